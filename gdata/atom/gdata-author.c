@@ -36,11 +36,13 @@
 #include "gdata-parsable.h"
 #include "gdata-parser.h"
 #include "gdata-comparable.h"
+#include "gdata-private.h"
 
 static void gdata_author_comparable_init (GDataComparableIface *iface);
 static void gdata_author_finalize (GObject *object);
 static void gdata_author_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_author_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+static void clone_private (GDataParsable *self, GDataParsable *clone);
 static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
 static gboolean post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
@@ -77,6 +79,9 @@ gdata_author_class_init (GDataAuthorClass *klass)
 	parsable_class->get_xml = get_xml;
 	parsable_class->element_name = "author";
 
+	_gdata_parsable_class_set_clone_func (parsable_class, clone_private);
+	_gdata_parsable_class_set_shareable (parsable_class);
+
 	/**
 	 * GDataAuthor:name:
 	 *
@@ -144,6 +149,16 @@ gdata_author_init (GDataAuthor *self)
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_AUTHOR, GDataAuthorPrivate);
 }
 
+static void
+clone_private (GDataParsable *self, GDataParsable *clone)
+{
+	GDataAuthorPrivate *priv = GDATA_AUTHOR (self)->priv, *clone_priv = GDATA_AUTHOR (clone)->priv;
+
+	clone_priv->name = g_strdup (priv->name);
+	clone_priv->uri = g_strdup (priv->uri);
+	clone_priv->email_address = g_strdup (priv->email_address);
+}
+
 static void
 gdata_author_finalize (GObject *object)
 {
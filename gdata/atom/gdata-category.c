@@ -36,17 +36,19 @@
 #include "gdata-parsable.h"
 #include "gdata-parser.h"
 #include "gdata-comparable.h"
+#include "gdata-private.h"
 
 static void gdata_category_comparable_init (GDataComparableIface *iface);
 static void gdata_category_finalize (GObject *object);
 static void gdata_category_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_category_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+static void clone_private (GDataParsable *self, GDataParsable *clone);
 static gboolean pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error);
 static void pre_get_xml (GDataParsable *parsable, GString *xml_string);
 
 struct _GDataCategoryPrivate {
 	gchar *term;
-	gchar *scheme;
+	const gchar *scheme; /* interned */
 	gchar *label;
 };
 
@@ -75,6 +77,9 @@ gdata_category_class_init (GDataCategoryClass *klass)
 	parsable_class->pre_get_xml = pre_get_xml;
 	parsable_class->element_name = "category";
 
+	_gdata_parsable_class_set_clone_func (parsable_class, clone_private);
+	_gdata_parsable_class_set_shareable (parsable_class);
+
 	/**
 	 * GDataCategory:term:
 	 *
@@ -145,13 +150,22 @@ gdata_category_init (GDataCategory *self)
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CATEGORY, GDataCategoryPrivate);
 }
 
+static void
+clone_private (GDataParsable *self, GDataParsable *clone)
+{
+	GDataCategoryPrivate *priv = GDATA_CATEGORY (self)->priv, *clone_priv = GDATA_CATEGORY (clone)->priv;
+
+	clone_priv->term = g_strdup (priv->term);
+	clone_priv->scheme = priv->scheme;
+	clone_priv->label = g_strdup (priv->label);
+}
+
 static void
 gdata_category_finalize (GObject *object)
 {
 	GDataCategoryPrivate *priv = GDATA_CATEGORY (object)->priv;
 
 	g_free (priv->term);
-	g_free (priv->scheme);
 	g_free (priv->label);
 
 	/* Chain up to the parent class */
@@ -215,7 +229,7 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 	}
 	self->priv->term = (gchar*) term;
 
-	self->priv->scheme = (gchar*) xmlGetProp (root_node, (xmlChar*) "scheme");
+	self->priv->scheme = gdata_parser_intern_property (root_node, "scheme");
 	self->priv->label = (gchar*) xmlGetProp (root_node, (xmlChar*) "label");
 
 	return TRUE;
@@ -323,8 +337,7 @@ gdata_category_set_scheme (GDataCategory *self, const gchar *scheme)
 {
 	g_return_if_fail (GDATA_IS_CATEGORY (self));
 
-	g_free (self->priv->scheme);
-	self->priv->scheme = g_strdup (scheme);
+	self->priv->scheme = g_intern_string (scheme);
 	g_object_notify (G_OBJECT (self), "scheme");
 }
 
@@ -37,18 +37,20 @@
 #include "gdata-parsable.h"
 #include "gdata-parser.h"
 #include "gdata-comparable.h"
+#include "gdata-private.h"
 
 static void gdata_link_comparable_init (GDataComparableIface *iface);
 static void gdata_link_finalize (GObject *object);
 static void gdata_link_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_link_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+static void clone_private (GDataParsable *self, GDataParsable *clone);
 static gboolean pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error);
 static void pre_get_xml (GDataParsable *parsable, GString *xml_string);
 
 struct _GDataLinkPrivate {
 	gchar *uri;
-	gchar *relation_type;
-	gchar *content_type;
+	const gchar *relation_type; /* interned */
+	const gchar *content_type; /* interned */
 	gchar *language;
 	gchar *title;
 	gint length;
@@ -82,6 +84,8 @@ gdata_link_class_init (GDataLinkClass *klass)
 	parsable_class->pre_get_xml = pre_get_xml;
 	parsable_class->element_name = "link";
 
+	_gdata_parsable_class_set_clone_func (parsable_class, clone_private);
+
 	/**
 	 * GDataLink:uri:
 	 *
@@ -201,7 +205,20 @@ gdata_link_init (GDataLink *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_LINK, GDataLinkPrivate);
 	self->priv->length = -1;
-	self->priv->relation_type = g_strdup (GDATA_LINK_ALTERNATE);
+	self->priv->relation_type = g_intern_static_string (GDATA_LINK_ALTERNATE);
+}
+
+static void
+clone_private (GDataParsable *self, GDataParsable *clone)
+{
+	GDataLinkPrivate *priv = GDATA_LINK (self)->priv, *clone_priv = GDATA_LINK (clone)->priv;
+
+	clone_priv->uri = g_strdup (priv->uri);
+	clone_priv->relation_type = priv->relation_type;
+	clone_priv->content_type = priv->content_type;
+	clone_priv->language = g_strdup (priv->language);
+	clone_priv->title = g_strdup (priv->title);
+	clone_priv->length = priv->length;
 }
 
 static void
@@ -210,8 +227,6 @@ gdata_link_finalize (GObject *object)
 	GDataLinkPrivate *priv = GDATA_LINK (object)->priv;
 
 	g_free (priv->uri);
-	g_free (priv->relation_type);
-	g_free (priv->content_type);
 	g_free (priv->language);
 	g_free (priv->title);
 
@@ -284,7 +299,8 @@ gdata_link_set_property (GObject *object, guint property_id, const GValue *value
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
-	xmlChar *uri, *relation_type, *content_type, *language, *length;
+	xmlChar *uri, *language, *length;
+	const gchar *relation_type, *content_type;
 	GDataLink *self = GDATA_LINK (parsable);
 
 	/* href */
@@ -296,22 +312,17 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 	self->priv->uri = (gchar*) uri;
 
 	/* rel */
-	relation_type = xmlGetProp (root_node, (xmlChar*) "rel");
-	if (relation_type != NULL && *relation_type == '\0') {
-		xmlFree (relation_type);
+	relation_type = gdata_parser_intern_property (root_node, "rel");
+	if (relation_type != NULL && *relation_type == '\0')
 		return gdata_parser_error_required_property_missing (root_node, "rel", error);
-	}
 
-	gdata_link_set_relation_type (self, (const gchar*) relation_type);
-	xmlFree (relation_type);
+	gdata_link_set_relation_type (self, relation_type);
 
 	/* type */
-	content_type = xmlGetProp (root_node, (xmlChar*) "type");
-	if (content_type != NULL && *content_type == '\0') {
-		xmlFree (content_type);
+	content_type = gdata_parser_intern_property (root_node, "type");
+	if (content_type != NULL && *content_type == '\0')
 		return gdata_parser_error_required_property_missing (root_node, "type", error);
-	}
-	self->priv->content_type = (gchar*) content_type;
+	self->priv->content_type = content_type;
 
 	/* hreflang */
 	language = xmlGetProp (root_node, (xmlChar*) "hreflang");
@@ -453,14 +464,19 @@ gdata_link_set_relation_type (GDataLink *self, const gchar *relation_type)
 	/* If the relation type is unset, use the default "alternate" relation type. If it's set, and isn't an IRI, turn it into an IRI
 	 * by appending it to "http://www.iana.org/assignments/relation/". If it's set and is an IRI, just use the IRI.
 	 * See: http://www.atomenabled.org/developers/syndication/atom-format-spec.php#rel_attribute
+	 *
+	 * Relation types are interned, since there are only a handful of them and they're repeated in every entry. This also allows
+	 * gdata_entry_look_up_link() and gdata_feed_look_up_link() to compare them by pointer.
 	 */
-	g_free (self->priv->relation_type);
-	if (relation_type == NULL)
-		self->priv->relation_type = g_strdup (GDATA_LINK_ALTERNATE);
-	else if (strchr ((char*) relation_type, ':') == NULL)
-		self->priv->relation_type = g_strconcat ("http://www.iana.org/assignments/relation/", (const gchar*) relation_type, NULL);
-	else
-		self->priv->relation_type = g_strdup ((gchar*) relation_type);
+	if (relation_type == NULL) {
+		self->priv->relation_type = g_intern_static_string (GDATA_LINK_ALTERNATE);
+	} else if (strchr ((char*) relation_type, ':') == NULL) {
+		gchar *full_relation_type = g_strconcat ("http://www.iana.org/assignments/relation/", (const gchar*) relation_type, NULL);
+		self->priv->relation_type = g_intern_string (full_relation_type);
+		g_free (full_relation_type);
+	} else {
+		self->priv->relation_type = g_intern_string (relation_type);
+	}
 
 	g_object_notify (G_OBJECT (self), "relation-type");
 }
@@ -499,8 +515,7 @@ gdata_link_set_content_type (GDataLink *self, const gchar *content_type)
 	g_return_if_fail (GDATA_IS_LINK (self));
 	g_return_if_fail (content_type == NULL || *content_type != '\0');
 
-	g_free (self->priv->content_type);
-	self->priv->content_type = g_strdup (content_type);
+	self->priv->content_type = g_intern_string (content_type);
 	g_object_notify (G_OBJECT (self), "content-type");
 }
 
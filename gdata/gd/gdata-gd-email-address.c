@@ -47,7 +47,7 @@ static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 
 struct _GDataGDEmailAddressPrivate {
 	gchar *address;
-	gchar *relation_type;
+	const gchar *relation_type; /* interned */
 	gchar *label;
 	gboolean is_primary;
 	gchar *display_name;
@@ -187,7 +187,6 @@ gdata_gd_email_address_finalize (GObject *object)
 	GDataGDEmailAddressPrivate *priv = GDATA_GD_EMAIL_ADDRESS (object)->priv;
 
 	g_free (priv->address);
-	g_free (priv->relation_type);
 	g_free (priv->label);
 	g_free (priv->display_name);
 
@@ -254,7 +253,8 @@ gdata_gd_email_address_set_property (GObject *object, guint property_id, const G
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
-	xmlChar *address, *rel;
+	xmlChar *address;
+	const gchar *rel;
 	gboolean primary_bool;
 	GDataGDEmailAddressPrivate *priv = GDATA_GD_EMAIL_ADDRESS (parsable)->priv;
 
@@ -268,15 +268,14 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 		return gdata_parser_error_required_property_missing (root_node, "address", error);
 	}
 
-	rel = xmlGetProp (root_node, (xmlChar*) "rel");
+	rel = gdata_parser_intern_property (root_node, "rel");
 	if (rel != NULL && *rel == '\0') {
 		xmlFree (address);
-		xmlFree (rel);
 		return gdata_parser_error_required_property_missing (root_node, "rel", error);
 	}
 
 	priv->address = (gchar*) address;
-	priv->relation_type = (gchar*) rel;
+	priv->relation_type = rel;
 	priv->label = (gchar*) xmlGetProp (root_node, (xmlChar*) "label");
 	priv->is_primary = primary_bool;
 	priv->display_name = (gchar*) xmlGetProp (root_node, (xmlChar*) "displayName");
@@ -403,8 +402,7 @@ gdata_gd_email_address_set_relation_type (GDataGDEmailAddress *self, const gchar
 	g_return_if_fail (GDATA_IS_GD_EMAIL_ADDRESS (self));
 	g_return_if_fail (relation_type == NULL || *relation_type != '\0');
 
-	g_free (self->priv->relation_type);
-	self->priv->relation_type = g_strdup (relation_type);
+	self->priv->relation_type = g_intern_string (relation_type);
 	g_object_notify (G_OBJECT (self), "relation-type");
 }
 
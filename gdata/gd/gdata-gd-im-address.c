@@ -47,8 +47,8 @@ static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 
 struct _GDataGDIMAddressPrivate {
 	gchar *address;
-	gchar *protocol;
-	gchar *relation_type;
+	const gchar *protocol; /* interned */
+	const gchar *relation_type; /* interned */
 	gchar *label;
 	gboolean is_primary;
 };
@@ -191,8 +191,6 @@ gdata_gd_im_address_finalize (GObject *object)
 	GDataGDIMAddressPrivate *priv = GDATA_GD_IM_ADDRESS (object)->priv;
 
 	g_free (priv->address);
-	g_free (priv->protocol);
-	g_free (priv->relation_type);
 	g_free (priv->label);
 
 	/* Chain up to the parent class */
@@ -258,7 +256,8 @@ gdata_gd_im_address_set_property (GObject *object, guint property_id, const GVal
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
-	xmlChar *address, *rel;
+	xmlChar *address;
+	const gchar *rel;
 	gboolean primary_bool;
 	GDataGDIMAddressPrivate *priv = GDATA_GD_IM_ADDRESS (parsable)->priv;
 
@@ -272,16 +271,15 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 		return gdata_parser_error_required_property_missing (root_node, "address", error);
 	}
 
-	rel = xmlGetProp (root_node, (xmlChar*) "rel");
+	rel = gdata_parser_intern_property (root_node, "rel");
 	if (rel != NULL && *rel == '\0') {
 		xmlFree (address);
-		xmlFree (rel);
 		return gdata_parser_error_required_property_missing (root_node, "rel", error);
 	}
 
 	priv->address = (gchar*) address;
-	priv->protocol = (gchar*) xmlGetProp (root_node, (xmlChar*) "protocol");
-	priv->relation_type = (gchar*) rel;
+	priv->protocol = gdata_parser_intern_property (root_node, "protocol");
+	priv->relation_type = rel;
 	priv->label = (gchar*) xmlGetProp (root_node, (xmlChar*) "label");
 	priv->is_primary = primary_bool;
 
@@ -408,8 +406,7 @@ gdata_gd_im_address_set_protocol (GDataGDIMAddress *self, const gchar *protocol)
 	g_return_if_fail (GDATA_IS_GD_IM_ADDRESS (self));
 	g_return_if_fail (protocol == NULL || *protocol != '\0');
 
-	g_free (self->priv->protocol);
-	self->priv->protocol = g_strdup (protocol);
+	self->priv->protocol = g_intern_string (protocol);
 	g_object_notify (G_OBJECT (self), "protocol");
 }
 
@@ -447,8 +444,7 @@ gdata_gd_im_address_set_relation_type (GDataGDIMAddress *self, const gchar *rela
 	g_return_if_fail (GDATA_IS_GD_IM_ADDRESS (self));
 	g_return_if_fail (relation_type == NULL || *relation_type != '\0');
 
-	g_free (self->priv->relation_type);
-	self->priv->relation_type = g_strdup (relation_type);
+	self->priv->relation_type = g_intern_string (relation_type);
 	g_object_notify (G_OBJECT (self), "relation-type");
 }
 
@@ -36,6 +36,9 @@
  * 	<varlistentry><term>#GDataGDName:suffix</term><listitem><para>KG</para></listitem></varlistentry>
  * </variablelist>
  *
+ * The name's strings are stored together to save memory, so the strings returned by its getters are only valid until the name is next modified,
+ * rather than until the same property is next modified.
+ *
  * Since: 0.5.0
  **/
 
@@ -46,6 +49,7 @@
 #include "gdata-parsable.h"
 #include "gdata-parser.h"
 #include "gdata-comparable.h"
+#include "gdata-packed-strings.h"
 
 static void gdata_gd_name_comparable_init (GDataComparableIface *iface);
 static void gdata_gd_name_finalize (GObject *object);
@@ -55,15 +59,32 @@ static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node,
 static void get_xml (GDataParsable *parsable, GString *xml_string);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 
+/* Indices of the name's strings in GDataGDNamePrivate.strings, most of which are usually unset. These are in the order they're output. */
+typedef enum {
+	FIELD_GIVEN_NAME = 0,
+	FIELD_ADDITIONAL_NAME,
+	FIELD_FAMILY_NAME,
+	FIELD_PREFIX,
+	FIELD_SUFFIX,
+	FIELD_FULL_NAME
+} Field;
+
+/* The names of the elements for each Field */
+static const gchar *field_elements[] = {
+	"givenName",
+	"additionalName",
+	"familyName",
+	"namePrefix",
+	"nameSuffix",
+	"fullName",
+};
+
 struct _GDataGDNamePrivate {
-	gchar *given_name;
-	gchar *additional_name;
-	gchar *family_name;
-	gchar *prefix;
-	gchar *suffix;
-	gchar *full_name;
+	GDataPackedStrings strings; /* indexed by Field */
 };
 
+#define GET_FIELD(P, F) gdata_packed_strings_get (&((P)->strings), (F))
+
 enum {
 	PROP_GIVEN_NAME = 1,
 	PROP_ADDITIONAL_NAME,
@@ -197,8 +218,10 @@ compare_with (GDataComparable *self, GDataComparable *other)
 {
 	GDataGDNamePrivate *a = ((GDataGDName*) self)->priv, *b = ((GDataGDName*) other)->priv;
 
-	if (g_strcmp0 (a->given_name, b->given_name) == 0 && g_strcmp0 (a->additional_name, b->additional_name) == 0 &&
-	    g_strcmp0 (a->family_name, b->family_name) == 0 && g_strcmp0 (a->prefix, b->prefix) == 0)
+	if (g_strcmp0 (GET_FIELD (a, FIELD_GIVEN_NAME), GET_FIELD (b, FIELD_GIVEN_NAME)) == 0 &&
+	    g_strcmp0 (GET_FIELD (a, FIELD_ADDITIONAL_NAME), GET_FIELD (b, FIELD_ADDITIONAL_NAME)) == 0 &&
+	    g_strcmp0 (GET_FIELD (a, FIELD_FAMILY_NAME), GET_FIELD (b, FIELD_FAMILY_NAME)) == 0 &&
+	    g_strcmp0 (GET_FIELD (a, FIELD_PREFIX), GET_FIELD (b, FIELD_PREFIX)) == 0)
 		return 0;
 	return 1;
 }
@@ -220,12 +243,7 @@ gdata_gd_name_finalize (GObject *object)
 {
 	GDataGDNamePrivate *priv = GDATA_GD_NAME (object)->priv;
 
-	g_free (priv->given_name);
-	g_free (priv->additional_name);
-	g_free (priv->family_name);
-	g_free (priv->prefix);
-	g_free (priv->suffix);
-	g_free (priv->full_name);
+	gdata_packed_strings_clear (&(priv->strings));
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_gd_name_parent_class)->finalize (object);
@@ -238,22 +256,22 @@ gdata_gd_name_get_property (GObject *object, guint property_id, GValue *value, G
 
 	switch (property_id) {
 		case PROP_GIVEN_NAME:
-			g_value_set_string (value, priv->given_name);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_GIVEN_NAME));
 			break;
 		case PROP_ADDITIONAL_NAME:
-			g_value_set_string (value, priv->additional_name);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_ADDITIONAL_NAME));
 			break;
 		case PROP_FAMILY_NAME:
-			g_value_set_string (value, priv->family_name);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_FAMILY_NAME));
 			break;
 		case PROP_PREFIX:
-			g_value_set_string (value, priv->prefix);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_PREFIX));
 			break;
 		case PROP_SUFFIX:
-			g_value_set_string (value, priv->suffix);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_SUFFIX));
 			break;
 		case PROP_FULL_NAME:
-			g_value_set_string (value, priv->full_name);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_FULL_NAME));
 			break;
 		default:
 			/* We don't have any other property... */
@@ -299,17 +317,26 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 	gboolean success;
 	GDataGDNamePrivate *priv = GDATA_GD_NAME (parsable)->priv;
 
-	if (gdata_parser_is_namespace (node, "http://schemas.google.com/g/2005") == TRUE && (
-	     gdata_parser_string_from_element (node, "givenName", P_NO_DUPES, &(priv->given_name), &success, error) == TRUE ||
-	     gdata_parser_string_from_element (node, "additionalName", P_NO_DUPES, &(priv->additional_name), &success, error) == TRUE ||
-	     gdata_parser_string_from_element (node, "familyName", P_NO_DUPES, &(priv->family_name), &success, error) == TRUE ||
-	     gdata_parser_string_from_element (node, "namePrefix", P_NO_DUPES, &(priv->prefix), &success, error) == TRUE ||
-	     gdata_parser_string_from_element (node, "nameSuffix", P_NO_DUPES, &(priv->suffix), &success, error) == TRUE ||
-	     gdata_parser_string_from_element (node, "fullName", P_NO_DUPES, &(priv->full_name), &success, error) == TRUE)) {
-		return success;
-	} else {
-		return GDATA_PARSABLE_CLASS (gdata_gd_name_parent_class)->parse_xml (parsable, doc, node, user_data, error);
+	if (gdata_parser_is_namespace (node, "http://schemas.google.com/g/2005") == TRUE) {
+		Field field;
+
+		for (field = FIELD_GIVEN_NAME; field < G_N_ELEMENTS (field_elements); field++) {
+			gchar *value = NULL;
+
+			if (xmlStrcmp (node->name, (xmlChar*) field_elements[field]) != 0)
+				continue;
+
+			if (GET_FIELD (priv, field) != NULL)
+				return gdata_parser_error_duplicate_element (node, error);
+
+			gdata_parser_string_from_element (node, field_elements[field], P_NO_DUPES, &value, &success, error);
+			gdata_packed_strings_take (&(priv->strings), field, value);
+
+			return success;
+		}
 	}
+
+	return GDATA_PARSABLE_CLASS (gdata_gd_name_parent_class)->parse_xml (parsable, doc, node, user_data, error);
 }
 
 static void
@@ -317,22 +344,19 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 {
 	GDataGDNamePrivate *priv = GDATA_GD_NAME (parsable)->priv;
 
-#define OUTPUT_STRING_ELEMENT(E,F)									\
-	if (priv->F != NULL)										\
-		gdata_parser_string_append_escaped (xml_string, "<gd:" E ">", priv->F, "</gd:" E ">");
+	Field field;
 
-	OUTPUT_STRING_ELEMENT ("givenName", given_name)
-	OUTPUT_STRING_ELEMENT ("additionalName", additional_name)
-	OUTPUT_STRING_ELEMENT ("familyName", family_name)
-	OUTPUT_STRING_ELEMENT ("namePrefix", prefix)
-	OUTPUT_STRING_ELEMENT ("nameSuffix", suffix)
+	for (field = FIELD_GIVEN_NAME; field < G_N_ELEMENTS (field_elements); field++) {
+		const gchar *value = GET_FIELD (priv, field);
 
-	/* We can't guarantee that priv->full_name is non-empty without breaking API. */
-	if (priv->full_name != NULL && *(priv->full_name) != '\0') {
-		gdata_parser_string_append_escaped (xml_string, "<gd:fullName>", priv->full_name, "</gd:fullName>");
-	}
+		/* We can't guarantee that the full name is non-empty without breaking API. */
+		if (value == NULL || (field == FIELD_FULL_NAME && *value == '\0'))
+			continue;
 
-#undef OUTPUT_STRING_ELEMENT
+		g_string_append_printf (xml_string, "<gd:%s>", field_elements[field]);
+		gdata_parser_string_append_escaped (xml_string, NULL, value, NULL);
+		g_string_append_printf (xml_string, "</gd:%s>", field_elements[field]);
+	}
 }
 
 static void
@@ -375,7 +399,7 @@ const gchar *
 gdata_gd_name_get_given_name (GDataGDName *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_NAME (self), NULL);
-	return self->priv->given_name;
+	return GET_FIELD (self->priv, FIELD_GIVEN_NAME);
 }
 
 /**
@@ -393,8 +417,7 @@ gdata_gd_name_set_given_name (GDataGDName *self, const gchar *given_name)
 	g_return_if_fail (GDATA_IS_GD_NAME (self));
 	g_return_if_fail (given_name == NULL || *given_name != '\0');
 
-	g_free (self->priv->given_name);
-	self->priv->given_name = g_strdup (given_name);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_GIVEN_NAME, given_name);
 	g_object_notify (G_OBJECT (self), "given-name");
 }
 
@@ -412,7 +435,7 @@ const gchar *
 gdata_gd_name_get_additional_name (GDataGDName *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_NAME (self), NULL);
-	return self->priv->additional_name;
+	return GET_FIELD (self->priv, FIELD_ADDITIONAL_NAME);
 }
 
 /**
@@ -430,8 +453,7 @@ gdata_gd_name_set_additional_name (GDataGDName *self, const gchar *additional_na
 	g_return_if_fail (GDATA_IS_GD_NAME (self));
 	g_return_if_fail (additional_name == NULL || *additional_name != '\0');
 
-	g_free (self->priv->additional_name);
-	self->priv->additional_name = g_strdup (additional_name);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_ADDITIONAL_NAME, additional_name);
 	g_object_notify (G_OBJECT (self), "additional-name");
 }
 
@@ -449,7 +471,7 @@ const gchar *
 gdata_gd_name_get_family_name (GDataGDName *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_NAME (self), NULL);
-	return self->priv->family_name;
+	return GET_FIELD (self->priv, FIELD_FAMILY_NAME);
 }
 
 /**
@@ -467,8 +489,7 @@ gdata_gd_name_set_family_name (GDataGDName *self, const gchar *family_name)
 	g_return_if_fail (GDATA_IS_GD_NAME (self));
 	g_return_if_fail (family_name == NULL || *family_name != '\0');
 
-	g_free (self->priv->family_name);
-	self->priv->family_name = g_strdup (family_name);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_FAMILY_NAME, family_name);
 	g_object_notify (G_OBJECT (self), "family-name");
 }
 
@@ -486,7 +507,7 @@ const gchar *
 gdata_gd_name_get_prefix (GDataGDName *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_NAME (self), NULL);
-	return self->priv->prefix;
+	return GET_FIELD (self->priv, FIELD_PREFIX);
 }
 
 /**
@@ -504,8 +525,7 @@ gdata_gd_name_set_prefix (GDataGDName *self, const gchar *prefix)
 	g_return_if_fail (GDATA_IS_GD_NAME (self));
 	g_return_if_fail (prefix == NULL || *prefix != '\0');
 
-	g_free (self->priv->prefix);
-	self->priv->prefix = g_strdup (prefix);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_PREFIX, prefix);
 	g_object_notify (G_OBJECT (self), "prefix");
 }
 
@@ -523,7 +543,7 @@ const gchar *
 gdata_gd_name_get_suffix (GDataGDName *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_NAME (self), NULL);
-	return self->priv->suffix;
+	return GET_FIELD (self->priv, FIELD_SUFFIX);
 }
 
 /**
@@ -541,8 +561,7 @@ gdata_gd_name_set_suffix (GDataGDName *self, const gchar *suffix)
 	g_return_if_fail (GDATA_IS_GD_NAME (self));
 	g_return_if_fail (suffix == NULL || *suffix != '\0');
 
-	g_free (self->priv->suffix);
-	self->priv->suffix = g_strdup (suffix);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_SUFFIX, suffix);
 	g_object_notify (G_OBJECT (self), "suffix");
 }
 
@@ -560,7 +579,7 @@ const gchar *
 gdata_gd_name_get_full_name (GDataGDName *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_NAME (self), NULL);
-	return self->priv->full_name;
+	return GET_FIELD (self->priv, FIELD_FULL_NAME);
 }
 
 /**
@@ -583,7 +602,6 @@ gdata_gd_name_set_full_name (GDataGDName *self, const gchar *full_name)
 		full_name = NULL;
 	}
 
-	g_free (self->priv->full_name);
-	self->priv->full_name = g_strdup (full_name);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_FULL_NAME, full_name);
 	g_object_notify (G_OBJECT (self), "full-name");
 }
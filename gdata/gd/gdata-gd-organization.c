@@ -53,7 +53,7 @@ static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 struct _GDataGDOrganizationPrivate {
 	gchar *name;
 	gchar *title;
-	gchar *relation_type;
+	const gchar *relation_type; /* interned */
 	gchar *label;
 	gboolean is_primary;
 	gchar *department;
@@ -285,7 +285,6 @@ gdata_gd_organization_finalize (GObject *object)
 
 	g_free (priv->name);
 	g_free (priv->title);
-	g_free (priv->relation_type);
 	g_free (priv->label);
 	g_free (priv->department);
 	g_free (priv->job_description);
@@ -378,7 +377,7 @@ gdata_gd_organization_set_property (GObject *object, guint property_id, const GV
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
-	xmlChar *rel;
+	const gchar *rel;
 	gboolean primary_bool;
 	GDataGDOrganizationPrivate *priv = GDATA_GD_ORGANIZATION (parsable)->priv;
 
@@ -386,13 +385,11 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 	if (gdata_parser_boolean_from_property (root_node, "primary", &primary_bool, 0, error) == FALSE)
 		return FALSE;
 
-	rel = xmlGetProp (root_node, (xmlChar*) "rel");
-	if (rel != NULL && *rel == '\0') {
-		xmlFree (rel);
+	rel = gdata_parser_intern_property (root_node, "rel");
+	if (rel != NULL && *rel == '\0')
 		return gdata_parser_error_required_property_missing (root_node, "rel", error);
-	}
 
-	priv->relation_type = (gchar*) rel;
+	priv->relation_type = rel;
 	priv->label = (gchar*) xmlGetProp (root_node, (xmlChar*) "label");
 	priv->is_primary = primary_bool;
 
@@ -593,8 +590,7 @@ gdata_gd_organization_set_relation_type (GDataGDOrganization *self, const gchar
 	g_return_if_fail (GDATA_IS_GD_ORGANIZATION (self));
 	g_return_if_fail (relation_type == NULL || *relation_type != '\0');
 
-	g_free (self->priv->relation_type);
-	self->priv->relation_type = g_strdup (relation_type);
+	self->priv->relation_type = g_intern_string (relation_type);
 	g_object_notify (G_OBJECT (self), "relation-type");
 }
 
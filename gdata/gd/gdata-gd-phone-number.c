@@ -51,7 +51,7 @@ static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 struct _GDataGDPhoneNumberPrivate {
 	gchar *number;
 	gchar *uri;
-	gchar *relation_type;
+	const gchar *relation_type; /* interned */
 	gchar *label;
 	gboolean is_primary;
 };
@@ -209,7 +209,6 @@ gdata_gd_phone_number_finalize (GObject *object)
 
 	g_free (priv->number);
 	g_free (priv->uri);
-	g_free (priv->relation_type);
 	g_free (priv->label);
 
 	/* Chain up to the parent class */
@@ -275,7 +274,8 @@ gdata_gd_phone_number_set_property (GObject *object, guint property_id, const GV
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
-	xmlChar *number, *rel;
+	xmlChar *number;
+	const gchar *rel;
 	gboolean primary_bool;
 	GDataGDPhoneNumberPrivate *priv = GDATA_GD_PHONE_NUMBER (parsable)->priv;
 
@@ -283,27 +283,26 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 	if (gdata_parser_boolean_from_property (root_node, "primary", &primary_bool, 0, error) == FALSE)
 		return FALSE;
 
-	number = xmlNodeListGetString (doc, root_node->children, TRUE);
+	number = gdata_parser_take_element_content (root_node);
 	if (number == NULL || *number == '\0') {
 		xmlFree (number);
 		return gdata_parser_error_required_content_missing (root_node, error);
 	}
 
-	rel = xmlGetProp (root_node, (xmlChar*) "rel");
+	rel = gdata_parser_intern_property (root_node, "rel");
 	if (rel != NULL && *rel == '\0') {
-		xmlFree (rel);
 		xmlFree (number);
 		return gdata_parser_error_required_property_missing (root_node, "rel", error);
 	}
 
-	gdata_gd_phone_number_set_number (GDATA_GD_PHONE_NUMBER (parsable), (gchar*) number);
+	/* Trim the number's whitespace in place, as gdata_gd_phone_number_set_number() would, and keep it without copying it */
+	g_free (priv->number);
+	priv->number = gdata_parser_utf8_trim_whitespace_in_place ((gchar*) number);
 	priv->uri = (gchar*) xmlGetProp (root_node, (xmlChar*) "uri");
-	priv->relation_type = (gchar*) rel;
+	priv->relation_type = rel;
 	priv->label = (gchar*) xmlGetProp (root_node, (xmlChar*) "label");
 	priv->is_primary = primary_bool;
 
-	xmlFree (number);
-
 	return TRUE;
 }
 
@@ -483,8 +482,7 @@ gdata_gd_phone_number_set_relation_type (GDataGDPhoneNumber *self, const gchar *
 	g_return_if_fail (GDATA_IS_GD_PHONE_NUMBER (self));
 	g_return_if_fail (relation_type == NULL || *relation_type != '\0');
 
-	g_free (self->priv->relation_type);
-	self->priv->relation_type = g_strdup (relation_type);
+	self->priv->relation_type = g_intern_string (relation_type);
 	g_object_notify (G_OBJECT (self), "relation-type");
 }
 
@@ -27,6 +27,9 @@
  * <ulink type="http" url="http://code.google.com/apis/gdata/docs/2.0/elements.html#gdStructuredPostalAddress">GData specification</ulink>.
  * Note that it does not represent a simple "postalAddress" element, as "structuredPostalAddress" is now used wherever possible in the GData API.
  *
+ * The address' strings are stored together to save memory, so the strings returned by its getters are only valid until the address is next
+ * modified, rather than until the same property is next modified.
+ *
  * Since: 0.4.0
  **/
 
@@ -38,6 +41,7 @@
 #include "gdata-parsable.h"
 #include "gdata-parser.h"
 #include "gdata-comparable.h"
+#include "gdata-packed-strings.h"
 
 static void gdata_gd_postal_address_comparable_init (GDataComparableIface *iface);
 static void gdata_gd_postal_address_finalize (GObject *object);
@@ -49,26 +53,33 @@ static void pre_get_xml (GDataParsable *parsable, GString *xml_string);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 
+/* Most addresses only have a few of their string fields set, so they're packed together rather than each being allocated separately */
+typedef enum {
+	FIELD_FORMATTED_ADDRESS = 0,
+	FIELD_LABEL,
+	FIELD_MAIL_CLASS,
+	FIELD_USAGE,
+	FIELD_AGENT,
+	FIELD_HOUSE_NAME,
+	FIELD_STREET,
+	FIELD_PO_BOX,
+	FIELD_NEIGHBORHOOD,
+	FIELD_CITY,
+	FIELD_SUBREGION,
+	FIELD_REGION,
+	FIELD_POSTCODE,
+	FIELD_COUNTRY,
+	FIELD_COUNTRY_CODE
+} Field;
+
 struct _GDataGDPostalAddressPrivate {
-	gchar *formatted_address;
-	gchar *relation_type;
-	gchar *label;
+	GDataPackedStrings strings; /* indexed by Field */
+	const gchar *relation_type; /* interned */
 	gboolean is_primary;
-	gchar *mail_class;
-	gchar *usage;
-	gchar *agent;
-	gchar *house_name;
-	gchar *street;
-	gchar *po_box;
-	gchar *neighborhood;
-	gchar *city;
-	gchar *subregion;
-	gchar *region;
-	gchar *postcode;
-	gchar *country;
-	gchar *country_code;
 };
 
+#define GET_FIELD(P, F) gdata_packed_strings_get (&((P)->strings), (F))
+
 enum {
 	PROP_FORMATTED_ADDRESS = 1,
 	PROP_RELATION_TYPE,
@@ -396,8 +407,10 @@ compare_with (GDataComparable *self, GDataComparable *other)
 {
 	GDataGDPostalAddressPrivate *a = ((GDataGDPostalAddress*) self)->priv, *b = ((GDataGDPostalAddress*) other)->priv;
 
-	if (g_strcmp0 (a->street, b->street) == 0 && g_strcmp0 (a->po_box, b->po_box) == 0 &&
-	    g_strcmp0 (a->city, b->city) == 0 && g_strcmp0 (a->postcode, b->postcode) == 0)
+	if (g_strcmp0 (GET_FIELD (a, FIELD_STREET), GET_FIELD (b, FIELD_STREET)) == 0 &&
+	    g_strcmp0 (GET_FIELD (a, FIELD_PO_BOX), GET_FIELD (b, FIELD_PO_BOX)) == 0 &&
+	    g_strcmp0 (GET_FIELD (a, FIELD_CITY), GET_FIELD (b, FIELD_CITY)) == 0 &&
+	    g_strcmp0 (GET_FIELD (a, FIELD_POSTCODE), GET_FIELD (b, FIELD_POSTCODE)) == 0)
 		return 0;
 	return 1;
 }
@@ -419,22 +432,7 @@ gdata_gd_postal_address_finalize (GObject *object)
 {
 	GDataGDPostalAddressPrivate *priv = GDATA_GD_POSTAL_ADDRESS (object)->priv;
 
-	g_free (priv->formatted_address);
-	g_free (priv->relation_type);
-	g_free (priv->label);
-	g_free (priv->mail_class);
-	g_free (priv->usage);
-	g_free (priv->agent);
-	g_free (priv->house_name);
-	g_free (priv->street);
-	g_free (priv->po_box);
-	g_free (priv->neighborhood);
-	g_free (priv->city);
-	g_free (priv->subregion);
-	g_free (priv->region);
-	g_free (priv->postcode);
-	g_free (priv->country);
-	g_free (priv->country_code);
+	gdata_packed_strings_clear (&(priv->strings));
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_gd_postal_address_parent_class)->finalize (object);
@@ -447,55 +445,55 @@ gdata_gd_postal_address_get_property (GObject *object, guint property_id, GValue
 
 	switch (property_id) {
 		case PROP_FORMATTED_ADDRESS:
-			g_value_set_string (value, priv->formatted_address);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_FORMATTED_ADDRESS));
 			break;
 		case PROP_RELATION_TYPE:
 			g_value_set_string (value, priv->relation_type);
 			break;
 		case PROP_LABEL:
-			g_value_set_string (value, priv->label);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_LABEL));
 			break;
 		case PROP_IS_PRIMARY:
 			g_value_set_boolean (value, priv->is_primary);
 			break;
 		case PROP_MAIL_CLASS:
-			g_value_set_string (value, priv->mail_class);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_MAIL_CLASS));
 			break;
 		case PROP_USAGE:
-			g_value_set_string (value, priv->usage);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_USAGE));
 			break;
 		case PROP_AGENT:
-			g_value_set_string (value, priv->agent);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_AGENT));
 			break;
 		case PROP_HOUSE_NAME:
-			g_value_set_string (value, priv->house_name);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_HOUSE_NAME));
 			break;
 		case PROP_STREET:
-			g_value_set_string (value, priv->street);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_STREET));
 			break;
 		case PROP_PO_BOX:
-			g_value_set_string (value, priv->po_box);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_PO_BOX));
 			break;
 		case PROP_NEIGHBORHOOD:
-			g_value_set_string (value, priv->neighborhood);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_NEIGHBORHOOD));
 			break;
 		case PROP_CITY:
-			g_value_set_string (value, priv->city);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_CITY));
 			break;
 		case PROP_SUBREGION:
-			g_value_set_string (value, priv->subregion);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_SUBREGION));
 			break;
 		case PROP_REGION:
-			g_value_set_string (value, priv->region);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_REGION));
 			break;
 		case PROP_POSTCODE:
-			g_value_set_string (value, priv->postcode);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_POSTCODE));
 			break;
 		case PROP_COUNTRY:
-			g_value_set_string (value, priv->country);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_COUNTRY));
 			break;
 		case PROP_COUNTRY_CODE:
-			g_value_set_string (value, priv->country_code);
+			g_value_set_string (value, GET_FIELD (priv, FIELD_COUNTRY_CODE));
 			break;
 		default:
 			/* We don't have any other property... */
@@ -562,10 +560,19 @@ gdata_gd_postal_address_set_property (GObject *object, guint property_id, const
 	}
 }
 
+static void
+set_field_from_property (GDataGDPostalAddressPrivate *priv, Field field, xmlNode *node, const gchar *property_name)
+{
+	xmlChar *value = xmlGetProp (node, (xmlChar*) property_name);
+
+	gdata_packed_strings_set (&(priv->strings), field, (gchar*) value);
+	xmlFree (value);
+}
+
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
-	xmlChar *rel;
+	const gchar *rel;
 	gboolean primary_bool;
 	GDataGDPostalAddressPrivate *priv = GDATA_GD_POSTAL_ADDRESS (parsable)->priv;
 
@@ -573,21 +580,36 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 	if (gdata_parser_boolean_from_property (root_node, "primary", &primary_bool, 0, error) == FALSE)
 		return FALSE;
 
-	rel = xmlGetProp (root_node, (xmlChar*) "rel");
-	if (rel != NULL && *rel == '\0') {
-		xmlFree (rel);
+	rel = gdata_parser_intern_property (root_node, "rel");
+	if (rel != NULL && *rel == '\0')
 		return gdata_parser_error_required_property_missing (root_node, "rel", error);
-	}
 
-	priv->relation_type = (gchar*) rel;
-	priv->label = (gchar*) xmlGetProp (root_node, (xmlChar*) "label");
-	priv->mail_class = (gchar*) xmlGetProp (root_node, (xmlChar*) "mailClass");
-	priv->usage = (gchar*) xmlGetProp (root_node, (xmlChar*) "usage");
+	priv->relation_type = rel;
+	set_field_from_property (priv, FIELD_LABEL, root_node, "label");
+	set_field_from_property (priv, FIELD_MAIL_CLASS, root_node, "mailClass");
+	set_field_from_property (priv, FIELD_USAGE, root_node, "usage");
 	priv->is_primary = primary_bool;
 
 	return TRUE;
 }
 
+/* The simple string child elements, in the order they're output (apart from gd:country, which is output before gd:formattedAddress) */
+static const struct {
+	const gchar *element_name;
+	Field field;
+} string_elements[] = {
+	{ "agent", FIELD_AGENT },
+	{ "housename", FIELD_HOUSE_NAME },
+	{ "street", FIELD_STREET },
+	{ "pobox", FIELD_PO_BOX },
+	{ "neighborhood", FIELD_NEIGHBORHOOD },
+	{ "city", FIELD_CITY },
+	{ "subregion", FIELD_SUBREGION },
+	{ "region", FIELD_REGION },
+	{ "postcode", FIELD_POSTCODE },
+	{ "formattedAddress", FIELD_FORMATTED_ADDRESS },
+};
+
 static gboolean
 parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
 {
@@ -595,21 +617,30 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 	GDataGDPostalAddressPrivate *priv = GDATA_GD_POSTAL_ADDRESS (parsable)->priv;
 
 	if (gdata_parser_is_namespace (node, "http://schemas.google.com/g/2005") == TRUE) {
-		if (gdata_parser_string_from_element (node, "agent", P_NO_DUPES, &(priv->agent), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "housename", P_NO_DUPES, &(priv->house_name), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "pobox", P_NO_DUPES, &(priv->po_box), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "street", P_NO_DUPES, &(priv->street), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "neighborhood", P_NO_DUPES, &(priv->neighborhood), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "city", P_NO_DUPES, &(priv->city), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "subregion", P_NO_DUPES, &(priv->subregion), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "region", P_NO_DUPES, &(priv->region), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "postcode", P_NO_DUPES, &(priv->postcode), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "formattedAddress", P_NO_DUPES, &(priv->formatted_address), &success, error) == TRUE) {
+		guint i;
+
+		for (i = 0; i < G_N_ELEMENTS (string_elements); i++) {
+			gchar *value = NULL;
+
+			if (xmlStrcmp (node->name, (xmlChar*) string_elements[i].element_name) != 0)
+				continue;
+
+			if (GET_FIELD (priv, string_elements[i].field) != NULL)
+				return gdata_parser_error_duplicate_element (node, error);
+
+			gdata_parser_string_from_element (node, string_elements[i].element_name, P_NO_DUPES, &value, &success, error);
+			gdata_packed_strings_take (&(priv->strings), string_elements[i].field, value);
+
 			return success;
-		} else if (xmlStrcmp (node->name, (xmlChar*) "country") == 0) {
+		}
+
+		if (xmlStrcmp (node->name, (xmlChar*) "country") == 0) {
 			/* gd:country */
-			priv->country_code = (gchar*) xmlGetProp (node, (xmlChar*) "code");
-			priv->country = (gchar*) xmlNodeListGetString (doc, node->children, TRUE);
+			xmlChar *country = gdata_parser_take_element_content (node);
+
+			set_field_from_property (priv, FIELD_COUNTRY_CODE, node, "code");
+			gdata_packed_strings_set (&(priv->strings), FIELD_COUNTRY, (gchar*) country);
+			xmlFree (country);
 
 			return TRUE;
 		}
@@ -625,12 +656,12 @@ pre_get_xml (GDataParsable *parsable, GString *xml_string)
 
 	if (priv->relation_type != NULL)
 		gdata_parser_string_append_escaped (xml_string, " rel='", priv->relation_type, "'");
-	if (priv->label != NULL)
-		gdata_parser_string_append_escaped (xml_string, " label='", priv->label, "'");
-	if (priv->mail_class != NULL)
-		gdata_parser_string_append_escaped (xml_string, " mailClass='", priv->mail_class, "'");
-	if (priv->usage != NULL)
-		gdata_parser_string_append_escaped (xml_string, " usage='", priv->usage, "'");
+	if (GET_FIELD (priv, FIELD_LABEL) != NULL)
+		gdata_parser_string_append_escaped (xml_string, " label='", GET_FIELD (priv, FIELD_LABEL), "'");
+	if (GET_FIELD (priv, FIELD_MAIL_CLASS) != NULL)
+		gdata_parser_string_append_escaped (xml_string, " mailClass='", GET_FIELD (priv, FIELD_MAIL_CLASS), "'");
+	if (GET_FIELD (priv, FIELD_USAGE) != NULL)
+		gdata_parser_string_append_escaped (xml_string, " usage='", GET_FIELD (priv, FIELD_USAGE), "'");
 
 	if (priv->is_primary == TRUE)
 		g_string_append (xml_string, " primary='true'");
@@ -643,31 +674,26 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 {
 	GDataGDPostalAddressPrivate *priv = GDATA_GD_POSTAL_ADDRESS (parsable)->priv;
 
-#define OUTPUT_STRING_ELEMENT(E,F)									\
-	if (priv->F != NULL)										\
-		gdata_parser_string_append_escaped (xml_string, "<gd:" E ">", priv->F, "</gd:" E ">");
-
-	OUTPUT_STRING_ELEMENT ("agent", agent)
-	OUTPUT_STRING_ELEMENT ("housename", house_name)
-	OUTPUT_STRING_ELEMENT ("street", street)
-	OUTPUT_STRING_ELEMENT ("pobox", po_box)
-	OUTPUT_STRING_ELEMENT ("neighborhood", neighborhood)
-	OUTPUT_STRING_ELEMENT ("city", city)
-	OUTPUT_STRING_ELEMENT ("subregion", subregion)
-	OUTPUT_STRING_ELEMENT ("region", region)
-	OUTPUT_STRING_ELEMENT ("postcode", postcode)
-
-	if (priv->country != NULL) {
-		if (priv->country_code != NULL)
-			gdata_parser_string_append_escaped (xml_string, "<gd:country code='", priv->country_code, "'>");
-		else
-			g_string_append (xml_string, "<gd:country>");
-		gdata_parser_string_append_escaped (xml_string, NULL, priv->country, "</gd:country>");
-	}
+	const gchar *country = GET_FIELD (priv, FIELD_COUNTRY), *country_code = GET_FIELD (priv, FIELD_COUNTRY_CODE);
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (string_elements); i++) {
+		const gchar *value = GET_FIELD (priv, string_elements[i].field);
 
-	OUTPUT_STRING_ELEMENT ("formattedAddress", formatted_address)
+		if (string_elements[i].field == FIELD_FORMATTED_ADDRESS && country != NULL) {
+			if (country_code != NULL)
+				gdata_parser_string_append_escaped (xml_string, "<gd:country code='", country_code, "'>");
+			else
+				g_string_append (xml_string, "<gd:country>");
+			gdata_parser_string_append_escaped (xml_string, NULL, country, "</gd:country>");
+		}
 
-#undef OUTPUT_STRING_ELEMENT
+		if (value != NULL) {
+			g_string_append_printf (xml_string, "<gd:%s>", string_elements[i].element_name);
+			gdata_parser_string_append_escaped (xml_string, NULL, value, NULL);
+			g_string_append_printf (xml_string, "</gd:%s>", string_elements[i].element_name);
+		}
+	}
 }
 
 static void
@@ -710,7 +736,7 @@ const gchar *
 gdata_gd_postal_address_get_address (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->formatted_address;
+	return GET_FIELD (self->priv, FIELD_FORMATTED_ADDRESS);
 }
 
 /**
@@ -729,8 +755,7 @@ gdata_gd_postal_address_set_address (GDataGDPostalAddress *self, const gchar *ad
 
 	/* Trim leading and trailing whitespace from the address.
 	 * See here: http://code.google.com/apis/gdata/docs/1.0/elements.html#gdPostalAddress */
-	g_free (self->priv->formatted_address);
-	self->priv->formatted_address = gdata_parser_utf8_trim_whitespace (address);
+	gdata_packed_strings_take (&(self->priv->strings), FIELD_FORMATTED_ADDRESS, gdata_parser_utf8_trim_whitespace (address));
 	g_object_notify (G_OBJECT (self), "address");
 }
 
@@ -768,8 +793,7 @@ gdata_gd_postal_address_set_relation_type (GDataGDPostalAddress *self, const gch
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (relation_type == NULL || *relation_type != '\0');
 
-	g_free (self->priv->relation_type);
-	self->priv->relation_type = g_strdup (relation_type);
+	self->priv->relation_type = g_intern_string (relation_type);
 	g_object_notify (G_OBJECT (self), "relation-type");
 }
 
@@ -787,7 +811,7 @@ const gchar *
 gdata_gd_postal_address_get_label (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->label;
+	return GET_FIELD (self->priv, FIELD_LABEL);
 }
 
 /**
@@ -806,8 +830,7 @@ gdata_gd_postal_address_set_label (GDataGDPostalAddress *self, const gchar *labe
 {
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 
-	g_free (self->priv->label);
-	self->priv->label = g_strdup (label);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_LABEL, label);
 	g_object_notify (G_OBJECT (self), "label");
 }
 
@@ -860,7 +883,7 @@ const gchar *
 gdata_gd_postal_address_get_mail_class (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->mail_class;
+	return GET_FIELD (self->priv, FIELD_MAIL_CLASS);
 }
 
 /**
@@ -880,8 +903,7 @@ gdata_gd_postal_address_set_mail_class (GDataGDPostalAddress *self, const gchar
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (mail_class == NULL || *mail_class != '\0');
 
-	g_free (self->priv->mail_class);
-	self->priv->mail_class = g_strdup (mail_class);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_MAIL_CLASS, mail_class);
 	g_object_notify (G_OBJECT (self), "mail-class");
 }
 
@@ -899,7 +921,7 @@ const gchar *
 gdata_gd_postal_address_get_usage (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->usage;
+	return GET_FIELD (self->priv, FIELD_USAGE);
 }
 
 /**
@@ -919,8 +941,7 @@ gdata_gd_postal_address_set_usage (GDataGDPostalAddress *self, const gchar *usag
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (usage == NULL || *usage != '\0');
 
-	g_free (self->priv->usage);
-	self->priv->usage = g_strdup (usage);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_USAGE, usage);
 	g_object_notify (G_OBJECT (self), "usage");
 }
 
@@ -938,7 +959,7 @@ const gchar *
 gdata_gd_postal_address_get_agent (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->agent;
+	return GET_FIELD (self->priv, FIELD_AGENT);
 }
 
 /**
@@ -958,8 +979,7 @@ gdata_gd_postal_address_set_agent (GDataGDPostalAddress *self, const gchar *agen
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (agent == NULL || *agent != '\0');
 
-	g_free (self->priv->agent);
-	self->priv->agent = g_strdup (agent);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_AGENT, agent);
 	g_object_notify (G_OBJECT (self), "agent");
 }
 
@@ -977,7 +997,7 @@ const gchar *
 gdata_gd_postal_address_get_house_name (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->house_name;
+	return GET_FIELD (self->priv, FIELD_HOUSE_NAME);
 }
 
 /**
@@ -997,8 +1017,7 @@ gdata_gd_postal_address_set_house_name (GDataGDPostalAddress *self, const gchar
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (house_name == NULL || *house_name != '\0');
 
-	g_free (self->priv->house_name);
-	self->priv->house_name = g_strdup (house_name);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_HOUSE_NAME, house_name);
 	g_object_notify (G_OBJECT (self), "house-name");
 }
 
@@ -1016,7 +1035,7 @@ const gchar *
 gdata_gd_postal_address_get_street (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->street;
+	return GET_FIELD (self->priv, FIELD_STREET);
 }
 
 /**
@@ -1036,8 +1055,7 @@ gdata_gd_postal_address_set_street (GDataGDPostalAddress *self, const gchar *str
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (street == NULL || *street != '\0');
 
-	g_free (self->priv->street);
-	self->priv->street = g_strdup (street);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_STREET, street);
 	g_object_notify (G_OBJECT (self), "street");
 }
 
@@ -1055,7 +1073,7 @@ const gchar *
 gdata_gd_postal_address_get_po_box (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->po_box;
+	return GET_FIELD (self->priv, FIELD_PO_BOX);
 }
 
 /**
@@ -1075,8 +1093,7 @@ gdata_gd_postal_address_set_po_box (GDataGDPostalAddress *self, const gchar *po_
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (po_box == NULL || *po_box != '\0');
 
-	g_free (self->priv->po_box);
-	self->priv->po_box = g_strdup (po_box);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_PO_BOX, po_box);
 	g_object_notify (G_OBJECT (self), "po-box");
 }
 
@@ -1094,7 +1111,7 @@ const gchar *
 gdata_gd_postal_address_get_neighborhood (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->neighborhood;
+	return GET_FIELD (self->priv, FIELD_NEIGHBORHOOD);
 }
 
 /**
@@ -1114,8 +1131,7 @@ gdata_gd_postal_address_set_neighborhood (GDataGDPostalAddress *self, const gcha
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (neighborhood == NULL || *neighborhood != '\0');
 
-	g_free (self->priv->neighborhood);
-	self->priv->neighborhood = g_strdup (neighborhood);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_NEIGHBORHOOD, neighborhood);
 	g_object_notify (G_OBJECT (self), "neighborhood");
 }
 
@@ -1133,7 +1149,7 @@ const gchar *
 gdata_gd_postal_address_get_city (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->city;
+	return GET_FIELD (self->priv, FIELD_CITY);
 }
 
 /**
@@ -1153,8 +1169,7 @@ gdata_gd_postal_address_set_city (GDataGDPostalAddress *self, const gchar *city)
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (city == NULL || *city != '\0');
 
-	g_free (self->priv->city);
-	self->priv->city = g_strdup (city);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_CITY, city);
 	g_object_notify (G_OBJECT (self), "city");
 }
 
@@ -1172,7 +1187,7 @@ const gchar *
 gdata_gd_postal_address_get_subregion (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->subregion;
+	return GET_FIELD (self->priv, FIELD_SUBREGION);
 }
 
 /**
@@ -1192,8 +1207,7 @@ gdata_gd_postal_address_set_subregion (GDataGDPostalAddress *self, const gchar *
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (subregion == NULL || *subregion != '\0');
 
-	g_free (self->priv->subregion);
-	self->priv->subregion = g_strdup (subregion);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_SUBREGION, subregion);
 	g_object_notify (G_OBJECT (self), "subregion");
 }
 
@@ -1211,7 +1225,7 @@ const gchar *
 gdata_gd_postal_address_get_region (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->region;
+	return GET_FIELD (self->priv, FIELD_REGION);
 }
 
 /**
@@ -1231,8 +1245,7 @@ gdata_gd_postal_address_set_region (GDataGDPostalAddress *self, const gchar *reg
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (region == NULL || *region != '\0');
 
-	g_free (self->priv->region);
-	self->priv->region = g_strdup (region);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_REGION, region);
 	g_object_notify (G_OBJECT (self), "region");
 }
 
@@ -1250,7 +1263,7 @@ const gchar *
 gdata_gd_postal_address_get_postcode (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->postcode;
+	return GET_FIELD (self->priv, FIELD_POSTCODE);
 }
 
 /**
@@ -1270,8 +1283,7 @@ gdata_gd_postal_address_set_postcode (GDataGDPostalAddress *self, const gchar *p
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (postcode == NULL || *postcode != '\0');
 
-	g_free (self->priv->postcode);
-	self->priv->postcode = g_strdup (postcode);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_POSTCODE, postcode);
 	g_object_notify (G_OBJECT (self), "postcode");
 }
 
@@ -1289,7 +1301,7 @@ const gchar *
 gdata_gd_postal_address_get_country (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->country;
+	return GET_FIELD (self->priv, FIELD_COUNTRY);
 }
 
 /**
@@ -1306,7 +1318,7 @@ const gchar *
 gdata_gd_postal_address_get_country_code (GDataGDPostalAddress *self)
 {
 	g_return_val_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self), NULL);
-	return self->priv->country_code;
+	return GET_FIELD (self->priv, FIELD_COUNTRY_CODE);
 }
 
 /**
@@ -1325,15 +1337,17 @@ gdata_gd_postal_address_get_country_code (GDataGDPostalAddress *self)
 void
 gdata_gd_postal_address_set_country (GDataGDPostalAddress *self, const gchar *country, const gchar *country_code)
 {
+	gchar *country_code_copy;
+
 	g_return_if_fail (GDATA_IS_GD_POSTAL_ADDRESS (self));
 	g_return_if_fail (country != NULL || country_code == NULL);
 	g_return_if_fail (country == NULL || *country != '\0');
 	g_return_if_fail (country_code == NULL || *country_code != '\0');
 
-	g_free (self->priv->country);
-	g_free (self->priv->country_code);
-	self->priv->country = g_strdup (country);
-	self->priv->country_code = g_strdup (country_code);
+	/* Setting the country invalidates @country_code if it's the current country code */
+	country_code_copy = g_strdup (country_code);
+	gdata_packed_strings_set (&(self->priv->strings), FIELD_COUNTRY, country);
+	gdata_packed_strings_take (&(self->priv->strings), FIELD_COUNTRY_CODE, country_code_copy);
 
 	g_object_freeze_notify (G_OBJECT (self));
 	g_object_notify (G_OBJECT (self), "country");
@@ -242,22 +242,16 @@ static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
 	GDataGDReminderPrivate *priv = GDATA_GD_REMINDER (parsable)->priv;
-	xmlChar *absolute_time, *relative_time;
+	xmlChar *relative_time;
 	gint64 absolute_time_int64;
 	gint relative_time_int = -1;
 	gboolean is_absolute_time = FALSE;
 
 	/* Absolute time */
-	absolute_time = xmlGetProp (root_node, (xmlChar*) "absoluteTime");
-	if (absolute_time != NULL) {
+	if (xmlHasProp (root_node, (xmlChar*) "absoluteTime") != NULL) {
 		is_absolute_time = TRUE;
-		if (gdata_parser_int64_from_iso8601 ((gchar*) absolute_time, &absolute_time_int64) == FALSE) {
-			/* Error */
-			gdata_parser_error_not_iso8601_format (root_node, (gchar*) absolute_time, error);
-			xmlFree (absolute_time);
+		if (gdata_parser_int64_time_from_property (root_node, "absoluteTime", TRUE, &absolute_time_int64, NULL, error) == FALSE)
 			return FALSE;
-		}
-		xmlFree (absolute_time);
 	}
 
 	/* Relative time */
@@ -295,9 +289,12 @@ pre_get_xml (GDataParsable *parsable, GString *xml_string)
 	GDataGDReminderPrivate *priv = GDATA_GD_REMINDER (parsable)->priv;
 
 	if (priv->relative_time == -1) {
-		gchar *absolute_time = gdata_parser_int64_to_iso8601 (priv->absolute_time);
-		g_string_append_printf (xml_string, " absoluteTime='%s'", absolute_time);
-		g_free (absolute_time);
+		gchar absolute_time[GDATA_PARSER_ISO8601_BUFFER_SIZE];
+		gsize length = gdata_parser_int64_to_iso8601_buffer (priv->absolute_time, absolute_time);
+
+		g_string_append (xml_string, " absoluteTime='");
+		g_string_append_len (xml_string, absolute_time, length);
+		g_string_append_c (xml_string, '\'');
 	} else {
 		g_string_append_printf (xml_string, " minutes='%i'", priv->relative_time);
 	}
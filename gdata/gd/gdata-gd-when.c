@@ -268,42 +268,23 @@ static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
 	GDataGDWhenPrivate *priv = GDATA_GD_WHEN (parsable)->priv;
-	xmlChar *start_time, *end_time;
 	gint64 start_time_int64, end_time_int64;
-	gboolean is_date = FALSE;
+	gboolean is_date, end_is_date;
 
-	/* Start time */
-	start_time = xmlGetProp (root_node, (xmlChar*) "startTime");
-	if (gdata_parser_int64_from_date ((gchar*) start_time, &start_time_int64) == TRUE) {
-		is_date = TRUE;
-	} else if (gdata_parser_int64_from_iso8601 ((gchar*) start_time, &start_time_int64) == FALSE) {
-		/* Error */
-		gdata_parser_error_not_iso8601_format (root_node, (gchar*) start_time, error);
-		xmlFree (start_time);
+	/* Start time; this may be a date or a date and time */
+	if (gdata_parser_int64_time_from_property (root_node, "startTime", TRUE, &start_time_int64, &is_date, error) == FALSE)
 		return FALSE;
-	}
-	xmlFree (start_time);
-
-	/* End time (optional) */
-	end_time = xmlGetProp (root_node, (xmlChar*) "endTime");
-	if (end_time != NULL) {
-		gboolean success;
 
-		if (is_date == TRUE)
-			success = gdata_parser_int64_from_date ((gchar*) end_time, &end_time_int64);
-		else
-			success = gdata_parser_int64_from_iso8601 ((gchar*) end_time, &end_time_int64);
-
-		if (success == FALSE) {
-			/* Error */
-			gdata_parser_error_not_iso8601_format (root_node, (gchar*) end_time, error);
-			xmlFree (end_time);
-			return FALSE;
-		}
+	/* End time (optional); this must be of the same form as the start time */
+	if (gdata_parser_int64_time_from_property (root_node, "endTime", FALSE, &end_time_int64, (is_date == TRUE) ? &end_is_date : NULL,
+	                                           error) == FALSE) {
+		return FALSE;
+	} else if (is_date == TRUE && end_time_int64 != -1 && end_is_date == FALSE) {
+		/* Error */
+		xmlChar *end_time = xmlGetProp (root_node, (xmlChar*) "endTime");
+		gdata_parser_error_not_iso8601_format (root_node, (gchar*) end_time, error);
 		xmlFree (end_time);
-	} else {
-		/* Give a default */
-		end_time_int64 = -1;
+		return FALSE;
 	}
 
 	priv->start_time = start_time_int64;
@@ -343,26 +324,27 @@ static void
 pre_get_xml (GDataParsable *parsable, GString *xml_string)
 {
 	GDataGDWhenPrivate *priv = GDATA_GD_WHEN (parsable)->priv;
-	gchar *start_time;
+	gchar time_buffer[MAX (GDATA_PARSER_DATE_BUFFER_SIZE, GDATA_PARSER_ISO8601_BUFFER_SIZE)];
+	gsize length;
 
 	if (priv->is_date == TRUE)
-		start_time = gdata_parser_date_from_int64 (priv->start_time);
+		length = gdata_parser_date_to_buffer (priv->start_time, time_buffer);
 	else
-		start_time = gdata_parser_int64_to_iso8601 (priv->start_time);
+		length = gdata_parser_int64_to_iso8601_buffer (priv->start_time, time_buffer);
 
-	g_string_append_printf (xml_string, " startTime='%s'", start_time);
-	g_free (start_time);
+	g_string_append (xml_string, " startTime='");
+	g_string_append_len (xml_string, time_buffer, length);
+	g_string_append_c (xml_string, '\'');
 
 	if (priv->end_time != -1) {
-		gchar *end_time;
-
 		if (priv->is_date == TRUE)
-			end_time = gdata_parser_date_from_int64 (priv->end_time);
+			length = gdata_parser_date_to_buffer (priv->end_time, time_buffer);
 		else
-			end_time = gdata_parser_int64_to_iso8601 (priv->end_time);
+			length = gdata_parser_int64_to_iso8601_buffer (priv->end_time, time_buffer);
 
-		g_string_append_printf (xml_string, " endTime='%s'", end_time);
-		g_free (end_time);
+		g_string_append (xml_string, " endTime='");
+		g_string_append_len (xml_string, time_buffer, length);
+		g_string_append_c (xml_string, '\'');
 	}
 
 	if (priv->value_string != NULL)
@@ -48,7 +48,7 @@ static void pre_get_xml (GDataParsable *parsable, GString *xml_string);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 
 struct _GDataGDWherePrivate {
-	gchar *relation_type;
+	const gchar *relation_type; /* interned */
 	gchar *value_string;
 	gchar *label;
 };
@@ -159,7 +159,6 @@ gdata_gd_where_finalize (GObject *object)
 {
 	GDataGDWherePrivate *priv = GDATA_GD_WHERE (object)->priv;
 
-	g_free (priv->relation_type);
 	g_free (priv->value_string);
 	g_free (priv->label);
 
@@ -214,16 +213,14 @@ gdata_gd_where_set_property (GObject *object, guint property_id, const GValue *v
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
-	xmlChar *rel;
+	const gchar *rel;
 	GDataGDWherePrivate *priv = GDATA_GD_WHERE (parsable)->priv;
 
-	rel = xmlGetProp (root_node, (xmlChar*) "rel");
-	if (rel != NULL && *rel == '\0') {
-		xmlFree (rel);
+	rel = gdata_parser_intern_property (root_node, "rel");
+	if (rel != NULL && *rel == '\0')
 		return gdata_parser_error_required_property_missing (root_node, "rel", error);
-	}
 
-	priv->relation_type = (gchar*) rel;
+	priv->relation_type = rel;
 	priv->value_string = (gchar*) xmlGetProp (root_node, (xmlChar*) "valueString");
 	priv->label = (gchar*) xmlGetProp (root_node, (xmlChar*) "label");
 
@@ -325,8 +322,7 @@ gdata_gd_where_set_relation_type (GDataGDWhere *self, const gchar *relation_type
 	g_return_if_fail (GDATA_IS_GD_WHERE (self));
 	g_return_if_fail (relation_type == NULL || *relation_type != '\0');
 
-	g_free (self->priv->relation_type);
-	self->priv->relation_type = g_strdup (relation_type);
+	self->priv->relation_type = g_intern_string (relation_type);
 	g_object_notify (G_OBJECT (self), "relation-type");
 }
 
@@ -48,7 +48,7 @@ static void pre_get_xml (GDataParsable *parsable, GString *xml_string);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 
 struct _GDataGDWhoPrivate {
-	gchar *relation_type;
+	const gchar *relation_type; /* interned */
 	gchar *value_string;
 	gchar *email_address;
 };
@@ -159,7 +159,6 @@ gdata_gd_who_finalize (GObject *object)
 {
 	GDataGDWhoPrivate *priv = GDATA_GD_WHO (object)->priv;
 
-	g_free (priv->relation_type);
 	g_free (priv->value_string);
 	g_free (priv->email_address);
 
@@ -214,23 +213,21 @@ gdata_gd_who_set_property (GObject *object, guint property_id, const GValue *val
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
-	xmlChar *rel, *email;
+	const gchar *rel;
+	xmlChar *email;
 	GDataGDWhoPrivate *priv = GDATA_GD_WHO (parsable)->priv;
 
-	rel = xmlGetProp (root_node, (xmlChar*) "rel");
-	if (rel != NULL && *rel == '\0') {
-		xmlFree (rel);
+	rel = gdata_parser_intern_property (root_node, "rel");
+	if (rel != NULL && *rel == '\0')
 		return gdata_parser_error_required_property_missing (root_node, "rel", error);
-	}
 
 	email = xmlGetProp (root_node, (xmlChar*) "email");
 	if (email != NULL && *email == '\0') {
-		xmlFree (rel);
 		xmlFree (email);
 		return gdata_parser_error_required_property_missing (root_node, "email", error);
 	}
 
-	priv->relation_type = (gchar*) rel;
+	priv->relation_type = rel;
 	priv->value_string = (gchar*) xmlGetProp (root_node, (xmlChar*) "valueString");
 	priv->email_address = (gchar*) email;
 
@@ -331,8 +328,7 @@ gdata_gd_who_set_relation_type (GDataGDWho *self, const gchar *relation_type)
 	g_return_if_fail (GDATA_IS_GD_WHO (self));
 	g_return_if_fail (relation_type == NULL || *relation_type != '\0');
 
-	g_free (self->priv->relation_type);
-	self->priv->relation_type = g_strdup (relation_type);
+	self->priv->relation_type = g_intern_string (relation_type);
 	g_object_notify (G_OBJECT (self), "relation-type");
 }
 
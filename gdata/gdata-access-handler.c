@@ -29,6 +29,12 @@
  *
  * For an example of inserting an access rule into an ACL, see the documentation for #GDataAccessRule.
  *
+ * To change a lot of rules at once (for example, to share an entry with many users), use gdata_access_handler_create_batch_operation() to send
+ * the changes in batch requests. The rules of many access handlers can be retrieved concurrently with gdata_access_handler_get_rules_multiple().
+ *
+ * If the same access control lists are retrieved repeatedly, set #GDataService:acl-cache-size to cache them against the ETags of their access
+ * handlers.
+ *
  * When implementing the interface, classes must implement an <function>is_owner_rule</function> function. It's optional to implement a
  * <function>get_authorization_domain</function> function, but if it's not implemented, any operations on the access handler's
  * #GDataAccessRule<!-- -->s will be performed unauthorized (i.e. as if by a non-logged-in user). This will not usually work.
@@ -88,10 +94,30 @@ _gdata_access_handler_get_rules (GDataAccessHandler *self, GDataService *service
 	GDataFeed *feed;
 	GDataLink *_link;
 	SoupMessage *message;
+	GBytes *cached_response;
 
 	_link = gdata_entry_look_up_link (GDATA_ENTRY (self), GDATA_LINK_ACCESS_CONTROL_LIST);
 	g_assert (_link != NULL);
 
+	/* If the rules for this version of the entry have been cached (see #GDataService:acl-cache-size), build the feed from them rather than
+	 * downloading them again. Parsing them afresh means each caller gets its own feed, and @progress_callback is called as usual. */
+	cached_response = _gdata_service_acl_cache_lookup (service, GDATA_ENTRY (self));
+	if (cached_response != NULL) {
+		gsize length;
+		const gchar *data = g_bytes_get_data (cached_response, &length);
+
+		if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
+			g_bytes_unref (cached_response);
+			return NULL;
+		}
+
+		feed = _gdata_feed_new_from_xml (GDATA_TYPE_FEED, data, length, GDATA_TYPE_ACCESS_RULE, progress_callback, progress_user_data,
+		                                 is_async, TRUE, error);
+		g_bytes_unref (cached_response);
+
+		return feed;
+	}
+
 	iface = GDATA_ACCESS_HANDLER_GET_IFACE (self);
 	if (iface->get_authorization_domain != NULL) {
 		domain = iface->get_authorization_domain (self);
@@ -104,7 +130,12 @@ _gdata_access_handler_get_rules (GDataAccessHandler *self, GDataService *service
 
 	g_assert (message->response_body->data != NULL);
 	feed = _gdata_feed_new_from_xml (GDATA_TYPE_FEED, message->response_body->data, message->response_body->length, GDATA_TYPE_ACCESS_RULE,
-	                                 progress_callback, progress_user_data, is_async, error);
+	                                 progress_callback, progress_user_data, is_async, TRUE, error);
+
+	/* Only cache responses which parsed successfully */
+	if (feed != NULL)
+		_gdata_service_acl_cache_insert (service, GDATA_ENTRY (self), gdata_link_get_uri (_link), message);
+
 	g_object_unref (message);
 
 	return feed;
@@ -198,6 +229,9 @@ gdata_access_handler_get_rules_async (GDataAccessHandler *self, GDataService *se
  * For each rule in the response feed, @progress_callback will be called in the main thread. If there was an error parsing the XML response,
  * a #GDataParserError will be returned.
  *
+ * If #GDataService:acl-cache-size is non-zero, the rules are cached, and are returned from the cache by later calls for as long as @self's ETag
+ * doesn't change and none of its rules are modified through @service.
+ *
  * Return value: (transfer full): a #GDataFeed of access control rules, or %NULL; unref with g_object_unref()
  *
  * Since: 0.3.0
@@ -213,3 +247,373 @@ gdata_access_handler_get_rules (GDataAccessHandler *self, GDataService *service,
 
 	return _gdata_access_handler_get_rules (self, service, cancellable, progress_callback, progress_user_data, FALSE, error);
 }
+
+/**
+ * gdata_access_handler_create_batch_operation:
+ * @self: a #GDataAccessHandler
+ * @service: a #GDataService
+ *
+ * Creates a new #GDataBatchOperation which sends its operations to the batch URI of @self's access control list, so that many
+ * #GDataAccessRule<!-- -->s can be inserted, updated and deleted using a few requests, rather than one request per rule. Add the rule changes to the
+ * operation with gdata_batch_operation_add_insertion(), gdata_batch_operation_add_update() and gdata_batch_operation_add_deletion(), and then run
+ * it with gdata_batch_operation_run(). The operation uses the authorization domain of @self, as returned by its
+ * <function>get_authorization_domain</function> function.
+ *
+ * If more rule changes are added than the server accepts in a single batch request, they're split into several requests automatically when the
+ * operation is run; see #GDataBatchOperation:max-operations-per-request.
+ *
+ * As with gdata_access_handler_get_rules(), only the owner of a #GDataAccessHandler may change its rules, and @self must have a
+ * %GDATA_LINK_ACCESS_CONTROL_LIST link.
+ *
+ * Return value: (transfer full): a new #GDataBatchOperation; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataBatchOperation *
+gdata_access_handler_create_batch_operation (GDataAccessHandler *self, GDataService *service)
+{
+	GDataAccessHandlerIface *iface;
+	GDataAuthorizationDomain *domain = NULL;
+	GDataBatchOperation *operation;
+	GDataLink *_link;
+	const gchar *acl_uri, *query_string;
+	gchar *batch_uri;
+
+	g_return_val_if_fail (GDATA_IS_ACCESS_HANDLER (self), NULL);
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+
+	_link = gdata_entry_look_up_link (GDATA_ENTRY (self), GDATA_LINK_ACCESS_CONTROL_LIST);
+	g_return_val_if_fail (_link != NULL, NULL);
+
+	iface = GDATA_ACCESS_HANDLER_GET_IFACE (self);
+	if (iface->get_authorization_domain != NULL) {
+		domain = iface->get_authorization_domain (self);
+	}
+
+	/* The batch URI of an ACL feed is the feed URI with "/batch" appended to its path, keeping any query parameters */
+	acl_uri = gdata_link_get_uri (_link);
+	query_string = strchr (acl_uri, '?');
+
+	if (query_string != NULL)
+		batch_uri = g_strdup_printf ("%.*s/batch%s", (int) (query_string - acl_uri), acl_uri, query_string);
+	else
+		batch_uri = g_strconcat (acl_uri, "/batch", NULL);
+
+	operation = g_object_new (GDATA_TYPE_BATCH_OPERATION,
+	                          "service", service,
+	                          "authorization-domain", domain,
+	                          "feed-uri", batch_uri,
+	                          "max-operations-per-request", GDATA_BATCH_MAX_OPERATIONS_PER_REQUEST,
+	                          NULL);
+	g_free (batch_uri);
+
+	return operation;
+}
+
+typedef struct {
+	GDataService *service;
+	GCancellable *cancellable;
+	GAsyncQueue *results; /* RuleResults */
+} GetRulesMultipleData;
+
+/* A rule from one of the access handlers, or the error from querying its rules. Once an access handler's query has finished, a RuleResult with
+ * neither a rule nor an error is pushed for it. */
+typedef struct {
+	GDataAccessHandler *access_handler;
+	GDataAccessRule *rule;
+	GError *error;
+	GDataAccessHandlerRuleCallback callback;
+	gpointer user_data;
+} RuleResult;
+
+typedef struct {
+	GDataAccessHandler *access_handler;
+	GetRulesMultipleData *data;
+} GetRulesMultipleProgressData;
+
+static RuleResult *
+rule_result_new (GDataAccessHandler *access_handler, GDataAccessRule *rule, GError *error)
+{
+	RuleResult *result = g_slice_new0 (RuleResult);
+
+	result->access_handler = g_object_ref (access_handler);
+	result->rule = (rule != NULL) ? g_object_ref (rule) : NULL;
+	result->error = error; /* transfer ownership */
+
+	return result;
+}
+
+static void
+rule_result_free (RuleResult *result)
+{
+	g_object_unref (result->access_handler);
+	if (result->rule != NULL)
+		g_object_unref (result->rule);
+	if (result->error != NULL)
+		g_error_free (result->error);
+
+	g_slice_free (RuleResult, result);
+}
+
+/* Run the user-supplied callback for a rule. This is designed to be used in an idle handler, so that the callback is run in the thread which
+ * started the query. */
+static gboolean
+rule_result_callback_cb (RuleResult *result)
+{
+	result->callback (result->access_handler, result->rule, result->error, result->user_data);
+	return FALSE;
+}
+
+static void
+get_rules_multiple_progress_cb (GDataEntry *entry, guint entry_key, guint entry_count, GetRulesMultipleProgressData *progress_data)
+{
+	/* Called in the access handler's thread as each of its rules is parsed, so that rules are streamed back without waiting for the whole feed */
+	g_async_queue_push (progress_data->data->results, rule_result_new (progress_data->access_handler, GDATA_ACCESS_RULE (entry), NULL));
+}
+
+static void
+get_rules_multiple_thread (GDataAccessHandler *access_handler, GetRulesMultipleData *data)
+{
+	GetRulesMultipleProgressData progress_data;
+	GDataFeed *feed = NULL;
+	GError *error = NULL;
+
+	progress_data.access_handler = access_handler;
+	progress_data.data = data;
+
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &error) == TRUE) {
+		/* Fall through */
+	} else if (gdata_entry_look_up_link (GDATA_ENTRY (access_handler), GDATA_LINK_ACCESS_CONTROL_LIST) == NULL) {
+		/* Entries which the user doesn't own don't link to their ACL */
+		g_set_error_literal (&error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_FORBIDDEN,
+		                     _("The entry does not have an access control list."));
+	} else {
+		feed = _gdata_access_handler_get_rules (access_handler, data->service, data->cancellable,
+		                                        (GDataQueryProgressCallback) get_rules_multiple_progress_cb, &progress_data, FALSE, &error);
+	}
+
+	if (feed != NULL)
+		g_object_unref (feed);
+
+	if (error != NULL)
+		g_async_queue_push (data->results, rule_result_new (access_handler, NULL, error));
+	g_async_queue_push (data->results, rule_result_new (access_handler, NULL, NULL));
+
+	g_object_unref (access_handler); /* ref transferred from the thread pool */
+}
+
+static gboolean
+get_rules_multiple (GDataService *service, GList *access_handlers, GCancellable *cancellable, GDataAccessHandlerRuleCallback rule_callback,
+                    gpointer rule_user_data, GMainContext *context, gboolean is_async, GError **error)
+{
+	GetRulesMultipleData data;
+	GThreadPool *pool;
+	GList *i;
+	guint n_pending = 0;
+
+	data.service = service;
+	data.cancellable = cancellable;
+	data.results = g_async_queue_new ();
+
+	/* Query the ACLs concurrently; they're all on the same host, so there's no point running more queries at once than the service has
+	 * connections to it. */
+	pool = g_thread_pool_new ((GFunc) get_rules_multiple_thread, &data, MAX (gdata_service_get_max_connections_per_host (service), 1), FALSE, NULL);
+
+	for (i = access_handlers; i != NULL; i = i->next) {
+		g_thread_pool_push (pool, g_object_ref (i->data), NULL);
+		n_pending++;
+	}
+
+	/* Deliver the rules as they arrive. As with gdata_commentable_query_comments_multiple(), only dispatch the callbacks in the thread-default
+	 * main context of the thread which started the query if it was started with gdata_access_handler_get_rules_multiple_async(). */
+	while (n_pending > 0) {
+		RuleResult *result = g_async_queue_pop (data.results);
+
+		if (result->rule == NULL && result->error == NULL) {
+			/* An access handler has finished */
+			n_pending--;
+			rule_result_free (result);
+			continue;
+		} else if (rule_callback == NULL) {
+			rule_result_free (result);
+			continue;
+		}
+
+		result->callback = rule_callback;
+		result->user_data = rule_user_data;
+
+		if (is_async == TRUE) {
+			_gdata_service_idle_add (context, (GSourceFunc) rule_result_callback_cb, result, (GDestroyNotify) rule_result_free);
+		} else {
+			rule_result_callback_cb (result);
+			rule_result_free (result);
+		}
+	}
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_async_queue_unref (data.results);
+
+	/* Errors for individual access handlers are reported to the callback; only cancellation of the whole operation is reported here */
+	return (g_cancellable_set_error_if_cancelled (cancellable, error) == FALSE);
+}
+
+/**
+ * gdata_access_handler_get_rules_multiple:
+ * @service: a #GDataService
+ * @access_handlers: (element-type GData.AccessHandler): a list of #GDataAccessHandler<!-- -->s to retrieve the access rules of
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @rule_callback: (allow-none) (scope call) (closure rule_user_data): a #GDataAccessHandlerRuleCallback to call for each rule, or %NULL
+ * @rule_user_data: (closure): data to pass to the @rule_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Retrieves the access rules of each of the #GDataAccessHandler<!-- -->s in @access_handlers, as by gdata_access_handler_get_rules(), querying
+ * several of them concurrently (up to the #GDataService:max-connections-per-host of @service). @rule_callback is called with each rule as soon as
+ * it's been parsed, paired with the #GDataAccessHandler it applies to, so the rules of all the access handlers are interleaved; the rules of each
+ * access handler are delivered in the order they appear in its rule feed. This allows the ACLs of a large number of entries to be audited without
+ * holding all of their rule feeds in memory at once.
+ *
+ * If retrieving an access handler's rules fails (for example, because it doesn't have an access control list, in which case
+ * %GDATA_SERVICE_ERROR_FORBIDDEN is used), @rule_callback is called once for it with the error, and the other access handlers are still queried.
+ * Such errors aren't returned in @error. All the queries share @cancellable: if it's cancelled, the remaining queries are abandoned (and
+ * @rule_callback is called with a %G_IO_ERROR_CANCELLED error for each of them), and %FALSE is returned with @error set.
+ *
+ * Return value: %TRUE if all the #GDataAccessHandler<!-- -->s were queried (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_access_handler_get_rules_multiple (GDataService *service, GList *access_handlers, GCancellable *cancellable,
+                                         GDataAccessHandlerRuleCallback rule_callback, gpointer rule_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = access_handlers; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_ACCESS_HANDLER (i->data), FALSE);
+
+	return get_rules_multiple (service, access_handlers, cancellable, rule_callback, rule_user_data, NULL, FALSE, error);
+}
+
+typedef struct {
+	GList *access_handlers;
+	GDataAccessHandlerRuleCallback rule_callback;
+	gpointer rule_user_data;
+	GDestroyNotify destroy_rule_user_data;
+	GMainContext *context;
+	gboolean success;
+} GetRulesMultipleAsyncData;
+
+static void
+get_rules_multiple_async_data_free (GetRulesMultipleAsyncData *data)
+{
+	g_list_free_full (data->access_handlers, g_object_unref);
+
+	if (data->destroy_rule_user_data != NULL)
+		data->destroy_rule_user_data (data->rule_user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (GetRulesMultipleAsyncData, data);
+}
+
+static void
+get_rules_multiple_async_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+{
+	GetRulesMultipleAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	data->success = get_rules_multiple (service, data->access_handlers, cancellable, data->rule_callback, data->rule_user_data, data->context, TRUE,
+	                                    &error);
+
+	if (data->success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_access_handler_get_rules_multiple_async:
+ * @service: a #GDataService
+ * @access_handlers: (element-type GData.AccessHandler): a list of #GDataAccessHandler<!-- -->s to retrieve the access rules of
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @rule_callback: (allow-none) (closure rule_user_data): a #GDataAccessHandlerRuleCallback to call for each rule, or %NULL
+ * @rule_user_data: (closure): data to pass to the @rule_callback function
+ * @destroy_rule_user_data: (allow-none): the function to call when @rule_callback will not be called any more, or %NULL. This function will be
+ * called with @rule_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the queries are finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Retrieves the access rules of each of the #GDataAccessHandler<!-- -->s in @access_handlers, passing them to @rule_callback as they are parsed, in
+ * idle functions in the thread-default main context of the thread which called this function (see g_main_context_push_thread_default()). @service and
+ * @access_handlers are reffed/copied when this function is called, so can safely be unreffed/freed after this function returns.
+ *
+ * For more details, see gdata_access_handler_get_rules_multiple(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_access_handler_get_rules_multiple_finish() to get the
+ * results of the operation. @rule_callback is guaranteed to have been called for every rule before @callback is called.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_access_handler_get_rules_multiple_async (GDataService *service, GList *access_handlers, GCancellable *cancellable,
+                                               GDataAccessHandlerRuleCallback rule_callback, gpointer rule_user_data,
+                                               GDestroyNotify destroy_rule_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	GetRulesMultipleAsyncData *data;
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_SERVICE (service));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = access_handlers; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_ACCESS_HANDLER (i->data));
+
+	data = g_slice_new0 (GetRulesMultipleAsyncData);
+	data->access_handlers = g_list_copy (access_handlers);
+	g_list_foreach (data->access_handlers, (GFunc) g_object_ref, NULL);
+	data->rule_callback = rule_callback;
+	data->rule_user_data = rule_user_data;
+	data->destroy_rule_user_data = destroy_rule_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (service), callback, user_data, gdata_access_handler_get_rules_multiple_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) get_rules_multiple_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) get_rules_multiple_async_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_access_handler_get_rules_multiple_finish:
+ * @service: the #GDataService passed to gdata_access_handler_get_rules_multiple_async()
+ * @result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous access rule query operation started with gdata_access_handler_get_rules_multiple_async().
+ *
+ * Return value: %TRUE if all the #GDataAccessHandler<!-- -->s were queried (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_access_handler_get_rules_multiple_finish (GDataService *service, GAsyncResult *result, GError **error)
+{
+	GetRulesMultipleAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service), gdata_access_handler_get_rules_multiple_async) == TRUE,
+	                      FALSE);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error) == TRUE)
+		return FALSE;
+
+	data = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
+	return data->success;
+}
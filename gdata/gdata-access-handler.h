@@ -27,6 +27,7 @@
 #include <gdata/gdata-service.h>
 #include <gdata/gdata-access-rule.h>
 #include <gdata/gdata-authorization-domain.h>
+#include <gdata/gdata-batch-operation.h>
 
 G_BEGIN_DECLS
 
@@ -76,6 +77,23 @@ typedef struct {
 	GDataAuthorizationDomain *(*get_authorization_domain) (GDataAccessHandler *self);
 } GDataAccessHandlerIface;
 
+/**
+ * GDataAccessHandlerRuleCallback:
+ * @access_handler: the #GDataAccessHandler whose rules were queried
+ * @rule: (allow-none): a #GDataAccessRule which applies to @access_handler, or %NULL
+ * @error: a #GError describing any error which occurred, or %NULL
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called for each rule retrieved by gdata_access_handler_get_rules_multiple(). If the query was successful, @rule will be one of
+ * the rules which apply to @access_handler and @error will be %NULL. Otherwise, the callback is called once for @access_handler with @rule set
+ * to %NULL and a descriptive error in @error.
+ *
+ * Both @rule and @error are owned by the caller; if the callback needs to keep @rule, it must reference it.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataAccessHandlerRuleCallback) (GDataAccessHandler *access_handler, GDataAccessRule *rule, GError *error, gpointer user_data);
+
 GType gdata_access_handler_get_type (void) G_GNUC_CONST;
 
 GDataFeed *gdata_access_handler_get_rules (GDataAccessHandler *self, GDataService *service, GCancellable *cancellable,
@@ -86,6 +104,16 @@ void gdata_access_handler_get_rules_async (GDataAccessHandler *self, GDataServic
                                            GDestroyNotify destroy_progress_user_data,
                                            GAsyncReadyCallback callback, gpointer user_data);
 
+GDataBatchOperation *gdata_access_handler_create_batch_operation (GDataAccessHandler *self,
+                                                                  GDataService *service) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+gboolean gdata_access_handler_get_rules_multiple (GDataService *service, GList *access_handlers, GCancellable *cancellable,
+                                                  GDataAccessHandlerRuleCallback rule_callback, gpointer rule_user_data, GError **error);
+void gdata_access_handler_get_rules_multiple_async (GDataService *service, GList *access_handlers, GCancellable *cancellable,
+                                                    GDataAccessHandlerRuleCallback rule_callback, gpointer rule_user_data,
+                                                    GDestroyNotify destroy_rule_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_access_handler_get_rules_multiple_finish (GDataService *service, GAsyncResult *result, GError **error);
+
 G_END_DECLS
 
 #endif /* !GDATA_ACCESS_HANDLER_H */
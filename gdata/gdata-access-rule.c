@@ -88,6 +88,7 @@
 
 static GObject *gdata_access_rule_constructor (GType type, guint n_construct_params, GObjectConstructParam *construct_params);
 static void gdata_access_rule_finalize (GObject *object);
+static void gdata_access_rule_notify (GObject *object, GParamSpec *pspec);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
 static void gdata_access_rule_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
@@ -95,10 +96,11 @@ static void gdata_access_rule_get_property (GObject *object, guint property_id,
 static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
 
 struct _GDataAccessRulePrivate {
-	gchar *role;
-	gchar *scope_type;
+	const gchar *role; /* interned */
+	const gchar *scope_type; /* interned */
 	gchar *scope_value;
 	gint64 edited;
+	gboolean syncing_title; /* TRUE while GDataEntry:title and GDataAccessRule:role are being kept in sync */
 };
 
 enum {
@@ -124,6 +126,7 @@ gdata_access_rule_class_init (GDataAccessRuleClass *klass)
 	gobject_class->finalize = gdata_access_rule_finalize;
 	gobject_class->get_property = gdata_access_rule_get_property;
 	gobject_class->set_property = gdata_access_rule_set_property;
+	gobject_class->notify = gdata_access_rule_notify;
 
 	parsable_class->parse_xml = parse_xml;
 	parsable_class->get_xml = get_xml;
@@ -195,35 +198,34 @@ gdata_access_rule_class_init (GDataAccessRuleClass *klass)
 	g_object_class_override_property (gobject_class, PROP_ETAG, "etag");
 }
 
-static void notify_role_cb (GDataAccessRule *self, GParamSpec *pspec, gpointer user_data);
-
 static void
-notify_title_cb (GDataAccessRule *self, GParamSpec *pspec, gpointer user_data)
+gdata_access_rule_init (GDataAccessRule *self)
 {
-	/* Update GDataAccessRule:role */
-	g_signal_handlers_block_by_func (self, notify_role_cb, self);
-	gdata_access_rule_set_role (self, gdata_entry_get_title (GDATA_ENTRY (self)));
-	g_signal_handlers_unblock_by_func (self, notify_role_cb, self);
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_ACCESS_RULE, GDataAccessRulePrivate);
+	self->priv->edited = -1;
 }
 
+/* GDataAccessRule:role is linked to GDataEntry:title. They're kept in sync from the class' notify handler, rather than by connecting to the notify
+ * signal of each instance, since rule feeds can contain a lot of rules and signal handlers aren't free. */
 static void
-notify_role_cb (GDataAccessRule *self, GParamSpec *pspec, gpointer user_data)
+gdata_access_rule_notify (GObject *object, GParamSpec *pspec)
 {
-	/* Update GDataEntry:title */
-	g_signal_handlers_block_by_func (self, notify_title_cb, self);
-	gdata_entry_set_title (GDATA_ENTRY (self), gdata_access_rule_get_role (self));
-	g_signal_handlers_unblock_by_func (self, notify_title_cb, self);
-}
+	GDataAccessRule *self = GDATA_ACCESS_RULE (object);
 
-static void
-gdata_access_rule_init (GDataAccessRule *self)
-{
-	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_ACCESS_RULE, GDataAccessRulePrivate);
-	self->priv->edited = -1;
+	if (self->priv->syncing_title == FALSE) {
+		self->priv->syncing_title = TRUE;
+
+		if (strcmp (pspec->name, "title") == 0)
+			gdata_access_rule_set_role (self, gdata_entry_get_title (GDATA_ENTRY (self)));
+		else if (strcmp (pspec->name, "role") == 0)
+			gdata_entry_set_title (GDATA_ENTRY (self), gdata_access_rule_get_role (self));
 
-	/* Listen to change notifications for the entry's title, since it's linked to GDataAccessRule:role */
-	g_signal_connect (self, "notify::title", (GCallback) notify_title_cb, self);
-	g_signal_connect (self, "notify::role", (GCallback) notify_role_cb, self);
+		self->priv->syncing_title = FALSE;
+	}
+
+	/* Chain up to the parent class */
+	if (G_OBJECT_CLASS (gdata_access_rule_parent_class)->notify != NULL)
+		G_OBJECT_CLASS (gdata_access_rule_parent_class)->notify (object, pspec);
 }
 
 static GObject *
@@ -245,8 +247,8 @@ gdata_access_rule_constructor (GType type, guint n_construct_params, GObjectCons
 		priv->edited = time_val.tv_sec;
 
 		/* Set up the role and scope type */
-		priv->role = g_strdup (GDATA_ACCESS_ROLE_NONE);
-		priv->scope_type = g_strdup (GDATA_ACCESS_SCOPE_DEFAULT);
+		priv->role = g_intern_static_string (GDATA_ACCESS_ROLE_NONE);
+		priv->scope_type = g_intern_static_string (GDATA_ACCESS_SCOPE_DEFAULT);
 	}
 
 	return object;
@@ -257,8 +259,6 @@ gdata_access_rule_finalize (GObject *object)
 {
 	GDataAccessRulePrivate *priv = GDATA_ACCESS_RULE (object)->priv;
 
-	g_free (priv->role);
-	g_free (priv->scope_type);
 	g_free (priv->scope_value);
 
 	/* Chain up to the parent class */
@@ -304,8 +304,7 @@ gdata_access_rule_set_property (GObject *object, guint property_id, const GValue
 			gdata_access_rule_set_role (self, g_value_get_string (value));
 			break;
 		case PROP_SCOPE_TYPE:
-			g_free (self->priv->scope_type);
-			self->priv->scope_type = g_value_dup_string (value);
+			self->priv->scope_type = g_intern_string (g_value_get_string (value));
 			g_object_notify (object, "scope-type");
 			break;
 		case PROP_SCOPE_VALUE:
@@ -334,16 +333,17 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		return success;
 	} else if (gdata_parser_is_namespace (node, "http://schemas.google.com/acl/2007") == TRUE) {
 		if (xmlStrcmp (node->name, (xmlChar*) "role") == 0) {
-			/* gAcl:role */
-			xmlChar *role = xmlGetProp (node, (xmlChar*) "value");
+			/* gAcl:role; roles and scope types are drawn from small sets, so intern them to keep large rule feeds cheap */
+			const gchar *role = gdata_parser_intern_property (node, "value");
 			if (role == NULL)
 				return gdata_parser_error_required_property_missing (node, "value", error);
-			self->priv->role = (gchar*) role;
+			self->priv->role = role;
 		} else if (xmlStrcmp (node->name, (xmlChar*) "scope") == 0) {
 			/* gAcl:scope */
-			xmlChar *scope_type, *scope_value;
+			const gchar *scope_type;
+			xmlChar *scope_value;
 
-			scope_type = xmlGetProp (node, (xmlChar*) "type");
+			scope_type = gdata_parser_intern_property (node, "type");
 			if (scope_type == NULL)
 				return gdata_parser_error_required_property_missing (node, "type", error);
 
@@ -351,12 +351,10 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 
 			/* The @value property is required for all scope types except "default".
 			 * See: https://developers.google.com/google-apps/calendar/v2/reference#gacl_reference */
-			if (xmlStrcmp (scope_type, (xmlChar*) GDATA_ACCESS_SCOPE_DEFAULT) != 0 && scope_value == NULL) {
-				xmlFree (scope_type);
+			if (strcmp (scope_type, GDATA_ACCESS_SCOPE_DEFAULT) != 0 && scope_value == NULL)
 				return gdata_parser_error_required_property_missing (node, "value", error);
-			}
 
-			self->priv->scope_type = (gchar*) scope_type;
+			self->priv->scope_type = scope_type;
 			self->priv->scope_value = (gchar*) scope_value;
 		} else {
 			return GDATA_PARSABLE_CLASS (gdata_access_rule_parent_class)->parse_xml (parsable, doc, node, user_data, error);
@@ -437,8 +435,7 @@ gdata_access_rule_set_role (GDataAccessRule *self, const gchar *role)
 {
 	g_return_if_fail (GDATA_IS_ACCESS_RULE (self));
 
-	g_free (self->priv->role);
-	self->priv->role = g_strdup (role);
+	self->priv->role = g_intern_string (role);
 	g_object_notify (G_OBJECT (self), "role");
 }
 
@@ -483,8 +480,7 @@ gdata_access_rule_set_scope (GDataAccessRule *self, const gchar *type, const gch
 	g_return_if_fail (type != NULL);
 	g_return_if_fail ((strcmp (type, GDATA_ACCESS_SCOPE_DEFAULT) == 0 && value == NULL) || value != NULL);
 
-	g_free (self->priv->scope_type);
-	self->priv->scope_type = g_strdup (type);
+	self->priv->scope_type = g_intern_string (type);
 
 	g_free (self->priv->scope_value);
 	self->priv->scope_value = g_strdup (value);
@@ -51,14 +51,22 @@
  * It must be noted that all #GDataAuthorizer implementations must be thread safe, as methods such as gdata_authorizer_refresh_authorization() may be
  * called from any thread (such as the thread performing an asynchronous query operation) at any time.
  *
+ * Implementations which may have to wait before they can authorize a request, such as those which fetch access tokens on demand, should implement
+ * gdata_authorizer_process_request_async() as well as gdata_authorizer_process_request(). #GDataService uses the asynchronous version for
+ * asynchronous operations, so that they never block the thread they were started from while waiting for the authorizer.
+ *
  * Examples of code using #GDataAuthorizer can be found in the documentation for the various implementations of the #GDataAuthorizer interface.
  *
  * Since: 0.9.0
  */
 
+#include <config.h>
 #include <glib.h>
+#include <string.h>
 
 #include "gdata-authorizer.h"
+#include "gdata-private.h"
+#include "gdata-trace.h"
 
 G_DEFINE_INTERFACE (GDataAuthorizer, gdata_authorizer, G_TYPE_OBJECT)
 
@@ -99,7 +107,106 @@ gdata_authorizer_process_request (GDataAuthorizer *self, GDataAuthorizationDomai
 	iface = GDATA_AUTHORIZER_GET_IFACE (self);
 	g_assert (iface->process_request != NULL);
 
+	GDATA_TRACE2 (auth_process_start, domain, message);
 	iface->process_request (self, domain, message);
+	GDATA_TRACE2 (auth_process_end, domain, message);
+}
+
+/**
+ * gdata_authorizer_process_request_async:
+ * @self: a #GDataAuthorizer
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @message: the query to process
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the query has been processed
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Processes @message asynchronously, in the same way as gdata_authorizer_process_request(). This allows #GDataAuthorizer implementations which may
+ * have to wait for something before they can authorize a request (such as an access token being fetched) to do so without blocking the calling
+ * thread. For more details, see gdata_authorizer_process_request(), which is the synchronous version of this method.
+ *
+ * If the #GDataAuthorizer class doesn't implement an asynchronous version of the method, gdata_authorizer_process_request() is called immediately
+ * and @callback is called from an idle callback once it's finished.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_authorizer_process_request_finish() to get the results of the
+ * operation.
+ *
+ * This method is thread safe.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_authorizer_process_request_async (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message, GCancellable *cancellable,
+                                        GAsyncReadyCallback callback, gpointer user_data)
+{
+	GDataAuthorizerInterface *iface;
+	GSimpleAsyncResult *result;
+	GError *error = NULL;
+
+	g_return_if_fail (GDATA_IS_AUTHORIZER (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (SOUP_IS_MESSAGE (message));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	iface = GDATA_AUTHORIZER_GET_IFACE (self);
+
+	/* Either both _async() and _finish() must be defined, or they must both be undefined. */
+	g_assert ((iface->process_request_async == NULL && iface->process_request_finish == NULL) ||
+	          (iface->process_request_async != NULL && iface->process_request_finish != NULL));
+
+	if (iface->process_request_async != NULL) {
+		iface->process_request_async (self, domain, message, cancellable, callback, user_data);
+		return;
+	}
+
+	/* If the _async() method isn't implemented, process the request synchronously and return the result in a callback. process_request() has
+	 * to be thread safe, so it's assumed not to block for long. */
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_authorizer_process_request_async);
+
+	if (g_cancellable_set_error_if_cancelled (cancellable, &error) == TRUE) {
+		g_simple_async_result_take_error (result, error);
+	} else {
+		gdata_authorizer_process_request (self, domain, message);
+	}
+
+	g_simple_async_result_complete_in_idle (result);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_authorizer_process_request_finish:
+ * @self: a #GDataAuthorizer
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous request processing operation for the #GDataAuthorizer, as started with gdata_authorizer_process_request_async().
+ *
+ * If the operation fails (for example, because it was cancelled), the query may not have been authorized, and should not be sent.
+ *
+ * This method is thread safe.
+ *
+ * Return value: %TRUE if the query was processed, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_authorizer_process_request_finish (GDataAuthorizer *self, GAsyncResult *async_result, GError **error)
+{
+	GDataAuthorizerInterface *iface;
+
+	g_return_val_if_fail (GDATA_IS_AUTHORIZER (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	iface = GDATA_AUTHORIZER_GET_IFACE (self);
+
+	if (iface->process_request_finish != NULL) {
+		return iface->process_request_finish (self, async_result, error);
+	}
+
+	g_warn_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), gdata_authorizer_process_request_async) == TRUE);
+
+	return (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == FALSE) ? TRUE : FALSE;
 }
 
 /**
@@ -146,6 +253,129 @@ gdata_authorizer_is_authorized_for_domain (GDataAuthorizer *self, GDataAuthoriza
 	return iface->is_authorized_for_domain (self, domain);
 }
 
+/* Authorization refreshes are coalesced per #GDataAuthorizer: if a refresh is requested while one is already in progress (typically because several
+ * requests have all just received a 401 response for the same expired token), the new caller waits for the in-progress refresh to finish and shares
+ * its result, rather than making another request to the authorization server. */
+typedef struct {
+	GMutex mutex;
+	GCond cond;
+	gboolean in_progress; /* whether a refresh is currently in progress */
+	guint generation; /* incremented every time a refresh finishes */
+	gboolean success; /* result of the last refresh to finish */
+	GError *error; /* error from the last refresh to finish, or %NULL */
+	GSList *waiters; /* GSimpleAsyncResults of async callers waiting on the in-progress refresh */
+	gint64 expiry_time; /* monotonic time the current authorization expires at, or 0 if unknown */
+} RefreshData;
+
+#define REFRESH_DATA_KEY "gdata-authorizer-refresh-data"
+
+/* How long before a known expiry time to proactively refresh the authorization, in microseconds */
+#define PROACTIVE_REFRESH_MARGIN (60 * G_USEC_PER_SEC)
+
+static void
+refresh_data_free (RefreshData *data)
+{
+	g_assert (data->in_progress == FALSE);
+	g_assert (data->waiters == NULL);
+
+	g_clear_error (&data->error);
+	g_cond_clear (&data->cond);
+	g_mutex_clear (&data->mutex);
+	g_slice_free (RefreshData, data);
+}
+
+static RefreshData *
+get_refresh_data (GDataAuthorizer *self)
+{
+	static GMutex creation_mutex;
+	RefreshData *data;
+
+	g_mutex_lock (&creation_mutex);
+
+	data = g_object_get_data (G_OBJECT (self), REFRESH_DATA_KEY);
+
+	if (data == NULL) {
+		data = g_slice_new0 (RefreshData);
+		g_mutex_init (&data->mutex);
+		g_cond_init (&data->cond);
+		g_object_set_data_full (G_OBJECT (self), REFRESH_DATA_KEY, data, (GDestroyNotify) refresh_data_free);
+	}
+
+	g_mutex_unlock (&creation_mutex);
+
+	return data;
+}
+
+typedef struct {
+	GCancellable *cancellable;
+	gboolean success;
+} RefreshAsyncData;
+
+static void
+refresh_async_data_free (RefreshAsyncData *data)
+{
+	if (data->cancellable != NULL)
+		g_object_unref (data->cancellable);
+
+	g_slice_free (RefreshAsyncData, data);
+}
+
+static void
+complete_refresh_async (GSimpleAsyncResult *result, gboolean success, const GError *error)
+{
+	RefreshAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+
+	data->success = success;
+	if (error != NULL)
+		g_simple_async_result_set_from_error (result, error);
+}
+
+/* Record the result of the refresh which was in progress, wake up any synchronous waiters and complete any asynchronous ones. If the refresh was
+ * cancelled, the waiters (which weren't cancelled themselves) are told a refresh was not attempted, rather than being given the cancellation error. */
+static void
+finish_refresh (RefreshData *data, gboolean success, const GError *error)
+{
+	GSList *waiters, *i;
+	gboolean cancelled;
+
+	cancelled = (error != NULL && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == TRUE) ? TRUE : FALSE;
+
+	g_mutex_lock (&data->mutex);
+
+	g_assert (data->in_progress == TRUE);
+
+	data->in_progress = FALSE;
+	data->generation++;
+	data->success = success;
+	g_clear_error (&data->error);
+	data->error = (error != NULL && cancelled == FALSE) ? g_error_copy (error) : NULL;
+
+	waiters = data->waiters;
+	data->waiters = NULL;
+
+	g_cond_broadcast (&data->cond);
+	g_mutex_unlock (&data->mutex);
+
+	for (i = waiters; i != NULL; i = i->next) {
+		GSimpleAsyncResult *result = i->data;
+
+		complete_refresh_async (result, success, (cancelled == FALSE) ? error : NULL);
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+	}
+
+	g_slist_free (waiters);
+}
+
+static void
+waiter_cancelled_cb (GCancellable *cancellable, RefreshData *data)
+{
+	/* Wake up the waiters so they can notice the cancellation */
+	g_mutex_lock (&data->mutex);
+	g_cond_broadcast (&data->cond);
+	g_mutex_unlock (&data->mutex);
+}
+
 /**
  * gdata_authorizer_refresh_authorization:
  * @self: a #GDataAuthorizer
@@ -168,6 +398,10 @@ gdata_authorizer_is_authorized_for_domain (GDataAuthorizer *self, GDataAuthoriza
  * Some #GDataAuthorizer implementations may not support refreshing authorization tokens at all; for example if doing so requires user interaction.
  * %FALSE will be returned immediately in that case and @error will not be set.
  *
+ * Concurrent refreshes are coalesced: if a refresh of @self is already in progress (started by this method or by
+ * gdata_authorizer_refresh_authorization_async(), in any thread), this method waits for it to finish and returns its result, rather than starting
+ * another refresh. If the in-progress refresh is cancelled, %FALSE is returned without an error. (Since: 0.15.0)
+ *
  * This method is thread safe.
  *
  * Return value: %TRUE if an authorization refresh was attempted and was successful, %FALSE if a refresh wasn't attempted or was unsuccessful
@@ -178,6 +412,9 @@ gboolean
 gdata_authorizer_refresh_authorization (GDataAuthorizer *self, GCancellable *cancellable, GError **error)
 {
 	GDataAuthorizerInterface *iface;
+	RefreshData *data;
+	GError *child_error = NULL;
+	gboolean success;
 
 	g_return_val_if_fail (GDATA_IS_AUTHORIZER (self), FALSE);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
@@ -190,21 +427,98 @@ gdata_authorizer_refresh_authorization (GDataAuthorizer *self, GCancellable *can
 		return FALSE;
 	}
 
-	return iface->refresh_authorization (self, cancellable, error);
+	data = get_refresh_data (self);
+
+	g_mutex_lock (&data->mutex);
+
+	if (data->in_progress == TRUE) {
+		guint generation = data->generation;
+		gulong cancelled_signal = 0;
+
+		/* Another thread's already refreshing the authorization, so wait for it to finish and use its result. The cancellable has to be
+		 * connected to without the mutex held, as g_cancellable_connect() calls the callback immediately if it's already cancelled. */
+		if (cancellable != NULL) {
+			g_mutex_unlock (&data->mutex);
+			cancelled_signal = g_cancellable_connect (cancellable, (GCallback) waiter_cancelled_cb, data, NULL);
+			g_mutex_lock (&data->mutex);
+		}
+
+		while (data->generation == generation && (cancellable == NULL || g_cancellable_is_cancelled (cancellable) == FALSE)) {
+			g_cond_wait (&data->cond, &data->mutex);
+		}
+
+		if (data->generation != generation) {
+			success = data->success;
+			if (data->error != NULL)
+				child_error = g_error_copy (data->error);
+		} else {
+			success = FALSE;
+			g_cancellable_set_error_if_cancelled (cancellable, &child_error);
+		}
+
+		g_mutex_unlock (&data->mutex);
+
+		if (cancelled_signal != 0)
+			g_cancellable_disconnect (cancellable, cancelled_signal);
+
+		if (child_error != NULL)
+			g_propagate_error (error, child_error);
+
+		return success;
+	}
+
+	/* Perform the refresh ourselves */
+	data->in_progress = TRUE;
+	g_mutex_unlock (&data->mutex);
+
+	GDATA_TRACE1 (auth_refresh_start, self);
+	success = iface->refresh_authorization (self, cancellable, &child_error);
+	GDATA_TRACE2 (auth_refresh_end, self, success);
+
+	finish_refresh (data, success, child_error);
+
+	if (child_error != NULL)
+		g_propagate_error (error, child_error);
+
+	return success;
+}
+
+static void
+refresh_authorization_thread (GSimpleAsyncResult *result, GDataAuthorizer *authorizer, GCancellable *_cancellable)
+{
+	RefreshAsyncData *async_data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+	gboolean success = FALSE;
+
+	/* Refresh the authorisation and return. The real cancellable is in @async_data, since the thread's run without one, so that it's always
+	 * run and always calls finish_refresh(). */
+	if (g_cancellable_set_error_if_cancelled (async_data->cancellable, &error) == FALSE) {
+		GDATA_TRACE1 (auth_refresh_start, authorizer);
+		success = GDATA_AUTHORIZER_GET_IFACE (authorizer)->refresh_authorization (authorizer, async_data->cancellable, &error);
+		GDATA_TRACE2 (auth_refresh_end, authorizer, success);
+	}
+
+	finish_refresh (get_refresh_data (authorizer), success, error);
+	complete_refresh_async (result, success, error);
+
+	g_clear_error (&error);
 }
 
 static void
-refresh_authorization_thread (GSimpleAsyncResult *result, GDataAuthorizer *authorizer, GCancellable *cancellable)
+refresh_authorization_async_cb (GDataAuthorizer *authorizer, GAsyncResult *async_result, GSimpleAsyncResult *result)
 {
 	GError *error = NULL;
+	gboolean success;
 
-	/* Refresh the authorisation and return */
-	gdata_authorizer_refresh_authorization (authorizer, cancellable, &error);
+	success = GDATA_AUTHORIZER_GET_IFACE (authorizer)->refresh_authorization_finish (authorizer, async_result, &error);
+	GDATA_TRACE2 (auth_refresh_end, authorizer, success);
 
-	if (error != NULL) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-	}
+	finish_refresh (get_refresh_data (authorizer), success, error);
+	complete_refresh_async (result, success, error);
+	g_simple_async_result_complete (result);
+
+	g_clear_error (&error);
+	g_object_unref (result);
 }
 
 /**
@@ -221,6 +535,9 @@ refresh_authorization_thread (GSimpleAsyncResult *result, GDataAuthorizer *autho
  * doesn't implement #GDataAuthorizerInterface.refresh_authorization_async but does implement #GDataAuthorizerInterface.refresh_authorization, the
  * latter will be called from a new thread to make it asynchronous.
  *
+ * As with the synchronous version, if a refresh of @self is already in progress, the operation finishes when that refresh does, with its result.
+ * In that case, @cancellable is not checked. (Since: 0.15.0)
+ *
  * When the authorization refresh operation is finished, @callback will be called. You can then call gdata_authorizer_refresh_authorization_finish()
  * to get the results of the operation.
  *
@@ -232,6 +549,9 @@ void
 gdata_authorizer_refresh_authorization_async (GDataAuthorizer *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
 {
 	GDataAuthorizerInterface *iface;
+	GSimpleAsyncResult *result;
+	RefreshAsyncData *async_data;
+	RefreshData *data;
 
 	g_return_if_fail (GDATA_IS_AUTHORIZER (self));
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
@@ -242,26 +562,43 @@ gdata_authorizer_refresh_authorization_async (GDataAuthorizer *self, GCancellabl
 	g_assert ((iface->refresh_authorization_async == NULL && iface->refresh_authorization_finish == NULL) ||
 	          (iface->refresh_authorization_async != NULL && iface->refresh_authorization_finish != NULL));
 
-	if (iface->refresh_authorization_async != NULL) {
-		/* Call the method */
-		iface->refresh_authorization_async (self, cancellable, callback, user_data);
-	} else if (iface->refresh_authorization != NULL) {
-		/* If the _async() method isn't implemented, fall back to running the sync method in a thread */
-		GSimpleAsyncResult *result = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
-		                                                        gdata_authorizer_refresh_authorization_async);
-		g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) refresh_authorization_thread, G_PRIORITY_DEFAULT, cancellable);
-		g_object_unref (result);
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_authorizer_refresh_authorization_async);
+	async_data = g_slice_new0 (RefreshAsyncData);
+	async_data->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+	g_simple_async_result_set_op_res_gpointer (result, async_data, (GDestroyNotify) refresh_async_data_free);
 
-		return;
-	} else {
+	if (iface->refresh_authorization_async == NULL && iface->refresh_authorization == NULL) {
 		/* If neither are implemented, immediately return FALSE with no error in a callback */
-		GSimpleAsyncResult *result = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
-		                                                        gdata_authorizer_refresh_authorization_async);
 		g_simple_async_result_complete_in_idle (result);
 		g_object_unref (result);
 
 		return;
 	}
+
+	data = get_refresh_data (self);
+
+	g_mutex_lock (&data->mutex);
+
+	if (data->in_progress == TRUE) {
+		/* Wait for the in-progress refresh to finish, and use its result. finish_refresh() takes ownership of the reference. */
+		data->waiters = g_slist_prepend (data->waiters, result);
+		g_mutex_unlock (&data->mutex);
+
+		return;
+	}
+
+	data->in_progress = TRUE;
+	g_mutex_unlock (&data->mutex);
+
+	if (iface->refresh_authorization_async != NULL) {
+		/* Call the method; refresh_authorization_async_cb() takes ownership of the reference */
+		GDATA_TRACE1 (auth_refresh_start, self);
+		iface->refresh_authorization_async (self, cancellable, (GAsyncReadyCallback) refresh_authorization_async_cb, result);
+	} else {
+		/* If the _async() method isn't implemented, fall back to running the sync method in a thread */
+		g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) refresh_authorization_thread, G_PRIORITY_DEFAULT, NULL);
+		g_object_unref (result);
+	}
 }
 
 /**
@@ -281,32 +618,198 @@ gdata_authorizer_refresh_authorization_async (GDataAuthorizer *self, GCancellabl
 gboolean
 gdata_authorizer_refresh_authorization_finish (GDataAuthorizer *self, GAsyncResult *async_result, GError **error)
 {
-	GDataAuthorizerInterface *iface;
+	RefreshAsyncData *data;
 
 	g_return_val_if_fail (GDATA_IS_AUTHORIZER (self), FALSE);
 	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
+	g_warn_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), gdata_authorizer_refresh_authorization_async) == TRUE);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == TRUE) {
+		return FALSE;
+	}
+
+	data = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (async_result));
+
+	return data->success;
+}
+
+/**
+ * gdata_authorizer_save_state:
+ * @self: a #GDataAuthorizer
+ *
+ * Returns the #GDataAuthorizer's current authorization state, such as the authorization tokens it holds, so that it can be stored and later restored
+ * into a new #GDataAuthorizer of the same type using gdata_authorizer_restore_state(). This allows short-lived processes to reuse an existing
+ * authorization, rather than having to go through the authentication and authorization process again every time they start.
+ *
+ * The state is returned as a #GVariant of type <type>a{sv}</type>, whose contents are specific to the #GDataAuthorizer implementation. It can be
+ * serialised using g_variant_get_data() and deserialised using g_variant_new_from_data(), and should be stored using a secure storage mechanism
+ * such as the user's keyring, since it contains secrets which grant access to the user's data. Note that the #GVariant is not stored in
+ * non-pageable memory.
+ *
+ * If the #GDataAuthorizer implementation doesn't support saving its state, %NULL is returned.
+ *
+ * This method is thread safe.
+ *
+ * Return value: (transfer full) (allow-none): the authorizer's state, or %NULL; unref with g_variant_unref()
+ *
+ * Since: 0.15.0
+ */
+GVariant *
+gdata_authorizer_save_state (GDataAuthorizer *self)
+{
+	GDataAuthorizerInterface *iface;
+	GVariant *state;
+
+	g_return_val_if_fail (GDATA_IS_AUTHORIZER (self), NULL);
+
 	iface = GDATA_AUTHORIZER_GET_IFACE (self);
 
-	/* Either both _async() and _finish() must be defined, or they must both be undefined. */
-	g_assert ((iface->refresh_authorization_async == NULL && iface->refresh_authorization_finish == NULL) ||
-	          (iface->refresh_authorization_async != NULL && iface->refresh_authorization_finish != NULL));
+	/* Either both save_state() and restore_state() must be defined, or they must both be undefined. */
+	g_assert ((iface->save_state == NULL) == (iface->restore_state == NULL));
 
-	if (iface->refresh_authorization_finish != NULL) {
-		/* Call the method */
-		return iface->refresh_authorization_finish (self, async_result, error);
-	} else if (iface->refresh_authorization != NULL) {
-		/* If the _async() method isn't implemented, fall back to finishing off running the sync method in a thread */
-		g_warn_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), gdata_authorizer_refresh_authorization_async) == TRUE);
+	if (iface->save_state == NULL) {
+		return NULL;
+	}
 
-		if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == TRUE) {
-			return FALSE;
-		}
+	state = iface->save_state (self);
+	g_assert (state == NULL || (g_variant_is_floating (state) == FALSE && g_variant_is_of_type (state, G_VARIANT_TYPE_VARDICT) == TRUE));
+
+	return state;
+}
+
+/**
+ * gdata_authorizer_restore_state:
+ * @self: a #GDataAuthorizer
+ * @state: an <type>a{sv}</type> #GVariant, as returned by gdata_authorizer_save_state()
+ * @error: a #GError, or %NULL
+ *
+ * Restores authorization state previously returned by gdata_authorizer_save_state() on a #GDataAuthorizer of the same type, replacing @self's
+ * current state. Once this has returned, @self can be used to authorize requests without re-authenticating (for as long as the restored
+ * authorization remains valid with the online service).
+ *
+ * If @state is invalid, or is for a different type of #GDataAuthorizer, %G_IO_ERROR_INVALID_DATA will be returned and @self's state will be left
+ * unchanged. If the #GDataAuthorizer implementation doesn't support restoring its state, %G_IO_ERROR_NOT_SUPPORTED will be returned.
+ *
+ * This method is thread safe.
+ *
+ * Return value: %TRUE if the state was restored successfully, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_authorizer_restore_state (GDataAuthorizer *self, GVariant *state, GError **error)
+{
+	GDataAuthorizerInterface *iface;
+
+	g_return_val_if_fail (GDATA_IS_AUTHORIZER (self), FALSE);
+	g_return_val_if_fail (state != NULL && g_variant_is_of_type (state, G_VARIANT_TYPE_VARDICT) == TRUE, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	iface = GDATA_AUTHORIZER_GET_IFACE (self);
+
+	/* Either both save_state() and restore_state() must be defined, or they must both be undefined. */
+	g_assert ((iface->save_state == NULL) == (iface->restore_state == NULL));
+
+	if (iface->restore_state == NULL) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, "Restoring the state of a %s is not supported.", G_OBJECT_TYPE_NAME (self));
+		return FALSE;
+	}
+
+	g_variant_ref_sink (state);
+	if (iface->restore_state (self, state, error) == FALSE) {
+		g_variant_unref (state);
+		return FALSE;
+	}
+	g_variant_unref (state);
+
+	return TRUE;
+}
+
+/*
+ * _gdata_authorizer_check_state:
+ * @state: an <type>a{sv}</type> state #GVariant passed to gdata_authorizer_restore_state()
+ * @type_name: the name of the #GDataAuthorizer implementation the state should be for
+ * @version: the version of the state format the implementation supports
+ * @error: a #GError, or %NULL
+ *
+ * Checks that @state was saved by the given #GDataAuthorizer implementation with the given state format version, by checking its
+ * <literal>type</literal> and <literal>version</literal> entries. These are required in all state saved by libgdata's implementations.
+ *
+ * Return value: %TRUE if @state is of the right type and version, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_authorizer_check_state (GVariant *state, const gchar *type_name, guint32 version, GError **error)
+{
+	const gchar *state_type_name;
+	guint32 state_version;
 
-		return TRUE;
+	if (g_variant_lookup (state, "type", "&s", &state_type_name) == FALSE || strcmp (state_type_name, type_name) != 0 ||
+	    g_variant_lookup (state, "version", "u", &state_version) == FALSE || state_version != version) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "The authorization state is not valid for a %s.", type_name);
+		return FALSE;
 	}
 
-	/* Fall back to just returning FALSE if none of the methods are implemented */
-	return FALSE;
+	return TRUE;
+}
+
+/**
+ * _gdata_authorizer_set_expiry_time:
+ * @self: a #GDataAuthorizer
+ * @expires_in: the number of seconds until the current authorization expires, or <code class="literal">0</code> if unknown
+ *
+ * Records when the authorization tokens which @self just acquired will expire, so that they can be proactively refreshed shortly beforehand (see
+ * _gdata_authorizer_is_expiring()) rather than only after a request fails with 401 Unauthorized. This is intended to be called by
+ * #GDataAuthorizer implementations which learn the lifetime of their tokens, whenever they acquire new ones.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_authorizer_set_expiry_time (GDataAuthorizer *self, gint64 expires_in)
+{
+	RefreshData *data;
+
+	g_return_if_fail (GDATA_IS_AUTHORIZER (self));
+
+	data = get_refresh_data (self);
+
+	g_mutex_lock (&data->mutex);
+	data->expiry_time = (expires_in > 0) ? g_get_monotonic_time () + expires_in * G_USEC_PER_SEC : 0;
+	g_mutex_unlock (&data->mutex);
+}
+
+/**
+ * _gdata_authorizer_is_expiring:
+ * @self: (allow-none): a #GDataAuthorizer, or %NULL
+ *
+ * Returns whether @self's authorization is known to expire within the next minute (or to have expired already), as recorded with
+ * _gdata_authorizer_set_expiry_time(). If so, it should be refreshed before making another request with it. If @self is %NULL, or the expiry time
+ * isn't known, or a refresh is already in progress, %FALSE is returned.
+ *
+ * Return value: %TRUE if the authorization should be refreshed proactively, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_authorizer_is_expiring (GDataAuthorizer *self)
+{
+	RefreshData *data;
+	gboolean expiring;
+
+	g_return_val_if_fail (self == NULL || GDATA_IS_AUTHORIZER (self), FALSE);
+
+	if (self == NULL || GDATA_AUTHORIZER_GET_IFACE (self)->refresh_authorization == NULL)
+		return FALSE;
+
+	data = get_refresh_data (self);
+
+	g_mutex_lock (&data->mutex);
+	expiring = (data->in_progress == FALSE && data->expiry_time > 0 &&
+	            g_get_monotonic_time () >= data->expiry_time - PROACTIVE_REFRESH_MARGIN) ? TRUE : FALSE;
+	g_mutex_unlock (&data->mutex);
+
+	return expiring;
 }
@@ -60,6 +60,16 @@ typedef struct _GDataAuthorizer		GDataAuthorizer; /* dummy typedef */
  * also be implemented and both functions must be thread safe
  * @refresh_authorization_finish: (allow-none): a finish function for the asynchronous version of @refresh_authorization; this must be implemented
  * exactly if @refresh_authorization_async is implemented, and must be thread safe if it is implemented
+ * @save_state: (allow-none): a function to return the authorizer's current authorization state (such as its tokens) as a non-floating
+ * <type>a{sv}</type> #GVariant which can later be passed to @restore_state; if this isn't implemented, the authorizer's state can't be saved; if it
+ * is implemented, it must be thread safe (Since: 0.15.0)
+ * @restore_state: (allow-none): a function to restore authorization state returned by @save_state, returning %FALSE and setting an error if it's
+ * invalid; this must be implemented exactly if @save_state is implemented, and must be thread safe if it is implemented (Since: 0.15.0)
+ * @process_request_async: (allow-none): an asynchronous version of @process_request, for authorizers which may need to block (for example, to fetch
+ * an access token) before they can process a request; if this isn't implemented, @process_request will be called from the main context instead,
+ * whereas if this is implemented @process_request_finish must also be implemented and both functions must be thread safe (Since: 0.15.0)
+ * @process_request_finish: (allow-none): a finish function for the asynchronous version of @process_request; this must be implemented exactly if
+ * @process_request_async is implemented, and must be thread safe if it is implemented (Since: 0.15.0)
  *
  * The class structure for the #GDataAuthorizer interface.
  *
@@ -74,11 +84,21 @@ typedef struct {
 	void (*refresh_authorization_async) (GDataAuthorizer *self, GCancellable *cancellable,
 	                                     GAsyncReadyCallback callback, gpointer user_data);
 	gboolean (*refresh_authorization_finish) (GDataAuthorizer *self, GAsyncResult *async_result, GError **error);
+
+	GVariant *(*save_state) (GDataAuthorizer *self);
+	gboolean (*restore_state) (GDataAuthorizer *self, GVariant *state, GError **error);
+
+	void (*process_request_async) (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message, GCancellable *cancellable,
+	                               GAsyncReadyCallback callback, gpointer user_data);
+	gboolean (*process_request_finish) (GDataAuthorizer *self, GAsyncResult *async_result, GError **error);
 } GDataAuthorizerInterface;
 
 GType gdata_authorizer_get_type (void) G_GNUC_CONST;
 
 void gdata_authorizer_process_request (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message);
+void gdata_authorizer_process_request_async (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message,
+                                             GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_authorizer_process_request_finish (GDataAuthorizer *self, GAsyncResult *async_result, GError **error);
 gboolean gdata_authorizer_is_authorized_for_domain (GDataAuthorizer *self, GDataAuthorizationDomain *domain);
 
 gboolean gdata_authorizer_refresh_authorization (GDataAuthorizer *self, GCancellable *cancellable, GError **error);
@@ -86,6 +106,9 @@ void gdata_authorizer_refresh_authorization_async (GDataAuthorizer *self, GCance
                                                    GAsyncReadyCallback callback, gpointer user_data);
 gboolean gdata_authorizer_refresh_authorization_finish (GDataAuthorizer *self, GAsyncResult *async_result, GError **error);
 
+GVariant *gdata_authorizer_save_state (GDataAuthorizer *self) G_GNUC_WARN_UNUSED_RESULT;
+gboolean gdata_authorizer_restore_state (GDataAuthorizer *self, GVariant *state, GError **error);
+
 G_END_DECLS
 
 #endif /* !GDATA_AUTHORIZER_H */
@@ -0,0 +1,119 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SECTION:gdata-bandwidth-limiter
+ * @short_description: GData transfer bandwidth limiter
+ * @stability: Unstable
+ * @include: gdata/gdata-bandwidth-limiter.h
+ *
+ * #GDataBandwidthLimiter is a threadsafe limiter which paces the chunks of data transferred by upload and download streams so that no more than a
+ * configured number of bytes are transferred per second. As with #GDataRateLimiter, callers reserve the time at which they may transfer each chunk
+ * using gdata_bandwidth_limiter_reserve(), then wait until then.
+ *
+ * Reservations are made in order, and each stream only reserves its next chunk once it's finished waiting for its current one. A limiter shared by
+ * several streams (such as a service's) therefore hands out its bandwidth between them in turn, a chunk at a time, so each of them gets a fair
+ * share of it regardless of how quickly it can produce or consume data.
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-bandwidth-limiter.h"
+#include "gdata-rate-limiter.h"
+
+/* The longest a limiter may be idle for and still have its unused bandwidth transferred back-to-back, in microseconds. This smooths over small gaps
+ * between chunks without allowing large bursts after a stream's been stalled. */
+#define MAX_BURST_TIME (G_USEC_PER_SEC / 10)
+
+GDataBandwidthLimiter *
+gdata_bandwidth_limiter_new (void)
+{
+	GDataBandwidthLimiter *self = g_slice_new0 (GDataBandwidthLimiter);
+
+	g_mutex_init (&(self->mutex));
+
+	return self;
+}
+
+void
+gdata_bandwidth_limiter_free (GDataBandwidthLimiter *self)
+{
+	g_mutex_clear (&(self->mutex));
+	g_slice_free (GDataBandwidthLimiter, self);
+}
+
+/* Sets the rate to @rate bytes per second, or no limit if it's 0 */
+void
+gdata_bandwidth_limiter_set_rate (GDataBandwidthLimiter *self, guint rate)
+{
+	g_atomic_int_set (&(self->rate), MIN (rate, G_MAXINT));
+}
+
+guint
+gdata_bandwidth_limiter_get_rate (GDataBandwidthLimiter *self)
+{
+	return g_atomic_int_get (&(self->rate));
+}
+
+/* Reserves bandwidth for transferring @length bytes, and returns the monotonic time at which the transfer may start. This returns immediately (and
+ * the caller should then wait until the returned time if it's in the future). If there's no limit, this returns 0. */
+gint64
+gdata_bandwidth_limiter_reserve (GDataBandwidthLimiter *self, gsize length)
+{
+	gint64 now, start_time;
+	guint rate;
+
+	rate = gdata_bandwidth_limiter_get_rate (self);
+	if (rate == 0)
+		return 0;
+
+	now = g_get_monotonic_time ();
+
+	g_mutex_lock (&(self->mutex));
+
+	start_time = MAX (self->next_time, now - MAX_BURST_TIME);
+	self->next_time = start_time + (gint64) ((gdouble) length * G_USEC_PER_SEC / rate);
+
+	g_mutex_unlock (&(self->mutex));
+
+	return start_time;
+}
+
+/* Blocks until @length bytes may be transferred under both @stream_limiter and @service_limiter (either of which may be %NULL). Returns %FALSE if
+ * @cancellable is cancelled first. */
+gboolean
+gdata_bandwidth_limiter_throttle (GDataBandwidthLimiter *stream_limiter, GDataBandwidthLimiter *service_limiter, gsize length,
+                                  GCancellable *cancellable)
+{
+	gint64 start_time = 0;
+
+	if (length == 0)
+		return TRUE;
+
+	if (stream_limiter != NULL)
+		start_time = gdata_bandwidth_limiter_reserve (stream_limiter, length);
+	if (service_limiter != NULL)
+		start_time = MAX (start_time, gdata_bandwidth_limiter_reserve (service_limiter, length));
+
+	if (start_time <= g_get_monotonic_time ())
+		return TRUE;
+
+	return gdata_rate_limiter_wait_until (start_time, cancellable);
+}
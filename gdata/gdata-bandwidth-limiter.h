@@ -0,0 +1,54 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_BANDWIDTH_LIMITER_H
+#define GDATA_BANDWIDTH_LIMITER_H
+
+#include <glib.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDataBandwidthLimiter:
+ *
+ * All the fields in the #GDataBandwidthLimiter structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GMutex mutex; /* protects next_time */
+	volatile gint rate; /* configured rate, in bytes per second; 0 for no limit */
+	gint64 next_time; /* monotonic time at which all the bytes reserved so far will have been transferred at the configured rate */
+} GDataBandwidthLimiter;
+
+GDataBandwidthLimiter *gdata_bandwidth_limiter_new (void) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_bandwidth_limiter_free (GDataBandwidthLimiter *self);
+
+void gdata_bandwidth_limiter_set_rate (GDataBandwidthLimiter *self, guint rate);
+guint gdata_bandwidth_limiter_get_rate (GDataBandwidthLimiter *self);
+
+gint64 gdata_bandwidth_limiter_reserve (GDataBandwidthLimiter *self, gsize length);
+gboolean gdata_bandwidth_limiter_throttle (GDataBandwidthLimiter *stream_limiter, GDataBandwidthLimiter *service_limiter, gsize length,
+                                           GCancellable *cancellable);
+
+G_END_DECLS
+
+#endif /* !GDATA_BANDWIDTH_LIMITER_H */
@@ -116,12 +116,17 @@ struct _GDataBatchOperationPrivate {
 	guint next_id; /* next available operation ID */
 	gboolean has_run; /* TRUE if the operation has been run already (though it does not necessarily have to have finished running) */
 	gboolean is_async; /* TRUE if the operation was run with *_run_async(); FALSE if run with *_run() */
+	GMainContext *context; /* thread-default main context of the thread which called *_run_async(), to dispatch the callbacks in */
+	guint max_operations_per_request;
+	guint max_concurrent_requests;
 };
 
 enum {
 	PROP_SERVICE = 1,
 	PROP_FEED_URI,
 	PROP_AUTHORIZATION_DOMAIN,
+	PROP_MAX_OPERATIONS_PER_REQUEST,
+	PROP_MAX_CONCURRENT_REQUESTS,
 };
 
 G_DEFINE_TYPE (GDataBatchOperation, gdata_batch_operation, G_TYPE_OBJECT)
@@ -181,6 +186,39 @@ gdata_batch_operation_class_init (GDataBatchOperationClass *klass)
 	                                                      "Feed URI", "The feed URI that this batch operation will be sent to.",
 	                                                      NULL,
 	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataBatchOperation:max-operations-per-request:
+	 *
+	 * The maximum number of operations to send to the server in a single request. If more operations than this have been added to the batch
+	 * operation, it will be split into several requests when it's run, each containing operations in the order they were added. Google's
+	 * services reject batch requests containing more than 100 operations, so set this to 100 (or less) if that many might be added.
+	 *
+	 * If this is <code class="literal">0</code> (the default), all the operations will be sent in a single request.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MAX_OPERATIONS_PER_REQUEST,
+	                                 g_param_spec_uint ("max-operations-per-request",
+	                                                    "Maximum operations per request",
+	                                                    "The maximum number of operations to send in a single request.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataBatchOperation:max-concurrent-requests:
+	 *
+	 * The maximum number of requests to have in flight at once, if the batch operation has been split into several requests due to
+	 * #GDataBatchOperation:max-operations-per-request. Responses are parsed, and operations' callbacks called, in the thread which ran the
+	 * batch operation regardless of this setting.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MAX_CONCURRENT_REQUESTS,
+	                                 g_param_spec_uint ("max-concurrent-requests",
+	                                                    "Maximum concurrent requests", "The maximum number of requests to have in flight at once.",
+	                                                    1, G_MAXUINT, 1,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -198,6 +236,12 @@ gdata_batch_operation_get_property (GObject *object, guint property_id, GValue *
 		case PROP_FEED_URI:
 			g_value_set_string (value, priv->feed_uri);
 			break;
+		case PROP_MAX_OPERATIONS_PER_REQUEST:
+			g_value_set_uint (value, priv->max_operations_per_request);
+			break;
+		case PROP_MAX_CONCURRENT_REQUESTS:
+			g_value_set_uint (value, priv->max_concurrent_requests);
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -221,6 +265,12 @@ gdata_batch_operation_set_property (GObject *object, guint property_id, const GV
 		case PROP_FEED_URI:
 			priv->feed_uri = g_value_dup_string (value);
 			break;
+		case PROP_MAX_OPERATIONS_PER_REQUEST:
+			gdata_batch_operation_set_max_operations_per_request (GDATA_BATCH_OPERATION (object), g_value_get_uint (value));
+			break;
+		case PROP_MAX_CONCURRENT_REQUESTS:
+			gdata_batch_operation_set_max_concurrent_requests (GDATA_BATCH_OPERATION (object), g_value_get_uint (value));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -233,6 +283,7 @@ gdata_batch_operation_init (GDataBatchOperation *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_BATCH_OPERATION, GDataBatchOperationPrivate);
 	self->priv->next_id = 1; /* reserve ID 0 for error conditions */
+	self->priv->max_concurrent_requests = 1;
 	self->priv->operations = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) operation_free);
 }
 
@@ -261,6 +312,9 @@ gdata_batch_operation_finalize (GObject *object)
 	g_free (priv->feed_uri);
 	g_hash_table_destroy (priv->operations);
 
+	if (priv->context != NULL)
+		g_main_context_unref (priv->context);
+
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_batch_operation_parent_class)->finalize (object);
 }
@@ -317,6 +371,77 @@ gdata_batch_operation_get_feed_uri (GDataBatchOperation *self)
 	return self->priv->feed_uri;
 }
 
+/**
+ * gdata_batch_operation_get_max_operations_per_request:
+ * @self: a #GDataBatchOperation
+ *
+ * Gets the #GDataBatchOperation:max-operations-per-request property.
+ *
+ * Return value: the maximum number of operations sent in each request, or <code class="literal">0</code> for no limit
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_batch_operation_get_max_operations_per_request (GDataBatchOperation *self)
+{
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), 0);
+	return self->priv->max_operations_per_request;
+}
+
+/**
+ * gdata_batch_operation_set_max_operations_per_request:
+ * @self: a #GDataBatchOperation
+ * @max_operations_per_request: the maximum number of operations to send in each request, or <code class="literal">0</code> for no limit
+ *
+ * Sets the #GDataBatchOperation:max-operations-per-request property. This has no effect once the batch operation has been run.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_batch_operation_set_max_operations_per_request (GDataBatchOperation *self, guint max_operations_per_request)
+{
+	g_return_if_fail (GDATA_IS_BATCH_OPERATION (self));
+
+	self->priv->max_operations_per_request = max_operations_per_request;
+	g_object_notify (G_OBJECT (self), "max-operations-per-request");
+}
+
+/**
+ * gdata_batch_operation_get_max_concurrent_requests:
+ * @self: a #GDataBatchOperation
+ *
+ * Gets the #GDataBatchOperation:max-concurrent-requests property.
+ *
+ * Return value: the maximum number of requests in flight at once
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_batch_operation_get_max_concurrent_requests (GDataBatchOperation *self)
+{
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), 1);
+	return self->priv->max_concurrent_requests;
+}
+
+/**
+ * gdata_batch_operation_set_max_concurrent_requests:
+ * @self: a #GDataBatchOperation
+ * @max_concurrent_requests: the maximum number of requests to have in flight at once; must be greater than <code class="literal">0</code>
+ *
+ * Sets the #GDataBatchOperation:max-concurrent-requests property. This has no effect once the batch operation has been run.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_batch_operation_set_max_concurrent_requests (GDataBatchOperation *self, guint max_concurrent_requests)
+{
+	g_return_if_fail (GDATA_IS_BATCH_OPERATION (self));
+	g_return_if_fail (max_concurrent_requests > 0);
+
+	self->priv->max_concurrent_requests = max_concurrent_requests;
+	g_object_notify (G_OBJECT (self), "max-concurrent-requests");
+}
+
 /* Add an operation to the list of operations to be executed when the #GDataBatchOperation is run, and return its operation ID */
 static guint
 add_operation (GDataBatchOperation *self, GDataBatchOperationType type, GDataEntry *entry, GDataBatchOperationCallback callback, gpointer user_data)
@@ -358,7 +483,7 @@ _gdata_batch_operation_get_operation (GDataBatchOperation *self, guint id)
 }
 
 /* Run a user-supplied callback for a #BatchOperation whose return value we've just processed. This is designed to be used in an idle handler, so
- * that the callback is run in the main thread. It can be called if the user-supplied callback is %NULL (e.g. in the case that the callback's been
+ * that the callback is run in the main context the operation was run from. It can be called if the user-supplied callback is %NULL (e.g. in the case that the callback's been
  * called before). */
 static gboolean
 run_callback_cb (BatchOperation *op)
@@ -382,7 +507,7 @@ run_callback_cb (BatchOperation *op)
  * Run the callback for @op to notify the user code that the operation's result has been received and processed. Either @entry or @error should be
  * set (and the other should be %NULL), signifying a successful operation or a failed operation, respectively.
  *
- * The function will call @op's user-supplied callback, if available, in either the current or the main thread, depending on whether the
+ * The function will call @op's user-supplied callback, if available, in either the current thread or the main context it was run from, depending on whether the
  * #GDataBatchOperation was run with gdata_batch_operation_run() or gdata_batch_operation_run_async().
  *
  * Since: 0.7.0
@@ -409,12 +534,11 @@ _gdata_batch_operation_run_callback (GDataBatchOperation *self, BatchOperation *
 	if (op->callback == NULL)
 		return;
 
-	/* Only dispatch it in the main thread if the request was run with *_run_async(). This allows applications to run batch operations entirely in
-	 * application-owned threads if desired. */
+	/* Only dispatch it in the calling thread's main context if the request was run with *_run_async(). This allows applications to run batch
+	 * operations entirely in application-owned threads if desired. */
 	if (self->priv->is_async == TRUE) {
-		/* Send the callback; use G_PRIORITY_DEFAULT rather than G_PRIORITY_DEFAULT_IDLE
-		 * to contend with the priorities used by the callback functions in GAsyncResult */
-		g_idle_add_full (G_PRIORITY_DEFAULT, (GSourceFunc) run_callback_cb, op, NULL);
+		/* Send the callback to the same main context as the GAsyncResult will be completed in */
+		_gdata_service_idle_add (self->priv->context, (GSourceFunc) run_callback_cb, op, NULL);
 	} else {
 		run_callback_cb (op);
 	}
@@ -448,10 +572,11 @@ operation_free (BatchOperation *op)
  * batch operation's operations will be performed.
  *
  * @callback will be called when the #GDataBatchOperation is run with gdata_batch_operation_run() (in which case it will be called in the thread which
- * ran the batch operation), or with gdata_batch_operation_run_async() (in which case it will be called in an idle handler in the main thread). The
- * @operation_id passed to the callback will match the return value of gdata_batch_operation_add_query(), and the @operation_type will be
- * %GDATA_BATCH_OPERATION_QUERY. If the query was successful, the resulting entry will be passed to the callback function as @entry, and @error will
- * be %NULL. If, however, the query was unsuccessful, @entry will be %NULL and @error will contain a #GError detailing what went wrong.
+ * ran the batch operation), or with gdata_batch_operation_run_async() (in which case it will be called in an idle handler in the thread-default main
+ * context of the thread which ran it). The @operation_id passed to the callback will match the return value of gdata_batch_operation_add_query(), and
+ * the @operation_type will be %GDATA_BATCH_OPERATION_QUERY. If the query was successful, the resulting entry will be passed to the callback function
+ * as @entry, and @error will be %NULL. If, however, the query was unsuccessful, @entry will be %NULL and @error will contain a #GError detailing what
+ * went wrong.
  *
  * Return value: operation ID for the added query, or <code class="literal">0</code>
  *
@@ -570,56 +695,124 @@ gdata_batch_operation_add_deletion (GDataBatchOperation *self, GDataEntry *entry
 	return add_operation (self, GDATA_BATCH_OPERATION_DELETION, entry, callback, user_data);
 }
 
-/**
- * gdata_batch_operation_run:
- * @self: a #GDataBatchOperation
- * @cancellable: (allow-none): a #GCancellable, or %NULL
- * @error: a #GError, or %NULL
- *
- * Run the #GDataBatchOperation synchronously. This will send all the operations in the batch operation to the server, and call their respective
- * callbacks synchronously (i.e. before gdata_batch_operation_run() returns, and in the same thread that called gdata_batch_operation_run()) as the
- * server returns results for each operation.
- *
- * The callbacks for all of the operations in the batch operation are always guaranteed to be called, even if the batch operation as a whole fails.
- * Each callback will be called exactly once for each time gdata_batch_operation_run() is called.
- *
- * The return value of the function indicates whether the overall batch operation was successful, and doesn't indicate the status of any of the
- * operations it comprises. gdata_batch_operation_run() could return %TRUE even if all of its operations failed.
- *
- * @cancellable can be used to cancel the entire batch operation any time before or during the network activity. If @cancellable is cancelled
- * after network activity has finished, gdata_batch_operation_run() will continue and finish as normal.
- *
- * Return value: %TRUE on success, %FALSE otherwise
- *
- * Since: 0.7.0
- **/
-gboolean
-gdata_batch_operation_run (GDataBatchOperation *self, GCancellable *cancellable, GError **error)
+/* A single request to the server, containing some or all of the operations in the batch operation */
+typedef struct {
+	GList *operations; /* BatchOperation, owned by the GDataBatchOperation */
+	SoupMessage *message;
+	guint status;
+	GError *error; /* set by the network code iff status is SOUP_STATUS_NONE or SOUP_STATUS_CANCELLED */
+
+	/* Request body state; the body is serialised one entry at a time as libsoup writes it out, rather than all at once */
+	GPtrArray *entries; /* GDataEntry */
+	gchar *feed_header; /* the XML declaration, and the feed's opening tag and required elements */
+	guint next_entry; /* index into entries of the next entry to serialise */
+	gboolean body_complete; /* TRUE once the closing </feed> tag has been written */
+	GConverter *compressor; /* gzips the body as it's written, if #GDataService:compress-requests is set; otherwise NULL */
+
+	/* Only used when sending requests from a thread pool */
+	GCancellable *cancellable;
+	GAsyncQueue *responses;
+} BatchRequest;
+
+static void
+batch_request_free (BatchRequest *request)
+{
+	g_list_free (request->operations);
+	if (request->message != NULL)
+		g_object_unref (request->message);
+	if (request->entries != NULL)
+		g_ptr_array_unref (request->entries);
+	g_free (request->feed_header);
+	if (request->compressor != NULL)
+		g_object_unref (request->compressor);
+	if (request->error != NULL)
+		g_error_free (request->error);
+
+	g_slice_free (BatchRequest, request);
+}
+
+static void
+build_namespaces_cb (const gchar *prefix, const gchar *href, GString *output)
+{
+	g_string_append_printf (output, " xmlns:%s='%s'", prefix, href);
+}
+
+/* Append @data to the request body, compressing it if needed; @data must remain valid until the body's been written */
+static void
+batch_request_append (BatchRequest *request, SoupMessage *message, SoupMemoryUse use, const gchar *data, gsize length, gboolean at_end)
+{
+	if (request->compressor == NULL) {
+		soup_message_body_append (message->request_body, use, data, length);
+		return;
+	}
+
+	_gdata_service_append_compressed (request->compressor, message->request_body, data, length, at_end);
+
+	if (use == SOUP_MEMORY_TAKE)
+		g_free ((gchar*) data);
+}
+
+static void
+batch_request_wrote_headers_cb (SoupMessage *message, BatchRequest *request)
+{
+	/* (Re)start the body. If the message has been restarted (e.g. due to a redirect), any previously-written body has already been discarded. */
+	soup_message_body_truncate (message->request_body);
+	request->next_entry = 0;
+	request->body_complete = FALSE;
+
+	if (request->compressor != NULL)
+		g_converter_reset (request->compressor);
+
+	batch_request_append (request, message, SOUP_MEMORY_STATIC, request->feed_header, strlen (request->feed_header), FALSE);
+}
+
+static void
+batch_request_wrote_chunk_cb (SoupMessage *message, BatchRequest *request)
+{
+	/* Serialise the next entry, or close the feed once they've all been written. Entries which haven't been modified since they were parsed can
+	 * just be output as the server sent them. */
+	if (request->next_entry < request->entries->len) {
+		GDataParsable *entry = GDATA_PARSABLE (g_ptr_array_index (request->entries, request->next_entry++));
+		GString *xml_string = g_string_sized_new (1000);
+		gsize length;
+
+		if (_gdata_parsable_get_original_xml (entry, xml_string) == FALSE)
+			_gdata_parsable_get_xml (entry, xml_string, FALSE);
+
+		length = xml_string->len;
+		batch_request_append (request, message, SOUP_MEMORY_TAKE, g_string_free (xml_string, FALSE), length, FALSE);
+	} else if (request->body_complete == FALSE) {
+		request->body_complete = TRUE;
+
+		batch_request_append (request, message, SOUP_MEMORY_STATIC, "</feed>", strlen ("</feed>"), TRUE);
+		soup_message_body_complete (message->request_body);
+	}
+}
+
+/* Build the message for a request containing @operations. The request body is a batch feed, but rather than serialising the whole feed to a
+ * string up front, keep hold of its entries and feed them to libsoup one at a time using chunked encoding, so that only one entry's XML is held in
+ * memory at once. */
+static SoupMessage *
+build_request_message (GDataBatchOperation *self, BatchRequest *request)
 {
 	GDataBatchOperationPrivate *priv = self->priv;
 	SoupMessage *message;
-	GDataFeed *feed;
+	GHashTable *namespaces;
+	GString *feed_header;
 	GTimeVal updated;
-	gchar *upload_data;
-	guint status;
-	GHashTableIter iter;
-	gpointer op_id;
-	BatchOperation *op;
-	GError *child_error = NULL;
-
-	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), FALSE);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
-	g_return_val_if_fail (priv->has_run == FALSE, FALSE);
+	gchar *updated_string;
+	GList *i;
+	guint j;
 
 	message = _gdata_service_build_message (priv->service, priv->authorization_domain, SOUP_METHOD_POST, priv->feed_uri, NULL, TRUE);
 
-	/* Build the request */
+	/* Build the request's entries */
 	g_get_current_time (&updated);
-	feed = _gdata_feed_new ("Batch operation feed", "batch1", updated.tv_sec);
+	request->entries = g_ptr_array_new_with_free_func (g_object_unref);
+
+	for (i = request->operations; i != NULL; i = i->next) {
+		BatchOperation *op = i->data;
 
-	g_hash_table_iter_init (&iter, priv->operations);
-	while (g_hash_table_iter_next (&iter, &op_id, (gpointer*) &op) == TRUE) {
 		if (op->type == GDATA_BATCH_OPERATION_QUERY) {
 			/* Queries are weird; build a new throwaway entry, and add it to the feed */
 			GDataEntry *entry;
@@ -637,38 +830,90 @@ gdata_batch_operation_run (GDataBatchOperation *self, GCancellable *cancellable,
 			_gdata_entry_set_updated (entry, updated.tv_sec);
 
 			_gdata_entry_set_batch_data (entry, op->id, op->type);
-			_gdata_feed_add_entry (feed, entry);
+			g_ptr_array_add (request->entries, entry);
 
 			g_type_class_unref (klass);
-			g_object_unref (entry);
 		} else {
 			/* Everything else just dumps the entry's XML in the request */
 			_gdata_entry_set_batch_data (op->entry, op->id, op->type);
-			_gdata_feed_add_entry (feed, op->entry);
+			g_ptr_array_add (request->entries, g_object_ref (op->entry));
 		}
 	}
 
-	upload_data = gdata_parsable_get_xml (GDATA_PARSABLE (feed));
-	soup_message_set_request (message, "application/atom+xml", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
+	/* Build the feed's opening tag, declaring the namespaces used by all of its entries, as GDataFeed's get_xml() would */
+	namespaces = g_hash_table_new (g_str_hash, g_str_equal);
 
-	g_object_unref (feed);
+	for (j = 0; j < request->entries->len; j++) {
+		_gdata_parsable_get_namespaces (GDATA_PARSABLE (g_ptr_array_index (request->entries, j)), namespaces);
+	}
 
-	/* Ensure that this GDataBatchOperation can't be run again */
-	priv->has_run = TRUE;
+	/* The entries' batch elements are declared on each entry, but declaring the namespace here as well saves anything parsing the feed from
+	 * having to look it up for every entry */
+	g_hash_table_insert (namespaces, (gchar*) "batch", (gchar*) "http://schemas.google.com/gdata/batch");
+
+	feed_header = g_string_new ("<?xml version='1.0' encoding='UTF-8'?><feed xmlns='http://www.w3.org/2005/Atom'");
+	g_hash_table_foreach (namespaces, (GHFunc) build_namespaces_cb, feed_header);
+	g_hash_table_destroy (namespaces);
+
+	updated_string = gdata_parser_int64_to_iso8601 (updated.tv_sec);
+	g_string_append_printf (feed_header, "><title type='text'>Batch operation feed</title><id>batch1</id><updated>%s</updated>", updated_string);
+	g_free (updated_string);
+
+	request->feed_header = g_string_free (feed_header, FALSE);
+
+	/* Stream the body */
+	soup_message_headers_set_content_type (message->request_headers, "application/atom+xml", NULL);
+	soup_message_headers_set_encoding (message->request_headers, SOUP_ENCODING_CHUNKED);
+	soup_message_body_set_accumulate (message->request_body, FALSE);
+
+	if (gdata_service_get_compress_requests (priv->service) == TRUE) {
+		request->compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1));
+		soup_message_headers_replace (message->request_headers, "Content-Encoding", "gzip");
+	}
+
+	g_signal_connect (message, "wrote-headers", (GCallback) batch_request_wrote_headers_cb, request);
+	g_signal_connect (message, "wrote-chunk", (GCallback) batch_request_wrote_chunk_cb, request);
+
+	return message;
+}
+
+/* Send @request's message, and push @request onto @responses once the response has been received */
+static void
+send_request (BatchRequest *request, GCancellable *cancellable, GDataBatchOperation *self, GAsyncQueue *responses)
+{
+	request->status = _gdata_service_send_message (self->priv->service, request->message, cancellable, &(request->error));
+	g_async_queue_push (responses, request);
+}
 
-	/* Send the message */
-	status = _gdata_service_send_message (priv->service, message, cancellable, &child_error);
+static void
+send_request_thread (BatchRequest *request, GDataBatchOperation *self)
+{
+	send_request (request, request->cancellable, self, request->responses);
+}
 
-	if (status != SOUP_STATUS_OK) {
-		/* Iff status is SOUP_STATUS_NONE or SOUP_STATUS_CANCELLED, child_error has already been set */
-		if (status != SOUP_STATUS_NONE && status != SOUP_STATUS_CANCELLED) {
+/* Parse the response to @request, running the callbacks of its operations. If the request as a whole failed, all of its operations' callbacks are
+ * run with the error, and the error is also returned in @error if it's the first one. */
+static void
+process_response (GDataBatchOperation *self, BatchRequest *request, GError **error)
+{
+	GDataBatchOperationPrivate *priv = self->priv;
+	SoupMessage *message = request->message;
+	GDataFeed *feed;
+	GError *child_error = NULL;
+	GList *i;
+
+	if (request->status != SOUP_STATUS_OK) {
+		/* Iff status is SOUP_STATUS_NONE or SOUP_STATUS_CANCELLED, request->error has already been set */
+		if (request->status != SOUP_STATUS_NONE && request->status != SOUP_STATUS_CANCELLED) {
 			/* Error */
 			GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (priv->service);
 			g_assert (klass->parse_error_response != NULL);
-			klass->parse_error_response (priv->service, GDATA_OPERATION_BATCH, status, message->reason_phrase, message->response_body->data,
-			                             message->response_body->length, &child_error);
+			klass->parse_error_response (priv->service, GDATA_OPERATION_BATCH, request->status, message->reason_phrase,
+			                             message->response_body->data, message->response_body->length, &child_error);
+		} else {
+			child_error = request->error;
+			request->error = NULL;
 		}
-		g_object_unref (message);
 
 		goto error;
 	}
@@ -677,23 +922,155 @@ gdata_batch_operation_run (GDataBatchOperation *self, GCancellable *cancellable,
 	g_assert (message->response_body->data != NULL);
 	feed = GDATA_FEED (_gdata_parsable_new_from_xml (GDATA_TYPE_BATCH_FEED, message->response_body->data, message->response_body->length,
 	                                                 self, &child_error));
-	g_object_unref (message);
 
 	if (feed == NULL)
 		goto error;
 	g_object_unref (feed);
 
-	return TRUE;
+	return;
 
 error:
-	/* Call the callbacks for each of our operations to notify them of the error */
+	/* Call the callbacks for each of the request's operations to notify them of the error */
+	for (i = request->operations; i != NULL; i = i->next)
+		_gdata_batch_operation_run_callback (self, i->data, NULL, g_error_copy (child_error));
+
+	if (error != NULL && *error == NULL)
+		g_propagate_error (error, child_error);
+	else
+		g_error_free (child_error);
+}
+
+static gint
+compare_operation_ids (const BatchOperation *a, const BatchOperation *b)
+{
+	return (a->id < b->id) ? -1 : ((a->id > b->id) ? 1 : 0);
+}
+
+/**
+ * gdata_batch_operation_run:
+ * @self: a #GDataBatchOperation
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Run the #GDataBatchOperation synchronously. This will send all the operations in the batch operation to the server, and call their respective
+ * callbacks synchronously (i.e. before gdata_batch_operation_run() returns, and in the same thread that called gdata_batch_operation_run()) as the
+ * server returns results for each operation.
+ *
+ * If there are more operations than #GDataBatchOperation:max-operations-per-request, they're split across several requests, up to
+ * #GDataBatchOperation:max-concurrent-requests of which are sent at once.
+ *
+ * The callbacks for all of the operations in the batch operation are always guaranteed to be called, even if the batch operation as a whole fails.
+ * Each callback will be called exactly once for each time gdata_batch_operation_run() is called.
+ *
+ * The return value of the function indicates whether the overall batch operation was successful, and doesn't indicate the status of any of the
+ * operations it comprises. gdata_batch_operation_run() could return %TRUE even if all of its operations failed. If the batch operation was split
+ * into several requests and any of them failed as a whole, %FALSE is returned with the first such error; the operations in the other requests
+ * may still have succeeded, as reported to their callbacks.
+ *
+ * @cancellable can be used to cancel the entire batch operation any time before or during the network activity. If @cancellable is cancelled
+ * after network activity has finished, gdata_batch_operation_run() will continue and finish as normal.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.7.0
+ **/
+gboolean
+gdata_batch_operation_run (GDataBatchOperation *self, GCancellable *cancellable, GError **error)
+{
+	GDataBatchOperationPrivate *priv = self->priv;
+	GList *operations, *i;
+	GPtrArray *requests;
+	GAsyncQueue *responses;
+	GHashTableIter iter;
+	gpointer op_id;
+	BatchOperation *op;
+	guint n_operations, j;
+	GError *child_error = NULL;
+
+	g_return_val_if_fail (GDATA_IS_BATCH_OPERATION (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (priv->has_run == FALSE, FALSE);
+
+	/* Split the operations into requests of at most max_operations_per_request operations each, in the order they were added (the hash table
+	 * doesn't keep them in any particular order) */
+	operations = NULL;
 	g_hash_table_iter_init (&iter, priv->operations);
 	while (g_hash_table_iter_next (&iter, &op_id, (gpointer*) &op) == TRUE)
-		_gdata_batch_operation_run_callback (self, op, NULL, g_error_copy (child_error));
+		operations = g_list_prepend (operations, op);
+	operations = g_list_sort (operations, (GCompareFunc) compare_operation_ids);
 
-	g_propagate_error (error, child_error);
+	requests = g_ptr_array_new_with_free_func ((GDestroyNotify) batch_request_free);
+	n_operations = 0;
 
-	return FALSE;
+	for (i = operations; i != NULL; i = i->next) {
+		BatchRequest *request;
+
+		if (requests->len == 0 || (priv->max_operations_per_request > 0 && n_operations == priv->max_operations_per_request)) {
+			request = g_slice_new0 (BatchRequest);
+			g_ptr_array_add (requests, request);
+			n_operations = 0;
+		} else {
+			request = g_ptr_array_index (requests, requests->len - 1);
+		}
+
+		request->operations = g_list_prepend (request->operations, i->data);
+		n_operations++;
+	}
+
+	g_list_free (operations);
+
+	/* Build the requests' messages */
+	for (j = 0; j < requests->len; j++) {
+		BatchRequest *request = g_ptr_array_index (requests, j);
+
+		request->operations = g_list_reverse (request->operations);
+		request->message = build_request_message (self, request);
+	}
+
+	/* Ensure that this GDataBatchOperation can't be run again */
+	priv->has_run = TRUE;
+
+	/* Send the requests. The network activity can happen in parallel, but the responses are parsed (and our operations' callbacks are run) in
+	 * this thread, as documented by gdata_batch_operation_run(). */
+	responses = g_async_queue_new ();
+
+	if (requests->len == 1 || priv->max_concurrent_requests == 1) {
+		for (j = 0; j < requests->len; j++) {
+			BatchRequest *request = g_ptr_array_index (requests, j);
+
+			send_request (request, cancellable, self, responses);
+			process_response (self, g_async_queue_pop (responses), &child_error);
+		}
+	} else {
+		GThreadPool *pool;
+
+		pool = g_thread_pool_new ((GFunc) send_request_thread, self, priv->max_concurrent_requests, FALSE, NULL);
+
+		for (j = 0; j < requests->len; j++) {
+			BatchRequest *request = g_ptr_array_index (requests, j);
+
+			request->cancellable = cancellable;
+			request->responses = responses;
+			g_thread_pool_push (pool, request, NULL);
+		}
+
+		/* Process the responses in the order they arrive */
+		for (j = 0; j < requests->len; j++)
+			process_response (self, g_async_queue_pop (responses), &child_error);
+
+		g_thread_pool_free (pool, FALSE, TRUE);
+	}
+
+	g_async_queue_unref (responses);
+	g_ptr_array_unref (requests);
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	return TRUE;
 }
 
 static void
@@ -721,8 +1098,9 @@ run_thread (GSimpleAsyncResult *result, GDataBatchOperation *operation, GCancell
  * @user_data: (closure): data to pass to the @callback function
  *
  * Run the #GDataBatchOperation asynchronously. This will send all the operations in the batch operation to the server, and call their respective
- * callbacks asynchronously (i.e. in idle functions in the main thread, usually after gdata_batch_operation_run_async() has returned) as the
- * server returns results for each operation. @self is reffed when this function is called, so can safely be unreffed after this function returns.
+ * callbacks asynchronously (i.e. in idle functions in the thread-default main context of the thread which called this function, usually after
+ * gdata_batch_operation_run_async() has returned) as the server returns results for each operation. @self is reffed when this function is called,
+ * so can safely be unreffed after this function returns.
  *
  * For more details, see gdata_batch_operation_run(), which is the synchronous version of this function.
  *
@@ -742,6 +1120,7 @@ gdata_batch_operation_run_async (GDataBatchOperation *self, GCancellable *cancel
 
 	/* Mark the operation as async for the purposes of deciding where to call the callbacks */
 	self->priv->is_async = TRUE;
+	self->priv->context = g_main_context_ref_thread_default ();
 
 	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_batch_operation_run_async);
 
@@ -126,6 +126,11 @@ GDataService *gdata_batch_operation_get_service (GDataBatchOperation *self) G_GN
 GDataAuthorizationDomain *gdata_batch_operation_get_authorization_domain (GDataBatchOperation *self) G_GNUC_PURE;
 const gchar *gdata_batch_operation_get_feed_uri (GDataBatchOperation *self) G_GNUC_PURE;
 
+guint gdata_batch_operation_get_max_operations_per_request (GDataBatchOperation *self) G_GNUC_PURE;
+void gdata_batch_operation_set_max_operations_per_request (GDataBatchOperation *self, guint max_operations_per_request);
+guint gdata_batch_operation_get_max_concurrent_requests (GDataBatchOperation *self) G_GNUC_PURE;
+void gdata_batch_operation_set_max_concurrent_requests (GDataBatchOperation *self, guint max_concurrent_requests);
+
 guint gdata_batch_operation_add_query (GDataBatchOperation *self, const gchar *id, GType entry_type,
                                        GDataBatchOperationCallback callback, gpointer user_data);
 guint gdata_batch_operation_add_insertion (GDataBatchOperation *self, GDataEntry *entry, GDataBatchOperationCallback callback, gpointer user_data);
@@ -0,0 +1,963 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-blob-store
+ * @short_description: GData content-addressed download store
+ * @stability: Unstable
+ * @include: gdata/gdata-blob-store.h
+ *
+ * #GDataBlobStore is a directory of downloaded files (<firstterm>blobs</firstterm>), such as thumbnails, contact photos, exported documents and
+ * media, which can be shared by all the caches and services in a process. Each blob is stored once, named after the SHA-256 checksum of its
+ * contents, so a file which is downloaded from several URIs (such as the same avatar in several accounts' contacts) only takes up space once.
+ *
+ * Blobs are found either by their checksum, with gdata_blob_store_lookup(), or by the URI they were last downloaded from and (optionally) the ETag
+ * of that version of them, with gdata_blob_store_lookup_uri(). Both return the blob's contents mapped into memory straight from the file, so they
+ * aren't copied however large they are.
+ *
+ * If a store is set as a service's #GDataService:blob-store, every #GDataDownloadStream for that service writes the files it downloads through to
+ * the store, and revalidates any copy the store already has of a file with the server before downloading it again, reading it from the store if it
+ * hasn't changed.
+ *
+ * The store is included in the budget of the #GDataCacheManager, so if the manager has a #GDataCacheManager:budget, the least recently used blobs
+ * are deleted whenever the caches grow beyond it. Blobs are evicted after the contents of all the in-memory caches, since fetching them again means
+ * downloading them again; and since they aren't held in memory, they're left alone on low memory warnings.
+ *
+ * The methods of a #GDataBlobStore may be called from any thread. Several stores may be used at once, but they mustn't share a directory.
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#include "gdata-blob-store.h"
+#include "gdata-private.h"
+
+/* Each blob we know of, in the store's ->lru queue. The data itself is only ever in the file. */
+typedef struct {
+	gchar *hash;
+	guint64 size;
+	gint64 last_used; /* monotonic time */
+	GList *link; /* in ->lru */
+} BlobInfo;
+
+struct _GDataBlobWriter {
+	GDataBlobStore *store;
+	gchar *temp_path;
+	gint fd;
+	GChecksum *checksum;
+	guint64 length;
+};
+
+static void gdata_blob_store_constructed (GObject *object);
+static void gdata_blob_store_finalize (GObject *object);
+static void gdata_blob_store_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_blob_store_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+static gsize blob_store_get_size (gpointer cache, guint *n_items);
+static gint64 blob_store_get_oldest_use (gpointer cache);
+static gsize blob_store_evict_oldest (gpointer cache);
+
+static const GDataCacheFuncs blob_store_funcs = {
+	blob_store_get_size,
+	blob_store_get_oldest_use,
+	blob_store_evict_oldest,
+};
+
+/* The directory is laid out as follows:
+ *  - blobs/<SHA-256 of the contents>: the blobs themselves. Their modification times are updated whenever they're used, so that the order in which
+ *    they're evicted survives across processes.
+ *  - blobs/.<random>: blobs which are still being written; renamed into place once their checksum is known.
+ *  - aliases/<SHA-1 of the URI>: the alias of each URI, giving the checksum of the version of it which was last stored, that version's ETag and
+ *    content type, and the URI itself, each on a line of its own. An alias whose blob has been evicted is deleted when it's next looked up. */
+struct _GDataBlobStorePrivate {
+	gchar *directory;
+	gchar *blobs_directory;
+	gchar *aliases_directory;
+
+	GMutex mutex; /* protects the members below, and the contents of the directory */
+	GHashTable *blobs; /* checksum → BlobInfo */
+	GQueue lru; /* BlobInfo, in most-recently-used-first order */
+	guint64 size;
+
+	GDataCacheRegistration *registration;
+};
+
+enum {
+	PROP_DIRECTORY = 1,
+};
+
+G_DEFINE_TYPE (GDataBlobStore, gdata_blob_store, G_TYPE_OBJECT)
+
+static void
+gdata_blob_store_class_init (GDataBlobStoreClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataBlobStorePrivate));
+
+	gobject_class->constructed = gdata_blob_store_constructed;
+	gobject_class->finalize = gdata_blob_store_finalize;
+	gobject_class->get_property = gdata_blob_store_get_property;
+	gobject_class->set_property = gdata_blob_store_set_property;
+
+	/**
+	 * GDataBlobStore:directory:
+	 *
+	 * The directory the blobs are stored in. It's created if it doesn't exist. If %NULL is passed when constructing the store, a
+	 * <filename>libgdata/blobs</filename> directory in the user's cache directory (see g_get_user_cache_dir()) is used.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_DIRECTORY,
+	                                 g_param_spec_string ("directory",
+	                                                      "Directory", "The directory the blobs are stored in.",
+	                                                      NULL,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+blob_info_free (BlobInfo *info)
+{
+	g_free (info->hash);
+	g_slice_free (BlobInfo, info);
+}
+
+static void
+gdata_blob_store_init (GDataBlobStore *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_BLOB_STORE, GDataBlobStorePrivate);
+
+	g_mutex_init (&(self->priv->mutex));
+	self->priv->blobs = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) blob_info_free);
+	g_queue_init (&(self->priv->lru));
+}
+
+static gint
+compare_blob_infos (const BlobInfo **a, const BlobInfo **b)
+{
+	return ((*a)->last_used < (*b)->last_used) ? -1 : ((*a)->last_used > (*b)->last_used) ? 1 : 0;
+}
+
+/* Reads the alias file at @path, returning its fields in the out parameters (which may be %NULL), or %FALSE if it's corrupt. @uri is checked
+ * against the alias's URI if it's non-%NULL. */
+static gboolean
+alias_load (const gchar *path, const gchar *uri, gchar **hash, gchar **etag, gchar **content_type)
+{
+	gchar *contents;
+	gchar **lines;
+	gboolean valid;
+
+	if (g_file_get_contents (path, &contents, NULL, NULL) == FALSE)
+		return FALSE;
+
+	lines = g_strsplit (contents, "\n", 4);
+	g_free (contents);
+
+	valid = (g_strv_length (lines) == 4 && strlen (lines[0]) == 64 && (uri == NULL || strcmp (lines[3], uri) == 0)) ? TRUE : FALSE;
+
+	if (valid == TRUE) {
+		if (hash != NULL)
+			*hash = g_strdup (lines[0]);
+		if (etag != NULL)
+			*etag = (*lines[1] != '\0') ? g_strdup (lines[1]) : NULL;
+		if (content_type != NULL)
+			*content_type = (*lines[2] != '\0') ? g_strdup (lines[2]) : NULL;
+	}
+
+	g_strfreev (lines);
+
+	return valid;
+}
+
+/* Works out which blobs are in the store from the files in its directory, deleting any which were left half-written by an earlier process, and any
+ * aliases whose blobs no longer exist. This blocks on disk I/O, but only happens once per store. */
+static void
+gdata_blob_store_constructed (GObject *object)
+{
+	GDataBlobStorePrivate *priv = GDATA_BLOB_STORE (object)->priv;
+	GPtrArray *infos;
+	GDir *dir;
+	const gchar *name;
+	gint64 now_real, now_monotonic;
+	guint i;
+
+	/* Chain up to the parent class */
+	if (G_OBJECT_CLASS (gdata_blob_store_parent_class)->constructed != NULL)
+		G_OBJECT_CLASS (gdata_blob_store_parent_class)->constructed (object);
+
+	if (priv->directory == NULL)
+		priv->directory = g_build_filename (g_get_user_cache_dir (), "libgdata", "blobs", NULL);
+
+	priv->blobs_directory = g_build_filename (priv->directory, "blobs", NULL);
+	priv->aliases_directory = g_build_filename (priv->directory, "aliases", NULL);
+
+	g_mkdir_with_parents (priv->blobs_directory, 0700);
+	g_mkdir_with_parents (priv->aliases_directory, 0700);
+
+	/* Blobs' last uses are approximated from their modification times */
+	now_real = g_get_real_time ();
+	now_monotonic = g_get_monotonic_time ();
+	infos = g_ptr_array_new ();
+
+	dir = g_dir_open (priv->blobs_directory, 0, NULL);
+	while (dir != NULL && (name = g_dir_read_name (dir)) != NULL) {
+		GStatBuf stat_buf;
+		BlobInfo *info;
+		gchar *path;
+
+		path = g_build_filename (priv->blobs_directory, name, NULL);
+
+		if (*name == '.') {
+			g_unlink (path);
+		} else if (strlen (name) == 64 && g_stat (path, &stat_buf) == 0 && S_ISREG (stat_buf.st_mode)) {
+			info = g_slice_new0 (BlobInfo);
+			info->hash = g_strdup (name);
+			info->size = stat_buf.st_size;
+			info->last_used = now_monotonic - MAX (now_real - (gint64) stat_buf.st_mtime * G_USEC_PER_SEC, 0);
+
+			g_hash_table_insert (priv->blobs, info->hash, info);
+			g_ptr_array_add (infos, info);
+			priv->size += info->size;
+		}
+
+		g_free (path);
+	}
+
+	if (dir != NULL)
+		g_dir_close (dir);
+
+	/* Queue the blobs in most-recently-used-first order */
+	g_ptr_array_sort (infos, (GCompareFunc) compare_blob_infos);
+
+	for (i = 0; i < infos->len; i++) {
+		BlobInfo *info = g_ptr_array_index (infos, i);
+
+		g_queue_push_head (&(priv->lru), info);
+		info->link = priv->lru.head;
+	}
+
+	g_ptr_array_free (infos, TRUE);
+
+	/* Delete aliases of blobs which have been evicted */
+	dir = g_dir_open (priv->aliases_directory, 0, NULL);
+	while (dir != NULL && (name = g_dir_read_name (dir)) != NULL) {
+		gchar *path, *hash = NULL;
+
+		path = g_build_filename (priv->aliases_directory, name, NULL);
+
+		if (alias_load (path, NULL, &hash, NULL, NULL) == FALSE || g_hash_table_lookup (priv->blobs, hash) == NULL)
+			g_unlink (path);
+
+		g_free (hash);
+		g_free (path);
+	}
+
+	if (dir != NULL)
+		g_dir_close (dir);
+
+	priv->registration = _gdata_cache_manager_register ("GDataBlobStore", GDATA_CACHE_PRIORITY_DISK, &blob_store_funcs, object);
+
+	/* Bring the store within the budget, in case it's shrunk since the blobs were stored */
+	_gdata_cache_manager_cache_grown (priv->registration);
+}
+
+static void
+gdata_blob_store_finalize (GObject *object)
+{
+	GDataBlobStorePrivate *priv = GDATA_BLOB_STORE (object)->priv;
+
+	if (priv->registration != NULL)
+		_gdata_cache_manager_unregister (priv->registration);
+
+	g_queue_clear (&(priv->lru));
+	g_hash_table_destroy (priv->blobs);
+	g_mutex_clear (&(priv->mutex));
+
+	g_free (priv->directory);
+	g_free (priv->blobs_directory);
+	g_free (priv->aliases_directory);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_blob_store_parent_class)->finalize (object);
+}
+
+static void
+gdata_blob_store_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataBlobStorePrivate *priv = GDATA_BLOB_STORE (object)->priv;
+
+	switch (property_id) {
+		case PROP_DIRECTORY:
+			g_value_set_string (value, priv->directory);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_blob_store_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataBlobStorePrivate *priv = GDATA_BLOB_STORE (object)->priv;
+
+	switch (property_id) {
+		case PROP_DIRECTORY:
+			/* Construction only */
+			priv->directory = g_value_dup_string (value);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static gsize
+blob_store_get_size (gpointer cache, guint *n_items)
+{
+	GDataBlobStorePrivate *priv = GDATA_BLOB_STORE (cache)->priv;
+	gsize size;
+
+	g_mutex_lock (&(priv->mutex));
+
+	size = (gsize) MIN (priv->size, G_MAXSIZE);
+	if (n_items != NULL)
+		*n_items = g_hash_table_size (priv->blobs);
+
+	g_mutex_unlock (&(priv->mutex));
+
+	return size;
+}
+
+static gint64
+blob_store_get_oldest_use (gpointer cache)
+{
+	GDataBlobStorePrivate *priv = GDATA_BLOB_STORE (cache)->priv;
+	BlobInfo *info;
+	gint64 oldest_use;
+
+	g_mutex_lock (&(priv->mutex));
+	info = g_queue_peek_tail (&(priv->lru));
+	oldest_use = (info != NULL) ? info->last_used : G_MAXINT64;
+	g_mutex_unlock (&(priv->mutex));
+
+	return oldest_use;
+}
+
+static gsize
+blob_store_evict_oldest (gpointer cache)
+{
+	GDataBlobStorePrivate *priv = GDATA_BLOB_STORE (cache)->priv;
+	BlobInfo *info;
+	gchar *path;
+	gsize n_bytes;
+
+	g_mutex_lock (&(priv->mutex));
+
+	info = g_queue_pop_tail (&(priv->lru));
+	if (info == NULL) {
+		g_mutex_unlock (&(priv->mutex));
+		return 0;
+	}
+
+	/* Anyone who's already mapped the blob keeps their mapping of it. The blob's aliases are deleted lazily. */
+	path = g_build_filename (priv->blobs_directory, info->hash, NULL);
+	g_unlink (path);
+	g_free (path);
+
+	/* Even empty blobs have to count as something, or the manager will think we couldn't evict anything */
+	n_bytes = (gsize) MAX (MIN (info->size, G_MAXSIZE), 1);
+	priv->size -= info->size;
+	g_hash_table_remove (priv->blobs, info->hash);
+
+	g_mutex_unlock (&(priv->mutex));
+
+	return n_bytes;
+}
+
+/**
+ * gdata_blob_store_new:
+ * @directory: (allow-none): the directory to store the blobs in, or %NULL to use the default directory
+ *
+ * Creates a new #GDataBlobStore using @directory, which is created if it doesn't exist. Any blobs already in the directory, for example from an
+ * earlier run of the application, are available straight away. See #GDataBlobStore:directory for details of the default directory.
+ *
+ * Return value: (transfer full): a new #GDataBlobStore; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataBlobStore *
+gdata_blob_store_new (const gchar *directory)
+{
+	return g_object_new (GDATA_TYPE_BLOB_STORE, "directory", directory, NULL);
+}
+
+/**
+ * gdata_blob_store_get_directory:
+ * @self: a #GDataBlobStore
+ *
+ * Gets the #GDataBlobStore:directory property.
+ *
+ * Return value: the directory the blobs are stored in
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_blob_store_get_directory (GDataBlobStore *self)
+{
+	g_return_val_if_fail (GDATA_IS_BLOB_STORE (self), NULL);
+	return self->priv->directory;
+}
+
+/**
+ * gdata_blob_store_get_size:
+ * @self: a #GDataBlobStore
+ *
+ * Gets the total size of all the blobs in the store. Each blob is only counted once, however many URIs it's been stored under.
+ *
+ * Return value: the size of the store, in bytes
+ *
+ * Since: 0.15.0
+ **/
+guint64
+gdata_blob_store_get_size (GDataBlobStore *self)
+{
+	guint64 size;
+
+	g_return_val_if_fail (GDATA_IS_BLOB_STORE (self), 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	size = self->priv->size;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return size;
+}
+
+/* Must be called with the store's lock held. Marks @info as just used, both in memory and on disk. */
+static void
+touch_blob_unlocked (GDataBlobStore *self, BlobInfo *info, const gchar *path)
+{
+	GDataBlobStorePrivate *priv = self->priv;
+
+	info->last_used = g_get_monotonic_time ();
+
+	g_queue_unlink (&(priv->lru), info->link);
+	g_queue_push_head_link (&(priv->lru), info->link);
+
+	g_utime (path, NULL);
+}
+
+/* Must be called with the store's lock held. Maps the blob with the given @hash into memory, or returns %NULL if it isn't in the store. The file
+ * is mapped before the lock is released so that it can't be evicted in between. */
+static GBytes *
+map_blob_unlocked (GDataBlobStore *self, const gchar *hash)
+{
+	GDataBlobStorePrivate *priv = self->priv;
+	BlobInfo *info;
+	GMappedFile *mapped_file;
+	GBytes *bytes;
+	gchar *path;
+
+	info = g_hash_table_lookup (priv->blobs, hash);
+	if (info == NULL)
+		return NULL;
+
+	path = g_build_filename (priv->blobs_directory, hash, NULL);
+	mapped_file = g_mapped_file_new (path, FALSE, NULL);
+
+	if (mapped_file == NULL) {
+		/* The file's been deleted behind our back */
+		g_queue_delete_link (&(priv->lru), info->link);
+		priv->size -= info->size;
+		g_hash_table_remove (priv->blobs, hash);
+		g_free (path);
+
+		return NULL;
+	}
+
+	touch_blob_unlocked (self, info, path);
+	g_free (path);
+
+	bytes = g_mapped_file_get_bytes (mapped_file);
+	g_mapped_file_unref (mapped_file);
+
+	return bytes;
+}
+
+static gchar *
+get_alias_path (GDataBlobStore *self, const gchar *uri)
+{
+	gchar *checksum, *path;
+
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+	path = g_build_filename (self->priv->aliases_directory, checksum, NULL);
+	g_free (checksum);
+
+	return path;
+}
+
+/* Must be called with the store's lock held. Looks up the blob last stored for @uri, returning it and its ETag and content type if it's
+ * present and its ETag matches @etag (or @etag is %NULL). */
+static GBytes *
+lookup_uri_unlocked (GDataBlobStore *self, const gchar *uri, const gchar *etag, gchar **stored_etag, gchar **content_type)
+{
+	GBytes *bytes = NULL;
+	gchar *path, *hash = NULL, *_stored_etag = NULL, *_content_type = NULL;
+
+	path = get_alias_path (self, uri);
+
+	if (alias_load (path, uri, &hash, &_stored_etag, &_content_type) == TRUE && (etag == NULL || g_strcmp0 (etag, _stored_etag) == 0)) {
+		bytes = map_blob_unlocked (self, hash);
+
+		/* Tidy up the alias if its blob has been evicted */
+		if (bytes == NULL)
+			g_unlink (path);
+	}
+
+	if (bytes != NULL && stored_etag != NULL) {
+		*stored_etag = _stored_etag;
+		_stored_etag = NULL;
+	}
+
+	if (bytes != NULL && content_type != NULL) {
+		*content_type = _content_type;
+		_content_type = NULL;
+	}
+
+	g_free (_content_type);
+	g_free (_stored_etag);
+	g_free (hash);
+	g_free (path);
+
+	return bytes;
+}
+
+/**
+ * gdata_blob_store_lookup:
+ * @self: a #GDataBlobStore
+ * @hash: the SHA-256 checksum of the blob's contents, in hexadecimal, as returned by gdata_blob_store_add()
+ *
+ * Looks up a blob by its checksum.
+ *
+ * The blob's contents are mapped into memory rather than being read, so this is cheap however large the blob is. The mapping stays valid until the
+ * returned #GBytes is freed, even if the blob is evicted from the store in the meantime.
+ *
+ * Return value: (transfer full) (allow-none): the contents of the blob, or %NULL if it isn't in the store; unref with g_bytes_unref()
+ *
+ * Since: 0.15.0
+ **/
+GBytes *
+gdata_blob_store_lookup (GDataBlobStore *self, const gchar *hash)
+{
+	GBytes *bytes;
+
+	g_return_val_if_fail (GDATA_IS_BLOB_STORE (self), NULL);
+	g_return_val_if_fail (hash != NULL, NULL);
+
+	g_mutex_lock (&(self->priv->mutex));
+	bytes = map_blob_unlocked (self, hash);
+	_gdata_cache_manager_record_lookup (self->priv->registration, bytes != NULL);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return bytes;
+}
+
+/**
+ * gdata_blob_store_lookup_uri:
+ * @self: a #GDataBlobStore
+ * @uri: the URI the blob was downloaded from
+ * @etag: (allow-none): the ETag of the version of the blob which is wanted, or %NULL to accept whichever version was stored last
+ * @content_type: (out callee-allocates) (transfer full) (allow-none): return location for the content type the blob was stored with, or %NULL
+ *
+ * Looks up the blob most recently stored for @uri, as long as it's the version identified by @etag. The blob is returned in the same way as by
+ * gdata_blob_store_lookup().
+ *
+ * If no content type was given when the blob was stored, or the blob isn't found, @content_type is set to %NULL.
+ *
+ * Return value: (transfer full) (allow-none): the contents of the blob, or %NULL if it isn't in the store; unref with g_bytes_unref()
+ *
+ * Since: 0.15.0
+ **/
+GBytes *
+gdata_blob_store_lookup_uri (GDataBlobStore *self, const gchar *uri, const gchar *etag, gchar **content_type)
+{
+	GBytes *bytes;
+
+	g_return_val_if_fail (GDATA_IS_BLOB_STORE (self), NULL);
+	g_return_val_if_fail (uri != NULL, NULL);
+
+	if (content_type != NULL)
+		*content_type = NULL;
+
+	g_mutex_lock (&(self->priv->mutex));
+	bytes = lookup_uri_unlocked (self, uri, etag, NULL, content_type);
+	_gdata_cache_manager_record_lookup (self->priv->registration, bytes != NULL);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return bytes;
+}
+
+/**
+ * gdata_blob_store_remove_uri:
+ * @self: a #GDataBlobStore
+ * @uri: the URI to forget
+ *
+ * Removes the alias of @uri from the store, so that its blob is no longer returned by gdata_blob_store_lookup_uri() for it. The blob itself stays
+ * in the store, since it might also have been stored for other URIs, until it's evicted.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_blob_store_remove_uri (GDataBlobStore *self, const gchar *uri)
+{
+	gchar *path;
+
+	g_return_if_fail (GDATA_IS_BLOB_STORE (self));
+	g_return_if_fail (uri != NULL);
+
+	path = get_alias_path (self, uri);
+
+	g_mutex_lock (&(self->priv->mutex));
+	g_unlink (path);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_free (path);
+}
+
+/**
+ * gdata_blob_store_add:
+ * @self: a #GDataBlobStore
+ * @uri: (allow-none): the URI @data was downloaded from, or %NULL
+ * @etag: (allow-none): the ETag of the version of @data, or %NULL
+ * @content_type: (allow-none): the content type of @data, or %NULL
+ * @data: the contents of the blob
+ * @error: a #GError, or %NULL
+ *
+ * Stores @data in the store, if it isn't already there, and returns its checksum. If @uri is non-%NULL, the blob is also made the current version
+ * of @uri for gdata_blob_store_lookup_uri(), replacing any earlier version; @etag and @content_type are stored with it.
+ *
+ * If the store grows beyond the #GDataCacheManager:budget as a result, the least recently used blobs are evicted.
+ *
+ * Return value: (transfer full): the SHA-256 checksum of @data, in hexadecimal, or %NULL on error; free with g_free()
+ *
+ * Since: 0.15.0
+ **/
+gchar *
+gdata_blob_store_add (GDataBlobStore *self, const gchar *uri, const gchar *etag, const gchar *content_type, GBytes *data, GError **error)
+{
+	GDataBlobWriter *writer;
+	gconstpointer contents;
+	gsize length;
+
+	g_return_val_if_fail (GDATA_IS_BLOB_STORE (self), NULL);
+	g_return_val_if_fail (data != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	writer = _gdata_blob_store_begin_write (self, error);
+	if (writer == NULL)
+		return NULL;
+
+	contents = g_bytes_get_data (data, &length);
+	if (_gdata_blob_writer_write (writer, contents, length, error) == FALSE) {
+		_gdata_blob_writer_abort (writer);
+		return NULL;
+	}
+
+	return _gdata_blob_writer_commit (writer, uri, etag, content_type, error);
+}
+
+/*
+ * _gdata_blob_store_lookup_uri_latest:
+ * @self: a #GDataBlobStore
+ * @uri: the URI the blob was downloaded from
+ * @etag: (out callee-allocates) (transfer full): return location for the ETag the blob was stored with, or %NULL if it has none
+ * @content_type: (out callee-allocates) (transfer full): return location for the content type the blob was stored with, or %NULL if it has none
+ *
+ * Looks up the blob most recently stored for @uri, whatever its version, so that it can be revalidated with the server using its ETag. This is
+ * counted in the store's statistics as a hit or miss by the caller, with _gdata_blob_store_record_lookup(), once it knows whether the blob is
+ * current.
+ *
+ * Return value: (transfer full) (allow-none): the contents of the blob, or %NULL if it isn't in the store
+ *
+ * Since: 0.15.0
+ */
+GBytes *
+_gdata_blob_store_lookup_uri_latest (GDataBlobStore *self, const gchar *uri, gchar **etag, gchar **content_type)
+{
+	GBytes *bytes;
+
+	*etag = NULL;
+	*content_type = NULL;
+
+	g_mutex_lock (&(self->priv->mutex));
+	bytes = lookup_uri_unlocked (self, uri, NULL, etag, content_type);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return bytes;
+}
+
+/*
+ * _gdata_blob_store_record_lookup:
+ * @self: a #GDataBlobStore
+ * @hit: %TRUE if a blob was read from the store, %FALSE if it had to be downloaded
+ *
+ * Counts a lookup made with _gdata_blob_store_lookup_uri_latest() in the store's statistics.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_blob_store_record_lookup (GDataBlobStore *self, gboolean hit)
+{
+	_gdata_cache_manager_record_lookup (self->priv->registration, hit);
+}
+
+/*
+ * _gdata_blob_store_begin_write:
+ * @self: a #GDataBlobStore
+ * @error: a #GError, or %NULL
+ *
+ * Starts writing a new blob to the store, which can be done piece by piece as it's downloaded with _gdata_blob_writer_write(). The blob isn't
+ * visible in the store until it's committed with _gdata_blob_writer_commit(); if the download fails, it must be abandoned with
+ * _gdata_blob_writer_abort() instead.
+ *
+ * Return value: (transfer full): a new writer, or %NULL on error
+ *
+ * Since: 0.15.0
+ */
+GDataBlobWriter *
+_gdata_blob_store_begin_write (GDataBlobStore *self, GError **error)
+{
+	GDataBlobWriter *writer;
+	gchar *temp_path;
+	gint fd;
+
+	/* Write to a temporary file in the same directory, so that it can be renamed into place */
+	temp_path = g_build_filename (self->priv->blobs_directory, ".blob-XXXXXX", NULL);
+	fd = g_mkstemp_full (temp_path, O_WRONLY | O_CREAT | O_EXCL, 0600);
+
+	if (fd < 0) {
+		gint errsv = errno;
+
+		g_set_error_literal (error, G_IO_ERROR, g_io_error_from_errno (errsv), g_strerror (errsv));
+		g_free (temp_path);
+
+		return NULL;
+	}
+
+	writer = g_slice_new0 (GDataBlobWriter);
+	writer->store = g_object_ref (self);
+	writer->temp_path = temp_path;
+	writer->fd = fd;
+	writer->checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+	return writer;
+}
+
+/*
+ * _gdata_blob_writer_write:
+ * @writer: a #GDataBlobWriter
+ * @data: the next part of the blob's contents
+ * @length: the length of @data, in bytes
+ * @error: a #GError, or %NULL
+ *
+ * Appends @data to the blob being written. On error, the writer must be abandoned with _gdata_blob_writer_abort().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_blob_writer_write (GDataBlobWriter *writer, gconstpointer data, gsize length, GError **error)
+{
+	const gchar *chunk = data;
+
+	g_checksum_update (writer->checksum, data, length);
+	writer->length += length;
+
+	while (length > 0) {
+		gssize length_written = write (writer->fd, chunk, length);
+
+		if (length_written < 0 && errno == EINTR) {
+			continue;
+		} else if (length_written < 0) {
+			gint errsv = errno;
+
+			g_set_error_literal (error, G_IO_ERROR, g_io_error_from_errno (errsv), g_strerror (errsv));
+			return FALSE;
+		}
+
+		chunk += length_written;
+		length -= length_written;
+	}
+
+	return TRUE;
+}
+
+static void
+blob_writer_free (GDataBlobWriter *writer)
+{
+	if (writer->fd >= 0)
+		close (writer->fd);
+
+	g_checksum_free (writer->checksum);
+	g_free (writer->temp_path);
+	g_object_unref (writer->store);
+	g_slice_free (GDataBlobWriter, writer);
+}
+
+/*
+ * _gdata_blob_writer_abort:
+ * @writer: (transfer full): a #GDataBlobWriter
+ *
+ * Abandons the blob being written by @writer, and frees the writer.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_blob_writer_abort (GDataBlobWriter *writer)
+{
+	g_unlink (writer->temp_path);
+	blob_writer_free (writer);
+}
+
+/* Must be called with the store's lock held */
+static void
+write_alias_unlocked (GDataBlobStore *self, const gchar *uri, const gchar *etag, const gchar *content_type, const gchar *hash)
+{
+	gchar *path, *contents;
+
+	path = get_alias_path (self, uri);
+
+	/* The fields are separated by newlines, so a field containing one can't be stored; it's better to forget the URI than to store it wrongly */
+	if ((etag != NULL && strchr (etag, '\n') != NULL) || (content_type != NULL && strchr (content_type, '\n') != NULL)) {
+		g_unlink (path);
+		g_free (path);
+		return;
+	}
+
+	contents = g_strdup_printf ("%s\n%s\n%s\n%s", hash, (etag != NULL) ? etag : "", (content_type != NULL) ? content_type : "", uri);
+
+	if (g_file_set_contents (path, contents, -1, NULL) == FALSE)
+		g_debug ("Failed to store blob alias file '%s'.", path);
+
+	g_free (contents);
+	g_free (path);
+}
+
+/*
+ * _gdata_blob_writer_commit:
+ * @writer: (transfer full): a #GDataBlobWriter
+ * @uri: (allow-none): the URI the blob was downloaded from, or %NULL
+ * @etag: (allow-none): the ETag of the version of the blob, or %NULL
+ * @content_type: (allow-none): the content type of the blob, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Finishes writing the blob and adds it to the store, or just marks the existing copy as used if the store already has a blob with the same
+ * contents; then updates the alias of @uri, as with gdata_blob_store_add(). The writer is freed, whether this succeeds or not.
+ *
+ * Return value: (transfer full): the checksum of the blob, or %NULL on error
+ *
+ * Since: 0.15.0
+ */
+gchar *
+_gdata_blob_writer_commit (GDataBlobWriter *writer, const gchar *uri, const gchar *etag, const gchar *content_type, GError **error)
+{
+	GDataBlobStore *self = writer->store;
+	GDataBlobStorePrivate *priv = self->priv;
+	BlobInfo *info;
+	gchar *hash, *path;
+	gboolean grown = FALSE;
+
+	if (close (writer->fd) != 0) {
+		gint errsv = errno;
+
+		writer->fd = -1;
+		g_set_error_literal (error, G_IO_ERROR, g_io_error_from_errno (errsv), g_strerror (errsv));
+		_gdata_blob_writer_abort (writer);
+
+		return NULL;
+	}
+
+	writer->fd = -1;
+
+	hash = g_strdup (g_checksum_get_string (writer->checksum));
+	path = g_build_filename (priv->blobs_directory, hash, NULL);
+
+	g_mutex_lock (&(priv->mutex));
+
+	info = g_hash_table_lookup (priv->blobs, hash);
+
+	if (info != NULL) {
+		/* We've already got this blob, so only keep one copy of it */
+		g_unlink (writer->temp_path);
+		touch_blob_unlocked (self, info, path);
+	} else if (g_rename (writer->temp_path, path) != 0) {
+		gint errsv = errno;
+
+		g_mutex_unlock (&(priv->mutex));
+
+		g_set_error_literal (error, G_IO_ERROR, g_io_error_from_errno (errsv), g_strerror (errsv));
+		_gdata_blob_writer_abort (writer);
+		g_free (path);
+		g_free (hash);
+
+		return NULL;
+	} else {
+		info = g_slice_new0 (BlobInfo);
+		info->hash = g_strdup (hash);
+		info->size = writer->length;
+		info->last_used = g_get_monotonic_time ();
+
+		g_hash_table_insert (priv->blobs, info->hash, info);
+		g_queue_push_head (&(priv->lru), info);
+		info->link = priv->lru.head;
+		priv->size += info->size;
+
+		grown = TRUE;
+	}
+
+	if (uri != NULL)
+		write_alias_unlocked (self, uri, etag, content_type, hash);
+
+	g_mutex_unlock (&(priv->mutex));
+
+	/* This mustn't be called with our lock held */
+	if (grown == TRUE)
+		_gdata_cache_manager_cache_grown (priv->registration);
+
+	blob_writer_free (writer);
+	g_free (path);
+
+	return hash;
+}
@@ -0,0 +1,77 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_BLOB_STORE_H
+#define GDATA_BLOB_STORE_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_BLOB_STORE		(gdata_blob_store_get_type ())
+#define GDATA_BLOB_STORE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_BLOB_STORE, GDataBlobStore))
+#define GDATA_BLOB_STORE_CLASS(k)	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_BLOB_STORE, GDataBlobStoreClass))
+#define GDATA_IS_BLOB_STORE(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_BLOB_STORE))
+#define GDATA_IS_BLOB_STORE_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_BLOB_STORE))
+#define GDATA_BLOB_STORE_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_BLOB_STORE, GDataBlobStoreClass))
+
+typedef struct _GDataBlobStorePrivate	GDataBlobStorePrivate;
+
+/**
+ * GDataBlobStore:
+ *
+ * All the fields in the #GDataBlobStore structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataBlobStorePrivate *priv;
+} GDataBlobStore;
+
+/**
+ * GDataBlobStoreClass:
+ *
+ * All the fields in the #GDataBlobStoreClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataBlobStoreClass;
+
+GType gdata_blob_store_get_type (void) G_GNUC_CONST;
+
+GDataBlobStore *gdata_blob_store_new (const gchar *directory) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+const gchar *gdata_blob_store_get_directory (GDataBlobStore *self) G_GNUC_PURE;
+guint64 gdata_blob_store_get_size (GDataBlobStore *self);
+
+gchar *gdata_blob_store_add (GDataBlobStore *self, const gchar *uri, const gchar *etag, const gchar *content_type, GBytes *data,
+                             GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GBytes *gdata_blob_store_lookup (GDataBlobStore *self, const gchar *hash) G_GNUC_WARN_UNUSED_RESULT;
+GBytes *gdata_blob_store_lookup_uri (GDataBlobStore *self, const gchar *uri, const gchar *etag, gchar **content_type) G_GNUC_WARN_UNUSED_RESULT;
+void gdata_blob_store_remove_uri (GDataBlobStore *self, const gchar *uri);
+
+G_END_DECLS
+
+#endif /* !GDATA_BLOB_STORE_H */
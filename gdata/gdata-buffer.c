@@ -25,6 +25,10 @@
  *
  * #GDataBuffer is a simple object which allows threadsafe buffering of data meaning, for example, data can be received from
  * the network in a "push" fashion, buffered, then sent out to an output stream in a "pull" fashion.
+ *
+ * By default, the buffer is an unbounded list of chunks protected by a mutex. A #GDataBuffer created with gdata_buffer_new_ring() instead uses a
+ * fixed-size ring buffer, which must only be used by a single pushing thread and a single popping thread. It avoids allocating memory on each
+ * push, and only takes the mutex when one of the threads has to wait for the other because the ring is empty or full.
  */
 
 #include <config.h>
@@ -32,16 +36,178 @@
 #include <string.h>
 
 #include "gdata-buffer.h"
+#include "gdata-trace.h"
 
 struct _GDataBufferChunk {
 	/*< private >*/
 	guint8 *data;
 	gsize length;
 	GDataBufferChunk *next;
-	/* Note: the data is actually allocated in the same memory block, so it's inside this comment right now.
-	 * We simply set chunk->data to point to chunk + sizeof (GDataBufferChunk). */
+	GDestroyNotify free_func; /* NULL unless the data was pushed with gdata_buffer_push_data_full() */
+	gpointer free_data;
+	/* Note: unless the chunk was pushed with gdata_buffer_push_data_full(), the data is actually allocated in the same memory block, so it's
+	 * inside this comment right now. We simply set chunk->data to point to chunk + sizeof (GDataBufferChunk). */
 };
 
+/* The ring buffer backend. ->ring_head and ->ring_tail count the total number of bytes ever popped and pushed, so the number of bytes in the ring is
+ * always (tail - head), even once they've wrapped around, and the ring is indexed by masking them with (capacity - 1). Since only the popping thread
+ * writes ->ring_head and only the pushing thread writes ->ring_tail, neither needs the mutex unless it has to wait for the other. In that case it
+ * sets its flag in ->ring_waiting and waits on ->cond or ->space_cond with ->mutex held; the other thread checks the flag after updating its index
+ * and takes ->mutex to signal the waiter. ->reached_eof is accessed atomically in this mode. */
+#define RING_POPPER_WAITING (1 << 0)
+#define RING_PUSHER_WAITING (1 << 1)
+
+#define MIN_RING_CAPACITY 4096
+#define MAX_RING_CAPACITY (1 << 30)
+
+static inline guint
+ring_length (GDataBuffer *self)
+{
+	return (guint) g_atomic_int_get (&(self->ring_tail)) - (guint) g_atomic_int_get (&(self->ring_head));
+}
+
+/* Adds @delta to the buffer's length counter, if it has one */
+static inline void
+count_length (GDataBuffer *self, gssize delta)
+{
+	if (self->length_counter != NULL)
+		g_atomic_pointer_add (self->length_counter, delta);
+}
+
+static void
+ring_wake (GDataBuffer *self, gint waiter, GCond *cond)
+{
+	if ((g_atomic_int_get (&(self->ring_waiting)) & waiter) != 0) {
+		g_mutex_lock (&(self->mutex));
+		g_cond_broadcast (cond);
+		g_mutex_unlock (&(self->mutex));
+	}
+}
+
+/* Copy @length bytes into the ring, blocking whenever it's full until the popping thread has freed up half of it (or as much as we need, if that's
+ * less). If @cancelled is non-%NULL and becomes %TRUE while blocking, give up and return %FALSE; some of the data may already have been pushed. */
+static gboolean
+ring_push (GDataBuffer *self, const guint8 *data, gsize length, gboolean *cancelled)
+{
+	GDATA_TRACE2 (buffer_push, self, length);
+
+	while (length > 0) {
+		guint head, tail, space, offset, n, first;
+
+		tail = (guint) g_atomic_int_get (&(self->ring_tail));
+		head = (guint) g_atomic_int_get (&(self->ring_head));
+		space = self->ring_capacity - (tail - head);
+
+		if (space == 0) {
+			gboolean was_cancelled;
+
+			g_mutex_lock (&(self->mutex));
+			g_atomic_int_or (&(self->ring_waiting), RING_PUSHER_WAITING);
+
+			while (self->ring_capacity - ring_length (self) < MIN (length, self->ring_capacity / 2) &&
+			       (cancelled == NULL || *cancelled == FALSE)) {
+				g_cond_wait (&(self->space_cond), &(self->mutex));
+			}
+
+			g_atomic_int_and (&(self->ring_waiting), ~RING_PUSHER_WAITING);
+			was_cancelled = (cancelled != NULL && *cancelled == TRUE);
+			g_mutex_unlock (&(self->mutex));
+
+			if (was_cancelled == TRUE)
+				return FALSE;
+
+			continue;
+		}
+
+		n = MIN (space, length);
+		offset = tail & (self->ring_capacity - 1);
+		first = MIN (n, self->ring_capacity - offset);
+
+		memcpy (self->ring + offset, data, first);
+		memcpy (self->ring, data + first, n - first);
+
+		/* Publish the data, then wake the popping thread if it's waiting for it */
+		g_atomic_int_set (&(self->ring_tail), (gint) (tail + n));
+		count_length (self, n);
+		ring_wake (self, RING_POPPER_WAITING, &(self->cond));
+
+		data += n;
+		length -= n;
+	}
+
+	return TRUE;
+}
+
+/* Copy up to @length bytes out of the ring (or drop them if @data is %NULL). If @fill is %TRUE, block until @length bytes have been popped or EOF is
+ * reached; otherwise only block if the ring is empty. In both cases, stop blocking if @cancelled becomes %TRUE. */
+static gsize
+ring_pop (GDataBuffer *self, guint8 *data, gsize length, gboolean fill, gboolean *reached_eof, gboolean *cancelled)
+{
+	gsize popped = 0;
+
+	while (popped < length) {
+		guint head, available, offset, n, first;
+
+		head = (guint) g_atomic_int_get (&(self->ring_head));
+		available = (guint) g_atomic_int_get (&(self->ring_tail)) - head;
+
+		if (available == 0) {
+			gboolean stop;
+
+			if (fill == FALSE && popped > 0)
+				break;
+
+			g_mutex_lock (&(self->mutex));
+			g_atomic_int_or (&(self->ring_waiting), RING_POPPER_WAITING);
+
+			while (ring_length (self) == 0 && g_atomic_int_get (&(self->reached_eof)) == FALSE && *cancelled == FALSE)
+				g_cond_wait (&(self->cond), &(self->mutex));
+
+			g_atomic_int_and (&(self->ring_waiting), ~RING_POPPER_WAITING);
+			stop = (ring_length (self) == 0);
+			g_mutex_unlock (&(self->mutex));
+
+			/* EOF or cancellation */
+			if (stop == TRUE)
+				break;
+
+			continue;
+		}
+
+		n = MIN (available, length - popped);
+		offset = head & (self->ring_capacity - 1);
+		first = MIN (n, self->ring_capacity - offset);
+
+		if (data != NULL) {
+			memcpy (data + popped, self->ring + offset, first);
+			memcpy (data + popped + first, self->ring, n - first);
+		}
+
+		/* Release the space, then wake the pushing thread if it's waiting for it */
+		g_atomic_int_set (&(self->ring_head), (gint) (head + n));
+		count_length (self, -((gssize) n));
+		ring_wake (self, RING_PUSHER_WAITING, &(self->space_cond));
+
+		popped += n;
+	}
+
+	if (reached_eof != NULL)
+		*reached_eof = (g_atomic_int_get (&(self->reached_eof)) == TRUE && ring_length (self) == 0);
+
+	GDATA_TRACE2 (buffer_pop, self, popped);
+
+	return popped;
+}
+
+static void
+free_chunk (GDataBufferChunk *chunk)
+{
+	if (chunk->free_func != NULL)
+		chunk->free_func (chunk->free_data);
+
+	g_free (chunk);
+}
+
 /**
  * gdata_buffer_new:
  *
@@ -58,6 +224,32 @@ gdata_buffer_new (void)
 
 	g_mutex_init (&(buffer->mutex));
 	g_cond_init (&(buffer->cond));
+	g_cond_init (&(buffer->space_cond));
+
+	return buffer;
+}
+
+/**
+ * gdata_buffer_new_ring:
+ * @capacity: the number of bytes the buffer should be able to hold
+ *
+ * Creates a new empty #GDataBuffer backed by a fixed-size ring buffer. @capacity is rounded up to a power of two. Unlike a buffer created with
+ * gdata_buffer_new(), it must only ever be pushed to by one thread and popped from by one other thread, and pushing to it blocks while it's full
+ * (so gdata_buffer_set_limits() has no effect on it). In return, pushing and popping don't allocate memory, and only take a lock if one of the
+ * threads has to wait for the other.
+ *
+ * Return value: a new #GDataBuffer; free with gdata_buffer_free()
+ *
+ * Since: 0.15.0
+ **/
+GDataBuffer *
+gdata_buffer_new_ring (gsize capacity)
+{
+	GDataBuffer *buffer = gdata_buffer_new ();
+
+	capacity = CLAMP (capacity, MIN_RING_CAPACITY, MAX_RING_CAPACITY);
+	buffer->ring_capacity = 1 << g_bit_storage (capacity - 1);
+	buffer->ring = g_malloc (buffer->ring_capacity);
 
 	return buffer;
 }
@@ -78,11 +270,16 @@ gdata_buffer_free (GDataBuffer *self)
 
 	g_return_if_fail (self != NULL);
 
+	count_length (self, -((gssize) ((self->ring != NULL) ? ring_length (self) : self->total_length)));
+
 	for (chunk = self->head; chunk != NULL; chunk = next_chunk) {
 		next_chunk = chunk->next;
-		g_free (chunk);
+		free_chunk (chunk);
 	}
 
+	g_free (self->ring);
+
+	g_cond_clear (&(self->space_cond));
 	g_cond_clear (&(self->cond));
 	g_mutex_clear (&(self->mutex));
 
@@ -90,30 +287,89 @@ gdata_buffer_free (GDataBuffer *self)
 }
 
 /**
- * gdata_buffer_push_data:
+ * gdata_buffer_set_limits:
  * @self: a #GDataBuffer
- * @data: the data to push onto the buffer
- * @length: the length of @data
+ * @high_water_mark: the number of bytes above which gdata_buffer_push_data_bounded() will block, or <code class="literal">0</code> for no limit
+ * @low_water_mark: the number of bytes to which the buffer must drain before blocked pushes are resumed
  *
- * Pushes @length bytes of @data onto the buffer, taking a copy of the data. If @data is %NULL and @length is <code class="literal">0</code>,
- * the buffer will be marked as having reached the EOF, and subsequent calls to gdata_buffer_push_data()
- * will fail and return %FALSE.
+ * Sets the limits used by gdata_buffer_push_data_bounded() to apply backpressure to the pushing thread, so that the amount of memory used by the
+ * buffer stays roughly constant when data is pushed faster than it is popped. @low_water_mark must be no greater than @high_water_mark. Calls to
+ * gdata_buffer_push_data() and gdata_buffer_push_data_full() never block because of the limits. The limits have no effect on a buffer created with
+ * gdata_buffer_new_ring(), which blocks pushes whenever it's full instead.
  *
- * Assuming the buffer hasn't reached EOF, this operation is guaranteed to succeed (unless memory allocation fails).
+ * This function is threadsafe.
  *
- * This function holds the lock on the #GDataBuffer, and signals any waiting calls to gdata_buffer_pop_data() once
- * the new data has been pushed onto the buffer. This function is threadsafe.
+ * Since: 0.15.0
+ **/
+void
+gdata_buffer_set_limits (GDataBuffer *self, gsize high_water_mark, gsize low_water_mark)
+{
+	g_return_if_fail (self != NULL);
+	g_return_if_fail (low_water_mark <= high_water_mark);
+
+	g_mutex_lock (&(self->mutex));
+	self->high_water_mark = high_water_mark;
+	self->low_water_mark = low_water_mark;
+	g_cond_broadcast (&(self->space_cond));
+	g_mutex_unlock (&(self->mutex));
+}
+
+/**
+ * gdata_buffer_set_length_counter:
+ * @self: a #GDataBuffer
+ * @length_counter: (allow-none): a counter to keep the buffer's length added to, or %NULL
  *
- * Return value: %TRUE on success, %FALSE otherwise
+ * Sets a counter which the number of bytes currently held in the buffer is added to, and which is kept up to date atomically as data is pushed
+ * and popped, until the buffer is freed or another counter is set. This allows the total amount of data held in several buffers to be read cheaply
+ * from any thread. The buffer's current length is moved from any previous counter to @length_counter.
  *
- * Since: 0.5.0
+ * The counter is updated with g_atomic_pointer_add() without taking a lock, so must be read with g_atomic_pointer_get(). This function must only
+ * be called while no other thread is pushing to or popping from the buffer.
+ *
+ * Since: 0.15.0
  **/
-gboolean
-gdata_buffer_push_data (GDataBuffer *self, const guint8 *data, gsize length)
+void
+gdata_buffer_set_length_counter (GDataBuffer *self, volatile gsize *length_counter)
+{
+	gsize length;
+
+	g_return_if_fail (self != NULL);
+
+	length = (self->ring != NULL) ? ring_length (self) : self->total_length;
+
+	count_length (self, -((gssize) length));
+	self->length_counter = length_counter;
+	count_length (self, length);
+}
+
+static gboolean
+push_chunk (GDataBuffer *self, const guint8 *data, gsize length, GDestroyNotify free_func, gpointer free_data)
 {
 	GDataBufferChunk *chunk;
 
-	g_return_val_if_fail (self != NULL, 0);
+	GDATA_TRACE2 (buffer_push, self, length);
+
+	if (self->ring != NULL) {
+		gboolean success = FALSE;
+
+		if (G_UNLIKELY (g_atomic_int_get (&(self->reached_eof)) == TRUE)) {
+			/* Don't accept any more data after EOF */
+		} else if (G_UNLIKELY (data == NULL && length == 0)) {
+			/* Mark EOF and wake the popping thread */
+			g_mutex_lock (&(self->mutex));
+			g_atomic_int_set (&(self->reached_eof), TRUE);
+			g_cond_broadcast (&(self->cond));
+			g_mutex_unlock (&(self->mutex));
+		} else {
+			success = ring_push (self, data, length, NULL);
+		}
+
+		/* The ring always takes a copy. On failure, gdata_buffer_push_data_full() calls @free_func itself. */
+		if (success == TRUE && free_func != NULL)
+			free_func (free_data);
+
+		return success;
+	}
 
 	g_mutex_lock (&(self->mutex));
 
@@ -131,14 +387,23 @@ gdata_buffer_push_data (GDataBuffer *self, const guint8 *data, gsize length)
 	}
 
 	/* Create the chunk */
-	chunk = g_malloc (sizeof (GDataBufferChunk) + length);
-	chunk->data = (guint8*) ((guint8*) chunk + sizeof (GDataBufferChunk)); /* pointer arithmetic in terms of bytes here */
+	if (free_func == NULL) {
+		chunk = g_malloc (sizeof (GDataBufferChunk) + length);
+		chunk->data = (guint8*) ((guint8*) chunk + sizeof (GDataBufferChunk)); /* pointer arithmetic in terms of bytes here */
+
+		/* Copy the data to the chunk */
+		if (G_LIKELY (data != NULL))
+			memcpy (chunk->data, data, length);
+	} else {
+		/* Reference the caller's data */
+		chunk = g_malloc (sizeof (GDataBufferChunk));
+		chunk->data = (guint8*) data;
+	}
+
 	chunk->length = length;
 	chunk->next = NULL;
-
-	/* Copy the data to the chunk */
-	if (G_LIKELY (data != NULL))
-		memcpy (chunk->data, data, length);
+	chunk->free_func = free_func;
+	chunk->free_data = free_data;
 
 	/* Add it to the buffer's tail */
 	if (self->tail != NULL)
@@ -147,6 +412,7 @@ gdata_buffer_push_data (GDataBuffer *self, const guint8 *data, gsize length)
 		self->head = chunk;
 	self->tail = &(chunk->next);
 	self->total_length += length;
+	count_length (self, length);
 
 	/* Signal any threads waiting to pop that data is available */
 	g_cond_signal (&(self->cond));
@@ -156,11 +422,198 @@ gdata_buffer_push_data (GDataBuffer *self, const guint8 *data, gsize length)
 	return TRUE;
 }
 
+/**
+ * gdata_buffer_push_data:
+ * @self: a #GDataBuffer
+ * @data: the data to push onto the buffer
+ * @length: the length of @data
+ *
+ * Pushes @length bytes of @data onto the buffer, taking a copy of the data. If @data is %NULL and @length is <code class="literal">0</code>,
+ * the buffer will be marked as having reached the EOF, and subsequent calls to gdata_buffer_push_data()
+ * will fail and return %FALSE.
+ *
+ * Assuming the buffer hasn't reached EOF, this operation is guaranteed to succeed (unless memory allocation fails). If the buffer was created with
+ * gdata_buffer_new_ring(), this blocks while the ring is full.
+ *
+ * This function holds the lock on the #GDataBuffer, and signals any waiting calls to gdata_buffer_pop_data() once
+ * the new data has been pushed onto the buffer. This function is threadsafe.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.5.0
+ **/
+gboolean
+gdata_buffer_push_data (GDataBuffer *self, const guint8 *data, gsize length)
+{
+	g_return_val_if_fail (self != NULL, 0);
+
+	return push_chunk (self, data, length, NULL, NULL);
+}
+
+/**
+ * gdata_buffer_push_data_full:
+ * @self: a #GDataBuffer
+ * @data: the data to push onto the buffer
+ * @length: the length of @data
+ * @free_func: a function to call once @data is no longer needed by the buffer
+ * @free_data: data to pass to @free_func
+ *
+ * Pushes @length bytes of @data onto the buffer without copying them, in the same manner as gdata_buffer_push_data(). @data must remain valid until
+ * it has been entirely popped off the buffer or the buffer has been freed, at which point @free_func will be called with @free_data. This is called
+ * from whichever thread pops the last of @data.
+ *
+ * If the data can't be pushed onto the buffer (because the buffer has already reached EOF), @free_func is called immediately.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_buffer_push_data_full (GDataBuffer *self, const guint8 *data, gsize length, GDestroyNotify free_func, gpointer free_data)
+{
+	g_return_val_if_fail (self != NULL, 0);
+	g_return_val_if_fail (data != NULL && length > 0, 0);
+	g_return_val_if_fail (free_func != NULL, 0);
+
+	if (push_chunk (self, data, length, free_func, free_data) == FALSE) {
+		free_func (free_data);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_buffer_push_data_nonblocking:
+ * @self: a #GDataBuffer
+ * @data: the data to push onto the buffer
+ * @length: the length of @data
+ *
+ * Pushes as much of @data onto the buffer as can be pushed without blocking, taking a copy of it, in the same manner as gdata_buffer_push_data().
+ * For a buffer created with gdata_buffer_new(), that's always all of @data; for one created with gdata_buffer_new_ring(), it's as much as currently
+ * fits in the ring. This allows a buffer to be filled from a thread which mustn't block, such as one running a main loop, which then has to hold
+ * on to the rest of the data until the popping thread has made space for it.
+ *
+ * Nothing is pushed if the buffer has reached EOF. @data must not be %NULL.
+ *
+ * Return value: the number of bytes of @data which were pushed
+ *
+ * Since: 0.15.0
+ **/
+gsize
+gdata_buffer_push_data_nonblocking (GDataBuffer *self, const guint8 *data, gsize length)
+{
+	guint space;
+
+	g_return_val_if_fail (self != NULL, 0);
+	g_return_val_if_fail (data != NULL, 0);
+
+	if (length == 0)
+		return 0;
+
+	if (self->ring == NULL)
+		return (push_chunk (self, data, length, NULL, NULL) == TRUE) ? length : 0;
+
+	if (g_atomic_int_get (&(self->reached_eof)) == TRUE)
+		return 0;
+
+	/* The space can only grow until we next push, since we're the only pushing thread, so pushing at most this much never blocks */
+	space = self->ring_capacity - ring_length (self);
+	length = MIN (length, space);
+
+	if (length > 0)
+		ring_push (self, data, length, NULL);
+
+	return length;
+}
+
 typedef struct {
 	GDataBuffer *buffer;
 	gboolean *cancelled;
 } CancelledData;
 
+static void
+push_cancelled_cb (GCancellable *cancellable, CancelledData *data)
+{
+	/* Signal the push_data_bounded function that it should stop blocking and cancel */
+	g_mutex_lock (&(data->buffer->mutex));
+	*(data->cancelled) = TRUE;
+	g_cond_broadcast (&(data->buffer->space_cond));
+	g_mutex_unlock (&(data->buffer->mutex));
+}
+
+/**
+ * gdata_buffer_push_data_bounded:
+ * @self: a #GDataBuffer
+ * @data: the data to push onto the buffer
+ * @length: the length of @data
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ *
+ * Pushes @length bytes of @data onto the buffer, taking a copy of the data, in the same manner as gdata_buffer_push_data(). However, if the buffer
+ * already contains more data than the high-water mark set with gdata_buffer_set_limits(), this function will first block until enough data has been
+ * popped off the buffer to bring it down to the low-water mark. This allows a producer to be throttled to the speed of the consumer.
+ *
+ * If @cancellable is cancelled from another thread while the function is blocking, it will return %FALSE immediately without pushing @data. %FALSE
+ * is also returned if the buffer has reached EOF.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_buffer_push_data_bounded (GDataBuffer *self, const guint8 *data, gsize length, GCancellable *cancellable)
+{
+	gulong cancelled_signal = 0;
+	gboolean cancelled = FALSE;
+	CancelledData cancelled_data;
+
+	g_return_val_if_fail (self != NULL, FALSE);
+	g_return_val_if_fail (data != NULL || length == 0, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+
+	/* As in gdata_buffer_pop_data(), this must be done before we lock @self->mutex */
+	if (cancellable != NULL) {
+		cancelled_data.buffer = self;
+		cancelled_data.cancelled = &cancelled;
+
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) push_cancelled_cb, &cancelled_data, NULL);
+	}
+
+	if (self->ring != NULL) {
+		gboolean success;
+
+		/* The ring blocks by itself when it's full. EOF has to go through push_chunk(). */
+		if (data == NULL || g_atomic_int_get (&(self->reached_eof)) == TRUE)
+			success = push_chunk (self, data, length, NULL, NULL);
+		else
+			success = ring_push (self, data, length, &cancelled);
+
+		if (cancelled_signal != 0)
+			g_cancellable_disconnect (cancellable, cancelled_signal);
+
+		return success;
+	}
+
+	g_mutex_lock (&(self->mutex));
+
+	if (self->high_water_mark > 0 && self->total_length > self->high_water_mark) {
+		while (self->high_water_mark > 0 && self->total_length > self->low_water_mark &&
+		       cancelled == FALSE && self->reached_eof == FALSE) {
+			g_cond_wait (&(self->space_cond), &(self->mutex));
+		}
+	}
+
+	g_mutex_unlock (&(self->mutex));
+
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	if (cancelled == TRUE)
+		return FALSE;
+
+	return push_chunk (self, data, length, NULL, NULL);
+}
+
 static void
 pop_cancelled_cb (GCancellable *cancellable, CancelledData *data)
 {
@@ -229,6 +682,11 @@ gdata_buffer_pop_data (GDataBuffer *self, guint8 *data, gsize length_requested,
 		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) pop_cancelled_cb, &cancelled_data, NULL);
 	}
 
+	if (self->ring != NULL) {
+		return_length = ring_pop (self, data, length_requested, TRUE, reached_eof, &cancelled);
+		goto disconnect;
+	}
+
 	g_mutex_lock (&(self->mutex));
 
 	/* Set reached_eof */
@@ -268,7 +726,7 @@ gdata_buffer_pop_data (GDataBuffer *self, guint8 *data, gsize length_requested,
 
 	/* We can't assume we'll have enough data, since we may have reached EOF */
 	chunk = self->head;
-	while (chunk != NULL && length_remaining >= chunk->length) {
+	while (chunk != NULL && length_remaining >= chunk->length - self->head_read_offset) {
 		GDataBufferChunk *next_chunk;
 		gsize chunk_length = chunk->length - self->head_read_offset;
 
@@ -281,7 +739,7 @@ gdata_buffer_pop_data (GDataBuffer *self, guint8 *data, gsize length_requested,
 
 		/* Free the chunk and move on */
 		next_chunk = chunk->next;
-		g_free (chunk);
+		free_chunk (chunk);
 		chunk = next_chunk;
 
 		/* Reset the head read offset, since we've processed at least the first chunk now */
@@ -304,10 +762,18 @@ gdata_buffer_pop_data (GDataBuffer *self, guint8 *data, gsize length_requested,
 	if (self->head == NULL)
 		self->tail = NULL;
 	self->total_length -= return_length;
+	count_length (self, -((gssize) return_length));
+
+	/* Wake up any pushes which are blocked on the buffer draining */
+	if (self->high_water_mark > 0 && self->total_length <= self->low_water_mark)
+		g_cond_broadcast (&(self->space_cond));
+
+	GDATA_TRACE2 (buffer_pop, self, return_length);
 
 done:
 	g_mutex_unlock (&(self->mutex));
 
+disconnect:
 	/* Disconnect from the cancelled signal. Note that this has to be done without @self->mutex held, or deadlock can occur.
 	 * (g_cancellable_disconnect() waits for any in-progress signal handler call to finish, which can't happen until the mutex is released.) */
 	if (cancelled_signal != 0)
@@ -339,6 +805,12 @@ gdata_buffer_pop_data_limited (GDataBuffer *self, guint8 *data, gsize maximum_le
 	g_return_val_if_fail (data != NULL, 0);
 	g_return_val_if_fail (maximum_length > 0, 0);
 
+	if (self->ring != NULL) {
+		gboolean cancelled = FALSE;
+
+		return ring_pop (self, data, maximum_length, FALSE, reached_eof, &cancelled);
+	}
+
 	/* If there's no data in the buffer, block until some is available */
 	g_mutex_lock (&(self->mutex));
 	if (self->total_length == 0 && self->reached_eof == FALSE) {
@@ -45,12 +45,32 @@ typedef struct {
 
 	GMutex mutex; /* mutex protecting the entire structure on push and pop */
 	GCond cond; /* a GCond to allow a popping thread to block on data being pushed into the buffer */
+
+	gsize high_water_mark; /* gdata_buffer_push_data_bounded() blocks while total_length is above this; 0 for no limit */
+	gsize low_water_mark; /* blocked pushes are resumed once total_length drops to this or below */
+	GCond space_cond; /* a GCond to allow a pushing thread to block on data being popped off the buffer */
+
+	/* Ring buffer backend, used instead of the chunk list iff ring_capacity > 0; see gdata_buffer_new_ring() */
+	guint8 *ring;
+	guint ring_capacity; /* always a power of two */
+	volatile gint ring_head; /* total number of bytes ever popped (modulo 2^32); only written by the popping thread */
+	volatile gint ring_tail; /* total number of bytes ever pushed (modulo 2^32); only written by the pushing thread */
+	volatile gint ring_waiting; /* flags indicating which threads are waiting on cond or space_cond */
+
+	volatile gsize *length_counter; /* counter to keep adding changes in the buffer's length to, or NULL; see gdata_buffer_set_length_counter() */
 } GDataBuffer;
 
 GDataBuffer *gdata_buffer_new (void) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GDataBuffer *gdata_buffer_new_ring (gsize capacity) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 void gdata_buffer_free (GDataBuffer *self);
 
+void gdata_buffer_set_limits (GDataBuffer *self, gsize high_water_mark, gsize low_water_mark);
+void gdata_buffer_set_length_counter (GDataBuffer *self, volatile gsize *length_counter);
+
 gboolean gdata_buffer_push_data (GDataBuffer *self, const guint8 *data, gsize length);
+gboolean gdata_buffer_push_data_bounded (GDataBuffer *self, const guint8 *data, gsize length, GCancellable *cancellable);
+gboolean gdata_buffer_push_data_full (GDataBuffer *self, const guint8 *data, gsize length, GDestroyNotify free_func, gpointer free_data);
+gsize gdata_buffer_push_data_nonblocking (GDataBuffer *self, const guint8 *data, gsize length);
 gsize gdata_buffer_pop_data (GDataBuffer *self, guint8 *data, gsize length_requested, gboolean *reached_eof, GCancellable *cancellable);
 gsize gdata_buffer_pop_data_limited (GDataBuffer *self, guint8 *data, gsize maximum_length, gboolean *reached_eof);
 
@@ -0,0 +1,569 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-cache-manager
+ * @short_description: GData process-wide cache management
+ * @stability: Unstable
+ * @include: gdata/gdata-cache-manager.h
+ *
+ * #GDataCacheManager oversees all of libgdata's in-memory caches: the entry and ACL caches of each #GDataService (see
+ * #GDataService:entry-cache-size and #GDataService:acl-cache-size), the photo cache of each #GDataContactsService (see
+ * gdata_contacts_service_set_photo_cache()) and the thumbnail cache shared by all #GDataThumbnailPrefetcher<!-- -->s. Each cache keeps its own size
+ * limit, but the manager can additionally hold them all to a combined #GDataCacheManager:budget, and can make them give memory back when the
+ * system is short of it. Any #GDataBlobStore<!-- -->s are included in the budget too, although they're stored on disk, and their blobs are only
+ * evicted once the in-memory caches are empty.
+ *
+ * Whenever it has to free memory, the manager evicts items one at a time from the caches, taking the least recently used item of all of them each
+ * time, except that caches whose contents are cheap to get back (such as images which are also cached on disk) are emptied before any others are
+ * touched.
+ *
+ * On systems with GLib 2.64 or later, the manager listens for low memory warnings from the default #GMemoryMonitor, and trims the caches by an
+ * amount depending on the warning's severity. Applications using older versions of GLib can pass on low memory warnings from elsewhere using
+ * gdata_cache_manager_handle_memory_pressure().
+ *
+ * There's a single manager per process, returned by gdata_cache_manager_get_default(). Its methods may be called from any thread.
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "gdata-cache-manager.h"
+#include "gdata-private.h"
+
+struct _GDataCacheRegistration {
+	gchar *name;
+	GDataCachePriority priority;
+	const GDataCacheFuncs *funcs;
+	gpointer cache;
+
+	volatile gint n_hits;
+	volatile gint n_misses;
+	guint n_evictions; /* evictions made by the manager; protected by its lock */
+};
+
+static void gdata_cache_manager_finalize (GObject *object);
+static void gdata_cache_manager_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_cache_manager_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataCacheManagerPrivate {
+	GMutex mutex; /* protects all the members below */
+	GList *registrations; /* GDataCacheRegistration */
+	guint64 budget;
+
+#if GLIB_CHECK_VERSION (2, 64, 0)
+	GMemoryMonitor *memory_monitor;
+#endif
+};
+
+enum {
+	PROP_BUDGET = 1,
+};
+
+G_DEFINE_TYPE (GDataCacheManager, gdata_cache_manager, G_TYPE_OBJECT)
+
+static void
+gdata_cache_manager_class_init (GDataCacheManagerClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataCacheManagerPrivate));
+
+	gobject_class->finalize = gdata_cache_manager_finalize;
+	gobject_class->get_property = gdata_cache_manager_get_property;
+	gobject_class->set_property = gdata_cache_manager_set_property;
+
+	/**
+	 * GDataCacheManager:budget:
+	 *
+	 * The maximum number of bytes all the caches together may hold, or <code class="literal">0</code> for no limit other than those of the
+	 * individual caches. Whenever the caches grow beyond it, the least recently used items are evicted until they fit again.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_BUDGET,
+	                                 g_param_spec_uint64 ("budget",
+	                                                      "Budget", "The maximum number of bytes all the caches together may hold.",
+	                                                      0, G_MAXUINT64, 0,
+	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+#if GLIB_CHECK_VERSION (2, 64, 0)
+static void
+low_memory_warning_cb (GMemoryMonitor *monitor, GMemoryMonitorWarningLevel level, GDataCacheManager *self)
+{
+	if (level >= G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL)
+		gdata_cache_manager_handle_memory_pressure (self, GDATA_MEMORY_PRESSURE_CRITICAL);
+	else if (level >= G_MEMORY_MONITOR_WARNING_LEVEL_MEDIUM)
+		gdata_cache_manager_handle_memory_pressure (self, GDATA_MEMORY_PRESSURE_MEDIUM);
+	else
+		gdata_cache_manager_handle_memory_pressure (self, GDATA_MEMORY_PRESSURE_LOW);
+}
+#endif
+
+static void
+gdata_cache_manager_init (GDataCacheManager *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CACHE_MANAGER, GDataCacheManagerPrivate);
+
+	g_mutex_init (&(self->priv->mutex));
+
+#if GLIB_CHECK_VERSION (2, 64, 0)
+	self->priv->memory_monitor = g_memory_monitor_dup_default ();
+	g_signal_connect (self->priv->memory_monitor, "low-memory-warning", (GCallback) low_memory_warning_cb, self);
+#endif
+}
+
+static void
+gdata_cache_manager_finalize (GObject *object)
+{
+	GDataCacheManagerPrivate *priv = GDATA_CACHE_MANAGER (object)->priv;
+
+#if GLIB_CHECK_VERSION (2, 64, 0)
+	g_signal_handlers_disconnect_by_func (priv->memory_monitor, low_memory_warning_cb, object);
+	g_object_unref (priv->memory_monitor);
+#endif
+
+	/* All the caches should have unregistered by now */
+	g_warn_if_fail (priv->registrations == NULL);
+	g_mutex_clear (&(priv->mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_cache_manager_parent_class)->finalize (object);
+}
+
+static void
+gdata_cache_manager_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataCacheManager *self = GDATA_CACHE_MANAGER (object);
+
+	switch (property_id) {
+		case PROP_BUDGET:
+			g_value_set_uint64 (value, gdata_cache_manager_get_budget (self));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_cache_manager_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataCacheManager *self = GDATA_CACHE_MANAGER (object);
+
+	switch (property_id) {
+		case PROP_BUDGET:
+			gdata_cache_manager_set_budget (self, g_value_get_uint64 (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_cache_manager_get_default:
+ *
+ * Gets the process-wide #GDataCacheManager, creating it if it doesn't exist yet.
+ *
+ * Return value: (transfer none): the cache manager
+ *
+ * Since: 0.15.0
+ **/
+GDataCacheManager *
+gdata_cache_manager_get_default (void)
+{
+	static volatile GDataCacheManager *manager__volatile = NULL;
+
+	if (g_once_init_enter (&manager__volatile) == TRUE) {
+		GDataCacheManager *manager = g_object_new (GDATA_TYPE_CACHE_MANAGER, NULL);
+		g_once_init_leave (&manager__volatile, manager);
+	}
+
+	return GDATA_CACHE_MANAGER (manager__volatile);
+}
+
+/* Must be called with the manager's lock held. On-disk caches are only included if @include_disk is %TRUE. */
+static guint64
+get_size_unlocked (GDataCacheManager *self, gboolean include_disk)
+{
+	guint64 size = 0;
+	GList *i;
+
+	for (i = self->priv->registrations; i != NULL; i = i->next) {
+		GDataCacheRegistration *registration = i->data;
+
+		if (include_disk == TRUE || registration->priority != GDATA_CACHE_PRIORITY_DISK)
+			size += registration->funcs->get_size (registration->cache, NULL);
+	}
+
+	return size;
+}
+
+/* Must be called with the manager's lock held. Evicts items from the caches until they hold no more than @size bytes between them: each time, the
+ * least recently used item of the lowest-priority non-empty caches. On-disk caches are only included if @include_disk is %TRUE. */
+static void
+trim_unlocked (GDataCacheManager *self, guint64 size, gboolean include_disk)
+{
+	guint64 current_size = get_size_unlocked (self, include_disk);
+
+	while (current_size > size) {
+		GDataCacheRegistration *victim = NULL;
+		gint64 victim_oldest_use = G_MAXINT64;
+		gsize n_bytes;
+		GList *i;
+
+		for (i = self->priv->registrations; i != NULL; i = i->next) {
+			GDataCacheRegistration *registration = i->data;
+			gint64 oldest_use;
+
+			if ((include_disk == FALSE && registration->priority == GDATA_CACHE_PRIORITY_DISK) ||
+			    registration->funcs->get_size (registration->cache, NULL) == 0) {
+				continue;
+			}
+
+			oldest_use = registration->funcs->get_oldest_use (registration->cache);
+
+			if (victim == NULL || registration->priority < victim->priority ||
+			    (registration->priority == victim->priority && oldest_use < victim_oldest_use)) {
+				victim = registration;
+				victim_oldest_use = oldest_use;
+			}
+		}
+
+		if (victim == NULL)
+			break;
+
+		n_bytes = victim->funcs->evict_oldest (victim->cache);
+		if (n_bytes == 0) {
+			/* The cache claims to hold something but can't evict it; don't spin forever */
+			break;
+		}
+
+		victim->n_evictions++;
+		current_size -= MIN (n_bytes, current_size);
+	}
+}
+
+/**
+ * gdata_cache_manager_get_budget:
+ * @self: a #GDataCacheManager
+ *
+ * Gets the #GDataCacheManager:budget property.
+ *
+ * Return value: the maximum number of bytes all the caches together may hold, or <code class="literal">0</code> for no limit
+ *
+ * Since: 0.15.0
+ **/
+guint64
+gdata_cache_manager_get_budget (GDataCacheManager *self)
+{
+	guint64 budget;
+
+	g_return_val_if_fail (GDATA_IS_CACHE_MANAGER (self), 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	budget = self->priv->budget;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return budget;
+}
+
+/**
+ * gdata_cache_manager_set_budget:
+ * @self: a #GDataCacheManager
+ * @budget: the maximum number of bytes all the caches together may hold, or <code class="literal">0</code> for no limit
+ *
+ * Sets the #GDataCacheManager:budget property. If the caches currently hold more than @budget bytes, the least recently used items are evicted
+ * straight away.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_cache_manager_set_budget (GDataCacheManager *self, guint64 budget)
+{
+	g_return_if_fail (GDATA_IS_CACHE_MANAGER (self));
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	if (self->priv->budget == budget) {
+		g_mutex_unlock (&(self->priv->mutex));
+		return;
+	}
+
+	self->priv->budget = budget;
+	if (budget > 0)
+		trim_unlocked (self, budget, TRUE);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_object_notify (G_OBJECT (self), "budget");
+}
+
+/**
+ * gdata_cache_manager_get_size:
+ * @self: a #GDataCacheManager
+ *
+ * Gets the approximate number of bytes held by all the caches together.
+ *
+ * Return value: the size of the caches, in bytes
+ *
+ * Since: 0.15.0
+ **/
+guint64
+gdata_cache_manager_get_size (GDataCacheManager *self)
+{
+	guint64 size;
+
+	g_return_val_if_fail (GDATA_IS_CACHE_MANAGER (self), 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	size = get_size_unlocked (self, TRUE);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return size;
+}
+
+/**
+ * gdata_cache_manager_trim:
+ * @self: a #GDataCacheManager
+ * @size: the number of bytes the caches should be trimmed to
+ *
+ * Evicts items from the caches until they hold no more than @size bytes between them, in the order described in the
+ * <link linkend="gdata-cache-manager.description">class documentation</link>. Passing <code class="literal">0</code> empties them.
+ *
+ * Unlike #GDataCacheManager:budget, this only has an effect once: the caches are free to grow again afterwards.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_cache_manager_trim (GDataCacheManager *self, guint64 size)
+{
+	g_return_if_fail (GDATA_IS_CACHE_MANAGER (self));
+
+	g_mutex_lock (&(self->priv->mutex));
+	trim_unlocked (self, size, TRUE);
+	g_mutex_unlock (&(self->priv->mutex));
+}
+
+/**
+ * gdata_cache_manager_handle_memory_pressure:
+ * @self: a #GDataCacheManager
+ * @pressure: how severe the memory shortage is
+ *
+ * Trims the caches in response to a low memory warning, by an amount depending on @pressure (see #GDataMemoryPressure). This is done
+ * automatically for warnings from the default #GMemoryMonitor if libgdata was built against GLib 2.64 or later.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_cache_manager_handle_memory_pressure (GDataCacheManager *self, GDataMemoryPressure pressure)
+{
+	guint64 size;
+
+	g_return_if_fail (GDATA_IS_CACHE_MANAGER (self));
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	switch (pressure) {
+		case GDATA_MEMORY_PRESSURE_LOW:
+			size = get_size_unlocked (self, FALSE) / 2;
+			break;
+		case GDATA_MEMORY_PRESSURE_MEDIUM:
+			size = get_size_unlocked (self, FALSE) / 4;
+			break;
+		case GDATA_MEMORY_PRESSURE_CRITICAL:
+		default:
+			size = 0;
+			break;
+	}
+
+	/* On-disk caches don't hold any memory (the kernel can drop their pages as it sees fit), so emptying them wouldn't help */
+	g_debug ("Trimming caches to %" G_GUINT64_FORMAT " bytes due to memory pressure.", size);
+	trim_unlocked (self, size, FALSE);
+
+	g_mutex_unlock (&(self->priv->mutex));
+}
+
+typedef struct {
+	guint64 n_bytes;
+	guint n_items;
+	guint n_hits;
+	guint n_misses;
+	guint n_evictions;
+} CacheStats;
+
+/**
+ * gdata_cache_manager_dup_stats:
+ * @self: a #GDataCacheManager
+ *
+ * Gets a snapshot of the size and effectiveness of each cache, in a form which can easily be exported to a metrics system. The returned #GVariant
+ * has type <literal>a{s(tuuuu)}</literal>, mapping the name of each cache to the approximate number of bytes it holds, its number of items, the
+ * number of lookups in it which hit and which missed, and the number of items the manager has evicted from it. Caches belonging to different
+ * instances of the same class (such as the entry caches of two #GDataCalendarService<!-- -->s) are added together.
+ *
+ * Return value: (transfer full): the statistics; unref with g_variant_unref()
+ *
+ * Since: 0.15.0
+ **/
+GVariant *
+gdata_cache_manager_dup_stats (GDataCacheManager *self)
+{
+	GHashTable *stats;
+	GHashTableIter iter;
+	const gchar *name;
+	CacheStats *cache_stats;
+	GVariantBuilder builder;
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_CACHE_MANAGER (self), NULL);
+
+	stats = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	for (i = self->priv->registrations; i != NULL; i = i->next) {
+		GDataCacheRegistration *registration = i->data;
+		guint n_items = 0;
+
+		cache_stats = g_hash_table_lookup (stats, registration->name);
+		if (cache_stats == NULL) {
+			cache_stats = g_new0 (CacheStats, 1);
+			g_hash_table_insert (stats, g_strdup (registration->name), cache_stats);
+		}
+
+		cache_stats->n_bytes += registration->funcs->get_size (registration->cache, &n_items);
+		cache_stats->n_items += n_items;
+		cache_stats->n_hits += g_atomic_int_get (&(registration->n_hits));
+		cache_stats->n_misses += g_atomic_int_get (&(registration->n_misses));
+		cache_stats->n_evictions += registration->n_evictions;
+	}
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(tuuuu)}"));
+
+	g_hash_table_iter_init (&iter, stats);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &name, (gpointer*) &cache_stats) == TRUE) {
+		g_variant_builder_add (&builder, "{s(tuuuu)}", name, cache_stats->n_bytes, cache_stats->n_items, cache_stats->n_hits,
+		                       cache_stats->n_misses, cache_stats->n_evictions);
+	}
+
+	g_hash_table_destroy (stats);
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/*
+ * _gdata_cache_manager_register:
+ * @name: the name to report the cache's statistics under
+ * @priority: how readily the cache should give up memory
+ * @funcs: the functions to measure and evict from the cache with, which must stay valid until the cache is unregistered
+ * @cache: the cache, passed to each of @funcs
+ *
+ * Registers a cache with the default #GDataCacheManager, so that it's included in the budget and in trims. The cache must be unregistered with
+ * _gdata_cache_manager_unregister() before it's destroyed.
+ *
+ * Return value: (transfer full): the registration, to pass to the other _gdata_cache_manager_*() functions
+ *
+ * Since: 0.15.0
+ */
+GDataCacheRegistration *
+_gdata_cache_manager_register (const gchar *name, GDataCachePriority priority, const GDataCacheFuncs *funcs, gpointer cache)
+{
+	GDataCacheManager *self = gdata_cache_manager_get_default ();
+	GDataCacheRegistration *registration;
+
+	registration = g_slice_new0 (GDataCacheRegistration);
+	registration->name = g_strdup (name);
+	registration->priority = priority;
+	registration->funcs = funcs;
+	registration->cache = cache;
+
+	g_mutex_lock (&(self->priv->mutex));
+	self->priv->registrations = g_list_prepend (self->priv->registrations, registration);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return registration;
+}
+
+/*
+ * _gdata_cache_manager_unregister:
+ * @registration: (transfer full): a registration returned by _gdata_cache_manager_register()
+ *
+ * Unregisters a cache from the default #GDataCacheManager, and frees @registration. Once this returns, the manager won't touch the cache again.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_cache_manager_unregister (GDataCacheRegistration *registration)
+{
+	GDataCacheManager *self = gdata_cache_manager_get_default ();
+
+	g_mutex_lock (&(self->priv->mutex));
+	self->priv->registrations = g_list_remove (self->priv->registrations, registration);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_free (registration->name);
+	g_slice_free (GDataCacheRegistration, registration);
+}
+
+/*
+ * _gdata_cache_manager_record_lookup:
+ * @registration: the registration of the cache which was looked up in
+ * @hit: %TRUE if the lookup found what it was looking for, %FALSE otherwise
+ *
+ * Counts a lookup in the cache for its statistics. This may be called with the cache's lock held.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_cache_manager_record_lookup (GDataCacheRegistration *registration, gboolean hit)
+{
+	if (hit == TRUE)
+		g_atomic_int_inc (&(registration->n_hits));
+	else
+		g_atomic_int_inc (&(registration->n_misses));
+}
+
+/*
+ * _gdata_cache_manager_cache_grown:
+ * @registration: the registration of the cache which has grown
+ *
+ * Tells the default #GDataCacheManager that a cache has grown, so that it can evict items to keep within its budget. This must not be called with
+ * the cache's lock held.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_cache_manager_cache_grown (GDataCacheRegistration *registration)
+{
+	GDataCacheManager *self = gdata_cache_manager_get_default ();
+
+	g_mutex_lock (&(self->priv->mutex));
+	if (self->priv->budget > 0)
+		trim_unlocked (self, self->priv->budget, TRUE);
+	g_mutex_unlock (&(self->priv->mutex));
+}
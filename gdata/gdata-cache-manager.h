@@ -0,0 +1,93 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_CACHE_MANAGER_H
+#define GDATA_CACHE_MANAGER_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDataMemoryPressure:
+ * @GDATA_MEMORY_PRESSURE_LOW: memory is getting low; the caches are trimmed to half their current size
+ * @GDATA_MEMORY_PRESSURE_MEDIUM: memory is low; the caches are trimmed to a quarter of their current size
+ * @GDATA_MEMORY_PRESSURE_CRITICAL: memory is critically low; the caches are emptied
+ *
+ * How severe a low memory warning passed to gdata_cache_manager_handle_memory_pressure() is.
+ *
+ * Since: 0.15.0
+ **/
+typedef enum {
+	GDATA_MEMORY_PRESSURE_LOW = 0,
+	GDATA_MEMORY_PRESSURE_MEDIUM,
+	GDATA_MEMORY_PRESSURE_CRITICAL
+} GDataMemoryPressure;
+
+#define GDATA_TYPE_CACHE_MANAGER		(gdata_cache_manager_get_type ())
+#define GDATA_CACHE_MANAGER(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CACHE_MANAGER, GDataCacheManager))
+#define GDATA_CACHE_MANAGER_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CACHE_MANAGER, GDataCacheManagerClass))
+#define GDATA_IS_CACHE_MANAGER(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CACHE_MANAGER))
+#define GDATA_IS_CACHE_MANAGER_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_CACHE_MANAGER))
+#define GDATA_CACHE_MANAGER_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_CACHE_MANAGER, GDataCacheManagerClass))
+
+typedef struct _GDataCacheManagerPrivate	GDataCacheManagerPrivate;
+
+/**
+ * GDataCacheManager:
+ *
+ * All the fields in the #GDataCacheManager structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataCacheManagerPrivate *priv;
+} GDataCacheManager;
+
+/**
+ * GDataCacheManagerClass:
+ *
+ * All the fields in the #GDataCacheManagerClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataCacheManagerClass;
+
+GType gdata_cache_manager_get_type (void) G_GNUC_CONST;
+
+GDataCacheManager *gdata_cache_manager_get_default (void);
+
+guint64 gdata_cache_manager_get_budget (GDataCacheManager *self);
+void gdata_cache_manager_set_budget (GDataCacheManager *self, guint64 budget);
+
+guint64 gdata_cache_manager_get_size (GDataCacheManager *self);
+void gdata_cache_manager_trim (GDataCacheManager *self, guint64 size);
+void gdata_cache_manager_handle_memory_pressure (GDataCacheManager *self, GDataMemoryPressure pressure);
+
+GVariant *gdata_cache_manager_dup_stats (GDataCacheManager *self) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* !GDATA_CACHE_MANAGER_H */
@@ -40,13 +40,18 @@
  *
  * ClientLogin does not natively support authorization against multiple authorization domains concurrently with a single authorization token, so it
  * has to be simulated by maintaining multiple authorization tokens if multiple authorization domains are used. This means that proportionally more
- * network requests are made when gdata_client_login_authorizer_authenticate() is called, which will be proportionally slower. Handling of the
- * multiple authorization tokens is otherwise transparent to the client.
+ * network requests are made when gdata_client_login_authorizer_authenticate() is called. They're made concurrently, so authentication takes about
+ * as long as it does for the slowest authorization domain, and requests made with the authorizer in the meantime keep using the old authorization
+ * tokens until all the new ones have been received. Handling of the multiple authorization tokens is otherwise transparent to the client.
  *
  * Each authorization token is long lived, so reauthorization is rarely necessary with #GDataClientLoginAuthorizer. Consequently, refreshing
  * authorization using gdata_authorizer_refresh_authorization() is not supported by #GDataClientLoginAuthorizer, and will immediately return %FALSE
  * with no error set.
  *
+ * Since the authorization tokens are long lived, it's worth saving them with gdata_authorizer_save_state() and restoring them into a new
+ * #GDataClientLoginAuthorizer with gdata_authorizer_restore_state() when the client is next run, rather than authenticating again. The saved state
+ * contains the username and the authorization tokens, but not the password. Restoring state clears any password previously set on the authorizer.
+ *
  * <example>
  * 	<title>Authenticating Asynchronously Using ClientLogin</title>
  * 	<programlisting>
@@ -100,6 +105,9 @@
 /* The default e-mail domain to use for usernames */
 #define EMAIL_DOMAIN "gmail.com"
 
+/* Version of the format of the state returned by save_state() */
+#define STATE_VERSION 1
+
 GQuark
 gdata_client_login_authorizer_error_quark (void)
 {
@@ -114,6 +122,10 @@ static void set_property (GObject *object, guint property_id, const GValue *valu
 
 static void process_request (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message);
 static gboolean is_authorized_for_domain (GDataAuthorizer *self, GDataAuthorizationDomain *domain);
+static GVariant *save_state (GDataAuthorizer *self);
+static gboolean restore_state (GDataAuthorizer *self, GVariant *state, GError **error);
+static gboolean notify_authentication_details_cb (GDataClientLoginAuthorizer *self);
+static void update_auth_headers (GDataClientLoginAuthorizer *self);
 
 static void notify_proxy_uri_cb (GObject *gobject, GParamSpec *pspec, GDataClientLoginAuthorizer *self);
 static void notify_timeout_cb (GObject *gobject, GParamSpec *pspec, GObject *self);
@@ -128,9 +140,8 @@ struct _GDataClientLoginAuthorizerPrivate {
 
 	gchar *client_id;
 
-	/* Mutex for username, password and auth_tokens. It has to be recursive as the top-level authentication functions need to hold a lock on
-	 * auth_tokens while looping over it, but lower-level functions also need to modify auth_tokens to add the auth_tokens themselves once they're
-	 * returned by the online service. */
+	/* Mutex for username, password and auth_tokens. It's only held briefly: authentication takes a snapshot of the domains in auth_tokens, and
+	 * replaces auth_tokens wholesale once all the new auth. tokens have been returned by the online service. */
 	GRecMutex mutex;
 
 	gchar *username;
@@ -138,6 +149,16 @@ struct _GDataClientLoginAuthorizerPrivate {
 
 	/* Mapping from GDataAuthorizationDomain to string? auth_token; auth_token is NULL for domains which aren't authorised at the moment */
 	GHashTable *auth_tokens;
+
+	/* Mapping from GDataAuthorizationDomain to string auth_header, the pre-formatted value of the Authorization header for each authorised
+	 * domain. It's rebuilt from auth_tokens (with mutex held) whenever they change, so that process_request() doesn't have to format the
+	 * header, or take the mutex. The table is never modified once built, only replaced wholesale, and is protected by auth_headers_lock so that
+	 * concurrent requests only ever take a shared reader lock. */
+	GRWLock auth_headers_lock;
+	GHashTable *auth_headers;
+
+	/* Held while emitting ::captcha-challenge, so that concurrent authentications with different domains only present one challenge at a time */
+	GMutex captcha_mutex;
 };
 
 enum {
@@ -278,6 +299,10 @@ gdata_client_login_authorizer_class_init (GDataClientLoginAuthorizerClass *klass
 	 * to be completed. The URI of a CAPTCHA image is given, and the program should display this to the user, and return their response (the text
 	 * displayed in the image). There is no timeout imposed by the library for the response.
 	 *
+	 * Since authorization domains are authenticated with concurrently, the signal may be emitted in a thread other than the one which called
+	 * gdata_client_login_authorizer_authenticate(). It's only emitted for one domain at a time, though, so handlers don't need to cope with
+	 * several challenges at once.
+	 *
 	 * Return value: a newly allocated string containing the text in the CAPTCHA image
 	 *
 	 * Since: 0.9.0
@@ -295,6 +320,8 @@ authorizer_init (GDataAuthorizerInterface *iface)
 {
 	iface->process_request = process_request;
 	iface->is_authorized_for_domain = is_authorized_for_domain;
+	iface->save_state = save_state;
+	iface->restore_state = restore_state;
 }
 
 static void
@@ -306,6 +333,11 @@ gdata_client_login_authorizer_init (GDataClientLoginAuthorizer *self)
 	g_rec_mutex_init (&(self->priv->mutex));
 	self->priv->auth_tokens = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, (GDestroyNotify) _gdata_service_secure_strfree);
 
+	g_rw_lock_init (&(self->priv->auth_headers_lock));
+	self->priv->auth_headers = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, (GDestroyNotify) _gdata_service_secure_strfree);
+
+	g_mutex_init (&(self->priv->captcha_mutex));
+
 	/* Set up the session */
 	self->priv->session = _gdata_service_build_session ();
 
@@ -342,6 +374,9 @@ finalize (GObject *object)
 	_gdata_service_secure_strfree (priv->password);
 	g_free (priv->client_id);
 	g_hash_table_destroy (priv->auth_tokens);
+	g_hash_table_unref (priv->auth_headers);
+	g_rw_lock_clear (&(priv->auth_headers_lock));
+	g_mutex_clear (&(priv->captcha_mutex));
 	g_rec_mutex_clear (&(priv->mutex));
 
 	if (priv->proxy_uri != NULL) {
@@ -416,7 +451,7 @@ set_property (GObject *object, guint property_id, const GValue *value, GParamSpe
 static void
 process_request (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message)
 {
-	GDataConstSecureString auth_token; /* privacy sensitive */
+	GDataConstSecureString auth_header; /* privacy sensitive */
 	GDataClientLoginAuthorizerPrivate *priv = GDATA_CLIENT_LOGIN_AUTHORIZER (self)->priv;
 
 	/* If the domain's NULL, return immediately */
@@ -424,28 +459,59 @@ process_request (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMe
 		return;
 	}
 
-	/* Set the authorisation header */
-	g_rec_mutex_lock (&(priv->mutex));
+	/* Set the authorisation header. This only needs the (uncontended) reader lock on the pre-formatted headers, rather than the mutex. */
+	g_rw_lock_reader_lock (&(priv->auth_headers_lock));
 
-	auth_token = (GDataConstSecureString) g_hash_table_lookup (priv->auth_tokens, domain);
+	auth_header = (GDataConstSecureString) g_hash_table_lookup (priv->auth_headers, domain);
 
-	if (auth_token != NULL) {
+	if (auth_header != NULL) {
 		/* Ensure that we're using HTTPS: if not, we shouldn't set the Authorization header or we could be revealing the auth token to
 		 * anyone snooping the connection, which would give them the same rights as us on the user's data. Generally a bad thing to happen. */
 		if (soup_message_get_uri (message)->scheme != SOUP_URI_SCHEME_HTTPS) {
 			g_warning ("Not authorizing a non-HTTPS message with the user's ClientLogin auth token as the connection isn't secure.");
 		} else {
-			/* Ideally, authorisation_header would be allocated in non-pageable memory. However, it's copied by
-			 * soup_message_headers_replace() immediately anyway, so there's not much point. However, we do ensure we zero it out before
-			 * freeing. */
-			gchar *authorisation_header = g_strdup_printf ("GoogleLogin auth=%s", auth_token);
-			soup_message_headers_replace (message->request_headers, "Authorization", authorisation_header);
-			memset (authorisation_header, 0, strlen (authorisation_header));
-			g_free (authorisation_header);
+			/* auth_header is copied by soup_message_headers_replace() immediately, so can't be kept in non-pageable memory there. */
+			soup_message_headers_replace (message->request_headers, "Authorization", auth_header);
 		}
 	}
 
-	g_rec_mutex_unlock (&(priv->mutex));
+	g_rw_lock_reader_unlock (&(priv->auth_headers_lock));
+}
+
+/* Rebuild ->auth_headers from ->auth_tokens. This must be called with ->mutex held, every time ->auth_tokens is changed. */
+static void
+update_auth_headers (GDataClientLoginAuthorizer *self)
+{
+	GDataClientLoginAuthorizerPrivate *priv = self->priv;
+	GHashTable *new_auth_headers, *old_auth_headers;
+	GHashTableIter iter;
+	GDataAuthorizationDomain *domain;
+	GDataConstSecureString auth_token; /* privacy sensitive */
+
+	new_auth_headers = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, (GDestroyNotify) _gdata_service_secure_strfree);
+	g_hash_table_iter_init (&iter, priv->auth_tokens);
+
+	while (g_hash_table_iter_next (&iter, (gpointer*) &domain, (gpointer*) &auth_token) == TRUE) {
+		gchar *auth_header;
+
+		if (auth_token == NULL) {
+			continue;
+		}
+
+		/* Keep the cached header in non-pageable memory, like the auth. token itself. The temporary copy is zeroed out before freeing. */
+		auth_header = g_strconcat ("GoogleLogin auth=", auth_token, NULL);
+		g_hash_table_insert (new_auth_headers, g_object_ref (domain), _gdata_service_secure_strdup (auth_header));
+		memset (auth_header, 0, strlen (auth_header));
+		g_free (auth_header);
+	}
+
+	/* Swap the new headers in; the writer lock is only held for the pointer swap, so readers are never blocked for long */
+	g_rw_lock_writer_lock (&(priv->auth_headers_lock));
+	old_auth_headers = priv->auth_headers;
+	priv->auth_headers = new_auth_headers;
+	g_rw_lock_writer_unlock (&(priv->auth_headers_lock));
+
+	g_hash_table_unref (old_auth_headers);
 }
 
 static gboolean
@@ -461,6 +527,105 @@ is_authorized_for_domain (GDataAuthorizer *self, GDataAuthorizationDomain *domai
 	return (result != NULL) ? TRUE : FALSE;
 }
 
+static GVariant *
+save_state (GDataAuthorizer *self)
+{
+	GDataClientLoginAuthorizerPrivate *priv = GDATA_CLIENT_LOGIN_AUTHORIZER (self)->priv;
+	GVariantBuilder builder, tokens_builder;
+	GHashTableIter iter;
+	GDataAuthorizationDomain *domain;
+	GDataConstSecureString auth_token;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&builder, "{sv}", "type", g_variant_new_string (G_OBJECT_TYPE_NAME (self)));
+	g_variant_builder_add (&builder, "{sv}", "version", g_variant_new_uint32 (STATE_VERSION));
+
+	/* The auth. tokens are stored as (service name, scope, auth. token) tuples so that they can be matched up with the domains when restoring */
+	g_variant_builder_init (&tokens_builder, G_VARIANT_TYPE ("a(sss)"));
+
+	g_rec_mutex_lock (&(priv->mutex));
+
+	if (priv->username != NULL) {
+		g_variant_builder_add (&builder, "{sv}", "username", g_variant_new_string (priv->username));
+	}
+
+	g_hash_table_iter_init (&iter, priv->auth_tokens);
+
+	while (g_hash_table_iter_next (&iter, (gpointer*) &domain, (gpointer*) &auth_token) == TRUE) {
+		if (auth_token != NULL) {
+			g_variant_builder_add (&tokens_builder, "(sss)", gdata_authorization_domain_get_service_name (domain),
+			                       gdata_authorization_domain_get_scope (domain), auth_token);
+		}
+	}
+
+	g_rec_mutex_unlock (&(priv->mutex));
+
+	g_variant_builder_add (&builder, "{sv}", "auth-tokens", g_variant_builder_end (&tokens_builder));
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static gboolean
+restore_state (GDataAuthorizer *self, GVariant *state, GError **error)
+{
+	GDataClientLoginAuthorizerPrivate *priv = GDATA_CLIENT_LOGIN_AUTHORIZER (self)->priv;
+	GVariant *auth_tokens;
+	GVariantIter tokens_iter;
+	GHashTableIter iter;
+	GDataAuthorizationDomain *domain;
+	const gchar *username = NULL, *service_name, *scope, *auth_token;
+
+	if (_gdata_authorizer_check_state (state, G_OBJECT_TYPE_NAME (self), STATE_VERSION, error) == FALSE) {
+		return FALSE;
+	}
+
+	auth_tokens = g_variant_lookup_value (state, "auth-tokens", G_VARIANT_TYPE ("a(sss)"));
+	if (auth_tokens == NULL) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "The authorization state is not valid for a %s.", G_OBJECT_TYPE_NAME (self));
+		return FALSE;
+	}
+
+	g_variant_lookup (state, "username", "&s", &username);
+
+	g_rec_mutex_lock (&(priv->mutex));
+
+	g_free (priv->username);
+	priv->username = g_strdup (username);
+
+	/* The password isn't part of the state */
+	_gdata_service_secure_strfree (priv->password);
+	priv->password = NULL;
+
+	/* Replace all the auth. tokens; domains which aren't in the state are left unauthorised, and tokens for domains we don't know are ignored */
+	g_hash_table_iter_init (&iter, priv->auth_tokens);
+
+	while (g_hash_table_iter_next (&iter, (gpointer*) &domain, NULL) == TRUE) {
+		GDataSecureString new_auth_token = NULL;
+
+		g_variant_iter_init (&tokens_iter, auth_tokens);
+
+		while (g_variant_iter_next (&tokens_iter, "(&s&s&s)", &service_name, &scope, &auth_token) == TRUE) {
+			if (strcmp (service_name, gdata_authorization_domain_get_service_name (domain)) == 0 &&
+			    strcmp (scope, gdata_authorization_domain_get_scope (domain)) == 0 && *auth_token != '\0') {
+				new_auth_token = _gdata_service_secure_strdup (auth_token);
+				break;
+			}
+		}
+
+		g_hash_table_iter_replace (&iter, new_auth_token);
+	}
+
+	update_auth_headers (GDATA_CLIENT_LOGIN_AUTHORIZER (self));
+
+	g_rec_mutex_unlock (&(priv->mutex));
+
+	g_variant_unref (auth_tokens);
+
+	notify_authentication_details_cb (g_object_ref (self));
+
+	return TRUE;
+}
+
 /**
  * gdata_client_login_authorizer_new:
  * @client_id: your application's client ID
@@ -581,6 +746,8 @@ set_authentication_details (GDataClientLoginAuthorizer *self, const gchar *usern
 		priv->auth_tokens = new_auth_tokens;
 	}
 
+	update_auth_headers (self);
+
 	g_rec_mutex_unlock (&(priv->mutex));
 
 	/* Notify of the property changes in the main thread; i.e. if we're running an async operation, schedule the notification in an idle
@@ -777,7 +944,9 @@ authenticate (GDataClientLoginAuthorizer *self, GDataAuthorizationDomain *domain
 			captcha_uri[captcha_base_uri_length + (captcha_end - captcha_start)] = '\0';
 
 			/* Request a CAPTCHA answer from the application */
+			g_mutex_lock (&(priv->captcha_mutex));
 			g_signal_emit (self, authorizer_signals[SIGNAL_CAPTCHA_CHALLENGE], 0, captcha_uri, &new_captcha_answer);
+			g_mutex_unlock (&(priv->captcha_mutex));
 			g_free (captcha_uri);
 
 			if (new_captcha_answer == NULL || *new_captcha_answer == '\0') {
@@ -914,54 +1083,120 @@ protocol_error:
 	return NULL;
 }
 
+typedef struct {
+	GDataClientLoginAuthorizer *authorizer;
+	const gchar *username;
+	GDataConstSecureString password;
+	GCancellable *cancellable; /* cancelled as soon as any domain fails, since the whole authentication then fails */
+
+	GMutex mutex; /* protects the members below */
+	GHashTable *new_auth_tokens;
+	GError *error; /* the first error to occur */
+	gboolean cumulative_success;
+} AuthenticateLoopData;
+
+/* Authenticates with a single domain, as one of the jobs of authenticate_loop(). This takes ownership of a reference to @domain. */
+static void
+authenticate_domain_thread (GDataAuthorizationDomain *domain, AuthenticateLoopData *data)
+{
+	GError *authenticate_error = NULL;
+	GDataSecureString auth_token;
+
+	auth_token = authenticate (data->authorizer, domain, data->username, data->password, NULL, NULL, data->cancellable, &authenticate_error);
+
+	g_mutex_lock (&(data->mutex));
+
+	if (auth_token == NULL) {
+		/* Only propagate the first error which occurs; the others are likely to be cancellations caused by it. */
+		if (data->cumulative_success == TRUE) {
+			data->error = authenticate_error;
+			authenticate_error = NULL;
+		}
+
+		data->cumulative_success = FALSE;
+	}
+
+	/* Store the auth. token (or lack thereof if authentication failed). */
+	g_hash_table_insert (data->new_auth_tokens, domain, auth_token);
+
+	g_mutex_unlock (&(data->mutex));
+
+	if (auth_token == NULL)
+		g_cancellable_cancel (data->cancellable);
+
+	g_clear_error (&authenticate_error);
+}
+
+static void
+authenticate_loop_cancelled_cb (GCancellable *cancellable, GCancellable *loop_cancellable)
+{
+	g_cancellable_cancel (loop_cancellable);
+}
+
 static gboolean
 authenticate_loop (GDataClientLoginAuthorizer *authorizer, gboolean is_async, const gchar *username, const gchar *password, GCancellable *cancellable,
                    GError **error)
 {
 	GDataClientLoginAuthorizerPrivate *priv = authorizer->priv;
-	gboolean cumulative_success = TRUE;
-	GHashTable *new_auth_tokens;
-	GHashTableIter iter;
-	GDataAuthorizationDomain *domain;
-	GDataSecureString auth_token;
+	AuthenticateLoopData data;
+	GList *domains, *i;
+	gulong cancelled_id = 0;
+	gboolean success;
 
+	/* Take a snapshot of the domains to authenticate with. The mutex isn't held during authentication, so that the authorizer can still be
+	 * queried (and used to authorize requests with the old auth. tokens) in the meantime. */
 	g_rec_mutex_lock (&(priv->mutex));
+	domains = g_hash_table_get_keys (priv->auth_tokens);
+	g_list_foreach (domains, (GFunc) g_object_ref, NULL);
+	g_rec_mutex_unlock (&(priv->mutex));
 
-	/* Authenticate and authorize against each of the services registered with the authorizer */
-	new_auth_tokens = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, (GDestroyNotify) _gdata_service_secure_strfree);
-	g_hash_table_iter_init (&iter, priv->auth_tokens);
-
-	while (g_hash_table_iter_next (&iter, (gpointer*) &domain, NULL) == TRUE) {
-		GError *authenticate_error = NULL;
+	data.authorizer = authorizer;
+	data.username = username;
+	data.password = password;
+	data.cancellable = g_cancellable_new ();
+	g_mutex_init (&(data.mutex));
+	data.new_auth_tokens = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, (GDestroyNotify) _gdata_service_secure_strfree);
+	data.error = NULL;
+	data.cumulative_success = TRUE;
 
-		auth_token = authenticate (authorizer, domain, username, password, NULL, NULL, cancellable, &authenticate_error);
+	if (cancellable != NULL)
+		cancelled_id = g_cancellable_connect (cancellable, (GCallback) authenticate_loop_cancelled_cb, g_object_ref (data.cancellable), g_object_unref);
 
-		if (auth_token == NULL && cumulative_success == TRUE) {
-			/* Only propagate the first error which occurs. */
-			g_propagate_error (error, authenticate_error);
-			authenticate_error = NULL;
-		}
+	/* Authenticate and authorize against each of the services registered with the authorizer. Each domain needs a separate round trip to the
+	 * accounts server, so make them concurrently; there's no need for a thread pool if there's only one. */
+	if (domains != NULL && domains->next == NULL) {
+		authenticate_domain_thread (domains->data, &data);
+	} else if (domains != NULL) {
+		GThreadPool *pool;
 
-		cumulative_success = (auth_token != NULL) && cumulative_success;
+		pool = g_thread_pool_new ((GFunc) authenticate_domain_thread, &data, g_list_length (domains), FALSE, NULL);
 
-		/* Store the auth. token (or lack thereof if authentication failed). */
-		g_hash_table_insert (new_auth_tokens, g_object_ref (domain), auth_token);
+		for (i = domains; i != NULL; i = i->next)
+			g_thread_pool_push (pool, i->data, NULL); /* transfer the ref */
 
-		g_clear_error (&authenticate_error);
+		g_thread_pool_free (pool, FALSE, TRUE);
 	}
 
-	g_rec_mutex_unlock (&(priv->mutex));
+	g_list_free (domains);
+
+	if (cancellable != NULL)
+		g_cancellable_disconnect (cancellable, cancelled_id);
+
+	/* Set or clear the authentication details and return now that we're done. The new auth. tokens are swapped in all at once. */
+	success = data.cumulative_success;
 
-	/* Set or clear the authentication details and return now that we're done */
-	if (cumulative_success == TRUE) {
-		set_authentication_details (authorizer, username, password, new_auth_tokens, is_async);
+	if (success == TRUE) {
+		set_authentication_details (authorizer, username, password, data.new_auth_tokens, is_async);
 	} else {
 		set_authentication_details (authorizer, NULL, NULL, NULL, is_async);
+		g_propagate_error (error, data.error);
 	}
 
-	g_hash_table_unref (new_auth_tokens);
+	g_hash_table_unref (data.new_auth_tokens);
+	g_mutex_clear (&(data.mutex));
+	g_object_unref (data.cancellable);
 
-	return cumulative_success;
+	return success;
 }
 
 typedef struct {
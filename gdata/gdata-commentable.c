@@ -99,6 +99,7 @@
 
 #include "gdata-commentable.h"
 #include "gdata-service.h"
+#include "gdata-private.h"
 
 G_DEFINE_INTERFACE (GDataCommentable, gdata_commentable, GDATA_TYPE_ENTRY)
 
@@ -305,6 +306,288 @@ gdata_commentable_query_comments_finish (GDataCommentable *self, GAsyncResult *r
 	return GDATA_FEED (g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result)));
 }
 
+typedef struct {
+	GDataService *service;
+	GDataQuery *query;
+	GCancellable *cancellable;
+	GAsyncQueue *results; /* CommentsResults */
+} QueryMultipleData;
+
+typedef struct {
+	GDataCommentable *commentable;
+	GDataFeed *feed;
+	GError *error;
+	GDataCommentableCommentsCallback callback;
+	gpointer user_data;
+} CommentsResult;
+
+static void
+comments_result_free (CommentsResult *result)
+{
+	g_object_unref (result->commentable);
+	if (result->feed != NULL)
+		g_object_unref (result->feed);
+	if (result->error != NULL)
+		g_error_free (result->error);
+
+	g_slice_free (CommentsResult, result);
+}
+
+static void
+query_comments_thread (GDataCommentable *commentable, QueryMultipleData *data)
+{
+	CommentsResult *result;
+	GDataQuery *query;
+
+	result = g_slice_new0 (CommentsResult);
+	result->commentable = commentable; /* transfer ref from the thread pool */
+
+	/* Each commentable needs its own query, since querying updates it */
+	query = (data->query != NULL) ? _gdata_query_copy (data->query) : NULL;
+
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &(result->error)) == FALSE) {
+		result->feed = gdata_commentable_query_comments (commentable, data->service, query, data->cancellable, NULL, NULL,
+		                                                 &(result->error));
+	}
+
+	if (query != NULL)
+		g_object_unref (query);
+
+	g_async_queue_push (data->results, result);
+}
+
+/* Run the user-supplied callback for a commentable's comments. This is designed to be used in an idle handler, so that the callback is run in the
+ * thread which started the query. */
+static gboolean
+comments_result_callback_cb (CommentsResult *result)
+{
+	result->callback (result->commentable, result->feed, result->error, result->user_data);
+	return FALSE;
+}
+
+static gboolean
+query_comments_multiple (GDataService *service, GList *commentables, GDataQuery *query, GCancellable *cancellable,
+                         GDataCommentableCommentsCallback comments_callback, gpointer comments_user_data, GMainContext *context, gboolean is_async,
+                         GError **error)
+{
+	QueryMultipleData data;
+	GThreadPool *pool;
+	GList *i;
+	guint n_pending = 0;
+
+	data.service = service;
+	data.query = query;
+	data.cancellable = cancellable;
+	data.results = g_async_queue_new ();
+
+	/* Query the commentables concurrently; all their comment feeds are on the same host, so there's no point running more queries at once
+	 * than the service has connections to it. */
+	pool = g_thread_pool_new ((GFunc) query_comments_thread, &data, MAX (gdata_service_get_max_connections_per_host (service), 1), FALSE, NULL);
+
+	for (i = commentables; i != NULL; i = i->next) {
+		g_thread_pool_push (pool, g_object_ref (i->data), NULL);
+		n_pending++;
+	}
+
+	/* Deliver the results as they arrive. As with GDataBatchOperation, only dispatch the callbacks in the thread-default main context of the
+	 * thread which started the query if it was started with gdata_commentable_query_comments_multiple_async(). */
+	for (; n_pending > 0; n_pending--) {
+		CommentsResult *result = g_async_queue_pop (data.results);
+
+		if (comments_callback == NULL) {
+			comments_result_free (result);
+			continue;
+		}
+
+		result->callback = comments_callback;
+		result->user_data = comments_user_data;
+
+		if (is_async == TRUE) {
+			_gdata_service_idle_add (context, (GSourceFunc) comments_result_callback_cb, result, (GDestroyNotify) comments_result_free);
+		} else {
+			comments_result_callback_cb (result);
+			comments_result_free (result);
+		}
+	}
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_async_queue_unref (data.results);
+
+	/* Errors for individual commentables are reported to the callback; only cancellation of the whole operation is reported here */
+	return (g_cancellable_set_error_if_cancelled (cancellable, error) == FALSE);
+}
+
+/**
+ * gdata_commentable_query_comments_multiple:
+ * @service: a #GDataService representing the service with which the objects' comments will be manipulated
+ * @commentables: (element-type GData.Commentable): a list of #GDataCommentable<!-- -->s to query the comments of
+ * @query: (allow-none): a #GDataQuery with query parameters, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @comments_callback: (allow-none) (scope call) (closure comments_user_data): a #GDataCommentableCommentsCallback to call when each
+ * #GDataCommentable's comments have been queried, or %NULL
+ * @comments_user_data: (closure): data to pass to the @comments_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Retrieves the comments on each of the #GDataCommentable<!-- -->s in @commentables, as by gdata_commentable_query_comments(), querying several of
+ * them concurrently (up to the #GDataService:max-connections-per-host of @service). @comments_callback is called with each #GDataCommentable's
+ * feed of comments, or the error which occurred while querying them, in the order in which the queries finish.
+ *
+ * The parameters in @query are applied to each #GDataCommentable's query; @query itself is not modified. All the queries share @cancellable: if
+ * it's cancelled, the remaining queries are abandoned (and @comments_callback is called with a %G_IO_ERROR_CANCELLED error for each of them),
+ * and %FALSE is returned with @error set. Errors for individual #GDataCommentable<!-- -->s don't stop the others being queried, and aren't returned
+ * in @error.
+ *
+ * The GData batch protocol can't be used to query feeds, so each #GDataCommentable's comments are queried with a separate request.
+ *
+ * Return value: %TRUE if all the #GDataCommentable<!-- -->s were queried (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_commentable_query_comments_multiple (GDataService *service, GList *commentables, GDataQuery *query, GCancellable *cancellable,
+                                           GDataCommentableCommentsCallback comments_callback, gpointer comments_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = commentables; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_COMMENTABLE (i->data), FALSE);
+
+	return query_comments_multiple (service, commentables, query, cancellable, comments_callback, comments_user_data, NULL, FALSE, error);
+}
+
+typedef struct {
+	GList *commentables;
+	GDataQuery *query;
+	GDataCommentableCommentsCallback comments_callback;
+	gpointer comments_user_data;
+	GDestroyNotify destroy_comments_user_data;
+	GMainContext *context;
+	gboolean success;
+} QueryMultipleAsyncData;
+
+static void
+query_multiple_async_data_free (QueryMultipleAsyncData *data)
+{
+	g_list_free_full (data->commentables, g_object_unref);
+	if (data->query != NULL)
+		g_object_unref (data->query);
+
+	if (data->destroy_comments_user_data != NULL)
+		data->destroy_comments_user_data (data->comments_user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (QueryMultipleAsyncData, data);
+}
+
+static void
+query_comments_multiple_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+{
+	QueryMultipleAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	data->success = query_comments_multiple (service, data->commentables, data->query, cancellable, data->comments_callback,
+	                                         data->comments_user_data, data->context, TRUE, &error);
+
+	if (data->success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_commentable_query_comments_multiple_async:
+ * @service: a #GDataService representing the service with which the objects' comments will be manipulated
+ * @commentables: (element-type GData.Commentable): a list of #GDataCommentable<!-- -->s to query the comments of
+ * @query: (allow-none): a #GDataQuery with query parameters, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @comments_callback: (allow-none) (closure comments_user_data): a #GDataCommentableCommentsCallback to call when each #GDataCommentable's
+ * comments have been queried, or %NULL
+ * @comments_user_data: (closure): data to pass to the @comments_callback function
+ * @destroy_comments_user_data: (allow-none): the function to call when @comments_callback will not be called any more, or %NULL. This function
+ * will be called with @comments_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the queries are finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Retrieves the comments on each of the #GDataCommentable<!-- -->s in @commentables, passing them to @comments_callback as they are loaded, in idle
+ * functions in the thread-default main context of the thread which called this function (see g_main_context_push_thread_default()). @service,
+ * @commentables and @query are all reffed/copied when this function is called, so can safely be unreffed/freed after this function returns.
+ *
+ * For more details, see gdata_commentable_query_comments_multiple(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_commentable_query_comments_multiple_finish() to get the
+ * results of the operation. @comments_callback is guaranteed to have been called for every #GDataCommentable before @callback is called.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_commentable_query_comments_multiple_async (GDataService *service, GList *commentables, GDataQuery *query, GCancellable *cancellable,
+                                                 GDataCommentableCommentsCallback comments_callback, gpointer comments_user_data,
+                                                 GDestroyNotify destroy_comments_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	QueryMultipleAsyncData *data;
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_SERVICE (service));
+	g_return_if_fail (query == NULL || GDATA_IS_QUERY (query));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = commentables; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_COMMENTABLE (i->data));
+
+	data = g_slice_new0 (QueryMultipleAsyncData);
+	data->commentables = g_list_copy (commentables);
+	g_list_foreach (data->commentables, (GFunc) g_object_ref, NULL);
+	data->query = (query != NULL) ? g_object_ref (query) : NULL;
+	data->comments_callback = comments_callback;
+	data->comments_user_data = comments_user_data;
+	data->destroy_comments_user_data = destroy_comments_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (service), callback, user_data, gdata_commentable_query_comments_multiple_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_multiple_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_comments_multiple_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_commentable_query_comments_multiple_finish:
+ * @service: the #GDataService passed to gdata_commentable_query_comments_multiple_async()
+ * @result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous comment query operation started with gdata_commentable_query_comments_multiple_async().
+ *
+ * Return value: %TRUE if all the #GDataCommentable<!-- -->s were queried (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_commentable_query_comments_multiple_finish (GDataService *service, GAsyncResult *result, GError **error)
+{
+	QueryMultipleAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service), gdata_commentable_query_comments_multiple_async) == TRUE,
+	                      FALSE);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error) == TRUE)
+		return FALSE;
+
+	data = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
+	return data->success;
+}
+
 /**
  * gdata_commentable_insert_comment:
  * @self: a #GDataCommentable
@@ -634,3 +917,420 @@ gdata_commentable_delete_comment_finish (GDataCommentable *self, GAsyncResult *r
 
 	return g_simple_async_result_get_op_res_gboolean (G_SIMPLE_ASYNC_RESULT (result));
 }
+
+typedef enum {
+	COMMENT_OPERATION_INSERTION,
+	COMMENT_OPERATION_DELETION,
+} CommentOperationType;
+
+typedef struct {
+	GDataService *service;
+	CommentOperationType type;
+	GCancellable *cancellable;
+	GAsyncQueue *results; /* CommentOperations */
+} ModifyMultipleData;
+
+typedef struct {
+	guint index;
+	GDataCommentable *commentable;
+	GDataComment *comment;
+	GDataComment *result;
+	GError *error;
+	GDataCommentableBatchCallback callback;
+	gpointer user_data;
+} CommentOperation;
+
+static void
+comment_operation_free (CommentOperation *operation)
+{
+	g_object_unref (operation->commentable);
+	g_object_unref (operation->comment);
+	if (operation->result != NULL)
+		g_object_unref (operation->result);
+	if (operation->error != NULL)
+		g_error_free (operation->error);
+
+	g_slice_free (CommentOperation, operation);
+}
+
+static void
+modify_comment_thread (CommentOperation *operation, ModifyMultipleData *data)
+{
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &(operation->error)) == FALSE) {
+		switch (data->type) {
+			case COMMENT_OPERATION_INSERTION:
+				operation->result = gdata_commentable_insert_comment (operation->commentable, data->service, operation->comment,
+				                                                      data->cancellable, &(operation->error));
+				break;
+			case COMMENT_OPERATION_DELETION:
+				gdata_commentable_delete_comment (operation->commentable, data->service, operation->comment, data->cancellable,
+				                                  &(operation->error));
+				break;
+			default:
+				g_assert_not_reached ();
+		}
+	}
+
+	g_async_queue_push (data->results, operation);
+}
+
+/* Run the user-supplied callback for a comment operation. This is designed to be used in an idle handler, so that the callback is run in the
+ * thread which started the operation. */
+static gboolean
+comment_operation_callback_cb (CommentOperation *operation)
+{
+	operation->callback (operation->index, operation->commentable, operation->comment, operation->result, operation->error, operation->user_data);
+	return FALSE;
+}
+
+static gboolean
+modify_comments_multiple (GDataService *service, CommentOperationType type, GList *commentables, GList *comments, GCancellable *cancellable,
+                          GDataCommentableBatchCallback batch_callback, gpointer batch_user_data, GMainContext *context, gboolean is_async,
+                          GError **error)
+{
+	ModifyMultipleData data;
+	GThreadPool *pool;
+	GList *i, *j;
+	guint index = 0, n_pending = 0;
+
+	data.service = service;
+	data.type = type;
+	data.cancellable = cancellable;
+	data.results = g_async_queue_new ();
+
+	/* Neither the YouTube nor the PicasaWeb comment feeds accept batch requests, so each comment needs a request of its own. As with
+	 * query_comments_multiple(), the requests are all to the same host, so there's no point making more at once than the service has
+	 * connections to it. */
+	pool = g_thread_pool_new ((GFunc) modify_comment_thread, &data, MAX (gdata_service_get_max_connections_per_host (service), 1), FALSE, NULL);
+
+	for (i = commentables, j = comments; i != NULL && j != NULL; i = i->next, j = j->next) {
+		CommentOperation *operation;
+
+		operation = g_slice_new0 (CommentOperation);
+		operation->index = index++;
+		operation->commentable = g_object_ref (i->data);
+		operation->comment = g_object_ref (j->data);
+
+		g_thread_pool_push (pool, operation, NULL);
+		n_pending++;
+	}
+
+	/* Report the outcome of each operation as it finishes */
+	for (; n_pending > 0; n_pending--) {
+		CommentOperation *operation = g_async_queue_pop (data.results);
+
+		if (batch_callback == NULL) {
+			comment_operation_free (operation);
+			continue;
+		}
+
+		operation->callback = batch_callback;
+		operation->user_data = batch_user_data;
+
+		if (is_async == TRUE) {
+			/* Dispatch in the thread-default main context of the thread which started the operation */
+			_gdata_service_idle_add (context, (GSourceFunc) comment_operation_callback_cb, operation, (GDestroyNotify) comment_operation_free);
+		} else {
+			comment_operation_callback_cb (operation);
+			comment_operation_free (operation);
+		}
+	}
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_async_queue_unref (data.results);
+
+	/* Errors for individual comments are reported to the callback; only cancellation of the whole operation is reported here */
+	return (g_cancellable_set_error_if_cancelled (cancellable, error) == FALSE);
+}
+
+/* Checks the arguments common to all the functions which modify multiple comments */
+static gboolean
+check_comments_multiple (GList *commentables, GList *comments)
+{
+	GList *i, *j;
+
+	for (i = commentables, j = comments; i != NULL && j != NULL; i = i->next, j = j->next) {
+		g_return_val_if_fail (GDATA_IS_COMMENTABLE (i->data), FALSE);
+		g_return_val_if_fail (GDATA_IS_COMMENT (j->data), FALSE);
+		g_return_val_if_fail (g_type_is_a (G_OBJECT_TYPE (j->data), get_comment_type (GDATA_COMMENTABLE_GET_IFACE (i->data))) == TRUE,
+		                      FALSE);
+	}
+
+	/* The lists must be the same length */
+	g_return_val_if_fail (i == NULL && j == NULL, FALSE);
+
+	return TRUE;
+}
+
+typedef struct {
+	CommentOperationType type;
+	GList *commentables;
+	GList *comments;
+	GDataCommentableBatchCallback batch_callback;
+	gpointer batch_user_data;
+	GDestroyNotify destroy_batch_user_data;
+	GMainContext *context;
+	gboolean success;
+} ModifyMultipleAsyncData;
+
+static void
+modify_multiple_async_data_free (ModifyMultipleAsyncData *data)
+{
+	g_list_free_full (data->commentables, g_object_unref);
+	g_list_free_full (data->comments, g_object_unref);
+
+	if (data->destroy_batch_user_data != NULL)
+		data->destroy_batch_user_data (data->batch_user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (ModifyMultipleAsyncData, data);
+}
+
+static void
+modify_comments_multiple_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+{
+	ModifyMultipleAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	data->success = modify_comments_multiple (service, data->type, data->commentables, data->comments, cancellable, data->batch_callback,
+	                                          data->batch_user_data, data->context, TRUE, &error);
+
+	if (data->success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+static void
+modify_comments_multiple_async (GDataService *service, CommentOperationType type, GList *commentables, GList *comments, GCancellable *cancellable,
+                                GDataCommentableBatchCallback batch_callback, gpointer batch_user_data, GDestroyNotify destroy_batch_user_data,
+                                GAsyncReadyCallback callback, gpointer user_data, gpointer source_tag)
+{
+	GSimpleAsyncResult *result;
+	ModifyMultipleAsyncData *data;
+
+	data = g_slice_new0 (ModifyMultipleAsyncData);
+	data->type = type;
+	data->commentables = g_list_copy (commentables);
+	g_list_foreach (data->commentables, (GFunc) g_object_ref, NULL);
+	data->comments = g_list_copy (comments);
+	g_list_foreach (data->comments, (GFunc) g_object_ref, NULL);
+	data->batch_callback = batch_callback;
+	data->batch_user_data = batch_user_data;
+	data->destroy_batch_user_data = destroy_batch_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (service), callback, user_data, source_tag);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) modify_multiple_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) modify_comments_multiple_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+static gboolean
+modify_comments_multiple_finish (GDataService *service, GAsyncResult *result, gpointer source_tag, GError **error)
+{
+	ModifyMultipleAsyncData *data;
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service), source_tag) == TRUE, FALSE);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error) == TRUE)
+		return FALSE;
+
+	data = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
+	return data->success;
+}
+
+/**
+ * gdata_commentable_insert_comments_multiple:
+ * @service: a #GDataService with which the comments will be added
+ * @commentables: (element-type GData.Commentable): a list of #GDataCommentable<!-- -->s to add the comments to
+ * @comments: (element-type GData.Comment): a list of new comments, the same length as @commentables
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (scope call) (closure batch_user_data): a #GDataCommentableBatchCallback to call when each comment has been
+ * added, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Adds each comment in @comments to the #GDataCommentable at the same position in @commentables, as by gdata_commentable_insert_comment(). Several
+ * comments are added concurrently (up to the #GDataService:max-connections-per-host of @service), so the comments on a single
+ * #GDataCommentable aren't necessarily added in the order they're listed. @batch_callback is called for every comment, with its position in
+ * @comments, with the added version of the comment as @result or with the error which occurred while adding it, in the order in which the
+ * comments are added.
+ *
+ * All the requests share @cancellable: if it's cancelled, the remaining comments aren't added (and @batch_callback is called with a
+ * %G_IO_ERROR_CANCELLED error for each of them), and %FALSE is returned with @error set. Errors for individual comments don't stop the others being
+ * added, and aren't returned in @error.
+ *
+ * Return value: %TRUE if all the comments were processed (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_commentable_insert_comments_multiple (GDataService *service, GList *commentables, GList *comments, GCancellable *cancellable,
+                                            GDataCommentableBatchCallback batch_callback, gpointer batch_user_data, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (check_comments_multiple (commentables, comments) == TRUE, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return modify_comments_multiple (service, COMMENT_OPERATION_INSERTION, commentables, comments, cancellable, batch_callback, batch_user_data,
+	                                 NULL, FALSE, error);
+}
+
+/**
+ * gdata_commentable_insert_comments_multiple_async:
+ * @service: a #GDataService with which the comments will be added
+ * @commentables: (element-type GData.Commentable): a list of #GDataCommentable<!-- -->s to add the comments to
+ * @comments: (element-type GData.Comment): a list of new comments, the same length as @commentables
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (closure batch_user_data): a #GDataCommentableBatchCallback to call when each comment has been added, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @destroy_batch_user_data: (allow-none): the function to call when @batch_callback will not be called any more, or %NULL. This function will
+ * be called with @batch_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Adds each comment in @comments to the #GDataCommentable at the same position in @commentables asynchronously, calling @batch_callback for each
+ * in an idle function in the thread-default main context of the thread which called this function (see g_main_context_push_thread_default()).
+ * @service, @commentables and @comments are all reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_commentable_insert_comments_multiple(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_commentable_insert_comments_multiple_finish() to get the
+ * results of the operation. @batch_callback is guaranteed to have been called for every comment before @callback is called.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_commentable_insert_comments_multiple_async (GDataService *service, GList *commentables, GList *comments, GCancellable *cancellable,
+                                                  GDataCommentableBatchCallback batch_callback, gpointer batch_user_data,
+                                                  GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (service));
+	g_return_if_fail (check_comments_multiple (commentables, comments) == TRUE);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	modify_comments_multiple_async (service, COMMENT_OPERATION_INSERTION, commentables, comments, cancellable, batch_callback, batch_user_data,
+	                                destroy_batch_user_data, callback, user_data, gdata_commentable_insert_comments_multiple_async);
+}
+
+/**
+ * gdata_commentable_insert_comments_multiple_finish:
+ * @service: the #GDataService passed to gdata_commentable_insert_comments_multiple_async()
+ * @result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous comment insertion operation started with gdata_commentable_insert_comments_multiple_async().
+ *
+ * Return value: %TRUE if all the comments were processed (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_commentable_insert_comments_multiple_finish (GDataService *service, GAsyncResult *result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return modify_comments_multiple_finish (service, result, gdata_commentable_insert_comments_multiple_async, error);
+}
+
+/**
+ * gdata_commentable_delete_comments_multiple:
+ * @service: a #GDataService with which the comments will be deleted
+ * @commentables: (element-type GData.Commentable): a list of the #GDataCommentable<!-- -->s the comments belong to
+ * @comments: (element-type GData.Comment): a list of comments to delete, the same length as @commentables
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (scope call) (closure batch_user_data): a #GDataCommentableBatchCallback to call when each comment has been
+ * deleted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Deletes each comment in @comments from the #GDataCommentable at the same position in @commentables, as by gdata_commentable_delete_comment().
+ * Several comments are deleted concurrently (up to the #GDataService:max-connections-per-host of @service). @batch_callback is called for every
+ * comment, with its position in @comments, with a %NULL @result, and with the error which occurred while deleting it (if any), in the order in
+ * which the comments are deleted.
+ *
+ * Cancellation and errors are handled as for gdata_commentable_insert_comments_multiple().
+ *
+ * Return value: %TRUE if all the comments were processed (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_commentable_delete_comments_multiple (GDataService *service, GList *commentables, GList *comments, GCancellable *cancellable,
+                                            GDataCommentableBatchCallback batch_callback, gpointer batch_user_data, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (check_comments_multiple (commentables, comments) == TRUE, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return modify_comments_multiple (service, COMMENT_OPERATION_DELETION, commentables, comments, cancellable, batch_callback, batch_user_data,
+	                                 NULL, FALSE, error);
+}
+
+/**
+ * gdata_commentable_delete_comments_multiple_async:
+ * @service: a #GDataService with which the comments will be deleted
+ * @commentables: (element-type GData.Commentable): a list of the #GDataCommentable<!-- -->s the comments belong to
+ * @comments: (element-type GData.Comment): a list of comments to delete, the same length as @commentables
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (closure batch_user_data): a #GDataCommentableBatchCallback to call when each comment has been deleted, or
+ * %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @destroy_batch_user_data: (allow-none): the function to call when @batch_callback will not be called any more, or %NULL. This function will
+ * be called with @batch_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Deletes each comment in @comments from the #GDataCommentable at the same position in @commentables asynchronously, calling @batch_callback for
+ * each in an idle function in the thread-default main context of the thread which called this function (see g_main_context_push_thread_default()).
+ * @service, @commentables and @comments are all reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_commentable_delete_comments_multiple(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_commentable_delete_comments_multiple_finish() to get the
+ * results of the operation. @batch_callback is guaranteed to have been called for every comment before @callback is called.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_commentable_delete_comments_multiple_async (GDataService *service, GList *commentables, GList *comments, GCancellable *cancellable,
+                                                  GDataCommentableBatchCallback batch_callback, gpointer batch_user_data,
+                                                  GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (service));
+	g_return_if_fail (check_comments_multiple (commentables, comments) == TRUE);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	modify_comments_multiple_async (service, COMMENT_OPERATION_DELETION, commentables, comments, cancellable, batch_callback, batch_user_data,
+	                                destroy_batch_user_data, callback, user_data, gdata_commentable_delete_comments_multiple_async);
+}
+
+/**
+ * gdata_commentable_delete_comments_multiple_finish:
+ * @service: the #GDataService passed to gdata_commentable_delete_comments_multiple_async()
+ * @result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous comment deletion operation started with gdata_commentable_delete_comments_multiple_async().
+ *
+ * Return value: %TRUE if all the comments were processed (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_commentable_delete_comments_multiple_finish (GDataService *service, GAsyncResult *result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return modify_comments_multiple_finish (service, result, gdata_commentable_delete_comments_multiple_async, error);
+}
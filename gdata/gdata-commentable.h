@@ -74,6 +74,40 @@ typedef struct {
 	gboolean (*is_comment_deletable) (GDataCommentable *self, GDataComment *comment);
 } GDataCommentableInterface;
 
+/**
+ * GDataCommentableCommentsCallback:
+ * @commentable: the #GDataCommentable whose comments were queried
+ * @comments: (allow-none): a #GDataFeed of the #GDataComment<!-- -->s on @commentable, or %NULL
+ * @error: a #GError describing any error which occurred, or %NULL
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called once for each #GDataCommentable queried by gdata_commentable_query_comments_multiple(), as soon as its comments have
+ * been queried. If the query was successful, @comments will contain the comments and @error will be %NULL. Otherwise, @comments will be %NULL and
+ * a descriptive error will be in @error (for example, %GDATA_SERVICE_ERROR_FORBIDDEN if @commentable doesn't support comments).
+ *
+ * Both @comments and @error are owned by the caller; if the callback needs to keep @comments, it must reference it.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataCommentableCommentsCallback) (GDataCommentable *commentable, GDataFeed *comments, GError *error, gpointer user_data);
+
+/**
+ * GDataCommentableBatchCallback:
+ * @index: the position of @comment in the list of comments passed to the operation
+ * @commentable: the #GDataCommentable which @comment was added to or deleted from
+ * @comment: the comment which was added or deleted, as passed to the operation
+ * @result: (allow-none): the added version of @comment as returned by the server, or %NULL for deletions and if an error occurred
+ * @error: (allow-none): a #GError describing any error which occurred while adding or deleting @comment, or %NULL
+ * @user_data: user data passed to the callback
+ *
+ * Callback for gdata_commentable_insert_comments_multiple() and gdata_commentable_delete_comments_multiple(), called once for each comment, as
+ * soon as it's been processed. All the parameters are owned by the operation; if the callback needs to keep @result, it must reference it.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataCommentableBatchCallback) (guint index, GDataCommentable *commentable, GDataComment *comment, GDataComment *result,
+                                               GError *error, gpointer user_data);
+
 GType gdata_commentable_get_type (void) G_GNUC_CONST;
 
 GDataFeed *gdata_commentable_query_comments (GDataCommentable *self, GDataService *service, GDataQuery *query, GCancellable *cancellable,
@@ -85,6 +119,15 @@ void gdata_commentable_query_comments_async (GDataCommentable *self, GDataServic
 GDataFeed *gdata_commentable_query_comments_finish (GDataCommentable *self, GAsyncResult *result,
                                                     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
+gboolean gdata_commentable_query_comments_multiple (GDataService *service, GList *commentables, GDataQuery *query, GCancellable *cancellable,
+                                                    GDataCommentableCommentsCallback comments_callback, gpointer comments_user_data,
+                                                    GError **error);
+void gdata_commentable_query_comments_multiple_async (GDataService *service, GList *commentables, GDataQuery *query, GCancellable *cancellable,
+                                                      GDataCommentableCommentsCallback comments_callback, gpointer comments_user_data,
+                                                      GDestroyNotify destroy_comments_user_data, GAsyncReadyCallback callback,
+                                                      gpointer user_data);
+gboolean gdata_commentable_query_comments_multiple_finish (GDataService *service, GAsyncResult *result, GError **error);
+
 GDataComment *gdata_commentable_insert_comment (GDataCommentable *self, GDataService *service, GDataComment *comment_, GCancellable *cancellable,
                                                 GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 void gdata_commentable_insert_comment_async (GDataCommentable *self, GDataService *service, GDataComment *comment_, GCancellable *cancellable,
@@ -98,6 +141,22 @@ void gdata_commentable_delete_comment_async (GDataCommentable *self, GDataServic
                                              GAsyncReadyCallback callback, gpointer user_data);
 gboolean gdata_commentable_delete_comment_finish (GDataCommentable *self, GAsyncResult *result, GError **error);
 
+gboolean gdata_commentable_insert_comments_multiple (GDataService *service, GList *commentables, GList *comments, GCancellable *cancellable,
+                                                     GDataCommentableBatchCallback batch_callback, gpointer batch_user_data, GError **error);
+void gdata_commentable_insert_comments_multiple_async (GDataService *service, GList *commentables, GList *comments, GCancellable *cancellable,
+                                                       GDataCommentableBatchCallback batch_callback, gpointer batch_user_data,
+                                                       GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback,
+                                                       gpointer user_data);
+gboolean gdata_commentable_insert_comments_multiple_finish (GDataService *service, GAsyncResult *result, GError **error);
+
+gboolean gdata_commentable_delete_comments_multiple (GDataService *service, GList *commentables, GList *comments, GCancellable *cancellable,
+                                                     GDataCommentableBatchCallback batch_callback, gpointer batch_user_data, GError **error);
+void gdata_commentable_delete_comments_multiple_async (GDataService *service, GList *commentables, GList *comments, GCancellable *cancellable,
+                                                       GDataCommentableBatchCallback batch_callback, gpointer batch_user_data,
+                                                       GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback,
+                                                       gpointer user_data);
+gboolean gdata_commentable_delete_comments_multiple_finish (GDataService *service, GAsyncResult *result, GError **error);
+
 G_END_DECLS
 
 #endif /* !GDATA_COMMENTABLE_H */
@@ -0,0 +1,234 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-deadline
+ * @short_description: GData operation deadlines
+ * @stability: Unstable
+ * @include: gdata/gdata-deadline.h
+ *
+ * #GDataService:timeout only limits how long each individual network operation may take, so an operation which makes several requests (following
+ * redirects, refreshing its authorization, retrying transient failures or fetching several pages) can take many times longer. To limit the total
+ * time taken by an operation, set a deadline on the #GCancellable passed to it using gdata_cancellable_set_deadline().
+ *
+ * Once the deadline has passed, the cancellable is cancelled, so the operation (including whichever request it's in the middle of) fails with
+ * %G_IO_ERROR_CANCELLED. Work which couldn't finish in time is shed early: a request which would have to wait past the deadline for the service's
+ * rate limits is cancelled straight away rather than waiting, and a transient failure which couldn't be retried before the deadline is returned
+ * rather than retried.
+ *
+ * Since the deadline belongs to the cancellable, it applies to every operation using the cancellable, synchronous or asynchronous; so one
+ * cancellable can give a whole sequence of operations a shared budget.
+ *
+ * <example>
+ *	<title>Limiting a Query to Two Seconds</title>
+ *	<programlisting>
+ *	GCancellable *cancellable;
+ *	GDataFeed *feed;
+ *	GError *error = NULL;
+ *
+ *	cancellable = g_cancellable_new ();
+ *	gdata_cancellable_set_deadline (cancellable, g_get_monotonic_time () + 2 * G_USEC_PER_SEC);
+ *
+ *	feed = gdata_service_query (service, domain, feed_uri, query, GDATA_TYPE_ENTRY, cancellable, NULL, NULL, &error);
+ *
+ *	g_object_unref (cancellable);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-deadline.h"
+#include "gdata-private.h"
+
+static GQuark
+get_deadline_quark (void)
+{
+	static gsize deadline_quark = 0;
+
+	if (g_once_init_enter (&deadline_quark) == TRUE)
+		g_once_init_leave (&deadline_quark, g_quark_from_static_string ("gdata-deadline"));
+
+	return (GQuark) deadline_quark;
+}
+
+/* The timeout sources which cancel cancellables at their deadlines are all attached to one main context, whose loop runs in its own thread, so that
+ * the deadlines fire whichever thread (if any) is iterating a main loop. */
+static gpointer
+deadline_thread (GMainContext *context)
+{
+	GMainLoop *loop = g_main_loop_new (context, FALSE);
+	g_main_loop_run (loop);
+
+	return NULL;
+}
+
+static GMainContext *
+get_deadline_context (void)
+{
+	static gsize deadline_context = 0;
+
+	if (g_once_init_enter (&deadline_context) == TRUE) {
+		GMainContext *context = g_main_context_new ();
+		g_thread_unref (g_thread_new ("gdata-deadline-thread", (GThreadFunc) deadline_thread, context));
+		g_once_init_leave (&deadline_context, (gsize) context);
+	}
+
+	return (GMainContext*) deadline_context;
+}
+
+typedef struct {
+	gint64 deadline;
+	GSource *source; /* cancels the cancellable at the deadline */
+	gulong cancelled_signal;
+} Deadline;
+
+static gboolean
+deadline_passed_cb (GCancellable *cancellable)
+{
+	g_cancellable_cancel (cancellable);
+	return FALSE;
+}
+
+static void
+deadline_cancelled_cb (GCancellable *cancellable, GSource *source)
+{
+	/* The cancellable's been cancelled by something else, so the timeout's no longer needed. This also drops its reference to the cancellable. */
+	g_source_destroy (source);
+}
+
+static void
+deadline_free (Deadline *deadline)
+{
+	g_source_destroy (deadline->source);
+	g_source_unref (deadline->source);
+	g_slice_free (Deadline, deadline);
+}
+
+G_LOCK_DEFINE_STATIC (deadlines);
+
+/**
+ * gdata_cancellable_set_deadline:
+ * @cancellable: a #GCancellable
+ * @deadline: the time (in monotonic time; see g_get_monotonic_time()) at which to cancel @cancellable, or <code class="literal">-1</code> to unset
+ * its deadline
+ *
+ * Sets the deadline by which all the libgdata operations using @cancellable must finish. @cancellable is cancelled once the deadline has passed
+ * (straight away, if it's already passed), and libgdata doesn't start requests or retries which couldn't finish in time. See the section
+ * documentation for more details.
+ *
+ * Setting a new deadline replaces any previous one.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_cancellable_set_deadline (GCancellable *cancellable, gint64 deadline)
+{
+	Deadline *data;
+	gint64 now;
+
+	g_return_if_fail (G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (deadline >= -1);
+
+	G_LOCK (deadlines);
+
+	data = g_object_steal_qdata (G_OBJECT (cancellable), get_deadline_quark ());
+	if (data != NULL) {
+		g_cancellable_disconnect (cancellable, data->cancelled_signal);
+		deadline_free (data);
+	}
+
+	if (deadline < 0) {
+		G_UNLOCK (deadlines);
+		return;
+	}
+
+	now = g_get_monotonic_time ();
+
+	data = g_slice_new (Deadline);
+	data->deadline = deadline;
+	data->source = g_timeout_source_new ((guint) MIN ((MAX (deadline - now, 0) + 999) / 1000, G_MAXUINT));
+	g_source_set_callback (data->source, (GSourceFunc) deadline_passed_cb, g_object_ref (cancellable), g_object_unref);
+	g_source_attach (data->source, get_deadline_context ());
+
+	/* This is called immediately if the cancellable's already been cancelled; that's safe with the lock held since the callback doesn't take it */
+	data->cancelled_signal = g_cancellable_connect (cancellable, (GCallback) deadline_cancelled_cb, g_source_ref (data->source),
+	                                                (GDestroyNotify) g_source_unref);
+
+	g_object_set_qdata_full (G_OBJECT (cancellable), get_deadline_quark (), data, (GDestroyNotify) deadline_free);
+
+	G_UNLOCK (deadlines);
+}
+
+/**
+ * gdata_cancellable_get_deadline:
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ *
+ * Gets the deadline set on @cancellable by gdata_cancellable_set_deadline().
+ *
+ * Return value: the deadline, in monotonic time, or <code class="literal">-1</code> if @cancellable is %NULL or has no deadline
+ *
+ * Since: 0.15.0
+ **/
+gint64
+gdata_cancellable_get_deadline (GCancellable *cancellable)
+{
+	Deadline *data;
+	gint64 deadline;
+
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), -1);
+
+	if (cancellable == NULL)
+		return -1;
+
+	G_LOCK (deadlines);
+	data = g_object_get_qdata (G_OBJECT (cancellable), get_deadline_quark ());
+	deadline = (data != NULL) ? data->deadline : -1;
+	G_UNLOCK (deadlines);
+
+	return deadline;
+}
+
+/*
+ * _gdata_cancellable_shed_past_deadline:
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @time: the monotonic time by which some work would finish
+ *
+ * Checks whether work which would finish at @time would overrun the deadline of @cancellable (if it has one), and if so, cancels @cancellable
+ * straight away so that the work isn't started.
+ *
+ * Return value: %TRUE if @cancellable has been cancelled, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_cancellable_shed_past_deadline (GCancellable *cancellable, gint64 time)
+{
+	gint64 deadline = gdata_cancellable_get_deadline (cancellable);
+
+	if (deadline < 0 || time <= deadline)
+		return FALSE;
+
+	g_cancellable_cancel (cancellable);
+
+	return TRUE;
+}
@@ -29,7 +29,9 @@
  *
  * Once a #GDataDownloadStream is instantiated with gdata_download_stream_new(), the standard #GInputStream API can be used on the stream to download
  * the file. Network communication may not actually begin until the first call to g_input_stream_read(), so having a #GDataDownloadStream around is no
- * guarantee that the file is being downloaded.
+ * guarantee that the file is being downloaded. The network activity of all the streams created for a #GDataService is handled by a single
+ * thread belonging to that service, so having many streams open at once doesn't need a thread for each of them; the #GInputStream methods
+ * still block as usual while they wait for data.
  *
  * The content type and length of the file being downloaded are made available through #GDataDownloadStream:content-type and
  * #GDataDownloadStream:content-length as soon as the appropriate data is received from the server. Connect to the
@@ -54,6 +56,15 @@
  * If the server returns an error message (for example, if the user is not correctly authenticated/authorized or doesn't have suitable permissions to
  * download from the given URI), it will be returned as a #GDataServiceError by the first call to g_input_stream_read().
  *
+ * If #GDataDownloadStream:auto-resume is enabled, a download which is interrupted by a network failure is resumed from where it left off rather than
+ * returning an error, as long as the file hasn't changed on the server in the meantime.
+ *
+ * Large files can be downloaded straight to a #GFile over several connections at once using gdata_download_stream_download_segments(), instead of
+ * being read through the #GInputStream API.
+ *
+ * If the service has a #GDataService:blob-store, files which are read through the #GInputStream API from their start are written through to the
+ * store, and are read back out of it by later downloads for as long as the server says they haven't changed.
+ *
  * <example>
  * 	<title>Downloading to a File</title>
  * 	<programlisting>
@@ -103,6 +114,14 @@
 #include <config.h>
 #include <glib.h>
 #include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#endif
 
 #include "gdata-download-stream.h"
 #include "gdata-buffer.h"
@@ -124,25 +143,26 @@ static gboolean gdata_download_stream_seek (GSeekable *seekable, goffset offset,
 static gboolean gdata_download_stream_can_truncate (GSeekable *seekable);
 static gboolean gdata_download_stream_truncate (GSeekable *seekable, goffset offset, GCancellable *cancellable, GError **error);
 
-static void create_network_thread (GDataDownloadStream *self, GError **error);
-static void reset_network_thread (GDataDownloadStream *self);
+static gboolean start_network (GDataDownloadStream *self, GError **error);
+static void reset_network (GDataDownloadStream *self);
+static void buffer_drained (GDataDownloadStream *self, gsize length);
 
 /*
  * The GDataDownloadStream can be in one of several states:
- *  1. Pre-network activity. This is the state that the stream is created in. @network_thread and @cancellable are both %NULL, and @finished is %FALSE.
+ *  1. Pre-network activity. This is the state that the stream is created in. @network_started is %FALSE, @buffer is %NULL, and @finished is %FALSE.
  *     The stream will remain in this state until gdata_download_stream_read() or gdata_download_stream_seek() are called for the first time.
  *     @content_type and @content_length are at their default values (NULL and -1, respectively).
  *  2. Network activity. This state is entered when gdata_download_stream_read() is called for the first time.
- *     @network_thread, @buffer and @cancellable are created, while @finished remains %FALSE.
+ *     @network_started is set, @buffer is created and the request is started in the service's I/O loop, while @finished remains %FALSE.
  *     As soon as the headers are downloaded, which is guaranteed to be before the first call to gdata_download_stream_read() returns, @content_type
  *     and @content_length are set from the headers. From this point onwards, they are immutable.
- *  3. Reset network activity. This state is entered only if case 3 is encountered in a call to gdata_download_stream_seek(): a seek to an offset which
- *     has already been read out of the buffer. In this state, @buffer is freed and set to %NULL, @network_thread is cancelled (then set to %NULL),
+ *  3. Reset network activity. This state is entered only if case 4 is encountered in a call to gdata_download_stream_seek(): a seek to an offset which
+ *     has already been read out of the buffer and isn't in the seek window, or which is too far ahead to drain the buffer to. In this state, @buffer is freed and set to %NULL, the request is cancelled (then @network_started is unset),
  *     and @offset is set to the seeked-to offset. @finished remains at %FALSE.
  *     When the next call to gdata_download_stream_read() is made, the download stream will go back to state 2 as if this was the first call to
  *     gdata_download_stream_read().
- *  4. Post-network activity. This state is reached once the download thread finishes downloading, due to having downloaded everything.
- *     @buffer is non-%NULL, @network_thread is non-%NULL, but meaningless; @cancellable is still a valid #GCancellable instance; and @finished is set
+ *  4. Post-network activity. This state is reached once the request finishes, due to having downloaded everything.
+ *     @buffer is non-%NULL, @network_started is still set; @cancellable is still a valid #GCancellable instance; and @finished is set
  *     to %TRUE. At the same time, @finished_cond is signalled.
  *     This state can be exited either by making a call to gdata_download_stream_seek(), in which case the stream will go back to state 3; or by
  *     calling gdata_download_stream_close(), in which case the stream will return errors for all operations, as the underlying %GInputStream will be
@@ -155,9 +175,67 @@ struct _GDataDownloadStreamPrivate {
 	SoupSession *session;
 	SoupMessage *message;
 	GDataBuffer *buffer;
+	guint max_buffer_size; /* high-water mark for ->buffer, or 0 for no limit; only read by start_network() */
+	guint buffer_limit; /* ->max_buffer_size as it was when the network was started, which ->buffer was sized for */
 	goffset offset; /* current position in the stream */
 
-	GThread *network_thread;
+	/* Seek policy */
+	guint seek_threshold; /* forward seeks further than this restart the connection rather than draining ->buffer */
+	guint seek_window_size; /* size to allocate ->seek_window with when the request is next started */
+
+	/* The most recently read bytes, kept so that short backward seeks can be served without a new request. ->seek_window is a circular buffer
+	 * of ->seek_window_capacity bytes, of which the ->seek_window_length bytes ending before ->seek_window_end are valid. The last
+	 * ->seek_window_replay of those are in front of ->offset (i.e. the stream has been seeked backwards over them), and are returned by the
+	 * next reads before any more data is taken from ->buffer. */
+	guint8 *seek_window;
+	gsize seek_window_capacity;
+	gsize seek_window_length;
+	gsize seek_window_end;
+	gsize seek_window_replay;
+
+	/* Automatic resumption. These are only touched by the I/O thread, apart from ->auto_resume. */
+	gboolean auto_resume;
+	goffset network_offset; /* offset of the next byte to be received from the network */
+	goffset start_offset; /* value of ->network_offset when the current request was sent */
+	guint resume_attempt;
+	gboolean resuming; /* whether the current request is resuming an interrupted one */
+	gchar *etag; /* validators from the first response, used to check that a resumed download is of the same version of the file */
+	gchar *last_modified;
+	GSource *resume_source; /* timeout before the next attempt to resume, or %NULL */
+	GSource *resume_cancel_source; /* cancellation of ->network_cancellable during the timeout, or %NULL */
+
+	GDataBandwidthLimiter *bandwidth_limiter; /* per-stream limit; the service's limit applies as well */
+
+	/* The service's #GDataService:blob-store, if the request started from the beginning of the file. ->stored_blob is the copy of the file which
+	 * was already in the store (with its ->stored_etag and ->stored_content_type), if any; the request is made conditional on it, and if the
+	 * server says it's still current, ->reading_stored_blob is set and reads are served from it instead. Otherwise, the response is written
+	 * through to the store by ->blob_writer, which is only touched by the I/O thread. These are all set by start_network() and cleared by
+	 * reset_network(). */
+	GDataBlobStore *blob_store;
+	GBytes *stored_blob;
+	gchar *stored_etag;
+	gchar *stored_content_type;
+	gboolean reading_stored_blob; /* only touched by the reader */
+	GDataBlobWriter *blob_writer;
+
+	/* Network activity is driven by the service's I/O loop (see #GDataIOLoop), rather than by a thread of our own, so it must never block. Instead,
+	 * the message is paused while the bandwidth limits are being waited for (->throttle_source is non-%NULL) or while ->buffer is full
+	 * (->waiting_for_space is set). Data which has been received but doesn't fit in ->buffer is held in ->overflow until the reader has made
+	 * space for it. These, and ->message_paused, are only touched by the I/O thread, except that the reader reads ->waiting_for_space and keeps
+	 * ->buffered_length up to date, both atomically. */
+	gboolean network_started; /* only touched by the reader */
+	GDataIOLoop *io_loop;
+	gulong headers_signal;
+	gulong chunk_signal;
+	GSource *throttle_source;
+	gboolean message_queued; /* TRUE from queueing each request on the session until it's finished */
+	gboolean message_paused;
+	volatile gint buffered_length; /* bytes in ->buffer, if ->buffer_limit is non-zero */
+	volatile gint waiting_for_space;
+	volatile gint space_available_pending; /* set while a call to space_available_cb() is pending */
+	GByteArray *overflow; /* received data still to be pushed onto ->buffer, or %NULL */
+	gboolean finish_pending; /* TRUE if finish_network() is waiting for ->overflow to be pushed */
+
 	GCancellable *cancellable;
 	GCancellable *network_cancellable; /* see the comment in gdata_download_stream_constructor() about the relationship between these two */
 
@@ -178,8 +256,23 @@ enum {
 	PROP_CONTENT_LENGTH,
 	PROP_CANCELLABLE,
 	PROP_AUTHORIZATION_DOMAIN,
+	PROP_MAX_BUFFER_SIZE,
+	PROP_SEEK_THRESHOLD,
+	PROP_SEEK_WINDOW_SIZE,
+	PROP_AUTO_RESUME,
+	PROP_BANDWIDTH_LIMIT,
 };
 
+#define DEFAULT_MAX_BUFFER_SIZE (8 * 1024 * 1024) /* bytes = 8 MiB */
+#define DEFAULT_SEEK_THRESHOLD (1024 * 1024) /* bytes = 1 MiB */
+#define DEFAULT_SEEK_WINDOW_SIZE (256 * 1024) /* bytes = 256 KiB */
+
+/* Backoff between attempts to resume an interrupted download. The delay doubles on each attempt, and the attempt count is reset whenever an attempt
+ * manages to download some data. */
+#define MAX_RESUME_ATTEMPTS 8
+#define INITIAL_RESUME_DELAY 1 /* seconds */
+#define MAX_RESUME_DELAY 60 /* seconds */
+
 G_DEFINE_TYPE_WITH_CODE (GDataDownloadStream, gdata_download_stream, G_TYPE_INPUT_STREAM,
                          G_IMPLEMENT_INTERFACE (G_TYPE_SEEKABLE, gdata_download_stream_seekable_iface_init))
 
@@ -298,6 +391,94 @@ gdata_download_stream_class_init (GDataDownloadStreamClass *klass)
 	                                                      "Cancellable", "An optional cancellable used to cancel the entire download operation.",
 	                                                      G_TYPE_CANCELLABLE,
 	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDownloadStream:max-buffer-size:
+	 *
+	 * The maximum number of bytes (approximately) which will be buffered after being received from the network and before being read from the
+	 * stream. Once the buffer is full, the download is paused until half of it has been read, so that memory usage stays bounded if the stream is
+	 * read more slowly than the data arrives. If this is <code class="literal">0</code>, the buffer is unbounded.
+	 *
+	 * A bounded buffer is allocated in full (rounded up to a power of two) when the network connection is started, so this shouldn't be set much
+	 * larger than is needed. Changes to this property take effect the next time the network connection is started (i.e. on the first read, or
+	 * the first read after seeking backwards).
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MAX_BUFFER_SIZE,
+	                                 g_param_spec_uint ("max-buffer-size",
+	                                                    "Maximum buffer size", "The maximum number of bytes to buffer from the network.",
+	                                                    0, G_MAXUINT, DEFAULT_MAX_BUFFER_SIZE,
+	                                                    G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDownloadStream:seek-threshold:
+	 *
+	 * The furthest (in bytes) a forward seek can go by downloading and discarding the intervening data. Seeking any further ahead closes the
+	 * network connection and opens a new one with a <literal>Range</literal> request starting at the new offset, which is quicker for long seeks
+	 * as the intervening data isn't downloaded at all. Seeks within data which has already been downloaded completely are never restarted.
+	 *
+	 * Set this to %G_MAXUINT to always drain, or to <code class="literal">0</code> to restart the connection for every forward seek which can't
+	 * be served from memory.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SEEK_THRESHOLD,
+	                                 g_param_spec_uint ("seek-threshold",
+	                                                    "Seek threshold", "The furthest a forward seek can go without restarting the download.",
+	                                                    0, G_MAXUINT, DEFAULT_SEEK_THRESHOLD,
+	                                                    G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDownloadStream:seek-window-size:
+	 *
+	 * The number of recently read bytes to keep in memory, so that backward seeks of up to this distance can be served without making a new
+	 * network request. This suits media demuxers, which often seek back a short way. If this is <code class="literal">0</code>, every backward
+	 * seek restarts the download.
+	 *
+	 * Changes to this property take effect the next time the network connection is started.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SEEK_WINDOW_SIZE,
+	                                 g_param_spec_uint ("seek-window-size",
+	                                                    "Seek window size", "The number of recently read bytes to keep for backward seeks.",
+	                                                    0, G_MAXUINT, DEFAULT_SEEK_WINDOW_SIZE,
+	                                                    G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDownloadStream:auto-resume:
+	 *
+	 * Whether to automatically resume the download if the network connection fails part-way through. If this is %TRUE, the download is retried
+	 * from the last byte received, with an exponentially increasing delay between attempts, and the failure is only reported by
+	 * g_input_stream_read() if it persists.
+	 *
+	 * Downloads are only resumed if the server provided an <literal>ETag</literal> or <literal>Last-Modified</literal> header for the file, which
+	 * is then used to check that the rest of the file comes from the same version of it. If the file has changed on the server in the meantime,
+	 * %GDATA_SERVICE_ERROR_CONFLICT is returned rather than parts of two versions being joined together.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_AUTO_RESUME,
+	                                 g_param_spec_boolean ("auto-resume",
+	                                                       "Auto-resume?", "Whether to automatically resume the download after a network failure.",
+	                                                       FALSE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDownloadStream:bandwidth-limit:
+	 *
+	 * The maximum rate at which this stream may download data, in bytes per second, or <code class="literal">0</code> for no limit. This
+	 * applies in addition to #GDataService:download-bandwidth-limit, which is shared between all the streams using the service, and also
+	 * applies to the whole of a download made using gdata_download_stream_download_segments() or gdata_download_stream_download_to_file().
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_BANDWIDTH_LIMIT,
+	                                 g_param_spec_uint ("bandwidth-limit",
+	                                                    "Bandwidth limit", "The maximum rate at which to download data, in bytes per second.",
+	                                                    0, G_MAXINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -314,7 +495,7 @@ static void
 gdata_download_stream_init (GDataDownloadStream *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_DOWNLOAD_STREAM, GDataDownloadStreamPrivate);
-	self->priv->buffer = NULL; /* created when the network thread is started and destroyed when the stream is closed */
+	self->priv->buffer = NULL; /* created when the request is started and destroyed when the stream is closed */
 
 	self->priv->finished = FALSE;
 	g_cond_init (&(self->priv->finished_cond));
@@ -323,6 +504,8 @@ gdata_download_stream_init (GDataDownloadStream *self)
 	self->priv->content_type = NULL;
 	self->priv->content_length = -1;
 	g_mutex_init (&(self->priv->content_mutex));
+
+	self->priv->bandwidth_limiter = gdata_bandwidth_limiter_new ();
 }
 
 static void
@@ -359,6 +542,7 @@ gdata_download_stream_constructor (GType type, guint n_construct_params, GObject
 	soup_uri_set_port (_uri, _gdata_service_get_https_port ());
 	priv->message = soup_message_new_from_uri (SOUP_METHOD_GET, _uri);
 	soup_uri_free (_uri);
+	_gdata_service_claim_message (priv->service, priv->message);
 
 	/* Make sure the headers are set */
 	klass = GDATA_SERVICE_GET_CLASS (priv->service);
@@ -369,6 +553,9 @@ gdata_download_stream_constructor (GType type, guint n_construct_params, GObject
 	/* We don't want to accumulate chunks */
 	soup_message_body_set_accumulate (priv->message->request_body, FALSE);
 
+	/* Byte offsets (for seeking and resuming) have to refer to the file itself, not a compressed encoding of it */
+	soup_message_disable_feature (priv->message, SOUP_TYPE_CONTENT_DECODER);
+
 	/* Downloading doesn't actually start until the first call to read() */
 
 	return object;
@@ -394,8 +581,14 @@ gdata_download_stream_dispose (GObject *object)
 		g_object_unref (priv->authorization_domain);
 	priv->authorization_domain = NULL;
 
-	if (priv->service != NULL)
+	if (priv->service != NULL) {
+		/* The buffer's normally been freed by closing the stream, but mustn't be counted by the service after it's gone if not */
+		if (priv->buffer != NULL)
+			gdata_buffer_set_length_counter (priv->buffer, NULL);
+
+		_gdata_service_remove_stream (priv->service, GDATA_OPERATION_DOWNLOAD);
 		g_object_unref (priv->service);
+	}
 	priv->service = NULL;
 
 	if (priv->message != NULL)
@@ -411,15 +604,19 @@ gdata_download_stream_finalize (GObject *object)
 {
 	GDataDownloadStreamPrivate *priv = GDATA_DOWNLOAD_STREAM (object)->priv;
 
-	reset_network_thread (GDATA_DOWNLOAD_STREAM (object));
+	reset_network (GDATA_DOWNLOAD_STREAM (object));
 
 	g_cond_clear (&(priv->finished_cond));
 	g_mutex_clear (&(priv->finished_mutex));
 
 	g_mutex_clear (&(priv->content_mutex));
 
+	gdata_bandwidth_limiter_free (priv->bandwidth_limiter);
+
 	g_free (priv->download_uri);
 	g_free (priv->content_type);
+	g_free (priv->etag);
+	g_free (priv->last_modified);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_download_stream_parent_class)->finalize (object);
@@ -453,6 +650,21 @@ gdata_download_stream_get_property (GObject *object, guint property_id, GValue *
 		case PROP_CANCELLABLE:
 			g_value_set_object (value, priv->cancellable);
 			break;
+		case PROP_MAX_BUFFER_SIZE:
+			g_value_set_uint (value, priv->max_buffer_size);
+			break;
+		case PROP_SEEK_THRESHOLD:
+			g_value_set_uint (value, priv->seek_threshold);
+			break;
+		case PROP_SEEK_WINDOW_SIZE:
+			g_value_set_uint (value, priv->seek_window_size);
+			break;
+		case PROP_AUTO_RESUME:
+			g_value_set_boolean (value, gdata_download_stream_get_auto_resume (GDATA_DOWNLOAD_STREAM (object)));
+			break;
+		case PROP_BANDWIDTH_LIMIT:
+			g_value_set_uint (value, gdata_download_stream_get_bandwidth_limit (GDATA_DOWNLOAD_STREAM (object)));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -469,6 +681,9 @@ gdata_download_stream_set_property (GObject *object, guint property_id, const GV
 		case PROP_SERVICE:
 			priv->service = g_value_dup_object (value);
 			priv->session = _gdata_service_get_session (priv->service);
+
+			/* Count the stream in the service's gauges until it's disposed */
+			_gdata_service_add_stream (priv->service, GDATA_OPERATION_DOWNLOAD);
 			break;
 		case PROP_AUTHORIZATION_DOMAIN:
 			priv->authorization_domain = g_value_dup_object (value);
@@ -480,6 +695,21 @@ gdata_download_stream_set_property (GObject *object, guint property_id, const GV
 			/* Construction only */
 			priv->cancellable = g_value_dup_object (value);
 			break;
+		case PROP_MAX_BUFFER_SIZE:
+			gdata_download_stream_set_max_buffer_size (GDATA_DOWNLOAD_STREAM (object), g_value_get_uint (value));
+			break;
+		case PROP_SEEK_THRESHOLD:
+			gdata_download_stream_set_seek_threshold (GDATA_DOWNLOAD_STREAM (object), g_value_get_uint (value));
+			break;
+		case PROP_SEEK_WINDOW_SIZE:
+			gdata_download_stream_set_seek_window_size (GDATA_DOWNLOAD_STREAM (object), g_value_get_uint (value));
+			break;
+		case PROP_AUTO_RESUME:
+			gdata_download_stream_set_auto_resume (GDATA_DOWNLOAD_STREAM (object), g_value_get_boolean (value));
+			break;
+		case PROP_BANDWIDTH_LIMIT:
+			gdata_download_stream_set_bandwidth_limit (GDATA_DOWNLOAD_STREAM (object), g_value_get_uint (value));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -493,6 +723,64 @@ read_cancelled_cb (GCancellable *cancellable, GCancellable *child_cancellable)
 	g_cancellable_cancel (child_cancellable);
 }
 
+/* Adds data which has just been read from ->buffer to the seek window, overwriting the oldest data in it if necessary */
+static void
+seek_window_append (GDataDownloadStreamPrivate *priv, const guint8 *data, gsize length)
+{
+	gsize first_length;
+
+	g_assert (priv->seek_window != NULL && priv->seek_window_replay == 0);
+
+	/* Only the end of the data will fit */
+	if (length > priv->seek_window_capacity) {
+		data += length - priv->seek_window_capacity;
+		length = priv->seek_window_capacity;
+	}
+
+	first_length = MIN (length, priv->seek_window_capacity - priv->seek_window_end);
+	memcpy (priv->seek_window + priv->seek_window_end, data, first_length);
+	memcpy (priv->seek_window, data + first_length, length - first_length);
+
+	priv->seek_window_end = (priv->seek_window_end + length) % priv->seek_window_capacity;
+	priv->seek_window_length = MIN (priv->seek_window_length + length, priv->seek_window_capacity);
+}
+
+/* Copies up to @count bytes which have been seeked back over out of the seek window, returning the number copied */
+static gsize
+seek_window_replay (GDataDownloadStreamPrivate *priv, guint8 *buffer, gsize count)
+{
+	gsize length, position, first_length;
+
+	g_assert (priv->seek_window_replay <= priv->seek_window_length);
+
+	length = MIN (count, priv->seek_window_replay);
+	position = (priv->seek_window_end + priv->seek_window_capacity - priv->seek_window_replay) % priv->seek_window_capacity;
+
+	first_length = MIN (length, priv->seek_window_capacity - position);
+	memcpy (buffer, priv->seek_window + position, first_length);
+	memcpy (buffer + first_length, priv->seek_window, length - first_length);
+
+	priv->seek_window_replay -= length;
+
+	return length;
+}
+
+/* Copies up to @count bytes from ->offset onwards out of ->stored_blob, returning the number copied */
+static gsize
+read_stored_blob (GDataDownloadStreamPrivate *priv, guint8 *buffer, gsize count, gboolean *reached_eof)
+{
+	const guint8 *data;
+	gsize size, length;
+
+	data = g_bytes_get_data (priv->stored_blob, &size);
+	length = (priv->offset < (goffset) size) ? MIN (count, size - priv->offset) : 0;
+	memcpy (buffer, data + priv->offset, length);
+
+	*reached_eof = (length == 0) ? TRUE : FALSE;
+
+	return length;
+}
+
 static gssize
 gdata_download_stream_read (GInputStream *stream, void *buffer, gsize count, GCancellable *cancellable, GError **error)
 {
@@ -513,30 +801,49 @@ gdata_download_stream_read (GInputStream *stream, void *buffer, gsize count, GCa
 		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) read_cancelled_cb, child_cancellable, NULL);
 
 	/* We're lazy about starting the network operation so we don't end up with a massive buffer */
-	if (priv->network_thread == NULL) {
-		/* Handle early cancellation so that we don't create the network thread unnecessarily */
+	if (priv->network_started == FALSE) {
+		/* Handle early cancellation so that we don't start the request unnecessarily */
 		if (g_cancellable_set_error_if_cancelled (child_cancellable, &child_error) == TRUE) {
 			length_read = -1;
 			goto done;
 		}
 
-		/* Create the network thread */
-		create_network_thread (GDATA_DOWNLOAD_STREAM (stream), &child_error);
-		if (priv->network_thread == NULL) {
+		/* Start the request */
+		if (start_network (GDATA_DOWNLOAD_STREAM (stream), &child_error) == FALSE) {
 			length_read = -1;
 			goto done;
 		}
 	}
 
+	/* If the copy of the file in the blob store is current, all of it is read from there */
+	if (priv->reading_stored_blob == TRUE) {
+		length_read = (gssize) read_stored_blob (priv, buffer, count, &reached_eof);
+		goto done;
+	}
+
+	/* If we've seeked backwards into the seek window, return data from there until we're back at the front of the buffer */
+	if (priv->seek_window_replay > 0) {
+		length_read = (gssize) seek_window_replay (priv, buffer, count);
+		goto done;
+	}
+
 	/* Read the data off the buffer. If the operation is cancelled, it'll probably still return a positive number of bytes read — if it does, we
 	 * can return without error. Iff it returns a non-positive number of bytes should we return an error. */
 	g_assert (priv->buffer != NULL);
 	length_read = (gssize) gdata_buffer_pop_data (priv->buffer, buffer, count, &reached_eof, child_cancellable);
+	buffer_drained (GDATA_DOWNLOAD_STREAM (stream), length_read);
 
 	if (length_read < 1 && g_cancellable_set_error_if_cancelled (child_cancellable, &child_error) == TRUE) {
 		/* Handle cancellation */
 		length_read = -1;
 
+		goto done;
+	} else if (priv->message->status_code == SOUP_STATUS_NOT_MODIFIED && priv->stored_blob != NULL) {
+		/* The file hasn't changed since it was stored, so nothing was downloaded; read it from the blob store from now on */
+		g_assert (length_read == 0);
+		priv->reading_stored_blob = TRUE;
+		length_read = (gssize) read_stored_blob (priv, buffer, count, &reached_eof);
+
 		goto done;
 	} else if (SOUP_STATUS_IS_SUCCESSFUL (priv->message->status_code) == FALSE) {
 		GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (priv->service);
@@ -550,6 +857,10 @@ gdata_download_stream_read (GInputStream *stream, void *buffer, gsize count, GCa
 		goto done;
 	}
 
+	/* Remember what we've read in case of a backward seek */
+	if (length_read > 0 && priv->seek_window != NULL)
+		seek_window_append (priv, buffer, length_read);
+
 done:
 	/* Disconnect from the cancelled signals. */
 	if (cancelled_signal != 0)
@@ -594,7 +905,7 @@ close_cancelled_cb (GCancellable *cancellable, CancelledData *data)
  * GIO methods (notably g_output_stream_splice()) can call gdata_download_stream_close() directly. Consequently, we need to be careful to be idempotent
  * after the first call.
  *
- * If the network thread hasn't yet been started (i.e. gdata_download_stream_read() hasn't been called at all yet), %TRUE will be returned immediately.
+ * If the request hasn't yet been started (i.e. gdata_download_stream_read() hasn't been called at all yet), %TRUE will be returned immediately.
  *
  * If the global cancellable, ->cancellable, or @cancellable are cancelled before the call to gdata_download_stream_close(),
  * gdata_download_stream_close() should return immediately with %G_IO_ERROR_CANCELLED. If they're cancelled during the call,
@@ -614,7 +925,7 @@ gdata_download_stream_close (GInputStream *stream, GCancellable *cancellable, GE
 	GError *child_error = NULL;
 
 	/* If the operation was never started, return successfully immediately */
-	if (priv->network_thread == NULL) {
+	if (priv->network_started == FALSE) {
 		goto done;
 	}
 
@@ -629,7 +940,7 @@ gdata_download_stream_close (GInputStream *stream, GCancellable *cancellable, GE
 
 	g_mutex_lock (&(priv->finished_mutex));
 
-	/* If the operation has started but hasn't already finished, cancel the network thread and wait for it to finish before returning */
+	/* If the operation has started but hasn't already finished, cancel the request and wait for it to finish before returning */
 	if (priv->finished == FALSE) {
 		g_cancellable_cancel (priv->network_cancellable);
 
@@ -663,7 +974,7 @@ done:
 	g_mutex_lock (&(priv->finished_mutex));
 
 	if (success == TRUE && priv->finished == TRUE) {
-		reset_network_thread (GDATA_DOWNLOAD_STREAM (stream));
+		reset_network (GDATA_DOWNLOAD_STREAM (stream));
 	}
 
 	g_mutex_unlock (&(priv->finished_mutex));
@@ -692,6 +1003,8 @@ static gboolean
 gdata_download_stream_seek (GSeekable *seekable, goffset offset, GSeekType type, GCancellable *cancellable, GError **error)
 {
 	GDataDownloadStreamPrivate *priv = GDATA_DOWNLOAD_STREAM (seekable)->priv;
+	goffset buffer_offset;
+	gboolean finished;
 	GError *child_error = NULL;
 
 	if (type == G_SEEK_END && priv->content_length == -1) {
@@ -720,33 +1033,62 @@ gdata_download_stream_seek (GSeekable *seekable, goffset offset, GSeekType type,
 			g_assert_not_reached ();
 	}
 
-	/* There are three cases to consider:
-	 *  1. The network thread hasn't been started. In this case, we need to set the offset and do nothing. When the network thread is started
+	/* There are four cases to consider:
+	 *  1. The request hasn't been started. In this case, we need to set the offset and do nothing. When the request is started
 	 *     (in the next read() call), a Range header will be set on it which will give the correct seek.
-	 *  2. The network thread has been started and the seek is to a position greater than our current position (i.e. one which already does, or
-	 *     will soon, exist in the buffer). In this case, we need to pop the intervening bytes off the buffer (which may block) and update the
-	 *     offset.
-	 *  3. The network thread has been started and the seek is to a position which has already been popped off the buffer. In this case, we need
-	 *     to set the offset and cancel the network thread. When the network thread is restarted (in the next read() call), a Range header will
-	 *     be set on it which will give the correct seek.
+	 *  2. The request has been started and the seek is to a position in the seek window (i.e. one which has been read recently, but
+	 *     possibly seeked back over since). In this case, we just need to adjust how much of the seek window will be replayed by read().
+	 *  3. The request has been started and the seek is to a position greater than the front of the buffer, but no further ahead of it
+	 *     than ->seek_threshold (or the download has finished, so the position already exists in the buffer). In this case, we need to pop the
+	 *     intervening bytes off the buffer (which may block) and update the offset.
+	 *  4. The request has been started and the seek is to a position which has already been popped off the buffer and has dropped out of
+	 *     the seek window, or to a position too far ahead to be worth draining. In this case, we need to set the offset and cancel the
+	 *     request. When the request is restarted (in the next read() call), a Range header will be set on it which will give the correct
+	 *     seek.
 	 */
 
-	if (priv->network_thread == NULL) {
+	if (priv->network_started == FALSE) {
 		/* Case 1. Set the offset and we're done. */
 		priv->offset = offset;
 
 		goto done;
 	}
 
-	/* Cases 2 and 3. The network thread has already been started. */
-	if (offset >= priv->offset) {
+	if (priv->reading_stored_blob == TRUE) {
+		/* The file is being read from the blob store rather than the network, so it can all be seeked around freely */
+		priv->offset = offset;
+
+		goto done;
+	}
+
+	/* Cases 2, 3 and 4. The request has already been started. Work out the offset of the front of the buffer, and whether it's
+	 * all been downloaded. */
+	buffer_offset = priv->offset + priv->seek_window_replay;
+
+	g_mutex_lock (&(priv->finished_mutex));
+	finished = priv->finished;
+	g_mutex_unlock (&(priv->finished_mutex));
+
+	if (offset <= buffer_offset && buffer_offset - offset <= (goffset) priv->seek_window_length) {
+		/* Case 2. Replay the seek window from the new offset. */
+		priv->seek_window_replay = buffer_offset - offset;
+		priv->offset = offset;
+
+		goto done;
+	} else if (offset > buffer_offset && (offset - buffer_offset <= (goffset) priv->seek_threshold || finished == TRUE)) {
 		goffset num_intervening_bytes;
 		gssize length_read;
 
-		/* Case 2. Pop off the intervening bytes and update the offset. If we can't pop enough bytes off, we throw an error. */
-		num_intervening_bytes = offset - priv->offset;
+		/* Case 3. Pop off the intervening bytes and update the offset. If we can't pop enough bytes off, we throw an error. The bytes
+		 * aren't added to the seek window, so it's no longer contiguous with the stream position and has to be emptied. */
+		num_intervening_bytes = offset - buffer_offset;
+		priv->offset = buffer_offset;
+		priv->seek_window_length = 0;
+		priv->seek_window_replay = 0;
+
 		g_assert (priv->buffer != NULL);
 		length_read = (gssize) gdata_buffer_pop_data (priv->buffer, NULL, num_intervening_bytes, NULL, cancellable);
+		buffer_drained (GDATA_DOWNLOAD_STREAM (seekable), length_read);
 
 		if (length_read != num_intervening_bytes) {
 			if (g_cancellable_set_error_if_cancelled (cancellable, &child_error) == FALSE) {
@@ -762,8 +1104,8 @@ gdata_download_stream_seek (GSeekable *seekable, goffset offset, GSeekType type,
 
 		goto done;
 	} else {
-		/* Case 3. Cancel the current network thread. Note that we don't allow cancellation of this call, as we depend on it waiting for
-		 * the network thread to join. */
+		/* Case 4. Cancel the current request. Note that we don't allow cancellation of this call, as we depend on it waiting for
+		 * the request to finish. */
 		if (gdata_download_stream_close (G_INPUT_STREAM (seekable), NULL, &child_error) == FALSE) {
 			goto done;
 		}
@@ -771,7 +1113,7 @@ gdata_download_stream_seek (GSeekable *seekable, goffset offset, GSeekType type,
 		/* Update the offset */
 		priv->offset = offset;
 
-		/* Mark the thread as unfinished */
+		/* Mark the download as unfinished */
 		g_mutex_lock (&(priv->finished_mutex));
 		priv->finished = FALSE;
 		g_mutex_unlock (&(priv->finished_mutex));
@@ -803,17 +1145,84 @@ gdata_download_stream_truncate (GSeekable *seekable, goffset offset, GCancellabl
 	return FALSE;
 }
 
+/* Returns the validator to send in an If-Range header when resuming the download, or %NULL if the download can't be resumed safely. Weak ETags
+ * can't be used with If-Range. */
+static const gchar *
+get_resume_validator (GDataDownloadStreamPrivate *priv)
+{
+	if (priv->etag != NULL && g_str_has_prefix (priv->etag, "W/") == FALSE)
+		return priv->etag;
+
+	return priv->last_modified;
+}
+
+/* Checks that the response to a resumed request is for the same version of the file as the original response */
+static gboolean
+validators_match (GDataDownloadStreamPrivate *priv, SoupMessage *message)
+{
+	if (priv->etag != NULL && g_str_has_prefix (priv->etag, "W/") == FALSE)
+		return (g_strcmp0 (soup_message_headers_get_one (message->response_headers, "ETag"), priv->etag) == 0) ? TRUE : FALSE;
+
+	g_assert (priv->last_modified != NULL);
+	return (g_strcmp0 (soup_message_headers_get_one (message->response_headers, "Last-Modified"), priv->last_modified) == 0) ? TRUE : FALSE;
+}
+
 static void
 got_headers_cb (SoupMessage *message, GDataDownloadStream *self)
 {
+	GDataDownloadStreamPrivate *priv = self->priv;
+	const gchar *content_type;
+	gssize content_length;
+
+	/* If the copy of the file in the blob store is still current, it'll be read from there, so take its Content-Type and -Length */
+	if (message == priv->message && message->status_code == SOUP_STATUS_NOT_MODIFIED && priv->stored_blob != NULL) {
+		_gdata_blob_store_record_lookup (priv->blob_store, TRUE);
+
+		content_type = priv->stored_content_type;
+		content_length = g_bytes_get_size (priv->stored_blob);
+
+		goto notify;
+	}
+
 	/* Don't get the client's hopes up by setting the Content-Type or -Length if the response
 	 * is actually unsuccessful. */
 	if (SOUP_STATUS_IS_SUCCESSFUL (message->status_code) == FALSE)
 		return;
 
+	/* If we're resuming an interrupted download, we already have the Content-Type and -Length, and just need to check that we're getting
+	 * the rest of the same version of the file. If it's changed, the server ignores our If-Range header and returns the whole of the new
+	 * version with a 200 status. Either way, stop the request before any of the data gets into the buffer. */
+	if (priv->resuming == TRUE) {
+		if (message->status_code != SOUP_STATUS_PARTIAL_CONTENT || validators_match (priv, message) == FALSE)
+			soup_session_cancel_message (priv->session, message, SOUP_STATUS_PRECONDITION_FAILED);
+
+		return;
+	}
+
+	/* Remember the validators so we can resume the download safely if it gets interrupted */
+	g_free (priv->etag);
+	priv->etag = g_strdup (soup_message_headers_get_one (message->response_headers, "ETag"));
+
+	g_free (priv->last_modified);
+	priv->last_modified = g_strdup (soup_message_headers_get_one (message->response_headers, "Last-Modified"));
+
+	/* Write the whole file through to the blob store as it's received. Failing to store it isn't fatal to the download. */
+	if (priv->blob_store != NULL && message == priv->message && message->status_code == SOUP_STATUS_OK) {
+		if (priv->stored_blob != NULL)
+			_gdata_blob_store_record_lookup (priv->blob_store, FALSE);
+
+		g_assert (priv->blob_writer == NULL);
+		priv->blob_writer = _gdata_blob_store_begin_write (priv->blob_store, NULL);
+	}
+
+	content_type = soup_message_headers_get_content_type (message->response_headers, NULL);
+	content_length = soup_message_headers_get_content_length (message->response_headers);
+
+notify:
 	g_mutex_lock (&(self->priv->content_mutex));
-	self->priv->content_type = g_strdup (soup_message_headers_get_content_type (message->response_headers, NULL));
-	self->priv->content_length = soup_message_headers_get_content_length (message->response_headers);
+	g_free (self->priv->content_type);
+	self->priv->content_type = g_strdup (content_type);
+	self->priv->content_length = content_length;
 	g_mutex_unlock (&(self->priv->content_mutex));
 
 	/* Emit the notifications for the Content-Length and -Type properties */
@@ -823,136 +1232,792 @@ got_headers_cb (SoupMessage *message, GDataDownloadStream *self)
 	g_object_thaw_notify (G_OBJECT (self));
 }
 
+/* In a blocking download's thread, block after receiving @length bytes until the stream's and the service's bandwidth limits allow more to be received.
+ * Not reading from the socket in the meantime lets TCP flow control slow the server down. */
 static void
-got_chunk_cb (SoupMessage *message, SoupBuffer *buffer, GDataDownloadStream *self)
+throttle_read (GDataDownloadStream *self, gsize length, GCancellable *cancellable)
 {
-	/* Ignore the chunk if the response is unsuccessful or it has zero length */
-	if (SOUP_STATUS_IS_SUCCESSFUL (message->status_code) == FALSE || buffer->length == 0)
+	gdata_bandwidth_limiter_throttle (self->priv->bandwidth_limiter, _gdata_service_get_download_bandwidth_limiter (self->priv->service), length,
+	                                  cancellable);
+}
+
+/* The network activity of a stream. All of this runs in the service's I/O thread, apart from start_network(), reset_network() and buffer_drained(),
+ * which are called by the reader. A reference to the stream is held from start_network() until finish_network(). */
+
+/* In the I/O thread, pause or unpause the request according to whether it's waiting for the bandwidth limits or for space in ->buffer. Only a
+ * request which is in progress is ever paused, and a paused request can only finish by being cancelled, so this never touches a request which
+ * isn't queued on the session. (We can still be waiting for space between a request finishing and being resumed, if some of the data it received
+ * hasn't been pushed yet.) */
+static void
+update_message_paused (GDataDownloadStream *self)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+	gboolean pause;
+
+	if (priv->message_queued == FALSE)
 		return;
 
-	/* Push the data onto the buffer immediately */
-	g_assert (self->priv->buffer != NULL);
-	gdata_buffer_push_data (self->priv->buffer, (const guint8*) buffer->data, buffer->length);
+	pause = (priv->throttle_source != NULL || g_atomic_int_get (&(priv->waiting_for_space)) == TRUE) ? TRUE : FALSE;
+
+	if (pause == TRUE && priv->message_paused == FALSE) {
+		soup_session_pause_message (priv->session, priv->message);
+		priv->message_paused = TRUE;
+	} else if (pause == FALSE && priv->message_paused == TRUE) {
+		soup_session_unpause_message (priv->session, priv->message);
+		priv->message_paused = FALSE;
+	}
 }
 
-static gpointer
-download_thread (GDataDownloadStream *self)
+/* The number of bytes ->buffer may hold before the request is paused, and the number it must drain to before the request is unpaused again */
+static gint
+get_high_water_mark (GDataDownloadStreamPrivate *priv)
+{
+	return (gint) MIN (priv->buffer_limit, G_MAXINT / 2);
+}
+
+static gint
+get_low_water_mark (GDataDownloadStreamPrivate *priv)
+{
+	return get_high_water_mark (priv) / 2;
+}
+
+static gboolean
+throttle_cb (GDataDownloadStream *self)
 {
 	GDataDownloadStreamPrivate *priv = self->priv;
 
-	g_object_ref (self);
+	g_source_unref (priv->throttle_source);
+	priv->throttle_source = NULL;
 
-	g_assert (priv->network_cancellable != NULL);
+	update_message_paused (self);
 
-	/* Connect to the got-headers signal so we can notify clients of the values of content-type and content-length */
-	g_signal_connect (priv->message, "got-headers", (GCallback) got_headers_cb, self);
-	g_signal_connect (priv->message, "got-chunk", (GCallback) got_chunk_cb, self);
+	return FALSE;
+}
 
-	/* Set a Range header if our starting offset is non-zero */
-	if (priv->offset > 0) {
-		soup_message_headers_set_range (priv->message->request_headers, priv->offset, -1);
+/* Push as much of ->overflow onto ->buffer as will fit without blocking */
+static void
+push_overflow (GDataDownloadStreamPrivate *priv)
+{
+	gsize length;
+
+	if (priv->overflow == NULL)
+		return;
+
+	length = gdata_buffer_push_data_nonblocking (priv->buffer, priv->overflow->data, priv->overflow->len);
+
+	if (priv->buffer_limit > 0)
+		g_atomic_int_add (&(priv->buffered_length), (gint) length);
+
+	if (length == priv->overflow->len) {
+		g_byte_array_unref (priv->overflow);
+		priv->overflow = NULL;
 	} else {
-		soup_message_headers_remove (priv->message->request_headers, "Range");
+		g_byte_array_remove_range (priv->overflow, 0, length);
+	}
+}
+
+/* In the I/O thread, push whatever's in ->overflow onto ->buffer, then work out whether the request has to wait for the reader to drain ->buffer
+ * before it can receive any more */
+static void
+update_waiting_for_space (GDataDownloadStream *self)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+
+	while (TRUE) {
+		push_overflow (priv);
+
+		if (priv->overflow == NULL && (priv->buffer_limit == 0 || g_atomic_int_get (&(priv->buffered_length)) <= get_high_water_mark (priv))) {
+			g_atomic_int_set (&(priv->waiting_for_space), FALSE);
+			return;
+		}
+
+		g_atomic_int_set (&(priv->waiting_for_space), TRUE);
+
+		/* The reader only wakes us if it sees the flag after draining the buffer, so check whether it's already drained it. If so, there's
+		 * now space for at least half of the ring, so we can go round again. */
+		if (g_atomic_int_get (&(priv->buffered_length)) > get_low_water_mark (priv))
+			return;
 	}
+}
 
-	_gdata_service_actually_send_message (priv->session, priv->message, priv->network_cancellable, NULL);
+static void finish_network (GDataDownloadStream *self);
+static gboolean resume_cancelled_cb (GCancellable *cancellable, GDataDownloadStream *self);
 
-	/* Mark the buffer as having reached EOF */
-	g_assert (priv->buffer != NULL);
-	gdata_buffer_push_data (priv->buffer, NULL, 0);
+static gboolean
+space_available_cb (GDataDownloadStream *self)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
 
-	/* Mark the download as finished */
-	g_mutex_lock (&(priv->finished_mutex));
-	priv->finished = TRUE;
-	g_cond_signal (&(priv->finished_cond));
-	g_mutex_unlock (&(priv->finished_mutex));
+	g_atomic_int_set (&(priv->space_available_pending), FALSE);
 
-	g_object_unref (self);
+	update_waiting_for_space (self);
 
-	return NULL;
+	/* If the request finished while data was still waiting to be pushed, the EOF can only be pushed once all of it has been */
+	if (priv->finish_pending == TRUE) {
+		if (priv->overflow == NULL)
+			finish_network (self);
+	} else {
+		update_message_paused (self);
+	}
+
+	return FALSE;
 }
 
+/* Called by the reader after it's popped @length bytes off ->buffer, to unpause the request if it was waiting for the buffer to drain */
 static void
-create_network_thread (GDataDownloadStream *self, GError **error)
+buffer_drained (GDataDownloadStream *self, gsize length)
 {
 	GDataDownloadStreamPrivate *priv = self->priv;
+	gint buffered_length;
 
-	g_assert (priv->buffer == NULL);
-	priv->buffer = gdata_buffer_new ();
+	if (priv->buffer_limit == 0 || length == 0)
+		return;
+
+	buffered_length = g_atomic_int_add (&(priv->buffered_length), -((gint) length)) - (gint) length;
 
-	g_assert (priv->network_thread == NULL);
-	priv->network_thread = g_thread_try_new ("download-thread", (GThreadFunc) download_thread, self, error);
+	if (buffered_length <= get_low_water_mark (priv) && g_atomic_int_get (&(priv->waiting_for_space)) == TRUE &&
+	    g_atomic_int_compare_and_exchange (&(priv->space_available_pending), FALSE, TRUE) == TRUE) {
+		gdata_io_loop_invoke (priv->io_loop, (GSourceFunc) space_available_cb, g_object_ref (self), g_object_unref);
+	}
 }
 
 static void
-reset_network_thread (GDataDownloadStream *self)
+got_chunk_cb (SoupMessage *message, SoupBuffer *buffer, GDataDownloadStream *self)
 {
 	GDataDownloadStreamPrivate *priv = self->priv;
+	gint64 start_time = 0;
 
-	priv->network_thread = NULL;
+	/* Ignore the chunk if the response is unsuccessful or it has zero length */
+	if (SOUP_STATUS_IS_SUCCESSFUL (message->status_code) == FALSE || buffer->length == 0)
+		return;
 
-	if (priv->buffer != NULL) {
-		gdata_buffer_free (priv->buffer);
-		priv->buffer = NULL;
+	/* Push the data onto the buffer immediately, or as much of it as fits if the buffer's a ring. This never blocks; instead, the rest is held
+	 * in ->overflow, and if the buffer's now full, the request is paused until the reader catches up, which stops us reading from the network in
+	 * the meantime. Data already in ->overflow has to go first. */
+	g_assert (priv->buffer != NULL);
+
+	if (priv->overflow == NULL) {
+		gsize length = gdata_buffer_push_data_nonblocking (priv->buffer, (const guint8*) buffer->data, buffer->length);
+
+		if (priv->buffer_limit > 0)
+			g_atomic_int_add (&(priv->buffered_length), (gint) length);
+
+		if (length < buffer->length) {
+			priv->overflow = g_byte_array_sized_new (buffer->length - length);
+			g_byte_array_append (priv->overflow, (const guint8*) buffer->data + length, buffer->length - length);
+		}
+	} else {
+		g_byte_array_append (priv->overflow, (const guint8*) buffer->data, buffer->length);
 	}
 
-	if (priv->message != NULL) {
-		soup_session_cancel_message (priv->session, priv->message, SOUP_STATUS_CANCELLED);
+	update_waiting_for_space (self);
+	priv->network_offset += buffer->length;
+
+	/* This blocks on disk I/O, but the writes normally only go as far as the page cache, so are quick compared to waiting on the network */
+	if (priv->blob_writer != NULL && _gdata_blob_writer_write (priv->blob_writer, buffer->data, buffer->length, NULL) == FALSE) {
+		_gdata_blob_writer_abort (priv->blob_writer);
+		priv->blob_writer = NULL;
 	}
 
-	priv->offset = 0;
+	/* Wait until the stream's and the service's bandwidth limits allow more to be received, as throttle_read() does, but without blocking */
+	if (buffer->length > 0) {
+		GDataBandwidthLimiter *service_limiter = _gdata_service_get_download_bandwidth_limiter (priv->service);
 
-	if (priv->network_cancellable != NULL) {
-		g_cancellable_reset (priv->network_cancellable);
+		start_time = gdata_bandwidth_limiter_reserve (priv->bandwidth_limiter, buffer->length);
+		if (service_limiter != NULL)
+			start_time = MAX (start_time, gdata_bandwidth_limiter_reserve (service_limiter, buffer->length));
 	}
+
+	if (start_time > g_get_monotonic_time () && priv->throttle_source == NULL)
+		priv->throttle_source = gdata_io_loop_add_timeout (priv->io_loop, start_time, (GSourceFunc) throttle_cb, self, NULL);
+
+	update_message_paused (self);
 }
 
-/**
- * gdata_download_stream_new:
- * @service: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain to authorize the download, or %NULL
- * @download_uri: the URI to download
- * @cancellable: (allow-none): a #GCancellable for the entire download stream, or %NULL
- *
- * Creates a new #GDataDownloadStream, allowing a file to be downloaded from a GData service using standard #GInputStream API.
- *
- * As well as the standard GIO errors, calls to the #GInputStream API on a #GDataDownloadStream can also return any relevant specific error from
- * #GDataServiceError, or %GDATA_SERVICE_ERROR_PROTOCOL_ERROR in the general case.
- *
- * If a #GCancellable is provided in @cancellable, the download operation may be cancelled at any time from another thread using g_cancellable_cancel().
- * In this case, any ongoing network activity will be stopped, and any pending or future calls to #GInputStream API on the #GDataDownloadStream will
- * return %G_IO_ERROR_CANCELLED. Note that the #GCancellable objects which can be passed to individual #GInputStream operations will not cancel the
- * download operation proper if cancelled — they will merely cancel that API call. The only way to cancel the download operation completely is using
- * this @cancellable.
- *
- * Return value: a new #GInputStream, or %NULL; unref with g_object_unref()
- *
- * Since: 0.9.0
- **/
-GInputStream *
-gdata_download_stream_new (GDataService *service, GDataAuthorizationDomain *domain, const gchar *download_uri, GCancellable *cancellable)
+static void send_request (GDataDownloadStream *self);
+
+static void
+clear_resume_sources (GDataDownloadStreamPrivate *priv)
 {
-	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
-	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
-	g_return_val_if_fail (download_uri != NULL, NULL);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	if (priv->resume_source != NULL) {
+		g_source_destroy (priv->resume_source);
+		g_source_unref (priv->resume_source);
+		priv->resume_source = NULL;
+	}
 
-	return G_INPUT_STREAM (g_object_new (GDATA_TYPE_DOWNLOAD_STREAM,
-	                                     "download-uri", download_uri,
-	                                     "service", service,
-	                                     "authorization-domain", domain,
-	                                     "cancellable", cancellable,
-	                                     NULL));
+	if (priv->resume_cancel_source != NULL) {
+		g_source_destroy (priv->resume_cancel_source);
+		g_source_unref (priv->resume_cancel_source);
+		priv->resume_cancel_source = NULL;
+	}
 }
 
-/**
- * gdata_download_stream_get_service:
- * @self: a #GDataDownloadStream
- *
- * Gets the service used to authorize the download, as passed to gdata_download_stream_new().
- *
- * Return value: (transfer none): the #GDataService used to authorize the download
- *
+/* Marks the download as finished, once no more requests are to be made */
+static void
+finish_network (GDataDownloadStream *self)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+
+	clear_resume_sources (priv);
+
+	/* If some of the data couldn't be pushed yet, wait for the reader to make space for it before pushing the EOF, unless the stream's being
+	 * closed, in which case nobody will read it. space_available_cb() calls us again once it's been pushed. */
+	if (priv->overflow != NULL) {
+		if (g_cancellable_is_cancelled (priv->network_cancellable) == FALSE) {
+			priv->finish_pending = TRUE;
+
+			priv->resume_cancel_source = g_cancellable_source_new (priv->network_cancellable);
+			g_source_set_callback (priv->resume_cancel_source, (GSourceFunc) resume_cancelled_cb, self, NULL);
+			g_source_attach (priv->resume_cancel_source, gdata_io_loop_get_context (priv->io_loop));
+
+			return;
+		}
+
+		g_byte_array_unref (priv->overflow);
+		priv->overflow = NULL;
+	}
+
+	priv->finish_pending = FALSE;
+
+	g_signal_handler_disconnect (priv->message, priv->chunk_signal);
+	g_signal_handler_disconnect (priv->message, priv->headers_signal);
+	priv->chunk_signal = 0;
+	priv->headers_signal = 0;
+
+	/* Store the file if all of it was downloaded; a response which was cut short would have a transport error status, or if it was resumed, the
+	 * status of the last attempt at resuming it */
+	if (priv->blob_writer != NULL) {
+		if (SOUP_STATUS_IS_SUCCESSFUL (priv->message->status_code) == TRUE) {
+			gchar *content_type, *hash;
+
+			g_mutex_lock (&(priv->content_mutex));
+			content_type = g_strdup (priv->content_type);
+			g_mutex_unlock (&(priv->content_mutex));
+
+			hash = _gdata_blob_writer_commit (priv->blob_writer, priv->download_uri, priv->etag, content_type, NULL);
+
+			g_free (hash);
+			g_free (content_type);
+		} else {
+			_gdata_blob_writer_abort (priv->blob_writer);
+		}
+
+		priv->blob_writer = NULL;
+	}
+
+	/* Mark the buffer as having reached EOF */
+	g_assert (priv->buffer != NULL);
+	gdata_buffer_push_data (priv->buffer, NULL, 0);
+
+	/* Mark the download as finished */
+	g_mutex_lock (&(priv->finished_mutex));
+	priv->finished = TRUE;
+	g_cond_signal (&(priv->finished_cond));
+	g_mutex_unlock (&(priv->finished_mutex));
+
+	/* Reference held since start_network() */
+	g_object_unref (self);
+}
+
+static gboolean
+resume_cb (GDataDownloadStream *self)
+{
+	clear_resume_sources (self->priv);
+
+	self->priv->resume_attempt++;
+	self->priv->resuming = TRUE;
+	send_request (self);
+
+	return FALSE;
+}
+
+static gboolean
+resume_cancelled_cb (GCancellable *cancellable, GDataDownloadStream *self)
+{
+	finish_network (self);
+
+	return FALSE;
+}
+
+/* Decides whether the request which has just finished should be resumed, and if so, schedules the next attempt after the backoff delay for it.
+ * Returns %FALSE if the download shouldn't (or can't) be resumed. */
+static gboolean
+schedule_resume (GDataDownloadStream *self)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+	gint64 ready_time;
+
+	/* Only resume after transport errors which weren't caused by cancellation, and only if we can check that we're resuming the same version
+	 * of the file */
+	if (g_atomic_int_get (&(priv->auto_resume)) == FALSE || priv->resume_attempt >= MAX_RESUME_ATTEMPTS ||
+	    SOUP_STATUS_IS_TRANSPORT_ERROR (priv->message->status_code) == FALSE || priv->message->status_code == SOUP_STATUS_CANCELLED ||
+	    g_cancellable_is_cancelled (priv->network_cancellable) == TRUE || get_resume_validator (priv) == NULL) {
+		return FALSE;
+	}
+
+	ready_time = g_get_monotonic_time () + MIN (INITIAL_RESUME_DELAY << priv->resume_attempt, MAX_RESUME_DELAY) * G_TIME_SPAN_SECOND;
+	priv->resume_source = gdata_io_loop_add_timeout (priv->io_loop, ready_time, (GSourceFunc) resume_cb, self, NULL);
+
+	/* Stop waiting if the stream's closed in the meantime */
+	priv->resume_cancel_source = g_cancellable_source_new (priv->network_cancellable);
+	g_source_set_callback (priv->resume_cancel_source, (GSourceFunc) resume_cancelled_cb, self, NULL);
+	g_source_attach (priv->resume_cancel_source, gdata_io_loop_get_context (priv->io_loop));
+
+	return TRUE;
+}
+
+static void
+message_finished_cb (SoupSession *session, SoupMessage *message, GDataDownloadStream *self)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+
+	/* A paused request can only have finished by being cancelled. Drop any pending waits, since they were for this request, apart from waiting for
+	 * space for data which has already been received. */
+	priv->message_queued = FALSE;
+	priv->message_paused = FALSE;
+	update_waiting_for_space (self);
+
+	if (priv->throttle_source != NULL) {
+		g_source_destroy (priv->throttle_source);
+		g_source_unref (priv->throttle_source);
+		priv->throttle_source = NULL;
+	}
+
+	/* Start backing off from scratch if the last attempt managed to download something */
+	if (priv->network_offset > priv->start_offset)
+		priv->resume_attempt = 0;
+
+	if (schedule_resume (self) == FALSE)
+		finish_network (self);
+}
+
+/* Sends the request for the rest of the file, from ->network_offset */
+static void
+send_request (GDataDownloadStream *self)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+
+	priv->start_offset = priv->network_offset;
+
+	if (g_cancellable_is_cancelled (priv->network_cancellable) == TRUE) {
+		soup_message_set_status (priv->message, SOUP_STATUS_CANCELLED);
+		finish_network (self);
+		return;
+	}
+
+	/* Set a Range header if our starting offset is non-zero */
+	if (priv->network_offset > 0) {
+		soup_message_headers_set_range (priv->message->request_headers, priv->network_offset, -1);
+	} else {
+		soup_message_headers_remove (priv->message->request_headers, "Range");
+	}
+
+	/* If resuming, only accept the rest of the file if it hasn't changed */
+	if (priv->resuming == TRUE) {
+		soup_message_headers_replace (priv->message->request_headers, "If-Range", get_resume_validator (priv));
+	} else {
+		soup_message_headers_remove (priv->message->request_headers, "If-Range");
+	}
+
+	/* If the blob store has a copy of the file, only download it again if it's changed */
+	if (priv->stored_blob != NULL && priv->resuming == FALSE) {
+		soup_message_headers_replace (priv->message->request_headers, "If-None-Match", priv->stored_etag);
+	} else {
+		soup_message_headers_remove (priv->message->request_headers, "If-None-Match");
+	}
+
+	/* The I/O loop's context is the thread-default context here, so the request is processed in the I/O thread */
+	priv->message_queued = TRUE;
+	_gdata_service_queue_message (priv->session, priv->message, priv->network_cancellable, (SoupSessionCallback) message_finished_cb, self);
+}
+
+static gboolean
+network_start_cb (GDataDownloadStream *self)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+
+	g_assert (priv->network_cancellable != NULL);
+
+	/* Connect to the got-headers signal so we can notify clients of the values of content-type and content-length */
+	priv->headers_signal = g_signal_connect (priv->message, "got-headers", (GCallback) got_headers_cb, self);
+	priv->chunk_signal = g_signal_connect (priv->message, "got-chunk", (GCallback) got_chunk_cb, self);
+
+	priv->network_offset = priv->offset;
+	priv->resume_attempt = 0;
+	priv->resuming = FALSE;
+
+	send_request (self);
+
+	return FALSE;
+}
+
+/* Starts downloading from ->offset into a new ->buffer, in the service's I/O loop */
+static gboolean
+start_network (GDataDownloadStream *self, GError **error)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+
+	g_assert (priv->network_started == FALSE);
+
+	priv->io_loop = _gdata_service_get_io_loop (priv->service, error);
+	if (priv->io_loop == NULL)
+		return FALSE;
+
+	/* A bounded buffer is a ring, since it has exactly one pushing thread (the I/O thread) and one popping thread (the reader). The I/O thread
+	 * mustn't block, so it only pushes as much as fits, and pauses the request until the reader has made space for the rest. Its size is fixed
+	 * here, so changes to ->max_buffer_size only take effect the next time the network is started. */
+	g_assert (priv->buffer == NULL);
+	priv->buffer_limit = priv->max_buffer_size;
+	priv->buffer = (priv->buffer_limit > 0) ? gdata_buffer_new_ring (priv->buffer_limit) : gdata_buffer_new ();
+	_gdata_service_count_buffer (priv->service, GDATA_OPERATION_DOWNLOAD, priv->buffer);
+	g_atomic_int_set (&(priv->buffered_length), 0);
+	g_atomic_int_set (&(priv->waiting_for_space), FALSE);
+	g_assert (priv->overflow == NULL);
+
+	g_assert (priv->seek_window == NULL);
+	if (priv->seek_window_size > 0) {
+		priv->seek_window = g_malloc (priv->seek_window_size);
+		priv->seek_window_capacity = priv->seek_window_size;
+	}
+
+	/* Downloads of whole files go through the blob store, if the service has one. A stored copy of the file can only be used if it can be
+	 * revalidated. */
+	if (priv->offset == 0)
+		priv->blob_store = _gdata_service_dup_blob_store (priv->service);
+
+	if (priv->blob_store != NULL) {
+		priv->stored_blob = _gdata_blob_store_lookup_uri_latest (priv->blob_store, priv->download_uri, &(priv->stored_etag),
+		                                                         &(priv->stored_content_type));
+
+		if (priv->stored_blob != NULL && priv->stored_etag == NULL) {
+			g_bytes_unref (priv->stored_blob);
+			priv->stored_blob = NULL;
+		}
+	}
+
+	priv->network_started = TRUE;
+
+	/* The reference is released by finish_network() */
+	gdata_io_loop_invoke (priv->io_loop, (GSourceFunc) network_start_cb, g_object_ref (self), NULL);
+
+	return TRUE;
+}
+
+/* Tidies up once the request has finished (or was never started), so that it can be started again from a new offset */
+static void
+reset_network (GDataDownloadStream *self)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+
+	priv->network_started = FALSE;
+
+	if (priv->buffer != NULL) {
+		gdata_buffer_free (priv->buffer);
+		priv->buffer = NULL;
+	}
+
+	g_free (priv->seek_window);
+	priv->seek_window = NULL;
+	priv->seek_window_capacity = 0;
+	priv->seek_window_length = 0;
+	priv->seek_window_end = 0;
+	priv->seek_window_replay = 0;
+
+	/* finish_network() has always dealt with ->blob_writer by now */
+	g_assert (priv->blob_writer == NULL);
+	priv->reading_stored_blob = FALSE;
+	g_clear_object (&(priv->blob_store));
+
+	if (priv->stored_blob != NULL)
+		g_bytes_unref (priv->stored_blob);
+	priv->stored_blob = NULL;
+
+	g_free (priv->stored_etag);
+	priv->stored_etag = NULL;
+	g_free (priv->stored_content_type);
+	priv->stored_content_type = NULL;
+
+	priv->offset = 0;
+
+	if (priv->network_cancellable != NULL) {
+		g_cancellable_reset (priv->network_cancellable);
+	}
+}
+
+
+
+/* Segments smaller than this aren't worth a request of their own */
+#define MIN_SEGMENT_SIZE (1024 * 1024) /* bytes = 1 MiB */
+
+typedef struct {
+	GDataDownloadStream *self;
+	GFile *destination;
+	GOutputStream *output; /* the stream being written to, or %NULL before it's opened */
+	goffset start;
+	goffset end; /* inclusive, or -1 to download until the end of the file */
+	goffset length_received;
+	guint expected_status;
+	GCancellable *cancellable; /* shared between all segments; cancelled as soon as any segment fails */
+	GError *error; /* set only in the segment's own thread */
+} SegmentData;
+
+static SoupMessage *
+build_segment_message (GDataDownloadStream *self, goffset start, goffset end)
+{
+	GDataDownloadStreamPrivate *priv = self->priv;
+	GDataServiceClass *klass;
+	SoupMessage *message;
+	SoupURI *_uri;
+
+	_uri = soup_uri_new (priv->download_uri);
+	soup_uri_set_port (_uri, _gdata_service_get_https_port ());
+	message = soup_message_new_from_uri (SOUP_METHOD_GET, _uri);
+	soup_uri_free (_uri);
+	_gdata_service_claim_message (priv->service, message);
+
+	klass = GDATA_SERVICE_GET_CLASS (priv->service);
+	if (klass->append_query_headers != NULL) {
+		klass->append_query_headers (priv->service, priv->authorization_domain, message);
+	}
+
+	/* Don't bother with a Range header if we want the whole file */
+	if (start > 0 || end >= 0)
+		soup_message_headers_set_range (message->request_headers, start, end);
+
+	/* The data is written out as it arrives, so there's no need to keep it around */
+	soup_message_body_set_accumulate (message->response_body, FALSE);
+
+	/* Ranges have to refer to the file itself, not a compressed encoding of it */
+	soup_message_disable_feature (message, SOUP_TYPE_CONTENT_DECODER);
+
+	return message;
+}
+
+static void
+segment_got_chunk_cb (SoupMessage *message, SoupBuffer *buffer, SegmentData *data)
+{
+	if (message->status_code != data->expected_status || buffer->length == 0 || data->error != NULL)
+		return;
+
+	/* Refuse to write outside the segment if the server sends more than we asked for */
+	if (data->end >= 0 && data->start + data->length_received + (goffset) buffer->length > data->end + 1) {
+		g_set_error_literal (&(data->error), GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+		                     _("The server returned more data than was requested."));
+		g_cancellable_cancel (data->cancellable);
+		return;
+	}
+
+	if (g_output_stream_write_all (data->output, buffer->data, buffer->length, NULL, data->cancellable, &(data->error)) == FALSE) {
+		g_cancellable_cancel (data->cancellable);
+		return;
+	}
+
+	data->length_received += buffer->length;
+
+	throttle_read (data->self, buffer->length, data->cancellable);
+}
+
+/* Sends @message and writes its body to @data->output, checking the response. On failure, @data->error is set and @data->cancellable is
+ * cancelled so that the other segments stop too. */
+static void
+download_segment (SegmentData *data, SoupMessage *message)
+{
+	GDataDownloadStreamPrivate *priv = data->self->priv;
+	GError *child_error = NULL;
+	gulong chunk_signal;
+
+	chunk_signal = g_signal_connect (message, "got-chunk", (GCallback) segment_got_chunk_cb, data);
+	_gdata_service_actually_send_message (priv->session, message, data->cancellable, &child_error);
+	g_signal_handler_disconnect (message, chunk_signal);
+
+	if (data->error != NULL) {
+		/* A write error (or similar) takes priority over the cancellation error it caused */
+		g_clear_error (&child_error);
+	} else if (child_error != NULL) {
+		g_propagate_error (&(data->error), child_error);
+	} else if (SOUP_STATUS_IS_SUCCESSFUL (message->status_code) == FALSE) {
+		GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (priv->service);
+
+		g_assert (klass->parse_error_response != NULL);
+		klass->parse_error_response (priv->service, GDATA_OPERATION_DOWNLOAD, message->status_code, message->reason_phrase,
+		                             NULL, 0, &(data->error));
+	} else if (message->status_code != data->expected_status) {
+		/* The server ignored our Range header after having honoured it for the first segment */
+		g_set_error_literal (&(data->error), GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+		                     _("The server did not return the requested part of the file."));
+	} else if (data->expected_status == SOUP_STATUS_PARTIAL_CONTENT) {
+		goffset start, end;
+
+		if (soup_message_headers_get_content_range (message->response_headers, &start, &end, NULL) == FALSE || start != data->start ||
+		    (data->end >= 0 && data->start + data->length_received != data->end + 1)) {
+			g_set_error_literal (&(data->error), GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+			                     _("The server did not return the requested part of the file."));
+		}
+	}
+
+	if (data->error != NULL)
+		g_cancellable_cancel (data->cancellable);
+}
+
+static void
+probe_got_headers_cb (SoupMessage *message, SegmentData *data)
+{
+	/* If the server doesn't support ranges, it returns the whole file, which we then write out in one go */
+	if (message->status_code == SOUP_STATUS_OK) {
+		data->expected_status = SOUP_STATUS_OK;
+		data->end = -1;
+	}
+}
+
+static gpointer
+segment_thread (SegmentData *data)
+{
+	GFileIOStream *io_stream;
+	SoupMessage *message;
+
+	/* Each segment gets its own file handle, so that they can seek independently */
+	io_stream = g_file_open_readwrite (data->destination, data->cancellable, &(data->error));
+	if (io_stream == NULL || g_seekable_seek (G_SEEKABLE (io_stream), data->start, G_SEEK_SET, data->cancellable, &(data->error)) == FALSE) {
+		if (io_stream != NULL)
+			g_object_unref (io_stream);
+		g_cancellable_cancel (data->cancellable);
+
+		return NULL;
+	}
+
+	data->output = g_io_stream_get_output_stream (G_IO_STREAM (io_stream));
+
+	message = build_segment_message (data->self, data->start, data->end);
+	download_segment (data, message);
+	g_object_unref (message);
+
+	/* Only report errors from closing the file if everything else succeeded */
+	if (g_io_stream_close (G_IO_STREAM (io_stream), NULL, (data->error == NULL) ? &(data->error) : NULL) == FALSE)
+		g_cancellable_cancel (data->cancellable);
+
+	g_object_unref (io_stream);
+	data->output = NULL;
+
+	return NULL;
+}
+
+typedef struct {
+	GDataDownloadStream *self;
+	gint fd; /* the file being written to, or -1 if writing to @output */
+	GOutputStream *output;
+	GCancellable *cancellable;
+	GError *error;
+} FileData;
+
+static void
+file_got_headers_cb (SoupMessage *message, FileData *data)
+{
+	if (SOUP_STATUS_IS_SUCCESSFUL (message->status_code) == FALSE)
+		return;
+
+	/* Update the Content-Type and -Length properties as if we were being read */
+	got_headers_cb (message, data->self);
+
+#ifdef HAVE_POSIX_FALLOCATE
+	/* Allocate the whole file in one go if we know how long it is. This avoids fragmenting it, and means we find out straight away if there
+	 * isn't enough disk space. Not all file systems support it, so other errors are ignored. */
+	if (data->fd >= 0 && soup_message_headers_get_encoding (message->response_headers) == SOUP_ENCODING_CONTENT_LENGTH) {
+		goffset content_length = soup_message_headers_get_content_length (message->response_headers);
+
+		if (content_length > 0 && posix_fallocate (data->fd, 0, content_length) == ENOSPC) {
+			g_set_error_literal (&(data->error), G_IO_ERROR, G_IO_ERROR_NO_SPACE, g_strerror (ENOSPC));
+			g_cancellable_cancel (data->cancellable);
+		}
+	}
+#endif /* HAVE_POSIX_FALLOCATE */
+}
+
+static void
+file_got_chunk_cb (SoupMessage *message, SoupBuffer *buffer, FileData *data)
+{
+	const gchar *chunk = buffer->data;
+	gsize length = buffer->length;
+
+	if (SOUP_STATUS_IS_SUCCESSFUL (message->status_code) == FALSE || length == 0 || data->error != NULL)
+		return;
+
+	throttle_read (data->self, length, data->cancellable);
+
+#ifdef G_OS_UNIX
+	/* Write the chunk straight out of libsoup's buffer */
+	if (data->fd >= 0) {
+		while (length > 0) {
+			gssize length_written = write (data->fd, chunk, length);
+
+			if (length_written < 0 && errno == EINTR) {
+				continue;
+			} else if (length_written < 0) {
+				gint errsv = errno;
+
+				g_set_error_literal (&(data->error), G_IO_ERROR, g_io_error_from_errno (errsv), g_strerror (errsv));
+				g_cancellable_cancel (data->cancellable);
+
+				return;
+			}
+
+			chunk += length_written;
+			length -= length_written;
+		}
+
+		return;
+	}
+#endif /* G_OS_UNIX */
+
+	if (g_output_stream_write_all (data->output, chunk, length, NULL, data->cancellable, &(data->error)) == FALSE)
+		g_cancellable_cancel (data->cancellable);
+}
+
+/**
+ * gdata_download_stream_new:
+ * @service: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain to authorize the download, or %NULL
+ * @download_uri: the URI to download
+ * @cancellable: (allow-none): a #GCancellable for the entire download stream, or %NULL
+ *
+ * Creates a new #GDataDownloadStream, allowing a file to be downloaded from a GData service using standard #GInputStream API.
+ *
+ * As well as the standard GIO errors, calls to the #GInputStream API on a #GDataDownloadStream can also return any relevant specific error from
+ * #GDataServiceError, or %GDATA_SERVICE_ERROR_PROTOCOL_ERROR in the general case.
+ *
+ * If a #GCancellable is provided in @cancellable, the download operation may be cancelled at any time from another thread using g_cancellable_cancel().
+ * In this case, any ongoing network activity will be stopped, and any pending or future calls to #GInputStream API on the #GDataDownloadStream will
+ * return %G_IO_ERROR_CANCELLED. Note that the #GCancellable objects which can be passed to individual #GInputStream operations will not cancel the
+ * download operation proper if cancelled — they will merely cancel that API call. The only way to cancel the download operation completely is using
+ * this @cancellable.
+ *
+ * Return value: a new #GInputStream, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.9.0
+ **/
+GInputStream *
+gdata_download_stream_new (GDataService *service, GDataAuthorizationDomain *domain, const gchar *download_uri, GCancellable *cancellable)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (download_uri != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+
+	return G_INPUT_STREAM (g_object_new (GDATA_TYPE_DOWNLOAD_STREAM,
+	                                     "download-uri", download_uri,
+	                                     "service", service,
+	                                     "authorization-domain", domain,
+	                                     "cancellable", cancellable,
+	                                     NULL));
+}
+
+/**
+ * gdata_download_stream_get_service:
+ * @self: a #GDataDownloadStream
+ *
+ * Gets the service used to authorize the download, as passed to gdata_download_stream_new().
+ *
+ * Return value: (transfer none): the #GDataService used to authorize the download
+ *
  * Since: 0.5.0
  **/
 GDataService *
@@ -1067,3 +2132,541 @@ gdata_download_stream_get_cancellable (GDataDownloadStream *self)
 	g_assert (self->priv->cancellable != NULL);
 	return self->priv->cancellable;
 }
+
+/**
+ * gdata_download_stream_get_max_buffer_size:
+ * @self: a #GDataDownloadStream
+ *
+ * Gets the #GDataDownloadStream:max-buffer-size property.
+ *
+ * Return value: the maximum number of bytes to buffer from the network, or <code class="literal">0</code> if the buffer is unbounded
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_download_stream_get_max_buffer_size (GDataDownloadStream *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOWNLOAD_STREAM (self), 0);
+	return self->priv->max_buffer_size;
+}
+
+/**
+ * gdata_download_stream_set_max_buffer_size:
+ * @self: a #GDataDownloadStream
+ * @max_buffer_size: the maximum number of bytes to buffer from the network, or <code class="literal">0</code> for no limit
+ *
+ * Sets the #GDataDownloadStream:max-buffer-size property. This takes effect the next time the network connection is started.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_download_stream_set_max_buffer_size (GDataDownloadStream *self, guint max_buffer_size)
+{
+	g_return_if_fail (GDATA_IS_DOWNLOAD_STREAM (self));
+
+	self->priv->max_buffer_size = max_buffer_size;
+
+	g_object_notify (G_OBJECT (self), "max-buffer-size");
+}
+
+/**
+ * gdata_download_stream_get_seek_threshold:
+ * @self: a #GDataDownloadStream
+ *
+ * Gets the #GDataDownloadStream:seek-threshold property.
+ *
+ * Return value: the furthest a forward seek can go without restarting the network connection, in bytes
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_download_stream_get_seek_threshold (GDataDownloadStream *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOWNLOAD_STREAM (self), 0);
+	return self->priv->seek_threshold;
+}
+
+/**
+ * gdata_download_stream_set_seek_threshold:
+ * @self: a #GDataDownloadStream
+ * @seek_threshold: the furthest a forward seek can go without restarting the network connection, in bytes
+ *
+ * Sets the #GDataDownloadStream:seek-threshold property.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_download_stream_set_seek_threshold (GDataDownloadStream *self, guint seek_threshold)
+{
+	g_return_if_fail (GDATA_IS_DOWNLOAD_STREAM (self));
+
+	self->priv->seek_threshold = seek_threshold;
+
+	g_object_notify (G_OBJECT (self), "seek-threshold");
+}
+
+/**
+ * gdata_download_stream_get_seek_window_size:
+ * @self: a #GDataDownloadStream
+ *
+ * Gets the #GDataDownloadStream:seek-window-size property.
+ *
+ * Return value: the number of recently read bytes kept for backward seeks, or <code class="literal">0</code> if none are kept
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_download_stream_get_seek_window_size (GDataDownloadStream *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOWNLOAD_STREAM (self), 0);
+	return self->priv->seek_window_size;
+}
+
+/**
+ * gdata_download_stream_set_seek_window_size:
+ * @self: a #GDataDownloadStream
+ * @seek_window_size: the number of recently read bytes to keep for backward seeks, or <code class="literal">0</code> to keep none
+ *
+ * Sets the #GDataDownloadStream:seek-window-size property. This takes effect the next time the network connection is started.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_download_stream_set_seek_window_size (GDataDownloadStream *self, guint seek_window_size)
+{
+	g_return_if_fail (GDATA_IS_DOWNLOAD_STREAM (self));
+
+	self->priv->seek_window_size = seek_window_size;
+
+	g_object_notify (G_OBJECT (self), "seek-window-size");
+}
+
+/**
+ * gdata_download_stream_get_auto_resume:
+ * @self: a #GDataDownloadStream
+ *
+ * Gets the #GDataDownloadStream:auto-resume property.
+ *
+ * Return value: %TRUE if interrupted downloads are automatically resumed, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_download_stream_get_auto_resume (GDataDownloadStream *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOWNLOAD_STREAM (self), FALSE);
+	return g_atomic_int_get (&(self->priv->auto_resume));
+}
+
+/**
+ * gdata_download_stream_set_auto_resume:
+ * @self: a #GDataDownloadStream
+ * @auto_resume: %TRUE to automatically resume interrupted downloads, %FALSE otherwise
+ *
+ * Sets the #GDataDownloadStream:auto-resume property. This can be changed at any time, including from another thread while the stream is being
+ * read.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_download_stream_set_auto_resume (GDataDownloadStream *self, gboolean auto_resume)
+{
+	g_return_if_fail (GDATA_IS_DOWNLOAD_STREAM (self));
+
+	g_atomic_int_set (&(self->priv->auto_resume), (auto_resume == TRUE) ? TRUE : FALSE);
+
+	g_object_notify (G_OBJECT (self), "auto-resume");
+}
+
+/**
+ * gdata_download_stream_get_bandwidth_limit:
+ * @self: a #GDataDownloadStream
+ *
+ * Gets the #GDataDownloadStream:bandwidth-limit property.
+ *
+ * Return value: the maximum rate at which this stream may download data, in bytes per second, or <code class="literal">0</code> if there's no
+ * limit
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_download_stream_get_bandwidth_limit (GDataDownloadStream *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOWNLOAD_STREAM (self), 0);
+	return gdata_bandwidth_limiter_get_rate (self->priv->bandwidth_limiter);
+}
+
+/**
+ * gdata_download_stream_set_bandwidth_limit:
+ * @self: a #GDataDownloadStream
+ * @bytes_per_second: the maximum rate at which this stream may download data, in bytes per second, or <code class="literal">0</code> for no
+ * limit
+ *
+ * Sets the #GDataDownloadStream:bandwidth-limit property. This can be changed at any time, including from another thread while the stream is
+ * being read.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_download_stream_set_bandwidth_limit (GDataDownloadStream *self, guint bytes_per_second)
+{
+	g_return_if_fail (GDATA_IS_DOWNLOAD_STREAM (self));
+	g_return_if_fail (bytes_per_second <= G_MAXINT);
+
+	gdata_bandwidth_limiter_set_rate (self->priv->bandwidth_limiter, bytes_per_second);
+
+	g_object_notify (G_OBJECT (self), "bandwidth-limit");
+}
+
+/**
+ * gdata_download_stream_download_segments:
+ * @self: a #GDataDownloadStream
+ * @destination: the #GFile to save the downloaded file to
+ * @n_segments: the maximum number of parts to download concurrently
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Downloads the file to @destination, splitting it into up to @n_segments byte ranges which are requested concurrently on separate connections. On
+ * links with a high bandwidth–delay product, this can be much faster than reading the file through the #GInputStream API, as a single connection
+ * rarely gets all of the available bandwidth. @destination is created if it doesn't exist, and overwritten if it does.
+ *
+ * The length of the file is found by requesting its first byte. If the server doesn't support <literal>Range</literal> requests, the whole file is
+ * downloaded on a single connection instead. Each part is written straight to @destination as it arrives, so the memory used doesn't depend on the
+ * size of the file. Files smaller than a few megabytes aren't split into as many parts as requested. The number of parts actually transferred at
+ * once is also limited by #GDataService:max-connections-per-host, so that should be raised to at least @n_segments beforehand.
+ *
+ * This must be called before any data has been read from @self using the #GInputStream API. Once it returns successfully,
+ * #GDataDownloadStream:content-type and #GDataDownloadStream:content-length are set.
+ *
+ * If the download fails or is cancelled (using @cancellable or #GDataDownloadStream:cancellable), all the parts are stopped and an error is returned.
+ * The contents of @destination are undefined in that case. If the server returns an error, it will be returned as a #GDataServiceError.
+ * %GDATA_SERVICE_ERROR_PROTOCOL_ERROR is returned if the server returns different parts of the file to those which were requested.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_download_stream_download_segments (GDataDownloadStream *self, GFile *destination, guint n_segments, GCancellable *cancellable, GError **error)
+{
+	GDataDownloadStreamPrivate *priv;
+	GCancellable *child_cancellable;
+	gulong cancelled_signal = 0, global_cancelled_signal = 0;
+	GFileOutputStream *output_stream;
+	SoupMessage *message;
+	SegmentData probe = { NULL, };
+	SegmentData *segments = NULL;
+	GThread **threads = NULL;
+	goffset total_length = -1, remaining_length, segment_length;
+	guint i, n_threads = 0;
+	gchar *content_type = NULL;
+	GError *child_error = NULL;
+
+	g_return_val_if_fail (GDATA_IS_DOWNLOAD_STREAM (self), FALSE);
+	g_return_val_if_fail (G_IS_FILE (destination), FALSE);
+	g_return_val_if_fail (n_segments > 0, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = self->priv;
+
+	/* Segmented downloads can't be mixed with reading from the stream */
+	g_return_val_if_fail (priv->network_started == FALSE, FALSE);
+
+	if (g_input_stream_set_pending (G_INPUT_STREAM (self), error) == FALSE)
+		return FALSE;
+
+	/* As in gdata_download_stream_read(), multiplex cancellation from @cancellable and @priv->cancellable. Failure of any one segment also
+	 * cancels @child_cancellable, which stops all the others. */
+	child_cancellable = g_cancellable_new ();
+
+	global_cancelled_signal = g_cancellable_connect (priv->cancellable, (GCallback) read_cancelled_cb, child_cancellable, NULL);
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) read_cancelled_cb, child_cancellable, NULL);
+
+	/* Request the first byte of the file to find out how long it is. This goes through g_file_replace() so that @destination is replaced
+	 * atomically, and the segments can then open it separately once it's been closed. */
+	output_stream = g_file_replace (destination, NULL, FALSE, G_FILE_CREATE_NONE, child_cancellable, &child_error);
+	if (output_stream == NULL)
+		goto done;
+
+	probe.self = self;
+	probe.destination = destination;
+	probe.output = G_OUTPUT_STREAM (output_stream);
+	probe.start = 0;
+	probe.end = 0;
+	probe.expected_status = SOUP_STATUS_PARTIAL_CONTENT;
+	probe.cancellable = child_cancellable;
+
+	message = build_segment_message (self, probe.start, probe.end);
+	g_signal_connect (message, "got-headers", (GCallback) probe_got_headers_cb, &probe);
+	download_segment (&probe, message);
+
+	if (probe.error == NULL) {
+		content_type = g_strdup (soup_message_headers_get_content_type (message->response_headers, NULL));
+
+		if (probe.expected_status == SOUP_STATUS_OK) {
+			total_length = probe.length_received;
+		} else {
+			soup_message_headers_get_content_range (message->response_headers, NULL, NULL, &total_length);
+		}
+	}
+
+	g_object_unref (message);
+
+	g_output_stream_close (G_OUTPUT_STREAM (output_stream), NULL, (probe.error == NULL) ? &(probe.error) : NULL);
+	g_object_unref (output_stream);
+
+	if (probe.error != NULL) {
+		g_propagate_error (&child_error, probe.error);
+		goto done;
+	} else if (probe.expected_status == SOUP_STATUS_OK) {
+		/* The whole file was returned in response to the probe */
+		goto done;
+	}
+
+	/* Split the rest of the file into segments. If the server didn't tell us the total length, we have to download the rest of it in one go. */
+	if (total_length < 0) {
+		n_threads = 1;
+		remaining_length = -1;
+		segment_length = -1;
+	} else {
+		remaining_length = total_length - 1;
+		n_threads = (guint) MIN ((goffset) n_segments, MAX (1, remaining_length / MIN_SEGMENT_SIZE));
+		segment_length = remaining_length / n_threads;
+
+		if (remaining_length == 0)
+			n_threads = 0;
+	}
+
+	segments = g_new0 (SegmentData, n_threads);
+	threads = g_new0 (GThread*, n_threads);
+
+	for (i = 0; i < n_threads; i++) {
+		SegmentData *segment = &(segments[i]);
+
+		segment->self = self;
+		segment->destination = destination;
+		segment->start = 1 + i * segment_length;
+		if (total_length < 0)
+			segment->end = -1;
+		else if (i == n_threads - 1)
+			segment->end = total_length - 1;
+		else
+			segment->end = segment->start + segment_length - 1;
+
+		segment->expected_status = SOUP_STATUS_PARTIAL_CONTENT;
+		segment->cancellable = child_cancellable;
+
+		threads[i] = g_thread_try_new ("download-segment-thread", (GThreadFunc) segment_thread, segment, &child_error);
+		if (threads[i] == NULL) {
+			g_cancellable_cancel (child_cancellable);
+			break;
+		}
+	}
+
+	/* Wait for all the segments to finish, and return the error which caused the download to fail, rather than the cancellation errors which
+	 * it caused in the other segments */
+	for (i = 0; i < n_threads && threads[i] != NULL; i++) {
+		g_thread_join (threads[i]);
+
+		if (segments[i].error == NULL) {
+			continue;
+		} else if (child_error == NULL ||
+		           (g_error_matches (child_error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == TRUE &&
+		            g_error_matches (segments[i].error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == FALSE)) {
+			g_clear_error (&child_error);
+			child_error = segments[i].error;
+		} else {
+			g_error_free (segments[i].error);
+		}
+	}
+
+	if (child_error == NULL && total_length < 0 && n_threads == 1)
+		total_length = 1 + segments[0].length_received;
+
+	g_free (threads);
+	g_free (segments);
+
+done:
+	/* Cache the Content-Type and -Length now that we know the download succeeded */
+	if (child_error == NULL) {
+		g_mutex_lock (&(priv->content_mutex));
+		g_free (priv->content_type);
+		priv->content_type = content_type;
+		priv->content_length = (gssize) total_length;
+		g_mutex_unlock (&(priv->content_mutex));
+
+		g_object_freeze_notify (G_OBJECT (self));
+		g_object_notify (G_OBJECT (self), "content-length");
+		g_object_notify (G_OBJECT (self), "content-type");
+		g_object_thaw_notify (G_OBJECT (self));
+	} else {
+		g_free (content_type);
+	}
+
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+	if (global_cancelled_signal != 0)
+		g_cancellable_disconnect (priv->cancellable, global_cancelled_signal);
+
+	g_object_unref (child_cancellable);
+
+	g_input_stream_clear_pending (G_INPUT_STREAM (self));
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* Returns the ETag of the file, if the server has returned one yet. This must only be called when the request isn't running. */
+const gchar *
+_gdata_download_stream_get_etag (GDataDownloadStream *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOWNLOAD_STREAM (self), NULL);
+	return self->priv->etag;
+}
+
+/**
+ * gdata_download_stream_download_to_file:
+ * @self: a #GDataDownloadStream
+ * @destination: the #GFile to save the downloaded file to
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Downloads the whole file to @destination, which is created if it doesn't exist and overwritten if it does. This is more efficient than reading the
+ * file through the #GInputStream API and splicing it into a #GFileOutputStream, as the data is written to @destination straight from the network
+ * buffers as it arrives, in the calling thread: there's no intermediate buffering and the service's I/O thread isn't involved. If @destination is a local file,
+ * its full length is allocated on disk as soon as the <literal>Content-Length</literal> is known (if the file system supports it), so a lack of
+ * disk space is reported before the download gets going.
+ *
+ * This must be called before any data has been read from @self using the #GInputStream API. Once it returns successfully,
+ * #GDataDownloadStream:content-type and #GDataDownloadStream:content-length are set. The download can be cancelled using @cancellable or
+ * #GDataDownloadStream:cancellable. If it fails or is cancelled, the contents of @destination are undefined. If the server returns an error, it
+ * will be returned as a #GDataServiceError.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_download_stream_download_to_file (GDataDownloadStream *self, GFile *destination, GCancellable *cancellable, GError **error)
+{
+	GDataDownloadStreamPrivate *priv;
+	GCancellable *child_cancellable;
+	gulong cancelled_signal = 0, global_cancelled_signal = 0;
+	SoupMessage *message;
+	FileData data = { NULL, };
+	gchar *path;
+	GError *child_error = NULL;
+
+	g_return_val_if_fail (GDATA_IS_DOWNLOAD_STREAM (self), FALSE);
+	g_return_val_if_fail (G_IS_FILE (destination), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = self->priv;
+
+	/* This can't be mixed with reading from the stream */
+	g_return_val_if_fail (priv->network_started == FALSE, FALSE);
+
+	if (g_input_stream_set_pending (G_INPUT_STREAM (self), error) == FALSE)
+		return FALSE;
+
+	/* As in gdata_download_stream_read(), multiplex cancellation from @cancellable and @priv->cancellable. Write errors also cancel
+	 * @child_cancellable, which stops the download. */
+	child_cancellable = g_cancellable_new ();
+
+	global_cancelled_signal = g_cancellable_connect (priv->cancellable, (GCallback) read_cancelled_cb, child_cancellable, NULL);
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) read_cancelled_cb, child_cancellable, NULL);
+
+	data.self = self;
+	data.fd = -1;
+	data.cancellable = child_cancellable;
+
+	/* Write local files directly so that we can pre-allocate them; otherwise go through GIO */
+	path = g_file_get_path (destination);
+
+#ifdef G_OS_UNIX
+	if (path != NULL) {
+		data.fd = g_open (path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+		if (data.fd < 0) {
+			gint errsv = errno;
+			gchar *display_name = g_filename_display_name (path);
+
+			g_set_error (&child_error, G_IO_ERROR, g_io_error_from_errno (errsv), _("Error opening file '%s': %s"), display_name,
+			             g_strerror (errsv));
+			g_free (display_name);
+			g_free (path);
+
+			goto done;
+		}
+	}
+#endif /* G_OS_UNIX */
+
+	g_free (path);
+
+	if (data.fd < 0) {
+		data.output = G_OUTPUT_STREAM (g_file_replace (destination, NULL, FALSE, G_FILE_CREATE_NONE, child_cancellable, &child_error));
+		if (data.output == NULL)
+			goto done;
+	}
+
+	message = build_segment_message (self, 0, -1);
+	g_signal_connect (message, "got-headers", (GCallback) file_got_headers_cb, &data);
+	g_signal_connect (message, "got-chunk", (GCallback) file_got_chunk_cb, &data);
+
+	_gdata_service_actually_send_message (priv->session, message, child_cancellable, &child_error);
+
+	if (data.error != NULL) {
+		/* A write error takes priority over the cancellation error it caused */
+		g_clear_error (&child_error);
+		child_error = data.error;
+	} else if (child_error == NULL && SOUP_STATUS_IS_SUCCESSFUL (message->status_code) == FALSE) {
+		GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (priv->service);
+
+		g_assert (klass->parse_error_response != NULL);
+		klass->parse_error_response (priv->service, GDATA_OPERATION_DOWNLOAD, message->status_code, message->reason_phrase,
+		                             NULL, 0, &child_error);
+	}
+
+	g_object_unref (message);
+
+	/* Only report errors from closing the file if everything else succeeded */
+#ifdef G_OS_UNIX
+	if (data.fd >= 0) {
+		if (close (data.fd) < 0 && child_error == NULL) {
+			gint errsv = errno;
+			g_set_error_literal (&child_error, G_IO_ERROR, g_io_error_from_errno (errsv), g_strerror (errsv));
+		}
+	} else
+#endif /* G_OS_UNIX */
+	{
+		g_output_stream_close (data.output, NULL, (child_error == NULL) ? &child_error : NULL);
+		g_object_unref (data.output);
+	}
+
+done:
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+	if (global_cancelled_signal != 0)
+		g_cancellable_disconnect (priv->cancellable, global_cancelled_signal);
+
+	g_object_unref (child_cancellable);
+
+	g_input_stream_clear_pending (G_INPUT_STREAM (self));
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
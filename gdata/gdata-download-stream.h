@@ -72,6 +72,20 @@ const gchar *gdata_download_stream_get_download_uri (GDataDownloadStream *self)
 const gchar *gdata_download_stream_get_content_type (GDataDownloadStream *self) G_GNUC_PURE;
 gssize gdata_download_stream_get_content_length (GDataDownloadStream *self) G_GNUC_PURE;
 GCancellable *gdata_download_stream_get_cancellable (GDataDownloadStream *self) G_GNUC_PURE;
+guint gdata_download_stream_get_max_buffer_size (GDataDownloadStream *self) G_GNUC_PURE;
+void gdata_download_stream_set_max_buffer_size (GDataDownloadStream *self, guint max_buffer_size);
+guint gdata_download_stream_get_seek_threshold (GDataDownloadStream *self) G_GNUC_PURE;
+void gdata_download_stream_set_seek_threshold (GDataDownloadStream *self, guint seek_threshold);
+guint gdata_download_stream_get_seek_window_size (GDataDownloadStream *self) G_GNUC_PURE;
+void gdata_download_stream_set_seek_window_size (GDataDownloadStream *self, guint seek_window_size);
+gboolean gdata_download_stream_get_auto_resume (GDataDownloadStream *self) G_GNUC_PURE;
+void gdata_download_stream_set_auto_resume (GDataDownloadStream *self, gboolean auto_resume);
+guint gdata_download_stream_get_bandwidth_limit (GDataDownloadStream *self) G_GNUC_PURE;
+void gdata_download_stream_set_bandwidth_limit (GDataDownloadStream *self, guint bytes_per_second);
+
+gboolean gdata_download_stream_download_to_file (GDataDownloadStream *self, GFile *destination, GCancellable *cancellable, GError **error);
+gboolean gdata_download_stream_download_segments (GDataDownloadStream *self, GFile *destination, guint n_segments, GCancellable *cancellable,
+                                                  GError **error);
 
 G_END_DECLS
 
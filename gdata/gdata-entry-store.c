@@ -0,0 +1,2115 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-entry-store
+ * @short_description: GData local entry store
+ * @stability: Unstable
+ * @include: gdata/gdata-entry-store.h
+ *
+ * #GDataEntryStore is an optional local store of #GDataEntry<!-- -->s, which can be kept in a file between runs of a program so that entries
+ * are available offline and without the latency of a request to the server.
+ *
+ * Entries are kept in the binary form returned by gdata_parsable_get_variant(), and are only deserialised when they're looked up. Entries are
+ * indexed by ID and by last update time; contacts are also indexed by their e-mail addresses, calendar events by their times and documents by
+ * their parent folders, so they can be found using gdata_entry_store_find_contacts_by_email(), gdata_entry_store_find_events() and
+ * gdata_entry_store_find_documents_in_folder() respectively. Geotagged PicasaWeb albums and files and YouTube videos are indexed by their
+ * coordinates, so they can be found within an area using gdata_entry_store_find_entries_in_area() or gdata_entry_store_find_entries_near().
+ *
+ * Entries are also indexed by the words in their titles and summaries, and contacts by the words in their names, nicknames and e-mail
+ * addresses, so they can be searched locally using gdata_entry_store_search(). Searches match entries which contain a word starting with each of
+ * the words searched for, ignoring case, so they're suitable for autocompletion as the user types.
+ *
+ * The store implements #GDataContactsSyncStore, #GDataCalendarSyncStore, #GDataTasksSyncStore and #GDataDocumentsSyncStore, so it can be
+ * filled and kept up to date by passing it to the corresponding synchronisation engine. The store is written to its file whenever a contacts
+ * watermark or documents changestamp is stored, as the synchronisation engines require; otherwise, gdata_entry_store_save() must be called to
+ * write it.
+ *
+ * gdata_entry_store_query_single_entry() and gdata_entry_store_query() take the same parameters as the equivalent #GDataService methods, and
+ * only send a request to the server if the store can't answer them itself; the entries returned by the server are then added to the store.
+ * A feed query can be answered locally once the store has been completely filled with entries of the queried type by a synchronisation engine
+ * (so only contacts and documents queries can be answered locally), and if the query only uses the #GDataQuery:q, #GDataQuery:updated-min,
+ * #GDataQuery:updated-max, #GDataQuery:published-min, #GDataQuery:published-max, #GDataQuery:start-index and #GDataQuery:max-results
+ * parameters. Locally answered queries return entries in order of last update, most recent first; their #GDataQuery:q is evaluated as by
+ * gdata_entry_store_search(), so it only matches the indexed fields, rather than the entries' full text as the server does.
+ *
+ * The store is thread-safe.
+ *
+ * <example>
+ *	<title>Keeping a Local Store of Contacts</title>
+ *	<programlisting>
+ *	GDataEntryStore *store;
+ *	GDataContactsSync *sync;
+ *	GList *contacts;
+ *	GError *error = NULL;
+ *
+ *	store = gdata_entry_store_new ("/path/to/cache/contacts.store", &error);
+ *	sync = gdata_contacts_sync_new (service, GDATA_CONTACTS_SYNC_STORE (store));
+ *
+ *	/<!-- -->* Bring the store up to date; if this fails, the previously stored contacts can still be used offline *<!-- -->/
+ *	if (gdata_contacts_sync_run (sync, NULL, NULL, NULL, &error) == FALSE) {
+ *		g_warning ("Error synchronising contacts: %s", error->message);
+ *		g_clear_error (&error);
+ *	}
+ *
+ *	contacts = gdata_entry_store_find_contacts_by_email (store, "john.smith@example.com");
+ *	g_list_free_full (contacts, g_object_unref);
+ *
+ *	g_object_unref (sync);
+ *	g_object_unref (store);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <string.h>
+#include <math.h>
+
+#include "gdata-entry-store.h"
+#include "gdata-parsable.h"
+#include "gdata-parser.h"
+#include "gdata-private.h"
+#include "gd/gdata-gd-email-address.h"
+#include "gd/gdata-gd-when.h"
+#include "services/contacts/gdata-contacts-contact.h"
+#include "services/contacts/gdata-contacts-sync.h"
+#include "services/calendar/gdata-calendar-event.h"
+#include "services/calendar/gdata-calendar-sync.h"
+#include "services/documents/gdata-documents-entry.h"
+#include "services/documents/gdata-documents-sync.h"
+#include "services/tasks/gdata-tasks-sync.h"
+#include "services/picasaweb/gdata-picasaweb-album.h"
+#include "services/picasaweb/gdata-picasaweb-file.h"
+#include "services/youtube/gdata-youtube-video.h"
+
+#define STORE_FORMAT_VERSION 2
+
+/* Type, ID, scope, resource ID, updated and published times, e-mail addresses, times, parents, search terms, locations and the
+ * gdata_parsable_get_variant() data; empty strings stand in for NULL */
+#define STORED_ENTRY_TYPE "(ssssxxasa(xx)asasa(dd)v)"
+/* Version, contacts watermark, documents changestamp, synchronised entry type names and the stored entries */
+#define STORE_TYPE "(uxxasa" STORED_ENTRY_TYPE ")"
+
+/* The URI under which a parent link refers to a folder is of the form: http://docs.google.com/feeds/default/private/full/folder%3Afolder_id */
+#define PARENT_LINK_REL "http://schemas.google.com/docs/2007#parent"
+#define FOLDER_URI_PREFIX "folder%3A"
+
+/* Length assumed for all-day times which don't have an end date */
+#define DAY_LENGTH (24 * 60 * 60)
+
+/* Locations are indexed in a grid of cells this many to a degree of latitude and longitude (so roughly a kilometre across at the equator) */
+#define GEO_CELLS_PER_DEGREE 100
+#define GEO_N_LONGITUDE_CELLS (360 * GEO_CELLS_PER_DEGREE)
+#define GEO_N_LATITUDE_CELLS (180 * GEO_CELLS_PER_DEGREE)
+
+/* Mean radius of the Earth, in metres */
+#define EARTH_RADIUS 6371008.8
+
+typedef struct {
+	gchar *id;
+	gchar *type_name;
+	gchar *scope; /* ID of the calendar or tasklist the entry was synchronised from, or NULL */
+	gchar *resource_id; /* documents' resource IDs, or NULL */
+	gint64 updated;
+	gint64 published;
+	gchar **emails; /* contacts' lower-cased e-mail addresses */
+	GArray *times; /* events' start and end times, as pairs of gint64s */
+	gchar **parents; /* resource IDs of documents' parent folders */
+	gchar **terms; /* distinct case-folded words to search for the entry by */
+	GArray *locations; /* geotagged entries' latitudes and longitudes, as pairs of gdoubles */
+	GVariant *data; /* from gdata_parsable_get_variant() */
+
+	GSequenceIter *updated_iter; /* in by_updated */
+	GPtrArray *time_iters; /* GSequenceIters in by_time */
+} StoredEntry;
+
+typedef struct {
+	gint64 start_time;
+	gint64 end_time;
+	StoredEntry *entry;
+} TimeSpan;
+
+/* The entries containing a search term */
+typedef struct {
+	gchar *term;
+	GPtrArray *entries; /* StoredEntry */
+	GSequenceIter *iter; /* in sorted_terms */
+} Term;
+
+/* The entries with a location in a cell of the location grid */
+typedef struct {
+	gint64 key; /* latitude cell × GEO_N_LONGITUDE_CELLS + longitude cell */
+	GPtrArray *entries; /* StoredEntry */
+} GeoCell;
+
+/* An entry found by a location search, with its distance from the search's centre */
+typedef struct {
+	StoredEntry *entry;
+	gdouble distance;
+} GeoMatch;
+
+/* A stored entry's data, taken so that it can be deserialised without holding the store's lock */
+typedef struct {
+	GType type;
+	GVariant *data;
+} EntryData;
+
+static void gdata_entry_store_contacts_sync_store_init (GDataContactsSyncStoreInterface *iface);
+static void gdata_entry_store_calendar_sync_store_init (GDataCalendarSyncStoreInterface *iface);
+static void gdata_entry_store_tasks_sync_store_init (GDataTasksSyncStoreInterface *iface);
+static void gdata_entry_store_documents_sync_store_init (GDataDocumentsSyncStoreInterface *iface);
+static void gdata_entry_store_finalize (GObject *object);
+static void gdata_entry_store_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_entry_store_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataEntryStorePrivate {
+	gchar *filename;
+
+	GMutex mutex; /* protects all the other fields */
+	GHashTable *entries; /* entry ID → owned StoredEntry */
+	GSequence *by_updated; /* StoredEntry, most recently updated first */
+	GHashTable *by_email; /* address → GPtrArray of StoredEntry */
+	GHashTable *by_parent; /* folder resource ID → GPtrArray of StoredEntry */
+	GHashTable *by_resource_id; /* resource ID → StoredEntry */
+	GHashTable *terms; /* search term → owned Term */
+	GSequence *sorted_terms; /* Term, in order of their strings, so that prefix searches can find a range of terms */
+	GSequence *by_time; /* owned TimeSpan, in order of start time */
+	gint64 max_time_span; /* length of the longest TimeSpan ever indexed, so overlap searches know how far back to start */
+	GHashTable *by_location; /* cell key → owned GeoCell; only non-empty cells are present */
+	GHashTable *synced_types; /* names of the entry types a synchronisation engine has completely filled the store with */
+	gint64 contacts_watermark;
+	gint64 documents_changestamp;
+};
+
+enum {
+	PROP_FILENAME = 1,
+};
+
+G_DEFINE_TYPE_WITH_CODE (GDataEntryStore, gdata_entry_store, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_CONTACTS_SYNC_STORE, gdata_entry_store_contacts_sync_store_init)
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_CALENDAR_SYNC_STORE, gdata_entry_store_calendar_sync_store_init)
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_TASKS_SYNC_STORE, gdata_entry_store_tasks_sync_store_init)
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_DOCUMENTS_SYNC_STORE, gdata_entry_store_documents_sync_store_init))
+
+static void
+gdata_entry_store_class_init (GDataEntryStoreClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataEntryStorePrivate));
+
+	gobject_class->get_property = gdata_entry_store_get_property;
+	gobject_class->set_property = gdata_entry_store_set_property;
+	gobject_class->finalize = gdata_entry_store_finalize;
+
+	/**
+	 * GDataEntryStore:filename:
+	 *
+	 * The file the store is loaded from and saved to, or %NULL if the store is only kept in memory.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_FILENAME,
+	                                 g_param_spec_string ("filename",
+	                                                      "Filename", "The file the store is loaded from and saved to.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+stored_entry_free (StoredEntry *entry)
+{
+	g_free (entry->id);
+	g_free (entry->type_name);
+	g_free (entry->scope);
+	g_free (entry->resource_id);
+	g_strfreev (entry->emails);
+	g_array_free (entry->times, TRUE);
+	g_strfreev (entry->parents);
+	g_strfreev (entry->terms);
+	g_array_free (entry->locations, TRUE);
+	g_variant_unref (entry->data);
+	g_ptr_array_free (entry->time_iters, TRUE);
+	g_slice_free (StoredEntry, entry);
+}
+
+static void
+time_span_free (TimeSpan *span)
+{
+	g_slice_free (TimeSpan, span);
+}
+
+static void
+term_free (Term *term)
+{
+	g_free (term->term);
+	g_ptr_array_free (term->entries, TRUE);
+	g_slice_free (Term, term);
+}
+
+static void
+geo_cell_free (GeoCell *cell)
+{
+	g_ptr_array_free (cell->entries, TRUE);
+	g_slice_free (GeoCell, cell);
+}
+
+static void
+gdata_entry_store_init (GDataEntryStore *self)
+{
+	GDataEntryStorePrivate *priv;
+
+	self->priv = priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_ENTRY_STORE, GDataEntryStorePrivate);
+
+	g_mutex_init (&(priv->mutex));
+	priv->entries = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) stored_entry_free);
+	priv->by_updated = g_sequence_new (NULL);
+	priv->by_email = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->by_parent = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	priv->by_resource_id = g_hash_table_new (g_str_hash, g_str_equal);
+	priv->terms = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) term_free);
+	priv->sorted_terms = g_sequence_new (NULL);
+	priv->by_time = g_sequence_new ((GDestroyNotify) time_span_free);
+	priv->by_location = g_hash_table_new_full (g_int64_hash, g_int64_equal, NULL, (GDestroyNotify) geo_cell_free);
+	priv->synced_types = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->contacts_watermark = -1;
+	priv->documents_changestamp = -1;
+}
+
+static void
+gdata_entry_store_finalize (GObject *object)
+{
+	GDataEntryStorePrivate *priv = GDATA_ENTRY_STORE (object)->priv;
+
+	/* The indices only point into the entries, so must be destroyed first */
+	g_sequence_free (priv->by_updated);
+	g_sequence_free (priv->by_time);
+	g_sequence_free (priv->sorted_terms);
+	g_hash_table_destroy (priv->terms);
+	g_hash_table_destroy (priv->by_email);
+	g_hash_table_destroy (priv->by_parent);
+	g_hash_table_destroy (priv->by_resource_id);
+	g_hash_table_destroy (priv->by_location);
+	g_hash_table_destroy (priv->entries);
+	g_hash_table_destroy (priv->synced_types);
+	g_mutex_clear (&(priv->mutex));
+	g_free (priv->filename);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_entry_store_parent_class)->finalize (object);
+}
+
+static void
+gdata_entry_store_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataEntryStorePrivate *priv = GDATA_ENTRY_STORE (object)->priv;
+
+	switch (property_id) {
+		case PROP_FILENAME:
+			g_value_set_string (value, priv->filename);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_entry_store_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataEntryStorePrivate *priv = GDATA_ENTRY_STORE (object)->priv;
+
+	switch (property_id) {
+		case PROP_FILENAME:
+			priv->filename = g_value_dup_string (value);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/* Orders entries by last update time, most recent first; the IDs break any ties so that every entry has a distinct position */
+static gint
+compare_entries_by_updated (const StoredEntry *a, const StoredEntry *b, gpointer user_data)
+{
+	if (a->updated != b->updated)
+		return (a->updated > b->updated) ? -1 : 1;
+
+	return strcmp (a->id, b->id);
+}
+
+/* As compare_entries_by_updated(), but for g_ptr_array_sort_with_data(), which passes pointers to the elements */
+static gint
+compare_stored_entries_by_updated (const StoredEntry **a, const StoredEntry **b, gpointer user_data)
+{
+	return compare_entries_by_updated (*a, *b, user_data);
+}
+
+/* Orders time spans by start time, then end time; the entry addresses break any remaining ties */
+static gint
+compare_time_spans (const TimeSpan *a, const TimeSpan *b, gpointer user_data)
+{
+	if (a->start_time != b->start_time)
+		return (a->start_time < b->start_time) ? -1 : 1;
+	if (a->end_time != b->end_time)
+		return (a->end_time < b->end_time) ? -1 : 1;
+	if (a->entry != b->entry)
+		return (a->entry < b->entry) ? -1 : 1;
+	return 0;
+}
+
+static gint
+compare_terms (const Term *a, const Term *b, gpointer user_data)
+{
+	return strcmp (a->term, b->term);
+}
+
+/* Splits @text into case-folded words, which may contain duplicates */
+static gchar **
+tokenize (const gchar *text)
+{
+	GPtrArray *tokens;
+	gchar *normalized, *folded;
+	const gchar *i, *start = NULL;
+
+	tokens = g_ptr_array_new ();
+
+	normalized = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+	if (normalized == NULL) {
+		/* Invalid UTF-8 */
+		g_ptr_array_add (tokens, NULL);
+		return (gchar**) g_ptr_array_free (tokens, FALSE);
+	}
+
+	folded = g_utf8_casefold (normalized, -1);
+	g_free (normalized);
+
+	for (i = folded; ; i = g_utf8_next_char (i)) {
+		gunichar c = g_utf8_get_char (i);
+
+		if (c != 0 && g_unichar_isalnum (c) == TRUE) {
+			if (start == NULL)
+				start = i;
+		} else {
+			if (start != NULL)
+				g_ptr_array_add (tokens, g_strndup (start, i - start));
+			start = NULL;
+
+			if (c == 0)
+				break;
+		}
+	}
+
+	g_free (folded);
+
+	g_ptr_array_add (tokens, NULL);
+	return (gchar**) g_ptr_array_free (tokens, FALSE);
+}
+
+static void
+add_terms (GHashTable *terms, const gchar *text)
+{
+	gchar **tokens;
+	guint i;
+
+	if (text == NULL)
+		return;
+
+	tokens = tokenize (text);
+
+	for (i = 0; tokens[i] != NULL; i++) {
+		if (g_hash_table_contains (terms, tokens[i]) == FALSE)
+			g_hash_table_add (terms, tokens[i]);
+		else
+			g_free (tokens[i]);
+	}
+
+	/* The strings are now owned by @terms */
+	g_free (tokens);
+}
+
+/* Extract the folder's resource ID from the URI of a parent link, or return NULL if it isn't a folder URI */
+static gchar *
+parent_uri_to_resource_id (const gchar *uri)
+{
+	const gchar *folder_id;
+	gsize length;
+
+	folder_id = strstr (uri, FOLDER_URI_PREFIX);
+	if (folder_id == NULL)
+		return NULL;
+
+	folder_id += strlen (FOLDER_URI_PREFIX);
+	length = strcspn (folder_id, "/?#");
+
+	if (length == 0)
+		return NULL;
+
+	return g_strdup_printf ("folder:%.*s", (int) length, folder_id);
+}
+
+/* Returns NULL if the entry can't be stored */
+static StoredEntry *
+stored_entry_new (GDataEntry *entry, const gchar *scope)
+{
+	StoredEntry *stored;
+	GVariant *data;
+	GPtrArray *strings;
+	GHashTable *terms;
+	GHashTableIter iter;
+	gchar *term;
+	GList *i;
+	guint j;
+
+	data = gdata_parsable_get_variant (GDATA_PARSABLE (entry));
+	if (data == NULL)
+		return NULL;
+
+	stored = g_slice_new0 (StoredEntry);
+	stored->id = g_strdup (gdata_entry_get_id (entry));
+	stored->type_name = g_strdup (G_OBJECT_TYPE_NAME (entry));
+	stored->scope = g_strdup (scope);
+	stored->updated = gdata_entry_get_updated (entry);
+	stored->published = gdata_entry_get_published (entry);
+	stored->data = data;
+	stored->times = g_array_new (FALSE, FALSE, sizeof (gint64));
+	stored->time_iters = g_ptr_array_new ();
+	stored->locations = g_array_new (FALSE, FALSE, sizeof (gdouble));
+
+	strings = g_ptr_array_new ();
+	if (GDATA_IS_CONTACTS_CONTACT (entry) == TRUE) {
+		for (i = gdata_contacts_contact_get_email_addresses (GDATA_CONTACTS_CONTACT (entry)); i != NULL; i = i->next) {
+			const gchar *address = gdata_gd_email_address_get_address (GDATA_GD_EMAIL_ADDRESS (i->data));
+
+			if (address != NULL)
+				g_ptr_array_add (strings, g_utf8_strdown (address, -1));
+		}
+	}
+	g_ptr_array_add (strings, NULL);
+	stored->emails = (gchar**) g_ptr_array_free (strings, FALSE);
+
+	terms = g_hash_table_new (g_str_hash, g_str_equal);
+	add_terms (terms, gdata_entry_get_title (entry));
+	add_terms (terms, gdata_entry_get_summary (entry));
+
+	if (GDATA_IS_CONTACTS_CONTACT (entry) == TRUE) {
+		GDataGDName *name = gdata_contacts_contact_get_name (GDATA_CONTACTS_CONTACT (entry));
+
+		if (name != NULL) {
+			add_terms (terms, gdata_gd_name_get_full_name (name));
+			add_terms (terms, gdata_gd_name_get_given_name (name));
+			add_terms (terms, gdata_gd_name_get_family_name (name));
+		}
+
+		add_terms (terms, gdata_contacts_contact_get_nickname (GDATA_CONTACTS_CONTACT (entry)));
+
+		for (j = 0; stored->emails[j] != NULL; j++)
+			add_terms (terms, stored->emails[j]);
+	}
+
+	strings = g_ptr_array_new ();
+	g_hash_table_iter_init (&iter, terms);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &term, NULL) == TRUE)
+		g_ptr_array_add (strings, term);
+	g_ptr_array_add (strings, NULL);
+	stored->terms = (gchar**) g_ptr_array_free (strings, FALSE);
+
+	/* The strings are now owned by @stored */
+	g_hash_table_destroy (terms);
+
+	if (GDATA_IS_CALENDAR_EVENT (entry) == TRUE) {
+		for (i = gdata_calendar_event_get_times (GDATA_CALENDAR_EVENT (entry)); i != NULL; i = i->next) {
+			GDataGDWhen *when = GDATA_GD_WHEN (i->data);
+			gint64 start_time, end_time;
+
+			start_time = gdata_gd_when_get_start_time (when);
+			end_time = gdata_gd_when_get_end_time (when);
+
+			if (end_time < start_time)
+				end_time = start_time + ((gdata_gd_when_is_date (when) == TRUE) ? DAY_LENGTH : 0);
+
+			g_array_append_val (stored->times, start_time);
+			g_array_append_val (stored->times, end_time);
+		}
+	}
+
+	strings = g_ptr_array_new ();
+	if (GDATA_IS_DOCUMENTS_ENTRY (entry) == TRUE) {
+		GList *links;
+
+		stored->resource_id = g_strdup (gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (entry)));
+
+		links = gdata_entry_look_up_links (entry, PARENT_LINK_REL);
+		for (i = links; i != NULL; i = i->next) {
+			gchar *parent_id = parent_uri_to_resource_id (gdata_link_get_uri (GDATA_LINK (i->data)));
+
+			if (parent_id != NULL)
+				g_ptr_array_add (strings, parent_id);
+		}
+		g_list_free (links);
+	}
+	g_ptr_array_add (strings, NULL);
+	stored->parents = (gchar**) g_ptr_array_free (strings, FALSE);
+
+	if (GDATA_IS_PICASAWEB_ALBUM (entry) == TRUE || GDATA_IS_PICASAWEB_FILE (entry) == TRUE || GDATA_IS_YOUTUBE_VIDEO (entry) == TRUE) {
+		gdouble latitude = G_MAXDOUBLE, longitude = G_MAXDOUBLE;
+
+		if (GDATA_IS_PICASAWEB_ALBUM (entry) == TRUE)
+			gdata_picasaweb_album_get_coordinates (GDATA_PICASAWEB_ALBUM (entry), &latitude, &longitude);
+		else if (GDATA_IS_PICASAWEB_FILE (entry) == TRUE)
+			gdata_picasaweb_file_get_coordinates (GDATA_PICASAWEB_FILE (entry), &latitude, &longitude);
+		else
+			gdata_youtube_video_get_coordinates (GDATA_YOUTUBE_VIDEO (entry), &latitude, &longitude);
+
+		/* Unset coordinates are G_MAXDOUBLE */
+		if (latitude >= -90.0 && latitude <= 90.0 && longitude >= -180.0 && longitude <= 180.0) {
+			g_array_append_val (stored->locations, latitude);
+			g_array_append_val (stored->locations, longitude);
+		}
+	}
+
+	return stored;
+}
+
+static void
+multi_index_add (GHashTable *index, const gchar *key, StoredEntry *entry)
+{
+	GPtrArray *entries = g_hash_table_lookup (index, key);
+
+	if (entries == NULL) {
+		entries = g_ptr_array_new ();
+		g_hash_table_insert (index, g_strdup (key), entries);
+	}
+
+	g_ptr_array_add (entries, entry);
+}
+
+static void
+multi_index_remove (GHashTable *index, const gchar *key, StoredEntry *entry)
+{
+	GPtrArray *entries = g_hash_table_lookup (index, key);
+
+	if (entries == NULL)
+		return;
+
+	g_ptr_array_remove_fast (entries, entry);
+	if (entries->len == 0)
+		g_hash_table_remove (index, key);
+}
+
+static void
+term_index_add (GDataEntryStorePrivate *priv, const gchar *term_string, StoredEntry *entry)
+{
+	Term *term = g_hash_table_lookup (priv->terms, term_string);
+
+	if (term == NULL) {
+		term = g_slice_new (Term);
+		term->term = g_strdup (term_string);
+		term->entries = g_ptr_array_new ();
+		term->iter = g_sequence_insert_sorted (priv->sorted_terms, term, (GCompareDataFunc) compare_terms, NULL);
+		g_hash_table_insert (priv->terms, term->term, term);
+	}
+
+	g_ptr_array_add (term->entries, entry);
+}
+
+static void
+term_index_remove (GDataEntryStorePrivate *priv, const gchar *term_string, StoredEntry *entry)
+{
+	Term *term = g_hash_table_lookup (priv->terms, term_string);
+
+	if (term == NULL)
+		return;
+
+	g_ptr_array_remove_fast (term->entries, entry);
+	if (term->entries->len == 0) {
+		g_sequence_remove (term->iter);
+		g_hash_table_remove (priv->terms, term_string);
+	}
+}
+
+static gint
+latitude_to_cell (gdouble latitude)
+{
+	return CLAMP ((gint) floor ((latitude + 90.0) * GEO_CELLS_PER_DEGREE), 0, GEO_N_LATITUDE_CELLS - 1);
+}
+
+/* Longitudes of 180° wrap around to the cell for -180° */
+static gint
+longitude_to_cell (gdouble longitude)
+{
+	return CLAMP ((gint) floor ((longitude + 180.0) * GEO_CELLS_PER_DEGREE), 0, GEO_N_LONGITUDE_CELLS) % GEO_N_LONGITUDE_CELLS;
+}
+
+static gint64
+location_to_cell_key (gdouble latitude, gdouble longitude)
+{
+	return (gint64) latitude_to_cell (latitude) * GEO_N_LONGITUDE_CELLS + longitude_to_cell (longitude);
+}
+
+static void
+location_index_add (GDataEntryStorePrivate *priv, gdouble latitude, gdouble longitude, StoredEntry *entry)
+{
+	gint64 key = location_to_cell_key (latitude, longitude);
+	GeoCell *cell = g_hash_table_lookup (priv->by_location, &key);
+
+	if (cell == NULL) {
+		cell = g_slice_new (GeoCell);
+		cell->key = key;
+		cell->entries = g_ptr_array_new ();
+		g_hash_table_insert (priv->by_location, &(cell->key), cell);
+	}
+
+	/* Entries with several locations in the same cell are only listed once */
+	if (cell->entries->len == 0 || g_ptr_array_index (cell->entries, cell->entries->len - 1) != entry)
+		g_ptr_array_add (cell->entries, entry);
+}
+
+static void
+location_index_remove (GDataEntryStorePrivate *priv, gdouble latitude, gdouble longitude, StoredEntry *entry)
+{
+	gint64 key = location_to_cell_key (latitude, longitude);
+	GeoCell *cell = g_hash_table_lookup (priv->by_location, &key);
+
+	if (cell == NULL)
+		return;
+
+	g_ptr_array_remove_fast (cell->entries, entry);
+	if (cell->entries->len == 0)
+		g_hash_table_remove (priv->by_location, &key);
+}
+
+/* Must be called with the lock held. Frees @entry. */
+static void
+remove_stored_entry (GDataEntryStorePrivate *priv, StoredEntry *entry)
+{
+	guint i;
+
+	g_sequence_remove (entry->updated_iter);
+
+	for (i = 0; i < entry->time_iters->len; i++)
+		g_sequence_remove (g_ptr_array_index (entry->time_iters, i));
+
+	for (i = 0; entry->emails[i] != NULL; i++)
+		multi_index_remove (priv->by_email, entry->emails[i], entry);
+	for (i = 0; entry->parents[i] != NULL; i++)
+		multi_index_remove (priv->by_parent, entry->parents[i], entry);
+	for (i = 0; entry->terms[i] != NULL; i++)
+		term_index_remove (priv, entry->terms[i], entry);
+	for (i = 0; i + 1 < entry->locations->len; i += 2) {
+		location_index_remove (priv, g_array_index (entry->locations, gdouble, i), g_array_index (entry->locations, gdouble, i + 1),
+		                       entry);
+	}
+
+	if (entry->resource_id != NULL && g_hash_table_lookup (priv->by_resource_id, entry->resource_id) == entry)
+		g_hash_table_remove (priv->by_resource_id, entry->resource_id);
+
+	g_hash_table_remove (priv->entries, entry->id);
+}
+
+/* Must be called with the lock held. Takes ownership of @entry, replacing any existing entry with the same ID. */
+static void
+add_stored_entry (GDataEntryStorePrivate *priv, StoredEntry *entry)
+{
+	StoredEntry *old_entry;
+	guint i;
+
+	old_entry = g_hash_table_lookup (priv->entries, entry->id);
+	if (old_entry != NULL) {
+		/* Keep the scope the entry was synchronised with, if it's being updated from elsewhere */
+		if (entry->scope == NULL)
+			entry->scope = g_strdup (old_entry->scope);
+
+		remove_stored_entry (priv, old_entry);
+	}
+
+	g_hash_table_insert (priv->entries, entry->id, entry);
+	entry->updated_iter = g_sequence_insert_sorted (priv->by_updated, entry, (GCompareDataFunc) compare_entries_by_updated, NULL);
+
+	for (i = 0; i + 1 < entry->times->len; i += 2) {
+		TimeSpan *span = g_slice_new (TimeSpan);
+
+		span->start_time = g_array_index (entry->times, gint64, i);
+		span->end_time = g_array_index (entry->times, gint64, i + 1);
+		span->entry = entry;
+
+		priv->max_time_span = MAX (priv->max_time_span, span->end_time - span->start_time);
+		g_ptr_array_add (entry->time_iters, g_sequence_insert_sorted (priv->by_time, span, (GCompareDataFunc) compare_time_spans, NULL));
+	}
+
+	for (i = 0; entry->emails[i] != NULL; i++)
+		multi_index_add (priv->by_email, entry->emails[i], entry);
+	for (i = 0; entry->parents[i] != NULL; i++)
+		multi_index_add (priv->by_parent, entry->parents[i], entry);
+	for (i = 0; entry->terms[i] != NULL; i++)
+		term_index_add (priv, entry->terms[i], entry);
+	for (i = 0; i + 1 < entry->locations->len; i += 2)
+		location_index_add (priv, g_array_index (entry->locations, gdouble, i), g_array_index (entry->locations, gdouble, i + 1), entry);
+
+	if (entry->resource_id != NULL)
+		g_hash_table_insert (priv->by_resource_id, entry->resource_id, entry);
+}
+
+static void
+add_entry (GDataEntryStore *self, GDataEntry *entry, const gchar *scope)
+{
+	StoredEntry *stored;
+
+	/* Entries without IDs can't be looked up again, so aren't worth storing */
+	if (gdata_entry_get_id (entry) == NULL)
+		return;
+
+	stored = stored_entry_new (entry, scope);
+	if (stored == NULL)
+		return;
+
+	g_mutex_lock (&(self->priv->mutex));
+	add_stored_entry (self->priv, stored);
+	g_mutex_unlock (&(self->priv->mutex));
+}
+
+static gboolean
+remove_entry_by_resource_id (GDataEntryStore *self, const gchar *resource_id)
+{
+	StoredEntry *entry;
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	entry = g_hash_table_lookup (self->priv->by_resource_id, resource_id);
+	if (entry != NULL)
+		remove_stored_entry (self->priv, entry);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return (entry != NULL) ? TRUE : FALSE;
+}
+
+static void
+remove_scope (GDataEntryStore *self, const gchar *scope)
+{
+	GHashTableIter iter;
+	StoredEntry *entry;
+	GPtrArray *entries;
+	guint i;
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	entries = g_ptr_array_new ();
+
+	g_hash_table_iter_init (&iter, self->priv->entries);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &entry) == TRUE) {
+		if (g_strcmp0 (entry->scope, scope) == 0)
+			g_ptr_array_add (entries, entry);
+	}
+
+	for (i = 0; i < entries->len; i++)
+		remove_stored_entry (self->priv, g_ptr_array_index (entries, i));
+
+	g_ptr_array_free (entries, TRUE);
+
+	g_mutex_unlock (&(self->priv->mutex));
+}
+
+/* Must be called with the lock held */
+static void
+mark_type_synced (GDataEntryStorePrivate *priv, GType entry_type)
+{
+	if (g_hash_table_contains (priv->synced_types, g_type_name (entry_type)) == FALSE)
+		g_hash_table_add (priv->synced_types, g_strdup (g_type_name (entry_type)));
+}
+
+/* Must be called with the lock held. Takes a reference to @entry's data if it's an instance of @entry_type. */
+static void
+entry_data_add (GArray *entries, StoredEntry *entry, GType entry_type)
+{
+	EntryData data;
+
+	data.type = g_type_from_name (entry->type_name);
+
+	/* The entry's type won't be registered if nothing's used it since the store was loaded, in which case it can't be @entry_type */
+	if (data.type == 0 || g_type_is_a (data.type, entry_type) == FALSE)
+		return;
+
+	data.data = g_variant_ref (entry->data);
+	g_array_append_val (entries, data);
+}
+
+/* Must be called without the lock held. Deserialises and frees @entries, skipping any which can't be deserialised. */
+static GList *
+entry_data_free_to_list (GArray *entries)
+{
+	GList *list = NULL;
+	guint i;
+
+	for (i = 0; i < entries->len; i++) {
+		EntryData *data = &g_array_index (entries, EntryData, i);
+		GDataParsable *parsable;
+
+		parsable = gdata_parsable_new_from_variant (data->type, data->data, NULL);
+		if (parsable != NULL)
+			list = g_list_prepend (list, parsable);
+
+		g_variant_unref (data->data);
+	}
+
+	g_array_free (entries, TRUE);
+
+	return g_list_reverse (list);
+}
+
+static gint64
+contacts_sync_store_get_watermark (GDataContactsSyncStore *self)
+{
+	GDataEntryStorePrivate *priv = GDATA_ENTRY_STORE (self)->priv;
+	gint64 watermark;
+
+	g_mutex_lock (&(priv->mutex));
+	watermark = priv->contacts_watermark;
+	g_mutex_unlock (&(priv->mutex));
+
+	return watermark;
+}
+
+static gboolean
+contacts_sync_store_set_watermark (GDataContactsSyncStore *self, gint64 watermark, GError **error)
+{
+	GDataEntryStorePrivate *priv = GDATA_ENTRY_STORE (self)->priv;
+
+	g_mutex_lock (&(priv->mutex));
+	priv->contacts_watermark = watermark;
+	mark_type_synced (priv, GDATA_TYPE_CONTACTS_CONTACT);
+	g_mutex_unlock (&(priv->mutex));
+
+	return gdata_entry_store_save (GDATA_ENTRY_STORE (self), error);
+}
+
+static gboolean
+contacts_sync_store_apply_contact (GDataContactsSyncStore *self, GDataContactsContact *contact, GError **error)
+{
+	add_entry (GDATA_ENTRY_STORE (self), GDATA_ENTRY (contact), NULL);
+	return TRUE;
+}
+
+static gboolean
+contacts_sync_store_remove_contact (GDataContactsSyncStore *self, const gchar *contact_id, GError **error)
+{
+	gdata_entry_store_remove_entry (GDATA_ENTRY_STORE (self), contact_id);
+	return TRUE;
+}
+
+static void
+gdata_entry_store_contacts_sync_store_init (GDataContactsSyncStoreInterface *iface)
+{
+	iface->get_watermark = contacts_sync_store_get_watermark;
+	iface->set_watermark = contacts_sync_store_set_watermark;
+	iface->apply_contact = contacts_sync_store_apply_contact;
+	iface->remove_contact = contacts_sync_store_remove_contact;
+}
+
+static gboolean
+calendar_sync_store_reset_calendar (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GError **error)
+{
+	remove_scope (GDATA_ENTRY_STORE (self), gdata_entry_get_id (GDATA_ENTRY (calendar)));
+	return TRUE;
+}
+
+static gboolean
+calendar_sync_store_apply_event (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GDataCalendarEvent *event, GError **error)
+{
+	add_entry (GDATA_ENTRY_STORE (self), GDATA_ENTRY (event), gdata_entry_get_id (GDATA_ENTRY (calendar)));
+	return TRUE;
+}
+
+static gboolean
+calendar_sync_store_remove_event (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, const gchar *event_id, GError **error)
+{
+	gdata_entry_store_remove_entry (GDATA_ENTRY_STORE (self), event_id);
+	return TRUE;
+}
+
+static void
+gdata_entry_store_calendar_sync_store_init (GDataCalendarSyncStoreInterface *iface)
+{
+	iface->reset_calendar = calendar_sync_store_reset_calendar;
+	iface->apply_event = calendar_sync_store_apply_event;
+	iface->remove_event = calendar_sync_store_remove_event;
+}
+
+static gboolean
+tasks_sync_store_reset_tasklist (GDataTasksSyncStore *self, GDataTasksTasklist *tasklist, GError **error)
+{
+	remove_scope (GDATA_ENTRY_STORE (self), gdata_entry_get_id (GDATA_ENTRY (tasklist)));
+	return TRUE;
+}
+
+static gboolean
+tasks_sync_store_apply_task (GDataTasksSyncStore *self, GDataTasksTasklist *tasklist, GDataTasksTask *task, GError **error)
+{
+	add_entry (GDATA_ENTRY_STORE (self), GDATA_ENTRY (task), gdata_entry_get_id (GDATA_ENTRY (tasklist)));
+	return TRUE;
+}
+
+static gboolean
+tasks_sync_store_remove_task (GDataTasksSyncStore *self, GDataTasksTasklist *tasklist, const gchar *task_id, GError **error)
+{
+	gdata_entry_store_remove_entry (GDATA_ENTRY_STORE (self), task_id);
+	return TRUE;
+}
+
+static void
+gdata_entry_store_tasks_sync_store_init (GDataTasksSyncStoreInterface *iface)
+{
+	iface->reset_tasklist = tasks_sync_store_reset_tasklist;
+	iface->apply_task = tasks_sync_store_apply_task;
+	iface->remove_task = tasks_sync_store_remove_task;
+}
+
+static gint64
+documents_sync_store_get_changestamp (GDataDocumentsSyncStore *self)
+{
+	GDataEntryStorePrivate *priv = GDATA_ENTRY_STORE (self)->priv;
+	gint64 changestamp;
+
+	g_mutex_lock (&(priv->mutex));
+	changestamp = priv->documents_changestamp;
+	g_mutex_unlock (&(priv->mutex));
+
+	return changestamp;
+}
+
+static gboolean
+documents_sync_store_set_changestamp (GDataDocumentsSyncStore *self, gint64 changestamp, GError **error)
+{
+	GDataEntryStorePrivate *priv = GDATA_ENTRY_STORE (self)->priv;
+
+	g_mutex_lock (&(priv->mutex));
+	priv->documents_changestamp = changestamp;
+	mark_type_synced (priv, GDATA_TYPE_DOCUMENTS_ENTRY);
+	g_mutex_unlock (&(priv->mutex));
+
+	return gdata_entry_store_save (GDATA_ENTRY_STORE (self), error);
+}
+
+static gboolean
+documents_sync_store_apply_entry (GDataDocumentsSyncStore *self, GDataDocumentsEntry *entry, GError **error)
+{
+	add_entry (GDATA_ENTRY_STORE (self), GDATA_ENTRY (entry), NULL);
+	return TRUE;
+}
+
+static gboolean
+documents_sync_store_remove_entry (GDataDocumentsSyncStore *self, const gchar *resource_id, GError **error)
+{
+	remove_entry_by_resource_id (GDATA_ENTRY_STORE (self), resource_id);
+	return TRUE;
+}
+
+static void
+gdata_entry_store_documents_sync_store_init (GDataDocumentsSyncStoreInterface *iface)
+{
+	iface->get_changestamp = documents_sync_store_get_changestamp;
+	iface->set_changestamp = documents_sync_store_set_changestamp;
+	iface->apply_entry = documents_sync_store_apply_entry;
+	iface->remove_entry = documents_sync_store_remove_entry;
+}
+
+static void
+set_format_error (GError **error)
+{
+	g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+	             /* Translators: the parameter is an error message */
+	             _("Error parsing GVariant: %s"),
+	             /* Translators: this is a dummy error message to be substituted into "Error parsing GVariant: %s". */
+	             _("The data is not a valid entry store."));
+}
+
+/* Must be called before the store's used by anything else, so doesn't need to take the lock */
+static gboolean
+load_store (GDataEntryStore *self, GError **error)
+{
+	GDataEntryStorePrivate *priv = self->priv;
+	GVariant *store, *entry_variant;
+	GVariantIter *synced_types, *entries;
+	gchar *contents, *type_name;
+	gsize length;
+	guint32 version;
+	GError *child_error = NULL;
+
+	if (g_file_get_contents (priv->filename, &contents, &length, &child_error) == FALSE) {
+		/* A store which hasn't been saved yet starts off empty */
+		if (g_error_matches (child_error, G_FILE_ERROR, G_FILE_ERROR_NOENT) == TRUE) {
+			g_error_free (child_error);
+			return TRUE;
+		}
+
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	store = g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE (STORE_TYPE), contents, length, FALSE, g_free, contents));
+
+	g_variant_get_child (store, 0, "u", &version);
+	if (version != STORE_FORMAT_VERSION) {
+		set_format_error (error);
+		g_variant_unref (store);
+		return FALSE;
+	}
+
+	g_variant_get (store, "(uxxasa" STORED_ENTRY_TYPE ")", NULL, &(priv->contacts_watermark), &(priv->documents_changestamp), &synced_types,
+	               &entries);
+
+	while (g_variant_iter_next (synced_types, "s", &type_name) == TRUE)
+		g_hash_table_add (priv->synced_types, type_name);
+
+	while ((entry_variant = g_variant_iter_next_value (entries)) != NULL) {
+		StoredEntry *entry;
+		GVariant *times, *locations;
+		GVariantIter iter;
+		gint64 start_time, end_time;
+		gdouble latitude, longitude;
+
+		entry = g_slice_new0 (StoredEntry);
+		g_variant_get (entry_variant, STORED_ENTRY_TYPE, &(entry->type_name), &(entry->id), &(entry->scope), &(entry->resource_id),
+		               &(entry->updated), &(entry->published), NULL, NULL, NULL, NULL, NULL, &(entry->data));
+		g_variant_get_child (entry_variant, 6, "^as", &(entry->emails));
+		g_variant_get_child (entry_variant, 8, "^as", &(entry->parents));
+		g_variant_get_child (entry_variant, 9, "^as", &(entry->terms));
+
+		entry->times = g_array_new (FALSE, FALSE, sizeof (gint64));
+		entry->time_iters = g_ptr_array_new ();
+
+		times = g_variant_get_child_value (entry_variant, 7);
+		g_variant_iter_init (&iter, times);
+		while (g_variant_iter_next (&iter, "(xx)", &start_time, &end_time) == TRUE) {
+			g_array_append_val (entry->times, start_time);
+			g_array_append_val (entry->times, end_time);
+		}
+		g_variant_unref (times);
+
+		entry->locations = g_array_new (FALSE, FALSE, sizeof (gdouble));
+
+		locations = g_variant_get_child_value (entry_variant, 10);
+		g_variant_iter_init (&iter, locations);
+		while (g_variant_iter_next (&iter, "(dd)", &latitude, &longitude) == TRUE) {
+			g_array_append_val (entry->locations, latitude);
+			g_array_append_val (entry->locations, longitude);
+		}
+		g_variant_unref (locations);
+
+		/* Empty strings stand in for NULL */
+		if (*(entry->scope) == '\0')
+			g_clear_pointer (&(entry->scope), g_free);
+		if (*(entry->resource_id) == '\0')
+			g_clear_pointer (&(entry->resource_id), g_free);
+
+		add_stored_entry (priv, entry);
+
+		g_variant_unref (entry_variant);
+	}
+
+	g_variant_iter_free (synced_types);
+	g_variant_iter_free (entries);
+	g_variant_unref (store);
+
+	return TRUE;
+}
+
+/**
+ * gdata_entry_store_new:
+ * @filename: (allow-none): the file to load the store from and save it to, or %NULL to keep the store only in memory
+ * @error: a #GError, or %NULL
+ *
+ * Creates a new #GDataEntryStore. If @filename is non-%NULL and exists, the store is loaded from it; otherwise, the store starts off empty.
+ *
+ * If @filename can't be read, an error from #GFileError will be returned. If it isn't a valid entry store (or was saved by an incompatible
+ * version of libgdata), %GDATA_PARSER_ERROR_PARSING_STRING will be returned.
+ *
+ * Return value: (transfer full): a new #GDataEntryStore, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataEntryStore *
+gdata_entry_store_new (const gchar *filename, GError **error)
+{
+	GDataEntryStore *self;
+
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	self = g_object_new (GDATA_TYPE_ENTRY_STORE, "filename", filename, NULL);
+
+	if (filename != NULL && load_store (self, error) == FALSE) {
+		g_object_unref (self);
+		return NULL;
+	}
+
+	return self;
+}
+
+/**
+ * gdata_entry_store_save:
+ * @self: a #GDataEntryStore
+ * @error: a #GError, or %NULL
+ *
+ * Writes the store to its #GDataEntryStore:filename, replacing the file atomically. If the store doesn't have a filename, this does nothing.
+ *
+ * If the file can't be written, an error from #GFileError will be returned.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_entry_store_save (GDataEntryStore *self, GError **error)
+{
+	GDataEntryStorePrivate *priv;
+	GVariantBuilder synced_types, entries;
+	GHashTableIter iter;
+	GVariant *store;
+	const gchar *type_name;
+	StoredEntry *entry;
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = self->priv;
+
+	if (priv->filename == NULL)
+		return TRUE;
+
+	g_mutex_lock (&(priv->mutex));
+
+	g_variant_builder_init (&synced_types, G_VARIANT_TYPE_STRING_ARRAY);
+	g_hash_table_iter_init (&iter, priv->synced_types);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &type_name, NULL) == TRUE)
+		g_variant_builder_add (&synced_types, "s", type_name);
+
+	g_variant_builder_init (&entries, G_VARIANT_TYPE ("a" STORED_ENTRY_TYPE));
+	g_hash_table_iter_init (&iter, priv->entries);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &entry) == TRUE) {
+		GVariantBuilder times, locations;
+		guint i;
+
+		g_variant_builder_init (&times, G_VARIANT_TYPE ("a(xx)"));
+		for (i = 0; i + 1 < entry->times->len; i += 2)
+			g_variant_builder_add (&times, "(xx)", g_array_index (entry->times, gint64, i), g_array_index (entry->times, gint64, i + 1));
+
+		g_variant_builder_init (&locations, G_VARIANT_TYPE ("a(dd)"));
+		for (i = 0; i + 1 < entry->locations->len; i += 2) {
+			g_variant_builder_add (&locations, "(dd)", g_array_index (entry->locations, gdouble, i),
+			                       g_array_index (entry->locations, gdouble, i + 1));
+		}
+
+		g_variant_builder_add (&entries, "(ssssxx@as@a(xx)@as@as@a(dd)v)", entry->type_name, entry->id,
+		                       (entry->scope != NULL) ? entry->scope : "", (entry->resource_id != NULL) ? entry->resource_id : "",
+		                       entry->updated, entry->published, g_variant_new_strv ((const gchar * const *) entry->emails, -1),
+		                       g_variant_builder_end (&times), g_variant_new_strv ((const gchar * const *) entry->parents, -1),
+		                       g_variant_new_strv ((const gchar * const *) entry->terms, -1), g_variant_builder_end (&locations), entry->data);
+	}
+
+	store = g_variant_ref_sink (g_variant_new ("(uxx@as@a" STORED_ENTRY_TYPE ")", (guint32) STORE_FORMAT_VERSION, priv->contacts_watermark,
+	                                           priv->documents_changestamp, g_variant_builder_end (&synced_types),
+	                                           g_variant_builder_end (&entries)));
+
+	g_mutex_unlock (&(priv->mutex));
+
+	success = g_file_set_contents (priv->filename, g_variant_get_data (store), g_variant_get_size (store), error);
+	g_variant_unref (store);
+
+	return success;
+}
+
+/**
+ * gdata_entry_store_get_filename:
+ * @self: a #GDataEntryStore
+ *
+ * Gets the #GDataEntryStore:filename property.
+ *
+ * Return value: the file the store is loaded from and saved to, or %NULL
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+gdata_entry_store_get_filename (GDataEntryStore *self)
+{
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	return self->priv->filename;
+}
+
+/**
+ * gdata_entry_store_get_n_entries:
+ * @self: a #GDataEntryStore
+ *
+ * Gets the number of entries in the store.
+ *
+ * Return value: the number of entries in the store
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_entry_store_get_n_entries (GDataEntryStore *self)
+{
+	guint n_entries;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	n_entries = g_hash_table_size (self->priv->entries);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return n_entries;
+}
+
+/**
+ * gdata_entry_store_add_entry:
+ * @self: a #GDataEntryStore
+ * @entry: the #GDataEntry to add
+ *
+ * Adds @entry to the store, replacing any entry with the same #GDataEntry:id. The store keeps a serialised copy of @entry, so later changes to
+ * @entry don't affect the store.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_entry_store_add_entry (GDataEntryStore *self, GDataEntry *entry)
+{
+	g_return_if_fail (GDATA_IS_ENTRY_STORE (self));
+	g_return_if_fail (GDATA_IS_ENTRY (entry));
+	g_return_if_fail (gdata_entry_get_id (entry) != NULL);
+
+	add_entry (self, entry, NULL);
+}
+
+/**
+ * gdata_entry_store_remove_entry:
+ * @self: a #GDataEntryStore
+ * @entry_id: the ID of the entry to remove
+ *
+ * Removes the entry with the given ID from the store, if it's in the store.
+ *
+ * Return value: %TRUE if the entry was removed, %FALSE if it wasn't in the store
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_entry_store_remove_entry (GDataEntryStore *self, const gchar *entry_id)
+{
+	StoredEntry *entry;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), FALSE);
+	g_return_val_if_fail (entry_id != NULL, FALSE);
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	entry = g_hash_table_lookup (self->priv->entries, entry_id);
+	if (entry != NULL)
+		remove_stored_entry (self->priv, entry);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return (entry != NULL) ? TRUE : FALSE;
+}
+
+/**
+ * gdata_entry_store_get_entry:
+ * @self: a #GDataEntryStore
+ * @entry_id: the ID of the entry to look up
+ * @entry_type: the expected type of the entry, which must be a subclass of #GDataEntry
+ *
+ * Looks up the entry with the given ID in the store, without querying the server.
+ *
+ * Return value: (transfer full): the entry, or %NULL if the store doesn't contain an entry of type @entry_type with the given ID; unref with
+ * g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataEntry *
+gdata_entry_store_get_entry (GDataEntryStore *self, const gchar *entry_id, GType entry_type)
+{
+	StoredEntry *entry;
+	GArray *entries;
+	GList *list;
+	GDataEntry *result;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	g_return_val_if_fail (entry_id != NULL, NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+
+	entries = g_array_new (FALSE, FALSE, sizeof (EntryData));
+
+	g_mutex_lock (&(self->priv->mutex));
+	entry = g_hash_table_lookup (self->priv->entries, entry_id);
+	if (entry != NULL)
+		entry_data_add (entries, entry, entry_type);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	list = entry_data_free_to_list (entries);
+	result = (list != NULL) ? list->data : NULL;
+	g_list_free (list);
+
+	return result;
+}
+
+/**
+ * gdata_entry_store_find_contacts_by_email:
+ * @self: a #GDataEntryStore
+ * @address: the e-mail address to look for
+ *
+ * Finds the contacts in the store which have @address as one of their #GDataGDEmailAddress<!-- -->es. Addresses are compared
+ * case-insensitively.
+ *
+ * Return value: (element-type GDataContactsContact) (transfer full): the matching contacts, or %NULL; free with
+ * <literal>g_list_free_full (list, g_object_unref)</literal>
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_entry_store_find_contacts_by_email (GDataEntryStore *self, const gchar *address)
+{
+	GPtrArray *matches;
+	GArray *entries;
+	gchar *key;
+	guint i;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	g_return_val_if_fail (address != NULL, NULL);
+
+	key = g_utf8_strdown (address, -1);
+	entries = g_array_new (FALSE, FALSE, sizeof (EntryData));
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	matches = g_hash_table_lookup (self->priv->by_email, key);
+	for (i = 0; matches != NULL && i < matches->len; i++)
+		entry_data_add (entries, g_ptr_array_index (matches, i), GDATA_TYPE_CONTACTS_CONTACT);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_free (key);
+
+	return entry_data_free_to_list (entries);
+}
+
+/**
+ * gdata_entry_store_find_events:
+ * @self: a #GDataEntryStore
+ * @start_time: the start of the time range, as a UNIX timestamp
+ * @end_time: the end of the time range, as a UNIX timestamp
+ *
+ * Finds the calendar events in the store which have a #GDataGDWhen overlapping the half-open range [@start_time, @end_time). Events are returned
+ * in order of the start of their first overlapping time, and only once each.
+ *
+ * Return value: (element-type GDataCalendarEvent) (transfer full): the matching events, or %NULL; free with
+ * <literal>g_list_free_full (list, g_object_unref)</literal>
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_entry_store_find_events (GDataEntryStore *self, gint64 start_time, gint64 end_time)
+{
+	GHashTable *seen;
+	GArray *entries;
+	GSequenceIter *iter;
+	TimeSpan key;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	g_return_val_if_fail (start_time <= end_time, NULL);
+
+	entries = g_array_new (FALSE, FALSE, sizeof (EntryData));
+	seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	/* No span starting before this can overlap the range. The key sorts before every span with the same start time. */
+	key.start_time = start_time - self->priv->max_time_span;
+	key.end_time = G_MININT64;
+	key.entry = NULL;
+
+	for (iter = g_sequence_search (self->priv->by_time, &key, (GCompareDataFunc) compare_time_spans, NULL);
+	     g_sequence_iter_is_end (iter) == FALSE; iter = g_sequence_iter_next (iter)) {
+		TimeSpan *span = g_sequence_get (iter);
+
+		if (span->start_time >= end_time)
+			break;
+
+		/* Zero-length spans overlap the range if they start in it */
+		if ((span->end_time > start_time || span->start_time >= start_time) && g_hash_table_contains (seen, span->entry) == FALSE) {
+			g_hash_table_add (seen, span->entry);
+			entry_data_add (entries, span->entry, GDATA_TYPE_CALENDAR_EVENT);
+		}
+	}
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_hash_table_destroy (seen);
+
+	return entry_data_free_to_list (entries);
+}
+
+/**
+ * gdata_entry_store_find_documents_in_folder:
+ * @self: a #GDataEntryStore
+ * @folder_resource_id: the #GDataDocumentsEntry:resource-id of a folder
+ *
+ * Finds the documents in the store which are in the given folder, according to their parent links.
+ *
+ * Return value: (element-type GDataDocumentsEntry) (transfer full): the matching documents, or %NULL; free with
+ * <literal>g_list_free_full (list, g_object_unref)</literal>
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_entry_store_find_documents_in_folder (GDataEntryStore *self, const gchar *folder_resource_id)
+{
+	GPtrArray *matches;
+	GArray *entries;
+	guint i;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	g_return_val_if_fail (folder_resource_id != NULL, NULL);
+
+	entries = g_array_new (FALSE, FALSE, sizeof (EntryData));
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	matches = g_hash_table_lookup (self->priv->by_parent, folder_resource_id);
+	for (i = 0; matches != NULL && i < matches->len; i++)
+		entry_data_add (entries, g_ptr_array_index (matches, i), GDATA_TYPE_DOCUMENTS_ENTRY);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return entry_data_free_to_list (entries);
+}
+
+/* Returns the great-circle distance between two locations, in metres */
+static gdouble
+location_distance (gdouble latitude1, gdouble longitude1, gdouble latitude2, gdouble longitude2)
+{
+	gdouble sin_half_dlatitude, sin_half_dlongitude, a;
+
+	/* The haversine formula, which is accurate for small distances */
+	sin_half_dlatitude = sin ((latitude2 - latitude1) * G_PI / 360.0);
+	sin_half_dlongitude = sin ((longitude2 - longitude1) * G_PI / 360.0);
+	a = sin_half_dlatitude * sin_half_dlatitude +
+	    cos (latitude1 * G_PI / 180.0) * cos (latitude2 * G_PI / 180.0) * sin_half_dlongitude * sin_half_dlongitude;
+
+	return 2.0 * EARTH_RADIUS * asin (sqrt (MIN (a, 1.0)));
+}
+
+/* Must be called with the lock held. Adds the entries in @cell which have a location in the given box to @matches (as a set). */
+static void
+add_cell_matches (GeoCell *cell, gdouble min_latitude, gdouble min_longitude, gdouble max_latitude, gdouble max_longitude, GHashTable *matches)
+{
+	guint i, j;
+
+	for (i = 0; i < cell->entries->len; i++) {
+		StoredEntry *entry = g_ptr_array_index (cell->entries, i);
+
+		for (j = 0; j + 1 < entry->locations->len; j += 2) {
+			gdouble latitude = g_array_index (entry->locations, gdouble, j);
+			gdouble longitude = g_array_index (entry->locations, gdouble, j + 1);
+
+			if (latitude >= min_latitude && latitude <= max_latitude && longitude >= min_longitude && longitude <= max_longitude) {
+				g_hash_table_add (matches, entry);
+				break;
+			}
+		}
+	}
+}
+
+/* Must be called with the lock held. Adds the entries with a location in the given box to @matches (as a set), where @min_longitude is no greater
+ * than @max_longitude. Either each cell covering the box is looked up, or every non-empty cell is checked, whichever means checking fewer cells;
+ * so small boxes are quick however many entries are stored, and large boxes are no slower than a scan of the stored locations. */
+static void
+find_located_entries_in_box (GDataEntryStorePrivate *priv, gdouble min_latitude, gdouble min_longitude, gdouble max_latitude,
+                             gdouble max_longitude, GHashTable *matches)
+{
+	gint min_latitude_cell, max_latitude_cell, min_longitude_cell, max_longitude_cell;
+	GeoCell *cell;
+
+	min_latitude_cell = latitude_to_cell (min_latitude);
+	max_latitude_cell = latitude_to_cell (max_latitude);
+	min_longitude_cell = CLAMP ((gint) floor ((min_longitude + 180.0) * GEO_CELLS_PER_DEGREE), 0, GEO_N_LONGITUDE_CELLS - 1);
+	max_longitude_cell = CLAMP ((gint) floor ((max_longitude + 180.0) * GEO_CELLS_PER_DEGREE), 0, GEO_N_LONGITUDE_CELLS - 1);
+
+	if ((gint64) (max_latitude_cell - min_latitude_cell + 1) * (max_longitude_cell - min_longitude_cell + 1) <=
+	    (gint64) g_hash_table_size (priv->by_location)) {
+		gint i, j;
+
+		for (i = min_latitude_cell; i <= max_latitude_cell; i++) {
+			for (j = min_longitude_cell; j <= max_longitude_cell; j++) {
+				gint64 key = (gint64) i * GEO_N_LONGITUDE_CELLS + j;
+
+				cell = g_hash_table_lookup (priv->by_location, &key);
+				if (cell != NULL)
+					add_cell_matches (cell, min_latitude, min_longitude, max_latitude, max_longitude, matches);
+			}
+		}
+
+		/* Locations at 180° are indexed in the cell for -180° */
+		if (max_longitude >= 180.0 && min_longitude_cell > 0) {
+			for (i = min_latitude_cell; i <= max_latitude_cell; i++) {
+				gint64 key = (gint64) i * GEO_N_LONGITUDE_CELLS;
+
+				cell = g_hash_table_lookup (priv->by_location, &key);
+				if (cell != NULL)
+					add_cell_matches (cell, min_latitude, min_longitude, max_latitude, max_longitude, matches);
+			}
+		}
+	} else {
+		GHashTableIter iter;
+
+		g_hash_table_iter_init (&iter, priv->by_location);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &cell) == TRUE) {
+			gint latitude_cell = cell->key / GEO_N_LONGITUDE_CELLS;
+
+			if (latitude_cell >= min_latitude_cell && latitude_cell <= max_latitude_cell)
+				add_cell_matches (cell, min_latitude, min_longitude, max_latitude, max_longitude, matches);
+		}
+	}
+}
+
+/* Must be called with the lock held. As find_located_entries_in_box(), but if @west_longitude is greater than @east_longitude, the box is taken to
+ * cross the antimeridian. */
+static void
+find_located_entries (GDataEntryStorePrivate *priv, gdouble min_latitude, gdouble west_longitude, gdouble max_latitude, gdouble east_longitude,
+                      GHashTable *matches)
+{
+	if (west_longitude <= east_longitude) {
+		find_located_entries_in_box (priv, min_latitude, west_longitude, max_latitude, east_longitude, matches);
+	} else {
+		find_located_entries_in_box (priv, min_latitude, west_longitude, max_latitude, 180.0, matches);
+		find_located_entries_in_box (priv, min_latitude, -180.0, max_latitude, east_longitude, matches);
+	}
+}
+
+static gint
+compare_geo_matches (const GeoMatch *a, const GeoMatch *b, gpointer user_data)
+{
+	if (a->distance != b->distance)
+		return (a->distance < b->distance) ? -1 : 1;
+
+	return compare_entries_by_updated (a->entry, b->entry, user_data);
+}
+
+/**
+ * gdata_entry_store_find_entries_in_area:
+ * @self: a #GDataEntryStore
+ * @min_latitude: the latitude of the south edge of the area, in degrees
+ * @west_longitude: the longitude of the west edge of the area, in degrees
+ * @max_latitude: the latitude of the north edge of the area, in degrees
+ * @east_longitude: the longitude of the east edge of the area, in degrees
+ * @entry_type: the type of entries to return, which must be a subclass of #GDataEntry
+ * @max_results: the maximum number of entries to return, or <code class="literal">0</code> for no limit
+ *
+ * Finds the geotagged entries of type @entry_type in the store whose coordinates are inside the given area, including its edges. Latitudes must
+ * be between -90° and 90°, and longitudes between -180° and 180°. If @west_longitude is greater than @east_longitude, the area is taken to cross
+ * the antimeridian.
+ *
+ * The coordinates of #GDataPicasaWebAlbum<!-- -->s, #GDataPicasaWebFile<!-- -->s and #GDataYouTubeVideo<!-- -->s are indexed, so this is quick
+ * even for stores holding many entries.
+ *
+ * Return value: (element-type GDataEntry) (transfer full): the matching entries, in order of last update, most recent first; or %NULL; free
+ * with <literal>g_list_free_full (list, g_object_unref)</literal>
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_entry_store_find_entries_in_area (GDataEntryStore *self, gdouble min_latitude, gdouble west_longitude, gdouble max_latitude,
+                                        gdouble east_longitude, GType entry_type, guint max_results)
+{
+	GHashTable *matches;
+	GHashTableIter iter;
+	GPtrArray *sorted;
+	GArray *entries;
+	StoredEntry *entry;
+	guint i;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	g_return_val_if_fail (min_latitude >= -90.0 && min_latitude <= max_latitude && max_latitude <= 90.0, NULL);
+	g_return_val_if_fail (west_longitude >= -180.0 && west_longitude <= 180.0, NULL);
+	g_return_val_if_fail (east_longitude >= -180.0 && east_longitude <= 180.0, NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+
+	entries = g_array_new (FALSE, FALSE, sizeof (EntryData));
+	matches = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	find_located_entries (self->priv, min_latitude, west_longitude, max_latitude, east_longitude, matches);
+
+	sorted = g_ptr_array_sized_new (g_hash_table_size (matches));
+	g_hash_table_iter_init (&iter, matches);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &entry, NULL) == TRUE)
+		g_ptr_array_add (sorted, entry);
+	g_ptr_array_sort_with_data (sorted, (GCompareDataFunc) compare_stored_entries_by_updated, NULL);
+
+	for (i = 0; i < sorted->len && (max_results == 0 || entries->len < max_results); i++)
+		entry_data_add (entries, g_ptr_array_index (sorted, i), entry_type);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_ptr_array_free (sorted, TRUE);
+	g_hash_table_destroy (matches);
+
+	return entry_data_free_to_list (entries);
+}
+
+/**
+ * gdata_entry_store_find_entries_near:
+ * @self: a #GDataEntryStore
+ * @latitude: the latitude of the centre of the area, in degrees
+ * @longitude: the longitude of the centre of the area, in degrees
+ * @radius: the radius of the area, in metres
+ * @entry_type: the type of entries to return, which must be a subclass of #GDataEntry
+ * @max_results: the maximum number of entries to return, or <code class="literal">0</code> for no limit
+ *
+ * Finds the geotagged entries of type @entry_type in the store whose coordinates are no further than @radius from the given location, measured
+ * along the surface of the Earth. @latitude must be between -90° and 90°, and @longitude between -180° and 180°.
+ *
+ * As with gdata_entry_store_find_entries_in_area(), the coordinates of #GDataPicasaWebAlbum<!-- -->s, #GDataPicasaWebFile<!-- -->s and
+ * #GDataYouTubeVideo<!-- -->s are indexed, so this is quick even for stores holding many entries.
+ *
+ * Return value: (element-type GDataEntry) (transfer full): the matching entries, nearest first; or %NULL; free with
+ * <literal>g_list_free_full (list, g_object_unref)</literal>
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_entry_store_find_entries_near (GDataEntryStore *self, gdouble latitude, gdouble longitude, gdouble radius, GType entry_type,
+                                     guint max_results)
+{
+	GHashTable *candidates;
+	GHashTableIter iter;
+	GArray *matches, *entries;
+	StoredEntry *entry;
+	gdouble angle, min_latitude, max_latitude, west_longitude, east_longitude;
+	guint i, j;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	g_return_val_if_fail (latitude >= -90.0 && latitude <= 90.0, NULL);
+	g_return_val_if_fail (longitude >= -180.0 && longitude <= 180.0, NULL);
+	g_return_val_if_fail (radius >= 0.0, NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+
+	/* Work out the box bounding the circle, then check the distance of everything in it. The circle spans the angle @angle (in radians) from
+	 * its centre; if it covers a pole, the box covers all longitudes. */
+	angle = radius / EARTH_RADIUS;
+	min_latitude = latitude - angle * 180.0 / G_PI;
+	max_latitude = latitude + angle * 180.0 / G_PI;
+
+	if (min_latitude <= -90.0 || max_latitude >= 90.0 || angle >= G_PI / 2.0) {
+		min_latitude = MAX (min_latitude, -90.0);
+		max_latitude = MIN (max_latitude, 90.0);
+		west_longitude = -180.0;
+		east_longitude = 180.0;
+	} else {
+		gdouble longitude_span = asin (MIN (sin (angle) / cos (latitude * G_PI / 180.0), 1.0)) * 180.0 / G_PI;
+
+		west_longitude = longitude - longitude_span;
+		east_longitude = longitude + longitude_span;
+
+		if (east_longitude - west_longitude >= 360.0) {
+			west_longitude = -180.0;
+			east_longitude = 180.0;
+		} else {
+			if (west_longitude < -180.0)
+				west_longitude += 360.0;
+			if (east_longitude > 180.0)
+				east_longitude -= 360.0;
+		}
+	}
+
+	entries = g_array_new (FALSE, FALSE, sizeof (EntryData));
+	candidates = g_hash_table_new (g_direct_hash, g_direct_equal);
+	matches = g_array_new (FALSE, FALSE, sizeof (GeoMatch));
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	find_located_entries (self->priv, min_latitude, west_longitude, max_latitude, east_longitude, candidates);
+
+	g_hash_table_iter_init (&iter, candidates);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &entry, NULL) == TRUE) {
+		GeoMatch match;
+
+		match.entry = entry;
+		match.distance = G_MAXDOUBLE;
+
+		for (j = 0; j + 1 < entry->locations->len; j += 2) {
+			match.distance = MIN (match.distance, location_distance (latitude, longitude, g_array_index (entry->locations, gdouble, j),
+			                                                         g_array_index (entry->locations, gdouble, j + 1)));
+		}
+
+		if (match.distance <= radius)
+			g_array_append_val (matches, match);
+	}
+
+	g_array_sort_with_data (matches, (GCompareDataFunc) compare_geo_matches, NULL);
+
+	for (i = 0; i < matches->len && (max_results == 0 || entries->len < max_results); i++)
+		entry_data_add (entries, g_array_index (matches, GeoMatch, i).entry, entry_type);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_array_free (matches, TRUE);
+	g_hash_table_destroy (candidates);
+
+	return entry_data_free_to_list (entries);
+}
+
+/**
+ * gdata_entry_store_query_single_entry:
+ * @self: a #GDataEntryStore
+ * @service: the #GDataService to query if the entry isn't in the store
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @entry_id: the entry ID of the desired entry
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry class to represent the query result
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Returns the entry with the given ID from the store if it's there; otherwise, queries the server for it using
+ * gdata_service_query_single_entry(), and adds the result to the store. Queries which request a partial response (see #GDataQuery:fields) are
+ * always sent to the server, and their results aren't stored.
+ *
+ * Errors are as for gdata_service_query_single_entry().
+ *
+ * Return value: (transfer full): a #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataEntry *
+gdata_entry_store_query_single_entry (GDataEntryStore *self, GDataService *service, GDataAuthorizationDomain *domain, const gchar *entry_id,
+                                      GDataQuery *query, GType entry_type, GCancellable *cancellable, GError **error)
+{
+	GDataEntry *entry;
+	gboolean partial;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (entry_id != NULL, NULL);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	partial = (query != NULL && gdata_query_get_fields (query) != NULL) ? TRUE : FALSE;
+
+	if (partial == FALSE) {
+		entry = gdata_entry_store_get_entry (self, entry_id, entry_type);
+		if (entry != NULL)
+			return entry;
+	}
+
+	entry = gdata_service_query_single_entry (service, domain, entry_id, query, entry_type, cancellable, error);
+	if (entry != NULL && partial == FALSE && gdata_entry_get_id (entry) != NULL)
+		add_entry (self, entry, NULL);
+
+	return entry;
+}
+
+/* Must be called with the lock held. Returns the set of entries containing a term starting with @prefix. */
+static GHashTable *
+search_prefix (GDataEntryStorePrivate *priv, const gchar *prefix)
+{
+	GHashTable *matches;
+	GSequenceIter *iter, *previous;
+	Term key;
+
+	matches = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	/* Find the first term which is greater than or equal to @prefix; g_sequence_search() returns the position after any term equal to it */
+	key.term = (gchar*) prefix;
+	iter = g_sequence_search (priv->sorted_terms, &key, (GCompareDataFunc) compare_terms, NULL);
+
+	previous = g_sequence_iter_prev (iter);
+	if (previous != iter && strcmp (((Term*) g_sequence_get (previous))->term, prefix) == 0)
+		iter = previous;
+
+	for (; g_sequence_iter_is_end (iter) == FALSE; iter = g_sequence_iter_next (iter)) {
+		Term *term = g_sequence_get (iter);
+		guint i;
+
+		if (g_str_has_prefix (term->term, prefix) == FALSE)
+			break;
+
+		for (i = 0; i < term->entries->len; i++)
+			g_hash_table_add (matches, g_ptr_array_index (term->entries, i));
+	}
+
+	return matches;
+}
+
+/* Must be called with the lock held. Returns the set of entries which contain a term starting with each word in @text. */
+static GHashTable *
+search_entries (GDataEntryStorePrivate *priv, const gchar *text)
+{
+	GHashTable *matches = NULL;
+	gchar **tokens;
+	guint i;
+
+	tokens = tokenize (text);
+
+	for (i = 0; tokens[i] != NULL; i++) {
+		GHashTable *token_matches = search_prefix (priv, tokens[i]);
+
+		if (matches == NULL) {
+			matches = token_matches;
+		} else {
+			GHashTableIter iter;
+			StoredEntry *entry;
+
+			/* Only keep the entries which match every token */
+			g_hash_table_iter_init (&iter, matches);
+			while (g_hash_table_iter_next (&iter, (gpointer*) &entry, NULL) == TRUE) {
+				if (g_hash_table_contains (token_matches, entry) == FALSE)
+					g_hash_table_iter_remove (&iter);
+			}
+
+			g_hash_table_destroy (token_matches);
+		}
+
+		if (g_hash_table_size (matches) == 0)
+			break;
+	}
+
+	g_strfreev (tokens);
+
+	/* Searching for no words matches nothing */
+	if (matches == NULL)
+		matches = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	return matches;
+}
+
+/**
+ * gdata_entry_store_search:
+ * @self: a #GDataEntryStore
+ * @text: the words to search for
+ * @entry_type: the type of entries to return, which must be a subclass of #GDataEntry
+ * @max_results: the maximum number of entries to return, or <code class="literal">0</code> for no limit
+ *
+ * Searches the store for entries of type @entry_type which contain a word starting with each of the words in @text, ignoring case. The entries'
+ * titles and summaries are searched, along with contacts' names, nicknames and e-mail addresses. For example, searching for
+ * <literal>"jo sm"</literal> would match a contact named “John Smith”.
+ *
+ * This never queries the server; to fall back to querying the server for entries which haven't been synchronised into the store, use
+ * gdata_entry_store_query() with #GDataQuery:q set.
+ *
+ * Return value: (element-type GDataEntry) (transfer full): the matching entries, in order of last update, most recent first; or %NULL; free
+ * with <literal>g_list_free_full (list, g_object_unref)</literal>
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_entry_store_search (GDataEntryStore *self, const gchar *text, GType entry_type, guint max_results)
+{
+	GHashTable *matches;
+	GHashTableIter iter;
+	GPtrArray *sorted;
+	GArray *entries;
+	StoredEntry *entry;
+	guint i;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	g_return_val_if_fail (text != NULL, NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+
+	entries = g_array_new (FALSE, FALSE, sizeof (EntryData));
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	matches = search_entries (self->priv, text);
+
+	sorted = g_ptr_array_sized_new (g_hash_table_size (matches));
+	g_hash_table_iter_init (&iter, matches);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &entry, NULL) == TRUE)
+		g_ptr_array_add (sorted, entry);
+	g_ptr_array_sort_with_data (sorted, (GCompareDataFunc) compare_stored_entries_by_updated, NULL);
+
+	for (i = 0; i < sorted->len && (max_results == 0 || entries->len < max_results); i++)
+		entry_data_add (entries, g_ptr_array_index (sorted, i), entry_type);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_ptr_array_free (sorted, TRUE);
+	g_hash_table_destroy (matches);
+
+	return entry_data_free_to_list (entries);
+}
+
+/* Must be called with the lock held */
+static gboolean
+can_answer_query (GDataEntryStorePrivate *priv, GDataQuery *query, GType entry_type)
+{
+	GHashTableIter iter;
+	const gchar *type_name;
+
+	/* Subclasses' parameters (such as search filters and orderings) can't be evaluated locally */
+	if (query != NULL &&
+	    (G_OBJECT_TYPE (query) != GDATA_TYPE_QUERY || gdata_query_get_categories (query) != NULL ||
+	     gdata_query_get_author (query) != NULL || gdata_query_get_fields (query) != NULL)) {
+		return FALSE;
+	}
+
+	g_hash_table_iter_init (&iter, priv->synced_types);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &type_name, NULL) == TRUE) {
+		GType synced_type = g_type_from_name (type_name);
+
+		if (synced_type != 0 && g_type_is_a (entry_type, synced_type) == TRUE)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Must be called with the lock held. Adds the data for the entries matching @query to @entries. */
+static void
+answer_query (GDataEntryStorePrivate *priv, GDataQuery *query, GType entry_type, GArray *entries)
+{
+	GSequenceIter *iter;
+	GHashTable *matches = NULL;
+	gint64 updated_min = -1, updated_max = -1, published_min = -1, published_max = -1;
+	guint n_skipped = 0, start_index = 0, max_results = 0;
+
+	if (query != NULL) {
+		if (gdata_query_get_q (query) != NULL)
+			matches = search_entries (priv, gdata_query_get_q (query));
+
+		updated_min = gdata_query_get_updated_min (query);
+		updated_max = gdata_query_get_updated_max (query);
+		published_min = gdata_query_get_published_min (query);
+		published_max = gdata_query_get_published_max (query);
+		start_index = gdata_query_get_start_index (query);
+		max_results = gdata_query_get_max_results (query);
+	}
+
+	for (iter = g_sequence_get_begin_iter (priv->by_updated); g_sequence_iter_is_end (iter) == FALSE; iter = g_sequence_iter_next (iter)) {
+		StoredEntry *entry = g_sequence_get (iter);
+		guint old_len;
+
+		/* Entries are in order of last update, most recent first, so nothing after this can match */
+		if (updated_min != -1 && entry->updated < updated_min)
+			break;
+
+		if ((updated_max != -1 && entry->updated >= updated_max) ||
+		    (published_min != -1 && entry->published < published_min) ||
+		    (published_max != -1 && entry->published >= published_max) ||
+		    (matches != NULL && g_hash_table_contains (matches, entry) == FALSE)) {
+			continue;
+		}
+
+		old_len = entries->len;
+		entry_data_add (entries, entry, entry_type);
+
+		/* #GDataQuery:start-index is 1-based */
+		if (entries->len > old_len && start_index > 1 && n_skipped < start_index - 1) {
+			g_variant_unref (g_array_index (entries, EntryData, old_len).data);
+			g_array_set_size (entries, old_len);
+			n_skipped++;
+		}
+
+		if (max_results > 0 && entries->len >= max_results)
+			break;
+	}
+
+	if (matches != NULL)
+		g_hash_table_destroy (matches);
+}
+
+/**
+ * gdata_entry_store_query:
+ * @self: a #GDataEntryStore
+ * @service: the #GDataService to query if the store can't answer the query itself
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @feed_uri: the feed URI to query
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the results
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Answers the query from the store if it can (see the section documentation for the queries which can be answered locally); otherwise, queries
+ * the server using gdata_service_query(), and adds the returned entries to the store.
+ *
+ * Locally answered queries return a feed with @feed_uri as its ID and title, and no links.
+ *
+ * Errors are as for gdata_service_query().
+ *
+ * Return value: (transfer full): a #GDataFeed of query results, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataFeed *
+gdata_entry_store_query (GDataEntryStore *self, GDataService *service, GDataAuthorizationDomain *domain, const gchar *feed_uri,
+                         GDataQuery *query, GType entry_type, GCancellable *cancellable, GError **error)
+{
+	GDataFeed *feed;
+	GArray *entries;
+	GList *list, *i;
+	gboolean answered;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY_STORE (self), NULL);
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	entries = g_array_new (FALSE, FALSE, sizeof (EntryData));
+
+	g_mutex_lock (&(self->priv->mutex));
+	answered = can_answer_query (self->priv, query, entry_type);
+	if (answered == TRUE)
+		answer_query (self->priv, query, entry_type, entries);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	list = entry_data_free_to_list (entries);
+
+	if (answered == TRUE) {
+		feed = _gdata_feed_new (feed_uri, feed_uri, g_get_real_time () / G_USEC_PER_SEC);
+
+		for (i = list; i != NULL; i = i->next)
+			_gdata_feed_add_entry (feed, i->data);
+		g_list_free_full (list, g_object_unref);
+
+		return feed;
+	}
+
+	feed = gdata_service_query (service, domain, feed_uri, query, entry_type, cancellable, NULL, NULL, error);
+
+	/* Partial responses aren't stored, since they'd replace the complete entries */
+	if (feed != NULL && (query == NULL || gdata_query_get_fields (query) == NULL)) {
+		for (i = gdata_feed_get_entries (feed); i != NULL; i = i->next) {
+			if (gdata_entry_get_id (i->data) != NULL)
+				add_entry (self, i->data, NULL);
+		}
+	}
+
+	return feed;
+}
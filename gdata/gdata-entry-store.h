@@ -0,0 +1,100 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_ENTRY_STORE_H
+#define GDATA_ENTRY_STORE_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/gdata-service.h>
+#include <gdata/gdata-query.h>
+#include <gdata/gdata-feed.h>
+#include <gdata/gdata-entry.h>
+#include <gdata/gdata-authorization-domain.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_ENTRY_STORE			(gdata_entry_store_get_type ())
+#define GDATA_ENTRY_STORE(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_ENTRY_STORE, GDataEntryStore))
+#define GDATA_ENTRY_STORE_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_ENTRY_STORE, GDataEntryStoreClass))
+#define GDATA_IS_ENTRY_STORE(o)			(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_ENTRY_STORE))
+#define GDATA_IS_ENTRY_STORE_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_ENTRY_STORE))
+#define GDATA_ENTRY_STORE_GET_CLASS(o)		(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_ENTRY_STORE, GDataEntryStoreClass))
+
+typedef struct _GDataEntryStorePrivate	GDataEntryStorePrivate;
+
+/**
+ * GDataEntryStore:
+ *
+ * All the fields in the #GDataEntryStore structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataEntryStorePrivate *priv;
+} GDataEntryStore;
+
+/**
+ * GDataEntryStoreClass:
+ *
+ * All the fields in the #GDataEntryStoreClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataEntryStoreClass;
+
+GType gdata_entry_store_get_type (void) G_GNUC_CONST;
+
+GDataEntryStore *gdata_entry_store_new (const gchar *filename, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gboolean gdata_entry_store_save (GDataEntryStore *self, GError **error);
+
+const gchar *gdata_entry_store_get_filename (GDataEntryStore *self) G_GNUC_PURE;
+guint gdata_entry_store_get_n_entries (GDataEntryStore *self);
+
+void gdata_entry_store_add_entry (GDataEntryStore *self, GDataEntry *entry);
+gboolean gdata_entry_store_remove_entry (GDataEntryStore *self, const gchar *entry_id);
+GDataEntry *gdata_entry_store_get_entry (GDataEntryStore *self, const gchar *entry_id, GType entry_type) G_GNUC_WARN_UNUSED_RESULT;
+
+GList *gdata_entry_store_find_contacts_by_email (GDataEntryStore *self, const gchar *address) G_GNUC_WARN_UNUSED_RESULT;
+GList *gdata_entry_store_find_events (GDataEntryStore *self, gint64 start_time, gint64 end_time) G_GNUC_WARN_UNUSED_RESULT;
+GList *gdata_entry_store_find_documents_in_folder (GDataEntryStore *self, const gchar *folder_resource_id) G_GNUC_WARN_UNUSED_RESULT;
+GList *gdata_entry_store_find_entries_in_area (GDataEntryStore *self, gdouble min_latitude, gdouble west_longitude, gdouble max_latitude,
+                                               gdouble east_longitude, GType entry_type, guint max_results) G_GNUC_WARN_UNUSED_RESULT;
+GList *gdata_entry_store_find_entries_near (GDataEntryStore *self, gdouble latitude, gdouble longitude, gdouble radius, GType entry_type,
+                                            guint max_results) G_GNUC_WARN_UNUSED_RESULT;
+
+GList *gdata_entry_store_search (GDataEntryStore *self, const gchar *text, GType entry_type, guint max_results) G_GNUC_WARN_UNUSED_RESULT;
+
+GDataEntry *gdata_entry_store_query_single_entry (GDataEntryStore *self, GDataService *service, GDataAuthorizationDomain *domain,
+                                                  const gchar *entry_id, GDataQuery *query, GType entry_type,
+                                                  GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GDataFeed *gdata_entry_store_query (GDataEntryStore *self, GDataService *service, GDataAuthorizationDomain *domain, const gchar *feed_uri,
+                                    GDataQuery *query, GType entry_type, GCancellable *cancellable, GError **error)
+                                    G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+G_END_DECLS
+
+#endif /* !GDATA_ENTRY_STORE_H */
@@ -49,15 +49,22 @@ static void gdata_entry_dispose (GObject *object);
 static void gdata_entry_finalize (GObject *object);
 static void gdata_entry_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_entry_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+static void gdata_entry_notify (GObject *object, GParamSpec *pspec);
 static gboolean pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error);
 static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
 static gboolean post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error);
+static void register_elements (void);
+static void clone_private (GDataParsable *self, GDataParsable *clone);
+static void refresh_private (GDataEntry *self, GDataEntry *other);
+static void diff_private (GDataEntry *self, GDataEntry *other, GPtrArray *changes);
 static void pre_get_xml (GDataParsable *parsable, GString *xml_string);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
+static gboolean get_original_xml (GDataParsable *parsable, GString *xml_string);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 static gchar *get_entry_uri (const gchar *id) G_GNUC_WARN_UNUSED_RESULT;
 static gboolean parse_json (GDataParsable *parsable, JsonReader *reader, gpointer user_data, GError **error);
 static void get_json (GDataParsable *parsable, JsonBuilder *builder);
+static void write_json (GDataParsable *parsable, GString *json);
 
 struct _GDataEntryPrivate {
 	gchar *title;
@@ -70,12 +77,22 @@ struct _GDataEntryPrivate {
 	gchar *content;
 	gboolean content_is_uri;
 	GList *links; /* GDataLink */
+	GHashTable *links_by_rel; /* interned gchar* → owned GList of GDataLink, in the same order as ->links; built lazily */
 	GList *authors; /* GDataAuthor */
 	gchar *rights;
 
 	/* Batch processing data */
 	GDataBatchOperationType batch_operation_type;
 	guint batch_id;
+
+	/* Partial response selector the entry was retrieved with, or NULL if it's complete */
+	gchar *partial_fields;
+
+	/* Fields (element names, or member names for JSON entries) which have been modified locally since the entry was parsed, in the order they
+	 * were first modified; see _gdata_entry_mark_field_dirty() */
+	GPtrArray *dirty_fields; /* interned gchar* */
+	gboolean has_untracked_changes; /* TRUE if a property with no registered field has been modified */
+	gboolean refreshing; /* TRUE while _gdata_entry_refresh() is emitting notifications, which don't dirty the entry */
 };
 
 enum {
@@ -88,11 +105,18 @@ enum {
 	PROP_CONTENT,
 	PROP_IS_INSERTED,
 	PROP_RIGHTS,
-	PROP_CONTENT_URI
+	PROP_CONTENT_URI,
+	PROP_IS_PARTIAL
 };
 
 G_DEFINE_TYPE (GDataEntry, gdata_entry, GDATA_TYPE_PARSABLE)
 
+/* Property qdata holding the field which a property is serialised as; see _gdata_entry_class_set_property_field() */
+static GQuark property_field_quark = 0;
+static GQuark diff_func_quark = 0;
+static GQuark refresh_func_quark = 0;
+static const gchar ignored_field[] = "";
+
 static void
 gdata_entry_class_init (GDataEntryClass *klass)
 {
@@ -106,6 +130,7 @@ gdata_entry_class_init (GDataEntryClass *klass)
 	gobject_class->set_property = gdata_entry_set_property;
 	gobject_class->dispose = gdata_entry_dispose;
 	gobject_class->finalize = gdata_entry_finalize;
+	gobject_class->notify = gdata_entry_notify;
 
 	parsable_class->pre_parse_xml = pre_parse_xml;
 	parsable_class->parse_xml = parse_xml;
@@ -117,9 +142,19 @@ gdata_entry_class_init (GDataEntryClass *klass)
 
 	parsable_class->parse_json = parse_json;
 	parsable_class->get_json = get_json;
+	_gdata_parsable_class_set_json_write_func (parsable_class, write_json);
 
 	klass->get_entry_uri = get_entry_uri;
 
+	register_elements ();
+	_gdata_parsable_class_set_clone_func (parsable_class, clone_private);
+	_gdata_parsable_class_set_original_xml_func (parsable_class, get_original_xml);
+
+	property_field_quark = g_quark_from_static_string ("gdata-entry-property-field");
+	diff_func_quark = g_quark_from_static_string ("gdata-entry-diff-func");
+	refresh_func_quark = g_quark_from_static_string ("gdata-entry-refresh-func");
+	_gdata_entry_class_set_refresh_func (klass, refresh_private);
+
 	/**
 	 * GDataEntry:title:
 	 *
@@ -266,6 +301,37 @@ gdata_entry_class_init (GDataEntryClass *klass)
 	                                                      "Rights", "The ownership rights pertaining to the entry.",
 	                                                      NULL,
 	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataEntry:is-partial:
+	 *
+	 * Whether the entry only contains some of its fields, because it was returned by a query with #GDataQuery:fields set. Properties of a
+	 * partial entry which weren't selected by the query will be unset, regardless of their values on the server.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_IS_PARTIAL,
+	                                 g_param_spec_boolean ("is-partial",
+	                                                       "Partial?", "Whether the entry only contains some of its fields.",
+	                                                       FALSE,
+	                                                       G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+	/* Map the properties to the elements they're serialised as, so that only modified elements have to be sent by
+	 * gdata_service_patch_entry(). The rest are set by the server, so changing them locally doesn't need to be sent. */
+	_gdata_entry_class_set_property_field (klass, "title", "title");
+	_gdata_entry_class_set_property_field (klass, "summary", "summary");
+	_gdata_entry_class_set_property_field (klass, "content", "content");
+	_gdata_entry_class_set_property_field (klass, "content-uri", "content");
+	_gdata_entry_class_set_property_field (klass, "rights", "rights");
+	_gdata_entry_class_set_property_field (klass, "etag", NULL);
+	_gdata_entry_class_set_property_field (klass, "id", NULL);
+	_gdata_entry_class_set_property_field (klass, "updated", NULL);
+	_gdata_entry_class_set_property_field (klass, "published", NULL);
+	_gdata_entry_class_set_property_field (klass, "is-inserted", NULL);
+
+	/* Categories, links and authors aren't exposed as properties, so have to be diffed separately */
+	_gdata_entry_class_set_diff_func (klass, diff_private);
+	_gdata_entry_class_set_property_field (klass, "is-partial", NULL);
 }
 
 static void
@@ -295,6 +361,14 @@ gdata_entry_constructed (GObject *object)
 		parent_class->constructed (object);
 }
 
+static void
+invalidate_link_index (GDataEntryPrivate *priv)
+{
+	if (priv->links_by_rel != NULL)
+		g_hash_table_destroy (priv->links_by_rel);
+	priv->links_by_rel = NULL;
+}
+
 static void
 gdata_entry_dispose (GObject *object)
 {
@@ -306,6 +380,8 @@ gdata_entry_dispose (GObject *object)
 	}
 	priv->categories = NULL;
 
+	invalidate_link_index (priv);
+
 	if (priv->links != NULL) {
 		g_list_foreach (priv->links, (GFunc) g_object_unref, NULL);
 		g_list_free (priv->links);
@@ -322,6 +398,56 @@ gdata_entry_dispose (GObject *object)
 	G_OBJECT_CLASS (gdata_entry_parent_class)->dispose (object);
 }
 
+static GList *
+clone_parsable_list (GList *list)
+{
+	GList *clones = NULL, *i;
+
+	for (i = list; i != NULL; i = i->next)
+		clones = g_list_prepend (clones, gdata_parsable_clone (GDATA_PARSABLE (i->data)));
+
+	return g_list_reverse (clones);
+}
+
+static void
+clone_private (GDataParsable *self, GDataParsable *clone)
+{
+	GDataEntryPrivate *priv = GDATA_ENTRY (self)->priv, *clone_priv = GDATA_ENTRY (clone)->priv;
+	guint i;
+
+	/* Drop the kind category added by constructed(); @self's categories will include it */
+	g_list_free_full (clone_priv->categories, (GDestroyNotify) g_object_unref);
+	clone_priv->categories = clone_parsable_list (priv->categories);
+	clone_priv->links = clone_parsable_list (priv->links);
+	clone_priv->authors = clone_parsable_list (priv->authors);
+
+	clone_priv->title = g_strdup (priv->title);
+	clone_priv->summary = g_strdup (priv->summary);
+	clone_priv->id = g_strdup (priv->id);
+	clone_priv->etag = g_strdup (priv->etag);
+	clone_priv->updated = priv->updated;
+	clone_priv->published = priv->published;
+	clone_priv->content = g_strdup (priv->content);
+	clone_priv->content_is_uri = priv->content_is_uri;
+	clone_priv->rights = g_strdup (priv->rights);
+	clone_priv->batch_operation_type = priv->batch_operation_type;
+	clone_priv->batch_id = priv->batch_id;
+	clone_priv->partial_fields = g_strdup (priv->partial_fields);
+
+	/* The dirty fields are interned, so can be shared */
+	if (clone_priv->dirty_fields != NULL)
+		g_ptr_array_free (clone_priv->dirty_fields, TRUE);
+	clone_priv->dirty_fields = NULL;
+
+	if (priv->dirty_fields != NULL) {
+		clone_priv->dirty_fields = g_ptr_array_sized_new (priv->dirty_fields->len);
+		for (i = 0; i < priv->dirty_fields->len; i++)
+			g_ptr_array_add (clone_priv->dirty_fields, g_ptr_array_index (priv->dirty_fields, i));
+	}
+
+	clone_priv->has_untracked_changes = priv->has_untracked_changes;
+}
+
 static void
 gdata_entry_finalize (GObject *object)
 {
@@ -333,11 +459,31 @@ gdata_entry_finalize (GObject *object)
 	g_free (priv->etag);
 	g_free (priv->rights);
 	g_free (priv->content);
+	g_free (priv->partial_fields);
+
+	if (priv->dirty_fields != NULL)
+		g_ptr_array_free (priv->dirty_fields, TRUE);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_entry_parent_class)->finalize (object);
 }
 
+static void
+gdata_entry_notify (GObject *object, GParamSpec *pspec)
+{
+	/* Record which of the entry's fields has been modified. Properties from outside the entry class hierarchy, such as
+	 * GDataParsable:constructed-from-xml, don't describe the entry's content. */
+	if (g_type_is_a (pspec->owner_type, GDATA_TYPE_ENTRY) == TRUE && GDATA_ENTRY (object)->priv->refreshing == FALSE) {
+		const gchar *field = g_param_spec_get_qdata (pspec, property_field_quark);
+
+		if (field != ignored_field)
+			_gdata_entry_mark_field_dirty (GDATA_ENTRY (object), field);
+	}
+
+	if (G_OBJECT_CLASS (gdata_entry_parent_class)->notify != NULL)
+		G_OBJECT_CLASS (gdata_entry_parent_class)->notify (object, pspec);
+}
+
 static void
 gdata_entry_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
 {
@@ -374,6 +520,9 @@ gdata_entry_get_property (GObject *object, guint property_id, GValue *value, GPa
 		case PROP_RIGHTS:
 			g_value_set_string (value, priv->rights);
 			break;
+		case PROP_IS_PARTIAL:
+			g_value_set_boolean (value, gdata_entry_is_partial (GDATA_ENTRY (object)));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -427,46 +576,72 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 }
 
 static gboolean
-parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+parse_content (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
 {
-	gboolean success;
+	/* atom:content */
 	GDataEntryPrivate *priv = GDATA_ENTRY (parsable)->priv;
 
-	if (gdata_parser_is_namespace (node, "http://www.w3.org/2005/Atom") == TRUE) {
-		if (gdata_parser_string_from_element (node, "title", P_DEFAULT, &(priv->title), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "id", P_REQUIRED | P_NON_EMPTY | P_NO_DUPES, &(priv->id), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "summary", P_NONE, &(priv->summary), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "rights", P_NONE, &(priv->rights), &success, error) == TRUE ||
-		    gdata_parser_int64_time_from_element (node, "updated", P_REQUIRED | P_NO_DUPES, &(priv->updated), &success, error) == TRUE ||
-		    gdata_parser_int64_time_from_element (node, "published", P_REQUIRED | P_NO_DUPES, &(priv->published), &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "category", P_REQUIRED, GDATA_TYPE_CATEGORY,
-		                                             gdata_entry_add_category, parsable, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "link", P_REQUIRED, GDATA_TYPE_LINK,
-		                                             gdata_entry_add_link, parsable, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "author", P_REQUIRED, GDATA_TYPE_AUTHOR,
-		                                             gdata_entry_add_author, parsable, &success, error) == TRUE) {
-			return success;
-		} else if (xmlStrcmp (node->name, (xmlChar*) "content") == 0) {
-			/* atom:content */
-			priv->content = (gchar*) xmlGetProp (node, (xmlChar*) "src");
-			priv->content_is_uri = TRUE;
-
-			if (priv->content == NULL) {
-				priv->content = (gchar*) xmlNodeListGetString (doc, node->children, TRUE);
-				priv->content_is_uri = FALSE;
-			}
-
-			return TRUE;
-		}
-	} else if (gdata_parser_is_namespace (node, "http://schemas.google.com/gdata/batch") == TRUE) {
-		if (xmlStrcmp (node->name, (xmlChar*) "id") == 0 ||
-		    xmlStrcmp (node->name, (xmlChar*) "status") == 0 ||
-		    xmlStrcmp (node->name, (xmlChar*) "operation") == 0) {
-			/* Ignore batch operation elements; they're handled in GDataBatchFeed */
-			return TRUE;
-		}
+	priv->content = (gchar*) xmlGetProp (node, (xmlChar*) "src");
+	priv->content_is_uri = TRUE;
+
+	if (priv->content == NULL) {
+		priv->content = (gchar*) xmlNodeListGetString (doc, node->children, TRUE);
+		priv->content_is_uri = FALSE;
 	}
 
+	return TRUE;
+}
+
+static gboolean
+parse_batch_element (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* Ignore batch operation elements; they're handled in GDataBatchFeed. They mustn't be output again as part of another batch operation,
+	 * though. */
+	_gdata_parsable_forget_original_xml (parsable);
+	return TRUE;
+}
+
+#define ATOM "http://www.w3.org/2005/Atom"
+#define BATCH "http://schemas.google.com/gdata/batch"
+
+/* The elements parsed by parse_xml(). They're all output by get_xml() itself, as most need attributes. */
+static const GDataParserSchemaElement entry_schema[] = {
+	P_SCHEMA_STRING_ELEMENT (ATOM, "title", NULL, P_DEFAULT, GDataEntryPrivate, title),
+	P_SCHEMA_STRING_ELEMENT (ATOM, "id", NULL, P_REQUIRED | P_NON_EMPTY | P_NO_DUPES, GDataEntryPrivate, id),
+	P_SCHEMA_STRING_ELEMENT (ATOM, "summary", NULL, P_NONE, GDataEntryPrivate, summary),
+	P_SCHEMA_STRING_ELEMENT (ATOM, "rights", NULL, P_NONE, GDataEntryPrivate, rights),
+	P_SCHEMA_INT64_TIME_ELEMENT (ATOM, "updated", NULL, P_REQUIRED | P_NO_DUPES, GDataEntryPrivate, updated),
+	P_SCHEMA_INT64_TIME_ELEMENT (ATOM, "published", NULL, P_REQUIRED | P_NO_DUPES, GDataEntryPrivate, published),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (ATOM, "category", P_REQUIRED, gdata_category_get_type, gdata_entry_add_category),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (ATOM, "link", P_REQUIRED, gdata_link_get_type, gdata_entry_add_link),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (ATOM, "author", P_REQUIRED, gdata_author_get_type, gdata_entry_add_author),
+	P_SCHEMA_FUNC_ELEMENT (ATOM, "content", NULL, parse_content, NULL),
+
+	P_SCHEMA_FUNC_ELEMENT (BATCH, "id", NULL, parse_batch_element, NULL),
+	P_SCHEMA_FUNC_ELEMENT (BATCH, "status", NULL, parse_batch_element, NULL),
+	P_SCHEMA_FUNC_ELEMENT (BATCH, "operation", NULL, parse_batch_element, NULL),
+
+	P_SCHEMA_END
+};
+
+#undef BATCH
+#undef ATOM
+
+static void
+register_elements (void)
+{
+	gdata_parser_register_schema (GDATA_TYPE_ENTRY, entry_schema);
+}
+
+static gboolean
+parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	gboolean success;
+
+	/* The elements we understand are listed in entry_schema */
+	if (gdata_parser_dispatch_element (GDATA_TYPE_ENTRY, parsable, doc, node, user_data, &success, error) == TRUE)
+		return success;
+
 	return GDATA_PARSABLE_CLASS (gdata_entry_parent_class)->parse_xml (parsable, doc, node, user_data, error);
 }
 
@@ -489,6 +664,8 @@ post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error)
 	priv->links = g_list_reverse (priv->links);
 	priv->authors = g_list_reverse (priv->authors);
 
+	invalidate_link_index (priv);
+
 	return TRUE;
 }
 
@@ -500,6 +677,46 @@ pre_get_xml (GDataParsable *parsable, GString *xml_string)
 	/* Add the entry's ETag, if available */
 	if (gdata_entry_get_etag (GDATA_ENTRY (parsable)) != NULL)
 		gdata_parser_string_append_escaped (xml_string, " gd:etag='", priv->etag, "'");
+
+	/* Declare the batch namespace here rather than in get_namespaces(), so that the class' namespaces don't depend on whether the entry is in a
+	 * batch operation, and can be cached */
+	if (priv->batch_id != 0)
+		g_string_append (xml_string, " xmlns:batch='http://schemas.google.com/gdata/batch'");
+
+	/* Tell the server which fields are present when doing a partial update */
+	if (priv->partial_fields != NULL)
+		gdata_parser_string_append_escaped (xml_string, " gd:fields='", priv->partial_fields, "'");
+}
+
+/* Appends the elements describing the batch operation @self is part of, if any */
+static void
+append_batch_elements (GDataEntry *self, GString *xml_string)
+{
+	GDataEntryPrivate *priv = self->priv;
+	const gchar *batch_op;
+
+	if (priv->batch_id == 0)
+		return;
+
+	switch (priv->batch_operation_type) {
+		case GDATA_BATCH_OPERATION_QUERY:
+			batch_op = "query";
+			break;
+		case GDATA_BATCH_OPERATION_INSERTION:
+			batch_op = "insert";
+			break;
+		case GDATA_BATCH_OPERATION_UPDATE:
+			batch_op = "update";
+			break;
+		case GDATA_BATCH_OPERATION_DELETION:
+			batch_op = "delete";
+			break;
+		default:
+			g_assert_not_reached ();
+			break;
+	}
+
+	g_string_append_printf (xml_string, "<batch:id>%u</batch:id><batch:operation type='%s'/>", priv->batch_id, batch_op);
 }
 
 static void
@@ -514,15 +731,21 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 		gdata_parser_string_append_escaped (xml_string, "<id>", priv->id, "</id>");
 
 	if (priv->updated != -1) {
-		gchar *updated = gdata_parser_int64_to_iso8601 (priv->updated);
-		g_string_append_printf (xml_string, "<updated>%s</updated>", updated);
-		g_free (updated);
+		gchar updated[GDATA_PARSER_ISO8601_BUFFER_SIZE];
+		gsize length = gdata_parser_int64_to_iso8601_buffer (priv->updated, updated);
+
+		g_string_append (xml_string, "<updated>");
+		g_string_append_len (xml_string, updated, length);
+		g_string_append (xml_string, "</updated>");
 	}
 
 	if (priv->published != -1) {
-		gchar *published = gdata_parser_int64_to_iso8601 (priv->published);
-		g_string_append_printf (xml_string, "<published>%s</published>", published);
-		g_free (published);
+		gchar published[GDATA_PARSER_ISO8601_BUFFER_SIZE];
+		gsize length = gdata_parser_int64_to_iso8601_buffer (priv->published, published);
+
+		g_string_append (xml_string, "<published>");
+		g_string_append_len (xml_string, published, length);
+		g_string_append (xml_string, "</published>");
 	}
 
 	if (priv->summary != NULL)
@@ -547,39 +770,25 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 	for (authors = priv->authors; authors != NULL; authors = authors->next)
 		_gdata_parsable_get_xml (GDATA_PARSABLE (authors->data), xml_string, FALSE);
 
-	/* Batch operation data */
-	if (priv->batch_id != 0) {
-		const gchar *batch_op;
-
-		switch (priv->batch_operation_type) {
-			case GDATA_BATCH_OPERATION_QUERY:
-				batch_op = "query";
-				break;
-			case GDATA_BATCH_OPERATION_INSERTION:
-				batch_op = "insert";
-				break;
-			case GDATA_BATCH_OPERATION_UPDATE:
-				batch_op = "update";
-				break;
-			case GDATA_BATCH_OPERATION_DELETION:
-				batch_op = "delete";
-				break;
-			default:
-				g_assert_not_reached ();
-				break;
-		}
+	append_batch_elements (GDATA_ENTRY (parsable), xml_string);
+}
 
-		g_string_append_printf (xml_string, "<batch:id>%u</batch:id><batch:operation type='%s'/>", priv->batch_id, batch_op);
-	}
+static gboolean
+get_original_xml (GDataParsable *parsable, GString *xml_string)
+{
+	/* Changes to the lists of categories, links and authors don't notify any properties */
+	if (gdata_entry_is_dirty (GDATA_ENTRY (parsable)) == TRUE)
+		return FALSE;
+
+	append_batch_elements (GDATA_ENTRY (parsable), xml_string);
+
+	return TRUE;
 }
 
 static void
 get_namespaces (GDataParsable *parsable, GHashTable *namespaces)
 {
 	g_hash_table_insert (namespaces, (gchar*) "gd", (gchar*) "http://schemas.google.com/g/2005");
-
-	if (GDATA_ENTRY (parsable)->priv->batch_id != 0)
-		g_hash_table_insert (namespaces, (gchar*) "batch", (gchar*) "http://schemas.google.com/gdata/batch");
 }
 
 static gchar *
@@ -682,6 +891,40 @@ get_json (GDataParsable *parsable, JsonBuilder *builder)
 	}
 }
 
+/* Equivalent to get_json(), but writing the members straight into @json */
+static void
+write_json (GDataParsable *parsable, GString *json)
+{
+	GDataEntryPrivate *priv = GDATA_ENTRY (parsable)->priv;
+	GList *i;
+	GDataLink *_link;
+
+	_gdata_parsable_json_append_member_string (json, "title", priv->title);
+
+	if (priv->id != NULL)
+		_gdata_parsable_json_append_member_string (json, "id", priv->id);
+
+	if (priv->updated != -1) {
+		gchar *updated = gdata_parser_int64_to_json_iso8601 (priv->updated);
+		_gdata_parsable_json_append_member_string (json, "updated", updated);
+		g_free (updated);
+	}
+
+	for (i = priv->categories; i != NULL; i = i->next) {
+		GDataCategory *category = GDATA_CATEGORY (i->data);
+
+		if (g_strcmp0 (gdata_category_get_scheme (category), "http://schemas.google.com/g/2005#kind") == 0)
+			_gdata_parsable_json_append_member_string (json, "kind", gdata_category_get_term (category));
+	}
+
+	if (gdata_entry_get_etag (GDATA_ENTRY (parsable)) != NULL)
+		_gdata_parsable_json_append_member_string (json, "etag", priv->etag);
+
+	_link = gdata_entry_look_up_link (GDATA_ENTRY (parsable), GDATA_LINK_SELF);
+	if (_link != NULL)
+		_gdata_parsable_json_append_member_string (json, "selfLink", gdata_link_get_uri (_link));
+}
+
 /**
  * gdata_entry_new:
  * @id: (allow-none): the entry's ID, or %NULL
@@ -890,8 +1133,10 @@ gdata_entry_add_category (GDataEntry *self, GDataCategory *category)
 	}
 
 	/* Add the category if we don't already have it */
-	if (g_list_find_custom (self->priv->categories, category, (GCompareFunc) gdata_comparable_compare) == NULL)
+	if (g_list_find_custom (self->priv->categories, category, (GCompareFunc) gdata_comparable_compare) == NULL) {
 		self->priv->categories = g_list_prepend (self->priv->categories, g_object_ref (category));
+		_gdata_entry_mark_field_dirty (self, "category");
+	}
 }
 
 /**
@@ -908,6 +1153,10 @@ GList *
 gdata_entry_get_categories (GDataEntry *self)
 {
 	g_return_val_if_fail (GDATA_IS_ENTRY (self), NULL);
+
+	/* The entry's categories may be shared with other entries in its feed, so give out private copies, which can be modified */
+	_gdata_parsable_unshare_list (GDATA_PARSABLE (self), self->priv->categories);
+
 	return self->priv->categories;
 }
 
@@ -925,6 +1174,10 @@ GList *
 gdata_entry_get_authors (GDataEntry *self)
 {
 	g_return_val_if_fail (GDATA_IS_ENTRY (self), NULL);
+
+	/* The entry's authors may be shared with other entries in its feed, so give out private copies, which can be modified */
+	_gdata_parsable_unshare_list (GDATA_PARSABLE (self), self->priv->authors);
+
 	return self->priv->authors;
 }
 
@@ -1024,8 +1277,11 @@ gdata_entry_add_link (GDataEntry *self, GDataLink *_link)
 	g_return_if_fail (GDATA_IS_ENTRY (self));
 	g_return_if_fail (GDATA_IS_LINK (_link));
 
-	if (g_list_find_custom (self->priv->links, _link, (GCompareFunc) gdata_comparable_compare) == NULL)
+	if (g_list_find_custom (self->priv->links, _link, (GCompareFunc) gdata_comparable_compare) == NULL) {
+		invalidate_link_index (self->priv);
 		self->priv->links = g_list_prepend (self->priv->links, g_object_ref (_link));
+		_gdata_entry_mark_field_dirty (self, "link");
+	}
 }
 
 /**
@@ -1054,16 +1310,38 @@ gdata_entry_remove_link (GDataEntry *self, GDataLink *_link)
 		return FALSE;
 	}
 
+	invalidate_link_index (self->priv);
 	self->priv->links = g_list_delete_link (self->priv->links, i);
 	g_object_unref (_link);
+	_gdata_entry_mark_field_dirty (self, "link");
 
 	return TRUE;
 }
 
-static gint
-link_compare_cb (const GDataLink *_link, const gchar *rel)
+/* Returns the links with relation type @rel (which must be interned), in order, from the index of the entry's links; building the index if needed */
+static GList *
+look_up_indexed_links (GDataEntry *self, const gchar *rel)
 {
-	return strcmp (gdata_link_get_relation_type ((GDataLink*) _link), rel);
+	GDataEntryPrivate *priv = self->priv;
+
+	if (priv->links_by_rel == NULL) {
+		GList *i;
+
+		priv->links_by_rel = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_list_free);
+
+		/* Build the lists backwards so they can be prepended to; relation types are interned by GDataLink, so the keys can be compared by
+		 * pointer */
+		for (i = g_list_last (priv->links); i != NULL; i = i->prev) {
+			const gchar *relation_type = gdata_link_get_relation_type (GDATA_LINK (i->data));
+			GList *links;
+
+			links = g_hash_table_lookup (priv->links_by_rel, relation_type);
+			g_hash_table_steal (priv->links_by_rel, relation_type);
+			g_hash_table_insert (priv->links_by_rel, (gpointer) relation_type, g_list_prepend (links, i->data));
+		}
+	}
+
+	return g_hash_table_lookup (priv->links_by_rel, rel);
 }
 
 /**
@@ -1083,15 +1361,21 @@ link_compare_cb (const GDataLink *_link, const gchar *rel)
 GDataLink *
 gdata_entry_look_up_link (GDataEntry *self, const gchar *rel)
 {
-	GList *element;
+	GList *links;
+	GQuark quark;
 
 	g_return_val_if_fail (GDATA_IS_ENTRY (self), NULL);
 	g_return_val_if_fail (rel != NULL, NULL);
 
-	element = g_list_find_custom (self->priv->links, rel, (GCompareFunc) link_compare_cb);
-	if (element == NULL)
+	/* If @rel has never been interned, no link can have it as its relation type */
+	quark = g_quark_try_string (rel);
+	if (quark == 0)
 		return NULL;
-	return GDATA_LINK (element->data);
+
+	links = look_up_indexed_links (self, g_quark_to_string (quark));
+	if (links == NULL)
+		return NULL;
+	return GDATA_LINK (links->data);
 }
 
 /**
@@ -1112,18 +1396,16 @@ gdata_entry_look_up_link (GDataEntry *self, const gchar *rel)
 GList *
 gdata_entry_look_up_links (GDataEntry *self, const gchar *rel)
 {
-	GList *i, *results = NULL;
+	GQuark quark;
 
 	g_return_val_if_fail (GDATA_IS_ENTRY (self), NULL);
 	g_return_val_if_fail (rel != NULL, NULL);
 
-	for (i = self->priv->links; i != NULL; i = i->next) {
-		const gchar *relation_type = gdata_link_get_relation_type (((GDataLink*) i->data));
-		if (strcmp (relation_type, rel) == 0)
-			results = g_list_prepend (results, i->data);
-	}
+	quark = g_quark_try_string (rel);
+	if (quark == 0)
+		return NULL;
 
-	return g_list_reverse (results);
+	return g_list_copy (look_up_indexed_links (self, g_quark_to_string (quark)));
 }
 
 /**
@@ -1142,8 +1424,10 @@ gdata_entry_add_author (GDataEntry *self, GDataAuthor *author)
 	g_return_if_fail (GDATA_IS_ENTRY (self));
 	g_return_if_fail (GDATA_IS_AUTHOR (author));
 
-	if (g_list_find_custom (self->priv->authors, author, (GCompareFunc) gdata_comparable_compare) == NULL)
+	if (g_list_find_custom (self->priv->authors, author, (GCompareFunc) gdata_comparable_compare) == NULL) {
 		self->priv->authors = g_list_prepend (self->priv->authors, g_object_ref (author));
+		_gdata_entry_mark_field_dirty (self, "author");
+	}
 }
 
 /**
@@ -1164,6 +1448,434 @@ gdata_entry_is_inserted (GDataEntry *self)
 	return FALSE;
 }
 
+/**
+ * gdata_entry_is_partial:
+ * @self: a #GDataEntry
+ *
+ * Returns whether the entry only contains some of its fields, because it was returned by a query with #GDataQuery:fields set. See
+ * #GDataEntry:is-partial.
+ *
+ * Return value: %TRUE if the entry is partial, %FALSE if it's complete
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_entry_is_partial (GDataEntry *self)
+{
+	g_return_val_if_fail (GDATA_IS_ENTRY (self), FALSE);
+	return (self->priv->partial_fields != NULL) ? TRUE : FALSE;
+}
+
+/**
+ * gdata_entry_is_dirty:
+ * @self: a #GDataEntry
+ *
+ * Returns whether the entry has been modified locally since it was retrieved from the server. Only modifications made through the entry's own
+ * API are tracked: modifying an object it contains (such as one of its #GDataLink<!-- -->s) in place isn't noticed. Entries which were created
+ * locally are dirty as soon as any of their properties are set.
+ *
+ * A dirty entry can be sent to the server using gdata_service_patch_entry(), which only uploads the modified fields.
+ *
+ * Return value: %TRUE if the entry has local modifications, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_entry_is_dirty (GDataEntry *self)
+{
+	g_return_val_if_fail (GDATA_IS_ENTRY (self), FALSE);
+	return (self->priv->dirty_fields != NULL || self->priv->has_untracked_changes == TRUE) ? TRUE : FALSE;
+}
+
+static gboolean parsables_equal (GDataParsable *a, GDataParsable *b);
+
+static gboolean
+values_equal (GParamSpec *pspec, const GValue *a, const GValue *b)
+{
+	if (G_VALUE_HOLDS_OBJECT (a) == TRUE) {
+		GObject *object_a = g_value_get_object (a), *object_b = g_value_get_object (b);
+
+		/* Compare child parsables (such as a contact's name) structurally, rather than by identity */
+		if (object_a != NULL && object_b != NULL && GDATA_IS_PARSABLE (object_a) && GDATA_IS_PARSABLE (object_b))
+			return parsables_equal (GDATA_PARSABLE (object_a), GDATA_PARSABLE (object_b));
+	} else if (G_VALUE_HOLDS (a, G_TYPE_DATE) == TRUE) {
+		GDate *date_a = g_value_get_boxed (a), *date_b = g_value_get_boxed (b);
+
+		if (date_a == NULL || date_b == NULL || g_date_valid (date_a) == FALSE || g_date_valid (date_b) == FALSE)
+			return (date_a == date_b) ? TRUE : FALSE;
+		return (g_date_compare (date_a, date_b) == 0) ? TRUE : FALSE;
+	}
+
+	/* Boxed values other than dates are compared by identity, so may be reported as changed when they aren't */
+	return (g_param_values_cmp (pspec, a, b) == 0) ? TRUE : FALSE;
+}
+
+static gboolean
+property_equal (GObject *a, GObject *b, GParamSpec *pspec)
+{
+	GValue value_a = G_VALUE_INIT, value_b = G_VALUE_INIT;
+	gboolean equal;
+
+	g_value_init (&value_a, G_PARAM_SPEC_VALUE_TYPE (pspec));
+	g_value_init (&value_b, G_PARAM_SPEC_VALUE_TYPE (pspec));
+	g_object_get_property (a, pspec->name, &value_a);
+	g_object_get_property (b, pspec->name, &value_b);
+
+	equal = values_equal (pspec, &value_a, &value_b);
+
+	g_value_unset (&value_b);
+	g_value_unset (&value_a);
+
+	return equal;
+}
+
+/* Whether the properties of @a and @b are all equal, ignoring those of #GDataParsable itself */
+static gboolean
+parsables_equal (GDataParsable *a, GDataParsable *b)
+{
+	GParamSpec **pspecs;
+	guint i, n_pspecs;
+	gboolean equal = TRUE;
+
+	if (a == b)
+		return TRUE;
+	else if (G_OBJECT_TYPE (a) != G_OBJECT_TYPE (b))
+		return FALSE;
+
+	pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (a), &n_pspecs);
+
+	for (i = 0; i < n_pspecs && equal == TRUE; i++) {
+		if (pspecs[i]->owner_type != GDATA_TYPE_PARSABLE && (pspecs[i]->flags & G_PARAM_READABLE) != 0)
+			equal = property_equal (G_OBJECT (a), G_OBJECT (b), pspecs[i]);
+	}
+
+	g_free (pspecs);
+
+	return equal;
+}
+
+static gboolean
+parsable_lists_equal (GList *a, GList *b)
+{
+	for (; a != NULL && b != NULL; a = a->next, b = b->next) {
+		if (parsables_equal (GDATA_PARSABLE (a->data), GDATA_PARSABLE (b->data)) == FALSE)
+			return FALSE;
+	}
+
+	return (a == NULL && b == NULL) ? TRUE : FALSE;
+}
+
+static void
+diff_private (GDataEntry *self, GDataEntry *other, GPtrArray *changes)
+{
+	if (parsable_lists_equal (self->priv->categories, other->priv->categories) == FALSE)
+		g_ptr_array_add (changes, g_strdup ("categories"));
+	if (parsable_lists_equal (self->priv->links, other->priv->links) == FALSE)
+		g_ptr_array_add (changes, g_strdup ("links"));
+	if (parsable_lists_equal (self->priv->authors, other->priv->authors) == FALSE)
+		g_ptr_array_add (changes, g_strdup ("authors"));
+}
+
+static gchar *
+get_serialisation (GDataEntry *self)
+{
+	GDataParsableClass *klass = GDATA_PARSABLE_GET_CLASS (self);
+
+	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0)
+		return gdata_parsable_get_json (GDATA_PARSABLE (self));
+	return gdata_parsable_get_xml (GDATA_PARSABLE (self));
+}
+
+/**
+ * gdata_entry_diff:
+ * @self: a #GDataEntry
+ * @other: another #GDataEntry of the same type as @self
+ *
+ * Works out which properties of @self differ from those of @other, for example to find what has changed between a cached copy of an entry and
+ * the copy which was just retrieved from the server. Properties which are objects (such as a contact's name) are compared by value, as are the
+ * entry's categories, links and authors, which are listed as <literal>categories</literal>, <literal>links</literal> and <literal>authors</literal>
+ * respectively. Unhandled XML isn't compared.
+ *
+ * If @self and @other have the same ETag and neither has been modified locally (see gdata_entry_is_dirty()), they're assumed to be equal without
+ * comparing them any further.
+ *
+ * Some entry types contain data which isn't exposed as properties and which can't be diffed. If @self and @other differ in such data, %NULL is
+ * returned, and the entries have to be treated as differing in full.
+ *
+ * Return value: (transfer full): a %NULL-terminated array of the names of the properties which differ, which is empty if the entries are equal; or
+ * %NULL if the differences can't be expressed as a set of properties; free with g_strfreev()
+ *
+ * Since: 0.15.0
+ **/
+gchar **
+gdata_entry_diff (GDataEntry *self, GDataEntry *other)
+{
+	GPtrArray *changes;
+	GParamSpec **pspecs;
+	guint i, n_pspecs;
+	GType type;
+	gboolean fully_diffable = TRUE;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY (self), NULL);
+	g_return_val_if_fail (GDATA_IS_ENTRY (other), NULL);
+	g_return_val_if_fail (G_OBJECT_TYPE (self) == G_OBJECT_TYPE (other), NULL);
+
+	changes = g_ptr_array_new ();
+
+	/* The ETag changes whenever the server's copy of the entry changes */
+	if (self == other ||
+	    (self->priv->etag != NULL && g_strcmp0 (self->priv->etag, other->priv->etag) == 0 &&
+	     gdata_entry_is_dirty (self) == FALSE && gdata_entry_is_dirty (other) == FALSE)) {
+		g_ptr_array_add (changes, NULL);
+		return (gchar**) g_ptr_array_free (changes, FALSE);
+	}
+
+	pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (self), &n_pspecs);
+
+	for (i = 0; i < n_pspecs; i++) {
+		if (g_type_is_a (pspecs[i]->owner_type, GDATA_TYPE_ENTRY) == FALSE || (pspecs[i]->flags & G_PARAM_READABLE) == 0)
+			continue;
+
+		if (property_equal (G_OBJECT (self), G_OBJECT (other), pspecs[i]) == FALSE)
+			g_ptr_array_add (changes, g_strdup (pspecs[i]->name));
+	}
+
+	g_free (pspecs);
+
+	/* Diff the state which each class doesn't expose as properties */
+	for (type = G_OBJECT_TYPE (self); type != GDATA_TYPE_PARSABLE; type = g_type_parent (type)) {
+		GDataEntryDiffFunc diff_func = (GDataEntryDiffFunc) g_type_get_qdata (type, diff_func_quark);
+
+		if (diff_func != NULL)
+			diff_func (self, other, changes);
+		else if (g_type_is_a (type, GDATA_TYPE_ENTRY) == TRUE)
+			fully_diffable = FALSE;
+	}
+
+	/* If some state couldn't be diffed, compare it wholesale */
+	if (fully_diffable == FALSE) {
+		gchar *serialisation, *other_serialisation;
+		gboolean equal;
+
+		serialisation = get_serialisation (self);
+		other_serialisation = get_serialisation (other);
+		equal = (strcmp (serialisation, other_serialisation) == 0) ? TRUE : FALSE;
+		g_free (other_serialisation);
+		g_free (serialisation);
+
+		if (equal == FALSE) {
+			g_ptr_array_foreach (changes, (GFunc) g_free, NULL);
+			g_ptr_array_free (changes, TRUE);
+			return NULL;
+		}
+	}
+
+	g_ptr_array_add (changes, NULL);
+	return (gchar**) g_ptr_array_free (changes, FALSE);
+}
+
+static void
+swap_strings (gchar **a, gchar **b)
+{
+	gchar *temp = *a;
+	*a = *b;
+	*b = temp;
+}
+
+static void
+swap_lists (GList **a, GList **b)
+{
+	GList *temp = *a;
+	*a = *b;
+	*b = temp;
+}
+
+static void
+refresh_private (GDataEntry *self, GDataEntry *other)
+{
+	GDataEntryPrivate *priv = self->priv, *other_priv = other->priv;
+
+	/* Take @other's state, leaving it with ours to free */
+	swap_strings (&(priv->id), &(other_priv->id));
+	swap_strings (&(priv->etag), &(other_priv->etag));
+	swap_strings (&(priv->partial_fields), &(other_priv->partial_fields));
+	priv->updated = other_priv->updated;
+	priv->published = other_priv->published;
+
+	/* Keep the existing child objects where they're unchanged, so that anything holding references to them isn't left with stale copies */
+	if (parsable_lists_equal (priv->categories, other_priv->categories) == FALSE)
+		swap_lists (&(priv->categories), &(other_priv->categories));
+	if (parsable_lists_equal (priv->authors, other_priv->authors) == FALSE)
+		swap_lists (&(priv->authors), &(other_priv->authors));
+	if (parsable_lists_equal (priv->links, other_priv->links) == FALSE) {
+		swap_lists (&(priv->links), &(other_priv->links));
+		invalidate_link_index (priv);
+		invalidate_link_index (other_priv);
+	}
+}
+
+/* Updates only the ID, ETag and edit link of @self from @other, for when @other was built from a minimal response (see
+ * #GDataService:minimal-responses) and its other properties are meaningless. */
+static void
+refresh_identity (GDataEntry *self, GDataEntry *other)
+{
+	GDataEntryPrivate *priv = self->priv, *other_priv = other->priv;
+	GDataLink *edit_link, *other_edit_link;
+	gboolean was_inserted = gdata_entry_is_inserted (self);
+
+	if (other_priv->id != NULL && g_strcmp0 (priv->id, other_priv->id) != 0) {
+		swap_strings (&(priv->id), &(other_priv->id));
+		g_object_notify (G_OBJECT (self), "id");
+	}
+
+	if (g_strcmp0 (priv->etag, other_priv->etag) != 0) {
+		swap_strings (&(priv->etag), &(other_priv->etag));
+		g_object_notify (G_OBJECT (self), "etag");
+	}
+
+	edit_link = gdata_entry_look_up_link (self, GDATA_LINK_EDIT);
+	other_edit_link = gdata_entry_look_up_link (other, GDATA_LINK_EDIT);
+
+	if (other_edit_link != NULL &&
+	    (edit_link == NULL || g_strcmp0 (gdata_link_get_uri (edit_link), gdata_link_get_uri (other_edit_link)) != 0)) {
+		if (edit_link != NULL) {
+			priv->links = g_list_remove (priv->links, edit_link);
+			g_object_unref (edit_link);
+		}
+
+		priv->links = g_list_append (priv->links, g_object_ref (other_edit_link));
+		invalidate_link_index (priv);
+	}
+
+	if (gdata_entry_is_inserted (self) != was_inserted)
+		g_object_notify (G_OBJECT (self), "is-inserted");
+}
+
+static gboolean
+is_settable (GParamSpec *pspec)
+{
+	return ((pspec->flags & G_PARAM_WRITABLE) != 0 && (pspec->flags & G_PARAM_CONSTRUCT_ONLY) == 0) ? TRUE : FALSE;
+}
+
+/*
+ * _gdata_entry_refresh:
+ * @self: a #GDataEntry
+ * @other: another #GDataEntry of the same type as @self, such as the one parsed from the server's response to an update of @self
+ * @minimal: %TRUE if @other only holds an ID, ETag and edit link, as parsed from a minimal response
+ *
+ * Updates @self in place to match @other, so that code holding references to @self (such as UI bindings) sees the server's changes without
+ * having to switch to @other. Notifications are only emitted for the properties whose values change, and @self is left clean (see
+ * gdata_entry_is_dirty()). @other is left in an unspecified state, and should be unreffed afterwards.
+ *
+ * Writable properties are copied using their setters. Read-only properties, and the entry's links, categories and authors, are copied by the
+ * refresh functions of their classes; see _gdata_entry_class_set_refresh_func(). State which isn't exposed as properties is kept as it was in
+ * @self, since it's what was just sent to the server.
+ *
+ * If a read-only property differs and its class has no refresh function, @self is left untouched and %FALSE is returned.
+ *
+ * Return value: %TRUE if @self was refreshed, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_entry_refresh (GDataEntry *self, GDataEntry *other, gboolean minimal)
+{
+	GParamSpec **pspecs;
+	GPtrArray *changed;
+	GSList *refresh_funcs = NULL, *j;
+	guint i, n_pspecs;
+	GType type;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_ENTRY (other), FALSE);
+	g_return_val_if_fail (G_OBJECT_TYPE (self) == G_OBJECT_TYPE (other), FALSE);
+
+	if (self == other)
+		return TRUE;
+
+	g_object_freeze_notify (G_OBJECT (self));
+
+	if (minimal == TRUE) {
+		refresh_identity (self, other);
+		goto done;
+	}
+
+	/* Work out which properties have changed, and check that they can all be copied before changing anything */
+	pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (self), &n_pspecs);
+	changed = g_ptr_array_new ();
+
+	for (i = 0; i < n_pspecs; i++) {
+		if (g_type_is_a (pspecs[i]->owner_type, GDATA_TYPE_ENTRY) == FALSE || (pspecs[i]->flags & G_PARAM_READABLE) == 0 ||
+		    property_equal (G_OBJECT (self), G_OBJECT (other), pspecs[i]) == TRUE) {
+			continue;
+		}
+
+		if (is_settable (pspecs[i]) == FALSE && g_type_get_qdata (pspecs[i]->owner_type, refresh_func_quark) == NULL) {
+			g_ptr_array_free (changed, TRUE);
+			g_free (pspecs);
+			g_object_thaw_notify (G_OBJECT (self));
+
+			return FALSE;
+		}
+
+		g_ptr_array_add (changed, pspecs[i]);
+	}
+
+	g_free (pspecs);
+
+	/* Copy the writable properties, which notifies them */
+	for (i = 0; i < changed->len; i++) {
+		GParamSpec *pspec = g_ptr_array_index (changed, i);
+		GValue value = G_VALUE_INIT;
+
+		if (is_settable (pspec) == FALSE)
+			continue;
+
+		g_value_init (&value, G_PARAM_SPEC_VALUE_TYPE (pspec));
+		g_object_get_property (G_OBJECT (other), pspec->name, &value);
+		g_object_set_property (G_OBJECT (self), pspec->name, &value);
+		g_value_unset (&value);
+	}
+
+	/* Copy everything else, from the base class down */
+	for (type = G_OBJECT_TYPE (self); type != GDATA_TYPE_PARSABLE; type = g_type_parent (type)) {
+		GDataEntryRefreshFunc refresh_func = (GDataEntryRefreshFunc) g_type_get_qdata (type, refresh_func_quark);
+
+		if (refresh_func != NULL)
+			refresh_funcs = g_slist_prepend (refresh_funcs, refresh_func);
+	}
+
+	for (j = refresh_funcs; j != NULL; j = j->next)
+		((GDataEntryRefreshFunc) j->data) (self, other);
+	g_slist_free (refresh_funcs);
+
+	_gdata_parsable_swap_unhandled_data (GDATA_PARSABLE (self), GDATA_PARSABLE (other));
+
+	for (i = 0; i < changed->len; i++) {
+		GParamSpec *pspec = g_ptr_array_index (changed, i);
+
+		if (is_settable (pspec) == FALSE)
+			g_object_notify_by_pspec (G_OBJECT (self), pspec);
+	}
+
+	g_ptr_array_free (changed, TRUE);
+
+done:
+	/* @self now matches the server's copy, so it's clean, and the XML it was parsed from is out of date */
+	if (self->priv->dirty_fields != NULL)
+		g_ptr_array_free (self->priv->dirty_fields, TRUE);
+	self->priv->dirty_fields = NULL;
+	self->priv->has_untracked_changes = FALSE;
+
+	_gdata_parsable_forget_original_xml (GDATA_PARSABLE (self));
+
+	self->priv->refreshing = TRUE;
+	g_object_thaw_notify (G_OBJECT (self));
+	self->priv->refreshing = FALSE;
+
+	return TRUE;
+}
+
 /**
  * gdata_entry_get_rights:
  * @self: a #GDataEntry
@@ -1218,3 +1930,192 @@ _gdata_entry_set_batch_data (GDataEntry *self, guint id, GDataBatchOperationType
 	self->priv->batch_id = id;
 	self->priv->batch_operation_type = type;
 }
+
+/*
+ * _gdata_entry_get_partial_fields:
+ * @self: a #GDataEntry
+ *
+ * Gets the partial response selector which @self was retrieved with, as set by _gdata_entry_set_partial_fields().
+ *
+ * Return value: the entry's partial response selector, or %NULL if it's complete
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+_gdata_entry_get_partial_fields (GDataEntry *self)
+{
+	g_return_val_if_fail (GDATA_IS_ENTRY (self), NULL);
+	return self->priv->partial_fields;
+}
+
+/*
+ * _gdata_entry_set_partial_fields:
+ * @self: a #GDataEntry
+ * @fields: (allow-none): the partial response selector @self was retrieved with, or %NULL
+ *
+ * Marks @self as only containing the fields selected by @fields, which must be a selector relative to the entry (rather than to a feed containing
+ * it). The selector is sent back to the server when the entry is updated, so that only the selected fields are changed.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_entry_set_partial_fields (GDataEntry *self, const gchar *fields)
+{
+	g_return_if_fail (GDATA_IS_ENTRY (self));
+
+	g_free (self->priv->partial_fields);
+	self->priv->partial_fields = g_strdup (fields);
+	g_object_notify (G_OBJECT (self), "is-partial");
+}
+
+/*
+ * _gdata_entry_class_set_property_field:
+ * @klass: a #GDataEntryClass
+ * @property_name: the name of one of @klass' properties
+ * @field: (allow-none): the qualified name of the element (or the name of the JSON member) which the property is serialised as, or %NULL
+ *
+ * Registers the field which @property_name is serialised as, so that modifying the property on an instance of @klass marks that field as dirty
+ * (see _gdata_entry_mark_field_dirty()). If @field is %NULL, the property is read-only on the server, and modifying it locally doesn't dirty the
+ * entry.
+ *
+ * Modifying a property which has no field registered marks the entry as having changes which can't be sent as a patch, so subclasses needn't
+ * register all their properties for gdata_service_patch_entry() to remain correct; it will just fall back to a full update for them.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_entry_class_set_property_field (GDataEntryClass *klass, const gchar *property_name, const gchar *field)
+{
+	GParamSpec *pspec;
+
+	g_return_if_fail (GDATA_IS_ENTRY_CLASS (klass));
+	g_return_if_fail (property_name != NULL);
+
+	pspec = g_object_class_find_property (G_OBJECT_CLASS (klass), property_name);
+	g_return_if_fail (pspec != NULL);
+
+	g_param_spec_set_qdata (pspec, property_field_quark, (field != NULL) ? (gpointer) g_intern_string (field) : (gpointer) ignored_field);
+}
+
+static void
+diff_nothing (GDataEntry *self, GDataEntry *other, GPtrArray *changes)
+{
+	/* The class exposes all its state as properties */
+}
+
+/*
+ * _gdata_entry_class_set_diff_func:
+ * @klass: a #GDataEntryClass
+ * @diff_func: (allow-none): a function to diff the state of instances of @klass which isn't exposed as properties, or %NULL if there is none
+ *
+ * Sets the function used by gdata_entry_diff() to compare the state declared by @klass (but not that of its parent or child classes) which isn't
+ * exposed as properties. The function should append the names of any differing parts of the state to its @changes array, as newly allocated
+ * strings. Entry classes which don't set a diff function are compared by serialising them, so gdata_entry_diff() can only say whether they differ,
+ * not how. This should be called from the class' class_init function.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_entry_class_set_diff_func (GDataEntryClass *klass, GDataEntryDiffFunc diff_func)
+{
+	g_return_if_fail (GDATA_IS_ENTRY_CLASS (klass));
+	g_type_set_qdata (G_TYPE_FROM_CLASS (klass), diff_func_quark, (diff_func != NULL) ? (gpointer) diff_func : (gpointer) diff_nothing);
+}
+
+/*
+ * _gdata_entry_class_set_refresh_func:
+ * @klass: a #GDataEntryClass
+ * @refresh_func: a function to copy the read-only properties declared by @klass from one instance to another
+ *
+ * Sets the function used by _gdata_entry_refresh() to copy the values of the read-only and construct-only properties declared by @klass (but not
+ * those of its parent or child classes) from a newly-parsed instance into an existing one. The function may take ownership of the other
+ * instance's values, since it's discarded afterwards, and mustn't emit any notifications. Entries of classes which declare such properties but
+ * don't set a refresh function can only be refreshed in place if the properties haven't changed. This should be called from the class' class_init
+ * function.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_entry_class_set_refresh_func (GDataEntryClass *klass, GDataEntryRefreshFunc refresh_func)
+{
+	g_return_if_fail (GDATA_IS_ENTRY_CLASS (klass));
+	g_return_if_fail (refresh_func != NULL);
+
+	g_type_set_qdata (G_TYPE_FROM_CLASS (klass), refresh_func_quark, (gpointer) refresh_func);
+}
+
+/*
+ * _gdata_entry_mark_field_dirty:
+ * @self: a #GDataEntry
+ * @field: (allow-none): the qualified name of the modified element (or the name of the modified JSON member), or %NULL
+ *
+ * Records that @field of @self has been modified locally, so needs to be sent to the server when the entry is patched. This is done automatically
+ * for properties registered with _gdata_entry_class_set_property_field(), but has to be done explicitly by functions which modify lists of child
+ * elements. If @field is %NULL, the change can't be expressed as a set of fields, and the entry will have to be updated in full.
+ *
+ * Modifications made while @self is being parsed are ignored.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_entry_mark_field_dirty (GDataEntry *self, const gchar *field)
+{
+	GDataEntryPrivate *priv = self->priv;
+	guint i;
+
+	g_return_if_fail (GDATA_IS_ENTRY (self));
+
+	if (_gdata_parsable_is_parsing (GDATA_PARSABLE (self)) == TRUE)
+		return;
+
+	if (field == NULL) {
+		priv->has_untracked_changes = TRUE;
+		return;
+	}
+
+	/* Interned strings can be compared by pointer */
+	field = g_intern_string (field);
+
+	if (priv->dirty_fields == NULL)
+		priv->dirty_fields = g_ptr_array_new ();
+
+	for (i = 0; i < priv->dirty_fields->len; i++) {
+		if (g_ptr_array_index (priv->dirty_fields, i) == field)
+			return;
+	}
+
+	g_ptr_array_add (priv->dirty_fields, (gpointer) field);
+}
+
+/*
+ * _gdata_entry_get_dirty_fields:
+ * @self: a #GDataEntry
+ *
+ * Gets the fields of @self which have been modified locally, in the order they were first modified.
+ *
+ * Return value: (transfer container): a %NULL-terminated array of field names, which is empty if @self isn't dirty; or %NULL if @self has changes
+ * which can't be expressed as a set of fields; free with g_free()
+ *
+ * Since: 0.15.0
+ */
+const gchar **
+_gdata_entry_get_dirty_fields (GDataEntry *self)
+{
+	GDataEntryPrivate *priv = self->priv;
+	const gchar **fields;
+	guint i, n_fields;
+
+	g_return_val_if_fail (GDATA_IS_ENTRY (self), NULL);
+
+	if (priv->has_untracked_changes == TRUE)
+		return NULL;
+
+	n_fields = (priv->dirty_fields != NULL) ? priv->dirty_fields->len : 0;
+	fields = g_new (const gchar*, n_fields + 1);
+
+	for (i = 0; i < n_fields; i++)
+		fields[i] = g_ptr_array_index (priv->dirty_fields, i);
+	fields[n_fields] = NULL;
+
+	return fields;
+}
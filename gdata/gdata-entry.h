@@ -93,6 +93,9 @@ const gchar *gdata_entry_get_rights (GDataEntry *self) G_GNUC_PURE;
 void gdata_entry_set_rights (GDataEntry *self, const gchar *rights);
 
 gboolean gdata_entry_is_inserted (GDataEntry *self) G_GNUC_PURE;
+gboolean gdata_entry_is_partial (GDataEntry *self) G_GNUC_PURE;
+gboolean gdata_entry_is_dirty (GDataEntry *self) G_GNUC_PURE;
+gchar **gdata_entry_diff (GDataEntry *self, GDataEntry *other) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
 G_END_DECLS
 
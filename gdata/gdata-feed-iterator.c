@@ -0,0 +1,437 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-feed-iterator
+ * @short_description: GData lazy iterator over query results
+ * @stability: Unstable
+ * @include: gdata/gdata-feed-iterator.h
+ *
+ * #GDataFeedIterator iterates over all the entries matched by a query, one page at a time, without the caller having to paginate the query
+ * themselves using gdata_query_next_page(). Each page is only requested once it's needed, and is released as soon as its last entry has been
+ * returned by gdata_feed_iterator_next(), so at most two pages are held in memory at any time, however many entries there are in total.
+ *
+ * Once there are no more than #GDataFeedIterator:prefetch-threshold entries left to return from the current page, the next page is requested in
+ * a background thread, so that it's normally ready by the time the caller reaches the end of the current page and the network round trip for
+ * each page is hidden.
+ *
+ * The iterator advances its #GDataQuery through the pages as it goes, so the query mustn't be used for anything else while it's being iterated
+ * over.
+ *
+ * <example>
+ *	<title>Iterating Over All of a User's Documents</title>
+ *	<programlisting>
+ *	GDataFeedIterator *iterator;
+ *	GDataEntry *entry;
+ *	GError *error = NULL;
+ *
+ *	iterator = gdata_feed_iterator_new (service, domain, feed_uri, query, GDATA_TYPE_DOCUMENTS_ENTRY);
+ *
+ *	while ((entry = gdata_feed_iterator_next (iterator, NULL, &error)) != NULL) {
+ *		g_print ("%s\n", gdata_entry_get_title (entry));
+ *		g_object_unref (entry);
+ *	}
+ *
+ *	if (error != NULL) {
+ *		g_warning ("Error querying documents: %s", error->message);
+ *		g_error_free (error);
+ *	}
+ *
+ *	g_object_unref (iterator);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-feed-iterator.h"
+#include "gdata-feed.h"
+#include "gdata-private.h"
+
+#define DEFAULT_PREFETCH_THRESHOLD 10
+
+static void gdata_feed_iterator_dispose (GObject *object);
+static void gdata_feed_iterator_finalize (GObject *object);
+static void gdata_feed_iterator_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_feed_iterator_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataFeedIteratorPrivate {
+	GDataService *service;
+	GDataAuthorizationDomain *domain;
+	gchar *feed_uri;
+	GDataQuery *query;
+	GType entry_type;
+	guint prefetch_threshold;
+
+	GDataFeed *feed; /* the current page, or %NULL before the first page has been fetched and after the last one's been finished */
+	GList *next_entry; /* link in the current page's entries of the next entry to return */
+	guint n_entries_left; /* length of @next_entry */
+	gboolean has_next_page; /* TRUE if @query has been advanced to a page which hasn't been fetched yet */
+
+	/* The next page, being fetched in the background. @prefetch_feed and @prefetch_error are only valid once the thread's been joined. */
+	GThread *prefetch_thread;
+	GCancellable *prefetch_cancellable;
+	GDataFeed *prefetch_feed;
+	GError *prefetch_error;
+};
+
+enum {
+	PROP_PREFETCH_THRESHOLD = 1,
+};
+
+G_DEFINE_TYPE (GDataFeedIterator, gdata_feed_iterator, G_TYPE_OBJECT)
+
+static void
+gdata_feed_iterator_class_init (GDataFeedIteratorClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataFeedIteratorPrivate));
+
+	gobject_class->dispose = gdata_feed_iterator_dispose;
+	gobject_class->finalize = gdata_feed_iterator_finalize;
+	gobject_class->get_property = gdata_feed_iterator_get_property;
+	gobject_class->set_property = gdata_feed_iterator_set_property;
+
+	/**
+	 * GDataFeedIterator:prefetch-threshold:
+	 *
+	 * The number of entries left to return from the current page at which the next page is requested in the background. Setting this to the
+	 * page size (#GDataQuery:max-results) or more requests each page as soon as the previous one arrives; setting it to
+	 * <code class="literal">0</code> disables prefetching, so that each page is only requested once the previous one has been finished.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_PREFETCH_THRESHOLD,
+	                                 g_param_spec_uint ("prefetch-threshold",
+	                                                    "Prefetch threshold", "The number of entries left at which the next page is requested.",
+	                                                    0, G_MAXUINT, DEFAULT_PREFETCH_THRESHOLD,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_feed_iterator_init (GDataFeedIterator *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_FEED_ITERATOR, GDataFeedIteratorPrivate);
+	self->priv->prefetch_threshold = DEFAULT_PREFETCH_THRESHOLD;
+	self->priv->has_next_page = TRUE;
+	self->priv->prefetch_cancellable = g_cancellable_new ();
+}
+
+static void
+gdata_feed_iterator_dispose (GObject *object)
+{
+	GDataFeedIteratorPrivate *priv = GDATA_FEED_ITERATOR (object)->priv;
+
+	/* Stop any prefetch, and wait for it to finish, since it's using the service and query */
+	if (priv->prefetch_thread != NULL) {
+		g_cancellable_cancel (priv->prefetch_cancellable);
+		g_thread_join (priv->prefetch_thread);
+		priv->prefetch_thread = NULL;
+	}
+
+	g_clear_object (&(priv->prefetch_feed));
+	g_clear_object (&(priv->feed));
+	priv->next_entry = NULL;
+	g_clear_object (&(priv->query));
+	g_clear_object (&(priv->domain));
+	g_clear_object (&(priv->service));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_feed_iterator_parent_class)->dispose (object);
+}
+
+static void
+gdata_feed_iterator_finalize (GObject *object)
+{
+	GDataFeedIteratorPrivate *priv = GDATA_FEED_ITERATOR (object)->priv;
+
+	g_clear_error (&(priv->prefetch_error));
+	g_object_unref (priv->prefetch_cancellable);
+	g_free (priv->feed_uri);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_feed_iterator_parent_class)->finalize (object);
+}
+
+static void
+gdata_feed_iterator_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataFeedIteratorPrivate *priv = GDATA_FEED_ITERATOR (object)->priv;
+
+	switch (property_id) {
+		case PROP_PREFETCH_THRESHOLD:
+			g_value_set_uint (value, priv->prefetch_threshold);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_feed_iterator_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataFeedIterator *self = GDATA_FEED_ITERATOR (object);
+
+	switch (property_id) {
+		case PROP_PREFETCH_THRESHOLD:
+			gdata_feed_iterator_set_prefetch_threshold (self, g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_feed_iterator_new:
+ * @service: the #GDataService to query
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @feed_uri: the feed URI to query
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the feed pages
+ *
+ * Creates a new #GDataFeedIterator over all the entries matching @query in the feed at @feed_uri, as returned by gdata_service_query() for each
+ * page in turn. No requests are made until gdata_feed_iterator_next() is first called.
+ *
+ * @query is advanced through the pages of results as they're fetched, starting from its current page.
+ *
+ * Return value: (transfer full): a new #GDataFeedIterator; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataFeedIterator *
+gdata_feed_iterator_new (GDataService *service, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type)
+{
+	GDataFeedIterator *self;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+
+	self = g_object_new (GDATA_TYPE_FEED_ITERATOR, NULL);
+	self->priv->service = g_object_ref (service);
+	self->priv->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
+	self->priv->feed_uri = g_strdup (feed_uri);
+	self->priv->query = (query != NULL) ? g_object_ref (query) : gdata_query_new (NULL);
+	self->priv->entry_type = entry_type;
+
+	return self;
+}
+
+static GDataFeed *
+fetch_page (GDataFeedIterator *self, GCancellable *cancellable, GError **error)
+{
+	GDataFeedIteratorPrivate *priv = self->priv;
+
+	return gdata_service_query (priv->service, priv->domain, priv->feed_uri, priv->query, priv->entry_type, cancellable, NULL, NULL, error);
+}
+
+static gpointer
+prefetch_thread (GDataFeedIterator *self)
+{
+	GDataFeedIteratorPrivate *priv = self->priv;
+
+	priv->prefetch_feed = fetch_page (self, priv->prefetch_cancellable, &(priv->prefetch_error));
+
+	return NULL;
+}
+
+/* Starts fetching the next page in the background if there is one, and the caller's close enough to the end of the current page */
+static void
+maybe_start_prefetch (GDataFeedIterator *self)
+{
+	GDataFeedIteratorPrivate *priv = self->priv;
+
+	if (priv->has_next_page == FALSE || priv->prefetch_thread != NULL || priv->prefetch_threshold == 0 ||
+	    priv->n_entries_left > priv->prefetch_threshold) {
+		return;
+	}
+
+	g_cancellable_reset (priv->prefetch_cancellable);
+
+	/* If the thread can't be created, the page is just fetched synchronously once it's needed */
+	priv->prefetch_thread = g_thread_try_new ("feed-iterator-prefetch-thread", (GThreadFunc) prefetch_thread, self, NULL);
+}
+
+static void
+prefetch_cancelled_cb (GCancellable *cancellable, GCancellable *prefetch_cancellable)
+{
+	g_cancellable_cancel (prefetch_cancellable);
+}
+
+/* Waits for the page being prefetched, and returns it or its error. Cancelling @cancellable cancels the prefetch. */
+static GDataFeed *
+finish_prefetch (GDataFeedIterator *self, GCancellable *cancellable, GError **error)
+{
+	GDataFeedIteratorPrivate *priv = self->priv;
+	GDataFeed *feed;
+	gulong cancelled_signal = 0;
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) prefetch_cancelled_cb, priv->prefetch_cancellable, NULL);
+
+	g_thread_join (priv->prefetch_thread);
+	priv->prefetch_thread = NULL;
+
+	if (cancellable != NULL)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	feed = priv->prefetch_feed;
+	priv->prefetch_feed = NULL;
+
+	if (priv->prefetch_error != NULL) {
+		g_propagate_error (error, priv->prefetch_error);
+		priv->prefetch_error = NULL;
+	}
+
+	return feed;
+}
+
+/* Returns whether the results continue after @feed. An empty page is taken as the end of the results, even if it has a next link, so that a
+ * misbehaving server can't loop forever. */
+static gboolean
+feed_has_next_page (GDataFeed *feed)
+{
+	if (gdata_feed_get_entries (feed) == NULL)
+		return FALSE;
+
+	return (gdata_feed_look_up_link (feed, "next") != NULL || _gdata_feed_get_next_page_token (feed) != NULL) ? TRUE : FALSE;
+}
+
+/**
+ * gdata_feed_iterator_next:
+ * @self: a #GDataFeedIterator
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Returns the next entry matched by the iterator's query, requesting the next page of results if the current page has been finished (and the
+ * next page hasn't already been prefetched).
+ *
+ * If there are no more entries, %NULL is returned and @error is left unset. If requesting a page fails, %NULL is returned and @error is set; the
+ * page is requested again by the next call to gdata_feed_iterator_next(). If the operation is cancelled from another thread using
+ * @cancellable, a %G_IO_ERROR_CANCELLED error is returned.
+ *
+ * Return value: (transfer full) (allow-none): the next #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataEntry *
+gdata_feed_iterator_next (GDataFeedIterator *self, GCancellable *cancellable, GError **error)
+{
+	GDataFeedIteratorPrivate *priv;
+	GDataEntry *entry;
+
+	g_return_val_if_fail (GDATA_IS_FEED_ITERATOR (self), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	priv = self->priv;
+
+	while (priv->next_entry == NULL) {
+		GDataFeed *feed;
+		GError *child_error = NULL;
+
+		/* The current page has been finished, so release it */
+		g_clear_object (&(priv->feed));
+
+		if (priv->has_next_page == FALSE)
+			return NULL;
+
+		if (priv->prefetch_thread != NULL)
+			feed = finish_prefetch (self, cancellable, &child_error);
+		else
+			feed = fetch_page (self, cancellable, &child_error);
+
+		if (child_error != NULL) {
+			g_propagate_error (error, child_error);
+			return NULL;
+		} else if (feed == NULL) {
+			/* The results haven't changed since the query's ETag was set, so there's nothing to return */
+			priv->has_next_page = FALSE;
+			return NULL;
+		}
+
+		priv->feed = feed;
+		priv->next_entry = gdata_feed_get_entries (feed);
+		priv->n_entries_left = g_list_length (priv->next_entry);
+		priv->has_next_page = feed_has_next_page (feed);
+
+		/* gdata_service_query() has updated the query's pagination from the page, so it can now be moved on to the next one */
+		if (priv->has_next_page == TRUE)
+			gdata_query_next_page (priv->query);
+	}
+
+	entry = g_object_ref (priv->next_entry->data);
+	priv->next_entry = priv->next_entry->next;
+	priv->n_entries_left--;
+
+	maybe_start_prefetch (self);
+
+	return entry;
+}
+
+/**
+ * gdata_feed_iterator_get_prefetch_threshold:
+ * @self: a #GDataFeedIterator
+ *
+ * Gets the #GDataFeedIterator:prefetch-threshold property.
+ *
+ * Return value: the number of entries left in the current page at which the next page is requested, or <code class="literal">0</code> if
+ * prefetching is disabled
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_feed_iterator_get_prefetch_threshold (GDataFeedIterator *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_ITERATOR (self), 0);
+	return self->priv->prefetch_threshold;
+}
+
+/**
+ * gdata_feed_iterator_set_prefetch_threshold:
+ * @self: a #GDataFeedIterator
+ * @prefetch_threshold: the number of entries left in the current page at which to request the next page, or <code class="literal">0</code> to
+ * disable prefetching
+ *
+ * Sets the #GDataFeedIterator:prefetch-threshold property of the #GDataFeedIterator to @prefetch_threshold. This takes effect from the next call
+ * to gdata_feed_iterator_next(); a page which is already being prefetched carries on being fetched.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_feed_iterator_set_prefetch_threshold (GDataFeedIterator *self, guint prefetch_threshold)
+{
+	g_return_if_fail (GDATA_IS_FEED_ITERATOR (self));
+
+	if (self->priv->prefetch_threshold == prefetch_threshold)
+		return;
+
+	self->priv->prefetch_threshold = prefetch_threshold;
+	g_object_notify (G_OBJECT (self), "prefetch-threshold");
+}
@@ -0,0 +1,80 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_FEED_ITERATOR_H
+#define GDATA_FEED_ITERATOR_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/gdata-service.h>
+#include <gdata/gdata-query.h>
+#include <gdata/gdata-entry.h>
+#include <gdata/gdata-authorization-domain.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_FEED_ITERATOR		(gdata_feed_iterator_get_type ())
+#define GDATA_FEED_ITERATOR(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_FEED_ITERATOR, GDataFeedIterator))
+#define GDATA_FEED_ITERATOR_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_FEED_ITERATOR, GDataFeedIteratorClass))
+#define GDATA_IS_FEED_ITERATOR(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_FEED_ITERATOR))
+#define GDATA_IS_FEED_ITERATOR_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_FEED_ITERATOR))
+#define GDATA_FEED_ITERATOR_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_FEED_ITERATOR, GDataFeedIteratorClass))
+
+typedef struct _GDataFeedIteratorPrivate	GDataFeedIteratorPrivate;
+
+/**
+ * GDataFeedIterator:
+ *
+ * All the fields in the #GDataFeedIterator structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataFeedIteratorPrivate *priv;
+} GDataFeedIterator;
+
+/**
+ * GDataFeedIteratorClass:
+ *
+ * All the fields in the #GDataFeedIteratorClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataFeedIteratorClass;
+
+GType gdata_feed_iterator_get_type (void) G_GNUC_CONST;
+
+GDataFeedIterator *gdata_feed_iterator_new (GDataService *service, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query,
+                                            GType entry_type) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataEntry *gdata_feed_iterator_next (GDataFeedIterator *self, GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+
+guint gdata_feed_iterator_get_prefetch_threshold (GDataFeedIterator *self) G_GNUC_PURE;
+void gdata_feed_iterator_set_prefetch_threshold (GDataFeedIterator *self, guint prefetch_threshold);
+
+G_END_DECLS
+
+#endif /* !GDATA_FEED_ITERATOR_H */
@@ -0,0 +1,577 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-feed-snapshot
+ * @short_description: GData read-only binary feed snapshot
+ * @stability: Unstable
+ * @include: gdata/gdata-feed-snapshot.h
+ *
+ * #GDataFeedSnapshot is a compact, read-only binary copy of a #GDataFeed, intended for sharing the results of a query between several processes.
+ * One process queries the service and builds a snapshot of the resulting feed using gdata_feed_snapshot_new(), then writes the snapshot's data
+ * (from gdata_feed_snapshot_get_data()) into a file, shared memory segment or memfd. Other processes can then map the data and open it using
+ * gdata_feed_snapshot_new_from_data() without copying or parsing it.
+ *
+ * The data contains no pointers, so it can be mapped at any address. The feed's and entries' IDs, ETags, titles and update times can be read
+ * straight out of the data; the strings returned by the accessors point into it. Full #GDataEntry<!-- -->s are only built on demand, one at a time,
+ * by gdata_feed_snapshot_dup_entry(), so a process which only looks at a few entries doesn't pay to parse the rest.
+ *
+ * All the entries in a snapshot must be of the same type, which has to be passed to gdata_feed_snapshot_new_from_data() to open it. The data
+ * records the version of its format, so snapshots written by an incompatible version of libgdata are rejected rather than misread.
+ *
+ * <example>
+ *	<title>Reading a Snapshot from Shared Memory</title>
+ *	<programlisting>
+ *	GDataFeedSnapshot *snapshot;
+ *	gpointer data;
+ *	gsize length;
+ *	guint i, n_entries;
+ *	GError *error = NULL;
+ *
+ *	/<!-- -->* Map the shared memory written by the querying process (e.g. using mmap()), which must be aligned to 8 bytes *<!-- -->/
+ *	data = map_shared_snapshot (&length);
+ *
+ *	snapshot = gdata_feed_snapshot_new_from_data (GDATA_TYPE_CALENDAR_EVENT, data, length, (GDestroyNotify) unmap_shared_snapshot, data,
+ *	                                              &error);
+ *
+ *	if (error != NULL) {
+ *		g_error ("Error opening snapshot: %s", error->message);
+ *		g_error_free (error);
+ *		return;
+ *	}
+ *
+ *	n_entries = gdata_feed_snapshot_get_n_entries (snapshot);
+ *	for (i = 0; i < n_entries; i++)
+ *		g_print ("%s: %s\n", gdata_feed_snapshot_get_entry_id (snapshot, i), gdata_feed_snapshot_get_entry_title (snapshot, i));
+ *
+ *	g_object_unref (snapshot);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <string.h>
+
+#include "gdata-feed-snapshot.h"
+#include "gdata-parsable.h"
+#include "gdata-private.h"
+
+/* Version 1 of the snapshot format is a serialised GVariant tuple of:
+ *  - the format version;
+ *  - the name of the entry type;
+ *  - the feed's ID, ETag, title and update time; and
+ *  - an array of entries, each of which has its ID, ETag, title, update time, and its full XML or JSON (depending on the content type of the
+ *    entry type).
+ * Strings which are unset are stored as empty strings. */
+#define SNAPSHOT_FORMAT_VERSION 1
+#define SNAPSHOT_TYPE "(ussssxa(sssxs))"
+#define SNAPSHOT_ENTRY_TYPE "(sssxs)"
+
+enum {
+	SNAPSHOT_VERSION = 0,
+	SNAPSHOT_ENTRY_TYPE_NAME,
+	SNAPSHOT_ID,
+	SNAPSHOT_ETAG,
+	SNAPSHOT_TITLE,
+	SNAPSHOT_UPDATED,
+	SNAPSHOT_ENTRIES
+};
+
+enum {
+	ENTRY_ID = 0,
+	ENTRY_ETAG,
+	ENTRY_TITLE,
+	ENTRY_UPDATED,
+	ENTRY_CONTENT
+};
+
+static void gdata_feed_snapshot_finalize (GObject *object);
+
+struct _GDataFeedSnapshotPrivate {
+	GVariant *snapshot; /* always in serialised form */
+	GVariant *entries; /* child of snapshot, cached for quick indexing */
+	GType entry_type;
+};
+
+G_DEFINE_TYPE (GDataFeedSnapshot, gdata_feed_snapshot, G_TYPE_OBJECT)
+
+static void
+gdata_feed_snapshot_class_init (GDataFeedSnapshotClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataFeedSnapshotPrivate));
+
+	gobject_class->finalize = gdata_feed_snapshot_finalize;
+}
+
+static void
+gdata_feed_snapshot_init (GDataFeedSnapshot *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_FEED_SNAPSHOT, GDataFeedSnapshotPrivate);
+}
+
+static void
+gdata_feed_snapshot_finalize (GObject *object)
+{
+	GDataFeedSnapshotPrivate *priv = GDATA_FEED_SNAPSHOT (object)->priv;
+
+	if (priv->entries != NULL)
+		g_variant_unref (priv->entries);
+	if (priv->snapshot != NULL)
+		g_variant_unref (priv->snapshot);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_feed_snapshot_parent_class)->finalize (object);
+}
+
+static gboolean
+entry_type_is_json (GType entry_type)
+{
+	GDataParsableClass *klass;
+	gboolean is_json;
+
+	klass = g_type_class_ref (entry_type);
+	g_assert (klass->get_content_type != NULL);
+	is_json = (g_strcmp0 (klass->get_content_type (), "application/json") == 0);
+	g_type_class_unref (klass);
+
+	return is_json;
+}
+
+static GDataFeedSnapshot *
+snapshot_new (GVariant *snapshot, GType entry_type)
+{
+	GDataFeedSnapshot *self;
+
+	self = g_object_new (GDATA_TYPE_FEED_SNAPSHOT, NULL);
+	self->priv->snapshot = g_variant_ref_sink (snapshot);
+	self->priv->entries = g_variant_get_child_value (snapshot, SNAPSHOT_ENTRIES);
+	self->priv->entry_type = entry_type;
+
+	return self;
+}
+
+/**
+ * gdata_feed_snapshot_new:
+ * @feed: the #GDataFeed to take a snapshot of
+ *
+ * Creates a new #GDataFeedSnapshot containing all the entries in @feed. All the entries must be of the same type. Later changes to @feed or its
+ * entries are not reflected in the snapshot.
+ *
+ * Return value: (transfer full): a new #GDataFeedSnapshot; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataFeedSnapshot *
+gdata_feed_snapshot_new (GDataFeed *feed)
+{
+	GDataFeedSnapshot *self;
+	GVariantBuilder entries_builder;
+	GVariant *snapshot;
+	GType entry_type;
+	gboolean is_json;
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_FEED (feed), NULL);
+
+	i = gdata_feed_get_entries (feed);
+	entry_type = (i != NULL) ? G_OBJECT_TYPE (i->data) : GDATA_TYPE_ENTRY;
+	is_json = entry_type_is_json (entry_type);
+
+	g_variant_builder_init (&entries_builder, G_VARIANT_TYPE ("a" SNAPSHOT_ENTRY_TYPE));
+
+	for (; i != NULL; i = i->next) {
+		GDataEntry *entry = GDATA_ENTRY (i->data);
+		gchar *content;
+
+		g_return_val_if_fail (G_OBJECT_TYPE (entry) == entry_type, NULL);
+
+		content = (is_json == TRUE) ? gdata_parsable_get_json (GDATA_PARSABLE (entry)) : gdata_parsable_get_xml (GDATA_PARSABLE (entry));
+		g_variant_builder_add (&entries_builder, SNAPSHOT_ENTRY_TYPE,
+		                       (gdata_entry_get_id (entry) != NULL) ? gdata_entry_get_id (entry) : "",
+		                       (gdata_entry_get_etag (entry) != NULL) ? gdata_entry_get_etag (entry) : "",
+		                       (gdata_entry_get_title (entry) != NULL) ? gdata_entry_get_title (entry) : "",
+		                       gdata_entry_get_updated (entry),
+		                       content);
+		g_free (content);
+	}
+
+	snapshot = g_variant_new (SNAPSHOT_TYPE,
+	                          (guint32) SNAPSHOT_FORMAT_VERSION,
+	                          g_type_name (entry_type),
+	                          (gdata_feed_get_id (feed) != NULL) ? gdata_feed_get_id (feed) : "",
+	                          (gdata_feed_get_etag (feed) != NULL) ? gdata_feed_get_etag (feed) : "",
+	                          (gdata_feed_get_title (feed) != NULL) ? gdata_feed_get_title (feed) : "",
+	                          gdata_feed_get_updated (feed),
+	                          &entries_builder);
+
+	self = snapshot_new (snapshot, entry_type);
+
+	/* Serialise the snapshot now, so that the accessors all index into the same flat data as a snapshot opened from data would */
+	g_variant_get_data (self->priv->snapshot);
+
+	return self;
+}
+
+/**
+ * gdata_feed_snapshot_new_from_data:
+ * @entry_type: the type of the entries in the snapshot, which must be a subtype of #GDataEntry
+ * @data: (array length=length) (element-type guint8): the snapshot data, as returned by gdata_feed_snapshot_get_data()
+ * @length: the length of @data, in bytes
+ * @notify: (allow-none): function to call when @data is no longer needed, or %NULL
+ * @user_data: (closure): data to pass to @notify
+ * @error: a #GError, or %NULL
+ *
+ * Opens a snapshot previously written out from gdata_feed_snapshot_get_data(), possibly by another process. @data is not copied: it must remain
+ * valid and unmodified until @notify is called, which happens when the returned #GDataFeedSnapshot is finalized (or straight away if an error is
+ * returned). @data must be aligned to 8 bytes, which memory returned by mmap() or g_malloc() always is.
+ *
+ * @data is only checked enough to ensure it has the right format version and @entry_type; reading a corrupted snapshot is safe, but will return
+ * empty values. If @data is not a snapshot of the current format version, or was written for a different entry type,
+ * %GDATA_PARSER_ERROR_PARSING_STRING is returned.
+ *
+ * Return value: (transfer full): a new #GDataFeedSnapshot, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataFeedSnapshot *
+gdata_feed_snapshot_new_from_data (GType entry_type, gconstpointer data, gsize length, GDestroyNotify notify, gpointer user_data,
+                                   GError **error)
+{
+	GVariant *snapshot;
+	guint32 version;
+	const gchar *entry_type_name;
+
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+	g_return_val_if_fail (data != NULL || length == 0, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* This takes ownership of @data, so @notify will be called once @snapshot is freed */
+	snapshot = g_variant_ref_sink (g_variant_new_from_data (G_VARIANT_TYPE (SNAPSHOT_TYPE), data, length, FALSE, notify, user_data));
+
+	g_variant_get_child (snapshot, SNAPSHOT_VERSION, "u", &version);
+	g_variant_get_child (snapshot, SNAPSHOT_ENTRY_TYPE_NAME, "&s", &entry_type_name);
+
+	if (version != SNAPSHOT_FORMAT_VERSION) {
+		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+		             /* Translators: the parameter is a version number */
+		             _("The feed snapshot is not of a supported version (version %u)."), version);
+		g_variant_unref (snapshot);
+		return NULL;
+	} else if (strcmp (entry_type_name, g_type_name (entry_type)) != 0) {
+		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+		             /* Translators: the first parameter is the name of a type of entry the snapshot was expected to contain; the second is
+		              * the name of the type it does contain. */
+		             _("The feed snapshot does not contain entries of type %s (it contains entries of type %s)."),
+		             g_type_name (entry_type), entry_type_name);
+		g_variant_unref (snapshot);
+		return NULL;
+	}
+
+	return snapshot_new (snapshot, entry_type);
+}
+
+/**
+ * gdata_feed_snapshot_get_data:
+ * @self: a #GDataFeedSnapshot
+ * @length: (out caller-allocates): return location for the length of the data, in bytes
+ *
+ * Returns the snapshot's data, which can be written out to a file or shared memory and later opened using gdata_feed_snapshot_new_from_data().
+ *
+ * Return value: (transfer none) (array length=length) (element-type guint8): the snapshot's data, owned by @self
+ *
+ * Since: 0.15.0
+ **/
+gconstpointer
+gdata_feed_snapshot_get_data (GDataFeedSnapshot *self, gsize *length)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), NULL);
+	g_return_val_if_fail (length != NULL, NULL);
+
+	*length = g_variant_get_size (self->priv->snapshot);
+	return g_variant_get_data (self->priv->snapshot);
+}
+
+/**
+ * gdata_feed_snapshot_get_entry_type:
+ * @self: a #GDataFeedSnapshot
+ *
+ * Returns the type of the entries in the snapshot.
+ *
+ * Return value: the entries' type; a subtype of #GDataEntry
+ *
+ * Since: 0.15.0
+ **/
+GType
+gdata_feed_snapshot_get_entry_type (GDataFeedSnapshot *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), G_TYPE_INVALID);
+	return self->priv->entry_type;
+}
+
+/* Returns a string child of @container, pointing into the snapshot's data, or %NULL if it's empty */
+static const gchar *
+get_string (GVariant *container, gsize index)
+{
+	const gchar *str;
+
+	g_variant_get_child (container, index, "&s", &str);
+	return (*str == '\0') ? NULL : str;
+}
+
+/**
+ * gdata_feed_snapshot_get_id:
+ * @self: a #GDataFeedSnapshot
+ *
+ * Returns the feed's unique and permanent URN ID.
+ *
+ * Return value: the feed's ID, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_feed_snapshot_get_id (GDataFeedSnapshot *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), NULL);
+	return get_string (self->priv->snapshot, SNAPSHOT_ID);
+}
+
+/**
+ * gdata_feed_snapshot_get_etag:
+ * @self: a #GDataFeedSnapshot
+ *
+ * Returns the feed's unique ETag for this version.
+ *
+ * Return value: the feed's ETag, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_feed_snapshot_get_etag (GDataFeedSnapshot *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), NULL);
+	return get_string (self->priv->snapshot, SNAPSHOT_ETAG);
+}
+
+/**
+ * gdata_feed_snapshot_get_title:
+ * @self: a #GDataFeedSnapshot
+ *
+ * Returns the title of the feed.
+ *
+ * Return value: the feed's title, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_feed_snapshot_get_title (GDataFeedSnapshot *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), NULL);
+	return get_string (self->priv->snapshot, SNAPSHOT_TITLE);
+}
+
+/**
+ * gdata_feed_snapshot_get_updated:
+ * @self: a #GDataFeedSnapshot
+ *
+ * Gets the time the feed was last updated.
+ *
+ * Return value: the UNIX timestamp for the time the feed was last updated, or <code class="literal">-1</code>
+ *
+ * Since: 0.15.0
+ **/
+gint64
+gdata_feed_snapshot_get_updated (GDataFeedSnapshot *self)
+{
+	gint64 updated;
+
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), -1);
+
+	g_variant_get_child (self->priv->snapshot, SNAPSHOT_UPDATED, "x", &updated);
+	return updated;
+}
+
+/**
+ * gdata_feed_snapshot_get_n_entries:
+ * @self: a #GDataFeedSnapshot
+ *
+ * Returns the number of entries in the snapshot.
+ *
+ * Return value: the number of entries
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_feed_snapshot_get_n_entries (GDataFeedSnapshot *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), 0);
+	return g_variant_n_children (self->priv->entries);
+}
+
+/* Returns a string member of the entry at @index, pointing into the snapshot's data, or %NULL if it's empty */
+static const gchar *
+get_entry_string (GDataFeedSnapshot *self, guint index, gsize member)
+{
+	GVariant *entry;
+	const gchar *str;
+
+	/* The child shares the snapshot's data, so the string remains valid after it's unreffed */
+	entry = g_variant_get_child_value (self->priv->entries, index);
+	str = get_string (entry, member);
+	g_variant_unref (entry);
+
+	return str;
+}
+
+/**
+ * gdata_feed_snapshot_get_entry_id:
+ * @self: a #GDataFeedSnapshot
+ * @index: the index of the entry, which must be less than gdata_feed_snapshot_get_n_entries()
+ *
+ * Returns the ID of the entry at @index, without building the entry. Entries are in the same order as they were in the feed.
+ *
+ * Return value: the entry's ID, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_feed_snapshot_get_entry_id (GDataFeedSnapshot *self, guint index)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), NULL);
+	g_return_val_if_fail (index < g_variant_n_children (self->priv->entries), NULL);
+
+	return get_entry_string (self, index, ENTRY_ID);
+}
+
+/**
+ * gdata_feed_snapshot_get_entry_etag:
+ * @self: a #GDataFeedSnapshot
+ * @index: the index of the entry, which must be less than gdata_feed_snapshot_get_n_entries()
+ *
+ * Returns the ETag of the entry at @index, without building the entry.
+ *
+ * Return value: the entry's ETag, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_feed_snapshot_get_entry_etag (GDataFeedSnapshot *self, guint index)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), NULL);
+	g_return_val_if_fail (index < g_variant_n_children (self->priv->entries), NULL);
+
+	return get_entry_string (self, index, ENTRY_ETAG);
+}
+
+/**
+ * gdata_feed_snapshot_get_entry_title:
+ * @self: a #GDataFeedSnapshot
+ * @index: the index of the entry, which must be less than gdata_feed_snapshot_get_n_entries()
+ *
+ * Returns the title of the entry at @index, without building the entry.
+ *
+ * Return value: the entry's title, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_feed_snapshot_get_entry_title (GDataFeedSnapshot *self, guint index)
+{
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), NULL);
+	g_return_val_if_fail (index < g_variant_n_children (self->priv->entries), NULL);
+
+	return get_entry_string (self, index, ENTRY_TITLE);
+}
+
+/**
+ * gdata_feed_snapshot_get_entry_updated:
+ * @self: a #GDataFeedSnapshot
+ * @index: the index of the entry, which must be less than gdata_feed_snapshot_get_n_entries()
+ *
+ * Returns the time the entry at @index was last updated, without building the entry.
+ *
+ * Return value: the UNIX timestamp for the time the entry was last updated, or <code class="literal">-1</code>
+ *
+ * Since: 0.15.0
+ **/
+gint64
+gdata_feed_snapshot_get_entry_updated (GDataFeedSnapshot *self, guint index)
+{
+	GVariant *entry;
+	gint64 updated;
+
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), -1);
+	g_return_val_if_fail (index < g_variant_n_children (self->priv->entries), -1);
+
+	entry = g_variant_get_child_value (self->priv->entries, index);
+	g_variant_get_child (entry, ENTRY_UPDATED, "x", &updated);
+	g_variant_unref (entry);
+
+	return updated;
+}
+
+/**
+ * gdata_feed_snapshot_dup_entry:
+ * @self: a #GDataFeedSnapshot
+ * @index: the index of the entry, which must be less than gdata_feed_snapshot_get_n_entries()
+ * @error: a #GError, or %NULL
+ *
+ * Builds the full #GDataEntry at @index by parsing its copy in the snapshot. Each call returns a new entry, which is independent of the snapshot;
+ * callers which need the same entry repeatedly should keep a reference to it rather than calling this again.
+ *
+ * Errors from %GDATA_PARSER_ERROR can be returned if the entry can't be parsed.
+ *
+ * Return value: (transfer full): a new #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataEntry *
+gdata_feed_snapshot_dup_entry (GDataFeedSnapshot *self, guint index, GError **error)
+{
+	GVariant *entry;
+	const gchar *content;
+	gsize content_length;
+	GDataParsable *parsable = NULL;
+
+	g_return_val_if_fail (GDATA_IS_FEED_SNAPSHOT (self), NULL);
+	g_return_val_if_fail (index < g_variant_n_children (self->priv->entries), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	entry = g_variant_get_child_value (self->priv->entries, index);
+	g_variant_get_child (entry, ENTRY_CONTENT, "&s", &content);
+	content_length = strlen (content);
+
+	if (content_length == 0) {
+		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_EMPTY_DOCUMENT, /* Translators: this is a dummy error message to be substituted into "Error parsing XML: %s". */
+		             _("Error parsing XML: %s"), _("Empty document."));
+	} else if (entry_type_is_json (self->priv->entry_type) == TRUE) {
+		parsable = gdata_parsable_new_from_json (self->priv->entry_type, content, (gint) content_length, error);
+	} else {
+		parsable = gdata_parsable_new_from_xml (self->priv->entry_type, content, (gint) content_length, error);
+	}
+
+	g_variant_unref (entry);
+
+	return (parsable != NULL) ? GDATA_ENTRY (parsable) : NULL;
+}
@@ -0,0 +1,87 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_FEED_SNAPSHOT_H
+#define GDATA_FEED_SNAPSHOT_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gdata/gdata-feed.h>
+#include <gdata/gdata-entry.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_FEED_SNAPSHOT		(gdata_feed_snapshot_get_type ())
+#define GDATA_FEED_SNAPSHOT(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_FEED_SNAPSHOT, GDataFeedSnapshot))
+#define GDATA_FEED_SNAPSHOT_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_FEED_SNAPSHOT, GDataFeedSnapshotClass))
+#define GDATA_IS_FEED_SNAPSHOT(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_FEED_SNAPSHOT))
+#define GDATA_IS_FEED_SNAPSHOT_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_FEED_SNAPSHOT))
+#define GDATA_FEED_SNAPSHOT_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_FEED_SNAPSHOT, GDataFeedSnapshotClass))
+
+typedef struct _GDataFeedSnapshotPrivate	GDataFeedSnapshotPrivate;
+
+/**
+ * GDataFeedSnapshot:
+ *
+ * All the fields in the #GDataFeedSnapshot structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataFeedSnapshotPrivate *priv;
+} GDataFeedSnapshot;
+
+/**
+ * GDataFeedSnapshotClass:
+ *
+ * All the fields in the #GDataFeedSnapshotClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataFeedSnapshotClass;
+
+GType gdata_feed_snapshot_get_type (void) G_GNUC_CONST;
+
+GDataFeedSnapshot *gdata_feed_snapshot_new (GDataFeed *feed) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GDataFeedSnapshot *gdata_feed_snapshot_new_from_data (GType entry_type, gconstpointer data, gsize length, GDestroyNotify notify,
+                                                      gpointer user_data, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gconstpointer gdata_feed_snapshot_get_data (GDataFeedSnapshot *self, gsize *length);
+
+GType gdata_feed_snapshot_get_entry_type (GDataFeedSnapshot *self) G_GNUC_PURE;
+const gchar *gdata_feed_snapshot_get_id (GDataFeedSnapshot *self) G_GNUC_PURE;
+const gchar *gdata_feed_snapshot_get_etag (GDataFeedSnapshot *self) G_GNUC_PURE;
+const gchar *gdata_feed_snapshot_get_title (GDataFeedSnapshot *self) G_GNUC_PURE;
+gint64 gdata_feed_snapshot_get_updated (GDataFeedSnapshot *self);
+guint gdata_feed_snapshot_get_n_entries (GDataFeedSnapshot *self) G_GNUC_PURE;
+
+const gchar *gdata_feed_snapshot_get_entry_id (GDataFeedSnapshot *self, guint index);
+const gchar *gdata_feed_snapshot_get_entry_etag (GDataFeedSnapshot *self, guint index);
+const gchar *gdata_feed_snapshot_get_entry_title (GDataFeedSnapshot *self, guint index);
+gint64 gdata_feed_snapshot_get_entry_updated (GDataFeedSnapshot *self, guint index);
+GDataEntry *gdata_feed_snapshot_dup_entry (GDataFeedSnapshot *self, guint index, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+G_END_DECLS
+
+#endif /* !GDATA_FEED_SNAPSHOT_H */
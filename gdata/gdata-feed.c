@@ -44,6 +44,7 @@
 #include "gdata-private.h"
 #include "gdata-service.h"
 #include "gdata-parsable.h"
+#include "gdata-trace.h"
 
 static void gdata_feed_dispose (GObject *object);
 static void gdata_feed_finalize (GObject *object);
@@ -51,6 +52,7 @@ static void gdata_feed_get_property (GObject *object, guint property_id, GValue
 static gboolean pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error);
 static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
 static gboolean post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error);
+static void register_elements (void);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 
@@ -62,7 +64,11 @@ static gboolean parse_json (GDataParsable *parsable, JsonReader *reader, gpointe
 static gboolean post_parse_json (GDataParsable *parsable, gpointer user_data, GError **error);
 
 struct _GDataFeedPrivate {
-	GList *entries;
+	GPtrArray *entries; /* GDataEntry, in document order */
+	guint entries_reserved; /* number of entries the entries array was last pre-sized for; see reserve_expected_entries() */
+	GList *entries_list; /* compatibility view of entries for gdata_feed_get_entries(); built lazily, then kept up to date */
+	GList *entries_list_tail; /* last element of entries_list, so entries can be appended to it cheaply */
+	GHashTable *entries_by_id; /* gchar* → GDataEntry; built lazily */
 	gchar *title;
 	gchar *subtitle;
 	gchar *id;
@@ -72,12 +78,21 @@ struct _GDataFeedPrivate {
 	gchar *logo;
 	gchar *icon;
 	GList *links; /* GDataLink */
+	GHashTable *links_by_rel; /* interned gchar* → GDataLink; built lazily */
+
+	/* The lazily-built members above are built by getters, which may be called on the same feed from several threads at once (for example,
+	 * if it's shared between queries; see #GDataService:share-queries) */
+	GMutex indices_mutex; /* protects entries_list, entries_list_tail, entries_by_id and links_by_rel */
 	GList *authors; /* GDataAuthor */
 	GDataGenerator *generator;
 	guint items_per_page;
 	guint start_index;
 	guint total_results;
 	gchar *rights;
+	gchar *next_page_token; /* only set for JSON feeds */
+
+	/* Categories and authors which are shared between the entries, while they're being parsed; see parse_entry() */
+	GHashTable *flyweights; /* owned gchar* → owned GDataParsable, or NULL */
 };
 
 enum {
@@ -116,9 +131,14 @@ gdata_feed_class_init (GDataFeedClass *klass)
 	parsable_class->get_namespaces = get_namespaces;
 	parsable_class->element_name = "feed";
 
+	/* A feed's namespaces depend on its entries */
+	_gdata_parsable_class_set_dynamic_namespaces (parsable_class);
+
 	parsable_class->parse_json = parse_json;
 	parsable_class->post_parse_json = post_parse_json;
 
+	register_elements ();
+
 	/**
 	 * GDataFeed:title:
 	 *
@@ -298,11 +318,41 @@ gdata_feed_class_init (GDataFeedClass *klass)
 	                                                    G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 }
 
+static void entry_id_notify_cb (GDataEntry *entry, GParamSpec *pspec, GDataFeedPrivate *priv);
+
+/* Must be called with indices_mutex held */
+static void
+invalidate_entry_index (GDataFeedPrivate *priv)
+{
+	guint i;
+
+	if (priv->entries_by_id == NULL)
+		return;
+
+	/* Only the entries which were in the feed when the index was built are being watched, but it doesn't matter if this looks at later ones */
+	for (i = 0; i < priv->entries->len; i++)
+		g_signal_handlers_disconnect_by_func (g_ptr_array_index (priv->entries, i), entry_id_notify_cb, priv);
+
+	g_hash_table_destroy (priv->entries_by_id);
+	priv->entries_by_id = NULL;
+}
+
+/* Must be called with indices_mutex held */
+static void
+invalidate_link_index (GDataFeedPrivate *priv)
+{
+	if (priv->links_by_rel != NULL)
+		g_hash_table_destroy (priv->links_by_rel);
+	priv->links_by_rel = NULL;
+}
+
 static void
 gdata_feed_init (GDataFeed *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_FEED, GDataFeedPrivate);
 	self->priv->updated = -1;
+	self->priv->entries = g_ptr_array_new_with_free_func (g_object_unref);
+	g_mutex_init (&(self->priv->indices_mutex));
 }
 
 static void
@@ -310,11 +360,19 @@ gdata_feed_dispose (GObject *object)
 {
 	GDataFeedPrivate *priv = GDATA_FEED (object)->priv;
 
-	if (priv->entries != NULL) {
-		g_list_foreach (priv->entries, (GFunc) g_object_unref, NULL);
-		g_list_free (priv->entries);
-	}
-	priv->entries = NULL;
+	g_mutex_lock (&(priv->indices_mutex));
+	g_list_free (priv->entries_list);
+	priv->entries_list = NULL;
+	priv->entries_list_tail = NULL;
+	invalidate_entry_index (priv);
+	invalidate_link_index (priv);
+	g_mutex_unlock (&(priv->indices_mutex));
+
+	g_ptr_array_set_size (priv->entries, 0);
+
+	if (priv->flyweights != NULL)
+		g_hash_table_unref (priv->flyweights);
+	priv->flyweights = NULL;
 
 	if (priv->categories != NULL) {
 		g_list_foreach (priv->categories, (GFunc) g_object_unref, NULL);
@@ -322,6 +380,8 @@ gdata_feed_dispose (GObject *object)
 	}
 	priv->categories = NULL;
 
+	invalidate_link_index (priv);
+
 	if (priv->links != NULL) {
 		g_list_foreach (priv->links, (GFunc) g_object_unref, NULL);
 		g_list_free (priv->links);
@@ -354,6 +414,9 @@ gdata_feed_finalize (GObject *object)
 	g_free (priv->logo);
 	g_free (priv->icon);
 	g_free (priv->rights);
+	g_free (priv->next_page_token);
+	g_ptr_array_unref (priv->entries);
+	g_mutex_clear (&(priv->indices_mutex));
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_feed_parent_class)->finalize (object);
@@ -408,14 +471,122 @@ gdata_feed_get_property (GObject *object, guint property_id, GValue *value, GPar
 	}
 }
 
+typedef struct {
+	GDataQueryProgressCallback progress_callback;
+	gpointer progress_user_data;
+	GDataEntry *entry;
+	guint entry_i;
+	guint total_results;
+} ProgressCallbackData;
+
+/* The progress callbacks of an asynchronous query which are waiting to be called in its main context. Rather than adding an idle source for each
+ * entry, the callbacks are queued and then called in batches by a single idle source, so that a large feed doesn't flood the main context with
+ * sources. The queue is reference counted, since it outlives the ParseData if its idle source is still pending once parsing's finished. */
+typedef struct {
+	volatile gint ref_count;
+	GMainContext *context;
+	GDataService *service; /* the service running the query, whose gauges count the idle sources; may be NULL */
+	GMutex mutex; /* protects callbacks and idle_pending */
+	GQueue callbacks; /* owned ProgressCallbackData, in the order they were queued */
+	gboolean idle_pending; /* TRUE if an idle source has been added to call the queued callbacks */
+} ProgressQueue;
+
 typedef struct {
 	GType entry_type;
 	GDataQueryProgressCallback progress_callback;
 	gpointer progress_user_data;
 	guint entry_i;
 	gboolean is_async;
+	gboolean retain_entries; /* FALSE if entries are only passed to progress_callback, and not added to the feed */
+	ProgressQueue *progress_queue; /* NULL unless is_async is TRUE and there's a progress_callback */
+
+	/* Called as soon as the feed's next link has been parsed; see _gdata_feed_new_from_xml_input() */
+	GDataFeedNextLinkCallback next_link_callback;
+	gpointer next_link_user_data;
+
+	/* Parallel entry parsing; see _gdata_feed_new_from_xml_input(). These are all %NULL or 0 if entries are parsed in order by parse_entry(). */
+	GThreadPool *entry_pool;
+	guint max_pending_entries; /* number of entries which may be queued before parse_entry() waits for the oldest to be built */
+	GMutex entry_mutex; /* protects the finished, entry and error members of all EntryJobs */
+	GCond entry_cond;
+	GPtrArray/*<owned EntryJob*>*/ *entry_jobs; /* in document order; NULL once added to the feed */
+	guint n_entries_added; /* index of the first EntryJob which hasn't yet been added to the feed */
 } ParseData;
 
+/* An entry being built by the entry pool. Its XML is copied into its own document, since libxml2 documents can't be shared between threads. */
+typedef struct {
+	xmlDoc *doc;
+	gboolean finished;
+	GDataEntry *entry;
+	GError *error;
+} EntryJob;
+
+static void
+entry_job_free (EntryJob *job)
+{
+	if (job->doc != NULL)
+		xmlFreeDoc (job->doc);
+	if (job->entry != NULL)
+		g_object_unref (job->entry);
+	g_clear_error (&(job->error));
+	g_slice_free (EntryJob, job);
+}
+
+static void
+entry_job_run (EntryJob *job, ParseData *data)
+{
+	GDataEntry *entry;
+	GError *error = NULL;
+
+	GDATA_TRACE1 (parse_entry_start, xmlDocGetRootElement (job->doc));
+	entry = GDATA_ENTRY (_gdata_parsable_new_from_xml_node (data->entry_type, job->doc, xmlDocGetRootElement (job->doc), NULL, &error));
+	GDATA_TRACE1 (parse_entry_end, entry);
+
+	xmlFreeDoc (job->doc);
+	job->doc = NULL;
+
+	g_mutex_lock (&(data->entry_mutex));
+	job->entry = entry;
+	job->error = error;
+	job->finished = TRUE;
+	g_cond_broadcast (&(data->entry_cond));
+	g_mutex_unlock (&(data->entry_mutex));
+}
+
+/* Adds the entries built by the entry pool to the feed in document order, calling the progress callback for each, until no more than
+ * @max_pending entries are still queued or being built. This waits for entries to be built if necessary. */
+static gboolean
+add_built_entries (GDataFeed *self, ParseData *data, guint max_pending, GError **error)
+{
+	while (data->n_entries_added < data->entry_jobs->len) {
+		EntryJob *job = g_ptr_array_index (data->entry_jobs, data->n_entries_added);
+		gboolean must_wait = (data->entry_jobs->len - data->n_entries_added > max_pending) ? TRUE : FALSE;
+		gboolean finished;
+
+		g_mutex_lock (&(data->entry_mutex));
+		while (job->finished == FALSE && must_wait == TRUE)
+			g_cond_wait (&(data->entry_cond), &(data->entry_mutex));
+		finished = job->finished;
+		g_mutex_unlock (&(data->entry_mutex));
+
+		if (finished == FALSE)
+			break;
+
+		if (job->entry == NULL) {
+			g_propagate_error (error, job->error);
+			job->error = NULL;
+			return FALSE;
+		}
+
+		_gdata_feed_add_parsed_entry (self, data, job->entry);
+
+		g_ptr_array_index (data->entry_jobs, data->n_entries_added++) = NULL;
+		entry_job_free (job);
+	}
+
+	return TRUE;
+}
+
 static gboolean
 pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error)
 {
@@ -424,119 +595,236 @@ pre_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointe
 	return TRUE;
 }
 
-typedef struct {
-	GDataQueryProgressCallback progress_callback;
-	gpointer progress_user_data;
+static gboolean
+parse_entry (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* atom:entry */
+	GDataFeed *self = GDATA_FEED (parsable);
+	ParseData *data = user_data;
 	GDataEntry *entry;
-	guint entry_i;
-	guint total_results;
-} ProgressCallbackData;
+	GHashTable *previous_flyweights;
+	GType entry_type;
+
+	/* Build the entry on the entry pool if parallel parsing's enabled. Entries are added to the feed in document order as they're finished. */
+	if (data != NULL && data->entry_pool != NULL) {
+		EntryJob *job;
+
+		job = g_slice_new0 (EntryJob);
+		job->doc = xmlNewDoc ((xmlChar*) "1.0");
+		job->doc->_private = doc->_private; /* the unhandled XML mode */
+		xmlDocSetRootElement (job->doc, xmlDocCopyNode (node, job->doc, 1));
+
+		g_ptr_array_add (data->entry_jobs, job);
+		g_thread_pool_push (data->entry_pool, job, NULL);
+
+		return add_built_entries (self, data, data->max_pending_entries, error);
+	}
+
+	/* Allow @data to be %NULL, and assume we're parsing a vanilla feed, so that we can test #GDataFeed in tests/general.c.
+	 * A little hacky, but not too much so, and valuable for testing. */
+	entry_type = (data != NULL) ? data->entry_type : GDATA_TYPE_ENTRY;
+
+	/* Entries in the same feed tend to have the same categories and authors, so only build one object for each distinct one, and share it between
+	 * them. This isn't done for entries built on the entry pool, since the objects would have to be shared between threads while being built. */
+	if (self->priv->flyweights == NULL)
+		self->priv->flyweights = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+
+	GDATA_TRACE1 (parse_entry_start, node);
+	previous_flyweights = _gdata_parsable_set_flyweights (self->priv->flyweights);
+	entry = GDATA_ENTRY (_gdata_parsable_new_from_xml_node (entry_type, doc, node, NULL, error));
+	_gdata_parsable_set_flyweights (previous_flyweights);
+	GDATA_TRACE1 (parse_entry_end, entry);
+
+	if (entry == NULL)
+		return FALSE;
+
+	/* Calls the callbacks in the main thread */
+	if (data != NULL)
+		_gdata_feed_add_parsed_entry (self, data, entry);
+	else
+		_gdata_feed_add_entry (self, entry);
+	g_object_unref (entry);
+
+	return TRUE;
+}
 
 static gboolean
-parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+parse_opensearch_uint (xmlDoc *doc, xmlNode *node, guint *output, GError **error)
 {
-	gboolean success;
-	GDataFeed *self = GDATA_FEED (parsable);
+	xmlChar *uint_string;
+
+	/* Duplicate checking */
+	if (*output != 0)
+		return gdata_parser_error_duplicate_element (node, error);
+
+	/* Parse the number */
+	uint_string = xmlNodeListGetString (doc, node->children, TRUE);
+	if (uint_string == NULL)
+		return gdata_parser_error_required_content_missing (node, error);
+
+	*output = strtoul ((gchar*) uint_string, NULL, 10);
+	xmlFree (uint_string);
+
+	return TRUE;
+}
+
+/* The most entries the entries array will be pre-sized for, however many the feed's openSearch elements claim it has. No GData service returns
+ * more than this in one page, so a bogus totalResults can't make us allocate a huge array up front. */
+#define MAX_RESERVED_ENTRIES 1000
+
+/* Returns the number of entries this page of the feed is expected to contain, going by whichever of its openSearch elements have been parsed
+ * so far, or 0 if there's no way to tell. */
+static guint
+get_expected_n_entries (GDataFeedPrivate *priv)
+{
+	guint remaining_results = 0;
+
+	if (priv->total_results > 0) {
+		/* startIndex is one-based */
+		guint offset = (priv->start_index > 0) ? priv->start_index - 1 : 0;
+		remaining_results = priv->total_results - MIN (offset, priv->total_results);
+	}
+
+	if (priv->items_per_page > 0 && priv->total_results > 0)
+		return MIN (priv->items_per_page, remaining_results);
+	else if (priv->items_per_page > 0)
+		return priv->items_per_page;
+
+	return remaining_results;
+}
+
+/* Pre-sizes the feed's entries array for the number of entries it's expected to contain, so that it isn't repeatedly reallocated as they're
+ * added. This only happens before the first entry's been added, which is the usual case since the openSearch elements come first in a feed. */
+static void
+reserve_expected_entries (GDataFeed *self, ParseData *data)
+{
+	GDataFeedPrivate *priv = self->priv;
+	guint n_entries;
+
+	/* Entries which are only being streamed to the progress callback don't need any room in the feed */
+	if ((data != NULL && data->retain_entries == FALSE) || priv->entries->len > 0)
+		return;
+
+	n_entries = MIN (get_expected_n_entries (priv), MAX_RESERVED_ENTRIES);
+	if (n_entries <= priv->entries_reserved)
+		return;
+
+	g_ptr_array_unref (priv->entries);
+	priv->entries = g_ptr_array_new_full (n_entries, g_object_unref);
+	priv->entries_reserved = n_entries;
+}
+
+static gboolean
+parse_total_results (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* openSearch:totalResults */
+	if (parse_opensearch_uint (doc, node, &(GDATA_FEED (parsable)->priv->total_results), error) == FALSE)
+		return FALSE;
+
+	reserve_expected_entries (GDATA_FEED (parsable), user_data);
+
+	return TRUE;
+}
+
+static gboolean
+parse_start_index (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* openSearch:startIndex */
+	if (parse_opensearch_uint (doc, node, &(GDATA_FEED (parsable)->priv->start_index), error) == FALSE)
+		return FALSE;
+
+	reserve_expected_entries (GDATA_FEED (parsable), user_data);
+
+	return TRUE;
+}
+
+static gboolean
+parse_items_per_page (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* openSearch:itemsPerPage */
+	if (parse_opensearch_uint (doc, node, &(GDATA_FEED (parsable)->priv->items_per_page), error) == FALSE)
+		return FALSE;
+
+	reserve_expected_entries (GDATA_FEED (parsable), user_data);
+
+	return TRUE;
+}
+
+static gboolean
+parse_link (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	GDataFeedPrivate *priv = GDATA_FEED (parsable)->priv;
 	ParseData *data = user_data;
+	gboolean success;
 
-	if (gdata_parser_is_namespace (node, "http://www.w3.org/2005/Atom") == TRUE) {
-		if (xmlStrcmp (node->name, (xmlChar*) "entry") == 0) {
-			/* atom:entry */
-			GDataEntry *entry;
-			GType entry_type;
+	/* atom:link */
+	gdata_parser_object_from_element_setter (node, "link", P_REQUIRED, GDATA_TYPE_LINK, _gdata_feed_add_link, parsable, &success, error);
 
-			/* Allow @data to be %NULL, and assume we're parsing a vanilla feed, so that we can test #GDataFeed in tests/general.c.
-			 * A little hacky, but not too much so, and valuable for testing. */
-			entry_type = (data != NULL) ? data->entry_type : GDATA_TYPE_ENTRY;
-			entry = GDATA_ENTRY (_gdata_parsable_new_from_xml_node (entry_type, doc, node, NULL, error));
-			if (entry == NULL)
-				return FALSE;
+	/* Links come before the entries in most feeds, so tell the caller about the next page's link straight away, rather than once the whole
+	 * feed's been parsed. The link has just been prepended to the list. */
+	if (success == TRUE && data != NULL && data->next_link_callback != NULL) {
+		GDataLink *_link = GDATA_LINK (priv->links->data);
 
-			/* Calls the callbacks in the main thread */
-			if (data != NULL)
-				_gdata_feed_call_progress_callback (self, data, entry);
-			_gdata_feed_add_entry (self, entry);
-			g_object_unref (entry);
-		} else if (gdata_parser_string_from_element (node, "title", P_NO_DUPES, &(self->priv->title), &success, error) == TRUE ||
-		           gdata_parser_string_from_element (node, "subtitle", P_NO_DUPES, &(self->priv->subtitle), &success, error) == TRUE ||
-		           gdata_parser_string_from_element (node, "id", P_NO_DUPES, &(self->priv->id), &success, error) == TRUE ||
-		           gdata_parser_string_from_element (node, "logo", P_NO_DUPES, &(self->priv->logo), &success, error) == TRUE ||
-		           gdata_parser_string_from_element (node, "icon", P_NO_DUPES, &(self->priv->icon), &success, error) == TRUE ||
-		           gdata_parser_object_from_element_setter (node, "category", P_REQUIRED, GDATA_TYPE_CATEGORY,
-		                                                    _gdata_feed_add_category, self, &success, error) == TRUE ||
-		           gdata_parser_object_from_element_setter (node, "link", P_REQUIRED, GDATA_TYPE_LINK,
-		                                                    _gdata_feed_add_link, self, &success, error) == TRUE ||
-		           gdata_parser_object_from_element_setter (node, "author", P_REQUIRED, GDATA_TYPE_AUTHOR,
-		                                                    _gdata_feed_add_author, self, &success, error) == TRUE ||
-		           gdata_parser_object_from_element (node, "generator", P_REQUIRED | P_NO_DUPES, GDATA_TYPE_GENERATOR,
-		                                             &(self->priv->generator), &success, error) == TRUE ||
-		           gdata_parser_int64_time_from_element (node, "updated", P_REQUIRED | P_NO_DUPES,
-		                                                 &(self->priv->updated), &success, error) == TRUE ||
-		           gdata_parser_string_from_element (node, "rights", P_NONE, &(self->priv->rights), &success, error) == TRUE) {
-			return success;
-		} else {
-			return GDATA_PARSABLE_CLASS (gdata_feed_parent_class)->parse_xml (parsable, doc, node, user_data, error);
+		if (strcmp (gdata_link_get_relation_type (_link), "http://www.iana.org/assignments/relation/next") == 0) {
+			data->next_link_callback (gdata_link_get_uri (_link), data->next_link_user_data);
+			data->next_link_callback = NULL;
 		}
-	} else if (gdata_parser_is_namespace (node, "http://a9.com/-/spec/opensearch/1.1/") == TRUE) {
-		if (xmlStrcmp (node->name, (xmlChar*) "totalResults") == 0) {
-			/* openSearch:totalResults */
-			xmlChar *total_results_string;
-
-			/* Duplicate checking */
-			if (self->priv->total_results != 0)
-				return gdata_parser_error_duplicate_element (node, error);
-
-			/* Parse the number */
-			total_results_string = xmlNodeListGetString (doc, node->children, TRUE);
-			if (total_results_string == NULL)
-				return gdata_parser_error_required_content_missing (node, error);
-
-			self->priv->total_results = strtoul ((gchar*) total_results_string, NULL, 10);
-			xmlFree (total_results_string);
-		} else if (xmlStrcmp (node->name, (xmlChar*) "startIndex") == 0) {
-			/* openSearch:startIndex */
-			xmlChar *start_index_string;
-
-			/* Duplicate checking */
-			if (self->priv->start_index != 0)
-				return gdata_parser_error_duplicate_element (node, error);
-
-			/* Parse the number */
-			start_index_string = xmlNodeListGetString (doc, node->children, TRUE);
-			if (start_index_string == NULL)
-				return gdata_parser_error_required_content_missing (node, error);
-
-			self->priv->start_index = strtoul ((gchar*) start_index_string, NULL, 10);
-			xmlFree (start_index_string);
-		} else if (xmlStrcmp (node->name, (xmlChar*) "itemsPerPage") == 0) {
-			/* openSearch:itemsPerPage */
-			xmlChar *items_per_page_string;
-
-			/* Duplicate checking */
-			if (self->priv->items_per_page != 0)
-				return gdata_parser_error_duplicate_element (node, error);
-
-			/* Parse the number */
-			items_per_page_string = xmlNodeListGetString (doc, node->children, TRUE);
-			if (items_per_page_string == NULL)
-				return gdata_parser_error_required_content_missing (node, error);
-
-			self->priv->items_per_page = strtoul ((gchar*) items_per_page_string, NULL, 10);
-			xmlFree (items_per_page_string);
-		} else {
-			return GDATA_PARSABLE_CLASS (gdata_feed_parent_class)->parse_xml (parsable, doc, node, user_data, error);
-		}
-	} else {
-		return GDATA_PARSABLE_CLASS (gdata_feed_parent_class)->parse_xml (parsable, doc, node, user_data, error);
 	}
 
-	return TRUE;
+	return success;
+}
+
+static void
+register_elements (void)
+{
+	GType type = GDATA_TYPE_FEED;
+	const gchar *atom = "http://www.w3.org/2005/Atom", *opensearch = "http://a9.com/-/spec/opensearch/1.1/";
+
+	gdata_parser_register_func (type, atom, "entry", parse_entry);
+	gdata_parser_register_string (type, atom, "title", P_NO_DUPES, G_STRUCT_OFFSET (GDataFeedPrivate, title));
+	gdata_parser_register_string (type, atom, "subtitle", P_NO_DUPES, G_STRUCT_OFFSET (GDataFeedPrivate, subtitle));
+	gdata_parser_register_string (type, atom, "id", P_NO_DUPES, G_STRUCT_OFFSET (GDataFeedPrivate, id));
+	gdata_parser_register_string (type, atom, "logo", P_NO_DUPES, G_STRUCT_OFFSET (GDataFeedPrivate, logo));
+	gdata_parser_register_string (type, atom, "icon", P_NO_DUPES, G_STRUCT_OFFSET (GDataFeedPrivate, icon));
+	gdata_parser_register_object_setter (type, atom, "category", P_REQUIRED, GDATA_TYPE_CATEGORY, _gdata_feed_add_category);
+	gdata_parser_register_func (type, atom, "link", parse_link);
+	gdata_parser_register_object_setter (type, atom, "author", P_REQUIRED, GDATA_TYPE_AUTHOR, _gdata_feed_add_author);
+	gdata_parser_register_object (type, atom, "generator", P_REQUIRED | P_NO_DUPES, GDATA_TYPE_GENERATOR,
+	                              G_STRUCT_OFFSET (GDataFeedPrivate, generator));
+	gdata_parser_register_int64_time (type, atom, "updated", P_REQUIRED | P_NO_DUPES, G_STRUCT_OFFSET (GDataFeedPrivate, updated));
+	gdata_parser_register_string (type, atom, "rights", P_NONE, G_STRUCT_OFFSET (GDataFeedPrivate, rights));
+
+	gdata_parser_register_func (type, opensearch, "totalResults", parse_total_results);
+	gdata_parser_register_func (type, opensearch, "startIndex", parse_start_index);
+	gdata_parser_register_func (type, opensearch, "itemsPerPage", parse_items_per_page);
+}
+
+static gboolean
+parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	gboolean success;
+
+	/* The elements we understand are registered in register_elements() */
+	if (gdata_parser_dispatch_element (GDATA_TYPE_FEED, parsable, doc, node, user_data, &success, error) == TRUE)
+		return success;
+
+	return GDATA_PARSABLE_CLASS (gdata_feed_parent_class)->parse_xml (parsable, doc, node, user_data, error);
 }
 
 static gboolean
 post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error)
 {
 	GDataFeedPrivate *priv = GDATA_FEED (parsable)->priv;
+	ParseData *data = user_data;
+
+	/* Add any entries which are still being built in parallel */
+	if (data != NULL && data->entry_pool != NULL && add_built_entries (GDATA_FEED (parsable), data, 0, error) == FALSE)
+		return FALSE;
+
+	/* The entries keep references to any objects they share, so the table's no longer needed */
+	if (priv->flyweights != NULL)
+		g_hash_table_unref (priv->flyweights);
+	priv->flyweights = NULL;
 
 	/* Check for missing required elements */
 	/* FIXME: The YouTube comments feed seems to have lost its <feed/title> element, making it an invalid Atom feed and meaning
@@ -550,12 +838,14 @@ post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error)
 	if (priv->updated == -1)
 		return gdata_parser_error_required_element_missing ("updated", "feed", error);
 
-	/* Reverse our lists of stuff */
-	priv->entries = g_list_reverse (priv->entries);
+	/* Reverse our lists of stuff. Entries are already stored in document order. */
 	priv->categories = g_list_reverse (priv->categories);
 	priv->links = g_list_reverse (priv->links);
 	priv->authors = g_list_reverse (priv->authors);
 
+	/* The link index was built against the old order, and look-ups must return the first link in document order */
+	invalidate_link_index (priv);
+
 	return TRUE;
 }
 
@@ -563,7 +853,7 @@ static void
 get_xml (GDataParsable *parsable, GString *xml_string)
 {
 	GDataFeedPrivate *priv = GDATA_FEED (parsable)->priv;
-	GList *entries;
+	guint i;
 	gchar *updated;
 
 	/* NOTE: Only the required elements are implemented at the moment */
@@ -575,20 +865,21 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 	g_free (updated);
 
 	/* Entries */
-	for (entries = priv->entries; entries != NULL; entries = entries->next)
-		_gdata_parsable_get_xml (GDATA_PARSABLE (entries->data), xml_string, FALSE);
+	for (i = 0; i < priv->entries->len; i++)
+		_gdata_parsable_get_xml (GDATA_PARSABLE (g_ptr_array_index (priv->entries, i)), xml_string, FALSE);
 }
 
 static void
 get_namespaces (GDataParsable *parsable, GHashTable *namespaces)
 {
 	GDataFeedPrivate *priv = GDATA_FEED (parsable)->priv;
-	GList *i;
+	guint i;
 
 	/* We can't assume that all the entries in the feed have identical namespaces, so we have to call get_namespaces() for all of them.
 	 * GDataBatchFeeds, for example, can easily contain entries with differing sets of namespaces. */
-	for (i = priv->entries; i != NULL; i = i->next)
-		GDATA_PARSABLE_GET_CLASS (i->data)->get_namespaces (GDATA_PARSABLE (i->data), namespaces);
+	for (i = 0; i < priv->entries->len; i++) {
+		_gdata_parsable_get_namespaces (GDATA_PARSABLE (g_ptr_array_index (priv->entries, i)), namespaces);
+	}
 }
 
 static gboolean
@@ -596,14 +887,27 @@ parse_json (GDataParsable *parsable, JsonReader *reader, gpointer user_data, GEr
 {
 	GDataFeed *self = GDATA_FEED (parsable);
 	ParseData *data = user_data;
+	gboolean success;
 
-	if (g_strcmp0 (json_reader_get_member_name (reader), "items") == 0) {
+	/* JSON APIs paginate using an opaque token rather than a link to the next page */
+	if (gdata_parser_string_from_json_member (reader, "nextPageToken", P_NON_EMPTY | P_NO_DUPES, &(self->priv->next_page_token),
+	                                          &success, error) == TRUE) {
+		return success;
+	} else if (g_strcmp0 (json_reader_get_member_name (reader), "items") == 0) {
+		JsonNode *items;
+		JsonArray *array;
 		gint i, elements;
 
+		/* When the feed is streamed by _gdata_feed_new_from_json(), this is called once for each entry, with a one-element array. Entries are
+		 * appended, so that works the same as being called once with the whole array. */
+		items = _gdata_parsable_get_json_member (parsable, "items");
+		array = (items != NULL && JSON_NODE_HOLDS_ARRAY (items) == TRUE) ? json_node_get_array (items) : NULL;
+
 		/* Loop through the elements array. */
 		for (i = 0, elements = json_reader_count_elements (reader); i < elements; i++) {
 			GDataEntry *entry;
 			GType entry_type;
+			JsonNode *element;
 
 			json_reader_read_element (reader, i);
 
@@ -611,15 +915,27 @@ parse_json (GDataParsable *parsable, JsonReader *reader, gpointer user_data, GEr
 			 * A little hacky, but not too much so, and valuable for testing. */
 			entry_type = (data != NULL) ? data->entry_type : GDATA_TYPE_ENTRY;
 
-			/* Parse the node, passing it the reader cursor. */
-			entry = GDATA_ENTRY (_gdata_parsable_new_from_json_node (entry_type, reader, NULL, error));
+			/* Parse the node directly if we have it, so that the entry can keep its unhandled members by reference; otherwise pass it the
+			 * reader cursor. */
+			element = (array != NULL) ? json_array_get_element (array, i) : NULL;
+
+			GDATA_TRACE1 (parse_entry_start, element);
+
+			if (element != NULL && JSON_NODE_HOLDS_OBJECT (element) == TRUE)
+				entry = GDATA_ENTRY (_gdata_parsable_new_from_json_object (entry_type, json_node_get_object (element), NULL, error));
+			else
+				entry = GDATA_ENTRY (_gdata_parsable_new_from_json_node (entry_type, reader, NULL, error));
+
+			GDATA_TRACE1 (parse_entry_end, entry);
+
 			if (entry == NULL)
 				return FALSE;
 
 			/* Calls the callbacks in the main thread */
 			if (data != NULL)
-				_gdata_feed_call_progress_callback (self, data, entry);
-			_gdata_feed_add_entry (self, entry);
+				_gdata_feed_add_parsed_entry (self, data, entry);
+			else
+				_gdata_feed_add_entry (self, entry);
 			g_object_unref (entry);
 
 			json_reader_end_element (reader);
@@ -634,11 +950,7 @@ parse_json (GDataParsable *parsable, JsonReader *reader, gpointer user_data, GEr
 static gboolean
 post_parse_json (GDataParsable *parsable, gpointer user_data, GError **error)
 {
-	GDataFeedPrivate *priv = GDATA_FEED (parsable)->priv;
-
-	/* Reverse our lists of stuff. */
-	priv->entries = g_list_reverse (priv->entries);
-
+	/* Entries are already stored in document order, so there's nothing to reverse. */
 	return TRUE;
 }
 
@@ -673,7 +985,8 @@ _gdata_feed_new (const gchar *title, const gchar *id, gint64 updated)
 
 GDataFeed *
 _gdata_feed_new_from_xml (GType feed_type, const gchar *xml, gint length, GType entry_type,
-                          GDataQueryProgressCallback progress_callback, gpointer progress_user_data, gboolean is_async, GError **error)
+                          GDataQueryProgressCallback progress_callback, gpointer progress_user_data, gboolean is_async, gboolean retain_entries,
+                          GError **error)
 {
 	ParseData *data;
 	GDataFeed *feed;
@@ -683,8 +996,62 @@ _gdata_feed_new_from_xml (GType feed_type, const gchar *xml, gint length, GType
 	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	data = _gdata_feed_parse_data_new (entry_type, progress_callback, progress_user_data, is_async);
-	feed = GDATA_FEED (_gdata_parsable_new_from_xml (feed_type, xml, length, data, error));
+	/* Stream the feed, so that only one entry's subtree is in memory at any time, and so that progress callbacks are emitted as soon as each
+	 * entry has been parsed rather than once the whole document has been. */
+	data = _gdata_feed_parse_data_new (entry_type, progress_callback, progress_user_data, is_async, retain_entries);
+	feed = GDATA_FEED (_gdata_parsable_new_from_xml_stream (feed_type, xml, length, data, error));
+	_gdata_feed_parse_data_free (data);
+
+	return feed;
+}
+
+/* Equivalent to _gdata_feed_new_from_xml(), but pulls the XML from @read_callback as it becomes available, so parsing can overlap with the network
+ * transfer, and the response body never has to be held in memory in its entirety.
+ *
+ * If @parse_threads is greater than one, the feed's entries are built on that many threads in parallel (or one per processor if it's 0), while this
+ * thread carries on reading the XML. They're still added to the feed, and passed to @progress_callback, in document order. Entries handled by a
+ * subclass's own parse_xml function rather than #GDataFeed's are always built in order in this thread.
+ *
+ * If @next_link_callback is non-%NULL, it's called in this thread with the URI of the feed's <literal>next</literal> link as soon as that's been
+ * parsed (so typically before any of the entries), so that the caller can start requesting the next page while this one is still arriving. It's not
+ * called if the feed has no <literal>next</literal> link, or if parsing fails before it's reached. */
+GDataFeed *
+_gdata_feed_new_from_xml_input (GType feed_type, xmlInputReadCallback read_callback, gpointer read_user_data,
+                                GDataUnhandledXmlMode unhandled_xml_mode, guint parse_threads, GType entry_type,
+                                GDataQueryProgressCallback progress_callback, gpointer progress_user_data, gboolean is_async,
+                                gboolean retain_entries, GDataFeedNextLinkCallback next_link_callback, gpointer next_link_user_data,
+                                GError **error)
+{
+	ParseData *data;
+	GDataFeed *feed;
+
+	g_return_val_if_fail (g_type_is_a (feed_type, GDATA_TYPE_FEED), NULL);
+	g_return_val_if_fail (read_callback != NULL, NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	data = _gdata_feed_parse_data_new (entry_type, progress_callback, progress_user_data, is_async, retain_entries);
+	data->next_link_callback = next_link_callback;
+	data->next_link_user_data = next_link_user_data;
+
+	if (parse_threads == 0)
+		parse_threads = MAX (g_get_num_processors (), 1);
+
+	if (parse_threads > 1) {
+		/* Make sure the entry class is initialised before the pool threads start using it */
+		g_type_class_ref (entry_type);
+
+		data->entry_pool = g_thread_pool_new ((GFunc) entry_job_run, data, parse_threads, FALSE, NULL);
+		data->max_pending_entries = parse_threads * 4;
+		g_mutex_init (&(data->entry_mutex));
+		g_cond_init (&(data->entry_cond));
+		data->entry_jobs = g_ptr_array_new_with_free_func ((GDestroyNotify) entry_job_free);
+	}
+
+	/* Entries built on the entry pool are parsed from copies of their subtrees, so their original XML can't be found */
+	feed = GDATA_FEED (_gdata_parsable_new_from_xml_input (feed_type, read_callback, read_user_data, unhandled_xml_mode,
+	                                                       data->entry_pool == NULL && _gdata_parsable_type_retains_original_xml (entry_type),
+	                                                       data, error));
 	_gdata_feed_parse_data_free (data);
 
 	return feed;
@@ -692,7 +1059,8 @@ _gdata_feed_new_from_xml (GType feed_type, const gchar *xml, gint length, GType
 
 GDataFeed *
 _gdata_feed_new_from_json (GType feed_type, const gchar *json, gint length, GType entry_type,
-                          GDataQueryProgressCallback progress_callback, gpointer progress_user_data, gboolean is_async, GError **error)
+                          GDataQueryProgressCallback progress_callback, gpointer progress_user_data, gboolean is_async, gboolean retain_entries,
+                          GError **error)
 {
 	ParseData *data;
 	GDataFeed *feed;
@@ -702,8 +1070,10 @@ _gdata_feed_new_from_json (GType feed_type, const gchar *json, gint length, GTyp
 	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	data = _gdata_feed_parse_data_new (entry_type, progress_callback, progress_user_data, is_async);
-	feed = GDATA_FEED (_gdata_parsable_new_from_json (feed_type, json, length, data, error));
+	/* As with XML feeds, parse one entry at a time, so that the whole document's tree is never in memory, and progress callbacks are emitted as
+	 * soon as each entry has been parsed */
+	data = _gdata_feed_parse_data_new (entry_type, progress_callback, progress_user_data, is_async, retain_entries);
+	feed = GDATA_FEED (_gdata_parsable_new_from_json_stream (feed_type, json, length, "items", data, error));
 	_gdata_feed_parse_data_free (data);
 
 	return feed;
@@ -715,19 +1085,69 @@ _gdata_feed_new_from_json (GType feed_type, const gchar *json, gint length, GTyp
  *
  * Returns a list of the entries contained in this feed.
  *
+ * The list is owned by the feed, and remains valid for as long as the feed does.
+ *
  * Return value: (element-type GData.Entry) (transfer none): a #GList of #GDataEntry<!-- -->s
  **/
 GList *
 gdata_feed_get_entries (GDataFeed *self)
 {
+	GDataFeedPrivate *priv;
+	GList *entries;
+
 	g_return_val_if_fail (GDATA_IS_FEED (self), NULL);
-	return self->priv->entries;
+
+	priv = self->priv;
+
+	g_mutex_lock (&(priv->indices_mutex));
+
+	/* Build the list lazily from the array, back to front so we can prepend. Once it's been built, it may have been handed out, so it's never
+	 * freed or rebuilt until the feed is disposed; _gdata_feed_add_entry() appends to it instead. */
+	if (priv->entries_list == NULL && priv->entries->len > 0) {
+		guint i;
+
+		for (i = priv->entries->len; i > 0; i--)
+			priv->entries_list = g_list_prepend (priv->entries_list, g_ptr_array_index (priv->entries, i - 1));
+
+		priv->entries_list_tail = g_list_last (priv->entries_list);
+	}
+
+	entries = priv->entries_list;
+
+	g_mutex_unlock (&(priv->indices_mutex));
+
+	return entries;
 }
 
-static gint
-entry_compare_cb (const GDataEntry *entry, const gchar *id)
+/* Entries' IDs can change after they've been indexed; for example, when an entry's updated in place from a response (see
+ * #GDataService:update-entries-in-place). The index is then rebuilt on the next look-up, rather than updated, since another entry might be next in
+ * line for the old ID. */
+static void
+entry_id_notify_cb (GDataEntry *entry, GParamSpec *pspec, GDataFeedPrivate *priv)
+{
+	g_mutex_lock (&(priv->indices_mutex));
+	invalidate_entry_index (priv);
+	g_mutex_unlock (&(priv->indices_mutex));
+}
+
+/* Must be called with indices_mutex held */
+static void
+build_entry_index (GDataFeedPrivate *priv)
 {
-	return strcmp (gdata_entry_get_id (GDATA_ENTRY (entry)), id);
+	guint i;
+
+	priv->entries_by_id = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	for (i = 0; i < priv->entries->len; i++) {
+		GDataEntry *entry = g_ptr_array_index (priv->entries, i);
+		const gchar *entry_id = gdata_entry_get_id (entry);
+
+		/* If there are duplicate IDs, the first entry wins, as it did with a linear search */
+		if (entry_id != NULL && g_hash_table_lookup (priv->entries_by_id, entry_id) == NULL)
+			g_hash_table_insert (priv->entries_by_id, g_strdup (entry_id), entry);
+
+		g_signal_connect (entry, "notify::id", (GCallback) entry_id_notify_cb, priv);
+	}
 }
 
 /**
@@ -744,15 +1164,26 @@ entry_compare_cb (const GDataEntry *entry, const gchar *id)
 GDataEntry *
 gdata_feed_look_up_entry (GDataFeed *self, const gchar *id)
 {
-	GList *element;
+	GDataFeedPrivate *priv;
+	GDataEntry *entry;
 
 	g_return_val_if_fail (GDATA_IS_FEED (self), NULL);
 	g_return_val_if_fail (id != NULL, NULL);
 
-	element = g_list_find_custom (self->priv->entries, id, (GCompareFunc) entry_compare_cb);
-	if (element == NULL)
-		return NULL;
-	return GDATA_ENTRY (element->data);
+	priv = self->priv;
+
+	g_mutex_lock (&(priv->indices_mutex));
+
+	/* Build the index on the first look-up, so that feeds which are only iterated over don't pay for it */
+	if (priv->entries_by_id == NULL)
+		build_entry_index (priv);
+
+	/* The index is invalidated whenever an entry's added or an indexed entry's ID changes, so it's always current */
+	entry = g_hash_table_lookup (priv->entries_by_id, id);
+
+	g_mutex_unlock (&(priv->indices_mutex));
+
+	return entry;
 }
 
 /**
@@ -791,12 +1222,6 @@ gdata_feed_get_links (GDataFeed *self)
 	return self->priv->links;
 }
 
-static gint
-link_compare_cb (const GDataLink *_link, const gchar *rel)
-{
-	return strcmp (gdata_link_get_relation_type ((GDataLink*) _link), rel);
-}
-
 /**
  * gdata_feed_look_up_link:
  * @self: a #GDataFeed
@@ -811,21 +1236,50 @@ link_compare_cb (const GDataLink *_link, const gchar *rel)
 GDataLink *
 gdata_feed_look_up_link (GDataFeed *self, const gchar *rel)
 {
-	GList *element;
+	GDataFeedPrivate *priv;
+	GDataLink *_link;
+	GQuark quark;
 
 	g_return_val_if_fail (GDATA_IS_FEED (self), NULL);
 	g_return_val_if_fail (rel != NULL, NULL);
 
-	element = g_list_find_custom (self->priv->links, rel, (GCompareFunc) link_compare_cb);
-	if (element == NULL)
+	priv = self->priv;
+
+	/* Relation types are interned by GDataLink, so if @rel has never been interned, no link can have it as its relation type. Otherwise,
+	 * the index can be keyed by pointer. */
+	quark = g_quark_try_string (rel);
+	if (quark == 0)
 		return NULL;
-	return GDATA_LINK (element->data);
+
+	g_mutex_lock (&(priv->indices_mutex));
+
+	if (priv->links_by_rel == NULL) {
+		GList *i;
+
+		priv->links_by_rel = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+		for (i = priv->links; i != NULL; i = i->next) {
+			const gchar *relation_type = gdata_link_get_relation_type (GDATA_LINK (i->data));
+
+			if (g_hash_table_lookup (priv->links_by_rel, relation_type) == NULL)
+				g_hash_table_insert (priv->links_by_rel, (gpointer) relation_type, i->data);
+		}
+	}
+
+	_link = g_hash_table_lookup (priv->links_by_rel, g_quark_to_string (quark));
+
+	g_mutex_unlock (&(priv->indices_mutex));
+
+	return _link;
 }
 
 static void
 _gdata_feed_add_link (GDataFeed *self, GDataLink *_link)
 {
+	g_mutex_lock (&(self->priv->indices_mutex));
+	invalidate_link_index (self->priv);
 	self->priv->links = g_list_prepend (self->priv->links, g_object_ref (_link));
+	g_mutex_unlock (&(self->priv->indices_mutex));
 }
 
 /**
@@ -1036,42 +1490,168 @@ gdata_feed_get_total_results (GDataFeed *self)
 	return self->priv->total_results;
 }
 
+/*
+ * _gdata_feed_get_next_page_token:
+ * @self: a #GDataFeed
+ *
+ * Returns the token identifying the next page of results, as given by the <literal>nextPageToken</literal> member of a JSON feed. Atom feeds
+ * link to their next page instead, so this is always %NULL for them.
+ *
+ * Return value: (allow-none): the next page token, or %NULL
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+_gdata_feed_get_next_page_token (GDataFeed *self)
+{
+	g_return_val_if_fail (GDATA_IS_FEED (self), NULL);
+	return self->priv->next_page_token;
+}
+
 void
 _gdata_feed_add_entry (GDataFeed *self, GDataEntry *entry)
 {
+	GDataFeedPrivate *priv;
+
 	g_return_if_fail (GDATA_IS_FEED (self));
 	g_return_if_fail (GDATA_IS_ENTRY (entry));
-	self->priv->entries = g_list_prepend (self->priv->entries, g_object_ref (entry));
+
+	priv = self->priv;
+
+	g_mutex_lock (&(priv->indices_mutex));
+
+	g_ptr_array_add (priv->entries, g_object_ref (entry));
+	invalidate_entry_index (priv);
+
+	/* The list may have been handed out by gdata_feed_get_entries(), so it's extended rather than rebuilt */
+	if (priv->entries_list != NULL)
+		priv->entries_list_tail = g_list_append (priv->entries_list_tail, entry)->next;
+
+	g_mutex_unlock (&(priv->indices_mutex));
+}
+
+static void
+progress_callback_data_free (ProgressCallbackData *data)
+{
+	g_object_unref (data->entry);
+	g_slice_free (ProgressCallbackData, data);
+}
+
+static ProgressQueue *
+progress_queue_ref (ProgressQueue *self)
+{
+	g_atomic_int_inc (&(self->ref_count));
+	return self;
+}
+
+static void
+progress_queue_unref (ProgressQueue *self)
+{
+	if (g_atomic_int_dec_and_test (&(self->ref_count)) == FALSE)
+		return;
+
+	/* Any callbacks which are still queued can only be left if their context's been destroyed */
+	g_queue_foreach (&(self->callbacks), (GFunc) progress_callback_data_free, NULL);
+	g_queue_clear (&(self->callbacks));
+	g_mutex_clear (&(self->mutex));
+	if (self->context != NULL)
+		g_main_context_unref (self->context);
+	if (self->service != NULL)
+		g_object_unref (self->service);
+
+	g_slice_free (ProgressQueue, self);
+}
+
+static gboolean
+progress_queue_idle (ProgressQueue *self)
+{
+	GQueue callbacks = G_QUEUE_INIT;
+	ProgressCallbackData *data;
+
+	/* Take all the callbacks which have been queued so far. Any which are queued while we're calling them will get a new idle source, which
+	 * can't be dispatched until this one's returned, so the callbacks are still called in order. */
+	g_mutex_lock (&(self->mutex));
+	callbacks = self->callbacks;
+	g_queue_init (&(self->callbacks));
+	self->idle_pending = FALSE;
+	g_mutex_unlock (&(self->mutex));
+
+	while ((data = g_queue_pop_head (&callbacks)) != NULL) {
+		data->progress_callback (data->entry, data->entry_i, data->total_results, data->progress_user_data);
+		progress_callback_data_free (data);
+	}
+
+	return FALSE;
+}
+
+static void
+progress_queue_push (ProgressQueue *self, ProgressCallbackData *data)
+{
+	gboolean add_idle;
+
+	g_mutex_lock (&(self->mutex));
+	g_queue_push_tail (&(self->callbacks), data);
+	add_idle = !self->idle_pending;
+	self->idle_pending = TRUE;
+	g_mutex_unlock (&(self->mutex));
+
+	if (add_idle == TRUE) {
+		_gdata_service_progress_idle_add (self->service, self->context, (GSourceFunc) progress_queue_idle, progress_queue_ref (self),
+		                                  (GDestroyNotify) progress_queue_unref);
+	}
 }
 
 gpointer
-_gdata_feed_parse_data_new (GType entry_type, GDataQueryProgressCallback progress_callback, gpointer progress_user_data, gboolean is_async)
+_gdata_feed_parse_data_new (GType entry_type, GDataQueryProgressCallback progress_callback, gpointer progress_user_data, gboolean is_async,
+                            gboolean retain_entries)
 {
 	ParseData *data;
-	data = g_slice_new (ParseData);
+	data = g_slice_new0 (ParseData);
 	data->entry_type = entry_type;
 	data->progress_callback = progress_callback;
 	data->progress_user_data = progress_user_data;
 	data->entry_i = 0;
 	data->is_async = is_async;
+	/* Entries can only be left out of the feed if there's somewhere else for them to go */
+	data->retain_entries = (retain_entries == TRUE || progress_callback == NULL) ? TRUE : FALSE;
+
+	if (is_async == TRUE && progress_callback != NULL) {
+		/* Capture the context and service now, since the callbacks may be queued from other threads */
+		data->progress_queue = g_slice_new0 (ProgressQueue);
+		data->progress_queue->ref_count = 1;
+		data->progress_queue->context = _gdata_service_get_callback_context ();
+		if (data->progress_queue->context != NULL)
+			g_main_context_ref (data->progress_queue->context);
+		data->progress_queue->service = _gdata_service_get_callback_service ();
+		if (data->progress_queue->service != NULL)
+			g_object_ref (data->progress_queue->service);
+		g_mutex_init (&(data->progress_queue->mutex));
+		g_queue_init (&(data->progress_queue->callbacks));
+	}
 
 	return data;
 }
 
 void
-_gdata_feed_parse_data_free (gpointer data)
+_gdata_feed_parse_data_free (gpointer _data)
 {
+	ParseData *data = _data;
+
+	if (data->entry_pool != NULL) {
+		/* If parsing failed, drop the entries which haven't been started, and wait for the rest before freeing them */
+		g_thread_pool_free (data->entry_pool, TRUE, TRUE);
+		g_ptr_array_unref (data->entry_jobs);
+		g_cond_clear (&(data->entry_cond));
+		g_mutex_clear (&(data->entry_mutex));
+		g_type_class_unref (g_type_class_peek (data->entry_type));
+	}
+
+	if (data->progress_queue != NULL)
+		progress_queue_unref (data->progress_queue);
+
 	g_slice_free (ParseData, data);
 }
 
-static gboolean
-progress_callback_idle (ProgressCallbackData *data)
-{
-	data->progress_callback (data->entry, data->entry_i, data->total_results, data->progress_user_data);
-	g_object_unref (data->entry);
-	g_slice_free (ProgressCallbackData, data);
-	return FALSE;
-}
 
 void
 _gdata_feed_call_progress_callback (GDataFeed *self, gpointer user_data, GDataEntry *entry)
@@ -1087,17 +1667,34 @@ _gdata_feed_call_progress_callback (GDataFeed *self, gpointer user_data, GDataEn
 		progress_data->progress_user_data = data->progress_user_data;
 		progress_data->entry = g_object_ref (entry);
 		progress_data->entry_i = data->entry_i;
-		progress_data->total_results = MIN (self->priv->items_per_page, self->priv->total_results);
+		progress_data->total_results = get_expected_n_entries (self->priv);
+
+		GDATA_TRACE3 (progress_dispatch, entry, data->entry_i, data->is_async);
 
 		if (data->is_async == TRUE) {
-			/* Send the callback; use G_PRIORITY_DEFAULT rather than G_PRIORITY_DEFAULT_IDLE
-			* to contend with the priorities used by the callback functions in GAsyncResult */
-			g_idle_add_full (G_PRIORITY_DEFAULT, (GSourceFunc) progress_callback_idle, progress_data, NULL);
+			/* Send the callback to the main context of the thread which started the query, batched with any others which haven't been
+			 * dispatched yet */
+			progress_queue_push (data->progress_queue, progress_data);
 		} else {
 			/* If we're running synchronously, just call the callbacks directly */
-			progress_callback_idle (progress_data);
+			progress_data->progress_callback (progress_data->entry, progress_data->entry_i, progress_data->total_results,
+			                                  progress_data->progress_user_data);
+			progress_callback_data_free (progress_data);
 		}
 	}
 	data->entry_i++;
 }
 
+/* Passes @entry, which has just been parsed as part of @self, to the progress callback in @user_data, and then adds it to @self unless the feed's
+ * entries are only being streamed to the callback. In that case the progress callback holds the only references to @entry once the caller's
+ * released its own, so the feed's memory use doesn't grow with the number of entries. */
+void
+_gdata_feed_add_parsed_entry (GDataFeed *self, gpointer user_data, GDataEntry *entry)
+{
+	ParseData *data = user_data;
+
+	_gdata_feed_call_progress_callback (self, data, entry);
+
+	if (data->retain_entries == TRUE)
+		_gdata_feed_add_entry (self, entry);
+}
@@ -31,6 +31,9 @@
  * Internally, GOA authenticates with the Google servers using the
  * <ulink type="http" url="http://code.google.com/apis/accounts/docs/OAuthForInstalledApps.html">OAuth 1.0</ulink> process.
  *
+ * If GOA reports when the access token will expire, #GDataGoaAuthorizer fetches a new one in the background a couple of minutes beforehand (timed
+ * from the global default main context), so that requests don't normally have to wait for the D-Bus round trips to GOA.
+ *
  * #GDataGoaAuthorizer natively supports authorization against multiple services (unlike #GDataClientLoginAuthorizer), depending entirely on which
  * services the user has enabled for their Google account in GOA. #GDataGoaAuthorizer cannot authenticate for more services than are enabled in GOA.
  *
@@ -67,6 +70,7 @@
 #include "gdata-goa-authorizer.h"
 #include "gdata-authorizer.h"
 #include "gdata-service.h"
+#include "gdata-private.h"
 
 #include "services/calendar/gdata-calendar-service.h"
 #include "services/contacts/gdata-contacts-service.h"
@@ -74,6 +78,10 @@
 
 #define HMAC_SHA1_LEN 20 /* bytes, raw */
 
+/* How long before the access token expires to prefetch a new one in the background. This is larger than the service's proactive refresh margin,
+ * so that normally the new token is in place before any request would have to block on a refresh. */
+#define PREFETCH_MARGIN 120 /* seconds */
+
 static void gdata_goa_authorizer_interface_init (GDataAuthorizerInterface *interface);
 
 /* GDataAuthorizer methods must be thread-safe. */
@@ -87,6 +95,14 @@ struct _GDataGoaAuthorizerPrivate {
 	gchar *access_token;
 	gchar *access_token_secret;
 	GHashTable *authorization_domains;
+	GSource *prefetch_source; /* timeout to refresh the access token in the background shortly before it expires, or NULL */
+
+	/* Pre-formatted Authorization header for OAuth 2.0 accounts, or NULL. This is set atomically at the end of each refresh, and is protected by
+	 * header_lock rather than the global mutex (which is held for the whole of a refresh), so that the OAuth 2.0 hot path in process_request()
+	 * only takes a shared reader lock and doesn't format anything. authorization_domains isn't modified after construction, so may be read
+	 * under either lock. */
+	GRWLock header_lock;
+	gchar *oauth2_header;
 };
 
 enum {
@@ -300,25 +316,19 @@ static void
 gdata_goa_authorizer_add_oauth2_authorization (GDataAuthorizer *authorizer, SoupMessage *message)
 {
 	GDataGoaAuthorizerPrivate *priv;
-	GString *authorization;
 
-	/* This MUST be called with the mutex already locked. */
+	/* This MUST be called with the header lock already locked (for reading, at least). */
 
 	priv = GDATA_GOA_AUTHORIZER (authorizer)->priv;
 
 	/* We can't add an Authorization header without an access token. Let the request fail. GData should refresh us if it gets back a
 	 * "401 Authorization required" response from Google, and then automatically retry the request. */
-	if (priv->access_token == NULL) {
+	if (priv->oauth2_header == NULL) {
 		return;
 	}
 
-	authorization = g_string_new ("OAuth ");
-	g_string_append (authorization, priv->access_token);
-
 	/* Use replace here, not append, to make sure there's only one "Authorization" header. */
-	soup_message_headers_replace (message->request_headers, "Authorization", authorization->str);
-
-	g_string_free (authorization, TRUE);
+	soup_message_headers_replace (message->request_headers, "Authorization", priv->oauth2_header);
 }
 
 static void
@@ -330,10 +340,8 @@ gdata_goa_authorizer_add_authorization (GDataAuthorizer *authorizer, SoupMessage
 
 	priv = GDATA_GOA_AUTHORIZER (authorizer)->priv;
 
-	/* Prefer OAuth 2.0 over OAuth 1.0. */
-	if (goa_object_peek_oauth2_based (priv->goa_object) != NULL) {
-		gdata_goa_authorizer_add_oauth2_authorization (authorizer, message);
-	} else if (goa_object_peek_oauth_based (priv->goa_object) != NULL) {
+	/* OAuth 2.0 is handled without the mutex in process_request(). */
+	if (goa_object_peek_oauth2_based (priv->goa_object) == NULL && goa_object_peek_oauth_based (priv->goa_object) != NULL) {
 		gdata_goa_authorizer_add_oauth1_authorization (authorizer, message);
 	}
 }
@@ -341,7 +349,7 @@ gdata_goa_authorizer_add_authorization (GDataAuthorizer *authorizer, SoupMessage
 static gboolean
 gdata_goa_authorizer_is_authorized (GDataAuthorizer *authorizer, GDataAuthorizationDomain *domain)
 {
-	/* This MUST be called with the mutex already locked. */
+	/* This MUST be called with the mutex or the header lock already locked. */
 
 	if (domain == NULL) {
 		return TRUE;
@@ -422,6 +430,16 @@ gdata_goa_authorizer_dispose (GObject *object)
 
 	priv = GDATA_GOA_AUTHORIZER (object)->priv;
 
+	g_mutex_lock (&mutex);
+
+	if (priv->prefetch_source != NULL) {
+		g_source_destroy (priv->prefetch_source);
+		g_source_unref (priv->prefetch_source);
+		priv->prefetch_source = NULL;
+	}
+
+	g_mutex_unlock (&mutex);
+
 	g_clear_object (&priv->goa_object);
 	g_hash_table_remove_all (priv->authorization_domains);
 
@@ -438,6 +456,8 @@ gdata_goa_authorizer_finalize (GObject *object)
 
 	g_free (priv->access_token);
 	g_free (priv->access_token_secret);
+	g_free (priv->oauth2_header);
+	g_rw_lock_clear (&priv->header_lock);
 	g_hash_table_destroy (priv->authorization_domains);
 
 	/* Chain up to parent's finalize() method. */
@@ -447,6 +467,24 @@ gdata_goa_authorizer_finalize (GObject *object)
 static void
 gdata_goa_authorizer_process_request (GDataAuthorizer *authorizer, GDataAuthorizationDomain *domain, SoupMessage *message)
 {
+	GDataGoaAuthorizerPrivate *priv;
+
+	priv = GDATA_GOA_AUTHORIZER (authorizer)->priv;
+
+	/* Prefer OAuth 2.0 over OAuth 1.0. The OAuth 2.0 header doesn't depend on the message, so is cached and can be added under the reader
+	 * lock, without contending with other requests or waiting for an in-progress refresh. */
+	if (goa_object_peek_oauth2_based (priv->goa_object) != NULL) {
+		g_rw_lock_reader_lock (&priv->header_lock);
+
+		if (gdata_goa_authorizer_is_authorized (authorizer, domain)) {
+			gdata_goa_authorizer_add_oauth2_authorization (authorizer, message);
+		}
+
+		g_rw_lock_reader_unlock (&priv->header_lock);
+
+		return;
+	}
+
 	g_mutex_lock (&mutex);
 
 	if (gdata_goa_authorizer_is_authorized (authorizer, domain)) {
@@ -470,6 +508,45 @@ gdata_goa_authorizer_is_authorized_for_domain (GDataAuthorizer *authorizer, GDat
 	return authorized;
 }
 
+static gboolean
+prefetch_cb (GDataAuthorizer *authorizer)
+{
+	/* Don't touch ->prefetch_source here, since that would need the mutex, which is held for the whole of any in-progress refresh. It's
+	 * cleaned up the next time a refresh schedules a prefetch, or on dispose(), which are both safe once the source has been dispatched. */
+
+	/* Fetch the new token from GOA in a worker thread. This is coalesced with any other refreshes, and requests carry on using the current
+	 * token (which is still valid) in the meantime, so nothing on the request path waits for the D-Bus round trips. */
+	gdata_authorizer_refresh_authorization_async (authorizer, NULL, NULL, NULL);
+
+	return FALSE;
+}
+
+static void
+schedule_prefetch (GDataAuthorizer *authorizer, gint expires_in)
+{
+	GDataGoaAuthorizerPrivate *priv;
+
+	/* This MUST be called with the mutex already locked. */
+
+	priv = GDATA_GOA_AUTHORIZER (authorizer)->priv;
+
+	if (priv->prefetch_source != NULL) {
+		g_source_destroy (priv->prefetch_source);
+		g_source_unref (priv->prefetch_source);
+		priv->prefetch_source = NULL;
+	}
+
+	/* If GOA didn't tell us when the token's going to expire, we'll have to wait for a 401 response as before. */
+	if (expires_in <= 0) {
+		return;
+	}
+
+	/* The source is destroyed in dispose(), so it doesn't need its own reference to the authorizer. */
+	priv->prefetch_source = g_timeout_source_new_seconds (MAX (expires_in - PREFETCH_MARGIN, 1));
+	g_source_set_callback (priv->prefetch_source, (GSourceFunc) prefetch_cb, authorizer, NULL);
+	g_source_attach (priv->prefetch_source, NULL);
+}
+
 static gboolean
 gdata_goa_authorizer_refresh_authorization (GDataAuthorizer *authorizer, GCancellable *cancellable, GError **error)
 {
@@ -477,6 +554,7 @@ gdata_goa_authorizer_refresh_authorization (GDataAuthorizer *authorizer, GCancel
 	GoaOAuthBased *goa_oauth1_based;
 	GoaOAuth2Based *goa_oauth2_based;
 	GoaAccount *goa_account;
+	gint expires_in = 0;
 	gboolean success = FALSE;
 
 	priv = GDATA_GOA_AUTHORIZER (authorizer)->priv;
@@ -501,15 +579,35 @@ gdata_goa_authorizer_refresh_authorization (GDataAuthorizer *authorizer, GCancel
 
 	/* Prefer OAuth 2.0 over OAuth 1.0. */
 	if (goa_oauth2_based != NULL) {
-		success = goa_oauth2_based_call_get_access_token_sync (goa_oauth2_based, &priv->access_token, NULL, cancellable, error);
+		success = goa_oauth2_based_call_get_access_token_sync (goa_oauth2_based, &priv->access_token, &expires_in, cancellable, error);
 	} else if (goa_oauth1_based != NULL) {
-		success = goa_oauth_based_call_get_access_token_sync (goa_oauth1_based, &priv->access_token, &priv->access_token_secret, NULL,
+		success = goa_oauth_based_call_get_access_token_sync (goa_oauth1_based, &priv->access_token, &priv->access_token_secret, &expires_in,
 		                                                      cancellable, error);
 	} else {
 		g_warn_if_reached (); /* should never happen */
 	}
 
+	/* Note the token's lifetime so that the service can refresh it shortly before it expires, rather than waiting for a 401 */
+	_gdata_authorizer_set_expiry_time (authorizer, (success == TRUE) ? expires_in : 0);
+
+	/* …and prefetch a new token in the background before then, so that usually no request has to wait for a refresh at all */
+	schedule_prefetch (authorizer, (success == TRUE) ? expires_in : 0);
+
 exit:
+	/* Swap in the new OAuth 2.0 header (or clear it if the refresh failed). Until now, requests have continued to use the old one. */
+	if (goa_oauth2_based != NULL) {
+		gchar *new_header, *old_header;
+
+		new_header = (success == TRUE && priv->access_token != NULL) ? g_strconcat ("OAuth ", priv->access_token, NULL) : NULL;
+
+		g_rw_lock_writer_lock (&priv->header_lock);
+		old_header = priv->oauth2_header;
+		priv->oauth2_header = new_header;
+		g_rw_lock_writer_unlock (&priv->header_lock);
+
+		g_free (old_header);
+	}
+
 	g_clear_object (&goa_account);
 	g_clear_object (&goa_oauth1_based);
 	g_clear_object (&goa_oauth2_based);
@@ -519,6 +617,110 @@ exit:
 	return success;
 }
 
+typedef struct {
+	GDataAuthorizationDomain *domain;
+	SoupMessage *message;
+} ProcessRequestAsyncData;
+
+static void
+process_request_async_data_free (ProcessRequestAsyncData *data)
+{
+	if (data->domain != NULL) {
+		g_object_unref (data->domain);
+	}
+
+	g_object_unref (data->message);
+
+	g_slice_free (ProcessRequestAsyncData, data);
+}
+
+/* Returns whether a request under @domain can be processed straight away: either there's a token to authorize it with, or it isn't going to be
+ * authorized anyway. */
+static gboolean
+can_process_request_now (GDataAuthorizer *authorizer, GDataAuthorizationDomain *domain)
+{
+	GDataGoaAuthorizerPrivate *priv;
+	gboolean can_process;
+
+	priv = GDATA_GOA_AUTHORIZER (authorizer)->priv;
+
+	if (goa_object_peek_oauth2_based (priv->goa_object) != NULL) {
+		g_rw_lock_reader_lock (&priv->header_lock);
+		can_process = (!gdata_goa_authorizer_is_authorized (authorizer, domain) || priv->oauth2_header != NULL);
+		g_rw_lock_reader_unlock (&priv->header_lock);
+
+		return can_process;
+	}
+
+	/* The mutex is held for the whole of any in-progress refresh, so if it's not free, wait for the refresh to finish rather than blocking. */
+	if (!g_mutex_trylock (&mutex)) {
+		return FALSE;
+	}
+
+	can_process = (!gdata_goa_authorizer_is_authorized (authorizer, domain) || priv->access_token != NULL);
+
+	g_mutex_unlock (&mutex);
+
+	return can_process;
+}
+
+static void
+process_request_refresh_cb (GDataAuthorizer *authorizer, GAsyncResult *async_result, GSimpleAsyncResult *result)
+{
+	ProcessRequestAsyncData *data;
+	GError *error = NULL;
+
+	data = g_simple_async_result_get_op_res_gpointer (result);
+
+	/* If the refresh failed, the request is processed without a token, and is left to fail as it would've done synchronously */
+	if (!gdata_authorizer_refresh_authorization_finish (authorizer, async_result, &error) &&
+	    g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		g_simple_async_result_take_error (result, error);
+	} else {
+		g_clear_error (&error);
+		gdata_goa_authorizer_process_request (authorizer, data->domain, data->message);
+	}
+
+	g_simple_async_result_complete (result);
+	g_object_unref (result);
+}
+
+static void
+gdata_goa_authorizer_process_request_async (GDataAuthorizer *authorizer, GDataAuthorizationDomain *domain, SoupMessage *message,
+                                            GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	ProcessRequestAsyncData *data;
+
+	result = g_simple_async_result_new (G_OBJECT (authorizer), callback, user_data, gdata_goa_authorizer_process_request_async);
+
+	if (can_process_request_now (authorizer, domain)) {
+		gdata_goa_authorizer_process_request (authorizer, domain, message);
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+
+		return;
+	}
+
+	/* There's no token yet, or one is being fetched, so wait for a (coalesced) refresh to finish before processing the request, rather than
+	 * blocking on the mutex or sending the request only for it to be rejected. process_request_refresh_cb() takes ownership of the result. */
+	data = g_slice_new (ProcessRequestAsyncData);
+	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
+	data->message = g_object_ref (message);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) process_request_async_data_free);
+
+	gdata_authorizer_refresh_authorization_async (authorizer, cancellable, (GAsyncReadyCallback) process_request_refresh_cb, result);
+}
+
+static gboolean
+gdata_goa_authorizer_process_request_finish (GDataAuthorizer *authorizer, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (authorizer), gdata_goa_authorizer_process_request_async),
+	                      FALSE);
+
+	return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error);
+}
+
 static void
 gdata_goa_authorizer_class_init (GDataGoaAuthorizerClass *class)
 {
@@ -550,6 +752,8 @@ gdata_goa_authorizer_interface_init (GDataAuthorizerInterface *interface)
 	interface->process_request = gdata_goa_authorizer_process_request;
 	interface->is_authorized_for_domain = gdata_goa_authorizer_is_authorized_for_domain;
 	interface->refresh_authorization = gdata_goa_authorizer_refresh_authorization;
+	interface->process_request_async = gdata_goa_authorizer_process_request_async;
+	interface->process_request_finish = gdata_goa_authorizer_process_request_finish;
 }
 
 static void
@@ -562,6 +766,7 @@ gdata_goa_authorizer_init (GDataGoaAuthorizer *authorizer)
 
 	authorizer->priv = G_TYPE_INSTANCE_GET_PRIVATE (authorizer, GDATA_TYPE_GOA_AUTHORIZER, GDataGoaAuthorizerPrivate);
 	authorizer->priv->authorization_domains = authorization_domains;
+	g_rw_lock_init (&authorizer->priv->header_lock);
 }
 
 /**
@@ -0,0 +1,585 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-incremental-parser
+ * @short_description: GData time-sliced XML parser
+ * @stability: Unstable
+ * @include: gdata/gdata-incremental-parser.h
+ *
+ * #GDataIncrementalParser parses a #GDataParsable (typically a #GDataFeed) from XML a little at a time, so that applications which have to parse
+ * large feeds on their main thread can do so without blocking it for long enough to drop frames or stall input handling.
+ *
+ * Each call to gdata_incremental_parser_step() parses the root element's children (such as a feed's entries) one at a time until either the
+ * #GDataIncrementalParser:time-budget has been used up or #GDataIncrementalParser:max-children of them have been parsed, and then returns, leaving
+ * the rest of the document for the next call. At least one child is parsed by each step, so a parse always makes progress. Once
+ * gdata_incremental_parser_is_finished() returns %TRUE, the result is available from gdata_incremental_parser_get_parsable().
+ *
+ * Alternatively, gdata_incremental_parser_parse_async() runs the steps from idle callbacks in the thread-default main context, returning to the
+ * main loop between them so that other event sources get a chance to run.
+ *
+ * The XML is streamed through the same parser as the services use for feeds, so only one child of the root element is held in memory as a DOM
+ * at any time. As a consequence, the parsable's class may only use the root element's attributes (rather than its children) when starting to
+ * parse it; this is the case for #GDataFeed, #GDataEntry and their subclasses. The original XML of parsed entries isn't retained.
+ *
+ * <example>
+ *	<title>Parsing a Feed Without Blocking the Main Loop</title>
+ *	<programlisting>
+ *	static void
+ *	parse_cb (GDataIncrementalParser *parser, GAsyncResult *async_result, gpointer user_data)
+ *	{
+ *		GDataParsable *feed;
+ *		GError *error = NULL;
+ *
+ *		feed = gdata_incremental_parser_parse_finish (parser, async_result, &error);
+ *
+ *		if (error != NULL) {
+ *			g_error ("Error parsing feed: %s", error->message);
+ *			g_error_free (error);
+ *			return;
+ *		}
+ *
+ *		/<!-- -->* Do something with the feed *<!-- -->/
+ *
+ *		g_object_unref (feed);
+ *	}
+ *
+ *	GDataIncrementalParser *parser;
+ *
+ *	parser = gdata_incremental_parser_new (GDATA_TYPE_FEED, xml, -1);
+ *	gdata_incremental_parser_set_time_budget (parser, 4);
+ *	gdata_incremental_parser_parse_async (parser, NULL, (GAsyncReadyCallback) parse_cb, NULL);
+ *	g_object_unref (parser);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <string.h>
+
+#include "gdata-incremental-parser.h"
+#include "gdata-private.h"
+
+static void gdata_incremental_parser_dispose (GObject *object);
+static void gdata_incremental_parser_finalize (GObject *object);
+static void gdata_incremental_parser_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_incremental_parser_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataIncrementalParserPrivate {
+	GType parsable_type;
+	gchar *xml; /* NULL once the parse has finished */
+	gsize length;
+
+	xmlTextReader *reader; /* NULL until the first step */
+	GDataParsableReader *parsable_reader; /* NULL until the first step, and once the parse has finished or failed */
+	GDataParsable *parsable; /* only set once the parse has finished successfully */
+	gboolean finished;
+	gboolean failed;
+
+	guint time_budget;
+	guint max_children;
+
+	/* Asynchronous parsing */
+	GSimpleAsyncResult *async_result;
+	GCancellable *cancellable;
+	GSource *idle_source;
+};
+
+enum {
+	PROP_TIME_BUDGET = 1,
+	PROP_MAX_CHILDREN,
+};
+
+G_DEFINE_TYPE (GDataIncrementalParser, gdata_incremental_parser, G_TYPE_OBJECT)
+
+static void
+gdata_incremental_parser_class_init (GDataIncrementalParserClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataIncrementalParserPrivate));
+
+	gobject_class->dispose = gdata_incremental_parser_dispose;
+	gobject_class->finalize = gdata_incremental_parser_finalize;
+	gobject_class->get_property = gdata_incremental_parser_get_property;
+	gobject_class->set_property = gdata_incremental_parser_set_property;
+
+	/**
+	 * GDataIncrementalParser:time-budget:
+	 *
+	 * The number of milliseconds each step may spend parsing before returning, or <code class="literal">0</code> for no limit. The budget is
+	 * checked between children of the root element, so a step may overrun it by the time taken to parse a single child.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_TIME_BUDGET,
+	                                 g_param_spec_uint ("time-budget",
+	                                                    "Time budget", "The number of milliseconds each step may spend parsing.",
+	                                                    0, G_MAXUINT, 8,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataIncrementalParser:max-children:
+	 *
+	 * The maximum number of children of the root element (such as a feed's entries) each step may parse, or <code class="literal">0</code>
+	 * for no limit.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MAX_CHILDREN,
+	                                 g_param_spec_uint ("max-children",
+	                                                    "Maximum children", "The maximum number of children each step may parse.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_incremental_parser_init (GDataIncrementalParser *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_INCREMENTAL_PARSER, GDataIncrementalParserPrivate);
+	self->priv->time_budget = 8;
+}
+
+static void
+gdata_incremental_parser_dispose (GObject *object)
+{
+	GDataIncrementalParserPrivate *priv = GDATA_INCREMENTAL_PARSER (object)->priv;
+
+	/* An asynchronous parse holds a reference to the parser, so can't be running at this point */
+	g_assert (priv->async_result == NULL);
+
+	if (priv->parsable != NULL)
+		g_object_unref (priv->parsable);
+	priv->parsable = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_incremental_parser_parent_class)->dispose (object);
+}
+
+static void
+gdata_incremental_parser_finalize (GObject *object)
+{
+	GDataIncrementalParserPrivate *priv = GDATA_INCREMENTAL_PARSER (object)->priv;
+
+	if (priv->parsable_reader != NULL)
+		_gdata_parsable_reader_free (priv->parsable_reader);
+	if (priv->reader != NULL)
+		xmlFreeTextReader (priv->reader);
+	g_free (priv->xml);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_incremental_parser_parent_class)->finalize (object);
+}
+
+static void
+gdata_incremental_parser_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataIncrementalParserPrivate *priv = GDATA_INCREMENTAL_PARSER (object)->priv;
+
+	switch (property_id) {
+		case PROP_TIME_BUDGET:
+			g_value_set_uint (value, priv->time_budget);
+			break;
+		case PROP_MAX_CHILDREN:
+			g_value_set_uint (value, priv->max_children);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_incremental_parser_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataIncrementalParser *self = GDATA_INCREMENTAL_PARSER (object);
+
+	switch (property_id) {
+		case PROP_TIME_BUDGET:
+			gdata_incremental_parser_set_time_budget (self, g_value_get_uint (value));
+			break;
+		case PROP_MAX_CHILDREN:
+			gdata_incremental_parser_set_max_children (self, g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_incremental_parser_new:
+ * @parsable_type: the type of the class represented by the XML
+ * @xml: the XML for the parsable object
+ * @length: the length of @xml, or -1
+ *
+ * Creates a new #GDataIncrementalParser to parse a new instance of @parsable_type from @xml. @xml is copied, so may be freed once this returns.
+ * Nothing is parsed until gdata_incremental_parser_step() or gdata_incremental_parser_parse_async() is called.
+ *
+ * Return value: (transfer full): a new #GDataIncrementalParser; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataIncrementalParser *
+gdata_incremental_parser_new (GType parsable_type, const gchar *xml, gint length)
+{
+	GDataIncrementalParser *self;
+
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
+	g_return_val_if_fail (xml != NULL && *xml != '\0', NULL);
+	g_return_val_if_fail (length >= -1, NULL);
+
+	if (length == -1)
+		length = strlen (xml);
+
+	self = g_object_new (GDATA_TYPE_INCREMENTAL_PARSER, NULL);
+	self->priv->parsable_type = parsable_type;
+	self->priv->xml = g_strndup (xml, length);
+	self->priv->length = length;
+
+	return self;
+}
+
+/**
+ * gdata_incremental_parser_get_time_budget:
+ * @self: a #GDataIncrementalParser
+ *
+ * Gets the #GDataIncrementalParser:time-budget property.
+ *
+ * Return value: the number of milliseconds each step may spend parsing, or <code class="literal">0</code> for no limit
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_incremental_parser_get_time_budget (GDataIncrementalParser *self)
+{
+	g_return_val_if_fail (GDATA_IS_INCREMENTAL_PARSER (self), 0);
+	return self->priv->time_budget;
+}
+
+/**
+ * gdata_incremental_parser_set_time_budget:
+ * @self: a #GDataIncrementalParser
+ * @time_budget: the number of milliseconds each step may spend parsing, or <code class="literal">0</code> for no limit
+ *
+ * Sets the #GDataIncrementalParser:time-budget property. This takes effect from the next step.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_incremental_parser_set_time_budget (GDataIncrementalParser *self, guint time_budget)
+{
+	g_return_if_fail (GDATA_IS_INCREMENTAL_PARSER (self));
+
+	if (self->priv->time_budget == time_budget)
+		return;
+
+	self->priv->time_budget = time_budget;
+	g_object_notify (G_OBJECT (self), "time-budget");
+}
+
+/**
+ * gdata_incremental_parser_get_max_children:
+ * @self: a #GDataIncrementalParser
+ *
+ * Gets the #GDataIncrementalParser:max-children property.
+ *
+ * Return value: the maximum number of children each step may parse, or <code class="literal">0</code> for no limit
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_incremental_parser_get_max_children (GDataIncrementalParser *self)
+{
+	g_return_val_if_fail (GDATA_IS_INCREMENTAL_PARSER (self), 0);
+	return self->priv->max_children;
+}
+
+/**
+ * gdata_incremental_parser_set_max_children:
+ * @self: a #GDataIncrementalParser
+ * @max_children: the maximum number of children each step may parse, or <code class="literal">0</code> for no limit
+ *
+ * Sets the #GDataIncrementalParser:max-children property. This takes effect from the next step.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_incremental_parser_set_max_children (GDataIncrementalParser *self, guint max_children)
+{
+	g_return_if_fail (GDATA_IS_INCREMENTAL_PARSER (self));
+
+	if (self->priv->max_children == max_children)
+		return;
+
+	self->priv->max_children = max_children;
+	g_object_notify (G_OBJECT (self), "max-children");
+}
+
+static void
+parse_failed (GDataIncrementalParser *self)
+{
+	GDataIncrementalParserPrivate *priv = self->priv;
+
+	if (priv->parsable_reader != NULL)
+		_gdata_parsable_reader_free (priv->parsable_reader);
+	priv->parsable_reader = NULL;
+
+	priv->failed = TRUE;
+}
+
+/**
+ * gdata_incremental_parser_step:
+ * @self: a #GDataIncrementalParser
+ * @error: a #GError, or %NULL
+ *
+ * Parses the next part of the document: children of the root element are parsed until the #GDataIncrementalParser:time-budget has been used up,
+ * #GDataIncrementalParser:max-children of them have been parsed, or the end of the document has been reached. The first step also parses the
+ * root element itself.
+ *
+ * Once the end of the document has been reached, gdata_incremental_parser_is_finished() will return %TRUE and the parsed object can be retrieved
+ * using gdata_incremental_parser_get_parsable(). This must not be called again after that, nor after it's returned an error, nor while
+ * gdata_incremental_parser_parse_async() is running.
+ *
+ * If the XML is malformed, a %GDATA_PARSER_ERROR_PARSING_STRING error will be returned; if it's empty, a %GDATA_PARSER_ERROR_EMPTY_DOCUMENT error
+ * will be returned.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_incremental_parser_step (GDataIncrementalParser *self, GError **error)
+{
+	GDataIncrementalParserPrivate *priv;
+	gboolean finished;
+	gint64 end_time;
+
+	g_return_val_if_fail (GDATA_IS_INCREMENTAL_PARSER (self), FALSE);
+	g_return_val_if_fail (self->priv->finished == FALSE && self->priv->failed == FALSE, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = self->priv;
+	end_time = (priv->time_budget > 0) ? g_get_monotonic_time () + (gint64) priv->time_budget * 1000 : -1;
+
+	/* Start parsing on the first step. There's no scanner context pushed for the parse, as the parse outlives this call; so the original XML of
+	 * the root's children isn't kept. */
+	if (priv->reader == NULL) {
+		_gdata_parsable_init_libxml ();
+
+		priv->reader = xmlReaderForMemory (priv->xml, priv->length, "/dev/null", NULL, GDATA_XML_PARSE_OPTIONS);
+		if (priv->reader == NULL) {
+			xmlError *xml_error = xmlGetLastError ();
+			g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+			             /* Translators: the parameter is an error message */
+			             _("Error parsing XML: %s"),
+			             (xml_error != NULL) ? xml_error->message : NULL);
+			parse_failed (self);
+			return FALSE;
+		}
+
+		priv->parsable_reader = _gdata_parsable_reader_new (priv->parsable_type, priv->reader, GDATA_UNHANDLED_XML_KEEP, NULL, error);
+		if (priv->parsable_reader == NULL) {
+			parse_failed (self);
+			return FALSE;
+		}
+	}
+
+	if (_gdata_parsable_reader_step (priv->parsable_reader, priv->max_children, end_time, &finished, error) == FALSE) {
+		parse_failed (self);
+		return FALSE;
+	}
+
+	if (finished == FALSE)
+		return TRUE;
+
+	/* Finished parsing; free the reader and the XML now rather than waiting for the parser to be finalised */
+	priv->parsable = _gdata_parsable_reader_finish (priv->parsable_reader, error);
+	priv->parsable_reader = NULL;
+
+	xmlFreeTextReader (priv->reader);
+	priv->reader = NULL;
+	g_free (priv->xml);
+	priv->xml = NULL;
+
+	if (priv->parsable == NULL) {
+		parse_failed (self);
+		return FALSE;
+	}
+
+	priv->finished = TRUE;
+
+	return TRUE;
+}
+
+/**
+ * gdata_incremental_parser_is_finished:
+ * @self: a #GDataIncrementalParser
+ *
+ * Returns whether the whole document has been parsed successfully.
+ *
+ * Return value: %TRUE if the parse has finished, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_incremental_parser_is_finished (GDataIncrementalParser *self)
+{
+	g_return_val_if_fail (GDATA_IS_INCREMENTAL_PARSER (self), FALSE);
+	return self->priv->finished;
+}
+
+/**
+ * gdata_incremental_parser_get_parsable:
+ * @self: a #GDataIncrementalParser
+ *
+ * Gets the object parsed from the document, once the parse has finished (see gdata_incremental_parser_is_finished()).
+ *
+ * Return value: (transfer none) (allow-none): the parsed object, or %NULL if the parse hasn't finished
+ *
+ * Since: 0.15.0
+ **/
+GDataParsable *
+gdata_incremental_parser_get_parsable (GDataIncrementalParser *self)
+{
+	g_return_val_if_fail (GDATA_IS_INCREMENTAL_PARSER (self), NULL);
+	return self->priv->parsable;
+}
+
+static void
+complete_async_parse (GDataIncrementalParser *self)
+{
+	GDataIncrementalParserPrivate *priv = self->priv;
+	GSimpleAsyncResult *result = priv->async_result;
+
+	priv->async_result = NULL;
+
+	if (priv->cancellable != NULL)
+		g_object_unref (priv->cancellable);
+	priv->cancellable = NULL;
+
+	if (priv->idle_source != NULL) {
+		g_source_destroy (priv->idle_source);
+		g_source_unref (priv->idle_source);
+		priv->idle_source = NULL;
+	}
+
+	/* The result holds a reference to the parser, so it stays alive until the callback has returned */
+	g_simple_async_result_complete (result);
+	g_object_unref (result);
+}
+
+static gboolean
+parse_idle_cb (GDataIncrementalParser *self)
+{
+	GDataIncrementalParserPrivate *priv = self->priv;
+	GError *error = NULL;
+
+	if (g_cancellable_set_error_if_cancelled (priv->cancellable, &error) == TRUE) {
+		parse_failed (self);
+	} else if (gdata_incremental_parser_step (self, &error) == TRUE && priv->finished == FALSE) {
+		/* Give other sources a chance to run before the next step */
+		return TRUE;
+	}
+
+	if (error != NULL) {
+		g_simple_async_result_take_error (priv->async_result, error);
+	}
+
+	complete_async_parse (self);
+
+	return FALSE;
+}
+
+/**
+ * gdata_incremental_parser_parse_async:
+ * @self: a #GDataIncrementalParser
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the parse is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Parses the rest of the document by calling gdata_incremental_parser_step() from a series of idle callbacks in the thread-default main context
+ * of the calling thread, so that other sources in the main context are dispatched between steps. The idle callbacks have priority
+ * %G_PRIORITY_DEFAULT_IDLE, so input and redrawing take precedence over parsing.
+ *
+ * @self is reffed while the parse is running, so can safely be unreffed after this function returns. When the parse is finished, @callback will
+ * be called, and gdata_incremental_parser_parse_finish() should be called to get the parsed object.
+ *
+ * If @cancellable is cancelled, the parse is abandoned before the next step, and a %G_IO_ERROR_CANCELLED error is returned.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_incremental_parser_parse_async (GDataIncrementalParser *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GDataIncrementalParserPrivate *priv;
+	GMainContext *context;
+
+	g_return_if_fail (GDATA_IS_INCREMENTAL_PARSER (self));
+	g_return_if_fail (self->priv->finished == FALSE && self->priv->failed == FALSE);
+	g_return_if_fail (self->priv->async_result == NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	priv = self->priv;
+
+	priv->async_result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_incremental_parser_parse_async);
+	priv->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+
+	context = g_main_context_ref_thread_default ();
+
+	priv->idle_source = g_idle_source_new ();
+	g_source_set_priority (priv->idle_source, G_PRIORITY_DEFAULT_IDLE);
+	g_source_set_callback (priv->idle_source, (GSourceFunc) parse_idle_cb, self, NULL);
+	g_source_attach (priv->idle_source, context);
+
+	g_main_context_unref (context);
+}
+
+/**
+ * gdata_incremental_parser_parse_finish:
+ * @self: a #GDataIncrementalParser
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous parse started with gdata_incremental_parser_parse_async().
+ *
+ * Return value: (transfer full): the parsed object, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataParsable *
+gdata_incremental_parser_parse_finish (GDataIncrementalParser *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_INCREMENTAL_PARSER (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	g_warn_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), gdata_incremental_parser_parse_async));
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == TRUE)
+		return NULL;
+
+	return g_object_ref (self->priv->parsable);
+}
@@ -0,0 +1,84 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_INCREMENTAL_PARSER_H
+#define GDATA_INCREMENTAL_PARSER_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/gdata-parsable.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_INCREMENTAL_PARSER		(gdata_incremental_parser_get_type ())
+#define GDATA_INCREMENTAL_PARSER(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_INCREMENTAL_PARSER, GDataIncrementalParser))
+#define GDATA_INCREMENTAL_PARSER_CLASS(k)	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_INCREMENTAL_PARSER, GDataIncrementalParserClass))
+#define GDATA_IS_INCREMENTAL_PARSER(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_INCREMENTAL_PARSER))
+#define GDATA_IS_INCREMENTAL_PARSER_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_INCREMENTAL_PARSER))
+#define GDATA_INCREMENTAL_PARSER_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_INCREMENTAL_PARSER, GDataIncrementalParserClass))
+
+typedef struct _GDataIncrementalParserPrivate	GDataIncrementalParserPrivate;
+
+/**
+ * GDataIncrementalParser:
+ *
+ * All the fields in the #GDataIncrementalParser structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataIncrementalParserPrivate *priv;
+} GDataIncrementalParser;
+
+/**
+ * GDataIncrementalParserClass:
+ *
+ * All the fields in the #GDataIncrementalParserClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataIncrementalParserClass;
+
+GType gdata_incremental_parser_get_type (void) G_GNUC_CONST;
+
+GDataIncrementalParser *gdata_incremental_parser_new (GType parsable_type, const gchar *xml, gint length) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+guint gdata_incremental_parser_get_time_budget (GDataIncrementalParser *self) G_GNUC_PURE;
+void gdata_incremental_parser_set_time_budget (GDataIncrementalParser *self, guint time_budget);
+guint gdata_incremental_parser_get_max_children (GDataIncrementalParser *self) G_GNUC_PURE;
+void gdata_incremental_parser_set_max_children (GDataIncrementalParser *self, guint max_children);
+
+gboolean gdata_incremental_parser_step (GDataIncrementalParser *self, GError **error);
+gboolean gdata_incremental_parser_is_finished (GDataIncrementalParser *self) G_GNUC_PURE;
+GDataParsable *gdata_incremental_parser_get_parsable (GDataIncrementalParser *self) G_GNUC_PURE;
+
+void gdata_incremental_parser_parse_async (GDataIncrementalParser *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+GDataParsable *gdata_incremental_parser_parse_finish (GDataIncrementalParser *self, GAsyncResult *async_result,
+                                                      GError **error) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* !GDATA_INCREMENTAL_PARSER_H */
@@ -0,0 +1,220 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SECTION:gdata-io-loop
+ * @short_description: GData shared network I/O thread
+ * @stability: Unstable
+ * @include: gdata/gdata-io-loop.h
+ *
+ * #GDataIOLoop is a thread running a main loop over a #GMainContext of its own. Each #GDataService has one, which drives the network activity of
+ * all its #GDataDownloadStream<!-- -->s using libsoup's asynchronous API, rather than each stream having a thread of its own blocked in
+ * soup_session_send_message(). The streams hand work to the loop with gdata_io_loop_invoke(), and the loop hands data back to the streams' readers
+ * through their #GDataBuffer<!-- -->s.
+ *
+ * Code running in the loop's thread must never block, since that would stall every other stream using the loop. The loop's context is the
+ * thread-default context of its thread, so libsoup messages queued from it are processed there.
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-io-loop.h"
+
+/* The thread holds its own reference to the loop (and hence its context), since the #GDataIOLoop may be freed before it exits */
+static gpointer
+io_loop_thread (GMainLoop *loop)
+{
+	GMainContext *context = g_main_loop_get_context (loop);
+
+	g_main_context_push_thread_default (context);
+	g_main_loop_run (loop);
+	g_main_context_pop_thread_default (context);
+
+	g_main_loop_unref (loop);
+
+	return NULL;
+}
+
+/**
+ * gdata_io_loop_new:
+ * @error: a #GError, or %NULL
+ *
+ * Creates a new #GDataIOLoop and starts its thread.
+ *
+ * Return value: a new #GDataIOLoop, or %NULL if its thread couldn't be created; free with gdata_io_loop_free()
+ *
+ * Since: 0.15.0
+ **/
+GDataIOLoop *
+gdata_io_loop_new (GError **error)
+{
+	GDataIOLoop *self = g_slice_new0 (GDataIOLoop);
+
+	self->context = g_main_context_new ();
+	self->loop = g_main_loop_new (self->context, FALSE);
+	self->thread = g_thread_try_new ("gdata-io-thread", (GThreadFunc) io_loop_thread, g_main_loop_ref (self->loop), error);
+
+	if (self->thread == NULL) {
+		g_main_loop_unref (self->loop); /* the thread's reference */
+		g_main_loop_unref (self->loop);
+		g_main_context_unref (self->context);
+		g_slice_free (GDataIOLoop, self);
+
+		return NULL;
+	}
+
+	return self;
+}
+
+static gboolean
+quit_cb (GMainLoop *loop)
+{
+	g_main_loop_quit (loop);
+	return FALSE;
+}
+
+/**
+ * gdata_io_loop_free:
+ * @self: a #GDataIOLoop
+ *
+ * Stops the loop's thread, waiting for it to exit, and frees the loop. Any sources still attached to the loop's context are destroyed without being
+ * dispatched again, so all the work handed to the loop should have finished first.
+ *
+ * This may be called from the loop's own thread (for example, if the last reference to a #GDataService is dropped by a callback running in it), in
+ * which case the thread exits once the current callback returns.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_io_loop_free (GDataIOLoop *self)
+{
+	g_return_if_fail (self != NULL);
+
+	if (gdata_io_loop_is_current_thread (self) == TRUE) {
+		/* We can't join ourselves. g_main_loop_run() returns once the current dispatch has finished, and the thread then exits on its own,
+		 * holding its own reference to the loop until then. */
+		g_main_loop_quit (self->loop);
+		g_thread_unref (self->thread);
+	} else {
+		gdata_io_loop_invoke (self, (GSourceFunc) quit_cb, g_main_loop_ref (self->loop), (GDestroyNotify) g_main_loop_unref);
+		g_thread_join (self->thread);
+	}
+
+	g_main_loop_unref (self->loop);
+	g_main_context_unref (self->context);
+
+	g_slice_free (GDataIOLoop, self);
+}
+
+/**
+ * gdata_io_loop_get_context:
+ * @self: a #GDataIOLoop
+ *
+ * Gets the #GMainContext which the loop runs.
+ *
+ * Return value: (transfer none): the loop's #GMainContext
+ *
+ * Since: 0.15.0
+ **/
+GMainContext *
+gdata_io_loop_get_context (GDataIOLoop *self)
+{
+	g_return_val_if_fail (self != NULL, NULL);
+
+	return self->context;
+}
+
+/**
+ * gdata_io_loop_is_current_thread:
+ * @self: a #GDataIOLoop
+ *
+ * Checks whether the calling thread is the loop's thread.
+ *
+ * Return value: %TRUE if called from the loop's thread, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_io_loop_is_current_thread (GDataIOLoop *self)
+{
+	g_return_val_if_fail (self != NULL, FALSE);
+
+	return (g_thread_self () == self->thread) ? TRUE : FALSE;
+}
+
+/**
+ * gdata_io_loop_invoke:
+ * @self: a #GDataIOLoop
+ * @function: the function to call in the loop's thread
+ * @data: data to pass to @function
+ * @notify: (allow-none): a function to free @data once @function has been called, or %NULL
+ *
+ * Calls @function in the loop's thread. If this is called from the loop's thread, @function is called immediately; otherwise, it's called as soon
+ * as the loop next iterates, and this returns straight away. @function is only ever called once, whatever it returns.
+ *
+ * This function is threadsafe.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_io_loop_invoke (GDataIOLoop *self, GSourceFunc function, gpointer data, GDestroyNotify notify)
+{
+	g_return_if_fail (self != NULL);
+	g_return_if_fail (function != NULL);
+
+	g_main_context_invoke_full (self->context, G_PRIORITY_DEFAULT, function, data, notify);
+}
+
+/**
+ * gdata_io_loop_add_timeout:
+ * @self: a #GDataIOLoop
+ * @ready_time: the monotonic time at which to call @function
+ * @function: the function to call in the loop's thread
+ * @data: data to pass to @function
+ * @notify: (allow-none): a function to free @data once the timeout has been removed, or %NULL
+ *
+ * Calls @function in the loop's thread once the monotonic clock (as returned by g_get_monotonic_time()) reaches @ready_time. As with
+ * g_timeout_add(), @function is called repeatedly until it returns %FALSE.
+ *
+ * This function is threadsafe.
+ *
+ * Return value: (transfer full): the timeout's #GSource, which may be destroyed with g_source_destroy() to remove the timeout; unref with
+ * g_source_unref()
+ *
+ * Since: 0.15.0
+ **/
+GSource *
+gdata_io_loop_add_timeout (GDataIOLoop *self, gint64 ready_time, GSourceFunc function, gpointer data, GDestroyNotify notify)
+{
+	GSource *source;
+	gint64 delay;
+
+	g_return_val_if_fail (self != NULL, NULL);
+	g_return_val_if_fail (function != NULL, NULL);
+
+	/* Round up, so that @function isn't called before @ready_time */
+	delay = MAX (ready_time - g_get_monotonic_time (), 0);
+
+	source = g_timeout_source_new ((guint) MIN ((delay + 999) / 1000, G_MAXUINT));
+	g_source_set_callback (source, function, data, notify);
+	g_source_attach (source, self->context);
+
+	return source;
+}
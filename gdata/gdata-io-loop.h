@@ -0,0 +1,53 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_IO_LOOP_H
+#define GDATA_IO_LOOP_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDataIOLoop:
+ *
+ * All the fields in the #GDataIOLoop structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GMainContext *context;
+	GMainLoop *loop;
+	GThread *thread;
+} GDataIOLoop;
+
+GDataIOLoop *gdata_io_loop_new (GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_io_loop_free (GDataIOLoop *self);
+
+GMainContext *gdata_io_loop_get_context (GDataIOLoop *self) G_GNUC_PURE;
+gboolean gdata_io_loop_is_current_thread (GDataIOLoop *self) G_GNUC_PURE;
+
+void gdata_io_loop_invoke (GDataIOLoop *self, GSourceFunc function, gpointer data, GDestroyNotify notify);
+GSource *gdata_io_loop_add_timeout (GDataIOLoop *self, gint64 ready_time, GSourceFunc function, gpointer data, GDestroyNotify notify)
+                                    G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* !GDATA_IO_LOOP_H */
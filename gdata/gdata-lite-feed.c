@@ -0,0 +1,695 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-lite-feed
+ * @short_description: GData read-only lightweight feed object
+ * @stability: Unstable
+ * @include: gdata/gdata-lite-feed.h
+ *
+ * #GDataLiteFeed is a read-only, compact representation of an Atom feed, intended for applications which only need to read a few common
+ * properties of a large number of entries, such as reporting tools. Rather than building a #GDataEntry (and all of its child objects) for each
+ * entry in the feed, it streams the XML and copies the properties it understands into a single string arena. Each entry is then represented by
+ * a small #GDataLiteEntry structure of offsets into that arena, and the whole feed is freed in one go when the #GDataLiteFeed is finalized.
+ *
+ * Only the ID, ETag, title, summary, content, update and publication times, and links of each entry are kept; everything else in the feed,
+ * including any service-specific elements, is skipped. Entries in a #GDataLiteFeed can't be modified or uploaded. Use a #GDataFeed for that.
+ *
+ * <example>
+ *	<title>Summarising a Large Feed</title>
+ *	<programlisting>
+ *	GDataLiteFeed *feed;
+ *	guint i, n_entries;
+ *	GError *error = NULL;
+ *
+ *	feed = gdata_lite_feed_new_from_xml (feed_xml, -1, &error);
+ *
+ *	if (error != NULL) {
+ *		g_error ("Error parsing feed: %s", error->message);
+ *		g_error_free (error);
+ *		return;
+ *	}
+ *
+ *	n_entries = gdata_lite_feed_get_n_entries (feed);
+ *	for (i = 0; i < n_entries; i++) {
+ *		const GDataLiteEntry *entry = gdata_lite_feed_get_entry (feed, i);
+ *		g_print ("%s: %s\n", gdata_lite_entry_get_id (entry), gdata_lite_entry_get_title (entry));
+ *	}
+ *
+ *	g_object_unref (feed);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <libxml/parser.h>
+#include <libxml/xmlreader.h>
+#include <string.h>
+
+#include "gdata-lite-feed.h"
+#include "gdata-parser.h"
+#include "gdata-private.h"
+#include "gdata-service.h"
+#include "atom/gdata-link.h"
+
+/* All strings are stored in the arena, and referred to by their offset into it. Offset 0 is a nul byte which represents an unset string. */
+typedef guint ArenaOffset;
+
+typedef struct {
+	ArenaOffset relation_type;
+	ArenaOffset uri;
+} LiteLink;
+
+struct _GDataLiteEntry {
+	GDataLiteFeed *feed; /* unowned */
+
+	ArenaOffset id;
+	ArenaOffset etag;
+	ArenaOffset title;
+	ArenaOffset summary;
+	ArenaOffset content;
+	gint64 updated;
+	gint64 published;
+
+	/* Range of the entry's links in the feed's link array */
+	guint first_link;
+	guint n_links;
+};
+
+static void gdata_lite_feed_finalize (GObject *object);
+
+struct _GDataLiteFeedPrivate {
+	GString *arena;
+	GArray/*<GDataLiteEntry>*/ *entries;
+	GArray/*<LiteLink>*/ *links;
+
+	ArenaOffset id;
+	ArenaOffset etag;
+	ArenaOffset title;
+	gint64 updated;
+};
+
+G_DEFINE_TYPE (GDataLiteFeed, gdata_lite_feed, G_TYPE_OBJECT)
+
+static void
+gdata_lite_feed_class_init (GDataLiteFeedClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataLiteFeedPrivate));
+
+	gobject_class->finalize = gdata_lite_feed_finalize;
+}
+
+static void
+gdata_lite_feed_init (GDataLiteFeed *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_LITE_FEED, GDataLiteFeedPrivate);
+
+	self->priv->arena = g_string_new ("");
+	g_string_append_c (self->priv->arena, '\0'); /* reserve offset 0 for unset strings */
+	self->priv->entries = g_array_new (FALSE, TRUE, sizeof (GDataLiteEntry));
+	self->priv->links = g_array_new (FALSE, TRUE, sizeof (LiteLink));
+	self->priv->updated = -1;
+}
+
+static void
+gdata_lite_feed_finalize (GObject *object)
+{
+	GDataLiteFeedPrivate *priv = GDATA_LITE_FEED (object)->priv;
+
+	g_string_free (priv->arena, TRUE);
+	g_array_free (priv->entries, TRUE);
+	g_array_free (priv->links, TRUE);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_lite_feed_parent_class)->finalize (object);
+}
+
+static ArenaOffset
+arena_append (GDataLiteFeed *self, const gchar *str)
+{
+	ArenaOffset offset;
+
+	if (str == NULL)
+		return 0;
+
+	offset = self->priv->arena->len;
+	g_string_append_len (self->priv->arena, str, strlen (str) + 1); /* include the nul terminator */
+
+	return offset;
+}
+
+static inline const gchar *
+arena_get (GDataLiteFeed *self, ArenaOffset offset)
+{
+	return (offset == 0) ? NULL : self->priv->arena->str + offset;
+}
+
+/* Append the text content of @element to the arena. Simple elements only have a single text child, whose content can be copied straight
+ * into the arena without building a temporary string first. */
+static ArenaOffset
+arena_append_content (GDataLiteFeed *self, xmlDoc *doc, xmlNode *element)
+{
+	xmlChar *content;
+	ArenaOffset offset;
+
+	if (element->children == NULL)
+		return arena_append (self, "");
+	else if (element->children->next == NULL && element->children->type == XML_TEXT_NODE)
+		return arena_append (self, (const gchar*) element->children->content);
+
+	content = xmlNodeListGetString (doc, element->children, TRUE);
+	offset = arena_append (self, (content != NULL) ? (const gchar*) content : "");
+	xmlFree (content);
+
+	return offset;
+}
+
+static gboolean
+parse_time (xmlDoc *doc, xmlNode *element, gint64 *output, GError **error)
+{
+	xmlChar *content;
+	gboolean success;
+
+	content = xmlNodeListGetString (doc, element->children, TRUE);
+	if (content == NULL || *content == '\0') {
+		xmlFree (content);
+		return gdata_parser_error_required_content_missing (element, error);
+	}
+
+	success = gdata_parser_int64_from_iso8601 ((gchar*) content, output);
+	if (success == FALSE)
+		gdata_parser_error_not_iso8601_format (element, (gchar*) content, error);
+	xmlFree (content);
+
+	return success;
+}
+
+static gboolean
+parse_link (GDataLiteFeed *self, xmlNode *element, GError **error)
+{
+	LiteLink lite_link;
+	xmlChar *uri, *relation_type;
+
+	uri = xmlGetProp (element, (xmlChar*) "href");
+	if (uri == NULL || *uri == '\0') {
+		xmlFree (uri);
+		return gdata_parser_error_required_property_missing (element, "href", error);
+	}
+
+	/* Normalise the relation type in the same way as gdata_link_set_relation_type(), so that it can be looked up using the same values */
+	relation_type = xmlGetProp (element, (xmlChar*) "rel");
+	if (relation_type == NULL || *relation_type == '\0') {
+		lite_link.relation_type = arena_append (self, GDATA_LINK_ALTERNATE);
+	} else if (strchr ((gchar*) relation_type, ':') == NULL) {
+		gchar *full_relation_type = g_strconcat ("http://www.iana.org/assignments/relation/", (const gchar*) relation_type, NULL);
+		lite_link.relation_type = arena_append (self, full_relation_type);
+		g_free (full_relation_type);
+	} else {
+		lite_link.relation_type = arena_append (self, (const gchar*) relation_type);
+	}
+
+	lite_link.uri = arena_append (self, (const gchar*) uri);
+
+	xmlFree (relation_type);
+	xmlFree (uri);
+
+	g_array_append_val (self->priv->links, lite_link);
+
+	return TRUE;
+}
+
+static ArenaOffset
+arena_append_etag (GDataLiteFeed *self, xmlNode *element)
+{
+	xmlChar *etag;
+	ArenaOffset offset;
+
+	etag = xmlGetNsProp (element, (xmlChar*) "etag", (xmlChar*) "http://schemas.google.com/g/2005");
+	offset = arena_append (self, (const gchar*) etag);
+	xmlFree (etag);
+
+	return offset;
+}
+
+static gboolean
+parse_entry (GDataLiteFeed *self, xmlDoc *doc, xmlNode *entry_element, GError **error)
+{
+	GDataLiteEntry entry = { 0, };
+	xmlNode *node;
+
+	entry.feed = self;
+	entry.etag = arena_append_etag (self, entry_element);
+	entry.updated = -1;
+	entry.published = -1;
+	entry.first_link = self->priv->links->len;
+
+	for (node = entry_element->children; node != NULL; node = node->next) {
+		if (node->type != XML_ELEMENT_NODE || gdata_parser_is_namespace (node, "http://www.w3.org/2005/Atom") == FALSE)
+			continue;
+
+		if (xmlStrcmp (node->name, (xmlChar*) "id") == 0) {
+			entry.id = arena_append_content (self, doc, node);
+		} else if (xmlStrcmp (node->name, (xmlChar*) "title") == 0) {
+			entry.title = arena_append_content (self, doc, node);
+		} else if (xmlStrcmp (node->name, (xmlChar*) "summary") == 0) {
+			entry.summary = arena_append_content (self, doc, node);
+		} else if (xmlStrcmp (node->name, (xmlChar*) "content") == 0) {
+			entry.content = arena_append_content (self, doc, node);
+		} else if (xmlStrcmp (node->name, (xmlChar*) "updated") == 0) {
+			if (parse_time (doc, node, &entry.updated, error) == FALSE)
+				return FALSE;
+		} else if (xmlStrcmp (node->name, (xmlChar*) "published") == 0) {
+			if (parse_time (doc, node, &entry.published, error) == FALSE)
+				return FALSE;
+		} else if (xmlStrcmp (node->name, (xmlChar*) "link") == 0) {
+			if (parse_link (self, node, error) == FALSE)
+				return FALSE;
+		}
+	}
+
+	entry.n_links = self->priv->links->len - entry.first_link;
+	g_array_append_val (self->priv->entries, entry);
+
+	return TRUE;
+}
+
+static gboolean
+parse_feed_child (GDataLiteFeed *self, xmlDoc *doc, xmlNode *node, GError **error)
+{
+	if (node->type != XML_ELEMENT_NODE || gdata_parser_is_namespace (node, "http://www.w3.org/2005/Atom") == FALSE)
+		return TRUE;
+
+	if (xmlStrcmp (node->name, (xmlChar*) "entry") == 0)
+		return parse_entry (self, doc, node, error);
+	else if (xmlStrcmp (node->name, (xmlChar*) "id") == 0)
+		self->priv->id = arena_append_content (self, doc, node);
+	else if (xmlStrcmp (node->name, (xmlChar*) "title") == 0)
+		self->priv->title = arena_append_content (self, doc, node);
+	else if (xmlStrcmp (node->name, (xmlChar*) "updated") == 0)
+		return parse_time (doc, node, &self->priv->updated, error);
+
+	return TRUE;
+}
+
+static void
+set_xml_parsing_error (GError **error)
+{
+	xmlError *xml_error = xmlGetLastError ();
+	g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+	             /* Translators: the parameter is an error message */
+	             _("Error parsing XML: %s"),
+	             (xml_error != NULL) ? xml_error->message : NULL);
+}
+
+/* This follows the structure of _gdata_parsable_new_from_xml_reader(): only one child subtree of the <feed> element is expanded at a time, and is
+ * freed by xmlTextReaderNext() once its properties have been copied into the arena. */
+static gboolean
+parse_feed (GDataLiteFeed *self, xmlTextReader *reader, GError **error)
+{
+	xmlNode *node;
+	xmlDoc *doc;
+	gint ret, root_depth;
+
+	/* Skip over anything preceding the root element, such as the XML declaration or comments */
+	do {
+		ret = xmlTextReaderRead (reader);
+	} while (ret == 1 && xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT);
+
+	if (ret == -1) {
+		set_xml_parsing_error (error);
+		return FALSE;
+	} else if (ret == 0) {
+		/* XML document's empty */
+		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_EMPTY_DOCUMENT,
+		             _("Error parsing XML: %s"),
+		             /* Translators: this is a dummy error message to be substituted into "Error parsing XML: %s". */
+		             _("Empty document."));
+		return FALSE;
+	}
+
+	node = xmlTextReaderCurrentNode (reader);
+	doc = node->doc;
+	root_depth = xmlTextReaderDepth (reader);
+
+	if (xmlStrcmp (node->name, (xmlChar*) "feed") != 0 || gdata_parser_is_namespace (node, "http://www.w3.org/2005/Atom") == FALSE)
+		return gdata_parser_error_required_element_missing ("feed", "root", error);
+
+	self->priv->etag = arena_append_etag (self, node);
+
+	if (xmlTextReaderIsEmptyElement (reader) != 0)
+		return TRUE;
+
+	ret = xmlTextReaderRead (reader);
+
+	while (ret == 1 && xmlTextReaderDepth (reader) > root_depth) {
+		node = xmlTextReaderExpand (reader);
+		if (node == NULL) {
+			ret = -1;
+			break;
+		}
+
+		if (parse_feed_child (self, doc, node, error) == FALSE)
+			return FALSE;
+
+		ret = xmlTextReaderNext (reader);
+	}
+
+	if (ret == -1) {
+		set_xml_parsing_error (error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_lite_feed_new_from_xml:
+ * @xml: the XML for an Atom feed
+ * @length: the length of @xml, or -1
+ * @error: a #GError, or %NULL
+ *
+ * Parses @xml as an Atom feed and returns a new read-only #GDataLiteFeed containing its entries. See the documentation for #GDataLiteFeed for
+ * details of which properties are kept.
+ *
+ * If @length is -1, @xml will be assumed to be nul-terminated.
+ *
+ * If an error occurs during parsing, a suitable error from #GDataParserError or #GDataServiceError will be returned.
+ *
+ * Return value: (transfer full): a new #GDataLiteFeed, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataLiteFeed *
+gdata_lite_feed_new_from_xml (const gchar *xml, gint length, GError **error)
+{
+	GDataLiteFeed *self;
+	xmlTextReader *reader;
+	gboolean success;
+
+	g_return_val_if_fail (xml != NULL && *xml != '\0', NULL);
+	g_return_val_if_fail (length >= -1, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	_gdata_parsable_init_libxml ();
+
+	if (length == -1)
+		length = strlen (xml);
+
+	reader = xmlReaderForMemory (xml, length, "/dev/null", NULL, GDATA_XML_PARSE_OPTIONS);
+	if (reader == NULL) {
+		set_xml_parsing_error (error);
+		return NULL;
+	}
+
+	self = g_object_new (GDATA_TYPE_LITE_FEED, NULL);
+
+	/* The copied text is typically a small fraction of the markup, so this avoids most of the arena's reallocations */
+	g_string_set_size (self->priv->arena, MAX (length / 4, 1));
+	g_string_truncate (self->priv->arena, 1);
+
+	success = parse_feed (self, reader, error);
+	xmlFreeTextReader (reader);
+
+	if (success == FALSE) {
+		g_object_unref (self);
+		return NULL;
+	}
+
+	return self;
+}
+
+/**
+ * gdata_lite_feed_get_id:
+ * @self: a #GDataLiteFeed
+ *
+ * Returns the feed's unique and permanent URN ID, taken from its <code class="literal">&lt;id&gt;</code> element.
+ *
+ * Return value: the feed's ID, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_lite_feed_get_id (GDataLiteFeed *self)
+{
+	g_return_val_if_fail (GDATA_IS_LITE_FEED (self), NULL);
+	return arena_get (self, self->priv->id);
+}
+
+/**
+ * gdata_lite_feed_get_etag:
+ * @self: a #GDataLiteFeed
+ *
+ * Returns the feed's unique ETag for this version.
+ *
+ * Return value: the feed's ETag, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_lite_feed_get_etag (GDataLiteFeed *self)
+{
+	g_return_val_if_fail (GDATA_IS_LITE_FEED (self), NULL);
+	return arena_get (self, self->priv->etag);
+}
+
+/**
+ * gdata_lite_feed_get_title:
+ * @self: a #GDataLiteFeed
+ *
+ * Returns the title of the feed.
+ *
+ * Return value: the feed's title, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_lite_feed_get_title (GDataLiteFeed *self)
+{
+	g_return_val_if_fail (GDATA_IS_LITE_FEED (self), NULL);
+	return arena_get (self, self->priv->title);
+}
+
+/**
+ * gdata_lite_feed_get_updated:
+ * @self: a #GDataLiteFeed
+ *
+ * Gets the time the feed was last updated.
+ *
+ * Return value: the UNIX timestamp for the time the feed was last updated, or <code class="literal">-1</code>
+ *
+ * Since: 0.15.0
+ **/
+gint64
+gdata_lite_feed_get_updated (GDataLiteFeed *self)
+{
+	g_return_val_if_fail (GDATA_IS_LITE_FEED (self), -1);
+	return self->priv->updated;
+}
+
+/**
+ * gdata_lite_feed_get_n_entries:
+ * @self: a #GDataLiteFeed
+ *
+ * Returns the number of entries in the feed.
+ *
+ * Return value: the number of entries
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_lite_feed_get_n_entries (GDataLiteFeed *self)
+{
+	g_return_val_if_fail (GDATA_IS_LITE_FEED (self), 0);
+	return self->priv->entries->len;
+}
+
+/**
+ * gdata_lite_feed_get_entry:
+ * @self: a #GDataLiteFeed
+ * @index: the index of the entry, which must be less than gdata_lite_feed_get_n_entries()
+ *
+ * Returns the entry at @index in the feed, in the order the entries appeared in the XML.
+ *
+ * Return value: (transfer none): the entry at @index, owned by @self
+ *
+ * Since: 0.15.0
+ **/
+const GDataLiteEntry *
+gdata_lite_feed_get_entry (GDataLiteFeed *self, guint index)
+{
+	g_return_val_if_fail (GDATA_IS_LITE_FEED (self), NULL);
+	g_return_val_if_fail (index < self->priv->entries->len, NULL);
+
+	return &g_array_index (self->priv->entries, GDataLiteEntry, index);
+}
+
+/**
+ * gdata_lite_entry_get_id:
+ * @self: a #GDataLiteEntry
+ *
+ * Returns the URN ID of the entry; a unique and permanent identifier for the object the entry represents.
+ *
+ * Return value: the entry's ID, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_lite_entry_get_id (const GDataLiteEntry *self)
+{
+	g_return_val_if_fail (self != NULL, NULL);
+	return arena_get (self->feed, self->id);
+}
+
+/**
+ * gdata_lite_entry_get_etag:
+ * @self: a #GDataLiteEntry
+ *
+ * Returns the ETag of the entry; a unique identifier for each version of the entry.
+ *
+ * Return value: the entry's ETag, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_lite_entry_get_etag (const GDataLiteEntry *self)
+{
+	g_return_val_if_fail (self != NULL, NULL);
+	return arena_get (self->feed, self->etag);
+}
+
+/**
+ * gdata_lite_entry_get_title:
+ * @self: a #GDataLiteEntry
+ *
+ * Returns the title of the entry.
+ *
+ * Return value: the entry's title, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_lite_entry_get_title (const GDataLiteEntry *self)
+{
+	g_return_val_if_fail (self != NULL, NULL);
+	return arena_get (self->feed, self->title);
+}
+
+/**
+ * gdata_lite_entry_get_summary:
+ * @self: a #GDataLiteEntry
+ *
+ * Returns the summary of the entry.
+ *
+ * Return value: the entry's summary, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_lite_entry_get_summary (const GDataLiteEntry *self)
+{
+	g_return_val_if_fail (self != NULL, NULL);
+	return arena_get (self->feed, self->summary);
+}
+
+/**
+ * gdata_lite_entry_get_content:
+ * @self: a #GDataLiteEntry
+ *
+ * Returns the textual content of the entry. Content which is only referenced by URI is not available.
+ *
+ * Return value: the entry's content, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_lite_entry_get_content (const GDataLiteEntry *self)
+{
+	g_return_val_if_fail (self != NULL, NULL);
+	return arena_get (self->feed, self->content);
+}
+
+/**
+ * gdata_lite_entry_get_updated:
+ * @self: a #GDataLiteEntry
+ *
+ * Gets the time the entry was last updated.
+ *
+ * Return value: the UNIX timestamp for the last update of the entry, or <code class="literal">-1</code>
+ *
+ * Since: 0.15.0
+ **/
+gint64
+gdata_lite_entry_get_updated (const GDataLiteEntry *self)
+{
+	g_return_val_if_fail (self != NULL, -1);
+	return self->updated;
+}
+
+/**
+ * gdata_lite_entry_get_published:
+ * @self: a #GDataLiteEntry
+ *
+ * Gets the time the entry was originally published.
+ *
+ * Return value: the UNIX timestamp for the original publish time of the entry, or <code class="literal">-1</code>
+ *
+ * Since: 0.15.0
+ **/
+gint64
+gdata_lite_entry_get_published (const GDataLiteEntry *self)
+{
+	g_return_val_if_fail (self != NULL, -1);
+	return self->published;
+}
+
+/**
+ * gdata_lite_entry_look_up_link_uri:
+ * @self: a #GDataLiteEntry
+ * @rel: the value of the <structfield>rel</structfield> attribute of the desired link
+ *
+ * Looks up a link by relation type from the entry's links, in the same manner as gdata_entry_look_up_link(), and returns its URI. If more than
+ * one link has the given @rel, the URI of the first is returned.
+ *
+ * Return value: the URI of the link, or %NULL if the entry has no link with the given @rel
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_lite_entry_look_up_link_uri (const GDataLiteEntry *self, const gchar *rel)
+{
+	guint i;
+
+	g_return_val_if_fail (self != NULL, NULL);
+	g_return_val_if_fail (rel != NULL, NULL);
+
+	for (i = self->first_link; i < self->first_link + self->n_links; i++) {
+		const LiteLink *lite_link = &g_array_index (self->feed->priv->links, LiteLink, i);
+
+		if (strcmp (arena_get (self->feed, lite_link->relation_type), rel) == 0)
+			return arena_get (self->feed, lite_link->uri);
+	}
+
+	return NULL;
+}
@@ -0,0 +1,93 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_LITE_FEED_H
+#define GDATA_LITE_FEED_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_LITE_FEED		(gdata_lite_feed_get_type ())
+#define GDATA_LITE_FEED(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_LITE_FEED, GDataLiteFeed))
+#define GDATA_LITE_FEED_CLASS(k)	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_LITE_FEED, GDataLiteFeedClass))
+#define GDATA_IS_LITE_FEED(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_LITE_FEED))
+#define GDATA_IS_LITE_FEED_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_LITE_FEED))
+#define GDATA_LITE_FEED_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_LITE_FEED, GDataLiteFeedClass))
+
+typedef struct _GDataLiteFeedPrivate	GDataLiteFeedPrivate;
+
+/**
+ * GDataLiteFeed:
+ *
+ * All the fields in the #GDataLiteFeed structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataLiteFeedPrivate *priv;
+} GDataLiteFeed;
+
+/**
+ * GDataLiteFeedClass:
+ *
+ * All the fields in the #GDataLiteFeedClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataLiteFeedClass;
+
+/**
+ * GDataLiteEntry:
+ *
+ * An opaque read-only entry in a #GDataLiteFeed. It's owned by the feed, and is only valid for as long as the feed is alive.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct _GDataLiteEntry	GDataLiteEntry;
+
+GType gdata_lite_feed_get_type (void) G_GNUC_CONST;
+
+GDataLiteFeed *gdata_lite_feed_new_from_xml (const gchar *xml, gint length, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+const gchar *gdata_lite_feed_get_id (GDataLiteFeed *self) G_GNUC_PURE;
+const gchar *gdata_lite_feed_get_etag (GDataLiteFeed *self) G_GNUC_PURE;
+const gchar *gdata_lite_feed_get_title (GDataLiteFeed *self) G_GNUC_PURE;
+gint64 gdata_lite_feed_get_updated (GDataLiteFeed *self);
+guint gdata_lite_feed_get_n_entries (GDataLiteFeed *self) G_GNUC_PURE;
+const GDataLiteEntry *gdata_lite_feed_get_entry (GDataLiteFeed *self, guint index) G_GNUC_PURE;
+
+const gchar *gdata_lite_entry_get_id (const GDataLiteEntry *self) G_GNUC_PURE;
+const gchar *gdata_lite_entry_get_etag (const GDataLiteEntry *self) G_GNUC_PURE;
+const gchar *gdata_lite_entry_get_title (const GDataLiteEntry *self) G_GNUC_PURE;
+const gchar *gdata_lite_entry_get_summary (const GDataLiteEntry *self) G_GNUC_PURE;
+const gchar *gdata_lite_entry_get_content (const GDataLiteEntry *self) G_GNUC_PURE;
+gint64 gdata_lite_entry_get_updated (const GDataLiteEntry *self);
+gint64 gdata_lite_entry_get_published (const GDataLiteEntry *self);
+const gchar *gdata_lite_entry_look_up_link_uri (const GDataLiteEntry *self, const gchar *rel) G_GNUC_PURE;
+
+G_END_DECLS
+
+#endif /* !GDATA_LITE_FEED_H */
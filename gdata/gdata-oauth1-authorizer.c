@@ -57,6 +57,10 @@
  * Each access token is long lived, so reauthorization is rarely necessary with #GDataOAuth1Authorizer. Consequently, refreshing authorization using
  * gdata_authorizer_refresh_authorization() is not supported by #GDataOAuth1Authorizer, and will immediately return %FALSE with no error set.
  *
+ * Since the access token is long lived, it's worth saving it with gdata_authorizer_save_state() and restoring it into a new #GDataOAuth1Authorizer
+ * with gdata_authorizer_restore_state() when the client is next run, rather than going through the authentication and authorization process again.
+ * The state can only be restored into a #GDataOAuth1Authorizer whose authorization domains were all authorized when the state was saved.
+ *
  * <example>
  *	<title>Authenticating Asynchronously Using OAuth 1.0</title>
  *	<programlisting>
@@ -148,6 +152,9 @@
 
 #define HMAC_SHA1_LEN 20 /* bytes, raw */
 
+/* Version of the format of the state returned by save_state() */
+#define STATE_VERSION 1
+
 static void authorizer_init (GDataAuthorizerInterface *iface);
 static void dispose (GObject *object);
 static void finalize (GObject *object);
@@ -156,9 +163,16 @@ static void set_property (GObject *object, guint property_id, const GValue *valu
 
 static void process_request (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message);
 static gboolean is_authorized_for_domain (GDataAuthorizer *self, GDataAuthorizationDomain *domain);
+static GVariant *save_state (GDataAuthorizer *self);
+static gboolean restore_state (GDataAuthorizer *self, GVariant *state, GError **error);
 
 static void sign_message (GDataOAuth1Authorizer *self, SoupMessage *message, const gchar *token, const gchar *token_secret, GHashTable *parameters);
 
+typedef struct _SigningContext SigningContext;
+static SigningContext *signing_context_new (const gchar *token, const gchar *token_secret);
+static void signing_context_free (SigningContext *context);
+static void sign_message_with_context (SigningContext *context, SoupMessage *message);
+
 static void notify_proxy_uri_cb (GObject *object, GParamSpec *pspec, GDataOAuth1Authorizer *self);
 static void notify_timeout_cb (GObject *gobject, GParamSpec *pspec, GObject *self);
 
@@ -180,6 +194,9 @@ struct _GDataOAuth1AuthorizerPrivate {
 	gchar *token;
 	GDataSecureString token_secret; /* must be allocated by _gdata_service_secure_strdup() */
 
+	/* Precomputed parts of the signature for token and token_secret, built when first needed, and cleared whenever they change. */
+	SigningContext *signing_context;
+
 	/* Mapping from GDataAuthorizationDomain to itself; a set of domains for which ->access_token is valid. */
 	GHashTable *authorization_domains;
 };
@@ -292,6 +309,8 @@ authorizer_init (GDataAuthorizerInterface *iface)
 {
 	iface->process_request = process_request;
 	iface->is_authorized_for_domain = is_authorized_for_domain;
+	iface->save_state = save_state;
+	iface->restore_state = restore_state;
 }
 
 static void
@@ -347,6 +366,9 @@ finalize (GObject *object)
 	g_free (priv->token);
 	_gdata_service_secure_strfree (priv->token_secret);
 
+	if (priv->signing_context != NULL)
+		signing_context_free (priv->signing_context);
+
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_oauth1_authorizer_parent_class)->finalize (object);
 }
@@ -427,7 +449,10 @@ process_request (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMe
 	g_assert ((priv->token == NULL) == (priv->token_secret == NULL));
 
 	if (priv->token != NULL && g_hash_table_lookup (priv->authorization_domains, domain) != NULL) {
-		sign_message (GDATA_OAUTH1_AUTHORIZER (self), message, priv->token, priv->token_secret, NULL);
+		if (priv->signing_context == NULL)
+			priv->signing_context = signing_context_new (priv->token, priv->token_secret);
+
+		sign_message_with_context (priv->signing_context, message);
 	}
 
 	g_mutex_unlock (&(priv->mutex));
@@ -451,6 +476,101 @@ is_authorized_for_domain (GDataAuthorizer *self, GDataAuthorizationDomain *domai
 	return (token != NULL && result != NULL) ? TRUE : FALSE;
 }
 
+static GVariant *
+save_state (GDataAuthorizer *self)
+{
+	GDataOAuth1AuthorizerPrivate *priv = GDATA_OAUTH1_AUTHORIZER (self)->priv;
+	GVariantBuilder builder, scopes_builder;
+	GHashTableIter iter;
+	GDataAuthorizationDomain *domain;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&builder, "{sv}", "type", g_variant_new_string (G_OBJECT_TYPE_NAME (self)));
+	g_variant_builder_add (&builder, "{sv}", "version", g_variant_new_uint32 (STATE_VERSION));
+
+	g_mutex_lock (&(priv->mutex));
+
+	/* Only save the token if we're authorised; the scopes say which domains it's valid for */
+	if (priv->token != NULL) {
+		g_variant_builder_add (&builder, "{sv}", "token", g_variant_new_string (priv->token));
+		g_variant_builder_add (&builder, "{sv}", "token-secret", g_variant_new_string (priv->token_secret));
+
+		g_variant_builder_init (&scopes_builder, G_VARIANT_TYPE_STRING_ARRAY);
+		g_hash_table_iter_init (&iter, priv->authorization_domains);
+
+		while (g_hash_table_iter_next (&iter, (gpointer*) &domain, NULL) == TRUE) {
+			g_variant_builder_add (&scopes_builder, "s", gdata_authorization_domain_get_scope (domain));
+		}
+
+		g_variant_builder_add (&builder, "{sv}", "scopes", g_variant_builder_end (&scopes_builder));
+	}
+
+	g_mutex_unlock (&(priv->mutex));
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static gboolean
+restore_state (GDataAuthorizer *self, GVariant *state, GError **error)
+{
+	GDataOAuth1AuthorizerPrivate *priv = GDATA_OAUTH1_AUTHORIZER (self)->priv;
+	const gchar *token = NULL, *token_secret = NULL;
+	const gchar **scopes = NULL;
+	GHashTableIter iter;
+	GDataAuthorizationDomain *domain;
+	gboolean valid;
+
+	if (_gdata_authorizer_check_state (state, G_OBJECT_TYPE_NAME (self), STATE_VERSION, error) == FALSE) {
+		return FALSE;
+	}
+
+	g_variant_lookup (state, "token", "&s", &token);
+	g_variant_lookup (state, "token-secret", "&s", &token_secret);
+	g_variant_lookup (state, "scopes", "^a&s", &scopes);
+
+	/* Either the state is authorised, with a token, secret and scopes; or it's not, with none of them */
+	valid = (token == NULL && token_secret == NULL && scopes == NULL) ||
+	        (token != NULL && *token != '\0' && token_secret != NULL && *token_secret != '\0' && scopes != NULL);
+
+	g_mutex_lock (&(priv->mutex));
+
+	/* The token's only valid for us if it was authorised for all of our domains */
+	if (valid == TRUE && token != NULL) {
+		g_hash_table_iter_init (&iter, priv->authorization_domains);
+
+		while (valid == TRUE && g_hash_table_iter_next (&iter, (gpointer*) &domain, NULL) == TRUE) {
+			const gchar **scope;
+
+			for (scope = scopes; *scope != NULL && strcmp (*scope, gdata_authorization_domain_get_scope (domain)) != 0; scope++);
+			valid = (*scope != NULL) ? TRUE : FALSE;
+		}
+	}
+
+	if (valid == TRUE) {
+		g_free (priv->token);
+		priv->token = g_strdup (token);
+
+		_gdata_service_secure_strfree (priv->token_secret);
+		priv->token_secret = _gdata_service_secure_strdup (token_secret);
+
+		if (priv->signing_context != NULL) {
+			signing_context_free (priv->signing_context);
+			priv->signing_context = NULL;
+		}
+	}
+
+	g_mutex_unlock (&(priv->mutex));
+
+	g_free (scopes);
+
+	if (valid == FALSE) {
+		g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "The authorization state is not valid for this %s.", G_OBJECT_TYPE_NAME (self));
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 /* Sign the message and add the Authorization header to it containing the signature.
  * NOTE: This must not lock priv->mutex, as it's called from within a critical section in process_request() and priv->mutex isn't recursive. */
 static void
@@ -621,6 +741,133 @@ sign_message (GDataOAuth1Authorizer *self, SoupMessage *message, const gchar *to
 	free (nonce);
 }
 
+/* The parts of the signature computed by sign_message() which only depend on the access token and its secret, so that they're computed once per
+ * token rather than for every request. This is only used for signing normal requests (in process_request()), which only have the standard OAuth
+ * parameters; requests made during the authorization process go through sign_message(). */
+struct _SigningContext {
+	/* The percent-encoded token, for the Authorization header */
+	gchar *encoded_token;
+	/* The end of the (sorted) parameter string after oauth_timestamp, percent-encoded again as it appears in the signature base string */
+	gchar *encoded_params_tail;
+	/* An HMAC keyed with the consumer secret and token secret, which is copied for each signature so the key doesn't have to be re-processed */
+	GHmac *hmac;
+};
+
+static SigningContext *
+signing_context_new (const gchar *token, const gchar *token_secret)
+{
+	SigningContext *context;
+	GString *string;
+
+	g_return_val_if_fail (token != NULL && *token != '\0', NULL);
+	g_return_val_if_fail (token_secret != NULL && *token_secret != '\0', NULL);
+
+	context = g_slice_new (SigningContext);
+
+	string = g_string_new (NULL);
+	g_string_append_uri_escaped (string, token, NULL, FALSE);
+	context->encoded_token = g_string_free (string, FALSE);
+
+	/* The parameters are sorted by their encoded "key=value" pairs, so oauth_token and oauth_version always come last; see sign_message() */
+	string = g_string_new ("&oauth_token=");
+	g_string_append (string, context->encoded_token);
+	g_string_append (string, "&oauth_version=1.0");
+	context->encoded_params_tail = g_uri_escape_string (string->str, NULL, FALSE);
+	g_string_free (string, TRUE);
+
+	/* Build the secret key to use in the HMAC, as in sign_message() (the consumer secret is "anonymous") */
+	string = g_string_new ("anonymous&");
+	g_string_append_uri_escaped (string, token_secret, NULL, FALSE);
+
+	context->hmac = g_hmac_new (G_CHECKSUM_SHA1, (const guchar*) string->str, string->len);
+
+	/* Zero out the secret_string before freeing it, to reduce the chance of secrets hitting disk. */
+	memset (string->str, 0, string->allocated_len);
+	g_string_free (string, TRUE);
+
+	return context;
+}
+
+static void
+signing_context_free (SigningContext *context)
+{
+	g_free (context->encoded_token);
+	g_free (context->encoded_params_tail);
+	g_hmac_unref (context->hmac);
+	g_slice_free (SigningContext, context);
+}
+
+/* Sign the message and add the Authorization header to it, giving exactly the same result as sign_message() would with the context's token and
+ * token secret and no other parameters, but only computing the parts which vary between requests: the nonce, timestamp, method and URI. */
+static void
+sign_message_with_context (SigningContext *context, SoupMessage *message)
+{
+	GString *string;
+	SoupURI *normalised_uri;
+	GHmac *signature_hmac;
+	gchar *uri, *signature, *encoded_nonce, timestamp[32];
+	char *nonce;
+	GTimeVal time_val;
+	guchar signature_buf[HMAC_SHA1_LEN];
+	gsize signature_buf_len;
+
+	nonce = oauth_gen_nonce ();
+	encoded_nonce = g_uri_escape_string (nonce, NULL, FALSE);
+	g_get_current_time (&time_val);
+	g_snprintf (timestamp, sizeof (timestamp), "%li", time_val.tv_sec);
+
+	/* Normalise the URI as described here: http://tools.ietf.org/html/rfc5849#section-3.4.1.2 */
+	normalised_uri = soup_uri_copy (soup_message_get_uri (message));
+	soup_uri_set_query (normalised_uri, NULL);
+	soup_uri_set_fragment (normalised_uri, NULL);
+	uri = soup_uri_to_string (normalised_uri, FALSE);
+	soup_uri_free (normalised_uri);
+
+	/* Build the signature base string as described here: http://tools.ietf.org/html/rfc5849#section-3.4.1.1. The constant parts of the
+	 * parameter string are already encoded (twice), and the timestamp is all digits so doesn't need encoding. */
+	string = g_string_sized_new (256);
+	g_string_append_uri_escaped (string, message->method, NULL, FALSE);
+	g_string_append_c (string, '&');
+	g_string_append_uri_escaped (string, uri, NULL, FALSE);
+	g_string_append (string, "&oauth_consumer_key%3Danonymous%26oauth_nonce%3D");
+	g_string_append_uri_escaped (string, encoded_nonce, NULL, FALSE);
+	g_string_append (string, "%26oauth_signature_method%3DHMAC-SHA1%26oauth_timestamp%3D");
+	g_string_append (string, timestamp);
+	g_string_append (string, context->encoded_params_tail);
+
+	g_free (uri);
+
+	/* Create the signature as described here: http://tools.ietf.org/html/rfc5849#section-3.4.2 */
+	signature_hmac = g_hmac_copy (context->hmac);
+	g_hmac_update (signature_hmac, (const guchar*) string->str, string->len);
+
+	signature_buf_len = G_N_ELEMENTS (signature_buf);
+	g_hmac_get_digest (signature_hmac, signature_buf, &signature_buf_len);
+
+	g_hmac_unref (signature_hmac);
+
+	signature = g_base64_encode (signature_buf, signature_buf_len);
+
+	/* Build the Authorization header and append it to the message, reusing the string */
+	g_string_truncate (string, 0);
+	g_string_append (string, "OAuth oauth_consumer_key=\"anonymous\",oauth_token=\"");
+	g_string_append (string, context->encoded_token);
+	g_string_append (string, "\",oauth_signature_method=\"HMAC-SHA1\",oauth_signature=\"");
+	g_string_append_uri_escaped (string, signature, NULL, FALSE);
+	g_string_append (string, "\",oauth_timestamp=\"");
+	g_string_append (string, timestamp);
+	g_string_append (string, "\",oauth_nonce=\"");
+	g_string_append (string, encoded_nonce);
+	g_string_append (string, "\",oauth_version=\"1.0\"");
+
+	soup_message_headers_replace (message->request_headers, "Authorization", string->str);
+
+	g_string_free (string, TRUE);
+	g_free (signature);
+	g_free (encoded_nonce);
+	free (nonce);
+}
+
 /**
  * gdata_oauth1_authorizer_new:
  * @application_name: (allow-none): a human-readable, translated application name to use on authentication pages, or %NULL
@@ -1127,6 +1374,11 @@ gdata_oauth1_authorizer_request_authorization (GDataOAuth1Authorizer *self, cons
 	_gdata_service_secure_strfree (priv->token_secret);
 	priv->token_secret = _gdata_service_secure_strdup (_token_secret);
 
+	if (priv->signing_context != NULL) {
+		signing_context_free (priv->signing_context);
+		priv->signing_context = NULL;
+	}
+
 	g_mutex_unlock (&(priv->mutex));
 
 	/* Zero out the secret token before freeing the hash table, to reduce the chance of it hitting disk later. */
@@ -0,0 +1,140 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SECTION:gdata-packed-strings
+ * @short_description: GData compact string field storage
+ * @stability: Unstable
+ * @include: gdata/gdata-packed-strings.h
+ *
+ * #GDataPackedStrings stores a fixed set of optional string fields, such as the components of a postal address, in a single allocation. It's
+ * intended to be embedded in the private structures of parsables which have lots of string fields, most of which are unset in practice: rather
+ * than a pointer and a separate allocation for each field, only a bitmap of the fields which are set and one block holding their values are
+ * needed. A #GDataPackedStrings which is all zeros is valid, and has no fields set.
+ *
+ * Getting a field is constant-time. Setting one rebuilds the block, so this is only suitable for fields which are rarely modified once they've
+ * been parsed.
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+
+#include "gdata-packed-strings.h"
+
+static guint
+count_bits (guint32 bits)
+{
+	guint count = 0;
+
+	for (; bits != 0; bits &= bits - 1)
+		count++;
+
+	return count;
+}
+
+/* Clears all the fields of @self, leaving it empty. */
+void
+gdata_packed_strings_clear (GDataPackedStrings *self)
+{
+	g_free (self->data);
+	self->data = NULL;
+	self->present = 0;
+}
+
+/* Returns the value of field @index of @self, or %NULL if it's unset. The string is owned by @self, and is invalidated by the next modification of
+ * any of its fields. */
+const gchar *
+gdata_packed_strings_get (const GDataPackedStrings *self, guint index)
+{
+	guint32 bit;
+
+	g_return_val_if_fail (index < GDATA_PACKED_STRINGS_MAX, NULL);
+
+	bit = (guint32) 1 << index;
+	if ((self->present & bit) == 0)
+		return NULL;
+
+	/* The string's offset is stored after those of the present strings with lower indices */
+	return self->data + ((const guint32*) self->data)[count_bits (self->present & (bit - 1))];
+}
+
+/* Sets field @index of @self to a copy of @value, which may be %NULL to unset it. @value may be the value of one of the fields of @self. */
+void
+gdata_packed_strings_set (GDataPackedStrings *self, guint index, const gchar *value)
+{
+	const gchar *values[GDATA_PACKED_STRINGS_MAX];
+	gsize lengths[GDATA_PACKED_STRINGS_MAX];
+	guint32 present;
+	gsize size, offset;
+	gchar *data;
+	guint i, n;
+
+	g_return_if_fail (index < GDATA_PACKED_STRINGS_MAX);
+
+	/* Nothing to do? */
+	if (value == NULL && (self->present & ((guint32) 1 << index)) == 0)
+		return;
+
+	present = (value != NULL) ? self->present | ((guint32) 1 << index) : self->present & ~((guint32) 1 << index);
+
+	if (present == 0) {
+		gdata_packed_strings_clear (self);
+		return;
+	}
+
+	/* Work out the size of the new block. The old one can't be freed until the new one's been built, as @value might point into it. */
+	size = count_bits (present) * sizeof (guint32);
+
+	for (i = 0; i < GDATA_PACKED_STRINGS_MAX; i++) {
+		if ((present & ((guint32) 1 << i)) == 0)
+			continue;
+
+		values[i] = (i == index) ? value : gdata_packed_strings_get (self, i);
+		lengths[i] = strlen (values[i]) + 1;
+		size += lengths[i];
+	}
+
+	g_return_if_fail (size <= G_MAXUINT32);
+
+	/* Build it */
+	data = g_malloc (size);
+	offset = count_bits (present) * sizeof (guint32);
+
+	for (i = 0, n = 0; i < GDATA_PACKED_STRINGS_MAX; i++) {
+		if ((present & ((guint32) 1 << i)) == 0)
+			continue;
+
+		((guint32*) data)[n++] = (guint32) offset;
+		memcpy (data + offset, values[i], lengths[i]);
+		offset += lengths[i];
+	}
+
+	g_free (self->data);
+	self->data = data;
+	self->present = present;
+}
+
+/* Like gdata_packed_strings_set(), but takes ownership of @value, which must have been allocated with g_malloc(). */
+void
+gdata_packed_strings_take (GDataPackedStrings *self, guint index, gchar *value)
+{
+	gdata_packed_strings_set (self, index, value);
+	g_free (value);
+}
@@ -0,0 +1,51 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_PACKED_STRINGS_H
+#define GDATA_PACKED_STRINGS_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* The maximum number of strings which can be stored in a #GDataPackedStrings */
+#define GDATA_PACKED_STRINGS_MAX 32
+
+/**
+ * GDataPackedStrings:
+ *
+ * All the fields in the #GDataPackedStrings structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	guint32 present; /* bit n is set if string n is non-%NULL */
+	gchar *data; /* the offsets of the present strings (as guint32s), followed by the strings themselves; or %NULL if none are present */
+} GDataPackedStrings;
+
+void gdata_packed_strings_clear (GDataPackedStrings *self);
+
+const gchar *gdata_packed_strings_get (const GDataPackedStrings *self, guint index) G_GNUC_PURE;
+void gdata_packed_strings_set (GDataPackedStrings *self, guint index, const gchar *value);
+void gdata_packed_strings_take (GDataPackedStrings *self, guint index, gchar *value);
+
+G_END_DECLS
+
+#endif /* !GDATA_PACKED_STRINGS_H */
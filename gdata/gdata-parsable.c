@@ -36,11 +36,13 @@
 #include <glib/gi18n-lib.h>
 #include <string.h>
 #include <libxml/parser.h>
+#include <libxml/xmlreader.h>
 #include <json-glib/json-glib.h>
 
 #include "gdata-parsable.h"
 #include "gdata-private.h"
 #include "gdata-parser.h"
+#include "gdata-xml-scanner.h"
 
 GQuark
 gdata_parser_error_quark (void)
@@ -50,26 +52,138 @@ gdata_parser_error_quark (void)
 
 static void gdata_parsable_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_parsable_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+static void gdata_parsable_constructed (GObject *object);
 static void gdata_parsable_finalize (GObject *object);
+static void gdata_parsable_dispatch_properties_changed (GObject *object, guint n_pspecs, GParamSpec **pspecs);
 static gboolean real_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
 static gboolean real_parse_json (GDataParsable *parsable, JsonReader *reader, gpointer user_data, GError **error);
 static const gchar *get_content_type (void);
+static void update_accounts (GDataParsable *self, gboolean is_new);
 
+/* The extra_* members are only allocated once there's unhandled content to store in them. Most parsables (especially the many small gd:* and
+ * atom:* objects owned by each entry) never have any, so this saves several allocations per object. */
 struct _GDataParsablePrivate {
 	/* XML stuff. */
-	GString *extra_xml;
-	GHashTable *extra_namespaces;
+	GString *extra_xml; /* or NULL */
+	GHashTable *extra_namespaces; /* or NULL */
+	xmlDoc *extra_doc; /* unhandled XML which hasn't been serialised into extra_xml yet; see GDATA_UNHANDLED_XML_LAZY */
 
 	/* JSON stuff. */
-	GHashTable/*<gchar*, owned JsonNode*>*/ *extra_json;
+	GHashTable/*<gchar*, owned JsonNode*>*/ *extra_json; /* or NULL */
+	JsonObject *json_object; /* unowned; the object whose members are being parsed, if it's available, or NULL */
 
 	gboolean constructed_from_xml;
+	gboolean parsing; /* TRUE from construction until the object's post-parse function has returned */
+
+	/* The XML the parsable was parsed from, or the XML of the parsable it was parsed as part of; see _gdata_parsable_get_original_xml() */
+	struct _OriginalXml *original_xml; /* or NULL */
+	gboolean owns_original_xml; /* TRUE if @original_xml is the parsable's own XML */
+
+	/* Memory accounting; see gdata_parsable_set_accounting_enabled() */
+	gboolean accounted; /* TRUE if the parsable was constructed while accounting was enabled, and so is included in the accounts */
+	gsize accounted_bytes; /* the parsable's size, as last measured by update_accounts() */
+
+	/* TRUE if the parsable may be referenced by several parents, and so mustn't be modified; see _gdata_parsable_new_shared_from_xml_node() */
+	gboolean shared;
 };
 
+/* The XML which a parsable was parsed from, kept so that it can be output again verbatim for as long as the parsable is unmodified. It's shared with
+ * all the parsables which were constructed while it was being parsed (such as its links and categories), since modifying any of them invalidates
+ * it too. */
+typedef struct _OriginalXml {
+	volatile gint ref_count;
+	volatile gint modified; /* set once the parsable or any of its children have been modified */
+	gchar *xml;
+	gsize length;
+	gsize content_offset; /* offset of the element's content in @xml, just after its start tag */
+} OriginalXml;
+
+/* The document being parsed by _gdata_parsable_new_from_xml() or one of its streaming equivalents, so that the text of its root element and of the
+ * root's children can be found for parsables which retain their original XML. */
+typedef struct {
+	GDataXmlScanner scanner;
+	xmlNode *root_node; /* or NULL if it hasn't been reached yet */
+	xmlNode *child_node; /* the child of @root_node currently being parsed, or NULL */
+	guint child_index; /* the index of @child_node among the element children of @root_node */
+	guint n_children;
+	gpointer previous_context; /* the context to restore once the document's been parsed */
+} ScannerContext;
+
 enum {
 	PROP_CONSTRUCTED_FROM_XML = 1,
 };
 
+/* Namespace declarations for a class, built the first time one of its instances is serialised at the top level. These are attached to the class'
+ * GType as qdata, and never freed. Classes whose namespaces depend on the state of their instances (marked using
+ * _gdata_parsable_class_set_dynamic_namespaces()) don't get one. */
+typedef struct {
+	GHashTable *namespaces; /* owned prefix → owned href */
+	gchar *declarations; /* xmlns attributes for the default Atom namespace and for everything in @namespaces */
+	gsize declarations_length;
+} NamespaceCache;
+
+static GQuark namespace_cache_quark = 0;
+static GQuark dynamic_namespaces_quark = 0;
+static GQuark clone_func_quark = 0;
+static GQuark original_xml_func_quark = 0;
+static GQuark json_write_func_quark = 0;
+static GQuark shareable_quark = 0;
+static GQuark readable_properties_quark = 0;
+
+/* Set by new_constructed_from_xml() for the duration of its g_object_new() call; see gdata_parsable_init() */
+static GPrivate constructing_from_xml = G_PRIVATE_INIT (NULL);
+/* The ScannerContext for the document being parsed in this thread, if any */
+static GPrivate scanner_context = G_PRIVATE_INIT (NULL);
+/* The OriginalXml of the parsable being parsed in this thread, if it retains it; see gdata_parsable_init() */
+static GPrivate parsing_original_xml = G_PRIVATE_INIT (NULL);
+/* This thread's idle parser context for _gdata_parsable_read_xml(), if it has one */
+static GPrivate parser_context = G_PRIVATE_INIT ((GDestroyNotify) xmlFreeParserCtxt);
+/* The table of shared parsables for the document being parsed in this thread, if any; see _gdata_parsable_set_flyweights() */
+static GPrivate flyweights_table = G_PRIVATE_INIT (NULL);
+/* The XmlSink for the XML being written in this thread by _gdata_parsable_write_xml(), if any */
+static GPrivate xml_sink = G_PRIVATE_INIT (NULL);
+G_LOCK_DEFINE_STATIC (namespace_cache);
+G_LOCK_DEFINE_STATIC (readable_properties);
+
+/* The live instances of each type of parsable, if memory accounting is enabled; see gdata_parsable_set_accounting_enabled() */
+typedef struct {
+	guint n_instances;
+	gsize n_bytes;
+} TypeAccount;
+
+static volatile gint accounting_enabled = FALSE;
+static GHashTable *type_accounts = NULL; /* GType → owned TypeAccount; protected by the accounts lock */
+G_LOCK_DEFINE_STATIC (accounts);
+
+/* The cost of the parse_xml calls for each kind of child node of each type of parsable, if profiling is enabled; see
+ * gdata_parsable_set_profiling_enabled() */
+typedef struct {
+	GType type;
+	gchar *element_name; /* qualified with the namespace prefix, if it has one */
+	guint n_calls;
+	guint64 n_microseconds;
+	guint64 n_parsables; /* the number of parsables constructed by the calls */
+} ElementProfile;
+
+static volatile gint profiling_enabled = FALSE;
+static GHashTable *element_profiles = NULL; /* owned ElementProfile → itself; protected by the profiles lock */
+G_LOCK_DEFINE_STATIC (profiles);
+/* The number of parsables constructed in this thread while profiling was enabled */
+static GPrivate n_parsables_constructed = G_PRIVATE_INIT (NULL);
+
+/* The destination of the XML being written by _gdata_parsable_write_xml(). Whenever an element's finished and at least XML_SINK_CHUNK_SIZE bytes
+ * are waiting in @xml_string, they're passed to @func and @xml_string's emptied, so it never grows much beyond that size. */
+typedef struct {
+	GString *xml_string;
+	gsize flushed; /* the number of bytes already passed to @func */
+	GDataParsableXmlSinkFunc func;
+	gpointer user_data;
+} XmlSink;
+
+#define XML_SINK_CHUNK_SIZE (64 * 1024)
+
+static guint notify_signal_id = 0;
+
 G_DEFINE_ABSTRACT_TYPE (GDataParsable, gdata_parsable, G_TYPE_OBJECT)
 
 static void
@@ -81,11 +195,22 @@ gdata_parsable_class_init (GDataParsableClass *klass)
 
 	gobject_class->get_property = gdata_parsable_get_property;
 	gobject_class->set_property = gdata_parsable_set_property;
+	gobject_class->constructed = gdata_parsable_constructed;
 	gobject_class->finalize = gdata_parsable_finalize;
+	gobject_class->dispatch_properties_changed = gdata_parsable_dispatch_properties_changed;
 	klass->parse_xml = real_parse_xml;
 	klass->parse_json = real_parse_json;
 	klass->get_content_type = get_content_type;
 
+	namespace_cache_quark = g_quark_from_static_string ("gdata-parsable-namespace-cache");
+	notify_signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
+	dynamic_namespaces_quark = g_quark_from_static_string ("gdata-parsable-dynamic-namespaces");
+	clone_func_quark = g_quark_from_static_string ("gdata-parsable-clone-func");
+	original_xml_func_quark = g_quark_from_static_string ("gdata-parsable-original-xml-func");
+	json_write_func_quark = g_quark_from_static_string ("gdata-parsable-json-write-func");
+	shareable_quark = g_quark_from_static_string ("gdata-parsable-shareable");
+	readable_properties_quark = g_quark_from_static_string ("gdata-parsable-readable-properties");
+
 	/**
 	 * GDataParsable:constructed-from-xml:
 	 *
@@ -101,17 +226,50 @@ gdata_parsable_class_init (GDataParsableClass *klass)
 	                                                       G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
+static OriginalXml *
+original_xml_ref (OriginalXml *original_xml)
+{
+	g_atomic_int_inc (&(original_xml->ref_count));
+	return original_xml;
+}
+
+static void
+original_xml_unref (OriginalXml *original_xml)
+{
+	if (g_atomic_int_dec_and_test (&(original_xml->ref_count))) {
+		g_free (original_xml->xml);
+		g_slice_free (OriginalXml, original_xml);
+	}
+}
+
 static void
 gdata_parsable_init (GDataParsable *self)
 {
+	OriginalXml *original_xml;
+
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_PARSABLE, GDataParsablePrivate);
 
-	self->priv->extra_xml = g_string_new ("");
-	self->priv->extra_namespaces = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	/* Take the value of GDataParsable:constructed-from-xml from new_constructed_from_xml(), if we're being constructed by it. This is the first
+	 * instance initialiser to be run, so any other parsables constructed by the rest of the construction process (such as by subclasses'
+	 * constructed() functions) won't see the flag. */
+	if (g_private_get (&constructing_from_xml) != NULL) {
+		g_private_set (&constructing_from_xml, NULL);
+		self->priv->constructed_from_xml = TRUE;
+		self->priv->parsing = TRUE;
+	} else {
+		self->priv->constructed_from_xml = FALSE;
+	}
 
-	self->priv->extra_json = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) json_node_free);
+	/* Anything constructed while a parsable which retains its original XML is being parsed is part of it (or is created by it), so modifying
+	 * it has to invalidate that XML */
+	original_xml = g_private_get (&parsing_original_xml);
+	if (original_xml != NULL)
+		self->priv->original_xml = original_xml_ref (original_xml);
 
-	self->priv->constructed_from_xml = FALSE;
+	if (g_atomic_int_get (&profiling_enabled) == TRUE) {
+		guint n_parsables = GPOINTER_TO_UINT (g_private_get (&n_parsables_constructed));
+		g_private_set (&n_parsables_constructed, GUINT_TO_POINTER (n_parsables + 1));
+	}
 }
 
 
@@ -139,6 +297,7 @@ gdata_parsable_set_property (GObject *object, guint property_id, const GValue *v
 	switch (property_id) {
 		case PROP_CONSTRUCTED_FROM_XML:
 			priv->constructed_from_xml = g_value_get_boolean (value);
+			priv->parsing = priv->constructed_from_xml;
 			break;
 		default:
 			/* We don't have any other property... */
@@ -147,15 +306,124 @@ gdata_parsable_set_property (GObject *object, guint property_id, const GValue *v
 	}
 }
 
+static void
+gdata_parsable_dispatch_properties_changed (GObject *object, guint n_pspecs, GParamSpec **pspecs)
+{
+	GDataParsablePrivate *priv = GDATA_PARSABLE (object)->priv;
+
+	/* Changes made while the parsable which owns the original XML is still being parsed come from that XML */
+	if (priv->original_xml != NULL && priv->parsing == FALSE && g_private_get (&parsing_original_xml) != priv->original_xml)
+		g_atomic_int_set (&(priv->original_xml->modified), 1);
+
+	if (priv->parsing == TRUE) {
+		GParamSpec **pending_pspecs;
+		guint i, n_pending_pspecs = 0;
+
+		/* Nothing outside the object can have connected to it while it's being parsed, so only the object's own signal handlers (such as
+		 * those which keep two of its properties in sync) need to be notified. Class handlers for ::notify are skipped, so mustn't rely on
+		 * notifications of changes made during parsing. This saves a signal emission for every property set by the parser. */
+		pending_pspecs = g_newa (GParamSpec*, n_pspecs);
+
+		for (i = 0; i < n_pspecs; i++) {
+			if (g_signal_has_handler_pending (object, notify_signal_id, g_quark_try_string (pspecs[i]->name), FALSE) == TRUE)
+				pending_pspecs[n_pending_pspecs++] = pspecs[i];
+		}
+
+		if (n_pending_pspecs == 0)
+			return;
+
+		pspecs = pending_pspecs;
+		n_pspecs = n_pending_pspecs;
+	}
+
+	G_OBJECT_CLASS (gdata_parsable_parent_class)->dispatch_properties_changed (object, n_pspecs, pspecs);
+
+	/* Changes made while parsing are measured once parsing's finished, in finish_parsing() */
+	if (priv->accounted == TRUE && priv->parsing == FALSE)
+		update_accounts (GDATA_PARSABLE (object), FALSE);
+}
+
+/* Equivalent to g_object_new (parsable_type, "constructed-from-xml", TRUE, NULL), but without looking up the property by name and marshalling its
+ * value through a GValue, and without queueing a notification for it. This is significant, since the parser constructs an object for every link,
+ * category, etc. of every entry. */
+static GDataParsable *
+new_constructed_from_xml (GType parsable_type)
+{
+	GDataParsable *parsable;
+
+	g_private_set (&constructing_from_xml, GINT_TO_POINTER (TRUE));
+	parsable = g_object_new (parsable_type, NULL);
+	g_assert (g_private_get (&constructing_from_xml) == NULL);
+
+	return parsable;
+}
+
+/* Creates a parsable to be filled in by one of the parsing functions. Property notifications are frozen until finish_parsing() is called, so that
+ * each property which the parser sets multiple times is only notified once, and all the notifications are dispatched together. */
+static GDataParsable *
+new_parsable (GType parsable_type)
+{
+	GDataParsable *parsable;
+
+	parsable = new_constructed_from_xml (parsable_type);
+	g_object_freeze_notify (G_OBJECT (parsable));
+
+	return parsable;
+}
+
+/* Marks the end of parsing a parsable created by new_parsable(), once its post-parse function has returned successfully. */
+static void
+finish_parsing (GDataParsable *parsable)
+{
+	/* This has to be done while ->parsing is still set, so that the notifications are filtered */
+	g_object_thaw_notify (G_OBJECT (parsable));
+	parsable->priv->parsing = FALSE;
+
+	if (parsable->priv->accounted == TRUE)
+		update_accounts (parsable, FALSE);
+}
+
+static void
+gdata_parsable_constructed (GObject *object)
+{
+	/* Chain up to the parent class */
+	if (G_OBJECT_CLASS (gdata_parsable_parent_class)->constructed != NULL)
+		G_OBJECT_CLASS (gdata_parsable_parent_class)->constructed (object);
+
+	/* This can't be done in gdata_parsable_init(), since the object's final type isn't known until then */
+	if (g_atomic_int_get (&accounting_enabled) == TRUE) {
+		GDATA_PARSABLE (object)->priv->accounted = TRUE;
+		update_accounts (GDATA_PARSABLE (object), TRUE);
+	}
+}
+
 static void
 gdata_parsable_finalize (GObject *object)
 {
 	GDataParsablePrivate *priv = GDATA_PARSABLE (object)->priv;
 
-	g_string_free (priv->extra_xml, TRUE);
-	g_hash_table_destroy (priv->extra_namespaces);
+	if (priv->accounted == TRUE) {
+		TypeAccount *account;
+
+		G_LOCK (accounts);
+		account = g_hash_table_lookup (type_accounts, GSIZE_TO_POINTER (G_OBJECT_TYPE (object)));
+		account->n_instances--;
+		account->n_bytes -= priv->accounted_bytes;
+		G_UNLOCK (accounts);
+	}
+
+	if (priv->extra_xml != NULL)
+		g_string_free (priv->extra_xml, TRUE);
+	if (priv->extra_namespaces != NULL)
+		g_hash_table_destroy (priv->extra_namespaces);
+	if (priv->extra_doc != NULL)
+		xmlFreeDoc (priv->extra_doc);
 
-	g_hash_table_destroy (priv->extra_json);
+	if (priv->extra_json != NULL)
+		g_hash_table_destroy (priv->extra_json);
+
+	if (priv->original_xml != NULL)
+		original_xml_unref (priv->original_xml);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_parsable_parent_class)->finalize (object);
@@ -164,13 +432,29 @@ gdata_parsable_finalize (GObject *object)
 static gboolean
 real_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
 {
+	GDataParsablePrivate *priv = parsable->priv;
 	xmlBuffer *buffer;
 	xmlNs **namespaces, **namespace;
 
-	/* Unhandled XML */
+	/* Unhandled XML. The document's _private field is set to the GDataUnhandledXmlMode to use by _gdata_parsable_new_from_xml_reader(). */
+	switch ((GDataUnhandledXmlMode) (GPOINTER_TO_UINT (doc->_private) & ~GDATA_PARSE_LAZY_SUBTREES)) {
+		case GDATA_UNHANDLED_XML_DISCARD:
+			return TRUE;
+		case GDATA_UNHANDLED_XML_LAZY:
+			/* Copy the node into our own document, to be serialised in _gdata_parsable_get_xml() if it's ever needed */
+			_gdata_parsable_defer_xml (&(priv->extra_doc), doc, node);
+			return TRUE;
+		case GDATA_UNHANDLED_XML_KEEP:
+		default:
+			break;
+	}
+
+	if (priv->extra_xml == NULL)
+		priv->extra_xml = g_string_new ("");
+
 	buffer = xmlBufferCreate ();
 	xmlNodeDump (buffer, doc, node, 0, 0);
-	g_string_append (parsable->priv->extra_xml, (gchar*) xmlBufferContent (buffer));
+	g_string_append (priv->extra_xml, (gchar*) xmlBufferContent (buffer));
 	g_debug ("Unhandled XML in %s: %s", G_OBJECT_TYPE_NAME (parsable), (gchar*) xmlBufferContent (buffer));
 	xmlBufferFree (buffer);
 
@@ -179,11 +463,14 @@ real_parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer us
 	if (namespaces == NULL)
 		return TRUE;
 
+	if (priv->extra_namespaces == NULL)
+		priv->extra_namespaces = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
 	for (namespace = namespaces; *namespace != NULL; namespace++) {
-		if ((*namespace)->prefix != NULL) {
-			/* NOTE: These two g_strdup()s leak, but it's probably acceptable, given that it saves us
-			 * g_strdup()ing every other namespace we put in @extra_namespaces. */
-			g_hash_table_insert (parsable->priv->extra_namespaces,
+		/* Most unhandled elements share the same few namespaces, so only copy the ones we haven't seen before */
+		if ((*namespace)->prefix != NULL &&
+		    g_hash_table_lookup (priv->extra_namespaces, (*namespace)->prefix) == NULL) {
+			g_hash_table_insert (priv->extra_namespaces,
 			                     g_strdup ((gchar*) ((*namespace)->prefix)),
 			                     g_strdup ((gchar*) ((*namespace)->href)));
 		}
@@ -245,33 +532,64 @@ _json_reader_dup_current_node (JsonReader *reader)
 	return value;
 }
 
+/* Returns a new node which refers to the same object or array as @node, rather than deep-copying it as json_node_copy() would. JsonObject and
+ * JsonArray are reference counted, so this keeps the subtree alive after the rest of the document it came from has been freed. */
+static JsonNode * /* transfer full */
+_json_node_share (JsonNode *node)
+{
+	JsonNode *value;
+
+	switch (json_node_get_node_type (node)) {
+		case JSON_NODE_OBJECT:
+			value = json_node_new (JSON_NODE_OBJECT);
+			json_node_set_object (value, json_node_get_object (node));
+			return value;
+		case JSON_NODE_ARRAY:
+			value = json_node_new (JSON_NODE_ARRAY);
+			json_node_set_array (value, json_node_get_array (node));
+			return value;
+		case JSON_NODE_VALUE:
+		case JSON_NODE_NULL:
+		default:
+			return json_node_copy (node);
+	}
+}
+
 static gboolean
 real_parse_json (GDataParsable *parsable, JsonReader *reader, gpointer user_data, GError **error)
 {
-	gchar *json, *member_name;
-	JsonGenerator *generator;
-	JsonNode *value;
+	gchar *member_name;
+	JsonNode *value, *node;
 
 	/* Unhandled JSON member. Save it and its value to ->extra_xml so that it's not lost if we
 	 * re-upload this Parsable to the server. */
 	member_name = g_strdup (json_reader_get_member_name (reader));
 	g_assert (member_name != NULL);
 
-	/* Extract a copy of the current node. */
-	value = _json_reader_dup_current_node (reader);
+	/* Keep a reference to the member's value if we have access to its node; otherwise extract a copy of it through the reader. */
+	node = _gdata_parsable_get_json_member (parsable, member_name);
+	value = (node != NULL) ? _json_node_share (node) : _json_reader_dup_current_node (reader);
 	g_assert (value != NULL);
 
 	/* Serialise the value for debugging. */
-	generator = json_generator_new ();
-	json_generator_set_root (generator, value);
+	if (_gdata_service_get_log_level () > GDATA_LOG_NONE) {
+		JsonGenerator *generator;
+		gchar *json;
 
-	json = json_generator_to_data (generator, NULL);
-	g_debug ("Unhandled JSON member ‘%s’ in %s: %s", member_name, G_OBJECT_TYPE_NAME (parsable), json);
-	g_free (json);
+		generator = json_generator_new ();
+		json_generator_set_root (generator, value);
 
-	g_object_unref (generator);
+		json = json_generator_to_data (generator, NULL);
+		g_debug ("Unhandled JSON member ‘%s’ in %s: %s", member_name, G_OBJECT_TYPE_NAME (parsable), json);
+		g_free (json);
+
+		g_object_unref (generator);
+	}
 
 	/* Save the value. Transfer ownership of the member_name and value. */
+	if (parsable->priv->extra_json == NULL)
+		parsable->priv->extra_json = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) json_node_free);
+
 	g_hash_table_replace (parsable->priv->extra_json, (gpointer) member_name, (gpointer) value);
 
 	return TRUE;
@@ -315,33 +633,167 @@ gdata_parsable_new_from_xml (GType parsable_type, const gchar *xml, gint length,
 	return _gdata_parsable_new_from_xml (parsable_type, xml, length, NULL, error);
 }
 
+/* Set up libxml. We do this here to avoid introducing a libgdata setup function, which would be unnecessary hassle. This must be called before
+ * any libxml allocations are made, so anything in the library which parses XML without going through this file (such as GDataLiteFeed) must
+ * call it first. */
+void
+_gdata_parsable_init_libxml (void)
+{
+	static volatile gsize libxml_initialised = 0;
+
+	/* This is called on every parse, possibly from several threads at once, so the fast path is a single atomic read */
+	if (g_once_init_enter (&libxml_initialised)) {
+		/* Change the libxml memory allocation functions to be GLib's. This means we don't have to re-allocate all the strings we get from
+		 * libxml, which cuts down on strdup() calls dramatically. */
+		xmlMemSetup ((xmlFreeFunc) g_free, (xmlMallocFunc) g_malloc, (xmlReallocFunc) g_realloc, (xmlStrdupFunc) g_strdup);
+		g_once_init_leave (&libxml_initialised, 1);
+	}
+}
+
+/* Once a thread's parser context has interned this many names, it's thrown away after the current parse, so that its dictionary can't grow without
+ * bound in a long-running thread */
+#define MAX_PARSER_DICT_SIZE 10000
+
+/* Parses @xml into a document, as xmlReadMemory() would, but reusing a per-thread parser context rather than creating a new one each time. Setting
+ * up a context and its dictionary dominates the cost of parsing small documents, such as single entries and batch responses, and keeping the
+ * dictionary means the element and attribute names interned by one parse are already there for the next.
+ *
+ * @options is passed to libxml as well as GDATA_XML_PARSE_OPTIONS. On failure, %NULL is returned and the error can be retrieved with
+ * xmlGetLastError(), as with xmlReadMemory(). */
+xmlDoc *
+_gdata_parsable_read_xml (const gchar *xml, gint length, gint options)
+{
+	xmlParserCtxt *ctxt;
+	xmlDoc *doc;
+
+	_gdata_parsable_init_libxml ();
+
+	/* Take the context out of the GPrivate while it's in use, so that any parse started while this one's underway gets its own */
+	ctxt = g_private_get (&parser_context);
+	if (ctxt != NULL) {
+		g_private_set (&parser_context, NULL);
+	} else {
+		ctxt = xmlNewParserCtxt ();
+		if (ctxt == NULL)
+			return xmlReadMemory (xml, length, "/dev/null", NULL, GDATA_XML_PARSE_OPTIONS | options);
+	}
+
+	/* This resets the context before parsing */
+	doc = xmlCtxtReadMemory (ctxt, xml, length, "/dev/null", NULL, GDATA_XML_PARSE_OPTIONS | options);
+
+	/* The document holds its own reference to the dictionary, so the context can be freed or reused independently of it */
+	if (ctxt->dict != NULL && xmlDictSize (ctxt->dict) > MAX_PARSER_DICT_SIZE)
+		xmlFreeParserCtxt (ctxt);
+	else
+		g_private_replace (&parser_context, ctxt);
+
+	return doc;
+}
+
+/* Makes @context the current scanner context for this thread, scanning @xml (or, if it's %NULL, whatever's appended to the scanner) */
+static void
+push_scanner_context (ScannerContext *context, const gchar *xml, gsize length)
+{
+	gdata_xml_scanner_init (&(context->scanner), xml, length);
+	context->root_node = NULL;
+	context->child_node = NULL;
+	context->child_index = 0;
+	context->n_children = 0;
+
+	/* Another document could be parsed while this one is, for example by a progress callback */
+	context->previous_context = g_private_get (&scanner_context);
+	g_private_set (&scanner_context, context);
+}
+
+static void
+pop_scanner_context (ScannerContext *context)
+{
+	g_assert (g_private_get (&scanner_context) == context);
+	g_private_set (&scanner_context, context->previous_context);
+	gdata_xml_scanner_clear (&(context->scanner));
+}
+
+typedef struct {
+	xmlInputReadCallback read_callback;
+	gpointer read_user_data;
+	ScannerContext context;
+} ScannerInput;
+
+static int
+scanner_input_read_cb (ScannerInput *input, char *buffer, int len)
+{
+	int length = input->read_callback (input->read_user_data, buffer, len);
+
+	if (length > 0)
+		gdata_xml_scanner_append (&(input->context.scanner), buffer, length);
+
+	return length;
+}
+
+/* If @node is the root of the document being parsed, or one of the root's children, and @parsable_type retains its original XML, returns a new
+ * #OriginalXml holding the text of @node. Otherwise returns %NULL. */
+static OriginalXml *
+find_original_xml (GType parsable_type, xmlNode *node)
+{
+	ScannerContext *context;
+	OriginalXml *original_xml;
+	gchar *xml;
+	const gchar *name, *name_end;
+	gsize length, content_offset;
+
+	context = g_private_get (&scanner_context);
+	if (context == NULL || (node != context->root_node && node != context->child_node) ||
+	    _gdata_parsable_type_retains_original_xml (parsable_type) == FALSE) {
+		return NULL;
+	}
+
+	if (node == context->root_node)
+		xml = gdata_xml_scanner_dup_root (&(context->scanner), &length, &content_offset);
+	else
+		xml = gdata_xml_scanner_dup_child (&(context->scanner), context->child_index, &length, &content_offset);
+
+	if (xml == NULL)
+		return NULL;
+
+	/* Check that the scanner agrees with libxml about which element this is */
+	name_end = xml + strcspn (xml, " \t\r\n/>");
+	for (name = name_end; name > xml + 1 && name[-1] != ':'; name--);
+
+	if (strlen ((const gchar*) node->name) != (gsize) (name_end - name) || strncmp (name, (const gchar*) node->name, name_end - name) != 0) {
+		g_free (xml);
+		return NULL;
+	}
+
+	original_xml = g_slice_new (OriginalXml);
+	original_xml->ref_count = 1;
+	original_xml->modified = 0;
+	original_xml->xml = xml;
+	original_xml->length = length;
+	original_xml->content_offset = content_offset;
+
+	return original_xml;
+}
+
 GDataParsable *
 _gdata_parsable_new_from_xml (GType parsable_type, const gchar *xml, gint length, gpointer user_data, GError **error)
 {
 	xmlDoc *doc;
 	xmlNode *node;
 	GDataParsable *parsable;
-	static gboolean libxml_initialised = FALSE;
+	ScannerContext context;
 
 	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
 	g_return_val_if_fail (xml != NULL && *xml != '\0', NULL);
 	g_return_val_if_fail (length >= -1, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	/* Set up libxml. We do this here to avoid introducing a libgdata setup function, which would be unnecessary hassle. This is the only place
-	 * that libxml can be initialised in the library. */
-	if (libxml_initialised == FALSE) {
-		/* Change the libxml memory allocation functions to be GLib's. This means we don't have to re-allocate all the strings we get from
-		 * libxml, which cuts down on strdup() calls dramatically. */
-		xmlMemSetup ((xmlFreeFunc) g_free, (xmlMallocFunc) g_malloc, (xmlReallocFunc) g_realloc, (xmlStrdupFunc) g_strdup);
-		libxml_initialised = TRUE;
-	}
+	_gdata_parsable_init_libxml ();
 
 	if (length == -1)
 		length = strlen (xml);
 
 	/* Parse the XML */
-	doc = xmlReadMemory (xml, length, "/dev/null", NULL, 0);
+	doc = _gdata_parsable_read_xml (xml, length, 0);
 	if (doc == NULL) {
 		xmlError *xml_error = xmlGetLastError ();
 		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
@@ -363,24 +815,101 @@ _gdata_parsable_new_from_xml (GType parsable_type, const gchar *xml, gint length
 		return NULL;
 	}
 
+	push_scanner_context (&context, xml, length);
+	context.root_node = node;
+
 	parsable = _gdata_parsable_new_from_xml_node (parsable_type, doc, node, user_data, error);
 	xmlFreeDoc (doc);
 
+	pop_scanner_context (&context);
+
 	return parsable;
 }
 
-GDataParsable *
-_gdata_parsable_new_from_xml_node (GType parsable_type, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+static guint
+element_profile_hash (const ElementProfile *profile)
+{
+	return g_direct_hash (GSIZE_TO_POINTER (profile->type)) ^ g_str_hash (profile->element_name);
+}
+
+static gboolean
+element_profile_equal (const ElementProfile *a, const ElementProfile *b)
+{
+	return (a->type == b->type && strcmp (a->element_name, b->element_name) == 0) ? TRUE : FALSE;
+}
+
+static void
+element_profile_free (ElementProfile *profile)
+{
+	g_free (profile->element_name);
+	g_slice_free (ElementProfile, profile);
+}
+
+/* Calls @klass's parse_xml function on @node. If profiling is enabled, the time the call takes and the number of parsables it constructs are added
+ * to the profile for @node in @parsable's type. */
+static gboolean
+call_parse_xml (GDataParsableClass *klass, GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	ElementProfile key, *profile;
+	gchar element_name[256];
+	gint64 start_time, n_microseconds;
+	guint start_parsables, n_parsables;
+	gboolean success;
+
+	if (g_atomic_int_get (&profiling_enabled) == FALSE)
+		return klass->parse_xml (parsable, doc, node, user_data, error);
+
+	start_parsables = GPOINTER_TO_UINT (g_private_get (&n_parsables_constructed));
+	start_time = g_get_monotonic_time ();
+
+	success = klass->parse_xml (parsable, doc, node, user_data, error);
+
+	n_microseconds = g_get_monotonic_time () - start_time;
+	n_parsables = GPOINTER_TO_UINT (g_private_get (&n_parsables_constructed)) - start_parsables;
+
+	/* Elements are named as they appear in the XML; other nodes (such as whitespace and comments) by their type */
+	if (node->type != XML_ELEMENT_NODE)
+		g_snprintf (element_name, sizeof (element_name), "#%s", (const gchar*) node->name);
+	else if (node->ns != NULL && node->ns->prefix != NULL)
+		g_snprintf (element_name, sizeof (element_name), "%s:%s", (const gchar*) node->ns->prefix, (const gchar*) node->name);
+	else
+		g_strlcpy (element_name, (const gchar*) node->name, sizeof (element_name));
+
+	key.type = G_OBJECT_TYPE (parsable);
+	key.element_name = element_name;
+
+	G_LOCK (profiles);
+
+	if (element_profiles == NULL) {
+		element_profiles = g_hash_table_new_full ((GHashFunc) element_profile_hash, (GEqualFunc) element_profile_equal,
+		                                          (GDestroyNotify) element_profile_free, NULL);
+	}
+
+	profile = g_hash_table_lookup (element_profiles, &key);
+	if (profile == NULL) {
+		profile = g_slice_new0 (ElementProfile);
+		profile->type = key.type;
+		profile->element_name = g_strdup (element_name);
+		g_hash_table_add (element_profiles, profile);
+	}
+
+	profile->n_calls++;
+	profile->n_microseconds += n_microseconds;
+	profile->n_parsables += n_parsables;
+
+	G_UNLOCK (profiles);
+
+	return success;
+}
+
+static GDataParsable *
+parse_xml_node (GType parsable_type, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
 {
 	GDataParsable *parsable;
 	GDataParsableClass *klass;
+	ScannerContext *context;
 
-	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
-	g_return_val_if_fail (doc != NULL, NULL);
-	g_return_val_if_fail (node != NULL, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
-
-	parsable = g_object_new (parsable_type, "constructed-from-xml", TRUE, NULL);
+	parsable = new_parsable (parsable_type);
 
 	klass = GDATA_PARSABLE_GET_CLASS (parsable);
 	if (klass->parse_xml == NULL) {
@@ -404,16 +933,29 @@ _gdata_parsable_new_from_xml_node (GType parsable_type, xmlDoc *doc, xmlNode *no
 		return NULL;
 	}
 
+	/* Keep track of which of the document root's children is being parsed, so that their original XML can be found */
+	context = g_private_get (&scanner_context);
+	if (context != NULL && context->root_node != node)
+		context = NULL;
+
 	/* Parse each child element */
 	node = node->children;
 	while (node != NULL) {
-		if (klass->parse_xml (parsable, doc, node, user_data, error) == FALSE) {
+		if (context != NULL && node->type == XML_ELEMENT_NODE) {
+			context->child_node = node;
+			context->child_index = context->n_children++;
+		}
+
+		if (call_parse_xml (klass, parsable, doc, node, user_data, error) == FALSE) {
 			g_object_unref (parsable);
 			return NULL;
 		}
 		node = node->next;
 	}
 
+	if (context != NULL)
+		context->child_node = NULL;
+
 	/* Call the post-parse function */
 	if (klass->post_parse_xml != NULL &&
 	    klass->post_parse_xml (parsable, user_data, error) == FALSE) {
@@ -421,334 +963,2924 @@ _gdata_parsable_new_from_xml_node (GType parsable_type, xmlDoc *doc, xmlNode *no
 		return NULL;
 	}
 
+	finish_parsing (parsable);
+
 	return parsable;
 }
 
-/**
- * gdata_parsable_new_from_json:
- * @parsable_type: the type of the class represented by the JSON
- * @json: the JSON for just the parsable object
- * @length: the length of @json, or -1
- * @error: a #GError, or %NULL
+/*
+ * _gdata_parsable_is_deferring_xml:
+ * @doc: the XML document being parsed
  *
- * Creates a new #GDataParsable subclass (of the given @parsable_type) from the given @json.
+ * Returns whether heavy child subtrees of the parsables being built from @doc (such as long lists of child elements which are expensive to turn into
+ * objects) should be copied with _gdata_parsable_defer_xml() and parsed when they're first needed, rather than being parsed straight away. This is
+ * the case when %GDATA_PARSE_LAZY_SUBTREES was set in the mode the document was read with.
  *
- * An object of the given @parsable_type is created, and its <function>parse_json</function> and
- * <function>post_parse_json</function> class functions called on the JSON node obtained from @json.
- * <function>post_parse_json</function> is called once on the root node, while <function>parse_json</function> is called for
- * each of the node's members.
+ * Return value: %TRUE if subtrees should be deferred, %FALSE otherwise
  *
- * If @length is -1, @json will be assumed to be nul-terminated.
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_parsable_is_deferring_xml (xmlDoc *doc)
+{
+	return ((GPOINTER_TO_UINT (doc->_private) & GDATA_PARSE_LAZY_SUBTREES) != 0) ? TRUE : FALSE;
+}
+
+/*
+ * _gdata_parsable_defer_xml:
+ * @deferred_doc: (inout) (allow-none): return location for the document holding the deferred nodes, which is created if it's %NULL
+ * @doc: the XML document being parsed
+ * @node: the node to defer
  *
- * If an error occurs during parsing, a suitable error from #GDataParserError will be returned.
+ * Copies @node (and its subtree) into *@deferred_doc, after any nodes already deferred there, so that it can be parsed later by
+ * _gdata_parsable_parse_deferred_xml() once @doc has been freed. Copying the node declares any namespaces it uses on the copy itself, so the copy is
+ * self-contained.
  *
- * Return value: a new #GDataParsable, or %NULL; unref with g_object_unref()
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_defer_xml (xmlDoc **deferred_doc, xmlDoc *doc, xmlNode *node)
+{
+	if (*deferred_doc == NULL) {
+		*deferred_doc = xmlNewDoc ((xmlChar*) "1.0");
+		xmlDocSetRootElement (*deferred_doc, xmlNewDocNode (*deferred_doc, NULL, (xmlChar*) "extra", NULL));
+
+		/* Parse the nodes with the same unhandled XML mode as the rest of the document, but without deferring them again */
+		(*deferred_doc)->_private = GUINT_TO_POINTER (GPOINTER_TO_UINT (doc->_private) & ~GDATA_PARSE_LAZY_SUBTREES);
+	}
+
+	xmlAddChild (xmlDocGetRootElement (*deferred_doc), xmlDocCopyNode (node, *deferred_doc, 1));
+}
+
+/*
+ * _gdata_parsable_parse_deferred_xml:
+ * @self: the #GDataParsable the nodes were deferred from
+ * @deferred_doc: (inout): the document holding the deferred nodes, or %NULL
+ *
+ * Parses the nodes deferred into *@deferred_doc by _gdata_parsable_defer_xml(), by passing each one to @self's parse_xml class function as if it
+ * were being parsed for the first time, then frees the document and sets *@deferred_doc to %NULL. It does nothing if *@deferred_doc is already
+ * %NULL, so can be called at the start of every accessor which depends on the deferred nodes.
+ *
+ * *@deferred_doc is cleared before the nodes are parsed, so the parse_xml function may call accessors which call this function again. Errors in the
+ * deferred nodes can't be reported to whoever called the accessor, so they're only logged.
  *
  * Since: 0.15.0
  */
-GDataParsable *
-gdata_parsable_new_from_json (GType parsable_type, const gchar *json, gint length, GError **error)
+void
+_gdata_parsable_parse_deferred_xml (GDataParsable *self, xmlDoc **deferred_doc)
 {
-	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
-	g_return_val_if_fail (json != NULL && *json != '\0', NULL);
-	g_return_val_if_fail (length >= -1, NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	GDataParsableClass *klass;
+	xmlDoc *doc;
+	xmlNode *node;
+	gboolean was_parsing;
+	GError *error = NULL;
 
-	return _gdata_parsable_new_from_json (parsable_type, json, length, NULL, error);
+	doc = *deferred_doc;
+	if (doc == NULL)
+		return;
+
+	*deferred_doc = NULL;
+	klass = GDATA_PARSABLE_GET_CLASS (self);
+
+	/* The parsed nodes come from the original XML, so mustn't mark it as modified */
+	was_parsing = self->priv->parsing;
+	self->priv->parsing = TRUE;
+
+	for (node = xmlDocGetRootElement (doc)->children; node != NULL; node = node->next) {
+		if (call_parse_xml (klass, self, doc, node, NULL, &error) == FALSE) {
+			g_warning ("Error parsing deferred XML in %s: %s", G_OBJECT_TYPE_NAME (self), error->message);
+			g_clear_error (&error);
+		}
+	}
+
+	self->priv->parsing = was_parsing;
+	xmlFreeDoc (doc);
+
+	if (self->priv->accounted == TRUE && was_parsing == FALSE)
+		update_accounts (self, FALSE);
 }
 
 GDataParsable *
-_gdata_parsable_new_from_json (GType parsable_type, const gchar *json, gint length, gpointer user_data, GError **error)
+_gdata_parsable_new_from_xml_node (GType parsable_type, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
 {
-	JsonParser *parser;
-	JsonReader *reader;
 	GDataParsable *parsable;
-	GError *child_error = NULL;
+	OriginalXml *original_xml;
+	gpointer previous_original_xml = NULL;
 
 	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
-	g_return_val_if_fail (json != NULL && *json != '\0', NULL);
-	g_return_val_if_fail (length >= -1, NULL);
+	g_return_val_if_fail (doc != NULL, NULL);
+	g_return_val_if_fail (node != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	if (length == -1)
-		length = strlen (json);
+	original_xml = find_original_xml (parsable_type, node);
+	if (original_xml != NULL) {
+		previous_original_xml = g_private_get (&parsing_original_xml);
+		g_private_set (&parsing_original_xml, original_xml);
+	}
 
-	parser = json_parser_new ();
-	if (!json_parser_load_from_data (parser, json, length, &child_error)) {
-		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
-		             /* Translators: the parameter is an error message */
-		             _("Error parsing JSON: %s"), child_error->message);
-		g_error_free (child_error);
-		g_object_unref (parser);
+	parsable = parse_xml_node (parsable_type, doc, node, user_data, error);
 
-		return NULL;
-	}
+	if (original_xml != NULL) {
+		g_private_set (&parsing_original_xml, previous_original_xml);
 
-	reader = json_reader_new (json_parser_get_root (parser));
-	parsable = _gdata_parsable_new_from_json_node (parsable_type, reader, user_data, error);
+		if (parsable != NULL) {
+			g_assert (parsable->priv->original_xml == original_xml);
+			parsable->priv->owns_original_xml = TRUE;
+		}
 
-	g_object_unref (reader);
-	g_object_unref (parser);
+		original_xml_unref (original_xml);
+	}
 
 	return parsable;
 }
 
-GDataParsable *
-_gdata_parsable_new_from_json_node (GType parsable_type, JsonReader *reader, gpointer user_data, GError **error)
+static void
+set_xml_parsing_error (GError **error)
 {
+	xmlError *xml_error = xmlGetLastError ();
+	g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+	             /* Translators: the parameter is an error message */
+	             _("Error parsing XML: %s"),
+	             (xml_error != NULL) ? xml_error->message : NULL);
+}
+
+/* The state of a parse by _gdata_parsable_new_from_xml_reader(), which can be advanced a few children of the root node at a time */
+struct _GDataParsableReader {
+	xmlTextReader *reader; /* not owned */
 	GDataParsable *parsable;
 	GDataParsableClass *klass;
-	gint i;
+	xmlDoc *doc;
+	gpointer user_data;
+	gint root_depth;
+	gint ret; /* result of the last xmlTextReaderRead() or xmlTextReaderNext() call; 0 once the root node's children are exhausted */
+	ScannerContext *context;
+};
+
+/*
+ * _gdata_parsable_reader_new:
+ * @parsable_type: the type of the class represented by the XML
+ * @reader: an #xmlTextReader positioned at the start of the document
+ * @unhandled_xml_mode: how to handle XML which isn't understood by the parsable (or any of its children), with %GDATA_PARSE_LAZY_SUBTREES optionally set
+ * @user_data: data to pass to the class functions
+ * @error: a #GError, or %NULL
+ *
+ * Starts parsing a new #GDataParsable subclass (of the given @parsable_type) from the XML read by @reader, as for
+ * _gdata_parsable_new_from_xml_reader(). The root node is read and passed to <function>pre_parse_xml</function>, but none of its children are read;
+ * call _gdata_parsable_reader_step() to parse them, and then _gdata_parsable_reader_finish() to get the parsable.
+ *
+ * @reader must stay alive until the returned state is finished or freed.
+ *
+ * Return value: (transfer full): the parse's state, or %NULL on error; free with _gdata_parsable_reader_finish() or _gdata_parsable_reader_free()
+ *
+ * Since: 0.15.0
+ */
+GDataParsableReader *
+_gdata_parsable_reader_new (GType parsable_type, xmlTextReader *reader, GDataUnhandledXmlMode unhandled_xml_mode, gpointer user_data, GError **error)
+{
+	GDataParsableReader *self;
+	GDataParsable *parsable;
+	GDataParsableClass *klass;
+	xmlDoc *doc;
+	xmlNode *node;
+	gint ret, root_depth;
+	ScannerContext *context;
 
 	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
 	g_return_val_if_fail (reader != NULL, NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	/* Indicator property which allows distinguishing between locally created and server based objects
-	 * as it is used for non-XML tasks, and adding another one for JSON would be a bit pointless. */
-	parsable = g_object_new (parsable_type, "constructed-from-xml", TRUE, NULL);
-
-	klass = GDATA_PARSABLE_GET_CLASS (parsable);
-	g_assert (klass->parse_json != NULL);
+	/* Skip over anything preceding the root element, such as the XML declaration or comments */
+	do {
+		ret = xmlTextReaderRead (reader);
+	} while (ret == 1 && xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT);
 
-	/* Check that the outermost node is an object. */
-	if (json_reader_is_object (reader) == FALSE) {
-		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
-		             /* Translators: the parameter is an error message */
-		             _("Error parsing JSON: %s"),
-		             _("Outermost JSON node is not an object."));
-		g_object_unref (parsable);
+	if (ret == -1) {
+		set_xml_parsing_error (error);
+		return NULL;
+	} else if (ret == 0) {
+		/* XML document's empty */
+		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_EMPTY_DOCUMENT,
+		             _("Error parsing XML: %s"),
+		             /* Translators: this is a dummy error message to be substituted into "Error parsing XML: %s". */
+		             _("Empty document."));
 		return NULL;
 	}
 
-	/* Parse each child member. This assumes the outermost node is an object. */
-	for (i = 0; i < json_reader_count_members (reader); i++) {
-		g_return_val_if_fail (json_reader_read_element (reader, i), NULL);
+	/* The root node only has its attributes and namespace declarations at this point; none of its children have been read yet. We use the
+	 * node's document rather than xmlTextReaderCurrentDoc(), since the latter forces the reader to preserve the entire document. */
+	node = xmlTextReaderCurrentNode (reader);
+	doc = node->doc;
+	root_depth = xmlTextReaderDepth (reader);
 
-		if (klass->parse_json (parsable, reader, user_data, error) == FALSE) {
-			g_object_unref (parsable);
-			return NULL;
-		}
+	/* Keep track of which of the root's children is being parsed, so that their original XML can be found */
+	context = g_private_get (&scanner_context);
+	if (context != NULL && context->root_node == NULL)
+		context->root_node = node;
+	else
+		context = NULL;
 
-		json_reader_end_element (reader);
-	}
+	/* Every parse_xml implementation gets passed the document, so use it to tell real_parse_xml() what to do with unhandled XML */
+	doc->_private = GUINT_TO_POINTER (unhandled_xml_mode);
 
-	/* Call the post-parse function */
-	if (klass->post_parse_json != NULL &&
-	    klass->post_parse_json (parsable, user_data, error) == FALSE) {
+	parsable = new_parsable (parsable_type);
+
+	klass = GDATA_PARSABLE_GET_CLASS (parsable);
+	if (klass->parse_xml == NULL) {
 		g_object_unref (parsable);
 		return NULL;
 	}
 
-	return parsable;
-}
-
-static void
-build_namespaces_cb (gchar *prefix, gchar *href, GString *output)
-{
-	g_string_append_printf (output, " xmlns:%s='%s'", prefix, href);
-}
+	g_assert (klass->element_name != NULL);
 
-static gboolean
-filter_namespaces_cb (gchar *prefix, gchar *href, GHashTable *canonical_namespaces)
-{
-	if (g_hash_table_lookup (canonical_namespaces, prefix) != NULL)
-		return TRUE;
-	return FALSE;
-}
+	/* Call the pre-parse function first */
+	if (klass->pre_parse_xml != NULL &&
+	    klass->pre_parse_xml (parsable, doc, node, user_data, error) == FALSE) {
+		g_object_unref (parsable);
+		return NULL;
+	}
 
-/**
- * gdata_parsable_get_xml:
- * @self: a #GDataParsable
- *
- * Builds an XML representation of the #GDataParsable in its current state, such that it could be inserted on the server. The XML is guaranteed
- * to have all its namespaces declared properly in a self-contained fashion, and is valid for stand-alone use.
- *
- * Return value: the object's XML; free with g_free()
- *
- * Since: 0.4.0
- **/
-gchar *
-gdata_parsable_get_xml (GDataParsable *self)
-{
-	GString *xml_string;
+	self = g_slice_new (GDataParsableReader);
+	self->reader = reader;
+	self->parsable = parsable;
+	self->klass = klass;
+	self->doc = doc;
+	self->user_data = user_data;
+	self->root_depth = root_depth;
+	self->context = context;
 
-	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+	/* Move on to the root node's first child, if it has any */
+	self->ret = (xmlTextReaderIsEmptyElement (reader) == 0) ? xmlTextReaderRead (reader) : 0;
 
-	xml_string = g_string_sized_new (1000);
-	g_string_append (xml_string, "<?xml version='1.0' encoding='UTF-8'?>");
-	_gdata_parsable_get_xml (self, xml_string, TRUE);
-	return g_string_free (xml_string, FALSE);
+	return self;
 }
 
 /*
- * _gdata_parsable_get_xml:
- * @self: a #GDataParsable
- * @xml_string: a #GString to build the XML in
- * @declare_namespaces: %TRUE if all the namespaces used in the outputted XML should be declared in the opening tag of the root element,
- * %FALSE otherwise
+ * _gdata_parsable_reader_step:
+ * @self: the state of a parse started by _gdata_parsable_reader_new()
+ * @max_children: the maximum number of the root node's children to parse, or <code class="literal">0</code> for no limit
+ * @end_time: the monotonic time (as returned by g_get_monotonic_time()) after which to stop parsing children, or <code class="literal">-1</code>
+ * for no limit
+ * @finished: (out caller-allocates): return location for whether all of the root node's children have now been parsed
+ * @error: a #GError, or %NULL
  *
- * Builds an XML representation of the #GDataParsable in its current state, such that it could be inserted on the server. If @declare_namespaces is
- * %TRUE, the XML is guaranteed to have all its namespaces declared properly in a self-contained fashion, and is valid for stand-alone use. If
- * @declare_namespaces is %FALSE, none of the used namespaces are declared, and the XML is suitable for insertion into a larger XML tree.
+ * Parses the root node's children, one at a time, until they've all been parsed, @max_children of them have been parsed, or @end_time has passed.
+ * At least one child is always parsed (if any are left), so repeated calls always make progress. Each child is expanded, passed to
+ * <function>parse_xml</function>, and then freed before the next child is read, as for _gdata_parsable_new_from_xml_reader().
  *
- * Return value: the object's XML; free with g_free()
+ * If an error occurs, %FALSE is returned and the parse can't be continued; @self should be freed with _gdata_parsable_reader_free().
  *
- * Since: 0.4.0
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
  */
-void
-_gdata_parsable_get_xml (GDataParsable *self, GString *xml_string, gboolean declare_namespaces)
+gboolean
+_gdata_parsable_reader_step (GDataParsableReader *self, guint max_children, gint64 end_time, gboolean *finished, GError **error)
 {
-	GDataParsableClass *klass;
-	guint length;
-	GHashTable *namespaces = NULL; /* shut up, gcc */
-
-	g_return_if_fail (GDATA_IS_PARSABLE (self));
-	g_return_if_fail (xml_string != NULL);
+	guint n_children = 0;
 
-	klass = GDATA_PARSABLE_GET_CLASS (self);
-	g_assert (klass->element_name != NULL);
+	g_return_val_if_fail (self != NULL, FALSE);
+	g_return_val_if_fail (finished != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	/* Get the namespaces the class uses */
-	if (declare_namespaces == TRUE && klass->get_namespaces != NULL) {
-		namespaces = g_hash_table_new (g_str_hash, g_str_equal);
-		klass->get_namespaces (self, namespaces);
+	*finished = FALSE;
 
-		/* Remove any duplicate extra namespaces */
-		g_hash_table_foreach_remove (self->priv->extra_namespaces, (GHRFunc) filter_namespaces_cb, namespaces);
-	}
+	/* Parse each child node in turn. xmlTextReaderExpand() reads the whole of the current child's subtree, and xmlTextReaderNext() then skips
+	 * to its next sibling, which allows the reader to free the subtree we've just finished with. */
+	while (self->ret == 1 && xmlTextReaderDepth (self->reader) > self->root_depth) {
+		xmlNode *node;
 
-	/* Build up the namespace list */
-	if (klass->element_namespace != NULL)
-		g_string_append_printf (xml_string, "<%s:%s", klass->element_namespace, klass->element_name);
-	else
-		g_string_append_printf (xml_string, "<%s", klass->element_name);
+		if (n_children > 0 &&
+		    ((max_children > 0 && n_children >= max_children) || (end_time >= 0 && g_get_monotonic_time () >= end_time))) {
+			return TRUE;
+		}
 
-	/* We only include the normal namespaces if we're not at the top level of XML building */
-	if (declare_namespaces == TRUE) {
-		g_string_append (xml_string, " xmlns='http://www.w3.org/2005/Atom'");
-		if (namespaces != NULL) {
-			g_hash_table_foreach (namespaces, (GHFunc) build_namespaces_cb, xml_string);
-			g_hash_table_destroy (namespaces);
+		node = xmlTextReaderExpand (self->reader);
+		if (node == NULL) {
+			self->ret = -1;
+			break;
 		}
-	}
 
-	g_hash_table_foreach (self->priv->extra_namespaces, (GHFunc) build_namespaces_cb, xml_string);
+		if (self->context != NULL && node->type == XML_ELEMENT_NODE) {
+			self->context->child_node = node;
+			self->context->child_index = self->context->n_children++;
+		}
 
-	/* Add anything the class thinks is suitable */
-	if (klass->pre_get_xml != NULL)
-		klass->pre_get_xml (self, xml_string);
-	g_string_append_c (xml_string, '>');
+		if (call_parse_xml (self->klass, self->parsable, self->doc, node, self->user_data, error) == FALSE)
+			return FALSE;
 
-	/* Store the length before we close the opening tag, so we can determine whether to self-close later on */
-	length = xml_string->len;
+		n_children++;
+		self->ret = xmlTextReaderNext (self->reader);
+	}
 
-	/* Add the rest of the XML */
-	if (klass->get_xml != NULL)
-		klass->get_xml (self, xml_string);
+	if (self->ret == -1) {
+		set_xml_parsing_error (error);
+		return FALSE;
+	}
 
-	/* Any extra XML? */
-	if (self->priv->extra_xml != NULL && self->priv->extra_xml->str != NULL)
-		g_string_append (xml_string, self->priv->extra_xml->str);
+	self->ret = 0;
+	*finished = TRUE;
 
-	/* Close the element; either by self-closing the opening tag, or by writing out a closing tag */
-	if (xml_string->len == length)
-		g_string_overwrite (xml_string, length - 1, "/>");
-	else if (klass->element_namespace != NULL)
-		g_string_append_printf (xml_string, "</%s:%s>", klass->element_namespace, klass->element_name);
-	else
-		g_string_append_printf (xml_string, "</%s>", klass->element_name);
+	return TRUE;
 }
 
-/**
- * gdata_parsable_get_json:
- * @self: a #GDataParsable
+/*
+ * _gdata_parsable_reader_finish:
+ * @self: (transfer full): the state of a parse whose root node's children have all been parsed by _gdata_parsable_reader_step()
+ * @error: a #GError, or %NULL
  *
- * Builds a JSON representation of the #GDataParsable in its current state, such that it could be inserted on the server. The JSON
- * is valid for stand-alone use.
+ * Finishes a parse by calling <function>post_parse_xml</function>, and frees @self.
  *
- * Return value: the object's JSON; free with g_free()
+ * Return value: the new #GDataParsable, or %NULL; unref with g_object_unref()
  *
  * Since: 0.15.0
  */
-gchar *
-gdata_parsable_get_json (GDataParsable *self)
+GDataParsable *
+_gdata_parsable_reader_finish (GDataParsableReader *self, GError **error)
 {
-	JsonGenerator *generator;
-	JsonBuilder *builder;
-	JsonNode *root;
-	gchar *output;
+	GDataParsable *parsable;
 
-	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+	g_return_val_if_fail (self != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	/* Build the JSON tree. */
-	builder = json_builder_new ();
-	_gdata_parsable_get_json (self, builder);
-	root = json_builder_get_root (builder);
-	g_object_unref (builder);
+	parsable = self->parsable;
+	self->parsable = NULL;
 
-	/* Serialise it to a string. */
-	generator = json_generator_new ();
-	json_generator_set_root (generator, root);
-	output = json_generator_to_data (generator, NULL);
-	g_object_unref (generator);
+	/* Call the post-parse function */
+	if (self->klass->post_parse_xml != NULL &&
+	    self->klass->post_parse_xml (parsable, self->user_data, error) == FALSE) {
+		g_object_unref (parsable);
+		parsable = NULL;
+	} else {
+		finish_parsing (parsable);
+	}
 
-	json_node_free (root);
+	_gdata_parsable_reader_free (self);
 
-	return output;
+	return parsable;
 }
 
 /*
- * _gdata_parsable_get_json:
- * @self: a #GDataParsable
- * @builder: a #JsonBuilder to build the JSON in
+ * _gdata_parsable_reader_free:
+ * @self: (transfer full): the state of a parse started by _gdata_parsable_reader_new()
  *
- * Builds a JSON representation of the #GDataParsable in its current state, such that it could be inserted on the server.
+ * Abandons a parse, freeing its state and the partially-parsed parsable.
  *
  * Since: 0.15.0
  */
 void
-_gdata_parsable_get_json (GDataParsable *self, JsonBuilder *builder)
+_gdata_parsable_reader_free (GDataParsableReader *self)
 {
-	GDataParsableClass *klass;
-	GHashTableIter iter;
-	gchar *member_name;
-	JsonNode *value;
-
-	g_return_if_fail (GDATA_IS_PARSABLE (self));
-	g_return_if_fail (JSON_IS_BUILDER (builder));
+	if (self->parsable != NULL)
+		g_object_unref (self->parsable);
 
-	klass = GDATA_PARSABLE_GET_CLASS (self);
+	g_slice_free (GDataParsableReader, self);
+}
 
-	json_builder_begin_object (builder);
+/*
+ * _gdata_parsable_new_from_xml_reader:
+ * @parsable_type: the type of the class represented by the XML
+ * @reader: an #xmlTextReader positioned at the start of the document
+ * @unhandled_xml_mode: how to handle XML which isn't understood by the parsable (or any of its children), with %GDATA_PARSE_LAZY_SUBTREES optionally set
+ * @user_data: data to pass to the class functions
+ * @error: a #GError, or %NULL
+ *
+ * Creates a new #GDataParsable subclass (of the given @parsable_type) by streaming the XML read by @reader, rather than by building a DOM for the
+ * entire document first. The class functions are called exactly as for _gdata_parsable_new_from_xml_node(), except that only one child subtree of
+ * the root node exists in memory at any time: each child of the root node is expanded, passed to <function>parse_xml</function>, and then freed
+ * before the next child is read. This means that peak memory usage for a large feed is bounded by the size of its largest entry, and that
+ * <function>parse_xml</function> (and hence any progress callbacks) is called for each entry as soon as it's been read.
+ *
+ * As a consequence, <function>pre_parse_xml</function> may only inspect the attributes and namespace declarations of the root node it's passed;
+ * the root node's children will not have been read at that point.
+ *
+ * @reader is not freed by this function. The parse can also be done a few children at a time, using _gdata_parsable_reader_new() and friends.
+ *
+ * Return value: a new #GDataParsable, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataParsable *
+_gdata_parsable_new_from_xml_reader (GType parsable_type, xmlTextReader *reader, GDataUnhandledXmlMode unhandled_xml_mode, gpointer user_data,
+                                     GError **error)
+{
+	GDataParsableReader *parsable_reader;
+	gboolean finished;
 
-	/* Add the JSON. */
-	if (klass->get_json != NULL)
-		klass->get_json (self, builder);
+	parsable_reader = _gdata_parsable_reader_new (parsable_type, reader, unhandled_xml_mode, user_data, error);
+	if (parsable_reader == NULL)
+		return NULL;
 
-	/* Any extra JSON which we couldn't parse before? */
-	g_hash_table_iter_init (&iter, self->priv->extra_json);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &member_name, (gpointer *) &value) == TRUE) {
-		json_builder_set_member_name (builder, member_name);
-		json_builder_add_value (builder, json_node_copy (value)); /* transfers ownership */
+	if (_gdata_parsable_reader_step (parsable_reader, 0, -1, &finished, error) == FALSE) {
+		_gdata_parsable_reader_free (parsable_reader);
+		return NULL;
 	}
 
-	json_builder_end_object (builder);
+	g_assert (finished == TRUE);
+
+	return _gdata_parsable_reader_finish (parsable_reader, error);
 }
 
 /*
- * _gdata_parsable_is_constructed_from_xml:
- * @self: a #GDataParsable
+ * _gdata_parsable_new_from_xml_stream:
+ * @parsable_type: the type of the class represented by the XML
+ * @xml: the XML for the parsable object, with full namespace declarations
+ * @length: the length of @xml, or -1
+ * @user_data: data to pass to the class functions
+ * @error: a #GError, or %NULL
  *
- * Returns the value of #GDataParsable:constructed-from-xml.
+ * Equivalent to _gdata_parsable_new_from_xml(), but streams @xml using _gdata_parsable_new_from_xml_reader() rather than building a DOM for the whole
+ * document. This should be used for large documents such as feeds, where the parsable's <function>pre_parse_xml</function> function only needs the
+ * root node's attributes.
  *
- * Return value: %TRUE if the #GDataParsable was constructed from XML, %FALSE otherwise
+ * Return value: a new #GDataParsable, or %NULL; unref with g_object_unref()
  *
- * Since: 0.7.0
+ * Since: 0.15.0
  */
-gboolean
-_gdata_parsable_is_constructed_from_xml (GDataParsable *self)
+GDataParsable *
+_gdata_parsable_new_from_xml_stream (GType parsable_type, const gchar *xml, gint length, gpointer user_data, GError **error)
 {
-	g_return_val_if_fail (GDATA_IS_PARSABLE (self), FALSE);
-	return self->priv->constructed_from_xml;
+	xmlTextReader *reader;
+	GDataParsable *parsable;
+	ScannerContext context;
+
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
+	g_return_val_if_fail (xml != NULL && *xml != '\0', NULL);
+	g_return_val_if_fail (length >= -1, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	_gdata_parsable_init_libxml ();
+
+	if (length == -1)
+		length = strlen (xml);
+
+	reader = xmlReaderForMemory (xml, length, "/dev/null", NULL, GDATA_XML_PARSE_OPTIONS);
+	if (reader == NULL) {
+		set_xml_parsing_error (error);
+		return NULL;
+	}
+
+	push_scanner_context (&context, xml, length);
+	parsable = _gdata_parsable_new_from_xml_reader (parsable_type, reader, GDATA_UNHANDLED_XML_KEEP, user_data, error);
+	pop_scanner_context (&context);
+
+	xmlFreeTextReader (reader);
+
+	return parsable;
+}
+
+/*
+ * _gdata_parsable_new_from_xml_input:
+ * @parsable_type: the type of the class represented by the XML
+ * @read_callback: an #xmlInputReadCallback to pull the XML from
+ * @read_user_data: data to pass to @read_callback
+ * @unhandled_xml_mode: how to handle XML which isn't understood by the parsable (or any of its children), with %GDATA_PARSE_LAZY_SUBTREES optionally set
+ * @retain_original_xml: %TRUE to keep the original XML of the root's children, if their classes support it
+ * @user_data: data to pass to the class functions
+ * @error: a #GError, or %NULL
+ *
+ * Equivalent to _gdata_parsable_new_from_xml_stream(), but pulls the XML incrementally from @read_callback rather than requiring the whole document
+ * to be in memory. @read_callback may block until more data is available, and should return <code class="literal">0</code> once the end of the
+ * document has been reached.
+ *
+ * Since the document isn't available in full, the original XML of the root's children (see _gdata_parsable_get_original_xml()) is only kept if
+ * @retain_original_xml is %TRUE, as this means holding a copy of the XML which has been read but not yet parsed. It should only be set if the
+ * children are expected to be of a class which retains its original XML (see _gdata_parsable_type_retains_original_xml()).
+ *
+ * Return value: a new #GDataParsable, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataParsable *
+_gdata_parsable_new_from_xml_input (GType parsable_type, xmlInputReadCallback read_callback, gpointer read_user_data,
+                                    GDataUnhandledXmlMode unhandled_xml_mode, gboolean retain_original_xml, gpointer user_data, GError **error)
+{
+	xmlTextReader *reader;
+	GDataParsable *parsable;
+	ScannerInput input;
+
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
+	g_return_val_if_fail (read_callback != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	_gdata_parsable_init_libxml ();
+
+	if (retain_original_xml == FALSE) {
+		reader = xmlReaderForIO (read_callback, NULL, read_user_data, "/dev/null", NULL, GDATA_XML_PARSE_OPTIONS);
+	} else {
+		/* Copy the XML to the scanner as it's read. The reader starts reading as soon as it's created. */
+		input.read_callback = read_callback;
+		input.read_user_data = read_user_data;
+		push_scanner_context (&(input.context), NULL, 0);
+
+		reader = xmlReaderForIO ((xmlInputReadCallback) scanner_input_read_cb, NULL, &input, "/dev/null", NULL, GDATA_XML_PARSE_OPTIONS);
+	}
+
+	if (reader == NULL) {
+		if (retain_original_xml == TRUE)
+			pop_scanner_context (&(input.context));
+
+		set_xml_parsing_error (error);
+		return NULL;
+	}
+
+	parsable = _gdata_parsable_new_from_xml_reader (parsable_type, reader, unhandled_xml_mode, user_data, error);
+
+	/* The reader may read from the input until it's freed */
+	xmlFreeTextReader (reader);
+
+	if (retain_original_xml == TRUE)
+		pop_scanner_context (&(input.context));
+
+	return parsable;
+}
+
+/**
+ * gdata_parsable_new_from_json:
+ * @parsable_type: the type of the class represented by the JSON
+ * @json: the JSON for just the parsable object
+ * @length: the length of @json, or -1
+ * @error: a #GError, or %NULL
+ *
+ * Creates a new #GDataParsable subclass (of the given @parsable_type) from the given @json.
+ *
+ * An object of the given @parsable_type is created, and its <function>parse_json</function> and
+ * <function>post_parse_json</function> class functions called on the JSON node obtained from @json.
+ * <function>post_parse_json</function> is called once on the root node, while <function>parse_json</function> is called for
+ * each of the node's members.
+ *
+ * If @length is -1, @json will be assumed to be nul-terminated.
+ *
+ * If an error occurs during parsing, a suitable error from #GDataParserError will be returned.
+ *
+ * Return value: a new #GDataParsable, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataParsable *
+gdata_parsable_new_from_json (GType parsable_type, const gchar *json, gint length, GError **error)
+{
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
+	g_return_val_if_fail (json != NULL && *json != '\0', NULL);
+	g_return_val_if_fail (length >= -1, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return _gdata_parsable_new_from_json (parsable_type, json, length, NULL, error);
+}
+
+GDataParsable *
+_gdata_parsable_new_from_json (GType parsable_type, const gchar *json, gint length, gpointer user_data, GError **error)
+{
+	JsonParser *parser;
+	JsonReader *reader;
+	GDataParsable *parsable;
+	GError *child_error = NULL;
+
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
+	g_return_val_if_fail (json != NULL && *json != '\0', NULL);
+	g_return_val_if_fail (length >= -1, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (length == -1)
+		length = strlen (json);
+
+	parser = json_parser_new ();
+	if (!json_parser_load_from_data (parser, json, length, &child_error)) {
+		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+		             /* Translators: the parameter is an error message */
+		             _("Error parsing JSON: %s"), child_error->message);
+		g_error_free (child_error);
+		g_object_unref (parser);
+
+		return NULL;
+	}
+
+	if (JSON_NODE_HOLDS_OBJECT (json_parser_get_root (parser)) == TRUE) {
+		parsable = _gdata_parsable_new_from_json_object (parsable_type, json_node_get_object (json_parser_get_root (parser)), user_data, error);
+	} else {
+		/* Let _gdata_parsable_new_from_json_node() report the error */
+		reader = json_reader_new (json_parser_get_root (parser));
+		parsable = _gdata_parsable_new_from_json_node (parsable_type, reader, user_data, error);
+		g_object_unref (reader);
+	}
+
+	g_object_unref (parser);
+
+	return parsable;
+}
+
+static GDataParsable *
+new_from_json_reader (GType parsable_type, JsonReader *reader, JsonObject *object, gpointer user_data, GError **error)
+{
+	GDataParsable *parsable;
+	GDataParsableClass *klass;
+	gint i;
+
+	/* Indicator property which allows distinguishing between locally created and server based objects
+	 * as it is used for non-XML tasks, and adding another one for JSON would be a bit pointless. */
+	parsable = new_parsable (parsable_type);
+
+	klass = GDATA_PARSABLE_GET_CLASS (parsable);
+	g_assert (klass->parse_json != NULL);
+
+	/* Check that the outermost node is an object. */
+	if (json_reader_is_object (reader) == FALSE) {
+		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+		             /* Translators: the parameter is an error message */
+		             _("Error parsing JSON: %s"),
+		             _("Outermost JSON node is not an object."));
+		g_object_unref (parsable);
+		return NULL;
+	}
+
+	/* Parse each child member. This assumes the outermost node is an object. */
+	parsable->priv->json_object = object;
+
+	for (i = 0; i < json_reader_count_members (reader); i++) {
+		g_return_val_if_fail (json_reader_read_element (reader, i), NULL);
+
+		if (klass->parse_json (parsable, reader, user_data, error) == FALSE) {
+			parsable->priv->json_object = NULL;
+			g_object_unref (parsable);
+			return NULL;
+		}
+
+		json_reader_end_element (reader);
+	}
+
+	parsable->priv->json_object = NULL;
+
+	/* Call the post-parse function */
+	if (klass->post_parse_json != NULL &&
+	    klass->post_parse_json (parsable, user_data, error) == FALSE) {
+		g_object_unref (parsable);
+		return NULL;
+	}
+
+	finish_parsing (parsable);
+
+	return parsable;
+}
+
+GDataParsable *
+_gdata_parsable_new_from_json_node (GType parsable_type, JsonReader *reader, gpointer user_data, GError **error)
+{
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
+	g_return_val_if_fail (reader != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return new_from_json_reader (parsable_type, reader, NULL, user_data, error);
+}
+
+/*
+ * _gdata_parsable_new_from_json_object:
+ * @parsable_type: the type of the class represented by the JSON
+ * @object: the JSON object for the parsable object
+ * @user_data: data to pass to the class functions
+ * @error: a #GError, or %NULL
+ *
+ * Equivalent to _gdata_parsable_new_from_json_node(), but with direct access to the object being parsed. This allows unhandled members to be
+ * kept by reference (see _gdata_parsable_get_json_member()) rather than deep-copied.
+ *
+ * Return value: a new #GDataParsable, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataParsable *
+_gdata_parsable_new_from_json_object (GType parsable_type, JsonObject *object, gpointer user_data, GError **error)
+{
+	JsonNode *node;
+	JsonReader *reader;
+	GDataParsable *parsable;
+
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
+	g_return_val_if_fail (object != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	node = json_node_new (JSON_NODE_OBJECT);
+	json_node_set_object (node, object);
+	reader = json_reader_new (node);
+
+	parsable = new_from_json_reader (parsable_type, reader, object, user_data, error);
+
+	g_object_unref (reader);
+	json_node_free (node);
+
+	return parsable;
+}
+
+/* Returns a pointer to just after the JSON string starting at @p, or %NULL if it's unterminated. */
+static const gchar *
+skip_json_string (const gchar *p, const gchar *end)
+{
+	g_assert (*p == '"');
+
+	for (p++; p < end; p++) {
+		if (*p == '\\' && ++p == end)
+			return NULL;
+		else if (*p == '"')
+			return p + 1;
+	}
+
+	return NULL;
+}
+
+/* Returns a pointer to just after the JSON value starting at @p, or %NULL if it's truncated. The value isn't validated beyond matching up its
+ * brackets and string delimiters; that's left to json-glib once the value has been extracted. */
+static const gchar *
+skip_json_value (const gchar *p, const gchar *end)
+{
+	guint depth = 0;
+
+	if (p == end) {
+		return NULL;
+	} else if (*p == '"') {
+		return skip_json_string (p, end);
+	} else if (*p != '{' && *p != '[') {
+		/* A number, true, false or null */
+		while (p < end && strchr (",:{}[]\" \t\r\n", *p) == NULL)
+			p++;
+		return p;
+	}
+
+	while (p < end) {
+		switch (*p) {
+			case '"':
+				p = skip_json_string (p, end);
+				if (p == NULL)
+					return NULL;
+				continue;
+			case '{':
+			case '[':
+				depth++;
+				break;
+			case '}':
+			case ']':
+				if (--depth == 0)
+					return p + 1;
+				break;
+			default:
+				break;
+		}
+
+		p++;
+	}
+
+	return NULL;
+}
+
+static const gchar *
+skip_json_whitespace (const gchar *p, const gchar *end)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+		p++;
+	return p;
+}
+
+/* Parses the single-member JSON object in @document, and passes its member to @parsable's parse_json function. */
+static gboolean
+parse_json_member (GDataParsable *parsable, JsonParser *parser, GString *document, gpointer user_data, GError **error)
+{
+	JsonReader *reader;
+	GError *child_error = NULL;
+	gboolean success;
+
+	if (json_parser_load_from_data (parser, document->str, document->len, &child_error) == FALSE) {
+		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+		             /* Translators: the parameter is an error message */
+		             _("Error parsing JSON: %s"), child_error->message);
+		g_error_free (child_error);
+
+		return FALSE;
+	}
+
+	reader = json_reader_new (json_parser_get_root (parser));
+	json_reader_read_element (reader, 0);
+
+	parsable->priv->json_object = json_node_get_object (json_parser_get_root (parser));
+	success = GDATA_PARSABLE_GET_CLASS (parsable)->parse_json (parsable, reader, user_data, error);
+	parsable->priv->json_object = NULL;
+
+	json_reader_end_element (reader);
+	g_object_unref (reader);
+
+	return success;
+}
+
+/*
+ * _gdata_parsable_new_from_json_stream:
+ * @parsable_type: the type of the class represented by the JSON
+ * @json: the JSON for the parsable object
+ * @length: the length of @json, or -1
+ * @streamed_member: the name of a member of the outermost object whose array value should be parsed one element at a time
+ * @user_data: data to pass to the class functions
+ * @error: a #GError, or %NULL
+ *
+ * Equivalent to _gdata_parsable_new_from_json(), but only builds a JSON tree for one member of the outermost object at a time, rather than for the
+ * whole document. The elements of the @streamed_member array are handled individually, with the parsable's <function>parse_json</function> class
+ * function being called once for each of them, with a one-element array as the value of the member. This bounds the memory used by a large feed to
+ * that needed for one of its entries at a time, and lets each entry be handled as soon as it's been parsed.
+ *
+ * Unhandled members are kept by reference to the trees they were parsed into, rather than deep-copied out of them.
+ *
+ * Return value: a new #GDataParsable, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataParsable *
+_gdata_parsable_new_from_json_stream (GType parsable_type, const gchar *json, gint length, const gchar *streamed_member, gpointer user_data,
+                                      GError **error)
+{
+	GDataParsable *parsable;
+	GDataParsableClass *klass;
+	JsonParser *parser;
+	GString *document;
+	const gchar *p, *end;
+	gsize streamed_member_length;
+
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
+	g_return_val_if_fail (json != NULL && *json != '\0', NULL);
+	g_return_val_if_fail (length >= -1, NULL);
+	g_return_val_if_fail (streamed_member != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (length == -1)
+		length = strlen (json);
+
+	end = json + length;
+	streamed_member_length = strlen (streamed_member);
+
+	/* Leave anything which isn't an object to _gdata_parsable_new_from_json(), so that it can report the error */
+	p = skip_json_whitespace (json, end);
+	if (p == end || *p != '{')
+		return _gdata_parsable_new_from_json (parsable_type, json, length, user_data, error);
+
+	parsable = new_parsable (parsable_type);
+
+	klass = GDATA_PARSABLE_GET_CLASS (parsable);
+	g_assert (klass->parse_json != NULL);
+
+	parser = json_parser_new ();
+	document = g_string_sized_new (1024);
+
+	/* Split the outermost object into its members, and parse each of them as a separate document */
+	p++;
+	while (TRUE) {
+		const gchar *name, *name_end, *value;
+
+		p = skip_json_whitespace (p, end);
+		if (p == end)
+			goto malformed;
+		else if (*p == '}')
+			break;
+		else if (*p != '"')
+			goto malformed;
+
+		name = p;
+		name_end = skip_json_string (p, end);
+		if (name_end == NULL)
+			goto malformed;
+
+		p = skip_json_whitespace (name_end, end);
+		if (p == end || *p != ':')
+			goto malformed;
+		p = skip_json_whitespace (p + 1, end);
+
+		if (p < end && *p == '[' &&
+		    (gsize) (name_end - name - 2) == streamed_member_length && strncmp (name + 1, streamed_member, streamed_member_length) == 0) {
+			/* Parse the array's elements one at a time */
+			p++;
+			while (TRUE) {
+				p = skip_json_whitespace (p, end);
+				if (p == end)
+					goto malformed;
+				else if (*p == ']')
+					break;
+
+				value = p;
+				p = skip_json_value (p, end);
+				if (p == NULL)
+					goto malformed;
+
+				g_string_truncate (document, 0);
+				g_string_append_c (document, '{');
+				g_string_append_len (document, name, name_end - name);
+				g_string_append (document, ":[");
+				g_string_append_len (document, value, p - value);
+				g_string_append (document, "]}");
+
+				if (parse_json_member (parsable, parser, document, user_data, error) == FALSE)
+					goto error;
+
+				p = skip_json_whitespace (p, end);
+				if (p < end && *p == ',')
+					p++;
+				else if (p == end || *p != ']')
+					goto malformed;
+			}
+
+			p++;
+		} else {
+			value = p;
+			p = skip_json_value (p, end);
+			if (p == NULL)
+				goto malformed;
+
+			g_string_truncate (document, 0);
+			g_string_append_c (document, '{');
+			g_string_append_len (document, name, p - name);
+			g_string_append_c (document, '}');
+
+			if (parse_json_member (parsable, parser, document, user_data, error) == FALSE)
+				goto error;
+		}
+
+		p = skip_json_whitespace (p, end);
+		if (p < end && *p == ',')
+			p++;
+		else if (p == end || *p != '}')
+			goto malformed;
+	}
+
+	g_string_free (document, TRUE);
+	g_object_unref (parser);
+
+	/* Call the post-parse function */
+	if (klass->post_parse_json != NULL &&
+	    klass->post_parse_json (parsable, user_data, error) == FALSE) {
+		g_object_unref (parsable);
+		return NULL;
+	}
+
+	finish_parsing (parsable);
+
+	return parsable;
+
+malformed:
+	/* The document couldn't be split up, so parse it in one go instead; json-glib will report the error, if there is one */
+	g_string_free (document, TRUE);
+	g_object_unref (parser);
+	g_object_unref (parsable);
+
+	return _gdata_parsable_new_from_json (parsable_type, json, length, user_data, error);
+
+error:
+	g_string_free (document, TRUE);
+	g_object_unref (parser);
+	g_object_unref (parsable);
+
+	return NULL;
+}
+
+/*
+ * _gdata_parsable_get_json_member:
+ * @self: a #GDataParsable
+ * @member_name: the name of the member to return
+ *
+ * Looks up the node for one of the members of the JSON object which @self is being parsed from. This is only available from within
+ * <function>parse_json</function> class functions, and then only if the parsable was created by _gdata_parsable_new_from_json_object(),
+ * _gdata_parsable_new_from_json() or _gdata_parsable_new_from_json_stream(). It allows subtrees of the JSON to be kept by reference.
+ *
+ * Return value: (transfer none): the member's node, or %NULL if it's not available
+ *
+ * Since: 0.15.0
+ */
+JsonNode *
+_gdata_parsable_get_json_member (GDataParsable *self, const gchar *member_name)
+{
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+	g_return_val_if_fail (member_name != NULL, NULL);
+
+	if (self->priv->json_object == NULL || json_object_has_member (self->priv->json_object, member_name) == FALSE)
+		return NULL;
+
+	return json_object_get_member (self->priv->json_object, member_name);
+}
+
+static void
+build_namespaces_cb (gchar *prefix, gchar *href, GString *output)
+{
+	g_string_append (output, " xmlns:");
+	g_string_append (output, prefix);
+	g_string_append (output, "='");
+	g_string_append (output, href);
+	g_string_append_c (output, '\'');
+}
+
+static void
+copy_namespaces_cb (const gchar *prefix, const gchar *href, GHashTable *namespaces)
+{
+	g_hash_table_insert (namespaces, g_strdup (prefix), g_strdup (href));
+}
+
+/* Returns the cached namespaces for @self's class, building them from @self if this is the first time they've been needed. Returns %NULL if the
+ * class' namespaces can't be cached. */
+static const NamespaceCache *
+get_namespace_cache (GDataParsable *self)
+{
+	GDataParsableClass *klass = GDATA_PARSABLE_GET_CLASS (self);
+	GType type, ancestor;
+	NamespaceCache *cache;
+
+	type = G_TYPE_FROM_CLASS (klass);
+	cache = g_type_get_qdata (type, namespace_cache_quark);
+
+	if (cache != NULL)
+		return cache;
+
+	for (ancestor = type; ancestor != G_TYPE_OBJECT; ancestor = g_type_parent (ancestor)) {
+		if (g_type_get_qdata (ancestor, dynamic_namespaces_quark) != NULL)
+			return NULL;
+	}
+
+	G_LOCK (namespace_cache);
+
+	/* Check again, in case another thread got here first */
+	cache = g_type_get_qdata (type, namespace_cache_quark);
+
+	if (cache == NULL) {
+		GHashTable *namespaces;
+		GString *declarations;
+
+		namespaces = g_hash_table_new (g_str_hash, g_str_equal);
+		if (klass->get_namespaces != NULL)
+			klass->get_namespaces (self, namespaces);
+
+		declarations = g_string_new (" xmlns='http://www.w3.org/2005/Atom'");
+		g_hash_table_foreach (namespaces, (GHFunc) build_namespaces_cb, declarations);
+
+		cache = g_slice_new (NamespaceCache);
+		cache->namespaces = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		g_hash_table_foreach (namespaces, (GHFunc) copy_namespaces_cb, cache->namespaces);
+		cache->declarations_length = declarations->len;
+		cache->declarations = g_string_free (declarations, FALSE);
+
+		g_hash_table_destroy (namespaces);
+
+		g_type_set_qdata (type, namespace_cache_quark, cache);
+	}
+
+	G_UNLOCK (namespace_cache);
+
+	return cache;
+}
+
+/*
+ * _gdata_parsable_class_set_dynamic_namespaces:
+ * @klass: a #GDataParsableClass
+ *
+ * Marks @klass (and its subclasses) as having namespaces which depend on the state of their instances, so that the result of
+ * #GDataParsableClass.get_namespaces isn't cached. By default, it's only called once per class, the first time an instance of the class is
+ * serialised with its namespaces declared. This should be called from the class' class_init function.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_class_set_dynamic_namespaces (GDataParsableClass *klass)
+{
+	g_return_if_fail (GDATA_IS_PARSABLE_CLASS (klass));
+	g_type_set_qdata (G_TYPE_FROM_CLASS (klass), dynamic_namespaces_quark, GINT_TO_POINTER (TRUE));
+}
+
+static void
+clone_nothing (GDataParsable *self, GDataParsable *clone)
+{
+	/* The class has no state of its own to copy */
+}
+
+/*
+ * _gdata_parsable_class_set_clone_func:
+ * @klass: a #GDataParsableClass
+ * @clone_func: (allow-none): a function to copy the state of instances of @klass, or %NULL if the class has no state of its own
+ *
+ * Sets the function used by gdata_parsable_clone() to copy the private state declared by @klass (but not that of its parent or child classes) from
+ * an instance to a newly constructed clone of it. It's called after the clone functions of the parent classes, and must not emit property
+ * notifications. Classes which don't set a clone function (and their subclasses) are cloned by serialising and re-parsing them. This should be
+ * called from the class' class_init function.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_class_set_clone_func (GDataParsableClass *klass, GDataParsableCloneFunc clone_func)
+{
+	g_return_if_fail (GDATA_IS_PARSABLE_CLASS (klass));
+	g_type_set_qdata (G_TYPE_FROM_CLASS (klass), clone_func_quark, (clone_func != NULL) ? (gpointer) clone_func : (gpointer) clone_nothing);
+}
+
+/*
+ * _gdata_parsable_class_set_json_write_func:
+ * @klass: a #GDataParsableClass
+ * @json_write_func: a function to write the JSON members of instances of @klass
+ *
+ * Sets the function used by gdata_parsable_get_json() to write the members which @klass' #GDataParsableClass.get_json function adds (but not those
+ * of its parent or child classes) directly to the output string, using _gdata_parsable_json_append_member_name() and the other JSON writing
+ * functions. It's called after the write functions of the parent classes, and must write exactly the same members as the get_json function.
+ *
+ * If any class in an object's hierarchy overrides get_json without setting a write function, the object's JSON is built as a #JsonNode tree and
+ * then serialised instead, which is about twice as slow and uses twice as much memory. This should be called from the class' class_init
+ * function.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_class_set_json_write_func (GDataParsableClass *klass, GDataParsableJsonWriteFunc json_write_func)
+{
+	g_return_if_fail (GDATA_IS_PARSABLE_CLASS (klass));
+	g_return_if_fail (json_write_func != NULL);
+
+	g_type_set_qdata (G_TYPE_FROM_CLASS (klass), json_write_func_quark, json_write_func);
+}
+
+static gboolean
+original_xml_nothing (GDataParsable *self, GString *xml_string)
+{
+	/* The class has no state which the original XML doesn't reflect */
+	return TRUE;
+}
+
+/*
+ * _gdata_parsable_class_set_original_xml_func:
+ * @klass: a #GDataParsableClass
+ * @original_xml_func: (allow-none): a function to check that the original XML of instances of @klass is still valid, or %NULL
+ *
+ * Marks instances of @klass as retaining the XML they were parsed from, so that it can be output again by _gdata_parsable_get_original_xml() rather
+ * than being regenerated. Only a parsable's own element is retained: that is, the root element of the document it's parsed from, or (as for the
+ * entries in a feed) one of the children of the root.
+ *
+ * The XML is automatically invalidated when a property of the parsable (or of any parsable constructed while it was being parsed, such as its
+ * links) is changed. If @klass has state which can be modified without notifying a property, @original_xml_func must check for such modifications
+ * and return %FALSE if there have been any. Otherwise it may append content to @xml_string to be inserted at the start of the element's content;
+ * this is done for the parent classes first. Subclasses of @klass don't retain their XML unless they call this themselves.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_class_set_original_xml_func (GDataParsableClass *klass, GDataParsableOriginalXmlFunc original_xml_func)
+{
+	g_return_if_fail (GDATA_IS_PARSABLE_CLASS (klass));
+	g_type_set_qdata (G_TYPE_FROM_CLASS (klass), original_xml_func_quark,
+	                  (original_xml_func != NULL) ? (gpointer) original_xml_func : (gpointer) original_xml_nothing);
+}
+
+/*
+ * _gdata_parsable_type_retains_original_xml:
+ * @parsable_type: a #GDataParsable subclass type
+ *
+ * Returns whether instances of @parsable_type retain the XML they were parsed from; see _gdata_parsable_class_set_original_xml_func(). This requires
+ * @parsable_type and all its parent classes to have called it.
+ *
+ * Return value: %TRUE if instances of @parsable_type retain their original XML, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_parsable_type_retains_original_xml (GType parsable_type)
+{
+	GType type;
+
+	for (type = parsable_type; type != GDATA_TYPE_PARSABLE; type = g_type_parent (type)) {
+		if (g_type_get_qdata (type, original_xml_func_quark) == NULL)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+call_original_xml_funcs (GDataParsable *self, GType type, GString *xml_string)
+{
+	GDataParsableOriginalXmlFunc original_xml_func;
+
+	if (type == GDATA_TYPE_PARSABLE)
+		return TRUE;
+
+	/* Parent classes first */
+	if (call_original_xml_funcs (self, g_type_parent (type), xml_string) == FALSE)
+		return FALSE;
+
+	original_xml_func = (GDataParsableOriginalXmlFunc) g_type_get_qdata (type, original_xml_func_quark);
+	g_assert (original_xml_func != NULL);
+
+	return original_xml_func (self, xml_string);
+}
+
+/*
+ * _gdata_parsable_get_original_xml:
+ * @self: a #GDataParsable
+ * @xml_string: a #GString to append the XML to
+ *
+ * Appends the XML @self was parsed from to @xml_string, if it's been retained (see _gdata_parsable_class_set_original_xml_func()) and @self hasn't
+ * been modified since. This is much cheaper than regenerating the XML using _gdata_parsable_get_xml(), and preserves any XML which @self didn't
+ * understand exactly. The XML declares all the namespaces it uses, so can be used either stand-alone or inserted into a larger XML tree; but it's
+ * in the form the server sent it, so shouldn't be used where the output has to be predictable.
+ *
+ * Return value: %TRUE if the original XML was appended to @xml_string, %FALSE if it's unavailable and @xml_string is unchanged
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_parsable_get_original_xml (GDataParsable *self, GString *xml_string)
+{
+	OriginalXml *original_xml;
+	gsize length;
+
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), FALSE);
+	g_return_val_if_fail (xml_string != NULL, FALSE);
+
+	original_xml = self->priv->original_xml;
+	if (self->priv->owns_original_xml == FALSE || g_atomic_int_get (&(original_xml->modified)) != 0)
+		return FALSE;
+
+	length = xml_string->len;
+	g_string_append_len (xml_string, original_xml->xml, original_xml->content_offset);
+
+	if (call_original_xml_funcs (self, G_OBJECT_TYPE (self), xml_string) == FALSE) {
+		g_string_truncate (xml_string, length);
+		return FALSE;
+	}
+
+	g_string_append_len (xml_string, original_xml->xml + original_xml->content_offset, original_xml->length - original_xml->content_offset);
+
+	return TRUE;
+}
+
+/*
+ * _gdata_parsable_forget_original_xml:
+ * @self: a #GDataParsable
+ *
+ * Stops @self from being output using the XML it was parsed from, for example because that XML contains elements which shouldn't be output again.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_forget_original_xml (GDataParsable *self)
+{
+	g_return_if_fail (GDATA_IS_PARSABLE (self));
+
+	if (self->priv->original_xml != NULL)
+		g_atomic_int_set (&(self->priv->original_xml->modified), 1);
+}
+
+/*
+ * _gdata_parsable_swap_unhandled_data:
+ * @self: a #GDataParsable
+ * @other: another #GDataParsable
+ *
+ * Swaps the unhandled XML and JSON of @self and @other, for example so that @self can adopt the unhandled content of a newly-parsed copy of itself
+ * (and @other then frees @self's old content when it's finalized).
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_swap_unhandled_data (GDataParsable *self, GDataParsable *other)
+{
+	GDataParsablePrivate *priv, *other_priv;
+	GString *extra_xml;
+	GHashTable *extra_namespaces, *extra_json;
+	xmlDoc *extra_doc;
+
+	g_return_if_fail (GDATA_IS_PARSABLE (self));
+	g_return_if_fail (GDATA_IS_PARSABLE (other));
+
+	priv = self->priv;
+	other_priv = other->priv;
+
+	extra_xml = priv->extra_xml;
+	extra_namespaces = priv->extra_namespaces;
+	extra_doc = priv->extra_doc;
+	extra_json = priv->extra_json;
+
+	priv->extra_xml = other_priv->extra_xml;
+	priv->extra_namespaces = other_priv->extra_namespaces;
+	priv->extra_doc = other_priv->extra_doc;
+	priv->extra_json = other_priv->extra_json;
+
+	other_priv->extra_xml = extra_xml;
+	other_priv->extra_namespaces = extra_namespaces;
+	other_priv->extra_doc = extra_doc;
+	other_priv->extra_json = extra_json;
+}
+
+/*
+ * _gdata_parsable_get_namespaces:
+ * @self: a #GDataParsable
+ * @namespaces: a #GHashTable to add the namespaces to
+ *
+ * Adds the namespaces used by @self to @namespaces, as #GDataParsableClass.get_namespaces would, but using the cached namespaces for @self's class
+ * where possible. The strings added to @namespaces aren't owned by it, and are valid for at least as long as @self.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_get_namespaces (GDataParsable *self, GHashTable *namespaces)
+{
+	const NamespaceCache *cache;
+	GHashTableIter iter;
+	gpointer prefix, href;
+
+	g_return_if_fail (GDATA_IS_PARSABLE (self));
+	g_return_if_fail (namespaces != NULL);
+
+	cache = get_namespace_cache (self);
+
+	if (cache == NULL) {
+		GDataParsableClass *klass = GDATA_PARSABLE_GET_CLASS (self);
+
+		if (klass->get_namespaces != NULL)
+			klass->get_namespaces (self, namespaces);
+
+		return;
+	}
+
+	g_hash_table_iter_init (&iter, cache->namespaces);
+	while (g_hash_table_iter_next (&iter, &prefix, &href) == TRUE)
+		g_hash_table_insert (namespaces, prefix, href);
+}
+
+static gboolean
+filter_namespaces_cb (gchar *prefix, gchar *href, GHashTable *canonical_namespaces)
+{
+	if (g_hash_table_lookup (canonical_namespaces, prefix) != NULL)
+		return TRUE;
+	return FALSE;
+}
+
+/**
+ * gdata_parsable_get_xml:
+ * @self: a #GDataParsable
+ *
+ * Builds an XML representation of the #GDataParsable in its current state, such that it could be inserted on the server. The XML is guaranteed
+ * to have all its namespaces declared properly in a self-contained fashion, and is valid for stand-alone use.
+ *
+ * Return value: the object's XML; free with g_free()
+ *
+ * Since: 0.4.0
+ **/
+gchar *
+gdata_parsable_get_xml (GDataParsable *self)
+{
+	GString *xml_string;
+
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+
+	xml_string = g_string_sized_new (1000);
+	g_string_append (xml_string, "<?xml version='1.0' encoding='UTF-8'?>");
+	_gdata_parsable_get_xml (self, xml_string, TRUE);
+	return g_string_free (xml_string, FALSE);
+}
+
+/*
+ * _gdata_parsable_get_xml:
+ * @self: a #GDataParsable
+ * @xml_string: a #GString to build the XML in
+ * @declare_namespaces: %TRUE if all the namespaces used in the outputted XML should be declared in the opening tag of the root element,
+ * %FALSE otherwise
+ *
+ * Builds an XML representation of the #GDataParsable in its current state, such that it could be inserted on the server. If @declare_namespaces is
+ * %TRUE, the XML is guaranteed to have all its namespaces declared properly in a self-contained fashion, and is valid for stand-alone use. If
+ * @declare_namespaces is %FALSE, none of the used namespaces are declared, and the XML is suitable for insertion into a larger XML tree.
+ *
+ * Return value: the object's XML; free with g_free()
+ *
+ * Since: 0.4.0
+ */
+/* Returns the offset of the end of @xml_string in the XML as a whole, counting anything which has already been flushed to @sink */
+static inline gsize
+get_xml_offset (const XmlSink *sink, const GString *xml_string)
+{
+	return xml_string->len + ((sink != NULL) ? sink->flushed : 0);
+}
+
+static void
+flush_xml_sink (XmlSink *sink)
+{
+	if (sink->xml_string->len == 0)
+		return;
+
+	sink->func (sink->xml_string->str, sink->xml_string->len, sink->user_data);
+	sink->flushed += sink->xml_string->len;
+	g_string_truncate (sink->xml_string, 0);
+}
+
+void
+_gdata_parsable_get_xml (GDataParsable *self, GString *xml_string, gboolean declare_namespaces)
+{
+	GDataParsableClass *klass;
+	gsize length;
+	XmlSink *sink;
+	const NamespaceCache *cache = NULL;
+	GHashTable *namespaces = NULL; /* shut up, gcc */
+
+	g_return_if_fail (GDATA_IS_PARSABLE (self));
+	g_return_if_fail (xml_string != NULL);
+
+	klass = GDATA_PARSABLE_GET_CLASS (self);
+	g_assert (klass->element_name != NULL);
+
+	/* Only flush if we're writing into the string _gdata_parsable_write_xml() is draining, rather than (e.g.) a batch request built meanwhile */
+	sink = g_private_get (&xml_sink);
+	if (sink != NULL && sink->xml_string != xml_string)
+		sink = NULL;
+
+	/* Get the namespaces the class uses. These are normally the same for every instance of the class, so only have to be worked out once. */
+	if (declare_namespaces == TRUE) {
+		cache = get_namespace_cache (self);
+
+		if (cache == NULL && klass->get_namespaces != NULL) {
+			namespaces = g_hash_table_new (g_str_hash, g_str_equal);
+			klass->get_namespaces (self, namespaces);
+		}
+
+		/* Remove any duplicate extra namespaces */
+		if (self->priv->extra_namespaces != NULL && g_hash_table_size (self->priv->extra_namespaces) > 0 &&
+		    (cache != NULL || namespaces != NULL)) {
+			g_hash_table_foreach_remove (self->priv->extra_namespaces, (GHRFunc) filter_namespaces_cb,
+			                             (cache != NULL) ? cache->namespaces : namespaces);
+		}
+	}
+
+	/* Build up the namespace list */
+	if (klass->element_namespace != NULL)
+		g_string_append_printf (xml_string, "<%s:%s", klass->element_namespace, klass->element_name);
+	else
+		g_string_append_printf (xml_string, "<%s", klass->element_name);
+
+	/* We only include the normal namespaces if we're not at the top level of XML building */
+	if (declare_namespaces == TRUE && cache != NULL) {
+		g_string_append_len (xml_string, cache->declarations, cache->declarations_length);
+	} else if (declare_namespaces == TRUE) {
+		g_string_append (xml_string, " xmlns='http://www.w3.org/2005/Atom'");
+		if (namespaces != NULL) {
+			g_hash_table_foreach (namespaces, (GHFunc) build_namespaces_cb, xml_string);
+			g_hash_table_destroy (namespaces);
+		}
+	}
+
+	/* Most instances don't have any namespaces of their own */
+	if (self->priv->extra_namespaces != NULL && g_hash_table_size (self->priv->extra_namespaces) > 0)
+		g_hash_table_foreach (self->priv->extra_namespaces, (GHFunc) build_namespaces_cb, xml_string);
+
+	/* Add anything the class thinks is suitable */
+	if (klass->pre_get_xml != NULL)
+		klass->pre_get_xml (self, xml_string);
+	g_string_append_c (xml_string, '>');
+
+	/* Store the length before we close the opening tag, so we can determine whether to self-close later on. This is an offset into the XML as a
+	 * whole, since the children may flush the start of the string. */
+	length = get_xml_offset (sink, xml_string);
+
+	/* Add the rest of the XML */
+	if (klass->get_xml != NULL)
+		klass->get_xml (self, xml_string);
+
+	/* Any extra XML? Serialise any which was stored lazily first, so that it only has to be done once. */
+	if (self->priv->extra_doc != NULL) {
+		xmlNode *node;
+		xmlBuffer *buffer = xmlBufferCreate ();
+
+		for (node = xmlDocGetRootElement (self->priv->extra_doc)->children; node != NULL; node = node->next)
+			xmlNodeDump (buffer, self->priv->extra_doc, node, 0, 0);
+
+		if (self->priv->extra_xml == NULL)
+			self->priv->extra_xml = g_string_new ("");
+		g_string_append (self->priv->extra_xml, (gchar*) xmlBufferContent (buffer));
+
+		xmlBufferFree (buffer);
+		xmlFreeDoc (self->priv->extra_doc);
+		self->priv->extra_doc = NULL;
+	}
+
+	if (self->priv->extra_xml != NULL && self->priv->extra_xml->str != NULL)
+		g_string_append (xml_string, self->priv->extra_xml->str);
+
+	/* Close the element; either by self-closing the opening tag, or by writing out a closing tag */
+	if (get_xml_offset (sink, xml_string) == length)
+		g_string_overwrite (xml_string, xml_string->len - 1, "/>");
+	else if (klass->element_namespace != NULL)
+		g_string_append_printf (xml_string, "</%s:%s>", klass->element_namespace, klass->element_name);
+	else
+		g_string_append_printf (xml_string, "</%s>", klass->element_name);
+
+	if (sink != NULL && xml_string->len >= XML_SINK_CHUNK_SIZE)
+		flush_xml_sink (sink);
+}
+
+/*
+ * _gdata_parsable_write_xml:
+ * @self: a #GDataParsable
+ * @use_original_xml: %TRUE to write the XML @self was parsed from if it's available (see _gdata_parsable_get_original_xml()), %FALSE to always
+ * build it afresh
+ * @sink_func: the function to pass the XML to
+ * @user_data: data to pass to @sink_func
+ *
+ * Builds the same stand-alone XML as _gdata_parsable_get_xml() with @declare_namespaces set to %TRUE (but without an XML declaration), passing it
+ * to @sink_func a piece at a time rather than building it all in memory first. The pieces are split at element boundaries once enough XML has
+ * accumulated, so they're typically a few tens of kilobytes each; the data passed to @sink_func is only valid for the duration of the call.
+ *
+ * This should be preferred over _gdata_parsable_get_xml() when the XML's only going to be copied somewhere else, such as into a request body,
+ * since it saves the memory and reallocations of building the whole string.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_write_xml (GDataParsable *self, gboolean use_original_xml, GDataParsableXmlSinkFunc sink_func, gpointer user_data)
+{
+	XmlSink sink, *old_sink;
+
+	g_return_if_fail (GDATA_IS_PARSABLE (self));
+	g_return_if_fail (sink_func != NULL);
+
+	sink.xml_string = g_string_sized_new (XML_SINK_CHUNK_SIZE + 1024);
+	sink.flushed = 0;
+	sink.func = sink_func;
+	sink.user_data = user_data;
+
+	/* The original XML might yet be abandoned and truncated away, so it can't be flushed until it's been written in full */
+	if (use_original_xml == FALSE || _gdata_parsable_get_original_xml (self, sink.xml_string) == FALSE) {
+		old_sink = g_private_get (&xml_sink);
+		g_private_set (&xml_sink, &sink);
+
+		_gdata_parsable_get_xml (self, sink.xml_string, TRUE);
+
+		g_private_set (&xml_sink, old_sink);
+	}
+
+	flush_xml_sink (&sink);
+	g_string_free (sink.xml_string, TRUE);
+}
+
+/*
+ * _gdata_parsable_json_append_string:
+ * @json: the string to append to
+ * @value: (allow-none): the string value to append, or %NULL
+ *
+ * Appends @value to @json as a JSON string, quoted and escaped, or as <literal>null</literal> if @value is %NULL.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_json_append_string (GString *json, const gchar *value)
+{
+	const gchar *p, *start;
+
+	if (value == NULL) {
+		g_string_append (json, "null");
+		return;
+	}
+
+	g_string_append_c (json, '"');
+
+	/* Copy runs of characters which don't need escaping in one go */
+	for (p = start = value; *p != '\0'; p++) {
+		const gchar *escape;
+
+		switch (*p) {
+			case '"': escape = "\\\""; break;
+			case '\\': escape = "\\\\"; break;
+			case '\b': escape = "\\b"; break;
+			case '\f': escape = "\\f"; break;
+			case '\n': escape = "\\n"; break;
+			case '\r': escape = "\\r"; break;
+			case '\t': escape = "\\t"; break;
+			default:
+				if ((guchar) *p >= 0x20)
+					continue;
+				escape = NULL;
+				break;
+		}
+
+		g_string_append_len (json, start, p - start);
+		start = p + 1;
+
+		if (escape != NULL)
+			g_string_append (json, escape);
+		else
+			g_string_append_printf (json, "\\u%04x", (guint) *p);
+	}
+
+	g_string_append_len (json, start, p - start);
+	g_string_append_c (json, '"');
+}
+
+/*
+ * _gdata_parsable_json_append_member_name:
+ * @json: the string to append to
+ * @member_name: the name of the member
+ *
+ * Appends the name of an object member to @json, preceded by a comma if it isn't the first member of the object. The member's value must be
+ * appended next.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_json_append_member_name (GString *json, const gchar *member_name)
+{
+	if (json->len > 0 && json->str[json->len - 1] != '{' && json->str[json->len - 1] != '[')
+		g_string_append_c (json, ',');
+
+	_gdata_parsable_json_append_string (json, member_name);
+	g_string_append_c (json, ':');
+}
+
+/*
+ * _gdata_parsable_json_append_member_string:
+ * @json: the string to append to
+ * @member_name: the name of the member
+ * @value: (allow-none): the member's value, or %NULL
+ *
+ * Appends an object member with a string value (or <literal>null</literal>, if @value is %NULL) to @json.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_json_append_member_string (GString *json, const gchar *member_name, const gchar *value)
+{
+	_gdata_parsable_json_append_member_name (json, member_name);
+	_gdata_parsable_json_append_string (json, value);
+}
+
+/*
+ * _gdata_parsable_json_append_member_boolean:
+ * @json: the string to append to
+ * @member_name: the name of the member
+ * @value: the member's value
+ *
+ * Appends an object member with a boolean value to @json.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_json_append_member_boolean (GString *json, const gchar *member_name, gboolean value)
+{
+	_gdata_parsable_json_append_member_name (json, member_name);
+	g_string_append (json, (value == TRUE) ? "true" : "false");
+}
+
+static void append_json_node (GString *json, JsonNode *node);
+
+static void
+append_json_object_member_cb (JsonObject *object, const gchar *member_name, JsonNode *member_node, GString *json)
+{
+	_gdata_parsable_json_append_member_name (json, member_name);
+	append_json_node (json, member_node);
+}
+
+static void
+append_json_array_element_cb (JsonArray *array, guint index_, JsonNode *element_node, GString *json)
+{
+	if (index_ > 0)
+		g_string_append_c (json, ',');
+
+	append_json_node (json, element_node);
+}
+
+/* Appends an arbitrary JSON tree (such as an unhandled member's value) to @json, as JsonGenerator would */
+static void
+append_json_node (GString *json, JsonNode *node)
+{
+	switch (json_node_get_node_type (node)) {
+		case JSON_NODE_OBJECT:
+			g_string_append_c (json, '{');
+			json_object_foreach_member (json_node_get_object (node), (JsonObjectForeach) append_json_object_member_cb, json);
+			g_string_append_c (json, '}');
+			break;
+		case JSON_NODE_ARRAY:
+			g_string_append_c (json, '[');
+			json_array_foreach_element (json_node_get_array (node), (JsonArrayForeach) append_json_array_element_cb, json);
+			g_string_append_c (json, ']');
+			break;
+		case JSON_NODE_VALUE:
+			switch (json_node_get_value_type (node)) {
+				case G_TYPE_STRING:
+					_gdata_parsable_json_append_string (json, json_node_get_string (node));
+					break;
+				case G_TYPE_BOOLEAN:
+					g_string_append (json, (json_node_get_boolean (node) == TRUE) ? "true" : "false");
+					break;
+				case G_TYPE_DOUBLE: {
+					gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+					g_string_append (json, g_ascii_dtostr (buffer, sizeof (buffer), json_node_get_double (node)));
+					break;
+				}
+				case G_TYPE_INT64:
+				default:
+					g_string_append_printf (json, "%" G_GINT64_FORMAT, json_node_get_int (node));
+					break;
+			}
+			break;
+		case JSON_NODE_NULL:
+		default:
+			g_string_append (json, "null");
+			break;
+	}
+}
+
+/* Writes @self's JSON directly into a string, without building a JsonNode tree first. Returns %NULL if a class in @self's hierarchy has a get_json
+ * function but no JSON write function, in which case the JSON has to be built as a tree. See _gdata_parsable_class_set_json_write_func(). */
+static gchar *
+write_json (GDataParsable *self)
+{
+	GSList *write_funcs = NULL, *i;
+	GType type;
+	GString *json;
+
+	/* Find the write functions from the most-derived class up */
+	for (type = G_OBJECT_TYPE (self); type != GDATA_TYPE_PARSABLE; type = g_type_parent (type)) {
+		GDataParsableClass *klass = g_type_class_peek (type);
+		GDataParsableClass *parent_klass = g_type_class_peek (g_type_parent (type));
+		GDataParsableJsonWriteFunc write_func;
+
+		/* Classes which don't override get_json don't add any members */
+		if (klass->get_json == parent_klass->get_json)
+			continue;
+
+		write_func = (GDataParsableJsonWriteFunc) g_type_get_qdata (type, json_write_func_quark);
+		if (write_func == NULL) {
+			g_slist_free (write_funcs);
+			return NULL;
+		}
+
+		write_funcs = g_slist_prepend (write_funcs, write_func);
+	}
+
+	json = g_string_sized_new (512);
+	g_string_append_c (json, '{');
+
+	/* Write the members of each class, from the base class down */
+	for (i = write_funcs; i != NULL; i = i->next)
+		((GDataParsableJsonWriteFunc) i->data) (self, json);
+	g_slist_free (write_funcs);
+
+	/* Any extra JSON which we couldn't parse before? */
+	if (self->priv->extra_json != NULL) {
+		GHashTableIter iter;
+		const gchar *member_name;
+		JsonNode *value;
+
+		g_hash_table_iter_init (&iter, self->priv->extra_json);
+		while (g_hash_table_iter_next (&iter, (gpointer *) &member_name, (gpointer *) &value) == TRUE) {
+			_gdata_parsable_json_append_member_name (json, member_name);
+			append_json_node (json, value);
+		}
+	}
+
+	g_string_append_c (json, '}');
+
+	return g_string_free (json, FALSE);
+}
+
+/**
+ * gdata_parsable_get_json:
+ * @self: a #GDataParsable
+ *
+ * Builds a JSON representation of the #GDataParsable in its current state, such that it could be inserted on the server. The JSON
+ * is valid for stand-alone use.
+ *
+ * Return value: the object's JSON; free with g_free()
+ *
+ * Since: 0.15.0
+ */
+gchar *
+gdata_parsable_get_json (GDataParsable *self)
+{
+	JsonGenerator *generator;
+	JsonBuilder *builder;
+	JsonNode *root;
+	gchar *output;
+
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+
+	/* Write the JSON straight out if we can */
+	output = write_json (self);
+	if (output != NULL)
+		return output;
+
+	/* Otherwise, build the JSON tree. */
+	builder = json_builder_new ();
+	_gdata_parsable_get_json (self, builder);
+	root = json_builder_get_root (builder);
+	g_object_unref (builder);
+
+	/* Serialise it to a string. */
+	generator = json_generator_new ();
+	json_generator_set_root (generator, root);
+	output = json_generator_to_data (generator, NULL);
+	g_object_unref (generator);
+
+	json_node_free (root);
+
+	return output;
+}
+
+/*
+ * _gdata_parsable_get_json:
+ * @self: a #GDataParsable
+ * @builder: a #JsonBuilder to build the JSON in
+ *
+ * Builds a JSON representation of the #GDataParsable in its current state, such that it could be inserted on the server.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_get_json (GDataParsable *self, JsonBuilder *builder)
+{
+	GDataParsableClass *klass;
+	GHashTableIter iter;
+	gchar *member_name;
+	JsonNode *value;
+
+	g_return_if_fail (GDATA_IS_PARSABLE (self));
+	g_return_if_fail (JSON_IS_BUILDER (builder));
+
+	klass = GDATA_PARSABLE_GET_CLASS (self);
+
+	json_builder_begin_object (builder);
+
+	/* Add the JSON. */
+	if (klass->get_json != NULL)
+		klass->get_json (self, builder);
+
+	/* Any extra JSON which we couldn't parse before? */
+	if (self->priv->extra_json != NULL) {
+		g_hash_table_iter_init (&iter, self->priv->extra_json);
+		while (g_hash_table_iter_next (&iter, (gpointer *) &member_name, (gpointer *) &value) == TRUE) {
+			json_builder_set_member_name (builder, member_name);
+			json_builder_add_value (builder, json_node_copy (value)); /* transfers ownership */
+		}
+	}
+
+	json_builder_end_object (builder);
+}
+
+/* Version 1 of the variant format is a tuple of the format version, the name of the parsable's type, and its document. For XML parsables, the
+ * document is the parsable's XML tree, with each element stored as a tuple of:
+ *  - the prefix of its namespace (nothing if it has no namespace; an empty string for the default namespace);
+ *  - its local name;
+ *  - the namespaces it declares, as pairs of prefix (empty for the default namespace) and URI;
+ *  - its attributes, as triples of namespace prefix (nothing if it has no namespace), name and value; and
+ *  - its children, each of which is either another element or a string of text.
+ * For JSON parsables, the document is the parsable's JSON as serialised by json_gvariant_serialize().
+ * Loading either form builds the tree directly, rather than tokenising and validating text. Future versions of the format must continue to be
+ * accepted by gdata_parsable_new_from_variant(), so that variants stored by applications survive library upgrades. */
+#define VARIANT_FORMAT_VERSION 1
+#define VARIANT_TYPE "(usv)"
+#define VARIANT_XML_ELEMENT_TYPE "(mssa(ss)a(msss)av)"
+
+static GVariant *
+xml_node_to_variant (xmlNode *node)
+{
+	GVariantBuilder namespaces_builder, attributes_builder, children_builder;
+	xmlNs *ns;
+	xmlAttr *attr;
+	xmlNode *child;
+
+	g_variant_builder_init (&namespaces_builder, G_VARIANT_TYPE ("a(ss)"));
+	for (ns = node->nsDef; ns != NULL; ns = ns->next)
+		g_variant_builder_add (&namespaces_builder, "(ss)", (ns->prefix != NULL) ? (const gchar*) ns->prefix : "", (const gchar*) ns->href);
+
+	g_variant_builder_init (&attributes_builder, G_VARIANT_TYPE ("a(msss)"));
+	for (attr = node->properties; attr != NULL; attr = attr->next) {
+		xmlChar *value = xmlNodeListGetString (node->doc, attr->children, TRUE);
+		g_variant_builder_add (&attributes_builder, "(msss)",
+		                       (attr->ns == NULL) ? NULL : (attr->ns->prefix != NULL) ? (const gchar*) attr->ns->prefix : "",
+		                       (const gchar*) attr->name, (value != NULL) ? (const gchar*) value : "");
+		xmlFree (value);
+	}
+
+	g_variant_builder_init (&children_builder, G_VARIANT_TYPE ("av"));
+	for (child = node->children; child != NULL; child = child->next) {
+		if (child->type == XML_ELEMENT_NODE) {
+			g_variant_builder_add (&children_builder, "v", xml_node_to_variant (child));
+		} else if (child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE) {
+			g_variant_builder_add (&children_builder, "v",
+			                       g_variant_new_string ((child->content != NULL) ? (const gchar*) child->content : ""));
+		}
+		/* Comments and processing instructions are ignored when parsing, so aren't stored */
+	}
+
+	return g_variant_new (VARIANT_XML_ELEMENT_TYPE,
+	                      (node->ns == NULL) ? NULL : (node->ns->prefix != NULL) ? (const gchar*) node->ns->prefix : "",
+	                      (const gchar*) node->name, &namespaces_builder, &attributes_builder, &children_builder);
+}
+
+static xmlNode *
+variant_to_xml_node (xmlDoc *doc, xmlNode *parent, GVariant *element)
+{
+	xmlNode *node;
+	const gchar *ns_prefix, *name, *prefix, *href, *value;
+	GVariantIter *namespaces, *attributes, *children;
+	GVariant *child;
+
+	g_variant_get (element, "(m&s&sa(ss)a(msss)av)", &ns_prefix, &name, &namespaces, &attributes, &children);
+
+	node = xmlNewDocNode (doc, NULL, (const xmlChar*) name, NULL);
+	if (parent != NULL)
+		xmlAddChild (parent, node);
+	else
+		xmlDocSetRootElement (doc, node);
+
+	/* Namespaces have to be declared before they can be looked up by the element and its attributes */
+	while (g_variant_iter_next (namespaces, "(&s&s)", &prefix, &href) == TRUE)
+		xmlNewNs (node, (const xmlChar*) href, (*prefix != '\0') ? (const xmlChar*) prefix : NULL);
+
+	if (ns_prefix != NULL)
+		xmlSetNs (node, xmlSearchNs (doc, node, (*ns_prefix != '\0') ? (const xmlChar*) ns_prefix : NULL));
+
+	while (g_variant_iter_next (attributes, "(m&s&s&s)", &prefix, &name, &value) == TRUE) {
+		if (prefix != NULL)
+			xmlNewNsProp (node, xmlSearchNs (doc, node, (const xmlChar*) prefix), (const xmlChar*) name, (const xmlChar*) value);
+		else
+			xmlNewProp (node, (const xmlChar*) name, (const xmlChar*) value);
+	}
+
+	while (g_variant_iter_next (children, "v", &child) == TRUE) {
+		if (g_variant_is_of_type (child, G_VARIANT_TYPE_STRING) == TRUE)
+			xmlAddChild (node, xmlNewDocText (doc, (const xmlChar*) g_variant_get_string (child, NULL)));
+		else if (g_variant_is_of_type (child, G_VARIANT_TYPE (VARIANT_XML_ELEMENT_TYPE)) == TRUE)
+			variant_to_xml_node (doc, node, child);
+		/* Anything else is corrupt, and is ignored */
+
+		g_variant_unref (child);
+	}
+
+	g_variant_iter_free (namespaces);
+	g_variant_iter_free (attributes);
+	g_variant_iter_free (children);
+
+	return node;
+}
+
+static void
+set_variant_error (GError **error)
+{
+	g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+	             /* Translators: the parameter is an error message */
+	             _("Error parsing GVariant: %s"),
+	             /* Translators: this is a dummy error message to be substituted into "Error parsing GVariant: %s". */
+	             _("The data is not a valid serialised object."));
+}
+
+/**
+ * gdata_parsable_new_from_variant:
+ * @parsable_type: the type of the class represented by the variant
+ * @variant: a #GVariant returned by gdata_parsable_get_variant()
+ * @error: a #GError, or %NULL
+ *
+ * Creates a new #GDataParsable subclass (of the given @parsable_type) from @variant, which must have been returned by
+ * gdata_parsable_get_variant() for an object of the same type (possibly by an older version of libgdata). This is typically much faster than
+ * re-parsing the object's XML or JSON using gdata_parsable_new_from_xml() or gdata_parsable_new_from_json(), so is suitable for loading
+ * objects from a local cache.
+ *
+ * If @variant is floating, it is consumed.
+ *
+ * If @variant is not of the right format or version, or was not created for an object of type @parsable_type,
+ * %GDATA_PARSER_ERROR_PARSING_STRING will be returned. If an error occurs during parsing, a suitable error from #GDataParserError will be
+ * returned.
+ *
+ * Return value: a new #GDataParsable, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataParsable *
+gdata_parsable_new_from_variant (GType parsable_type, GVariant *variant, GError **error)
+{
+	GDataParsableClass *klass;
+	GDataParsable *parsable = NULL;
+	GVariant *document;
+	const gchar *type_name;
+	guint32 version;
+
+	g_return_val_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE), NULL);
+	g_return_val_if_fail (variant != NULL, NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	g_variant_ref_sink (variant);
+
+	if (g_variant_is_of_type (variant, G_VARIANT_TYPE (VARIANT_TYPE)) == FALSE) {
+		set_variant_error (error);
+		g_variant_unref (variant);
+		return NULL;
+	}
+
+	g_variant_get (variant, "(u&sv)", &version, &type_name, &document);
+
+	if (version != VARIANT_FORMAT_VERSION || strcmp (type_name, g_type_name (parsable_type)) != 0) {
+		set_variant_error (error);
+		goto done;
+	}
+
+	klass = g_type_class_ref (parsable_type);
+	g_assert (klass->get_content_type != NULL);
+
+	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
+		JsonNode *root;
+
+		root = json_gvariant_deserialize (document, NULL, NULL);
+		if (root == NULL || JSON_NODE_HOLDS_OBJECT (root) == FALSE)
+			set_variant_error (error);
+		else
+			parsable = _gdata_parsable_new_from_json_object (parsable_type, json_node_get_object (root), NULL, error);
+
+		if (root != NULL)
+			json_node_free (root);
+	} else if (g_variant_is_of_type (document, G_VARIANT_TYPE (VARIANT_XML_ELEMENT_TYPE)) == TRUE) {
+		xmlDoc *doc;
+		xmlNode *root;
+
+		_gdata_parsable_init_libxml ();
+
+		doc = xmlNewDoc ((const xmlChar*) "1.0");
+		root = variant_to_xml_node (doc, NULL, document);
+		parsable = _gdata_parsable_new_from_xml_node (parsable_type, doc, root, NULL, error);
+		xmlFreeDoc (doc);
+	} else {
+		set_variant_error (error);
+	}
+
+	g_type_class_unref (klass);
+
+done:
+	g_variant_unref (document);
+	g_variant_unref (variant);
+
+	return parsable;
+}
+
+/**
+ * gdata_parsable_get_variant:
+ * @self: a #GDataParsable
+ *
+ * Builds a binary representation of the #GDataParsable in its current state, including any unhandled XML or JSON and the namespaces it uses,
+ * which can be loaded again using gdata_parsable_new_from_variant(). The variant is versioned, so it can be stored (for example, using
+ * g_variant_get_data()) and loaded by later versions of libgdata.
+ *
+ * Return value: (transfer full): the object's variant, or %NULL if the object contains characters which can't be represented in XML; unref with
+ * g_variant_unref()
+ *
+ * Since: 0.15.0
+ */
+GVariant *
+gdata_parsable_get_variant (GDataParsable *self)
+{
+	GDataParsableClass *klass;
+	GVariant *document;
+
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+
+	klass = GDATA_PARSABLE_GET_CLASS (self);
+	g_assert (klass->get_content_type != NULL);
+
+	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
+		JsonBuilder *builder;
+		JsonNode *root;
+
+		builder = json_builder_new ();
+		_gdata_parsable_get_json (self, builder);
+		root = json_builder_get_root (builder);
+		g_object_unref (builder);
+
+		document = json_gvariant_serialize (root);
+		json_node_free (root);
+	} else {
+		GString *xml_string;
+		xmlDoc *doc;
+
+		/* Build the XML tree by parsing the object's XML, rather than duplicating all of the classes' get_xml() functions. This is slower than
+		 * gdata_parsable_get_xml(), but objects are typically loaded far more often than they're stored. */
+		xml_string = g_string_sized_new (1000);
+		g_string_append (xml_string, "<?xml version='1.0' encoding='UTF-8'?>");
+		_gdata_parsable_get_xml (self, xml_string, TRUE);
+
+		_gdata_parsable_init_libxml ();
+
+		/* The XML's our own, so libxml's limits on the size of untrusted documents needn't apply to it */
+		doc = _gdata_parsable_read_xml (xml_string->str, (int) xml_string->len, XML_PARSE_HUGE);
+		g_string_free (xml_string, TRUE);
+
+		if (doc == NULL || xmlDocGetRootElement (doc) == NULL) {
+			/* This can only happen if the object contains characters which aren't allowed in XML */
+			g_warning ("Error building GVariant for %s: its XML is not valid.", G_OBJECT_TYPE_NAME (self));
+			xmlFreeDoc (doc);
+			return NULL;
+		}
+
+		document = xml_node_to_variant (xmlDocGetRootElement (doc));
+		xmlFreeDoc (doc);
+	}
+
+	return g_variant_ref_sink (g_variant_new (VARIANT_TYPE, (guint32) VARIANT_FORMAT_VERSION, G_OBJECT_TYPE_NAME (self), document));
+}
+
+/* Clones @self by serialising and re-parsing it, for classes which don't have a clone function */
+static GDataParsable *
+clone_by_reparsing (GDataParsable *self)
+{
+	GDataParsableClass *klass;
+	GDataParsable *clone;
+	GError *error = NULL;
+
+	klass = GDATA_PARSABLE_GET_CLASS (self);
+	g_assert (klass->get_content_type != NULL);
+
+	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
+		gchar *json = gdata_parsable_get_json (self);
+		clone = _gdata_parsable_new_from_json (G_OBJECT_TYPE (self), json, -1, NULL, &error);
+		g_free (json);
+	} else {
+		GString *xml_string = g_string_sized_new (1000);
+		_gdata_parsable_get_xml (self, xml_string, TRUE);
+		clone = _gdata_parsable_new_from_xml (G_OBJECT_TYPE (self), xml_string->str, (gint) xml_string->len, NULL, &error);
+		g_string_free (xml_string, TRUE);
+	}
+
+	if (clone == NULL) {
+		/* This can only happen if the object contains characters which aren't allowed in XML */
+		g_warning ("Error cloning %s: %s", G_OBJECT_TYPE_NAME (self), error->message);
+		g_error_free (error);
+	}
+
+	return clone;
+}
+
+/* Returns the readable properties of @klass, as a %NULL-terminated array which is cached for the lifetime of the process */
+static GParamSpec * const *
+get_readable_properties (GObjectClass *klass)
+{
+	GType type = G_TYPE_FROM_CLASS (klass);
+	GParamSpec **readable_properties;
+
+	readable_properties = g_type_get_qdata (type, readable_properties_quark);
+
+	if (readable_properties != NULL)
+		return (GParamSpec * const *) readable_properties;
+
+	G_LOCK (readable_properties);
+
+	/* Check again, in case another thread got here first */
+	readable_properties = g_type_get_qdata (type, readable_properties_quark);
+
+	if (readable_properties == NULL) {
+		GParamSpec **properties;
+		guint n_properties, i, j;
+
+		properties = g_object_class_list_properties (klass, &n_properties);
+		readable_properties = g_new (GParamSpec*, n_properties + 1);
+
+		for (i = 0, j = 0; i < n_properties; i++) {
+			if ((properties[i]->flags & G_PARAM_READABLE) != 0)
+				readable_properties[j++] = properties[i];
+		}
+
+		readable_properties[j] = NULL;
+		g_free (properties);
+
+		g_type_set_qdata (type, readable_properties_quark, readable_properties);
+	}
+
+	G_UNLOCK (readable_properties);
+
+	return (GParamSpec * const *) readable_properties;
+}
+
+static GVariant *dup_properties (GDataParsable *self, const gchar * const *property_names);
+
+/* Converts @value to a floating #GVariant, or returns %NULL if it's %NULL or of a type which can't be represented */
+static GVariant *
+value_to_variant (const GValue *value)
+{
+	GType type = G_VALUE_TYPE (value);
+
+	switch (G_TYPE_FUNDAMENTAL (type)) {
+		case G_TYPE_BOOLEAN:
+			return g_variant_new_boolean (g_value_get_boolean (value));
+		case G_TYPE_CHAR:
+			return g_variant_new_byte ((guchar) g_value_get_schar (value));
+		case G_TYPE_UCHAR:
+			return g_variant_new_byte (g_value_get_uchar (value));
+		case G_TYPE_INT:
+			return g_variant_new_int32 (g_value_get_int (value));
+		case G_TYPE_UINT:
+			return g_variant_new_uint32 (g_value_get_uint (value));
+		case G_TYPE_LONG:
+			return g_variant_new_int64 (g_value_get_long (value));
+		case G_TYPE_ULONG:
+			return g_variant_new_uint64 (g_value_get_ulong (value));
+		case G_TYPE_INT64:
+			return g_variant_new_int64 (g_value_get_int64 (value));
+		case G_TYPE_UINT64:
+			return g_variant_new_uint64 (g_value_get_uint64 (value));
+		case G_TYPE_FLOAT:
+			return g_variant_new_double (g_value_get_float (value));
+		case G_TYPE_DOUBLE:
+			return g_variant_new_double (g_value_get_double (value));
+		case G_TYPE_ENUM:
+			return g_variant_new_int32 (g_value_get_enum (value));
+		case G_TYPE_FLAGS:
+			return g_variant_new_uint32 (g_value_get_flags (value));
+		case G_TYPE_STRING:
+			return (g_value_get_string (value) != NULL) ? g_variant_new_string (g_value_get_string (value)) : NULL;
+		case G_TYPE_VARIANT:
+			return (g_value_get_variant (value) != NULL) ? g_variant_new_variant (g_value_get_variant (value)) : NULL;
+		case G_TYPE_BOXED:
+			if (type == G_TYPE_STRV && g_value_get_boxed (value) != NULL)
+				return g_variant_new_strv (g_value_get_boxed (value), -1);
+			return NULL;
+		case G_TYPE_OBJECT:
+			if (GDATA_IS_PARSABLE (g_value_get_object (value)) == TRUE)
+				return dup_properties (GDATA_PARSABLE (g_value_get_object (value)), NULL);
+			return NULL;
+		default:
+			return NULL;
+	}
+}
+
+/* Builds a floating a{sv} of the given properties of @self, or all its readable properties if @property_names is %NULL */
+static GVariant *
+dup_properties (GDataParsable *self, const gchar * const *property_names)
+{
+	GObjectClass *klass = G_OBJECT_GET_CLASS (self);
+	GVariantBuilder builder;
+	GValue value = G_VALUE_INIT;
+	guint i;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+
+	for (i = 0; ; i++) {
+		GParamSpec *pspec;
+		GVariant *variant;
+
+		if (property_names != NULL) {
+			if (property_names[i] == NULL)
+				break;
+
+			pspec = g_object_class_find_property (klass, property_names[i]);
+			if (pspec == NULL || (pspec->flags & G_PARAM_READABLE) == 0) {
+				g_warning ("%s: object class '%s' has no readable property named '%s'", G_STRFUNC, G_OBJECT_TYPE_NAME (self),
+				           property_names[i]);
+				continue;
+			}
+		} else {
+			pspec = get_readable_properties (klass)[i];
+			if (pspec == NULL)
+				break;
+		}
+
+		g_value_init (&value, pspec->value_type);
+		g_object_get_property (G_OBJECT (self), pspec->name, &value);
+
+		variant = value_to_variant (&value);
+		if (variant != NULL)
+			g_variant_builder_add (&builder, "{sv}", pspec->name, variant);
+
+		g_value_unset (&value);
+	}
+
+	return g_variant_builder_end (&builder);
+}
+
+/**
+ * gdata_parsable_dup_properties:
+ * @self: a #GDataParsable
+ * @property_names: (array zero-terminated=1) (allow-none): a %NULL-terminated array of the names of the properties to get, or %NULL to get
+ * all of them
+ *
+ * Gets the values of several properties of @self at once, as a dictionary mapping each property's name to its value. This is equivalent to calling
+ * g_object_get() for each property, but is much cheaper for language bindings, which can read all the fields they need from an object with a
+ * single call rather than one per field.
+ *
+ * Property values are converted as follows: booleans to <code class="literal">b</code>; signed and unsigned integers to <code class="literal">i</code>
+ * and <code class="literal">u</code> (or <code class="literal">x</code> and <code class="literal">t</code> for 64-bit and long types), with enums
+ * and flags given as their numeric values; floating point numbers to <code class="literal">d</code>; strings to <code class="literal">s</code>;
+ * string arrays to <code class="literal">as</code>; and #GDataParsable<!-- -->s (such as a #GDataContactsContact's #GDataContactsContact:name) to
+ * nested dictionaries of all their properties. Properties which are unset (such as %NULL
+ * strings), and properties of other types, are omitted from the dictionary.
+ *
+ * If any of @property_names aren't readable properties of @self, a warning is printed and they're omitted.
+ *
+ * Return value: (transfer full): a dictionary of type <code class="literal">a{sv}</code> mapping property names to their values; unref with
+ * g_variant_unref()
+ *
+ * Since: 0.15.0
+ */
+GVariant *
+gdata_parsable_dup_properties (GDataParsable *self, const gchar * const *property_names)
+{
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+
+	return g_variant_ref_sink (dup_properties (self, property_names));
+}
+
+static void
+copy_extra_namespace_cb (const gchar *prefix, const gchar *href, GHashTable *namespaces)
+{
+	g_hash_table_insert (namespaces, g_strdup (prefix), g_strdup (href));
+}
+
+static void
+copy_extra_json_cb (const gchar *member_name, JsonNode *value, GHashTable *extra_json)
+{
+	g_hash_table_insert (extra_json, g_strdup (member_name), _json_node_share (value));
+}
+
+/**
+ * gdata_parsable_clone:
+ * @self: a #GDataParsable
+ *
+ * Creates a copy of @self, of the same type and with the same properties, which can then be modified without affecting @self (for example, to keep
+ * the original for detecting conflicts when updating it). Child objects, such as the links of a #GDataEntry, are cloned as well.
+ *
+ * This is the equivalent of building the XML or JSON for @self and parsing it again, but most classes copy their state directly, which is much
+ * faster. Unhandled JSON members are shared between @self and the clone rather than being copied, since they're never modified.
+ *
+ * Return value: (transfer full): a clone of @self, or %NULL if @self contains characters which can't be represented in XML; unref with
+ * g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataParsable *
+gdata_parsable_clone (GDataParsable *self)
+{
+	GDataParsablePrivate *priv, *clone_priv;
+	GDataParsable *clone;
+	GSList *clone_funcs = NULL, *i;
+	GType type;
+
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), NULL);
+
+	/* Find the clone functions from the most-derived class up; if any class doesn't have one, it might have state which we don't know how to
+	 * copy, so fall back to re-parsing */
+	for (type = G_OBJECT_TYPE (self); type != GDATA_TYPE_PARSABLE; type = g_type_parent (type)) {
+		GDataParsableCloneFunc clone_func = (GDataParsableCloneFunc) g_type_get_qdata (type, clone_func_quark);
+
+		if (clone_func == NULL) {
+			g_slist_free (clone_funcs);
+			return clone_by_reparsing (self);
+		}
+
+		clone_funcs = g_slist_prepend (clone_funcs, clone_func);
+	}
+
+	priv = self->priv;
+	if (priv->constructed_from_xml == TRUE)
+		clone = new_constructed_from_xml (G_OBJECT_TYPE (self));
+	else
+		clone = g_object_new (G_OBJECT_TYPE (self), NULL);
+	clone_priv = clone->priv;
+	clone_priv->parsing = FALSE;
+
+	/* Copy the unhandled XML and JSON */
+	if (priv->extra_xml != NULL)
+		clone_priv->extra_xml = g_string_new_len (priv->extra_xml->str, priv->extra_xml->len);
+	if (priv->extra_namespaces != NULL) {
+		clone_priv->extra_namespaces = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		g_hash_table_foreach (priv->extra_namespaces, (GHFunc) copy_extra_namespace_cb, clone_priv->extra_namespaces);
+	}
+	if (priv->extra_doc != NULL)
+		clone_priv->extra_doc = xmlCopyDoc (priv->extra_doc, 1);
+	if (priv->extra_json != NULL) {
+		clone_priv->extra_json = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) json_node_free);
+		g_hash_table_foreach (priv->extra_json, (GHFunc) copy_extra_json_cb, clone_priv->extra_json);
+	}
+
+	/* Copy the state of each class, from the base class down */
+	for (i = clone_funcs; i != NULL; i = i->next)
+		((GDataParsableCloneFunc) i->data) (self, clone);
+	g_slist_free (clone_funcs);
+
+	/* The clone functions set the clone's members directly, so it won't have been measured since it was constructed */
+	if (clone_priv->accounted == TRUE)
+		update_accounts (clone, FALSE);
+
+	return clone;
+}
+
+/*
+ * _gdata_parsable_is_constructed_from_xml:
+ * @self: a #GDataParsable
+ *
+ * Returns the value of #GDataParsable:constructed-from-xml.
+ *
+ * Return value: %TRUE if the #GDataParsable was constructed from XML, %FALSE otherwise
+ *
+ * Since: 0.7.0
+ */
+gboolean
+_gdata_parsable_is_constructed_from_xml (GDataParsable *self)
+{
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), FALSE);
+	return self->priv->constructed_from_xml;
+}
+
+/*
+ * _gdata_parsable_is_parsing:
+ * @self: a #GDataParsable
+ *
+ * Returns whether @self is still being built from XML or JSON: that is, whether it was constructed from XML and its post-parse function hasn't yet
+ * returned. Property changes made while parsing reflect the server's copy of the object, rather than local modifications.
+ *
+ * Return value: %TRUE if the #GDataParsable is being parsed, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_parsable_is_parsing (GDataParsable *self)
+{
+	g_return_val_if_fail (GDATA_IS_PARSABLE (self), FALSE);
+	return self->priv->parsing;
+}
+
+/* Keys longer than this aren't worth looking up, since elements that large are unlikely to be repeated */
+#define MAX_FLYWEIGHT_KEY_LENGTH 1024
+
+/*
+ * _gdata_parsable_class_set_shareable:
+ * @klass: a #GDataParsableClass
+ *
+ * Marks instances of @klass (but not of its subclasses) as being simple values, identified entirely by the XML they're parsed from, so that one
+ * instance can be shared between all the parents in a document which contain identical elements; see _gdata_parsable_new_shared_from_xml_node().
+ * This should be called from the class' class_init function.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_class_set_shareable (GDataParsableClass *klass)
+{
+	g_return_if_fail (GDATA_IS_PARSABLE_CLASS (klass));
+	g_type_set_qdata (G_TYPE_FROM_CLASS (klass), shareable_quark, GINT_TO_POINTER (TRUE));
+}
+
+/*
+ * _gdata_parsable_set_flyweights:
+ * @flyweights: (allow-none): a table to hold the parsables shared while parsing, or %NULL
+ *
+ * Sets the table used by _gdata_parsable_new_shared_from_xml_node() in this thread. @flyweights should have been created with
+ * g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref), and should only be used for a single document, since the keys refer to
+ * the XML's content but not its context. If @flyweights is %NULL, parsables aren't shared.
+ *
+ * Return value: (transfer none): the previous table, which should be restored once parsing's finished
+ *
+ * Since: 0.15.0
+ */
+GHashTable *
+_gdata_parsable_set_flyweights (GHashTable *flyweights)
+{
+	GHashTable *previous_flyweights;
+
+	previous_flyweights = g_private_get (&flyweights_table);
+	g_private_set (&flyweights_table, flyweights);
+
+	return previous_flyweights;
+}
+
+/* Builds a key for @node which is equal to that of any other node with the same name, namespace, attributes and descendants. Returns %FALSE if
+ * @node contains anything which can't be compared this way, or is too large to be worth sharing. The separators are control characters, which
+ * can't appear in XML 1.0 content. */
+static gboolean
+append_flyweight_key (GString *key, xmlNode *node)
+{
+	xmlAttr *attr;
+	xmlNode *child;
+
+	g_string_append (key, (const gchar*) node->name);
+	g_string_append_c (key, '\x1f');
+	if (node->ns != NULL) {
+		if (node->ns->prefix != NULL)
+			g_string_append (key, (const gchar*) node->ns->prefix);
+		g_string_append_c (key, '\x1f');
+		g_string_append (key, (const gchar*) node->ns->href);
+	}
+
+	for (attr = node->properties; attr != NULL; attr = attr->next) {
+		/* Only plain attributes whose value is a single text node */
+		if (attr->ns != NULL || attr->children == NULL || attr->children->type != XML_TEXT_NODE || attr->children->next != NULL)
+			return FALSE;
+
+		g_string_append_c (key, '\x1e');
+		g_string_append (key, (const gchar*) attr->name);
+		g_string_append_c (key, '=');
+		g_string_append (key, (const gchar*) attr->children->content);
+	}
+
+	for (child = node->children; child != NULL; child = child->next) {
+		if (key->len > MAX_FLYWEIGHT_KEY_LENGTH)
+			return FALSE;
+
+		switch (child->type) {
+			case XML_ELEMENT_NODE:
+				g_string_append_c (key, '\x1d');
+				if (append_flyweight_key (key, child) == FALSE)
+					return FALSE;
+				break;
+			case XML_TEXT_NODE:
+			case XML_CDATA_SECTION_NODE:
+				g_string_append_c (key, '\x1c');
+				g_string_append (key, (const gchar*) child->content);
+				break;
+			default:
+				/* Comments, entity references, etc. */
+				return FALSE;
+		}
+	}
+
+	g_string_append_c (key, '\x1b');
+
+	return key->len <= MAX_FLYWEIGHT_KEY_LENGTH;
+}
+
+/*
+ * _gdata_parsable_new_shared_from_xml_node:
+ * @parsable_type: the type of the parsable to build
+ * @doc: the document containing @node
+ * @node: the element to parse
+ * @error: a #GError, or %NULL
+ *
+ * Equivalent to _gdata_parsable_new_from_xml_node(), but if a flyweights table has been set for this thread (see _gdata_parsable_set_flyweights())
+ * and @parsable_type is shareable (see _gdata_parsable_class_set_shareable()), a parsable built from an identical element earlier in the document
+ * is returned instead of a new one, if there is one. This saves building and keeping many copies of elements which are repeated in every entry of
+ * a feed, such as categories and authors.
+ *
+ * Shared parsables must never be modified, since their other parents would see the changes. Parents must pass their lists of child parsables
+ * through _gdata_parsable_unshare_list() before giving them out.
+ *
+ * Return value: (transfer full): a new reference to the parsable, or %NULL on error
+ *
+ * Since: 0.15.0
+ */
+GDataParsable *
+_gdata_parsable_new_shared_from_xml_node (GType parsable_type, xmlDoc *doc, xmlNode *node, GError **error)
+{
+	GHashTable *flyweights;
+	GDataParsable *parsable;
+	GString *key;
+
+	flyweights = g_private_get (&flyweights_table);
+	if (flyweights == NULL || g_type_get_qdata (parsable_type, shareable_quark) == NULL)
+		return _gdata_parsable_new_from_xml_node (parsable_type, doc, node, NULL, error);
+
+	/* The key has to be built before parsing, since the parser may steal the element's content */
+	key = g_string_sized_new (128);
+	g_string_append (key, g_type_name (parsable_type));
+	g_string_append_c (key, '\x1f');
+
+	if (append_flyweight_key (key, node) == FALSE) {
+		g_string_free (key, TRUE);
+		return _gdata_parsable_new_from_xml_node (parsable_type, doc, node, NULL, error);
+	}
+
+	parsable = g_hash_table_lookup (flyweights, key->str);
+	if (parsable != NULL) {
+		g_string_free (key, TRUE);
+		return g_object_ref (parsable);
+	}
+
+	parsable = _gdata_parsable_new_from_xml_node (parsable_type, doc, node, NULL, error);
+
+	/* Parsables holding unhandled XML can modify themselves when it's output (see GDATA_UNHANDLED_XML_LAZY), so can't be shared */
+	if (parsable != NULL && parsable->priv->extra_xml == NULL && parsable->priv->extra_doc == NULL && parsable->priv->extra_namespaces == NULL) {
+		parsable->priv->shared = TRUE;
+
+		/* It's never modified, so needn't refer to the original XML of the parent it happened to be parsed as part of (which would keep
+		 * that alive for as long as any of the other parents) */
+		if (parsable->priv->original_xml != NULL) {
+			original_xml_unref (parsable->priv->original_xml);
+			parsable->priv->original_xml = NULL;
+		}
+
+		g_hash_table_insert (flyweights, g_string_free (key, FALSE), g_object_ref (parsable));
+	} else {
+		g_string_free (key, TRUE);
+	}
+
+	return parsable;
+}
+
+/*
+ * _gdata_parsable_unshare_list:
+ * @owner: the #GDataParsable which owns @parsables
+ * @parsables: (element-type GDataParsable): a list of @owner's child parsables
+ *
+ * Replaces each shared parsable in @parsables (see _gdata_parsable_new_shared_from_xml_node()) with a private copy, in place, so that it can safely
+ * be modified. This must be called on any list of possibly-shared children before they're given out by @owner. The copies count as part of
+ * @owner's original XML, so modifying them invalidates it.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_parsable_unshare_list (GDataParsable *owner, GList *parsables)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_PARSABLE (owner));
+
+	for (i = parsables; i != NULL; i = i->next) {
+		GDataParsable *parsable = i->data, *copy;
+
+		if (parsable->priv->shared == FALSE)
+			continue;
+
+		copy = gdata_parsable_clone (parsable);
+
+		if (copy->priv->original_xml != NULL)
+			original_xml_unref (copy->priv->original_xml);
+		copy->priv->original_xml = (owner->priv->original_xml != NULL) ? original_xml_ref (owner->priv->original_xml) : NULL;
+
+		i->data = copy;
+		g_object_unref (parsable);
+	}
+}
+
+static void
+measure_extra_namespace_cb (const gchar *prefix, const gchar *href, gsize *n_bytes)
+{
+	*n_bytes += strlen (prefix) + strlen (href) + 2;
+}
+
+/* Approximates the number of bytes of memory owned by @self: the instance itself, its string properties and its unhandled XML. Child parsables (such
+ * as an entry's authors) aren't included, since they're accounted as instances of their own types. */
+static gsize
+measure_parsable (GDataParsable *self)
+{
+	GDataParsablePrivate *priv = self->priv;
+	GTypeQuery query;
+	GParamSpec **pspecs;
+	guint i, n_pspecs;
+	gsize n_bytes;
+
+	g_type_query (G_OBJECT_TYPE (self), &query);
+	n_bytes = query.instance_size + sizeof (GDataParsablePrivate);
+
+	pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (self), &n_pspecs);
+
+	for (i = 0; i < n_pspecs; i++) {
+		GValue value = G_VALUE_INIT;
+
+		if ((pspecs[i]->flags & G_PARAM_READABLE) == 0 ||
+		    (pspecs[i]->value_type != G_TYPE_STRING && pspecs[i]->value_type != G_TYPE_STRV)) {
+			continue;
+		}
+
+		g_value_init (&value, pspecs[i]->value_type);
+		g_object_get_property (G_OBJECT (self), pspecs[i]->name, &value);
+
+		if (pspecs[i]->value_type == G_TYPE_STRING) {
+			const gchar *str = g_value_get_string (&value);
+
+			if (str != NULL)
+				n_bytes += strlen (str) + 1;
+		} else {
+			const gchar * const *strv = g_value_get_boxed (&value);
+
+			for (; strv != NULL && *strv != NULL; strv++)
+				n_bytes += sizeof (gchar*) + strlen (*strv) + 1;
+		}
+
+		g_value_unset (&value);
+	}
+
+	g_free (pspecs);
+
+	if (priv->extra_xml != NULL)
+		n_bytes += sizeof (GString) + priv->extra_xml->allocated_len;
+	if (priv->extra_namespaces != NULL)
+		g_hash_table_foreach (priv->extra_namespaces, (GHFunc) measure_extra_namespace_cb, &n_bytes);
+
+	return n_bytes;
+}
+
+/* Approximates the number of bytes of memory owned by @self, as for memory accounting; used to size caches of parsables */
+gsize
+_gdata_parsable_measure (GDataParsable *self)
+{
+	return measure_parsable (self);
+}
+
+/* Re-measures @self and updates the accounts for its type to match. If @is_new is %TRUE, @self is also added to the count of its type's instances. */
+static void
+update_accounts (GDataParsable *self, gboolean is_new)
+{
+	GDataParsablePrivate *priv = self->priv;
+	TypeAccount *account;
+	gsize n_bytes;
+
+	n_bytes = measure_parsable (self);
+
+	G_LOCK (accounts);
+
+	if (type_accounts == NULL)
+		type_accounts = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+
+	account = g_hash_table_lookup (type_accounts, GSIZE_TO_POINTER (G_OBJECT_TYPE (self)));
+	if (account == NULL) {
+		account = g_new0 (TypeAccount, 1);
+		g_hash_table_insert (type_accounts, GSIZE_TO_POINTER (G_OBJECT_TYPE (self)), account);
+	}
+
+	if (is_new == TRUE)
+		account->n_instances++;
+	account->n_bytes = account->n_bytes - priv->accounted_bytes + n_bytes;
+	priv->accounted_bytes = n_bytes;
+
+	G_UNLOCK (accounts);
+}
+
+/**
+ * gdata_parsable_set_accounting_enabled:
+ * @enabled: %TRUE to enable memory accounting, %FALSE to disable it
+ *
+ * Enables or disables memory accounting for all #GDataParsables in the process. While it's enabled, the number of live instances of each
+ * #GDataParsable subclass, and the approximate amount of memory they retain, is tracked, and can be retrieved using gdata_parsable_get_accounts()
+ * or gdata_parsable_dup_accounts(). This can be used to size caches of entries, or to find leaks.
+ *
+ * The memory retained by a parsable is taken to be the size of the instance, plus its string properties and any unhandled XML it's preserving.
+ * Child parsables, such as the #GDataAuthors of a #GDataEntry, are accounted as instances of their own types rather than as part of their parent.
+ * The size is updated whenever one of the parsable's properties changes.
+ *
+ * Only parsables constructed while accounting is enabled are accounted, and they stay in the accounts until they're finalized even if
+ * accounting is disabled in the meantime. Accounting is disabled by default, since measuring each parsable has a noticeable cost.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parsable_set_accounting_enabled (gboolean enabled)
+{
+	g_atomic_int_set (&accounting_enabled, (enabled == TRUE) ? TRUE : FALSE);
+}
+
+/**
+ * gdata_parsable_get_accounting_enabled:
+ *
+ * Gets whether memory accounting is enabled. See gdata_parsable_set_accounting_enabled().
+ *
+ * Return value: %TRUE if memory accounting is enabled, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_parsable_get_accounting_enabled (void)
+{
+	return g_atomic_int_get (&accounting_enabled);
+}
+
+/**
+ * gdata_parsable_get_accounts:
+ * @parsable_type: the type of parsable to get the accounts for
+ * @n_instances: (out caller-allocates) (allow-none): return location for the number of live instances of @parsable_type, or %NULL
+ * @n_bytes: (out caller-allocates) (allow-none): return location for the approximate number of bytes retained by the instances, or %NULL
+ *
+ * Gets the number of live instances of @parsable_type which have been accounted, and the approximate amount of memory they retain. Instances of
+ * subclasses of @parsable_type aren't included. See gdata_parsable_set_accounting_enabled().
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parsable_get_accounts (GType parsable_type, guint *n_instances, gsize *n_bytes)
+{
+	TypeAccount *account = NULL;
+
+	g_return_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE) == TRUE);
+
+	G_LOCK (accounts);
+
+	if (type_accounts != NULL)
+		account = g_hash_table_lookup (type_accounts, GSIZE_TO_POINTER (parsable_type));
+
+	if (n_instances != NULL)
+		*n_instances = (account != NULL) ? account->n_instances : 0;
+	if (n_bytes != NULL)
+		*n_bytes = (account != NULL) ? account->n_bytes : 0;
+
+	G_UNLOCK (accounts);
+}
+
+/**
+ * gdata_parsable_dup_accounts:
+ *
+ * Gets a snapshot of the accounts of all types of #GDataParsable which have had instances accounted, in a form which can easily be exported to
+ * a metrics system. The returned #GVariant has type <literal>a{s(ut)}</literal>, mapping the name of each type to its number of live instances
+ * and the approximate number of bytes they retain, as returned by gdata_parsable_get_accounts(). See gdata_parsable_set_accounting_enabled().
+ *
+ * Return value: (transfer full): the accounts; unref with g_variant_unref()
+ *
+ * Since: 0.15.0
+ */
+GVariant *
+gdata_parsable_dup_accounts (void)
+{
+	GVariantBuilder builder;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{s(ut)}"));
+
+	G_LOCK (accounts);
+
+	if (type_accounts != NULL) {
+		GHashTableIter iter;
+		gpointer type;
+		TypeAccount *account;
+
+		g_hash_table_iter_init (&iter, type_accounts);
+		while (g_hash_table_iter_next (&iter, &type, (gpointer*) &account) == TRUE) {
+			g_variant_builder_add (&builder, "{s(ut)}", g_type_name (GPOINTER_TO_SIZE (type)), account->n_instances,
+			                       (guint64) account->n_bytes);
+		}
+	}
+
+	G_UNLOCK (accounts);
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/**
+ * gdata_parsable_set_profiling_enabled:
+ * @enabled: %TRUE to enable parse profiling, %FALSE to disable it
+ *
+ * Enables or disables parse profiling for all #GDataParsables in the process. While it's enabled, each call to a parsable's
+ * <function>parse_xml</function> class function for one of its child nodes is timed, and the number of parsables it constructs is counted. The
+ * results are accumulated for each pair of parsable type and child element name, and can be retrieved using gdata_parsable_dup_profile(), to find
+ * out which elements are the most expensive to parse.
+ *
+ * The measurements for an element include those of any parsables constructed from it, so the time spent parsing a #GDataEntry's
+ * <literal>author</literal> elements includes the time spent parsing their <literal>name</literal> elements as #GDataAuthor children. Parsing JSON
+ * isn't profiled.
+ *
+ * Profiling is disabled by default, since it slows parsing down noticeably.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parsable_set_profiling_enabled (gboolean enabled)
+{
+	g_atomic_int_set (&profiling_enabled, (enabled == TRUE) ? TRUE : FALSE);
+}
+
+/**
+ * gdata_parsable_get_profiling_enabled:
+ *
+ * Gets whether parse profiling is enabled. See gdata_parsable_set_profiling_enabled().
+ *
+ * Return value: %TRUE if parse profiling is enabled, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_parsable_get_profiling_enabled (void)
+{
+	return g_atomic_int_get (&profiling_enabled);
+}
+
+/**
+ * gdata_parsable_dup_profile:
+ *
+ * Gets a snapshot of the parse profile accumulated since profiling was enabled (or since the profile was last reset with
+ * gdata_parsable_reset_profile()). The returned #GVariant has type <literal>a(ssutt)</literal>: an array with one element for each pair of parsable
+ * type and child node which has been parsed, giving the name of the type, the name of the child element (with its namespace prefix, as in
+ * <literal>gd:who</literal>, or the node type prefixed with ‘#’, as in <literal>#text</literal>, for other nodes), the number of times it was
+ * parsed, the total time spent parsing it in microseconds, and the total number of parsables constructed while parsing it. The array isn't in
+ * any particular order. See gdata_parsable_set_profiling_enabled().
+ *
+ * Return value: (transfer full): the profile; unref with g_variant_unref()
+ *
+ * Since: 0.15.0
+ */
+GVariant *
+gdata_parsable_dup_profile (void)
+{
+	GVariantBuilder builder;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ssutt)"));
+
+	G_LOCK (profiles);
+
+	if (element_profiles != NULL) {
+		GHashTableIter iter;
+		ElementProfile *profile;
+
+		g_hash_table_iter_init (&iter, element_profiles);
+		while (g_hash_table_iter_next (&iter, (gpointer*) &profile, NULL) == TRUE) {
+			g_variant_builder_add (&builder, "(ssutt)", g_type_name (profile->type), profile->element_name, profile->n_calls,
+			                       profile->n_microseconds, profile->n_parsables);
+		}
+	}
+
+	G_UNLOCK (profiles);
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/**
+ * gdata_parsable_reset_profile:
+ *
+ * Discards the parse profile accumulated so far, so that gdata_parsable_dup_profile() only covers parsing done from now on. This doesn't enable or
+ * disable profiling. See gdata_parsable_set_profiling_enabled().
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parsable_reset_profile (void)
+{
+	G_LOCK (profiles);
+
+	if (element_profiles != NULL)
+		g_hash_table_remove_all (element_profiles);
+
+	G_UNLOCK (profiles);
 }
@@ -39,6 +39,24 @@ typedef enum {
 	GDATA_PARSER_ERROR_EMPTY_DOCUMENT
 } GDataParserError;
 
+/**
+ * GDataUnhandledXmlMode:
+ * @GDATA_UNHANDLED_XML_KEEP: serialise unhandled XML as soon as it's parsed, so that it's preserved by gdata_parsable_get_xml()
+ * @GDATA_UNHANDLED_XML_LAZY: keep a copy of the unhandled XML nodes, and only serialise them when gdata_parsable_get_xml() is called
+ * @GDATA_UNHANDLED_XML_DISCARD: drop unhandled XML entirely; it won't be preserved by gdata_parsable_get_xml()
+ *
+ * Modes for handling XML elements which aren't understood by a #GDataParsable when it's parsed. Keeping unhandled XML means it isn't lost if the
+ * parsable is later sent back to the server, but costs time and memory; applications which only ever read the results of a query may prefer to
+ * discard it.
+ *
+ * Since: 0.15.0
+ **/
+typedef enum {
+	GDATA_UNHANDLED_XML_KEEP = 0,
+	GDATA_UNHANDLED_XML_LAZY,
+	GDATA_UNHANDLED_XML_DISCARD
+} GDataUnhandledXmlMode;
+
 #define GDATA_PARSER_ERROR gdata_parser_error_quark ()
 GQuark gdata_parser_error_quark (void) G_GNUC_CONST;
 
@@ -117,6 +135,22 @@ GDataParsable *gdata_parsable_new_from_json (GType parsable_type, const gchar *j
                                              GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 gchar *gdata_parsable_get_json (GDataParsable *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
+GDataParsable *gdata_parsable_new_from_variant (GType parsable_type, GVariant *variant, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GVariant *gdata_parsable_get_variant (GDataParsable *self) G_GNUC_WARN_UNUSED_RESULT;
+
+GDataParsable *gdata_parsable_clone (GDataParsable *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GVariant *gdata_parsable_dup_properties (GDataParsable *self, const gchar * const *property_names) G_GNUC_WARN_UNUSED_RESULT;
+
+void gdata_parsable_set_accounting_enabled (gboolean enabled);
+gboolean gdata_parsable_get_accounting_enabled (void);
+void gdata_parsable_get_accounts (GType parsable_type, guint *n_instances, gsize *n_bytes);
+GVariant *gdata_parsable_dup_accounts (void) G_GNUC_WARN_UNUSED_RESULT;
+
+void gdata_parsable_set_profiling_enabled (gboolean enabled);
+gboolean gdata_parsable_get_profiling_enabled (void);
+GVariant *gdata_parsable_dup_profile (void) G_GNUC_WARN_UNUSED_RESULT;
+void gdata_parsable_reset_profile (void);
+
 G_END_DECLS
 
 #endif /* !GDATA_PARSABLE_H */
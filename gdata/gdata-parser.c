@@ -203,16 +203,184 @@ gdata_parser_error_duplicate_element (xmlNode *element, GError **error)
 	return FALSE;
 }
 
+/* Returns the number of days between 1970-01-01 and the given date in the proleptic Gregorian calendar. @month is 1–12. */
+static gint64
+days_from_civil (gint64 year, guint month, guint day)
+{
+	gint64 era, year_of_era, day_of_year, day_of_era;
+
+	/* Count years from March, so that the leap day falls at the end of the year */
+	year -= (month <= 2) ? 1 : 0;
+	era = ((year >= 0) ? year : year - 399) / 400;
+	year_of_era = year - era * 400;
+	day_of_year = (153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5 + day - 1;
+	day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+	return era * 146097 + day_of_era - 719468;
+}
+
+/* The inverse of days_from_civil() */
+static void
+civil_from_days (gint64 days, gint64 *year, guint *month, guint *day)
+{
+	gint64 era, day_of_era, year_of_era, day_of_year, month_index;
+
+	days += 719468;
+	era = ((days >= 0) ? days : days - 146096) / 146097;
+	day_of_era = days - era * 146097;
+	year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+	day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+	month_index = (5 * day_of_year + 2) / 153;
+
+	*day = day_of_year - (153 * month_index + 2) / 5 + 1;
+	*month = month_index + ((month_index < 10) ? 3 : -9);
+	*year = year_of_era + era * 400 + ((*month <= 2) ? 1 : 0);
+}
+
+static guint
+days_in_month (gint64 year, guint month)
+{
+	static const guint8 days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+
+	if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))
+		return 29;
+
+	return days[month - 1];
+}
+
+/* Parses @n_digits decimal digits from @str into @value. Returns %FALSE if any of them aren't digits. */
+static inline gboolean
+parse_digits (const gchar *str, guint n_digits, guint *value)
+{
+	guint i;
+
+	*value = 0;
+	for (i = 0; i < n_digits; i++) {
+		if (g_ascii_isdigit (str[i]) == FALSE)
+			return FALSE;
+		*value = *value * 10 + (str[i] - '0');
+	}
+
+	return TRUE;
+}
+
+static inline gchar *
+format_digits (gchar *buffer, guint value, guint n_digits)
+{
+	guint i;
+
+	for (i = n_digits; i > 0; i--) {
+		buffer[i - 1] = '0' + value % 10;
+		value /= 10;
+	}
+
+	return buffer + n_digits;
+}
+
+/* Parses a date in the form YYYY-MM-DD or YYYYMMDD, returning the end of the date in @end. Returns %FALSE if @date isn't in either form, or the
+ * date is invalid. */
+static gboolean
+parse_date (const gchar *date, gint64 *_days, const gchar **end)
+{
+	guint year, month, day;
+	gboolean extended;
+
+	if (parse_digits (date, 4, &year) == FALSE)
+		return FALSE;
+
+	extended = (date[4] == '-');
+	date += (extended == TRUE) ? 5 : 4;
+
+	if (parse_digits (date, 2, &month) == FALSE || month < 1 || month > 12)
+		return FALSE;
+
+	date += 2;
+	if (extended == TRUE) {
+		if (*date != '-')
+			return FALSE;
+		date++;
+	}
+
+	if (parse_digits (date, 2, &day) == FALSE || day < 1 || day > days_in_month (year, month))
+		return FALSE;
+
+	*_days = days_from_civil (year, month, day);
+	*end = date + 2;
+
+	return TRUE;
+}
+
+/* Parses the fixed-width subset of ISO 8601 which Google's servers send: YYYY-MM-DDTHH:MM:SS, optionally followed by a fraction of a second, then
+ * either Z or a ±HH:MM (or ±HHMM) offset. Anything else (including out-of-range fields) makes this return %FALSE, so that the caller can fall back
+ * to g_time_val_from_iso8601(). */
+static gboolean
+parse_iso8601_fast (const gchar *date, gint64 *_time)
+{
+	guint hour, minute, second, offset_hours, offset_minutes;
+	gint64 days, offset;
+
+	if (parse_date (date, &days, &date) == FALSE || *date != 'T')
+		return FALSE;
+	date++;
+
+	if (parse_digits (date, 2, &hour) == FALSE || hour > 23 || date[2] != ':' ||
+	    parse_digits (date + 3, 2, &minute) == FALSE || minute > 59 || date[5] != ':' ||
+	    parse_digits (date + 6, 2, &second) == FALSE || second > 59) {
+		return FALSE;
+	}
+	date += 8;
+
+	/* Skip any fraction of a second; g_time_val_from_iso8601() would put it in tv_usec, which we ignore */
+	if (*date == '.') {
+		date++;
+		if (g_ascii_isdigit (*date) == FALSE)
+			return FALSE;
+		while (g_ascii_isdigit (*date) == TRUE)
+			date++;
+	}
+
+	if (date[0] == 'Z' && date[1] == '\0') {
+		offset = 0;
+	} else if (date[0] == '+' || date[0] == '-') {
+		const gchar *minutes;
+
+		if (parse_digits (date + 1, 2, &offset_hours) == FALSE)
+			return FALSE;
+
+		minutes = (date[3] == ':') ? date + 4 : date + 3;
+		if (parse_digits (minutes, 2, &offset_minutes) == FALSE || offset_minutes > 59 || minutes[2] != '\0')
+			return FALSE;
+
+		offset = (offset_hours * 60 + offset_minutes) * 60;
+		if (date[0] == '-')
+			offset = -offset;
+	} else {
+		return FALSE;
+	}
+
+	*_time = days * 86400 + hour * 3600 + minute * 60 + second - offset;
+
+	return TRUE;
+}
+
 gboolean
 gdata_parser_int64_from_date (const gchar *date, gint64 *_time)
 {
 	gchar *iso8601_date;
 	gboolean success;
 	GTimeVal time_val;
+	gint64 days;
+	const gchar *end;
 
 	if (strlen (date) != 10 && strlen (date) != 8)
 		return FALSE;
 
+	if (parse_date (date, &days, &end) == TRUE && *end == '\0') {
+		*_time = days * 86400;
+		return TRUE;
+	}
+
+	/* Fall back to GLib's parser for anything unusual */
 	/* Note: This doesn't need translating, as it's outputting an ISO 8601 time string */
 	iso8601_date = g_strdup_printf ("%sT00:00:00Z", date);
 	success = g_time_val_from_iso8601 (iso8601_date, &time_val);
@@ -224,45 +392,158 @@ gdata_parser_int64_from_date (const gchar *date, gint64 *_time)
 	return success;
 }
 
+/*
+ * gdata_parser_date_to_buffer:
+ * @_time: a UNIX timestamp
+ * @buffer: (out caller-allocates): a buffer of at least %GDATA_PARSER_DATE_BUFFER_SIZE bytes
+ *
+ * Formats the date (in UTC) of @_time as YYYY-MM-DD into @buffer, nul-terminated, without allocating. This is the same as
+ * gdata_parser_date_from_int64().
+ *
+ * Return value: the length of the string written to @buffer
+ */
+gsize
+gdata_parser_date_to_buffer (gint64 _time, gchar *buffer)
+{
+	gint64 year;
+	guint month, day;
+	gchar *p;
+
+	civil_from_days ((_time >= 0) ? _time / 86400 : (_time - 86399) / 86400, &year, &month, &day);
+
+	if (year < 0 || year > 9999) {
+		/* Note: This doesn't need translating, as it's outputting an ISO 8601 date string */
+		return g_snprintf (buffer, GDATA_PARSER_DATE_BUFFER_SIZE, "%04" G_GINT64_FORMAT "-%02u-%02u", year, month, day);
+	}
+
+	p = format_digits (buffer, year, 4);
+	*(p++) = '-';
+	p = format_digits (p, month, 2);
+	*(p++) = '-';
+	p = format_digits (p, day, 2);
+	*p = '\0';
+
+	return p - buffer;
+}
+
 gchar *
 gdata_parser_date_from_int64 (gint64 _time)
 {
-	time_t secs;
-	struct tm *tm;
+	gchar buffer[GDATA_PARSER_DATE_BUFFER_SIZE];
 
-	secs = _time;
-	tm = gmtime (&secs);
+	gdata_parser_date_to_buffer (_time, buffer);
 
-	/* Note: This doesn't need translating, as it's outputting an ISO 8601 date string */
-	return g_strdup_printf ("%04d-%02d-%02d", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday);
+	return g_strdup (buffer);
+}
+
+/* Formats @_time as YYYY-MM-DDTHH:MM:SS into @buffer (which must be at least %GDATA_PARSER_ISO8601_BUFFER_SIZE bytes long), followed by @suffix.
+ * Years outside 1000–9999 are formatted by GLib, which doesn't pad them in the same way; newer versions of GLib refuse to format years outside
+ * 1–9999 at all, so those are formatted here without any padding. */
+static gsize
+format_iso8601 (gint64 _time, const gchar *suffix, gchar *buffer)
+{
+	gint64 year, days, seconds;
+	guint month, day;
+	gchar *p;
+
+	days = (_time >= 0) ? _time / 86400 : (_time - 86399) / 86400;
+	seconds = _time - days * 86400;
+	civil_from_days (days, &year, &month, &day);
+
+	if (year < 1000 || year > 9999) {
+		GTimeVal time_val;
+		gchar *iso8601;
+		const gchar *z;
+		gsize length;
+
+		time_val.tv_sec = _time;
+		time_val.tv_usec = 0;
+		iso8601 = g_time_val_to_iso8601 (&time_val);
+
+		if (iso8601 == NULL) {
+			/* Note: This doesn't need translating, as it's outputting an ISO 8601 time string */
+			return g_snprintf (buffer, GDATA_PARSER_ISO8601_BUFFER_SIZE, "%" G_GINT64_FORMAT "-%02u-%02uT%02u:%02u:%02u%s", year, month, day,
+			                   (guint) (seconds / 3600), (guint) ((seconds / 60) % 60), (guint) (seconds % 60), suffix);
+		}
+
+		/* Swap GLib's trailing Z for the suffix */
+		z = strrchr (iso8601, 'Z');
+		length = (z != NULL) ? (gsize) (z - iso8601) : strlen (iso8601);
+		length = MIN (length, GDATA_PARSER_ISO8601_BUFFER_SIZE - strlen (suffix) - 1);
+		memcpy (buffer, iso8601, length);
+		strcpy (buffer + length, suffix);
+		g_free (iso8601);
+
+		return length + strlen (suffix);
+	}
+
+	p = format_digits (buffer, year, 4);
+	*(p++) = '-';
+	p = format_digits (p, month, 2);
+	*(p++) = '-';
+	p = format_digits (p, day, 2);
+	*(p++) = 'T';
+	p = format_digits (p, seconds / 3600, 2);
+	*(p++) = ':';
+	p = format_digits (p, (seconds / 60) % 60, 2);
+	*(p++) = ':';
+	p = format_digits (p, seconds % 60, 2);
+	strcpy (p, suffix);
+
+	return (p - buffer) + strlen (suffix);
+}
+
+/*
+ * gdata_parser_int64_to_iso8601_buffer:
+ * @_time: a UNIX timestamp
+ * @buffer: (out caller-allocates): a buffer of at least %GDATA_PARSER_ISO8601_BUFFER_SIZE bytes
+ *
+ * Formats @_time as an ISO 8601 date and time in UTC into @buffer, nul-terminated, without allocating. This is the same as
+ * gdata_parser_int64_to_iso8601().
+ *
+ * Return value: the length of the string written to @buffer
+ */
+gsize
+gdata_parser_int64_to_iso8601_buffer (gint64 _time, gchar *buffer)
+{
+	return format_iso8601 (_time, "Z", buffer);
 }
 
 gchar *
 gdata_parser_int64_to_iso8601 (gint64 _time)
 {
-	GTimeVal time_val;
+	gchar buffer[GDATA_PARSER_ISO8601_BUFFER_SIZE];
 
-	time_val.tv_sec = _time;
-	time_val.tv_usec = 0;
+	gdata_parser_int64_to_iso8601_buffer (_time, buffer);
 
-	return g_time_val_to_iso8601 (&time_val);
+	return g_strdup (buffer);
+}
+
+/*
+ * gdata_parser_int64_to_json_iso8601_buffer:
+ * @_time: a UNIX timestamp
+ * @buffer: (out caller-allocates): a buffer of at least %GDATA_PARSER_ISO8601_BUFFER_SIZE bytes
+ *
+ * Formats @_time in the form of ISO 8601 which Google's JSON APIs accept into @buffer, nul-terminated, without allocating. This is the same as
+ * gdata_parser_int64_to_json_iso8601().
+ *
+ * Return value: the length of the string written to @buffer
+ */
+gsize
+gdata_parser_int64_to_json_iso8601_buffer (gint64 _time, gchar *buffer)
+{
+	/* FIXME: Work around for Google's incorrect ISO 8601 implementation. */
+	return format_iso8601 (_time, ".000001+00:00", buffer);
 }
 
-/* FIXME: Work around for Google's incorrect ISO 8601 implementation. */
 gchar *
 gdata_parser_int64_to_json_iso8601 (gint64 _time)
 {
-	gchar *iso8601;
-	gchar **date_time_components;
-	gchar *retval;
+	gchar buffer[GDATA_PARSER_ISO8601_BUFFER_SIZE];
 
-	iso8601 = gdata_parser_int64_to_iso8601 (_time);
+	gdata_parser_int64_to_json_iso8601_buffer (_time, buffer);
 
-	date_time_components = g_strsplit (iso8601, "Z", 2);
-	retval = g_strjoinv (".000001+00:00", date_time_components);
-	g_strfreev (date_time_components);
-
-	return retval;
+	return g_strdup (buffer);
 }
 
 gboolean
@@ -270,6 +551,10 @@ gdata_parser_int64_from_iso8601 (const gchar *date, gint64 *_time)
 {
 	GTimeVal time_val;
 
+	if (parse_iso8601_fast (date, _time) == TRUE)
+		return TRUE;
+
+	/* Fall back to GLib's parser for the less common forms of ISO 8601 */
 	if (g_time_val_from_iso8601 (date, &time_val) == TRUE) {
 		*_time = time_val.tv_sec;
 		return TRUE;
@@ -278,6 +563,92 @@ gdata_parser_int64_from_iso8601 (const gchar *date, gint64 *_time)
 	return FALSE;
 }
 
+/* Time zones are expensive to create, as each named zone is loaded from the system's time zone database; and GLib frees a zone as soon as its last
+ * reference is dropped. Keep the zones which have been asked for around for the lifetime of the process, up to a limit, so that parsing a feed of
+ * events which all use the same handful of zones only loads each of them once. */
+#define MAX_CACHED_TIME_ZONES 64
+
+static GMutex time_zones_mutex;
+static GHashTable *time_zones = NULL; /* gchar* identifier → GTimeZone */
+
+/*
+ * gdata_parser_time_zone_new:
+ * @identifier: (allow-none): a time zone identifier, as accepted by g_time_zone_new(), or %NULL for UTC
+ *
+ * Gets the time zone for @identifier, as g_time_zone_new() would, but from a process-wide cache. This may be called from any thread.
+ *
+ * Return value: (transfer full): the time zone; unref with g_time_zone_unref()
+ *
+ * Since: 0.15.0
+ */
+GTimeZone *
+gdata_parser_time_zone_new (const gchar *identifier)
+{
+	static gsize utc_time_zone = 0;
+	GTimeZone *time_zone;
+
+	if (identifier == NULL) {
+		if (g_once_init_enter (&utc_time_zone) == TRUE)
+			g_once_init_leave (&utc_time_zone, (gsize) g_time_zone_new_utc ());
+
+		return g_time_zone_ref ((GTimeZone*) utc_time_zone);
+	}
+
+	g_mutex_lock (&time_zones_mutex);
+
+	if (time_zones == NULL)
+		time_zones = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_time_zone_unref);
+
+	time_zone = g_hash_table_lookup (time_zones, identifier);
+
+	if (time_zone != NULL) {
+		g_time_zone_ref (time_zone);
+	} else {
+		time_zone = g_time_zone_new (identifier);
+
+		if (g_hash_table_size (time_zones) < MAX_CACHED_TIME_ZONES)
+			g_hash_table_insert (time_zones, g_strdup (identifier), g_time_zone_ref (time_zone));
+	}
+
+	g_mutex_unlock (&time_zones_mutex);
+
+	return time_zone;
+}
+
+/*
+ * gdata_parser_int64_from_local_time:
+ * @time_zone: (allow-none): the time zone the time is in, or %NULL for UTC
+ * @year: the year
+ * @month: the month, from 1 to 12
+ * @day: the day of the month, from 1
+ * @hour: the hour, from 0 to 23
+ * @minute: the minute, from 0 to 59
+ * @second: the second, from 0 to 59
+ *
+ * Converts a wall clock time in @time_zone to a UNIX timestamp, as g_date_time_to_unix() on the result of g_date_time_new() would, but without
+ * allocating. As with g_date_time_new(), times which are skipped over or repeated by a daylight saving change are taken to be in standard time.
+ * The date isn't validated.
+ *
+ * Return value: the UNIX timestamp
+ *
+ * Since: 0.15.0
+ */
+gint64
+gdata_parser_int64_from_local_time (GTimeZone *time_zone, gint64 year, guint month, guint day, guint hour, guint minute, guint second)
+{
+	gint64 _time;
+	gint interval;
+
+	_time = days_from_civil (year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+
+	if (time_zone == NULL)
+		return _time;
+
+	interval = g_time_zone_adjust_time (time_zone, G_TIME_TYPE_STANDARD, &_time);
+
+	return _time - g_time_zone_get_offset (time_zone, interval);
+}
+
 gboolean
 gdata_parser_error_required_json_content_missing (JsonReader *reader, GError **error)
 {
@@ -378,6 +749,157 @@ gdata_parser_boolean_from_property (xmlNode *element, const gchar *property_name
 	return TRUE;
 }
 
+/*
+ * gdata_parser_int64_from_property:
+ * @element: the XML element which owns the property to parse
+ * @property_name: the name of the property to parse
+ * @output: the return location for the parsed integer value
+ * @error: a #GError, or %NULL
+ *
+ * Parses a decimal integer from the property @property_name of @element, such as "<element property_name='1234'/>".
+ * A %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned in @error if the property is missing or isn't a valid integer, and @output will
+ * not be set.
+ *
+ * Return value: %TRUE on successful parsing, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_parser_int64_from_property (xmlNode *element, const gchar *property_name, gint64 *output, GError **error)
+{
+	xmlChar *value;
+	gchar *end_ptr;
+	gint64 val;
+
+	value = xmlGetProp (element, (xmlChar*) property_name);
+
+	if (value == NULL) {
+		return gdata_parser_error_required_property_missing (element, property_name, error);
+	}
+
+	val = g_ascii_strtoll ((const gchar*) value, &end_ptr, 10);
+
+	if (*value == '\0' || *end_ptr != '\0') {
+		gdata_parser_error_unknown_property_value (element, property_name, (gchar*) value, error);
+		xmlFree (value);
+		return FALSE;
+	}
+
+	*output = val;
+	xmlFree (value);
+
+	return TRUE;
+}
+
+/* Gets the value of the property @property_name of @element without copying it if possible, as xmlGetProp() would. If a copy has to be made, it's
+ * returned in @owned, and must be freed with xmlFree(); otherwise @owned is set to %NULL. */
+static const xmlChar *
+peek_property (xmlNode *element, const gchar *property_name, xmlChar **owned)
+{
+	xmlAttr *property;
+
+	property = xmlHasProp (element, (xmlChar*) property_name);
+	if (property == NULL) {
+		*owned = NULL;
+		return NULL;
+	}
+
+	/* Almost all properties have a single text child. Anything else (such as a default from a DTD, or an entity reference) is left to libxml. */
+	if (property->type == XML_ATTRIBUTE_NODE && property->children != NULL && property->children->next == NULL &&
+	    property->children->type == XML_TEXT_NODE && property->children->content != NULL) {
+		*owned = NULL;
+		return property->children->content;
+	}
+
+	*owned = xmlGetProp (element, (xmlChar*) property_name);
+	return *owned;
+}
+
+/*
+ * gdata_parser_int64_time_from_property:
+ * @element: the XML element which owns the property to parse
+ * @property_name: the name of the property to parse
+ * @required: %TRUE if the property must be present, %FALSE otherwise
+ * @output: the return location for the parsed UNIX timestamp
+ * @is_date: (allow-none) (out): the return location for whether the property was a date rather than a date and time, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Parses an ISO 8601 date and time from the property @property_name of @element, such as "<element property_name='2009-04-17T15:00:00Z'/>",
+ * without copying the property's value. If @is_date is non-%NULL, a plain date (such as "2009-04-17") is also accepted, in which case @output is
+ * set to midnight UTC on that date and @is_date is set to %TRUE.
+ *
+ * If the property is missing and @required is %FALSE, @output is set to <code class="literal">-1</code> and %TRUE is returned. Otherwise, a
+ * %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned in @error if the property is missing or isn't a valid time, and @output will not
+ * be set.
+ *
+ * Return value: %TRUE on successful parsing, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_parser_int64_time_from_property (xmlNode *element, const gchar *property_name, gboolean required, gint64 *output, gboolean *is_date,
+                                       GError **error)
+{
+	const xmlChar *value;
+	xmlChar *owned;
+	gboolean success = TRUE;
+
+	if (is_date != NULL)
+		*is_date = FALSE;
+
+	value = peek_property (element, property_name, &owned);
+
+	if (value == NULL) {
+		if (required == TRUE)
+			return gdata_parser_error_required_property_missing (element, property_name, error);
+
+		*output = -1;
+		return TRUE;
+	}
+
+	if (is_date != NULL && gdata_parser_int64_from_date ((const gchar*) value, output) == TRUE) {
+		*is_date = TRUE;
+	} else if (gdata_parser_int64_from_iso8601 ((const gchar*) value, output) == FALSE) {
+		gdata_parser_error_not_iso8601_format (element, (const gchar*) value, error);
+		success = FALSE;
+	}
+
+	xmlFree (owned);
+
+	return success;
+}
+
+/*
+ * gdata_parser_intern_property:
+ * @element: the XML element which owns the property to intern
+ * @property_name: the name of the property to intern
+ *
+ * Gets the value of the property @property_name of @element and interns it using g_intern_string(). This is intended for properties whose values
+ * are drawn from a small, enumerated set (such as relation types and category schemes) and are repeated in every entry of a feed; each distinct
+ * value is then only stored once, and interned values can be compared by pointer.
+ *
+ * Interned strings are never freed, so this must not be used for free-form values such as labels or URIs.
+ *
+ * Return value: (transfer none): the interned property value, or %NULL if @element doesn't have the property
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+gdata_parser_intern_property (xmlNode *element, const gchar *property_name)
+{
+	xmlChar *value;
+	const gchar *interned_value;
+
+	value = xmlGetProp (element, (xmlChar*) property_name);
+	if (value == NULL)
+		return NULL;
+
+	interned_value = g_intern_string ((const gchar*) value);
+	xmlFree (value);
+
+	return interned_value;
+}
+
 /*
  * gdata_parser_is_namespace:
  * @element: the element to check
@@ -399,6 +921,67 @@ gdata_parser_is_namespace (xmlNode *element, const gchar *namespace_uri)
 	return FALSE;
 }
 
+/* Returns the single text (or CDATA) child of @element whose content can be used without copying it, or %NULL if @element has no children, more
+ * than one, or its content is owned by the document's dictionary (as short and blank strings are) or stored inline in the node. */
+static xmlNode *
+get_sole_text_child (xmlNode *element)
+{
+	xmlNode *child = element->children;
+
+	if (child == NULL || child->next != NULL || (child->type != XML_TEXT_NODE && child->type != XML_CDATA_SECTION_NODE) ||
+	    child->content == NULL || child->content == (xmlChar*) &(child->properties) ||
+	    (element->doc != NULL && element->doc->dict != NULL && xmlDictOwns (element->doc->dict, child->content) != 0)) {
+		return NULL;
+	}
+
+	return child;
+}
+
+/*
+ * gdata_parser_take_element_content:
+ * @element: the element whose content to get
+ *
+ * Gets the text content of @element, as xmlNodeListGetString() would. If the content is a single text node, as it almost always is, ownership of
+ * its string is taken from the node rather than copying it, leaving the node empty; so this must only be used once the content of @element is not
+ * going to be needed again, such as when it's being parsed into a property.
+ *
+ * Return value: (allow-none): the content of @element, or %NULL if it has none; free with g_free()
+ *
+ * Since: 0.15.0
+ */
+xmlChar *
+gdata_parser_take_element_content (xmlNode *element)
+{
+	xmlNode *child;
+	xmlChar *content;
+
+	child = get_sole_text_child (element);
+	if (child == NULL)
+		return xmlNodeListGetString (element->doc, element->children, TRUE);
+
+	content = child->content;
+	child->content = NULL;
+
+	return content;
+}
+
+/* Gets the text content of @element without copying it if possible. If a copy has to be made, it's returned in @owned, and must be freed with
+ * xmlFree(); otherwise @owned is set to %NULL. */
+static const xmlChar *
+peek_element_content (xmlNode *element, xmlChar **owned)
+{
+	xmlNode *child;
+
+	child = get_sole_text_child (element);
+	if (child != NULL) {
+		*owned = NULL;
+		return child->content;
+	}
+
+	*owned = xmlNodeListGetString (element->doc, element->children, TRUE);
+	return *owned;
+}
+
 /*
  * gdata_parser_string_from_element:
  * @element: the element to check against
@@ -444,7 +1027,7 @@ gdata_parser_string_from_element (xmlNode *element, const gchar *element_name, G
 	}
 
 	/* Get the string and check it for NULLness or emptiness */
-	text = xmlNodeListGetString (element->doc, element->children, TRUE);
+	text = gdata_parser_take_element_content (element);
 	if ((options & P_REQUIRED && text == NULL) || (options & P_NON_EMPTY && text != NULL && *text == '\0')) {
 		xmlFree (text);
 		*success = gdata_parser_error_required_content_missing (element, error);
@@ -494,7 +1077,8 @@ gboolean
 gdata_parser_int64_time_from_element (xmlNode *element, const gchar *element_name, GDataParserOptions options,
                                       gint64 *output, gboolean *success, GError **error)
 {
-	xmlChar *text;
+	const xmlChar *text;
+	xmlChar *owned_text;
 	GTimeVal time_val;
 
 	/* Check it's the right element */
@@ -508,24 +1092,24 @@ gdata_parser_int64_time_from_element (xmlNode *element, const gchar *element_nam
 	}
 
 	/* Get the string and check it for NULLness */
-	text = xmlNodeListGetString (element->doc, element->children, TRUE);
+	text = peek_element_content (element, &owned_text);
 	if (options & P_REQUIRED && (text == NULL || *text == '\0')) {
-		xmlFree (text);
+		xmlFree (owned_text);
 		*success = gdata_parser_error_required_content_missing (element, error);
 		return TRUE;
 	}
 
 	/* Attempt to parse the string as a GTimeVal */
-	if (g_time_val_from_iso8601 ((gchar*) text, &time_val) == FALSE) {
-		*success = gdata_parser_error_not_iso8601_format (element, (gchar*) text, error);
-		xmlFree (text);
+	if (text == NULL || g_time_val_from_iso8601 ((const gchar*) text, &time_val) == FALSE) {
+		*success = gdata_parser_error_not_iso8601_format (element, (const gchar*) text, error);
+		xmlFree (owned_text);
 		return TRUE;
 	}
 
 	*output = time_val.tv_sec;
 
 	/* Success! */
-	xmlFree (text);
+	xmlFree (owned_text);
 	*success = TRUE;
 
 	return TRUE;
@@ -565,7 +1149,8 @@ gboolean
 gdata_parser_int64_from_element (xmlNode *element, const gchar *element_name, GDataParserOptions options,
                                  gint64 *output, gint64 default_output, gboolean *success, GError **error)
 {
-	xmlChar *text;
+	const xmlChar *text;
+	xmlChar *owned_text;
 	gchar *end_ptr;
 	gint64 val;
 
@@ -581,27 +1166,27 @@ gdata_parser_int64_from_element (xmlNode *element, const gchar *element_name, GD
 	}
 
 	/* Get the string and check it for NULLness */
-	text = xmlNodeListGetString (element->doc, element->children, TRUE);
+	text = peek_element_content (element, &owned_text);
 	if (options & P_REQUIRED && (text == NULL || *text == '\0')) {
-		xmlFree (text);
+		xmlFree (owned_text);
 		*success = gdata_parser_error_required_content_missing (element, error);
 		return TRUE;
 	}
 
 	/* Attempt to parse the string as a 64-bit integer */
 	errno = 0;
-	val = g_ascii_strtoll ((const gchar*) text, &end_ptr, 10);
+	val = (text != NULL) ? g_ascii_strtoll ((const gchar*) text, &end_ptr, 10) : 0;
 
-	if (errno != 0 || end_ptr == (gchar*) text) {
-		*success = gdata_parser_error_unknown_content (element, (gchar*) text, error);
-		xmlFree (text);
+	if (text == NULL || errno != 0 || end_ptr == (const gchar*) text) {
+		*success = gdata_parser_error_unknown_content (element, (const gchar*) text, error);
+		xmlFree (owned_text);
 		return TRUE;
 	}
 
 	*output = val;
 
 	/* Success! */
-	xmlFree (text);
+	xmlFree (owned_text);
 	*success = TRUE;
 
 	return TRUE;
@@ -623,6 +1208,7 @@ gdata_parser_int64_from_element (xmlNode *element, const gchar *element_name, GD
  * @element_name, @element will be parsed as an @object_type, which must extend #GDataParsable. If parsing is successful, @_setter will be called
  * with its first parameter as @_parent_parsable, and its second as the parsed object of type @object_type. @_setter must reference the parsed object
  * it's passed if it wants to keep it, as gdata_parser_object_from_element_setter will unreference it before returning.
+ * The object may be shared with other parents in the same feed (see _gdata_parsable_new_shared_from_xml_node()), so @_setter mustn't modify it.
  *
  * If @element doesn't match @element_name, %FALSE will be returned, @error will be unset and @success will be unset.
  *
@@ -660,10 +1246,10 @@ gdata_parser_object_from_element_setter (xmlNode *element, const gchar *element_
 	if (xmlStrcmp (element->name, (xmlChar*) element_name) != 0)
 		return FALSE;
 
-	/* Get the object and check for instantiation failure */
-	parsable = _gdata_parsable_new_from_xml_node (object_type, element->doc, element, NULL, error);
+	/* Get the object and check for instantiation failure. Simple values which are repeated throughout a feed share one object. */
+	parsable = _gdata_parsable_new_shared_from_xml_node (object_type, element->doc, element, error);
 	if (options & P_REQUIRED && parsable == NULL) {
-		/* The error has already been set by _gdata_parsable_new_from_xml_node() */
+		/* The error has already been set by _gdata_parsable_new_shared_from_xml_node() */
 		*success = FALSE;
 		return TRUE;
 	}
@@ -746,6 +1332,378 @@ gdata_parser_object_from_element (xmlNode *element, const gchar *element_name, G
 	return TRUE;
 }
 
+typedef struct {
+	GDataParserSchemaType type;
+	GDataParserOptions options;
+	GType object_type;
+	gsize private_offset;
+	const gchar *attribute_name; /* for P_SCHEMA_STRING_ATTRIBUTE */
+	gpointer func; /* a GDataParserSetterFunc for P_SCHEMA_OBJECT_SETTER, or a GDataParserElementFunc for P_SCHEMA_FUNC */
+} ElementHandler;
+
+static GQuark
+element_handlers_quark (void)
+{
+	static GQuark quark = 0;
+
+	if (G_UNLIKELY (quark == 0))
+		quark = g_quark_from_static_string ("gdata-parser-element-handlers");
+
+	return quark;
+}
+
+static void
+register_element_handler (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserSchemaType type,
+                          GDataParserOptions options, GType object_type, gsize private_offset, const gchar *attribute_name, gpointer func)
+{
+	GHashTable *namespaces, *elements;
+	ElementHandler *handler;
+
+	g_return_if_fail (g_type_is_a (parsable_type, GDATA_TYPE_PARSABLE));
+	g_return_if_fail (namespace_uri != NULL);
+	g_return_if_fail (element_name != NULL);
+
+	/* The tables are keyed on namespace URI, then element name. Both are expected to be static strings, and the tables are never freed, since
+	 * they're only ever registered for static types. */
+	namespaces = g_type_get_qdata (parsable_type, element_handlers_quark ());
+	if (namespaces == NULL) {
+		namespaces = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) g_hash_table_destroy);
+		g_type_set_qdata (parsable_type, element_handlers_quark (), namespaces);
+	}
+
+	elements = g_hash_table_lookup (namespaces, namespace_uri);
+	if (elements == NULL) {
+		elements = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+		g_hash_table_insert (namespaces, (gpointer) namespace_uri, elements);
+	}
+
+	handler = g_new (ElementHandler, 1);
+	handler->type = type;
+	handler->options = options;
+	handler->object_type = object_type;
+	handler->private_offset = private_offset;
+	handler->attribute_name = attribute_name;
+	handler->func = func;
+
+	g_hash_table_insert (elements, (gpointer) element_name, handler);
+}
+
+/*
+ * gdata_parser_register_string:
+ * @parsable_type: the #GDataParsable subclass to register the element for
+ * @namespace_uri: the namespace URI of the element
+ * @element_name: the name of the element
+ * @options: a bitwise combination of parsing options from #GDataParserOptions, or %P_NONE
+ * @private_offset: the offset of the #gchar* output field in @parsable_type's private structure, as given by G_STRUCT_OFFSET()
+ *
+ * Registers an element which gdata_parser_dispatch_element() will parse for @parsable_type as if by gdata_parser_string_from_element(), storing
+ * the string in the given field of the parsable's private structure. This should be called from @parsable_type's <function>class_init</function>
+ * function.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parser_register_string (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserOptions options,
+                              gsize private_offset)
+{
+	register_element_handler (parsable_type, namespace_uri, element_name, P_SCHEMA_STRING, options, G_TYPE_INVALID, private_offset, NULL, NULL);
+}
+
+/*
+ * gdata_parser_register_int64_time:
+ * @parsable_type: the #GDataParsable subclass to register the element for
+ * @namespace_uri: the namespace URI of the element
+ * @element_name: the name of the element
+ * @options: a bitwise combination of parsing options from #GDataParserOptions, or %P_NONE
+ * @private_offset: the offset of the #gint64 output field in @parsable_type's private structure, as given by G_STRUCT_OFFSET()
+ *
+ * Registers an element which gdata_parser_dispatch_element() will parse for @parsable_type as if by gdata_parser_int64_time_from_element().
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parser_register_int64_time (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserOptions options,
+                                  gsize private_offset)
+{
+	register_element_handler (parsable_type, namespace_uri, element_name, P_SCHEMA_INT64_TIME, options, G_TYPE_INVALID, private_offset, NULL,
+	                          NULL);
+}
+
+/*
+ * gdata_parser_register_object:
+ * @parsable_type: the #GDataParsable subclass to register the element for
+ * @namespace_uri: the namespace URI of the element
+ * @element_name: the name of the element
+ * @options: a bitwise combination of parsing options from #GDataParserOptions, or %P_NONE
+ * @object_type: the type of the object to parse
+ * @private_offset: the offset of the #GDataParsable* output field in @parsable_type's private structure, as given by G_STRUCT_OFFSET()
+ *
+ * Registers an element which gdata_parser_dispatch_element() will parse for @parsable_type as if by gdata_parser_object_from_element().
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parser_register_object (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserOptions options,
+                              GType object_type, gsize private_offset)
+{
+	register_element_handler (parsable_type, namespace_uri, element_name, P_SCHEMA_OBJECT, options, object_type, private_offset, NULL, NULL);
+}
+
+/*
+ * gdata_parser_register_object_setter:
+ * @parsable_type: the #GDataParsable subclass to register the element for
+ * @namespace_uri: the namespace URI of the element
+ * @element_name: the name of the element
+ * @options: a bitwise combination of parsing options from #GDataParserOptions, or %P_NONE
+ * @object_type: the type of the object to parse
+ * @_setter: a #GDataParserSetterFunc to call with the parsable and the parsed object
+ *
+ * Registers an element which gdata_parser_dispatch_element() will parse for @parsable_type as if by gdata_parser_object_from_element_setter(),
+ * with the parsable being parsed as the parent parsable.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parser_register_object_setter (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserOptions options,
+                                     GType object_type, gpointer /* GDataParserSetterFunc */ _setter)
+{
+	register_element_handler (parsable_type, namespace_uri, element_name, P_SCHEMA_OBJECT_SETTER, options, object_type, 0, NULL, _setter);
+}
+
+/*
+ * gdata_parser_register_func:
+ * @parsable_type: the #GDataParsable subclass to register the element for
+ * @namespace_uri: the namespace URI of the element
+ * @element_name: the name of the element
+ * @func: a #GDataParserElementFunc to parse the element
+ *
+ * Registers an element which gdata_parser_dispatch_element() will parse for @parsable_type by calling @func, for elements which need custom
+ * parsing code. The return value of @func is used as the success value.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parser_register_func (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserElementFunc func)
+{
+	g_return_if_fail (func != NULL);
+	register_element_handler (parsable_type, namespace_uri, element_name, P_SCHEMA_FUNC, P_NONE, G_TYPE_INVALID, 0, NULL, func);
+}
+
+/*
+ * gdata_parser_register_schema:
+ * @parsable_type: the #GDataParsable subclass to register the elements for
+ * @schema: (array zero-terminated=1): a static array of elements, terminated by %P_SCHEMA_END
+ *
+ * Registers all the elements in @schema for gdata_parser_dispatch_element() to parse for @parsable_type, as if each had been registered using
+ * the corresponding gdata_parser_register_*() function. @schema must remain valid for the lifetime of the process, as the same array can be
+ * passed to gdata_parser_get_xml_from_schema() to output the elements. This should be called from @parsable_type's
+ * <function>class_init</function> function.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parser_register_schema (GType parsable_type, const GDataParserSchemaElement *schema)
+{
+	const GDataParserSchemaElement *element;
+
+	g_return_if_fail (schema != NULL);
+
+	for (element = schema; element->namespace_uri != NULL; element++) {
+		GType object_type = (element->get_object_type != NULL) ? element->get_object_type () : G_TYPE_INVALID;
+
+		g_return_if_fail (element->type != P_SCHEMA_STRING_ATTRIBUTE || element->attribute_name != NULL);
+		g_return_if_fail ((element->type != P_SCHEMA_OBJECT && element->type != P_SCHEMA_OBJECT_SETTER) || object_type != G_TYPE_INVALID);
+		g_return_if_fail ((element->type != P_SCHEMA_OBJECT_SETTER && element->type != P_SCHEMA_FUNC) || element->func != NULL);
+
+		register_element_handler (parsable_type, element->namespace_uri, element->element_name, element->type, element->options, object_type,
+		                          element->private_offset, element->attribute_name, element->func);
+	}
+}
+
+/*
+ * gdata_parser_get_xml_from_schema:
+ * @parsable: the #GDataParsable to output
+ * @parsable_type: the #GDataParsable subclass which @schema belongs to
+ * @schema: (array zero-terminated=1): the schema registered for @parsable_type with gdata_parser_register_schema()
+ * @xml_string: the #GString to append the XML to
+ *
+ * Outputs the elements of @schema which have a qualified name, in the order they're listed in @schema, for use in @parsable_type's
+ * <function>get_xml</function> function. %P_SCHEMA_STRING, %P_SCHEMA_STRING_ATTRIBUTE, %P_SCHEMA_INT64_TIME and %P_SCHEMA_OBJECT elements are
+ * output from their fields in the parsable's private structure, with the same escaping as gdata_parser_string_append_escaped(), and are omitted if
+ * the field is unset. %P_SCHEMA_FUNC elements are output using their @get_xml function, if they have one. Elements with no qualified name, and
+ * %P_SCHEMA_OBJECT_SETTER elements (which generally build lists), have to be output by the class itself.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_parser_get_xml_from_schema (GDataParsable *parsable, GType parsable_type, const GDataParserSchemaElement *schema, GString *xml_string)
+{
+	const GDataParserSchemaElement *element;
+	gpointer priv;
+
+	g_return_if_fail (G_TYPE_CHECK_INSTANCE_TYPE (parsable, parsable_type));
+	g_return_if_fail (schema != NULL);
+	g_return_if_fail (xml_string != NULL);
+
+	priv = g_type_instance_get_private ((GTypeInstance*) parsable, parsable_type);
+
+	for (element = schema; element->namespace_uri != NULL; element++) {
+		if (element->qualified_name == NULL)
+			continue;
+
+		switch (element->type) {
+			case P_SCHEMA_STRING: {
+				const gchar *value = G_STRUCT_MEMBER (const gchar*, priv, element->private_offset);
+
+				if (value != NULL) {
+					g_string_append_c (xml_string, '<');
+					g_string_append (xml_string, element->qualified_name);
+					gdata_parser_string_append_escaped (xml_string, ">", value, "</");
+					g_string_append (xml_string, element->qualified_name);
+					g_string_append_c (xml_string, '>');
+				}
+
+				break;
+			}
+			case P_SCHEMA_STRING_ATTRIBUTE: {
+				const gchar *value = G_STRUCT_MEMBER (const gchar*, priv, element->private_offset);
+
+				if (value != NULL) {
+					g_string_append_printf (xml_string, "<%s %s='", element->qualified_name, element->attribute_name);
+					gdata_parser_string_append_escaped (xml_string, NULL, value, "'/>");
+				}
+
+				break;
+			}
+			case P_SCHEMA_INT64_TIME: {
+				gint64 value = G_STRUCT_MEMBER (gint64, priv, element->private_offset);
+				gchar buffer[GDATA_PARSER_ISO8601_BUFFER_SIZE];
+
+				if (value != -1) {
+					gdata_parser_int64_to_iso8601_buffer (value, buffer);
+					g_string_append_printf (xml_string, "<%s>%s</%s>", element->qualified_name, buffer, element->qualified_name);
+				}
+
+				break;
+			}
+			case P_SCHEMA_OBJECT: {
+				GDataParsable *value = G_STRUCT_MEMBER (GDataParsable*, priv, element->private_offset);
+
+				if (value != NULL)
+					_gdata_parsable_get_xml (value, xml_string, FALSE);
+
+				break;
+			}
+			case P_SCHEMA_OBJECT_SETTER:
+				break;
+			case P_SCHEMA_FUNC:
+				if (element->get_xml != NULL)
+					element->get_xml (parsable, xml_string);
+				break;
+			default:
+				g_assert_not_reached ();
+		}
+	}
+}
+
+/*
+ * gdata_parser_dispatch_element:
+ * @parsable_type: the #GDataParsable subclass whose registered elements should be checked
+ * @parsable: the #GDataParsable being parsed
+ * @doc: the XML document being parsed
+ * @element: the element to parse
+ * @user_data: the user data passed to <function>parse_xml</function>
+ * @success: the return location for a value which is %TRUE if the element was parsed successfully, %FALSE if an error was encountered,
+ * and undefined if @element isn't registered for @parsable_type
+ * @error: a #GError, or %NULL
+ *
+ * Looks up @element in the elements registered for @parsable_type (but not its parent types) using the gdata_parser_register_*() functions, and
+ * parses it using the registered handler if found. This replaces long chains of gdata_parser_*_from_element() calls in <function>parse_xml</function>
+ * implementations, each of which has to compare the element's name, with a single lookup on the element's namespace and name.
+ *
+ * The return value and @success follow the same semantics as gdata_parser_string_from_element(), so unregistered elements can be passed on to
+ * the parent class' <function>parse_xml</function> as usual.
+ *
+ * Return value: %TRUE if @element was registered for @parsable_type, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_parser_dispatch_element (GType parsable_type, GDataParsable *parsable, xmlDoc *doc, xmlNode *element, gpointer user_data,
+                               gboolean *success, GError **error)
+{
+	GHashTable *namespaces, *elements;
+	ElementHandler *handler;
+	const gchar *namespace_uri;
+	gpointer priv;
+
+	namespaces = g_type_get_qdata (parsable_type, element_handlers_quark ());
+	if (namespaces == NULL)
+		return FALSE;
+
+	/* Elements without a namespace are treated as being in the Atom namespace, as in gdata_parser_is_namespace() */
+	namespace_uri = (element->ns != NULL) ? (const gchar*) element->ns->href : "http://www.w3.org/2005/Atom";
+	if (namespace_uri == NULL)
+		return FALSE;
+
+	elements = g_hash_table_lookup (namespaces, namespace_uri);
+	if (elements == NULL)
+		return FALSE;
+
+	handler = g_hash_table_lookup (elements, element->name);
+	if (handler == NULL)
+		return FALSE;
+
+	switch (handler->type) {
+		case P_SCHEMA_STRING:
+			priv = g_type_instance_get_private ((GTypeInstance*) parsable, parsable_type);
+			return gdata_parser_string_from_element (element, (const gchar*) element->name, handler->options,
+			                                         G_STRUCT_MEMBER_P (priv, handler->private_offset), success, error);
+		case P_SCHEMA_STRING_ATTRIBUTE: {
+			gchar **output;
+			xmlChar *value;
+
+			priv = g_type_instance_get_private ((GTypeInstance*) parsable, parsable_type);
+			output = G_STRUCT_MEMBER_P (priv, handler->private_offset);
+
+			if (*output != NULL) {
+				*success = gdata_parser_error_duplicate_element (element, error);
+				return TRUE;
+			}
+
+			value = xmlGetProp (element, (xmlChar*) handler->attribute_name);
+			if (value == NULL || *value == '\0') {
+				xmlFree (value);
+				*success = gdata_parser_error_required_content_missing (element, error);
+				return TRUE;
+			}
+
+			*output = g_strdup ((gchar*) value);
+			xmlFree (value);
+			*success = TRUE;
+
+			return TRUE;
+		}
+		case P_SCHEMA_INT64_TIME:
+			priv = g_type_instance_get_private ((GTypeInstance*) parsable, parsable_type);
+			return gdata_parser_int64_time_from_element (element, (const gchar*) element->name, handler->options,
+			                                             G_STRUCT_MEMBER_P (priv, handler->private_offset), success, error);
+		case P_SCHEMA_OBJECT:
+			priv = g_type_instance_get_private ((GTypeInstance*) parsable, parsable_type);
+			return gdata_parser_object_from_element (element, (const gchar*) element->name, handler->options, handler->object_type,
+			                                         G_STRUCT_MEMBER_P (priv, handler->private_offset), success, error);
+		case P_SCHEMA_OBJECT_SETTER:
+			return gdata_parser_object_from_element_setter (element, (const gchar*) element->name, handler->options,
+			                                                handler->object_type, handler->func, parsable, success, error);
+		case P_SCHEMA_FUNC:
+			*success = ((GDataParserElementFunc) handler->func) (parsable, doc, element, user_data, error);
+			return TRUE;
+	}
+
+	g_assert_not_reached ();
+	return FALSE;
+}
+
 /*
  * gdata_parser_string_from_json_member:
  * @reader: #JsonReader cursor object to read JSON node from
@@ -933,33 +1891,74 @@ gdata_parser_boolean_from_json_member (JsonReader *reader, const gchar *member_n
 	return TRUE;
 }
 
+/* Bytes which can't be copied straight into the output by gdata_parser_string_append_escaped(): the XML special characters, the C0 control
+ * characters other than tab, newline and carriage return, U+007F, and 0xc2, which is the lead byte of the UTF-8 encodings of the C1 control
+ * characters (U+0080–U+009F). All other bytes, including the bytes of all other multi-byte characters, are copied verbatim. */
+static const guint8 escape_table[256] = {
+	/* 0x00 */ 0, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1,
+	/* 0x10 */ 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	/* 0x20 */ 0, 0, 1, 0, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0x30 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0,
+	/* 0x40 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0x50 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0x60 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0x70 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+	/* 0x80 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0x90 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0xa0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0xb0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0xc0 */ 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0xd0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0xe0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	/* 0xf0 */ 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static void
+append_character_reference (GString *xml_string, gunichar c)
+{
+	static const gchar hex_digits[] = "0123456789abcdef";
+
+	/* All the characters which get here are in the range U+0001–U+009F, so have at most two hex digits */
+	g_string_append (xml_string, "&#x");
+	if (c >= 0x10)
+		g_string_append_c (xml_string, hex_digits[(c >> 4) & 0xf]);
+	g_string_append_c (xml_string, hex_digits[c & 0xf]);
+	g_string_append_c (xml_string, ';');
+}
+
 void
 gdata_parser_string_append_escaped (GString *xml_string, const gchar *pre, const gchar *element_content, const gchar *post)
 {
-	/* Allocate 10 extra bytes when reallocating the GString, to try and avoid having to reallocate again, by assuming
-	 * there will be an increase in the length of element_content when escaped of less than 10 characters. */
-/*	#define SIZE_FUZZINESS 10*/
+	const guchar *p, *run;
+	gsize content_length, pre_length, post_length, old_length;
 
-/*	guint new_size;*/
-	const gchar *p;
+	content_length = (element_content != NULL) ? strlen (element_content) : 0;
+	pre_length = (pre != NULL) ? strlen (pre) : 0;
+	post_length = (post != NULL) ? strlen (post) : 0;
 
-	/* Expand xml_string as necessary */
-	/* TODO: There is no way to expand the allocation of a GString if you know in advance how much room
-	 * lots of append operations are going to require. */
-/*	new_size = xml_string->len + strlen (pre) + strlen (element_content) + strlen (post) + SIZE_FUZZINESS;
-	if (new_size > xml_string->allocated_len)
-		g_string_set_size (xml_string, new_size);*/
+	/* Expand xml_string in one go, assuming that most content needs few or no escapes. GString has no way of reserving space, so grow it then
+	 * shrink it again, which leaves the allocation in place. */
+	old_length = xml_string->len;
+	g_string_set_size (xml_string, old_length + pre_length + content_length + post_length);
+	g_string_truncate (xml_string, old_length);
 
 	/* Append the pre content */
 	if (pre != NULL)
-		g_string_append (xml_string, pre);
+		g_string_append_len (xml_string, pre, pre_length);
 
-	/* Loop through the string to be escaped. Code adapted from GLib's g_markup_escape_text() function.
-	 *  Copyright 2000, 2003 Red Hat, Inc.
-	 *  Copyright 2007, 2008 Ryan Lortie <desrt@desrt.ca> */
-	p = element_content;
+	/* Loop through the string to be escaped, copying runs of characters which don't need escaping in bulk. This escapes the same characters as
+	 * GLib's g_markup_escape_text() function. */
+	p = run = (const guchar*) element_content;
 	while (p != NULL && *p != '\0') {
-		const gchar *next = g_utf8_next_char (p);
+		/* Find the end of the current run of plain bytes */
+		while (escape_table[*p] == 0 && *p != '\0')
+			p++;
+
+		if (p > run)
+			g_string_append_len (xml_string, (const gchar*) run, p - run);
+
+		if (*p == '\0')
+			break;
 
 		switch (*p) {
 			case '&':
@@ -977,48 +1976,75 @@ gdata_parser_string_append_escaped (GString *xml_string, const gchar *pre, const
 			case '"':
 				g_string_append (xml_string, "&quot;");
 				break;
-			default: {
-				gunichar c = g_utf8_get_char (p);
-
-				if ((0x1 <= c && c <= 0x8) ||
-				    (0xb <= c && c  <= 0xc) ||
-				    (0xe <= c && c <= 0x1f) ||
-				    (0x7f <= c && c <= 0x84) ||
-				    (0x86 <= c && c <= 0x9f)) {
-					g_string_append_printf (xml_string, "&#x%x;", c);
+			case 0xc2:
+				/* U+0080–U+00BF; only the C1 control characters (other than U+0085, NEL) need escaping */
+				if (p[1] < 0x80 || p[1] > 0xbf) {
+					/* Invalid UTF-8: don't swallow the following byte, in case it needs escaping itself */
+					g_string_append_c (xml_string, (gchar) *p);
+				} else if (p[1] <= 0x9f && p[1] != 0x85) {
+					append_character_reference (xml_string, p[1]);
+					p++;
 				} else {
-					g_string_append_len (xml_string, p, next - p);
-					break;
+					g_string_append_len (xml_string, (const gchar*) p, 2);
+					p++;
 				}
-			}
+				break;
+			default:
+				/* A C0 control character or U+007F */
+				append_character_reference (xml_string, *p);
+				break;
 		}
-		p = next;
+
+		run = ++p;
 	}
 
 	/* Append the post content */
 	if (post != NULL)
-		g_string_append (xml_string, post);
+		g_string_append_len (xml_string, post, post_length);
 }
 
-/* TODO: Should be perfectly possible to make this modify the string in-place */
-gchar *
-gdata_parser_utf8_trim_whitespace (const gchar *s)
+/* Finds the part of @s with its leading and trailing whitespace trimmed, in a single pass over the string. Returns its start, and sets @end to the
+ * byte after its end. */
+static const gchar *
+utf8_find_trimmed (const gchar *s, const gchar **end)
 {
-	glong len;
-	const gchar *_s;
+	const gchar *i;
 
 	/* Skip the leading whitespace */
 	while (*s != '\0' && g_unichar_isspace (g_utf8_get_char (s)))
 		s = g_utf8_next_char (s);
 
-	/* Find the end of the string and backtrack until we've passed all the whitespace */
-	len = g_utf8_strlen (s, -1);
-	_s = g_utf8_offset_to_pointer (s, len - 1);
-	while (len > 0 && g_unichar_isspace (g_utf8_get_char (_s))) {
-		_s = g_utf8_prev_char (_s);
-		len--;
+	/* Keep track of the end of the last non-whitespace character */
+	*end = s;
+	for (i = s; *i != '\0'; i = g_utf8_next_char (i)) {
+		if (g_unichar_isspace (g_utf8_get_char (i)) == FALSE)
+			*end = g_utf8_next_char (i);
 	}
-	_s = g_utf8_next_char (_s);
 
-	return g_strndup (s, _s - s);
+	return s;
+}
+
+gchar *
+gdata_parser_utf8_trim_whitespace (const gchar *s)
+{
+	const gchar *start, *end;
+
+	start = utf8_find_trimmed (s, &end);
+
+	return g_strndup (start, end - start);
+}
+
+/* Trims the leading and trailing whitespace from @s by modifying it, and returns @s. */
+gchar *
+gdata_parser_utf8_trim_whitespace_in_place (gchar *s)
+{
+	const gchar *start, *end;
+
+	start = utf8_find_trimmed (s, &end);
+
+	if (start != s)
+		memmove (s, start, end - start);
+	s[end - start] = '\0';
+
+	return s;
 }
@@ -39,11 +39,21 @@ gboolean gdata_parser_error_duplicate_json_element (JsonReader *reader, GError *
 gboolean gdata_parser_error_required_json_content_missing (JsonReader *reader, GError **error);
 gboolean gdata_parser_error_not_iso8601_format_json (JsonReader *reader, const gchar *actual_value, GError **error);
 
+/* Sizes of the buffers needed by gdata_parser_date_to_buffer() and gdata_parser_int64_to_[json_]iso8601_buffer(), including the nul terminator.
+ * These leave room for the years which can't be expressed in four digits. */
+#define GDATA_PARSER_DATE_BUFFER_SIZE 32
+#define GDATA_PARSER_ISO8601_BUFFER_SIZE 64
+
 gboolean gdata_parser_int64_from_date (const gchar *date, gint64 *_time);
 gchar *gdata_parser_date_from_int64 (gint64 _time) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gsize gdata_parser_date_to_buffer (gint64 _time, gchar *buffer);
 gchar *gdata_parser_int64_to_iso8601 (gint64 _time) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gsize gdata_parser_int64_to_iso8601_buffer (gint64 _time, gchar *buffer);
 gchar *gdata_parser_int64_to_json_iso8601 (gint64 _time) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gsize gdata_parser_int64_to_json_iso8601_buffer (gint64 _time, gchar *buffer);
 gboolean gdata_parser_int64_from_iso8601 (const gchar *date, gint64 *_time);
+GTimeZone *gdata_parser_time_zone_new (const gchar *identifier) G_GNUC_WARN_UNUSED_RESULT;
+gint64 gdata_parser_int64_from_local_time (GTimeZone *time_zone, gint64 year, guint month, guint day, guint hour, guint minute, guint second);
 
 /*
  * GDataParserOptions:
@@ -71,9 +81,15 @@ typedef enum {
 typedef void (*GDataParserSetterFunc) (GDataParsable *parent_parsable, GDataParsable *parsable);
 
 gboolean gdata_parser_boolean_from_property (xmlNode *element, const gchar *property_name, gboolean *output, gint default_output, GError **error);
+gboolean gdata_parser_int64_from_property (xmlNode *element, const gchar *property_name, gint64 *output, GError **error);
+gboolean gdata_parser_int64_time_from_property (xmlNode *element, const gchar *property_name, gboolean required, gint64 *output, gboolean *is_date,
+                                                GError **error);
+const gchar *gdata_parser_intern_property (xmlNode *element, const gchar *property_name);
 
 gboolean gdata_parser_is_namespace (xmlNode *element, const gchar *namespace_uri);
 
+xmlChar *gdata_parser_take_element_content (xmlNode *element) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
 gboolean gdata_parser_string_from_element (xmlNode *element, const gchar *element_name, GDataParserOptions options,
                                            gchar **output, gboolean *success, GError **error);
 gboolean gdata_parser_int64_time_from_element (xmlNode *element, const gchar *element_name, GDataParserOptions options,
@@ -85,6 +101,96 @@ gboolean gdata_parser_object_from_element_setter (xmlNode *element, const gchar
                                                   gboolean *success, GError **error);
 gboolean gdata_parser_object_from_element (xmlNode *element, const gchar *element_name, GDataParserOptions options, GType object_type,
                                            gpointer /* GDataParsable ** */ _output, gboolean *success, GError **error);
+typedef gboolean (*GDataParserElementFunc) (GDataParsable *parsable, xmlDoc *doc, xmlNode *element, gpointer user_data, GError **error);
+
+/*
+ * GDataParserSchemaType:
+ * @P_SCHEMA_STRING: the element's content is a string, parsed as by gdata_parser_string_from_element()
+ * @P_SCHEMA_STRING_ATTRIBUTE: the element is empty, and has a required non-empty string attribute; it may appear at most once
+ * @P_SCHEMA_INT64_TIME: the element's content is an ISO 8601 time, parsed as by gdata_parser_int64_time_from_element()
+ * @P_SCHEMA_OBJECT: the element is a child #GDataParsable, parsed as by gdata_parser_object_from_element()
+ * @P_SCHEMA_OBJECT_SETTER: the element is a child #GDataParsable, parsed as by gdata_parser_object_from_element_setter()
+ * @P_SCHEMA_FUNC: the element is parsed by a #GDataParserElementFunc
+ *
+ * The types of element which can be described by a #GDataParserSchemaElement.
+ *
+ * Since: 0.15.0
+ */
+typedef enum {
+	P_SCHEMA_STRING,
+	P_SCHEMA_STRING_ATTRIBUTE,
+	P_SCHEMA_INT64_TIME,
+	P_SCHEMA_OBJECT,
+	P_SCHEMA_OBJECT_SETTER,
+	P_SCHEMA_FUNC
+} GDataParserSchemaType;
+
+typedef void (*GDataParserSchemaGetXmlFunc) (GDataParsable *parsable, GString *xml_string);
+
+/*
+ * GDataParserSchemaElement:
+ * @namespace_uri: the namespace URI of the element, or %NULL to terminate the schema
+ * @element_name: the name of the element
+ * @qualified_name: the prefixed name of the element for gdata_parser_get_xml_from_schema(), or %NULL if it isn't output from the schema
+ * @type: the type of the element
+ * @options: a bitwise combination of parsing options from #GDataParserOptions, or %P_NONE
+ * @private_offset: the offset of the output field in the parsable's private structure, as given by G_STRUCT_OFFSET(), for the types which have
+ * an output field
+ * @attribute_name: the name of the attribute holding the value of a %P_SCHEMA_STRING_ATTRIBUTE element, or %NULL
+ * @get_object_type: the <function>get_type</function> function of the object type for %P_SCHEMA_OBJECT and %P_SCHEMA_OBJECT_SETTER elements, or
+ * %NULL
+ * @func: a #GDataParserSetterFunc for %P_SCHEMA_OBJECT_SETTER elements, or a #GDataParserElementFunc for %P_SCHEMA_FUNC elements, or %NULL
+ * @get_xml: a function to output a %P_SCHEMA_FUNC element in gdata_parser_get_xml_from_schema(), or %NULL
+ *
+ * A declarative description of an element which a #GDataParsable subclass parses, and optionally outputs. A class lists its elements in a
+ * static array of these, terminated by %P_SCHEMA_END, and registers it using gdata_parser_register_schema() in its
+ * <function>class_init</function> function. The P_SCHEMA_*() macros should be used to build the array, rather than initialising the structure
+ * directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	const gchar *namespace_uri;
+	const gchar *element_name;
+	const gchar *qualified_name;
+	GDataParserSchemaType type;
+	GDataParserOptions options;
+	gsize private_offset;
+	const gchar *attribute_name;
+	GType (*get_object_type) (void);
+	gpointer func;
+	GDataParserSchemaGetXmlFunc get_xml;
+} GDataParserSchemaElement;
+
+#define P_SCHEMA_STRING_ELEMENT(NS, Name, QName, Options, Struct, Field) \
+	{ (NS), (Name), (QName), P_SCHEMA_STRING, (Options), G_STRUCT_OFFSET (Struct, Field), NULL, NULL, NULL, NULL }
+#define P_SCHEMA_STRING_ATTRIBUTE_ELEMENT(NS, Name, QName, Attribute, Struct, Field) \
+	{ (NS), (Name), (QName), P_SCHEMA_STRING_ATTRIBUTE, P_NONE, G_STRUCT_OFFSET (Struct, Field), (Attribute), NULL, NULL, NULL }
+#define P_SCHEMA_INT64_TIME_ELEMENT(NS, Name, QName, Options, Struct, Field) \
+	{ (NS), (Name), (QName), P_SCHEMA_INT64_TIME, (Options), G_STRUCT_OFFSET (Struct, Field), NULL, NULL, NULL, NULL }
+#define P_SCHEMA_OBJECT_ELEMENT(NS, Name, QName, Options, GetType, Struct, Field) \
+	{ (NS), (Name), (QName), P_SCHEMA_OBJECT, (Options), G_STRUCT_OFFSET (Struct, Field), NULL, (GetType), NULL, NULL }
+#define P_SCHEMA_OBJECT_SETTER_ELEMENT(NS, Name, Options, GetType, Setter) \
+	{ (NS), (Name), NULL, P_SCHEMA_OBJECT_SETTER, (Options), 0, NULL, (GetType), (gpointer) (Setter), NULL }
+#define P_SCHEMA_FUNC_ELEMENT(NS, Name, QName, Func, GetXml) \
+	{ (NS), (Name), (QName), P_SCHEMA_FUNC, P_NONE, 0, NULL, NULL, (gpointer) (Func), (GetXml) }
+#define P_SCHEMA_END \
+	{ NULL, NULL, NULL, P_SCHEMA_FUNC, P_NONE, 0, NULL, NULL, NULL, NULL }
+
+void gdata_parser_register_string (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserOptions options,
+                                   gsize private_offset);
+void gdata_parser_register_int64_time (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserOptions options,
+                                       gsize private_offset);
+void gdata_parser_register_object (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserOptions options,
+                                   GType object_type, gsize private_offset);
+void gdata_parser_register_object_setter (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserOptions options,
+                                          GType object_type, gpointer /* GDataParserSetterFunc */ _setter);
+void gdata_parser_register_func (GType parsable_type, const gchar *namespace_uri, const gchar *element_name, GDataParserElementFunc func);
+void gdata_parser_register_schema (GType parsable_type, const GDataParserSchemaElement *schema);
+gboolean gdata_parser_dispatch_element (GType parsable_type, GDataParsable *parsable, xmlDoc *doc, xmlNode *element, gpointer user_data,
+                                        gboolean *success, GError **error);
+void gdata_parser_get_xml_from_schema (GDataParsable *parsable, GType parsable_type, const GDataParserSchemaElement *schema, GString *xml_string);
+
 gboolean gdata_parser_string_from_json_member (JsonReader *reader, const gchar *member_name, GDataParserOptions options,
                                                gchar **output, gboolean *success, GError **error);
 gboolean gdata_parser_int64_time_from_json_member (JsonReader *reader, const gchar *member_name, GDataParserOptions options,
@@ -94,6 +200,7 @@ gboolean gdata_parser_boolean_from_json_member (JsonReader *reader, const gchar
 
 void gdata_parser_string_append_escaped (GString *xml_string, const gchar *pre, const gchar *element_content, const gchar *post);
 gchar *gdata_parser_utf8_trim_whitespace (const gchar *s) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gchar *gdata_parser_utf8_trim_whitespace_in_place (gchar *s);
 
 G_END_DECLS
 
@@ -0,0 +1,629 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-poll-scheduler
+ * @short_description: GData adaptive feed polling
+ * @stability: Unstable
+ * @include: gdata/gdata-poll-scheduler.h
+ *
+ * #GDataPollScheduler decides when to poll feeds for changes, for feeds which can't be watched with a #GDataWatchChannel. Rather than polling each
+ * feed at a fixed interval, it polls each one about as often as it's been seen to change: each poll which finds the feed unchanged lengthens the
+ * feed's interval by half, up to #GDataPollScheduler:max-interval, and each poll which finds it changed halves the interval, down to
+ * #GDataPollScheduler:min-interval. Feeds which rarely change are therefore rarely polled.
+ *
+ * Whether a feed has changed is found out from the queries made for it with gdata_service_query() (or its asynchronous version) on the scheduler's
+ * #GDataService: a %SOUP_STATUS_NOT_MODIFIED response to a conditional query means it hasn't. Queries are only made conditional if the service has
+ * a #GDataService:cache-directory, or if the query's #GDataQuery:etag is set, so one of those is needed for the intervals to adapt. A query made
+ * for a feed counts as a poll of it whether or not it was started by the scheduler, and feeds are matched by their query URIs, so any #GDataQuery
+ * with the same parameters (other than the ETag) will do.
+ *
+ * To avoid polls of many feeds happening at once (for example, after all the feeds for many accounts have been added together), each feed's first
+ * poll is at a random point in its first interval, and each later poll is made up to a tenth of the interval earlier or later than it would
+ * otherwise be.
+ *
+ * The #GDataPollSchedulerCallback for each feed is called in the thread-default main context of the thread the scheduler was created in, and
+ * gdata_poll_scheduler_add_feed() and gdata_poll_scheduler_remove_feed() must only be called from that thread. The queries themselves may be made
+ * from any thread.
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-poll-scheduler.h"
+#include "gdata-private.h"
+
+#define DEFAULT_MIN_INTERVAL (5 * 60) /* seconds */
+#define DEFAULT_MAX_INTERVAL (24 * 60 * 60) /* seconds */
+
+/* A feed added with gdata_poll_scheduler_add_feed() */
+typedef struct {
+	GDataPollScheduler *scheduler; /* unowned */
+	guint id;
+	gchar *key; /* the feed's query URI, which identifies the queries made for it */
+	gchar *feed_uri;
+	GDataQuery *query;
+	GDataPollSchedulerCallback callback;
+	gpointer user_data;
+	GDestroyNotify destroy_user_data;
+
+	guint interval; /* seconds */
+	GSource *source; /* timeout for the next poll */
+} PolledFeed;
+
+static void gdata_poll_scheduler_dispose (GObject *object);
+static void gdata_poll_scheduler_finalize (GObject *object);
+static void gdata_poll_scheduler_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_poll_scheduler_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataPollSchedulerPrivate {
+	GDataService *service;
+	GMainContext *context; /* the thread-default context when the scheduler was created */
+
+	GMutex mutex; /* protects all the members below */
+	guint min_interval;
+	guint max_interval;
+	GHashTable *feeds; /* feed ID → PolledFeed */
+	GHashTable *feeds_by_key; /* query URI → GSList of PolledFeed */
+	guint next_feed_id;
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_MIN_INTERVAL,
+	PROP_MAX_INTERVAL,
+};
+
+G_DEFINE_TYPE (GDataPollScheduler, gdata_poll_scheduler, G_TYPE_OBJECT)
+
+static void
+gdata_poll_scheduler_class_init (GDataPollSchedulerClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataPollSchedulerPrivate));
+
+	gobject_class->dispose = gdata_poll_scheduler_dispose;
+	gobject_class->finalize = gdata_poll_scheduler_finalize;
+	gobject_class->get_property = gdata_poll_scheduler_get_property;
+	gobject_class->set_property = gdata_poll_scheduler_set_property;
+
+	/**
+	 * GDataPollScheduler:service:
+	 *
+	 * The service whose queries are used to find out how often each feed changes.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service whose queries are used to find out how often each feed changes.",
+	                                                      GDATA_TYPE_SERVICE,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataPollScheduler:min-interval:
+	 *
+	 * The shortest interval, in seconds, at which any feed is polled. Newly added feeds start off being polled at this interval.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MIN_INTERVAL,
+	                                 g_param_spec_uint ("min-interval",
+	                                                    "Minimum interval", "The shortest interval at which any feed is polled.",
+	                                                    1, G_MAXUINT, DEFAULT_MIN_INTERVAL,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataPollScheduler:max-interval:
+	 *
+	 * The longest interval, in seconds, at which any feed is polled, however rarely it changes. If this is less than
+	 * #GDataPollScheduler:min-interval, the minimum interval is used for all feeds.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MAX_INTERVAL,
+	                                 g_param_spec_uint ("max-interval",
+	                                                    "Maximum interval", "The longest interval at which any feed is polled.",
+	                                                    1, G_MAXUINT, DEFAULT_MAX_INTERVAL,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+polled_feed_free (PolledFeed *feed)
+{
+	if (feed->source != NULL) {
+		g_source_destroy (feed->source);
+		g_source_unref (feed->source);
+	}
+
+	if (feed->destroy_user_data != NULL)
+		feed->destroy_user_data (feed->user_data);
+
+	g_free (feed->key);
+	g_free (feed->feed_uri);
+	if (feed->query != NULL)
+		g_object_unref (feed->query);
+
+	g_slice_free (PolledFeed, feed);
+}
+
+static void
+gdata_poll_scheduler_init (GDataPollScheduler *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_POLL_SCHEDULER, GDataPollSchedulerPrivate);
+
+	g_mutex_init (&(self->priv->mutex));
+	self->priv->min_interval = DEFAULT_MIN_INTERVAL;
+	self->priv->max_interval = DEFAULT_MAX_INTERVAL;
+	self->priv->feeds = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) polled_feed_free);
+	self->priv->feeds_by_key = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_slist_free);
+	self->priv->next_feed_id = 1;
+
+	self->priv->context = g_main_context_ref_thread_default ();
+}
+
+static void
+gdata_poll_scheduler_dispose (GObject *object)
+{
+	GDataPollSchedulerPrivate *priv = GDATA_POLL_SCHEDULER (object)->priv;
+
+	/* Stop listening for queries before anything's torn down */
+	if (priv->service != NULL) {
+		_gdata_service_remove_poll_scheduler (priv->service, GDATA_POLL_SCHEDULER (object));
+		g_object_unref (priv->service);
+		priv->service = NULL;
+	}
+
+	g_mutex_lock (&(priv->mutex));
+	g_hash_table_remove_all (priv->feeds_by_key);
+	g_hash_table_remove_all (priv->feeds);
+	g_mutex_unlock (&(priv->mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_poll_scheduler_parent_class)->dispose (object);
+}
+
+static void
+gdata_poll_scheduler_finalize (GObject *object)
+{
+	GDataPollSchedulerPrivate *priv = GDATA_POLL_SCHEDULER (object)->priv;
+
+	g_hash_table_destroy (priv->feeds_by_key);
+	g_hash_table_destroy (priv->feeds);
+	g_main_context_unref (priv->context);
+	g_mutex_clear (&(priv->mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_poll_scheduler_parent_class)->finalize (object);
+}
+
+static void
+gdata_poll_scheduler_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataPollScheduler *self = GDATA_POLL_SCHEDULER (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, self->priv->service);
+			break;
+		case PROP_MIN_INTERVAL:
+			g_value_set_uint (value, gdata_poll_scheduler_get_min_interval (self));
+			break;
+		case PROP_MAX_INTERVAL:
+			g_value_set_uint (value, gdata_poll_scheduler_get_max_interval (self));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_poll_scheduler_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataPollScheduler *self = GDATA_POLL_SCHEDULER (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			self->priv->service = g_value_dup_object (value);
+			_gdata_service_add_poll_scheduler (self->priv->service, self);
+			break;
+		case PROP_MIN_INTERVAL:
+			gdata_poll_scheduler_set_min_interval (self, g_value_get_uint (value));
+			break;
+		case PROP_MAX_INTERVAL:
+			gdata_poll_scheduler_set_max_interval (self, g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_poll_scheduler_new:
+ * @service: the #GDataService the feeds will be queried with
+ *
+ * Creates a new #GDataPollScheduler for feeds queried with @service. Its callbacks are dispatched in the thread-default main context of the
+ * calling thread.
+ *
+ * Return value: (transfer full): a new #GDataPollScheduler; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataPollScheduler *
+gdata_poll_scheduler_new (GDataService *service)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+
+	return g_object_new (GDATA_TYPE_POLL_SCHEDULER, "service", service, NULL);
+}
+
+/**
+ * gdata_poll_scheduler_get_service:
+ * @self: a #GDataPollScheduler
+ *
+ * Gets the #GDataPollScheduler:service property.
+ *
+ * Return value: (transfer none): the service the feeds are queried with
+ *
+ * Since: 0.15.0
+ **/
+GDataService *
+gdata_poll_scheduler_get_service (GDataPollScheduler *self)
+{
+	g_return_val_if_fail (GDATA_IS_POLL_SCHEDULER (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_poll_scheduler_get_min_interval:
+ * @self: a #GDataPollScheduler
+ *
+ * Gets the #GDataPollScheduler:min-interval property.
+ *
+ * Return value: the shortest polling interval, in seconds
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_poll_scheduler_get_min_interval (GDataPollScheduler *self)
+{
+	guint min_interval;
+
+	g_return_val_if_fail (GDATA_IS_POLL_SCHEDULER (self), 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	min_interval = self->priv->min_interval;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return min_interval;
+}
+
+/**
+ * gdata_poll_scheduler_set_min_interval:
+ * @self: a #GDataPollScheduler
+ * @min_interval: the shortest polling interval, in seconds
+ *
+ * Sets the #GDataPollScheduler:min-interval property. Feeds' intervals are brought within the new bounds after their next poll.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_poll_scheduler_set_min_interval (GDataPollScheduler *self, guint min_interval)
+{
+	g_return_if_fail (GDATA_IS_POLL_SCHEDULER (self));
+	g_return_if_fail (min_interval > 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	self->priv->min_interval = min_interval;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_object_notify (G_OBJECT (self), "min-interval");
+}
+
+/**
+ * gdata_poll_scheduler_get_max_interval:
+ * @self: a #GDataPollScheduler
+ *
+ * Gets the #GDataPollScheduler:max-interval property.
+ *
+ * Return value: the longest polling interval, in seconds
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_poll_scheduler_get_max_interval (GDataPollScheduler *self)
+{
+	guint max_interval;
+
+	g_return_val_if_fail (GDATA_IS_POLL_SCHEDULER (self), 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	max_interval = self->priv->max_interval;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return max_interval;
+}
+
+/**
+ * gdata_poll_scheduler_set_max_interval:
+ * @self: a #GDataPollScheduler
+ * @max_interval: the longest polling interval, in seconds
+ *
+ * Sets the #GDataPollScheduler:max-interval property. Feeds' intervals are brought within the new bounds after their next poll.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_poll_scheduler_set_max_interval (GDataPollScheduler *self, guint max_interval)
+{
+	g_return_if_fail (GDATA_IS_POLL_SCHEDULER (self));
+	g_return_if_fail (max_interval > 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	self->priv->max_interval = max_interval;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_object_notify (G_OBJECT (self), "max-interval");
+}
+
+static gboolean poll_due_cb (PolledFeed *feed);
+
+/* Schedules the next poll of @feed in @delay milliseconds. The scheduler's mutex must be held. */
+static void
+schedule_poll (PolledFeed *feed, guint64 delay)
+{
+	GDataPollSchedulerPrivate *priv = feed->scheduler->priv;
+
+	if (feed->source != NULL) {
+		g_source_destroy (feed->source);
+		g_source_unref (feed->source);
+	}
+
+	feed->source = g_timeout_source_new (MIN (delay, G_MAXUINT));
+	g_source_set_callback (feed->source, (GSourceFunc) poll_due_cb, feed, NULL);
+	g_source_attach (feed->source, priv->context);
+}
+
+/* Returns the delay in milliseconds until the poll after next one, spread randomly by up to a tenth of @interval either way */
+static guint64
+get_jittered_delay (guint interval)
+{
+	return (guint64) (interval * 1000.0 * g_random_double_range (0.9, 1.1));
+}
+
+static gboolean
+poll_due_cb (PolledFeed *feed)
+{
+	GDataPollScheduler *self = feed->scheduler;
+	GDataPollSchedulerPrivate *priv = self->priv;
+
+	g_mutex_lock (&(priv->mutex));
+
+	/* Ignore the timeout if the poll's been rescheduled by _gdata_poll_scheduler_record_poll() since it was dispatched */
+	if (g_main_current_source () != feed->source) {
+		g_mutex_unlock (&(priv->mutex));
+		return FALSE;
+	}
+
+	/* Schedule the next poll now, in case the poll's result never gets back to us; _gdata_poll_scheduler_record_poll() will reschedule it
+	 * if it does */
+	schedule_poll (feed, get_jittered_delay (feed->interval));
+
+	g_mutex_unlock (&(priv->mutex));
+
+	/* The callback may remove the feed, but only after we've finished with it */
+	g_object_ref (self);
+	feed->callback (self, feed->feed_uri, feed->query, feed->user_data);
+	g_object_unref (self);
+
+	return FALSE;
+}
+
+/* Returns the canonical key for queries of @feed_uri with @query. The same key is built for the queries made by _gdata_service_query(). */
+static gchar *
+build_feed_key (const gchar *feed_uri, GDataQuery *query)
+{
+	return g_strdup ((query != NULL) ? _gdata_query_peek_query_uri (query, feed_uri) : feed_uri);
+}
+
+/**
+ * gdata_poll_scheduler_add_feed:
+ * @self: a #GDataPollScheduler
+ * @feed_uri: the URI of the feed to poll
+ * @query: (allow-none): the query to poll the feed with, or %NULL
+ * @callback: a #GDataPollSchedulerCallback to call whenever the feed is due to be polled
+ * @user_data: (closure): data to pass to @callback
+ * @destroy_user_data: (allow-none): the function to call when @user_data is no longer needed, or %NULL
+ *
+ * Starts scheduling polls of the feed at @feed_uri. @callback is called whenever it's due to be polled; the first time at a random point during
+ * #GDataPollScheduler:min-interval. The query made by @callback lets the scheduler see whether the feed has changed, and adjust the interval
+ * until it's next polled.
+ *
+ * @query is reffed, and mustn't be modified while the feed is being polled, since its parameters identify the feed's queries. In particular, its
+ * #GDataQuery:etag should be left unset, so that the service's feed cache is used.
+ *
+ * Return value: an ID for the feed, for use with gdata_poll_scheduler_remove_feed()
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_poll_scheduler_add_feed (GDataPollScheduler *self, const gchar *feed_uri, GDataQuery *query, GDataPollSchedulerCallback callback,
+                               gpointer user_data, GDestroyNotify destroy_user_data)
+{
+	GDataPollSchedulerPrivate *priv;
+	PolledFeed *feed;
+	GSList *feeds;
+
+	g_return_val_if_fail (GDATA_IS_POLL_SCHEDULER (self), 0);
+	g_return_val_if_fail (feed_uri != NULL, 0);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), 0);
+	g_return_val_if_fail (callback != NULL, 0);
+
+	priv = self->priv;
+
+	feed = g_slice_new0 (PolledFeed);
+	feed->scheduler = self;
+	feed->key = build_feed_key (feed_uri, query);
+	feed->feed_uri = g_strdup (feed_uri);
+	feed->query = (query != NULL) ? g_object_ref (query) : NULL;
+	feed->callback = callback;
+	feed->user_data = user_data;
+	feed->destroy_user_data = destroy_user_data;
+
+	g_mutex_lock (&(priv->mutex));
+
+	feed->id = priv->next_feed_id++;
+	feed->interval = priv->min_interval;
+	g_hash_table_insert (priv->feeds, GUINT_TO_POINTER (feed->id), feed);
+
+	/* g_hash_table_replace() frees the old list, so steal it first */
+	feeds = g_hash_table_lookup (priv->feeds_by_key, feed->key);
+	g_hash_table_steal (priv->feeds_by_key, feed->key);
+	g_hash_table_insert (priv->feeds_by_key, g_strdup (feed->key), g_slist_prepend (feeds, feed));
+
+	/* Spread the first polls of feeds added together over the whole of their first interval */
+	schedule_poll (feed, (guint64) (feed->interval * 1000.0 * g_random_double ()));
+
+	g_mutex_unlock (&(priv->mutex));
+
+	return feed->id;
+}
+
+/**
+ * gdata_poll_scheduler_remove_feed:
+ * @self: a #GDataPollScheduler
+ * @feed_id: the ID of the feed, as returned by gdata_poll_scheduler_add_feed()
+ *
+ * Stops scheduling polls of the feed, and frees its user data.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_poll_scheduler_remove_feed (GDataPollScheduler *self, guint feed_id)
+{
+	GDataPollSchedulerPrivate *priv;
+	PolledFeed *feed;
+	GSList *feeds;
+
+	g_return_if_fail (GDATA_IS_POLL_SCHEDULER (self));
+	g_return_if_fail (feed_id != 0);
+
+	priv = self->priv;
+
+	g_mutex_lock (&(priv->mutex));
+
+	feed = g_hash_table_lookup (priv->feeds, GUINT_TO_POINTER (feed_id));
+	if (feed == NULL) {
+		g_mutex_unlock (&(priv->mutex));
+		g_warning ("Invalid feed ID %u.", feed_id);
+		return;
+	}
+
+	feeds = g_hash_table_lookup (priv->feeds_by_key, feed->key);
+	g_hash_table_steal (priv->feeds_by_key, feed->key);
+	feeds = g_slist_remove (feeds, feed);
+	if (feeds != NULL)
+		g_hash_table_insert (priv->feeds_by_key, g_strdup (feed->key), feeds);
+
+	g_hash_table_steal (priv->feeds, GUINT_TO_POINTER (feed_id));
+
+	g_mutex_unlock (&(priv->mutex));
+
+	/* Free it outside the lock, since it calls the user data's destroy function */
+	polled_feed_free (feed);
+}
+
+/**
+ * gdata_poll_scheduler_get_interval:
+ * @self: a #GDataPollScheduler
+ * @feed_id: the ID of the feed, as returned by gdata_poll_scheduler_add_feed()
+ *
+ * Gets the interval at which the feed is currently being polled, as adjusted for how often it's been seen to change.
+ *
+ * Return value: the feed's polling interval, in seconds, or <code class="literal">0</code> if @feed_id is invalid
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_poll_scheduler_get_interval (GDataPollScheduler *self, guint feed_id)
+{
+	PolledFeed *feed;
+	guint interval = 0;
+
+	g_return_val_if_fail (GDATA_IS_POLL_SCHEDULER (self), 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	feed = g_hash_table_lookup (self->priv->feeds, GUINT_TO_POINTER (feed_id));
+	if (feed != NULL)
+		interval = feed->interval;
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return interval;
+}
+
+/*
+ * _gdata_poll_scheduler_record_poll:
+ * @self: a #GDataPollScheduler
+ * @feed_uri: the URI of the feed which was queried
+ * @query: (allow-none): the query the feed was queried with, or %NULL
+ * @changed: %TRUE if the feed had changed since the cached version of it, %FALSE if it hadn't
+ *
+ * Adjusts the polling interval of any feeds being polled with the same query URI as the query just made, according to whether it found the feed
+ * changed, and schedules their next polls from now. Called by the service for each conditional query.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_poll_scheduler_record_poll (GDataPollScheduler *self, const gchar *feed_uri, GDataQuery *query, gboolean changed)
+{
+	GDataPollSchedulerPrivate *priv = self->priv;
+	gchar *key;
+	GSList *i;
+
+	key = build_feed_key (feed_uri, query);
+
+	g_mutex_lock (&(priv->mutex));
+
+	for (i = g_hash_table_lookup (priv->feeds_by_key, key); i != NULL; i = i->next) {
+		PolledFeed *feed = i->data;
+		guint64 interval;
+
+		/* Back off gradually while the feed stays the same, but catch up quickly once it starts changing */
+		if (changed == TRUE)
+			interval = feed->interval / 2;
+		else
+			interval = (guint64) feed->interval + feed->interval / 2;
+
+		feed->interval = (guint) CLAMP (interval, priv->min_interval, MAX (priv->min_interval, priv->max_interval));
+		schedule_poll (feed, get_jittered_delay (feed->interval));
+	}
+
+	g_mutex_unlock (&(priv->mutex));
+
+	g_free (key);
+}
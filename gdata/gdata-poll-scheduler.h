@@ -0,0 +1,97 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_POLL_SCHEDULER_H
+#define GDATA_POLL_SCHEDULER_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gdata/gdata-service.h>
+#include <gdata/gdata-query.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_POLL_SCHEDULER		(gdata_poll_scheduler_get_type ())
+#define GDATA_POLL_SCHEDULER(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_POLL_SCHEDULER, GDataPollScheduler))
+#define GDATA_POLL_SCHEDULER_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_POLL_SCHEDULER, GDataPollSchedulerClass))
+#define GDATA_IS_POLL_SCHEDULER(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_POLL_SCHEDULER))
+#define GDATA_IS_POLL_SCHEDULER_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_POLL_SCHEDULER))
+#define GDATA_POLL_SCHEDULER_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_POLL_SCHEDULER, GDataPollSchedulerClass))
+
+typedef struct _GDataPollSchedulerPrivate	GDataPollSchedulerPrivate;
+
+/**
+ * GDataPollScheduler:
+ *
+ * All the fields in the #GDataPollScheduler structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataPollSchedulerPrivate *priv;
+} GDataPollScheduler;
+
+/**
+ * GDataPollSchedulerClass:
+ *
+ * All the fields in the #GDataPollSchedulerClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataPollSchedulerClass;
+
+/**
+ * GDataPollSchedulerCallback:
+ * @scheduler: the #GDataPollScheduler
+ * @feed_uri: the feed URI the feed was added with
+ * @query: (allow-none): the query the feed was added with, or %NULL
+ * @user_data: (closure): user data passed to gdata_poll_scheduler_add_feed()
+ *
+ * Called when a feed added with gdata_poll_scheduler_add_feed() is due to be polled. The callback should query the feed with @feed_uri and
+ * @query, using gdata_service_query() or gdata_service_query_async().
+ *
+ * Since: 0.15.0
+ **/
+typedef void (*GDataPollSchedulerCallback) (GDataPollScheduler *scheduler, const gchar *feed_uri, GDataQuery *query, gpointer user_data);
+
+GType gdata_poll_scheduler_get_type (void) G_GNUC_CONST;
+
+GDataPollScheduler *gdata_poll_scheduler_new (GDataService *service) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataService *gdata_poll_scheduler_get_service (GDataPollScheduler *self) G_GNUC_PURE;
+
+guint gdata_poll_scheduler_get_min_interval (GDataPollScheduler *self);
+void gdata_poll_scheduler_set_min_interval (GDataPollScheduler *self, guint min_interval);
+guint gdata_poll_scheduler_get_max_interval (GDataPollScheduler *self);
+void gdata_poll_scheduler_set_max_interval (GDataPollScheduler *self, guint max_interval);
+
+guint gdata_poll_scheduler_add_feed (GDataPollScheduler *self, const gchar *feed_uri, GDataQuery *query, GDataPollSchedulerCallback callback,
+                                     gpointer user_data, GDestroyNotify destroy_user_data);
+void gdata_poll_scheduler_remove_feed (GDataPollScheduler *self, guint feed_id);
+guint gdata_poll_scheduler_get_interval (GDataPollScheduler *self, guint feed_id);
+
+G_END_DECLS
+
+#endif /* !GDATA_POLL_SCHEDULER_H */
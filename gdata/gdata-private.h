@@ -19,6 +19,7 @@
 
 #include <glib.h>
 #include <libxml/parser.h>
+#include <libxml/xmlreader.h>
 #include <libsoup/soup.h>
 
 #include <gdata/gdata-service.h>
@@ -50,18 +51,96 @@ typedef enum {
 
 #include "gdata-service.h"
 G_GNUC_INTERNAL SoupSession *_gdata_service_get_session (GDataService *self) G_GNUC_PURE;
+G_GNUC_INTERNAL void _gdata_service_claim_message (GDataService *self, SoupMessage *message);
 G_GNUC_INTERNAL SoupMessage *_gdata_service_build_message (GDataService *self, GDataAuthorizationDomain *domain, const gchar *method, const gchar *uri,
                                                            const gchar *etag, gboolean etag_if_match);
 G_GNUC_INTERNAL void _gdata_service_actually_send_message (SoupSession *session, SoupMessage *message, GCancellable *cancellable, GError **error);
+G_GNUC_INTERNAL void _gdata_service_queue_message (SoupSession *session, SoupMessage *message, GCancellable *cancellable,
+                                                   SoupSessionCallback callback, gpointer user_data);
 G_GNUC_INTERNAL guint _gdata_service_send_message (GDataService *self, SoupMessage *message, GCancellable *cancellable, GError **error);
+G_GNUC_INTERNAL void _gdata_service_send_message_async (GDataService *self, SoupMessage *message, GCancellable *cancellable,
+                                                        GAsyncReadyCallback callback, gpointer user_data);
+G_GNUC_INTERNAL guint _gdata_service_send_message_finish (GDataService *self, GAsyncResult *async_result, GError **error);
+G_GNUC_INTERNAL void _gdata_service_append_compressed (GConverter *compressor, SoupMessageBody *body, const gchar *data, gsize length,
+                                                       gboolean at_end);
+G_GNUC_INTERNAL void _gdata_service_set_request_xml (SoupMessage *message, GDataParsable *parsable, gboolean use_original_xml);
 G_GNUC_INTERNAL SoupMessage *_gdata_service_query (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query,
                                                    GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL GBytes *_gdata_service_acl_cache_lookup (GDataService *self, GDataEntry *entry) G_GNUC_WARN_UNUSED_RESULT;
+G_GNUC_INTERNAL void _gdata_service_acl_cache_insert (GDataService *self, GDataEntry *entry, const gchar *acl_uri, SoupMessage *message);
 G_GNUC_INTERNAL const gchar *_gdata_service_get_scheme (void) G_GNUC_CONST;
 G_GNUC_INTERNAL gchar *_gdata_service_build_uri (const gchar *format, ...) G_GNUC_PRINTF (1, 2) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 G_GNUC_INTERNAL guint _gdata_service_get_https_port (void);
 G_GNUC_INTERNAL gchar *_gdata_service_fix_uri_scheme (const gchar *uri) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 G_GNUC_INTERNAL GDataLogLevel _gdata_service_get_log_level (void) G_GNUC_CONST;
 G_GNUC_INTERNAL SoupSession *_gdata_service_build_session (void) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL void _gdata_service_push_callback_context (GDataService *service, GMainContext *context);
+G_GNUC_INTERNAL void _gdata_service_pop_callback_context (void);
+G_GNUC_INTERNAL GMainContext *_gdata_service_get_callback_context (void);
+G_GNUC_INTERNAL GDataService *_gdata_service_get_callback_service (void);
+G_GNUC_INTERNAL guint _gdata_service_idle_add (GMainContext *context, GSourceFunc function, gpointer data, GDestroyNotify notify);
+G_GNUC_INTERNAL guint _gdata_service_progress_idle_add (GDataService *service, GMainContext *context, GSourceFunc function, gpointer data,
+                                                        GDestroyNotify notify);
+
+#include "gdata-bandwidth-limiter.h"
+G_GNUC_INTERNAL GDataBandwidthLimiter *_gdata_service_get_upload_bandwidth_limiter (GDataService *self) G_GNUC_PURE;
+G_GNUC_INTERNAL GDataBandwidthLimiter *_gdata_service_get_download_bandwidth_limiter (GDataService *self) G_GNUC_PURE;
+
+#include "gdata-io-loop.h"
+G_GNUC_INTERNAL GDataIOLoop *_gdata_service_get_io_loop (GDataService *self, GError **error);
+
+#include "gdata-buffer.h"
+G_GNUC_INTERNAL void _gdata_service_add_stream (GDataService *self, GDataOperationType operation_type);
+G_GNUC_INTERNAL void _gdata_service_remove_stream (GDataService *self, GDataOperationType operation_type);
+G_GNUC_INTERNAL void _gdata_service_count_buffer (GDataService *self, GDataOperationType operation_type, GDataBuffer *buffer);
+
+#include "gdata-poll-scheduler.h"
+G_GNUC_INTERNAL void _gdata_service_add_poll_scheduler (GDataService *self, GDataPollScheduler *scheduler);
+G_GNUC_INTERNAL void _gdata_service_remove_poll_scheduler (GDataService *self, GDataPollScheduler *scheduler);
+G_GNUC_INTERNAL void _gdata_poll_scheduler_record_poll (GDataPollScheduler *self, const gchar *feed_uri, GDataQuery *query, gboolean changed);
+
+#include "gdata-cache-manager.h"
+
+/* How readily a cache registered with _gdata_cache_manager_register() gives up memory: caches of lower priority are evicted from first */
+typedef enum {
+	GDATA_CACHE_PRIORITY_LOW = 0, /* cheap to refill, such as downloaded images which are also cached on disk */
+	GDATA_CACHE_PRIORITY_NORMAL,
+	GDATA_CACHE_PRIORITY_DISK, /* held on disk rather than in memory: counted against the budget, but left alone on low memory warnings */
+} GDataCachePriority;
+
+/* The functions the cache manager uses to measure and evict from a registered cache. They're called with the manager's lock held, so must take
+ * the cache's own lock, and the cache must never call into the manager with its own lock held. */
+typedef struct {
+	/* Returns the approximate number of bytes held by the cache, and its number of items in *n_items */
+	gsize (*get_size) (gpointer cache, guint *n_items);
+	/* Returns the monotonic time at which the cache's least recently used item was last used, or G_MAXINT64 if it's empty */
+	gint64 (*get_oldest_use) (gpointer cache);
+	/* Evicts the cache's least recently used item, returning the approximate number of bytes freed, or 0 if it's empty */
+	gsize (*evict_oldest) (gpointer cache);
+} GDataCacheFuncs;
+
+typedef struct _GDataCacheRegistration GDataCacheRegistration;
+
+G_GNUC_INTERNAL GDataCacheRegistration *_gdata_cache_manager_register (const gchar *name, GDataCachePriority priority, const GDataCacheFuncs *funcs,
+                                                                       gpointer cache);
+G_GNUC_INTERNAL void _gdata_cache_manager_unregister (GDataCacheRegistration *registration);
+G_GNUC_INTERNAL void _gdata_cache_manager_record_lookup (GDataCacheRegistration *registration, gboolean hit);
+G_GNUC_INTERNAL void _gdata_cache_manager_cache_grown (GDataCacheRegistration *registration);
+
+#include "gdata-blob-store.h"
+
+typedef struct _GDataBlobWriter GDataBlobWriter;
+
+G_GNUC_INTERNAL GDataBlobStore *_gdata_service_dup_blob_store (GDataService *self) G_GNUC_WARN_UNUSED_RESULT;
+
+G_GNUC_INTERNAL GBytes *_gdata_blob_store_lookup_uri_latest (GDataBlobStore *self, const gchar *uri, gchar **etag,
+                                                             gchar **content_type) G_GNUC_WARN_UNUSED_RESULT;
+G_GNUC_INTERNAL void _gdata_blob_store_record_lookup (GDataBlobStore *self, gboolean hit);
+G_GNUC_INTERNAL GDataBlobWriter *_gdata_blob_store_begin_write (GDataBlobStore *self, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+G_GNUC_INTERNAL gboolean _gdata_blob_writer_write (GDataBlobWriter *writer, gconstpointer data, gsize length, GError **error);
+G_GNUC_INTERNAL void _gdata_blob_writer_abort (GDataBlobWriter *writer);
+G_GNUC_INTERNAL gchar *_gdata_blob_writer_commit (GDataBlobWriter *writer, const gchar *uri, const gchar *etag, const gchar *content_type,
+                                                  GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
 typedef gchar *GDataSecureString;
 typedef const gchar *GDataConstSecureString;
@@ -70,45 +149,182 @@ G_GNUC_INTERNAL GDataSecureString _gdata_service_secure_strdup (const gchar *str
 G_GNUC_INTERNAL GDataSecureString _gdata_service_secure_strndup (const gchar *str, gsize n_bytes) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 G_GNUC_INTERNAL void _gdata_service_secure_strfree (GDataSecureString str);
 
+#include "gdata-authorizer.h"
+G_GNUC_INTERNAL void _gdata_authorizer_set_expiry_time (GDataAuthorizer *self, gint64 expires_in);
+G_GNUC_INTERNAL gboolean _gdata_authorizer_is_expiring (GDataAuthorizer *self);
+G_GNUC_INTERNAL gboolean _gdata_authorizer_check_state (GVariant *state, const gchar *type_name, guint32 version, GError **error);
+
+#include "gdata-deadline.h"
+G_GNUC_INTERNAL gboolean _gdata_cancellable_shed_past_deadline (GCancellable *cancellable, gint64 time);
+
+#include "gdata-download-stream.h"
+G_GNUC_INTERNAL const gchar *_gdata_download_stream_get_etag (GDataDownloadStream *self) G_GNUC_PURE;
+
 #include "gdata-query.h"
 G_GNUC_INTERNAL void _gdata_query_set_next_uri (GDataQuery *self, const gchar *next_uri);
 G_GNUC_INTERNAL void _gdata_query_set_previous_uri (GDataQuery *self, const gchar *previous_uri);
+G_GNUC_INTERNAL void _gdata_query_set_next_page_token (GDataQuery *self, const gchar *next_page_token);
+G_GNUC_INTERNAL const gchar *_gdata_query_get_page_token (GDataQuery *self) G_GNUC_PURE;
+G_GNUC_INTERNAL const gchar *_gdata_query_peek_query_uri (GDataQuery *self, const gchar *feed_uri);
+G_GNUC_INTERNAL gchar *_gdata_query_build_page_uri (GDataQuery *self, const gchar *feed_uri, guint start_index, guint max_results);
+G_GNUC_INTERNAL gchar *_gdata_query_get_entry_fields (GDataQuery *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL GDataQuery *_gdata_query_copy (GDataQuery *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL GDataUnhandledXmlMode _gdata_query_get_parse_mode (GDataQuery *self) G_GNUC_PURE;
+G_GNUC_INTERNAL const gchar *_gdata_query_get_page_etag (GDataQuery *self, const gchar *query_uri) G_GNUC_PURE;
+G_GNUC_INTERNAL GDataFeed *_gdata_query_get_page_feed (GDataQuery *self, const gchar *query_uri) G_GNUC_PURE;
+G_GNUC_INTERNAL void _gdata_query_store_page (GDataQuery *self, const gchar *query_uri, GDataFeed *feed);
+G_GNUC_INTERNAL void _gdata_query_restore_page (GDataQuery *self, const gchar *query_uri);
 
 #include "gdata-parsable.h"
+/* Options used for all libxml parses. NONET stops documents from causing network access (e.g. for external DTDs), and COMPACT stores short text
+ * nodes inline in the node, saving an allocation each; gdata_parser_take_element_content() knows not to steal those. */
+#define GDATA_XML_PARSE_OPTIONS (XML_PARSE_NONET | XML_PARSE_COMPACT)
+/* Flag which can be set in the GDataUnhandledXmlMode passed to the _gdata_*_new_from_xml_*() functions (and so in the _private field of the parsed
+ * document, alongside the mode) to leave heavy child subtrees unparsed until they're needed. See _gdata_parsable_defer_xml(). */
+#define GDATA_PARSE_LAZY_SUBTREES (1 << 16)
+G_GNUC_INTERNAL void _gdata_parsable_init_libxml (void);
+G_GNUC_INTERNAL xmlDoc *_gdata_parsable_read_xml (const gchar *xml, gint length, gint options) G_GNUC_WARN_UNUSED_RESULT;
 G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_from_xml (GType parsable_type, const gchar *xml, gint length, gpointer user_data,
                                                              GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_from_xml_node (GType parsable_type, xmlDoc *doc, xmlNode *node, gpointer user_data,
                                                                   GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_from_xml_reader (GType parsable_type, xmlTextReader *reader,
+                                                                    GDataUnhandledXmlMode unhandled_xml_mode, gpointer user_data,
+                                                                    GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+typedef struct _GDataParsableReader GDataParsableReader;
+G_GNUC_INTERNAL GDataParsableReader *_gdata_parsable_reader_new (GType parsable_type, xmlTextReader *reader, GDataUnhandledXmlMode unhandled_xml_mode,
+                                                                 gpointer user_data, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+G_GNUC_INTERNAL gboolean _gdata_parsable_reader_step (GDataParsableReader *self, guint max_children, gint64 end_time, gboolean *finished,
+                                                      GError **error);
+G_GNUC_INTERNAL GDataParsable *_gdata_parsable_reader_finish (GDataParsableReader *self, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+G_GNUC_INTERNAL void _gdata_parsable_reader_free (GDataParsableReader *self);
+G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_from_xml_stream (GType parsable_type, const gchar *xml, gint length, gpointer user_data,
+                                                                    GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_from_xml_input (GType parsable_type, xmlInputReadCallback read_callback, gpointer read_user_data,
+                                                                   GDataUnhandledXmlMode unhandled_xml_mode, gboolean retain_original_xml,
+                                                                   gpointer user_data, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL gboolean _gdata_parsable_is_deferring_xml (xmlDoc *doc) G_GNUC_PURE;
+G_GNUC_INTERNAL void _gdata_parsable_defer_xml (xmlDoc **deferred_doc, xmlDoc *doc, xmlNode *node);
+G_GNUC_INTERNAL void _gdata_parsable_parse_deferred_xml (GDataParsable *self, xmlDoc **deferred_doc);
 G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_from_json (GType parsable_type, const gchar *json, gint length, gpointer user_data,
                                                               GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_from_json_node (GType parsable_type, JsonReader *reader, gpointer user_data,
                                                                    GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_from_json_object (GType parsable_type, JsonObject *object, gpointer user_data,
+                                                                     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_from_json_stream (GType parsable_type, const gchar *json, gint length, const gchar *streamed_member,
+                                                                     gpointer user_data, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+G_GNUC_INTERNAL JsonNode *_gdata_parsable_get_json_member (GDataParsable *self, const gchar *member_name) G_GNUC_PURE;
 G_GNUC_INTERNAL void _gdata_parsable_get_xml (GDataParsable *self, GString *xml_string, gboolean declare_namespaces);
+typedef void (*GDataParsableXmlSinkFunc) (const gchar *data, gsize length, gpointer user_data);
+G_GNUC_INTERNAL void _gdata_parsable_write_xml (GDataParsable *self, gboolean use_original_xml, GDataParsableXmlSinkFunc sink_func,
+                                                gpointer user_data);
+G_GNUC_INTERNAL void _gdata_parsable_get_namespaces (GDataParsable *self, GHashTable *namespaces);
+G_GNUC_INTERNAL void _gdata_parsable_class_set_dynamic_namespaces (GDataParsableClass *klass);
+typedef void (*GDataParsableCloneFunc) (GDataParsable *self, GDataParsable *clone);
+G_GNUC_INTERNAL void _gdata_parsable_class_set_clone_func (GDataParsableClass *klass, GDataParsableCloneFunc clone_func);
+typedef gboolean (*GDataParsableOriginalXmlFunc) (GDataParsable *self, GString *xml_string);
+G_GNUC_INTERNAL void _gdata_parsable_class_set_original_xml_func (GDataParsableClass *klass, GDataParsableOriginalXmlFunc original_xml_func);
+G_GNUC_INTERNAL gboolean _gdata_parsable_type_retains_original_xml (GType parsable_type);
+G_GNUC_INTERNAL gboolean _gdata_parsable_get_original_xml (GDataParsable *self, GString *xml_string);
+G_GNUC_INTERNAL void _gdata_parsable_forget_original_xml (GDataParsable *self);
+G_GNUC_INTERNAL void _gdata_parsable_swap_unhandled_data (GDataParsable *self, GDataParsable *other);
 G_GNUC_INTERNAL void _gdata_parsable_get_json (GDataParsable *self, JsonBuilder *builder);
+typedef void (*GDataParsableJsonWriteFunc) (GDataParsable *self, GString *json);
+G_GNUC_INTERNAL void _gdata_parsable_class_set_json_write_func (GDataParsableClass *klass, GDataParsableJsonWriteFunc json_write_func);
+G_GNUC_INTERNAL void _gdata_parsable_json_append_string (GString *json, const gchar *value);
+G_GNUC_INTERNAL void _gdata_parsable_json_append_member_name (GString *json, const gchar *member_name);
+G_GNUC_INTERNAL void _gdata_parsable_json_append_member_string (GString *json, const gchar *member_name, const gchar *value);
+G_GNUC_INTERNAL void _gdata_parsable_json_append_member_boolean (GString *json, const gchar *member_name, gboolean value);
 G_GNUC_INTERNAL void _gdata_parsable_string_append_escaped (GString *xml_string, const gchar *pre, const gchar *element_content, const gchar *post);
 G_GNUC_INTERNAL gboolean _gdata_parsable_is_constructed_from_xml (GDataParsable *self);
+G_GNUC_INTERNAL gboolean _gdata_parsable_is_parsing (GDataParsable *self);
+G_GNUC_INTERNAL gsize _gdata_parsable_measure (GDataParsable *self);
+G_GNUC_INTERNAL void _gdata_parsable_class_set_shareable (GDataParsableClass *klass);
+G_GNUC_INTERNAL GHashTable *_gdata_parsable_set_flyweights (GHashTable *flyweights);
+G_GNUC_INTERNAL GDataParsable *_gdata_parsable_new_shared_from_xml_node (GType parsable_type, xmlDoc *doc, xmlNode *node,
+                                                                         GError **error) G_GNUC_WARN_UNUSED_RESULT;
+G_GNUC_INTERNAL void _gdata_parsable_unshare_list (GDataParsable *owner, GList *parsables);
 
 #include "gdata-feed.h"
 G_GNUC_INTERNAL GDataFeed *_gdata_feed_new (const gchar *title, const gchar *id, gint64 updated) G_GNUC_WARN_UNUSED_RESULT;
 G_GNUC_INTERNAL GDataFeed *_gdata_feed_new_from_xml (GType feed_type, const gchar *xml, gint length, GType entry_type,
                                                      GDataQueryProgressCallback progress_callback, gpointer progress_user_data, gboolean is_async,
-                                                     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+                                                     gboolean retain_entries, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+typedef void (*GDataFeedNextLinkCallback) (const gchar *uri, gpointer user_data);
+G_GNUC_INTERNAL GDataFeed *_gdata_feed_new_from_xml_input (GType feed_type, xmlInputReadCallback read_callback, gpointer read_user_data,
+                                                           GDataUnhandledXmlMode unhandled_xml_mode, guint parse_threads, GType entry_type,
+                                                           GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                                                           gboolean is_async, gboolean retain_entries,
+                                                           GDataFeedNextLinkCallback next_link_callback, gpointer next_link_user_data,
+                                                           GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 G_GNUC_INTERNAL GDataFeed *_gdata_feed_new_from_json (GType feed_type, const gchar *json, gint length, GType entry_type,
                                                      GDataQueryProgressCallback progress_callback, gpointer progress_user_data, gboolean is_async,
-                                                     GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+                                                     gboolean retain_entries, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 G_GNUC_INTERNAL void _gdata_feed_add_entry (GDataFeed *self, GDataEntry *entry);
+G_GNUC_INTERNAL const gchar *_gdata_feed_get_next_page_token (GDataFeed *self) G_GNUC_PURE;
 G_GNUC_INTERNAL gpointer _gdata_feed_parse_data_new (GType entry_type, GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
-                                                     gboolean is_async);
+                                                     gboolean is_async, gboolean retain_entries);
 G_GNUC_INTERNAL void _gdata_feed_parse_data_free (gpointer data);
 G_GNUC_INTERNAL void _gdata_feed_call_progress_callback (GDataFeed *self, gpointer user_data, GDataEntry *entry);
+G_GNUC_INTERNAL void _gdata_feed_add_parsed_entry (GDataFeed *self, gpointer user_data, GDataEntry *entry);
 
 #include "gdata-entry.h"
 #include "gdata-batch-operation.h"
+/* Google's services reject batch requests containing more operations than this, so the batch operations which libgdata creates itself are split
+ * into requests of at most this many operations. */
+#define GDATA_BATCH_MAX_OPERATIONS_PER_REQUEST 100
 G_GNUC_INTERNAL void _gdata_entry_set_updated (GDataEntry *self, gint64 updated);
 G_GNUC_INTERNAL void _gdata_entry_set_batch_data (GDataEntry *self, guint id, GDataBatchOperationType type);
+G_GNUC_INTERNAL const gchar *_gdata_entry_get_partial_fields (GDataEntry *self) G_GNUC_PURE;
+G_GNUC_INTERNAL void _gdata_entry_set_partial_fields (GDataEntry *self, const gchar *fields);
+G_GNUC_INTERNAL void _gdata_entry_class_set_property_field (GDataEntryClass *klass, const gchar *property_name, const gchar *field);
+typedef void (*GDataEntryDiffFunc) (GDataEntry *self, GDataEntry *other, GPtrArray *changes);
+G_GNUC_INTERNAL void _gdata_entry_class_set_diff_func (GDataEntryClass *klass, GDataEntryDiffFunc diff_func);
+typedef void (*GDataEntryRefreshFunc) (GDataEntry *self, GDataEntry *other);
+G_GNUC_INTERNAL void _gdata_entry_class_set_refresh_func (GDataEntryClass *klass, GDataEntryRefreshFunc refresh_func);
+G_GNUC_INTERNAL gboolean _gdata_entry_refresh (GDataEntry *self, GDataEntry *other, gboolean minimal);
+G_GNUC_INTERNAL void _gdata_entry_mark_field_dirty (GDataEntry *self, const gchar *field);
+G_GNUC_INTERNAL const gchar **_gdata_entry_get_dirty_fields (GDataEntry *self) G_GNUC_WARN_UNUSED_RESULT;
+
+#include "gdata-upload-stream.h"
+G_GNUC_INTERNAL void _gdata_upload_stream_set_if_match (GDataUploadStream *self, const gchar *etag);
+G_GNUC_INTERNAL gchar *_gdata_upload_stream_dup_response_etag (GDataUploadStream *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+#include "gdata-upload-queue.h"
+typedef GDataUploadStream *(*GDataUploadQueueStartFunc) (GDataService *service, GDataEntry *entry, const gchar *slug, const gchar *content_type,
+                                                         GCancellable *cancellable, gpointer user_data, GError **error);
+typedef GDataEntry *(*GDataUploadQueueFinishFunc) (GDataService *service, GDataUploadStream *upload_stream, gpointer user_data, GError **error);
+G_GNUC_INTERNAL GDataUploadQueue *_gdata_upload_queue_new (GDataService *service, GType entry_type, GDataUploadQueueStartFunc start_func,
+                                                           GDataUploadQueueFinishFunc finish_func, gpointer func_data,
+                                                           GDestroyNotify func_data_destroy) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+typedef GDataFeed *(*GDataSyncQueryFunc) (GDataQuery *query, gpointer user_data, GCancellable *cancellable, GError **error);
+typedef gboolean (*GDataSyncEntryFunc) (GDataEntry *entry, gpointer user_data, GError **error);
+G_GNUC_INTERNAL gboolean _gdata_sync_run (GDataQuery *query, gint64 watermark, guint clock_skew_margin, GDataSyncQueryFunc query_func,
+                                          GDataSyncEntryFunc entry_func, gpointer user_data, GCancellable *cancellable, gint64 *new_watermark,
+                                          GError **error);
 
 #include "gdata-parser.h"
 
+#include "gdata-types.h"
+G_GNUC_INTERNAL guint32 _gdata_color_pack (const GDataColor *color) G_GNUC_PURE;
+G_GNUC_INTERNAL void _gdata_color_unpack (guint32 packed, GDataColor *color);
+G_GNUC_INTERNAL gboolean _gdata_color_parse_packed (const gchar *hexadecimal, guint32 *packed);
+G_GNUC_INTERNAL void _gdata_color_append_hexadecimal (GString *xml_string, guint32 packed);
+
+#include "services/contacts/gdata-contacts-service.h"
+G_GNUC_INTERNAL guint8 *_gdata_contacts_service_look_up_photo (GDataContactsService *self, const gchar *contact_id, const gchar *etag, gsize *length,
+                                                               gchar **content_type) G_GNUC_WARN_UNUSED_RESULT;
+G_GNUC_INTERNAL void _gdata_contacts_service_cache_photo (GDataContactsService *self, const gchar *contact_id, const gchar *etag,
+                                                          const gchar *content_type, const guint8 *data, gsize length);
+
+#include "services/calendar/gdata-calendar-event.h"
+G_GNUC_INTERNAL gint64 _gdata_calendar_event_get_original_start_time (GDataCalendarEvent *self);
+
+#include "services/picasaweb/gdata-picasaweb-user.h"
+G_GNUC_INTERNAL void _gdata_picasaweb_user_add_to_quota_current (GDataPicasaWebUser *self, gint64 delta);
+
 /**
  * _GDATA_DEFINE_AUTHORIZATION_DOMAIN:
  * @l_n: lowercase name for the authorization domain, separated by underscores
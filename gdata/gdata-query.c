@@ -37,6 +37,10 @@
  *
  * Every time a property of a #GDataQuery instance is changed, the instance's ETag will be unset.
  *
+ * As a single ETag only covers a single page of results, code which pages through large feeds repeatedly (for example, to re-synchronise a local
+ * copy of them) should set #GDataQuery:page-cache-mode instead. The query then remembers the ETag of each page it's been used to fetch, so that
+ * pages which haven't changed since they were last fetched aren't downloaded again.
+ *
  * For more information on the standard GData query parameters supported by #GDataQuery, see the <ulink type="http"
  * url="http://code.google.com/apis/gdata/docs/2.0/reference.html#Queries">online documentation</ulink>.
  **/
@@ -45,10 +49,13 @@
 #include <string.h>
 
 #include "gdata-query.h"
+#include "gdata-feed.h"
 #include "gdata-private.h"
 #include "gdata-types.h"
+#include "gdata-enums.h"
 
 static void gdata_query_finalize (GObject *object);
+static void gdata_query_notify (GObject *object, GParamSpec *pspec);
 static void gdata_query_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_query_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
 static void get_query_uri (GDataQuery *self, const gchar *feed_uri, GString *query_uri, gboolean *params_started);
@@ -70,10 +77,37 @@ struct _GDataQueryPrivate {
 	gchar *previous_uri;
 	gboolean use_next_uri;
 	gboolean use_previous_uri;
+	gchar *next_page_token; /* for JSON APIs, which paginate using tokens rather than links */
+	gboolean use_next_page_token;
 
 	gchar *etag;
+
+	GDataUnhandledXmlMode unhandled_xml_mode;
+
+	gchar *fields;
+	GDataRequestPriority priority;
+	guint parse_threads;
+	gboolean retain_entries;
+	gboolean lazy_parsing;
+
+	GDataPageCacheMode page_cache_mode;
+	GHashTable *pages; /* query URI → owned QueryPage; NULL if page_cache_mode is GDATA_PAGE_CACHE_NONE */
+
+	/* The most recently built query URI, and the feed URI it was built for; both NULL if the query has changed since. See
+	 * _gdata_query_peek_query_uri(). */
+	gchar *cached_feed_uri;
+	gchar *cached_query_uri;
 };
 
+/* A page of results which the query has fetched before; see _gdata_query_store_page() */
+typedef struct {
+	gchar *etag;
+	gchar *next_uri;
+	gchar *previous_uri;
+	gchar *next_page_token;
+	GDataFeed *feed; /* NULL unless page_cache_mode is GDATA_PAGE_CACHE_FEEDS */
+} QueryPage;
+
 enum {
 	PROP_Q = 1,
 	PROP_CATEGORIES,
@@ -85,7 +119,14 @@ enum {
 	PROP_START_INDEX,
 	PROP_IS_STRICT,
 	PROP_MAX_RESULTS,
-	PROP_ETAG
+	PROP_ETAG,
+	PROP_UNHANDLED_XML_MODE,
+	PROP_FIELDS,
+	PROP_PRIORITY,
+	PROP_PARSE_THREADS,
+	PROP_RETAIN_ENTRIES,
+	PROP_LAZY_PARSING,
+	PROP_PAGE_CACHE_MODE
 };
 
 G_DEFINE_TYPE (GDataQuery, gdata_query, G_TYPE_OBJECT)
@@ -100,6 +141,7 @@ gdata_query_class_init (GDataQueryClass *klass)
 	gobject_class->set_property = gdata_query_set_property;
 	gobject_class->get_property = gdata_query_get_property;
 	gobject_class->finalize = gdata_query_finalize;
+	gobject_class->notify = gdata_query_notify;
 
 	klass->get_query_uri = get_query_uri;
 
@@ -271,6 +313,154 @@ gdata_query_class_init (GDataQueryClass *klass)
 	                                                      "ETag", "An ETag against which to check.",
 	                                                      NULL,
 	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataQuery:unhandled-xml-mode:
+	 *
+	 * How to handle XML in the query results which isn't understood by libgdata. By default it's kept, so that it isn't lost if a resulting
+	 * entry is sent back to the server, but that costs time and memory when parsing large feeds. If the results will only be read, it can
+	 * safely be discarded.
+	 *
+	 * Unlike the other query properties, this doesn't affect the query URI, so setting it doesn't unset #GDataQuery:etag.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_UNHANDLED_XML_MODE,
+	                                 g_param_spec_enum ("unhandled-xml-mode",
+	                                                    "Unhandled XML mode", "How to handle XML in the query results which isn't understood.",
+	                                                    GDATA_TYPE_UNHANDLED_XML_MODE, GDATA_UNHANDLED_XML_KEEP,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataQuery:fields:
+	 *
+	 * A selector for the parts of the results to return, using the partial response syntax of the GData protocol. For example,
+	 * <userinput>entry(title,gd:email,link[@rel='http://schemas.google.com/contacts/2008/rel#photo'](@gd:etag))</userinput> returns only
+	 * the title, e-mail addresses and photo link of each entry in a feed. (When querying a single entry, the selector applies to the entry
+	 * itself, so would be <userinput>title,gd:email</userinput>.) This can greatly reduce the size of responses which would otherwise contain
+	 * a lot of unneeded data.
+	 *
+	 * Entries built from a response which has been restricted like this are marked as partial (see gdata_entry_is_partial()). When a partial
+	 * entry is updated using gdata_service_update_entry(), only its selected fields are changed on the server, so that the fields which weren't
+	 * downloaded aren't lost.
+	 *
+	 * For more information, see the <ulink type="http" url="https://developers.google.com/gdata/docs/2.0/reference#PartialResponse">online
+	 * documentation</ulink>.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_FIELDS,
+	                                 g_param_spec_string ("fields",
+	                                                      "Fields", "A selector for the parts of the results to return.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataQuery:priority:
+	 *
+	 * The priority of the requests made for the query. Interactive requests, such as looking up an entry which the user has just opened, go ahead
+	 * of any normal or background requests which are waiting to be sent by the same #GDataService, and can use the connections it reserves for
+	 * them (see #GDataService:reserved-connections), so they aren't held up behind a large synchronisation.
+	 *
+	 * Like #GDataQuery:unhandled-xml-mode, this doesn't affect the query URI, so setting it doesn't unset #GDataQuery:etag.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_PRIORITY,
+	                                 g_param_spec_enum ("priority",
+	                                                    "Priority", "The priority of the requests made for the query.",
+	                                                    GDATA_TYPE_REQUEST_PRIORITY, GDATA_REQUEST_PRIORITY_NORMAL,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataQuery:parse-threads:
+	 *
+	 * The number of threads to build the entries of an XML feed on in parallel. By default, entries are built one after another as the feed is
+	 * read; if this is more than <code class="literal">1</code>, they're built on that many threads at once while the feed carries on being
+	 * read, which can make parsing a feed with thousands of entries several times faster on a multi-core machine. If it's
+	 * <code class="literal">0</code>, one thread per processor is used.
+	 *
+	 * Either way, entries are added to the resulting feed, and passed to the query's progress callback, in the order they appear in the feed.
+	 *
+	 * Like #GDataQuery:unhandled-xml-mode, this doesn't affect the query URI, so setting it doesn't unset #GDataQuery:etag.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_PARSE_THREADS,
+	                                 g_param_spec_uint ("parse-threads",
+	                                                    "Parse threads", "The number of threads to build the entries of an XML feed on.",
+	                                                    0, 256, 1,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataQuery:retain-entries:
+	 *
+	 * Whether the entries in the feed returned by gdata_service_query() are kept in the feed. If this is %FALSE and a progress callback is
+	 * passed to the query, each entry is released as soon as it's been passed to the callback, and the feed only contains feed-level metadata
+	 * and links, so processing a feed of any size in the callback takes a constant amount of memory. Callers which want to keep some of the
+	 * entries must take their own references to them in the callback.
+	 *
+	 * This has no effect if there's no progress callback, since the entries would otherwise be lost, and it's ignored by
+	 * gdata_service_query_all(), which has to collect the pages' entries to deliver them in order.
+	 *
+	 * Like #GDataQuery:unhandled-xml-mode, this doesn't affect the query URI, so setting it doesn't unset #GDataQuery:etag.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_RETAIN_ENTRIES,
+	                                 g_param_spec_boolean ("retain-entries",
+	                                                       "Retain entries?", "Whether to keep the entries in the resulting feed.",
+	                                                       TRUE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataQuery:lazy-parsing:
+	 *
+	 * Whether to leave large child elements of the resulting entries unparsed until they're first needed, such as the attendees of a
+	 * #GDataCalendarEvent or the media group of a #GDataYouTubeVideo. Each such element is copied out of the response as it's read, and only
+	 * turned into objects the first time one of the accessors which depends on it (such as gdata_calendar_event_get_people() or
+	 * gdata_youtube_video_get_thumbnails()) is called. This makes queries whose results are only partly looked at (such as those filling a list
+	 * view) quicker, at the cost of a little more time for each entry whose deferred elements are eventually accessed.
+	 *
+	 * Like #GDataQuery:unhandled-xml-mode, this doesn't affect the query URI, so setting it doesn't unset #GDataQuery:etag.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_LAZY_PARSING,
+	                                 g_param_spec_boolean ("lazy-parsing",
+	                                                       "Lazy parsing?", "Whether to leave large child elements unparsed until they're needed.",
+	                                                       FALSE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataQuery:page-cache-mode:
+	 *
+	 * How the query remembers the pages of results it's been used to fetch with gdata_service_query(). #GDataQuery:etag only covers one page of
+	 * results, and is overwritten each time the query's made, so paging through a feed again (for example, to re-synchronise it) can't skip any
+	 * pages which haven't changed.
+	 *
+	 * If this is %GDATA_PAGE_CACHE_ETAGS, the ETag of each page is remembered instead, keyed by the page's query URI, so it doesn't matter
+	 * whether the page was reached by following the feeds' next and previous links, by page tokens or by setting #GDataQuery:start-index. Each
+	 * query for a page which has been fetched before is made conditional on its ETag; and if the page hasn't changed, gdata_service_query()
+	 * returns %NULL without setting an error, as it would for #GDataQuery:etag, and the query's next and previous pages are set to those from the
+	 * last time the page was fetched, so that gdata_query_next_page() carries on as normal.
+	 *
+	 * If this is %GDATA_PAGE_CACHE_FEEDS, the feed returned for each page is kept too, and gdata_service_query() returns it again (rather than
+	 * %NULL) if the page hasn't changed. This costs the memory of every page fetched, but means an unchanged page is handled exactly like a
+	 * changed one, apart from the progress callback not being called for its entries again.
+	 *
+	 * Either way, #GDataQuery:etag isn't updated by gdata_service_query(), since the pages' ETags supersede it; but if it's set explicitly, it
+	 * takes precedence. Setting this to %GDATA_PAGE_CACHE_NONE forgets all the remembered pages.
+	 *
+	 * Like #GDataQuery:unhandled-xml-mode, this doesn't affect the query URI, so setting it doesn't unset #GDataQuery:etag.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_PAGE_CACHE_MODE,
+	                                 g_param_spec_enum ("page-cache-mode",
+	                                                    "Page cache mode", "How the query remembers the pages of results it's fetched.",
+	                                                    GDATA_TYPE_PAGE_CACHE_MODE, GDATA_PAGE_CACHE_NONE,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -278,6 +468,8 @@ gdata_query_init (GDataQuery *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_QUERY, GDataQueryPrivate);
 	self->priv->updated_min = -1;
+	self->priv->parse_threads = 1;
+	self->priv->retain_entries = TRUE;
 	self->priv->updated_max = -1;
 	self->priv->published_min = -1;
 	self->priv->published_max = -1;
@@ -293,12 +485,56 @@ gdata_query_finalize (GObject *object)
 	g_free (priv->author);
 	g_free (priv->next_uri);
 	g_free (priv->previous_uri);
+	g_free (priv->next_page_token);
 	g_free (priv->etag);
+	g_free (priv->fields);
+	g_free (priv->cached_feed_uri);
+	g_free (priv->cached_query_uri);
+
+	if (priv->pages != NULL)
+		g_hash_table_destroy (priv->pages);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_query_parent_class)->finalize (object);
 }
 
+static void
+query_page_free (QueryPage *page)
+{
+	g_free (page->etag);
+	g_free (page->next_uri);
+	g_free (page->previous_uri);
+	g_free (page->next_page_token);
+	if (page->feed != NULL)
+		g_object_unref (page->feed);
+	g_slice_free (QueryPage, page);
+}
+
+static void
+invalidate_query_uri (GDataQuery *self)
+{
+	g_free (self->priv->cached_feed_uri);
+	self->priv->cached_feed_uri = NULL;
+	g_free (self->priv->cached_query_uri);
+	self->priv->cached_query_uri = NULL;
+}
+
+static void
+gdata_query_notify (GObject *object, GParamSpec *pspec)
+{
+	/* Every property of the query and its subclasses affects the query URI, apart from these. In particular, the ETag is updated each time the
+	 * query is made, and must not throw the URI away. */
+	if (strcmp (pspec->name, "etag") != 0 && strcmp (pspec->name, "unhandled-xml-mode") != 0 && strcmp (pspec->name, "priority") != 0 &&
+	    strcmp (pspec->name, "parse-threads") != 0 && strcmp (pspec->name, "lazy-parsing") != 0 &&
+	    strcmp (pspec->name, "page-cache-mode") != 0) {
+		invalidate_query_uri (GDATA_QUERY (object));
+	}
+
+	/* Chain up to the parent class */
+	if (G_OBJECT_CLASS (gdata_query_parent_class)->notify != NULL)
+		G_OBJECT_CLASS (gdata_query_parent_class)->notify (object, pspec);
+}
+
 static void
 gdata_query_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
 {
@@ -338,6 +574,27 @@ gdata_query_get_property (GObject *object, guint property_id, GValue *value, GPa
 		case PROP_ETAG:
 			g_value_set_string (value, priv->etag);
 			break;
+		case PROP_UNHANDLED_XML_MODE:
+			g_value_set_enum (value, priv->unhandled_xml_mode);
+			break;
+		case PROP_FIELDS:
+			g_value_set_string (value, priv->fields);
+			break;
+		case PROP_PRIORITY:
+			g_value_set_enum (value, priv->priority);
+			break;
+		case PROP_PARSE_THREADS:
+			g_value_set_uint (value, priv->parse_threads);
+			break;
+		case PROP_RETAIN_ENTRIES:
+			g_value_set_boolean (value, priv->retain_entries);
+			break;
+		case PROP_LAZY_PARSING:
+			g_value_set_boolean (value, priv->lazy_parsing);
+			break;
+		case PROP_PAGE_CACHE_MODE:
+			g_value_set_enum (value, priv->page_cache_mode);
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -384,6 +641,27 @@ gdata_query_set_property (GObject *object, guint property_id, const GValue *valu
 		case PROP_ETAG:
 			gdata_query_set_etag (self, g_value_get_string (value));
 			break;
+		case PROP_UNHANDLED_XML_MODE:
+			gdata_query_set_unhandled_xml_mode (self, g_value_get_enum (value));
+			break;
+		case PROP_FIELDS:
+			gdata_query_set_fields (self, g_value_get_string (value));
+			break;
+		case PROP_PRIORITY:
+			gdata_query_set_priority (self, g_value_get_enum (value));
+			break;
+		case PROP_PARSE_THREADS:
+			gdata_query_set_parse_threads (self, g_value_get_uint (value));
+			break;
+		case PROP_RETAIN_ENTRIES:
+			gdata_query_set_retain_entries (self, g_value_get_boolean (value));
+			break;
+		case PROP_LAZY_PARSING:
+			gdata_query_set_lazy_parsing (self, g_value_get_boolean (value));
+			break;
+		case PROP_PAGE_CACHE_MODE:
+			gdata_query_set_page_cache_mode (self, g_value_get_enum (value));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -471,6 +749,12 @@ get_query_uri (GDataQuery *self, const gchar *feed_uri, GString *query_uri, gboo
 		APPEND_SEP
 		g_string_append_printf (query_uri, "max-results=%u", priv->max_results);
 	}
+
+	if (priv->fields != NULL) {
+		APPEND_SEP
+		g_string_append (query_uri, "fields=");
+		g_string_append_uri_escaped (query_uri, priv->fields, NULL, FALSE);
+	}
 }
 
 /**
@@ -518,11 +802,40 @@ gdata_query_new_with_limits (const gchar *q, guint start_index, guint max_result
  *
  * The query URI is what functions like gdata_service_query() use to query the online service.
  *
+ * The URI is only rebuilt when the properties of the #GDataQuery (other than #GDataQuery:etag and those which don't appear in the URI) or its
+ * page change, or if a different @feed_uri is given, so repeatedly querying with the same #GDataQuery is cheap.
+ *
  * Return value: a query URI; free with g_free()
  **/
 gchar *
 gdata_query_get_query_uri (GDataQuery *self, const gchar *feed_uri)
 {
+	g_return_val_if_fail (GDATA_IS_QUERY (self), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+
+	return g_strdup (_gdata_query_peek_query_uri (self, feed_uri));
+}
+
+/*
+ * _gdata_query_peek_query_uri:
+ * @self: a #GDataQuery
+ * @feed_uri: the feed URI on which to build the query URI
+ *
+ * Returns the query URI which gdata_query_get_query_uri() would build, without copying it. The URI is built the first time it's needed, and then
+ * kept until one of the query's properties is changed (as signalled by #GObject::notify) or its page is changed, so that repeatedly making the same
+ * query doesn't rebuild it each time. Only the URI for the most recent @feed_uri is kept.
+ *
+ * As the parameters are always added to the URI in the same order, this also serves as a canonical key for the query, for caching the results of
+ * identical queries and coalescing them.
+ *
+ * Return value: the query URI, owned by @self and valid until the query is next changed
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+_gdata_query_peek_query_uri (GDataQuery *self, const gchar *feed_uri)
+{
+	GDataQueryPrivate *priv = self->priv;
 	GDataQueryClass *klass;
 	GString *query_uri;
 	gboolean params_started;
@@ -531,10 +844,13 @@ gdata_query_get_query_uri (GDataQuery *self, const gchar *feed_uri)
 	g_return_val_if_fail (feed_uri != NULL, NULL);
 
 	/* Check to see if we're paginating first */
-	if (self->priv->use_next_uri == TRUE)
-		return g_strdup (self->priv->next_uri);
-	if (self->priv->use_previous_uri == TRUE)
-		return g_strdup (self->priv->previous_uri);
+	if (priv->use_next_uri == TRUE)
+		return priv->next_uri;
+	if (priv->use_previous_uri == TRUE)
+		return priv->previous_uri;
+
+	if (priv->cached_query_uri != NULL && strcmp (priv->cached_feed_uri, feed_uri) == 0)
+		return priv->cached_query_uri;
 
 	klass = GDATA_QUERY_GET_CLASS (self);
 	g_assert (klass->get_query_uri != NULL);
@@ -546,7 +862,11 @@ gdata_query_get_query_uri (GDataQuery *self, const gchar *feed_uri)
 	query_uri = g_string_new (feed_uri);
 	klass->get_query_uri (self, feed_uri, query_uri, &params_started);
 
-	return g_string_free (query_uri, FALSE);
+	invalidate_query_uri (self);
+	priv->cached_feed_uri = g_strdup (feed_uri);
+	priv->cached_query_uri = g_string_free (query_uri, FALSE);
+
+	return priv->cached_query_uri;
 }
 
 /**
@@ -956,6 +1276,531 @@ gdata_query_set_etag (GDataQuery *self, const gchar *etag)
 	g_object_notify (G_OBJECT (self), "etag");
 }
 
+/**
+ * gdata_query_get_unhandled_xml_mode:
+ * @self: a #GDataQuery
+ *
+ * Gets the #GDataQuery:unhandled-xml-mode property.
+ *
+ * Return value: the mode for handling unhandled XML in the query results
+ *
+ * Since: 0.15.0
+ **/
+GDataUnhandledXmlMode
+gdata_query_get_unhandled_xml_mode (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), GDATA_UNHANDLED_XML_KEEP);
+	return self->priv->unhandled_xml_mode;
+}
+
+/**
+ * gdata_query_set_unhandled_xml_mode:
+ * @self: a #GDataQuery
+ * @mode: the new mode for handling unhandled XML
+ *
+ * Sets the #GDataQuery:unhandled-xml-mode property of the #GDataQuery to @mode.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_query_set_unhandled_xml_mode (GDataQuery *self, GDataUnhandledXmlMode mode)
+{
+	g_return_if_fail (GDATA_IS_QUERY (self));
+
+	if (self->priv->unhandled_xml_mode == mode)
+		return;
+
+	self->priv->unhandled_xml_mode = mode;
+	g_object_notify (G_OBJECT (self), "unhandled-xml-mode");
+}
+
+/**
+ * gdata_query_get_fields:
+ * @self: a #GDataQuery
+ *
+ * Gets the #GDataQuery:fields property.
+ *
+ * Return value: the partial response selector, or %NULL if it is unset
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_query_get_fields (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), NULL);
+	return self->priv->fields;
+}
+
+/**
+ * gdata_query_set_fields:
+ * @self: a #GDataQuery
+ * @fields: (allow-none): a new partial response selector, or %NULL
+ *
+ * Sets the #GDataQuery:fields property of the #GDataQuery to the new partial response selector, @fields.
+ *
+ * Set @fields to %NULL to return the full results.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_query_set_fields (GDataQuery *self, const gchar *fields)
+{
+	g_return_if_fail (GDATA_IS_QUERY (self));
+
+	g_free (self->priv->fields);
+	self->priv->fields = g_strdup (fields);
+	g_object_notify (G_OBJECT (self), "fields");
+
+	/* Our current ETag will no longer be relevant */
+	gdata_query_set_etag (self, NULL);
+}
+
+/**
+ * gdata_query_get_priority:
+ * @self: a #GDataQuery
+ *
+ * Gets the #GDataQuery:priority property.
+ *
+ * Return value: the priority of the requests made for the query
+ *
+ * Since: 0.15.0
+ **/
+GDataRequestPriority
+gdata_query_get_priority (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), GDATA_REQUEST_PRIORITY_NORMAL);
+	return self->priv->priority;
+}
+
+/**
+ * gdata_query_set_priority:
+ * @self: a #GDataQuery
+ * @priority: the new priority
+ *
+ * Sets the #GDataQuery:priority property of the #GDataQuery to @priority.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_query_set_priority (GDataQuery *self, GDataRequestPriority priority)
+{
+	g_return_if_fail (GDATA_IS_QUERY (self));
+
+	if (self->priv->priority == priority)
+		return;
+
+	self->priv->priority = priority;
+	g_object_notify (G_OBJECT (self), "priority");
+}
+
+/**
+ * gdata_query_get_parse_threads:
+ * @self: a #GDataQuery
+ *
+ * Gets the #GDataQuery:parse-threads property.
+ *
+ * Return value: the number of threads to build the entries of an XML feed on, or <code class="literal">0</code> for one per processor
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_query_get_parse_threads (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), 1);
+	return self->priv->parse_threads;
+}
+
+/**
+ * gdata_query_set_parse_threads:
+ * @self: a #GDataQuery
+ * @parse_threads: the number of threads to build the entries of an XML feed on, or <code class="literal">0</code> for one per processor
+ *
+ * Sets the #GDataQuery:parse-threads property of the #GDataQuery to @parse_threads.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_query_set_parse_threads (GDataQuery *self, guint parse_threads)
+{
+	g_return_if_fail (GDATA_IS_QUERY (self));
+	g_return_if_fail (parse_threads <= 256);
+
+	if (self->priv->parse_threads == parse_threads)
+		return;
+
+	self->priv->parse_threads = parse_threads;
+	g_object_notify (G_OBJECT (self), "parse-threads");
+}
+
+/**
+ * gdata_query_get_retain_entries:
+ * @self: a #GDataQuery
+ *
+ * Gets the #GDataQuery:retain-entries property.
+ *
+ * Return value: %TRUE if the entries are kept in the resulting feed, %FALSE if they're only passed to the progress callback
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_query_get_retain_entries (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), TRUE);
+	return self->priv->retain_entries;
+}
+
+/**
+ * gdata_query_set_retain_entries:
+ * @self: a #GDataQuery
+ * @retain_entries: %TRUE to keep the entries in the resulting feed, %FALSE to only pass them to the progress callback
+ *
+ * Sets the #GDataQuery:retain-entries property of the #GDataQuery to @retain_entries.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_query_set_retain_entries (GDataQuery *self, gboolean retain_entries)
+{
+	g_return_if_fail (GDATA_IS_QUERY (self));
+
+	retain_entries = (retain_entries == TRUE) ? TRUE : FALSE;
+
+	if (self->priv->retain_entries == retain_entries)
+		return;
+
+	self->priv->retain_entries = retain_entries;
+	g_object_notify (G_OBJECT (self), "retain-entries");
+}
+
+/**
+ * gdata_query_get_lazy_parsing:
+ * @self: a #GDataQuery
+ *
+ * Gets the #GDataQuery:lazy-parsing property.
+ *
+ * Return value: %TRUE if large child elements of the resulting entries are parsed when they're first needed, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_query_get_lazy_parsing (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), FALSE);
+	return self->priv->lazy_parsing;
+}
+
+/**
+ * gdata_query_set_lazy_parsing:
+ * @self: a #GDataQuery
+ * @lazy_parsing: %TRUE to parse large child elements of the resulting entries when they're first needed, %FALSE to parse them straight away
+ *
+ * Sets the #GDataQuery:lazy-parsing property of the #GDataQuery to @lazy_parsing.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_query_set_lazy_parsing (GDataQuery *self, gboolean lazy_parsing)
+{
+	g_return_if_fail (GDATA_IS_QUERY (self));
+
+	lazy_parsing = (lazy_parsing == TRUE) ? TRUE : FALSE;
+
+	if (self->priv->lazy_parsing == lazy_parsing)
+		return;
+
+	self->priv->lazy_parsing = lazy_parsing;
+	g_object_notify (G_OBJECT (self), "lazy-parsing");
+}
+
+/**
+ * gdata_query_get_page_cache_mode:
+ * @self: a #GDataQuery
+ *
+ * Gets the #GDataQuery:page-cache-mode property.
+ *
+ * Return value: how the query remembers the pages of results it's fetched
+ *
+ * Since: 0.15.0
+ **/
+GDataPageCacheMode
+gdata_query_get_page_cache_mode (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), GDATA_PAGE_CACHE_NONE);
+	return self->priv->page_cache_mode;
+}
+
+/**
+ * gdata_query_set_page_cache_mode:
+ * @self: a #GDataQuery
+ * @page_cache_mode: how the query should remember the pages of results it fetches
+ *
+ * Sets the #GDataQuery:page-cache-mode property of the #GDataQuery to @page_cache_mode. Any remembered pages which aren't needed by the new mode
+ * are forgotten.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_query_set_page_cache_mode (GDataQuery *self, GDataPageCacheMode page_cache_mode)
+{
+	GDataQueryPrivate *priv;
+
+	g_return_if_fail (GDATA_IS_QUERY (self));
+	g_return_if_fail (page_cache_mode >= GDATA_PAGE_CACHE_NONE && page_cache_mode <= GDATA_PAGE_CACHE_FEEDS);
+
+	priv = self->priv;
+
+	if (priv->page_cache_mode == page_cache_mode)
+		return;
+
+	if (page_cache_mode == GDATA_PAGE_CACHE_NONE) {
+		g_hash_table_destroy (priv->pages);
+		priv->pages = NULL;
+	} else if (priv->pages == NULL) {
+		priv->pages = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) query_page_free);
+	} else if (page_cache_mode == GDATA_PAGE_CACHE_ETAGS) {
+		GHashTableIter iter;
+		QueryPage *page;
+
+		/* Drop the feeds, but keep the ETags */
+		g_hash_table_iter_init (&iter, priv->pages);
+		while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &page) == TRUE)
+			g_clear_object (&(page->feed));
+	}
+
+	priv->page_cache_mode = page_cache_mode;
+	g_object_notify (G_OBJECT (self), "page-cache-mode");
+}
+
+/*
+ * _gdata_query_get_page_etag:
+ * @self: a #GDataQuery
+ * @query_uri: the query URI of the page
+ *
+ * Returns the ETag of the page at @query_uri from the last time it was fetched, if @self's #GDataQuery:page-cache-mode means it's been remembered.
+ *
+ * Return value: (allow-none): the page's ETag, owned by @self, or %NULL
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+_gdata_query_get_page_etag (GDataQuery *self, const gchar *query_uri)
+{
+	QueryPage *page;
+
+	g_return_val_if_fail (GDATA_IS_QUERY (self), NULL);
+	g_return_val_if_fail (query_uri != NULL, NULL);
+
+	if (self->priv->pages == NULL)
+		return NULL;
+
+	page = g_hash_table_lookup (self->priv->pages, query_uri);
+	return (page != NULL) ? page->etag : NULL;
+}
+
+/*
+ * _gdata_query_get_page_feed:
+ * @self: a #GDataQuery
+ * @query_uri: the query URI of the page
+ *
+ * Returns the feed for the page at @query_uri from the last time it was fetched, if #GDataQuery:page-cache-mode is %GDATA_PAGE_CACHE_FEEDS. The
+ * feed is only valid if the page hasn't changed since, as confirmed by a query conditional on _gdata_query_get_page_etag().
+ *
+ * Return value: (transfer none) (allow-none): the page's feed, or %NULL
+ *
+ * Since: 0.15.0
+ */
+GDataFeed *
+_gdata_query_get_page_feed (GDataQuery *self, const gchar *query_uri)
+{
+	QueryPage *page;
+
+	g_return_val_if_fail (GDATA_IS_QUERY (self), NULL);
+	g_return_val_if_fail (query_uri != NULL, NULL);
+
+	if (self->priv->pages == NULL)
+		return NULL;
+
+	page = g_hash_table_lookup (self->priv->pages, query_uri);
+	return (page != NULL) ? page->feed : NULL;
+}
+
+/*
+ * _gdata_query_store_page:
+ * @self: a #GDataQuery
+ * @query_uri: the query URI of the page
+ * @feed: the feed returned for the page
+ *
+ * Remembers @feed's ETag and pagination as those of the page at @query_uri (and @feed itself, if #GDataQuery:page-cache-mode is
+ * %GDATA_PAGE_CACHE_FEEDS), replacing anything remembered for it before. This is a no-op if pages aren't being remembered; and if @feed has no
+ * ETag, the page is forgotten, since there'd be nothing to revalidate it with.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_query_store_page (GDataQuery *self, const gchar *query_uri, GDataFeed *feed)
+{
+	GDataQueryPrivate *priv = self->priv;
+	QueryPage *page;
+	GDataLink *_link;
+
+	g_return_if_fail (GDATA_IS_QUERY (self));
+	g_return_if_fail (query_uri != NULL);
+	g_return_if_fail (GDATA_IS_FEED (feed));
+
+	if (priv->pages == NULL)
+		return;
+
+	if (gdata_feed_get_etag (feed) == NULL) {
+		g_hash_table_remove (priv->pages, query_uri);
+		return;
+	}
+
+	page = g_slice_new0 (QueryPage);
+	page->etag = g_strdup (gdata_feed_get_etag (feed));
+	page->next_page_token = g_strdup (_gdata_feed_get_next_page_token (feed));
+
+	_link = gdata_feed_look_up_link (feed, "next");
+	if (_link != NULL)
+		page->next_uri = g_strdup (gdata_link_get_uri (_link));
+	_link = gdata_feed_look_up_link (feed, "previous");
+	if (_link != NULL)
+		page->previous_uri = g_strdup (gdata_link_get_uri (_link));
+
+	if (priv->page_cache_mode == GDATA_PAGE_CACHE_FEEDS)
+		page->feed = g_object_ref (feed);
+
+	g_hash_table_replace (priv->pages, g_strdup (query_uri), page);
+}
+
+/*
+ * _gdata_query_restore_page:
+ * @self: a #GDataQuery
+ * @query_uri: the query URI of the page
+ *
+ * Updates the next and previous pages of @self from the page at @query_uri, as they were the last time it was fetched, in the same way as
+ * gdata_service_query() updates them from a newly-fetched feed. This is used when the page hasn't changed, so that paging through the results
+ * can carry on past it.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_query_restore_page (GDataQuery *self, const gchar *query_uri)
+{
+	QueryPage *page;
+
+	g_return_if_fail (GDATA_IS_QUERY (self));
+	g_return_if_fail (query_uri != NULL);
+
+	if (self->priv->pages == NULL)
+		return;
+
+	page = g_hash_table_lookup (self->priv->pages, query_uri);
+	if (page == NULL)
+		return;
+
+	if (page->next_uri != NULL)
+		_gdata_query_set_next_uri (self, page->next_uri);
+	if (page->previous_uri != NULL)
+		_gdata_query_set_previous_uri (self, page->previous_uri);
+	_gdata_query_set_next_page_token (self, page->next_page_token);
+}
+
+/*
+ * _gdata_query_get_parse_mode:
+ * @self: a #GDataQuery
+ *
+ * Gets the mode to parse the query's results with: its #GDataQuery:unhandled-xml-mode, with %GDATA_PARSE_LAZY_SUBTREES set if
+ * #GDataQuery:lazy-parsing is %TRUE.
+ *
+ * Return value: the parse mode to pass to _gdata_feed_new_from_xml_input()
+ *
+ * Since: 0.15.0
+ */
+GDataUnhandledXmlMode
+_gdata_query_get_parse_mode (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), GDATA_UNHANDLED_XML_KEEP);
+
+	return (GDataUnhandledXmlMode) (self->priv->unhandled_xml_mode | ((self->priv->lazy_parsing == TRUE) ? GDATA_PARSE_LAZY_SUBTREES : 0));
+}
+
+/* Returns the end of the bracketed expression starting at @p (which must point to @open), or the end of the string if it isn't closed */
+static const gchar *
+skip_brackets (const gchar *p, gchar open, gchar close)
+{
+	guint depth = 0;
+
+	for (; *p != '\0'; p++) {
+		if (*p == open) {
+			depth++;
+		} else if (*p == close && --depth == 0) {
+			return p + 1;
+		}
+	}
+
+	return p;
+}
+
+/*
+ * _gdata_query_get_entry_fields:
+ * @self: a #GDataQuery
+ *
+ * Extracts the part of the #GDataQuery:fields selector which applies to each entry of a feed: the sub-selector of its <literal>entry</literal>
+ * (or, for JSON feeds, <literal>items</literal>) element. For example, the entry selector of <userinput>title,entry(title,gd:email)</userinput>
+ * is <userinput>title,gd:email</userinput>.
+ *
+ * Return value: the entry selector, or %NULL if the selector doesn't restrict the entries' fields (or there isn't one); free with g_free()
+ *
+ * Since: 0.15.0
+ */
+gchar *
+_gdata_query_get_entry_fields (GDataQuery *self)
+{
+	const gchar *p;
+
+	g_return_val_if_fail (GDATA_IS_QUERY (self), NULL);
+
+	if (self->priv->fields == NULL)
+		return NULL;
+
+	/* Look through the top-level, comma-separated items of the selector for the entry element */
+	for (p = self->priv->fields; *p != '\0';) {
+		const gchar *item_end;
+
+		while (*p == ' ')
+			p++;
+
+		if ((strncmp (p, "entry", 5) == 0 && (p[5] == '(' || p[5] == '[')) || (strncmp (p, "items", 5) == 0 && (p[5] == '(' || p[5] == '['))) {
+			p += 5;
+
+			/* Skip any condition on which entries to return */
+			if (*p == '[')
+				p = skip_brackets (p, '[', ']');
+
+			if (*p == '(') {
+				item_end = skip_brackets (p, '(', ')');
+				if (item_end > p + 1 && *(item_end - 1) == ')')
+					return g_strndup (p + 1, item_end - p - 2);
+			}
+
+			/* The entries are selected with all their fields */
+			return NULL;
+		}
+
+		/* Move on to the next item */
+		for (item_end = p; *item_end != '\0' && *item_end != ','; item_end++) {
+			if (*item_end == '(')
+				item_end = skip_brackets (item_end, '(', ')') - 1;
+			else if (*item_end == '[')
+				item_end = skip_brackets (item_end, '[', ']') - 1;
+		}
+
+		p = (*item_end == ',') ? item_end + 1 : item_end;
+	}
+
+	return NULL;
+}
+
 void
 _gdata_query_set_next_uri (GDataQuery *self, const gchar *next_uri)
 {
@@ -976,6 +1821,81 @@ _gdata_query_set_previous_uri (GDataQuery *self, const gchar *previous_uri)
 	self->priv->use_previous_uri = FALSE;
 }
 
+void
+_gdata_query_set_next_page_token (GDataQuery *self, const gchar *next_page_token)
+{
+	g_return_if_fail (GDATA_IS_QUERY (self));
+	g_free (self->priv->next_page_token);
+	self->priv->next_page_token = g_strdup (next_page_token);
+	self->priv->use_next_page_token = FALSE;
+	invalidate_query_uri (self);
+}
+
+/*
+ * _gdata_query_get_page_token:
+ * @self: a #GDataQuery
+ *
+ * Returns the token of the page of results to query, for subclasses which query JSON APIs to add to their query URIs. This is only non-%NULL once
+ * gdata_query_next_page() has been called after querying a feed which gave a <literal>nextPageToken</literal>.
+ *
+ * Return value: (allow-none): the page token, or %NULL
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+_gdata_query_get_page_token (GDataQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_QUERY (self), NULL);
+	return (self->priv->use_next_page_token == TRUE) ? self->priv->next_page_token : NULL;
+}
+
+/*
+ * _gdata_query_build_page_uri:
+ * @self: a #GDataQuery
+ * @feed_uri: the feed URI on which to build the query URI
+ * @start_index: the one-based index of the first result in the page
+ * @max_results: the number of results in the page
+ *
+ * Builds a query URI in the same way as gdata_query_get_query_uri(), but with #GDataQuery:start-index and #GDataQuery:max-results overridden,
+ * and ignoring any pagination state. This can be used to build the URIs of several pages of a result set up front.
+ *
+ * The overrides are made by setting the properties on @self while the URI's built (without emitting notifications), so @self must not be
+ * used by any other thread at the same time. It should be a private copy of the caller's query, made with _gdata_query_copy().
+ *
+ * Return value: a query URI; free with g_free()
+ *
+ * Since: 0.15.0
+ */
+gchar *
+_gdata_query_build_page_uri (GDataQuery *self, const gchar *feed_uri, guint start_index, guint max_results)
+{
+	GDataQueryPrivate *priv = self->priv;
+	GDataQueryClass *klass;
+	GString *query_uri;
+	gboolean params_started;
+	guint old_start_index, old_max_results;
+
+	g_return_val_if_fail (GDATA_IS_QUERY (self), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+
+	klass = GDATA_QUERY_GET_CLASS (self);
+	g_assert (klass->get_query_uri != NULL);
+
+	old_start_index = priv->start_index;
+	old_max_results = priv->max_results;
+	priv->start_index = start_index;
+	priv->max_results = max_results;
+
+	params_started = (strstr (feed_uri, "?") != NULL) ? TRUE : FALSE;
+	query_uri = g_string_new (feed_uri);
+	klass->get_query_uri (self, feed_uri, query_uri, &params_started);
+
+	priv->start_index = old_start_index;
+	priv->max_results = old_max_results;
+
+	return g_string_free (query_uri, FALSE);
+}
+
 /**
  * gdata_query_next_page:
  * @self: a #GDataQuery
@@ -998,12 +1918,16 @@ gdata_query_next_page (GDataQuery *self)
 	if (priv->next_uri != NULL) {
 		priv->use_next_uri = TRUE;
 		priv->use_previous_uri = FALSE;
+	} else if (priv->next_page_token != NULL) {
+		priv->use_next_page_token = TRUE;
 	} else {
 		if (priv->start_index == 0)
 			priv->start_index++;
 		priv->start_index += priv->max_results;
 	}
 
+	invalidate_query_uri (self);
+
 	/* Our current ETag will no longer be relevant */
 	gdata_query_set_etag (self, NULL);
 }
@@ -1037,8 +1961,56 @@ gdata_query_previous_page (GDataQuery *self)
 			priv->start_index--;
 	}
 
+	invalidate_query_uri (self);
+
 	/* Our current ETag will no longer be relevant */
 	gdata_query_set_etag (self, NULL);
 
 	return TRUE;
 }
+
+/*
+ * _gdata_query_copy:
+ * @self: a #GDataQuery
+ *
+ * Creates a new query of the same type as @self, with the same parameters. The copy's #GDataQuery:etag and pagination state are not copied, so it
+ * starts from the first page of results. This is used when several independent requests need to be made with the same parameters, for example
+ * concurrently from different threads, which can't share a #GDataQuery since querying updates it.
+ *
+ * Return value: (transfer full): a new #GDataQuery; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataQuery *
+_gdata_query_copy (GDataQuery *self)
+{
+	GDataQuery *copy;
+	GParamSpec **pspecs;
+	guint n_pspecs, i;
+
+	g_return_val_if_fail (GDATA_IS_QUERY (self), NULL);
+
+	copy = g_object_new (G_OBJECT_TYPE (self), NULL);
+	pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (self), &n_pspecs);
+
+	g_object_freeze_notify (G_OBJECT (copy));
+
+	for (i = 0; i < n_pspecs; i++) {
+		GValue value = G_VALUE_INIT;
+
+		if ((pspecs[i]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE || (pspecs[i]->flags & G_PARAM_CONSTRUCT_ONLY) != 0 ||
+		    strcmp (pspecs[i]->name, "etag") == 0) {
+			continue;
+		}
+
+		g_value_init (&value, G_PARAM_SPEC_VALUE_TYPE (pspecs[i]));
+		g_object_get_property (G_OBJECT (self), pspecs[i]->name, &value);
+		g_object_set_property (G_OBJECT (copy), pspecs[i]->name, &value);
+		g_value_unset (&value);
+	}
+
+	g_object_thaw_notify (G_OBJECT (copy));
+	g_free (pspecs);
+
+	return copy;
+}
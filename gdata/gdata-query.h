@@ -23,8 +23,45 @@
 #include <glib.h>
 #include <glib-object.h>
 
+#include <gdata/gdata-parsable.h>
+
 G_BEGIN_DECLS
 
+/**
+ * GDataRequestPriority:
+ * @GDATA_REQUEST_PRIORITY_BACKGROUND: a bulk request, such as part of a synchronisation, which only goes ahead once there are no normal priority
+ * requests waiting
+ * @GDATA_REQUEST_PRIORITY_NORMAL: a normal request; this is the default
+ * @GDATA_REQUEST_PRIORITY_INTERACTIVE: a request which a user is waiting for, which goes ahead of any other requests and may use the connections
+ * reserved by #GDataService:reserved-connections
+ *
+ * Priority classes for requests made by a #GDataService. See #GDataQuery:priority.
+ *
+ * Since: 0.15.0
+ **/
+typedef enum {
+	GDATA_REQUEST_PRIORITY_BACKGROUND = -1,
+	GDATA_REQUEST_PRIORITY_NORMAL = 0,
+	GDATA_REQUEST_PRIORITY_INTERACTIVE = 1
+} GDataRequestPriority;
+
+/**
+ * GDataPageCacheMode:
+ * @GDATA_PAGE_CACHE_NONE: pages aren't remembered, and only #GDataQuery:etag is used to make queries conditional; this is the default
+ * @GDATA_PAGE_CACHE_ETAGS: the ETag of each page is remembered, and queries for a page which has been fetched before are made conditional on it
+ * @GDATA_PAGE_CACHE_FEEDS: as with %GDATA_PAGE_CACHE_ETAGS, but the feed for each page is kept as well, and returned again if the page hasn't
+ * changed
+ *
+ * How a #GDataQuery remembers the pages of results it's been used to fetch. See #GDataQuery:page-cache-mode.
+ *
+ * Since: 0.15.0
+ **/
+typedef enum {
+	GDATA_PAGE_CACHE_NONE = 0,
+	GDATA_PAGE_CACHE_ETAGS,
+	GDATA_PAGE_CACHE_FEEDS
+} GDataPageCacheMode;
+
 #define GDATA_TYPE_QUERY		(gdata_query_get_type ())
 #define GDATA_QUERY(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_QUERY, GDataQuery))
 #define GDATA_QUERY_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_QUERY, GDataQueryClass))
@@ -87,6 +124,20 @@ guint gdata_query_get_max_results (GDataQuery *self) G_GNUC_PURE;
 void gdata_query_set_max_results (GDataQuery *self, guint max_results);
 const gchar *gdata_query_get_etag (GDataQuery *self) G_GNUC_PURE;
 void gdata_query_set_etag (GDataQuery *self, const gchar *etag);
+GDataUnhandledXmlMode gdata_query_get_unhandled_xml_mode (GDataQuery *self) G_GNUC_PURE;
+void gdata_query_set_unhandled_xml_mode (GDataQuery *self, GDataUnhandledXmlMode mode);
+const gchar *gdata_query_get_fields (GDataQuery *self) G_GNUC_PURE;
+void gdata_query_set_fields (GDataQuery *self, const gchar *fields);
+GDataRequestPriority gdata_query_get_priority (GDataQuery *self) G_GNUC_PURE;
+void gdata_query_set_priority (GDataQuery *self, GDataRequestPriority priority);
+guint gdata_query_get_parse_threads (GDataQuery *self) G_GNUC_PURE;
+void gdata_query_set_parse_threads (GDataQuery *self, guint parse_threads);
+gboolean gdata_query_get_retain_entries (GDataQuery *self) G_GNUC_PURE;
+void gdata_query_set_retain_entries (GDataQuery *self, gboolean retain_entries);
+gboolean gdata_query_get_lazy_parsing (GDataQuery *self) G_GNUC_PURE;
+void gdata_query_set_lazy_parsing (GDataQuery *self, gboolean lazy_parsing);
+GDataPageCacheMode gdata_query_get_page_cache_mode (GDataQuery *self) G_GNUC_PURE;
+void gdata_query_set_page_cache_mode (GDataQuery *self, GDataPageCacheMode page_cache_mode);
 
 G_END_DECLS
 
@@ -0,0 +1,192 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SECTION:gdata-rate-limiter
+ * @short_description: GData token bucket request scheduler
+ * @stability: Unstable
+ * @include: gdata/gdata-rate-limiter.h
+ *
+ * #GDataRateLimiter is a threadsafe token bucket which schedules requests so that no more than a configured number are sent per second, while
+ * allowing a burst of requests after an idle period. Rather than blocking while a token becomes available, callers reserve the time at which their
+ * request may be sent using gdata_rate_limiter_reserve(), then wait until then. Requests are therefore scheduled in the order they were made, and
+ * asynchronous callers can wait using a timeout source rather than a thread.
+ *
+ * The rate adapts to the server's responses: each throttling response halves the rate (down to a minimum) and pauses all requests for a while, and
+ * each successful response increases it again, up to the configured rate. This keeps the rate just under the server's quota, rather than
+ * oscillating between exceeding it and backing off completely.
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-rate-limiter.h"
+
+/* The most the rate may be slowed down by throttling responses, as a fraction of the configured rate */
+#define MAX_SLOWDOWN 64.0
+/* The fraction of the configured rate which is recovered with each successful response */
+#define RECOVERY_STEP (1.0 / 16.0)
+/* The longest time to pause for after a throttling response, in seconds */
+#define MAX_PAUSE 60
+
+GDataRateLimiter *
+gdata_rate_limiter_new (void)
+{
+	GDataRateLimiter *self = g_slice_new0 (GDataRateLimiter);
+
+	g_mutex_init (&(self->mutex));
+	self->burst = 1;
+
+	return self;
+}
+
+void
+gdata_rate_limiter_free (GDataRateLimiter *self)
+{
+	g_mutex_clear (&(self->mutex));
+	g_slice_free (GDataRateLimiter, self);
+}
+
+/* Sets the rate to @rate requests per second (or no limit if it's 0), allowing bursts of up to @burst requests. This resets any adaptation to
+ * throttling responses. */
+void
+gdata_rate_limiter_set_rate (GDataRateLimiter *self, gdouble rate, guint burst)
+{
+	g_return_if_fail (rate >= 0.0);
+
+	g_mutex_lock (&(self->mutex));
+	self->rate = rate;
+	self->current_rate = rate;
+	self->burst = MAX (burst, 1);
+	g_mutex_unlock (&(self->mutex));
+}
+
+gdouble
+gdata_rate_limiter_get_rate (GDataRateLimiter *self, guint *burst)
+{
+	gdouble rate;
+
+	g_mutex_lock (&(self->mutex));
+	rate = self->rate;
+	if (burst != NULL)
+		*burst = self->burst;
+	g_mutex_unlock (&(self->mutex));
+
+	return rate;
+}
+
+gboolean
+gdata_rate_limiter_is_enabled (GDataRateLimiter *self)
+{
+	gboolean enabled;
+
+	g_mutex_lock (&(self->mutex));
+	enabled = (self->rate > 0.0) ? TRUE : FALSE;
+	g_mutex_unlock (&(self->mutex));
+
+	return enabled;
+}
+
+/* Reserves a token for a request, returning the monotonic time at which the request may be sent (which may be in the past). This is the generic cell
+ * rate algorithm: requests are spaced at the current rate, but may run up to (burst - 1) intervals ahead of that schedule. */
+gint64
+gdata_rate_limiter_reserve (GDataRateLimiter *self)
+{
+	gint64 now, interval, send_time;
+
+	now = g_get_monotonic_time ();
+
+	g_mutex_lock (&(self->mutex));
+
+	if (self->rate <= 0.0) {
+		g_mutex_unlock (&(self->mutex));
+		return now;
+	}
+
+	interval = (gint64) (G_USEC_PER_SEC / self->current_rate);
+
+	self->arrival_time = MAX (self->arrival_time, now);
+	send_time = MAX (self->arrival_time - (gint64) (self->burst - 1) * interval, now);
+	send_time = MAX (send_time, self->resume_time);
+	self->arrival_time = MAX (self->arrival_time, send_time) + interval;
+
+	g_mutex_unlock (&(self->mutex));
+
+	return send_time;
+}
+
+/* Notes that the server has asked us to slow down, optionally giving a number of seconds to wait before sending any more requests as @retry_after
+ * (or 0 if it didn't say). */
+void
+gdata_rate_limiter_throttled (GDataRateLimiter *self, guint retry_after)
+{
+	gint64 now, pause;
+
+	now = g_get_monotonic_time ();
+
+	g_mutex_lock (&(self->mutex));
+
+	if (self->rate > 0.0) {
+		self->current_rate = MAX (self->current_rate / 2.0, self->rate / MAX_SLOWDOWN);
+
+		/* Stop sending anything until the server's ready for us again; if it didn't say when that'd be, wait for one interval at the new
+		 * rate. Requests which had already been scheduled are pushed back behind the pause. */
+		pause = (retry_after > 0) ? (gint64) MIN (retry_after, MAX_PAUSE) * G_USEC_PER_SEC :
+		                            MIN ((gint64) (G_USEC_PER_SEC / self->current_rate), (gint64) MAX_PAUSE * G_USEC_PER_SEC);
+		self->resume_time = MAX (self->resume_time, now + pause);
+		self->arrival_time = MAX (self->arrival_time, self->resume_time);
+	}
+
+	g_mutex_unlock (&(self->mutex));
+}
+
+/* Notes that a request succeeded, so the rate can be increased back towards the configured rate */
+void
+gdata_rate_limiter_succeeded (GDataRateLimiter *self)
+{
+	g_mutex_lock (&(self->mutex));
+
+	if (self->current_rate < self->rate)
+		self->current_rate = MIN (self->current_rate + self->rate * RECOVERY_STEP, self->rate);
+
+	g_mutex_unlock (&(self->mutex));
+}
+
+/* Blocks until the monotonic time @time, returning %FALSE if @cancellable is cancelled first */
+gboolean
+gdata_rate_limiter_wait_until (gint64 time, GCancellable *cancellable)
+{
+	GPollFD pollfd;
+	gboolean have_pollfd;
+	gint64 now;
+
+	have_pollfd = (cancellable != NULL) ? g_cancellable_make_pollfd (cancellable, &pollfd) : FALSE;
+
+	while ((now = g_get_monotonic_time ()) < time && g_cancellable_is_cancelled (cancellable) == FALSE) {
+		if (have_pollfd == TRUE)
+			g_poll (&pollfd, 1, (gint) MIN ((time - now + 999) / 1000, G_MAXINT));
+		else
+			g_usleep (time - now);
+	}
+
+	if (have_pollfd == TRUE)
+		g_cancellable_release_fd (cancellable);
+
+	return (g_cancellable_is_cancelled (cancellable) == FALSE) ? TRUE : FALSE;
+}
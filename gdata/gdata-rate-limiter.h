@@ -0,0 +1,62 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_RATE_LIMITER_H
+#define GDATA_RATE_LIMITER_H
+
+#include <glib.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDataRateLimiter:
+ *
+ * All the fields in the #GDataRateLimiter structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GMutex mutex; /* protects all the other members */
+
+	gdouble rate; /* configured rate, in requests per second; 0 for no limit */
+	guint burst; /* number of requests which may be sent back-to-back after an idle period; always at least 1 */
+	gdouble current_rate; /* rate adapted to throttling responses; between rate / MAX_SLOWDOWN and rate */
+
+	gint64 arrival_time; /* monotonic time at which the next request would be sent if requests were evenly spaced at current_rate */
+	gint64 resume_time; /* monotonic time before which no requests may be sent, after the server asked us to back off */
+} GDataRateLimiter;
+
+GDataRateLimiter *gdata_rate_limiter_new (void) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_rate_limiter_free (GDataRateLimiter *self);
+
+void gdata_rate_limiter_set_rate (GDataRateLimiter *self, gdouble rate, guint burst);
+gdouble gdata_rate_limiter_get_rate (GDataRateLimiter *self, guint *burst);
+gboolean gdata_rate_limiter_is_enabled (GDataRateLimiter *self);
+
+gint64 gdata_rate_limiter_reserve (GDataRateLimiter *self);
+void gdata_rate_limiter_throttled (GDataRateLimiter *self, guint retry_after);
+void gdata_rate_limiter_succeeded (GDataRateLimiter *self);
+
+gboolean gdata_rate_limiter_wait_until (gint64 time, GCancellable *cancellable);
+
+G_END_DECLS
+
+#endif /* !GDATA_RATE_LIMITER_H */
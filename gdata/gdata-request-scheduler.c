@@ -0,0 +1,327 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SECTION:gdata-request-scheduler
+ * @short_description: GData request priority scheduler
+ * @stability: Unstable
+ * @include: gdata/gdata-request-scheduler.h
+ *
+ * #GDataRequestScheduler is a threadsafe admission queue which keeps connections free for interactive requests. Before a request is sent, a slot is
+ * acquired for it; after its response has been received, the slot is released. Interactive requests (%GDATA_REQUEST_PRIORITY_INTERACTIVE) are
+ * never queued, but only a limited number of other requests may be in flight at once: any more wait in the scheduler, rather than in libsoup's
+ * connection queue, with normal priority requests going ahead of background ones. If the limit is less than the number of connections libsoup
+ * may open, interactive requests therefore never have to wait for a bulk operation to finish with a connection.
+ *
+ * Blocking callers wait using gdata_request_scheduler_acquire(); asynchronous callers use gdata_request_scheduler_acquire_async(), which calls a
+ * function in their thread-default main context once a slot has been granted to them.
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-request-scheduler.h"
+
+typedef struct {
+	gboolean ready;
+
+	/* For asynchronous waiters only */
+	GMainContext *context;
+	GSourceFunc ready_func;
+	gpointer user_data;
+	GDestroyNotify notify;
+} Waiter;
+
+GDataRequestScheduler *
+gdata_request_scheduler_new (void)
+{
+	GDataRequestScheduler *self = g_slice_new0 (GDataRequestScheduler);
+
+	g_mutex_init (&(self->mutex));
+	g_cond_init (&(self->cond));
+	g_queue_init (&(self->normal_waiters));
+	g_queue_init (&(self->background_waiters));
+
+	return self;
+}
+
+static void
+waiter_free (Waiter *waiter)
+{
+	if (waiter->notify != NULL)
+		waiter->notify (waiter->user_data);
+	g_main_context_unref (waiter->context);
+	g_slice_free (Waiter, waiter);
+}
+
+void
+gdata_request_scheduler_free (GDataRequestScheduler *self)
+{
+	/* Every request holds a reference to the service, so nothing can still be waiting */
+	g_assert (g_queue_is_empty (&(self->normal_waiters)) && g_queue_is_empty (&(self->background_waiters)));
+
+	g_cond_clear (&(self->cond));
+	g_mutex_clear (&(self->mutex));
+	g_slice_free (GDataRequestScheduler, self);
+}
+
+/* Must be called with the mutex held, after either queue has changed */
+static void
+update_n_waiting (GDataRequestScheduler *self)
+{
+	g_atomic_int_set (&(self->n_waiting), (gint) (self->normal_waiters.length + self->background_waiters.length));
+}
+
+static gboolean
+has_free_slot (GDataRequestScheduler *self)
+{
+	return (self->max_active == 0 || self->n_active < self->max_active) ? TRUE : FALSE;
+}
+
+/* Grants slots to as many waiters as possible, highest priority first. Blocking waiters are woken up, and asynchronous waiters which have been granted
+ * a slot are returned, so that their ready functions can be scheduled once the mutex has been released. Must be called with the mutex held. */
+static GSList *
+grant_slots (GDataRequestScheduler *self)
+{
+	GSList *granted = NULL;
+	gboolean woke_blocking_waiter = FALSE;
+
+	while (has_free_slot (self) == TRUE) {
+		Waiter *waiter;
+
+		waiter = g_queue_pop_head (&(self->normal_waiters));
+		if (waiter == NULL)
+			waiter = g_queue_pop_head (&(self->background_waiters));
+		if (waiter == NULL)
+			break;
+
+		self->n_active++;
+		waiter->ready = TRUE;
+
+		if (waiter->ready_func != NULL)
+			granted = g_slist_prepend (granted, waiter);
+		else
+			woke_blocking_waiter = TRUE;
+	}
+
+	update_n_waiting (self);
+
+	if (woke_blocking_waiter == TRUE)
+		g_cond_broadcast (&(self->cond));
+
+	return g_slist_reverse (granted);
+}
+
+/* Calls the ready functions of asynchronous waiters returned by grant_slots(), in their own main contexts. Must be called without the mutex held. */
+static void
+dispatch_granted (GSList *granted)
+{
+	GSList *i;
+
+	for (i = granted; i != NULL; i = i->next) {
+		Waiter *waiter = i->data;
+		GSource *source;
+
+		source = g_idle_source_new ();
+		g_source_set_callback (source, waiter->ready_func, waiter->user_data, waiter->notify);
+		g_source_attach (source, waiter->context);
+		g_source_unref (source);
+
+		/* The source now owns the user data */
+		waiter->notify = NULL;
+		waiter_free (waiter);
+	}
+
+	g_slist_free (granted);
+}
+
+/* Sets the number of non-interactive requests which may be in flight at once to @max_active, or removes the limit if it's 0. Requests which are
+ * already in flight are unaffected. */
+void
+gdata_request_scheduler_set_max_active (GDataRequestScheduler *self, guint max_active)
+{
+	GSList *granted;
+
+	g_mutex_lock (&(self->mutex));
+	self->max_active = max_active;
+	granted = grant_slots (self);
+	g_mutex_unlock (&(self->mutex));
+
+	dispatch_granted (granted);
+}
+
+static GQueue *
+get_queue (GDataRequestScheduler *self, GDataRequestPriority priority)
+{
+	return (priority == GDATA_REQUEST_PRIORITY_BACKGROUND) ? &(self->background_waiters) : &(self->normal_waiters);
+}
+
+static void
+acquire_cancelled_cb (GCancellable *cancellable, GDataRequestScheduler *self)
+{
+	/* Lock the mutex so that the broadcast can't happen between the waiter checking for cancellation and starting to wait */
+	g_mutex_lock (&(self->mutex));
+	g_cond_broadcast (&(self->cond));
+	g_mutex_unlock (&(self->mutex));
+}
+
+/* Blocks until a slot is available for a request of the given @priority, then acquires it. Returns %FALSE without acquiring a slot if @cancellable is
+ * cancelled first. Each successful call must be balanced by a call to gdata_request_scheduler_release(). */
+gboolean
+gdata_request_scheduler_acquire (GDataRequestScheduler *self, GDataRequestPriority priority, GCancellable *cancellable)
+{
+	Waiter waiter = { FALSE, };
+	gulong cancelled_id = 0;
+
+	if (priority == GDATA_REQUEST_PRIORITY_INTERACTIVE)
+		return TRUE;
+
+	/* This has to be done without the mutex held, since the callback is called immediately if @cancellable's already been cancelled */
+	if (cancellable != NULL)
+		cancelled_id = g_cancellable_connect (cancellable, (GCallback) acquire_cancelled_cb, self, NULL);
+
+	g_mutex_lock (&(self->mutex));
+
+	if (has_free_slot (self) == TRUE) {
+		self->n_active++;
+		waiter.ready = TRUE;
+	} else {
+		g_queue_push_tail (get_queue (self, priority), &waiter);
+		update_n_waiting (self);
+
+		while (waiter.ready == FALSE && g_cancellable_is_cancelled (cancellable) == FALSE)
+			g_cond_wait (&(self->cond), &(self->mutex));
+
+		if (waiter.ready == FALSE) {
+			g_queue_remove (get_queue (self, priority), &waiter);
+			update_n_waiting (self);
+		}
+	}
+
+	g_mutex_unlock (&(self->mutex));
+
+	if (cancelled_id != 0)
+		g_cancellable_disconnect (cancellable, cancelled_id);
+
+	return waiter.ready;
+}
+
+/* Acquires a slot for a request of the given @priority if one is available, calling @notify on @user_data and returning %TRUE straight away.
+ * Otherwise, returns %FALSE and queues the request; once a slot has been acquired on its behalf, @ready_func is called with @user_data in the
+ * thread-default main context of the calling thread. @user_data identifies the request to gdata_request_scheduler_cancel(), so it must be unique to
+ * the request. */
+gboolean
+gdata_request_scheduler_acquire_async (GDataRequestScheduler *self, GDataRequestPriority priority, GSourceFunc ready_func, gpointer user_data,
+                                       GDestroyNotify notify)
+{
+	Waiter *waiter;
+
+	g_return_val_if_fail (ready_func != NULL, FALSE);
+
+	if (priority != GDATA_REQUEST_PRIORITY_INTERACTIVE) {
+		g_mutex_lock (&(self->mutex));
+
+		if (has_free_slot (self) == FALSE) {
+			waiter = g_slice_new0 (Waiter);
+			waiter->context = g_main_context_ref_thread_default ();
+			waiter->ready_func = ready_func;
+			waiter->user_data = user_data;
+			waiter->notify = notify;
+
+			g_queue_push_tail (get_queue (self, priority), waiter);
+			update_n_waiting (self);
+			g_mutex_unlock (&(self->mutex));
+
+			return FALSE;
+		}
+
+		self->n_active++;
+		g_mutex_unlock (&(self->mutex));
+	}
+
+	if (notify != NULL)
+		notify (user_data);
+
+	return TRUE;
+}
+
+static gint
+compare_waiter_user_data (Waiter *waiter, gpointer user_data)
+{
+	return (waiter->ready_func != NULL && waiter->user_data == user_data) ? 0 : 1;
+}
+
+/* Stops waiting for a slot for the request identified by @user_data, returning %TRUE. If a slot has already been granted to the request, %FALSE is
+ * returned instead, and the request's ready function will still be called. */
+gboolean
+gdata_request_scheduler_cancel (GDataRequestScheduler *self, gpointer user_data)
+{
+	Waiter *waiter = NULL;
+	GList *link;
+
+	g_mutex_lock (&(self->mutex));
+
+	link = g_queue_find_custom (&(self->normal_waiters), user_data, (GCompareFunc) compare_waiter_user_data);
+	if (link != NULL) {
+		waiter = link->data;
+		g_queue_delete_link (&(self->normal_waiters), link);
+	} else {
+		link = g_queue_find_custom (&(self->background_waiters), user_data, (GCompareFunc) compare_waiter_user_data);
+		if (link != NULL) {
+			waiter = link->data;
+			g_queue_delete_link (&(self->background_waiters), link);
+		}
+	}
+
+	update_n_waiting (self);
+	g_mutex_unlock (&(self->mutex));
+
+	if (waiter == NULL)
+		return FALSE;
+
+	waiter_free (waiter);
+
+	return TRUE;
+}
+
+/* Releases a slot acquired for a request of the given @priority, granting it to the next waiting request, if any */
+void
+gdata_request_scheduler_release (GDataRequestScheduler *self, GDataRequestPriority priority)
+{
+	GSList *granted;
+
+	if (priority == GDATA_REQUEST_PRIORITY_INTERACTIVE)
+		return;
+
+	g_mutex_lock (&(self->mutex));
+	g_assert (self->n_active > 0);
+	self->n_active--;
+	granted = grant_slots (self);
+	g_mutex_unlock (&(self->mutex));
+
+	dispatch_granted (granted);
+}
+
+/* Returns the number of requests which are currently waiting for a slot. This doesn't take the mutex, so can be called from any thread cheaply,
+ * but the value may be out of date by the time it's returned. */
+guint
+gdata_request_scheduler_get_n_waiting (GDataRequestScheduler *self)
+{
+	return (guint) g_atomic_int_get (&(self->n_waiting));
+}
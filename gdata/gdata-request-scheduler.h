@@ -0,0 +1,65 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_REQUEST_SCHEDULER_H
+#define GDATA_REQUEST_SCHEDULER_H
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "gdata-query.h"
+
+G_BEGIN_DECLS
+
+/**
+ * GDataRequestScheduler:
+ *
+ * All the fields in the #GDataRequestScheduler structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GMutex mutex; /* protects all the other members */
+	GCond cond; /* signalled when a blocking waiter is granted a slot or cancelled */
+
+	guint max_active; /* number of non-interactive requests which may be in flight at once; 0 for no limit */
+	guint n_active; /* number of non-interactive requests in flight */
+
+	GQueue normal_waiters; /* queue of waiters for a slot, in the order they arrived */
+	GQueue background_waiters;
+	volatile gint n_waiting; /* total length of the two queues; updated with the mutex held, but read atomically without it */
+} GDataRequestScheduler;
+
+GDataRequestScheduler *gdata_request_scheduler_new (void) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_request_scheduler_free (GDataRequestScheduler *self);
+
+void gdata_request_scheduler_set_max_active (GDataRequestScheduler *self, guint max_active);
+
+gboolean gdata_request_scheduler_acquire (GDataRequestScheduler *self, GDataRequestPriority priority, GCancellable *cancellable);
+gboolean gdata_request_scheduler_acquire_async (GDataRequestScheduler *self, GDataRequestPriority priority, GSourceFunc ready_func,
+                                                gpointer user_data, GDestroyNotify notify);
+gboolean gdata_request_scheduler_cancel (GDataRequestScheduler *self, gpointer user_data);
+void gdata_request_scheduler_release (GDataRequestScheduler *self, GDataRequestPriority priority);
+
+guint gdata_request_scheduler_get_n_waiting (GDataRequestScheduler *self);
+
+G_END_DECLS
+
+#endif /* !GDATA_REQUEST_SCHEDULER_H */
@@ -35,14 +35,37 @@
  * Note that it's not always necessary to supply a #GDataAuthorizer instance to a #GDataService. If the only operations to be performed on the
  * #GDataService don't need authorization (e.g. they only query public information), setting up a #GDataAuthorizer is just extra overhead. See the
  * documentation for the operations on individual #GDataService subclasses to see which need authorization and which don't.
+ *
+ * <refsect2 id="gdata-service-threads">
+ * <title>Thread Safety</title>
+ * <para>
+ * A single #GDataService is designed to be shared by all the threads in an application, so that they can share its connection pool and
+ * caches; there's no need to create a service for each thread. All of its methods may be called concurrently from any thread, and all of its
+ * properties may be read and set from any thread while requests are in flight.
+ * </para>
+ * <para>
+ * Changes to #GDataService:authorizer, #GDataService:locale and the network properties apply to requests which are made after the change;
+ * requests which are already in flight carry on with the configuration they were started with. Property change notifications are emitted in the
+ * thread which made the change.
+ * </para>
+ * <para>
+ * gdata_service_get_authorizer() and gdata_service_get_proxy_resolver() don't return a reference, so if another thread could change the
+ * property at the same time, use gdata_service_dup_authorizer() or g_object_get() instead. The string returned by gdata_service_get_locale()
+ * remains valid for the lifetime of the process.
+ * </para>
+ * </refsect2>
  */
 
 #include <config.h>
 #include <glib.h>
 #include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
 #include <libsoup/soup.h>
 #include <string.h>
+#include <stdlib.h>
 #include <stdarg.h>
+#include <json-glib/json-glib.h>
+#include <libxml/xmlreader.h>
 
 #ifdef HAVE_GNOME
 #define GCR_API_SUBJECT_TO_CHANGE
@@ -54,6 +77,15 @@
 #include "gdata-client-login-authorizer.h"
 #include "gdata-marshal.h"
 #include "gdata-types.h"
+#include "gdata-buffer.h"
+#include "gdata-rate-limiter.h"
+#include "gdata-request-scheduler.h"
+#include "gdata-bandwidth-limiter.h"
+#include "gdata-io-loop.h"
+#include "gdata-trace.h"
+#include "gdata-deadline.h"
+#include "gdata-batchable.h"
+#include "gdata-poll-scheduler.h"
 
 GQuark
 gdata_service_error_quark (void)
@@ -61,6 +93,17 @@ gdata_service_error_quark (void)
 	return g_quark_from_static_string ("gdata-service-error-quark");
 }
 
+/* Number of recent response times to learn the hedge delay from; see get_hedge_delay() */
+#define HEDGE_SAMPLES 64
+
+/* Default connection limits for new sessions; see _gdata_service_build_session() */
+#define DEFAULT_MAX_CONNECTIONS 24
+#define DEFAULT_MAX_CONNECTIONS_PER_HOST 6
+
+/* Default for #GDataService:max-error-response-size, in bytes */
+#define DEFAULT_MAX_ERROR_RESPONSE_SIZE (64 * 1024)
+
+static void gdata_service_constructed (GObject *object);
 static void gdata_service_dispose (GObject *object);
 static void gdata_service_finalize (GObject *object);
 static void gdata_service_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
@@ -70,29 +113,203 @@ static void real_parse_error_response (GDataService *self, GDataOperationType op
                                        const gchar *response_body, gint length, GError **error);
 static void notify_proxy_uri_cb (GObject *gobject, GParamSpec *pspec, GObject *self);
 static void notify_timeout_cb (GObject *gobject, GParamSpec *pspec, GObject *self);
+static void notify_max_conns_cb (GObject *gobject, GParamSpec *pspec, GObject *self);
+static void notify_max_conns_per_host_cb (GObject *gobject, GParamSpec *pspec, GObject *self);
+static void notify_idle_timeout_cb (GObject *gobject, GParamSpec *pspec, GObject *self);
+static void request_queued_cb (SoupSession *session, SoupMessage *message, GDataService *self);
+static void request_unqueued_cb (SoupSession *session, SoupMessage *message, GDataService *self);
+static void acl_cache_finished_cb (SoupMessage *message, GDataService *self);
+static gsize entry_cache_get_size (gpointer cache, guint *n_items);
+static gint64 entry_cache_get_oldest_use (gpointer cache);
+static gsize entry_cache_evict_oldest (gpointer cache);
+static gsize acl_cache_get_size (gpointer cache, guint *n_items);
+static gint64 acl_cache_get_oldest_use (gpointer cache);
+static gsize acl_cache_evict_oldest (gpointer cache);
 static void debug_handler (const char *log_domain, GLogLevelFlags log_level, const char *message, gpointer user_data);
 static void soup_log_printer (SoupLogger *logger, SoupLoggerLogLevel level, char direction, const char *data, gpointer user_data);
 
 static GDataFeed *__gdata_service_query (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query,
                                          GType entry_type, GCancellable *cancellable, GDataQueryProgressCallback progress_callback,
                                          gpointer progress_user_data, GError **error, gboolean is_async);
+static GDataFeed *__gdata_service_query_all (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query,
+                                             GType entry_type, guint max_concurrent_pages, GCancellable *cancellable,
+                                             GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error,
+                                             gboolean is_async);
 
 static SoupURI *_get_proxy_uri (GDataService *self);
 static void _set_proxy_uri (GDataService *self, SoupURI *proxy_uri);
 
 struct _GDataServicePrivate {
 	SoupSession *session;
-	gchar *locale;
+	const gchar *locale; /* interned, so it's never freed while another thread's using it; accessed atomically */
+
+	/* Configuration which can be changed from any thread while requests are being made. Requests take their own reference to the authorizer
+	 * (see dup_authorizer()), so it can be replaced while they're in flight. */
+	GMutex config_mutex; /* protects authorizer, proxy_resolver, io_loop and blob_store */
 	GDataAuthorizer *authorizer;
 	GProxyResolver *proxy_resolver;
+	GDataIOLoop *io_loop; /* shared by the service's download streams; created when first needed */
+	GSList *poll_schedulers; /* unowned GDataPollSchedulers to tell about conditional queries; each removes itself when disposed */
+
+	/* Connection statistics; updated atomically, since messages can be sent from any thread */
+	volatile gint requests_sent;
+	volatile gint connections_opened;
+	volatile gint tls_handshakes;
+
+	/* Transfer statistics; these are 64-bit, so can't be updated atomically on all platforms */
+	GMutex transfer_statistics_mutex; /* protects bytes_received and bytes_decoded */
+	guint64 bytes_received;
+	guint64 bytes_decoded;
+
+	/* Entry cache for gdata_service_query_single_entry(); entry_cache_lru holds CachedEntrys, most recently used first, and entry_cache maps
+	 * entry IDs to their links in entry_cache_lru */
+	GMutex entry_cache_mutex; /* protects all the entry_cache* members */
+	GHashTable *entry_cache;
+	GQueue entry_cache_lru;
+	guint entry_cache_size;
+	gsize entry_cache_bytes; /* approximate total size of the cached entries */
+	GDataCacheRegistration *entry_cache_registration;
+
+	/* ACL cache for gdata_access_handler_get_rules(); laid out as for the entry cache, but holding CachedRules keyed by the access handlers'
+	 * entry IDs */
+	GMutex acl_cache_mutex; /* protects all the acl_cache* members */
+	GHashTable *acl_cache;
+	GQueue acl_cache_lru;
+	guint acl_cache_size;
+	gsize acl_cache_bytes;
+	GDataCacheRegistration *acl_cache_registration;
+
+	gchar *cache_directory;
+	GDataBlobStore *blob_store;
+
+	/* Queries which are currently in progress without a progress callback, so that identical ones can share the response rather than making
+	 * a request each. This maps query keys (see get_in_flight_query_key()) to InFlightQuerys. in_flight_queries_cond is signalled whenever
+	 * one of them finishes, or one of their waiters' cancellables is cancelled. */
+	volatile gint share_queries; /* whether in_flight_queries is used at all; accessed atomically */
+	GMutex in_flight_queries_mutex; /* protects in_flight_queries and all the InFlightQuerys */
+	GCond in_flight_queries_cond;
+	GHashTable *in_flight_queries;
+
+	/* Rate limiters for scheduling requests; see gdata_service_set_rate_limit(). Domain rate limiters are created the first time a limit is set
+	 * for their domain, and none are freed until the service is finalized, so they can be used without holding rate_limiters_mutex. */
+	GMutex rate_limiters_mutex; /* protects domain_rate_limiters */
+	GDataRateLimiter *user_rate_limiter;
+	GHashTable/*<owned GDataAuthorizationDomain*, owned GDataRateLimiter*>*/ *domain_rate_limiters;
+
+	/* Retry policy for transient failures; accessed atomically, since messages can be sent from any thread */
+	volatile gint max_retries;
+	volatile gint retry_delay; /* in milliseconds */
+
+	/* Whether to ask for minimal responses to insertions and updates, and whether to merge responses into the existing entries; accessed
+	 * atomically */
+	volatile gint minimal_responses;
+	volatile gint update_entries_in_place;
+
+	/* Hedging of slow GET requests; see get_hedge_delay() */
+	volatile gint hedge_delay; /* in milliseconds */
+	GMutex hedge_samples_mutex; /* protects the hedge_samples members */
+	gint64 hedge_samples[HEDGE_SAMPLES]; /* times taken to receive response headers, in microseconds; a ring buffer */
+	guint n_hedge_samples;
+	guint next_hedge_sample;
+
+	/* Whether to gzip large request bodies; accessed atomically */
+	volatile gint compress_requests;
+
+	/* Maximum number of bytes of an error response body to keep, or 0 for no limit; accessed atomically */
+	volatile gint max_error_response_size;
+
+	/* Permanent redirects which have been followed; redirect_cache maps "METHOD URI" keys to the URIs they redirect to, and
+	 * redirect_cache_keys holds the keys, oldest first, so the cache can be bounded. See cache_redirect(). */
+	GMutex redirect_cache_mutex; /* protects the redirect_cache* members */
+	GHashTable *redirect_cache;
+	GQueue redirect_cache_keys;
+
+	/* Admission queue which holds back normal and background requests so that connections stay free for interactive ones */
+	GDataRequestScheduler *request_scheduler;
+	volatile gint reserved_connections;
+
+	/* Bandwidth limiters shared by all the upload and download streams using the service */
+	GDataBandwidthLimiter *upload_bandwidth_limiter;
+	GDataBandwidthLimiter *download_bandwidth_limiter;
+
+	/* Gauges of the service's current load; see gdata_service_get_gauges(). They're updated atomically, since requests and streams can be used
+	 * from any thread. Domain counters are created the first time a request is sent under their domain, and none are freed until the service is
+	 * finalized, so they can be updated without holding gauges_mutex. */
+	volatile gint requests_in_flight;
+	volatile gint connection_queue_length;
+	volatile gint upload_streams;
+	volatile gint download_streams;
+	volatile gsize upload_buffered_bytes; /* see gdata_buffer_set_length_counter() */
+	volatile gsize download_buffered_bytes;
+	volatile gint pending_progress_callbacks;
+	GMutex gauges_mutex; /* protects domain_requests_in_flight, gauges_interval and gauges_source */
+	GHashTable/*<owned GDataAuthorizationDomain*, owned gint*>*/ *domain_requests_in_flight;
+	guint gauges_interval; /* in milliseconds */
+	GSource *gauges_source; /* emits GDataService::gauges-sampled; NULL if gauges_interval is 0 */
+};
+
+typedef struct {
+	gchar *id;
+	GDataEntry *entry;
+	gsize size; /* approximate number of bytes held, for the cache manager */
+	gint64 last_used; /* monotonic time */
+} CachedEntry;
+
+typedef struct {
+	gchar *id;
+	gchar *etag; /* ETag of the access handler entry when its rules were fetched */
+	SoupURI *acl_uri;
+	GBytes *response; /* body of the ACL feed */
+	gsize size;
+	gint64 last_used;
+} CachedRules;
+
+enum {
+	SIGNAL_REQUEST_COMPLETED,
+	SIGNAL_GAUGES_SAMPLED,
+	LAST_SIGNAL
+};
+
+static const GDataCacheFuncs entry_cache_funcs = {
+	entry_cache_get_size,
+	entry_cache_get_oldest_use,
+	entry_cache_evict_oldest,
+};
+
+static const GDataCacheFuncs acl_cache_funcs = {
+	acl_cache_get_size,
+	acl_cache_get_oldest_use,
+	acl_cache_evict_oldest,
 };
 
+static guint service_signals[LAST_SIGNAL] = { 0, };
+
 enum {
 	PROP_PROXY_URI = 1,
 	PROP_TIMEOUT,
 	PROP_LOCALE,
 	PROP_AUTHORIZER,
 	PROP_PROXY_RESOLVER,
+	PROP_MAX_CONNECTIONS,
+	PROP_MAX_CONNECTIONS_PER_HOST,
+	PROP_RESERVED_CONNECTIONS,
+	PROP_IDLE_TIMEOUT,
+	PROP_ENTRY_CACHE_SIZE,
+	PROP_CACHE_DIRECTORY,
+	PROP_MAX_RETRIES,
+	PROP_RETRY_DELAY,
+	PROP_UPLOAD_BANDWIDTH_LIMIT,
+	PROP_DOWNLOAD_BANDWIDTH_LIMIT,
+	PROP_MINIMAL_RESPONSES,
+	PROP_UPDATE_ENTRIES_IN_PLACE,
+	PROP_HEDGE_DELAY,
+	PROP_COMPRESS_REQUESTS,
+	PROP_SESSION,
+	PROP_MAX_ERROR_RESPONSE_SIZE,
+	PROP_ACL_CACHE_SIZE,
+	PROP_GAUGES_INTERVAL,
+	PROP_BLOB_STORE,
+	PROP_SHARE_QUERIES,
 };
 
 G_DEFINE_TYPE (GDataService, gdata_service, G_TYPE_OBJECT)
@@ -106,6 +323,7 @@ gdata_service_class_init (GDataServiceClass *klass)
 
 	gobject_class->set_property = gdata_service_set_property;
 	gobject_class->get_property = gdata_service_get_property;
+	gobject_class->constructed = gdata_service_constructed;
 	gobject_class->dispose = gdata_service_dispose;
 	gobject_class->finalize = gdata_service_finalize;
 
@@ -204,23 +422,495 @@ gdata_service_class_init (GDataServiceClass *klass)
 	                                                      "Proxy Resolver", "A GProxyResolver used to determine a proxy URI.",
 	                                                      G_TYPE_PROXY_RESOLVER,
 	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:max-connections:
+	 *
+	 * The maximum number of simultaneous connections the service will open, across all hosts. Requests beyond this limit are queued until
+	 * a connection becomes free.
+	 *
+	 * Note that if a #GDataAuthorizer is being used with this #GDataService, the authorizer uses its own connections.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MAX_CONNECTIONS,
+	                                 g_param_spec_uint ("max-connections",
+	                                                    "Maximum connections", "The maximum number of simultaneous connections.",
+	                                                    1, G_MAXUINT, DEFAULT_MAX_CONNECTIONS,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:max-connections-per-host:
+	 *
+	 * The maximum number of simultaneous connections the service will open to a single host. Since all requests for a given service tend
+	 * to go to the same host, this is typically the limit on the number of requests which can be in flight at once, so applications which
+	 * share one #GDataService between several threads may wish to raise it.
+	 *
+	 * Requests are made over HTTP/1.1, which can only carry one request on a connection at once, so this is also the limit on how many
+	 * requests the concurrent operations (such as batch operations and multi-page queries) have in flight to a host at once. The default is
+	 * six, in line with web browsers.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MAX_CONNECTIONS_PER_HOST,
+	                                 g_param_spec_uint ("max-connections-per-host",
+	                                                    "Maximum connections per host",
+	                                                    "The maximum number of simultaneous connections to a single host.",
+	                                                    1, G_MAXUINT, DEFAULT_MAX_CONNECTIONS_PER_HOST,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:reserved-connections:
+	 *
+	 * The number of connections to each host to keep free for interactive requests (see #GDataQuery:priority). Only
+	 * #GDataService:max-connections-per-host minus this many normal and background priority requests may be in flight at once (though always at
+	 * least one); any more wait in the service, with normal priority requests going ahead of background ones. Interactive requests never wait, so
+	 * a user-facing lookup doesn't get stuck in the connection queue behind a large synchronisation.
+	 *
+	 * If this is <code class="literal">0</code>, no connections are reserved, and requests are sent in the order they are made.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_RESERVED_CONNECTIONS,
+	                                 g_param_spec_uint ("reserved-connections",
+	                                                    "Reserved connections", "The number of connections to keep free for interactive requests.",
+	                                                    0, G_MAXINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:idle-timeout:
+	 *
+	 * A timeout, in seconds, after which idle persistent connections will be closed. Keeping connections open allows later requests to
+	 * the same host to skip the TCP and TLS handshakes.
+	 *
+	 * If the timeout is <code class="literal">0</code>, idle connections will be kept open until the server closes them.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_IDLE_TIMEOUT,
+	                                 g_param_spec_uint ("idle-timeout",
+	                                                    "Idle timeout", "A timeout, in seconds, after which idle connections are closed.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:entry-cache-size:
+	 *
+	 * The maximum number of entries to keep in the service's entry cache. Entries returned by gdata_service_query_single_entry() are cached
+	 * along with their ETags, and subsequent queries for the same entry are made conditional on the cached ETag. If the server reports that
+	 * the entry hasn't been modified, the cached entry is returned rather than %NULL. The least recently used entries are evicted once the
+	 * cache is full.
+	 *
+	 * If this is <code class="literal">0</code>, the cache is disabled.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_ENTRY_CACHE_SIZE,
+	                                 g_param_spec_uint ("entry-cache-size",
+	                                                    "Entry cache size", "The maximum number of entries to keep in the entry cache.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:cache-directory:
+	 *
+	 * A directory in which to persistently cache the responses to feed queries made with gdata_service_query() (and functions which use it).
+	 * Responses are cached along with their ETags, keyed by the query URI, and subsequent queries for the same URI are made conditional on
+	 * the cached ETag; if the feed hasn't been modified, it's built from the cached response rather than being downloaded again. This
+	 * persists across instances of the service, so can be used to speed up application start-up.
+	 *
+	 * Queries which have their #GDataQuery:etag set don't use the cache, and behave as documented for gdata_service_query().
+	 *
+	 * Cached responses may contain private data, so the directory should only be readable by the user, and shouldn't be shared between
+	 * services authorized as different users. The directory will be created if it doesn't exist.
+	 *
+	 * If this is %NULL, responses aren't cached.
+	 *
+	 * Since: 0.15.0
+	 **/
+	/**
+	 * GDataService:acl-cache-size:
+	 *
+	 * The maximum number of access control lists to keep in the service's ACL cache. The rules returned by gdata_access_handler_get_rules()
+	 * are cached against the ID and ETag of the #GDataAccessHandler they belong to, and are reused for as long as the access handler's ETag
+	 * doesn't change, rather than being downloaded again. Whenever an access rule is inserted, updated or deleted through the service
+	 * (including in batch operations), the cached rules for its access handler are dropped. The least recently used access control lists are
+	 * evicted once the cache is full.
+	 *
+	 * Changes made to an access control list by other clients only become visible once the access handler has been re-queried with a new
+	 * ETag, so the cache shouldn't be used where that matters.
+	 *
+	 * If this is <code class="literal">0</code>, the cache is disabled.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_ACL_CACHE_SIZE,
+	                                 g_param_spec_uint ("acl-cache-size",
+	                                                    "ACL cache size", "The maximum number of access control lists to keep in the ACL cache.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_class, PROP_CACHE_DIRECTORY,
+	                                 g_param_spec_string ("cache-directory",
+	                                                      "Cache directory", "A directory in which to persistently cache feed query responses.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:max-retries:
+	 *
+	 * The maximum number of times to re-send an idempotent request after a transient failure: a 500 Internal Server Error, 502 Bad Gateway,
+	 * 503 Service Unavailable or 504 Gateway Timeout response, or a connection error (such as the connection being reset). Only
+	 * <literal>GET</literal> and <literal>HEAD</literal> requests, and conditional requests carrying an <literal>If-Match</literal> header
+	 * (such as updates and deletions of entries with an ETag), are re-sent, since re-sending any other request could apply it twice.
+	 *
+	 * Each retry is made after an exponentially increasing delay, starting from #GDataService:retry-delay, with random jitter so that many
+	 * clients which failed at the same time don't all retry at the same time. If the server gives a <literal>Retry-After</literal> header, it
+	 * is respected. Retries are counted in #GDataRequestRecord.retry_count, and don't happen once the request's #GCancellable is cancelled.
+	 *
+	 * If this is <code class="literal">0</code>, transient failures are returned as errors straight away.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MAX_RETRIES,
+	                                 g_param_spec_uint ("max-retries",
+	                                                    "Maximum retries", "The maximum number of times to retry a request after a transient failure.",
+	                                                    0, G_MAXINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:retry-delay:
+	 *
+	 * The delay before the first retry of a request after a transient failure, in milliseconds. The delay is doubled for each subsequent
+	 * retry, up to a maximum of a minute. See #GDataService:max-retries.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_RETRY_DELAY,
+	                                 g_param_spec_uint ("retry-delay",
+	                                                    "Retry delay", "The delay before the first retry of a request, in milliseconds.",
+	                                                    0, 60000, 500,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:upload-bandwidth-limit:
+	 *
+	 * The maximum rate at which all the #GDataUploadStream<!-- -->s using the service may upload data, in bytes per second, or
+	 * <code class="literal">0</code> for no limit. The bandwidth is shared fairly between the streams which are uploading at the same time.
+	 * Each stream may be limited further using #GDataUploadStream:bandwidth-limit.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_UPLOAD_BANDWIDTH_LIMIT,
+	                                 g_param_spec_uint ("upload-bandwidth-limit",
+	                                                    "Upload bandwidth limit", "The maximum rate at which to upload data, in bytes per second.",
+	                                                    0, G_MAXINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:download-bandwidth-limit:
+	 *
+	 * The maximum rate at which all the #GDataDownloadStream<!-- -->s using the service may download data, in bytes per second, or
+	 * <code class="literal">0</code> for no limit. The bandwidth is shared fairly between the streams which are downloading at the same time.
+	 * Each stream may be limited further using #GDataDownloadStream:bandwidth-limit.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_DOWNLOAD_BANDWIDTH_LIMIT,
+	                                 g_param_spec_uint ("download-bandwidth-limit",
+	                                                    "Download bandwidth limit", "The maximum rate at which to download data, in bytes per second.",
+	                                                    0, G_MAXINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:minimal-responses:
+	 *
+	 * Whether insertions and updates of XML entries should ask the server for a minimal response, using a
+	 * <literal>Prefer: return=minimal</literal> header, and skip parsing the full entry out of any response body it sends anyway. The
+	 * entries returned by gdata_service_insert_entry(), gdata_service_update_entry() and gdata_service_patch_entry() (and their asynchronous
+	 * versions) then only have their ID, ETag and <literal>edit</literal> link set; all their other properties are left unset. This is
+	 * useful for bulk imports which only need to know the identity and version of each entry they upload.
+	 *
+	 * Entries which are sent as JSON are always parsed in full.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MINIMAL_RESPONSES,
+	                                 g_param_spec_boolean ("minimal-responses",
+	                                                       "Minimal responses", "Whether to ask for minimal responses to insertions and updates.",
+	                                                       FALSE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:update-entries-in-place:
+	 *
+	 * Whether gdata_service_insert_entry(), gdata_service_update_entry() and gdata_service_patch_entry() (and their asynchronous versions)
+	 * should update the entry which was passed to them to match the server's response, and return it, rather than returning a new entry. Code
+	 * which holds references to the entry, such as UI bindings, then sees the changes made by the server (such as to the entry's ETag and
+	 * timestamps) without having to switch to a new object. #GObject::notify is only emitted for the properties whose values change, and the
+	 * entry is no longer dirty afterwards (see gdata_entry_is_dirty()).
+	 *
+	 * State which isn't exposed as properties is kept as it was sent to the server. If the response changes a read-only property which can't be
+	 * updated in place, a new entry is returned as if this property wasn't set.
+	 *
+	 * If #GDataService:minimal-responses is also set, only the entry's ID, ETag and <literal>edit</literal> link are updated.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_UPDATE_ENTRIES_IN_PLACE,
+	                                 g_param_spec_boolean ("update-entries-in-place",
+	                                                       "Update entries in place", "Whether to update entries to match the responses to their uploads.",
+	                                                       FALSE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:hedge-delay:
+	 *
+	 * How long to wait for the response to a gdata_service_query_single_entry() request (or its asynchronous version) before sending an
+	 * identical second request, in milliseconds, or <code class="literal">0</code> to never do so. Whichever of the two requests is answered
+	 * first is used, and the other is cancelled. This cuts the tail latency of interactive lookups when the occasional request gets stuck on a
+	 * slow server, at the cost of a few extra requests.
+	 *
+	 * The service learns how long responses normally take to start arriving, and once it's seen enough requests, the second request is only
+	 * sent after the 95th percentile of that time, if it's longer than this delay. This limits the extra load to around one request in twenty.
+	 * Only GET requests are hedged, since they're idempotent.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_HEDGE_DELAY,
+	                                 g_param_spec_uint ("hedge-delay",
+	                                                    "Hedge delay", "How long to wait for a response before sending a second request, in milliseconds.",
+	                                                    0, 60000, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:compress-requests:
+	 *
+	 * Whether to compress the bodies of large requests using gzip, and send them with a <literal>Content-Encoding: gzip</literal> header. This
+	 * applies to the batch feeds sent by gdata_batch_operation_run() (and its asynchronous version), and to the entry XML sent at the start of a
+	 * resumable #GDataUploadStream. Atom XML typically compresses by a factor of ten or more, so this can greatly speed up these requests on
+	 * slow uplinks.
+	 *
+	 * Batch feeds are compressed as they're streamed, one entry at a time, so compression doesn't require the whole feed to be held in memory.
+	 * The multipart bodies of non-resumable uploads aren't compressed, since they mostly consist of the (typically already compressed) file
+	 * being uploaded.
+	 *
+	 * This must only be enabled if the service's servers accept gzip-encoded request bodies, which isn't the case for all Google APIs.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_COMPRESS_REQUESTS,
+	                                 g_param_spec_boolean ("compress-requests",
+	                                                       "Compress requests", "Whether to compress the bodies of large requests using gzip.",
+	                                                       FALSE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:session:
+	 *
+	 * The #SoupSession the service sends its requests over. If this isn't set when the service is constructed, the service creates a
+	 * session of its own.
+	 *
+	 * Many services, each with its own #GDataAuthorizer, may share one session by passing the session of an existing service (as returned by
+	 * gdata_service_get_session()) when constructing the others. Each request is still authorized by the service which made it, but the
+	 * services share a single pool of persistent connections (and their TLS sessions), so a process acting on behalf of many users doesn't
+	 * need a separate set of idle connections for each of them. The per-service statistics, signals, rate limits and retry settings are
+	 * unaffected by sharing.
+	 *
+	 * Note that the #GDataService:proxy-resolver, #GDataService:timeout, #GDataService:max-connections,
+	 * #GDataService:max-connections-per-host and #GDataService:idle-timeout properties are properties of the session, so changing them
+	 * on one service changes them for all the services sharing its session.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_SESSION,
+	                                 g_param_spec_object ("session",
+	                                                      "Session", "The SoupSession the service sends its requests over.",
+	                                                      SOUP_TYPE_SESSION,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:max-error-response-size:
+	 *
+	 * The maximum number of bytes of the body of an error response (one with a status other than 2xx or 3xx) to keep in memory, or
+	 * <code class="literal">0</code> for no limit. The rest of the body is read from the network and discarded as it arrives, so a large error
+	 * page (for example, from a proxy) doesn't have to be held in memory to produce an error message. Error details from the online service come
+	 * at the start of the body, so are unaffected.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_MAX_ERROR_RESPONSE_SIZE,
+	                                 g_param_spec_uint ("max-error-response-size",
+	                                                    "Maximum error response size",
+	                                                    "The maximum number of bytes of an error response body to keep.",
+	                                                    0, G_MAXINT, DEFAULT_MAX_ERROR_RESPONSE_SIZE,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:gauges-interval:
+	 *
+	 * How often to emit #GDataService::gauges-sampled with a snapshot of the service's gauges, in milliseconds, or
+	 * <code class="literal">0</code> to never do so. The gauges can be read at any time with gdata_service_get_gauges() regardless.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_GAUGES_INTERVAL,
+	                                 g_param_spec_uint ("gauges-interval",
+	                                                    "Gauges interval", "How often to emit a snapshot of the service's gauges, in milliseconds.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:blob-store:
+	 *
+	 * A #GDataBlobStore for the #GDataDownloadStream<!-- -->s of the service to store the files they download in. A file which is read through
+	 * a download stream from its start is written through to the store once it's complete, along with its ETag; and a later download of the
+	 * same URI is made conditional on that ETag, so that if the file hasn't changed, it's read from the store rather than being downloaded
+	 * again. Downloads made with gdata_download_stream_download_segments() and similar functions don't use the store.
+	 *
+	 * The store may be shared between several services, even ones authorized as different users, since each file is still revalidated with the
+	 * server using the credentials of the service downloading it.
+	 *
+	 * If this is %NULL, downloads aren't stored.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_BLOB_STORE,
+	                                 g_param_spec_object ("blob-store",
+	                                                      "Blob store", "A store for the files downloaded by the service's download streams.",
+	                                                      GDATA_TYPE_BLOB_STORE,
+	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService:share-queries:
+	 *
+	 * Whether a query made with gdata_service_query() which is identical to one already in progress on the service in another thread should
+	 * wait for that one to finish and share its response, rather than making a request of its own. Queries are identical if they have the same
+	 * #GDataAuthorizationDomain, entry type, query URI and parse mode, no ETag, no #GDataQuery:page-cache-mode and no progress callback.
+	 *
+	 * This is useful when many threads may ask for the same feed at once, but note that the callers sharing a response are all returned
+	 * references to the <emphasis>same</emphasis> #GDataFeed and #GDataEntry objects (or a copy of the same error). They must treat them as
+	 * read-only, and any of them which modifies the entries must copy them first with gdata_parsable_clone(). For this reason, it's disabled
+	 * by default.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_SHARE_QUERIES,
+	                                 g_param_spec_boolean ("share-queries",
+	                                                       "Share queries", "Whether identical concurrent queries share one request and its response.",
+	                                                       FALSE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataService::request-completed:
+	 * @service: the #GDataService which made the request
+	 * @record: a #GDataRequestRecord describing the request
+	 *
+	 * The #GDataService::request-completed signal is emitted once each query, insertion, update or deletion request made by the service has
+	 * finished, including parsing its response. @record breaks down the time taken by the request, and can be used to find slow endpoints.
+	 * It is only valid for the duration of the signal emission; copy it with gdata_request_record_copy() to keep it.
+	 *
+	 * Note that this signal is emitted in the thread which performed the request, which may not be the main thread if the asynchronous
+	 * API was used.
+	 *
+	 * Since: 0.15.0
+	 */
+	service_signals[SIGNAL_REQUEST_COMPLETED] = g_signal_new ("request-completed",
+	                                                          G_TYPE_FROM_CLASS (klass),
+	                                                          G_SIGNAL_RUN_LAST,
+	                                                          0, NULL, NULL,
+	                                                          g_cclosure_marshal_VOID__BOXED,
+	                                                          G_TYPE_NONE, 1, GDATA_TYPE_REQUEST_RECORD | G_SIGNAL_TYPE_STATIC_SCOPE);
+
+	/**
+	 * GDataService::gauges-sampled:
+	 * @service: the #GDataService whose gauges were sampled
+	 * @gauges: a #GDataServiceGauges snapshot
+	 *
+	 * The #GDataService::gauges-sampled signal is emitted every #GDataService:gauges-interval milliseconds with a snapshot of the service's
+	 * gauges, as returned by gdata_service_get_gauges(), so that the load on the service can be monitored without polling it. @gauges is only
+	 * valid for the duration of the signal emission; copy it with gdata_service_gauges_copy() to keep it.
+	 *
+	 * This signal is emitted in the thread-default main context of the thread which last set #GDataService:gauges-interval.
+	 *
+	 * Since: 0.15.0
+	 */
+	service_signals[SIGNAL_GAUGES_SAMPLED] = g_signal_new ("gauges-sampled",
+	                                                       G_TYPE_FROM_CLASS (klass),
+	                                                       G_SIGNAL_RUN_LAST,
+	                                                       0, NULL, NULL,
+	                                                       g_cclosure_marshal_VOID__BOXED,
+	                                                       G_TYPE_NONE, 1, GDATA_TYPE_SERVICE_GAUGES | G_SIGNAL_TYPE_STATIC_SCOPE);
 }
 
 static void
 gdata_service_init (GDataService *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_SERVICE, GDataServicePrivate);
-	self->priv->session = _gdata_service_build_session ();
+
+	g_mutex_init (&(self->priv->config_mutex));
+	g_mutex_init (&(self->priv->transfer_statistics_mutex));
+	g_mutex_init (&(self->priv->entry_cache_mutex));
+	self->priv->entry_cache = g_hash_table_new (g_str_hash, g_str_equal);
+	g_queue_init (&(self->priv->entry_cache_lru));
+	g_mutex_init (&(self->priv->acl_cache_mutex));
+	self->priv->acl_cache = g_hash_table_new (g_str_hash, g_str_equal);
+	g_queue_init (&(self->priv->acl_cache_lru));
+	self->priv->entry_cache_registration = _gdata_cache_manager_register ("GDataService:entry-cache", GDATA_CACHE_PRIORITY_NORMAL,
+	                                                                      &entry_cache_funcs, self);
+	self->priv->acl_cache_registration = _gdata_cache_manager_register ("GDataService:acl-cache", GDATA_CACHE_PRIORITY_NORMAL,
+	                                                                    &acl_cache_funcs, self);
+	g_mutex_init (&(self->priv->in_flight_queries_mutex));
+	g_cond_init (&(self->priv->in_flight_queries_cond));
+	self->priv->in_flight_queries = g_hash_table_new (g_str_hash, g_str_equal);
+	g_mutex_init (&(self->priv->rate_limiters_mutex));
+	self->priv->user_rate_limiter = gdata_rate_limiter_new ();
+	self->priv->domain_rate_limiters = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref,
+	                                                          (GDestroyNotify) gdata_rate_limiter_free);
+	self->priv->retry_delay = 500;
+	self->priv->max_error_response_size = DEFAULT_MAX_ERROR_RESPONSE_SIZE;
+	g_mutex_init (&(self->priv->hedge_samples_mutex));
+	g_mutex_init (&(self->priv->redirect_cache_mutex));
+	self->priv->redirect_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	g_queue_init (&(self->priv->redirect_cache_keys));
+	self->priv->request_scheduler = gdata_request_scheduler_new ();
+	self->priv->upload_bandwidth_limiter = gdata_bandwidth_limiter_new ();
+	self->priv->download_bandwidth_limiter = gdata_bandwidth_limiter_new ();
+	g_mutex_init (&(self->priv->gauges_mutex));
+	self->priv->domain_requests_in_flight = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, g_free);
 
 	/* Log handling for all message types except debug */
 	g_log_set_handler (G_LOG_DOMAIN, G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_ERROR | G_LOG_LEVEL_INFO | G_LOG_LEVEL_MESSAGE | G_LOG_LEVEL_WARNING, (GLogFunc) debug_handler, self);
+}
+
+static void
+gdata_service_constructed (GObject *object)
+{
+	GDataService *self = GDATA_SERVICE (object);
+
+	/* Build our own session, unless we've been given one to share with other services */
+	if (self->priv->session == NULL)
+		self->priv->session = _gdata_service_build_session ();
 
 	/* Proxy the SoupSession's proxy-uri and timeout properties */
 	g_signal_connect (self->priv->session, "notify::proxy-uri", (GCallback) notify_proxy_uri_cb, self);
 	g_signal_connect (self->priv->session, "notify::timeout", (GCallback) notify_timeout_cb, self);
 
+	/* Proxy the SoupSession's connection pool properties */
+	g_signal_connect (self->priv->session, "notify::max-conns", (GCallback) notify_max_conns_cb, self);
+	g_signal_connect (self->priv->session, "notify::max-conns-per-host", (GCallback) notify_max_conns_per_host_cb, self);
+	g_signal_connect (self->priv->session, "notify::idle-timeout", (GCallback) notify_idle_timeout_cb, self);
+
+	/* Track connection reuse */
+	g_signal_connect (self->priv->session, "request-queued", (GCallback) request_queued_cb, self);
+	g_signal_connect (self->priv->session, "request-unqueued", (GCallback) request_unqueued_cb, self);
+
 	/* Keep our GProxyResolver synchronized with SoupSession's. */
 	g_object_bind_property (self->priv->session, "proxy-resolver", self, "proxy-resolver", G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
+
+	/* Chain up to the parent class */
+	if (G_OBJECT_CLASS (gdata_service_parent_class)->constructed != NULL)
+		G_OBJECT_CLASS (gdata_service_parent_class)->constructed (object);
 }
 
 static void
@@ -232,11 +922,27 @@ gdata_service_dispose (GObject *object)
 		g_object_unref (priv->authorizer);
 	priv->authorizer = NULL;
 
-	if (priv->session != NULL)
+	if (priv->session != NULL) {
+		g_signal_handlers_disconnect_by_data (priv->session, object);
 		g_object_unref (priv->session);
+	}
 	priv->session = NULL;
 
 	g_clear_object (&priv->proxy_resolver);
+	g_clear_object (&priv->blob_store);
+
+	/* Stop sampling the gauges */
+	g_mutex_lock (&(priv->gauges_mutex));
+	if (priv->gauges_source != NULL) {
+		g_source_destroy (priv->gauges_source);
+		g_source_unref (priv->gauges_source);
+		priv->gauges_source = NULL;
+	}
+	g_mutex_unlock (&(priv->gauges_mutex));
+
+	/* Drop all the cached entries */
+	gdata_service_set_entry_cache_size (GDATA_SERVICE (object), 0);
+	gdata_service_set_acl_cache_size (GDATA_SERVICE (object), 0);
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_service_parent_class)->dispose (object);
@@ -247,7 +953,34 @@ gdata_service_finalize (GObject *object)
 {
 	GDataServicePrivate *priv = GDATA_SERVICE (object)->priv;
 
-	g_free (priv->locale);
+	g_free (priv->cache_directory);
+	g_mutex_clear (&(priv->config_mutex));
+
+	_gdata_cache_manager_unregister (priv->entry_cache_registration);
+	_gdata_cache_manager_unregister (priv->acl_cache_registration);
+	g_hash_table_destroy (priv->entry_cache);
+	g_mutex_clear (&(priv->entry_cache_mutex));
+	g_hash_table_destroy (priv->acl_cache);
+	g_mutex_clear (&(priv->acl_cache_mutex));
+	g_hash_table_destroy (priv->in_flight_queries);
+	g_cond_clear (&(priv->in_flight_queries_cond));
+	g_mutex_clear (&(priv->in_flight_queries_mutex));
+	g_mutex_clear (&(priv->transfer_statistics_mutex));
+	g_hash_table_destroy (priv->domain_rate_limiters);
+	gdata_rate_limiter_free (priv->user_rate_limiter);
+	g_mutex_clear (&(priv->rate_limiters_mutex));
+	gdata_request_scheduler_free (priv->request_scheduler);
+	gdata_bandwidth_limiter_free (priv->upload_bandwidth_limiter);
+	gdata_bandwidth_limiter_free (priv->download_bandwidth_limiter);
+	g_hash_table_destroy (priv->domain_requests_in_flight);
+	g_mutex_clear (&(priv->gauges_mutex));
+
+	if (priv->io_loop != NULL)
+		gdata_io_loop_free (priv->io_loop);
+	g_mutex_clear (&(priv->hedge_samples_mutex));
+	g_queue_clear (&(priv->redirect_cache_keys)); /* the keys are owned by redirect_cache */
+	g_hash_table_destroy (priv->redirect_cache);
+	g_mutex_clear (&(priv->redirect_cache_mutex));
 
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_service_parent_class)->finalize (object);
@@ -266,13 +999,75 @@ gdata_service_get_property (GObject *object, guint property_id, GValue *value, G
 			g_value_set_uint (value, gdata_service_get_timeout (GDATA_SERVICE (object)));
 			break;
 		case PROP_LOCALE:
-			g_value_set_string (value, priv->locale);
+			g_value_set_string (value, gdata_service_get_locale (GDATA_SERVICE (object)));
 			break;
 		case PROP_AUTHORIZER:
-			g_value_set_object (value, priv->authorizer);
+			g_value_take_object (value, gdata_service_dup_authorizer (GDATA_SERVICE (object)));
 			break;
 		case PROP_PROXY_RESOLVER:
+			g_mutex_lock (&(priv->config_mutex));
 			g_value_set_object (value, priv->proxy_resolver);
+			g_mutex_unlock (&(priv->config_mutex));
+			break;
+		case PROP_MAX_CONNECTIONS:
+			g_value_set_uint (value, gdata_service_get_max_connections (GDATA_SERVICE (object)));
+			break;
+		case PROP_MAX_CONNECTIONS_PER_HOST:
+			g_value_set_uint (value, gdata_service_get_max_connections_per_host (GDATA_SERVICE (object)));
+			break;
+		case PROP_RESERVED_CONNECTIONS:
+			g_value_set_uint (value, gdata_service_get_reserved_connections (GDATA_SERVICE (object)));
+			break;
+		case PROP_IDLE_TIMEOUT:
+			g_value_set_uint (value, gdata_service_get_idle_timeout (GDATA_SERVICE (object)));
+			break;
+		case PROP_ENTRY_CACHE_SIZE:
+			g_value_set_uint (value, gdata_service_get_entry_cache_size (GDATA_SERVICE (object)));
+			break;
+		case PROP_ACL_CACHE_SIZE:
+			g_value_set_uint (value, gdata_service_get_acl_cache_size (GDATA_SERVICE (object)));
+			break;
+		case PROP_CACHE_DIRECTORY:
+			g_value_set_string (value, priv->cache_directory);
+			break;
+		case PROP_MAX_RETRIES:
+			g_value_set_uint (value, gdata_service_get_max_retries (GDATA_SERVICE (object)));
+			break;
+		case PROP_RETRY_DELAY:
+			g_value_set_uint (value, gdata_service_get_retry_delay (GDATA_SERVICE (object)));
+			break;
+		case PROP_UPLOAD_BANDWIDTH_LIMIT:
+			g_value_set_uint (value, gdata_service_get_upload_bandwidth_limit (GDATA_SERVICE (object)));
+			break;
+		case PROP_DOWNLOAD_BANDWIDTH_LIMIT:
+			g_value_set_uint (value, gdata_service_get_download_bandwidth_limit (GDATA_SERVICE (object)));
+			break;
+		case PROP_MINIMAL_RESPONSES:
+			g_value_set_boolean (value, gdata_service_get_minimal_responses (GDATA_SERVICE (object)));
+			break;
+		case PROP_UPDATE_ENTRIES_IN_PLACE:
+			g_value_set_boolean (value, gdata_service_get_update_entries_in_place (GDATA_SERVICE (object)));
+			break;
+		case PROP_HEDGE_DELAY:
+			g_value_set_uint (value, gdata_service_get_hedge_delay (GDATA_SERVICE (object)));
+			break;
+		case PROP_COMPRESS_REQUESTS:
+			g_value_set_boolean (value, gdata_service_get_compress_requests (GDATA_SERVICE (object)));
+			break;
+		case PROP_MAX_ERROR_RESPONSE_SIZE:
+			g_value_set_uint (value, gdata_service_get_max_error_response_size (GDATA_SERVICE (object)));
+			break;
+		case PROP_SESSION:
+			g_value_set_object (value, priv->session);
+			break;
+		case PROP_GAUGES_INTERVAL:
+			g_value_set_uint (value, gdata_service_get_gauges_interval (GDATA_SERVICE (object)));
+			break;
+		case PROP_BLOB_STORE:
+			g_value_take_object (value, _gdata_service_dup_blob_store (GDATA_SERVICE (object)));
+			break;
+		case PROP_SHARE_QUERIES:
+			g_value_set_boolean (value, gdata_service_get_share_queries (GDATA_SERVICE (object)));
 			break;
 		default:
 			/* We don't have any other property... */
@@ -300,6 +1095,67 @@ gdata_service_set_property (GObject *object, guint property_id, const GValue *va
 		case PROP_PROXY_RESOLVER:
 			gdata_service_set_proxy_resolver (GDATA_SERVICE (object), g_value_get_object (value));
 			break;
+		case PROP_MAX_CONNECTIONS:
+			gdata_service_set_max_connections (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_MAX_CONNECTIONS_PER_HOST:
+			gdata_service_set_max_connections_per_host (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_RESERVED_CONNECTIONS:
+			gdata_service_set_reserved_connections (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_IDLE_TIMEOUT:
+			gdata_service_set_idle_timeout (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_ENTRY_CACHE_SIZE:
+			gdata_service_set_entry_cache_size (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_ACL_CACHE_SIZE:
+			gdata_service_set_acl_cache_size (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_CACHE_DIRECTORY:
+			gdata_service_set_cache_directory (GDATA_SERVICE (object), g_value_get_string (value));
+			break;
+		case PROP_MAX_RETRIES:
+			gdata_service_set_max_retries (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_RETRY_DELAY:
+			gdata_service_set_retry_delay (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_UPLOAD_BANDWIDTH_LIMIT:
+			gdata_service_set_upload_bandwidth_limit (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_DOWNLOAD_BANDWIDTH_LIMIT:
+			gdata_service_set_download_bandwidth_limit (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_MINIMAL_RESPONSES:
+			gdata_service_set_minimal_responses (GDATA_SERVICE (object), g_value_get_boolean (value));
+			break;
+		case PROP_UPDATE_ENTRIES_IN_PLACE:
+			gdata_service_set_update_entries_in_place (GDATA_SERVICE (object), g_value_get_boolean (value));
+			break;
+		case PROP_HEDGE_DELAY:
+			gdata_service_set_hedge_delay (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_COMPRESS_REQUESTS:
+			gdata_service_set_compress_requests (GDATA_SERVICE (object), g_value_get_boolean (value));
+			break;
+		case PROP_MAX_ERROR_RESPONSE_SIZE:
+			gdata_service_set_max_error_response_size (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_SESSION:
+			/* Construct only */
+			GDATA_SERVICE (object)->priv->session = g_value_dup_object (value);
+			break;
+		case PROP_GAUGES_INTERVAL:
+			gdata_service_set_gauges_interval (GDATA_SERVICE (object), g_value_get_uint (value));
+			break;
+		case PROP_BLOB_STORE:
+			gdata_service_set_blob_store (GDATA_SERVICE (object), g_value_get_object (value));
+			break;
+		case PROP_SHARE_QUERIES:
+			gdata_service_set_share_queries (GDATA_SERVICE (object), g_value_get_boolean (value));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -307,14 +1163,30 @@ gdata_service_set_property (GObject *object, guint property_id, const GValue *va
 	}
 }
 
+/* The authorizer which is yet to process a message, if processing it has been deferred until it's sent */
+#define AUTHORIZATION_PENDING_KEY "gdata-authorization-pending"
+
 static void
 real_append_query_headers (GDataService *self, GDataAuthorizationDomain *domain, SoupMessage *message)
 {
+	GDataAuthorizer *authorizer;
+	const gchar *locale;
+
 	g_assert (message != NULL);
 
 	/* Set the authorisation header */
-	if (self->priv->authorizer != NULL) {
-		gdata_authorizer_process_request (self->priv->authorizer, domain, message);
+	authorizer = gdata_service_dup_authorizer (self);
+
+	if (authorizer != NULL) {
+		if (GDATA_AUTHORIZER_GET_IFACE (authorizer)->process_request_async != NULL) {
+			/* The authorizer may have to wait before it can process the message (for example, to fetch an access token), so defer
+			 * processing until the message is sent. That way, asynchronous operations can process it without blocking. See
+			 * process_pending_authorization() and _gdata_service_send_message_async(). */
+			g_object_set_data_full (G_OBJECT (message), AUTHORIZATION_PENDING_KEY, g_object_ref (authorizer),
+			                        (GDestroyNotify) g_object_unref);
+		} else {
+			gdata_authorizer_process_request (authorizer, domain, message);
+		}
 
 		if (domain != NULL) {
 			/* Store the authorisation domain on the message so that we can access it again after refreshing authorisation if necessary.
@@ -322,14 +1194,17 @@ real_append_query_headers (GDataService *self, GDataAuthorizationDomain *domain,
 			g_object_set_data_full (G_OBJECT (message), "gdata-authorization-domain", g_object_ref (domain),
 			                        (GDestroyNotify) g_object_unref);
 		}
+
+		g_object_unref (authorizer);
 	}
 
 	/* Set the GData-Version header to tell it we want to use the v2 API */
 	soup_message_headers_append (message->request_headers, "GData-Version", GDATA_SERVICE_GET_CLASS (self)->api_version);
 
 	/* Set the locale, if it's been set for the service */
-	if (self->priv->locale != NULL)
-		soup_message_headers_append (message->request_headers, "Accept-Language", self->priv->locale);
+	locale = gdata_service_get_locale (self);
+	if (locale != NULL)
+		soup_message_headers_append (message->request_headers, "Accept-Language", locale);
 }
 
 static void
@@ -456,13 +1331,16 @@ real_parse_error_response (GDataService *self, GDataOperationType operation_type
 gboolean
 gdata_service_is_authorized (GDataService *self)
 {
+	GDataAuthorizer *authorizer;
 	GList *domains, *i;
 	gboolean authorised = TRUE;
 
 	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
 
 	/* If we don't have an authoriser set, we can't be authorised */
-	if (self->priv->authorizer == NULL) {
+	authorizer = gdata_service_dup_authorizer (self);
+
+	if (authorizer == NULL) {
 		return FALSE;
 	}
 
@@ -470,13 +1348,14 @@ gdata_service_is_authorized (GDataService *self)
 
 	/* Find any domains which we're not authorised for */
 	for (i = domains; i != NULL; i = i->next) {
-		if (gdata_authorizer_is_authorized_for_domain (self->priv->authorizer, GDATA_AUTHORIZATION_DOMAIN (i->data)) == FALSE) {
+		if (gdata_authorizer_is_authorized_for_domain (authorizer, GDATA_AUTHORIZATION_DOMAIN (i->data)) == FALSE) {
 			authorised = FALSE;
 			break;
 		}
 	}
 
 	g_list_free (domains);
+	g_object_unref (authorizer);
 
 	return authorised;
 }
@@ -487,6 +1366,9 @@ gdata_service_is_authorized (GDataService *self)
  *
  * Gets the #GDataAuthorizer object currently in use by the service. See the documentation for #GDataService:authorizer for more details.
  *
+ * If another thread could change the authorizer at the same time, use gdata_service_dup_authorizer() instead, since the returned authorizer could
+ * otherwise be finalized while it's still being used.
+ *
  * Return value: (transfer none): the authorizer object for this service, or %NULL
  *
  * Since: 0.9.0
@@ -494,9 +1376,41 @@ gdata_service_is_authorized (GDataService *self)
 GDataAuthorizer *
 gdata_service_get_authorizer (GDataService *self)
 {
+	GDataAuthorizer *authorizer;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+
+	g_mutex_lock (&(self->priv->config_mutex));
+	authorizer = self->priv->authorizer;
+	g_mutex_unlock (&(self->priv->config_mutex));
+
+	return authorizer;
+}
+
+/**
+ * gdata_service_dup_authorizer:
+ * @self: a #GDataService
+ *
+ * Gets a reference to the #GDataAuthorizer object currently in use by the service. This is the thread-safe version of
+ * gdata_service_get_authorizer(): the authorizer stays alive for as long as the reference is held, even if another thread sets a new one on the
+ * service in the meantime.
+ *
+ * Return value: (transfer full): the authorizer object for this service, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataAuthorizer *
+gdata_service_dup_authorizer (GDataService *self)
+{
+	GDataAuthorizer *authorizer;
+
 	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
 
-	return self->priv->authorizer;
+	g_mutex_lock (&(self->priv->config_mutex));
+	authorizer = (self->priv->authorizer != NULL) ? g_object_ref (self->priv->authorizer) : NULL;
+	g_mutex_unlock (&(self->priv->config_mutex));
+
+	return authorizer;
 }
 
 /**
@@ -513,18 +1427,24 @@ void
 gdata_service_set_authorizer (GDataService *self, GDataAuthorizer *authorizer)
 {
 	GDataServicePrivate *priv = self->priv;
+	GDataAuthorizer *old_authorizer;
 
 	g_return_if_fail (GDATA_IS_SERVICE (self));
 	g_return_if_fail (authorizer == NULL || GDATA_IS_AUTHORIZER (authorizer));
 
-	if (priv->authorizer != NULL) {
-		g_object_unref (priv->authorizer);
+	if (authorizer != NULL) {
+		g_object_ref (authorizer);
 	}
 
+	g_mutex_lock (&(priv->config_mutex));
+	old_authorizer = priv->authorizer;
 	priv->authorizer = authorizer;
+	g_mutex_unlock (&(priv->config_mutex));
 
-	if (priv->authorizer != NULL) {
-		g_object_ref (priv->authorizer);
+	/* Drop the old authorizer outside the lock, since finalising it could call back into the service. Requests which are in flight hold their
+	 * own references to it. */
+	if (old_authorizer != NULL) {
+		g_object_unref (old_authorizer);
 	}
 
 	g_object_notify (G_OBJECT (self), "authorizer");
@@ -545,21 +1465,147 @@ gdata_service_set_authorizer (GDataService *self, GDataAuthorizer *authorizer)
  *
  * Since: 0.9.0
  */
+G_LOCK_DEFINE_STATIC (authorization_domains);
+
+static GQuark
+authorization_domains_quark (void)
+{
+	return g_quark_from_static_string ("gdata-service-authorization-domains");
+}
+
+/* Returns the authorization domains for @service_type as a #GPtrArray owned by the type. The domains are interned and static, and a service
+ * type's set of domains never changes, so they're only asked for once per type; later calls don't even need to reference the class. */
+static GPtrArray *
+get_cached_authorization_domains (GType service_type)
+{
+	GPtrArray *domains;
+
+	G_LOCK (authorization_domains);
+
+	domains = g_type_get_qdata (service_type, authorization_domains_quark ());
+
+	if (domains == NULL) {
+		GDataServiceClass *klass;
+		GList *list = NULL, *i;
+
+		/* Only take a reference if nothing else has initialised the class yet */
+		klass = g_type_class_peek (service_type);
+		if (klass == NULL) {
+			klass = g_type_class_ref (service_type);
+			if (klass->get_authorization_domains != NULL) {
+				list = klass->get_authorization_domains ();
+			}
+			g_type_class_unref (klass);
+		} else if (klass->get_authorization_domains != NULL) {
+			list = klass->get_authorization_domains ();
+		}
+
+		domains = g_ptr_array_sized_new (g_list_length (list));
+		for (i = list; i != NULL; i = i->next) {
+			g_ptr_array_add (domains, i->data);
+		}
+
+		g_list_free (list);
+
+		/* This is never freed, since types are never unregistered */
+		g_type_set_qdata (service_type, authorization_domains_quark (), domains);
+	}
+
+	G_UNLOCK (authorization_domains);
+
+	return domains;
+}
+
 GList *
 gdata_service_get_authorization_domains (GType service_type)
 {
-	GDataServiceClass *klass;
-	GList *domains = NULL;
+	GPtrArray *domains;
+	GList *list = NULL;
+	guint i;
 
 	g_return_val_if_fail (g_type_is_a (service_type, GDATA_TYPE_SERVICE), NULL);
 
-	klass = GDATA_SERVICE_CLASS (g_type_class_ref (service_type));
-	if (klass->get_authorization_domains != NULL) {
-		domains = klass->get_authorization_domains ();
+	domains = get_cached_authorization_domains (service_type);
+
+	for (i = domains->len; i > 0; i--) {
+		list = g_list_prepend (list, domains->pdata[i - 1]);
 	}
-	g_type_class_unref (klass);
 
-	return domains;
+	return list;
+}
+
+/* The service which sent a message. Several services may share a session (see #GDataService:session), so the session's signal handlers use
+ * this to ignore messages sent by other services. It's a weak pointer, since a service always outlives the messages it sends. */
+#define MESSAGE_SERVICE_KEY "gdata-service"
+
+/* While the body of an error response to a message is being capped to #GDataService:max-error-response-size, this is set on the message to the
+ * maximum number of bytes to keep. libsoup's accumulation of the body is turned off, and the message's got-chunk handler accumulates it instead. */
+#define ERROR_BODY_LIMIT_KEY "gdata-error-body-limit"
+
+static void
+error_body_got_headers_cb (SoupMessage *message, GDataService *self)
+{
+	guint limit;
+
+	/* If the previous response to the message was capped, it's since been re-sent (for example, after refreshing authorisation), so start
+	 * again. This handler is connected before any others which turn off accumulation (such as when streaming queries), so it can't undo
+	 * theirs. */
+	if (g_object_get_data (G_OBJECT (message), ERROR_BODY_LIMIT_KEY) != NULL) {
+		g_object_set_data (G_OBJECT (message), ERROR_BODY_LIMIT_KEY, NULL);
+		soup_message_body_set_accumulate (message->response_body, TRUE);
+	}
+
+	if (SOUP_STATUS_IS_SUCCESSFUL (message->status_code) || SOUP_STATUS_IS_REDIRECTION (message->status_code) ||
+	    soup_message_body_get_accumulate (message->response_body) == FALSE) {
+		return;
+	}
+
+	limit = gdata_service_get_max_error_response_size (self);
+	if (limit == 0)
+		return;
+
+	soup_message_body_set_accumulate (message->response_body, FALSE);
+	g_object_set_data (G_OBJECT (message), ERROR_BODY_LIMIT_KEY, GUINT_TO_POINTER (limit));
+}
+
+static void
+error_body_got_chunk_cb (SoupMessage *message, SoupBuffer *chunk, gpointer user_data)
+{
+	guint limit;
+
+	limit = GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (message), ERROR_BODY_LIMIT_KEY));
+	if (limit == 0 || message->response_body->length >= limit)
+		return;
+
+	/* Keep the start of the body, where any error details are, and drop the rest as it arrives */
+	soup_message_body_append (message->response_body, SOUP_MEMORY_COPY, chunk->data,
+	                          MIN (chunk->length, limit - (gsize) message->response_body->length));
+}
+
+static void
+error_body_got_body_cb (SoupMessage *message, gpointer user_data)
+{
+	/* libsoup only flattens the body (setting message->response_body->data) if it accumulated it itself */
+	if (g_object_get_data (G_OBJECT (message), ERROR_BODY_LIMIT_KEY) != NULL)
+		soup_buffer_free (soup_message_body_flatten (message->response_body));
+}
+
+void
+_gdata_service_claim_message (GDataService *self, SoupMessage *message)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (SOUP_IS_MESSAGE (message));
+
+	g_object_set_data (G_OBJECT (message), MESSAGE_SERVICE_KEY, self);
+
+	/* Cap the size of error response bodies; see #GDataService:max-error-response-size */
+	g_signal_connect (message, "got-headers", (GCallback) error_body_got_headers_cb, self);
+	g_signal_connect (message, "got-chunk", (GCallback) error_body_got_chunk_cb, NULL);
+	g_signal_connect (message, "got-body", (GCallback) error_body_got_body_cb, NULL);
+
+	/* Anything other than a GET or HEAD request could change an access control list */
+	if (message->method != SOUP_METHOD_GET && message->method != SOUP_METHOD_HEAD)
+		g_signal_connect (message, "finished", (GCallback) acl_cache_finished_cb, self);
 }
 
 SoupMessage *
@@ -570,12 +1616,16 @@ _gdata_service_build_message (GDataService *self, GDataAuthorizationDomain *doma
 	GDataServiceClass *klass;
 	SoupURI *_uri;
 
+	GDATA_TRACE2 (message_build_start, method, uri);
+
 	/* Create the message. Allow changing the HTTPS port just for testing. */
 	_uri = soup_uri_new (uri);
 	soup_uri_set_port (_uri, _gdata_service_get_https_port ());
 	message = soup_message_new_from_uri (method, _uri);
 	soup_uri_free (_uri);
 
+	_gdata_service_claim_message (self, message);
+
 	/* Make sure subclasses set their headers */
 	klass = GDATA_SERVICE_GET_CLASS (self);
 	if (klass->append_query_headers != NULL)
@@ -585,41 +1635,209 @@ _gdata_service_build_message (GDataService *self, GDataAuthorizationDomain *doma
 	if (etag != NULL)
 		soup_message_headers_append (message->request_headers, (etag_if_match == TRUE) ? "If-Match" : "If-None-Match", etag);
 
+	GDATA_TRACE1 (message_build_end, message);
+
 	return message;
 }
 
+/**
+ * gdata_request_record_copy:
+ * @self: a #GDataRequestRecord
+ *
+ * Copies @self, for example so that it can be kept after a #GDataService::request-completed signal handler has returned.
+ *
+ * Return value: (transfer full): a copy of @self; free with gdata_request_record_free()
+ *
+ * Since: 0.15.0
+ **/
+GDataRequestRecord *
+gdata_request_record_copy (const GDataRequestRecord *self)
+{
+	GDataRequestRecord *copy;
+
+	g_return_val_if_fail (self != NULL, NULL);
+
+	copy = g_slice_dup (GDataRequestRecord, self);
+	copy->domain = (self->domain != NULL) ? g_object_ref (self->domain) : NULL;
+	copy->method = g_intern_string (self->method);
+	copy->uri = g_strdup (self->uri);
+
+	return copy;
+}
+
+/**
+ * gdata_request_record_free:
+ * @self: a #GDataRequestRecord returned by gdata_request_record_copy()
+ *
+ * Frees a #GDataRequestRecord.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_request_record_free (GDataRequestRecord *self)
+{
+	if (self == NULL)
+		return;
+
+	if (self->domain != NULL)
+		g_object_unref (self->domain);
+	g_free (self->uri);
+	g_slice_free (GDataRequestRecord, self);
+}
+
+GType
+gdata_request_record_get_type (void)
+{
+	static GType type_id = 0;
+
+	if (type_id == 0) {
+		type_id = g_boxed_type_register_static (g_intern_static_string ("GDataRequestRecord"),
+		                                        (GBoxedCopyFunc) gdata_request_record_copy,
+		                                        (GBoxedFreeFunc) gdata_request_record_free);
+	}
+
+	return type_id;
+}
+
+/* Timing information for a message, built up by the session signal handlers as it's sent (and potentially re-sent), and reported by
+ * emit_request_completed(). All times are monotonic. */
+typedef struct {
+	GDataRequestRecord record;
+
+	gint64 queued;
+	gboolean queue_time_counted; /* whether record.queue_time has been updated for the current attempt */
+	gint64 resolving;
+	gint64 connecting;
+	gint64 tls_handshaking;
+	gint64 wrote_body;
+	gint64 got_headers;
+	gint64 got_body;
+} RequestTimer;
+
+/* Key for a message's RequestTimer */
+#define REQUEST_TIMER_KEY "gdata-service-request-timer"
+
+static void
+request_timer_free (RequestTimer *timer)
+{
+	g_slice_free (RequestTimer, timer);
+}
+
+/* Emits GDataService::request-completed for @message, which must have been sent by @self. If @domain is %NULL, the domain the message was
+ * authorized under is used, if known. */
+static void
+emit_request_completed (GDataService *self, SoupMessage *message, GDataOperationType operation_type, GDataAuthorizationDomain *domain)
+{
+	RequestTimer *timer;
+	GDataRequestRecord *record;
+	SoupURI *uri;
+
+	timer = g_object_get_data (G_OBJECT (message), REQUEST_TIMER_KEY);
+	if (timer == NULL) {
+		/* The message was never sent (for example, it was cancelled first) */
+		return;
+	}
+
+	record = &(timer->record);
+	record->operation_type = operation_type;
+	record->domain = (domain != NULL) ? domain : g_object_get_data (G_OBJECT (message), "gdata-authorization-domain");
+	record->method = message->method;
+	record->status = message->status_code;
+	record->parse_time = (timer->got_body > 0) ? g_get_monotonic_time () - timer->got_body : 0;
+
+	uri = soup_uri_copy (soup_message_get_uri (message));
+	soup_uri_set_query (uri, NULL);
+	soup_uri_set_fragment (uri, NULL);
+	record->uri = soup_uri_to_string (uri, FALSE);
+	soup_uri_free (uri);
+
+	g_signal_emit (self, service_signals[SIGNAL_REQUEST_COMPLETED], 0, record);
+
+	g_free (record->uri);
+
+	/* Each request is only reported once */
+	g_object_set_data (G_OBJECT (message), REQUEST_TIMER_KEY, NULL);
+}
+
 typedef struct {
-	GMutex mutex; /* mutex to prevent cancellation before the message has been added to the session's message queue */
 	SoupSession *session;
 	SoupMessage *message;
+	GCancellable *cancellable;
 } MessageData;
 
 static void
 message_cancel_cb (GCancellable *cancellable, MessageData *data)
 {
-	g_mutex_lock (&(data->mutex));
 	soup_session_cancel_message (data->session, data->message, SOUP_STATUS_CANCELLED);
-	g_mutex_unlock (&(data->mutex));
 }
 
+/* soup_session_cancel_message() has no effect until the session has queued the message, so if the cancellable's cancelled in the short window
+ * between checking it and the message being queued, message_cancel_cb() won't cancel the message. Catch that by checking the cancellable again as
+ * soon as the message makes any progress. These signals are emitted on the message itself, in the thread which is sending it, so unlike the
+ * session's request-queued signal they don't have to be handled for every other thread's messages too. */
 static void
-message_request_queued_cb (SoupSession *session, SoupMessage *message, MessageData *data)
+message_check_cancelled (MessageData *data)
 {
-	if (message == data->message) {
-		g_mutex_unlock (&(data->mutex));
+	if (g_cancellable_is_cancelled (data->cancellable) == TRUE && data->message->status_code != SOUP_STATUS_CANCELLED)
+		soup_session_cancel_message (data->session, data->message, SOUP_STATUS_CANCELLED);
+}
+
+static void
+message_progress_network_event_cb (SoupMessage *message, GSocketClientEvent event, GIOStream *connection, MessageData *data)
+{
+	message_check_cancelled (data);
+}
+
+static void
+message_progress_cb (SoupMessage *message, MessageData *data)
+{
+	message_check_cancelled (data);
+}
+
+static void
+message_progress_chunk_cb (SoupMessage *message, SoupBuffer *chunk, MessageData *data)
+{
+	message_check_cancelled (data);
+}
+
+/* Returns the authorizer which has yet to process @message, if any, removing it from the message so that the message is only processed once */
+static GDataAuthorizer *
+steal_pending_authorizer (SoupMessage *message)
+{
+	return g_object_steal_data (G_OBJECT (message), AUTHORIZATION_PENDING_KEY);
+}
+
+/* Synchronously process @message with its authorizer, if processing was deferred when the message was built. See real_append_query_headers(). */
+static void
+process_pending_authorization (SoupMessage *message)
+{
+	GDataAuthorizer *authorizer;
+
+	authorizer = steal_pending_authorizer (message);
+
+	if (authorizer != NULL) {
+		GDataAuthorizationDomain *domain = g_object_get_data (G_OBJECT (message), "gdata-authorization-domain");
+		gdata_authorizer_process_request (authorizer, domain, message);
+		g_object_unref (authorizer);
 	}
 }
 
 /* Synchronously send @message via @service, handling asynchronous cancellation as best we can. If @cancellable has been cancelled before we start
  * network activity, return without doing any network activity. Otherwise, if @cancellable is cancelled (from another thread) after network activity
- * has started, we wait until the message has been queued by the session, then cancel the network activity and return as soon as possible.
+ * has started, cancel the network activity (or, if the session hasn't queued the message yet, cancel it as soon as it's queued) and return as soon
+ * as possible.
  *
  * If cancellation has been handled, @error is guaranteed to be set to %G_IO_ERROR_CANCELLED. Otherwise, @error is guaranteed to be unset. */
 void
 _gdata_service_actually_send_message (SoupSession *session, SoupMessage *message, GCancellable *cancellable, GError **error)
 {
 	MessageData data;
-	gulong cancel_signal = 0, request_queued_signal = 0;
+	gulong cancel_signal = 0;
+
+	GDATA_TRACE1 (send_start, message);
+
+	/* All synchronous sends come through here, so this is the last chance to authorize the message if that was deferred */
+	process_pending_authorization (message);
 
 	/* Hold references to the session and message so they can't be freed by other threads. For example, if the SoupSession was freed by another
 	 * thread while we were making a request, the request would be unexpectedly cancelled. See bgo#650835 for an example of this breaking things.
@@ -629,24 +1847,20 @@ _gdata_service_actually_send_message (SoupSession *session, SoupMessage *message
 
 	/* Listen for cancellation */
 	if (cancellable != NULL) {
-		g_mutex_init (&(data.mutex));
 		data.session = session;
 		data.message = message;
+		data.cancellable = cancellable;
+
+		g_signal_connect (message, "network-event", (GCallback) message_progress_network_event_cb, &data);
+		g_signal_connect (message, "wrote-headers", (GCallback) message_progress_cb, &data);
+		g_signal_connect (message, "got-headers", (GCallback) message_progress_cb, &data);
+		g_signal_connect (message, "got-chunk", (GCallback) message_progress_chunk_cb, &data);
 
 		cancel_signal = g_cancellable_connect (cancellable, (GCallback) message_cancel_cb, &data, NULL);
-		request_queued_signal = g_signal_connect (session, "request-queued", (GCallback) message_request_queued_cb, &data);
-
-		/* We lock this mutex until the message has been queued by the session (i.e. it's unlocked in the request-queued callback), and require
-		 * the mutex to be held to cancel the message. Consequently, if the message is cancelled (in another thread) any time between this lock
-		 * and the request being queued, the cancellation will wait until the request has been queued before taking effect.
-		 * This is a little ugly, but is the only way I can think of to avoid a race condition between calling soup_session_cancel_message()
-		 * and soup_session_send_message(), as the former doesn't have any effect until the request has been queued, and once the latter has
-		 * returned, all network activity has been finished so cancellation is pointless. */
-		g_mutex_lock (&(data.mutex));
 	}
 
-	/* Only send the message if it hasn't already been cancelled. There is no race condition here for the above reasons: if the cancellable has
-	 * been cancelled, it's because it was cancelled before we called g_cancellable_connect().
+	/* Only send the message if it hasn't already been cancelled. If the cancellable is cancelled after this check, either message_cancel_cb()
+	 * or message_check_cancelled() will cancel the message.
 	 *
 	 * Otherwise, manually set the message's status code to SOUP_STATUS_CANCELLED, as the message was cancelled before even being queued to be
 	 * sent. */
@@ -657,12 +1871,10 @@ _gdata_service_actually_send_message (SoupSession *session, SoupMessage *message
 
 	/* Clean up the cancellation code */
 	if (cancellable != NULL) {
-		g_signal_handler_disconnect (session, request_queued_signal);
-
 		if (cancel_signal != 0)
 			g_cancellable_disconnect (cancellable, cancel_signal);
 
-		g_mutex_clear (&(data.mutex));
+		g_signal_handlers_disconnect_by_data (message, &data);
 	}
 
 	/* Set the cancellation error if applicable. We can't assume that our GCancellable has been cancelled just because the message has;
@@ -686,1301 +1898,7666 @@ _gdata_service_actually_send_message (SoupSession *session, SoupMessage *message
 		soup_message_set_status (message, SOUP_STATUS_CANCELLED);
 	}
 
+	GDATA_TRACE2 (send_end, message, message->status_code);
+
 	/* Free things */
 	g_object_unref (message);
 	g_object_unref (session);
 }
 
-guint
-_gdata_service_send_message (GDataService *self, SoupMessage *message, GCancellable *cancellable, GError **error)
+typedef struct {
+	SoupSession *session;
+	SoupMessage *message;
+	GCancellable *cancellable;
+	GSource *cancel_source; /* cancels the message while it's queued, or %NULL */
+	SoupSessionCallback callback;
+	gpointer user_data;
+} QueueMessageData;
+
+static void
+queue_message_data_free (QueueMessageData *data)
 {
-	/* Based on code from evolution-data-server's libgdata:
-	 *  Ebby Wiselyn <ebbywiselyn@gmail.com>
-	 *  Jason Willis <zenbrother@gmail.com>
-	 *
-	 * Copyright (C) 1999-2008 Novell, Inc. (www.novell.com)
-	 */
+	g_object_unref (data->session);
+	g_object_unref (data->message);
+	if (data->cancellable != NULL)
+		g_object_unref (data->cancellable);
+	g_slice_free (QueueMessageData, data);
+}
 
-	soup_message_set_flags (message, SOUP_MESSAGE_NO_REDIRECT);
-	_gdata_service_actually_send_message (self->priv->session, message, cancellable, error);
-	soup_message_set_flags (message, 0);
+static void
+queue_message_cb (SoupSession *session, SoupMessage *message, QueueMessageData *data)
+{
+	if (data->cancel_source != NULL) {
+		g_source_destroy (data->cancel_source);
+		g_source_unref (data->cancel_source);
+		data->cancel_source = NULL;
+	}
 
-	/* Handle redirections specially so we don't lose our custom headers when making the second request */
-	if (SOUP_STATUS_IS_REDIRECTION (message->status_code)) {
-		SoupURI *new_uri;
-		const gchar *new_location;
+	/* As in _gdata_service_actually_send_message(), make sure cancellation is reported as such, rather than as whatever transport error it
+	 * caused */
+	if (data->cancellable != NULL && g_cancellable_is_cancelled (data->cancellable) == TRUE &&
+	    SOUP_STATUS_IS_TRANSPORT_ERROR (message->status_code) == TRUE) {
+		soup_message_set_status (message, SOUP_STATUS_CANCELLED);
+	}
 
-		new_location = soup_message_headers_get_one (message->response_headers, "Location");
-		g_return_val_if_fail (new_location != NULL, SOUP_STATUS_NONE);
+	GDATA_TRACE2 (send_end, message, message->status_code);
 
-		new_uri = soup_uri_new_with_base (soup_message_get_uri (message), new_location);
-		if (new_uri == NULL) {
-			gchar *uri_string = soup_uri_to_string (new_uri, FALSE);
-			g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
-			             /* Translators: the parameter is the URI which is invalid. */
-			             _("Invalid redirect URI: %s"), uri_string);
-			g_free (uri_string);
-			return SOUP_STATUS_NONE;
-		}
+	data->callback (session, message, data->user_data);
+	queue_message_data_free (data);
+}
 
-		/* Allow overriding the URI for testing. */
-		soup_uri_set_port (new_uri, _gdata_service_get_https_port ());
+static gboolean
+queue_message_cancelled_cb (GCancellable *cancellable, QueueMessageData *data)
+{
+	soup_session_cancel_message (data->session, data->message, SOUP_STATUS_CANCELLED);
 
-		soup_message_set_uri (message, new_uri);
-		soup_uri_free (new_uri);
+	return FALSE;
+}
 
-		/* Send the message again */
-		_gdata_service_actually_send_message (self->priv->session, message, cancellable, error);
+static void
+queue_message_now (QueueMessageData *data)
+{
+	/* The message may have been cancelled while it was being authorized */
+	if (data->cancellable != NULL && g_cancellable_is_cancelled (data->cancellable) == TRUE) {
+		soup_message_set_status (data->message, SOUP_STATUS_CANCELLED);
+		queue_message_cb (data->session, data->message, data);
+		return;
 	}
 
-	/* Not authorised, or authorisation has expired. If we were authorised in the first place, attempt to refresh the authorisation and
-	 * try sending the message again (but only once, so we don't get caught in an infinite loop of denied authorisation errors).
-	 *
-	 * Note that we have to re-process the message with the authoriser so that its authorisation headers get updated after the refresh
-	 * (bgo#653535). */
-	if (message->status_code == SOUP_STATUS_UNAUTHORIZED) {
-		GDataAuthorizer *authorizer = self->priv->authorizer;
+	/* Cancel the message if @cancellable is cancelled while it's queued. The source is destroyed in queue_message_cb(), so it can't outlive the
+	 * message's time on the session. */
+	if (data->cancellable != NULL) {
+		data->cancel_source = g_cancellable_source_new (data->cancellable);
+		g_source_set_callback (data->cancel_source, (GSourceFunc) queue_message_cancelled_cb, data, NULL);
+		g_source_attach (data->cancel_source, g_main_context_get_thread_default ());
+	}
 
-		if (authorizer != NULL && gdata_authorizer_refresh_authorization (authorizer, cancellable, NULL) == TRUE) {
-			GDataAuthorizationDomain *domain;
+	/* soup_session_queue_message() takes ownership of a reference to the message */
+	soup_session_queue_message (data->session, g_object_ref (data->message), (SoupSessionCallback) queue_message_cb, data);
+}
 
-			/* Re-process the request */
-			domain = g_object_get_data (G_OBJECT (message), "gdata-authorization-domain");
-			g_assert (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+static void
+queue_message_process_request_cb (GDataAuthorizer *authorizer, GAsyncResult *async_result, QueueMessageData *data)
+{
+	/* As with gdata_authorizer_process_request(), failing to authorize the message isn't an error here; the server will reject it */
+	gdata_authorizer_process_request_finish (authorizer, async_result, NULL);
+	queue_message_now (data);
+}
 
-			gdata_authorizer_process_request (authorizer, domain, message);
+/* Asynchronously send @message over @session from the thread-default main context, without blocking it; this is the asynchronous counterpart of
+ * _gdata_service_actually_send_message(). As there, the message is sent once, without the redirection, authorization refresh and retry handling of
+ * _gdata_service_send_message_async(). If processing by the authorizer was deferred when the message was built, it's done asynchronously first.
+ *
+ * @callback is called in the thread-default main context once the response has been received, or the message has been cancelled with
+ * soup_session_cancel_message(). If @cancellable is cancelled while the message is being authorized, the message isn't sent; if it's cancelled
+ * once the message has been queued, the message is cancelled. Either way, @callback is called with the message set to %SOUP_STATUS_CANCELLED. */
+void
+_gdata_service_queue_message (SoupSession *session, SoupMessage *message, GCancellable *cancellable, SoupSessionCallback callback, gpointer user_data)
+{
+	QueueMessageData *data;
+	GDataAuthorizer *authorizer;
 
-			/* Send the message again */
-			g_clear_error (error);
-			_gdata_service_actually_send_message (self->priv->session, message, cancellable, error);
-		}
-	}
+	GDATA_TRACE1 (send_start, message);
 
-	return message->status_code;
-}
+	data = g_slice_new (QueueMessageData);
+	data->session = g_object_ref (session);
+	data->message = g_object_ref (message);
+	data->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+	data->cancel_source = NULL;
+	data->callback = callback;
+	data->user_data = user_data;
 
-typedef struct {
-	/* Input */
-	GDataAuthorizationDomain *domain;
-	gchar *feed_uri;
-	GDataQuery *query;
-	GType entry_type;
+	authorizer = steal_pending_authorizer (message);
 
-	/* Output */
-	GDataFeed *feed;
-	GDataQueryProgressCallback progress_callback;
-	gpointer progress_user_data;
-	GDestroyNotify destroy_progress_user_data;
-} QueryAsyncData;
+	if (authorizer != NULL) {
+		GDataAuthorizationDomain *domain = g_object_get_data (G_OBJECT (message), "gdata-authorization-domain");
+
+		gdata_authorizer_process_request_async (authorizer, domain, message, cancellable,
+		                                        (GAsyncReadyCallback) queue_message_process_request_cb, data);
+		g_object_unref (authorizer);
+	} else {
+		queue_message_now (data);
+	}
+}
 
+/* Re-process @message with @authorizer after its authorization has been refreshed, so that its authorization headers are updated (bgo#653535) */
 static void
-query_async_data_free (QueryAsyncData *self)
+reprocess_message (GDataAuthorizer *authorizer, SoupMessage *message)
+{
+	GDataAuthorizationDomain *domain;
+
+	domain = g_object_get_data (G_OBJECT (message), "gdata-authorization-domain");
+	g_assert (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+
+	gdata_authorizer_process_request (authorizer, domain, message);
+}
+
+/* Refresh the service's authorization if it's known to be about to expire. Concurrent refreshes are coalesced by the authorizer, so if several
+ * threads notice at once, only one refresh is made. Returns %TRUE if the authorization was refreshed. */
+static gboolean
+refresh_expiring_authorization (GDataAuthorizer *authorizer, GCancellable *cancellable)
+{
+	if (_gdata_authorizer_is_expiring (authorizer) == FALSE)
+		return FALSE;
+
+	return gdata_authorizer_refresh_authorization (authorizer, cancellable, NULL);
+}
+
+/* The number of times a request is sent before giving up, if the server keeps asking us to slow down and rate limiting is enabled */
+#define MAX_THROTTLED_ATTEMPTS 5
+
+/* Returns the enabled rate limiters which apply to @message: the service-wide one, and the one for its authorization domain. Either is returned as
+ * %NULL if it's not enabled. */
+static void
+get_rate_limiters (GDataService *self, SoupMessage *message, GDataRateLimiter **user_limiter, GDataRateLimiter **domain_limiter)
+{
+	GDataServicePrivate *priv = self->priv;
+	GDataAuthorizationDomain *domain;
+
+	domain = g_object_get_data (G_OBJECT (message), "gdata-authorization-domain");
+
+	g_mutex_lock (&(priv->rate_limiters_mutex));
+	*domain_limiter = (domain != NULL) ? g_hash_table_lookup (priv->domain_rate_limiters, domain) : NULL;
+	g_mutex_unlock (&(priv->rate_limiters_mutex));
+
+	if (*domain_limiter != NULL && gdata_rate_limiter_is_enabled (*domain_limiter) == FALSE)
+		*domain_limiter = NULL;
+
+	*user_limiter = (gdata_rate_limiter_is_enabled (priv->user_rate_limiter) == TRUE) ? priv->user_rate_limiter : NULL;
+}
+
+/* Reserves a slot for @message under the service's rate limits, returning the monotonic time at which it may be sent */
+static gint64
+schedule_message (GDataService *self, SoupMessage *message)
+{
+	GDataRateLimiter *user_limiter, *domain_limiter;
+	gint64 send_time;
+
+	get_rate_limiters (self, message, &user_limiter, &domain_limiter);
+
+	send_time = g_get_monotonic_time ();
+	if (user_limiter != NULL)
+		send_time = MAX (send_time, gdata_rate_limiter_reserve (user_limiter));
+	if (domain_limiter != NULL)
+		send_time = MAX (send_time, gdata_rate_limiter_reserve (domain_limiter));
+
+	return send_time;
+}
+
+/* Returns %TRUE if the response to @message is the server asking us to slow down, rather than a real failure */
+static gboolean
+is_throttling_response (SoupMessage *message)
+{
+	if (message->status_code == 429 /* Too Many Requests */ || message->status_code == SOUP_STATUS_SERVICE_UNAVAILABLE)
+		return TRUE;
+
+	/* Rate limit errors are 403s, distinguished from permission errors by the reason in the error body; this also matches userRateLimitExceeded.
+	 * quotaExceeded errors aren't included, since retrying them won't succeed until the daily quota is reset. The body is searched without
+	 * being parsed, and is at most #GDataService:max-error-response-size bytes long, so this stays cheap when many requests fail at once. */
+	return (message->status_code == SOUP_STATUS_FORBIDDEN && message->response_body != NULL && message->response_body->data != NULL &&
+	        (g_strstr_len (message->response_body->data, message->response_body->length, "rateLimitExceeded") != NULL ||
+	         g_strstr_len (message->response_body->data, message->response_body->length, "RateLimitExceeded") != NULL)) ? TRUE : FALSE;
+}
+
+/* Feeds the response to @message back to the service's rate limiters, so they can adapt their rates. Returns %TRUE if the server asked us to slow
+ * down and rate limiting is enabled for @message, in which case it should be sent again, rather than failed. */
+static gboolean
+update_rate_limiters (GDataService *self, SoupMessage *message)
+{
+	GDataRateLimiter *user_limiter, *domain_limiter;
+	const gchar *retry_after;
+	guint retry_after_seconds = 0;
+
+	get_rate_limiters (self, message, &user_limiter, &domain_limiter);
+
+	if (user_limiter == NULL && domain_limiter == NULL) {
+		return FALSE;
+	} else if (is_throttling_response (message) == FALSE) {
+		if (SOUP_STATUS_IS_SUCCESSFUL (message->status_code)) {
+			if (user_limiter != NULL)
+				gdata_rate_limiter_succeeded (user_limiter);
+			if (domain_limiter != NULL)
+				gdata_rate_limiter_succeeded (domain_limiter);
+		}
+
+		return FALSE;
+	}
+
+	/* Only delays in seconds are supported, not HTTP dates */
+	retry_after = soup_message_headers_get_one (message->response_headers, "Retry-After");
+	if (retry_after != NULL)
+		retry_after_seconds = (guint) MIN (g_ascii_strtoull (retry_after, NULL, 10), G_MAXUINT);
+
+	if (user_limiter != NULL)
+		gdata_rate_limiter_throttled (user_limiter, retry_after_seconds);
+	if (domain_limiter != NULL)
+		gdata_rate_limiter_throttled (domain_limiter, retry_after_seconds);
+
+	return TRUE;
+}
+
+/* Returns the priority of @message, as set from the #GDataQuery it was built for, if any */
+static GDataRequestPriority
+get_message_priority (SoupMessage *message)
+{
+	return GPOINTER_TO_INT (g_object_get_data (G_OBJECT (message), "gdata-request-priority"));
+}
+
+/* The longest delay between retries after transient failures, in seconds */
+#define MAX_RETRY_DELAY 60
+
+/* Set on a message once part of its response body has been handed to a streaming parser; see streaming_query_got_headers_cb() */
+#define RESPONSE_STREAMED_KEY "gdata-response-streamed"
+
+/* Returns %TRUE if @message can safely be sent again after a transient failure; that is, if it's idempotent, and none of the failed response has
+ * been consumed already */
+static gboolean
+is_retryable_message (SoupMessage *message)
+{
+	/* The parser can't be rewound to the start of the response body, so a second attempt's body would be appended to the first's */
+	if (g_object_get_data (G_OBJECT (message), RESPONSE_STREAMED_KEY) != NULL)
+		return FALSE;
+
+	if (message->method == SOUP_METHOD_GET || message->method == SOUP_METHOD_HEAD)
+		return TRUE;
+
+	/* Conditional updates and deletions fail with 412 Precondition Failed if the first attempt actually succeeded, rather than being applied
+	 * twice */
+	return ((message->method == SOUP_METHOD_PUT || message->method == SOUP_METHOD_DELETE || strcmp (message->method, "PATCH") == 0) &&
+	        soup_message_headers_get_one (message->request_headers, "If-Match") != NULL) ? TRUE : FALSE;
+}
+
+/* Returns the number of microseconds to wait before re-sending @message after a transient failure, having already re-sent it @n_retries times; or
+ * -1 if it shouldn't be re-sent, because it didn't fail transiently, it isn't idempotent, it's been retried too many times already or it couldn't be
+ * re-sent before the deadline of @cancellable. */
+static gint64
+get_retry_delay (GDataService *self, SoupMessage *message, guint n_retries, GCancellable *cancellable)
+{
+	gint64 deadline;
+	const gchar *retry_after;
+	gint64 delay;
+
+	switch (message->status_code) {
+		case SOUP_STATUS_INTERNAL_SERVER_ERROR:
+		case SOUP_STATUS_BAD_GATEWAY:
+		case SOUP_STATUS_SERVICE_UNAVAILABLE:
+		case SOUP_STATUS_GATEWAY_TIMEOUT:
+		case SOUP_STATUS_IO_ERROR:
+		case SOUP_STATUS_CANT_CONNECT:
+		case SOUP_STATUS_CANT_CONNECT_PROXY:
+			break;
+		default:
+			return -1;
+	}
+
+	if (n_retries >= (guint) g_atomic_int_get (&(self->priv->max_retries)) || is_retryable_message (message) == FALSE)
+		return -1;
+
+	/* Exponential backoff with "equal jitter": wait at least half of the backoff delay, plus a random amount up to the other half */
+	delay = MIN ((gint64) g_atomic_int_get (&(self->priv->retry_delay)) * 1000 << MIN (n_retries, 16), (gint64) MAX_RETRY_DELAY * G_USEC_PER_SEC);
+	delay = delay / 2 + (gint64) g_random_double_range (0.0, (gdouble) (delay / 2));
+
+	/* Only delays in seconds are supported, not HTTP dates */
+	retry_after = soup_message_headers_get_one (message->response_headers, "Retry-After");
+	if (retry_after != NULL)
+		delay = MAX (delay, (gint64) MIN (g_ascii_strtoull (retry_after, NULL, 10), MAX_RETRY_DELAY) * G_USEC_PER_SEC);
+
+	/* Return the failure now rather than waiting to be cancelled part-way through the retry */
+	deadline = gdata_cancellable_get_deadline (cancellable);
+	if (deadline >= 0 && g_get_monotonic_time () + delay >= deadline)
+		return -1;
+
+	return delay;
+}
+
+/* The maximum number of permanent redirects remembered by each service */
+#define MAX_REDIRECT_CACHE_SIZE 128
+
+static gchar *
+build_redirect_cache_key (SoupMessage *message)
+{
+	gchar *uri, *key;
+
+	uri = soup_uri_to_string (soup_message_get_uri (message), FALSE);
+	key = g_strconcat (message->method, " ", uri, NULL);
+	g_free (uri);
+
+	return key;
+}
+
+/* If @message has been redirected to @new_uri permanently (with a 301 or 308 status), remember the redirect so that later requests to the same URI
+ * go straight to @new_uri. Temporary redirects aren't remembered. The oldest redirects are forgotten once the cache is full. */
+static void
+cache_redirect (GDataService *self, SoupMessage *message, SoupURI *new_uri)
+{
+	GDataServicePrivate *priv = self->priv;
+	gchar *key;
+
+	/* 308 is Permanent Redirect (RFC 7538) */
+	if (message->status_code != SOUP_STATUS_MOVED_PERMANENTLY && message->status_code != 308)
+		return;
+
+	key = build_redirect_cache_key (message);
+
+	g_mutex_lock (&(priv->redirect_cache_mutex));
+
+	/* If the URI's already in the cache, g_hash_table_insert() keeps the existing key (which is the one in redirect_cache_keys) and frees ours */
+	if (g_hash_table_contains (priv->redirect_cache, key) == FALSE)
+		g_queue_push_tail (&(priv->redirect_cache_keys), key);
+	g_hash_table_insert (priv->redirect_cache, key, soup_uri_to_string (new_uri, FALSE));
+
+	if (priv->redirect_cache_keys.length > MAX_REDIRECT_CACHE_SIZE)
+		g_hash_table_remove (priv->redirect_cache, g_queue_pop_head (&(priv->redirect_cache_keys)));
+
+	g_mutex_unlock (&(priv->redirect_cache_mutex));
+}
+
+/* If @message's URI has previously been redirected permanently, send it straight to the URI it was redirected to */
+static void
+apply_cached_redirect (GDataService *self, SoupMessage *message)
+{
+	GDataServicePrivate *priv = self->priv;
+	gchar *key;
+	const gchar *new_location;
+	SoupURI *new_uri = NULL;
+
+	key = build_redirect_cache_key (message);
+
+	g_mutex_lock (&(priv->redirect_cache_mutex));
+	new_location = g_hash_table_lookup (priv->redirect_cache, key);
+	if (new_location != NULL)
+		new_uri = soup_uri_new (new_location);
+	g_mutex_unlock (&(priv->redirect_cache_mutex));
+
+	g_free (key);
+
+	if (new_uri != NULL) {
+		soup_message_set_uri (message, new_uri);
+		soup_uri_free (new_uri);
+	}
+}
+
+/* Sends @message once, following redirects and refreshing the authorization if needed */
+static guint
+send_message_once (GDataService *self, SoupMessage *message, GCancellable *cancellable, GError **error)
+{
+	/* Based on code from evolution-data-server's libgdata:
+	 *  Ebby Wiselyn <ebbywiselyn@gmail.com>
+	 *  Jason Willis <zenbrother@gmail.com>
+	 *
+	 * Copyright (C) 1999-2008 Novell, Inc. (www.novell.com)
+	 */
+
+	GDataAuthorizer *authorizer;
+
+	/* Use the same authorizer for the whole exchange, even if the service's authorizer is changed by another thread in the meantime */
+	authorizer = gdata_service_dup_authorizer (self);
+
+	/* If the authorization is about to expire, refresh it before sending the message, rather than waiting for it to be rejected */
+	if (refresh_expiring_authorization (authorizer, cancellable) == TRUE)
+		reprocess_message (authorizer, message);
+
+	/* Skip the round trip to the old URI if it's been redirected permanently before */
+	apply_cached_redirect (self, message);
+
+	soup_message_set_flags (message, SOUP_MESSAGE_NO_REDIRECT);
+	_gdata_service_actually_send_message (self->priv->session, message, cancellable, error);
+	soup_message_set_flags (message, 0);
+
+	/* Handle redirections specially so we don't lose our custom headers when making the second request */
+	if (SOUP_STATUS_IS_REDIRECTION (message->status_code)) {
+		SoupURI *new_uri;
+		const gchar *new_location;
+
+		new_location = soup_message_headers_get_one (message->response_headers, "Location");
+		if (new_location == NULL) {
+			g_clear_object (&authorizer);
+			g_return_val_if_reached (SOUP_STATUS_NONE);
+		}
+
+		GDATA_TRACE3 (redirect, message, message->status_code, new_location);
+
+		new_uri = soup_uri_new_with_base (soup_message_get_uri (message), new_location);
+		if (new_uri == NULL) {
+			gchar *uri_string = soup_uri_to_string (new_uri, FALSE);
+			g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+			             /* Translators: the parameter is the URI which is invalid. */
+			             _("Invalid redirect URI: %s"), uri_string);
+			g_free (uri_string);
+			g_clear_object (&authorizer);
+			return SOUP_STATUS_NONE;
+		}
+
+		/* Allow overriding the URI for testing. */
+		soup_uri_set_port (new_uri, _gdata_service_get_https_port ());
+
+		cache_redirect (self, message, new_uri);
+		soup_message_set_uri (message, new_uri);
+		soup_uri_free (new_uri);
+
+		/* Send the message again */
+		_gdata_service_actually_send_message (self->priv->session, message, cancellable, error);
+	}
+
+	/* Not authorised, or authorisation has expired. If we were authorised in the first place, attempt to refresh the authorisation and
+	 * try sending the message again (but only once, so we don't get caught in an infinite loop of denied authorisation errors).
+	 *
+	 * Note that we have to re-process the message with the authoriser so that its authorisation headers get updated after the refresh
+	 * (bgo#653535). */
+	if (message->status_code == SOUP_STATUS_UNAUTHORIZED) {
+		GDATA_TRACE1 (auth_refresh, message);
+
+		if (authorizer != NULL && gdata_authorizer_refresh_authorization (authorizer, cancellable, NULL) == TRUE) {
+			/* Re-process the request */
+			reprocess_message (authorizer, message);
+
+			/* Send the message again */
+			g_clear_error (error);
+			_gdata_service_actually_send_message (self->priv->session, message, cancellable, error);
+		}
+	}
+
+	g_clear_object (&authorizer);
+
+	return message->status_code;
+}
+
+guint
+_gdata_service_send_message (GDataService *self, SoupMessage *message, GCancellable *cancellable, GError **error)
+{
+	guint status, n_throttled_attempts = 0, n_retries = 0;
+	gint64 retry_delay = 0, send_time;
+
+	while (TRUE) {
+		/* Wait for our turn under the service's rate limits, if any, and for any delay before retrying; unless that would take us past the
+		 * operation's deadline, in which case give up straight away */
+		send_time = MAX (schedule_message (self, message), g_get_monotonic_time () + retry_delay);
+		if (_gdata_cancellable_shed_past_deadline (cancellable, send_time) == TRUE ||
+		    gdata_rate_limiter_wait_until (send_time, cancellable) == FALSE) {
+			g_cancellable_set_error_if_cancelled (cancellable, error);
+			soup_message_set_status (message, SOUP_STATUS_CANCELLED);
+			return SOUP_STATUS_CANCELLED;
+		}
+
+		/* Wait for a free connection if connections are being reserved for higher priority requests */
+		if (gdata_request_scheduler_acquire (self->priv->request_scheduler, get_message_priority (message), cancellable) == FALSE) {
+			g_cancellable_set_error_if_cancelled (cancellable, error);
+			soup_message_set_status (message, SOUP_STATUS_CANCELLED);
+			return SOUP_STATUS_CANCELLED;
+		}
+
+		status = send_message_once (self, message, cancellable, error);
+
+		gdata_request_scheduler_release (self->priv->request_scheduler, get_message_priority (message));
+
+		/* If the server asked us to slow down, queue the request again rather than failing it */
+		if (update_rate_limiters (self, message) == TRUE && ++n_throttled_attempts < MAX_THROTTLED_ATTEMPTS) {
+			retry_delay = 0;
+			continue;
+		}
+
+		/* Retry transient failures of idempotent requests, if enabled */
+		retry_delay = get_retry_delay (self, message, n_retries, cancellable);
+		if (retry_delay < 0)
+			return status;
+
+		n_retries++;
+	}
+}
+
+typedef struct {
+	GDataService *service;
+	SoupMessage *message;
+	GCancellable *cancellable;
+	GSource *cancel_source;
+	GSource *schedule_source; /* timeout until the message may be sent under the rate limits */
+	GSource *schedule_cancel_source; /* stops waiting for schedule_source if the operation is cancelled */
+	GSource *slot_cancel_source; /* stops waiting for a slot from the request scheduler if the operation is cancelled */
+	gboolean handled_redirect;
+	gboolean refreshed_authorization;
+	guint n_throttled_attempts;
+	guint n_retries;
+	guint status;
+	GError *error;
+} SendMessageAsyncData;
+
+static void
+send_message_async_data_free (SendMessageAsyncData *data)
+{
+	/* The cancel and schedule sources must have been removed before the operation completed */
+	g_assert (data->cancel_source == NULL);
+	g_assert (data->schedule_source == NULL && data->schedule_cancel_source == NULL);
+	g_assert (data->slot_cancel_source == NULL);
+
+	g_object_unref (data->service);
+	g_object_unref (data->message);
+	if (data->cancellable != NULL)
+		g_object_unref (data->cancellable);
+	if (data->error != NULL)
+		g_error_free (data->error);
+
+	g_slice_free (SendMessageAsyncData, data);
+}
+
+/* Sets @error to %G_IO_ERROR_CANCELLED, in the same way as _gdata_service_actually_send_message() does. */
+static void
+set_cancelled_error (GError **error)
+{
+	GCancellable *error_cancellable = g_cancellable_new ();
+	g_cancellable_cancel (error_cancellable);
+	g_assert (g_cancellable_set_error_if_cancelled (error_cancellable, error) == TRUE);
+	g_object_unref (error_cancellable);
+}
+
+static gboolean
+send_message_async_cancelled_cb (GCancellable *cancellable, SendMessageAsyncData *data)
+{
+	/* This is dispatched in the same main context as the message, so it's safe to cancel it directly */
+	soup_session_cancel_message (data->service->priv->session, data->message, SOUP_STATUS_CANCELLED);
+
+	return FALSE;
+}
+
+static void send_message_async_queue (GSimpleAsyncResult *result);
+static void send_message_async_requeue (GSimpleAsyncResult *result);
+static void send_message_async_schedule (GSimpleAsyncResult *result, gint64 delay);
+static void send_message_async_resend (GSimpleAsyncResult *result, gint64 delay);
+
+static void
+send_message_async_refresh_cb (GDataAuthorizer *authorizer, GAsyncResult *async_result, GSimpleAsyncResult *result)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+
+	if (gdata_authorizer_refresh_authorization_finish (authorizer, async_result, NULL) == TRUE) {
+		/* Re-process the request */
+		reprocess_message (authorizer, data->message);
+
+		/* Send the message again */
+		send_message_async_requeue (result);
+	} else {
+		/* Return the original response */
+		data->status = data->message->status_code;
+		g_simple_async_result_complete (result);
+	}
+
+	g_object_unref (result);
+}
+
+static void
+send_message_async_proactive_refresh_cb (GDataAuthorizer *authorizer, GAsyncResult *async_result, GSimpleAsyncResult *result)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+
+	/* Send the message whether or not the refresh succeeded; if it didn't, the message will be handled as normal if it's rejected */
+	if (gdata_authorizer_refresh_authorization_finish (authorizer, async_result, NULL) == TRUE)
+		reprocess_message (authorizer, data->message);
+
+	send_message_async_schedule (result, 0);
+
+	g_object_unref (result);
+}
+
+static void
+send_message_async_handle_response (GSimpleAsyncResult *result, SoupMessage *message)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GDataServicePrivate *priv = data->service->priv;
+	gint64 retry_delay;
+
+	if (data->cancel_source != NULL) {
+		g_source_destroy (data->cancel_source);
+		g_source_unref (data->cancel_source);
+		data->cancel_source = NULL;
+	}
+
+	/* Let the next request have the connection */
+	gdata_request_scheduler_release (priv->request_scheduler, get_message_priority (message));
+
+	/* As in _gdata_service_actually_send_message(), libsoup may report a cancelled message as an I/O error */
+	if (message->status_code == SOUP_STATUS_CANCELLED ||
+	    ((message->status_code == SOUP_STATUS_IO_ERROR || message->status_code == SOUP_STATUS_SSL_FAILED ||
+	      message->status_code == SOUP_STATUS_CANT_CONNECT || message->status_code == SOUP_STATUS_CANT_RESOLVE) &&
+	     data->cancellable != NULL && g_cancellable_is_cancelled (data->cancellable) == TRUE)) {
+		set_cancelled_error (&data->error);
+		soup_message_set_status (message, SOUP_STATUS_CANCELLED);
+		data->status = SOUP_STATUS_CANCELLED;
+		g_simple_async_result_complete (result);
+		return;
+	}
+
+	/* Handle redirections specially so we don't lose our custom headers when making the second request, exactly as in
+	 * _gdata_service_send_message() */
+	if (data->handled_redirect == FALSE) {
+		data->handled_redirect = TRUE;
+		soup_message_set_flags (message, 0);
+
+		if (SOUP_STATUS_IS_REDIRECTION (message->status_code)) {
+			SoupURI *new_uri;
+			const gchar *new_location;
+
+			new_location = soup_message_headers_get_one (message->response_headers, "Location");
+			new_uri = (new_location != NULL) ? soup_uri_new_with_base (soup_message_get_uri (message), new_location) : NULL;
+
+			GDATA_TRACE3 (redirect, message, message->status_code, new_location);
+
+			if (new_uri == NULL) {
+				g_set_error (&data->error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+				             /* Translators: the parameter is the URI which is invalid. */
+				             _("Invalid redirect URI: %s"), (new_location != NULL) ? new_location : "");
+				data->status = SOUP_STATUS_NONE;
+				g_simple_async_result_complete (result);
+				return;
+			}
+
+			/* Allow overriding the URI for testing. */
+			soup_uri_set_port (new_uri, _gdata_service_get_https_port ());
+
+			cache_redirect (data->service, message, new_uri);
+			soup_message_set_uri (message, new_uri);
+			soup_uri_free (new_uri);
+
+			/* Send the message again */
+			send_message_async_requeue (result);
+			return;
+		}
+	}
+
+	/* Not authorised, or authorisation has expired. Refresh the authorisation and try once more, as in _gdata_service_send_message(). */
+	if (message->status_code == SOUP_STATUS_UNAUTHORIZED && data->refreshed_authorization == FALSE) {
+		GDataAuthorizer *authorizer = gdata_service_dup_authorizer (data->service);
+
+		if (authorizer != NULL) {
+			data->refreshed_authorization = TRUE;
+
+			GDATA_TRACE1 (auth_refresh, message);
+
+			gdata_authorizer_refresh_authorization_async (authorizer, data->cancellable,
+			                                              (GAsyncReadyCallback) send_message_async_refresh_cb, g_object_ref (result));
+			g_object_unref (authorizer);
+			return;
+		}
+	}
+
+	/* If the server asked us to slow down, queue the request again rather than failing it, as in _gdata_service_send_message() */
+	if (update_rate_limiters (data->service, message) == TRUE && ++data->n_throttled_attempts < MAX_THROTTLED_ATTEMPTS) {
+		send_message_async_resend (result, 0);
+		return;
+	}
+
+	/* Retry transient failures of idempotent requests, if enabled */
+	retry_delay = get_retry_delay (data->service, message, data->n_retries, data->cancellable);
+	if (retry_delay >= 0) {
+		data->n_retries++;
+		send_message_async_resend (result, retry_delay);
+		return;
+	}
+
+	data->status = message->status_code;
+	g_simple_async_result_complete (result);
+}
+
+static void
+send_message_async_cb (SoupSession *session, SoupMessage *message, GSimpleAsyncResult *result)
+{
+	send_message_async_handle_response (result, message);
+
+	/* Drop the reference which was passed to soup_session_queue_message() */
+	g_object_unref (result);
+}
+
+/* Queues the message on the session, once a slot has been acquired for it from the request scheduler */
+static void
+send_message_async_send (GSimpleAsyncResult *result)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+
+	if (data->cancellable != NULL) {
+		if (g_cancellable_is_cancelled (data->cancellable) == TRUE) {
+			gdata_request_scheduler_release (data->service->priv->request_scheduler, get_message_priority (data->message));
+			set_cancelled_error (&data->error);
+			soup_message_set_status (data->message, SOUP_STATUS_CANCELLED);
+			data->status = SOUP_STATUS_CANCELLED;
+			g_simple_async_result_complete_in_idle (result);
+			return;
+		}
+
+		data->cancel_source = g_cancellable_source_new (data->cancellable);
+		g_source_set_callback (data->cancel_source, (GSourceFunc) send_message_async_cancelled_cb, data, NULL);
+		g_source_attach (data->cancel_source, g_main_context_get_thread_default ());
+	}
+
+	/* soup_session_queue_message() takes ownership of a reference to the message, and we need to keep our own for the retries */
+	g_object_ref (data->message);
+	soup_session_queue_message (data->service->priv->session, data->message, (SoupSessionCallback) send_message_async_cb,
+	                            g_object_ref (result));
+}
+
+static void
+send_message_async_clear_slot_cancel_source (SendMessageAsyncData *data)
+{
+	if (data->slot_cancel_source != NULL) {
+		g_source_destroy (data->slot_cancel_source);
+		g_source_unref (data->slot_cancel_source);
+		data->slot_cancel_source = NULL;
+	}
+}
+
+static gboolean
+send_message_async_slot_ready_cb (GSimpleAsyncResult *result)
+{
+	send_message_async_clear_slot_cancel_source (g_simple_async_result_get_op_res_gpointer (result));
+
+	/* This completes the operation if it's been cancelled in the meantime */
+	send_message_async_send (result);
+
+	return FALSE;
+}
+
+static gboolean
+send_message_async_slot_cancelled_cb (GCancellable *cancellable, GSimpleAsyncResult *result)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+
+	send_message_async_clear_slot_cancel_source (data);
+
+	/* If a slot has already been granted, send_message_async_slot_ready_cb() is about to be called, and will handle the cancellation */
+	if (gdata_request_scheduler_cancel (data->service->priv->request_scheduler, result) == TRUE) {
+		set_cancelled_error (&data->error);
+		soup_message_set_status (data->message, SOUP_STATUS_CANCELLED);
+		data->status = SOUP_STATUS_CANCELLED;
+		g_simple_async_result_complete (result);
+	}
+
+	return FALSE;
+}
+
+/* Sends the message, waiting for a slot from the request scheduler first if connections are being reserved for higher priority requests */
+static void
+send_message_async_queue (GSimpleAsyncResult *result)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+
+	if (gdata_request_scheduler_acquire_async (data->service->priv->request_scheduler, get_message_priority (data->message),
+	                                           (GSourceFunc) send_message_async_slot_ready_cb, g_object_ref (result), g_object_unref) == TRUE) {
+		send_message_async_send (result);
+		return;
+	}
+
+	if (data->cancellable != NULL) {
+		data->slot_cancel_source = g_cancellable_source_new (data->cancellable);
+		g_source_set_callback (data->slot_cancel_source, (GSourceFunc) send_message_async_slot_cancelled_cb, g_object_ref (result),
+		                       g_object_unref);
+		g_source_attach (data->slot_cancel_source, g_main_context_get_thread_default ());
+	}
+}
+
+static void
+send_message_async_clear_schedule (SendMessageAsyncData *data)
+{
+	if (data->schedule_source != NULL) {
+		g_source_destroy (data->schedule_source);
+		g_source_unref (data->schedule_source);
+		data->schedule_source = NULL;
+	}
+
+	if (data->schedule_cancel_source != NULL) {
+		g_source_destroy (data->schedule_cancel_source);
+		g_source_unref (data->schedule_cancel_source);
+		data->schedule_cancel_source = NULL;
+	}
+}
+
+static gboolean
+send_message_async_scheduled_cb (GSimpleAsyncResult *result)
+{
+	send_message_async_clear_schedule (g_simple_async_result_get_op_res_gpointer (result));
+
+	/* This completes the operation if it's been cancelled while waiting */
+	send_message_async_queue (result);
+
+	return FALSE;
+}
+
+static gboolean
+send_message_async_schedule_cancelled_cb (GCancellable *cancellable, GSimpleAsyncResult *result)
+{
+	return send_message_async_scheduled_cb (result);
+}
+
+/* Sends the message again after a redirection or an authorization refresh. This is called from (or, for an authorizer which refreshes
+ * synchronously, may be called from) send_message_async_cb(), and libsoup only releases the message's queue item once that callback has returned,
+ * so the message mustn't be queued on the session again until then. soup_session_requeue_message() can't be used either, since it only works on
+ * messages which are still in the queue. Instead, the message is queued again from an idle source in the thread-default main context. */
+static void
+send_message_async_requeue (GSimpleAsyncResult *result)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+
+	g_assert (data->schedule_source == NULL);
+
+	/* This completes the operation if it's been cancelled in the meantime */
+	data->schedule_source = g_idle_source_new ();
+	g_source_set_callback (data->schedule_source, (GSourceFunc) send_message_async_scheduled_cb, g_object_ref (result), g_object_unref);
+	g_source_attach (data->schedule_source, g_main_context_get_thread_default ());
+}
+
+/* Queues the message once it may be sent under the service's rate limits, and at least @delay microseconds from now, using a timeout source rather
+ * than blocking */
+static void
+send_message_async_schedule (GSimpleAsyncResult *result, gint64 delay)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	gint64 send_time, now;
+
+	now = g_get_monotonic_time ();
+	send_time = MAX (schedule_message (data->service, data->message), now + delay);
+
+	/* This completes the operation as cancelled if waiting would take it past its deadline. As for a timeout, the message is queued from an
+	 * idle source rather than directly, since this may be called from send_message_async_cb(); see send_message_async_requeue(). */
+	if (send_time <= now || _gdata_cancellable_shed_past_deadline (data->cancellable, send_time) == TRUE) {
+		send_message_async_requeue (result);
+		return;
+	}
+
+	data->schedule_source = g_timeout_source_new ((guint) MIN ((send_time - now + 999) / 1000, G_MAXUINT));
+	g_source_set_callback (data->schedule_source, (GSourceFunc) send_message_async_scheduled_cb, g_object_ref (result), g_object_unref);
+	g_source_attach (data->schedule_source, g_main_context_get_thread_default ());
+
+	if (data->cancellable != NULL) {
+		data->schedule_cancel_source = g_cancellable_source_new (data->cancellable);
+		g_source_set_callback (data->schedule_cancel_source, (GSourceFunc) send_message_async_schedule_cancelled_cb, g_object_ref (result),
+		                       g_object_unref);
+		g_source_attach (data->schedule_cancel_source, g_main_context_get_thread_default ());
+	}
+}
+
+/* Sends the message again, at least @delay microseconds from now, after it was throttled or failed transiently. Each attempt follows its own
+ * redirection and refreshes the authorization if it's rejected, as send_message_once() does for each attempt in _gdata_service_send_message(). */
+static void
+send_message_async_resend (GSimpleAsyncResult *result, gint64 delay)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+
+	data->handled_redirect = FALSE;
+	data->refreshed_authorization = FALSE;
+
+	apply_cached_redirect (data->service, data->message);
+	soup_message_set_flags (data->message, SOUP_MESSAGE_NO_REDIRECT);
+
+	send_message_async_schedule (result, delay);
+}
+
+/* Starts sending the message, refreshing the authorization first if it's about to expire, as in _gdata_service_send_message() */
+static void
+send_message_async_start (GSimpleAsyncResult *result)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GDataAuthorizer *authorizer;
+
+	authorizer = gdata_service_dup_authorizer (data->service);
+
+	if (_gdata_authorizer_is_expiring (authorizer) == TRUE) {
+		gdata_authorizer_refresh_authorization_async (authorizer, data->cancellable,
+		                                              (GAsyncReadyCallback) send_message_async_proactive_refresh_cb, g_object_ref (result));
+	} else {
+		send_message_async_schedule (result, 0);
+	}
+
+	g_clear_object (&authorizer);
+}
+
+static void
+send_message_async_process_request_cb (GDataAuthorizer *authorizer, GAsyncResult *async_result, GSimpleAsyncResult *result)
+{
+	SendMessageAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	if (gdata_authorizer_process_request_finish (authorizer, async_result, &error) == FALSE &&
+	    g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == TRUE) {
+		/* Don't send the message if the operation's been cancelled */
+		g_propagate_error (&data->error, error);
+		soup_message_set_status (data->message, SOUP_STATUS_CANCELLED);
+		data->status = SOUP_STATUS_CANCELLED;
+		g_simple_async_result_complete (result);
+	} else {
+		/* If processing failed for any other reason, send the message anyway, and let the server decide whether it needs authorizing (in
+		 * which case it'll be handled like any other unauthorized response) */
+		g_clear_error (&error);
+		send_message_async_start (result);
+	}
+
+	g_object_unref (result);
+}
+
+/*
+ * _gdata_service_send_message_async:
+ * @self: a #GDataService
+ * @message: the #SoupMessage to send
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the message has been sent
+ * @user_data: (closure): data to pass to @callback
+ *
+ * Sends @message without blocking, handling redirections, authorization refreshes, rate limiting and retries in the same way as
+ * _gdata_service_send_message(). The
+ * message is queued on the service's #SoupSession, and @callback is called in the thread-default main context of the calling thread once the
+ * response has been received; no thread is tied up while the request is in flight.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_service_send_message_async (GDataService *self, SoupMessage *message, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	SendMessageAsyncData *data;
+	GDataAuthorizer *authorizer;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (SOUP_IS_MESSAGE (message));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	data = g_slice_new0 (SendMessageAsyncData);
+	data->service = g_object_ref (self);
+	data->message = g_object_ref (message);
+	data->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, _gdata_service_send_message_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) send_message_async_data_free);
+
+	apply_cached_redirect (self, message);
+	soup_message_set_flags (message, SOUP_MESSAGE_NO_REDIRECT);
+
+	/* If authorizing the message was deferred when it was built, authorize it now without blocking */
+	authorizer = steal_pending_authorizer (message);
+
+	if (authorizer != NULL) {
+		gdata_authorizer_process_request_async (authorizer, g_object_get_data (G_OBJECT (message), "gdata-authorization-domain"), message,
+		                                        cancellable, (GAsyncReadyCallback) send_message_async_process_request_cb,
+		                                        g_object_ref (result));
+		g_object_unref (authorizer);
+	} else {
+		send_message_async_start (result);
+	}
+
+	g_object_unref (result);
+}
+
+/*
+ * _gdata_service_send_message_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an operation started with _gdata_service_send_message_async(). The return value and @error follow the same conventions as for
+ * _gdata_service_send_message(): @error is only set if the message was cancelled or couldn't be redirected, in which case the status is
+ * %SOUP_STATUS_CANCELLED or %SOUP_STATUS_NONE respectively.
+ *
+ * Return value: the final HTTP status of the message
+ *
+ * Since: 0.15.0
+ */
+guint
+_gdata_service_send_message_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	SendMessageAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), SOUP_STATUS_NONE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), SOUP_STATUS_NONE);
+	g_return_val_if_fail (error == NULL || *error == NULL, SOUP_STATUS_NONE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == _gdata_service_send_message_async);
+
+	data = g_simple_async_result_get_op_res_gpointer (result);
+
+	if (data->error != NULL)
+		g_propagate_error (error, g_error_copy (data->error));
+
+	return data->status;
+}
+
+/* Hedged requests; see #GDataService:hedge-delay. The times taken to receive the response headers of the most recent hedgeable requests are kept
+ * in a ring buffer, so that requests are only hedged once they've taken longer than most do. */
+#define HEDGE_MIN_SAMPLES 16
+#define HEDGE_PERCENTILE 95
+
+static gint
+compare_gint64 (gconstpointer a, gconstpointer b)
+{
+	gint64 _a = *((const gint64*) a), _b = *((const gint64*) b);
+	return (_a < _b) ? -1 : (_a > _b) ? 1 : 0;
+}
+
+/* Returns how long to wait for the response headers of @message before sending a second copy of it, in microseconds; or -1 if it shouldn't be
+ * hedged, because hedging is disabled or the message isn't idempotent. */
+static gint64
+get_hedge_delay (GDataService *self, SoupMessage *message)
+{
+	GDataServicePrivate *priv = self->priv;
+	gint64 delay, samples[HEDGE_SAMPLES];
+	guint n_samples;
+
+	delay = (gint64) g_atomic_int_get (&(priv->hedge_delay)) * 1000;
+	if (delay == 0 || message->method != SOUP_METHOD_GET)
+		return -1;
+
+	g_mutex_lock (&(priv->hedge_samples_mutex));
+	n_samples = priv->n_hedge_samples;
+	memcpy (samples, priv->hedge_samples, n_samples * sizeof (*samples));
+	g_mutex_unlock (&(priv->hedge_samples_mutex));
+
+	/* Once enough requests have been seen, only hedge those which are slower than the given percentile */
+	if (n_samples >= HEDGE_MIN_SAMPLES) {
+		qsort (samples, n_samples, sizeof (*samples), compare_gint64);
+		delay = MAX (delay, samples[n_samples * HEDGE_PERCENTILE / 100]);
+	}
+
+	return delay;
+}
+
+static void
+add_hedge_sample (GDataService *self, gint64 latency)
+{
+	GDataServicePrivate *priv = self->priv;
+
+	g_mutex_lock (&(priv->hedge_samples_mutex));
+	priv->hedge_samples[priv->next_hedge_sample] = latency;
+	priv->next_hedge_sample = (priv->next_hedge_sample + 1) % HEDGE_SAMPLES;
+	priv->n_hedge_samples = MIN (priv->n_hedge_samples + 1, HEDGE_SAMPLES);
+	g_mutex_unlock (&(priv->hedge_samples_mutex));
+}
+
+static void
+copy_header_cb (const gchar *name, const gchar *value, SoupMessageHeaders *headers)
+{
+	soup_message_headers_append (headers, name, value);
+}
+
+/* Builds an identical copy of the GET @message to send as a hedge */
+static SoupMessage *
+copy_hedge_message (SoupMessage *message)
+{
+	SoupMessage *copy;
+	GDataAuthorizationDomain *domain;
+	GDataAuthorizer *pending_authorizer;
+
+	copy = soup_message_new_from_uri (message->method, soup_message_get_uri (message));
+	soup_message_headers_foreach (message->request_headers, (SoupMessageHeadersForeachFunc) copy_header_cb, copy->request_headers);
+
+	domain = g_object_get_data (G_OBJECT (message), "gdata-authorization-domain");
+	if (domain != NULL)
+		g_object_set_data_full (G_OBJECT (copy), "gdata-authorization-domain", g_object_ref (domain), (GDestroyNotify) g_object_unref);
+
+	/* If the original hasn't been authorized yet, the copy has to be authorized separately when it's sent */
+	pending_authorizer = g_object_get_data (G_OBJECT (message), AUTHORIZATION_PENDING_KEY);
+	if (pending_authorizer != NULL) {
+		g_object_set_data_full (G_OBJECT (copy), AUTHORIZATION_PENDING_KEY, g_object_ref (pending_authorizer),
+		                        (GDestroyNotify) g_object_unref);
+	}
+
+	_gdata_service_claim_message (g_object_get_data (G_OBJECT (message), MESSAGE_SERVICE_KEY), copy);
+	g_object_set_data (G_OBJECT (copy), "gdata-request-priority", g_object_get_data (G_OBJECT (message), "gdata-request-priority"));
+
+	return copy;
+}
+
+/* Replaces the response of @message with that of @hedge, so the hedge's response can be used as if it were @message's own */
+static void
+take_hedge_response (SoupMessage *message, SoupMessage *hedge)
+{
+	SoupBuffer *buffer;
+
+	soup_message_set_uri (message, soup_message_get_uri (hedge));
+	soup_message_set_status_full (message, hedge->status_code, hedge->reason_phrase);
+
+	soup_message_headers_clear (message->response_headers);
+	soup_message_headers_foreach (hedge->response_headers, (SoupMessageHeadersForeachFunc) copy_header_cb, message->response_headers);
+
+	soup_message_body_truncate (message->response_body);
+	buffer = soup_message_body_flatten (hedge->response_body);
+	soup_message_body_append_buffer (message->response_body, buffer);
+	soup_buffer_free (buffer);
+
+	/* Make sure response_body->data is set, as callers expect */
+	buffer = soup_message_body_flatten (message->response_body);
+	soup_buffer_free (buffer);
+}
+
+typedef struct _HedgedSend HedgedSend;
+
+/* One of the (up to) two copies of a hedged request */
+typedef struct {
+	HedgedSend *send;
+	SoupMessage *message;
+	GCancellable *cancellable; /* cancels just this copy */
+	gint64 start_time;
+	gulong got_headers_signal;
+	volatile gint got_headers;
+	guint status;
+	GError *error;
+} HedgeAttempt;
+
+struct _HedgedSend {
+	GDataService *service;
+	GMutex mutex; /* protects winner in the synchronous case, and is used with cond to wait for it */
+	GCond cond;
+	HedgeAttempt attempts[2]; /* the original message, then the hedge */
+	guint n_attempts;
+	HedgeAttempt *winner; /* the first copy to finish, or %NULL */
+	volatile gint got_headers; /* whether either copy has received its response headers */
+
+	GCancellable *cancellable;
+	gulong cancelled_signal;
+
+	/* Asynchronous case only; these are only touched in the main context the request was started in */
+	GSource *hedge_source;
+	guint n_pending;
+	GSimpleAsyncResult *result;
+};
+
+static void
+hedge_attempt_got_headers_cb (SoupMessage *message, HedgeAttempt *attempt)
+{
+	HedgedSend *send = attempt->send;
+
+	/* This is also emitted for redirects and authorization failures, but only the first response counts */
+	if (g_atomic_int_compare_and_exchange (&(attempt->got_headers), 0, 1) == FALSE)
+		return;
+
+	add_hedge_sample (send->service, g_get_monotonic_time () - attempt->start_time);
+
+	g_mutex_lock (&(send->mutex));
+	g_atomic_int_set (&(send->got_headers), 1);
+	g_cond_broadcast (&(send->cond));
+	g_mutex_unlock (&(send->mutex));
+}
+
+static HedgeAttempt *
+hedged_send_add_attempt (HedgedSend *send, SoupMessage *message)
+{
+	HedgeAttempt *attempt = &(send->attempts[send->n_attempts++]);
+
+	attempt->message = g_object_ref (message);
+	attempt->start_time = g_get_monotonic_time ();
+	attempt->got_headers_signal = g_signal_connect (message, "got-headers", (GCallback) hedge_attempt_got_headers_cb, attempt);
+
+	return attempt;
+}
+
+static void
+hedged_send_cancelled_cb (GCancellable *cancellable, HedgedSend *send)
+{
+	/* The attempts' cancellables are created up front, so this is safe whichever thread it's called in */
+	g_cancellable_cancel (send->attempts[0].cancellable);
+	g_cancellable_cancel (send->attempts[1].cancellable);
+}
+
+static HedgedSend *
+hedged_send_new (GDataService *self, SoupMessage *message, GCancellable *cancellable)
+{
+	HedgedSend *send;
+	guint i;
+
+	send = g_slice_new0 (HedgedSend);
+	send->service = g_object_ref (self);
+	g_mutex_init (&(send->mutex));
+	g_cond_init (&(send->cond));
+
+	for (i = 0; i < G_N_ELEMENTS (send->attempts); i++) {
+		send->attempts[i].send = send;
+		send->attempts[i].cancellable = g_cancellable_new ();
+	}
+
+	hedged_send_add_attempt (send, message);
+
+	if (cancellable != NULL) {
+		send->cancellable = g_object_ref (cancellable);
+		send->cancelled_signal = g_cancellable_connect (cancellable, (GCallback) hedged_send_cancelled_cb, send, NULL);
+	}
+
+	return send;
+}
+
+/* Uses the winning copy's response as the response to the original message, and returns its status and error, freeing @send. All the copies
+ * must have finished. */
+static guint
+hedged_send_free (HedgedSend *send, GError **error)
+{
+	HedgeAttempt *winner = send->winner;
+	guint status, i;
+
+	if (send->cancellable != NULL) {
+		g_cancellable_disconnect (send->cancellable, send->cancelled_signal);
+		g_object_unref (send->cancellable);
+	}
+
+	if (winner != &(send->attempts[0]))
+		take_hedge_response (send->attempts[0].message, winner->message);
+
+	status = winner->status;
+	if (winner->error != NULL) {
+		g_propagate_error (error, winner->error);
+		winner->error = NULL;
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (send->attempts); i++) {
+		HedgeAttempt *attempt = &(send->attempts[i]);
+
+		if (attempt->message != NULL) {
+			g_signal_handler_disconnect (attempt->message, attempt->got_headers_signal);
+			g_object_unref (attempt->message);
+		}
+
+		g_object_unref (attempt->cancellable);
+		g_clear_error (&(attempt->error));
+	}
+
+	g_cond_clear (&(send->cond));
+	g_mutex_clear (&(send->mutex));
+	g_object_unref (send->service);
+	g_slice_free (HedgedSend, send);
+
+	return status;
+}
+
+/* Cancels all the copies except the winner, which must have been set */
+static void
+hedged_send_cancel_losers (HedgedSend *send)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (send->attempts); i++) {
+		if (&(send->attempts[i]) != send->winner)
+			g_cancellable_cancel (send->attempts[i].cancellable);
+	}
+}
+
+static gpointer
+hedge_attempt_thread (HedgeAttempt *attempt)
+{
+	HedgedSend *send = attempt->send;
+	GError *error = NULL;
+	guint status;
+
+	status = _gdata_service_send_message (send->service, attempt->message, attempt->cancellable, &error);
+
+	g_mutex_lock (&(send->mutex));
+
+	attempt->status = status;
+	attempt->error = error;
+
+	if (send->winner == NULL)
+		send->winner = attempt;
+
+	g_cond_broadcast (&(send->cond));
+	g_mutex_unlock (&(send->mutex));
+
+	return NULL;
+}
+
+/* Equivalent to _gdata_service_send_message(), but if #GDataService:hedge-delay is set and @message is a GET request whose response headers
+ * haven't been received within the hedge delay, sends an identical copy of @message, which libsoup will send on another connection. Whichever
+ * copy finishes first is used as the response to @message, and the other is cancelled. */
+static guint
+send_hedged_message (GDataService *self, SoupMessage *message, GCancellable *cancellable, GError **error)
+{
+	HedgedSend *send;
+	GThread *threads[2] = { NULL, NULL };
+	gint64 hedge_delay, deadline;
+	guint i;
+
+	hedge_delay = get_hedge_delay (self, message);
+	if (hedge_delay < 0)
+		return _gdata_service_send_message (self, message, cancellable, error);
+
+	send = hedged_send_new (self, message, cancellable);
+	threads[0] = g_thread_try_new ("hedged-request-thread", (GThreadFunc) hedge_attempt_thread, &(send->attempts[0]), NULL);
+
+	if (threads[0] == NULL) {
+		/* Fall back to sending the message without hedging */
+		hedge_attempt_thread (&(send->attempts[0]));
+		return hedged_send_free (send, error);
+	}
+
+	deadline = g_get_monotonic_time () + hedge_delay;
+
+	g_mutex_lock (&(send->mutex));
+
+	while (send->winner == NULL && g_atomic_int_get (&(send->got_headers)) == 0) {
+		if (g_cond_wait_until (&(send->cond), &(send->mutex), deadline) == FALSE)
+			break;
+	}
+
+	/* Nothing's been heard back from the server in time, so send another copy */
+	if (send->winner == NULL && g_atomic_int_get (&(send->got_headers)) == 0 &&
+	    g_cancellable_is_cancelled (send->attempts[1].cancellable) == FALSE) {
+		SoupMessage *hedge = copy_hedge_message (message);
+		HedgeAttempt *attempt = hedged_send_add_attempt (send, hedge);
+
+		GDATA_TRACE1 (send_hedge, message);
+
+		threads[1] = g_thread_try_new ("hedged-request-thread", (GThreadFunc) hedge_attempt_thread, attempt, NULL);
+		g_object_unref (hedge);
+	}
+
+	while (send->winner == NULL)
+		g_cond_wait (&(send->cond), &(send->mutex));
+
+	g_mutex_unlock (&(send->mutex));
+
+	/* Cancel the loser, and wait for it to finish so that it's no longer using its message */
+	hedged_send_cancel_losers (send);
+
+	for (i = 0; i < G_N_ELEMENTS (threads); i++) {
+		if (threads[i] != NULL)
+			g_thread_join (threads[i]);
+	}
+
+	return hedged_send_free (send, error);
+}
+
+static void hedge_attempt_async_cb (GDataService *service, GAsyncResult *async_result, HedgeAttempt *attempt);
+
+static gboolean
+hedged_send_timeout_cb (HedgedSend *send)
+{
+	HedgeAttempt *attempt;
+	SoupMessage *hedge;
+
+	g_source_unref (send->hedge_source);
+	send->hedge_source = NULL;
+
+	if (send->winner != NULL || g_atomic_int_get (&(send->got_headers)) != 0 ||
+	    g_cancellable_is_cancelled (send->attempts[1].cancellable) == TRUE) {
+		return FALSE;
+	}
+
+	/* Nothing's been heard back from the server in time, so send another copy */
+	hedge = copy_hedge_message (send->attempts[0].message);
+	attempt = hedged_send_add_attempt (send, hedge);
+
+	GDATA_TRACE1 (send_hedge, send->attempts[0].message);
+
+	send->n_pending++;
+	_gdata_service_send_message_async (send->service, hedge, attempt->cancellable, (GAsyncReadyCallback) hedge_attempt_async_cb, attempt);
+	g_object_unref (hedge);
+
+	return FALSE;
+}
+
+static void
+hedge_attempt_async_cb (GDataService *service, GAsyncResult *async_result, HedgeAttempt *attempt)
+{
+	HedgedSend *send = attempt->send;
+	GSimpleAsyncResult *result;
+	GError *error = NULL;
+	guint status;
+
+	attempt->status = _gdata_service_send_message_finish (service, async_result, &(attempt->error));
+
+	if (send->winner == NULL) {
+		send->winner = attempt;
+
+		/* Stop waiting to send a hedge, and cancel the other copy if it's been sent */
+		if (send->hedge_source != NULL) {
+			g_source_destroy (send->hedge_source);
+			g_source_unref (send->hedge_source);
+			send->hedge_source = NULL;
+		}
+
+		hedged_send_cancel_losers (send);
+	}
+
+	/* Wait for the loser to finish too, since it may still be using the message whose response is going to be replaced */
+	if (--send->n_pending > 0)
+		return;
+
+	result = send->result;
+	status = hedged_send_free (send, &error);
+
+	g_simple_async_result_set_op_res_gssize (result, status);
+	if (error != NULL)
+		g_simple_async_result_take_error (result, error);
+
+	g_simple_async_result_complete (result);
+	g_object_unref (result);
+}
+
+/* Asynchronous version of send_hedged_message(). @callback is called in the thread-default main context of the calling thread. */
+static void
+send_hedged_message_async (GDataService *self, SoupMessage *message, GCancellable *cancellable, GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+	HedgedSend *send;
+	gint64 hedge_delay;
+
+	send = hedged_send_new (self, message, cancellable);
+	send->result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, send_hedged_message_async);
+	send->n_pending = 1;
+
+	hedge_delay = get_hedge_delay (self, message);
+	if (hedge_delay >= 0) {
+		send->hedge_source = g_timeout_source_new ((guint) (hedge_delay / 1000));
+		g_source_set_callback (send->hedge_source, (GSourceFunc) hedged_send_timeout_cb, send, NULL);
+		g_source_attach (send->hedge_source, g_main_context_get_thread_default ());
+	}
+
+	_gdata_service_send_message_async (self, message, send->attempts[0].cancellable, (GAsyncReadyCallback) hedge_attempt_async_cb,
+	                                   &(send->attempts[0]));
+}
+
+/* Finishes send_hedged_message_async(), following the same conventions as _gdata_service_send_message_finish() */
+static guint
+send_hedged_message_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == send_hedged_message_async);
+
+	g_simple_async_result_propagate_error (result, error);
+	return (guint) g_simple_async_result_get_op_res_gssize (result);
+}
+
+typedef struct {
+	/* Input */
+	GDataAuthorizationDomain *domain;
+	gchar *feed_uri;
+	GDataQuery *query;
+	GType entry_type;
+
+	/* Output */
+	GDataFeed *feed;
+	GDataQueryProgressCallback progress_callback;
+	GDataQueryBatchProgressCallback batch_progress_callback; /* mutually exclusive with progress_callback */
+	gpointer progress_user_data;
+	GDestroyNotify destroy_progress_user_data;
+	guint batch_size;
+	guint batch_interval; /* in milliseconds */
+	guint max_concurrent_pages; /* non-zero to fetch all pages of the feed with gdata_service_query_all_async() */
+	GMainContext *context; /* thread-default main context of the thread which started the query, to dispatch the progress callbacks in */
+} QueryAsyncData;
+
+typedef struct {
+	GDataQueryBatchProgressCallback progress_callback;
+	gpointer progress_user_data;
+	GPtrArray *entries;
+	guint first_entry_key;
+	guint entry_count;
+} ProgressBatch;
+
+typedef struct {
+	QueryAsyncData *query_data;
+	GPtrArray *entries; /* entries which have been parsed but not yet delivered */
+	guint first_entry_key;
+	guint entry_count;
+	gint64 batch_start_time; /* monotonic time, in microseconds, when the first entry in @entries was parsed */
+} ProgressBatcher;
+
+static gboolean
+progress_batch_idle (ProgressBatch *batch)
+{
+	batch->progress_callback (batch->entries, batch->first_entry_key, batch->entry_count, batch->progress_user_data);
+
+	g_ptr_array_unref (batch->entries);
+	g_slice_free (ProgressBatch, batch);
+
+	return FALSE;
+}
+
+static void
+progress_batcher_flush (ProgressBatcher *batcher)
+{
+	ProgressBatch *batch;
+
+	if (batcher->entries->len == 0)
+		return;
+
+	batch = g_slice_new (ProgressBatch);
+	batch->progress_callback = batcher->query_data->batch_progress_callback;
+	batch->progress_user_data = batcher->query_data->progress_user_data;
+	batch->entries = batcher->entries;
+	batch->first_entry_key = batcher->first_entry_key;
+	batch->entry_count = batcher->entry_count;
+
+	/* Use the same priority as the per-entry progress callbacks, so that the batches are delivered in order, and before the GAsyncResult's
+	 * callback */
+	_gdata_service_progress_idle_add (_gdata_service_get_callback_service (), batcher->query_data->context, (GSourceFunc) progress_batch_idle,
+	                                  batch, NULL);
+
+	batcher->entries = g_ptr_array_new_with_free_func (g_object_unref);
+}
+
+/* A GDataQueryProgressCallback which is called synchronously in the query thread, and collects the entries into batches */
+static void
+progress_batcher_add_entry_cb (GDataEntry *entry, guint entry_key, guint entry_count, ProgressBatcher *batcher)
+{
+	QueryAsyncData *query_data = batcher->query_data;
+	gint64 now = g_get_monotonic_time ();
+
+	if (batcher->entries->len == 0) {
+		batcher->first_entry_key = entry_key;
+		batcher->batch_start_time = now;
+	}
+
+	g_ptr_array_add (batcher->entries, g_object_ref (entry));
+	batcher->entry_count = entry_count;
+
+	if ((query_data->batch_size > 0 && batcher->entries->len >= query_data->batch_size) ||
+	    (query_data->batch_interval > 0 && now - batcher->batch_start_time >= (gint64) query_data->batch_interval * 1000)) {
+		progress_batcher_flush (batcher);
+	}
+}
+
+static gboolean
+destroy_progress_user_data_idle (QueryAsyncData *data)
+{
+	data->destroy_progress_user_data (data->progress_user_data);
+	return FALSE;
+}
+
+static void
+query_async_data_free (QueryAsyncData *self)
 {
 	if (self->domain != NULL)
 		g_object_unref (self->domain);
 
-	g_free (self->feed_uri);
-	if (self->query)
-		g_object_unref (self->query);
-	if (self->feed)
-		g_object_unref (self->feed);
+	g_free (self->feed_uri);
+	if (self->query)
+		g_object_unref (self->query);
+	if (self->feed)
+		g_object_unref (self->feed);
+	g_main_context_unref (self->context);
+
+	g_slice_free (QueryAsyncData, self);
+}
+
+static void
+query_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+{
+	GError *error = NULL;
+	QueryAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+
+	/* Dispatch the progress callbacks in the same main context as the GSimpleAsyncResult will be completed in */
+	_gdata_service_push_callback_context (service, data->context);
+
+	/* Execute the query and return */
+	if (data->batch_progress_callback != NULL) {
+		ProgressBatcher batcher;
+
+		/* Collect the entries synchronously in this thread, and only schedule a main loop callback for each batch of them */
+		batcher.query_data = data;
+		batcher.entries = g_ptr_array_new_with_free_func (g_object_unref);
+		batcher.first_entry_key = 0;
+		batcher.entry_count = 0;
+		batcher.batch_start_time = 0;
+
+		data->feed = __gdata_service_query (service, data->domain, data->feed_uri, data->query, data->entry_type, cancellable,
+		                                    (GDataQueryProgressCallback) progress_batcher_add_entry_cb, &batcher, &error, FALSE);
+
+		progress_batcher_flush (&batcher);
+		g_ptr_array_unref (batcher.entries);
+	} else if (data->max_concurrent_pages > 0) {
+		data->feed = __gdata_service_query_all (service, data->domain, data->feed_uri, data->query, data->entry_type, data->max_concurrent_pages,
+		                                        cancellable, data->progress_callback, data->progress_user_data, &error, TRUE);
+	} else {
+		data->feed = __gdata_service_query (service, data->domain, data->feed_uri, data->query, data->entry_type, cancellable,
+		                                    data->progress_callback, data->progress_user_data, &error, TRUE);
+	}
+
+	if (data->feed == NULL && error != NULL) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+
+	if (data->destroy_progress_user_data != NULL) {
+		/* Make sure the user data outlives the progress callbacks which are still queued in the main context. The GSimpleAsyncResult holds a
+		 * reference to @data until after this idle callback, since it's queued with the same priority before the result completes. */
+		_gdata_service_idle_add (data->context, (GSourceFunc) destroy_progress_user_data_idle, data, NULL);
+	}
+
+	_gdata_service_pop_callback_context ();
+}
+
+/**
+ * gdata_service_query_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @feed_uri: the feed URI to query, including the host name and protocol
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @progress_callback: (allow-none) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
+ * @progress_user_data: (closure): data to pass to the @progress_callback function
+ * @destroy_progress_user_data: (allow-none): the function to call when @progress_callback will not be called any more, or %NULL. This function will be
+ * called with @progress_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the query is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Queries the service's @feed_uri feed to build a #GDataFeed. @self, @feed_uri and
+ * @query are all reffed/copied when this function is called, so can safely be freed after this function returns.
+ *
+ * For more details, see gdata_service_query(), which is the synchronous version of this function.
+ *
+ * @progress_callback, @destroy_progress_user_data and @callback are all called in the thread-default main context of the thread which called this
+ * function (see g_main_context_push_thread_default()). Progress callbacks for entries which are parsed in quick succession are dispatched together,
+ * from a single idle source.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_query_finish()
+ * to get the results of the operation.
+ *
+ * Since: 0.9.1
+ **/
+void
+gdata_service_query_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                           GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                           GDestroyNotify destroy_progress_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	QueryAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (feed_uri != NULL);
+	g_return_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new (QueryAsyncData);
+	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
+	data->feed_uri = g_strdup (feed_uri);
+	data->query = (query != NULL) ? g_object_ref (query) : NULL;
+	data->entry_type = entry_type;
+	data->feed = NULL;
+	data->progress_callback = progress_callback;
+	data->batch_progress_callback = NULL;
+	data->progress_user_data = progress_user_data;
+	data->destroy_progress_user_data = destroy_progress_user_data;
+	data->batch_size = 0;
+	data->batch_interval = 0;
+	data->max_concurrent_pages = 0;
+	data->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_service_query_batched_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @feed_uri: the feed URI to query, including the host name and protocol
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @batch_size: the maximum number of entries to pass to each call of @progress_callback, or <code class="literal">0</code> for no limit
+ * @batch_interval: the maximum time (in milliseconds) to hold entries before passing them to @progress_callback, or <code class="literal">0</code>
+ * for no limit
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @progress_callback: (allow-none) (closure progress_user_data): a #GDataQueryBatchProgressCallback to call when a batch of entries is loaded,
+ * or %NULL
+ * @progress_user_data: (closure): data to pass to the @progress_callback function
+ * @destroy_progress_user_data: (allow-none): the function to call when @progress_callback will not be called any more, or %NULL. This function will be
+ * called with @progress_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the query is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Queries the service's @feed_uri feed to build a #GDataFeed, in the same manner as gdata_service_query_async(). Rather than calling a progress
+ * callback for each entry (and waking up the main loop for each one), entries are delivered to @progress_callback in batches: a batch is
+ * delivered once it contains @batch_size entries, or once @batch_interval milliseconds have passed since its first entry was parsed (this is
+ * checked as each entry is parsed), whichever happens first. Any remaining entries are delivered once parsing is complete. If both @batch_size
+ * and @batch_interval are <code class="literal">0</code>, all the entries are delivered in a single batch.
+ *
+ * As with gdata_service_query_async(), @progress_callback, @destroy_progress_user_data and @callback are all called in the thread-default main
+ * context of the thread which called this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_query_finish()
+ * to get the results of the operation.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_query_batched_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query,
+                                   GType entry_type, guint batch_size, guint batch_interval, GCancellable *cancellable,
+                                   GDataQueryBatchProgressCallback progress_callback, gpointer progress_user_data,
+                                   GDestroyNotify destroy_progress_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	QueryAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (feed_uri != NULL);
+	g_return_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new (QueryAsyncData);
+	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
+	data->feed_uri = g_strdup (feed_uri);
+	data->query = (query != NULL) ? g_object_ref (query) : NULL;
+	data->entry_type = entry_type;
+	data->feed = NULL;
+	data->progress_callback = NULL;
+	data->batch_progress_callback = progress_callback;
+	data->progress_user_data = progress_user_data;
+	data->destroy_progress_user_data = destroy_progress_user_data;
+	data->batch_size = batch_size;
+	data->batch_interval = batch_interval;
+	data->max_concurrent_pages = 0;
+	data->context = g_main_context_ref_thread_default ();
+
+	/* Use the same source tag as gdata_service_query_async(), so that gdata_service_query_finish() can be used for both */
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_service_query_all_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @feed_uri: the feed URI to query, including the host name and protocol
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @max_concurrent_pages: the maximum number of pages to request at once; must be greater than <code class="literal">0</code>
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @progress_callback: (allow-none) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
+ * @progress_user_data: (closure): data to pass to the @progress_callback function
+ * @destroy_progress_user_data: (allow-none): the function to call when @progress_callback will not be called any more, or %NULL. This function will be
+ * called with @progress_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the query is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Queries the service's @feed_uri feed and fetches all the pages of the results. @self, @feed_uri and @query are all reffed/copied when this
+ * function is called, so can safely be freed after this function returns.
+ *
+ * For more details, see gdata_service_query_all(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_query_finish()
+ * to get the results of the operation.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_query_all_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                               guint max_concurrent_pages, GCancellable *cancellable, GDataQueryProgressCallback progress_callback,
+                               gpointer progress_user_data, GDestroyNotify destroy_progress_user_data, GAsyncReadyCallback callback,
+                               gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	QueryAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (feed_uri != NULL);
+	g_return_if_fail (query == NULL || GDATA_IS_QUERY (query));
+	g_return_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY));
+	g_return_if_fail (max_concurrent_pages > 0);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new (QueryAsyncData);
+	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
+	data->feed_uri = g_strdup (feed_uri);
+	data->query = (query != NULL) ? g_object_ref (query) : NULL;
+	data->entry_type = entry_type;
+	data->feed = NULL;
+	data->progress_callback = progress_callback;
+	data->batch_progress_callback = NULL;
+	data->progress_user_data = progress_user_data;
+	data->destroy_progress_user_data = destroy_progress_user_data;
+	data->batch_size = 0;
+	data->batch_interval = 0;
+	data->max_concurrent_pages = max_concurrent_pages;
+	data->context = g_main_context_ref_thread_default ();
+
+	/* Use the same source tag as gdata_service_query_async(), so that gdata_service_query_finish() can be used for both */
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_service_query_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous query operation started with gdata_service_query_async().
+ *
+ * Return value: (transfer full): a #GDataFeed of query results, or %NULL; unref with g_object_unref()
+ **/
+GDataFeed *
+gdata_service_query_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	QueryAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_query_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	data = g_simple_async_result_get_op_res_gpointer (result);
+	if (data->feed != NULL)
+		return g_object_ref (data->feed);
+	return NULL;
+}
+
+/* Builds a GET request for @feed_uri with @query's parameters. If @etag is non-%NULL, the request is made conditional on it; otherwise on @query's
+ * ETag, if it has one. */
+static SoupMessage *
+build_conditional_query_message (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query,
+                                 const gchar *etag)
+{
+	SoupMessage *message;
+
+	/* Append the ETag header if possible */
+	if (etag == NULL && query != NULL)
+		etag = gdata_query_get_etag (query);
+
+	/* Build the message */
+	if (query != NULL) {
+		message = _gdata_service_build_message (self, domain, SOUP_METHOD_GET, _gdata_query_peek_query_uri (query, feed_uri), etag, FALSE);
+
+		g_object_set_data (G_OBJECT (message), "gdata-request-priority", GINT_TO_POINTER (gdata_query_get_priority (query)));
+	} else {
+		message = _gdata_service_build_message (self, domain, SOUP_METHOD_GET, feed_uri, etag, FALSE);
+	}
+
+	return message;
+}
+
+static SoupMessage *
+build_query_message (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query)
+{
+	return build_conditional_query_message (self, domain, feed_uri, query, NULL);
+}
+
+/* Returns TRUE if @message's response status is SOUP_STATUS_OK. Otherwise, sets @error as appropriate for the status and returns FALSE. */
+static gboolean
+check_query_response_status (GDataService *self, SoupMessage *message, guint status, GError **error)
+{
+	if (status == SOUP_STATUS_NOT_MODIFIED || status == SOUP_STATUS_CANCELLED) {
+		/* Not modified (ETag has worked), or cancelled (in which case the error has been set) */
+		return FALSE;
+	} else if (status != SOUP_STATUS_OK) {
+		/* Error */
+		GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (self);
+		g_assert (klass->parse_error_response != NULL);
+		klass->parse_error_response (self, GDATA_OPERATION_QUERY, status, message->reason_phrase, message->response_body->data,
+		                             message->response_body->length, error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+void
+_gdata_service_add_poll_scheduler (GDataService *self, GDataPollScheduler *scheduler)
+{
+	g_mutex_lock (&(self->priv->config_mutex));
+	self->priv->poll_schedulers = g_slist_prepend (self->priv->poll_schedulers, scheduler);
+	g_mutex_unlock (&(self->priv->config_mutex));
+}
+
+void
+_gdata_service_remove_poll_scheduler (GDataService *self, GDataPollScheduler *scheduler)
+{
+	g_mutex_lock (&(self->priv->config_mutex));
+	self->priv->poll_schedulers = g_slist_remove (self->priv->poll_schedulers, scheduler);
+	g_mutex_unlock (&(self->priv->config_mutex));
+}
+
+/* Tells the service's poll schedulers whether the feed queried with @feed_uri and @query had changed since it was last queried */
+static void
+record_poll (GDataService *self, const gchar *feed_uri, GDataQuery *query, gboolean changed)
+{
+	GSList *schedulers, *i;
+
+	/* Don't call out to the schedulers with config_mutex held. A scheduler being disposed can still be reffed, since it only removes itself
+	 * from the list in its dispose() function. */
+	g_mutex_lock (&(self->priv->config_mutex));
+	schedulers = g_slist_copy_deep (self->priv->poll_schedulers, (GCopyFunc) g_object_ref, NULL);
+	g_mutex_unlock (&(self->priv->config_mutex));
+
+	for (i = schedulers; i != NULL; i = i->next)
+		_gdata_poll_scheduler_record_poll (i->data, feed_uri, query, changed);
+
+	g_slist_free_full (schedulers, g_object_unref);
+}
+
+/* Does the bulk of the work of gdata_service_query. Split out because certain queries (such as that done by
+ * gdata_service_query_single_entry()) only return a single entry, and thus need special parsing code. */
+SoupMessage *
+_gdata_service_query (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query,
+                      GCancellable *cancellable, GError **error)
+{
+	SoupMessage *message;
+	guint status;
+
+	message = build_query_message (self, domain, feed_uri, query);
+
+	/* Note that cancellation only applies to network activity; not to the processing done afterwards */
+	status = _gdata_service_send_message (self, message, cancellable, error);
+
+	if (check_query_response_status (self, message, status, error) == FALSE) {
+		g_object_unref (message);
+		return NULL;
+	}
+
+	return message;
+}
+
+static gboolean
+is_json_response (SoupMessage *message)
+{
+	const gchar *content_type = soup_message_headers_get_content_type (message->response_headers, NULL);
+	return (content_type != NULL && strcmp (content_type, "application/json") == 0) ? TRUE : FALSE;
+}
+
+/* A response loaded from the feed cache. Cache files contain the response's ETag and Content-Type on a line each, followed by its body. */
+typedef struct {
+	gchar *contents; /* the whole file, with the line breaks after the headers replaced by nul bytes */
+	const gchar *etag;
+	const gchar *content_type;
+	const gchar *body;
+	gsize body_length;
+} CachedFeed;
+
+static void
+cached_feed_free (CachedFeed *cached)
+{
+	g_free (cached->contents);
+	g_slice_free (CachedFeed, cached);
+}
+
+/* Returns the path of the feed cache file for @uri, or %NULL if the feed cache is disabled */
+static gchar *
+feed_cache_get_path (GDataService *self, const gchar *uri)
+{
+	gchar *checksum, *path;
+
+	if (self->priv->cache_directory == NULL)
+		return NULL;
+
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+	path = g_build_filename (self->priv->cache_directory, checksum, NULL);
+	g_free (checksum);
+
+	return path;
+}
+
+/* Returns the cached response at @path, or %NULL if there's no (valid) cached response */
+static CachedFeed *
+feed_cache_load (const gchar *path)
+{
+	CachedFeed *cached;
+	gchar *contents, *etag_end, *content_type_end;
+	gsize length;
+
+	if (g_file_get_contents (path, &contents, &length, NULL) == FALSE)
+		return NULL;
+
+	etag_end = memchr (contents, '\n', length);
+	content_type_end = (etag_end != NULL) ? memchr (etag_end + 1, '\n', length - (etag_end + 1 - contents)) : NULL;
+
+	if (content_type_end == NULL || etag_end == contents || content_type_end + 1 == contents + length) {
+		/* Corrupt cache file, or one with no body */
+		g_free (contents);
+		return NULL;
+	}
+
+	*etag_end = '\0';
+	*content_type_end = '\0';
+
+	cached = g_slice_new (CachedFeed);
+	cached->contents = contents;
+	cached->etag = contents;
+	cached->content_type = etag_end + 1;
+	cached->body = content_type_end + 1;
+	cached->body_length = length - (content_type_end + 1 - contents);
+
+	return cached;
+}
+
+/* A response being stored in the feed cache. The response is written to a temporary file alongside the cache file as its body arrives, so it never
+ * has to be held in memory as a whole, and the temporary file replaces the cache file once the whole response has been received. Failures are
+ * ignored; the cache is only an optimisation. */
+typedef struct {
+	gchar *path;
+	gchar *temp_path;
+	GOutputStream *stream;
+	gsize body_length;
+	gboolean failed;
+} FeedCacheWriter;
+
+/* Starts storing the response to @message at @path, once its headers have been received. Returns %NULL if the response isn't cacheable, or the
+ * temporary file couldn't be created. */
+static FeedCacheWriter *
+feed_cache_writer_new (const gchar *path, SoupMessage *message)
+{
+	FeedCacheWriter *writer;
+	const gchar *etag, *content_type;
+	GFile *temp_file;
+	GFileOutputStream *stream;
+	gchar *dirname, *temp_path, *headers;
+
+	etag = soup_message_headers_get_one (message->response_headers, "ETag");
+	content_type = soup_message_headers_get_content_type (message->response_headers, NULL);
+
+	if (etag == NULL || *etag == '\0' || strchr (etag, '\n') != NULL) {
+		/* Can't revalidate the response, so there's no point caching it; and remove any stale version so it doesn't get revalidated */
+		g_unlink (path);
+		return NULL;
+	}
+
+	dirname = g_path_get_dirname (path);
+	g_mkdir_with_parents (dirname, 0700);
+	g_free (dirname);
+
+	/* Several threads may be storing the same query's response at once, so each needs its own temporary file */
+	temp_path = g_strdup_printf ("%s.%08x.tmp", path, g_random_int ());
+	temp_file = g_file_new_for_path (temp_path);
+	stream = g_file_create (temp_file, G_FILE_CREATE_PRIVATE, NULL, NULL);
+	g_object_unref (temp_file);
+
+	if (stream == NULL) {
+		g_debug ("Failed to create feed cache file '%s'.", temp_path);
+		g_free (temp_path);
+		return NULL;
+	}
+
+	writer = g_slice_new0 (FeedCacheWriter);
+	writer->path = g_strdup (path);
+	writer->temp_path = temp_path;
+	writer->stream = G_OUTPUT_STREAM (stream);
+
+	headers = g_strdup_printf ("%s\n%s\n", etag, (content_type != NULL) ? content_type : "");
+	writer->failed = !g_output_stream_write_all (writer->stream, headers, strlen (headers), NULL, NULL, NULL);
+	g_free (headers);
+
+	return writer;
+}
+
+/* Appends the next part of the response body */
+static void
+feed_cache_writer_append (FeedCacheWriter *writer, const gchar *data, gsize length)
+{
+	if (writer->failed == FALSE && g_output_stream_write_all (writer->stream, data, length, NULL, NULL, NULL) == FALSE)
+		writer->failed = TRUE;
+
+	writer->body_length += length;
+}
+
+/* Finishes storing the response and frees @writer. If @success is %TRUE, the whole response has been received, and replaces any cached version;
+ * otherwise the cache is left as it was. */
+static void
+feed_cache_writer_finish (FeedCacheWriter *writer, gboolean success)
+{
+	if (g_output_stream_close (writer->stream, NULL, NULL) == FALSE)
+		writer->failed = TRUE;
+
+	if (success == TRUE && writer->body_length == 0) {
+		/* There's nothing to build a feed from, so remove any stale version so it doesn't get revalidated */
+		g_unlink (writer->temp_path);
+		g_unlink (writer->path);
+	} else if (success == FALSE || writer->failed == TRUE) {
+		g_unlink (writer->temp_path);
+	} else if (g_rename (writer->temp_path, writer->path) != 0) {
+		g_debug ("Failed to store feed cache file '%s'.", writer->path);
+		g_unlink (writer->temp_path);
+	}
+
+	g_object_unref (writer->stream);
+	g_free (writer->temp_path);
+	g_free (writer->path);
+	g_slice_free (FeedCacheWriter, writer);
+}
+
+/* Stores the response to @message (with the given @body, which has been received in full), if it's cacheable */
+static void
+feed_cache_store (const gchar *path, SoupMessage *message, const gchar *body, gsize body_length)
+{
+	FeedCacheWriter *writer;
+
+	writer = feed_cache_writer_new (path, message);
+	if (writer == NULL)
+		return;
+
+	feed_cache_writer_append (writer, body, body_length);
+	feed_cache_writer_finish (writer, TRUE);
+}
+
+typedef struct {
+	GDataService *service;
+	SoupMessage *message;
+	GCancellable *cancellable;
+
+	/* Successful XML response bodies are pushed into here by the network thread as they arrive, and popped out by the parser */
+	GDataBuffer *buffer;
+
+	GMutex mutex; /* protects is_streaming and is_finished */
+	GCond cond;
+	gboolean is_streaming; /* TRUE once the headers of a successful XML response have been received */
+	gboolean is_finished; /* TRUE once network activity has finished */
+
+	guint status; /* only valid once is_finished is TRUE */
+	GError *error; /* only valid once is_finished is TRUE */
+
+	const gchar *cache_path; /* where to store the response in the feed cache, or NULL if it's not being cached */
+	FeedCacheWriter *cache_writer; /* stores the streamed response body in the feed cache as it arrives; owned by the network thread until it's
+	                                * finished */
+} StreamingQueryData;
+
+static void
+streaming_query_got_headers_cb (SoupMessage *message, StreamingQueryData *data)
+{
+	/* Only stream successful XML responses. Anything else (redirections, authorisation failures which are about to be retried, errors and
+	 * JSON) gets accumulated in the message's response body as usual, and is dealt with once the message has finished. */
+	if (message->status_code != SOUP_STATUS_OK || is_json_response (message) == TRUE)
+		return;
+
+	/* Don't accumulate the response body: each chunk is handed straight to the parser, and freed once it's been consumed. This also means the
+	 * message can't be retried if the connection fails part-way through the body. */
+	soup_message_body_set_accumulate (message->response_body, FALSE);
+	g_object_set_data (G_OBJECT (message), RESPONSE_STREAMED_KEY, GINT_TO_POINTER (TRUE));
+
+	if (data->cache_path != NULL && data->cache_writer == NULL)
+		data->cache_writer = feed_cache_writer_new (data->cache_path, message);
+
+	g_mutex_lock (&(data->mutex));
+	data->is_streaming = TRUE;
+	g_cond_signal (&(data->cond));
+	g_mutex_unlock (&(data->mutex));
+}
+
+static void
+streaming_query_got_chunk_cb (SoupMessage *message, SoupBuffer *buffer, StreamingQueryData *data)
+{
+	/* is_streaming is only ever written from this thread, so it's safe to read it without the lock */
+	if (data->is_streaming == FALSE || buffer->length == 0)
+		return;
+
+	if (data->cache_writer != NULL)
+		feed_cache_writer_append (data->cache_writer, buffer->data, buffer->length);
+
+	/* Reference the buffer rather than copying it */
+	buffer = soup_buffer_copy (buffer);
+	gdata_buffer_push_data_full (data->buffer, (const guint8*) buffer->data, buffer->length, (GDestroyNotify) soup_buffer_free, buffer);
+}
+
+static void
+streaming_query_thread (StreamingQueryData *data, gpointer user_data)
+{
+	guint status;
+	GError *error = NULL;
+
+	status = _gdata_service_send_message (data->service, data->message, data->cancellable, &error);
+
+	g_mutex_lock (&(data->mutex));
+	data->status = status;
+	data->error = error;
+	data->is_finished = TRUE;
+
+	/* Mark the end of the response body, so that the parser stops blocking. This is done after setting is_finished so that the parser knows
+	 * the message has finished once it reaches the end of the body, and before unlocking, since @data may be freed as soon as the querying
+	 * thread sees is_finished. */
+	gdata_buffer_push_data (data->buffer, NULL, 0);
+
+	g_cond_signal (&(data->cond));
+	g_mutex_unlock (&(data->mutex));
+}
+
+/* Returns the pool of threads, shared by all services, which send the messages for streamed queries while the querying threads parse the
+ * responses. Threads are reused between queries rather than one being created for each. The pool isn't limited, since each query's parser is
+ * blocked until its message has been sent, and queries may be made from any number of threads. */
+static GThreadPool *
+get_streaming_query_pool (void)
+{
+	static gsize pool = 0;
+
+	if (g_once_init_enter (&pool) == TRUE)
+		g_once_init_leave (&pool, (gsize) g_thread_pool_new ((GFunc) streaming_query_thread, NULL, -1, FALSE, NULL));
+
+	return (GThreadPool*) pool;
+}
+
+static int
+streaming_query_read_cb (StreamingQueryData *data, char *buffer, int len)
+{
+	gboolean reached_eof = FALSE;
+
+	/* This blocks until len bytes are available or the network thread has finished. Cancellation of the query is handled by the network
+	 * thread, which marks the end of the buffer once the message has been cancelled. */
+	return (int) gdata_buffer_pop_data (data->buffer, (guint8*) buffer, len, &reached_eof, NULL);
+}
+
+/* Marks each of @entries as only containing the fields selected by @entry_fields (if it's non-%NULL) */
+static void
+mark_partial_entries (GList *entries, const gchar *entry_fields)
+{
+	GList *i;
+
+	if (entry_fields == NULL)
+		return;
+
+	for (i = entries; i != NULL; i = i->next)
+		_gdata_entry_set_partial_fields (GDATA_ENTRY (i->data), entry_fields);
+}
+
+/* Makes a request for the query and parses the response into a feed. This doesn't update @query; see __gdata_service_query(). If the response is
+ * streamed and parsed as XML, @next_link_callback is passed to _gdata_feed_new_from_xml_input(). */
+static GDataFeed *
+fetch_query_feed (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                  GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                  GDataFeedNextLinkCallback next_link_callback, gpointer next_link_user_data, GError **error, gboolean is_async)
+{
+	GDataServiceClass *klass;
+	GDataFeed *feed = NULL;
+	StreamingQueryData data;
+	GError *child_error = NULL;
+	gulong got_headers_signal, got_chunk_signal;
+	gchar *cache_path = NULL;
+	CachedFeed *cached_feed = NULL;
+	const gchar *page_etag = NULL;
+	gboolean retain_entries, cancelled_message = FALSE;
+
+	klass = GDATA_SERVICE_GET_CLASS (self);
+	retain_entries = (query == NULL || gdata_query_get_retain_entries (query) == TRUE) ? TRUE : FALSE;
+
+	/* Look up the query in the feed cache, unless the caller is doing their own ETag handling */
+	if (self->priv->cache_directory != NULL && (query == NULL || gdata_query_get_etag (query) == NULL)) {
+		cache_path = feed_cache_get_path (self, (query != NULL) ? _gdata_query_peek_query_uri (query, feed_uri) : feed_uri);
+		if (cache_path != NULL)
+			cached_feed = feed_cache_load (cache_path);
+	}
+
+	/* Failing that, make the query conditional on the page's ETag from the last time the query fetched it, if it remembers its pages */
+	if (cached_feed == NULL && query != NULL && gdata_query_get_etag (query) == NULL)
+		page_etag = _gdata_query_get_page_etag (query, _gdata_query_peek_query_uri (query, feed_uri));
+
+	/* Send the message in a thread from the shared pool, and parse the response body in this one as it arrives, rather than waiting for the
+	 * whole body to be downloaded before starting to parse it. This is the same approach as taken by GDataDownloadStream. */
+	data.service = self;
+	data.message = build_conditional_query_message (self, domain, feed_uri, query, (cached_feed != NULL) ? cached_feed->etag : page_etag);
+	data.cancellable = cancellable;
+	data.buffer = gdata_buffer_new ();
+	g_mutex_init (&(data.mutex));
+	g_cond_init (&(data.cond));
+	data.is_streaming = FALSE;
+	data.is_finished = FALSE;
+	data.status = SOUP_STATUS_NONE;
+	data.error = NULL;
+	data.cache_path = cache_path;
+	data.cache_writer = NULL;
+
+	got_headers_signal = g_signal_connect (data.message, "got-headers", (GCallback) streaming_query_got_headers_cb, &data);
+	got_chunk_signal = g_signal_connect (data.message, "got-chunk", (GCallback) streaming_query_got_chunk_cb, &data);
+
+	if (g_thread_pool_push (get_streaming_query_pool (), &data, &child_error) == FALSE) {
+		/* Fall back to sending the message in this thread */
+		g_clear_error (&child_error);
+		streaming_query_thread (&data, NULL);
+	}
+
+	/* Wait until we know whether the response is going to be streamed */
+	g_mutex_lock (&(data.mutex));
+	while (data.is_streaming == FALSE && data.is_finished == FALSE)
+		g_cond_wait (&(data.cond), &(data.mutex));
+	g_mutex_unlock (&(data.mutex));
+
+	if (data.is_streaming == TRUE) {
+		/* Potentially XML. Don't bother checking the Content-Type, since the parser
+		 * will fail gracefully if the response body is not valid XML. */
+		g_debug ("XML content type detected.");
+		feed = _gdata_feed_new_from_xml_input (klass->feed_type, (xmlInputReadCallback) streaming_query_read_cb, &data,
+		                                       (query != NULL) ? _gdata_query_get_parse_mode (query) : GDATA_UNHANDLED_XML_KEEP,
+		                                       (query != NULL) ? gdata_query_get_parse_threads (query) : 1,
+		                                       entry_type, progress_callback, progress_user_data, is_async, retain_entries,
+		                                       next_link_callback, next_link_user_data, &child_error);
+
+		/* Don't bother downloading the rest of the response if it's failed to parse */
+		if (feed == NULL) {
+			g_mutex_lock (&(data.mutex));
+			if (data.is_finished == FALSE) {
+				soup_session_cancel_message (self->priv->session, data.message, SOUP_STATUS_CANCELLED);
+				cancelled_message = TRUE;
+			}
+			g_mutex_unlock (&(data.mutex));
+		}
+	}
+
+	/* Wait for the network thread to finish with the message */
+	g_mutex_lock (&(data.mutex));
+	while (data.is_finished == FALSE)
+		g_cond_wait (&(data.cond), &(data.mutex));
+	g_mutex_unlock (&(data.mutex));
+
+	g_signal_handler_disconnect (data.message, got_chunk_signal);
+	g_signal_handler_disconnect (data.message, got_headers_signal);
+
+	if (data.is_streaming == TRUE) {
+		if (feed == NULL && (cancelled_message == TRUE || (data.error == NULL && data.status == SOUP_STATUS_OK))) {
+			/* Parse error; this takes precedence over the cancellation error we've caused ourselves */
+			g_propagate_error (error, child_error);
+			g_clear_error (&(data.error));
+		} else if (data.error != NULL || data.status != SOUP_STATUS_OK) {
+			/* The connection failed or the query was cancelled part-way through the response body, so the feed is incomplete (or failed
+			 * to parse because it was truncated) */
+			g_clear_object (&feed);
+			g_clear_error (&child_error);
+
+			if (data.error != NULL)
+				g_propagate_error (error, data.error);
+			else
+				check_query_response_status (self, data.message, data.status, error);
+		}
+
+		/* Only replace the cached response if the whole of the new one has been received and parsed */
+		if (data.cache_writer != NULL)
+			feed_cache_writer_finish (data.cache_writer, (feed != NULL) ? TRUE : FALSE);
+	} else if (data.error != NULL) {
+		g_propagate_error (error, data.error);
+	} else if (data.status == SOUP_STATUS_NOT_MODIFIED && cached_feed != NULL) {
+		/* The cached response is still current, so build the feed from that */
+		g_debug ("Building feed from cache file '%s'.", cache_path);
+
+		if (strcmp (cached_feed->content_type, "application/json") == 0) {
+			feed = _gdata_feed_new_from_json (klass->feed_type, cached_feed->body, cached_feed->body_length, entry_type,
+			                                  progress_callback, progress_user_data, is_async, retain_entries, error);
+		} else {
+			feed = _gdata_feed_new_from_xml (klass->feed_type, cached_feed->body, cached_feed->body_length, entry_type,
+			                                 progress_callback, progress_user_data, is_async, retain_entries, error);
+		}
+	} else if (data.status == SOUP_STATUS_NOT_MODIFIED && page_etag != NULL &&
+	           _gdata_query_get_page_feed (query, _gdata_query_peek_query_uri (query, feed_uri)) != NULL) {
+		/* The page hasn't changed since the query last fetched it, and the query kept the feed it got then */
+		feed = g_object_ref (_gdata_query_get_page_feed (query, _gdata_query_peek_query_uri (query, feed_uri)));
+	} else if (check_query_response_status (self, data.message, data.status, error) == TRUE) {
+		/* Definitely JSON. */
+		g_assert (data.message->response_body->data != NULL);
+		g_debug ("JSON content type detected.");
+		feed = _gdata_feed_new_from_json (klass->feed_type, data.message->response_body->data, data.message->response_body->length,
+		                                  entry_type, progress_callback, progress_user_data, is_async, retain_entries, error);
+
+		if (feed != NULL && cache_path != NULL)
+			feed_cache_store (cache_path, data.message, data.message->response_body->data, data.message->response_body->length);
+	}
+
+	emit_request_completed (self, data.message, GDATA_OPERATION_QUERY, domain);
+
+	/* A conditional query tells us whether the feed has changed, which poll schedulers want to know */
+	if ((cached_feed != NULL || page_etag != NULL || (query != NULL && gdata_query_get_etag (query) != NULL)) && data.error == NULL &&
+	    (data.status == SOUP_STATUS_OK || data.status == SOUP_STATUS_NOT_MODIFIED)) {
+		record_poll (self, feed_uri, query, (data.status == SOUP_STATUS_OK) ? TRUE : FALSE);
+	}
+
+	g_cond_clear (&(data.cond));
+	g_mutex_clear (&(data.mutex));
+	gdata_buffer_free (data.buffer);
+	g_object_unref (data.message);
+
+	if (cached_feed != NULL)
+		cached_feed_free (cached_feed);
+	g_free (cache_path);
+
+	if (feed == NULL)
+		return NULL;
+
+	/* The entries in a partial response only contain the fields which were asked for */
+	if (query != NULL && gdata_query_get_fields (query) != NULL) {
+		gchar *entry_fields = _gdata_query_get_entry_fields (query);
+		mark_partial_entries (gdata_feed_get_entries (feed), entry_fields);
+		g_free (entry_fields);
+	}
+
+	return feed;
+}
+
+typedef struct {
+	gchar *key;
+	guint ref_count; /* one for the query which is making the request, plus one for each query waiting for its response */
+	gboolean is_finished;
+	GDataFeed *feed; /* only valid once is_finished is TRUE */
+	GError *error; /* only valid once is_finished is TRUE */
+} InFlightQuery;
+
+/* Must be called with in_flight_queries_mutex held */
+static void
+in_flight_query_unref (InFlightQuery *in_flight)
+{
+	if (--in_flight->ref_count > 0)
+		return;
+
+	g_free (in_flight->key);
+	if (in_flight->feed != NULL)
+		g_object_unref (in_flight->feed);
+	g_clear_error (&(in_flight->error));
+	g_slice_free (InFlightQuery, in_flight);
+}
+
+/* Returns a key identifying everything which affects the result of the query, or %NULL if it can't be shared with identical queries (or the
+ * service doesn't share queries at all) */
+static gchar *
+get_in_flight_query_key (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                         GDataQueryProgressCallback progress_callback)
+{
+	/* Progress callbacks are per-caller, and queries with an ETag (or their own page ETags) have their own conditional semantics */
+	if (gdata_service_get_share_queries (self) == FALSE || progress_callback != NULL ||
+	    (query != NULL && (gdata_query_get_etag (query) != NULL || gdata_query_get_page_cache_mode (query) != GDATA_PAGE_CACHE_NONE))) {
+		return NULL;
+	}
+
+	/* The whole parse mode is included, since it decides whether subtrees are parsed lazily as well as what's kept of unhandled XML */
+	return g_strdup_printf ("%p %s %u %s", (gpointer) domain, g_type_name (entry_type),
+	                        (query != NULL) ? (guint) _gdata_query_get_parse_mode (query) : (guint) GDATA_UNHANDLED_XML_KEEP,
+	                        (query != NULL) ? _gdata_query_peek_query_uri (query, feed_uri) : feed_uri);
+}
+
+static void
+in_flight_query_cancelled_cb (GCancellable *cancellable, GDataService *self)
+{
+	/* Wake up the waiters so they can check their cancellables */
+	g_mutex_lock (&(self->priv->in_flight_queries_mutex));
+	g_cond_broadcast (&(self->priv->in_flight_queries_cond));
+	g_mutex_unlock (&(self->priv->in_flight_queries_mutex));
+}
+
+/* Waits for @in_flight to finish, and returns its feed (or error). @in_flight must have been referenced for the caller. */
+static GDataFeed *
+wait_for_in_flight_query (GDataService *self, InFlightQuery *in_flight, GCancellable *cancellable, GError **error)
+{
+	GDataServicePrivate *priv = self->priv;
+	GDataFeed *feed = NULL;
+	gulong cancelled_signal = 0;
+
+	/* This can't be connected with the mutex held, as the handler is called immediately if the cancellable's already cancelled */
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) in_flight_query_cancelled_cb, self, NULL);
+
+	g_mutex_lock (&(priv->in_flight_queries_mutex));
+
+	while (in_flight->is_finished == FALSE && g_cancellable_is_cancelled (cancellable) == FALSE)
+		g_cond_wait (&(priv->in_flight_queries_cond), &(priv->in_flight_queries_mutex));
+
+	if (in_flight->is_finished == FALSE) {
+		/* This caller was cancelled; the request carries on for the others */
+		set_cancelled_error (error);
+	} else if (in_flight->feed != NULL) {
+		feed = g_object_ref (in_flight->feed);
+	} else if (in_flight->error != NULL) {
+		g_propagate_error (error, g_error_copy (in_flight->error));
+	}
+
+	in_flight_query_unref (in_flight);
+
+	g_mutex_unlock (&(priv->in_flight_queries_mutex));
+
+	/* This can't be disconnected with the mutex held, as it waits for the handler to finish if it's running */
+	if (cancellable != NULL)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	return feed;
+}
+
+/* Does the bulk of the work of gdata_service_query(). If #GDataService:share-queries is set and an identical query is already in progress (in
+ * another thread), this shares its response rather than making another request, and returns another reference to the same feed. The pagination URIs and ETag of each caller's @query are
+ * updated from the feed as normal. */
+static GDataFeed *
+__gdata_service_query (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                       GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error,
+                       gboolean is_async)
+{
+	GDataServicePrivate *priv = self->priv;
+	GDataFeed *feed;
+	gchar *key, *page_uri = NULL;
+
+	/* Note which page is being fetched, before the query's pagination is updated, if the query remembers its pages */
+	if (query != NULL && gdata_query_get_page_cache_mode (query) != GDATA_PAGE_CACHE_NONE)
+		page_uri = g_strdup (_gdata_query_peek_query_uri (query, feed_uri));
+
+	key = get_in_flight_query_key (self, domain, feed_uri, query, entry_type, progress_callback);
+
+	if (key == NULL) {
+		GError *child_error = NULL;
+
+		feed = fetch_query_feed (self, domain, feed_uri, query, entry_type, cancellable, progress_callback, progress_user_data, NULL, NULL,
+		                         &child_error, is_async);
+
+		if (child_error != NULL) {
+			g_propagate_error (error, child_error);
+		} else if (feed == NULL && page_uri != NULL) {
+			/* The page hasn't changed since the query last fetched it, so carry on paginating from where it left off then */
+			_gdata_query_restore_page (query, page_uri);
+		}
+	} else {
+		while (TRUE) {
+			InFlightQuery *in_flight;
+			GError *child_error = NULL;
+
+			g_mutex_lock (&(priv->in_flight_queries_mutex));
+
+			in_flight = g_hash_table_lookup (priv->in_flight_queries, key);
+
+			if (in_flight != NULL) {
+				/* Wait for the identical query to finish and share its feed. If it was cancelled by its own caller (but this one
+				 * hasn't been), try again: either another query will have started in the meantime, or this one will make the
+				 * request itself. */
+				in_flight->ref_count++;
+				g_mutex_unlock (&(priv->in_flight_queries_mutex));
+
+				feed = wait_for_in_flight_query (self, in_flight, cancellable, &child_error);
+
+				if (feed == NULL && g_error_matches (child_error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == TRUE &&
+				    g_cancellable_is_cancelled (cancellable) == FALSE) {
+					g_clear_error (&child_error);
+					continue;
+				}
+
+				if (child_error != NULL)
+					g_propagate_error (error, child_error);
+
+				break;
+			}
+
+			/* Otherwise, this query makes the request for everyone */
+			in_flight = g_slice_new0 (InFlightQuery);
+			in_flight->key = g_strdup (key);
+			in_flight->ref_count = 1;
+			g_hash_table_insert (priv->in_flight_queries, in_flight->key, in_flight);
+
+			g_mutex_unlock (&(priv->in_flight_queries_mutex));
+
+			feed = fetch_query_feed (self, domain, feed_uri, query, entry_type, cancellable, NULL, NULL, NULL, NULL, &child_error,
+			                         is_async);
+
+			g_mutex_lock (&(priv->in_flight_queries_mutex));
+
+			g_hash_table_remove (priv->in_flight_queries, in_flight->key);
+			in_flight->is_finished = TRUE;
+			in_flight->feed = (feed != NULL) ? g_object_ref (feed) : NULL;
+			in_flight->error = (child_error != NULL) ? g_error_copy (child_error) : NULL;
+			in_flight_query_unref (in_flight);
+
+			g_cond_broadcast (&(priv->in_flight_queries_cond));
+			g_mutex_unlock (&(priv->in_flight_queries_mutex));
+
+			if (child_error != NULL)
+				g_propagate_error (error, child_error);
+
+			break;
+		}
+
+		g_free (key);
+	}
+
+	if (feed == NULL) {
+		g_free (page_uri);
+		return NULL;
+	}
+
+	/* Update the query with the feed's ETag; or, if it remembers its pages, remember this one */
+	if (page_uri != NULL) {
+		_gdata_query_store_page (query, page_uri, feed);
+		g_free (page_uri);
+	} else if (query != NULL && feed != NULL && gdata_feed_get_etag (feed) != NULL) {
+		gdata_query_set_etag (query, gdata_feed_get_etag (feed));
+	}
+
+	/* Update the query with the next and previous URIs from the feed */
+	if (query != NULL && feed != NULL) {
+		GDataLink *_link;
+
+		_link = gdata_feed_look_up_link (feed, "next");
+		if (_link != NULL)
+			_gdata_query_set_next_uri (query, gdata_link_get_uri (_link));
+		_link = gdata_feed_look_up_link (feed, "previous");
+		if (_link != NULL)
+			_gdata_query_set_previous_uri (query, gdata_link_get_uri (_link));
+
+		/* Always replace the page token, since the last page doesn't have one */
+		_gdata_query_set_next_page_token (query, _gdata_feed_get_next_page_token (feed));
+	}
+
+	return feed;
+}
+
+/**
+ * gdata_service_query:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @feed_uri: the feed URI to query, including the host name and protocol
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @progress_callback: (allow-none) (scope call) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
+ * @progress_user_data: (closure): data to pass to the @progress_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Queries the service's @feed_uri feed to build a #GDataFeed.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled before or during network activity, the error %G_IO_ERROR_CANCELLED will be returned. Cancellation has no effect
+ * after network activity has finished, however, and the query will return successfully (or return an error sent by the server) if it is first
+ * cancelled after network activity has finished. See the <link linkend="cancellable-support">overview of cancellation</link> for
+ * more details.
+ *
+ * A %GDATA_SERVICE_ERROR_PROTOCOL_ERROR will be returned if the server indicates there is a problem with the query, but subclasses may override
+ * this and return their own errors. See their documentation for more details.
+ *
+ * For each entry in the response feed, @progress_callback will be called in the main thread. If there was an error parsing the XML response,
+ * a #GDataParserError will be returned.
+ *
+ * If the query is successful and the feed supports pagination, @query will be updated with the pagination URIs, and the next or previous page
+ * can then be loaded by calling gdata_query_next_page() or gdata_query_previous_page() before running the query again.
+ *
+ * If the #GDataQuery's ETag is set and it finds a match on the server, %NULL will be returned, but @error will remain unset. Otherwise,
+ * @query's ETag will be updated with the ETag from the returned feed, if available. If #GDataQuery:page-cache-mode is set, the ETag of each page
+ * is remembered separately instead; see its documentation for details.
+ *
+ * If #GDataService:share-queries is set and an identical query is already in progress on the same service in another thread, no new request is
+ * made: the query waits for that one to finish and returns another reference to the same #GDataFeed (or the same error). Callers sharing a feed
+ * in this way mustn't modify it. See the property's documentation for details.
+ *
+ * Return value: (transfer full): a #GDataFeed of query results, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.9.0
+ **/
+GDataFeed *
+gdata_service_query (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                     GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return __gdata_service_query (self, domain, feed_uri, query, entry_type, cancellable, progress_callback, progress_user_data, error, FALSE);
+}
+
+typedef struct {
+	GDataQueryProgressCallback progress_callback;
+	gpointer progress_user_data;
+	GDataEntry *entry;
+	guint entry_key;
+	guint entry_count;
+} QueryAllProgressData;
+
+static gboolean
+query_all_progress_idle (QueryAllProgressData *data)
+{
+	data->progress_callback (data->entry, data->entry_key, data->entry_count, data->progress_user_data);
+
+	g_object_unref (data->entry);
+	g_slice_free (QueryAllProgressData, data);
+
+	return FALSE;
+}
+
+typedef struct {
+	gchar *uri;
+	GDataFeed *feed;
+	GError *error;
+	gboolean finished;
+	gboolean has_next_page; /* TRUE once the page after this one has been queued, when following next links */
+} QueryAllPage;
+
+typedef struct {
+	GDataService *service;
+	GDataAuthorizationDomain *domain;
+	GType entry_type;
+	GCancellable *cancellable; /* cancelled if any page fails, or if the caller's cancellable is cancelled */
+	GMutex mutex; /* protects the finished, feed and error members of all pages, and n_parsing */
+	GCond cond;
+	guint n_parsing; /* number of pages queued on the parse pool which haven't finished yet */
+
+	/* Only used when following next links; see query_all_follow_next_links() */
+	GThreadPool *next_page_pool;
+	GPtrArray/*<owned QueryAllPage*>*/ *next_pages; /* in order; protected by mutex */
+} QueryAllData;
+
+/* A downloaded page waiting to be parsed */
+typedef struct {
+	QueryAllPage *page;
+	QueryAllData *data;
+	SoupMessage *message; /* the response to parse, or %NULL to parse cached_feed */
+	CachedFeed *cached_feed;
+	gchar *cache_path; /* where to cache the response once it's been parsed, or %NULL */
+} QueryAllParseJob;
+
+static void
+query_all_finish_page (QueryAllData *data, QueryAllPage *page, GDataFeed *feed, GError *error)
+{
+	/* Bail out of the other pages if this one failed; there's no way to return a partial result set */
+	if (feed == NULL)
+		g_cancellable_cancel (data->cancellable);
+
+	g_mutex_lock (&(data->mutex));
+	page->feed = feed;
+	page->error = error;
+	page->finished = TRUE;
+	g_cond_broadcast (&(data->cond));
+	g_mutex_unlock (&(data->mutex));
+}
+
+static void
+query_all_parse_job_free (QueryAllParseJob *job)
+{
+	if (job->message != NULL)
+		g_object_unref (job->message);
+	if (job->cached_feed != NULL)
+		cached_feed_free (job->cached_feed);
+	g_free (job->cache_path);
+	g_slice_free (QueryAllParseJob, job);
+}
+
+static void
+query_all_parse_job_run (QueryAllParseJob *job, gpointer user_data)
+{
+	QueryAllData *data = job->data;
+	GDataFeed *feed = NULL;
+	GError *error = NULL;
+	GType feed_type = GDATA_SERVICE_GET_CLASS (data->service)->feed_type;
+
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &error) == TRUE) {
+		/* Another page has failed, so there's no point parsing this one */
+	} else if (job->message == NULL) {
+		g_debug ("Building feed from cache file '%s'.", job->cache_path);
+
+		if (strcmp (job->cached_feed->content_type, "application/json") == 0) {
+			feed = _gdata_feed_new_from_json (feed_type, job->cached_feed->body, job->cached_feed->body_length, data->entry_type,
+			                                  NULL, NULL, FALSE, TRUE, &error);
+		} else {
+			feed = _gdata_feed_new_from_xml (feed_type, job->cached_feed->body, job->cached_feed->body_length, data->entry_type,
+			                                 NULL, NULL, FALSE, TRUE, &error);
+		}
+	} else {
+		SoupMessageBody *body = job->message->response_body;
+
+		if (is_json_response (job->message) == TRUE)
+			feed = _gdata_feed_new_from_json (feed_type, body->data, body->length, data->entry_type, NULL, NULL, FALSE, TRUE, &error);
+		else
+			feed = _gdata_feed_new_from_xml (feed_type, body->data, body->length, data->entry_type, NULL, NULL, FALSE, TRUE, &error);
+
+		if (feed != NULL && job->cache_path != NULL)
+			feed_cache_store (job->cache_path, job->message, body->data, body->length);
+	}
+
+	query_all_finish_page (data, job->page, feed, error);
+
+	g_mutex_lock (&(data->mutex));
+	data->n_parsing--;
+	g_cond_broadcast (&(data->cond));
+	g_mutex_unlock (&(data->mutex));
+
+	query_all_parse_job_free (job);
+}
+
+/* Returns a pool of threads, one per processor and shared by all services, for parsing responses which have been completely downloaded. Parsing
+ * a page of a query is CPU-bound, so this lets the thread which requested it get on with requesting the next page in the meantime. */
+static GThreadPool *
+get_parse_pool (void)
+{
+	static gsize parse_pool = 0;
+
+	if (g_once_init_enter (&parse_pool) == TRUE) {
+		GThreadPool *pool = g_thread_pool_new ((GFunc) query_all_parse_job_run, NULL, MAX (g_get_num_processors (), 1), FALSE, NULL);
+		g_once_init_leave (&parse_pool, (gsize) pool);
+	}
+
+	return (GThreadPool*) parse_pool;
+}
+
+/* Requests a page, and queues the response to be parsed on the parse pool. The page is passed as a URI rather than a GDataQuery so that the
+ * caller's query isn't modified by several threads at once. */
+static void
+query_all_page_thread (QueryAllPage *page, QueryAllData *data)
+{
+	GDataService *self = data->service;
+	QueryAllParseJob *job;
+	SoupMessage *message;
+	CachedFeed *cached_feed = NULL;
+	gchar *cache_path;
+	guint status;
+	GError *error = NULL;
+
+	/* Look up the page in the feed cache, as in fetch_query_feed() */
+	cache_path = feed_cache_get_path (self, page->uri);
+	if (cache_path != NULL)
+		cached_feed = feed_cache_load (cache_path);
+
+	message = build_conditional_query_message (self, data->domain, page->uri, NULL, (cached_feed != NULL) ? cached_feed->etag : NULL);
+	status = _gdata_service_send_message (self, message, data->cancellable, &error);
+
+	emit_request_completed (self, message, GDATA_OPERATION_QUERY, data->domain);
+
+	job = g_slice_new0 (QueryAllParseJob);
+	job->page = page;
+	job->data = data;
+	job->cache_path = cache_path;
+
+	if (error == NULL && status == SOUP_STATUS_NOT_MODIFIED && cached_feed != NULL) {
+		/* The cached response is still current */
+		job->cached_feed = cached_feed;
+		g_object_unref (message);
+	} else if (error == NULL && check_query_response_status (self, message, status, &error) == TRUE) {
+		job->message = message;
+		if (cached_feed != NULL)
+			cached_feed_free (cached_feed);
+	} else {
+		query_all_finish_page (data, page, NULL, error);
+
+		job->message = message;
+		job->cached_feed = cached_feed;
+		query_all_parse_job_free (job);
+
+		return;
+	}
+
+	g_mutex_lock (&(data->mutex));
+	data->n_parsing++;
+	g_mutex_unlock (&(data->mutex));
+
+	g_thread_pool_push (get_parse_pool (), job, NULL);
+}
+
+static void
+query_all_cancelled_cb (GCancellable *cancellable, GCancellable *internal_cancellable)
+{
+	g_cancellable_cancel (internal_cancellable);
+}
+
+static void
+query_all_deliver_entries (GDataFeed *feed, GList *entries, guint first_entry_key, guint entry_count, GDataQueryProgressCallback progress_callback,
+                           gpointer progress_user_data, gboolean is_async)
+{
+	GList *i;
+	guint entry_key = first_entry_key;
+
+	for (i = entries; i != NULL; i = i->next, entry_key++) {
+		GDataEntry *entry = GDATA_ENTRY (i->data);
+
+		/* Pages after the first are appended to the first page's feed */
+		if (feed != NULL)
+			_gdata_feed_add_entry (feed, entry);
+
+		if (progress_callback == NULL) {
+			continue;
+		} else if (is_async == TRUE) {
+			QueryAllProgressData *progress_data;
+
+			progress_data = g_slice_new (QueryAllProgressData);
+			progress_data->progress_callback = progress_callback;
+			progress_data->progress_user_data = progress_user_data;
+			progress_data->entry = g_object_ref (entry);
+			progress_data->entry_key = entry_key;
+			progress_data->entry_count = entry_count;
+
+			/* Use the same priority as the progress callbacks in __gdata_service_query(), so that they're delivered in order and before the
+			 * GAsyncResult completes */
+			_gdata_service_progress_idle_add (_gdata_service_get_callback_service (), _gdata_service_get_callback_context (),
+			                                  (GSourceFunc) query_all_progress_idle, progress_data, NULL);
+		} else {
+			progress_callback (entry, entry_key, entry_count, progress_user_data);
+		}
+	}
+}
+
+/* The relation type of a feed's link to its next page; see gdata_link_set_relation_type() */
+#define NEXT_PAGE_RELATION "http://www.iana.org/assignments/relation/next"
+
+static void
+query_all_page_free (QueryAllPage *page)
+{
+	g_free (page->uri);
+	if (page->feed != NULL)
+		g_object_unref (page->feed);
+	if (page->error != NULL)
+		g_error_free (page->error);
+	g_slice_free (QueryAllPage, page);
+}
+
+/* Queues the page after @page, at @next_uri, on the next page pool. This is a no-op if it's already been queued. */
+static void
+query_all_queue_next_page (QueryAllData *data, QueryAllPage *page, const gchar *next_uri)
+{
+	QueryAllPage *next_page;
+
+	g_mutex_lock (&(data->mutex));
+
+	if (page->has_next_page == TRUE || g_cancellable_is_cancelled (data->cancellable) == TRUE) {
+		g_mutex_unlock (&(data->mutex));
+		return;
+	}
+
+	next_page = g_slice_new0 (QueryAllPage);
+	next_page->uri = g_strdup (next_uri);
+
+	page->has_next_page = TRUE;
+	g_ptr_array_add (data->next_pages, next_page);
+
+	g_mutex_unlock (&(data->mutex));
+
+	g_thread_pool_push (data->next_page_pool, next_page, NULL);
+}
+
+typedef struct {
+	QueryAllData *data;
+	QueryAllPage *page;
+	gchar *next_uri; /* the page's next link, if it was parsed before any of the page's entries */
+	gboolean has_entries;
+} QueryAllNextLinkData;
+
+static void
+query_all_next_link_cb (const gchar *uri, QueryAllNextLinkData *link_data)
+{
+	/* Start requesting the next page while the rest of this one is still being downloaded and parsed. Since an empty page ends the results,
+	 * this has to wait until the page is known to have at least one entry. */
+	if (link_data->has_entries == TRUE)
+		query_all_queue_next_page (link_data->data, link_data->page, uri);
+	else if (link_data->next_uri == NULL)
+		link_data->next_uri = g_strdup (uri);
+}
+
+static void
+query_all_next_page_progress_cb (GDataEntry *entry, guint entry_key, guint entry_count, QueryAllNextLinkData *link_data)
+{
+	if (link_data->has_entries == TRUE)
+		return;
+
+	link_data->has_entries = TRUE;
+
+	if (link_data->next_uri != NULL)
+		query_all_queue_next_page (link_data->data, link_data->page, link_data->next_uri);
+}
+
+/* Requests and parses a page found by following a next link. Unlike query_all_page_thread(), the response is streamed and parsed in this thread, so
+ * that the next page can be queued as soon as its link and the page's first entry have been parsed. */
+static void
+query_all_next_page_thread (QueryAllPage *page, QueryAllData *data)
+{
+	QueryAllNextLinkData link_data;
+	GDataFeed *feed = NULL;
+	GError *error = NULL;
+
+	link_data.data = data;
+	link_data.page = page;
+	link_data.next_uri = NULL;
+	link_data.has_entries = FALSE;
+
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &error) == FALSE) {
+		feed = fetch_query_feed (data->service, data->domain, page->uri, NULL, data->entry_type, data->cancellable,
+		                         (GDataQueryProgressCallback) query_all_next_page_progress_cb, &link_data,
+		                         (GDataFeedNextLinkCallback) query_all_next_link_cb, &link_data, &error, FALSE);
+	}
+
+	g_free (link_data.next_uri);
+
+	/* If the next link wasn't spotted while parsing (for example, because the response was JSON or was built from the cache), queue the next
+	 * page now. An empty page is taken as the end of the results, even if it has a next link, so that a misbehaving server can't loop forever. */
+	if (feed != NULL && gdata_feed_get_entries (feed) != NULL) {
+		GDataLink *_link = gdata_feed_look_up_link (feed, NEXT_PAGE_RELATION);
+
+		if (_link != NULL)
+			query_all_queue_next_page (data, page, gdata_link_get_uri (_link));
+	}
+
+	query_all_finish_page (data, page, feed, error);
+}
+
+/* Fetches the rest of the pages of a feed which doesn't report its size, by following the next links from @first_feed (which has @first_next_uri as
+ * its next link, and has already had its @n_entries entries delivered). The pages have to be requested one after another, but each page is
+ * requested as soon as the previous page's next link and first entry have been parsed, rather than once the whole previous page has been
+ * downloaded and parsed, so with more than one page thread, the request for each page overlaps with the download and parsing of the previous one.
+ * Entries are delivered and added to @first_feed in order. */
+static gboolean
+query_all_follow_next_links (GDataService *self, GDataAuthorizationDomain *domain, GDataQuery *query, GType entry_type, GDataFeed *first_feed,
+                             const gchar *first_next_uri, guint n_entries, guint max_concurrent_pages, GCancellable *cancellable,
+                             GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error, gboolean is_async)
+{
+	QueryAllData data;
+	QueryAllPage first_page = { NULL, };
+	gulong cancelled_signal = 0;
+	GError *child_error = NULL;
+	gchar *entry_fields;
+	guint i;
+
+	/* The pages are queried without a GDataQuery, so have to be marked as partial here */
+	entry_fields = (query != NULL) ? _gdata_query_get_entry_fields (query) : NULL;
+
+	data.service = self;
+	data.domain = domain;
+	data.entry_type = entry_type;
+	data.cancellable = g_cancellable_new ();
+	g_mutex_init (&(data.mutex));
+	g_cond_init (&(data.cond));
+	data.n_parsing = 0;
+	data.next_pages = g_ptr_array_new_with_free_func ((GDestroyNotify) query_all_page_free);
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) query_all_cancelled_cb, data.cancellable, NULL);
+
+	/* With a single thread, each page is only requested once the previous one has been completely parsed */
+	data.next_page_pool = g_thread_pool_new ((GFunc) query_all_next_page_thread, &data, max_concurrent_pages, FALSE, NULL);
+	query_all_queue_next_page (&data, &first_page, first_next_uri);
+
+	for (i = 0; ; i++) {
+		QueryAllPage *page;
+		GList *entries;
+		gboolean has_next_page;
+
+		g_mutex_lock (&(data.mutex));
+		page = (i < data.next_pages->len) ? g_ptr_array_index (data.next_pages, i) : NULL;
+		while (page != NULL && page->finished == FALSE)
+			g_cond_wait (&(data.cond), &(data.mutex));
+		has_next_page = (page != NULL && page->has_next_page == TRUE);
+		g_mutex_unlock (&(data.mutex));
+
+		if (page == NULL) {
+			/* The caller's cancellable was cancelled before the first page could be queued */
+			g_cancellable_set_error_if_cancelled (data.cancellable, &child_error);
+			break;
+		} else if (page->feed == NULL) {
+			child_error = page->error;
+			page->error = NULL;
+
+			if (child_error == NULL)
+				set_cancelled_error (&child_error);
+
+			break;
+		}
+
+		entries = gdata_feed_get_entries (page->feed);
+		mark_partial_entries (entries, entry_fields);
+		query_all_deliver_entries (first_feed, entries, n_entries, n_entries + g_list_length (entries), progress_callback,
+		                           progress_user_data, is_async);
+		n_entries += g_list_length (entries);
+
+		if (has_next_page == FALSE)
+			break;
+	}
+
+	/* Stop any pages which are still being fetched after an error, and wait for them to finish */
+	if (child_error != NULL)
+		g_cancellable_cancel (data.cancellable);
+
+	g_thread_pool_free (data.next_page_pool, TRUE, TRUE);
+
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	g_ptr_array_unref (data.next_pages);
+	g_object_unref (data.cancellable);
+	g_mutex_clear (&(data.mutex));
+	g_cond_clear (&(data.cond));
+	g_free (entry_fields);
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static GDataFeed *
+__gdata_service_query_all (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                           guint max_concurrent_pages, GCancellable *cancellable, GDataQueryProgressCallback progress_callback,
+                           gpointer progress_user_data, GError **error, gboolean is_async)
+{
+	GDataFeed *feed;
+	GDataQuery *page_query;
+	QueryAllData data;
+	QueryAllPage *pages;
+	GThreadPool *pool;
+	GList *entries;
+	guint first_start_index, items_per_page, total_results, n_entries, n_delivered, n_pages, i;
+	gulong cancelled_signal = 0;
+	GError *child_error = NULL;
+	gchar *entry_fields;
+
+	/* Fetch the first page serially, since we need its openSearch metadata to work out the rest of the page windows. Its entries are delivered
+	 * below so that the entry keys are consistent across all the pages. */
+	feed = __gdata_service_query (self, domain, feed_uri, query, entry_type, cancellable, NULL, NULL, error, FALSE);
+	if (feed == NULL)
+		return NULL;
+
+	entries = gdata_feed_get_entries (feed);
+	n_entries = g_list_length (entries);
+	total_results = gdata_feed_get_total_results (feed);
+	items_per_page = gdata_feed_get_items_per_page (feed);
+	first_start_index = MAX (gdata_feed_get_start_index (feed), 1);
+
+	if (items_per_page == 0)
+		items_per_page = n_entries;
+
+	/* Entry keys count the entries actually delivered, starting from zero, rather than being derived from the pages' start indices, since
+	 * pages may be shorter than the server claimed */
+	query_all_deliver_entries (NULL, entries, 0, MAX (total_results, n_entries), progress_callback, progress_user_data, is_async);
+	n_delivered = n_entries;
+
+	/* If the feed doesn't report its size, the only way to find the rest of the pages is to follow its next links */
+	if (total_results == 0) {
+		GDataLink *next_link = gdata_feed_look_up_link (feed, NEXT_PAGE_RELATION);
+
+		if (next_link != NULL && n_entries > 0 &&
+		    query_all_follow_next_links (self, domain, query, entry_type, feed, gdata_link_get_uri (next_link), n_entries,
+		                                 max_concurrent_pages, cancellable, progress_callback, progress_user_data, error, is_async) == FALSE) {
+			g_object_unref (feed);
+			return NULL;
+		}
+
+		return feed;
+	}
+
+	/* Work out how many more pages there are */
+	if (items_per_page == 0 || first_start_index - 1 + n_entries >= total_results)
+		return feed;
+
+	n_pages = (total_results - (first_start_index - 1) - n_entries + items_per_page - 1) / items_per_page;
+
+	/* Build the URIs of the remaining pages up front. This is done using a copy of the query, since building them temporarily changes its
+	 * properties, and it may be in use by the caller in another thread. */
+	page_query = (query != NULL) ? _gdata_query_copy (query) : gdata_query_new (NULL);
+	pages = g_new0 (QueryAllPage, n_pages);
+
+	for (i = 0; i < n_pages; i++)
+		pages[i].uri = _gdata_query_build_page_uri (page_query, feed_uri, first_start_index + n_entries + i * items_per_page, items_per_page);
+
+	/* The remaining pages are queried without a GDataQuery, so have to be marked as partial here */
+	entry_fields = _gdata_query_get_entry_fields (page_query);
+
+	g_object_unref (page_query);
+
+	data.service = self;
+	data.domain = domain;
+	data.entry_type = entry_type;
+	data.cancellable = g_cancellable_new ();
+	g_mutex_init (&(data.mutex));
+	g_cond_init (&(data.cond));
+	data.n_parsing = 0;
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) query_all_cancelled_cb, data.cancellable, NULL);
+
+	/* Fetch the pages in parallel, bounded by the size of the thread pool */
+	pool = g_thread_pool_new ((GFunc) query_all_page_thread, &data, max_concurrent_pages, FALSE, NULL);
+	for (i = 0; i < n_pages; i++)
+		g_thread_pool_push (pool, &(pages[i]), NULL);
+
+	/* Collect the pages in order as they arrive, so that entries are delivered in the same order as if the pages had been fetched serially */
+	for (i = 0; i < n_pages; i++) {
+		QueryAllPage *page = &(pages[i]);
+		guint n_page_entries;
+
+		g_mutex_lock (&(data.mutex));
+		while (page->finished == FALSE)
+			g_cond_wait (&(data.cond), &(data.mutex));
+		g_mutex_unlock (&(data.mutex));
+
+		if (page->feed == NULL) {
+			/* Prefer reporting the error which caused the other pages to be cancelled. A page which returned NULL with no error was
+			 * "not modified", which can only happen if the server's being silly; stop there. */
+			guint j;
+
+			for (j = i; j < n_pages && child_error == NULL; j++) {
+				g_mutex_lock (&(data.mutex));
+				if (pages[j].finished == TRUE && pages[j].error != NULL &&
+				    g_error_matches (pages[j].error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == FALSE) {
+					child_error = pages[j].error;
+					pages[j].error = NULL;
+				}
+				g_mutex_unlock (&(data.mutex));
+			}
+
+			if (child_error == NULL && page->error != NULL) {
+				child_error = page->error;
+				page->error = NULL;
+			}
+
+			g_cancellable_cancel (data.cancellable);
+			break;
+		}
+
+		entries = gdata_feed_get_entries (page->feed);
+		n_page_entries = g_list_length (entries);
+
+		mark_partial_entries (entries, entry_fields);
+		query_all_deliver_entries (feed, entries, n_delivered, MAX (total_results, n_delivered + n_page_entries), progress_callback,
+		                           progress_user_data, is_async);
+		n_delivered += n_page_entries;
+	}
+
+	g_free (entry_fields);
+
+	/* Drop any pages which haven't started yet, and wait for the rest to finish, including parsing */
+	g_thread_pool_free (pool, TRUE, TRUE);
+
+	g_mutex_lock (&(data.mutex));
+	while (data.n_parsing > 0)
+		g_cond_wait (&(data.cond), &(data.mutex));
+	g_mutex_unlock (&(data.mutex));
+
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	for (i = 0; i < n_pages; i++) {
+		g_free (pages[i].uri);
+		if (pages[i].feed != NULL)
+			g_object_unref (pages[i].feed);
+		if (pages[i].error != NULL)
+			g_error_free (pages[i].error);
+	}
+	g_free (pages);
+
+	g_object_unref (data.cancellable);
+	g_mutex_clear (&(data.mutex));
+	g_cond_clear (&(data.cond));
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		g_object_unref (feed);
+		return NULL;
+	}
+
+	return feed;
+}
+
+/**
+ * gdata_service_query_all:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @feed_uri: the feed URI to query, including the host name and protocol
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @max_concurrent_pages: the maximum number of pages to request at once; must be greater than <code class="literal">0</code>
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @progress_callback: (allow-none) (scope call) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
+ * @progress_user_data: (closure): data to pass to the @progress_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Queries the service's @feed_uri feed and fetches every page of the results, returning a single #GDataFeed containing all the entries.
+ *
+ * The first page is requested as by gdata_service_query(). If its feed reports #GDataFeed:total-results, the remaining pages are then requested
+ * using #GDataQuery:start-index and #GDataQuery:max-results, with up to @max_concurrent_pages requests in flight at once. The entries are
+ * passed to @progress_callback (with keys counting from <code class="literal">0</code> across the whole result set, and the total number of
+ * results as the count) and added to the returned feed in result order, regardless of the order in which the pages arrive.
+ *
+ * If the feed doesn't report its size, the remaining pages are found by following each page's <literal>next</literal> link instead. These pages
+ * can only be requested one after another, but if @max_concurrent_pages is greater than <code class="literal">1</code>, each page is requested
+ * as soon as the previous page's <literal>next</literal> link has been parsed, while the rest of that page is still arriving and being parsed. The
+ * count passed to @progress_callback is then the number of entries delivered so far. An empty page is taken to be the last one.
+ *
+ * Other than the #GDataFeed:entries, the properties of the returned feed are those of the first page. @query is updated with the ETag and
+ * pagination URIs of the first page, and is not otherwise modified.
+ *
+ * The remaining pages are parsed on a pool of threads shared by all services, with one thread per processor. The @max_concurrent_pages request
+ * threads are therefore free to send the next request as soon as each response has been downloaded, and large result sets are parsed on all
+ * the processors at once.
+ *
+ * If any page fails, the outstanding requests are cancelled and the error from the failed page is returned. Cancellation of @cancellable is
+ * handled as for gdata_service_query().
+ *
+ * Return value: (transfer full): a #GDataFeed of all the query results, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataFeed *
+gdata_service_query_all (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                         guint max_concurrent_pages, GCancellable *cancellable, GDataQueryProgressCallback progress_callback,
+                         gpointer progress_user_data, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+	g_return_val_if_fail (max_concurrent_pages > 0, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return __gdata_service_query_all (self, domain, feed_uri, query, entry_type, max_concurrent_pages, cancellable, progress_callback,
+	                                  progress_user_data, error, FALSE);
+}
+
+static void
+cached_entry_free (CachedEntry *cached)
+{
+	g_free (cached->id);
+	g_object_unref (cached->entry);
+	g_slice_free (CachedEntry, cached);
+}
+
+/* Evicts the least recently used entries until the cache fits within its size. entry_cache_mutex must be held. */
+static void
+entry_cache_trim (GDataServicePrivate *priv)
+{
+	while (priv->entry_cache_lru.length > priv->entry_cache_size) {
+		CachedEntry *cached = g_queue_pop_tail (&(priv->entry_cache_lru));
+
+		g_hash_table_remove (priv->entry_cache, cached->id);
+		priv->entry_cache_bytes -= cached->size;
+		cached_entry_free (cached);
+	}
+}
+
+static gsize
+entry_cache_get_size (gpointer cache, guint *n_items)
+{
+	GDataServicePrivate *priv = GDATA_SERVICE (cache)->priv;
+	gsize n_bytes;
+
+	g_mutex_lock (&(priv->entry_cache_mutex));
+	n_bytes = priv->entry_cache_bytes;
+	if (n_items != NULL)
+		*n_items = priv->entry_cache_lru.length;
+	g_mutex_unlock (&(priv->entry_cache_mutex));
+
+	return n_bytes;
+}
+
+static gint64
+entry_cache_get_oldest_use (gpointer cache)
+{
+	GDataServicePrivate *priv = GDATA_SERVICE (cache)->priv;
+	gint64 last_used = G_MAXINT64;
+
+	g_mutex_lock (&(priv->entry_cache_mutex));
+	if (priv->entry_cache_lru.tail != NULL)
+		last_used = ((CachedEntry*) priv->entry_cache_lru.tail->data)->last_used;
+	g_mutex_unlock (&(priv->entry_cache_mutex));
+
+	return last_used;
+}
+
+static gsize
+entry_cache_evict_oldest (gpointer cache)
+{
+	GDataServicePrivate *priv = GDATA_SERVICE (cache)->priv;
+	CachedEntry *cached;
+	gsize n_bytes = 0;
+
+	g_mutex_lock (&(priv->entry_cache_mutex));
+
+	cached = g_queue_pop_tail (&(priv->entry_cache_lru));
+	if (cached != NULL) {
+		g_hash_table_remove (priv->entry_cache, cached->id);
+		priv->entry_cache_bytes -= cached->size;
+		n_bytes = cached->size;
+		cached_entry_free (cached);
+	}
+
+	g_mutex_unlock (&(priv->entry_cache_mutex));
+
+	return n_bytes;
+}
+
+/* Returns a new reference to the cached entry for @entry_id, or %NULL if there isn't one of @entry_type; and marks it as most recently used */
+static GDataEntry *
+entry_cache_lookup (GDataService *self, const gchar *entry_id, GType entry_type)
+{
+	GDataServicePrivate *priv = self->priv;
+	GDataEntry *entry = NULL;
+	GList *link;
+
+	g_mutex_lock (&(priv->entry_cache_mutex));
+
+	link = g_hash_table_lookup (priv->entry_cache, entry_id);
+	if (link != NULL && G_TYPE_CHECK_INSTANCE_TYPE (((CachedEntry*) link->data)->entry, entry_type) == TRUE) {
+		entry = g_object_ref (((CachedEntry*) link->data)->entry);
+		((CachedEntry*) link->data)->last_used = g_get_monotonic_time ();
+
+		g_queue_unlink (&(priv->entry_cache_lru), link);
+		g_queue_push_head_link (&(priv->entry_cache_lru), link);
+	}
+
+	if (priv->entry_cache_size > 0)
+		_gdata_cache_manager_record_lookup (priv->entry_cache_registration, entry != NULL);
+
+	g_mutex_unlock (&(priv->entry_cache_mutex));
+
+	return entry;
+}
+
+/* Caches @entry as the latest version of @entry_id, if the cache is enabled and @entry has an ETag to validate it with */
+static void
+entry_cache_insert (GDataService *self, const gchar *entry_id, GDataEntry *entry)
+{
+	GDataServicePrivate *priv = self->priv;
+	CachedEntry *cached;
+	GList *link;
+	gsize size;
+
+	if (gdata_entry_get_etag (entry) == NULL)
+		return;
+
+	/* Measure the entry before taking the lock, since it means querying all its properties */
+	size = sizeof (CachedEntry) + strlen (entry_id) + 1 + _gdata_parsable_measure (GDATA_PARSABLE (entry));
+
+	g_mutex_lock (&(priv->entry_cache_mutex));
+
+	if (priv->entry_cache_size == 0) {
+		g_mutex_unlock (&(priv->entry_cache_mutex));
+		return;
+	}
+
+	link = g_hash_table_lookup (priv->entry_cache, entry_id);
+	if (link != NULL) {
+		/* Replace the existing version */
+		cached = link->data;
+		g_object_unref (cached->entry);
+		cached->entry = g_object_ref (entry);
+		priv->entry_cache_bytes = priv->entry_cache_bytes - cached->size + size;
+		cached->size = size;
+		cached->last_used = g_get_monotonic_time ();
+
+		g_queue_unlink (&(priv->entry_cache_lru), link);
+		g_queue_push_head_link (&(priv->entry_cache_lru), link);
+	} else {
+		cached = g_slice_new (CachedEntry);
+		cached->id = g_strdup (entry_id);
+		cached->entry = g_object_ref (entry);
+		cached->size = size;
+		cached->last_used = g_get_monotonic_time ();
+
+		g_queue_push_head (&(priv->entry_cache_lru), cached);
+		g_hash_table_insert (priv->entry_cache, cached->id, priv->entry_cache_lru.head);
+		priv->entry_cache_bytes += size;
+
+		entry_cache_trim (priv);
+	}
+
+	g_mutex_unlock (&(priv->entry_cache_mutex));
+
+	/* Let the cache manager keep all the caches within its budget */
+	_gdata_cache_manager_cache_grown (priv->entry_cache_registration);
+}
+
+static void
+entry_cache_insert_cb (const gchar *entry_id, GDataEntry *entry, GDataService *self)
+{
+	entry_cache_insert (self, entry_id, entry);
+}
+
+static void
+cached_rules_free (CachedRules *cached)
+{
+	g_free (cached->id);
+	g_free (cached->etag);
+	soup_uri_free (cached->acl_uri);
+	g_bytes_unref (cached->response);
+	g_slice_free (CachedRules, cached);
+}
+
+/* Drops the cached rules in @link. acl_cache_mutex must be held. */
+static void
+acl_cache_remove_link (GDataServicePrivate *priv, GList *link)
+{
+	CachedRules *cached = link->data;
+
+	g_hash_table_remove (priv->acl_cache, cached->id);
+	g_queue_delete_link (&(priv->acl_cache_lru), link);
+	priv->acl_cache_bytes -= cached->size;
+	cached_rules_free (cached);
+}
+
+/* Evicts the least recently used access control lists until the cache fits within its size. acl_cache_mutex must be held. */
+static void
+acl_cache_trim (GDataServicePrivate *priv)
+{
+	while (priv->acl_cache_lru.length > priv->acl_cache_size)
+		acl_cache_remove_link (priv, priv->acl_cache_lru.tail);
+}
+
+static gsize
+acl_cache_get_size (gpointer cache, guint *n_items)
+{
+	GDataServicePrivate *priv = GDATA_SERVICE (cache)->priv;
+	gsize n_bytes;
+
+	g_mutex_lock (&(priv->acl_cache_mutex));
+	n_bytes = priv->acl_cache_bytes;
+	if (n_items != NULL)
+		*n_items = priv->acl_cache_lru.length;
+	g_mutex_unlock (&(priv->acl_cache_mutex));
+
+	return n_bytes;
+}
+
+static gint64
+acl_cache_get_oldest_use (gpointer cache)
+{
+	GDataServicePrivate *priv = GDATA_SERVICE (cache)->priv;
+	gint64 last_used = G_MAXINT64;
+
+	g_mutex_lock (&(priv->acl_cache_mutex));
+	if (priv->acl_cache_lru.tail != NULL)
+		last_used = ((CachedRules*) priv->acl_cache_lru.tail->data)->last_used;
+	g_mutex_unlock (&(priv->acl_cache_mutex));
+
+	return last_used;
+}
+
+static gsize
+acl_cache_evict_oldest (gpointer cache)
+{
+	GDataServicePrivate *priv = GDATA_SERVICE (cache)->priv;
+	gsize n_bytes = 0;
+
+	g_mutex_lock (&(priv->acl_cache_mutex));
+
+	if (priv->acl_cache_lru.tail != NULL) {
+		n_bytes = ((CachedRules*) priv->acl_cache_lru.tail->data)->size;
+		acl_cache_remove_link (priv, priv->acl_cache_lru.tail);
+	}
+
+	g_mutex_unlock (&(priv->acl_cache_mutex));
+
+	return n_bytes;
+}
+
+/* Returns a new reference to the cached body of @entry's ACL feed, or %NULL if there isn't one for its current ETag; and marks it as most recently
+ * used. Cached rules for an older version of @entry are dropped. */
+GBytes *
+_gdata_service_acl_cache_lookup (GDataService *self, GDataEntry *entry)
+{
+	GDataServicePrivate *priv = self->priv;
+	const gchar *id, *etag;
+	GBytes *response = NULL;
+	GList *link;
+
+	id = gdata_entry_get_id (entry);
+	etag = gdata_entry_get_etag (entry);
+
+	if (id == NULL || etag == NULL)
+		return NULL;
+
+	g_mutex_lock (&(priv->acl_cache_mutex));
+
+	link = g_hash_table_lookup (priv->acl_cache, id);
+	if (link != NULL && strcmp (((CachedRules*) link->data)->etag, etag) == 0) {
+		response = g_bytes_ref (((CachedRules*) link->data)->response);
+		((CachedRules*) link->data)->last_used = g_get_monotonic_time ();
+
+		g_queue_unlink (&(priv->acl_cache_lru), link);
+		g_queue_push_head_link (&(priv->acl_cache_lru), link);
+	} else if (link != NULL) {
+		acl_cache_remove_link (priv, link);
+	}
+
+	if (priv->acl_cache_size > 0)
+		_gdata_cache_manager_record_lookup (priv->acl_cache_registration, response != NULL);
+
+	g_mutex_unlock (&(priv->acl_cache_mutex));
+
+	return response;
+}
+
+/* Caches the body of @message, the response to a query for the ACL feed at @acl_uri, as the rules of the current version of @entry, if the cache
+ * is enabled and @entry has an ID and ETag to key it with */
+void
+_gdata_service_acl_cache_insert (GDataService *self, GDataEntry *entry, const gchar *acl_uri, SoupMessage *message)
+{
+	GDataServicePrivate *priv = self->priv;
+	CachedRules *cached;
+	const gchar *id, *etag;
+	GList *link;
+
+	id = gdata_entry_get_id (entry);
+	etag = gdata_entry_get_etag (entry);
+
+	if (id == NULL || etag == NULL)
+		return;
+
+	g_mutex_lock (&(priv->acl_cache_mutex));
+
+	if (priv->acl_cache_size == 0) {
+		g_mutex_unlock (&(priv->acl_cache_mutex));
+		return;
+	}
+
+	cached = g_slice_new (CachedRules);
+	cached->id = g_strdup (id);
+	cached->etag = g_strdup (etag);
+	cached->acl_uri = soup_uri_new (acl_uri);
+	cached->response = g_bytes_new (message->response_body->data, message->response_body->length);
+	cached->size = sizeof (CachedRules) + strlen (id) + strlen (etag) + 2 + message->response_body->length;
+	if (acl_uri != NULL)
+		cached->size += strlen (acl_uri) + 1;
+	cached->last_used = g_get_monotonic_time ();
+
+	/* Replace any existing version */
+	link = g_hash_table_lookup (priv->acl_cache, id);
+	if (link != NULL)
+		acl_cache_remove_link (priv, link);
+
+	g_queue_push_head (&(priv->acl_cache_lru), cached);
+	g_hash_table_insert (priv->acl_cache, cached->id, priv->acl_cache_lru.head);
+	priv->acl_cache_bytes += cached->size;
+
+	acl_cache_trim (priv);
+
+	g_mutex_unlock (&(priv->acl_cache_mutex));
+
+	_gdata_cache_manager_cache_grown (priv->acl_cache_registration);
+}
+
+/* Returns %TRUE if @uri is @acl_uri or a resource beneath it, such as one of its rules or its batch feed */
+static gboolean
+acl_uri_contains (SoupURI *acl_uri, SoupURI *uri)
+{
+	const gchar *acl_path, *path;
+	gsize acl_path_length;
+
+	if (acl_uri == NULL || g_strcmp0 (acl_uri->host, uri->host) != 0)
+		return FALSE;
+
+	acl_path = acl_uri->path;
+	path = uri->path;
+	acl_path_length = strlen (acl_path);
+
+	return (strncmp (acl_path, path, acl_path_length) == 0 && (path[acl_path_length] == '\0' || path[acl_path_length] == '/'));
+}
+
+/* Drops the cached rules which might have been changed by a modifying request once it's finished. This is done whether the request succeeded or
+ * not, since even a failed request might have been applied, or might have failed because the access control list had changed on the server. */
+static void
+acl_cache_finished_cb (SoupMessage *message, GDataService *self)
+{
+	GDataServicePrivate *priv = self->priv;
+	SoupURI *uri;
+	GList *link, *next;
+
+	uri = soup_message_get_uri (message);
+
+	g_mutex_lock (&(priv->acl_cache_mutex));
+
+	for (link = priv->acl_cache_lru.head; link != NULL; link = next) {
+		next = link->next;
+
+		if (acl_uri_contains (((CachedRules*) link->data)->acl_uri, uri) == TRUE)
+			acl_cache_remove_link (priv, link);
+	}
+
+	g_mutex_unlock (&(priv->acl_cache_mutex));
+}
+
+/* Builds the request for gdata_service_query_single_entry() and gdata_service_query_single_entry_async(). If the request is made conditional on a
+ * cached version of the entry, a reference to that version is returned in @cached_entry. */
+static SoupMessage *
+build_single_entry_message (GDataService *self, GDataAuthorizationDomain *domain, const gchar *entry_id, GDataQuery *query, GType entry_type,
+                            GDataEntry **cached_entry)
+{
+	GDataEntryClass *klass;
+	SoupMessage *message;
+	gchar *entry_uri;
+
+	*cached_entry = NULL;
+
+	/* An explicit ETag on the query takes precedence over the cache. The cache only holds complete entries, so can't be used for partial
+	 * queries. */
+	if (query == NULL || (gdata_query_get_etag (query) == NULL && gdata_query_get_fields (query) == NULL))
+		*cached_entry = entry_cache_lookup (self, entry_id, entry_type);
+
+	/* Query for just the specified entry */
+	klass = GDATA_ENTRY_CLASS (g_type_class_ref (entry_type));
+	g_assert (klass->get_entry_uri != NULL);
+
+	entry_uri = klass->get_entry_uri (entry_id);
+	message = build_conditional_query_message (self, domain, entry_uri, query,
+	                                           (*cached_entry != NULL) ? gdata_entry_get_etag (*cached_entry) : NULL);
+	g_free (entry_uri);
+	g_type_class_unref (klass);
+
+	return message;
+}
+
+/* Handles the response to a request built by build_single_entry_message(), returning the queried entry (or %NULL) */
+static GDataEntry *
+parse_single_entry_response (GDataService *self, SoupMessage *message, guint status, const gchar *entry_id, GDataQuery *query, GType entry_type,
+                             GDataEntry *cached_entry, GError **error)
+{
+	GDataEntry *entry;
+
+	if (status == SOUP_STATUS_NOT_MODIFIED && cached_entry != NULL) {
+		/* Our cached version is still current */
+		return g_object_ref (cached_entry);
+	} else if (check_query_response_status (self, message, status, error) == FALSE) {
+		return NULL;
+	}
+
+	g_assert (message->response_body->data != NULL);
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (entry_type, message->response_body->data, message->response_body->length, error));
+
+	if (entry != NULL && query != NULL && gdata_query_get_fields (query) != NULL) {
+		/* When querying a single entry, the selector applies to the entry itself */
+		_gdata_entry_set_partial_fields (entry, gdata_query_get_fields (query));
+	} else if (entry != NULL) {
+		entry_cache_insert (self, entry_id, entry);
+	}
+
+	return entry;
+}
+
+/**
+ * gdata_service_query_single_entry:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @entry_id: the entry ID of the desired entry
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry to build from the XML
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Retrieves information about the single entry with the given @entry_id. @entry_id should be as returned by
+ * gdata_entry_get_id().
+ *
+ * Parameters and errors are as for gdata_service_query(). Most of the properties of @query aren't relevant, and
+ * will cause a server-side error if used. The most useful property to use is #GDataQuery:etag, which will cause the
+ * server to not return anything if the entry hasn't been modified since it was given the specified ETag; thus saving
+ * bandwidth. If the server does not return anything for this reason, gdata_service_query_single_entry() will return
+ * %NULL, but will not set an error in @error.
+ *
+ * If #GDataService:entry-cache-size is non-zero and @query doesn't have an ETag set, the service's entry cache is used instead: the query is made
+ * conditional on the ETag of the cached version of the entry, and if the entry hasn't been modified the cached #GDataEntry is returned. Note that
+ * this means the same #GDataEntry may be returned from several calls, so it shouldn't be modified.
+ *
+ * Return value: (transfer full): a #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.9.0
+ **/
+GDataEntry *
+gdata_service_query_single_entry (GDataService *self, GDataAuthorizationDomain *domain, const gchar *entry_id, GDataQuery *query, GType entry_type,
+                                  GCancellable *cancellable, GError **error)
+{
+	GDataEntry *entry, *cached_entry;
+	SoupMessage *message;
+	guint status;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (entry_id != NULL, NULL);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	message = build_single_entry_message (self, domain, entry_id, query, entry_type, &cached_entry);
+
+	/* Note that cancellation only applies to network activity; not to the processing done afterwards */
+	status = send_hedged_message (self, message, cancellable, error);
+	entry = parse_single_entry_response (self, message, status, entry_id, query, entry_type, cached_entry, error);
+	emit_request_completed (self, message, GDATA_OPERATION_QUERY, domain);
+
+	g_object_unref (message);
+	if (cached_entry != NULL)
+		g_object_unref (cached_entry);
+
+	return entry;
+}
+
+typedef struct {
+	GDataAuthorizationDomain *domain;
+	gchar *entry_id;
+	GDataQuery *query;
+	GType entry_type;
+	SoupMessage *message;
+	GDataEntry *cached_entry;
+	GSimpleAsyncResult *result;
+} QuerySingleEntryAsyncData;
+
+static void
+query_single_entry_async_data_free (QuerySingleEntryAsyncData *data)
+{
+	if (data->domain != NULL)
+		g_object_unref (data->domain);
+
+	g_free (data->entry_id);
+	if (data->query != NULL)
+		g_object_unref (data->query);
+	if (data->message != NULL)
+		g_object_unref (data->message);
+	if (data->cached_entry != NULL)
+		g_object_unref (data->cached_entry);
+	g_slice_free (QuerySingleEntryAsyncData, data);
+}
+
+static void
+query_single_entry_send_cb (GDataService *service, GAsyncResult *send_result, QuerySingleEntryAsyncData *data)
+{
+	GSimpleAsyncResult *result = data->result;
+	GDataEntry *entry = NULL;
+	GError *error = NULL;
+	guint status;
+
+	status = send_hedged_message_finish (service, send_result, &error);
+	entry = parse_single_entry_response (service, data->message, status, data->entry_id, data->query, data->entry_type, data->cached_entry,
+	                                     &error);
+	emit_request_completed (service, data->message, GDATA_OPERATION_QUERY, data->domain);
+
+	if (entry != NULL) {
+		g_simple_async_result_set_op_res_gpointer (result, entry, (GDestroyNotify) g_object_unref);
+	} else if (error != NULL) {
+		g_simple_async_result_take_error (result, error);
+	}
+
+	g_simple_async_result_complete (result);
+
+	query_single_entry_async_data_free (data);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_service_query_single_entry_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
+ * @entry_id: the entry ID of the desired entry
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @entry_type: a #GType for the #GDataEntry to build from the XML
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the query is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Retrieves information about the single entry with the given @entry_id. @entry_id should be as returned by
+ * gdata_entry_get_id(). @self, @query and @entry_id are reffed/copied when this
+ * function is called, so can safely be freed after this function returns.
+ *
+ * For more details, see gdata_service_query_single_entry(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_query_single_entry_finish()
+ * to get the results of the operation.
+ *
+ * Since: 0.9.0
+ **/
+void
+gdata_service_query_single_entry_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *entry_id, GDataQuery *query,
+                                        GType entry_type, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	QuerySingleEntryAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (entry_id != NULL);
+	g_return_if_fail (query == NULL || GDATA_IS_QUERY (query));
+	g_return_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new0 (QuerySingleEntryAsyncData);
+	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
+	data->query = (query != NULL) ? g_object_ref (query) : NULL;
+	data->entry_id = g_strdup (entry_id);
+	data->entry_type = entry_type;
+
+	/* Build the message here, rather than in a thread, and send it asynchronously */
+	data->message = build_single_entry_message (self, domain, entry_id, query, entry_type, &(data->cached_entry));
+
+	/* The result's owned by @data until the message has been sent */
+	data->result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_single_entry_async);
+	send_hedged_message_async (self, data->message, cancellable, (GAsyncReadyCallback) query_single_entry_send_cb, data);
+}
+
+/**
+ * gdata_service_query_single_entry_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous query operation for a single entry, as started with gdata_service_query_single_entry_async().
+ *
+ * Return value: (transfer full): a #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.7.0
+ **/
+GDataEntry *
+gdata_service_query_single_entry_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	GDataEntry *entry;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_query_single_entry_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	entry = g_simple_async_result_get_op_res_gpointer (result);
+	if (entry != NULL)
+		return g_object_ref (entry);
+	return NULL;
+}
+
+/* Results shared between the requests made by query_entries_by_id() */
+typedef struct {
+	GMutex mutex; /* protects all the members */
+	GHashTable *entries; /* entry ID → GDataEntry */
+	GError *error; /* first error other than GDATA_SERVICE_ERROR_NOT_FOUND, or %NULL */
+} QueryByIdResults;
+
+typedef struct {
+	QueryByIdResults *results;
+	const gchar *entry_id;
+} QueryByIdOperation;
+
+/* Records the result of querying for @entry_id. Entries which don't exist (any more) are simply left out of the results. */
+static void
+query_by_id_record (QueryByIdResults *results, const gchar *entry_id, GDataEntry *entry, const GError *error)
+{
+	g_mutex_lock (&(results->mutex));
+
+	if (entry != NULL) {
+		g_hash_table_replace (results->entries, g_strdup (entry_id), g_object_ref (entry));
+	} else if (error != NULL && g_error_matches (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND) == FALSE &&
+	           results->error == NULL) {
+		results->error = g_error_copy (error);
+	}
+
+	g_mutex_unlock (&(results->mutex));
+}
+
+static void
+query_by_id_batch_cb (guint operation_id, GDataBatchOperationType operation_type, GDataEntry *entry, GError *error, QueryByIdOperation *operation)
+{
+	query_by_id_record (operation->results, operation->entry_id, entry, error);
+}
+
+typedef struct {
+	GDataService *service;
+	GDataAuthorizationDomain *domain;
+	GType entry_type;
+	GCancellable *cancellable;
+	QueryByIdResults *results;
+} QueryByIdPoolData;
+
+static void
+query_by_id_thread (const gchar *entry_id, QueryByIdPoolData *data)
+{
+	GDataEntry *entry;
+	GError *error = NULL;
+
+	entry = gdata_service_query_single_entry (data->service, data->domain, entry_id, NULL, data->entry_type, data->cancellable, &error);
+	query_by_id_record (data->results, entry_id, entry, error);
+
+	if (entry != NULL)
+		g_object_unref (entry);
+	g_clear_error (&error);
+}
+
+static GHashTable *
+query_entries_by_id (GDataService *self, GDataAuthorizationDomain *domain, const gchar *batch_feed_uri, const gchar * const *entry_ids,
+                     GType entry_type, GCancellable *cancellable, GError **error)
+{
+	QueryByIdResults results;
+	GHashTable *unique_ids;
+	GPtrArray *ids;
+	GError *child_error = NULL;
+	guint i;
+
+	/* Query each entry only once, however many times it's listed */
+	unique_ids = g_hash_table_new (g_str_hash, g_str_equal);
+	ids = g_ptr_array_new ();
+
+	for (i = 0; entry_ids[i] != NULL; i++) {
+		if (g_hash_table_contains (unique_ids, entry_ids[i]) == FALSE) {
+			g_hash_table_add (unique_ids, (gpointer) entry_ids[i]);
+			g_ptr_array_add (ids, (gpointer) entry_ids[i]);
+		}
+	}
+
+	g_hash_table_destroy (unique_ids);
+
+	g_mutex_init (&(results.mutex));
+	results.entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	results.error = NULL;
+
+	if (batch_feed_uri != NULL && GDATA_IS_BATCHABLE (self) == TRUE && ids->len > 1) {
+		GDataBatchOperation *operation;
+		QueryByIdOperation *operations;
+
+		/* Fetch the entries a batch feed at a time. The batch operation splits the queries between as many requests as it needs. Batch
+		 * queries can't be conditional, but the results are added to the entry cache as usual, ready for later single-entry queries. */
+		operation = gdata_batchable_create_operation (GDATA_BATCHABLE (self), domain, batch_feed_uri);
+		gdata_batch_operation_set_max_operations_per_request (operation, GDATA_BATCH_MAX_OPERATIONS_PER_REQUEST);
+		gdata_batch_operation_set_max_concurrent_requests (operation, MAX (gdata_service_get_max_connections_per_host (self), 1));
+		operations = g_new (QueryByIdOperation, ids->len);
+
+		for (i = 0; i < ids->len; i++) {
+			operations[i].results = &results;
+			operations[i].entry_id = ids->pdata[i];
+			gdata_batch_operation_add_query (operation, ids->pdata[i], entry_type, (GDataBatchOperationCallback) query_by_id_batch_cb,
+			                                 &(operations[i]));
+		}
+
+		gdata_batch_operation_run (operation, cancellable, &child_error);
+
+		g_object_unref (operation);
+		g_free (operations);
+
+		g_mutex_lock (&(results.mutex));
+		g_hash_table_foreach (results.entries, (GHFunc) entry_cache_insert_cb, self);
+		g_mutex_unlock (&(results.mutex));
+	} else {
+		GThreadPool *pool;
+		QueryByIdPoolData pool_data;
+
+		/* Fall back to querying the entries individually, as many at once as the service's connection limit allows. Each query is
+		 * conditional on the ETag of the entry's cached version, if it has one, so entries which haven't changed cost very little. */
+		pool_data.service = self;
+		pool_data.domain = domain;
+		pool_data.entry_type = entry_type;
+		pool_data.cancellable = cancellable;
+		pool_data.results = &results;
+
+		pool = g_thread_pool_new ((GFunc) query_by_id_thread, &pool_data, MAX (gdata_service_get_max_connections_per_host (self), 1), FALSE,
+		                          &child_error);
+
+		if (pool != NULL) {
+			for (i = 0; i < ids->len; i++)
+				g_thread_pool_push (pool, ids->pdata[i], NULL);
+
+			/* Wait for all the queries to finish */
+			g_thread_pool_free (pool, FALSE, TRUE);
+		}
+	}
+
+	g_ptr_array_unref (ids);
+	g_mutex_clear (&(results.mutex));
+
+	if (child_error == NULL && results.error != NULL) {
+		child_error = results.error;
+		results.error = NULL;
+	}
+
+	g_clear_error (&(results.error));
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		g_hash_table_unref (results.entries);
+		return NULL;
+	}
+
+	return results.entries;
+}
+
+/**
+ * gdata_service_query_entries_by_id:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the queries fall under, or %NULL
+ * @batch_feed_uri: (allow-none): the URI of the batch feed to query the entries through, or %NULL
+ * @entry_ids: (array zero-terminated=1): a %NULL-terminated array of the entry IDs of the desired entries
+ * @entry_type: a #GType for the #GDataEntrys to build from the XML
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Retrieves the current versions of all the entries with the given @entry_ids, as for calling gdata_service_query_single_entry() for each of them.
+ * Each entry ID should be as returned by gdata_entry_get_id(), and is only queried once, however many times it's listed.
+ *
+ * If @self implements #GDataBatchable and @batch_feed_uri is non-%NULL, the entries are queried in batch requests to @batch_feed_uri (normally the
+ * %GDATA_LINK_BATCH link URI in the appropriate #GDataFeed), as many at once as #GDataService:max-connections-per-host allows. Otherwise, they're
+ * queried individually, with up to that many queries in flight at once. Individual queries use the service's entry cache as
+ * gdata_service_query_single_entry() does, so entries which haven't changed since they were cached aren't downloaded again; entries returned by batch
+ * queries are added to the cache.
+ *
+ * Entries which don't exist are left out of the returned hash table, rather than causing an error. If any other query fails, or the operation is
+ * cancelled, %NULL is returned and @error is set, even though other queries may have succeeded.
+ *
+ * Return value: (transfer full) (element-type utf8 GData.Entry): a hash table mapping each entry ID to its #GDataEntry, or %NULL; unref with
+ * g_hash_table_unref()
+ *
+ * Since: 0.15.0
+ **/
+GHashTable *
+gdata_service_query_entries_by_id (GDataService *self, GDataAuthorizationDomain *domain, const gchar *batch_feed_uri, const gchar * const *entry_ids,
+                                   GType entry_type, GCancellable *cancellable, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (entry_ids != NULL, NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	return query_entries_by_id (self, domain, batch_feed_uri, entry_ids, entry_type, cancellable, error);
+}
+
+typedef struct {
+	GDataAuthorizationDomain *domain;
+	gchar *batch_feed_uri;
+	gchar **entry_ids;
+	GType entry_type;
+	GHashTable *entries;
+} QueryEntriesByIdAsyncData;
+
+static void
+query_entries_by_id_async_data_free (QueryEntriesByIdAsyncData *data)
+{
+	if (data->domain != NULL)
+		g_object_unref (data->domain);
+
+	g_free (data->batch_feed_uri);
+	g_strfreev (data->entry_ids);
+	if (data->entries != NULL)
+		g_hash_table_unref (data->entries);
+	g_slice_free (QueryEntriesByIdAsyncData, data);
+}
+
+static void
+query_entries_by_id_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+{
+	QueryEntriesByIdAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	data->entries = query_entries_by_id (service, data->domain, data->batch_feed_uri, (const gchar * const *) data->entry_ids, data->entry_type,
+	                                     cancellable, &error);
+
+	if (data->entries == NULL)
+		g_simple_async_result_take_error (result, error);
+}
+
+/**
+ * gdata_service_query_entries_by_id_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the queries fall under, or %NULL
+ * @batch_feed_uri: (allow-none): the URI of the batch feed to query the entries through, or %NULL
+ * @entry_ids: (array zero-terminated=1): a %NULL-terminated array of the entry IDs of the desired entries
+ * @entry_type: a #GType for the #GDataEntrys to build from the XML
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the queries are finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Retrieves the current versions of all the entries with the given @entry_ids. @self, @domain, @batch_feed_uri and @entry_ids are reffed/copied
+ * when this function is called, so can safely be freed after this function returns.
+ *
+ * For more details, see gdata_service_query_entries_by_id(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_query_entries_by_id_finish() to get the results of
+ * the operation.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_query_entries_by_id_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *batch_feed_uri,
+                                         const gchar * const *entry_ids, GType entry_type, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                         gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	QueryEntriesByIdAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (entry_ids != NULL);
+	g_return_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new (QueryEntriesByIdAsyncData);
+	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
+	data->batch_feed_uri = g_strdup (batch_feed_uri);
+	data->entry_ids = g_strdupv ((gchar**) entry_ids);
+	data->entry_type = entry_type;
+	data->entries = NULL;
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_entries_by_id_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_entries_by_id_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_entries_by_id_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_service_query_entries_by_id_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous query operation for several entries, as started with gdata_service_query_entries_by_id_async().
+ *
+ * Return value: (transfer full) (element-type utf8 GData.Entry): a hash table mapping each entry ID to its #GDataEntry, or %NULL; unref with
+ * g_hash_table_unref()
+ *
+ * Since: 0.15.0
+ **/
+GHashTable *
+gdata_service_query_entries_by_id_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	QueryEntriesByIdAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_query_entries_by_id_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	data = g_simple_async_result_get_op_res_gpointer (result);
+	return g_hash_table_ref (data->entries);
+}
+
+/* The state shared between the threads querying each source in query_top_entries() */
+typedef struct {
+	GDataService *service;
+	GDataAuthorizationDomain *domain;
+	const gchar *feed_uri;
+	GType entry_type;
+	guint n_entries;
+	GCompareDataFunc compare_func;
+	gpointer compare_user_data;
+	GCancellable *cancellable;
+
+	GMutex mutex; /* protects the members below */
+	GPtrArray *heap; /* the best n_entries entries so far (owned), as a binary heap with the worst at the root */
+	GError *error; /* the first error from any source, or %NULL */
+} QueryTopData;
+
+static inline gint
+query_top_compare (QueryTopData *data, gconstpointer a, gconstpointer b)
+{
+	return data->compare_func (a, b, data->compare_user_data);
+}
+
+/* Moves the entry at @i towards the root of the heap until its parent is worse than it */
+static void
+query_top_sift_up (QueryTopData *data, guint i)
+{
+	gpointer *heap = data->heap->pdata;
+
+	while (i > 0) {
+		guint parent = (i - 1) / 2;
+		gpointer entry;
+
+		if (query_top_compare (data, heap[i], heap[parent]) <= 0)
+			break;
+
+		entry = heap[i];
+		heap[i] = heap[parent];
+		heap[parent] = entry;
+		i = parent;
+	}
+}
+
+/* Moves the entry at @i away from the root of the heap until both its children are better than it */
+static void
+query_top_sift_down (QueryTopData *data, guint i)
+{
+	gpointer *heap = data->heap->pdata;
+	guint length = data->heap->len;
+
+	while (TRUE) {
+		guint worst = i, left = 2 * i + 1, right = 2 * i + 2;
+		gpointer entry;
+
+		if (left < length && query_top_compare (data, heap[left], heap[worst]) > 0)
+			worst = left;
+		if (right < length && query_top_compare (data, heap[right], heap[worst]) > 0)
+			worst = right;
+
+		if (worst == i)
+			break;
+
+		entry = heap[i];
+		heap[i] = heap[worst];
+		heap[worst] = entry;
+		i = worst;
+	}
+}
+
+/* Adds @entry to the results if it's one of the best n_entries so far, displacing the worst of them if need be. Returns %FALSE if the results are
+ * full and @entry isn't better than any of them. Must be called with the mutex held. */
+static gboolean
+query_top_offer (QueryTopData *data, GDataEntry *entry)
+{
+	GPtrArray *heap = data->heap;
+
+	if (heap->len < data->n_entries) {
+		g_ptr_array_add (heap, g_object_ref (entry));
+		query_top_sift_up (data, heap->len - 1);
+		return TRUE;
+	}
+
+	if (query_top_compare (data, entry, heap->pdata[0]) >= 0)
+		return FALSE;
+
+	g_object_unref (heap->pdata[0]);
+	heap->pdata[0] = g_object_ref (entry);
+	query_top_sift_down (data, 0);
+
+	return TRUE;
+}
+
+/* Pages through the results of one source, offering each entry for the results, until it runs out of pages or its results can no longer make the
+ * cut. Each source's results are ordered by the server in the same way as compare_func orders them, so as soon as one entry fails to make the
+ * cut, none of those after it can either. */
+static void
+query_top_source_thread (GDataQuery *query, QueryTopData *data)
+{
+	while (TRUE) {
+		GDataFeed *feed;
+		GList *i, *entries;
+		GError *error = NULL;
+		gboolean finished;
+
+		/* Give up if another source has failed */
+		g_mutex_lock (&(data->mutex));
+		finished = (data->error != NULL) ? TRUE : FALSE;
+		g_mutex_unlock (&(data->mutex));
+
+		if (finished == TRUE)
+			return;
+
+		feed = gdata_service_query (data->service, data->domain, data->feed_uri, query, data->entry_type, data->cancellable, NULL, NULL,
+		                            &error);
+
+		if (feed == NULL) {
+			g_mutex_lock (&(data->mutex));
+			if (data->error == NULL && error != NULL)
+				data->error = error;
+			else
+				g_clear_error (&error);
+			g_mutex_unlock (&(data->mutex));
+
+			return;
+		}
+
+		entries = gdata_feed_get_entries (feed);
+		finished = (entries == NULL) ? TRUE : FALSE;
+
+		g_mutex_lock (&(data->mutex));
+
+		for (i = entries; i != NULL; i = i->next) {
+			if (query_top_offer (data, GDATA_ENTRY (i->data)) == FALSE) {
+				finished = TRUE;
+				break;
+			}
+		}
+
+		g_mutex_unlock (&(data->mutex));
+
+		if (gdata_feed_look_up_link (feed, "next") == NULL && _gdata_feed_get_next_page_token (feed) == NULL)
+			finished = TRUE;
+
+		g_object_unref (feed);
+
+		if (finished == TRUE)
+			return;
+
+		gdata_query_next_page (query);
+	}
+}
+
+/* Returns copies of @queries for query_top_entries() to page through, so that the callers' queries aren't changed (or changed by several threads at
+ * once). Each page is limited to @n_entries results, since no source can contribute more than that. */
+static GPtrArray *
+copy_top_queries (GList *queries, guint n_entries)
+{
+	GPtrArray *copies;
+	GList *i;
+
+	copies = g_ptr_array_new_with_free_func (g_object_unref);
+
+	for (i = queries; i != NULL; i = i->next) {
+		GDataQuery *copy = _gdata_query_copy (GDATA_QUERY (i->data));
+
+		if (gdata_query_get_max_results (copy) == 0 || gdata_query_get_max_results (copy) > n_entries)
+			gdata_query_set_max_results (copy, n_entries);
+		gdata_query_set_page_cache_mode (copy, GDATA_PAGE_CACHE_NONE);
+
+		g_ptr_array_add (copies, copy);
+	}
+
+	return copies;
+}
+
+static gint
+query_top_compare_pointers (gconstpointer a, gconstpointer b, QueryTopData *data)
+{
+	return query_top_compare (data, *((gconstpointer*) a), *((gconstpointer*) b));
+}
+
+static GList *
+query_top_entries (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GPtrArray *queries, GType entry_type,
+                   guint n_entries, GCompareDataFunc compare_func, gpointer compare_user_data, GCancellable *cancellable, GError **error)
+{
+	QueryTopData data;
+	GThreadPool *pool;
+	GList *entries = NULL;
+	GError *child_error = NULL;
+	guint i;
+
+	data.service = self;
+	data.domain = domain;
+	data.feed_uri = feed_uri;
+	data.entry_type = entry_type;
+	data.n_entries = n_entries;
+	data.compare_func = compare_func;
+	data.compare_user_data = compare_user_data;
+	data.cancellable = cancellable;
+	g_mutex_init (&(data.mutex));
+	data.heap = g_ptr_array_sized_new (n_entries);
+	data.error = NULL;
+
+	/* Query the sources concurrently, as many at once as the service's connection limit allows */
+	pool = g_thread_pool_new ((GFunc) query_top_source_thread, &data, MAX (gdata_service_get_max_connections_per_host (self), 1), FALSE,
+	                          &child_error);
+
+	if (pool != NULL) {
+		for (i = 0; i < queries->len; i++)
+			g_thread_pool_push (pool, queries->pdata[i], NULL);
+
+		/* Wait for all the sources to finish */
+		g_thread_pool_free (pool, FALSE, TRUE);
+	}
+
+	g_mutex_clear (&(data.mutex));
+
+	if (child_error == NULL)
+		child_error = data.error;
+	else
+		g_clear_error (&(data.error));
+
+	if (child_error != NULL) {
+		g_ptr_array_foreach (data.heap, (GFunc) g_object_unref, NULL);
+		g_ptr_array_free (data.heap, TRUE);
+		g_propagate_error (error, child_error);
+
+		return NULL;
+	}
+
+	/* Hand the entries over best first */
+	g_ptr_array_sort_with_data (data.heap, (GCompareDataFunc) query_top_compare_pointers, &data);
+
+	for (i = data.heap->len; i > 0; i--)
+		entries = g_list_prepend (entries, data.heap->pdata[i - 1]);
+
+	g_ptr_array_free (data.heap, TRUE);
+
+	return entries;
+}
+
+/**
+ * gdata_service_query_top_entries:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the queries fall under, or %NULL
+ * @feed_uri: the feed URI to query, including the host name and protocol
+ * @queries: (element-type GData.Query): a list of #GDataQuery<!-- -->s, one for each source of entries
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @n_entries: the number of entries to return; must be greater than <code class="literal">0</code>
+ * @compare_func: (scope call) (closure compare_user_data): a function which returns a negative number if its first entry ranks higher than its
+ * second, a positive number if it ranks lower, or <code class="literal">0</code> if they rank equally
+ * @compare_user_data: data to pass to @compare_func
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Finds the @n_entries highest-ranking entries, according to @compare_func, across several sources of entries, such as several channels'
+ * videos or several folders' documents. Each source is queried with one of @queries on @feed_uri, and each query must make the server return its
+ * results in the order defined by @compare_func (for example, by setting #GDataYouTubeQuery:order-by).
+ *
+ * The sources are queried concurrently, as many at once as #GDataService:max-connections-per-host allows, and the best @n_entries results seen
+ * so far are kept as they arrive. Since each source's results are in order, a source stops being paged through as soon as one of its results
+ * fails to beat the @n_entries<!-- -->th best result so far, and each page is limited to @n_entries results (or fewer, if #GDataQuery:max-results
+ * is already smaller). This bounds both the number of requests and the memory used, however large the sources are, rather than fetching all their
+ * results and sorting them.
+ *
+ * @queries aren't modified: each is copied before being queried.
+ *
+ * If any of the queries fails, or the operation is cancelled, %NULL is returned and @error is set.
+ *
+ * Return value: (transfer full) (element-type GData.Entry): the highest-ranking entries, best first; free with g_list_free_full() and
+ * g_object_unref(). This is %NULL with @error unset if the sources had no entries.
+ *
+ * Since: 0.15.0
+ **/
+GList *
+gdata_service_query_top_entries (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GList *queries, GType entry_type,
+                                 guint n_entries, GCompareDataFunc compare_func, gpointer compare_user_data, GCancellable *cancellable,
+                                 GError **error)
+{
+	GPtrArray *copies;
+	GList *entries;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (feed_uri != NULL, NULL);
+	g_return_val_if_fail (queries != NULL, NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE, NULL);
+	g_return_val_if_fail (n_entries > 0, NULL);
+	g_return_val_if_fail (compare_func != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	copies = copy_top_queries (queries, n_entries);
+	entries = query_top_entries (self, domain, feed_uri, copies, entry_type, n_entries, compare_func, compare_user_data, cancellable, error);
+	g_ptr_array_unref (copies);
+
+	return entries;
+}
+
+typedef struct {
+	GDataAuthorizationDomain *domain;
+	gchar *feed_uri;
+	GPtrArray *queries;
+	GType entry_type;
+	guint n_entries;
+	GCompareDataFunc compare_func;
+	gpointer compare_user_data;
+	GDestroyNotify destroy_compare_user_data;
+	GList *entries;
+} QueryTopEntriesAsyncData;
+
+static void
+query_top_entries_async_data_free (QueryTopEntriesAsyncData *data)
+{
+	if (data->domain != NULL)
+		g_object_unref (data->domain);
+
+	g_free (data->feed_uri);
+	g_ptr_array_unref (data->queries);
+	if (data->destroy_compare_user_data != NULL)
+		data->destroy_compare_user_data (data->compare_user_data);
+	g_list_free_full (data->entries, g_object_unref);
+	g_slice_free (QueryTopEntriesAsyncData, data);
+}
+
+static void
+query_top_entries_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+{
+	QueryTopEntriesAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	data->entries = query_top_entries (service, data->domain, data->feed_uri, data->queries, data->entry_type, data->n_entries,
+	                                   data->compare_func, data->compare_user_data, cancellable, &error);
+
+	if (error != NULL)
+		g_simple_async_result_take_error (result, error);
+}
+
+/**
+ * gdata_service_query_top_entries_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the queries fall under, or %NULL
+ * @feed_uri: the feed URI to query, including the host name and protocol
+ * @queries: (element-type GData.Query): a list of #GDataQuery<!-- -->s, one for each source of entries
+ * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
+ * @n_entries: the number of entries to return; must be greater than <code class="literal">0</code>
+ * @compare_func: (scope notified) (closure compare_user_data): a function which returns a negative number if its first entry ranks higher than its
+ * second, a positive number if it ranks lower, or <code class="literal">0</code> if they rank equally
+ * @compare_user_data: data to pass to @compare_func
+ * @destroy_compare_user_data: (allow-none): the function to call when @compare_func will not be called any more, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the queries are finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Finds the @n_entries highest-ranking entries across several sources of entries. @self, @domain and @feed_uri are reffed/copied, and @queries
+ * are copied, when this function is called, so can safely be freed after this function returns. @compare_func is called in another thread.
+ *
+ * For more details, see gdata_service_query_top_entries(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_query_top_entries_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_query_top_entries_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GList *queries,
+                                       GType entry_type, guint n_entries, GCompareDataFunc compare_func, gpointer compare_user_data,
+                                       GDestroyNotify destroy_compare_user_data, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	QueryTopEntriesAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (feed_uri != NULL);
+	g_return_if_fail (queries != NULL);
+	g_return_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE);
+	g_return_if_fail (n_entries > 0);
+	g_return_if_fail (compare_func != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new (QueryTopEntriesAsyncData);
+	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
+	data->feed_uri = g_strdup (feed_uri);
+	data->queries = copy_top_queries (queries, n_entries);
+	data->entry_type = entry_type;
+	data->n_entries = n_entries;
+	data->compare_func = compare_func;
+	data->compare_user_data = compare_user_data;
+	data->destroy_compare_user_data = destroy_compare_user_data;
+	data->entries = NULL;
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_top_entries_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_top_entries_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_top_entries_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_service_query_top_entries_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous query for the highest-ranking entries across several sources, as started with gdata_service_query_top_entries_async().
+ *
+ * Return value: (transfer full) (element-type GData.Entry): the highest-ranking entries, best first; free with g_list_free_full() and
+ * g_object_unref(). This is %NULL with @error unset if the sources had no entries.
+ *
+ * Since: 0.15.0
+ **/
+GList *
+gdata_service_query_top_entries_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	QueryTopEntriesAsyncData *data;
+	GList *entries;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_query_top_entries_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	data = g_simple_async_result_get_op_res_gpointer (result);
+	entries = data->entries;
+	data->entries = NULL;
+
+	return entries;
+}
+
+/* Builds the request to upload @entry to @upload_uri; shared between gdata_service_insert_entry() and gdata_service_insert_entry_async(). */
+/* Asks for a minimal response to @message if #GDataService:minimal-responses is set. parse_entry_response() checks for the header, rather than the
+ * property, so that changing the property while a request is in flight doesn't matter. */
+static void
+append_minimal_response_header (GDataService *self, SoupMessage *message)
+{
+	if (g_atomic_int_get (&(self->priv->minimal_responses)) != 0)
+		soup_message_headers_replace (message->request_headers, "Prefer", "return=minimal");
+}
+
+static SoupMessage *
+build_insert_message (GDataService *self, GDataAuthorizationDomain *domain, const gchar *upload_uri, GDataEntry *entry)
+{
+	SoupMessage *message;
+	gchar *upload_data;
+	GDataParsableClass *klass;
+
+	message = _gdata_service_build_message (self, domain, SOUP_METHOD_POST, upload_uri, NULL, FALSE);
+
+	/* Append the data */
+	klass = GDATA_PARSABLE_GET_CLASS (entry);
+	g_assert (klass->get_content_type != NULL);
+	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
+		upload_data = gdata_parsable_get_json (GDATA_PARSABLE (entry));
+		soup_message_set_request (message, "application/json", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
+	} else {
+		_gdata_service_set_request_xml (message, GDATA_PARSABLE (entry), FALSE);
+		append_minimal_response_header (self, message);
+	}
+
+	return message;
+}
+
+/* Scans the XML response to an insertion or update for the root element's ETag and its <id> and edit <link> children, without building an
+ * entry from it. The strings are set to newly-allocated values if they're found, and left untouched otherwise. Scanning stops once all of
+ * them have been found, so the rest of the body isn't even tokenised. */
+static gboolean
+scan_minimal_entry_response (const gchar *data, gsize length, gchar **id, gchar **etag, gchar **edit_uri, GError **error)
+{
+	xmlTextReader *reader;
+	xmlChar *value;
+	gint ret, root_depth;
+
+	_gdata_parsable_init_libxml ();
+
+	reader = xmlReaderForMemory (data, length, "/dev/null", NULL, GDATA_XML_PARSE_OPTIONS);
+	if (reader == NULL)
+		goto error;
+
+	/* Skip over anything preceding the root element */
+	do {
+		ret = xmlTextReaderRead (reader);
+	} while (ret == 1 && xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT);
+
+	if (ret != 1)
+		goto error;
+
+	value = xmlTextReaderGetAttributeNs (reader, (xmlChar*) "etag", (xmlChar*) "http://schemas.google.com/g/2005");
+	if (value != NULL) {
+		g_free (*etag);
+		*etag = g_strdup ((gchar*) value);
+		xmlFree (value);
+	}
+
+	root_depth = xmlTextReaderDepth (reader);
+	ret = (xmlTextReaderIsEmptyElement (reader) != 0) ? 0 : xmlTextReaderRead (reader);
+
+	while (ret == 1 && xmlTextReaderDepth (reader) > root_depth && (*id == NULL || *edit_uri == NULL)) {
+		const xmlChar *name = xmlTextReaderConstLocalName (reader);
+
+		if (xmlTextReaderNodeType (reader) == XML_READER_TYPE_ELEMENT &&
+		    xmlStrcmp (xmlTextReaderConstNamespaceUri (reader), (xmlChar*) "http://www.w3.org/2005/Atom") == 0) {
+			if (xmlStrcmp (name, (xmlChar*) "id") == 0 && *id == NULL) {
+				value = xmlTextReaderReadString (reader);
+				*id = g_strdup ((gchar*) value);
+				xmlFree (value);
+			} else if (xmlStrcmp (name, (xmlChar*) "link") == 0 && *edit_uri == NULL) {
+				value = xmlTextReaderGetAttribute (reader, (xmlChar*) "rel");
+
+				/* Relation types can be given in full or relative to the IANA registry, as in gdata_link_get_relation_type() */
+				if (xmlStrcmp (value, (xmlChar*) "edit") == 0 || xmlStrcmp (value, (xmlChar*) GDATA_LINK_EDIT) == 0) {
+					xmlChar *href = xmlTextReaderGetAttribute (reader, (xmlChar*) "href");
+					*edit_uri = g_strdup ((gchar*) href);
+					xmlFree (href);
+				}
+
+				xmlFree (value);
+			}
+		}
+
+		ret = xmlTextReaderNext (reader);
+	}
+
+	if (ret == -1)
+		goto error;
+
+	xmlFreeTextReader (reader);
+
+	return TRUE;
+
+error:
+	{
+		xmlError *xml_error = xmlGetLastError ();
+		g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING,
+		             /* Translators: the parameter is an error message */
+		             _("Error parsing XML: %s"),
+		             (xml_error != NULL) ? xml_error->message : NULL);
+	}
+
+	if (reader != NULL)
+		xmlFreeTextReader (reader);
+
+	return FALSE;
+}
+
+/* Builds a new entry of the same type as @entry holding only the ID, ETag and edit link from a minimal response to @message; see
+ * #GDataService:minimal-responses. Anything the response body doesn't give is taken from the response headers or, for updates, from @entry. */
+static GDataEntry *
+parse_minimal_entry_response (GDataService *self, GDataOperationType operation_type, GDataEntry *entry, SoupMessage *message, GError **error)
+{
+	GDataEntry *updated_entry;
+	gchar *id = NULL, *etag = NULL, *edit_uri = NULL;
+
+	if (message->response_body->length > 0 &&
+	    scan_minimal_entry_response (message->response_body->data, message->response_body->length, &id, &etag, &edit_uri, error) == FALSE) {
+		return NULL;
+	}
+
+	if (etag == NULL)
+		etag = g_strdup (soup_message_headers_get_one (message->response_headers, "ETag"));
+
+	if (operation_type == GDATA_OPERATION_INSERTION) {
+		/* The Location of a newly-created entry is its edit URI */
+		if (edit_uri == NULL)
+			edit_uri = g_strdup (soup_message_headers_get_one (message->response_headers, "Location"));
+	} else {
+		GDataLink *_link;
+
+		if (id == NULL)
+			id = g_strdup (gdata_entry_get_id (entry));
+
+		_link = gdata_entry_look_up_link (entry, GDATA_LINK_EDIT);
+		if (edit_uri == NULL && _link != NULL)
+			edit_uri = g_strdup (gdata_link_get_uri (_link));
+	}
+
+	updated_entry = g_object_new (G_OBJECT_TYPE (entry), "id", id, "etag", etag, NULL);
+
+	if (edit_uri != NULL) {
+		GDataLink *_link = gdata_link_new (edit_uri, GDATA_LINK_EDIT);
+		gdata_entry_add_link (updated_entry, _link);
+		g_object_unref (_link);
+	}
+
+	g_free (id);
+	g_free (etag);
+	g_free (edit_uri);
+
+	return updated_entry;
+}
+
+/* Parses a new entry of the same type as @entry from the response to a message which sent @entry to the server, or sets @error appropriately
+ * for @status. @error may already have been set by _gdata_service_send_message() if @status is %SOUP_STATUS_NONE or
+ * %SOUP_STATUS_CANCELLED. */
+static GDataEntry *
+parse_new_entry_response (GDataService *self, GDataOperationType operation_type, GDataEntry *entry, SoupMessage *message, guint status,
+                          gboolean minimal, GError **error)
+{
+	GDataParsableClass *klass;
+
+	if (status == SOUP_STATUS_NONE || status == SOUP_STATUS_CANCELLED) {
+		/* Redirect error or cancelled */
+		return NULL;
+	} else if (minimal == TRUE && status == SOUP_STATUS_NO_CONTENT) {
+		/* The server honoured the request for a minimal response and didn't send a body */
+		return parse_minimal_entry_response (self, operation_type, entry, message, error);
+	} else if (status != SOUP_STATUS_OK && (operation_type != GDATA_OPERATION_INSERTION || status != SOUP_STATUS_CREATED)) {
+		/* Error: for XML APIs Google returns CREATED for insertions and for JSON it returns OK. */
+		GDataServiceClass *service_klass = GDATA_SERVICE_GET_CLASS (self);
+		g_assert (service_klass->parse_error_response != NULL);
+		service_klass->parse_error_response (self, operation_type, status, message->reason_phrase, message->response_body->data,
+		                                     message->response_body->length, error);
+		return NULL;
+	}
+
+	/* If the server sent the whole entry back anyway, only pick out the bits the caller wants */
+	if (minimal == TRUE)
+		return parse_minimal_entry_response (self, operation_type, entry, message, error);
+
+	/* Parse the XML or JSON according to GDataEntry type; create and return a new GDataEntry of the same type as @entry */
+	klass = GDATA_PARSABLE_GET_CLASS (entry);
+	g_assert (message->response_body->data != NULL);
+	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
+		return GDATA_ENTRY (gdata_parsable_new_from_json (G_OBJECT_TYPE (entry), message->response_body->data,
+		                                                  message->response_body->length, error));
+	} else {
+		return GDATA_ENTRY (gdata_parsable_new_from_xml (G_OBJECT_TYPE (entry), message->response_body->data,
+		                                                 message->response_body->length, error));
+	}
+}
+
+/* As parse_new_entry_response(), but if #GDataService:update-entries-in-place is set, @entry is updated to match the response and returned
+ * (with a new reference) instead of the new entry. */
+static GDataEntry *
+parse_entry_response (GDataService *self, GDataOperationType operation_type, GDataEntry *entry, SoupMessage *message, guint status,
+                      GError **error)
+{
+	GDataEntry *updated_entry;
+	gboolean minimal;
+
+	/* See append_minimal_response_header() */
+	minimal = (soup_message_headers_get_one (message->request_headers, "Prefer") != NULL);
+
+	updated_entry = parse_new_entry_response (self, operation_type, entry, message, status, minimal, error);
+
+	if (updated_entry != NULL && g_atomic_int_get (&(self->priv->update_entries_in_place)) != 0 &&
+	    _gdata_entry_refresh (entry, updated_entry, minimal) == TRUE) {
+		g_object_unref (updated_entry);
+		updated_entry = g_object_ref (entry);
+	}
+
+	return updated_entry;
+}
+
+/* Checks the response to a deletion request, setting @error appropriately for @status. As with parse_entry_response(), @error may already be
+ * set. */
+static gboolean
+parse_delete_response (GDataService *self, SoupMessage *message, guint status, GError **error)
+{
+	if (status == SOUP_STATUS_NONE || status == SOUP_STATUS_CANCELLED) {
+		/* Redirect error or cancelled */
+		return FALSE;
+	} else if (status != SOUP_STATUS_OK) {
+		/* Error */
+		GDataServiceClass *service_klass = GDATA_SERVICE_GET_CLASS (self);
+		g_assert (service_klass->parse_error_response != NULL);
+		service_klass->parse_error_response (self, GDATA_OPERATION_DELETION, status, message->reason_phrase, message->response_body->data,
+		                                     message->response_body->length, error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+typedef struct {
+	GDataOperationType operation_type;
+	GDataEntry *entry;
+	SoupMessage *message;
+	GSimpleAsyncResult *result;
+} ModifyEntryAsyncData;
+
+static void
+modify_entry_async_data_free (ModifyEntryAsyncData *data)
+{
+	g_object_unref (data->entry);
+	g_object_unref (data->message);
+	g_object_unref (data->result);
+
+	g_slice_free (ModifyEntryAsyncData, data);
+}
+
+/* Completes an asynchronous insertion, update or deletion once its message has been sent. For insertions and updates, the result is the updated
+ * entry; for deletions, it's a boolean. */
+static void
+modify_entry_send_cb (GDataService *service, GAsyncResult *send_result, ModifyEntryAsyncData *data)
+{
+	GSimpleAsyncResult *result = data->result;
+	GError *error = NULL;
+	guint status;
+
+	status = _gdata_service_send_message_finish (service, send_result, &error);
+
+	if (data->operation_type == GDATA_OPERATION_DELETION) {
+		if (parse_delete_response (service, data->message, status, &error) == TRUE)
+			g_simple_async_result_set_op_res_gboolean (result, TRUE);
+		else
+			g_simple_async_result_take_error (result, error);
+	} else {
+		GDataEntry *updated_entry;
+
+		updated_entry = parse_entry_response (service, data->operation_type, data->entry, data->message, status, &error);
+		if (updated_entry != NULL)
+			g_simple_async_result_set_op_res_gpointer (result, updated_entry, (GDestroyNotify) g_object_unref);
+		else
+			g_simple_async_result_take_error (result, error);
+	}
+
+	emit_request_completed (service, data->message, data->operation_type, NULL);
+
+	g_simple_async_result_complete (result);
+	modify_entry_async_data_free (data);
+}
+
+/* Sends @message asynchronously, and completes a new GSimpleAsyncResult with @source_tag once a response has been received. Takes ownership of
+ * @message. */
+static void
+modify_entry_async (GDataService *self, GDataOperationType operation_type, GDataEntry *entry, SoupMessage *message, GCancellable *cancellable,
+                    GAsyncReadyCallback callback, gpointer user_data, gpointer source_tag)
+{
+	ModifyEntryAsyncData *data;
+
+	data = g_slice_new (ModifyEntryAsyncData);
+	data->operation_type = operation_type;
+	data->entry = g_object_ref (entry);
+	data->message = message;
+	data->result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, source_tag);
+
+	_gdata_service_send_message_async (self, message, cancellable, (GAsyncReadyCallback) modify_entry_send_cb, data);
+}
+
+/**
+ * gdata_service_insert_entry_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the insertion operation falls under, or %NULL
+ * @upload_uri: the URI to which the upload should be sent
+ * @entry: the #GDataEntry to insert
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when insertion is finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Inserts @entry by uploading it to the online service at @upload_uri. @self, @upload_uri and
+ * @entry are all reffed/copied when this function is called, so can safely be freed after this function returns.
+ *
+ * For more details, see gdata_service_insert_entry(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_insert_entry_finish()
+ * to get the results of the operation.
+ *
+ * Since: 0.9.0
+ **/
+void
+gdata_service_insert_entry_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *upload_uri, GDataEntry *entry,
+                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (upload_uri != NULL);
+	g_return_if_fail (GDATA_IS_ENTRY (entry));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	if (gdata_entry_is_inserted (entry) == TRUE) {
+		g_simple_async_report_error_in_idle (G_OBJECT (self), callback, user_data, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED,
+		                                     "%s", _("The entry has already been inserted."));
+		return;
+	}
+
+	modify_entry_async (self, GDATA_OPERATION_INSERTION, entry, build_insert_message (self, domain, upload_uri, entry), cancellable,
+	                    callback, user_data, gdata_service_insert_entry_async);
+}
+
+/**
+ * gdata_service_insert_entry_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous entry insertion operation started with gdata_service_insert_entry_async().
+ *
+ * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.3.0
+ **/
+GDataEntry *
+gdata_service_insert_entry_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	GDataEntry *entry;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_insert_entry_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	entry = g_simple_async_result_get_op_res_gpointer (result);
+	g_assert (entry != NULL);
+
+	return g_object_ref (entry);
+}
+
+/**
+ * gdata_service_insert_entry:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the insertion operation falls under, or %NULL
+ * @upload_uri: the URI to which the upload should be sent
+ * @entry: the #GDataEntry to insert
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Inserts @entry by uploading it to the online service at @upload_uri. For more information about the concept of inserting entries, see
+ * the <ulink type="http" url="http://code.google.com/apis/gdata/docs/2.0/basics.html#InsertingEntry">online documentation</ulink> for the GData
+ * protocol.
+ *
+ * The service will return an updated version of the entry, which is the return value of this function on success.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled before or during network activity, the error %G_IO_ERROR_CANCELLED will be returned. Cancellation has no effect
+ * after network activity has finished, however, and the insertion will return successfully (or return an error sent by the server) if it is first
+ * cancelled after network activity has finished. See the <link linkend="cancellable-support">overview of cancellation</link> for
+ * more details.
+ *
+ * If the entry is marked as already having been inserted a %GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED error will be returned immediately
+ * (there will be no network requests).
+ *
+ * If there is an error inserting the entry, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned. Currently, subclasses
+ * <emphasis>cannot</emphasis> cannot override this or provide more specific errors.
+ *
+ * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.9.0
+ */
+GDataEntry *
+gdata_service_insert_entry (GDataService *self, GDataAuthorizationDomain *domain, const gchar *upload_uri, GDataEntry *entry,
+                            GCancellable *cancellable, GError **error)
+{
+	GDataEntry *updated_entry;
+	SoupMessage *message;
+	guint status;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (upload_uri != NULL, NULL);
+	g_return_val_if_fail (GDATA_IS_ENTRY (entry), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	if (gdata_entry_is_inserted (entry) == TRUE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED,
+		                     _("The entry has already been inserted."));
+		return NULL;
+	}
+
+	message = build_insert_message (self, domain, upload_uri, entry);
+
+	/* Send the message */
+	status = _gdata_service_send_message (self, message, cancellable, error);
+	updated_entry = parse_entry_response (self, GDATA_OPERATION_INSERTION, entry, message, status, error);
+	emit_request_completed (self, message, GDATA_OPERATION_INSERTION, domain);
+	g_object_unref (message);
+
+	return updated_entry;
+}
+
+/* Builds the request to PUT @entry to its edit URI; shared between gdata_service_update_entry() and gdata_service_update_entry_async(). Partial
+ * entries are PATCHed instead, so that the fields which they don't contain are left alone on the server. */
+static SoupMessage *
+build_update_message (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry)
+{
+	GDataLink *_link;
+	SoupMessage *message;
+	gchar *upload_data;
+	GDataParsableClass *klass;
+	const gchar *method;
+
+	method = (gdata_entry_is_partial (entry) == TRUE) ? "PATCH" : SOUP_METHOD_PUT;
+
+	/* Append the data */
+	klass = GDATA_PARSABLE_GET_CLASS (entry);
+	g_assert (klass->get_content_type != NULL);
+	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
+		/* Get the edit URI */
+		_link = gdata_entry_look_up_link (entry, GDATA_LINK_SELF);
+		g_assert (_link != NULL);
+		message = _gdata_service_build_message (self, domain, method, gdata_link_get_uri (_link), gdata_entry_get_etag (entry), TRUE);
+		upload_data = gdata_parsable_get_json (GDATA_PARSABLE (entry));
+		soup_message_set_request (message, "application/json", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
+	} else {
+		/* Get the edit URI */
+		_link = gdata_entry_look_up_link (entry, GDATA_LINK_EDIT);
+		g_assert (_link != NULL);
+		message = _gdata_service_build_message (self, domain, method, gdata_link_get_uri (_link), gdata_entry_get_etag (entry), TRUE);
+
+		/* If the entry hasn't been modified since it was parsed, just send back what the server sent us */
+		_gdata_service_set_request_xml (message, GDATA_PARSABLE (entry), TRUE);
+		append_minimal_response_header (self, message);
+	}
+
+	return message;
+}
+
+/**
+ * gdata_service_update_entry_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the update operation falls under, or %NULL
+ * @entry: the #GDataEntry to update
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the update is finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Updates @entry by PUTting it to its <literal>edit</literal> link's URI. @self and
+ * @entry are both reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_service_update_entry(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_update_entry_finish()
+ * to get the results of the operation.
+ *
+ * Since: 0.9.0
+ **/
+void
+gdata_service_update_entry_async (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry,
+                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (GDATA_IS_ENTRY (entry));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	modify_entry_async (self, GDATA_OPERATION_UPDATE, entry, build_update_message (self, domain, entry), cancellable,
+	                    callback, user_data, gdata_service_update_entry_async);
+}
+
+/**
+ * gdata_service_update_entry_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous entry update operation started with gdata_service_update_entry_async().
+ *
+ * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.3.0
+ **/
+GDataEntry *
+gdata_service_update_entry_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	GDataEntry *entry;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_update_entry_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	entry = g_simple_async_result_get_op_res_gpointer (result);
+	g_assert (entry != NULL);
+
+	return g_object_ref (entry);
+}
+
+/**
+ * gdata_service_update_entry:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the update operation falls under, or %NULL
+ * @entry: the #GDataEntry to update
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Updates @entry by PUTting it to its <literal>edit</literal> link's URI. For more information about the concept of updating entries, see
+ * the <ulink type="http" url="http://code.google.com/apis/gdata/docs/2.0/basics.html#UpdatingEntry">online documentation</ulink> for the GData
+ * protocol.
+ *
+ * If @entry is partial (see gdata_entry_is_partial()), it's PATCHed instead, and only the fields which were selected when it was queried are
+ * updated on the server.
+ *
+ * The service will return an updated version of the entry, which is the return value of this function on success.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled before or during network activity, the error %G_IO_ERROR_CANCELLED will be returned. Cancellation has no effect
+ * after network activity has finished, however, and the update will return successfully (or return an error sent by the server) if it is first
+ * cancelled after network activity has finished. See the <link linkend="cancellable-support">overview of cancellation</link> for
+ * more details.
+ *
+ * If there is an error updating the entry, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned. Currently, subclasses
+ * <emphasis>cannot</emphasis> cannot override this or provide more specific errors.
+ *
+ * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.9.0
+ **/
+GDataEntry *
+gdata_service_update_entry (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry, GCancellable *cancellable, GError **error)
+{
+	GDataEntry *updated_entry;
+	SoupMessage *message;
+	guint status;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (GDATA_IS_ENTRY (entry), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	message = build_update_message (self, domain, entry);
+
+	/* Send the message */
+	status = _gdata_service_send_message (self, message, cancellable, error);
+	updated_entry = parse_entry_response (self, GDATA_OPERATION_UPDATE, entry, message, status, error);
+	emit_request_completed (self, message, GDATA_OPERATION_UPDATE, domain);
+	g_object_unref (message);
+
+	return updated_entry;
+}
+
+/* Checks whether the @length bytes at @name are one of @fields. */
+static gboolean
+is_dirty_field (const gchar *name, gsize length, const gchar * const *fields)
+{
+	guint i;
+
+	for (i = 0; fields[i] != NULL; i++) {
+		if (strncmp (fields[i], name, length) == 0 && fields[i][length] == '\0')
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Filters @xml, the serialisation of a complete entry, down to the top-level child elements whose qualified names are in @fields, and sets
+ * gd:fields on the root element to @fields_list so that the server only changes those elements. The XML we generate always escapes '<' and '>'
+ * in character data and attribute values, so elements can be delimited without parsing the XML properly. Preserved unhandled XML could contain
+ * comments, CDATA sections or processing instructions, which would break that assumption, so %NULL is returned if any are found. */
+static gchar *
+filter_patch_xml (const gchar *xml, const gchar * const *fields, const gchar *fields_list)
+{
+	GString *output;
+	const gchar *root_end, *attribute, *cursor;
+
+	root_end = strchr (xml, '>');
+	if (root_end == NULL || root_end == xml || root_end[-1] == '/')
+		return NULL;
+
+	output = g_string_sized_new (root_end - xml + 512);
+	g_string_append (output, "<?xml version='1.0' encoding='UTF-8'?>");
+
+	/* Copy the root element's start tag, replacing the gd:fields attribute which a partial entry already has */
+	attribute = g_strstr_len (xml, root_end - xml, " gd:fields='");
+	if (attribute != NULL) {
+		const gchar *attribute_end = strchr (attribute + strlen (" gd:fields='"), '\'');
+
+		g_string_append_len (output, xml, attribute - xml);
+		g_string_append_len (output, attribute_end + 1, root_end - (attribute_end + 1));
+	} else {
+		g_string_append_len (output, xml, root_end - xml);
+	}
+
+	gdata_parser_string_append_escaped (output, " gd:fields='", fields_list, "'>");
+
+	/* Copy the dirty child elements */
+	cursor = root_end + 1;
+	while (TRUE) {
+		const gchar *element;
+		gsize name_length;
+		gint depth = 0;
+
+		element = strchr (cursor, '<');
+		if (element == NULL || element[1] == '!' || element[1] == '?')
+			break;
+
+		if (element[1] == '/') {
+			/* The root element's end tag */
+			g_string_append (output, element);
+			return g_string_free (output, FALSE);
+		}
+
+		name_length = strcspn (element + 1, " \t\r\n/>");
+
+		/* Find the end of the element, keeping track of how deeply nested in it we are */
+		cursor = element;
+		do {
+			const gchar *tag_end;
+
+			cursor = strchr (cursor, '<');
+			if (cursor == NULL || cursor[1] == '!' || cursor[1] == '?')
+				goto error;
+
+			tag_end = strchr (cursor, '>');
+			if (tag_end == NULL)
+				goto error;
+
+			if (cursor[1] == '/')
+				depth--;
+			else if (tag_end[-1] != '/')
+				depth++;
+
+			cursor = tag_end + 1;
+		} while (depth > 0);
+
+		if (is_dirty_field (element + 1, name_length, fields) == TRUE)
+			g_string_append_len (output, element, cursor - element);
+	}
+
+error:
+	g_string_free (output, TRUE);
+
+	return NULL;
+}
+
+/* Builds a JSON object containing only the @fields members of @entry's JSON serialisation. Dirty members which are absent from the serialisation
+ * have been unset, so are sent as null to clear them on the server. */
+static gchar *
+build_patch_json (GDataEntry *entry, const gchar * const *fields)
+{
+	JsonBuilder *builder;
+	JsonGenerator *generator;
+	JsonNode *root, *patch_root;
+	JsonObject *object, *patch;
+	gchar *output;
+	guint i;
+
+	builder = json_builder_new ();
+	_gdata_parsable_get_json (GDATA_PARSABLE (entry), builder);
+	root = json_builder_get_root (builder);
+	g_object_unref (builder);
+
+	object = json_node_get_object (root);
+	patch = json_object_new ();
+
+	for (i = 0; fields[i] != NULL; i++) {
+		JsonNode *member = json_object_get_member (object, fields[i]);
+		json_object_set_member (patch, fields[i], (member != NULL) ? json_node_copy (member) : json_node_new (JSON_NODE_NULL));
+	}
+
+	patch_root = json_node_new (JSON_NODE_OBJECT);
+	json_node_take_object (patch_root, patch);
+
+	generator = json_generator_new ();
+	json_generator_set_root (generator, patch_root);
+	output = json_generator_to_data (generator, NULL);
+	g_object_unref (generator);
+
+	json_node_free (patch_root);
+	json_node_free (root);
+
+	return output;
+}
+
+/* Builds the request to PATCH the given @fields of @entry; the patch is POSTed with an X-HTTP-Method-Override header, which is the form of PATCH
+ * which all GData servers understand. Returns %NULL if the patch can't be built, in which case the entry has to be updated in full instead. */
+static SoupMessage *
+build_patch_message (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry, const gchar * const *fields)
+{
+	GDataLink *_link;
+	SoupMessage *message;
+	gchar *upload_data;
+	const gchar *content_type;
+	GDataParsableClass *klass;
+
+	klass = GDATA_PARSABLE_GET_CLASS (entry);
+	g_assert (klass->get_content_type != NULL);
+	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
+		_link = gdata_entry_look_up_link (entry, GDATA_LINK_SELF);
+		upload_data = build_patch_json (entry, fields);
+		content_type = "application/json";
+	} else {
+		GString *xml_string;
+		gchar *fields_list;
+
+		_link = gdata_entry_look_up_link (entry, GDATA_LINK_EDIT);
+
+		xml_string = g_string_sized_new (1000);
+		_gdata_parsable_get_xml (GDATA_PARSABLE (entry), xml_string, TRUE);
+		fields_list = g_strjoinv (",", (gchar**) fields);
+		upload_data = filter_patch_xml (xml_string->str, fields, fields_list);
+		g_free (fields_list);
+		g_string_free (xml_string, TRUE);
+
+		if (upload_data == NULL)
+			return NULL;
+
+		content_type = "application/atom+xml";
+	}
+
+	g_assert (_link != NULL);
+	message = _gdata_service_build_message (self, domain, SOUP_METHOD_POST, gdata_link_get_uri (_link), gdata_entry_get_etag (entry), TRUE);
+	soup_message_headers_replace (message->request_headers, "X-HTTP-Method-Override", "PATCH");
+	soup_message_set_request (message, content_type, SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
+
+	if (g_strcmp0 (content_type, "application/atom+xml") == 0)
+		append_minimal_response_header (self, message);
+
+	return message;
+}
+
+/* Builds the request to send @entry's local modifications to the server; shared between gdata_service_patch_entry() and
+ * gdata_service_patch_entry_async(). This is a PATCH of the dirty fields where possible, and a full update otherwise. %NULL is returned if the
+ * entry isn't dirty, in which case nothing needs sending. */
+static SoupMessage *
+build_patch_or_update_message (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry)
+{
+	const gchar **fields;
+	SoupMessage *message = NULL;
+
+	fields = _gdata_entry_get_dirty_fields (entry);
+
+	if (fields != NULL && fields[0] == NULL) {
+		g_free (fields);
+		return NULL;
+	} else if (fields != NULL) {
+		message = build_patch_message (self, domain, entry, fields);
+		g_free (fields);
+	}
+
+	if (message == NULL)
+		message = build_update_message (self, domain, entry);
+
+	return message;
+}
+
+/**
+ * gdata_service_patch_entry_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the update operation falls under, or %NULL
+ * @entry: the #GDataEntry to patch
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the update is finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Updates @entry on the server by sending only the fields which have been modified locally. @self and @entry are both reffed when this function is
+ * called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_service_patch_entry(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_patch_entry_finish()
+ * to get the results of the operation.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_patch_entry_async (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry,
+                                 GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	SoupMessage *message;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (GDATA_IS_ENTRY (entry));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	message = build_patch_or_update_message (self, domain, entry);
+
+	if (message == NULL) {
+		GSimpleAsyncResult *result;
+
+		/* Nothing to send */
+		result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_patch_entry_async);
+		g_simple_async_result_set_op_res_gpointer (result, g_object_ref (entry), (GDestroyNotify) g_object_unref);
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+
+		return;
+	}
+
+	modify_entry_async (self, GDATA_OPERATION_UPDATE, entry, message, cancellable, callback, user_data, gdata_service_patch_entry_async);
+}
+
+/**
+ * gdata_service_patch_entry_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous entry patch operation started with gdata_service_patch_entry_async().
+ *
+ * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataEntry *
+gdata_service_patch_entry_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	GDataEntry *entry;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_patch_entry_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	entry = g_simple_async_result_get_op_res_gpointer (result);
+	g_assert (entry != NULL);
+
+	return g_object_ref (entry);
+}
+
+/**
+ * gdata_service_patch_entry:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the update operation falls under, or %NULL
+ * @entry: the #GDataEntry to patch
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Updates @entry on the server by sending only the fields which have been modified locally since it was retrieved (see gdata_entry_is_dirty()),
+ * rather than PUTting the whole entry as gdata_service_update_entry() does. For more information, see the <ulink type="http"
+ * url="https://developers.google.com/gdata/docs/2.0/reference#PartialUpdate">online documentation</ulink> for partial updates in the GData
+ * protocol.
+ *
+ * If some of the modifications can't be expressed as a set of fields (for example, because they're to properties of a subclass of #GDataEntry
+ * which doesn't support patching), the entire entry is updated as with gdata_service_update_entry(). If @entry hasn't been modified at all, no
+ * network activity takes place and a new reference to @entry is returned.
+ *
+ * The service will return an updated version of the entry, which is the return value of this function on success.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled before or during network activity, the error %G_IO_ERROR_CANCELLED will be returned. Cancellation has no effect
+ * after network activity has finished, however, and the update will return successfully (or return an error sent by the server) if it is first
+ * cancelled after network activity has finished. See the <link linkend="cancellable-support">overview of cancellation</link> for
+ * more details.
+ *
+ * If there is an error updating the entry, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned.
+ *
+ * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataEntry *
+gdata_service_patch_entry (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry, GCancellable *cancellable, GError **error)
+{
+	GDataEntry *updated_entry;
+	SoupMessage *message;
+	guint status;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (GDATA_IS_ENTRY (entry), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	message = build_patch_or_update_message (self, domain, entry);
+
+	/* Nothing to send */
+	if (message == NULL)
+		return g_object_ref (entry);
+
+	/* Send the message */
+	status = _gdata_service_send_message (self, message, cancellable, error);
+	updated_entry = parse_entry_response (self, GDATA_OPERATION_UPDATE, entry, message, status, error);
+	emit_request_completed (self, message, GDATA_OPERATION_UPDATE, domain);
+	g_object_unref (message);
+
+	return updated_entry;
+}
+
+/* Builds the request to DELETE @entry; shared between gdata_service_delete_entry() and gdata_service_delete_entry_async(). */
+static SoupMessage *
+build_delete_message (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry)
+{
+	GDataLink *_link;
+	SoupMessage *message;
+	gchar *fixed_uri;
+	GDataParsableClass *klass;
+
+	/* Get the edit URI. We have to fix it to always use HTTPS as YouTube videos appear to incorrectly return a HTTP URI as their edit URI. */
+	klass = GDATA_PARSABLE_GET_CLASS (entry);
+	g_assert (klass->get_content_type != NULL);
+	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
+		_link = gdata_entry_look_up_link (entry, GDATA_LINK_SELF);
+	} else {
+		_link = gdata_entry_look_up_link (entry, GDATA_LINK_EDIT);
+	}
+	g_assert (_link != NULL);
+
+	fixed_uri = _gdata_service_fix_uri_scheme (gdata_link_get_uri (_link));
+	message = _gdata_service_build_message (self, domain, SOUP_METHOD_DELETE, fixed_uri, gdata_entry_get_etag (entry), TRUE);
+	g_free (fixed_uri);
+
+	return message;
+}
+
+/**
+ * gdata_service_delete_entry_async:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the deletion falls under, or %NULL
+ * @entry: the #GDataEntry to delete
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when deletion is finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Deletes @entry from the server. @self and @entry are both reffed when this function is called,
+ * so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_service_delete_entry(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_delete_entry_finish()
+ * to get the results of the operation.
+ *
+ * Since: 0.9.0
+ **/
+void
+gdata_service_delete_entry_async (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry,
+                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (GDATA_IS_ENTRY (entry));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	modify_entry_async (self, GDATA_OPERATION_DELETION, entry, build_delete_message (self, domain, entry), cancellable,
+	                    callback, user_data, gdata_service_delete_entry_async);
+}
+
+/**
+ * gdata_service_delete_entry_finish:
+ * @self: a #GDataService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous entry deletion operation started with gdata_service_delete_entry_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.3.0
+ **/
+gboolean
+gdata_service_delete_entry_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_delete_entry_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	return g_simple_async_result_get_op_res_gboolean (result);
+}
+
+/**
+ * gdata_service_delete_entry:
+ * @self: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain the deletion falls under, or %NULL
+ * @entry: the #GDataEntry to delete
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Deletes @entry from the server. For more information about the concept of deleting entries, see the
+ * <ulink type="http" url="http://code.google.com/apis/gdata/docs/2.0/basics.html#DeletingEntry">online documentation</ulink> for the GData
+ * protocol.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled before or during network activity, the error %G_IO_ERROR_CANCELLED will be returned. Cancellation has no effect
+ * after network activity has finished, however, and the deletion will return successfully (or return an error sent by the server) if it is first
+ * cancelled after network activity has finished. See the <link linkend="cancellable-support">overview of cancellation</link> for
+ * more details.
+ *
+ * If there is an error deleting the entry, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned. Currently, subclasses
+ * <emphasis>cannot</emphasis> cannot override this or provide more specific errors.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.9.0
+ **/
+gboolean
+gdata_service_delete_entry (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry, GCancellable *cancellable, GError **error)
+{
+	SoupMessage *message;
+	guint status;
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), FALSE);
+	g_return_val_if_fail (GDATA_IS_ENTRY (entry), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	message = build_delete_message (self, domain, entry);
+
+	/* Send the message */
+	status = _gdata_service_send_message (self, message, cancellable, error);
+	success = parse_delete_response (self, message, status, error);
+	emit_request_completed (self, message, GDATA_OPERATION_DELETION, domain);
+	g_object_unref (message);
+
+	return success;
+}
+
+static void
+notify_proxy_uri_cb (GObject *gobject, GParamSpec *pspec, GObject *self)
+{
+	g_object_notify (self, "proxy-uri");
+}
+
+/* Static function which isn't deprecated so we can continue using it internally. */
+static SoupURI *
+_get_proxy_uri (GDataService *self)
+{
+	SoupURI *proxy_uri;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+
+	g_object_get (self->priv->session, SOUP_SESSION_PROXY_URI, &proxy_uri, NULL);
+	g_object_unref (proxy_uri); /* remove the ref added by g_object_get */
+
+	return proxy_uri;
+}
+
+/**
+ * gdata_service_get_proxy_uri:
+ * @self: a #GDataService
+ *
+ * Gets the proxy URI on the #GDataService's #SoupSession.
+ *
+ * Return value: (transfer none): the proxy URI, or %NULL
+ *
+ * Since: 0.2.0
+ * Deprecated: Use gdata_service_get_proxy_resolver() instead, which gives more flexibility over the proxy used. (Since: 0.15.0.)
+ **/
+SoupURI *
+gdata_service_get_proxy_uri (GDataService *self)
+{
+	return _get_proxy_uri (self);
+}
+
+/* Static function which isn't deprecated so we can continue using it internally. */
+static void
+_set_proxy_uri (GDataService *self, SoupURI *proxy_uri)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_object_set (self->priv->session, SOUP_SESSION_PROXY_URI, proxy_uri, NULL);
+	g_object_notify (G_OBJECT (self), "proxy-uri");
+}
 
-	g_slice_free (QueryAsyncData, self);
+/**
+ * gdata_service_set_proxy_uri:
+ * @self: a #GDataService
+ * @proxy_uri: (allow-none): the proxy URI, or %NULL
+ *
+ * Sets the proxy URI on the #SoupSession used internally by the given #GDataService.
+ * This forces all requests through the given proxy.
+ *
+ * If @proxy_uri is %NULL, no proxy will be used.
+ *
+ * Note that if a #GDataAuthorizer is being used with this #GDataService, the authorizer might also need its proxy URI setting.
+ *
+ * Since: 0.2.0
+ * Deprecated: Use gdata_service_set_proxy_resolver() instead, which gives more flexibility over the proxy used. (Since: 0.15.0.)
+ **/
+void
+gdata_service_set_proxy_uri (GDataService *self, SoupURI *proxy_uri)
+{
+	_set_proxy_uri (self, proxy_uri);
 }
 
-static void
-query_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+/**
+ * gdata_service_get_proxy_resolver:
+ * @self: a #GDataService
+ *
+ * Gets the #GProxyResolver on the #GDataService's #SoupSession.
+ *
+ * Return value: (transfer none) (allow-none): a #GProxyResolver, or %NULL
+ *
+ * Since: 0.15.0
+ */
+GProxyResolver *
+gdata_service_get_proxy_resolver (GDataService *self)
 {
-	GError *error = NULL;
-	QueryAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GProxyResolver *proxy_resolver;
 
-	/* Execute the query and return */
-	data->feed = __gdata_service_query (service, data->domain, data->feed_uri, data->query, data->entry_type, cancellable,
-	                                    data->progress_callback, data->progress_user_data, &error, TRUE);
-	if (data->feed == NULL && error != NULL) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-	}
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
 
-	if (data->destroy_progress_user_data != NULL) {
-		data->destroy_progress_user_data (data->progress_user_data);
-	}
+	g_mutex_lock (&(self->priv->config_mutex));
+	proxy_resolver = self->priv->proxy_resolver;
+	g_mutex_unlock (&(self->priv->config_mutex));
+
+	return proxy_resolver;
 }
 
 /**
- * gdata_service_query_async:
+ * gdata_service_set_proxy_resolver:
  * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
- * @feed_uri: the feed URI to query, including the host name and protocol
- * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
- * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
- * @cancellable: (allow-none): optional #GCancellable object, or %NULL
- * @progress_callback: (allow-none) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
- * @progress_user_data: (closure): data to pass to the @progress_callback function
- * @destroy_progress_user_data: (allow-none): the function to call when @progress_callback will not be called any more, or %NULL. This function will be
- * called with @progress_user_data as a parameter and can be used to free any memory allocated for it.
- * @callback: a #GAsyncReadyCallback to call when the query is finished
- * @user_data: (closure): data to pass to the @callback function
- *
- * Queries the service's @feed_uri feed to build a #GDataFeed. @self, @feed_uri and
- * @query are all reffed/copied when this function is called, so can safely be freed after this function returns.
+ * @proxy_resolver: (allow-none): a #GProxyResolver, or %NULL
  *
- * For more details, see gdata_service_query(), which is the synchronous version of this function.
+ * Sets the #GProxyResolver on the #SoupSession used internally by the given #GDataService.
  *
- * When the operation is finished, @callback will be called. You can then call gdata_service_query_finish()
- * to get the results of the operation.
+ * Setting this will clear the #GDataService:proxy-uri property.
  *
- * Since: 0.9.1
- **/
+ * Since: 0.15.0
+ */
 void
-gdata_service_query_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
-                           GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
-                           GDestroyNotify destroy_progress_user_data, GAsyncReadyCallback callback, gpointer user_data)
+gdata_service_set_proxy_resolver (GDataService *self, GProxyResolver *proxy_resolver)
 {
-	GSimpleAsyncResult *result;
-	QueryAsyncData *data;
+	GProxyResolver *old_proxy_resolver;
 
 	g_return_if_fail (GDATA_IS_SERVICE (self));
-	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
-	g_return_if_fail (feed_uri != NULL);
-	g_return_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY));
-	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
-	g_return_if_fail (callback != NULL);
+	g_return_if_fail (proxy_resolver == NULL || G_IS_PROXY_RESOLVER (proxy_resolver));
 
-	data = g_slice_new (QueryAsyncData);
-	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
-	data->feed_uri = g_strdup (feed_uri);
-	data->query = (query != NULL) ? g_object_ref (query) : NULL;
-	data->entry_type = entry_type;
-	data->feed = NULL;
-	data->progress_callback = progress_callback;
-	data->progress_user_data = progress_user_data;
-	data->destroy_progress_user_data = destroy_progress_user_data;
+	if (proxy_resolver != NULL) {
+		g_object_ref (proxy_resolver);
+	}
 
-	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_async);
-	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_async_data_free);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_thread, G_PRIORITY_DEFAULT, cancellable);
-	g_object_unref (result);
+	g_mutex_lock (&(self->priv->config_mutex));
+	old_proxy_resolver = self->priv->proxy_resolver;
+	self->priv->proxy_resolver = proxy_resolver;
+	g_mutex_unlock (&(self->priv->config_mutex));
+
+	g_clear_object (&old_proxy_resolver);
+
+	g_object_notify (G_OBJECT (self), "proxy-resolver");
+}
+
+static void
+notify_timeout_cb (GObject *gobject, GParamSpec *pspec, GObject *self)
+{
+	g_object_notify (self, "timeout");
 }
 
 /**
- * gdata_service_query_finish:
+ * gdata_service_get_timeout:
  * @self: a #GDataService
- * @async_result: a #GAsyncResult
- * @error: a #GError, or %NULL
  *
- * Finishes an asynchronous query operation started with gdata_service_query_async().
+ * Gets the #GDataService:timeout property; the network timeout, in seconds.
  *
- * Return value: (transfer full): a #GDataFeed of query results, or %NULL; unref with g_object_unref()
+ * Return value: the timeout, or <code class="literal">0</code>
+ *
+ * Since: 0.7.0
  **/
-GDataFeed *
-gdata_service_query_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+guint
+gdata_service_get_timeout (GDataService *self)
 {
-	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
-	QueryAsyncData *data;
+	guint timeout;
 
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
 
-	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_query_async);
+	g_object_get (self->priv->session, SOUP_SESSION_TIMEOUT, &timeout, NULL);
 
-	if (g_simple_async_result_propagate_error (result, error) == TRUE)
-		return NULL;
+	return timeout;
+}
 
-	data = g_simple_async_result_get_op_res_gpointer (result);
-	if (data->feed != NULL)
-		return g_object_ref (data->feed);
-	return NULL;
+/**
+ * gdata_service_set_timeout:
+ * @self: a #GDataService
+ * @timeout: the timeout, or <code class="literal">0</code>
+ *
+ * Sets the #GDataService:timeout property; the network timeout, in seconds.
+ *
+ * If @timeout is <code class="literal">0</code>, network operations will never time out.
+ *
+ * Note that if a #GDataAuthorizer is being used with this #GDataService, the authorizer might also need its timeout setting.
+ *
+ * The timeout applies to each network operation individually; to limit the total time taken by a method call, give its #GCancellable a deadline
+ * using gdata_cancellable_set_deadline().
+ *
+ * Since: 0.7.0
+ **/
+void
+gdata_service_set_timeout (GDataService *self, guint timeout)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_object_set (self->priv->session, SOUP_SESSION_TIMEOUT, timeout, NULL);
+	g_object_notify (G_OBJECT (self), "timeout");
 }
 
-/* Does the bulk of the work of gdata_service_query. Split out because certain queries (such as that done by
- * gdata_service_query_single_entry()) only return a single entry, and thus need special parsing code. */
-SoupMessage *
-_gdata_service_query (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query,
-                      GCancellable *cancellable, GError **error)
+static void
+notify_max_conns_cb (GObject *gobject, GParamSpec *pspec, GObject *self)
 {
-	SoupMessage *message;
-	guint status;
-	const gchar *etag = NULL;
+	g_object_notify (self, "max-connections");
+}
 
-	/* Append the ETag header if possible */
-	if (query != NULL)
-		etag = gdata_query_get_etag (query);
+/**
+ * gdata_service_get_max_connections:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:max-connections property; the maximum number of simultaneous connections across all hosts.
+ *
+ * Return value: the maximum number of connections
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_max_connections (GDataService *self)
+{
+	gint max_conns;
 
-	/* Build the message */
-	if (query != NULL) {
-		gchar *query_uri = gdata_query_get_query_uri (query, feed_uri);
-		message = _gdata_service_build_message (self, domain, SOUP_METHOD_GET, query_uri, etag, FALSE);
-		g_free (query_uri);
-	} else {
-		message = _gdata_service_build_message (self, domain, SOUP_METHOD_GET, feed_uri, etag, FALSE);
-	}
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
 
-	/* Note that cancellation only applies to network activity; not to the processing done afterwards */
-	status = _gdata_service_send_message (self, message, cancellable, error);
+	g_object_get (self->priv->session, SOUP_SESSION_MAX_CONNS, &max_conns, NULL);
 
-	if (status == SOUP_STATUS_NOT_MODIFIED || status == SOUP_STATUS_CANCELLED) {
-		/* Not modified (ETag has worked), or cancelled (in which case the error has been set) */
-		g_object_unref (message);
-		return NULL;
-	} else if (status != SOUP_STATUS_OK) {
-		/* Error */
-		GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (self);
-		g_assert (klass->parse_error_response != NULL);
-		klass->parse_error_response (self, GDATA_OPERATION_QUERY, status, message->reason_phrase, message->response_body->data,
-		                             message->response_body->length, error);
-		g_object_unref (message);
-		return NULL;
-	}
+	return max_conns;
+}
 
-	return message;
+/**
+ * gdata_service_set_max_connections:
+ * @self: a #GDataService
+ * @max_connections: the maximum number of connections; must be greater than <code class="literal">0</code>
+ *
+ * Sets the #GDataService:max-connections property; the maximum number of simultaneous connections across all hosts.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_max_connections (GDataService *self, guint max_connections)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (max_connections > 0 && max_connections <= G_MAXINT);
+
+	g_object_set (self->priv->session, SOUP_SESSION_MAX_CONNS, (gint) max_connections, NULL);
 }
 
-static GDataFeed *
-__gdata_service_query (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
-                       GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error,
-                       gboolean is_async)
+/* Limits the number of normal and background requests in flight so that #GDataService:reserved-connections connections are kept free */
+static void
+update_request_scheduler (GDataService *self)
 {
-	GDataServiceClass *klass;
-	GDataFeed *feed = NULL;
-	SoupMessage *message;
-	SoupMessageHeaders *headers;
-	const gchar *content_type;
+	guint reserved_connections, max_connections_per_host, max_active = 0;
 
-	message = _gdata_service_query (self, domain, feed_uri, query, cancellable, error);
-	if (message == NULL)
-		return NULL;
+	reserved_connections = gdata_service_get_reserved_connections (self);
+	max_connections_per_host = gdata_service_get_max_connections_per_host (self);
 
-	g_assert (message->response_body->data != NULL);
-	klass = GDATA_SERVICE_GET_CLASS (self);
+	if (reserved_connections > 0)
+		max_active = (reserved_connections < max_connections_per_host) ? max_connections_per_host - reserved_connections : 1;
 
-	headers = message->response_headers;
-	content_type = soup_message_headers_get_content_type (headers, NULL);
+	gdata_request_scheduler_set_max_active (self->priv->request_scheduler, max_active);
+}
 
-	if (content_type != NULL && strcmp (content_type, "application/json") == 0) {
-		/* Definitely JSON. */
-		g_debug("JSON content type detected.");
-		feed = _gdata_feed_new_from_json (klass->feed_type, message->response_body->data, message->response_body->length, entry_type,
-		                                  progress_callback, progress_user_data, is_async, error);
-	} else {
-		/* Potentially XML. Don't bother checking the Content-Type, since the parser
-		 * will fail gracefully if the response body is not valid XML. */
-		g_debug("XML content type detected.");
-		feed = _gdata_feed_new_from_xml (klass->feed_type, message->response_body->data, message->response_body->length, entry_type,
-		                                 progress_callback, progress_user_data, is_async, error);
-	}
+static void
+notify_max_conns_per_host_cb (GObject *gobject, GParamSpec *pspec, GObject *self)
+{
+	update_request_scheduler (GDATA_SERVICE (self));
+	g_object_notify (self, "max-connections-per-host");
+}
 
-	g_object_unref (message);
+/**
+ * gdata_service_get_max_connections_per_host:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:max-connections-per-host property; the maximum number of simultaneous connections to a single host.
+ *
+ * Return value: the maximum number of connections per host
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_max_connections_per_host (GDataService *self)
+{
+	gint max_conns_per_host;
 
-	if (feed == NULL)
-		return NULL;
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
 
-	/* Update the query with the feed's ETag */
-	if (query != NULL && feed != NULL && gdata_feed_get_etag (feed) != NULL)
-		gdata_query_set_etag (query, gdata_feed_get_etag (feed));
+	g_object_get (self->priv->session, SOUP_SESSION_MAX_CONNS_PER_HOST, &max_conns_per_host, NULL);
 
-	/* Update the query with the next and previous URIs from the feed */
-	if (query != NULL && feed != NULL) {
-		GDataLink *_link;
+	return max_conns_per_host;
+}
 
-		_link = gdata_feed_look_up_link (feed, "next");
-		if (_link != NULL)
-			_gdata_query_set_next_uri (query, gdata_link_get_uri (_link));
-		_link = gdata_feed_look_up_link (feed, "previous");
-		if (_link != NULL)
-			_gdata_query_set_previous_uri (query, gdata_link_get_uri (_link));
-	}
+/**
+ * gdata_service_set_max_connections_per_host:
+ * @self: a #GDataService
+ * @max_connections_per_host: the maximum number of connections per host; must be greater than <code class="literal">0</code>
+ *
+ * Sets the #GDataService:max-connections-per-host property; the maximum number of simultaneous connections to a single host.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_max_connections_per_host (GDataService *self, guint max_connections_per_host)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (max_connections_per_host > 0 && max_connections_per_host <= G_MAXINT);
 
-	return feed;
+	g_object_set (self->priv->session, SOUP_SESSION_MAX_CONNS_PER_HOST, (gint) max_connections_per_host, NULL);
 }
 
 /**
- * gdata_service_query:
+ * gdata_service_get_reserved_connections:
  * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
- * @feed_uri: the feed URI to query, including the host name and protocol
- * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
- * @entry_type: a #GType for the #GDataEntry<!-- -->s to build from the XML
- * @cancellable: (allow-none): optional #GCancellable object, or %NULL
- * @progress_callback: (allow-none) (scope call) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
- * @progress_user_data: (closure): data to pass to the @progress_callback function
- * @error: a #GError, or %NULL
  *
- * Queries the service's @feed_uri feed to build a #GDataFeed.
+ * Gets the #GDataService:reserved-connections property.
  *
- * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
- * If the operation was cancelled before or during network activity, the error %G_IO_ERROR_CANCELLED will be returned. Cancellation has no effect
- * after network activity has finished, however, and the query will return successfully (or return an error sent by the server) if it is first
- * cancelled after network activity has finished. See the <link linkend="cancellable-support">overview of cancellation</link> for
- * more details.
+ * Return value: the number of connections kept free for interactive requests
  *
- * A %GDATA_SERVICE_ERROR_PROTOCOL_ERROR will be returned if the server indicates there is a problem with the query, but subclasses may override
- * this and return their own errors. See their documentation for more details.
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_reserved_connections (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	return (guint) g_atomic_int_get (&(self->priv->reserved_connections));
+}
+
+/**
+ * gdata_service_set_reserved_connections:
+ * @self: a #GDataService
+ * @reserved_connections: the number of connections to keep free for interactive requests, or <code class="literal">0</code>
  *
- * For each entry in the response feed, @progress_callback will be called in the main thread. If there was an error parsing the XML response,
- * a #GDataParserError will be returned.
+ * Sets the #GDataService:reserved-connections property. Requests which are already in flight are unaffected.
  *
- * If the query is successful and the feed supports pagination, @query will be updated with the pagination URIs, and the next or previous page
- * can then be loaded by calling gdata_query_next_page() or gdata_query_previous_page() before running the query again.
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_reserved_connections (GDataService *self, guint reserved_connections)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (reserved_connections <= G_MAXINT);
+
+	g_atomic_int_set (&(self->priv->reserved_connections), (gint) reserved_connections);
+	update_request_scheduler (self);
+	g_object_notify (G_OBJECT (self), "reserved-connections");
+}
+
+static void
+notify_idle_timeout_cb (GObject *gobject, GParamSpec *pspec, GObject *self)
+{
+	g_object_notify (self, "idle-timeout");
+}
+
+/**
+ * gdata_service_get_idle_timeout:
+ * @self: a #GDataService
  *
- * If the #GDataQuery's ETag is set and it finds a match on the server, %NULL will be returned, but @error will remain unset. Otherwise,
- * @query's ETag will be updated with the ETag from the returned feed, if available.
+ * Gets the #GDataService:idle-timeout property; the time, in seconds, after which idle persistent connections are closed.
  *
- * Return value: (transfer full): a #GDataFeed of query results, or %NULL; unref with g_object_unref()
+ * Return value: the idle timeout, or <code class="literal">0</code>
  *
- * Since: 0.9.0
+ * Since: 0.15.0
  **/
-GDataFeed *
-gdata_service_query (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
-                     GCancellable *cancellable, GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error)
+guint
+gdata_service_get_idle_timeout (GDataService *self)
 {
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
-	g_return_val_if_fail (feed_uri != NULL, NULL);
-	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	guint idle_timeout;
 
-	return __gdata_service_query (self, domain, feed_uri, query, entry_type, cancellable, progress_callback, progress_user_data, error, FALSE);
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+
+	g_object_get (self->priv->session, SOUP_SESSION_IDLE_TIMEOUT, &idle_timeout, NULL);
+
+	return idle_timeout;
 }
 
 /**
- * gdata_service_query_single_entry:
+ * gdata_service_set_idle_timeout:
  * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
- * @entry_id: the entry ID of the desired entry
- * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
- * @entry_type: a #GType for the #GDataEntry to build from the XML
- * @cancellable: (allow-none): a #GCancellable, or %NULL
- * @error: a #GError, or %NULL
- *
- * Retrieves information about the single entry with the given @entry_id. @entry_id should be as returned by
- * gdata_entry_get_id().
+ * @idle_timeout: the idle timeout, or <code class="literal">0</code>
  *
- * Parameters and errors are as for gdata_service_query(). Most of the properties of @query aren't relevant, and
- * will cause a server-side error if used. The most useful property to use is #GDataQuery:etag, which will cause the
- * server to not return anything if the entry hasn't been modified since it was given the specified ETag; thus saving
- * bandwidth. If the server does not return anything for this reason, gdata_service_query_single_entry() will return
- * %NULL, but will not set an error in @error.
+ * Sets the #GDataService:idle-timeout property; the time, in seconds, after which idle persistent connections are closed.
  *
- * Return value: (transfer full): a #GDataEntry, or %NULL; unref with g_object_unref()
+ * If @idle_timeout is <code class="literal">0</code>, idle connections will be kept open until the server closes them.
  *
- * Since: 0.9.0
+ * Since: 0.15.0
  **/
-GDataEntry *
-gdata_service_query_single_entry (GDataService *self, GDataAuthorizationDomain *domain, const gchar *entry_id, GDataQuery *query, GType entry_type,
-                                  GCancellable *cancellable, GError **error)
+void
+gdata_service_set_idle_timeout (GDataService *self, guint idle_timeout)
 {
-	GDataEntryClass *klass;
-	GDataEntry *entry;
-	gchar *entry_uri;
-	SoupMessage *message;
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_object_set (self->priv->session, SOUP_SESSION_IDLE_TIMEOUT, idle_timeout, NULL);
+}
 
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
-	g_return_val_if_fail (entry_id != NULL, NULL);
-	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), NULL);
-	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE, NULL);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+/* Counts the time since @timer's message was (re-)queued towards its queue time, if that hasn't already been done for this attempt. This is called
+ * when the message either starts setting up a new connection or is about to be sent on an existing one. */
+static void
+request_timer_count_queue_time (RequestTimer *timer, gint64 now)
+{
+	if (timer->queue_time_counted == FALSE) {
+		timer->record.queue_time += now - timer->queued;
+		timer->queue_time_counted = TRUE;
+	}
+}
 
-	/* Query for just the specified entry */
-	klass = GDATA_ENTRY_CLASS (g_type_class_ref (entry_type));
-	g_assert (klass->get_entry_uri != NULL);
+/* The state of a message counted in the service's gauges, from when it's queued in the session until it's unqueued. See request_queued_cb(). */
+typedef struct {
+	volatile gint *domain_requests_in_flight; /* owned by the service's domain_requests_in_flight table; NULL if the message has no domain */
+	gboolean waiting_for_connection; /* whether it's counted in connection_queue_length */
+} RequestGauge;
 
-	entry_uri = klass->get_entry_uri (entry_id);
-	message = _gdata_service_query (GDATA_SERVICE (self), domain, entry_uri, query, cancellable, error);
-	g_free (entry_uri);
+/* Key for a message's RequestGauge */
+#define REQUEST_GAUGE_KEY "gdata-service-request-gauge"
 
-	if (message == NULL) {
-		g_type_class_unref (klass);
-		return NULL;
+static void
+request_gauge_free (RequestGauge *gauge)
+{
+	g_slice_free (RequestGauge, gauge);
+}
+
+/* Returns the counter of requests in flight under @domain, creating it if this is the first request under @domain */
+static volatile gint *
+get_domain_requests_in_flight (GDataService *self, GDataAuthorizationDomain *domain)
+{
+	gint *counter;
+
+	g_mutex_lock (&(self->priv->gauges_mutex));
+
+	counter = g_hash_table_lookup (self->priv->domain_requests_in_flight, domain);
+	if (counter == NULL) {
+		counter = g_new0 (gint, 1);
+		g_hash_table_insert (self->priv->domain_requests_in_flight, g_object_ref (domain), counter);
 	}
 
-	g_assert (message->response_body->data != NULL);
-	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (entry_type, message->response_body->data, message->response_body->length, error));
-	g_object_unref (message);
-	g_type_class_unref (klass);
+	g_mutex_unlock (&(self->priv->gauges_mutex));
 
-	return entry;
+	return counter;
 }
 
-typedef struct {
-	GDataAuthorizationDomain *domain;
-	gchar *entry_id;
-	GDataQuery *query;
-	GType entry_type;
-} QuerySingleEntryAsyncData;
+/* Stops counting @message as waiting for a connection, once it either starts setting up a new connection or is about to be sent on an existing one */
+static void
+request_gauge_stop_waiting (GDataService *self, SoupMessage *message)
+{
+	RequestGauge *gauge = g_object_get_data (G_OBJECT (message), REQUEST_GAUGE_KEY);
+
+	if (gauge != NULL && gauge->waiting_for_connection == TRUE) {
+		gauge->waiting_for_connection = FALSE;
+		g_atomic_int_add (&self->priv->connection_queue_length, -1);
+	}
+}
 
 static void
-query_single_entry_async_data_free (QuerySingleEntryAsyncData *data)
+message_network_event_cb (SoupMessage *message, GSocketClientEvent event, GIOStream *connection, GDataService *self)
 {
-	if (data->domain != NULL)
-		g_object_unref (data->domain);
+	RequestTimer *timer = g_object_get_data (G_OBJECT (message), REQUEST_TIMER_KEY);
+	gint64 now = g_get_monotonic_time ();
 
-	g_free (data->entry_id);
-	if (data->query != NULL)
-		g_object_unref (data->query);
-	g_slice_free (QuerySingleEntryAsyncData, data);
+	/* These events are only emitted when a new connection is being set up, not when one is being reused */
+	switch (event) {
+		case G_SOCKET_CLIENT_RESOLVING:
+			request_gauge_stop_waiting (self, message);
+
+			if (timer != NULL) {
+				request_timer_count_queue_time (timer, now);
+				timer->resolving = now;
+			}
+			break;
+		case G_SOCKET_CLIENT_RESOLVED:
+			if (timer != NULL && timer->resolving > 0)
+				timer->record.dns_time += now - timer->resolving;
+			break;
+		case G_SOCKET_CLIENT_CONNECTING:
+			request_gauge_stop_waiting (self, message);
+
+			if (timer != NULL) {
+				request_timer_count_queue_time (timer, now);
+				timer->connecting = now;
+			}
+			break;
+		case G_SOCKET_CLIENT_CONNECTED:
+			g_atomic_int_inc (&self->priv->connections_opened);
+
+			if (timer != NULL && timer->connecting > 0)
+				timer->record.connect_time += now - timer->connecting;
+			break;
+		case G_SOCKET_CLIENT_TLS_HANDSHAKING:
+			if (timer != NULL)
+				timer->tls_handshaking = now;
+			break;
+		case G_SOCKET_CLIENT_TLS_HANDSHAKED:
+			g_atomic_int_inc (&self->priv->tls_handshakes);
+
+			if (timer != NULL && timer->tls_handshaking > 0)
+				timer->record.tls_time += now - timer->tls_handshaking;
+			break;
+		default:
+			/* Don't care */
+			break;
+	}
 }
 
 static void
-query_single_entry_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+message_starting_cb (SoupMessage *message, GDataService *self)
 {
-	GDataEntry *entry;
-	GError *error = NULL;
-	QuerySingleEntryAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	RequestTimer *timer = g_object_get_data (G_OBJECT (message), REQUEST_TIMER_KEY);
 
-	/* Execute the query and return */
-	entry = gdata_service_query_single_entry (service, data->domain, data->entry_id, data->query, data->entry_type, cancellable, &error);
-	if (entry == NULL && error != NULL) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
+	request_gauge_stop_waiting (self, message);
+
+	if (timer != NULL)
+		request_timer_count_queue_time (timer, g_get_monotonic_time ());
+}
+
+static void
+message_wrote_body_cb (SoupMessage *message, GDataService *self)
+{
+	RequestTimer *timer = g_object_get_data (G_OBJECT (message), REQUEST_TIMER_KEY);
+
+	if (timer != NULL)
+		timer->wrote_body = g_get_monotonic_time ();
+}
+
+/* Key for the number of (decoded) bytes of the current response body received so far by a message, stored as a guint64 */
+#define RESPONSE_BYTES_KEY "gdata-service-response-bytes"
+
+static void
+message_got_headers_cb (SoupMessage *message, GDataService *self)
+{
+	RequestTimer *timer = g_object_get_data (G_OBJECT (message), REQUEST_TIMER_KEY);
+
+	/* The message may be re-sent (for example, after a redirect), so start counting afresh for each response */
+	g_object_set_data_full (G_OBJECT (message), RESPONSE_BYTES_KEY, g_new0 (guint64, 1), g_free);
+
+	if (timer != NULL) {
+		timer->got_headers = g_get_monotonic_time ();
+		if (timer->wrote_body > 0)
+			timer->record.time_to_first_byte += timer->got_headers - timer->wrote_body;
+	}
+}
+
+static void
+message_got_chunk_cb (SoupMessage *message, SoupBuffer *buffer, GDataService *self)
+{
+	guint64 *response_bytes = g_object_get_data (G_OBJECT (message), RESPONSE_BYTES_KEY);
+	RequestTimer *timer = g_object_get_data (G_OBJECT (message), REQUEST_TIMER_KEY);
+
+	/* This is emitted after any content decoding, so counts the uncompressed size of the body */
+	if (response_bytes != NULL)
+		*response_bytes += buffer->length;
+	if (timer != NULL)
+		timer->record.bytes_in += buffer->length;
+}
+
+static void
+message_got_body_cb (SoupMessage *message, GDataService *self)
+{
+	GDataServicePrivate *priv = self->priv;
+	guint64 *response_bytes, received;
+	const gchar *content_encoding;
+	RequestTimer *timer;
+
+	timer = g_object_get_data (G_OBJECT (message), REQUEST_TIMER_KEY);
+	if (timer != NULL) {
+		timer->got_body = g_get_monotonic_time ();
+		if (timer->got_headers > 0)
+			timer->record.transfer_time += timer->got_body - timer->got_headers;
+	}
+
+	response_bytes = g_object_get_data (G_OBJECT (message), RESPONSE_BYTES_KEY);
+	if (response_bytes == NULL)
+		return;
+
+	/* Work out how many bytes of the body actually came over the wire. If it wasn't encoded, that's the same as the number of bytes decoded;
+	 * if it was, it's only known if the server gave a Content-Length, as libsoup doesn't expose the size of the encoded chunks. Responses whose
+	 * encoded size isn't known are left out of the statistics entirely, so that the ratio between the two counters stays meaningful. */
+	content_encoding = soup_message_headers_get_one (message->response_headers, "Content-Encoding");
+
+	if (content_encoding == NULL || g_ascii_strcasecmp (content_encoding, "identity") == 0) {
+		received = *response_bytes;
+	} else if (soup_message_headers_get_encoding (message->response_headers) == SOUP_ENCODING_CONTENT_LENGTH) {
+		received = soup_message_headers_get_content_length (message->response_headers);
+	} else {
 		return;
 	}
 
-	g_simple_async_result_set_op_res_gpointer (result, entry, (GDestroyNotify) g_object_unref);
+	g_mutex_lock (&(priv->transfer_statistics_mutex));
+	priv->bytes_received += received;
+	priv->bytes_decoded += *response_bytes;
+	g_mutex_unlock (&(priv->transfer_statistics_mutex));
+
+	*response_bytes = 0;
 }
 
-/**
- * gdata_service_query_single_entry_async:
- * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the query falls under, or %NULL
- * @entry_id: the entry ID of the desired entry
- * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
- * @entry_type: a #GType for the #GDataEntry to build from the XML
- * @cancellable: (allow-none): optional #GCancellable object, or %NULL
- * @callback: a #GAsyncReadyCallback to call when the query is finished
- * @user_data: (closure): data to pass to the @callback function
- *
- * Retrieves information about the single entry with the given @entry_id. @entry_id should be as returned by
- * gdata_entry_get_id(). @self, @query and @entry_id are reffed/copied when this
- * function is called, so can safely be freed after this function returns.
+static void
+request_queued_cb (SoupSession *session, SoupMessage *message, GDataService *self)
+{
+	RequestTimer *timer;
+	RequestGauge *gauge;
+	GDataAuthorizationDomain *domain;
+
+	/* Ignore messages sent by other services sharing our session */
+	if (g_object_get_data (G_OBJECT (message), MESSAGE_SERVICE_KEY) != self)
+		return;
+
+	g_atomic_int_inc (&self->priv->requests_sent);
+
+	/* Count the request as in flight and waiting for a connection until it's unqueued. The domain counter is kept with the message, so that the
+	 * same one is decremented even if the message's domain changes. */
+	domain = g_object_get_data (G_OBJECT (message), "gdata-authorization-domain");
+
+	gauge = g_slice_new (RequestGauge);
+	gauge->domain_requests_in_flight = (domain != NULL) ? get_domain_requests_in_flight (self, domain) : NULL;
+	gauge->waiting_for_connection = TRUE;
+	g_object_set_data_full (G_OBJECT (message), REQUEST_GAUGE_KEY, gauge, (GDestroyNotify) request_gauge_free);
+
+	g_atomic_int_inc (&self->priv->requests_in_flight);
+	g_atomic_int_inc (&self->priv->connection_queue_length);
+	if (gauge->domain_requests_in_flight != NULL)
+		g_atomic_int_inc (gauge->domain_requests_in_flight);
+
+	/* Start timing the request. If the message is being re-sent (after a redirect or an authorization refresh), keep adding to its existing
+	 * timings, which are reported once the whole operation finishes; see emit_request_completed(). */
+	timer = g_object_get_data (G_OBJECT (message), REQUEST_TIMER_KEY);
+	if (timer == NULL) {
+		timer = g_slice_new0 (RequestTimer);
+		g_object_set_data_full (G_OBJECT (message), REQUEST_TIMER_KEY, timer, (GDestroyNotify) request_timer_free);
+	} else {
+		timer->record.retry_count++;
+	}
+
+	timer->queued = g_get_monotonic_time ();
+	timer->queue_time_counted = FALSE;
+	timer->resolving = timer->connecting = timer->tls_handshaking = 0;
+	timer->wrote_body = timer->got_headers = timer->got_body = 0;
+	timer->record.bytes_out += message->request_body->length;
+
+	g_signal_connect (message, "network-event", (GCallback) message_network_event_cb, self);
+	g_signal_connect (message, "starting", (GCallback) message_starting_cb, self);
+	g_signal_connect (message, "wrote-body", (GCallback) message_wrote_body_cb, self);
+
+	g_signal_connect (message, "got-headers", (GCallback) message_got_headers_cb, self);
+	g_signal_connect (message, "got-chunk", (GCallback) message_got_chunk_cb, self);
+	g_signal_connect (message, "got-body", (GCallback) message_got_body_cb, self);
+}
+
+static void
+request_unqueued_cb (SoupSession *session, SoupMessage *message, GDataService *self)
+{
+	RequestGauge *gauge;
+
+	if (g_object_get_data (G_OBJECT (message), MESSAGE_SERVICE_KEY) != self)
+		return;
+
+	gauge = g_object_get_data (G_OBJECT (message), REQUEST_GAUGE_KEY);
+	if (gauge != NULL) {
+		request_gauge_stop_waiting (self, message);
+
+		g_atomic_int_add (&self->priv->requests_in_flight, -1);
+		if (gauge->domain_requests_in_flight != NULL)
+			g_atomic_int_add (gauge->domain_requests_in_flight, -1);
+
+		g_object_set_data (G_OBJECT (message), REQUEST_GAUGE_KEY, NULL);
+	}
+
+	g_signal_handlers_disconnect_by_func (message, message_network_event_cb, self);
+	g_signal_handlers_disconnect_by_func (message, message_starting_cb, self);
+	g_signal_handlers_disconnect_by_func (message, message_wrote_body_cb, self);
+	g_signal_handlers_disconnect_by_func (message, message_got_headers_cb, self);
+	g_signal_handlers_disconnect_by_func (message, message_got_chunk_cb, self);
+	g_signal_handlers_disconnect_by_func (message, message_got_body_cb, self);
+	g_object_set_data (G_OBJECT (message), RESPONSE_BYTES_KEY, NULL);
+}
+
+/**
+ * gdata_service_get_connection_statistics:
+ * @self: a #GDataService
+ * @requests_sent: (out caller-allocates) (allow-none): return location for the number of requests sent, or %NULL
+ * @connections_opened: (out caller-allocates) (allow-none): return location for the number of connections opened, or %NULL
+ * @tls_handshakes: (out caller-allocates) (allow-none): return location for the number of TLS handshakes performed, or %NULL
  *
- * For more details, see gdata_service_query_single_entry(), which is the synchronous version of this function.
+ * Gets statistics about the service's use of network connections since it was constructed. If @connections_opened is much smaller than
+ * @requests_sent, persistent connections are being reused and the cost of the TCP and TLS handshakes is being amortised across requests.
  *
- * When the operation is finished, @callback will be called. You can then call gdata_service_query_single_entry_finish()
- * to get the results of the operation.
+ * Requests which are re-sent by libsoup (for example, after a redirect) are only counted once. Requests made by a #GDataAuthorizer are not
+ * counted.
  *
- * Since: 0.9.0
+ * Since: 0.15.0
  **/
 void
-gdata_service_query_single_entry_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *entry_id, GDataQuery *query,
-                                        GType entry_type, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+gdata_service_get_connection_statistics (GDataService *self, guint *requests_sent, guint *connections_opened, guint *tls_handshakes)
 {
-	GSimpleAsyncResult *result;
-	QuerySingleEntryAsyncData *data;
+	GDataServicePrivate *priv;
 
 	g_return_if_fail (GDATA_IS_SERVICE (self));
-	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
-	g_return_if_fail (entry_id != NULL);
-	g_return_if_fail (query == NULL || GDATA_IS_QUERY (query));
-	g_return_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY) == TRUE);
-	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
-	g_return_if_fail (callback != NULL);
 
-	data = g_slice_new (QuerySingleEntryAsyncData);
-	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
-	data->query = (query != NULL) ? g_object_ref (query) : NULL;
-	data->entry_id = g_strdup (entry_id);
-	data->entry_type = entry_type;
+	priv = self->priv;
 
-	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_single_entry_async);
-	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_single_entry_async_data_free);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_single_entry_thread, G_PRIORITY_DEFAULT, cancellable);
-	g_object_unref (result);
+	if (requests_sent != NULL)
+		*requests_sent = g_atomic_int_get (&priv->requests_sent);
+	if (connections_opened != NULL)
+		*connections_opened = g_atomic_int_get (&priv->connections_opened);
+	if (tls_handshakes != NULL)
+		*tls_handshakes = g_atomic_int_get (&priv->tls_handshakes);
 }
 
 /**
- * gdata_service_query_single_entry_finish:
+ * gdata_service_get_transfer_statistics:
  * @self: a #GDataService
- * @async_result: a #GAsyncResult
- * @error: a #GError, or %NULL
+ * @bytes_received: (out caller-allocates) (allow-none): return location for the number of response body bytes received over the network, or %NULL
+ * @bytes_decoded: (out caller-allocates) (allow-none): return location for the number of response body bytes after decompression, or %NULL
  *
- * Finishes an asynchronous query operation for a single entry, as started with gdata_service_query_single_entry_async().
+ * Gets statistics about the amount of data the service has downloaded since it was constructed. Responses are requested with gzip or deflate
+ * compression, and decompressed as they arrive; the ratio of @bytes_decoded to @bytes_received gives the saving made by compressing them.
  *
- * Return value: (transfer full): a #GDataEntry, or %NULL; unref with g_object_unref()
+ * Only response bodies are counted, not headers. Compressed responses whose size on the wire isn't known (because the server sent them without a
+ * <code class="literal">Content-Length</code> header) are counted in neither statistic. As with gdata_service_get_connection_statistics(),
+ * requests made by a #GDataAuthorizer are not counted.
  *
- * Since: 0.7.0
+ * Since: 0.15.0
  **/
-GDataEntry *
-gdata_service_query_single_entry_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+void
+gdata_service_get_transfer_statistics (GDataService *self, guint64 *bytes_received, guint64 *bytes_decoded)
 {
-	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
-	GDataEntry *entry;
+	GDataServicePrivate *priv;
 
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+	g_return_if_fail (GDATA_IS_SERVICE (self));
 
-	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_query_single_entry_async);
+	priv = self->priv;
 
-	if (g_simple_async_result_propagate_error (result, error) == TRUE)
-		return NULL;
+	g_mutex_lock (&(priv->transfer_statistics_mutex));
 
-	entry = g_simple_async_result_get_op_res_gpointer (result);
-	if (entry != NULL)
-		return g_object_ref (entry);
-	return NULL;
-}
+	if (bytes_received != NULL)
+		*bytes_received = priv->bytes_received;
+	if (bytes_decoded != NULL)
+		*bytes_decoded = priv->bytes_decoded;
 
-typedef struct {
-	GDataAuthorizationDomain *domain;
-	gchar *upload_uri;
-	GDataEntry *entry;
-} InsertEntryAsyncData;
+	g_mutex_unlock (&(priv->transfer_statistics_mutex));
+}
 
-static void
-insert_entry_async_data_free (InsertEntryAsyncData *self)
+/**
+ * gdata_service_gauges_copy:
+ * @self: a #GDataServiceGauges
+ *
+ * Copies @self, for example so that it can be kept after a #GDataService::gauges-sampled signal handler has returned.
+ *
+ * Return value: (transfer full): a copy of @self; free with gdata_service_gauges_free()
+ *
+ * Since: 0.15.0
+ **/
+GDataServiceGauges *
+gdata_service_gauges_copy (const GDataServiceGauges *self)
 {
-	if (self->domain != NULL)
-		g_object_unref (self->domain);
+	g_return_val_if_fail (self != NULL, NULL);
+
+	return g_slice_dup (GDataServiceGauges, self);
+}
 
-	g_free (self->upload_uri);
-	if (self->entry)
-		g_object_unref (self->entry);
+/**
+ * gdata_service_gauges_free:
+ * @self: a #GDataServiceGauges returned by gdata_service_gauges_copy()
+ *
+ * Frees a #GDataServiceGauges.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_gauges_free (GDataServiceGauges *self)
+{
+	if (self == NULL)
+		return;
 
-	g_slice_free (InsertEntryAsyncData, self);
+	g_slice_free (GDataServiceGauges, self);
 }
 
-static void
-insert_entry_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+GType
+gdata_service_gauges_get_type (void)
 {
-	GDataEntry *updated_entry;
-	GError *error = NULL;
-	InsertEntryAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	static GType type_id = 0;
 
-	/* Insert the entry and return */
-	updated_entry = gdata_service_insert_entry (service, data->domain, data->upload_uri, data->entry, cancellable, &error);
-	if (updated_entry == NULL) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-		return;
+	if (type_id == 0) {
+		type_id = g_boxed_type_register_static (g_intern_static_string ("GDataServiceGauges"),
+		                                        (GBoxedCopyFunc) gdata_service_gauges_copy,
+		                                        (GBoxedFreeFunc) gdata_service_gauges_free);
 	}
 
-	/* Swap the old entry with the new one */
-	g_simple_async_result_set_op_res_gpointer (result, updated_entry, (GDestroyNotify) g_object_unref);
+	return type_id;
 }
 
 /**
- * gdata_service_insert_entry_async:
+ * gdata_service_get_gauges:
  * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the insertion operation falls under, or %NULL
- * @upload_uri: the URI to which the upload should be sent
- * @entry: the #GDataEntry to insert
- * @cancellable: (allow-none): optional #GCancellable object, or %NULL
- * @callback: a #GAsyncReadyCallback to call when insertion is finished, or %NULL
- * @user_data: (closure): data to pass to the @callback function
- *
- * Inserts @entry by uploading it to the online service at @upload_uri. @self, @upload_uri and
- * @entry are all reffed/copied when this function is called, so can safely be freed after this function returns.
+ * @gauges: (out caller-allocates): return location for the gauges
  *
- * For more details, see gdata_service_insert_entry(), which is the synchronous version of this function.
+ * Gets a snapshot of the service's current load: how many requests are in flight and queued, how many upload and download streams are open and
+ * how much data they're holding, and how many progress callbacks are waiting to be dispatched. See #GDataServiceGauges for details.
  *
- * When the operation is finished, @callback will be called. You can then call gdata_service_insert_entry_finish()
- * to get the results of the operation.
+ * Each gauge is read atomically without taking any locks, so this is cheap enough to call often, and can be called from any thread. Since the
+ * gauges are read one after another, they may not be exactly consistent with each other while requests are being made.
  *
- * Since: 0.9.0
+ * Since: 0.15.0
  **/
 void
-gdata_service_insert_entry_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *upload_uri, GDataEntry *entry,
-                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+gdata_service_get_gauges (GDataService *self, GDataServiceGauges *gauges)
 {
-	GSimpleAsyncResult *result;
-	InsertEntryAsyncData *data;
+	GDataServicePrivate *priv;
 
 	g_return_if_fail (GDATA_IS_SERVICE (self));
-	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
-	g_return_if_fail (upload_uri != NULL);
-	g_return_if_fail (GDATA_IS_ENTRY (entry));
-	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
-
-	data = g_slice_new (InsertEntryAsyncData);
-	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
-	data->upload_uri = g_strdup (upload_uri);
-	data->entry = g_object_ref (entry);
-
-	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_insert_entry_async);
-	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) insert_entry_async_data_free);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) insert_entry_thread, G_PRIORITY_DEFAULT, cancellable);
-	g_object_unref (result);
+	g_return_if_fail (gauges != NULL);
+
+	priv = self->priv;
+
+	gauges->requests_in_flight = g_atomic_int_get (&priv->requests_in_flight);
+	gauges->scheduler_queue_length = gdata_request_scheduler_get_n_waiting (priv->request_scheduler);
+	gauges->connection_queue_length = g_atomic_int_get (&priv->connection_queue_length);
+	gauges->upload_streams = g_atomic_int_get (&priv->upload_streams);
+	gauges->upload_buffered_bytes = (gsize) g_atomic_pointer_get (&priv->upload_buffered_bytes);
+	gauges->download_streams = g_atomic_int_get (&priv->download_streams);
+	gauges->download_buffered_bytes = (gsize) g_atomic_pointer_get (&priv->download_buffered_bytes);
+	gauges->pending_progress_callbacks = g_atomic_int_get (&priv->pending_progress_callbacks);
 }
 
 /**
- * gdata_service_insert_entry_finish:
+ * gdata_service_get_requests_in_flight:
  * @self: a #GDataService
- * @async_result: a #GAsyncResult
- * @error: a #GError, or %NULL
+ * @domain: (allow-none): the #GDataAuthorizationDomain to count requests under, or %NULL to count all requests
  *
- * Finishes an asynchronous entry insertion operation started with gdata_service_insert_entry_async().
+ * Gets the number of requests made by the service under @domain which have been queued to be sent and haven't finished yet. If @domain is %NULL,
+ * the total over all domains (and requests made without one) is returned, as in #GDataServiceGauges.requests_in_flight.
  *
- * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ * As with gdata_service_get_gauges(), this can be called from any thread.
  *
- * Since: 0.3.0
+ * Return value: the number of requests in flight
+ *
+ * Since: 0.15.0
  **/
-GDataEntry *
-gdata_service_insert_entry_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+guint
+gdata_service_get_requests_in_flight (GDataService *self, GDataAuthorizationDomain *domain)
 {
-	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
-	GDataEntry *entry;
+	gint *counter;
 
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), 0);
 
-	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_insert_entry_async);
+	if (domain == NULL)
+		return g_atomic_int_get (&self->priv->requests_in_flight);
 
-	if (g_simple_async_result_propagate_error (result, error) == TRUE)
-		return NULL;
+	g_mutex_lock (&(self->priv->gauges_mutex));
+	counter = g_hash_table_lookup (self->priv->domain_requests_in_flight, domain);
+	g_mutex_unlock (&(self->priv->gauges_mutex));
 
-	entry = g_simple_async_result_get_op_res_gpointer (result);
-	g_assert (entry != NULL);
+	return (counter != NULL) ? g_atomic_int_get (counter) : 0;
+}
 
-	return g_object_ref (entry);
+static gboolean
+gauges_source_cb (GDataService *self)
+{
+	GDataServiceGauges gauges;
+
+	gdata_service_get_gauges (self, &gauges);
+	g_signal_emit (self, service_signals[SIGNAL_GAUGES_SAMPLED], 0, &gauges);
+
+	return TRUE;
 }
 
 /**
- * gdata_service_insert_entry:
+ * gdata_service_get_gauges_interval:
  * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the insertion operation falls under, or %NULL
- * @upload_uri: the URI to which the upload should be sent
- * @entry: the #GDataEntry to insert
- * @cancellable: (allow-none): optional #GCancellable object, or %NULL
- * @error: a #GError, or %NULL
  *
- * Inserts @entry by uploading it to the online service at @upload_uri. For more information about the concept of inserting entries, see
- * the <ulink type="http" url="http://code.google.com/apis/gdata/docs/2.0/basics.html#InsertingEntry">online documentation</ulink> for the GData
- * protocol.
+ * Gets the #GDataService:gauges-interval property.
  *
- * The service will return an updated version of the entry, which is the return value of this function on success.
+ * Return value: the interval between snapshots of the gauges, in milliseconds, or <code class="literal">0</code>
  *
- * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
- * If the operation was cancelled before or during network activity, the error %G_IO_ERROR_CANCELLED will be returned. Cancellation has no effect
- * after network activity has finished, however, and the insertion will return successfully (or return an error sent by the server) if it is first
- * cancelled after network activity has finished. See the <link linkend="cancellable-support">overview of cancellation</link> for
- * more details.
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_gauges_interval (GDataService *self)
+{
+	guint gauges_interval;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+
+	g_mutex_lock (&(self->priv->gauges_mutex));
+	gauges_interval = self->priv->gauges_interval;
+	g_mutex_unlock (&(self->priv->gauges_mutex));
+
+	return gauges_interval;
+}
+
+/**
+ * gdata_service_set_gauges_interval:
+ * @self: a #GDataService
+ * @gauges_interval: the interval between snapshots of the gauges, in milliseconds, or <code class="literal">0</code>
  *
- * If the entry is marked as already having been inserted a %GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED error will be returned immediately
- * (there will be no network requests).
+ * Sets the #GDataService:gauges-interval property. If @gauges_interval is non-zero, #GDataService::gauges-sampled is emitted every
+ * @gauges_interval milliseconds in the calling thread's thread-default main context, replacing any previous schedule.
  *
- * If there is an error inserting the entry, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned. Currently, subclasses
- * <emphasis>cannot</emphasis> cannot override this or provide more specific errors.
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_gauges_interval (GDataService *self, guint gauges_interval)
+{
+	GDataServicePrivate *priv;
+	GMainContext *context;
+	GSource *source = NULL;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+
+	priv = self->priv;
+
+	/* The source doesn't hold a reference to the service, since it's destroyed when the service is disposed */
+	if (gauges_interval > 0) {
+		context = g_main_context_ref_thread_default ();
+
+		source = g_timeout_source_new (gauges_interval);
+		g_source_set_callback (source, (GSourceFunc) gauges_source_cb, self, NULL);
+		g_source_attach (source, context);
+
+		g_main_context_unref (context);
+	}
+
+	g_mutex_lock (&(priv->gauges_mutex));
+
+	if (priv->gauges_source != NULL) {
+		g_source_destroy (priv->gauges_source);
+		g_source_unref (priv->gauges_source);
+	}
+
+	priv->gauges_source = source;
+	priv->gauges_interval = gauges_interval;
+
+	g_mutex_unlock (&(priv->gauges_mutex));
+
+	g_object_notify (G_OBJECT (self), "gauges-interval");
+}
+
+void
+_gdata_service_add_stream (GDataService *self, GDataOperationType operation_type)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+
+	if (operation_type == GDATA_OPERATION_UPLOAD)
+		g_atomic_int_inc (&self->priv->upload_streams);
+	else
+		g_atomic_int_inc (&self->priv->download_streams);
+}
+
+void
+_gdata_service_remove_stream (GDataService *self, GDataOperationType operation_type)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+
+	if (operation_type == GDATA_OPERATION_UPLOAD)
+		g_atomic_int_add (&self->priv->upload_streams, -1);
+	else
+		g_atomic_int_add (&self->priv->download_streams, -1);
+}
+
+/*
+ * _gdata_service_count_buffer:
+ * @self: a #GDataService
+ * @operation_type: %GDATA_OPERATION_UPLOAD or %GDATA_OPERATION_DOWNLOAD
+ * @buffer: a stream's #GDataBuffer
  *
- * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ * Counts the data held in @buffer towards the service's #GDataServiceGauges.upload_buffered_bytes or #GDataServiceGauges.download_buffered_bytes
+ * gauge, depending on @operation_type, until @buffer is freed. If @buffer could outlive @self, it must be uncounted first by calling
+ * gdata_buffer_set_length_counter() on it with a %NULL counter. As with gdata_buffer_set_length_counter(), this must only be called while no other
+ * thread is using @buffer.
  *
- * Since: 0.9.0
+ * Since: 0.15.0
  */
-GDataEntry *
-gdata_service_insert_entry (GDataService *self, GDataAuthorizationDomain *domain, const gchar *upload_uri, GDataEntry *entry,
-                            GCancellable *cancellable, GError **error)
+void
+_gdata_service_count_buffer (GDataService *self, GDataOperationType operation_type, GDataBuffer *buffer)
 {
-	GDataEntry *updated_entry;
-	SoupMessage *message;
-	gchar *upload_data;
-	guint status;
-	GDataParsableClass *klass;
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (buffer != NULL);
 
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
-	g_return_val_if_fail (upload_uri != NULL, NULL);
-	g_return_val_if_fail (GDATA_IS_ENTRY (entry), NULL);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	gdata_buffer_set_length_counter (buffer, (operation_type == GDATA_OPERATION_UPLOAD) ? &self->priv->upload_buffered_bytes :
+	                                                                                      &self->priv->download_buffered_bytes);
+}
 
-	if (gdata_entry_is_inserted (entry) == TRUE) {
-		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_ENTRY_ALREADY_INSERTED,
-		                     _("The entry has already been inserted."));
-		return NULL;
-	}
+typedef struct {
+	GPtrArray *messages; /* SoupMessages still in flight; not owned */
+	GCancellable *cancellable;
+	GSource *cancel_source;
+	gboolean cancelled;
+} PrepareConnectionsData;
 
-	message = _gdata_service_build_message (self, domain, SOUP_METHOD_POST, upload_uri, NULL, FALSE);
+static void
+prepare_connections_data_free (PrepareConnectionsData *data)
+{
+	g_assert (data->messages->len == 0);
 
-	/* Append the data */
-	klass = GDATA_PARSABLE_GET_CLASS (entry);
-	g_assert (klass->get_content_type != NULL);
-	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
-		upload_data = gdata_parsable_get_json (GDATA_PARSABLE (entry));
-		soup_message_set_request (message, "application/json", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
-	} else {
-		upload_data = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
-		soup_message_set_request (message, "application/atom+xml", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
+	g_ptr_array_unref (data->messages);
+
+	if (data->cancel_source != NULL) {
+		g_source_destroy (data->cancel_source);
+		g_source_unref (data->cancel_source);
 	}
 
-	/* Send the message */
-	status = _gdata_service_send_message (self, message, cancellable, error);
+	if (data->cancellable != NULL)
+		g_object_unref (data->cancellable);
 
-	if (status == SOUP_STATUS_NONE || status == SOUP_STATUS_CANCELLED) {
-		/* Redirect error or cancelled */
-		g_object_unref (message);
-		return NULL;
-	} else if (status != SOUP_STATUS_CREATED && status != SOUP_STATUS_OK) {
-		/* Error: for XML APIs Google returns CREATED and for JSON it returns OK. */
-		GDataServiceClass *service_klass = GDATA_SERVICE_GET_CLASS (self);
-		g_assert (service_klass->parse_error_response != NULL);
-		service_klass->parse_error_response (self, GDATA_OPERATION_INSERTION, status, message->reason_phrase, message->response_body->data,
-		                                     message->response_body->length, error);
-		g_object_unref (message);
-		return NULL;
+	g_slice_free (PrepareConnectionsData, data);
+}
+
+static gboolean
+prepare_connections_cancelled_cb (GCancellable *cancellable, GSimpleAsyncResult *result)
+{
+	PrepareConnectionsData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GDataService *self = GDATA_SERVICE (g_async_result_get_source_object (G_ASYNC_RESULT (result)));
+	GPtrArray *pending;
+	guint i, j;
+
+	/* Cancelling the last message completes the operation, which would otherwise free @result and @data under us */
+	g_object_ref (result);
+
+	data->cancelled = TRUE;
+
+	/* Cancelling a message may call prepare_connections_message_cb() and remove it from ->messages immediately, so iterate over a copy, and only
+	 * cancel messages which are still pending. */
+	pending = g_ptr_array_sized_new (data->messages->len);
+	for (i = 0; i < data->messages->len; i++)
+		g_ptr_array_add (pending, data->messages->pdata[i]);
+
+	for (i = 0; i < pending->len; i++) {
+		for (j = 0; j < data->messages->len; j++) {
+			if (data->messages->pdata[j] == pending->pdata[i]) {
+				soup_session_cancel_message (self->priv->session, pending->pdata[i], SOUP_STATUS_CANCELLED);
+				break;
+			}
+		}
 	}
 
-	/* Parse the XML or JSON according to GDataEntry type; create and return a new GDataEntry of the same type as @entry */
-	g_assert (message->response_body->data != NULL);
-	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
-		updated_entry = GDATA_ENTRY (gdata_parsable_new_from_json (G_OBJECT_TYPE (entry), message->response_body->data,
-		                             message->response_body->length, error));
-	} else {
-		updated_entry = GDATA_ENTRY (gdata_parsable_new_from_xml (G_OBJECT_TYPE (entry), message->response_body->data,
-		                             message->response_body->length, error));
-	}
-	g_object_unref (message);
+	g_ptr_array_unref (pending);
+	g_object_unref (self);
+	g_object_unref (result);
 
-	return updated_entry;
+	return FALSE;
 }
 
-typedef struct {
-	GDataAuthorizationDomain *domain;
-	GDataEntry *entry;
-} UpdateEntryAsyncData;
-
 static void
-update_entry_async_data_free (UpdateEntryAsyncData *data)
+prepare_connections_message_cb (SoupSession *session, SoupMessage *message, GSimpleAsyncResult *result)
 {
-	if (data->domain != NULL)
-		g_object_unref (data->domain);
+	PrepareConnectionsData *data = g_simple_async_result_get_op_res_gpointer (result);
 
-	if (data->entry != NULL)
-		g_object_unref (data->entry);
+	/* The response itself is of no interest: all that matters is that a connection to the host is now open (or that it couldn't be opened, in
+	 * which case the real request will report the error). */
+	g_ptr_array_remove_fast (data->messages, message);
 
-	g_slice_free (UpdateEntryAsyncData, data);
+	if (data->messages->len == 0) {
+		if (data->cancelled == TRUE) {
+			GError *error = NULL;
+
+			set_cancelled_error (&error);
+			g_simple_async_result_take_error (result, error);
+		}
+
+		g_simple_async_result_complete (result);
+	}
+
+	/* Drop the reference which was passed to soup_session_queue_message() */
+	g_object_unref (result);
 }
 
 static void
-update_entry_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+prepare_connection_for_uri (GDataService *self, GSimpleAsyncResult *result, GHashTable *origins, const gchar *uri)
 {
-	GDataEntry *updated_entry;
-	GError *error = NULL;
-	UpdateEntryAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	PrepareConnectionsData *data = g_simple_async_result_get_op_res_gpointer (result);
+	SoupURI *soup_uri, *origin_uri;
+	SoupMessage *message;
+	gchar *origin;
 
-	/* Update the entry and return */
-	updated_entry = gdata_service_update_entry (service, data->domain, data->entry, cancellable, &error);
-	if (updated_entry == NULL) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
+	soup_uri = soup_uri_new (uri);
+	if (soup_uri == NULL || SOUP_URI_VALID_FOR_HTTP (soup_uri) == FALSE) {
+		g_warning ("Not preparing a connection for invalid URI ‘%s’.", uri);
+
+		if (soup_uri != NULL)
+			soup_uri_free (soup_uri);
+
+		return;
+	}
+
+	/* Only make one connection to each origin (scheme, host and port) */
+	origin_uri = soup_uri_new (NULL);
+	soup_uri_set_scheme (origin_uri, soup_uri_get_scheme (soup_uri));
+	soup_uri_set_host (origin_uri, soup_uri_get_host (soup_uri));
+	soup_uri_set_port (origin_uri, soup_uri_get_port (soup_uri));
+	soup_uri_set_path (origin_uri, "/");
+	soup_uri_free (soup_uri);
+
+	origin = soup_uri_to_string (origin_uri, FALSE);
+
+	if (g_hash_table_lookup (origins, origin) != NULL) {
+		g_free (origin);
+		soup_uri_free (origin_uri);
 		return;
 	}
 
-	/* Swap the old entry with the new one */
-	g_simple_async_result_set_op_res_gpointer (result, updated_entry, (GDestroyNotify) g_object_unref);
+	g_hash_table_insert (origins, origin, origin);
+
+	/* A HEAD request for the root of the origin is about the cheapest thing which makes libsoup resolve the host, open a connection and do the
+	 * TLS handshake. The connection is then kept alive in the session's pool, ready for the next real request. */
+	message = soup_message_new_from_uri (SOUP_METHOD_HEAD, origin_uri);
+	soup_message_set_flags (message, SOUP_MESSAGE_NO_REDIRECT);
+	_gdata_service_claim_message (self, message);
+	soup_uri_free (origin_uri);
+
+	g_ptr_array_add (data->messages, message);
+	soup_session_queue_message (self->priv->session, message, (SoupSessionCallback) prepare_connections_message_cb, g_object_ref (result));
 }
 
 /**
- * gdata_service_update_entry_async:
+ * gdata_service_prepare_connections_async:
  * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the update operation falls under, or %NULL
- * @entry: the #GDataEntry to update
+ * @uris: (array zero-terminated=1) (allow-none): a %NULL-terminated array of URIs to connect to, or %NULL
  * @cancellable: (allow-none): optional #GCancellable object, or %NULL
- * @callback: a #GAsyncReadyCallback to call when the update is finished, or %NULL
- * @user_data: (closure): data to pass to the @callback function
+ * @callback: a #GAsyncReadyCallback to call when the connections have been prepared
+ * @user_data: (closure): data to pass to @callback
  *
- * Updates @entry by PUTting it to its <literal>edit</literal> link's URI. @self and
- * @entry are both reffed when this function is called, so can safely be unreffed after this function returns.
+ * Opens connections to the hosts in @uris in the background, so that the first real request to each of them doesn't have to wait for DNS
+ * resolution, the TCP handshake and the TLS handshake. This is intended to be called early on, for example when an application starts up, before
+ * the user does anything which needs a request to be made. Only one connection is opened to each host, regardless of how many of @uris share it,
+ * and it's kept alive for the session's #GDataService:idle-timeout.
  *
- * For more details, see gdata_service_update_entry(), which is the synchronous version of this function.
+ * If @uris is %NULL, connections are prepared for the scopes of all the #GDataAuthorizationDomain<!-- -->s the service's type uses (see
+ * gdata_service_get_authorization_domains()), which normally covers all the hosts it will make requests to.
  *
- * When the operation is finished, @callback will be called. You can then call gdata_service_update_entry_finish()
- * to get the results of the operation.
+ * This is best-effort: failures to connect aren't reported, as the next real request to the host will report them anyway. @callback is called in
+ * the thread-default main context of the calling thread once all the connections have been opened (or have failed to open), at which point
+ * gdata_service_prepare_connections_finish() should be called. Each connection is made with a single <code class="literal">HEAD</code>
+ * request, which is counted by gdata_service_get_connection_statistics().
  *
- * Since: 0.9.0
+ * If @cancellable is cancelled before the connections have been prepared, any which are still being made are abandoned, and
+ * gdata_service_prepare_connections_finish() returns %G_IO_ERROR_CANCELLED.
+ *
+ * Since: 0.15.0
  **/
 void
-gdata_service_update_entry_async (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry,
-                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+gdata_service_prepare_connections_async (GDataService *self, const gchar * const *uris, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                         gpointer user_data)
 {
 	GSimpleAsyncResult *result;
-	UpdateEntryAsyncData *data;
+	PrepareConnectionsData *data;
+	GHashTable *origins;
 
 	g_return_if_fail (GDATA_IS_SERVICE (self));
-	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
-	g_return_if_fail (GDATA_IS_ENTRY (entry));
 	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
 
-	data = g_slice_new (UpdateEntryAsyncData);
-	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
-	data->entry = g_object_ref (entry);
+	data = g_slice_new0 (PrepareConnectionsData);
+	data->messages = g_ptr_array_new ();
+	data->cancellable = (cancellable != NULL) ? g_object_ref (cancellable) : NULL;
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_prepare_connections_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) prepare_connections_data_free);
+
+	if (cancellable != NULL && g_cancellable_is_cancelled (cancellable) == TRUE) {
+		GError *error = NULL;
+
+		set_cancelled_error (&error);
+		g_simple_async_result_take_error (result, error);
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+
+		return;
+	}
+
+	origins = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	if (uris != NULL) {
+		guint i;
+
+		for (i = 0; uris[i] != NULL; i++)
+			prepare_connection_for_uri (self, result, origins, uris[i]);
+	} else {
+		GList *domains, *i;
+
+		domains = gdata_service_get_authorization_domains (G_OBJECT_TYPE (self));
+
+		for (i = domains; i != NULL; i = i->next)
+			prepare_connection_for_uri (self, result, origins, gdata_authorization_domain_get_scope (GDATA_AUTHORIZATION_DOMAIN (i->data)));
+
+		g_list_free (domains);
+	}
+
+	g_hash_table_unref (origins);
+
+	if (data->messages->len == 0) {
+		/* Nothing to connect to */
+		g_simple_async_result_complete_in_idle (result);
+	} else if (cancellable != NULL) {
+		/* This is dispatched in the thread-default main context, which is where libsoup calls prepare_connections_message_cb() */
+		data->cancel_source = g_cancellable_source_new (cancellable);
+		g_source_set_callback (data->cancel_source, (GSourceFunc) prepare_connections_cancelled_cb, result, NULL);
+		g_source_attach (data->cancel_source, g_main_context_get_thread_default ());
+	}
 
-	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_update_entry_async);
-	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) update_entry_async_data_free);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) update_entry_thread, G_PRIORITY_DEFAULT, cancellable);
 	g_object_unref (result);
 }
 
 /**
- * gdata_service_update_entry_finish:
+ * gdata_service_prepare_connections_finish:
  * @self: a #GDataService
  * @async_result: a #GAsyncResult
  * @error: a #GError, or %NULL
  *
- * Finishes an asynchronous entry update operation started with gdata_service_update_entry_async().
+ * Finishes an asynchronous operation to prepare connections started with gdata_service_prepare_connections_async().
  *
- * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ * Return value: %TRUE once the connections have been prepared, or %FALSE if the operation was cancelled
  *
- * Since: 0.3.0
+ * Since: 0.15.0
  **/
-GDataEntry *
-gdata_service_update_entry_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+gboolean
+gdata_service_prepare_connections_finish (GDataService *self, GAsyncResult *async_result, GError **error)
 {
-	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
-	GDataEntry *entry;
-
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_update_entry_async);
+	g_warn_if_fail (g_simple_async_result_get_source_tag (G_SIMPLE_ASYNC_RESULT (async_result)) == gdata_service_prepare_connections_async);
 
-	if (g_simple_async_result_propagate_error (result, error) == TRUE)
-		return NULL;
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == TRUE)
+		return FALSE;
 
-	entry = g_simple_async_result_get_op_res_gpointer (result);
-	g_assert (entry != NULL);
+	return TRUE;
+}
 
-	return g_object_ref (entry);
+/**
+ * gdata_service_get_entry_cache_size:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:entry-cache-size property.
+ *
+ * Return value: the maximum number of entries in the entry cache, or <code class="literal">0</code> if it's disabled
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_entry_cache_size (GDataService *self)
+{
+	guint entry_cache_size;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+
+	g_mutex_lock (&(self->priv->entry_cache_mutex));
+	entry_cache_size = self->priv->entry_cache_size;
+	g_mutex_unlock (&(self->priv->entry_cache_mutex));
+
+	return entry_cache_size;
 }
 
 /**
- * gdata_service_update_entry:
+ * gdata_service_set_entry_cache_size:
  * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the update operation falls under, or %NULL
- * @entry: the #GDataEntry to update
- * @cancellable: (allow-none): optional #GCancellable object, or %NULL
- * @error: a #GError, or %NULL
+ * @entry_cache_size: the maximum number of entries in the entry cache, or <code class="literal">0</code> to disable it
  *
- * Updates @entry by PUTting it to its <literal>edit</literal> link's URI. For more information about the concept of updating entries, see
- * the <ulink type="http" url="http://code.google.com/apis/gdata/docs/2.0/basics.html#UpdatingEntry">online documentation</ulink> for the GData
- * protocol.
+ * Sets the #GDataService:entry-cache-size property. If the cache currently holds more than @entry_cache_size entries, the least recently used
+ * ones are evicted.
  *
- * The service will return an updated version of the entry, which is the return value of this function on success.
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_entry_cache_size (GDataService *self, guint entry_cache_size)
+{
+	GDataServicePrivate *priv;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+
+	priv = self->priv;
+
+	g_mutex_lock (&(priv->entry_cache_mutex));
+
+	if (priv->entry_cache_size == entry_cache_size) {
+		g_mutex_unlock (&(priv->entry_cache_mutex));
+		return;
+	}
+
+	priv->entry_cache_size = entry_cache_size;
+	entry_cache_trim (priv);
+
+	g_mutex_unlock (&(priv->entry_cache_mutex));
+
+	g_object_notify (G_OBJECT (self), "entry-cache-size");
+}
+
+/**
+ * gdata_service_get_acl_cache_size:
+ * @self: a #GDataService
  *
- * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
- * If the operation was cancelled before or during network activity, the error %G_IO_ERROR_CANCELLED will be returned. Cancellation has no effect
- * after network activity has finished, however, and the update will return successfully (or return an error sent by the server) if it is first
- * cancelled after network activity has finished. See the <link linkend="cancellable-support">overview of cancellation</link> for
- * more details.
+ * Gets the #GDataService:acl-cache-size property.
  *
- * If there is an error updating the entry, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned. Currently, subclasses
- * <emphasis>cannot</emphasis> cannot override this or provide more specific errors.
+ * Return value: the maximum number of access control lists in the ACL cache, or <code class="literal">0</code> if it's disabled
  *
- * Return value: (transfer full): an updated #GDataEntry, or %NULL; unref with g_object_unref()
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_acl_cache_size (GDataService *self)
+{
+	guint acl_cache_size;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+
+	g_mutex_lock (&(self->priv->acl_cache_mutex));
+	acl_cache_size = self->priv->acl_cache_size;
+	g_mutex_unlock (&(self->priv->acl_cache_mutex));
+
+	return acl_cache_size;
+}
+
+/**
+ * gdata_service_set_acl_cache_size:
+ * @self: a #GDataService
+ * @acl_cache_size: the maximum number of access control lists in the ACL cache, or <code class="literal">0</code> to disable it
  *
- * Since: 0.9.0
+ * Sets the #GDataService:acl-cache-size property. If the cache currently holds more than @acl_cache_size access control lists, the least
+ * recently used ones are evicted.
+ *
+ * Since: 0.15.0
  **/
-GDataEntry *
-gdata_service_update_entry (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry, GCancellable *cancellable, GError **error)
+void
+gdata_service_set_acl_cache_size (GDataService *self, guint acl_cache_size)
 {
-	GDataEntry *updated_entry;
-	GDataLink *_link;
-	SoupMessage *message;
-	gchar *upload_data;
-	guint status;
-	GDataParsableClass *klass;
+	GDataServicePrivate *priv;
 
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
-	g_return_val_if_fail (GDATA_IS_ENTRY (entry), NULL);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_if_fail (GDATA_IS_SERVICE (self));
 
-	/* Append the data */
-	klass = GDATA_PARSABLE_GET_CLASS (entry);
-	g_assert (klass->get_content_type != NULL);
-	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
-		/* Get the edit URI */
-		_link = gdata_entry_look_up_link (entry, GDATA_LINK_SELF);
-		g_assert (_link != NULL);
-		message = _gdata_service_build_message (self, domain, SOUP_METHOD_PUT, gdata_link_get_uri (_link), gdata_entry_get_etag (entry), TRUE);
-		upload_data = gdata_parsable_get_json (GDATA_PARSABLE (entry));
-		soup_message_set_request (message, "application/json", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
-	} else {
-		/* Get the edit URI */
-		_link = gdata_entry_look_up_link (entry, GDATA_LINK_EDIT);
-		g_assert (_link != NULL);
-		message = _gdata_service_build_message (self, domain, SOUP_METHOD_PUT, gdata_link_get_uri (_link), gdata_entry_get_etag (entry), TRUE);
-		upload_data = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
-		soup_message_set_request (message, "application/atom+xml", SOUP_MEMORY_TAKE, upload_data, strlen (upload_data));
-	}
+	priv = self->priv;
 
-	/* Send the message */
-	status = _gdata_service_send_message (self, message, cancellable, error);
+	g_mutex_lock (&(priv->acl_cache_mutex));
 
-	if (status == SOUP_STATUS_NONE || status == SOUP_STATUS_CANCELLED) {
-		/* Redirect error or cancelled */
-		g_object_unref (message);
-		return NULL;
-	} else if (status != SOUP_STATUS_OK) {
-		/* Error */
-		GDataServiceClass *service_klass = GDATA_SERVICE_GET_CLASS (self);
-		g_assert (service_klass->parse_error_response != NULL);
-		service_klass->parse_error_response (self, GDATA_OPERATION_UPDATE, status, message->reason_phrase, message->response_body->data,
-		                                     message->response_body->length, error);
-		g_object_unref (message);
-		return NULL;
+	if (priv->acl_cache_size == acl_cache_size) {
+		g_mutex_unlock (&(priv->acl_cache_mutex));
+		return;
 	}
 
-	/* Parse the XML; create and return a new GDataEntry of the same type as @entry */
-	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
-		updated_entry = GDATA_ENTRY (gdata_parsable_new_from_json (G_OBJECT_TYPE (entry), message->response_body->data,
-		                         message->response_body->length, error));
-	} else {
-		updated_entry = GDATA_ENTRY (gdata_parsable_new_from_xml (G_OBJECT_TYPE (entry), message->response_body->data,
-		                             message->response_body->length, error));
-	}
-	g_object_unref (message);
+	priv->acl_cache_size = acl_cache_size;
+	acl_cache_trim (priv);
+
+	g_mutex_unlock (&(priv->acl_cache_mutex));
+
+	g_object_notify (G_OBJECT (self), "acl-cache-size");
+}
+
+/**
+ * gdata_service_get_max_retries:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:max-retries property.
+ *
+ * Return value: the maximum number of times to retry a request after a transient failure
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_max_retries (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	return (guint) g_atomic_int_get (&(self->priv->max_retries));
+}
+
+/**
+ * gdata_service_set_max_retries:
+ * @self: a #GDataService
+ * @max_retries: the maximum number of times to retry a request after a transient failure, or <code class="literal">0</code> to never retry
+ *
+ * Sets the #GDataService:max-retries property.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_max_retries (GDataService *self, guint max_retries)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (max_retries <= G_MAXINT);
+
+	g_atomic_int_set (&(self->priv->max_retries), (gint) max_retries);
+	g_object_notify (G_OBJECT (self), "max-retries");
+}
+
+/**
+ * gdata_service_get_retry_delay:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:retry-delay property.
+ *
+ * Return value: the delay before the first retry of a request, in milliseconds
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_retry_delay (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	return (guint) g_atomic_int_get (&(self->priv->retry_delay));
+}
+
+/**
+ * gdata_service_set_retry_delay:
+ * @self: a #GDataService
+ * @retry_delay: the delay before the first retry of a request, in milliseconds; at most <code class="literal">60000</code>
+ *
+ * Sets the #GDataService:retry-delay property.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_retry_delay (GDataService *self, guint retry_delay)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (retry_delay <= 60000);
 
-	return updated_entry;
+	g_atomic_int_set (&(self->priv->retry_delay), (gint) retry_delay);
+	g_object_notify (G_OBJECT (self), "retry-delay");
 }
 
-typedef struct {
-	GDataAuthorizationDomain *domain;
-	GDataEntry *entry;
-} DeleteEntryAsyncData;
-
-static void
-delete_entry_async_data_free (DeleteEntryAsyncData *data)
+/**
+ * gdata_service_get_upload_bandwidth_limit:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:upload-bandwidth-limit property.
+ *
+ * Return value: the maximum rate at which to upload data, in bytes per second, or <code class="literal">0</code> if there's no limit
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_upload_bandwidth_limit (GDataService *self)
 {
-	if (data->domain != NULL)
-		g_object_unref (data->domain);
-
-	if (data->entry != NULL)
-		g_object_unref (data->entry);
-
-	g_slice_free (DeleteEntryAsyncData, data);
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	return gdata_bandwidth_limiter_get_rate (self->priv->upload_bandwidth_limiter);
 }
 
-static void
-delete_entry_thread (GSimpleAsyncResult *result, GDataService *service, GCancellable *cancellable)
+/**
+ * gdata_service_set_upload_bandwidth_limit:
+ * @self: a #GDataService
+ * @bytes_per_second: the maximum rate at which to upload data, in bytes per second, or <code class="literal">0</code> for no limit
+ *
+ * Sets the #GDataService:upload-bandwidth-limit property. This takes effect immediately, including for uploads which are already in progress.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_upload_bandwidth_limit (GDataService *self, guint bytes_per_second)
 {
-	gboolean success;
-	GError *error = NULL;
-	DeleteEntryAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
-
-	/* Delete the entry and return */
-	success = gdata_service_delete_entry (service, data->domain, data->entry, cancellable, &error);
-	if (success == FALSE) {
-		g_simple_async_result_set_from_error (result, error);
-		g_error_free (error);
-		return;
-	}
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (bytes_per_second <= G_MAXINT);
 
-	/* Replace the entry with the success value */
-	g_simple_async_result_set_op_res_gboolean (result, success);
+	gdata_bandwidth_limiter_set_rate (self->priv->upload_bandwidth_limiter, bytes_per_second);
+	g_object_notify (G_OBJECT (self), "upload-bandwidth-limit");
 }
 
 /**
- * gdata_service_delete_entry_async:
+ * gdata_service_get_download_bandwidth_limit:
  * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the deletion falls under, or %NULL
- * @entry: the #GDataEntry to delete
- * @cancellable: (allow-none): optional #GCancellable object, or %NULL
- * @callback: a #GAsyncReadyCallback to call when deletion is finished, or %NULL
- * @user_data: (closure): data to pass to the @callback function
  *
- * Deletes @entry from the server. @self and @entry are both reffed when this function is called,
- * so can safely be unreffed after this function returns.
+ * Gets the #GDataService:download-bandwidth-limit property.
  *
- * For more details, see gdata_service_delete_entry(), which is the synchronous version of this function.
+ * Return value: the maximum rate at which to download data, in bytes per second, or <code class="literal">0</code> if there's no limit
  *
- * When the operation is finished, @callback will be called. You can then call gdata_service_delete_entry_finish()
- * to get the results of the operation.
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_download_bandwidth_limit (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	return gdata_bandwidth_limiter_get_rate (self->priv->download_bandwidth_limiter);
+}
+
+/**
+ * gdata_service_set_download_bandwidth_limit:
+ * @self: a #GDataService
+ * @bytes_per_second: the maximum rate at which to download data, in bytes per second, or <code class="literal">0</code> for no limit
  *
- * Since: 0.9.0
+ * Sets the #GDataService:download-bandwidth-limit property. This takes effect immediately, including for downloads which are already in
+ * progress.
+ *
+ * Since: 0.15.0
  **/
 void
-gdata_service_delete_entry_async (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry,
-                                  GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+gdata_service_set_download_bandwidth_limit (GDataService *self, guint bytes_per_second)
 {
-	GSimpleAsyncResult *result;
-	DeleteEntryAsyncData *data;
-
 	g_return_if_fail (GDATA_IS_SERVICE (self));
-	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
-	g_return_if_fail (GDATA_IS_ENTRY (entry));
-	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
-
-	data = g_slice_new (DeleteEntryAsyncData);
-	data->domain = (domain != NULL) ? g_object_ref (domain) : NULL;
-	data->entry = g_object_ref (entry);
+	g_return_if_fail (bytes_per_second <= G_MAXINT);
 
-	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_delete_entry_async);
-	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) delete_entry_async_data_free);
-	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) delete_entry_thread, G_PRIORITY_DEFAULT, cancellable);
-	g_object_unref (result);
+	gdata_bandwidth_limiter_set_rate (self->priv->download_bandwidth_limiter, bytes_per_second);
+	g_object_notify (G_OBJECT (self), "download-bandwidth-limit");
 }
 
 /**
- * gdata_service_delete_entry_finish:
+ * gdata_service_get_minimal_responses:
  * @self: a #GDataService
- * @async_result: a #GAsyncResult
- * @error: a #GError, or %NULL
  *
- * Finishes an asynchronous entry deletion operation started with gdata_service_delete_entry_async().
+ * Gets the #GDataService:minimal-responses property.
  *
- * Return value: %TRUE on success, %FALSE otherwise
+ * Return value: %TRUE if minimal responses are requested for insertions and updates, %FALSE otherwise
  *
- * Since: 0.3.0
+ * Since: 0.15.0
  **/
 gboolean
-gdata_service_delete_entry_finish (GDataService *self, GAsyncResult *async_result, GError **error)
+gdata_service_get_minimal_responses (GDataService *self)
 {
-	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
-
 	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
-	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
-
-	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_service_delete_entry_async);
-
-	if (g_simple_async_result_propagate_error (result, error) == TRUE)
-		return FALSE;
-
-	return g_simple_async_result_get_op_res_gboolean (result);
+	return (g_atomic_int_get (&(self->priv->minimal_responses)) != 0) ? TRUE : FALSE;
 }
 
 /**
- * gdata_service_delete_entry:
+ * gdata_service_set_minimal_responses:
  * @self: a #GDataService
- * @domain: (allow-none): the #GDataAuthorizationDomain the deletion falls under, or %NULL
- * @entry: the #GDataEntry to delete
- * @cancellable: (allow-none): optional #GCancellable object, or %NULL
- * @error: a #GError, or %NULL
+ * @minimal_responses: %TRUE to request minimal responses for insertions and updates, %FALSE otherwise
  *
- * Deletes @entry from the server. For more information about the concept of deleting entries, see the
- * <ulink type="http" url="http://code.google.com/apis/gdata/docs/2.0/basics.html#DeletingEntry">online documentation</ulink> for the GData
- * protocol.
+ * Sets the #GDataService:minimal-responses property.
  *
- * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
- * If the operation was cancelled before or during network activity, the error %G_IO_ERROR_CANCELLED will be returned. Cancellation has no effect
- * after network activity has finished, however, and the deletion will return successfully (or return an error sent by the server) if it is first
- * cancelled after network activity has finished. See the <link linkend="cancellable-support">overview of cancellation</link> for
- * more details.
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_minimal_responses (GDataService *self, gboolean minimal_responses)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+
+	g_atomic_int_set (&(self->priv->minimal_responses), (minimal_responses == TRUE) ? 1 : 0);
+	g_object_notify (G_OBJECT (self), "minimal-responses");
+}
+
+/**
+ * gdata_service_get_update_entries_in_place:
+ * @self: a #GDataService
  *
- * If there is an error deleting the entry, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned. Currently, subclasses
- * <emphasis>cannot</emphasis> cannot override this or provide more specific errors.
+ * Gets the #GDataService:update-entries-in-place property.
  *
- * Return value: %TRUE on success, %FALSE otherwise
+ * Return value: %TRUE if uploaded entries are updated in place to match the server's responses, %FALSE otherwise
  *
- * Since: 0.9.0
+ * Since: 0.15.0
  **/
 gboolean
-gdata_service_delete_entry (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry, GCancellable *cancellable, GError **error)
+gdata_service_get_update_entries_in_place (GDataService *self)
 {
-	GDataLink *_link;
-	SoupMessage *message;
-	guint status;
-	gchar *fixed_uri;
-	GDataParsableClass *klass;
-
 	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
-	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), FALSE);
-	g_return_val_if_fail (GDATA_IS_ENTRY (entry), FALSE);
-	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
-	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
-
-	/* Get the edit URI. We have to fix it to always use HTTPS as YouTube videos appear to incorrectly return a HTTP URI as their edit URI. */
-	klass = GDATA_PARSABLE_GET_CLASS (entry);
-	g_assert (klass->get_content_type != NULL);
-	if (g_strcmp0 (klass->get_content_type (), "application/json") == 0) {
-		_link = gdata_entry_look_up_link (entry, GDATA_LINK_SELF);
-	} else {
-		_link = gdata_entry_look_up_link (entry, GDATA_LINK_EDIT);
-	}
-	g_assert (_link != NULL);
+	return (g_atomic_int_get (&(self->priv->update_entries_in_place)) != 0) ? TRUE : FALSE;
+}
 
-	fixed_uri = _gdata_service_fix_uri_scheme (gdata_link_get_uri (_link));
-	message = _gdata_service_build_message (self, domain, SOUP_METHOD_DELETE, fixed_uri, gdata_entry_get_etag (entry), TRUE);
-	g_free (fixed_uri);
+/**
+ * gdata_service_set_update_entries_in_place:
+ * @self: a #GDataService
+ * @update_entries_in_place: %TRUE to update uploaded entries in place, %FALSE to return new entries
+ *
+ * Sets the #GDataService:update-entries-in-place property.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_update_entries_in_place (GDataService *self, gboolean update_entries_in_place)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
 
-	/* Send the message */
-	status = _gdata_service_send_message (self, message, cancellable, error);
+	g_atomic_int_set (&(self->priv->update_entries_in_place), (update_entries_in_place == TRUE) ? 1 : 0);
+	g_object_notify (G_OBJECT (self), "update-entries-in-place");
+}
 
-	if (status == SOUP_STATUS_NONE || status == SOUP_STATUS_CANCELLED) {
-		/* Redirect error or cancelled */
-		g_object_unref (message);
-		return FALSE;
-	} else if (status != SOUP_STATUS_OK) {
-		/* Error */
-		GDataServiceClass *service_klass = GDATA_SERVICE_GET_CLASS (self);
-		g_assert (service_klass->parse_error_response != NULL);
-		service_klass->parse_error_response (self, GDATA_OPERATION_DELETION, status, message->reason_phrase, message->response_body->data,
-		                                     message->response_body->length, error);
-		g_object_unref (message);
-		return FALSE;
-	}
+/**
+ * gdata_service_get_hedge_delay:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:hedge-delay property.
+ *
+ * Return value: how long to wait for a response before sending a second request, in milliseconds, or <code class="literal">0</code> if requests
+ * aren't hedged
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_hedge_delay (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	return (guint) g_atomic_int_get (&(self->priv->hedge_delay));
+}
 
-	g_object_unref (message);
+/**
+ * gdata_service_set_hedge_delay:
+ * @self: a #GDataService
+ * @hedge_delay: how long to wait for a response before sending a second request, in milliseconds, or <code class="literal">0</code> to not hedge
+ * requests; at most <code class="literal">60000</code>
+ *
+ * Sets the #GDataService:hedge-delay property.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_hedge_delay (GDataService *self, guint hedge_delay)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (hedge_delay <= 60000);
 
-	return TRUE;
+	g_atomic_int_set (&(self->priv->hedge_delay), (gint) hedge_delay);
+	g_object_notify (G_OBJECT (self), "hedge-delay");
 }
 
-static void
-notify_proxy_uri_cb (GObject *gobject, GParamSpec *pspec, GObject *self)
+/**
+ * gdata_service_get_compress_requests:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:compress-requests property.
+ *
+ * Return value: %TRUE if large request bodies are compressed, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_service_get_compress_requests (GDataService *self)
 {
-	g_object_notify (self, "proxy-uri");
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
+	return (g_atomic_int_get (&(self->priv->compress_requests)) != 0) ? TRUE : FALSE;
 }
 
-/* Static function which isn't deprecated so we can continue using it internally. */
-static SoupURI *
-_get_proxy_uri (GDataService *self)
+/**
+ * gdata_service_set_compress_requests:
+ * @self: a #GDataService
+ * @compress_requests: %TRUE to compress large request bodies, %FALSE otherwise
+ *
+ * Sets the #GDataService:compress-requests property.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_compress_requests (GDataService *self, gboolean compress_requests)
 {
-	SoupURI *proxy_uri;
-
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-
-	g_object_get (self->priv->session, SOUP_SESSION_PROXY_URI, &proxy_uri, NULL);
-	g_object_unref (proxy_uri); /* remove the ref added by g_object_get */
+	g_return_if_fail (GDATA_IS_SERVICE (self));
 
-	return proxy_uri;
+	g_atomic_int_set (&(self->priv->compress_requests), (compress_requests == TRUE) ? 1 : 0);
+	g_object_notify (G_OBJECT (self), "compress-requests");
 }
 
 /**
- * gdata_service_get_proxy_uri:
+ * gdata_service_get_share_queries:
  * @self: a #GDataService
  *
- * Gets the proxy URI on the #GDataService's #SoupSession.
+ * Gets the #GDataService:share-queries property.
  *
- * Return value: (transfer none): the proxy URI, or %NULL
+ * Return value: %TRUE if identical concurrent queries share a response, %FALSE otherwise
  *
- * Since: 0.2.0
- * Deprecated: Use gdata_service_get_proxy_resolver() instead, which gives more flexibility over the proxy used. (Since: 0.15.0.)
+ * Since: 0.15.0
  **/
-SoupURI *
-gdata_service_get_proxy_uri (GDataService *self)
+gboolean
+gdata_service_get_share_queries (GDataService *self)
 {
-	return _get_proxy_uri (self);
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), FALSE);
+	return (g_atomic_int_get (&(self->priv->share_queries)) != 0) ? TRUE : FALSE;
 }
 
-/* Static function which isn't deprecated so we can continue using it internally. */
-static void
-_set_proxy_uri (GDataService *self, SoupURI *proxy_uri)
+/**
+ * gdata_service_set_share_queries:
+ * @self: a #GDataService
+ * @share_queries: %TRUE to let identical concurrent queries share a response, %FALSE otherwise
+ *
+ * Sets the #GDataService:share-queries property. Queries which are already waiting for a shared response are unaffected.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_share_queries (GDataService *self, gboolean share_queries)
 {
 	g_return_if_fail (GDATA_IS_SERVICE (self));
-	g_object_set (self->priv->session, SOUP_SESSION_PROXY_URI, proxy_uri, NULL);
-	g_object_notify (G_OBJECT (self), "proxy-uri");
+
+	g_atomic_int_set (&(self->priv->share_queries), (share_queries == TRUE) ? 1 : 0);
+	g_object_notify (G_OBJECT (self), "share-queries");
 }
 
 /**
- * gdata_service_set_proxy_uri:
+ * gdata_service_get_max_error_response_size:
  * @self: a #GDataService
- * @proxy_uri: (allow-none): the proxy URI, or %NULL
  *
- * Sets the proxy URI on the #SoupSession used internally by the given #GDataService.
- * This forces all requests through the given proxy.
+ * Gets the #GDataService:max-error-response-size property.
  *
- * If @proxy_uri is %NULL, no proxy will be used.
+ * Return value: the maximum number of bytes of an error response body to keep, or <code class="literal">0</code> for no limit
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_service_get_max_error_response_size (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	return (guint) g_atomic_int_get (&(self->priv->max_error_response_size));
+}
+
+/**
+ * gdata_service_set_max_error_response_size:
+ * @self: a #GDataService
+ * @max_error_response_size: the maximum number of bytes of an error response body to keep, or <code class="literal">0</code> for no limit
  *
- * Note that if a #GDataAuthorizer is being used with this #GDataService, the authorizer might also need its proxy URI setting.
+ * Sets the #GDataService:max-error-response-size property.
  *
- * Since: 0.2.0
- * Deprecated: Use gdata_service_set_proxy_resolver() instead, which gives more flexibility over the proxy used. (Since: 0.15.0.)
+ * Since: 0.15.0
  **/
 void
-gdata_service_set_proxy_uri (GDataService *self, SoupURI *proxy_uri)
+gdata_service_set_max_error_response_size (GDataService *self, guint max_error_response_size)
 {
-	_set_proxy_uri (self, proxy_uri);
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (max_error_response_size <= G_MAXINT);
+
+	g_atomic_int_set (&(self->priv->max_error_response_size), (gint) max_error_response_size);
+	g_object_notify (G_OBJECT (self), "max-error-response-size");
 }
 
-/**
- * gdata_service_get_proxy_resolver:
- * @self: a #GDataService
- *
- * Gets the #GProxyResolver on the #GDataService's #SoupSession.
+/*
+ * _gdata_service_append_compressed:
+ * @compressor: a #GZlibCompressor
+ * @body: the #SoupMessageBody to append to
+ * @data: the data to compress
+ * @length: the length of @data, in bytes
+ * @at_end: %TRUE if @data is the end of the body, %FALSE otherwise
  *
- * Return value: (transfer none) (allow-none): a #GProxyResolver, or %NULL
+ * Compresses @data using @compressor and appends the result to @body. If @at_end is %FALSE, the compressor is flushed, so that everything
+ * written so far can be decompressed as soon as it's been sent; this means that bodies which are streamed a piece at a time (using chunked
+ * encoding) never append an empty chunk, which would end the body. If @at_end is %TRUE, the compressed stream is finished.
  *
  * Since: 0.15.0
  */
-GProxyResolver *
-gdata_service_get_proxy_resolver (GDataService *self)
+void
+_gdata_service_append_compressed (GConverter *compressor, SoupMessageBody *body, const gchar *data, gsize length, gboolean at_end)
 {
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	GByteArray *output;
+	GConverterResult result;
+	gsize bytes_read, bytes_written, output_length;
+	GError *error = NULL;
+
+	output = g_byte_array_new ();
+
+	do {
+		guint old_length = output->len;
+
+		/* Make space for more output; zlib rarely needs more than a small fraction of the input size for text */
+		g_byte_array_set_size (output, old_length + MAX (length / 4, 1024));
+
+		result = g_converter_convert (compressor, data, length, output->data + old_length, output->len - old_length,
+		                              (at_end == TRUE) ? G_CONVERTER_INPUT_AT_END : G_CONVERTER_FLUSH, &bytes_read, &bytes_written, &error);
+
+		if (result == G_CONVERTER_ERROR) {
+			bytes_read = bytes_written = 0;
+
+			/* Just loop round with a bigger buffer if the output didn't fit */
+			if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE) == FALSE) {
+				g_warning ("Error compressing request body: %s", error->message);
+				g_error_free (error);
+				g_byte_array_set_size (output, old_length);
+				break;
+			}
+
+			g_clear_error (&error);
+		}
+
+		g_byte_array_set_size (output, old_length + bytes_written);
+		data += bytes_read;
+		length -= bytes_read;
+	} while (result == G_CONVERTER_CONVERTED || result == G_CONVERTER_ERROR);
 
-	return self->priv->proxy_resolver;
+	output_length = output->len;
+	if (output_length > 0)
+		soup_message_body_append (body, SOUP_MEMORY_TAKE, g_byte_array_free (output, FALSE), output_length);
+	else
+		g_byte_array_free (output, TRUE);
 }
 
-/**
- * gdata_service_set_proxy_resolver:
- * @self: a #GDataService
- * @proxy_resolver: (allow-none): a #GProxyResolver, or %NULL
- *
- * Sets the #GProxyResolver on the #SoupSession used internally by the given #GDataService.
+static void
+append_request_xml_cb (const gchar *data, gsize length, SoupMessageBody *body)
+{
+	soup_message_body_append (body, SOUP_MEMORY_COPY, data, length);
+}
+
+/*
+ * _gdata_service_set_request_xml:
+ * @message: the #SoupMessage to set the request body of
+ * @parsable: the #GDataParsable to serialise
+ * @use_original_xml: %TRUE to send the XML @parsable was parsed from if it's unmodified, %FALSE to always build it afresh
  *
- * Setting this will clear the #GDataService:proxy-uri property.
+ * Sets the request body of @message to the stand-alone XML for @parsable, with an XML declaration and an <literal>application/atom+xml</literal>
+ * content type. The XML is written straight into the body a chunk at a time using _gdata_parsable_write_xml(), rather than being built in one
+ * string first, so large entries don't need a second full-size buffer (and all the reallocations of growing it).
  *
  * Since: 0.15.0
  */
 void
-gdata_service_set_proxy_resolver (GDataService *self, GProxyResolver *proxy_resolver)
+_gdata_service_set_request_xml (SoupMessage *message, GDataParsable *parsable, gboolean use_original_xml)
 {
-	g_return_if_fail (GDATA_IS_SERVICE (self));
-	g_return_if_fail (proxy_resolver == NULL || G_IS_PROXY_RESOLVER (proxy_resolver));
+	static const gchar declaration[] = "<?xml version='1.0' encoding='UTF-8'?>";
 
-	if (proxy_resolver != NULL) {
-		g_object_ref (proxy_resolver);
-	}
+	soup_message_headers_replace (message->request_headers, "Content-Type", "application/atom+xml");
+	soup_message_body_truncate (message->request_body);
+	soup_message_body_append (message->request_body, SOUP_MEMORY_STATIC, declaration, sizeof (declaration) - 1);
 
-	g_clear_object (&self->priv->proxy_resolver);
-	self->priv->proxy_resolver = proxy_resolver;
+	_gdata_parsable_write_xml (parsable, use_original_xml, (GDataParsableXmlSinkFunc) append_request_xml_cb, message->request_body);
+}
 
-	g_object_notify (G_OBJECT (self), "proxy-resolver");
+GDataBandwidthLimiter *
+_gdata_service_get_upload_bandwidth_limiter (GDataService *self)
+{
+	return self->priv->upload_bandwidth_limiter;
 }
 
-static void
-notify_timeout_cb (GObject *gobject, GParamSpec *pspec, GObject *self)
+GDataBandwidthLimiter *
+_gdata_service_get_download_bandwidth_limiter (GDataService *self)
 {
-	g_object_notify (self, "timeout");
+	return self->priv->download_bandwidth_limiter;
+}
+
+/* Returns the service's shared I/O loop, starting it if this is the first time it's been needed, or %NULL if its thread couldn't be created. The loop
+ * lives as long as the service. */
+GDataIOLoop *
+_gdata_service_get_io_loop (GDataService *self, GError **error)
+{
+	GDataIOLoop *io_loop;
+
+	g_mutex_lock (&(self->priv->config_mutex));
+
+	if (self->priv->io_loop == NULL)
+		self->priv->io_loop = gdata_io_loop_new (error);
+	io_loop = self->priv->io_loop;
+
+	g_mutex_unlock (&(self->priv->config_mutex));
+
+	return io_loop;
 }
 
 /**
- * gdata_service_get_timeout:
+ * gdata_service_get_rate_limit:
  * @self: a #GDataService
+ * @domain: (allow-none): the authorization domain to get the rate limit for, or %NULL to get the service-wide rate limit
+ * @burst: (out caller-allocates) (allow-none): return location for the maximum burst size, or %NULL
  *
- * Gets the #GDataService:timeout property; the network timeout, in seconds.
+ * Gets the rate limit set for requests in @domain (or for all the service's requests) using gdata_service_set_rate_limit().
  *
- * Return value: the timeout, or <code class="literal">0</code>
+ * Return value: the maximum number of requests per second, or <code class="literal">0</code> if there's no limit
  *
- * Since: 0.7.0
+ * Since: 0.15.0
  **/
-guint
-gdata_service_get_timeout (GDataService *self)
+gdouble
+gdata_service_get_rate_limit (GDataService *self, GDataAuthorizationDomain *domain, guint *burst)
 {
-	guint timeout;
+	GDataRateLimiter *limiter;
 
-	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0);
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), 0.0);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), 0.0);
 
-	g_object_get (self->priv->session, SOUP_SESSION_TIMEOUT, &timeout, NULL);
+	if (domain == NULL) {
+		limiter = self->priv->user_rate_limiter;
+	} else {
+		g_mutex_lock (&(self->priv->rate_limiters_mutex));
+		limiter = g_hash_table_lookup (self->priv->domain_rate_limiters, domain);
+		g_mutex_unlock (&(self->priv->rate_limiters_mutex));
+	}
 
-	return timeout;
+	if (limiter == NULL) {
+		if (burst != NULL)
+			*burst = 1;
+		return 0.0;
+	}
+
+	return gdata_rate_limiter_get_rate (limiter, burst);
 }
 
 /**
- * gdata_service_set_timeout:
+ * gdata_service_set_rate_limit:
  * @self: a #GDataService
- * @timeout: the timeout, or <code class="literal">0</code>
+ * @domain: (allow-none): the authorization domain to limit requests in, or %NULL to limit all the service's requests
+ * @requests_per_second: the maximum number of requests to send per second, or <code class="literal">0</code> for no limit
+ * @burst: the maximum number of requests which may be sent back-to-back after a period of inactivity
  *
- * Sets the #GDataService:timeout property; the network timeout, in seconds.
+ * Limits the rate at which requests in @domain (or, if @domain is %NULL, all of the service's requests) are sent, so that they stay within the
+ * server's quotas. Google's quotas typically apply per user and per project, so the service-wide limit should be set to the per-user quota for the
+ * service's API, and per-domain limits used for any stricter quotas. Both limits apply to requests in a domain which has its own limit.
  *
- * If @timeout is <code class="literal">0</code>, network operations will never time out.
+ * Requests which would exceed a limit are queued until they may be sent, rather than failed, so operations may take longer to complete; they can
+ * still be cancelled while queued. If the server responds to a rate-limited request by asking for requests to be slowed down (with a 429 Too Many
+ * Requests or 503 Service Unavailable status, or a 403 Forbidden status with a <literal>rateLimitExceeded</literal> reason), the request is queued
+ * and sent again, up to a few times. The rate is also reduced (down to a small fraction of @requests_per_second) and then gradually increased
+ * again as requests succeed, so that the rate settles just under the server's actual quota.
  *
- * Note that if a #GDataAuthorizer is being used with this #GDataService, the authorizer might also need its timeout setting.
+ * By default, there are no rate limits, and throttling responses are returned as errors as normal. Setting a rate limit resets any adaptation
+ * of the rate to throttling responses.
  *
- * Since: 0.7.0
+ * Since: 0.15.0
  **/
 void
-gdata_service_set_timeout (GDataService *self, guint timeout)
+gdata_service_set_rate_limit (GDataService *self, GDataAuthorizationDomain *domain, gdouble requests_per_second, guint burst)
 {
+	GDataRateLimiter *limiter;
+
 	g_return_if_fail (GDATA_IS_SERVICE (self));
-	g_object_set (self->priv->session, SOUP_SESSION_TIMEOUT, timeout, NULL);
-	g_object_notify (G_OBJECT (self), "timeout");
+	g_return_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain));
+	g_return_if_fail (requests_per_second >= 0.0);
+
+	if (domain == NULL) {
+		limiter = self->priv->user_rate_limiter;
+	} else {
+		g_mutex_lock (&(self->priv->rate_limiters_mutex));
+
+		limiter = g_hash_table_lookup (self->priv->domain_rate_limiters, domain);
+		if (limiter == NULL) {
+			limiter = gdata_rate_limiter_new ();
+			g_hash_table_insert (self->priv->domain_rate_limiters, g_object_ref (domain), limiter);
+		}
+
+		g_mutex_unlock (&(self->priv->rate_limiters_mutex));
+	}
+
+	gdata_rate_limiter_set_rate (limiter, requests_per_second, burst);
+}
+
+/**
+ * gdata_service_get_session:
+ * @self: a #GDataService
+ *
+ * Gets the #GDataService:session property; the #SoupSession which the service sends its requests over. This can be passed as the
+ * #GDataService:session property of other services so that they share its connections.
+ *
+ * Return value: (transfer none): the service's #SoupSession
+ *
+ * Since: 0.15.0
+ */
+SoupSession *
+gdata_service_get_session (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	return self->priv->session;
 }
 
 SoupSession *
@@ -2065,197 +9642,412 @@ _gdata_service_build_uri (const gchar *format, ...)
 		}
 	}
 
-	va_end (args);
+	va_end (args);
+
+	/* Fix the scheme to always be HTTPS */
+	fixed_uri = _gdata_service_fix_uri_scheme (uri->str);
+	g_string_free (uri, TRUE);
+
+	return fixed_uri;
+}
+
+/**
+ * _gdata_service_fix_uri_scheme:
+ * @uri: an URI with either HTTP or HTTPS as the scheme
+ *
+ * Fixes the given URI to always have HTTPS as its scheme.
+ *
+ * Return value: (transfer full): the URI with HTTPS as its scheme
+ *
+ * Since: 0.9.0
+ */
+gchar *
+_gdata_service_fix_uri_scheme (const gchar *uri)
+{
+	g_return_val_if_fail (uri != NULL && *uri != '\0', NULL);
+
+	/* Ensure we're using the correct scheme (HTTP or HTTPS) */
+	if (g_str_has_prefix (uri, "https") == FALSE) {
+		gchar *fixed_uri, **pieces;
+
+		pieces = g_strsplit (uri, ":", 2);
+		g_assert (pieces[0] != NULL && pieces[1] != NULL && pieces[2] == NULL);
+
+		fixed_uri = g_strconcat ("https:", pieces[1], NULL);
+
+		g_strfreev (pieces);
+
+		return fixed_uri;
+	}
+
+	return g_strdup (uri);
+}
+
+/**
+ * _gdata_service_get_https_port:
+ *
+ * Gets the destination TCP/IP port number which libgdata should use for all outbound HTTPS traffic.
+ * This defaults to 443, but may be overridden using the <code class="literal">LIBGDATA_HTTPS_PORT</code>
+ * environment variable. This is intended to allow network traffic to be redirected to a local server for
+ * unit testing, with a listening port above 1024 so the tests don't need root privileges.
+ *
+ * The value returned by this function may change at any time (e.g. between unit tests), so callers must not cache the result.
+ *
+ * Return value: port number to use for HTTPS traffic
+ */
+guint
+_gdata_service_get_https_port (void)
+{
+	const gchar *port_string;
+
+	/* Allow changing the HTTPS port just for testing. */
+	port_string = g_getenv ("LIBGDATA_HTTPS_PORT");
+	if (port_string != NULL) {
+		const gchar *end;
+
+		guint64 port = g_ascii_strtoull (port_string, (gchar **) &end, 10);
+
+		if (port != 0 && *end == '\0') {
+			g_debug ("Overriding message port to %" G_GUINT64_FORMAT ".", port);
+			return port;
+		}
+	}
+
+	/* Return the default. */
+	return 443;
+}
+
+/*
+ * debug_handler:
+ *
+ * GLib debug message handler, which is passed all messages from g_debug() calls, and decides whether to print them.
+ */
+static void
+debug_handler (const char *log_domain, GLogLevelFlags log_level, const char *message, gpointer user_data)
+{
+	if (_gdata_service_get_log_level () != GDATA_LOG_NONE)
+		g_log_default_handler (log_domain, log_level, message, NULL);
+}
+
+/* Redaction rules for soup_log_printer(). Each rule matches lines in one direction which start with a given prefix, and says what to replace. */
+typedef enum {
+	REDACT_VALUE, /* replace everything after the prefix */
+	REDACT_FORM_FIELDS, /* replace the values of the given fields in a form-encoded line */
+	REDACT_URI_QUERY, /* replace the values of the given fields in the query string of the URI after the prefix */
+} RedactionType;
+
+typedef struct {
+	gchar direction;
+	const gchar *prefix;
+	gsize prefix_length;
+	RedactionType type;
+	const gchar * const *fields;
+} RedactionRule;
+
+#define REDACTION_RULE(D, P, T, F) { D, P, sizeof (P) - 1, T, F }
+
+static const gchar * const location_fields[] = { "gsessionid", NULL };
+static const gchar * const client_login_fields[] = { "Email", "Passwd", NULL };
+static const gchar * const oauth_token_fields[] = { "oauth_token", "oauth_token_secret", NULL };
+
+static const RedactionRule redaction_rules[] = {
+	REDACTION_RULE ('>', "Authorization: GoogleLogin ", REDACT_VALUE, NULL),
+	REDACTION_RULE ('>', "Authorization: OAuth ", REDACT_VALUE, NULL),
+	REDACTION_RULE ('<', "Set-Cookie: ", REDACT_VALUE, NULL),
+	/* Looks like: "Location: https://www.google.com/calendar/feeds/default/owncalendars/full?gsessionid=sBjmp05m5i67exYA51XjDA". */
+	REDACTION_RULE ('<', "Location: ", REDACT_URI_QUERY, location_fields),
+	REDACTION_RULE ('<', "SID=", REDACT_VALUE, NULL),
+	REDACTION_RULE ('<', "LSID=", REDACT_VALUE, NULL),
+	REDACTION_RULE ('<', "Auth=", REDACT_VALUE, NULL),
+	/* Looks like: "> accountType=HOSTED%5FOR%5FGOOGLE&Email=[e-mail address]&Passwd=[plaintex password]"
+	 *             "&service=[service name]&source=ytapi%2DGNOME%2Dlibgdata%2D444fubtt%2D0". */
+	REDACTION_RULE ('>', "accountType=", REDACT_FORM_FIELDS, client_login_fields),
+	/* Looks like: "< oauth_token=4%2FI-WU7sBzKk5GhGlQUF8a_TCZRnb7&oauth_token_secret=qTTTJg3no25auiiWFerzjW4I"
+	 *             "&oauth_callback_confirmed=true". */
+	REDACTION_RULE ('<', "oauth_token=", REDACT_FORM_FIELDS, oauth_token_fields),
+	/* Looks like: "> X-GData-Key: key=[dev key in hex]". */
+	REDACTION_RULE ('>', "X-GData-Key: key=", REDACT_VALUE, NULL),
+};
+
+G_STATIC_ASSERT (G_N_ELEMENTS (redaction_rules) <= 16);
+
+/* For each direction ('>' is 0 and '<' is 1) and each possible first byte of a line, a bitmask of the rules which could match. Almost all lines (in
+ * particular, body lines) start with a byte which no rule matches, so can be logged with a single table lookup. */
+static guint16 redaction_index[2][256];
+
+static gpointer
+build_redaction_index (gpointer user_data)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (redaction_rules); i++) {
+		const RedactionRule *rule = &redaction_rules[i];
+		redaction_index[(rule->direction == '<') ? 1 : 0][(guint8) rule->prefix[0]] |= 1 << i;
+	}
+
+	return NULL;
+}
+
+static gboolean
+is_redacted_field (const gchar *name, gsize name_length, const gchar * const *fields)
+{
+	for (; *fields != NULL; fields++) {
+		if (strncmp (name, *fields, name_length) == 0 && (*fields)[name_length] == '\0')
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Append the first @length bytes of the form-encoded @form to @out, replacing the values of any of @fields with "<redacted>". The order of the
+ * fields is preserved. */
+static void
+append_redacted_form (GString *out, const gchar *form, gsize length, const gchar * const *fields)
+{
+	const gchar *end = form + length;
+
+	while (form < end) {
+		const gchar *pair_end, *equals;
+
+		pair_end = memchr (form, '&', end - form);
+		if (pair_end == NULL)
+			pair_end = end;
+
+		equals = memchr (form, '=', pair_end - form);
+		if (equals != NULL && is_redacted_field (form, equals - form, fields) == TRUE) {
+			g_string_append_len (out, form, equals - form + 1);
+			g_string_append (out, "<redacted>");
+		} else {
+			g_string_append_len (out, form, pair_end - form);
+		}
+
+		if (pair_end < end)
+			g_string_append_c (out, '&');
+		form = pair_end + 1;
+	}
+}
+
+/* Redact @data into @out according to @rule, which is known to match it. */
+static void
+apply_redaction_rule (const RedactionRule *rule, const gchar *data, GString *out)
+{
+	switch (rule->type) {
+		case REDACT_VALUE:
+			g_string_append_len (out, data, rule->prefix_length);
+			g_string_append (out, "<redacted>");
+			break;
+		case REDACT_FORM_FIELDS:
+			append_redacted_form (out, data, strlen (data), rule->fields);
+			break;
+		case REDACT_URI_QUERY: {
+			const gchar *query, *query_end;
+
+			query = strchr (data + rule->prefix_length, '?');
+			if (query == NULL) {
+				g_string_append (out, data);
+				break;
+			}
+
+			query++;
+			query_end = query + strcspn (query, "#");
+
+			g_string_append_len (out, data, query - data);
+			append_redacted_form (out, query, query_end - query, rule->fields);
+			g_string_append (out, query_end);
+			break;
+		}
+		default:
+			g_assert_not_reached ();
+	}
+}
+
+static void
+free_scratch_string (GString *scratch)
+{
+	g_string_free (scratch, TRUE);
+}
+
+/* Per-thread scratch string for building log lines in, so that once it's grown to the longest line, logging a line doesn't allocate. */
+static GPrivate log_scratch_string = G_PRIVATE_INIT ((GDestroyNotify) free_scratch_string);
+
+static GString *
+get_scratch_string (void)
+{
+	GString *scratch = g_private_get (&log_scratch_string);
+
+	if (scratch == NULL) {
+		scratch = g_string_sized_new (256);
+		g_private_set (&log_scratch_string, scratch);
+	}
+
+	g_string_truncate (scratch, 0);
+
+	return scratch;
+}
+
+/*
+ * Asynchronous log sink. If LIBGDATA_DEBUG_ASYNC=1, soup_log_printer() copies each line into a fixed-size ring buffer, and a separate thread passes
+ * them on to g_debug(). This means that the I/O threads never block writing to the terminal or log file. If the ring fills up, lines are dropped
+ * (and a count of them is logged) rather than blocking. Each record in the ring is a direction byte, a #guint32 length, then the line itself.
+ */
+#define LOG_SINK_SIZE (1 << 20)
+#define LOG_SINK_HEADER_SIZE (1 + sizeof (guint32))
 
-	/* Fix the scheme to always be HTTPS */
-	fixed_uri = _gdata_service_fix_uri_scheme (uri->str);
-	g_string_free (uri, TRUE);
+typedef struct {
+	GMutex mutex;
+	GCond cond;
+	gchar *ring;
+	gsize head; /* total bytes ever read; protected by mutex */
+	gsize tail; /* total bytes ever written; protected by mutex */
+	guint dropped; /* lines dropped since the last one was logged; protected by mutex */
+} LogSink;
 
-	return fixed_uri;
+static LogSink *log_sink = NULL;
+
+static void
+log_sink_copy_in (LogSink *sink, gconstpointer data, gsize length)
+{
+	gsize offset = sink->tail % LOG_SINK_SIZE, first = MIN (length, LOG_SINK_SIZE - offset);
+
+	memcpy (sink->ring + offset, data, first);
+	memcpy (sink->ring, (const gchar*) data + first, length - first);
+	sink->tail += length;
 }
 
-/**
- * _gdata_service_fix_uri_scheme:
- * @uri: an URI with either HTTP or HTTPS as the scheme
- *
- * Fixes the given URI to always have HTTPS as its scheme.
- *
- * Return value: (transfer full): the URI with HTTPS as its scheme
- *
- * Since: 0.9.0
- */
-gchar *
-_gdata_service_fix_uri_scheme (const gchar *uri)
+static void
+log_sink_copy_out (LogSink *sink, gpointer data, gsize length)
 {
-	g_return_val_if_fail (uri != NULL && *uri != '\0', NULL);
+	gsize offset = sink->head % LOG_SINK_SIZE, first = MIN (length, LOG_SINK_SIZE - offset);
 
-	/* Ensure we're using the correct scheme (HTTP or HTTPS) */
-	if (g_str_has_prefix (uri, "https") == FALSE) {
-		gchar *fixed_uri, **pieces;
+	memcpy (data, sink->ring + offset, first);
+	memcpy ((gchar*) data + first, sink->ring, length - first);
+	sink->head += length;
+}
 
-		pieces = g_strsplit (uri, ":", 2);
-		g_assert (pieces[0] != NULL && pieces[1] != NULL && pieces[2] == NULL);
+static gpointer
+log_sink_thread (LogSink *sink)
+{
+	GString *line = get_scratch_string ();
 
-		fixed_uri = g_strconcat ("https:", pieces[1], NULL);
+	while (TRUE) {
+		gchar direction;
+		guint32 length;
+		guint dropped;
 
-		g_strfreev (pieces);
+		g_mutex_lock (&(sink->mutex));
 
-		return fixed_uri;
+		while (sink->head == sink->tail)
+			g_cond_wait (&(sink->cond), &(sink->mutex));
+
+		log_sink_copy_out (sink, &direction, 1);
+		log_sink_copy_out (sink, &length, sizeof (length));
+		g_string_set_size (line, length);
+		log_sink_copy_out (sink, line->str, length);
+
+		dropped = sink->dropped;
+		sink->dropped = 0;
+
+		g_mutex_unlock (&(sink->mutex));
+
+		if (dropped > 0)
+			g_debug ("Dropped %u network log lines because the log sink was full.", dropped);
+
+		g_debug ("%c %s", direction, line->str);
 	}
 
-	return g_strdup (uri);
+	return NULL;
 }
 
-/**
- * _gdata_service_get_https_port:
- *
- * Gets the destination TCP/IP port number which libgdata should use for all outbound HTTPS traffic.
- * This defaults to 443, but may be overridden using the <code class="literal">LIBGDATA_HTTPS_PORT</code>
- * environment variable. This is intended to allow network traffic to be redirected to a local server for
- * unit testing, with a listening port above 1024 so the tests don't need root privileges.
- *
- * The value returned by this function may change at any time (e.g. between unit tests), so callers must not cache the result.
- *
- * Return value: port number to use for HTTPS traffic
- */
-guint
-_gdata_service_get_https_port (void)
+static gpointer
+build_log_sink (gpointer user_data)
 {
-	const gchar *port_string;
+	LogSink *sink;
 
-	/* Allow changing the HTTPS port just for testing. */
-	port_string = g_getenv ("LIBGDATA_HTTPS_PORT");
-	if (port_string != NULL) {
-		const gchar *end;
+	if (g_strcmp0 (g_getenv ("LIBGDATA_DEBUG_ASYNC"), "1") != 0)
+		return NULL;
 
-		guint64 port = g_ascii_strtoull (port_string, (gchar **) &end, 10);
+	sink = g_new0 (LogSink, 1);
+	g_mutex_init (&(sink->mutex));
+	g_cond_init (&(sink->cond));
+	sink->ring = g_malloc (LOG_SINK_SIZE);
 
-		if (port != 0 && *end == '\0') {
-			g_debug ("Overriding message port to %" G_GUINT64_FORMAT ".", port);
-			return port;
-		}
-	}
+	/* The thread runs for the lifetime of the process, so is never joined. */
+	g_thread_unref (g_thread_new ("gdata-log-sink", (GThreadFunc) log_sink_thread, sink));
 
-	/* Return the default. */
-	return 443;
+	g_atomic_pointer_set (&log_sink, sink);
+
+	return NULL;
 }
 
-/*
- * debug_handler:
- *
- * GLib debug message handler, which is passed all messages from g_debug() calls, and decides whether to print them.
- */
+/* Log a network log line, either directly or through the asynchronous sink. */
 static void
-debug_handler (const char *log_domain, GLogLevelFlags log_level, const char *message, gpointer user_data)
+log_network_line (gchar direction, const gchar *data, gsize length)
 {
-	if (_gdata_service_get_log_level () != GDATA_LOG_NONE)
-		g_log_default_handler (log_domain, log_level, message, NULL);
+	LogSink *sink = g_atomic_pointer_get (&log_sink);
+	guint32 _length = length;
+
+	if (sink == NULL) {
+		g_debug ("%c %s", direction, data);
+		return;
+	}
+
+	g_mutex_lock (&(sink->mutex));
+
+	if (LOG_SINK_SIZE - (sink->tail - sink->head) < LOG_SINK_HEADER_SIZE + length) {
+		sink->dropped++;
+	} else {
+		log_sink_copy_in (sink, &direction, 1);
+		log_sink_copy_in (sink, &_length, sizeof (_length));
+		log_sink_copy_in (sink, data, length);
+		g_cond_signal (&(sink->cond));
+	}
+
+	g_mutex_unlock (&(sink->mutex));
 }
 
 /*
  * soup_log_printer:
  *
  * Log printer for the libsoup logging functionality, which just marshals all soup log output to the standard GLib logging framework
- * (and thus to debug_handler(), above).
+ * (and thus to debug_handler(), above), possibly via the asynchronous log sink.
+ *
+ * This is called on the I/O thread for every header and body line, so it avoids allocating: lines are matched against the redaction rules using
+ * redaction_index, and only lines which need redacting are copied (into a per-thread scratch string).
  */
 static void
 soup_log_printer (SoupLogger *logger, SoupLoggerLogLevel level, char direction, const char *data, gpointer user_data)
 {
-	gboolean filter_data;
-	gchar *_data = NULL;
-
-	filter_data = (_gdata_service_get_log_level () > GDATA_LOG_NONE && _gdata_service_get_log_level () < GDATA_LOG_FULL_UNREDACTED) ? TRUE : FALSE;
-
-	if (filter_data == TRUE) {
-		/* Filter out lines which look like they might contain usernames, passwords or auth. tokens. */
-		if (direction == '>' && g_str_has_prefix (data, "Authorization: GoogleLogin ") == TRUE) {
-			_data = g_strdup ("Authorization: GoogleLogin <redacted>");
-		} else if (direction == '>' && g_str_has_prefix (data, "Authorization: OAuth ") == TRUE) {
-			_data = g_strdup ("Authorization: OAuth <redacted>");
-		} else if (direction == '<' && g_str_has_prefix (data, "Set-Cookie: ") == TRUE) {
-			_data = g_strdup ("Set-Cookie: <redacted>");
-		} else if (direction == '<' && g_str_has_prefix (data, "Location: ") == TRUE) {
-			/* Looks like:
-			 * "Location: https://www.google.com/calendar/feeds/default/owncalendars/full?gsessionid=sBjmp05m5i67exYA51XjDA". */
-			SoupURI *uri;
-			gchar *_uri;
-			GHashTable *params;
-
-			uri = soup_uri_new (data + strlen ("Location: "));
-
-			if (uri->query != NULL) {
-				params = soup_form_decode (uri->query);
-
-				/* strdup()s are necessary because the hash table's set up to free keys. */
-				if (g_hash_table_lookup (params, "gsessionid") != NULL) {
-					g_hash_table_insert (params, (gpointer) g_strdup ("gsessionid"), (gpointer) "<redacted>");
-				}
-
-				soup_uri_set_query_from_form (uri, params);
-				g_hash_table_destroy (params);
-			}
+	static GOnce index_once = G_ONCE_INIT;
+	guint16 candidates;
+	guint i;
+
+	/* Don't filter anything if we're meant to be logging everything */
+	if (_gdata_service_get_log_level () <= GDATA_LOG_NONE || _gdata_service_get_log_level () >= GDATA_LOG_FULL_UNREDACTED ||
+	    (direction != '>' && direction != '<')) {
+		log_network_line (direction, data, strlen (data));
+		return;
+	}
 
-			_uri = soup_uri_to_string (uri, FALSE);
-			_data = g_strconcat ("Location: ", _uri, NULL);
-			g_free (_uri);
-
-			soup_uri_free (uri);
-		} else if (direction == '<' && g_str_has_prefix (data, "SID=") == TRUE) {
-			_data = g_strdup ("SID=<redacted>");
-		} else if (direction == '<' && g_str_has_prefix (data, "LSID=") == TRUE) {
-			_data = g_strdup ("LSID=<redacted>");
-		} else if (direction == '<' && g_str_has_prefix (data, "Auth=") == TRUE) {
-			_data = g_strdup ("Auth=<redacted>");
-		} else if (direction == '>' && g_str_has_prefix (data, "accountType=") == TRUE) {
-			/* Looks like: "> accountType=HOSTED%5FOR%5FGOOGLE&Email=[e-mail address]&Passwd=[plaintex password]"
-			               "&service=[service name]&source=ytapi%2DGNOME%2Dlibgdata%2D444fubtt%2D0". */
-			GHashTable *params = soup_form_decode (data);
-
-			/* strdup()s are necessary because the hash table's set up to free keys. */
-			if (g_hash_table_lookup (params, "Email") != NULL) {
-				g_hash_table_insert (params, (gpointer) g_strdup ("Email"), (gpointer) "<redacted>");
-			}
-			if (g_hash_table_lookup (params, "Passwd") != NULL) {
-				g_hash_table_insert (params, (gpointer) g_strdup ("Passwd"), (gpointer) "<redacted>");
-			}
+	g_once (&index_once, build_redaction_index, NULL);
 
-			_data = soup_form_encode_hash (params);
+	/* Filter out lines which look like they might contain usernames, passwords or auth. tokens. */
+	candidates = redaction_index[(direction == '<') ? 1 : 0][(guint8) data[0]];
 
-			g_hash_table_destroy (params);
-		} else if (direction == '<' && g_str_has_prefix (data, "oauth_token=") == TRUE) {
-			/* Looks like: "< oauth_token=4%2FI-WU7sBzKk5GhGlQUF8a_TCZRnb7&oauth_token_secret=qTTTJg3no25auiiWFerzjW4I"
-			               "&oauth_callback_confirmed=true". */
-			GHashTable *params = soup_form_decode (data);
+	for (i = 0; candidates != 0; i++, candidates >>= 1) {
+		const RedactionRule *rule = &redaction_rules[i];
 
-			/* strdup()s are necessary because the hash table's set up to free keys. */
-			if (g_hash_table_lookup (params, "oauth_token") != NULL) {
-				g_hash_table_insert (params, (gpointer) g_strdup ("oauth_token"), (gpointer) "<redacted>");
-			}
-			if (g_hash_table_lookup (params, "oauth_token_secret") != NULL) {
-				g_hash_table_insert (params, (gpointer) g_strdup ("oauth_token_secret"), (gpointer) "<redacted>");
-			}
+		if ((candidates & 1) != 0 && strncmp (data, rule->prefix, rule->prefix_length) == 0) {
+			GString *redacted = get_scratch_string ();
 
-			_data = soup_form_encode_hash (params);
+			apply_redaction_rule (rule, data, redacted);
+			log_network_line (direction, redacted->str, redacted->len);
 
-			g_hash_table_destroy (params);
-		} else if (direction == '>' && g_str_has_prefix (data, "X-GData-Key: key=") == TRUE) {
-			/* Looks like: "> X-GData-Key: key=[dev key in hex]". */
-			_data = g_strdup ("X-GData-Key: key=<redacted>");
-		} else {
-			/* Nothing to redact. */
-			_data = g_strdup (data);
+			return;
 		}
-	} else {
-		/* Don't dupe the string. */
-		_data = (gchar*) data;
 	}
 
-	/* Log the data. */
-	g_debug ("%c %s", direction, _data);
-
-	if (filter_data == TRUE) {
-		g_free (_data);
-	}
+	/* Nothing to redact. */
+	log_network_line (direction, data, strlen (data));
 }
 
 /**
@@ -2286,7 +10078,8 @@ _gdata_service_get_log_level (void)
  * _gdata_service_build_session:
  *
  * Build a new #SoupSession, enabling GNOME features if support has been compiled for them, and adding a log printer which is hooked into
- * libgdata's logging functionality.
+ * libgdata's logging functionality. Responses are requested with gzip or deflate compression, and transparently decompressed as they arrive, so
+ * that got-chunk handlers see the decompressed body.
  *
  * Return value: a new #SoupSession; unref with g_object_unref()
  *
@@ -2295,6 +10088,7 @@ _gdata_service_get_log_level (void)
 SoupSession *
 _gdata_service_build_session (void)
 {
+	static GOnce log_sink_once = G_ONCE_INIT;
 	SoupSession *session;
 	gboolean ssl_strict = TRUE;
 
@@ -2303,12 +10097,21 @@ _gdata_service_build_session (void)
 		ssl_strict = FALSE;
 	}
 
+	/* libsoup only allows two connections to each host by default, which limits the concurrent operations to two requests in flight at once. It
+	 * can't multiplex requests over a single connection (it doesn't support HTTP/2, and doesn't pipeline HTTP/1.1 requests), so allow as many
+	 * connections as browsers do instead. */
 	session = soup_session_new_with_options ("ssl-strict", ssl_strict,
 	                                         "timeout", 0,
+	                                         SOUP_SESSION_MAX_CONNS, DEFAULT_MAX_CONNECTIONS,
+	                                         SOUP_SESSION_MAX_CONNS_PER_HOST, DEFAULT_MAX_CONNECTIONS_PER_HOST,
 	                                         NULL);
 
 	soup_session_add_feature_by_type (session, SOUP_TYPE_PROXY_RESOLVER_DEFAULT);
 
+	/* Atom feeds compress very well, so have them sent compressed. This adds an Accept-Encoding header to every message, unless it's disabled
+	 * for the message using soup_message_disable_feature(). */
+	soup_session_add_feature_by_type (session, SOUP_TYPE_CONTENT_DECODER);
+
 	/* Log all libsoup traffic if debugging's turned on */
 	if (_gdata_service_get_log_level () > GDATA_LOG_MESSAGES) {
 		SoupLoggerLogLevel level;
@@ -2328,6 +10131,9 @@ _gdata_service_build_session (void)
 				g_assert_not_reached ();
 		}
 
+		/* Set up the asynchronous log sink, if it's been requested */
+		g_once (&log_sink_once, build_log_sink, NULL);
+
 		logger = soup_logger_new (level, -1);
 		soup_logger_set_printer (logger, (SoupLoggerPrinter) soup_log_printer, NULL, NULL);
 
@@ -2339,6 +10145,187 @@ _gdata_service_build_session (void)
 	return session;
 }
 
+/* An entry in the stack of callback contexts; see _gdata_service_push_callback_context() */
+typedef struct {
+	GMainContext *context;
+	GDataService *service;
+} CallbackContext;
+
+/* A stack of the main contexts which the callbacks of the asynchronous operations running in the current thread should be dispatched in, along with
+ * the services running the operations. The stack is always empty when a thread exits. */
+static GPrivate callback_contexts = G_PRIVATE_INIT ((GDestroyNotify) g_slist_free);
+
+/*
+ * _gdata_service_push_callback_context:
+ * @service: (allow-none): the #GDataService running the operation, or %NULL
+ * @context: (allow-none): the #GMainContext to dispatch callbacks in, or %NULL for the global default main context
+ *
+ * Makes @context the main context which the progress and completion callbacks of asynchronous operations are dispatched in (by
+ * _gdata_service_idle_add()) while the current thread runs an operation. This is used by the threads which run asynchronous operations, to dispatch
+ * their callbacks in the thread-default main context of the thread which started the operation, rather than always in the global default one.
+ * Progress callbacks dispatched in the meantime are counted in @service's gauges; see _gdata_service_progress_idle_add().
+ *
+ * Calls must be balanced with calls to _gdata_service_pop_callback_context().
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_service_push_callback_context (GDataService *service, GMainContext *context)
+{
+	GSList *contexts = g_private_get (&callback_contexts);
+	CallbackContext *callback_context;
+
+	callback_context = g_slice_new (CallbackContext);
+	callback_context->context = context;
+	callback_context->service = service;
+
+	g_private_set (&callback_contexts, g_slist_prepend (contexts, callback_context));
+}
+
+/*
+ * _gdata_service_pop_callback_context:
+ *
+ * Undoes the last call to _gdata_service_push_callback_context() in the current thread.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_service_pop_callback_context (void)
+{
+	GSList *contexts = g_private_get (&callback_contexts);
+
+	g_return_if_fail (contexts != NULL);
+
+	g_slice_free (CallbackContext, contexts->data);
+	g_private_set (&callback_contexts, g_slist_delete_link (contexts, contexts));
+}
+
+/*
+ * _gdata_service_get_callback_context:
+ *
+ * Gets the main context which was last pushed with _gdata_service_push_callback_context() in the current thread.
+ *
+ * Return value: (transfer none): the callback context, or %NULL for the global default main context
+ *
+ * Since: 0.15.0
+ */
+GMainContext *
+_gdata_service_get_callback_context (void)
+{
+	GSList *contexts = g_private_get (&callback_contexts);
+	return (contexts != NULL) ? ((CallbackContext*) contexts->data)->context : NULL;
+}
+
+/*
+ * _gdata_service_get_callback_service:
+ *
+ * Gets the service which was last pushed with _gdata_service_push_callback_context() in the current thread.
+ *
+ * Return value: (transfer none): the callback service, or %NULL
+ *
+ * Since: 0.15.0
+ */
+GDataService *
+_gdata_service_get_callback_service (void)
+{
+	GSList *contexts = g_private_get (&callback_contexts);
+	return (contexts != NULL) ? ((CallbackContext*) contexts->data)->service : NULL;
+}
+
+/*
+ * _gdata_service_idle_add:
+ * @context: (allow-none): the #GMainContext to dispatch @function in, or %NULL for the global default main context
+ * @function: the function to call
+ * @data: (closure): data to pass to @function
+ * @notify: (allow-none): function to call when the idle source is removed, or %NULL
+ *
+ * Equivalent to g_idle_add_full(), but attaches the idle source to @context rather than always to the global default main context. This should be
+ * used to dispatch the callbacks of asynchronous operations, normally with the context from _gdata_service_get_callback_context().
+ *
+ * The idle source has priority %G_PRIORITY_DEFAULT rather than %G_PRIORITY_DEFAULT_IDLE, to contend with the priorities used by the callback
+ * functions in #GAsyncResult, so that callbacks are dispatched before the operation's #GAsyncReadyCallback.
+ *
+ * Return value: the ID of the idle source within @context
+ *
+ * Since: 0.15.0
+ */
+guint
+_gdata_service_idle_add (GMainContext *context, GSourceFunc function, gpointer data, GDestroyNotify notify)
+{
+	GSource *source;
+	guint id;
+
+	source = g_idle_source_new ();
+	g_source_set_priority (source, G_PRIORITY_DEFAULT);
+	g_source_set_callback (source, function, data, notify);
+	id = g_source_attach (source, context);
+	g_source_unref (source);
+
+	return id;
+}
+
+typedef struct {
+	GDataService *service;
+	GSourceFunc function;
+	gpointer data;
+	GDestroyNotify notify;
+} ProgressDispatch;
+
+static gboolean
+progress_dispatch_cb (ProgressDispatch *dispatch)
+{
+	return dispatch->function (dispatch->data);
+}
+
+static void
+progress_dispatch_free (ProgressDispatch *dispatch)
+{
+	if (dispatch->notify != NULL)
+		dispatch->notify (dispatch->data);
+
+	g_atomic_int_add (&dispatch->service->priv->pending_progress_callbacks, -1);
+	g_object_unref (dispatch->service);
+
+	g_slice_free (ProgressDispatch, dispatch);
+}
+
+/*
+ * _gdata_service_progress_idle_add:
+ * @service: (allow-none): the #GDataService running the operation, or %NULL
+ * @context: (allow-none): the #GMainContext to dispatch @function in, or %NULL for the global default main context
+ * @function: the function to call
+ * @data: (closure): data to pass to @function
+ * @notify: (allow-none): function to call when the idle source is removed, or %NULL
+ *
+ * Equivalent to _gdata_service_idle_add(), but for dispatching progress callbacks: the dispatch is counted in the
+ * #GDataServiceGauges.pending_progress_callbacks gauge of @service (if it's non-%NULL) until the idle source is removed. @function must return
+ * %FALSE.
+ *
+ * Return value: the ID of the idle source within @context
+ *
+ * Since: 0.15.0
+ */
+guint
+_gdata_service_progress_idle_add (GDataService *service, GMainContext *context, GSourceFunc function, gpointer data, GDestroyNotify notify)
+{
+	ProgressDispatch *dispatch;
+
+	g_return_val_if_fail (service == NULL || GDATA_IS_SERVICE (service), 0);
+
+	if (service == NULL)
+		return _gdata_service_idle_add (context, function, data, notify);
+
+	dispatch = g_slice_new (ProgressDispatch);
+	dispatch->service = g_object_ref (service);
+	dispatch->function = function;
+	dispatch->data = data;
+	dispatch->notify = notify;
+
+	g_atomic_int_inc (&service->priv->pending_progress_callbacks);
+
+	return _gdata_service_idle_add (context, (GSourceFunc) progress_dispatch_cb, dispatch, (GDestroyNotify) progress_dispatch_free);
+}
+
 /**
  * gdata_service_get_locale:
  * @self: a #GDataService
@@ -2353,7 +10340,7 @@ const gchar *
 gdata_service_get_locale (GDataService *self)
 {
 	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
-	return self->priv->locale;
+	return g_atomic_pointer_get (&(self->priv->locale));
 }
 
 /**
@@ -2373,11 +10360,128 @@ gdata_service_set_locale (GDataService *self, const gchar *locale)
 {
 	g_return_if_fail (GDATA_IS_SERVICE (self));
 
-	g_free (self->priv->locale);
-	self->priv->locale = g_strdup (locale);
+	/* Locales are interned, so that the old one stays valid for any thread which is still using it */
+	g_atomic_pointer_set (&(self->priv->locale), g_intern_string (locale));
 	g_object_notify (G_OBJECT (self), "locale");
 }
 
+/**
+ * gdata_service_get_cache_directory:
+ * @self: a #GDataService
+ *
+ * Gets the directory used to persistently cache feed query responses. See #GDataService:cache-directory for more details.
+ *
+ * Return value: the cache directory, or %NULL if responses aren't cached
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_service_get_cache_directory (GDataService *self)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+	return self->priv->cache_directory;
+}
+
+/**
+ * gdata_service_set_cache_directory:
+ * @self: a #GDataService
+ * @cache_directory: (allow-none): the directory in which to cache feed query responses, or %NULL to not cache them
+ *
+ * Sets the directory used to persistently cache feed query responses. See #GDataService:cache-directory for more details.
+ *
+ * As with gdata_service_set_locale(), this should only be called after creation of a service, but before any network requests are made.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_cache_directory (GDataService *self, const gchar *cache_directory)
+{
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+
+	g_free (self->priv->cache_directory);
+	self->priv->cache_directory = g_strdup (cache_directory);
+	g_object_notify (G_OBJECT (self), "cache-directory");
+}
+
+/**
+ * gdata_service_get_blob_store:
+ * @self: a #GDataService
+ *
+ * Gets the store used for the files downloaded by the service's download streams. See #GDataService:blob-store for more details.
+ *
+ * Return value: (transfer none) (allow-none): the blob store, or %NULL if downloads aren't stored
+ *
+ * Since: 0.15.0
+ **/
+GDataBlobStore *
+gdata_service_get_blob_store (GDataService *self)
+{
+	GDataBlobStore *blob_store;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (self), NULL);
+
+	g_mutex_lock (&(self->priv->config_mutex));
+	blob_store = self->priv->blob_store;
+	g_mutex_unlock (&(self->priv->config_mutex));
+
+	return blob_store;
+}
+
+/**
+ * gdata_service_set_blob_store:
+ * @self: a #GDataService
+ * @blob_store: (allow-none): the store for downloaded files, or %NULL to not store them
+ *
+ * Sets the store used for the files downloaded by the service's download streams. See #GDataService:blob-store for more details.
+ *
+ * Download streams which have already started downloading carry on using the store which was set when they started.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_service_set_blob_store (GDataService *self, GDataBlobStore *blob_store)
+{
+	GDataBlobStore *old_blob_store;
+
+	g_return_if_fail (GDATA_IS_SERVICE (self));
+	g_return_if_fail (blob_store == NULL || GDATA_IS_BLOB_STORE (blob_store));
+
+	if (blob_store != NULL)
+		g_object_ref (blob_store);
+
+	g_mutex_lock (&(self->priv->config_mutex));
+	old_blob_store = self->priv->blob_store;
+	self->priv->blob_store = blob_store;
+	g_mutex_unlock (&(self->priv->config_mutex));
+
+	if (old_blob_store != NULL)
+		g_object_unref (old_blob_store);
+
+	g_object_notify (G_OBJECT (self), "blob-store");
+}
+
+/*
+ * _gdata_service_dup_blob_store:
+ * @self: a #GDataService
+ *
+ * Gets a reference to the service's #GDataService:blob-store, which stays valid even if another thread sets a new one.
+ *
+ * Return value: (transfer full) (allow-none): the blob store, or %NULL
+ *
+ * Since: 0.15.0
+ */
+GDataBlobStore *
+_gdata_service_dup_blob_store (GDataService *self)
+{
+	GDataBlobStore *blob_store;
+
+	g_mutex_lock (&(self->priv->config_mutex));
+	blob_store = (self->priv->blob_store != NULL) ? g_object_ref (self->priv->blob_store) : NULL;
+	g_mutex_unlock (&(self->priv->config_mutex));
+
+	return blob_store;
+}
+
 /*
  * _gdata_service_secure_strdup:
  * @str: string (which may be in pageable memory) to be duplicated, or %NULL
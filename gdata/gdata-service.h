@@ -26,6 +26,7 @@
 
 #include <gdata/gdata-authorizer.h>
 #include <gdata/gdata-feed.h>
+#include <gdata/gdata-blob-store.h>
 
 G_BEGIN_DECLS
 
@@ -96,12 +97,117 @@ typedef enum {
  *
  * Callback function called for each #GDataEntry parsed in a #GDataFeed when loading the results of a query.
  *
+ * @entry_count is worked out from the feed's <literal>openSearch</literal> elements, which precede its entries, so it's already accurate for the
+ * first entry. Callers which stream a feed's entries into their own storage can use it then to pre-size that storage or to start reporting
+ * progress. It's <code class="literal">0</code> if the feed doesn't say how many entries it contains.
+ *
  * It is called in the main thread, so there is no guarantee on the order in which the callbacks are executed,
  * or whether they will be called in a timely manner. It is, however, guaranteed that they will all be called before
  * the #GAsyncReadyCallback which signals the completion of the query is called.
  **/
 typedef void (*GDataQueryProgressCallback) (GDataEntry *entry, guint entry_key, guint entry_count, gpointer user_data);
 
+/**
+ * GDataQueryBatchProgressCallback:
+ * @entries: (element-type GData.Entry): an array of new #GDataEntry<!-- -->s, in feed order
+ * @first_entry_key: the key of the first entry in @entries (zero-based index of its position in the feed)
+ * @entry_count: the total number of entries in the feed
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called for each batch of #GDataEntry<!-- -->s parsed in a #GDataFeed when loading the results of a query with
+ * gdata_service_query_batched_async(). @entries is owned by libgdata, and the entries in it must be reffed if they're to be kept after the callback
+ * returns.
+ *
+ * It is called in the thread-default main context of the thread which started the query. Batches are delivered in feed order, and it is guaranteed
+ * that they will all be delivered before the #GAsyncReadyCallback which signals the completion of the query is called.
+ *
+ * Since: 0.15.0
+ **/
+typedef void (*GDataQueryBatchProgressCallback) (GPtrArray *entries, guint first_entry_key, guint entry_count, gpointer user_data);
+
+/**
+ * GDataRequestRecord:
+ * @operation_type: the type of operation which made the request
+ * @domain: (allow-none): the #GDataAuthorizationDomain the request was made under, or %NULL
+ * @method: the HTTP method of the request
+ * @uri: the URI of the request, without its query string, so that requests to the same endpoint can be grouped together
+ * @status: the final HTTP status of the request
+ * @retry_count: the number of times the request was re-sent, following a redirect, an authorization refresh, a throttling response or a transient
+ * failure (see #GDataService:max-retries)
+ * @queue_time: the time the request spent waiting for a connection to become available, in microseconds
+ * @dns_time: the time spent resolving the host name, in microseconds; <code class="literal">0</code> if an existing connection was used
+ * @connect_time: the time spent establishing the TCP connection, in microseconds; <code class="literal">0</code> if an existing connection was
+ * used
+ * @tls_time: the time spent in the TLS handshake, in microseconds; <code class="literal">0</code> if an existing connection was used
+ * @time_to_first_byte: the time between the request being sent and the response headers being received, in microseconds
+ * @transfer_time: the time spent receiving the response body, in microseconds
+ * @parse_time: the time between the response body being received and the operation finishing, in microseconds; this is mostly spent parsing the
+ * response, although streamed responses are partly parsed during @transfer_time
+ * @bytes_in: the number of response body bytes received, after decompression
+ * @bytes_out: the number of request body bytes sent
+ *
+ * A record of how long each stage of a request to the online service took, as emitted by #GDataService::request-completed. If the request was
+ * re-sent, the times and byte counts are summed over all attempts.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GDataOperationType operation_type;
+	GDataAuthorizationDomain *domain;
+	const gchar *method;
+	gchar *uri;
+	guint status;
+	guint retry_count;
+	gint64 queue_time;
+	gint64 dns_time;
+	gint64 connect_time;
+	gint64 tls_time;
+	gint64 time_to_first_byte;
+	gint64 transfer_time;
+	gint64 parse_time;
+	guint64 bytes_in;
+	guint64 bytes_out;
+} GDataRequestRecord;
+
+#define GDATA_TYPE_REQUEST_RECORD	(gdata_request_record_get_type ())
+GType gdata_request_record_get_type (void) G_GNUC_CONST;
+GDataRequestRecord *gdata_request_record_copy (const GDataRequestRecord *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_request_record_free (GDataRequestRecord *self);
+
+/**
+ * GDataServiceGauges:
+ * @requests_in_flight: the number of requests which have been queued to be sent and haven't finished yet
+ * @scheduler_queue_length: the number of normal and background priority requests waiting to be admitted, so that connections stay free for
+ * interactive ones (see #GDataService:reserved-connections)
+ * @connection_queue_length: the number of requests which have been admitted and queued to be sent, but are still waiting for a connection
+ * @upload_streams: the number of open #GDataUploadStream<!-- -->s using the service
+ * @upload_buffered_bytes: the number of bytes written to those streams which haven't been sent yet
+ * @download_streams: the number of open #GDataDownloadStream<!-- -->s using the service
+ * @download_buffered_bytes: the number of bytes received by those streams which haven't been read yet
+ * @pending_progress_callbacks: the number of dispatches of asynchronous queries' progress callbacks which have been queued in a main context but
+ * haven't run yet; if this keeps growing, the main context isn't keeping up with the responses being parsed
+ *
+ * A snapshot of the current load on a #GDataService, as returned by gdata_service_get_gauges() and emitted by #GDataService::gauges-sampled.
+ * Unlike the fields of #GDataRequestRecord, these go down as well as up. Requests made by a #GDataAuthorizer are not counted.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	guint requests_in_flight;
+	guint scheduler_queue_length;
+	guint connection_queue_length;
+	guint upload_streams;
+	guint64 upload_buffered_bytes;
+	guint download_streams;
+	guint64 download_buffered_bytes;
+	guint pending_progress_callbacks;
+} GDataServiceGauges;
+
+#define GDATA_TYPE_SERVICE_GAUGES	(gdata_service_gauges_get_type ())
+GType gdata_service_gauges_get_type (void) G_GNUC_CONST;
+GDataServiceGauges *gdata_service_gauges_copy (const GDataServiceGauges *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_service_gauges_free (GDataServiceGauges *self);
+
 #define GDATA_TYPE_SERVICE		(gdata_service_get_type ())
 #define GDATA_SERVICE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_SERVICE, GDataService))
 #define GDATA_SERVICE_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_SERVICE, GDataServiceClass))
@@ -159,6 +265,7 @@ GList *gdata_service_get_authorization_domains (GType service_type) G_GNUC_WARN_
 gboolean gdata_service_is_authorized (GDataService *self);
 
 GDataAuthorizer *gdata_service_get_authorizer (GDataService *self) G_GNUC_PURE;
+GDataAuthorizer *gdata_service_dup_authorizer (GDataService *self) G_GNUC_WARN_UNUSED_RESULT;
 void gdata_service_set_authorizer (GDataService *self, GDataAuthorizer *authorizer);
 
 #include <gdata/gdata-query.h>
@@ -171,8 +278,21 @@ void gdata_service_query_async (GDataService *self, GDataAuthorizationDomain *do
                                 GCancellable *cancellable,
                                 GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GDestroyNotify destroy_progress_user_data,
                                 GAsyncReadyCallback callback, gpointer user_data);
+void gdata_service_query_batched_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query,
+                                        GType entry_type, guint batch_size, guint batch_interval, GCancellable *cancellable,
+                                        GDataQueryBatchProgressCallback progress_callback, gpointer progress_user_data,
+                                        GDestroyNotify destroy_progress_user_data, GAsyncReadyCallback callback, gpointer user_data);
 GDataFeed *gdata_service_query_finish (GDataService *self, GAsyncResult *async_result, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
+GDataFeed *gdata_service_query_all (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                                    guint max_concurrent_pages, GCancellable *cancellable,
+                                    GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                                    GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_service_query_all_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GDataQuery *query, GType entry_type,
+                                    guint max_concurrent_pages, GCancellable *cancellable,
+                                    GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                                    GDestroyNotify destroy_progress_user_data, GAsyncReadyCallback callback, gpointer user_data);
+
 GDataEntry *gdata_service_query_single_entry (GDataService *self, GDataAuthorizationDomain *domain, const gchar *entry_id, GDataQuery *query,
                                               GType entry_type, GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 void gdata_service_query_single_entry_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *entry_id, GDataQuery *query,
@@ -180,6 +300,24 @@ void gdata_service_query_single_entry_async (GDataService *self, GDataAuthorizat
 GDataEntry *gdata_service_query_single_entry_finish (GDataService *self, GAsyncResult *async_result,
                                                      GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
+GHashTable *gdata_service_query_entries_by_id (GDataService *self, GDataAuthorizationDomain *domain, const gchar *batch_feed_uri,
+                                               const gchar * const *entry_ids, GType entry_type, GCancellable *cancellable,
+                                               GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_service_query_entries_by_id_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *batch_feed_uri,
+                                              const gchar * const *entry_ids, GType entry_type, GCancellable *cancellable,
+                                              GAsyncReadyCallback callback, gpointer user_data);
+GHashTable *gdata_service_query_entries_by_id_finish (GDataService *self, GAsyncResult *async_result,
+                                                      GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GList *gdata_service_query_top_entries (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GList *queries,
+                                        GType entry_type, guint n_entries, GCompareDataFunc compare_func, gpointer compare_user_data,
+                                        GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+void gdata_service_query_top_entries_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *feed_uri, GList *queries,
+                                            GType entry_type, guint n_entries, GCompareDataFunc compare_func, gpointer compare_user_data,
+                                            GDestroyNotify destroy_compare_user_data, GCancellable *cancellable,
+                                            GAsyncReadyCallback callback, gpointer user_data);
+GList *gdata_service_query_top_entries_finish (GDataService *self, GAsyncResult *async_result, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+
 GDataEntry *gdata_service_insert_entry (GDataService *self, GDataAuthorizationDomain *domain, const gchar *upload_uri, GDataEntry *entry,
                                         GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 void gdata_service_insert_entry_async (GDataService *self, GDataAuthorizationDomain *domain, const gchar *upload_uri, GDataEntry *entry,
@@ -194,6 +332,13 @@ void gdata_service_update_entry_async (GDataService *self, GDataAuthorizationDom
 GDataEntry *gdata_service_update_entry_finish (GDataService *self, GAsyncResult *async_result,
                                                GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
+GDataEntry *gdata_service_patch_entry (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry,
+                                       GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_service_patch_entry_async (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry, GCancellable *cancellable,
+                                      GAsyncReadyCallback callback, gpointer user_data);
+GDataEntry *gdata_service_patch_entry_finish (GDataService *self, GAsyncResult *async_result,
+                                              GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
 gboolean gdata_service_delete_entry (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry,
                                      GCancellable *cancellable, GError **error);
 void gdata_service_delete_entry_async (GDataService *self, GDataAuthorizationDomain *domain, GDataEntry *entry, GCancellable *cancellable,
@@ -211,6 +356,66 @@ void gdata_service_set_proxy_resolver (GDataService *self, GProxyResolver *proxy
 guint gdata_service_get_timeout (GDataService *self) G_GNUC_PURE;
 void gdata_service_set_timeout (GDataService *self, guint timeout);
 
+guint gdata_service_get_max_connections (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_max_connections (GDataService *self, guint max_connections);
+guint gdata_service_get_max_connections_per_host (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_max_connections_per_host (GDataService *self, guint max_connections_per_host);
+guint gdata_service_get_reserved_connections (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_reserved_connections (GDataService *self, guint reserved_connections);
+guint gdata_service_get_idle_timeout (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_idle_timeout (GDataService *self, guint idle_timeout);
+
+void gdata_service_get_connection_statistics (GDataService *self, guint *requests_sent, guint *connections_opened, guint *tls_handshakes);
+void gdata_service_get_transfer_statistics (GDataService *self, guint64 *bytes_received, guint64 *bytes_decoded);
+
+void gdata_service_get_gauges (GDataService *self, GDataServiceGauges *gauges);
+guint gdata_service_get_requests_in_flight (GDataService *self, GDataAuthorizationDomain *domain);
+guint gdata_service_get_gauges_interval (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_gauges_interval (GDataService *self, guint gauges_interval);
+
+void gdata_service_prepare_connections_async (GDataService *self, const gchar * const *uris, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                              gpointer user_data);
+gboolean gdata_service_prepare_connections_finish (GDataService *self, GAsyncResult *async_result, GError **error);
+
+guint gdata_service_get_entry_cache_size (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_entry_cache_size (GDataService *self, guint entry_cache_size);
+
+guint gdata_service_get_acl_cache_size (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_acl_cache_size (GDataService *self, guint acl_cache_size);
+
+guint gdata_service_get_max_retries (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_max_retries (GDataService *self, guint max_retries);
+guint gdata_service_get_retry_delay (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_retry_delay (GDataService *self, guint retry_delay);
+
+guint gdata_service_get_upload_bandwidth_limit (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_upload_bandwidth_limit (GDataService *self, guint bytes_per_second);
+guint gdata_service_get_download_bandwidth_limit (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_download_bandwidth_limit (GDataService *self, guint bytes_per_second);
+
+gboolean gdata_service_get_minimal_responses (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_minimal_responses (GDataService *self, gboolean minimal_responses);
+gboolean gdata_service_get_update_entries_in_place (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_update_entries_in_place (GDataService *self, gboolean update_entries_in_place);
+guint gdata_service_get_hedge_delay (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_hedge_delay (GDataService *self, guint hedge_delay);
+gboolean gdata_service_get_compress_requests (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_compress_requests (GDataService *self, gboolean compress_requests);
+gboolean gdata_service_get_share_queries (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_share_queries (GDataService *self, gboolean share_queries);
+guint gdata_service_get_max_error_response_size (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_max_error_response_size (GDataService *self, guint max_error_response_size);
+
+SoupSession *gdata_service_get_session (GDataService *self) G_GNUC_PURE;
+
+gdouble gdata_service_get_rate_limit (GDataService *self, GDataAuthorizationDomain *domain, guint *burst);
+void gdata_service_set_rate_limit (GDataService *self, GDataAuthorizationDomain *domain, gdouble requests_per_second, guint burst);
+
+const gchar *gdata_service_get_cache_directory (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_cache_directory (GDataService *self, const gchar *cache_directory);
+GDataBlobStore *gdata_service_get_blob_store (GDataService *self) G_GNUC_PURE;
+void gdata_service_set_blob_store (GDataService *self, GDataBlobStore *blob_store);
+
 const gchar *gdata_service_get_locale (GDataService *self) G_GNUC_PURE;
 void gdata_service_set_locale (GDataService *self, const gchar *locale);
 
@@ -0,0 +1,116 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The core of the incremental synchronisation engines (#GDataContactsSync, #GDataCalendarSync and #GDataTasksSync). Each engine builds a query
+ * for its feed and decides what to do with each entry; this queries for the entries updated since a watermark, walks all the pages of results and
+ * works out the new watermark.
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-private.h"
+
+/*
+ * _gdata_sync_run:
+ * @query: the query to use, with any service-specific parameters already set
+ * @watermark: the watermark of the last successful synchronisation, or <code class="literal">-1</code> for a full synchronisation
+ * @clock_skew_margin: the number of seconds before @watermark to start querying from
+ * @query_func: function to query a page of results using @query
+ * @entry_func: function to apply each entry in the results
+ * @user_data: (closure): data to pass to @query_func and @entry_func
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @new_watermark: (out caller-allocates): return location for the new watermark
+ * @error: a #GError, or %NULL
+ *
+ * Queries for all the entries updated since @watermark (less @clock_skew_margin) using #GDataQuery:updated-min, and passes each of them to
+ * @entry_func, walking all the pages of results. Pages are followed using either the feed's <literal>next</literal> link or, for JSON feeds, its
+ * next page token.
+ *
+ * If all the entries are applied successfully, @new_watermark is set to the watermark to use for the next synchronisation. This is taken from the
+ * server's clock at the time of the first page, so that any changes made while the pages are being walked get picked up next time. Feeds which
+ * don't give the server's time (such as JSON feeds) use the latest update time of the entries instead; and if there were no entries, @watermark is
+ * returned unchanged. If @query_func or @entry_func fail, synchronisation stops, %FALSE is returned, and @new_watermark is set to @watermark.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_sync_run (GDataQuery *query, gint64 watermark, guint clock_skew_margin, GDataSyncQueryFunc query_func, GDataSyncEntryFunc entry_func,
+                 gpointer user_data, GCancellable *cancellable, gint64 *new_watermark, GError **error)
+{
+	gint64 feed_watermark = -1, latest_updated = -1;
+	gboolean first_page = TRUE, success = TRUE;
+
+	g_return_val_if_fail (GDATA_IS_QUERY (query), FALSE);
+	g_return_val_if_fail (query_func != NULL, FALSE);
+	g_return_val_if_fail (entry_func != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (new_watermark != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* Only query for the changes since the watermark */
+	if (watermark >= 0)
+		gdata_query_set_updated_min (query, MAX (watermark - (gint64) clock_skew_margin, 0));
+
+	while (TRUE) {
+		GDataFeed *feed;
+		GList *i;
+		gboolean has_next_page;
+
+		feed = query_func (query, user_data, cancellable, error);
+		if (feed == NULL) {
+			success = FALSE;
+			break;
+		}
+
+		if (first_page == TRUE)
+			feed_watermark = gdata_feed_get_updated (feed);
+		first_page = FALSE;
+
+		has_next_page = (gdata_feed_get_entries (feed) != NULL &&
+		                 (gdata_feed_look_up_link (feed, "next") != NULL || _gdata_feed_get_next_page_token (feed) != NULL));
+
+		for (i = gdata_feed_get_entries (feed); i != NULL && success == TRUE; i = i->next) {
+			latest_updated = MAX (latest_updated, gdata_entry_get_updated (GDATA_ENTRY (i->data)));
+			success = entry_func (GDATA_ENTRY (i->data), user_data, error);
+		}
+
+		g_object_unref (feed);
+
+		if (success == FALSE || has_next_page == FALSE)
+			break;
+
+		gdata_query_next_page (query);
+	}
+
+	/* Only move the watermark on once all the changes have been applied */
+	if (success == FALSE)
+		*new_watermark = watermark;
+	else if (feed_watermark >= 0)
+		*new_watermark = feed_watermark;
+	else if (latest_updated >= 0)
+		*new_watermark = MAX (watermark, latest_updated);
+	else
+		*new_watermark = watermark;
+
+	return success;
+}
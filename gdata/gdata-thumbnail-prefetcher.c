@@ -0,0 +1,1068 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-thumbnail-prefetcher
+ * @short_description: GData thumbnail prefetcher object
+ * @stability: Unstable
+ * @include: gdata/gdata-thumbnail-prefetcher.h
+ *
+ * #GDataThumbnailPrefetcher downloads the thumbnails for all the entries in a feed at once, such as a feed of #GDataYouTubeVideo<!-- -->s or
+ * #GDataPicasaWebFile<!-- -->s, for display in a gallery view. For each entry, it chooses the smallest thumbnail which is at least as big as the
+ * prefetcher's #GDataThumbnailPrefetcher:width and #GDataThumbnailPrefetcher:height (or the biggest thumbnail, if none are big enough); see
+ * gdata_thumbnail_prefetcher_choose_thumbnail(). Up to #GDataThumbnailPrefetcher:max-concurrent-downloads thumbnails are downloaded at once, and
+ * each is passed to a #GDataThumbnailPrefetcherCallback as soon as it arrives.
+ *
+ * Downloaded thumbnails are cached in memory, in a least-recently-used cache whose size can be set with
+ * gdata_thumbnail_prefetcher_set_memory_cache_limit(). They can also be cached on disk, by setting a cache directory with
+ * gdata_thumbnail_prefetcher_set_disk_cache(). Both caches are shared by all the #GDataThumbnailPrefetcher<!-- -->s (and so all the services)
+ * in the process; thumbnails are keyed by their URIs. Thumbnails which are found in either of the caches are delivered without any network
+ * activity.
+ *
+ * <example>
+ *	<title>Prefetching Thumbnails for a Gallery</title>
+ *	<programlisting>
+ *	GDataThumbnailPrefetcher *prefetcher;
+ *	GDataFeed *feed;
+ *
+ *	feed = gdata_youtube_service_query_standard_feed (service, GDATA_YOUTUBE_MOST_POPULAR_FEED, NULL, NULL, NULL, NULL, NULL);
+ *
+ *	/<!-- -->* Fetch thumbnails of at least 120×90 pixels for all the videos in the feed *<!-- -->/
+ *	prefetcher = gdata_thumbnail_prefetcher_new (GDATA_SERVICE (service), 120, 90);
+ *	gdata_thumbnail_prefetcher_prefetch_async (prefetcher, feed, (GDataThumbnailPrefetcherCallback) thumbnail_cb, gallery, NULL,
+ *	                                           NULL, (GAsyncReadyCallback) prefetch_cb, NULL);
+ *
+ *	g_object_unref (prefetcher);
+ *	g_object_unref (feed);
+ *
+ *	static void
+ *	thumbnail_cb (GDataEntry *entry, GDataMediaThumbnail *thumbnail, const guint8 *data, gsize length, GError *error, MyGallery *gallery)
+ *	{
+ *		if (error != NULL) {
+ *			g_warning ("Error fetching thumbnail for ‘%s’: %s", gdata_entry_get_title (entry), error->message);
+ *			return;
+ *		}
+ *
+ *		/<!-- -->* Display the thumbnail; the data must be copied if it's needed after the callback returns *<!-- -->/
+ *		my_gallery_set_thumbnail (gallery, entry, data, length);
+ *	}
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "gdata-thumbnail-prefetcher.h"
+#include "gdata-download-stream.h"
+#include "gdata-private.h"
+#include "services/youtube/gdata-youtube-video.h"
+#include "services/picasaweb/gdata-picasaweb-file.h"
+
+/* Default limits for the shared caches */
+#define DEFAULT_MEMORY_CACHE_LIMIT (4 * 1024 * 1024)
+#define DEFAULT_DISK_CACHE_LIMIT (64 * 1024 * 1024)
+
+/* Size of the buffer used to read each thumbnail from its download stream */
+#define READ_BUFFER_SIZE (16 * 1024)
+
+typedef struct {
+	GDataEntry *entry;
+	GDataMediaThumbnail *thumbnail;
+	GDataThumbnailPrefetcherCallback callback;
+	gpointer user_data;
+	GCancellable *cancellable;
+	GAsyncQueue *results;
+
+	/* Results */
+	guint8 *data;
+	gsize length;
+	GError *error;
+} PrefetchRequest;
+
+static void gdata_thumbnail_prefetcher_dispose (GObject *object);
+static void gdata_thumbnail_prefetcher_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_thumbnail_prefetcher_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataThumbnailPrefetcherPrivate {
+	GDataService *service;
+	guint width;
+	guint height;
+	guint max_concurrent_downloads;
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_WIDTH,
+	PROP_HEIGHT,
+	PROP_MAX_CONCURRENT_DOWNLOADS,
+};
+
+/* Process-wide thumbnail caches, shared between all prefetchers. The memory cache maps URIs to the GList links of their CacheEntrys in
+ * memory_cache_lru, which is kept in most-recently-used-first order so that the least recently used entries can be evicted from its tail. The disk
+ * cache is a directory of files named after the checksums of their URIs; when it grows too big, the oldest files are deleted from it. */
+typedef struct {
+	gchar *uri;
+	guint8 *data;
+	gsize length;
+	gint64 last_used; /* monotonic time */
+} CacheEntry;
+
+G_LOCK_DEFINE_STATIC (cache);
+static GHashTable *memory_cache = NULL;
+static GQueue memory_cache_lru = G_QUEUE_INIT;
+static gsize memory_cache_size = 0;
+static gsize memory_cache_limit = DEFAULT_MEMORY_CACHE_LIMIT;
+static gchar *disk_cache_directory = NULL;
+static guint64 disk_cache_size = 0;
+static gboolean disk_cache_size_known = FALSE;
+static guint64 disk_cache_limit = DEFAULT_DISK_CACHE_LIMIT;
+
+/* The memory cache's registration with the cache manager; set in class_init, since only prefetchers can use the cache, and never unregistered. Its
+ * thumbnails are evicted before any other caches' items, since they can be re-read from the disk cache if there is one. */
+static gsize memory_cache_get_size (gpointer cache, guint *n_items);
+static gint64 memory_cache_get_oldest_use (gpointer cache);
+static gsize memory_cache_evict_oldest (gpointer cache);
+
+static const GDataCacheFuncs memory_cache_funcs = {
+	memory_cache_get_size,
+	memory_cache_get_oldest_use,
+	memory_cache_evict_oldest,
+};
+
+static GDataCacheRegistration *memory_cache_registration = NULL;
+
+G_DEFINE_TYPE (GDataThumbnailPrefetcher, gdata_thumbnail_prefetcher, G_TYPE_OBJECT)
+
+static void
+gdata_thumbnail_prefetcher_class_init (GDataThumbnailPrefetcherClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataThumbnailPrefetcherPrivate));
+
+	memory_cache_registration = _gdata_cache_manager_register ("GDataThumbnailPrefetcher:memory-cache", GDATA_CACHE_PRIORITY_LOW,
+	                                                           &memory_cache_funcs, NULL);
+
+	gobject_class->dispose = gdata_thumbnail_prefetcher_dispose;
+	gobject_class->get_property = gdata_thumbnail_prefetcher_get_property;
+	gobject_class->set_property = gdata_thumbnail_prefetcher_set_property;
+
+	/**
+	 * GDataThumbnailPrefetcher:service:
+	 *
+	 * The service used to download the thumbnails.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service used to download the thumbnails.",
+	                                                      GDATA_TYPE_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataThumbnailPrefetcher:width:
+	 *
+	 * The width the thumbnails are going to be displayed at, in pixels. The smallest thumbnail for each entry which is at least this wide (and
+	 * at least #GDataThumbnailPrefetcher:height high) is fetched.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_WIDTH,
+	                                 g_param_spec_uint ("width",
+	                                                    "Width", "The width the thumbnails are going to be displayed at, in pixels.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataThumbnailPrefetcher:height:
+	 *
+	 * The height the thumbnails are going to be displayed at, in pixels. The smallest thumbnail for each entry which is at least this high (and
+	 * at least #GDataThumbnailPrefetcher:width wide) is fetched.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_HEIGHT,
+	                                 g_param_spec_uint ("height",
+	                                                    "Height", "The height the thumbnails are going to be displayed at, in pixels.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataThumbnailPrefetcher:max-concurrent-downloads:
+	 *
+	 * The maximum number of thumbnails to download at once. Each download uses its own connection, so this is also limited by the service's
+	 * #GDataService:max-connections-per-host.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MAX_CONCURRENT_DOWNLOADS,
+	                                 g_param_spec_uint ("max-concurrent-downloads",
+	                                                    "Maximum concurrent downloads", "The maximum number of thumbnails to download at once.",
+	                                                    1, G_MAXUINT, 6,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_thumbnail_prefetcher_init (GDataThumbnailPrefetcher *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_THUMBNAIL_PREFETCHER, GDataThumbnailPrefetcherPrivate);
+	self->priv->max_concurrent_downloads = 6;
+}
+
+static void
+gdata_thumbnail_prefetcher_dispose (GObject *object)
+{
+	GDataThumbnailPrefetcherPrivate *priv = GDATA_THUMBNAIL_PREFETCHER (object)->priv;
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_thumbnail_prefetcher_parent_class)->dispose (object);
+}
+
+static void
+gdata_thumbnail_prefetcher_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataThumbnailPrefetcherPrivate *priv = GDATA_THUMBNAIL_PREFETCHER (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_WIDTH:
+			g_value_set_uint (value, priv->width);
+			break;
+		case PROP_HEIGHT:
+			g_value_set_uint (value, priv->height);
+			break;
+		case PROP_MAX_CONCURRENT_DOWNLOADS:
+			g_value_set_uint (value, priv->max_concurrent_downloads);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_thumbnail_prefetcher_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataThumbnailPrefetcherPrivate *priv = GDATA_THUMBNAIL_PREFETCHER (object)->priv;
+
+	switch (property_id) {
+		/* Construct only */
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_WIDTH:
+			priv->width = g_value_get_uint (value);
+			break;
+		case PROP_HEIGHT:
+			priv->height = g_value_get_uint (value);
+			break;
+		case PROP_MAX_CONCURRENT_DOWNLOADS:
+			gdata_thumbnail_prefetcher_set_max_concurrent_downloads (GDATA_THUMBNAIL_PREFETCHER (object), g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_thumbnail_prefetcher_new:
+ * @service: the #GDataService to download the thumbnails with
+ * @width: the width the thumbnails are going to be displayed at, in pixels
+ * @height: the height the thumbnails are going to be displayed at, in pixels
+ *
+ * Creates a new #GDataThumbnailPrefetcher for downloading thumbnails of at least @width×@height pixels using @service. Pass
+ * <code class="literal">0</code> for both @width and @height to fetch the smallest thumbnail for each entry.
+ *
+ * Return value: (transfer full): a new #GDataThumbnailPrefetcher; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataThumbnailPrefetcher *
+gdata_thumbnail_prefetcher_new (GDataService *service, guint width, guint height)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+
+	return g_object_new (GDATA_TYPE_THUMBNAIL_PREFETCHER,
+	                     "service", service,
+	                     "width", width,
+	                     "height", height,
+	                     NULL);
+}
+
+/**
+ * gdata_thumbnail_prefetcher_get_service:
+ * @self: a #GDataThumbnailPrefetcher
+ *
+ * Gets the #GDataThumbnailPrefetcher:service property.
+ *
+ * Return value: (transfer none): the service used to download the thumbnails
+ *
+ * Since: 0.15.0
+ */
+GDataService *
+gdata_thumbnail_prefetcher_get_service (GDataThumbnailPrefetcher *self)
+{
+	g_return_val_if_fail (GDATA_IS_THUMBNAIL_PREFETCHER (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_thumbnail_prefetcher_get_width:
+ * @self: a #GDataThumbnailPrefetcher
+ *
+ * Gets the #GDataThumbnailPrefetcher:width property.
+ *
+ * Return value: the width the thumbnails are going to be displayed at, in pixels
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_thumbnail_prefetcher_get_width (GDataThumbnailPrefetcher *self)
+{
+	g_return_val_if_fail (GDATA_IS_THUMBNAIL_PREFETCHER (self), 0);
+	return self->priv->width;
+}
+
+/**
+ * gdata_thumbnail_prefetcher_get_height:
+ * @self: a #GDataThumbnailPrefetcher
+ *
+ * Gets the #GDataThumbnailPrefetcher:height property.
+ *
+ * Return value: the height the thumbnails are going to be displayed at, in pixels
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_thumbnail_prefetcher_get_height (GDataThumbnailPrefetcher *self)
+{
+	g_return_val_if_fail (GDATA_IS_THUMBNAIL_PREFETCHER (self), 0);
+	return self->priv->height;
+}
+
+/**
+ * gdata_thumbnail_prefetcher_get_max_concurrent_downloads:
+ * @self: a #GDataThumbnailPrefetcher
+ *
+ * Gets the #GDataThumbnailPrefetcher:max-concurrent-downloads property.
+ *
+ * Return value: the maximum number of thumbnails to download at once
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_thumbnail_prefetcher_get_max_concurrent_downloads (GDataThumbnailPrefetcher *self)
+{
+	g_return_val_if_fail (GDATA_IS_THUMBNAIL_PREFETCHER (self), 0);
+	return self->priv->max_concurrent_downloads;
+}
+
+/**
+ * gdata_thumbnail_prefetcher_set_max_concurrent_downloads:
+ * @self: a #GDataThumbnailPrefetcher
+ * @max_concurrent_downloads: the maximum number of thumbnails to download at once
+ *
+ * Sets the #GDataThumbnailPrefetcher:max-concurrent-downloads property. This only affects prefetches started after it's called.
+ * @max_concurrent_downloads must be at least <code class="literal">1</code>.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_thumbnail_prefetcher_set_max_concurrent_downloads (GDataThumbnailPrefetcher *self, guint max_concurrent_downloads)
+{
+	g_return_if_fail (GDATA_IS_THUMBNAIL_PREFETCHER (self));
+	g_return_if_fail (max_concurrent_downloads > 0);
+
+	self->priv->max_concurrent_downloads = max_concurrent_downloads;
+	g_object_notify (G_OBJECT (self), "max-concurrent-downloads");
+}
+
+static GList *
+get_entry_thumbnails (GDataEntry *entry)
+{
+	if (GDATA_IS_YOUTUBE_VIDEO (entry) == TRUE)
+		return gdata_youtube_video_get_thumbnails (GDATA_YOUTUBE_VIDEO (entry));
+	else if (GDATA_IS_PICASAWEB_FILE (entry) == TRUE)
+		return gdata_picasaweb_file_get_thumbnails (GDATA_PICASAWEB_FILE (entry));
+
+	return NULL;
+}
+
+/**
+ * gdata_thumbnail_prefetcher_choose_thumbnail:
+ * @self: a #GDataThumbnailPrefetcher
+ * @entry: the entry to choose a thumbnail for
+ *
+ * Chooses the thumbnail which would be fetched for @entry by a prefetch. This is the smallest of @entry's thumbnails which is at least
+ * #GDataThumbnailPrefetcher:width wide and #GDataThumbnailPrefetcher:height high; or, if none of them are big enough, the biggest of them.
+ *
+ * Only #GDataYouTubeVideo<!-- -->s and #GDataPicasaWebFile<!-- -->s have thumbnails; %NULL is returned for other entries, and for entries which have
+ * no thumbnails.
+ *
+ * Return value: (transfer none) (allow-none): the best thumbnail for @entry, or %NULL
+ *
+ * Since: 0.15.0
+ */
+GDataMediaThumbnail *
+gdata_thumbnail_prefetcher_choose_thumbnail (GDataThumbnailPrefetcher *self, GDataEntry *entry)
+{
+	GDataMediaThumbnail *smallest_big_enough = NULL, *biggest = NULL;
+	guint64 smallest_big_enough_area = 0, biggest_area = 0;
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_THUMBNAIL_PREFETCHER (self), NULL);
+	g_return_val_if_fail (GDATA_IS_ENTRY (entry), NULL);
+
+	for (i = get_entry_thumbnails (entry); i != NULL; i = i->next) {
+		GDataMediaThumbnail *thumbnail = GDATA_MEDIA_THUMBNAIL (i->data);
+		guint width, height;
+		guint64 area;
+
+		width = gdata_media_thumbnail_get_width (thumbnail);
+		height = gdata_media_thumbnail_get_height (thumbnail);
+		area = (guint64) width * height;
+
+		if (width >= self->priv->width && height >= self->priv->height &&
+		    (smallest_big_enough == NULL || area < smallest_big_enough_area)) {
+			smallest_big_enough = thumbnail;
+			smallest_big_enough_area = area;
+		}
+
+		if (biggest == NULL || area > biggest_area) {
+			biggest = thumbnail;
+			biggest_area = area;
+		}
+	}
+
+	return (smallest_big_enough != NULL) ? smallest_big_enough : biggest;
+}
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+	g_free (entry->uri);
+	g_free (entry->data);
+	g_slice_free (CacheEntry, entry);
+}
+
+/* Must be called with the cache lock held */
+static void
+memory_cache_trim_unlocked (gsize limit)
+{
+	while (memory_cache_size > limit) {
+		CacheEntry *entry = g_queue_pop_tail (&memory_cache_lru);
+
+		g_hash_table_remove (memory_cache, entry->uri);
+		memory_cache_size -= entry->length;
+		cache_entry_free (entry);
+	}
+}
+
+static gsize
+memory_cache_get_size (gpointer cache, guint *n_items)
+{
+	gsize n_bytes;
+
+	G_LOCK (cache);
+	n_bytes = memory_cache_size;
+	if (n_items != NULL)
+		*n_items = memory_cache_lru.length;
+	G_UNLOCK (cache);
+
+	return n_bytes;
+}
+
+static gint64
+memory_cache_get_oldest_use (gpointer cache)
+{
+	gint64 last_used = G_MAXINT64;
+
+	G_LOCK (cache);
+	if (memory_cache_lru.tail != NULL)
+		last_used = ((CacheEntry*) memory_cache_lru.tail->data)->last_used;
+	G_UNLOCK (cache);
+
+	return last_used;
+}
+
+static gsize
+memory_cache_evict_oldest (gpointer cache)
+{
+	CacheEntry *entry;
+	gsize n_bytes = 0;
+
+	G_LOCK (cache);
+
+	entry = g_queue_pop_tail (&memory_cache_lru);
+	if (entry != NULL) {
+		g_hash_table_remove (memory_cache, entry->uri);
+		memory_cache_size -= entry->length;
+		n_bytes = entry->length;
+		cache_entry_free (entry);
+	}
+
+	G_UNLOCK (cache);
+
+	return n_bytes;
+}
+
+/* Must be called with the cache lock held */
+static void
+memory_cache_insert_unlocked (const gchar *uri, const guint8 *data, gsize length)
+{
+	CacheEntry *entry;
+
+	if (length > memory_cache_limit || (memory_cache != NULL && g_hash_table_lookup (memory_cache, uri) != NULL))
+		return;
+
+	if (memory_cache == NULL)
+		memory_cache = g_hash_table_new (g_str_hash, g_str_equal);
+
+	entry = g_slice_new (CacheEntry);
+	entry->uri = g_strdup (uri);
+	entry->data = g_memdup (data, length);
+	entry->length = length;
+	entry->last_used = g_get_monotonic_time ();
+
+	g_queue_push_head (&memory_cache_lru, entry);
+	g_hash_table_insert (memory_cache, entry->uri, memory_cache_lru.head);
+	memory_cache_size += length;
+
+	memory_cache_trim_unlocked (memory_cache_limit);
+}
+
+/* Must be called with the cache lock held. Returns %NULL if there is no disk cache. */
+static gchar *
+disk_cache_get_path_unlocked (const gchar *uri)
+{
+	gchar *checksum, *path;
+
+	if (disk_cache_directory == NULL)
+		return NULL;
+
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+	path = g_build_filename (disk_cache_directory, checksum, NULL);
+	g_free (checksum);
+
+	return path;
+}
+
+typedef struct {
+	gchar *path;
+	time_t mtime;
+	guint64 size;
+} DiskCacheFile;
+
+static gint
+compare_disk_cache_files (const DiskCacheFile *a, const DiskCacheFile *b)
+{
+	return (a->mtime < b->mtime) ? -1 : (a->mtime > b->mtime) ? 1 : 0;
+}
+
+/* Works out the size of the disk cache and, if it's over the limit, deletes the oldest files from it until it's well under the limit again, so that
+ * this doesn't have to be done on every insertion. Must be called with the cache lock held; this blocks on disk I/O, but is only needed
+ * occasionally. */
+static void
+disk_cache_prune_unlocked (void)
+{
+	GDir *dir;
+	const gchar *name;
+	GArray *files;
+	guint64 total_size = 0;
+	guint i;
+
+	dir = g_dir_open (disk_cache_directory, 0, NULL);
+	if (dir == NULL)
+		return;
+
+	files = g_array_new (FALSE, FALSE, sizeof (DiskCacheFile));
+
+	while ((name = g_dir_read_name (dir)) != NULL) {
+		DiskCacheFile file;
+		GStatBuf stat_buf;
+
+		file.path = g_build_filename (disk_cache_directory, name, NULL);
+
+		if (g_stat (file.path, &stat_buf) != 0 || S_ISREG (stat_buf.st_mode) == FALSE) {
+			g_free (file.path);
+			continue;
+		}
+
+		file.mtime = stat_buf.st_mtime;
+		file.size = stat_buf.st_size;
+		total_size += file.size;
+		g_array_append_val (files, file);
+	}
+
+	g_dir_close (dir);
+
+	if (total_size > disk_cache_limit) {
+		g_array_sort (files, (GCompareFunc) compare_disk_cache_files);
+
+		for (i = 0; i < files->len && total_size > disk_cache_limit / 4 * 3; i++) {
+			DiskCacheFile *file = &g_array_index (files, DiskCacheFile, i);
+
+			if (g_unlink (file->path) == 0)
+				total_size -= file->size;
+		}
+	}
+
+	for (i = 0; i < files->len; i++)
+		g_free (g_array_index (files, DiskCacheFile, i).path);
+	g_array_free (files, TRUE);
+
+	disk_cache_size = total_size;
+	disk_cache_size_known = TRUE;
+}
+
+/* Looks up @uri in the memory cache, then in the disk cache. Returns a newly-allocated copy of the cached data, or %NULL. */
+static guint8 *
+cache_lookup (const gchar *uri, gsize *length)
+{
+	GList *link;
+	gchar *path, *contents = NULL;
+	guint8 *data = NULL;
+
+	G_LOCK (cache);
+
+	link = (memory_cache != NULL) ? g_hash_table_lookup (memory_cache, uri) : NULL;
+	if (link != NULL) {
+		CacheEntry *entry = link->data;
+
+		/* Mark the entry as the most recently used */
+		g_queue_unlink (&memory_cache_lru, link);
+		g_queue_push_head_link (&memory_cache_lru, link);
+		entry->last_used = g_get_monotonic_time ();
+
+		data = g_memdup (entry->data, entry->length);
+		*length = entry->length;
+
+		G_UNLOCK (cache);
+
+		_gdata_cache_manager_record_lookup (memory_cache_registration, TRUE);
+
+		return data;
+	}
+
+	path = disk_cache_get_path_unlocked (uri);
+
+	G_UNLOCK (cache);
+
+	_gdata_cache_manager_record_lookup (memory_cache_registration, FALSE);
+
+	if (path != NULL && g_file_get_contents (path, &contents, length, NULL) == TRUE && *length > 0) {
+		data = (guint8*) contents;
+
+		G_LOCK (cache);
+		memory_cache_insert_unlocked (uri, data, *length);
+		G_UNLOCK (cache);
+
+		_gdata_cache_manager_cache_grown (memory_cache_registration);
+	} else {
+		g_free (contents);
+	}
+
+	g_free (path);
+
+	return data;
+}
+
+/* Stores @data in the memory and disk caches. Failures are ignored; the caches are only an optimisation. */
+static void
+cache_store (const gchar *uri, const guint8 *data, gsize length)
+{
+	gchar *path, *dirname;
+
+	G_LOCK (cache);
+	memory_cache_insert_unlocked (uri, data, length);
+	path = disk_cache_get_path_unlocked (uri);
+	G_UNLOCK (cache);
+
+	_gdata_cache_manager_cache_grown (memory_cache_registration);
+
+	if (path == NULL)
+		return;
+
+	dirname = g_path_get_dirname (path);
+	g_mkdir_with_parents (dirname, 0700);
+	g_free (dirname);
+
+	if (g_file_set_contents (path, (const gchar*) data, length, NULL) == TRUE) {
+		G_LOCK (cache);
+
+		disk_cache_size += length;
+		if (disk_cache_size_known == FALSE || disk_cache_size > disk_cache_limit)
+			disk_cache_prune_unlocked ();
+
+		G_UNLOCK (cache);
+	} else {
+		g_debug ("Failed to store thumbnail cache file '%s'.", path);
+	}
+
+	g_free (path);
+}
+
+/**
+ * gdata_thumbnail_prefetcher_set_memory_cache_limit:
+ * @memory_limit: the maximum total size of the thumbnails to keep in memory, in bytes
+ *
+ * Sets the size limit of the in-memory thumbnail cache shared by all #GDataThumbnailPrefetcher<!-- -->s. If the cache is bigger than this, the least
+ * recently used thumbnails are evicted from it immediately. Set @memory_limit to <code class="literal">0</code> to disable the memory cache.
+ *
+ * The default limit is 4 MiB.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_thumbnail_prefetcher_set_memory_cache_limit (gsize memory_limit)
+{
+	G_LOCK (cache);
+
+	memory_cache_limit = memory_limit;
+	if (memory_cache != NULL)
+		memory_cache_trim_unlocked (memory_cache_limit);
+
+	G_UNLOCK (cache);
+}
+
+/**
+ * gdata_thumbnail_prefetcher_set_disk_cache:
+ * @directory: (allow-none): the directory in which to cache thumbnails, or %NULL to not cache them on disk
+ * @disk_limit: the maximum total size of the files in @directory, in bytes
+ *
+ * Sets the directory used to persistently cache thumbnails for all #GDataThumbnailPrefetcher<!-- -->s, and its size limit. @directory should be
+ * dedicated to the thumbnail cache (for example, a subdirectory of g_get_user_cache_dir()), as the oldest files in it are deleted when it grows bigger
+ * than @disk_limit. It will be created if it doesn't exist.
+ *
+ * By default, thumbnails are not cached on disk.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_thumbnail_prefetcher_set_disk_cache (const gchar *directory, guint64 disk_limit)
+{
+	G_LOCK (cache);
+
+	g_free (disk_cache_directory);
+	disk_cache_directory = g_strdup (directory);
+	disk_cache_limit = disk_limit;
+
+	/* Re-scan the directory on the next insertion */
+	disk_cache_size = 0;
+	disk_cache_size_known = FALSE;
+
+	G_UNLOCK (cache);
+}
+
+static guint8 *
+download_thumbnail (GDataThumbnailPrefetcher *self, GDataMediaThumbnail *thumbnail, gsize *length, GCancellable *cancellable, GError **error)
+{
+	GDataDownloadStream *download_stream;
+	GByteArray *buffer;
+	guint8 read_buffer[READ_BUFFER_SIZE];
+	gssize length_read;
+
+	download_stream = gdata_media_thumbnail_download (thumbnail, self->priv->service, cancellable, error);
+	if (download_stream == NULL)
+		return NULL;
+
+	buffer = g_byte_array_new ();
+
+	while ((length_read = g_input_stream_read (G_INPUT_STREAM (download_stream), read_buffer, sizeof (read_buffer), cancellable, error)) > 0)
+		g_byte_array_append (buffer, read_buffer, length_read);
+
+	g_input_stream_close (G_INPUT_STREAM (download_stream), NULL, NULL);
+	g_object_unref (download_stream);
+
+	if (length_read < 0) {
+		g_byte_array_free (buffer, TRUE);
+		return NULL;
+	} else if (buffer->len == 0) {
+		g_byte_array_free (buffer, TRUE);
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR, _("The server returned an empty thumbnail."));
+		return NULL;
+	}
+
+	*length = buffer->len;
+	return g_byte_array_free (buffer, FALSE);
+}
+
+static void
+prefetch_request_free (PrefetchRequest *request)
+{
+	g_object_unref (request->entry);
+	g_object_unref (request->thumbnail);
+	g_free (request->data);
+	if (request->error != NULL)
+		g_error_free (request->error);
+
+	g_slice_free (PrefetchRequest, request);
+}
+
+static void
+prefetch_thread (PrefetchRequest *request, GDataThumbnailPrefetcher *self)
+{
+	const gchar *uri = gdata_media_thumbnail_get_uri (request->thumbnail);
+
+	request->data = cache_lookup (uri, &(request->length));
+
+	if (request->data == NULL) {
+		request->data = download_thumbnail (self, request->thumbnail, &(request->length), request->cancellable, &(request->error));
+
+		if (request->data != NULL)
+			cache_store (uri, request->data, request->length);
+	}
+
+	g_async_queue_push (request->results, request);
+}
+
+/* Run the user-supplied callback for a thumbnail which has arrived. This is designed to be used in an idle handler, so that the callback is run in
+ * the thread which started the prefetch. */
+static gboolean
+run_callback_cb (PrefetchRequest *request)
+{
+	request->callback (request->entry, request->thumbnail, request->data, request->length, request->error, request->user_data);
+	return FALSE;
+}
+
+static gboolean
+prefetch (GDataThumbnailPrefetcher *self, GDataFeed *feed, GDataThumbnailPrefetcherCallback callback, gpointer user_data, GMainContext *context,
+          gboolean is_async, GCancellable *cancellable, GError **error)
+{
+	GAsyncQueue *results;
+	GThreadPool *pool;
+	GList *i;
+	guint n_requests = 0;
+
+	results = g_async_queue_new ();
+	pool = g_thread_pool_new ((GFunc) prefetch_thread, self, self->priv->max_concurrent_downloads, FALSE, NULL);
+
+	for (i = gdata_feed_get_entries (feed); i != NULL; i = i->next) {
+		GDataMediaThumbnail *thumbnail;
+		PrefetchRequest *request;
+
+		thumbnail = gdata_thumbnail_prefetcher_choose_thumbnail (self, GDATA_ENTRY (i->data));
+		if (thumbnail == NULL || gdata_media_thumbnail_get_uri (thumbnail) == NULL)
+			continue;
+
+		request = g_slice_new0 (PrefetchRequest);
+		request->entry = g_object_ref (i->data);
+		request->thumbnail = g_object_ref (thumbnail);
+		request->callback = callback;
+		request->user_data = user_data;
+		request->cancellable = cancellable;
+		request->results = results;
+
+		g_thread_pool_push (pool, request, NULL);
+		n_requests++;
+	}
+
+	/* Deliver the thumbnails in the order they arrive. As with GDataBatchOperation, only dispatch the callbacks in the thread-default main
+	 * context of the thread which started the prefetch if it was started with *_prefetch_async(). */
+	for (; n_requests > 0; n_requests--) {
+		PrefetchRequest *request = g_async_queue_pop (results);
+
+		if (is_async == TRUE) {
+			_gdata_service_idle_add (context, (GSourceFunc) run_callback_cb, request, (GDestroyNotify) prefetch_request_free);
+		} else {
+			run_callback_cb (request);
+			prefetch_request_free (request);
+		}
+	}
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_async_queue_unref (results);
+
+	/* Errors fetching individual thumbnails are only reported to the callback */
+	return (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) ? FALSE : TRUE;
+}
+
+/**
+ * gdata_thumbnail_prefetcher_prefetch:
+ * @self: a #GDataThumbnailPrefetcher
+ * @feed: a #GDataFeed containing the entries to fetch thumbnails for
+ * @callback: (scope call): a #GDataThumbnailPrefetcherCallback to call as each thumbnail arrives
+ * @user_data: (closure): data to pass to the @callback function
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Fetches the best thumbnail for each of the entries in @feed, as chosen by gdata_thumbnail_prefetcher_choose_thumbnail(), and passes them to
+ * @callback synchronously (i.e. before gdata_thumbnail_prefetcher_prefetch() returns, and in the same thread that called it) as they arrive.
+ * Thumbnails which aren't in the cache are downloaded in parallel, up to #GDataThumbnailPrefetcher:max-concurrent-downloads at once.
+ *
+ * @callback is called once for each entry which has thumbnails, even if the thumbnail couldn't be fetched; such errors are only reported to
+ * @callback. Entries without any thumbnails are skipped.
+ *
+ * If @cancellable is cancelled, the thumbnails which haven't arrived yet are reported to @callback with %G_IO_ERROR_CANCELLED, and %FALSE is
+ * returned with the same error.
+ *
+ * Return value: %TRUE on success, %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_thumbnail_prefetcher_prefetch (GDataThumbnailPrefetcher *self, GDataFeed *feed, GDataThumbnailPrefetcherCallback callback, gpointer user_data,
+                                     GCancellable *cancellable, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_THUMBNAIL_PREFETCHER (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_FEED (feed), FALSE);
+	g_return_val_if_fail (callback != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return prefetch (self, feed, callback, user_data, NULL, FALSE, cancellable, error);
+}
+
+typedef struct {
+	GDataFeed *feed;
+	GDataThumbnailPrefetcherCallback callback;
+	gpointer user_data;
+	GDestroyNotify destroy_user_data;
+	GMainContext *context;
+	gboolean success;
+} PrefetchAsyncData;
+
+static void
+prefetch_async_data_free (PrefetchAsyncData *data)
+{
+	g_object_unref (data->feed);
+
+	if (data->destroy_user_data != NULL)
+		data->destroy_user_data (data->user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (PrefetchAsyncData, data);
+}
+
+static void
+prefetch_thread_cb (GSimpleAsyncResult *result, GDataThumbnailPrefetcher *self, GCancellable *cancellable)
+{
+	PrefetchAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	data->success = prefetch (self, data->feed, data->callback, data->user_data, data->context, TRUE, cancellable, &error);
+
+	if (data->success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_thumbnail_prefetcher_prefetch_async:
+ * @self: a #GDataThumbnailPrefetcher
+ * @feed: a #GDataFeed containing the entries to fetch thumbnails for
+ * @thumbnail_callback: (scope notified): a #GDataThumbnailPrefetcherCallback to call as each thumbnail arrives
+ * @thumbnail_user_data: (closure): data to pass to the @thumbnail_callback function
+ * @destroy_thumbnail_user_data: (allow-none): the function to call when @thumbnail_callback will not be called any more, or %NULL
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when all the thumbnails have arrived, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Fetches the thumbnails for the entries in @feed asynchronously, passing them to @thumbnail_callback as they arrive, in idle functions in the
+ * thread-default main context of the thread which called this function (see g_main_context_push_thread_default()). @self and @feed are reffed when
+ * this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_thumbnail_prefetcher_prefetch(), which is the synchronous version of this function.
+ *
+ * When all the thumbnails have been delivered, @callback will be called. You can then call gdata_thumbnail_prefetcher_prefetch_finish() to get the
+ * results of the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_thumbnail_prefetcher_prefetch_async (GDataThumbnailPrefetcher *self, GDataFeed *feed, GDataThumbnailPrefetcherCallback thumbnail_callback,
+                                           gpointer thumbnail_user_data, GDestroyNotify destroy_thumbnail_user_data,
+                                           GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	PrefetchAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_THUMBNAIL_PREFETCHER (self));
+	g_return_if_fail (GDATA_IS_FEED (feed));
+	g_return_if_fail (thumbnail_callback != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	data = g_slice_new0 (PrefetchAsyncData);
+	data->feed = g_object_ref (feed);
+	data->callback = thumbnail_callback;
+	data->user_data = thumbnail_user_data;
+	data->destroy_user_data = destroy_thumbnail_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	/* The data (and so the callback's user data) is freed when the result is, which is after all the thumbnail callbacks have been dispatched */
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_thumbnail_prefetcher_prefetch_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) prefetch_async_data_free);
+
+	/* Disable handling of cancellation so that the thumbnail callbacks are always called, as in the synchronous case */
+	g_simple_async_result_set_handle_cancellation (result, FALSE);
+
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) prefetch_thread_cb, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_thumbnail_prefetcher_prefetch_finish:
+ * @self: a #GDataThumbnailPrefetcher
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous prefetch started with gdata_thumbnail_prefetcher_prefetch_async().
+ *
+ * Return values are as for gdata_thumbnail_prefetcher_prefetch().
+ *
+ * Return value: %TRUE on success, %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_thumbnail_prefetcher_prefetch_finish (GDataThumbnailPrefetcher *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	PrefetchAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_THUMBNAIL_PREFETCHER (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_thumbnail_prefetcher_prefetch_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	data = g_simple_async_result_get_op_res_gpointer (result);
+	return data->success;
+}
@@ -0,0 +1,115 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_THUMBNAIL_PREFETCHER_H
+#define GDATA_THUMBNAIL_PREFETCHER_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/gdata-service.h>
+#include <gdata/gdata-entry.h>
+#include <gdata/gdata-feed.h>
+#include <gdata/media/gdata-media-thumbnail.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDataThumbnailPrefetcherCallback:
+ * @entry: the entry the thumbnail belongs to
+ * @thumbnail: the thumbnail which was chosen for @entry
+ * @data: (array length=length) (allow-none): the thumbnail's image data, or %NULL
+ * @length: the length of @data, in bytes
+ * @error: a #GError describing any error which occurred, or %NULL
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called once for each entry in a #GDataThumbnailPrefetcher run which has any thumbnails, as soon as the image data for the
+ * best of them is available (either from the cache or from the network).
+ *
+ * If the thumbnail was fetched successfully, @data will contain its image data and @error will be %NULL. Otherwise, @data will be %NULL and a
+ * descriptive error will be in @error. @data and @error are owned by the prefetcher and are only valid for the duration of the callback; if the
+ * callback code needs to retain the data, it must copy it.
+ *
+ * As with #GDataBatchOperationCallback, the callback is called in the thread which called gdata_thumbnail_prefetcher_prefetch(), or in the main
+ * thread if gdata_thumbnail_prefetcher_prefetch_async() was used. Thumbnails may arrive in any order.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataThumbnailPrefetcherCallback) (GDataEntry *entry, GDataMediaThumbnail *thumbnail, const guint8 *data, gsize length,
+                                                  GError *error, gpointer user_data);
+
+#define GDATA_TYPE_THUMBNAIL_PREFETCHER			(gdata_thumbnail_prefetcher_get_type ())
+#define GDATA_THUMBNAIL_PREFETCHER(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_THUMBNAIL_PREFETCHER, GDataThumbnailPrefetcher))
+#define GDATA_THUMBNAIL_PREFETCHER_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_THUMBNAIL_PREFETCHER, GDataThumbnailPrefetcherClass))
+#define GDATA_IS_THUMBNAIL_PREFETCHER(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_THUMBNAIL_PREFETCHER))
+#define GDATA_IS_THUMBNAIL_PREFETCHER_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_THUMBNAIL_PREFETCHER))
+#define GDATA_THUMBNAIL_PREFETCHER_GET_CLASS(o)		(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_THUMBNAIL_PREFETCHER, GDataThumbnailPrefetcherClass))
+
+typedef struct _GDataThumbnailPrefetcherPrivate	GDataThumbnailPrefetcherPrivate;
+
+/**
+ * GDataThumbnailPrefetcher:
+ *
+ * All the fields in the #GDataThumbnailPrefetcher structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataThumbnailPrefetcherPrivate *priv;
+} GDataThumbnailPrefetcher;
+
+/**
+ * GDataThumbnailPrefetcherClass:
+ *
+ * All the fields in the #GDataThumbnailPrefetcherClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataThumbnailPrefetcherClass;
+
+GType gdata_thumbnail_prefetcher_get_type (void) G_GNUC_CONST;
+
+GDataThumbnailPrefetcher *gdata_thumbnail_prefetcher_new (GDataService *service, guint width, guint height) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataService *gdata_thumbnail_prefetcher_get_service (GDataThumbnailPrefetcher *self) G_GNUC_PURE;
+guint gdata_thumbnail_prefetcher_get_width (GDataThumbnailPrefetcher *self) G_GNUC_PURE;
+guint gdata_thumbnail_prefetcher_get_height (GDataThumbnailPrefetcher *self) G_GNUC_PURE;
+guint gdata_thumbnail_prefetcher_get_max_concurrent_downloads (GDataThumbnailPrefetcher *self) G_GNUC_PURE;
+void gdata_thumbnail_prefetcher_set_max_concurrent_downloads (GDataThumbnailPrefetcher *self, guint max_concurrent_downloads);
+
+GDataMediaThumbnail *gdata_thumbnail_prefetcher_choose_thumbnail (GDataThumbnailPrefetcher *self, GDataEntry *entry);
+
+gboolean gdata_thumbnail_prefetcher_prefetch (GDataThumbnailPrefetcher *self, GDataFeed *feed, GDataThumbnailPrefetcherCallback callback,
+                                              gpointer user_data, GCancellable *cancellable, GError **error);
+void gdata_thumbnail_prefetcher_prefetch_async (GDataThumbnailPrefetcher *self, GDataFeed *feed, GDataThumbnailPrefetcherCallback thumbnail_callback,
+                                                gpointer thumbnail_user_data, GDestroyNotify destroy_thumbnail_user_data,
+                                                GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_thumbnail_prefetcher_prefetch_finish (GDataThumbnailPrefetcher *self, GAsyncResult *async_result, GError **error);
+
+void gdata_thumbnail_prefetcher_set_memory_cache_limit (gsize memory_limit);
+void gdata_thumbnail_prefetcher_set_disk_cache (const gchar *directory, guint64 disk_limit);
+
+G_END_DECLS
+
+#endif /* !GDATA_THUMBNAIL_PREFETCHER_H */
@@ -0,0 +1,58 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_TRACE_H
+#define GDATA_TRACE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Static tracepoints on libgdata's hot paths, in the "libgdata" provider. When built with HAVE_TRACEPOINTS, these are USDT probes from
+ * <sys/sdt.h>, which compile to a single NOP at the probe site plus a note in the ELF file, so they cost nothing until a tracer (perf, bpftrace,
+ * SystemTap, etc.) attaches to them. For example:
+ *
+ *   perf probe -x libgdata.so sdt_libgdata:send_start
+ *   bpftrace -e 'usdt:libgdata.so:libgdata:parse_entry_end { @[arg0] = count (); }'
+ *
+ * The probe arguments are still evaluated when no tracer is attached, so they must only ever be cheap expressions (pointers and integers already
+ * in hand), never function calls which allocate or take locks.
+ *
+ * Otherwise, the macros expand to nothing.
+ */
+#ifdef HAVE_TRACEPOINTS
+#include <sys/sdt.h>
+
+#define GDATA_TRACE(name) DTRACE_PROBE (libgdata, name)
+#define GDATA_TRACE1(name, a) DTRACE_PROBE1 (libgdata, name, a)
+#define GDATA_TRACE2(name, a, b) DTRACE_PROBE2 (libgdata, name, a, b)
+#define GDATA_TRACE3(name, a, b, c) DTRACE_PROBE3 (libgdata, name, a, b, c)
+#define GDATA_TRACE4(name, a, b, c, d) DTRACE_PROBE4 (libgdata, name, a, b, c, d)
+#else /* !HAVE_TRACEPOINTS */
+#define GDATA_TRACE(name) G_STMT_START { } G_STMT_END
+#define GDATA_TRACE1(name, a) G_STMT_START { } G_STMT_END
+#define GDATA_TRACE2(name, a, b) G_STMT_START { } G_STMT_END
+#define GDATA_TRACE3(name, a, b, c) G_STMT_START { } G_STMT_END
+#define GDATA_TRACE4(name, a, b, c, d) G_STMT_START { } G_STMT_END
+#endif /* !HAVE_TRACEPOINTS */
+
+G_END_DECLS
+
+#endif /* !GDATA_TRACE_H */
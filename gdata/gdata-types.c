@@ -34,6 +34,7 @@
 #include <libsoup/soup.h>
 
 #include "gdata-types.h"
+#include "gdata-private.h"
 
 static gpointer
 gdata_color_copy (gpointer color)
@@ -55,6 +56,123 @@ gdata_color_get_type (void)
 	return type_id;
 }
 
+/* Value of each hexadecimal digit, or -1 for characters which aren't hexadecimal digits (including nul) */
+static const gint8 hex_digit_values[256] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+static const gchar hex_digits[] = "0123456789abcdef";
+
+/*
+ * _gdata_color_pack:
+ * @color: a #GDataColor
+ *
+ * Packs @color into a 32-bit value of the form <literal>0x00<replaceable>rrggbb</replaceable></literal>, for compact storage.
+ *
+ * Return value: the packed color
+ *
+ * Since: 0.15.0
+ */
+guint32
+_gdata_color_pack (const GDataColor *color)
+{
+	return ((guint32) (color->red & 0xff) << 16) | ((guint32) (color->green & 0xff) << 8) | (guint32) (color->blue & 0xff);
+}
+
+/*
+ * _gdata_color_unpack:
+ * @packed: a color packed with _gdata_color_pack()
+ * @color: (out caller-allocates): return location for the #GDataColor
+ *
+ * Unpacks @packed into @color.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_color_unpack (guint32 packed, GDataColor *color)
+{
+	color->red = (packed >> 16) & 0xff;
+	color->green = (packed >> 8) & 0xff;
+	color->blue = packed & 0xff;
+}
+
+/*
+ * _gdata_color_parse_packed:
+ * @hexadecimal: a hexadecimal color string
+ * @packed: (out caller-allocates): return location for the packed color
+ *
+ * Parses @hexadecimal as gdata_color_from_hexadecimal() does, but returns the color packed as by _gdata_color_pack(). This doesn't allocate any
+ * memory. @packed is only modified on success.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+_gdata_color_parse_packed (const gchar *hexadecimal, guint32 *packed)
+{
+	const guchar *i;
+	guint32 value = 0;
+	guint j;
+
+	i = (const guchar*) hexadecimal;
+	if (*i == '#')
+		i++;
+
+	/* The nul terminator isn't a hexadecimal digit, so this stops at the end of short strings */
+	for (j = 0; j < 6; j++, i++) {
+		gint8 digit = hex_digit_values[*i];
+
+		if (digit < 0)
+			return FALSE;
+		value = (value << 4) | (guint32) digit;
+	}
+
+	if (*i != '\0')
+		return FALSE;
+
+	*packed = value;
+	return TRUE;
+}
+
+/*
+ * _gdata_color_append_hexadecimal:
+ * @xml_string: the string to append to
+ * @packed: a color packed with _gdata_color_pack()
+ *
+ * Appends @packed to @xml_string in the form produced by gdata_color_to_hexadecimal(), without allocating a temporary string.
+ *
+ * Since: 0.15.0
+ */
+void
+_gdata_color_append_hexadecimal (GString *xml_string, guint32 packed)
+{
+	gchar buf[8];
+	guint j;
+
+	buf[0] = '#';
+	for (j = 0; j < 6; j++)
+		buf[j + 1] = hex_digits[(packed >> (20 - 4 * j)) & 0xf];
+	buf[7] = '\0';
+
+	g_string_append_len (xml_string, buf, 7);
+}
+
 /**
  * gdata_color_from_hexadecimal:
  * @hexadecimal: a hexadecimal color string
@@ -71,45 +189,15 @@ gdata_color_get_type (void)
 gboolean
 gdata_color_from_hexadecimal (const gchar *hexadecimal, GDataColor *color)
 {
-	gint temp;
+	guint32 packed;
 
 	g_return_val_if_fail (hexadecimal != NULL, FALSE);
 	g_return_val_if_fail (color != NULL, FALSE);
 
-	if (*hexadecimal == '#')
-		hexadecimal++;
-	if (strlen (hexadecimal) != 6)
-		return FALSE;
-
-	/* Red */
-	temp = g_ascii_xdigit_value (*(hexadecimal++)) * 16;
-	if (temp < 0)
-		return FALSE;
-	color->red = temp;
-	temp = g_ascii_xdigit_value (*(hexadecimal++));
-	if (temp < 0)
-		return FALSE;
-	color->red += temp;
-
-	/* Green */
-	temp = g_ascii_xdigit_value (*(hexadecimal++)) * 16;
-	if (temp < 0)
-		return FALSE;
-	color->green = temp;
-	temp = g_ascii_xdigit_value (*(hexadecimal++));
-	if (temp < 0)
+	if (_gdata_color_parse_packed (hexadecimal, &packed) == FALSE)
 		return FALSE;
-	color->green += temp;
 
-	/* Blue */
-	temp = g_ascii_xdigit_value (*(hexadecimal++)) * 16;
-	if (temp < 0)
-		return FALSE;
-	color->blue = temp;
-	temp = g_ascii_xdigit_value (*(hexadecimal++));
-	if (temp < 0)
-		return FALSE;
-	color->blue += temp;
+	_gdata_color_unpack (packed, color);
 
 	return TRUE;
 }
@@ -129,6 +217,12 @@ gdata_color_from_hexadecimal (const gchar *hexadecimal, GDataColor *color)
 gchar *
 gdata_color_to_hexadecimal (const GDataColor *color)
 {
+	GString *hexadecimal;
+
 	g_return_val_if_fail (color != NULL, NULL);
-	return g_strdup_printf ("#%02x%02x%02x", color->red, color->green, color->blue);
+
+	hexadecimal = g_string_sized_new (8);
+	_gdata_color_append_hexadecimal (hexadecimal, _gdata_color_pack (color));
+
+	return g_string_free (hexadecimal, FALSE);
 }
@@ -0,0 +1,897 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-upload-queue
+ * @short_description: GData upload queue object
+ * @stability: Unstable
+ * @include: gdata/gdata-upload-queue.h
+ *
+ * #GDataUploadQueue is a transient standalone class which uploads a number of files to a service, several at once. It saves applications which
+ * upload many files at a time (for example, a whole album of photos) from having to schedule the #GDataUploadStream<!-- -->s themselves.
+ *
+ * To use an upload queue: create one for the service using gdata_youtube_service_create_upload_queue() or
+ * gdata_picasaweb_service_create_upload_queue(); add the files to upload, and the metadata entries to upload with them, using
+ * gdata_upload_queue_add_file(); run the queue with gdata_upload_queue_run() or gdata_upload_queue_run_async(); and handle the uploaded entries in
+ * the callback functions, which are invoked by the queue as each upload finishes.
+ *
+ * Up to #GDataUploadQueue:max-concurrent-uploads files are uploaded at once, sharing the service's connection pool. Uploads which fail due to
+ * transient network or server problems are retried from the start, up to #GDataUploadQueue:max-retries times each, with an increasing delay between
+ * attempts. The overall progress of the queue can be retrieved at any time (from any thread) using gdata_upload_queue_get_progress() and
+ * gdata_upload_queue_get_throughput().
+ *
+ * <example>
+ *	<title>Uploading an Album of Photos</title>
+ *	<programlisting>
+ *	GDataPicasaWebService *service;
+ *	GDataUploadQueue *queue;
+ *	GList *i;
+ *
+ *	service = create_picasaweb_service ();
+ *	queue = gdata_picasaweb_service_create_upload_queue (service, album);
+ *	gdata_upload_queue_set_max_concurrent_uploads (queue, 6);
+ *
+ *	for (i = photo_files; i != NULL; i = i->next) {
+ *		GDataPicasaWebFile *file_entry = gdata_picasaweb_file_new (NULL);
+ *		gdata_entry_set_title (GDATA_ENTRY (file_entry), g_file_get_basename (i->data));
+ *
+ *		gdata_upload_queue_add_file (queue, GDATA_ENTRY (file_entry), G_FILE (i->data), uploaded_cb, NULL);
+ *		g_object_unref (file_entry);
+ *	}
+ *
+ *	/<!-- -->* Run the uploads without blocking, and update a progress bar periodically using gdata_upload_queue_get_progress() *<!-- -->/
+ *	gdata_upload_queue_run_async (queue, NULL, (GAsyncReadyCallback) queue_finished_cb, NULL);
+ *	g_timeout_add (500, (GSourceFunc) update_progress_bar_cb, queue);
+ *
+ *	g_object_unref (queue);
+ *	g_object_unref (service);
+ *
+ *	static void
+ *	uploaded_cb (guint upload_id, GDataEntry *entry, GDataEntry *uploaded_entry, GError *error, gpointer user_data)
+ *	{
+ *		if (error != NULL) {
+ *			g_warning ("Error uploading ‘%s’: %s", gdata_entry_get_title (entry), error->message);
+ *			return;
+ *		}
+ *
+ *		/<!-- -->* Do something with the uploaded entry, referencing it if it needs to stay alive after the callback returns *<!-- -->/
+ *		add_photo_to_ui (GDATA_PICASAWEB_FILE (uploaded_entry));
+ *	}
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <string.h>
+
+#include "gdata-upload-queue.h"
+#include "gdata-upload-stream.h"
+#include "gdata-private.h"
+
+/* Size of the buffer used to copy each file into its upload stream */
+#define COPY_BUFFER_SIZE (64 * 1024)
+
+/* Delay before the first retry of a failed upload; this doubles on each subsequent retry */
+#define RETRY_DELAY (G_USEC_PER_SEC)
+
+typedef struct {
+	guint id;
+	GDataEntry *entry;
+	GFile *file;
+	GDataUploadQueueCallback callback;
+	gpointer user_data;
+
+	/* Only valid while the queue's running */
+	gchar *slug;
+	gchar *content_type;
+	goffset size;
+	GDataEntry *uploaded_entry;
+	GError *error;
+	GCancellable *cancellable;
+	GAsyncQueue *results;
+} QueuedUpload;
+
+static void queued_upload_free (QueuedUpload *upload);
+
+static void gdata_upload_queue_dispose (GObject *object);
+static void gdata_upload_queue_finalize (GObject *object);
+static void gdata_upload_queue_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_upload_queue_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataUploadQueuePrivate {
+	GDataService *service;
+	GType entry_type;
+	GDataUploadQueueStartFunc start_func;
+	GDataUploadQueueFinishFunc finish_func;
+	gpointer func_data;
+	GDestroyNotify func_data_destroy;
+
+	GPtrArray *uploads; /* QueuedUploads, in the order they were added */
+	guint next_id; /* next available upload ID */
+	gboolean has_run; /* TRUE if the queue has been run already (though it does not necessarily have to have finished running) */
+	gboolean is_async; /* TRUE if the queue was run with *_run_async(); FALSE if run with *_run() */
+	GMainContext *context; /* thread-default main context of the thread which called *_run_async(), to dispatch the callbacks in */
+	guint max_concurrent_uploads;
+	guint max_retries;
+
+	/* Progress of the current run; these can be read from any thread */
+	GMutex progress_mutex; /* protects all the members below */
+	guint uploads_finished;
+	guint uploads_total;
+	goffset bytes_uploaded;
+	goffset bytes_total;
+	gint64 start_time; /* monotonic time the run started, or 0 */
+	gint64 end_time; /* monotonic time the run finished, or 0 */
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_MAX_CONCURRENT_UPLOADS,
+	PROP_MAX_RETRIES,
+};
+
+G_DEFINE_TYPE (GDataUploadQueue, gdata_upload_queue, G_TYPE_OBJECT)
+
+static void
+gdata_upload_queue_class_init (GDataUploadQueueClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataUploadQueuePrivate));
+
+	gobject_class->dispose = gdata_upload_queue_dispose;
+	gobject_class->finalize = gdata_upload_queue_finalize;
+	gobject_class->get_property = gdata_upload_queue_get_property;
+	gobject_class->set_property = gdata_upload_queue_set_property;
+
+	/**
+	 * GDataUploadQueue:service:
+	 *
+	 * The service the files are being uploaded to.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service the files are being uploaded to.",
+	                                                      GDATA_TYPE_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataUploadQueue:max-concurrent-uploads:
+	 *
+	 * The maximum number of files to upload at once. Each upload uses its own connection, so this is also limited by the service's
+	 * #GDataService:max-connections-per-host.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MAX_CONCURRENT_UPLOADS,
+	                                 g_param_spec_uint ("max-concurrent-uploads",
+	                                                    "Maximum concurrent uploads", "The maximum number of files to upload at once.",
+	                                                    1, G_MAXUINT, 4,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataUploadQueue:max-retries:
+	 *
+	 * The maximum number of times to retry each upload if it fails due to a transient problem, such as a network error or the service being
+	 * temporarily unavailable. Uploads which fail for other reasons (such as the file not existing, or the user not being authorized) are never
+	 * retried.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MAX_RETRIES,
+	                                 g_param_spec_uint ("max-retries",
+	                                                    "Maximum retries", "The maximum number of times to retry each failed upload.",
+	                                                    0, G_MAXUINT, 3,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_upload_queue_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataUploadQueuePrivate *priv = GDATA_UPLOAD_QUEUE (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_MAX_CONCURRENT_UPLOADS:
+			g_value_set_uint (value, priv->max_concurrent_uploads);
+			break;
+		case PROP_MAX_RETRIES:
+			g_value_set_uint (value, priv->max_retries);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_upload_queue_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataUploadQueuePrivate *priv = GDATA_UPLOAD_QUEUE (object)->priv;
+
+	switch (property_id) {
+		/* Construct only */
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_MAX_CONCURRENT_UPLOADS:
+			gdata_upload_queue_set_max_concurrent_uploads (GDATA_UPLOAD_QUEUE (object), g_value_get_uint (value));
+			break;
+		case PROP_MAX_RETRIES:
+			gdata_upload_queue_set_max_retries (GDATA_UPLOAD_QUEUE (object), g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_upload_queue_init (GDataUploadQueue *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_UPLOAD_QUEUE, GDataUploadQueuePrivate);
+	self->priv->next_id = 1; /* reserve ID 0 for error conditions */
+	self->priv->max_concurrent_uploads = 4;
+	self->priv->max_retries = 3;
+	self->priv->uploads = g_ptr_array_new_with_free_func ((GDestroyNotify) queued_upload_free);
+	g_mutex_init (&(self->priv->progress_mutex));
+}
+
+static void
+gdata_upload_queue_dispose (GObject *object)
+{
+	GDataUploadQueuePrivate *priv = GDATA_UPLOAD_QUEUE (object)->priv;
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	if (priv->func_data_destroy != NULL && priv->func_data != NULL)
+		priv->func_data_destroy (priv->func_data);
+	priv->func_data = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_upload_queue_parent_class)->dispose (object);
+}
+
+static void
+gdata_upload_queue_finalize (GObject *object)
+{
+	GDataUploadQueuePrivate *priv = GDATA_UPLOAD_QUEUE (object)->priv;
+
+	g_ptr_array_unref (priv->uploads);
+	g_mutex_clear (&(priv->progress_mutex));
+
+	if (priv->context != NULL)
+		g_main_context_unref (priv->context);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_upload_queue_parent_class)->finalize (object);
+}
+
+/*
+ * _gdata_upload_queue_new:
+ * @service: the #GDataService to upload to
+ * @entry_type: the #GType of the entries which will be uploaded
+ * @start_func: function to start the upload of a file, returning its #GDataUploadStream
+ * @finish_func: function to parse the uploaded entry from a finished #GDataUploadStream
+ * @func_data: (allow-none): data to pass to @start_func and @finish_func
+ * @func_data_destroy: (allow-none): function to free @func_data when the queue is disposed of, or %NULL
+ *
+ * Creates a new #GDataUploadQueue for uploading entries of type @entry_type to @service. This is intended to be called by the
+ * <function>create_upload_queue</function> functions of services which support uploading files, which provide @start_func and @finish_func as
+ * wrappers around their own upload functions.
+ *
+ * Return value: (transfer full): a new #GDataUploadQueue; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataUploadQueue *
+_gdata_upload_queue_new (GDataService *service, GType entry_type, GDataUploadQueueStartFunc start_func, GDataUploadQueueFinishFunc finish_func,
+                         gpointer func_data, GDestroyNotify func_data_destroy)
+{
+	GDataUploadQueue *self;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (g_type_is_a (entry_type, GDATA_TYPE_ENTRY), NULL);
+	g_return_val_if_fail (start_func != NULL, NULL);
+	g_return_val_if_fail (finish_func != NULL, NULL);
+
+	self = g_object_new (GDATA_TYPE_UPLOAD_QUEUE, "service", service, NULL);
+	self->priv->entry_type = entry_type;
+	self->priv->start_func = start_func;
+	self->priv->finish_func = finish_func;
+	self->priv->func_data = func_data;
+	self->priv->func_data_destroy = func_data_destroy;
+
+	return self;
+}
+
+/**
+ * gdata_upload_queue_get_service:
+ * @self: a #GDataUploadQueue
+ *
+ * Gets the #GDataUploadQueue:service property.
+ *
+ * Return value: (transfer none): the service the files are being uploaded to
+ *
+ * Since: 0.15.0
+ */
+GDataService *
+gdata_upload_queue_get_service (GDataUploadQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_UPLOAD_QUEUE (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_upload_queue_get_max_concurrent_uploads:
+ * @self: a #GDataUploadQueue
+ *
+ * Gets the #GDataUploadQueue:max-concurrent-uploads property.
+ *
+ * Return value: the maximum number of files to upload at once
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_upload_queue_get_max_concurrent_uploads (GDataUploadQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_UPLOAD_QUEUE (self), 0);
+	return self->priv->max_concurrent_uploads;
+}
+
+/**
+ * gdata_upload_queue_set_max_concurrent_uploads:
+ * @self: a #GDataUploadQueue
+ * @max_concurrent_uploads: the maximum number of files to upload at once
+ *
+ * Sets the #GDataUploadQueue:max-concurrent-uploads property. This must be called before the queue is run. @max_concurrent_uploads must be
+ * at least <code class="literal">1</code>.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_queue_set_max_concurrent_uploads (GDataUploadQueue *self, guint max_concurrent_uploads)
+{
+	g_return_if_fail (GDATA_IS_UPLOAD_QUEUE (self));
+	g_return_if_fail (max_concurrent_uploads > 0);
+	g_return_if_fail (self->priv->has_run == FALSE);
+
+	self->priv->max_concurrent_uploads = max_concurrent_uploads;
+	g_object_notify (G_OBJECT (self), "max-concurrent-uploads");
+}
+
+/**
+ * gdata_upload_queue_get_max_retries:
+ * @self: a #GDataUploadQueue
+ *
+ * Gets the #GDataUploadQueue:max-retries property.
+ *
+ * Return value: the maximum number of times to retry each failed upload
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_upload_queue_get_max_retries (GDataUploadQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_UPLOAD_QUEUE (self), 0);
+	return self->priv->max_retries;
+}
+
+/**
+ * gdata_upload_queue_set_max_retries:
+ * @self: a #GDataUploadQueue
+ * @max_retries: the maximum number of times to retry each failed upload
+ *
+ * Sets the #GDataUploadQueue:max-retries property. This must be called before the queue is run. Set @max_retries to
+ * <code class="literal">0</code> to never retry uploads.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_queue_set_max_retries (GDataUploadQueue *self, guint max_retries)
+{
+	g_return_if_fail (GDATA_IS_UPLOAD_QUEUE (self));
+	g_return_if_fail (self->priv->has_run == FALSE);
+
+	self->priv->max_retries = max_retries;
+	g_object_notify (G_OBJECT (self), "max-retries");
+}
+
+static void
+queued_upload_free (QueuedUpload *upload)
+{
+	g_object_unref (upload->entry);
+	g_object_unref (upload->file);
+	g_free (upload->slug);
+	g_free (upload->content_type);
+	if (upload->uploaded_entry != NULL)
+		g_object_unref (upload->uploaded_entry);
+	if (upload->error != NULL)
+		g_error_free (upload->error);
+
+	g_slice_free (QueuedUpload, upload);
+}
+
+/**
+ * gdata_upload_queue_add_file:
+ * @self: a #GDataUploadQueue
+ * @entry: the metadata to upload with the file
+ * @file: the file to upload
+ * @callback: (scope async): a #GDataUploadQueueCallback to call when the upload is finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Add a file to be uploaded when the #GDataUploadQueue is run. @entry must be of the type of entries expected by the service, for example a
+ * #GDataYouTubeVideo for a queue created by gdata_youtube_service_create_upload_queue(), and must not have been inserted on the server already.
+ * Both @entry and @file are reffed by the queue, so may be unreffed after this function returns.
+ *
+ * The file's content type and size are looked up when the queue is run, and its display name is used as the slug for the upload.
+ *
+ * This must be called before the queue is run.
+ *
+ * Return value: the upload's ID, which is passed to @callback when the upload finishes
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_upload_queue_add_file (GDataUploadQueue *self, GDataEntry *entry, GFile *file, GDataUploadQueueCallback callback, gpointer user_data)
+{
+	QueuedUpload *upload;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_QUEUE (self), 0);
+	g_return_val_if_fail (g_type_is_a (G_OBJECT_TYPE (entry), self->priv->entry_type), 0);
+	g_return_val_if_fail (G_IS_FILE (file), 0);
+	g_return_val_if_fail (self->priv->has_run == FALSE, 0);
+
+	upload = g_slice_new0 (QueuedUpload);
+	upload->id = self->priv->next_id++;
+	upload->entry = g_object_ref (entry);
+	upload->file = g_object_ref (file);
+	upload->callback = callback;
+	upload->user_data = user_data;
+
+	g_ptr_array_add (self->priv->uploads, upload);
+
+	return upload->id;
+}
+
+static void
+add_progress (GDataUploadQueue *self, gssize bytes_uploaded, guint uploads_finished)
+{
+	g_mutex_lock (&(self->priv->progress_mutex));
+	self->priv->bytes_uploaded += bytes_uploaded;
+	self->priv->uploads_finished += uploads_finished;
+	g_mutex_unlock (&(self->priv->progress_mutex));
+}
+
+static gboolean
+is_transient_error (const GError *error)
+{
+	return (g_error_matches (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_UNAVAILABLE) == TRUE ||
+	        g_error_matches (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NETWORK_ERROR) == TRUE ||
+	        g_error_matches (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROXY_ERROR) == TRUE ||
+	        g_error_matches (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT) == TRUE ||
+	        g_error_matches (error, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE) == TRUE) ? TRUE : FALSE;
+}
+
+/* Waits for @delay microseconds, or until @cancellable is cancelled */
+static void
+wait_before_retry (gint64 delay, GCancellable *cancellable)
+{
+	gint64 end_time = g_get_monotonic_time () + delay;
+	gint64 now;
+
+	while ((now = g_get_monotonic_time ()) < end_time && g_cancellable_is_cancelled (cancellable) == FALSE)
+		g_usleep (MIN (end_time - now, G_USEC_PER_SEC / 10));
+}
+
+/* Makes a single attempt at uploading @upload. On failure, the progress made by the attempt is subtracted from the queue's progress again. */
+static GDataEntry *
+upload_file (GDataUploadQueue *self, QueuedUpload *upload, guint8 *buffer, GError **error)
+{
+	GDataUploadQueuePrivate *priv = self->priv;
+	GInputStream *input_stream;
+	GDataUploadStream *upload_stream;
+	GDataEntry *uploaded_entry = NULL;
+	goffset attempt_bytes = 0;
+	gssize length_read;
+
+	input_stream = G_INPUT_STREAM (g_file_read (upload->file, upload->cancellable, error));
+	if (input_stream == NULL)
+		return NULL;
+
+	upload_stream = priv->start_func (priv->service, upload->entry, upload->slug, upload->content_type, upload->cancellable, priv->func_data,
+	                                  error);
+	if (upload_stream == NULL) {
+		g_object_unref (input_stream);
+		return NULL;
+	}
+
+	/* Copy the file into the upload stream, keeping track of the progress. This is equivalent to g_output_stream_splice(). */
+	while ((length_read = g_input_stream_read (input_stream, buffer, COPY_BUFFER_SIZE, upload->cancellable, error)) > 0) {
+		if (g_output_stream_write_all (G_OUTPUT_STREAM (upload_stream), buffer, length_read, NULL, upload->cancellable, error) == FALSE) {
+			length_read = -1;
+			break;
+		}
+
+		attempt_bytes += length_read;
+		add_progress (self, length_read, 0);
+	}
+
+	if (length_read == 0 && g_output_stream_close (G_OUTPUT_STREAM (upload_stream), upload->cancellable, error) == TRUE) {
+		uploaded_entry = priv->finish_func (priv->service, upload_stream, priv->func_data, error);
+
+		if (uploaded_entry == NULL && error != NULL && *error == NULL) {
+			g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+			                     _("The server returned a malformed response."));
+		}
+	}
+
+	g_input_stream_close (input_stream, NULL, NULL);
+	g_object_unref (input_stream);
+	g_object_unref (upload_stream);
+
+	if (uploaded_entry == NULL)
+		add_progress (self, -attempt_bytes, 0);
+
+	return uploaded_entry;
+}
+
+static void
+upload_thread (QueuedUpload *upload, GDataUploadQueue *self)
+{
+	guint8 *buffer;
+	guint attempt;
+
+	buffer = g_malloc (COPY_BUFFER_SIZE);
+
+	for (attempt = 0; TRUE; attempt++) {
+		GError *child_error = NULL;
+
+		upload->uploaded_entry = upload_file (self, upload, buffer, &child_error);
+
+		if (upload->uploaded_entry != NULL || attempt >= self->priv->max_retries || is_transient_error (child_error) == FALSE ||
+		    g_cancellable_is_cancelled (upload->cancellable) == TRUE) {
+			upload->error = child_error;
+			break;
+		}
+
+		g_debug ("Retrying upload %u after error: %s", upload->id, child_error->message);
+		g_error_free (child_error);
+
+		wait_before_retry ((gint64) RETRY_DELAY << MIN (attempt, 6), upload->cancellable);
+	}
+
+	g_free (buffer);
+
+	add_progress (self, 0, 1);
+	g_async_queue_push (upload->results, upload);
+}
+
+/* Run the user-supplied callback for an upload which has finished. This is designed to be used in an idle handler, so that the callback is run in
+ * the main context the queue was run from. */
+static gboolean
+run_callback_cb (QueuedUpload *upload)
+{
+	if (upload->callback != NULL)
+		upload->callback (upload->id, upload->entry, upload->uploaded_entry, upload->error, upload->user_data);
+
+	/* Unset the callback so that it can't be called again */
+	upload->callback = NULL;
+
+	return FALSE;
+}
+
+static void
+run_callback (GDataUploadQueue *self, QueuedUpload *upload)
+{
+	/* Don't bother scheduling run_callback_cb() if there is no callback to run */
+	if (upload->callback == NULL)
+		return;
+
+	/* As with GDataBatchOperation, only dispatch it in the calling thread's main context if the queue was run with *_run_async() */
+	if (self->priv->is_async == TRUE)
+		_gdata_service_idle_add (self->priv->context, (GSourceFunc) run_callback_cb, upload, NULL);
+	else
+		run_callback_cb (upload);
+}
+
+/**
+ * gdata_upload_queue_run:
+ * @self: a #GDataUploadQueue
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Run the #GDataUploadQueue synchronously. This will upload all the files which have been added to the queue, up to
+ * #GDataUploadQueue:max-concurrent-uploads at once, and call their respective callbacks synchronously (i.e. before gdata_upload_queue_run()
+ * returns, and in the same thread that called gdata_upload_queue_run()) as each upload finishes.
+ *
+ * The callbacks for all of the uploads in the queue are always guaranteed to be called, even if the uploads fail. The return value of the function
+ * indicates whether all the uploads were successful: if any of them failed, %FALSE is returned with the first error which occurred (the other uploads
+ * may still have succeeded, as reported to their callbacks).
+ *
+ * @cancellable can be used to cancel all the uploads which haven't finished yet. They will be reported to their callbacks with
+ * %G_IO_ERROR_CANCELLED.
+ *
+ * A #GDataUploadQueue can only be run once.
+ *
+ * Return value: %TRUE if all the uploads succeeded, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_upload_queue_run (GDataUploadQueue *self, GCancellable *cancellable, GError **error)
+{
+	GDataUploadQueuePrivate *priv = self->priv;
+	GAsyncQueue *results;
+	GThreadPool *pool;
+	GError *child_error = NULL;
+	guint i, n_uploads_started = 0;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_QUEUE (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (priv->has_run == FALSE, FALSE);
+
+	/* Ensure that this GDataUploadQueue can't be run again */
+	priv->has_run = TRUE;
+
+	/* Look up the size and content type of each file. Files which can't be read are reported to their callbacks immediately. */
+	g_mutex_lock (&(priv->progress_mutex));
+	priv->uploads_total = priv->uploads->len;
+	priv->start_time = g_get_monotonic_time ();
+	g_mutex_unlock (&(priv->progress_mutex));
+
+	for (i = 0; i < priv->uploads->len; i++) {
+		QueuedUpload *upload = g_ptr_array_index (priv->uploads, i);
+		GFileInfo *info;
+
+		info = g_file_query_info (upload->file, G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ","
+		                          G_FILE_ATTRIBUTE_STANDARD_SIZE, G_FILE_QUERY_INFO_NONE, cancellable, &(upload->error));
+		if (info == NULL)
+			continue;
+
+		upload->slug = g_strdup (g_file_info_get_display_name (info));
+		upload->content_type = g_content_type_get_mime_type (g_file_info_get_content_type (info));
+		upload->size = g_file_info_get_size (info);
+		g_object_unref (info);
+
+		g_mutex_lock (&(priv->progress_mutex));
+		priv->bytes_total += upload->size;
+		g_mutex_unlock (&(priv->progress_mutex));
+	}
+
+	/* Send the uploads. The network activity happens in parallel, but the callbacks are run in this thread, as documented above. */
+	results = g_async_queue_new ();
+	pool = g_thread_pool_new ((GFunc) upload_thread, self, priv->max_concurrent_uploads, FALSE, NULL);
+
+	for (i = 0; i < priv->uploads->len; i++) {
+		QueuedUpload *upload = g_ptr_array_index (priv->uploads, i);
+
+		if (upload->error != NULL) {
+			add_progress (self, 0, 1);
+			g_async_queue_push (results, upload);
+			continue;
+		}
+
+		upload->cancellable = cancellable;
+		upload->results = results;
+		g_thread_pool_push (pool, upload, NULL);
+		n_uploads_started++;
+	}
+
+	/* Process the results in the order they arrive */
+	for (i = 0; i < priv->uploads->len; i++) {
+		QueuedUpload *upload = g_async_queue_pop (results);
+
+		if (upload->error != NULL && child_error == NULL)
+			child_error = g_error_copy (upload->error);
+
+		run_callback (self, upload);
+	}
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_async_queue_unref (results);
+
+	g_mutex_lock (&(priv->progress_mutex));
+	priv->end_time = g_get_monotonic_time ();
+	g_mutex_unlock (&(priv->progress_mutex));
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+run_thread (GSimpleAsyncResult *result, GDataUploadQueue *queue, GCancellable *cancellable)
+{
+	gboolean success;
+	GError *error = NULL;
+
+	/* Run the upload queue and return */
+	success = gdata_upload_queue_run (queue, cancellable, &error);
+	g_simple_async_result_set_op_res_gboolean (result, success);
+
+	/* Propagate any errors */
+	if (success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_upload_queue_run_async:
+ * @self: a #GDataUploadQueue
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when all the uploads are finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Run the #GDataUploadQueue asynchronously. This will upload all the files which have been added to the queue, and call their respective callbacks
+ * asynchronously (i.e. in idle functions in the thread-default main context of the thread which called this function) as each upload finishes. @self
+ * is reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_upload_queue_run(), which is the synchronous version of this function.
+ *
+ * When all the uploads are finished, @callback will be called. You can then call gdata_upload_queue_run_finish() to get the results of the run.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_queue_run_async (GDataUploadQueue *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+
+	g_return_if_fail (GDATA_IS_UPLOAD_QUEUE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (self->priv->has_run == FALSE);
+
+	/* Mark the queue as async for the purposes of deciding where to call the callbacks */
+	self->priv->is_async = TRUE;
+	self->priv->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_upload_queue_run_async);
+
+	/* Disable handling of cancellation so that g_simple_async_result_run_in_thread() doesn't return immediately without calling run_thread() if
+	 * cancellable has already been cancelled by this point; the uploads' callbacks must still be called. */
+	g_simple_async_result_set_handle_cancellation (result, FALSE);
+
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) run_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_upload_queue_run_finish:
+ * @self: a #GDataUploadQueue
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous upload queue run started with gdata_upload_queue_run_async().
+ *
+ * Return values are as for gdata_upload_queue_run().
+ *
+ * Return value: %TRUE if all the uploads succeeded, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_upload_queue_run_finish (GDataUploadQueue *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_QUEUE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_upload_queue_run_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	return g_simple_async_result_get_op_res_gboolean (result);
+}
+
+/**
+ * gdata_upload_queue_get_progress:
+ * @self: a #GDataUploadQueue
+ * @uploads_finished: (out caller-allocates) (allow-none): return location for the number of uploads which have finished (successfully or not), or
+ * %NULL
+ * @uploads_total: (out caller-allocates) (allow-none): return location for the total number of uploads in the queue, or %NULL
+ * @bytes_uploaded: (out caller-allocates) (allow-none): return location for the number of bytes of file data uploaded so far, or %NULL
+ * @bytes_total: (out caller-allocates) (allow-none): return location for the total number of bytes of file data to upload, or %NULL
+ *
+ * Gets the overall progress of the queue's current (or last) run, aggregated over all its uploads. This may be called from any thread while the
+ * queue is running, for example to update a progress bar periodically. All the values are <code class="literal">0</code> before the queue is run.
+ *
+ * If an upload fails and is retried, the bytes uploaded in the failed attempt are subtracted from @bytes_uploaded again, so it may decrease.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_queue_get_progress (GDataUploadQueue *self, guint *uploads_finished, guint *uploads_total, goffset *bytes_uploaded,
+                                 goffset *bytes_total)
+{
+	GDataUploadQueuePrivate *priv;
+
+	g_return_if_fail (GDATA_IS_UPLOAD_QUEUE (self));
+
+	priv = self->priv;
+
+	g_mutex_lock (&(priv->progress_mutex));
+
+	if (uploads_finished != NULL)
+		*uploads_finished = priv->uploads_finished;
+	if (uploads_total != NULL)
+		*uploads_total = priv->uploads_total;
+	if (bytes_uploaded != NULL)
+		*bytes_uploaded = priv->bytes_uploaded;
+	if (bytes_total != NULL)
+		*bytes_total = priv->bytes_total;
+
+	g_mutex_unlock (&(priv->progress_mutex));
+}
+
+/**
+ * gdata_upload_queue_get_throughput:
+ * @self: a #GDataUploadQueue
+ *
+ * Gets the average rate at which file data has been uploaded during the queue's current (or last) run, across all its concurrent uploads. As with
+ * gdata_upload_queue_get_progress(), this may be called from any thread while the queue is running.
+ *
+ * Return value: the average upload throughput, in bytes per second; or <code class="literal">0</code> if the queue hasn't been run
+ *
+ * Since: 0.15.0
+ */
+guint64
+gdata_upload_queue_get_throughput (GDataUploadQueue *self)
+{
+	GDataUploadQueuePrivate *priv;
+	gint64 elapsed;
+	guint64 throughput = 0;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_QUEUE (self), 0);
+
+	priv = self->priv;
+
+	g_mutex_lock (&(priv->progress_mutex));
+
+	if (priv->start_time != 0) {
+		elapsed = ((priv->end_time != 0) ? priv->end_time : g_get_monotonic_time ()) - priv->start_time;
+
+		if (elapsed > 0 && priv->bytes_uploaded > 0)
+			throughput = (guint64) priv->bytes_uploaded * G_USEC_PER_SEC / (guint64) elapsed;
+	}
+
+	g_mutex_unlock (&(priv->progress_mutex));
+
+	return throughput;
+}
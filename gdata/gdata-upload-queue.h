@@ -0,0 +1,110 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_UPLOAD_QUEUE_H
+#define GDATA_UPLOAD_QUEUE_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/gdata-service.h>
+#include <gdata/gdata-entry.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDataUploadQueueCallback:
+ * @upload_id: the upload ID returned from gdata_upload_queue_add_file()
+ * @entry: the entry which was passed to gdata_upload_queue_add_file()
+ * @uploaded_entry: the entry returned by the server for the uploaded file, or %NULL
+ * @error: a #GError describing any error which occurred, or %NULL
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called once for each upload in a #GDataUploadQueue run, as soon as that upload has finished. The upload is identified by
+ * @upload_id, as returned by gdata_upload_queue_add_file().
+ *
+ * If the upload was successful, the resulting #GDataEntry (of the same type as @entry) will be passed in as @uploaded_entry, and @error will be
+ * %NULL. Otherwise, @uploaded_entry will be %NULL and a descriptive error will be in @error.
+ *
+ * If the callback code needs to retain a copy of @uploaded_entry, it must be referenced (with g_object_ref()). Similarly, @error is owned by the
+ * calling code, and must not be freed.
+ *
+ * As with #GDataBatchOperationCallback, the callback is called in the thread which called gdata_upload_queue_run(), or in the main thread if the
+ * queue was run with gdata_upload_queue_run_async(). Uploads may finish in any order.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataUploadQueueCallback) (guint upload_id, GDataEntry *entry, GDataEntry *uploaded_entry, GError *error, gpointer user_data);
+
+#define GDATA_TYPE_UPLOAD_QUEUE			(gdata_upload_queue_get_type ())
+#define GDATA_UPLOAD_QUEUE(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_UPLOAD_QUEUE, GDataUploadQueue))
+#define GDATA_UPLOAD_QUEUE_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_UPLOAD_QUEUE, GDataUploadQueueClass))
+#define GDATA_IS_UPLOAD_QUEUE(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_UPLOAD_QUEUE))
+#define GDATA_IS_UPLOAD_QUEUE_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_UPLOAD_QUEUE))
+#define GDATA_UPLOAD_QUEUE_GET_CLASS(o)		(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_UPLOAD_QUEUE, GDataUploadQueueClass))
+
+typedef struct _GDataUploadQueuePrivate	GDataUploadQueuePrivate;
+
+/**
+ * GDataUploadQueue:
+ *
+ * All the fields in the #GDataUploadQueue structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataUploadQueuePrivate *priv;
+} GDataUploadQueue;
+
+/**
+ * GDataUploadQueueClass:
+ *
+ * All the fields in the #GDataUploadQueueClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataUploadQueueClass;
+
+GType gdata_upload_queue_get_type (void) G_GNUC_CONST;
+
+GDataService *gdata_upload_queue_get_service (GDataUploadQueue *self) G_GNUC_PURE;
+
+guint gdata_upload_queue_get_max_concurrent_uploads (GDataUploadQueue *self) G_GNUC_PURE;
+void gdata_upload_queue_set_max_concurrent_uploads (GDataUploadQueue *self, guint max_concurrent_uploads);
+guint gdata_upload_queue_get_max_retries (GDataUploadQueue *self) G_GNUC_PURE;
+void gdata_upload_queue_set_max_retries (GDataUploadQueue *self, guint max_retries);
+
+guint gdata_upload_queue_add_file (GDataUploadQueue *self, GDataEntry *entry, GFile *file, GDataUploadQueueCallback callback, gpointer user_data);
+
+gboolean gdata_upload_queue_run (GDataUploadQueue *self, GCancellable *cancellable, GError **error);
+void gdata_upload_queue_run_async (GDataUploadQueue *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_upload_queue_run_finish (GDataUploadQueue *self, GAsyncResult *async_result, GError **error);
+
+void gdata_upload_queue_get_progress (GDataUploadQueue *self, guint *uploads_finished, guint *uploads_total, goffset *bytes_uploaded,
+                                      goffset *bytes_total);
+guint64 gdata_upload_queue_get_throughput (GDataUploadQueue *self);
+
+G_END_DECLS
+
+#endif /* !GDATA_UPLOAD_QUEUE_H */
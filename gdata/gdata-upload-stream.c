@@ -154,7 +154,9 @@
  *
  * The write() and close() operations on the output stream are synchronised with the network thread, so that the write() call only returns once the
  * network thread has written at least as many bytes as were passed to the write() call, and the close() call only returns once all network activity
- * has finished (including receiving the response from the server). Async versions of these calls are provided by GOutputStream.
+ * has finished (including receiving the response from the server). Async versions of these calls are provided by GOutputStream. If
+ * #GDataUploadStream:write-behind-size is set, write() instead returns as soon as no more than that many bytes are waiting to be written to the
+ * network; flush() and close() still wait for all of them.
  *
  * The number of bytes in the various buffers are recorded using:
  *  • message_bytes_outstanding: the number of bytes in the GDataBuffer which are waiting to be written to the SoupMessageBody
@@ -173,10 +175,22 @@
 
 #include "gdata-upload-stream.h"
 #include "gdata-buffer.h"
+#include "gdata-marshal.h"
 #include "gdata-private.h"
+#include "gdata-trace.h"
 
 #define BOUNDARY_STRING "0003Z5W789deadbeefRTE456KlemsnoZV"
-#define MAX_RESUMABLE_CHUNK_SIZE (512 * 1024) /* bytes = 512 KiB */
+#define DEFAULT_RESUMABLE_CHUNK_SIZE (512 * 1024) /* bytes = 512 KiB */
+#define RESUMABLE_CHUNK_SIZE_GRANULARITY (256 * 1024) /* bytes = 256 KiB; all chunks except the last must be a multiple of this */
+#define DEFAULT_MAX_RESUMABLE_CHUNK_SIZE (64 * 1024 * 1024) /* bytes = 64 MiB */
+#define MAX_RESUMABLE_CHUNK_SIZE (G_MAXUINT - (G_MAXUINT % RESUMABLE_CHUNK_SIZE_GRANULARITY))
+#define WRITE_BUFFER_SIZE (64 * 1024) /* bytes = 64 KiB; the amount of data passed to libsoup in one go */
+
+/* Adaptive chunk sizing aims to make sending each chunk take this many times as long as waiting for the server's response to it. */
+#define ADAPTIVE_CHUNK_RTT_RATIO 9
+
+/* First line of a serialised upload session; bump the version if the format changes */
+#define SESSION_HEADER "GDataUploadStream 1"
 
 static GObject *gdata_upload_stream_constructor (GType type, guint n_construct_params, GObjectConstructParam *construct_params);
 static void gdata_upload_stream_dispose (GObject *object);
@@ -204,7 +218,8 @@ struct _GDataUploadStreamPrivate {
 	GDataEntry *entry;
 	gchar *slug;
 	gchar *content_type;
-	goffset content_length; /* -1 for non-resumable uploads; 0 or greater for resumable ones */
+	goffset content_length; /* -1 for non-resumable uploads and resumable ones of unknown length; 0 or greater for other resumable ones */
+	gboolean resumable; /* TRUE if using the resumable upload protocol; always TRUE if content_length >= 0 */
 	SoupSession *session;
 	SoupMessage *message;
 	GDataBuffer *buffer;
@@ -216,12 +231,39 @@ struct _GDataUploadStreamPrivate {
 	GMutex write_mutex; /* mutex for write operations (specifically, write_finished) */
 	/* This persists across all resumable upload chunks. Note that it doesn't count bytes from the entry XML. */
 	gsize total_network_bytes_written; /* the number of bytes which have been written to the network in STATE_DATA_REQUESTS */
+	gsize total_bytes_pushed; /* the number of bytes written to ->buffer (plus the entry XML of a non-resumable upload); only used for resumable
+	                           * uploads of unknown length and when write_behind_size is non-zero (write_mutex) */
+	gsize write_behind_size; /* the number of bytes write() may leave waiting to be written to the network; protected by write_mutex */
 
 	/* All of the following apply only to the current resumable upload chunk. */
 	gsize message_bytes_outstanding; /* the number of bytes which have been written to the buffer but not libsoup (signalled by write_cond) */
 	gsize network_bytes_outstanding; /* the number of bytes which have been written to libsoup but not the network (signalled by write_cond) */
 	gsize network_bytes_written; /* the number of bytes which have been written to the network (signalled by write_cond) */
-	gsize chunk_size; /* the size of the current chunk (in bytes); 0 iff content_length <= 0; must be <= MAX_RESUMABLE_CHUNK_SIZE */
+	gsize chunk_size; /* the size of the current chunk (in bytes); 0 iff content_length <= 0 or until the first chunk of an upload of unknown
+	                   * length is collected; must be <= resumable_chunk_size */
+	gsize resumable_chunk_size; /* the maximum size of each resumable upload chunk (in bytes); protected by write_mutex */
+	gchar *session_uri; /* the URI to send the next chunk of a resumable upload to; NULL until known; protected by write_mutex */
+	goffset committed_length; /* the number of bytes the server has acknowledged in a resumable upload; protected by write_mutex */
+	gboolean adaptive_chunk_size; /* whether to recalculate resumable_chunk_size after each chunk; protected by write_mutex */
+	gsize min_chunk_size; /* bounds on resumable_chunk_size when adaptive_chunk_size is set; protected by write_mutex */
+	gsize max_chunk_size;
+	guint8 *write_buffer; /* WRITE_BUFFER_SIZE bytes, only touched by the network thread */
+	GMappedFile *mapped_file; /* the file to upload from, bypassing ->buffer; NULL if data is written to the stream */
+	GChecksum *checksum; /* running digest of the data written to the stream; NULL unless requested with gdata_upload_stream_set_checksum_type() */
+	gchar *checksum_string; /* hex digest, set once the stream's closed and the digest's been requested */
+	GDataBandwidthLimiter *bandwidth_limiter; /* per-stream limit; the service's limit applies as well */
+
+	/* Header hook; see gdata_upload_stream_set_header_func(). These are only touched by the thread calling the #GOutputStream methods. */
+	GDataUploadStreamHeaderFunc header_func; /* NULL once it's been called, or if it was never set */
+	gpointer header_func_data;
+	GDestroyNotify header_func_data_destroy;
+	gsize header_length; /* the number of bytes to pass to header_func */
+	GByteArray *header; /* the data written so far, held back until header_func has been called */
+
+	/* Timing of resumable upload chunks. These are only touched by the network thread. */
+	gint64 chunk_last_write_time; /* monotonic time at which the last byte of the current chunk was written to the network */
+	gdouble throughput_estimate; /* smoothed estimate of the upload throughput, in bytes per second; 0 if not known yet */
+	gdouble rtt_estimate; /* smoothed estimate of the time between finishing sending a chunk and receiving its response, in seconds */
 	GCond write_cond; /* signalled when a chunk has been written (protected by write_mutex) */
 
 	GCond finished_cond; /* signalled when sending the message (and receiving the response) is finished (protected by response_mutex) */
@@ -240,8 +282,22 @@ enum {
 	PROP_CANCELLABLE,
 	PROP_AUTHORIZATION_DOMAIN,
 	PROP_CONTENT_LENGTH,
+	PROP_CHUNK_SIZE,
+	PROP_ADAPTIVE_CHUNK_SIZE,
+	PROP_MIN_CHUNK_SIZE,
+	PROP_MAX_CHUNK_SIZE,
+	PROP_RESUMABLE,
+	PROP_BANDWIDTH_LIMIT,
+	PROP_WRITE_BEHIND_SIZE,
+};
+
+enum {
+	SIGNAL_CHUNK_SENT,
+	LAST_SIGNAL
 };
 
+static guint upload_stream_signals[LAST_SIGNAL] = { 0, };
+
 G_DEFINE_TYPE (GDataUploadStream, gdata_upload_stream, G_TYPE_OUTPUT_STREAM)
 
 static void
@@ -349,7 +405,8 @@ gdata_upload_stream_class_init (GDataUploadStreamClass *klass)
 	 * The content length (in bytes) of the file being uploaded (i.e. as returned by g_file_info_get_size()). Note that this does not include the
 	 * length of the XML serialisation of #GDataUploadStream:entry, if set.
 	 *
-	 * If this is <code class="literal">-1</code> the upload will be non-resumable; if it is non-negative, the upload will be resumable.
+	 * If this is <code class="literal">-1</code> the upload will be non-resumable, unless #GDataUploadStream:resumable is set, in which case the
+	 * upload will be resumable but its length won't be known until the stream is closed. If it is non-negative, the upload will be resumable.
 	 *
 	 * Since: 0.13.0
 	 */
@@ -359,6 +416,24 @@ gdata_upload_stream_class_init (GDataUploadStreamClass *klass)
 	                                                     -1, G_MAXINT64, -1,
 	                                                     G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * GDataUploadStream:resumable:
+	 *
+	 * Whether the upload uses GData's resumable upload protocol. This is always %TRUE if #GDataUploadStream:content-length is non-negative.
+	 *
+	 * If it's set and #GDataUploadStream:content-length is <code class="literal">-1</code>, the length of the file isn't given to the server up
+	 * front. Instead, the data written to the stream is collected into chunks of #GDataUploadStream:chunk-size bytes, each of which is sent
+	 * as soon as it's full, and the total length is given to the server with the final chunk once the stream is closed. This allows data to be
+	 * uploaded as it's produced (for example, by a live recording) whilst still being able to resume the upload if it's interrupted.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_RESUMABLE,
+	                                 g_param_spec_boolean ("resumable",
+	                                                       "Resumable?", "Whether the upload uses the resumable upload protocol.",
+	                                                       FALSE,
+	                                                       G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
 	/**
 	 * GDataUploadStream:content-type:
 	 *
@@ -372,6 +447,105 @@ gdata_upload_stream_class_init (GDataUploadStreamClass *klass)
 	                                                      NULL,
 	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * GDataUploadStream:chunk-size:
+	 *
+	 * The maximum size (in bytes) of each chunk of a resumable upload. Each chunk is sent as a separate PUT request, and the server has to
+	 * acknowledge it before the next one can be sent, so larger chunks mean fewer round trips on high-latency links at the cost of having to
+	 * re-send more data if a chunk fails. The protocol requires this to be a multiple of 256 KiB; the final chunk of an upload may be smaller.
+	 *
+	 * Changes to this property take effect from the next chunk to be sent. It is ignored for non-resumable uploads.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_CHUNK_SIZE,
+	                                 g_param_spec_uint ("chunk-size",
+	                                                    "Chunk size", "The maximum size (in bytes) of each chunk of a resumable upload.",
+	                                                    RESUMABLE_CHUNK_SIZE_GRANULARITY, MAX_RESUMABLE_CHUNK_SIZE,
+	                                                    DEFAULT_RESUMABLE_CHUNK_SIZE,
+	                                                    G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataUploadStream:adaptive-chunk-size:
+	 *
+	 * Whether to adjust #GDataUploadStream:chunk-size automatically during a resumable upload, based on the throughput and round-trip time
+	 * measured for the chunks sent so far. Chunks are sized so that the time spent waiting for the server to acknowledge each chunk is small
+	 * compared to the time spent sending it, within the bounds given by #GDataUploadStream:min-chunk-size and
+	 * #GDataUploadStream:max-chunk-size. The initial value of #GDataUploadStream:chunk-size is used for the first chunk.
+	 *
+	 * When the chunk size is adjusted, the new value can be retrieved using gdata_upload_stream_get_chunk_size(), but no notification is
+	 * emitted for it.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_ADAPTIVE_CHUNK_SIZE,
+	                                 g_param_spec_boolean ("adaptive-chunk-size",
+	                                                       "Adaptive chunk size", "Whether to adjust the chunk size automatically.",
+	                                                       FALSE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataUploadStream:min-chunk-size:
+	 *
+	 * The smallest chunk size (in bytes) which will be chosen for a resumable upload if #GDataUploadStream:adaptive-chunk-size is %TRUE.
+	 * This must be a multiple of 256 KiB.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MIN_CHUNK_SIZE,
+	                                 g_param_spec_uint ("min-chunk-size",
+	                                                    "Minimum chunk size", "The smallest chunk size which will be chosen adaptively.",
+	                                                    RESUMABLE_CHUNK_SIZE_GRANULARITY, MAX_RESUMABLE_CHUNK_SIZE, RESUMABLE_CHUNK_SIZE_GRANULARITY,
+	                                                    G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataUploadStream:max-chunk-size:
+	 *
+	 * The largest chunk size (in bytes) which will be chosen for a resumable upload if #GDataUploadStream:adaptive-chunk-size is %TRUE.
+	 * This must be a multiple of 256 KiB. Note that the whole of each chunk may have to be re-sent if sending it fails.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MAX_CHUNK_SIZE,
+	                                 g_param_spec_uint ("max-chunk-size",
+	                                                    "Maximum chunk size", "The largest chunk size which will be chosen adaptively.",
+	                                                    RESUMABLE_CHUNK_SIZE_GRANULARITY, MAX_RESUMABLE_CHUNK_SIZE, DEFAULT_MAX_RESUMABLE_CHUNK_SIZE,
+	                                                    G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataUploadStream:bandwidth-limit:
+	 *
+	 * The maximum rate at which this stream may upload data, in bytes per second, or <code class="literal">0</code> for no limit. This applies
+	 * in addition to #GDataService:upload-bandwidth-limit, which is shared between all the streams using the service. It may be changed at
+	 * any time, and takes effect for the next data sent.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_BANDWIDTH_LIMIT,
+	                                 g_param_spec_uint ("bandwidth-limit",
+	                                                    "Bandwidth limit", "The maximum rate at which to upload data, in bytes per second.",
+	                                                    0, G_MAXINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataUploadStream:write-behind-size:
+	 *
+	 * The number of bytes which g_output_stream_write() may leave buffered, waiting to be sent to the server, before it returns. If this is
+	 * <code class="literal">0</code>, each write only returns once its data has been sent. Otherwise, writes return as soon as their data has
+	 * been buffered and no more than this many bytes are outstanding, which lets the caller produce the next data (for example, by reading it
+	 * from disk) while earlier data is still being sent. g_output_stream_flush() and g_output_stream_close() still wait for all the buffered
+	 * data to be sent, and any error sending it is reported by them or by a later write.
+	 *
+	 * It may be changed at any time, and takes effect for the next write.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_WRITE_BEHIND_SIZE,
+	                                 g_param_spec_uint ("write-behind-size",
+	                                                    "Write-behind size", "The number of bytes a write may leave waiting to be sent.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
 	/**
 	 * GDataUploadStream:cancellable:
 	 *
@@ -392,6 +566,29 @@ gdata_upload_stream_class_init (GDataUploadStreamClass *klass)
 	                                                      "Cancellable", "An optional cancellable used to cancel the entire upload operation.",
 	                                                      G_TYPE_CANCELLABLE,
 	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataUploadStream::chunk-sent:
+	 * @stream: the #GDataUploadStream which sent the chunk
+	 * @offset: the offset (in bytes) of the start of the chunk in the file being uploaded
+	 * @length: the length (in bytes) of the chunk
+	 * @send_time: the time taken to send the chunk's request, in microseconds
+	 * @response_time: the time between finishing sending the chunk and receiving the server's response to it, in microseconds
+	 *
+	 * The #GDataUploadStream::chunk-sent signal is emitted once the server has acknowledged each chunk of a resumable upload. It is not emitted
+	 * for non-resumable uploads.
+	 *
+	 * Note that this signal is emitted in the thread which performs the network communication, rather than the thread which is writing to the
+	 * stream. Handlers must not call gdata_upload_stream_get_response() or block on the stream.
+	 *
+	 * Since: 0.15.0
+	 */
+	upload_stream_signals[SIGNAL_CHUNK_SENT] = g_signal_new ("chunk-sent",
+	                                                         G_TYPE_FROM_CLASS (klass),
+	                                                         G_SIGNAL_RUN_LAST,
+	                                                         0, NULL, NULL,
+	                                                         gdata_marshal_VOID__INT64_UINT_INT64_INT64,
+	                                                         G_TYPE_NONE, 4, G_TYPE_INT64, G_TYPE_UINT, G_TYPE_INT64, G_TYPE_INT64);
 }
 
 static void
@@ -399,6 +596,8 @@ gdata_upload_stream_init (GDataUploadStream *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_UPLOAD_STREAM, GDataUploadStreamPrivate);
 	self->priv->buffer = gdata_buffer_new ();
+	self->priv->write_buffer = g_malloc (WRITE_BUFFER_SIZE);
+	self->priv->bandwidth_limiter = gdata_bandwidth_limiter_new ();
 	g_mutex_init (&(self->priv->write_mutex));
 	g_cond_init (&(self->priv->write_cond));
 	g_cond_init (&(self->priv->finished_cond));
@@ -416,6 +615,7 @@ build_message (GDataUploadStream *self, const gchar *method, const gchar *upload
 	soup_uri_set_port (_uri, _gdata_service_get_https_port ());
 	new_message = soup_message_new_from_uri (method, _uri);
 	soup_uri_free (_uri);
+	_gdata_service_claim_message (self->priv->service, new_message);
 
 	/* We don't want to accumulate chunks */
 	soup_message_body_set_accumulate (new_message->request_body, FALSE);
@@ -423,6 +623,75 @@ build_message (GDataUploadStream *self, const gchar *method, const gchar *upload
 	return new_message;
 }
 
+static void
+append_entry_xml_cb (const gchar *data, gsize length, SoupMessageBody *body)
+{
+	soup_message_body_append (body, SOUP_MEMORY_COPY, data, length);
+}
+
+typedef struct {
+	GConverter *compressor;
+	SoupMessageBody *body;
+} CompressedEntryXml;
+
+static void
+append_compressed_entry_xml_cb (const gchar *data, gsize length, CompressedEntryXml *compressed)
+{
+	_gdata_service_append_compressed (compressed->compressor, compressed->body, data, length, FALSE);
+}
+
+/* Append the XML for ->entry to the body of the first request of the upload: as the first part of the multipart body of a non-resumable upload,
+ * or as the whole body of the initial request of a resumable one. This must be called before the network thread has been created, so that we're
+ * the sole thread accessing the SoupMessage and can skip the buffer. The XML's written into the body a chunk at a time, rather than being built
+ * in full first. */
+static void
+append_entry (GDataUploadStream *self)
+{
+	GDataUploadStreamPrivate *priv = self->priv;
+	static const gchar declaration[] = "<?xml version='1.0' encoding='UTF-8'?>";
+
+	g_assert (priv->entry != NULL);
+	g_assert (priv->network_thread == NULL);
+
+	if (priv->resumable == FALSE) {
+		const gchar *first_part_header;
+		gchar *second_part_header;
+
+		first_part_header = "--" BOUNDARY_STRING "\nContent-Type: application/atom+xml; charset=UTF-8\n\n";
+		second_part_header = g_strdup_printf ("\n--" BOUNDARY_STRING "\nContent-Type: %s\nContent-Transfer-Encoding: binary\n\n",
+		                                      priv->content_type);
+
+		soup_message_body_append (priv->message->request_body, SOUP_MEMORY_STATIC, first_part_header, strlen (first_part_header));
+		soup_message_body_append (priv->message->request_body, SOUP_MEMORY_STATIC, declaration, sizeof (declaration) - 1);
+		_gdata_parsable_write_xml (GDATA_PARSABLE (priv->entry), FALSE, (GDataParsableXmlSinkFunc) append_entry_xml_cb,
+		                           priv->message->request_body);
+		soup_message_body_append (priv->message->request_body, SOUP_MEMORY_TAKE, second_part_header, strlen (second_part_header));
+	} else if (gdata_service_get_compress_requests (priv->service) == TRUE) {
+		/* Only the resumable initial request is compressed, since a non-resumable upload's body is mostly the file itself */
+		CompressedEntryXml compressed;
+
+		compressed.compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1));
+		compressed.body = priv->message->request_body;
+
+		soup_message_headers_replace (priv->message->request_headers, "Content-Encoding", "gzip");
+		_gdata_service_append_compressed (compressed.compressor, compressed.body, declaration, sizeof (declaration) - 1, FALSE);
+		_gdata_parsable_write_xml (GDATA_PARSABLE (priv->entry), FALSE, (GDataParsableXmlSinkFunc) append_compressed_entry_xml_cb, &compressed);
+		_gdata_service_append_compressed (compressed.compressor, compressed.body, "", 0, TRUE);
+
+		g_object_unref (compressed.compressor);
+	} else {
+		soup_message_body_append (priv->message->request_body, SOUP_MEMORY_STATIC, declaration, sizeof (declaration) - 1);
+		_gdata_parsable_write_xml (GDATA_PARSABLE (priv->entry), FALSE, (GDataParsableXmlSinkFunc) append_entry_xml_cb,
+		                           priv->message->request_body);
+	}
+
+	priv->network_bytes_outstanding = priv->message->request_body->length;
+
+	/* The network thread counts the XML of a non-resumable upload as data, so count it as pushed too */
+	if (priv->resumable == FALSE)
+		priv->total_bytes_pushed = priv->message->request_body->length;
+}
+
 static GObject *
 gdata_upload_stream_constructor (GType type, guint n_construct_params, GObjectConstructParam *construct_params)
 {
@@ -444,31 +713,20 @@ gdata_upload_stream_constructor (GType type, guint n_construct_params, GObjectCo
 	if (priv->slug != NULL)
 		soup_message_headers_append (priv->message->request_headers, "Slug", priv->slug);
 
-	if (priv->content_length == -1) {
+	if (priv->content_length != -1)
+		priv->resumable = TRUE;
+
+	if (priv->resumable == FALSE) {
 		/* Non-resumable upload */
 		soup_message_headers_set_encoding (priv->message->request_headers, SOUP_ENCODING_CHUNKED);
 
 		/* The Content-Type should be multipart/related if we're also uploading the metadata (entry != NULL),
 		 * and the given content_type otherwise. */
 		if (priv->entry != NULL) {
-			const gchar *first_part_header;
-			gchar *entry_xml, *second_part_header;
-
 			soup_message_headers_set_content_type (priv->message->request_headers, "multipart/related; boundary=" BOUNDARY_STRING, NULL);
 
 			/* Start by writing out the entry; then the thread has something to write to the network when it's created */
-			first_part_header = "--" BOUNDARY_STRING "\nContent-Type: application/atom+xml; charset=UTF-8\n\n";
-			entry_xml = gdata_parsable_get_xml (GDATA_PARSABLE (priv->entry));
-			second_part_header = g_strdup_printf ("\n--" BOUNDARY_STRING "\nContent-Type: %s\nContent-Transfer-Encoding: binary\n\n",
-			                                      priv->content_type);
-
-			/* Push the message parts onto the message body; we can skip the buffer, since the network thread hasn't yet been created,
-			 * so we're the sole thread accessing the SoupMessage. */
-			soup_message_body_append (priv->message->request_body, SOUP_MEMORY_STATIC, first_part_header, strlen (first_part_header));
-			soup_message_body_append (priv->message->request_body, SOUP_MEMORY_TAKE, entry_xml, strlen (entry_xml));
-			soup_message_body_append (priv->message->request_body, SOUP_MEMORY_TAKE, second_part_header, strlen (second_part_header));
-
-			priv->network_bytes_outstanding = priv->message->request_body->length;
+			append_entry (GDATA_UPLOAD_STREAM (object));
 		} else {
 			soup_message_headers_set_content_type (priv->message->request_headers, priv->content_type, NULL);
 		}
@@ -476,32 +734,28 @@ gdata_upload_stream_constructor (GType type, guint n_construct_params, GObjectCo
 		/* Non-resumable uploads start with the data requests immediately. */
 		priv->state = STATE_DATA_REQUESTS;
 	} else {
-		gchar *content_length_str;
-
-		/* Resumable upload's initial request */
+		/* Resumable upload's initial request. If the length is unknown, the server finds it out from the final chunk. */
 		soup_message_headers_set_encoding (priv->message->request_headers, SOUP_ENCODING_CONTENT_LENGTH);
 		soup_message_headers_replace (priv->message->request_headers, "X-Upload-Content-Type", priv->content_type);
 
-		content_length_str = g_strdup_printf ("%" G_GOFFSET_FORMAT, priv->content_length);
-		soup_message_headers_replace (priv->message->request_headers, "X-Upload-Content-Length", content_length_str);
-		g_free (content_length_str);
+		if (priv->content_length != -1) {
+			gchar *content_length_str;
 
-		if (priv->entry != NULL) {
-			const gchar *entry_xml;
+			content_length_str = g_strdup_printf ("%" G_GOFFSET_FORMAT, priv->content_length);
+			soup_message_headers_replace (priv->message->request_headers, "X-Upload-Content-Length", content_length_str);
+			g_free (content_length_str);
+		}
 
+		if (priv->entry != NULL) {
 			soup_message_headers_set_content_type (priv->message->request_headers, "application/atom+xml; charset=UTF-8", NULL);
-
-			entry_xml = gdata_parsable_get_xml (GDATA_PARSABLE (priv->entry));
-			soup_message_body_append (priv->message->request_body, SOUP_MEMORY_TAKE, entry_xml, strlen (entry_xml));
-
-			priv->network_bytes_outstanding = priv->message->request_body->length;
+			append_entry (GDATA_UPLOAD_STREAM (object));
 		} else {
 			soup_message_headers_set_content_length (priv->message->request_headers, 0);
 		}
 
 		/* Resumable uploads always start with an initial request, which either contains the XML or is empty. */
 		priv->state = STATE_INITIAL_REQUEST;
-		priv->chunk_size = MIN (priv->content_length, MAX_RESUMABLE_CHUNK_SIZE);
+		priv->chunk_size = (priv->content_length != -1) ? MIN (priv->content_length, priv->resumable_chunk_size) : 0;
 	}
 
 	/* Make sure the headers are set. HACK: This should actually be in build_message(), but we have to work around
@@ -527,14 +781,25 @@ gdata_upload_stream_dispose (GObject *object)
 
 	/* Close the stream before unreffing things like priv->service, which stops crashes like bgo#602156 if the stream is unreffed in the middle
 	 * of network operations */
+	if (priv->network_thread == NULL && priv->mapped_file != NULL) {
+		/* Don't start uploading a mapped file just because the stream was never closed */
+		g_mapped_file_unref (priv->mapped_file);
+		priv->mapped_file = NULL;
+	}
+
 	g_output_stream_close (G_OUTPUT_STREAM (object), NULL, NULL);
 
 	if (priv->cancellable != NULL)
 		g_object_unref (priv->cancellable);
 	priv->cancellable = NULL;
 
-	if (priv->service != NULL)
+	/* The network thread holds a reference to the stream, so nothing else can be using the buffer by now. The buffer isn't freed until the stream
+	 * is finalized, which may be after the service is. */
+	if (priv->service != NULL) {
+		gdata_buffer_set_length_counter (priv->buffer, NULL);
+		_gdata_service_remove_stream (priv->service, GDATA_OPERATION_UPLOAD);
 		g_object_unref (priv->service);
+	}
 	priv->service = NULL;
 
 	if (priv->authorization_domain != NULL)
@@ -563,6 +828,20 @@ gdata_upload_stream_finalize (GObject *object)
 	g_cond_clear (&(priv->write_cond));
 	g_mutex_clear (&(priv->write_mutex));
 	gdata_buffer_free (priv->buffer);
+	g_free (priv->write_buffer);
+	g_free (priv->session_uri);
+	gdata_bandwidth_limiter_free (priv->bandwidth_limiter);
+
+	if (priv->header != NULL)
+		g_byte_array_unref (priv->header);
+	if (priv->header_func_data_destroy != NULL)
+		priv->header_func_data_destroy (priv->header_func_data);
+
+	if (priv->mapped_file != NULL)
+		g_mapped_file_unref (priv->mapped_file);
+	if (priv->checksum != NULL)
+		g_checksum_free (priv->checksum);
+	g_free (priv->checksum_string);
 	g_clear_error (&(priv->response_error));
 	g_free (priv->upload_uri);
 	g_free (priv->method);
@@ -603,6 +882,27 @@ gdata_upload_stream_get_property (GObject *object, guint property_id, GValue *va
 		case PROP_CONTENT_LENGTH:
 			g_value_set_int64 (value, priv->content_length);
 			break;
+		case PROP_RESUMABLE:
+			g_value_set_boolean (value, priv->resumable);
+			break;
+		case PROP_CHUNK_SIZE:
+			g_value_set_uint (value, gdata_upload_stream_get_chunk_size (GDATA_UPLOAD_STREAM (object)));
+			break;
+		case PROP_ADAPTIVE_CHUNK_SIZE:
+			g_value_set_boolean (value, gdata_upload_stream_get_adaptive_chunk_size (GDATA_UPLOAD_STREAM (object)));
+			break;
+		case PROP_MIN_CHUNK_SIZE:
+			g_value_set_uint (value, gdata_upload_stream_get_min_chunk_size (GDATA_UPLOAD_STREAM (object)));
+			break;
+		case PROP_MAX_CHUNK_SIZE:
+			g_value_set_uint (value, gdata_upload_stream_get_max_chunk_size (GDATA_UPLOAD_STREAM (object)));
+			break;
+		case PROP_BANDWIDTH_LIMIT:
+			g_value_set_uint (value, gdata_upload_stream_get_bandwidth_limit (GDATA_UPLOAD_STREAM (object)));
+			break;
+		case PROP_WRITE_BEHIND_SIZE:
+			g_value_set_uint (value, gdata_upload_stream_get_write_behind_size (GDATA_UPLOAD_STREAM (object)));
+			break;
 		case PROP_CANCELLABLE:
 			g_value_set_object (value, priv->cancellable);
 			break;
@@ -622,6 +922,10 @@ gdata_upload_stream_set_property (GObject *object, guint property_id, const GVal
 		case PROP_SERVICE:
 			priv->service = g_value_dup_object (value);
 			priv->session = _gdata_service_get_session (priv->service);
+
+			/* Count the stream in the service's gauges until it's disposed */
+			_gdata_service_add_stream (priv->service, GDATA_OPERATION_UPLOAD);
+			_gdata_service_count_buffer (priv->service, GDATA_OPERATION_UPLOAD, priv->buffer);
 			break;
 		case PROP_AUTHORIZATION_DOMAIN:
 			priv->authorization_domain = g_value_dup_object (value);
@@ -644,6 +948,27 @@ gdata_upload_stream_set_property (GObject *object, guint property_id, const GVal
 		case PROP_CONTENT_LENGTH:
 			priv->content_length = g_value_get_int64 (value);
 			break;
+		case PROP_RESUMABLE:
+			priv->resumable = g_value_get_boolean (value);
+			break;
+		case PROP_CHUNK_SIZE:
+			gdata_upload_stream_set_chunk_size (GDATA_UPLOAD_STREAM (object), g_value_get_uint (value));
+			break;
+		case PROP_ADAPTIVE_CHUNK_SIZE:
+			gdata_upload_stream_set_adaptive_chunk_size (GDATA_UPLOAD_STREAM (object), g_value_get_boolean (value));
+			break;
+		case PROP_MIN_CHUNK_SIZE:
+			gdata_upload_stream_set_min_chunk_size (GDATA_UPLOAD_STREAM (object), g_value_get_uint (value));
+			break;
+		case PROP_MAX_CHUNK_SIZE:
+			gdata_upload_stream_set_max_chunk_size (GDATA_UPLOAD_STREAM (object), g_value_get_uint (value));
+			break;
+		case PROP_BANDWIDTH_LIMIT:
+			gdata_upload_stream_set_bandwidth_limit (GDATA_UPLOAD_STREAM (object), g_value_get_uint (value));
+			break;
+		case PROP_WRITE_BEHIND_SIZE:
+			gdata_upload_stream_set_write_behind_size (GDATA_UPLOAD_STREAM (object), g_value_get_uint (value));
+			break;
 		case PROP_CANCELLABLE:
 			/* Construction only */
 			priv->cancellable = g_value_dup_object (value);
@@ -672,6 +997,44 @@ write_cancelled_cb (GCancellable *cancellable, CancelledData *data)
 	g_mutex_unlock (&(priv->write_mutex));
 }
 
+/* Call the header function with the data which has been held back, then upload it. This has to add the XML for ->entry to the request, since the
+ * header function may have modified ->entry. */
+static gboolean
+run_header_func (GDataUploadStream *self, GCancellable *cancellable, GError **error)
+{
+	GDataUploadStreamPrivate *priv = self->priv;
+	GDataUploadStreamHeaderFunc header_func;
+	GByteArray *header;
+	gsize offset = 0;
+	gboolean success;
+
+	header_func = priv->header_func;
+	header = priv->header;
+	priv->header_func = NULL;
+	priv->header = NULL;
+
+	header_func (self, priv->entry, header->data, MIN (header->len, priv->header_length), priv->header_func_data);
+
+	if (priv->entry != NULL)
+		append_entry (self);
+
+	/* Upload the data written so far */
+	while (offset < header->len) {
+		gssize length_written;
+
+		length_written = gdata_upload_stream_write (G_OUTPUT_STREAM (self), header->data + offset, header->len - offset, cancellable, error);
+		if (length_written < 0)
+			break;
+
+		offset += length_written;
+	}
+
+	success = (offset == header->len);
+	g_byte_array_unref (header);
+
+	return success;
+}
+
 static gssize
 gdata_upload_stream_write (GOutputStream *stream, const void *buffer, gsize count, GCancellable *cancellable, GError **error_out)
 {
@@ -700,16 +1063,46 @@ gdata_upload_stream_write (GOutputStream *stream, const void *buffer, gsize coun
 		          g_cancellable_set_error_if_cancelled (priv->cancellable, &error) == TRUE);
 		g_mutex_unlock (&(priv->write_mutex));
 
+		length_written = -1;
+		goto done;
+	} else if (priv->mapped_file != NULL) {
+		/* The data comes from the mapped file; see gdata_upload_stream_new_resumable_from_file(). */
+		g_set_error_literal (&error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, _("Data cannot be written to a stream which uploads a file."));
+		g_mutex_unlock (&(priv->write_mutex));
+
+		length_written = -1;
+		goto done;
+	} else if (priv->state == STATE_FINISHED && priv->network_thread == NULL) {
+		/* A resumed upload which the server had already completed; see gdata_upload_stream_new_from_session(). */
+		g_set_error_literal (&error, G_IO_ERROR, G_IO_ERROR_CLOSED, _("Stream is already closed"));
+		g_mutex_unlock (&(priv->write_mutex));
+
 		length_written = -1;
 		goto done;
 	}
 
 	g_mutex_unlock (&(priv->write_mutex));
 
+	/* If there's a header function, hold the data back until it has enough to look at; see gdata_upload_stream_set_header_func() */
+	if (priv->header_func != NULL) {
+		g_byte_array_append (priv->header, buffer, count);
+
+		if (priv->header->len < priv->header_length || run_header_func (GDATA_UPLOAD_STREAM (stream), cancellable, &error) == TRUE)
+			length_written = count;
+
+		goto done;
+	}
+
 	/* Increment the number of bytes outstanding for the new write, and keep a record of the old number written so we know if the write's
 	 * finished before we reach write_cond. */
+	g_mutex_lock (&(priv->write_mutex));
 	old_total_network_bytes_written = priv->total_network_bytes_written;
 	priv->message_bytes_outstanding += count;
+	g_mutex_unlock (&(priv->write_mutex));
+
+	/* Digest the data on its way into the buffer, so that callers don't have to read the file twice to checksum it */
+	if (priv->checksum != NULL)
+		g_checksum_update (priv->checksum, buffer, count);
 
 	/* Handle the more common case of the network thread already having been created first */
 	if (priv->network_thread != NULL) {
@@ -731,11 +1124,40 @@ gdata_upload_stream_write (GOutputStream *stream, const void *buffer, gsize coun
 write:
 	g_mutex_lock (&(priv->write_mutex));
 
-	/* Wait for it to be written */
-	while (priv->total_network_bytes_written - old_total_network_bytes_written < count && cancelled == FALSE && priv->state != STATE_FINISHED) {
-		g_cond_wait (&(priv->write_cond), &(priv->write_mutex));
+	if (priv->resumable == TRUE && priv->content_length == -1) {
+		/* The network thread won't send anything until it's collected a whole chunk (or reached EOF), so we can't wait for our data to
+		 * be written to the network, or a small write would deadlock. Instead, allow up to a chunk's worth of data to be buffered. */
+		priv->total_bytes_pushed += count;
+
+		while (priv->total_bytes_pushed - priv->total_network_bytes_written > MAX (priv->chunk_size, priv->resumable_chunk_size) &&
+		       cancelled == FALSE && priv->state != STATE_FINISHED) {
+			g_cond_wait (&(priv->write_cond), &(priv->write_mutex));
+		}
+
+		length_written = (priv->state == STATE_FINISHED) ? 0 : count;
+	} else if (priv->write_behind_size > 0) {
+		/* Write-behind: only wait until no more than ->write_behind_size bytes are left to be written to the network. flush() and close()
+		 * wait for the rest. */
+		priv->total_bytes_pushed += count;
+
+		while (priv->total_bytes_pushed > priv->total_network_bytes_written + priv->write_behind_size && cancelled == FALSE &&
+		       priv->state != STATE_FINISHED) {
+			g_cond_wait (&(priv->write_cond), &(priv->write_mutex));
+		}
+
+		/* The upload only finishes early if it fails */
+		length_written = (priv->state == STATE_FINISHED && priv->total_bytes_pushed > priv->total_network_bytes_written) ? 0 : count;
+	} else {
+		/* Wait for it to be written */
+		priv->total_bytes_pushed += count;
+
+		while (priv->total_network_bytes_written - old_total_network_bytes_written < count && cancelled == FALSE &&
+		       priv->state != STATE_FINISHED) {
+			g_cond_wait (&(priv->write_cond), &(priv->write_mutex));
+		}
+
+		length_written = MIN (count, priv->total_network_bytes_written - old_total_network_bytes_written);
 	}
-	length_written = MIN (count, priv->total_network_bytes_written - old_total_network_bytes_written);
 
 	/* Check for an error and return if necessary */
 	if (cancelled == TRUE && length_written < 1) {
@@ -780,7 +1202,8 @@ flush_cancelled_cb (GCancellable *cancellable, CancelledData *data)
 	g_mutex_unlock (&(priv->write_mutex));
 }
 
-/* Block until ->network_bytes_outstanding reaches zero. Cancelling the cancellable passed to gdata_upload_stream_flush() breaks out of the wait(),
+/* Block until ->network_bytes_outstanding (and ->message_bytes_outstanding, unless the chunks of a resumable upload of unknown length are being
+ * collected) reaches zero. Cancelling the cancellable passed to gdata_upload_stream_flush() breaks out of the wait(),
  * but doesn't stop the network thread from continuing to write the remaining bytes to the network.
  * The wrapper function, g_output_stream_flush(), calls g_output_stream_set_pending() before calling this function, and calls
  * g_output_stream_clear_pending() afterwards, so we don't need to worry about other operations happening concurrently. We also don't need to worry
@@ -792,8 +1215,13 @@ gdata_upload_stream_flush (GOutputStream *stream, GCancellable *cancellable, GEr
 	gulong cancelled_signal = 0, global_cancelled_signal = 0;
 	gboolean cancelled = FALSE; /* must only be touched with ->write_mutex held */
 	gboolean success = TRUE;
+	gboolean collects_chunks;
 	CancelledData data;
 
+	/* Data held back for the header function can't be sent until it's been called */
+	if (priv->header_func != NULL)
+		return TRUE;
+
 	/* Listen for cancellation events */
 	data.upload_stream = GDATA_UPLOAD_STREAM (stream);
 	data.cancelled = &cancelled;
@@ -815,8 +1243,12 @@ gdata_upload_stream_flush (GOutputStream *stream, GCancellable *cancellable, GEr
 	/* Start the flush operation proper */
 	g_mutex_lock (&(priv->write_mutex));
 
-	/* Wait for all outstanding bytes to be written to the network */
-	while (priv->network_bytes_outstanding > 0 && cancelled == FALSE && priv->state != STATE_FINISHED) {
+	/* Wait for all outstanding bytes to be written to the network, including any left in ->buffer by write-behind. Chunks of a resumable upload
+	 * of unknown length aren't sent until they're complete (or the stream's closed), so the bytes in ->buffer can't be waited for then. */
+	collects_chunks = (priv->resumable == TRUE && priv->content_length == -1);
+
+	while ((priv->network_bytes_outstanding > 0 || (collects_chunks == FALSE && priv->message_bytes_outstanding > 0)) &&
+	       cancelled == FALSE && priv->state != STATE_FINISHED) {
 		g_cond_wait (&(priv->write_cond), &(priv->write_mutex));
 	}
 
@@ -825,7 +1257,7 @@ gdata_upload_stream_flush (GOutputStream *stream, GCancellable *cancellable, GEr
 		g_assert (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE ||
 		          g_cancellable_set_error_if_cancelled (priv->cancellable, error) == TRUE);
 		success = FALSE;
-	} else if (priv->state == STATE_FINISHED && priv->network_bytes_outstanding > 0) {
+	} else if (priv->state == STATE_FINISHED && (priv->network_bytes_outstanding > 0 || priv->message_bytes_outstanding > 0)) {
 		/* Resumable upload error. */
 		g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, _("Error received from server after uploading a resumable upload chunk."));
 		success = FALSE;
@@ -884,9 +1316,19 @@ gdata_upload_stream_close (GOutputStream *stream, GCancellable *cancellable, GEr
 	gboolean is_finished;
 	GError *child_error = NULL;
 
-	/* If the operation was never started, return successfully immediately */
-	if (priv->network_thread == NULL)
+	/* If the stream's been closed before enough data was written to call the header function, call it with whatever there is */
+	if (priv->header_func != NULL && priv->header->len > 0 && run_header_func (GDATA_UPLOAD_STREAM (stream), cancellable, error) == FALSE)
+		return FALSE;
+
+	/* If we're uploading a mapped file, closing the stream is what starts the upload. Otherwise, if the operation was never started, return
+	 * successfully immediately. */
+	if (priv->network_thread == NULL && priv->mapped_file != NULL && priv->state != STATE_FINISHED) {
+		create_network_thread (GDATA_UPLOAD_STREAM (stream), error);
+		if (priv->network_thread == NULL)
+			return FALSE;
+	} else if (priv->network_thread == NULL) {
 		return TRUE;
+	}
 
 	/* If we've already closed the stream, return G_IO_ERROR_CLOSED */
 	g_mutex_lock (&(priv->response_mutex));
@@ -917,7 +1359,7 @@ gdata_upload_stream_close (GOutputStream *stream, GCancellable *cancellable, GEr
 	/* If an operation is still in progress, the upload thread hasn't finished yet… */
 	if (!is_finished) {
 		/* We've reached the end of the stream, so append the footer if the entire operation hasn't been cancelled. */
-		if (priv->entry != NULL && g_cancellable_is_cancelled (priv->cancellable) == FALSE) {
+		if (priv->entry != NULL && priv->resumable == FALSE && g_cancellable_is_cancelled (priv->cancellable) == FALSE) {
 			const gchar *footer = "\n--" BOUNDARY_STRING "--";
 			gsize footer_length = strlen (footer);
 
@@ -987,6 +1429,16 @@ gdata_upload_stream_close (GOutputStream *stream, GCancellable *cancellable, GEr
 	return success;
 }
 
+/* In the network thread context, block until @length bytes may be sent under the stream's and the service's bandwidth limits. */
+static void
+throttle_write (GDataUploadStream *self, gsize length)
+{
+	GDataUploadStreamPrivate *priv = self->priv;
+
+	gdata_bandwidth_limiter_throttle (priv->bandwidth_limiter, _gdata_service_get_upload_bandwidth_limiter (priv->service), length,
+	                                  priv->cancellable);
+}
+
 /* In the network thread context, called just after writing the headers, or just after writing a chunk, to write the next chunk to libsoup.
  * We don't let it return until we've finished pushing all the data into the buffer.
  * This is due to http://bugzilla.gnome.org/show_bug.cgi?id=522147, which means that
@@ -998,13 +1450,16 @@ gdata_upload_stream_close (GOutputStream *stream, GCancellable *cancellable, GEr
 static void
 write_next_chunk (GDataUploadStream *self, SoupMessage *message)
 {
-	#define CHUNK_SIZE 8192 /* 8KiB */
-
 	GDataUploadStreamPrivate *priv = self->priv;
 	gboolean has_network_bytes_outstanding, is_complete;
 	gsize length;
 	gboolean reached_eof = FALSE;
-	guint8 next_buffer[CHUNK_SIZE];
+	guint8 *next_buffer = priv->write_buffer;
+
+	/* Chunks of a resumable upload of unknown length are collected in full before their request is sent, so there's nothing more to write;
+	 * see build_unknown_length_chunk_message(). */
+	if (priv->resumable == TRUE && priv->content_length == -1 && priv->state == STATE_DATA_REQUESTS)
+		return;
 
 	g_mutex_lock (&(priv->write_mutex));
 	has_network_bytes_outstanding = (priv->network_bytes_outstanding > 0);
@@ -1023,23 +1478,55 @@ write_next_chunk (GDataUploadStream *self, SoupMessage *message)
 	}
 
 	/* Append the next chunk to the message body so it can join in the fun.
-	 * Note that this call isn't necessarily blocking, and can return less than the CHUNK_SIZE. This is because
-	 * we could deadlock if we block on getting CHUNK_SIZE bytes at the end of the stream. write() could
+	 * Note that this call isn't necessarily blocking, and can return less than the WRITE_BUFFER_SIZE. This is because
+	 * we could deadlock if we block on getting WRITE_BUFFER_SIZE bytes at the end of the stream. write() could
 	 * easily be called with fewer bytes, but has no way to notify us that we've reached the end of the
 	 * stream, so we'd happily block on receiving more bytes which weren't forthcoming.
 	 *
 	 * Note also that we can't block on this call with write_mutex locked, or we could get into a deadlock if the stream is flushed at the same
 	 * time (in the case that we don't know the content length ahead of time). */
-	if (priv->content_length == -1) {
+	if (priv->mapped_file != NULL) {
+		SoupBuffer *mapped_buffer;
+		gsize offset;
+
+		/* Uploading from a mapped file. Hand the rest of the chunk to libsoup in one go as a buffer which references the mapped pages,
+		 * rather than copying it through ->buffer. Only this thread modifies the counters, so we can read them without write_mutex.
+		 * If the upload's bandwidth is limited, hand it over a buffer at a time instead, so that it can be paced. */
+		offset = priv->total_network_bytes_written + priv->network_bytes_outstanding;
+		length = priv->chunk_size - (priv->network_bytes_written + priv->network_bytes_outstanding);
+
+		if (gdata_bandwidth_limiter_get_rate (priv->bandwidth_limiter) > 0 ||
+		    gdata_bandwidth_limiter_get_rate (_gdata_service_get_upload_bandwidth_limiter (priv->service)) > 0) {
+			length = MIN (length, WRITE_BUFFER_SIZE);
+			throttle_write (self, length);
+		}
+
+		mapped_buffer = soup_buffer_new_with_owner (g_mapped_file_get_contents (priv->mapped_file) + offset, length,
+		                                            g_mapped_file_ref (priv->mapped_file), (GDestroyNotify) g_mapped_file_unref);
+
+		g_mutex_lock (&(priv->write_mutex));
+		priv->network_bytes_outstanding += length;
+		soup_message_body_append_buffer (priv->message->request_body, mapped_buffer);
+		if (priv->network_bytes_written + priv->network_bytes_outstanding == priv->chunk_size)
+			soup_message_body_complete (priv->message->request_body);
+		g_mutex_unlock (&(priv->write_mutex));
+
+		soup_buffer_free (mapped_buffer);
+
+		return;
+	} else if (priv->resumable == FALSE) {
 		/* Non-resumable upload. */
-		length = gdata_buffer_pop_data_limited (priv->buffer, next_buffer, CHUNK_SIZE, &reached_eof);
+		length = gdata_buffer_pop_data_limited (priv->buffer, next_buffer, WRITE_BUFFER_SIZE, &reached_eof);
 	} else {
 		/* Resumable upload. Ensure we don't exceed the chunk size. */
 		length = gdata_buffer_pop_data_limited (priv->buffer, next_buffer,
-		                                        MIN (CHUNK_SIZE, priv->chunk_size - (priv->network_bytes_written +
+		                                        MIN (WRITE_BUFFER_SIZE, priv->chunk_size - (priv->network_bytes_written +
 		                                                                             priv->network_bytes_outstanding)), &reached_eof);
 	}
 
+	/* Pace the upload if its bandwidth is limited. This is done without write_mutex held, so that writes to the stream aren't held up. */
+	throttle_write (self, length);
+
 	g_mutex_lock (&(priv->write_mutex));
 
 	priv->message_bytes_outstanding -= length;
@@ -1085,6 +1572,7 @@ wrote_body_data_cb (SoupMessage *message, SoupBuffer *buffer, GDataUploadStream
 	g_assert (priv->network_bytes_outstanding > 0);
 	priv->network_bytes_outstanding -= buffer->length;
 	priv->network_bytes_written += buffer->length;
+	priv->chunk_last_write_time = g_get_monotonic_time ();
 
 	if (priv->state == STATE_DATA_REQUESTS) {
 		priv->total_network_bytes_written += buffer->length;
@@ -1097,126 +1585,335 @@ wrote_body_data_cb (SoupMessage *message, SoupBuffer *buffer, GDataUploadStream
 	write_next_chunk (self, message);
 }
 
-static gpointer
-upload_thread (GDataUploadStream *self)
+/* Build a PUT request for the next chunk of a resumable upload, starting at ->total_network_bytes_written, and return its length in @chunk_length.
+ * This must be called with ->write_mutex held, or before the network thread has been created. */
+static SoupMessage *
+build_chunk_message (GDataUploadStream *self, const gchar *uri, gsize *chunk_length)
 {
 	GDataUploadStreamPrivate *priv = self->priv;
+	GDataServiceClass *klass;
+	SoupMessage *new_message;
+	gsize next_chunk_length;
 
-	g_assert (priv->cancellable != NULL);
+	next_chunk_length = MIN (priv->content_length - priv->total_network_bytes_written, priv->resumable_chunk_size);
 
-	while (TRUE) {
-		GDataServiceClass *klass;
-		gulong wrote_headers_signal, wrote_body_data_signal;
-		gchar *new_uri;
-		SoupMessage *new_message;
-		gsize next_chunk_length;
+	new_message = build_message (self, SOUP_METHOD_PUT, uri);
 
-		/* Connect to the wrote-* signals so we can prepare the next chunk for transmission */
-		wrote_headers_signal = g_signal_connect (priv->message, "wrote-headers", (GCallback) wrote_headers_cb, self);
-		wrote_body_data_signal = g_signal_connect (priv->message, "wrote-body-data", (GCallback) wrote_body_data_cb, self);
+	soup_message_headers_set_encoding (new_message->request_headers, SOUP_ENCODING_CONTENT_LENGTH);
+	soup_message_headers_set_content_type (new_message->request_headers, priv->content_type, NULL);
+	soup_message_headers_set_content_length (new_message->request_headers, next_chunk_length);
+	soup_message_headers_set_content_range (new_message->request_headers, priv->total_network_bytes_written,
+	                                        priv->total_network_bytes_written + next_chunk_length - 1, priv->content_length);
 
-		_gdata_service_actually_send_message (priv->session, priv->message, priv->cancellable, NULL);
+	/* Make sure the headers are set. HACK: This should actually be in build_message(), but we have to work around
+	 * http://code.google.com/a/google.com/p/apps-api-issues/issues/detail?id=3033 in GDataDocumentsService's append_query_headers(). */
+	klass = GDATA_SERVICE_GET_CLASS (priv->service);
+	if (klass->append_query_headers != NULL) {
+		klass->append_query_headers (priv->service, priv->authorization_domain, new_message);
+	}
 
-		g_mutex_lock (&(priv->write_mutex));
+	*chunk_length = next_chunk_length;
 
-		/* If this is a resumable upload, continue to the next chunk. If it's a non-resumable upload, we're done. We have several cases:
-		 *  • Non-resumable upload:
-		 *     - Content only: STATE_DATA_REQUESTS → STATE_FINISHED
-		 *     - Metadata only: not supported
-		 *     - Content and metadata: STATE_DATA_REQUESTS → STATE_FINISHED
-		 *  • Resumable upload:
-		 *     - Content only:
-		 *        * STATE_INITIAL_REQUEST → STATE_DATA_REQUESTS
-		 *        * STATE_DATA_REQUESTS → STATE_DATA_REQUESTS
-		 *        * STATE_DATA_REQUESTS → STATE_FINISHED
-		 *     - Metadata only: STATE_INITIAL_REQUEST → STATE_FINISHED
-		 *     - Content and metadata:
-		 *        * STATE_INITIAL_REQUEST → STATE_DATA_REQUESTS
-		 *        * STATE_DATA_REQUESTS → STATE_DATA_REQUESTS
-		 *        * STATE_DATA_REQUESTS → STATE_FINISHED
-		 */
-		switch (priv->state) {
-			case STATE_INITIAL_REQUEST:
-				/* We're either a content-only or a content-and-metadata resumable upload. */
-				priv->state = STATE_DATA_REQUESTS;
+	return new_message;
+}
 
-				/* Check the response. On success it should be empty, status 200, with a Location header telling us where to upload
-				 * next. If it's an error response, bail out and let the code in gdata_upload_stream_close() parse the error..*/
-				if (!SOUP_STATUS_IS_SUCCESSFUL (priv->message->status_code)) {
-					goto finished;
-				} else if (priv->content_length == 0 && priv->message->status_code == SOUP_STATUS_CREATED) {
-					/* If this was a metadata-only upload, we're done. */
-					goto finished;
-				}
+/* In the network thread context, collect the next chunk of a resumable upload of unknown length from ->buffer, blocking until either a whole chunk
+ * has been written to the stream or the stream has been closed, and build a PUT request for it. Chunks other than the last are sent with an
+ * unknown total length; the last gives the total length, and may be empty if the previous chunk happened to end exactly at EOF. Unlike
+ * build_chunk_message(), the whole chunk is added to the request body, so this must be called *without* ->write_mutex held, or the client could
+ * never finish writing the chunk. */
+static SoupMessage *
+build_unknown_length_chunk_message (GDataUploadStream *self, const gchar *uri)
+{
+	GDataUploadStreamPrivate *priv = self->priv;
+	GDataServiceClass *klass;
+	SoupMessage *new_message;
+	guint8 *data;
+	gsize chunk_size, length;
+	goffset offset;
+	gboolean reached_eof = FALSE;
 
-				/* Fall out and prepare the next message */
-				g_assert (priv->total_network_bytes_written == 0); /* haven't written any data yet */
+	g_mutex_lock (&(priv->write_mutex));
+	chunk_size = priv->resumable_chunk_size;
+	priv->chunk_size = chunk_size;
+	g_mutex_unlock (&(priv->write_mutex));
 
-				break;
-			case STATE_DATA_REQUESTS:
-				/* Check the response. On completion it should contain the resulting entry's XML, status 201. On continuation it should
-				 * be empty, status 308, with a Range header and potentially a Location header telling us what/where to upload next.
-				 * If it's an error response, bail out and let the code in gdata_upload_stream_close() parse the error..*/
-				if (priv->message->status_code == 308) {
-					/* Continuation: fall out and prepare the next message */
-					g_assert (priv->content_length == -1 || priv->total_network_bytes_written < (gsize) priv->content_length);
-				} else if (SOUP_STATUS_IS_SUCCESSFUL (priv->message->status_code)) {
-					/* Completion. Check the server isn't misbehaving. */
-					g_assert (priv->content_length == -1 || priv->total_network_bytes_written == (gsize) priv->content_length);
+	/* Only this thread modifies total_network_bytes_written, so it's safe to read here */
+	offset = priv->total_network_bytes_written;
 
-					goto finished;
-				} else {
-					/* Error */
-					goto finished;
-				}
+	data = g_malloc (chunk_size);
+	length = gdata_buffer_pop_data (priv->buffer, data, chunk_size, &reached_eof, priv->cancellable);
 
-				/* Fall out and prepare the next message */
-				g_assert (priv->total_network_bytes_written > 0);
+	new_message = build_message (self, SOUP_METHOD_PUT, uri);
 
-				break;
-			case STATE_FINISHED:
-			default:
-				g_assert_not_reached ();
-		}
+	soup_message_headers_set_encoding (new_message->request_headers, SOUP_ENCODING_CONTENT_LENGTH);
+	soup_message_headers_set_content_type (new_message->request_headers, priv->content_type, NULL);
+	soup_message_headers_set_content_length (new_message->request_headers, length);
 
-		/* Prepare the next message. */
-		g_assert (priv->content_length != -1);
+	if (length > 0) {
+		soup_message_headers_set_content_range (new_message->request_headers, offset, offset + length - 1,
+		                                        (reached_eof == TRUE) ? offset + (goffset) length : -1);
+	} else {
+		gchar *content_range;
+
+		/* The previous chunk ended at EOF, but we didn't know that when sending it; so just tell the server the total length */
+		content_range = (reached_eof == TRUE) ? g_strdup_printf ("bytes */%" G_GOFFSET_FORMAT, offset) : g_strdup ("bytes */*");
+		soup_message_headers_replace (new_message->request_headers, "Content-Range", content_range);
+		g_free (content_range);
+	}
+
+	/* Make sure the headers are set. HACK: See build_chunk_message(). */
+	klass = GDATA_SERVICE_GET_CLASS (priv->service);
+	if (klass->append_query_headers != NULL) {
+		klass->append_query_headers (priv->service, priv->authorization_domain, new_message);
+	}
+
+	g_mutex_lock (&(priv->write_mutex));
+
+	if (length > 0)
+		soup_message_body_append (new_message->request_body, SOUP_MEMORY_TAKE, data, length);
+	else
+		g_free (data);
+	soup_message_body_complete (new_message->request_body);
+
+	priv->message_bytes_outstanding -= length;
+	priv->network_bytes_outstanding = length;
+	priv->network_bytes_written = 0;
+	priv->chunk_size = length;
+
+	g_mutex_unlock (&(priv->write_mutex));
+
+	return new_message;
+}
+
+/* Parse the Range header of a 308 response to a resumable upload request, returning the number of bytes the server has committed. If there's no
+ * Range header, the server hasn't committed anything. */
+static goffset
+parse_committed_range (SoupMessage *message, goffset content_length)
+{
+	SoupRange *ranges;
+	gint length;
+	goffset committed = 0;
+
+	/* The range is only ever a prefix of the file, so if the total length isn't known yet, any finite bound will do */
+	if (content_length == -1)
+		content_length = G_MAXINT64;
+
+	if (soup_message_headers_get_ranges (message->response_headers, content_length, &ranges, &length) == TRUE) {
+		if (length > 0 && ranges[0].start == 0)
+			committed = ranges[0].end + 1;
+
+		soup_message_headers_free_ranges (message->response_headers, ranges);
+	}
+
+	return committed;
+}
+
+/* In the network thread context, called once the server has successfully responded to a request in a resumable upload. Updates the session URI
+ * and number of committed bytes which are exported by gdata_upload_stream_save_session(). */
+static void
+update_session (GDataUploadStream *self, SoupMessage *message)
+{
+	GDataUploadStreamPrivate *priv = self->priv;
+	const gchar *location;
+
+	g_mutex_lock (&(priv->write_mutex));
+
+	location = soup_message_headers_get_one (message->response_headers, "Location");
+	if (location != NULL) {
+		g_free (priv->session_uri);
+		priv->session_uri = g_strdup (location);
+	} else if (priv->session_uri == NULL) {
+		priv->session_uri = soup_uri_to_string (soup_message_get_uri (message), FALSE);
+	}
+
+	if (message->status_code == 308)
+		priv->committed_length = parse_committed_range (message, priv->content_length);
+	else if (priv->state == STATE_DATA_REQUESTS)
+		priv->committed_length = (priv->content_length != -1) ? priv->content_length : (goffset) priv->total_network_bytes_written;
+
+	g_mutex_unlock (&(priv->write_mutex));
+}
+
+/* In the network thread context, called once the server has acknowledged a chunk of a resumable upload. Updates the throughput and round-trip
+ * time estimates, recalculates the chunk size if adaptive chunk sizing is enabled, and emits GDataUploadStream::chunk-sent. */
+static void
+chunk_sent (GDataUploadStream *self, gint64 request_time, gint64 response_time)
+{
+	GDataUploadStreamPrivate *priv = self->priv;
+	gint64 send_time, wait_time;
+	goffset offset;
+	gsize length;
+
+	length = priv->network_bytes_written;
+	offset = priv->total_network_bytes_written - length;
+	send_time = MAX (priv->chunk_last_write_time - request_time, 1);
+	wait_time = MAX (response_time - priv->chunk_last_write_time, 0);
+
+	/* Only chunks which were full-sized are representative of the throughput; the final one may be tiny. Use an exponentially-weighted moving
+	 * average so that one slow chunk doesn't throw things off too much. */
+	if (length == priv->chunk_size && length > 0) {
+		gdouble throughput = (gdouble) length * G_USEC_PER_SEC / send_time;
+		gdouble rtt = (gdouble) wait_time / G_USEC_PER_SEC;
+
+		if (priv->throughput_estimate == 0.0) {
+			priv->throughput_estimate = throughput;
+			priv->rtt_estimate = rtt;
+		} else {
+			priv->throughput_estimate = (priv->throughput_estimate + throughput) / 2.0;
+			priv->rtt_estimate = (priv->rtt_estimate + rtt) / 2.0;
+		}
+
+		g_mutex_lock (&(priv->write_mutex));
+
+		if (priv->adaptive_chunk_size == TRUE) {
+			gdouble target;
+			gsize min_size, max_size, new_size;
+
+			min_size = MIN (priv->min_chunk_size, priv->max_chunk_size);
+			max_size = priv->max_chunk_size;
+
+			/* Aim for a chunk which takes ADAPTIVE_CHUNK_RTT_RATIO round trips to send, but never more than double the chunk size at once,
+			 * since the throughput measured for small chunks is dominated by TCP slow start. */
+			target = priv->throughput_estimate * priv->rtt_estimate * ADAPTIVE_CHUNK_RTT_RATIO;
+			target = MIN (target, 2.0 * priv->resumable_chunk_size);
+			target = CLAMP (target, (gdouble) min_size, (gdouble) max_size);
+
+			new_size = ((gsize) target / RESUMABLE_CHUNK_SIZE_GRANULARITY) * RESUMABLE_CHUNK_SIZE_GRANULARITY;
+			priv->resumable_chunk_size = MAX (new_size, min_size);
+		}
+
+		g_mutex_unlock (&(priv->write_mutex));
+	}
+
+	GDATA_TRACE4 (upload_chunk_end, self, offset, length, send_time);
+
+	g_signal_emit (self, upload_stream_signals[SIGNAL_CHUNK_SENT], 0, (gint64) offset, (guint) length, send_time, wait_time);
+}
+
+static gpointer
+upload_thread (GDataUploadStream *self)
+{
+	GDataUploadStreamPrivate *priv = self->priv;
+
+	g_assert (priv->cancellable != NULL);
 
-		next_chunk_length = MIN (priv->content_length - priv->total_network_bytes_written, MAX_RESUMABLE_CHUNK_SIZE);
+	while (TRUE) {
+		gulong wrote_headers_signal, wrote_body_data_signal;
+		SoupMessage *new_message;
+		gsize next_chunk_length;
+		gint64 request_time;
 
-		new_uri = g_strdup (soup_message_headers_get_one (priv->message->response_headers, "Location"));
-		if (new_uri == NULL) {
-			new_uri = soup_uri_to_string (soup_message_get_uri (priv->message), FALSE);
+		/* A resumed upload of unknown length starts with its first chunk, which can't be built until the client has written it; see
+		 * gdata_upload_stream_new_from_session(). */
+		if (priv->message == NULL)
+			priv->message = build_unknown_length_chunk_message (self, priv->session_uri);
+
+		/* Connect to the wrote-* signals so we can prepare the next chunk for transmission */
+		wrote_headers_signal = g_signal_connect (priv->message, "wrote-headers", (GCallback) wrote_headers_cb, self);
+		wrote_body_data_signal = g_signal_connect (priv->message, "wrote-body-data", (GCallback) wrote_body_data_cb, self);
+
+		request_time = g_get_monotonic_time ();
+		priv->chunk_last_write_time = request_time;
+
+		GDATA_TRACE3 (upload_chunk_start, self, priv->state, priv->total_network_bytes_written);
+
+		_gdata_service_actually_send_message (priv->session, priv->message, priv->cancellable, NULL);
+
+		/* The counters are only modified by this thread, so are safe to read here without write_mutex */
+		if (priv->resumable == TRUE && (priv->message->status_code == 308 || SOUP_STATUS_IS_SUCCESSFUL (priv->message->status_code))) {
+			update_session (self, priv->message);
+
+			if (priv->state == STATE_DATA_REQUESTS)
+				chunk_sent (self, request_time, g_get_monotonic_time ());
 		}
 
-		new_message = build_message (self, SOUP_METHOD_PUT, new_uri);
+		g_mutex_lock (&(priv->write_mutex));
+
+		/* If this is a resumable upload, continue to the next chunk. If it's a non-resumable upload, we're done. We have several cases:
+		 *  • Non-resumable upload:
+		 *     - Content only: STATE_DATA_REQUESTS → STATE_FINISHED
+		 *     - Metadata only: not supported
+		 *     - Content and metadata: STATE_DATA_REQUESTS → STATE_FINISHED
+		 *  • Resumable upload:
+		 *     - Content only:
+		 *        * STATE_INITIAL_REQUEST → STATE_DATA_REQUESTS
+		 *        * STATE_DATA_REQUESTS → STATE_DATA_REQUESTS
+		 *        * STATE_DATA_REQUESTS → STATE_FINISHED
+		 *     - Metadata only: STATE_INITIAL_REQUEST → STATE_FINISHED
+		 *     - Content and metadata:
+		 *        * STATE_INITIAL_REQUEST → STATE_DATA_REQUESTS
+		 *        * STATE_DATA_REQUESTS → STATE_DATA_REQUESTS
+		 *        * STATE_DATA_REQUESTS → STATE_FINISHED
+		 */
+		switch (priv->state) {
+			case STATE_INITIAL_REQUEST:
+				/* We're either a content-only or a content-and-metadata resumable upload. */
+				priv->state = STATE_DATA_REQUESTS;
+
+				/* Check the response. On success it should be empty, status 200, with a Location header telling us where to upload
+				 * next. If it's an error response, bail out and let the code in gdata_upload_stream_close() parse the error..*/
+				if (!SOUP_STATUS_IS_SUCCESSFUL (priv->message->status_code)) {
+					goto finished;
+				} else if (priv->content_length == 0 && priv->message->status_code == SOUP_STATUS_CREATED) {
+					/* If this was a metadata-only upload, we're done. */
+					goto finished;
+				}
+
+				/* Fall out and prepare the next message */
+				g_assert (priv->total_network_bytes_written == 0); /* haven't written any data yet */
+
+				break;
+			case STATE_DATA_REQUESTS:
+				/* Check the response. On completion it should contain the resulting entry's XML, status 201. On continuation it should
+				 * be empty, status 308, with a Range header and potentially a Location header telling us what/where to upload next.
+				 * If it's an error response, bail out and let the code in gdata_upload_stream_close() parse the error..*/
+				if (priv->message->status_code == 308) {
+					/* Continuation: fall out and prepare the next message */
+					g_assert (priv->content_length == -1 || priv->total_network_bytes_written < (gsize) priv->content_length);
+				} else if (SOUP_STATUS_IS_SUCCESSFUL (priv->message->status_code)) {
+					/* Completion. Check the server isn't misbehaving. */
+					g_assert (priv->content_length == -1 || priv->total_network_bytes_written == (gsize) priv->content_length);
 
-		g_free (new_uri);
+					goto finished;
+				} else {
+					/* Error */
+					goto finished;
+				}
 
-		soup_message_headers_set_encoding (new_message->request_headers, SOUP_ENCODING_CONTENT_LENGTH);
-		soup_message_headers_set_content_type (new_message->request_headers, priv->content_type, NULL);
-		soup_message_headers_set_content_length (new_message->request_headers, next_chunk_length);
-		soup_message_headers_set_content_range (new_message->request_headers, priv->total_network_bytes_written,
-		                                        priv->total_network_bytes_written + next_chunk_length - 1, priv->content_length);
+				/* Fall out and prepare the next message */
+				g_assert (priv->total_network_bytes_written > 0);
 
-		/* Make sure the headers are set. HACK: This should actually be in build_message(), but we have to work around
-		 * http://code.google.com/a/google.com/p/apps-api-issues/issues/detail?id=3033 in GDataDocumentsService's append_query_headers(). */
-		klass = GDATA_SERVICE_GET_CLASS (priv->service);
-		if (klass->append_query_headers != NULL) {
-			klass->append_query_headers (priv->service, priv->authorization_domain, new_message);
+				break;
+			case STATE_FINISHED:
+			default:
+				g_assert_not_reached ();
 		}
 
+		/* Prepare the next message. */
+		g_assert (priv->resumable == TRUE);
+		g_assert (priv->session_uri != NULL);
+
 		g_signal_handler_disconnect (priv->message, wrote_body_data_signal);
 		g_signal_handler_disconnect (priv->message, wrote_headers_signal);
 
-		g_object_unref (priv->message);
-		priv->message = new_message;
-
 		/* Reset various counters for the next upload. Note that message_bytes_outstanding may be > 0 at this point, since the client may
 		 * have pushed some content into the buffer while we were waiting for the response to this request. */
 		g_assert (priv->network_bytes_outstanding == 0);
-		priv->chunk_size = next_chunk_length;
-		priv->network_bytes_written = 0;
+
+		if (priv->content_length == -1) {
+			/* Unknown length: wait for the client to write the next chunk. Only this thread touches the session URI. */
+			g_mutex_unlock (&(priv->write_mutex));
+			new_message = build_unknown_length_chunk_message (self, priv->session_uri);
+			g_mutex_lock (&(priv->write_mutex));
+		} else {
+			new_message = build_chunk_message (self, priv->session_uri, &next_chunk_length);
+			priv->chunk_size = next_chunk_length;
+			priv->network_bytes_written = 0;
+		}
+
+		g_object_unref (priv->message);
+		priv->message = new_message;
 
 		/* Loop round and upload this chunk now. */
 		g_mutex_unlock (&(priv->write_mutex));
@@ -1329,7 +2026,7 @@ gdata_upload_stream_new (GDataService *service, GDataAuthorizationDomain *domain
  * @entry: (allow-none): the entry to upload as metadata, or %NULL
  * @slug: the file's slug (filename)
  * @content_type: the content type of the file being uploaded
- * @content_length: the size (in bytes) of the file being uploaded
+ * @content_length: the size (in bytes) of the file being uploaded, or <code class="literal">-1</code> if it isn't known yet
  * @cancellable: (allow-none): a #GCancellable for the entire upload stream, or %NULL
  *
  * Creates a new resumable #GDataUploadStream, allowing a file to be uploaded from a GData service using standard #GOutputStream API. The upload will
@@ -1348,6 +2045,12 @@ gdata_upload_stream_new (GDataService *service, GDataAuthorizationDomain *domain
  * correct content type for the file, and should be in the service's list of acceptable content types. @content_length must be the size of the file
  * being uploaded (not including the XML for any associated #GDataEntry) in bytes. Zero is accepted if a metadata-only upload is being performed.
  *
+ * If the size of the file isn't known until it's all been written (for example, if it's being recorded live), @content_length may be
+ * <code class="literal">-1</code>. The data is then sent in chunks of #GDataUploadStream:chunk-size bytes as soon as each has been written,
+ * and the total length is given to the server when the stream is closed. Calls to g_output_stream_write() only block while more than a chunk of
+ * data is waiting to be sent, and g_output_stream_flush() doesn't send a partial chunk, since the protocol requires all chunks except the last
+ * to be a multiple of 256 KiB. See #GDataUploadStream:resumable.
+ *
  * As well as the standard GIO errors, calls to the #GOutputStream API on a #GDataUploadStream can also return any relevant specific error from
  * #GDataServiceError, or %GDATA_SERVICE_ERROR_PROTOCOL_ERROR in the general case.
  *
@@ -1374,7 +2077,7 @@ gdata_upload_stream_new_resumable (GDataService *service, GDataAuthorizationDoma
 	g_return_val_if_fail (entry == NULL || GDATA_IS_ENTRY (entry), NULL);
 	g_return_val_if_fail (slug != NULL, NULL);
 	g_return_val_if_fail (content_type != NULL, NULL);
-	g_return_val_if_fail (content_length >= 0, NULL);
+	g_return_val_if_fail (content_length >= -1, NULL);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
 
 	/* Create the upload stream */
@@ -1387,10 +2090,249 @@ gdata_upload_stream_new_resumable (GDataService *service, GDataAuthorizationDoma
 	                                      "slug", slug,
 	                                      "content-type", content_type,
 	                                      "content-length", content_length,
+	                                      "resumable", TRUE,
 	                                      "cancellable", cancellable,
 	                                      NULL));
 }
 
+/**
+ * gdata_upload_stream_new_resumable_from_file:
+ * @service: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain to authorize the upload, or %NULL
+ * @method: the HTTP method to use
+ * @upload_uri: the URI to upload
+ * @entry: (allow-none): the entry to upload as metadata, or %NULL
+ * @slug: the file's slug (filename)
+ * @content_type: the content type of the file being uploaded
+ * @file: the local file to upload
+ * @cancellable: (allow-none): a #GCancellable for the entire upload stream, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Creates a new resumable #GDataUploadStream which uploads the contents of @file, as gdata_upload_stream_new_resumable() does. Rather than being
+ * written to the stream, the contents are memory-mapped and passed to the network directly, without being copied into intermediate buffers, which
+ * makes this much cheaper than writing the file to a normal #GDataUploadStream for large files. The content length is taken from the size of @file,
+ * which must not be modified while the upload is in progress.
+ *
+ * The upload is started by calling g_output_stream_close() (or g_output_stream_close_async()) on the returned stream, which returns once the upload
+ * has finished, exactly as for a stream which has been written to; the server's response can then be retrieved using
+ * gdata_upload_stream_get_response(). Calls to g_output_stream_write() on the stream will fail with %G_IO_ERROR_NOT_SUPPORTED. If the stream is
+ * finalized without being closed, nothing is uploaded.
+ *
+ * @file must be a local file (i.e. g_file_get_path() must return non-%NULL), otherwise %G_IO_ERROR_NOT_SUPPORTED will be returned. Errors from
+ * mapping the file are returned as #GFileError.
+ *
+ * Return value: (transfer full): a new #GOutputStream, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GOutputStream *
+gdata_upload_stream_new_resumable_from_file (GDataService *service, GDataAuthorizationDomain *domain, const gchar *method, const gchar *upload_uri,
+                                             GDataEntry *entry, const gchar *slug, const gchar *content_type, GFile *file,
+                                             GCancellable *cancellable, GError **error)
+{
+	GDataUploadStream *self;
+	GMappedFile *mapped_file;
+	gchar *path;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (method != NULL, NULL);
+	g_return_val_if_fail (upload_uri != NULL, NULL);
+	g_return_val_if_fail (entry == NULL || GDATA_IS_ENTRY (entry), NULL);
+	g_return_val_if_fail (slug != NULL, NULL);
+	g_return_val_if_fail (content_type != NULL, NULL);
+	g_return_val_if_fail (G_IS_FILE (file), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	path = g_file_get_path (file);
+	if (path == NULL) {
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED, _("Only local files can be uploaded without copying."));
+		return NULL;
+	}
+
+	mapped_file = g_mapped_file_new (path, FALSE, error);
+	g_free (path);
+
+	if (mapped_file == NULL)
+		return NULL;
+
+	/* Create the upload stream */
+	self = GDATA_UPLOAD_STREAM (g_object_new (GDATA_TYPE_UPLOAD_STREAM,
+	                                          "method", method,
+	                                          "upload-uri", upload_uri,
+	                                          "service", service,
+	                                          "authorization-domain", domain,
+	                                          "entry", entry,
+	                                          "slug", slug,
+	                                          "content-type", content_type,
+	                                          "content-length", (gint64) g_mapped_file_get_length (mapped_file),
+	                                          "cancellable", cancellable,
+	                                          NULL));
+	self->priv->mapped_file = mapped_file;
+
+	return G_OUTPUT_STREAM (self);
+}
+
+/**
+ * gdata_upload_stream_new_from_session:
+ * @service: a #GDataService
+ * @domain: (allow-none): the #GDataAuthorizationDomain to authorize the upload, or %NULL
+ * @session: an upload session previously returned by gdata_upload_stream_save_session()
+ * @cancellable: (allow-none): a #GCancellable for the entire upload stream, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Creates a new resumable #GDataUploadStream which continues the upload described by @session, which was saved from a previous #GDataUploadStream
+ * using gdata_upload_stream_save_session() (possibly in a different process). @service and @domain should be equivalent to those used for the
+ * original upload.
+ *
+ * The server is queried for the number of bytes of the file it has already received, which is synchronous and may block. Once it has returned,
+ * gdata_upload_stream_get_committed_length() gives the offset into the file from which writing to the new stream must continue. The data from
+ * that offset to the end of the file should then be written to the stream, and it should be closed, exactly as with a stream returned by
+ * gdata_upload_stream_new_resumable().
+ *
+ * If the server had already received the entire file, the returned stream is already complete: gdata_upload_stream_get_committed_length() will
+ * return the stream's #GDataUploadStream:content-length, gdata_upload_stream_get_response() will return the server's response, and any attempts
+ * to write to the stream will fail with %G_IO_ERROR_CLOSED.
+ *
+ * If @session is invalid, %GDATA_PARSER_ERROR_PARSING_STRING will be returned. If the server doesn't recognise the session (for example, because it
+ * has expired), an error from #GDataServiceError will be returned, and the upload must be restarted from scratch.
+ *
+ * Return value: (transfer full): a new #GOutputStream, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GOutputStream *
+gdata_upload_stream_new_from_session (GDataService *service, GDataAuthorizationDomain *domain, const gchar *session, GCancellable *cancellable,
+                                      GError **error)
+{
+	GDataUploadStream *self;
+	GDataUploadStreamPrivate *priv;
+	GDataServiceClass *klass;
+	SoupMessage *message;
+	gchar **lines, *end, *slug, *content_range;
+	goffset content_length;
+	GError *child_error = NULL;
+
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (session != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* Parse the session: see gdata_upload_stream_save_session() for the format */
+	lines = g_strsplit (session, "\n", -1);
+
+	if (g_strv_length (lines) < 5 || strcmp (lines[0], SESSION_HEADER) != 0 || *lines[2] == '\0' || *lines[4] == '\0') {
+		goto parse_error;
+	}
+
+	content_length = g_ascii_strtoll (lines[1], &end, 10);
+	if (end == lines[1] || (*end != ' ' && *end != '\0') || content_length < -1) {
+		goto parse_error;
+	}
+
+	slug = g_strcompress (lines[3]);
+
+	self = GDATA_UPLOAD_STREAM (g_object_new (GDATA_TYPE_UPLOAD_STREAM,
+	                                          "method", SOUP_METHOD_PUT,
+	                                          "upload-uri", lines[4],
+	                                          "service", service,
+	                                          "authorization-domain", domain,
+	                                          "slug", slug,
+	                                          "content-type", lines[2],
+	                                          "content-length", content_length,
+	                                          "resumable", TRUE,
+	                                          "cancellable", cancellable,
+	                                          NULL));
+	priv = self->priv;
+
+	g_free (slug);
+	g_strfreev (lines);
+
+	/* Ask the server how much of the file it has already received, using an empty PUT request whose Content-Range gives only the total length */
+	message = build_message (self, SOUP_METHOD_PUT, priv->upload_uri);
+	soup_message_headers_set_encoding (message->request_headers, SOUP_ENCODING_CONTENT_LENGTH);
+	soup_message_headers_set_content_length (message->request_headers, 0);
+
+	if (priv->content_length != -1)
+		content_range = g_strdup_printf ("bytes */%" G_GOFFSET_FORMAT, priv->content_length);
+	else
+		content_range = g_strdup ("bytes */*");
+	soup_message_headers_replace (message->request_headers, "Content-Range", content_range);
+	g_free (content_range);
+
+	klass = GDATA_SERVICE_GET_CLASS (priv->service);
+	if (klass->append_query_headers != NULL) {
+		klass->append_query_headers (priv->service, priv->authorization_domain, message);
+	}
+
+	_gdata_service_actually_send_message (priv->session, message, priv->cancellable, &child_error);
+
+	if (child_error != NULL) {
+		/* Cancelled */
+		g_propagate_error (error, child_error);
+		goto error;
+	} else if (message->status_code == 308) {
+		/* The upload is incomplete, so throw away the initial request built by the constructor and replace it with a request for the
+		 * first chunk we still need to send. */
+		priv->committed_length = parse_committed_range (message, priv->content_length);
+		priv->total_network_bytes_written = priv->committed_length;
+		priv->total_bytes_pushed = priv->committed_length;
+
+		if (soup_message_headers_get_one (message->response_headers, "Location") != NULL)
+			priv->session_uri = g_strdup (soup_message_headers_get_one (message->response_headers, "Location"));
+		else
+			priv->session_uri = g_strdup (priv->upload_uri);
+
+		g_object_unref (priv->message);
+		priv->message = NULL;
+
+		/* If the length is unknown, the network thread builds the first message once the client has written enough data for it */
+		if (priv->content_length != -1)
+			priv->message = build_chunk_message (self, priv->session_uri, &(priv->chunk_size));
+		else
+			priv->chunk_size = 0;
+
+		priv->network_bytes_outstanding = 0;
+		priv->state = STATE_DATA_REQUESTS;
+
+		g_object_unref (message);
+	} else if (SOUP_STATUS_IS_SUCCESSFUL (message->status_code)) {
+		/* The server had already received everything, and has sent us the final response */
+		if (priv->content_length != -1) {
+			priv->committed_length = priv->content_length;
+			priv->total_network_bytes_written = priv->content_length;
+		}
+
+		priv->session_uri = g_strdup (priv->upload_uri);
+
+		g_object_unref (priv->message);
+		priv->message = message;
+		priv->state = STATE_FINISHED;
+		priv->response_status = message->status_code;
+	} else {
+		g_assert (klass->parse_error_response != NULL);
+		klass->parse_error_response (priv->service, GDATA_OPERATION_UPLOAD, message->status_code, message->reason_phrase,
+		                             message->response_body->data, message->response_body->length, error);
+		goto error;
+	}
+
+	return G_OUTPUT_STREAM (self);
+
+parse_error:
+	g_strfreev (lines);
+	g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING, _("The upload session was invalid."));
+
+	return NULL;
+
+error:
+	g_object_unref (message);
+	g_object_unref (self);
+
+	return NULL;
+}
+
 /**
  * gdata_upload_stream_get_response:
  * @self: a #GDataUploadStream
@@ -1568,8 +2510,8 @@ gdata_upload_stream_get_content_type (GDataUploadStream *self)
  * gdata_upload_stream_get_content_length:
  * @self: a #GDataUploadStream
  *
- * Gets the size (in bytes) of the file being uploaded. This will be <code class="literal">-1</code> for a non-resumable upload, and zero or greater
- * for a resumable upload.
+ * Gets the size (in bytes) of the file being uploaded. This will be <code class="literal">-1</code> for a non-resumable upload or a resumable
+ * upload whose length isn't known in advance, and zero or greater for other resumable uploads.
  *
  * Return value: the size of the file being uploaded
  *
@@ -1582,6 +2524,23 @@ gdata_upload_stream_get_content_length (GDataUploadStream *self)
 	return self->priv->content_length;
 }
 
+/**
+ * gdata_upload_stream_get_resumable:
+ * @self: a #GDataUploadStream
+ *
+ * Gets the #GDataUploadStream:resumable property.
+ *
+ * Return value: %TRUE if the upload uses the resumable upload protocol, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_upload_stream_get_resumable (GDataUploadStream *self)
+{
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), FALSE);
+	return self->priv->resumable;
+}
+
 /**
  * gdata_upload_stream_get_cancellable:
  * @self: a #GDataUploadStream
@@ -1599,3 +2558,501 @@ gdata_upload_stream_get_cancellable (GDataUploadStream *self)
 	g_assert (self->priv->cancellable != NULL);
 	return self->priv->cancellable;
 }
+
+/**
+ * gdata_upload_stream_get_chunk_size:
+ * @self: a #GDataUploadStream
+ *
+ * Gets the maximum size of each chunk of a resumable upload. See #GDataUploadStream:chunk-size.
+ *
+ * Return value: the maximum chunk size, in bytes
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_upload_stream_get_chunk_size (GDataUploadStream *self)
+{
+	guint chunk_size;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), 0);
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	chunk_size = self->priv->resumable_chunk_size;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	return chunk_size;
+}
+
+/**
+ * gdata_upload_stream_set_chunk_size:
+ * @self: a #GDataUploadStream
+ * @chunk_size: the new maximum chunk size, in bytes
+ *
+ * Sets the maximum size of each chunk of a resumable upload. @chunk_size must be a non-zero multiple of 256 KiB. This may be called at any time
+ * (including from another thread while the upload is in progress), and will take effect from the next chunk to be sent.
+ *
+ * See #GDataUploadStream:chunk-size for more details.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_stream_set_chunk_size (GDataUploadStream *self, guint chunk_size)
+{
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (self));
+	g_return_if_fail (chunk_size > 0 && chunk_size % RESUMABLE_CHUNK_SIZE_GRANULARITY == 0);
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	self->priv->resumable_chunk_size = chunk_size;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	g_object_notify (G_OBJECT (self), "chunk-size");
+}
+
+/**
+ * gdata_upload_stream_get_adaptive_chunk_size:
+ * @self: a #GDataUploadStream
+ *
+ * Gets the #GDataUploadStream:adaptive-chunk-size property.
+ *
+ * Return value: %TRUE if the chunk size of a resumable upload is adjusted automatically, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_upload_stream_get_adaptive_chunk_size (GDataUploadStream *self)
+{
+	gboolean adaptive_chunk_size;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), FALSE);
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	adaptive_chunk_size = self->priv->adaptive_chunk_size;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	return adaptive_chunk_size;
+}
+
+/**
+ * gdata_upload_stream_set_adaptive_chunk_size:
+ * @self: a #GDataUploadStream
+ * @adaptive_chunk_size: %TRUE to adjust the chunk size automatically, %FALSE otherwise
+ *
+ * Sets the #GDataUploadStream:adaptive-chunk-size property. This may be called at any time, and will take effect once the next chunk has been
+ * acknowledged by the server.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_stream_set_adaptive_chunk_size (GDataUploadStream *self, gboolean adaptive_chunk_size)
+{
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (self));
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	self->priv->adaptive_chunk_size = adaptive_chunk_size;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	g_object_notify (G_OBJECT (self), "adaptive-chunk-size");
+}
+
+/**
+ * gdata_upload_stream_get_min_chunk_size:
+ * @self: a #GDataUploadStream
+ *
+ * Gets the #GDataUploadStream:min-chunk-size property.
+ *
+ * Return value: the smallest chunk size which will be chosen adaptively, in bytes
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_upload_stream_get_min_chunk_size (GDataUploadStream *self)
+{
+	guint min_chunk_size;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), 0);
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	min_chunk_size = self->priv->min_chunk_size;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	return min_chunk_size;
+}
+
+/**
+ * gdata_upload_stream_set_min_chunk_size:
+ * @self: a #GDataUploadStream
+ * @min_chunk_size: the smallest chunk size to choose adaptively, in bytes
+ *
+ * Sets the #GDataUploadStream:min-chunk-size property. @min_chunk_size must be a non-zero multiple of 256 KiB. If it is greater than
+ * #GDataUploadStream:max-chunk-size, the latter takes precedence.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_stream_set_min_chunk_size (GDataUploadStream *self, guint min_chunk_size)
+{
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (self));
+	g_return_if_fail (min_chunk_size > 0 && min_chunk_size % RESUMABLE_CHUNK_SIZE_GRANULARITY == 0);
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	self->priv->min_chunk_size = min_chunk_size;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	g_object_notify (G_OBJECT (self), "min-chunk-size");
+}
+
+/**
+ * gdata_upload_stream_get_max_chunk_size:
+ * @self: a #GDataUploadStream
+ *
+ * Gets the #GDataUploadStream:max-chunk-size property.
+ *
+ * Return value: the largest chunk size which will be chosen adaptively, in bytes
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_upload_stream_get_max_chunk_size (GDataUploadStream *self)
+{
+	guint max_chunk_size;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), 0);
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	max_chunk_size = self->priv->max_chunk_size;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	return max_chunk_size;
+}
+
+/**
+ * gdata_upload_stream_set_max_chunk_size:
+ * @self: a #GDataUploadStream
+ * @max_chunk_size: the largest chunk size to choose adaptively, in bytes
+ *
+ * Sets the #GDataUploadStream:max-chunk-size property. @max_chunk_size must be a non-zero multiple of 256 KiB.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_stream_set_max_chunk_size (GDataUploadStream *self, guint max_chunk_size)
+{
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (self));
+	g_return_if_fail (max_chunk_size > 0 && max_chunk_size % RESUMABLE_CHUNK_SIZE_GRANULARITY == 0);
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	self->priv->max_chunk_size = max_chunk_size;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	g_object_notify (G_OBJECT (self), "max-chunk-size");
+}
+
+/**
+ * gdata_upload_stream_get_bandwidth_limit:
+ * @self: a #GDataUploadStream
+ *
+ * Gets the #GDataUploadStream:bandwidth-limit property.
+ *
+ * Return value: the maximum rate at which this stream may upload data, in bytes per second, or <code class="literal">0</code> if there's no limit
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_upload_stream_get_bandwidth_limit (GDataUploadStream *self)
+{
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), 0);
+	return gdata_bandwidth_limiter_get_rate (self->priv->bandwidth_limiter);
+}
+
+/**
+ * gdata_upload_stream_set_bandwidth_limit:
+ * @self: a #GDataUploadStream
+ * @bytes_per_second: the maximum rate at which this stream may upload data, in bytes per second, or <code class="literal">0</code> for no limit
+ *
+ * Sets the #GDataUploadStream:bandwidth-limit property. This may be called at any time, including from another thread while the upload is in
+ * progress.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_stream_set_bandwidth_limit (GDataUploadStream *self, guint bytes_per_second)
+{
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (self));
+	g_return_if_fail (bytes_per_second <= G_MAXINT);
+
+	gdata_bandwidth_limiter_set_rate (self->priv->bandwidth_limiter, bytes_per_second);
+	g_object_notify (G_OBJECT (self), "bandwidth-limit");
+}
+
+/**
+ * gdata_upload_stream_get_write_behind_size:
+ * @self: a #GDataUploadStream
+ *
+ * Gets the #GDataUploadStream:write-behind-size property.
+ *
+ * Return value: the number of bytes a write may leave waiting to be sent, or <code class="literal">0</code> if writes wait for their data to be sent
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_upload_stream_get_write_behind_size (GDataUploadStream *self)
+{
+	guint write_behind_size;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), 0);
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	write_behind_size = self->priv->write_behind_size;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	return write_behind_size;
+}
+
+/**
+ * gdata_upload_stream_set_write_behind_size:
+ * @self: a #GDataUploadStream
+ * @write_behind_size: the number of bytes a write may leave waiting to be sent, or <code class="literal">0</code>
+ *
+ * Sets the #GDataUploadStream:write-behind-size property. This may be called at any time, including from another thread while the upload is in
+ * progress.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_stream_set_write_behind_size (GDataUploadStream *self, guint write_behind_size)
+{
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (self));
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	self->priv->write_behind_size = write_behind_size;
+	/* Wake any write which is waiting, in case the window's grown */
+	g_cond_broadcast (&(self->priv->write_cond));
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	g_object_notify (G_OBJECT (self), "write-behind-size");
+}
+
+/**
+ * gdata_upload_stream_get_committed_length:
+ * @self: a #GDataUploadStream
+ *
+ * Gets the number of bytes of the file which the server has acknowledged receiving in a resumable upload. This is updated as each chunk of the
+ * upload is acknowledged, and for a stream returned by gdata_upload_stream_new_from_session(), it is the offset in the file from which writing
+ * should continue.
+ *
+ * For non-resumable uploads, this is always <code class="literal">0</code>.
+ *
+ * Return value: the number of bytes committed by the server
+ *
+ * Since: 0.15.0
+ */
+goffset
+gdata_upload_stream_get_committed_length (GDataUploadStream *self)
+{
+	goffset committed_length;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), 0);
+
+	g_mutex_lock (&(self->priv->write_mutex));
+	committed_length = self->priv->committed_length;
+	g_mutex_unlock (&(self->priv->write_mutex));
+
+	return committed_length;
+}
+
+/**
+ * gdata_upload_stream_save_session:
+ * @self: a #GDataUploadStream
+ *
+ * Serialises the state of a resumable upload, so that it can be continued later with gdata_upload_stream_new_from_session() if the upload is
+ * interrupted (for example, if the process crashes). The session includes the URI the server allocated for the upload, the content length and type,
+ * and the number of bytes committed so far. The format of the returned string is private, but it is plain text and contains no newline characters
+ * other than line separators.
+ *
+ * It is safe to call this from any thread at any time, including from a handler for #GDataUploadStream::chunk-sent, which is a convenient point
+ * to persist the session. The session URI isn't known until the server has responded to the initial request of the upload, so %NULL is returned
+ * before that point, and for non-resumable uploads.
+ *
+ * The session is only meaningful for uploads of the content of a file; any metadata entry passed to gdata_upload_stream_new_resumable() is sent
+ * in the initial request, so is not part of the session.
+ *
+ * Return value: (transfer full) (allow-none): the serialised upload session, or %NULL; free with g_free()
+ *
+ * Since: 0.15.0
+ */
+gchar *
+gdata_upload_stream_save_session (GDataUploadStream *self)
+{
+	GDataUploadStreamPrivate *priv;
+	gchar *session = NULL, *slug;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), NULL);
+
+	priv = self->priv;
+	slug = g_strescape ((priv->slug != NULL) ? priv->slug : "", NULL);
+
+	g_mutex_lock (&(priv->write_mutex));
+
+	if (priv->session_uri != NULL) {
+		session = g_strdup_printf (SESSION_HEADER "\n%" G_GOFFSET_FORMAT " %" G_GOFFSET_FORMAT "\n%s\n%s\n%s\n",
+		                           priv->content_length, priv->committed_length, priv->content_type, slug, priv->session_uri);
+	}
+
+	g_mutex_unlock (&(priv->write_mutex));
+
+	g_free (slug);
+
+	return session;
+}
+
+/**
+ * gdata_upload_stream_set_checksum_type:
+ * @self: a #GDataUploadStream
+ * @checksum_type: the type of digest to compute
+ *
+ * Requests that a digest of type @checksum_type (such as %G_CHECKSUM_MD5 or %G_CHECKSUM_SHA1) be computed over the data written to the stream, as it
+ * is written. Once the stream has been closed, the digest can be retrieved with gdata_upload_stream_get_checksum(). This allows a file to be
+ * checksummed (for example, to set #GDataPicasaWebFile:checksum) as it is uploaded, rather than having to read it twice.
+ *
+ * This must be called before any data is written to the stream. The digest only covers the data written to the stream, not any entry metadata sent
+ * with it; so for a stream returned by gdata_upload_stream_new_from_session(), it only covers the data written after the upload was resumed.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_stream_set_checksum_type (GDataUploadStream *self, GChecksumType checksum_type)
+{
+	GDataUploadStreamPrivate *priv;
+
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (self));
+
+	priv = self->priv;
+	g_return_if_fail (priv->network_thread == NULL && priv->checksum_string == NULL);
+
+	if (priv->checksum != NULL)
+		g_checksum_free (priv->checksum);
+	priv->checksum = g_checksum_new (checksum_type);
+}
+
+/**
+ * gdata_upload_stream_get_checksum:
+ * @self: a #GDataUploadStream
+ *
+ * Gets the hexadecimal digest of the data written to the stream, as requested with gdata_upload_stream_set_checksum_type(). For streams returned by
+ * gdata_upload_stream_new_resumable_from_file(), the digest is of the whole file.
+ *
+ * The digest is only available once the stream has been closed; %NULL is returned before then, or if no digest was requested.
+ *
+ * Return value: (allow-none): the digest of the uploaded data, or %NULL
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+gdata_upload_stream_get_checksum (GDataUploadStream *self)
+{
+	GDataUploadStreamPrivate *priv;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), NULL);
+
+	priv = self->priv;
+
+	if (priv->checksum == NULL || g_output_stream_is_closed (G_OUTPUT_STREAM (self)) == FALSE)
+		return NULL;
+
+	if (priv->checksum_string == NULL) {
+		/* A mapped file is uploaded without passing through gdata_upload_stream_write(), but its pages will be in memory already */
+		if (priv->mapped_file != NULL) {
+			g_checksum_update (priv->checksum, (const guchar*) g_mapped_file_get_contents (priv->mapped_file),
+			                   g_mapped_file_get_length (priv->mapped_file));
+		}
+
+		priv->checksum_string = g_strdup (g_checksum_get_string (priv->checksum));
+	}
+
+	return priv->checksum_string;
+}
+
+/**
+ * gdata_upload_stream_set_header_func:
+ * @self: a #GDataUploadStream
+ * @header_length: the number of bytes from the start of the file to pass to @header_func
+ * @header_func: (scope notified): a function to call with the start of the file
+ * @user_data: (closure): data to pass to @header_func
+ * @destroy_user_data: (allow-none): a function to free @user_data once @header_func has been called, or %NULL
+ *
+ * Sets a function to be called with the first @header_length bytes written to the stream, before the #GDataUploadStream:entry has been sent to
+ * the server. The function can modify the entry based on the file's own headers; for example, to fill in a photo's metadata from its EXIF data
+ * without having to read the file twice (see gdata_picasaweb_service_parse_exif_on_upload()).
+ *
+ * Data written to the stream is held back in memory (and nothing is sent to the server) until @header_length bytes have been written, or the
+ * stream has been closed, at which point @header_func is called with the data written so far and the upload proceeds as normal. So
+ * @header_length should be kept small, but big enough to cover the headers being examined. It is called in the thread which made the write
+ * or close call which supplied the final bytes of the header.
+ *
+ * This must be called before any data is written to the stream, and can't be used with a stream returned by
+ * gdata_upload_stream_new_resumable_from_file() or gdata_upload_stream_new_from_session().
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_upload_stream_set_header_func (GDataUploadStream *self, gsize header_length, GDataUploadStreamHeaderFunc header_func, gpointer user_data,
+                                     GDestroyNotify destroy_user_data)
+{
+	GDataUploadStreamPrivate *priv;
+
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (self));
+	g_return_if_fail (header_length > 0);
+	g_return_if_fail (header_func != NULL);
+
+	priv = self->priv;
+
+	g_return_if_fail (priv->network_thread == NULL && priv->header_func == NULL);
+	g_return_if_fail (priv->mapped_file == NULL && priv->state != STATE_DATA_REQUESTS && priv->state != STATE_FINISHED);
+
+	if (priv->header_func_data_destroy != NULL)
+		priv->header_func_data_destroy (priv->header_func_data);
+
+	priv->header_func = header_func;
+	priv->header_func_data = user_data;
+	priv->header_func_data_destroy = destroy_user_data;
+	priv->header_length = header_length;
+	priv->header = g_byte_array_sized_new (header_length);
+
+	/* Hold back the entry until the header function's had a chance to modify it; see run_header_func(). The network thread hasn't been created,
+	 * so we're the sole thread accessing the SoupMessage. */
+	if (priv->entry != NULL) {
+		soup_message_body_truncate (priv->message->request_body);
+		priv->network_bytes_outstanding = 0;
+	}
+}
+
+/* Sets the If-Match header of the upload request, for uploads which update an existing resource without an entry to take the ETag from. This must be
+ * called before the first write to the stream, while the network thread isn't running. */
+void
+_gdata_upload_stream_set_if_match (GDataUploadStream *self, const gchar *etag)
+{
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (self));
+	g_return_if_fail (etag != NULL);
+	g_return_if_fail (self->priv->network_thread == NULL);
+
+	soup_message_headers_replace (self->priv->message->request_headers, "If-Match", etag);
+}
+
+/* Returns a copy of the ETag header of the server's response to a successful upload, or %NULL if the upload failed, hasn't finished or the response
+ * has no ETag. As with gdata_upload_stream_get_response(), the response is only guaranteed to be available once the stream's been closed. */
+gchar *
+_gdata_upload_stream_dup_response_etag (GDataUploadStream *self)
+{
+	gchar *etag = NULL;
+
+	g_return_val_if_fail (GDATA_IS_UPLOAD_STREAM (self), NULL);
+
+	g_mutex_lock (&(self->priv->response_mutex));
+
+	if (self->priv->response_status != SOUP_STATUS_NONE && SOUP_STATUS_IS_SUCCESSFUL (self->priv->response_status) == TRUE)
+		etag = g_strdup (soup_message_headers_get_one (self->priv->message->response_headers, "ETag"));
+
+	g_mutex_unlock (&(self->priv->response_mutex));
+
+	return etag;
+}
@@ -88,6 +88,23 @@ typedef struct {
 	GOutputStreamClass parent;
 } GDataUploadStreamClass;
 
+/**
+ * GDataUploadStreamHeaderFunc:
+ * @self: the #GDataUploadStream
+ * @entry: (allow-none): the #GDataUploadStream:entry being uploaded with the file, or %NULL
+ * @header: (array length=length): the first bytes of the file
+ * @length: the length of @header, in bytes
+ * @user_data: user data passed to gdata_upload_stream_set_header_func()
+ *
+ * Called with the start of the file being uploaded through a #GDataUploadStream, before @entry has been sent to the server, so that @entry can
+ * be updated from the file's own metadata. See gdata_upload_stream_set_header_func().
+ *
+ * @length may be less than the length requested if the stream was closed before that many bytes were written.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataUploadStreamHeaderFunc) (GDataUploadStream *self, GDataEntry *entry, const guint8 *header, gsize length, gpointer user_data);
+
 GType gdata_upload_stream_get_type (void) G_GNUC_CONST;
 
 GOutputStream *gdata_upload_stream_new (GDataService *service, GDataAuthorizationDomain *domain, const gchar *method, const gchar *upload_uri,
@@ -96,6 +113,11 @@ GOutputStream *gdata_upload_stream_new (GDataService *service, GDataAuthorizatio
 GOutputStream *gdata_upload_stream_new_resumable (GDataService *service, GDataAuthorizationDomain *domain, const gchar *method, const gchar *upload_uri,
                                                   GDataEntry *entry, const gchar *slug, const gchar *content_type, goffset content_length,
                                                   GCancellable *cancellable) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GOutputStream *gdata_upload_stream_new_resumable_from_file (GDataService *service, GDataAuthorizationDomain *domain, const gchar *method,
+                                                            const gchar *upload_uri, GDataEntry *entry, const gchar *slug, const gchar *content_type,
+                                                            GFile *file, GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GOutputStream *gdata_upload_stream_new_from_session (GDataService *service, GDataAuthorizationDomain *domain, const gchar *session,
+                                                     GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
 const gchar *gdata_upload_stream_get_response (GDataUploadStream *self, gssize *length);
 
@@ -107,8 +129,33 @@ GDataEntry *gdata_upload_stream_get_entry (GDataUploadStream *self) G_GNUC_PURE;
 const gchar *gdata_upload_stream_get_slug (GDataUploadStream *self) G_GNUC_PURE;
 const gchar *gdata_upload_stream_get_content_type (GDataUploadStream *self) G_GNUC_PURE;
 goffset gdata_upload_stream_get_content_length (GDataUploadStream *self) G_GNUC_PURE;
+gboolean gdata_upload_stream_get_resumable (GDataUploadStream *self) G_GNUC_PURE;
 GCancellable *gdata_upload_stream_get_cancellable (GDataUploadStream *self) G_GNUC_PURE;
 
+guint gdata_upload_stream_get_chunk_size (GDataUploadStream *self);
+void gdata_upload_stream_set_chunk_size (GDataUploadStream *self, guint chunk_size);
+gboolean gdata_upload_stream_get_adaptive_chunk_size (GDataUploadStream *self);
+void gdata_upload_stream_set_adaptive_chunk_size (GDataUploadStream *self, gboolean adaptive_chunk_size);
+guint gdata_upload_stream_get_min_chunk_size (GDataUploadStream *self);
+void gdata_upload_stream_set_min_chunk_size (GDataUploadStream *self, guint min_chunk_size);
+guint gdata_upload_stream_get_max_chunk_size (GDataUploadStream *self);
+void gdata_upload_stream_set_max_chunk_size (GDataUploadStream *self, guint max_chunk_size);
+
+guint gdata_upload_stream_get_bandwidth_limit (GDataUploadStream *self);
+void gdata_upload_stream_set_bandwidth_limit (GDataUploadStream *self, guint bytes_per_second);
+
+guint gdata_upload_stream_get_write_behind_size (GDataUploadStream *self);
+void gdata_upload_stream_set_write_behind_size (GDataUploadStream *self, guint write_behind_size);
+
+goffset gdata_upload_stream_get_committed_length (GDataUploadStream *self);
+gchar *gdata_upload_stream_save_session (GDataUploadStream *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+void gdata_upload_stream_set_checksum_type (GDataUploadStream *self, GChecksumType checksum_type);
+const gchar *gdata_upload_stream_get_checksum (GDataUploadStream *self);
+
+void gdata_upload_stream_set_header_func (GDataUploadStream *self, gsize header_length, GDataUploadStreamHeaderFunc header_func, gpointer user_data,
+                                          GDestroyNotify destroy_user_data);
+
 G_END_DECLS
 
 #endif /* !GDATA_UPLOAD_STREAM_H */
@@ -0,0 +1,1149 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-watch-channel
+ * @short_description: GData push notification channel
+ * @stability: Unstable
+ * @include: gdata/gdata-watch-channel.h
+ *
+ * #GDataWatchChannel subscribes to push notifications of changes to a resource (such as the events in a calendar), so that changes can be
+ * synchronised as soon as they happen, rather than by polling the resource's feed. The server notifies changes by making an HTTPS request to
+ * the #GDataWatchChannel:address the channel was created with, which the application must handle itself (for example, with a #SoupServer), and
+ * pass to gdata_watch_channel_handle_notification(). That checks the request came from the channel, drops repeated notifications, and emits
+ * #GDataWatchChannel::notification for changes, which is where an incremental synchronisation of the changed resource should be started.
+ *
+ * A channel is created on the server by gdata_watch_channel_start(), which is given the channel's time to live. Channels can't be extended on the
+ * server, so to renew a channel before it expires, gdata_watch_channel_start() is called again: it starts a replacement channel, and only then
+ * stops the old one, so that no notifications are missed in between. gdata_watch_channel_stop() stops the channel once notifications are no longer
+ * needed.
+ *
+ * Notifications can be lost, and channels can stop without warning, so polling isn't made entirely redundant: applications should still
+ * synchronise occasionally (say, whenever a channel is renewed), but much less often than they would without push notifications.
+ *
+ * <example>
+ *	<title>Synchronising a Calendar on Push Notifications</title>
+ *	<programlisting>
+ *	static void
+ *	notification_cb (GDataWatchChannel *channel, GDataWatchNotification notification, GDataCalendarCalendar *calendar)
+ *	{
+ *		/<!-- -->* The calendar's events have changed, so fetch the changes *<!-- -->/
+ *		gdata_calendar_sync_run_async (sync, calendar, NULL, (GAsyncReadyCallback) sync_cb, NULL);
+ *	}
+ *
+ *	channel = gdata_watch_channel_new (GDATA_SERVICE (service), gdata_calendar_service_get_primary_authorization_domain (),
+ *	                                   watch_uri, stop_uri, "https://example.com/notifications");
+ *	g_signal_connect (channel, "notification", (GCallback) notification_cb, calendar);
+ *
+ *	if (gdata_watch_channel_start (channel, 24 * 60 * 60, NULL, &error) == FALSE) {
+ *		/<!-- -->* Fall back to polling *<!-- -->/
+ *	}
+ *
+ *	/<!-- -->* Later, in the handler for requests to https://example.com/notifications *<!-- -->/
+ *	gdata_watch_channel_handle_notification (channel, msg->request_headers);
+ *	soup_message_set_status (msg, SOUP_STATUS_OK);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <json-glib/json-glib.h>
+
+#include "gdata-watch-channel.h"
+#include "gdata-private.h"
+#include "gdata-enums.h"
+
+/* Length of the random hex string used as each channel's ID */
+#define CHANNEL_ID_LENGTH 32
+
+/* A channel on the server */
+typedef struct {
+	gchar *id;
+	gchar *resource_id; /* %NULL until the server's confirmed the channel */
+	gchar *token; /* the token the channel was started with, or %NULL */
+	gint64 expiration; /* UNIX timestamp in milliseconds, or -1 */
+	guint64 last_message_number; /* number of the last notification handled, or 0 */
+} Channel;
+
+static void gdata_watch_channel_dispose (GObject *object);
+static void gdata_watch_channel_finalize (GObject *object);
+static void gdata_watch_channel_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_watch_channel_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataWatchChannelPrivate {
+	GDataService *service;
+	GDataAuthorizationDomain *domain;
+	gchar *watch_uri;
+	gchar *stop_uri;
+	gchar *address;
+
+	GMutex mutex; /* protects all the members below */
+	gchar *token;
+	Channel *channel; /* the active channel, or %NULL */
+	Channel *pending_channel; /* a channel being started, or %NULL; its notifications can arrive before the server's confirmed it */
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_AUTHORIZATION_DOMAIN,
+	PROP_WATCH_URI,
+	PROP_STOP_URI,
+	PROP_ADDRESS,
+	PROP_TOKEN,
+	PROP_EXPIRATION,
+};
+
+enum {
+	SIGNAL_NOTIFICATION,
+	LAST_SIGNAL
+};
+
+static guint watch_channel_signals[LAST_SIGNAL] = { 0, };
+
+G_DEFINE_TYPE (GDataWatchChannel, gdata_watch_channel, G_TYPE_OBJECT)
+
+static void
+gdata_watch_channel_class_init (GDataWatchChannelClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataWatchChannelPrivate));
+
+	gobject_class->dispose = gdata_watch_channel_dispose;
+	gobject_class->finalize = gdata_watch_channel_finalize;
+	gobject_class->get_property = gdata_watch_channel_get_property;
+	gobject_class->set_property = gdata_watch_channel_set_property;
+
+	/**
+	 * GDataWatchChannel:service:
+	 *
+	 * The service the channel's requests are made with.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service the channel's requests are made with.",
+	                                                      GDATA_TYPE_SERVICE,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWatchChannel:authorization-domain:
+	 *
+	 * The authorization domain the channel's requests are made under, or %NULL if they don't need authorization.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_AUTHORIZATION_DOMAIN,
+	                                 g_param_spec_object ("authorization-domain",
+	                                                      "Authorization domain", "The authorization domain the channel's requests are made under.",
+	                                                      GDATA_TYPE_AUTHORIZATION_DOMAIN,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWatchChannel:watch-uri:
+	 *
+	 * The URI which channels are started by posting to. This is specific to the watched resource; for example, for the events in a calendar it
+	 * would be <literal>https://www.googleapis.com/calendar/v3/calendars/<replaceable>calendar ID</replaceable>/events/watch</literal>.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_WATCH_URI,
+	                                 g_param_spec_string ("watch-uri",
+	                                                      "Watch URI", "The URI which channels are started by posting to.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWatchChannel:stop-uri:
+	 *
+	 * The URI which channels are stopped by posting to. This is specific to the API, rather than to the watched resource; for example, for
+	 * calendars it would be <literal>https://www.googleapis.com/calendar/v3/channels/stop</literal>.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_STOP_URI,
+	                                 g_param_spec_string ("stop-uri",
+	                                                      "Stop URI", "The URI which channels are stopped by posting to.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWatchChannel:address:
+	 *
+	 * The HTTPS URI the server sends notifications to. Requests to it should be passed to gdata_watch_channel_handle_notification().
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_ADDRESS,
+	                                 g_param_spec_string ("address",
+	                                                      "Address", "The HTTPS URI the server sends notifications to.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWatchChannel:token:
+	 *
+	 * An arbitrary string sent to the server when the channel is started, which the server includes in every notification from the channel.
+	 * If it's set, gdata_watch_channel_handle_notification() ignores notifications which don't include it, so it can be used to check that
+	 * notifications are genuine. Changes only take effect when the channel is next started.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_TOKEN,
+	                                 g_param_spec_string ("token",
+	                                                      "Token", "An arbitrary string included in every notification from the channel.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWatchChannel:expiration:
+	 *
+	 * The time at which the server will stop the channel, as a UNIX timestamp in milliseconds; or <code class="literal">-1</code> if the
+	 * channel isn't active, or the server didn't say when it will expire. The channel should be renewed with gdata_watch_channel_start()
+	 * before then.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_EXPIRATION,
+	                                 g_param_spec_int64 ("expiration",
+	                                                     "Expiration", "The time at which the server will stop the channel.",
+	                                                     -1, G_MAXINT64, -1,
+	                                                     G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWatchChannel::notification:
+	 * @self: the #GDataWatchChannel which received the notification
+	 * @notification: the kind of notification; either %GDATA_WATCH_NOTIFICATION_CHANGED or %GDATA_WATCH_NOTIFICATION_REMOVED
+	 *
+	 * Emitted by gdata_watch_channel_handle_notification(), in the thread which called it, when a notification of a change to the watched
+	 * resource is received. Handlers should start an incremental synchronisation of the resource, and should return quickly, since the
+	 * server expects the notification request to be responded to promptly.
+	 *
+	 * Since: 0.15.0
+	 **/
+	watch_channel_signals[SIGNAL_NOTIFICATION] = g_signal_new ("notification",
+	                                                           G_TYPE_FROM_CLASS (klass),
+	                                                           G_SIGNAL_RUN_LAST,
+	                                                           0, NULL, NULL,
+	                                                           g_cclosure_marshal_VOID__ENUM,
+	                                                           G_TYPE_NONE, 1, GDATA_TYPE_WATCH_NOTIFICATION);
+}
+
+static void
+gdata_watch_channel_init (GDataWatchChannel *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_WATCH_CHANNEL, GDataWatchChannelPrivate);
+	g_mutex_init (&(self->priv->mutex));
+}
+
+static void
+channel_free (Channel *channel)
+{
+	g_free (channel->id);
+	g_free (channel->resource_id);
+	g_free (channel->token);
+	g_slice_free (Channel, channel);
+}
+
+static void
+gdata_watch_channel_dispose (GObject *object)
+{
+	GDataWatchChannelPrivate *priv = GDATA_WATCH_CHANNEL (object)->priv;
+
+	g_clear_object (&(priv->domain));
+	g_clear_object (&(priv->service));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_watch_channel_parent_class)->dispose (object);
+}
+
+static void
+gdata_watch_channel_finalize (GObject *object)
+{
+	GDataWatchChannelPrivate *priv = GDATA_WATCH_CHANNEL (object)->priv;
+
+	g_free (priv->watch_uri);
+	g_free (priv->stop_uri);
+	g_free (priv->address);
+	g_free (priv->token);
+
+	if (priv->channel != NULL)
+		channel_free (priv->channel);
+	if (priv->pending_channel != NULL)
+		channel_free (priv->pending_channel);
+
+	g_mutex_clear (&(priv->mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_watch_channel_parent_class)->finalize (object);
+}
+
+static void
+gdata_watch_channel_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataWatchChannel *self = GDATA_WATCH_CHANNEL (object);
+	GDataWatchChannelPrivate *priv = self->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_AUTHORIZATION_DOMAIN:
+			g_value_set_object (value, priv->domain);
+			break;
+		case PROP_WATCH_URI:
+			g_value_set_string (value, priv->watch_uri);
+			break;
+		case PROP_STOP_URI:
+			g_value_set_string (value, priv->stop_uri);
+			break;
+		case PROP_ADDRESS:
+			g_value_set_string (value, priv->address);
+			break;
+		case PROP_TOKEN:
+			g_mutex_lock (&(priv->mutex));
+			g_value_set_string (value, priv->token);
+			g_mutex_unlock (&(priv->mutex));
+			break;
+		case PROP_EXPIRATION:
+			g_value_set_int64 (value, gdata_watch_channel_get_expiration (self));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_watch_channel_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataWatchChannel *self = GDATA_WATCH_CHANNEL (object);
+	GDataWatchChannelPrivate *priv = self->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_AUTHORIZATION_DOMAIN:
+			priv->domain = g_value_dup_object (value);
+			break;
+		case PROP_WATCH_URI:
+			priv->watch_uri = g_value_dup_string (value);
+			break;
+		case PROP_STOP_URI:
+			priv->stop_uri = g_value_dup_string (value);
+			break;
+		case PROP_ADDRESS:
+			priv->address = g_value_dup_string (value);
+			break;
+		case PROP_TOKEN:
+			gdata_watch_channel_set_token (self, g_value_get_string (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_watch_channel_new:
+ * @service: the #GDataService to make the channel's requests with
+ * @domain: (allow-none): the #GDataAuthorizationDomain the channel's requests fall under, or %NULL
+ * @watch_uri: the URI which channels are started by posting to
+ * @stop_uri: the URI which channels are stopped by posting to
+ * @address: the HTTPS URI for the server to send notifications to
+ *
+ * Creates a new #GDataWatchChannel for push notifications of changes to the resource watched through @watch_uri. See
+ * #GDataWatchChannel:watch-uri and #GDataWatchChannel:stop-uri for examples of the URIs. No requests are made until gdata_watch_channel_start()
+ * is called.
+ *
+ * Return value: (transfer full): a new #GDataWatchChannel; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataWatchChannel *
+gdata_watch_channel_new (GDataService *service, GDataAuthorizationDomain *domain, const gchar *watch_uri, const gchar *stop_uri,
+                         const gchar *address)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (watch_uri != NULL, NULL);
+	g_return_val_if_fail (stop_uri != NULL, NULL);
+	g_return_val_if_fail (address != NULL, NULL);
+
+	return g_object_new (GDATA_TYPE_WATCH_CHANNEL,
+	                     "service", service,
+	                     "authorization-domain", domain,
+	                     "watch-uri", watch_uri,
+	                     "stop-uri", stop_uri,
+	                     "address", address,
+	                     NULL);
+}
+
+/**
+ * gdata_watch_channel_get_service:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets the #GDataWatchChannel:service property.
+ *
+ * Return value: (transfer none): the service the channel's requests are made with
+ *
+ * Since: 0.15.0
+ **/
+GDataService *
+gdata_watch_channel_get_service (GDataWatchChannel *self)
+{
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_watch_channel_get_authorization_domain:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets the #GDataWatchChannel:authorization-domain property.
+ *
+ * Return value: (transfer none) (allow-none): the authorization domain the channel's requests are made under, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+GDataAuthorizationDomain *
+gdata_watch_channel_get_authorization_domain (GDataWatchChannel *self)
+{
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), NULL);
+	return self->priv->domain;
+}
+
+/**
+ * gdata_watch_channel_get_watch_uri:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets the #GDataWatchChannel:watch-uri property.
+ *
+ * Return value: the URI which channels are started by posting to
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_watch_channel_get_watch_uri (GDataWatchChannel *self)
+{
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), NULL);
+	return self->priv->watch_uri;
+}
+
+/**
+ * gdata_watch_channel_get_stop_uri:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets the #GDataWatchChannel:stop-uri property.
+ *
+ * Return value: the URI which channels are stopped by posting to
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_watch_channel_get_stop_uri (GDataWatchChannel *self)
+{
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), NULL);
+	return self->priv->stop_uri;
+}
+
+/**
+ * gdata_watch_channel_get_address:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets the #GDataWatchChannel:address property.
+ *
+ * Return value: the HTTPS URI the server sends notifications to
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_watch_channel_get_address (GDataWatchChannel *self)
+{
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), NULL);
+	return self->priv->address;
+}
+
+/**
+ * gdata_watch_channel_get_token:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets the #GDataWatchChannel:token property.
+ *
+ * Return value: (allow-none): the channel's token, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_watch_channel_get_token (GDataWatchChannel *self)
+{
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), NULL);
+	return self->priv->token;
+}
+
+/**
+ * gdata_watch_channel_set_token:
+ * @self: a #GDataWatchChannel
+ * @token: (allow-none): the new token, or %NULL
+ *
+ * Sets the #GDataWatchChannel:token property to @token. The new token is used from the next time the channel is started.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_watch_channel_set_token (GDataWatchChannel *self, const gchar *token)
+{
+	g_return_if_fail (GDATA_IS_WATCH_CHANNEL (self));
+
+	g_mutex_lock (&(self->priv->mutex));
+	g_free (self->priv->token);
+	self->priv->token = g_strdup (token);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_object_notify (G_OBJECT (self), "token");
+}
+
+/**
+ * gdata_watch_channel_dup_id:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets the ID of the channel which is currently active on the server. A new ID is generated each time the channel is started.
+ *
+ * Return value: (allow-none) (transfer full): the ID of the active channel, or %NULL if it isn't active; free with g_free()
+ *
+ * Since: 0.15.0
+ **/
+gchar *
+gdata_watch_channel_dup_id (GDataWatchChannel *self)
+{
+	gchar *id;
+
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), NULL);
+
+	g_mutex_lock (&(self->priv->mutex));
+	id = (self->priv->channel != NULL) ? g_strdup (self->priv->channel->id) : NULL;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return id;
+}
+
+/**
+ * gdata_watch_channel_dup_resource_id:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets the server's opaque ID for the resource watched by the active channel.
+ *
+ * Return value: (allow-none) (transfer full): the ID of the watched resource, or %NULL if the channel isn't active; free with g_free()
+ *
+ * Since: 0.15.0
+ **/
+gchar *
+gdata_watch_channel_dup_resource_id (GDataWatchChannel *self)
+{
+	gchar *resource_id;
+
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), NULL);
+
+	g_mutex_lock (&(self->priv->mutex));
+	resource_id = (self->priv->channel != NULL) ? g_strdup (self->priv->channel->resource_id) : NULL;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return resource_id;
+}
+
+/**
+ * gdata_watch_channel_get_expiration:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets the #GDataWatchChannel:expiration property.
+ *
+ * Return value: the time at which the active channel expires, as a UNIX timestamp in milliseconds, or <code class="literal">-1</code>
+ *
+ * Since: 0.15.0
+ **/
+gint64
+gdata_watch_channel_get_expiration (GDataWatchChannel *self)
+{
+	gint64 expiration;
+
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), -1);
+
+	g_mutex_lock (&(self->priv->mutex));
+	expiration = (self->priv->channel != NULL) ? self->priv->channel->expiration : -1;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return expiration;
+}
+
+/**
+ * gdata_watch_channel_is_active:
+ * @self: a #GDataWatchChannel
+ *
+ * Gets whether the channel has been started (and not since stopped). Note that the server may stop the channel of its own accord, which this
+ * doesn't take into account.
+ *
+ * Return value: %TRUE if the channel is active, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_watch_channel_is_active (GDataWatchChannel *self)
+{
+	gboolean active;
+
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), FALSE);
+
+	g_mutex_lock (&(self->priv->mutex));
+	active = (self->priv->channel != NULL) ? TRUE : FALSE;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return active;
+}
+
+/* Posts the JSON @body to @uri, setting an error from the response if it fails. On success, the message is returned in @message_out, if it's
+ * non-%NULL, for the response to be parsed. */
+static gboolean
+send_channel_request (GDataWatchChannel *self, GDataOperationType operation_type, const gchar *uri, JsonNode *body, SoupMessage **message_out,
+                      GCancellable *cancellable, GError **error)
+{
+	GDataWatchChannelPrivate *priv = self->priv;
+	SoupMessage *message;
+	JsonGenerator *generator;
+	gchar *upload_data;
+	gsize upload_length;
+	guint status;
+
+	message = _gdata_service_build_message (priv->service, priv->domain, SOUP_METHOD_POST, uri, NULL, FALSE);
+
+	generator = json_generator_new ();
+	json_generator_set_root (generator, body);
+	upload_data = json_generator_to_data (generator, &upload_length);
+	g_object_unref (generator);
+
+	soup_message_set_request (message, "application/json", SOUP_MEMORY_TAKE, upload_data, upload_length);
+
+	status = _gdata_service_send_message (priv->service, message, cancellable, error);
+
+	if (status == SOUP_STATUS_NONE || status == SOUP_STATUS_CANCELLED) {
+		/* Redirect error or cancelled */
+		g_object_unref (message);
+		return FALSE;
+	} else if (SOUP_STATUS_IS_SUCCESSFUL (status) == FALSE) {
+		GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (priv->service);
+
+		/* Error */
+		g_assert (klass->parse_error_response != NULL);
+		klass->parse_error_response (priv->service, operation_type, status, message->reason_phrase, message->response_body->data,
+		                             message->response_body->length, error);
+		g_object_unref (message);
+		return FALSE;
+	}
+
+	if (message_out != NULL)
+		*message_out = message;
+	else
+		g_object_unref (message);
+
+	return TRUE;
+}
+
+/* Asks the server to stop @channel. It needs to have been confirmed by the server. */
+static gboolean
+stop_channel (GDataWatchChannel *self, Channel *channel, GCancellable *cancellable, GError **error)
+{
+	JsonBuilder *builder;
+	JsonNode *body;
+	gboolean success;
+
+	builder = json_builder_new ();
+	json_builder_begin_object (builder);
+	json_builder_set_member_name (builder, "id");
+	json_builder_add_string_value (builder, channel->id);
+	json_builder_set_member_name (builder, "resourceId");
+	json_builder_add_string_value (builder, channel->resource_id);
+	json_builder_end_object (builder);
+	body = json_builder_get_root (builder);
+	g_object_unref (builder);
+
+	success = send_channel_request (self, GDATA_OPERATION_DELETION, self->priv->stop_uri, body, NULL, cancellable, error);
+	json_node_free (body);
+
+	return success;
+}
+
+/* Parses the server's description of a channel it's just started into @channel */
+static gboolean
+parse_channel_response (SoupMessage *message, Channel *channel, GError **error)
+{
+	JsonParser *parser;
+	JsonObject *object;
+	const gchar *resource_id, *expiration;
+	GError *child_error = NULL;
+
+	parser = json_parser_new ();
+
+	if (json_parser_load_from_data (parser, message->response_body->data, message->response_body->length, &child_error) == FALSE) {
+		g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+		             /* Translators: the parameter is an error message. */
+		             _("Error parsing JSON: %s"), child_error->message);
+		g_error_free (child_error);
+		g_object_unref (parser);
+		return FALSE;
+	}
+
+	if (JSON_NODE_HOLDS_OBJECT (json_parser_get_root (parser)) == FALSE) {
+		g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+		             /* Translators: the parameter is an error message. */
+		             _("Error parsing JSON: %s"), _("Outermost JSON node is not an object."));
+		g_object_unref (parser);
+		return FALSE;
+	}
+
+	object = json_node_get_object (json_parser_get_root (parser));
+
+	resource_id = json_object_has_member (object, "resourceId") ? json_object_get_string_member (object, "resourceId") : NULL;
+	if (resource_id == NULL) {
+		g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+		             /* Translators: the parameter is the name of an JSON element. */
+		             _("A \'%s\' element was missing required content."), "resourceId");
+		g_object_unref (parser);
+		return FALSE;
+	}
+
+	g_free (channel->resource_id);
+	channel->resource_id = g_strdup (resource_id);
+
+	/* The expiration is a string holding a UNIX timestamp in milliseconds, and is optional */
+	expiration = json_object_has_member (object, "expiration") ? json_object_get_string_member (object, "expiration") : NULL;
+	channel->expiration = (expiration != NULL) ? g_ascii_strtoll (expiration, NULL, 10) : -1;
+
+	g_object_unref (parser);
+
+	return TRUE;
+}
+
+static gchar *
+generate_channel_id (void)
+{
+	GString *id;
+	guint i;
+
+	id = g_string_sized_new (CHANNEL_ID_LENGTH);
+
+	for (i = 0; i < CHANNEL_ID_LENGTH; i++)
+		g_string_append_c (id, "0123456789abcdef"[g_random_int_range (0, 16)]);
+
+	return g_string_free (id, FALSE);
+}
+
+/**
+ * gdata_watch_channel_start:
+ * @self: a #GDataWatchChannel
+ * @ttl: the requested lifetime of the channel, in seconds, or <code class="literal">0</code> for the server's default
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Starts a new channel on the server, so that it sends notifications of changes to the watched resource to #GDataWatchChannel:address. The server
+ * may give the channel a shorter lifetime than @ttl; #GDataWatchChannel:expiration gives the actual time it will expire.
+ *
+ * If the channel is already active, this renews it: the replacement channel is started first, and the old channel is only stopped once the
+ * replacement's been confirmed, so no notifications are missed. Failing to stop the old channel isn't treated as an error, since it will expire
+ * of its own accord. If starting the replacement fails, the old channel is left active.
+ *
+ * The server sends a %GDATA_WATCH_NOTIFICATION_SYNC notification to #GDataWatchChannel:address as soon as the channel's started, which may
+ * arrive before this function returns. It's handled correctly by gdata_watch_channel_handle_notification() regardless.
+ *
+ * This mustn't be called while another call to gdata_watch_channel_start() or gdata_watch_channel_stop() for the channel is in progress.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_watch_channel_start (GDataWatchChannel *self, guint ttl, GCancellable *cancellable, GError **error)
+{
+	GDataWatchChannelPrivate *priv;
+	Channel *channel, *old_channel;
+	JsonBuilder *builder;
+	JsonNode *body;
+	SoupMessage *message = NULL;
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = self->priv;
+
+	channel = g_slice_new0 (Channel);
+	channel->id = generate_channel_id ();
+	channel->expiration = -1;
+
+	builder = json_builder_new ();
+	json_builder_begin_object (builder);
+	json_builder_set_member_name (builder, "id");
+	json_builder_add_string_value (builder, channel->id);
+	json_builder_set_member_name (builder, "type");
+	json_builder_add_string_value (builder, "web_hook");
+	json_builder_set_member_name (builder, "address");
+	json_builder_add_string_value (builder, priv->address);
+
+	/* Accept notifications from the new channel from now on, since the server sends the first one before replying to the request */
+	g_mutex_lock (&(priv->mutex));
+
+	channel->token = g_strdup (priv->token);
+	if (channel->token != NULL) {
+		json_builder_set_member_name (builder, "token");
+		json_builder_add_string_value (builder, channel->token);
+	}
+
+	g_assert (priv->pending_channel == NULL);
+	priv->pending_channel = channel;
+
+	g_mutex_unlock (&(priv->mutex));
+
+	if (ttl > 0) {
+		gchar *ttl_string = g_strdup_printf ("%u", ttl);
+
+		json_builder_set_member_name (builder, "params");
+		json_builder_begin_object (builder);
+		json_builder_set_member_name (builder, "ttl");
+		json_builder_add_string_value (builder, ttl_string);
+		json_builder_end_object (builder);
+
+		g_free (ttl_string);
+	}
+
+	json_builder_end_object (builder);
+	body = json_builder_get_root (builder);
+	g_object_unref (builder);
+
+	success = send_channel_request (self, GDATA_OPERATION_INSERTION, priv->watch_uri, body, &message, cancellable, error);
+	json_node_free (body);
+
+	if (success == TRUE) {
+		success = parse_channel_response (message, channel, error);
+		g_object_unref (message);
+	}
+
+	/* Make the new channel the active one */
+	g_mutex_lock (&(priv->mutex));
+
+	priv->pending_channel = NULL;
+
+	if (success == TRUE) {
+		old_channel = priv->channel;
+		priv->channel = channel;
+	} else {
+		old_channel = NULL;
+		channel_free (channel);
+	}
+
+	g_mutex_unlock (&(priv->mutex));
+
+	if (success == FALSE)
+		return FALSE;
+
+	g_object_notify (G_OBJECT (self), "expiration");
+
+	/* Stop the channel we've just replaced. This isn't cancellable, since it's no longer part of the operation the caller cares about. */
+	if (old_channel != NULL) {
+		stop_channel (self, old_channel, NULL, NULL);
+		channel_free (old_channel);
+	}
+
+	return TRUE;
+}
+
+typedef struct {
+	guint ttl;
+} StartAsyncData;
+
+static void
+start_async_data_free (StartAsyncData *data)
+{
+	g_slice_free (StartAsyncData, data);
+}
+
+static void
+start_thread (GSimpleAsyncResult *result, GDataWatchChannel *self, GCancellable *cancellable)
+{
+	StartAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	if (gdata_watch_channel_start (self, data->ttl, cancellable, &error) == FALSE)
+		g_simple_async_result_take_error (result, error);
+}
+
+/**
+ * gdata_watch_channel_start_async:
+ * @self: a #GDataWatchChannel
+ * @ttl: the requested lifetime of the channel, in seconds, or <code class="literal">0</code> for the server's default
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the channel has been started
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Starts (or renews) the channel on the server. @self is reffed when this function is called, so can safely be unreffed after this function
+ * returns.
+ *
+ * For more details, see gdata_watch_channel_start(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_watch_channel_start_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_watch_channel_start_async (GDataWatchChannel *self, guint ttl, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	StartAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_WATCH_CHANNEL (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new (StartAsyncData);
+	data->ttl = ttl;
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_watch_channel_start_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) start_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) start_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_watch_channel_start_finish:
+ * @self: a #GDataWatchChannel
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous operation to start a channel, as started with gdata_watch_channel_start_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_watch_channel_start_finish (GDataWatchChannel *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (G_SIMPLE_ASYNC_RESULT (async_result)) == gdata_watch_channel_start_async);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == TRUE)
+		return FALSE;
+
+	return TRUE;
+}
+
+/**
+ * gdata_watch_channel_stop:
+ * @self: a #GDataWatchChannel
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Stops the active channel on the server, so that no more notifications are sent. If the channel isn't active, this does nothing and succeeds.
+ *
+ * The channel is treated as stopped even if the request fails, since its ID isn't reused; it can be started again with
+ * gdata_watch_channel_start().
+ *
+ * This mustn't be called while another call to gdata_watch_channel_start() or gdata_watch_channel_stop() for the channel is in progress.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_watch_channel_stop (GDataWatchChannel *self, GCancellable *cancellable, GError **error)
+{
+	Channel *channel;
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_mutex_lock (&(self->priv->mutex));
+	channel = self->priv->channel;
+	self->priv->channel = NULL;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	if (channel == NULL)
+		return TRUE;
+
+	g_object_notify (G_OBJECT (self), "expiration");
+
+	success = stop_channel (self, channel, cancellable, error);
+	channel_free (channel);
+
+	return success;
+}
+
+static void
+stop_thread (GSimpleAsyncResult *result, GDataWatchChannel *self, GCancellable *cancellable)
+{
+	GError *error = NULL;
+
+	if (gdata_watch_channel_stop (self, cancellable, &error) == FALSE)
+		g_simple_async_result_take_error (result, error);
+}
+
+/**
+ * gdata_watch_channel_stop_async:
+ * @self: a #GDataWatchChannel
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the channel has been stopped
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Stops the active channel on the server. @self is reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_watch_channel_stop(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_watch_channel_stop_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_watch_channel_stop_async (GDataWatchChannel *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+
+	g_return_if_fail (GDATA_IS_WATCH_CHANNEL (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_watch_channel_stop_async);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) stop_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_watch_channel_stop_finish:
+ * @self: a #GDataWatchChannel
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous operation to stop a channel, as started with gdata_watch_channel_stop_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_watch_channel_stop_finish (GDataWatchChannel *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (G_SIMPLE_ASYNC_RESULT (async_result)) == gdata_watch_channel_stop_async);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == TRUE)
+		return FALSE;
+
+	return TRUE;
+}
+
+/**
+ * gdata_watch_channel_handle_notification:
+ * @self: a #GDataWatchChannel
+ * @headers: the headers of the notification request sent to #GDataWatchChannel:address
+ *
+ * Handles a notification request sent by the server to #GDataWatchChannel:address. The notification is checked against the active channel (or one
+ * which is being started or renewed) and its #GDataWatchChannel:token, and notifications which have already been handled (the server may resend
+ * them) are ignored. If the notification is of a change to the watched resource, #GDataWatchChannel::notification is emitted.
+ *
+ * Notifications describe only which resource changed, not how, so the body of the request can be ignored. The request should be responded to with
+ * %SOUP_STATUS_OK whatever this returns; otherwise the server will keep retrying it.
+ *
+ * This may be called from any thread.
+ *
+ * Return value: the kind of notification, or %GDATA_WATCH_NOTIFICATION_IGNORED if it should be ignored
+ *
+ * Since: 0.15.0
+ **/
+GDataWatchNotification
+gdata_watch_channel_handle_notification (GDataWatchChannel *self, SoupMessageHeaders *headers)
+{
+	GDataWatchChannelPrivate *priv;
+	const gchar *channel_id, *token, *resource_state, *message_number_string;
+	Channel *channel = NULL;
+	guint64 message_number;
+	GDataWatchNotification notification;
+
+	g_return_val_if_fail (GDATA_IS_WATCH_CHANNEL (self), GDATA_WATCH_NOTIFICATION_IGNORED);
+	g_return_val_if_fail (headers != NULL, GDATA_WATCH_NOTIFICATION_IGNORED);
+
+	priv = self->priv;
+
+	channel_id = soup_message_headers_get_one (headers, "X-Goog-Channel-ID");
+	token = soup_message_headers_get_one (headers, "X-Goog-Channel-Token");
+	resource_state = soup_message_headers_get_one (headers, "X-Goog-Resource-State");
+	message_number_string = soup_message_headers_get_one (headers, "X-Goog-Message-Number");
+
+	if (channel_id == NULL || resource_state == NULL || message_number_string == NULL)
+		return GDATA_WATCH_NOTIFICATION_IGNORED;
+
+	message_number = g_ascii_strtoull (message_number_string, NULL, 10);
+
+	/* Work out what kind of notification it is. Unknown states are treated as changes, so that newer kinds of notification aren't missed. */
+	if (strcmp (resource_state, "sync") == 0) {
+		notification = GDATA_WATCH_NOTIFICATION_SYNC;
+	} else if (strcmp (resource_state, "not_exists") == 0) {
+		notification = GDATA_WATCH_NOTIFICATION_REMOVED;
+	} else {
+		notification = GDATA_WATCH_NOTIFICATION_CHANGED;
+	}
+
+	g_mutex_lock (&(priv->mutex));
+
+	if (priv->channel != NULL && strcmp (priv->channel->id, channel_id) == 0)
+		channel = priv->channel;
+	else if (priv->pending_channel != NULL && strcmp (priv->pending_channel->id, channel_id) == 0)
+		channel = priv->pending_channel;
+
+	/* Ignore notifications for other channels, with the wrong token, or which have already been handled. Message numbers increase with each
+	 * notification on a channel, so anything not newer than the last one is a repeat. */
+	if (channel == NULL || (channel->token != NULL && g_strcmp0 (channel->token, token) != 0) || message_number <= channel->last_message_number) {
+		notification = GDATA_WATCH_NOTIFICATION_IGNORED;
+	} else {
+		channel->last_message_number = message_number;
+	}
+
+	g_mutex_unlock (&(priv->mutex));
+
+	if (notification == GDATA_WATCH_NOTIFICATION_CHANGED || notification == GDATA_WATCH_NOTIFICATION_REMOVED)
+		g_signal_emit (self, watch_channel_signals[SIGNAL_NOTIFICATION], 0, notification);
+
+	return notification;
+}
@@ -0,0 +1,118 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_WATCH_CHANNEL_H
+#define GDATA_WATCH_CHANNEL_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include <gdata/gdata-service.h>
+#include <gdata/gdata-authorization-domain.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDataWatchNotification:
+ * @GDATA_WATCH_NOTIFICATION_IGNORED: the notification wasn't for the channel, or was a repeat of one which has already been handled, so should be
+ * ignored
+ * @GDATA_WATCH_NOTIFICATION_SYNC: the notification was the one sent by the server when the channel was started, and doesn't indicate any change
+ * @GDATA_WATCH_NOTIFICATION_CHANGED: the watched resource (or something in it) has been created or changed
+ * @GDATA_WATCH_NOTIFICATION_REMOVED: the watched resource has been deleted
+ *
+ * The kinds of push notification which gdata_watch_channel_handle_notification() recognises.
+ *
+ * Since: 0.15.0
+ **/
+typedef enum {
+	GDATA_WATCH_NOTIFICATION_IGNORED = 0,
+	GDATA_WATCH_NOTIFICATION_SYNC,
+	GDATA_WATCH_NOTIFICATION_CHANGED,
+	GDATA_WATCH_NOTIFICATION_REMOVED
+} GDataWatchNotification;
+
+#define GDATA_TYPE_WATCH_CHANNEL		(gdata_watch_channel_get_type ())
+#define GDATA_WATCH_CHANNEL(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_WATCH_CHANNEL, GDataWatchChannel))
+#define GDATA_WATCH_CHANNEL_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_WATCH_CHANNEL, GDataWatchChannelClass))
+#define GDATA_IS_WATCH_CHANNEL(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_WATCH_CHANNEL))
+#define GDATA_IS_WATCH_CHANNEL_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_WATCH_CHANNEL))
+#define GDATA_WATCH_CHANNEL_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_WATCH_CHANNEL, GDataWatchChannelClass))
+
+typedef struct _GDataWatchChannelPrivate	GDataWatchChannelPrivate;
+
+/**
+ * GDataWatchChannel:
+ *
+ * All the fields in the #GDataWatchChannel structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataWatchChannelPrivate *priv;
+} GDataWatchChannel;
+
+/**
+ * GDataWatchChannelClass:
+ *
+ * All the fields in the #GDataWatchChannelClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataWatchChannelClass;
+
+GType gdata_watch_channel_get_type (void) G_GNUC_CONST;
+
+GDataWatchChannel *gdata_watch_channel_new (GDataService *service, GDataAuthorizationDomain *domain, const gchar *watch_uri, const gchar *stop_uri,
+                                            const gchar *address) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataService *gdata_watch_channel_get_service (GDataWatchChannel *self) G_GNUC_PURE;
+GDataAuthorizationDomain *gdata_watch_channel_get_authorization_domain (GDataWatchChannel *self) G_GNUC_PURE;
+const gchar *gdata_watch_channel_get_watch_uri (GDataWatchChannel *self) G_GNUC_PURE;
+const gchar *gdata_watch_channel_get_stop_uri (GDataWatchChannel *self) G_GNUC_PURE;
+const gchar *gdata_watch_channel_get_address (GDataWatchChannel *self) G_GNUC_PURE;
+
+const gchar *gdata_watch_channel_get_token (GDataWatchChannel *self) G_GNUC_PURE;
+void gdata_watch_channel_set_token (GDataWatchChannel *self, const gchar *token);
+
+gchar *gdata_watch_channel_dup_id (GDataWatchChannel *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gchar *gdata_watch_channel_dup_resource_id (GDataWatchChannel *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gint64 gdata_watch_channel_get_expiration (GDataWatchChannel *self);
+gboolean gdata_watch_channel_is_active (GDataWatchChannel *self);
+
+gboolean gdata_watch_channel_start (GDataWatchChannel *self, guint ttl, GCancellable *cancellable, GError **error);
+void gdata_watch_channel_start_async (GDataWatchChannel *self, guint ttl, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                      gpointer user_data);
+gboolean gdata_watch_channel_start_finish (GDataWatchChannel *self, GAsyncResult *async_result, GError **error);
+
+gboolean gdata_watch_channel_stop (GDataWatchChannel *self, GCancellable *cancellable, GError **error);
+void gdata_watch_channel_stop_async (GDataWatchChannel *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_watch_channel_stop_finish (GDataWatchChannel *self, GAsyncResult *async_result, GError **error);
+
+GDataWatchNotification gdata_watch_channel_handle_notification (GDataWatchChannel *self, SoupMessageHeaders *headers);
+
+G_END_DECLS
+
+#endif /* !GDATA_WATCH_CHANNEL_H */
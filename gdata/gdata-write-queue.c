@@ -0,0 +1,1210 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-write-queue
+ * @short_description: GData offline write queue
+ * @stability: Unstable
+ * @include: gdata/gdata-write-queue.h
+ *
+ * #GDataWriteQueue records insertions, updates and deletions of entries made while offline, or in quick succession, and sends them to the server
+ * later, all together. Applications which let the user make many small edits can queue each one as it's made, rather than sending a request for
+ * each edit and dealing with the ETag conflicts between them.
+ *
+ * Successive writes to the same entry are coalesced into one as they're queued, so only the latest version of each entry is sent:
+ * <itemizedlist>
+ *	<listitem>an insertion followed by updates is sent as a single insertion of the latest version;</listitem>
+ *	<listitem>an insertion followed by a deletion isn't sent at all;</listitem>
+ *	<listitem>several updates are sent as a single update of the latest version; and</listitem>
+ *	<listitem>updates followed by a deletion are sent as just the deletion.</listitem>
+ * </itemizedlist>
+ * Entries are matched by their IDs, or, for entries which haven't been inserted yet, by the #GDataEntry objects themselves. Once an insertion has
+ * been flushed, later writes should be made to the inserted entry passed to #GDataWriteQueue::write-finished.
+ *
+ * The queue is flushed by gdata_write_queue_flush() or gdata_write_queue_flush_async(), or automatically,
+ * #GDataWriteQueue:flush-delay seconds after the first write is queued while it's #GDataWriteQueue:online. If the queue was created with a
+ * batch feed URI and its service implements #GDataBatchable, the writes are sent as a single #GDataBatchOperation; otherwise each is sent with its
+ * own request. The result of each write is reported by #GDataWriteQueue::write-finished.
+ *
+ * Writes which fail for reasons which might go away (for example, because the network is unavailable, or the flush was cancelled) are put back in
+ * the queue, coalesced with any writes to the same entry queued since, to be sent again by the next flush. Updates and deletions which fail with
+ * %GDATA_SERVICE_ERROR_CONFLICT, because the entry was changed on the server after the local version was retrieved, are passed to the
+ * #GDataWriteQueueConflictResolver set with gdata_write_queue_set_conflict_resolver(), if there is one, along with the server's version of the entry.
+ *
+ * The queue holds a reference to each entry queued. An entry mustn't be modified while it's being flushed, but it may be modified and queued again
+ * between flushes.
+ *
+ * Since: 0.15.0
+ **/
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-write-queue.h"
+#include "gdata-batchable.h"
+#include "gdata-batch-operation.h"
+#include "gdata-marshal.h"
+#include "gdata-enums.h"
+#include "gdata-private.h"
+
+/* A write of an entry waiting to be flushed */
+typedef struct {
+	GDataBatchOperationType type; /* insertion, update or deletion */
+	gchar *key; /* identifies writes of the same entry; see build_write_key() */
+	GDataEntry *entry; /* the latest local version of the entry */
+
+	/* Only valid while the write's being flushed */
+	GDataEntry *result;
+	GError *error;
+} PendingWrite;
+
+static void gdata_write_queue_dispose (GObject *object);
+static void gdata_write_queue_finalize (GObject *object);
+static void gdata_write_queue_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_write_queue_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataWriteQueuePrivate {
+	GDataService *service;
+	GDataAuthorizationDomain *authorization_domain;
+	gchar *upload_uri;
+	gchar *batch_feed_uri;
+	GMainContext *context; /* the thread-default context when the queue was created */
+
+	GMutex flush_mutex; /* held for the whole of each flush, so that flushes happen one at a time */
+
+	GMutex mutex; /* protects all the members below */
+	GQueue *writes; /* PendingWrites, in the order they were first queued */
+	GHashTable *writes_by_key; /* key → PendingWrite in writes */
+	guint flush_delay; /* seconds */
+	gboolean online;
+	GSource *flush_source; /* timeout for the next automatic flush, or NULL */
+	GDataWriteQueueConflictResolver resolver;
+	gpointer resolver_data;
+	GDestroyNotify resolver_data_destroy;
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_AUTHORIZATION_DOMAIN,
+	PROP_UPLOAD_URI,
+	PROP_BATCH_FEED_URI,
+	PROP_FLUSH_DELAY,
+	PROP_ONLINE,
+};
+
+enum {
+	SIGNAL_WRITE_FINISHED,
+	LAST_SIGNAL
+};
+
+static guint write_queue_signals[LAST_SIGNAL] = { 0, };
+
+G_DEFINE_TYPE (GDataWriteQueue, gdata_write_queue, G_TYPE_OBJECT)
+
+static void
+gdata_write_queue_class_init (GDataWriteQueueClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataWriteQueuePrivate));
+
+	gobject_class->dispose = gdata_write_queue_dispose;
+	gobject_class->finalize = gdata_write_queue_finalize;
+	gobject_class->get_property = gdata_write_queue_get_property;
+	gobject_class->set_property = gdata_write_queue_set_property;
+
+	/**
+	 * GDataWriteQueue:service:
+	 *
+	 * The service the writes are sent to.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service the writes are sent to.",
+	                                                      GDATA_TYPE_SERVICE,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWriteQueue:authorization-domain:
+	 *
+	 * The authorization domain the writes are authorized under, or %NULL.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_AUTHORIZATION_DOMAIN,
+	                                 g_param_spec_object ("authorization-domain",
+	                                                      "Authorization domain", "The authorization domain the writes are authorized under.",
+	                                                      GDATA_TYPE_AUTHORIZATION_DOMAIN,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWriteQueue:upload-uri:
+	 *
+	 * The URI which insertions are sent to when they aren't sent in a batch operation.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_UPLOAD_URI,
+	                                 g_param_spec_string ("upload-uri",
+	                                                      "Upload URI", "The URI which insertions are sent to.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWriteQueue:batch-feed-uri:
+	 *
+	 * The URI of the batch feed the writes are sent to together, or %NULL to send each write with its own request. It's only used if the
+	 * #GDataWriteQueue:service implements #GDataBatchable.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_BATCH_FEED_URI,
+	                                 g_param_spec_string ("batch-feed-uri",
+	                                                      "Batch feed URI", "The URI of the batch feed the writes are sent to together.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWriteQueue:flush-delay:
+	 *
+	 * The number of seconds after a write is queued to an empty queue that the queue is flushed automatically, if it's
+	 * #GDataWriteQueue:online. Writes queued in the meantime are flushed with it, so a longer delay coalesces more edits. If this is
+	 * <code class="literal">0</code>, the queue is never flushed automatically.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_FLUSH_DELAY,
+	                                 g_param_spec_uint ("flush-delay",
+	                                                    "Flush delay", "The number of seconds after a write is queued that the queue is flushed.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWriteQueue:online:
+	 *
+	 * Whether the server can currently be reached. While this is %FALSE, the queue isn't flushed automatically; when it becomes %TRUE, any
+	 * writes queued in the meantime are flushed straight away. Applications should keep it up to date using #GNetworkMonitor or similar.
+	 *
+	 * Since: 0.15.0
+	 **/
+	g_object_class_install_property (gobject_class, PROP_ONLINE,
+	                                 g_param_spec_boolean ("online",
+	                                                       "Online", "Whether the server can currently be reached.",
+	                                                       TRUE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataWriteQueue::write-finished:
+	 * @self: a #GDataWriteQueue
+	 * @operation_type: the type of the write
+	 * @entry: the local version of the entry which was written
+	 * @server_entry: (allow-none): the entry returned by the server, or %NULL
+	 * @error: (allow-none): a #GError describing why the write failed, or %NULL
+	 *
+	 * Emitted once for each write which a flush has finished with, apart from those put back in the queue to be retried.
+	 *
+	 * If the write succeeded, @error is %NULL, and @server_entry is the inserted or updated entry, or %NULL for a deletion. If a conflict was
+	 * resolved by abandoning the write, @error is also %NULL, and @server_entry is the server's version of the entry. Otherwise, @error is set.
+	 *
+	 * It's emitted in the thread which called gdata_write_queue_flush(), or in the thread-default main context of the thread the queue was
+	 * created in if the queue was flushed with gdata_write_queue_flush_async() or automatically.
+	 *
+	 * Since: 0.15.0
+	 **/
+	write_queue_signals[SIGNAL_WRITE_FINISHED] = g_signal_new ("write-finished",
+	                                                           G_TYPE_FROM_CLASS (klass),
+	                                                           G_SIGNAL_RUN_LAST,
+	                                                           0, NULL, NULL,
+	                                                           gdata_marshal_VOID__ENUM_OBJECT_OBJECT_BOXED,
+	                                                           G_TYPE_NONE, 4, GDATA_TYPE_BATCH_OPERATION_TYPE, GDATA_TYPE_ENTRY,
+	                                                           GDATA_TYPE_ENTRY, G_TYPE_ERROR);
+}
+
+static void
+pending_write_free (PendingWrite *write)
+{
+	g_free (write->key);
+	g_object_unref (write->entry);
+
+	if (write->result != NULL)
+		g_object_unref (write->result);
+	g_clear_error (&(write->error));
+
+	g_slice_free (PendingWrite, write);
+}
+
+static void
+gdata_write_queue_init (GDataWriteQueue *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_WRITE_QUEUE, GDataWriteQueuePrivate);
+
+	g_mutex_init (&(self->priv->flush_mutex));
+	g_mutex_init (&(self->priv->mutex));
+	self->priv->writes = g_queue_new ();
+	self->priv->writes_by_key = g_hash_table_new (g_str_hash, g_str_equal);
+	self->priv->online = TRUE;
+
+	self->priv->context = g_main_context_ref_thread_default ();
+}
+
+/* Cancels the next automatic flush, if one's scheduled. The queue's mutex must be held. */
+static void
+cancel_flush (GDataWriteQueue *self)
+{
+	GDataWriteQueuePrivate *priv = self->priv;
+
+	if (priv->flush_source != NULL) {
+		g_source_destroy (priv->flush_source);
+		g_source_unref (priv->flush_source);
+		priv->flush_source = NULL;
+	}
+}
+
+static void
+gdata_write_queue_dispose (GObject *object)
+{
+	GDataWriteQueuePrivate *priv = GDATA_WRITE_QUEUE (object)->priv;
+
+	g_mutex_lock (&(priv->mutex));
+	cancel_flush (GDATA_WRITE_QUEUE (object));
+	g_mutex_unlock (&(priv->mutex));
+
+	if (priv->authorization_domain != NULL)
+		g_object_unref (priv->authorization_domain);
+	priv->authorization_domain = NULL;
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_write_queue_parent_class)->dispose (object);
+}
+
+static void
+gdata_write_queue_finalize (GObject *object)
+{
+	GDataWriteQueuePrivate *priv = GDATA_WRITE_QUEUE (object)->priv;
+
+	g_hash_table_destroy (priv->writes_by_key);
+	g_queue_free_full (priv->writes, (GDestroyNotify) pending_write_free);
+
+	if (priv->resolver_data_destroy != NULL)
+		priv->resolver_data_destroy (priv->resolver_data);
+
+	g_free (priv->upload_uri);
+	g_free (priv->batch_feed_uri);
+	g_main_context_unref (priv->context);
+	g_mutex_clear (&(priv->mutex));
+	g_mutex_clear (&(priv->flush_mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_write_queue_parent_class)->finalize (object);
+}
+
+static void
+gdata_write_queue_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataWriteQueue *self = GDATA_WRITE_QUEUE (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, self->priv->service);
+			break;
+		case PROP_AUTHORIZATION_DOMAIN:
+			g_value_set_object (value, self->priv->authorization_domain);
+			break;
+		case PROP_UPLOAD_URI:
+			g_value_set_string (value, self->priv->upload_uri);
+			break;
+		case PROP_BATCH_FEED_URI:
+			g_value_set_string (value, self->priv->batch_feed_uri);
+			break;
+		case PROP_FLUSH_DELAY:
+			g_value_set_uint (value, gdata_write_queue_get_flush_delay (self));
+			break;
+		case PROP_ONLINE:
+			g_value_set_boolean (value, gdata_write_queue_get_online (self));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_write_queue_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataWriteQueue *self = GDATA_WRITE_QUEUE (object);
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			self->priv->service = g_value_dup_object (value);
+			break;
+		case PROP_AUTHORIZATION_DOMAIN:
+			self->priv->authorization_domain = g_value_dup_object (value);
+			break;
+		case PROP_UPLOAD_URI:
+			self->priv->upload_uri = g_value_dup_string (value);
+			break;
+		case PROP_BATCH_FEED_URI:
+			self->priv->batch_feed_uri = g_value_dup_string (value);
+			break;
+		case PROP_FLUSH_DELAY:
+			gdata_write_queue_set_flush_delay (self, g_value_get_uint (value));
+			break;
+		case PROP_ONLINE:
+			gdata_write_queue_set_online (self, g_value_get_boolean (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_write_queue_new:
+ * @service: the #GDataService to send the writes to
+ * @domain: (allow-none): the #GDataAuthorizationDomain to authorize the writes under, or %NULL
+ * @upload_uri: the URI to send insertions to when they aren't sent in a batch operation
+ * @batch_feed_uri: (allow-none): the URI of the batch feed to send the writes to, or %NULL
+ *
+ * Creates a new, empty #GDataWriteQueue. Automatic flushes are made, and #GDataWriteQueue::write-finished is emitted for asynchronous flushes, in
+ * the thread-default main context of the calling thread.
+ *
+ * Return value: (transfer full): a new #GDataWriteQueue; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GDataWriteQueue *
+gdata_write_queue_new (GDataService *service, GDataAuthorizationDomain *domain, const gchar *upload_uri, const gchar *batch_feed_uri)
+{
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), NULL);
+	g_return_val_if_fail (domain == NULL || GDATA_IS_AUTHORIZATION_DOMAIN (domain), NULL);
+	g_return_val_if_fail (upload_uri != NULL, NULL);
+
+	return g_object_new (GDATA_TYPE_WRITE_QUEUE,
+	                     "service", service,
+	                     "authorization-domain", domain,
+	                     "upload-uri", upload_uri,
+	                     "batch-feed-uri", batch_feed_uri,
+	                     NULL);
+}
+
+/**
+ * gdata_write_queue_get_service:
+ * @self: a #GDataWriteQueue
+ *
+ * Gets the #GDataWriteQueue:service property.
+ *
+ * Return value: (transfer none): the service the writes are sent to
+ *
+ * Since: 0.15.0
+ **/
+GDataService *
+gdata_write_queue_get_service (GDataWriteQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_WRITE_QUEUE (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_write_queue_get_authorization_domain:
+ * @self: a #GDataWriteQueue
+ *
+ * Gets the #GDataWriteQueue:authorization-domain property.
+ *
+ * Return value: (transfer none) (allow-none): the authorization domain the writes are authorized under, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+GDataAuthorizationDomain *
+gdata_write_queue_get_authorization_domain (GDataWriteQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_WRITE_QUEUE (self), NULL);
+	return self->priv->authorization_domain;
+}
+
+/**
+ * gdata_write_queue_get_upload_uri:
+ * @self: a #GDataWriteQueue
+ *
+ * Gets the #GDataWriteQueue:upload-uri property.
+ *
+ * Return value: the URI insertions are sent to
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_write_queue_get_upload_uri (GDataWriteQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_WRITE_QUEUE (self), NULL);
+	return self->priv->upload_uri;
+}
+
+/**
+ * gdata_write_queue_get_batch_feed_uri:
+ * @self: a #GDataWriteQueue
+ *
+ * Gets the #GDataWriteQueue:batch-feed-uri property.
+ *
+ * Return value: (allow-none): the URI of the batch feed the writes are sent to, or %NULL
+ *
+ * Since: 0.15.0
+ **/
+const gchar *
+gdata_write_queue_get_batch_feed_uri (GDataWriteQueue *self)
+{
+	g_return_val_if_fail (GDATA_IS_WRITE_QUEUE (self), NULL);
+	return self->priv->batch_feed_uri;
+}
+
+static gboolean flush_timeout_cb (GDataWriteQueue *self);
+
+/* Schedules an automatic flush, if the queue's online and has writes in it, and one isn't already scheduled. The queue's mutex must be held. */
+static void
+schedule_flush (GDataWriteQueue *self)
+{
+	GDataWriteQueuePrivate *priv = self->priv;
+
+	if (priv->flush_source != NULL || priv->online == FALSE || priv->flush_delay == 0 || g_queue_is_empty (priv->writes) == TRUE)
+		return;
+
+	priv->flush_source = g_timeout_source_new_seconds (priv->flush_delay);
+	g_source_set_callback (priv->flush_source, (GSourceFunc) flush_timeout_cb, self, NULL);
+	g_source_attach (priv->flush_source, priv->context);
+}
+
+static gboolean
+flush_timeout_cb (GDataWriteQueue *self)
+{
+	GDataWriteQueuePrivate *priv = self->priv;
+
+	g_mutex_lock (&(priv->mutex));
+
+	/* Ignore the timeout if the flush has been cancelled or rescheduled since it was dispatched */
+	if (g_main_current_source () != priv->flush_source) {
+		g_mutex_unlock (&(priv->mutex));
+		return FALSE;
+	}
+
+	g_source_unref (priv->flush_source);
+	priv->flush_source = NULL;
+
+	g_mutex_unlock (&(priv->mutex));
+
+	gdata_write_queue_flush_async (self, NULL, NULL, NULL);
+
+	return FALSE;
+}
+
+/**
+ * gdata_write_queue_get_flush_delay:
+ * @self: a #GDataWriteQueue
+ *
+ * Gets the #GDataWriteQueue:flush-delay property.
+ *
+ * Return value: the delay before automatic flushes, in seconds, or <code class="literal">0</code> if the queue isn't flushed automatically
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_write_queue_get_flush_delay (GDataWriteQueue *self)
+{
+	guint flush_delay;
+
+	g_return_val_if_fail (GDATA_IS_WRITE_QUEUE (self), 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	flush_delay = self->priv->flush_delay;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return flush_delay;
+}
+
+/**
+ * gdata_write_queue_set_flush_delay:
+ * @self: a #GDataWriteQueue
+ * @flush_delay: the delay before automatic flushes, in seconds, or <code class="literal">0</code> to disable them
+ *
+ * Sets the #GDataWriteQueue:flush-delay property. If the queue has writes in it, the next automatic flush is rescheduled to happen after the new
+ * delay.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_write_queue_set_flush_delay (GDataWriteQueue *self, guint flush_delay)
+{
+	g_return_if_fail (GDATA_IS_WRITE_QUEUE (self));
+
+	g_mutex_lock (&(self->priv->mutex));
+	self->priv->flush_delay = flush_delay;
+	cancel_flush (self);
+	schedule_flush (self);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_object_notify (G_OBJECT (self), "flush-delay");
+}
+
+/**
+ * gdata_write_queue_get_online:
+ * @self: a #GDataWriteQueue
+ *
+ * Gets the #GDataWriteQueue:online property.
+ *
+ * Return value: %TRUE if the server can be reached, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_write_queue_get_online (GDataWriteQueue *self)
+{
+	gboolean online;
+
+	g_return_val_if_fail (GDATA_IS_WRITE_QUEUE (self), FALSE);
+
+	g_mutex_lock (&(self->priv->mutex));
+	online = self->priv->online;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return online;
+}
+
+/**
+ * gdata_write_queue_set_online:
+ * @self: a #GDataWriteQueue
+ * @online: %TRUE if the server can be reached, %FALSE otherwise
+ *
+ * Sets the #GDataWriteQueue:online property. If the queue goes online with writes in it, they're flushed asynchronously straight away.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_write_queue_set_online (GDataWriteQueue *self, gboolean online)
+{
+	GDataWriteQueuePrivate *priv;
+	gboolean flush_now;
+
+	g_return_if_fail (GDATA_IS_WRITE_QUEUE (self));
+
+	priv = self->priv;
+	online = (online != FALSE) ? TRUE : FALSE;
+
+	g_mutex_lock (&(priv->mutex));
+
+	if (priv->online == online) {
+		g_mutex_unlock (&(priv->mutex));
+		return;
+	}
+
+	priv->online = online;
+	flush_now = (online == TRUE && g_queue_is_empty (priv->writes) == FALSE);
+
+	/* The timer's restarted by the flush, if it's needed */
+	cancel_flush (self);
+
+	g_mutex_unlock (&(priv->mutex));
+
+	if (flush_now == TRUE)
+		gdata_write_queue_flush_async (self, NULL, NULL, NULL);
+
+	g_object_notify (G_OBJECT (self), "online");
+}
+
+/**
+ * gdata_write_queue_set_conflict_resolver:
+ * @self: a #GDataWriteQueue
+ * @resolver: (allow-none): the #GDataWriteQueueConflictResolver to call for conflicting updates and deletions, or %NULL
+ * @user_data: (closure): data to pass to @resolver
+ * @destroy_user_data: (allow-none): the function to call when @user_data is no longer needed, or %NULL
+ *
+ * Sets the function which decides what to do with updates and deletions which conflict with changes made on the server, replacing any previous one
+ * and freeing its user data. If @resolver is %NULL, conflicting writes fail with %GDATA_SERVICE_ERROR_CONFLICT.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_write_queue_set_conflict_resolver (GDataWriteQueue *self, GDataWriteQueueConflictResolver resolver, gpointer user_data,
+                                         GDestroyNotify destroy_user_data)
+{
+	GDataWriteQueuePrivate *priv;
+	gpointer old_data;
+	GDestroyNotify old_data_destroy;
+
+	g_return_if_fail (GDATA_IS_WRITE_QUEUE (self));
+
+	priv = self->priv;
+
+	/* Hold the flush mutex so that the old resolver isn't in use while its data is freed */
+	g_mutex_lock (&(priv->flush_mutex));
+	g_mutex_lock (&(priv->mutex));
+
+	old_data = priv->resolver_data;
+	old_data_destroy = priv->resolver_data_destroy;
+
+	priv->resolver = resolver;
+	priv->resolver_data = user_data;
+	priv->resolver_data_destroy = destroy_user_data;
+
+	g_mutex_unlock (&(priv->mutex));
+
+	if (old_data_destroy != NULL)
+		old_data_destroy (old_data);
+
+	g_mutex_unlock (&(priv->flush_mutex));
+}
+
+/* Returns the key identifying writes of @entry: its ID, or its address if it hasn't been inserted yet. IDs are URIs, so the two can't clash. */
+static gchar *
+build_write_key (GDataEntry *entry)
+{
+	const gchar *id = gdata_entry_get_id (entry);
+
+	return (id != NULL) ? g_strdup (id) : g_strdup_printf ("local:%p", (gpointer) entry);
+}
+
+/* Folds a later write of @type of @entry into @write, which is to the same entry. Returns %FALSE if the two writes cancel out. */
+static gboolean
+coalesce_writes (PendingWrite *write, GDataBatchOperationType type, GDataEntry *entry)
+{
+	if (write->type == GDATA_BATCH_OPERATION_INSERTION) {
+		/* The server's never seen the entry, so there's nothing to delete; and it might as well be inserted as it is now */
+		if (type == GDATA_BATCH_OPERATION_DELETION)
+			return FALSE;
+	} else if (write->type == GDATA_BATCH_OPERATION_UPDATE) {
+		/* Only the last version of the entry matters; and there's no point updating something which is about to be deleted */
+		write->type = (type == GDATA_BATCH_OPERATION_DELETION) ? GDATA_BATCH_OPERATION_DELETION : GDATA_BATCH_OPERATION_UPDATE;
+	} else {
+		/* A write following a deletion recreates the entry with the same ID, so it replaces the deletion */
+		write->type = type;
+	}
+
+	g_object_ref (entry);
+	g_object_unref (write->entry);
+	write->entry = entry;
+
+	return TRUE;
+}
+
+static void
+remove_write (GDataWriteQueue *self, PendingWrite *write)
+{
+	g_hash_table_remove (self->priv->writes_by_key, write->key);
+	g_queue_remove (self->priv->writes, write);
+	pending_write_free (write);
+}
+
+static void
+add_write (GDataWriteQueue *self, GDataBatchOperationType type, GDataEntry *entry)
+{
+	GDataWriteQueuePrivate *priv = self->priv;
+	PendingWrite *write;
+	gchar *key;
+
+	key = build_write_key (entry);
+
+	g_mutex_lock (&(priv->mutex));
+
+	write = g_hash_table_lookup (priv->writes_by_key, key);
+
+	if (write == NULL) {
+		write = g_slice_new0 (PendingWrite);
+		write->type = type;
+		write->key = key;
+		write->entry = g_object_ref (entry);
+
+		g_queue_push_tail (priv->writes, write);
+		g_hash_table_insert (priv->writes_by_key, write->key, write);
+	} else {
+		if (coalesce_writes (write, type, entry) == FALSE)
+			remove_write (self, write);
+
+		g_free (key);
+	}
+
+	schedule_flush (self);
+
+	g_mutex_unlock (&(priv->mutex));
+}
+
+/**
+ * gdata_write_queue_add_insertion:
+ * @self: a #GDataWriteQueue
+ * @entry: the #GDataEntry to insert
+ *
+ * Queues an insertion of @entry. If @entry is already queued to be inserted, the insertion is left as it is; the latest version of @entry is sent
+ * when the queue's flushed anyway.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_write_queue_add_insertion (GDataWriteQueue *self, GDataEntry *entry)
+{
+	g_return_if_fail (GDATA_IS_WRITE_QUEUE (self));
+	g_return_if_fail (GDATA_IS_ENTRY (entry));
+
+	add_write (self, GDATA_BATCH_OPERATION_INSERTION, entry);
+}
+
+/**
+ * gdata_write_queue_add_update:
+ * @self: a #GDataWriteQueue
+ * @entry: the updated #GDataEntry
+ *
+ * Queues an update of @entry, replacing any update of the same entry which is already queued. If the entry is queued to be inserted, it's inserted
+ * as @entry instead of being updated.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_write_queue_add_update (GDataWriteQueue *self, GDataEntry *entry)
+{
+	g_return_if_fail (GDATA_IS_WRITE_QUEUE (self));
+	g_return_if_fail (GDATA_IS_ENTRY (entry));
+
+	add_write (self, GDATA_BATCH_OPERATION_UPDATE, entry);
+}
+
+/**
+ * gdata_write_queue_add_deletion:
+ * @self: a #GDataWriteQueue
+ * @entry: the #GDataEntry to delete
+ *
+ * Queues a deletion of @entry, replacing any update of the same entry which is already queued. If the entry is queued to be inserted, the insertion
+ * is dropped from the queue instead, and nothing is sent to the server.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_write_queue_add_deletion (GDataWriteQueue *self, GDataEntry *entry)
+{
+	g_return_if_fail (GDATA_IS_WRITE_QUEUE (self));
+	g_return_if_fail (GDATA_IS_ENTRY (entry));
+
+	add_write (self, GDATA_BATCH_OPERATION_DELETION, entry);
+}
+
+/**
+ * gdata_write_queue_get_n_pending:
+ * @self: a #GDataWriteQueue
+ *
+ * Gets the number of writes waiting in the queue, after coalescing. Writes which are currently being flushed aren't counted.
+ *
+ * Return value: the number of pending writes
+ *
+ * Since: 0.15.0
+ **/
+guint
+gdata_write_queue_get_n_pending (GDataWriteQueue *self)
+{
+	guint n_pending;
+
+	g_return_val_if_fail (GDATA_IS_WRITE_QUEUE (self), 0);
+
+	g_mutex_lock (&(self->priv->mutex));
+	n_pending = g_queue_get_length (self->priv->writes);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return n_pending;
+}
+
+/* Returns %TRUE if @error is one which might go away if the write's retried later */
+static gboolean
+is_transient_error (const GError *error)
+{
+	return (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == TRUE ||
+	        g_error_matches (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_UNAVAILABLE) == TRUE ||
+	        g_error_matches (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NETWORK_ERROR) == TRUE ||
+	        g_error_matches (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROXY_ERROR) == TRUE) ? TRUE : FALSE;
+}
+
+/* Sends a single write of @entry, setting @write's result or error */
+static void
+send_write (GDataWriteQueue *self, PendingWrite *write, GDataEntry *entry, GCancellable *cancellable)
+{
+	GDataWriteQueuePrivate *priv = self->priv;
+
+	switch (write->type) {
+		case GDATA_BATCH_OPERATION_INSERTION:
+			write->result = gdata_service_insert_entry (priv->service, priv->authorization_domain, priv->upload_uri, entry, cancellable,
+			                                            &(write->error));
+			break;
+		case GDATA_BATCH_OPERATION_UPDATE:
+			write->result = gdata_service_update_entry (priv->service, priv->authorization_domain, entry, cancellable, &(write->error));
+			break;
+		case GDATA_BATCH_OPERATION_DELETION:
+			gdata_service_delete_entry (priv->service, priv->authorization_domain, entry, cancellable, &(write->error));
+			break;
+		case GDATA_BATCH_OPERATION_QUERY:
+		default:
+			g_assert_not_reached ();
+	}
+}
+
+static void
+batch_write_cb (guint operation_id, GDataBatchOperationType operation_type, GDataEntry *entry, GError *error, PendingWrite *write)
+{
+	if (error != NULL)
+		write->error = g_error_copy (error);
+	else if (entry != NULL && operation_type != GDATA_BATCH_OPERATION_DELETION)
+		write->result = g_object_ref (entry);
+}
+
+/* Sends @writes (a list of PendingWrites) to the server, setting each one's result or error */
+static void
+send_writes (GDataWriteQueue *self, GList *writes, GCancellable *cancellable)
+{
+	GDataWriteQueuePrivate *priv = self->priv;
+	GList *i;
+
+	if (priv->batch_feed_uri != NULL && GDATA_IS_BATCHABLE (priv->service) == TRUE && writes->next != NULL) {
+		GDataBatchOperation *operation;
+
+		operation = gdata_batchable_create_operation (GDATA_BATCHABLE (priv->service), priv->authorization_domain, priv->batch_feed_uri);
+		gdata_batch_operation_set_max_operations_per_request (operation, GDATA_BATCH_MAX_OPERATIONS_PER_REQUEST);
+
+		for (i = writes; i != NULL; i = i->next) {
+			PendingWrite *write = i->data;
+			GDataBatchOperationCallback callback = (GDataBatchOperationCallback) batch_write_cb;
+
+			if (write->type == GDATA_BATCH_OPERATION_INSERTION)
+				gdata_batch_operation_add_insertion (operation, write->entry, callback, write);
+			else if (write->type == GDATA_BATCH_OPERATION_UPDATE)
+				gdata_batch_operation_add_update (operation, write->entry, callback, write);
+			else
+				gdata_batch_operation_add_deletion (operation, write->entry, callback, write);
+		}
+
+		/* Every write's callback is called with the error if the operation fails as a whole, so the return value can be ignored */
+		gdata_batch_operation_run (operation, cancellable, NULL);
+		g_object_unref (operation);
+
+		return;
+	}
+
+	for (i = writes; i != NULL; i = i->next) {
+		PendingWrite *write = i->data;
+
+		send_write (self, write, write->entry, cancellable);
+
+		/* If the network's gone down, don't bother trying the rest of the writes: fail them with the same error */
+		if (write->error != NULL && is_transient_error (write->error) == TRUE) {
+			for (i = i->next; i != NULL; i = i->next)
+				((PendingWrite*) i->data)->error = g_error_copy (write->error);
+			break;
+		}
+	}
+}
+
+/* Handles a write which failed with GDATA_SERVICE_ERROR_CONFLICT, by asking the conflict resolver what to do and retrying the write once */
+static void
+resolve_conflict (GDataWriteQueue *self, PendingWrite *write, GDataWriteQueueConflictResolver resolver, gpointer resolver_data,
+                  GCancellable *cancellable)
+{
+	GDataWriteQueuePrivate *priv = self->priv;
+	GDataEntry *server_entry, *resolved_entry;
+	GError *child_error = NULL;
+
+	server_entry = gdata_service_query_single_entry (priv->service, priv->authorization_domain, gdata_entry_get_id (write->entry), NULL,
+	                                                 G_OBJECT_TYPE (write->entry), cancellable, &child_error);
+
+	if (server_entry == NULL) {
+		g_clear_error (&(write->error));
+
+		/* If a deleted entry's been deleted on the server too, there's no conflict */
+		if (write->type == GDATA_BATCH_OPERATION_DELETION &&
+		    g_error_matches (child_error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND) == TRUE) {
+			g_error_free (child_error);
+		} else {
+			write->error = child_error;
+		}
+
+		return;
+	}
+
+	resolved_entry = resolver (self, write->entry, server_entry, resolver_data);
+	g_clear_error (&(write->error));
+
+	if (resolved_entry == NULL) {
+		/* Abandon the write, and report the server's version as the result */
+		write->result = server_entry;
+		return;
+	}
+
+	send_write (self, write, resolved_entry, cancellable);
+
+	g_object_unref (resolved_entry);
+	g_object_unref (server_entry);
+}
+
+/* Puts @write, a write which failed transiently, back in the queue. Any writes to the same entry queued since it was taken out are newer, so are
+ * coalesced into it. The queue's mutex must be held. */
+static void
+requeue_write (GDataWriteQueue *self, PendingWrite *write)
+{
+	GDataWriteQueuePrivate *priv = self->priv;
+	PendingWrite *newer_write;
+
+	g_clear_error (&(write->error));
+	if (write->result != NULL)
+		g_object_unref (write->result);
+	write->result = NULL;
+
+	newer_write = g_hash_table_lookup (priv->writes_by_key, write->key);
+
+	if (newer_write == NULL) {
+		g_queue_push_head (priv->writes, write);
+		g_hash_table_insert (priv->writes_by_key, write->key, write);
+	} else if (coalesce_writes (write, newer_write->type, newer_write->entry) == TRUE) {
+		/* Keep the newer write's place in the queue */
+		newer_write->type = write->type;
+		g_object_ref (write->entry);
+		g_object_unref (newer_write->entry);
+		newer_write->entry = write->entry;
+
+		pending_write_free (write);
+	} else {
+		remove_write (self, newer_write);
+		pending_write_free (write);
+	}
+}
+
+typedef struct {
+	GDataWriteQueue *queue;
+	PendingWrite *write;
+} WriteFinishedData;
+
+static void
+write_finished_data_free (WriteFinishedData *data)
+{
+	g_object_unref (data->queue);
+	pending_write_free (data->write);
+	g_slice_free (WriteFinishedData, data);
+}
+
+static void
+emit_write_finished (GDataWriteQueue *self, PendingWrite *write)
+{
+	g_signal_emit (self, write_queue_signals[SIGNAL_WRITE_FINISHED], 0, write->type, write->entry, write->result, write->error);
+}
+
+static gboolean
+write_finished_idle_cb (WriteFinishedData *data)
+{
+	emit_write_finished (data->queue, data->write);
+	return FALSE;
+}
+
+/* Flushes the queue. If @is_async is %TRUE, #GDataWriteQueue::write-finished is emitted in the queue's main context rather than the calling
+ * thread. */
+static gboolean
+flush_writes (GDataWriteQueue *self, gboolean is_async, GCancellable *cancellable, GError **error)
+{
+	GDataWriteQueuePrivate *priv = self->priv;
+	GDataWriteQueueConflictResolver resolver;
+	gpointer resolver_data;
+	GQueue *writes;
+	GList *i;
+	GError *child_error = NULL;
+
+	g_mutex_lock (&(priv->flush_mutex));
+
+	/* Take all the writes out of the queue, so that writes can be queued (and coalesced) while these are being sent */
+	g_mutex_lock (&(priv->mutex));
+
+	cancel_flush (self);
+	writes = priv->writes;
+	priv->writes = g_queue_new ();
+	g_hash_table_remove_all (priv->writes_by_key);
+
+	resolver = priv->resolver;
+	resolver_data = priv->resolver_data;
+
+	g_mutex_unlock (&(priv->mutex));
+
+	if (g_queue_is_empty (writes) == TRUE) {
+		g_queue_free (writes);
+		g_mutex_unlock (&(priv->flush_mutex));
+		return TRUE;
+	}
+
+	send_writes (self, writes->head, cancellable);
+
+	for (i = writes->head; i != NULL; i = i->next) {
+		PendingWrite *write = i->data;
+
+		if (resolver != NULL && write->type != GDATA_BATCH_OPERATION_INSERTION &&
+		    g_error_matches (write->error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_CONFLICT) == TRUE) {
+			resolve_conflict (self, write, resolver, resolver_data, cancellable);
+		}
+	}
+
+	/* Put back the writes which might succeed next time, in their original order, and report the rest */
+	g_mutex_lock (&(priv->mutex));
+
+	for (i = writes->tail; i != NULL; i = i->prev) {
+		PendingWrite *write = i->data;
+
+		if (write->error != NULL && is_transient_error (write->error) == TRUE) {
+			if (child_error != NULL)
+				g_error_free (child_error);
+			child_error = g_error_copy (write->error);
+
+			requeue_write (self, write);
+			i->data = NULL;
+		}
+	}
+
+	schedule_flush (self);
+
+	g_mutex_unlock (&(priv->mutex));
+
+	for (i = writes->head; i != NULL; i = i->next) {
+		PendingWrite *write = i->data;
+
+		if (write == NULL)
+			continue;
+
+		if (is_async == TRUE) {
+			WriteFinishedData *data = g_slice_new (WriteFinishedData);
+			data->queue = g_object_ref (self);
+			data->write = write;
+
+			_gdata_service_idle_add (priv->context, (GSourceFunc) write_finished_idle_cb, data, (GDestroyNotify) write_finished_data_free);
+		} else {
+			emit_write_finished (self, write);
+			pending_write_free (write);
+		}
+	}
+
+	g_queue_free (writes);
+
+	g_mutex_unlock (&(priv->flush_mutex));
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_write_queue_flush:
+ * @self: a #GDataWriteQueue
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Sends all the writes in the queue to the server, and emits #GDataWriteQueue::write-finished for each one (in the calling thread) as they're
+ * finished with. If another flush is in progress, this waits for it to finish first.
+ *
+ * Writes which fail for reasons which might go away are put back in the queue, and %FALSE is returned with the error of the first of them. Other
+ * failures are only reported by #GDataWriteQueue::write-finished, and don't make this return %FALSE.
+ *
+ * If @cancellable is cancelled, the writes which haven't been sent yet are put back in the queue, and %G_IO_ERROR_CANCELLED is returned.
+ *
+ * Return value: %TRUE if no writes were put back in the queue, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_write_queue_flush (GDataWriteQueue *self, GCancellable *cancellable, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_WRITE_QUEUE (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return flush_writes (self, FALSE, cancellable, error);
+}
+
+static void
+flush_thread (GSimpleAsyncResult *result, GDataWriteQueue *self, GCancellable *cancellable)
+{
+	GError *error = NULL;
+
+	if (flush_writes (self, TRUE, cancellable, &error) == FALSE)
+		g_simple_async_result_take_error (result, error);
+}
+
+/**
+ * gdata_write_queue_flush_async:
+ * @self: a #GDataWriteQueue
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: (allow-none): a #GAsyncReadyCallback to call when the flush is finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Sends all the writes in the queue to the server asynchronously. #GDataWriteQueue::write-finished is emitted for each write in the
+ * thread-default main context of the thread which created the queue, before @callback is called. @self is reffed when this function is called, so
+ * can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_write_queue_flush(), which is the synchronous version of this function.
+ *
+ * When the flush is finished, @callback will be called. You can then call gdata_write_queue_flush_finish() to get the results of the flush.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_write_queue_flush_async (GDataWriteQueue *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+
+	g_return_if_fail (GDATA_IS_WRITE_QUEUE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_write_queue_flush_async);
+
+	/* The writes must be put back in the queue if the flush is cancelled, so flush_thread() must always be called */
+	g_simple_async_result_set_handle_cancellation (result, FALSE);
+
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) flush_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_write_queue_flush_finish:
+ * @self: a #GDataWriteQueue
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous flush started with gdata_write_queue_flush_async().
+ *
+ * Return values are as for gdata_write_queue_flush().
+ *
+ * Return value: %TRUE if no writes were put back in the queue, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ **/
+gboolean
+gdata_write_queue_flush_finish (GDataWriteQueue *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_WRITE_QUEUE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (G_SIMPLE_ASYNC_RESULT (async_result)) == gdata_write_queue_flush_async);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == TRUE)
+		return FALSE;
+
+	return TRUE;
+}
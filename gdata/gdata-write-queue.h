@@ -0,0 +1,119 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_WRITE_QUEUE_H
+#define GDATA_WRITE_QUEUE_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/gdata-service.h>
+#include <gdata/gdata-entry.h>
+#include <gdata/gdata-authorization-domain.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_WRITE_QUEUE			(gdata_write_queue_get_type ())
+#define GDATA_WRITE_QUEUE(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_WRITE_QUEUE, GDataWriteQueue))
+#define GDATA_WRITE_QUEUE_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_WRITE_QUEUE, GDataWriteQueueClass))
+#define GDATA_IS_WRITE_QUEUE(o)			(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_WRITE_QUEUE))
+#define GDATA_IS_WRITE_QUEUE_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_WRITE_QUEUE))
+#define GDATA_WRITE_QUEUE_GET_CLASS(o)		(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_WRITE_QUEUE, GDataWriteQueueClass))
+
+typedef struct _GDataWriteQueuePrivate	GDataWriteQueuePrivate;
+
+/**
+ * GDataWriteQueue:
+ *
+ * All the fields in the #GDataWriteQueue structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObject parent;
+	GDataWriteQueuePrivate *priv;
+} GDataWriteQueue;
+
+/**
+ * GDataWriteQueueClass:
+ *
+ * All the fields in the #GDataWriteQueueClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataWriteQueueClass;
+
+/**
+ * GDataWriteQueueConflictResolver:
+ * @queue: the #GDataWriteQueue
+ * @local_entry: the local version of the entry, which the queue tried to update or delete
+ * @server_entry: the version of the entry currently on the server
+ * @user_data: (closure): user data passed to gdata_write_queue_set_conflict_resolver()
+ *
+ * Called when an update or deletion flushed by a #GDataWriteQueue fails because the entry has been changed on the server since @local_entry was
+ * retrieved, to decide what to do instead.
+ *
+ * To go ahead with the write, the resolver should return an entry with the server's ETag: typically @server_entry, with the local changes merged
+ * into it, or a reference to it to delete it anyway. The queue then retries the write once with that entry. To abandon the write and keep the
+ * server's version, the resolver should return %NULL.
+ *
+ * The resolver is called in the thread which is flushing the queue.
+ *
+ * Return value: (transfer full) (allow-none): the entry to retry the write with, or %NULL to abandon it
+ *
+ * Since: 0.15.0
+ **/
+typedef GDataEntry *(*GDataWriteQueueConflictResolver) (GDataWriteQueue *queue, GDataEntry *local_entry, GDataEntry *server_entry,
+                                                        gpointer user_data);
+
+GType gdata_write_queue_get_type (void) G_GNUC_CONST;
+
+GDataWriteQueue *gdata_write_queue_new (GDataService *service, GDataAuthorizationDomain *domain, const gchar *upload_uri,
+                                        const gchar *batch_feed_uri) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataService *gdata_write_queue_get_service (GDataWriteQueue *self) G_GNUC_PURE;
+GDataAuthorizationDomain *gdata_write_queue_get_authorization_domain (GDataWriteQueue *self) G_GNUC_PURE;
+const gchar *gdata_write_queue_get_upload_uri (GDataWriteQueue *self) G_GNUC_PURE;
+const gchar *gdata_write_queue_get_batch_feed_uri (GDataWriteQueue *self) G_GNUC_PURE;
+
+guint gdata_write_queue_get_flush_delay (GDataWriteQueue *self);
+void gdata_write_queue_set_flush_delay (GDataWriteQueue *self, guint flush_delay);
+gboolean gdata_write_queue_get_online (GDataWriteQueue *self);
+void gdata_write_queue_set_online (GDataWriteQueue *self, gboolean online);
+
+void gdata_write_queue_set_conflict_resolver (GDataWriteQueue *self, GDataWriteQueueConflictResolver resolver, gpointer user_data,
+                                              GDestroyNotify destroy_user_data);
+
+void gdata_write_queue_add_insertion (GDataWriteQueue *self, GDataEntry *entry);
+void gdata_write_queue_add_update (GDataWriteQueue *self, GDataEntry *entry);
+void gdata_write_queue_add_deletion (GDataWriteQueue *self, GDataEntry *entry);
+guint gdata_write_queue_get_n_pending (GDataWriteQueue *self);
+
+gboolean gdata_write_queue_flush (GDataWriteQueue *self, GCancellable *cancellable, GError **error);
+void gdata_write_queue_flush_async (GDataWriteQueue *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_write_queue_flush_finish (GDataWriteQueue *self, GAsyncResult *async_result, GError **error);
+
+G_END_DECLS
+
+#endif /* !GDATA_WRITE_QUEUE_H */
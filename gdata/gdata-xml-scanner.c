@@ -0,0 +1,420 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * SECTION:gdata-xml-scanner
+ * @short_description: GData XML element span scanner
+ * @stability: Unstable
+ * @include: gdata/gdata-xml-scanner.h
+ *
+ * #GDataXmlScanner finds the text of the root element of an XML document, or of each of the root's child elements in turn (such as the entries in a
+ * feed), so that they can be kept and output again verbatim. It runs alongside libxml, rather than replacing it: it only tokenises the markup, and
+ * relies on libxml to have checked that the document is well-formed. Scanning is done lazily, when an element's text is requested, so there's no
+ * cost for documents whose elements aren't requested.
+ *
+ * The document can either be given in full up front, in which case it's scanned in place, or appended to the scanner as it's read. In the latter
+ * case, the text which precedes a requested child element is discarded once the element's been returned, so only the document's read-ahead has to be
+ * held in memory.
+ *
+ * Scanning fails for documents which have a DTD (since entities could then expand to markup), or which aren't encoded in UTF-8.
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+
+#include "gdata-xml-scanner.h"
+
+typedef enum {
+	TOKEN_INCOMPLETE,
+	TOKEN_INVALID,
+	TOKEN_START_TAG,
+	TOKEN_EMPTY_TAG,
+	TOKEN_END_TAG,
+	TOKEN_OTHER,
+} TokenType;
+
+/* Initialises @self to scan @xml, which must remain valid until @self is cleared. If @xml is %NULL, the document has to be appended to @self using
+ * gdata_xml_scanner_append() instead. */
+void
+gdata_xml_scanner_init (GDataXmlScanner *self, const gchar *xml, gsize length)
+{
+	memset (self, 0, sizeof (*self));
+
+	if (xml != NULL) {
+		self->data = xml;
+		self->length = length;
+	} else {
+		self->owned = g_string_new (NULL);
+		self->data = self->owned->str;
+	}
+}
+
+/* Frees the resources held by @self */
+void
+gdata_xml_scanner_clear (GDataXmlScanner *self)
+{
+	if (self->owned != NULL)
+		g_string_free (self->owned, TRUE);
+	if (self->root_declarations != NULL)
+		g_ptr_array_free (self->root_declarations, TRUE);
+
+	memset (self, 0, sizeof (*self));
+}
+
+/* Appends the next @length bytes of the document to @self, which must have been initialised without one */
+void
+gdata_xml_scanner_append (GDataXmlScanner *self, const gchar *data, gsize length)
+{
+	g_return_if_fail (self->owned != NULL);
+
+	g_string_append_len (self->owned, data, length);
+	self->data = self->owned->str;
+	self->length = self->owned->len;
+}
+
+/* Discards the first @offset bytes of the document, if it's owned by @self */
+static void
+discard (GDataXmlScanner *self, gsize offset)
+{
+	if (self->owned == NULL || offset == 0)
+		return;
+
+	g_string_erase (self->owned, 0, offset);
+	self->data = self->owned->str;
+	self->length = self->owned->len;
+	self->discarded += offset;
+	self->position -= offset;
+
+	/* The current child's been finished with, so its offsets can be clamped; and the root's are no longer needed */
+	self->child_start = MAX (self->child_start, offset) - offset;
+	self->child_content_start = MAX (self->child_content_start, offset) - offset;
+	self->child_end = MAX (self->child_end, offset) - offset;
+	self->root_start = self->root_content_start = self->root_end = 0;
+}
+
+static const gchar *
+find_string (const gchar *p, const gchar *end, const gchar *needle)
+{
+	return g_strstr_len (p, end - p, needle);
+}
+
+/* Returns FALSE if the encoding given in the XML declaration between @p and @end isn't UTF-8 */
+static gboolean
+check_xml_declaration (const gchar *p, const gchar *end)
+{
+	const gchar *encoding;
+	gchar quote;
+
+	encoding = find_string (p, end, "encoding");
+	if (encoding == NULL)
+		return TRUE;
+
+	for (p = encoding + strlen ("encoding"); p < end && (g_ascii_isspace (*p) || *p == '='); p++);
+	if (p == end || (*p != '"' && *p != '\''))
+		return FALSE;
+
+	quote = *(p++);
+	return ((end - p > 5 && g_ascii_strncasecmp (p, "UTF-8", 5) == 0 && p[5] == quote) ||
+	        (end - p > 4 && g_ascii_strncasecmp (p, "UTF8", 4) == 0 && p[4] == quote)) ? TRUE : FALSE;
+}
+
+/* Finds the next markup token, and sets @token_start and @token_end to its offsets */
+static TokenType
+next_token (GDataXmlScanner *self, gsize *token_start, gsize *token_end)
+{
+	const gchar *data = self->data, *end = self->data + self->length, *p, *q;
+	TokenType type;
+
+	p = memchr (data + self->position, '<', self->length - self->position);
+	if (p == NULL) {
+		/* Skip the character data; there's no need to look at it again once more of the document's been appended */
+		self->position = self->length;
+		return TOKEN_INCOMPLETE;
+	}
+
+	self->position = p - data;
+	if (end - p < 2)
+		return TOKEN_INCOMPLETE;
+
+	if (p[1] == '?') {
+		/* Processing instruction or XML declaration */
+		q = find_string (p + 2, end, "?>");
+		if (q == NULL)
+			return TOKEN_INCOMPLETE;
+		q += 2;
+
+		if (self->root_declarations == NULL && check_xml_declaration (p, q) == FALSE)
+			return TOKEN_INVALID;
+
+		type = TOKEN_OTHER;
+	} else if (p[1] == '!') {
+		if (end - p >= 4 && strncmp (p, "<!--", 4) == 0) {
+			q = find_string (p + 4, end, "-->");
+			if (q == NULL)
+				return TOKEN_INCOMPLETE;
+			q += 3;
+		} else if (end - p >= 9 && strncmp (p, "<![CDATA[", 9) == 0) {
+			q = find_string (p + 9, end, "]]>");
+			if (q == NULL)
+				return TOKEN_INCOMPLETE;
+			q += 3;
+		} else if (end - p >= 9) {
+			/* A DTD; its entities could expand to markup, so give up */
+			return TOKEN_INVALID;
+		} else {
+			return TOKEN_INCOMPLETE;
+		}
+
+		type = TOKEN_OTHER;
+	} else if (p[1] == '/') {
+		q = memchr (p, '>', end - p);
+		if (q == NULL)
+			return TOKEN_INCOMPLETE;
+		q++;
+
+		type = TOKEN_END_TAG;
+	} else {
+		/* Start tag; attribute values can contain '>' */
+		for (q = p + 1; q < end && *q != '>'; q++) {
+			if (*q == '"' || *q == '\'') {
+				q = memchr (q + 1, *q, end - q - 1);
+				if (q == NULL)
+					return TOKEN_INCOMPLETE;
+			}
+		}
+
+		if (q == end)
+			return TOKEN_INCOMPLETE;
+
+		type = (q[-1] == '/') ? TOKEN_EMPTY_TAG : TOKEN_START_TAG;
+		q++;
+	}
+
+	*token_start = p - data;
+	*token_end = q - data;
+	self->position = *token_end;
+
+	return type;
+}
+
+/* Skips the element name at the start of the start tag at @p */
+static const gchar *
+skip_element_name (const gchar *p, const gchar *end)
+{
+	for (p++; p < end && g_ascii_isspace (*p) == FALSE && *p != '/' && *p != '>'; p++);
+	return p;
+}
+
+/* Finds the next attribute in a start tag, starting from *@p, and updates *@p to point after it. Returns %FALSE at the end of the tag. */
+static gboolean
+next_attribute (const gchar **p, const gchar *end, const gchar **name, gsize *name_length)
+{
+	const gchar *q = *p, *value_end;
+
+	for (; q < end && g_ascii_isspace (*q); q++);
+	if (q == end || *q == '/' || *q == '>')
+		return FALSE;
+
+	*name = q;
+	for (; q < end && *q != '=' && g_ascii_isspace (*q) == FALSE; q++);
+	*name_length = q - *name;
+
+	for (; q < end && g_ascii_isspace (*q); q++);
+	if (q == end || *q != '=')
+		return FALSE;
+	for (q++; q < end && g_ascii_isspace (*q); q++);
+	if (q == end || (*q != '"' && *q != '\''))
+		return FALSE;
+
+	value_end = memchr (q + 1, *q, end - q - 1);
+	if (value_end == NULL)
+		return FALSE;
+
+	*p = value_end + 1;
+	return TRUE;
+}
+
+static gboolean
+is_namespace_declaration (const gchar *name, gsize name_length)
+{
+	return (name_length >= 5 && strncmp (name, "xmlns", 5) == 0 && (name_length == 5 || name[5] == ':')) ? TRUE : FALSE;
+}
+
+/* Stores the namespace declarations from the root's start tag, so that they can be added to its children */
+static void
+store_root_declarations (GDataXmlScanner *self, const gchar *tag, const gchar *end)
+{
+	const gchar *p, *name;
+	gsize name_length;
+
+	self->root_declarations = g_ptr_array_new_with_free_func (g_free);
+
+	p = skip_element_name (tag, end);
+
+	while (next_attribute (&p, end, &name, &name_length) == TRUE) {
+		if (is_namespace_declaration (name, name_length) == TRUE)
+			g_ptr_array_add (self->root_declarations, g_strndup (name, p - name));
+	}
+}
+
+/* Returns whether the start tag from @tag to @end has an attribute named @name */
+static gboolean
+has_attribute (const gchar *tag, const gchar *end, const gchar *name, gsize name_length)
+{
+	const gchar *p, *attribute_name;
+	gsize attribute_name_length;
+
+	p = skip_element_name (tag, end);
+
+	while (next_attribute (&p, end, &attribute_name, &attribute_name_length) == TRUE) {
+		if (attribute_name_length == name_length && strncmp (attribute_name, name, name_length) == 0)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Scans the next markup token, updating the positions of the root and current child. Returns %FALSE if no progress could be made. */
+static gboolean
+scan_token (GDataXmlScanner *self)
+{
+	gsize start, end;
+	TokenType type;
+
+	type = next_token (self, &start, &end);
+
+	switch (type) {
+		case TOKEN_INCOMPLETE:
+			return FALSE;
+		case TOKEN_INVALID:
+			self->failed = TRUE;
+			return FALSE;
+		case TOKEN_START_TAG:
+		case TOKEN_EMPTY_TAG:
+			if (self->depth == 0) {
+				/* The root; there can only be one, and a UTF-16 document would have nul bytes before it */
+				if (self->root_declarations != NULL || memchr (self->data, '\0', start) != NULL) {
+					self->failed = TRUE;
+					return FALSE;
+				}
+
+				store_root_declarations (self, self->data + start, self->data + end);
+				self->root_start = start;
+				self->root_content_start = end;
+				self->root_end = (type == TOKEN_EMPTY_TAG) ? end : 0;
+			} else if (self->depth == 1) {
+				self->n_children++;
+				self->child_start = start;
+				self->child_content_start = end;
+				self->child_end = (type == TOKEN_EMPTY_TAG) ? end : 0;
+			}
+
+			if (type == TOKEN_START_TAG)
+				self->depth++;
+			break;
+		case TOKEN_END_TAG:
+			if (self->depth == 0) {
+				self->failed = TRUE;
+				return FALSE;
+			}
+
+			self->depth--;
+			if (self->depth == 1)
+				self->child_end = end;
+			else if (self->depth == 0)
+				self->root_end = end;
+			break;
+		case TOKEN_OTHER:
+			break;
+		default:
+			g_assert_not_reached ();
+	}
+
+	return TRUE;
+}
+
+/* Returns a copy of the root element of the document, or %NULL if it can't be found (for example, because the document's incomplete). @length is
+ * set to the length of the copy, and @content_offset to the offset of its content, just after the end of its start tag. Self-closing roots aren't
+ * returned. */
+gchar *
+gdata_xml_scanner_dup_root (GDataXmlScanner *self, gsize *length, gsize *content_offset)
+{
+	while (self->failed == FALSE && self->root_end == 0) {
+		if (scan_token (self) == FALSE)
+			break;
+	}
+
+	if (self->failed == TRUE || self->root_end == 0 || self->discarded > 0 || self->root_content_start == self->root_end)
+		return NULL;
+
+	*length = self->root_end - self->root_start;
+	*content_offset = self->root_content_start - self->root_start;
+
+	return g_strndup (self->data + self->root_start, *length);
+}
+
+/* Returns a copy of the root element's child element with the given @index (counting only elements), or %NULL if it can't be found. Children
+ * must be requested in document order. The namespace declarations on the root element are added to the child's start tag, so that it can be used
+ * out of context. @length and @content_offset are set as for gdata_xml_scanner_dup_root(). Self-closing children aren't returned. */
+gchar *
+gdata_xml_scanner_dup_child (GDataXmlScanner *self, guint index, gsize *length, gsize *content_offset)
+{
+	const gchar *tag, *tag_end;
+	GString *xml_string;
+	guint i;
+
+	while (self->failed == FALSE && self->n_children <= index + 1) {
+		if (self->n_children == index + 1 && self->child_end != 0)
+			break;
+		if (scan_token (self) == FALSE)
+			break;
+	}
+
+	if (self->failed == TRUE || self->n_children != index + 1 || self->child_end == 0 || self->child_content_start == self->child_end)
+		return NULL;
+
+	/* Copy the start tag without its closing bracket, then add any of the root's namespace declarations which it doesn't redefine */
+	tag = self->data + self->child_start;
+	tag_end = self->data + self->child_content_start - 1;
+
+	xml_string = g_string_sized_new (self->child_end - self->child_start + 512);
+	g_string_append_len (xml_string, tag, tag_end - tag);
+
+	for (i = 0; i < self->root_declarations->len; i++) {
+		const gchar *declaration = g_ptr_array_index (self->root_declarations, i);
+		gsize name_length = strcspn (declaration, "= \t\r\n");
+
+		if (has_attribute (tag, tag_end, declaration, name_length) == FALSE) {
+			g_string_append_c (xml_string, ' ');
+			g_string_append (xml_string, declaration);
+		}
+	}
+
+	g_string_append_c (xml_string, '>');
+	*content_offset = xml_string->len;
+
+	g_string_append_len (xml_string, self->data + self->child_content_start, self->child_end - self->child_content_start);
+	*length = xml_string->len;
+
+	/* Nothing before the end of this child will be needed again */
+	discard (self, self->child_end);
+
+	return g_string_free (xml_string, FALSE);
+}
@@ -0,0 +1,60 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_XML_SCANNER_H
+#define GDATA_XML_SCANNER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDataXmlScanner:
+ *
+ * All the fields in the #GDataXmlScanner structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	const gchar *data; /* the document scanned so far, less any which has been discarded; either external or @owned's string */
+	gsize length;
+	GString *owned; /* or %NULL if @data is external */
+	gsize discarded; /* number of bytes discarded from the start of the document */
+	gsize position; /* offset in @data of the next markup to scan */
+	guint depth;
+	gboolean failed;
+
+	GPtrArray *root_declarations; /* owned gchar* namespace declarations from the root's start tag, or %NULL until it's been scanned */
+	gsize root_start, root_content_start, root_end; /* offsets in @data; @root_end is 0 until the root's been completely scanned */
+
+	guint n_children; /* number of the root's child elements whose start tags have been scanned */
+	gsize child_start, child_content_start, child_end; /* of the most recent child; @child_end is 0 until it's been completely scanned */
+} GDataXmlScanner;
+
+void gdata_xml_scanner_init (GDataXmlScanner *self, const gchar *xml, gsize length);
+void gdata_xml_scanner_clear (GDataXmlScanner *self);
+void gdata_xml_scanner_append (GDataXmlScanner *self, const gchar *data, gsize length);
+
+gchar *gdata_xml_scanner_dup_root (GDataXmlScanner *self, gsize *length, gsize *content_offset) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gchar *gdata_xml_scanner_dup_child (GDataXmlScanner *self, guint index, gsize *length, gsize *content_offset) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+G_END_DECLS
+
+#endif /* !GDATA_XML_SCANNER_H */
@@ -23,6 +23,17 @@
 /* Core files */
 #include <gdata/gdata-entry.h>
 #include <gdata/gdata-feed.h>
+#include <gdata/gdata-lite-feed.h>
+#include <gdata/gdata-feed-snapshot.h>
+#include <gdata/gdata-feed-iterator.h>
+#include <gdata/gdata-deadline.h>
+#include <gdata/gdata-entry-store.h>
+#include <gdata/gdata-watch-channel.h>
+#include <gdata/gdata-poll-scheduler.h>
+#include <gdata/gdata-write-queue.h>
+#include <gdata/gdata-cache-manager.h>
+#include <gdata/gdata-blob-store.h>
+#include <gdata/gdata-incremental-parser.h>
 #include <gdata/gdata-service.h>
 #include <gdata/gdata-types.h>
 #include <gdata/gdata-query.h>
@@ -35,6 +46,8 @@
 #include <gdata/gdata-comparable.h>
 #include <gdata/gdata-batchable.h>
 #include <gdata/gdata-batch-operation.h>
+#include <gdata/gdata-upload-queue.h>
+#include <gdata/gdata-thumbnail-prefetcher.h>
 #include <gdata/gdata-authorizer.h>
 #include <gdata/gdata-authorization-domain.h>
 #include <gdata/gdata-client-login-authorizer.h>
@@ -98,6 +111,8 @@
 #include <gdata/services/youtube/gdata-youtube-enums.h>
 #include <gdata/services/youtube/gdata-youtube-category.h>
 #include <gdata/services/youtube/gdata-youtube-comment.h>
+#include <gdata/services/youtube/gdata-youtube-multi-query.h>
+#include <gdata/services/youtube/gdata-youtube-state-poller.h>
 
 /* Google Calendar */
 #include <gdata/services/calendar/gdata-calendar-service.h>
@@ -105,6 +120,10 @@
 #include <gdata/services/calendar/gdata-calendar-calendar.h>
 #include <gdata/services/calendar/gdata-calendar-event.h>
 #include <gdata/services/calendar/gdata-calendar-query.h>
+#include <gdata/services/calendar/gdata-calendar-sync.h>
+#include <gdata/services/calendar/gdata-calendar-event-expander.h>
+#include <gdata/services/calendar/gdata-calendar-free-busy-index.h>
+#include <gdata/services/calendar/gdata-calendar-calendar-list.h>
 
 /* Google PicasaWeb */
 #include <gdata/services/picasaweb/gdata-picasaweb-service.h>
@@ -121,6 +140,10 @@
 #include <gdata/services/contacts/gdata-contacts-contact.h>
 #include <gdata/services/contacts/gdata-contacts-group.h>
 #include <gdata/services/contacts/gdata-contacts-query.h>
+#include <gdata/services/contacts/gdata-contacts-sync.h>
+#include <gdata/services/contacts/gdata-contacts-group-index.h>
+#include <gdata/services/contacts/gdata-contacts-contact-summary.h>
+#include <gdata/services/contacts/gdata-contacts-merge-index.h>
 
 /* Google Documents*/
 #include <gdata/services/documents/gdata-documents-entry.h>
@@ -129,6 +152,8 @@
 #include <gdata/services/documents/gdata-documents-spreadsheet.h>
 #include <gdata/services/documents/gdata-documents-presentation.h>
 #include <gdata/services/documents/gdata-documents-folder.h>
+#include <gdata/services/documents/gdata-documents-folder-tree.h>
+#include <gdata/services/documents/gdata-documents-sync.h>
 #include <gdata/services/documents/gdata-documents-query.h>
 #include <gdata/services/documents/gdata-documents-service.h>
 #include <gdata/services/documents/gdata-documents-feed.h>
@@ -142,5 +167,6 @@
 #include <gdata/services/tasks/gdata-tasks-query.h>
 #include <gdata/services/tasks/gdata-tasks-tasklist.h>
 #include <gdata/services/tasks/gdata-tasks-task.h>
+#include <gdata/services/tasks/gdata-tasks-sync.h>
 
 #endif /* !GDATA_H */
@@ -571,3 +571,42 @@ gdata_media_content_download (GDataMediaContent *self, GDataService *service, GC
 	src_uri = gdata_media_content_get_uri (self);
 	return GDATA_DOWNLOAD_STREAM (gdata_download_stream_new (service, NULL, src_uri, cancellable));
 }
+
+/**
+ * gdata_media_content_download_to_file:
+ * @self: a #GDataMediaContent
+ * @service: the #GDataService
+ * @destination: the #GFile to save the content to
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Downloads the content represented by @self to @destination, such as the original of a PicasaWeb photo or video. The content is written straight
+ * to @destination as it's received, using gdata_download_stream_download_to_file(), which is more efficient than splicing the stream returned by
+ * gdata_media_content_download() into a file. @destination is created if it doesn't exist and overwritten if it does; if the download fails, its
+ * contents are undefined.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_media_content_download_to_file (GDataMediaContent *self, GDataService *service, GFile *destination, GCancellable *cancellable, GError **error)
+{
+	GDataDownloadStream *download_stream;
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_MEDIA_CONTENT (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_FILE (destination), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	download_stream = gdata_media_content_download (self, service, cancellable, error);
+	if (download_stream == NULL)
+		return FALSE;
+
+	success = gdata_download_stream_download_to_file (download_stream, destination, cancellable, error);
+	g_object_unref (download_stream);
+
+	return success;
+}
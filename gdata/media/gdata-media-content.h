@@ -110,6 +110,8 @@ guint gdata_media_content_get_width (GDataMediaContent *self) G_GNUC_PURE;
 
 GDataDownloadStream *gdata_media_content_download (GDataMediaContent *self, GDataService *service, GCancellable *cancellable,
                                                    GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gboolean gdata_media_content_download_to_file (GDataMediaContent *self, GDataService *service, GFile *destination, GCancellable *cancellable,
+                                               GError **error);
 
 G_END_DECLS
 
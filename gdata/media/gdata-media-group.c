@@ -50,11 +50,20 @@ static void gdata_media_group_finalize (GObject *object);
 static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
+static void set_restricted_in_country (GDataMediaGroup *self, gchar *country, gboolean restricted);
+
+/* Two-letter upper-case country codes (i.e. all ISO 3166-1 alpha-2 codes) are stored in a bitset, indexed by COUNTRY_INDEX; anything else goes
+ * in the restricted_countries hash table. */
+#define IS_COUNTRY_CODE(C) (g_ascii_isupper ((C)[0]) && g_ascii_isupper ((C)[1]) && (C)[2] == '\0')
+#define COUNTRY_INDEX(C) (((C)[0] - 'A') * 26 + ((C)[1] - 'A'))
+#define N_COUNTRY_WORDS ((26 * 26 + 31) / 32)
 
 struct _GDataMediaGroupPrivate {
 	gchar **keywords;
 	gchar *player_uri;
-	GHashTable *restricted_countries;
+	guint32 restricted_country_codes[N_COUNTRY_WORDS]; /* bitset of COUNTRY_INDEX()es */
+	gboolean restricted_in_all_countries;
+	GHashTable *restricted_countries; /* any other country strings */
 	gchar *simple_rating;
 	gchar *mpaa_rating;
 	gchar *v_chip_rating;
@@ -62,6 +71,7 @@ struct _GDataMediaGroupPrivate {
 	gchar *title;
 	GDataMediaCategory *category;
 	GList *contents; /* GDataMediaContent */
+	GHashTable *contents_by_type; /* content type (owned by the GDataMediaContent) → GDataMediaContent (owned by contents) */
 	GDataMediaCredit *credit;
 	gchar *description;
 };
@@ -91,6 +101,7 @@ gdata_media_group_init (GDataMediaGroup *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_MEDIA_GROUP, GDataMediaGroupPrivate);
 	self->priv->restricted_countries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	self->priv->contents_by_type = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 static void
@@ -106,6 +117,8 @@ gdata_media_group_dispose (GObject *object)
 		g_object_unref (priv->credit);
 	priv->credit = NULL;
 
+	g_hash_table_remove_all (priv->contents_by_type);
+
 	if (priv->contents != NULL) {
 		g_list_foreach (priv->contents, (GFunc) g_object_unref, NULL);
 		g_list_free (priv->contents);
@@ -133,6 +146,7 @@ gdata_media_group_finalize (GObject *object)
 	g_free (priv->mpaa_rating);
 	g_free (priv->simple_rating);
 	g_hash_table_destroy (priv->restricted_countries);
+	g_hash_table_destroy (priv->contents_by_type);
 	g_free (priv->title);
 	g_free (priv->description);
 
@@ -236,13 +250,13 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 
 					/* Add all the listed countries to the restricted countries table */
 					for (country = country_list; *country != NULL; country++) {
-						g_hash_table_insert (self->priv->restricted_countries, *country, GUINT_TO_POINTER (TRUE));
+						set_restricted_in_country (self, *country, TRUE);
 					}
 
 					g_free (country_list);
 				} else {
 					/* Assume it's restricted in all countries */
-					g_hash_table_insert (self->priv->restricted_countries, g_strdup ("all"), GUINT_TO_POINTER (TRUE));
+					self->priv->restricted_in_all_countries = TRUE;
 				}
 
 				success = TRUE;
@@ -286,12 +300,12 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 			country_list = g_strsplit ((const gchar*) countries, " ", -1);
 			xmlFree (countries);
 
-			/* Add "all" to the table, since it's an exception table */
-			g_hash_table_insert (self->priv->restricted_countries, g_strdup ("all"), GUINT_TO_POINTER (!relationship_bool));
+			/* Set the default for all countries, since the list is a list of exceptions */
+			self->priv->restricted_in_all_countries = !relationship_bool;
 
 			/* Add all the listed countries to the restricted countries table */
 			for (country = country_list; *country != NULL; country++)
-				g_hash_table_insert (self->priv->restricted_countries, *country, GUINT_TO_POINTER (relationship_bool));
+				set_restricted_in_country (self, *country, relationship_bool);
 			g_free (country_list);
 		} else {
 			return GDATA_PARSABLE_CLASS (gdata_media_group_parent_class)->parse_xml (parsable, doc, node, user_data, error);
@@ -500,12 +514,6 @@ gdata_media_group_set_category (GDataMediaGroup *self, GDataMediaCategory *categ
 	self->priv->category = (category == NULL) ? NULL : g_object_ref (category);
 }
 
-static gint
-content_compare_cb (const GDataMediaContent *content, const gchar *type)
-{
-	return strcmp (gdata_media_content_get_content_type ((GDataMediaContent*) content), type);
-}
-
 /**
  * gdata_media_group_look_up_content:
  * @self: a #GDataMediaGroup
@@ -519,16 +527,10 @@ content_compare_cb (const GDataMediaContent *content, const gchar *type)
 GDataMediaContent *
 gdata_media_group_look_up_content (GDataMediaGroup *self, const gchar *type)
 {
-	GList *element;
-
 	g_return_val_if_fail (GDATA_IS_MEDIA_GROUP (self), NULL);
 	g_return_val_if_fail (type != NULL, NULL);
 
-	/* TODO: If type is required, and is unique, the contents can be stored in a hash table rather than a linked list */
-	element = g_list_find_custom (self->priv->contents, type, (GCompareFunc) content_compare_cb);
-	if (element == NULL)
-		return NULL;
-	return GDATA_MEDIA_CONTENT (element->data);
+	return g_hash_table_lookup (self->priv->contents_by_type, type);
 }
 
 /**
@@ -549,9 +551,17 @@ gdata_media_group_get_contents (GDataMediaGroup *self)
 void
 _gdata_media_group_add_content (GDataMediaGroup *self, GDataMediaContent *content)
 {
+	const gchar *type;
+
 	g_return_if_fail (GDATA_IS_MEDIA_GROUP (self));
 	g_return_if_fail (GDATA_IS_MEDIA_CONTENT (content));
+
 	self->priv->contents = g_list_prepend (self->priv->contents, g_object_ref (content));
+
+	/* Index the content by type. Later contents take precedence over earlier ones with the same type, as they are earlier in the list. */
+	type = gdata_media_content_get_content_type (content);
+	if (type != NULL)
+		g_hash_table_insert (self->priv->contents_by_type, (gpointer) type, content);
 }
 
 /**
@@ -611,10 +621,38 @@ gdata_media_group_is_restricted_in_country (GDataMediaGroup *self, const gchar *
 	g_return_val_if_fail (GDATA_IS_MEDIA_GROUP (self), FALSE);
 	g_return_val_if_fail (country != NULL && *country != '\0', FALSE);
 
-	if (GPOINTER_TO_UINT (g_hash_table_lookup (self->priv->restricted_countries, country)) == TRUE)
+	if (IS_COUNTRY_CODE (country)) {
+		guint i = COUNTRY_INDEX (country);
+
+		if (self->priv->restricted_country_codes[i / 32] & (1U << (i % 32)))
+			return TRUE;
+	} else if (GPOINTER_TO_UINT (g_hash_table_lookup (self->priv->restricted_countries, country)) == TRUE) {
 		return TRUE;
+	}
+
+	return self->priv->restricted_in_all_countries;
+}
 
-	return GPOINTER_TO_UINT (g_hash_table_lookup (self->priv->restricted_countries, "all"));
+/* Takes ownership of @country */
+static void
+set_restricted_in_country (GDataMediaGroup *self, gchar *country, gboolean restricted)
+{
+	if (IS_COUNTRY_CODE (country)) {
+		guint i = COUNTRY_INDEX (country);
+
+		if (restricted == TRUE)
+			self->priv->restricted_country_codes[i / 32] |= (1U << (i % 32));
+		else
+			self->priv->restricted_country_codes[i / 32] &= ~(1U << (i % 32));
+
+		g_free (country);
+	} else if (strcmp (country, "all") == 0) {
+		/* The mediarating country list may be the value "all" */
+		self->priv->restricted_in_all_countries = restricted;
+		g_free (country);
+	} else {
+		g_hash_table_insert (self->priv->restricted_countries, country, GUINT_TO_POINTER (restricted));
+	}
 }
 
 /**
@@ -0,0 +1,702 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-calendar-calendar-list
+ * @short_description: GData Calendar cached calendar list
+ * @stability: Unstable
+ * @include: gdata/services/calendar/gdata-calendar-calendar-list.h
+ *
+ * #GDataCalendarCalendarList keeps a parsed copy of the list of calendars returned by gdata_calendar_service_query_all_calendars() or
+ * gdata_calendar_service_query_own_calendars(), so that clients which refresh their calendar list regularly don't have to download and parse the
+ * whole list each time. The list rarely changes, so each refresh is made conditional on the ETag of the previous version of the list; if the list
+ * hasn't changed, the server responds without sending it, and the cached #GDataCalendarCalendar<!-- -->s are kept as they are.
+ *
+ * There is one list of all calendars and one list of owned calendars for each #GDataCalendarService, and they are shared between all the callers
+ * of gdata_calendar_calendar_list_get_for_service() for as long as any of them holds a reference to the list.
+ *
+ * When a refresh finds the list has changed, the #GDataCalendarCalendarList::calendar-added, #GDataCalendarCalendarList::calendar-removed and
+ * #GDataCalendarCalendarList::calendar-changed signals are emitted for each calendar which differs from the cached version, as judged by the
+ * calendars' ETags. Calendars which haven't changed are left as the same #GDataCalendarCalendar instances, so signal handlers and any references
+ * held by other code remain valid.
+ *
+ * <example>
+ *	<title>Keeping a Calendar List Up To Date</title>
+ *	<programlisting>
+ *	static void
+ *	calendar_added_cb (GDataCalendarCalendarList *list, GDataCalendarCalendar *calendar, gpointer user_data)
+ *	{
+ *		/<!-- -->* Add the calendar to the UI *<!-- -->/
+ *		add_calendar_to_ui (user_data, calendar);
+ *	}
+ *
+ *	GDataCalendarCalendarList *list;
+ *	GError *error = NULL;
+ *
+ *	list = gdata_calendar_calendar_list_get_for_service (service, FALSE);
+ *	g_signal_connect (list, "calendar-added", (GCallback) calendar_added_cb, ui);
+ *
+ *	/<!-- -->* Call this every time the UI is refreshed; it's cheap if the calendar list hasn't changed *<!-- -->/
+ *	if (gdata_calendar_calendar_list_refresh (list, NULL, &error) == FALSE) {
+ *		g_error ("Error refreshing calendar list: %s", error->message);
+ *		g_error_free (error);
+ *	}
+ *
+ *	g_object_unref (list);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+
+#include "gdata-calendar-calendar-list.h"
+#include "gdata-query.h"
+#include "gdata-service.h"
+
+/* Key for the SharedLists on a GDataCalendarService */
+#define SHARED_LISTS_KEY "gdata-calendar-calendar-lists"
+
+typedef struct {
+	GWeakRef all_calendars; /* GDataCalendarCalendarList */
+	GWeakRef own_calendars; /* GDataCalendarCalendarList */
+} SharedLists;
+
+static void gdata_calendar_calendar_list_dispose (GObject *object);
+static void gdata_calendar_calendar_list_finalize (GObject *object);
+static void gdata_calendar_calendar_list_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_calendar_calendar_list_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataCalendarCalendarListPrivate {
+	GDataCalendarService *service;
+	gboolean own_calendars;
+
+	/* The cached list. These are only touched with ->mutex held, since refreshes may happen in several threads. */
+	GMutex mutex;
+	GPtrArray *calendars; /* GDataCalendarCalendar (reffed), in the order the server returned them */
+	GHashTable *calendars_by_id; /* calendar ID → GDataCalendarCalendar (both owned by ->calendars) */
+	gchar *etag; /* ETag of the cached list, or NULL if it hasn't been loaded yet */
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_OWN_CALENDARS,
+};
+
+enum {
+	SIGNAL_CALENDAR_ADDED,
+	SIGNAL_CALENDAR_REMOVED,
+	SIGNAL_CALENDAR_CHANGED,
+	LAST_SIGNAL
+};
+
+static guint calendar_list_signals[LAST_SIGNAL] = { 0, };
+
+G_LOCK_DEFINE_STATIC (shared_lists);
+
+G_DEFINE_TYPE (GDataCalendarCalendarList, gdata_calendar_calendar_list, G_TYPE_OBJECT)
+
+static void
+gdata_calendar_calendar_list_class_init (GDataCalendarCalendarListClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataCalendarCalendarListPrivate));
+
+	gobject_class->dispose = gdata_calendar_calendar_list_dispose;
+	gobject_class->finalize = gdata_calendar_calendar_list_finalize;
+	gobject_class->get_property = gdata_calendar_calendar_list_get_property;
+	gobject_class->set_property = gdata_calendar_calendar_list_set_property;
+
+	/**
+	 * GDataCalendarCalendarList:service:
+	 *
+	 * The service the calendar list is queried with.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service the calendar list is queried with.",
+	                                                      GDATA_TYPE_CALENDAR_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataCalendarCalendarList:own-calendars:
+	 *
+	 * Whether the list only contains the calendars owned by the authenticated user, as returned by
+	 * gdata_calendar_service_query_own_calendars(), rather than all the calendars they can access, as returned by
+	 * gdata_calendar_service_query_all_calendars().
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_OWN_CALENDARS,
+	                                 g_param_spec_boolean ("own-calendars",
+	                                                       "Own calendars?", "Whether the list only contains the user's own calendars.",
+	                                                       FALSE,
+	                                                       G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataCalendarCalendarList::calendar-added:
+	 * @list: the #GDataCalendarCalendarList which changed
+	 * @calendar: the calendar which was added
+	 *
+	 * The #GDataCalendarCalendarList::calendar-added signal is emitted when a refresh finds a calendar which wasn't in the previous version of
+	 * the list, including for every calendar when the list is first loaded.
+	 *
+	 * It's emitted in the thread which called gdata_calendar_calendar_list_refresh(), or in the main context which called
+	 * gdata_calendar_calendar_list_refresh_async().
+	 *
+	 * Since: 0.15.0
+	 */
+	calendar_list_signals[SIGNAL_CALENDAR_ADDED] = g_signal_new ("calendar-added",
+	                                                             G_TYPE_FROM_CLASS (klass),
+	                                                             G_SIGNAL_RUN_LAST,
+	                                                             0, NULL, NULL,
+	                                                             g_cclosure_marshal_VOID__OBJECT,
+	                                                             G_TYPE_NONE, 1, GDATA_TYPE_CALENDAR_CALENDAR);
+
+	/**
+	 * GDataCalendarCalendarList::calendar-removed:
+	 * @list: the #GDataCalendarCalendarList which changed
+	 * @calendar: the cached version of the calendar which was removed
+	 *
+	 * The #GDataCalendarCalendarList::calendar-removed signal is emitted when a refresh finds that a calendar in the previous version of the list
+	 * is no longer in it. It's emitted in the same thread as #GDataCalendarCalendarList::calendar-added.
+	 *
+	 * Since: 0.15.0
+	 */
+	calendar_list_signals[SIGNAL_CALENDAR_REMOVED] = g_signal_new ("calendar-removed",
+	                                                               G_TYPE_FROM_CLASS (klass),
+	                                                               G_SIGNAL_RUN_LAST,
+	                                                               0, NULL, NULL,
+	                                                               g_cclosure_marshal_VOID__OBJECT,
+	                                                               G_TYPE_NONE, 1, GDATA_TYPE_CALENDAR_CALENDAR);
+
+	/**
+	 * GDataCalendarCalendarList::calendar-changed:
+	 * @list: the #GDataCalendarCalendarList which changed
+	 * @calendar: the new version of the calendar
+	 *
+	 * The #GDataCalendarCalendarList::calendar-changed signal is emitted when a refresh finds that a calendar in the list has a different ETag
+	 * from its cached version. The new version replaces the cached one in the list. It's emitted in the same thread as
+	 * #GDataCalendarCalendarList::calendar-added.
+	 *
+	 * Since: 0.15.0
+	 */
+	calendar_list_signals[SIGNAL_CALENDAR_CHANGED] = g_signal_new ("calendar-changed",
+	                                                               G_TYPE_FROM_CLASS (klass),
+	                                                               G_SIGNAL_RUN_LAST,
+	                                                               0, NULL, NULL,
+	                                                               g_cclosure_marshal_VOID__OBJECT,
+	                                                               G_TYPE_NONE, 1, GDATA_TYPE_CALENDAR_CALENDAR);
+}
+
+static void
+gdata_calendar_calendar_list_init (GDataCalendarCalendarList *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CALENDAR_CALENDAR_LIST, GDataCalendarCalendarListPrivate);
+
+	g_mutex_init (&(self->priv->mutex));
+	self->priv->calendars = g_ptr_array_new_with_free_func (g_object_unref);
+	self->priv->calendars_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+}
+
+static void
+gdata_calendar_calendar_list_dispose (GObject *object)
+{
+	GDataCalendarCalendarListPrivate *priv = GDATA_CALENDAR_CALENDAR_LIST (object)->priv;
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_calendar_calendar_list_parent_class)->dispose (object);
+}
+
+static void
+gdata_calendar_calendar_list_finalize (GObject *object)
+{
+	GDataCalendarCalendarListPrivate *priv = GDATA_CALENDAR_CALENDAR_LIST (object)->priv;
+
+	g_hash_table_unref (priv->calendars_by_id);
+	g_ptr_array_unref (priv->calendars);
+	g_free (priv->etag);
+	g_mutex_clear (&(priv->mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_calendar_calendar_list_parent_class)->finalize (object);
+}
+
+static void
+gdata_calendar_calendar_list_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataCalendarCalendarListPrivate *priv = GDATA_CALENDAR_CALENDAR_LIST (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_OWN_CALENDARS:
+			g_value_set_boolean (value, priv->own_calendars);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_calendar_calendar_list_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataCalendarCalendarListPrivate *priv = GDATA_CALENDAR_CALENDAR_LIST (object)->priv;
+
+	switch (property_id) {
+		/* Construct only */
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_OWN_CALENDARS:
+			priv->own_calendars = g_value_get_boolean (value);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+shared_lists_free (SharedLists *shared)
+{
+	g_weak_ref_clear (&(shared->all_calendars));
+	g_weak_ref_clear (&(shared->own_calendars));
+	g_slice_free (SharedLists, shared);
+}
+
+/**
+ * gdata_calendar_calendar_list_get_for_service:
+ * @service: a #GDataCalendarService
+ * @own_calendars: %TRUE to get the list of the authenticated user's own calendars, %FALSE to get the list of all the calendars they can access
+ *
+ * Gets the shared cached calendar list for @service. If another caller already holds a reference to the list, the same instance is returned;
+ * otherwise a new, empty list is created. Call gdata_calendar_calendar_list_refresh() to load it.
+ *
+ * The list holds a reference to @service.
+ *
+ * Return value: (transfer full): the #GDataCalendarCalendarList for @service; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataCalendarCalendarList *
+gdata_calendar_calendar_list_get_for_service (GDataCalendarService *service, gboolean own_calendars)
+{
+	SharedLists *shared;
+	GWeakRef *weak_ref;
+	GDataCalendarCalendarList *list;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SERVICE (service), NULL);
+
+	G_LOCK (shared_lists);
+
+	/* The service only holds weak references to its lists, since they hold strong references to it */
+	shared = g_object_get_data (G_OBJECT (service), SHARED_LISTS_KEY);
+	if (shared == NULL) {
+		shared = g_slice_new (SharedLists);
+		g_weak_ref_init (&(shared->all_calendars), NULL);
+		g_weak_ref_init (&(shared->own_calendars), NULL);
+		g_object_set_data_full (G_OBJECT (service), SHARED_LISTS_KEY, shared, (GDestroyNotify) shared_lists_free);
+	}
+
+	weak_ref = (own_calendars == TRUE) ? &(shared->own_calendars) : &(shared->all_calendars);
+	list = g_weak_ref_get (weak_ref);
+
+	if (list == NULL) {
+		list = g_object_new (GDATA_TYPE_CALENDAR_CALENDAR_LIST, "service", service, "own-calendars", own_calendars, NULL);
+		g_weak_ref_set (weak_ref, list);
+	}
+
+	G_UNLOCK (shared_lists);
+
+	return list;
+}
+
+/**
+ * gdata_calendar_calendar_list_get_service:
+ * @self: a #GDataCalendarCalendarList
+ *
+ * Gets the #GDataCalendarCalendarList:service property.
+ *
+ * Return value: (transfer none): the list's service
+ *
+ * Since: 0.15.0
+ */
+GDataCalendarService *
+gdata_calendar_calendar_list_get_service (GDataCalendarCalendarList *self)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_CALENDAR_LIST (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_calendar_calendar_list_get_own_calendars:
+ * @self: a #GDataCalendarCalendarList
+ *
+ * Gets the #GDataCalendarCalendarList:own-calendars property.
+ *
+ * Return value: %TRUE if the list only contains the user's own calendars, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_calendar_list_get_own_calendars (GDataCalendarCalendarList *self)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_CALENDAR_LIST (self), FALSE);
+	return self->priv->own_calendars;
+}
+
+/* Builds a query which is conditional on the cached version of the list, if there is one */
+static GDataQuery *
+build_refresh_query (GDataCalendarCalendarList *self)
+{
+	GDataQuery *query;
+
+	query = gdata_query_new (NULL);
+
+	g_mutex_lock (&(self->priv->mutex));
+	if (self->priv->etag != NULL)
+		gdata_query_set_etag (query, self->priv->etag);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return query;
+}
+
+static gboolean
+calendar_differs (GDataCalendarCalendar *old_calendar, GDataCalendarCalendar *new_calendar)
+{
+	const gchar *old_etag, *new_etag;
+
+	old_etag = gdata_entry_get_etag (GDATA_ENTRY (old_calendar));
+	new_etag = gdata_entry_get_etag (GDATA_ENTRY (new_calendar));
+
+	if (old_etag != NULL && new_etag != NULL)
+		return (strcmp (old_etag, new_etag) != 0) ? TRUE : FALSE;
+
+	return (gdata_entry_get_updated (GDATA_ENTRY (old_calendar)) != gdata_entry_get_updated (GDATA_ENTRY (new_calendar))) ? TRUE : FALSE;
+}
+
+static void
+emit_calendar_signals (GDataCalendarCalendarList *self, guint signal_id, GPtrArray *calendars)
+{
+	guint i;
+
+	for (i = 0; i < calendars->len; i++)
+		g_signal_emit (self, calendar_list_signals[signal_id], 0, g_ptr_array_index (calendars, i));
+}
+
+/* Replaces the cached list with the calendars in @feed, keeping the cached instances of any which haven't changed, and emits signals for the
+ * differences. */
+static void
+apply_feed (GDataCalendarCalendarList *self, GDataFeed *feed)
+{
+	GDataCalendarCalendarListPrivate *priv = self->priv;
+	GPtrArray *calendars, *added, *removed, *changed;
+	GHashTable *calendars_by_id;
+	GHashTableIter iter;
+	GDataCalendarCalendar *calendar;
+	GList *i;
+
+	calendars = g_ptr_array_new_with_free_func (g_object_unref);
+	calendars_by_id = g_hash_table_new (g_str_hash, g_str_equal);
+	added = g_ptr_array_new_with_free_func (g_object_unref);
+	removed = g_ptr_array_new_with_free_func (g_object_unref);
+	changed = g_ptr_array_new_with_free_func (g_object_unref);
+
+	g_mutex_lock (&(priv->mutex));
+
+	for (i = gdata_feed_get_entries (feed); i != NULL; i = i->next) {
+		GDataCalendarCalendar *old_calendar;
+		const gchar *calendar_id;
+
+		if (GDATA_IS_CALENDAR_CALENDAR (i->data) == FALSE)
+			continue;
+
+		calendar = GDATA_CALENDAR_CALENDAR (i->data);
+		calendar_id = gdata_entry_get_id (GDATA_ENTRY (calendar));
+
+		if (calendar_id == NULL || g_hash_table_lookup (calendars_by_id, calendar_id) != NULL)
+			continue;
+
+		/* Entries left in ->calendars_by_id at the end have been removed */
+		old_calendar = g_hash_table_lookup (priv->calendars_by_id, calendar_id);
+		g_hash_table_remove (priv->calendars_by_id, calendar_id);
+
+		if (old_calendar == NULL) {
+			g_ptr_array_add (added, g_object_ref (calendar));
+		} else if (calendar_differs (old_calendar, calendar) == TRUE) {
+			g_ptr_array_add (changed, g_object_ref (calendar));
+		} else {
+			/* Keep the existing instance */
+			calendar = old_calendar;
+		}
+
+		g_ptr_array_add (calendars, g_object_ref (calendar));
+		g_hash_table_insert (calendars_by_id, (gpointer) gdata_entry_get_id (GDATA_ENTRY (calendar)), calendar);
+	}
+
+	g_hash_table_iter_init (&iter, priv->calendars_by_id);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &calendar) == TRUE)
+		g_ptr_array_add (removed, g_object_ref (calendar));
+
+	g_hash_table_unref (priv->calendars_by_id);
+	g_ptr_array_unref (priv->calendars);
+	priv->calendars = calendars;
+	priv->calendars_by_id = calendars_by_id;
+
+	g_free (priv->etag);
+	priv->etag = g_strdup (gdata_feed_get_etag (feed));
+
+	g_mutex_unlock (&(priv->mutex));
+
+	/* Emit the signals without the lock held, so that handlers can query the list */
+	emit_calendar_signals (self, SIGNAL_CALENDAR_REMOVED, removed);
+	emit_calendar_signals (self, SIGNAL_CALENDAR_CHANGED, changed);
+	emit_calendar_signals (self, SIGNAL_CALENDAR_ADDED, added);
+
+	g_ptr_array_unref (added);
+	g_ptr_array_unref (removed);
+	g_ptr_array_unref (changed);
+}
+
+/**
+ * gdata_calendar_calendar_list_refresh:
+ * @self: a #GDataCalendarCalendarList
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Refreshes the list from the server. If the list has been loaded before, the query is conditional on its ETag, so nothing is downloaded or parsed
+ * if the list hasn't changed. Otherwise, the cached list is updated and the #GDataCalendarCalendarList::calendar-added,
+ * #GDataCalendarCalendarList::calendar-removed and #GDataCalendarCalendarList::calendar-changed signals are emitted in this thread for the
+ * calendars which differ.
+ *
+ * Errors are as for gdata_calendar_service_query_all_calendars(); if an error occurs, the cached list is left unchanged.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_calendar_list_refresh (GDataCalendarCalendarList *self, GCancellable *cancellable, GError **error)
+{
+	GDataQuery *query;
+	GDataFeed *feed;
+	GError *child_error = NULL;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_CALENDAR_LIST (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	query = build_refresh_query (self);
+
+	if (self->priv->own_calendars == TRUE)
+		feed = gdata_calendar_service_query_own_calendars (self->priv->service, query, cancellable, NULL, NULL, &child_error);
+	else
+		feed = gdata_calendar_service_query_all_calendars (self->priv->service, query, cancellable, NULL, NULL, &child_error);
+
+	g_object_unref (query);
+
+	if (child_error != NULL) {
+		g_clear_object (&feed);
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	/* A NULL feed without an error means the list hasn't changed since it was cached */
+	if (feed != NULL) {
+		apply_feed (self, feed);
+		g_object_unref (feed);
+	}
+
+	return TRUE;
+}
+
+static void
+refresh_query_cb (GDataService *service, GAsyncResult *async_result, GSimpleAsyncResult *result)
+{
+	GDataCalendarCalendarList *self;
+	GDataFeed *feed;
+	GError *error = NULL;
+
+	self = GDATA_CALENDAR_CALENDAR_LIST (g_async_result_get_source_object (G_ASYNC_RESULT (result)));
+	feed = gdata_service_query_finish (service, async_result, &error);
+
+	if (error != NULL) {
+		g_clear_object (&feed);
+		g_simple_async_result_take_error (result, error);
+	} else {
+		/* Apply the changes here, so the signals are emitted in the caller's main context */
+		if (feed != NULL) {
+			apply_feed (self, feed);
+			g_object_unref (feed);
+		}
+
+		g_simple_async_result_set_op_res_gboolean (result, TRUE);
+	}
+
+	g_simple_async_result_complete (result);
+
+	g_object_unref (result);
+	g_object_unref (self);
+}
+
+/**
+ * gdata_calendar_calendar_list_refresh_async:
+ * @self: a #GDataCalendarCalendarList
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the refresh is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Refreshes the list from the server. @self is reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_calendar_calendar_list_refresh(), which is the synchronous version of this function. The list's signals are
+ * emitted in the thread-default main context of the caller, just before @callback is called.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_calendar_calendar_list_refresh_finish() to get the results
+ * of the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_calendar_list_refresh_async (GDataCalendarCalendarList *self, GCancellable *cancellable, GAsyncReadyCallback callback,
+                                            gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	GDataQuery *query;
+
+	g_return_if_fail (GDATA_IS_CALENDAR_CALENDAR_LIST (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_calendar_calendar_list_refresh_async);
+	query = build_refresh_query (self);
+
+	if (self->priv->own_calendars == TRUE) {
+		gdata_calendar_service_query_own_calendars_async (self->priv->service, query, cancellable, NULL, NULL, NULL,
+		                                                  (GAsyncReadyCallback) refresh_query_cb, result);
+	} else {
+		gdata_calendar_service_query_all_calendars_async (self->priv->service, query, cancellable, NULL, NULL, NULL,
+		                                                  (GAsyncReadyCallback) refresh_query_cb, result);
+	}
+
+	g_object_unref (query);
+}
+
+/**
+ * gdata_calendar_calendar_list_refresh_finish:
+ * @self: a #GDataCalendarCalendarList
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous refresh operation started with gdata_calendar_calendar_list_refresh_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_calendar_list_refresh_finish (GDataCalendarCalendarList *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_CALENDAR_LIST (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_calendar_calendar_list_refresh_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	return g_simple_async_result_get_op_res_gboolean (result);
+}
+
+/**
+ * gdata_calendar_calendar_list_get_calendars:
+ * @self: a #GDataCalendarCalendarList
+ *
+ * Gets the calendars in the cached list, in the order the server returned them. This doesn't contact the server; if the list hasn't been
+ * refreshed yet, it's empty.
+ *
+ * Return value: (element-type GData.CalendarCalendar) (transfer full): a list of #GDataCalendarCalendar<!-- -->s, or %NULL; free with
+ * g_list_free_full() and g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_calendar_calendar_list_get_calendars (GDataCalendarCalendarList *self)
+{
+	GList *calendars = NULL;
+	guint i;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_CALENDAR_LIST (self), NULL);
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	for (i = self->priv->calendars->len; i > 0; i--)
+		calendars = g_list_prepend (calendars, g_object_ref (g_ptr_array_index (self->priv->calendars, i - 1)));
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return calendars;
+}
+
+/**
+ * gdata_calendar_calendar_list_look_up_calendar:
+ * @self: a #GDataCalendarCalendarList
+ * @calendar_id: the ID of the calendar to look up, as returned by gdata_entry_get_id()
+ *
+ * Looks up the calendar with ID @calendar_id in the cached list. This doesn't contact the server.
+ *
+ * Return value: (transfer full) (allow-none): the #GDataCalendarCalendar, or %NULL if it isn't in the list; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataCalendarCalendar *
+gdata_calendar_calendar_list_look_up_calendar (GDataCalendarCalendarList *self, const gchar *calendar_id)
+{
+	GDataCalendarCalendar *calendar;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_CALENDAR_LIST (self), NULL);
+	g_return_val_if_fail (calendar_id != NULL, NULL);
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	calendar = g_hash_table_lookup (self->priv->calendars_by_id, calendar_id);
+	if (calendar != NULL)
+		g_object_ref (calendar);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return calendar;
+}
@@ -0,0 +1,87 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_CALENDAR_CALENDAR_LIST_H
+#define GDATA_CALENDAR_CALENDAR_LIST_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/services/calendar/gdata-calendar-calendar.h>
+#include <gdata/services/calendar/gdata-calendar-service.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_CALENDAR_CALENDAR_LIST		(gdata_calendar_calendar_list_get_type ())
+#define GDATA_CALENDAR_CALENDAR_LIST(o) \
+	(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CALENDAR_CALENDAR_LIST, GDataCalendarCalendarList))
+#define GDATA_CALENDAR_CALENDAR_LIST_CLASS(k) \
+	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CALENDAR_CALENDAR_LIST, GDataCalendarCalendarListClass))
+#define GDATA_IS_CALENDAR_CALENDAR_LIST(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CALENDAR_CALENDAR_LIST))
+#define GDATA_IS_CALENDAR_CALENDAR_LIST_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_CALENDAR_CALENDAR_LIST))
+#define GDATA_CALENDAR_CALENDAR_LIST_GET_CLASS(o) \
+	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_CALENDAR_CALENDAR_LIST, GDataCalendarCalendarListClass))
+
+typedef struct _GDataCalendarCalendarListPrivate	GDataCalendarCalendarListPrivate;
+
+/**
+ * GDataCalendarCalendarList:
+ *
+ * All the fields in the #GDataCalendarCalendarList structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataCalendarCalendarListPrivate *priv;
+} GDataCalendarCalendarList;
+
+/**
+ * GDataCalendarCalendarListClass:
+ *
+ * All the fields in the #GDataCalendarCalendarListClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataCalendarCalendarListClass;
+
+GType gdata_calendar_calendar_list_get_type (void) G_GNUC_CONST;
+
+GDataCalendarCalendarList *gdata_calendar_calendar_list_get_for_service (GDataCalendarService *service,
+                                                                         gboolean own_calendars) G_GNUC_WARN_UNUSED_RESULT;
+
+GDataCalendarService *gdata_calendar_calendar_list_get_service (GDataCalendarCalendarList *self) G_GNUC_PURE;
+gboolean gdata_calendar_calendar_list_get_own_calendars (GDataCalendarCalendarList *self) G_GNUC_PURE;
+
+gboolean gdata_calendar_calendar_list_refresh (GDataCalendarCalendarList *self, GCancellable *cancellable, GError **error);
+void gdata_calendar_calendar_list_refresh_async (GDataCalendarCalendarList *self, GCancellable *cancellable,
+                                                 GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_calendar_calendar_list_refresh_finish (GDataCalendarCalendarList *self, GAsyncResult *async_result, GError **error);
+
+GList *gdata_calendar_calendar_list_get_calendars (GDataCalendarCalendarList *self) G_GNUC_WARN_UNUSED_RESULT;
+GDataCalendarCalendar *gdata_calendar_calendar_list_look_up_calendar (GDataCalendarCalendarList *self,
+                                                                      const gchar *calendar_id) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* !GDATA_CALENDAR_CALENDAR_LIST_H */
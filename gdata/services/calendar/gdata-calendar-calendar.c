@@ -91,6 +91,7 @@
 static void gdata_calendar_calendar_access_handler_init (GDataAccessHandlerIface *iface);
 static GObject *gdata_calendar_calendar_constructor (GType type, guint n_construct_params, GObjectConstructParam *construct_params);
 static void gdata_calendar_calendar_finalize (GObject *object);
+static void refresh_private (GDataEntry *self, GDataEntry *other);
 static void gdata_calendar_calendar_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_calendar_calendar_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
@@ -101,7 +102,7 @@ struct _GDataCalendarCalendarPrivate {
 	gchar *timezone;
 	guint times_cleaned;
 	gboolean is_hidden;
-	GDataColor colour;
+	guint32 colour; /* packed with _gdata_color_pack() */
 	gboolean is_selected;
 	gchar *access_level;
 
@@ -142,6 +143,10 @@ gdata_calendar_calendar_class_init (GDataCalendarCalendarClass *klass)
 
 	entry_class->kind_term = "http://schemas.google.com/gCal/2005#calendarmeta";
 
+	/* All the calendar's state is exposed as properties */
+	_gdata_parsable_class_set_original_xml_func (parsable_class, NULL);
+	_gdata_entry_class_set_refresh_func (entry_class, refresh_private);
+
 	/**
 	 * GDataCalendarCalendar:timezone:
 	 *
@@ -281,6 +286,20 @@ gdata_calendar_calendar_constructor (GType type, guint n_construct_params, GObje
 	return object;
 }
 
+static void
+refresh_private (GDataEntry *self, GDataEntry *other)
+{
+	GDataCalendarCalendarPrivate *priv = GDATA_CALENDAR_CALENDAR (self)->priv, *other_priv = GDATA_CALENDAR_CALENDAR (other)->priv;
+	gchar *access_level;
+
+	priv->times_cleaned = other_priv->times_cleaned;
+	priv->edited = other_priv->edited;
+
+	access_level = priv->access_level;
+	priv->access_level = other_priv->access_level;
+	other_priv->access_level = access_level;
+}
+
 static void
 gdata_calendar_calendar_finalize (GObject *object)
 {
@@ -308,9 +327,13 @@ gdata_calendar_calendar_get_property (GObject *object, guint property_id, GValue
 		case PROP_IS_HIDDEN:
 			g_value_set_boolean (value, priv->is_hidden);
 			break;
-		case PROP_COLOR:
-			g_value_set_boxed (value, &(priv->colour));
+		case PROP_COLOR: {
+			GDataColor colour;
+
+			_gdata_color_unpack (priv->colour, &colour);
+			g_value_set_boxed (value, &colour);
 			break;
+		}
 		case PROP_IS_SELECTED:
 			g_value_set_boolean (value, priv->is_selected);
 			break;
@@ -389,12 +412,12 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		} else if (xmlStrcmp (node->name, (xmlChar*) "color") == 0) {
 			/* gCal:color */
 			xmlChar *value;
-			GDataColor colour;
+			guint32 colour;
 
 			value = xmlGetProp (node, (xmlChar*) "value");
 			if (value == NULL)
 				return gdata_parser_error_required_property_missing (node, "value", error);
-			if (gdata_color_from_hexadecimal ((gchar*) value, &colour) == FALSE) {
+			if (_gdata_color_parse_packed ((gchar*) value, &colour) == FALSE) {
 				/* Error */
 				g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
 				             /* Translators: the first parameter is the name of an XML element (including the angle brackets
@@ -410,7 +433,7 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 				return FALSE;
 			}
 
-			gdata_calendar_calendar_set_color (self, &colour);
+			self->priv->colour = colour;
 			xmlFree (value);
 		} else if (xmlStrcmp (node->name, (xmlChar*) "selected") == 0) {
 			/* gCal:selected */
@@ -434,7 +457,6 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 static void
 get_xml (GDataParsable *parsable, GString *xml_string)
 {
-	gchar *colour;
 	GDataCalendarCalendarPrivate *priv = GDATA_CALENDAR_CALENDAR (parsable)->priv;
 
 	/* Chain up to the parent class */
@@ -449,9 +471,9 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 	else
 		g_string_append (xml_string, "<gCal:hidden value='false'/>");
 
-	colour = gdata_color_to_hexadecimal (&(priv->colour));
-	g_string_append_printf (xml_string, "<gCal:color value='%s'/>", colour);
-	g_free (colour);
+	g_string_append (xml_string, "<gCal:color value='");
+	_gdata_color_append_hexadecimal (xml_string, priv->colour);
+	g_string_append (xml_string, "'/>");
 
 	if (priv->is_selected == TRUE)
 		g_string_append (xml_string, "<gCal:selected value='true'/>");
@@ -579,7 +601,7 @@ gdata_calendar_calendar_get_color (GDataCalendarCalendar *self, GDataColor *colo
 {
 	g_return_if_fail (GDATA_IS_CALENDAR_CALENDAR (self));
 	g_return_if_fail (color != NULL);
-	*color = self->priv->colour;
+	_gdata_color_unpack (self->priv->colour, color);
 }
 
 /**
@@ -594,7 +616,7 @@ gdata_calendar_calendar_set_color (GDataCalendarCalendar *self, const GDataColor
 {
 	g_return_if_fail (GDATA_IS_CALENDAR_CALENDAR (self));
 	g_return_if_fail (color != NULL);
-	self->priv->colour = *color;
+	self->priv->colour = _gdata_color_pack (color);
 	g_object_notify (G_OBJECT (self), "color");
 }
 
@@ -0,0 +1,1478 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-calendar-event-expander
+ * @short_description: GData Calendar client-side recurrence expansion
+ * @stability: Unstable
+ * @include: gdata/services/calendar/gdata-calendar-event-expander.h
+ *
+ * #GDataCalendarEventExpander expands recurring #GDataCalendarEvent<!-- -->s into their individual instances locally, so that a calendar view
+ * can be populated for any window of time without asking the server to expand the recurrences using
+ * gdata_calendar_query_set_recurrence_expansion_start() or gdata_calendar_query_set_single_events() each time the window moves.
+ *
+ * Events are added to the expander using gdata_calendar_event_expander_add_event(), which parses the iCalendar <code class="literal">DTSTART</code>,
+ * <code class="literal">DTEND</code>, <code class="literal">DURATION</code>, <code class="literal">RRULE</code>,
+ * <code class="literal">RDATE</code> and <code class="literal">EXDATE</code> properties from gdata_calendar_event_get_recurrence(). Events
+ * which aren't recurring are also accepted, and are reported as a single instance. Exceptions to recurring events (see
+ * gdata_calendar_event_is_exception()) replace the instance of the recurring event which they were originally scheduled as, or remove it
+ * entirely if they're cancelled.
+ *
+ * gdata_calendar_event_expander_expand() then reports all the instances which overlap a given window, in order of start time. The
+ * instances generated for each recurring event are cached, so expanding a window which has already been covered (or which lies before one which
+ * has) is cheap, and moving the window forwards only generates the newly-covered instances.
+ *
+ * Recurrence rules using <code class="literal">FREQ=HOURLY</code>, <code class="literal">FREQ=MINUTELY</code> or
+ * <code class="literal">FREQ=SECONDLY</code>, or the <code class="literal">BYHOUR</code>, <code class="literal">BYMINUTE</code>,
+ * <code class="literal">BYSECOND</code>, <code class="literal">BYYEARDAY</code> or <code class="literal">BYWEEKNO</code> rule parts, are not
+ * supported, and neither are <code class="literal">EXRULE</code>s or multiple <code class="literal">RRULE</code>s. Adding an event which uses them
+ * fails, and the event should be expanded on the server instead.
+ *
+ * <example>
+ *	<title>Expanding a Week of Events</title>
+ *	<programlisting>
+ *	static void
+ *	instance_cb (GDataCalendarEvent *event, gint64 start_time, gint64 end_time, gboolean is_date, gpointer user_data)
+ *	{
+ *		/<!-- -->* Add the instance to the calendar view *<!-- -->/
+ *		add_instance_to_view (user_data, gdata_entry_get_title (GDATA_ENTRY (event)), start_time, end_time, is_date);
+ *	}
+ *
+ *	GDataCalendarEventExpander *expander;
+ *	GList *i;
+ *
+ *	/<!-- -->* Add all the events from a query without single-events or recurrence expansion set *<!-- -->/
+ *	expander = gdata_calendar_event_expander_new ();
+ *
+ *	for (i = gdata_feed_get_entries (feed); i != NULL; i = i->next) {
+ *		GError *error = NULL;
+ *
+ *		if (gdata_calendar_event_expander_add_event (expander, GDATA_CALENDAR_EVENT (i->data), &error) == FALSE) {
+ *			g_warning ("Couldn't expand event: %s", error->message);
+ *			g_error_free (error);
+ *		}
+ *	}
+ *
+ *	/<!-- -->* Expand whichever week is being viewed; this can be repeated as the view is scrolled *<!-- -->/
+ *	gdata_calendar_event_expander_expand (expander, week_start, week_start + 7 * 24 * 60 * 60, instance_cb, view);
+ *
+ *	g_object_unref (expander);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <string.h>
+
+#include "gdata-calendar-event-expander.h"
+#include "gdata-calendar-event.h"
+#include "gdata-parser.h"
+#include "gdata-private.h"
+#include "gdata-service.h"
+
+/* Instances are never generated beyond this year, which is the last one GDate can represent */
+#define MAX_YEAR 9999
+
+typedef enum {
+	FREQUENCY_DAILY,
+	FREQUENCY_WEEKLY,
+	FREQUENCY_MONTHLY,
+	FREQUENCY_YEARLY,
+} Frequency;
+
+typedef struct {
+	gint ordinal; /* 0 for every such weekday in the period */
+	GDateWeekday weekday;
+} WeekdayRule;
+
+typedef struct {
+	Frequency frequency;
+	guint interval;
+	guint count; /* 0 if unbounded */
+	gint64 until; /* -1 if unbounded */
+	GDateWeekday week_start;
+	guint by_month; /* bit n set if month n is included; 0 if unrestricted */
+	GArray *by_month_day; /* gint */
+	GArray *by_day; /* WeekdayRule */
+	GArray *by_set_pos; /* gint */
+} RecurrenceRule;
+
+typedef struct {
+	GDataCalendarEvent *event; /* owned */
+	gchar *key; /* owned; see get_event_key() */
+
+	/* Set for exceptions to a recurring event */
+	gchar *master_key; /* owned */
+	gint64 original_start_time;
+	gboolean is_cancelled;
+
+	/* Set for recurring events */
+	gboolean is_recurring;
+	gint64 start_time; /* start of the first instance */
+	gint64 duration;
+	gboolean is_date;
+	GTimeZone *time_zone; /* owned; NULL for all-day events */
+	GDate start_date; /* local date of the first instance */
+	gint hour, minute, second; /* local time of each instance */
+	RecurrenceRule *rule; /* owned; NULL if there's no RRULE */
+	GArray *rdates; /* gint64, sorted */
+	GHashTable *exdates; /* gint64 set */
+
+	/* Cache of the instances generated from DTSTART and the RRULE so far, before EXDATEs are removed */
+	GArray *instances; /* gint64, sorted */
+	GDate next_period; /* first day of the next period to generate instances for */
+	gint64 expanded_until; /* all the instances starting before this time have been generated */
+	gboolean is_exhausted; /* whether all the instances have been generated */
+} ExpandedEvent;
+
+typedef struct {
+	GDataCalendarEvent *event;
+	gint64 start_time;
+	gint64 end_time;
+	gboolean is_date;
+} Instance;
+
+static void gdata_calendar_event_expander_finalize (GObject *object);
+
+struct _GDataCalendarEventExpanderPrivate {
+	GHashTable *events; /* event ID → ExpandedEvent */
+	GHashTable *overrides; /* key of a recurring event → (gint64 original start time of an instance → number of exceptions replacing it) */
+};
+
+G_DEFINE_TYPE (GDataCalendarEventExpander, gdata_calendar_event_expander, G_TYPE_OBJECT)
+
+static void
+gdata_calendar_event_expander_class_init (GDataCalendarEventExpanderClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataCalendarEventExpanderPrivate));
+
+	gobject_class->finalize = gdata_calendar_event_expander_finalize;
+}
+
+static void
+recurrence_rule_free (RecurrenceRule *rule)
+{
+	g_array_free (rule->by_month_day, TRUE);
+	g_array_free (rule->by_day, TRUE);
+	g_array_free (rule->by_set_pos, TRUE);
+	g_slice_free (RecurrenceRule, rule);
+}
+
+static void
+expanded_event_free (ExpandedEvent *data)
+{
+	g_object_unref (data->event);
+	g_free (data->key);
+	g_free (data->master_key);
+
+	if (data->time_zone != NULL)
+		g_time_zone_unref (data->time_zone);
+	if (data->rule != NULL)
+		recurrence_rule_free (data->rule);
+	if (data->rdates != NULL)
+		g_array_free (data->rdates, TRUE);
+	if (data->exdates != NULL)
+		g_hash_table_destroy (data->exdates);
+	if (data->instances != NULL)
+		g_array_free (data->instances, TRUE);
+
+	g_slice_free (ExpandedEvent, data);
+}
+
+static void
+gdata_calendar_event_expander_init (GDataCalendarEventExpander *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CALENDAR_EVENT_EXPANDER, GDataCalendarEventExpanderPrivate);
+	self->priv->events = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) expanded_event_free);
+	self->priv->overrides = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_destroy);
+}
+
+static void
+gdata_calendar_event_expander_finalize (GObject *object)
+{
+	GDataCalendarEventExpanderPrivate *priv = GDATA_CALENDAR_EVENT_EXPANDER (object)->priv;
+
+	g_hash_table_destroy (priv->events);
+	g_hash_table_destroy (priv->overrides);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_calendar_event_expander_parent_class)->finalize (object);
+}
+
+/**
+ * gdata_calendar_event_expander_new:
+ *
+ * Creates a new, empty #GDataCalendarEventExpander.
+ *
+ * Return value: (transfer full): a new #GDataCalendarEventExpander; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataCalendarEventExpander *
+gdata_calendar_event_expander_new (void)
+{
+	return g_object_new (GDATA_TYPE_CALENDAR_EVENT_EXPANDER, NULL);
+}
+
+/* Exceptions refer to their recurring event by its short ID, whereas gdata_entry_get_id() returns the full URI, so key them using the last
+ * component of the ID. */
+static gchar *
+get_event_key (const gchar *event_id)
+{
+	const gchar *slash = strrchr (event_id, '/');
+	return g_strdup ((slash != NULL) ? slash + 1 : event_id);
+}
+
+static gboolean set_recurrence_error (GError **error, const gchar *format, ...) G_GNUC_PRINTF (2, 3);
+
+static gboolean
+set_recurrence_error (GError **error, const gchar *format, ...)
+{
+	va_list args;
+	gchar *message;
+
+	va_start (args, format);
+	message = g_strdup_vprintf (format, args);
+	va_end (args);
+
+	g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR, message);
+	g_free (message);
+
+	return FALSE;
+}
+
+static gint64
+local_date_to_time (GTimeZone *time_zone, const GDate *date, gint hour, gint minute, gint second)
+{
+	/* All-day events have no time zone, and their instances start at midnight UTC */
+	if (time_zone == NULL)
+		hour = minute = second = 0;
+
+	return gdata_parser_int64_from_local_time (time_zone, g_date_get_year (date), g_date_get_month (date), g_date_get_day (date),
+	                                           hour, minute, second);
+}
+
+static gint64
+instance_time (const ExpandedEvent *data, const GDate *date)
+{
+	return local_date_to_time (data->time_zone, date, data->hour, data->minute, data->second);
+}
+
+/* Parses an iCalendar DATE ("YYYYMMDD") or DATE-TIME ("YYYYMMDDTHHMMSS", optionally suffixed with "Z" for UTC) value. A DATE-TIME without the
+ * "Z" is in @time_zone. */
+static gboolean
+parse_date_time (const gchar *value, GTimeZone *time_zone, gboolean *is_date, GDate *date, gint *hour, gint *minute, gint *second,
+                 gint64 *_time)
+{
+	guint year, month, day, h = 0, m = 0, s = 0;
+	gsize length = strlen (value);
+	gsize i;
+
+	for (i = 0; i < length; i++) {
+		if (g_ascii_isdigit (value[i]) == FALSE && !(i == 8 && value[i] == 'T') && !(i == 15 && value[i] == 'Z'))
+			return FALSE;
+	}
+
+	if (length == 8) {
+		*is_date = TRUE;
+	} else if ((length == 15 || length == 16) && value[8] == 'T') {
+		*is_date = FALSE;
+	} else {
+		return FALSE;
+	}
+
+	if (sscanf (value, "%4u%2u%2u", &year, &month, &day) != 3)
+		return FALSE;
+	if (*is_date == FALSE && sscanf (value + 9, "%2u%2u%2u", &h, &m, &s) != 3)
+		return FALSE;
+
+	if (g_date_valid_dmy (day, month, year) == FALSE || h > 23 || m > 59 || s > 60)
+		return FALSE;
+
+	g_date_clear (date, 1);
+	g_date_set_dmy (date, day, month, year);
+	*hour = h;
+	*minute = m;
+	*second = MIN (s, 59);
+
+	if (*is_date == TRUE) {
+		*_time = local_date_to_time (NULL, date, 0, 0, 0);
+	} else {
+		/* DATE-TIMEs suffixed with "Z" are in UTC. All-day events have no time zone, so treat any DATE-TIMEs in them as UTC too. */
+		*_time = gdata_parser_int64_from_local_time ((length == 16) ? NULL : time_zone, year, month, day, *hour, *minute, *second);
+	}
+
+	return TRUE;
+}
+
+/* Parses an iCalendar DURATION value, such as "P1W", "P1D" or "PT1H30M" */
+static gboolean
+parse_duration (const gchar *value, gint64 *duration)
+{
+	gint64 total = 0, number = -1, sign = 1;
+	gboolean in_time = FALSE;
+	const gchar *i = value;
+
+	if (*i == '+' || *i == '-')
+		sign = (*(i++) == '-') ? -1 : 1;
+	if (*(i++) != 'P')
+		return FALSE;
+
+	for (; *i != '\0'; i++) {
+		if (g_ascii_isdigit (*i) == TRUE) {
+			number = MAX (number, 0) * 10 + g_ascii_digit_value (*i);
+			continue;
+		} else if (*i == 'T' && in_time == FALSE && number == -1) {
+			in_time = TRUE;
+			continue;
+		} else if (number == -1) {
+			return FALSE;
+		}
+
+		if (*i == 'W' && in_time == FALSE)
+			total += number * 7 * 24 * 60 * 60;
+		else if (*i == 'D' && in_time == FALSE)
+			total += number * 24 * 60 * 60;
+		else if (*i == 'H' && in_time == TRUE)
+			total += number * 60 * 60;
+		else if (*i == 'M' && in_time == TRUE)
+			total += number * 60;
+		else if (*i == 'S' && in_time == TRUE)
+			total += number;
+		else
+			return FALSE;
+
+		number = -1;
+	}
+
+	if (number != -1)
+		return FALSE;
+
+	*duration = sign * total;
+	return TRUE;
+}
+
+static gboolean
+parse_weekday (const gchar *value, GDateWeekday *weekday)
+{
+	static const gchar *weekdays[] = { "MO", "TU", "WE", "TH", "FR", "SA", "SU" };
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (weekdays); i++) {
+		if (g_ascii_strcasecmp (value, weekdays[i]) == 0) {
+			*weekday = G_DATE_MONDAY + i;
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/* Parses a comma-separated list of integers in [-max, -min] ∪ [min, max] into @array */
+static gboolean
+parse_integer_list (const gchar *value, gint min, gint max, GArray *array)
+{
+	gchar **values;
+	guint i;
+	gboolean success = TRUE;
+
+	values = g_strsplit (value, ",", -1);
+
+	for (i = 0; values[i] != NULL && success == TRUE; i++) {
+		gchar *end;
+		gint64 number = g_ascii_strtoll (values[i], &end, 10);
+
+		if (*values[i] == '\0' || *end != '\0' || ABS (number) < min || ABS (number) > max) {
+			success = FALSE;
+		} else {
+			gint number_int = number;
+			g_array_append_val (array, number_int);
+		}
+	}
+
+	g_strfreev (values);
+
+	return success;
+}
+
+static RecurrenceRule *
+parse_rule (const gchar *value, const ExpandedEvent *data, GError **error)
+{
+	RecurrenceRule *rule;
+	gchar **parts;
+	guint i;
+	gboolean have_frequency = FALSE, success = TRUE;
+
+	rule = g_slice_new0 (RecurrenceRule);
+	rule->interval = 1;
+	rule->until = -1;
+	rule->week_start = G_DATE_MONDAY;
+	rule->by_month_day = g_array_new (FALSE, FALSE, sizeof (gint));
+	rule->by_day = g_array_new (FALSE, FALSE, sizeof (WeekdayRule));
+	rule->by_set_pos = g_array_new (FALSE, FALSE, sizeof (gint));
+
+	parts = g_strsplit (value, ";", -1);
+
+	for (i = 0; parts[i] != NULL && success == TRUE; i++) {
+		gchar *part_value = strchr (parts[i], '=');
+		const gchar *part_name = parts[i];
+
+		if (*parts[i] == '\0')
+			continue;
+
+		if (part_value == NULL) {
+			success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), parts[i]);
+			break;
+		}
+
+		*(part_value++) = '\0';
+
+		if (g_ascii_strcasecmp (part_name, "FREQ") == 0) {
+			have_frequency = TRUE;
+
+			if (g_ascii_strcasecmp (part_value, "DAILY") == 0)
+				rule->frequency = FREQUENCY_DAILY;
+			else if (g_ascii_strcasecmp (part_value, "WEEKLY") == 0)
+				rule->frequency = FREQUENCY_WEEKLY;
+			else if (g_ascii_strcasecmp (part_value, "MONTHLY") == 0)
+				rule->frequency = FREQUENCY_MONTHLY;
+			else if (g_ascii_strcasecmp (part_value, "YEARLY") == 0)
+				rule->frequency = FREQUENCY_YEARLY;
+			else
+				success = set_recurrence_error (error, _("The recurrence frequency ‘%s’ is not supported."), part_value);
+		} else if (g_ascii_strcasecmp (part_name, "INTERVAL") == 0 || g_ascii_strcasecmp (part_name, "COUNT") == 0) {
+			gchar *end;
+			guint64 number = g_ascii_strtoull (part_value, &end, 10);
+
+			if (*part_value == '\0' || *end != '\0' || number == 0 || number > G_MAXUINT)
+				success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), part_name);
+			else if (g_ascii_strcasecmp (part_name, "INTERVAL") == 0)
+				rule->interval = number;
+			else
+				rule->count = number;
+		} else if (g_ascii_strcasecmp (part_name, "UNTIL") == 0) {
+			GDate date;
+			gboolean is_date;
+			gint hour, minute, second;
+
+			if (parse_date_time (part_value, data->time_zone, &is_date, &date, &hour, &minute, &second, &(rule->until)) == FALSE) {
+				success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), part_name);
+			} else if (is_date == TRUE && data->is_date == FALSE) {
+				/* Include any instance on the UNTIL date itself */
+				rule->until = local_date_to_time (data->time_zone, &date, 23, 59, 59);
+			}
+		} else if (g_ascii_strcasecmp (part_name, "WKST") == 0) {
+			if (parse_weekday (part_value, &(rule->week_start)) == FALSE)
+				success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), part_name);
+		} else if (g_ascii_strcasecmp (part_name, "BYMONTH") == 0) {
+			GArray *months = g_array_new (FALSE, FALSE, sizeof (gint));
+			guint j;
+
+			if (parse_integer_list (part_value, 1, 12, months) == FALSE) {
+				success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), part_name);
+			} else {
+				for (j = 0; j < months->len; j++) {
+					gint month = g_array_index (months, gint, j);
+
+					if (month < 0) {
+						success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), part_name);
+						break;
+					}
+
+					rule->by_month |= 1 << month;
+				}
+			}
+
+			g_array_free (months, TRUE);
+		} else if (g_ascii_strcasecmp (part_name, "BYMONTHDAY") == 0) {
+			if (parse_integer_list (part_value, 1, 31, rule->by_month_day) == FALSE)
+				success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), part_name);
+		} else if (g_ascii_strcasecmp (part_name, "BYSETPOS") == 0) {
+			if (parse_integer_list (part_value, 1, 366, rule->by_set_pos) == FALSE)
+				success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), part_name);
+		} else if (g_ascii_strcasecmp (part_name, "BYDAY") == 0) {
+			gchar **days = g_strsplit (part_value, ",", -1);
+			guint j;
+
+			for (j = 0; days[j] != NULL; j++) {
+				WeekdayRule weekday_rule;
+				gchar *end;
+				gsize length = strlen (days[j]);
+
+				weekday_rule.ordinal = 0;
+				if (length > 2) {
+					gint64 ordinal = g_ascii_strtoll (days[j], &end, 10);
+
+					if (end != days[j] + length - 2 || ordinal == 0 || ABS (ordinal) > 53) {
+						success = FALSE;
+						break;
+					}
+
+					weekday_rule.ordinal = ordinal;
+				}
+
+				if (length < 2 || parse_weekday (days[j] + length - 2, &(weekday_rule.weekday)) == FALSE) {
+					success = FALSE;
+					break;
+				}
+
+				g_array_append_val (rule->by_day, weekday_rule);
+			}
+
+			g_strfreev (days);
+
+			if (success == FALSE)
+				set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), part_name);
+		} else {
+			/* BYSECOND, BYMINUTE, BYHOUR, BYYEARDAY, BYWEEKNO and anything else */
+			success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ is not supported."), part_name);
+		}
+	}
+
+	g_strfreev (parts);
+
+	if (success == TRUE && have_frequency == FALSE)
+		success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was missing."), "FREQ");
+
+	/* Check that the rule parts make sense together, as per RFC 5545 §3.3.10 */
+	if (success == TRUE && rule->frequency == FREQUENCY_WEEKLY && rule->by_month_day->len > 0)
+		success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), "BYMONTHDAY");
+
+	if (success == TRUE && rule->frequency != FREQUENCY_MONTHLY && rule->frequency != FREQUENCY_YEARLY) {
+		for (i = 0; i < rule->by_day->len; i++) {
+			if (g_array_index (rule->by_day, WeekdayRule, i).ordinal != 0) {
+				success = set_recurrence_error (error, _("The recurrence rule part ‘%s’ was invalid."), "BYDAY");
+				break;
+			}
+		}
+	}
+
+	if (success == FALSE) {
+		recurrence_rule_free (rule);
+		return NULL;
+	}
+
+	return rule;
+}
+
+/* Splits an unfolded iCalendar content line into its name, the values of its TZID and VALUE parameters, and its value. The line is modified in
+ * place, and the returned strings point into it. */
+static gboolean
+split_property (gchar *line, const gchar **name, const gchar **tzid, const gchar **value_type, const gchar **value)
+{
+	gchar *i, *parameter = NULL;
+	gboolean in_quotes = FALSE, done = FALSE;
+
+	*name = line;
+	*tzid = NULL;
+	*value_type = NULL;
+	*value = NULL;
+
+	for (i = line; *i != '\0' && done == FALSE; i++) {
+		if (*i == '"') {
+			in_quotes = !in_quotes;
+			continue;
+		} else if (in_quotes == TRUE || (*i != ';' && *i != ':')) {
+			continue;
+		}
+
+		done = (*i == ':');
+		*i = '\0';
+
+		/* Finish off the previous parameter */
+		if (parameter != NULL) {
+			if (g_ascii_strncasecmp (parameter, "TZID=", 5) == 0)
+				*tzid = parameter + 5;
+			else if (g_ascii_strncasecmp (parameter, "VALUE=", 6) == 0)
+				*value_type = parameter + 6;
+		}
+
+		parameter = i + 1;
+	}
+
+	if (done == FALSE)
+		return FALSE;
+
+	*value = i;
+
+	/* Strip any quotes from the TZID */
+	if (*tzid != NULL && **tzid == '"') {
+		gchar *tzid_end;
+
+		*tzid += 1;
+		tzid_end = strchr (*tzid, '"');
+		if (tzid_end != NULL)
+			*tzid_end = '\0';
+	}
+
+	return TRUE;
+}
+
+static gint
+compare_times (gconstpointer a, gconstpointer b)
+{
+	gint64 time_a = *((const gint64*) a), time_b = *((const gint64*) b);
+	return (time_a < time_b) ? -1 : (time_a > time_b) ? 1 : 0;
+}
+
+/* Parses the comma-separated values of an EXDATE or RDATE property into @array. PERIOD values are reduced to their start times. */
+static gboolean
+parse_date_list (const ExpandedEvent *data, const gchar *tzid, const gchar *value_type, const gchar *value, GArray *array)
+{
+	GTimeZone *time_zone;
+	gchar **values;
+	guint i;
+	gboolean success = TRUE;
+
+	if (tzid != NULL)
+		time_zone = gdata_parser_time_zone_new (tzid);
+	else if (data->time_zone != NULL)
+		time_zone = g_time_zone_ref (data->time_zone);
+	else
+		time_zone = gdata_parser_time_zone_new (NULL);
+	values = g_strsplit (value, ",", -1);
+
+	for (i = 0; values[i] != NULL && success == TRUE; i++) {
+		gchar *slash;
+		GDate date;
+		gboolean is_date;
+		gint hour, minute, second;
+		gint64 _time;
+
+		if (value_type != NULL && g_ascii_strcasecmp (value_type, "PERIOD") == 0 && (slash = strchr (values[i], '/')) != NULL)
+			*slash = '\0';
+
+		if (parse_date_time (values[i], time_zone, &is_date, &date, &hour, &minute, &second, &_time) == FALSE) {
+			success = FALSE;
+			break;
+		}
+
+		/* A DATE value in a timed event refers to the instance on that day */
+		if (is_date == TRUE && data->is_date == FALSE)
+			_time = instance_time (data, &date);
+
+		g_array_append_val (array, _time);
+	}
+
+	g_strfreev (values);
+	g_time_zone_unref (time_zone);
+
+	return success;
+}
+
+typedef struct {
+	const gchar *name;
+	const gchar *tzid;
+	const gchar *value_type;
+	const gchar *value;
+} DateList;
+
+static gboolean
+parse_recurrence (ExpandedEvent *data, const gchar *recurrence, GError **error)
+{
+	GString *unfolded;
+	gchar **lines;
+	const gchar *i;
+	const gchar *rrule = NULL;
+	GArray *date_lists; /* DateList for each EXDATE and RDATE line, which can only be parsed once DTSTART's known */
+	GArray *exdates;
+	guint j, depth = 0;
+	gint64 end_time = -1, duration = -1;
+	gboolean have_start = FALSE, success = TRUE;
+
+	/* Unfold the content lines, as per RFC 5545 §3.1 */
+	unfolded = g_string_sized_new (strlen (recurrence));
+
+	for (i = recurrence; *i != '\0'; i++) {
+		if (*i == '\r')
+			continue;
+		else if (*i == '\n' && (i[1] == ' ' || i[1] == '\t'))
+			i++;
+		else
+			g_string_append_c (unfolded, *i);
+	}
+
+	lines = g_strsplit (unfolded->str, "\n", -1);
+	g_string_free (unfolded, TRUE);
+
+	date_lists = g_array_new (FALSE, FALSE, sizeof (DateList));
+
+	for (j = 0; lines[j] != NULL && success == TRUE; j++) {
+		const gchar *name, *tzid, *value_type, *value;
+
+		if (*lines[j] == '\0')
+			continue;
+
+		/* Skip nested components, such as the VTIMEZONE Google appends */
+		if (g_ascii_strncasecmp (lines[j], "BEGIN:", 6) == 0) {
+			depth++;
+			continue;
+		} else if (g_ascii_strncasecmp (lines[j], "END:", 4) == 0) {
+			depth = (depth > 0) ? depth - 1 : 0;
+			continue;
+		} else if (depth > 0) {
+			continue;
+		}
+
+		if (split_property (lines[j], &name, &tzid, &value_type, &value) == FALSE) {
+			success = set_recurrence_error (error, _("The recurrence line ‘%s’ was invalid."), lines[j]);
+			break;
+		}
+
+		if (g_ascii_strcasecmp (name, "DTSTART") == 0) {
+			if (data->time_zone != NULL)
+				g_time_zone_unref (data->time_zone);
+			data->time_zone = (tzid != NULL) ? gdata_parser_time_zone_new (tzid) : g_time_zone_new_local ();
+
+			if (parse_date_time (value, data->time_zone, &(data->is_date), &(data->start_date), &(data->hour), &(data->minute),
+			                     &(data->second), &(data->start_time)) == FALSE) {
+				success = set_recurrence_error (error, _("The recurrence property ‘%s’ was invalid."), name);
+				break;
+			}
+
+			/* All-day events are expanded in UTC, to match how GDataGDWhen stores them; DATE-TIMEs in UTC are expanded as such */
+			if (data->is_date == TRUE) {
+				g_time_zone_unref (data->time_zone);
+				data->time_zone = NULL;
+			} else if (value[strlen (value) - 1] == 'Z') {
+				g_time_zone_unref (data->time_zone);
+				data->time_zone = gdata_parser_time_zone_new (NULL);
+			}
+
+			have_start = TRUE;
+		} else if (g_ascii_strcasecmp (name, "DTEND") == 0) {
+			GTimeZone *time_zone = (tzid != NULL) ? gdata_parser_time_zone_new (tzid) : g_time_zone_new_local ();
+			GDate date;
+			gboolean is_date;
+			gint hour, minute, second;
+
+			if (parse_date_time (value, time_zone, &is_date, &date, &hour, &minute, &second, &end_time) == FALSE)
+				success = set_recurrence_error (error, _("The recurrence property ‘%s’ was invalid."), name);
+
+			g_time_zone_unref (time_zone);
+		} else if (g_ascii_strcasecmp (name, "DURATION") == 0) {
+			if (parse_duration (value, &duration) == FALSE || duration < 0)
+				success = set_recurrence_error (error, _("The recurrence property ‘%s’ was invalid."), name);
+		} else if (g_ascii_strcasecmp (name, "RRULE") == 0) {
+			if (rrule != NULL)
+				success = set_recurrence_error (error, _("The recurrence property ‘%s’ is not supported."), "RRULE");
+			rrule = value;
+		} else if (g_ascii_strcasecmp (name, "EXDATE") == 0 || g_ascii_strcasecmp (name, "RDATE") == 0) {
+			DateList date_list;
+
+			date_list.name = name;
+			date_list.tzid = tzid;
+			date_list.value_type = value_type;
+			date_list.value = value;
+			g_array_append_val (date_lists, date_list);
+		} else if (g_ascii_strcasecmp (name, "EXRULE") == 0) {
+			success = set_recurrence_error (error, _("The recurrence property ‘%s’ is not supported."), name);
+		}
+	}
+
+	if (success == TRUE && have_start == FALSE)
+		success = set_recurrence_error (error, _("The recurrence property ‘%s’ was missing."), "DTSTART");
+
+	if (success == TRUE) {
+		if (end_time != -1)
+			data->duration = MAX (end_time - data->start_time, 0);
+		else if (duration != -1)
+			data->duration = duration;
+		else
+			data->duration = (data->is_date == TRUE) ? 24 * 60 * 60 : 0;
+	}
+
+	if (success == TRUE && rrule != NULL) {
+		data->rule = parse_rule (rrule, data, error);
+		success = (data->rule != NULL);
+	}
+
+	/* Parse the EXDATEs and RDATEs */
+	data->rdates = g_array_new (FALSE, FALSE, sizeof (gint64));
+	data->exdates = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+	exdates = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+	for (j = 0; j < date_lists->len && success == TRUE; j++) {
+		const DateList *date_list = &g_array_index (date_lists, DateList, j);
+		GArray *array = (g_ascii_strcasecmp (date_list->name, "RDATE") == 0) ? data->rdates : exdates;
+
+		if (parse_date_list (data, date_list->tzid, date_list->value_type, date_list->value, array) == FALSE)
+			success = set_recurrence_error (error, _("The recurrence property ‘%s’ was invalid."), date_list->name);
+	}
+
+	for (j = 0; j < exdates->len; j++) {
+		gint64 *exdate = g_memdup (&g_array_index (exdates, gint64, j), sizeof (gint64));
+		g_hash_table_insert (data->exdates, exdate, exdate);
+	}
+
+	g_array_sort (data->rdates, compare_times);
+
+	g_array_free (exdates, TRUE);
+	g_array_free (date_lists, TRUE);
+	g_strfreev (lines);
+
+	return success;
+}
+
+/* Gets the first day of the period (as determined by the rule's frequency) containing @date */
+static void
+get_period_start (const RecurrenceRule *rule, const GDate *date, GDate *period_start)
+{
+	*period_start = *date;
+
+	switch (rule->frequency) {
+		case FREQUENCY_DAILY:
+			break;
+		case FREQUENCY_WEEKLY:
+			g_date_subtract_days (period_start, (g_date_get_weekday (date) - rule->week_start + 7) % 7);
+			break;
+		case FREQUENCY_MONTHLY:
+			g_date_set_day (period_start, 1);
+			break;
+		case FREQUENCY_YEARLY:
+			g_date_set_day (period_start, 1);
+			g_date_set_month (period_start, G_DATE_JANUARY);
+			break;
+		default:
+			g_assert_not_reached ();
+	}
+}
+
+/* Moves @period_start on to the start of the next period according to the rule's frequency and interval. Returns %FALSE if that would be beyond
+ * the range of GDate. */
+static gboolean
+advance_period (const RecurrenceRule *rule, GDate *period_start)
+{
+	guint years;
+
+	switch (rule->frequency) {
+		case FREQUENCY_DAILY:
+			years = rule->interval / 365 + 1;
+			break;
+		case FREQUENCY_WEEKLY:
+			years = rule->interval / 52 + 1;
+			break;
+		case FREQUENCY_MONTHLY:
+			years = rule->interval / 12 + 1;
+			break;
+		case FREQUENCY_YEARLY:
+			years = rule->interval;
+			break;
+		default:
+			g_assert_not_reached ();
+	}
+
+	if (years >= MAX_YEAR || g_date_get_year (period_start) + years >= MAX_YEAR)
+		return FALSE;
+
+	switch (rule->frequency) {
+		case FREQUENCY_DAILY:
+			g_date_add_days (period_start, rule->interval);
+			break;
+		case FREQUENCY_WEEKLY:
+			g_date_add_days (period_start, rule->interval * 7);
+			break;
+		case FREQUENCY_MONTHLY:
+			g_date_add_months (period_start, rule->interval);
+			break;
+		case FREQUENCY_YEARLY:
+			g_date_add_years (period_start, rule->interval);
+			break;
+		default:
+			g_assert_not_reached ();
+	}
+
+	return TRUE;
+}
+
+static gboolean
+month_matches (const RecurrenceRule *rule, GDateMonth month)
+{
+	return (rule->by_month == 0 || (rule->by_month & (1 << month)) != 0) ? TRUE : FALSE;
+}
+
+static gboolean
+month_day_matches (const RecurrenceRule *rule, const GDate *date)
+{
+	guint i, n_days;
+
+	if (rule->by_month_day->len == 0)
+		return TRUE;
+
+	n_days = g_date_get_days_in_month (g_date_get_month (date), g_date_get_year (date));
+
+	for (i = 0; i < rule->by_month_day->len; i++) {
+		gint month_day = g_array_index (rule->by_month_day, gint, i);
+
+		if ((month_day > 0 && (guint) month_day == g_date_get_day (date)) ||
+		    (month_day < 0 && (gint) n_days + month_day + 1 == g_date_get_day (date))) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/* Only for rules whose BYDAY parts have no ordinals */
+static gboolean
+weekday_matches (const RecurrenceRule *rule, GDateWeekday weekday)
+{
+	guint i;
+
+	for (i = 0; i < rule->by_day->len; i++) {
+		if (g_array_index (rule->by_day, WeekdayRule, i).weekday == weekday)
+			return TRUE;
+	}
+
+	return (rule->by_day->len == 0) ? TRUE : FALSE;
+}
+
+/* Marks the (zero-based) offsets into a span of @n_days days, the first of which is @first_weekday, which the BYDAY rules select. Ordinals count
+ * from the start or end of the span. */
+static void
+mark_weekdays (const RecurrenceRule *rule, GDateWeekday first_weekday, guint n_days, gboolean *marked)
+{
+	guint i;
+
+	for (i = 0; i < rule->by_day->len; i++) {
+		const WeekdayRule *weekday_rule = &g_array_index (rule->by_day, WeekdayRule, i);
+		gint first = (weekday_rule->weekday - first_weekday + 7) % 7;
+		gint last = first + 7 * ((n_days - 1 - first) / 7);
+		gint offset;
+
+		if (weekday_rule->ordinal == 0) {
+			for (offset = first; offset < (gint) n_days; offset += 7)
+				marked[offset] = TRUE;
+			continue;
+		}
+
+		offset = (weekday_rule->ordinal > 0) ? first + 7 * (weekday_rule->ordinal - 1) : last + 7 * (weekday_rule->ordinal + 1);
+		if (offset >= 0 && offset < (gint) n_days)
+			marked[offset] = TRUE;
+	}
+}
+
+/* Appends the Julian days of the instances in the given month to @candidates, in order */
+static void
+expand_month (const ExpandedEvent *data, GDateYear year, GDateMonth month, GArray *candidates)
+{
+	const RecurrenceRule *rule = data->rule;
+	gboolean marked[31] = { FALSE, };
+	GDate date;
+	guint i, n_days;
+
+	n_days = g_date_get_days_in_month (month, year);
+	g_date_clear (&date, 1);
+	g_date_set_dmy (&date, 1, month, year);
+
+	if (rule->by_month_day->len == 0 && rule->by_day->len == 0) {
+		/* Default to the day of the month of the first instance, skipping months which don't have it */
+		if (g_date_get_day (&data->start_date) <= n_days)
+			marked[g_date_get_day (&data->start_date) - 1] = TRUE;
+	} else if (rule->by_day->len > 0) {
+		mark_weekdays (rule, g_date_get_weekday (&date), n_days, marked);
+	} else {
+		for (i = 0; i < n_days; i++)
+			marked[i] = TRUE;
+	}
+
+	for (i = 0; i < n_days; i++, g_date_add_days (&date, 1)) {
+		if (marked[i] == TRUE && month_day_matches (rule, &date) == TRUE) {
+			guint32 julian = g_date_get_julian (&date);
+			g_array_append_val (candidates, julian);
+		}
+	}
+}
+
+/* Appends the Julian days of the instances in a yearly rule's period to @candidates when the BYDAY ordinals count through the whole year */
+static void
+expand_year_by_day (const ExpandedEvent *data, GDateYear year, GArray *candidates)
+{
+	gboolean marked[366] = { FALSE, };
+	GDate date;
+	guint i, n_days;
+
+	n_days = (g_date_is_leap_year (year) == TRUE) ? 366 : 365;
+	g_date_clear (&date, 1);
+	g_date_set_dmy (&date, 1, G_DATE_JANUARY, year);
+
+	mark_weekdays (data->rule, g_date_get_weekday (&date), n_days, marked);
+
+	for (i = 0; i < n_days; i++, g_date_add_days (&date, 1)) {
+		if (marked[i] == TRUE && month_day_matches (data->rule, &date) == TRUE) {
+			guint32 julian = g_date_get_julian (&date);
+			g_array_append_val (candidates, julian);
+		}
+	}
+}
+
+/* Appends the Julian days of the instances in the period starting at @period_start to @candidates, in order */
+static void
+get_period_candidates (const ExpandedEvent *data, const GDate *period_start, GArray *candidates)
+{
+	const RecurrenceRule *rule = data->rule;
+	GDate date;
+	guint i;
+
+	switch (rule->frequency) {
+		case FREQUENCY_DAILY:
+			if (month_matches (rule, g_date_get_month (period_start)) == TRUE && month_day_matches (rule, period_start) == TRUE &&
+			    weekday_matches (rule, g_date_get_weekday (period_start)) == TRUE) {
+				guint32 julian = g_date_get_julian (period_start);
+				g_array_append_val (candidates, julian);
+			}
+
+			break;
+		case FREQUENCY_WEEKLY:
+			for (i = 0, date = *period_start; i < 7; i++, g_date_add_days (&date, 1)) {
+				gboolean day_matches;
+
+				if (rule->by_day->len == 0)
+					day_matches = (g_date_get_weekday (&date) == g_date_get_weekday (&data->start_date));
+				else
+					day_matches = weekday_matches (rule, g_date_get_weekday (&date));
+
+				if (day_matches == TRUE && month_matches (rule, g_date_get_month (&date)) == TRUE) {
+					guint32 julian = g_date_get_julian (&date);
+					g_array_append_val (candidates, julian);
+				}
+			}
+
+			break;
+		case FREQUENCY_MONTHLY:
+			if (month_matches (rule, g_date_get_month (period_start)) == TRUE)
+				expand_month (data, g_date_get_year (period_start), g_date_get_month (period_start), candidates);
+
+			break;
+		case FREQUENCY_YEARLY:
+			if (rule->by_month != 0) {
+				for (i = G_DATE_JANUARY; i <= G_DATE_DECEMBER; i++) {
+					if (month_matches (rule, i) == TRUE)
+						expand_month (data, g_date_get_year (period_start), i, candidates);
+				}
+			} else if (rule->by_day->len > 0) {
+				expand_year_by_day (data, g_date_get_year (period_start), candidates);
+			} else if (rule->by_month_day->len > 0) {
+				for (i = G_DATE_JANUARY; i <= G_DATE_DECEMBER; i++)
+					expand_month (data, g_date_get_year (period_start), i, candidates);
+			} else {
+				expand_month (data, g_date_get_year (period_start), g_date_get_month (&data->start_date), candidates);
+			}
+
+			break;
+		default:
+			g_assert_not_reached ();
+	}
+
+	/* Apply BYSETPOS to the period's candidates */
+	if (rule->by_set_pos->len > 0 && candidates->len > 0) {
+		gboolean *selected = g_new0 (gboolean, candidates->len);
+		guint n_selected = 0;
+
+		for (i = 0; i < rule->by_set_pos->len; i++) {
+			gint position = g_array_index (rule->by_set_pos, gint, i);
+			gint index = (position > 0) ? position - 1 : (gint) candidates->len + position;
+
+			if (index >= 0 && index < (gint) candidates->len)
+				selected[index] = TRUE;
+		}
+
+		for (i = 0; i < candidates->len; i++) {
+			if (selected[i] == TRUE)
+				g_array_index (candidates, guint32, n_selected++) = g_array_index (candidates, guint32, i);
+		}
+
+		g_array_set_size (candidates, n_selected);
+		g_free (selected);
+	}
+}
+
+/* Generates and caches all the instances of a recurring event (before EXDATEs are applied) which start before @until */
+static void
+expand_until (ExpandedEvent *data, gint64 until)
+{
+	GArray *candidates;
+
+	if (data->instances == NULL) {
+		/* DTSTART is always the first instance of the recurrence set, even if it doesn't match the RRULE */
+		data->instances = g_array_new (FALSE, FALSE, sizeof (gint64));
+		g_array_append_val (data->instances, data->start_time);
+		data->expanded_until = data->start_time + 1;
+
+		if (data->rule == NULL || data->rule->count == 1) {
+			data->is_exhausted = TRUE;
+		} else {
+			g_date_clear (&(data->next_period), 1);
+			get_period_start (data->rule, &(data->start_date), &(data->next_period));
+		}
+	}
+
+	candidates = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	while (data->is_exhausted == FALSE && data->expanded_until < until) {
+		const RecurrenceRule *rule = data->rule;
+		guint i;
+
+		g_array_set_size (candidates, 0);
+		get_period_candidates (data, &(data->next_period), candidates);
+
+		for (i = 0; i < candidates->len && data->is_exhausted == FALSE; i++) {
+			GDate date;
+			gint64 _time;
+
+			g_date_clear (&date, 1);
+			g_date_set_julian (&date, g_array_index (candidates, guint32, i));
+			_time = instance_time (data, &date);
+
+			/* Instances before DTSTART (in its period) aren't part of the recurrence set, and DTSTART itself is already included */
+			if (_time <= data->start_time)
+				continue;
+
+			if (rule->until != -1 && _time > rule->until) {
+				data->is_exhausted = TRUE;
+				break;
+			}
+
+			g_array_append_val (data->instances, _time);
+
+			if (rule->count != 0 && data->instances->len >= rule->count)
+				data->is_exhausted = TRUE;
+		}
+
+		if (advance_period (rule, &(data->next_period)) == FALSE) {
+			data->is_exhausted = TRUE;
+			break;
+		}
+
+		data->expanded_until = local_date_to_time (data->time_zone, &(data->next_period), 0, 0, 0);
+
+		if (rule->until != -1 && data->expanded_until > rule->until)
+			data->is_exhausted = TRUE;
+	}
+
+	g_array_free (candidates, TRUE);
+}
+
+static void
+add_override (GDataCalendarEventExpander *self, const ExpandedEvent *data)
+{
+	GHashTable *overrides;
+	gpointer key, value;
+
+	if (data->master_key == NULL || data->original_start_time == -1)
+		return;
+
+	overrides = g_hash_table_lookup (self->priv->overrides, data->master_key);
+	if (overrides == NULL) {
+		overrides = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, NULL);
+		g_hash_table_insert (self->priv->overrides, g_strdup (data->master_key), overrides);
+	}
+
+	if (g_hash_table_lookup_extended (overrides, &(data->original_start_time), &key, &value) == TRUE)
+		g_hash_table_insert (overrides, g_memdup (key, sizeof (gint64)), GUINT_TO_POINTER (GPOINTER_TO_UINT (value) + 1));
+	else
+		g_hash_table_insert (overrides, g_memdup (&(data->original_start_time), sizeof (gint64)), GUINT_TO_POINTER (1));
+}
+
+static void
+remove_override (GDataCalendarEventExpander *self, const ExpandedEvent *data)
+{
+	GHashTable *overrides;
+	gpointer key, value;
+
+	if (data->master_key == NULL || data->original_start_time == -1)
+		return;
+
+	overrides = g_hash_table_lookup (self->priv->overrides, data->master_key);
+	if (overrides == NULL || g_hash_table_lookup_extended (overrides, &(data->original_start_time), &key, &value) == FALSE)
+		return;
+
+	if (GPOINTER_TO_UINT (value) > 1)
+		g_hash_table_insert (overrides, g_memdup (key, sizeof (gint64)), GUINT_TO_POINTER (GPOINTER_TO_UINT (value) - 1));
+	else
+		g_hash_table_remove (overrides, key);
+
+	if (g_hash_table_size (overrides) == 0)
+		g_hash_table_remove (self->priv->overrides, data->master_key);
+}
+
+/**
+ * gdata_calendar_event_expander_add_event:
+ * @self: a #GDataCalendarEventExpander
+ * @event: the #GDataCalendarEvent to add
+ * @error: a #GError, or %NULL
+ *
+ * Adds @event to the expander, replacing any event previously added with the same ID. @event is reffed, and mustn't be modified while it's
+ * in the expander; to update it, add the new version instead.
+ *
+ * If @event is recurring, its recurrence is parsed, and any cached instances of the event's previous version are discarded. If the recurrence
+ * is invalid or uses features which aren't supported (see the <link linkend="gdata-calendar-event-expander.description">description</link>
+ * above), %GDATA_SERVICE_ERROR_PROTOCOL_ERROR is returned and the expander is left unchanged.
+ *
+ * If @event is an exception to a recurring event, it replaces the instance of the recurring event at its original start time, whether or not
+ * the recurring event itself has been added yet. Cancelled exceptions just remove that instance.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_event_expander_add_event (GDataCalendarEventExpander *self, GDataCalendarEvent *event, GError **error)
+{
+	ExpandedEvent *data;
+	const gchar *event_id, *recurrence;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_EVENT_EXPANDER (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_CALENDAR_EVENT (event), FALSE);
+	g_return_val_if_fail (gdata_entry_get_id (GDATA_ENTRY (event)) != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	event_id = gdata_entry_get_id (GDATA_ENTRY (event));
+
+	data = g_slice_new0 (ExpandedEvent);
+	data->event = g_object_ref (event);
+	data->key = get_event_key (event_id);
+	data->original_start_time = -1;
+
+	recurrence = gdata_calendar_event_get_recurrence (event);
+	if (recurrence != NULL) {
+		data->is_recurring = TRUE;
+
+		if (parse_recurrence (data, recurrence, error) == FALSE) {
+			expanded_event_free (data);
+			return FALSE;
+		}
+	}
+
+	if (gdata_calendar_event_is_exception (event) == TRUE) {
+		gchar *original_event_id;
+
+		gdata_calendar_event_get_original_event_details (event, &original_event_id, NULL);
+		data->master_key = get_event_key (original_event_id);
+		data->original_start_time = _gdata_calendar_event_get_original_start_time (event);
+		data->is_cancelled = (g_strcmp0 (gdata_calendar_event_get_status (event), GDATA_GD_EVENT_STATUS_CANCELED) == 0) ? TRUE : FALSE;
+		g_free (original_event_id);
+	}
+
+	/* Replace any previous version of the event */
+	gdata_calendar_event_expander_remove_event (self, event_id);
+
+	g_hash_table_insert (self->priv->events, g_strdup (event_id), data);
+	add_override (self, data);
+
+	return TRUE;
+}
+
+/**
+ * gdata_calendar_event_expander_remove_event:
+ * @self: a #GDataCalendarEventExpander
+ * @event_id: the ID of the event to remove, as returned by gdata_entry_get_id()
+ *
+ * Removes the event with ID @event_id from the expander, along with its cached instances. If the event is an exception to a recurring event,
+ * the instance it replaced is restored. If no such event has been added, this does nothing.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_event_expander_remove_event (GDataCalendarEventExpander *self, const gchar *event_id)
+{
+	ExpandedEvent *data;
+
+	g_return_if_fail (GDATA_IS_CALENDAR_EVENT_EXPANDER (self));
+	g_return_if_fail (event_id != NULL);
+
+	data = g_hash_table_lookup (self->priv->events, event_id);
+	if (data == NULL)
+		return;
+
+	remove_override (self, data);
+	g_hash_table_remove (self->priv->events, event_id);
+}
+
+static gboolean
+overlaps_window (gint64 start_time, gint64 end_time, gint64 window_start, gint64 window_end)
+{
+	return (start_time < window_end && (end_time > window_start || (end_time == start_time && start_time >= window_start))) ? TRUE : FALSE;
+}
+
+static void
+append_instance (GArray *instances, GDataCalendarEvent *event, gint64 start_time, gint64 end_time, gboolean is_date)
+{
+	Instance instance;
+
+	instance.event = event;
+	instance.start_time = start_time;
+	instance.end_time = end_time;
+	instance.is_date = is_date;
+
+	g_array_append_val (instances, instance);
+}
+
+static gint
+compare_instances (gconstpointer a, gconstpointer b)
+{
+	const Instance *instance_a = a, *instance_b = b;
+
+	if (instance_a->start_time != instance_b->start_time)
+		return (instance_a->start_time < instance_b->start_time) ? -1 : 1;
+	return (instance_a->end_time < instance_b->end_time) ? -1 : (instance_a->end_time > instance_b->end_time) ? 1 : 0;
+}
+
+/* Finds the index of the first time in the sorted @times array for which an instance starting then would end after @window_start */
+static guint
+find_first_instance (GArray *times, gint64 duration, gint64 window_start)
+{
+	guint low = 0, high = times->len;
+
+	while (low < high) {
+		guint middle = low + (high - low) / 2;
+		gint64 start_time = g_array_index (times, gint64, middle);
+
+		if (start_time + duration > window_start || (duration == 0 && start_time >= window_start))
+			high = middle;
+		else
+			low = middle + 1;
+	}
+
+	return low;
+}
+
+static gboolean
+is_instance_removed (const ExpandedEvent *data, GHashTable *overrides, gint64 start_time)
+{
+	return (g_hash_table_lookup (data->exdates, &start_time) != NULL ||
+	        (overrides != NULL && g_hash_table_lookup (overrides, &start_time) != NULL)) ? TRUE : FALSE;
+}
+
+static void
+expand_recurring_event (GDataCalendarEventExpander *self, ExpandedEvent *data, gint64 window_start, gint64 window_end, GArray *instances)
+{
+	GHashTable *overrides;
+	guint i;
+
+	overrides = g_hash_table_lookup (self->priv->overrides, data->key);
+	expand_until (data, window_end);
+
+	/* Instances generated from DTSTART and the RRULE */
+	for (i = find_first_instance (data->instances, data->duration, window_start); i < data->instances->len; i++) {
+		gint64 start_time = g_array_index (data->instances, gint64, i);
+
+		if (start_time >= window_end)
+			break;
+
+		if (is_instance_removed (data, overrides, start_time) == FALSE)
+			append_instance (instances, data->event, start_time, start_time + data->duration, data->is_date);
+	}
+
+	/* Instances from RDATEs, skipping any which duplicate the others */
+	for (i = find_first_instance (data->rdates, data->duration, window_start); i < data->rdates->len; i++) {
+		gint64 start_time = g_array_index (data->rdates, gint64, i);
+		guint index;
+
+		if (start_time >= window_end)
+			break;
+
+		index = find_first_instance (data->instances, 0, start_time);
+		if ((index < data->instances->len && g_array_index (data->instances, gint64, index) == start_time) ||
+		    (i > 0 && g_array_index (data->rdates, gint64, i - 1) == start_time)) {
+			continue;
+		}
+
+		if (is_instance_removed (data, overrides, start_time) == FALSE)
+			append_instance (instances, data->event, start_time, start_time + data->duration, data->is_date);
+	}
+}
+
+/**
+ * gdata_calendar_event_expander_expand:
+ * @self: a #GDataCalendarEventExpander
+ * @window_start: the start of the window, as a UNIX timestamp
+ * @window_end: the end of the window, as a UNIX timestamp
+ * @callback: (scope call) (closure user_data): a #GDataCalendarEventExpanderCallback to call for each instance
+ * @user_data: (closure): data to pass to @callback
+ *
+ * Finds all the instances of the events in the expander which overlap the window from @window_start (inclusive) to @window_end (exclusive), and
+ * calls @callback for each of them in order of start time. @callback must not add or remove events from the expander.
+ *
+ * No network requests are made. The instances of recurring events are generated as needed and cached, so repeatedly expanding overlapping
+ * windows is cheap.
+ *
+ * Return value: the number of instances found
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_calendar_event_expander_expand (GDataCalendarEventExpander *self, gint64 window_start, gint64 window_end,
+                                      GDataCalendarEventExpanderCallback callback, gpointer user_data)
+{
+	GHashTableIter iter;
+	ExpandedEvent *data;
+	GArray *instances;
+	guint i, n_instances;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_EVENT_EXPANDER (self), 0);
+	g_return_val_if_fail (window_start <= window_end, 0);
+	g_return_val_if_fail (callback != NULL, 0);
+
+	instances = g_array_new (FALSE, FALSE, sizeof (Instance));
+
+	g_hash_table_iter_init (&iter, self->priv->events);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &data) == TRUE) {
+		GList *times;
+
+		if (data->is_cancelled == TRUE) {
+			continue;
+		} else if (data->is_recurring == TRUE) {
+			expand_recurring_event (self, data, window_start, window_end, instances);
+			continue;
+		}
+
+		/* Single events and exceptions */
+		for (times = gdata_calendar_event_get_times (data->event); times != NULL; times = times->next) {
+			GDataGDWhen *when = GDATA_GD_WHEN (times->data);
+			gint64 start_time, end_time;
+
+			start_time = gdata_gd_when_get_start_time (when);
+			end_time = gdata_gd_when_get_end_time (when);
+			if (end_time == -1)
+				end_time = (gdata_gd_when_is_date (when) == TRUE) ? start_time + 24 * 60 * 60 : start_time;
+
+			if (overlaps_window (start_time, end_time, window_start, window_end) == TRUE)
+				append_instance (instances, data->event, start_time, end_time, gdata_gd_when_is_date (when));
+		}
+	}
+
+	g_array_sort (instances, compare_instances);
+
+	for (i = 0; i < instances->len; i++) {
+		const Instance *instance = &g_array_index (instances, Instance, i);
+		callback (instance->event, instance->start_time, instance->end_time, instance->is_date, user_data);
+	}
+
+	n_instances = instances->len;
+	g_array_free (instances, TRUE);
+
+	return n_instances;
+}
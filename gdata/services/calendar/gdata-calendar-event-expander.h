@@ -0,0 +1,93 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_CALENDAR_EVENT_EXPANDER_H
+#define GDATA_CALENDAR_EVENT_EXPANDER_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gdata/services/calendar/gdata-calendar-event.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_CALENDAR_EVENT_EXPANDER		(gdata_calendar_event_expander_get_type ())
+#define GDATA_CALENDAR_EVENT_EXPANDER(o) \
+	(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CALENDAR_EVENT_EXPANDER, GDataCalendarEventExpander))
+#define GDATA_CALENDAR_EVENT_EXPANDER_CLASS(k) \
+	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CALENDAR_EVENT_EXPANDER, GDataCalendarEventExpanderClass))
+#define GDATA_IS_CALENDAR_EVENT_EXPANDER(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CALENDAR_EVENT_EXPANDER))
+#define GDATA_IS_CALENDAR_EVENT_EXPANDER_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_CALENDAR_EVENT_EXPANDER))
+#define GDATA_CALENDAR_EVENT_EXPANDER_GET_CLASS(o) \
+	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_CALENDAR_EVENT_EXPANDER, GDataCalendarEventExpanderClass))
+
+typedef struct _GDataCalendarEventExpanderPrivate	GDataCalendarEventExpanderPrivate;
+
+/**
+ * GDataCalendarEventExpander:
+ *
+ * All the fields in the #GDataCalendarEventExpander structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataCalendarEventExpanderPrivate *priv;
+} GDataCalendarEventExpander;
+
+/**
+ * GDataCalendarEventExpanderClass:
+ *
+ * All the fields in the #GDataCalendarEventExpanderClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataCalendarEventExpanderClass;
+
+/**
+ * GDataCalendarEventExpanderCallback:
+ * @event: the event which the instance is of; either a recurring event, an exception to one, or a single event
+ * @start_time: the start time of the instance, as a UNIX timestamp
+ * @end_time: the end time of the instance, as a UNIX timestamp
+ * @is_date: %TRUE if the instance is an all-day one, in which case @start_time and @end_time refer to midnight UTC on the relevant days
+ * @user_data: user data passed to gdata_calendar_event_expander_expand()
+ *
+ * Callback function called for each instance of an event found by gdata_calendar_event_expander_expand().
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataCalendarEventExpanderCallback) (GDataCalendarEvent *event, gint64 start_time, gint64 end_time, gboolean is_date,
+                                                    gpointer user_data);
+
+GType gdata_calendar_event_expander_get_type (void) G_GNUC_CONST;
+
+GDataCalendarEventExpander *gdata_calendar_event_expander_new (void) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+gboolean gdata_calendar_event_expander_add_event (GDataCalendarEventExpander *self, GDataCalendarEvent *event, GError **error);
+void gdata_calendar_event_expander_remove_event (GDataCalendarEventExpander *self, const gchar *event_id);
+
+guint gdata_calendar_event_expander_expand (GDataCalendarEventExpander *self, gint64 window_start, gint64 window_end,
+                                            GDataCalendarEventExpanderCallback callback, gpointer user_data);
+
+G_END_DECLS
+
+#endif /* !GDATA_CALENDAR_EVENT_EXPANDER_H */
@@ -97,6 +97,7 @@
 static GObject *gdata_calendar_event_constructor (GType type, guint n_construct_params, GObjectConstructParam *construct_params);
 static void gdata_calendar_event_dispose (GObject *object);
 static void gdata_calendar_event_finalize (GObject *object);
+static void refresh_private (GDataEntry *self, GDataEntry *other);
 static void gdata_calendar_event_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_calendar_event_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
@@ -116,10 +117,12 @@ struct _GDataCalendarEventPrivate {
 	guint guests_can_see_guests : 1;
 	guint anyone_can_add_self : 1;
 	GList *people; /* GDataGDWho */
+	xmlDoc *people_doc; /* gd:who elements which haven't been parsed into people yet; see GDataQuery:lazy-parsing */
 	GList *places; /* GDataGDWhere */
 	gchar *recurrence;
 	gchar *original_event_id;
 	gchar *original_event_uri;
+	gint64 original_start_time; /* start time of the instance this exception replaces, or -1 if unknown */
 };
 
 enum {
@@ -160,6 +163,7 @@ gdata_calendar_event_class_init (GDataCalendarEventClass *klass)
 	parsable_class->get_namespaces = get_namespaces;
 
 	entry_class->kind_term = "http://schemas.google.com/g/2005#event";
+	_gdata_entry_class_set_refresh_func (entry_class, refresh_private);
 
 	/**
 	 * GDataCalendarEvent:edited:
@@ -349,6 +353,7 @@ gdata_calendar_event_init (GDataCalendarEvent *self)
 {
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CALENDAR_EVENT, GDataCalendarEventPrivate);
 	self->priv->edited = -1;
+	self->priv->original_start_time = -1;
 }
 
 static GObject *
@@ -399,6 +404,23 @@ gdata_calendar_event_dispose (GObject *object)
 	G_OBJECT_CLASS (gdata_calendar_event_parent_class)->dispose (object);
 }
 
+static void
+refresh_private (GDataEntry *self, GDataEntry *other)
+{
+	GDataCalendarEventPrivate *priv = GDATA_CALENDAR_EVENT (self)->priv, *other_priv = GDATA_CALENDAR_EVENT (other)->priv;
+	gchar *temp;
+
+	priv->edited = other_priv->edited;
+
+	temp = priv->original_event_id;
+	priv->original_event_id = other_priv->original_event_id;
+	other_priv->original_event_id = temp;
+
+	temp = priv->original_event_uri;
+	priv->original_event_uri = other_priv->original_event_uri;
+	other_priv->original_event_uri = temp;
+}
+
 static void
 gdata_calendar_event_finalize (GObject *object)
 {
@@ -412,6 +434,9 @@ gdata_calendar_event_finalize (GObject *object)
 	g_free (priv->original_event_id);
 	g_free (priv->original_event_uri);
 
+	if (priv->people_doc != NULL)
+		xmlFreeDoc (priv->people_doc);
+
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_calendar_event_parent_class)->finalize (object);
 }
@@ -521,7 +546,11 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 	    gdata_parser_int64_time_from_element (node, "edited", P_REQUIRED | P_NO_DUPES, &(self->priv->edited), &success, error) == TRUE) {
 		return success;
 	} else if (gdata_parser_is_namespace (node, "http://schemas.google.com/g/2005") == TRUE) {
-		if (gdata_parser_object_from_element_setter (node, "when", P_REQUIRED, GDATA_TYPE_GD_WHEN,
+		if (xmlStrcmp (node->name, (xmlChar*) "who") == 0 && _gdata_parsable_is_deferring_xml (doc) == TRUE) {
+			/* gd:who; events can have thousands of attendees, so leave them until gdata_calendar_event_get_people() is called */
+			_gdata_parsable_defer_xml (&(self->priv->people_doc), doc, node);
+			return TRUE;
+		} else if (gdata_parser_object_from_element_setter (node, "when", P_REQUIRED, GDATA_TYPE_GD_WHEN,
 		                                             gdata_calendar_event_add_time, self, &success, error) == TRUE ||
 		    gdata_parser_object_from_element_setter (node, "who", P_REQUIRED, GDATA_TYPE_GD_WHO,
 		                                             gdata_calendar_event_add_person, self, &success, error) == TRUE ||
@@ -551,8 +580,26 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 			self->priv->recurrence = (gchar*) xmlNodeListGetString (doc, node->children, TRUE);
 		} else if (xmlStrcmp (node->name, (xmlChar*) "originalEvent") == 0) {
 			/* gd:originalEvent */
+			xmlNode *child_node;
+
 			self->priv->original_event_id = (gchar*) xmlGetProp (node, (xmlChar*) "id");
 			self->priv->original_event_uri = (gchar*) xmlGetProp (node, (xmlChar*) "href");
+
+			/* Its gd:when gives the original start time of the instance this exception replaces */
+			for (child_node = node->children; child_node != NULL; child_node = child_node->next) {
+				xmlChar *start_time;
+
+				if (child_node->type != XML_ELEMENT_NODE || xmlStrcmp (child_node->name, (xmlChar*) "when") != 0)
+					continue;
+
+				start_time = xmlGetProp (child_node, (xmlChar*) "startTime");
+				if (start_time != NULL &&
+				    gdata_parser_int64_from_date ((gchar*) start_time, &(self->priv->original_start_time)) == FALSE &&
+				    gdata_parser_int64_from_iso8601 ((gchar*) start_time, &(self->priv->original_start_time)) == FALSE) {
+					self->priv->original_start_time = -1;
+				}
+				xmlFree (start_time);
+			}
 		} else {
 			return GDATA_PARSABLE_CLASS (gdata_calendar_event_parent_class)->parse_xml (parsable, doc, node, user_data, error);
 		}
@@ -670,6 +717,7 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 		gdata_parser_string_append_escaped (xml_string, "<gd:recurrence>", priv->recurrence, "</gd:recurrence>");
 
 	get_child_xml (priv->times, xml_string);
+	_gdata_parsable_parse_deferred_xml (parsable, &(priv->people_doc));
 	get_child_xml (priv->people, xml_string);
 	get_child_xml (priv->places, xml_string);
 
@@ -1025,6 +1073,9 @@ gdata_calendar_event_add_person (GDataCalendarEvent *self, GDataGDWho *who)
 	g_return_if_fail (GDATA_IS_CALENDAR_EVENT (self));
 	g_return_if_fail (GDATA_IS_GD_WHO (who));
 
+	/* Keep the people in their original order */
+	_gdata_parsable_parse_deferred_xml (GDATA_PARSABLE (self), &(self->priv->people_doc));
+
 	if (g_list_find_custom (self->priv->people, who, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->people = g_list_append (self->priv->people, g_object_ref (who));
 }
@@ -1043,6 +1094,9 @@ GList *
 gdata_calendar_event_get_people (GDataCalendarEvent *self)
 {
 	g_return_val_if_fail (GDATA_IS_CALENDAR_EVENT (self), NULL);
+
+	_gdata_parsable_parse_deferred_xml (GDATA_PARSABLE (self), &(self->priv->people_doc));
+
 	return self->priv->people;
 }
 
@@ -1253,3 +1307,22 @@ gdata_calendar_event_is_exception (GDataCalendarEvent *self)
 	g_return_val_if_fail (GDATA_IS_CALENDAR_EVENT (self), FALSE);
 	return (self->priv->original_event_id != NULL && self->priv->original_event_uri != NULL) ? TRUE : FALSE;
 }
+
+/*
+ * _gdata_calendar_event_get_original_start_time:
+ * @self: a #GDataCalendarEvent
+ *
+ * Gets the original start time of the instance of a recurring event which this exception replaces, as given in its
+ * <literal>gd:originalEvent</literal> element.
+ *
+ * Return value: the original start time as a UNIX timestamp, or <code class="literal">-1</code> if the event isn't an exception or the time
+ * is unknown
+ *
+ * Since: 0.15.0
+ */
+gint64
+_gdata_calendar_event_get_original_start_time (GDataCalendarEvent *self)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_EVENT (self), -1);
+	return self->priv->original_start_time;
+}
@@ -0,0 +1,755 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-calendar-free-busy-index
+ * @short_description: GData Calendar local free/busy index
+ * @stability: Unstable
+ * @include: gdata/services/calendar/gdata-calendar-free-busy-index.h
+ *
+ * #GDataCalendarFreeBusyIndex keeps the times of a set of #GDataCalendarEvent<!-- -->s in an interval tree, so that questions such as “which
+ * events overlap this hour?”, “is this afternoon free?” or “when is the next free half-hour slot?” can be answered locally in logarithmic time,
+ * rather than by scanning every event or by querying the server each time.
+ *
+ * Events can be added from a feed using gdata_calendar_free_busy_index_add_feed(), or individually using
+ * gdata_calendar_free_busy_index_add_event(). The index also implements #GDataCalendarSyncStore, so it can be passed straight to
+ * gdata_calendar_sync_new() to be kept up to date incrementally as calendars are synchronised.
+ *
+ * Each of an event's #GDataGDWhen<!-- -->s is indexed as a separate busy period. Cancelled events, and events whose transparency is
+ * %GDATA_GD_EVENT_TRANSPARENCY_TRANSPARENT, don't make any time busy, and aren't indexed. Recurring events are only indexed by the times they
+ * carry; to index each of their instances, query for them with gdata_calendar_query_set_single_events() set, or add their expanded instances
+ * individually using #GDataCalendarEventExpander.
+ *
+ * All times are treated as half-open intervals: an event which ends at the exact time another starts doesn't overlap it.
+ *
+ * The index is thread-safe.
+ *
+ * <example>
+ *	<title>Finding a Free Slot for a Meeting</title>
+ *	<programlisting>
+ *	GDataCalendarFreeBusyIndex *index;
+ *	gint64 slot_start;
+ *
+ *	/<!-- -->* Index the events from a query, which should have gdata_calendar_query_set_single_events() set *<!-- -->/
+ *	index = gdata_calendar_free_busy_index_new ();
+ *	gdata_calendar_free_busy_index_add_feed (index, calendar, feed);
+ *
+ *	/<!-- -->* Find the first free hour in the working day *<!-- -->/
+ *	slot_start = gdata_calendar_free_busy_index_find_free_slot (index, day_start + 9 * 60 * 60, day_start + 17 * 60 * 60, 60 * 60);
+ *
+ *	if (slot_start == -1)
+ *		g_message ("No free hour today.");
+ *	else
+ *		schedule_meeting (slot_start, slot_start + 60 * 60);
+ *
+ *	g_object_unref (index);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-calendar-free-busy-index.h"
+#include "gdata-calendar-sync.h"
+#include "gdata-gd-when.h"
+
+/* Length assumed for all-day times which don't have an end date */
+#define DAY_LENGTH (24 * 60 * 60)
+
+typedef struct _IntervalNode IntervalNode;
+
+typedef struct {
+	GDataCalendarEvent *event; /* owned */
+	gchar *calendar_id; /* owned; NULL if the event wasn't added with a calendar */
+	GPtrArray *nodes; /* IntervalNode; the nodes are owned by the tree */
+} IndexedEvent;
+
+/* A node in a treap ordered by start time, augmented with the latest end time in each subtree so that overlap searches can skip whole subtrees */
+struct _IntervalNode {
+	gint64 start_time;
+	gint64 end_time;
+	gint64 max_end_time; /* latest end_time of this node and its descendants */
+	guint32 priority;
+	IndexedEvent *event;
+	IntervalNode *left;
+	IntervalNode *right;
+};
+
+/* Called for each node overlapping a range, in order of start time; returns FALSE to stop the traversal */
+typedef gboolean (*IntervalNodeFunc) (IntervalNode *node, gpointer user_data);
+
+static void gdata_calendar_free_busy_index_sync_store_init (GDataCalendarSyncStoreInterface *iface);
+static void gdata_calendar_free_busy_index_finalize (GObject *object);
+
+struct _GDataCalendarFreeBusyIndexPrivate {
+	GMutex mutex; /* protects all the other fields */
+	GHashTable *events; /* event ID → IndexedEvent */
+	IntervalNode *root;
+	GRand *rand; /* for node priorities */
+};
+
+G_DEFINE_TYPE_WITH_CODE (GDataCalendarFreeBusyIndex, gdata_calendar_free_busy_index, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_CALENDAR_SYNC_STORE, gdata_calendar_free_busy_index_sync_store_init))
+
+static void
+gdata_calendar_free_busy_index_class_init (GDataCalendarFreeBusyIndexClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataCalendarFreeBusyIndexPrivate));
+
+	gobject_class->finalize = gdata_calendar_free_busy_index_finalize;
+}
+
+static void
+indexed_event_free (IndexedEvent *data)
+{
+	g_object_unref (data->event);
+	g_free (data->calendar_id);
+	g_ptr_array_free (data->nodes, TRUE);
+	g_slice_free (IndexedEvent, data);
+}
+
+static void
+gdata_calendar_free_busy_index_init (GDataCalendarFreeBusyIndex *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CALENDAR_FREE_BUSY_INDEX, GDataCalendarFreeBusyIndexPrivate);
+	g_mutex_init (&(self->priv->mutex));
+	self->priv->events = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) indexed_event_free);
+	self->priv->rand = g_rand_new ();
+}
+
+static void
+tree_free (IntervalNode *node)
+{
+	if (node == NULL)
+		return;
+
+	tree_free (node->left);
+	tree_free (node->right);
+	g_slice_free (IntervalNode, node);
+}
+
+static void
+gdata_calendar_free_busy_index_finalize (GObject *object)
+{
+	GDataCalendarFreeBusyIndexPrivate *priv = GDATA_CALENDAR_FREE_BUSY_INDEX (object)->priv;
+
+	tree_free (priv->root);
+	g_hash_table_destroy (priv->events);
+	g_rand_free (priv->rand);
+	g_mutex_clear (&(priv->mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_calendar_free_busy_index_parent_class)->finalize (object);
+}
+
+static gboolean
+sync_store_reset_calendar (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GError **error)
+{
+	gdata_calendar_free_busy_index_remove_calendar (GDATA_CALENDAR_FREE_BUSY_INDEX (self), calendar);
+	return TRUE;
+}
+
+static gboolean
+sync_store_apply_event (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GDataCalendarEvent *event, GError **error)
+{
+	gdata_calendar_free_busy_index_add_event (GDATA_CALENDAR_FREE_BUSY_INDEX (self), calendar, event);
+	return TRUE;
+}
+
+static gboolean
+sync_store_remove_event (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, const gchar *event_id, GError **error)
+{
+	gdata_calendar_free_busy_index_remove_event (GDATA_CALENDAR_FREE_BUSY_INDEX (self), event_id);
+	return TRUE;
+}
+
+static void
+gdata_calendar_free_busy_index_sync_store_init (GDataCalendarSyncStoreInterface *iface)
+{
+	iface->reset_calendar = sync_store_reset_calendar;
+	iface->apply_event = sync_store_apply_event;
+	iface->remove_event = sync_store_remove_event;
+}
+
+/**
+ * gdata_calendar_free_busy_index_new:
+ *
+ * Creates a new, empty #GDataCalendarFreeBusyIndex.
+ *
+ * Return value: (transfer full): a new #GDataCalendarFreeBusyIndex; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataCalendarFreeBusyIndex *
+gdata_calendar_free_busy_index_new (void)
+{
+	return g_object_new (GDATA_TYPE_CALENDAR_FREE_BUSY_INDEX, NULL);
+}
+
+/* Orders nodes by start time, then end time; the node addresses break any remaining ties so that every node has a distinct position */
+static gint
+compare_nodes (const IntervalNode *a, const IntervalNode *b)
+{
+	if (a->start_time != b->start_time)
+		return (a->start_time < b->start_time) ? -1 : 1;
+	if (a->end_time != b->end_time)
+		return (a->end_time < b->end_time) ? -1 : 1;
+	if (a != b)
+		return (a < b) ? -1 : 1;
+	return 0;
+}
+
+static void
+update_max_end_time (IntervalNode *node)
+{
+	node->max_end_time = node->end_time;
+
+	if (node->left != NULL && node->left->max_end_time > node->max_end_time)
+		node->max_end_time = node->left->max_end_time;
+	if (node->right != NULL && node->right->max_end_time > node->max_end_time)
+		node->max_end_time = node->right->max_end_time;
+}
+
+static IntervalNode *
+rotate_right (IntervalNode *node)
+{
+	IntervalNode *left = node->left;
+
+	node->left = left->right;
+	left->right = node;
+
+	update_max_end_time (node);
+	update_max_end_time (left);
+
+	return left;
+}
+
+static IntervalNode *
+rotate_left (IntervalNode *node)
+{
+	IntervalNode *right = node->right;
+
+	node->right = right->left;
+	right->left = node;
+
+	update_max_end_time (node);
+	update_max_end_time (right);
+
+	return right;
+}
+
+static IntervalNode *
+tree_insert (IntervalNode *root, IntervalNode *node)
+{
+	if (root == NULL)
+		return node;
+
+	if (compare_nodes (node, root) < 0) {
+		root->left = tree_insert (root->left, node);
+		if (root->left->priority > root->priority)
+			return rotate_right (root);
+	} else {
+		root->right = tree_insert (root->right, node);
+		if (root->right->priority > root->priority)
+			return rotate_left (root);
+	}
+
+	update_max_end_time (root);
+
+	return root;
+}
+
+/* Joins two treaps, where every node in @left sorts before every node in @right */
+static IntervalNode *
+tree_merge (IntervalNode *left, IntervalNode *right)
+{
+	if (left == NULL)
+		return right;
+	if (right == NULL)
+		return left;
+
+	if (left->priority > right->priority) {
+		left->right = tree_merge (left->right, right);
+		update_max_end_time (left);
+		return left;
+	}
+
+	right->left = tree_merge (left, right->left);
+	update_max_end_time (right);
+
+	return right;
+}
+
+static IntervalNode *
+tree_remove (IntervalNode *root, IntervalNode *node)
+{
+	gint comparison;
+
+	g_assert (root != NULL);
+
+	comparison = compare_nodes (node, root);
+	if (comparison == 0)
+		return tree_merge (root->left, root->right);
+	else if (comparison < 0)
+		root->left = tree_remove (root->left, node);
+	else
+		root->right = tree_remove (root->right, node);
+
+	update_max_end_time (root);
+
+	return root;
+}
+
+/* Calls @func for each node which overlaps [@start_time, @end_time), in order of start time. Returns FALSE if @func stopped the traversal. */
+static gboolean
+tree_foreach_overlapping (IntervalNode *node, gint64 start_time, gint64 end_time, IntervalNodeFunc func, gpointer user_data)
+{
+	/* Nothing in this subtree ends after the range starts */
+	if (node == NULL || node->max_end_time <= start_time)
+		return TRUE;
+
+	if (tree_foreach_overlapping (node->left, start_time, end_time, func, user_data) == FALSE)
+		return FALSE;
+
+	/* Neither this node nor anything in its right subtree starts before the range ends */
+	if (node->start_time >= end_time)
+		return TRUE;
+
+	if (node->end_time > start_time && func (node, user_data) == FALSE)
+		return FALSE;
+
+	return tree_foreach_overlapping (node->right, start_time, end_time, func, user_data);
+}
+
+/* Must be called with the mutex held */
+static void
+remove_indexed_event (GDataCalendarFreeBusyIndex *self, IndexedEvent *data)
+{
+	guint i;
+
+	for (i = 0; i < data->nodes->len; i++) {
+		IntervalNode *node = g_ptr_array_index (data->nodes, i);
+
+		self->priv->root = tree_remove (self->priv->root, node);
+		g_slice_free (IntervalNode, node);
+	}
+
+	g_ptr_array_set_size (data->nodes, 0);
+}
+
+static gboolean
+is_event_busy (GDataCalendarEvent *event)
+{
+	if (g_strcmp0 (gdata_calendar_event_get_status (event), GDATA_GD_EVENT_STATUS_CANCELED) == 0)
+		return FALSE;
+	if (g_strcmp0 (gdata_calendar_event_get_transparency (event), GDATA_GD_EVENT_TRANSPARENCY_TRANSPARENT) == 0)
+		return FALSE;
+
+	return TRUE;
+}
+
+/**
+ * gdata_calendar_free_busy_index_add_event:
+ * @self: a #GDataCalendarFreeBusyIndex
+ * @calendar: (allow-none): the calendar containing @event, or %NULL
+ * @event: the event to add
+ *
+ * Adds the times of @event to the index, replacing any previous version of the event (matched by gdata_entry_get_id()). If @event is cancelled
+ * or transparent, any previous version of it is removed, but it doesn't make any time busy.
+ *
+ * If @calendar is given, the event can later be removed along with the rest of the calendar's events using
+ * gdata_calendar_free_busy_index_remove_calendar().
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_free_busy_index_add_event (GDataCalendarFreeBusyIndex *self, GDataCalendarCalendar *calendar, GDataCalendarEvent *event)
+{
+	GDataCalendarFreeBusyIndexPrivate *priv;
+	IndexedEvent *data;
+	const gchar *event_id;
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CALENDAR_FREE_BUSY_INDEX (self));
+	g_return_if_fail (calendar == NULL || GDATA_IS_CALENDAR_CALENDAR (calendar));
+	g_return_if_fail (GDATA_IS_CALENDAR_EVENT (event));
+	g_return_if_fail (gdata_entry_get_id (GDATA_ENTRY (event)) != NULL);
+
+	priv = self->priv;
+	event_id = gdata_entry_get_id (GDATA_ENTRY (event));
+
+	g_mutex_lock (&(priv->mutex));
+
+	/* Replace any previous version of the event */
+	data = g_hash_table_lookup (priv->events, event_id);
+	if (data != NULL) {
+		remove_indexed_event (self, data);
+		g_hash_table_remove (priv->events, event_id);
+	}
+
+	if (is_event_busy (event) == FALSE) {
+		g_mutex_unlock (&(priv->mutex));
+		return;
+	}
+
+	data = g_slice_new0 (IndexedEvent);
+	data->event = g_object_ref (event);
+	data->calendar_id = (calendar != NULL) ? g_strdup (gdata_entry_get_id (GDATA_ENTRY (calendar))) : NULL;
+	data->nodes = g_ptr_array_new ();
+
+	for (i = gdata_calendar_event_get_times (event); i != NULL; i = i->next) {
+		GDataGDWhen *when = GDATA_GD_WHEN (i->data);
+		IntervalNode *node;
+		gint64 start_time, end_time;
+
+		start_time = gdata_gd_when_get_start_time (when);
+		end_time = gdata_gd_when_get_end_time (when);
+
+		/* All-day times may omit their end date, in which case they last for the day */
+		if (end_time == -1)
+			end_time = (gdata_gd_when_is_date (when) == TRUE) ? start_time + DAY_LENGTH : start_time;
+
+		/* Instantaneous times don't make anything busy */
+		if (end_time <= start_time)
+			continue;
+
+		node = g_slice_new0 (IntervalNode);
+		node->start_time = start_time;
+		node->end_time = end_time;
+		node->max_end_time = end_time;
+		node->priority = g_rand_int (priv->rand);
+		node->event = data;
+
+		priv->root = tree_insert (priv->root, node);
+		g_ptr_array_add (data->nodes, node);
+	}
+
+	g_hash_table_insert (priv->events, g_strdup (event_id), data);
+
+	g_mutex_unlock (&(priv->mutex));
+}
+
+/**
+ * gdata_calendar_free_busy_index_add_feed:
+ * @self: a #GDataCalendarFreeBusyIndex
+ * @calendar: (allow-none): the calendar which @feed was queried from, or %NULL
+ * @feed: a feed of #GDataCalendarEvent<!-- -->s
+ *
+ * Adds all the events in @feed to the index, as if by calling gdata_calendar_free_busy_index_add_event() on each of them. Entries in @feed which
+ * aren't #GDataCalendarEvent<!-- -->s are ignored.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_free_busy_index_add_feed (GDataCalendarFreeBusyIndex *self, GDataCalendarCalendar *calendar, GDataFeed *feed)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CALENDAR_FREE_BUSY_INDEX (self));
+	g_return_if_fail (calendar == NULL || GDATA_IS_CALENDAR_CALENDAR (calendar));
+	g_return_if_fail (GDATA_IS_FEED (feed));
+
+	for (i = gdata_feed_get_entries (feed); i != NULL; i = i->next) {
+		if (GDATA_IS_CALENDAR_EVENT (i->data) == TRUE && gdata_entry_get_id (GDATA_ENTRY (i->data)) != NULL)
+			gdata_calendar_free_busy_index_add_event (self, calendar, GDATA_CALENDAR_EVENT (i->data));
+	}
+}
+
+/**
+ * gdata_calendar_free_busy_index_remove_event:
+ * @self: a #GDataCalendarFreeBusyIndex
+ * @event_id: the ID of the event to remove, as returned by gdata_entry_get_id()
+ *
+ * Removes the event with ID @event_id from the index. If no such event has been added, this does nothing.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_free_busy_index_remove_event (GDataCalendarFreeBusyIndex *self, const gchar *event_id)
+{
+	IndexedEvent *data;
+
+	g_return_if_fail (GDATA_IS_CALENDAR_FREE_BUSY_INDEX (self));
+	g_return_if_fail (event_id != NULL);
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	data = g_hash_table_lookup (self->priv->events, event_id);
+	if (data != NULL) {
+		remove_indexed_event (self, data);
+		g_hash_table_remove (self->priv->events, event_id);
+	}
+
+	g_mutex_unlock (&(self->priv->mutex));
+}
+
+/**
+ * gdata_calendar_free_busy_index_remove_calendar:
+ * @self: a #GDataCalendarFreeBusyIndex
+ * @calendar: the calendar whose events should be removed
+ *
+ * Removes all the events which were added to the index with @calendar (matched by gdata_entry_get_id()). Events added without a calendar are
+ * left alone.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_free_busy_index_remove_calendar (GDataCalendarFreeBusyIndex *self, GDataCalendarCalendar *calendar)
+{
+	GHashTableIter iter;
+	IndexedEvent *data;
+	const gchar *calendar_id;
+
+	g_return_if_fail (GDATA_IS_CALENDAR_FREE_BUSY_INDEX (self));
+	g_return_if_fail (GDATA_IS_CALENDAR_CALENDAR (calendar));
+
+	calendar_id = gdata_entry_get_id (GDATA_ENTRY (calendar));
+	if (calendar_id == NULL)
+		return;
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	g_hash_table_iter_init (&iter, self->priv->events);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &data) == TRUE) {
+		if (g_strcmp0 (data->calendar_id, calendar_id) == 0) {
+			remove_indexed_event (self, data);
+			g_hash_table_iter_remove (&iter);
+		}
+	}
+
+	g_mutex_unlock (&(self->priv->mutex));
+}
+
+typedef struct {
+	GHashTable *seen; /* IndexedEvent set */
+	GList *events;
+} GetEventsData;
+
+static gboolean
+get_events_cb (IntervalNode *node, GetEventsData *data)
+{
+	if (g_hash_table_lookup (data->seen, node->event) == NULL) {
+		g_hash_table_insert (data->seen, node->event, node->event);
+		data->events = g_list_prepend (data->events, g_object_ref (node->event->event));
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_calendar_free_busy_index_get_events:
+ * @self: a #GDataCalendarFreeBusyIndex
+ * @start_time: the start of the range, as a UNIX timestamp
+ * @end_time: the end of the range, as a UNIX timestamp
+ *
+ * Gets the events which are busy at some point in the range [@start_time, @end_time), in order of the earliest of their times which overlaps
+ * the range. Each event is only listed once, even if several of its times overlap the range.
+ *
+ * Return value: (element-type GData.CalendarEvent) (transfer full): a list of the overlapping #GDataCalendarEvent<!-- -->s, or %NULL; free with
+ * g_list_free_full() and g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_calendar_free_busy_index_get_events (GDataCalendarFreeBusyIndex *self, gint64 start_time, gint64 end_time)
+{
+	GetEventsData data;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_FREE_BUSY_INDEX (self), NULL);
+	g_return_val_if_fail (start_time <= end_time, NULL);
+
+	data.seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+	data.events = NULL;
+
+	g_mutex_lock (&(self->priv->mutex));
+	tree_foreach_overlapping (self->priv->root, start_time, end_time, (IntervalNodeFunc) get_events_cb, &data);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	g_hash_table_destroy (data.seen);
+
+	return g_list_reverse (data.events);
+}
+
+static gboolean
+is_free_cb (IntervalNode *node, gboolean *is_free)
+{
+	*is_free = FALSE;
+	return FALSE;
+}
+
+/**
+ * gdata_calendar_free_busy_index_is_free:
+ * @self: a #GDataCalendarFreeBusyIndex
+ * @start_time: the start of the range, as a UNIX timestamp
+ * @end_time: the end of the range, as a UNIX timestamp
+ *
+ * Checks whether no indexed events are busy at any point in the range [@start_time, @end_time).
+ *
+ * Return value: %TRUE if the whole range is free, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_free_busy_index_is_free (GDataCalendarFreeBusyIndex *self, gint64 start_time, gint64 end_time)
+{
+	gboolean is_free = TRUE;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_FREE_BUSY_INDEX (self), FALSE);
+	g_return_val_if_fail (start_time <= end_time, FALSE);
+
+	g_mutex_lock (&(self->priv->mutex));
+	tree_foreach_overlapping (self->priv->root, start_time, end_time, (IntervalNodeFunc) is_free_cb, &is_free);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return is_free;
+}
+
+typedef struct {
+	gint64 duration;
+	gint64 free_from; /* end of the busy time seen so far */
+	gboolean found;
+} FindFreeSlotData;
+
+static gboolean
+find_free_slot_cb (IntervalNode *node, FindFreeSlotData *data)
+{
+	/* Nodes are visited in order of start time, so the gap before this one can't be filled by any node still to come */
+	if (node->start_time - data->free_from >= data->duration) {
+		data->found = TRUE;
+		return FALSE;
+	}
+
+	data->free_from = MAX (data->free_from, node->end_time);
+
+	return TRUE;
+}
+
+/**
+ * gdata_calendar_free_busy_index_find_free_slot:
+ * @self: a #GDataCalendarFreeBusyIndex
+ * @start_time: the start of the range to search, as a UNIX timestamp
+ * @end_time: the end of the range to search, as a UNIX timestamp
+ * @duration: the length of the slot to find, in seconds
+ *
+ * Finds the earliest time in the range [@start_time, @end_time) at which a slot @duration seconds long is free, with the whole slot lying
+ * within the range.
+ *
+ * Return value: the start of the earliest free slot as a UNIX timestamp, or <code class="literal">-1</code> if there isn't one
+ *
+ * Since: 0.15.0
+ */
+gint64
+gdata_calendar_free_busy_index_find_free_slot (GDataCalendarFreeBusyIndex *self, gint64 start_time, gint64 end_time, gint64 duration)
+{
+	FindFreeSlotData data;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_FREE_BUSY_INDEX (self), -1);
+	g_return_val_if_fail (start_time <= end_time, -1);
+	g_return_val_if_fail (duration > 0, -1);
+
+	data.duration = duration;
+	data.free_from = start_time;
+	data.found = FALSE;
+
+	g_mutex_lock (&(self->priv->mutex));
+	tree_foreach_overlapping (self->priv->root, start_time, end_time, (IntervalNodeFunc) find_free_slot_cb, &data);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	if (data.found == TRUE || end_time - data.free_from >= duration)
+		return data.free_from;
+
+	return -1;
+}
+
+typedef struct {
+	gint64 start_time;
+	gint64 end_time;
+	gboolean in_period;
+	gint64 period_start;
+	gint64 period_end;
+	GList *periods;
+} GetBusyPeriodsData;
+
+static gboolean
+get_busy_periods_cb (IntervalNode *node, GetBusyPeriodsData *data)
+{
+	gint64 start_time, end_time;
+
+	start_time = MAX (node->start_time, data->start_time);
+	end_time = MIN (node->end_time, data->end_time);
+
+	if (data->in_period == TRUE && start_time <= data->period_end) {
+		/* Extend the current period */
+		data->period_end = MAX (data->period_end, end_time);
+	} else {
+		/* Finish the current period and start a new one */
+		if (data->in_period == TRUE)
+			data->periods = g_list_prepend (data->periods, gdata_gd_when_new (data->period_start, data->period_end, FALSE));
+
+		data->in_period = TRUE;
+		data->period_start = start_time;
+		data->period_end = end_time;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_calendar_free_busy_index_get_busy_periods:
+ * @self: a #GDataCalendarFreeBusyIndex
+ * @start_time: the start of the range, as a UNIX timestamp
+ * @end_time: the end of the range, as a UNIX timestamp
+ *
+ * Gets the periods within the range [@start_time, @end_time) during which at least one indexed event is busy. Overlapping and adjacent busy
+ * times are merged into a single period, and periods are clipped to the range, so the returned periods are disjoint and in order.
+ *
+ * Return value: (element-type GData.GDWhen) (transfer full): a list of #GDataGDWhen<!-- -->s giving the busy periods, or %NULL; free with
+ * g_list_free_full() and g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_calendar_free_busy_index_get_busy_periods (GDataCalendarFreeBusyIndex *self, gint64 start_time, gint64 end_time)
+{
+	GetBusyPeriodsData data;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_FREE_BUSY_INDEX (self), NULL);
+	g_return_val_if_fail (start_time <= end_time, NULL);
+
+	data.start_time = start_time;
+	data.end_time = end_time;
+	data.in_period = FALSE;
+	data.period_start = 0;
+	data.period_end = 0;
+	data.periods = NULL;
+
+	g_mutex_lock (&(self->priv->mutex));
+	tree_foreach_overlapping (self->priv->root, start_time, end_time, (IntervalNodeFunc) get_busy_periods_cb, &data);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	if (data.in_period == TRUE)
+		data.periods = g_list_prepend (data.periods, gdata_gd_when_new (data.period_start, data.period_end, FALSE));
+
+	return g_list_reverse (data.periods);
+}
@@ -0,0 +1,86 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_CALENDAR_FREE_BUSY_INDEX_H
+#define GDATA_CALENDAR_FREE_BUSY_INDEX_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gdata/gdata-feed.h>
+#include <gdata/services/calendar/gdata-calendar-calendar.h>
+#include <gdata/services/calendar/gdata-calendar-event.h>
+#include <gdata/services/calendar/gdata-calendar-sync.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_CALENDAR_FREE_BUSY_INDEX		(gdata_calendar_free_busy_index_get_type ())
+#define GDATA_CALENDAR_FREE_BUSY_INDEX(o) \
+	(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CALENDAR_FREE_BUSY_INDEX, GDataCalendarFreeBusyIndex))
+#define GDATA_CALENDAR_FREE_BUSY_INDEX_CLASS(k) \
+	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CALENDAR_FREE_BUSY_INDEX, GDataCalendarFreeBusyIndexClass))
+#define GDATA_IS_CALENDAR_FREE_BUSY_INDEX(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CALENDAR_FREE_BUSY_INDEX))
+#define GDATA_IS_CALENDAR_FREE_BUSY_INDEX_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_CALENDAR_FREE_BUSY_INDEX))
+#define GDATA_CALENDAR_FREE_BUSY_INDEX_GET_CLASS(o) \
+	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_CALENDAR_FREE_BUSY_INDEX, GDataCalendarFreeBusyIndexClass))
+
+typedef struct _GDataCalendarFreeBusyIndexPrivate	GDataCalendarFreeBusyIndexPrivate;
+
+/**
+ * GDataCalendarFreeBusyIndex:
+ *
+ * All the fields in the #GDataCalendarFreeBusyIndex structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataCalendarFreeBusyIndexPrivate *priv;
+} GDataCalendarFreeBusyIndex;
+
+/**
+ * GDataCalendarFreeBusyIndexClass:
+ *
+ * All the fields in the #GDataCalendarFreeBusyIndexClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataCalendarFreeBusyIndexClass;
+
+GType gdata_calendar_free_busy_index_get_type (void) G_GNUC_CONST;
+
+GDataCalendarFreeBusyIndex *gdata_calendar_free_busy_index_new (void) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+void gdata_calendar_free_busy_index_add_feed (GDataCalendarFreeBusyIndex *self, GDataCalendarCalendar *calendar, GDataFeed *feed);
+void gdata_calendar_free_busy_index_add_event (GDataCalendarFreeBusyIndex *self, GDataCalendarCalendar *calendar, GDataCalendarEvent *event);
+void gdata_calendar_free_busy_index_remove_event (GDataCalendarFreeBusyIndex *self, const gchar *event_id);
+void gdata_calendar_free_busy_index_remove_calendar (GDataCalendarFreeBusyIndex *self, GDataCalendarCalendar *calendar);
+
+GList *gdata_calendar_free_busy_index_get_events (GDataCalendarFreeBusyIndex *self, gint64 start_time, gint64 end_time) G_GNUC_WARN_UNUSED_RESULT;
+gboolean gdata_calendar_free_busy_index_is_free (GDataCalendarFreeBusyIndex *self, gint64 start_time, gint64 end_time);
+gint64 gdata_calendar_free_busy_index_find_free_slot (GDataCalendarFreeBusyIndex *self, gint64 start_time, gint64 end_time, gint64 duration);
+GList *gdata_calendar_free_busy_index_get_busy_periods (GDataCalendarFreeBusyIndex *self, gint64 start_time,
+                                                        gint64 end_time) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+G_END_DECLS
+
+#endif /* !GDATA_CALENDAR_FREE_BUSY_INDEX_H */
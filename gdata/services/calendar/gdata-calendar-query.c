@@ -397,6 +397,8 @@ static void
 get_query_uri (GDataQuery *self, const gchar *feed_uri, GString *query_uri, gboolean *params_started)
 {
 	GDataCalendarQueryPrivate *priv = GDATA_CALENDAR_QUERY (self)->priv;
+	gchar time_buffer[GDATA_PARSER_ISO8601_BUFFER_SIZE];
+	gsize length;
 
 	#define APPEND_SEP g_string_append_c (query_uri, (*params_started == FALSE) ? '?' : '&'); *params_started = TRUE;
 
@@ -416,23 +418,17 @@ get_query_uri (GDataQuery *self, const gchar *feed_uri, GString *query_uri, gboo
 	}
 
 	if (priv->recurrence_expansion_start != -1) {
-		gchar *recurrence_expansion_start;
-
 		APPEND_SEP
 		g_string_append (query_uri, "recurrence-expansion-start=");
-		recurrence_expansion_start = gdata_parser_int64_to_iso8601 (priv->recurrence_expansion_start);
-		g_string_append (query_uri, recurrence_expansion_start);
-		g_free (recurrence_expansion_start);
+		length = gdata_parser_int64_to_iso8601_buffer (priv->recurrence_expansion_start, time_buffer);
+		g_string_append_len (query_uri, time_buffer, length);
 	}
 
 	if (priv->recurrence_expansion_end != -1) {
-		gchar *recurrence_expansion_end;
-
 		APPEND_SEP
 		g_string_append (query_uri, "recurrence-expansion-end=");
-		recurrence_expansion_end = gdata_parser_int64_to_iso8601 (priv->recurrence_expansion_end);
-		g_string_append (query_uri, recurrence_expansion_end);
-		g_free (recurrence_expansion_end);
+		length = gdata_parser_int64_to_iso8601_buffer (priv->recurrence_expansion_end, time_buffer);
+		g_string_append_len (query_uri, time_buffer, length);
 	}
 
 	APPEND_SEP
@@ -448,23 +444,17 @@ get_query_uri (GDataQuery *self, const gchar *feed_uri, GString *query_uri, gboo
 	}
 
 	if (priv->start_min != -1) {
-		gchar *start_min;
-
 		APPEND_SEP
 		g_string_append (query_uri, "start-min=");
-		start_min = gdata_parser_int64_to_iso8601 (priv->start_min);
-		g_string_append (query_uri, start_min);
-		g_free (start_min);
+		length = gdata_parser_int64_to_iso8601_buffer (priv->start_min, time_buffer);
+		g_string_append_len (query_uri, time_buffer, length);
 	}
 
 	if (priv->start_max != -1) {
-		gchar *start_max;
-
 		APPEND_SEP
 		g_string_append (query_uri, "start-max=");
-		start_max = gdata_parser_int64_to_iso8601 (priv->start_max);
-		g_string_append (query_uri, start_max);
-		g_free (start_max);
+		length = gdata_parser_int64_to_iso8601_buffer (priv->start_max, time_buffer);
+		g_string_append_len (query_uri, time_buffer, length);
 	}
 
 	if (priv->timezone != NULL) {
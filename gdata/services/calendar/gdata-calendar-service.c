@@ -208,10 +208,12 @@
 
 #include "gdata-calendar-service.h"
 #include "gdata-batchable.h"
+#include "gdata-batch-operation.h"
 #include "gdata-service.h"
 #include "gdata-private.h"
 #include "gdata-query.h"
 #include "gdata-calendar-feed.h"
+#include "gdata-calendar-query.h"
 
 /* Standards reference here: http://code.google.com/apis/calendar/docs/2.0/reference.html */
 
@@ -590,6 +592,409 @@ gdata_calendar_service_query_events_async (GDataCalendarService *self, GDataCale
 	                           progress_callback, progress_user_data, destroy_progress_user_data, callback, user_data);
 }
 
+typedef struct {
+	GDataCalendarCalendar *calendar;
+	GQueue events; /* GDataCalendarEvent, in the order they were parsed */
+	gboolean is_finished;
+} EventStream;
+
+typedef struct {
+	GDataCalendarService *service;
+	GDataQuery *query;
+	GCancellable *cancellable;
+
+	/* Protects the EventStreams and error */
+	GMutex mutex;
+	GCond cond;
+	GError *error; /* the first error from any calendar's query */
+} QueryEventsMultipleData;
+
+typedef struct {
+	EventStream *stream;
+	QueryEventsMultipleData *data;
+} EventStreamProgressData;
+
+typedef struct {
+	GDataCalendarCalendar *calendar;
+	GDataCalendarEvent *event;
+	GDataCalendarServiceEventCallback callback;
+	gpointer user_data;
+} EventResult;
+
+static void
+event_result_free (EventResult *result)
+{
+	g_object_unref (result->calendar);
+	g_object_unref (result->event);
+	g_slice_free (EventResult, result);
+}
+
+/* Run the user-supplied callback for an event. This is designed to be used in an idle handler, so that the callback is run in the thread which
+ * started the query. */
+static gboolean
+event_result_callback_cb (EventResult *result)
+{
+	result->callback (result->calendar, result->event, result->user_data);
+	return FALSE;
+}
+
+/* Events without any times (such as recurring events queried without recurrence expansion) sort first */
+static gint64
+get_event_start_time (GDataCalendarEvent *event)
+{
+	GList *times = gdata_calendar_event_get_times (event);
+	return (times != NULL) ? gdata_gd_when_get_start_time (GDATA_GD_WHEN (times->data)) : G_MININT64;
+}
+
+static void
+query_events_multiple_progress_cb (GDataEntry *entry, guint entry_key, guint entry_count, EventStreamProgressData *progress_data)
+{
+	/* Called in the calendar's thread as each of its events is parsed */
+	g_mutex_lock (&(progress_data->data->mutex));
+	g_queue_push_tail (&(progress_data->stream->events), g_object_ref (entry));
+	g_cond_signal (&(progress_data->data->cond));
+	g_mutex_unlock (&(progress_data->data->mutex));
+}
+
+static void
+query_events_multiple_thread (EventStream *stream, QueryEventsMultipleData *data)
+{
+	EventStreamProgressData progress_data;
+	GDataQuery *query;
+	GDataFeed *feed = NULL;
+	GError *error = NULL;
+
+	/* Each calendar needs its own query, since querying updates it. The k-way merge relies on each calendar's events arriving in order of start
+	 * time, so ask the server to sort them. */
+	query = (data->query != NULL) ? _gdata_query_copy (data->query) : GDATA_QUERY (gdata_calendar_query_new (NULL));
+
+	if (GDATA_IS_CALENDAR_QUERY (query) == TRUE) {
+		gdata_calendar_query_set_order_by (GDATA_CALENDAR_QUERY (query), "starttime");
+		gdata_calendar_query_set_sort_order (GDATA_CALENDAR_QUERY (query), "ascending");
+	}
+
+	progress_data.stream = stream;
+	progress_data.data = data;
+
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &error) == FALSE) {
+		feed = gdata_calendar_service_query_events (data->service, stream->calendar, query, data->cancellable,
+		                                            (GDataQueryProgressCallback) query_events_multiple_progress_cb, &progress_data, &error);
+	}
+
+	if (feed != NULL)
+		g_object_unref (feed);
+	g_object_unref (query);
+
+	g_mutex_lock (&(data->mutex));
+
+	if (error != NULL && data->error == NULL)
+		data->error = error;
+	else if (error != NULL)
+		g_error_free (error);
+
+	stream->is_finished = TRUE;
+	g_cond_signal (&(data->cond));
+
+	g_mutex_unlock (&(data->mutex));
+}
+
+static gboolean
+query_events_multiple (GDataCalendarService *self, GList *calendars, GDataQuery *query, GCancellable *cancellable,
+                       GDataCalendarServiceEventCallback event_callback, gpointer event_user_data, GMainContext *context, gboolean is_async,
+                       GError **error)
+{
+	QueryEventsMultipleData data;
+	EventStream *streams;
+	GThreadPool *pool;
+	GList *i;
+	guint j, n_streams;
+
+	data.service = self;
+	data.query = query;
+	data.cancellable = cancellable;
+	data.error = NULL;
+	g_mutex_init (&(data.mutex));
+	g_cond_init (&(data.cond));
+
+	n_streams = g_list_length (calendars);
+	streams = g_new0 (EventStream, n_streams);
+
+	/* Query the calendars concurrently; all their event feeds are on the same host, so there's no point running more queries at once than the
+	 * service has connections to it. */
+	pool = g_thread_pool_new ((GFunc) query_events_multiple_thread, &data,
+	                          MAX (gdata_service_get_max_connections_per_host (GDATA_SERVICE (self)), 1), FALSE, NULL);
+
+	for (i = calendars, j = 0; i != NULL; i = i->next, j++) {
+		streams[j].calendar = i->data;
+		g_queue_init (&(streams[j].events));
+		g_thread_pool_push (pool, &(streams[j]), NULL);
+	}
+
+	/* k-way merge the calendars' events as they arrive. The earliest event at the head of any stream can be delivered once every unfinished
+	 * stream has an event at its head, since each stream is in order of start time. */
+	g_mutex_lock (&(data.mutex));
+
+	while (TRUE) {
+		EventStream *earliest_stream = NULL;
+		gint64 earliest_start_time = G_MAXINT64;
+		gboolean can_deliver = TRUE;
+		GDataCalendarEvent *event;
+
+		for (j = 0; j < n_streams; j++) {
+			GDataCalendarEvent *head = g_queue_peek_head (&(streams[j].events));
+
+			if (head == NULL) {
+				if (streams[j].is_finished == FALSE) {
+					can_deliver = FALSE;
+					break;
+				}
+
+				continue;
+			}
+
+			if (earliest_stream == NULL || get_event_start_time (head) < earliest_start_time) {
+				earliest_stream = &(streams[j]);
+				earliest_start_time = get_event_start_time (head);
+			}
+		}
+
+		if (can_deliver == FALSE) {
+			g_cond_wait (&(data.cond), &(data.mutex));
+			continue;
+		} else if (earliest_stream == NULL) {
+			/* All the streams are finished and empty */
+			break;
+		}
+
+		event = g_queue_pop_head (&(earliest_stream->events));
+
+		if (event_callback == NULL) {
+			g_object_unref (event);
+			continue;
+		}
+
+		g_mutex_unlock (&(data.mutex));
+
+		/* As with gdata_commentable_query_comments_multiple(), only dispatch the callbacks in the thread-default main context of the thread
+		 * which started the query if it was started with gdata_calendar_service_query_events_multiple_async(). */
+		if (is_async == TRUE) {
+			EventResult *result = g_slice_new (EventResult);
+
+			result->calendar = g_object_ref (earliest_stream->calendar);
+			result->event = event; /* transfer ownership */
+			result->callback = event_callback;
+			result->user_data = event_user_data;
+
+			_gdata_service_idle_add (context, (GSourceFunc) event_result_callback_cb, result, (GDestroyNotify) event_result_free);
+		} else {
+			event_callback (earliest_stream->calendar, event, event_user_data);
+			g_object_unref (event);
+		}
+
+		g_mutex_lock (&(data.mutex));
+	}
+
+	g_mutex_unlock (&(data.mutex));
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_free (streams);
+	g_cond_clear (&(data.cond));
+	g_mutex_clear (&(data.mutex));
+
+	if (data.error != NULL) {
+		g_propagate_error (error, data.error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_calendar_service_query_events_multiple:
+ * @self: a #GDataCalendarService
+ * @calendars: (element-type GData.CalendarCalendar): a list of #GDataCalendarCalendar<!-- -->s to query the events of
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @event_callback: (allow-none) (scope call) (closure event_user_data): a #GDataCalendarServiceEventCallback to call for each event, or %NULL
+ * @event_user_data: (closure): data to pass to the @event_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Queries the events in each of the @calendars which match @query, as by gdata_calendar_service_query_events(), querying several calendars
+ * concurrently (up to the #GDataService:max-connections-per-host of @self). The events from all the calendars are merged into a single stream in
+ * order of their start times, and @event_callback is called for each of them as soon as it's known that no earlier event remains to be
+ * delivered. This allows a view of several calendars to be rendered incrementally.
+ *
+ * The parameters in @query (typically a #GDataCalendarQuery with a start and end time set to give a window) are applied to each calendar's query;
+ * @query itself is not modified. If @query is a #GDataCalendarQuery (or is %NULL), each calendar's events are requested in ascending order of start
+ * time, overriding any #GDataCalendarQuery:order-by and #GDataCalendarQuery:sort-order set on @query; otherwise the merge relies on the server's
+ * default ordering. Events without any times are delivered before the others. Only the page of results selected by @query is retrieved from each
+ * calendar.
+ *
+ * If querying any of the calendars fails (or the operation is cancelled), the events from the others are still delivered, but %FALSE is returned
+ * and @error is set to the first error which occurred.
+ *
+ * Return value: %TRUE if all the calendars were queried successfully, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_service_query_events_multiple (GDataCalendarService *self, GList *calendars, GDataQuery *query, GCancellable *cancellable,
+                                              GDataCalendarServiceEventCallback event_callback, gpointer event_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SERVICE (self), FALSE);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = calendars; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_CALENDAR_CALENDAR (i->data), FALSE);
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (self)),
+	                                               get_calendar_authorization_domain ()) == FALSE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+		                     _("You must be authenticated to query your own calendars."));
+		return FALSE;
+	}
+
+	return query_events_multiple (self, calendars, query, cancellable, event_callback, event_user_data, NULL, FALSE, error);
+}
+
+typedef struct {
+	GList *calendars;
+	GDataQuery *query;
+	GDataCalendarServiceEventCallback event_callback;
+	gpointer event_user_data;
+	GDestroyNotify destroy_event_user_data;
+	GMainContext *context;
+} QueryEventsMultipleAsyncData;
+
+static void
+query_events_multiple_async_data_free (QueryEventsMultipleAsyncData *data)
+{
+	g_list_free_full (data->calendars, g_object_unref);
+	if (data->query != NULL)
+		g_object_unref (data->query);
+
+	if (data->destroy_event_user_data != NULL)
+		data->destroy_event_user_data (data->event_user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (QueryEventsMultipleAsyncData, data);
+}
+
+static void
+query_events_multiple_async_thread (GSimpleAsyncResult *result, GDataCalendarService *service, GCancellable *cancellable)
+{
+	QueryEventsMultipleAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	if (query_events_multiple (service, data->calendars, data->query, cancellable, data->event_callback, data->event_user_data,
+	                           data->context, TRUE, &error) == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_calendar_service_query_events_multiple_async:
+ * @self: a #GDataCalendarService
+ * @calendars: (element-type GData.CalendarCalendar): a list of #GDataCalendarCalendar<!-- -->s to query the events of
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @event_callback: (allow-none) (closure event_user_data): a #GDataCalendarServiceEventCallback to call for each event, or %NULL
+ * @event_user_data: (closure): data to pass to the @event_callback function
+ * @destroy_event_user_data: (allow-none): the function to call when @event_callback will not be called any more, or %NULL. This function will be
+ * called with @event_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the queries are finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Queries the events in each of the @calendars which match @query, passing them to @event_callback in order of their start times, in idle functions
+ * in the thread-default main context of the thread which called this function (see g_main_context_push_thread_default()). @self, @calendars and
+ * @query are all reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_calendar_service_query_events_multiple(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_calendar_service_query_events_multiple_finish() to get the
+ * results of the operation. @event_callback is guaranteed to have been called for every event before @callback is called.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_service_query_events_multiple_async (GDataCalendarService *self, GList *calendars, GDataQuery *query, GCancellable *cancellable,
+                                                    GDataCalendarServiceEventCallback event_callback, gpointer event_user_data,
+                                                    GDestroyNotify destroy_event_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	QueryEventsMultipleAsyncData *data;
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CALENDAR_SERVICE (self));
+	g_return_if_fail (query == NULL || GDATA_IS_QUERY (query));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = calendars; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_CALENDAR_CALENDAR (i->data));
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_calendar_service_query_events_multiple_async);
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (self)),
+	                                               get_calendar_authorization_domain ()) == FALSE) {
+		g_simple_async_result_set_error (result, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED, "%s",
+		                                 _("You must be authenticated to query your own calendars."));
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+
+		if (destroy_event_user_data != NULL)
+			destroy_event_user_data (event_user_data);
+
+		return;
+	}
+
+	data = g_slice_new0 (QueryEventsMultipleAsyncData);
+	data->calendars = g_list_copy (calendars);
+	g_list_foreach (data->calendars, (GFunc) g_object_ref, NULL);
+	data->query = (query != NULL) ? g_object_ref (query) : NULL;
+	data->event_callback = event_callback;
+	data->event_user_data = event_user_data;
+	data->destroy_event_user_data = destroy_event_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_events_multiple_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_events_multiple_async_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_calendar_service_query_events_multiple_finish:
+ * @self: a #GDataCalendarService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous multiple calendar event query operation started with gdata_calendar_service_query_events_multiple_async().
+ *
+ * Return value: %TRUE if all the calendars were queried successfully, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_service_query_events_multiple_finish (GDataCalendarService *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self),
+	                                                      gdata_calendar_service_query_events_multiple_async) == TRUE, FALSE);
+
+	return (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == FALSE) ? TRUE : FALSE;
+}
+
 /**
  * gdata_calendar_service_insert_event:
  * @self: a #GDataCalendarService
@@ -658,3 +1063,256 @@ gdata_calendar_service_insert_event_async (GDataCalendarService *self, GDataCale
 	                                  callback, user_data);
 	g_free (uri);
 }
+
+/* Data shared by all the operations in a batched insertion of events. It's attached to the GDataBatchOperation, so lives as long as it does. */
+typedef struct _BatchData BatchData;
+
+typedef struct {
+	BatchData *data;
+	guint index;
+	GDataCalendarEvent *event;
+} BatchItem;
+
+struct _BatchData {
+	GDataCalendarServiceBatchCallback callback;
+	gpointer user_data;
+	GDestroyNotify destroy_user_data;
+	guint n_items;
+	BatchItem *items; /* one per input event */
+};
+
+static void
+batch_data_free (BatchData *data)
+{
+	guint i;
+
+	for (i = 0; i < data->n_items; i++)
+		g_object_unref (data->items[i].event);
+	g_free (data->items);
+
+	if (data->destroy_user_data != NULL)
+		data->destroy_user_data (data->user_data);
+
+	g_slice_free (BatchData, data);
+}
+
+static void
+batch_operation_cb (guint operation_id, GDataBatchOperationType operation_type, GDataEntry *entry, GError *error, BatchItem *item)
+{
+	item->data->callback (item->index, item->event, (entry != NULL) ? GDATA_CALENDAR_EVENT (entry) : NULL, error, item->data->user_data);
+}
+
+/* Builds a batch operation against the batch feed of @calendar's events (or of the default calendar's, if @calendar is %NULL) to insert each of
+ * @events. On error, @destroy_user_data isn't called. */
+static GDataBatchOperation *
+create_events_batch_operation (GDataCalendarService *self, GDataCalendarCalendar *calendar, GList *events,
+                               GDataCalendarServiceBatchCallback callback, gpointer user_data, GDestroyNotify destroy_user_data, GError **error)
+{
+	GDataBatchOperation *operation;
+	BatchData *data;
+	GList *i;
+	gchar *feed_uri;
+	guint j;
+
+	if (calendar == NULL) {
+		feed_uri = g_strconcat (_gdata_service_get_scheme (), "://www.google.com/calendar/feeds/default/private/full/batch", NULL);
+	} else if (gdata_entry_get_content_uri (GDATA_ENTRY (calendar)) != NULL) {
+		/* The calendar's content src is its events feed */
+		feed_uri = g_strconcat (gdata_entry_get_content_uri (GDATA_ENTRY (calendar)), "/batch", NULL);
+	} else {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+		                     _("The calendar did not have a content URI."));
+		return NULL;
+	}
+
+	operation = gdata_batchable_create_operation (GDATA_BATCHABLE (self), get_calendar_authorization_domain (), feed_uri);
+	g_free (feed_uri);
+
+	/* The batch operation splits the events into server-sized requests itself; send as many of them at once as we have connections for */
+	gdata_batch_operation_set_max_operations_per_request (operation, GDATA_BATCH_MAX_OPERATIONS_PER_REQUEST);
+	gdata_batch_operation_set_max_concurrent_requests (operation, MAX (gdata_service_get_max_connections_per_host (GDATA_SERVICE (self)), 1));
+
+	data = g_slice_new0 (BatchData);
+	data->callback = callback;
+	data->user_data = user_data;
+	data->destroy_user_data = destroy_user_data;
+	data->n_items = g_list_length (events);
+	data->items = g_new (BatchItem, data->n_items);
+	g_object_set_data_full (G_OBJECT (operation), "calendar-batch-data", data, (GDestroyNotify) batch_data_free);
+
+	for (i = events, j = 0; i != NULL; i = i->next, j++) {
+		BatchItem *item = &(data->items[j]);
+
+		item->data = data;
+		item->index = j;
+		item->event = g_object_ref (i->data);
+
+		gdata_batch_operation_add_insertion (operation, GDATA_ENTRY (i->data),
+		                                     (callback != NULL) ? (GDataBatchOperationCallback) batch_operation_cb : NULL, item);
+	}
+
+	return operation;
+}
+
+/**
+ * gdata_calendar_service_insert_events:
+ * @self: a #GDataCalendarService
+ * @calendar: (allow-none): the #GDataCalendarCalendar to insert the events into, or %NULL for the user's default calendar
+ * @events: (element-type GData.CalendarEvent): a list of #GDataCalendarEvent<!-- -->s to insert
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (scope call) (closure batch_user_data): a #GDataCalendarServiceBatchCallback to call when each event has been
+ * inserted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Inserts all the events in @events into @calendar using the calendar's batch feed, as by gdata_batch_operation_add_insertion(). This is much
+ * faster than inserting the events one at a time with gdata_calendar_service_insert_event() when there are many of them, such as when importing
+ * an iCalendar file. The events must not already exist on the server.
+ *
+ * The events are split into as many batch requests as necessary (see #GDataBatchOperation:max-operations-per-request), up to
+ * #GDataService:max-connections-per-host of which are sent at once. @batch_callback is called for every event, with its position in @events, with
+ * the inserted version of the event (carrying its server-assigned ID and ETag) as @result or with the error which occurred while processing it, in
+ * the order in which the server's responses arrive.
+ *
+ * If @calendar doesn't have a content URI, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error is returned and nothing is inserted. Otherwise, as with
+ * gdata_batch_operation_run(), %FALSE is returned with @error set only if a batch request failed as a whole; the other events may still have been
+ * inserted, as reported to @batch_callback.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_service_insert_events (GDataCalendarService *self, GDataCalendarCalendar *calendar, GList *events, GCancellable *cancellable,
+                                      GDataCalendarServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error)
+{
+	GDataBatchOperation *operation;
+	gboolean success;
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SERVICE (self), FALSE);
+	g_return_val_if_fail (calendar == NULL || GDATA_IS_CALENDAR_CALENDAR (calendar), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = events; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_CALENDAR_EVENT (i->data), FALSE);
+
+	/* Nothing to do */
+	if (events == NULL)
+		return TRUE;
+
+	operation = create_events_batch_operation (self, calendar, events, batch_callback, batch_user_data, NULL, error);
+	if (operation == NULL)
+		return FALSE;
+
+	success = gdata_batch_operation_run (operation, cancellable, error);
+	g_object_unref (operation);
+
+	return success;
+}
+
+static void
+insert_events_run_cb (GDataBatchOperation *operation, GAsyncResult *async_result, GSimpleAsyncResult *result)
+{
+	GError *error = NULL;
+
+	if (gdata_batch_operation_run_finish (operation, async_result, &error) == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+
+	g_simple_async_result_complete (result);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_calendar_service_insert_events_async:
+ * @self: a #GDataCalendarService
+ * @calendar: (allow-none): the #GDataCalendarCalendar to insert the events into, or %NULL for the user's default calendar
+ * @events: (element-type GData.CalendarEvent): a list of #GDataCalendarEvent<!-- -->s to insert
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (closure batch_user_data): a #GDataCalendarServiceBatchCallback to call when each event has been inserted, or
+ * %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @destroy_batch_user_data: (allow-none): the function to call when @batch_callback will not be called any more, or %NULL. This function will
+ * be called with @batch_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Inserts all the events in @events into @calendar asynchronously, calling @batch_callback for each in an idle function in the main thread.
+ * @self, @calendar and @events are reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_calendar_service_insert_events(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_calendar_service_insert_events_finish() to get the results of
+ * the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_service_insert_events_async (GDataCalendarService *self, GDataCalendarCalendar *calendar, GList *events, GCancellable *cancellable,
+                                            GDataCalendarServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                            GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	GDataBatchOperation *operation;
+	GError *error = NULL;
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CALENDAR_SERVICE (self));
+	g_return_if_fail (calendar == NULL || GDATA_IS_CALENDAR_CALENDAR (calendar));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = events; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_CALENDAR_EVENT (i->data));
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_calendar_service_insert_events_async);
+
+	/* There's nothing to do if there are no events */
+	operation = (events != NULL) ? create_events_batch_operation (self, calendar, events, batch_callback, batch_user_data,
+	                                                              destroy_batch_user_data, &error) : NULL;
+
+	if (operation == NULL) {
+		if (error != NULL) {
+			g_simple_async_result_set_from_error (result, error);
+			g_error_free (error);
+		}
+
+		if (destroy_batch_user_data != NULL)
+			destroy_batch_user_data (batch_user_data);
+
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+		return;
+	}
+
+	gdata_batch_operation_run_async (operation, cancellable, (GAsyncReadyCallback) insert_events_run_cb, result); /* transfer ref to result */
+	g_object_unref (operation);
+}
+
+/**
+ * gdata_calendar_service_insert_events_finish:
+ * @self: a #GDataCalendarService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous batched event insertion operation started with gdata_calendar_service_insert_events_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_service_insert_events_finish (GDataCalendarService *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), gdata_calendar_service_insert_events_async) == TRUE,
+	                      FALSE);
+
+	return (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == FALSE) ? TRUE : FALSE;
+}
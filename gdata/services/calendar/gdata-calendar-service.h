@@ -86,11 +86,60 @@ void gdata_calendar_service_query_events_async (GDataCalendarService *self, GDat
 
 #include <gdata/services/calendar/gdata-calendar-event.h>
 
+/**
+ * GDataCalendarServiceEventCallback:
+ * @calendar: the #GDataCalendarCalendar which @event is in
+ * @event: an event from @calendar
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called for each event found by gdata_calendar_service_query_events_multiple(), in order of the events' start times across all
+ * the queried calendars.
+ *
+ * @calendar and @event are owned by the caller; if the callback needs to keep @event, it must reference it.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataCalendarServiceEventCallback) (GDataCalendarCalendar *calendar, GDataCalendarEvent *event, gpointer user_data);
+
+gboolean gdata_calendar_service_query_events_multiple (GDataCalendarService *self, GList *calendars, GDataQuery *query, GCancellable *cancellable,
+                                                       GDataCalendarServiceEventCallback event_callback, gpointer event_user_data,
+                                                       GError **error);
+void gdata_calendar_service_query_events_multiple_async (GDataCalendarService *self, GList *calendars, GDataQuery *query,
+                                                         GCancellable *cancellable, GDataCalendarServiceEventCallback event_callback,
+                                                         gpointer event_user_data, GDestroyNotify destroy_event_user_data,
+                                                         GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_calendar_service_query_events_multiple_finish (GDataCalendarService *self, GAsyncResult *async_result, GError **error);
+
 GDataCalendarEvent *gdata_calendar_service_insert_event (GDataCalendarService *self, GDataCalendarEvent *event,
                                                          GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 void gdata_calendar_service_insert_event_async (GDataCalendarService *self, GDataCalendarEvent *event, GCancellable *cancellable,
                                                 GAsyncReadyCallback callback, gpointer user_data);
 
+/**
+ * GDataCalendarServiceBatchCallback:
+ * @index: the position of @event in the list of events passed to the batch function
+ * @event: the #GDataCalendarEvent which was passed to the batch function
+ * @result: (allow-none): the event returned by the server, or %NULL on error
+ * @error: (allow-none): the error which occurred while processing @event, or %NULL on success
+ * @user_data: user data passed to the batch function
+ *
+ * Callback for gdata_calendar_service_insert_events(), called once for each event passed to it. @result carries the event's server-assigned ID and
+ * ETag. @event, @result and @error are owned by the batch operation; they must be reffed or copied if they need to outlive the callback.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataCalendarServiceBatchCallback) (guint index, GDataCalendarEvent *event, GDataCalendarEvent *result, GError *error,
+                                                   gpointer user_data);
+
+gboolean gdata_calendar_service_insert_events (GDataCalendarService *self, GDataCalendarCalendar *calendar, GList *events,
+                                               GCancellable *cancellable, GDataCalendarServiceBatchCallback batch_callback,
+                                               gpointer batch_user_data, GError **error);
+void gdata_calendar_service_insert_events_async (GDataCalendarService *self, GDataCalendarCalendar *calendar, GList *events,
+                                                 GCancellable *cancellable, GDataCalendarServiceBatchCallback batch_callback,
+                                                 gpointer batch_user_data, GDestroyNotify destroy_batch_user_data,
+                                                 GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_calendar_service_insert_events_finish (GDataCalendarService *self, GAsyncResult *async_result, GError **error);
+
 G_END_DECLS
 
 #endif /* !GDATA_CALENDAR_SERVICE_H */
@@ -0,0 +1,902 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-calendar-sync
+ * @short_description: GData Calendar incremental synchronisation
+ * @stability: Unstable
+ * @include: gdata/services/calendar/gdata-calendar-sync.h
+ *
+ * #GDataCalendarSync keeps a local copy of the events in a set of calendars up to date, by only downloading the events which have been added,
+ * changed or deleted in each calendar since it was last synchronised, rather than re-querying the whole of each calendar.
+ *
+ * The local copy is accessed through the #GDataCalendarSyncStore interface, which the application implements. #GDataCalendarSync tracks a
+ * <firstterm>watermark</firstterm> for each calendar: the server's time at the start of the calendar's last successful synchronisation. Each run
+ * of gdata_calendar_sync_run() on a calendar queries for events updated since its watermark (using #GDataQuery:updated-min and
+ * #GDataCalendarQuery:show-deleted), walks all the pages of results, applies them to the store, and then updates the watermark. Calendars which
+ * don't have a watermark yet are fully synchronised.
+ *
+ * If a synchronisation window has been set with gdata_calendar_sync_set_window(), only events in the window are synchronised, and recurring events
+ * are expanded into their instances within the window. As the query only returns changed events, only the recurrences which have changed are
+ * expanded. Changing the window causes each calendar to be fully synchronised again the next time it's run, since events which haven't changed
+ * may have moved into the window.
+ *
+ * The watermarks are taken from the server's clock, so they're unaffected by skew in the local clock. To allow for changes which the server hasn't
+ * finished propagating when a watermark is taken, each query starts #GDataCalendarSync:clock-skew-margin seconds before the watermark; so some
+ * events may be applied to the store more than once.
+ *
+ * The watermarks can be saved with gdata_calendar_sync_save_state() and restored in a later process with gdata_calendar_sync_load_state(), so that
+ * synchronisation can be resumed where it left off. Several calendars may be synchronised at once using gdata_calendar_sync_run_async().
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <string.h>
+
+#include "gdata-calendar-sync.h"
+#include "gdata-calendar-query.h"
+#include "gdata-parsable.h"
+#include "gdata-private.h"
+
+/* First line of the serialised state; bump the version if the format changes */
+#define STATE_HEADER "GDataCalendarSync 1"
+
+G_DEFINE_INTERFACE (GDataCalendarSyncStore, gdata_calendar_sync_store, G_TYPE_OBJECT)
+
+static void
+gdata_calendar_sync_store_default_init (GDataCalendarSyncStoreInterface *iface)
+{
+	/* Nothing to see here */
+}
+
+static void gdata_calendar_sync_dispose (GObject *object);
+static void gdata_calendar_sync_finalize (GObject *object);
+static void gdata_calendar_sync_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_calendar_sync_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+/* The synchronisation state of a single calendar */
+typedef struct {
+	gint64 watermark;
+	gint64 window_start; /* the window the calendar was last synchronised with */
+	gint64 window_end;
+} CalendarState;
+
+struct _GDataCalendarSyncPrivate {
+	GDataCalendarService *service;
+	GDataCalendarSyncStore *store;
+	gint64 window_start;
+	gint64 window_end;
+	guint clock_skew_margin;
+	guint page_size;
+
+	GMutex mutex; /* protects calendars */
+	GHashTable *calendars; /* calendar ID → CalendarState */
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_STORE,
+	PROP_WINDOW_START,
+	PROP_WINDOW_END,
+	PROP_CLOCK_SKEW_MARGIN,
+	PROP_PAGE_SIZE,
+};
+
+G_DEFINE_TYPE (GDataCalendarSync, gdata_calendar_sync, G_TYPE_OBJECT)
+
+static void
+gdata_calendar_sync_class_init (GDataCalendarSyncClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataCalendarSyncPrivate));
+
+	gobject_class->get_property = gdata_calendar_sync_get_property;
+	gobject_class->set_property = gdata_calendar_sync_set_property;
+	gobject_class->dispose = gdata_calendar_sync_dispose;
+	gobject_class->finalize = gdata_calendar_sync_finalize;
+
+	/**
+	 * GDataCalendarSync:service:
+	 *
+	 * The service to query for changed events.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service to query for changed events.",
+	                                                      GDATA_TYPE_CALENDAR_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataCalendarSync:store:
+	 *
+	 * The local store to apply changed events to.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_STORE,
+	                                 g_param_spec_object ("store",
+	                                                      "Store", "The local store to apply changed events to.",
+	                                                      GDATA_TYPE_CALENDAR_SYNC_STORE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataCalendarSync:window-start:
+	 *
+	 * The start of the synchronisation window, as a UNIX timestamp, or <code class="literal">-1</code>. See gdata_calendar_sync_set_window().
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_WINDOW_START,
+	                                 g_param_spec_int64 ("window-start",
+	                                                     "Window start", "The start of the synchronisation window.",
+	                                                     -1, G_MAXINT64, -1,
+	                                                     G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataCalendarSync:window-end:
+	 *
+	 * The end of the synchronisation window, as a UNIX timestamp, or <code class="literal">-1</code>. See gdata_calendar_sync_set_window().
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_WINDOW_END,
+	                                 g_param_spec_int64 ("window-end",
+	                                                     "Window end", "The end of the synchronisation window.",
+	                                                     -1, G_MAXINT64, -1,
+	                                                     G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataCalendarSync:clock-skew-margin:
+	 *
+	 * The number of seconds before each calendar's watermark from which to query for changes, to allow for changes which hadn't propagated
+	 * through the server when the watermark was taken.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_CLOCK_SKEW_MARGIN,
+	                                 g_param_spec_uint ("clock-skew-margin",
+	                                                    "Clock skew margin", "The number of seconds before the watermark to query from.",
+	                                                    0, G_MAXUINT, 300,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataCalendarSync:page-size:
+	 *
+	 * The maximum number of events to request in each page of results.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_PAGE_SIZE,
+	                                 g_param_spec_uint ("page-size",
+	                                                    "Page size", "The maximum number of events to request in each page of results.",
+	                                                    1, G_MAXUINT, 250,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+calendar_state_free (CalendarState *state)
+{
+	g_slice_free (CalendarState, state);
+}
+
+static void
+gdata_calendar_sync_init (GDataCalendarSync *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CALENDAR_SYNC, GDataCalendarSyncPrivate);
+	self->priv->window_start = -1;
+	self->priv->window_end = -1;
+	self->priv->clock_skew_margin = 300;
+	self->priv->page_size = 250;
+
+	g_mutex_init (&(self->priv->mutex));
+	self->priv->calendars = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) calendar_state_free);
+}
+
+static void
+gdata_calendar_sync_dispose (GObject *object)
+{
+	GDataCalendarSyncPrivate *priv = GDATA_CALENDAR_SYNC (object)->priv;
+
+	g_clear_object (&priv->service);
+	g_clear_object (&priv->store);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_calendar_sync_parent_class)->dispose (object);
+}
+
+static void
+gdata_calendar_sync_finalize (GObject *object)
+{
+	GDataCalendarSyncPrivate *priv = GDATA_CALENDAR_SYNC (object)->priv;
+
+	g_hash_table_destroy (priv->calendars);
+	g_mutex_clear (&(priv->mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_calendar_sync_parent_class)->finalize (object);
+}
+
+static void
+gdata_calendar_sync_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataCalendarSyncPrivate *priv = GDATA_CALENDAR_SYNC (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_STORE:
+			g_value_set_object (value, priv->store);
+			break;
+		case PROP_WINDOW_START:
+			g_value_set_int64 (value, priv->window_start);
+			break;
+		case PROP_WINDOW_END:
+			g_value_set_int64 (value, priv->window_end);
+			break;
+		case PROP_CLOCK_SKEW_MARGIN:
+			g_value_set_uint (value, priv->clock_skew_margin);
+			break;
+		case PROP_PAGE_SIZE:
+			g_value_set_uint (value, priv->page_size);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_calendar_sync_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataCalendarSync *self = GDATA_CALENDAR_SYNC (object);
+	GDataCalendarSyncPrivate *priv = self->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_STORE:
+			priv->store = g_value_dup_object (value);
+			break;
+		case PROP_WINDOW_START:
+			gdata_calendar_sync_set_window (self, g_value_get_int64 (value), priv->window_end);
+			break;
+		case PROP_WINDOW_END:
+			gdata_calendar_sync_set_window (self, priv->window_start, g_value_get_int64 (value));
+			break;
+		case PROP_CLOCK_SKEW_MARGIN:
+			gdata_calendar_sync_set_clock_skew_margin (self, g_value_get_uint (value));
+			break;
+		case PROP_PAGE_SIZE:
+			gdata_calendar_sync_set_page_size (self, g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_calendar_sync_new:
+ * @service: the #GDataCalendarService to query for changed events
+ * @store: the #GDataCalendarSyncStore holding the local copy of the events
+ *
+ * Creates a new #GDataCalendarSync, which will keep @store up to date with the events available through @service. No calendars have watermarks
+ * initially; use gdata_calendar_sync_load_state() to restore them from a previous instance.
+ *
+ * Return value: (transfer full): a new #GDataCalendarSync; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataCalendarSync *
+gdata_calendar_sync_new (GDataCalendarService *service, GDataCalendarSyncStore *store)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SERVICE (service), NULL);
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC_STORE (store), NULL);
+
+	return g_object_new (GDATA_TYPE_CALENDAR_SYNC, "service", service, "store", store, NULL);
+}
+
+/**
+ * gdata_calendar_sync_get_service:
+ * @self: a #GDataCalendarSync
+ *
+ * Gets the #GDataCalendarSync:service property.
+ *
+ * Return value: (transfer none): the service to query for changed events
+ *
+ * Since: 0.15.0
+ */
+GDataCalendarService *
+gdata_calendar_sync_get_service (GDataCalendarSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_calendar_sync_get_store:
+ * @self: a #GDataCalendarSync
+ *
+ * Gets the #GDataCalendarSync:store property.
+ *
+ * Return value: (transfer none): the local store to apply changed events to
+ *
+ * Since: 0.15.0
+ */
+GDataCalendarSyncStore *
+gdata_calendar_sync_get_store (GDataCalendarSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC (self), NULL);
+	return self->priv->store;
+}
+
+/**
+ * gdata_calendar_sync_get_window:
+ * @self: a #GDataCalendarSync
+ * @window_start: (out caller-allocates) (allow-none): return location for the start of the window, or %NULL
+ * @window_end: (out caller-allocates) (allow-none): return location for the end of the window, or %NULL
+ *
+ * Gets the #GDataCalendarSync:window-start and #GDataCalendarSync:window-end properties.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_sync_get_window (GDataCalendarSync *self, gint64 *window_start, gint64 *window_end)
+{
+	g_return_if_fail (GDATA_IS_CALENDAR_SYNC (self));
+
+	if (window_start != NULL)
+		*window_start = self->priv->window_start;
+	if (window_end != NULL)
+		*window_end = self->priv->window_end;
+}
+
+/**
+ * gdata_calendar_sync_set_window:
+ * @self: a #GDataCalendarSync
+ * @window_start: the start of the window as a UNIX timestamp, or <code class="literal">-1</code>
+ * @window_end: the end of the window as a UNIX timestamp, or <code class="literal">-1</code>
+ *
+ * Sets the window of time in which to synchronise events. Only events which occur (at least partially) in the window are synchronised. If both
+ * @window_start and @window_end are set, recurring events are expanded into their individual instances within the window, as with
+ * #GDataCalendarQuery:single-events; otherwise recurring events are synchronised as a single event.
+ *
+ * Calendars synchronised with a different window will be fully synchronised again the next time they're run.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_sync_set_window (GDataCalendarSync *self, gint64 window_start, gint64 window_end)
+{
+	g_return_if_fail (GDATA_IS_CALENDAR_SYNC (self));
+	g_return_if_fail (window_start >= -1 && window_end >= -1);
+
+	g_object_freeze_notify (G_OBJECT (self));
+
+	if (self->priv->window_start != window_start) {
+		self->priv->window_start = window_start;
+		g_object_notify (G_OBJECT (self), "window-start");
+	}
+
+	if (self->priv->window_end != window_end) {
+		self->priv->window_end = window_end;
+		g_object_notify (G_OBJECT (self), "window-end");
+	}
+
+	g_object_thaw_notify (G_OBJECT (self));
+}
+
+/**
+ * gdata_calendar_sync_get_clock_skew_margin:
+ * @self: a #GDataCalendarSync
+ *
+ * Gets the #GDataCalendarSync:clock-skew-margin property.
+ *
+ * Return value: the margin before the watermark from which changes are queried, in seconds
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_calendar_sync_get_clock_skew_margin (GDataCalendarSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC (self), 0);
+	return self->priv->clock_skew_margin;
+}
+
+/**
+ * gdata_calendar_sync_set_clock_skew_margin:
+ * @self: a #GDataCalendarSync
+ * @clock_skew_margin: the margin before the watermark from which to query changes, in seconds
+ *
+ * Sets the #GDataCalendarSync:clock-skew-margin property.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_sync_set_clock_skew_margin (GDataCalendarSync *self, guint clock_skew_margin)
+{
+	g_return_if_fail (GDATA_IS_CALENDAR_SYNC (self));
+
+	self->priv->clock_skew_margin = clock_skew_margin;
+	g_object_notify (G_OBJECT (self), "clock-skew-margin");
+}
+
+/**
+ * gdata_calendar_sync_get_page_size:
+ * @self: a #GDataCalendarSync
+ *
+ * Gets the #GDataCalendarSync:page-size property.
+ *
+ * Return value: the maximum number of events requested in each page of results
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_calendar_sync_get_page_size (GDataCalendarSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC (self), 0);
+	return self->priv->page_size;
+}
+
+/**
+ * gdata_calendar_sync_set_page_size:
+ * @self: a #GDataCalendarSync
+ * @page_size: the maximum number of events to request in each page of results; must be greater than <code class="literal">0</code>
+ *
+ * Sets the #GDataCalendarSync:page-size property.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_sync_set_page_size (GDataCalendarSync *self, guint page_size)
+{
+	g_return_if_fail (GDATA_IS_CALENDAR_SYNC (self));
+	g_return_if_fail (page_size > 0);
+
+	self->priv->page_size = page_size;
+	g_object_notify (G_OBJECT (self), "page-size");
+}
+
+/**
+ * gdata_calendar_sync_get_watermark:
+ * @self: a #GDataCalendarSync
+ * @calendar: a #GDataCalendarCalendar
+ *
+ * Gets the watermark of @calendar: the server's time at the start of its last successful synchronisation.
+ *
+ * Return value: the calendar's watermark as a UNIX timestamp, or <code class="literal">-1</code> if it's never been synchronised
+ *
+ * Since: 0.15.0
+ */
+gint64
+gdata_calendar_sync_get_watermark (GDataCalendarSync *self, GDataCalendarCalendar *calendar)
+{
+	CalendarState *state;
+	gint64 watermark = -1;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC (self), -1);
+	g_return_val_if_fail (GDATA_IS_CALENDAR_CALENDAR (calendar), -1);
+
+	g_mutex_lock (&(self->priv->mutex));
+	state = g_hash_table_lookup (self->priv->calendars, gdata_entry_get_id (GDATA_ENTRY (calendar)));
+	if (state != NULL)
+		watermark = state->watermark;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return watermark;
+}
+
+/**
+ * gdata_calendar_sync_reset:
+ * @self: a #GDataCalendarSync
+ * @calendar: (allow-none): a #GDataCalendarCalendar, or %NULL
+ *
+ * Forgets the watermark of @calendar, so that it will be fully synchronised the next time it's run. If @calendar is %NULL, the watermarks of all
+ * calendars are forgotten.
+ *
+ * Note that the server only keeps records of deleted events for a limited time, so calendars which haven't been synchronised for longer than that
+ * should be reset.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_sync_reset (GDataCalendarSync *self, GDataCalendarCalendar *calendar)
+{
+	g_return_if_fail (GDATA_IS_CALENDAR_SYNC (self));
+	g_return_if_fail (calendar == NULL || GDATA_IS_CALENDAR_CALENDAR (calendar));
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	if (calendar != NULL)
+		g_hash_table_remove (self->priv->calendars, gdata_entry_get_id (GDATA_ENTRY (calendar)));
+	else
+		g_hash_table_remove_all (self->priv->calendars);
+
+	g_mutex_unlock (&(self->priv->mutex));
+}
+
+/**
+ * gdata_calendar_sync_save_state:
+ * @self: a #GDataCalendarSync
+ *
+ * Serialises the watermarks of all the calendars which have been synchronised, so that they can be restored later with
+ * gdata_calendar_sync_load_state(). The format of the returned string is private, but it is plain text.
+ *
+ * Return value: (transfer full): the serialised state; free with g_free()
+ *
+ * Since: 0.15.0
+ */
+gchar *
+gdata_calendar_sync_save_state (GDataCalendarSync *self)
+{
+	GString *output;
+	GHashTableIter iter;
+	const gchar *calendar_id;
+	CalendarState *state;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC (self), NULL);
+
+	output = g_string_new (STATE_HEADER "\n");
+
+	/* One line per calendar, with the ID last so that it can contain spaces */
+	g_mutex_lock (&(self->priv->mutex));
+
+	g_hash_table_iter_init (&iter, self->priv->calendars);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &calendar_id, (gpointer*) &state) == TRUE) {
+		g_string_append_printf (output, "%" G_GINT64_FORMAT " %" G_GINT64_FORMAT " %" G_GINT64_FORMAT " %s\n",
+		                        state->watermark, state->window_start, state->window_end, calendar_id);
+	}
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return g_string_free (output, FALSE);
+}
+
+/* Parses a space-terminated integer from @str, advancing @str past the space */
+static gboolean
+parse_state_int64 (const gchar **str, gint64 *value)
+{
+	gchar *end;
+
+	*value = g_ascii_strtoll (*str, &end, 10);
+	if (end == *str || *end != ' ' || *value < -1)
+		return FALSE;
+
+	*str = end + 1;
+	return TRUE;
+}
+
+/**
+ * gdata_calendar_sync_load_state:
+ * @self: a #GDataCalendarSync
+ * @state: state previously returned by gdata_calendar_sync_save_state()
+ * @error: a #GError, or %NULL
+ *
+ * Restores the watermarks previously saved with gdata_calendar_sync_save_state(), replacing any which @self currently holds. If @state is invalid,
+ * %GDATA_PARSER_ERROR_PARSING_STRING is returned and the current watermarks are left unchanged.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_sync_load_state (GDataCalendarSync *self, const gchar *state, GError **error)
+{
+	GHashTable *calendars;
+	gchar **lines;
+	guint i;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC (self), FALSE);
+	g_return_val_if_fail (state != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	lines = g_strsplit (state, "\n", -1);
+
+	if (lines[0] == NULL || strcmp (lines[0], STATE_HEADER) != 0)
+		goto error;
+
+	calendars = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) calendar_state_free);
+
+	for (i = 1; lines[i] != NULL; i++) {
+		const gchar *line = lines[i];
+		CalendarState calendar_state;
+
+		/* Skip the empty line after the trailing newline */
+		if (*line == '\0')
+			continue;
+
+		if (parse_state_int64 (&line, &(calendar_state.watermark)) == FALSE ||
+		    parse_state_int64 (&line, &(calendar_state.window_start)) == FALSE ||
+		    parse_state_int64 (&line, &(calendar_state.window_end)) == FALSE ||
+		    *line == '\0') {
+			g_hash_table_destroy (calendars);
+			goto error;
+		}
+
+		g_hash_table_replace (calendars, g_strdup (line), g_slice_dup (CalendarState, &calendar_state));
+	}
+
+	g_strfreev (lines);
+
+	g_mutex_lock (&(self->priv->mutex));
+	g_hash_table_destroy (self->priv->calendars);
+	self->priv->calendars = calendars;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return TRUE;
+
+error:
+	g_strfreev (lines);
+	g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING, _("The calendar synchronization state was invalid."));
+
+	return FALSE;
+}
+
+typedef struct {
+	GDataCalendarSync *self;
+	GDataCalendarCalendar *calendar;
+	guint n_changed;
+	guint n_removed;
+} RunData;
+
+static GDataFeed *
+query_page (GDataQuery *query, RunData *data, GCancellable *cancellable, GError **error)
+{
+	return gdata_calendar_service_query_events (data->self->priv->service, data->calendar, query, cancellable, NULL, NULL, error);
+}
+
+/* Applies a changed event to the store, returning FALSE if the store fails */
+static gboolean
+apply_entry (GDataEntry *entry, RunData *data, GError **error)
+{
+	GDataCalendarSyncStore *store = data->self->priv->store;
+	GDataCalendarSyncStoreInterface *iface = GDATA_CALENDAR_SYNC_STORE_GET_IFACE (store);
+	GDataCalendarEvent *event = GDATA_CALENDAR_EVENT (entry);
+	const gchar *status = gdata_calendar_event_get_status (event);
+
+	/* Deleted events (and cancelled instances of recurring events) are returned with a cancelled status */
+	if (status != NULL && strcmp (status, GDATA_GD_EVENT_STATUS_CANCELED) == 0) {
+		if (iface->remove_event (store, data->calendar, gdata_entry_get_id (entry), error) == FALSE)
+			return FALSE;
+		data->n_removed++;
+	} else {
+		if (iface->apply_event (store, data->calendar, event, error) == FALSE)
+			return FALSE;
+		data->n_changed++;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_calendar_sync_run:
+ * @self: a #GDataCalendarSync
+ * @calendar: the #GDataCalendarCalendar to synchronise
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @n_changed: (out caller-allocates) (allow-none): return location for the number of events added or changed, or %NULL
+ * @n_removed: (out caller-allocates) (allow-none): return location for the number of events removed, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Synchronises the events of @calendar in the #GDataCalendarSync:store with the server, applying all the events which have been added, changed or
+ * deleted since the calendar's watermark, and then updating the watermark. All the pages of results are queried. If the calendar has no watermark
+ * (or was last synchronised with a different window), the store's <function>reset_calendar</function> function is called and then all the events
+ * in the window are applied to the store.
+ *
+ * The store's functions are called in the same thread as this function. If the query fails, or any of the store's functions fails, synchronisation
+ * stops and the calendar's watermark is left unchanged. Errors are as for gdata_service_query().
+ *
+ * Only one synchronisation should be run on a given calendar at once, but different calendars may be synchronised concurrently.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_sync_run (GDataCalendarSync *self, GDataCalendarCalendar *calendar, GCancellable *cancellable,
+                         guint *n_changed, guint *n_removed, GError **error)
+{
+	GDataCalendarSyncPrivate *priv;
+	GDataCalendarSyncStoreInterface *iface;
+	GDataCalendarQuery *query;
+	CalendarState *state;
+	const gchar *calendar_id;
+	RunData data;
+	gint64 watermark = -1, new_watermark = -1, window_start, window_end;
+	gboolean success = TRUE;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_CALENDAR_CALENDAR (calendar), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = self->priv;
+	iface = GDATA_CALENDAR_SYNC_STORE_GET_IFACE (priv->store);
+	g_assert (iface->reset_calendar != NULL && iface->apply_event != NULL && iface->remove_event != NULL);
+
+	calendar_id = gdata_entry_get_id (GDATA_ENTRY (calendar));
+	window_start = priv->window_start;
+	window_end = priv->window_end;
+
+	/* A watermark is only valid if it was taken with the current window */
+	g_mutex_lock (&(priv->mutex));
+	state = g_hash_table_lookup (priv->calendars, calendar_id);
+	if (state != NULL && state->window_start == window_start && state->window_end == window_end)
+		watermark = state->watermark;
+	g_mutex_unlock (&(priv->mutex));
+
+	query = gdata_calendar_query_new (NULL);
+	gdata_query_set_max_results (GDATA_QUERY (query), priv->page_size);
+
+	if (window_start != -1)
+		gdata_calendar_query_set_start_min (query, window_start);
+	if (window_end != -1)
+		gdata_calendar_query_set_start_max (query, window_end);
+	if (window_start != -1 && window_end != -1)
+		gdata_calendar_query_set_single_events (query, TRUE);
+
+	/* Include deletions in incremental synchronisations */
+	if (watermark >= 0)
+		gdata_calendar_query_set_show_deleted (query, TRUE);
+	else
+		success = iface->reset_calendar (priv->store, calendar, error);
+
+	data.self = self;
+	data.calendar = calendar;
+	data.n_changed = 0;
+	data.n_removed = 0;
+
+	if (success == TRUE) {
+		success = _gdata_sync_run (GDATA_QUERY (query), watermark, priv->clock_skew_margin, (GDataSyncQueryFunc) query_page,
+		                           (GDataSyncEntryFunc) apply_entry, &data, cancellable, &new_watermark, error);
+	}
+
+	g_object_unref (query);
+
+	/* Only move the watermark on once all the changes have been applied */
+	if (success == TRUE && new_watermark >= 0) {
+		CalendarState new_state;
+
+		new_state.watermark = new_watermark;
+		new_state.window_start = window_start;
+		new_state.window_end = window_end;
+
+		g_mutex_lock (&(priv->mutex));
+		g_hash_table_replace (priv->calendars, g_strdup (calendar_id), g_slice_dup (CalendarState, &new_state));
+		g_mutex_unlock (&(priv->mutex));
+	}
+
+	if (n_changed != NULL)
+		*n_changed = data.n_changed;
+	if (n_removed != NULL)
+		*n_removed = data.n_removed;
+
+	return success;
+}
+
+typedef struct {
+	GDataCalendarCalendar *calendar;
+	guint n_changed;
+	guint n_removed;
+} RunAsyncData;
+
+static void
+run_async_data_free (RunAsyncData *data)
+{
+	g_object_unref (data->calendar);
+	g_slice_free (RunAsyncData, data);
+}
+
+static void
+run_thread (GSimpleAsyncResult *result, GDataCalendarSync *self, GCancellable *cancellable)
+{
+	RunAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	if (gdata_calendar_sync_run (self, data->calendar, cancellable, &(data->n_changed), &(data->n_removed), &error) == FALSE)
+		g_simple_async_result_take_error (result, error);
+}
+
+/**
+ * gdata_calendar_sync_run_async:
+ * @self: a #GDataCalendarSync
+ * @calendar: the #GDataCalendarCalendar to synchronise
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when synchronisation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Synchronises the events of @calendar with the server asynchronously. @self and @calendar are reffed when this function is called, so can safely
+ * be unreffed after this function returns.
+ *
+ * For more details, see gdata_calendar_sync_run(), which is the synchronous version of this function. Note that the store's functions will be
+ * called in a worker thread, rather than the main thread.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_calendar_sync_run_finish() to get the results of the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_calendar_sync_run_async (GDataCalendarSync *self, GDataCalendarCalendar *calendar, GCancellable *cancellable,
+                               GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	RunAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_CALENDAR_SYNC (self));
+	g_return_if_fail (GDATA_IS_CALENDAR_CALENDAR (calendar));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new0 (RunAsyncData);
+	data->calendar = g_object_ref (calendar);
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_calendar_sync_run_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) run_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) run_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_calendar_sync_run_finish:
+ * @self: a #GDataCalendarSync
+ * @async_result: a #GAsyncResult
+ * @n_changed: (out caller-allocates) (allow-none): return location for the number of events added or changed, or %NULL
+ * @n_removed: (out caller-allocates) (allow-none): return location for the number of events removed, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous synchronisation operation started with gdata_calendar_sync_run_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_calendar_sync_run_finish (GDataCalendarSync *self, GAsyncResult *async_result, guint *n_changed, guint *n_removed, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	RunAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_CALENDAR_SYNC (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_calendar_sync_run_async);
+
+	/* Changes applied before a failure are still reported */
+	data = g_simple_async_result_get_op_res_gpointer (result);
+
+	if (n_changed != NULL)
+		*n_changed = data->n_changed;
+	if (n_removed != NULL)
+		*n_removed = data->n_removed;
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	return TRUE;
+}
@@ -0,0 +1,134 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_CALENDAR_SYNC_H
+#define GDATA_CALENDAR_SYNC_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/services/calendar/gdata-calendar-service.h>
+#include <gdata/services/calendar/gdata-calendar-calendar.h>
+#include <gdata/services/calendar/gdata-calendar-event.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_CALENDAR_SYNC_STORE		(gdata_calendar_sync_store_get_type ())
+#define GDATA_CALENDAR_SYNC_STORE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CALENDAR_SYNC_STORE, GDataCalendarSyncStore))
+#define GDATA_CALENDAR_SYNC_STORE_CLASS(k)	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CALENDAR_SYNC_STORE, GDataCalendarSyncStoreInterface))
+#define GDATA_IS_CALENDAR_SYNC_STORE(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CALENDAR_SYNC_STORE))
+#define GDATA_CALENDAR_SYNC_STORE_GET_IFACE(o)	(G_TYPE_INSTANCE_GET_INTERFACE ((o), GDATA_TYPE_CALENDAR_SYNC_STORE, GDataCalendarSyncStoreInterface))
+
+/**
+ * GDataCalendarSyncStore:
+ *
+ * All the fields in the #GDataCalendarSyncStore structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct _GDataCalendarSyncStore		GDataCalendarSyncStore; /* dummy typedef */
+
+/**
+ * GDataCalendarSyncStoreInterface:
+ * @parent: the parent type
+ * @reset_calendar: a function to remove all the events for the given calendar from the store, called before the calendar is fully (rather than
+ * incrementally) synchronised; this must be implemented
+ * @apply_event: a function to add the given event to the store, or to replace the existing version of it (matched by gdata_entry_get_id()) if the
+ * store already contains it; this must be implemented, and must cope with being passed a version of an event which it already contains
+ * @remove_event: a function to remove the event with the given ID from the store; this must be implemented, and must cope with being passed the ID
+ * of an event which the store doesn't contain
+ *
+ * The interface structure for the #GDataCalendarSyncStore interface. The functions are called in the thread which runs the synchronisation; if
+ * several calendars are synchronised at once, they may be called from several threads at once.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GTypeInterface parent;
+
+	gboolean (*reset_calendar) (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GError **error);
+	gboolean (*apply_event) (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GDataCalendarEvent *event, GError **error);
+	gboolean (*remove_event) (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, const gchar *event_id, GError **error);
+} GDataCalendarSyncStoreInterface;
+
+GType gdata_calendar_sync_store_get_type (void) G_GNUC_CONST;
+
+#define GDATA_TYPE_CALENDAR_SYNC		(gdata_calendar_sync_get_type ())
+#define GDATA_CALENDAR_SYNC(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CALENDAR_SYNC, GDataCalendarSync))
+#define GDATA_CALENDAR_SYNC_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CALENDAR_SYNC, GDataCalendarSyncClass))
+#define GDATA_IS_CALENDAR_SYNC(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CALENDAR_SYNC))
+#define GDATA_IS_CALENDAR_SYNC_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_CALENDAR_SYNC))
+#define GDATA_CALENDAR_SYNC_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_CALENDAR_SYNC, GDataCalendarSyncClass))
+
+typedef struct _GDataCalendarSyncPrivate	GDataCalendarSyncPrivate;
+
+/**
+ * GDataCalendarSync:
+ *
+ * All the fields in the #GDataCalendarSync structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	GObject parent;
+	GDataCalendarSyncPrivate *priv;
+} GDataCalendarSync;
+
+/**
+ * GDataCalendarSyncClass:
+ *
+ * All the fields in the #GDataCalendarSyncClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataCalendarSyncClass;
+
+GType gdata_calendar_sync_get_type (void) G_GNUC_CONST;
+
+GDataCalendarSync *gdata_calendar_sync_new (GDataCalendarService *service, GDataCalendarSyncStore *store) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataCalendarService *gdata_calendar_sync_get_service (GDataCalendarSync *self) G_GNUC_PURE;
+GDataCalendarSyncStore *gdata_calendar_sync_get_store (GDataCalendarSync *self) G_GNUC_PURE;
+
+void gdata_calendar_sync_get_window (GDataCalendarSync *self, gint64 *window_start, gint64 *window_end);
+void gdata_calendar_sync_set_window (GDataCalendarSync *self, gint64 window_start, gint64 window_end);
+guint gdata_calendar_sync_get_clock_skew_margin (GDataCalendarSync *self) G_GNUC_PURE;
+void gdata_calendar_sync_set_clock_skew_margin (GDataCalendarSync *self, guint clock_skew_margin);
+guint gdata_calendar_sync_get_page_size (GDataCalendarSync *self) G_GNUC_PURE;
+void gdata_calendar_sync_set_page_size (GDataCalendarSync *self, guint page_size);
+
+gint64 gdata_calendar_sync_get_watermark (GDataCalendarSync *self, GDataCalendarCalendar *calendar);
+void gdata_calendar_sync_reset (GDataCalendarSync *self, GDataCalendarCalendar *calendar);
+
+gchar *gdata_calendar_sync_save_state (GDataCalendarSync *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gboolean gdata_calendar_sync_load_state (GDataCalendarSync *self, const gchar *state, GError **error);
+
+gboolean gdata_calendar_sync_run (GDataCalendarSync *self, GDataCalendarCalendar *calendar, GCancellable *cancellable,
+                                  guint *n_changed, guint *n_removed, GError **error);
+void gdata_calendar_sync_run_async (GDataCalendarSync *self, GDataCalendarCalendar *calendar, GCancellable *cancellable,
+                                    GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_calendar_sync_run_finish (GDataCalendarSync *self, GAsyncResult *async_result, guint *n_changed, guint *n_removed, GError **error);
+
+G_END_DECLS
+
+#endif /* !GDATA_CALENDAR_SYNC_H */
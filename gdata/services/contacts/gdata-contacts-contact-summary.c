@@ -0,0 +1,327 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-contacts-contact-summary
+ * @short_description: GData Contacts contact summary object
+ * @stability: Unstable
+ * @include: gdata/services/contacts/gdata-contacts-contact-summary.h
+ *
+ * #GDataContactsContactSummary is a lightweight, read-only alternative to #GDataContactsContact for listing large address books, for example to
+ * populate an autocompletion list. It only holds a contact's display name, primary e-mail address and photo ETag, plus the standard #GDataEntry
+ * properties such as its ID and ETag; everything else about the contact is neither downloaded nor parsed.
+ *
+ * Contact summaries are returned by gdata_contacts_service_query_contact_summaries(). To get or modify the full details of a contact, query for it
+ * as a #GDataContactsContact using its ID.
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <libxml/parser.h>
+
+#include "gdata-contacts-contact-summary.h"
+#include "gdata-parser.h"
+#include "gdata-private.h"
+
+static void gdata_contacts_contact_summary_finalize (GObject *object);
+static void gdata_contacts_contact_summary_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
+static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
+static void register_elements (void);
+
+struct _GDataContactsContactSummaryPrivate {
+	gchar *full_name;
+	gchar *primary_email_address;
+	gboolean email_address_is_primary; /* whether primary_email_address was marked as primary, or is just the first we found */
+	gchar *photo_etag;
+};
+
+enum {
+	PROP_FULL_NAME = 1,
+	PROP_PRIMARY_EMAIL_ADDRESS,
+	PROP_PHOTO_ETAG,
+};
+
+G_DEFINE_TYPE (GDataContactsContactSummary, gdata_contacts_contact_summary, GDATA_TYPE_ENTRY)
+
+static void
+gdata_contacts_contact_summary_class_init (GDataContactsContactSummaryClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+	GDataParsableClass *parsable_class = GDATA_PARSABLE_CLASS (klass);
+	GDataEntryClass *entry_class = GDATA_ENTRY_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataContactsContactSummaryPrivate));
+
+	gobject_class->get_property = gdata_contacts_contact_summary_get_property;
+	gobject_class->finalize = gdata_contacts_contact_summary_finalize;
+
+	parsable_class->parse_xml = parse_xml;
+	parsable_class->get_namespaces = get_namespaces;
+
+	entry_class->kind_term = "http://schemas.google.com/contact/2008#contact";
+
+	register_elements ();
+
+	/**
+	 * GDataContactsContactSummary:full-name:
+	 *
+	 * The contact's full name, as in #GDataGDName:full-name, or %NULL if they don't have one.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_FULL_NAME,
+	                                 g_param_spec_string ("full-name",
+	                                                      "Full name", "The contact's full name.",
+	                                                      NULL,
+	                                                      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataContactsContactSummary:primary-email-address:
+	 *
+	 * The contact's primary e-mail address, or their first e-mail address if none is marked as primary, or %NULL if they don't have any.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_PRIMARY_EMAIL_ADDRESS,
+	                                 g_param_spec_string ("primary-email-address",
+	                                                      "Primary e-mail address", "The contact's primary e-mail address.",
+	                                                      NULL,
+	                                                      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataContactsContactSummary:photo-etag:
+	 *
+	 * The ETag of the contact's photo, as in #GDataContactsContact:photo-etag, or %NULL if they don't have a photo.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_PHOTO_ETAG,
+	                                 g_param_spec_string ("photo-etag",
+	                                                      "Photo ETag", "The ETag of the contact's photo.",
+	                                                      NULL,
+	                                                      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_contacts_contact_summary_init (GDataContactsContactSummary *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CONTACTS_CONTACT_SUMMARY, GDataContactsContactSummaryPrivate);
+}
+
+static void
+gdata_contacts_contact_summary_finalize (GObject *object)
+{
+	GDataContactsContactSummaryPrivate *priv = GDATA_CONTACTS_CONTACT_SUMMARY (object)->priv;
+
+	g_free (priv->full_name);
+	g_free (priv->primary_email_address);
+	g_free (priv->photo_etag);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_contacts_contact_summary_parent_class)->finalize (object);
+}
+
+static void
+gdata_contacts_contact_summary_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataContactsContactSummaryPrivate *priv = GDATA_CONTACTS_CONTACT_SUMMARY (object)->priv;
+
+	switch (property_id) {
+		case PROP_FULL_NAME:
+			g_value_set_string (value, priv->full_name);
+			break;
+		case PROP_PRIMARY_EMAIL_ADDRESS:
+			g_value_set_string (value, priv->primary_email_address);
+			break;
+		case PROP_PHOTO_ETAG:
+			g_value_set_string (value, priv->photo_etag);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static gboolean
+parse_name (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	GDataContactsContactSummaryPrivate *priv = GDATA_CONTACTS_CONTACT_SUMMARY (parsable)->priv;
+	xmlNode *child_node;
+
+	/* gd:name; we only care about its gd:fullName, rather than building a whole GDataGDName */
+	for (child_node = node->children; child_node != NULL; child_node = child_node->next) {
+		if (child_node->type == XML_ELEMENT_NODE && xmlStrcmp (child_node->name, (xmlChar*) "fullName") == 0 && priv->full_name == NULL) {
+			xmlChar *full_name = xmlNodeListGetString (doc, child_node->children, TRUE);
+
+			priv->full_name = g_strdup ((gchar*) full_name);
+			xmlFree (full_name);
+		}
+	}
+
+	return TRUE;
+}
+
+static gboolean
+parse_email (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	GDataContactsContactSummaryPrivate *priv = GDATA_CONTACTS_CONTACT_SUMMARY (parsable)->priv;
+	xmlChar *address;
+	gboolean is_primary;
+
+	/* gd:email; keep the primary address, falling back to the first one */
+	if (priv->email_address_is_primary == TRUE)
+		return TRUE;
+
+	if (gdata_parser_boolean_from_property (node, "primary", &is_primary, 0, error) == FALSE)
+		return FALSE;
+
+	if (is_primary == FALSE && priv->primary_email_address != NULL)
+		return TRUE;
+
+	address = xmlGetProp (node, (xmlChar*) "address");
+	if (address == NULL || *address == '\0') {
+		xmlFree (address);
+		return gdata_parser_error_required_property_missing (node, "address", error);
+	}
+
+	g_free (priv->primary_email_address);
+	priv->primary_email_address = g_strdup ((gchar*) address);
+	priv->email_address_is_primary = is_primary;
+	xmlFree (address);
+
+	return TRUE;
+}
+
+static gboolean
+parse_link (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	GDataContactsContactSummaryPrivate *priv = GDATA_CONTACTS_CONTACT_SUMMARY (parsable)->priv;
+
+	/* As with GDataContactsContact, note down the ETag of the photo link, then pass it onto the parent class to parse properly */
+	if (priv->photo_etag == NULL) {
+		xmlChar *rel = xmlGetProp (node, (xmlChar*) "rel");
+		if (xmlStrcmp (rel, (xmlChar*) "http://schemas.google.com/contacts/2008/rel#photo") == 0)
+			priv->photo_etag = (gchar*) xmlGetProp (node, (xmlChar*) "etag");
+		xmlFree (rel);
+	}
+
+	return GDATA_PARSABLE_CLASS (gdata_contacts_contact_summary_parent_class)->parse_xml (parsable, doc, node, user_data, error);
+}
+
+static gboolean
+skip_element (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* Ignore elements we don't summarise, rather than having the parent class keep a copy of their XML */
+	return TRUE;
+}
+
+static void
+register_elements (void)
+{
+	GType type = GDATA_TYPE_CONTACTS_CONTACT_SUMMARY;
+	const gchar *atom = "http://www.w3.org/2005/Atom", *gd = "http://schemas.google.com/g/2005";
+
+	gdata_parser_register_func (type, atom, "link", parse_link);
+	gdata_parser_register_func (type, atom, "content", skip_element);
+
+	gdata_parser_register_func (type, gd, "name", parse_name);
+	gdata_parser_register_func (type, gd, "email", parse_email);
+}
+
+static gboolean
+parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	gboolean success;
+
+	/* The elements we understand are registered in register_elements() */
+	if (gdata_parser_dispatch_element (GDATA_TYPE_CONTACTS_CONTACT_SUMMARY, parsable, doc, node, user_data, &success, error) == TRUE)
+		return success;
+
+	/* Everything else in the Contacts-specific namespaces is ignored; the query only requests the summarised elements anyway */
+	if (gdata_parser_is_namespace (node, "http://schemas.google.com/g/2005") == TRUE ||
+	    gdata_parser_is_namespace (node, "http://schemas.google.com/contact/2008") == TRUE) {
+		return TRUE;
+	}
+
+	return GDATA_PARSABLE_CLASS (gdata_contacts_contact_summary_parent_class)->parse_xml (parsable, doc, node, user_data, error);
+}
+
+static void
+get_namespaces (GDataParsable *parsable, GHashTable *namespaces)
+{
+	/* Chain up to the parent class */
+	GDATA_PARSABLE_CLASS (gdata_contacts_contact_summary_parent_class)->get_namespaces (parsable, namespaces);
+
+	g_hash_table_insert (namespaces, (gchar*) "gd", (gchar*) "http://schemas.google.com/g/2005");
+}
+
+/**
+ * gdata_contacts_contact_summary_get_full_name:
+ * @self: a #GDataContactsContactSummary
+ *
+ * Gets the #GDataContactsContactSummary:full-name property.
+ *
+ * Return value: the contact's full name, or %NULL
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+gdata_contacts_contact_summary_get_full_name (GDataContactsContactSummary *self)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT_SUMMARY (self), NULL);
+	return self->priv->full_name;
+}
+
+/**
+ * gdata_contacts_contact_summary_get_primary_email_address:
+ * @self: a #GDataContactsContactSummary
+ *
+ * Gets the #GDataContactsContactSummary:primary-email-address property.
+ *
+ * Return value: the contact's primary e-mail address, or %NULL
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+gdata_contacts_contact_summary_get_primary_email_address (GDataContactsContactSummary *self)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT_SUMMARY (self), NULL);
+	return self->priv->primary_email_address;
+}
+
+/**
+ * gdata_contacts_contact_summary_get_photo_etag:
+ * @self: a #GDataContactsContactSummary
+ *
+ * Gets the #GDataContactsContactSummary:photo-etag property.
+ *
+ * Return value: the ETag of the contact's photo, or %NULL
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+gdata_contacts_contact_summary_get_photo_etag (GDataContactsContactSummary *self)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT_SUMMARY (self), NULL);
+	return self->priv->photo_etag;
+}
@@ -0,0 +1,72 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_CONTACTS_CONTACT_SUMMARY_H
+#define GDATA_CONTACTS_CONTACT_SUMMARY_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gdata/gdata-entry.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_CONTACTS_CONTACT_SUMMARY		(gdata_contacts_contact_summary_get_type ())
+#define GDATA_CONTACTS_CONTACT_SUMMARY(o)	(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CONTACTS_CONTACT_SUMMARY, GDataContactsContactSummary))
+#define GDATA_CONTACTS_CONTACT_SUMMARY_CLASS(k)	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CONTACTS_CONTACT_SUMMARY, GDataContactsContactSummaryClass))
+#define GDATA_IS_CONTACTS_CONTACT_SUMMARY(o)	(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CONTACTS_CONTACT_SUMMARY))
+#define GDATA_IS_CONTACTS_CONTACT_SUMMARY_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_CONTACTS_CONTACT_SUMMARY))
+#define GDATA_CONTACTS_CONTACT_SUMMARY_GET_CLASS(o) \
+	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_CONTACTS_CONTACT_SUMMARY, GDataContactsContactSummaryClass))
+
+typedef struct _GDataContactsContactSummaryPrivate	GDataContactsContactSummaryPrivate;
+
+/**
+ * GDataContactsContactSummary:
+ *
+ * All the fields in the #GDataContactsContactSummary structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GDataEntry parent;
+	GDataContactsContactSummaryPrivate *priv;
+} GDataContactsContactSummary;
+
+/**
+ * GDataContactsContactSummaryClass:
+ *
+ * All the fields in the #GDataContactsContactSummaryClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GDataEntryClass parent;
+} GDataContactsContactSummaryClass;
+
+GType gdata_contacts_contact_summary_get_type (void) G_GNUC_CONST;
+
+const gchar *gdata_contacts_contact_summary_get_full_name (GDataContactsContactSummary *self) G_GNUC_PURE;
+const gchar *gdata_contacts_contact_summary_get_primary_email_address (GDataContactsContactSummary *self) G_GNUC_PURE;
+const gchar *gdata_contacts_contact_summary_get_photo_etag (GDataContactsContactSummary *self) G_GNUC_PURE;
+
+G_END_DECLS
+
+#endif /* !GDATA_CONTACTS_CONTACT_SUMMARY_H */
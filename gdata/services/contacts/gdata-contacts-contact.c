@@ -157,6 +157,7 @@
 #include "gdata-types.h"
 #include "gdata-private.h"
 #include "gdata-comparable.h"
+#include "gdata-marshal.h"
 
 /* The maximum number of extended properties the server allows us. See
  * http://code.google.com/apis/contacts/docs/2.0/reference.html#ProjectionsAndExtended.
@@ -167,10 +168,12 @@
 static GObject *gdata_contacts_contact_constructor (GType type, guint n_construct_params, GObjectConstructParam *construct_params);
 static void gdata_contacts_contact_dispose (GObject *object);
 static void gdata_contacts_contact_finalize (GObject *object);
+static void refresh_private (GDataEntry *self, GDataEntry *other);
 static void gdata_contacts_contact_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_contacts_contact_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
 static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
+static void register_elements (void);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
 static gchar *get_entry_uri (const gchar *id) G_GNUC_WARN_UNUSED_RESULT;
 
@@ -183,6 +186,7 @@ struct _GDataContactsContactPrivate {
 	GList *postal_addresses; /* GDataGDPostalAddress */
 	GList *organizations; /* GDataGDOrganization */
 	GHashTable *extended_properties;
+	gchar *extended_properties_xml; /* serialised extended_properties, or NULL if there are none; see update_extended_properties_xml() */
 	GHashTable *user_defined_fields;
 	GHashTable *groups;
 	gboolean deleted;
@@ -234,6 +238,13 @@ enum {
 	PROP_FILE_AS,
 };
 
+enum {
+	SIGNAL_GROUP_MEMBERSHIP_CHANGED,
+	LAST_SIGNAL
+};
+
+static guint contact_signals[LAST_SIGNAL] = { 0, };
+
 G_DEFINE_TYPE (GDataContactsContact, gdata_contacts_contact, GDATA_TYPE_ENTRY)
 
 static void
@@ -258,6 +269,11 @@ gdata_contacts_contact_class_init (GDataContactsContactClass *klass)
 	entry_class->get_entry_uri = get_entry_uri;
 	entry_class->kind_term = "http://schemas.google.com/contact/2008#contact";
 
+	register_elements ();
+	/* All modifications of contacts are notified or mark the contact as dirty */
+	_gdata_parsable_class_set_original_xml_func (parsable_class, NULL);
+	_gdata_entry_class_set_refresh_func (entry_class, refresh_private);
+
 	/**
 	 * GDataContactsContact:edited:
 	 *
@@ -508,6 +524,46 @@ gdata_contacts_contact_class_init (GDataContactsContactClass *klass)
 	                                                      "Subject", "The subject of the contact.",
 	                                                      NULL,
 	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/* Map the properties to the elements they're serialised as; see gdata_service_patch_entry() */
+	_gdata_entry_class_set_property_field (entry_class, "edited", NULL);
+	_gdata_entry_class_set_property_field (entry_class, "deleted", NULL);
+	_gdata_entry_class_set_property_field (entry_class, "photo-etag", NULL);
+	_gdata_entry_class_set_property_field (entry_class, "name", "gd:name");
+	_gdata_entry_class_set_property_field (entry_class, "nickname", "gContact:nickname");
+	_gdata_entry_class_set_property_field (entry_class, "file-as", "gContact:fileAs");
+	_gdata_entry_class_set_property_field (entry_class, "birthday", "gContact:birthday");
+	_gdata_entry_class_set_property_field (entry_class, "birthday-has-year", "gContact:birthday");
+	_gdata_entry_class_set_property_field (entry_class, "billing-information", "gContact:billingInformation");
+	_gdata_entry_class_set_property_field (entry_class, "directory-server", "gContact:directoryServer");
+	_gdata_entry_class_set_property_field (entry_class, "gender", "gContact:gender");
+	_gdata_entry_class_set_property_field (entry_class, "initials", "gContact:initials");
+	_gdata_entry_class_set_property_field (entry_class, "maiden-name", "gContact:maidenName");
+	_gdata_entry_class_set_property_field (entry_class, "mileage", "gContact:mileage");
+	_gdata_entry_class_set_property_field (entry_class, "occupation", "gContact:occupation");
+	_gdata_entry_class_set_property_field (entry_class, "priority", "gContact:priority");
+	_gdata_entry_class_set_property_field (entry_class, "sensitivity", "gContact:sensitivity");
+	_gdata_entry_class_set_property_field (entry_class, "short-name", "gContact:shortName");
+	_gdata_entry_class_set_property_field (entry_class, "subject", "gContact:subject");
+
+	/**
+	 * GDataContactsContact::group-membership-changed:
+	 * @contact: the #GDataContactsContact whose groups changed
+	 * @href: the ID URI of the group the contact was added to or removed from
+	 * @is_member: %TRUE if the contact was added to the group, %FALSE if it was removed from it
+	 *
+	 * The #GDataContactsContact::group-membership-changed signal is emitted when gdata_contacts_contact_add_group() or
+	 * gdata_contacts_contact_remove_group() changes the groups the contact is in. It isn't emitted when the contact is parsed, or if the contact
+	 * was already (or wasn't) in the group. This allows indices of group membership, such as #GDataContactsGroupIndex, to be kept up to date.
+	 *
+	 * Since: 0.15.0
+	 */
+	contact_signals[SIGNAL_GROUP_MEMBERSHIP_CHANGED] = g_signal_new ("group-membership-changed",
+	                                                                G_TYPE_FROM_CLASS (klass),
+	                                                                G_SIGNAL_RUN_LAST,
+	                                                                0, NULL, NULL,
+	                                                                gdata_marshal_VOID__STRING_BOOLEAN,
+	                                                                G_TYPE_NONE, 2, G_TYPE_STRING, G_TYPE_BOOLEAN);
 }
 
 static void notify_full_name_cb (GObject *gobject, GParamSpec *pspec, GDataContactsContact *self);
@@ -519,6 +575,8 @@ notify_title_cb (GObject *gobject, GParamSpec *pspec, GDataContactsContact *self
 	g_signal_handlers_block_by_func (self->priv->name, notify_full_name_cb, self);
 	gdata_gd_name_set_full_name (self->priv->name, gdata_entry_get_title (GDATA_ENTRY (self)));
 	g_signal_handlers_unblock_by_func (self->priv->name, notify_full_name_cb, self);
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:name");
 }
 
 static void
@@ -621,12 +679,27 @@ gdata_contacts_contact_dispose (GObject *object)
 	G_OBJECT_CLASS (gdata_contacts_contact_parent_class)->dispose (object);
 }
 
+static void
+refresh_private (GDataEntry *self, GDataEntry *other)
+{
+	GDataContactsContactPrivate *priv = GDATA_CONTACTS_CONTACT (self)->priv, *other_priv = GDATA_CONTACTS_CONTACT (other)->priv;
+	gchar *photo_etag;
+
+	priv->edited = other_priv->edited;
+	priv->deleted = other_priv->deleted;
+
+	photo_etag = priv->photo_etag;
+	priv->photo_etag = other_priv->photo_etag;
+	other_priv->photo_etag = photo_etag;
+}
+
 static void
 gdata_contacts_contact_finalize (GObject *object)
 {
 	GDataContactsContactPrivate *priv = GDATA_CONTACTS_CONTACT (object)->priv;
 
 	g_hash_table_destroy (priv->extended_properties);
+	g_free (priv->extended_properties_xml);
 	g_hash_table_destroy (priv->user_defined_fields);
 	g_hash_table_destroy (priv->groups);
 	g_free (priv->photo_etag);
@@ -785,266 +858,295 @@ gdata_contacts_contact_set_property (GObject *object, guint property_id, const G
 }
 
 static gboolean
-parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+parse_id (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* We have to override <id> parsing to fix the projection. Modify it in-place so that the parser in GDataEntry will pick up
+	 * the changes. This fixes bugs caused by referring to contacts by the base projection, rather than the full projection;
+	 * such as http://code.google.com/p/gdata-issues/issues/detail?id=2129. */
+	gchar *base;
+	gchar *id = (gchar*) xmlNodeListGetString (doc, node->children, TRUE);
+
+	if (id != NULL) {
+		base = strstr (id, "/base/");
+		if (base != NULL) {
+			memcpy (base, "/full/", 6);
+			xmlNodeSetContent (node, (xmlChar*) id);
+		}
+	}
+
+	xmlFree (id);
+
+	return GDATA_PARSABLE_CLASS (gdata_contacts_contact_parent_class)->parse_xml (parsable, doc, node, user_data, error);
+}
+
+static gboolean
+parse_link (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
 {
-	gboolean success;
 	GDataContactsContact *self = GDATA_CONTACTS_CONTACT (parsable);
 
-	if (gdata_parser_is_namespace (node, "http://www.w3.org/2007/app") == TRUE &&
-	    gdata_parser_int64_time_from_element (node, "edited", P_REQUIRED | P_NO_DUPES, &(self->priv->edited), &success, error) == TRUE) {
-		return success;
-	} else if (gdata_parser_is_namespace (node, "http://www.w3.org/2005/Atom") == TRUE && xmlStrcmp (node->name, (xmlChar*) "id") == 0) {
-		/* We have to override <id> parsing to fix the projection. Modify it in-place so that the parser in GDataEntry will pick up
-		 * the changes. This fixes bugs caused by referring to contacts by the base projection, rather than the full projection;
-		 * such as http://code.google.com/p/gdata-issues/issues/detail?id=2129. */
-		gchar *base;
-		gchar *id = (gchar*) xmlNodeListGetString (doc, node->children, TRUE);
-
-		if (id != NULL) {
-			base = strstr (id, "/base/");
-			if (base != NULL) {
-				memcpy (base, "/full/", 6);
-				xmlNodeSetContent (node, (xmlChar*) id);
-			}
+	/* If we haven't yet found a photo, check to see if it's a photo <link> element */
+	if (self->priv->photo_etag == NULL) {
+		xmlChar *rel = xmlGetProp (node, (xmlChar*) "rel");
+		if (xmlStrcmp (rel, (xmlChar*) "http://schemas.google.com/contacts/2008/rel#photo") == 0) {
+			/* It's the photo link (http://code.google.com/apis/contacts/docs/2.0/reference.html#Photos), whose ETag we should
+			 * note down, then pass onto the parent class to parse properly */
+			self->priv->photo_etag = (gchar*) xmlGetProp (node, (xmlChar*) "etag");
 		}
+		xmlFree (rel);
+	}
 
-		xmlFree (id);
-
-		return GDATA_PARSABLE_CLASS (gdata_contacts_contact_parent_class)->parse_xml (parsable, doc, node, user_data, error);
-	} else if (gdata_parser_is_namespace (node, "http://schemas.google.com/g/2005") == TRUE) {
-		if (gdata_parser_object_from_element_setter (node, "email", P_REQUIRED, GDATA_TYPE_GD_EMAIL_ADDRESS,
-		                                             gdata_contacts_contact_add_email_address, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "im", P_REQUIRED, GDATA_TYPE_GD_IM_ADDRESS,
-		                                             gdata_contacts_contact_add_im_address, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "phoneNumber", P_REQUIRED, GDATA_TYPE_GD_PHONE_NUMBER,
-		                                             gdata_contacts_contact_add_phone_number, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "structuredPostalAddress", P_REQUIRED, GDATA_TYPE_GD_POSTAL_ADDRESS,
-		                                             gdata_contacts_contact_add_postal_address, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "organization", P_REQUIRED, GDATA_TYPE_GD_ORGANIZATION,
-		                                             gdata_contacts_contact_add_organization, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element (node, "name", P_REQUIRED, GDATA_TYPE_GD_NAME, &(self->priv->name), &success, error) == TRUE) {
-			return success;
-		} else if (xmlStrcmp (node->name, (xmlChar*) "extendedProperty") == 0) {
-			/* gd:extendedProperty */
-			xmlChar *name, *value;
-			xmlBuffer *buffer = NULL;
-
-			name = xmlGetProp (node, (xmlChar*) "name");
-			if (name == NULL)
-				return gdata_parser_error_required_property_missing (node, "name", error);
-
-			/* Get either the value property, or the element's content */
-			value = xmlGetProp (node, (xmlChar*) "value");
-			if (value == NULL) {
-				xmlNode *child_node;
-
-				/* Use the element's content instead (arbitrary XML) */
-				buffer = xmlBufferCreate ();
-				for (child_node = node->children; child_node != NULL; child_node = child_node->next)
-					xmlNodeDump (buffer, doc, child_node, 0, 0);
-				value = (xmlChar*) xmlBufferContent (buffer);
-			}
+	return GDATA_PARSABLE_CLASS (gdata_contacts_contact_parent_class)->parse_xml (parsable, doc, node, user_data, error);
+}
 
-			gdata_contacts_contact_set_extended_property (self, (gchar*) name, (gchar*) value);
-
-			xmlFree (name);
-			if (buffer != NULL)
-				xmlBufferFree (buffer);
-			else
-				xmlFree (value);
-		} else if (xmlStrcmp (node->name, (xmlChar*) "deleted") == 0) {
-			/* gd:deleted */
-			self->priv->deleted = TRUE;
-		} else {
-			return GDATA_PARSABLE_CLASS (gdata_contacts_contact_parent_class)->parse_xml (parsable, doc, node, user_data, error);
-		}
-	} else if (gdata_parser_is_namespace (node, "http://schemas.google.com/contact/2008") == TRUE) {
-		if (gdata_parser_object_from_element_setter (node, "jot", P_REQUIRED, GDATA_TYPE_GCONTACT_JOT,
-		                                             gdata_contacts_contact_add_jot, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "relation", P_REQUIRED, GDATA_TYPE_GCONTACT_RELATION,
-		                                             gdata_contacts_contact_add_relation, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "event", P_REQUIRED, GDATA_TYPE_GCONTACT_EVENT,
-		                                             gdata_contacts_contact_add_event, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "website", P_REQUIRED, GDATA_TYPE_GCONTACT_WEBSITE,
-		                                             gdata_contacts_contact_add_website, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "calendarLink", P_REQUIRED, GDATA_TYPE_GCONTACT_CALENDAR,
-		                                             gdata_contacts_contact_add_calendar, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "externalId", P_REQUIRED, GDATA_TYPE_GCONTACT_EXTERNAL_ID,
-		                                             gdata_contacts_contact_add_external_id, self, &success, error) == TRUE ||
-		    gdata_parser_object_from_element_setter (node, "language", P_REQUIRED, GDATA_TYPE_GCONTACT_LANGUAGE,
-		                                             gdata_contacts_contact_add_language, self, &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "nickname", P_REQUIRED | P_NO_DUPES, &(self->priv->nickname), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "fileAs", P_REQUIRED | P_NO_DUPES, &(self->priv->file_as), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "billingInformation", P_REQUIRED | P_NO_DUPES | P_NON_EMPTY,
-		                                      &(self->priv->billing_information), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "directoryServer", P_REQUIRED | P_NO_DUPES | P_NON_EMPTY,
-		                                      &(self->priv->directory_server), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "initials", P_REQUIRED | P_NO_DUPES, &(self->priv->initials), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "maidenName", P_REQUIRED | P_NO_DUPES,
-		                                      &(self->priv->maiden_name), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "mileage", P_REQUIRED | P_NO_DUPES, &(self->priv->mileage), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "occupation", P_REQUIRED | P_NO_DUPES,
-		                                      &(self->priv->occupation), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "shortName", P_REQUIRED | P_NO_DUPES,
-		                                      &(self->priv->short_name), &success, error) == TRUE ||
-		    gdata_parser_string_from_element (node, "subject", P_REQUIRED | P_NO_DUPES, &(self->priv->subject), &success, error) == TRUE) {
-			return success;
-		} else if (xmlStrcmp (node->name, (xmlChar*) "gender") == 0) {
-			/* gContact:gender */
-			xmlChar *value;
-
-			if (self->priv->gender != NULL)
-				return gdata_parser_error_duplicate_element (node, error);
-
-			value = xmlGetProp (node, (xmlChar*) "value");
-			if (value == NULL || *value == '\0') {
-				xmlFree (value);
-				return gdata_parser_error_required_content_missing (node, error);
-			}
+static gboolean
+parse_extended_property (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* gd:extendedProperty */
+	xmlChar *name, *value;
+	xmlBuffer *buffer = NULL;
 
-			self->priv->gender = (gchar*) value;
-		} else if (xmlStrcmp (node->name, (xmlChar*) "hobby") == 0) {
-			/* gContact:hobby */
-			xmlChar *hobby;
+	name = xmlGetProp (node, (xmlChar*) "name");
+	if (name == NULL)
+		return gdata_parser_error_required_property_missing (node, "name", error);
 
-			hobby = xmlNodeListGetString (doc, node->children, TRUE);
-			if (hobby == NULL || *hobby == '\0') {
-				xmlFree (hobby);
-				return gdata_parser_error_required_content_missing (node, error);
-			}
+	/* Get either the value property, or the element's content */
+	value = xmlGetProp (node, (xmlChar*) "value");
+	if (value == NULL) {
+		xmlNode *child_node;
 
-			gdata_contacts_contact_add_hobby (self, (gchar*) hobby);
-			xmlFree (hobby);
-		} else if (xmlStrcmp (node->name, (xmlChar*) "userDefinedField") == 0) {
-			/* gContact:userDefinedField */
-			xmlChar *name, *value;
-
-			/* Note that while we require the property to be present, we don't require it to be non-empty. See bgo#648058 */
-			name = xmlGetProp (node, (xmlChar*) "key");
-			if (name == NULL) {
-				xmlFree (name);
-				return gdata_parser_error_required_property_missing (node, "key", error);
-			}
+		/* Use the element's content instead (arbitrary XML) */
+		buffer = xmlBufferCreate ();
+		for (child_node = node->children; child_node != NULL; child_node = child_node->next)
+			xmlNodeDump (buffer, doc, child_node, 0, 0);
+		value = (xmlChar*) xmlBufferContent (buffer);
+	}
 
-			/* Get either the value property, or the element's content */
-			value = xmlGetProp (node, (xmlChar*) "value");
-			if (value == NULL) {
-				xmlFree (name);
-				return gdata_parser_error_required_property_missing (node, "value", error);
-			}
+	gdata_contacts_contact_set_extended_property (GDATA_CONTACTS_CONTACT (parsable), (gchar*) name, (gchar*) value);
 
-			gdata_contacts_contact_set_user_defined_field (self, (gchar*) name, (gchar*) value);
+	xmlFree (name);
+	if (buffer != NULL)
+		xmlBufferFree (buffer);
+	else
+		xmlFree (value);
 
-			xmlFree (name);
-			xmlFree (value);
-		} else if (xmlStrcmp (node->name, (xmlChar*) "priority") == 0) {
-			/* gContact:priority */
-			xmlChar *rel;
+	return TRUE;
+}
 
-			if (self->priv->priority != NULL)
-				return gdata_parser_error_duplicate_element (node, error);
+static gboolean
+parse_deleted (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* gd:deleted */
+	GDATA_CONTACTS_CONTACT (parsable)->priv->deleted = TRUE;
+	return TRUE;
+}
 
-			rel = xmlGetProp (node, (xmlChar*) "rel");
-			if (rel == NULL || *rel == '\0') {
-				xmlFree (rel);
-				return gdata_parser_error_required_content_missing (node, error);
-			}
+static gboolean
+parse_hobby (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* gContact:hobby */
+	xmlChar *hobby;
 
-			self->priv->priority = (gchar*) rel;
-		} else if (xmlStrcmp (node->name, (xmlChar*) "sensitivity") == 0) {
-			/* gContact:sensitivity */
-			xmlChar *rel;
+	hobby = xmlNodeListGetString (doc, node->children, TRUE);
+	if (hobby == NULL || *hobby == '\0') {
+		xmlFree (hobby);
+		return gdata_parser_error_required_content_missing (node, error);
+	}
 
-			if (self->priv->sensitivity != NULL)
-				return gdata_parser_error_duplicate_element (node, error);
+	gdata_contacts_contact_add_hobby (GDATA_CONTACTS_CONTACT (parsable), (gchar*) hobby);
+	xmlFree (hobby);
 
-			rel = xmlGetProp (node, (xmlChar*) "rel");
-			if (rel == NULL || *rel == '\0') {
-				xmlFree (rel);
-				return gdata_parser_error_required_content_missing (node, error);
-			}
+	return TRUE;
+}
 
-			self->priv->sensitivity = (gchar*) rel;
-		} else if (xmlStrcmp (node->name, (xmlChar*) "groupMembershipInfo") == 0) {
-			/* gContact:groupMembershipInfo */
-			xmlChar *href;
-			gboolean deleted_bool;
+static gboolean
+parse_user_defined_field (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* gContact:userDefinedField */
+	xmlChar *name, *value;
 
-			href = xmlGetProp (node, (xmlChar*) "href");
-			if (href == NULL)
-				return gdata_parser_error_required_property_missing (node, "href", error);
+	/* Note that while we require the property to be present, we don't require it to be non-empty. See bgo#648058 */
+	name = xmlGetProp (node, (xmlChar*) "key");
+	if (name == NULL) {
+		xmlFree (name);
+		return gdata_parser_error_required_property_missing (node, "key", error);
+	}
 
-			/* Has it been deleted? */
-			if (gdata_parser_boolean_from_property (node, "deleted", &deleted_bool, 0, error) == FALSE) {
-				xmlFree (href);
-				return FALSE;
-			}
+	/* Get either the value property, or the element's content */
+	value = xmlGetProp (node, (xmlChar*) "value");
+	if (value == NULL) {
+		xmlFree (name);
+		return gdata_parser_error_required_property_missing (node, "value", error);
+	}
 
-			/* Insert it into the hash table */
-			g_hash_table_insert (self->priv->groups, (gchar*) href, GUINT_TO_POINTER (deleted_bool));
-		} else if (xmlStrcmp (node->name, (xmlChar*) "birthday") == 0) {
-			/* gContact:birthday */
-			xmlChar *birthday;
-			guint length = 0, year = 666, month, day;
-
-			if (g_date_valid (&(self->priv->birthday)) == TRUE)
-				return gdata_parser_error_duplicate_element (node, error);
-
-			birthday = xmlGetProp (node, (xmlChar*) "when");
-			if (birthday == NULL)
-				return gdata_parser_error_required_property_missing (node, "when", error);
-			length = strlen ((char*) birthday);
-
-			/* Try parsing the two possible formats: YYYY-MM-DD and --MM-DD */
-			if (((length == 10 && sscanf ((char*) birthday, "%4u-%2u-%2u", &year, &month, &day) == 3) ||
-			     (length == 7 && sscanf ((char*) birthday, "--%2u-%2u", &month, &day) == 2)) &&
-			    g_date_valid_dmy (day, month, year) == TRUE) {
-				/* Store the values in the GDate */
-				g_date_set_dmy (&(self->priv->birthday), day, month, year);
-				self->priv->birthday_has_year = (length == 10) ? TRUE : FALSE;
-				xmlFree (birthday);
-			} else {
-				/* Parsing failed */
-				gdata_parser_error_not_iso8601_format (node, (gchar*) birthday, error);
-				xmlFree (birthday);
-				return FALSE;
-			}
-		} else {
-			return GDATA_PARSABLE_CLASS (gdata_contacts_contact_parent_class)->parse_xml (parsable, doc, node, user_data, error);
-		}
-	} else {
-		/* If we haven't yet found a photo, check to see if it's a photo <link> element */
-		if (self->priv->photo_etag == NULL && xmlStrcmp (node->name, (xmlChar*) "link") == 0) {
-			xmlChar *rel = xmlGetProp (node, (xmlChar*) "rel");
-			if (xmlStrcmp (rel, (xmlChar*) "http://schemas.google.com/contacts/2008/rel#photo") == 0) {
-				/* It's the photo link (http://code.google.com/apis/contacts/docs/2.0/reference.html#Photos), whose ETag we should
-				 * note down, then pass onto the parent class to parse properly */
-				self->priv->photo_etag = (gchar*) xmlGetProp (node, (xmlChar*) "etag");
-			}
-			xmlFree (rel);
-		}
+	gdata_contacts_contact_set_user_defined_field (GDATA_CONTACTS_CONTACT (parsable), (gchar*) name, (gchar*) value);
+
+	xmlFree (name);
+	xmlFree (value);
+
+	return TRUE;
+}
+
+static gboolean
+parse_group_membership_info (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* gContact:groupMembershipInfo */
+	xmlChar *href;
+	gboolean deleted_bool;
+
+	href = xmlGetProp (node, (xmlChar*) "href");
+	if (href == NULL)
+		return gdata_parser_error_required_property_missing (node, "href", error);
+
+	/* Has it been deleted? */
+	if (gdata_parser_boolean_from_property (node, "deleted", &deleted_bool, 0, error) == FALSE) {
+		xmlFree (href);
+		return FALSE;
+	}
+
+	/* Insert it into the hash table */
+	g_hash_table_insert (GDATA_CONTACTS_CONTACT (parsable)->priv->groups, (gchar*) href, GUINT_TO_POINTER (deleted_bool));
+
+	return TRUE;
+}
 
-		return GDATA_PARSABLE_CLASS (gdata_contacts_contact_parent_class)->parse_xml (parsable, doc, node, user_data, error);
+static gboolean
+parse_birthday (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	/* gContact:birthday */
+	GDataContactsContactPrivate *priv = GDATA_CONTACTS_CONTACT (parsable)->priv;
+	xmlChar *birthday;
+	guint length = 0, year = 666, month, day;
+
+	if (g_date_valid (&(priv->birthday)) == TRUE)
+		return gdata_parser_error_duplicate_element (node, error);
+
+	birthday = xmlGetProp (node, (xmlChar*) "when");
+	if (birthday == NULL)
+		return gdata_parser_error_required_property_missing (node, "when", error);
+	length = strlen ((char*) birthday);
+
+	/* Try parsing the two possible formats: YYYY-MM-DD and --MM-DD */
+	if (((length == 10 && sscanf ((char*) birthday, "%4u-%2u-%2u", &year, &month, &day) == 3) ||
+	     (length == 7 && sscanf ((char*) birthday, "--%2u-%2u", &month, &day) == 2)) &&
+	    g_date_valid_dmy (day, month, year) == TRUE) {
+		/* Store the values in the GDate */
+		g_date_set_dmy (&(priv->birthday), day, month, year);
+		priv->birthday_has_year = (length == 10) ? TRUE : FALSE;
+		xmlFree (birthday);
+	} else {
+		/* Parsing failed */
+		gdata_parser_error_not_iso8601_format (node, (gchar*) birthday, error);
+		xmlFree (birthday);
+		return FALSE;
 	}
 
 	return TRUE;
 }
 
 static void
-get_child_xml (GList *list, GString *xml_string)
+get_birthday_xml (GDataParsable *parsable, GString *xml_string)
 {
-	GList *i;
+	GDataContactsContactPrivate *priv = GDATA_CONTACTS_CONTACT (parsable)->priv;
 
-	for (i = list; i != NULL; i = i->next)
-		_gdata_parsable_get_xml (GDATA_PARSABLE (i->data), xml_string, FALSE);
+	if (g_date_valid (&(priv->birthday)) == FALSE)
+		return;
+
+	if (priv->birthday_has_year == TRUE) {
+		g_string_append_printf (xml_string, "<gContact:birthday when='%04u-%02u-%02u'/>",
+		                        g_date_get_year (&(priv->birthday)),
+		                        g_date_get_month (&(priv->birthday)),
+		                        g_date_get_day (&(priv->birthday)));
+	} else {
+		g_string_append_printf (xml_string, "<gContact:birthday when='--%02u-%02u'/>",
+		                        g_date_get_month (&(priv->birthday)),
+		                        g_date_get_day (&(priv->birthday)));
+	}
 }
 
+#define ATOM "http://www.w3.org/2005/Atom"
+#define APP "http://www.w3.org/2007/app"
+#define GD "http://schemas.google.com/g/2005"
+#define GCONTACT "http://schemas.google.com/contact/2008"
+
+/* The elements parsed by parse_xml(). Those with a qualified name are also output by get_xml(), in the order they're listed here. */
+static const GDataParserSchemaElement contact_schema[] = {
+	P_SCHEMA_INT64_TIME_ELEMENT (APP, "edited", NULL, P_REQUIRED | P_NO_DUPES, GDataContactsContactPrivate, edited),
+
+	P_SCHEMA_FUNC_ELEMENT (ATOM, "id", NULL, parse_id, NULL),
+	P_SCHEMA_FUNC_ELEMENT (ATOM, "link", NULL, parse_link, NULL),
+
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GD, "email", P_REQUIRED, gdata_gd_email_address_get_type, gdata_contacts_contact_add_email_address),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GD, "im", P_REQUIRED, gdata_gd_im_address_get_type, gdata_contacts_contact_add_im_address),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GD, "phoneNumber", P_REQUIRED, gdata_gd_phone_number_get_type, gdata_contacts_contact_add_phone_number),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GD, "structuredPostalAddress", P_REQUIRED, gdata_gd_postal_address_get_type,
+	                                gdata_contacts_contact_add_postal_address),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GD, "organization", P_REQUIRED, gdata_gd_organization_get_type, gdata_contacts_contact_add_organization),
+	P_SCHEMA_OBJECT_ELEMENT (GD, "name", NULL, P_REQUIRED, gdata_gd_name_get_type, GDataContactsContactPrivate, name),
+	P_SCHEMA_FUNC_ELEMENT (GD, "extendedProperty", NULL, parse_extended_property, NULL),
+	P_SCHEMA_FUNC_ELEMENT (GD, "deleted", NULL, parse_deleted, NULL),
+
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GCONTACT, "jot", P_REQUIRED, gdata_gcontact_jot_get_type, gdata_contacts_contact_add_jot),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GCONTACT, "relation", P_REQUIRED, gdata_gcontact_relation_get_type, gdata_contacts_contact_add_relation),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GCONTACT, "event", P_REQUIRED, gdata_gcontact_event_get_type, gdata_contacts_contact_add_event),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GCONTACT, "website", P_REQUIRED, gdata_gcontact_website_get_type, gdata_contacts_contact_add_website),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GCONTACT, "calendarLink", P_REQUIRED, gdata_gcontact_calendar_get_type, gdata_contacts_contact_add_calendar),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GCONTACT, "externalId", P_REQUIRED, gdata_gcontact_external_id_get_type,
+	                                gdata_contacts_contact_add_external_id),
+	P_SCHEMA_OBJECT_SETTER_ELEMENT (GCONTACT, "language", P_REQUIRED, gdata_gcontact_language_get_type, gdata_contacts_contact_add_language),
+	P_SCHEMA_FUNC_ELEMENT (GCONTACT, "hobby", NULL, parse_hobby, NULL),
+	P_SCHEMA_FUNC_ELEMENT (GCONTACT, "userDefinedField", NULL, parse_user_defined_field, NULL),
+	P_SCHEMA_FUNC_ELEMENT (GCONTACT, "groupMembershipInfo", NULL, parse_group_membership_info, NULL),
+
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "nickname", "gContact:nickname", P_REQUIRED | P_NO_DUPES, GDataContactsContactPrivate, nickname),
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "fileAs", "gContact:fileAs", P_REQUIRED | P_NO_DUPES, GDataContactsContactPrivate, file_as),
+	P_SCHEMA_FUNC_ELEMENT (GCONTACT, "birthday", "gContact:birthday", parse_birthday, get_birthday_xml),
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "billingInformation", "gContact:billingInformation", P_REQUIRED | P_NO_DUPES | P_NON_EMPTY,
+	                         GDataContactsContactPrivate, billing_information),
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "directoryServer", "gContact:directoryServer", P_REQUIRED | P_NO_DUPES | P_NON_EMPTY,
+	                         GDataContactsContactPrivate, directory_server),
+	P_SCHEMA_STRING_ATTRIBUTE_ELEMENT (GCONTACT, "gender", "gContact:gender", "value", GDataContactsContactPrivate, gender),
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "initials", "gContact:initials", P_REQUIRED | P_NO_DUPES, GDataContactsContactPrivate, initials),
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "maidenName", "gContact:maidenName", P_REQUIRED | P_NO_DUPES, GDataContactsContactPrivate, maiden_name),
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "mileage", "gContact:mileage", P_REQUIRED | P_NO_DUPES, GDataContactsContactPrivate, mileage),
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "occupation", "gContact:occupation", P_REQUIRED | P_NO_DUPES, GDataContactsContactPrivate, occupation),
+	P_SCHEMA_STRING_ATTRIBUTE_ELEMENT (GCONTACT, "priority", "gContact:priority", "rel", GDataContactsContactPrivate, priority),
+	P_SCHEMA_STRING_ATTRIBUTE_ELEMENT (GCONTACT, "sensitivity", "gContact:sensitivity", "rel", GDataContactsContactPrivate, sensitivity),
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "shortName", "gContact:shortName", P_REQUIRED | P_NO_DUPES, GDataContactsContactPrivate, short_name),
+	P_SCHEMA_STRING_ELEMENT (GCONTACT, "subject", "gContact:subject", P_REQUIRED | P_NO_DUPES, GDataContactsContactPrivate, subject),
+
+	P_SCHEMA_END
+};
+
+#undef GCONTACT
+#undef GD
+#undef APP
+#undef ATOM
+
 static void
-get_extended_property_xml_cb (const gchar *name, const gchar *value, GString *xml_string)
+register_elements (void)
 {
-	/* Note that the value *isn't* escaped (see http://code.google.com/apis/gdata/docs/2.0/elements.html#gdExtendedProperty) */
-	gdata_parser_string_append_escaped (xml_string, "<gd:extendedProperty name='", name, "'>");
-	g_string_append_printf (xml_string, "%s</gd:extendedProperty>", value);
+	gdata_parser_register_schema (GDATA_TYPE_CONTACTS_CONTACT, contact_schema);
+}
+
+static gboolean
+parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
+{
+	gboolean success;
+
+	/* The elements we understand are listed in contact_schema */
+	if (gdata_parser_dispatch_element (GDATA_TYPE_CONTACTS_CONTACT, parsable, doc, node, user_data, &success, error) == TRUE)
+		return success;
+
+	return GDATA_PARSABLE_CLASS (gdata_contacts_contact_parent_class)->parse_xml (parsable, doc, node, user_data, error);
+}
+
+static void
+get_child_xml (GList *list, GString *xml_string)
+{
+	GList *i;
+
+	for (i = list; i != NULL; i = i->next)
+		_gdata_parsable_get_xml (GDATA_PARSABLE (i->data), xml_string, FALSE);
 }
 
 static void
@@ -1102,7 +1204,8 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 	get_child_xml (priv->languages, xml_string);
 
 	/* Extended properties */
-	g_hash_table_foreach (priv->extended_properties, (GHFunc) get_extended_property_xml_cb, xml_string);
+	if (priv->extended_properties_xml != NULL)
+		g_string_append (xml_string, priv->extended_properties_xml);
 
 	/* User defined fields */
 	g_hash_table_foreach (priv->user_defined_fields, (GHFunc) get_user_defined_field_xml_cb, xml_string);
@@ -1113,74 +1216,8 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 	/* Hobbies */
 	g_list_foreach (priv->hobbies, (GFunc) get_hobby_xml_cb, xml_string);
 
-	/* gContact:nickname */
-	if (priv->nickname != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:nickname>", priv->nickname, "</gContact:nickname>");
-
-	/* gContact:fileAs */
-	if (priv->file_as != NULL) {
-		gdata_parser_string_append_escaped (xml_string, "<gContact:fileAs>", priv->file_as, "</gContact:fileAs>");
-	}
-
-	/* gContact:birthday */
-	if (g_date_valid (&(priv->birthday)) == TRUE) {
-		if (priv->birthday_has_year == TRUE) {
-			g_string_append_printf (xml_string, "<gContact:birthday when='%04u-%02u-%02u'/>",
-			                        g_date_get_year (&(priv->birthday)),
-			                        g_date_get_month (&(priv->birthday)),
-			                        g_date_get_day (&(priv->birthday)));
-		} else {
-			g_string_append_printf (xml_string, "<gContact:birthday when='--%02u-%02u'/>",
-			                        g_date_get_month (&(priv->birthday)),
-			                        g_date_get_day (&(priv->birthday)));
-		}
-	}
-
-	/* gContact:billingInformation */
-	if (priv->billing_information != NULL) {
-		gdata_parser_string_append_escaped (xml_string,
-		                                    "<gContact:billingInformation>", priv->billing_information, "</gContact:billingInformation>");
-	}
-
-	/* gContact:directoryServer */
-	if (priv->directory_server != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:directoryServer>", priv->directory_server, "</gContact:directoryServer>");
-
-	/* gContact:gender */
-	if (priv->gender != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:gender value='", priv->gender, "'/>");
-
-	/* gContact:initials */
-	if (priv->initials != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:initials>", priv->initials, "</gContact:initials>");
-
-	/* gContact:maidenName */
-	if (priv->maiden_name != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:maidenName>", priv->maiden_name, "</gContact:maidenName>");
-
-	/* gContact:mileage */
-	if (priv->mileage != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:mileage>", priv->mileage, "</gContact:mileage>");
-
-	/* gContact:occupation */
-	if (priv->occupation != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:occupation>", priv->occupation, "</gContact:occupation>");
-
-	/* gContact:priority */
-	if (priv->priority != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:priority rel='", priv->priority, "'/>");
-
-	/* gContact:sensitivity */
-	if (priv->sensitivity != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:sensitivity rel='", priv->sensitivity, "'/>");
-
-	/* gContact:shortName */
-	if (priv->short_name != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:shortName>", priv->short_name, "</gContact:shortName>");
-
-	/* gContact:subject */
-	if (priv->subject != NULL)
-		gdata_parser_string_append_escaped (xml_string, "<gContact:subject>", priv->subject, "</gContact:subject>");
+	/* Simple elements */
+	gdata_parser_get_xml_from_schema (parsable, GDATA_TYPE_CONTACTS_CONTACT, contact_schema, xml_string);
 
 	/* TODO:
 	 * - Finish supporting all tags
@@ -1878,6 +1915,8 @@ gdata_contacts_contact_add_email_address (GDataContactsContact *self, GDataGDEma
 
 	if (g_list_find_custom (self->priv->email_addresses, email_address, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->email_addresses = g_list_append (self->priv->email_addresses, g_object_ref (email_address));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:email");
 }
 
 /**
@@ -1942,6 +1981,8 @@ gdata_contacts_contact_remove_all_email_addresses (GDataContactsContact *self)
 		g_list_free (priv->email_addresses);
 	}
 	priv->email_addresses = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:email");
 }
 
 /**
@@ -1967,6 +2008,8 @@ gdata_contacts_contact_add_im_address (GDataContactsContact *self, GDataGDIMAddr
 
 	if (g_list_find_custom (self->priv->im_addresses, im_address, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->im_addresses = g_list_append (self->priv->im_addresses, g_object_ref (im_address));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:im");
 }
 
 /**
@@ -2031,6 +2074,8 @@ gdata_contacts_contact_remove_all_im_addresses (GDataContactsContact *self)
 		g_list_free (priv->im_addresses);
 	}
 	priv->im_addresses = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:im");
 }
 
 /**
@@ -2056,6 +2101,8 @@ gdata_contacts_contact_add_phone_number (GDataContactsContact *self, GDataGDPhon
 
 	if (g_list_find_custom (self->priv->phone_numbers, phone_number, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->phone_numbers = g_list_append (self->priv->phone_numbers, g_object_ref (phone_number));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:phoneNumber");
 }
 
 /**
@@ -2120,6 +2167,8 @@ gdata_contacts_contact_remove_all_phone_numbers (GDataContactsContact *self)
 		g_list_free (priv->phone_numbers);
 	}
 	priv->phone_numbers = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:phoneNumber");
 }
 
 /**
@@ -2145,6 +2194,8 @@ gdata_contacts_contact_add_postal_address (GDataContactsContact *self, GDataGDPo
 
 	if (g_list_find_custom (self->priv->postal_addresses, postal_address, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->postal_addresses = g_list_append (self->priv->postal_addresses, g_object_ref (postal_address));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:structuredPostalAddress");
 }
 
 /**
@@ -2209,6 +2260,8 @@ gdata_contacts_contact_remove_all_postal_addresses (GDataContactsContact *self)
 		g_list_free (priv->postal_addresses);
 	}
 	priv->postal_addresses = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:structuredPostalAddress");
 }
 
 /**
@@ -2234,6 +2287,8 @@ gdata_contacts_contact_add_organization (GDataContactsContact *self, GDataGDOrga
 
 	if (g_list_find_custom (self->priv->organizations, organization, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->organizations = g_list_append (self->priv->organizations, g_object_ref (organization));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:organization");
 }
 
 /**
@@ -2298,6 +2353,8 @@ gdata_contacts_contact_remove_all_organizations (GDataContactsContact *self)
 		g_list_free (priv->organizations);
 	}
 	priv->organizations = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:organization");
 }
 
 /**
@@ -2318,6 +2375,8 @@ gdata_contacts_contact_add_jot (GDataContactsContact *self, GDataGContactJot *jo
 	g_return_if_fail (GDATA_IS_GCONTACT_JOT (jot));
 
 	self->priv->jots = g_list_append (self->priv->jots, g_object_ref (jot));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:jot");
 }
 
 /**
@@ -2357,6 +2416,8 @@ gdata_contacts_contact_remove_all_jots (GDataContactsContact *self)
 		g_list_free (priv->jots);
 	}
 	priv->jots = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:jot");
 }
 
 /**
@@ -2378,6 +2439,8 @@ gdata_contacts_contact_add_relation (GDataContactsContact *self, GDataGContactRe
 	g_return_if_fail (GDATA_IS_GCONTACT_RELATION (relation));
 
 	self->priv->relations = g_list_append (self->priv->relations, g_object_ref (relation));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:relation");
 }
 
 /**
@@ -2417,6 +2480,8 @@ gdata_contacts_contact_remove_all_relations (GDataContactsContact *self)
 		g_list_free (priv->relations);
 	}
 	priv->relations = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:relation");
 }
 
 /**
@@ -2439,6 +2504,8 @@ gdata_contacts_contact_add_website (GDataContactsContact *self, GDataGContactWeb
 
 	if (g_list_find_custom (self->priv->websites, website, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->websites = g_list_append (self->priv->websites, g_object_ref (website));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:website");
 }
 
 /**
@@ -2503,6 +2570,8 @@ gdata_contacts_contact_remove_all_websites (GDataContactsContact *self)
 		g_list_free (priv->websites);
 	}
 	priv->websites = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:website");
 }
 
 /**
@@ -2524,6 +2593,8 @@ gdata_contacts_contact_add_event (GDataContactsContact *self, GDataGContactEvent
 	g_return_if_fail (GDATA_IS_GCONTACT_EVENT (event));
 
 	self->priv->events = g_list_append (self->priv->events, g_object_ref (event));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:event");
 }
 
 /**
@@ -2563,6 +2634,8 @@ gdata_contacts_contact_remove_all_events (GDataContactsContact *self)
 		g_list_free (priv->events);
 	}
 	priv->events = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:event");
 }
 
 /**
@@ -2585,6 +2658,8 @@ gdata_contacts_contact_add_calendar (GDataContactsContact *self, GDataGContactCa
 
 	if (g_list_find_custom (self->priv->calendars, calendar, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->calendars = g_list_append (self->priv->calendars, g_object_ref (calendar));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:calendarLink");
 }
 
 /**
@@ -2649,6 +2724,8 @@ gdata_contacts_contact_remove_all_calendars (GDataContactsContact *self)
 		g_list_free (priv->calendars);
 	}
 	priv->calendars = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:calendarLink");
 }
 
 /**
@@ -2670,6 +2747,8 @@ gdata_contacts_contact_add_external_id (GDataContactsContact *self, GDataGContac
 
 	if (g_list_find_custom (self->priv->external_ids, external_id, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->external_ids = g_list_append (self->priv->external_ids, g_object_ref (external_id));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:externalId");
 }
 
 /**
@@ -2709,6 +2788,8 @@ gdata_contacts_contact_remove_all_external_ids (GDataContactsContact *self)
 		g_list_free (priv->external_ids);
 	}
 	priv->external_ids = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:externalId");
 }
 
 /**
@@ -2730,6 +2811,8 @@ gdata_contacts_contact_add_hobby (GDataContactsContact *self, const gchar *hobby
 
 	if (g_list_find_custom (self->priv->hobbies, hobby, (GCompareFunc) g_strcmp0) == NULL)
 		self->priv->hobbies = g_list_append (self->priv->hobbies, g_strdup (hobby));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:hobby");
 }
 
 /**
@@ -2769,6 +2852,8 @@ gdata_contacts_contact_remove_all_hobbies (GDataContactsContact *self)
 		g_list_free (priv->hobbies);
 	}
 	priv->hobbies = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:hobby");
 }
 
 /**
@@ -2790,6 +2875,8 @@ gdata_contacts_contact_add_language (GDataContactsContact *self, GDataGContactLa
 
 	if (g_list_find_custom (self->priv->languages, language, (GCompareFunc) gdata_comparable_compare) == NULL)
 		self->priv->languages = g_list_append (self->priv->languages, g_object_ref (language));
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:language");
 }
 
 /**
@@ -2829,6 +2916,8 @@ gdata_contacts_contact_remove_all_languages (GDataContactsContact *self)
 		g_list_free (priv->languages);
 	}
 	priv->languages = NULL;
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:language");
 }
 
 /**
@@ -2855,7 +2944,8 @@ gdata_contacts_contact_get_extended_property (GDataContactsContact *self, const
  * gdata_contacts_contact_get_extended_properties:
  * @self: a #GDataContactsContact
  *
- * Gets the full list of extended properties of the contact; a hash table mapping property name to value.
+ * Gets the full list of extended properties of the contact; a hash table mapping property name to value. The hash table must not be modified; use
+ * gdata_contacts_contact_set_extended_property() to change the properties.
  *
  * Return value: (transfer none): a #GHashTable of extended properties
  *
@@ -2868,6 +2958,33 @@ gdata_contacts_contact_get_extended_properties (GDataContactsContact *self)
 	return self->priv->extended_properties;
 }
 
+static void
+get_extended_property_xml_cb (const gchar *name, const gchar *value, GString *xml_string)
+{
+	/* Note that the value *isn't* escaped (see http://code.google.com/apis/gdata/docs/2.0/elements.html#gdExtendedProperty) */
+	gdata_parser_string_append_escaped (xml_string, "<gd:extendedProperty name='", name, "'>");
+	g_string_append (xml_string, value);
+	g_string_append (xml_string, "</gd:extendedProperty>");
+}
+
+/* Re-serialise the extended properties after they've been changed. There are at most MAX_N_EXTENDED_PROPERTIES of them, so this is cheap, and means
+ * that get_xml() doesn't have to escape their names again every time the contact is serialised (for example, for each retry of an update). */
+static void
+update_extended_properties_xml (GDataContactsContact *self)
+{
+	GString *xml_string;
+
+	g_free (self->priv->extended_properties_xml);
+	self->priv->extended_properties_xml = NULL;
+
+	if (g_hash_table_size (self->priv->extended_properties) == 0)
+		return;
+
+	xml_string = g_string_new (NULL);
+	g_hash_table_foreach (self->priv->extended_properties, (GHFunc) get_extended_property_xml_cb, xml_string);
+	self->priv->extended_properties_xml = g_string_free (xml_string, FALSE);
+}
+
 /**
  * gdata_contacts_contact_set_extended_property:
  * @self: a #GDataContactsContact
@@ -2898,7 +3015,9 @@ gdata_contacts_contact_set_extended_property (GDataContactsContact *self, const
 
 	if (value == NULL || *value == '\0') {
 		/* Removing a property */
-		g_hash_table_remove (extended_properties, name);
+		if (g_hash_table_remove (extended_properties, name) == TRUE)
+			update_extended_properties_xml (self);
+		_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:extendedProperty");
 		return TRUE;
 	}
 
@@ -2909,6 +3028,8 @@ gdata_contacts_contact_set_extended_property (GDataContactsContact *self, const
 
 	/* Updating an existing property or adding a new one */
 	g_hash_table_insert (extended_properties, g_strdup (name), g_strdup (value));
+	update_extended_properties_xml (self);
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gd:extendedProperty");
 
 	return TRUE;
 }
@@ -2980,6 +3101,8 @@ gdata_contacts_contact_set_user_defined_field (GDataContactsContact *self, const
 		/* Updating an existing field or adding a new one */
 		g_hash_table_insert (self->priv->user_defined_fields, g_strdup (name), g_strdup (value));
 	}
+
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:userDefinedField");
 }
 
 /**
@@ -2994,9 +3117,20 @@ gdata_contacts_contact_set_user_defined_field (GDataContactsContact *self, const
 void
 gdata_contacts_contact_add_group (GDataContactsContact *self, const gchar *href)
 {
+	gpointer value;
+	gboolean was_member;
+
 	g_return_if_fail (GDATA_IS_CONTACTS_CONTACT (self));
 	g_return_if_fail (href != NULL);
+
+	/* Only a deleted membership (or no membership at all) is a change */
+	was_member = (g_hash_table_lookup_extended (self->priv->groups, href, NULL, &value) == TRUE && GPOINTER_TO_UINT (value) == FALSE);
+
 	g_hash_table_insert (self->priv->groups, g_strdup (href), GUINT_TO_POINTER (FALSE));
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:groupMembershipInfo");
+
+	if (was_member == FALSE)
+		g_signal_emit (self, contact_signals[SIGNAL_GROUP_MEMBERSHIP_CHANGED], 0, href, TRUE);
 }
 
 /**
@@ -3011,9 +3145,20 @@ gdata_contacts_contact_add_group (GDataContactsContact *self, const gchar *href)
 void
 gdata_contacts_contact_remove_group (GDataContactsContact *self, const gchar *href)
 {
+	gpointer value;
+	gboolean was_member;
+
 	g_return_if_fail (GDATA_IS_CONTACTS_CONTACT (self));
 	g_return_if_fail (href != NULL);
+
+	/* Deleted memberships don't count, as gdata_contacts_contact_get_groups() doesn't return them */
+	was_member = (g_hash_table_lookup_extended (self->priv->groups, href, NULL, &value) == TRUE && GPOINTER_TO_UINT (value) == FALSE);
+
 	g_hash_table_remove (self->priv->groups, href);
+	_gdata_entry_mark_field_dirty (GDATA_ENTRY (self), "gContact:groupMembershipInfo");
+
+	if (was_member == TRUE)
+		g_signal_emit (self, contact_signals[SIGNAL_GROUP_MEMBERSHIP_CHANGED], 0, href, FALSE);
 }
 
 /**
@@ -3155,8 +3300,12 @@ gdata_contacts_contact_get_photo (GDataContactsContact *self, GDataContactsServi
 	if (gdata_contacts_contact_get_photo_etag (self) == NULL)
 		return NULL;
 
+	/* Return the cached photo if it hasn't changed since it was cached */
+	data = _gdata_contacts_service_look_up_photo (service, gdata_entry_get_id (GDATA_ENTRY (self)), self->priv->photo_etag, length, content_type);
+	if (data != NULL)
+		return data;
+
 	/* Get the photo URI */
-	/* TODO: ETag support */
 	_link = gdata_entry_look_up_link (GDATA_ENTRY (self), "http://schemas.google.com/contacts/2008/rel#photo");
 	g_assert (_link != NULL);
 	message = _gdata_service_build_message (GDATA_SERVICE (service), gdata_contacts_service_get_primary_authorization_domain (),
@@ -3190,6 +3339,9 @@ gdata_contacts_contact_get_photo (GDataContactsContact *self, GDataContactsServi
 	/* Update the stored photo ETag */
 	g_free (self->priv->photo_etag);
 	self->priv->photo_etag = g_strdup (soup_message_headers_get_one (message->response_headers, "ETag"));
+
+	_gdata_contacts_service_cache_photo (service, gdata_entry_get_id (GDATA_ENTRY (self)), self->priv->photo_etag,
+	                                     soup_message_headers_get_content_type (message->response_headers, NULL), data, *length);
 	g_object_unref (message);
 
 	return data;
@@ -3331,6 +3483,142 @@ gdata_contacts_contact_get_photo_finish (GDataContactsContact *self, GAsyncResul
 	return photo_data;
 }
 
+/**
+ * gdata_contacts_contact_get_photo_to_file:
+ * @self: a #GDataContactsContact
+ * @service: a #GDataContactsService
+ * @destination: the #GFile to save the photo to
+ * @content_type: (out callee-allocates) (transfer full) (allow-none): return location for the image's content type, or %NULL; free with g_free()
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Downloads the contact's photo to @destination, if they have one, as with gdata_contacts_contact_get_photo(). The image is written straight to
+ * @destination as it's received using gdata_download_stream_download_to_file(), rather than being held in memory. @destination is created if it
+ * doesn't exist and overwritten if it does; if the download fails, its contents are undefined.
+ *
+ * If the contact doesn't have a photo (i.e. gdata_contacts_contact_get_photo_etag() returns %NULL), %FALSE is returned, but no error is set in
+ * @error and @destination isn't touched.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ *
+ * If there is an error getting the photo, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned.
+ *
+ * Return value: %TRUE if the photo was downloaded, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_contact_get_photo_to_file (GDataContactsContact *self, GDataContactsService *service, GFile *destination, gchar **content_type,
+                                          GCancellable *cancellable, GError **error)
+{
+	GDataLink *_link;
+	GDataDownloadStream *download_stream;
+	const gchar *etag;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_FILE (destination), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* Return if there is no photo */
+	if (gdata_contacts_contact_get_photo_etag (self) == NULL)
+		return FALSE;
+
+	/* Get the photo URI */
+	_link = gdata_entry_look_up_link (GDATA_ENTRY (self), "http://schemas.google.com/contacts/2008/rel#photo");
+	g_assert (_link != NULL);
+	download_stream = GDATA_DOWNLOAD_STREAM (gdata_download_stream_new (GDATA_SERVICE (service),
+	                                                                    gdata_contacts_service_get_primary_authorization_domain (),
+	                                                                    gdata_link_get_uri (_link), NULL));
+
+	if (gdata_download_stream_download_to_file (download_stream, destination, cancellable, error) == FALSE) {
+		g_object_unref (download_stream);
+		return FALSE;
+	}
+
+	/* Sort out the return values */
+	if (content_type != NULL)
+		*content_type = g_strdup (gdata_download_stream_get_content_type (download_stream));
+
+	/* Update the stored photo ETag */
+	etag = _gdata_download_stream_get_etag (download_stream);
+	g_free (self->priv->photo_etag);
+	self->priv->photo_etag = g_strdup (etag);
+	g_object_unref (download_stream);
+
+	return TRUE;
+}
+
+/**
+ * gdata_contacts_contact_get_photo_to_stream:
+ * @self: a #GDataContactsContact
+ * @service: a #GDataContactsService
+ * @destination: the #GOutputStream to write the photo to
+ * @content_type: (out callee-allocates) (transfer full) (allow-none): return location for the image's content type, or %NULL; free with g_free()
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Downloads the contact's photo and writes it to @destination, if they have one, as with gdata_contacts_contact_get_photo(). The image is spliced
+ * from a #GDataDownloadStream to @destination as it's received, so it's never held in memory in its entirety; @destination could be a file, or
+ * a #GDataUploadStream for another service. @destination isn't closed.
+ *
+ * If the contact doesn't have a photo (i.e. gdata_contacts_contact_get_photo_etag() returns %NULL), %FALSE is returned, but no error is set in
+ * @error and nothing is written to @destination. If the download fails part-way through, some of the photo may already have been written.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ *
+ * If there is an error getting the photo, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned.
+ *
+ * Return value: %TRUE if the photo was downloaded, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_contact_get_photo_to_stream (GDataContactsContact *self, GDataContactsService *service, GOutputStream *destination,
+                                            gchar **content_type, GCancellable *cancellable, GError **error)
+{
+	GDataLink *_link;
+	GInputStream *download_stream;
+	const gchar *etag;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_OUTPUT_STREAM (destination), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* Return if there is no photo */
+	if (gdata_contacts_contact_get_photo_etag (self) == NULL)
+		return FALSE;
+
+	/* Get the photo URI */
+	_link = gdata_entry_look_up_link (GDATA_ENTRY (self), "http://schemas.google.com/contacts/2008/rel#photo");
+	g_assert (_link != NULL);
+	download_stream = gdata_download_stream_new (GDATA_SERVICE (service), gdata_contacts_service_get_primary_authorization_domain (),
+	                                             gdata_link_get_uri (_link), cancellable);
+
+	/* Closing the download stream means the network thread's finished with it by the time we look at its ETag */
+	if (g_output_stream_splice (destination, download_stream, G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE, cancellable, error) == -1) {
+		g_object_unref (download_stream);
+		return FALSE;
+	}
+
+	/* Sort out the return values */
+	if (content_type != NULL)
+		*content_type = g_strdup (gdata_download_stream_get_content_type (GDATA_DOWNLOAD_STREAM (download_stream)));
+
+	/* Update the stored photo ETag */
+	etag = _gdata_download_stream_get_etag (GDATA_DOWNLOAD_STREAM (download_stream));
+	g_free (self->priv->photo_etag);
+	self->priv->photo_etag = g_strdup (etag);
+	g_object_unref (download_stream);
+
+	return TRUE;
+}
+
 /**
  * gdata_contacts_contact_set_photo:
  * @self: a #GDataContactsContact
@@ -3519,3 +3807,67 @@ gdata_contacts_contact_set_photo_finish (GDataContactsContact *self, GAsyncResul
 
 	return g_simple_async_result_get_op_res_gboolean (result);
 }
+
+/**
+ * gdata_contacts_contact_set_photo_from_stream:
+ * @self: a #GDataContactsContact
+ * @service: a #GDataContactsService
+ * @source: the #GInputStream to read the image data from
+ * @content_type: the content type of the image
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Sets the contact's photo to the image data read from @source, as with gdata_contacts_contact_set_photo(). The data is spliced from @source into
+ * a #GDataUploadStream as it's read, so it's never held in memory in its entirety; @source could be a file, or a #GDataDownloadStream from another
+ * service. @source isn't closed. To delete the contact's photo, use gdata_contacts_contact_set_photo() with %NULL data.
+ *
+ * If @cancellable is not %NULL, then the operation can be cancelled by triggering the @cancellable object from another thread.
+ * If the operation was cancelled, the error %G_IO_ERROR_CANCELLED will be returned.
+ *
+ * If there is an error setting the photo, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_contact_set_photo_from_stream (GDataContactsContact *self, GDataContactsService *service, GInputStream *source,
+                                              const gchar *content_type, GCancellable *cancellable, GError **error)
+{
+	GDataLink *_link;
+	GOutputStream *upload_stream;
+	const gchar *etag;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_INPUT_STREAM (source), FALSE);
+	g_return_val_if_fail (content_type != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	/* Get the photo URI */
+	_link = gdata_entry_look_up_link (GDATA_ENTRY (self), "http://schemas.google.com/contacts/2008/rel#photo");
+	g_assert (_link != NULL);
+
+	upload_stream = gdata_upload_stream_new (GDATA_SERVICE (service), gdata_contacts_service_get_primary_authorization_domain (),
+	                                         SOUP_METHOD_PUT, gdata_link_get_uri (_link), NULL, "", content_type, cancellable);
+
+	/* We always have to set an If-Match header, as in gdata_contacts_contact_set_photo() */
+	etag = self->priv->photo_etag;
+	_gdata_upload_stream_set_if_match (GDATA_UPLOAD_STREAM (upload_stream), (etag == NULL || *etag == '\0') ? "*" : etag);
+
+	/* Closing the upload stream sends the end of the request and waits for the response */
+	if (g_output_stream_splice (upload_stream, source, G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET, cancellable, error) == -1) {
+		g_object_unref (upload_stream);
+		return FALSE;
+	}
+
+	/* Update the stored photo ETag */
+	g_free (self->priv->photo_etag);
+	self->priv->photo_etag = _gdata_upload_stream_dup_response_etag (GDATA_UPLOAD_STREAM (upload_stream));
+	g_object_notify (G_OBJECT (self), "photo-etag");
+
+	g_object_unref (upload_stream);
+
+	return TRUE;
+}
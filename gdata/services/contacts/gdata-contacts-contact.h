@@ -288,12 +288,18 @@ void gdata_contacts_contact_get_photo_async (GDataContactsContact *self, GDataCo
                                              GAsyncReadyCallback callback, gpointer user_data);
 guint8 *gdata_contacts_contact_get_photo_finish (GDataContactsContact *self, GAsyncResult *async_result, gsize *length, gchar **content_type,
                                                  GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gboolean gdata_contacts_contact_get_photo_to_file (GDataContactsContact *self, GDataContactsService *service, GFile *destination,
+                                                   gchar **content_type, GCancellable *cancellable, GError **error);
+gboolean gdata_contacts_contact_get_photo_to_stream (GDataContactsContact *self, GDataContactsService *service, GOutputStream *destination,
+                                                     gchar **content_type, GCancellable *cancellable, GError **error);
 
 gboolean gdata_contacts_contact_set_photo (GDataContactsContact *self, GDataContactsService *service, const guint8 *data, gsize length,
                                            const gchar *content_type, GCancellable *cancellable, GError **error);
 void gdata_contacts_contact_set_photo_async (GDataContactsContact *self, GDataContactsService *service, const guint8 *data, gsize length,
                                              const gchar *content_type, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
 gboolean gdata_contacts_contact_set_photo_finish (GDataContactsContact *self, GAsyncResult *async_result, GError **error);
+gboolean gdata_contacts_contact_set_photo_from_stream (GDataContactsContact *self, GDataContactsService *service, GInputStream *source,
+                                                      const gchar *content_type, GCancellable *cancellable, GError **error);
 
 G_END_DECLS
 
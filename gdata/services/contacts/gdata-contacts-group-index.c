@@ -0,0 +1,339 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-contacts-group-index
+ * @short_description: GData contacts group membership index object
+ * @stability: Unstable
+ * @include: gdata/services/contacts/gdata-contacts-group-index.h
+ *
+ * #GDataContactsGroupIndex is a standalone class which indexes a set of #GDataContactsContact<!-- -->s by the groups they're in, so that the
+ * members of a group can be listed without calling gdata_contacts_contact_get_groups() on every contact. It's typically built from the feed returned
+ * by gdata_contacts_service_query_contacts(), and is kept up to date as contacts are added to and removed from groups with
+ * gdata_contacts_contact_add_group() and gdata_contacts_contact_remove_group() (see #GDataContactsContact::group-membership-changed).
+ *
+ * Groups are identified by their ID URIs, as returned by gdata_contacts_contact_get_groups(). As with that function, groups the contact has been
+ * removed from on the server (see gdata_contacts_contact_is_group_deleted()) aren't indexed.
+ *
+ * <example>
+ *	<title>Listing a Group's Members</title>
+ *	<programlisting>
+ *	GDataContactsGroupIndex *index;
+ *	GList *members, *i;
+ *
+ *	index = gdata_contacts_group_index_new (contacts_feed);
+ *	members = gdata_contacts_group_index_get_contacts (index, gdata_entry_get_id (GDATA_ENTRY (group)));
+ *
+ *	for (i = members; i != NULL; i = i->next)
+ *		g_message ("%s", gdata_entry_get_title (GDATA_ENTRY (i->data)));
+ *
+ *	g_list_free (members);
+ *	g_object_unref (index);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-contacts-group-index.h"
+
+static void gdata_contacts_group_index_dispose (GObject *object);
+static void gdata_contacts_group_index_finalize (GObject *object);
+
+struct _GDataContactsGroupIndexPrivate {
+	GHashTable *contacts; /* GDataContactsContact (reffed) → group-membership-changed handler ID */
+	GHashTable *groups; /* group ID (owned) → GHashTable set of the group's GDataContactsContacts (not reffed; ->contacts holds the refs) */
+};
+
+G_DEFINE_TYPE (GDataContactsGroupIndex, gdata_contacts_group_index, G_TYPE_OBJECT)
+
+static void
+gdata_contacts_group_index_class_init (GDataContactsGroupIndexClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataContactsGroupIndexPrivate));
+
+	gobject_class->dispose = gdata_contacts_group_index_dispose;
+	gobject_class->finalize = gdata_contacts_group_index_finalize;
+}
+
+static void
+gdata_contacts_group_index_init (GDataContactsGroupIndex *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CONTACTS_GROUP_INDEX, GDataContactsGroupIndexPrivate);
+
+	self->priv->contacts = g_hash_table_new (g_direct_hash, g_direct_equal);
+	self->priv->groups = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+}
+
+static void
+gdata_contacts_group_index_dispose (GObject *object)
+{
+	GDataContactsGroupIndexPrivate *priv = GDATA_CONTACTS_GROUP_INDEX (object)->priv;
+	GHashTableIter iter;
+	gpointer contact, handler_id;
+
+	g_hash_table_iter_init (&iter, priv->contacts);
+	while (g_hash_table_iter_next (&iter, &contact, &handler_id) == TRUE) {
+		g_signal_handler_disconnect (contact, GPOINTER_TO_SIZE (handler_id));
+		g_object_unref (contact);
+	}
+
+	g_hash_table_remove_all (priv->contacts);
+	g_hash_table_remove_all (priv->groups);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_contacts_group_index_parent_class)->dispose (object);
+}
+
+static void
+gdata_contacts_group_index_finalize (GObject *object)
+{
+	GDataContactsGroupIndexPrivate *priv = GDATA_CONTACTS_GROUP_INDEX (object)->priv;
+
+	g_hash_table_destroy (priv->contacts);
+	g_hash_table_destroy (priv->groups);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_contacts_group_index_parent_class)->finalize (object);
+}
+
+/**
+ * gdata_contacts_group_index_new:
+ * @feed: (allow-none): a #GDataFeed of #GDataContactsContact<!-- -->s to index, or %NULL
+ *
+ * Creates a new #GDataContactsGroupIndex, indexing the contacts in @feed (as by gdata_contacts_group_index_add_feed()) if it's non-%NULL.
+ *
+ * Return value: (transfer full): a new #GDataContactsGroupIndex; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataContactsGroupIndex *
+gdata_contacts_group_index_new (GDataFeed *feed)
+{
+	GDataContactsGroupIndex *self;
+
+	g_return_val_if_fail (feed == NULL || GDATA_IS_FEED (feed), NULL);
+
+	self = g_object_new (GDATA_TYPE_CONTACTS_GROUP_INDEX, NULL);
+
+	if (feed != NULL)
+		gdata_contacts_group_index_add_feed (self, feed);
+
+	return self;
+}
+
+static void
+index_membership (GDataContactsGroupIndex *self, GDataContactsContact *contact, const gchar *group_id)
+{
+	GHashTable *members;
+
+	members = g_hash_table_lookup (self->priv->groups, group_id);
+	if (members == NULL) {
+		members = g_hash_table_new (g_direct_hash, g_direct_equal);
+		g_hash_table_insert (self->priv->groups, g_strdup (group_id), members);
+	}
+
+	g_hash_table_insert (members, contact, contact);
+}
+
+static void
+unindex_membership (GDataContactsGroupIndex *self, GDataContactsContact *contact, const gchar *group_id)
+{
+	GHashTable *members;
+
+	members = g_hash_table_lookup (self->priv->groups, group_id);
+	if (members == NULL)
+		return;
+
+	g_hash_table_remove (members, contact);
+
+	/* Don't keep empty groups around, so that gdata_contacts_group_index_get_groups() only lists groups with members */
+	if (g_hash_table_size (members) == 0)
+		g_hash_table_remove (self->priv->groups, group_id);
+}
+
+static void
+group_membership_changed_cb (GDataContactsContact *contact, const gchar *href, gboolean is_member, GDataContactsGroupIndex *self)
+{
+	if (is_member == TRUE)
+		index_membership (self, contact, href);
+	else
+		unindex_membership (self, contact, href);
+}
+
+/**
+ * gdata_contacts_group_index_add_feed:
+ * @self: a #GDataContactsGroupIndex
+ * @feed: a #GDataFeed of #GDataContactsContact<!-- -->s
+ *
+ * Adds all the #GDataContactsContact<!-- -->s in @feed to the index, as by gdata_contacts_group_index_add_contact(). Any other entries in @feed are
+ * ignored.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_group_index_add_feed (GDataContactsGroupIndex *self, GDataFeed *feed)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_GROUP_INDEX (self));
+	g_return_if_fail (GDATA_IS_FEED (feed));
+
+	for (i = gdata_feed_get_entries (feed); i != NULL; i = i->next) {
+		if (GDATA_IS_CONTACTS_CONTACT (i->data) == TRUE)
+			gdata_contacts_group_index_add_contact (self, i->data);
+	}
+}
+
+/**
+ * gdata_contacts_group_index_add_contact:
+ * @self: a #GDataContactsGroupIndex
+ * @contact: a #GDataContactsContact to index
+ *
+ * Adds @contact to the index under each of the groups it's in. @contact is reffed until it's removed from the index (or the index is destroyed), and
+ * the index is updated whenever @contact is added to or removed from a group in the meantime. Adding a contact which is already in the index does
+ * nothing.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_group_index_add_contact (GDataContactsGroupIndex *self, GDataContactsContact *contact)
+{
+	GList *groups, *i;
+	gulong handler_id;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_GROUP_INDEX (self));
+	g_return_if_fail (GDATA_IS_CONTACTS_CONTACT (contact));
+
+	if (g_hash_table_lookup (self->priv->contacts, contact) != NULL)
+		return;
+
+	handler_id = g_signal_connect (contact, "group-membership-changed", (GCallback) group_membership_changed_cb, self);
+	g_hash_table_insert (self->priv->contacts, g_object_ref (contact), GSIZE_TO_POINTER (handler_id));
+
+	groups = gdata_contacts_contact_get_groups (contact);
+	for (i = groups; i != NULL; i = i->next)
+		index_membership (self, contact, i->data);
+	g_list_free (groups);
+}
+
+/**
+ * gdata_contacts_group_index_remove_contact:
+ * @self: a #GDataContactsGroupIndex
+ * @contact: a #GDataContactsContact to remove from the index
+ *
+ * Removes @contact from the index, so that it's no longer listed as a member of any group. Removing a contact which isn't in the index does nothing.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_group_index_remove_contact (GDataContactsGroupIndex *self, GDataContactsContact *contact)
+{
+	gpointer handler_id;
+	GList *groups, *i;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_GROUP_INDEX (self));
+	g_return_if_fail (GDATA_IS_CONTACTS_CONTACT (contact));
+
+	handler_id = g_hash_table_lookup (self->priv->contacts, contact);
+	if (handler_id == NULL)
+		return;
+
+	/* The index is kept in sync with the contact's groups, so these are exactly the groups it's indexed under */
+	groups = gdata_contacts_contact_get_groups (contact);
+	for (i = groups; i != NULL; i = i->next)
+		unindex_membership (self, contact, i->data);
+	g_list_free (groups);
+
+	g_signal_handler_disconnect (contact, GPOINTER_TO_SIZE (handler_id));
+	g_hash_table_remove (self->priv->contacts, contact);
+	g_object_unref (contact);
+}
+
+/**
+ * gdata_contacts_group_index_get_contacts:
+ * @self: a #GDataContactsGroupIndex
+ * @group_id: the ID URI of a group
+ *
+ * Gets the indexed contacts which are in the group with ID @group_id, in no particular order.
+ *
+ * Return value: (element-type GData.ContactsContact) (transfer container): a #GList of the group's #GDataContactsContact<!-- -->s, or %NULL; free
+ * with g_list_free()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_contacts_group_index_get_contacts (GDataContactsGroupIndex *self, const gchar *group_id)
+{
+	GHashTable *members;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_GROUP_INDEX (self), NULL);
+	g_return_val_if_fail (group_id != NULL, NULL);
+
+	members = g_hash_table_lookup (self->priv->groups, group_id);
+
+	return (members != NULL) ? g_hash_table_get_keys (members) : NULL;
+}
+
+/**
+ * gdata_contacts_group_index_get_n_contacts:
+ * @self: a #GDataContactsGroupIndex
+ * @group_id: the ID URI of a group
+ *
+ * Gets the number of indexed contacts which are in the group with ID @group_id, without having to list them.
+ *
+ * Return value: the number of contacts in the group
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_contacts_group_index_get_n_contacts (GDataContactsGroupIndex *self, const gchar *group_id)
+{
+	GHashTable *members;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_GROUP_INDEX (self), 0);
+	g_return_val_if_fail (group_id != NULL, 0);
+
+	members = g_hash_table_lookup (self->priv->groups, group_id);
+
+	return (members != NULL) ? g_hash_table_size (members) : 0;
+}
+
+/**
+ * gdata_contacts_group_index_get_groups:
+ * @self: a #GDataContactsGroupIndex
+ *
+ * Gets the IDs of all the groups which at least one of the indexed contacts is in, in no particular order.
+ *
+ * Return value: (element-type utf8) (transfer container): a #GList of constant group ID URIs, or %NULL; free with g_list_free()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_contacts_group_index_get_groups (GDataContactsGroupIndex *self)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_GROUP_INDEX (self), NULL);
+
+	return g_hash_table_get_keys (self->priv->groups);
+}
@@ -0,0 +1,78 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_CONTACTS_GROUP_INDEX_H
+#define GDATA_CONTACTS_GROUP_INDEX_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gdata/gdata-feed.h>
+#include <gdata/services/contacts/gdata-contacts-contact.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_CONTACTS_GROUP_INDEX			(gdata_contacts_group_index_get_type ())
+#define GDATA_CONTACTS_GROUP_INDEX(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CONTACTS_GROUP_INDEX, GDataContactsGroupIndex))
+#define GDATA_CONTACTS_GROUP_INDEX_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CONTACTS_GROUP_INDEX, GDataContactsGroupIndexClass))
+#define GDATA_IS_CONTACTS_GROUP_INDEX(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CONTACTS_GROUP_INDEX))
+#define GDATA_IS_CONTACTS_GROUP_INDEX_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_CONTACTS_GROUP_INDEX))
+#define GDATA_CONTACTS_GROUP_INDEX_GET_CLASS(o)		(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_CONTACTS_GROUP_INDEX, GDataContactsGroupIndexClass))
+
+typedef struct _GDataContactsGroupIndexPrivate	GDataContactsGroupIndexPrivate;
+
+/**
+ * GDataContactsGroupIndex:
+ *
+ * All the fields in the #GDataContactsGroupIndex structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataContactsGroupIndexPrivate *priv;
+} GDataContactsGroupIndex;
+
+/**
+ * GDataContactsGroupIndexClass:
+ *
+ * All the fields in the #GDataContactsGroupIndexClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataContactsGroupIndexClass;
+
+GType gdata_contacts_group_index_get_type (void) G_GNUC_CONST;
+
+GDataContactsGroupIndex *gdata_contacts_group_index_new (GDataFeed *feed) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+void gdata_contacts_group_index_add_feed (GDataContactsGroupIndex *self, GDataFeed *feed);
+void gdata_contacts_group_index_add_contact (GDataContactsGroupIndex *self, GDataContactsContact *contact);
+void gdata_contacts_group_index_remove_contact (GDataContactsGroupIndex *self, GDataContactsContact *contact);
+
+GList *gdata_contacts_group_index_get_contacts (GDataContactsGroupIndex *self, const gchar *group_id) G_GNUC_WARN_UNUSED_RESULT;
+guint gdata_contacts_group_index_get_n_contacts (GDataContactsGroupIndex *self, const gchar *group_id);
+GList *gdata_contacts_group_index_get_groups (GDataContactsGroupIndex *self) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* !GDATA_CONTACTS_GROUP_INDEX_H */
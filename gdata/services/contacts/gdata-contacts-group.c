@@ -112,6 +112,7 @@
 static GObject *gdata_contacts_group_constructor (GType type, guint n_construct_params, GObjectConstructParam *construct_params);
 static void gdata_contacts_group_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_contacts_group_finalize (GObject *object);
+static void refresh_private (GDataEntry *self, GDataEntry *other);
 static void get_xml (GDataParsable *parsable, GString *xml_string);
 static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error);
 static void get_namespaces (GDataParsable *parsable, GHashTable *namespaces);
@@ -151,6 +152,7 @@ gdata_contacts_group_class_init (GDataContactsGroupClass *klass)
 
 	entry_class->get_entry_uri = get_entry_uri;
 	entry_class->kind_term = "http://schemas.google.com/contact/2008#group";
+	_gdata_entry_class_set_refresh_func (entry_class, refresh_private);
 
 	/**
 	 * GDataContactsGroup:edited:
@@ -301,6 +303,20 @@ gdata_contacts_group_get_property (GObject *object, guint property_id, GValue *v
 	}
 }
 
+static void
+refresh_private (GDataEntry *self, GDataEntry *other)
+{
+	GDataContactsGroupPrivate *priv = GDATA_CONTACTS_GROUP (self)->priv, *other_priv = GDATA_CONTACTS_GROUP (other)->priv;
+	gchar *system_group_id;
+
+	priv->edited = other_priv->edited;
+	priv->deleted = other_priv->deleted;
+
+	system_group_id = priv->system_group_id;
+	priv->system_group_id = other_priv->system_group_id;
+	other_priv->system_group_id = system_group_id;
+}
+
 static void
 gdata_contacts_group_finalize (GObject *object)
 {
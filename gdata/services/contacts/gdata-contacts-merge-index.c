@@ -0,0 +1,533 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-contacts-merge-index
+ * @short_description: GData contacts duplicate detection index object
+ * @stability: Unstable
+ * @include: gdata/services/contacts/gdata-contacts-merge-index.h
+ *
+ * #GDataContactsMergeIndex is a standalone class which finds #GDataContactsContact<!-- -->s which are likely to be the same person, typically
+ * across the address books of several accounts. Contacts are indexed by their normalised e-mail addresses and phone numbers, and two contacts are
+ * considered duplicates if they share any of them; duplication is transitive, so a contact sharing an e-mail address with a second contact, which
+ * in turn shares a phone number with a third, is grouped with both. Indexing and grouping take time linear in the number of contacts and addresses,
+ * rather than comparing every contact with every other.
+ *
+ * E-mail addresses are compared case-insensitively, with Gmail's equivalences applied: <literal>googlemail.com</literal> is treated as
+ * <literal>gmail.com</literal>, and dots and <literal>+</literal>suffixes in the local parts of Gmail addresses are ignored. Phone numbers are
+ * compared on their last ten digits (or all of them, if there are fewer), so that the same number written in national and international formats
+ * matches; numbers with fewer than seven digits are ignored, since they're too short to identify anyone.
+ *
+ * Contacts are identified by their entry IDs, which are unique across accounts. Adding a contact whose ID is already in the index replaces the older
+ * version, so the index can be kept up to date with delta feeds, or from the #GDataContactsSyncStore.apply_contact and
+ * #GDataContactsSyncStore.remove_contact implementations of a #GDataContactsSync store. Changes made locally to an indexed contact aren't noticed
+ * until it's added again.
+ *
+ * <example>
+ *	<title>Finding Duplicates Across Accounts</title>
+ *	<programlisting>
+ *	GDataContactsMergeIndex *index;
+ *	GList *sets, *i;
+ *
+ *	index = gdata_contacts_merge_index_new ();
+ *	gdata_contacts_merge_index_add_feed (index, work_contacts_feed);
+ *	gdata_contacts_merge_index_add_feed (index, personal_contacts_feed);
+ *
+ *	sets = gdata_contacts_merge_index_get_duplicate_sets (index);
+ *
+ *	for (i = sets; i != NULL; i = i->next) {
+ *		GList *duplicates = i->data;
+ *
+ *		/<!-- -->* Merge the contacts in duplicates *<!-- -->/
+ *	}
+ *
+ *	g_list_free_full (sets, (GDestroyNotify) g_list_free);
+ *	g_object_unref (index);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <string.h>
+
+#include "gdata-contacts-merge-index.h"
+
+/* Phone numbers are matched on this many of their last digits, and ignored if they have fewer than MIN_PHONE_DIGITS */
+#define PHONE_SUFFIX_DIGITS 10
+#define MIN_PHONE_DIGITS 7
+
+static void gdata_contacts_merge_index_finalize (GObject *object);
+
+typedef struct {
+	GDataContactsContact *contact; /* reffed */
+	GPtrArray *keys; /* the contact's match keys (owned); see get_match_keys() */
+} IndexedContact;
+
+struct _GDataContactsMergeIndexPrivate {
+	GHashTable *contacts; /* contact ID (owned) → IndexedContact (owned) */
+	GHashTable *keys; /* match key (owned) → GHashTable set of the IndexedContacts with that key (not owned; ->contacts owns them) */
+};
+
+G_DEFINE_TYPE (GDataContactsMergeIndex, gdata_contacts_merge_index, G_TYPE_OBJECT)
+
+static void
+gdata_contacts_merge_index_class_init (GDataContactsMergeIndexClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataContactsMergeIndexPrivate));
+
+	gobject_class->finalize = gdata_contacts_merge_index_finalize;
+}
+
+static void
+indexed_contact_free (IndexedContact *indexed)
+{
+	g_object_unref (indexed->contact);
+	g_ptr_array_unref (indexed->keys);
+	g_slice_free (IndexedContact, indexed);
+}
+
+static void
+gdata_contacts_merge_index_init (GDataContactsMergeIndex *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CONTACTS_MERGE_INDEX, GDataContactsMergeIndexPrivate);
+
+	self->priv->contacts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) indexed_contact_free);
+	self->priv->keys = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+}
+
+static void
+gdata_contacts_merge_index_finalize (GObject *object)
+{
+	GDataContactsMergeIndexPrivate *priv = GDATA_CONTACTS_MERGE_INDEX (object)->priv;
+
+	/* Destroy the key sets first, since they point into the IndexedContacts */
+	g_hash_table_destroy (priv->keys);
+	g_hash_table_destroy (priv->contacts);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_contacts_merge_index_parent_class)->finalize (object);
+}
+
+/**
+ * gdata_contacts_merge_index_new:
+ *
+ * Creates a new, empty #GDataContactsMergeIndex.
+ *
+ * Return value: (transfer full): a new #GDataContactsMergeIndex; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataContactsMergeIndex *
+gdata_contacts_merge_index_new (void)
+{
+	return g_object_new (GDATA_TYPE_CONTACTS_MERGE_INDEX, NULL);
+}
+
+/* Returns the match key for @address, or %NULL if it isn't a valid address */
+static gchar *
+get_email_key (const gchar *address)
+{
+	gchar *normalised, *at, *key;
+	GString *local_part;
+	const gchar *i;
+
+	normalised = g_utf8_strdown (address, -1);
+	g_strstrip (normalised);
+
+	at = strrchr (normalised, '@');
+	if (at == NULL || at == normalised || at[1] == '\0') {
+		g_free (normalised);
+		return NULL;
+	}
+
+	*at = '\0';
+
+	if (strcmp (at + 1, "gmail.com") != 0 && strcmp (at + 1, "googlemail.com") != 0) {
+		key = g_strdup_printf ("email:%s@%s", normalised, at + 1);
+		g_free (normalised);
+		return key;
+	}
+
+	/* Gmail ignores dots in the local part, and anything after a '+' */
+	local_part = g_string_sized_new (at - normalised);
+	for (i = normalised; *i != '\0' && *i != '+'; i++) {
+		if (*i != '.')
+			g_string_append_c (local_part, *i);
+	}
+
+	key = (local_part->len > 0) ? g_strdup_printf ("email:%s@gmail.com", local_part->str) : NULL;
+
+	g_string_free (local_part, TRUE);
+	g_free (normalised);
+
+	return key;
+}
+
+/* Returns the match key for @phone_number, or %NULL if it has too few digits. The tel: URI is preferred if there is one, since it's been
+ * normalised by the server. Digits after an extension or parameter are ignored. */
+static gchar *
+get_phone_key (GDataGDPhoneNumber *phone_number)
+{
+	const gchar *number, *uri, *i;
+	gchar digits[PHONE_SUFFIX_DIGITS + 1];
+	guint n_digits = 0;
+
+	uri = gdata_gd_phone_number_get_uri (phone_number);
+	if (uri != NULL && g_ascii_strncasecmp (uri, "tel:", 4) == 0)
+		number = uri + 4;
+	else
+		number = gdata_gd_phone_number_get_number (phone_number);
+
+	if (number == NULL)
+		return NULL;
+
+	/* Keep the last PHONE_SUFFIX_DIGITS digits in a ring buffer */
+	for (i = number; *i != '\0' && *i != ';' && *i != ',' && g_ascii_isalpha (*i) == FALSE; i++) {
+		if (g_ascii_isdigit (*i) == TRUE)
+			digits[n_digits++ % PHONE_SUFFIX_DIGITS] = *i;
+	}
+
+	if (n_digits < MIN_PHONE_DIGITS) {
+		return NULL;
+	} else if (n_digits <= PHONE_SUFFIX_DIGITS) {
+		digits[n_digits] = '\0';
+		return g_strdup_printf ("phone:%s", digits);
+	} else {
+		gchar suffix[PHONE_SUFFIX_DIGITS + 1];
+		guint j;
+
+		for (j = 0; j < PHONE_SUFFIX_DIGITS; j++)
+			suffix[j] = digits[(n_digits + j) % PHONE_SUFFIX_DIGITS];
+		suffix[PHONE_SUFFIX_DIGITS] = '\0';
+
+		return g_strdup_printf ("phone:%s", suffix);
+	}
+}
+
+static void
+add_key (GPtrArray *keys, gchar *key)
+{
+	guint i;
+
+	if (key == NULL)
+		return;
+
+	/* Contacts have few enough addresses that a linear search is fine */
+	for (i = 0; i < keys->len; i++) {
+		if (strcmp (g_ptr_array_index (keys, i), key) == 0) {
+			g_free (key);
+			return;
+		}
+	}
+
+	g_ptr_array_add (keys, key);
+}
+
+/* Returns the distinct match keys of @contact's e-mail addresses and phone numbers */
+static GPtrArray *
+get_match_keys (GDataContactsContact *contact)
+{
+	GPtrArray *keys;
+	GList *i;
+
+	keys = g_ptr_array_new_with_free_func (g_free);
+
+	for (i = gdata_contacts_contact_get_email_addresses (contact); i != NULL; i = i->next) {
+		const gchar *address = gdata_gd_email_address_get_address (GDATA_GD_EMAIL_ADDRESS (i->data));
+
+		if (address != NULL)
+			add_key (keys, get_email_key (address));
+	}
+
+	for (i = gdata_contacts_contact_get_phone_numbers (contact); i != NULL; i = i->next)
+		add_key (keys, get_phone_key (GDATA_GD_PHONE_NUMBER (i->data)));
+
+	return keys;
+}
+
+static void
+unindex_contact (GDataContactsMergeIndex *self, const gchar *contact_id)
+{
+	IndexedContact *indexed;
+	guint i;
+
+	indexed = g_hash_table_lookup (self->priv->contacts, contact_id);
+	if (indexed == NULL)
+		return;
+
+	for (i = 0; i < indexed->keys->len; i++) {
+		const gchar *key = g_ptr_array_index (indexed->keys, i);
+		GHashTable *contacts = g_hash_table_lookup (self->priv->keys, key);
+
+		g_hash_table_remove (contacts, indexed);
+
+		/* Don't keep keys which no contact has any more, or the index would grow without bound as addresses change */
+		if (g_hash_table_size (contacts) == 0)
+			g_hash_table_remove (self->priv->keys, key);
+	}
+
+	g_hash_table_remove (self->priv->contacts, contact_id);
+}
+
+/**
+ * gdata_contacts_merge_index_add_feed:
+ * @self: a #GDataContactsMergeIndex
+ * @feed: a #GDataFeed of #GDataContactsContact<!-- -->s
+ *
+ * Adds all the #GDataContactsContact<!-- -->s in @feed to the index, as by gdata_contacts_merge_index_add_contact(), except that contacts which have
+ * been deleted (see gdata_contacts_contact_is_deleted()) are removed from it. This means the feeds returned by queries with
+ * #GDataQuery:updated-min and #GDataContactsQuery:show-deleted set can be applied to the index directly. Any other entries in @feed are ignored.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_merge_index_add_feed (GDataContactsMergeIndex *self, GDataFeed *feed)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_MERGE_INDEX (self));
+	g_return_if_fail (GDATA_IS_FEED (feed));
+
+	for (i = gdata_feed_get_entries (feed); i != NULL; i = i->next) {
+		GDataContactsContact *contact;
+
+		if (GDATA_IS_CONTACTS_CONTACT (i->data) == FALSE)
+			continue;
+
+		contact = GDATA_CONTACTS_CONTACT (i->data);
+
+		if (gdata_contacts_contact_is_deleted (contact) == TRUE)
+			gdata_contacts_merge_index_remove_contact (self, gdata_entry_get_id (GDATA_ENTRY (contact)));
+		else
+			gdata_contacts_merge_index_add_contact (self, contact);
+	}
+}
+
+/**
+ * gdata_contacts_merge_index_add_contact:
+ * @self: a #GDataContactsMergeIndex
+ * @contact: a #GDataContactsContact to index
+ *
+ * Adds @contact to the index under its e-mail addresses and phone numbers. If a contact with the same ID is already in the index, it's replaced by
+ * @contact. @contact is reffed until it's removed from the index (or replaced, or the index is destroyed).
+ *
+ * @contact must have an ID, so must have been retrieved from (or inserted on) the server.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_merge_index_add_contact (GDataContactsMergeIndex *self, GDataContactsContact *contact)
+{
+	IndexedContact *indexed;
+	const gchar *contact_id;
+	guint i;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_MERGE_INDEX (self));
+	g_return_if_fail (GDATA_IS_CONTACTS_CONTACT (contact));
+
+	contact_id = gdata_entry_get_id (GDATA_ENTRY (contact));
+	g_return_if_fail (contact_id != NULL);
+
+	unindex_contact (self, contact_id);
+
+	indexed = g_slice_new (IndexedContact);
+	indexed->contact = g_object_ref (contact);
+	indexed->keys = get_match_keys (contact);
+
+	g_hash_table_insert (self->priv->contacts, g_strdup (contact_id), indexed);
+
+	for (i = 0; i < indexed->keys->len; i++) {
+		const gchar *key = g_ptr_array_index (indexed->keys, i);
+		GHashTable *contacts = g_hash_table_lookup (self->priv->keys, key);
+
+		if (contacts == NULL) {
+			contacts = g_hash_table_new (g_direct_hash, g_direct_equal);
+			g_hash_table_insert (self->priv->keys, g_strdup (key), contacts);
+		}
+
+		g_hash_table_add (contacts, indexed);
+	}
+}
+
+/**
+ * gdata_contacts_merge_index_remove_contact:
+ * @self: a #GDataContactsMergeIndex
+ * @contact_id: the ID of the contact to remove from the index
+ *
+ * Removes the contact with ID @contact_id from the index, so that it's no longer considered a duplicate of any other contact. Removing a contact which
+ * isn't in the index does nothing.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_merge_index_remove_contact (GDataContactsMergeIndex *self, const gchar *contact_id)
+{
+	g_return_if_fail (GDATA_IS_CONTACTS_MERGE_INDEX (self));
+	g_return_if_fail (contact_id != NULL);
+
+	unindex_contact (self, contact_id);
+}
+
+/**
+ * gdata_contacts_merge_index_get_n_contacts:
+ * @self: a #GDataContactsMergeIndex
+ *
+ * Gets the number of contacts in the index.
+ *
+ * Return value: the number of indexed contacts
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_contacts_merge_index_get_n_contacts (GDataContactsMergeIndex *self)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_MERGE_INDEX (self), 0);
+
+	return g_hash_table_size (self->priv->contacts);
+}
+
+/* Returns all the contacts which are transitively duplicates of @start, including @start itself, marking them in @visited_contacts. This is a
+ * breadth-first search of the graph of contacts and match keys; each key's contacts are only listed once, so the search takes time linear in the
+ * size of the set it returns. */
+static GList *
+collect_duplicates (GDataContactsMergeIndex *self, IndexedContact *start, GHashTable *visited_contacts)
+{
+	GHashTable *visited_keys;
+	GQueue queue = G_QUEUE_INIT;
+	IndexedContact *indexed;
+	GList *duplicates = NULL;
+
+	visited_keys = g_hash_table_new (g_str_hash, g_str_equal);
+
+	g_hash_table_add (visited_contacts, start);
+	g_queue_push_tail (&queue, start);
+
+	while ((indexed = g_queue_pop_head (&queue)) != NULL) {
+		guint i;
+
+		duplicates = g_list_prepend (duplicates, indexed->contact);
+
+		for (i = 0; i < indexed->keys->len; i++) {
+			gchar *key = g_ptr_array_index (indexed->keys, i);
+			GHashTableIter iter;
+			IndexedContact *other;
+
+			if (g_hash_table_contains (visited_keys, key) == TRUE)
+				continue;
+			g_hash_table_add (visited_keys, key);
+
+			g_hash_table_iter_init (&iter, g_hash_table_lookup (self->priv->keys, key));
+			while (g_hash_table_iter_next (&iter, (gpointer*) &other, NULL) == TRUE) {
+				if (g_hash_table_contains (visited_contacts, other) == FALSE) {
+					g_hash_table_add (visited_contacts, other);
+					g_queue_push_tail (&queue, other);
+				}
+			}
+		}
+	}
+
+	g_hash_table_destroy (visited_keys);
+
+	return duplicates;
+}
+
+/**
+ * gdata_contacts_merge_index_get_duplicates:
+ * @self: a #GDataContactsMergeIndex
+ * @contact: an indexed #GDataContactsContact
+ *
+ * Gets the indexed contacts which are likely to be the same person as @contact, in no particular order. @contact is matched by its ID, and isn't
+ * itself included in the list.
+ *
+ * Return value: (element-type GData.ContactsContact) (transfer container): a #GList of @contact's duplicates, or %NULL; free with g_list_free()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_contacts_merge_index_get_duplicates (GDataContactsMergeIndex *self, GDataContactsContact *contact)
+{
+	IndexedContact *indexed;
+	GHashTable *visited;
+	GList *duplicates;
+	const gchar *contact_id;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_MERGE_INDEX (self), NULL);
+	g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (contact), NULL);
+
+	contact_id = gdata_entry_get_id (GDATA_ENTRY (contact));
+	indexed = (contact_id != NULL) ? g_hash_table_lookup (self->priv->contacts, contact_id) : NULL;
+
+	if (indexed == NULL)
+		return NULL;
+
+	visited = g_hash_table_new (g_direct_hash, g_direct_equal);
+	duplicates = collect_duplicates (self, indexed, visited);
+	g_hash_table_destroy (visited);
+
+	return g_list_remove (duplicates, indexed->contact);
+}
+
+/**
+ * gdata_contacts_merge_index_get_duplicate_sets:
+ * @self: a #GDataContactsMergeIndex
+ *
+ * Groups all the indexed contacts which are likely to be the same person. Each set of duplicates is returned as a #GList of at least two
+ * #GDataContactsContact<!-- -->s; contacts with no duplicates aren't returned. The sets, and the contacts within them, are in no particular order.
+ *
+ * Return value: (element-type GLib.List) (transfer full): a #GList of the sets of duplicates, or %NULL; free with
+ * <literal>g_list_free_full (sets, (GDestroyNotify) g_list_free)</literal>
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_contacts_merge_index_get_duplicate_sets (GDataContactsMergeIndex *self)
+{
+	GHashTable *visited;
+	GHashTableIter iter;
+	IndexedContact *indexed;
+	GList *sets = NULL;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_MERGE_INDEX (self), NULL);
+
+	visited = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	g_hash_table_iter_init (&iter, self->priv->contacts);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &indexed) == TRUE) {
+		GList *duplicates;
+
+		if (g_hash_table_contains (visited, indexed) == TRUE)
+			continue;
+
+		duplicates = collect_duplicates (self, indexed, visited);
+
+		if (duplicates->next != NULL)
+			sets = g_list_prepend (sets, duplicates);
+		else
+			g_list_free (duplicates);
+	}
+
+	g_hash_table_destroy (visited);
+
+	return sets;
+}
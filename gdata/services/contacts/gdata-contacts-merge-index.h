@@ -0,0 +1,78 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_CONTACTS_MERGE_INDEX_H
+#define GDATA_CONTACTS_MERGE_INDEX_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gdata/gdata-feed.h>
+#include <gdata/services/contacts/gdata-contacts-contact.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_CONTACTS_MERGE_INDEX			(gdata_contacts_merge_index_get_type ())
+#define GDATA_CONTACTS_MERGE_INDEX(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CONTACTS_MERGE_INDEX, GDataContactsMergeIndex))
+#define GDATA_CONTACTS_MERGE_INDEX_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CONTACTS_MERGE_INDEX, GDataContactsMergeIndexClass))
+#define GDATA_IS_CONTACTS_MERGE_INDEX(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CONTACTS_MERGE_INDEX))
+#define GDATA_IS_CONTACTS_MERGE_INDEX_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_CONTACTS_MERGE_INDEX))
+#define GDATA_CONTACTS_MERGE_INDEX_GET_CLASS(o)		(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_CONTACTS_MERGE_INDEX, GDataContactsMergeIndexClass))
+
+typedef struct _GDataContactsMergeIndexPrivate	GDataContactsMergeIndexPrivate;
+
+/**
+ * GDataContactsMergeIndex:
+ *
+ * All the fields in the #GDataContactsMergeIndex structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataContactsMergeIndexPrivate *priv;
+} GDataContactsMergeIndex;
+
+/**
+ * GDataContactsMergeIndexClass:
+ *
+ * All the fields in the #GDataContactsMergeIndexClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataContactsMergeIndexClass;
+
+GType gdata_contacts_merge_index_get_type (void) G_GNUC_CONST;
+
+GDataContactsMergeIndex *gdata_contacts_merge_index_new (void) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+void gdata_contacts_merge_index_add_feed (GDataContactsMergeIndex *self, GDataFeed *feed);
+void gdata_contacts_merge_index_add_contact (GDataContactsMergeIndex *self, GDataContactsContact *contact);
+void gdata_contacts_merge_index_remove_contact (GDataContactsMergeIndex *self, const gchar *contact_id);
+guint gdata_contacts_merge_index_get_n_contacts (GDataContactsMergeIndex *self);
+
+GList *gdata_contacts_merge_index_get_duplicates (GDataContactsMergeIndex *self, GDataContactsContact *contact) G_GNUC_WARN_UNUSED_RESULT;
+GList *gdata_contacts_merge_index_get_duplicate_sets (GDataContactsMergeIndex *self) G_GNUC_WARN_UNUSED_RESULT;
+
+G_END_DECLS
+
+#endif /* !GDATA_CONTACTS_MERGE_INDEX_H */
@@ -152,12 +152,45 @@
 #include <string.h>
 
 #include "gdata-contacts-service.h"
+#include "gdata-contacts-contact-summary.h"
 #include "gdata-batchable.h"
 #include "gdata-service.h"
 #include "gdata-private.h"
 #include "gdata-query.h"
 
+static void gdata_contacts_service_finalize (GObject *object);
 static GList *get_authorization_domains (void);
+static gsize photo_cache_get_size (gpointer cache, guint *n_items);
+static gint64 photo_cache_get_oldest_use (gpointer cache);
+static gsize photo_cache_evict_oldest (gpointer cache);
+
+/* Entry in the photo cache. The memory cache maps contact IDs to the GList links of their PhotoCacheEntrys in photo_cache_lru, which is kept in
+ * most-recently-used-first order so that the least recently used entries can be evicted from its tail. The disk cache is a directory of files named
+ * after the checksums of the contact IDs, each holding the photo's ETag and content type on a line each, followed by the photo data. */
+typedef struct {
+	gchar *contact_id;
+	gchar *etag;
+	gchar *content_type;
+	guint8 *data;
+	gsize length;
+	gint64 last_used; /* monotonic time */
+} PhotoCacheEntry;
+
+struct _GDataContactsServicePrivate {
+	GMutex photo_cache_mutex; /* protects all the photo_cache_* members */
+	GHashTable *photo_cache;
+	GQueue photo_cache_lru;
+	gsize photo_cache_size;
+	gsize photo_cache_limit;
+	gchar *photo_cache_directory;
+	GDataCacheRegistration *photo_cache_registration;
+};
+
+static const GDataCacheFuncs photo_cache_funcs = {
+	photo_cache_get_size,
+	photo_cache_get_oldest_use,
+	photo_cache_evict_oldest,
+};
 
 _GDATA_DEFINE_AUTHORIZATION_DOMAIN (contacts, "cp", "https://www.google.com/m8/feeds/")
 G_DEFINE_TYPE_WITH_CODE (GDataContactsService, gdata_contacts_service, GDATA_TYPE_SERVICE,
@@ -166,7 +199,13 @@ G_DEFINE_TYPE_WITH_CODE (GDataContactsService, gdata_contacts_service, GDATA_TYP
 static void
 gdata_contacts_service_class_init (GDataContactsServiceClass *klass)
 {
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 	GDataServiceClass *service_class = GDATA_SERVICE_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataContactsServicePrivate));
+
+	gobject_class->finalize = gdata_contacts_service_finalize;
+
 	service_class->api_version = "3";
 	service_class->get_authorization_domains = get_authorization_domains;
 }
@@ -174,7 +213,41 @@ gdata_contacts_service_class_init (GDataContactsServiceClass *klass)
 static void
 gdata_contacts_service_init (GDataContactsService *self)
 {
-	/* Nothing to see here */
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CONTACTS_SERVICE, GDataContactsServicePrivate);
+
+	g_mutex_init (&(self->priv->photo_cache_mutex));
+	self->priv->photo_cache = g_hash_table_new (g_str_hash, g_str_equal);
+	g_queue_init (&(self->priv->photo_cache_lru));
+	self->priv->photo_cache_registration = _gdata_cache_manager_register ("GDataContactsService:photo-cache", GDATA_CACHE_PRIORITY_NORMAL,
+	                                                                      &photo_cache_funcs, self);
+}
+
+static void
+photo_cache_entry_free (PhotoCacheEntry *entry)
+{
+	g_free (entry->contact_id);
+	g_free (entry->etag);
+	g_free (entry->content_type);
+	g_free (entry->data);
+	g_slice_free (PhotoCacheEntry, entry);
+}
+
+static void
+gdata_contacts_service_finalize (GObject *object)
+{
+	GDataContactsServicePrivate *priv = GDATA_CONTACTS_SERVICE (object)->priv;
+	PhotoCacheEntry *entry;
+
+	_gdata_cache_manager_unregister (priv->photo_cache_registration);
+
+	while ((entry = g_queue_pop_head (&(priv->photo_cache_lru))) != NULL)
+		photo_cache_entry_free (entry);
+	g_hash_table_destroy (priv->photo_cache);
+	g_free (priv->photo_cache_directory);
+	g_mutex_clear (&(priv->photo_cache_mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_contacts_service_parent_class)->finalize (object);
 }
 
 static GList *
@@ -319,6 +392,129 @@ gdata_contacts_service_query_contacts_async (GDataContactsService *self, GDataQu
 	g_free (request_uri);
 }
 
+/* The partial response selector used by gdata_contacts_service_query_contact_summaries(). It keeps the feed elements needed for pagination plus
+ * everything GDataContactsContactSummary parses, and drops everything else. */
+#define CONTACT_SUMMARY_FIELDS \
+	"id,updated,link,openSearch:totalResults,openSearch:startIndex,openSearch:itemsPerPage," \
+	"entry(@gd:etag,id,updated,title,gd:name(gd:fullName),gd:email,link[@rel='http://schemas.google.com/contacts/2008/rel#photo'])"
+
+static gchar *
+build_contact_summaries_uri (void)
+{
+	gchar *fields, *request_uri;
+
+	fields = g_uri_escape_string (CONTACT_SUMMARY_FIELDS, NULL, FALSE);
+	request_uri = g_strconcat (_gdata_service_get_scheme (), "://www.google.com/m8/feeds/contacts/default/full?fields=", fields, NULL);
+	g_free (fields);
+
+	return request_uri;
+}
+
+/**
+ * gdata_contacts_service_query_contact_summaries:
+ * @self: a #GDataContactsService
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @progress_callback: (allow-none) (scope call) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
+ * @progress_user_data: (closure): data to pass to the @progress_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Queries the service to return a lightweight summary of each contact matching the given @query. This behaves as
+ * gdata_contacts_service_query_contacts(), but only the contacts' IDs, ETags, full names, primary e-mail addresses and photo ETags are requested
+ * from the server, and the feed contains #GDataContactsContactSummary<!-- -->s rather than #GDataContactsContact<!-- -->s. This is considerably
+ * cheaper to download and parse for large address books.
+ *
+ * The server-side projection is set using the <ulink type="http" url="https://developers.google.com/gdata/docs/2.0/reference#PartialResponse">
+ * partial response</ulink> <literal>fields</literal> parameter, so @query must not have its own #GDataQuery:fields set.
+ *
+ * For more details, see gdata_service_query().
+ *
+ * Return value: (transfer full): a #GDataFeed of #GDataContactsContactSummary<!-- -->s; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataFeed *
+gdata_contacts_service_query_contact_summaries (GDataContactsService *self, GDataQuery *query, GCancellable *cancellable,
+                                                GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error)
+{
+	GDataFeed *feed;
+	gchar *request_uri;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (self), NULL);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), NULL);
+	g_return_val_if_fail (query == NULL || gdata_query_get_fields (query) == NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (self)),
+	                                               get_contacts_authorization_domain ()) == FALSE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+		                     _("You must be authenticated to query contacts."));
+		return NULL;
+	}
+
+	request_uri = build_contact_summaries_uri ();
+	feed = gdata_service_query (GDATA_SERVICE (self), get_contacts_authorization_domain (), request_uri, GDATA_QUERY (query),
+	                            GDATA_TYPE_CONTACTS_CONTACT_SUMMARY, cancellable, progress_callback, progress_user_data, error);
+	g_free (request_uri);
+
+	return feed;
+}
+
+/**
+ * gdata_contacts_service_query_contact_summaries_async:
+ * @self: a #GDataContactsService
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @progress_callback: (allow-none) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
+ * @progress_user_data: (closure): data to pass to the @progress_callback function
+ * @destroy_progress_user_data: (allow-none): the function to call when @progress_callback will not be called any more, or %NULL. This function will be
+ * called with @progress_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the query is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Queries the service to return a lightweight summary of each contact matching the given @query. @self and
+ * @query are all reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_contacts_service_query_contact_summaries(), which is the synchronous version of this function,
+ * and gdata_service_query_async(), which is the base asynchronous query function.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_service_query_contact_summaries_async (GDataContactsService *self, GDataQuery *query, GCancellable *cancellable,
+                                                      GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                                                      GDestroyNotify destroy_progress_user_data,
+                                                      GAsyncReadyCallback callback, gpointer user_data)
+{
+	gchar *request_uri;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_SERVICE (self));
+	g_return_if_fail (query == NULL || GDATA_IS_QUERY (query));
+	g_return_if_fail (query == NULL || gdata_query_get_fields (query) == NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (self)),
+	                                               get_contacts_authorization_domain ()) == FALSE) {
+		GSimpleAsyncResult *result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_async);
+		g_simple_async_result_set_error (result, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED, "%s",
+		                                 _("You must be authenticated to query contacts."));
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+
+		return;
+	}
+
+	request_uri = build_contact_summaries_uri ();
+	gdata_service_query_async (GDATA_SERVICE (self), get_contacts_authorization_domain (), request_uri, GDATA_QUERY (query),
+	                           GDATA_TYPE_CONTACTS_CONTACT_SUMMARY, cancellable, progress_callback, progress_user_data,
+	                           destroy_progress_user_data, callback, user_data);
+	g_free (request_uri);
+}
+
 /**
  * gdata_contacts_service_insert_contact:
  * @self: a #GDataContactsService
@@ -564,3 +760,1047 @@ gdata_contacts_service_insert_group_async (GDataContactsService *self, GDataCont
 	                                  callback, user_data);
 	g_free (request_uri);
 }
+
+/* Data shared by all the operations in a batched insertion, update or deletion of contacts. It's attached to the GDataBatchOperation, so lives as
+ * long as it does. */
+typedef struct _BatchData BatchData;
+
+typedef struct {
+	BatchData *data;
+	guint index;
+	GDataContactsContact *contact;
+} BatchItem;
+
+struct _BatchData {
+	GDataContactsServiceBatchCallback callback;
+	gpointer user_data;
+	GDestroyNotify destroy_user_data;
+	guint n_items;
+	BatchItem *items; /* one per input contact */
+};
+
+static void
+batch_data_free (BatchData *data)
+{
+	guint i;
+
+	for (i = 0; i < data->n_items; i++)
+		g_object_unref (data->items[i].contact);
+	g_free (data->items);
+
+	if (data->destroy_user_data != NULL)
+		data->destroy_user_data (data->user_data);
+
+	g_slice_free (BatchData, data);
+}
+
+static void
+batch_operation_cb (guint operation_id, GDataBatchOperationType operation_type, GDataEntry *entry, GError *error, BatchItem *item)
+{
+	item->data->callback (item->index, item->contact, (entry != NULL) ? GDATA_CONTACTS_CONTACT (entry) : NULL, error, item->data->user_data);
+}
+
+/* Builds a batch operation against the contacts batch feed to perform @operation_type on each of @contacts */
+static GDataBatchOperation *
+create_contacts_batch_operation (GDataContactsService *self, GDataBatchOperationType operation_type, GList *contacts,
+                                 GDataContactsServiceBatchCallback callback, gpointer user_data, GDestroyNotify destroy_user_data)
+{
+	GDataBatchOperation *operation;
+	BatchData *data;
+	GList *i;
+	gchar *feed_uri;
+	guint j;
+
+	feed_uri = g_strconcat (_gdata_service_get_scheme (), "://www.google.com/m8/feeds/contacts/default/full/batch", NULL);
+	operation = gdata_batchable_create_operation (GDATA_BATCHABLE (self), get_contacts_authorization_domain (), feed_uri);
+	g_free (feed_uri);
+
+	/* The batch operation splits the contacts into server-sized requests itself; send as many of them at once as we have connections for */
+	gdata_batch_operation_set_max_operations_per_request (operation, GDATA_BATCH_MAX_OPERATIONS_PER_REQUEST);
+	gdata_batch_operation_set_max_concurrent_requests (operation, MAX (gdata_service_get_max_connections_per_host (GDATA_SERVICE (self)), 1));
+
+	data = g_slice_new0 (BatchData);
+	data->callback = callback;
+	data->user_data = user_data;
+	data->destroy_user_data = destroy_user_data;
+	data->n_items = g_list_length (contacts);
+	data->items = g_new (BatchItem, data->n_items);
+	g_object_set_data_full (G_OBJECT (operation), "contacts-batch-data", data, (GDestroyNotify) batch_data_free);
+
+	for (i = contacts, j = 0; i != NULL; i = i->next, j++) {
+		BatchItem *item = &(data->items[j]);
+		GDataBatchOperationCallback item_callback = (callback != NULL) ? (GDataBatchOperationCallback) batch_operation_cb : NULL;
+
+		item->data = data;
+		item->index = j;
+		item->contact = g_object_ref (i->data);
+
+		switch (operation_type) {
+			case GDATA_BATCH_OPERATION_INSERTION:
+				gdata_batch_operation_add_insertion (operation, GDATA_ENTRY (i->data), item_callback, item);
+				break;
+			case GDATA_BATCH_OPERATION_UPDATE:
+				gdata_batch_operation_add_update (operation, GDATA_ENTRY (i->data), item_callback, item);
+				break;
+			case GDATA_BATCH_OPERATION_DELETION:
+				gdata_batch_operation_add_deletion (operation, GDATA_ENTRY (i->data), item_callback, item);
+				break;
+			case GDATA_BATCH_OPERATION_QUERY:
+			default:
+				g_assert_not_reached ();
+		}
+	}
+
+	return operation;
+}
+
+static gboolean
+run_contacts_batch (GDataContactsService *self, GDataBatchOperationType operation_type, GList *contacts, GCancellable *cancellable,
+                    GDataContactsServiceBatchCallback callback, gpointer user_data, GError **error)
+{
+	GDataBatchOperation *operation;
+	gboolean success;
+
+	/* Nothing to do */
+	if (contacts == NULL)
+		return TRUE;
+
+	operation = create_contacts_batch_operation (self, operation_type, contacts, callback, user_data, NULL);
+	success = gdata_batch_operation_run (operation, cancellable, error);
+	g_object_unref (operation);
+
+	return success;
+}
+
+static void
+contacts_batch_run_cb (GDataBatchOperation *operation, GAsyncResult *async_result, GSimpleAsyncResult *result)
+{
+	GError *error = NULL;
+
+	if (gdata_batch_operation_run_finish (operation, async_result, &error) == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+
+	g_simple_async_result_complete (result);
+	g_object_unref (result);
+}
+
+static void
+run_contacts_batch_async (GDataContactsService *self, GDataBatchOperationType operation_type, GList *contacts, GCancellable *cancellable,
+                          GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data, GDestroyNotify destroy_batch_user_data,
+                          GAsyncReadyCallback callback, gpointer user_data, gpointer source_tag)
+{
+	GSimpleAsyncResult *result;
+	GDataBatchOperation *operation;
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, source_tag);
+
+	/* Nothing to do */
+	if (contacts == NULL) {
+		if (destroy_batch_user_data != NULL)
+			destroy_batch_user_data (batch_user_data);
+
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+		return;
+	}
+
+	operation = create_contacts_batch_operation (self, operation_type, contacts, batch_callback, batch_user_data, destroy_batch_user_data);
+	gdata_batch_operation_run_async (operation, cancellable, (GAsyncReadyCallback) contacts_batch_run_cb, result); /* transfer ref to result */
+	g_object_unref (operation);
+}
+
+static gboolean
+run_contacts_batch_finish (GDataContactsService *self, GAsyncResult *async_result, gpointer source_tag, GError **error)
+{
+	g_return_val_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), source_tag) == TRUE, FALSE);
+
+	return (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == FALSE);
+}
+
+/**
+ * gdata_contacts_service_insert_contacts:
+ * @self: a #GDataContactsService
+ * @contacts: (element-type GData.ContactsContact): a list of #GDataContactsContact<!-- -->s to insert
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (scope call) (closure batch_user_data): a #GDataContactsServiceBatchCallback to call when each contact has been
+ * inserted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Inserts all the contacts in @contacts using the contacts batch feed, as by gdata_batch_operation_add_insertion(). The contacts must not already
+ * exist on the server. The user must be authenticated to use this function.
+ *
+ * The contacts are split into as many batch requests as necessary (see #GDataBatchOperation:max-operations-per-request), up to
+ * #GDataService:max-connections-per-host of which are sent at once. @batch_callback is called for every contact, with its position in @contacts, with
+ * the inserted version of the contact as @result or with the error which occurred while processing it, in the order in which the server's responses
+ * arrive.
+ *
+ * As with gdata_batch_operation_run(), %FALSE is returned with @error set only if a batch request failed as a whole; the other contacts may still
+ * have been inserted, as reported to @batch_callback.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_service_insert_contacts (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                        GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = contacts; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (i->data), FALSE);
+
+	return run_contacts_batch (self, GDATA_BATCH_OPERATION_INSERTION, contacts, cancellable, batch_callback, batch_user_data, error);
+}
+
+/**
+ * gdata_contacts_service_insert_contacts_async:
+ * @self: a #GDataContactsService
+ * @contacts: (element-type GData.ContactsContact): a list of #GDataContactsContact<!-- -->s to insert
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (closure batch_user_data): a #GDataContactsServiceBatchCallback to call when each contact has
+ * been inserted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @destroy_batch_user_data: (allow-none): the function to call when @batch_callback will not be called any more, or %NULL. This function will
+ * be called with @batch_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Inserts all the contacts in @contacts asynchronously, calling @batch_callback for each in an idle function in the main thread. @self and
+ * @contacts are reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_contacts_service_insert_contacts(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_contacts_service_insert_contacts_finish() to get the results of
+ * the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_service_insert_contacts_async (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                              GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                              GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_SERVICE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = contacts; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_CONTACTS_CONTACT (i->data));
+
+	run_contacts_batch_async (self, GDATA_BATCH_OPERATION_INSERTION, contacts, cancellable, batch_callback, batch_user_data,
+	                          destroy_batch_user_data, callback, user_data, gdata_contacts_service_insert_contacts_async);
+}
+
+/**
+ * gdata_contacts_service_insert_contacts_finish:
+ * @self: a #GDataContactsService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous batched contact insertion operation started with gdata_contacts_service_insert_contacts_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_service_insert_contacts_finish (GDataContactsService *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return run_contacts_batch_finish (self, async_result, gdata_contacts_service_insert_contacts_async, error);
+}
+
+/**
+ * gdata_contacts_service_update_contacts:
+ * @self: a #GDataContactsService
+ * @contacts: (element-type GData.ContactsContact): a list of #GDataContactsContact<!-- -->s to update
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (scope call) (closure batch_user_data): a #GDataContactsServiceBatchCallback to call when each contact has been
+ * updated, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Updates all the contacts in @contacts using the contacts batch feed, as by gdata_batch_operation_add_update(). The contacts must already exist on
+ * the server, and have up-to-date ETags. The user must be authenticated to use this function.
+ *
+ * The contacts are split into as many batch requests as necessary (see #GDataBatchOperation:max-operations-per-request), up to
+ * #GDataService:max-connections-per-host of which are sent at once. @batch_callback is called for every contact, with its position in @contacts, with
+ * the updated version of the contact as @result or with the error which occurred while processing it, in the order in which the server's responses
+ * arrive.
+ *
+ * As with gdata_batch_operation_run(), %FALSE is returned with @error set only if a batch request failed as a whole; the other contacts may still
+ * have been updated, as reported to @batch_callback.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_service_update_contacts (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                        GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = contacts; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (i->data), FALSE);
+
+	return run_contacts_batch (self, GDATA_BATCH_OPERATION_UPDATE, contacts, cancellable, batch_callback, batch_user_data, error);
+}
+
+/**
+ * gdata_contacts_service_update_contacts_async:
+ * @self: a #GDataContactsService
+ * @contacts: (element-type GData.ContactsContact): a list of #GDataContactsContact<!-- -->s to update
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (closure batch_user_data): a #GDataContactsServiceBatchCallback to call when each contact has
+ * been updated, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @destroy_batch_user_data: (allow-none): the function to call when @batch_callback will not be called any more, or %NULL. This function will
+ * be called with @batch_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Updates all the contacts in @contacts asynchronously, calling @batch_callback for each in an idle function in the main thread. @self and
+ * @contacts are reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_contacts_service_update_contacts(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_contacts_service_update_contacts_finish() to get the results of
+ * the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_service_update_contacts_async (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                              GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                              GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_SERVICE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = contacts; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_CONTACTS_CONTACT (i->data));
+
+	run_contacts_batch_async (self, GDATA_BATCH_OPERATION_UPDATE, contacts, cancellable, batch_callback, batch_user_data,
+	                          destroy_batch_user_data, callback, user_data, gdata_contacts_service_update_contacts_async);
+}
+
+/**
+ * gdata_contacts_service_update_contacts_finish:
+ * @self: a #GDataContactsService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous batched contact update operation started with gdata_contacts_service_update_contacts_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_service_update_contacts_finish (GDataContactsService *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return run_contacts_batch_finish (self, async_result, gdata_contacts_service_update_contacts_async, error);
+}
+
+/**
+ * gdata_contacts_service_delete_contacts:
+ * @self: a #GDataContactsService
+ * @contacts: (element-type GData.ContactsContact): a list of #GDataContactsContact<!-- -->s to delete
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (scope call) (closure batch_user_data): a #GDataContactsServiceBatchCallback to call when each contact has been
+ * deleted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Deletes all the contacts in @contacts using the contacts batch feed, as by gdata_batch_operation_add_deletion(). The contacts must already exist on
+ * the server, and have up-to-date ETags. The user must be authenticated to use this function.
+ *
+ * The contacts are split into as many batch requests as necessary (see #GDataBatchOperation:max-operations-per-request), up to
+ * #GDataService:max-connections-per-host of which are sent at once. @batch_callback is called for every contact, with its position in @contacts, with
+ * a %NULL @result or with the error which occurred while processing it, in the order in which the server's responses arrive.
+ *
+ * As with gdata_batch_operation_run(), %FALSE is returned with @error set only if a batch request failed as a whole; the other contacts may still
+ * have been deleted, as reported to @batch_callback.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_service_delete_contacts (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                        GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = contacts; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (i->data), FALSE);
+
+	return run_contacts_batch (self, GDATA_BATCH_OPERATION_DELETION, contacts, cancellable, batch_callback, batch_user_data, error);
+}
+
+/**
+ * gdata_contacts_service_delete_contacts_async:
+ * @self: a #GDataContactsService
+ * @contacts: (element-type GData.ContactsContact): a list of #GDataContactsContact<!-- -->s to delete
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (closure batch_user_data): a #GDataContactsServiceBatchCallback to call when each contact has
+ * been deleted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @destroy_batch_user_data: (allow-none): the function to call when @batch_callback will not be called any more, or %NULL. This function will
+ * be called with @batch_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Deletes all the contacts in @contacts asynchronously, calling @batch_callback for each in an idle function in the main thread. @self and
+ * @contacts are reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_contacts_service_delete_contacts(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_contacts_service_delete_contacts_finish() to get the results of
+ * the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_service_delete_contacts_async (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                              GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                              GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_SERVICE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = contacts; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_CONTACTS_CONTACT (i->data));
+
+	run_contacts_batch_async (self, GDATA_BATCH_OPERATION_DELETION, contacts, cancellable, batch_callback, batch_user_data,
+	                          destroy_batch_user_data, callback, user_data, gdata_contacts_service_delete_contacts_async);
+}
+
+/**
+ * gdata_contacts_service_delete_contacts_finish:
+ * @self: a #GDataContactsService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous batched contact deletion operation started with gdata_contacts_service_delete_contacts_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_service_delete_contacts_finish (GDataContactsService *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return run_contacts_batch_finish (self, async_result, gdata_contacts_service_delete_contacts_async, error);
+}
+
+/* Must be called with the photo cache mutex held */
+static void
+photo_cache_remove_link_unlocked (GDataContactsService *self, GList *link)
+{
+	GDataContactsServicePrivate *priv = self->priv;
+	PhotoCacheEntry *entry = link->data;
+
+	g_hash_table_remove (priv->photo_cache, entry->contact_id);
+	g_queue_delete_link (&(priv->photo_cache_lru), link);
+	priv->photo_cache_size -= entry->length;
+	photo_cache_entry_free (entry);
+}
+
+/* Must be called with the photo cache mutex held */
+static void
+photo_cache_trim_unlocked (GDataContactsService *self)
+{
+	GDataContactsServicePrivate *priv = self->priv;
+
+	while (priv->photo_cache_size > priv->photo_cache_limit)
+		photo_cache_remove_link_unlocked (self, priv->photo_cache_lru.tail);
+}
+
+static gsize
+photo_cache_get_size (gpointer cache, guint *n_items)
+{
+	GDataContactsServicePrivate *priv = GDATA_CONTACTS_SERVICE (cache)->priv;
+	gsize n_bytes;
+
+	g_mutex_lock (&(priv->photo_cache_mutex));
+	n_bytes = priv->photo_cache_size;
+	if (n_items != NULL)
+		*n_items = priv->photo_cache_lru.length;
+	g_mutex_unlock (&(priv->photo_cache_mutex));
+
+	return n_bytes;
+}
+
+static gint64
+photo_cache_get_oldest_use (gpointer cache)
+{
+	GDataContactsServicePrivate *priv = GDATA_CONTACTS_SERVICE (cache)->priv;
+	gint64 last_used = G_MAXINT64;
+
+	g_mutex_lock (&(priv->photo_cache_mutex));
+	if (priv->photo_cache_lru.tail != NULL)
+		last_used = ((PhotoCacheEntry*) priv->photo_cache_lru.tail->data)->last_used;
+	g_mutex_unlock (&(priv->photo_cache_mutex));
+
+	return last_used;
+}
+
+static gsize
+photo_cache_evict_oldest (gpointer cache)
+{
+	GDataContactsService *self = GDATA_CONTACTS_SERVICE (cache);
+	GDataContactsServicePrivate *priv = self->priv;
+	gsize n_bytes = 0;
+
+	g_mutex_lock (&(priv->photo_cache_mutex));
+
+	if (priv->photo_cache_lru.tail != NULL) {
+		n_bytes = ((PhotoCacheEntry*) priv->photo_cache_lru.tail->data)->length;
+		photo_cache_remove_link_unlocked (self, priv->photo_cache_lru.tail);
+	}
+
+	g_mutex_unlock (&(priv->photo_cache_mutex));
+
+	return n_bytes;
+}
+
+/* Must be called with the photo cache mutex held. Replaces any photo already in the memory cache for @contact_id, since it must have an older
+ * ETag. */
+static void
+photo_cache_insert_unlocked (GDataContactsService *self, const gchar *contact_id, const gchar *etag, const gchar *content_type, const guint8 *data,
+                             gsize length)
+{
+	GDataContactsServicePrivate *priv = self->priv;
+	PhotoCacheEntry *entry;
+	GList *link;
+
+	link = g_hash_table_lookup (priv->photo_cache, contact_id);
+	if (link != NULL)
+		photo_cache_remove_link_unlocked (self, link);
+
+	if (length > priv->photo_cache_limit)
+		return;
+
+	entry = g_slice_new (PhotoCacheEntry);
+	entry->contact_id = g_strdup (contact_id);
+	entry->etag = g_strdup (etag);
+	entry->content_type = g_strdup (content_type);
+	entry->data = g_memdup (data, length);
+	entry->length = length;
+	entry->last_used = g_get_monotonic_time ();
+
+	g_queue_push_head (&(priv->photo_cache_lru), entry);
+	g_hash_table_insert (priv->photo_cache, entry->contact_id, priv->photo_cache_lru.head);
+	priv->photo_cache_size += length;
+
+	photo_cache_trim_unlocked (self);
+}
+
+/* Must be called with the photo cache mutex held. Returns %NULL if there is no disk cache. */
+static gchar *
+photo_cache_get_path_unlocked (GDataContactsService *self, const gchar *contact_id)
+{
+	gchar *checksum, *path;
+
+	if (self->priv->photo_cache_directory == NULL)
+		return NULL;
+
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, contact_id, -1);
+	path = g_build_filename (self->priv->photo_cache_directory, checksum, NULL);
+	g_free (checksum);
+
+	return path;
+}
+
+/*
+ * _gdata_contacts_service_look_up_photo:
+ * @self: a #GDataContactsService
+ * @contact_id: the ID of the contact whose photo is wanted
+ * @etag: the ETag of the wanted photo
+ * @length: return location for the image length, in bytes
+ * @content_type: (allow-none): return location for the image's content type, or %NULL
+ *
+ * Looks up the photo with the given @etag for the contact with ID @contact_id in @self's photo cache, checking the memory cache and then the disk
+ * cache. A photo with a different ETag is treated as a miss, since the contact's photo has changed since it was cached.
+ *
+ * Return value: a newly-allocated copy of the cached photo, or %NULL if it isn't cached; free with g_free()
+ */
+guint8 *
+_gdata_contacts_service_look_up_photo (GDataContactsService *self, const gchar *contact_id, const gchar *etag, gsize *length, gchar **content_type)
+{
+	GDataContactsServicePrivate *priv = self->priv;
+	GList *link;
+	gchar *path, *contents = NULL, *etag_end, *content_type_end;
+	gsize contents_length;
+	guint8 *data = NULL;
+
+	if (contact_id == NULL || etag == NULL)
+		return NULL;
+
+	g_mutex_lock (&(priv->photo_cache_mutex));
+
+	link = g_hash_table_lookup (priv->photo_cache, contact_id);
+	if (link != NULL && strcmp (((PhotoCacheEntry*) link->data)->etag, etag) == 0) {
+		PhotoCacheEntry *entry = link->data;
+
+		/* Mark the entry as the most recently used */
+		g_queue_unlink (&(priv->photo_cache_lru), link);
+		g_queue_push_head_link (&(priv->photo_cache_lru), link);
+		entry->last_used = g_get_monotonic_time ();
+
+		data = g_memdup (entry->data, entry->length);
+		*length = entry->length;
+		if (content_type != NULL)
+			*content_type = g_strdup (entry->content_type);
+
+		_gdata_cache_manager_record_lookup (priv->photo_cache_registration, TRUE);
+
+		g_mutex_unlock (&(priv->photo_cache_mutex));
+
+		return data;
+	}
+
+	if (priv->photo_cache_limit > 0)
+		_gdata_cache_manager_record_lookup (priv->photo_cache_registration, FALSE);
+
+	path = photo_cache_get_path_unlocked (self, contact_id);
+
+	g_mutex_unlock (&(priv->photo_cache_mutex));
+
+	if (path == NULL || g_file_get_contents (path, &contents, &contents_length, NULL) == FALSE) {
+		g_free (path);
+		return NULL;
+	}
+
+	g_free (path);
+
+	/* Parse the ETag and content type lines off the front of the file, and check the ETag is the one we want */
+	etag_end = memchr (contents, '\n', contents_length);
+	content_type_end = (etag_end != NULL) ? memchr (etag_end + 1, '\n', contents_length - (etag_end + 1 - contents)) : NULL;
+
+	if (content_type_end != NULL && (gsize) (etag_end - contents) == strlen (etag) && strncmp (contents, etag, etag_end - contents) == 0) {
+		*etag_end = '\0';
+		*content_type_end = '\0';
+
+		*length = contents_length - (content_type_end + 1 - contents);
+		data = g_memdup (content_type_end + 1, *length);
+		if (content_type != NULL)
+			*content_type = g_strdup (etag_end + 1);
+
+		g_mutex_lock (&(priv->photo_cache_mutex));
+		photo_cache_insert_unlocked (self, contact_id, etag, etag_end + 1, data, *length);
+		g_mutex_unlock (&(priv->photo_cache_mutex));
+
+		_gdata_cache_manager_cache_grown (priv->photo_cache_registration);
+	}
+
+	g_free (contents);
+
+	return data;
+}
+
+/*
+ * _gdata_contacts_service_cache_photo:
+ * @self: a #GDataContactsService
+ * @contact_id: the ID of the contact the photo belongs to
+ * @etag: the ETag of the photo
+ * @content_type: (allow-none): the photo's content type, or %NULL
+ * @data: the photo data
+ * @length: the length of @data, in bytes
+ *
+ * Stores a freshly-downloaded photo in @self's memory and disk caches, replacing any older photo for the same contact. Failures are ignored; the
+ * caches are only an optimisation.
+ */
+void
+_gdata_contacts_service_cache_photo (GDataContactsService *self, const gchar *contact_id, const gchar *etag, const gchar *content_type,
+                                     const guint8 *data, gsize length)
+{
+	GDataContactsServicePrivate *priv = self->priv;
+	gchar *path, *header;
+	GString *contents;
+
+	if (contact_id == NULL || etag == NULL || strchr (etag, '\n') != NULL || (content_type != NULL && strchr (content_type, '\n') != NULL))
+		return;
+
+	g_mutex_lock (&(priv->photo_cache_mutex));
+	photo_cache_insert_unlocked (self, contact_id, etag, content_type, data, length);
+	path = photo_cache_get_path_unlocked (self, contact_id);
+	g_mutex_unlock (&(priv->photo_cache_mutex));
+
+	_gdata_cache_manager_cache_grown (priv->photo_cache_registration);
+
+	if (path == NULL)
+		return;
+
+	header = g_strdup_printf ("%s\n%s\n", etag, (content_type != NULL) ? content_type : "");
+	contents = g_string_new (header);
+	g_string_append_len (contents, (const gchar*) data, length);
+	g_free (header);
+
+	if (g_file_set_contents (path, contents->str, contents->len, NULL) == FALSE)
+		g_debug ("Failed to store contact photo cache file '%s'.", path);
+
+	g_string_free (contents, TRUE);
+	g_free (path);
+}
+
+/* Returns whether either of the photo caches is enabled */
+static gboolean
+photo_cache_is_enabled (GDataContactsService *self)
+{
+	gboolean enabled;
+
+	g_mutex_lock (&(self->priv->photo_cache_mutex));
+	enabled = (self->priv->photo_cache_limit > 0 || self->priv->photo_cache_directory != NULL);
+	g_mutex_unlock (&(self->priv->photo_cache_mutex));
+
+	return enabled;
+}
+
+/**
+ * gdata_contacts_service_set_photo_cache:
+ * @self: a #GDataContactsService
+ * @directory: (allow-none): the directory in which to cache photos, or %NULL to not cache them on disk
+ * @memory_limit: the maximum total size of the photos to keep in memory, in bytes, or <code class="literal">0</code> to not cache them in memory
+ *
+ * Enables (or disables) caching of the contact photos downloaded with @self. Once enabled, gdata_contacts_contact_get_photo() and
+ * gdata_contacts_contact_get_photo_async() return a photo from the cache without making a request if its ETag matches the contact's
+ * #GDataContactsContact:photo-etag, and only download it if the contact's photo has changed since it was cached.
+ *
+ * Photos are kept in memory until their total size exceeds @memory_limit, at which point the least recently used are evicted. If @directory is
+ * non-%NULL, photos are also stored in it persistently, one file per contact (so a contact's old photo is replaced when their new one is cached).
+ * It will be created if it doesn't exist, and should be dedicated to the photo cache of a single account (for example, a subdirectory of
+ * g_get_user_cache_dir()).
+ *
+ * The cache is disabled by default.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_service_set_photo_cache (GDataContactsService *self, const gchar *directory, gsize memory_limit)
+{
+	GDataContactsServicePrivate *priv;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_SERVICE (self));
+
+	priv = self->priv;
+
+	if (directory != NULL)
+		g_mkdir_with_parents (directory, 0700);
+
+	g_mutex_lock (&(priv->photo_cache_mutex));
+
+	g_free (priv->photo_cache_directory);
+	priv->photo_cache_directory = g_strdup (directory);
+
+	priv->photo_cache_limit = memory_limit;
+	photo_cache_trim_unlocked (self);
+
+	g_mutex_unlock (&(priv->photo_cache_mutex));
+}
+
+typedef struct {
+	GDataContactsService *service;
+	GCancellable *cancellable;
+	GAsyncQueue *results; /* PhotoResults */
+} PrefetchPhotosData;
+
+typedef struct {
+	GDataContactsContact *contact;
+	GError *error;
+	GDataContactsServicePhotoCallback callback;
+	gpointer user_data;
+} PhotoResult;
+
+static void
+photo_result_free (PhotoResult *result)
+{
+	g_object_unref (result->contact);
+	if (result->error != NULL)
+		g_error_free (result->error);
+
+	g_slice_free (PhotoResult, result);
+}
+
+static void
+prefetch_photo_thread (GDataContactsContact *contact, PrefetchPhotosData *data)
+{
+	PhotoResult *result;
+
+	result = g_slice_new0 (PhotoResult);
+	result->contact = contact; /* transfer ref from the thread pool */
+
+	/* This only makes a request if the photo isn't already cached; either way, the photo ends up in the cache */
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &(result->error)) == FALSE) {
+		gsize length;
+
+		g_free (gdata_contacts_contact_get_photo (contact, data->service, &length, NULL, data->cancellable, &(result->error)));
+	}
+
+	g_async_queue_push (data->results, result);
+}
+
+/* Run the user-supplied callback for a contact's photo. This is designed to be used in an idle handler, so that the callback is run in the thread
+ * which started the prefetch. */
+static gboolean
+photo_result_callback_cb (PhotoResult *result)
+{
+	result->callback (result->contact, result->error, result->user_data);
+	return FALSE;
+}
+
+static gboolean
+prefetch_photos (GDataContactsService *self, GList *contacts, GCancellable *cancellable, GDataContactsServicePhotoCallback photo_callback,
+                 gpointer photo_user_data, GMainContext *context, gboolean is_async, GError **error)
+{
+	PrefetchPhotosData data;
+	GThreadPool *pool;
+	GList *i;
+	guint n_pending = 0;
+
+	/* Prefetching is pointless if there's nowhere to put the photos */
+	if (photo_cache_is_enabled (self) == FALSE)
+		return TRUE;
+
+	data.service = self;
+	data.cancellable = cancellable;
+	data.results = g_async_queue_new ();
+
+	/* All the photos are on the same host, so there's no point downloading more at once than the service has connections to it */
+	pool = g_thread_pool_new ((GFunc) prefetch_photo_thread, &data, MAX (gdata_service_get_max_connections_per_host (GDATA_SERVICE (self)), 1),
+	                          FALSE, NULL);
+
+	for (i = contacts; i != NULL; i = i->next) {
+		if (gdata_contacts_contact_get_photo_etag (i->data) == NULL)
+			continue;
+
+		g_thread_pool_push (pool, g_object_ref (i->data), NULL);
+		n_pending++;
+	}
+
+	/* Deliver the results as they arrive, dispatching the callbacks in the thread-default main context of the thread which started the prefetch
+	 * only if we were started with gdata_contacts_service_prefetch_photos_async(). */
+	for (; n_pending > 0; n_pending--) {
+		PhotoResult *result = g_async_queue_pop (data.results);
+
+		if (photo_callback == NULL) {
+			photo_result_free (result);
+			continue;
+		}
+
+		result->callback = photo_callback;
+		result->user_data = photo_user_data;
+
+		if (is_async == TRUE) {
+			_gdata_service_idle_add (context, (GSourceFunc) photo_result_callback_cb, result, (GDestroyNotify) photo_result_free);
+		} else {
+			photo_result_callback_cb (result);
+			photo_result_free (result);
+		}
+	}
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_async_queue_unref (data.results);
+
+	/* Errors for individual photos are reported to the callback; only cancellation of the whole operation is reported here */
+	return (g_cancellable_set_error_if_cancelled (cancellable, error) == FALSE);
+}
+
+/**
+ * gdata_contacts_service_prefetch_photos:
+ * @self: a #GDataContactsService
+ * @contacts: (element-type GData.ContactsContact): a list of #GDataContactsContact<!-- -->s whose photos should be cached
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @photo_callback: (allow-none) (scope call) (closure photo_user_data): a #GDataContactsServicePhotoCallback to call when each contact's photo
+ * has been cached, or %NULL
+ * @photo_user_data: (closure): data to pass to the @photo_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Fills @self's photo cache (see gdata_contacts_service_set_photo_cache()) with the photos of the #GDataContactsContact<!-- -->s in @contacts, so that
+ * later calls to gdata_contacts_contact_get_photo() for them don't have to make any requests. Only the photos which are missing from the cache (or
+ * whose ETags have changed) are downloaded, several at once (up to the #GDataService:max-connections-per-host of @self). Contacts without photos
+ * are skipped.
+ *
+ * @photo_callback is called for each contact with a photo, once it's in the cache or with the error which occurred while downloading it, in the
+ * order in which they finish. Errors for individual photos don't stop the others being downloaded, and aren't returned in @error. If @cancellable
+ * is cancelled, the remaining downloads are abandoned and %FALSE is returned with @error set.
+ *
+ * If the photo cache is disabled, this does nothing and returns %TRUE.
+ *
+ * Return value: %TRUE if all the photos were prefetched (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_service_prefetch_photos (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                        GDataContactsServicePhotoCallback photo_callback, gpointer photo_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = contacts; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_CONTACTS_CONTACT (i->data), FALSE);
+
+	return prefetch_photos (self, contacts, cancellable, photo_callback, photo_user_data, NULL, FALSE, error);
+}
+
+typedef struct {
+	GList *contacts;
+	GDataContactsServicePhotoCallback photo_callback;
+	gpointer photo_user_data;
+	GDestroyNotify destroy_photo_user_data;
+	GMainContext *context;
+	gboolean success;
+} PrefetchPhotosAsyncData;
+
+static void
+prefetch_photos_async_data_free (PrefetchPhotosAsyncData *data)
+{
+	g_list_free_full (data->contacts, g_object_unref);
+
+	if (data->destroy_photo_user_data != NULL)
+		data->destroy_photo_user_data (data->photo_user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (PrefetchPhotosAsyncData, data);
+}
+
+static void
+prefetch_photos_thread (GSimpleAsyncResult *result, GDataContactsService *service, GCancellable *cancellable)
+{
+	PrefetchPhotosAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	data->success = prefetch_photos (service, data->contacts, cancellable, data->photo_callback, data->photo_user_data, data->context, TRUE,
+	                                 &error);
+
+	if (data->success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_contacts_service_prefetch_photos_async:
+ * @self: a #GDataContactsService
+ * @contacts: (element-type GData.ContactsContact): a list of #GDataContactsContact<!-- -->s whose photos should be cached
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @photo_callback: (allow-none) (closure photo_user_data): a #GDataContactsServicePhotoCallback to call when each contact's photo has been cached,
+ * or %NULL
+ * @photo_user_data: (closure): data to pass to the @photo_callback function
+ * @destroy_photo_user_data: (allow-none): the function to call when @photo_callback will not be called any more, or %NULL. This function will be
+ * called with @photo_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the prefetch is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Fills @self's photo cache with the photos of the #GDataContactsContact<!-- -->s in @contacts asynchronously, passing each to @photo_callback in an
+ * idle function in the thread-default main context of the thread which called this function (see g_main_context_push_thread_default()). @self and
+ * @contacts are reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_contacts_service_prefetch_photos(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_contacts_service_prefetch_photos_finish() to get the results of
+ * the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_service_prefetch_photos_async (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                              GDataContactsServicePhotoCallback photo_callback, gpointer photo_user_data,
+                                              GDestroyNotify destroy_photo_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	PrefetchPhotosAsyncData *data;
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_SERVICE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = contacts; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_CONTACTS_CONTACT (i->data));
+
+	data = g_slice_new0 (PrefetchPhotosAsyncData);
+	data->contacts = g_list_copy (contacts);
+	g_list_foreach (data->contacts, (GFunc) g_object_ref, NULL);
+	data->photo_callback = photo_callback;
+	data->photo_user_data = photo_user_data;
+	data->destroy_photo_user_data = destroy_photo_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_contacts_service_prefetch_photos_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) prefetch_photos_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) prefetch_photos_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_contacts_service_prefetch_photos_finish:
+ * @self: a #GDataContactsService
+ * @result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous photo prefetch operation started with gdata_contacts_service_prefetch_photos_async().
+ *
+ * Return value: %TRUE if all the photos were prefetched (whether successfully or not), %FALSE if the operation was cancelled
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_service_prefetch_photos_finish (GDataContactsService *self, GAsyncResult *result, GError **error)
+{
+	PrefetchPhotosAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (self), gdata_contacts_service_prefetch_photos_async) == TRUE, FALSE);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error) == TRUE)
+		return FALSE;
+
+	data = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
+	return data->success;
+}
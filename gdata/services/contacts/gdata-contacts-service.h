@@ -46,6 +46,7 @@ typedef struct _GDataContactsServicePrivate	GDataContactsServicePrivate;
  **/
 typedef struct {
 	GDataService parent;
+	GDataContactsServicePrivate *priv;
 } GDataContactsService;
 
 /**
@@ -74,6 +75,14 @@ void gdata_contacts_service_query_contacts_async (GDataContactsService *self, GD
                                                   GDestroyNotify destroy_progress_user_data,
                                                   GAsyncReadyCallback callback, gpointer user_data);
 
+GDataFeed *gdata_contacts_service_query_contact_summaries (GDataContactsService *self, GDataQuery *query, GCancellable *cancellable,
+                                                           GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                                                           GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_contacts_service_query_contact_summaries_async (GDataContactsService *self, GDataQuery *query, GCancellable *cancellable,
+                                                           GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                                                           GDestroyNotify destroy_progress_user_data,
+                                                           GAsyncReadyCallback callback, gpointer user_data);
+
 #include <gdata/services/contacts/gdata-contacts-contact.h>
 
 GDataContactsContact *gdata_contacts_service_insert_contact (GDataContactsService *self, GDataContactsContact *contact,
@@ -96,6 +105,66 @@ GDataContactsGroup *gdata_contacts_service_insert_group (GDataContactsService *s
 void gdata_contacts_service_insert_group_async (GDataContactsService *self, GDataContactsGroup *group, GCancellable *cancellable,
                                                 GAsyncReadyCallback callback, gpointer user_data);
 
+/**
+ * GDataContactsServiceBatchCallback:
+ * @index: the position of @contact in the list of contacts passed to the batch function
+ * @contact: the #GDataContactsContact which was passed to the batch function
+ * @result: (allow-none): the contact returned by the server, or %NULL on error or for deletions
+ * @error: (allow-none): the error which occurred while processing @contact, or %NULL on success
+ * @user_data: user data passed to the batch function
+ *
+ * Callback for gdata_contacts_service_insert_contacts(), gdata_contacts_service_update_contacts() and gdata_contacts_service_delete_contacts(),
+ * called once for each contact passed to them. @contact, @result and @error are owned by the batch operation; they must be reffed or copied if
+ * they need to outlive the callback.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataContactsServiceBatchCallback) (guint index, GDataContactsContact *contact, GDataContactsContact *result, GError *error,
+                                                   gpointer user_data);
+
+gboolean gdata_contacts_service_insert_contacts (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                                 GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error);
+void gdata_contacts_service_insert_contacts_async (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                                   GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                                   GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_contacts_service_insert_contacts_finish (GDataContactsService *self, GAsyncResult *async_result, GError **error);
+
+gboolean gdata_contacts_service_update_contacts (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                                 GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error);
+void gdata_contacts_service_update_contacts_async (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                                   GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                                   GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_contacts_service_update_contacts_finish (GDataContactsService *self, GAsyncResult *async_result, GError **error);
+
+gboolean gdata_contacts_service_delete_contacts (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                                 GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error);
+void gdata_contacts_service_delete_contacts_async (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                                   GDataContactsServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                                   GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_contacts_service_delete_contacts_finish (GDataContactsService *self, GAsyncResult *async_result, GError **error);
+
+void gdata_contacts_service_set_photo_cache (GDataContactsService *self, const gchar *directory, gsize memory_limit);
+
+/**
+ * GDataContactsServicePhotoCallback:
+ * @contact: the #GDataContactsContact whose photo was prefetched
+ * @error: (allow-none): the error which occurred while downloading the photo, or %NULL if it's now in the cache
+ * @user_data: user data passed to the prefetch function
+ *
+ * Callback for gdata_contacts_service_prefetch_photos(), called once for each contact with a photo. @contact and @error are owned by the prefetch
+ * operation; they must be reffed or copied if they need to outlive the callback.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataContactsServicePhotoCallback) (GDataContactsContact *contact, GError *error, gpointer user_data);
+
+gboolean gdata_contacts_service_prefetch_photos (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                                 GDataContactsServicePhotoCallback photo_callback, gpointer photo_user_data, GError **error);
+void gdata_contacts_service_prefetch_photos_async (GDataContactsService *self, GList *contacts, GCancellable *cancellable,
+                                                   GDataContactsServicePhotoCallback photo_callback, gpointer photo_user_data,
+                                                   GDestroyNotify destroy_photo_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_contacts_service_prefetch_photos_finish (GDataContactsService *self, GAsyncResult *result, GError **error);
+
 G_END_DECLS
 
 #endif /* !GDATA_CONTACTS_SERVICE_H */
@@ -0,0 +1,534 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-contacts-sync
+ * @short_description: GData Contacts incremental synchronisation
+ * @stability: Unstable
+ * @include: gdata/services/contacts/gdata-contacts-sync.h
+ *
+ * #GDataContactsSync keeps a local copy of a user's contacts up to date by only downloading the contacts which have been added, changed or deleted
+ * since it was last run, rather than the whole address book.
+ *
+ * The local copy is accessed through the #GDataContactsSyncStore interface, which the application implements. As well as holding the contacts,
+ * the store persists a <firstterm>watermark</firstterm>: the server's time at the start of the last successful synchronisation. Each run of
+ * gdata_contacts_sync_run() queries for contacts updated since the watermark (using #GDataQuery:updated-min and
+ * #GDataContactsQuery:show-deleted), walks all the pages of results, applies them to the store, and then stores a new watermark.
+ *
+ * The watermark is taken from the server's clock, so it's unaffected by skew in the local clock. To allow for changes which the server hasn't
+ * finished propagating when the watermark is taken, each query starts #GDataContactsSync:clock-skew-margin seconds before the watermark; so some
+ * contacts may be applied to the store more than once. If a run fails part-way through, the watermark isn't updated, and the next run will
+ * re-apply the changes.
+ *
+ * To force a full synchronisation, empty the store and have it return <code class="literal">-1</code> as its watermark. Note that the server only
+ * keeps records of deleted contacts for a limited time (around 30 days), so stores which haven't been synchronised for longer than that should
+ * be fully re-synchronised.
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-contacts-sync.h"
+#include "gdata-contacts-query.h"
+#include "gdata-private.h"
+
+G_DEFINE_INTERFACE (GDataContactsSyncStore, gdata_contacts_sync_store, G_TYPE_OBJECT)
+
+static void
+gdata_contacts_sync_store_default_init (GDataContactsSyncStoreInterface *iface)
+{
+	/* Nothing to see here */
+}
+
+static void gdata_contacts_sync_dispose (GObject *object);
+static void gdata_contacts_sync_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_contacts_sync_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataContactsSyncPrivate {
+	GDataContactsService *service;
+	GDataContactsSyncStore *store;
+	guint clock_skew_margin;
+	guint page_size;
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_STORE,
+	PROP_CLOCK_SKEW_MARGIN,
+	PROP_PAGE_SIZE,
+};
+
+G_DEFINE_TYPE (GDataContactsSync, gdata_contacts_sync, G_TYPE_OBJECT)
+
+static void
+gdata_contacts_sync_class_init (GDataContactsSyncClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataContactsSyncPrivate));
+
+	gobject_class->get_property = gdata_contacts_sync_get_property;
+	gobject_class->set_property = gdata_contacts_sync_set_property;
+	gobject_class->dispose = gdata_contacts_sync_dispose;
+
+	/**
+	 * GDataContactsSync:service:
+	 *
+	 * The service to query for changed contacts.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service to query for changed contacts.",
+	                                                      GDATA_TYPE_CONTACTS_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataContactsSync:store:
+	 *
+	 * The local store to apply changed contacts to.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_STORE,
+	                                 g_param_spec_object ("store",
+	                                                      "Store", "The local store to apply changed contacts to.",
+	                                                      GDATA_TYPE_CONTACTS_SYNC_STORE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataContactsSync:clock-skew-margin:
+	 *
+	 * The number of seconds before the stored watermark from which to query for changes, to allow for changes which hadn't propagated through the
+	 * server when the watermark was taken.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_CLOCK_SKEW_MARGIN,
+	                                 g_param_spec_uint ("clock-skew-margin",
+	                                                    "Clock skew margin", "The number of seconds before the watermark to query from.",
+	                                                    0, G_MAXUINT, 300,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataContactsSync:page-size:
+	 *
+	 * The maximum number of contacts to request in each page of results.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_PAGE_SIZE,
+	                                 g_param_spec_uint ("page-size",
+	                                                    "Page size", "The maximum number of contacts to request in each page of results.",
+	                                                    1, G_MAXUINT, 500,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_contacts_sync_init (GDataContactsSync *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_CONTACTS_SYNC, GDataContactsSyncPrivate);
+	self->priv->clock_skew_margin = 300;
+	self->priv->page_size = 500;
+}
+
+static void
+gdata_contacts_sync_dispose (GObject *object)
+{
+	GDataContactsSyncPrivate *priv = GDATA_CONTACTS_SYNC (object)->priv;
+
+	g_clear_object (&priv->service);
+	g_clear_object (&priv->store);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_contacts_sync_parent_class)->dispose (object);
+}
+
+static void
+gdata_contacts_sync_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataContactsSyncPrivate *priv = GDATA_CONTACTS_SYNC (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_STORE:
+			g_value_set_object (value, priv->store);
+			break;
+		case PROP_CLOCK_SKEW_MARGIN:
+			g_value_set_uint (value, priv->clock_skew_margin);
+			break;
+		case PROP_PAGE_SIZE:
+			g_value_set_uint (value, priv->page_size);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_contacts_sync_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataContactsSyncPrivate *priv = GDATA_CONTACTS_SYNC (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_STORE:
+			priv->store = g_value_dup_object (value);
+			break;
+		case PROP_CLOCK_SKEW_MARGIN:
+			gdata_contacts_sync_set_clock_skew_margin (GDATA_CONTACTS_SYNC (object), g_value_get_uint (value));
+			break;
+		case PROP_PAGE_SIZE:
+			gdata_contacts_sync_set_page_size (GDATA_CONTACTS_SYNC (object), g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_contacts_sync_new:
+ * @service: the #GDataContactsService to query for changed contacts
+ * @store: the #GDataContactsSyncStore holding the local copy of the contacts
+ *
+ * Creates a new #GDataContactsSync, which will keep @store up to date with the contacts available through @service.
+ *
+ * Return value: (transfer full): a new #GDataContactsSync; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataContactsSync *
+gdata_contacts_sync_new (GDataContactsService *service, GDataContactsSyncStore *store)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SERVICE (service), NULL);
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SYNC_STORE (store), NULL);
+
+	return g_object_new (GDATA_TYPE_CONTACTS_SYNC, "service", service, "store", store, NULL);
+}
+
+/**
+ * gdata_contacts_sync_get_service:
+ * @self: a #GDataContactsSync
+ *
+ * Gets the #GDataContactsSync:service property.
+ *
+ * Return value: (transfer none): the service to query for changed contacts
+ *
+ * Since: 0.15.0
+ */
+GDataContactsService *
+gdata_contacts_sync_get_service (GDataContactsSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SYNC (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_contacts_sync_get_store:
+ * @self: a #GDataContactsSync
+ *
+ * Gets the #GDataContactsSync:store property.
+ *
+ * Return value: (transfer none): the local store to apply changed contacts to
+ *
+ * Since: 0.15.0
+ */
+GDataContactsSyncStore *
+gdata_contacts_sync_get_store (GDataContactsSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SYNC (self), NULL);
+	return self->priv->store;
+}
+
+/**
+ * gdata_contacts_sync_get_clock_skew_margin:
+ * @self: a #GDataContactsSync
+ *
+ * Gets the #GDataContactsSync:clock-skew-margin property.
+ *
+ * Return value: the margin before the watermark from which changes are queried, in seconds
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_contacts_sync_get_clock_skew_margin (GDataContactsSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SYNC (self), 0);
+	return self->priv->clock_skew_margin;
+}
+
+/**
+ * gdata_contacts_sync_set_clock_skew_margin:
+ * @self: a #GDataContactsSync
+ * @clock_skew_margin: the margin before the watermark from which to query changes, in seconds
+ *
+ * Sets the #GDataContactsSync:clock-skew-margin property.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_sync_set_clock_skew_margin (GDataContactsSync *self, guint clock_skew_margin)
+{
+	g_return_if_fail (GDATA_IS_CONTACTS_SYNC (self));
+
+	self->priv->clock_skew_margin = clock_skew_margin;
+	g_object_notify (G_OBJECT (self), "clock-skew-margin");
+}
+
+/**
+ * gdata_contacts_sync_get_page_size:
+ * @self: a #GDataContactsSync
+ *
+ * Gets the #GDataContactsSync:page-size property.
+ *
+ * Return value: the maximum number of contacts requested in each page of results
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_contacts_sync_get_page_size (GDataContactsSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SYNC (self), 0);
+	return self->priv->page_size;
+}
+
+/**
+ * gdata_contacts_sync_set_page_size:
+ * @self: a #GDataContactsSync
+ * @page_size: the maximum number of contacts to request in each page of results; must be greater than <code class="literal">0</code>
+ *
+ * Sets the #GDataContactsSync:page-size property.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_sync_set_page_size (GDataContactsSync *self, guint page_size)
+{
+	g_return_if_fail (GDATA_IS_CONTACTS_SYNC (self));
+	g_return_if_fail (page_size > 0);
+
+	self->priv->page_size = page_size;
+	g_object_notify (G_OBJECT (self), "page-size");
+}
+
+typedef struct {
+	GDataContactsSync *self;
+	guint n_changed;
+	guint n_removed;
+} RunData;
+
+static GDataFeed *
+query_page (GDataQuery *query, RunData *data, GCancellable *cancellable, GError **error)
+{
+	return gdata_contacts_service_query_contacts (data->self->priv->service, query, cancellable, NULL, NULL, error);
+}
+
+/* Applies a changed contact to the store, returning FALSE if the store fails */
+static gboolean
+apply_entry (GDataEntry *entry, RunData *data, GError **error)
+{
+	GDataContactsSyncStore *store = data->self->priv->store;
+	GDataContactsSyncStoreInterface *iface = GDATA_CONTACTS_SYNC_STORE_GET_IFACE (store);
+	GDataContactsContact *contact = GDATA_CONTACTS_CONTACT (entry);
+
+	if (gdata_contacts_contact_is_deleted (contact) == TRUE) {
+		if (iface->remove_contact (store, gdata_entry_get_id (entry), error) == FALSE)
+			return FALSE;
+		data->n_removed++;
+	} else {
+		if (iface->apply_contact (store, contact, error) == FALSE)
+			return FALSE;
+		data->n_changed++;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_contacts_sync_run:
+ * @self: a #GDataContactsSync
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @n_changed: (out caller-allocates) (allow-none): return location for the number of contacts added or changed, or %NULL
+ * @n_removed: (out caller-allocates) (allow-none): return location for the number of contacts removed, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Synchronises the #GDataContactsSync:store with the server, applying all the contacts which have been added, changed or deleted since the store's
+ * watermark, and then updating the watermark. All the pages of results are queried. If the store has never been synchronised, all the contacts
+ * are applied to it.
+ *
+ * The store's functions are called in the same thread as this function. If the query fails, or any of the store's functions fails, synchronisation
+ * stops and the watermark is left unchanged. Errors are as for gdata_service_query().
+ *
+ * Only one synchronisation should be run on a given store at once.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_sync_run (GDataContactsSync *self, GCancellable *cancellable, guint *n_changed, guint *n_removed, GError **error)
+{
+	GDataContactsSyncPrivate *priv;
+	GDataContactsSyncStoreInterface *iface;
+	GDataContactsQuery *query;
+	RunData data;
+	gint64 watermark, new_watermark;
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SYNC (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = self->priv;
+	iface = GDATA_CONTACTS_SYNC_STORE_GET_IFACE (priv->store);
+	g_assert (iface->get_watermark != NULL && iface->set_watermark != NULL);
+	g_assert (iface->apply_contact != NULL && iface->remove_contact != NULL);
+
+	watermark = iface->get_watermark (priv->store);
+
+	query = gdata_contacts_query_new_with_limits (NULL, 1, priv->page_size);
+
+	/* Include deletions in incremental synchronisations */
+	if (watermark >= 0)
+		gdata_contacts_query_set_show_deleted (query, TRUE);
+
+	data.self = self;
+	data.n_changed = 0;
+	data.n_removed = 0;
+
+	success = _gdata_sync_run (GDATA_QUERY (query), watermark, priv->clock_skew_margin, (GDataSyncQueryFunc) query_page,
+	                           (GDataSyncEntryFunc) apply_entry, &data, cancellable, &new_watermark, error);
+
+	g_object_unref (query);
+
+	/* Only move the watermark on once all the changes have been applied */
+	if (success == TRUE && new_watermark >= 0)
+		success = iface->set_watermark (priv->store, new_watermark, error);
+
+	if (n_changed != NULL)
+		*n_changed = data.n_changed;
+	if (n_removed != NULL)
+		*n_removed = data.n_removed;
+
+	return success;
+}
+
+typedef struct {
+	guint n_changed;
+	guint n_removed;
+} RunAsyncData;
+
+static void
+run_async_data_free (RunAsyncData *data)
+{
+	g_slice_free (RunAsyncData, data);
+}
+
+static void
+run_thread (GSimpleAsyncResult *result, GDataContactsSync *self, GCancellable *cancellable)
+{
+	RunAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	if (gdata_contacts_sync_run (self, cancellable, &(data->n_changed), &(data->n_removed), &error) == FALSE)
+		g_simple_async_result_take_error (result, error);
+}
+
+/**
+ * gdata_contacts_sync_run_async:
+ * @self: a #GDataContactsSync
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when synchronisation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Synchronises the #GDataContactsSync:store with the server asynchronously. @self is reffed when this function is called, so can safely be unreffed
+ * after this function returns.
+ *
+ * For more details, see gdata_contacts_sync_run(), which is the synchronous version of this function. Note that the store's functions will be
+ * called in a worker thread, rather than the main thread.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_contacts_sync_run_finish() to get the results of the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_contacts_sync_run_async (GDataContactsSync *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+
+	g_return_if_fail (GDATA_IS_CONTACTS_SYNC (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_contacts_sync_run_async);
+	g_simple_async_result_set_op_res_gpointer (result, g_slice_new0 (RunAsyncData), (GDestroyNotify) run_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) run_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_contacts_sync_run_finish:
+ * @self: a #GDataContactsSync
+ * @async_result: a #GAsyncResult
+ * @n_changed: (out caller-allocates) (allow-none): return location for the number of contacts added or changed, or %NULL
+ * @n_removed: (out caller-allocates) (allow-none): return location for the number of contacts removed, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous synchronisation operation started with gdata_contacts_sync_run_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_contacts_sync_run_finish (GDataContactsSync *self, GAsyncResult *async_result, guint *n_changed, guint *n_removed, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	RunAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_CONTACTS_SYNC (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_contacts_sync_run_async);
+
+	/* Changes applied before a failure are still reported */
+	data = g_simple_async_result_get_op_res_gpointer (result);
+
+	if (n_changed != NULL)
+		*n_changed = data->n_changed;
+	if (n_removed != NULL)
+		*n_removed = data->n_removed;
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	return TRUE;
+}
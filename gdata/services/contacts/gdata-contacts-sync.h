@@ -0,0 +1,125 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_CONTACTS_SYNC_H
+#define GDATA_CONTACTS_SYNC_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/services/contacts/gdata-contacts-service.h>
+#include <gdata/services/contacts/gdata-contacts-contact.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_CONTACTS_SYNC_STORE		(gdata_contacts_sync_store_get_type ())
+#define GDATA_CONTACTS_SYNC_STORE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CONTACTS_SYNC_STORE, GDataContactsSyncStore))
+#define GDATA_CONTACTS_SYNC_STORE_CLASS(k)	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CONTACTS_SYNC_STORE, GDataContactsSyncStoreInterface))
+#define GDATA_IS_CONTACTS_SYNC_STORE(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CONTACTS_SYNC_STORE))
+#define GDATA_CONTACTS_SYNC_STORE_GET_IFACE(o)	(G_TYPE_INSTANCE_GET_INTERFACE ((o), GDATA_TYPE_CONTACTS_SYNC_STORE, GDataContactsSyncStoreInterface))
+
+/**
+ * GDataContactsSyncStore:
+ *
+ * All the fields in the #GDataContactsSyncStore structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct _GDataContactsSyncStore		GDataContactsSyncStore; /* dummy typedef */
+
+/**
+ * GDataContactsSyncStoreInterface:
+ * @parent: the parent type
+ * @get_watermark: a function to return the watermark last stored by @set_watermark, or <code class="literal">-1</code> if the store has never
+ * been synchronised; this must be implemented
+ * @set_watermark: a function to persistently store the given watermark, which is only called once all the changes up to it have been applied to the
+ * store; this must be implemented
+ * @apply_contact: a function to add the given contact to the store, or to replace the existing version of it (matched by gdata_entry_get_id()) if
+ * the store already contains it; this must be implemented, and must cope with being passed a version of a contact which it already contains
+ * @remove_contact: a function to remove the contact with the given ID from the store; this must be implemented, and must cope with being passed the
+ * ID of a contact which the store doesn't contain
+ *
+ * The interface structure for the #GDataContactsSyncStore interface. The functions are called in the thread which runs the synchronisation.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GTypeInterface parent;
+
+	gint64 (*get_watermark) (GDataContactsSyncStore *self);
+	gboolean (*set_watermark) (GDataContactsSyncStore *self, gint64 watermark, GError **error);
+	gboolean (*apply_contact) (GDataContactsSyncStore *self, GDataContactsContact *contact, GError **error);
+	gboolean (*remove_contact) (GDataContactsSyncStore *self, const gchar *contact_id, GError **error);
+} GDataContactsSyncStoreInterface;
+
+GType gdata_contacts_sync_store_get_type (void) G_GNUC_CONST;
+
+#define GDATA_TYPE_CONTACTS_SYNC		(gdata_contacts_sync_get_type ())
+#define GDATA_CONTACTS_SYNC(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_CONTACTS_SYNC, GDataContactsSync))
+#define GDATA_CONTACTS_SYNC_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_CONTACTS_SYNC, GDataContactsSyncClass))
+#define GDATA_IS_CONTACTS_SYNC(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_CONTACTS_SYNC))
+#define GDATA_IS_CONTACTS_SYNC_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_CONTACTS_SYNC))
+#define GDATA_CONTACTS_SYNC_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_CONTACTS_SYNC, GDataContactsSyncClass))
+
+typedef struct _GDataContactsSyncPrivate	GDataContactsSyncPrivate;
+
+/**
+ * GDataContactsSync:
+ *
+ * All the fields in the #GDataContactsSync structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	GObject parent;
+	GDataContactsSyncPrivate *priv;
+} GDataContactsSync;
+
+/**
+ * GDataContactsSyncClass:
+ *
+ * All the fields in the #GDataContactsSyncClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataContactsSyncClass;
+
+GType gdata_contacts_sync_get_type (void) G_GNUC_CONST;
+
+GDataContactsSync *gdata_contacts_sync_new (GDataContactsService *service, GDataContactsSyncStore *store) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataContactsService *gdata_contacts_sync_get_service (GDataContactsSync *self) G_GNUC_PURE;
+GDataContactsSyncStore *gdata_contacts_sync_get_store (GDataContactsSync *self) G_GNUC_PURE;
+
+guint gdata_contacts_sync_get_clock_skew_margin (GDataContactsSync *self) G_GNUC_PURE;
+void gdata_contacts_sync_set_clock_skew_margin (GDataContactsSync *self, guint clock_skew_margin);
+guint gdata_contacts_sync_get_page_size (GDataContactsSync *self) G_GNUC_PURE;
+void gdata_contacts_sync_set_page_size (GDataContactsSync *self, guint page_size);
+
+gboolean gdata_contacts_sync_run (GDataContactsSync *self, GCancellable *cancellable, guint *n_changed, guint *n_removed, GError **error);
+void gdata_contacts_sync_run_async (GDataContactsSync *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_contacts_sync_run_finish (GDataContactsSync *self, GAsyncResult *async_result, guint *n_changed, guint *n_removed, GError **error);
+
+G_END_DECLS
+
+#endif /* !GDATA_CONTACTS_SYNC_H */
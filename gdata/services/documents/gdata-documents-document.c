@@ -309,6 +309,52 @@ gdata_documents_document_download (GDataDocumentsDocument *self, GDataDocumentsS
 	return download_stream;
 }
 
+/**
+ * gdata_documents_document_download_to_file:
+ * @self: a #GDataDocumentsDocument
+ * @service: a #GDataDocumentsService
+ * @export_format: the format in which the document should be exported
+ * @destination: the #GFile to save the document to
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Downloads and exports the document to @destination in the given @export_format, as with gdata_documents_document_download(). The document is
+ * written straight to @destination as it's received, using gdata_download_stream_download_to_file(), which is more efficient than splicing the
+ * returned #GDataDownloadStream into a file. @destination is created if it doesn't exist and overwritten if it does; if the download fails, its
+ * contents are undefined.
+ *
+ * If @service isn't authenticated, a %GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED will be returned.
+ *
+ * If there is an error getting the document, a %GDATA_SERVICE_ERROR_PROTOCOL_ERROR error will be returned.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_document_download_to_file (GDataDocumentsDocument *self, GDataDocumentsService *service, const gchar *export_format,
+                                           GFile *destination, GCancellable *cancellable, GError **error)
+{
+	GDataDownloadStream *download_stream;
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_DOCUMENT (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_SERVICE (service), FALSE);
+	g_return_val_if_fail (export_format != NULL && *export_format != '\0', FALSE);
+	g_return_val_if_fail (G_IS_FILE (destination), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	download_stream = gdata_documents_document_download (self, service, export_format, cancellable, error);
+	if (download_stream == NULL)
+		return FALSE;
+
+	success = gdata_download_stream_download_to_file (download_stream, destination, cancellable, error);
+	g_object_unref (download_stream);
+
+	return success;
+}
+
 /**
  * gdata_documents_document_get_download_uri:
  * @self: a #GDataDocumentsDocument
@@ -395,3 +441,385 @@ gdata_documents_document_get_thumbnail_uri (GDataDocumentsDocument *self)
 
 	return gdata_link_get_uri (thumbnail_link);
 }
+
+typedef struct {
+	GDataDocumentsService *service;
+	GCancellable *cancellable;
+	GAsyncQueue *results; /* ExportResults */
+} ExportMultipleData;
+
+typedef struct {
+	GDataDocumentsDocument *document;
+	gchar *export_format;
+	GFile *file;
+	GFile *partial_file;
+	GError *error;
+	GDataDocumentsDocumentExportCallback callback;
+	gpointer user_data;
+} ExportResult;
+
+static void
+export_result_free (ExportResult *result)
+{
+	g_object_unref (result->document);
+	g_free (result->export_format);
+	g_object_unref (result->file);
+	g_object_unref (result->partial_file);
+	if (result->error != NULL)
+		g_error_free (result->error);
+
+	g_slice_free (ExportResult, result);
+}
+
+/* Builds the name of the file to export @document to. This is based on the resource ID, rather than the title, so that it's unique and stays the
+ * same between runs, which is what allows an interrupted export to be resumed. */
+static gchar *
+build_export_file_name (GDataDocumentsDocument *document, const gchar *export_format)
+{
+	gchar *name, *file_name;
+
+	name = g_strdup (gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (document)));
+	g_strcanon (name, G_CSET_A_2_Z G_CSET_a_2_z G_CSET_DIGITS "-_", '_');
+
+	file_name = g_strconcat (name, ".", export_format, NULL);
+	g_free (name);
+
+	return file_name;
+}
+
+static GDataDownloadStream *
+export_document (GDataDocumentsDocument *document, GDataDocumentsService *service, const gchar *export_format, GCancellable *cancellable,
+                 GError **error)
+{
+	GDataAuthorizationDomain *domain;
+	GDataDownloadStream *download_stream;
+	gchar *download_uri;
+
+	/* Spreadsheets are exported from their own host, so can't use the content URI which gdata_documents_document_download() uses */
+	if (GDATA_IS_DOCUMENTS_SPREADSHEET (document) == FALSE)
+		return gdata_documents_document_download (document, service, export_format, cancellable, error);
+
+	domain = gdata_documents_service_get_spreadsheet_authorization_domain ();
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (service)), domain) == FALSE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+		                     _("You must be authenticated to download documents."));
+		return NULL;
+	}
+
+	download_uri = gdata_documents_spreadsheet_get_download_uri (GDATA_DOCUMENTS_SPREADSHEET (document), export_format, -1);
+	download_stream = GDATA_DOWNLOAD_STREAM (gdata_download_stream_new (GDATA_SERVICE (service), domain, download_uri, cancellable));
+	g_free (download_uri);
+
+	return download_stream;
+}
+
+static void
+export_thread (ExportResult *result, ExportMultipleData *data)
+{
+	GDataDownloadStream *download_stream;
+
+	/* Files which already exist were exported by a previous run, so are skipped */
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &(result->error)) == TRUE ||
+	    g_file_query_exists (result->file, NULL) == TRUE) {
+		goto done;
+	}
+
+	/* Download to a temporary file alongside the destination, and only move it into place once it's complete; so the destination only ever
+	 * exists if the export succeeded */
+	download_stream = export_document (result->document, data->service, result->export_format, data->cancellable, &(result->error));
+
+	if (download_stream != NULL &&
+	    gdata_download_stream_download_to_file (download_stream, result->partial_file, data->cancellable, &(result->error)) == TRUE) {
+		g_file_move (result->partial_file, result->file, G_FILE_COPY_OVERWRITE, data->cancellable, NULL, NULL, &(result->error));
+	}
+
+	if (result->error != NULL)
+		g_file_delete (result->partial_file, NULL, NULL);
+
+	if (download_stream != NULL)
+		g_object_unref (download_stream);
+
+done:
+	g_async_queue_push (data->results, result);
+}
+
+/* Run the user-supplied callback for an export. This is designed to be used in an idle handler, so that the callback is run in the thread which
+ * started the export. */
+static gboolean
+export_result_callback_cb (ExportResult *result)
+{
+	result->callback (result->document, result->export_format, result->file, result->error, result->user_data);
+	return FALSE;
+}
+
+static gboolean
+export_multiple (GDataDocumentsService *service, GList *documents, const gchar * const *export_formats, GFile *destination_directory,
+                 GCancellable *cancellable, GDataDocumentsDocumentExportCallback export_callback, gpointer export_user_data, GMainContext *context,
+                 gboolean is_async, GError **error)
+{
+	ExportMultipleData data;
+	GThreadPool *documents_pool, *spreadsheets_pool;
+	GError *child_error = NULL;
+	GList *i;
+	guint n_threads, n_pending = 0;
+
+	if (g_file_make_directory_with_parents (destination_directory, cancellable, &child_error) == FALSE &&
+	    g_error_matches (child_error, G_IO_ERROR, G_IO_ERROR_EXISTS) == FALSE) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	g_clear_error (&child_error);
+
+	data.service = service;
+	data.cancellable = cancellable;
+	data.results = g_async_queue_new ();
+
+	/* Spreadsheets are exported from a different host to other documents, so have their own pool; each pool is limited to the number of
+	 * connections the service allows to a single host. */
+	n_threads = MAX (gdata_service_get_max_connections_per_host (GDATA_SERVICE (service)), 1);
+	documents_pool = g_thread_pool_new ((GFunc) export_thread, &data, n_threads, FALSE, NULL);
+	spreadsheets_pool = g_thread_pool_new ((GFunc) export_thread, &data, n_threads, FALSE, NULL);
+
+	for (i = documents; i != NULL; i = i->next) {
+		guint j;
+
+		for (j = 0; export_formats[j] != NULL; j++) {
+			ExportResult *result;
+			gchar *file_name, *partial_file_name;
+
+			file_name = build_export_file_name (GDATA_DOCUMENTS_DOCUMENT (i->data), export_formats[j]);
+			partial_file_name = g_strconcat (file_name, ".part", NULL);
+
+			result = g_slice_new0 (ExportResult);
+			result->document = g_object_ref (i->data);
+			result->export_format = g_strdup (export_formats[j]);
+			result->file = g_file_get_child (destination_directory, file_name);
+			result->partial_file = g_file_get_child (destination_directory, partial_file_name);
+
+			g_free (partial_file_name);
+			g_free (file_name);
+
+			g_thread_pool_push (GDATA_IS_DOCUMENTS_SPREADSHEET (i->data) ? spreadsheets_pool : documents_pool, result, NULL);
+			n_pending++;
+		}
+	}
+
+	/* Deliver the results as they arrive. As with GDataBatchOperation, only dispatch the callbacks in the thread-default main context of the
+	 * thread which started the export if it was started with gdata_documents_document_export_multiple_async(). */
+	for (; n_pending > 0; n_pending--) {
+		ExportResult *result = g_async_queue_pop (data.results);
+
+		if (export_callback == NULL) {
+			export_result_free (result);
+			continue;
+		}
+
+		result->callback = export_callback;
+		result->user_data = export_user_data;
+
+		if (is_async == TRUE) {
+			_gdata_service_idle_add (context, (GSourceFunc) export_result_callback_cb, result, (GDestroyNotify) export_result_free);
+		} else {
+			export_result_callback_cb (result);
+			export_result_free (result);
+		}
+	}
+
+	g_thread_pool_free (documents_pool, FALSE, TRUE);
+	g_thread_pool_free (spreadsheets_pool, FALSE, TRUE);
+	g_async_queue_unref (data.results);
+
+	/* Errors for individual exports are reported to the callback; only cancellation of the whole operation is reported here */
+	return (g_cancellable_set_error_if_cancelled (cancellable, error) == FALSE);
+}
+
+/**
+ * gdata_documents_document_export_multiple:
+ * @service: a #GDataDocumentsService
+ * @documents: (element-type GData.DocumentsDocument): a list of #GDataDocumentsDocument<!-- -->s to export
+ * @export_formats: (array zero-terminated=1): a %NULL-terminated array of the formats to export each document in
+ * @destination_directory: the directory to write the exported documents to
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @export_callback: (allow-none) (scope call) (closure export_user_data): a #GDataDocumentsDocumentExportCallback to call when each export has
+ * finished, or %NULL
+ * @export_user_data: (closure): data to pass to the @export_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Exports each of the #GDataDocumentsDocument<!-- -->s in @documents in each of the @export_formats, as by
+ * gdata_documents_document_download_to_file(), running several downloads concurrently. Spreadsheets are exported using
+ * gdata_documents_spreadsheet_get_download_uri(). Since spreadsheets are exported from a different host to other documents, the two are
+ * downloaded in separate pools, each of which runs up to #GDataService:max-connections-per-host downloads at once.
+ *
+ * Each export is written to a file in @destination_directory (which is created if it doesn't exist) named after the document's resource ID and
+ * the export format, such as <filename>document_1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM.odt</filename>. Downloads are written to a
+ * temporary file which is only renamed to this name once it's complete, and exports whose file already exists are skipped; so if an export is
+ * interrupted, running it again with the same @destination_directory will only download the documents which are missing. (The server generates
+ * exports on demand, so partially downloaded files can't be resumed, and are deleted.)
+ *
+ * @export_callback is called once for each document and format, with the destination #GFile and the error which occurred during the export
+ * (or %NULL if it succeeded or was skipped), in the order in which the exports finish. All the exports share @cancellable: if it's cancelled, the
+ * remaining exports are abandoned (and @export_callback is called with a %G_IO_ERROR_CANCELLED error for each of them), and %FALSE is returned with
+ * @error set. Errors for individual exports don't stop the others being downloaded, and aren't returned in @error.
+ *
+ * If @destination_directory can't be created, %FALSE is returned with @error set, and no documents are exported.
+ *
+ * Return value: %TRUE if all the exports were attempted (whether successfully or not), %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_document_export_multiple (GDataDocumentsService *service, GList *documents, const gchar * const *export_formats,
+                                          GFile *destination_directory, GCancellable *cancellable,
+                                          GDataDocumentsDocumentExportCallback export_callback, gpointer export_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SERVICE (service), FALSE);
+	g_return_val_if_fail (export_formats != NULL, FALSE);
+	g_return_val_if_fail (G_IS_FILE (destination_directory), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = documents; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_DOCUMENTS_DOCUMENT (i->data), FALSE);
+
+	return export_multiple (service, documents, export_formats, destination_directory, cancellable, export_callback, export_user_data, NULL,
+	                        FALSE, error);
+}
+
+typedef struct {
+	GList *documents;
+	gchar **export_formats;
+	GFile *destination_directory;
+	GDataDocumentsDocumentExportCallback export_callback;
+	gpointer export_user_data;
+	GDestroyNotify destroy_export_user_data;
+	GMainContext *context;
+	gboolean success;
+} ExportMultipleAsyncData;
+
+static void
+export_multiple_async_data_free (ExportMultipleAsyncData *data)
+{
+	g_list_free_full (data->documents, g_object_unref);
+	g_strfreev (data->export_formats);
+	g_object_unref (data->destination_directory);
+
+	if (data->destroy_export_user_data != NULL)
+		data->destroy_export_user_data (data->export_user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (ExportMultipleAsyncData, data);
+}
+
+static void
+export_multiple_thread (GSimpleAsyncResult *result, GDataDocumentsService *service, GCancellable *cancellable)
+{
+	ExportMultipleAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	data->success = export_multiple (service, data->documents, (const gchar * const *) data->export_formats, data->destination_directory,
+	                                 cancellable, data->export_callback, data->export_user_data, data->context, TRUE, &error);
+
+	if (data->success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_documents_document_export_multiple_async:
+ * @service: a #GDataDocumentsService
+ * @documents: (element-type GData.DocumentsDocument): a list of #GDataDocumentsDocument<!-- -->s to export
+ * @export_formats: (array zero-terminated=1): a %NULL-terminated array of the formats to export each document in
+ * @destination_directory: the directory to write the exported documents to
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @export_callback: (allow-none) (closure export_user_data): a #GDataDocumentsDocumentExportCallback to call when each export has finished,
+ * or %NULL
+ * @export_user_data: (closure): data to pass to the @export_callback function
+ * @destroy_export_user_data: (allow-none): the function to call when @export_callback will not be called any more, or %NULL. This function
+ * will be called with @export_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the exports are finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Exports each of the #GDataDocumentsDocument<!-- -->s in @documents in each of the @export_formats, calling @export_callback as the exports finish,
+ * in idle functions in the thread-default main context of the thread which called this function (see g_main_context_push_thread_default()). @service,
+ * @documents, @export_formats and @destination_directory are all reffed/copied when this function is called, so can safely be unreffed/freed after
+ * this function returns.
+ *
+ * For more details, see gdata_documents_document_export_multiple(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_documents_document_export_multiple_finish() to get the
+ * results of the operation. @export_callback is guaranteed to have been called for every export before @callback is called.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_documents_document_export_multiple_async (GDataDocumentsService *service, GList *documents, const gchar * const *export_formats,
+                                                GFile *destination_directory, GCancellable *cancellable,
+                                                GDataDocumentsDocumentExportCallback export_callback, gpointer export_user_data,
+                                                GDestroyNotify destroy_export_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	ExportMultipleAsyncData *data;
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_DOCUMENTS_SERVICE (service));
+	g_return_if_fail (export_formats != NULL);
+	g_return_if_fail (G_IS_FILE (destination_directory));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = documents; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_DOCUMENTS_DOCUMENT (i->data));
+
+	data = g_slice_new0 (ExportMultipleAsyncData);
+	data->documents = g_list_copy (documents);
+	g_list_foreach (data->documents, (GFunc) g_object_ref, NULL);
+	data->export_formats = g_strdupv ((gchar **) export_formats);
+	data->destination_directory = g_object_ref (destination_directory);
+	data->export_callback = export_callback;
+	data->export_user_data = export_user_data;
+	data->destroy_export_user_data = destroy_export_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (service), callback, user_data, gdata_documents_document_export_multiple_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) export_multiple_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) export_multiple_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_documents_document_export_multiple_finish:
+ * @service: the #GDataDocumentsService passed to gdata_documents_document_export_multiple_async()
+ * @result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous export operation started with gdata_documents_document_export_multiple_async().
+ *
+ * Return value: %TRUE if all the exports were attempted (whether successfully or not), %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_document_export_multiple_finish (GDataDocumentsService *service, GAsyncResult *result, GError **error)
+{
+	ExportMultipleAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SERVICE (service), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (result, G_OBJECT (service), gdata_documents_document_export_multiple_async) == TRUE,
+	                      FALSE);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (result), error) == TRUE)
+		return FALSE;
+
+	data = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (result));
+	return data->success;
+}
@@ -69,10 +69,38 @@ GDataDocumentsDocument *gdata_documents_document_new (const gchar *id) G_GNUC_WA
 
 GDataDownloadStream *gdata_documents_document_download (GDataDocumentsDocument *self, GDataDocumentsService *service, const gchar *export_format,
                                                         GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gboolean gdata_documents_document_download_to_file (GDataDocumentsDocument *self, GDataDocumentsService *service, const gchar *export_format,
+                                                    GFile *destination, GCancellable *cancellable, GError **error);
 gchar *gdata_documents_document_get_download_uri (GDataDocumentsDocument *self, const gchar *export_format) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
 const gchar *gdata_documents_document_get_thumbnail_uri (GDataDocumentsDocument *self) G_GNUC_PURE;
 
+/**
+ * GDataDocumentsDocumentExportCallback:
+ * @document: the #GDataDocumentsDocument which was exported
+ * @export_format: the format in which @document was exported
+ * @file: the #GFile which @document was exported to
+ * @error: the error which occurred while exporting @document, or %NULL if it was exported successfully or had already been exported
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called once for each document and format exported by gdata_documents_document_export_multiple(), as soon as the export has
+ * finished. @file only exists if @error is %NULL. None of the parameters should be freed or unreffed by the callback.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataDocumentsDocumentExportCallback) (GDataDocumentsDocument *document, const gchar *export_format, GFile *file, GError *error,
+                                                      gpointer user_data);
+
+gboolean gdata_documents_document_export_multiple (GDataDocumentsService *service, GList *documents, const gchar * const *export_formats,
+                                                   GFile *destination_directory, GCancellable *cancellable,
+                                                   GDataDocumentsDocumentExportCallback export_callback, gpointer export_user_data,
+                                                   GError **error);
+void gdata_documents_document_export_multiple_async (GDataDocumentsService *service, GList *documents, const gchar * const *export_formats,
+                                                     GFile *destination_directory, GCancellable *cancellable,
+                                                     GDataDocumentsDocumentExportCallback export_callback, gpointer export_user_data,
+                                                     GDestroyNotify destroy_export_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_documents_document_export_multiple_finish (GDataDocumentsService *service, GAsyncResult *result, GError **error);
+
 G_END_DECLS
 
 #endif /* !GDATA_DOCUMENTS_DOCUMENT_H */
@@ -132,6 +132,9 @@ struct _GDataDocumentsEntryPrivate {
 	gboolean is_deleted;
 	GDataAuthor *last_modified_by;
 	goffset quota_used; /* bytes */
+	gint64 changestamp;
+	gboolean is_removed;
+	GList *access_rules; /* GDataAccessRule; only set if the entry was queried with GDataDocumentsQuery:expand-acl */
 };
 
 enum {
@@ -144,6 +147,8 @@ enum {
 	PROP_ID,
 	PROP_RESOURCE_ID,
 	PROP_QUOTA_USED,
+	PROP_CHANGESTAMP,
+	PROP_IS_REMOVED,
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_CODE (GDataDocumentsEntry, gdata_documents_entry, GDATA_TYPE_ENTRY,
@@ -294,6 +299,38 @@ gdata_documents_entry_class_init (GDataDocumentsEntryClass *klass)
 	                                                     0, G_MAXINT64, 0,
 	                                                     G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+	/**
+	 * GDataDocumentsEntry:changestamp:
+	 *
+	 * The changestamp of the most recent change to the document. Changestamps are only present on entries returned from the changes feed
+	 * (see gdata_documents_service_query_changes()); they increase monotonically across all of a user's documents, so they can be used as a
+	 * cursor for incremental synchronisation.
+	 *
+	 * This property will be <code class="literal">-1</code> if the entry doesn't have a changestamp.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_CHANGESTAMP,
+	                                 g_param_spec_int64 ("changestamp",
+	                                                     "Changestamp", "The changestamp of the most recent change to the document.",
+	                                                     -1, G_MAXINT64, -1,
+	                                                     G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDocumentsEntry:is-removed:
+	 *
+	 * Indicates whether the document has been removed from the user's view: either permanently deleted, or unshared from the user. This is
+	 * only ever set on entries returned from the changes feed, and differs from #GDataDocumentsEntry:is-deleted, which indicates that the
+	 * document is in the trash (and can still be retrieved). The metadata of a removed entry is limited to its resource ID and changestamp.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_IS_REMOVED,
+	                                 g_param_spec_boolean ("is-removed",
+	                                                       "Removed?", "Indicates whether the document has been removed from the user's view.",
+	                                                       FALSE,
+	                                                       G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
 	/* Override the ID property since the server returns two different forms of ID depending on how you form a query on an entry. These two forms
 	 * of ID are (for version 3 of the API):
 	 *  - Document ID: /feeds/id/[resource_id]
@@ -332,6 +369,7 @@ gdata_documents_entry_init (GDataDocumentsEntry *self)
 	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_DOCUMENTS_ENTRY, GDataDocumentsEntryPrivate);
 	self->priv->edited = -1;
 	self->priv->last_viewed = -1;
+	self->priv->changestamp = -1;
 }
 
 static GObject *
@@ -365,6 +403,9 @@ gdata_entry_dispose (GObject *object)
 		g_object_unref (priv->last_modified_by);
 	priv->last_modified_by = NULL;
 
+	g_list_free_full (priv->access_rules, g_object_unref);
+	priv->access_rules = NULL;
+
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_documents_entry_parent_class)->dispose (object);
 }
@@ -410,6 +451,12 @@ gdata_documents_entry_get_property (GObject *object, guint property_id, GValue *
 		case PROP_QUOTA_USED:
 			g_value_set_int64 (value, priv->quota_used);
 			break;
+		case PROP_CHANGESTAMP:
+			g_value_set_int64 (value, priv->changestamp);
+			break;
+		case PROP_IS_REMOVED:
+			g_value_set_boolean (value, priv->is_removed);
+			break;
 		case PROP_ID: {
 			gchar *uri;
 
@@ -445,6 +492,8 @@ gdata_documents_entry_set_property (GObject *object, guint property_id, const GV
 			/* Never set an ID (note that this doesn't stop it being set in GDataEntry due to XML parsing) */
 			break;
 		case PROP_QUOTA_USED:
+		case PROP_CHANGESTAMP:
+		case PROP_IS_REMOVED:
 			/* Read only. */
 		default:
 			/* We don't have any other property... */
@@ -453,6 +502,59 @@ gdata_documents_entry_set_property (GObject *object, guint property_id, const GV
 	}
 }
 
+/* If @node is the ACL's <gd:feedLink> and contains the ACL feed inline (as requested by GDataDocumentsQuery:expand-acl), parses the feed's entries
+ * into access rules, then removes the feed from the tree so it isn't kept as unhandled XML by the link */
+static gboolean
+parse_inline_acl (GDataDocumentsEntry *self, xmlDoc *doc, xmlNode *node, GError **error)
+{
+	xmlNode *feed_node, *child_node;
+	xmlChar *rel;
+	GList *access_rules = NULL;
+	gboolean is_acl;
+
+	rel = xmlGetProp (node, (xmlChar*) "rel");
+	is_acl = (xmlStrcmp (rel, (xmlChar*) "http://schemas.google.com/acl/2007#accessControlList") == 0) ? TRUE : FALSE;
+	xmlFree (rel);
+
+	if (is_acl == FALSE)
+		return TRUE;
+
+	for (feed_node = node->children; feed_node != NULL; feed_node = feed_node->next) {
+		if (feed_node->type == XML_ELEMENT_NODE && gdata_parser_is_namespace (feed_node, "http://www.w3.org/2005/Atom") == TRUE &&
+		    xmlStrcmp (feed_node->name, (xmlChar*) "feed") == 0) {
+			break;
+		}
+	}
+
+	if (feed_node == NULL)
+		return TRUE;
+
+	for (child_node = feed_node->children; child_node != NULL; child_node = child_node->next) {
+		GDataParsable *rule;
+
+		if (child_node->type != XML_ELEMENT_NODE || gdata_parser_is_namespace (child_node, "http://www.w3.org/2005/Atom") == FALSE ||
+		    xmlStrcmp (child_node->name, (xmlChar*) "entry") != 0) {
+			continue;
+		}
+
+		rule = _gdata_parsable_new_from_xml_node (GDATA_TYPE_ACCESS_RULE, doc, child_node, NULL, error);
+		if (rule == NULL) {
+			g_list_free_full (access_rules, g_object_unref);
+			return FALSE;
+		}
+
+		access_rules = g_list_prepend (access_rules, rule);
+	}
+
+	g_list_free_full (self->priv->access_rules, g_object_unref);
+	self->priv->access_rules = g_list_reverse (access_rules);
+
+	xmlUnlinkNode (feed_node);
+	xmlFreeNode (feed_node);
+
+	return TRUE;
+}
+
 static gboolean
 parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
 {
@@ -463,6 +565,9 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 	    gdata_parser_int64_time_from_element (node, "edited", P_REQUIRED | P_NO_DUPES, &(self->priv->edited), &success, error) == TRUE) {
 		return success;
 	} else if (gdata_parser_is_namespace (node, "http://schemas.google.com/g/2005") == TRUE) {
+		if (xmlStrcmp (node->name, (xmlChar*) "feedLink") == 0 && parse_inline_acl (self, doc, node, error) == FALSE)
+			return FALSE;
+
 		if (gdata_parser_int64_time_from_element (node, "lastViewed", P_REQUIRED | P_NO_DUPES,
 		                                          &(self->priv->last_viewed), &success, error) == TRUE ||
 		    gdata_parser_object_from_element_setter (node, "feedLink", P_REQUIRED, GDATA_TYPE_LINK,
@@ -481,10 +586,20 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		} else {
 			return GDATA_PARSABLE_CLASS (gdata_documents_entry_parent_class)->parse_xml (parsable, doc, node, user_data, error);
 		}
-	} else if (gdata_parser_is_namespace (node, "http://schemas.google.com/docs/2007") == TRUE &&
-	           xmlStrcmp (node->name, (xmlChar*) "writersCanInvite") ==  0) {
-		if (gdata_parser_boolean_from_property (node, "value", &(self->priv->writers_can_invite), -1, error) == FALSE)
-			return FALSE;
+	} else if (gdata_parser_is_namespace (node, "http://schemas.google.com/docs/2007") == TRUE) {
+		if (xmlStrcmp (node->name, (xmlChar*) "writersCanInvite") ==  0) {
+			if (gdata_parser_boolean_from_property (node, "value", &(self->priv->writers_can_invite), -1, error) == FALSE)
+				return FALSE;
+		} else if (xmlStrcmp (node->name, (xmlChar*) "changestamp") ==  0) {
+			/* <docs:changestamp> */
+			if (gdata_parser_int64_from_property (node, "value", &(self->priv->changestamp), error) == FALSE)
+				return FALSE;
+		} else if (xmlStrcmp (node->name, (xmlChar*) "removed") ==  0) {
+			/* <docs:removed>; like <gd:deleted>, it doesn't have any parameters */
+			self->priv->is_removed = TRUE;
+		} else {
+			return GDATA_PARSABLE_CLASS (gdata_documents_entry_parent_class)->parse_xml (parsable, doc, node, user_data, error);
+		}
 	} else {
 		return GDATA_PARSABLE_CLASS (gdata_documents_entry_parent_class)->parse_xml (parsable, doc, node, user_data, error);
 	}
@@ -782,3 +897,58 @@ gdata_documents_entry_is_deleted (GDataDocumentsEntry *self)
 	g_return_val_if_fail (GDATA_IS_DOCUMENTS_ENTRY (self), FALSE);
 	return self->priv->is_deleted;
 }
+
+/**
+ * gdata_documents_entry_get_changestamp:
+ * @self: a #GDataDocumentsEntry
+ *
+ * Gets the #GDataDocumentsEntry:changestamp property. If the property is unset, <code class="literal">-1</code> will be returned.
+ *
+ * Return value: the changestamp of the most recent change to the document, or <code class="literal">-1</code>
+ *
+ * Since: 0.15.0
+ */
+gint64
+gdata_documents_entry_get_changestamp (GDataDocumentsEntry *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_ENTRY (self), -1);
+	return self->priv->changestamp;
+}
+
+/**
+ * gdata_documents_entry_is_removed:
+ * @self: a #GDataDocumentsEntry
+ *
+ * Gets the #GDataDocumentsEntry:is-removed property.
+ *
+ * Return value: %TRUE if the document has been removed from the user's view, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_entry_is_removed (GDataDocumentsEntry *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_ENTRY (self), FALSE);
+	return self->priv->is_removed;
+}
+
+/**
+ * gdata_documents_entry_get_access_rules:
+ * @self: a #GDataDocumentsEntry
+ *
+ * Gets the access rules of the document, as included inline in the entry when it was queried with #GDataDocumentsQuery:expand-acl set. This saves
+ * a call to gdata_access_handler_get_rules() for each document when auditing the sharing of many of them.
+ *
+ * If the entry wasn't queried with its ACL expanded, %NULL is returned, and gdata_access_handler_get_rules() must be used instead. The rules
+ * aren't updated by changes made through the access handler API.
+ *
+ * Return value: (element-type GData.AccessRule) (transfer none): a #GList of #GDataAccessRule<!-- -->s, or %NULL
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_documents_entry_get_access_rules (GDataDocumentsEntry *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_ENTRY (self), NULL);
+	return self->priv->access_rules;
+}
@@ -112,6 +112,11 @@ goffset gdata_documents_entry_get_quota_used (GDataDocumentsEntry *self) G_GNUC_
 
 gboolean gdata_documents_entry_is_deleted (GDataDocumentsEntry *self) G_GNUC_PURE;
 
+gint64 gdata_documents_entry_get_changestamp (GDataDocumentsEntry *self) G_GNUC_PURE;
+gboolean gdata_documents_entry_is_removed (GDataDocumentsEntry *self) G_GNUC_PURE;
+
+GList *gdata_documents_entry_get_access_rules (GDataDocumentsEntry *self) G_GNUC_PURE;
+
 G_END_DECLS
 
 #endif /* !GDATA_DOCUMENTS_ENTRY_H */
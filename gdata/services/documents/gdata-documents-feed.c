@@ -47,25 +47,72 @@
 #include "gdata-documents-folder.h"
 #include "gdata-documents-drawing.h"
 #include "gdata-documents-pdf.h"
+#include "gdata-parser.h"
 #include "gdata-types.h"
 #include "gdata-private.h"
 #include "gdata-service.h"
 
+static void gdata_documents_feed_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static gboolean parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *root_node, gpointer user_data, GError **error);
 
+struct _GDataDocumentsFeedPrivate {
+	gint64 largest_changestamp;
+};
+
+enum {
+	PROP_LARGEST_CHANGESTAMP = 1,
+};
+
 G_DEFINE_TYPE (GDataDocumentsFeed, gdata_documents_feed, GDATA_TYPE_FEED)
 
 static void
 gdata_documents_feed_class_init (GDataDocumentsFeedClass *klass)
 {
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 	GDataParsableClass *parsable_class = GDATA_PARSABLE_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataDocumentsFeedPrivate));
+
+	gobject_class->get_property = gdata_documents_feed_get_property;
+
 	parsable_class->parse_xml = parse_xml;
+
+	/**
+	 * GDataDocumentsFeed:largest-changestamp:
+	 *
+	 * The largest changestamp of any change to the user's documents, as of the time the feed was returned. This is only present on feeds
+	 * returned from the changes feed (see gdata_documents_service_query_changes()), and will be <code class="literal">-1</code> otherwise.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_LARGEST_CHANGESTAMP,
+	                                 g_param_spec_int64 ("largest-changestamp",
+	                                                     "Largest changestamp", "The largest changestamp of any change to the user's documents.",
+	                                                     -1, G_MAXINT64, -1,
+	                                                     G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
 gdata_documents_feed_init (GDataDocumentsFeed *self)
 {
-	/* Why am I writing it? */
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_DOCUMENTS_FEED, GDataDocumentsFeedPrivate);
+	self->priv->largest_changestamp = -1;
+}
+
+static void
+gdata_documents_feed_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataDocumentsFeedPrivate *priv = GDATA_DOCUMENTS_FEED (object)->priv;
+
+	switch (property_id) {
+		case PROP_LARGEST_CHANGESTAMP:
+			g_value_set_int64 (value, priv->largest_changestamp);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
 }
 
 /* NOTE: Cast from (xmlChar*) to (gchar*) (and corresponding change in memory management functions) is safe because we've changed
@@ -90,6 +137,21 @@ get_kind (xmlDoc *doc, xmlNode *node)
 	return NULL;
 }
 
+static gboolean
+is_removed (xmlNode *node)
+{
+	xmlNode *entry_node;
+
+	for (entry_node = node->children; entry_node != NULL; entry_node = entry_node->next) {
+		if (gdata_parser_is_namespace (entry_node, "http://schemas.google.com/docs/2007") == TRUE &&
+		    xmlStrcmp (entry_node->name, (xmlChar*) "removed") == 0) {
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
 static gboolean
 parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_data, GError **error)
 {
@@ -115,6 +177,10 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 			entry_type = GDATA_TYPE_DOCUMENTS_DRAWING;
 		} else if (g_strcmp0 (kind, "http://schemas.google.com/docs/2007#pdf") == 0) {
 			entry_type = GDATA_TYPE_DOCUMENTS_PDF;
+		} else if (kind == NULL && is_removed (node) == TRUE) {
+			/* Removed entries in the changes feed carry no kind category, but they must still be reported so that the removal can be
+			 * propagated; they only have a resource ID and changestamp, so any concrete entry type will do. */
+			entry_type = GDATA_TYPE_DOCUMENTS_DOCUMENT;
 		} else {
 			g_message ("%s documents are not handled yet", kind);
 			g_free (kind);
@@ -129,13 +195,33 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 		entry = GDATA_ENTRY (_gdata_parsable_new_from_xml_node (entry_type, doc, node, NULL, error));
 
 		/* Call the progress callback in the main thread */
-		_gdata_feed_call_progress_callback (GDATA_FEED (self), user_data, entry);
-		_gdata_feed_add_entry (GDATA_FEED (self), entry);
+		_gdata_feed_add_parsed_entry (GDATA_FEED (self), user_data, entry);
 
 		g_object_unref (entry);
 
 		return TRUE;
+	} else if (gdata_parser_is_namespace (node, "http://schemas.google.com/docs/2007") == TRUE &&
+	           xmlStrcmp (node->name, (xmlChar*) "largestChangestamp") == 0) {
+		/* <docs:largestChangestamp> */
+		return gdata_parser_int64_from_property (node, "value", &(self->priv->largest_changestamp), error);
 	}
 
 	return GDATA_PARSABLE_CLASS (gdata_documents_feed_parent_class)->parse_xml (parsable, doc, node, user_data, error);
 }
+
+/**
+ * gdata_documents_feed_get_largest_changestamp:
+ * @self: a #GDataDocumentsFeed
+ *
+ * Gets the #GDataDocumentsFeed:largest-changestamp property. If the property is unset, <code class="literal">-1</code> will be returned.
+ *
+ * Return value: the largest changestamp of any change to the user's documents, or <code class="literal">-1</code>
+ *
+ * Since: 0.15.0
+ */
+gint64
+gdata_documents_feed_get_largest_changestamp (GDataDocumentsFeed *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_FEED (self), -1);
+	return self->priv->largest_changestamp;
+}
@@ -62,6 +62,8 @@ typedef struct {
 
 GType gdata_documents_feed_get_type (void) G_GNUC_CONST;
 
+gint64 gdata_documents_feed_get_largest_changestamp (GDataDocumentsFeed *self) G_GNUC_PURE;
+
 G_END_DECLS
 
 #endif /* !GDATA_DOCUMENTS_FEED_H */
@@ -0,0 +1,873 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-documents-folder-tree
+ * @short_description: GData documents folder tree object
+ * @stability: Unstable
+ * @include: gdata/services/documents/gdata-documents-folder-tree.h
+ *
+ * #GDataDocumentsFolderTree is a standalone class which crawls a user's documents folder hierarchy and keeps an in-memory index of every entry
+ * found, with the folders each one is in. Once a folder has been crawled with gdata_documents_folder_tree_crawl(), the entries, their parent
+ * folders and their paths can be looked up without any further requests to the server.
+ *
+ * The hierarchy is crawled breadth-first, with the contents of several folders queried at once (up to the #GDataService:max-connections-per-host
+ * of the service). Documents may be in more than one folder; each appears once in the index, with all of its parents. The parents are taken both
+ * from the folders an entry was found in and from the entry's parent links, so entries in folders which haven't been crawled still have their
+ * parents recorded.
+ *
+ * Entries are identified by their #GDataDocumentsEntry:resource-id.
+ *
+ * <example>
+ *	<title>Listing a Folder's Contents</title>
+ *	<programlisting>
+ *	GDataDocumentsFolderTree *tree;
+ *	GList *children, *i;
+ *	GError *error = NULL;
+ *
+ *	tree = gdata_documents_folder_tree_new (service);
+ *
+ *	if (gdata_documents_folder_tree_crawl (tree, NULL, NULL, &error) == FALSE) {
+ *		g_error ("Error crawling documents: %s", error->message);
+ *		g_error_free (error);
+ *		g_object_unref (tree);
+ *		return;
+ *	}
+ *
+ *	children = gdata_documents_folder_tree_get_children (tree, gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (folder)));
+ *
+ *	for (i = children; i != NULL; i = i->next) {
+ *		gchar *path = gdata_documents_folder_tree_get_path (tree, gdata_documents_entry_get_resource_id (i->data));
+ *		g_message ("%s: %s", path, gdata_entry_get_title (GDATA_ENTRY (i->data)));
+ *		g_free (path);
+ *	}
+ *
+ *	g_list_free (children);
+ *	g_object_unref (tree);
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <string.h>
+
+#include "gdata-documents-folder-tree.h"
+#include "gdata-documents-query.h"
+#include "gdata-private.h"
+
+/* The URI under which a parent link refers to a folder is of the form:
+ *   https://docs.google.com/feeds/default/private/full/folder%3Afolder_id */
+#define PARENT_LINK_REL "http://schemas.google.com/docs/2007#parent"
+#define FOLDER_URI_PREFIX "folder%3A"
+
+static void gdata_documents_folder_tree_dispose (GObject *object);
+static void gdata_documents_folder_tree_finalize (GObject *object);
+static void gdata_documents_folder_tree_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_documents_folder_tree_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataDocumentsFolderTreePrivate {
+	GDataDocumentsService *service;
+
+	/* The index. These are only touched with ->mutex held, since they're filled in by the crawl threads. */
+	GMutex mutex;
+	GHashTable *entries; /* resource ID (owned) → GDataDocumentsEntry (reffed) */
+	GHashTable *parents; /* resource ID (owned) → GPtrArray of parent folder resource IDs (owned) */
+	GHashTable *children; /* folder resource ID (owned) → GPtrArray of child resource IDs (owned) */
+	gboolean is_crawling;
+};
+
+enum {
+	PROP_SERVICE = 1,
+};
+
+G_DEFINE_TYPE (GDataDocumentsFolderTree, gdata_documents_folder_tree, G_TYPE_OBJECT)
+
+static void
+gdata_documents_folder_tree_class_init (GDataDocumentsFolderTreeClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataDocumentsFolderTreePrivate));
+
+	gobject_class->dispose = gdata_documents_folder_tree_dispose;
+	gobject_class->finalize = gdata_documents_folder_tree_finalize;
+	gobject_class->get_property = gdata_documents_folder_tree_get_property;
+	gobject_class->set_property = gdata_documents_folder_tree_set_property;
+
+	/**
+	 * GDataDocumentsFolderTree:service:
+	 *
+	 * The service the folders are crawled with.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service the folders are crawled with.",
+	                                                      GDATA_TYPE_DOCUMENTS_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_documents_folder_tree_init (GDataDocumentsFolderTree *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_DOCUMENTS_FOLDER_TREE, GDataDocumentsFolderTreePrivate);
+
+	g_mutex_init (&(self->priv->mutex));
+	self->priv->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	self->priv->parents = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+	self->priv->children = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_ptr_array_unref);
+}
+
+static void
+gdata_documents_folder_tree_dispose (GObject *object)
+{
+	GDataDocumentsFolderTreePrivate *priv = GDATA_DOCUMENTS_FOLDER_TREE (object)->priv;
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	g_hash_table_remove_all (priv->entries);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_documents_folder_tree_parent_class)->dispose (object);
+}
+
+static void
+gdata_documents_folder_tree_finalize (GObject *object)
+{
+	GDataDocumentsFolderTreePrivate *priv = GDATA_DOCUMENTS_FOLDER_TREE (object)->priv;
+
+	g_hash_table_unref (priv->entries);
+	g_hash_table_unref (priv->parents);
+	g_hash_table_unref (priv->children);
+	g_mutex_clear (&(priv->mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_documents_folder_tree_parent_class)->finalize (object);
+}
+
+static void
+gdata_documents_folder_tree_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataDocumentsFolderTreePrivate *priv = GDATA_DOCUMENTS_FOLDER_TREE (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_documents_folder_tree_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataDocumentsFolderTreePrivate *priv = GDATA_DOCUMENTS_FOLDER_TREE (object)->priv;
+
+	switch (property_id) {
+		/* Construct only */
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_documents_folder_tree_new:
+ * @service: the #GDataDocumentsService to crawl the folders with
+ *
+ * Creates a new, empty #GDataDocumentsFolderTree. Use gdata_documents_folder_tree_crawl() to fill it.
+ *
+ * Return value: (transfer full): a new #GDataDocumentsFolderTree; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataDocumentsFolderTree *
+gdata_documents_folder_tree_new (GDataDocumentsService *service)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SERVICE (service), NULL);
+	return g_object_new (GDATA_TYPE_DOCUMENTS_FOLDER_TREE, "service", service, NULL);
+}
+
+/**
+ * gdata_documents_folder_tree_get_service:
+ * @self: a #GDataDocumentsFolderTree
+ *
+ * Gets the #GDataDocumentsFolderTree:service property.
+ *
+ * Return value: (transfer none): the service the folders are crawled with
+ *
+ * Since: 0.15.0
+ */
+GDataDocumentsService *
+gdata_documents_folder_tree_get_service (GDataDocumentsFolderTree *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_FOLDER_TREE (self), NULL);
+	return self->priv->service;
+}
+
+/* Resource IDs are of the form "folder:[untyped_resource_id]" (or "document:[untyped_resource_id]", etc.); return the portion after the colon */
+static const gchar *
+get_untyped_resource_id (const gchar *resource_id)
+{
+	const gchar *colon = strchr (resource_id, ':');
+	return (colon != NULL) ? colon + 1 : resource_id;
+}
+
+/* Extract the folder's resource ID from the URI of a parent link, or return NULL if it isn't a folder URI */
+static gchar *
+parent_uri_to_resource_id (const gchar *uri)
+{
+	const gchar *folder_id;
+	gsize length;
+
+	folder_id = strstr (uri, FOLDER_URI_PREFIX);
+	if (folder_id == NULL)
+		return NULL;
+
+	folder_id += strlen (FOLDER_URI_PREFIX);
+	length = strcspn (folder_id, "/?#");
+
+	if (length == 0)
+		return NULL;
+
+	return g_strdup_printf ("folder:%.*s", (int) length, folder_id);
+}
+
+static gboolean
+ptr_array_contains_string (GPtrArray *array, const gchar *str)
+{
+	guint i;
+
+	for (i = 0; i < array->len; i++) {
+		if (strcmp (g_ptr_array_index (array, i), str) == 0)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Record that @parent_id is a parent of @child_id. Must be called with ->mutex held. */
+static void
+add_relation (GDataDocumentsFolderTreePrivate *priv, const gchar *child_id, const gchar *parent_id)
+{
+	GPtrArray *parents, *children;
+
+	parents = g_hash_table_lookup (priv->parents, child_id);
+	if (parents == NULL) {
+		parents = g_ptr_array_new_with_free_func (g_free);
+		g_hash_table_insert (priv->parents, g_strdup (child_id), parents);
+	} else if (ptr_array_contains_string (parents, parent_id) == TRUE) {
+		return;
+	}
+
+	g_ptr_array_add (parents, g_strdup (parent_id));
+
+	children = g_hash_table_lookup (priv->children, parent_id);
+	if (children == NULL) {
+		children = g_ptr_array_new_with_free_func (g_free);
+		g_hash_table_insert (priv->children, g_strdup (parent_id), children);
+	}
+
+	g_ptr_array_add (children, g_strdup (child_id));
+}
+
+/* Add @entry to the index, with the parents from its parent links. Must be called with ->mutex held. */
+static void
+add_entry (GDataDocumentsFolderTreePrivate *priv, GDataDocumentsEntry *entry)
+{
+	const gchar *resource_id;
+	GList *links, *i;
+
+	resource_id = gdata_documents_entry_get_resource_id (entry);
+	g_hash_table_replace (priv->entries, g_strdup (resource_id), g_object_ref (entry));
+
+	links = gdata_entry_look_up_links (GDATA_ENTRY (entry), PARENT_LINK_REL);
+
+	for (i = links; i != NULL; i = i->next) {
+		gchar *parent_id = parent_uri_to_resource_id (gdata_link_get_uri (GDATA_LINK (i->data)));
+
+		if (parent_id != NULL)
+			add_relation (priv, resource_id, parent_id);
+		g_free (parent_id);
+	}
+
+	g_list_free (links);
+}
+
+typedef struct {
+	GDataDocumentsFolderTree *tree;
+	GCancellable *cancellable; /* internal; cancelled if the caller's cancellable is, or if any folder fails */
+	GAsyncQueue *results; /* CrawlResults */
+	GThreadPool *pool; /* of untyped folder IDs (owned) */
+	GHashTable *visited; /* resource IDs of the folders queued in this crawl; only touched with the tree's ->mutex held */
+} CrawlData;
+
+typedef struct {
+	guint n_folders_queued;
+	GError *error;
+} CrawlResult;
+
+typedef struct {
+	CrawlData *data;
+	gchar *folder_resource_id; /* NULL for the root folder */
+	guint n_folders_queued;
+} FolderCrawl;
+
+static void
+crawl_entry_cb (GDataEntry *entry, guint entry_key, guint entry_count, FolderCrawl *crawl)
+{
+	GDataDocumentsFolderTreePrivate *priv = crawl->data->tree->priv;
+	const gchar *resource_id;
+
+	resource_id = gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (entry));
+	if (resource_id == NULL)
+		return;
+
+	g_mutex_lock (&(priv->mutex));
+
+	add_entry (priv, GDATA_DOCUMENTS_ENTRY (entry));
+
+	if (crawl->folder_resource_id != NULL)
+		add_relation (priv, resource_id, crawl->folder_resource_id);
+
+	/* Queue subfolders, unless they've already been queued from another of their parents */
+	if (GDATA_IS_DOCUMENTS_FOLDER (entry) == TRUE && g_hash_table_lookup (crawl->data->visited, resource_id) == NULL) {
+		g_hash_table_insert (crawl->data->visited, g_strdup (resource_id), GINT_TO_POINTER (TRUE));
+		g_thread_pool_push (crawl->data->pool, g_strdup (get_untyped_resource_id (resource_id)), NULL);
+		crawl->n_folders_queued++;
+	}
+
+	g_mutex_unlock (&(priv->mutex));
+}
+
+static void
+crawl_folder_thread (gchar *folder_id, CrawlData *data)
+{
+	FolderCrawl crawl;
+	GDataDocumentsQuery *query;
+	GDataFeed *feed = NULL;
+	CrawlResult *result;
+	gchar *uri;
+	GError *child_error = NULL;
+
+	crawl.data = data;
+	crawl.folder_resource_id = (strcmp (folder_id, "root") != 0) ? g_strconcat ("folder:", folder_id, NULL) : NULL;
+	crawl.n_folders_queued = 0;
+
+	query = gdata_documents_query_new (NULL);
+	gdata_documents_query_set_show_folders (query, TRUE);
+	gdata_documents_query_set_folder_id (query, folder_id);
+
+	/* Each folder's pages are fetched in turn; the concurrency comes from crawling several folders at once */
+	if (g_cancellable_set_error_if_cancelled (data->cancellable, &child_error) == FALSE) {
+		uri = g_strconcat (_gdata_service_get_scheme (), "://docs.google.com/feeds/default/private/full", NULL);
+		feed = gdata_service_query_all (GDATA_SERVICE (data->tree->priv->service), gdata_documents_service_get_primary_authorization_domain (),
+		                                uri, GDATA_QUERY (query), GDATA_TYPE_DOCUMENTS_ENTRY, 1, data->cancellable,
+		                                (GDataQueryProgressCallback) crawl_entry_cb, &crawl, &child_error);
+		g_free (uri);
+	}
+
+	if (feed != NULL)
+		g_object_unref (feed);
+	g_object_unref (query);
+
+	/* Fail fast: stop crawling the other folders if this one failed */
+	if (child_error != NULL)
+		g_cancellable_cancel (data->cancellable);
+
+	result = g_slice_new (CrawlResult);
+	result->n_folders_queued = crawl.n_folders_queued;
+	result->error = child_error;
+	g_async_queue_push (data->results, result);
+
+	g_free (crawl.folder_resource_id);
+	g_free (folder_id);
+}
+
+static void
+crawl_cancelled_cb (GCancellable *cancellable, GCancellable *internal_cancellable)
+{
+	g_cancellable_cancel (internal_cancellable);
+}
+
+static gboolean
+crawl (GDataDocumentsFolderTree *self, GDataDocumentsFolder *folder, GCancellable *cancellable, GError **error)
+{
+	GDataDocumentsFolderTreePrivate *priv = self->priv;
+	CrawlData data;
+	guint n_folders_pending = 1;
+	gulong cancelled_signal = 0;
+	GError *child_error = NULL;
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (priv->service)),
+	                                               gdata_documents_service_get_primary_authorization_domain ()) == FALSE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+		                     _("You must be authenticated to query documents."));
+		return FALSE;
+	}
+
+	data.tree = self;
+	data.cancellable = g_cancellable_new ();
+	data.results = g_async_queue_new ();
+	data.visited = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) crawl_cancelled_cb, data.cancellable, NULL);
+
+	/* All the queries go to the same host, so there's no point running more at once than the service will open connections to it */
+	data.pool = g_thread_pool_new ((GFunc) crawl_folder_thread, &data,
+	                               MAX (gdata_service_get_max_connections_per_host (GDATA_SERVICE (priv->service)), 1), FALSE, NULL);
+
+	/* Start again from scratch, with the folder being crawled (if it isn't the root) */
+	g_mutex_lock (&(priv->mutex));
+
+	g_hash_table_remove_all (priv->entries);
+	g_hash_table_remove_all (priv->parents);
+	g_hash_table_remove_all (priv->children);
+
+	if (folder != NULL) {
+		const gchar *resource_id = gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (folder));
+
+		add_entry (priv, GDATA_DOCUMENTS_ENTRY (folder));
+		g_hash_table_insert (data.visited, g_strdup (resource_id), GINT_TO_POINTER (TRUE));
+		g_thread_pool_push (data.pool, g_strdup (get_untyped_resource_id (resource_id)), NULL);
+	} else {
+		g_thread_pool_push (data.pool, g_strdup ("root"), NULL);
+	}
+
+	g_mutex_unlock (&(priv->mutex));
+
+	/* Each crawled folder reports how many subfolders it queued, so we know when the whole tree's been crawled */
+	while (n_folders_pending > 0) {
+		CrawlResult *result = g_async_queue_pop (data.results);
+
+		n_folders_pending += result->n_folders_queued;
+		n_folders_pending--;
+
+		/* Prefer reporting the error which caused the other folders to be cancelled */
+		if (result->error != NULL &&
+		    (child_error == NULL || (g_error_matches (child_error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == TRUE &&
+		                             g_error_matches (result->error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == FALSE))) {
+			g_clear_error (&child_error);
+			child_error = result->error;
+			result->error = NULL;
+		}
+
+		if (result->error != NULL)
+			g_error_free (result->error);
+		g_slice_free (CrawlResult, result);
+	}
+
+	g_thread_pool_free (data.pool, FALSE, TRUE);
+
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	g_hash_table_unref (data.visited);
+	g_async_queue_unref (data.results);
+	g_object_unref (data.cancellable);
+
+	/* Report cancellation of the caller's cancellable in preference to anything else */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
+		g_clear_error (&child_error);
+		return FALSE;
+	} else if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+set_is_crawling (GDataDocumentsFolderTree *self, gboolean is_crawling)
+{
+	g_mutex_lock (&(self->priv->mutex));
+	self->priv->is_crawling = is_crawling;
+	g_mutex_unlock (&(self->priv->mutex));
+}
+
+static gboolean
+is_crawling (GDataDocumentsFolderTree *self)
+{
+	gboolean retval;
+
+	g_mutex_lock (&(self->priv->mutex));
+	retval = self->priv->is_crawling;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return retval;
+}
+
+/**
+ * gdata_documents_folder_tree_crawl:
+ * @self: a #GDataDocumentsFolderTree
+ * @folder: (allow-none): the folder to crawl, or %NULL to crawl all the user's folders
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Crawls @folder and all the folders beneath it, replacing the contents of the index with every entry found. If @folder is %NULL, the crawl starts
+ * from the user's root folder. A user must be authenticated with the #GDataDocumentsService to crawl their folders.
+ *
+ * The folders are crawled breadth-first, with the contents of several folders being queried at once (see #GDataDocumentsFolderTree), and every
+ * page of each folder's contents being fetched. Each folder is crawled only once, even if it's in more than one of the crawled folders.
+ *
+ * If any folder fails to be queried, the rest of the crawl is cancelled and the error is returned; the index will then contain the entries
+ * found up to that point. Cancellation of @cancellable is handled as for gdata_service_query().
+ *
+ * The index can't be queried while a crawl is in progress.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_folder_tree_crawl (GDataDocumentsFolderTree *self, GDataDocumentsFolder *folder, GCancellable *cancellable, GError **error)
+{
+	gboolean success;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_FOLDER_TREE (self), FALSE);
+	g_return_val_if_fail (folder == NULL || GDATA_IS_DOCUMENTS_FOLDER (folder), FALSE);
+	g_return_val_if_fail (folder == NULL || gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (folder)) != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (is_crawling (self) == FALSE, FALSE);
+
+	set_is_crawling (self, TRUE);
+	success = crawl (self, folder, cancellable, error);
+	set_is_crawling (self, FALSE);
+
+	return success;
+}
+
+static void
+crawl_thread (GSimpleAsyncResult *result, GDataDocumentsFolderTree *self, GCancellable *cancellable)
+{
+	GDataDocumentsFolder *folder = g_simple_async_result_get_op_res_gpointer (result);
+	gboolean success;
+	GError *error = NULL;
+
+	success = crawl (self, folder, cancellable, &error);
+	set_is_crawling (self, FALSE);
+
+	if (success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_documents_folder_tree_crawl_async:
+ * @self: a #GDataDocumentsFolderTree
+ * @folder: (allow-none): the folder to crawl, or %NULL to crawl all the user's folders
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the crawl is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Crawls @folder and all the folders beneath it asynchronously. @self and @folder are both reffed when this function is called, so can safely be
+ * unreffed after this function returns.
+ *
+ * For more details, see gdata_documents_folder_tree_crawl(), which is the synchronous version of this function.
+ *
+ * When the crawl is finished, @callback will be called. You can then call gdata_documents_folder_tree_crawl_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_documents_folder_tree_crawl_async (GDataDocumentsFolderTree *self, GDataDocumentsFolder *folder, GCancellable *cancellable,
+                                         GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+
+	g_return_if_fail (GDATA_IS_DOCUMENTS_FOLDER_TREE (self));
+	g_return_if_fail (folder == NULL || GDATA_IS_DOCUMENTS_FOLDER (folder));
+	g_return_if_fail (folder == NULL || gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (folder)) != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+	g_return_if_fail (is_crawling (self) == FALSE);
+
+	set_is_crawling (self, TRUE);
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_documents_folder_tree_crawl_async);
+	if (folder != NULL)
+		g_simple_async_result_set_op_res_gpointer (result, g_object_ref (folder), (GDestroyNotify) g_object_unref);
+
+	/* Disable handling of cancellation so that crawl_thread() is always called, and so the crawling flag is always unset */
+	g_simple_async_result_set_handle_cancellation (result, FALSE);
+
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) crawl_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_documents_folder_tree_crawl_finish:
+ * @self: a #GDataDocumentsFolderTree
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous crawl started with gdata_documents_folder_tree_crawl_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_folder_tree_crawl_finish (GDataDocumentsFolderTree *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_FOLDER_TREE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), gdata_documents_folder_tree_crawl_async) == TRUE, FALSE);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == TRUE)
+		return FALSE;
+
+	return TRUE;
+}
+
+/**
+ * gdata_documents_folder_tree_look_up_entry:
+ * @self: a #GDataDocumentsFolderTree
+ * @resource_id: the #GDataDocumentsEntry:resource-id of the entry to look up
+ *
+ * Looks up the entry with the given @resource_id in the index.
+ *
+ * Return value: (transfer none) (allow-none): the entry, or %NULL if it isn't in the index
+ *
+ * Since: 0.15.0
+ */
+GDataDocumentsEntry *
+gdata_documents_folder_tree_look_up_entry (GDataDocumentsFolderTree *self, const gchar *resource_id)
+{
+	GDataDocumentsEntry *entry;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_FOLDER_TREE (self), NULL);
+	g_return_val_if_fail (resource_id != NULL, NULL);
+	g_return_val_if_fail (is_crawling (self) == FALSE, NULL);
+
+	g_mutex_lock (&(self->priv->mutex));
+	entry = g_hash_table_lookup (self->priv->entries, resource_id);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return entry;
+}
+
+/**
+ * gdata_documents_folder_tree_get_entries:
+ * @self: a #GDataDocumentsFolderTree
+ *
+ * Gets all the entries in the index, in no particular order.
+ *
+ * Return value: (element-type GData.DocumentsEntry) (transfer container): a list of the entries, which must be freed with g_list_free()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_documents_folder_tree_get_entries (GDataDocumentsFolderTree *self)
+{
+	GList *entries;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_FOLDER_TREE (self), NULL);
+	g_return_val_if_fail (is_crawling (self) == FALSE, NULL);
+
+	g_mutex_lock (&(self->priv->mutex));
+	entries = g_hash_table_get_values (self->priv->entries);
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return entries;
+}
+
+/**
+ * gdata_documents_folder_tree_get_children:
+ * @self: a #GDataDocumentsFolderTree
+ * @folder_resource_id: (allow-none): the #GDataDocumentsEntry:resource-id of a folder, or %NULL for the root folder
+ *
+ * Gets the entries in the index which are directly in the given folder. If @folder_resource_id is %NULL, the entries in the index which aren't in
+ * any folder are returned.
+ *
+ * Return value: (element-type GData.DocumentsEntry) (transfer container): a list of the entries, which must be freed with g_list_free()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_documents_folder_tree_get_children (GDataDocumentsFolderTree *self, const gchar *folder_resource_id)
+{
+	GDataDocumentsFolderTreePrivate *priv;
+	GList *children = NULL;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_FOLDER_TREE (self), NULL);
+	g_return_val_if_fail (is_crawling (self) == FALSE, NULL);
+
+	priv = self->priv;
+	g_mutex_lock (&(priv->mutex));
+
+	if (folder_resource_id != NULL) {
+		GPtrArray *child_ids = g_hash_table_lookup (priv->children, folder_resource_id);
+		guint i;
+
+		for (i = 0; child_ids != NULL && i < child_ids->len; i++) {
+			GDataDocumentsEntry *entry = g_hash_table_lookup (priv->entries, g_ptr_array_index (child_ids, i));
+
+			if (entry != NULL)
+				children = g_list_prepend (children, entry);
+		}
+
+		children = g_list_reverse (children);
+	} else {
+		GHashTableIter iter;
+		const gchar *resource_id;
+		GDataDocumentsEntry *entry;
+
+		g_hash_table_iter_init (&iter, priv->entries);
+		while (g_hash_table_iter_next (&iter, (gpointer*) &resource_id, (gpointer*) &entry) == TRUE) {
+			if (g_hash_table_lookup (priv->parents, resource_id) == NULL)
+				children = g_list_prepend (children, entry);
+		}
+	}
+
+	g_mutex_unlock (&(priv->mutex));
+
+	return children;
+}
+
+/**
+ * gdata_documents_folder_tree_get_parents:
+ * @self: a #GDataDocumentsFolderTree
+ * @resource_id: the #GDataDocumentsEntry:resource-id of an entry
+ *
+ * Gets the folders which directly contain the given entry. Only folders which are in the index are returned.
+ *
+ * Return value: (element-type GData.DocumentsFolder) (transfer container): a list of the folders, which must be freed with g_list_free()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_documents_folder_tree_get_parents (GDataDocumentsFolderTree *self, const gchar *resource_id)
+{
+	GDataDocumentsFolderTreePrivate *priv;
+	GPtrArray *parent_ids;
+	GList *parents = NULL;
+	guint i;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_FOLDER_TREE (self), NULL);
+	g_return_val_if_fail (resource_id != NULL, NULL);
+	g_return_val_if_fail (is_crawling (self) == FALSE, NULL);
+
+	priv = self->priv;
+	g_mutex_lock (&(priv->mutex));
+
+	parent_ids = g_hash_table_lookup (priv->parents, resource_id);
+
+	for (i = 0; parent_ids != NULL && i < parent_ids->len; i++) {
+		GDataDocumentsEntry *parent = g_hash_table_lookup (priv->entries, g_ptr_array_index (parent_ids, i));
+
+		if (parent != NULL)
+			parents = g_list_prepend (parents, parent);
+	}
+
+	g_mutex_unlock (&(priv->mutex));
+
+	return g_list_reverse (parents);
+}
+
+/**
+ * gdata_documents_folder_tree_get_path:
+ * @self: a #GDataDocumentsFolderTree
+ * @resource_id: the #GDataDocumentsEntry:resource-id of an entry
+ *
+ * Builds a path for the given entry from the index, in the same format as gdata_documents_entry_get_path(): starting from the root, then
+ * traversing the folders containing the entry, and ending with the entry's untyped resource ID. Unlike gdata_documents_entry_get_path(), every
+ * ancestor folder is included, rather than just the entry's immediate parents. If an entry is in more than one folder, its first parent is
+ * followed. The path stops at the first folder whose parents aren't known.
+ *
+ * An example path would be: <literal>/folder_id1/folder_id2/document_id</literal>.
+ *
+ * Return value: (allow-none): the path to the entry, or %NULL if it isn't in the index; free with g_free()
+ *
+ * Since: 0.15.0
+ */
+gchar *
+gdata_documents_folder_tree_get_path (GDataDocumentsFolderTree *self, const gchar *resource_id)
+{
+	GDataDocumentsFolderTreePrivate *priv;
+	GPtrArray *ancestors;
+	GString *path;
+	const gchar *current_id;
+	gint i;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_FOLDER_TREE (self), NULL);
+	g_return_val_if_fail (resource_id != NULL, NULL);
+	g_return_val_if_fail (is_crawling (self) == FALSE, NULL);
+
+	priv = self->priv;
+	g_mutex_lock (&(priv->mutex));
+
+	if (g_hash_table_lookup (priv->entries, resource_id) == NULL) {
+		g_mutex_unlock (&(priv->mutex));
+		return NULL;
+	}
+
+	/* Walk up the tree; the folder hierarchy shouldn't contain cycles, but guard against them anyway */
+	ancestors = g_ptr_array_new ();
+	current_id = resource_id;
+
+	while (TRUE) {
+		GPtrArray *parent_ids = g_hash_table_lookup (priv->parents, current_id);
+
+		if (parent_ids == NULL || parent_ids->len == 0 || ptr_array_contains_string (ancestors, g_ptr_array_index (parent_ids, 0)) == TRUE)
+			break;
+
+		current_id = g_ptr_array_index (parent_ids, 0);
+		if (strcmp (current_id, resource_id) == 0)
+			break;
+
+		g_ptr_array_add (ancestors, (gpointer) current_id);
+	}
+
+	path = g_string_new ("/");
+
+	for (i = ancestors->len - 1; i >= 0; i--) {
+		g_string_append (path, get_untyped_resource_id (g_ptr_array_index (ancestors, i)));
+		g_string_append_c (path, '/');
+	}
+
+	g_string_append (path, get_untyped_resource_id (resource_id));
+
+	g_mutex_unlock (&(priv->mutex));
+	g_ptr_array_unref (ancestors);
+
+	return g_string_free (path, FALSE);
+}
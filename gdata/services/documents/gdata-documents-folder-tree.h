@@ -0,0 +1,86 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_DOCUMENTS_FOLDER_TREE_H
+#define GDATA_DOCUMENTS_FOLDER_TREE_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/services/documents/gdata-documents-service.h>
+#include <gdata/services/documents/gdata-documents-entry.h>
+#include <gdata/services/documents/gdata-documents-folder.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_DOCUMENTS_FOLDER_TREE		(gdata_documents_folder_tree_get_type ())
+#define GDATA_DOCUMENTS_FOLDER_TREE(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_DOCUMENTS_FOLDER_TREE, GDataDocumentsFolderTree))
+#define GDATA_DOCUMENTS_FOLDER_TREE_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_DOCUMENTS_FOLDER_TREE, GDataDocumentsFolderTreeClass))
+#define GDATA_IS_DOCUMENTS_FOLDER_TREE(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_DOCUMENTS_FOLDER_TREE))
+#define GDATA_IS_DOCUMENTS_FOLDER_TREE_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_DOCUMENTS_FOLDER_TREE))
+#define GDATA_DOCUMENTS_FOLDER_TREE_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_DOCUMENTS_FOLDER_TREE, GDataDocumentsFolderTreeClass))
+
+typedef struct _GDataDocumentsFolderTreePrivate	GDataDocumentsFolderTreePrivate;
+
+/**
+ * GDataDocumentsFolderTree:
+ *
+ * All the fields in the #GDataDocumentsFolderTree structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataDocumentsFolderTreePrivate *priv;
+} GDataDocumentsFolderTree;
+
+/**
+ * GDataDocumentsFolderTreeClass:
+ *
+ * All the fields in the #GDataDocumentsFolderTreeClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataDocumentsFolderTreeClass;
+
+GType gdata_documents_folder_tree_get_type (void) G_GNUC_CONST;
+
+GDataDocumentsFolderTree *gdata_documents_folder_tree_new (GDataDocumentsService *service) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataDocumentsService *gdata_documents_folder_tree_get_service (GDataDocumentsFolderTree *self) G_GNUC_PURE;
+
+gboolean gdata_documents_folder_tree_crawl (GDataDocumentsFolderTree *self, GDataDocumentsFolder *folder, GCancellable *cancellable,
+                                            GError **error);
+void gdata_documents_folder_tree_crawl_async (GDataDocumentsFolderTree *self, GDataDocumentsFolder *folder, GCancellable *cancellable,
+                                              GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_documents_folder_tree_crawl_finish (GDataDocumentsFolderTree *self, GAsyncResult *async_result, GError **error);
+
+GDataDocumentsEntry *gdata_documents_folder_tree_look_up_entry (GDataDocumentsFolderTree *self, const gchar *resource_id);
+GList *gdata_documents_folder_tree_get_entries (GDataDocumentsFolderTree *self) G_GNUC_WARN_UNUSED_RESULT;
+GList *gdata_documents_folder_tree_get_children (GDataDocumentsFolderTree *self, const gchar *folder_resource_id) G_GNUC_WARN_UNUSED_RESULT;
+GList *gdata_documents_folder_tree_get_parents (GDataDocumentsFolderTree *self, const gchar *resource_id) G_GNUC_WARN_UNUSED_RESULT;
+gchar *gdata_documents_folder_tree_get_path (GDataDocumentsFolderTree *self, const gchar *resource_id) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+G_END_DECLS
+
+#endif /* !GDATA_DOCUMENTS_FOLDER_TREE_H */
@@ -104,8 +104,10 @@ struct _GDataDocumentsQueryPrivate {
 	gboolean show_deleted;
 	gboolean show_folders;
 	gboolean exact_title;
+	gboolean expand_acl;
 	gchar *folder_id;
 	gchar *title;
+	gchar *order_by;
 	GList *collaborator_addresses; /* GDataGDEmailAddress */
 	GList *reader_addresses; /* GDataGDEmailAddress */
 };
@@ -115,7 +117,9 @@ enum {
 	PROP_SHOW_FOLDERS,
 	PROP_EXACT_TITLE,
 	PROP_FOLDER_ID,
-	PROP_TITLE
+	PROP_TITLE,
+	PROP_EXPAND_ACL,
+	PROP_ORDER_BY
 };
 
 G_DEFINE_TYPE (GDataDocumentsQuery, gdata_documents_query, GDATA_TYPE_QUERY)
@@ -200,6 +204,37 @@ gdata_documents_query_class_init (GDataDocumentsQueryClass *klass)
 	                                                      "Title", "A title (or title fragment) to be searched for.",
 	                                                      NULL,
 	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDocumentsQuery:expand-acl:
+	 *
+	 * Specifies whether each returned document's access control list should be included inline in its entry. The rules can then be retrieved
+	 * with gdata_documents_entry_get_access_rules(), rather than with a separate request per document to gdata_access_handler_get_rules().
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_EXPAND_ACL,
+	                                 g_param_spec_boolean ("expand-acl",
+	                                                       "Expand ACL?", "Specifies whether documents' access control lists are included inline.",
+	                                                       FALSE,
+	                                                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDocumentsQuery:order-by:
+	 *
+	 * Specifies how to sort the returned documents: by <literal>last-modified</literal> or <literal>last-viewed</literal> time (most recent
+	 * first), or by <literal>title</literal>. If this is %NULL, the server's default order is used.
+	 *
+	 * For more information, see the <ulink type="http"
+	 * url="https://developers.google.com/google-apps/documents-list/#sorting_the_documents_list">online documentation</ulink>.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_ORDER_BY,
+	                                 g_param_spec_string ("order-by",
+	                                                      "Order by", "Specifies how to sort the returned documents.",
+	                                                      NULL,
+	                                                      G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -234,6 +269,7 @@ gdata_documents_query_finalize (GObject *object)
 
 	g_free (priv->folder_id);
 	g_free (priv->title);
+	g_free (priv->order_by);
 
 	G_OBJECT_CLASS (gdata_documents_query_parent_class)->finalize (object);
 }
@@ -259,6 +295,12 @@ gdata_documents_query_get_property (GObject *object, guint property_id, GValue *
 		case PROP_TITLE:
 			g_value_set_string (value, priv->title);
 			break;
+		case PROP_EXPAND_ACL:
+			g_value_set_boolean (value, priv->expand_acl);
+			break;
+		case PROP_ORDER_BY:
+			g_value_set_string (value, priv->order_by);
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -287,6 +329,12 @@ gdata_documents_query_set_property (GObject *object, guint property_id, const GV
 		case PROP_TITLE:
 			gdata_documents_query_set_title (self, g_value_get_string (value), TRUE);
 			break;
+		case PROP_EXPAND_ACL:
+			gdata_documents_query_set_expand_acl (self, g_value_get_boolean (value));
+			break;
+		case PROP_ORDER_BY:
+			gdata_documents_query_set_order_by (self, g_value_get_string (value));
+			break;
 		default:
 			/* We don't have any other property... */
 			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
@@ -353,6 +401,14 @@ get_query_uri (GDataQuery *self, const gchar *feed_uri, GString *query_uri, gboo
 		g_string_append (query_uri, "&showfolders=true");
 	else
 		g_string_append (query_uri, "&showfolders=false");
+
+	if (priv->expand_acl == TRUE)
+		g_string_append (query_uri, "&expand-acl=true");
+
+	if (priv->order_by != NULL) {
+		g_string_append (query_uri, "&orderby=");
+		g_string_append_uri_escaped (query_uri, priv->order_by, NULL, FALSE);
+	}
 }
 
 /**
@@ -656,3 +712,81 @@ gdata_documents_query_add_collaborator (GDataDocumentsQuery *self, const gchar *
 	/* Our current ETag will no longer be relevant */
 	gdata_query_set_etag (GDATA_QUERY (self), NULL);
 }
+
+/**
+ * gdata_documents_query_get_expand_acl:
+ * @self: a #GDataDocumentsQuery
+ *
+ * Gets the #GDataDocumentsQuery:expand-acl property.
+ *
+ * Return value: %TRUE if documents' access control lists are included inline, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_query_get_expand_acl (GDataDocumentsQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_QUERY (self), FALSE);
+	return self->priv->expand_acl;
+}
+
+/**
+ * gdata_documents_query_set_expand_acl:
+ * @self: a #GDataDocumentsQuery
+ * @expand_acl: %TRUE to include documents' access control lists inline, %FALSE otherwise
+ *
+ * Sets the #GDataDocumentsQuery:expand-acl property to @expand_acl.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_documents_query_set_expand_acl (GDataDocumentsQuery *self, gboolean expand_acl)
+{
+	g_return_if_fail (GDATA_IS_DOCUMENTS_QUERY (self));
+	self->priv->expand_acl = expand_acl;
+	g_object_notify (G_OBJECT (self), "expand-acl");
+
+	/* Our current ETag will no longer be relevant */
+	gdata_query_set_etag (GDATA_QUERY (self), NULL);
+}
+
+/**
+ * gdata_documents_query_get_order_by:
+ * @self: a #GDataDocumentsQuery
+ *
+ * Gets the #GDataDocumentsQuery:order-by property.
+ *
+ * Return value: the order of the returned documents, or %NULL if it's the server's default
+ *
+ * Since: 0.15.0
+ */
+const gchar *
+gdata_documents_query_get_order_by (GDataDocumentsQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_QUERY (self), NULL);
+	return self->priv->order_by;
+}
+
+/**
+ * gdata_documents_query_set_order_by:
+ * @self: a #GDataDocumentsQuery
+ * @order_by: (allow-none): the new order of the returned documents, or %NULL
+ *
+ * Sets the #GDataDocumentsQuery:order-by property to @order_by.
+ *
+ * Set @order_by to %NULL to use the server's default order.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_documents_query_set_order_by (GDataDocumentsQuery *self, const gchar *order_by)
+{
+	g_return_if_fail (GDATA_IS_DOCUMENTS_QUERY (self));
+
+	g_free (self->priv->order_by);
+	self->priv->order_by = g_strdup (order_by);
+	g_object_notify (G_OBJECT (self), "order-by");
+
+	/* Our current ETag will no longer be relevant */
+	gdata_query_set_etag (GDATA_QUERY (self), NULL);
+}
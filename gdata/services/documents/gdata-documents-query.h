@@ -81,6 +81,10 @@ GList *gdata_documents_query_get_collaborator_addresses (GDataDocumentsQuery *se
 GList *gdata_documents_query_get_reader_addresses (GDataDocumentsQuery *self) G_GNUC_PURE;
 void gdata_documents_query_add_reader (GDataDocumentsQuery *self, const gchar *email_address);
 void gdata_documents_query_add_collaborator (GDataDocumentsQuery *self, const gchar *email_address);
+gboolean gdata_documents_query_get_expand_acl (GDataDocumentsQuery *self) G_GNUC_PURE;
+void gdata_documents_query_set_expand_acl (GDataDocumentsQuery *self, gboolean expand_acl);
+const gchar *gdata_documents_query_get_order_by (GDataDocumentsQuery *self) G_GNUC_PURE;
+void gdata_documents_query_set_order_by (GDataDocumentsQuery *self, const gchar *order_by);
 
 G_END_DECLS
 
@@ -522,6 +522,238 @@ gdata_documents_service_query_documents_async (GDataDocumentsService *self, GDat
 	g_free (request_uri);
 }
 
+static gchar *
+_query_changes_build_request_uri (gint64 start_changestamp)
+{
+	if (start_changestamp <= 0) {
+		return g_strconcat (_gdata_service_get_scheme (), "://docs.google.com/feeds/default/private/changes", NULL);
+	}
+
+	return g_strdup_printf ("%s://docs.google.com/feeds/default/private/changes?start-index=%" G_GINT64_FORMAT,
+	                        _gdata_service_get_scheme (), start_changestamp);
+}
+
+/**
+ * gdata_documents_service_query_changes:
+ * @self: a #GDataDocumentsService
+ * @start_changestamp: the changestamp of the first change to return, or <code class="literal">-1</code> to return all changes
+ * @query: (allow-none): a #GDataQuery with additional query parameters, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @progress_callback: (allow-none) (scope call) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
+ * @progress_user_data: (closure): data to pass to the @progress_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Queries the service's changes feed for all changes to the user's documents with a changestamp of @start_changestamp or greater, in increasing
+ * changestamp order. Each document appears at most once, with the changestamp of its most recent change (see
+ * #GDataDocumentsEntry:changestamp); documents which have been permanently deleted or unshared from the user are returned with
+ * #GDataDocumentsEntry:is-removed set. The returned feed's #GDataDocumentsFeed:largest-changestamp gives the cursor to pass (plus one) as
+ * @start_changestamp to a later call in order to only fetch subsequent changes.
+ *
+ * @query may be used to set generic parameters such as #GDataQuery:max-results, and to paginate through the changes with
+ * gdata_query_next_page(). Its #GDataQuery:start-index is superseded by @start_changestamp, so should not be set. Note that @query must not be a
+ * #GDataDocumentsQuery, as the changes feed can't be restricted to a folder.
+ *
+ * For more details, see gdata_service_query().
+ *
+ * Return value: (transfer full): a #GDataDocumentsFeed of changed documents; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataDocumentsFeed *
+gdata_documents_service_query_changes (GDataDocumentsService *self, gint64 start_changestamp, GDataQuery *query, GCancellable *cancellable,
+                                       GDataQueryProgressCallback progress_callback, gpointer progress_user_data, GError **error)
+{
+	GDataFeed *feed;
+	gchar *request_uri;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SERVICE (self), NULL);
+	g_return_val_if_fail (query == NULL || (GDATA_IS_QUERY (query) && !GDATA_IS_DOCUMENTS_QUERY (query)), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (self)),
+	                                               get_documents_authorization_domain ()) == FALSE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+		                     _("You must be authenticated to query documents."));
+		return NULL;
+	}
+
+	request_uri = _query_changes_build_request_uri (start_changestamp);
+	feed = gdata_service_query (GDATA_SERVICE (self), get_documents_authorization_domain (), request_uri, query,
+	                            GDATA_TYPE_DOCUMENTS_ENTRY, cancellable, progress_callback, progress_user_data, error);
+	g_free (request_uri);
+
+	return GDATA_DOCUMENTS_FEED (feed);
+}
+
+/**
+ * gdata_documents_service_query_changes_async:
+ * @self: a #GDataDocumentsService
+ * @start_changestamp: the changestamp of the first change to return, or <code class="literal">-1</code> to return all changes
+ * @query: (allow-none): a #GDataQuery with additional query parameters, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @progress_callback: (allow-none) (closure progress_user_data): a #GDataQueryProgressCallback to call when an entry is loaded, or %NULL
+ * @progress_user_data: (closure): data to pass to the @progress_callback function
+ * @destroy_progress_user_data: (allow-none): the function to call when @progress_callback will not be called any more, or %NULL. This function will be
+ * called with @progress_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the query is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Queries the service's changes feed for all changes to the user's documents with a changestamp of @start_changestamp or greater. @self and
+ * @query are both reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_documents_service_query_changes(), which is the synchronous version of this function,
+ * and gdata_service_query_async(), which is the base asynchronous query function.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_documents_service_query_changes_async (GDataDocumentsService *self, gint64 start_changestamp, GDataQuery *query, GCancellable *cancellable,
+                                             GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                                             GDestroyNotify destroy_progress_user_data,
+                                             GAsyncReadyCallback callback, gpointer user_data)
+{
+	gchar *request_uri;
+
+	g_return_if_fail (GDATA_IS_DOCUMENTS_SERVICE (self));
+	g_return_if_fail (query == NULL || (GDATA_IS_QUERY (query) && !GDATA_IS_DOCUMENTS_QUERY (query)));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (self)),
+	                                               get_documents_authorization_domain ()) == FALSE) {
+		GSimpleAsyncResult *result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_service_query_async);
+		g_simple_async_result_set_error (result, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED, "%s",
+		                                 _("You must be authenticated to query documents."));
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+
+		return;
+	}
+
+	request_uri = _query_changes_build_request_uri (start_changestamp);
+	gdata_service_query_async (GDATA_SERVICE (self), get_documents_authorization_domain (), request_uri, query,
+	                           GDATA_TYPE_DOCUMENTS_ENTRY, cancellable, progress_callback, progress_user_data,
+	                           destroy_progress_user_data, callback, user_data);
+	g_free (request_uri);
+}
+
+/**
+ * gdata_documents_service_query_top_documents:
+ * @self: a #GDataDocumentsService
+ * @queries: (element-type GData.DocumentsQuery): a list of #GDataDocumentsQuery<!-- -->s, one for each source of documents (such as a folder, by
+ * setting #GDataDocumentsQuery:folder-id)
+ * @n_documents: the number of documents to return; must be greater than <code class="literal">0</code>
+ * @compare_func: (scope call) (closure compare_user_data): a function which returns a negative number if its first document ranks higher than its
+ * second, a positive number if it ranks lower, or <code class="literal">0</code> if they rank equally
+ * @compare_user_data: data to pass to @compare_func
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Finds the @n_documents highest-ranking documents across several queries for documents, as returned by
+ * gdata_documents_service_query_documents() for each of them. Each query must have the server return its documents in the order defined by
+ * @compare_func (see #GDataDocumentsQuery:order-by); each source is only paged through until its documents can no longer make the cut.
+ *
+ * For more details, see gdata_service_query_top_entries().
+ *
+ * Return value: (transfer full) (element-type GData.DocumentsEntry): the highest-ranking documents, best first; free with g_list_free_full() and
+ * g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GList *
+gdata_documents_service_query_top_documents (GDataDocumentsService *self, GList *queries, guint n_documents, GCompareDataFunc compare_func,
+                                             gpointer compare_user_data, GCancellable *cancellable, GError **error)
+{
+	GList *documents;
+	gchar *request_uri;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SERVICE (self), NULL);
+	g_return_val_if_fail (queries != NULL, NULL);
+	g_return_val_if_fail (n_documents > 0, NULL);
+	g_return_val_if_fail (compare_func != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (self)),
+	                                               get_documents_authorization_domain ()) == FALSE) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+		                     _("You must be authenticated to query documents."));
+		return NULL;
+	}
+
+	/* Each query's folder ID is applied by gdata_documents_query_get_query_uri(), so the base URI is the same for all of them */
+	request_uri = _query_documents_build_request_uri (NULL);
+	documents = gdata_service_query_top_entries (GDATA_SERVICE (self), get_documents_authorization_domain (), request_uri, queries,
+	                                             GDATA_TYPE_DOCUMENTS_ENTRY, n_documents, compare_func, compare_user_data, cancellable, error);
+	g_free (request_uri);
+
+	return documents;
+}
+
+/**
+ * gdata_documents_service_query_top_documents_async:
+ * @self: a #GDataDocumentsService
+ * @queries: (element-type GData.DocumentsQuery): a list of #GDataDocumentsQuery<!-- -->s, one for each source of documents
+ * @n_documents: the number of documents to return; must be greater than <code class="literal">0</code>
+ * @compare_func: (scope notified) (closure compare_user_data): a function which returns a negative number if its first document ranks higher than
+ * its second, a positive number if it ranks lower, or <code class="literal">0</code> if they rank equally
+ * @compare_user_data: data to pass to @compare_func
+ * @destroy_compare_user_data: (allow-none): the function to call when @compare_func will not be called any more, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the queries are finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Finds the @n_documents highest-ranking documents across several queries for documents. @self is reffed and @queries are copied when this function
+ * is called, so can safely be freed after this function returns.
+ *
+ * For more details, see gdata_documents_service_query_top_documents(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_query_top_entries_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_documents_service_query_top_documents_async (GDataDocumentsService *self, GList *queries, guint n_documents, GCompareDataFunc compare_func,
+                                                   gpointer compare_user_data, GDestroyNotify destroy_compare_user_data,
+                                                   GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	gchar *request_uri;
+
+	g_return_if_fail (GDATA_IS_DOCUMENTS_SERVICE (self));
+	g_return_if_fail (queries != NULL);
+	g_return_if_fail (n_documents > 0);
+	g_return_if_fail (compare_func != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	/* Ensure we're authenticated first */
+	if (gdata_authorizer_is_authorized_for_domain (gdata_service_get_authorizer (GDATA_SERVICE (self)),
+	                                               get_documents_authorization_domain ()) == FALSE) {
+		GSimpleAsyncResult *result = g_simple_async_result_new (G_OBJECT (self), callback, user_data,
+		                                                        gdata_service_query_top_entries_async);
+		g_simple_async_result_set_error (result, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED, "%s",
+		                                 _("You must be authenticated to query documents."));
+		g_simple_async_result_complete_in_idle (result);
+		g_object_unref (result);
+
+		if (destroy_compare_user_data != NULL)
+			destroy_compare_user_data (compare_user_data);
+
+		return;
+	}
+
+	request_uri = _query_documents_build_request_uri (NULL);
+	gdata_service_query_top_entries_async (GDATA_SERVICE (self), get_documents_authorization_domain (), request_uri, queries,
+	                                       GDATA_TYPE_DOCUMENTS_ENTRY, n_documents, compare_func, compare_user_data,
+	                                       destroy_compare_user_data, cancellable, callback, user_data);
+	g_free (request_uri);
+}
+
 static GDataUploadStream *
 upload_update_document (GDataDocumentsService *self, GDataDocumentsDocument *document, const gchar *slug, const gchar *content_type,
                         goffset content_length, const gchar *method, const gchar *upload_uri, GCancellable *cancellable)
@@ -697,6 +929,150 @@ gdata_documents_service_upload_document_resumable (GDataDocumentsService *self,
 	return upload_stream;
 }
 
+/* Files at least this big are uploaded using the resumable protocol; below it, the extra round trip needed to open a resumable session costs more
+ * than restarting a failed upload would. */
+#define RESUMABLE_UPLOAD_THRESHOLD (512 * 1024) /* bytes */
+
+/**
+ * gdata_documents_service_upload_file:
+ * @self: an authenticated #GDataDocumentsService
+ * @document: (allow-none): the #GDataDocumentsDocument to insert, or %NULL
+ * @file: the file to upload
+ * @slug: (allow-none): the filename to give to the uploaded document, or %NULL to use the display name of @file
+ * @content_type: (allow-none): the content type of @file, or %NULL to guess it
+ * @query: (allow-none): a query specifying parameters for the upload, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Uploads the contents of @file to Google Documents, using the properties from @document, and returns the uploaded document. Unlike
+ * gdata_documents_service_upload_document() and gdata_documents_service_upload_document_resumable(), the caller doesn't need to write the data or
+ * know its length: @file is queried for its size (and, if not given, its display name and content type), and the best kind of upload is chosen
+ * automatically.
+ *
+ * Files of 512 KiB or more, and all files uploaded with a @query, are uploaded using the resumable protocol, so transmission errors don't require
+ * the whole file to be sent again; the #GDataUploadStream:adaptive-chunk-size of the upload is enabled, so its chunk size tracks the throughput of
+ * the connection. Local files are memory-mapped and uploaded without being copied, as with gdata_upload_stream_new_resumable_from_file(). Smaller
+ * files are uploaded in a single request, as by gdata_documents_service_upload_document().
+ *
+ * For details of @document and @query, see gdata_documents_service_upload_document_resumable(). Errors from querying or reading @file are in the
+ * %G_IO_ERROR domain; upload errors may come from the #GDataServiceError domain.
+ *
+ * Return value: (transfer full): the uploaded #GDataDocumentsDocument, or %NULL; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataDocumentsDocument *
+gdata_documents_service_upload_file (GDataDocumentsService *self, GDataDocumentsDocument *document, GFile *file, const gchar *slug,
+                                     const gchar *content_type, GDataDocumentsUploadQuery *query, GCancellable *cancellable, GError **error)
+{
+	GFileInfo *file_info;
+	GDataUploadStream *upload_stream = NULL;
+	GDataDocumentsDocument *new_document = NULL;
+	gchar *guessed_content_type = NULL;
+	goffset content_length;
+	gboolean resumable, is_mapped = FALSE;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SERVICE (self), NULL);
+	g_return_val_if_fail (document == NULL || GDATA_IS_DOCUMENTS_DOCUMENT (document), NULL);
+	g_return_val_if_fail (G_IS_FILE (file), NULL);
+	g_return_val_if_fail (query == NULL || GDATA_IS_DOCUMENTS_UPLOAD_QUERY (query), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (_upload_checks (self, document, error) == FALSE) {
+		return NULL;
+	}
+
+	file_info = g_file_query_info (file, G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ","
+	                               G_FILE_ATTRIBUTE_STANDARD_SIZE, G_FILE_QUERY_INFO_NONE, cancellable, error);
+	if (file_info == NULL) {
+		return NULL;
+	}
+
+	content_length = g_file_info_get_size (file_info);
+
+	if (slug == NULL) {
+		slug = g_file_info_get_display_name (file_info);
+	}
+
+	if (content_type == NULL) {
+		guessed_content_type = g_content_type_get_mime_type (g_file_info_get_content_type (file_info));
+		content_type = (guessed_content_type != NULL) ? guessed_content_type : "application/octet-stream";
+	}
+
+	/* The non-resumable upload URI doesn't support any of the query parameters */
+	resumable = (content_length >= RESUMABLE_UPLOAD_THRESHOLD || query != NULL);
+
+	if (resumable == TRUE) {
+		gchar *path, *upload_uri;
+
+		/* Upload local files straight from a mapping of them, rather than copying them through the stream */
+		path = g_file_get_path (file);
+		is_mapped = (path != NULL);
+		g_free (path);
+
+		if (is_mapped == TRUE) {
+			/* HACK: As in upload_update_document(), correct the content type for ODF spreadsheets */
+			if (strcmp (content_type, "application/vnd.oasis.opendocument.spreadsheet") == 0)
+				content_type = "application/x-vnd.oasis.opendocument.spreadsheet";
+
+			upload_uri = _get_upload_uri_for_query_and_folder (query, NULL);
+			upload_stream = GDATA_UPLOAD_STREAM (gdata_upload_stream_new_resumable_from_file (GDATA_SERVICE (self),
+			                                                                                  get_documents_authorization_domain (),
+			                                                                                  SOUP_METHOD_POST, upload_uri,
+			                                                                                  GDATA_ENTRY (document), slug, content_type,
+			                                                                                  file, cancellable, error));
+			g_free (upload_uri);
+		} else {
+			upload_stream = gdata_documents_service_upload_document_resumable (self, document, slug, content_type, content_length, query,
+			                                                                   cancellable, error);
+		}
+
+		if (upload_stream != NULL) {
+			gdata_upload_stream_set_adaptive_chunk_size (upload_stream, TRUE);
+		}
+	} else {
+		upload_stream = gdata_documents_service_upload_document (self, document, slug, content_type, NULL, cancellable, error);
+	}
+
+	g_free (guessed_content_type);
+	g_object_unref (file_info);
+
+	if (upload_stream == NULL) {
+		return NULL;
+	}
+
+	if (is_mapped == TRUE) {
+		/* Closing the stream performs the upload from the mapping */
+		if (g_output_stream_close (G_OUTPUT_STREAM (upload_stream), cancellable, error) == FALSE) {
+			goto done;
+		}
+	} else {
+		GFileInputStream *input_stream;
+		gssize n_spliced;
+
+		input_stream = g_file_read (file, cancellable, error);
+		if (input_stream == NULL) {
+			goto done;
+		}
+
+		n_spliced = g_output_stream_splice (G_OUTPUT_STREAM (upload_stream), G_INPUT_STREAM (input_stream),
+		                                    G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE | G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET, cancellable, error);
+		g_object_unref (input_stream);
+
+		if (n_spliced == -1) {
+			goto done;
+		}
+	}
+
+	new_document = gdata_documents_service_finish_upload (self, upload_stream, error);
+
+done:
+	g_object_unref (upload_stream);
+
+	return new_document;
+}
+
 static gboolean
 _update_checks (GDataDocumentsService *self, GError **error)
 {
@@ -1421,6 +1797,398 @@ gdata_documents_service_remove_entry_from_folder_finish (GDataDocumentsService *
 	g_assert_not_reached ();
 }
 
+typedef struct {
+	GDataDocumentsService *service;
+	GDataDocumentsFolder *from_folder;
+	GDataDocumentsFolder *to_folder;
+	GCancellable *cancellable;
+	GAsyncQueue *results; /* MoveResults */
+} MoveEntriesData;
+
+typedef struct {
+	GDataDocumentsEntry *entry;
+	GDataDocumentsEntry *moved_entry; /* the entry after being moved; NULL on failure */
+	GDataDocumentsEntry *added_entry; /* the entry after being added to the destination, if removing it from the source then failed */
+	gboolean is_undo; /* TRUE if this is rolling back a move */
+	GError *error;
+	GDataDocumentsServiceMoveCallback callback;
+	gpointer user_data;
+} MoveResult;
+
+static void
+move_result_free (MoveResult *result)
+{
+	g_object_unref (result->entry);
+	if (result->moved_entry != NULL)
+		g_object_unref (result->moved_entry);
+	if (result->added_entry != NULL)
+		g_object_unref (result->added_entry);
+	if (result->error != NULL)
+		g_error_free (result->error);
+
+	g_slice_free (MoveResult, result);
+}
+
+/* Moves @entry from @from_folder to @to_folder (either of which may be NULL). If the entry was added to @to_folder but couldn't be removed from
+ * @from_folder, the added version is returned in @added_entry so that the addition can be undone. */
+static GDataDocumentsEntry *
+move_entry (GDataDocumentsService *self, GDataDocumentsEntry *entry, GDataDocumentsFolder *from_folder, GDataDocumentsFolder *to_folder,
+            GCancellable *cancellable, GDataDocumentsEntry **added_entry, GError **error)
+{
+	GDataDocumentsEntry *new_entry, *moved_entry;
+
+	if (to_folder == NULL) {
+		return gdata_documents_service_remove_entry_from_folder (self, entry, from_folder, cancellable, error);
+	}
+
+	new_entry = gdata_documents_service_add_entry_to_folder (self, entry, to_folder, cancellable, error);
+	if (new_entry == NULL || from_folder == NULL) {
+		return new_entry;
+	}
+
+	/* The addition changes the entry's ETag, so the removal has to use the new version */
+	moved_entry = gdata_documents_service_remove_entry_from_folder (self, new_entry, from_folder, cancellable, error);
+
+	if (moved_entry == NULL) {
+		*added_entry = new_entry;
+	} else {
+		g_object_unref (new_entry);
+	}
+
+	return moved_entry;
+}
+
+static void
+move_entries_thread (MoveResult *result, MoveEntriesData *data)
+{
+	if (result->is_undo == TRUE) {
+		GDataDocumentsEntry *restored_entry, *added_entry = NULL;
+
+		/* Roll back regardless of whether the operation's been cancelled, since cancellation is one of the things being rolled back */
+		if (result->moved_entry != NULL) {
+			restored_entry = move_entry (data->service, result->moved_entry, data->to_folder, data->from_folder, NULL, &added_entry,
+			                             &(result->error));
+		} else {
+			restored_entry = gdata_documents_service_remove_entry_from_folder (data->service, result->added_entry, data->to_folder, NULL,
+			                                                                   &(result->error));
+		}
+
+		if (restored_entry != NULL)
+			g_object_unref (restored_entry);
+		if (added_entry != NULL)
+			g_object_unref (added_entry);
+	} else if (g_cancellable_set_error_if_cancelled (data->cancellable, &(result->error)) == FALSE) {
+		result->moved_entry = move_entry (data->service, result->entry, data->from_folder, data->to_folder, data->cancellable,
+		                                  &(result->added_entry), &(result->error));
+	}
+
+	g_async_queue_push (data->results, result);
+}
+
+/* Run the user-supplied callback for a move. This is designed to be used in an idle handler, so that the callback is run in the thread which
+ * started the move. */
+static gboolean
+move_result_callback_cb (MoveResult *result)
+{
+	result->callback (result->entry, result->moved_entry, result->error, result->user_data);
+	return FALSE;
+}
+
+static gboolean
+move_entries (GDataDocumentsService *self, GList *entries, GDataDocumentsFolder *from_folder, GDataDocumentsFolder *to_folder,
+              gboolean roll_back_on_failure, GCancellable *cancellable, GDataDocumentsServiceMoveCallback move_callback, gpointer move_user_data,
+              GMainContext *context, gboolean is_async, GError **error)
+{
+	MoveEntriesData data;
+	GThreadPool *pool;
+	GList *i, *moved = NULL;
+	GError *first_error = NULL;
+	guint n_pending = 0;
+
+	data.service = self;
+	data.from_folder = from_folder;
+	data.to_folder = to_folder;
+	data.cancellable = cancellable;
+	data.results = g_async_queue_new ();
+
+	/* Folder membership can't be changed using the batch protocol, so move the entries concurrently instead; each move is two requests to the
+	 * same host, so there's no point running more at once than the service has connections to it. */
+	pool = g_thread_pool_new ((GFunc) move_entries_thread, &data, MAX (gdata_service_get_max_connections_per_host (GDATA_SERVICE (self)), 1),
+	                          FALSE, NULL);
+
+	for (i = entries; i != NULL; i = i->next) {
+		MoveResult *result = g_slice_new0 (MoveResult);
+		result->entry = g_object_ref (i->data);
+
+		g_thread_pool_push (pool, result, NULL);
+		n_pending++;
+	}
+
+	/* Deliver the results as they arrive. As with GDataBatchOperation, only dispatch the callbacks in the thread-default main context of the
+	 * thread which started the move if it was started with gdata_documents_service_move_entries_async(). Results are kept back if they might
+	 * need to be rolled back. */
+	for (; n_pending > 0; n_pending--) {
+		MoveResult *result = g_async_queue_pop (data.results);
+
+		if (result->error != NULL && first_error == NULL) {
+			first_error = g_error_copy (result->error);
+		}
+
+		if (move_callback != NULL) {
+			MoveResult *callback_result = result;
+
+			if (roll_back_on_failure == TRUE) {
+				/* Report a copy, so that the result itself stays around for rolling back */
+				callback_result = g_slice_new0 (MoveResult);
+				callback_result->entry = g_object_ref (result->entry);
+				callback_result->moved_entry = (result->moved_entry != NULL) ? g_object_ref (result->moved_entry) : NULL;
+				callback_result->error = (result->error != NULL) ? g_error_copy (result->error) : NULL;
+			}
+
+			callback_result->callback = move_callback;
+			callback_result->user_data = move_user_data;
+
+			if (is_async == TRUE) {
+				_gdata_service_idle_add (context, (GSourceFunc) move_result_callback_cb, callback_result,
+				                         (GDestroyNotify) move_result_free);
+			} else {
+				move_result_callback_cb (callback_result);
+				move_result_free (callback_result);
+			}
+
+			if (callback_result == result)
+				continue;
+		} else if (roll_back_on_failure == FALSE) {
+			move_result_free (result);
+			continue;
+		}
+
+		moved = g_list_prepend (moved, result);
+	}
+
+	/* Roll back, if required: move the successfully moved entries back, and remove the half-moved ones from the destination. This is best-effort;
+	 * entries which can't be moved back are left where they are. */
+	if (first_error != NULL && roll_back_on_failure == TRUE) {
+		for (i = moved; i != NULL; i = i->next) {
+			MoveResult *result = i->data;
+
+			if (result->moved_entry == NULL && result->added_entry == NULL)
+				continue;
+
+			g_clear_error (&(result->error));
+			result->is_undo = TRUE;
+
+			g_thread_pool_push (pool, result, NULL);
+			n_pending++;
+		}
+
+		for (; n_pending > 0; n_pending--) {
+			g_async_queue_pop (data.results);
+		}
+	}
+
+	g_list_free_full (moved, (GDestroyNotify) move_result_free);
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_async_queue_unref (data.results);
+
+	/* Cancellation of the whole operation is always reported; other errors are only reported here if they caused a roll back */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
+		g_clear_error (&first_error);
+		return FALSE;
+	} else if (first_error != NULL && roll_back_on_failure == TRUE) {
+		g_propagate_error (error, first_error);
+		return FALSE;
+	}
+
+	g_clear_error (&first_error);
+
+	return TRUE;
+}
+
+/**
+ * gdata_documents_service_move_entries:
+ * @self: an authenticated #GDataDocumentsService
+ * @entries: (element-type GData.DocumentsEntry): a list of #GDataDocumentsEntry<!-- -->s to move
+ * @from_folder: (allow-none): the #GDataDocumentsFolder to move the entries out of, or %NULL
+ * @to_folder: (allow-none): the #GDataDocumentsFolder to move the entries into, or %NULL
+ * @roll_back_on_failure: %TRUE to move all the entries back if any of them fails to be moved, %FALSE otherwise
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @move_callback: (allow-none) (scope call) (closure move_user_data): a #GDataDocumentsServiceMoveCallback to call when each entry has been
+ * moved, or %NULL
+ * @move_user_data: (closure): data to pass to the @move_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Moves each of the #GDataDocumentsEntry<!-- -->s in @entries from @from_folder to @to_folder, by adding it to @to_folder with
+ * gdata_documents_service_add_entry_to_folder() and then removing it from @from_folder with gdata_documents_service_remove_entry_from_folder().
+ * If @from_folder is %NULL, the entries are only added to @to_folder; if @to_folder is %NULL, they're only removed from @from_folder. At least one
+ * of the two must be non-%NULL.
+ *
+ * Folder membership can't be changed using batch operations, so instead several entries are moved concurrently (up to the
+ * #GDataService:max-connections-per-host of @self). @move_callback is called with each entry and its updated version, or the error which occurred
+ * while moving it, in the order in which the moves finish.
+ *
+ * If @roll_back_on_failure is %FALSE, errors for individual entries don't stop the others being moved, and aren't returned in @error; %FALSE is only
+ * returned if @cancellable is cancelled. If @roll_back_on_failure is %TRUE and any entry fails to be moved (including because @cancellable was
+ * cancelled), then once all the moves have finished, the entries which were moved are moved back again, and %FALSE is returned with the first
+ * error in @error. The updated entries passed to @move_callback are then out of date. Rolling back is best-effort: entries which can't be moved
+ * back are left in @to_folder.
+ *
+ * Return value: %TRUE if all the entries were moved (or attempted, if @roll_back_on_failure is %FALSE), %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_service_move_entries (GDataDocumentsService *self, GList *entries, GDataDocumentsFolder *from_folder,
+                                      GDataDocumentsFolder *to_folder, gboolean roll_back_on_failure, GCancellable *cancellable,
+                                      GDataDocumentsServiceMoveCallback move_callback, gpointer move_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (from_folder == NULL || GDATA_IS_DOCUMENTS_FOLDER (from_folder), FALSE);
+	g_return_val_if_fail (to_folder == NULL || GDATA_IS_DOCUMENTS_FOLDER (to_folder), FALSE);
+	g_return_val_if_fail (from_folder != NULL || to_folder != NULL, FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = entries; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_DOCUMENTS_ENTRY (i->data), FALSE);
+
+	return move_entries (self, entries, from_folder, to_folder, roll_back_on_failure, cancellable, move_callback, move_user_data, NULL, FALSE,
+	                     error);
+}
+
+typedef struct {
+	GList *entries;
+	GDataDocumentsFolder *from_folder;
+	GDataDocumentsFolder *to_folder;
+	gboolean roll_back_on_failure;
+	GDataDocumentsServiceMoveCallback move_callback;
+	gpointer move_user_data;
+	GDestroyNotify destroy_move_user_data;
+	GMainContext *context;
+} MoveEntriesAsyncData;
+
+static void
+move_entries_async_data_free (MoveEntriesAsyncData *data)
+{
+	g_list_free_full (data->entries, g_object_unref);
+	if (data->from_folder != NULL)
+		g_object_unref (data->from_folder);
+	if (data->to_folder != NULL)
+		g_object_unref (data->to_folder);
+
+	if (data->destroy_move_user_data != NULL)
+		data->destroy_move_user_data (data->move_user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (MoveEntriesAsyncData, data);
+}
+
+static void
+move_entries_async_thread (GSimpleAsyncResult *result, GDataDocumentsService *service, GCancellable *cancellable)
+{
+	MoveEntriesAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	if (move_entries (service, data->entries, data->from_folder, data->to_folder, data->roll_back_on_failure, cancellable, data->move_callback,
+	                  data->move_user_data, data->context, TRUE, &error) == FALSE) {
+		g_simple_async_result_take_error (result, error);
+	}
+}
+
+/**
+ * gdata_documents_service_move_entries_async:
+ * @self: an authenticated #GDataDocumentsService
+ * @entries: (element-type GData.DocumentsEntry): a list of #GDataDocumentsEntry<!-- -->s to move
+ * @from_folder: (allow-none): the #GDataDocumentsFolder to move the entries out of, or %NULL
+ * @to_folder: (allow-none): the #GDataDocumentsFolder to move the entries into, or %NULL
+ * @roll_back_on_failure: %TRUE to move all the entries back if any of them fails to be moved, %FALSE otherwise
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @move_callback: (allow-none) (closure move_user_data): a #GDataDocumentsServiceMoveCallback to call when each entry has been moved, or %NULL
+ * @move_user_data: (closure): data to pass to the @move_callback function
+ * @destroy_move_user_data: (allow-none): the function to call when @move_callback will not be called any more, or %NULL. This function will be
+ * called with @move_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the moves are finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Moves each of the #GDataDocumentsEntry<!-- -->s in @entries from @from_folder to @to_folder, calling @move_callback as the moves finish, in idle
+ * functions in the thread-default main context of the thread which called this function (see g_main_context_push_thread_default()). @self, @entries,
+ * @from_folder and @to_folder are all reffed when this function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_documents_service_move_entries(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_documents_service_move_entries_finish() to get the results of
+ * the operation. @move_callback is guaranteed to have been called for every entry before @callback is called.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_documents_service_move_entries_async (GDataDocumentsService *self, GList *entries, GDataDocumentsFolder *from_folder,
+                                            GDataDocumentsFolder *to_folder, gboolean roll_back_on_failure, GCancellable *cancellable,
+                                            GDataDocumentsServiceMoveCallback move_callback, gpointer move_user_data,
+                                            GDestroyNotify destroy_move_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	MoveEntriesAsyncData *data;
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_DOCUMENTS_SERVICE (self));
+	g_return_if_fail (from_folder == NULL || GDATA_IS_DOCUMENTS_FOLDER (from_folder));
+	g_return_if_fail (to_folder == NULL || GDATA_IS_DOCUMENTS_FOLDER (to_folder));
+	g_return_if_fail (from_folder != NULL || to_folder != NULL);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = entries; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_DOCUMENTS_ENTRY (i->data));
+
+	data = g_slice_new0 (MoveEntriesAsyncData);
+	data->entries = g_list_copy (entries);
+	g_list_foreach (data->entries, (GFunc) g_object_ref, NULL);
+	data->from_folder = (from_folder != NULL) ? g_object_ref (from_folder) : NULL;
+	data->to_folder = (to_folder != NULL) ? g_object_ref (to_folder) : NULL;
+	data->roll_back_on_failure = roll_back_on_failure;
+	data->move_callback = move_callback;
+	data->move_user_data = move_user_data;
+	data->destroy_move_user_data = destroy_move_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_documents_service_move_entries_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) move_entries_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) move_entries_async_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_documents_service_move_entries_finish:
+ * @self: a #GDataDocumentsService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous move operation started with gdata_documents_service_move_entries_async().
+ *
+ * Return value: %TRUE if all the entries were moved (or attempted, if rolling back wasn't requested), %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_service_move_entries_finish (GDataDocumentsService *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), gdata_documents_service_move_entries_async) == TRUE,
+	                      FALSE);
+
+	if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == TRUE)
+		return FALSE;
+
+	return TRUE;
+}
+
 /* HACK: Work around http://code.google.com/a/google.com/p/apps-api-issues/issues/detail?id=3033 by also using the upload URI for the v2 API. Grrr. */
 static gchar *
 _build_v2_upload_uri (GDataDocumentsFolder *folder)
@@ -93,6 +93,24 @@ void gdata_documents_service_query_documents_async (GDataDocumentsService *self,
                                                     GDestroyNotify destroy_progress_user_data,
                                                     GAsyncReadyCallback callback, gpointer user_data);
 
+GDataDocumentsFeed *gdata_documents_service_query_changes (GDataDocumentsService *self, gint64 start_changestamp, GDataQuery *query,
+                                                           GCancellable *cancellable,
+                                                           GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                                                           GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_documents_service_query_changes_async (GDataDocumentsService *self, gint64 start_changestamp, GDataQuery *query,
+                                                  GCancellable *cancellable,
+                                                  GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
+                                                  GDestroyNotify destroy_progress_user_data,
+                                                  GAsyncReadyCallback callback, gpointer user_data);
+
+GList *gdata_documents_service_query_top_documents (GDataDocumentsService *self, GList *queries, guint n_documents, GCompareDataFunc compare_func,
+                                                    gpointer compare_user_data, GCancellable *cancellable,
+                                                    GError **error) G_GNUC_WARN_UNUSED_RESULT;
+void gdata_documents_service_query_top_documents_async (GDataDocumentsService *self, GList *queries, guint n_documents,
+                                                        GCompareDataFunc compare_func, gpointer compare_user_data,
+                                                        GDestroyNotify destroy_compare_user_data, GCancellable *cancellable,
+                                                        GAsyncReadyCallback callback, gpointer user_data);
+
 #include <gdata/services/documents/gdata-documents-document.h>
 #include <gdata/services/documents/gdata-documents-folder.h>
 #include <gdata/services/documents/gdata-documents-upload-query.h>
@@ -104,6 +122,9 @@ GDataUploadStream *gdata_documents_service_upload_document_resumable (GDataDocum
                                                                       const gchar *content_type, goffset content_length,
                                                                       GDataDocumentsUploadQuery *query,
                                                                       GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GDataDocumentsDocument *gdata_documents_service_upload_file (GDataDocumentsService *self, GDataDocumentsDocument *document, GFile *file,
+                                                             const gchar *slug, const gchar *content_type, GDataDocumentsUploadQuery *query,
+                                                             GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
 GDataUploadStream *gdata_documents_service_update_document (GDataDocumentsService *self, GDataDocumentsDocument *document, const gchar *slug,
                                                             const gchar *content_type, GCancellable *cancellable,
@@ -138,6 +159,29 @@ void gdata_documents_service_remove_entry_from_folder_async (GDataDocumentsServi
 GDataDocumentsEntry *gdata_documents_service_remove_entry_from_folder_finish (GDataDocumentsService *self, GAsyncResult *async_result,
                                                                               GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
+/**
+ * GDataDocumentsServiceMoveCallback:
+ * @entry: the #GDataDocumentsEntry which was moved
+ * @moved_entry: (allow-none): the updated version of @entry after being moved, or %NULL if moving it failed
+ * @error: the error which occurred while moving @entry, or %NULL if it was moved successfully
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called once for each entry moved by gdata_documents_service_move_entries(), as soon as it has been moved. None of the
+ * parameters should be freed or unreffed by the callback; @moved_entry must be reffed if it's to be kept.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataDocumentsServiceMoveCallback) (GDataDocumentsEntry *entry, GDataDocumentsEntry *moved_entry, GError *error, gpointer user_data);
+
+gboolean gdata_documents_service_move_entries (GDataDocumentsService *self, GList *entries, GDataDocumentsFolder *from_folder,
+                                               GDataDocumentsFolder *to_folder, gboolean roll_back_on_failure, GCancellable *cancellable,
+                                               GDataDocumentsServiceMoveCallback move_callback, gpointer move_user_data, GError **error);
+void gdata_documents_service_move_entries_async (GDataDocumentsService *self, GList *entries, GDataDocumentsFolder *from_folder,
+                                                 GDataDocumentsFolder *to_folder, gboolean roll_back_on_failure, GCancellable *cancellable,
+                                                 GDataDocumentsServiceMoveCallback move_callback, gpointer move_user_data,
+                                                 GDestroyNotify destroy_move_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_documents_service_move_entries_finish (GDataDocumentsService *self, GAsyncResult *async_result, GError **error);
+
 gchar *gdata_documents_service_get_upload_uri (GDataDocumentsFolder *folder) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
 G_END_DECLS
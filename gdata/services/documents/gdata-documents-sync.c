@@ -0,0 +1,486 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-documents-sync
+ * @short_description: GData Documents incremental synchronisation
+ * @stability: Unstable
+ * @include: gdata/services/documents/gdata-documents-sync.h
+ *
+ * #GDataDocumentsSync keeps a local copy of a user's document metadata up to date by only downloading the documents which have changed since it
+ * was last run, using the changes feed (see gdata_documents_service_query_changes()), rather than listing every document.
+ *
+ * The local copy is accessed through the #GDataDocumentsSyncStore interface, which the application implements. As well as holding the documents,
+ * the store persists a <firstterm>changestamp</firstterm> cursor: the largest changestamp of any change to the user's documents at the start of
+ * the last successful synchronisation. Each run of gdata_documents_sync_run() queries for changes after the cursor, walks all the pages of
+ * results, applies them to the store, and then stores a new cursor.
+ *
+ * Each document is reported at most once per run, with its latest metadata. Documents which have been permanently deleted or unshared from the
+ * user (see #GDataDocumentsEntry:is-removed) are removed from the store; documents which have merely been moved to the trash (see
+ * #GDataDocumentsEntry:is-deleted) are applied as normal, and the store may check their state itself. Changestamps are assigned by the server,
+ * so the cursor is unaffected by skew in the local clock. If a run fails part-way through, the cursor isn't updated, and the next run will
+ * re-apply the changes.
+ *
+ * To force a full synchronisation, empty the store and have it return <code class="literal">-1</code> as its changestamp.
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-documents-sync.h"
+#include "gdata-private.h"
+
+G_DEFINE_INTERFACE (GDataDocumentsSyncStore, gdata_documents_sync_store, G_TYPE_OBJECT)
+
+static void
+gdata_documents_sync_store_default_init (GDataDocumentsSyncStoreInterface *iface)
+{
+	/* Nothing to see here */
+}
+
+static void gdata_documents_sync_dispose (GObject *object);
+static void gdata_documents_sync_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_documents_sync_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataDocumentsSyncPrivate {
+	GDataDocumentsService *service;
+	GDataDocumentsSyncStore *store;
+	guint page_size;
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_STORE,
+	PROP_PAGE_SIZE,
+};
+
+G_DEFINE_TYPE (GDataDocumentsSync, gdata_documents_sync, G_TYPE_OBJECT)
+
+static void
+gdata_documents_sync_class_init (GDataDocumentsSyncClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataDocumentsSyncPrivate));
+
+	gobject_class->get_property = gdata_documents_sync_get_property;
+	gobject_class->set_property = gdata_documents_sync_set_property;
+	gobject_class->dispose = gdata_documents_sync_dispose;
+
+	/**
+	 * GDataDocumentsSync:service:
+	 *
+	 * The service to query for changed documents.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service to query for changed documents.",
+	                                                      GDATA_TYPE_DOCUMENTS_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDocumentsSync:store:
+	 *
+	 * The local store to apply changed documents to.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_STORE,
+	                                 g_param_spec_object ("store",
+	                                                      "Store", "The local store to apply changed documents to.",
+	                                                      GDATA_TYPE_DOCUMENTS_SYNC_STORE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataDocumentsSync:page-size:
+	 *
+	 * The maximum number of changes to request in each page of results.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_PAGE_SIZE,
+	                                 g_param_spec_uint ("page-size",
+	                                                    "Page size", "The maximum number of changes to request in each page of results.",
+	                                                    1, G_MAXUINT, 100,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_documents_sync_init (GDataDocumentsSync *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_DOCUMENTS_SYNC, GDataDocumentsSyncPrivate);
+	self->priv->page_size = 100;
+}
+
+static void
+gdata_documents_sync_dispose (GObject *object)
+{
+	GDataDocumentsSyncPrivate *priv = GDATA_DOCUMENTS_SYNC (object)->priv;
+
+	g_clear_object (&priv->service);
+	g_clear_object (&priv->store);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_documents_sync_parent_class)->dispose (object);
+}
+
+static void
+gdata_documents_sync_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataDocumentsSyncPrivate *priv = GDATA_DOCUMENTS_SYNC (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_STORE:
+			g_value_set_object (value, priv->store);
+			break;
+		case PROP_PAGE_SIZE:
+			g_value_set_uint (value, priv->page_size);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_documents_sync_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataDocumentsSyncPrivate *priv = GDATA_DOCUMENTS_SYNC (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_STORE:
+			priv->store = g_value_dup_object (value);
+			break;
+		case PROP_PAGE_SIZE:
+			gdata_documents_sync_set_page_size (GDATA_DOCUMENTS_SYNC (object), g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_documents_sync_new:
+ * @service: the #GDataDocumentsService to query for changed documents
+ * @store: the #GDataDocumentsSyncStore holding the local copy of the documents
+ *
+ * Creates a new #GDataDocumentsSync, which will keep @store up to date with the documents available through @service.
+ *
+ * Return value: (transfer full): a new #GDataDocumentsSync; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataDocumentsSync *
+gdata_documents_sync_new (GDataDocumentsService *service, GDataDocumentsSyncStore *store)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SERVICE (service), NULL);
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SYNC_STORE (store), NULL);
+
+	return g_object_new (GDATA_TYPE_DOCUMENTS_SYNC, "service", service, "store", store, NULL);
+}
+
+/**
+ * gdata_documents_sync_get_service:
+ * @self: a #GDataDocumentsSync
+ *
+ * Gets the #GDataDocumentsSync:service property.
+ *
+ * Return value: (transfer none): the service to query for changed documents
+ *
+ * Since: 0.15.0
+ */
+GDataDocumentsService *
+gdata_documents_sync_get_service (GDataDocumentsSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SYNC (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_documents_sync_get_store:
+ * @self: a #GDataDocumentsSync
+ *
+ * Gets the #GDataDocumentsSync:store property.
+ *
+ * Return value: (transfer none): the local store to apply changed documents to
+ *
+ * Since: 0.15.0
+ */
+GDataDocumentsSyncStore *
+gdata_documents_sync_get_store (GDataDocumentsSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SYNC (self), NULL);
+	return self->priv->store;
+}
+
+/**
+ * gdata_documents_sync_get_page_size:
+ * @self: a #GDataDocumentsSync
+ *
+ * Gets the #GDataDocumentsSync:page-size property.
+ *
+ * Return value: the maximum number of changes requested in each page of results
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_documents_sync_get_page_size (GDataDocumentsSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SYNC (self), 0);
+	return self->priv->page_size;
+}
+
+/**
+ * gdata_documents_sync_set_page_size:
+ * @self: a #GDataDocumentsSync
+ * @page_size: the maximum number of changes to request in each page of results; must be greater than <code class="literal">0</code>
+ *
+ * Sets the #GDataDocumentsSync:page-size property.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_documents_sync_set_page_size (GDataDocumentsSync *self, guint page_size)
+{
+	g_return_if_fail (GDATA_IS_DOCUMENTS_SYNC (self));
+	g_return_if_fail (page_size > 0);
+
+	self->priv->page_size = page_size;
+	g_object_notify (G_OBJECT (self), "page-size");
+}
+
+/* Applies the changes in @feed to the store, returning FALSE if the store fails. @largest_changestamp is updated with the largest changestamp
+ * seen. */
+static gboolean
+apply_feed (GDataDocumentsSyncStore *store, GDataFeed *feed, guint *n_changed, guint *n_removed, gint64 *largest_changestamp, GError **error)
+{
+	GDataDocumentsSyncStoreInterface *iface = GDATA_DOCUMENTS_SYNC_STORE_GET_IFACE (store);
+	GList *i;
+
+	for (i = gdata_feed_get_entries (feed); i != NULL; i = i->next) {
+		GDataDocumentsEntry *entry = GDATA_DOCUMENTS_ENTRY (i->data);
+
+		if (gdata_documents_entry_is_removed (entry) == TRUE) {
+			if (iface->remove_entry (store, gdata_documents_entry_get_resource_id (entry), error) == FALSE)
+				return FALSE;
+			(*n_removed)++;
+		} else {
+			if (iface->apply_entry (store, entry, error) == FALSE)
+				return FALSE;
+			(*n_changed)++;
+		}
+
+		*largest_changestamp = MAX (*largest_changestamp, gdata_documents_entry_get_changestamp (entry));
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_documents_sync_run:
+ * @self: a #GDataDocumentsSync
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @n_changed: (out caller-allocates) (allow-none): return location for the number of documents added or changed, or %NULL
+ * @n_removed: (out caller-allocates) (allow-none): return location for the number of documents removed, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Synchronises the #GDataDocumentsSync:store with the server, applying all the documents which have changed since the store's changestamp, and
+ * then updating the changestamp. All the pages of results are queried. If the store has never been synchronised, all the documents are applied
+ * to it.
+ *
+ * The store's functions are called in the same thread as this function. If the query fails, or any of the store's functions fails, synchronisation
+ * stops and the changestamp is left unchanged. Errors are as for gdata_documents_service_query_changes().
+ *
+ * Only one synchronisation should be run on a given store at once.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_sync_run (GDataDocumentsSync *self, GCancellable *cancellable, guint *n_changed, guint *n_removed, GError **error)
+{
+	GDataDocumentsSyncPrivate *priv;
+	GDataDocumentsSyncStoreInterface *iface;
+	GDataQuery *query;
+	gint64 changestamp, new_changestamp = -1;
+	guint changed = 0, removed = 0;
+	gboolean success = TRUE;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SYNC (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = self->priv;
+	iface = GDATA_DOCUMENTS_SYNC_STORE_GET_IFACE (priv->store);
+	g_assert (iface->get_changestamp != NULL && iface->set_changestamp != NULL);
+	g_assert (iface->apply_entry != NULL && iface->remove_entry != NULL);
+
+	changestamp = iface->get_changestamp (priv->store);
+
+	/* Pagination follows the feeds' next links, so the query itself never sets a start index */
+	query = gdata_query_new_with_limits (NULL, 0, priv->page_size);
+
+	while (TRUE) {
+		GDataDocumentsFeed *feed;
+		gboolean has_next_page;
+
+		feed = gdata_documents_service_query_changes (priv->service, (changestamp >= 0) ? changestamp + 1 : -1, query, cancellable,
+		                                              NULL, NULL, error);
+		if (feed == NULL) {
+			success = FALSE;
+			break;
+		}
+
+		/* Take the new changestamp from the first page, so that any changes made while we're paging through the results get picked up next
+		 * time; the changestamps of the entries themselves are used as a fallback if the server doesn't give it */
+		if (new_changestamp == -1)
+			new_changestamp = gdata_documents_feed_get_largest_changestamp (feed);
+
+		has_next_page = (gdata_feed_get_entries (GDATA_FEED (feed)) != NULL && gdata_feed_look_up_link (GDATA_FEED (feed), "next") != NULL);
+
+		success = apply_feed (priv->store, GDATA_FEED (feed), &changed, &removed, &new_changestamp, error);
+		g_object_unref (feed);
+
+		if (success == FALSE || has_next_page == FALSE)
+			break;
+
+		gdata_query_next_page (query);
+	}
+
+	g_object_unref (query);
+
+	/* Only move the cursor on once all the changes have been applied */
+	if (success == TRUE && new_changestamp > changestamp)
+		success = iface->set_changestamp (priv->store, new_changestamp, error);
+
+	if (n_changed != NULL)
+		*n_changed = changed;
+	if (n_removed != NULL)
+		*n_removed = removed;
+
+	return success;
+}
+
+typedef struct {
+	guint n_changed;
+	guint n_removed;
+} RunAsyncData;
+
+static void
+run_async_data_free (RunAsyncData *data)
+{
+	g_slice_free (RunAsyncData, data);
+}
+
+static void
+run_thread (GSimpleAsyncResult *result, GDataDocumentsSync *self, GCancellable *cancellable)
+{
+	RunAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	if (gdata_documents_sync_run (self, cancellable, &(data->n_changed), &(data->n_removed), &error) == FALSE)
+		g_simple_async_result_take_error (result, error);
+}
+
+/**
+ * gdata_documents_sync_run_async:
+ * @self: a #GDataDocumentsSync
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when synchronisation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Synchronises the #GDataDocumentsSync:store with the server asynchronously. @self is reffed when this function is called, so can safely be
+ * unreffed after this function returns.
+ *
+ * For more details, see gdata_documents_sync_run(), which is the synchronous version of this function. Note that the store's functions will be
+ * called in a worker thread, rather than the main thread.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_documents_sync_run_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_documents_sync_run_async (GDataDocumentsSync *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+
+	g_return_if_fail (GDATA_IS_DOCUMENTS_SYNC (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_documents_sync_run_async);
+	g_simple_async_result_set_op_res_gpointer (result, g_slice_new0 (RunAsyncData), (GDestroyNotify) run_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) run_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_documents_sync_run_finish:
+ * @self: a #GDataDocumentsSync
+ * @async_result: a #GAsyncResult
+ * @n_changed: (out caller-allocates) (allow-none): return location for the number of documents added or changed, or %NULL
+ * @n_removed: (out caller-allocates) (allow-none): return location for the number of documents removed, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous synchronisation operation started with gdata_documents_sync_run_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_documents_sync_run_finish (GDataDocumentsSync *self, GAsyncResult *async_result, guint *n_changed, guint *n_removed, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	RunAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_DOCUMENTS_SYNC (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_documents_sync_run_async);
+
+	/* Changes applied before a failure are still reported */
+	data = g_simple_async_result_get_op_res_gpointer (result);
+
+	if (n_changed != NULL)
+		*n_changed = data->n_changed;
+	if (n_removed != NULL)
+		*n_removed = data->n_removed;
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	return TRUE;
+}
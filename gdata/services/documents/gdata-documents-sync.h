@@ -0,0 +1,124 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_DOCUMENTS_SYNC_H
+#define GDATA_DOCUMENTS_SYNC_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/services/documents/gdata-documents-service.h>
+#include <gdata/services/documents/gdata-documents-entry.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_DOCUMENTS_SYNC_STORE		(gdata_documents_sync_store_get_type ())
+#define GDATA_DOCUMENTS_SYNC_STORE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_DOCUMENTS_SYNC_STORE, GDataDocumentsSyncStore))
+#define GDATA_DOCUMENTS_SYNC_STORE_CLASS(k)	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_DOCUMENTS_SYNC_STORE, GDataDocumentsSyncStoreInterface))
+#define GDATA_IS_DOCUMENTS_SYNC_STORE(o)	(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_DOCUMENTS_SYNC_STORE))
+#define GDATA_DOCUMENTS_SYNC_STORE_GET_IFACE(o)	(G_TYPE_INSTANCE_GET_INTERFACE ((o), GDATA_TYPE_DOCUMENTS_SYNC_STORE, GDataDocumentsSyncStoreInterface))
+
+/**
+ * GDataDocumentsSyncStore:
+ *
+ * All the fields in the #GDataDocumentsSyncStore structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct _GDataDocumentsSyncStore		GDataDocumentsSyncStore; /* dummy typedef */
+
+/**
+ * GDataDocumentsSyncStoreInterface:
+ * @parent: the parent type
+ * @get_changestamp: a function to return the changestamp last stored by @set_changestamp, or <code class="literal">-1</code> if the store has
+ * never been synchronised; this must be implemented
+ * @set_changestamp: a function to persistently store the given changestamp, which is only called once all the changes up to it have been applied
+ * to the store; this must be implemented
+ * @apply_entry: a function to add the given document to the store, or to replace the existing version of it (matched by
+ * gdata_documents_entry_get_resource_id()) if the store already contains it; this must be implemented, and must cope with being passed a version
+ * of a document which it already contains
+ * @remove_entry: a function to remove the document with the given resource ID from the store; this must be implemented, and must cope with being
+ * passed the resource ID of a document which the store doesn't contain
+ *
+ * The interface structure for the #GDataDocumentsSyncStore interface. The functions are called in the thread which runs the synchronisation.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GTypeInterface parent;
+
+	gint64 (*get_changestamp) (GDataDocumentsSyncStore *self);
+	gboolean (*set_changestamp) (GDataDocumentsSyncStore *self, gint64 changestamp, GError **error);
+	gboolean (*apply_entry) (GDataDocumentsSyncStore *self, GDataDocumentsEntry *entry, GError **error);
+	gboolean (*remove_entry) (GDataDocumentsSyncStore *self, const gchar *resource_id, GError **error);
+} GDataDocumentsSyncStoreInterface;
+
+GType gdata_documents_sync_store_get_type (void) G_GNUC_CONST;
+
+#define GDATA_TYPE_DOCUMENTS_SYNC		(gdata_documents_sync_get_type ())
+#define GDATA_DOCUMENTS_SYNC(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_DOCUMENTS_SYNC, GDataDocumentsSync))
+#define GDATA_DOCUMENTS_SYNC_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_DOCUMENTS_SYNC, GDataDocumentsSyncClass))
+#define GDATA_IS_DOCUMENTS_SYNC(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_DOCUMENTS_SYNC))
+#define GDATA_IS_DOCUMENTS_SYNC_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_DOCUMENTS_SYNC))
+#define GDATA_DOCUMENTS_SYNC_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_DOCUMENTS_SYNC, GDataDocumentsSyncClass))
+
+typedef struct _GDataDocumentsSyncPrivate	GDataDocumentsSyncPrivate;
+
+/**
+ * GDataDocumentsSync:
+ *
+ * All the fields in the #GDataDocumentsSync structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	GObject parent;
+	GDataDocumentsSyncPrivate *priv;
+} GDataDocumentsSync;
+
+/**
+ * GDataDocumentsSyncClass:
+ *
+ * All the fields in the #GDataDocumentsSyncClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataDocumentsSyncClass;
+
+GType gdata_documents_sync_get_type (void) G_GNUC_CONST;
+
+GDataDocumentsSync *gdata_documents_sync_new (GDataDocumentsService *service, GDataDocumentsSyncStore *store) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataDocumentsService *gdata_documents_sync_get_service (GDataDocumentsSync *self) G_GNUC_PURE;
+GDataDocumentsSyncStore *gdata_documents_sync_get_store (GDataDocumentsSync *self) G_GNUC_PURE;
+
+guint gdata_documents_sync_get_page_size (GDataDocumentsSync *self) G_GNUC_PURE;
+void gdata_documents_sync_set_page_size (GDataDocumentsSync *self, guint page_size);
+
+gboolean gdata_documents_sync_run (GDataDocumentsSync *self, GCancellable *cancellable, guint *n_changed, guint *n_removed, GError **error);
+void gdata_documents_sync_run_async (GDataDocumentsSync *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_documents_sync_run_finish (GDataDocumentsSync *self, GAsyncResult *async_result, guint *n_changed, guint *n_removed, GError **error);
+
+G_END_DECLS
+
+#endif /* !GDATA_DOCUMENTS_SYNC_H */
@@ -96,6 +96,7 @@
 #include <glib.h>
 #include <glib/gi18n-lib.h>
 #include <libxml/parser.h>
+#include <stdio.h>
 #include <string.h>
 
 #include "gdata-picasaweb-file.h"
@@ -1799,3 +1800,348 @@ gdata_picasaweb_file_set_coordinates (GDataPicasaWebFile *self, gdouble latitude
 	g_object_notify (G_OBJECT (self), "longitude");
 	g_object_thaw_notify (G_OBJECT (self));
 }
+
+/* A TIFF structure (as embedded in a JPEG file's APP1 segment); all offsets are from the start of the TIFF header. */
+typedef struct {
+	const guint8 *data;
+	gsize length;
+	gboolean big_endian;
+} ExifReader;
+
+#define EXIF_TYPE_ASCII 2
+#define EXIF_TYPE_SHORT 3
+#define EXIF_TYPE_LONG 4
+#define EXIF_TYPE_RATIONAL 5
+
+#define EXIF_TAG_IMAGE_DESCRIPTION 0x010e
+#define EXIF_TAG_DATE_TIME 0x0132
+#define EXIF_TAG_EXIF_IFD 0x8769
+#define EXIF_TAG_GPS_IFD 0x8825
+#define EXIF_TAG_DATE_TIME_ORIGINAL 0x9003
+#define EXIF_TAG_GPS_LATITUDE_REF 0x0001
+#define EXIF_TAG_GPS_LATITUDE 0x0002
+#define EXIF_TAG_GPS_LONGITUDE_REF 0x0003
+#define EXIF_TAG_GPS_LONGITUDE 0x0004
+
+static gboolean
+exif_get_uint16 (const ExifReader *reader, gsize offset, guint16 *value)
+{
+	const guint8 *p;
+
+	if (offset > reader->length || reader->length - offset < 2)
+		return FALSE;
+
+	p = reader->data + offset;
+	*value = (reader->big_endian == TRUE) ? (p[0] << 8) | p[1] : (p[1] << 8) | p[0];
+
+	return TRUE;
+}
+
+static gboolean
+exif_get_uint32 (const ExifReader *reader, gsize offset, guint32 *value)
+{
+	const guint8 *p;
+
+	if (offset > reader->length || reader->length - offset < 4)
+		return FALSE;
+
+	p = reader->data + offset;
+	if (reader->big_endian == TRUE)
+		*value = ((guint32) p[0] << 24) | ((guint32) p[1] << 16) | ((guint32) p[2] << 8) | (guint32) p[3];
+	else
+		*value = ((guint32) p[3] << 24) | ((guint32) p[2] << 16) | ((guint32) p[1] << 8) | (guint32) p[0];
+
+	return TRUE;
+}
+
+/* Find @tag in the IFD at @ifd_offset, checking it has type @type and returning the offset of its value (which is stored inline in the entry if it
+ * fits in four bytes) and its count of values. The whole value is guaranteed to lie within the TIFF structure. */
+static gboolean
+exif_find_tag (const ExifReader *reader, guint32 ifd_offset, guint16 tag, guint16 type, gsize *value_offset, guint32 *count)
+{
+	guint16 n_entries, i;
+
+	if (ifd_offset == 0 || exif_get_uint16 (reader, ifd_offset, &n_entries) == FALSE)
+		return FALSE;
+
+	for (i = 0; i < n_entries; i++) {
+		gsize entry_offset = ifd_offset + 2 + 12 * i;
+		guint16 entry_tag, entry_type;
+		guint32 entry_count, offset;
+		gsize value_size;
+
+		if (exif_get_uint16 (reader, entry_offset, &entry_tag) == FALSE)
+			return FALSE;
+		if (entry_tag != tag)
+			continue;
+
+		if (exif_get_uint16 (reader, entry_offset + 2, &entry_type) == FALSE || entry_type != type ||
+		    exif_get_uint32 (reader, entry_offset + 4, &entry_count) == FALSE) {
+			return FALSE;
+		}
+
+		switch (type) {
+			case EXIF_TYPE_ASCII:
+				value_size = entry_count;
+				break;
+			case EXIF_TYPE_SHORT:
+				value_size = 2 * (gsize) entry_count;
+				break;
+			case EXIF_TYPE_LONG:
+				value_size = 4 * (gsize) entry_count;
+				break;
+			case EXIF_TYPE_RATIONAL:
+				value_size = 8 * (gsize) entry_count;
+				break;
+			default:
+				g_assert_not_reached ();
+		}
+
+		if (value_size <= 4) {
+			*value_offset = entry_offset + 8;
+		} else if (exif_get_uint32 (reader, entry_offset + 8, &offset) == TRUE) {
+			*value_offset = offset;
+		} else {
+			return FALSE;
+		}
+
+		if (*value_offset > reader->length || reader->length - *value_offset < value_size)
+			return FALSE;
+
+		*count = entry_count;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Returns a newly-allocated string, or NULL if the tag isn't present, is empty or isn't valid UTF-8 */
+static gchar *
+exif_get_string (const ExifReader *reader, guint32 ifd_offset, guint16 tag)
+{
+	gsize value_offset;
+	guint32 count;
+	gchar *value;
+
+	if (exif_find_tag (reader, ifd_offset, tag, EXIF_TYPE_ASCII, &value_offset, &count) == FALSE)
+		return NULL;
+
+	value = g_strstrip (g_strndup ((const gchar*) reader->data + value_offset, count));
+	if (*value == '\0' || g_utf8_validate (value, -1, NULL) == FALSE) {
+		g_free (value);
+		return NULL;
+	}
+
+	return value;
+}
+
+static guint32
+exif_get_ifd_offset (const ExifReader *reader, guint32 ifd_offset, guint16 tag)
+{
+	gsize value_offset;
+	guint32 count, offset;
+
+	if (exif_find_tag (reader, ifd_offset, tag, EXIF_TYPE_LONG, &value_offset, &count) == FALSE || count != 1 ||
+	    exif_get_uint32 (reader, value_offset, &offset) == FALSE) {
+		return 0;
+	}
+
+	return offset;
+}
+
+/* Parse a "YYYY:MM:DD HH:MM:SS" date. EXIF doesn't record a time zone, so it's treated as UTC. Returns the timestamp in milliseconds, or -1. */
+static gint64
+exif_parse_date_time (const gchar *date_time)
+{
+	guint year, month, day, hour, minute, second;
+	GDateTime *parsed;
+	gint64 timestamp;
+
+	if (date_time == NULL ||
+	    sscanf (date_time, "%4u:%2u:%2u %2u:%2u:%2u", &year, &month, &day, &hour, &minute, &second) != 6) {
+		return -1;
+	}
+
+	parsed = g_date_time_new_utc (year, month, day, hour, minute, second);
+	if (parsed == NULL)
+		return -1;
+
+	timestamp = g_date_time_to_unix (parsed);
+	g_date_time_unref (parsed);
+
+	return (timestamp >= 0) ? timestamp * 1000 : -1;
+}
+
+/* Parse a GPS coordinate: three rationals (degrees, minutes and seconds) and a reference letter giving its sign */
+static gboolean
+exif_get_coordinate (const ExifReader *reader, guint32 gps_offset, guint16 tag, guint16 ref_tag, const gchar *negative_ref, gdouble *coordinate)
+{
+	gsize value_offset;
+	guint32 count;
+	gdouble value = 0.0, divisor = 1.0;
+	gchar *ref;
+	guint i;
+
+	if (exif_find_tag (reader, gps_offset, tag, EXIF_TYPE_RATIONAL, &value_offset, &count) == FALSE || count != 3)
+		return FALSE;
+
+	for (i = 0; i < 3; i++) {
+		guint32 numerator, denominator;
+
+		if (exif_get_uint32 (reader, value_offset + 8 * i, &numerator) == FALSE ||
+		    exif_get_uint32 (reader, value_offset + 8 * i + 4, &denominator) == FALSE || denominator == 0) {
+			return FALSE;
+		}
+
+		value += ((gdouble) numerator / (gdouble) denominator) / divisor;
+		divisor *= 60.0;
+	}
+
+	ref = exif_get_string (reader, gps_offset, ref_tag);
+	if (ref != NULL && strcmp (ref, negative_ref) == 0)
+		value = -value;
+	g_free (ref);
+
+	*coordinate = value;
+
+	return TRUE;
+}
+
+/* Find the TIFF structure holding the EXIF data in a JPEG file (in its APP1 segment), or a TIFF file (which is the structure itself) */
+static gboolean
+exif_find_tiff (const guint8 *data, gsize length, ExifReader *reader)
+{
+	gsize offset = 2;
+
+	if (length >= 4 && (memcmp (data, "II*\0", 4) == 0 || memcmp (data, "MM\0*", 4) == 0)) {
+		reader->data = data;
+		reader->length = length;
+	} else if (length >= 2 && data[0] == 0xff && data[1] == 0xd8) {
+		/* Scan the JPEG markers for APP1; they all come before the image data (SOS) */
+		reader->data = NULL;
+
+		while (offset + 4 <= length && data[offset] == 0xff) {
+			guint8 marker = data[offset + 1];
+			gsize segment_length;
+
+			if (marker == 0xff) {
+				/* Fill byte */
+				offset++;
+				continue;
+			} else if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd7)) {
+				/* Markers without a segment */
+				offset += 2;
+				continue;
+			} else if (marker == 0xd9 || marker == 0xda) {
+				/* EOI or SOS */
+				break;
+			}
+
+			segment_length = (data[offset + 2] << 8) | data[offset + 3];
+			if (segment_length < 2 || length - offset - 2 < segment_length)
+				break;
+
+			if (marker == 0xe1 && segment_length >= 2 + 6 + 8 && memcmp (data + offset + 4, "Exif\0\0", 6) == 0) {
+				reader->data = data + offset + 4 + 6;
+				reader->length = segment_length - 2 - 6;
+				break;
+			}
+
+			offset += 2 + segment_length;
+		}
+
+		if (reader->data == NULL)
+			return FALSE;
+	} else {
+		return FALSE;
+	}
+
+	if (reader->length < 8)
+		return FALSE;
+
+	reader->big_endian = (reader->data[0] == 'M');
+
+	return (reader->data[0] == reader->data[1] && (reader->data[0] == 'I' || reader->data[0] == 'M'));
+}
+
+/**
+ * gdata_picasaweb_file_update_from_exif:
+ * @self: a #GDataPicasaWebFile
+ * @data: (array length=length): the start of a JPEG or TIFF file
+ * @length: the length of @data, in bytes
+ *
+ * Parses the EXIF data from the start of a JPEG or TIFF file and uses it to fill in any of the file's #GDataPicasaWebFile:timestamp,
+ * #GDataPicasaWebFile:caption, #GDataPicasaWebFile:latitude and #GDataPicasaWebFile:longitude properties which are unset. Properties which have
+ * already been set are left alone.
+ *
+ * The timestamp is taken from the time the photo was taken (or, failing that, last modified); EXIF doesn't record a time zone, so it's assumed
+ * to be in UTC. The caption is taken from the image description, if it's valid UTF-8, and the coordinates are taken from the GPS data.
+ *
+ * The EXIF data is normally within the first 64 KiB of a JPEG file. If @data doesn't contain (all of) it, or it can't be parsed, the file is
+ * left unchanged. This is normally used on the data as it's being uploaded; see gdata_picasaweb_service_parse_exif_on_upload().
+ *
+ * Return value: %TRUE if any of the properties were set, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_picasaweb_file_update_from_exif (GDataPicasaWebFile *self, const guint8 *data, gsize length)
+{
+	ExifReader reader;
+	guint32 ifd0_offset;
+	gboolean updated = FALSE;
+
+	g_return_val_if_fail (GDATA_IS_PICASAWEB_FILE (self), FALSE);
+	g_return_val_if_fail (data != NULL || length == 0, FALSE);
+
+	if (exif_find_tiff (data, length, &reader) == FALSE || exif_get_uint32 (&reader, 4, &ifd0_offset) == FALSE)
+		return FALSE;
+
+	g_object_freeze_notify (G_OBJECT (self));
+
+	if (self->priv->timestamp == -1) {
+		gchar *date_time;
+		gint64 timestamp = -1;
+
+		date_time = exif_get_string (&reader, exif_get_ifd_offset (&reader, ifd0_offset, EXIF_TAG_EXIF_IFD), EXIF_TAG_DATE_TIME_ORIGINAL);
+		timestamp = exif_parse_date_time (date_time);
+		g_free (date_time);
+
+		if (timestamp == -1) {
+			date_time = exif_get_string (&reader, ifd0_offset, EXIF_TAG_DATE_TIME);
+			timestamp = exif_parse_date_time (date_time);
+			g_free (date_time);
+		}
+
+		if (timestamp != -1) {
+			gdata_picasaweb_file_set_timestamp (self, timestamp);
+			updated = TRUE;
+		}
+	}
+
+	if (gdata_picasaweb_file_get_caption (self) == NULL) {
+		gchar *description = exif_get_string (&reader, ifd0_offset, EXIF_TAG_IMAGE_DESCRIPTION);
+
+		if (description != NULL) {
+			gdata_picasaweb_file_set_caption (self, description);
+			g_free (description);
+			updated = TRUE;
+		}
+	}
+
+	if (gdata_georss_where_get_latitude (self->priv->georss_where) == G_MAXDOUBLE ||
+	    gdata_georss_where_get_longitude (self->priv->georss_where) == G_MAXDOUBLE) {
+		guint32 gps_offset = exif_get_ifd_offset (&reader, ifd0_offset, EXIF_TAG_GPS_IFD);
+		gdouble latitude, longitude;
+
+		if (exif_get_coordinate (&reader, gps_offset, EXIF_TAG_GPS_LATITUDE, EXIF_TAG_GPS_LATITUDE_REF, "S", &latitude) == TRUE &&
+		    exif_get_coordinate (&reader, gps_offset, EXIF_TAG_GPS_LONGITUDE, EXIF_TAG_GPS_LONGITUDE_REF, "W", &longitude) == TRUE) {
+			gdata_picasaweb_file_set_coordinates (self, latitude, longitude);
+			updated = TRUE;
+		}
+	}
+
+	g_object_thaw_notify (G_OBJECT (self));
+
+	return updated;
+}
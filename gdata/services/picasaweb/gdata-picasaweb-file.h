@@ -140,6 +140,8 @@ const gchar *gdata_picasaweb_file_get_model (GDataPicasaWebFile *self) G_GNUC_PU
 void gdata_picasaweb_file_get_coordinates (GDataPicasaWebFile *self, gdouble *latitude, gdouble *longitude);
 void gdata_picasaweb_file_set_coordinates (GDataPicasaWebFile *self, gdouble latitude, gdouble longitude);
 
+gboolean gdata_picasaweb_file_update_from_exif (GDataPicasaWebFile *self, const guint8 *data, gsize length);
+
 /* TODO implement is video */
 /* TODO implement get comments */
 
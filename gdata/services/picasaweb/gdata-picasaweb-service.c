@@ -121,23 +121,120 @@
 #include "gdata-upload-stream.h"
 #include "gdata-picasaweb-feed.h"
 
+static void gdata_picasaweb_service_finalize (GObject *object);
+static void gdata_picasaweb_service_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_picasaweb_service_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
 static GList *get_authorization_domains (void);
 
+#define DEFAULT_USER_CACHE_TTL 60 /* seconds */
+
+/* A user entry cached by gdata_picasaweb_service_get_cached_user(). It's revalidated with its ETag once it's older than the service's
+ * user-cache-ttl. */
+typedef struct {
+	GDataPicasaWebUser *user;
+	gchar *etag;
+	gint64 validated_time; /* monotonic time the entry was last fetched or revalidated, in microseconds */
+} UserCacheEntry;
+
+struct _GDataPicasaWebServicePrivate {
+	GMutex user_cache_mutex; /* protects user_cache and all its entries */
+	GHashTable *user_cache; /* user entry URI → UserCacheEntry */
+	guint user_cache_ttl;
+};
+
+enum {
+	PROP_USER_CACHE_TTL = 1,
+};
+
 _GDATA_DEFINE_AUTHORIZATION_DOMAIN (picasaweb, "lh2", "http://picasaweb.google.com/data/")
 G_DEFINE_TYPE (GDataPicasaWebService, gdata_picasaweb_service, GDATA_TYPE_SERVICE)
 
 static void
 gdata_picasaweb_service_class_init (GDataPicasaWebServiceClass *klass)
 {
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
 	GDataServiceClass *service_class = GDATA_SERVICE_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataPicasaWebServicePrivate));
+
+	gobject_class->finalize = gdata_picasaweb_service_finalize;
+	gobject_class->get_property = gdata_picasaweb_service_get_property;
+	gobject_class->set_property = gdata_picasaweb_service_set_property;
+
 	service_class->feed_type = GDATA_TYPE_PICASAWEB_FEED;
 	service_class->get_authorization_domains = get_authorization_domains;
+
+	/**
+	 * GDataPicasaWebService:user-cache-ttl:
+	 *
+	 * The number of seconds for which a user returned by gdata_picasaweb_service_get_cached_user() is used without checking with the server
+	 * that it's still current. If this is <code class="literal">0</code>, the user is revalidated every time.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_USER_CACHE_TTL,
+	                                 g_param_spec_uint ("user-cache-ttl",
+	                                                    "User cache TTL", "The number of seconds a cached user is used for without revalidation.",
+	                                                    0, G_MAXUINT, DEFAULT_USER_CACHE_TTL,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+user_cache_entry_free (UserCacheEntry *entry)
+{
+	g_object_unref (entry->user);
+	g_free (entry->etag);
+	g_slice_free (UserCacheEntry, entry);
 }
 
 static void
 gdata_picasaweb_service_init (GDataPicasaWebService *self)
 {
-	/* Nothing to see here */
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_PICASAWEB_SERVICE, GDataPicasaWebServicePrivate);
+
+	g_mutex_init (&(self->priv->user_cache_mutex));
+	self->priv->user_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) user_cache_entry_free);
+	self->priv->user_cache_ttl = DEFAULT_USER_CACHE_TTL;
+}
+
+static void
+gdata_picasaweb_service_finalize (GObject *object)
+{
+	GDataPicasaWebServicePrivate *priv = GDATA_PICASAWEB_SERVICE (object)->priv;
+
+	g_hash_table_destroy (priv->user_cache);
+	g_mutex_clear (&(priv->user_cache_mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_picasaweb_service_parent_class)->finalize (object);
+}
+
+static void
+gdata_picasaweb_service_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	switch (property_id) {
+		case PROP_USER_CACHE_TTL:
+			g_value_set_uint (value, gdata_picasaweb_service_get_user_cache_ttl (GDATA_PICASAWEB_SERVICE (object)));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_picasaweb_service_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	switch (property_id) {
+		case PROP_USER_CACHE_TTL:
+			gdata_picasaweb_service_set_user_cache_ttl (GDATA_PICASAWEB_SERVICE (object), g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
 }
 
 static GList *
@@ -347,6 +444,304 @@ gdata_picasaweb_service_get_user_finish (GDataPicasaWebService *self, GAsyncResu
 	return g_simple_async_result_get_op_res_gpointer (result);
 }
 
+/* Fetches the user entry at @uri, unless it's unchanged since @etag (in which case %NULL is returned with @error unset and @not_modified set to
+ * %TRUE). The new ETag is returned in @new_etag. */
+static GDataPicasaWebUser *
+download_user (GDataPicasaWebService *self, const gchar *uri, const gchar *etag, gchar **new_etag, gboolean *not_modified, GCancellable *cancellable,
+               GError **error)
+{
+	SoupMessage *message;
+	GDataPicasaWebUser *user;
+	guint status;
+
+	*not_modified = FALSE;
+
+	message = _gdata_service_build_message (GDATA_SERVICE (self), get_picasaweb_authorization_domain (), SOUP_METHOD_GET, uri, etag, FALSE);
+	status = _gdata_service_send_message (GDATA_SERVICE (self), message, cancellable, error);
+
+	if (status == SOUP_STATUS_NOT_MODIFIED && etag != NULL) {
+		/* The cached user is still current */
+		*not_modified = TRUE;
+		g_object_unref (message);
+		return NULL;
+	} else if (status == SOUP_STATUS_CANCELLED || status == SOUP_STATUS_NONE) {
+		/* Cancelled (in which case the error has been set) */
+		g_object_unref (message);
+		return NULL;
+	} else if (status != SOUP_STATUS_OK) {
+		/* Error */
+		GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (self);
+		g_assert (klass->parse_error_response != NULL);
+		klass->parse_error_response (GDATA_SERVICE (self), GDATA_OPERATION_QUERY, status, message->reason_phrase, message->response_body->data,
+		                             message->response_body->length, error);
+		g_object_unref (message);
+		return NULL;
+	}
+
+	g_assert (message->response_body->data != NULL);
+	user = GDATA_PICASAWEB_USER (gdata_parsable_new_from_xml (GDATA_TYPE_PICASAWEB_USER, message->response_body->data,
+	                                                          message->response_body->length, error));
+
+	if (user != NULL) {
+		const gchar *header_etag = soup_message_headers_get_one (message->response_headers, "ETag");
+		*new_etag = g_strdup ((header_etag != NULL) ? header_etag : gdata_entry_get_etag (GDATA_ENTRY (user)));
+	}
+
+	g_object_unref (message);
+
+	return user;
+}
+
+/**
+ * gdata_picasaweb_service_get_cached_user:
+ * @self: a #GDataPicasaWebService
+ * @username: (allow-none): the username of the user whose information you wish to retrieve, or %NULL for the currently authenticated user
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Gets the user specified by @username, as by gdata_picasaweb_service_get_user(), but from a cache on @self where possible. This makes it cheap to
+ * check the user's quota (see gdata_picasaweb_user_get_quota_current()) frequently, such as before uploading each of a series of files.
+ *
+ * A cached user is returned without any network activity if it was fetched or revalidated less than #GDataPicasaWebService:user-cache-ttl
+ * seconds ago. Otherwise, it's revalidated with the server using its ETag, which only costs a full download and parse if it's changed.
+ *
+ * The returned #GDataPicasaWebUser is shared with the cache, so it shouldn't be modified. Whenever a file is successfully uploaded through
+ * gdata_picasaweb_service_finish_file_upload(), the #GDataPicasaWebUser:quota-current of the authenticated user's cached entry (as returned for a
+ * %NULL @username) is increased by the file's size, so it stays accurate between revalidations.
+ *
+ * Return value: (transfer full): a #GDataPicasaWebUser; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataPicasaWebUser *
+gdata_picasaweb_service_get_cached_user (GDataPicasaWebService *self, const gchar *username, GCancellable *cancellable, GError **error)
+{
+	GDataPicasaWebServicePrivate *priv;
+	UserCacheEntry *entry;
+	GDataPicasaWebUser *user = NULL, *new_user;
+	gchar *uri, *etag, *new_etag = NULL;
+	gboolean not_modified;
+
+	g_return_val_if_fail (GDATA_IS_PICASAWEB_SERVICE (self), NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	priv = self->priv;
+
+	uri = create_uri (self, username, "entry");
+	if (uri == NULL) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+		                     _("You must specify a username or be authenticated to query a user."));
+		return NULL;
+	}
+
+	g_mutex_lock (&(priv->user_cache_mutex));
+
+	entry = g_hash_table_lookup (priv->user_cache, uri);
+	if (entry != NULL && g_get_monotonic_time () - entry->validated_time < (gint64) priv->user_cache_ttl * G_USEC_PER_SEC) {
+		/* Fresh enough to use as-is */
+		user = g_object_ref (entry->user);
+		g_mutex_unlock (&(priv->user_cache_mutex));
+		g_free (uri);
+
+		return user;
+	}
+
+	etag = (entry != NULL) ? g_strdup (entry->etag) : NULL;
+
+	g_mutex_unlock (&(priv->user_cache_mutex));
+
+	new_user = download_user (self, uri, etag, &new_etag, &not_modified, cancellable, error);
+	g_free (etag);
+
+	g_mutex_lock (&(priv->user_cache_mutex));
+
+	entry = g_hash_table_lookup (priv->user_cache, uri);
+
+	if (not_modified == TRUE && entry != NULL) {
+		entry->validated_time = g_get_monotonic_time ();
+		user = g_object_ref (entry->user);
+	} else if (new_user != NULL) {
+		if (entry == NULL) {
+			entry = g_slice_new0 (UserCacheEntry);
+			g_hash_table_insert (priv->user_cache, g_strdup (uri), entry);
+		} else {
+			g_object_unref (entry->user);
+			g_free (entry->etag);
+		}
+
+		entry->user = new_user; /* transfer ownership */
+		entry->etag = new_etag; /* transfer ownership */
+		entry->validated_time = g_get_monotonic_time ();
+		user = g_object_ref (new_user);
+	}
+
+	g_mutex_unlock (&(priv->user_cache_mutex));
+
+	/* The entry was dropped from the cache while it was being revalidated, so fetch it afresh */
+	if (not_modified == TRUE && user == NULL)
+		user = gdata_picasaweb_service_get_cached_user (self, username, cancellable, error);
+
+	g_free (uri);
+
+	return user;
+}
+
+static void
+get_cached_user_thread (GSimpleAsyncResult *result, GDataPicasaWebService *service, GCancellable *cancellable)
+{
+	GDataPicasaWebUser *user;
+	GError *error = NULL;
+
+	/* Get the user and return */
+	user = gdata_picasaweb_service_get_cached_user (service, g_simple_async_result_get_op_res_gpointer (result), cancellable, &error);
+
+	if (user == NULL) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+		return;
+	}
+
+	/* Replace the username with the user object */
+	g_simple_async_result_set_op_res_gpointer (result, user, (GDestroyNotify) g_object_unref);
+}
+
+/**
+ * gdata_picasaweb_service_get_cached_user_async:
+ * @self: a #GDataPicasaWebService
+ * @username: (allow-none): the username of the user whose information you wish to retrieve, or %NULL for the currently authenticated user
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the query is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Gets the user specified by @username from the cache on @self, revalidating it if necessary.
+ *
+ * For more details, see gdata_picasaweb_service_get_cached_user() which is the synchronous version of this method.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_picasaweb_service_get_cached_user_finish() to get the results of
+ * the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_picasaweb_service_get_cached_user_async (GDataPicasaWebService *self, const gchar *username, GCancellable *cancellable,
+                                               GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+
+	g_return_if_fail (GDATA_IS_PICASAWEB_SERVICE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_picasaweb_service_get_cached_user_async);
+	g_simple_async_result_set_op_res_gpointer (result, g_strdup (username), (GDestroyNotify) g_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) get_cached_user_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_picasaweb_service_get_cached_user_finish:
+ * @self: a #GDataPicasaWebService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous cached user retrieval operation started with gdata_picasaweb_service_get_cached_user_async().
+ *
+ * Return value: (transfer full): a #GDataPicasaWebUser; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataPicasaWebUser *
+gdata_picasaweb_service_get_cached_user_finish (GDataPicasaWebService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result;
+
+	g_return_val_if_fail (GDATA_IS_PICASAWEB_SERVICE (self), NULL);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), gdata_picasaweb_service_get_cached_user_async) == TRUE,
+	                      NULL);
+
+	result = G_SIMPLE_ASYNC_RESULT (async_result);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return NULL;
+
+	return g_object_ref (g_simple_async_result_get_op_res_gpointer (result));
+}
+
+/**
+ * gdata_picasaweb_service_get_user_cache_ttl:
+ * @self: a #GDataPicasaWebService
+ *
+ * Gets the #GDataPicasaWebService:user-cache-ttl property.
+ *
+ * Return value: the number of seconds a cached user is used for without revalidation
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_picasaweb_service_get_user_cache_ttl (GDataPicasaWebService *self)
+{
+	guint user_cache_ttl;
+
+	g_return_val_if_fail (GDATA_IS_PICASAWEB_SERVICE (self), 0);
+
+	g_mutex_lock (&(self->priv->user_cache_mutex));
+	user_cache_ttl = self->priv->user_cache_ttl;
+	g_mutex_unlock (&(self->priv->user_cache_mutex));
+
+	return user_cache_ttl;
+}
+
+/**
+ * gdata_picasaweb_service_set_user_cache_ttl:
+ * @self: a #GDataPicasaWebService
+ * @user_cache_ttl: the number of seconds a cached user is used for without revalidation, or <code class="literal">0</code> to always revalidate
+ *
+ * Sets the #GDataPicasaWebService:user-cache-ttl property. This takes effect for users already in the cache, too.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_picasaweb_service_set_user_cache_ttl (GDataPicasaWebService *self, guint user_cache_ttl)
+{
+	g_return_if_fail (GDATA_IS_PICASAWEB_SERVICE (self));
+
+	g_mutex_lock (&(self->priv->user_cache_mutex));
+	self->priv->user_cache_ttl = user_cache_ttl;
+	g_mutex_unlock (&(self->priv->user_cache_mutex));
+
+	g_object_notify (G_OBJECT (self), "user-cache-ttl");
+}
+
+/* Accounts for a successfully uploaded file of @size bytes in the authenticated user's cached quota, so that it doesn't need revalidating to stay
+ * accurate */
+static void
+add_upload_to_cached_user (GDataPicasaWebService *self, gsize size)
+{
+	GDataPicasaWebServicePrivate *priv = self->priv;
+	UserCacheEntry *entry;
+	gchar *uri;
+
+	uri = create_uri (self, NULL, "entry");
+	if (uri == NULL || size == 0) {
+		g_free (uri);
+		return;
+	}
+
+	g_mutex_lock (&(priv->user_cache_mutex));
+
+	entry = g_hash_table_lookup (priv->user_cache, uri);
+	if (entry != NULL)
+		_gdata_picasaweb_user_add_to_quota_current (entry->user, (gint64) size);
+
+	g_mutex_unlock (&(priv->user_cache_mutex));
+
+	g_free (uri);
+}
+
 /**
  * gdata_picasaweb_service_query_all_albums:
  * @self: a #GDataPicasaWebService
@@ -572,6 +967,462 @@ gdata_picasaweb_service_query_files_async (GDataPicasaWebService *self, GDataPic
 	                           callback, user_data);
 }
 
+/* Number of albums whose files are queried concurrently by gdata_picasaweb_service_query_all_files(), and the number of pages of each album's files
+ * which are in turn requested concurrently */
+#define MAX_CONCURRENT_ALBUMS 4
+#define MAX_CONCURRENT_PAGES 2
+
+/* Number of files to deliver in each batch from gdata_picasaweb_service_query_all_files() */
+#define FILES_BATCH_SIZE 100
+
+typedef struct {
+	GDataPicasaWebService *service;
+	GDataQuery *query;
+	GCancellable *cancellable; /* internal; cancelled if the caller's cancellable is, or if any album fails */
+	GAsyncQueue *results; /* FilesBatches */
+} QueryAllFilesData;
+
+typedef struct {
+	GDataPicasaWebAlbum *album;
+	GPtrArray *files; /* NULL for the final batch of each album */
+	GError *error; /* only set for the final batch */
+	GDataPicasaWebFilesCallback callback;
+	gpointer user_data;
+} FilesBatch;
+
+typedef struct {
+	QueryAllFilesData *data;
+	GDataPicasaWebAlbum *album;
+	GPtrArray *files;
+} AlbumFilesRequest;
+
+static void
+files_batch_free (FilesBatch *batch)
+{
+	g_object_unref (batch->album);
+	if (batch->files != NULL)
+		g_ptr_array_unref (batch->files);
+	if (batch->error != NULL)
+		g_error_free (batch->error);
+
+	g_slice_free (FilesBatch, batch);
+}
+
+static void
+push_files_batch (QueryAllFilesData *data, GDataPicasaWebAlbum *album, GPtrArray *files, GError *error)
+{
+	FilesBatch *batch = g_slice_new0 (FilesBatch);
+
+	batch->album = g_object_ref (album);
+	batch->files = files;
+	batch->error = error;
+
+	g_async_queue_push (data->results, batch);
+}
+
+static void
+album_files_progress_cb (GDataEntry *entry, guint entry_key, guint entry_count, AlbumFilesRequest *request)
+{
+	g_ptr_array_add (request->files, g_object_ref (entry));
+
+	if (request->files->len >= FILES_BATCH_SIZE) {
+		push_files_batch (request->data, request->album, request->files, NULL);
+		request->files = g_ptr_array_new_with_free_func (g_object_unref);
+	}
+}
+
+static void
+query_album_files_thread (GDataPicasaWebAlbum *album, QueryAllFilesData *data)
+{
+	AlbumFilesRequest request;
+	GDataQuery *query;
+	GDataFeed *feed = NULL;
+	const gchar *uri;
+	GError *child_error = NULL;
+
+	request.data = data;
+	request.album = album;
+	request.files = g_ptr_array_new_with_free_func (g_object_unref);
+
+	/* Each album needs its own query, since querying updates it */
+	query = (data->query != NULL) ? _gdata_query_copy (data->query) : NULL;
+
+	uri = get_query_files_uri (album, &child_error);
+	if (uri != NULL && g_cancellable_set_error_if_cancelled (data->cancellable, &child_error) == FALSE) {
+		feed = gdata_service_query_all (GDATA_SERVICE (data->service), get_picasaweb_authorization_domain (), uri, query,
+		                                GDATA_TYPE_PICASAWEB_FILE, MAX_CONCURRENT_PAGES, data->cancellable,
+		                                (GDataQueryProgressCallback) album_files_progress_cb, &request, &child_error);
+	}
+
+	if (feed != NULL)
+		g_object_unref (feed);
+	if (query != NULL)
+		g_object_unref (query);
+
+	/* Fail fast: stop querying the other albums if this one failed */
+	if (child_error != NULL)
+		g_cancellable_cancel (data->cancellable);
+
+	if (request.files->len > 0)
+		push_files_batch (data, album, request.files, NULL);
+	else
+		g_ptr_array_unref (request.files);
+
+	push_files_batch (data, album, NULL, child_error);
+	g_object_unref (album);
+}
+
+/* Run the user-supplied callback for a batch of files. This is designed to be used in an idle handler, so that the callback is run in the thread
+ * which started the query. */
+static gboolean
+files_batch_callback_cb (FilesBatch *batch)
+{
+	batch->callback (batch->album, batch->files, batch->user_data);
+	return FALSE;
+}
+
+static void
+query_all_files_cancelled_cb (GCancellable *cancellable, GCancellable *internal_cancellable)
+{
+	g_cancellable_cancel (internal_cancellable);
+}
+
+static gboolean
+query_all_files (GDataPicasaWebService *self, const gchar *username, GDataQuery *query, GCancellable *cancellable,
+                 GDataPicasaWebFilesCallback files_callback, gpointer files_user_data, GMainContext *context, gboolean is_async, GError **error)
+{
+	QueryAllFilesData data;
+	GDataFeed *album_feed;
+	GThreadPool *pool;
+	GList *i;
+	guint n_albums_pending = 0;
+	gulong cancelled_signal = 0;
+	gchar *uri;
+	GError *child_error = NULL;
+
+	uri = create_uri (self, username, "feed");
+	if (uri == NULL) {
+		g_set_error_literal (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+		                     _("You must specify a username or be authenticated to query all albums."));
+		return FALSE;
+	}
+
+	/* List all the albums first; the album feed is normally a single page, but may not be */
+	album_feed = gdata_service_query_all (GDATA_SERVICE (self), get_picasaweb_authorization_domain (), uri, NULL, GDATA_TYPE_PICASAWEB_ALBUM,
+	                                      MAX_CONCURRENT_PAGES, cancellable, NULL, NULL, error);
+	g_free (uri);
+
+	if (album_feed == NULL)
+		return FALSE;
+
+	data.service = self;
+	data.query = query;
+	data.cancellable = g_cancellable_new ();
+	data.results = g_async_queue_new ();
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) query_all_files_cancelled_cb, data.cancellable, NULL);
+
+	/* Query the albums' files concurrently, bounded by the size of the thread pool */
+	pool = g_thread_pool_new ((GFunc) query_album_files_thread, &data, MAX_CONCURRENT_ALBUMS, FALSE, NULL);
+
+	for (i = gdata_feed_get_entries (album_feed); i != NULL; i = i->next) {
+		g_thread_pool_push (pool, g_object_ref (i->data), NULL);
+		n_albums_pending++;
+	}
+
+	/* Deliver the batches as they arrive. As with GDataBatchOperation, only dispatch the callbacks in the thread-default main context of the
+	 * thread which started the query if it was started with *_query_all_files_async(). */
+	while (n_albums_pending > 0) {
+		FilesBatch *batch = g_async_queue_pop (data.results);
+
+		if (batch->files == NULL) {
+			/* Final batch for an album; prefer reporting the error which caused the other albums to be cancelled */
+			if (batch->error != NULL &&
+			    (child_error == NULL || (g_error_matches (child_error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == TRUE &&
+			                             g_error_matches (batch->error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == FALSE))) {
+				g_clear_error (&child_error);
+				child_error = batch->error;
+				batch->error = NULL;
+			}
+
+			n_albums_pending--;
+			files_batch_free (batch);
+		} else if (files_callback == NULL) {
+			files_batch_free (batch);
+		} else {
+			batch->callback = files_callback;
+			batch->user_data = files_user_data;
+
+			if (is_async == TRUE) {
+				_gdata_service_idle_add (context, (GSourceFunc) files_batch_callback_cb, batch, (GDestroyNotify) files_batch_free);
+			} else {
+				files_batch_callback_cb (batch);
+				files_batch_free (batch);
+			}
+		}
+	}
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	g_async_queue_unref (data.results);
+	g_object_unref (data.cancellable);
+	g_object_unref (album_feed);
+
+	/* Report cancellation of the caller's cancellable in preference to anything else */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
+		g_clear_error (&child_error);
+		return FALSE;
+	} else if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_picasaweb_service_query_all_files:
+ * @self: a #GDataPicasaWebService
+ * @username: (allow-none): the username of the user whose files you wish to retrieve, or %NULL
+ * @query: (allow-none): a #GDataQuery with the query parameters for the files, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @files_callback: (allow-none) (scope call) (closure files_user_data): a #GDataPicasaWebFilesCallback to call when a batch of files is loaded,
+ * or %NULL
+ * @files_user_data: (closure): data to pass to the @files_callback function
+ * @error: a #GError, or %NULL
+ *
+ * Queries the service for all the files in all the albums belonging to the specified @username, passing them to @files_callback in batches as they
+ * are loaded. If a user is authenticated with the service, @username can be set as %NULL to list the files belonging to the currently-authenticated
+ * user.
+ *
+ * This lists all of the user's albums as by gdata_picasaweb_service_query_all_albums(), then queries the files in several albums concurrently, as
+ * by gdata_picasaweb_service_query_files(). Every page of each album is fetched, as by gdata_service_query_all(). The parameters in @query (such
+ * as #GDataPicasaWebQuery:image-size) are applied to each album's files query; @query itself is not modified.
+ *
+ * If any album fails to be queried, the queries for the remaining albums are cancelled and the error is returned. Files which had already been
+ * loaded will have been passed to @files_callback. Cancellation of @cancellable is handled as for gdata_service_query().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_picasaweb_service_query_all_files (GDataPicasaWebService *self, const gchar *username, GDataQuery *query, GCancellable *cancellable,
+                                         GDataPicasaWebFilesCallback files_callback, gpointer files_user_data, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_PICASAWEB_SERVICE (self), FALSE);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return query_all_files (self, username, query, cancellable, files_callback, files_user_data, NULL, FALSE, error);
+}
+
+typedef struct {
+	gchar *username;
+	GDataQuery *query;
+	GDataPicasaWebFilesCallback files_callback;
+	gpointer files_user_data;
+	GDestroyNotify destroy_files_user_data;
+	GMainContext *context;
+	gboolean success;
+} QueryAllFilesAsyncData;
+
+static void
+query_all_files_async_data_free (QueryAllFilesAsyncData *data)
+{
+	g_free (data->username);
+	if (data->query != NULL)
+		g_object_unref (data->query);
+
+	if (data->destroy_files_user_data != NULL)
+		data->destroy_files_user_data (data->files_user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (QueryAllFilesAsyncData, data);
+}
+
+static void
+query_all_files_thread (GSimpleAsyncResult *result, GDataPicasaWebService *service, GCancellable *cancellable)
+{
+	QueryAllFilesAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	data->success = query_all_files (service, data->username, data->query, cancellable, data->files_callback, data->files_user_data,
+	                                 data->context, TRUE, &error);
+
+	if (data->success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_picasaweb_service_query_all_files_async:
+ * @self: a #GDataPicasaWebService
+ * @username: (allow-none): the username of the user whose files you wish to retrieve, or %NULL
+ * @query: (allow-none): a #GDataQuery with the query parameters for the files, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @files_callback: (allow-none) (closure files_user_data): a #GDataPicasaWebFilesCallback to call when a batch of files is loaded, or %NULL
+ * @files_user_data: (closure): data to pass to the @files_callback function
+ * @destroy_files_user_data: (allow-none): the function to call when @files_callback will not be called any more, or %NULL. This function will be
+ * called with @files_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the query is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Queries the service for all the files in all the albums belonging to the specified @username, passing them to @files_callback as they are loaded,
+ * in idle functions in the thread-default main context of the thread which called this function (see g_main_context_push_thread_default()). @self,
+ * @username and @query are all reffed/copied when this function is called, so can safely be unreffed/freed after this function returns.
+ *
+ * For more details, see gdata_picasaweb_service_query_all_files(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_picasaweb_service_query_all_files_finish() to get the results
+ * of the operation. All the batches of files are guaranteed to have been delivered before @callback is called.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_picasaweb_service_query_all_files_async (GDataPicasaWebService *self, const gchar *username, GDataQuery *query, GCancellable *cancellable,
+                                               GDataPicasaWebFilesCallback files_callback, gpointer files_user_data,
+                                               GDestroyNotify destroy_files_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	QueryAllFilesAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_PICASAWEB_SERVICE (self));
+	g_return_if_fail (query == NULL || GDATA_IS_QUERY (query));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new0 (QueryAllFilesAsyncData);
+	data->username = g_strdup (username);
+	data->query = (query != NULL) ? g_object_ref (query) : NULL;
+	data->files_callback = files_callback;
+	data->files_user_data = files_user_data;
+	data->destroy_files_user_data = destroy_files_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_picasaweb_service_query_all_files_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) query_all_files_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) query_all_files_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_picasaweb_service_query_all_files_finish:
+ * @self: a #GDataPicasaWebService
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous query operation started with gdata_picasaweb_service_query_all_files_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_picasaweb_service_query_all_files_finish (GDataPicasaWebService *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result;
+	QueryAllFilesAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_PICASAWEB_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_return_val_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), gdata_picasaweb_service_query_all_files_async) == TRUE,
+	                      FALSE);
+
+	result = G_SIMPLE_ASYNC_RESULT (async_result);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	data = g_simple_async_result_get_op_res_gpointer (result);
+	return data->success;
+}
+
+static void
+unref_file_if_non_null (GDataPicasaWebFile *file)
+{
+	if (file != NULL)
+		g_object_unref (file);
+}
+
+/**
+ * gdata_picasaweb_service_look_up_checksums:
+ * @self: a #GDataPicasaWebService
+ * @album: (allow-none): a #GDataPicasaWebAlbum to look in, or %NULL
+ * @checksums: (array zero-terminated=1): a %NULL-terminated array of file checksums to look up
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Looks up several files in @album by their #GDataPicasaWebFile:checksum<!-- -->s at once, so that an application can check which of a set of
+ * local files have already been uploaded (and skip uploading them again) with a single listing of the album, rather than one query per file. If
+ * @album is %NULL, the currently-authenticated user's default album is searched, as with gdata_picasaweb_service_query_files().
+ *
+ * Checksums are compared exactly, so they must have been computed in the same way as those set on the uploaded files; for example, using
+ * gdata_upload_stream_get_checksum() with the same #GChecksumType. Files in the album without a checksum never match.
+ *
+ * Return value: (transfer full) (element-type GData.PicasaWebFile): an array with one element for each of @checksums, which is the
+ * #GDataPicasaWebFile in @album with that checksum, or %NULL if there isn't one; or %NULL on error. Free with g_ptr_array_unref().
+ *
+ * Since: 0.15.0
+ */
+GPtrArray *
+gdata_picasaweb_service_look_up_checksums (GDataPicasaWebService *self, GDataPicasaWebAlbum *album, const gchar * const *checksums,
+                                           GCancellable *cancellable, GError **error)
+{
+	GDataFeed *feed;
+	GHashTable *files_by_checksum;
+	GPtrArray *results;
+	const gchar *uri;
+	GList *i;
+	guint j;
+
+	g_return_val_if_fail (GDATA_IS_PICASAWEB_SERVICE (self), NULL);
+	g_return_val_if_fail (album == NULL || GDATA_IS_PICASAWEB_ALBUM (album), NULL);
+	g_return_val_if_fail (checksums != NULL, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	uri = get_query_files_uri (album, error);
+	if (uri == NULL)
+		return NULL;
+
+	feed = gdata_service_query_all (GDATA_SERVICE (self), get_picasaweb_authorization_domain (), uri, NULL, GDATA_TYPE_PICASAWEB_FILE,
+	                                MAX_CONCURRENT_PAGES, cancellable, NULL, NULL, error);
+	if (feed == NULL)
+		return NULL;
+
+	/* Index the album's files by checksum, so the look-ups are constant-time */
+	files_by_checksum = g_hash_table_new (g_str_hash, g_str_equal);
+
+	for (i = gdata_feed_get_entries (feed); i != NULL; i = i->next) {
+		const gchar *checksum = gdata_picasaweb_file_get_checksum (GDATA_PICASAWEB_FILE (i->data));
+
+		if (checksum != NULL && *checksum != '\0')
+			g_hash_table_insert (files_by_checksum, (gpointer) checksum, i->data);
+	}
+
+	results = g_ptr_array_new_with_free_func ((GDestroyNotify) unref_file_if_non_null);
+
+	for (j = 0; checksums[j] != NULL; j++) {
+		GDataPicasaWebFile *file = g_hash_table_lookup (files_by_checksum, checksums[j]);
+		g_ptr_array_add (results, (file != NULL) ? g_object_ref (file) : NULL);
+	}
+
+	g_hash_table_unref (files_by_checksum);
+	g_object_unref (feed);
+
+	return results;
+}
+
 /**
  * gdata_picasaweb_service_upload_file:
  * @self: a #GDataPicasaWebService
@@ -644,6 +1495,39 @@ gdata_picasaweb_service_upload_file (GDataPicasaWebService *self, GDataPicasaWeb
 	return upload_stream;
 }
 
+/* The EXIF data in a JPEG file is in an APP1 segment, which is at most 64 KiB long; leave room for the segments before it */
+#define EXIF_HEADER_LENGTH (128 * 1024)
+
+static void
+parse_exif_header_cb (GDataUploadStream *upload_stream, GDataEntry *entry, const guint8 *header, gsize length, gpointer user_data)
+{
+	if (GDATA_IS_PICASAWEB_FILE (entry) == TRUE)
+		gdata_picasaweb_file_update_from_exif (GDATA_PICASAWEB_FILE (entry), header, length);
+}
+
+/**
+ * gdata_picasaweb_service_parse_exif_on_upload:
+ * @self: a #GDataPicasaWebService
+ * @upload_stream: a #GDataUploadStream returned by gdata_picasaweb_service_upload_file()
+ *
+ * Sets up @upload_stream to parse the EXIF data from the start of the file as it's written, and use it to fill in any unset metadata in the
+ * #GDataPicasaWebFile being uploaded (see gdata_picasaweb_file_update_from_exif()) before the metadata is sent to the server. This saves reading
+ * the file twice: once to get its metadata and once to upload it.
+ *
+ * The first 128 KiB of the file is held back until the EXIF data has been parsed, so this must be called before any data is written to
+ * @upload_stream. See gdata_upload_stream_set_header_func().
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_picasaweb_service_parse_exif_on_upload (GDataPicasaWebService *self, GDataUploadStream *upload_stream)
+{
+	g_return_if_fail (GDATA_IS_PICASAWEB_SERVICE (self));
+	g_return_if_fail (GDATA_IS_UPLOAD_STREAM (upload_stream));
+
+	gdata_upload_stream_set_header_func (upload_stream, EXIF_HEADER_LENGTH, parse_exif_header_cb, NULL, NULL);
+}
+
 /**
  * gdata_picasaweb_service_finish_file_upload:
  * @self: a #GDataPicasaWebService
@@ -663,6 +1547,7 @@ gdata_picasaweb_service_upload_file (GDataPicasaWebService *self, GDataPicasaWeb
 GDataPicasaWebFile *
 gdata_picasaweb_service_finish_file_upload (GDataPicasaWebService *self, GDataUploadStream *upload_stream, GError **error)
 {
+	GDataPicasaWebFile *file;
 	const gchar *response_body;
 	gssize response_length;
 
@@ -676,7 +1561,51 @@ gdata_picasaweb_service_finish_file_upload (GDataPicasaWebService *self, GDataUp
 		return NULL;
 
 	/* Parse the response to produce a GDataPicasaWebFile */
-	return GDATA_PICASAWEB_FILE (gdata_parsable_new_from_xml (GDATA_TYPE_PICASAWEB_FILE, response_body, (gint) response_length, error));
+	file = GDATA_PICASAWEB_FILE (gdata_parsable_new_from_xml (GDATA_TYPE_PICASAWEB_FILE, response_body, (gint) response_length, error));
+
+	if (file != NULL)
+		add_upload_to_cached_user (self, gdata_picasaweb_file_get_size (file));
+
+	return file;
+}
+
+static GDataUploadStream *
+upload_queue_start_cb (GDataService *service, GDataEntry *entry, const gchar *slug, const gchar *content_type, GCancellable *cancellable,
+                       GDataPicasaWebAlbum *album, GError **error)
+{
+	return gdata_picasaweb_service_upload_file (GDATA_PICASAWEB_SERVICE (service), album, GDATA_PICASAWEB_FILE (entry), slug, content_type,
+	                                            cancellable, error);
+}
+
+static GDataEntry *
+upload_queue_finish_cb (GDataService *service, GDataUploadStream *upload_stream, GDataPicasaWebAlbum *album, GError **error)
+{
+	return GDATA_ENTRY (gdata_picasaweb_service_finish_file_upload (GDATA_PICASAWEB_SERVICE (service), upload_stream, error));
+}
+
+/**
+ * gdata_picasaweb_service_create_upload_queue:
+ * @self: a #GDataPicasaWebService
+ * @album: (allow-none): a #GDataPicasaWebAlbum into which to insert the files, or %NULL
+ *
+ * Creates a new #GDataUploadQueue for uploading several files to @album in parallel. If @album is %NULL, the files will be uploaded to the currently
+ * authenticated user's "Drop Box" album, as with gdata_picasaweb_service_upload_file(). The entries added to the queue with
+ * gdata_upload_queue_add_file() must be #GDataPicasaWebFile<!-- -->s, and the uploaded entries passed to the queue's callbacks are also
+ * #GDataPicasaWebFile<!-- -->s.
+ *
+ * Return value: (transfer full): a new #GDataUploadQueue; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataUploadQueue *
+gdata_picasaweb_service_create_upload_queue (GDataPicasaWebService *self, GDataPicasaWebAlbum *album)
+{
+	g_return_val_if_fail (GDATA_IS_PICASAWEB_SERVICE (self), NULL);
+	g_return_val_if_fail (album == NULL || GDATA_IS_PICASAWEB_ALBUM (album), NULL);
+
+	return _gdata_upload_queue_new (GDATA_SERVICE (self), GDATA_TYPE_PICASAWEB_FILE, (GDataUploadQueueStartFunc) upload_queue_start_cb,
+	                                (GDataUploadQueueFinishFunc) upload_queue_finish_cb, (album != NULL) ? g_object_ref (album) : NULL,
+	                                (GDestroyNotify) g_object_unref);
 }
 
 /**
@@ -26,6 +26,7 @@
 
 #include <gdata/gdata-service.h>
 #include <gdata/gdata-upload-stream.h>
+#include <gdata/gdata-upload-queue.h>
 #include <gdata/services/picasaweb/gdata-picasaweb-album.h>
 #include <gdata/services/picasaweb/gdata-picasaweb-user.h>
 
@@ -38,6 +39,8 @@ G_BEGIN_DECLS
 #define GDATA_IS_PICASAWEB_SERVICE_CLASS(k)	(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_PICASAWEB_SERVICE))
 #define GDATA_PICASAWEB_SERVICE_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_PICASAWEB_SERVICE, GDataPicasaWebServiceClass))
 
+typedef struct _GDataPicasaWebServicePrivate	GDataPicasaWebServicePrivate;
+
 /**
  * GDataPicasaWebService:
  *
@@ -47,6 +50,7 @@ G_BEGIN_DECLS
  **/
 typedef struct {
 	GDataService parent;
+	GDataPicasaWebServicePrivate *priv;
 } GDataPicasaWebService;
 
 /**
@@ -76,6 +80,15 @@ void gdata_picasaweb_service_get_user_async (GDataPicasaWebService *self, const
 GDataPicasaWebUser *gdata_picasaweb_service_get_user_finish (GDataPicasaWebService *self, GAsyncResult *result,
                                                              GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
+GDataPicasaWebUser *gdata_picasaweb_service_get_cached_user (GDataPicasaWebService *self, const gchar *username, GCancellable *cancellable,
+                                                             GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_picasaweb_service_get_cached_user_async (GDataPicasaWebService *self, const gchar *username, GCancellable *cancellable,
+                                                    GAsyncReadyCallback callback, gpointer user_data);
+GDataPicasaWebUser *gdata_picasaweb_service_get_cached_user_finish (GDataPicasaWebService *self, GAsyncResult *async_result,
+                                                                    GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+guint gdata_picasaweb_service_get_user_cache_ttl (GDataPicasaWebService *self) G_GNUC_PURE;
+void gdata_picasaweb_service_set_user_cache_ttl (GDataPicasaWebService *self, guint user_cache_ttl);
+
 GDataFeed *gdata_picasaweb_service_query_all_albums (GDataPicasaWebService *self, GDataQuery *query, const gchar *username, GCancellable *cancellable,
                                                      GDataQueryProgressCallback progress_callback, gpointer progress_user_data,
                                                      GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
@@ -94,11 +107,40 @@ void gdata_picasaweb_service_query_files_async (GDataPicasaWebService *self, GDa
 
 #include <gdata/services/picasaweb/gdata-picasaweb-file.h>
 
+/**
+ * GDataPicasaWebFilesCallback:
+ * @album: the album the files are in
+ * @files: (element-type GData.PicasaWebFile): an array of new #GDataPicasaWebFile<!-- -->s from @album
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called for each batch of #GDataPicasaWebFile<!-- -->s loaded by gdata_picasaweb_service_query_all_files(). @files is owned by
+ * libgdata, and the files in it must be reffed if they're to be kept after the callback returns.
+ *
+ * The batches for each album are delivered in feed order, but batches from different albums may be interleaved. The callback is called in the
+ * thread which called gdata_picasaweb_service_query_all_files(), or in the main thread if gdata_picasaweb_service_query_all_files_async() was used.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataPicasaWebFilesCallback) (GDataPicasaWebAlbum *album, GPtrArray *files, gpointer user_data);
+
+gboolean gdata_picasaweb_service_query_all_files (GDataPicasaWebService *self, const gchar *username, GDataQuery *query, GCancellable *cancellable,
+                                                  GDataPicasaWebFilesCallback files_callback, gpointer files_user_data, GError **error);
+void gdata_picasaweb_service_query_all_files_async (GDataPicasaWebService *self, const gchar *username, GDataQuery *query, GCancellable *cancellable,
+                                                    GDataPicasaWebFilesCallback files_callback, gpointer files_user_data,
+                                                    GDestroyNotify destroy_files_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_picasaweb_service_query_all_files_finish (GDataPicasaWebService *self, GAsyncResult *async_result, GError **error);
+
+GPtrArray *gdata_picasaweb_service_look_up_checksums (GDataPicasaWebService *self, GDataPicasaWebAlbum *album, const gchar * const *checksums,
+                                                     GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
 GDataUploadStream *gdata_picasaweb_service_upload_file (GDataPicasaWebService *self, GDataPicasaWebAlbum *album, GDataPicasaWebFile *file_entry,
                                                         const gchar *slug, const gchar *content_type, GCancellable *cancellable,
                                                         GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+void gdata_picasaweb_service_parse_exif_on_upload (GDataPicasaWebService *self, GDataUploadStream *upload_stream);
 GDataPicasaWebFile *gdata_picasaweb_service_finish_file_upload (GDataPicasaWebService *self, GDataUploadStream *upload_stream,
                                                                 GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GDataUploadQueue *gdata_picasaweb_service_create_upload_queue (GDataPicasaWebService *self,
+                                                               GDataPicasaWebAlbum *album) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
 GDataPicasaWebAlbum *gdata_picasaweb_service_insert_album (GDataPicasaWebService *self, GDataPicasaWebAlbum *album, GCancellable *cancellable,
                                                            GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
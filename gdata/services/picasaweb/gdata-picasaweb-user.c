@@ -337,6 +337,20 @@ gdata_picasaweb_user_get_quota_current (GDataPicasaWebUser *self)
 	return self->priv->quota_current;
 }
 
+/* Adjusts the quota in use by @delta bytes, as when a file has been uploaded, so that the user doesn't have to be queried again to find out */
+void
+_gdata_picasaweb_user_add_to_quota_current (GDataPicasaWebUser *self, gint64 delta)
+{
+	g_return_if_fail (GDATA_IS_PICASAWEB_USER (self));
+
+	/* The quota isn't known, so there's nothing to adjust */
+	if (self->priv->quota_current < 0)
+		return;
+
+	self->priv->quota_current = MAX (self->priv->quota_current + delta, 0);
+	g_object_notify (G_OBJECT (self), "quota-current");
+}
+
 /**
  * gdata_picasaweb_user_get_max_photos_per_album:
  * @self: a #GDataPicasaWebUser
@@ -26,6 +26,11 @@
  * #GDataTasksQuery represents a collection of query parameters specific to the Google Tasks service, which go above and beyond
  * those catered for by #GDataQuery.
  *
+ * Of the #GDataQuery properties, #GDataQuery:max-results, #GDataQuery:updated-min and #GDataQuery:fields are supported. Only tasks modified
+ * since #GDataQuery:updated-min are returned, so combining it with #GDataTasksQuery:show-deleted and #GDataTasksQuery:show-hidden allows a local
+ * copy of a tasklist to be kept up to date incrementally; #GDataTasksSync does this. Pages of results are walked using gdata_query_next_page() as
+ * normal.
+ *
  * For more details of Google Tasks API, see the <ulink type="http" url="https://developers.google.com/google-apps/tasks/v1/reference/">
  * online documentation</ulink>.
  *
@@ -40,6 +45,7 @@
 #include "gdata-tasks-query.h"
 #include "gdata-query.h"
 #include "gdata-parser.h"
+#include "gdata-private.h"
 
 static void gdata_tasks_query_finalize (GObject *object);
 static void gdata_tasks_query_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
@@ -282,6 +288,13 @@ get_query_uri (GDataQuery *self, const gchar *feed_uri, GString *query_uri, gboo
 		g_string_append_printf (query_uri, "maxResults=%u", gdata_query_get_max_results (GDATA_QUERY (self)));
 	}
 
+	/* Set once gdata_query_next_page() has been called; the Tasks API doesn't support start-index */
+	if (_gdata_query_get_page_token (GDATA_QUERY (self)) != NULL) {
+		APPEND_SEP
+		g_string_append (query_uri, "pageToken=");
+		g_string_append_uri_escaped (query_uri, _gdata_query_get_page_token (GDATA_QUERY (self)), NULL, FALSE);
+	}
+
 	if (gdata_query_get_updated_min (GDATA_QUERY (self)) != -1) {
 		gchar *updated_min;
 
@@ -353,6 +366,13 @@ get_query_uri (GDataQuery *self, const gchar *feed_uri, GString *query_uri, gboo
 		g_string_append (query_uri, "showHidden=false");
 	}
 
+	/* The Tasks API uses the same partial response syntax as the GData protocol */
+	if (gdata_query_get_fields (GDATA_QUERY (self)) != NULL) {
+		APPEND_SEP
+		g_string_append (query_uri, "fields=");
+		g_string_append_uri_escaped (query_uri, gdata_query_get_fields (GDATA_QUERY (self)), NULL, FALSE);
+	}
+
 	/* We don't chain up with parent class get_query_uri because it uses
 	 *  GData protocol parameters and they aren't compatible with newest API family
 	 */
@@ -42,6 +42,7 @@
 #include "gdata-private.h"
 #include "gdata-query.h"
 #include "gdata-feed.h"
+#include "gdata-batch-operation.h"
 
 /* Standards reference here: https://developers.google.com/google-apps/tasks/v1/reference/ */
 
@@ -679,3 +680,971 @@ gdata_tasks_service_update_tasklist_async (GDataTasksService *self, GDataTasksTa
 	gdata_service_update_entry_async (GDATA_SERVICE (self), get_tasks_authorization_domain (), GDATA_ENTRY (tasklist), cancellable,
 	                                  callback, user_data);
 }
+
+/* The Tasks API's batch endpoint takes a multipart/mixed request with one embedded HTTP request per part, and returns a multipart/mixed response
+ * with one embedded HTTP response per part. See: https://developers.google.com/google-apps/tasks/batch */
+#define MAX_BATCH_PARTS 50 /* the most requests the server accepts in one batch */
+
+/* Backoff after the server asks us to slow down. The delay is shared by all the requests in an operation; it doubles each time the server asks,
+ * and is reset whenever a request succeeds. */
+#define MAX_BATCH_ATTEMPTS 6
+#define INITIAL_BACKOFF_DELAY 1 /* seconds */
+#define MAX_BACKOFF_DELAY 32 /* seconds */
+
+typedef struct {
+	guint index;
+	GDataTasksTask *task;
+	GDataTasksTask *result; /* NULL on error, and for deletions */
+	GError *error;
+	guint n_attempts;
+	GDataTasksServiceBatchCallback callback;
+	gpointer user_data;
+} TasksBatchItem;
+
+typedef struct {
+	GDataTasksService *service;
+	GDataBatchOperationType operation_type;
+	GDataTasksTasklist *tasklist; /* only for insertions */
+	GCancellable *cancellable;
+	GThreadPool *pool; /* GPtrArrays of TasksBatchItems */
+	GAsyncQueue *results; /* TasksBatchItems, once they're finished */
+
+	GMutex mutex;
+	GCond cond; /* signalled on cancellation, to wake up threads which are backing off */
+	gboolean batching_unavailable; /* TRUE once the batch endpoint has rejected a request; everything is then sent individually */
+	gint64 resume_time; /* monotonic time before which no more requests may be sent */
+	guint backoff_delay; /* seconds */
+	GError *error; /* the first error which failed a whole batch request */
+} TasksBatchData;
+
+static void
+tasks_batch_item_free (TasksBatchItem *item)
+{
+	g_object_unref (item->task);
+	if (item->result != NULL)
+		g_object_unref (item->result);
+	if (item->error != NULL)
+		g_error_free (item->error);
+
+	g_slice_free (TasksBatchItem, item);
+}
+
+/* Run the user-supplied callback for an item. This is designed to be used in an idle handler, so that the callback is run in the thread which
+ * started the operation. */
+static gboolean
+tasks_batch_item_callback_cb (TasksBatchItem *item)
+{
+	item->callback (item->index, item->task, item->result, item->error, item->user_data);
+	return FALSE;
+}
+
+static void
+tasks_batch_cancelled_cb (GCancellable *cancellable, TasksBatchData *data)
+{
+	g_mutex_lock (&(data->mutex));
+	g_cond_broadcast (&(data->cond));
+	g_mutex_unlock (&(data->mutex));
+}
+
+static GDataOperationType
+get_operation_type (TasksBatchData *data)
+{
+	switch (data->operation_type) {
+		case GDATA_BATCH_OPERATION_INSERTION:
+			return GDATA_OPERATION_INSERTION;
+		case GDATA_BATCH_OPERATION_UPDATE:
+			return GDATA_OPERATION_UPDATE;
+		case GDATA_BATCH_OPERATION_DELETION:
+			return GDATA_OPERATION_DELETION;
+		case GDATA_BATCH_OPERATION_QUERY:
+		default:
+			g_assert_not_reached ();
+	}
+}
+
+/* Builds the request for @item's operation, returning its URI. The method is returned in @method and the JSON body (if any) in @body. These are
+ * the same as the requests made by gdata_service_insert_entry(), gdata_service_update_entry() and gdata_service_delete_entry(). */
+static gchar *
+build_item_request (TasksBatchData *data, TasksBatchItem *item, const gchar **method, gchar **body)
+{
+	GDataLink *_link;
+
+	if (data->operation_type == GDATA_BATCH_OPERATION_INSERTION) {
+		*method = SOUP_METHOD_POST;
+		*body = gdata_parsable_get_json (GDATA_PARSABLE (item->task));
+
+		return g_strconcat (_gdata_service_get_scheme (), "://www.googleapis.com/tasks/v1/lists/",
+		                    gdata_entry_get_id (GDATA_ENTRY (data->tasklist)), "/tasks", NULL);
+	}
+
+	if (data->operation_type == GDATA_BATCH_OPERATION_UPDATE) {
+		*method = (gdata_entry_is_partial (GDATA_ENTRY (item->task)) == TRUE) ? "PATCH" : SOUP_METHOD_PUT;
+		*body = gdata_parsable_get_json (GDATA_PARSABLE (item->task));
+	} else {
+		*method = SOUP_METHOD_DELETE;
+		*body = NULL;
+	}
+
+	_link = gdata_entry_look_up_link (GDATA_ENTRY (item->task), GDATA_LINK_SELF);
+	g_assert (_link != NULL);
+
+	return _gdata_service_fix_uri_scheme (gdata_link_get_uri (_link));
+}
+
+/* Returns %TRUE if @status and @body are the server asking us to slow down, rather than a real failure */
+static gboolean
+is_rate_limited (guint status, const gchar *body, gsize length)
+{
+	if (status == 429 /* Too Many Requests */ || status == SOUP_STATUS_SERVICE_UNAVAILABLE)
+		return TRUE;
+
+	/* Quota errors are 403s, distinguished from permission errors by the reason in the JSON error body */
+	return (status == SOUP_STATUS_FORBIDDEN && body != NULL &&
+	        (g_strstr_len (body, length, "rateLimitExceeded") != NULL || g_strstr_len (body, length, "RateLimitExceeded") != NULL)) ? TRUE : FALSE;
+}
+
+/* Stops any more requests being sent until the backoff delay has passed (or @retry_after seconds, if the server gave a Retry-After header), and
+ * doubles the delay for next time. */
+static void
+back_off (TasksBatchData *data, const gchar *retry_after)
+{
+	guint64 delay;
+
+	g_mutex_lock (&(data->mutex));
+
+	delay = data->backoff_delay;
+	if (retry_after != NULL && g_ascii_strtoull (retry_after, NULL, 10) > 0)
+		delay = MIN (g_ascii_strtoull (retry_after, NULL, 10), MAX_BACKOFF_DELAY);
+
+	data->resume_time = MAX (data->resume_time, g_get_monotonic_time () + (gint64) delay * G_TIME_SPAN_SECOND);
+	data->backoff_delay = MIN (data->backoff_delay * 2, MAX_BACKOFF_DELAY);
+
+	g_mutex_unlock (&(data->mutex));
+}
+
+/* Waits until requests may be sent again after backing off. Returns %FALSE if the operation was cancelled while waiting. */
+static gboolean
+wait_for_backoff (TasksBatchData *data)
+{
+	gboolean cancelled;
+
+	g_mutex_lock (&(data->mutex));
+
+	while ((cancelled = g_cancellable_is_cancelled (data->cancellable)) == FALSE && data->resume_time > g_get_monotonic_time ())
+		g_cond_wait_until (&(data->cond), &(data->mutex), data->resume_time);
+
+	g_mutex_unlock (&(data->mutex));
+
+	return (cancelled == FALSE) ? TRUE : FALSE;
+}
+
+/* Handles the response to @item's request, whether it was sent individually or as part of a batch. Returns %FALSE if the request should be
+ * retried because the server asked us to slow down, or %TRUE once the item is finished (successfully or otherwise). */
+static gboolean
+parse_item_response (TasksBatchData *data, TasksBatchItem *item, guint status, const gchar *reason_phrase, const gchar *retry_after,
+                     const gchar *body, gsize length)
+{
+	if (is_rate_limited (status, body, length) == TRUE && ++item->n_attempts < MAX_BATCH_ATTEMPTS) {
+		back_off (data, retry_after);
+		return FALSE;
+	} else if (SOUP_STATUS_IS_SUCCESSFUL (status) == FALSE) {
+		GDataServiceClass *service_klass = GDATA_SERVICE_GET_CLASS (data->service);
+		g_assert (service_klass->parse_error_response != NULL);
+		service_klass->parse_error_response (GDATA_SERVICE (data->service), get_operation_type (data), status, reason_phrase, body, length,
+		                                     &(item->error));
+		return TRUE;
+	}
+
+	g_mutex_lock (&(data->mutex));
+	data->backoff_delay = INITIAL_BACKOFF_DELAY;
+	g_mutex_unlock (&(data->mutex));
+
+	/* Deletions return no content */
+	if (data->operation_type != GDATA_BATCH_OPERATION_DELETION)
+		item->result = GDATA_TASKS_TASK (gdata_parsable_new_from_json (GDATA_TYPE_TASKS_TASK, body, length, &(item->error)));
+
+	return TRUE;
+}
+
+/* Sends @item's request on its own, retrying it for as long as the server asks us to slow down */
+static void
+send_item (TasksBatchData *data, TasksBatchItem *item)
+{
+	gboolean finished = FALSE;
+
+	while (finished == FALSE) {
+		SoupMessage *message;
+		const gchar *method;
+		gchar *uri, *body;
+		guint status;
+
+		if (wait_for_backoff (data) == FALSE) {
+			g_cancellable_set_error_if_cancelled (data->cancellable, &(item->error));
+			return;
+		}
+
+		uri = build_item_request (data, item, &method, &body);
+		message = _gdata_service_build_message (GDATA_SERVICE (data->service), get_tasks_authorization_domain (), method, uri,
+		                                        (data->operation_type != GDATA_BATCH_OPERATION_INSERTION) ?
+		                                                gdata_entry_get_etag (GDATA_ENTRY (item->task)) : NULL,
+		                                        TRUE);
+		g_free (uri);
+
+		if (body != NULL)
+			soup_message_set_request (message, "application/json", SOUP_MEMORY_TAKE, body, strlen (body));
+
+		status = _gdata_service_send_message (GDATA_SERVICE (data->service), message, data->cancellable, &(item->error));
+
+		if (status == SOUP_STATUS_NONE || status == SOUP_STATUS_CANCELLED) {
+			/* Redirect error or cancelled; the error's already been set */
+			finished = TRUE;
+		} else {
+			finished = parse_item_response (data, item, status, message->reason_phrase,
+			                                soup_message_headers_get_one (message->response_headers, "Retry-After"),
+			                                message->response_body->data, message->response_body->length);
+		}
+
+		g_object_unref (message);
+	}
+}
+
+/* Appends @item's request to @multipart as an embedded HTTP request, identified by its @position in the batch */
+static void
+append_batch_part (TasksBatchData *data, SoupMultipart *multipart, TasksBatchItem *item, guint position)
+{
+	SoupMessageHeaders *headers;
+	SoupBuffer *buffer;
+	SoupURI *uri;
+	GString *request;
+	const gchar *method, *etag;
+	gchar *uri_string, *path, *body, *content_id;
+	gsize length;
+
+	uri_string = build_item_request (data, item, &method, &body);
+	uri = soup_uri_new (uri_string);
+	path = soup_uri_to_string (uri, TRUE);
+	soup_uri_free (uri);
+	g_free (uri_string);
+
+	request = g_string_new (NULL);
+	g_string_append_printf (request, "%s %s HTTP/1.1\r\n", method, path);
+	g_free (path);
+
+	etag = gdata_entry_get_etag (GDATA_ENTRY (item->task));
+	if (data->operation_type != GDATA_BATCH_OPERATION_INSERTION && etag != NULL)
+		g_string_append_printf (request, "If-Match: %s\r\n", etag);
+
+	if (body != NULL) {
+		g_string_append_printf (request, "Content-Type: application/json\r\nContent-Length: %" G_GSIZE_FORMAT "\r\n\r\n%s", strlen (body), body);
+		g_free (body);
+	} else {
+		g_string_append (request, "\r\n");
+	}
+
+	headers = soup_message_headers_new (SOUP_MESSAGE_HEADERS_MULTIPART);
+	soup_message_headers_append (headers, "Content-Type", "application/http");
+	content_id = g_strdup_printf ("<item-%u>", position);
+	soup_message_headers_append (headers, "Content-ID", content_id);
+	g_free (content_id);
+
+	length = request->len;
+	buffer = soup_buffer_new (SOUP_MEMORY_TAKE, g_string_free (request, FALSE), length);
+
+	/* The multipart takes copies of both */
+	soup_multipart_append_part (multipart, headers, buffer);
+
+	soup_buffer_free (buffer);
+	soup_message_headers_free (headers);
+}
+
+/* Parses one part of a batch response, which is an embedded HTTP response to the request with the same position in the batch. Returns the
+ * position, or -1 if the part isn't valid. */
+static gint
+parse_batch_part (TasksBatchData *data, GPtrArray *items, SoupMessageHeaders *part_headers, SoupBuffer *part_body, gboolean *finished)
+{
+	SoupMessageHeaders *headers;
+	const gchar *content_id, *header_end;
+	gchar *reason_phrase = NULL, *body, *end;
+	guint64 position;
+	guint status;
+
+	/* Response parts are identified as <response-item-N>, for the request part identified as <item-N> */
+	content_id = soup_message_headers_get_one (part_headers, "Content-ID");
+	if (content_id == NULL || g_str_has_prefix (content_id, "<response-item-") == FALSE)
+		return -1;
+
+	position = g_ascii_strtoull (content_id + strlen ("<response-item-"), &end, 10);
+	if (*end != '>' || position >= items->len)
+		return -1;
+
+	header_end = g_strstr_len (part_body->data, part_body->length, "\r\n\r\n");
+	if (header_end == NULL)
+		return -1;
+	header_end += strlen ("\r\n\r\n");
+
+	headers = soup_message_headers_new (SOUP_MESSAGE_HEADERS_RESPONSE);
+
+	if (soup_headers_parse_response (part_body->data, header_end - part_body->data, headers, NULL, &status, &reason_phrase) == FALSE) {
+		soup_message_headers_free (headers);
+		return -1;
+	}
+
+	/* Copy the body so that it's nul-terminated for error messages */
+	body = g_strndup (header_end, part_body->data + part_body->length - header_end);
+	*finished = parse_item_response (data, items->pdata[position], status, reason_phrase,
+	                                 soup_message_headers_get_one (headers, "Retry-After"), body, strlen (body));
+	g_free (body);
+
+	g_free (reason_phrase);
+	soup_message_headers_free (headers);
+
+	return position;
+}
+
+static void
+finish_item (TasksBatchData *data, TasksBatchItem *item)
+{
+	g_async_queue_push (data->results, item);
+}
+
+/* Sends @items as one batch request. Items which the server asks us to slow down for are queued again as a new batch, after backing off. If the
+ * batch endpoint isn't available, the items are sent individually instead. */
+static void
+send_batch (TasksBatchData *data, GPtrArray *items)
+{
+	SoupMessage *message;
+	SoupMultipart *multipart;
+	GPtrArray *retry_items;
+	gboolean *answered;
+	GError *error = NULL;
+	gchar *batch_uri;
+	guint status, i;
+
+	if (wait_for_backoff (data) == FALSE) {
+		for (i = 0; i < items->len; i++) {
+			TasksBatchItem *item = items->pdata[i];
+			g_cancellable_set_error_if_cancelled (data->cancellable, &(item->error));
+			finish_item (data, item);
+		}
+
+		return;
+	}
+
+	batch_uri = g_strconcat (_gdata_service_get_scheme (), "://www.googleapis.com/batch/tasks/v1", NULL);
+	message = _gdata_service_build_message (GDATA_SERVICE (data->service), get_tasks_authorization_domain (), SOUP_METHOD_POST, batch_uri, NULL,
+	                                        FALSE);
+	g_free (batch_uri);
+
+	multipart = soup_multipart_new ("multipart/mixed");
+	for (i = 0; i < items->len; i++)
+		append_batch_part (data, multipart, items->pdata[i], i);
+	soup_multipart_to_message (multipart, message->request_headers, message->request_body);
+	soup_multipart_free (multipart);
+
+	status = _gdata_service_send_message (GDATA_SERVICE (data->service), message, data->cancellable, &error);
+
+	if (status == SOUP_STATUS_NOT_FOUND || status == SOUP_STATUS_GONE || status == SOUP_STATUS_NOT_IMPLEMENTED) {
+		/* The batch endpoint isn't available, so fall back to sending everything individually from now on */
+		g_object_unref (message);
+		g_clear_error (&error);
+
+		g_mutex_lock (&(data->mutex));
+		data->batching_unavailable = TRUE;
+		g_mutex_unlock (&(data->mutex));
+
+		for (i = 0; i < items->len; i++) {
+			send_item (data, items->pdata[i]);
+			finish_item (data, items->pdata[i]);
+		}
+
+		return;
+	} else if (status != SOUP_STATUS_NONE && status != SOUP_STATUS_CANCELLED &&
+	           is_rate_limited (status, message->response_body->data, message->response_body->length) == TRUE &&
+	           ++((TasksBatchItem *) items->pdata[0])->n_attempts < MAX_BATCH_ATTEMPTS) {
+		/* The whole batch was rejected; try it again later. Attempts at whole batches are counted against their first item. */
+		back_off (data, soup_message_headers_get_one (message->response_headers, "Retry-After"));
+		g_object_unref (message);
+
+		g_thread_pool_push (data->pool, g_ptr_array_ref (items), NULL);
+
+		return;
+	} else if (status == SOUP_STATUS_NONE || status == SOUP_STATUS_CANCELLED) {
+		/* Redirect error or cancelled; the error should already have been set */
+		if (error == NULL)
+			g_cancellable_set_error_if_cancelled (data->cancellable, &error);
+		if (error == NULL)
+			g_set_error (&error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_WITH_BATCH_OPERATION,
+			             /* Translators: the first parameter is a HTTP status,
+			              * and the second is an error message returned by the server. */
+			             _("Error code %u when running a batch operation: %s"), status, message->reason_phrase);
+	} else if (status != SOUP_STATUS_OK) {
+		GDataServiceClass *service_klass = GDATA_SERVICE_GET_CLASS (data->service);
+		g_assert (service_klass->parse_error_response != NULL);
+		service_klass->parse_error_response (GDATA_SERVICE (data->service), GDATA_OPERATION_BATCH, status, message->reason_phrase,
+		                                     message->response_body->data, message->response_body->length, &error);
+	} else if ((multipart = soup_multipart_new_from_message (message->response_headers, message->response_body)) == NULL) {
+		g_set_error (&error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+		             /* Translators: the parameter is an error message returned by the server. */
+		             _("Error code %u when running a batch operation: %s"), status, _("The response was not a multipart message."));
+	}
+
+	/* Fail every item if the request failed as a whole */
+	if (error != NULL) {
+		g_mutex_lock (&(data->mutex));
+		if (data->error == NULL)
+			data->error = g_error_copy (error);
+		g_mutex_unlock (&(data->mutex));
+
+		for (i = 0; i < items->len; i++) {
+			TasksBatchItem *item = items->pdata[i];
+			item->error = g_error_copy (error);
+			finish_item (data, item);
+		}
+
+		g_error_free (error);
+		g_object_unref (message);
+
+		return;
+	}
+
+	answered = g_new0 (gboolean, items->len);
+	retry_items = g_ptr_array_new ();
+
+	for (i = 0; i < (guint) soup_multipart_get_length (multipart); i++) {
+		SoupMessageHeaders *part_headers;
+		SoupBuffer *part_body;
+		gboolean finished;
+		gint position;
+
+		if (soup_multipart_get_part (multipart, i, &part_headers, &part_body) == FALSE)
+			continue;
+
+		position = parse_batch_part (data, items, part_headers, part_body, &finished);
+		if (position < 0 || answered[position] == TRUE)
+			continue;
+
+		answered[position] = TRUE;
+
+		if (finished == TRUE)
+			finish_item (data, items->pdata[position]);
+		else
+			g_ptr_array_add (retry_items, items->pdata[position]);
+	}
+
+	/* Any requests the server didn't respond to have failed */
+	for (i = 0; i < items->len; i++) {
+		TasksBatchItem *item = items->pdata[i];
+
+		if (answered[i] == TRUE)
+			continue;
+
+		g_set_error_literal (&(item->error), GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+		                     _("The server did not return a response for this task in the batch response."));
+		finish_item (data, item);
+	}
+
+	if (retry_items->len > 0)
+		g_thread_pool_push (data->pool, retry_items, NULL);
+	else
+		g_ptr_array_unref (retry_items);
+
+	g_free (answered);
+	soup_multipart_free (multipart);
+	g_object_unref (message);
+}
+
+static void
+tasks_batch_thread (GPtrArray *items, TasksBatchData *data)
+{
+	gboolean batching_unavailable;
+	guint i;
+
+	g_mutex_lock (&(data->mutex));
+	batching_unavailable = data->batching_unavailable;
+	g_mutex_unlock (&(data->mutex));
+
+	/* There's no point wrapping a single request in a batch */
+	if (items->len > 1 && batching_unavailable == FALSE) {
+		send_batch (data, items);
+	} else {
+		for (i = 0; i < items->len; i++) {
+			send_item (data, items->pdata[i]);
+			finish_item (data, items->pdata[i]);
+		}
+	}
+
+	g_ptr_array_unref (items);
+}
+
+static gboolean
+run_tasks_batch (GDataTasksService *self, GDataBatchOperationType operation_type, GList *tasks, GDataTasksTasklist *tasklist,
+                 GCancellable *cancellable, GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data, GMainContext *context,
+                 gboolean is_async, GError **error)
+{
+	TasksBatchData data;
+	GPtrArray *chunk = NULL;
+	GList *i;
+	gulong cancelled_signal = 0;
+	guint n_pending = 0;
+
+	/* Nothing to do */
+	if (tasks == NULL)
+		return TRUE;
+
+	data.service = self;
+	data.operation_type = operation_type;
+	data.tasklist = tasklist;
+	data.cancellable = cancellable;
+	data.results = g_async_queue_new ();
+	g_mutex_init (&(data.mutex));
+	g_cond_init (&(data.cond));
+	data.batching_unavailable = FALSE;
+	data.resume_time = 0;
+	data.backoff_delay = INITIAL_BACKOFF_DELAY;
+	data.error = NULL;
+
+	if (cancellable != NULL)
+		cancelled_signal = g_cancellable_connect (cancellable, (GCallback) tasks_batch_cancelled_cb, &data, NULL);
+
+	/* Send as many batches (or individual requests, if batching isn't available) at once as we have connections for */
+	data.pool = g_thread_pool_new ((GFunc) tasks_batch_thread, &data, MAX (gdata_service_get_max_connections_per_host (GDATA_SERVICE (self)), 1),
+	                               FALSE, NULL);
+
+	for (i = tasks; i != NULL; i = i->next) {
+		TasksBatchItem *item = g_slice_new0 (TasksBatchItem);
+		item->index = n_pending++;
+		item->task = g_object_ref (i->data);
+
+		if (chunk == NULL)
+			chunk = g_ptr_array_sized_new (MAX_BATCH_PARTS);
+		g_ptr_array_add (chunk, item);
+
+		if (chunk->len == MAX_BATCH_PARTS) {
+			g_thread_pool_push (data.pool, chunk, NULL);
+			chunk = NULL;
+		}
+	}
+
+	if (chunk != NULL)
+		g_thread_pool_push (data.pool, chunk, NULL);
+
+	/* Deliver the results as they arrive. As with GDataBatchOperation, only dispatch the callbacks in the thread-default main context of the
+	 * thread which started the operation if it was started asynchronously. */
+	for (; n_pending > 0; n_pending--) {
+		TasksBatchItem *item = g_async_queue_pop (data.results);
+
+		if (batch_callback == NULL) {
+			tasks_batch_item_free (item);
+			continue;
+		}
+
+		item->callback = batch_callback;
+		item->user_data = batch_user_data;
+
+		if (is_async == TRUE) {
+			_gdata_service_idle_add (context, (GSourceFunc) tasks_batch_item_callback_cb, item, (GDestroyNotify) tasks_batch_item_free);
+		} else {
+			tasks_batch_item_callback_cb (item);
+			tasks_batch_item_free (item);
+		}
+	}
+
+	g_thread_pool_free (data.pool, FALSE, TRUE);
+
+	if (cancelled_signal != 0)
+		g_cancellable_disconnect (cancellable, cancelled_signal);
+
+	g_async_queue_unref (data.results);
+	g_cond_clear (&(data.cond));
+	g_mutex_clear (&(data.mutex));
+
+	/* Cancellation of the whole operation is always reported, as are failures of whole batch requests */
+	if (g_cancellable_set_error_if_cancelled (cancellable, error) == TRUE) {
+		g_clear_error (&(data.error));
+		return FALSE;
+	} else if (data.error != NULL) {
+		g_propagate_error (error, data.error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+typedef struct {
+	GDataBatchOperationType operation_type;
+	GList *tasks;
+	GDataTasksTasklist *tasklist;
+	GDataTasksServiceBatchCallback batch_callback;
+	gpointer batch_user_data;
+	GDestroyNotify destroy_batch_user_data;
+	GMainContext *context;
+} TasksBatchAsyncData;
+
+static void
+tasks_batch_async_data_free (TasksBatchAsyncData *data)
+{
+	g_list_free_full (data->tasks, g_object_unref);
+	if (data->tasklist != NULL)
+		g_object_unref (data->tasklist);
+
+	if (data->destroy_batch_user_data != NULL)
+		data->destroy_batch_user_data (data->batch_user_data);
+
+	g_main_context_unref (data->context);
+
+	g_slice_free (TasksBatchAsyncData, data);
+}
+
+static void
+tasks_batch_async_thread (GSimpleAsyncResult *result, GDataTasksService *service, GCancellable *cancellable)
+{
+	TasksBatchAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	if (run_tasks_batch (service, data->operation_type, data->tasks, data->tasklist, cancellable, data->batch_callback, data->batch_user_data,
+	                     data->context, TRUE, &error) == FALSE) {
+		g_simple_async_result_take_error (result, error);
+	}
+}
+
+static void
+run_tasks_batch_async (GDataTasksService *self, GDataBatchOperationType operation_type, GList *tasks, GDataTasksTasklist *tasklist,
+                       GCancellable *cancellable, GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data,
+                       GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data, gpointer source_tag)
+{
+	GSimpleAsyncResult *result;
+	TasksBatchAsyncData *data;
+
+	data = g_slice_new0 (TasksBatchAsyncData);
+	data->operation_type = operation_type;
+	data->tasks = g_list_copy (tasks);
+	g_list_foreach (data->tasks, (GFunc) g_object_ref, NULL);
+	data->tasklist = (tasklist != NULL) ? g_object_ref (tasklist) : NULL;
+	data->batch_callback = batch_callback;
+	data->batch_user_data = batch_user_data;
+	data->destroy_batch_user_data = destroy_batch_user_data;
+	data->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, source_tag);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) tasks_batch_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) tasks_batch_async_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+static gboolean
+run_tasks_batch_finish (GDataTasksService *self, GAsyncResult *async_result, gpointer source_tag, GError **error)
+{
+	g_return_val_if_fail (g_simple_async_result_is_valid (async_result, G_OBJECT (self), source_tag) == TRUE, FALSE);
+
+	return (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == FALSE);
+}
+
+/**
+ * gdata_tasks_service_insert_tasks:
+ * @self: a #GDataTasksService
+ * @tasks: (element-type GData.TasksTask): a list of #GDataTasksTask<!-- -->s to insert
+ * @tasklist: the #GDataTasksTasklist to insert the tasks into
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (scope call) (closure batch_user_data): a #GDataTasksServiceBatchCallback to call when each task has been
+ * inserted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @error: (allow-none): a #GError, or %NULL
+ *
+ * Inserts all the tasks in @tasks into @tasklist, as by gdata_tasks_service_insert_task(). The user must be authenticated to use this function.
+ *
+ * The insertions are sent to the Tasks API's batch endpoint, up to 50 to a request, and up to #GDataService:max-connections-per-host requests at
+ * once. If the batch endpoint isn't available, the tasks are instead inserted with individual requests, as many at once as there are connections
+ * for. Whenever the server indicates that its rate limits have been exceeded, no more requests are sent until an exponentially increasing delay
+ * has passed, and the affected tasks are retried.
+ *
+ * @batch_callback is called for every task, with its position in @tasks, with the inserted version of the task as @result or with the error
+ * which occurred while inserting it, in the order in which the server's responses arrive.
+ *
+ * %FALSE is returned with @error set if @cancellable was cancelled, or if a batch request failed as a whole (in which case every task in it is also
+ * reported to @batch_callback with the error). The other tasks may still have been inserted.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_tasks_service_insert_tasks (GDataTasksService *self, GList *tasks, GDataTasksTasklist *tasklist, GCancellable *cancellable,
+                                  GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_TASKS_SERVICE (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_TASKS_TASKLIST (tasklist), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = tasks; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_TASKS_TASK (i->data), FALSE);
+
+	return run_tasks_batch (self, GDATA_BATCH_OPERATION_INSERTION, tasks, tasklist, cancellable, batch_callback, batch_user_data, NULL, FALSE,
+	                        error);
+}
+
+/**
+ * gdata_tasks_service_insert_tasks_async:
+ * @self: a #GDataTasksService
+ * @tasks: (element-type GData.TasksTask): a list of #GDataTasksTask<!-- -->s to insert
+ * @tasklist: the #GDataTasksTasklist to insert the tasks into
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (closure batch_user_data): a #GDataTasksServiceBatchCallback to call when each task has been inserted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @destroy_batch_user_data: (allow-none): the function to call when @batch_callback will not be called any more, or %NULL. This function will
+ * be called with @batch_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Inserts all the tasks in @tasks into @tasklist asynchronously, calling @batch_callback for each in an idle function in the thread-default main
+ * context of the thread which called this function (see g_main_context_push_thread_default()). @self, @tasks and @tasklist are all reffed when this
+ * function is called, so can safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_tasks_service_insert_tasks(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_tasks_service_insert_tasks_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_tasks_service_insert_tasks_async (GDataTasksService *self, GList *tasks, GDataTasksTasklist *tasklist, GCancellable *cancellable,
+                                        GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                        GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_TASKS_SERVICE (self));
+	g_return_if_fail (GDATA_IS_TASKS_TASKLIST (tasklist));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = tasks; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_TASKS_TASK (i->data));
+
+	run_tasks_batch_async (self, GDATA_BATCH_OPERATION_INSERTION, tasks, tasklist, cancellable, batch_callback, batch_user_data,
+	                       destroy_batch_user_data, callback, user_data, gdata_tasks_service_insert_tasks_async);
+}
+
+/**
+ * gdata_tasks_service_insert_tasks_finish:
+ * @self: a #GDataTasksService
+ * @async_result: a #GAsyncResult
+ * @error: (allow-none): a #GError, or %NULL
+ *
+ * Finishes an asynchronous batched task insertion operation started with gdata_tasks_service_insert_tasks_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_tasks_service_insert_tasks_finish (GDataTasksService *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_TASKS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return run_tasks_batch_finish (self, async_result, gdata_tasks_service_insert_tasks_async, error);
+}
+
+/**
+ * gdata_tasks_service_update_tasks:
+ * @self: a #GDataTasksService
+ * @tasks: (element-type GData.TasksTask): a list of #GDataTasksTask<!-- -->s to update
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (scope call) (closure batch_user_data): a #GDataTasksServiceBatchCallback to call when each task has been
+ * updated, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @error: (allow-none): a #GError, or %NULL
+ *
+ * Updates all the tasks in @tasks, as by gdata_tasks_service_update_task(). The tasks must already exist on the server. The user must be
+ * authenticated to use this function.
+ *
+ * The updates are batched and rate limited as described for gdata_tasks_service_insert_tasks(). @batch_callback is called for every task, with
+ * its position in @tasks, with the updated version of the task as @result or with the error which occurred while updating it.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_tasks_service_update_tasks (GDataTasksService *self, GList *tasks, GCancellable *cancellable,
+                                  GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_TASKS_SERVICE (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = tasks; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_TASKS_TASK (i->data), FALSE);
+
+	return run_tasks_batch (self, GDATA_BATCH_OPERATION_UPDATE, tasks, NULL, cancellable, batch_callback, batch_user_data, NULL, FALSE,
+	                        error);
+}
+
+/**
+ * gdata_tasks_service_update_tasks_async:
+ * @self: a #GDataTasksService
+ * @tasks: (element-type GData.TasksTask): a list of #GDataTasksTask<!-- -->s to update
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (closure batch_user_data): a #GDataTasksServiceBatchCallback to call when each task has been updated, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @destroy_batch_user_data: (allow-none): the function to call when @batch_callback will not be called any more, or %NULL. This function will
+ * be called with @batch_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Updates all the tasks in @tasks asynchronously, calling @batch_callback for each in an idle function in the thread-default main context of the
+ * thread which called this function (see g_main_context_push_thread_default()). @self and @tasks are reffed when this function is called, so can
+ * safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_tasks_service_update_tasks(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_tasks_service_update_tasks_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_tasks_service_update_tasks_async (GDataTasksService *self, GList *tasks, GCancellable *cancellable,
+                                        GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                        GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_TASKS_SERVICE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = tasks; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_TASKS_TASK (i->data));
+
+	run_tasks_batch_async (self, GDATA_BATCH_OPERATION_UPDATE, tasks, NULL, cancellable, batch_callback, batch_user_data,
+	                       destroy_batch_user_data, callback, user_data, gdata_tasks_service_update_tasks_async);
+}
+
+/**
+ * gdata_tasks_service_update_tasks_finish:
+ * @self: a #GDataTasksService
+ * @async_result: a #GAsyncResult
+ * @error: (allow-none): a #GError, or %NULL
+ *
+ * Finishes an asynchronous batched task update operation started with gdata_tasks_service_update_tasks_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_tasks_service_update_tasks_finish (GDataTasksService *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_TASKS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return run_tasks_batch_finish (self, async_result, gdata_tasks_service_update_tasks_async, error);
+}
+
+/**
+ * gdata_tasks_service_delete_tasks:
+ * @self: a #GDataTasksService
+ * @tasks: (element-type GData.TasksTask): a list of #GDataTasksTask<!-- -->s to delete
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (scope call) (closure batch_user_data): a #GDataTasksServiceBatchCallback to call when each task has been
+ * deleted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @error: (allow-none): a #GError, or %NULL
+ *
+ * Deletes all the tasks in @tasks, as by gdata_tasks_service_delete_task(). The user must be authenticated to use this function.
+ *
+ * The deletions are batched and rate limited as described for gdata_tasks_service_insert_tasks(). @batch_callback is called for every task, with
+ * its position in @tasks and the error which occurred while deleting it, if any; @result is always %NULL.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_tasks_service_delete_tasks (GDataTasksService *self, GList *tasks, GCancellable *cancellable,
+                                  GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error)
+{
+	GList *i;
+
+	g_return_val_if_fail (GDATA_IS_TASKS_SERVICE (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	for (i = tasks; i != NULL; i = i->next)
+		g_return_val_if_fail (GDATA_IS_TASKS_TASK (i->data), FALSE);
+
+	return run_tasks_batch (self, GDATA_BATCH_OPERATION_DELETION, tasks, NULL, cancellable, batch_callback, batch_user_data, NULL, FALSE,
+	                        error);
+}
+
+/**
+ * gdata_tasks_service_delete_tasks_async:
+ * @self: a #GDataTasksService
+ * @tasks: (element-type GData.TasksTask): a list of #GDataTasksTask<!-- -->s to delete
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @batch_callback: (allow-none) (closure batch_user_data): a #GDataTasksServiceBatchCallback to call when each task has been deleted, or %NULL
+ * @batch_user_data: (closure): data to pass to the @batch_callback function
+ * @destroy_batch_user_data: (allow-none): the function to call when @batch_callback will not be called any more, or %NULL. This function will
+ * be called with @batch_user_data as a parameter and can be used to free any memory allocated for it.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Deletes all the tasks in @tasks asynchronously, calling @batch_callback for each in an idle function in the thread-default main context of the
+ * thread which called this function (see g_main_context_push_thread_default()). @self and @tasks are reffed when this function is called, so can
+ * safely be unreffed after this function returns.
+ *
+ * For more details, see gdata_tasks_service_delete_tasks(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_tasks_service_delete_tasks_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_tasks_service_delete_tasks_async (GDataTasksService *self, GList *tasks, GCancellable *cancellable,
+                                        GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                        GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GList *i;
+
+	g_return_if_fail (GDATA_IS_TASKS_SERVICE (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	for (i = tasks; i != NULL; i = i->next)
+		g_return_if_fail (GDATA_IS_TASKS_TASK (i->data));
+
+	run_tasks_batch_async (self, GDATA_BATCH_OPERATION_DELETION, tasks, NULL, cancellable, batch_callback, batch_user_data,
+	                       destroy_batch_user_data, callback, user_data, gdata_tasks_service_delete_tasks_async);
+}
+
+/**
+ * gdata_tasks_service_delete_tasks_finish:
+ * @self: a #GDataTasksService
+ * @async_result: a #GAsyncResult
+ * @error: (allow-none): a #GError, or %NULL
+ *
+ * Finishes an asynchronous batched task deletion operation started with gdata_tasks_service_delete_tasks_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_tasks_service_delete_tasks_finish (GDataTasksService *self, GAsyncResult *async_result, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_TASKS_SERVICE (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	return run_tasks_batch_finish (self, async_result, gdata_tasks_service_delete_tasks_async, error);
+}
@@ -105,6 +105,43 @@ GDataTasksTasklist *gdata_tasks_service_update_tasklist (GDataTasksService *self
 void gdata_tasks_service_update_tasklist_async (GDataTasksService *self, GDataTasksTasklist *tasklist,
                                                 GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
 
+/**
+ * GDataTasksServiceBatchCallback:
+ * @index: the position of @task in the list of tasks passed to the batch function
+ * @task: the #GDataTasksTask which was passed to the batch function
+ * @result: (allow-none): the task returned by the server, or %NULL on error or for deletions
+ * @error: (allow-none): the error which occurred while processing @task, or %NULL on success
+ * @user_data: user data passed to the batch function
+ *
+ * Callback for gdata_tasks_service_insert_tasks(), gdata_tasks_service_update_tasks() and gdata_tasks_service_delete_tasks(), called once for each
+ * task passed to them. @task, @result and @error are owned by the batch operation; they must be reffed or copied if they need to outlive the
+ * callback.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataTasksServiceBatchCallback) (guint index, GDataTasksTask *task, GDataTasksTask *result, GError *error, gpointer user_data);
+
+gboolean gdata_tasks_service_insert_tasks (GDataTasksService *self, GList *tasks, GDataTasksTasklist *tasklist, GCancellable *cancellable,
+                                           GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error);
+void gdata_tasks_service_insert_tasks_async (GDataTasksService *self, GList *tasks, GDataTasksTasklist *tasklist, GCancellable *cancellable,
+                                             GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                             GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_tasks_service_insert_tasks_finish (GDataTasksService *self, GAsyncResult *async_result, GError **error);
+
+gboolean gdata_tasks_service_update_tasks (GDataTasksService *self, GList *tasks, GCancellable *cancellable,
+                                           GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error);
+void gdata_tasks_service_update_tasks_async (GDataTasksService *self, GList *tasks, GCancellable *cancellable,
+                                             GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                             GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_tasks_service_update_tasks_finish (GDataTasksService *self, GAsyncResult *async_result, GError **error);
+
+gboolean gdata_tasks_service_delete_tasks (GDataTasksService *self, GList *tasks, GCancellable *cancellable,
+                                           GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data, GError **error);
+void gdata_tasks_service_delete_tasks_async (GDataTasksService *self, GList *tasks, GCancellable *cancellable,
+                                             GDataTasksServiceBatchCallback batch_callback, gpointer batch_user_data,
+                                             GDestroyNotify destroy_batch_user_data, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_tasks_service_delete_tasks_finish (GDataTasksService *self, GAsyncResult *async_result, GError **error);
+
 G_END_DECLS
 
 #endif /* !GDATA_TASKS_SERVICE_H */
@@ -0,0 +1,747 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-tasks-sync
+ * @short_description: GData Tasks incremental synchronisation
+ * @stability: Unstable
+ * @include: gdata/services/tasks/gdata-tasks-sync.h
+ *
+ * #GDataTasksSync keeps a local copy of the tasks in a set of tasklists up to date, by only downloading the tasks which have been added, changed
+ * or deleted in each tasklist since it was last synchronised, rather than re-downloading the whole of each tasklist.
+ *
+ * The local copy is accessed through the #GDataTasksSyncStore interface, which the application implements. #GDataTasksSync tracks a
+ * <firstterm>watermark</firstterm> for each tasklist: the latest modification time of the tasks seen in its last successful synchronisation. Each
+ * run of gdata_tasks_sync_run() on a tasklist queries for tasks updated since its watermark (using #GDataQuery:updated-min,
+ * #GDataTasksQuery:show-deleted and #GDataTasksQuery:show-hidden), walks all the pages of results, applies them to the store, and then updates the
+ * watermark. Tasklists which don't have a watermark yet are fully synchronised.
+ *
+ * Unlike the Atom feeds used by #GDataContactsSync and #GDataCalendarSync, the Tasks API doesn't give the server's time with its results, so the
+ * watermark is taken from the tasks' modification times instead. To allow for changes which the server hasn't finished propagating, each query
+ * starts #GDataTasksSync:clock-skew-margin seconds before the watermark; so some tasks may be applied to the store more than once.
+ *
+ * The watermarks can be saved with gdata_tasks_sync_save_state() and restored in a later process with gdata_tasks_sync_load_state(), so that
+ * synchronisation can be resumed where it left off. Several tasklists may be synchronised at once using gdata_tasks_sync_run_async().
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gi18n-lib.h>
+#include <string.h>
+
+#include "gdata-tasks-sync.h"
+#include "gdata-tasks-query.h"
+#include "gdata-parser.h"
+#include "gdata-private.h"
+
+/* First line of the serialised state; bump the version if the format changes */
+#define STATE_HEADER "GDataTasksSync 1"
+
+G_DEFINE_INTERFACE (GDataTasksSyncStore, gdata_tasks_sync_store, G_TYPE_OBJECT)
+
+static void
+gdata_tasks_sync_store_default_init (GDataTasksSyncStoreInterface *iface)
+{
+	/* Nothing to see here */
+}
+
+static void gdata_tasks_sync_dispose (GObject *object);
+static void gdata_tasks_sync_finalize (GObject *object);
+static void gdata_tasks_sync_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_tasks_sync_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataTasksSyncPrivate {
+	GDataTasksService *service;
+	GDataTasksSyncStore *store;
+	guint clock_skew_margin;
+	guint page_size;
+
+	GMutex mutex; /* protects tasklists */
+	GHashTable *tasklists; /* tasklist ID → gint64 watermark */
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_STORE,
+	PROP_CLOCK_SKEW_MARGIN,
+	PROP_PAGE_SIZE,
+};
+
+G_DEFINE_TYPE (GDataTasksSync, gdata_tasks_sync, G_TYPE_OBJECT)
+
+static void
+gdata_tasks_sync_class_init (GDataTasksSyncClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataTasksSyncPrivate));
+
+	gobject_class->get_property = gdata_tasks_sync_get_property;
+	gobject_class->set_property = gdata_tasks_sync_set_property;
+	gobject_class->dispose = gdata_tasks_sync_dispose;
+	gobject_class->finalize = gdata_tasks_sync_finalize;
+
+	/**
+	 * GDataTasksSync:service:
+	 *
+	 * The service to query for changed tasks.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service to query for changed tasks.",
+	                                                      GDATA_TYPE_TASKS_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataTasksSync:store:
+	 *
+	 * The local store to apply changed tasks to.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_STORE,
+	                                 g_param_spec_object ("store",
+	                                                      "Store", "The local store to apply changed tasks to.",
+	                                                      GDATA_TYPE_TASKS_SYNC_STORE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataTasksSync:clock-skew-margin:
+	 *
+	 * The number of seconds before each tasklist's watermark from which to query for changes, to allow for changes which hadn't propagated
+	 * through the server when the watermark was taken.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_CLOCK_SKEW_MARGIN,
+	                                 g_param_spec_uint ("clock-skew-margin",
+	                                                    "Clock skew margin", "The number of seconds before the watermark to query from.",
+	                                                    0, G_MAXUINT, 300,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataTasksSync:page-size:
+	 *
+	 * The maximum number of tasks to request in each page of results. The server won't return more than 100 tasks in a page.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_PAGE_SIZE,
+	                                 g_param_spec_uint ("page-size",
+	                                                    "Page size", "The maximum number of tasks to request in each page of results.",
+	                                                    1, G_MAXUINT, 100,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_tasks_sync_init (GDataTasksSync *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_TASKS_SYNC, GDataTasksSyncPrivate);
+	self->priv->clock_skew_margin = 300;
+	self->priv->page_size = 100;
+
+	g_mutex_init (&(self->priv->mutex));
+	self->priv->tasklists = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+}
+
+static void
+gdata_tasks_sync_dispose (GObject *object)
+{
+	GDataTasksSyncPrivate *priv = GDATA_TASKS_SYNC (object)->priv;
+
+	g_clear_object (&priv->service);
+	g_clear_object (&priv->store);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_tasks_sync_parent_class)->dispose (object);
+}
+
+static void
+gdata_tasks_sync_finalize (GObject *object)
+{
+	GDataTasksSyncPrivate *priv = GDATA_TASKS_SYNC (object)->priv;
+
+	g_hash_table_destroy (priv->tasklists);
+	g_mutex_clear (&(priv->mutex));
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_tasks_sync_parent_class)->finalize (object);
+}
+
+static void
+gdata_tasks_sync_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataTasksSyncPrivate *priv = GDATA_TASKS_SYNC (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_STORE:
+			g_value_set_object (value, priv->store);
+			break;
+		case PROP_CLOCK_SKEW_MARGIN:
+			g_value_set_uint (value, priv->clock_skew_margin);
+			break;
+		case PROP_PAGE_SIZE:
+			g_value_set_uint (value, priv->page_size);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_tasks_sync_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataTasksSync *self = GDATA_TASKS_SYNC (object);
+	GDataTasksSyncPrivate *priv = self->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_STORE:
+			priv->store = g_value_dup_object (value);
+			break;
+		case PROP_CLOCK_SKEW_MARGIN:
+			gdata_tasks_sync_set_clock_skew_margin (self, g_value_get_uint (value));
+			break;
+		case PROP_PAGE_SIZE:
+			gdata_tasks_sync_set_page_size (self, g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_tasks_sync_new:
+ * @service: the #GDataTasksService to query for changed tasks
+ * @store: the #GDataTasksSyncStore holding the local copy of the tasks
+ *
+ * Creates a new #GDataTasksSync, which will keep @store up to date with the tasks available through @service. No tasklists have watermarks
+ * initially; use gdata_tasks_sync_load_state() to restore them from a previous instance.
+ *
+ * Return value: (transfer full): a new #GDataTasksSync; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataTasksSync *
+gdata_tasks_sync_new (GDataTasksService *service, GDataTasksSyncStore *store)
+{
+	g_return_val_if_fail (GDATA_IS_TASKS_SERVICE (service), NULL);
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC_STORE (store), NULL);
+
+	return g_object_new (GDATA_TYPE_TASKS_SYNC, "service", service, "store", store, NULL);
+}
+
+/**
+ * gdata_tasks_sync_get_service:
+ * @self: a #GDataTasksSync
+ *
+ * Gets the #GDataTasksSync:service property.
+ *
+ * Return value: (transfer none): the service to query for changed tasks
+ *
+ * Since: 0.15.0
+ */
+GDataTasksService *
+gdata_tasks_sync_get_service (GDataTasksSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_tasks_sync_get_store:
+ * @self: a #GDataTasksSync
+ *
+ * Gets the #GDataTasksSync:store property.
+ *
+ * Return value: (transfer none): the local store to apply changed tasks to
+ *
+ * Since: 0.15.0
+ */
+GDataTasksSyncStore *
+gdata_tasks_sync_get_store (GDataTasksSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC (self), NULL);
+	return self->priv->store;
+}
+
+/**
+ * gdata_tasks_sync_get_clock_skew_margin:
+ * @self: a #GDataTasksSync
+ *
+ * Gets the #GDataTasksSync:clock-skew-margin property.
+ *
+ * Return value: the margin before the watermark from which changes are queried, in seconds
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_tasks_sync_get_clock_skew_margin (GDataTasksSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC (self), 0);
+	return self->priv->clock_skew_margin;
+}
+
+/**
+ * gdata_tasks_sync_set_clock_skew_margin:
+ * @self: a #GDataTasksSync
+ * @clock_skew_margin: the margin before the watermark from which to query changes, in seconds
+ *
+ * Sets the #GDataTasksSync:clock-skew-margin property.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_tasks_sync_set_clock_skew_margin (GDataTasksSync *self, guint clock_skew_margin)
+{
+	g_return_if_fail (GDATA_IS_TASKS_SYNC (self));
+
+	self->priv->clock_skew_margin = clock_skew_margin;
+	g_object_notify (G_OBJECT (self), "clock-skew-margin");
+}
+
+/**
+ * gdata_tasks_sync_get_page_size:
+ * @self: a #GDataTasksSync
+ *
+ * Gets the #GDataTasksSync:page-size property.
+ *
+ * Return value: the maximum number of tasks requested in each page of results
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_tasks_sync_get_page_size (GDataTasksSync *self)
+{
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC (self), 0);
+	return self->priv->page_size;
+}
+
+/**
+ * gdata_tasks_sync_set_page_size:
+ * @self: a #GDataTasksSync
+ * @page_size: the maximum number of tasks to request in each page of results; must be greater than <code class="literal">0</code>
+ *
+ * Sets the #GDataTasksSync:page-size property.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_tasks_sync_set_page_size (GDataTasksSync *self, guint page_size)
+{
+	g_return_if_fail (GDATA_IS_TASKS_SYNC (self));
+	g_return_if_fail (page_size > 0);
+
+	self->priv->page_size = page_size;
+	g_object_notify (G_OBJECT (self), "page-size");
+}
+
+/**
+ * gdata_tasks_sync_get_watermark:
+ * @self: a #GDataTasksSync
+ * @tasklist: a #GDataTasksTasklist
+ *
+ * Gets the watermark of @tasklist: the latest modification time of the tasks seen in its last successful synchronisation.
+ *
+ * Return value: the tasklist's watermark as a UNIX timestamp, or <code class="literal">-1</code> if it's never been synchronised
+ *
+ * Since: 0.15.0
+ */
+gint64
+gdata_tasks_sync_get_watermark (GDataTasksSync *self, GDataTasksTasklist *tasklist)
+{
+	gint64 *watermark_ptr;
+	gint64 watermark = -1;
+
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC (self), -1);
+	g_return_val_if_fail (GDATA_IS_TASKS_TASKLIST (tasklist), -1);
+
+	g_mutex_lock (&(self->priv->mutex));
+	watermark_ptr = g_hash_table_lookup (self->priv->tasklists, gdata_entry_get_id (GDATA_ENTRY (tasklist)));
+	if (watermark_ptr != NULL)
+		watermark = *watermark_ptr;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return watermark;
+}
+
+/**
+ * gdata_tasks_sync_reset:
+ * @self: a #GDataTasksSync
+ * @tasklist: (allow-none): a #GDataTasksTasklist, or %NULL
+ *
+ * Forgets the watermark of @tasklist, so that it will be fully synchronised the next time it's run. If @tasklist is %NULL, the watermarks of all
+ * tasklists are forgotten.
+ *
+ * Note that the server only keeps records of deleted tasks for a limited time, so tasklists which haven't been synchronised for longer than that
+ * should be reset.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_tasks_sync_reset (GDataTasksSync *self, GDataTasksTasklist *tasklist)
+{
+	g_return_if_fail (GDATA_IS_TASKS_SYNC (self));
+	g_return_if_fail (tasklist == NULL || GDATA_IS_TASKS_TASKLIST (tasklist));
+
+	g_mutex_lock (&(self->priv->mutex));
+
+	if (tasklist != NULL)
+		g_hash_table_remove (self->priv->tasklists, gdata_entry_get_id (GDATA_ENTRY (tasklist)));
+	else
+		g_hash_table_remove_all (self->priv->tasklists);
+
+	g_mutex_unlock (&(self->priv->mutex));
+}
+
+/**
+ * gdata_tasks_sync_save_state:
+ * @self: a #GDataTasksSync
+ *
+ * Serialises the watermarks of all the tasklists which have been synchronised, so that they can be restored later with
+ * gdata_tasks_sync_load_state(). The format of the returned string is private, but it is plain text.
+ *
+ * Return value: (transfer full): the serialised state; free with g_free()
+ *
+ * Since: 0.15.0
+ */
+gchar *
+gdata_tasks_sync_save_state (GDataTasksSync *self)
+{
+	GString *output;
+	GHashTableIter iter;
+	const gchar *tasklist_id;
+	gint64 *watermark;
+
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC (self), NULL);
+
+	output = g_string_new (STATE_HEADER "\n");
+
+	/* One line per tasklist, with the ID last so that it can contain spaces */
+	g_mutex_lock (&(self->priv->mutex));
+
+	g_hash_table_iter_init (&iter, self->priv->tasklists);
+	while (g_hash_table_iter_next (&iter, (gpointer*) &tasklist_id, (gpointer*) &watermark) == TRUE)
+		g_string_append_printf (output, "%" G_GINT64_FORMAT " %s\n", *watermark, tasklist_id);
+
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return g_string_free (output, FALSE);
+}
+
+/**
+ * gdata_tasks_sync_load_state:
+ * @self: a #GDataTasksSync
+ * @state: state previously returned by gdata_tasks_sync_save_state()
+ * @error: a #GError, or %NULL
+ *
+ * Restores the watermarks previously saved with gdata_tasks_sync_save_state(), replacing any which @self currently holds. If @state is invalid,
+ * %GDATA_PARSER_ERROR_PARSING_STRING is returned and the current watermarks are left unchanged.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_tasks_sync_load_state (GDataTasksSync *self, const gchar *state, GError **error)
+{
+	GHashTable *tasklists;
+	gchar **lines;
+	guint i;
+
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC (self), FALSE);
+	g_return_val_if_fail (state != NULL, FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	lines = g_strsplit (state, "\n", -1);
+
+	if (lines[0] == NULL || strcmp (lines[0], STATE_HEADER) != 0)
+		goto error;
+
+	tasklists = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+	for (i = 1; lines[i] != NULL; i++) {
+		gint64 watermark;
+		gchar *end;
+
+		/* Skip the empty line after the trailing newline */
+		if (*lines[i] == '\0')
+			continue;
+
+		watermark = g_ascii_strtoll (lines[i], &end, 10);
+		if (end == lines[i] || *end != ' ' || watermark < 0 || *(end + 1) == '\0') {
+			g_hash_table_destroy (tasklists);
+			goto error;
+		}
+
+		g_hash_table_replace (tasklists, g_strdup (end + 1), g_memdup (&watermark, sizeof (watermark)));
+	}
+
+	g_strfreev (lines);
+
+	g_mutex_lock (&(self->priv->mutex));
+	g_hash_table_destroy (self->priv->tasklists);
+	self->priv->tasklists = tasklists;
+	g_mutex_unlock (&(self->priv->mutex));
+
+	return TRUE;
+
+error:
+	g_strfreev (lines);
+	g_set_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING, _("The tasks synchronization state was invalid."));
+
+	return FALSE;
+}
+
+typedef struct {
+	GDataTasksSync *self;
+	GDataTasksTasklist *tasklist;
+	guint n_changed;
+	guint n_removed;
+} RunData;
+
+static GDataFeed *
+query_page (GDataQuery *query, RunData *data, GCancellable *cancellable, GError **error)
+{
+	return gdata_tasks_service_query_tasks (data->self->priv->service, data->tasklist, query, cancellable, NULL, NULL, error);
+}
+
+/* Applies a changed task to the store, returning FALSE if the store fails */
+static gboolean
+apply_entry (GDataEntry *entry, RunData *data, GError **error)
+{
+	GDataTasksSyncStore *store = data->self->priv->store;
+	GDataTasksSyncStoreInterface *iface = GDATA_TASKS_SYNC_STORE_GET_IFACE (store);
+	GDataTasksTask *task = GDATA_TASKS_TASK (entry);
+
+	if (gdata_tasks_task_is_deleted (task) == TRUE) {
+		if (iface->remove_task (store, data->tasklist, gdata_entry_get_id (entry), error) == FALSE)
+			return FALSE;
+		data->n_removed++;
+	} else {
+		if (iface->apply_task (store, data->tasklist, task, error) == FALSE)
+			return FALSE;
+		data->n_changed++;
+	}
+
+	return TRUE;
+}
+
+/**
+ * gdata_tasks_sync_run:
+ * @self: a #GDataTasksSync
+ * @tasklist: the #GDataTasksTasklist to synchronise
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @n_changed: (out caller-allocates) (allow-none): return location for the number of tasks added or changed, or %NULL
+ * @n_removed: (out caller-allocates) (allow-none): return location for the number of tasks removed, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Synchronises the tasks of @tasklist in the #GDataTasksSync:store with the server, applying all the tasks which have been added, changed or
+ * deleted since the tasklist's watermark, and then updating the watermark. All the pages of results are queried. Completed and hidden tasks are
+ * applied to the store along with the others. If the tasklist has no watermark, the store's <function>reset_tasklist</function> function is called
+ * and then all the tasks in the tasklist are applied to the store.
+ *
+ * The store's functions are called in the same thread as this function. If the query fails, or any of the store's functions fails, synchronisation
+ * stops and the tasklist's watermark is left unchanged. Errors are as for gdata_service_query().
+ *
+ * Only one synchronisation should be run on a given tasklist at once, but different tasklists may be synchronised concurrently.
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_tasks_sync_run (GDataTasksSync *self, GDataTasksTasklist *tasklist, GCancellable *cancellable,
+                      guint *n_changed, guint *n_removed, GError **error)
+{
+	GDataTasksSyncPrivate *priv;
+	GDataTasksSyncStoreInterface *iface;
+	GDataTasksQuery *query;
+	RunData data;
+	const gchar *tasklist_id;
+	gint64 watermark, new_watermark = -1;
+	gboolean success = TRUE;
+
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC (self), FALSE);
+	g_return_val_if_fail (GDATA_IS_TASKS_TASKLIST (tasklist), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	priv = self->priv;
+	iface = GDATA_TASKS_SYNC_STORE_GET_IFACE (priv->store);
+	g_assert (iface->reset_tasklist != NULL && iface->apply_task != NULL && iface->remove_task != NULL);
+
+	tasklist_id = gdata_entry_get_id (GDATA_ENTRY (tasklist));
+	watermark = gdata_tasks_sync_get_watermark (self, tasklist);
+
+	query = gdata_tasks_query_new (NULL);
+	gdata_query_set_max_results (GDATA_QUERY (query), priv->page_size);
+	gdata_tasks_query_set_show_completed (query, TRUE);
+	gdata_tasks_query_set_show_hidden (query, TRUE);
+
+	/* Include deletions in incremental synchronisations */
+	if (watermark >= 0)
+		gdata_tasks_query_set_show_deleted (query, TRUE);
+	else
+		success = iface->reset_tasklist (priv->store, tasklist, error);
+
+	data.self = self;
+	data.tasklist = tasklist;
+	data.n_changed = 0;
+	data.n_removed = 0;
+
+	if (success == TRUE) {
+		success = _gdata_sync_run (GDATA_QUERY (query), watermark, priv->clock_skew_margin, (GDataSyncQueryFunc) query_page,
+		                           (GDataSyncEntryFunc) apply_entry, &data, cancellable, &new_watermark, error);
+	}
+
+	g_object_unref (query);
+
+	/* Only move the watermark on once all the changes have been applied. An empty tasklist has no tasks to take a watermark from, so it's
+	 * marked as synchronised from the start of time. */
+	if (success == TRUE) {
+		new_watermark = MAX (new_watermark, 0);
+
+		g_mutex_lock (&(priv->mutex));
+		g_hash_table_replace (priv->tasklists, g_strdup (tasklist_id), g_memdup (&new_watermark, sizeof (new_watermark)));
+		g_mutex_unlock (&(priv->mutex));
+	}
+
+	if (n_changed != NULL)
+		*n_changed = data.n_changed;
+	if (n_removed != NULL)
+		*n_removed = data.n_removed;
+
+	return success;
+}
+
+typedef struct {
+	GDataTasksTasklist *tasklist;
+	guint n_changed;
+	guint n_removed;
+} RunAsyncData;
+
+static void
+run_async_data_free (RunAsyncData *data)
+{
+	g_object_unref (data->tasklist);
+	g_slice_free (RunAsyncData, data);
+}
+
+static void
+run_thread (GSimpleAsyncResult *result, GDataTasksSync *self, GCancellable *cancellable)
+{
+	RunAsyncData *data = g_simple_async_result_get_op_res_gpointer (result);
+	GError *error = NULL;
+
+	if (gdata_tasks_sync_run (self, data->tasklist, cancellable, &(data->n_changed), &(data->n_removed), &error) == FALSE)
+		g_simple_async_result_take_error (result, error);
+}
+
+/**
+ * gdata_tasks_sync_run_async:
+ * @self: a #GDataTasksSync
+ * @tasklist: the #GDataTasksTasklist to synchronise
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when synchronisation is finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Synchronises the tasks of @tasklist with the server asynchronously. @self and @tasklist are reffed when this function is called, so can safely
+ * be unreffed after this function returns.
+ *
+ * For more details, see gdata_tasks_sync_run(), which is the synchronous version of this function. Note that the store's functions will be
+ * called in a worker thread, rather than the main thread.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_tasks_sync_run_finish() to get the results of the operation.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_tasks_sync_run_async (GDataTasksSync *self, GDataTasksTasklist *tasklist, GCancellable *cancellable,
+                            GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+	RunAsyncData *data;
+
+	g_return_if_fail (GDATA_IS_TASKS_SYNC (self));
+	g_return_if_fail (GDATA_IS_TASKS_TASKLIST (tasklist));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	data = g_slice_new0 (RunAsyncData);
+	data->tasklist = g_object_ref (tasklist);
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_tasks_sync_run_async);
+	g_simple_async_result_set_op_res_gpointer (result, data, (GDestroyNotify) run_async_data_free);
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) run_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_tasks_sync_run_finish:
+ * @self: a #GDataTasksSync
+ * @async_result: a #GAsyncResult
+ * @n_changed: (out caller-allocates) (allow-none): return location for the number of tasks added or changed, or %NULL
+ * @n_removed: (out caller-allocates) (allow-none): return location for the number of tasks removed, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous synchronisation operation started with gdata_tasks_sync_run_async().
+ *
+ * Return value: %TRUE on success, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_tasks_sync_run_finish (GDataTasksSync *self, GAsyncResult *async_result, guint *n_changed, guint *n_removed, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+	RunAsyncData *data;
+
+	g_return_val_if_fail (GDATA_IS_TASKS_SYNC (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_tasks_sync_run_async);
+
+	/* Changes applied before a failure are still reported */
+	data = g_simple_async_result_get_op_res_gpointer (result);
+
+	if (n_changed != NULL)
+		*n_changed = data->n_changed;
+	if (n_removed != NULL)
+		*n_removed = data->n_removed;
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	return TRUE;
+}
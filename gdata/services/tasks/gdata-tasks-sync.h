@@ -0,0 +1,132 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_TASKS_SYNC_H
+#define GDATA_TASKS_SYNC_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/services/tasks/gdata-tasks-service.h>
+#include <gdata/services/tasks/gdata-tasks-tasklist.h>
+#include <gdata/services/tasks/gdata-tasks-task.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_TASKS_SYNC_STORE		(gdata_tasks_sync_store_get_type ())
+#define GDATA_TASKS_SYNC_STORE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_TASKS_SYNC_STORE, GDataTasksSyncStore))
+#define GDATA_TASKS_SYNC_STORE_CLASS(k)	(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_TASKS_SYNC_STORE, GDataTasksSyncStoreInterface))
+#define GDATA_IS_TASKS_SYNC_STORE(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_TASKS_SYNC_STORE))
+#define GDATA_TASKS_SYNC_STORE_GET_IFACE(o)	(G_TYPE_INSTANCE_GET_INTERFACE ((o), GDATA_TYPE_TASKS_SYNC_STORE, GDataTasksSyncStoreInterface))
+
+/**
+ * GDataTasksSyncStore:
+ *
+ * All the fields in the #GDataTasksSyncStore structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct _GDataTasksSyncStore		GDataTasksSyncStore; /* dummy typedef */
+
+/**
+ * GDataTasksSyncStoreInterface:
+ * @parent: the parent type
+ * @reset_tasklist: a function to remove all the tasks for the given tasklist from the store, called before the tasklist is fully (rather than
+ * incrementally) synchronised; this must be implemented
+ * @apply_task: a function to add the given task to the store, or to replace the existing version of it (matched by gdata_entry_get_id()) if the
+ * store already contains it; this must be implemented, and must cope with being passed a version of a task which it already contains
+ * @remove_task: a function to remove the task with the given ID from the store; this must be implemented, and must cope with being passed the ID
+ * of a task which the store doesn't contain
+ *
+ * The interface structure for the #GDataTasksSyncStore interface. The functions are called in the thread which runs the synchronisation; if
+ * several tasklists are synchronised at once, they may be called from several threads at once.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GTypeInterface parent;
+
+	gboolean (*reset_tasklist) (GDataTasksSyncStore *self, GDataTasksTasklist *tasklist, GError **error);
+	gboolean (*apply_task) (GDataTasksSyncStore *self, GDataTasksTasklist *tasklist, GDataTasksTask *task, GError **error);
+	gboolean (*remove_task) (GDataTasksSyncStore *self, GDataTasksTasklist *tasklist, const gchar *task_id, GError **error);
+} GDataTasksSyncStoreInterface;
+
+GType gdata_tasks_sync_store_get_type (void) G_GNUC_CONST;
+
+#define GDATA_TYPE_TASKS_SYNC		(gdata_tasks_sync_get_type ())
+#define GDATA_TASKS_SYNC(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_TASKS_SYNC, GDataTasksSync))
+#define GDATA_TASKS_SYNC_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_TASKS_SYNC, GDataTasksSyncClass))
+#define GDATA_IS_TASKS_SYNC(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_TASKS_SYNC))
+#define GDATA_IS_TASKS_SYNC_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_TASKS_SYNC))
+#define GDATA_TASKS_SYNC_GET_CLASS(o)	(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_TASKS_SYNC, GDataTasksSyncClass))
+
+typedef struct _GDataTasksSyncPrivate	GDataTasksSyncPrivate;
+
+/**
+ * GDataTasksSync:
+ *
+ * All the fields in the #GDataTasksSync structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	GObject parent;
+	GDataTasksSyncPrivate *priv;
+} GDataTasksSync;
+
+/**
+ * GDataTasksSyncClass:
+ *
+ * All the fields in the #GDataTasksSyncClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ **/
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataTasksSyncClass;
+
+GType gdata_tasks_sync_get_type (void) G_GNUC_CONST;
+
+GDataTasksSync *gdata_tasks_sync_new (GDataTasksService *service, GDataTasksSyncStore *store) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataTasksService *gdata_tasks_sync_get_service (GDataTasksSync *self) G_GNUC_PURE;
+GDataTasksSyncStore *gdata_tasks_sync_get_store (GDataTasksSync *self) G_GNUC_PURE;
+
+guint gdata_tasks_sync_get_clock_skew_margin (GDataTasksSync *self) G_GNUC_PURE;
+void gdata_tasks_sync_set_clock_skew_margin (GDataTasksSync *self, guint clock_skew_margin);
+guint gdata_tasks_sync_get_page_size (GDataTasksSync *self) G_GNUC_PURE;
+void gdata_tasks_sync_set_page_size (GDataTasksSync *self, guint page_size);
+
+gint64 gdata_tasks_sync_get_watermark (GDataTasksSync *self, GDataTasksTasklist *tasklist);
+void gdata_tasks_sync_reset (GDataTasksSync *self, GDataTasksTasklist *tasklist);
+
+gchar *gdata_tasks_sync_save_state (GDataTasksSync *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+gboolean gdata_tasks_sync_load_state (GDataTasksSync *self, const gchar *state, GError **error);
+
+gboolean gdata_tasks_sync_run (GDataTasksSync *self, GDataTasksTasklist *tasklist, GCancellable *cancellable,
+                               guint *n_changed, guint *n_removed, GError **error);
+void gdata_tasks_sync_run_async (GDataTasksSync *self, GDataTasksTasklist *tasklist, GCancellable *cancellable,
+                                 GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_tasks_sync_run_finish (GDataTasksSync *self, GAsyncResult *async_result, guint *n_changed, guint *n_removed, GError **error);
+
+G_END_DECLS
+
+#endif /* !GDATA_TASKS_SYNC_H */
@@ -47,6 +47,9 @@ static void gdata_tasks_task_finalize (GObject *object);
 static void gdata_tasks_task_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
 static void gdata_tasks_task_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
 static void get_json (GDataParsable *parsable, JsonBuilder *builder);
+static void write_json (GDataParsable *parsable, GString *json);
+static void clone_private (GDataParsable *self, GDataParsable *clone);
+static void refresh_private (GDataEntry *self, GDataEntry *other);
 static gboolean parse_json (GDataParsable *parsable, JsonReader *reader, gpointer user_data, GError **error);
 static const gchar *get_content_type (void);
 
@@ -89,6 +92,10 @@ gdata_tasks_task_class_init (GDataTasksTaskClass *klass)
 	parsable_class->parse_json = parse_json;
 	parsable_class->get_json = get_json;
 	parsable_class->get_content_type = get_content_type;
+	_gdata_parsable_class_set_json_write_func (parsable_class, write_json);
+
+	_gdata_parsable_class_set_clone_func (parsable_class, clone_private);
+	_gdata_entry_class_set_refresh_func (GDATA_ENTRY_CLASS (klass), refresh_private);
 
 	/**
 	 * GDataTasksTask:parent:
@@ -200,6 +207,19 @@ gdata_tasks_task_class_init (GDataTasksTaskClass *klass)
 	                                 "Hidden?", "Indicated whatever task is hidden.",
 	                                 FALSE,
 	                                 G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+	/* Map the properties to the JSON members they're serialised as; see gdata_service_patch_entry() */
+	_gdata_entry_class_set_property_field (GDATA_ENTRY_CLASS (klass), "parent", "parent");
+	_gdata_entry_class_set_property_field (GDATA_ENTRY_CLASS (klass), "position", "position");
+	_gdata_entry_class_set_property_field (GDATA_ENTRY_CLASS (klass), "notes", "notes");
+	_gdata_entry_class_set_property_field (GDATA_ENTRY_CLASS (klass), "status", "status");
+	_gdata_entry_class_set_property_field (GDATA_ENTRY_CLASS (klass), "due", "due");
+	_gdata_entry_class_set_property_field (GDATA_ENTRY_CLASS (klass), "completed", "completed");
+	_gdata_entry_class_set_property_field (GDATA_ENTRY_CLASS (klass), "is-deleted", "deleted");
+	_gdata_entry_class_set_property_field (GDATA_ENTRY_CLASS (klass), "is-hidden", NULL);
+
+	/* All of a task's state is exposed as properties */
+	_gdata_entry_class_set_diff_func (GDATA_ENTRY_CLASS (klass), NULL);
 }
 
 static void
@@ -210,6 +230,38 @@ gdata_tasks_task_init (GDataTasksTask *self)
 	self->priv->completed = -1;
 }
 
+static void
+clone_private (GDataParsable *self, GDataParsable *clone)
+{
+	GDataTasksTaskPrivate *priv = GDATA_TASKS_TASK (self)->priv, *clone_priv = GDATA_TASKS_TASK (clone)->priv;
+
+	clone_priv->parent = g_strdup (priv->parent);
+	clone_priv->position = g_strdup (priv->position);
+	clone_priv->notes = g_strdup (priv->notes);
+	clone_priv->status = g_strdup (priv->status);
+	clone_priv->due = priv->due;
+	clone_priv->completed = priv->completed;
+	clone_priv->deleted = priv->deleted;
+	clone_priv->hidden = priv->hidden;
+}
+
+static void
+refresh_private (GDataEntry *self, GDataEntry *other)
+{
+	GDataTasksTaskPrivate *priv = GDATA_TASKS_TASK (self)->priv, *other_priv = GDATA_TASKS_TASK (other)->priv;
+	gchar *temp;
+
+	temp = priv->parent;
+	priv->parent = other_priv->parent;
+	other_priv->parent = temp;
+
+	temp = priv->position;
+	priv->position = other_priv->position;
+	other_priv->position = temp;
+
+	priv->hidden = other_priv->hidden;
+}
+
 static void
 gdata_tasks_task_finalize (GObject *object)
 {
@@ -366,6 +418,34 @@ get_json (GDataParsable *parsable, JsonBuilder *builder)
 	}
 }
 
+/* Equivalent to get_json(), but writing the members straight into @json */
+static void
+write_json (GDataParsable *parsable, GString *json)
+{
+	GDataTasksTaskPrivate *priv = GDATA_TASKS_TASK (parsable)->priv;
+
+	if (priv->parent != NULL)
+		_gdata_parsable_json_append_member_string (json, "parent", priv->parent);
+	if (priv->position != NULL)
+		_gdata_parsable_json_append_member_string (json, "position", priv->position);
+	if (priv->notes != NULL)
+		_gdata_parsable_json_append_member_string (json, "notes", priv->notes);
+	if (priv->status != NULL)
+		_gdata_parsable_json_append_member_string (json, "status", priv->status);
+	if (priv->due != -1) {
+		gchar *due = gdata_parser_int64_to_json_iso8601 (priv->due);
+		_gdata_parsable_json_append_member_string (json, "due", due);
+		g_free (due);
+	}
+	if (priv->completed != -1) {
+		gchar *completed = gdata_parser_int64_to_json_iso8601 (priv->completed);
+		_gdata_parsable_json_append_member_string (json, "completed", completed);
+		g_free (completed);
+	}
+
+	_gdata_parsable_json_append_member_boolean (json, "deleted", priv->deleted);
+}
+
 static const gchar *
 get_content_type (void)
 {
@@ -49,6 +49,10 @@ gdata_tasks_tasklist_class_init (GDataTasksTasklistClass *klass)
 {
 	GDataParsableClass *parsable_class = GDATA_PARSABLE_CLASS (klass);
 	parsable_class->get_content_type = get_content_type;
+
+	/* Tasklists have no state of their own */
+	_gdata_parsable_class_set_clone_func (parsable_class, NULL);
+	_gdata_entry_class_set_diff_func (GDATA_ENTRY_CLASS (klass), NULL);
 }
 
 static void
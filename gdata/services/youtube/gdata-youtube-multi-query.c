@@ -0,0 +1,634 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-youtube-multi-query
+ * @short_description: GData YouTube multiple query object
+ * @stability: Unstable
+ * @include: gdata/services/youtube/gdata-youtube-multi-query.h
+ *
+ * #GDataYouTubeMultiQuery is a transient standalone class which runs several different YouTube queries at once: any mixture of standard feed
+ * queries (as by gdata_youtube_service_query_standard_feed()), related video queries (as by gdata_youtube_service_query_related()) and video searches
+ * (as by gdata_youtube_service_query_videos()). This means that a view which displays the results of several queries only has to wait for the
+ * slowest of them, rather than all of them in turn.
+ *
+ * Queries are added with the <function>gdata_youtube_multi_query_add_*()</function> functions, each of which takes a callback which is called with
+ * the query's results as soon as it finishes. The queries are then all run with gdata_youtube_multi_query_run() or
+ * gdata_youtube_multi_query_run_async(). By default, as many queries are run at once as the service will make connections to a single host (see
+ * #GDataService:max-connections-per-host), since all the queries go to the same host; this can be changed with
+ * #GDataYouTubeMultiQuery:max-concurrent-queries.
+ *
+ * <example>
+ *	<title>Loading a Dashboard</title>
+ *	<programlisting>
+ *	GDataYouTubeMultiQuery *multi_query;
+ *
+ *	multi_query = gdata_youtube_multi_query_new (service);
+ *
+ *	gdata_youtube_multi_query_add_standard_feed (multi_query, GDATA_YOUTUBE_MOST_POPULAR_FEED, NULL, (GDataYouTubeMultiQueryCallback) feed_cb,
+ *	                                             most_popular_view);
+ *	gdata_youtube_multi_query_add_standard_feed (multi_query, GDATA_YOUTUBE_TOP_RATED_FEED, NULL, (GDataYouTubeMultiQueryCallback) feed_cb,
+ *	                                             top_rated_view);
+ *	gdata_youtube_multi_query_add_related (multi_query, current_video, NULL, (GDataYouTubeMultiQueryCallback) feed_cb, related_view);
+ *	gdata_youtube_multi_query_add_videos (multi_query, search_query, (GDataYouTubeMultiQueryCallback) feed_cb, search_view);
+ *
+ *	gdata_youtube_multi_query_run_async (multi_query, NULL, (GAsyncReadyCallback) dashboard_loaded_cb, NULL);
+ *	g_object_unref (multi_query);
+ *
+ *	static void
+ *	feed_cb (guint query_id, GDataFeed *feed, GError *error, MyVideoView *view)
+ *	{
+ *		if (error != NULL) {
+ *			my_video_view_show_error (view, error);
+ *			return;
+ *		}
+ *
+ *		my_video_view_set_feed (view, feed);
+ *	}
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-youtube-multi-query.h"
+#include "gdata-private.h"
+
+typedef enum {
+	QUERY_STANDARD_FEED,
+	QUERY_RELATED,
+	QUERY_VIDEOS,
+} QueryType;
+
+typedef struct {
+	guint id;
+	QueryType type;
+	GDataYouTubeStandardFeedType feed_type; /* only for QUERY_STANDARD_FEED */
+	GDataYouTubeVideo *video; /* only for QUERY_RELATED */
+	GDataQuery *query;
+	GDataYouTubeMultiQueryCallback callback;
+	gpointer user_data;
+
+	/* Only valid while the queries are running */
+	GDataYouTubeMultiQuery *multi_query;
+	GCancellable *cancellable;
+	GAsyncQueue *results;
+	GDataFeed *feed;
+	GError *error;
+} QueuedQuery;
+
+static void queued_query_free (QueuedQuery *query);
+
+static void gdata_youtube_multi_query_dispose (GObject *object);
+static void gdata_youtube_multi_query_finalize (GObject *object);
+static void gdata_youtube_multi_query_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_youtube_multi_query_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataYouTubeMultiQueryPrivate {
+	GDataYouTubeService *service;
+	guint max_concurrent_queries; /* 0 to use the service's max-connections-per-host */
+	GPtrArray *queries; /* QueuedQuerys, in the order they were added */
+	guint next_id; /* next available query ID */
+	gboolean has_run; /* TRUE if the queries have been run already (though they don't necessarily have to have finished running) */
+	gboolean is_async; /* TRUE if the queries were run with *_run_async(); FALSE if run with *_run() */
+	GMainContext *context; /* thread-default main context of the thread which called *_run_async(), to dispatch the callbacks in */
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_MAX_CONCURRENT_QUERIES,
+};
+
+G_DEFINE_TYPE (GDataYouTubeMultiQuery, gdata_youtube_multi_query, G_TYPE_OBJECT)
+
+static void
+gdata_youtube_multi_query_class_init (GDataYouTubeMultiQueryClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataYouTubeMultiQueryPrivate));
+
+	gobject_class->dispose = gdata_youtube_multi_query_dispose;
+	gobject_class->finalize = gdata_youtube_multi_query_finalize;
+	gobject_class->get_property = gdata_youtube_multi_query_get_property;
+	gobject_class->set_property = gdata_youtube_multi_query_set_property;
+
+	/**
+	 * GDataYouTubeMultiQuery:service:
+	 *
+	 * The service the queries are being made against.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service the queries are being made against.",
+	                                                      GDATA_TYPE_YOUTUBE_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataYouTubeMultiQuery:max-concurrent-queries:
+	 *
+	 * The maximum number of queries to run at once. If this is <code class="literal">0</code>, the service's
+	 * #GDataService:max-connections-per-host is used, as all the queries are made to the same host and any more than that would just be
+	 * queued by the service.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MAX_CONCURRENT_QUERIES,
+	                                 g_param_spec_uint ("max-concurrent-queries",
+	                                                    "Maximum concurrent queries", "The maximum number of queries to run at once.",
+	                                                    0, G_MAXUINT, 0,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gdata_youtube_multi_query_init (GDataYouTubeMultiQuery *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_YOUTUBE_MULTI_QUERY, GDataYouTubeMultiQueryPrivate);
+	self->priv->next_id = 1; /* reserve ID 0 for error conditions */
+	self->priv->queries = g_ptr_array_new_with_free_func ((GDestroyNotify) queued_query_free);
+}
+
+static void
+gdata_youtube_multi_query_dispose (GObject *object)
+{
+	GDataYouTubeMultiQueryPrivate *priv = GDATA_YOUTUBE_MULTI_QUERY (object)->priv;
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_youtube_multi_query_parent_class)->dispose (object);
+}
+
+static void
+gdata_youtube_multi_query_finalize (GObject *object)
+{
+	GDataYouTubeMultiQueryPrivate *priv = GDATA_YOUTUBE_MULTI_QUERY (object)->priv;
+
+	g_ptr_array_unref (priv->queries);
+
+	if (priv->context != NULL)
+		g_main_context_unref (priv->context);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_youtube_multi_query_parent_class)->finalize (object);
+}
+
+static void
+gdata_youtube_multi_query_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataYouTubeMultiQueryPrivate *priv = GDATA_YOUTUBE_MULTI_QUERY (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_MAX_CONCURRENT_QUERIES:
+			g_value_set_uint (value, priv->max_concurrent_queries);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_youtube_multi_query_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataYouTubeMultiQueryPrivate *priv = GDATA_YOUTUBE_MULTI_QUERY (object)->priv;
+
+	switch (property_id) {
+		/* Construct only */
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_MAX_CONCURRENT_QUERIES:
+			gdata_youtube_multi_query_set_max_concurrent_queries (GDATA_YOUTUBE_MULTI_QUERY (object), g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_youtube_multi_query_new:
+ * @service: the #GDataYouTubeService to query
+ *
+ * Creates a new, empty #GDataYouTubeMultiQuery for running several queries against @service at once.
+ *
+ * Return value: (transfer full): a new #GDataYouTubeMultiQuery; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataYouTubeMultiQuery *
+gdata_youtube_multi_query_new (GDataYouTubeService *service)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (service), NULL);
+	return g_object_new (GDATA_TYPE_YOUTUBE_MULTI_QUERY, "service", service, NULL);
+}
+
+/**
+ * gdata_youtube_multi_query_get_service:
+ * @self: a #GDataYouTubeMultiQuery
+ *
+ * Gets the #GDataYouTubeMultiQuery:service property.
+ *
+ * Return value: (transfer none): the service the queries are being made against
+ *
+ * Since: 0.15.0
+ */
+GDataYouTubeService *
+gdata_youtube_multi_query_get_service (GDataYouTubeMultiQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_MULTI_QUERY (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_youtube_multi_query_get_max_concurrent_queries:
+ * @self: a #GDataYouTubeMultiQuery
+ *
+ * Gets the #GDataYouTubeMultiQuery:max-concurrent-queries property.
+ *
+ * Return value: the maximum number of queries to run at once, or <code class="literal">0</code> to use the service's connection limit
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_youtube_multi_query_get_max_concurrent_queries (GDataYouTubeMultiQuery *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_MULTI_QUERY (self), 0);
+	return self->priv->max_concurrent_queries;
+}
+
+/**
+ * gdata_youtube_multi_query_set_max_concurrent_queries:
+ * @self: a #GDataYouTubeMultiQuery
+ * @max_concurrent_queries: the maximum number of queries to run at once, or <code class="literal">0</code> to use the service's connection limit
+ *
+ * Sets the #GDataYouTubeMultiQuery:max-concurrent-queries property. This must be called before the queries are run.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_youtube_multi_query_set_max_concurrent_queries (GDataYouTubeMultiQuery *self, guint max_concurrent_queries)
+{
+	g_return_if_fail (GDATA_IS_YOUTUBE_MULTI_QUERY (self));
+	g_return_if_fail (self->priv->has_run == FALSE);
+
+	self->priv->max_concurrent_queries = max_concurrent_queries;
+	g_object_notify (G_OBJECT (self), "max-concurrent-queries");
+}
+
+static void
+queued_query_free (QueuedQuery *query)
+{
+	if (query->video != NULL)
+		g_object_unref (query->video);
+	if (query->query != NULL)
+		g_object_unref (query->query);
+	if (query->feed != NULL)
+		g_object_unref (query->feed);
+	if (query->error != NULL)
+		g_error_free (query->error);
+
+	g_slice_free (QueuedQuery, query);
+}
+
+static guint
+add_query (GDataYouTubeMultiQuery *self, QueryType type, GDataYouTubeStandardFeedType feed_type, GDataYouTubeVideo *video, GDataQuery *query,
+           GDataYouTubeMultiQueryCallback callback, gpointer user_data)
+{
+	QueuedQuery *queued_query;
+
+	queued_query = g_slice_new0 (QueuedQuery);
+	queued_query->id = self->priv->next_id++;
+	queued_query->type = type;
+	queued_query->feed_type = feed_type;
+	queued_query->video = (video != NULL) ? g_object_ref (video) : NULL;
+	queued_query->query = (query != NULL) ? g_object_ref (query) : NULL;
+	queued_query->callback = callback;
+	queued_query->user_data = user_data;
+
+	g_ptr_array_add (self->priv->queries, queued_query);
+
+	return queued_query->id;
+}
+
+/**
+ * gdata_youtube_multi_query_add_standard_feed:
+ * @self: a #GDataYouTubeMultiQuery
+ * @feed_type: the feed type to query, from #GDataYouTubeStandardFeedType
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @callback: (scope async): a #GDataYouTubeMultiQueryCallback to call when the query is finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Adds a query of the standard feed @feed_type to the #GDataYouTubeMultiQuery, to be run as by gdata_youtube_service_query_standard_feed().
+ * @query is reffed, and will be updated with the query's pagination links when it finishes; so the same #GDataQuery must not be added more than
+ * once to a #GDataYouTubeMultiQuery.
+ *
+ * This must be called before the queries are run.
+ *
+ * Return value: the query's ID, which is passed to @callback when the query finishes
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_youtube_multi_query_add_standard_feed (GDataYouTubeMultiQuery *self, GDataYouTubeStandardFeedType feed_type, GDataQuery *query,
+                                             GDataYouTubeMultiQueryCallback callback, gpointer user_data)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_MULTI_QUERY (self), 0);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), 0);
+	g_return_val_if_fail (self->priv->has_run == FALSE, 0);
+
+	return add_query (self, QUERY_STANDARD_FEED, feed_type, NULL, query, callback, user_data);
+}
+
+/**
+ * gdata_youtube_multi_query_add_related:
+ * @self: a #GDataYouTubeMultiQuery
+ * @video: a #GDataYouTubeVideo for which to find related videos
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @callback: (scope async): a #GDataYouTubeMultiQueryCallback to call when the query is finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Adds a query for videos related to @video to the #GDataYouTubeMultiQuery, to be run as by gdata_youtube_service_query_related(). @video and
+ * @query are reffed; see gdata_youtube_multi_query_add_standard_feed() for the caveats about sharing @query.
+ *
+ * This must be called before the queries are run.
+ *
+ * Return value: the query's ID, which is passed to @callback when the query finishes
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_youtube_multi_query_add_related (GDataYouTubeMultiQuery *self, GDataYouTubeVideo *video, GDataQuery *query,
+                                       GDataYouTubeMultiQueryCallback callback, gpointer user_data)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_MULTI_QUERY (self), 0);
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (video), 0);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), 0);
+	g_return_val_if_fail (self->priv->has_run == FALSE, 0);
+
+	return add_query (self, QUERY_RELATED, 0, video, query, callback, user_data);
+}
+
+/**
+ * gdata_youtube_multi_query_add_videos:
+ * @self: a #GDataYouTubeMultiQuery
+ * @query: (allow-none): a #GDataQuery with the query parameters, or %NULL
+ * @callback: (scope async): a #GDataYouTubeMultiQueryCallback to call when the query is finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Adds a video search to the #GDataYouTubeMultiQuery, to be run as by gdata_youtube_service_query_videos(). @query is reffed; see
+ * gdata_youtube_multi_query_add_standard_feed() for the caveats about sharing it.
+ *
+ * This must be called before the queries are run.
+ *
+ * Return value: the query's ID, which is passed to @callback when the query finishes
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_youtube_multi_query_add_videos (GDataYouTubeMultiQuery *self, GDataQuery *query, GDataYouTubeMultiQueryCallback callback, gpointer user_data)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_MULTI_QUERY (self), 0);
+	g_return_val_if_fail (query == NULL || GDATA_IS_QUERY (query), 0);
+	g_return_val_if_fail (self->priv->has_run == FALSE, 0);
+
+	return add_query (self, QUERY_VIDEOS, 0, NULL, query, callback, user_data);
+}
+
+static void
+query_thread (QueuedQuery *query, GDataYouTubeService *service)
+{
+	switch (query->type) {
+		case QUERY_STANDARD_FEED:
+			query->feed = gdata_youtube_service_query_standard_feed (service, query->feed_type, query->query, query->cancellable, NULL, NULL,
+			                                                         &(query->error));
+			break;
+		case QUERY_RELATED:
+			query->feed = gdata_youtube_service_query_related (service, query->video, query->query, query->cancellable, NULL, NULL,
+			                                                   &(query->error));
+			break;
+		case QUERY_VIDEOS:
+			query->feed = gdata_youtube_service_query_videos (service, query->query, query->cancellable, NULL, NULL, &(query->error));
+			break;
+		default:
+			g_assert_not_reached ();
+	}
+
+	g_async_queue_push (query->results, query);
+}
+
+/* Run the user-supplied callback for a query which has finished. This is designed to be used in an idle handler, so that the callback is run in
+ * the main context the queries were run from. */
+static gboolean
+run_callback_cb (QueuedQuery *query)
+{
+	if (query->callback != NULL)
+		query->callback (query->id, query->feed, query->error, query->user_data);
+
+	/* Unset the callback so that it can't be called again */
+	query->callback = NULL;
+
+	return FALSE;
+}
+
+/**
+ * gdata_youtube_multi_query_run:
+ * @self: a #GDataYouTubeMultiQuery
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Run the queries in the #GDataYouTubeMultiQuery synchronously. They are run in parallel, up to #GDataYouTubeMultiQuery:max-concurrent-queries
+ * at once, and their callbacks are called synchronously (i.e. before gdata_youtube_multi_query_run() returns, and in the same thread that called
+ * gdata_youtube_multi_query_run()) as each finishes.
+ *
+ * The callbacks for all of the queries are always guaranteed to be called, even if the queries fail. The return value indicates whether all the
+ * queries were successful: if any of them failed, %FALSE is returned with the first error which occurred.
+ *
+ * @cancellable can be used to cancel all the queries which haven't finished yet. They will be reported to their callbacks with
+ * %G_IO_ERROR_CANCELLED.
+ *
+ * A #GDataYouTubeMultiQuery can only be run once.
+ *
+ * Return value: %TRUE if all the queries succeeded, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_youtube_multi_query_run (GDataYouTubeMultiQuery *self, GCancellable *cancellable, GError **error)
+{
+	GDataYouTubeMultiQueryPrivate *priv = self->priv;
+	GAsyncQueue *results;
+	GThreadPool *pool;
+	guint max_concurrent_queries, i;
+	GError *child_error = NULL;
+
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_MULTI_QUERY (self), FALSE);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+	g_return_val_if_fail (priv->has_run == FALSE, FALSE);
+
+	/* Ensure that this GDataYouTubeMultiQuery can't be run again */
+	priv->has_run = TRUE;
+
+	if (priv->queries->len == 0)
+		return TRUE;
+
+	/* All the queries go to the same host, so there's no point running more at once than the service will open connections to it */
+	max_concurrent_queries = priv->max_concurrent_queries;
+	if (max_concurrent_queries == 0)
+		max_concurrent_queries = MAX (gdata_service_get_max_connections_per_host (GDATA_SERVICE (priv->service)), 1);
+
+	results = g_async_queue_new ();
+	pool = g_thread_pool_new ((GFunc) query_thread, priv->service, MIN (max_concurrent_queries, priv->queries->len), FALSE, NULL);
+
+	for (i = 0; i < priv->queries->len; i++) {
+		QueuedQuery *query = g_ptr_array_index (priv->queries, i);
+
+		query->cancellable = cancellable;
+		query->results = results;
+		g_thread_pool_push (pool, query, NULL);
+	}
+
+	/* Process the results in the order they arrive. As with GDataBatchOperation, only dispatch the callbacks in the calling thread's main
+	 * context if the queries were run with *_run_async(). */
+	for (i = 0; i < priv->queries->len; i++) {
+		QueuedQuery *query = g_async_queue_pop (results);
+
+		if (query->error != NULL && child_error == NULL)
+			child_error = g_error_copy (query->error);
+
+		if (query->callback == NULL)
+			continue;
+		else if (priv->is_async == TRUE)
+			_gdata_service_idle_add (priv->context, (GSourceFunc) run_callback_cb, query, NULL);
+		else
+			run_callback_cb (query);
+	}
+
+	g_thread_pool_free (pool, FALSE, TRUE);
+	g_async_queue_unref (results);
+
+	if (child_error != NULL) {
+		g_propagate_error (error, child_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+run_thread (GSimpleAsyncResult *result, GDataYouTubeMultiQuery *multi_query, GCancellable *cancellable)
+{
+	gboolean success;
+	GError *error = NULL;
+
+	/* Run the queries and return */
+	success = gdata_youtube_multi_query_run (multi_query, cancellable, &error);
+	g_simple_async_result_set_op_res_gboolean (result, success);
+
+	/* Propagate any errors */
+	if (success == FALSE) {
+		g_simple_async_result_set_from_error (result, error);
+		g_error_free (error);
+	}
+}
+
+/**
+ * gdata_youtube_multi_query_run_async:
+ * @self: a #GDataYouTubeMultiQuery
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when all the queries are finished, or %NULL
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Run the queries in the #GDataYouTubeMultiQuery asynchronously, calling their callbacks asynchronously (i.e. in idle functions in the thread-default
+ * main context of the thread which called this function) as each finishes. @self is reffed when this function is called, so can safely be unreffed
+ * after this function returns.
+ *
+ * For more details, see gdata_youtube_multi_query_run(), which is the synchronous version of this function.
+ *
+ * When all the queries are finished, @callback will be called. You can then call gdata_youtube_multi_query_run_finish() to get the results of
+ * the run.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_youtube_multi_query_run_async (GDataYouTubeMultiQuery *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+
+	g_return_if_fail (GDATA_IS_YOUTUBE_MULTI_QUERY (self));
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (self->priv->has_run == FALSE);
+
+	/* Mark the queries as async for the purposes of deciding where to call the callbacks */
+	self->priv->is_async = TRUE;
+	self->priv->context = g_main_context_ref_thread_default ();
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, gdata_youtube_multi_query_run_async);
+
+	/* Disable handling of cancellation so that run_thread() is always called, and so all the queries' callbacks are called */
+	g_simple_async_result_set_handle_cancellation (result, FALSE);
+
+	g_simple_async_result_run_in_thread (result, (GSimpleAsyncThreadFunc) run_thread, G_PRIORITY_DEFAULT, cancellable);
+	g_object_unref (result);
+}
+
+/**
+ * gdata_youtube_multi_query_run_finish:
+ * @self: a #GDataYouTubeMultiQuery
+ * @async_result: a #GAsyncResult
+ * @error: a #GError, or %NULL
+ *
+ * Finishes an asynchronous run of the queries started with gdata_youtube_multi_query_run_async().
+ *
+ * Return values are as for gdata_youtube_multi_query_run().
+ *
+ * Return value: %TRUE if all the queries succeeded, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_youtube_multi_query_run_finish (GDataYouTubeMultiQuery *self, GAsyncResult *async_result, GError **error)
+{
+	GSimpleAsyncResult *result = G_SIMPLE_ASYNC_RESULT (async_result);
+
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_MULTI_QUERY (self), FALSE);
+	g_return_val_if_fail (G_IS_ASYNC_RESULT (async_result), FALSE);
+	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+	g_warn_if_fail (g_simple_async_result_get_source_tag (result) == gdata_youtube_multi_query_run_async);
+
+	if (g_simple_async_result_propagate_error (result, error) == TRUE)
+		return FALSE;
+
+	return g_simple_async_result_get_op_res_gboolean (result);
+}
@@ -0,0 +1,107 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_YOUTUBE_MULTI_QUERY_H
+#define GDATA_YOUTUBE_MULTI_QUERY_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include <gdata/gdata-feed.h>
+#include <gdata/gdata-query.h>
+#include <gdata/services/youtube/gdata-youtube-service.h>
+#include <gdata/services/youtube/gdata-youtube-video.h>
+
+G_BEGIN_DECLS
+
+/**
+ * GDataYouTubeMultiQueryCallback:
+ * @query_id: the query ID returned when the query was added to the #GDataYouTubeMultiQuery
+ * @feed: (allow-none): the feed of results, or %NULL
+ * @error: a #GError describing any error which occurred, or %NULL
+ * @user_data: user data passed to the callback
+ *
+ * Callback function called once for each query in a #GDataYouTubeMultiQuery run, as soon as that query has finished. If the query was successful,
+ * @feed will contain its results and @error will be %NULL. Otherwise, @feed will be %NULL and a descriptive error will be in @error.
+ *
+ * Both @feed and @error are owned by the #GDataYouTubeMultiQuery; if the callback needs to keep @feed, it must reference it.
+ *
+ * As with #GDataBatchOperationCallback, the callback is called in the thread which called gdata_youtube_multi_query_run(), or in the main thread
+ * if the queries were run with gdata_youtube_multi_query_run_async(). Queries may finish in any order.
+ *
+ * Since: 0.15.0
+ */
+typedef void (*GDataYouTubeMultiQueryCallback) (guint query_id, GDataFeed *feed, GError *error, gpointer user_data);
+
+#define GDATA_TYPE_YOUTUBE_MULTI_QUERY			(gdata_youtube_multi_query_get_type ())
+#define GDATA_YOUTUBE_MULTI_QUERY(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_YOUTUBE_MULTI_QUERY, GDataYouTubeMultiQuery))
+#define GDATA_YOUTUBE_MULTI_QUERY_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_YOUTUBE_MULTI_QUERY, GDataYouTubeMultiQueryClass))
+#define GDATA_IS_YOUTUBE_MULTI_QUERY(o)			(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_YOUTUBE_MULTI_QUERY))
+#define GDATA_IS_YOUTUBE_MULTI_QUERY_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_YOUTUBE_MULTI_QUERY))
+#define GDATA_YOUTUBE_MULTI_QUERY_GET_CLASS(o)		(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_YOUTUBE_MULTI_QUERY, GDataYouTubeMultiQueryClass))
+
+typedef struct _GDataYouTubeMultiQueryPrivate	GDataYouTubeMultiQueryPrivate;
+
+/**
+ * GDataYouTubeMultiQuery:
+ *
+ * All the fields in the #GDataYouTubeMultiQuery structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataYouTubeMultiQueryPrivate *priv;
+} GDataYouTubeMultiQuery;
+
+/**
+ * GDataYouTubeMultiQueryClass:
+ *
+ * All the fields in the #GDataYouTubeMultiQueryClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataYouTubeMultiQueryClass;
+
+GType gdata_youtube_multi_query_get_type (void) G_GNUC_CONST;
+
+GDataYouTubeMultiQuery *gdata_youtube_multi_query_new (GDataYouTubeService *service) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataYouTubeService *gdata_youtube_multi_query_get_service (GDataYouTubeMultiQuery *self) G_GNUC_PURE;
+guint gdata_youtube_multi_query_get_max_concurrent_queries (GDataYouTubeMultiQuery *self) G_GNUC_PURE;
+void gdata_youtube_multi_query_set_max_concurrent_queries (GDataYouTubeMultiQuery *self, guint max_concurrent_queries);
+
+guint gdata_youtube_multi_query_add_standard_feed (GDataYouTubeMultiQuery *self, GDataYouTubeStandardFeedType feed_type, GDataQuery *query,
+                                                   GDataYouTubeMultiQueryCallback callback, gpointer user_data);
+guint gdata_youtube_multi_query_add_related (GDataYouTubeMultiQuery *self, GDataYouTubeVideo *video, GDataQuery *query,
+                                             GDataYouTubeMultiQueryCallback callback, gpointer user_data);
+guint gdata_youtube_multi_query_add_videos (GDataYouTubeMultiQuery *self, GDataQuery *query, GDataYouTubeMultiQueryCallback callback,
+                                            gpointer user_data);
+
+gboolean gdata_youtube_multi_query_run (GDataYouTubeMultiQuery *self, GCancellable *cancellable, GError **error);
+void gdata_youtube_multi_query_run_async (GDataYouTubeMultiQuery *self, GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+gboolean gdata_youtube_multi_query_run_finish (GDataYouTubeMultiQuery *self, GAsyncResult *async_result, GError **error);
+
+G_END_DECLS
+
+#endif /* !GDATA_YOUTUBE_MULTI_QUERY_H */
@@ -241,6 +241,7 @@
 #include <glib.h>
 #include <glib/gi18n-lib.h>
 #include <libsoup/soup.h>
+#include <libxml/xmlreader.h>
 #include <string.h>
 
 #include "gdata-youtube-service.h"
@@ -250,6 +251,7 @@
 #include "atom/gdata-link.h"
 #include "gdata-upload-stream.h"
 #include "gdata-youtube-category.h"
+#include "gdata-youtube-query.h"
 #include "gdata-batchable.h"
 
 /* Standards reference here: http://code.google.com/apis/youtube/2.0/reference.html */
@@ -375,12 +377,84 @@ append_query_headers (GDataService *self, GDataAuthorizationDomain *domain, Soup
 	GDATA_SERVICE_CLASS (gdata_youtube_service_parent_class)->append_query_headers (self, domain, message);
 }
 
+/* Reads the first <error> element out of a YouTube <errors> response, stopping as soon as it's been read rather than building a DOM for the whole
+ * response. Returns %FALSE if the response isn't an <errors> document. Otherwise, @domain, @code and @location are set to the error's details, or
+ * are all left %NULL if the <error> element couldn't be understood. */
+static gboolean
+read_first_error (const gchar *response_body, gint length, xmlChar **domain, xmlChar **code, xmlChar **location)
+{
+	xmlTextReader *reader;
+	gboolean is_errors = FALSE, understood = TRUE;
+
+	*domain = *code = *location = NULL;
+
+	reader = xmlReaderForMemory (response_body, length, "/dev/null", NULL, XML_PARSE_NONET | XML_PARSE_NOERROR | XML_PARSE_NOWARNING);
+	if (reader == NULL)
+		return FALSE;
+
+	while (xmlTextReaderRead (reader) == 1) {
+		const xmlChar *name;
+		xmlChar **field;
+		int depth;
+
+		depth = xmlTextReaderDepth (reader);
+
+		if (xmlTextReaderNodeType (reader) == XML_READER_TYPE_END_ELEMENT && depth == 1) {
+			/* Finished the first <error> element; any others are ignored */
+			break;
+		} else if (xmlTextReaderNodeType (reader) != XML_READER_TYPE_ELEMENT) {
+			continue;
+		}
+
+		name = xmlTextReaderConstLocalName (reader);
+
+		if (depth == 0) {
+			/* The root element must be <errors> */
+			is_errors = (xmlStrcmp (name, (xmlChar*) "errors") == 0) ? TRUE : FALSE;
+			if (is_errors == FALSE)
+				break;
+
+			continue;
+		} else if (depth != 2) {
+			continue;
+		}
+
+		if (xmlStrcmp (name, (xmlChar*) "domain") == 0) {
+			field = domain;
+		} else if (xmlStrcmp (name, (xmlChar*) "code") == 0) {
+			field = code;
+		} else if (xmlStrcmp (name, (xmlChar*) "location") == 0) {
+			field = location;
+		} else if (xmlStrcmp (name, (xmlChar*) "internalReason") == 0) {
+			continue;
+		} else {
+			/* Unknown element */
+			g_message ("Unhandled <error/%s> element.", name);
+			understood = FALSE;
+			break;
+		}
+
+		if (*field == NULL)
+			*field = xmlTextReaderReadString (reader);
+	}
+
+	xmlFreeTextReader (reader);
+
+	if (is_errors == FALSE || understood == FALSE || (*domain == NULL && *code == NULL)) {
+		xmlFree (*domain);
+		xmlFree (*code);
+		xmlFree (*location);
+		*domain = *code = *location = NULL;
+	}
+
+	return is_errors;
+}
+
 static void
 parse_error_response (GDataService *self, GDataOperationType operation_type, guint status, const gchar *reason_phrase, const gchar *response_body,
                       gint length, GError **error)
 {
-	xmlDoc *doc;
-	xmlNode *node;
+	xmlChar *domain, *code, *location;
 
 	if (response_body == NULL)
 		goto parent;
@@ -388,128 +462,66 @@ parse_error_response (GDataService *self, GDataOperationType operation_type, gui
 	if (length == -1)
 		length = strlen (response_body);
 
-	/* Parse the XML */
-	doc = xmlReadMemory (response_body, length, "/dev/null", NULL, 0);
-	if (doc == NULL)
-		goto parent;
-
-	/* Get the root element */
-	node = xmlDocGetRootElement (doc);
-	if (node == NULL) {
-		/* XML document's empty; chain up to the parent class */
-		xmlFreeDoc (doc);
-		goto parent;
-	}
-
-	if (xmlStrcmp (node->name, (xmlChar*) "errors") != 0) {
+	/* Only the first error is reported, so the response is scanned just as far as that, rather than being parsed in full */
+	if (read_first_error (response_body, length, &domain, &code, &location) == FALSE) {
 		/* No <errors> element (required); chain up to the parent class */
-		xmlFreeDoc (doc);
 		goto parent;
 	}
 
-	/* Parse the actual errors */
-	node = node->children;
-	while (node != NULL) {
-		xmlChar *domain = NULL, *code = NULL, *location = NULL;
-		xmlNode *child_node = node->children;
-
-		if (node->type == XML_TEXT_NODE) {
-			/* Skip text nodes; they're all whitespace */
-			node = node->next;
-			continue;
-		}
+	if (domain == NULL && code == NULL) {
+		g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR, _("Unknown and unparsable error received."));
+		return;
+	}
 
-		/* Get the error data */
-		while (child_node != NULL) {
-			if (child_node->type == XML_TEXT_NODE) {
-				/* Skip text nodes; they're all whitespace */
-				child_node = child_node->next;
-				continue;
-			}
-
-			if (xmlStrcmp (child_node->name, (xmlChar*) "domain") == 0)
-				domain = xmlNodeListGetString (doc, child_node->children, TRUE);
-			else if (xmlStrcmp (child_node->name, (xmlChar*) "code") == 0)
-				code = xmlNodeListGetString (doc, child_node->children, TRUE);
-			else if (xmlStrcmp (child_node->name, (xmlChar*) "location") == 0)
-				location = xmlNodeListGetString (doc, child_node->children, TRUE);
-			else if (xmlStrcmp (child_node->name, (xmlChar*) "internalReason") != 0) {
-				/* Unknown element (ignore internalReason) */
-				g_message ("Unhandled <error/%s> element.", child_node->name);
-
-				xmlFree (domain);
-				xmlFree (code);
-				xmlFree (location);
-				xmlFreeDoc (doc);
-				goto check_error;
-			}
-
-			child_node = child_node->next;
+	/* See http://code.google.com/apis/youtube/2.0/developers_guide_protocol.html#Error_responses */
+	if (xmlStrcmp (domain, (xmlChar*) "yt:service") == 0) {
+		if (xmlStrcmp (code, (xmlChar*) "disabled_in_maintenance_mode") == 0) {
+			/* Service disabled */
+			g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_UNAVAILABLE,
+			             _("This service is not available at the moment."));
+		} else if (xmlStrcmp (code, (xmlChar*) "youtube_signup_required") == 0) {
+			/* Tried to authenticate with a Google Account which hasn't yet had a YouTube channel created for it. */
+			g_set_error (error, GDATA_YOUTUBE_SERVICE_ERROR, GDATA_YOUTUBE_SERVICE_ERROR_CHANNEL_REQUIRED,
+			             /* Translators: the parameter is a URI. */
+			             _("Your Google Account must be associated with a YouTube channel to do this. Visit %s to create one."),
+			             "https://www.youtube.com/create_channel");
+		} else {
+			/* Protocol error */
+			g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+			             _("Unknown error code \"%s\" in domain \"%s\" received with location \"%s\"."),
+			             code, domain, location);
 		}
-
-		/* Create an error message, but only for the first error */
-		if (error == NULL || *error == NULL) {
-			/* See http://code.google.com/apis/youtube/2.0/developers_guide_protocol.html#Error_responses */
-			if (xmlStrcmp (domain, (xmlChar*) "yt:service") == 0) {
-				if (xmlStrcmp (code, (xmlChar*) "disabled_in_maintenance_mode") == 0) {
-					/* Service disabled */
-					g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_UNAVAILABLE,
-					             _("This service is not available at the moment."));
-				} else if (xmlStrcmp (code, (xmlChar*) "youtube_signup_required") == 0) {
-					/* Tried to authenticate with a Google Account which hasn't yet had a YouTube channel created for it. */
-					g_set_error (error, GDATA_YOUTUBE_SERVICE_ERROR, GDATA_YOUTUBE_SERVICE_ERROR_CHANNEL_REQUIRED,
-					             /* Translators: the parameter is a URI. */
-					             _("Your Google Account must be associated with a YouTube channel to do this. Visit %s to create one."),
-					             "https://www.youtube.com/create_channel");
-				} else {
-					/* Protocol error */
-					g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
-					             _("Unknown error code \"%s\" in domain \"%s\" received with location \"%s\"."),
-					             code, domain, location);
-				}
-			} else if (xmlStrcmp (domain, (xmlChar*) "yt:authentication") == 0) {
-				/* Authentication problem */
-				g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
-				             _("You must be authenticated to do this."));
-			} else if (xmlStrcmp (domain, (xmlChar*) "yt:quota") == 0) {
-				/* Quota errors */
-				if (xmlStrcmp (code, (xmlChar*) "too_many_recent_calls") == 0) {
-					g_set_error (error, GDATA_YOUTUBE_SERVICE_ERROR, GDATA_YOUTUBE_SERVICE_ERROR_API_QUOTA_EXCEEDED,
-					             _("You have made too many API calls recently. Please wait a few minutes and try again."));
-				} else if (xmlStrcmp (code, (xmlChar*) "too_many_entries") == 0) {
-					g_set_error (error, GDATA_YOUTUBE_SERVICE_ERROR, GDATA_YOUTUBE_SERVICE_ERROR_ENTRY_QUOTA_EXCEEDED,
-					             _("You have exceeded your entry quota. Please delete some entries and try again."));
-				} else {
-					/* Protocol error */
-					g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
-					             /* Translators: the first parameter is an error code, which is a coded string.
-					              * The second parameter is an error domain, which is another coded string.
-					              * The third parameter is the location of the error, which is either a URI or an XPath. */
-					             _("Unknown error code \"%s\" in domain \"%s\" received with location \"%s\"."),
-					             code, domain, location);
-				}
-			} else {
-				/* Unknown or validation (protocol) error */
-				g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
-				             _("Unknown error code \"%s\" in domain \"%s\" received with location \"%s\"."),
-				             code, domain, location);
-			}
+	} else if (xmlStrcmp (domain, (xmlChar*) "yt:authentication") == 0) {
+		/* Authentication problem */
+		g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED,
+		             _("You must be authenticated to do this."));
+	} else if (xmlStrcmp (domain, (xmlChar*) "yt:quota") == 0) {
+		/* Quota errors */
+		if (xmlStrcmp (code, (xmlChar*) "too_many_recent_calls") == 0) {
+			g_set_error (error, GDATA_YOUTUBE_SERVICE_ERROR, GDATA_YOUTUBE_SERVICE_ERROR_API_QUOTA_EXCEEDED,
+			             _("You have made too many API calls recently. Please wait a few minutes and try again."));
+		} else if (xmlStrcmp (code, (xmlChar*) "too_many_entries") == 0) {
+			g_set_error (error, GDATA_YOUTUBE_SERVICE_ERROR, GDATA_YOUTUBE_SERVICE_ERROR_ENTRY_QUOTA_EXCEEDED,
+			             _("You have exceeded your entry quota. Please delete some entries and try again."));
 		} else {
-			/* For all errors after the first, log the error in the terminal */
-			g_debug ("Error message received in response: code \"%s\", domain \"%s\", location \"%s\".", code, domain, location);
+			/* Protocol error */
+			g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+			             /* Translators: the first parameter is an error code, which is a coded string.
+			              * The second parameter is an error domain, which is another coded string.
+			              * The third parameter is the location of the error, which is either a URI or an XPath. */
+			             _("Unknown error code \"%s\" in domain \"%s\" received with location \"%s\"."),
+			             code, domain, location);
 		}
-
-		xmlFree (domain);
-		xmlFree (code);
-		xmlFree (location);
-
-		node = node->next;
+	} else {
+		/* Unknown or validation (protocol) error */
+		g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR,
+		             _("Unknown error code \"%s\" in domain \"%s\" received with location \"%s\"."),
+		             code, domain, location);
 	}
 
-check_error:
-	/* Ensure we're actually set an error message */
-	if (error != NULL && *error == NULL)
-		g_set_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR, _("Unknown and unparsable error received."));
+	xmlFree (domain);
+	xmlFree (code);
+	xmlFree (location);
 
 	return;
 
@@ -844,6 +856,156 @@ gdata_youtube_service_query_related_async (GDataYouTubeService *self, GDataYouTu
 	g_free (uri);
 }
 
+/* Comparison functions for the orders gdata_youtube_service_query_top_videos() knows how to rank videos in. @direction is 1 for the best (highest)
+ * values first, or -1 for the reverse. */
+static gint
+compare_videos_by_view_count (GDataYouTubeVideo *a, GDataYouTubeVideo *b, gpointer direction)
+{
+	guint a_views = gdata_youtube_video_get_view_count (a), b_views = gdata_youtube_video_get_view_count (b);
+	return GPOINTER_TO_INT (direction) * ((a_views > b_views) ? -1 : (a_views < b_views) ? 1 : 0);
+}
+
+static gint
+compare_videos_by_rating (GDataYouTubeVideo *a, GDataYouTubeVideo *b, gpointer direction)
+{
+	gdouble a_rating, b_rating;
+
+	gdata_youtube_video_get_rating (a, NULL, NULL, NULL, &a_rating);
+	gdata_youtube_video_get_rating (b, NULL, NULL, NULL, &b_rating);
+
+	return GPOINTER_TO_INT (direction) * ((a_rating > b_rating) ? -1 : (a_rating < b_rating) ? 1 : 0);
+}
+
+static gint
+compare_videos_by_published (GDataYouTubeVideo *a, GDataYouTubeVideo *b, gpointer direction)
+{
+	gint64 a_published = gdata_entry_get_published (GDATA_ENTRY (a)), b_published = gdata_entry_get_published (GDATA_ENTRY (b));
+	return GPOINTER_TO_INT (direction) * ((a_published > b_published) ? -1 : (a_published < b_published) ? 1 : 0);
+}
+
+/* Works out how to rank videos from the #GDataYouTubeQuery:order-by and #GDataYouTubeQuery:sort-order of @query. Returns %FALSE if the order isn't
+ * one which can be reproduced locally. */
+static gboolean
+get_video_compare_func (GDataQuery *query, GCompareDataFunc *compare_func, gpointer *compare_user_data)
+{
+	const gchar *order_by;
+
+	if (GDATA_IS_YOUTUBE_QUERY (query) == FALSE)
+		return FALSE;
+
+	order_by = gdata_youtube_query_get_order_by (GDATA_YOUTUBE_QUERY (query));
+
+	if (g_strcmp0 (order_by, "viewCount") == 0)
+		*compare_func = (GCompareDataFunc) compare_videos_by_view_count;
+	else if (g_strcmp0 (order_by, "rating") == 0)
+		*compare_func = (GCompareDataFunc) compare_videos_by_rating;
+	else if (g_strcmp0 (order_by, "published") == 0)
+		*compare_func = (GCompareDataFunc) compare_videos_by_published;
+	else
+		return FALSE;
+
+	*compare_user_data = GINT_TO_POINTER ((gdata_youtube_query_get_sort_order (GDATA_YOUTUBE_QUERY (query)) == GDATA_YOUTUBE_SORT_ASCENDING) ? -1 : 1);
+
+	return TRUE;
+}
+
+/**
+ * gdata_youtube_service_query_top_videos:
+ * @self: a #GDataYouTubeService
+ * @queries: (element-type GData.Query): a list of #GDataQuery<!-- -->s, one for each source of videos (such as a channel, by setting
+ * #GDataQuery:author)
+ * @n_videos: the number of videos to return; must be greater than <code class="literal">0</code>
+ * @compare_func: (allow-none) (scope call) (closure compare_user_data): a function which returns a negative number if its first video ranks
+ * higher than its second, a positive number if it ranks lower, or <code class="literal">0</code> if they rank equally; or %NULL
+ * @compare_user_data: data to pass to @compare_func
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @error: a #GError, or %NULL
+ *
+ * Finds the @n_videos highest-ranking videos across several queries for videos, as returned by gdata_youtube_service_query_videos() for each of
+ * them. Each query must have the server return its videos in the order defined by @compare_func; each source is only paged through until its
+ * videos can no longer make the cut, so this is much cheaper than fetching all their videos and sorting them.
+ *
+ * If @compare_func is %NULL, the videos are ranked by the #GDataYouTubeQuery:order-by and #GDataYouTubeQuery:sort-order of the first of
+ * @queries, which must be a #GDataYouTubeQuery ordered by <literal>viewCount</literal>, <literal>rating</literal> or
+ * <literal>published</literal>.
+ *
+ * For more details, see gdata_service_query_top_entries().
+ *
+ * Return value: (transfer full) (element-type GData.YouTubeVideo): the highest-ranking videos, best first; free with g_list_free_full() and
+ * g_object_unref()
+ *
+ * Since: 0.15.0
+ **/
+GList *
+gdata_youtube_service_query_top_videos (GDataYouTubeService *self, GList *queries, guint n_videos, GCompareDataFunc compare_func,
+                                        gpointer compare_user_data, GCancellable *cancellable, GError **error)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), NULL);
+	g_return_val_if_fail (queries != NULL, NULL);
+	g_return_val_if_fail (n_videos > 0, NULL);
+	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+	if (compare_func == NULL) {
+		gboolean has_compare_func = get_video_compare_func (queries->data, &compare_func, &compare_user_data);
+		g_return_val_if_fail (has_compare_func == TRUE, NULL);
+	}
+
+	return gdata_service_query_top_entries (GDATA_SERVICE (self), get_youtube_authorization_domain (), "https://gdata.youtube.com/feeds/api/videos",
+	                                        queries, GDATA_TYPE_YOUTUBE_VIDEO, n_videos, compare_func, compare_user_data, cancellable, error);
+}
+
+/**
+ * gdata_youtube_service_query_top_videos_async:
+ * @self: a #GDataYouTubeService
+ * @queries: (element-type GData.Query): a list of #GDataQuery<!-- -->s, one for each source of videos
+ * @n_videos: the number of videos to return; must be greater than <code class="literal">0</code>
+ * @compare_func: (allow-none) (scope notified) (closure compare_user_data): a function which returns a negative number if its first video ranks
+ * higher than its second, a positive number if it ranks lower, or <code class="literal">0</code> if they rank equally; or %NULL
+ * @compare_user_data: data to pass to @compare_func
+ * @destroy_compare_user_data: (allow-none): the function to call when @compare_func will not be called any more, or %NULL
+ * @cancellable: (allow-none): optional #GCancellable object, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the queries are finished
+ * @user_data: (closure): data to pass to the @callback function
+ *
+ * Finds the @n_videos highest-ranking videos across several queries for videos. @self is reffed and @queries are copied when this function is
+ * called, so can safely be freed after this function returns.
+ *
+ * For more details, see gdata_youtube_service_query_top_videos(), which is the synchronous version of this function.
+ *
+ * When the operation is finished, @callback will be called. You can then call gdata_service_query_top_entries_finish() to get the results of the
+ * operation.
+ *
+ * Since: 0.15.0
+ **/
+void
+gdata_youtube_service_query_top_videos_async (GDataYouTubeService *self, GList *queries, guint n_videos, GCompareDataFunc compare_func,
+                                              gpointer compare_user_data, GDestroyNotify destroy_compare_user_data, GCancellable *cancellable,
+                                              GAsyncReadyCallback callback, gpointer user_data)
+{
+	g_return_if_fail (GDATA_IS_YOUTUBE_SERVICE (self));
+	g_return_if_fail (queries != NULL);
+	g_return_if_fail (n_videos > 0);
+	g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+	g_return_if_fail (callback != NULL);
+
+	if (compare_func == NULL) {
+		gboolean has_compare_func;
+
+		/* The caller's data won't be needed, since it's replaced by our own */
+		if (destroy_compare_user_data != NULL)
+			destroy_compare_user_data (compare_user_data);
+		destroy_compare_user_data = NULL;
+
+		has_compare_func = get_video_compare_func (queries->data, &compare_func, &compare_user_data);
+		g_return_if_fail (has_compare_func == TRUE);
+	}
+
+	gdata_service_query_top_entries_async (GDATA_SERVICE (self), get_youtube_authorization_domain (), "https://gdata.youtube.com/feeds/api/videos",
+	                                       queries, GDATA_TYPE_YOUTUBE_VIDEO, n_videos, compare_func, compare_user_data,
+	                                       destroy_compare_user_data, cancellable, callback, user_data);
+}
+
 /**
  * gdata_youtube_service_upload_video:
  * @self: a #GDataYouTubeService
@@ -937,6 +1099,40 @@ gdata_youtube_service_finish_video_upload (GDataYouTubeService *self, GDataUploa
 	return GDATA_YOUTUBE_VIDEO (gdata_parsable_new_from_xml (GDATA_TYPE_YOUTUBE_VIDEO, response_body, (gint) response_length, error));
 }
 
+static GDataUploadStream *
+upload_queue_start_cb (GDataService *service, GDataEntry *entry, const gchar *slug, const gchar *content_type, GCancellable *cancellable,
+                       gpointer user_data, GError **error)
+{
+	return gdata_youtube_service_upload_video (GDATA_YOUTUBE_SERVICE (service), GDATA_YOUTUBE_VIDEO (entry), slug, content_type, cancellable,
+	                                           error);
+}
+
+static GDataEntry *
+upload_queue_finish_cb (GDataService *service, GDataUploadStream *upload_stream, gpointer user_data, GError **error)
+{
+	return GDATA_ENTRY (gdata_youtube_service_finish_video_upload (GDATA_YOUTUBE_SERVICE (service), upload_stream, error));
+}
+
+/**
+ * gdata_youtube_service_create_upload_queue:
+ * @self: a #GDataYouTubeService
+ *
+ * Creates a new #GDataUploadQueue for uploading several videos to YouTube in parallel. The entries added to the queue with
+ * gdata_upload_queue_add_file() must be #GDataYouTubeVideo<!-- -->s, and are uploaded as by gdata_youtube_service_upload_video(). The uploaded
+ * entries passed to the queue's callbacks are also #GDataYouTubeVideo<!-- -->s.
+ *
+ * Return value: (transfer full): a new #GDataUploadQueue; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataUploadQueue *
+gdata_youtube_service_create_upload_queue (GDataYouTubeService *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), NULL);
+
+	return _gdata_upload_queue_new (GDATA_SERVICE (self), GDATA_TYPE_YOUTUBE_VIDEO, upload_queue_start_cb, upload_queue_finish_cb, NULL, NULL);
+}
+
 /**
  * gdata_youtube_service_get_developer_key:
  * @self: a #GDataYouTubeService
@@ -952,6 +1148,83 @@ gdata_youtube_service_get_developer_key (GDataYouTubeService *self)
 	return self->priv->developer_key;
 }
 
+/* Cache of the categories document, shared between all YouTube services, since it only depends on the locale. This maps locales (or the empty string
+ * for no locale) to CategoriesCacheEntrys. Each entry is revalidated with the server every time it's used, but that's much cheaper than downloading
+ * and parsing the whole document again, since the server normally responds with 304 Not Modified. While an entry is being revalidated, other
+ * requests for it wait for that to finish, rather than making their own requests. */
+typedef struct {
+	GDataAPPCategories *categories; /* NULL until the categories have been downloaded successfully */
+	gchar *etag;
+	gchar *last_modified;
+
+	gboolean is_updating; /* TRUE while a request for the categories is in progress */
+	guint generation; /* incremented whenever a request finishes, so that waiters know when to stop waiting */
+	GError *error; /* error from the most recent request, or NULL */
+} CategoriesCacheEntry;
+
+static GMutex categories_cache_mutex; /* protects categories_cache and all its entries */
+static GCond categories_cache_cond; /* signalled whenever an entry finishes updating, or a waiter is cancelled */
+static GHashTable *categories_cache = NULL;
+
+static void
+categories_cache_cancelled_cb (GCancellable *cancellable, gpointer user_data)
+{
+	g_mutex_lock (&categories_cache_mutex);
+	g_cond_broadcast (&categories_cache_cond);
+	g_mutex_unlock (&categories_cache_mutex);
+}
+
+/* Downloads the categories document if it's changed since @etag or @last_modified. Returns the new categories, or %NULL if they haven't changed (with
+ * @error unset) or on error. The new validators are returned in @new_etag and @new_last_modified. */
+static GDataAPPCategories *
+download_categories (GDataYouTubeService *self, const gchar *etag, const gchar *last_modified, gchar **new_etag, gchar **new_last_modified,
+                     GCancellable *cancellable, GError **error)
+{
+	SoupMessage *message;
+	GDataAPPCategories *categories;
+	guint status;
+
+	/* Download the category list. Note that this is (service) locale-dependent. */
+	message = _gdata_service_build_message (GDATA_SERVICE (self), get_youtube_authorization_domain (), SOUP_METHOD_GET,
+	                                        "https://gdata.youtube.com/schemas/2007/categories.cat", etag, FALSE);
+	if (last_modified != NULL)
+		soup_message_headers_append (message->request_headers, "If-Modified-Since", last_modified);
+
+	status = _gdata_service_send_message (GDATA_SERVICE (self), message, cancellable, error);
+
+	if (status == SOUP_STATUS_NOT_MODIFIED && (etag != NULL || last_modified != NULL)) {
+		/* The cached categories are still current */
+		g_object_unref (message);
+		return NULL;
+	} else if (status == SOUP_STATUS_CANCELLED || status == SOUP_STATUS_NONE) {
+		/* Cancelled (in which case the error has been set) */
+		g_object_unref (message);
+		return NULL;
+	} else if (status != SOUP_STATUS_OK) {
+		/* Error */
+		GDataServiceClass *klass = GDATA_SERVICE_GET_CLASS (self);
+		g_assert (klass->parse_error_response != NULL);
+		klass->parse_error_response (GDATA_SERVICE (self), GDATA_OPERATION_QUERY, status, message->reason_phrase, message->response_body->data,
+		                             message->response_body->length, error);
+		g_object_unref (message);
+		return NULL;
+	}
+
+	g_assert (message->response_body->data != NULL);
+	categories = GDATA_APP_CATEGORIES (_gdata_parsable_new_from_xml (GDATA_TYPE_APP_CATEGORIES, message->response_body->data,
+	                                                                 message->response_body->length,
+	                                                                 GSIZE_TO_POINTER (GDATA_TYPE_YOUTUBE_CATEGORY), error));
+
+	if (categories != NULL) {
+		*new_etag = g_strdup (soup_message_headers_get_one (message->response_headers, "ETag"));
+		*new_last_modified = g_strdup (soup_message_headers_get_one (message->response_headers, "Last-Modified"));
+	}
+
+	g_object_unref (message);
+
+	return categories;
+}
+
 /**
  * gdata_youtube_service_get_categories:
  * @self: a #GDataYouTubeService
@@ -963,6 +1236,10 @@ gdata_youtube_service_get_developer_key (GDataYouTubeService *self)
  *
  * The category labels (#GDataCategory:label) are localised based on the value of #GDataService:locale.
  *
+ * The categories are cached for each locale, and shared between all #GDataYouTubeService<!-- -->s in the process. Subsequent calls only check with
+ * the server that the categories haven't changed, and return the same #GDataAPPCategories if they haven't, so it shouldn't be modified. Concurrent
+ * calls for the same locale (including calls to gdata_youtube_service_get_categories_async()) share a single request.
+ *
  * Return value: (transfer full): a #GDataAPPCategories, or %NULL; unref with g_object_unref()
  *
  * Since: 0.7.0
@@ -970,24 +1247,108 @@ gdata_youtube_service_get_developer_key (GDataYouTubeService *self)
 GDataAPPCategories *
 gdata_youtube_service_get_categories (GDataYouTubeService *self, GCancellable *cancellable, GError **error)
 {
-	SoupMessage *message;
-	GDataAPPCategories *categories;
+	CategoriesCacheEntry *entry;
+	GDataAPPCategories *categories = NULL, *new_categories;
+	const gchar *locale;
+	gchar *etag, *last_modified, *new_etag = NULL, *new_last_modified = NULL;
+	GError *child_error = NULL;
 
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (self), NULL);
 	g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
 	g_return_val_if_fail (error == NULL || *error == NULL, NULL);
 
-	/* Download the category list. Note that this is (service) locale-dependent. */
-	message = _gdata_service_query (GDATA_SERVICE (self), get_youtube_authorization_domain (),
-	                                "https://gdata.youtube.com/schemas/2007/categories.cat", NULL, cancellable, error);
-	if (message == NULL)
-		return NULL;
+	locale = gdata_service_get_locale (GDATA_SERVICE (self));
 
-	g_assert (message->response_body->data != NULL);
-	categories = GDATA_APP_CATEGORIES (_gdata_parsable_new_from_xml (GDATA_TYPE_APP_CATEGORIES, message->response_body->data,
-	                                                                 message->response_body->length,
-	                                                                 GSIZE_TO_POINTER (GDATA_TYPE_YOUTUBE_CATEGORY), error));
-	g_object_unref (message);
+start:
+	g_mutex_lock (&categories_cache_mutex);
+
+	if (categories_cache == NULL)
+		categories_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	entry = g_hash_table_lookup (categories_cache, (locale != NULL) ? locale : "");
+	if (entry == NULL) {
+		entry = g_slice_new0 (CategoriesCacheEntry);
+		g_hash_table_insert (categories_cache, g_strdup ((locale != NULL) ? locale : ""), entry);
+	}
+
+	if (entry->is_updating == TRUE) {
+		guint generation = entry->generation;
+		gulong cancelled_signal = 0;
+
+		/* Another request for the categories is in progress, so wait for it to finish and use its result. The cancellable can't be
+		 * connected with the mutex held, as the handler is called immediately if the cancellable's already cancelled. */
+		if (cancellable != NULL) {
+			g_mutex_unlock (&categories_cache_mutex);
+			cancelled_signal = g_cancellable_connect (cancellable, (GCallback) categories_cache_cancelled_cb, NULL, NULL);
+			g_mutex_lock (&categories_cache_mutex);
+		}
+
+		while (entry->generation == generation && g_cancellable_is_cancelled (cancellable) == FALSE)
+			g_cond_wait (&categories_cache_cond, &categories_cache_mutex);
+
+		if (entry->generation == generation) {
+			g_cancellable_set_error_if_cancelled (cancellable, &child_error);
+		} else if (entry->error != NULL) {
+			child_error = g_error_copy (entry->error);
+		} else if (entry->categories != NULL) {
+			categories = g_object_ref (entry->categories);
+		}
+
+		g_mutex_unlock (&categories_cache_mutex);
+
+		if (cancellable != NULL)
+			g_cancellable_disconnect (cancellable, cancelled_signal);
+
+		/* If the other request was cancelled by its caller, but this one hasn't been, try again */
+		if (g_error_matches (child_error, G_IO_ERROR, G_IO_ERROR_CANCELLED) == TRUE && g_cancellable_is_cancelled (cancellable) == FALSE) {
+			g_clear_error (&child_error);
+			goto start;
+		}
+
+		if (child_error != NULL)
+			g_propagate_error (error, child_error);
+
+		return categories;
+	}
+
+	/* Otherwise, revalidate the cached categories (if there are any) ourselves */
+	entry->is_updating = TRUE;
+	etag = (entry->categories != NULL) ? g_strdup (entry->etag) : NULL;
+	last_modified = (entry->categories != NULL) ? g_strdup (entry->last_modified) : NULL;
+
+	g_mutex_unlock (&categories_cache_mutex);
+
+	new_categories = download_categories (self, etag, last_modified, &new_etag, &new_last_modified, cancellable, &child_error);
+
+	g_free (last_modified);
+	g_free (etag);
+
+	g_mutex_lock (&categories_cache_mutex);
+
+	if (new_categories != NULL) {
+		if (entry->categories != NULL)
+			g_object_unref (entry->categories);
+		entry->categories = new_categories; /* transfer ownership */
+
+		g_free (entry->etag);
+		entry->etag = new_etag; /* transfer ownership */
+		g_free (entry->last_modified);
+		entry->last_modified = new_last_modified; /* transfer ownership */
+	}
+
+	if (child_error == NULL && entry->categories != NULL)
+		categories = g_object_ref (entry->categories);
+
+	g_clear_error (&(entry->error));
+	entry->error = (child_error != NULL) ? g_error_copy (child_error) : NULL;
+	entry->is_updating = FALSE;
+	entry->generation++;
+
+	g_cond_broadcast (&categories_cache_cond);
+	g_mutex_unlock (&categories_cache_mutex);
+
+	if (child_error != NULL)
+		g_propagate_error (error, child_error);
 
 	return categories;
 }
@@ -26,6 +26,7 @@
 
 #include <gdata/gdata-service.h>
 #include <gdata/gdata-upload-stream.h>
+#include <gdata/gdata-upload-queue.h>
 #include <gdata/services/youtube/gdata-youtube-video.h>
 #include <gdata/app/gdata-app-categories.h>
 
@@ -141,11 +142,18 @@ void gdata_youtube_service_query_related_async (GDataYouTubeService *self, GData
                                                 GDestroyNotify destroy_progress_user_data,
                                                 GAsyncReadyCallback callback, gpointer user_data);
 
+GList *gdata_youtube_service_query_top_videos (GDataYouTubeService *self, GList *queries, guint n_videos, GCompareDataFunc compare_func,
+                                               gpointer compare_user_data, GCancellable *cancellable, GError **error) G_GNUC_WARN_UNUSED_RESULT;
+void gdata_youtube_service_query_top_videos_async (GDataYouTubeService *self, GList *queries, guint n_videos, GCompareDataFunc compare_func,
+                                                   gpointer compare_user_data, GDestroyNotify destroy_compare_user_data,
+                                                   GCancellable *cancellable, GAsyncReadyCallback callback, gpointer user_data);
+
 GDataUploadStream *gdata_youtube_service_upload_video (GDataYouTubeService *self, GDataYouTubeVideo *video, const gchar *slug,
                                                        const gchar *content_type, GCancellable *cancellable,
                                                        GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 GDataYouTubeVideo *gdata_youtube_service_finish_video_upload (GDataYouTubeService *self, GDataUploadStream *upload_stream,
                                                               GError **error) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+GDataUploadQueue *gdata_youtube_service_create_upload_queue (GDataYouTubeService *self) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
 
 const gchar *gdata_youtube_service_get_developer_key (GDataYouTubeService *self) G_GNUC_PURE;
 
@@ -0,0 +1,676 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gdata-youtube-state-poller
+ * @short_description: GData YouTube video processing state poller
+ * @stability: Unstable
+ * @include: gdata/services/youtube/gdata-youtube-state-poller.h
+ *
+ * #GDataYouTubeStatePoller watches the processing state (see gdata_youtube_video_get_state()) of any number of newly uploaded videos until YouTube
+ * has finished processing them. Rather than querying each video individually, the poller gathers all the videos which are due to be polled into
+ * a single batch query of the authenticated user's uploads feed (see #GDataBatchOperation), so polling thousands of videos costs a handful of
+ * requests per poll, rather than thousands.
+ *
+ * Each video is polled on its own schedule. A video whose state hasn't changed since it was last polled is polled half as often as before, up to
+ * #GDataYouTubeStatePoller:max-interval; one whose state has changed, or which has just been added, is polled every
+ * #GDataYouTubeStatePoller:min-interval. Failed queries back off in the same way as unchanged states.
+ *
+ * #GDataYouTubeStatePoller::state-changed is emitted whenever a video's state changes, and #GDataYouTubeStatePoller::finished once a video is no
+ * longer being processed, at which point the poller stops watching it. The poller runs in the thread-default main context of the thread which
+ * created it, and its signals are emitted there.
+ *
+ * <example>
+ *	<title>Waiting for Uploads to be Processed</title>
+ *	<programlisting>
+ *	GDataYouTubeStatePoller *poller;
+ *
+ *	poller = gdata_youtube_state_poller_new (service);
+ *	g_signal_connect (poller, "finished", (GCallback) video_finished_cb, NULL);
+ *
+ *	/<!-- -->* Add each video as its upload finishes *<!-- -->/
+ *	uploaded_video = gdata_youtube_service_finish_video_upload (service, upload_stream, &error);
+ *	gdata_youtube_state_poller_add_video (poller, uploaded_video);
+ *
+ *	static void
+ *	video_finished_cb (GDataYouTubeStatePoller *poller, GDataYouTubeVideo *video, gpointer user_data)
+ *	{
+ *		GDataYouTubeState *state = gdata_youtube_video_get_state (video);
+ *
+ *		if (state == NULL)
+ *			g_message ("Video %s is live.", gdata_youtube_video_get_video_id (video));
+ *		else
+ *			g_message ("Video %s is %s.", gdata_youtube_video_get_video_id (video), gdata_youtube_state_get_name (state));
+ *	}
+ *	</programlisting>
+ * </example>
+ *
+ * Since: 0.15.0
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "gdata-youtube-state-poller.h"
+#include "gdata-youtube-state.h"
+#include "gdata-batchable.h"
+#include "gdata-batch-operation.h"
+
+/* Video states are only visible to the video's owner, through their uploads feed */
+#define UPLOADS_FEED_URI "https://gdata.youtube.com/feeds/api/users/default/uploads"
+#define UPLOADS_BATCH_URI UPLOADS_FEED_URI "/batch"
+
+/* The maximum number of queries YouTube accepts in a single batch request */
+#define MAX_OPERATIONS_PER_REQUEST 50
+
+#define DEFAULT_MIN_INTERVAL 5 /* seconds */
+#define DEFAULT_MAX_INTERVAL 300 /* seconds */
+
+typedef struct {
+	GDataYouTubeVideo *video; /* the most recently retrieved version of the video */
+	guint interval; /* seconds between polls */
+	gint64 next_poll; /* monotonic time of the next poll, in microseconds */
+} PolledVideo;
+
+typedef struct {
+	GDataYouTubeStatePoller *poller; /* owned */
+	GHashTable *operations; /* batch operation ID → video ID (owned) */
+} PollRound;
+
+static void polled_video_free (PolledVideo *polled);
+static void schedule_poll (GDataYouTubeStatePoller *self);
+
+static void gdata_youtube_state_poller_dispose (GObject *object);
+static void gdata_youtube_state_poller_finalize (GObject *object);
+static void gdata_youtube_state_poller_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec);
+static void gdata_youtube_state_poller_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec);
+
+struct _GDataYouTubeStatePollerPrivate {
+	GDataYouTubeService *service;
+	guint min_interval;
+	guint max_interval;
+
+	GHashTable *videos; /* video ID → PolledVideo */
+	GMainContext *context; /* thread-default main context the poller was created in */
+	GSource *timeout_source; /* the next scheduled poll, or NULL */
+	GCancellable *cancellable; /* cancels any poll in progress when the poller is disposed */
+	gboolean is_polling; /* TRUE while a batch query is in progress */
+};
+
+enum {
+	PROP_SERVICE = 1,
+	PROP_MIN_INTERVAL,
+	PROP_MAX_INTERVAL,
+};
+
+enum {
+	SIGNAL_STATE_CHANGED,
+	SIGNAL_FINISHED,
+	LAST_SIGNAL
+};
+
+static guint state_poller_signals[LAST_SIGNAL] = { 0, };
+
+G_DEFINE_TYPE (GDataYouTubeStatePoller, gdata_youtube_state_poller, G_TYPE_OBJECT)
+
+static void
+gdata_youtube_state_poller_class_init (GDataYouTubeStatePollerClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (GDataYouTubeStatePollerPrivate));
+
+	gobject_class->dispose = gdata_youtube_state_poller_dispose;
+	gobject_class->finalize = gdata_youtube_state_poller_finalize;
+	gobject_class->get_property = gdata_youtube_state_poller_get_property;
+	gobject_class->set_property = gdata_youtube_state_poller_set_property;
+
+	/**
+	 * GDataYouTubeStatePoller:service:
+	 *
+	 * The service the videos' states are queried from. It must be authorized as the videos' owner.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_SERVICE,
+	                                 g_param_spec_object ("service",
+	                                                      "Service", "The service the videos' states are queried from.",
+	                                                      GDATA_TYPE_YOUTUBE_SERVICE,
+	                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataYouTubeStatePoller:min-interval:
+	 *
+	 * The interval between polls of a video which has just been added or whose state has just changed, in seconds.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MIN_INTERVAL,
+	                                 g_param_spec_uint ("min-interval",
+	                                                    "Minimum interval", "The interval between polls of a video whose state has just changed.",
+	                                                    1, G_MAXUINT, DEFAULT_MIN_INTERVAL,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataYouTubeStatePoller:max-interval:
+	 *
+	 * The longest interval between polls of a video, in seconds, which the interval backs off to while the video's state doesn't change. If
+	 * this is less than #GDataYouTubeStatePoller:min-interval, videos are always polled every #GDataYouTubeStatePoller:min-interval.
+	 *
+	 * Since: 0.15.0
+	 */
+	g_object_class_install_property (gobject_class, PROP_MAX_INTERVAL,
+	                                 g_param_spec_uint ("max-interval",
+	                                                    "Maximum interval", "The longest interval between polls of a video.",
+	                                                    1, G_MAXUINT, DEFAULT_MAX_INTERVAL,
+	                                                    G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	/**
+	 * GDataYouTubeStatePoller::state-changed:
+	 * @self: the #GDataYouTubeStatePoller
+	 * @video: the newly retrieved version of the video
+	 *
+	 * The #GDataYouTubeStatePoller::state-changed signal is emitted when a poll finds that a video's state (see gdata_youtube_video_get_state())
+	 * has a different name from the last time it was polled.
+	 *
+	 * Since: 0.15.0
+	 */
+	state_poller_signals[SIGNAL_STATE_CHANGED] = g_signal_new ("state-changed",
+	                                                           G_TYPE_FROM_CLASS (klass),
+	                                                           G_SIGNAL_RUN_LAST,
+	                                                           0, NULL, NULL,
+	                                                           g_cclosure_marshal_VOID__OBJECT,
+	                                                           G_TYPE_NONE, 1, GDATA_TYPE_YOUTUBE_VIDEO);
+
+	/**
+	 * GDataYouTubeStatePoller::finished:
+	 * @self: the #GDataYouTubeStatePoller
+	 * @video: the newly retrieved version of the video
+	 *
+	 * The #GDataYouTubeStatePoller::finished signal is emitted when a poll finds that a video is no longer being processed: either it has no
+	 * state (in which case it's live), or its state is something other than <literal>processing</literal>, such as <literal>failed</literal>
+	 * or <literal>rejected</literal>. The poller stops watching the video before emitting this signal.
+	 *
+	 * Since: 0.15.0
+	 */
+	state_poller_signals[SIGNAL_FINISHED] = g_signal_new ("finished",
+	                                                      G_TYPE_FROM_CLASS (klass),
+	                                                      G_SIGNAL_RUN_LAST,
+	                                                      0, NULL, NULL,
+	                                                      g_cclosure_marshal_VOID__OBJECT,
+	                                                      G_TYPE_NONE, 1, GDATA_TYPE_YOUTUBE_VIDEO);
+}
+
+static void
+gdata_youtube_state_poller_init (GDataYouTubeStatePoller *self)
+{
+	self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, GDATA_TYPE_YOUTUBE_STATE_POLLER, GDataYouTubeStatePollerPrivate);
+	self->priv->min_interval = DEFAULT_MIN_INTERVAL;
+	self->priv->max_interval = DEFAULT_MAX_INTERVAL;
+	self->priv->videos = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) polled_video_free);
+	self->priv->context = g_main_context_ref_thread_default ();
+	self->priv->cancellable = g_cancellable_new ();
+}
+
+static void
+gdata_youtube_state_poller_dispose (GObject *object)
+{
+	GDataYouTubeStatePollerPrivate *priv = GDATA_YOUTUBE_STATE_POLLER (object)->priv;
+
+	/* A poll in progress holds a reference to the poller, so this can only happen between polls; but be safe */
+	g_cancellable_cancel (priv->cancellable);
+
+	if (priv->timeout_source != NULL) {
+		g_source_destroy (priv->timeout_source);
+		g_source_unref (priv->timeout_source);
+	}
+	priv->timeout_source = NULL;
+
+	if (priv->service != NULL)
+		g_object_unref (priv->service);
+	priv->service = NULL;
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_youtube_state_poller_parent_class)->dispose (object);
+}
+
+static void
+gdata_youtube_state_poller_finalize (GObject *object)
+{
+	GDataYouTubeStatePollerPrivate *priv = GDATA_YOUTUBE_STATE_POLLER (object)->priv;
+
+	g_hash_table_destroy (priv->videos);
+	g_main_context_unref (priv->context);
+	g_object_unref (priv->cancellable);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (gdata_youtube_state_poller_parent_class)->finalize (object);
+}
+
+static void
+gdata_youtube_state_poller_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GDataYouTubeStatePollerPrivate *priv = GDATA_YOUTUBE_STATE_POLLER (object)->priv;
+
+	switch (property_id) {
+		case PROP_SERVICE:
+			g_value_set_object (value, priv->service);
+			break;
+		case PROP_MIN_INTERVAL:
+			g_value_set_uint (value, priv->min_interval);
+			break;
+		case PROP_MAX_INTERVAL:
+			g_value_set_uint (value, priv->max_interval);
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+static void
+gdata_youtube_state_poller_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GDataYouTubeStatePollerPrivate *priv = GDATA_YOUTUBE_STATE_POLLER (object)->priv;
+
+	switch (property_id) {
+		/* Construct only */
+		case PROP_SERVICE:
+			priv->service = g_value_dup_object (value);
+			break;
+		case PROP_MIN_INTERVAL:
+			gdata_youtube_state_poller_set_min_interval (GDATA_YOUTUBE_STATE_POLLER (object), g_value_get_uint (value));
+			break;
+		case PROP_MAX_INTERVAL:
+			gdata_youtube_state_poller_set_max_interval (GDATA_YOUTUBE_STATE_POLLER (object), g_value_get_uint (value));
+			break;
+		default:
+			/* We don't have any other property... */
+			G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+			break;
+	}
+}
+
+/**
+ * gdata_youtube_state_poller_new:
+ * @service: the #GDataYouTubeService to query, authorized as the owner of the videos to be polled
+ *
+ * Creates a new #GDataYouTubeStatePoller, watching no videos. Polls are scheduled in the thread-default main context of the calling thread.
+ *
+ * Return value: (transfer full): a new #GDataYouTubeStatePoller; unref with g_object_unref()
+ *
+ * Since: 0.15.0
+ */
+GDataYouTubeStatePoller *
+gdata_youtube_state_poller_new (GDataYouTubeService *service)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_SERVICE (service), NULL);
+	return g_object_new (GDATA_TYPE_YOUTUBE_STATE_POLLER, "service", service, NULL);
+}
+
+/**
+ * gdata_youtube_state_poller_get_service:
+ * @self: a #GDataYouTubeStatePoller
+ *
+ * Gets the #GDataYouTubeStatePoller:service property.
+ *
+ * Return value: (transfer none): the service the videos' states are queried from
+ *
+ * Since: 0.15.0
+ */
+GDataYouTubeService *
+gdata_youtube_state_poller_get_service (GDataYouTubeStatePoller *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_STATE_POLLER (self), NULL);
+	return self->priv->service;
+}
+
+/**
+ * gdata_youtube_state_poller_get_min_interval:
+ * @self: a #GDataYouTubeStatePoller
+ *
+ * Gets the #GDataYouTubeStatePoller:min-interval property.
+ *
+ * Return value: the interval between polls of a video whose state has just changed, in seconds
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_youtube_state_poller_get_min_interval (GDataYouTubeStatePoller *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_STATE_POLLER (self), 0);
+	return self->priv->min_interval;
+}
+
+/**
+ * gdata_youtube_state_poller_set_min_interval:
+ * @self: a #GDataYouTubeStatePoller
+ * @min_interval: the interval between polls of a video whose state has just changed, in seconds; must be greater than
+ * <code class="literal">0</code>
+ *
+ * Sets the #GDataYouTubeStatePoller:min-interval property. This takes effect from each video's next poll.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_youtube_state_poller_set_min_interval (GDataYouTubeStatePoller *self, guint min_interval)
+{
+	g_return_if_fail (GDATA_IS_YOUTUBE_STATE_POLLER (self));
+	g_return_if_fail (min_interval > 0);
+
+	self->priv->min_interval = min_interval;
+	g_object_notify (G_OBJECT (self), "min-interval");
+}
+
+/**
+ * gdata_youtube_state_poller_get_max_interval:
+ * @self: a #GDataYouTubeStatePoller
+ *
+ * Gets the #GDataYouTubeStatePoller:max-interval property.
+ *
+ * Return value: the longest interval between polls of a video, in seconds
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_youtube_state_poller_get_max_interval (GDataYouTubeStatePoller *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_STATE_POLLER (self), 0);
+	return self->priv->max_interval;
+}
+
+/**
+ * gdata_youtube_state_poller_set_max_interval:
+ * @self: a #GDataYouTubeStatePoller
+ * @max_interval: the longest interval between polls of a video, in seconds; must be greater than <code class="literal">0</code>
+ *
+ * Sets the #GDataYouTubeStatePoller:max-interval property. This takes effect from each video's next poll.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_youtube_state_poller_set_max_interval (GDataYouTubeStatePoller *self, guint max_interval)
+{
+	g_return_if_fail (GDATA_IS_YOUTUBE_STATE_POLLER (self));
+	g_return_if_fail (max_interval > 0);
+
+	self->priv->max_interval = max_interval;
+	g_object_notify (G_OBJECT (self), "max-interval");
+}
+
+static void
+polled_video_free (PolledVideo *polled)
+{
+	g_object_unref (polled->video);
+	g_slice_free (PolledVideo, polled);
+}
+
+static const gchar *
+get_state_name (GDataYouTubeVideo *video)
+{
+	GDataYouTubeState *state = gdata_youtube_video_get_state (video);
+	return (state != NULL) ? gdata_youtube_state_get_name (state) : NULL;
+}
+
+static gboolean
+is_processing (GDataYouTubeVideo *video)
+{
+	return (g_strcmp0 (get_state_name (video), "processing") == 0) ? TRUE : FALSE;
+}
+
+static void
+poll_round_free (PollRound *round)
+{
+	g_hash_table_destroy (round->operations);
+	g_object_unref (round->poller);
+	g_slice_free (PollRound, round);
+}
+
+static void
+poll_video_cb (guint operation_id, GDataBatchOperationType operation_type, GDataEntry *entry, GError *error, PollRound *round)
+{
+	GDataYouTubeStatePoller *self = round->poller;
+	GDataYouTubeStatePollerPrivate *priv = self->priv;
+	PolledVideo *polled;
+	GDataYouTubeVideo *video;
+	const gchar *video_id;
+	gboolean state_changed;
+
+	video_id = g_hash_table_lookup (round->operations, GUINT_TO_POINTER (operation_id));
+	polled = g_hash_table_lookup (priv->videos, video_id);
+
+	/* The video may have been removed while the poll was in progress */
+	if (polled == NULL || g_cancellable_is_cancelled (priv->cancellable) == TRUE)
+		return;
+
+	if (error != NULL) {
+		/* Back off as if the state hadn't changed, so that a persistent failure doesn't cause a flood of requests */
+		polled->interval = MAX (MIN (polled->interval * 2, priv->max_interval), priv->min_interval);
+		polled->next_poll = g_get_monotonic_time () + (gint64) polled->interval * G_USEC_PER_SEC;
+		return;
+	}
+
+	video = GDATA_YOUTUBE_VIDEO (g_object_ref (entry));
+	state_changed = (g_strcmp0 (get_state_name (polled->video), get_state_name (video)) != 0) ? TRUE : FALSE;
+
+	g_object_unref (polled->video);
+	polled->video = g_object_ref (video);
+
+	if (state_changed == TRUE)
+		polled->interval = priv->min_interval;
+	else
+		polled->interval = MAX (MIN (polled->interval * 2, priv->max_interval), priv->min_interval);
+	polled->next_poll = g_get_monotonic_time () + (gint64) polled->interval * G_USEC_PER_SEC;
+
+	if (state_changed == TRUE)
+		g_signal_emit (self, state_poller_signals[SIGNAL_STATE_CHANGED], 0, video);
+
+	/* Signal handlers may have removed or re-added the video, so look it up again before dropping it */
+	if (is_processing (video) == FALSE) {
+		polled = g_hash_table_lookup (priv->videos, video_id);
+
+		if (polled != NULL && polled->video == video) {
+			g_hash_table_remove (priv->videos, video_id);
+			g_signal_emit (self, state_poller_signals[SIGNAL_FINISHED], 0, video);
+		}
+	}
+
+	g_object_unref (video);
+}
+
+static void
+poll_round_cb (GDataBatchOperation *operation, GAsyncResult *async_result, PollRound *round)
+{
+	GDataYouTubeStatePoller *self = round->poller;
+
+	/* Any errors have already been reported to poll_video_cb() for the individual videos */
+	gdata_batch_operation_run_finish (operation, async_result, NULL);
+
+	self->priv->is_polling = FALSE;
+
+	if (g_cancellable_is_cancelled (self->priv->cancellable) == FALSE)
+		schedule_poll (self);
+
+	poll_round_free (round);
+}
+
+static gboolean
+poll_cb (GDataYouTubeStatePoller *self)
+{
+	GDataYouTubeStatePollerPrivate *priv = self->priv;
+	GDataBatchOperation *operation;
+	PollRound *round;
+	GHashTableIter iter;
+	const gchar *video_id;
+	PolledVideo *polled;
+	gint64 now;
+
+	g_source_unref (priv->timeout_source);
+	priv->timeout_source = NULL;
+
+	operation = gdata_batchable_create_operation (GDATA_BATCHABLE (priv->service), gdata_youtube_service_get_primary_authorization_domain (),
+	                                              UPLOADS_BATCH_URI);
+	gdata_batch_operation_set_max_operations_per_request (operation, MAX_OPERATIONS_PER_REQUEST);
+
+	round = g_slice_new (PollRound);
+	round->poller = g_object_ref (self);
+	round->operations = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+
+	/* Query every video which is due, all in one batch */
+	now = g_get_monotonic_time ();
+	g_hash_table_iter_init (&iter, priv->videos);
+
+	while (g_hash_table_iter_next (&iter, (gpointer*) &video_id, (gpointer*) &polled) == TRUE) {
+		gchar *entry_uri;
+		guint operation_id;
+
+		if (polled->next_poll > now)
+			continue;
+
+		entry_uri = g_strconcat (UPLOADS_FEED_URI "/", video_id, NULL);
+		operation_id = gdata_batch_operation_add_query (operation, entry_uri, GDATA_TYPE_YOUTUBE_VIDEO,
+		                                                (GDataBatchOperationCallback) poll_video_cb, round);
+		g_hash_table_insert (round->operations, GUINT_TO_POINTER (operation_id), g_strdup (video_id));
+		g_free (entry_uri);
+	}
+
+	if (g_hash_table_size (round->operations) == 0) {
+		poll_round_free (round);
+		schedule_poll (self);
+	} else {
+		priv->is_polling = TRUE;
+
+		/* Make sure the callbacks come back to the poller's main context */
+		g_main_context_push_thread_default (priv->context);
+		gdata_batch_operation_run_async (operation, priv->cancellable, (GAsyncReadyCallback) poll_round_cb, round);
+		g_main_context_pop_thread_default (priv->context);
+	}
+
+	g_object_unref (operation);
+
+	return FALSE;
+}
+
+/* (Re)schedules the next poll for whenever the first of the videos is next due. Polls aren't scheduled while one is in progress; the next one is
+ * scheduled once it finishes. */
+static void
+schedule_poll (GDataYouTubeStatePoller *self)
+{
+	GDataYouTubeStatePollerPrivate *priv = self->priv;
+	GHashTableIter iter;
+	PolledVideo *polled;
+	gint64 next_poll = G_MAXINT64, now;
+
+	if (priv->timeout_source != NULL) {
+		g_source_destroy (priv->timeout_source);
+		g_source_unref (priv->timeout_source);
+		priv->timeout_source = NULL;
+	}
+
+	if (priv->is_polling == TRUE || g_hash_table_size (priv->videos) == 0)
+		return;
+
+	g_hash_table_iter_init (&iter, priv->videos);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer*) &polled) == TRUE)
+		next_poll = MIN (next_poll, polled->next_poll);
+
+	now = g_get_monotonic_time ();
+
+	priv->timeout_source = g_timeout_source_new ((next_poll > now) ? (guint) ((next_poll - now + 999) / 1000) : 0);
+	g_source_set_callback (priv->timeout_source, (GSourceFunc) poll_cb, self, NULL);
+	g_source_attach (priv->timeout_source, priv->context);
+}
+
+/**
+ * gdata_youtube_state_poller_add_video:
+ * @self: a #GDataYouTubeStatePoller
+ * @video: the video to watch, such as one returned by gdata_youtube_service_finish_video_upload()
+ *
+ * Starts watching @video's processing state. It's first polled after #GDataYouTubeStatePoller:min-interval, and then on a backing-off schedule
+ * until it's no longer being processed, when #GDataYouTubeStatePoller::finished is emitted. Its current state is taken as the state to compare
+ * the first poll's results against.
+ *
+ * If a video with the same ID is already being watched, it's replaced with @video and its schedule is restarted.
+ *
+ * Since: 0.15.0
+ */
+void
+gdata_youtube_state_poller_add_video (GDataYouTubeStatePoller *self, GDataYouTubeVideo *video)
+{
+	PolledVideo *polled;
+	const gchar *video_id;
+
+	g_return_if_fail (GDATA_IS_YOUTUBE_STATE_POLLER (self));
+	g_return_if_fail (GDATA_IS_YOUTUBE_VIDEO (video));
+
+	video_id = gdata_youtube_video_get_video_id (video);
+	g_return_if_fail (video_id != NULL);
+
+	polled = g_slice_new (PolledVideo);
+	polled->video = g_object_ref (video);
+	polled->interval = self->priv->min_interval;
+	polled->next_poll = g_get_monotonic_time () + (gint64) polled->interval * G_USEC_PER_SEC;
+
+	g_hash_table_replace (self->priv->videos, g_strdup (video_id), polled);
+
+	schedule_poll (self);
+}
+
+/**
+ * gdata_youtube_state_poller_remove_video:
+ * @self: a #GDataYouTubeStatePoller
+ * @video_id: the ID of the video to stop watching, as returned by gdata_youtube_video_get_video_id()
+ *
+ * Stops watching the video with ID @video_id. No more signals will be emitted for it, even if a poll including it is in progress.
+ *
+ * Return value: %TRUE if the video was being watched, %FALSE otherwise
+ *
+ * Since: 0.15.0
+ */
+gboolean
+gdata_youtube_state_poller_remove_video (GDataYouTubeStatePoller *self, const gchar *video_id)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_STATE_POLLER (self), FALSE);
+	g_return_val_if_fail (video_id != NULL, FALSE);
+
+	if (g_hash_table_remove (self->priv->videos, video_id) == FALSE)
+		return FALSE;
+
+	schedule_poll (self);
+
+	return TRUE;
+}
+
+/**
+ * gdata_youtube_state_poller_get_n_pending:
+ * @self: a #GDataYouTubeStatePoller
+ *
+ * Gets the number of videos being watched, which haven't finished processing yet.
+ *
+ * Return value: the number of videos being watched
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_youtube_state_poller_get_n_pending (GDataYouTubeStatePoller *self)
+{
+	g_return_val_if_fail (GDATA_IS_YOUTUBE_STATE_POLLER (self), 0);
+	return g_hash_table_size (self->priv->videos);
+}
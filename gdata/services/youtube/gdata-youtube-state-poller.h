@@ -0,0 +1,80 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GDATA_YOUTUBE_STATE_POLLER_H
+#define GDATA_YOUTUBE_STATE_POLLER_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <gdata/services/youtube/gdata-youtube-service.h>
+#include <gdata/services/youtube/gdata-youtube-video.h>
+
+G_BEGIN_DECLS
+
+#define GDATA_TYPE_YOUTUBE_STATE_POLLER			(gdata_youtube_state_poller_get_type ())
+#define GDATA_YOUTUBE_STATE_POLLER(o)			(G_TYPE_CHECK_INSTANCE_CAST ((o), GDATA_TYPE_YOUTUBE_STATE_POLLER, GDataYouTubeStatePoller))
+#define GDATA_YOUTUBE_STATE_POLLER_CLASS(k)		(G_TYPE_CHECK_CLASS_CAST((k), GDATA_TYPE_YOUTUBE_STATE_POLLER, GDataYouTubeStatePollerClass))
+#define GDATA_IS_YOUTUBE_STATE_POLLER(o)		(G_TYPE_CHECK_INSTANCE_TYPE ((o), GDATA_TYPE_YOUTUBE_STATE_POLLER))
+#define GDATA_IS_YOUTUBE_STATE_POLLER_CLASS(k)		(G_TYPE_CHECK_CLASS_TYPE ((k), GDATA_TYPE_YOUTUBE_STATE_POLLER))
+#define GDATA_YOUTUBE_STATE_POLLER_GET_CLASS(o)		(G_TYPE_INSTANCE_GET_CLASS ((o), GDATA_TYPE_YOUTUBE_STATE_POLLER, GDataYouTubeStatePollerClass))
+
+typedef struct _GDataYouTubeStatePollerPrivate	GDataYouTubeStatePollerPrivate;
+
+/**
+ * GDataYouTubeStatePoller:
+ *
+ * All the fields in the #GDataYouTubeStatePoller structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	GObject parent;
+	GDataYouTubeStatePollerPrivate *priv;
+} GDataYouTubeStatePoller;
+
+/**
+ * GDataYouTubeStatePollerClass:
+ *
+ * All the fields in the #GDataYouTubeStatePollerClass structure are private and should never be accessed directly.
+ *
+ * Since: 0.15.0
+ */
+typedef struct {
+	/*< private >*/
+	GObjectClass parent;
+} GDataYouTubeStatePollerClass;
+
+GType gdata_youtube_state_poller_get_type (void) G_GNUC_CONST;
+
+GDataYouTubeStatePoller *gdata_youtube_state_poller_new (GDataYouTubeService *service) G_GNUC_WARN_UNUSED_RESULT G_GNUC_MALLOC;
+
+GDataYouTubeService *gdata_youtube_state_poller_get_service (GDataYouTubeStatePoller *self) G_GNUC_PURE;
+guint gdata_youtube_state_poller_get_min_interval (GDataYouTubeStatePoller *self) G_GNUC_PURE;
+void gdata_youtube_state_poller_set_min_interval (GDataYouTubeStatePoller *self, guint min_interval);
+guint gdata_youtube_state_poller_get_max_interval (GDataYouTubeStatePoller *self) G_GNUC_PURE;
+void gdata_youtube_state_poller_set_max_interval (GDataYouTubeStatePoller *self, guint max_interval);
+
+void gdata_youtube_state_poller_add_video (GDataYouTubeStatePoller *self, GDataYouTubeVideo *video);
+gboolean gdata_youtube_state_poller_remove_video (GDataYouTubeStatePoller *self, const gchar *video_id);
+guint gdata_youtube_state_poller_get_n_pending (GDataYouTubeStatePoller *self) G_GNUC_PURE;
+
+G_END_DECLS
+
+#endif /* !GDATA_YOUTUBE_STATE_POLLER_H */
@@ -120,6 +120,8 @@ struct _GDataYouTubeVideoPrivate {
 
 	/* media:group */
 	GDataMediaGroup *media_group; /* is actually a GDataYouTubeGroup */
+	xmlDoc *media_group_doc; /* media:group element which hasn't been parsed yet; see GDataQuery:lazy-parsing and get_media_group() */
+	gboolean title_changed_while_deferred; /* whether atom:title was set while media_group_doc was pending */
 
 	/* georss:where */
 	GDataGeoRSSWhere *georss_where;
@@ -517,8 +519,10 @@ gdata_youtube_video_commentable_init (GDataCommentableInterface *iface)
 static void
 notify_title_cb (GDataYouTubeVideo *self, GParamSpec *pspec, gpointer user_data)
 {
-	/* Update our media:group title */
-	if (self->priv->media_group != NULL)
+	/* Update our media:group title; if the group hasn't been parsed yet, get_media_group() will do it once it has */
+	if (self->priv->media_group_doc != NULL)
+		self->priv->title_changed_while_deferred = TRUE;
+	else if (self->priv->media_group != NULL)
 		gdata_media_group_set_title (self->priv->media_group, gdata_entry_get_title (GDATA_ENTRY (self)));
 }
 
@@ -587,14 +591,39 @@ gdata_youtube_video_finalize (GObject *object)
 	g_free (priv->location);
 	g_hash_table_destroy (priv->access_controls);
 
+	if (priv->media_group_doc != NULL)
+		xmlFreeDoc (priv->media_group_doc);
+
 	/* Chain up to the parent class */
 	G_OBJECT_CLASS (gdata_youtube_video_parent_class)->finalize (object);
 }
 
+/* Returns the video's media group, parsing it first if it was deferred when the video was parsed. Everything other than parsing, construction and
+ * destruction must access the media group through this. */
+static GDataMediaGroup *
+get_media_group (GDataYouTubeVideo *self)
+{
+	GDataYouTubeVideoPrivate *priv = self->priv;
+
+	if (priv->media_group_doc != NULL) {
+		_gdata_parsable_parse_deferred_xml (GDATA_PARSABLE (self), &(priv->media_group_doc));
+
+		/* notify_title_cb() couldn't keep the group's title in sync while it was deferred. Only overwrite the parsed media:title if atom:title
+		 * has actually changed since, so an untouched video keeps the media:title it was parsed with, exactly as if it had been parsed eagerly. */
+		if (priv->title_changed_while_deferred == TRUE && priv->media_group != NULL)
+			gdata_media_group_set_title (priv->media_group, gdata_entry_get_title (GDATA_ENTRY (self)));
+
+		priv->title_changed_while_deferred = FALSE;
+	}
+
+	return priv->media_group;
+}
+
 static void
 gdata_youtube_video_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
 {
-	GDataYouTubeVideoPrivate *priv = GDATA_YOUTUBE_VIDEO (object)->priv;
+	GDataYouTubeVideo *self = GDATA_YOUTUBE_VIDEO (object);
+	GDataYouTubeVideoPrivate *priv = self->priv;
 
 	switch (property_id) {
 		case PROP_VIEW_COUNT:
@@ -619,31 +648,31 @@ gdata_youtube_video_get_property (GObject *object, guint property_id, GValue *va
 			g_value_set_double (value, priv->rating.average);
 			break;
 		case PROP_KEYWORDS:
-			g_value_set_boxed (value, gdata_media_group_get_keywords (priv->media_group));
+			g_value_set_boxed (value, gdata_media_group_get_keywords (get_media_group (self)));
 			break;
 		case PROP_PLAYER_URI:
-			g_value_set_string (value, gdata_media_group_get_player_uri (priv->media_group));
+			g_value_set_string (value, gdata_media_group_get_player_uri (get_media_group (self)));
 			break;
 		case PROP_CATEGORY:
-			g_value_set_object (value, gdata_media_group_get_category (priv->media_group));
+			g_value_set_object (value, gdata_media_group_get_category (get_media_group (self)));
 			break;
 		case PROP_CREDIT:
-			g_value_set_object (value, gdata_media_group_get_credit (priv->media_group));
+			g_value_set_object (value, gdata_media_group_get_credit (get_media_group (self)));
 			break;
 		case PROP_DESCRIPTION:
-			g_value_set_string (value, gdata_media_group_get_description (priv->media_group));
+			g_value_set_string (value, gdata_media_group_get_description (get_media_group (self)));
 			break;
 		case PROP_DURATION:
-			g_value_set_uint (value, gdata_youtube_group_get_duration (GDATA_YOUTUBE_GROUP (priv->media_group)));
+			g_value_set_uint (value, gdata_youtube_group_get_duration (GDATA_YOUTUBE_GROUP (get_media_group (self))));
 			break;
 		case PROP_IS_PRIVATE:
-			g_value_set_boolean (value, gdata_youtube_group_is_private (GDATA_YOUTUBE_GROUP (priv->media_group)));
+			g_value_set_boolean (value, gdata_youtube_group_is_private (GDATA_YOUTUBE_GROUP (get_media_group (self))));
 			break;
 		case PROP_UPLOADED:
-			g_value_set_int64 (value, gdata_youtube_group_get_uploaded (GDATA_YOUTUBE_GROUP (priv->media_group)));
+			g_value_set_int64 (value, gdata_youtube_group_get_uploaded (GDATA_YOUTUBE_GROUP (get_media_group (self))));
 			break;
 		case PROP_VIDEO_ID:
-			g_value_set_string (value, gdata_youtube_group_get_video_id (GDATA_YOUTUBE_GROUP (priv->media_group)));
+			g_value_set_string (value, gdata_youtube_group_get_video_id (GDATA_YOUTUBE_GROUP (get_media_group (self))));
 			break;
 		case PROP_IS_DRAFT:
 			g_value_set_boolean (value, gdata_youtube_control_is_draft (priv->youtube_control));
@@ -655,7 +684,7 @@ gdata_youtube_video_get_property (GObject *object, guint property_id, GValue *va
 			g_value_set_int64 (value, priv->recorded);
 			break;
 		case PROP_ASPECT_RATIO:
-			g_value_set_string (value, gdata_youtube_group_get_aspect_ratio (GDATA_YOUTUBE_GROUP (priv->media_group)));
+			g_value_set_string (value, gdata_youtube_group_get_aspect_ratio (GDATA_YOUTUBE_GROUP (get_media_group (self))));
 			break;
 		case PROP_LATITUDE:
 			g_value_set_double (value, gdata_georss_where_get_latitude (priv->georss_where));
@@ -721,9 +750,15 @@ parse_xml (GDataParsable *parsable, xmlDoc *doc, xmlNode *node, gpointer user_da
 	gboolean success;
 	GDataYouTubeVideo *self = GDATA_YOUTUBE_VIDEO (parsable);
 
-	if (gdata_parser_is_namespace (node, "http://search.yahoo.com/mrss/") == TRUE &&
-	    gdata_parser_object_from_element (node, "group", P_REQUIRED | P_NO_DUPES, GDATA_TYPE_YOUTUBE_GROUP,
-	                                      &(self->priv->media_group), &success, error) == TRUE) {
+	if (gdata_parser_is_namespace (node, "http://search.yahoo.com/mrss/") == TRUE && xmlStrcmp (node->name, (xmlChar*) "group") == 0 &&
+	    _gdata_parsable_is_deferring_xml (doc) == TRUE) {
+		/* media:group holds most of the video's metadata, but much of it (like the thumbnails and content) isn't needed for listing
+		 * videos, so leave it until it's first accessed */
+		_gdata_parsable_defer_xml (&(self->priv->media_group_doc), doc, node);
+		return TRUE;
+	} else if (gdata_parser_is_namespace (node, "http://search.yahoo.com/mrss/") == TRUE &&
+	           gdata_parser_object_from_element (node, "group", P_REQUIRED | P_NO_DUPES, GDATA_TYPE_YOUTUBE_GROUP,
+	                                             &(self->priv->media_group), &success, error) == TRUE) {
 		return success;
 	} else if (gdata_parser_is_namespace (node, "http://www.w3.org/2007/app") == TRUE &&
 	           gdata_parser_object_from_element (node, "control", P_REQUIRED | P_NO_DUPES, GDATA_TYPE_YOUTUBE_CONTROL,
@@ -873,6 +908,9 @@ post_parse_xml (GDataParsable *parsable, gpointer user_data, GError **error)
 	if (priv->youtube_control == NULL)
 		priv->youtube_control = g_object_new (GDATA_TYPE_YOUTUBE_CONTROL, NULL);
 
+	/* atom:title may have been parsed after media:group was deferred; that isn't a change the group needs to pick up */
+	priv->title_changed_while_deferred = FALSE;
+
 	return TRUE;
 }
 
@@ -909,7 +947,7 @@ get_xml (GDataParsable *parsable, GString *xml_string)
 	GDATA_PARSABLE_CLASS (gdata_youtube_video_parent_class)->get_xml (parsable, xml_string);
 
 	/* media:group */
-	_gdata_parsable_get_xml (GDATA_PARSABLE (priv->media_group), xml_string, FALSE);
+	_gdata_parsable_get_xml (GDATA_PARSABLE (get_media_group (GDATA_YOUTUBE_VIDEO (parsable))), xml_string, FALSE);
 
 	if (priv->location != NULL)
 		gdata_parser_string_append_escaped (xml_string, "<yt:location>", priv->location, "</yt:location>");
@@ -944,6 +982,7 @@ get_namespaces (GDataParsable *parsable, GHashTable *namespaces)
 	g_hash_table_insert (namespaces, (gchar*) "yt", (gchar*) "http://gdata.youtube.com/schemas/2007");
 
 	/* Add the media:group, app:control and georss:where namespaces */
+	get_media_group (GDATA_YOUTUBE_VIDEO (parsable));
 	GDATA_PARSABLE_GET_CLASS (priv->media_group)->get_namespaces (GDATA_PARSABLE (priv->media_group), namespaces);
 	GDATA_PARSABLE_GET_CLASS (priv->youtube_control)->get_namespaces (GDATA_PARSABLE (priv->youtube_control), namespaces);
 	GDATA_PARSABLE_GET_CLASS (priv->georss_where)->get_namespaces (GDATA_PARSABLE (priv->georss_where), namespaces);
@@ -1177,7 +1216,7 @@ const gchar * const *
 gdata_youtube_video_get_keywords (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
-	return gdata_media_group_get_keywords (self->priv->media_group);
+	return gdata_media_group_get_keywords (get_media_group (self));
 }
 
 /**
@@ -1196,7 +1235,7 @@ gdata_youtube_video_set_keywords (GDataYouTubeVideo *self, const gchar * const *
 	g_return_if_fail (GDATA_IS_YOUTUBE_VIDEO (self));
 	g_return_if_fail (keywords != NULL);
 
-	gdata_media_group_set_keywords (self->priv->media_group, keywords);
+	gdata_media_group_set_keywords (get_media_group (self), keywords);
 	g_object_notify (G_OBJECT (self), "keywords");
 }
 
@@ -1212,7 +1251,7 @@ const gchar *
 gdata_youtube_video_get_player_uri (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
-	return gdata_media_group_get_player_uri (self->priv->media_group);
+	return gdata_media_group_get_player_uri (get_media_group (self));
 }
 
 /**
@@ -1233,7 +1272,7 @@ gdata_youtube_video_is_restricted_in_country (GDataYouTubeVideo *self, const gch
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), FALSE);
 	g_return_val_if_fail (country != NULL && *country != '\0', FALSE);
 
-	return gdata_media_group_is_restricted_in_country (self->priv->media_group, country);
+	return gdata_media_group_is_restricted_in_country (get_media_group (self), country);
 }
 
 /**
@@ -1260,7 +1299,7 @@ gdata_youtube_video_get_media_rating (GDataYouTubeVideo *self, const gchar *rati
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
 	g_return_val_if_fail (rating_type != NULL && *rating_type != '\0', NULL);
 
-	return gdata_media_group_get_media_rating (self->priv->media_group, rating_type);
+	return gdata_media_group_get_media_rating (get_media_group (self), rating_type);
 }
 
 /**
@@ -1275,7 +1314,7 @@ GDataMediaCategory *
 gdata_youtube_video_get_category (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
-	return gdata_media_group_get_category (self->priv->media_group);
+	return gdata_media_group_get_category (get_media_group (self));
 }
 
 /**
@@ -1294,7 +1333,7 @@ gdata_youtube_video_set_category (GDataYouTubeVideo *self, GDataMediaCategory *c
 	g_return_if_fail (GDATA_IS_YOUTUBE_VIDEO (self));
 	g_return_if_fail (GDATA_IS_MEDIA_CATEGORY (category));
 
-	gdata_media_group_set_category (self->priv->media_group, category);
+	gdata_media_group_set_category (get_media_group (self), category);
 	g_object_notify (G_OBJECT (self), "category");
 }
 
@@ -1310,7 +1349,7 @@ GDataYouTubeCredit *
 gdata_youtube_video_get_credit (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
-	return GDATA_YOUTUBE_CREDIT (gdata_media_group_get_credit (self->priv->media_group));
+	return GDATA_YOUTUBE_CREDIT (gdata_media_group_get_credit (get_media_group (self)));
 }
 
 /**
@@ -1325,7 +1364,7 @@ const gchar *
 gdata_youtube_video_get_description (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
-	return gdata_media_group_get_description (self->priv->media_group);
+	return gdata_media_group_get_description (get_media_group (self));
 }
 
 /**
@@ -1342,7 +1381,7 @@ gdata_youtube_video_set_description (GDataYouTubeVideo *self, const gchar *descr
 {
 	g_return_if_fail (GDATA_IS_YOUTUBE_VIDEO (self));
 
-	gdata_media_group_set_description (self->priv->media_group, description);
+	gdata_media_group_set_description (get_media_group (self), description);
 	g_object_notify (G_OBJECT (self), "description");
 }
 
@@ -1362,7 +1401,7 @@ gdata_youtube_video_look_up_content (GDataYouTubeVideo *self, const gchar *type)
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
 	g_return_val_if_fail (type != NULL, NULL);
 
-	return GDATA_YOUTUBE_CONTENT (gdata_media_group_look_up_content (self->priv->media_group, type));
+	return GDATA_YOUTUBE_CONTENT (gdata_media_group_look_up_content (get_media_group (self), type));
 }
 
 /**
@@ -1377,7 +1416,7 @@ GList *
 gdata_youtube_video_get_thumbnails (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
-	return gdata_media_group_get_thumbnails (self->priv->media_group);
+	return gdata_media_group_get_thumbnails (get_media_group (self));
 }
 
 /**
@@ -1392,7 +1431,7 @@ guint
 gdata_youtube_video_get_duration (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), 0);
-	return gdata_youtube_group_get_duration (GDATA_YOUTUBE_GROUP (self->priv->media_group));
+	return gdata_youtube_group_get_duration (GDATA_YOUTUBE_GROUP (get_media_group (self)));
 }
 
 /**
@@ -1407,7 +1446,7 @@ gboolean
 gdata_youtube_video_is_private (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), FALSE);
-	return gdata_youtube_group_is_private (GDATA_YOUTUBE_GROUP (self->priv->media_group));
+	return gdata_youtube_group_is_private (GDATA_YOUTUBE_GROUP (get_media_group (self)));
 }
 
 /**
@@ -1421,7 +1460,7 @@ void
 gdata_youtube_video_set_is_private (GDataYouTubeVideo *self, gboolean is_private)
 {
 	g_return_if_fail (GDATA_IS_YOUTUBE_VIDEO (self));
-	gdata_youtube_group_set_is_private (GDATA_YOUTUBE_GROUP (self->priv->media_group), is_private);
+	gdata_youtube_group_set_is_private (GDATA_YOUTUBE_GROUP (get_media_group (self)), is_private);
 	g_object_notify (G_OBJECT (self), "is-private");
 }
 
@@ -1437,7 +1476,7 @@ gint64
 gdata_youtube_video_get_uploaded (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), -1);
-	return gdata_youtube_group_get_uploaded (GDATA_YOUTUBE_GROUP (self->priv->media_group));
+	return gdata_youtube_group_get_uploaded (GDATA_YOUTUBE_GROUP (get_media_group (self)));
 }
 
 /**
@@ -1452,7 +1491,7 @@ const gchar *
 gdata_youtube_video_get_video_id (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
-	return gdata_youtube_group_get_video_id (GDATA_YOUTUBE_GROUP (self->priv->media_group));
+	return gdata_youtube_group_get_video_id (GDATA_YOUTUBE_GROUP (get_media_group (self)));
 }
 
 /**
@@ -1622,7 +1661,7 @@ const gchar *
 gdata_youtube_video_get_aspect_ratio (GDataYouTubeVideo *self)
 {
 	g_return_val_if_fail (GDATA_IS_YOUTUBE_VIDEO (self), NULL);
-	return gdata_youtube_group_get_aspect_ratio (GDATA_YOUTUBE_GROUP (self->priv->media_group));
+	return gdata_youtube_group_get_aspect_ratio (GDATA_YOUTUBE_GROUP (get_media_group (self)));
 }
 
 /**
@@ -1639,7 +1678,7 @@ void
 gdata_youtube_video_set_aspect_ratio (GDataYouTubeVideo *self, const gchar *aspect_ratio)
 {
 	g_return_if_fail (GDATA_IS_YOUTUBE_VIDEO (self));
-	gdata_youtube_group_set_aspect_ratio (GDATA_YOUTUBE_GROUP (self->priv->media_group), aspect_ratio);
+	gdata_youtube_group_set_aspect_ratio (GDATA_YOUTUBE_GROUP (get_media_group (self)), aspect_ratio);
 	g_object_notify (G_OBJECT (self), "aspect-ratio");
 }
 
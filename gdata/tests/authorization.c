@@ -292,6 +292,41 @@ complex_authorizer_refresh_authorization_finish (GDataAuthorizer *self, GAsyncRe
 	return (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == FALSE) ? TRUE : FALSE;
 }
 
+static void
+complex_authorizer_process_request_async (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message, GCancellable *cancellable,
+                                          GAsyncReadyCallback callback, gpointer user_data)
+{
+	GSimpleAsyncResult *result;
+
+	/* Check the inputs */
+	g_assert (GDATA_IS_AUTHORIZER (self));
+	g_assert (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+	result = g_simple_async_result_new (G_OBJECT (self), callback, user_data, complex_authorizer_process_request_async);
+
+	/* Increment the process counter on the authorizer so we know if this function's been called more than once */
+	g_object_set_data (G_OBJECT (self), "process-counter",
+	                   GUINT_TO_POINTER (GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (self), "process-counter")) + 1));
+
+	simple_authorizer_process_request (self, domain, message);
+
+	g_simple_async_result_complete_in_idle (result);
+	g_object_unref (result);
+}
+
+static gboolean
+complex_authorizer_process_request_finish (GDataAuthorizer *self, GAsyncResult *async_result, GError **error)
+{
+	/* Check the inputs */
+	g_assert (GDATA_IS_AUTHORIZER (self));
+	g_assert (G_IS_ASYNC_RESULT (async_result));
+	g_assert (error == NULL || *error == NULL);
+
+	g_assert (g_simple_async_result_is_valid (async_result, G_OBJECT (self), complex_authorizer_process_request_async) == TRUE);
+
+	return (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (async_result), error) == FALSE) ? TRUE : FALSE;
+}
+
 static void
 complex_authorizer_authorizer_init (GDataAuthorizerInterface *iface)
 {
@@ -304,6 +339,10 @@ complex_authorizer_authorizer_init (GDataAuthorizerInterface *iface)
 	/* Unlike NormalAuthorizer, also implement the async versions of refresh_authorization(). */
 	iface->refresh_authorization_async = complex_authorizer_refresh_authorization_async;
 	iface->refresh_authorization_finish = complex_authorizer_refresh_authorization_finish;
+
+	/* …and the async version of process_request(). */
+	iface->process_request_async = complex_authorizer_process_request_async;
+	iface->process_request_finish = complex_authorizer_process_request_finish;
 }
 
 /* Testing data for generic GDataAuthorizer interface tests */
@@ -365,6 +404,100 @@ test_authorizer_process_request_null (AuthorizerData *data, gconstpointer user_d
 	g_object_unref (message);
 }
 
+static void
+test_authorizer_process_request_async_success_cb (GDataAuthorizer *authorizer, GAsyncResult *async_result, GMainLoop *main_loop)
+{
+	GError *error = NULL;
+
+	g_assert (gdata_authorizer_process_request_finish (authorizer, async_result, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_main_loop_quit (main_loop);
+}
+
+static void
+test_authorizer_process_request_async_cancelled_cb (GDataAuthorizer *authorizer, GAsyncResult *async_result, GMainLoop *main_loop)
+{
+	GError *error = NULL;
+
+	g_assert (gdata_authorizer_process_request_finish (authorizer, async_result, &error) == FALSE);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_clear_error (&error);
+
+	g_main_loop_quit (main_loop);
+}
+
+/* Test that calling gdata_authorizer_process_request_async() on an authorizer which implements it happens correctly */
+static void
+test_authorizer_process_request_async (AuthorizerData *data, gconstpointer user_data)
+{
+	SoupMessage *message;
+	GMainLoop *main_loop;
+
+	g_object_set_data (G_OBJECT (data->authorizer), "process-counter", GUINT_TO_POINTER (0));
+
+	main_loop = g_main_loop_new (NULL, FALSE);
+	message = soup_message_new (SOUP_METHOD_GET, "http://example.com/");
+
+	gdata_authorizer_process_request_async (data->authorizer, test_domain1, message, NULL,
+	                                        (GAsyncReadyCallback) test_authorizer_process_request_async_success_cb, main_loop);
+
+	g_main_loop_run (main_loop);
+
+	g_assert_cmpuint (GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (data->authorizer), "process-counter")), ==, 1);
+	g_assert_cmpstr (soup_message_headers_get_one (message->request_headers, "process_request"), ==, "1");
+
+	g_object_unref (message);
+	g_main_loop_unref (main_loop);
+}
+
+/* Test that calling gdata_authorizer_process_request_async() on an authorizer which doesn't implement it falls back to process_request() */
+static void
+test_authorizer_process_request_async_simulated (AuthorizerData *data, gconstpointer user_data)
+{
+	SoupMessage *message;
+	GMainLoop *main_loop;
+
+	main_loop = g_main_loop_new (NULL, FALSE);
+	message = soup_message_new (SOUP_METHOD_GET, "http://example.com/");
+
+	gdata_authorizer_process_request_async (data->authorizer, test_domain1, message, NULL,
+	                                        (GAsyncReadyCallback) test_authorizer_process_request_async_success_cb, main_loop);
+
+	g_main_loop_run (main_loop);
+
+	g_assert_cmpstr (soup_message_headers_get_one (message->request_headers, "process_request"), ==, "1");
+
+	g_object_unref (message);
+	g_main_loop_unref (main_loop);
+}
+
+/* Test that cancelling gdata_authorizer_process_request_async() on an authorizer which doesn't implement it leaves the message unprocessed */
+static void
+test_authorizer_process_request_async_cancellation_simulated (AuthorizerData *data, gconstpointer user_data)
+{
+	SoupMessage *message;
+	GCancellable *cancellable;
+	GMainLoop *main_loop;
+
+	main_loop = g_main_loop_new (NULL, FALSE);
+	message = soup_message_new (SOUP_METHOD_GET, "http://example.com/");
+
+	cancellable = g_cancellable_new ();
+	g_cancellable_cancel (cancellable);
+
+	gdata_authorizer_process_request_async (data->authorizer, test_domain1, message, cancellable,
+	                                        (GAsyncReadyCallback) test_authorizer_process_request_async_cancelled_cb, main_loop);
+
+	g_main_loop_run (main_loop);
+
+	g_assert (soup_message_headers_get_one (message->request_headers, "process_request") == NULL);
+
+	g_object_unref (cancellable);
+	g_object_unref (message);
+	g_main_loop_unref (main_loop);
+}
+
 /* Test that calling gdata_authorizer_is_authorized_for_domain() happens correctly */
 static void
 test_authorizer_is_authorized_for_domain (AuthorizerData *data, gconstpointer user_data)
@@ -692,6 +825,64 @@ test_authorizer_refresh_authorization_async_cancellation_simulated (AuthorizerDa
 	g_main_loop_unref (main_loop);
 }
 
+typedef struct {
+	GMainLoop *main_loop;
+	guint outstanding;
+} CoalescedData;
+
+static void
+test_authorizer_refresh_authorization_async_coalesced_cb (GDataAuthorizer *authorizer, GAsyncResult *async_result, CoalescedData *data)
+{
+	gboolean success;
+	GError *error = NULL;
+
+	success = gdata_authorizer_refresh_authorization_finish (authorizer, async_result, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+	g_clear_error (&error);
+
+	if (--data->outstanding == 0)
+		g_main_loop_quit (data->main_loop);
+}
+
+/* Test that several calls to refresh_authorization_async() made while a refresh is in progress are coalesced into a single call to the
+ * implementation, and all get its result */
+static void
+test_authorizer_refresh_authorization_async_coalesced (AuthorizerData *data, gconstpointer user_data)
+{
+	CoalescedData coalesced_data;
+	guint i;
+
+	/* Set a counter on the authoriser to check that the interface implementation is only called once */
+	g_object_set_data (G_OBJECT (data->authorizer), "counter", GUINT_TO_POINTER (0));
+
+	coalesced_data.main_loop = g_main_loop_new (NULL, FALSE);
+	coalesced_data.outstanding = 5;
+
+	/* The first call starts the refresh in a thread; since none of the callbacks can be called until we run the main loop, the rest are
+	 * guaranteed to be made while it's still in progress. */
+	for (i = 0; i < coalesced_data.outstanding; i++) {
+		gdata_authorizer_refresh_authorization_async (data->authorizer, NULL,
+		                                              (GAsyncReadyCallback) test_authorizer_refresh_authorization_async_coalesced_cb,
+		                                              &coalesced_data);
+	}
+
+	g_main_loop_run (coalesced_data.main_loop);
+
+	g_assert_cmpuint (GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (data->authorizer), "counter")), ==, 1);
+
+	/* Once the refresh has finished, another call should result in another refresh */
+	coalesced_data.outstanding = 1;
+	gdata_authorizer_refresh_authorization_async (data->authorizer, NULL,
+	                                              (GAsyncReadyCallback) test_authorizer_refresh_authorization_async_coalesced_cb,
+	                                              &coalesced_data);
+	g_main_loop_run (coalesced_data.main_loop);
+
+	g_assert_cmpuint (GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (data->authorizer), "counter")), ==, 2);
+
+	g_main_loop_unref (coalesced_data.main_loop);
+}
+
 /* Test that calling refresh_authorization_async() on an authorizer which doesn't implement it returns FALSE without an error */
 static void
 test_authorizer_refresh_authorization_async_unimplemented (AuthorizerData *data, gconstpointer user_data)
@@ -757,6 +948,12 @@ main (int argc, char *argv[])
 	            tear_down_authorizer_data);
 	g_test_add ("/authorizer/process-request/null", AuthorizerData, NULL, set_up_simple_authorizer_data, test_authorizer_process_request_null,
 	            tear_down_authorizer_data);
+	g_test_add ("/authorizer/process-request/async", AuthorizerData, NULL, set_up_complex_authorizer_data,
+	            test_authorizer_process_request_async, tear_down_authorizer_data);
+	g_test_add ("/authorizer/process-request/async/simulated", AuthorizerData, NULL, set_up_simple_authorizer_data,
+	            test_authorizer_process_request_async_simulated, tear_down_authorizer_data);
+	g_test_add ("/authorizer/process-request/async/cancellation/simulated", AuthorizerData, NULL, set_up_simple_authorizer_data,
+	            test_authorizer_process_request_async_cancellation_simulated, tear_down_authorizer_data);
 	g_test_add ("/authorizer/is-authorized-for-domain", AuthorizerData, NULL, set_up_simple_authorizer_data,
 	            test_authorizer_is_authorized_for_domain, tear_down_authorizer_data);
 	g_test_add ("/authorizer/is-authorized-for-domain/null", AuthorizerData, NULL, set_up_simple_authorizer_data,
@@ -781,6 +978,8 @@ main (int argc, char *argv[])
 	            test_authorizer_refresh_authorization_async_error_simulated, tear_down_authorizer_data);
 	g_test_add ("/authorizer/refresh-authorization/async/cancellation/simulated", AuthorizerData, NULL, set_up_normal_authorizer_data,
 	            test_authorizer_refresh_authorization_async_cancellation_simulated, tear_down_authorizer_data);
+	g_test_add ("/authorizer/refresh-authorization/async/coalesced", AuthorizerData, NULL, set_up_normal_authorizer_data,
+	            test_authorizer_refresh_authorization_async_coalesced, tear_down_authorizer_data);
 	g_test_add ("/authorizer/refresh-authorization/async/unimplemented", AuthorizerData, NULL, set_up_simple_authorizer_data,
 	            test_authorizer_refresh_authorization_async_unimplemented, tear_down_authorizer_data);
 	g_test_add ("/authorizer/refresh-authorization/async/cancellation/unimplemented", AuthorizerData, NULL, set_up_simple_authorizer_data,
@@ -713,79 +713,439 @@ test_event_xml_dates (void)
 	g_object_unref (event);
 }
 
+static const gchar *recurrence_event_xml =
+	"<entry xmlns='http://www.w3.org/2005/Atom' "
+	       "xmlns:gd='http://schemas.google.com/g/2005' "
+	       "xmlns:gCal='http://schemas.google.com/gCal/2005' "
+	       "xmlns:app='http://www.w3.org/2007/app'>"
+		"<id>http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/events/g5928e82rrch95b25f8ud0dlsg_20090429T153000Z</id>"
+		"<published>2009-04-25T15:22:47.000Z</published>"
+		"<updated>2009-04-27T17:54:10.000Z</updated>"
+		"<app:edited xmlns:app='http://www.w3.org/2007/app'>2009-04-27T17:54:10.000Z</app:edited>"
+		"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/g/2005#event'/>"
+		"<title>Test daily instance event</title>"
+		"<content></content>"
+		"<link rel='http://www.iana.org/assignments/relation/alternate' type='text/html' "
+		      "href='http://www.google.com/calendar/event?"
+		            "eid=ZzU5MjhlODJycmNoOTViMjVmOHVkMGRsc2dfMjAwOTA0MjlUMTUzMDAwWiBsaWJnZGF0YS50ZXN0QGdvb2dsZW1haWwuY29t' "
+		      "title='alternate'/>"
+		"<link rel='http://www.iana.org/assignments/relation/self' type='application/atom+xml' "
+		      "href='http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/"
+		            "g5928e82rrch95b25f8ud0dlsg_20090429T153000Z'/>"
+		"<link rel='http://www.iana.org/assignments/relation/edit' type='application/atom+xml' "
+		      "href='http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/"
+		            "g5928e82rrch95b25f8ud0dlsg_20090429T153000Z'/>"
+		"<author>"
+			"<name>GData Test</name>"
+			"<email>libgdata.test@googlemail.com</email>"
+		"</author>"
+		"<gd:originalEvent id='g5928e82rrch95b25f8ud0dlsg' "
+		                  "href='http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/"
+		                        "g5928e82rrch95b25f8ud0dlsg'>"
+			"<gd:when startTime='2009-04-29T16:30:00.000+01:00'/>"
+		"</gd:originalEvent>"
+		"<gCal:guestsCanModify value='false'/>"
+		"<gCal:guestsCanInviteOthers value='false'/>"
+		"<gCal:guestsCanSeeGuests value='false'/>"
+		"<gCal:anyoneCanAddSelf value='false'/>"
+		"<gd:comments>"
+			"<gd:feedLink href='http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/"
+			                   "g5928e82rrch95b25f8ud0dlsg_20090429T153000Z/comments'/>"
+		"</gd:comments>"
+		"<gd:eventStatus value='http://schemas.google.com/g/2005#event.confirmed'/>"
+		"<gd:visibility value='http://schemas.google.com/g/2005#event.private'/>"
+		"<gd:transparency value='http://schemas.google.com/g/2005#event.opaque'/>"
+		"<gCal:uid value='g5928e82rrch95b25f8ud0dlsg@google.com'/>"
+		"<gCal:sequence value='0'/>"
+		"<gd:when startTime='2009-04-29T17:30:00.000+01:00' endTime='2009-04-29T17:30:00.000+01:00'>"
+			"<gd:reminder minutes='10' method='email'/>"
+			"<gd:reminder minutes='10' method='alert'/>"
+		"</gd:when>"
+		"<gd:who rel='http://schemas.google.com/g/2005#event.organizer' valueString='GData Test' "
+		        "email='libgdata.test@googlemail.com'/>"
+		"<gd:where valueString=''/>"
+	"</entry>";
+
+static void
+check_recurrence_event (GDataCalendarEvent *event)
+{
+	gchar *id, *uri;
+
+	/* Check the original event */
+	g_assert (gdata_calendar_event_is_exception (event) == TRUE);
+
+	gdata_calendar_event_get_original_event_details (event, &id, &uri);
+	g_assert_cmpstr (id, ==, "g5928e82rrch95b25f8ud0dlsg");
+	g_assert_cmpstr (uri, ==, "http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/g5928e82rrch95b25f8ud0dlsg");
+
+	g_free (id);
+	g_free (uri);
+}
+
+static void
+check_recurrence_event_people (GDataCalendarEvent *event)
+{
+	GList *people;
+	GDataGDWho *who;
+
+	people = gdata_calendar_event_get_people (event);
+	g_assert_cmpuint (g_list_length (people), ==, 1);
+
+	who = GDATA_GD_WHO (people->data);
+	g_assert_cmpstr (gdata_gd_who_get_relation_type (who), ==, GDATA_GD_WHO_EVENT_ORGANIZER);
+	g_assert_cmpstr (gdata_gd_who_get_value_string (who), ==, "GData Test");
+	g_assert_cmpstr (gdata_gd_who_get_email_address (who), ==, "libgdata.test@googlemail.com");
+}
+
 static void
 test_event_xml_recurrence (void)
 {
 	GDataCalendarEvent *event;
 	GError *error = NULL;
-	gchar *id, *uri;
 
-	event = GDATA_CALENDAR_EVENT (gdata_parsable_new_from_xml (GDATA_TYPE_CALENDAR_EVENT,
-		"<entry xmlns='http://www.w3.org/2005/Atom' "
-		       "xmlns:gd='http://schemas.google.com/g/2005' "
-		       "xmlns:gCal='http://schemas.google.com/gCal/2005' "
-		       "xmlns:app='http://www.w3.org/2007/app'>"
-			"<id>http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/events/g5928e82rrch95b25f8ud0dlsg_20090429T153000Z</id>"
-			"<published>2009-04-25T15:22:47.000Z</published>"
+	event = GDATA_CALENDAR_EVENT (gdata_parsable_new_from_xml (GDATA_TYPE_CALENDAR_EVENT, recurrence_event_xml, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (event));
+	g_clear_error (&error);
+
+	check_recurrence_event (event);
+	check_recurrence_event_people (event);
+
+	g_object_unref (event);
+}
+
+static void
+test_event_xml_recurrence_lazy (void)
+{
+	GDataCalendarEvent *eager_event, *lazy_event;
+	gchar *eager_xml, *lazy_xml;
+	guint n_people;
+	GError *error = NULL;
+
+	/* The mock server is driven directly, so there's nothing to check against online */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping lazy parsing test when online or logging.");
+		return;
+	}
+
+	gdata_parsable_set_accounting_enabled (TRUE);
+
+	eager_event = GDATA_CALENDAR_EVENT (gdata_parsable_new_from_xml (GDATA_TYPE_CALENDAR_EVENT, recurrence_event_xml, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_CALENDAR_EVENT (eager_event));
+
+	/* Parsing lazily shouldn't create a GDataGDWho for the organiser… */
+	n_people = gdata_test_count_parsables (GDATA_TYPE_GD_WHO);
+	lazy_event = GDATA_CALENDAR_EVENT (gdata_test_parse_entry_lazily (mock_server, GDATA_TYPE_CALENDAR_EVENT, recurrence_event_xml));
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_GD_WHO), ==, n_people);
+
+	/* …and nor should reading the rest of the event */
+	check_recurrence_event (lazy_event);
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_GD_WHO), ==, n_people);
+
+	/* Serialising an untouched lazy event has to produce the same XML as an eager one */
+	eager_xml = gdata_parsable_get_xml (GDATA_PARSABLE (eager_event));
+	lazy_xml = gdata_parsable_get_xml (GDATA_PARSABLE (lazy_event));
+	g_assert_cmpstr (lazy_xml, ==, eager_xml);
+	g_free (lazy_xml);
+	g_free (eager_xml);
+
+	g_object_unref (lazy_event);
+
+	/* Asking for the people parses them, once */
+	lazy_event = GDATA_CALENDAR_EVENT (gdata_test_parse_entry_lazily (mock_server, GDATA_TYPE_CALENDAR_EVENT, recurrence_event_xml));
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_GD_WHO), ==, n_people);
+
+	check_recurrence_event_people (lazy_event);
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_GD_WHO), ==, n_people + 1);
+	check_recurrence_event_people (lazy_event);
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_GD_WHO), ==, n_people + 1);
+
+	g_object_unref (lazy_event);
+	g_object_unref (eager_event);
+
+	gdata_parsable_set_accounting_enabled (FALSE);
+}
+
+static void
+expander_instance_cb (GDataCalendarEvent *event, gint64 start_time, gint64 end_time, gboolean is_date, gpointer user_data)
+{
+	GArray *instances = user_data;
+
+	g_assert (GDATA_IS_CALENDAR_EVENT (event));
+	g_assert_cmpint (end_time, >=, start_time);
+
+	/* Record the start time, negated for all-day instances */
+	start_time = (is_date == TRUE) ? -start_time : start_time;
+	g_array_append_val (instances, start_time);
+}
+
+static void
+test_event_expander (void)
+{
+	GDataCalendarEventExpander *expander;
+	GDataCalendarEvent *event, *exception;
+	GArray *instances;
+	GError *error = NULL;
+
+	expander = gdata_calendar_event_expander_new ();
+	instances = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+	/* A weekly event on Mondays and Wednesdays, starting on a Wednesday, with one instance excluded */
+	event = gdata_calendar_event_new ("http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/events/g5928e82rrch95b25f8ud0dlsg");
+	gdata_calendar_event_set_recurrence (event,
+	                                     "DTSTART:20090401T153000Z\r\n"
+	                                     "DTEND:20090401T163000Z\r\n"
+	                                     "RRULE:FREQ=WEEKLY;BYDAY=MO,WE;COUNT=6\r\n"
+	                                     "EXDATE:20090406T153000Z\r\n");
+	g_assert (gdata_calendar_event_expander_add_event (expander, event, &error) == TRUE);
+	g_assert_no_error (error);
+	g_object_unref (event);
+
+	/* An exception moving the instance on 2009-04-15 to the following day */
+	exception = GDATA_CALENDAR_EVENT (gdata_parsable_new_from_xml (GDATA_TYPE_CALENDAR_EVENT,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/events/g5928e82rrch95b25f8ud0dlsg_20090415T153000Z</id>"
 			"<updated>2009-04-27T17:54:10.000Z</updated>"
-			"<app:edited xmlns:app='http://www.w3.org/2007/app'>2009-04-27T17:54:10.000Z</app:edited>"
-			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/g/2005#event'/>"
-			"<title>Test daily instance event</title>"
-			"<content></content>"
-			"<link rel='http://www.iana.org/assignments/relation/alternate' type='text/html' "
-			      "href='http://www.google.com/calendar/event?"
-			            "eid=ZzU5MjhlODJycmNoOTViMjVmOHVkMGRsc2dfMjAwOTA0MjlUMTUzMDAwWiBsaWJnZGF0YS50ZXN0QGdvb2dsZW1haWwuY29t' "
-			      "title='alternate'/>"
-			"<link rel='http://www.iana.org/assignments/relation/self' type='application/atom+xml' "
-			      "href='http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/"
-			            "g5928e82rrch95b25f8ud0dlsg_20090429T153000Z'/>"
-			"<link rel='http://www.iana.org/assignments/relation/edit' type='application/atom+xml' "
-			      "href='http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/"
-			            "g5928e82rrch95b25f8ud0dlsg_20090429T153000Z'/>"
-			"<author>"
-				"<name>GData Test</name>"
-				"<email>libgdata.test@googlemail.com</email>"
-			"</author>"
+			"<title>Moved instance</title>"
 			"<gd:originalEvent id='g5928e82rrch95b25f8ud0dlsg' "
 			                  "href='http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/"
 			                        "g5928e82rrch95b25f8ud0dlsg'>"
-				"<gd:when startTime='2009-04-29T16:30:00.000+01:00'/>"
+				"<gd:when startTime='2009-04-15T15:30:00.000Z'/>"
 			"</gd:originalEvent>"
-			"<gCal:guestsCanModify value='false'/>"
-			"<gCal:guestsCanInviteOthers value='false'/>"
-			"<gCal:guestsCanSeeGuests value='false'/>"
-			"<gCal:anyoneCanAddSelf value='false'/>"
-			"<gd:comments>"
-				"<gd:feedLink href='http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/"
-				                   "g5928e82rrch95b25f8ud0dlsg_20090429T153000Z/comments'/>"
-			"</gd:comments>"
 			"<gd:eventStatus value='http://schemas.google.com/g/2005#event.confirmed'/>"
-			"<gd:visibility value='http://schemas.google.com/g/2005#event.private'/>"
-			"<gd:transparency value='http://schemas.google.com/g/2005#event.opaque'/>"
-			"<gCal:uid value='g5928e82rrch95b25f8ud0dlsg@google.com'/>"
-			"<gCal:sequence value='0'/>"
-			"<gd:when startTime='2009-04-29T17:30:00.000+01:00' endTime='2009-04-29T17:30:00.000+01:00'>"
-				"<gd:reminder minutes='10' method='email'/>"
-				"<gd:reminder minutes='10' method='alert'/>"
-			"</gd:when>"
-			"<gd:who rel='http://schemas.google.com/g/2005#event.organizer' valueString='GData Test' "
-			        "email='libgdata.test@googlemail.com'/>"
-			"<gd:where valueString=''/>"
+			"<gd:when startTime='2009-04-16T17:00:00.000Z' endTime='2009-04-16T18:00:00.000Z'/>"
 		"</entry>", -1, &error));
 	g_assert_no_error (error);
-	g_assert (GDATA_IS_ENTRY (event));
+	g_assert (gdata_calendar_event_expander_add_event (expander, exception, &error) == TRUE);
+	g_assert_no_error (error);
+
+	/* Expand April */
+	g_assert_cmpuint (gdata_calendar_event_expander_expand (expander, 1238544000, 1241136000, expander_instance_cb, instances), ==, 5);
+	g_assert_cmpuint (instances->len, ==, 5);
+	g_assert_cmpint (g_array_index (instances, gint64, 0), ==, 1238599800); /* 2009-04-01, DTSTART */
+	g_assert_cmpint (g_array_index (instances, gint64, 1), ==, 1239204600); /* 2009-04-08 */
+	g_assert_cmpint (g_array_index (instances, gint64, 2), ==, 1239636600); /* 2009-04-13 */
+	g_assert_cmpint (g_array_index (instances, gint64, 3), ==, 1239901200); /* 2009-04-16, the exception */
+	g_assert_cmpint (g_array_index (instances, gint64, 4), ==, 1240241400); /* 2009-04-20, the last one by COUNT */
+
+	/* Expand a window within the cached expansion */
+	g_array_set_size (instances, 0);
+	g_assert_cmpuint (gdata_calendar_event_expander_expand (expander, 1239321600, 1239667200, expander_instance_cb, instances), ==, 1);
+	g_assert_cmpint (g_array_index (instances, gint64, 0), ==, 1239636600);
+
+	/* Removing the exception should restore the original instance */
+	gdata_calendar_event_expander_remove_event (expander, gdata_entry_get_id (GDATA_ENTRY (exception)));
+	g_object_unref (exception);
+
+	g_array_set_size (instances, 0);
+	g_assert_cmpuint (gdata_calendar_event_expander_expand (expander, 1238544000, 1241136000, expander_instance_cb, instances), ==, 5);
+	g_assert_cmpint (g_array_index (instances, gint64, 3), ==, 1239809400); /* 2009-04-15 */
+
+	/* An all-day event on the last Friday of each month */
+	event = gdata_calendar_event_new ("http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/events/lastfriday");
+	gdata_calendar_event_set_recurrence (event,
+	                                     "DTSTART;VALUE=DATE:20090130\n"
+	                                     "DTEND;VALUE=DATE:20090131\n"
+	                                     "RRULE:FREQ=MONTHLY;BYDAY=-1FR\n"
+	                                     "BEGIN:VTIMEZONE\n"
+	                                     "TZID:Europe/London\n"
+	                                     "END:VTIMEZONE\n");
+	g_assert (gdata_calendar_event_expander_add_event (expander, event, &error) == TRUE);
+	g_assert_no_error (error);
+	g_object_unref (event);
+
+	gdata_calendar_event_expander_remove_event (expander, "http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/events/"
+	                                                      "g5928e82rrch95b25f8ud0dlsg");
+
+	g_array_set_size (instances, 0);
+	g_assert_cmpuint (gdata_calendar_event_expander_expand (expander, 1230768000, 1241136000, expander_instance_cb, instances), ==, 4);
+	g_assert_cmpint (g_array_index (instances, gint64, 0), ==, -1233273600); /* 2009-01-30 */
+	g_assert_cmpint (g_array_index (instances, gint64, 1), ==, -1235692800); /* 2009-02-27 */
+	g_assert_cmpint (g_array_index (instances, gint64, 2), ==, -1238112000); /* 2009-03-27 */
+	g_assert_cmpint (g_array_index (instances, gint64, 3), ==, -1240531200); /* 2009-04-24 */
+
+	/* A daily event in a named time zone, across the start of daylight saving time; its instances should stay at 09:00 local time */
+	event = gdata_calendar_event_new ("http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/events/london");
+	gdata_calendar_event_set_recurrence (event,
+	                                     "DTSTART;TZID=Europe/London:20090328T090000\n"
+	                                     "DTEND;TZID=Europe/London:20090328T100000\n"
+	                                     "RRULE:FREQ=DAILY;COUNT=2\n");
+	g_assert (gdata_calendar_event_expander_add_event (expander, event, &error) == TRUE);
+	g_assert_no_error (error);
+	g_object_unref (event);
+
+	g_array_set_size (instances, 0);
+	g_assert_cmpuint (gdata_calendar_event_expander_expand (expander, 1238220000, 1238371200, expander_instance_cb, instances), ==, 2);
+	g_assert_cmpint (g_array_index (instances, gint64, 0), ==, 1238230800); /* 2009-03-28T09:00:00Z (GMT) */
+	g_assert_cmpint (g_array_index (instances, gint64, 1), ==, 1238313600); /* 2009-03-29T08:00:00Z (BST) */
+
+	gdata_calendar_event_expander_remove_event (expander, "http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/events/london");
+
+	/* Unsupported rules should be rejected, leaving the expander unchanged */
+	event = gdata_calendar_event_new ("http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/events/hourly");
+	gdata_calendar_event_set_recurrence (event, "DTSTART:20090101T000000Z\nRRULE:FREQ=HOURLY\n");
+	g_assert (gdata_calendar_event_expander_add_event (expander, event, &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
 	g_clear_error (&error);
+	g_object_unref (event);
 
-	/* Check the original event */
-	g_assert (gdata_calendar_event_is_exception (event) == TRUE);
+	g_array_set_size (instances, 0);
+	g_assert_cmpuint (gdata_calendar_event_expander_expand (expander, 1230768000, 1241136000, expander_instance_cb, instances), ==, 4);
 
-	gdata_calendar_event_get_original_event_details (event, &id, &uri);
-	g_assert_cmpstr (id, ==, "g5928e82rrch95b25f8ud0dlsg");
-	g_assert_cmpstr (uri, ==, "http://www.google.com/calendar/feeds/libgdata.test@googlemail.com/private/full/g5928e82rrch95b25f8ud0dlsg");
+	g_array_free (instances, TRUE);
+	g_object_unref (expander);
+}
 
-	g_free (id);
-	g_free (uri);
+static void
+test_query_events_multiple_unauthenticated (void)
+{
+	GDataCalendarService *service;
+	GDataCalendarCalendar *calendar;
+	GList *calendars;
+	GError *error = NULL;
+
+	/* Querying without authentication should fail before any requests are made */
+	service = gdata_calendar_service_new (NULL);
+	calendar = gdata_calendar_calendar_new (NULL);
+	calendars = g_list_prepend (NULL, calendar);
+
+	g_assert (gdata_calendar_service_query_events_multiple (service, calendars, NULL, NULL, NULL, NULL, &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED);
+	g_clear_error (&error);
+
+	g_list_free (calendars);
+	g_object_unref (calendar);
+	g_object_unref (service);
+}
+
+static GDataCalendarEvent *
+create_timed_event (const gchar *id, gint64 start_time, gint64 end_time)
+{
+	GDataCalendarEvent *event;
+	GDataGDWhen *when;
+
+	event = gdata_calendar_event_new (id);
+	when = gdata_gd_when_new (start_time, end_time, FALSE);
+	gdata_calendar_event_add_time (event, when);
+	g_object_unref (when);
+
+	return event;
+}
+
+static void
+test_free_busy_index (void)
+{
+	GDataCalendarFreeBusyIndex *index;
+	GDataCalendarCalendar *calendar;
+	GDataCalendarEvent *event;
+	GList *events, *periods;
+
+	index = gdata_calendar_free_busy_index_new ();
+
+	event = create_timed_event ("a", 1000, 2000);
+	gdata_calendar_free_busy_index_add_event (index, NULL, event);
+	g_object_unref (event);
+
+	event = create_timed_event ("b", 1500, 2500);
+	gdata_calendar_free_busy_index_add_event (index, NULL, event);
+	g_object_unref (event);
+
+	event = create_timed_event ("c", 4000, 5000);
+	gdata_calendar_free_busy_index_add_event (index, NULL, event);
+	g_object_unref (event);
+
+	/* Transparent events shouldn't make any time busy */
+	event = create_timed_event ("d", 2500, 3500);
+	gdata_calendar_event_set_transparency (event, GDATA_GD_EVENT_TRANSPARENCY_TRANSPARENT);
+	gdata_calendar_free_busy_index_add_event (index, NULL, event);
+	g_object_unref (event);
+
+	/* Overlap queries; intervals are half-open */
+	g_assert (gdata_calendar_free_busy_index_is_free (index, 0, 1000) == TRUE);
+	g_assert (gdata_calendar_free_busy_index_is_free (index, 2500, 4000) == TRUE);
+	g_assert (gdata_calendar_free_busy_index_is_free (index, 2499, 2501) == FALSE);
+
+	events = gdata_calendar_free_busy_index_get_events (index, 1800, 4001);
+	g_assert_cmpuint (g_list_length (events), ==, 3);
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (events->data)), ==, "a");
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (events->next->data)), ==, "b");
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (events->next->next->data)), ==, "c");
+	g_list_free_full (events, g_object_unref);
+
+	/* Free slot searches */
+	g_assert_cmpint (gdata_calendar_free_busy_index_find_free_slot (index, 0, 6000, 1000), ==, 0);
+	g_assert_cmpint (gdata_calendar_free_busy_index_find_free_slot (index, 1000, 6000, 1500), ==, 2500);
+	g_assert_cmpint (gdata_calendar_free_busy_index_find_free_slot (index, 1000, 6000, 2000), ==, 5000);
+	g_assert_cmpint (gdata_calendar_free_busy_index_find_free_slot (index, 1000, 5500, 1600), ==, -1);
+
+	/* Busy periods are merged and clipped to the range */
+	periods = gdata_calendar_free_busy_index_get_busy_periods (index, 1200, 4500);
+	g_assert_cmpuint (g_list_length (periods), ==, 2);
+	g_assert_cmpint (gdata_gd_when_get_start_time (GDATA_GD_WHEN (periods->data)), ==, 1200);
+	g_assert_cmpint (gdata_gd_when_get_end_time (GDATA_GD_WHEN (periods->data)), ==, 2500);
+	g_assert_cmpint (gdata_gd_when_get_start_time (GDATA_GD_WHEN (periods->next->data)), ==, 4000);
+	g_assert_cmpint (gdata_gd_when_get_end_time (GDATA_GD_WHEN (periods->next->data)), ==, 4500);
+	g_list_free_full (periods, g_object_unref);
+
+	/* Adding a new version of an event should replace the old one */
+	event = create_timed_event ("a", 6000, 7000);
+	gdata_calendar_free_busy_index_add_event (index, NULL, event);
+	g_object_unref (event);
+
+	g_assert (gdata_calendar_free_busy_index_is_free (index, 1000, 1500) == TRUE);
+	g_assert (gdata_calendar_free_busy_index_is_free (index, 6500, 6501) == FALSE);
+
+	gdata_calendar_free_busy_index_remove_event (index, "c");
+	g_assert (gdata_calendar_free_busy_index_is_free (index, 4000, 5000) == TRUE);
+
+	/* Removing a calendar should only remove its own events */
+	calendar = gdata_calendar_calendar_new ("calendar");
+	event = create_timed_event ("e", 8000, 9000);
+	gdata_calendar_free_busy_index_add_event (index, calendar, event);
 	g_object_unref (event);
+
+	g_assert (gdata_calendar_free_busy_index_is_free (index, 8000, 9000) == FALSE);
+	gdata_calendar_free_busy_index_remove_calendar (index, calendar);
+	g_assert (gdata_calendar_free_busy_index_is_free (index, 8000, 9000) == TRUE);
+	g_assert (gdata_calendar_free_busy_index_is_free (index, 6000, 7000) == FALSE);
+
+	g_object_unref (calendar);
+	g_object_unref (index);
+}
+
+static void
+test_calendar_list_shared (void)
+{
+	GDataCalendarService *service;
+	GDataCalendarCalendarList *list, *list2, *own_list;
+	GError *error = NULL;
+
+	service = gdata_calendar_service_new (NULL);
+
+	/* Callers should share the same list while it's alive */
+	list = gdata_calendar_calendar_list_get_for_service (service, FALSE);
+	list2 = gdata_calendar_calendar_list_get_for_service (service, FALSE);
+	own_list = gdata_calendar_calendar_list_get_for_service (service, TRUE);
+
+	g_assert (list == list2);
+	g_assert (list != own_list);
+	g_assert (gdata_calendar_calendar_list_get_service (list) == service);
+	g_assert (gdata_calendar_calendar_list_get_own_calendars (list) == FALSE);
+	g_assert (gdata_calendar_calendar_list_get_own_calendars (own_list) == TRUE);
+
+	/* The list should be empty until it's been refreshed, and refreshing it without authentication should leave it that way */
+	g_assert (gdata_calendar_calendar_list_get_calendars (list) == NULL);
+	g_assert (gdata_calendar_calendar_list_refresh (list, NULL, &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED);
+	g_clear_error (&error);
+	g_assert (gdata_calendar_calendar_list_get_calendars (list) == NULL);
+	g_assert (gdata_calendar_calendar_list_look_up_calendar (list, "calendar") == NULL);
+
+	g_object_unref (list2);
+	g_object_unref (list);
+	g_object_unref (own_list);
+	g_object_unref (service);
 }
 
 static void
@@ -1178,6 +1538,672 @@ test_access_rule_delete (TempCalendarAclsData *data, gconstpointer service)
 	uhm_server_end_trace (mock_server);
 }
 
+/* Builds a calendar whose ACL is at @acl_uri, or which has no ACL link if @acl_uri is %NULL */
+static GDataCalendarCalendar *
+build_acl_calendar (const gchar *name, const gchar *acl_uri)
+{
+	GDataCalendarCalendar *calendar;
+	gchar *xml, *acl_link = NULL;
+	GError *error = NULL;
+
+	if (acl_uri != NULL) {
+		acl_link = g_markup_printf_escaped ("<link rel='http://schemas.google.com/acl/2007#accessControlList' type='application/atom+xml' "
+		                                          "href='%s'/>", acl_uri);
+	}
+
+	xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom'>"
+	                           "<id>http://www.google.com/calendar/feeds/default/owncalendars/full/%s</id>"
+	                           "<updated>2026-10-01T00:00:00.000Z</updated>"
+	                           "<title type='text'>%s</title>"
+	                           "<content type='application/atom+xml' src='https://www.google.com/calendar/feeds/%s/private/full'/>"
+	                           "%s"
+	                       "</entry>", name, name, name, (acl_link != NULL) ? acl_link : "");
+	calendar = GDATA_CALENDAR_CALENDAR (gdata_parsable_new_from_xml (GDATA_TYPE_CALENDAR_CALENDAR, xml, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_CALENDAR_CALENDAR (calendar));
+	g_free (xml);
+	g_free (acl_link);
+
+	return calendar;
+}
+
+typedef struct {
+	GHashTable *rules; /* calendar to a GPtrArray of the roles of its rules */
+	GHashTable *errors; /* calendar to GError */
+	GThread *thread;
+	GMainLoop *main_loop; /* only used for the async test */
+	gboolean success;
+} GetRulesMultipleData;
+
+static void
+get_rules_multiple_cb (GDataAccessHandler *access_handler, GDataAccessRule *rule, GError *error, GetRulesMultipleData *data)
+{
+	g_assert (GDATA_IS_CALENDAR_CALENDAR (access_handler));
+	g_assert ((rule == NULL) != (error == NULL));
+	g_assert (g_thread_self () == data->thread);
+
+	if (rule != NULL) {
+		GPtrArray *roles = g_hash_table_lookup (data->rules, access_handler);
+
+		g_assert (GDATA_IS_ACCESS_RULE (rule));
+
+		if (roles == NULL) {
+			roles = g_ptr_array_new_with_free_func (g_free);
+			g_hash_table_insert (data->rules, access_handler, roles);
+		}
+
+		g_ptr_array_add (roles, g_strdup (gdata_access_rule_get_role (rule)));
+	} else {
+		/* Each failure is only reported once */
+		g_assert (g_hash_table_lookup (data->errors, access_handler) == NULL);
+		g_hash_table_insert (data->errors, access_handler, g_error_copy (error));
+	}
+}
+
+static GList *
+build_get_rules_multiple_calendars (void)
+{
+	GList *calendars = NULL;
+
+	calendars = g_list_append (calendars, build_acl_calendar ("first", "https://www.google.com/calendar/feeds/first%40group.calendar.google.com/acl/full"));
+	calendars = g_list_append (calendars, build_acl_calendar ("second", "https://www.google.com/calendar/feeds/second%40group.calendar.google.com/acl/full"));
+	calendars = g_list_append (calendars, build_acl_calendar ("third", NULL));
+
+	return calendars;
+}
+
+static void
+assert_rules_multiple_got (GetRulesMultipleData *data, GList *calendars)
+{
+	GPtrArray *roles;
+
+	/* The first calendar's rules are all delivered, in order */
+	roles = g_hash_table_lookup (data->rules, calendars->data);
+	g_assert (roles != NULL);
+	g_assert_cmpuint (roles->len, ==, 2);
+	g_assert_cmpstr (roles->pdata[0], ==, GDATA_CALENDAR_ACCESS_ROLE_EDITOR);
+	g_assert_cmpstr (roles->pdata[1], ==, GDATA_CALENDAR_ACCESS_ROLE_READ);
+	g_assert (g_hash_table_lookup (data->errors, calendars->data) == NULL);
+
+	/* The second calendar's ACL couldn't be retrieved, and the third doesn't have one */
+	g_assert (g_hash_table_lookup (data->rules, calendars->next->data) == NULL);
+	g_assert_error ((GError*) g_hash_table_lookup (data->errors, calendars->next->data), GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+
+	g_assert (g_hash_table_lookup (data->rules, calendars->next->next->data) == NULL);
+	g_assert_error ((GError*) g_hash_table_lookup (data->errors, calendars->next->next->data), GDATA_SERVICE_ERROR,
+	                GDATA_SERVICE_ERROR_FORBIDDEN);
+
+	g_assert_cmpuint (g_hash_table_size (data->rules), ==, 1);
+	g_assert_cmpuint (g_hash_table_size (data->errors), ==, 2);
+}
+
+static void
+get_rules_multiple_data_init (GetRulesMultipleData *data)
+{
+	data->rules = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
+	data->errors = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_error_free);
+	data->thread = g_thread_self ();
+	data->main_loop = NULL;
+	data->success = FALSE;
+}
+
+static void
+get_rules_multiple_data_clear (GetRulesMultipleData *data)
+{
+	g_hash_table_unref (data->errors);
+	g_hash_table_unref (data->rules);
+
+	if (data->main_loop != NULL)
+		g_main_loop_unref (data->main_loop);
+}
+
+static void
+test_access_rule_get_multiple (gconstpointer service)
+{
+	GetRulesMultipleData data;
+	GList *calendars;
+	guint old_max_connections;
+	gboolean success;
+	GError *error = NULL;
+
+	gdata_test_mock_server_start_trace (mock_server, "access-rule-get-multiple");
+
+	/* Query the ACLs one at a time so that the requests are made in the same order as in the trace */
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	calendars = build_get_rules_multiple_calendars ();
+	get_rules_multiple_data_init (&data);
+
+	success = gdata_access_handler_get_rules_multiple (GDATA_SERVICE (service), calendars, NULL,
+	                                                   (GDataAccessHandlerRuleCallback) get_rules_multiple_cb, &data, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	assert_rules_multiple_got (&data, calendars);
+
+	get_rules_multiple_data_clear (&data);
+	g_list_free_full (calendars, g_object_unref);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+
+	uhm_server_end_trace (mock_server);
+}
+
+static void
+get_rules_multiple_async_cb (GDataService *service, GAsyncResult *async_result, GetRulesMultipleData *data)
+{
+	GError *error = NULL;
+
+	data->success = gdata_access_handler_get_rules_multiple_finish (service, async_result, &error);
+	g_assert_no_error (error);
+
+	g_main_loop_quit (data->main_loop);
+}
+
+static void
+test_access_rule_get_multiple_async (gconstpointer service)
+{
+	GetRulesMultipleData data;
+	GList *calendars;
+	guint old_max_connections;
+
+	gdata_test_mock_server_start_trace (mock_server, "access-rule-get-multiple");
+
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	calendars = build_get_rules_multiple_calendars ();
+	get_rules_multiple_data_init (&data);
+	data.main_loop = g_main_loop_new (NULL, FALSE);
+
+	/* The callbacks are called in this thread's main context, and all of them before the operation finishes */
+	gdata_access_handler_get_rules_multiple_async (GDATA_SERVICE (service), calendars, NULL, (GDataAccessHandlerRuleCallback) get_rules_multiple_cb,
+	                                               &data, NULL, NULL, (GAsyncReadyCallback) get_rules_multiple_async_cb, &data);
+	g_main_loop_run (data.main_loop);
+
+	g_assert (data.success == TRUE);
+	assert_rules_multiple_got (&data, calendars);
+
+	get_rules_multiple_data_clear (&data);
+	g_list_free_full (calendars, g_object_unref);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+
+	uhm_server_end_trace (mock_server);
+}
+
+static void
+test_access_rule_batch_operation (void)
+{
+	GDataCalendarService *service;
+	GDataCalendarCalendar *calendar;
+	GDataBatchOperation *operation;
+
+	/* Creating the operation doesn't make any requests */
+	service = gdata_calendar_service_new (NULL);
+
+	/* The batch URI is the ACL URI with "/batch" appended */
+	calendar = build_acl_calendar ("first", "https://www.google.com/calendar/feeds/first%40group.calendar.google.com/acl/full");
+	operation = gdata_access_handler_create_batch_operation (GDATA_ACCESS_HANDLER (calendar), GDATA_SERVICE (service));
+
+	g_assert (GDATA_IS_BATCH_OPERATION (operation));
+	g_assert (gdata_batch_operation_get_service (operation) == GDATA_SERVICE (service));
+	g_assert_cmpstr (gdata_batch_operation_get_feed_uri (operation), ==,
+	                 "https://www.google.com/calendar/feeds/first%40group.calendar.google.com/acl/full/batch");
+	g_assert (gdata_batch_operation_get_authorization_domain (operation) == gdata_calendar_service_get_primary_authorization_domain ());
+	g_assert_cmpuint (gdata_batch_operation_get_max_operations_per_request (operation), ==, 100);
+
+	g_object_unref (operation);
+	g_object_unref (calendar);
+
+	/* Any query string is kept after the "/batch" path component */
+	calendar = build_acl_calendar ("second", "https://www.google.com/calendar/feeds/second%40group.calendar.google.com/acl/full?gsessionid=abc&v=2");
+	operation = gdata_access_handler_create_batch_operation (GDATA_ACCESS_HANDLER (calendar), GDATA_SERVICE (service));
+
+	g_assert (GDATA_IS_BATCH_OPERATION (operation));
+	g_assert_cmpstr (gdata_batch_operation_get_feed_uri (operation), ==,
+	                 "https://www.google.com/calendar/feeds/second%40group.calendar.google.com/acl/full/batch?gsessionid=abc&v=2");
+	g_assert (gdata_batch_operation_get_authorization_domain (operation) == gdata_calendar_service_get_primary_authorization_domain ());
+	g_assert_cmpuint (gdata_batch_operation_get_max_operations_per_request (operation), ==, 100);
+
+	g_object_unref (operation);
+	g_object_unref (calendar);
+
+	g_object_unref (service);
+}
+
+static void
+test_batch_events_empty (void)
+{
+	GDataCalendarService *service;
+	GDataCalendarCalendar *calendar;
+	GDataCalendarEvent *event;
+	GList *events;
+	GError *error = NULL;
+
+	/* Inserting no events should succeed without making any requests (which would fail, since the service isn't authenticated) */
+	service = gdata_calendar_service_new (NULL);
+
+	g_assert (gdata_calendar_service_insert_events (service, NULL, NULL, NULL, NULL, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	/* A calendar without a content URI has no batch feed to insert into */
+	calendar = gdata_calendar_calendar_new (NULL);
+	event = gdata_calendar_event_new (NULL);
+	events = g_list_prepend (NULL, event);
+
+	g_assert (gdata_calendar_service_insert_events (service, calendar, events, NULL, NULL, NULL, &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_clear_error (&error);
+
+	g_list_free (events);
+	g_object_unref (event);
+	g_object_unref (calendar);
+	g_object_unref (service);
+}
+
+/* A synchronisation store which keeps the titles of each calendar's events in a hash table */
+#define TYPE_TEST_CALENDAR_STORE	(test_calendar_store_get_type ())
+#define TEST_CALENDAR_STORE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), TYPE_TEST_CALENDAR_STORE, TestCalendarStore))
+
+typedef struct {
+	GObject parent;
+	GHashTable *calendars; /* calendar ID → (event ID → title) */
+	guint n_resets;
+} TestCalendarStore;
+
+typedef struct {
+	GObjectClass parent;
+} TestCalendarStoreClass;
+
+static GType test_calendar_store_get_type (void) G_GNUC_CONST;
+static void test_calendar_store_sync_store_init (GDataCalendarSyncStoreInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestCalendarStore, test_calendar_store, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_CALENDAR_SYNC_STORE, test_calendar_store_sync_store_init))
+
+static void
+test_calendar_store_finalize (GObject *object)
+{
+	g_hash_table_unref (TEST_CALENDAR_STORE (object)->calendars);
+
+	G_OBJECT_CLASS (test_calendar_store_parent_class)->finalize (object);
+}
+
+static void
+test_calendar_store_class_init (TestCalendarStoreClass *klass)
+{
+	G_OBJECT_CLASS (klass)->finalize = test_calendar_store_finalize;
+}
+
+static void
+test_calendar_store_init (TestCalendarStore *self)
+{
+	self->calendars = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+}
+
+/* Returns the events stored for @calendar_id, creating the table if @create is %TRUE */
+static GHashTable *
+test_calendar_store_get_events (TestCalendarStore *self, const gchar *calendar_id, gboolean create)
+{
+	GHashTable *events;
+
+	events = g_hash_table_lookup (self->calendars, calendar_id);
+	if (events == NULL && create == TRUE) {
+		events = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		g_hash_table_insert (self->calendars, g_strdup (calendar_id), events);
+	}
+
+	return events;
+}
+
+static gboolean
+test_calendar_store_reset_calendar (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GError **error)
+{
+	g_hash_table_remove (TEST_CALENDAR_STORE (self)->calendars, gdata_entry_get_id (GDATA_ENTRY (calendar)));
+	TEST_CALENDAR_STORE (self)->n_resets++;
+
+	return TRUE;
+}
+
+static gboolean
+test_calendar_store_apply_event (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GDataCalendarEvent *event, GError **error)
+{
+	GHashTable *events;
+
+	events = test_calendar_store_get_events (TEST_CALENDAR_STORE (self), gdata_entry_get_id (GDATA_ENTRY (calendar)), TRUE);
+	g_hash_table_replace (events, g_strdup (gdata_entry_get_id (GDATA_ENTRY (event))), g_strdup (gdata_entry_get_title (GDATA_ENTRY (event))));
+
+	return TRUE;
+}
+
+static gboolean
+test_calendar_store_remove_event (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, const gchar *event_id, GError **error)
+{
+	GHashTable *events;
+
+	events = test_calendar_store_get_events (TEST_CALENDAR_STORE (self), gdata_entry_get_id (GDATA_ENTRY (calendar)), FALSE);
+	if (events != NULL)
+		g_hash_table_remove (events, event_id);
+
+	return TRUE;
+}
+
+static void
+test_calendar_store_sync_store_init (GDataCalendarSyncStoreInterface *iface)
+{
+	iface->reset_calendar = test_calendar_store_reset_calendar;
+	iface->apply_event = test_calendar_store_apply_event;
+	iface->remove_event = test_calendar_store_remove_event;
+}
+
+static GDataCalendarCalendar *
+build_sync_calendar (const gchar *name)
+{
+	GDataCalendarCalendar *calendar;
+	gchar *xml;
+	GError *error = NULL;
+
+	xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom'>"
+	                           "<id>http://www.google.com/calendar/feeds/default/owncalendars/full/%s</id>"
+	                           "<updated>2026-10-01T00:00:00.000Z</updated>"
+	                           "<title type='text'>%s</title>"
+	                           "<content type='application/atom+xml' src='https://www.google.com/calendar/feeds/%s/private/full'/>"
+	                       "</entry>", name, name, name);
+	calendar = GDATA_CALENDAR_CALENDAR (gdata_parsable_new_from_xml (GDATA_TYPE_CALENDAR_CALENDAR, xml, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_CALENDAR_CALENDAR (calendar));
+	g_free (xml);
+
+	return calendar;
+}
+
+#define SYNC_EVENT_ID(C, E) "http://www.google.com/calendar/feeds/" C "/private/full/" E
+
+static void
+test_sync (gconstpointer service)
+{
+	TestCalendarStore *store;
+	GDataCalendarSync *sync;
+	GDataCalendarCalendar *calendar_a, *calendar_b;
+	GHashTable *events;
+	gchar *state;
+	guint n_changed, n_removed;
+	GError *error = NULL;
+
+	/* The trace is hand-written, so there's nothing to check against online */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping synchronisation test when online or logging.");
+		return;
+	}
+
+	store = g_object_new (TYPE_TEST_CALENDAR_STORE, NULL);
+	calendar_a = build_sync_calendar ("calendar-a");
+	calendar_b = build_sync_calendar ("calendar-b");
+
+	/* Synchronise October 2026, expanding recurring events within it */
+	sync = gdata_calendar_sync_new (GDATA_CALENDAR_SERVICE (service), GDATA_CALENDAR_SYNC_STORE (store));
+	gdata_calendar_sync_set_window (sync, 1790812800, 1793491200);
+	gdata_calendar_sync_set_page_size (sync, 2);
+
+	gdata_test_mock_server_start_trace (mock_server, "sync");
+
+	/* Neither calendar has been synchronised, so each should be reset and fully downloaded, across all its pages */
+	g_assert_cmpint (gdata_calendar_sync_get_watermark (sync, calendar_a), ==, -1);
+
+	g_assert (gdata_calendar_sync_run (sync, calendar_a, NULL, &n_changed, &n_removed, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (n_changed, ==, 4);
+	g_assert_cmpuint (n_removed, ==, 0);
+
+	g_assert (gdata_calendar_sync_run (sync, calendar_b, NULL, &n_changed, &n_removed, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (n_changed, ==, 1);
+	g_assert_cmpuint (n_removed, ==, 0);
+
+	g_assert_cmpuint (store->n_resets, ==, 2);
+
+	events = g_hash_table_lookup (store->calendars, gdata_entry_get_id (GDATA_ENTRY (calendar_a)));
+	g_assert_cmpuint (g_hash_table_size (events), ==, 4);
+	g_assert_cmpstr (g_hash_table_lookup (events, SYNC_EVENT_ID ("calendar-a", "e1")), ==, "Dentist");
+	g_assert_cmpstr (g_hash_table_lookup (events, SYNC_EVENT_ID ("calendar-a", "e2_20261007T100000Z")), ==, "Weekly meeting");
+	g_assert_cmpstr (g_hash_table_lookup (events, SYNC_EVENT_ID ("calendar-a", "e2_20261014T100000Z")), ==, "Weekly meeting");
+	g_assert_cmpstr (g_hash_table_lookup (events, SYNC_EVENT_ID ("calendar-a", "e3")), ==, "Lunch");
+
+	events = g_hash_table_lookup (store->calendars, gdata_entry_get_id (GDATA_ENTRY (calendar_b)));
+	g_assert_cmpuint (g_hash_table_size (events), ==, 1);
+	g_assert_cmpstr (g_hash_table_lookup (events, SYNC_EVENT_ID ("calendar-b", "e4")), ==, "Holiday");
+
+	/* Each calendar's watermark is the server's time at its first page */
+	g_assert_cmpint (gdata_calendar_sync_get_watermark (sync, calendar_a), ==, 1791972000);
+	g_assert_cmpint (gdata_calendar_sync_get_watermark (sync, calendar_b), ==, 1791972300);
+
+	/* Save the watermarks and restore them into a new GDataCalendarSync, as if resuming in a new process */
+	state = gdata_calendar_sync_save_state (sync);
+	g_object_unref (sync);
+
+	sync = gdata_calendar_sync_new (GDATA_CALENDAR_SERVICE (service), GDATA_CALENDAR_SYNC_STORE (store));
+	gdata_calendar_sync_set_window (sync, 1790812800, 1793491200);
+	gdata_calendar_sync_set_page_size (sync, 2);
+
+	g_assert (gdata_calendar_sync_load_state (sync, "Not a state", &error) == FALSE);
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_clear_error (&error);
+	g_assert_cmpint (gdata_calendar_sync_get_watermark (sync, calendar_a), ==, -1);
+
+	g_assert (gdata_calendar_sync_load_state (sync, state, &error) == TRUE);
+	g_assert_no_error (error);
+	g_free (state);
+
+	g_assert_cmpint (gdata_calendar_sync_get_watermark (sync, calendar_a), ==, 1791972000);
+	g_assert_cmpint (gdata_calendar_sync_get_watermark (sync, calendar_b), ==, 1791972300);
+
+	/* Synchronising calendar A again should only query for the changes since its watermark (less the clock skew margin), including the
+	 * cancelled event, and shouldn't reset it */
+	g_assert (gdata_calendar_sync_run (sync, calendar_a, NULL, &n_changed, &n_removed, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (n_changed, ==, 1);
+	g_assert_cmpuint (n_removed, ==, 1);
+	g_assert_cmpuint (store->n_resets, ==, 2);
+
+	events = g_hash_table_lookup (store->calendars, gdata_entry_get_id (GDATA_ENTRY (calendar_a)));
+	g_assert_cmpuint (g_hash_table_size (events), ==, 3);
+	g_assert_cmpstr (g_hash_table_lookup (events, SYNC_EVENT_ID ("calendar-a", "e2_20261007T100000Z")), ==, "Weekly meeting");
+	g_assert_cmpstr (g_hash_table_lookup (events, SYNC_EVENT_ID ("calendar-a", "e2_20261014T100000Z")), ==, "Weekly meeting (moved)");
+	g_assert (g_hash_table_lookup (events, SYNC_EVENT_ID ("calendar-a", "e3")) == NULL);
+
+	g_assert_cmpint (gdata_calendar_sync_get_watermark (sync, calendar_a), ==, 1791975600);
+	g_assert_cmpint (gdata_calendar_sync_get_watermark (sync, calendar_b), ==, 1791972300);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (sync);
+	g_object_unref (calendar_b);
+	g_object_unref (calendar_a);
+	g_object_unref (store);
+}
+
+static void
+query_events_multiple_cb (GDataCalendarCalendar *calendar, GDataCalendarEvent *event, GString *delivered)
+{
+	gchar *id_prefix;
+
+	/* Each event should be delivered with the calendar it came from */
+	id_prefix = g_strdup_printf ("http://www.google.com/calendar/feeds/%s/", gdata_entry_get_title (GDATA_ENTRY (calendar)));
+	g_assert (g_str_has_prefix (gdata_entry_get_id (GDATA_ENTRY (event)), id_prefix) == TRUE);
+	g_free (id_prefix);
+
+	if (delivered->len > 0)
+		g_string_append_c (delivered, ',');
+	g_string_append (delivered, gdata_entry_get_title (GDATA_ENTRY (event)));
+}
+
+static void
+test_query_events_multiple (gconstpointer service)
+{
+	GDataCalendarQuery *query;
+	GList *calendars = NULL;
+	GString *delivered;
+	guint old_max_connections;
+	GError *error = NULL;
+
+	/* The trace is hand-written, so there's nothing to check against online */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping multiple calendar query test when online or logging.");
+		return;
+	}
+
+	/* Query one calendar at a time, so that the requests are made in the order they're listed in the trace */
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	calendars = g_list_append (calendars, build_sync_calendar ("calendar-a"));
+	calendars = g_list_append (calendars, build_sync_calendar ("calendar-b"));
+	calendars = g_list_append (calendars, build_sync_calendar ("calendar-c"));
+
+	/* Each calendar should be asked for its events in order of start time, within the query's window */
+	query = gdata_calendar_query_new (NULL);
+	gdata_calendar_query_set_single_events (query, TRUE);
+	gdata_calendar_query_set_start_min (query, 1790812800); /* 2026-10-01T00:00:00Z */
+	gdata_calendar_query_set_start_max (query, 1793491200); /* 2026-11-01T00:00:00Z */
+
+	gdata_test_mock_server_start_trace (mock_server, "query-events-multiple");
+
+	/* The events should be merged in order of start time, with b0 (which has no times) first. calendar-c doesn't exist, which fails the
+	 * operation, but the other calendars' events are still delivered. */
+	delivered = g_string_new (NULL);
+	g_assert (gdata_calendar_service_query_events_multiple (GDATA_CALENDAR_SERVICE (service), calendars, GDATA_QUERY (query), NULL,
+	                                                        (GDataCalendarServiceEventCallback) query_events_multiple_cb, delivered,
+	                                                        &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+	g_clear_error (&error);
+
+	g_assert_cmpstr (delivered->str, ==, "b0,a1,b1,b2,a2,a3");
+	g_string_free (delivered, TRUE);
+
+	uhm_server_end_trace (mock_server);
+
+	/* The query itself shouldn't have been modified */
+	g_assert (gdata_calendar_query_get_order_by (query) == NULL);
+	g_assert (gdata_calendar_query_get_sort_order (query) == NULL);
+
+	g_object_unref (query);
+	g_list_free_full (calendars, g_object_unref);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+}
+
+#define BATCH_EVENTS_N_EVENTS 3
+
+typedef struct {
+	GDataCalendarEvent *events[BATCH_EVENTS_N_EVENTS]; /* the events passed in */
+	GDataCalendarEvent *results[BATCH_EVENTS_N_EVENTS]; /* the inserted events, if any */
+	GError *errors[BATCH_EVENTS_N_EVENTS];
+	guint n_results;
+} BatchEventsResults;
+
+static void
+batch_events_results_clear (BatchEventsResults *results)
+{
+	guint i;
+
+	for (i = 0; i < BATCH_EVENTS_N_EVENTS; i++) {
+		g_clear_object (&(results->results[i]));
+		g_clear_error (&(results->errors[i]));
+	}
+
+	results->n_results = 0;
+}
+
+static void
+batch_events_cb (guint index, GDataCalendarEvent *event, GDataCalendarEvent *result, GError *error, BatchEventsResults *results)
+{
+	/* Each event should be reported exactly once, with its position in the list */
+	g_assert_cmpuint (index, <, BATCH_EVENTS_N_EVENTS);
+	g_assert (event == results->events[index]);
+	g_assert (results->results[index] == NULL && results->errors[index] == NULL);
+	g_assert ((result == NULL) != (error == NULL));
+
+	results->results[index] = (result != NULL) ? g_object_ref (result) : NULL;
+	results->errors[index] = (error != NULL) ? g_error_copy (error) : NULL;
+	results->n_results++;
+}
+
+static void
+test_batch_events (gconstpointer service)
+{
+	GDataCalendarCalendar *calendar;
+	GList *events = NULL;
+	BatchEventsResults results = { { NULL, }, };
+	guint i;
+	GError *error = NULL;
+
+	/* The trace is hand-written, so there's nothing to check against online */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping event batch test when online or logging.");
+		return;
+	}
+
+	for (i = 0; i < BATCH_EVENTS_N_EVENTS; i++) {
+		gchar *title = g_strdup_printf ("Event %u", i + 1);
+
+		results.events[i] = gdata_calendar_event_new (NULL);
+		gdata_entry_set_title (GDATA_ENTRY (results.events[i]), title);
+		events = g_list_append (events, results.events[i]);
+
+		g_free (title);
+	}
+
+	gdata_test_mock_server_start_trace (mock_server, "batch-events");
+
+	/* Insert all three into the default calendar in one request. The server rejects the second and answers out of order, but each result should
+	 * be matched to its event, and the rejection shouldn't fail the batch as a whole. */
+	g_assert (gdata_calendar_service_insert_events (GDATA_CALENDAR_SERVICE (service), NULL, events, NULL,
+	                                                (GDataCalendarServiceBatchCallback) batch_events_cb, &results, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert_cmpuint (results.n_results, ==, 3);
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (results.results[0])), ==,
+	                 "http://www.google.com/calendar/feeds/default/private/full/event1");
+	g_assert_cmpstr (gdata_entry_get_etag (GDATA_ENTRY (results.results[0])), ==, "\"etag1\"");
+	g_assert_error (results.errors[1], GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (results.results[2])), ==,
+	                 "http://www.google.com/calendar/feeds/default/private/full/event3");
+	g_assert_cmpstr (gdata_entry_get_etag (GDATA_ENTRY (results.results[2])), ==, "\"etag3\"");
+
+	/* The events passed in shouldn't have been modified */
+	g_assert (gdata_entry_is_inserted (GDATA_ENTRY (results.events[0])) == FALSE);
+
+	batch_events_results_clear (&results);
+
+	/* Inserting into a calendar goes to its own batch feed. This calendar's been deleted, so the whole request fails, and that's reported both
+	 * to the callback and to the caller. */
+	calendar = build_sync_calendar ("calendar-a");
+	g_list_free (events);
+	events = g_list_append (NULL, results.events[0]);
+
+	g_assert (gdata_calendar_service_insert_events (GDATA_CALENDAR_SERVICE (service), calendar, events, NULL,
+	                                                (GDataCalendarServiceBatchCallback) batch_events_cb, &results, &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+	g_clear_error (&error);
+
+	g_assert_cmpuint (results.n_results, ==, 1);
+	g_assert_error (results.errors[0], GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+
+	batch_events_results_clear (&results);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (calendar);
+	g_list_free (events);
+
+	for (i = 0; i < BATCH_EVENTS_N_EVENTS; i++)
+		g_object_unref (results.events[i]);
+}
+
+#undef SYNC_EVENT_ID
+
 static void
 test_batch (gconstpointer service)
 {
@@ -1514,8 +2540,14 @@ main (int argc, char *argv[])
 	            tear_down_temp_calendar_acls);
 	g_test_add ("/calendar/access-rule/delete", TempCalendarAclsData, service, set_up_temp_calendar_acls, test_access_rule_delete,
 	            tear_down_temp_calendar_acls);
+	g_test_add_data_func ("/calendar/access-rule/get/multiple", service, test_access_rule_get_multiple);
+	g_test_add_data_func ("/calendar/access-rule/get/multiple/async", service, test_access_rule_get_multiple_async);
+	g_test_add_func ("/calendar/access-rule/batch-operation", test_access_rule_batch_operation);
 
 	g_test_add_data_func ("/calendar/batch", service, test_batch);
+	g_test_add_func ("/calendar/batch/events/empty", test_batch_events_empty);
+	g_test_add_data_func ("/calendar/batch/events", service, test_batch_events);
+	g_test_add_data_func ("/calendar/sync", service, test_sync);
 	g_test_add ("/calendar/batch/async", BatchAsyncData, service, setup_batch_async, test_batch_async, teardown_batch_async);
 	g_test_add ("/calendar/batch/async/cancellation", BatchAsyncData, service, setup_batch_async, test_batch_async_cancellation,
 	            teardown_batch_async);
@@ -1523,6 +2555,12 @@ main (int argc, char *argv[])
 	g_test_add_func ("/calendar/event/xml", test_event_xml);
 	g_test_add_func ("/calendar/event/xml/dates", test_event_xml_dates);
 	g_test_add_func ("/calendar/event/xml/recurrence", test_event_xml_recurrence);
+	g_test_add_func ("/calendar/event/xml/recurrence/lazy", test_event_xml_recurrence_lazy);
+	g_test_add_func ("/calendar/event/expander", test_event_expander);
+	g_test_add_func ("/calendar/query/events/multiple/unauthenticated", test_query_events_multiple_unauthenticated);
+	g_test_add_data_func ("/calendar/query/events/multiple", service, test_query_events_multiple);
+	g_test_add_func ("/calendar/free-busy-index", test_free_busy_index);
+	g_test_add_func ("/calendar/calendar-list/shared", test_calendar_list_shared);
 	g_test_add_func ("/calendar/event/escaping", test_event_escaping);
 
 	g_test_add_func ("/calendar/calendar/escaping", test_calendar_escaping);
@@ -133,6 +133,20 @@ set_up_client_login_authorizer_data_multiple_domains (ClientLoginAuthorizerData
 	connect_to_client_login_authorizer (data);
 }
 
+static void
+set_up_client_login_authorizer_data_several_domains (ClientLoginAuthorizerData *data, gconstpointer user_data)
+{
+	GList *authorization_domains = NULL;
+
+	authorization_domains = g_list_prepend (authorization_domains, gdata_youtube_service_get_primary_authorization_domain ());
+	authorization_domains = g_list_prepend (authorization_domains, gdata_picasaweb_service_get_primary_authorization_domain ());
+	authorization_domains = g_list_prepend (authorization_domains, gdata_calendar_service_get_primary_authorization_domain ());
+	data->authorizer = gdata_client_login_authorizer_new_for_authorization_domains ("client-id", authorization_domains);
+	g_list_free (authorization_domains);
+
+	connect_to_client_login_authorizer (data);
+}
+
 static void
 set_up_client_login_authorizer_data_authenticated (ClientLoginAuthorizerData *data, gconstpointer user_data)
 {
@@ -394,6 +408,54 @@ test_client_login_authorizer_authenticate_sync_multiple_domains (ClientLoginAuth
 	uhm_server_end_trace (mock_server);
 }
 
+static void
+assert_authorized_for_several_domains (ClientLoginAuthorizerData *data, gboolean authorized)
+{
+	g_assert (gdata_authorizer_is_authorized_for_domain (GDATA_AUTHORIZER (data->authorizer),
+	          gdata_youtube_service_get_primary_authorization_domain ()) == authorized);
+	g_assert (gdata_authorizer_is_authorized_for_domain (GDATA_AUTHORIZER (data->authorizer),
+	          gdata_picasaweb_service_get_primary_authorization_domain ()) == authorized);
+	g_assert (gdata_authorizer_is_authorized_for_domain (GDATA_AUTHORIZER (data->authorizer),
+	          gdata_calendar_service_get_primary_authorization_domain ()) == authorized);
+}
+
+/* Test that authentication against several authorization domains at once fails as a whole if one of the domains fails */
+static void
+test_client_login_authorizer_authenticate_sync_several_domains (ClientLoginAuthorizerData *data, gconstpointer user_data)
+{
+	gboolean success;
+	GError *error = NULL;
+
+	/* The domains are authenticated with concurrently, so the responses in the trace are handed out in whatever order the requests arrive.
+	 * The second time round, only the last request to arrive is rejected, so all three requests are always made. */
+	gdata_test_mock_server_start_trace (mock_server, "client-login-authorizer-authenticate-sync-several-domains");
+
+	pre_test_authentication (data);
+
+	/* Authenticate with all three domains */
+	success = gdata_client_login_authorizer_authenticate (data->authorizer, USERNAME, PASSWORD, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+	g_clear_error (&error);
+
+	assert_authorized_for_several_domains (data, TRUE);
+	g_assert_cmpstr (gdata_client_login_authorizer_get_username (data->authorizer), ==, USERNAME);
+	g_assert_cmpstr (gdata_client_login_authorizer_get_password (data->authorizer), ==, PASSWORD);
+
+	/* Authenticate again, but have one of the domains reject the password. The tokens the other domains returned are discarded along with
+	 * the old ones, rather than leaving the authorizer authorized for only some of its domains. */
+	success = gdata_client_login_authorizer_authenticate (data->authorizer, USERNAME, INCORRECT_PASSWORD, NULL, &error);
+	g_assert_error (error, GDATA_CLIENT_LOGIN_AUTHORIZER_ERROR, GDATA_CLIENT_LOGIN_AUTHORIZER_ERROR_BAD_AUTHENTICATION);
+	g_assert (success == FALSE);
+	g_clear_error (&error);
+
+	assert_authorized_for_several_domains (data, FALSE);
+	g_assert (gdata_client_login_authorizer_get_username (data->authorizer) == NULL);
+	g_assert (gdata_client_login_authorizer_get_password (data->authorizer) == NULL);
+
+	uhm_server_end_trace (mock_server);
+}
+
 /* Test that synchronous authentication can be cancelled */
 static void
 test_client_login_authorizer_authenticate_sync_cancellation (ClientLoginAuthorizerData *data, gconstpointer user_data)
@@ -689,6 +751,69 @@ test_client_login_authorizer_process_request_insecure_subprocess (ClientLoginAut
 	g_object_unref (message);
 }
 
+/* Test that saving the state of an authenticated authorizer and restoring it into a new authorizer gives an equivalent authorized authorizer */
+static void
+test_client_login_authorizer_save_state_authenticated (ClientLoginAuthorizerData *data, gconstpointer user_data)
+{
+	GDataClientLoginAuthorizer *new_authorizer;
+	GVariant *state;
+	SoupMessage *message, *new_message;
+	GError *error = NULL;
+
+	state = gdata_authorizer_save_state (GDATA_AUTHORIZER (data->authorizer));
+	g_assert (state != NULL);
+	g_assert (g_variant_is_of_type (state, G_VARIANT_TYPE_VARDICT) == TRUE);
+
+	/* Restore it into a new authorizer */
+	new_authorizer = gdata_client_login_authorizer_new ("client-id", GDATA_TYPE_YOUTUBE_SERVICE);
+	g_assert (gdata_authorizer_is_authorized_for_domain (GDATA_AUTHORIZER (new_authorizer),
+	                                                     gdata_youtube_service_get_primary_authorization_domain ()) == FALSE);
+
+	g_assert (gdata_authorizer_restore_state (GDATA_AUTHORIZER (new_authorizer), state, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert (gdata_authorizer_is_authorized_for_domain (GDATA_AUTHORIZER (new_authorizer),
+	                                                     gdata_youtube_service_get_primary_authorization_domain ()) == TRUE);
+	g_assert_cmpstr (gdata_client_login_authorizer_get_username (new_authorizer), ==, USERNAME);
+	g_assert (gdata_client_login_authorizer_get_password (new_authorizer) == NULL);
+
+	/* Both authorizers should authorize requests identically */
+	message = soup_message_new (SOUP_METHOD_GET, "https://example.com/");
+	new_message = soup_message_new (SOUP_METHOD_GET, "https://example.com/");
+
+	gdata_authorizer_process_request (GDATA_AUTHORIZER (data->authorizer), gdata_youtube_service_get_primary_authorization_domain (), message);
+	gdata_authorizer_process_request (GDATA_AUTHORIZER (new_authorizer), gdata_youtube_service_get_primary_authorization_domain (), new_message);
+
+	g_assert (soup_message_headers_get_one (message->request_headers, "Authorization") != NULL);
+	g_assert_cmpstr (soup_message_headers_get_one (new_message->request_headers, "Authorization"), ==,
+	                 soup_message_headers_get_one (message->request_headers, "Authorization"));
+
+	g_object_unref (new_message);
+	g_object_unref (message);
+	g_object_unref (new_authorizer);
+	g_variant_unref (state);
+}
+
+/* Test that restoring state saved by a different type of authorizer fails */
+static void
+test_client_login_authorizer_restore_state_invalid (ClientLoginAuthorizerData *data, gconstpointer user_data)
+{
+	GVariantBuilder builder;
+	GVariant *state;
+	GError *error = NULL;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	g_variant_builder_add (&builder, "{sv}", "type", g_variant_new_string ("GDataOAuth1Authorizer"));
+	g_variant_builder_add (&builder, "{sv}", "version", g_variant_new_uint32 (1));
+	state = g_variant_ref_sink (g_variant_builder_end (&builder));
+
+	g_assert (gdata_authorizer_restore_state (GDATA_AUTHORIZER (data->authorizer), state, &error) == FALSE);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA);
+	g_clear_error (&error);
+
+	g_variant_unref (state);
+}
+
 /* Test that processing a HTTP request (as opposed to the more normal HTTPS request) with an authenticated authorizer will abort rather than
  * transmitting the user's private auth token over an insecure HTTP connection. */
 static void
@@ -762,6 +887,9 @@ main (int argc, char *argv[])
 	            set_up_client_login_authorizer_data, test_client_login_authorizer_refresh_authorization,
 	            tear_down_client_login_authorizer_data);
 
+	g_test_add ("/client-login-authorizer/restore-state/invalid", ClientLoginAuthorizerData, NULL, set_up_client_login_authorizer_data,
+	            test_client_login_authorizer_restore_state_invalid, tear_down_client_login_authorizer_data);
+
 	g_test_add ("/client-login-authorizer/process-request/null", ClientLoginAuthorizerData, NULL,
 	            set_up_client_login_authorizer_data, test_client_login_authorizer_process_request_null, tear_down_client_login_authorizer_data);
 	g_test_add ("/client-login-authorizer/process-request/unauthenticated", ClientLoginAuthorizerData, NULL,
@@ -780,6 +908,9 @@ main (int argc, char *argv[])
 	g_test_add ("/client-login-authorizer/authenticate/sync/multiple-domains", ClientLoginAuthorizerData, NULL,
 	            set_up_client_login_authorizer_data_multiple_domains, test_client_login_authorizer_authenticate_sync_multiple_domains,
 	            tear_down_client_login_authorizer_data);
+	g_test_add ("/client-login-authorizer/authenticate/sync/several-domains", ClientLoginAuthorizerData, NULL,
+	            set_up_client_login_authorizer_data_several_domains, test_client_login_authorizer_authenticate_sync_several_domains,
+	            tear_down_client_login_authorizer_data);
 	g_test_add ("/client-login-authorizer/authenticate/sync/cancellation", ClientLoginAuthorizerData, NULL,
 	            set_up_client_login_authorizer_data, test_client_login_authorizer_authenticate_sync_cancellation,
 	            tear_down_client_login_authorizer_data);
@@ -803,6 +934,9 @@ main (int argc, char *argv[])
 	g_test_add ("/client-login-authorizer/process-request/authenticated", ClientLoginAuthorizerData, NULL,
 	            set_up_client_login_authorizer_data_authenticated, test_client_login_authorizer_process_request_authenticated,
 	            tear_down_client_login_authorizer_data);
+	g_test_add ("/client-login-authorizer/save-state/authenticated", ClientLoginAuthorizerData, NULL,
+	            set_up_client_login_authorizer_data_authenticated, test_client_login_authorizer_save_state_authenticated,
+	            tear_down_client_login_authorizer_data);
 	g_test_add ("/client-login-authorizer/process-request/insecure", ClientLoginAuthorizerData, NULL,
 	            set_up_client_login_authorizer_data_authenticated, test_client_login_authorizer_process_request_insecure,
 	            tear_down_client_login_authorizer_data);
@@ -1011,3 +1011,94 @@ gdata_test_mock_server_handle_message_timeout (UhmServer *server, SoupMessage *m
 
 	return TRUE;
 }
+
+static gboolean
+parse_entry_lazily_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, const gchar *entry_xml)
+{
+	gchar *feed_xml;
+
+	feed_xml = g_strconcat ("<?xml version='1.0' encoding='UTF-8'?>"
+	                        "<feed xmlns='http://www.w3.org/2005/Atom'>"
+	                        "<id>http://example.com/lazy-parsing</id>"
+	                        "<updated>2026-10-14T10:00:00Z</updated>"
+	                        "<title type='text'>Lazy parsing</title>",
+	                        entry_xml,
+	                        "</feed>", NULL);
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_TAKE, feed_xml, strlen (feed_xml));
+
+	return TRUE;
+}
+
+/**
+ * gdata_test_parse_entry_lazily:
+ * @server: a #UhmServer
+ * @entry_type: the type of entry to parse
+ * @entry_xml: the XML of a single entry, without an XML declaration
+ *
+ * Parses @entry_xml as an entry of type @entry_type, as gdata_parsable_new_from_xml() would, but with #GDataQuery:lazy-parsing set, so that any
+ * child elements which the entry's class defers are left unparsed. Deferral only happens when parsing query results, so this serves a feed
+ * containing just @entry_xml from @server and queries it. @server mustn't be running, and must resolve <literal>www.google.com</literal> to itself.
+ *
+ * Return value: (transfer full): the parsed entry
+ *
+ * Since: 0.15.0
+ */
+GDataEntry *
+gdata_test_parse_entry_lazily (UhmServer *server, GType entry_type, const gchar *entry_xml)
+{
+	GDataService *service;
+	GDataQuery *query;
+	GDataFeed *feed;
+	GDataEntry *entry;
+	gulong handler_id;
+	GError *error = NULL;
+
+	handler_id = g_signal_connect (server, "handle-message", (GCallback) parse_entry_lazily_handle_message_cb, (gpointer) entry_xml);
+	uhm_server_run (server);
+	gdata_test_set_https_port (server);
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	query = gdata_query_new (NULL);
+	gdata_query_set_lazy_parsing (query, TRUE);
+
+	feed = gdata_service_query (service, NULL, "https://www.google.com/feeds/lazy-parsing", query, entry_type, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	uhm_server_stop (server);
+	g_signal_handler_disconnect (server, handler_id);
+
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (feed)), ==, 1);
+	entry = g_object_ref (gdata_feed_get_entries (feed)->data);
+	g_assert (G_TYPE_CHECK_INSTANCE_TYPE (entry, entry_type));
+
+	g_object_unref (feed);
+	g_object_unref (query);
+	g_object_unref (service);
+
+	return entry;
+}
+
+/**
+ * gdata_test_count_parsables:
+ * @parsable_type: a #GDataParsable subtype
+ *
+ * Returns the number of live instances of exactly @parsable_type, as counted by gdata_parsable_get_accounts(). Accounting must have been enabled
+ * using gdata_parsable_set_accounting_enabled() before any of the instances of interest were created.
+ *
+ * Return value: the number of live instances of @parsable_type
+ *
+ * Since: 0.15.0
+ */
+guint
+gdata_test_count_parsables (GType parsable_type)
+{
+	guint n_instances;
+
+	g_assert (gdata_parsable_get_accounting_enabled () == TRUE);
+	gdata_parsable_get_accounts (parsable_type, &n_instances, NULL);
+
+	return n_instances;
+}
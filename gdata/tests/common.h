@@ -340,6 +340,9 @@ void gdata_test_mock_server_start_trace (UhmServer *server, const gchar *trace_f
 gboolean gdata_test_mock_server_handle_message_error (UhmServer *server, SoupMessage *message, SoupClientContext *client, gpointer user_data);
 gboolean gdata_test_mock_server_handle_message_timeout (UhmServer *server, SoupMessage *message, SoupClientContext *client, gpointer user_data);
 
+GDataEntry *gdata_test_parse_entry_lazily (UhmServer *server, GType entry_type, const gchar *entry_xml) G_GNUC_WARN_UNUSED_RESULT;
+guint gdata_test_count_parsables (GType parsable_type);
+
 G_END_DECLS
 
 #endif /* !GDATA_TEST_COMMON_H */
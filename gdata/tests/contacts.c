@@ -18,6 +18,7 @@
  */
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <unistd.h>
 #include <string.h>
 
@@ -233,6 +234,52 @@ test_query_all_contacts (QueryAllContactsData *data, gconstpointer service)
 	uhm_server_end_trace (mock_server);
 }
 
+static void
+request_completed_cb (GDataService *service, GDataRequestRecord *record, GDataRequestRecord **record_out)
+{
+	g_assert (*record_out == NULL);
+	*record_out = gdata_request_record_copy (record);
+}
+
+static void
+test_query_all_contacts_request_completed (QueryAllContactsData *data, gconstpointer service)
+{
+	GDataFeed *feed;
+	GDataRequestRecord *record = NULL;
+	gulong handler_id;
+	GError *error = NULL;
+
+	gdata_test_mock_server_start_trace (mock_server, "query-all-contacts");
+
+	handler_id = g_signal_connect (G_OBJECT (service), "request-completed", (GCallback) request_completed_cb, &record);
+
+	feed = gdata_contacts_service_query_contacts (GDATA_CONTACTS_SERVICE (service), NULL, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	g_signal_handler_disconnect (G_OBJECT (service), handler_id);
+
+	/* Check the request was recorded */
+	g_assert (record != NULL);
+	g_assert_cmpint (record->operation_type, ==, GDATA_OPERATION_QUERY);
+	g_assert (record->domain == gdata_contacts_service_get_primary_authorization_domain ());
+	g_assert_cmpstr (record->method, ==, "GET");
+	g_assert (g_str_has_suffix (record->uri, "/m8/feeds/contacts/default/full") == TRUE);
+	g_assert_cmpuint (record->status, ==, SOUP_STATUS_OK);
+	g_assert_cmpuint (record->retry_count, ==, 0);
+	g_assert_cmpint (record->queue_time, >=, 0);
+	g_assert_cmpint (record->time_to_first_byte, >=, 0);
+	g_assert_cmpint (record->transfer_time, >=, 0);
+	g_assert_cmpint (record->parse_time, >=, 0);
+	g_assert_cmpuint (record->bytes_in, >, 0);
+	g_assert_cmpuint (record->bytes_out, ==, 0);
+
+	gdata_request_record_free (record);
+	g_object_unref (feed);
+
+	uhm_server_end_trace (mock_server);
+}
+
 GDATA_ASYNC_CLOSURE_FUNCTIONS (query_all_contacts, QueryAllContactsData);
 
 GDATA_ASYNC_TEST_FUNCTIONS (query_all_contacts, QueryAllContactsData,
@@ -1764,6 +1811,78 @@ test_contact_parser_error_handling (void)
 #undef TEST_XML_ERROR_HANDLING
 }
 
+static void
+test_contact_summary_parser (void)
+{
+	GDataContactsContactSummary *summary;
+	gchar *full_name, *primary_email_address, *photo_etag;
+	GError *error = NULL;
+
+	summary = GDATA_CONTACTS_CONTACT_SUMMARY (gdata_parsable_new_from_xml (GDATA_TYPE_CONTACTS_CONTACT_SUMMARY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' "
+			"xmlns:gd='http://schemas.google.com/g/2005' "
+			"xmlns:gContact='http://schemas.google.com/contact/2008' "
+			"gd:etag='&quot;QngzcDVSLyp7ImA9WxJTFkoITgU.&quot;'>"
+			"<id>http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/base/1b46cdd20bfbee3b</id>"
+			"<updated>2009-04-25T15:21:53.688Z</updated>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>"
+			"<title>Bob</title>"
+			"<link rel='http://schemas.google.com/contacts/2008/rel#photo' type='image/*' "
+			      "href='http://www.google.com/m8/feeds/photos/media/libgdata.test@googlemail.com/1b46cdd20bfbee3b' "
+			      "gd:etag='&quot;abcdef&quot;'/>"
+			"<gd:name><gd:givenName>Bob</gd:givenName><gd:fullName>Bob Smith</gd:fullName></gd:name>"
+			"<gd:email rel='http://schemas.google.com/g/2005#other' address='bob@example.com'/>"
+			"<gd:email rel='http://schemas.google.com/g/2005#work' address='bob@work.example.com' primary='true'/>"
+			"<gd:email rel='http://schemas.google.com/g/2005#home' address='bob@home.example.com'/>"
+			"<gContact:nickname>Bobby</gContact:nickname>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_CONTACTS_CONTACT_SUMMARY (summary));
+	gdata_test_compare_kind (GDATA_ENTRY (summary), "http://schemas.google.com/contact/2008#contact", NULL);
+
+	/* Check the summarised properties, including that the primary e-mail address wins over the one listed first */
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (summary)), ==,
+	                 "http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/base/1b46cdd20bfbee3b");
+	g_assert_cmpstr (gdata_entry_get_etag (GDATA_ENTRY (summary)), ==, "\"QngzcDVSLyp7ImA9WxJTFkoITgU.\"");
+	g_assert_cmpstr (gdata_contacts_contact_summary_get_full_name (summary), ==, "Bob Smith");
+	g_assert_cmpstr (gdata_contacts_contact_summary_get_primary_email_address (summary), ==, "bob@work.example.com");
+	g_assert_cmpstr (gdata_contacts_contact_summary_get_photo_etag (summary), ==, "\"abcdef\"");
+
+	g_object_get (G_OBJECT (summary),
+	              "full-name", &full_name,
+	              "primary-email-address", &primary_email_address,
+	              "photo-etag", &photo_etag,
+	              NULL);
+
+	g_assert_cmpstr (full_name, ==, "Bob Smith");
+	g_assert_cmpstr (primary_email_address, ==, "bob@work.example.com");
+	g_assert_cmpstr (photo_etag, ==, "\"abcdef\"");
+
+	g_free (full_name);
+	g_free (primary_email_address);
+	g_free (photo_etag);
+
+	g_object_unref (summary);
+
+	/* Without a primary address, the first one should be used */
+	summary = GDATA_CONTACTS_CONTACT_SUMMARY (gdata_parsable_new_from_xml (GDATA_TYPE_CONTACTS_CONTACT_SUMMARY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/base/1b46cdd20bfbee3b</id>"
+			"<updated>2009-04-25T15:21:53.688Z</updated>"
+			"<title></title>"
+			"<gd:email rel='http://schemas.google.com/g/2005#other' address='bob@example.com'/>"
+			"<gd:email rel='http://schemas.google.com/g/2005#home' address='bob@home.example.com'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_CONTACTS_CONTACT_SUMMARY (summary));
+
+	g_assert (gdata_contacts_contact_summary_get_full_name (summary) == NULL);
+	g_assert_cmpstr (gdata_contacts_contact_summary_get_primary_email_address (summary), ==, "bob@example.com");
+	g_assert (gdata_contacts_contact_summary_get_photo_etag (summary) == NULL);
+
+	g_object_unref (summary);
+}
+
 static void
 test_group_properties (void)
 {
@@ -2161,6 +2280,74 @@ G_STMT_START {
 	g_free (photo_data);
 } G_STMT_END);
 
+static void
+test_photo_add_from_stream (TempContactData *data, gconstpointer service)
+{
+	GFile *photo_file;
+	GFileInputStream *photo_stream;
+	gboolean retval;
+	GError *error = NULL;
+
+	/* This makes the same request as test_photo_add(), but with the photo streamed from the file rather than loaded into memory first */
+	gdata_test_mock_server_start_trace (mock_server, "photo-add");
+
+	photo_file = g_file_new_for_path (TEST_FILE_DIR "photo.jpg");
+	photo_stream = g_file_read (photo_file, NULL, &error);
+	g_assert_no_error (error);
+
+	retval = gdata_contacts_contact_set_photo_from_stream (data->contact, GDATA_CONTACTS_SERVICE (service), G_INPUT_STREAM (photo_stream),
+	                                                       "image/jpeg", NULL, &error);
+	g_assert_no_error (error);
+	g_assert (retval == TRUE);
+
+	/* The photo's new ETag is taken from the response */
+	g_assert_cmpstr (gdata_contacts_contact_get_photo_etag (data->contact), ==, "\"RmtJPnAWSit7I2A9KxQuEiQCNkcWGnsvRA8.\"");
+
+	g_object_unref (photo_stream);
+	g_object_unref (photo_file);
+
+	uhm_server_end_trace (mock_server);
+}
+
+static void
+test_photo_get_to_stream (TempContactData *data, gconstpointer service)
+{
+	GOutputStream *photo_stream;
+	const guint8 *photo_data;
+	gchar *content_type = NULL;
+	gboolean retval;
+	GError *error = NULL;
+
+	/* This makes the same request as test_photo_get(), but with the photo streamed into the output stream as it's downloaded */
+	gdata_test_mock_server_start_trace (mock_server, "photo-get");
+
+	g_assert (gdata_contacts_contact_get_photo_etag (data->contact) != NULL);
+
+	photo_stream = g_memory_output_stream_new_resizable ();
+
+	retval = gdata_contacts_contact_get_photo_to_stream (data->contact, GDATA_CONTACTS_SERVICE (service), photo_stream, &content_type, NULL,
+	                                                     &error);
+	g_assert_no_error (error);
+	g_assert (retval == TRUE);
+	g_assert_cmpstr (content_type, ==, "image/jpeg");
+
+	/* The whole photo was written to the stream, which was left open */
+	g_assert (g_output_stream_is_closed (photo_stream) == FALSE);
+	g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (photo_stream)), >, 2);
+
+	photo_data = g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (photo_stream));
+	g_assert_cmpuint (photo_data[0], ==, 0xff); /* JPEG start of image marker */
+	g_assert_cmpuint (photo_data[1], ==, 0xd8);
+
+	/* The photo's ETag is updated from the response */
+	g_assert_cmpstr (gdata_contacts_contact_get_photo_etag (data->contact), ==, "\"LA9-MXQRfCt7I2BuDXFTQzcJIgBFemkvdgg.\"");
+
+	g_free (content_type);
+	g_object_unref (photo_stream);
+
+	uhm_server_end_trace (mock_server);
+}
+
 static void
 test_photo_delete (TempContactData *data, gconstpointer service)
 {
@@ -2529,6 +2716,548 @@ test_contact_id (void)
 	g_object_unref (contact);
 }
 
+static void
+test_group_index (void)
+{
+	GDataContactsGroupIndex *index;
+	GDataContactsContact *contact1, *contact2;
+	GList *members, *groups;
+
+	contact1 = gdata_contacts_contact_new (NULL);
+	gdata_contacts_contact_add_group (contact1, "http://foo.com/group1");
+	gdata_contacts_contact_add_group (contact1, "http://foo.com/group2");
+
+	contact2 = gdata_contacts_contact_new (NULL);
+	gdata_contacts_contact_add_group (contact2, "http://foo.com/group1");
+
+	/* Index the contacts */
+	index = gdata_contacts_group_index_new (NULL);
+	gdata_contacts_group_index_add_contact (index, contact1);
+	gdata_contacts_group_index_add_contact (index, contact2);
+	gdata_contacts_group_index_add_contact (index, contact2); /* no-op */
+
+	g_assert_cmpuint (gdata_contacts_group_index_get_n_contacts (index, "http://foo.com/group1"), ==, 2);
+	g_assert_cmpuint (gdata_contacts_group_index_get_n_contacts (index, "http://foo.com/group2"), ==, 1);
+	g_assert_cmpuint (gdata_contacts_group_index_get_n_contacts (index, "http://notagroup.com/"), ==, 0);
+
+	members = gdata_contacts_group_index_get_contacts (index, "http://foo.com/group2");
+	g_assert_cmpuint (g_list_length (members), ==, 1);
+	g_assert (members->data == contact1);
+	g_list_free (members);
+
+	groups = gdata_contacts_group_index_get_groups (index);
+	g_assert_cmpuint (g_list_length (groups), ==, 2);
+	g_list_free (groups);
+
+	/* Changing the contacts' groups should update the index */
+	gdata_contacts_contact_remove_group (contact1, "http://foo.com/group2");
+	gdata_contacts_contact_add_group (contact2, "http://foo.com/group3");
+
+	g_assert_cmpuint (gdata_contacts_group_index_get_n_contacts (index, "http://foo.com/group2"), ==, 0);
+
+	members = gdata_contacts_group_index_get_contacts (index, "http://foo.com/group3");
+	g_assert_cmpuint (g_list_length (members), ==, 1);
+	g_assert (members->data == contact2);
+	g_list_free (members);
+
+	groups = gdata_contacts_group_index_get_groups (index);
+	g_assert_cmpuint (g_list_length (groups), ==, 2);
+	g_list_free (groups);
+
+	/* Removing a contact from the index should remove it from all its groups, and stop the index tracking it */
+	gdata_contacts_group_index_remove_contact (index, contact2);
+
+	members = gdata_contacts_group_index_get_contacts (index, "http://foo.com/group1");
+	g_assert_cmpuint (g_list_length (members), ==, 1);
+	g_assert (members->data == contact1);
+	g_list_free (members);
+
+	g_assert_cmpuint (gdata_contacts_group_index_get_n_contacts (index, "http://foo.com/group3"), ==, 0);
+	gdata_contacts_contact_add_group (contact2, "http://foo.com/group4");
+	g_assert_cmpuint (gdata_contacts_group_index_get_n_contacts (index, "http://foo.com/group4"), ==, 0);
+
+	g_object_unref (index);
+
+	/* The contacts should outlive the index without any handlers left connected */
+	gdata_contacts_contact_add_group (contact1, "http://foo.com/group5");
+
+	g_object_unref (contact2);
+	g_object_unref (contact1);
+}
+
+static GDataContactsContact *
+build_merge_index_contact (const gchar *id, const gchar *email_address, const gchar *phone_number)
+{
+	GDataContactsContact *contact;
+	gchar *xml;
+	GError *error = NULL;
+
+	xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/base/%s</id>"
+			"<title>Contact</title>"
+			"%s%s%s"
+			"%s%s%s"
+		"</entry>", id,
+		(email_address != NULL) ? "<gd:email rel='http://schemas.google.com/g/2005#work' address='" : "",
+		(email_address != NULL) ? email_address : "", (email_address != NULL) ? "'/>" : "",
+		(phone_number != NULL) ? "<gd:phoneNumber rel='http://schemas.google.com/g/2005#mobile'>" : "",
+		(phone_number != NULL) ? phone_number : "", (phone_number != NULL) ? "</gd:phoneNumber>" : "");
+	contact = GDATA_CONTACTS_CONTACT (gdata_parsable_new_from_xml (GDATA_TYPE_CONTACTS_CONTACT, xml, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_CONTACTS_CONTACT (contact));
+	g_free (xml);
+
+	return contact;
+}
+
+static void
+test_merge_index (void)
+{
+	GDataContactsMergeIndex *index;
+	GDataContactsContact *contact1, *contact2, *contact3, *contact4, *contact2_updated;
+	GList *duplicates, *sets;
+
+	/* 1 and 2 share a Gmail address written differently; 2 and 3 share a phone number written differently; 4 is unrelated */
+	contact1 = build_merge_index_contact ("1", "John.Smith@gmail.com", NULL);
+	contact2 = build_merge_index_contact ("2", "johnsmith+work@googlemail.com", "+44 20 7946 0018");
+	contact3 = build_merge_index_contact ("3", NULL, "020 7946 0018");
+	contact4 = build_merge_index_contact ("4", "jane@example.com", "555-0100");
+
+	index = gdata_contacts_merge_index_new ();
+	gdata_contacts_merge_index_add_contact (index, contact1);
+	gdata_contacts_merge_index_add_contact (index, contact2);
+	gdata_contacts_merge_index_add_contact (index, contact3);
+	gdata_contacts_merge_index_add_contact (index, contact4);
+	g_assert_cmpuint (gdata_contacts_merge_index_get_n_contacts (index), ==, 4);
+
+	/* Duplication should be transitive */
+	duplicates = gdata_contacts_merge_index_get_duplicates (index, contact1);
+	g_assert_cmpuint (g_list_length (duplicates), ==, 2);
+	g_assert (g_list_find (duplicates, contact2) != NULL);
+	g_assert (g_list_find (duplicates, contact3) != NULL);
+	g_list_free (duplicates);
+
+	g_assert (gdata_contacts_merge_index_get_duplicates (index, contact4) == NULL);
+
+	sets = gdata_contacts_merge_index_get_duplicate_sets (index);
+	g_assert_cmpuint (g_list_length (sets), ==, 1);
+	g_assert_cmpuint (g_list_length (sets->data), ==, 3);
+	g_list_free_full (sets, (GDestroyNotify) g_list_free);
+
+	/* Updating contact 2 so it no longer shares anything should split the set */
+	contact2_updated = build_merge_index_contact ("2", "someone.else@example.com", NULL);
+	gdata_contacts_merge_index_add_contact (index, contact2_updated);
+	g_assert_cmpuint (gdata_contacts_merge_index_get_n_contacts (index), ==, 4);
+
+	g_assert (gdata_contacts_merge_index_get_duplicates (index, contact1) == NULL);
+	g_assert (gdata_contacts_merge_index_get_duplicate_sets (index) == NULL);
+
+	/* Removing contacts should work by ID, and ignore unknown IDs */
+	gdata_contacts_merge_index_remove_contact (index, gdata_entry_get_id (GDATA_ENTRY (contact3)));
+	gdata_contacts_merge_index_remove_contact (index, "http://example.com/not-a-contact");
+	g_assert_cmpuint (gdata_contacts_merge_index_get_n_contacts (index), ==, 3);
+
+	g_object_unref (index);
+
+	g_object_unref (contact2_updated);
+	g_object_unref (contact4);
+	g_object_unref (contact3);
+	g_object_unref (contact2);
+	g_object_unref (contact1);
+}
+
+static void
+test_batch_contacts_empty (void)
+{
+	GDataContactsService *service;
+	GError *error = NULL;
+
+	/* Batching no contacts should succeed without making any requests (which would fail, since the service isn't authenticated) */
+	service = gdata_contacts_service_new (NULL);
+
+	g_assert (gdata_contacts_service_insert_contacts (service, NULL, NULL, NULL, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert (gdata_contacts_service_update_contacts (service, NULL, NULL, NULL, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert (gdata_contacts_service_delete_contacts (service, NULL, NULL, NULL, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_object_unref (service);
+}
+
+#define BATCH_CONTACTS_N_CONTACTS 2
+
+typedef struct {
+	GDataContactsContact *contacts[BATCH_CONTACTS_N_CONTACTS]; /* the contacts passed in */
+	GDataContactsContact *results[BATCH_CONTACTS_N_CONTACTS]; /* the contacts returned by the server, if any */
+	GError *errors[BATCH_CONTACTS_N_CONTACTS];
+	guint n_results;
+} BatchContactsResults;
+
+static void
+batch_contacts_results_clear (BatchContactsResults *results)
+{
+	guint i;
+
+	for (i = 0; i < BATCH_CONTACTS_N_CONTACTS; i++) {
+		g_clear_object (&(results->results[i]));
+		g_clear_error (&(results->errors[i]));
+	}
+
+	results->n_results = 0;
+}
+
+static void
+batch_contacts_cb (guint index, GDataContactsContact *contact, GDataContactsContact *result, GError *error, BatchContactsResults *results)
+{
+	/* Each contact should be reported exactly once, with its position in the list */
+	g_assert_cmpuint (index, <, BATCH_CONTACTS_N_CONTACTS);
+	g_assert (contact == results->contacts[index]);
+	g_assert (results->results[index] == NULL && results->errors[index] == NULL);
+	g_assert (result == NULL || error == NULL);
+
+	results->results[index] = (result != NULL) ? g_object_ref (result) : NULL;
+	results->errors[index] = (error != NULL) ? g_error_copy (error) : NULL;
+	results->n_results++;
+}
+
+static GList *
+batch_contacts_results_set_contacts (BatchContactsResults *results, GDataContactsContact *contact1, GDataContactsContact *contact2)
+{
+	results->contacts[0] = contact1;
+	results->contacts[1] = contact2;
+
+	return g_list_append (g_list_append (NULL, contact1), contact2);
+}
+
+static void
+test_batch_contacts (gconstpointer service)
+{
+	GDataContactsContact *alice, *bob, *inserted_alice, *inserted_bob;
+	GDataGDName *name;
+	BatchContactsResults results = { { NULL, }, };
+	GList *contacts;
+	GError *error = NULL;
+
+	/* The trace is hand-written, so there's nothing to check against online */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping contact batch test when online or logging.");
+		return;
+	}
+
+	gdata_test_mock_server_start_trace (mock_server, "batch-contacts");
+
+	name = gdata_gd_name_new ("Alice", NULL);
+	alice = gdata_contacts_contact_new (NULL);
+	gdata_contacts_contact_set_name (alice, name);
+	g_object_unref (name);
+
+	name = gdata_gd_name_new ("Bob", NULL);
+	bob = gdata_contacts_contact_new (NULL);
+	gdata_contacts_contact_set_name (bob, name);
+	g_object_unref (name);
+
+	/* Insert both contacts in one request. The server answers out of order, but each result should be matched to its contact. */
+	contacts = batch_contacts_results_set_contacts (&results, alice, bob);
+	g_assert (gdata_contacts_service_insert_contacts (GDATA_CONTACTS_SERVICE (service), contacts, NULL,
+	                                                  (GDataContactsServiceBatchCallback) batch_contacts_cb, &results, &error) == TRUE);
+	g_assert_no_error (error);
+	g_list_free (contacts);
+
+	g_assert_cmpuint (results.n_results, ==, 2);
+	g_assert_no_error (results.errors[0]);
+	g_assert_no_error (results.errors[1]);
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (results.results[0])), ==, "Alice");
+	g_assert_cmpstr (gdata_entry_get_etag (GDATA_ENTRY (results.results[0])), ==, "\"etag1\"");
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (results.results[1])), ==, "Bob");
+	g_assert_cmpstr (gdata_entry_get_etag (GDATA_ENTRY (results.results[1])), ==, "\"etag2\"");
+
+	inserted_alice = g_object_ref (results.results[0]);
+	inserted_bob = g_object_ref (results.results[1]);
+	batch_contacts_results_clear (&results);
+
+	/* Update both. Bob has been changed on the server since he was inserted, so only Alice's update succeeds; but that doesn't fail the batch
+	 * as a whole. */
+	name = gdata_gd_name_new ("Alice", "Smith");
+	gdata_contacts_contact_set_name (inserted_alice, name);
+	g_object_unref (name);
+
+	contacts = batch_contacts_results_set_contacts (&results, inserted_alice, inserted_bob);
+	g_assert (gdata_contacts_service_update_contacts (GDATA_CONTACTS_SERVICE (service), contacts, NULL,
+	                                                  (GDataContactsServiceBatchCallback) batch_contacts_cb, &results, &error) == TRUE);
+	g_assert_no_error (error);
+	g_list_free (contacts);
+
+	g_assert_cmpuint (results.n_results, ==, 2);
+	g_assert_no_error (results.errors[0]);
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (results.results[0])), ==, "Alice Smith");
+	g_assert_cmpstr (gdata_entry_get_etag (GDATA_ENTRY (results.results[0])), ==, "\"etag3\"");
+	g_assert_error (results.errors[1], GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_CONFLICT);
+	g_assert (results.results[1] == NULL);
+
+	g_object_unref (inserted_alice);
+	inserted_alice = g_object_ref (results.results[0]);
+	batch_contacts_results_clear (&results);
+
+	/* Delete both. Alice has already been deleted elsewhere. Successful deletions don't return a contact. */
+	contacts = batch_contacts_results_set_contacts (&results, inserted_alice, inserted_bob);
+	g_assert (gdata_contacts_service_delete_contacts (GDATA_CONTACTS_SERVICE (service), contacts, NULL,
+	                                                  (GDataContactsServiceBatchCallback) batch_contacts_cb, &results, &error) == TRUE);
+	g_assert_no_error (error);
+	g_list_free (contacts);
+
+	g_assert_cmpuint (results.n_results, ==, 2);
+	g_assert_error (results.errors[0], GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+	g_assert (results.results[0] == NULL);
+	g_assert_no_error (results.errors[1]);
+	g_assert (results.results[1] == NULL);
+
+	batch_contacts_results_clear (&results);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (inserted_bob);
+	g_object_unref (inserted_alice);
+	g_object_unref (bob);
+	g_object_unref (alice);
+}
+
+/* A synchronisation store which keeps the titles of its contacts in a hash table, and which can be made to fail to apply a given contact */
+#define TYPE_TEST_CONTACTS_STORE	(test_contacts_store_get_type ())
+#define TEST_CONTACTS_STORE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), TYPE_TEST_CONTACTS_STORE, TestContactsStore))
+
+typedef struct {
+	GObject parent;
+	GHashTable *contacts; /* contact ID → title */
+	gint64 watermark;
+	guint n_watermarks_set;
+	const gchar *fail_id;
+} TestContactsStore;
+
+typedef struct {
+	GObjectClass parent;
+} TestContactsStoreClass;
+
+static GType test_contacts_store_get_type (void) G_GNUC_CONST;
+static void test_contacts_store_sync_store_init (GDataContactsSyncStoreInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestContactsStore, test_contacts_store, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_CONTACTS_SYNC_STORE, test_contacts_store_sync_store_init))
+
+static void
+test_contacts_store_finalize (GObject *object)
+{
+	g_hash_table_unref (TEST_CONTACTS_STORE (object)->contacts);
+
+	G_OBJECT_CLASS (test_contacts_store_parent_class)->finalize (object);
+}
+
+static void
+test_contacts_store_class_init (TestContactsStoreClass *klass)
+{
+	G_OBJECT_CLASS (klass)->finalize = test_contacts_store_finalize;
+}
+
+static void
+test_contacts_store_init (TestContactsStore *self)
+{
+	self->contacts = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	self->watermark = -1;
+}
+
+static gint64
+test_contacts_store_get_watermark (GDataContactsSyncStore *self)
+{
+	return TEST_CONTACTS_STORE (self)->watermark;
+}
+
+static gboolean
+test_contacts_store_set_watermark (GDataContactsSyncStore *self, gint64 watermark, GError **error)
+{
+	TEST_CONTACTS_STORE (self)->watermark = watermark;
+	TEST_CONTACTS_STORE (self)->n_watermarks_set++;
+
+	return TRUE;
+}
+
+static gboolean
+test_contacts_store_apply_contact (GDataContactsSyncStore *self, GDataContactsContact *contact, GError **error)
+{
+	TestContactsStore *store = TEST_CONTACTS_STORE (self);
+
+	if (g_strcmp0 (gdata_entry_get_id (GDATA_ENTRY (contact)), store->fail_id) == 0) {
+		g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE, "Store is full.");
+		return FALSE;
+	}
+
+	g_hash_table_replace (store->contacts, g_strdup (gdata_entry_get_id (GDATA_ENTRY (contact))),
+	                      g_strdup (gdata_entry_get_title (GDATA_ENTRY (contact))));
+
+	return TRUE;
+}
+
+static gboolean
+test_contacts_store_remove_contact (GDataContactsSyncStore *self, const gchar *contact_id, GError **error)
+{
+	g_hash_table_remove (TEST_CONTACTS_STORE (self)->contacts, contact_id);
+
+	return TRUE;
+}
+
+static void
+test_contacts_store_sync_store_init (GDataContactsSyncStoreInterface *iface)
+{
+	iface->get_watermark = test_contacts_store_get_watermark;
+	iface->set_watermark = test_contacts_store_set_watermark;
+	iface->apply_contact = test_contacts_store_apply_contact;
+	iface->remove_contact = test_contacts_store_remove_contact;
+}
+
+#define SYNC_CONTACT_ID(N) "http://www.google.com/m8/feeds/contacts/libgdata.test%40googlemail.com/base/" N
+
+static void
+test_sync (gconstpointer service)
+{
+	TestContactsStore *store;
+	GDataContactsSync *sync;
+	guint n_changed, n_removed;
+	GError *error = NULL;
+
+	/* The trace is hand-written, so there's nothing to check against online */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping synchronisation test when online or logging.");
+		return;
+	}
+
+	store = g_object_new (TYPE_TEST_CONTACTS_STORE, NULL);
+	sync = gdata_contacts_sync_new (GDATA_CONTACTS_SERVICE (service), GDATA_CONTACTS_SYNC_STORE (store));
+	gdata_contacts_sync_set_page_size (sync, 2);
+
+	gdata_test_mock_server_start_trace (mock_server, "sync");
+
+	/* The store's never been synchronised, so every contact should be downloaded, across both pages */
+	g_assert (gdata_contacts_sync_run (sync, NULL, &n_changed, &n_removed, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert_cmpuint (n_changed, ==, 3);
+	g_assert_cmpuint (n_removed, ==, 0);
+	g_assert_cmpuint (g_hash_table_size (store->contacts), ==, 3);
+	g_assert_cmpstr (g_hash_table_lookup (store->contacts, SYNC_CONTACT_ID ("c1")), ==, "Alice");
+	g_assert_cmpstr (g_hash_table_lookup (store->contacts, SYNC_CONTACT_ID ("c2")), ==, "Bob");
+	g_assert_cmpstr (g_hash_table_lookup (store->contacts, SYNC_CONTACT_ID ("c3")), ==, "Carol");
+
+	/* The watermark is the server's time at the first page (2026-10-14T10:00:00Z) */
+	g_assert_cmpint (store->watermark, ==, 1791972000);
+	g_assert_cmpuint (store->n_watermarks_set, ==, 1);
+
+	/* Synchronise again with a new GDataContactsSync, so the watermark has to come from the store. Only the changes since the watermark (less
+	 * the clock skew margin) should be queried for, including deletions. */
+	g_object_unref (sync);
+	sync = gdata_contacts_sync_new (GDATA_CONTACTS_SERVICE (service), GDATA_CONTACTS_SYNC_STORE (store));
+	gdata_contacts_sync_set_page_size (sync, 2);
+
+	g_assert (gdata_contacts_sync_run (sync, NULL, &n_changed, &n_removed, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert_cmpuint (n_changed, ==, 1);
+	g_assert_cmpuint (n_removed, ==, 1);
+	g_assert_cmpuint (g_hash_table_size (store->contacts), ==, 2);
+	g_assert_cmpstr (g_hash_table_lookup (store->contacts, SYNC_CONTACT_ID ("c1")), ==, "Alice");
+	g_assert_cmpstr (g_hash_table_lookup (store->contacts, SYNC_CONTACT_ID ("c2")), ==, "Bob Smith");
+	g_assert (g_hash_table_lookup (store->contacts, SYNC_CONTACT_ID ("c3")) == NULL);
+
+	g_assert_cmpint (store->watermark, ==, 1791975600);
+	g_assert_cmpuint (store->n_watermarks_set, ==, 2);
+
+	/* If the store fails part-way through, the watermark mustn't move on, so that the next run re-applies the changes */
+	store->fail_id = SYNC_CONTACT_ID ("c4");
+
+	g_assert (gdata_contacts_sync_run (sync, NULL, &n_changed, &n_removed, &error) == FALSE);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE);
+	g_clear_error (&error);
+
+	g_assert_cmpuint (n_changed, ==, 1);
+	g_assert_cmpuint (n_removed, ==, 0);
+	g_assert_cmpstr (g_hash_table_lookup (store->contacts, SYNC_CONTACT_ID ("c1")), ==, "Alice Jones");
+	g_assert (g_hash_table_lookup (store->contacts, SYNC_CONTACT_ID ("c4")) == NULL);
+
+	g_assert_cmpint (store->watermark, ==, 1791975600);
+	g_assert_cmpuint (store->n_watermarks_set, ==, 2);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (sync);
+	g_object_unref (store);
+}
+
+#undef SYNC_CONTACT_ID
+
+static void
+test_photo_cache (void)
+{
+	GDataContactsService *service;
+	GDataContactsContact *contact;
+	gchar *cache_dir, *checksum, *path, *content_type = NULL;
+	guint8 *data;
+	gsize length = 0;
+	GError *error = NULL;
+
+	contact = GDATA_CONTACTS_CONTACT (gdata_parsable_new_from_xml (GDATA_TYPE_CONTACTS_CONTACT,
+		"<entry xmlns='http://www.w3.org/2005/Atom' "
+			"xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/full/1b46cdd20bfbee3b</id>"
+			"<updated>2009-04-25T15:21:53.688Z</updated>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>"
+			"<title>Foobar</title>"
+			"<link rel='http://schemas.google.com/contacts/2008/rel#photo' type='image/*' gd:etag='\"abc\"' "
+			      "href='http://www.google.com/m8/feeds/photos/media/libgdata.test@googlemail.com/1b46cdd20bfbee3b'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert_cmpstr (gdata_contacts_contact_get_photo_etag (contact), ==, "\"abc\"");
+
+	/* Prefetching without a cache should do nothing (rather than making any requests) */
+	service = gdata_contacts_service_new (NULL);
+	g_assert (gdata_contacts_service_prefetch_photos (service, NULL, NULL, NULL, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	/* Seed a disk cache with the photo for the contact's current ETag; getting the photo should then be answered from the cache, without
+	 * making any requests (which would fail, since the service isn't authenticated) */
+	cache_dir = g_dir_make_tmp ("libgdata-contacts-photo-cache-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, gdata_entry_get_id (GDATA_ENTRY (contact)), -1);
+	path = g_build_filename (cache_dir, checksum, NULL);
+	g_assert (g_file_set_contents (path, "\"abc\"\nimage/png\nPNGDATA", -1, NULL) == TRUE);
+
+	gdata_contacts_service_set_photo_cache (service, cache_dir, 1024);
+
+	data = gdata_contacts_contact_get_photo (contact, service, &length, &content_type, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (data != NULL);
+	g_assert_cmpuint (length, ==, 7);
+	g_assert (memcmp (data, "PNGDATA", 7) == 0);
+	g_assert_cmpstr (content_type, ==, "image/png");
+	g_free (data);
+	g_free (content_type);
+
+	/* It should now also be in the memory cache, so it should still be found once the disk copy's gone */
+	g_unlink (path);
+	gdata_contacts_service_set_photo_cache (service, NULL, 1024);
+
+	data = gdata_contacts_contact_get_photo (contact, service, &length, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (data != NULL);
+	g_assert_cmpuint (length, ==, 7);
+	g_free (data);
+
+	g_rmdir (cache_dir);
+	g_free (path);
+	g_free (checksum);
+	g_free (cache_dir);
+	g_object_unref (service);
+	g_object_unref (contact);
+}
+
 static void
 mock_server_notify_resolver_cb (GObject *object, GParamSpec *pspec, gpointer user_data)
 {
@@ -2582,6 +3311,8 @@ main (int argc, char *argv[])
 
 	g_test_add ("/contacts/query/all_contacts", QueryAllContactsData, service, set_up_query_all_contacts, test_query_all_contacts,
 	            tear_down_query_all_contacts);
+	g_test_add ("/contacts/query/all_contacts/request_completed", QueryAllContactsData, service, set_up_query_all_contacts,
+	            test_query_all_contacts_request_completed, tear_down_query_all_contacts);
 	g_test_add ("/contacts/query/all_contacts/async", GDataAsyncTestData, service, set_up_query_all_contacts_async,
 	            test_query_all_contacts_async, tear_down_query_all_contacts_async);
 	g_test_add ("/contacts/query/all_contacts/async/progress_closure", QueryAllContactsData, service,
@@ -2600,6 +3331,10 @@ main (int argc, char *argv[])
 	            tear_down_temp_contact_with_photo_async);
 	g_test_add ("/contacts/photo/get/async/cancellation", GDataAsyncTestData, service, set_up_temp_contact_with_photo_async,
 	            test_photo_get_async_cancellation, tear_down_temp_contact_with_photo_async);
+	g_test_add ("/contacts/photo/add/from-stream", TempContactData, service, set_up_temp_contact, test_photo_add_from_stream,
+	            tear_down_temp_contact);
+	g_test_add ("/contacts/photo/get/to-stream", TempContactData, service, set_up_temp_contact_with_photo, test_photo_get_to_stream,
+	            tear_down_temp_contact);
 
 	g_test_add ("/contacts/photo/delete", TempContactData, service, set_up_temp_contact_with_photo, test_photo_delete,
 	            tear_down_temp_contact);
@@ -2637,6 +3372,11 @@ main (int argc, char *argv[])
 	g_test_add_func ("/contacts/contact/parser/normal", test_contact_parser_normal);
 	g_test_add_func ("/contacts/contact/parser/error_handling", test_contact_parser_error_handling);
 	g_test_add_func ("/contacts/contact/id", test_contact_id);
+	g_test_add_func ("/contacts/contact-summary/parser", test_contact_summary_parser);
+	g_test_add_func ("/contacts/photo/cache", test_photo_cache);
+	g_test_add_func ("/contacts/batch/contacts/empty", test_batch_contacts_empty);
+	g_test_add_data_func ("/contacts/batch/contacts", service, test_batch_contacts);
+	g_test_add_data_func ("/contacts/sync", service, test_sync);
 
 	g_test_add_func ("/contacts/query/uri", test_query_uri);
 	g_test_add_func ("/contacts/query/etag", test_query_etag);
@@ -2648,6 +3388,8 @@ main (int argc, char *argv[])
 	g_test_add_func ("/contacts/group/parser/system", test_group_parser_system);
 	g_test_add_func ("/contacts/group/parser/error_handling", test_group_parser_error_handling);
 	g_test_add_func ("/contacts/group/membership", test_group_membership);
+	g_test_add_func ("/contacts/group/index", test_group_index);
+	g_test_add_func ("/contacts/merge-index", test_merge_index);
 
 	retval = g_test_run ();
 
@@ -1690,6 +1690,731 @@ test_folder_parser_normal (void)
 	g_object_unref (folder);
 }
 
+static void
+test_entry_parser_inline_acl (void)
+{
+	GDataDocumentsFolder *folder;
+	GList *rules;
+	const gchar *scope_type, *scope_value;
+	gchar *xml;
+	GError *error = NULL;
+
+	/* Parse an entry with its ACL feed inline, as returned when GDataDocumentsQuery:expand-acl is set */
+	folder = GDATA_DOCUMENTS_FOLDER (gdata_parsable_new_from_xml (GDATA_TYPE_DOCUMENTS_FOLDER,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:docs='http://schemas.google.com/docs/2007' "
+		       "xmlns:gd='http://schemas.google.com/g/2005' xmlns:gAcl='http://schemas.google.com/acl/2007'>"
+			"<id>https://docs.google.com/feeds/id/folder%3A0BzY2jgHHwMwYalFhbjhVT3dyams</id>"
+			"<updated>2012-04-14T09:12:19.418Z</updated>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/docs/2007#folder' label='folder'/>"
+			"<title>Temporary Folder</title>"
+			"<gd:resourceId>folder:0BzY2jgHHwMwYalFhbjhVT3dyams</gd:resourceId>"
+			"<gd:feedLink rel='http://schemas.google.com/acl/2007#accessControlList' href='https://docs.google.com/feeds/default/private/full/folder%3A0BzY2jgHHwMwYalFhbjhVT3dyams/acl'>"
+				"<feed>"
+					"<id>https://docs.google.com/feeds/default/private/full/folder%3A0BzY2jgHHwMwYalFhbjhVT3dyams/acl</id>"
+					"<updated>2012-04-14T09:12:19.418Z</updated>"
+					"<title>Document Permissions</title>"
+					"<entry>"
+						"<id>https://docs.google.com/feeds/id/folder%3A0BzY2jgHHwMwYalFhbjhVT3dyams/acl/user%3Aowner%40example.com</id>"
+						"<updated>2012-04-14T09:12:19.418Z</updated>"
+						"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/acl/2007#accessRule'/>"
+						"<gAcl:role value='owner'/>"
+						"<gAcl:scope type='user' value='owner@example.com'/>"
+					"</entry>"
+					"<entry>"
+						"<id>https://docs.google.com/feeds/id/folder%3A0BzY2jgHHwMwYalFhbjhVT3dyams/acl/user%3Areader%40example.com</id>"
+						"<updated>2012-04-14T09:12:19.418Z</updated>"
+						"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/acl/2007#accessRule'/>"
+						"<gAcl:role value='reader'/>"
+						"<gAcl:scope type='user' value='reader@example.com'/>"
+					"</entry>"
+				"</feed>"
+			"</gd:feedLink>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_DOCUMENTS_FOLDER (folder));
+
+	/* The rules should be in document order */
+	rules = gdata_documents_entry_get_access_rules (GDATA_DOCUMENTS_ENTRY (folder));
+	g_assert_cmpuint (g_list_length (rules), ==, 2);
+
+	g_assert_cmpstr (gdata_access_rule_get_role (GDATA_ACCESS_RULE (rules->data)), ==, GDATA_DOCUMENTS_ACCESS_ROLE_OWNER);
+	gdata_access_rule_get_scope (GDATA_ACCESS_RULE (rules->data), &scope_type, &scope_value);
+	g_assert_cmpstr (scope_type, ==, GDATA_ACCESS_SCOPE_USER);
+	g_assert_cmpstr (scope_value, ==, "owner@example.com");
+
+	g_assert_cmpstr (gdata_access_rule_get_role (GDATA_ACCESS_RULE (rules->next->data)), ==, GDATA_DOCUMENTS_ACCESS_ROLE_READER);
+	gdata_access_rule_get_scope (GDATA_ACCESS_RULE (rules->next->data), &scope_type, &scope_value);
+	g_assert_cmpstr (scope_value, ==, "reader@example.com");
+
+	/* The ACL link should still be there, without the inline feed */
+	g_assert (gdata_entry_look_up_link (GDATA_ENTRY (folder), "http://schemas.google.com/acl/2007#accessControlList") != NULL);
+
+	xml = gdata_parsable_get_xml (GDATA_PARSABLE (folder));
+	g_assert (strstr (xml, "reader@example.com") == NULL);
+	g_free (xml);
+
+	g_object_unref (folder);
+}
+
+static void
+test_folder_tree_unauthenticated (void)
+{
+	GDataDocumentsService *service;
+	GDataDocumentsFolderTree *tree;
+	GError *error = NULL;
+
+	/* Crawling requires authentication, and shouldn't touch the network if it's missing */
+	service = gdata_documents_service_new (NULL);
+	tree = gdata_documents_folder_tree_new (service);
+
+	g_assert (gdata_documents_folder_tree_get_service (tree) == service);
+
+	g_assert (gdata_documents_folder_tree_crawl (tree, NULL, NULL, &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED);
+	g_clear_error (&error);
+
+	/* The index should be empty */
+	g_assert (gdata_documents_folder_tree_get_entries (tree) == NULL);
+	g_assert (gdata_documents_folder_tree_get_children (tree, NULL) == NULL);
+	g_assert (gdata_documents_folder_tree_look_up_entry (tree, "folder:abc") == NULL);
+	g_assert (gdata_documents_folder_tree_get_parents (tree, "folder:abc") == NULL);
+	g_assert (gdata_documents_folder_tree_get_path (tree, "folder:abc") == NULL);
+
+	g_object_unref (tree);
+	g_object_unref (service);
+}
+
+static void
+test_folder_tree_crawl (gconstpointer service)
+{
+	GDataDocumentsFolderTree *tree;
+	GDataDocumentsEntry *entry;
+	GDataDocumentsFolder *folder;
+	GList *entries;
+	gchar *path;
+	guint old_max_connections;
+	GError *error = NULL;
+
+	/* The trace is hand-written, and can't be replayed against the real server */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping folder tree test when online or logging.");
+		return;
+	}
+
+	/* Crawl one folder at a time, so that the requests are made in the order they're listed in the trace */
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	gdata_test_mock_server_start_trace (mock_server, "folder-tree");
+
+	/* Crawl everything: root contains folder1 and document1; folder1 contains folder2 and document2; folder2 contains spreadsheet1 and
+	 * (again) document2 */
+	tree = gdata_documents_folder_tree_new (GDATA_DOCUMENTS_SERVICE (service));
+	g_assert (gdata_documents_folder_tree_crawl (tree, NULL, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	entries = gdata_documents_folder_tree_get_entries (tree);
+	g_assert_cmpuint (g_list_length (entries), ==, 5);
+	g_list_free (entries);
+
+	entry = gdata_documents_folder_tree_look_up_entry (tree, "folder:folder2");
+	g_assert (GDATA_IS_DOCUMENTS_FOLDER (entry));
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (entry)), ==, "Folder Two");
+	g_assert (GDATA_IS_DOCUMENTS_SPREADSHEET (gdata_documents_folder_tree_look_up_entry (tree, "spreadsheet:spreadsheet1")));
+	g_assert (gdata_documents_folder_tree_look_up_entry (tree, "document:missing") == NULL);
+
+	/* Only the entries directly in the root have no parents */
+	entries = gdata_documents_folder_tree_get_children (tree, NULL);
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+	g_assert (g_list_find (entries, gdata_documents_folder_tree_look_up_entry (tree, "folder:folder1")) != NULL);
+	g_assert (g_list_find (entries, gdata_documents_folder_tree_look_up_entry (tree, "document:document1")) != NULL);
+	g_list_free (entries);
+
+	entries = gdata_documents_folder_tree_get_children (tree, "folder:folder1");
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (entries->data), ==, "folder:folder2");
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (entries->next->data), ==, "document:document2");
+	g_list_free (entries);
+
+	entries = gdata_documents_folder_tree_get_children (tree, "folder:folder2");
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (entries->data), ==, "spreadsheet:spreadsheet1");
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (entries->next->data), ==, "document:document2");
+	g_list_free (entries);
+
+	/* document2 is in both folders, but is only listed once as a child of each */
+	entries = gdata_documents_folder_tree_get_parents (tree, "document:document2");
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (entries->data), ==, "folder:folder1");
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (entries->next->data), ==, "folder:folder2");
+	g_list_free (entries);
+
+	g_assert (gdata_documents_folder_tree_get_parents (tree, "folder:folder1") == NULL);
+
+	path = gdata_documents_folder_tree_get_path (tree, "spreadsheet:spreadsheet1");
+	g_assert_cmpstr (path, ==, "/folder1/folder2/spreadsheet1");
+	g_free (path);
+
+	path = gdata_documents_folder_tree_get_path (tree, "document:document1");
+	g_assert_cmpstr (path, ==, "/document1");
+	g_free (path);
+
+	/* Crawl just folder2, which should replace the index. folder2 still links to folder1, but folder1 is no longer indexed. */
+	folder = g_object_ref (gdata_documents_folder_tree_look_up_entry (tree, "folder:folder2"));
+	g_assert (gdata_documents_folder_tree_crawl (tree, folder, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	entries = gdata_documents_folder_tree_get_entries (tree);
+	g_assert_cmpuint (g_list_length (entries), ==, 3);
+	g_list_free (entries);
+
+	g_assert (gdata_documents_folder_tree_look_up_entry (tree, "folder:folder1") == NULL);
+	g_assert (gdata_documents_folder_tree_look_up_entry (tree, "document:document1") == NULL);
+	g_assert (gdata_documents_folder_tree_look_up_entry (tree, "folder:folder2") == GDATA_DOCUMENTS_ENTRY (folder));
+	g_assert (gdata_documents_folder_tree_get_parents (tree, "folder:folder2") == NULL);
+
+	entries = gdata_documents_folder_tree_get_children (tree, "folder:folder2");
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+	g_list_free (entries);
+
+	g_object_unref (folder);
+	g_object_unref (tree);
+
+	uhm_server_end_trace (mock_server);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+}
+
+static void
+test_changes_feed_parser (void)
+{
+	GDataDocumentsFeed *feed;
+	GDataDocumentsEntry *entry;
+	GList *entries;
+	GError *error = NULL;
+
+	feed = GDATA_DOCUMENTS_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_DOCUMENTS_FEED,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<feed xmlns='http://www.w3.org/2005/Atom' xmlns:docs='http://schemas.google.com/docs/2007' "
+		      "xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>https://docs.google.com/feeds/default/private/changes</id>"
+			"<updated>2012-04-14T09:12:20.055Z</updated>"
+			"<title>Changes</title>"
+			"<docs:largestChangestamp value='5678'/>"
+			"<entry>"
+				"<id>https://docs.google.com/feeds/id/folder%3A0BzY2jgHHwMwYalFhbjhVT3dyams</id>"
+				"<updated>2012-04-14T09:12:19.418Z</updated>"
+				"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/docs/2007#folder' label='folder'/>"
+				"<title>Temporary Folder</title>"
+				"<gd:resourceId>folder:0BzY2jgHHwMwYalFhbjhVT3dyams</gd:resourceId>"
+				"<docs:changestamp value='1234'/>"
+			"</entry>"
+			"<entry>"
+				"<id>https://docs.google.com/feeds/id/document%3A1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM</id>"
+				"<updated>2012-04-14T09:12:19.418Z</updated>"
+				"<title>Removed Document</title>"
+				"<gd:resourceId>document:1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM</gd:resourceId>"
+				"<docs:changestamp value='5678'/>"
+				"<docs:removed/>"
+			"</entry>"
+		"</feed>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_DOCUMENTS_FEED (feed));
+
+	g_assert_cmpint (gdata_documents_feed_get_largest_changestamp (feed), ==, 5678);
+
+	/* The removed entry has no kind, but must still be reported */
+	entries = gdata_feed_get_entries (GDATA_FEED (feed));
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+
+	entry = GDATA_DOCUMENTS_ENTRY (entries->data);
+	g_assert (GDATA_IS_DOCUMENTS_FOLDER (entry));
+	g_assert_cmpint (gdata_documents_entry_get_changestamp (entry), ==, 1234);
+	g_assert (gdata_documents_entry_is_removed (entry) == FALSE);
+
+	entry = GDATA_DOCUMENTS_ENTRY (entries->next->data);
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (entry), ==, "document:1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM");
+	g_assert_cmpint (gdata_documents_entry_get_changestamp (entry), ==, 5678);
+	g_assert (gdata_documents_entry_is_removed (entry) == TRUE);
+
+	g_object_unref (feed);
+}
+
+static void
+export_multiple_cb (GDataDocumentsDocument *document, const gchar *export_format, GFile *file, GError *error, guint *n_failed)
+{
+	gchar *basename;
+
+	g_assert (GDATA_IS_DOCUMENTS_TEXT (document));
+
+	basename = g_file_get_basename (file);
+
+	if (g_strcmp0 (export_format, "pdf") == 0) {
+		/* This was already exported, so should have been skipped without touching the network */
+		g_assert_no_error (error);
+		g_assert_cmpstr (basename, ==, "document_1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM.pdf");
+	} else {
+		g_assert_cmpstr (export_format, ==, "odt");
+		g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED);
+		g_assert_cmpstr (basename, ==, "document_1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM.odt");
+		g_assert (g_file_query_exists (file, NULL) == FALSE);
+		(*n_failed)++;
+	}
+
+	g_free (basename);
+}
+
+static void
+test_document_export_multiple_unauthenticated (void)
+{
+	GDataDocumentsService *service;
+	GDataDocumentsDocument *document;
+	GList *documents;
+	GFile *directory, *exported_file;
+	gchar *directory_path, *exported_path;
+	const gchar *export_formats[] = { "odt", "pdf", NULL };
+	guint n_failed = 0;
+	GError *error = NULL;
+
+	document = GDATA_DOCUMENTS_DOCUMENT (gdata_parsable_new_from_xml (GDATA_TYPE_DOCUMENTS_TEXT,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>https://docs.google.com/feeds/id/document%3A1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM</id>"
+			"<updated>2012-04-14T09:12:19.418Z</updated>"
+			"<title>Document</title>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/docs/2007#document' label='document'/>"
+			"<content type='text/html' src='https://docs.google.com/feeds/download/documents/export/Export?id=1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM'/>"
+			"<gd:resourceId>document:1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM</gd:resourceId>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	documents = g_list_prepend (NULL, document);
+
+	directory_path = g_dir_make_tmp ("libgdata-export-XXXXXX", &error);
+	g_assert_no_error (error);
+	directory = g_file_new_for_path (directory_path);
+
+	/* Pretend that a previous run exported the PDF */
+	exported_path = g_build_filename (directory_path, "document_1uMkM0D4lgbjN12U4Ci0NB3CptY0SXJrzjdoNF8HdMfM.pdf", NULL);
+	g_assert (g_file_set_contents (exported_path, "%PDF", -1, NULL) == TRUE);
+	exported_file = g_file_new_for_path (exported_path);
+
+	/* Individual exports fail without authentication, but the operation as a whole succeeds */
+	service = gdata_documents_service_new (NULL);
+	g_assert (gdata_documents_document_export_multiple (service, documents, export_formats, directory, NULL,
+	                                                    (GDataDocumentsDocumentExportCallback) export_multiple_cb, &n_failed, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (n_failed, ==, 1);
+
+	g_file_delete (exported_file, NULL, NULL);
+	g_file_delete (directory, NULL, NULL);
+
+	g_object_unref (exported_file);
+	g_free (exported_path);
+	g_object_unref (directory);
+	g_free (directory_path);
+	g_list_free_full (documents, g_object_unref);
+	g_object_unref (service);
+}
+
+static GDataDocumentsDocument *
+build_export_document (const gchar *untyped_resource_id)
+{
+	GDataDocumentsDocument *document;
+	gchar *xml;
+	GError *error = NULL;
+
+	xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>https://docs.google.com/feeds/id/document%%3A%s</id>"
+			"<updated>2026-10-14T09:00:00.000Z</updated>"
+			"<title>Document</title>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/docs/2007#document' label='document'/>"
+			"<content type='text/html' src='https://docs.google.com/feeds/download/documents/export/Export?id=%s'/>"
+			"<gd:resourceId>document:%s</gd:resourceId>"
+		"</entry>", untyped_resource_id, untyped_resource_id, untyped_resource_id);
+	document = GDATA_DOCUMENTS_DOCUMENT (gdata_parsable_new_from_xml (GDATA_TYPE_DOCUMENTS_TEXT, xml, -1, &error));
+	g_assert_no_error (error);
+	g_free (xml);
+
+	return document;
+}
+
+static void
+export_multiple_trace_cb (GDataDocumentsDocument *document, const gchar *export_format, GFile *file, GError *error, GHashTable *results)
+{
+	gchar *basename;
+
+	/* Key the results by file name, since the order in which the exports finish isn't defined */
+	basename = g_file_get_basename (file);
+	g_assert (g_hash_table_contains (results, basename) == FALSE);
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (document)), ==,
+	                 (strstr (basename, "document1") != NULL) ? "document:document1" : "document:document2");
+	g_assert (g_str_has_suffix (basename, export_format) == TRUE);
+
+	g_hash_table_insert (results, basename, (error != NULL) ? g_error_copy (error) : NULL);
+}
+
+/* Check that @name in @directory has the given contents, then delete it */
+static void
+check_and_delete_exported_file (GFile *directory, const gchar *name, const gchar *expected_contents)
+{
+	GFile *file;
+	gchar *contents;
+	gsize length;
+	GError *error = NULL;
+
+	file = g_file_get_child (directory, name);
+
+	g_assert (g_file_load_contents (file, NULL, &contents, &length, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (length, ==, strlen (expected_contents));
+	g_assert (memcmp (contents, expected_contents, length) == 0);
+	g_free (contents);
+
+	g_assert (g_file_delete (file, NULL, NULL) == TRUE);
+	g_object_unref (file);
+}
+
+static void
+test_document_export_multiple (gconstpointer service)
+{
+	GList *documents = NULL;
+	GFile *directory, *file;
+	GHashTable *results;
+	GError *export_error;
+	gchar *directory_path, *path;
+	const gchar *export_formats[] = { "odt", "pdf", NULL };
+	guint old_max_connections;
+	GError *error = NULL;
+
+	/* The trace is hand-written, and can't be replayed against the real server */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping multiple export test when online or logging.");
+		return;
+	}
+
+	/* Export one document at a time, so that the requests are made in the order they're listed in the trace */
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	documents = g_list_append (documents, build_export_document ("document1"));
+	documents = g_list_append (documents, build_export_document ("document2"));
+
+	directory_path = g_dir_make_tmp ("libgdata-export-XXXXXX", &error);
+	g_assert_no_error (error);
+	directory = g_file_new_for_path (directory_path);
+
+	/* Pretend that a previous run exported document1 as a PDF, so only the other three exports touch the network */
+	path = g_build_filename (directory_path, "document_document1.pdf", NULL);
+	g_assert (g_file_set_contents (path, "%PDF", -1, NULL) == TRUE);
+	g_free (path);
+
+	gdata_test_mock_server_start_trace (mock_server, "export-multiple");
+
+	/* The failed export of document2 as a PDF doesn't fail the operation as a whole */
+	results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	g_assert (gdata_documents_document_export_multiple (GDATA_DOCUMENTS_SERVICE (service), documents, export_formats, directory, NULL,
+	                                                    (GDataDocumentsDocumentExportCallback) export_multiple_trace_cb, results,
+	                                                    &error) == TRUE);
+	g_assert_no_error (error);
+
+	uhm_server_end_trace (mock_server);
+
+	/* Every document and format should have been reported, with only the missing PDF failing */
+	g_assert_cmpuint (g_hash_table_size (results), ==, 4);
+	g_assert (g_hash_table_lookup_extended (results, "document_document1.odt", NULL, (gpointer*) &export_error) == TRUE);
+	g_assert_no_error (export_error);
+	g_assert (g_hash_table_lookup_extended (results, "document_document1.pdf", NULL, (gpointer*) &export_error) == TRUE);
+	g_assert_no_error (export_error);
+	g_assert (g_hash_table_lookup_extended (results, "document_document2.odt", NULL, (gpointer*) &export_error) == TRUE);
+	g_assert_no_error (export_error);
+	g_assert (g_hash_table_lookup_extended (results, "document_document2.pdf", NULL, (gpointer*) &export_error) == TRUE);
+	g_assert_error (export_error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+	g_error_free (export_error);
+	g_hash_table_unref (results);
+
+	/* The downloads should have been moved into place (each line of a traced response body ends with a newline), and the skipped export left
+	 * alone */
+	check_and_delete_exported_file (directory, "document_document1.odt", "Document one as ODT\n");
+	check_and_delete_exported_file (directory, "document_document2.odt", "Document two as ODT\n");
+	check_and_delete_exported_file (directory, "document_document1.pdf", "%PDF");
+
+	/* Neither the failed export nor its partial download should be left behind */
+	file = g_file_get_child (directory, "document_document2.pdf");
+	g_assert (g_file_query_exists (file, NULL) == FALSE);
+	g_object_unref (file);
+
+	file = g_file_get_child (directory, "document_document2.pdf.part");
+	g_assert (g_file_query_exists (file, NULL) == FALSE);
+	g_object_unref (file);
+
+	g_assert (g_file_delete (directory, NULL, NULL) == TRUE);
+
+	g_object_unref (directory);
+	g_free (directory_path);
+	g_list_free_full (documents, g_object_unref);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+}
+
+static void
+test_upload_file_unauthenticated (void)
+{
+	GDataDocumentsService *service;
+	GDataDocumentsDocument *document;
+	GFile *file;
+	GError *error = NULL;
+
+	/* Uploading requires authentication, which should be checked before the file is even queried */
+	service = gdata_documents_service_new (NULL);
+	file = g_file_new_for_path (TEST_FILE_DIR "test.odt");
+
+	document = gdata_documents_service_upload_file (service, NULL, file, NULL, NULL, NULL, NULL, &error);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED);
+	g_assert (document == NULL);
+	g_clear_error (&error);
+
+	g_object_unref (file);
+	g_object_unref (service);
+}
+
+static void
+test_upload_file (gconstpointer service)
+{
+	GDataDocumentsDocument *document;
+	GDataDocumentsUploadQuery *query;
+	GFile *file;
+	GError *error = NULL;
+
+	/* The trace is hand-written, and can't be replayed against the real server */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping file upload test when online or logging.");
+		return;
+	}
+
+	gdata_test_mock_server_start_trace (mock_server, "upload-file");
+
+	file = g_file_new_for_path (TEST_FILE_DIR "test.odt");
+
+	/* A small file without a query should be uploaded in a single request, named after the file */
+	document = gdata_documents_service_upload_file (GDATA_DOCUMENTS_SERVICE (service), NULL, file, NULL, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_DOCUMENTS_TEXT (document));
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (document)), ==, "document:uploaded1");
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (document)), ==, "test.odt");
+	g_object_unref (document);
+
+	/* Giving a query forces a resumable upload, which opens a session and then sends the (single) chunk */
+	query = gdata_documents_upload_query_new ();
+	document = gdata_documents_service_upload_file (GDATA_DOCUMENTS_SERVICE (service), NULL, file, "Uploaded Document",
+	                                                "application/vnd.oasis.opendocument.text", query, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_DOCUMENTS_TEXT (document));
+	g_assert_cmpstr (gdata_documents_entry_get_resource_id (GDATA_DOCUMENTS_ENTRY (document)), ==, "document:uploaded2");
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (document)), ==, "Uploaded Document");
+	g_object_unref (document);
+	g_object_unref (query);
+
+	g_object_unref (file);
+
+	/* A missing file should fail before anything is sent */
+	file = g_file_new_for_path (TEST_FILE_DIR "missing.odt");
+	document = gdata_documents_service_upload_file (GDATA_DOCUMENTS_SERVICE (service), NULL, file, NULL, NULL, NULL, NULL, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+	g_assert (document == NULL);
+	g_clear_error (&error);
+	g_object_unref (file);
+
+	uhm_server_end_trace (mock_server);
+}
+
+static void
+move_entries_cb (GDataDocumentsEntry *entry, GDataDocumentsEntry *moved_entry, GError *error, guint *n_failed)
+{
+	g_assert (GDATA_IS_DOCUMENTS_TEXT (entry));
+	g_assert (moved_entry == NULL);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED);
+
+	(*n_failed)++;
+}
+
+static void
+test_move_entries_unauthenticated (void)
+{
+	GDataDocumentsService *service;
+	GDataDocumentsFolder *from_folder, *to_folder;
+	GList *entries = NULL;
+	guint i, n_failed = 0;
+	GError *error = NULL;
+
+	service = gdata_documents_service_new (NULL);
+	from_folder = gdata_documents_folder_new (NULL);
+	to_folder = gdata_documents_folder_new (NULL);
+
+	for (i = 0; i < 5; i++)
+		entries = g_list_prepend (entries, gdata_documents_text_new (NULL));
+
+	/* Without rolling back, the individual failures are only reported to the callback */
+	g_assert (gdata_documents_service_move_entries (service, entries, from_folder, to_folder, FALSE, NULL,
+	                                                (GDataDocumentsServiceMoveCallback) move_entries_cb, &n_failed, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (n_failed, ==, 5);
+
+	/* With rolling back, the first failure is returned too */
+	n_failed = 0;
+	g_assert (gdata_documents_service_move_entries (service, entries, from_folder, to_folder, TRUE, NULL,
+	                                                (GDataDocumentsServiceMoveCallback) move_entries_cb, &n_failed, &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_AUTHENTICATION_REQUIRED);
+	g_clear_error (&error);
+	g_assert_cmpuint (n_failed, ==, 5);
+
+	g_list_free_full (entries, g_object_unref);
+	g_object_unref (to_folder);
+	g_object_unref (from_folder);
+	g_object_unref (service);
+}
+
+typedef struct {
+	GHashTable *moved_entries; /* resource ID → moved GDataDocumentsEntry */
+	GError *error; /* the last error reported */
+	guint n_failed;
+} MoveEntriesResults;
+
+static void
+move_entries_results_clear (MoveEntriesResults *results)
+{
+	g_hash_table_remove_all (results->moved_entries);
+	g_clear_error (&(results->error));
+	results->n_failed = 0;
+}
+
+static void
+move_entries_trace_cb (GDataDocumentsEntry *entry, GDataDocumentsEntry *moved_entry, GError *error, MoveEntriesResults *results)
+{
+	const gchar *resource_id = gdata_documents_entry_get_resource_id (entry);
+
+	g_assert (GDATA_IS_DOCUMENTS_TEXT (entry));
+
+	if (error != NULL) {
+		g_assert (moved_entry == NULL);
+		g_clear_error (&(results->error));
+		results->error = g_error_copy (error);
+		results->n_failed++;
+	} else {
+		g_assert (GDATA_IS_DOCUMENTS_TEXT (moved_entry));
+		g_assert_cmpstr (gdata_documents_entry_get_resource_id (moved_entry), ==, resource_id);
+		g_hash_table_insert (results->moved_entries, g_strdup (resource_id), g_object_ref (moved_entry));
+	}
+}
+
+static GDataDocumentsFolder *
+build_move_folder (const gchar *untyped_resource_id)
+{
+	GDataDocumentsFolder *folder;
+	gchar *xml;
+	GError *error = NULL;
+
+	xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>https://docs.google.com/feeds/id/folder%%3A%s</id>"
+			"<updated>2026-10-14T09:00:00.000Z</updated>"
+			"<title>Folder</title>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/docs/2007#folder' label='folder'/>"
+			"<content type='application/atom+xml;type=feed' "
+			         "src='https://docs.google.com/feeds/default/private/full/folder%%3A%s/contents'/>"
+			"<gd:resourceId>folder:%s</gd:resourceId>"
+		"</entry>", untyped_resource_id, untyped_resource_id, untyped_resource_id);
+	folder = GDATA_DOCUMENTS_FOLDER (gdata_parsable_new_from_xml (GDATA_TYPE_DOCUMENTS_FOLDER, xml, -1, &error));
+	g_assert_no_error (error);
+	g_free (xml);
+
+	return folder;
+}
+
+static void
+assert_entry_in_folder (GDataDocumentsEntry *entry, const gchar *etag, const gchar *folder_uri)
+{
+	GList *links;
+
+	g_assert_cmpstr (gdata_entry_get_etag (GDATA_ENTRY (entry)), ==, etag);
+
+	links = gdata_entry_look_up_links (GDATA_ENTRY (entry), "http://schemas.google.com/docs/2007#parent");
+	g_assert_cmpuint (g_list_length (links), ==, 1);
+	g_assert_cmpstr (gdata_link_get_uri (links->data), ==, folder_uri);
+	g_list_free (links);
+}
+
+static void
+test_move_entries (gconstpointer service)
+{
+	GDataDocumentsFolder *folder_a, *folder_b;
+	GList *entries;
+	MoveEntriesResults results;
+	guint old_max_connections;
+	GError *error = NULL;
+
+	/* The trace is hand-written, and can't be replayed against the real server */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping move test when online or logging.");
+		return;
+	}
+
+	/* Move one entry at a time, so that the requests are made in the order they're listed in the trace */
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	folder_a = build_move_folder ("folderA");
+	folder_b = build_move_folder ("folderB");
+
+	entries = g_list_append (NULL, build_export_document ("document1"));
+	entries = g_list_append (entries, build_export_document ("document2"));
+
+	results.moved_entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	results.error = NULL;
+	results.n_failed = 0;
+
+	gdata_test_mock_server_start_trace (mock_server, "move-entries");
+
+	/* Move both documents from folder A to folder B. Each is added to B, removed from A (using the ETag from the addition) and re-queried. */
+	g_assert (gdata_documents_service_move_entries (GDATA_DOCUMENTS_SERVICE (service), entries, folder_a, folder_b, FALSE, NULL,
+	                                                (GDataDocumentsServiceMoveCallback) move_entries_trace_cb, &results, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert_cmpuint (results.n_failed, ==, 0);
+	g_assert_cmpuint (g_hash_table_size (results.moved_entries), ==, 2);
+	assert_entry_in_folder (g_hash_table_lookup (results.moved_entries, "document:document1"), "\"moved1\"",
+	                        "https://docs.google.com/feeds/default/private/full/folder%3AfolderB");
+	assert_entry_in_folder (g_hash_table_lookup (results.moved_entries, "document:document2"), "\"moved2\"",
+	                        "https://docs.google.com/feeds/default/private/full/folder%3AfolderB");
+
+	/* Move the updated documents back to folder A, rolling back on failure. document2 can't be added to A, so document1 (which was) is moved
+	 * back to B, and the error is returned. */
+	g_list_free_full (entries, g_object_unref);
+	entries = g_list_append (NULL, g_object_ref (g_hash_table_lookup (results.moved_entries, "document:document1")));
+	entries = g_list_append (entries, g_object_ref (g_hash_table_lookup (results.moved_entries, "document:document2")));
+	move_entries_results_clear (&results);
+
+	g_assert (gdata_documents_service_move_entries (GDATA_DOCUMENTS_SERVICE (service), entries, folder_b, folder_a, TRUE, NULL,
+	                                                (GDataDocumentsServiceMoveCallback) move_entries_trace_cb, &results, &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_CONFLICT);
+	g_clear_error (&error);
+
+	/* The callback still reports the move of document1 which was later rolled back */
+	g_assert_cmpuint (results.n_failed, ==, 1);
+	g_assert_error (results.error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_CONFLICT);
+	g_assert_cmpuint (g_hash_table_size (results.moved_entries), ==, 1);
+	assert_entry_in_folder (g_hash_table_lookup (results.moved_entries, "document:document1"), "\"moved3\"",
+	                        "https://docs.google.com/feeds/default/private/full/folder%3AfolderA");
+
+	uhm_server_end_trace (mock_server);
+
+	move_entries_results_clear (&results);
+	g_hash_table_unref (results.moved_entries);
+	g_list_free_full (entries, g_object_unref);
+	g_object_unref (folder_b);
+	g_object_unref (folder_a);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+}
+
 static void
 test_query_etag (void)
 {
@@ -1709,6 +2434,8 @@ test_query_etag (void)
 	CHECK_ETAG (gdata_documents_query_set_title (query, "Title", FALSE))
 	CHECK_ETAG (gdata_documents_query_add_reader (query, "foo@example.com"))
 	CHECK_ETAG (gdata_documents_query_add_collaborator (query, "foo@example.com"))
+	CHECK_ETAG (gdata_documents_query_set_expand_acl (query, TRUE))
+	CHECK_ETAG (gdata_documents_query_set_order_by (query, "last-modified"))
 
 #undef CHECK_ETAG
 
@@ -2198,6 +2925,16 @@ main (int argc, char *argv[])
 	            tear_down_batch_async);
 
 	g_test_add_func ("/documents/folder/parser/normal", test_folder_parser_normal);
+	g_test_add_func ("/documents/entry/parser/inline-acl", test_entry_parser_inline_acl);
+	g_test_add_func ("/documents/folder-tree/unauthenticated", test_folder_tree_unauthenticated);
+	g_test_add_data_func ("/documents/folder-tree/crawl", service, test_folder_tree_crawl);
+	g_test_add_func ("/documents/changes/parser", test_changes_feed_parser);
+	g_test_add_func ("/documents/document/export-multiple/unauthenticated", test_document_export_multiple_unauthenticated);
+	g_test_add_data_func ("/documents/document/export-multiple", service, test_document_export_multiple);
+	g_test_add_func ("/documents/upload/file/unauthenticated", test_upload_file_unauthenticated);
+	g_test_add_data_func ("/documents/upload/file", service, test_upload_file);
+	g_test_add_func ("/documents/move-entries/unauthenticated", test_move_entries_unauthenticated);
+	g_test_add_data_func ("/documents/move-entries", service, test_move_entries);
 	g_test_add_func ("/documents/query/etag", test_query_etag);
 	g_test_add_func ("/documents/upload-query/properties/convert", test_upload_query_properties_convert);
 
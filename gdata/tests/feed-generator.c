@@ -0,0 +1,398 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Synthetic feed generator, for tests and benchmarks which need feeds of arbitrary size.
+ *
+ * Each entry is generated from a template modelled on what the corresponding service returns, followed by a configurable number of extension
+ * elements (elements from a GData namespace which libgdata knows about, but which the entry's type might not handle) and unknown elements (from a
+ * namespace libgdata knows nothing about, so they always end up as unhandled XML or JSON). Entries differ only in their IDs, so feeds are
+ * deterministic and their size scales linearly with the number of entries.
+ */
+
+#include <glib.h>
+
+#include "feed-generator.h"
+
+#define ATOM_NAMESPACES \
+	"xmlns='http://www.w3.org/2005/Atom' " \
+	"xmlns:app='http://www.w3.org/2007/app' " \
+	"xmlns:gd='http://schemas.google.com/g/2005' " \
+	"xmlns:gCal='http://schemas.google.com/gCal/2005' " \
+	"xmlns:gContact='http://schemas.google.com/contact/2008' " \
+	"xmlns:media='http://search.yahoo.com/mrss/' " \
+	"xmlns:yt='http://gdata.youtube.com/schemas/2007' " \
+	"xmlns:gphoto='http://schemas.google.com/photos/2007' " \
+	"xmlns:exif='http://schemas.google.com/photos/exif/2007' " \
+	"xmlns:unknown='http://example.com/unknown' "
+
+/* Each entry template follows the opening "<entry" or "{" (so that namespace declarations can be inserted for standalone entries), takes a single
+ * unsigned integer which is used to give the entry a unique ID, and stops before the closing tag or brace (so that extension and unknown elements
+ * can be appended). */
+static const gchar entry_template[] =
+	">"
+	"<id>http://example.com/entries/%u</id>"
+	"<title type='text'>Generated entry</title>"
+	"<updated>2009-01-25T14:07:37.880860Z</updated>"
+	"<published>2009-01-23T14:06:37.880860Z</published>"
+	"<content type='text'>This entry was generated for testing.</content>"
+	"<link rel='self' type='application/atom+xml' href='http://example.com/self'/>"
+	"<category scheme='http://example.com/categories' term='entry'/>"
+	"<author><name>Joe Smith</name><email>j.smith@example.com</email></author>";
+
+static const gchar calendar_event_template[] =
+	" gd:etag='W/\"DEQHQn84fCt7ImA9WxJTGUU.\"'>"
+	"<id>http://www.google.com/calendar/feeds/default/events/%u</id>"
+	"<published>2008-06-06T21:02:56.000Z</published>"
+	"<updated>2009-04-27T17:54:10.000Z</updated>"
+	"<app:edited>2009-04-27T17:54:10.000Z</app:edited>"
+	"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/g/2005#event'/>"
+	"<title>Tennis with Beth</title>"
+	"<content type='text'>Meet for a quick lesson.</content>"
+	"<link rel='alternate' type='text/html' href='http://www.google.com/calendar/event?eid=bzk5ZmxtZ21tZm'/>"
+	"<link rel='self' type='application/atom+xml' href='http://www.google.com/calendar/feeds/default/events/o99flmgmkfkfrr8u745ghr3100'/>"
+	"<author><name>GData Test</name><email>libgdata.test@googlemail.com</email></author>"
+	"<gd:eventStatus value='http://schemas.google.com/g/2005#event.confirmed'/>"
+	"<gd:visibility value='http://schemas.google.com/g/2005#event.public'/>"
+	"<gd:transparency value='http://schemas.google.com/g/2005#event.opaque'/>"
+	"<gd:where valueString='Rolling Lawn Courts'/>"
+	"<gd:who email='libgdata.test@googlemail.com' rel='http://schemas.google.com/g/2005#event.organizer' valueString='GData Test'/>"
+	"<gd:who email='john.smith@example.com' rel='http://schemas.google.com/g/2005#event.attendee' valueString='John Smith'>"
+		"<gd:attendeeStatus value='http://schemas.google.com/g/2005#event.accepted'/>"
+	"</gd:who>"
+	"<gd:when startTime='2009-04-17T15:00:00.000Z' endTime='2009-04-17T17:00:00.000Z'>"
+		"<gd:reminder minutes='10' method='alert'/>"
+	"</gd:when>"
+	"<gCal:anyoneCanAddSelf value='false'/>"
+	"<gCal:guestsCanInviteOthers value='false'/>"
+	"<gCal:guestsCanModify value='true'/>"
+	"<gCal:guestsCanSeeGuests value='true'/>"
+	"<gCal:sequence value='2'/>"
+	"<gCal:uid value='54dd4a2c-bee7-4c24-a0e2-a41a34c4d092@google.com'/>";
+
+static const gchar contacts_contact_template[] =
+	" gd:etag='\"QngzcDVSLyp7ImA9WxJTFkoITgU.\"'>"
+	"<id>http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/base/%u</id>"
+	"<updated>2009-04-25T15:21:53.688Z</updated>"
+	"<app:edited>2009-04-25T15:21:53.688Z</app:edited>"
+	"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>"
+	"<title>Fooish Bar</title>"
+	"<content type='text'>Notes about Fooish.</content>"
+	"<link rel='http://schemas.google.com/contacts/2008/rel#photo' type='image/*' "
+	      "href='http://www.google.com/m8/feeds/photos/media/libgdata.test@googlemail.com/1b46cdd20bfbee3b'/>"
+	"<link rel='self' type='application/atom+xml' "
+	      "href='http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/full/1b46cdd20bfbee3b'/>"
+	"<link rel='edit' type='application/atom+xml' "
+	      "href='http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/full/1b46cdd20bfbee3b/1240672913688000'/>"
+	"<gd:name><gd:givenName>Fooish</gd:givenName><gd:familyName>Bar</gd:familyName><gd:fullName>Fooish Bar</gd:fullName></gd:name>"
+	"<gd:email rel='http://schemas.google.com/g/2005#work' address='fooish@example.com' primary='true'/>"
+	"<gd:email rel='http://schemas.google.com/g/2005#home' address='bar@example.com'/>"
+	"<gd:im rel='http://schemas.google.com/g/2005#home' protocol='http://schemas.google.com/g/2005#GOOGLE_TALK' address='fooish@gmail.com'/>"
+	"<gd:phoneNumber rel='http://schemas.google.com/g/2005#work'>(206)555-1212</gd:phoneNumber>"
+	"<gd:phoneNumber rel='http://schemas.google.com/g/2005#mobile'>(206)555-1213</gd:phoneNumber>"
+	"<gd:structuredPostalAddress rel='http://schemas.google.com/g/2005#work'>"
+		"<gd:street>1600 Amphitheatre Parkway</gd:street><gd:city>Mountain View</gd:city><gd:postcode>94043</gd:postcode>"
+	"</gd:structuredPostalAddress>"
+	"<gd:organization rel='http://schemas.google.com/g/2005#work'><gd:orgName>Example Corp.</gd:orgName></gd:organization>"
+	"<gContact:website href='http://example.com/' rel='home-page'/>"
+	"<gContact:birthday when='1900-01-01'/>"
+	"<gContact:groupMembershipInfo href='http://www.google.com/feeds/contacts/groups/jo%%40gmail.com/base/1234a' deleted='false'/>";
+
+static const gchar youtube_video_template[] =
+	" gd:etag='W/\"CEMFSX47eCp7ImA9WxVUGEw.\"'>"
+	"<id>tag:youtube.com,2008:video:%u</id>"
+	"<published>2009-05-20T21:06:05.000Z</published>"
+	"<updated>2009-06-01T06:54:05.000Z</updated>"
+	"<category scheme='http://schemas.google.com/g/2005#kind' term='http://gdata.youtube.com/schemas/2007#video'/>"
+	"<category scheme='http://gdata.youtube.com/schemas/2007/categories.cat' term='Music' label='Music'/>"
+	"<title>Generated video</title>"
+	"<content type='application/x-shockwave-flash' src='http://www.youtube.com/v/_LeQuMpwbW4?f=standard&amp;app=youtube_gdata'/>"
+	"<link rel='alternate' type='text/html' href='http://www.youtube.com/watch?v=_LeQuMpwbW4&amp;feature=youtube_gdata'/>"
+	"<link rel='self' type='application/atom+xml' href='http://gdata.youtube.com/feeds/api/videos/_LeQuMpwbW4?v=2'/>"
+	"<author><name>GoogleDevelopers</name><uri>http://gdata.youtube.com/feeds/api/users/GoogleDevelopers</uri></author>"
+	"<gd:comments>"
+		"<gd:feedLink rel='http://gdata.youtube.com/schemas/2007#comments' "
+		             "href='http://gdata.youtube.com/feeds/api/videos/_LeQuMpwbW4/comments?v=2' countHint='7'/>"
+	"</gd:comments>"
+	"<media:group>"
+		"<media:category label='Music' scheme='http://gdata.youtube.com/schemas/2007/categories.cat'>Music</media:category>"
+		"<media:content url='http://www.youtube.com/v/_LeQuMpwbW4?f=standard&amp;app=youtube_gdata' type='application/x-shockwave-flash' "
+		               "medium='video' isDefault='true' expression='full' duration='215' yt:format='5'/>"
+		"<media:credit role='uploader' scheme='urn:youtube' yt:display='GoogleDevelopers'>googledevelopers</media:credit>"
+		"<media:description type='plain'>A video generated for testing.</media:description>"
+		"<media:keywords>generated, testing</media:keywords>"
+		"<media:player url='http://www.youtube.com/watch?v=_LeQuMpwbW4&amp;feature=youtube_gdata_player'/>"
+		"<media:thumbnail url='http://i.ytimg.com/vi/_LeQuMpwbW4/default.jpg' height='90' width='120' time='00:01:47.500' "
+		                 "yt:name='default'/>"
+		"<media:thumbnail url='http://i.ytimg.com/vi/_LeQuMpwbW4/hqdefault.jpg' height='360' width='480' yt:name='hqdefault'/>"
+		"<media:title type='plain'>Generated video</media:title>"
+		"<yt:duration seconds='215'/>"
+		"<yt:uploaded>2009-05-20T21:06:05.000Z</yt:uploaded>"
+		"<yt:videoid>_LeQuMpwbW4</yt:videoid>"
+	"</media:group>"
+	"<gd:rating average='4.9' max='5' min='1' numRaters='1056' rel='http://schemas.google.com/g/2005#overall'/>"
+	"<yt:statistics favoriteCount='1057' viewCount='120432'/>";
+
+static const gchar picasaweb_file_template[] =
+	" gd:etag='\"Qns7eDVSLyp7ImA9WxJTFkwFQQ0.\"'>"
+	"<id>http://picasaweb.google.com/data/entry/user/libgdata.picasaweb/albumid/5328889949261497249/photoid/%u</id>"
+	"<published>2009-04-25T15:21:53.688Z</published>"
+	"<updated>2009-04-25T15:21:53.688Z</updated>"
+	"<app:edited>2009-04-25T15:21:53.688Z</app:edited>"
+	"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/photos/2007#photo'/>"
+	"<title>generated.jpg</title>"
+	"<summary>A photo generated for testing.</summary>"
+	"<content type='image/jpeg' src='https://lh3.googleusercontent.com/-F5wqdCf7WlM/generated.jpg'/>"
+	"<link rel='self' type='application/atom+xml' "
+	      "href='https://picasaweb.google.com/data/entry/api/user/libgdata.picasaweb/albumid/5328889949261497249/photoid/5328890138794566386'/>"
+	"<gphoto:albumid>5328889949261497249</gphoto:albumid>"
+	"<gphoto:access>public</gphoto:access>"
+	"<gphoto:width>1024</gphoto:width>"
+	"<gphoto:height>768</gphoto:height>"
+	"<gphoto:size>143540</gphoto:size>"
+	"<gphoto:timestamp>1240672913000</gphoto:timestamp>"
+	"<gphoto:commentingEnabled>true</gphoto:commentingEnabled>"
+	"<gphoto:commentCount>0</gphoto:commentCount>"
+	"<exif:tags>"
+		"<exif:fstop>2.8</exif:fstop><exif:make>Canon</exif:make><exif:model>Canon PowerShot G9</exif:model>"
+		"<exif:exposure>0.016666668</exif:exposure><exif:flash>false</exif:flash><exif:focallength>7.4</exif:focallength>"
+		"<exif:iso>80</exif:iso><exif:time>1240672913000</exif:time>"
+	"</exif:tags>"
+	"<media:group>"
+		"<media:content url='https://lh3.googleusercontent.com/-F5wqdCf7WlM/generated.jpg' height='768' width='1024' type='image/jpeg' "
+		               "medium='image'/>"
+		"<media:credit>libgdata.picasaweb</media:credit>"
+		"<media:description type='plain'>A photo generated for testing.</media:description>"
+		"<media:keywords>generated</media:keywords>"
+		"<media:thumbnail url='https://lh3.googleusercontent.com/-F5wqdCf7WlM/s72/generated.jpg' height='54' width='72'/>"
+		"<media:title type='plain'>generated.jpg</media:title>"
+	"</media:group>";
+
+static const gchar json_entry_template[] =
+	"\"kind\": \"tasks#task\","
+	"\"id\": \"entry-%u\","
+	"\"etag\": \"\\\"etag\\\"\","
+	"\"title\": \"Generated entry\","
+	"\"updated\": \"2014-08-30T19:04:34.000Z\","
+	"\"selfLink\": \"https://www.googleapis.com/tasks/v1/lists/list/tasks/task\"";
+
+static const gchar tasks_task_template[] =
+	"\"kind\": \"tasks#task\","
+	"\"id\": \"MTEzNTY3MTg4NTUzOTU4NDQ4MzI6MDo3ODQxMjA1NjQ-%u\","
+	"\"etag\": \"\\\"ydsIn5hgu1IBj0la4T4xznQOfJ0/LTIwNTg0MzMzNjE\\\"\","
+	"\"title\": \"Buy milk\","
+	"\"updated\": \"2014-08-30T19:04:34.000Z\","
+	"\"selfLink\": \"https://www.googleapis.com/tasks/v1/lists/list/tasks/task\","
+	"\"parent\": \"MTEzNTY3MTg4NTUzOTU4NDQ4MzI6MDo3ODQxMjA1NjM\","
+	"\"position\": \"00000000000000130998\","
+	"\"notes\": \"Semi-skimmed.\","
+	"\"status\": \"needsAction\","
+	"\"due\": \"2014-09-02T00:00:00.000Z\","
+	"\"links\": [{\"type\": \"email\", \"description\": \"Email\", \"link\": \"https://mail.google.com/mail/#all/1234\"}],"
+	"\"deleted\": false,"
+	"\"hidden\": false";
+
+static const struct {
+	const gchar *name;
+	const gchar *template;
+	gboolean is_json;
+} kinds[GDATA_TEST_FEED_N_KINDS] = {
+	{ "entry", entry_template, FALSE },
+	{ "calendar-event", calendar_event_template, FALSE },
+	{ "contacts-contact", contacts_contact_template, FALSE },
+	{ "youtube-video", youtube_video_template, FALSE },
+	{ "picasaweb-file", picasaweb_file_template, FALSE },
+	{ "json-entry", json_entry_template, TRUE },
+	{ "tasks-task", tasks_task_template, TRUE },
+};
+
+const gchar *
+gdata_test_feed_kind_get_name (GDataTestFeedKind kind)
+{
+	g_return_val_if_fail (kind < GDATA_TEST_FEED_N_KINDS, NULL);
+	return kinds[kind].name;
+}
+
+/* Returns the type which entries of the given kind should be parsed as */
+GType
+gdata_test_feed_kind_get_entry_type (GDataTestFeedKind kind)
+{
+	switch (kind) {
+		case GDATA_TEST_FEED_ENTRY:
+		case GDATA_TEST_FEED_JSON_ENTRY:
+			return GDATA_TYPE_ENTRY;
+		case GDATA_TEST_FEED_CALENDAR_EVENT:
+			return GDATA_TYPE_CALENDAR_EVENT;
+		case GDATA_TEST_FEED_CONTACTS_CONTACT:
+			return GDATA_TYPE_CONTACTS_CONTACT;
+		case GDATA_TEST_FEED_YOUTUBE_VIDEO:
+			return GDATA_TYPE_YOUTUBE_VIDEO;
+		case GDATA_TEST_FEED_PICASAWEB_FILE:
+			return GDATA_TYPE_PICASAWEB_FILE;
+		case GDATA_TEST_FEED_TASKS_TASK:
+			return GDATA_TYPE_TASKS_TASK;
+		case GDATA_TEST_FEED_N_KINDS:
+		default:
+			g_assert_not_reached ();
+	}
+}
+
+gboolean
+gdata_test_feed_kind_is_json (GDataTestFeedKind kind)
+{
+	g_return_val_if_fail (kind < GDATA_TEST_FEED_N_KINDS, FALSE);
+	return kinds[kind].is_json;
+}
+
+static void
+append_entry (GString *output, GDataTestFeedKind kind, guint index, guint n_extension_elements, guint n_unknown_elements, gboolean standalone)
+{
+	guint i;
+
+	if (kinds[kind].is_json == TRUE) {
+		g_string_append_c (output, '{');
+		g_string_append_printf (output, kinds[kind].template, index);
+
+		if (n_extension_elements > 0) {
+			g_string_append (output, ",\"extendedProperties\": {\"private\": {");
+
+			for (i = 0; i < n_extension_elements; i++) {
+				if (i > 0)
+					g_string_append_c (output, ',');
+				g_string_append_printf (output, "\"property%u\": \"Value %u\"", i, i);
+			}
+
+			g_string_append (output, "}}");
+		}
+
+		for (i = 0; i < n_unknown_elements; i++)
+			g_string_append_printf (output, ",\"unknown%u\": {\"index\": %u, \"value\": \"Unknown content %u\"}", i, i, i);
+
+		g_string_append_c (output, '}');
+	} else {
+		g_string_append (output, "<entry");
+		if (standalone == TRUE)
+			g_string_append (output, " " ATOM_NAMESPACES);
+		g_string_append_printf (output, kinds[kind].template, index);
+
+		for (i = 0; i < n_extension_elements; i++)
+			g_string_append_printf (output, "<gd:extendedProperty name='property%u' value='Value %u'/>", i, i);
+
+		for (i = 0; i < n_unknown_elements; i++) {
+			g_string_append_printf (output, "<unknown:item index='%u'><unknown:value type='text'>Unknown content %u</unknown:value></unknown:item>",
+			                        i, i);
+		}
+
+		g_string_append (output, "</entry>");
+	}
+}
+
+/*
+ * gdata_test_generate_entry:
+ * @kind: the kind of entry to generate
+ * @index: a number to give the entry a unique ID
+ * @n_extension_elements: the number of extension elements to append to the entry
+ * @n_unknown_elements: the number of unknown elements to append to the entry
+ *
+ * Generates a standalone entry document (with all the namespace declarations it needs, if it's XML), suitable for passing to
+ * gdata_parsable_new_from_xml() or gdata_parsable_new_from_json() with the type returned by gdata_test_feed_kind_get_entry_type().
+ *
+ * Return value: (transfer full): the entry document
+ */
+gchar *
+gdata_test_generate_entry (GDataTestFeedKind kind, guint index, guint n_extension_elements, guint n_unknown_elements)
+{
+	GString *output;
+
+	g_return_val_if_fail (kind < GDATA_TEST_FEED_N_KINDS, NULL);
+
+	output = g_string_new (NULL);
+	append_entry (output, kind, index, n_extension_elements, n_unknown_elements, TRUE);
+
+	return g_string_free (output, FALSE);
+}
+
+/*
+ * gdata_test_generate_feed:
+ * @kind: the kind of entry to fill the feed with
+ * @n_entries: the number of entries to generate
+ * @n_extension_elements: the number of extension elements to append to each entry
+ * @n_unknown_elements: the number of unknown elements to append to each entry
+ * @length: (out caller-allocates) (allow-none): return location for the length of the feed document, or %NULL
+ *
+ * Generates a feed document containing @n_entries entries of the given @kind. It's an Atom feed or a JSON feed according to
+ * gdata_test_feed_kind_is_json(), and can be parsed as a #GDataFeed.
+ *
+ * The document is built in a single preallocated buffer, so generating feeds of a million entries is limited only by the memory available to hold
+ * them.
+ *
+ * Return value: (transfer full): the feed document
+ */
+gchar *
+gdata_test_generate_feed (GDataTestFeedKind kind, guint n_entries, guint n_extension_elements, guint n_unknown_elements, gsize *length)
+{
+	GString *output, *sample;
+	guint i;
+
+	g_return_val_if_fail (kind < GDATA_TEST_FEED_N_KINDS, NULL);
+
+	/* Measure an entry so the whole feed can be allocated up front, rather than by repeated doubling. A few bytes are added for entries with
+	 * longer IDs than the sample's, and the header and footer are comfortably shorter than 1KiB. */
+	sample = g_string_new (NULL);
+	append_entry (sample, kind, 0, n_extension_elements, n_unknown_elements, FALSE);
+	output = g_string_sized_new ((gsize) n_entries * (sample->len + 8) + 1024);
+	g_string_free (sample, TRUE);
+
+	if (kinds[kind].is_json == TRUE) {
+		g_string_append (output, "{\"kind\": \"tasks#tasks\", \"etag\": \"\\\"feed-etag\\\"\", "
+		                         "\"selfLink\": \"https://www.googleapis.com/tasks/v1/lists/list/tasks\", \"items\": [");
+
+		for (i = 0; i < n_entries; i++) {
+			if (i > 0)
+				g_string_append_c (output, ',');
+			append_entry (output, kind, i, n_extension_elements, n_unknown_elements, FALSE);
+		}
+
+		g_string_append (output, "]}");
+	} else {
+		g_string_append (output, "<?xml version='1.0' encoding='UTF-8'?>"
+		                         "<feed " ATOM_NAMESPACES
+		                         "xmlns:openSearch='http://a9.com/-/spec/opensearch/1.1/' "
+		                         "gd:etag='W/\"D08FQn8-eil7ImA9WxZbFEw.\"'>"
+		                         "<id>http://example.com/id</id>"
+		                         "<updated>2009-02-25T14:07:37.880860Z</updated>"
+		                         "<title type='text'>Generated feed</title>"
+		                         "<link rel='http://schemas.google.com/g/2005#feed' type='application/atom+xml' href='http://example.com/id'/>"
+		                         "<link rel='self' type='application/atom+xml' href='http://example.com/id'/>"
+		                         "<author><name>Joe Smith</name><email>j.smith@example.com</email></author>");
+		g_string_append_printf (output, "<openSearch:totalResults>%u</openSearch:totalResults>"
+		                                "<openSearch:startIndex>1</openSearch:startIndex>"
+		                                "<openSearch:itemsPerPage>%u</openSearch:itemsPerPage>", n_entries, n_entries);
+
+		for (i = 0; i < n_entries; i++)
+			append_entry (output, kind, i, n_extension_elements, n_unknown_elements, FALSE);
+
+		g_string_append (output, "</feed>");
+	}
+
+	if (length != NULL)
+		*length = output->len;
+
+	return g_string_free (output, FALSE);
+}
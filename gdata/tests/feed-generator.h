@@ -0,0 +1,51 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <gdata/gdata.h>
+
+#ifndef GDATA_TEST_FEED_GENERATOR_H
+#define GDATA_TEST_FEED_GENERATOR_H
+
+G_BEGIN_DECLS
+
+/* The kinds of entry which synthetic feeds can be generated for. Each is modelled on what the corresponding service returns, and is generated as
+ * Atom XML or as JSON according to what that service uses. */
+typedef enum {
+	GDATA_TEST_FEED_ENTRY = 0, /* Atom */
+	GDATA_TEST_FEED_CALENDAR_EVENT, /* Atom */
+	GDATA_TEST_FEED_CONTACTS_CONTACT, /* Atom */
+	GDATA_TEST_FEED_YOUTUBE_VIDEO, /* Atom */
+	GDATA_TEST_FEED_PICASAWEB_FILE, /* Atom */
+	GDATA_TEST_FEED_JSON_ENTRY, /* JSON */
+	GDATA_TEST_FEED_TASKS_TASK, /* JSON */
+	GDATA_TEST_FEED_N_KINDS
+} GDataTestFeedKind;
+
+const gchar *gdata_test_feed_kind_get_name (GDataTestFeedKind kind) G_GNUC_CONST;
+GType gdata_test_feed_kind_get_entry_type (GDataTestFeedKind kind);
+gboolean gdata_test_feed_kind_is_json (GDataTestFeedKind kind) G_GNUC_CONST;
+
+gchar *gdata_test_generate_entry (GDataTestFeedKind kind, guint index, guint n_extension_elements, guint n_unknown_elements) G_GNUC_MALLOC;
+gchar *gdata_test_generate_feed (GDataTestFeedKind kind, guint n_entries, guint n_extension_elements, guint n_unknown_elements,
+                                 gsize *length) G_GNUC_MALLOC;
+
+G_END_DECLS
+
+#endif /* !GDATA_TEST_FEED_GENERATOR_H */
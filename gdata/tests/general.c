@@ -19,10 +19,214 @@
 
 #include <glib.h>
 #include <locale.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
 
 #include "gdata.h"
+#include "gdata-xml-scanner.h"
 #include "common.h"
 
+static UhmServer *mock_server = NULL;
+
+/* Skips the current test if it can't be run against the online service, either because its traces were written by hand or because it depends on
+ * how the mock server times its responses. Returns %TRUE if the test should be skipped. */
+static gboolean
+skip_if_not_offline (void)
+{
+	if (uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Ignoring test due to logging being enabled.");
+		return TRUE;
+	} else if (uhm_server_get_enable_online (mock_server) == TRUE) {
+		g_test_message ("Ignoring test due to running online and test not being reproducible.");
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* A request received by the mock server, as recorded by a RequestLog */
+typedef struct {
+	gchar *method;
+	gchar *path_and_query;
+	SoupMessageHeaders *headers;
+	GBytes *body;
+} LoggedRequest;
+
+/* Records the requests received by the mock server, so that tests can check their headers and bodies, which traces don't. The requests are still
+ * answered from the trace (or by any other handler connected to the server after the log's started). */
+typedef struct {
+	GMutex mutex; /* protects requests, since requests are handled in the mock server's thread */
+	GPtrArray *requests; /* owned LoggedRequest */
+	gulong handler_id;
+} RequestLog;
+
+static void
+logged_request_free (LoggedRequest *request)
+{
+	g_free (request->method);
+	g_free (request->path_and_query);
+	soup_message_headers_free (request->headers);
+	g_bytes_unref (request->body);
+	g_slice_free (LoggedRequest, request);
+}
+
+static void
+copy_header_cb (const gchar *name, const gchar *value, SoupMessageHeaders *headers)
+{
+	soup_message_headers_append (headers, name, value);
+}
+
+static gboolean
+request_log_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, RequestLog *log)
+{
+	LoggedRequest *request;
+	SoupURI *uri = soup_message_get_uri (message);
+	SoupBuffer *body;
+
+	request = g_slice_new (LoggedRequest);
+	request->method = g_strdup (message->method);
+	request->path_and_query = (uri->query != NULL) ? g_strdup_printf ("%s?%s", uri->path, uri->query) : g_strdup (uri->path);
+	request->headers = soup_message_headers_new (SOUP_MESSAGE_HEADERS_REQUEST);
+	soup_message_headers_foreach (message->request_headers, (SoupMessageHeadersForeachFunc) copy_header_cb, request->headers);
+
+	body = soup_message_body_flatten (message->request_body);
+	request->body = g_bytes_new (body->data, body->length);
+	soup_buffer_free (body);
+
+	g_mutex_lock (&(log->mutex));
+	g_ptr_array_add (log->requests, request);
+	g_mutex_unlock (&(log->mutex));
+
+	/* Let the trace answer the request */
+	return FALSE;
+}
+
+static RequestLog *
+request_log_start (void)
+{
+	RequestLog *log;
+
+	log = g_slice_new (RequestLog);
+	g_mutex_init (&(log->mutex));
+	log->requests = g_ptr_array_new_with_free_func ((GDestroyNotify) logged_request_free);
+	log->handler_id = g_signal_connect (mock_server, "handle-message", (GCallback) request_log_handle_message_cb, log);
+
+	return log;
+}
+
+static void
+request_log_stop (RequestLog *log)
+{
+	g_signal_handler_disconnect (mock_server, log->handler_id);
+	g_ptr_array_unref (log->requests);
+	g_mutex_clear (&(log->mutex));
+	g_slice_free (RequestLog, log);
+}
+
+static guint
+request_log_get_length (RequestLog *log)
+{
+	guint length;
+
+	g_mutex_lock (&(log->mutex));
+	length = log->requests->len;
+	g_mutex_unlock (&(log->mutex));
+
+	return length;
+}
+
+static const LoggedRequest *
+request_log_get (RequestLog *log, guint i)
+{
+	const LoggedRequest *request;
+
+	g_mutex_lock (&(log->mutex));
+	g_assert_cmpuint (i, <, log->requests->len);
+	request = g_ptr_array_index (log->requests, i);
+	g_mutex_unlock (&(log->mutex));
+
+	return request;
+}
+
+/* An authorizer which adds a numbered token to each request, and gets a new token each time its authorization is refreshed */
+#define TYPE_TEST_AUTHORIZER		(test_authorizer_get_type ())
+#define TEST_AUTHORIZER(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), TYPE_TEST_AUTHORIZER, TestAuthorizer))
+
+typedef struct {
+	GObject parent;
+	volatile gint n_refreshes;
+} TestAuthorizer;
+
+typedef struct {
+	GObjectClass parent;
+} TestAuthorizerClass;
+
+static GType test_authorizer_get_type (void) G_GNUC_CONST;
+static void test_authorizer_authorizer_init (GDataAuthorizerInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestAuthorizer, test_authorizer, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_AUTHORIZER, test_authorizer_authorizer_init))
+
+static void
+test_authorizer_class_init (TestAuthorizerClass *klass)
+{
+	/* Nothing to see here */
+}
+
+static void
+test_authorizer_init (TestAuthorizer *self)
+{
+	/* Nothing to see here */
+}
+
+static void
+test_authorizer_process_request (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message)
+{
+	gchar *token;
+
+	token = g_strdup_printf ("Bearer token-%d", g_atomic_int_get (&(TEST_AUTHORIZER (self)->n_refreshes)) + 1);
+	soup_message_headers_replace (message->request_headers, "Authorization", token);
+	g_free (token);
+}
+
+static gboolean
+test_authorizer_is_authorized_for_domain (GDataAuthorizer *self, GDataAuthorizationDomain *domain)
+{
+	return TRUE;
+}
+
+static gboolean
+test_authorizer_refresh_authorization (GDataAuthorizer *self, GCancellable *cancellable, GError **error)
+{
+	g_atomic_int_inc (&(TEST_AUTHORIZER (self)->n_refreshes));
+	return TRUE;
+}
+
+static void
+test_authorizer_authorizer_init (GDataAuthorizerInterface *iface)
+{
+	iface->process_request = test_authorizer_process_request;
+	iface->is_authorized_for_domain = test_authorizer_is_authorized_for_domain;
+	iface->refresh_authorization = test_authorizer_refresh_authorization;
+}
+
+static void
+async_ready_cb (GObject *source_object, GAsyncResult *async_result, GAsyncResult **async_result_out)
+{
+	*async_result_out = g_object_ref (async_result);
+}
+
+/* Iterates the thread-default main context until an asynchronous operation using async_ready_cb() has finished, and returns its result */
+static GAsyncResult *
+wait_for_async_result (GAsyncResult **async_result)
+{
+	while (*async_result == NULL)
+		g_main_context_iteration (NULL, TRUE);
+
+	return *async_result;
+}
+
 static void
 test_xml_comparison (void)
 {
@@ -202,7 +406,7 @@ test_entry_get_xml (void)
 	GDataLink *_link; /* stupid unistd.h */
 	GDataAuthor *author;
 	gchar *xml, *title, *summary, *id, *etag, *content, *content_uri, *rights;
-	gboolean is_inserted;
+	gboolean is_inserted, is_partial;
 	GList *list;
 	GError *error = NULL;
 
@@ -415,6 +619,7 @@ test_entry_get_xml (void)
 	              "content", &content,
 	              "content-uri", &content_uri,
 	              "is-inserted", &is_inserted,
+	              "is-partial", &is_partial,
 	              "rights", &rights,
 	              NULL);
 
@@ -427,6 +632,8 @@ test_entry_get_xml (void)
 	g_assert_cmpstr (content, ==, gdata_entry_get_content (entry));
 	g_assert_cmpstr (content_uri, ==, gdata_entry_get_content_uri (entry));
 	g_assert (is_inserted == FALSE);
+	g_assert (is_partial == FALSE);
+	g_assert (gdata_entry_is_partial (entry2) == FALSE);
 	g_assert_cmpstr (rights, ==, gdata_entry_get_rights (entry));
 
 	g_free (title);
@@ -455,6 +662,65 @@ test_entry_get_xml (void)
 	g_object_unref (entry2);
 }
 
+/* A subclass of GDataEntry which overrides get_json without registering a JSON write function, so that its JSON is built as a tree */
+typedef GDataEntry TestTreeEntry;
+typedef GDataEntryClass TestTreeEntryClass;
+
+static GType test_tree_entry_get_type (void) G_GNUC_CONST;
+G_DEFINE_TYPE (TestTreeEntry, test_tree_entry, GDATA_TYPE_ENTRY)
+
+static void
+test_tree_entry_get_json (GDataParsable *parsable, JsonBuilder *builder)
+{
+	GDATA_PARSABLE_CLASS (test_tree_entry_parent_class)->get_json (parsable, builder);
+}
+
+static void
+test_tree_entry_class_init (TestTreeEntryClass *klass)
+{
+	GDATA_PARSABLE_CLASS (klass)->get_json = test_tree_entry_get_json;
+}
+
+static void
+test_tree_entry_init (TestTreeEntry *self)
+{
+	/* Nothing to see here */
+}
+
+static void
+test_entry_get_json_streamed (void)
+{
+	const gchar *json =
+		"{"
+			"\"title\":\"Title with \\\"quotes\\\", a \\\\ backslash, a \\n newline, a \\u0001 control character and ünïcödé\","
+			"\"id\":\"some-id\","
+			"\"updated\":\"2009-01-25T14:07:37Z\","
+			"\"etag\":\"some-etag\","
+			"\"unhandled-object\":{\"string\":\"value\",\"int\":-42,\"double\":1.5,\"bool\":true,\"null\":null},"
+			"\"unhandled-array\":[1,\"two\",[],{}]"
+		"}";
+	GDataEntry *entry, *tree_entry;
+	gchar *streamed_json, *tree_json;
+	GError *error = NULL;
+
+	entry = GDATA_ENTRY (gdata_parsable_new_from_json (GDATA_TYPE_ENTRY, json, -1, &error));
+	g_assert_no_error (error);
+	tree_entry = GDATA_ENTRY (gdata_parsable_new_from_json (test_tree_entry_get_type (), json, -1, &error));
+	g_assert_no_error (error);
+
+	/* The JSON written directly should be equivalent to that built as a tree, including the unhandled members */
+	streamed_json = gdata_parsable_get_json (GDATA_PARSABLE (entry));
+	tree_json = gdata_parsable_get_json (GDATA_PARSABLE (tree_entry));
+
+	g_assert (gdata_test_compare_json_strings (streamed_json, tree_json, TRUE) == TRUE);
+
+	g_free (tree_json);
+	g_free (streamed_json);
+
+	g_object_unref (tree_entry);
+	g_object_unref (entry);
+}
+
 static void
 test_entry_get_json (void)
 {
@@ -608,821 +874,5929 @@ test_entry_parse_json (void)
 }
 
 static void
-test_entry_error_handling_xml (void)
+test_entry_variant (void)
 {
-	GDataEntry *entry;
+	GDataEntry *entry, *entry2;
+	GVariant *variant, *variant2;
+	gpointer data;
+	gchar *xml, *xml2;
 	GError *error = NULL;
 
-#define TEST_XML_ERROR_HANDLING(x) entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,\
-		"<entry>"\
-			x\
-		"</entry>", -1, &error));\
-	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);\
-	g_assert (entry == NULL);\
-	g_clear_error (&error)
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' "
+		       "xmlns:foo='http://example.com/foo' gd:etag='W/\"entry-etag\"'>"
+			"<title type='text'>Escaped &amp; &lt;title&gt;</title>"
+			"<id>some-id</id>"
+			"<updated>2009-01-25T14:07:37Z</updated>"
+			"<category term='http://schemas.google.com/g/2005#kind' scheme='http://schemas.google.com/g/2005#kind'/>"
+			"<link rel='self' href='http://example.com/'/>"
+			"<foo:unhandled foo:attribute='value'>Text <foo:child/> more text</foo:unhandled>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_clear_error (&error);
 
-	/* updated */
-	TEST_XML_ERROR_HANDLING ("<updated>not a date</updated>"); /* invalid date */
+	variant = gdata_parsable_get_variant (GDATA_PARSABLE (entry));
+	g_assert (variant != NULL);
+	g_assert (g_variant_is_floating (variant) == FALSE);
 
-	/* published */
-	TEST_XML_ERROR_HANDLING ("<published>also not a date</published>"); /* invalid date */
+	/* Round-trip the variant through its serialised form, as a cache would */
+	data = g_memdup (g_variant_get_data (variant), g_variant_get_size (variant));
+	variant2 = g_variant_new_from_data (g_variant_get_type (variant), data, g_variant_get_size (variant), FALSE, g_free, data);
+	g_variant_unref (variant);
 
-	/* category */
-	TEST_XML_ERROR_HANDLING ("<category/>"); /* invalid category */
+	entry2 = GDATA_ENTRY (gdata_parsable_new_from_variant (GDATA_TYPE_ENTRY, variant2, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry2));
+	g_clear_error (&error);
 
-	/* link */
-	TEST_XML_ERROR_HANDLING ("<link/>"); /* invalid link */
+	/* The new entry should be identical to the old one, including its unhandled XML and namespaces */
+	g_assert_cmpstr (gdata_entry_get_title (entry2), ==, "Escaped & <title>");
+	g_assert_cmpstr (gdata_entry_get_id (entry2), ==, "some-id");
+	g_assert_cmpstr (gdata_entry_get_etag (entry2), ==, "W/\"entry-etag\"");
+	g_assert_cmpint (gdata_entry_get_updated (entry2), ==, 1232892457);
 
-	/* author */
-	TEST_XML_ERROR_HANDLING ("<author/>"); /* invalid author */
+	xml = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
+	xml2 = gdata_parsable_get_xml (GDATA_PARSABLE (entry2));
+	g_assert_cmpstr (xml2, ==, xml);
+	g_free (xml2);
+	g_free (xml);
 
-#undef TEST_XML_ERROR_HANDLING
+	/* Loading the variant as the wrong type should fail */
+	variant = gdata_parsable_get_variant (GDATA_PARSABLE (entry2));
+	g_assert (gdata_parsable_new_from_variant (GDATA_TYPE_FEED, variant, &error) == NULL);
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_clear_error (&error);
+	g_variant_unref (variant);
+
+	/* As should loading something which isn't a variant from gdata_parsable_get_variant() */
+	g_assert (gdata_parsable_new_from_variant (GDATA_TYPE_ENTRY, g_variant_new_string ("not an entry"), &error) == NULL);
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_clear_error (&error);
+
+	g_assert (gdata_parsable_new_from_variant (GDATA_TYPE_ENTRY, g_variant_new ("(usv)", 1000, "GDataEntry", g_variant_new_string ("")),
+	                                           &error) == NULL);
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_clear_error (&error);
+
+	g_object_unref (entry2);
+	g_object_unref (entry);
 }
 
 static void
-test_entry_error_handling_json (void)
+test_entry_clone (void)
 {
-	GDataEntry *entry;
+	GDataEntry *entry, *clone;
+	GDataLink *link;
+	gchar *xml, *xml2;
 	GError *error = NULL;
 
-#define TEST_JSON_ERROR_HANDLING(x) \
-	entry = GDATA_ENTRY (gdata_parsable_new_from_json (GDATA_TYPE_ENTRY,x, -1, &error));\
-	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);\
-	g_assert (entry == NULL);\
-	g_clear_error (&error)
-#define TEST_JSON_ERROR_HANDLING_PARSER(x) \
-	entry = GDATA_ENTRY (gdata_parsable_new_from_json (GDATA_TYPE_ENTRY,x, -1, &error));\
-	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);\
-	g_assert (entry == NULL);\
-	g_clear_error (&error)
-
-	/* General structure. */
-	TEST_JSON_ERROR_HANDLING_PARSER ("[true,false,true]"); /* root node is not an object */
-	TEST_JSON_ERROR_HANDLING_PARSER ("false"); /* root node is not an object */
-	TEST_JSON_ERROR_HANDLING_PARSER ("invalid json"); /* totally invalid JSON */
-
-	/* id */
-	TEST_JSON_ERROR_HANDLING ("{\"id\":\"\"}"); /* empty */
-	TEST_JSON_ERROR_HANDLING ("{\"id\":null}"); /* invalid type */
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' "
+		       "xmlns:foo='http://example.com/foo' gd:etag='W/\"entry-etag\"'>"
+			"<title type='text'>Escaped &amp; &lt;title&gt;</title>"
+			"<id>some-id</id>"
+			"<updated>2009-01-25T14:07:37Z</updated>"
+			"<category term='http://schemas.google.com/g/2005#kind' scheme='http://schemas.google.com/g/2005#kind'/>"
+			"<link rel='self' href='http://example.com/'/>"
+			"<author><name>Joe Bloggs</name><email>joe@example.com</email></author>"
+			"<foo:unhandled foo:attribute='value'>Text <foo:child/> more text</foo:unhandled>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_clear_error (&error);
 
-	/* updated */
-	TEST_JSON_ERROR_HANDLING ("{\"updated\":\"not correct\"}"); /* incorrect format */
-	TEST_JSON_ERROR_HANDLING ("{\"updated\":false}"); /* invalid type */
-	TEST_JSON_ERROR_HANDLING ("{\"updated\":\"\"}"); /* empty */
+	gdata_entry_set_summary (entry, "Summary");
 
-	/* title */
-	TEST_JSON_ERROR_HANDLING ("{\"title\":false}"); /* invalid type */
+	clone = GDATA_ENTRY (gdata_parsable_clone (GDATA_PARSABLE (entry)));
+	g_assert (GDATA_IS_ENTRY (clone));
+	g_assert (clone != entry);
 
-	/* etag */
-	TEST_JSON_ERROR_HANDLING ("{\"etag\":\"\"}"); /* empty */
-	TEST_JSON_ERROR_HANDLING ("{\"etag\":false}"); /* invalid type */
+	/* The clone should be identical, including its unhandled XML and its changes since it was parsed */
+	g_assert_cmpstr (gdata_entry_get_title (clone), ==, "Escaped & <title>");
+	g_assert_cmpstr (gdata_entry_get_summary (clone), ==, "Summary");
+	g_assert_cmpint (gdata_entry_get_updated (clone), ==, 1232892457);
+	g_assert (gdata_entry_is_dirty (clone) == TRUE);
 
-	/* selfLink */
-	TEST_JSON_ERROR_HANDLING ("{\"selfLink\":\"\"}"); /* empty */
-	TEST_JSON_ERROR_HANDLING ("{\"selfLink\":false}"); /* invalid type */
+	xml = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
+	xml2 = gdata_parsable_get_xml (GDATA_PARSABLE (clone));
+	g_assert_cmpstr (xml2, ==, xml);
+	g_free (xml2);
+
+	/* Modifying the clone's links shouldn't affect the original */
+	link = gdata_entry_look_up_link (clone, GDATA_LINK_SELF);
+	g_assert (link != NULL);
+	g_assert (link != gdata_entry_look_up_link (entry, GDATA_LINK_SELF));
+	gdata_link_set_uri (link, "http://example.com/other");
+	gdata_entry_set_title (clone, "Changed");
+
+	xml2 = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
+	g_assert_cmpstr (xml2, ==, xml);
+	g_free (xml2);
+	g_free (xml);
 
-	/* kind */
-	TEST_JSON_ERROR_HANDLING ("{\"kind\":\"\"}"); /* empty */
-	TEST_JSON_ERROR_HANDLING ("{\"kind\":false}"); /* invalid type */
+	g_assert_cmpstr (gdata_link_get_uri (gdata_entry_look_up_link (entry, GDATA_LINK_SELF)), ==, "http://example.com/");
 
-#undef TEST_JSON_ERROR_HANDLING_PARSER
-#undef TEST_JSON_ERROR_HANDLING
+	g_object_unref (clone);
+	g_object_unref (entry);
 }
 
 static void
-test_entry_escaping (void)
+test_entry_dup_properties (void)
 {
 	GDataEntry *entry;
+	GVariant *properties;
+	const gchar *title;
+	gint64 updated;
+	gboolean is_inserted;
+	const gchar * const property_names[] = { "title", "updated", NULL };
 	GError *error = NULL;
 
-	/* Since we can't construct a GDataEntry directly, we need to parse it from XML */
 	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
-		"<?xml version='1.0' encoding='UTF-8'?>"
 		"<entry xmlns='http://www.w3.org/2005/Atom'>"
-			"<title type='text'>Escaped content &amp; stuff</title>"
-			"<id>http://foo.com/?foo&amp;bar</id>"
-			"<updated>2010-12-10T17:21:24Z</updated>"
-			"<published>2010-12-10T17:21:24Z</published>"
-			"<summary type='text'>Summary &amp; stuff</summary>"
-			"<rights>Free &amp; open source</rights>"
-			"<content type='text'>Content &amp; things.</content>"
+			"<title type='text'>Title</title>"
+			"<id>some-id</id>"
+			"<updated>2009-01-25T14:07:37Z</updated>"
 		"</entry>", -1, &error));
 	g_assert_no_error (error);
 	g_assert (GDATA_IS_ENTRY (entry));
 
-	/* Check the outputted XML is escaped properly */
-	gdata_test_assert_xml (entry,
-		"<?xml version='1.0' encoding='UTF-8'?>"
-		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
-			"<title type='text'>Escaped content &amp; stuff</title>"
-			"<id>http://foo.com/?foo&amp;bar</id>"
-			"<updated>2010-12-10T17:21:24Z</updated>"
-			"<published>2010-12-10T17:21:24Z</published>"
-			"<summary type='text'>Summary &amp; stuff</summary>"
-			"<rights>Free &amp; open source</rights>"
-			"<content type='text'>Content &amp; things.</content>"
-		"</entry>");
+	/* All readable properties should be returned, except unset ones */
+	properties = gdata_parsable_dup_properties (GDATA_PARSABLE (entry), NULL);
+	g_assert (g_variant_is_of_type (properties, G_VARIANT_TYPE_VARDICT) == TRUE);
+	g_assert (g_variant_lookup (properties, "title", "&s", &title) == TRUE);
+	g_assert_cmpstr (title, ==, "Title");
+	g_assert (g_variant_lookup (properties, "id", "&s", &title) == TRUE);
+	g_assert_cmpstr (title, ==, "some-id");
+	g_assert (g_variant_lookup (properties, "updated", "x", &updated) == TRUE);
+	g_assert_cmpint (updated, ==, 1232892457);
+	g_assert (g_variant_lookup (properties, "is-inserted", "b", &is_inserted) == TRUE);
+	g_assert (is_inserted == TRUE);
+	g_assert (g_variant_lookup_value (properties, "summary", NULL) == NULL);
+	g_variant_unref (properties);
+
+	/* Only the requested properties should be returned */
+	properties = gdata_parsable_dup_properties (GDATA_PARSABLE (entry), property_names);
+	g_assert_cmpuint (g_variant_n_children (properties), ==, 2);
+	g_assert (g_variant_lookup (properties, "title", "&s", &title) == TRUE);
+	g_assert_cmpstr (title, ==, "Title");
+	g_assert (g_variant_lookup (properties, "updated", "x", &updated) == TRUE);
+	g_variant_unref (properties);
+
 	g_object_unref (entry);
+}
+
+static void
+test_parsable_accounting (void)
+{
+	GDataEntry *entry;
+	guint n_entries, n_links, n_entries_before;
+	gsize n_bytes, n_bytes_before;
+	GVariant *accounts;
+	guint32 variant_n_instances;
+	guint64 variant_n_bytes;
+	GError *error = NULL;
+
+	g_assert (gdata_parsable_get_accounting_enabled () == FALSE);
+	gdata_parsable_get_accounts (GDATA_TYPE_ENTRY, &n_entries_before, &n_bytes_before);
+
+	gdata_parsable_set_accounting_enabled (TRUE);
+	g_assert (gdata_parsable_get_accounting_enabled () == TRUE);
 
-	/* Repeat with content given by a URI */
 	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
-		"<?xml version='1.0' encoding='UTF-8'?>"
-		"<entry xmlns='http://www.w3.org/2005/Atom'>"
-			"<title type='text'>Escaped content &amp; stuff</title>"
-			"<content type='text/plain' src='http://foo.com?foo&amp;bar'/>"
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:foo='http://example.com/foo'>"
+			"<title type='text'>Title</title>"
+			"<id>some-id</id>"
+			"<updated>2009-01-25T14:07:37Z</updated>"
+			"<link rel='self' href='http://example.com/'/>"
+			"<foo:unhandled>Unhandled</foo:unhandled>"
 		"</entry>", -1, &error));
 	g_assert_no_error (error);
 	g_assert (GDATA_IS_ENTRY (entry));
 
-	/* Check the outputted XML is escaped properly */
-	gdata_test_assert_xml (entry,
-		"<?xml version='1.0' encoding='UTF-8'?>"
-		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
-			"<title type='text'>Escaped content &amp; stuff</title>"
-			"<content type='text/plain' src='http://foo.com?foo&amp;bar'/>"
-		"</entry>");
+	/* The entry and its link should both be accounted, each as its own type */
+	gdata_parsable_get_accounts (GDATA_TYPE_ENTRY, &n_entries, &n_bytes);
+	g_assert_cmpuint (n_entries, ==, n_entries_before + 1);
+	g_assert_cmpuint (n_bytes, >, n_bytes_before + strlen ("Title") + strlen ("some-id"));
+	gdata_parsable_get_accounts (GDATA_TYPE_LINK, &n_links, NULL);
+	g_assert_cmpuint (n_links, >=, 1);
+
+	/* Changing a property should update the accounts */
+	n_bytes_before = n_bytes;
+	gdata_entry_set_summary (entry, "A summary which is quite a bit longer than the title");
+	gdata_parsable_get_accounts (GDATA_TYPE_ENTRY, NULL, &n_bytes);
+	g_assert_cmpuint (n_bytes, >, n_bytes_before);
+
+	/* The snapshot should agree */
+	accounts = gdata_parsable_dup_accounts ();
+	g_assert (g_variant_is_of_type (accounts, G_VARIANT_TYPE ("a{s(ut)}")) == TRUE);
+	g_assert (g_variant_lookup (accounts, "GDataEntry", "(ut)", &variant_n_instances, &variant_n_bytes) == TRUE);
+	g_assert_cmpuint (variant_n_instances, ==, n_entries);
+	g_assert_cmpuint (variant_n_bytes, ==, n_bytes);
+	g_variant_unref (accounts);
+
+	/* Finalising the entry should remove it from the accounts, even once accounting's been disabled */
+	gdata_parsable_set_accounting_enabled (FALSE);
 	g_object_unref (entry);
+
+	gdata_parsable_get_accounts (GDATA_TYPE_ENTRY, &n_entries, NULL);
+	g_assert_cmpuint (n_entries, ==, n_entries_before);
 }
 
 static void
-test_entry_links_remove (void)
+test_parsable_profiling (void)
 {
 	GDataEntry *entry;
-	GDataLink *link_, *link2_;
+	GVariant *profile;
+	GVariantIter iter;
+	const gchar *type_name, *element_name;
+	guint32 n_calls;
+	guint64 n_microseconds, n_parsables;
+	gboolean found_author = FALSE, found_unhandled = FALSE;
 	GError *error = NULL;
 
-	/* Since we can't construct a GDataEntry directly, we need to parse it from XML. */
+	g_assert (gdata_parsable_get_profiling_enabled () == FALSE);
+
+	gdata_parsable_set_profiling_enabled (TRUE);
+	g_assert (gdata_parsable_get_profiling_enabled () == TRUE);
+	gdata_parsable_reset_profile ();
+
 	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
-		"<?xml version='1.0' encoding='UTF-8'?>"
-		"<entry xmlns='http://www.w3.org/2005/Atom'>"
-			"<title type='text'>Escaped content &amp; stuff</title>"
-			"<id>http://foo.com/?foo&amp;bar</id>"
-			"<updated>2010-12-10T17:21:24Z</updated>"
-			"<published>2010-12-10T17:21:24Z</published>"
-			"<summary type='text'>Summary &amp; stuff</summary>"
-			"<rights>Free &amp; open source</rights>"
-			"<content type='text'>Content &amp; things.</content>"
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:foo='http://example.com/foo'>"
+			"<title type='text'>Title</title>"
+			"<id>some-id</id>"
+			"<updated>2009-01-25T14:07:37Z</updated>"
+			"<author><name>John Smith</name></author>"
+			"<author><name>Jane Smith</name></author>"
+			"<foo:unhandled>Unhandled</foo:unhandled>"
 		"</entry>", -1, &error));
 	g_assert_no_error (error);
 	g_assert (GDATA_IS_ENTRY (entry));
+	g_object_unref (entry);
 
-	link_ = gdata_link_new ("http://example.com/", GDATA_LINK_RELATED);
+	gdata_parsable_set_profiling_enabled (FALSE);
+
+	/* Each author should have been counted, along with the GDataAuthor constructed for it; and unhandled elements should be named with their
+	 * namespace prefix */
+	profile = gdata_parsable_dup_profile ();
+	g_assert (g_variant_is_of_type (profile, G_VARIANT_TYPE ("a(ssutt)")) == TRUE);
+
+	g_variant_iter_init (&iter, profile);
+	while (g_variant_iter_next (&iter, "(&s&sutt)", &type_name, &element_name, &n_calls, &n_microseconds, &n_parsables) == TRUE) {
+		if (strcmp (type_name, "GDataEntry") == 0 && strcmp (element_name, "author") == 0) {
+			g_assert_cmpuint (n_calls, ==, 2);
+			g_assert_cmpuint (n_parsables, ==, 2);
+			found_author = TRUE;
+		} else if (strcmp (type_name, "GDataEntry") == 0 && strcmp (element_name, "foo:unhandled") == 0) {
+			g_assert_cmpuint (n_calls, ==, 1);
+			g_assert_cmpuint (n_parsables, ==, 0);
+			found_unhandled = TRUE;
+		}
+	}
 
-	/* Add a link. */
-	gdata_entry_add_link (entry, link_);
-	g_assert (gdata_entry_look_up_link (entry, GDATA_LINK_RELATED) == link_);
+	g_assert (found_author == TRUE);
+	g_assert (found_unhandled == TRUE);
+	g_variant_unref (profile);
 
-	/* Remove the link. */
-	g_assert (gdata_entry_remove_link (entry, link_) == TRUE);
-	g_assert (gdata_entry_look_up_link (entry, GDATA_LINK_RELATED) == NULL);
+	/* Resetting the profile should empty it */
+	gdata_parsable_reset_profile ();
+	profile = gdata_parsable_dup_profile ();
+	g_assert_cmpuint (g_variant_n_children (profile), ==, 0);
+	g_variant_unref (profile);
+}
 
-	/* Attempt to remove a non-existent link. */
-	link2_ = gdata_link_new ("http://foobar.com/", GDATA_LINK_SELF);
-	g_assert (gdata_entry_remove_link (entry, link2_) == FALSE);
+#define INCREMENTAL_FEED \
+	"<feed xmlns='http://www.w3.org/2005/Atom'>" \
+		"<id>feed-id</id>" \
+		"<updated>2009-01-25T14:07:37Z</updated>" \
+		"<title type='text'>Feed</title>" \
+		"<entry><title type='text'>Entry 1</title><id>entry-1</id><updated>2009-01-25T14:07:37Z</updated></entry>" \
+		"<entry><title type='text'>Entry 2</title><id>entry-2</id><updated>2009-01-25T14:07:37Z</updated></entry>" \
+		"<entry><title type='text'>Entry 3</title><id>entry-3</id><updated>2009-01-25T14:07:37Z</updated></entry>" \
+	"</feed>"
 
-	g_object_unref (link2_);
-	g_object_unref (link_);
-	g_object_unref (entry);
+static void
+incremental_parse_cb (GDataIncrementalParser *parser, GAsyncResult *async_result, GMainLoop *main_loop)
+{
+	GDataParsable *feed;
+	GError *error = NULL;
+
+	feed = gdata_incremental_parser_parse_finish (parser, async_result, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (GDATA_FEED (feed))), ==, 3);
+	g_object_unref (feed);
+
+	g_main_loop_quit (main_loop);
 }
 
 static void
-test_feed_parse_xml (void)
+test_parsable_incremental (void)
 {
+	GDataIncrementalParser *parser;
 	GDataFeed *feed;
-	GDataEntry *entry;
-	GDataLink *_link; /* stupid unistd.h */
-	GList *list;
-	gchar *title, *subtitle, *id, *etag, *logo, *icon, *rights;
-	gint64 updated, updated2;
-	GDataGenerator *generator;
-	guint items_per_page, start_index, total_results;
+	GList *entries;
+	GMainLoop *main_loop;
+	guint n_steps = 0;
 	GError *error = NULL;
 
-	feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED,
-		"<feed xmlns='http://www.w3.org/2005/Atom' "
-		      "xmlns:openSearch='http://a9.com/-/spec/opensearch/1.1/' "
-		      "xmlns:gd='http://schemas.google.com/g/2005' "
-		      "gd:etag='W/\"D08FQn8-eil7ImA9WxZbFEw.\"'>"
-			"<id>http://example.com/id</id>"
-			"<updated>2009-02-25T14:07:37.880860Z</updated>"
-			"<title type='text'>Test feed</title>"
-			"<subtitle type='text'>Test subtitle</subtitle>"
-			"<logo>http://example.com/logo.png</logo>"
-			"<icon>http://example.com/icon.png</icon>"
-			"<link rel='alternate' type='text/html' href='http://alternate.example.com/'/>"
-			"<link rel='http://schemas.google.com/g/2005#feed' type='application/atom+xml' href='http://example.com/id'/>"
-			"<link rel='http://schemas.google.com/g/2005#post' type='application/atom+xml' href='http://example.com/post'/>"
-			"<link rel='self' type='application/atom+xml' href='http://example.com/id'/>"
-			"<category scheme='http://example.com/categories' term='feed'/>"
-			"<rights>public</rights>"
-			"<author>"
-				"<name>Joe Smith</name>"
-				"<email>j.smith@example.com</email>"
-			"</author>"
-			"<generator version='0.6' uri='http://example.com/'>Example Generator</generator>"
-			"<openSearch:totalResults>2</openSearch:totalResults>"
-			"<openSearch:startIndex>1</openSearch:startIndex>"
-			"<openSearch:itemsPerPage>50</openSearch:itemsPerPage>"
-			"<entry>"
-				"<id>entry1</id>"
-				"<title type='text'>Testing unhandled XML</title>"
-				"<updated>2009-01-25T14:07:37.880860Z</updated>"
-				"<published>2009-01-23T14:06:37.880860Z</published>"
-				"<content type='text'>Here we test unhandled XML elements.</content>"
-			"</entry>"
-			"<entry>"
-				"<id>entry2</id>"
-				"<title type='text'>Testing unhandled XML 2</title>"
-				"<updated>2009-02-25T14:07:37.880860Z</updated>"
-				"<published>2009-02-23T14:06:37.880860Z</published>"
-				"<content type='text'>Here we test unhandled XML elements again.</content>"
-			"</entry>"
-			"<foobar>Test unhandled elements!</foobar>"
-		"</feed>", -1, &error));
-	g_assert_no_error (error);
+	/* Parse one child of the feed per step; there are three feed elements and three entries */
+	parser = gdata_incremental_parser_new (GDATA_TYPE_FEED, INCREMENTAL_FEED, -1);
+	g_assert_cmpuint (gdata_incremental_parser_get_time_budget (parser), ==, 8);
+	gdata_incremental_parser_set_time_budget (parser, 0);
+	gdata_incremental_parser_set_max_children (parser, 1);
+	g_assert_cmpuint (gdata_incremental_parser_get_max_children (parser), ==, 1);
+
+	while (gdata_incremental_parser_is_finished (parser) == FALSE) {
+		g_assert (gdata_incremental_parser_get_parsable (parser) == NULL);
+		g_assert (gdata_incremental_parser_step (parser, &error) == TRUE);
+		g_assert_no_error (error);
+		n_steps++;
+	}
+
+	g_assert_cmpuint (n_steps, ==, 6);
+
+	feed = GDATA_FEED (gdata_incremental_parser_get_parsable (parser));
 	g_assert (GDATA_IS_FEED (feed));
-	g_clear_error (&error);
+	g_assert_cmpstr (gdata_feed_get_id (feed), ==, "feed-id");
+	g_assert_cmpstr (gdata_feed_get_title (feed), ==, "Feed");
 
-	/* Check the feed's properties */
-	g_object_get (G_OBJECT (feed),
-	              "title", &title,
-	              "subtitle", &subtitle,
-	              "id", &id,
-	              "etag", &etag,
-	              "updated", &updated,
-	              "logo", &logo,
-	              "icon", &icon,
-	              "generator", &generator,
-	              "rights", &rights,
-	              "items-per-page", &items_per_page,
-	              "start-index", &start_index,
-	              "total-results", &total_results,
-	              NULL);
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, 3);
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (entries->data)), ==, "entry-1");
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (g_list_last (entries)->data)), ==, "entry-3");
 
-	g_assert_cmpstr (title, ==, "Test feed");
-	g_assert_cmpstr (subtitle, ==, "Test subtitle");
-	g_assert_cmpstr (id, ==, "http://example.com/id");
-	g_assert_cmpstr (etag, ==, "W/\"D08FQn8-eil7ImA9WxZbFEw.\"");
+	g_object_unref (parser);
 
-	g_assert_cmpint (updated, ==, 1235570857);
+	/* Without any limits, the whole feed should be parsed in one step */
+	parser = gdata_incremental_parser_new (GDATA_TYPE_FEED, INCREMENTAL_FEED, -1);
+	gdata_incremental_parser_set_time_budget (parser, 0);
+	g_assert (gdata_incremental_parser_step (parser, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert (gdata_incremental_parser_is_finished (parser) == TRUE);
+	g_object_unref (parser);
 
-	g_assert_cmpstr (logo, ==, "http://example.com/logo.png");
-	g_assert_cmpstr (icon, ==, "http://example.com/icon.png");
-	g_assert_cmpstr (rights, ==, "public");
+	/* Parse asynchronously, one child per idle callback */
+	main_loop = g_main_loop_new (NULL, FALSE);
 
-	g_assert (GDATA_IS_GENERATOR (generator));
-	g_assert_cmpstr (gdata_generator_get_name (generator), ==, "Example Generator");
-	g_assert_cmpstr (gdata_generator_get_uri (generator), ==, "http://example.com/");
-	g_assert_cmpstr (gdata_generator_get_version (generator), ==, "0.6");
+	parser = gdata_incremental_parser_new (GDATA_TYPE_FEED, INCREMENTAL_FEED, -1);
+	gdata_incremental_parser_set_max_children (parser, 1);
+	gdata_incremental_parser_parse_async (parser, NULL, (GAsyncReadyCallback) incremental_parse_cb, main_loop);
+	g_object_unref (parser);
 
-	g_assert_cmpuint (items_per_page, ==, 50);
-	g_assert_cmpuint (start_index, ==, 1);
-	g_assert_cmpuint (total_results, ==, 2);
+	g_main_loop_run (main_loop);
+	g_main_loop_unref (main_loop);
 
-	g_free (title);
-	g_free (subtitle);
-	g_free (id);
-	g_free (etag);
-	g_free (logo);
-	g_free (icon);
-	g_free (rights);
-	g_object_unref (generator);
+	/* Malformed XML should be reported by the step which reaches it */
+	parser = gdata_incremental_parser_new (GDATA_TYPE_FEED, "<feed xmlns='http://www.w3.org/2005/Atom'><id>feed-id</id><title>", -1);
+	gdata_incremental_parser_set_max_children (parser, 1);
 
-	/* Check the entries */
-	entry = gdata_feed_look_up_entry (feed, "entry1");
+	while (gdata_incremental_parser_step (parser, &error) == TRUE)
+		g_assert (gdata_incremental_parser_is_finished (parser) == FALSE);
+
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_assert (gdata_incremental_parser_is_finished (parser) == FALSE);
+	g_assert (gdata_incremental_parser_get_parsable (parser) == NULL);
+	g_clear_error (&error);
+
+	g_object_unref (parser);
+}
+
+static void
+test_entry_diff (void)
+{
+	GDataEntry *entry, *other;
+	GDataLink *link;
+	gchar **changes;
+	GError *error = NULL;
+
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='W/\"entry-etag\"'>"
+			"<title type='text'>Title</title>"
+			"<id>some-id</id>"
+			"<updated>2009-01-25T14:07:37Z</updated>"
+			"<link rel='self' href='http://example.com/'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
 	g_assert (GDATA_IS_ENTRY (entry));
+	g_clear_error (&error);
 
-	entry = gdata_feed_look_up_entry (feed, "this doesn't exist");
-	g_assert (entry == NULL);
+	/* Identical entries */
+	other = GDATA_ENTRY (gdata_parsable_clone (GDATA_PARSABLE (entry)));
+	changes = gdata_entry_diff (entry, other);
+	g_assert (changes != NULL);
+	g_assert (changes[0] == NULL);
+	g_strfreev (changes);
+
+	/* Local changes are noticed even though the ETags match */
+	gdata_entry_set_title (other, "New title");
+	link = gdata_entry_look_up_link (other, GDATA_LINK_SELF);
+	gdata_link_set_uri (link, "http://example.com/other");
+
+	changes = gdata_entry_diff (entry, other);
+	g_assert (changes != NULL);
+	g_assert_cmpuint (g_strv_length (changes), ==, 2);
+	g_assert_cmpstr (changes[0], ==, "title");
+	g_assert_cmpstr (changes[1], ==, "links");
+	g_strfreev (changes);
+
+	g_object_unref (other);
+	g_object_unref (entry);
+}
 
-	entry = gdata_feed_look_up_entry (feed, "entry2");
+static void
+test_entry_constructed_from_xml (void)
+{
+	GDataEntry *entry;
+	GDataLink *link;
+	gboolean constructed_from_xml;
+	GError *error = NULL;
+
+	/* Parsed entries and their children should be marked as such, but nothing constructed while they're constructed should be */
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom'>"
+			"<title type='text'>Title</title>"
+			"<link rel='self' href='http://example.com/'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
 	g_assert (GDATA_IS_ENTRY (entry));
+	g_clear_error (&error);
 
-	/* Check the categories */
-	list = gdata_feed_get_categories (feed);
-	g_assert (list != NULL);
-	g_assert_cmpint (g_list_length (list), ==, 1);
-	g_assert (GDATA_IS_CATEGORY (list->data));
+	g_object_get (entry, "constructed-from-xml", &constructed_from_xml, NULL);
+	g_assert (constructed_from_xml == TRUE);
 
-	/* Check the links */
-	list = gdata_feed_get_links (feed);
-	g_assert (list != NULL);
-	g_assert_cmpint (g_list_length (list), ==, 4);
-	g_assert (GDATA_IS_LINK (list->data));
-	g_assert (GDATA_IS_LINK (list->next->data));
-	g_assert (GDATA_IS_LINK (list->next->next->data));
-	g_assert (GDATA_IS_LINK (list->next->next->next->data));
+	link = gdata_entry_look_up_link (entry, GDATA_LINK_SELF);
+	g_object_get (link, "constructed-from-xml", &constructed_from_xml, NULL);
+	g_assert (constructed_from_xml == TRUE);
 
-	_link = gdata_feed_look_up_link (feed, GDATA_LINK_ALTERNATE);
-	g_assert (GDATA_IS_LINK (_link));
+	g_object_unref (entry);
 
-	_link = gdata_feed_look_up_link (feed, "this doesn't exist");
-	g_assert (_link == NULL);
+	link = gdata_link_new ("http://example.com/", GDATA_LINK_SELF);
+	g_object_get (link, "constructed-from-xml", &constructed_from_xml, NULL);
+	g_assert (constructed_from_xml == FALSE);
+	g_object_unref (link);
+}
 
-	_link = gdata_feed_look_up_link (feed, "http://schemas.google.com/g/2005#feed");
-	g_assert (GDATA_IS_LINK (_link));
+static void
+test_entry_constructed_from_xml_perf (void)
+{
+	GString *xml;
+	GDataEntry *entry;
+	GTimer *timer;
+	guint i;
+	GError *error = NULL;
+
+	/* Parsing is dominated by the construction of the entry's child objects when it has lots of them */
+	xml = g_string_new ("<entry xmlns='http://www.w3.org/2005/Atom'><title type='text'>Title</title>");
+	for (i = 0; i < 1000; i++) {
+		g_string_append_printf (xml, "<link rel='http://example.com/rel%u' href='http://example.com/%u'/>"
+		                             "<category term='term%u' scheme='http://example.com/scheme'/>", i, i, i);
+	}
+	g_string_append (xml, "</entry>");
+
+	timer = g_timer_new ();
+
+	for (i = 0; i < 100; i++) {
+		entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY, xml->str, (gint) xml->len, &error));
+		g_assert_no_error (error);
+		g_object_unref (entry);
+	}
+
+	g_test_minimized_result (g_timer_elapsed (timer, NULL) / (100.0 * 2000.0) * G_USEC_PER_SEC,
+	                         "%g µs per child object parsed", g_timer_elapsed (timer, NULL) / (100.0 * 2000.0) * G_USEC_PER_SEC);
+
+	g_timer_destroy (timer);
+	g_string_free (xml, TRUE);
+}
+
+static void
+test_entry_error_handling_xml (void)
+{
+	GDataEntry *entry;
+	GError *error = NULL;
+
+#define TEST_XML_ERROR_HANDLING(x) entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,\
+		"<entry>"\
+			x\
+		"</entry>", -1, &error));\
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);\
+	g_assert (entry == NULL);\
+	g_clear_error (&error)
+
+	/* updated */
+	TEST_XML_ERROR_HANDLING ("<updated>not a date</updated>"); /* invalid date */
+
+	/* published */
+	TEST_XML_ERROR_HANDLING ("<published>also not a date</published>"); /* invalid date */
+
+	/* category */
+	TEST_XML_ERROR_HANDLING ("<category/>"); /* invalid category */
+
+	/* link */
+	TEST_XML_ERROR_HANDLING ("<link/>"); /* invalid link */
+
+	/* author */
+	TEST_XML_ERROR_HANDLING ("<author/>"); /* invalid author */
+
+#undef TEST_XML_ERROR_HANDLING
+}
+
+static void
+test_entry_error_handling_json (void)
+{
+	GDataEntry *entry;
+	GError *error = NULL;
+
+#define TEST_JSON_ERROR_HANDLING(x) \
+	entry = GDATA_ENTRY (gdata_parsable_new_from_json (GDATA_TYPE_ENTRY,x, -1, &error));\
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);\
+	g_assert (entry == NULL);\
+	g_clear_error (&error)
+#define TEST_JSON_ERROR_HANDLING_PARSER(x) \
+	entry = GDATA_ENTRY (gdata_parsable_new_from_json (GDATA_TYPE_ENTRY,x, -1, &error));\
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);\
+	g_assert (entry == NULL);\
+	g_clear_error (&error)
+
+	/* General structure. */
+	TEST_JSON_ERROR_HANDLING_PARSER ("[true,false,true]"); /* root node is not an object */
+	TEST_JSON_ERROR_HANDLING_PARSER ("false"); /* root node is not an object */
+	TEST_JSON_ERROR_HANDLING_PARSER ("invalid json"); /* totally invalid JSON */
+
+	/* id */
+	TEST_JSON_ERROR_HANDLING ("{\"id\":\"\"}"); /* empty */
+	TEST_JSON_ERROR_HANDLING ("{\"id\":null}"); /* invalid type */
+
+	/* updated */
+	TEST_JSON_ERROR_HANDLING ("{\"updated\":\"not correct\"}"); /* incorrect format */
+	TEST_JSON_ERROR_HANDLING ("{\"updated\":false}"); /* invalid type */
+	TEST_JSON_ERROR_HANDLING ("{\"updated\":\"\"}"); /* empty */
+
+	/* title */
+	TEST_JSON_ERROR_HANDLING ("{\"title\":false}"); /* invalid type */
+
+	/* etag */
+	TEST_JSON_ERROR_HANDLING ("{\"etag\":\"\"}"); /* empty */
+	TEST_JSON_ERROR_HANDLING ("{\"etag\":false}"); /* invalid type */
+
+	/* selfLink */
+	TEST_JSON_ERROR_HANDLING ("{\"selfLink\":\"\"}"); /* empty */
+	TEST_JSON_ERROR_HANDLING ("{\"selfLink\":false}"); /* invalid type */
+
+	/* kind */
+	TEST_JSON_ERROR_HANDLING ("{\"kind\":\"\"}"); /* empty */
+	TEST_JSON_ERROR_HANDLING ("{\"kind\":false}"); /* invalid type */
+
+#undef TEST_JSON_ERROR_HANDLING_PARSER
+#undef TEST_JSON_ERROR_HANDLING
+}
+
+static void
+test_entry_escaping (void)
+{
+	GDataEntry *entry;
+	GError *error = NULL;
+
+	/* Since we can't construct a GDataEntry directly, we need to parse it from XML */
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<entry xmlns='http://www.w3.org/2005/Atom'>"
+			"<title type='text'>Escaped content &amp; stuff</title>"
+			"<id>http://foo.com/?foo&amp;bar</id>"
+			"<updated>2010-12-10T17:21:24Z</updated>"
+			"<published>2010-12-10T17:21:24Z</published>"
+			"<summary type='text'>Summary &amp; stuff</summary>"
+			"<rights>Free &amp; open source</rights>"
+			"<content type='text'>Content &amp; things.</content>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+
+	/* Check the outputted XML is escaped properly */
+	gdata_test_assert_xml (entry,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<title type='text'>Escaped content &amp; stuff</title>"
+			"<id>http://foo.com/?foo&amp;bar</id>"
+			"<updated>2010-12-10T17:21:24Z</updated>"
+			"<published>2010-12-10T17:21:24Z</published>"
+			"<summary type='text'>Summary &amp; stuff</summary>"
+			"<rights>Free &amp; open source</rights>"
+			"<content type='text'>Content &amp; things.</content>"
+		"</entry>");
+	g_object_unref (entry);
+
+	/* Repeat with content given by a URI */
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<entry xmlns='http://www.w3.org/2005/Atom'>"
+			"<title type='text'>Escaped content &amp; stuff</title>"
+			"<content type='text/plain' src='http://foo.com?foo&amp;bar'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+
+	/* Check the outputted XML is escaped properly */
+	gdata_test_assert_xml (entry,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<title type='text'>Escaped content &amp; stuff</title>"
+			"<content type='text/plain' src='http://foo.com?foo&amp;bar'/>"
+		"</entry>");
+	g_object_unref (entry);
+}
+
+static void
+test_entry_links_remove (void)
+{
+	GDataEntry *entry;
+	GDataLink *link_, *link2_;
+	GError *error = NULL;
+
+	/* Since we can't construct a GDataEntry directly, we need to parse it from XML. */
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<entry xmlns='http://www.w3.org/2005/Atom'>"
+			"<title type='text'>Escaped content &amp; stuff</title>"
+			"<id>http://foo.com/?foo&amp;bar</id>"
+			"<updated>2010-12-10T17:21:24Z</updated>"
+			"<published>2010-12-10T17:21:24Z</published>"
+			"<summary type='text'>Summary &amp; stuff</summary>"
+			"<rights>Free &amp; open source</rights>"
+			"<content type='text'>Content &amp; things.</content>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+
+	link_ = gdata_link_new ("http://example.com/", GDATA_LINK_RELATED);
+
+	/* Add a link. */
+	gdata_entry_add_link (entry, link_);
+	g_assert (gdata_entry_look_up_link (entry, GDATA_LINK_RELATED) == link_);
+
+	/* Remove the link. */
+	g_assert (gdata_entry_remove_link (entry, link_) == TRUE);
+	g_assert (gdata_entry_look_up_link (entry, GDATA_LINK_RELATED) == NULL);
+
+	/* Attempt to remove a non-existent link. */
+	link2_ = gdata_link_new ("http://foobar.com/", GDATA_LINK_SELF);
+	g_assert (gdata_entry_remove_link (entry, link2_) == FALSE);
+
+	g_object_unref (link2_);
+	g_object_unref (link_);
+	g_object_unref (entry);
+}
+
+static void
+test_entry_dirty (void)
+{
+	GDataEntry *entry;
+	GDataLink *link_;
+	GError *error = NULL;
+
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom'>"
+			"<title type='text'>Dirty tracking</title>"
+			"<id>http://example.com/id</id>"
+			"<updated>2010-12-10T17:21:24Z</updated>"
+			"<link rel='edit' href='http://example.com/edit'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+
+	/* Parsing the entry shouldn't dirty it */
+	g_assert (gdata_entry_is_dirty (entry) == FALSE);
+
+	/* Setting one of its properties should */
+	gdata_entry_set_title (entry, "Dirty tracking");
+	g_assert (gdata_entry_is_dirty (entry) == TRUE);
+	g_object_unref (entry);
+
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom'><title type='text'>Links</title></entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (gdata_entry_is_dirty (entry) == FALSE);
+
+	/* Modifying a list of child elements dirties the entry */
+	link_ = gdata_link_new ("http://example.com/", GDATA_LINK_RELATED);
+	gdata_entry_add_link (entry, link_);
+	g_assert (gdata_entry_is_dirty (entry) == TRUE);
+
+	g_object_unref (link_);
+	g_object_unref (entry);
+}
+
+/* A feed whose markup the scanner has to tokenise carefully: a comment and attribute values containing markup characters, a self-closing child,
+ * a CDATA section and a comment inside a child which contain end tags, entities, and a child which redefines one of the root's namespaces */
+static const gchar xml_scanner_document[] =
+	"<?xml version='1.0' encoding='UTF-8'?>\n"
+	"<!-- A comment before the root, with a <tag> in it -->\n"
+	"<feed xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='W/\"a>b\"'>\n"
+	"\t<id>http://example.com/feed?a=1&amp;b=2</id>\n"
+	"\t<link rel='self' href='http://example.com/feed?x=>'/>\n"
+	"\t<entry gd:etag='\"1/>\"'><title type='text'><![CDATA[A </title> in </entry> CDATA]]></title><!-- </entry> --></entry>\n"
+	"\t<entry xmlns='http://www.w3.org/2005/Atom' xmlns:app='http://www.w3.org/2007/app'><title>&lt;entry&gt;</title></entry>\n"
+	"</feed>\n";
+
+/* The root's children as the scanner should return them, with the root's namespace declarations added; self-closing children aren't returned */
+static const gchar *xml_scanner_children[] = {
+	"<id xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>http://example.com/feed?a=1&amp;b=2</id>",
+	NULL,
+	"<entry gd:etag='\"1/>\"' xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+		"<title type='text'><![CDATA[A </title> in </entry> CDATA]]></title><!-- </entry> --></entry>",
+	"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:app='http://www.w3.org/2007/app' xmlns:gd='http://schemas.google.com/g/2005'>"
+		"<title>&lt;entry&gt;</title></entry>",
+};
+
+static void
+check_xml_scanner_child (const gchar *xml, gsize length, gsize content_offset, guint index)
+{
+	const gchar *expected = xml_scanner_children[index];
+
+	g_assert (xml != NULL);
+	g_assert_cmpstr (xml, ==, expected);
+	g_assert_cmpuint (length, ==, strlen (expected));
+	g_assert_cmpuint (content_offset, ==, strchr (expected, '>') - expected + 1);
+}
+
+static void
+test_xml_scanner_in_place (void)
+{
+	GDataXmlScanner scanner;
+	gchar *xml;
+	const gchar *root_start, *root_end;
+	gsize length, content_offset;
+	guint i;
+
+	/* The root is returned verbatim */
+	gdata_xml_scanner_init (&scanner, xml_scanner_document, strlen (xml_scanner_document));
+
+	xml = gdata_xml_scanner_dup_root (&scanner, &length, &content_offset);
+	g_assert (xml != NULL);
+
+	root_start = strstr (xml_scanner_document, "<feed ");
+	root_end = strstr (xml_scanner_document, "</feed>") + strlen ("</feed>");
+	g_assert_cmpuint (length, ==, root_end - root_start);
+	g_assert (strncmp (xml, root_start, length) == 0);
+	g_assert_cmpuint (content_offset, ==, strstr (root_start, "b\"'>") + strlen ("b\"'>") - root_start);
+
+	g_free (xml);
+	gdata_xml_scanner_clear (&scanner);
+
+	/* As are its children, requested in order */
+	gdata_xml_scanner_init (&scanner, xml_scanner_document, strlen (xml_scanner_document));
+
+	for (i = 0; i < G_N_ELEMENTS (xml_scanner_children); i++) {
+		xml = gdata_xml_scanner_dup_child (&scanner, i, &length, &content_offset);
+
+		if (xml_scanner_children[i] == NULL)
+			g_assert (xml == NULL);
+		else
+			check_xml_scanner_child (xml, length, content_offset, i);
+
+		g_free (xml);
+	}
+
+	g_assert (gdata_xml_scanner_dup_child (&scanner, i, &length, &content_offset) == NULL);
+
+	gdata_xml_scanner_clear (&scanner);
+}
+
+static void
+test_xml_scanner_incremental (void)
+{
+	GDataXmlScanner scanner;
+	gchar *xml;
+	const gchar *end_tag;
+	gsize i, length, content_offset;
+	guint next_child = 0;
+
+	/* Append the document a byte at a time, requesting each child as soon as it's complete */
+	gdata_xml_scanner_init (&scanner, NULL, 0);
+
+	for (i = 0; xml_scanner_document[i] != '\0'; i++) {
+		gdata_xml_scanner_append (&scanner, xml_scanner_document + i, 1);
+
+		while (next_child < G_N_ELEMENTS (xml_scanner_children) && xml_scanner_children[next_child] == NULL)
+			next_child++;
+		if (next_child == G_N_ELEMENTS (xml_scanner_children))
+			continue;
+
+		xml = gdata_xml_scanner_dup_child (&scanner, next_child, &length, &content_offset);
+		if (xml == NULL)
+			continue;
+
+		/* The child's returned as soon as its end tag has been appended */
+		end_tag = (g_str_has_suffix (xml, "</id>") == TRUE) ? "</id>" : "</entry>";
+		g_assert (strncmp (xml_scanner_document + i + 1 - strlen (end_tag), end_tag, strlen (end_tag)) == 0);
+
+		check_xml_scanner_child (xml, length, content_offset, next_child++);
+
+		g_free (xml);
+	}
+
+	g_assert_cmpuint (next_child, ==, G_N_ELEMENTS (xml_scanner_children));
+
+	/* The text preceding the children has been discarded, so the root can't be returned any more */
+	g_assert (gdata_xml_scanner_dup_root (&scanner, &length, &content_offset) == NULL);
+
+	gdata_xml_scanner_clear (&scanner);
+}
+
+static void
+test_xml_scanner_unsupported (void)
+{
+	GDataXmlScanner scanner;
+	gsize length, content_offset;
+	guint i;
+
+	const gchar *documents[] = {
+		/* Entities declared in a DTD could expand to markup */
+		"<?xml version='1.0'?><!DOCTYPE feed [<!ENTITY e '<entry/>'>]><feed><id>x</id>&e;</feed>",
+		/* Only UTF-8 is supported */
+		"<?xml version='1.0' encoding='ISO-8859-1'?><feed><id>x</id></feed>",
+	};
+
+	for (i = 0; i < G_N_ELEMENTS (documents); i++) {
+		gdata_xml_scanner_init (&scanner, documents[i], strlen (documents[i]));
+		g_assert (gdata_xml_scanner_dup_root (&scanner, &length, &content_offset) == NULL);
+		gdata_xml_scanner_clear (&scanner);
+
+		gdata_xml_scanner_init (&scanner, documents[i], strlen (documents[i]));
+		g_assert (gdata_xml_scanner_dup_child (&scanner, 0, &length, &content_offset) == NULL);
+		gdata_xml_scanner_clear (&scanner);
+	}
+}
+
+/* Updates @entry against the given trace, and returns the body of the request which was sent. Entries are PUT back using the XML they were parsed
+ * from, if it's still valid. */
+static gchar *
+update_entry_and_get_request_body (GDataEntry *entry, const gchar *trace_name)
+{
+	GDataService *service;
+	GDataEntry *updated_entry;
+	RequestLog *log;
+	GBytes *body;
+	gchar *request_body;
+	GError *error = NULL;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	log = request_log_start ();
+
+	gdata_test_mock_server_start_trace (mock_server, trace_name);
+	updated_entry = gdata_service_update_entry (service, NULL, entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (updated_entry));
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 1);
+	g_assert_cmpstr (request_log_get (log, 0)->method, ==, "PUT");
+
+	body = request_log_get (log, 0)->body;
+	request_body = g_strndup (g_bytes_get_data (body, NULL), g_bytes_get_size (body));
+
+	request_log_stop (log);
+	g_object_unref (updated_entry);
+	g_object_unref (service);
+
+	return request_body;
+}
+
+/* An entry with formatting which re-serialising it wouldn't reproduce */
+static const gchar original_xml_entry[] =
+	"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;E1&quot;'>\n"
+	"  <!-- Kept as-is -->\n"
+	"  <id>urn:entry:1</id>\n"
+	"  <updated>2026-10-14T09:00:00.000Z</updated>\n"
+	"  <title type=\"text\"><![CDATA[Tom & Jerry]]></title>\n"
+	"  <content type='text'>&lt;b&gt;Not bold&lt;/b&gt; &#x263A;</content>\n"
+	"  <link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/entries/1'/>\n"
+	"  <category scheme='http://example.com/scheme' term='existing'/>\n"
+	"</entry>";
+
+static const gchar original_xml_contact[] =
+	"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' "
+	       "xmlns:gContact='http://schemas.google.com/contact/2008' gd:etag='&quot;C1&quot;'>\n"
+	"  <id>http://www.google.com/m8/feeds/contacts/libgdata.test@gmail.com/base/1</id>\n"
+	"  <updated>2026-10-14T09:00:00.000Z</updated>\n"
+	"  <category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>\n"
+	"  <title>Contact</title>\n"
+	"  <link rel='edit' type='application/atom+xml' href='https://www.google.com/m8/feeds/contacts/default/full/1'/>\n"
+	"  <gd:email rel='http://schemas.google.com/g/2005#work' address='old@example.com' primary='true'/>\n"
+	"  <gContact:groupMembershipInfo deleted='false' href='http://www.google.com/m8/feeds/groups/libgdata.test@gmail.com/base/1'/>\n"
+	"</entry>";
+
+static void
+test_parsable_original_xml_unmodified (void)
+{
+	GDataEntry *entry;
+	gchar *request_body, *expected_body;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY, original_xml_entry, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+
+	/* The entry hasn't been touched, so it's sent back byte-for-byte as it was parsed, comment, CDATA section, entities and all */
+	request_body = update_entry_and_get_request_body (entry, "original-xml-unmodified");
+	expected_body = g_strconcat ("<?xml version='1.0' encoding='UTF-8'?>", original_xml_entry, NULL);
+	g_assert_cmpstr (request_body, ==, expected_body);
+	g_free (expected_body);
+	g_free (request_body);
+
+	/* Public serialisation isn't affected */
+	request_body = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
+	g_assert (strstr (request_body, "<!-- Kept as-is -->") == NULL);
+	g_free (request_body);
+
+	g_object_unref (entry);
+}
+
+static void
+test_parsable_original_xml_category (void)
+{
+	GDataEntry *entry;
+	GDataCategory *category;
+	gchar *request_body;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY, original_xml_entry, -1, &error));
+	g_assert_no_error (error);
+
+	/* Adding a category doesn't notify any properties, but has to stop the original XML being used */
+	category = gdata_category_new ("added", "http://example.com/scheme", NULL);
+	gdata_entry_add_category (entry, category);
+	g_object_unref (category);
+
+	request_body = update_entry_and_get_request_body (entry, "original-xml-category");
+	g_assert (strstr (request_body, "<!-- Kept as-is -->") == NULL);
+	g_assert (strstr (request_body, "term='existing'") != NULL);
+	g_assert (strstr (request_body, "term='added'") != NULL);
+	g_free (request_body);
+
+	g_object_unref (entry);
+}
+
+static void
+test_parsable_original_xml_child (void)
+{
+	GDataContactsContact *contact;
+	GDataGDEmailAddress *email_address;
+	gchar *request_body;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	contact = GDATA_CONTACTS_CONTACT (gdata_parsable_new_from_xml (GDATA_TYPE_CONTACTS_CONTACT, original_xml_contact, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_CONTACTS_CONTACT (contact));
+	g_assert (gdata_entry_is_dirty (GDATA_ENTRY (contact)) == FALSE);
+
+	/* Modifying an object parsed as part of the contact (rather than the contact itself) has to stop the original XML being used too */
+	email_address = gdata_contacts_contact_get_primary_email_address (contact);
+	g_assert (GDATA_IS_GD_EMAIL_ADDRESS (email_address));
+	gdata_gd_email_address_set_address (email_address, "new@example.com");
+
+	request_body = update_entry_and_get_request_body (GDATA_ENTRY (contact), "original-xml-child");
+	g_assert (strstr (request_body, "new@example.com") != NULL);
+	g_assert (strstr (request_body, "old@example.com") == NULL);
+	g_free (request_body);
+
+	g_object_unref (contact);
+}
+
+static void
+test_parsable_original_xml_group (void)
+{
+	GDataContactsContact *contact;
+	gchar *request_body;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	contact = GDATA_CONTACTS_CONTACT (gdata_parsable_new_from_xml (GDATA_TYPE_CONTACTS_CONTACT, original_xml_contact, -1, &error));
+	g_assert_no_error (error);
+
+	/* Group memberships are kept in a hash table rather than a property, so adding one has to stop the original XML being used explicitly */
+	gdata_contacts_contact_add_group (contact, "http://www.google.com/m8/feeds/groups/libgdata.test@gmail.com/base/2");
+
+	request_body = update_entry_and_get_request_body (GDATA_ENTRY (contact), "original-xml-group");
+	g_assert (strstr (request_body, "http://www.google.com/m8/feeds/groups/libgdata.test@gmail.com/base/1") != NULL);
+	g_assert (strstr (request_body, "http://www.google.com/m8/feeds/groups/libgdata.test@gmail.com/base/2") != NULL);
+	g_assert (strstr (request_body, "old@example.com") != NULL);
+	g_free (request_body);
+
+	g_object_unref (contact);
+}
+
+static void
+test_feed_parse_xml (void)
+{
+	GDataFeed *feed;
+	GDataEntry *entry;
+	GDataLink *_link; /* stupid unistd.h */
+	GList *list;
+	gchar *title, *subtitle, *id, *etag, *logo, *icon, *rights;
+	gint64 updated, updated2;
+	GDataGenerator *generator;
+	guint items_per_page, start_index, total_results;
+	GError *error = NULL;
+
+	feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED,
+		"<feed xmlns='http://www.w3.org/2005/Atom' "
+		      "xmlns:openSearch='http://a9.com/-/spec/opensearch/1.1/' "
+		      "xmlns:gd='http://schemas.google.com/g/2005' "
+		      "gd:etag='W/\"D08FQn8-eil7ImA9WxZbFEw.\"'>"
+			"<id>http://example.com/id</id>"
+			"<updated>2009-02-25T14:07:37.880860Z</updated>"
+			"<title type='text'>Test feed</title>"
+			"<subtitle type='text'>Test subtitle</subtitle>"
+			"<logo>http://example.com/logo.png</logo>"
+			"<icon>http://example.com/icon.png</icon>"
+			"<link rel='alternate' type='text/html' href='http://alternate.example.com/'/>"
+			"<link rel='http://schemas.google.com/g/2005#feed' type='application/atom+xml' href='http://example.com/id'/>"
+			"<link rel='http://schemas.google.com/g/2005#post' type='application/atom+xml' href='http://example.com/post'/>"
+			"<link rel='self' type='application/atom+xml' href='http://example.com/id'/>"
+			"<category scheme='http://example.com/categories' term='feed'/>"
+			"<rights>public</rights>"
+			"<author>"
+				"<name>Joe Smith</name>"
+				"<email>j.smith@example.com</email>"
+			"</author>"
+			"<generator version='0.6' uri='http://example.com/'>Example Generator</generator>"
+			"<openSearch:totalResults>2</openSearch:totalResults>"
+			"<openSearch:startIndex>1</openSearch:startIndex>"
+			"<openSearch:itemsPerPage>50</openSearch:itemsPerPage>"
+			"<entry>"
+				"<id>entry1</id>"
+				"<title type='text'>Testing unhandled XML</title>"
+				"<updated>2009-01-25T14:07:37.880860Z</updated>"
+				"<published>2009-01-23T14:06:37.880860Z</published>"
+				"<content type='text'>Here we test unhandled XML elements.</content>"
+			"</entry>"
+			"<entry>"
+				"<id>entry2</id>"
+				"<title type='text'>Testing unhandled XML 2</title>"
+				"<updated>2009-02-25T14:07:37.880860Z</updated>"
+				"<published>2009-02-23T14:06:37.880860Z</published>"
+				"<content type='text'>Here we test unhandled XML elements again.</content>"
+			"</entry>"
+			"<foobar>Test unhandled elements!</foobar>"
+		"</feed>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_clear_error (&error);
+
+	/* Check the feed's properties */
+	g_object_get (G_OBJECT (feed),
+	              "title", &title,
+	              "subtitle", &subtitle,
+	              "id", &id,
+	              "etag", &etag,
+	              "updated", &updated,
+	              "logo", &logo,
+	              "icon", &icon,
+	              "generator", &generator,
+	              "rights", &rights,
+	              "items-per-page", &items_per_page,
+	              "start-index", &start_index,
+	              "total-results", &total_results,
+	              NULL);
+
+	g_assert_cmpstr (title, ==, "Test feed");
+	g_assert_cmpstr (subtitle, ==, "Test subtitle");
+	g_assert_cmpstr (id, ==, "http://example.com/id");
+	g_assert_cmpstr (etag, ==, "W/\"D08FQn8-eil7ImA9WxZbFEw.\"");
+
+	g_assert_cmpint (updated, ==, 1235570857);
+
+	g_assert_cmpstr (logo, ==, "http://example.com/logo.png");
+	g_assert_cmpstr (icon, ==, "http://example.com/icon.png");
+	g_assert_cmpstr (rights, ==, "public");
+
+	g_assert (GDATA_IS_GENERATOR (generator));
+	g_assert_cmpstr (gdata_generator_get_name (generator), ==, "Example Generator");
+	g_assert_cmpstr (gdata_generator_get_uri (generator), ==, "http://example.com/");
+	g_assert_cmpstr (gdata_generator_get_version (generator), ==, "0.6");
+
+	g_assert_cmpuint (items_per_page, ==, 50);
+	g_assert_cmpuint (start_index, ==, 1);
+	g_assert_cmpuint (total_results, ==, 2);
+
+	g_free (title);
+	g_free (subtitle);
+	g_free (id);
+	g_free (etag);
+	g_free (logo);
+	g_free (icon);
+	g_free (rights);
+	g_object_unref (generator);
+
+	/* Check the entries */
+	entry = gdata_feed_look_up_entry (feed, "entry1");
+	g_assert (GDATA_IS_ENTRY (entry));
+
+	entry = gdata_feed_look_up_entry (feed, "this doesn't exist");
+	g_assert (entry == NULL);
+
+	entry = gdata_feed_look_up_entry (feed, "entry2");
+	g_assert (GDATA_IS_ENTRY (entry));
+
+	/* Check the categories */
+	list = gdata_feed_get_categories (feed);
+	g_assert (list != NULL);
+	g_assert_cmpint (g_list_length (list), ==, 1);
+	g_assert (GDATA_IS_CATEGORY (list->data));
+
+	/* Check the links */
+	list = gdata_feed_get_links (feed);
+	g_assert (list != NULL);
+	g_assert_cmpint (g_list_length (list), ==, 4);
+	g_assert (GDATA_IS_LINK (list->data));
+	g_assert (GDATA_IS_LINK (list->next->data));
+	g_assert (GDATA_IS_LINK (list->next->next->data));
+	g_assert (GDATA_IS_LINK (list->next->next->next->data));
+
+	_link = gdata_feed_look_up_link (feed, GDATA_LINK_ALTERNATE);
+	g_assert (GDATA_IS_LINK (_link));
+
+	_link = gdata_feed_look_up_link (feed, "this doesn't exist");
+	g_assert (_link == NULL);
+
+	_link = gdata_feed_look_up_link (feed, "http://schemas.google.com/g/2005#feed");
+	g_assert (GDATA_IS_LINK (_link));
+
+	_link = gdata_feed_look_up_link (feed, "http://schemas.google.com/g/2005#post");
+	g_assert (GDATA_IS_LINK (_link));
+
+	_link = gdata_feed_look_up_link (feed, GDATA_LINK_SELF);
+	g_assert (GDATA_IS_LINK (_link));
+
+	/* Check the authors */
+	list = gdata_feed_get_authors (feed);
+	g_assert (list != NULL);
+	g_assert_cmpint (g_list_length (list), ==, 1);
+	g_assert (GDATA_IS_AUTHOR (list->data));
+
+	/* Check the other properties again, the more normal way this time */
+	g_assert_cmpstr (gdata_feed_get_title (feed), ==, "Test feed");
+	g_assert_cmpstr (gdata_feed_get_subtitle (feed), ==, "Test subtitle");
+	g_assert_cmpstr (gdata_feed_get_id (feed), ==, "http://example.com/id");
+	g_assert_cmpstr (gdata_feed_get_etag (feed), ==, "W/\"D08FQn8-eil7ImA9WxZbFEw.\"");
+
+	updated2 = gdata_feed_get_updated (feed);
+	g_assert_cmpint (updated2, ==, 1235570857);
+
+	g_assert_cmpstr (gdata_feed_get_logo (feed), ==, "http://example.com/logo.png");
+	g_assert_cmpstr (gdata_feed_get_icon (feed), ==, "http://example.com/icon.png");
+	g_assert_cmpstr (gdata_feed_get_rights (feed), ==, "public");
+
+	generator = gdata_feed_get_generator (feed);
+	g_assert (GDATA_IS_GENERATOR (generator));
+	g_assert_cmpstr (gdata_generator_get_name (generator), ==, "Example Generator");
+	g_assert_cmpstr (gdata_generator_get_uri (generator), ==, "http://example.com/");
+	g_assert_cmpstr (gdata_generator_get_version (generator), ==, "0.6");
+
+	g_assert_cmpuint (gdata_feed_get_items_per_page (feed), ==, 50);
+	g_assert_cmpuint (gdata_feed_get_start_index (feed), ==, 1);
+	g_assert_cmpuint (gdata_feed_get_total_results (feed), ==, 2);
+
+	g_object_unref (feed);
+}
+
+static void
+test_feed_shared_values (void)
+{
+	GDataFeed *feed;
+	GDataEntry *entry1, *entry2;
+	GDataCategory *category1, *category2;
+	GDataAuthor *author1, *author2;
+	GList *entries;
+	gchar *xml;
+	GError *error = NULL;
+
+	/* Both entries have identical categories and authors, which are shared while parsing */
+	feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED,
+		"<feed xmlns='http://www.w3.org/2005/Atom'>"
+			"<id>http://example.com/id</id>"
+			"<updated>2009-02-25T14:07:37.880860Z</updated>"
+			"<title type='text'>Test feed</title>"
+			"<entry>"
+				"<id>entry1</id>"
+				"<title type='text'>Entry 1</title>"
+				"<updated>2009-01-25T14:07:37.880860Z</updated>"
+				"<category scheme='http://example.com/categories' term='shared' label='Shared'/>"
+				"<author><name>Joe Smith</name><email>j.smith@example.com</email></author>"
+			"</entry>"
+			"<entry>"
+				"<id>entry2</id>"
+				"<title type='text'>Entry 2</title>"
+				"<updated>2009-01-26T14:07:37.880860Z</updated>"
+				"<category scheme='http://example.com/categories' term='shared' label='Shared'/>"
+				"<author><name>Joe Smith</name><email>j.smith@example.com</email></author>"
+			"</entry>"
+		"</feed>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+	entry1 = GDATA_ENTRY (entries->data);
+	entry2 = GDATA_ENTRY (entries->next->data);
+
+	/* Each entry should give out its own copies */
+	g_assert_cmpuint (g_list_length (gdata_entry_get_categories (entry1)), ==, 1);
+	category1 = GDATA_CATEGORY (gdata_entry_get_categories (entry1)->data);
+	category2 = GDATA_CATEGORY (gdata_entry_get_categories (entry2)->data);
+	g_assert (category1 != category2);
+	g_assert_cmpint (gdata_comparable_compare (GDATA_COMPARABLE (category1), GDATA_COMPARABLE (category2)), ==, 0);
+	g_assert_cmpstr (gdata_category_get_label (category1), ==, "Shared");
+
+	g_assert_cmpuint (g_list_length (gdata_entry_get_authors (entry1)), ==, 1);
+	author1 = GDATA_AUTHOR (gdata_entry_get_authors (entry1)->data);
+	author2 = GDATA_AUTHOR (gdata_entry_get_authors (entry2)->data);
+	g_assert (author1 != author2);
+	g_assert_cmpstr (gdata_author_get_name (author2), ==, "Joe Smith");
+
+	/* The copies should be stable across calls */
+	g_assert (gdata_entry_get_categories (entry1)->data == category1);
+	g_assert (gdata_entry_get_authors (entry1)->data == author1);
+
+	/* Modifying one entry's copies mustn't affect the other entry */
+	gdata_category_set_label (category1, "Changed");
+	gdata_author_set_name (author1, "John Smith");
+
+	g_assert_cmpstr (gdata_category_get_label (category2), ==, "Shared");
+	g_assert_cmpstr (gdata_author_get_name (author2), ==, "Joe Smith");
+
+	/* …and the changes should be reflected in the modified entry's XML, but not the other's */
+	xml = gdata_parsable_get_xml (GDATA_PARSABLE (entry1));
+	g_assert (strstr (xml, "label='Changed'") != NULL);
+	g_assert (strstr (xml, "John Smith") != NULL);
+	g_free (xml);
+
+	xml = gdata_parsable_get_xml (GDATA_PARSABLE (entry2));
+	g_assert (strstr (xml, "label='Shared'") != NULL);
+	g_assert (strstr (xml, "Joe Smith") != NULL);
+	g_free (xml);
+
+	g_object_unref (feed);
+}
+
+static void
+test_feed_parse_json (void)
+{
+	GDataFeed *feed;
+	GDataEntry *entry;
+	GList *entries;
+	GError *error = NULL;
+
+	feed = GDATA_FEED (gdata_parsable_new_from_json (GDATA_TYPE_FEED,
+		"{"
+			"\"kind\":\"kind#feed\","
+			"\"etag\":\"feed-etag\","
+			"\"items\":["
+				"{"
+					"\"title\":\"First\","
+					"\"id\":\"first-id\","
+					"\"unhandled-object\":{\"a\":[1,2,\"]}\"]}"
+				"},"
+				"{"
+					"\"title\":\"Second\","
+					"\"id\":\"second-id\""
+				"}"
+			"]"
+		"}", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_clear_error (&error);
+
+	/* Entries should be in document order */
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+
+	entry = GDATA_ENTRY (entries->data);
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "First");
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, "first-id");
+
+	/* Unhandled members of the entries should be preserved */
+	gdata_test_assert_json (entry,
+		"{"
+			"\"title\":\"First\","
+			"\"id\":\"first-id\","
+			"\"unhandled-object\":{\"a\":[1,2,\"]}\"]}"
+		"}");
+
+	entry = GDATA_ENTRY (entries->next->data);
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "Second");
+
+	g_object_unref (feed);
+}
+
+static void
+test_feed_lite (void)
+{
+	GDataLiteFeed *feed;
+	const GDataLiteEntry *entry;
+	GError *error = NULL;
+
+	feed = gdata_lite_feed_new_from_xml (
+		"<feed xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='W/\"feed-etag\"'>"
+			"<id>http://example.com/feed</id>"
+			"<updated>2009-02-25T14:07:37.880860Z</updated>"
+			"<title type='text'>Test Feed</title>"
+			"<entry gd:etag='W/\"entry-etag\"'>"
+				"<title type='text'>First &amp; Foremost</title>"
+				"<id>first-id</id>"
+				"<updated>2009-02-25T14:07:37.880860Z</updated>"
+				"<published>2009-02-24T14:07:37.880860Z</published>"
+				"<summary>Summary</summary>"
+				"<content type='text'>Some <![CDATA[content]]></content>"
+				"<link rel='self' href='http://example.com/first'/>"
+				"<link rel='http://schemas.google.com/g/2005#feed' href='http://example.com/first/feed'/>"
+				"<gd:who email='fooish@example.com'/>"
+			"</entry>"
+			"<entry>"
+				"<title type='text'>Second</title>"
+				"<id>second-id</id>"
+			"</entry>"
+		"</feed>", -1, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_LITE_FEED (feed));
+	g_clear_error (&error);
+
+	g_assert_cmpstr (gdata_lite_feed_get_id (feed), ==, "http://example.com/feed");
+	g_assert_cmpstr (gdata_lite_feed_get_etag (feed), ==, "W/\"feed-etag\"");
+	g_assert_cmpstr (gdata_lite_feed_get_title (feed), ==, "Test Feed");
+	g_assert_cmpint (gdata_lite_feed_get_updated (feed), ==, 1235570857);
+	g_assert_cmpuint (gdata_lite_feed_get_n_entries (feed), ==, 2);
+
+	/* Entries should be in document order */
+	entry = gdata_lite_feed_get_entry (feed, 0);
+	g_assert_cmpstr (gdata_lite_entry_get_id (entry), ==, "first-id");
+	g_assert_cmpstr (gdata_lite_entry_get_etag (entry), ==, "W/\"entry-etag\"");
+	g_assert_cmpstr (gdata_lite_entry_get_title (entry), ==, "First & Foremost");
+	g_assert_cmpstr (gdata_lite_entry_get_summary (entry), ==, "Summary");
+	g_assert_cmpstr (gdata_lite_entry_get_content (entry), ==, "Some content");
+	g_assert_cmpint (gdata_lite_entry_get_updated (entry), ==, 1235570857);
+	g_assert_cmpint (gdata_lite_entry_get_published (entry), ==, 1235484457);
+	g_assert_cmpstr (gdata_lite_entry_look_up_link_uri (entry, GDATA_LINK_SELF), ==, "http://example.com/first");
+	g_assert_cmpstr (gdata_lite_entry_look_up_link_uri (entry, "http://schemas.google.com/g/2005#feed"), ==, "http://example.com/first/feed");
+	g_assert (gdata_lite_entry_look_up_link_uri (entry, GDATA_LINK_EDIT) == NULL);
+
+	entry = gdata_lite_feed_get_entry (feed, 1);
+	g_assert_cmpstr (gdata_lite_entry_get_id (entry), ==, "second-id");
+	g_assert_cmpstr (gdata_lite_entry_get_title (entry), ==, "Second");
+	g_assert (gdata_lite_entry_get_etag (entry) == NULL);
+	g_assert (gdata_lite_entry_get_summary (entry) == NULL);
+	g_assert_cmpint (gdata_lite_entry_get_updated (entry), ==, -1);
+
+	g_object_unref (feed);
+
+	/* Errors */
+	feed = gdata_lite_feed_new_from_xml ("<entry xmlns='http://www.w3.org/2005/Atom'/>", -1, &error);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (feed == NULL);
+	g_clear_error (&error);
+
+	feed = gdata_lite_feed_new_from_xml ("<feed xmlns='http://www.w3.org/2005/Atom'><entry><updated>not a date</updated></entry></feed>", -1,
+	                                     &error);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (feed == NULL);
+	g_clear_error (&error);
+}
+
+static void
+test_feed_snapshot (void)
+{
+	GDataFeed *feed;
+	GDataFeedSnapshot *snapshot, *snapshot2;
+	GDataEntry *entry;
+	gconstpointer data;
+	gpointer data_copy;
+	gsize length;
+	gchar *xml;
+	GError *error = NULL;
+
+	feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED,
+		"<feed xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='W/\"feed-etag\"'>"
+			"<id>http://example.com/feed</id>"
+			"<updated>2009-02-25T14:07:37.880860Z</updated>"
+			"<title type='text'>Test Feed</title>"
+			"<entry gd:etag='W/\"entry-etag\"'>"
+				"<title type='text'>First &amp; Foremost</title>"
+				"<id>first-id</id>"
+				"<updated>2009-02-25T14:07:37.880860Z</updated>"
+				"<gd:who email='fooish@example.com'/>"
+			"</entry>"
+			"<entry>"
+				"<title type='text'>Second</title>"
+				"<id>second-id</id>"
+				"<updated>2009-02-24T14:07:37.880860Z</updated>"
+			"</entry>"
+		"</feed>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_clear_error (&error);
+
+	snapshot = gdata_feed_snapshot_new (feed);
+	g_assert (GDATA_IS_FEED_SNAPSHOT (snapshot));
+	g_object_unref (feed);
+
+	/* Open a copy of the data, as another process would */
+	data = gdata_feed_snapshot_get_data (snapshot, &length);
+	g_assert (data != NULL);
+	g_assert_cmpuint (length, >, 0);
+
+	data_copy = g_memdup (data, length);
+	g_object_unref (snapshot);
+
+	snapshot = gdata_feed_snapshot_new_from_data (GDATA_TYPE_ENTRY, data_copy, length, g_free, data_copy, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED_SNAPSHOT (snapshot));
+	g_clear_error (&error);
+
+	g_assert (gdata_feed_snapshot_get_entry_type (snapshot) == GDATA_TYPE_ENTRY);
+	g_assert_cmpstr (gdata_feed_snapshot_get_id (snapshot), ==, "http://example.com/feed");
+	g_assert_cmpstr (gdata_feed_snapshot_get_etag (snapshot), ==, "W/\"feed-etag\"");
+	g_assert_cmpstr (gdata_feed_snapshot_get_title (snapshot), ==, "Test Feed");
+	g_assert_cmpint (gdata_feed_snapshot_get_updated (snapshot), ==, 1235570857);
+	g_assert_cmpuint (gdata_feed_snapshot_get_n_entries (snapshot), ==, 2);
+
+	/* Entries should be in document order */
+	g_assert_cmpstr (gdata_feed_snapshot_get_entry_id (snapshot, 0), ==, "first-id");
+	g_assert_cmpstr (gdata_feed_snapshot_get_entry_etag (snapshot, 0), ==, "W/\"entry-etag\"");
+	g_assert_cmpstr (gdata_feed_snapshot_get_entry_title (snapshot, 0), ==, "First & Foremost");
+	g_assert_cmpint (gdata_feed_snapshot_get_entry_updated (snapshot, 0), ==, 1235570857);
+
+	g_assert_cmpstr (gdata_feed_snapshot_get_entry_id (snapshot, 1), ==, "second-id");
+	g_assert (gdata_feed_snapshot_get_entry_etag (snapshot, 1) == NULL);
+	g_assert_cmpstr (gdata_feed_snapshot_get_entry_title (snapshot, 1), ==, "Second");
+	g_assert_cmpint (gdata_feed_snapshot_get_entry_updated (snapshot, 1), ==, 1235484457);
+
+	/* Full entries should be built on demand, including their unhandled XML */
+	entry = gdata_feed_snapshot_dup_entry (snapshot, 0, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_clear_error (&error);
+
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, "first-id");
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "First & Foremost");
+	xml = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
+	g_assert (strstr (xml, "fooish@example.com") != NULL);
+	g_free (xml);
+
+	g_object_unref (entry);
+
+	/* Opening the data with the wrong entry type should fail */
+	data = gdata_feed_snapshot_get_data (snapshot, &length);
+	snapshot2 = gdata_feed_snapshot_new_from_data (GDATA_TYPE_ACCESS_RULE, data, length, NULL, NULL, &error);
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_assert (snapshot2 == NULL);
+	g_clear_error (&error);
+
+	g_object_unref (snapshot);
+
+	/* As should opening data which isn't a snapshot */
+	data_copy = g_strdup ("not a snapshot");
+	snapshot = gdata_feed_snapshot_new_from_data (GDATA_TYPE_ENTRY, data_copy, strlen (data_copy), g_free, data_copy, &error);
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_assert (snapshot == NULL);
+	g_clear_error (&error);
+}
+
+static void
+test_entry_store (void)
+{
+	GDataEntryStore *store;
+	GDataEntry *entry;
+	GDataPicasaWebFile *file;
+	GList *list;
+	gchar *filename;
+	gint fd;
+	GError *error = NULL;
+
+	/* An in-memory store */
+	store = gdata_entry_store_new (NULL, &error);
+	g_assert_no_error (error);
+	g_assert (gdata_entry_store_get_filename (store) == NULL);
+	g_assert_cmpuint (gdata_entry_store_get_n_entries (store), ==, 0);
+
+	entry = gdata_entry_new ("http://example.com/entry1");
+	gdata_entry_set_title (entry, "Stored");
+	gdata_entry_store_add_entry (store, entry);
+	g_object_unref (entry);
+
+	g_assert_cmpuint (gdata_entry_store_get_n_entries (store), ==, 1);
+	g_assert (gdata_entry_store_get_entry (store, "http://example.com/missing", GDATA_TYPE_ENTRY) == NULL);
+	g_assert (gdata_entry_store_get_entry (store, "http://example.com/entry1", GDATA_TYPE_CALENDAR_EVENT) == NULL);
+
+	entry = gdata_entry_store_get_entry (store, "http://example.com/entry1", GDATA_TYPE_ENTRY);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "Stored");
+	g_object_unref (entry);
+
+	g_assert (gdata_entry_store_save (store, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert (gdata_entry_store_remove_entry (store, "http://example.com/entry1") == TRUE);
+	g_assert (gdata_entry_store_remove_entry (store, "http://example.com/entry1") == FALSE);
+	g_assert_cmpuint (gdata_entry_store_get_n_entries (store), ==, 0);
+
+	g_object_unref (store);
+
+	/* Searching */
+	store = gdata_entry_store_new (NULL, &error);
+	g_assert_no_error (error);
+
+	entry = gdata_entry_new ("http://example.com/report");
+	gdata_entry_set_title (entry, "Quarterly Report");
+	gdata_entry_set_summary (entry, "Figures for the last quarter");
+	gdata_entry_store_add_entry (store, entry);
+	g_object_unref (entry);
+
+	entry = gdata_entry_new ("http://example.com/photos");
+	gdata_entry_set_title (entry, "Holiday PHOTOS");
+	gdata_entry_store_add_entry (store, entry);
+	g_object_unref (entry);
+
+	list = gdata_entry_store_search (store, "rep", GDATA_TYPE_ENTRY, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_assert_cmpstr (gdata_entry_get_id (list->data), ==, "http://example.com/report");
+	g_list_free_full (list, g_object_unref);
+
+	list = gdata_entry_store_search (store, "QUART, fig", GDATA_TYPE_ENTRY, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_list_free_full (list, g_object_unref);
+
+	list = gdata_entry_store_search (store, "photo", GDATA_TYPE_ENTRY, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_assert_cmpstr (gdata_entry_get_id (list->data), ==, "http://example.com/photos");
+	g_list_free_full (list, g_object_unref);
+
+	g_assert (gdata_entry_store_search (store, "photo quarter", GDATA_TYPE_ENTRY, 0) == NULL);
+	g_assert (gdata_entry_store_search (store, "", GDATA_TYPE_ENTRY, 0) == NULL);
+	g_assert (gdata_entry_store_search (store, "rep", GDATA_TYPE_CONTACTS_CONTACT, 0) == NULL);
+
+	/* Removed entries are no longer found */
+	g_assert (gdata_entry_store_remove_entry (store, "http://example.com/report") == TRUE);
+	g_assert (gdata_entry_store_search (store, "rep", GDATA_TYPE_ENTRY, 0) == NULL);
+
+	g_object_unref (store);
+
+	/* Searching by location */
+	store = gdata_entry_store_new (NULL, &error);
+	g_assert_no_error (error);
+
+	file = gdata_picasaweb_file_new ("http://example.com/london");
+	gdata_picasaweb_file_set_coordinates (file, 51.5007, -0.1246);
+	gdata_entry_store_add_entry (store, GDATA_ENTRY (file));
+	g_object_unref (file);
+
+	file = gdata_picasaweb_file_new ("http://example.com/greenwich");
+	gdata_picasaweb_file_set_coordinates (file, 51.4779, -0.0015);
+	gdata_entry_store_add_entry (store, GDATA_ENTRY (file));
+	g_object_unref (file);
+
+	file = gdata_picasaweb_file_new ("http://example.com/fiji");
+	gdata_picasaweb_file_set_coordinates (file, -17.7134, 179.9);
+	gdata_entry_store_add_entry (store, GDATA_ENTRY (file));
+	g_object_unref (file);
+
+	file = gdata_picasaweb_file_new ("http://example.com/nowhere");
+	gdata_entry_store_add_entry (store, GDATA_ENTRY (file));
+	g_object_unref (file);
+
+	list = gdata_entry_store_find_entries_in_area (store, 51.0, -1.0, 52.0, 1.0, GDATA_TYPE_PICASAWEB_FILE, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 2);
+	g_list_free_full (list, g_object_unref);
+
+	list = gdata_entry_store_find_entries_in_area (store, 51.0, -1.0, 52.0, -0.1, GDATA_TYPE_PICASAWEB_FILE, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_assert_cmpstr (gdata_entry_get_id (list->data), ==, "http://example.com/london");
+	g_list_free_full (list, g_object_unref);
+
+	list = gdata_entry_store_find_entries_in_area (store, 51.0, -1.0, 52.0, 1.0, GDATA_TYPE_PICASAWEB_FILE, 1);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_list_free_full (list, g_object_unref);
+
+	g_assert (gdata_entry_store_find_entries_in_area (store, 51.0, -1.0, 52.0, 1.0, GDATA_TYPE_YOUTUBE_VIDEO, 0) == NULL);
+
+	/* An area crossing the antimeridian */
+	list = gdata_entry_store_find_entries_in_area (store, -20.0, 179.0, -15.0, -179.0, GDATA_TYPE_PICASAWEB_FILE, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_assert_cmpstr (gdata_entry_get_id (list->data), ==, "http://example.com/fiji");
+	g_list_free_full (list, g_object_unref);
+
+	/* The whole world */
+	list = gdata_entry_store_find_entries_in_area (store, -90.0, -180.0, 90.0, 180.0, GDATA_TYPE_PICASAWEB_FILE, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 3);
+	g_list_free_full (list, g_object_unref);
+
+	/* Greenwich is about 8.6km from London; results are nearest first */
+	list = gdata_entry_store_find_entries_near (store, 51.5007, -0.1246, 10000.0, GDATA_TYPE_PICASAWEB_FILE, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 2);
+	g_assert_cmpstr (gdata_entry_get_id (list->data), ==, "http://example.com/london");
+	g_assert_cmpstr (gdata_entry_get_id (list->next->data), ==, "http://example.com/greenwich");
+	g_list_free_full (list, g_object_unref);
+
+	list = gdata_entry_store_find_entries_near (store, 51.5007, -0.1246, 5000.0, GDATA_TYPE_PICASAWEB_FILE, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_list_free_full (list, g_object_unref);
+
+	list = gdata_entry_store_find_entries_near (store, -17.7134, -179.95, 20000.0, GDATA_TYPE_PICASAWEB_FILE, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_assert_cmpstr (gdata_entry_get_id (list->data), ==, "http://example.com/fiji");
+	g_list_free_full (list, g_object_unref);
+
+	/* Removed entries are no longer found */
+	g_assert (gdata_entry_store_remove_entry (store, "http://example.com/greenwich") == TRUE);
+	list = gdata_entry_store_find_entries_near (store, 51.5007, -0.1246, 10000.0, GDATA_TYPE_PICASAWEB_FILE, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_list_free_full (list, g_object_unref);
+
+	g_object_unref (store);
+
+	/* Saving and loading a store */
+	fd = g_file_open_tmp ("libgdata-entry-store-XXXXXX", &filename, &error);
+	g_assert_no_error (error);
+	close (fd);
+	g_unlink (filename);
+
+	store = gdata_entry_store_new (filename, &error);
+	g_assert_no_error (error);
+	g_assert_cmpstr (gdata_entry_store_get_filename (store), ==, filename);
+
+	entry = gdata_entry_new ("http://example.com/entry2");
+	gdata_entry_set_title (entry, "Saved");
+	gdata_entry_store_add_entry (store, entry);
+	g_object_unref (entry);
+
+	file = gdata_picasaweb_file_new ("http://example.com/saved-location");
+	gdata_picasaweb_file_set_coordinates (file, 51.5007, -0.1246);
+	gdata_entry_store_add_entry (store, GDATA_ENTRY (file));
+	g_object_unref (file);
+
+	g_assert (gdata_entry_store_save (store, &error) == TRUE);
+	g_assert_no_error (error);
+	g_object_unref (store);
+
+	store = gdata_entry_store_new (filename, &error);
+	g_assert_no_error (error);
+	g_assert_cmpuint (gdata_entry_store_get_n_entries (store), ==, 2);
+
+	list = gdata_entry_store_find_entries_near (store, 51.5, -0.12, 1000.0, GDATA_TYPE_PICASAWEB_FILE, 0);
+	g_assert_cmpuint (g_list_length (list), ==, 1);
+	g_list_free_full (list, g_object_unref);
+
+	entry = gdata_entry_store_get_entry (store, "http://example.com/entry2", GDATA_TYPE_ENTRY);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "Saved");
+	g_object_unref (entry);
+
+	g_object_unref (store);
+
+	/* A file which isn't a store */
+	g_assert (g_file_set_contents (filename, "not a store", -1, NULL) == TRUE);
+	store = gdata_entry_store_new (filename, &error);
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_assert (store == NULL);
+	g_clear_error (&error);
+
+	g_unlink (filename);
+	g_free (filename);
+}
+
+static void
+test_feed_iterator (void)
+{
+	GDataService *service;
+	GDataFeedIterator *iterator;
+	guint prefetch_threshold;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	iterator = gdata_feed_iterator_new (service, NULL, "http://example.com/feed", NULL, GDATA_TYPE_ENTRY);
+	g_assert (GDATA_IS_FEED_ITERATOR (iterator));
+
+	/* Pages should be prefetched by default */
+	g_assert_cmpuint (gdata_feed_iterator_get_prefetch_threshold (iterator), ==, 10);
+
+	gdata_feed_iterator_set_prefetch_threshold (iterator, 0);
+	g_assert_cmpuint (gdata_feed_iterator_get_prefetch_threshold (iterator), ==, 0);
+
+	g_object_set (iterator, "prefetch-threshold", 50, NULL);
+	g_object_get (iterator, "prefetch-threshold", &prefetch_threshold, NULL);
+	g_assert_cmpuint (prefetch_threshold, ==, 50);
+
+	g_object_unref (iterator);
+	g_object_unref (service);
+}
+
+static void
+test_feed_look_up (void)
+{
+	GDataFeed *feed;
+	GDataEntry *first, *second;
+	GDataLink *_link;
+	GList *entries;
+	GError *error = NULL;
+
+	feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED,
+		"<feed xmlns='http://www.w3.org/2005/Atom'>"
+			"<id>http://example.com/id</id>"
+			"<updated>2009-02-25T14:07:37.880860Z</updated>"
+			"<title type='text'>Test feed</title>"
+			"<link rel='self' type='application/atom+xml' href='http://example.com/self'/>"
+			"<link rel='alternate' type='text/html' href='http://example.com/alternate-1'/>"
+			"<link rel='alternate' type='text/html' href='http://example.com/alternate-2'/>"
+			"<entry><id>entry1</id><title type='text'>First</title><updated>2009-01-25T14:07:37.880860Z</updated></entry>"
+			"<entry><id>entry2</id><title type='text'>Second</title><updated>2009-01-25T14:07:37.880860Z</updated></entry>"
+			"<entry><id>entry1</id><title type='text'>Duplicate</title><updated>2009-01-25T14:07:37.880860Z</updated></entry>"
+		"</feed>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	/* The list of entries is owned by the feed, so repeated calls return the same list */
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, 3);
+	g_assert (gdata_feed_get_entries (feed) == entries);
+
+	first = GDATA_ENTRY (entries->data);
+	second = GDATA_ENTRY (entries->next->data);
+
+	/* Look up entries by ID; the first of several entries with the same ID wins */
+	g_assert (gdata_feed_look_up_entry (feed, "entry1") == first);
+	g_assert (gdata_feed_look_up_entry (feed, "entry2") == second);
+	g_assert (gdata_feed_look_up_entry (feed, "entry3") == NULL);
+	g_assert (gdata_feed_look_up_entry (feed, "entry2") == second);
+
+	/* Look up links by relation type, including one which has never been seen, and one of which there are several */
+	_link = gdata_feed_look_up_link (feed, GDATA_LINK_SELF);
+	g_assert (GDATA_IS_LINK (_link));
+	g_assert_cmpstr (gdata_link_get_uri (_link), ==, "http://example.com/self");
+
+	_link = gdata_feed_look_up_link (feed, GDATA_LINK_ALTERNATE);
+	g_assert (GDATA_IS_LINK (_link));
+	g_assert_cmpstr (gdata_link_get_relation_type (_link), ==, GDATA_LINK_ALTERNATE);
+
+	g_assert (gdata_feed_look_up_link (feed, "http://example.com/never-used-relation-type") == NULL);
+	g_assert (gdata_feed_look_up_link (feed, GDATA_LINK_EDIT) == NULL);
+
+	/* The entries list is still the same after the look-ups */
+	g_assert (gdata_feed_get_entries (feed) == entries);
+
+	g_object_unref (feed);
+}
+
+static void
+test_feed_look_up_id_changed (void)
+{
+	GDataService *service;
+	GDataFeed *feed;
+	GDataEntry *entry, *updated_entry;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED,
+		"<feed xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005'>"
+			"<id>http://example.com/id</id>"
+			"<updated>2009-02-25T14:07:37.880860Z</updated>"
+			"<title type='text'>Test feed</title>"
+			"<entry gd:etag='&quot;A&quot;'>"
+				"<id>urn:entry:1</id>"
+				"<title type='text'>First</title>"
+				"<updated>2009-01-25T14:07:37.880860Z</updated>"
+				"<link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/entries/1'/>"
+			"</entry>"
+			"<entry><id>urn:entry:2</id><title type='text'>Second</title><updated>2009-01-25T14:07:37.880860Z</updated></entry>"
+		"</feed>", -1, &error));
+	g_assert_no_error (error);
+
+	/* Build the feed's index of entries */
+	entry = gdata_feed_look_up_entry (feed, "urn:entry:1");
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_assert (gdata_feed_look_up_entry (feed, "urn:entry:renamed") == NULL);
+
+	/* Update the entry in place; the server gives it a new ID */
+	service = g_object_new (GDATA_TYPE_SERVICE, "update-entries-in-place", TRUE, NULL);
+
+	gdata_test_mock_server_start_trace (mock_server, "feed-look-up-id-changed");
+
+	updated_entry = gdata_service_update_entry (service, NULL, entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (updated_entry == entry);
+	g_object_unref (updated_entry);
+
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, "urn:entry:renamed");
+
+	/* The feed's index mustn't return the entry by its old ID, and must find it by its new one */
+	g_assert (gdata_feed_look_up_entry (feed, "urn:entry:1") == NULL);
+	g_assert (gdata_feed_look_up_entry (feed, "urn:entry:renamed") == entry);
+	g_assert (GDATA_IS_ENTRY (gdata_feed_look_up_entry (feed, "urn:entry:2")));
+
+	g_object_unref (service);
+	g_object_unref (feed);
+}
+
+static void
+test_feed_error_handling (void)
+{
+	GDataFeed *feed;
+	GError *error = NULL;
+
+#define TEST_XML_ERROR_HANDLING(x) feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED, \
+		"<feed xmlns='http://www.w3.org/2005/Atom' xmlns:openSearch='http://a9.com/-/spec/opensearch/1.1/'>"\
+			x\
+		"</feed>", -1, &error));\
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);\
+	g_assert (feed == NULL);\
+	g_clear_error (&error)
+
+	/* entry */
+	TEST_XML_ERROR_HANDLING ("<entry><updated>this isn't a date</updated></entry>"); /* invalid entry */
+
+	/* title */
+	TEST_XML_ERROR_HANDLING ("<title>First title</title><title>Second title</title>"); /* duplicate title */
+#if 0
+	/* FIXME: Removed due to the YouTube comments feed not being a valid Atom feed.
+	 * See: https://code.google.com/p/gdata-issues/issues/detail?id=2908
+	 * and: https://bugzilla.gnome.org/show_bug.cgi?id=679072 */
+	TEST_XML_ERROR_HANDLING ("<id>ID</id><updated>2009-01-25T14:07:37.880860Z</updated>"); /* missing title */
+#endif
+
+	/* subtitle */
+	TEST_XML_ERROR_HANDLING ("<subtitle>First subtitle</subtitle><subtitle>Second subtitle</subtitle>"); /* duplicate subtitle */
+
+	/* id */
+	TEST_XML_ERROR_HANDLING ("<id>First ID</id><id>Second ID</id>"); /* duplicate ID */
+	TEST_XML_ERROR_HANDLING ("<title>Title</title><updated>2009-01-25T14:07:37.880860Z</updated>"); /* missing ID */
+
+	/* updated */
+	TEST_XML_ERROR_HANDLING ("<updated>2009-01-25T14:07:37.880860Z</updated>"
+	                         "<updated>2009-01-25T14:07:37.880860Z</updated>"); /* duplicate updated */
+	TEST_XML_ERROR_HANDLING ("<updated>not a date</updated>"); /* invalid date */
+	TEST_XML_ERROR_HANDLING ("<title>Title</title><id>ID</id>"); /* missing updated */
+
+	/* category */
+	TEST_XML_ERROR_HANDLING ("<category/>"); /* invalid category */
+
+	/* logo */
+	TEST_XML_ERROR_HANDLING ("<logo>First logo</logo><logo>Second logo</logo>"); /* duplicate logo */
+
+	/* icon */
+	TEST_XML_ERROR_HANDLING ("<icon>First icon</icon><icon>Second icon</icon>"); /* duplicate icon */
+
+	/* link */
+	TEST_XML_ERROR_HANDLING ("<link/>"); /* invalid link */
+
+	/* author */
+	TEST_XML_ERROR_HANDLING ("<author/>"); /* invalid author */
+
+	/* generator */
+	TEST_XML_ERROR_HANDLING ("<generator>First generator</generator><generator>Second generator</generator>"); /* duplicate generator */
+	TEST_XML_ERROR_HANDLING ("<generator uri=''/>"); /* invalid generator */
+
+	/* openSearch:totalResults */
+	TEST_XML_ERROR_HANDLING ("<openSearch:totalResults>5</openSearch:totalResults>"
+	                         "<openSearch:totalResults>3</openSearch:totalResults>"); /* duplicate totalResults */
+	TEST_XML_ERROR_HANDLING ("<openSearch:totalResults></openSearch:totalResults>"); /* missing content */
+	TEST_XML_ERROR_HANDLING ("<openSearch:totalResults>this isn't a number!</openSearch:totalResults>"); /* invalid number */
+
+	/* openSearch:startIndex */
+	TEST_XML_ERROR_HANDLING ("<openSearch:startIndex>5</openSearch:startIndex>"
+	                         "<openSearch:startIndex>3</openSearch:startIndex>"); /* duplicate startIndex */
+	TEST_XML_ERROR_HANDLING ("<openSearch:startIndex></openSearch:startIndex>"); /* missing content */
+	TEST_XML_ERROR_HANDLING ("<openSearch:startIndex>this isn't a number!</openSearch:startIndex>"); /* invalid number */
+
+	/* openSearch:itemsPerPage */
+	TEST_XML_ERROR_HANDLING ("<openSearch:itemsPerPage>5</openSearch:itemsPerPage>"
+	                         "<openSearch:itemsPerPage>3</openSearch:itemsPerPage>"); /* duplicate itemsPerPage */
+	TEST_XML_ERROR_HANDLING ("<openSearch:itemsPerPage></openSearch:itemsPerPage>"); /* missing content */
+	TEST_XML_ERROR_HANDLING ("<openSearch:itemsPerPage>this isn't a number!</openSearch:itemsPerPage>"); /* invalid number */
+
+#undef TEST_XML_ERROR_HANDLING
+}
+
+static void
+test_feed_escaping (void)
+{
+	GDataFeed *feed;
+	GError *error = NULL;
+
+	/* Since we can't construct a GDataEntry directly, we need to parse it from XML */
+	feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<feed xmlns='http://www.w3.org/2005/Atom'>"
+			"<id>http://foo.com?foo&amp;bar</id>"
+			"<updated>2010-12-10T17:49:15Z</updated>"
+			"<title type='text'>Test feed &amp; stuff.</title>"
+		"</feed>", -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	/* Check the outputted XML is escaped properly */
+	gdata_test_assert_xml (feed,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<feed xmlns='http://www.w3.org/2005/Atom'>"
+			"<title type='text'>Test feed &amp; stuff.</title>"
+			"<id>http://foo.com?foo&amp;bar</id>"
+			"<updated>2010-12-10T17:49:15Z</updated>"
+		"</feed>");
+	g_object_unref (feed);
+}
+
+static void
+test_query_uri_cache (void)
+{
+	GDataQuery *query;
+	gchar *query_uri;
+
+	query = gdata_query_new ("foobar");
+
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=foobar");
+	g_free (query_uri);
+
+	/* Setting the ETag doesn't change the URI */
+	gdata_query_set_etag (query, "W/\"foobar\"");
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=foobar");
+	g_free (query_uri);
+
+	/* A different feed URI gives a different query URI */
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/other");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/other?q=foobar");
+	g_free (query_uri);
+
+	/* Changing a property or the page changes the URI */
+	gdata_query_set_max_results (query, 10);
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/other");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/other?q=foobar&max-results=10");
+	g_free (query_uri);
+
+	gdata_query_next_page (query);
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/other");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/other?q=foobar&start-index=11&max-results=10");
+	g_free (query_uri);
+
+	g_object_unref (query);
+}
+
+static void
+test_query_categories (void)
+{
+	GDataQuery *query;
+	gchar *query_uri;
+
+	query = gdata_query_new ("foobar");
+
+	/* AND */
+	gdata_query_set_categories (query, "Fritz/Laurie");
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/-/Fritz/Laurie?q=foobar");
+	g_free (query_uri);
+
+	/* OR */
+	gdata_query_set_categories (query, "Fritz|Laurie");
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/-/Fritz%7CLaurie?q=foobar");
+	g_free (query_uri);
+
+	/* Combination */
+	gdata_query_set_categories (query, "A|-{urn:google.com}B/-C");
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/gdata_test");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/gdata_test/-/A%7C-%7Burn%3Agoogle.com%7DB/-C?q=foobar");
+	g_free (query_uri);
+
+	/* Same combination without q param */
+	gdata_query_set_q (query, NULL);
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/-/A%7C-%7Burn%3Agoogle.com%7DB/-C");
+	g_free (query_uri);
+
+	g_object_unref (query);
+}
+
+static void
+test_query_dates (void)
+{
+	GDataQuery *query;
+	gchar *query_uri;
+
+	query = gdata_query_new ("baz");
+
+	/* updated-min */
+	gdata_query_set_updated_min (query, 1373280114); /* 2013-07-08T10:41:54Z */
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=baz&updated-min=2013-07-08T10:41:54Z");
+	g_free (query_uri);
+	gdata_query_set_updated_min (query, -1);
+
+	/* updated-max */
+	gdata_query_set_updated_max (query, 1373280114); /* 2013-07-08T10:41:54Z */
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=baz&updated-max=2013-07-08T10:41:54Z");
+	g_free (query_uri);
+	gdata_query_set_updated_max (query, -1);
+
+	/* published-min */
+	gdata_query_set_published_min (query, 1373280114); /* 2013-07-08T10:41:54Z */
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=baz&published-min=2013-07-08T10:41:54Z");
+	g_free (query_uri);
+	gdata_query_set_published_min (query, -1);
+
+	/* published-max */
+	gdata_query_set_published_max (query, 1373280114); /* 2013-07-08T10:41:54Z */
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=baz&published-max=2013-07-08T10:41:54Z");
+	g_free (query_uri);
+	gdata_query_set_published_max (query, -1);
+
+	g_object_unref (query);
+}
+
+static void
+test_query_strict (void)
+{
+	GDataQuery *query;
+	gchar *query_uri;
+
+	query = gdata_query_new ("bar");
+
+	gdata_query_set_is_strict (query, TRUE);
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=bar&strict=true");
+	g_free (query_uri);
+
+	gdata_query_set_is_strict (query, FALSE);
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=bar");
+	g_free (query_uri);
+
+	g_object_unref (query);
+}
+
+static void
+test_query_fields (void)
+{
+	GDataQuery *query;
+	gchar *query_uri, *fields;
+
+	query = gdata_query_new ("bar");
+	g_assert (gdata_query_get_fields (query) == NULL);
+
+	gdata_query_set_fields (query, "entry(title,gd:email)");
+	g_assert_cmpstr (gdata_query_get_fields (query), ==, "entry(title,gd:email)");
+
+	g_object_get (query, "fields", &fields, NULL);
+	g_assert_cmpstr (fields, ==, "entry(title,gd:email)");
+	g_free (fields);
+
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=bar&fields=entry%28title%2Cgd%3Aemail%29");
+	g_free (query_uri);
+
+	gdata_query_set_fields (query, NULL);
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=bar");
+	g_free (query_uri);
+
+	g_object_unref (query);
+}
+
+static void
+test_query_pagination (void)
+{
+	GDataQuery *query;
+	gchar *query_uri;
+
+	query = gdata_query_new ("test");
+	gdata_query_set_max_results (query, 15);
+	gdata_query_set_etag (query, "etag"); /* this should be cleared by pagination */
+
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&max-results=15");
+	g_free (query_uri);
+
+	/* Try the next and previous pages. */
+	gdata_query_next_page (query);
+	g_assert (gdata_query_get_etag (query) == NULL);
+
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=16&max-results=15");
+	g_free (query_uri);
+
+	gdata_query_set_etag (query, "etag");
+	g_assert (gdata_query_previous_page (query) == TRUE);
+	g_assert (gdata_query_get_etag (query) == NULL);
+
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&max-results=15");
+	g_free (query_uri);
+
+	/* Try another previous page. This should fail, and the ETag should be untouched. */
+	gdata_query_set_etag (query, "etag");
+	g_assert (gdata_query_previous_page (query) == FALSE);
+	g_assert_cmpstr (gdata_query_get_etag (query), ==, "etag");
+
+	g_object_unref (query);
+
+	/* Try the alternate constructor. */
+	query = gdata_query_new_with_limits ("test", 40, 10);
+
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=40&max-results=10");
+	g_free (query_uri);
+
+	/* Try the next and previous pages again. */
+	gdata_query_next_page (query);
+
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=50&max-results=10");
+	g_free (query_uri);
+
+	g_assert (gdata_query_previous_page (query) == TRUE);
+
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=40&max-results=10");
+	g_free (query_uri);
+
+	g_assert (gdata_query_previous_page (query) == TRUE);
+
+	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=30&max-results=10");
+	g_free (query_uri);
+
+	g_object_unref (query);
+}
+
+static void
+notify_cb (GObject *obj, GParamSpec *pspec, gpointer user_data)
+{
+	gboolean *notification_received = user_data;
+	g_assert (*notification_received == FALSE);
+	*notification_received = TRUE;
+}
+
+static void
+test_query_properties (void)
+{
+	GDataQuery *query;
+	gboolean notification_received = FALSE;
+	gulong handler_id;
+
+	query = gdata_query_new ("default");
+
+#define CHECK_PROPERTY(cmptype, name_hyphens, name_underscores, default_val, new_val, new_val2, val_type, free_val) \
+	{ \
+		val_type val; \
+ \
+		handler_id = g_signal_connect (query, "notify::" name_hyphens, (GCallback) notify_cb, &notification_received); \
+ \
+		g_assert_##cmptype (gdata_query_get_##name_underscores (query), ==, default_val); \
+		g_object_get (query, name_hyphens, &val, NULL); \
+		g_assert_##cmptype (val, ==, default_val); \
+		if (free_val == TRUE) { \
+			g_free ((gpointer) ((guintptr) val)); \
+		} \
+ \
+		notification_received = FALSE; \
+		gdata_query_set_##name_underscores (query, new_val); \
+		g_assert (notification_received == TRUE); \
+ \
+		g_assert_##cmptype (gdata_query_get_##name_underscores (query), ==, new_val); \
+ \
+		notification_received = FALSE; \
+		g_object_set (query, name_hyphens, new_val2, NULL); \
+		g_assert (notification_received == TRUE); \
+ \
+		g_assert_##cmptype (gdata_query_get_##name_underscores (query), ==, new_val2); \
+ \
+		g_signal_handler_disconnect (query, handler_id); \
+	}
+#define CHECK_PROPERTY_STR(name_hyphens, name_underscores, default_val) \
+	CHECK_PROPERTY (cmpstr, name_hyphens, name_underscores, default_val, "new", "new2", gchar*, TRUE)
+#define CHECK_PROPERTY_INT64(name_hyphens, name_underscores, default_val) \
+	CHECK_PROPERTY (cmpint, name_hyphens, name_underscores, default_val, 123, 5134132, gint64, FALSE)
+#define CHECK_PROPERTY_UINT(name_hyphens, name_underscores, default_val) \
+	CHECK_PROPERTY (cmpuint, name_hyphens, name_underscores, default_val, 535, 123, guint, FALSE)
+#define CHECK_PROPERTY_BOOLEAN(name_hyphens, name_underscores, default_val) \
+	CHECK_PROPERTY (cmpuint, name_hyphens, name_underscores, default_val, TRUE, FALSE, gboolean, FALSE)
+
+	CHECK_PROPERTY_STR ("q", q, "default");
+	CHECK_PROPERTY_STR ("categories", categories, NULL);
+	CHECK_PROPERTY_STR ("author", author, NULL);
+	CHECK_PROPERTY_INT64 ("updated-min", updated_min, -1);
+	CHECK_PROPERTY_INT64 ("updated-max", updated_max, -1);
+	CHECK_PROPERTY_INT64 ("published-min", published_min, -1);
+	CHECK_PROPERTY_INT64 ("published-max", published_max, -1);
+	CHECK_PROPERTY_UINT ("start-index", start_index, 0);
+#define gdata_query_get_is_strict gdata_query_is_strict
+	CHECK_PROPERTY_BOOLEAN ("is-strict", is_strict, FALSE);
+#undef gdata_query_get_is_strict
+	CHECK_PROPERTY_UINT ("max-results", max_results, 0);
+	CHECK_PROPERTY_STR ("etag", etag, NULL);
+	CHECK_PROPERTY (cmpuint, "parse-threads", parse_threads, 1, 4, 0, guint, FALSE);
+	CHECK_PROPERTY (cmpuint, "retain-entries", retain_entries, TRUE, FALSE, TRUE, gboolean, FALSE);
+
+#undef CHECK_PROPERTY_BOOLEAN
+#undef CHECK_PROPERTY_UINT
+#undef CHECK_PROPERTY_INT64
+#undef CHECK_PROPERTY_STR
+#undef CHECK_PROPERTY
+
+	g_object_unref (query);
+}
+
+static void
+test_query_unicode (void)
+{
+	GDataQuery *query;
+	gchar *query_uri;
+
+	g_test_bug ("602497");
+
+	/* Simple query */
+	query = gdata_query_new ("fööbar‽");
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com?q=f%C3%B6%C3%B6bar%E2%80%BD");
+	g_free (query_uri);
+
+	/* Categories */
+	gdata_query_set_categories (query, "Ümlauts|¿Questions‽");
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/-/%C3%9Cmlauts%7C%C2%BFQuestions%E2%80%BD?q=f%C3%B6%C3%B6bar%E2%80%BD");
+	g_free (query_uri);
+
+	/* Author */
+	gdata_query_set_author (query, "Lørd Brïan Bleßêd");
+	query_uri = gdata_query_get_query_uri (query, "http://example.com");
+	g_assert_cmpstr (query_uri, ==, "http://example.com/-/%C3%9Cmlauts%7C%C2%BFQuestions%E2%80%BD?q=f%C3%B6%C3%B6bar%E2%80%BD&author=L%C3%B8rd%20Br%C3%AFan%20Ble%C3%9F%C3%AAd");
+	g_free (query_uri);
+
+	g_object_unref (query);
+}
+
+static void
+test_query_etag (void)
+{
+	GDataQuery *query = gdata_query_new (NULL);
+
+	/* Test that setting any property will unset the ETag */
+	g_test_bug ("613529");
+
+	/* Also check that setting the ETag doesn't unset the ETag! */
+	gdata_query_set_etag (query, "foobar");
+	g_assert_cmpstr (gdata_query_get_etag (query), ==, "foobar");
+
+#define CHECK_ETAG(C) \
+	gdata_query_set_etag (query, "foobar");		\
+	(C);						\
+	g_assert (gdata_query_get_etag (query) == NULL);
+
+	CHECK_ETAG (gdata_query_set_q (query, "q"))
+	CHECK_ETAG (gdata_query_set_categories (query, "shizzle,foobar"))
+	CHECK_ETAG (gdata_query_set_author (query, "John Smith"))
+	CHECK_ETAG (gdata_query_set_updated_min (query, -1))
+	CHECK_ETAG (gdata_query_set_updated_max (query, -1))
+	CHECK_ETAG (gdata_query_set_published_min (query, -1))
+	CHECK_ETAG (gdata_query_set_published_max (query, -1))
+	CHECK_ETAG (gdata_query_set_start_index (query, 5))
+	CHECK_ETAG (gdata_query_set_is_strict (query, TRUE))
+	CHECK_ETAG (gdata_query_set_max_results (query, 1000))
+	CHECK_ETAG (gdata_query_set_fields (query, "entry(title)"))
+	CHECK_ETAG (gdata_query_next_page (query))
+	CHECK_ETAG (gdata_query_previous_page (query))
+
+#undef CHECK_ETAG
+
+	/* The unhandled XML mode doesn't affect the query URI, so shouldn't unset the ETag */
+	gdata_query_set_etag (query, "foobar");
+	gdata_query_set_unhandled_xml_mode (query, GDATA_UNHANDLED_XML_DISCARD);
+	g_assert_cmpint (gdata_query_get_unhandled_xml_mode (query), ==, GDATA_UNHANDLED_XML_DISCARD);
+	g_assert_cmpstr (gdata_query_get_etag (query), ==, "foobar");
+
+	/* Nor does lazy parsing */
+	g_assert (gdata_query_get_lazy_parsing (query) == FALSE);
+	gdata_query_set_lazy_parsing (query, TRUE);
+	g_assert (gdata_query_get_lazy_parsing (query) == TRUE);
+	g_assert_cmpstr (gdata_query_get_etag (query), ==, "foobar");
+
+	/* Nor does the page cache mode */
+	g_assert_cmpint (gdata_query_get_page_cache_mode (query), ==, GDATA_PAGE_CACHE_NONE);
+	gdata_query_set_page_cache_mode (query, GDATA_PAGE_CACHE_FEEDS);
+	g_assert_cmpint (gdata_query_get_page_cache_mode (query), ==, GDATA_PAGE_CACHE_FEEDS);
+	g_object_set (query, "page-cache-mode", GDATA_PAGE_CACHE_ETAGS, NULL);
+	g_assert_cmpint (gdata_query_get_page_cache_mode (query), ==, GDATA_PAGE_CACHE_ETAGS);
+	g_assert_cmpstr (gdata_query_get_etag (query), ==, "foobar");
+
+	g_object_unref (query);
+}
+
+/* Queries @feed_uri with @query, and checks that the result has @n_entries entries, starting with urn:entry:@first_entry; or, if @n_entries is 0,
+ * that there's no result because the page hasn't changed */
+static GDataFeed *
+query_page_and_check (GDataService *service, const gchar *feed_uri, GDataQuery *query, guint first_entry, guint n_entries)
+{
+	GDataFeed *feed;
+	GList *entries;
+	gchar *expected_id;
+	GError *error = NULL;
+
+	feed = gdata_service_query (service, NULL, feed_uri, query, GDATA_TYPE_ENTRY, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+
+	if (n_entries == 0) {
+		g_assert (feed == NULL);
+		return NULL;
+	}
+
+	g_assert (GDATA_IS_FEED (feed));
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, n_entries);
+
+	expected_id = g_strdup_printf ("urn:entry:%u", first_entry);
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (entries->data)), ==, expected_id);
+	g_free (expected_id);
+
+	return feed;
+}
+
+static void
+test_query_page_etags (void)
+{
+	GDataService *service;
+	GDataQuery *query;
+	GDataFeed *feed, *feed2;
+	RequestLog *log;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	query = gdata_query_new_with_limits (NULL, 0, 2);
+	gdata_query_set_page_cache_mode (query, GDATA_PAGE_CACHE_ETAGS);
+	log = request_log_start ();
+
+	gdata_test_mock_server_start_trace (mock_server, "page-etags");
+
+	/* Page through the feed once, remembering each page's ETag */
+	g_object_unref (query_page_and_check (service, "https://www.google.com/feeds/general/page-etags", query, 1, 2));
+	gdata_query_next_page (query);
+	g_object_unref (query_page_and_check (service, "https://www.google.com/feeds/general/page-etags", query, 3, 1));
+
+	/* The query's own ETag isn't touched, since the pages' ETags supersede it */
+	g_assert (gdata_query_get_etag (query) == NULL);
+
+	/* Page through it again. The first page hasn't changed, so there's no result for it; the second has, so it's returned in full. */
+	gdata_query_set_start_index (query, 0);
+	g_assert (query_page_and_check (service, "https://www.google.com/feeds/general/page-etags", query, 0, 0) == NULL);
+	gdata_query_next_page (query);
+	g_object_unref (query_page_and_check (service, "https://www.google.com/feeds/general/page-etags", query, 3, 2));
+
+	uhm_server_end_trace (mock_server);
+
+	/* Only the second pass was conditional, with each page's own ETag */
+	g_assert_cmpuint (request_log_get_length (log), ==, 4);
+	g_assert (soup_message_headers_get_one (request_log_get (log, 0)->headers, "If-None-Match") == NULL);
+	g_assert (soup_message_headers_get_one (request_log_get (log, 1)->headers, "If-None-Match") == NULL);
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 2)->headers, "If-None-Match"), ==, "W/\"page-1\"");
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 3)->headers, "If-None-Match"), ==, "W/\"page-2\"");
+
+	request_log_stop (log);
+	g_object_unref (query);
+
+	/* If the query keeps the pages' feeds as well, an unchanged page's feed is returned again */
+	query = gdata_query_new_with_limits (NULL, 0, 2);
+	gdata_query_set_page_cache_mode (query, GDATA_PAGE_CACHE_FEEDS);
+
+	gdata_test_mock_server_start_trace (mock_server, "page-etags-feeds");
+
+	feed = query_page_and_check (service, "https://www.google.com/feeds/general/page-etags-feeds", query, 1, 2);
+	feed2 = query_page_and_check (service, "https://www.google.com/feeds/general/page-etags-feeds", query, 1, 2);
+	g_assert (feed2 == feed);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (feed2);
+	g_object_unref (feed);
+	g_object_unref (query);
+	g_object_unref (service);
+}
+
+/* Queries the unhandled-xml-mode feed with the given mode, returning the XML of its only entry after checking the entry's handled properties */
+static gchar *
+query_unhandled_xml_mode (GDataService *service, GDataUnhandledXmlMode mode)
+{
+	GDataQuery *query;
+	GDataFeed *feed;
+	GDataEntry *entry;
+	GList *authors;
+	gchar *xml;
+	GError *error = NULL;
+
+	query = gdata_query_new (NULL);
+	gdata_query_set_unhandled_xml_mode (query, mode);
+
+	feed = gdata_service_query (service, NULL, "https://www.google.com/feeds/general/unhandled-xml-mode", query, GDATA_TYPE_ENTRY, NULL, NULL,
+	                            NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (feed)), ==, 1);
+
+	/* The mode only affects unhandled XML */
+	entry = GDATA_ENTRY (gdata_feed_get_entries (feed)->data);
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "Entry 1");
+
+	authors = gdata_entry_get_authors (entry);
+	g_assert_cmpuint (g_list_length (authors), ==, 1);
+	g_assert_cmpstr (gdata_author_get_name (GDATA_AUTHOR (authors->data)), ==, "Author");
+
+	xml = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
+
+	g_object_unref (feed);
+	g_object_unref (query);
+
+	return xml;
+}
+
+static void
+test_query_unhandled_xml_mode (void)
+{
+	GDataService *service;
+	GDataEntry *entry;
+	gchar *keep_xml, *lazy_xml, *discard_xml;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	gdata_test_mock_server_start_trace (mock_server, "unhandled-xml-mode");
+
+	keep_xml = query_unhandled_xml_mode (service, GDATA_UNHANDLED_XML_KEEP);
+	lazy_xml = query_unhandled_xml_mode (service, GDATA_UNHANDLED_XML_LAZY);
+	discard_xml = query_unhandled_xml_mode (service, GDATA_UNHANDLED_XML_DISCARD);
+
+	uhm_server_end_trace (mock_server);
+
+	/* Keeping the unhandled XML outputs it again, both from the entry and from the author within it */
+	g_assert (strstr (keep_xml, "<foo:bar") != NULL);
+	g_assert (strstr (keep_xml, "Unhandled content<foo:child/>") != NULL);
+	g_assert (strstr (keep_xml, "Nested content") != NULL);
+	g_assert (strstr (keep_xml, "xmlns:foo='http://example.com/foo'") != NULL);
+
+	/* Capturing it lazily outputs the same elements, with their namespaces, once the XML's asked for */
+	g_assert (strstr (lazy_xml, "<foo:bar") != NULL);
+	g_assert (strstr (lazy_xml, "Unhandled content<foo:child/>") != NULL);
+	g_assert (strstr (lazy_xml, "Nested content") != NULL);
+
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY, lazy_xml, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_object_unref (entry);
+
+	/* Discarding it drops it entirely, but keeps everything which was handled */
+	g_assert (strstr (discard_xml, "foo:") == NULL);
+	g_assert (strstr (discard_xml, "Unhandled content") == NULL);
+	g_assert (strstr (discard_xml, "Nested content") == NULL);
+	g_assert (strstr (discard_xml, "<title type='text'>Entry 1</title>") != NULL);
+	g_assert (strstr (discard_xml, "<name>Author</name>") != NULL);
+
+	g_free (discard_xml);
+	g_free (lazy_xml);
+	g_free (keep_xml);
+	g_object_unref (service);
+}
+
+static void
+test_service_network_error (void)
+{
+	GDataService *service;
+#if 0
+	SoupURI *proxy_uri;
+#endif
+	GError *error = NULL;
+
+	/* This is a little hacky, but it should work */
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Try a query which should always fail due to errors resolving the hostname */
+	g_assert (gdata_service_query (service, NULL, "http://thisshouldnotexist.localhost", NULL, GDATA_TYPE_ENTRY,
+	                               NULL, NULL, NULL, &error) == NULL);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NETWORK_ERROR);
+	g_clear_error (&error);
+
+	/* TODO: We have to disable this test, as libsoup 2.30.2 < x <= 2.32.0 doesn't return SOUP_STATUS_CANT_RESOLVE_PROXY properly any more.
+	 * Filed as bgo#632354. */
+#if 0
+	/* Try one with a bad proxy set */
+	proxy_uri = soup_uri_new ("http://thisshouldalsonotexist.localhost/proxy");
+	gdata_service_set_proxy_uri (service, proxy_uri);
+	soup_uri_free (proxy_uri);
+
+	g_assert (gdata_service_query (service, "http://google.com", NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL, &error) == NULL);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROXY_ERROR);
+	g_clear_error (&error);
+#endif
+
+	g_object_unref (service);
+}
+
+static void
+test_service_locale (void)
+{
+	GDataService *service;
+	gchar *locale;
+
+	/* This is a little hacky, but it should work */
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Just test setting and getting the locale */
+	g_assert (gdata_service_get_locale (service) == NULL);
+	gdata_service_set_locale (service, "en_GB");
+	g_assert_cmpstr (gdata_service_get_locale (service), ==, "en_GB");
+
+	g_object_get (service, "locale", &locale, NULL);
+	g_assert_cmpstr (locale, ==, "en_GB");
+	g_free (locale);
+
+	g_object_unref (service);
+}
+
+static void
+test_service_max_error_response_size (void)
+{
+	GDataService *service;
+	guint max_error_response_size;
+	GError *error = NULL;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Error response bodies are capped by default */
+	g_assert_cmpuint (gdata_service_get_max_error_response_size (service), ==, 64 * 1024);
+	gdata_service_set_max_error_response_size (service, 0);
+	g_assert_cmpuint (gdata_service_get_max_error_response_size (service), ==, 0);
+
+	g_object_set (service, "max-error-response-size", 10, NULL);
+	g_object_get (service, "max-error-response-size", &max_error_response_size, NULL);
+	g_assert_cmpuint (max_error_response_size, ==, 10);
+
+	if (skip_if_not_offline () == TRUE) {
+		g_object_unref (service);
+		return;
+	}
+
+	gdata_test_mock_server_start_trace (mock_server, "max-error-response-size");
+
+	/* Only the start of the error response body makes it into the error */
+	g_assert (gdata_service_query_single_entry (service, NULL, "https://www.google.com/feeds/general/max-error-response-size", NULL,
+	                                            GDATA_TYPE_ENTRY, NULL, &error) == NULL);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (g_str_has_suffix (error->message, ": 0123456789") == TRUE);
+	g_clear_error (&error);
+
+	/* Without a limit, all of it does */
+	gdata_service_set_max_error_response_size (service, 0);
+
+	g_assert (gdata_service_query_single_entry (service, NULL, "https://www.google.com/feeds/general/max-error-response-size", NULL,
+	                                            GDATA_TYPE_ENTRY, NULL, &error) == NULL);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (strstr (error->message, ": 0123456789abcdefghijklmnopqrstuvwxyz") != NULL);
+	g_clear_error (&error);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (service);
+}
+
+static void
+test_service_connection_pool (void)
+{
+	GDataService *service;
+	guint max_connections, requests_sent, connections_opened, tls_handshakes;
+	guint64 bytes_received, bytes_decoded;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Test setting and getting the connection pool properties */
+	gdata_service_set_max_connections (service, 20);
+	g_assert_cmpuint (gdata_service_get_max_connections (service), ==, 20);
+	gdata_service_set_max_connections_per_host (service, 8);
+	g_assert_cmpuint (gdata_service_get_max_connections_per_host (service), ==, 8);
+	gdata_service_set_idle_timeout (service, 30);
+	g_assert_cmpuint (gdata_service_get_idle_timeout (service), ==, 30);
+
+	g_object_set (service, "max-connections", 15, NULL);
+	g_object_get (service, "max-connections", &max_connections, NULL);
+	g_assert_cmpuint (max_connections, ==, 15);
+
+	/* Nothing's been sent yet */
+	gdata_service_get_connection_statistics (service, &requests_sent, &connections_opened, &tls_handshakes);
+	g_assert_cmpuint (requests_sent, ==, 0);
+	g_assert_cmpuint (connections_opened, ==, 0);
+	g_assert_cmpuint (tls_handshakes, ==, 0);
+
+	gdata_service_get_transfer_statistics (service, &bytes_received, &bytes_decoded);
+	g_assert_cmpuint (bytes_received, ==, 0);
+	g_assert_cmpuint (bytes_decoded, ==, 0);
+
+	g_object_unref (service);
+}
+
+static void
+prepare_connections_cb (GDataService *service, GAsyncResult *async_result, GAsyncResult **result_out)
+{
+	*result_out = g_object_ref (async_result);
+}
+
+static void
+test_service_prepare_connections (void)
+{
+	GDataService *service;
+	GCancellable *cancellable;
+	GAsyncResult *async_result = NULL;
+	guint requests_sent;
+	GError *error = NULL;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* The base service type has no authorization domains, so there's nothing to connect to */
+	gdata_service_prepare_connections_async (service, NULL, NULL, (GAsyncReadyCallback) prepare_connections_cb, &async_result);
+
+	while (async_result == NULL)
+		g_main_context_iteration (NULL, TRUE);
+
+	g_assert (gdata_service_prepare_connections_finish (service, async_result, &error) == TRUE);
+	g_assert_no_error (error);
+	g_clear_object (&async_result);
+
+	/* Cancelling beforehand means nothing gets sent */
+	cancellable = g_cancellable_new ();
+	g_cancellable_cancel (cancellable);
+
+	gdata_service_prepare_connections_async (service, (const gchar * const []) { "https://example.com/feeds/", NULL }, cancellable,
+	                                         (GAsyncReadyCallback) prepare_connections_cb, &async_result);
+
+	while (async_result == NULL)
+		g_main_context_iteration (NULL, TRUE);
+
+	g_assert (gdata_service_prepare_connections_finish (service, async_result, &error) == FALSE);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_clear_error (&error);
+	g_clear_object (&async_result);
+
+	gdata_service_get_connection_statistics (service, &requests_sent, NULL, NULL);
+	g_assert_cmpuint (requests_sent, ==, 0);
+
+	g_object_unref (cancellable);
+	g_object_unref (service);
+}
+
+static void
+test_service_entry_cache (void)
+{
+	GDataService *service;
+	guint entry_cache_size;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* The cache is disabled by default */
+	g_assert_cmpuint (gdata_service_get_entry_cache_size (service), ==, 0);
+
+	gdata_service_set_entry_cache_size (service, 200);
+	g_assert_cmpuint (gdata_service_get_entry_cache_size (service), ==, 200);
+
+	g_object_set (service, "entry-cache-size", 50, NULL);
+	g_object_get (service, "entry-cache-size", &entry_cache_size, NULL);
+	g_assert_cmpuint (entry_cache_size, ==, 50);
+
+	g_object_unref (service);
+}
+
+static void
+test_service_acl_cache (void)
+{
+	GDataService *service;
+	guint acl_cache_size;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* The cache is disabled by default */
+	g_assert_cmpuint (gdata_service_get_acl_cache_size (service), ==, 0);
+
+	gdata_service_set_acl_cache_size (service, 20);
+	g_assert_cmpuint (gdata_service_get_acl_cache_size (service), ==, 20);
+
+	g_object_set (service, "acl-cache-size", 5, NULL);
+	g_object_get (service, "acl-cache-size", &acl_cache_size, NULL);
+	g_assert_cmpuint (acl_cache_size, ==, 5);
+
+	g_object_unref (service);
+}
+
+static void
+test_cache_manager (void)
+{
+	GDataCacheManager *manager;
+	GDataService *service;
+	GVariant *stats;
+	GVariantIter iter;
+	const gchar *name;
+	guint64 n_bytes, budget;
+	guint32 n_items, n_hits, n_misses, n_evictions;
+	gboolean found_entry_cache = FALSE;
+
+	manager = gdata_cache_manager_get_default ();
+	g_assert (GDATA_IS_CACHE_MANAGER (manager));
+	g_assert (gdata_cache_manager_get_default () == manager);
+
+	/* There's no budget by default */
+	g_assert_cmpuint (gdata_cache_manager_get_budget (manager), ==, 0);
+
+	gdata_cache_manager_set_budget (manager, 1024 * 1024);
+	g_assert_cmpuint (gdata_cache_manager_get_budget (manager), ==, 1024 * 1024);
+
+	g_object_set (manager, "budget", (guint64) 0, NULL);
+	g_object_get (manager, "budget", &budget, NULL);
+	g_assert_cmpuint (budget, ==, 0);
+
+	/* Each service's caches should be registered, and empty to begin with */
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	gdata_service_set_entry_cache_size (service, 10);
+
+	stats = gdata_cache_manager_dup_stats (manager);
+	g_assert (g_variant_is_of_type (stats, G_VARIANT_TYPE ("a{s(tuuuu)}")) == TRUE);
+
+	g_variant_iter_init (&iter, stats);
+	while (g_variant_iter_next (&iter, "{&s(tuuuu)}", &name, &n_bytes, &n_items, &n_hits, &n_misses, &n_evictions) == TRUE) {
+		if (strcmp (name, "GDataService:entry-cache") == 0) {
+			g_assert_cmpuint (n_bytes, ==, 0);
+			g_assert_cmpuint (n_items, ==, 0);
+			g_assert_cmpuint (n_evictions, ==, 0);
+			found_entry_cache = TRUE;
+		}
+	}
+
+	g_assert (found_entry_cache == TRUE);
+	g_variant_unref (stats);
+
+	/* Trimming empty caches should be harmless */
+	gdata_cache_manager_trim (manager, 0);
+	gdata_cache_manager_handle_memory_pressure (manager, GDATA_MEMORY_PRESSURE_CRITICAL);
+	g_assert_cmpuint (gdata_cache_manager_get_size (manager), ==, 0);
+
+	g_object_unref (service);
+}
+
+/* Recursively deletes the directory at @path */
+static void
+delete_directory (const gchar *path)
+{
+	GDir *dir;
+	const gchar *name;
+
+	dir = g_dir_open (path, 0, NULL);
+	while (dir != NULL && (name = g_dir_read_name (dir)) != NULL) {
+		gchar *child_path = g_build_filename (path, name, NULL);
+
+		if (g_file_test (child_path, G_FILE_TEST_IS_DIR) == TRUE)
+			delete_directory (child_path);
+		else
+			g_unlink (child_path);
+
+		g_free (child_path);
+	}
+
+	if (dir != NULL)
+		g_dir_close (dir);
+
+	g_rmdir (path);
+}
+
+static void
+test_blob_store (void)
+{
+	GDataBlobStore *store;
+	GDataService *service;
+	GBytes *data, *other_data, *blob;
+	gchar *directory, *hash, *other_hash, *content_type = NULL;
+
+	directory = g_dir_make_tmp ("libgdata-blob-store-XXXXXX", NULL);
+	g_assert (directory != NULL);
+
+	store = gdata_blob_store_new (directory);
+	g_assert (GDATA_IS_BLOB_STORE (store));
+	g_assert_cmpstr (gdata_blob_store_get_directory (store), ==, directory);
+	g_assert_cmpuint (gdata_blob_store_get_size (store), ==, 0);
+
+	data = g_bytes_new_static ("avatar", 6);
+	other_data = g_bytes_new_static ("thumbnail", 9);
+
+	/* Blobs are named after the SHA-256 checksums of their contents */
+	hash = gdata_blob_store_add (store, "https://example.com/photo", "\"etag1\"", "image/png", data, NULL);
+	other_hash = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, data);
+	g_assert_cmpstr (hash, ==, other_hash);
+	g_free (other_hash);
+
+	g_assert_cmpuint (gdata_blob_store_get_size (store), ==, 6);
+
+	blob = gdata_blob_store_lookup (store, hash);
+	g_assert (blob != NULL);
+	g_assert (g_bytes_equal (blob, data) == TRUE);
+	g_bytes_unref (blob);
+
+	/* Looking up by URI only finds the current version */
+	blob = gdata_blob_store_lookup_uri (store, "https://example.com/photo", "\"etag1\"", &content_type);
+	g_assert (blob != NULL);
+	g_assert (g_bytes_equal (blob, data) == TRUE);
+	g_assert_cmpstr (content_type, ==, "image/png");
+	g_bytes_unref (blob);
+	g_free (content_type);
+
+	blob = gdata_blob_store_lookup_uri (store, "https://example.com/photo", NULL, NULL);
+	g_assert (blob != NULL);
+	g_bytes_unref (blob);
+
+	g_assert (gdata_blob_store_lookup_uri (store, "https://example.com/photo", "\"etag2\"", &content_type) == NULL);
+	g_assert (content_type == NULL);
+	g_assert (gdata_blob_store_lookup_uri (store, "https://example.com/other", NULL, NULL) == NULL);
+
+	/* The same contents from another URI are only stored once */
+	other_hash = gdata_blob_store_add (store, "https://example.org/avatar", NULL, NULL, data, NULL);
+	g_assert_cmpstr (other_hash, ==, hash);
+	g_assert_cmpuint (gdata_blob_store_get_size (store), ==, 6);
+	g_free (other_hash);
+
+	blob = gdata_blob_store_lookup_uri (store, "https://example.org/avatar", NULL, &content_type);
+	g_assert (blob != NULL);
+	g_assert (content_type == NULL);
+	g_bytes_unref (blob);
+
+	/* Forgetting a URI leaves its blob in the store */
+	gdata_blob_store_remove_uri (store, "https://example.org/avatar");
+	g_assert (gdata_blob_store_lookup_uri (store, "https://example.org/avatar", NULL, NULL) == NULL);
+
+	blob = gdata_blob_store_lookup (store, hash);
+	g_assert (blob != NULL);
+	g_bytes_unref (blob);
+
+	other_hash = gdata_blob_store_add (store, NULL, NULL, NULL, other_data, NULL);
+	g_assert (other_hash != NULL);
+	g_assert_cmpuint (gdata_blob_store_get_size (store), ==, 15);
+
+	/* The blobs should still be there for a new store using the same directory */
+	g_object_unref (store);
+	store = gdata_blob_store_new (directory);
+	g_assert_cmpuint (gdata_blob_store_get_size (store), ==, 15);
+
+	blob = gdata_blob_store_lookup_uri (store, "https://example.com/photo", "\"etag1\"", NULL);
+	g_assert (blob != NULL);
+	g_bytes_unref (blob);
+
+	/* The store is held to the cache manager's budget, evicting the least recently used blob first */
+	gdata_cache_manager_set_budget (gdata_cache_manager_get_default (), 10);
+	g_assert_cmpuint (gdata_blob_store_get_size (store), ==, 6);
+	g_assert (gdata_blob_store_lookup (store, other_hash) == NULL);
+	gdata_cache_manager_set_budget (gdata_cache_manager_get_default (), 0);
+
+	/* It isn't touched on low memory warnings, since it's not in memory */
+	gdata_cache_manager_handle_memory_pressure (gdata_cache_manager_get_default (), GDATA_MEMORY_PRESSURE_CRITICAL);
+	g_assert_cmpuint (gdata_blob_store_get_size (store), ==, 6);
+
+	gdata_cache_manager_trim (gdata_cache_manager_get_default (), 0);
+	g_assert_cmpuint (gdata_blob_store_get_size (store), ==, 0);
+	g_assert (gdata_blob_store_lookup_uri (store, "https://example.com/photo", NULL, NULL) == NULL);
+
+	/* Test the service's property */
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	g_assert (gdata_service_get_blob_store (service) == NULL);
+
+	gdata_service_set_blob_store (service, store);
+	g_assert (gdata_service_get_blob_store (service) == store);
+
+	g_object_set (service, "blob-store", NULL, NULL);
+	g_assert (gdata_service_get_blob_store (service) == NULL);
+
+	g_object_unref (service);
+
+	g_free (other_hash);
+	g_free (hash);
+	g_bytes_unref (other_data);
+	g_bytes_unref (data);
+	g_object_unref (store);
+
+	delete_directory (directory);
+	g_free (directory);
+}
+
+static void
+test_service_query_entries_by_id_empty (void)
+{
+	GDataService *service;
+	GHashTable *entries;
+	const gchar *entry_ids[] = { NULL };
+	GError *error = NULL;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Querying no entries doesn't need any requests, and gives an empty result */
+	entries = gdata_service_query_entries_by_id (service, NULL, NULL, entry_ids, GDATA_TYPE_ENTRY, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (entries != NULL);
+	g_assert_cmpuint (g_hash_table_size (entries), ==, 0);
+
+	g_hash_table_unref (entries);
+	g_object_unref (service);
+}
+
+static void
+test_service_query_entries_by_id (void)
+{
+	GDataService *service;
+	GDataEntry *entry;
+	GHashTable *entries, *cached_entries;
+	RequestLog *log;
+	guint old_max_connections;
+	const gchar *entry_ids[] = {
+		"https://www.google.com/feeds/general/entries/e1",
+		"https://www.google.com/feeds/general/entries/e2",
+		"https://www.google.com/feeds/general/entries/e1",
+		"https://www.google.com/feeds/general/entries/e3",
+		NULL
+	};
+	const gchar *e1_ids[] = { "https://www.google.com/feeds/general/entries/e1", NULL };
+	const gchar *e2_ids[] = { "https://www.google.com/feeds/general/entries/e2", NULL };
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	/* A plain service isn't batchable, so the entries are queried individually; do so one at a time to keep the trace in order */
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	gdata_service_set_entry_cache_size (service, 10);
+	old_max_connections = gdata_service_get_max_connections_per_host (service);
+	gdata_service_set_max_connections_per_host (service, 1);
+	log = request_log_start ();
+
+	gdata_test_mock_server_start_trace (mock_server, "query-entries-by-id");
+
+	/* The duplicated ID is only queried once, and the missing entry is left out of the results */
+	entries = gdata_service_query_entries_by_id (service, NULL, NULL, entry_ids, GDATA_TYPE_ENTRY, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (entries != NULL);
+	g_assert_cmpuint (g_hash_table_size (entries), ==, 2);
+
+	entry = g_hash_table_lookup (entries, entry_ids[0]);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "Entry 1");
+	g_assert_cmpstr (gdata_entry_get_etag (entry), ==, "W/\"e1-1\"");
+
+	entry = g_hash_table_lookup (entries, entry_ids[1]);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "Entry 2");
+
+	g_assert (g_hash_table_lookup (entries, entry_ids[3]) == NULL);
+
+	/* Querying a cached entry again is conditional on its ETag, and an unchanged entry comes from the cache */
+	cached_entries = gdata_service_query_entries_by_id (service, NULL, NULL, e1_ids, GDATA_TYPE_ENTRY, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (cached_entries != NULL);
+	g_assert_cmpuint (g_hash_table_size (cached_entries), ==, 1);
+
+	entry = g_hash_table_lookup (cached_entries, e1_ids[0]);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "Entry 1");
+	g_assert_cmpstr (gdata_entry_get_etag (entry), ==, "W/\"e1-1\"");
+
+	g_hash_table_unref (cached_entries);
+
+	/* Any error other than a missing entry fails the whole query */
+	g_assert (gdata_service_query_entries_by_id (service, NULL, NULL, e2_ids, GDATA_TYPE_ENTRY, NULL, &error) == NULL);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_clear_error (&error);
+
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 5);
+	g_assert_cmpstr (request_log_get (log, 0)->path_and_query, ==, "/feeds/general/entries/e1");
+	g_assert_cmpstr (request_log_get (log, 1)->path_and_query, ==, "/feeds/general/entries/e2");
+	g_assert_cmpstr (request_log_get (log, 2)->path_and_query, ==, "/feeds/general/entries/e3");
+	g_assert (soup_message_headers_get_one (request_log_get (log, 0)->headers, "If-None-Match") == NULL);
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 3)->headers, "If-None-Match"), ==, "W/\"e1-1\"");
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 4)->headers, "If-None-Match"), ==, "W/\"e2-1\"");
+
+	request_log_stop (log);
+	g_hash_table_unref (entries);
+
+	gdata_service_set_max_connections_per_host (service, old_max_connections);
+	g_object_unref (service);
+}
+
+static void
+test_watch_channel_inactive (void)
+{
+	GDataService *service;
+	GDataWatchChannel *channel;
+	SoupMessageHeaders *headers;
+	gchar *token;
+	gint64 expiration;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	channel = gdata_watch_channel_new (service, NULL, "https://example.com/watch", "https://example.com/stop", "https://example.org/notify");
+
+	g_assert (gdata_watch_channel_get_service (channel) == service);
+	g_assert (gdata_watch_channel_get_authorization_domain (channel) == NULL);
+	g_assert_cmpstr (gdata_watch_channel_get_watch_uri (channel), ==, "https://example.com/watch");
+	g_assert_cmpstr (gdata_watch_channel_get_stop_uri (channel), ==, "https://example.com/stop");
+	g_assert_cmpstr (gdata_watch_channel_get_address (channel), ==, "https://example.org/notify");
+
+	gdata_watch_channel_set_token (channel, "secret");
+	g_object_get (channel, "token", &token, "expiration", &expiration, NULL);
+	g_assert_cmpstr (token, ==, "secret");
+	g_assert_cmpint (expiration, ==, -1);
+	g_free (token);
+
+	/* Nothing's been started yet */
+	g_assert (gdata_watch_channel_is_active (channel) == FALSE);
+	g_assert (gdata_watch_channel_dup_id (channel) == NULL);
+	g_assert (gdata_watch_channel_dup_resource_id (channel) == NULL);
+
+	/* so all notifications are ignored */
+	headers = soup_message_headers_new (SOUP_MESSAGE_HEADERS_REQUEST);
+	soup_message_headers_append (headers, "X-Goog-Channel-ID", "some-channel");
+	soup_message_headers_append (headers, "X-Goog-Channel-Token", "secret");
+	soup_message_headers_append (headers, "X-Goog-Resource-State", "exists");
+	soup_message_headers_append (headers, "X-Goog-Message-Number", "2");
+	g_assert_cmpint (gdata_watch_channel_handle_notification (channel, headers), ==, GDATA_WATCH_NOTIFICATION_IGNORED);
+	soup_message_headers_free (headers);
+
+	/* Stopping an inactive channel does nothing */
+	g_assert (gdata_watch_channel_stop (channel, NULL, NULL) == TRUE);
+
+	g_object_unref (channel);
+	g_object_unref (service);
+}
+
+static GDataWatchNotification
+send_watch_notification (GDataWatchChannel *channel, const gchar *channel_id, const gchar *token, const gchar *resource_state,
+                         const gchar *message_number)
+{
+	SoupMessageHeaders *headers;
+	GDataWatchNotification notification;
+
+	headers = soup_message_headers_new (SOUP_MESSAGE_HEADERS_REQUEST);
+	soup_message_headers_append (headers, "X-Goog-Channel-ID", channel_id);
+	if (token != NULL)
+		soup_message_headers_append (headers, "X-Goog-Channel-Token", token);
+	soup_message_headers_append (headers, "X-Goog-Resource-ID", "resource-1");
+	soup_message_headers_append (headers, "X-Goog-Resource-State", resource_state);
+	soup_message_headers_append (headers, "X-Goog-Message-Number", message_number);
+
+	notification = gdata_watch_channel_handle_notification (channel, headers);
+	soup_message_headers_free (headers);
+
+	return notification;
+}
+
+static void
+watch_channel_notification_cb (GDataWatchChannel *channel, GDataWatchNotification notification, GString *notifications)
+{
+	g_assert (notification == GDATA_WATCH_NOTIFICATION_CHANGED || notification == GDATA_WATCH_NOTIFICATION_REMOVED);
+	g_string_append_printf (notifications, "%s%s", (notifications->len > 0) ? "," : "",
+	                        (notification == GDATA_WATCH_NOTIFICATION_CHANGED) ? "changed" : "removed");
+}
+
+static void
+assert_watch_channel_request (RequestLog *log, guint index, const gchar *path, const gchar *expected_json)
+{
+	LoggedRequest *request;
+	gchar *body;
+
+	request = request_log_get (log, index);
+	g_assert_cmpstr (request->method, ==, "POST");
+	g_assert_cmpstr (request->path_and_query, ==, path);
+	g_assert_cmpstr (soup_message_headers_get_content_type (request->headers, NULL), ==, "application/json");
+
+	body = g_strndup (g_bytes_get_data (request->body, NULL), g_bytes_get_size (request->body));
+	g_assert (gdata_test_compare_json_strings (body, expected_json, TRUE) == TRUE);
+	g_free (body);
+}
+
+static void
+test_watch_channel (void)
+{
+	GDataService *service;
+	GDataWatchChannel *channel;
+	GString *notifications;
+	RequestLog *log;
+	gchar *id, *old_id, *resource_id, *expected_json;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	channel = gdata_watch_channel_new (service, NULL, "https://www.google.com/feeds/general/watch", "https://www.google.com/feeds/general/stop",
+	                                   "https://example.org/notify");
+	gdata_watch_channel_set_token (channel, "secret");
+
+	notifications = g_string_new (NULL);
+	g_signal_connect (channel, "notification", (GCallback) watch_channel_notification_cb, notifications);
+
+	log = request_log_start ();
+
+	gdata_test_mock_server_start_trace (mock_server, "watch-channel");
+
+	/* Start the channel. The server's response gives the resource ID and expiration, but the channel keeps the ID it chose itself. */
+	g_assert (gdata_watch_channel_start (channel, 3600, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert (gdata_watch_channel_is_active (channel) == TRUE);
+	g_assert_cmpint (gdata_watch_channel_get_expiration (channel), ==, G_GINT64_CONSTANT (1791993600000));
+
+	id = gdata_watch_channel_dup_id (channel);
+	g_assert (id != NULL);
+	g_assert_cmpstr (id, !=, "4f1c0b9a6e2d47b8a3c5d9e0f1a2b3c4");
+
+	resource_id = gdata_watch_channel_dup_resource_id (channel);
+	g_assert_cmpstr (resource_id, ==, "resource-1");
+	g_free (resource_id);
+
+	/* The initial sync notification doesn't emit the signal; changes and removals do, but only once each, only for this channel, and only
+	 * with the right token */
+	g_assert_cmpint (send_watch_notification (channel, id, "secret", "sync", "1"), ==, GDATA_WATCH_NOTIFICATION_SYNC);
+	g_assert_cmpint (send_watch_notification (channel, id, "secret", "exists", "2"), ==, GDATA_WATCH_NOTIFICATION_CHANGED);
+	g_assert_cmpint (send_watch_notification (channel, id, "secret", "exists", "2"), ==, GDATA_WATCH_NOTIFICATION_IGNORED);
+	g_assert_cmpint (send_watch_notification (channel, id, "wrong", "exists", "3"), ==, GDATA_WATCH_NOTIFICATION_IGNORED);
+	g_assert_cmpint (send_watch_notification (channel, id, NULL, "exists", "3"), ==, GDATA_WATCH_NOTIFICATION_IGNORED);
+	g_assert_cmpint (send_watch_notification (channel, "other-channel", "secret", "exists", "3"), ==, GDATA_WATCH_NOTIFICATION_IGNORED);
+	g_assert_cmpint (send_watch_notification (channel, id, "secret", "not_exists", "3"), ==, GDATA_WATCH_NOTIFICATION_REMOVED);
+
+	g_assert_cmpstr (notifications->str, ==, "changed,removed");
+
+	/* Renew the channel: the replacement is started before the old channel is stopped, and the old channel's notifications are then ignored */
+	old_id = id;
+
+	g_assert (gdata_watch_channel_start (channel, 0, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert (gdata_watch_channel_is_active (channel) == TRUE);
+	g_assert_cmpint (gdata_watch_channel_get_expiration (channel), ==, G_GINT64_CONSTANT (1792080000000));
+
+	id = gdata_watch_channel_dup_id (channel);
+	g_assert (id != NULL);
+	g_assert_cmpstr (id, !=, old_id);
+
+	g_assert_cmpint (send_watch_notification (channel, old_id, "secret", "exists", "4"), ==, GDATA_WATCH_NOTIFICATION_IGNORED);
+	g_assert_cmpint (send_watch_notification (channel, id, "secret", "sync", "1"), ==, GDATA_WATCH_NOTIFICATION_SYNC);
+	g_assert_cmpint (send_watch_notification (channel, id, "secret", "exists", "2"), ==, GDATA_WATCH_NOTIFICATION_CHANGED);
+
+	g_assert_cmpstr (notifications->str, ==, "changed,removed,changed");
+
+	/* Stop the channel */
+	g_assert (gdata_watch_channel_stop (channel, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert (gdata_watch_channel_is_active (channel) == FALSE);
+	g_assert (gdata_watch_channel_dup_id (channel) == NULL);
+	g_assert_cmpint (gdata_watch_channel_get_expiration (channel), ==, -1);
+	g_assert_cmpint (send_watch_notification (channel, id, "secret", "exists", "3"), ==, GDATA_WATCH_NOTIFICATION_IGNORED);
+
+	uhm_server_end_trace (mock_server);
+
+	/* Check what was sent: the TTL is only given when requested, and each stop request names the channel it's stopping */
+	g_assert_cmpuint (request_log_get_length (log), ==, 4);
+
+	expected_json = g_strdup_printf ("{\"id\":\"%s\",\"type\":\"web_hook\",\"address\":\"https://example.org/notify\",\"token\":\"secret\","
+	                                 "\"params\":{\"ttl\":\"3600\"}}", old_id);
+	assert_watch_channel_request (log, 0, "/feeds/general/watch", expected_json);
+	g_free (expected_json);
+
+	expected_json = g_strdup_printf ("{\"id\":\"%s\",\"type\":\"web_hook\",\"address\":\"https://example.org/notify\",\"token\":\"secret\"}",
+	                                 id);
+	assert_watch_channel_request (log, 1, "/feeds/general/watch", expected_json);
+	g_free (expected_json);
+
+	expected_json = g_strdup_printf ("{\"id\":\"%s\",\"resourceId\":\"resource-1\"}", old_id);
+	assert_watch_channel_request (log, 2, "/feeds/general/stop", expected_json);
+	g_free (expected_json);
+
+	expected_json = g_strdup_printf ("{\"id\":\"%s\",\"resourceId\":\"resource-1\"}", id);
+	assert_watch_channel_request (log, 3, "/feeds/general/stop", expected_json);
+	g_free (expected_json);
+
+	request_log_stop (log);
+
+	g_free (old_id);
+	g_free (id);
+	g_string_free (notifications, TRUE);
+	g_object_unref (channel);
+	g_object_unref (service);
+}
+
+static void
+dummy_poll_cb (GDataPollScheduler *scheduler, const gchar *feed_uri, GDataQuery *query, gpointer user_data)
+{
+	g_assert_not_reached ();
+}
+
+static void
+test_poll_scheduler (void)
+{
+	GDataService *service;
+	GDataPollScheduler *scheduler;
+	GDataQuery *query;
+	guint feed1, feed2, max_interval;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	scheduler = gdata_poll_scheduler_new (service);
+
+	g_assert (gdata_poll_scheduler_get_service (scheduler) == service);
+	g_assert_cmpuint (gdata_poll_scheduler_get_min_interval (scheduler), ==, 5 * 60);
+	g_assert_cmpuint (gdata_poll_scheduler_get_max_interval (scheduler), ==, 24 * 60 * 60);
+
+	gdata_poll_scheduler_set_min_interval (scheduler, 60);
+	g_object_set (scheduler, "max-interval", 3600, NULL);
+	g_object_get (scheduler, "max-interval", &max_interval, NULL);
+	g_assert_cmpuint (gdata_poll_scheduler_get_min_interval (scheduler), ==, 60);
+	g_assert_cmpuint (max_interval, ==, 3600);
+
+	/* New feeds start at the minimum interval; nothing's polled until the main loop runs */
+	query = gdata_query_new ("test");
+	feed1 = gdata_poll_scheduler_add_feed (scheduler, "http://example.com/feed", NULL, dummy_poll_cb, NULL, NULL);
+	feed2 = gdata_poll_scheduler_add_feed (scheduler, "http://example.com/feed", query, dummy_poll_cb, NULL, NULL);
+	g_assert_cmpuint (feed1, !=, 0);
+	g_assert_cmpuint (feed2, !=, feed1);
+	g_assert_cmpuint (gdata_poll_scheduler_get_interval (scheduler, feed1), ==, 60);
+	g_assert_cmpuint (gdata_poll_scheduler_get_interval (scheduler, feed2), ==, 60);
+
+	gdata_poll_scheduler_remove_feed (scheduler, feed1);
+	g_assert_cmpuint (gdata_poll_scheduler_get_interval (scheduler, feed1), ==, 0);
+
+	/* The remaining feed is removed when the scheduler's destroyed */
+	g_object_unref (query);
+	g_object_unref (scheduler);
+	g_object_unref (service);
+}
+
+static void
+test_write_queue_coalescing (void)
+{
+	GDataService *service;
+	GDataWriteQueue *queue;
+	GDataEntry *new_entry, *entry, *entry2;
+	GError *error = NULL;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	queue = gdata_write_queue_new (service, NULL, "http://example.com/feed", NULL);
+
+	g_assert (gdata_write_queue_get_service (queue) == service);
+	g_assert_cmpstr (gdata_write_queue_get_upload_uri (queue), ==, "http://example.com/feed");
+	g_assert (gdata_write_queue_get_batch_feed_uri (queue) == NULL);
+	g_assert_cmpuint (gdata_write_queue_get_flush_delay (queue), ==, 0);
+	g_assert (gdata_write_queue_get_online (queue) == TRUE);
+
+	/* Flushing an empty queue doesn't touch the network */
+	g_assert (gdata_write_queue_flush (queue, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	/* An insertion absorbs later updates, and cancels out with a later deletion */
+	new_entry = gdata_entry_new (NULL);
+	gdata_write_queue_add_insertion (queue, new_entry);
+	gdata_write_queue_add_update (queue, new_entry);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (queue), ==, 1);
+	gdata_write_queue_add_deletion (queue, new_entry);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (queue), ==, 0);
+
+	/* Updates of the same entry (matched by ID) are coalesced, and replaced by a deletion */
+	entry = gdata_entry_new ("http://example.com/id");
+	entry2 = gdata_entry_new ("http://example.com/id");
+	gdata_write_queue_add_update (queue, entry);
+	gdata_write_queue_add_update (queue, entry2);
+	gdata_write_queue_add_update (queue, entry);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (queue), ==, 1);
+	gdata_write_queue_add_deletion (queue, entry2);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (queue), ==, 1);
+
+	/* Writes of other entries are kept separate */
+	gdata_write_queue_add_insertion (queue, new_entry);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (queue), ==, 2);
+
+	/* Pending writes are dropped with the queue */
+	g_object_unref (entry2);
+	g_object_unref (entry);
+	g_object_unref (new_entry);
+	g_object_unref (queue);
+	g_object_unref (service);
+}
+
+static void
+test_service_rate_limit (void)
+{
+	GDataService *service;
+	GDataAuthorizationDomain *domain;
+	guint burst;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	domain = g_object_new (GDATA_TYPE_AUTHORIZATION_DOMAIN, "service-name", "test", "scope", "http://example.com/", NULL);
+
+	/* There are no limits by default */
+	g_assert_cmpfloat (gdata_service_get_rate_limit (service, NULL, &burst), ==, 0.0);
+	g_assert_cmpuint (burst, ==, 1);
+	g_assert_cmpfloat (gdata_service_get_rate_limit (service, domain, &burst), ==, 0.0);
+	g_assert_cmpuint (burst, ==, 1);
+
+	/* Service-wide and per-domain limits are independent */
+	gdata_service_set_rate_limit (service, NULL, 10.0, 5);
+	gdata_service_set_rate_limit (service, domain, 2.5, 0);
+
+	g_assert_cmpfloat (gdata_service_get_rate_limit (service, NULL, &burst), ==, 10.0);
+	g_assert_cmpuint (burst, ==, 5);
+	g_assert_cmpfloat (gdata_service_get_rate_limit (service, domain, &burst), ==, 2.5);
+	g_assert_cmpuint (burst, ==, 1); /* bursts are always at least one request */
+
+	/* Limits can be removed again */
+	gdata_service_set_rate_limit (service, domain, 0.0, 1);
+	g_assert_cmpfloat (gdata_service_get_rate_limit (service, domain, NULL), ==, 0.0);
+
+	g_object_unref (domain);
+	g_object_unref (service);
+}
+
+static void
+test_service_rate_limit_scheduling (void)
+{
+	GDataService *service;
+	GDataFeed *feed;
+	RequestLog *log;
+	gint64 start_time;
+	guint i;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	gdata_service_set_rate_limit (service, NULL, 10.0, 1);
+	log = request_log_start ();
+
+	gdata_test_mock_server_start_trace (mock_server, "rate-limit");
+	start_time = g_get_monotonic_time ();
+
+	/* The first query is throttled with a 503, which is queued and sent again once the limiter's paused, rather than returned as an error.
+	 * The others just wait their turn. */
+	for (i = 0; i < 3; i++) {
+		feed = gdata_service_query (service, NULL, "https://www.google.com/feeds/general/rate-limit", NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL,
+		                            &error);
+		g_assert_no_error (error);
+		g_assert (GDATA_IS_FEED (feed));
+		g_assert_cmpuint (g_list_length (gdata_feed_get_entries (feed)), ==, 1);
+		g_object_unref (feed);
+	}
+
+	/* All four requests were spaced at no more than ten a second, so took at least three intervals between them */
+	g_assert_cmpint (g_get_monotonic_time () - start_time, >=, 3 * G_USEC_PER_SEC / 10);
+
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 4);
+
+	request_log_stop (log);
+	g_object_unref (service);
+}
+
+static void
+test_service_retry_policy (void)
+{
+	GDataService *service;
+	guint max_retries, retry_delay;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Retries are disabled by default */
+	g_assert_cmpuint (gdata_service_get_max_retries (service), ==, 0);
+	g_assert_cmpuint (gdata_service_get_retry_delay (service), ==, 500);
+
+	gdata_service_set_max_retries (service, 3);
+	gdata_service_set_retry_delay (service, 250);
+
+	g_assert_cmpuint (gdata_service_get_max_retries (service), ==, 3);
+	g_assert_cmpuint (gdata_service_get_retry_delay (service), ==, 250);
+
+	g_object_set (service, "max-retries", 5, "retry-delay", 1000, NULL);
+	g_object_get (service, "max-retries", &max_retries, "retry-delay", &retry_delay, NULL);
+
+	g_assert_cmpuint (max_retries, ==, 5);
+	g_assert_cmpuint (retry_delay, ==, 1000);
+
+	g_object_unref (service);
+}
+
+static void
+retry_request_completed_cb (GDataService *service, GDataRequestRecord *record, GDataRequestRecord **record_out)
+{
+	g_assert (*record_out == NULL);
+	*record_out = gdata_request_record_copy (record);
+}
+
+static void
+test_service_retry_transient_failures (void)
+{
+	GDataService *service;
+	GDataFeed *feed;
+	GDataEntry *entry, *inserted_entry;
+	GDataRequestRecord *record = NULL;
+	RequestLog *log;
+	gulong handler_id;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, "max-retries", 3, "retry-delay", 10, NULL);
+	handler_id = g_signal_connect (service, "request-completed", (GCallback) retry_request_completed_cb, &record);
+	log = request_log_start ();
+
+	gdata_test_mock_server_start_trace (mock_server, "retry");
+
+	/* The query fails with a 503 and then a 502 before succeeding; both failures are retried, and the retries are counted in the request's
+	 * record */
+	feed = gdata_service_query (service, NULL, "https://www.google.com/feeds/general/retry", NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (feed)), ==, 1);
+	g_object_unref (feed);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 3);
+	g_assert (record != NULL);
+	g_assert_cmpuint (record->status, ==, SOUP_STATUS_OK);
+	g_assert_cmpuint (record->retry_count, ==, 2);
+	g_clear_pointer (&record, gdata_request_record_free);
+
+	/* An unconditional insertion isn't idempotent, so its 503 is returned straight away */
+	entry = gdata_entry_new (NULL);
+	gdata_entry_set_title (entry, "Inserted entry");
+
+	inserted_entry = gdata_service_insert_entry (service, NULL, "https://www.google.com/feeds/general/retry", entry, NULL, &error);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (inserted_entry == NULL);
+	g_clear_error (&error);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 4);
+	g_assert (record != NULL);
+	g_assert_cmpuint (record->status, ==, SOUP_STATUS_SERVICE_UNAVAILABLE);
+	g_assert_cmpuint (record->retry_count, ==, 0);
+	g_clear_pointer (&record, gdata_request_record_free);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (entry);
+	request_log_stop (log);
+	g_signal_handler_disconnect (service, handler_id);
+	g_object_unref (service);
+}
+
+static gboolean
+truncated_body_disconnect_cb (SoupSocket *socket)
+{
+	soup_socket_disconnect (socket);
+	return FALSE;
+}
+
+static gboolean
+truncated_body_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, volatile gint *n_requests)
+{
+	const gchar *response_body =
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<feed xmlns='http://www.w3.org/2005/Atom'>"
+			"<id>https://www.google.com/feeds/general/truncated</id>"
+			"<updated>2026-10-15T09:00:00.000Z</updated>"
+			"<title type='text'>Truncated feed</title>"
+			"<entry>"
+				"<id>https://www.google.com/feeds/general/truncated/1</id>"
+				"<updated>2026-10-15T09:00:00.000Z</updated>"
+				"<title type='text'>Entry</title>"
+			"</entry>"
+		"</feed>";
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_headers_set_content_type (message->response_headers, "application/atom+xml", NULL);
+
+	if (g_atomic_int_add (n_requests, 1) == 0) {
+		GSource *source;
+
+		/* Send the headers and the first half of the body, then drop the connection while the message is paused waiting for the rest */
+		soup_message_headers_set_encoding (message->response_headers, SOUP_ENCODING_CHUNKED);
+		soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, response_body, strlen (response_body) / 2);
+
+		source = g_timeout_source_new (100);
+		g_source_set_callback (source, (GSourceFunc) truncated_body_disconnect_cb, g_object_ref (soup_client_context_get_socket (client)),
+		                       g_object_unref);
+		g_source_attach (source, g_main_context_get_thread_default ());
+		g_source_unref (source);
+	} else {
+		soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_STATIC, response_body, strlen (response_body));
+	}
+
+	return TRUE;
+}
+
+static void
+test_service_retry_truncated_body (void)
+{
+	GDataService *service;
+	GDataFeed *feed;
+	RequestLog *log;
+	volatile gint n_requests = 0;
+	gulong handler_id;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, "max-retries", 3, "retry-delay", 10, NULL);
+
+	log = request_log_start ();
+	handler_id = g_signal_connect (mock_server, "handle-message", (GCallback) truncated_body_handle_message_cb, (gpointer) &n_requests);
+	uhm_server_run (mock_server);
+	gdata_test_set_https_port (mock_server);
+
+	/* The connection drops part-way through the streamed response body. Half of it has already been parsed, so the query fails with the
+	 * network error rather than being retried and having the second response appended to the first. */
+	feed = gdata_service_query (service, NULL, "https://www.google.com/feeds/general/truncated", NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL,
+	                            &error);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NETWORK_ERROR);
+	g_assert (feed == NULL);
+	g_clear_error (&error);
+
+	g_assert_cmpint (g_atomic_int_get (&n_requests), ==, 1);
+	g_assert_cmpuint (request_log_get_length (log), ==, 1);
+
+	/* Querying again starts afresh */
+	feed = gdata_service_query (service, NULL, "https://www.google.com/feeds/general/truncated", NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL,
+	                            &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (feed)), ==, 1);
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (gdata_feed_get_entries (feed)->data)), ==, "Entry");
+	g_object_unref (feed);
+
+	g_assert_cmpint (g_atomic_int_get (&n_requests), ==, 2);
+
+	uhm_server_stop (mock_server);
+	g_signal_handler_disconnect (mock_server, handler_id);
+
+	request_log_stop (log);
+	g_object_unref (service);
+}
+
+static gboolean
+async_retry_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, volatile gint *n_requests)
+{
+	switch (g_atomic_int_add (n_requests, 1)) {
+		case 0:
+			soup_message_set_status (message, SOUP_STATUS_SERVICE_UNAVAILABLE);
+			break;
+		case 1:
+			/* The redirection is only followed correctly (on the mock server's port) if it's handled by the service rather than libsoup */
+			soup_message_set_status (message, SOUP_STATUS_FOUND);
+			soup_message_headers_replace (message->response_headers, "Location", "https://www.google.com/feeds/general/entries/moved");
+			break;
+		default:
+			soup_message_set_status (message, SOUP_STATUS_NO_CONTENT);
+			break;
+	}
+
+	return TRUE;
+}
+
+static void
+test_service_retry_async_resend (void)
+{
+	GDataService *service;
+	GDataEntry *entry;
+	GAsyncResult *async_result = NULL;
+	RequestLog *log;
+	volatile gint n_requests = 0;
+	gulong handler_id;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	/* With no delay, the retry is queued from an idle source rather than straight from the failed message's callback */
+	service = g_object_new (GDATA_TYPE_SERVICE, "max-retries", 3, "retry-delay", 0, NULL);
+
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY, original_xml_entry, -1, &error));
+	g_assert_no_error (error);
+
+	log = request_log_start ();
+	handler_id = g_signal_connect (mock_server, "handle-message", (GCallback) async_retry_handle_message_cb, (gpointer) &n_requests);
+	uhm_server_run (mock_server);
+	gdata_test_set_https_port (mock_server);
+
+	/* The conditional deletion fails with a 503, and its retry is redirected; the redirection is followed even though the first attempt
+	 * had no redirection to follow */
+	gdata_service_delete_entry_async (service, NULL, entry, NULL, (GAsyncReadyCallback) async_ready_cb, &async_result);
+	g_assert (gdata_service_delete_entry_finish (service, wait_for_async_result (&async_result), &error) == TRUE);
+	g_assert_no_error (error);
+	g_object_unref (async_result);
+
+	uhm_server_stop (mock_server);
+	g_signal_handler_disconnect (mock_server, handler_id);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 3);
+	g_assert_cmpstr (request_log_get (log, 0)->path_and_query, ==, "/feeds/general/entries/1");
+	g_assert_cmpstr (request_log_get (log, 1)->path_and_query, ==, "/feeds/general/entries/1");
+	g_assert_cmpstr (request_log_get (log, 2)->method, ==, "DELETE");
+	g_assert_cmpstr (request_log_get (log, 2)->path_and_query, ==, "/feeds/general/entries/moved");
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 2)->headers, "If-Match"), ==, "\"E1\"");
+
+	request_log_stop (log);
+	g_object_unref (entry);
+	g_object_unref (service);
+}
+
+static void
+test_service_bandwidth_limits (void)
+{
+	GDataService *service;
+	GDataDownloadStream *stream;
+	guint upload_limit, download_limit;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Bandwidth isn't limited by default */
+	g_assert_cmpuint (gdata_service_get_upload_bandwidth_limit (service), ==, 0);
+	g_assert_cmpuint (gdata_service_get_download_bandwidth_limit (service), ==, 0);
+
+	gdata_service_set_upload_bandwidth_limit (service, 64 * 1024);
+	gdata_service_set_download_bandwidth_limit (service, 128 * 1024);
+
+	g_assert_cmpuint (gdata_service_get_upload_bandwidth_limit (service), ==, 64 * 1024);
+	g_assert_cmpuint (gdata_service_get_download_bandwidth_limit (service), ==, 128 * 1024);
+
+	g_object_set (service, "upload-bandwidth-limit", 0, "download-bandwidth-limit", 1000, NULL);
+	g_object_get (service, "upload-bandwidth-limit", &upload_limit, "download-bandwidth-limit", &download_limit, NULL);
+
+	g_assert_cmpuint (upload_limit, ==, 0);
+	g_assert_cmpuint (download_limit, ==, 1000);
+
+	/* Streams have their own limits on top of the service's */
+	stream = GDATA_DOWNLOAD_STREAM (gdata_download_stream_new (service, NULL, "http://example.com/", NULL));
+	g_assert_cmpuint (gdata_download_stream_get_bandwidth_limit (stream), ==, 0);
+
+	gdata_download_stream_set_bandwidth_limit (stream, 512);
+	g_assert_cmpuint (gdata_download_stream_get_bandwidth_limit (stream), ==, 512);
+	g_assert_cmpuint (gdata_service_get_download_bandwidth_limit (service), ==, 1000);
+
+	g_object_unref (stream);
+	g_object_unref (service);
+}
+
+static void
+test_service_minimal_responses (void)
+{
+	GDataService *service;
+	gboolean minimal_responses;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Full responses are parsed by default */
+	g_assert (gdata_service_get_minimal_responses (service) == FALSE);
+
+	gdata_service_set_minimal_responses (service, TRUE);
+	g_assert (gdata_service_get_minimal_responses (service) == TRUE);
+
+	g_object_set (service, "minimal-responses", FALSE, NULL);
+	g_object_get (service, "minimal-responses", &minimal_responses, NULL);
+	g_assert (minimal_responses == FALSE);
+
+	g_object_unref (service);
+}
+
+static void
+test_service_minimal_responses_upload (void)
+{
+	GDataService *service;
+	GDataEntry *entry, *inserted_entry, *updated_entry;
+	GDataLink *_link;
+	RequestLog *log;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, "minimal-responses", TRUE, NULL);
+	log = request_log_start ();
+
+	gdata_test_mock_server_start_trace (mock_server, "minimal-responses");
+
+	/* The server ignores the request for a minimal response to the insertion and sends the whole entry back, but only its identity is
+	 * picked out of it */
+	entry = gdata_entry_new (NULL);
+	gdata_entry_set_title (entry, "Inserted entry");
+
+	inserted_entry = gdata_service_insert_entry (service, NULL, "https://www.google.com/feeds/general/minimal", entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (inserted_entry));
+	g_assert (inserted_entry != entry);
+
+	g_assert_cmpstr (gdata_entry_get_id (inserted_entry), ==, "https://www.google.com/feeds/general/minimal/1");
+	g_assert_cmpstr (gdata_entry_get_etag (inserted_entry), ==, "W/\"1\"");
+	_link = gdata_entry_look_up_link (inserted_entry, GDATA_LINK_EDIT);
+	g_assert (_link != NULL);
+	g_assert_cmpstr (gdata_link_get_uri (_link), ==, "https://www.google.com/feeds/general/minimal/1");
+	g_assert (gdata_entry_get_title (inserted_entry) == NULL);
+	g_assert (gdata_entry_get_content (inserted_entry) == NULL);
+
+	/* This time the server honours it, and just sends the new ETag in a header */
+	gdata_entry_set_title (inserted_entry, "Updated entry");
+
+	updated_entry = gdata_service_update_entry (service, NULL, inserted_entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (updated_entry));
+
+	g_assert_cmpstr (gdata_entry_get_id (updated_entry), ==, "https://www.google.com/feeds/general/minimal/1");
+	g_assert_cmpstr (gdata_entry_get_etag (updated_entry), ==, "W/\"2\"");
+	_link = gdata_entry_look_up_link (updated_entry, GDATA_LINK_EDIT);
+	g_assert (_link != NULL);
+	g_assert_cmpstr (gdata_link_get_uri (_link), ==, "https://www.google.com/feeds/general/minimal/1");
+	g_assert (gdata_entry_get_title (updated_entry) == NULL);
+
+	uhm_server_end_trace (mock_server);
+
+	/* Both requests asked for a minimal response */
+	g_assert_cmpuint (request_log_get_length (log), ==, 2);
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 0)->headers, "Prefer"), ==, "return=minimal");
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 1)->headers, "Prefer"), ==, "return=minimal");
+
+	request_log_stop (log);
+	g_object_unref (updated_entry);
+	g_object_unref (inserted_entry);
+	g_object_unref (entry);
+	g_object_unref (service);
+}
+
+static void
+test_service_update_entries_in_place (void)
+{
+	GDataService *service;
+	gboolean update_entries_in_place;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* New entries are returned by default */
+	g_assert (gdata_service_get_update_entries_in_place (service) == FALSE);
+
+	gdata_service_set_update_entries_in_place (service, TRUE);
+	g_assert (gdata_service_get_update_entries_in_place (service) == TRUE);
+
+	g_object_set (service, "update-entries-in-place", FALSE, NULL);
+	g_object_get (service, "update-entries-in-place", &update_entries_in_place, NULL);
+	g_assert (update_entries_in_place == FALSE);
+
+	g_object_unref (service);
+}
+
+static void
+record_notify_cb (GObject *object, GParamSpec *pspec, GPtrArray *notifications)
+{
+	g_ptr_array_add (notifications, g_strdup (pspec->name));
+}
+
+static gboolean
+was_notified (GPtrArray *notifications, const gchar *property_name)
+{
+	guint i;
+
+	for (i = 0; i < notifications->len; i++) {
+		if (strcmp (g_ptr_array_index (notifications, i), property_name) == 0)
+			return TRUE;
+	}
+
+	return FALSE;
+}
+
+static void
+test_service_update_entries_in_place_upload (void)
+{
+	GDataService *service;
+	GDataEntry *entry, *returned_entry;
+	GDataLink *_link;
+	GPtrArray *notifications;
+	gint64 updated;
+	gulong handler_id;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, "update-entries-in-place", TRUE, NULL);
+
+	entry = gdata_entry_new (NULL);
+	gdata_entry_set_title (entry, "Inserted entry");
+
+	notifications = g_ptr_array_new_with_free_func (g_free);
+	handler_id = g_signal_connect (entry, "notify", (GCallback) record_notify_cb, notifications);
+
+	gdata_test_mock_server_start_trace (mock_server, "update-entries-in-place");
+
+	/* The inserted entry is the one which was uploaded, now with the server-assigned fields filled in */
+	returned_entry = gdata_service_insert_entry (service, NULL, "https://www.google.com/feeds/general/in-place", entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (returned_entry == entry);
+	g_object_unref (returned_entry);
+
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, "https://www.google.com/feeds/general/in-place/1");
+	g_assert_cmpstr (gdata_entry_get_etag (entry), ==, "W/\"1\"");
+	g_assert_cmpstr (gdata_entry_get_content (entry), ==, "Server-side content");
+	_link = gdata_entry_look_up_link (entry, GDATA_LINK_EDIT);
+	g_assert (_link != NULL);
+	g_assert_cmpstr (gdata_link_get_uri (_link), ==, "https://www.google.com/feeds/general/in-place/1");
+	g_assert (gdata_entry_is_dirty (entry) == FALSE);
+
+	g_assert (was_notified (notifications, "etag") == TRUE);
+	g_assert (was_notified (notifications, "content") == TRUE);
+	g_assert (was_notified (notifications, "title") == FALSE);
+
+	updated = gdata_entry_get_updated (entry);
+
+	/* Updating it again only notifies the properties the server changed; the title is the one which was sent, so hasn't changed */
+	gdata_entry_set_title (entry, "Updated entry");
+	g_ptr_array_set_size (notifications, 0);
+
+	returned_entry = gdata_service_update_entry (service, NULL, entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (returned_entry == entry);
+	g_object_unref (returned_entry);
+
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "Updated entry");
+	g_assert_cmpstr (gdata_entry_get_etag (entry), ==, "W/\"2\"");
+	g_assert_cmpint (gdata_entry_get_updated (entry), >, updated);
+	g_assert (gdata_entry_is_dirty (entry) == FALSE);
+
+	g_assert (was_notified (notifications, "etag") == TRUE);
+	g_assert (was_notified (notifications, "updated") == TRUE);
+	g_assert (was_notified (notifications, "title") == FALSE);
+	g_assert (was_notified (notifications, "content") == FALSE);
+	g_assert (was_notified (notifications, "id") == FALSE);
+
+	uhm_server_end_trace (mock_server);
+
+	g_signal_handler_disconnect (entry, handler_id);
+	g_ptr_array_unref (notifications);
+	g_object_unref (entry);
+	g_object_unref (service);
+}
+
+static gchar *
+dup_logged_request_body (const LoggedRequest *request)
+{
+	return g_strndup (g_bytes_get_data (request->body, NULL), g_bytes_get_size (request->body));
+}
+
+static void
+test_service_patch_entry (void)
+{
+	GDataService *service;
+	GDataEntry *entry, *updated_entry;
+	GDataTasksTask *task, *updated_task;
+	GAsyncResult *async_result = NULL;
+	const LoggedRequest *request;
+	RequestLog *log;
+	gchar *body;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	log = request_log_start ();
+
+	gdata_test_mock_server_start_trace (mock_server, "patch-entry");
+
+	/* An entry which hasn't been modified since it was parsed isn't sent at all, either synchronously or asynchronously */
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;P1&quot;'>"
+			"<id>urn:entry:patch:1</id>"
+			"<updated>2026-10-14T10:00:00.000Z</updated>"
+			"<title type='text'>Old title</title>"
+			"<content type='text'>Unchanged content</content>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/patch/1'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+
+	updated_entry = gdata_service_patch_entry (service, NULL, entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (updated_entry == entry);
+	g_object_unref (updated_entry);
+
+	gdata_service_patch_entry_async (service, NULL, entry, NULL, (GAsyncReadyCallback) async_ready_cb, &async_result);
+	updated_entry = gdata_service_patch_entry_finish (service, wait_for_async_result (&async_result), &error);
+	g_assert_no_error (error);
+	g_assert (updated_entry == entry);
+	g_object_unref (updated_entry);
+	g_clear_object (&async_result);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 0);
+
+	/* Only the modified title and summary are sent, as a PATCH tunnelled through a conditional POST, with gd:fields listing them in the order
+	 * they were modified */
+	gdata_entry_set_title (entry, "New title");
+	gdata_entry_set_summary (entry, "New summary");
+
+	updated_entry = gdata_service_patch_entry (service, NULL, entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (updated_entry));
+	g_assert_cmpstr (gdata_entry_get_title (updated_entry), ==, "New title");
+	g_assert_cmpstr (gdata_entry_get_etag (updated_entry), ==, "\"P2\"");
+	g_object_unref (updated_entry);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 1);
+	request = request_log_get (log, 0);
+	g_assert_cmpstr (request->method, ==, "POST");
+	g_assert_cmpstr (request->path_and_query, ==, "/feeds/general/patch/1");
+	g_assert_cmpstr (soup_message_headers_get_one (request->headers, "X-HTTP-Method-Override"), ==, "PATCH");
+	g_assert_cmpstr (soup_message_headers_get_one (request->headers, "If-Match"), ==, "\"P1\"");
+	g_assert_cmpstr (soup_message_headers_get_content_type (request->headers, NULL), ==, "application/atom+xml");
+
+	body = dup_logged_request_body (request);
+	g_assert (g_str_has_prefix (body, "<?xml version='1.0' encoding='UTF-8'?><entry ") == TRUE);
+	g_assert (strstr (body, " gd:fields='title,summary'>") != NULL);
+	g_assert (strstr (body, "<title type='text'>New title</title>") != NULL);
+	g_assert (strstr (body, "<summary type='text'>New summary</summary>") != NULL);
+	g_assert (strstr (body, "<id>") == NULL);
+	g_assert (strstr (body, "<content") == NULL);
+	g_assert (strstr (body, "<link") == NULL);
+	g_assert (g_str_has_suffix (body, "</entry>") == TRUE);
+	g_free (body);
+
+	g_object_unref (entry);
+
+	/* Preserved unhandled XML containing a comment can't be filtered safely, so the entry is updated in full with a PUT instead */
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;F1&quot;'>"
+			"<id>urn:entry:patch:2</id>"
+			"<updated>2026-10-14T10:00:00.000Z</updated>"
+			"<title type='text'>Old title</title>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/patch/2'/>"
+			"<ext:data xmlns:ext='http://example.com/ext'><!-- Not to be parsed as markup --></ext:data>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+
+	gdata_entry_set_title (entry, "Updated in full");
+
+	updated_entry = gdata_service_patch_entry (service, NULL, entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (updated_entry));
+	g_assert_cmpstr (gdata_entry_get_title (updated_entry), ==, "Updated in full");
+	g_object_unref (updated_entry);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 2);
+	request = request_log_get (log, 1);
+	g_assert_cmpstr (request->method, ==, "PUT");
+	g_assert_cmpstr (request->path_and_query, ==, "/feeds/general/patch/2");
+	g_assert (soup_message_headers_get_one (request->headers, "X-HTTP-Method-Override") == NULL);
+	g_assert_cmpstr (soup_message_headers_get_one (request->headers, "If-Match"), ==, "\"F1\"");
+
+	body = dup_logged_request_body (request);
+	g_assert (strstr (body, "gd:fields") == NULL);
+	g_assert (strstr (body, "<id>urn:entry:patch:2</id>") != NULL);
+	g_assert (strstr (body, "<!-- Not to be parsed as markup -->") != NULL);
+	g_free (body);
+
+	g_object_unref (entry);
+
+	/* A JSON entry's patch is a JSON object with only the modified members, and the ones which have been unset are sent as null */
+	task = GDATA_TASKS_TASK (gdata_parsable_new_from_json (GDATA_TYPE_TASKS_TASK,
+		"{"
+			"\"kind\": \"tasks#task\","
+			"\"id\": \"t1\","
+			"\"etag\": \"\\\"T1\\\"\","
+			"\"title\": \"Buy milk\","
+			"\"status\": \"needsAction\","
+			"\"due\": \"2026-10-20T00:00:00.000Z\","
+			"\"selfLink\": \"https://www.google.com/tasks/v1/lists/list-a/tasks/t1\""
+		"}", -1, &error));
+	g_assert_no_error (error);
+
+	gdata_tasks_task_set_notes (task, "Semi-skimmed");
+	gdata_tasks_task_set_due (task, -1);
+
+	updated_task = GDATA_TASKS_TASK (gdata_service_patch_entry (service, NULL, GDATA_ENTRY (task), NULL, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_TASKS_TASK (updated_task));
+	g_assert_cmpstr (gdata_tasks_task_get_notes (updated_task), ==, "Semi-skimmed");
+	g_object_unref (updated_task);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 3);
+	request = request_log_get (log, 2);
+	g_assert_cmpstr (request->method, ==, "POST");
+	g_assert_cmpstr (request->path_and_query, ==, "/tasks/v1/lists/list-a/tasks/t1");
+	g_assert_cmpstr (soup_message_headers_get_one (request->headers, "X-HTTP-Method-Override"), ==, "PATCH");
+	g_assert_cmpstr (soup_message_headers_get_one (request->headers, "If-Match"), ==, "\"T1\"");
+	g_assert_cmpstr (soup_message_headers_get_content_type (request->headers, NULL), ==, "application/json");
+
+	body = dup_logged_request_body (request);
+	g_assert (gdata_test_compare_json_strings (body, "{\"notes\": \"Semi-skimmed\", \"due\": null}", TRUE) == TRUE);
+	g_free (body);
+
+	g_object_unref (task);
+
+	uhm_server_end_trace (mock_server);
+
+	request_log_stop (log);
+	g_object_unref (service);
+}
+
+typedef struct {
+	GDataBatchOperationType type;
+	GDataEntry *entry;
+	GDataEntry *server_entry;
+	GError *error;
+} FinishedWrite;
+
+static void
+finished_write_free (FinishedWrite *write)
+{
+	g_object_unref (write->entry);
+	if (write->server_entry != NULL)
+		g_object_unref (write->server_entry);
+	g_clear_error (&(write->error));
+	g_slice_free (FinishedWrite, write);
+}
+
+static void
+write_finished_cb (GDataWriteQueue *queue, GDataBatchOperationType type, GDataEntry *entry, GDataEntry *server_entry, GError *error,
+                   GPtrArray *finished)
+{
+	FinishedWrite *write;
+
+	write = g_slice_new (FinishedWrite);
+	write->type = type;
+	write->entry = g_object_ref (entry);
+	write->server_entry = (server_entry != NULL) ? g_object_ref (server_entry) : NULL;
+	write->error = (error != NULL) ? g_error_copy (error) : NULL;
+
+	g_ptr_array_add (finished, write);
+}
+
+static void
+test_write_queue_flush (void)
+{
+	GDataService *service;
+	GDataContactsService *contacts_service;
+	GDataWriteQueue *queue;
+	GDataEntry *new_entry, *updated_entry, *deleted_entry;
+	GPtrArray *finished;
+	FinishedWrite *write;
+	RequestLog *log;
+	gchar *body;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	log = request_log_start ();
+	finished = g_ptr_array_new_with_free_func ((GDestroyNotify) finished_write_free);
+
+	gdata_test_mock_server_start_trace (mock_server, "write-queue-flush");
+
+	/* A plain service isn't batchable, so each write is sent as a separate request, in the order they were queued. A write which fails
+	 * permanently is reported, but doesn't stop the others or fail the flush. */
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	queue = gdata_write_queue_new (service, NULL, "https://www.google.com/feeds/general/write-queue", NULL);
+	g_signal_connect (queue, "write-finished", (GCallback) write_finished_cb, finished);
+
+	new_entry = gdata_entry_new (NULL);
+	gdata_entry_set_title (new_entry, "Inserted");
+
+	updated_entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;U1&quot;'>"
+			"<id>https://www.google.com/feeds/general/write-queue/2</id>"
+			"<updated>2026-10-14T10:00:00.000Z</updated>"
+			"<title type='text'>Updated</title>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/write-queue/2'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+
+	deleted_entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;D1&quot;'>"
+			"<id>https://www.google.com/feeds/general/write-queue/3</id>"
+			"<updated>2026-10-14T10:00:00.000Z</updated>"
+			"<title type='text'>Deleted</title>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/write-queue/3'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+
+	gdata_write_queue_add_insertion (queue, new_entry);
+	gdata_write_queue_add_update (queue, updated_entry);
+	gdata_write_queue_add_deletion (queue, deleted_entry);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (queue), ==, 3);
+
+	g_assert (gdata_write_queue_flush (queue, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (queue), ==, 0);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 3);
+	g_assert_cmpstr (request_log_get (log, 0)->method, ==, "POST");
+	g_assert_cmpstr (request_log_get (log, 0)->path_and_query, ==, "/feeds/general/write-queue");
+	g_assert_cmpstr (request_log_get (log, 1)->method, ==, "PUT");
+	g_assert_cmpstr (request_log_get (log, 1)->path_and_query, ==, "/feeds/general/write-queue/2");
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 1)->headers, "If-Match"), ==, "\"U1\"");
+	g_assert_cmpstr (request_log_get (log, 2)->method, ==, "DELETE");
+	g_assert_cmpstr (request_log_get (log, 2)->path_and_query, ==, "/feeds/general/write-queue/3");
+
+	g_assert_cmpuint (finished->len, ==, 3);
+
+	write = g_ptr_array_index (finished, 0);
+	g_assert_cmpint (write->type, ==, GDATA_BATCH_OPERATION_INSERTION);
+	g_assert (write->entry == new_entry);
+	g_assert_no_error (write->error);
+	g_assert_cmpstr (gdata_entry_get_id (write->server_entry), ==, "https://www.google.com/feeds/general/write-queue/1");
+	g_assert_cmpstr (gdata_entry_get_etag (write->server_entry), ==, "\"I1\"");
+
+	write = g_ptr_array_index (finished, 1);
+	g_assert_cmpint (write->type, ==, GDATA_BATCH_OPERATION_UPDATE);
+	g_assert (write->entry == updated_entry);
+	g_assert_no_error (write->error);
+	g_assert_cmpstr (gdata_entry_get_etag (write->server_entry), ==, "\"U2\"");
+
+	write = g_ptr_array_index (finished, 2);
+	g_assert_cmpint (write->type, ==, GDATA_BATCH_OPERATION_DELETION);
+	g_assert (write->entry == deleted_entry);
+	g_assert (write->server_entry == NULL);
+	g_assert_error (write->error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+
+	g_ptr_array_set_size (finished, 0);
+	g_object_unref (deleted_entry);
+	g_object_unref (updated_entry);
+	g_object_unref (new_entry);
+	g_object_unref (queue);
+	g_object_unref (service);
+
+	/* With a batchable service and a batch feed URI, all the writes go in a single batch request, and each is reported with its own status */
+	contacts_service = gdata_contacts_service_new (NULL);
+	queue = gdata_write_queue_new (GDATA_SERVICE (contacts_service), gdata_contacts_service_get_primary_authorization_domain (),
+	                               "https://www.google.com/m8/feeds/contacts/default/full",
+	                               "https://www.google.com/m8/feeds/contacts/default/full/batch");
+	g_signal_connect (queue, "write-finished", (GCallback) write_finished_cb, finished);
+
+	new_entry = GDATA_ENTRY (gdata_contacts_contact_new (NULL));
+	gdata_entry_set_title (new_entry, "Fooish Bar");
+
+	updated_entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_CONTACTS_CONTACT,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;C11&quot;'>"
+			"<id>http://www.google.com/m8/feeds/contacts/default/base/11</id>"
+			"<updated>2026-10-14T10:00:00.000Z</updated>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>"
+			"<title>Updated contact</title>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/m8/feeds/contacts/default/full/11'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+
+	deleted_entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_CONTACTS_CONTACT,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;C12&quot;'>"
+			"<id>http://www.google.com/m8/feeds/contacts/default/base/12</id>"
+			"<updated>2026-10-14T10:00:00.000Z</updated>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>"
+			"<title>Deleted contact</title>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/m8/feeds/contacts/default/full/12'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+
+	gdata_write_queue_add_insertion (queue, new_entry);
+	gdata_write_queue_add_update (queue, updated_entry);
+	gdata_write_queue_add_deletion (queue, deleted_entry);
+
+	g_assert (gdata_write_queue_flush (queue, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (queue), ==, 0);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 4);
+	g_assert_cmpstr (request_log_get (log, 3)->method, ==, "POST");
+	g_assert_cmpstr (request_log_get (log, 3)->path_and_query, ==, "/m8/feeds/contacts/default/full/batch");
+
+	body = dup_logged_request_body (request_log_get (log, 3));
+	g_assert (strstr (body, "<batch:operation type='insert'/>") != NULL);
+	g_assert (strstr (body, "<batch:operation type='update'/>") != NULL);
+	g_assert (strstr (body, "<batch:operation type='delete'/>") != NULL);
+	g_assert (strstr (body, "Fooish Bar") != NULL);
+	g_free (body);
+
+	g_assert_cmpuint (finished->len, ==, 3);
+
+	write = g_ptr_array_index (finished, 0);
+	g_assert_cmpint (write->type, ==, GDATA_BATCH_OPERATION_INSERTION);
+	g_assert (write->entry == new_entry);
+	g_assert_no_error (write->error);
+	g_assert (GDATA_IS_CONTACTS_CONTACT (write->server_entry));
+	g_assert_cmpstr (gdata_entry_get_id (write->server_entry), ==, "http://www.google.com/m8/feeds/contacts/default/base/10");
+
+	/* There's no conflict resolver, so the conflict is reported as it is */
+	write = g_ptr_array_index (finished, 1);
+	g_assert_cmpint (write->type, ==, GDATA_BATCH_OPERATION_UPDATE);
+	g_assert (write->entry == updated_entry);
+	g_assert (write->server_entry == NULL);
+	g_assert_error (write->error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_CONFLICT);
+
+	write = g_ptr_array_index (finished, 2);
+	g_assert_cmpint (write->type, ==, GDATA_BATCH_OPERATION_DELETION);
+	g_assert (write->entry == deleted_entry);
+	g_assert (write->server_entry == NULL);
+	g_assert_no_error (write->error);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (deleted_entry);
+	g_object_unref (updated_entry);
+	g_object_unref (new_entry);
+	g_object_unref (queue);
+	g_object_unref (contacts_service);
+	g_ptr_array_unref (finished);
+	request_log_stop (log);
+}
+
+typedef struct {
+	GDataWriteQueue *queue;
+	GDataEntry *newer_entry;
+	volatile gint n_requests;
+} WriteQueueRequeueData;
+
+static gboolean
+write_queue_requeue_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, WriteQueueRequeueData *data)
+{
+	const gchar *response_body =
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;W2&quot;'>"
+			"<id>https://www.google.com/feeds/general/write-queue/6</id>"
+			"<updated>2026-10-15T10:00:00.000Z</updated>"
+			"<title type='text'>Second edit</title>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/write-queue/6'/>"
+		"</entry>";
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_headers_set_content_type (message->response_headers, "application/atom+xml", NULL);
+
+	if (g_atomic_int_add (&(data->n_requests), 1) == 0) {
+		GSource *source;
+
+		/* The entry's edited again while the first edit's being sent */
+		gdata_write_queue_add_update (data->queue, data->newer_entry);
+
+		/* Drop the connection part-way through the response, so that the write fails with a network error */
+		soup_message_headers_set_encoding (message->response_headers, SOUP_ENCODING_CHUNKED);
+		soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, response_body, strlen (response_body) / 2);
+
+		source = g_timeout_source_new (100);
+		g_source_set_callback (source, (GSourceFunc) truncated_body_disconnect_cb, g_object_ref (soup_client_context_get_socket (client)),
+		                       g_object_unref);
+		g_source_attach (source, g_main_context_get_thread_default ());
+		g_source_unref (source);
+	} else {
+		soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_STATIC, response_body, strlen (response_body));
+	}
+
+	return TRUE;
+}
+
+static void
+test_write_queue_requeue (void)
+{
+	GDataService *service;
+	GDataEntry *entry;
+	GPtrArray *finished;
+	FinishedWrite *write;
+	WriteQueueRequeueData data;
+	RequestLog *log;
+	gulong handler_id;
+	gchar *body;
+	GError *error = NULL;
+	const gchar *entry_xml =
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;W1&quot;'>"
+			"<id>https://www.google.com/feeds/general/write-queue/6</id>"
+			"<updated>2026-10-14T10:00:00.000Z</updated>"
+			"<title type='text'>Original</title>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/write-queue/6'/>"
+		"</entry>";
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	finished = g_ptr_array_new_with_free_func ((GDestroyNotify) finished_write_free);
+
+	data.queue = gdata_write_queue_new (service, NULL, "https://www.google.com/feeds/general/write-queue", NULL);
+	data.n_requests = 0;
+	g_signal_connect (data.queue, "write-finished", (GCallback) write_finished_cb, finished);
+
+	/* Two separately-parsed versions of the same entry, as an application would have after editing it twice */
+	entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY, entry_xml, -1, &error));
+	g_assert_no_error (error);
+	gdata_entry_set_title (entry, "First edit");
+
+	data.newer_entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY, entry_xml, -1, &error));
+	g_assert_no_error (error);
+	gdata_entry_set_title (data.newer_entry, "Second edit");
+
+	log = request_log_start ();
+	handler_id = g_signal_connect (mock_server, "handle-message", (GCallback) write_queue_requeue_handle_message_cb, &data);
+	uhm_server_run (mock_server);
+	gdata_test_set_https_port (mock_server);
+
+	/* The first edit fails transiently, so it's put back in the queue rather than reported, and merged with the second edit which was queued
+	 * while it was being sent */
+	gdata_write_queue_add_update (data.queue, entry);
+
+	g_assert (gdata_write_queue_flush (data.queue, NULL, &error) == FALSE);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NETWORK_ERROR);
+	g_clear_error (&error);
+
+	g_assert_cmpuint (finished->len, ==, 0);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (data.queue), ==, 1);
+
+	/* Only the latest version of the entry is sent the next time round */
+	g_assert (gdata_write_queue_flush (data.queue, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (data.queue), ==, 0);
+
+	uhm_server_stop (mock_server);
+	g_signal_handler_disconnect (mock_server, handler_id);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 2);
+	g_assert_cmpstr (request_log_get (log, 1)->method, ==, "PUT");
+	g_assert_cmpstr (request_log_get (log, 1)->path_and_query, ==, "/feeds/general/write-queue/6");
+
+	body = dup_logged_request_body (request_log_get (log, 0));
+	g_assert (strstr (body, "First edit") != NULL);
+	g_free (body);
+
+	body = dup_logged_request_body (request_log_get (log, 1));
+	g_assert (strstr (body, "Second edit") != NULL);
+	g_assert (strstr (body, "First edit") == NULL);
+	g_free (body);
+
+	g_assert_cmpuint (finished->len, ==, 1);
+	write = g_ptr_array_index (finished, 0);
+	g_assert_cmpint (write->type, ==, GDATA_BATCH_OPERATION_UPDATE);
+	g_assert (write->entry == data.newer_entry);
+	g_assert_no_error (write->error);
+	g_assert_cmpstr (gdata_entry_get_etag (write->server_entry), ==, "\"W2\"");
+
+	request_log_stop (log);
+	g_ptr_array_unref (finished);
+	g_object_unref (data.newer_entry);
+	g_object_unref (entry);
+	g_object_unref (data.queue);
+	g_object_unref (service);
+}
+
+static GDataEntry *
+write_queue_conflict_resolver (GDataWriteQueue *queue, GDataEntry *local_entry, GDataEntry *server_entry, guint *n_calls)
+{
+	(*n_calls)++;
+
+	/* Keep the server's version of the deleted entry */
+	if (strcmp (gdata_entry_get_id (local_entry), "https://www.google.com/feeds/general/write-queue/5") == 0)
+		return NULL;
+
+	/* Merge the local title into the server's version of the updated entry */
+	gdata_entry_set_title (server_entry, gdata_entry_get_title (local_entry));
+
+	return g_object_ref (server_entry);
+}
+
+static void
+test_write_queue_conflict (void)
+{
+	GDataService *service;
+	GDataWriteQueue *queue;
+	GDataEntry *updated_entry, *deleted_entry;
+	GPtrArray *finished;
+	FinishedWrite *write;
+	RequestLog *log;
+	guint n_resolver_calls = 0;
+	gchar *body;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	log = request_log_start ();
+	finished = g_ptr_array_new_with_free_func ((GDestroyNotify) finished_write_free);
+
+	gdata_test_mock_server_start_trace (mock_server, "write-queue-conflict");
+
+	queue = gdata_write_queue_new (service, NULL, "https://www.google.com/feeds/general/write-queue", NULL);
+	gdata_write_queue_set_conflict_resolver (queue, (GDataWriteQueueConflictResolver) write_queue_conflict_resolver, &n_resolver_calls, NULL);
+	g_signal_connect (queue, "write-finished", (GCallback) write_finished_cb, finished);
+
+	updated_entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;L4&quot;'>"
+			"<id>https://www.google.com/feeds/general/write-queue/4</id>"
+			"<updated>2026-10-14T10:00:00.000Z</updated>"
+			"<title type='text'>Old title</title>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/write-queue/4'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	gdata_entry_set_title (updated_entry, "Local title");
+
+	deleted_entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY,
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gd='http://schemas.google.com/g/2005' gd:etag='&quot;L5&quot;'>"
+			"<id>https://www.google.com/feeds/general/write-queue/5</id>"
+			"<updated>2026-10-14T10:00:00.000Z</updated>"
+			"<title type='text'>Deleted locally</title>"
+			"<link rel='edit' type='application/atom+xml' href='https://www.google.com/feeds/general/write-queue/5'/>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+
+	gdata_write_queue_add_update (queue, updated_entry);
+	gdata_write_queue_add_deletion (queue, deleted_entry);
+
+	/* Both writes conflict. Once they've all been sent, the server's version of each entry is fetched and passed to the resolver: the update's
+	 * retried once with the merged entry, and the deletion's abandoned. */
+	g_assert (gdata_write_queue_flush (queue, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (gdata_write_queue_get_n_pending (queue), ==, 0);
+	g_assert_cmpuint (n_resolver_calls, ==, 2);
+
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 5);
+	g_assert_cmpstr (request_log_get (log, 0)->method, ==, "PUT");
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 0)->headers, "If-Match"), ==, "\"L4\"");
+	g_assert_cmpstr (request_log_get (log, 1)->method, ==, "DELETE");
+	g_assert_cmpstr (request_log_get (log, 2)->method, ==, "GET");
+	g_assert_cmpstr (request_log_get (log, 2)->path_and_query, ==, "/feeds/general/write-queue/4");
+	g_assert_cmpstr (request_log_get (log, 3)->method, ==, "PUT");
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 3)->headers, "If-Match"), ==, "\"S4\"");
+	g_assert_cmpstr (request_log_get (log, 4)->method, ==, "GET");
+	g_assert_cmpstr (request_log_get (log, 4)->path_and_query, ==, "/feeds/general/write-queue/5");
+
+	/* The retried update carries the server's content as well as the local title */
+	body = dup_logged_request_body (request_log_get (log, 3));
+	g_assert (strstr (body, "Local title") != NULL);
+	g_assert (strstr (body, "Server content") != NULL);
+	g_free (body);
+
+	g_assert_cmpuint (finished->len, ==, 2);
+
+	write = g_ptr_array_index (finished, 0);
+	g_assert_cmpint (write->type, ==, GDATA_BATCH_OPERATION_UPDATE);
+	g_assert (write->entry == updated_entry);
+	g_assert_no_error (write->error);
+	g_assert_cmpstr (gdata_entry_get_title (write->server_entry), ==, "Local title");
+	g_assert_cmpstr (gdata_entry_get_etag (write->server_entry), ==, "\"S4b\"");
+
+	/* An abandoned write is reported as succeeding, with the server's version of the entry */
+	write = g_ptr_array_index (finished, 1);
+	g_assert_cmpint (write->type, ==, GDATA_BATCH_OPERATION_DELETION);
+	g_assert (write->entry == deleted_entry);
+	g_assert_no_error (write->error);
+	g_assert_cmpstr (gdata_entry_get_title (write->server_entry), ==, "Kept on server");
+
+	g_object_unref (deleted_entry);
+	g_object_unref (updated_entry);
+	g_object_unref (queue);
+	g_ptr_array_unref (finished);
+	request_log_stop (log);
+	g_object_unref (service);
+}
+
+static void
+test_service_hedge_delay (void)
+{
+	GDataService *service;
+	guint hedge_delay;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Requests aren't hedged by default */
+	g_assert_cmpuint (gdata_service_get_hedge_delay (service), ==, 0);
+
+	gdata_service_set_hedge_delay (service, 150);
+	g_assert_cmpuint (gdata_service_get_hedge_delay (service), ==, 150);
+
+	g_object_set (service, "hedge-delay", 0, NULL);
+	g_object_get (service, "hedge-delay", &hedge_delay, NULL);
+	g_assert_cmpuint (hedge_delay, ==, 0);
+
+	g_object_unref (service);
+}
+
+static gboolean
+hedge_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, volatile gint *n_requests)
+{
+	const gchar *response_body =
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<entry xmlns='http://www.w3.org/2005/Atom'>"
+			"<id>https://www.google.com/feeds/general/hedge/1</id>"
+			"<updated>2026-10-14T09:00:00.000Z</updated>"
+			"<title type='text'>Hedged entry</title>"
+		"</entry>";
+
+	/* The first request is stuck on a slow server. The mock server handles one request at a time, so the hedge is only answered after it. */
+	if (g_atomic_int_add (n_requests, 1) == 0)
+		g_usleep (G_USEC_PER_SEC / 2);
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_set_response (message, "application/atom+xml; charset=UTF-8; type=entry", SOUP_MEMORY_STATIC, response_body,
+	                           strlen (response_body));
+
+	return TRUE;
+}
+
+static void
+test_service_hedge_slow_request (void)
+{
+	GDataService *service;
+	GDataEntry *entry;
+	RequestLog *log;
+	volatile gint n_requests = 0;
+	gulong handler_id;
+	guint i;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, "hedge-delay", 50, NULL);
+
+	/* The log has to be connected first so that it sees the requests before the handler answers them */
+	log = request_log_start ();
+	handler_id = g_signal_connect (mock_server, "handle-message", (GCallback) hedge_handle_message_cb, (gpointer) &n_requests);
+	uhm_server_run (mock_server);
+	gdata_test_set_https_port (mock_server);
+
+	/* The first request hasn't had a response after the hedge delay, so an identical second one is sent */
+	entry = gdata_service_query_single_entry (service, NULL, "https://www.google.com/feeds/general/hedge/1", NULL, GDATA_TYPE_ENTRY, NULL,
+	                                          &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_assert_cmpstr (gdata_entry_get_title (entry), ==, "Hedged entry");
+
+	/* The losing request is cancelled once the winner's finished, but the server may still be about to handle it */
+	for (i = 0; i < 100 && g_atomic_int_get (&n_requests) < 2; i++)
+		g_usleep (G_USEC_PER_SEC / 100);
+
+	uhm_server_stop (mock_server);
+	g_signal_handler_disconnect (mock_server, handler_id);
+
+	g_assert_cmpint (n_requests, ==, 2);
+	g_assert_cmpuint (request_log_get_length (log), ==, 2);
+	g_assert_cmpstr (request_log_get (log, 0)->method, ==, "GET");
+	g_assert_cmpstr (request_log_get (log, 1)->method, ==, "GET");
+	g_assert_cmpstr (request_log_get (log, 1)->path_and_query, ==, request_log_get (log, 0)->path_and_query);
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 1)->headers, "GData-Version"), ==,
+	                 soup_message_headers_get_one (request_log_get (log, 0)->headers, "GData-Version"));
+
+	request_log_stop (log);
+	g_object_unref (entry);
+	g_object_unref (service);
+}
+
+static void
+test_service_compress_requests (void)
+{
+	GDataService *service;
+	gboolean compress_requests;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Requests aren't compressed by default */
+	g_assert (gdata_service_get_compress_requests (service) == FALSE);
+
+	gdata_service_set_compress_requests (service, TRUE);
+	g_assert (gdata_service_get_compress_requests (service) == TRUE);
+
+	g_object_set (service, "compress-requests", FALSE, NULL);
+	g_object_get (service, "compress-requests", &compress_requests, NULL);
+	g_assert (compress_requests == FALSE);
+
+	g_object_unref (service);
+}
+
+/* Returns the gunzipped contents of @body as a nul-terminated string */
+static gchar *
+gunzip_request_body (GBytes *body)
+{
+	GInputStream *memory_stream, *converter_stream;
+	GConverter *decompressor;
+	GByteArray *contents;
+	guint8 buffer[4096];
+	gssize length;
+	GError *error = NULL;
+
+	memory_stream = g_memory_input_stream_new_from_data (g_bytes_get_data (body, NULL), g_bytes_get_size (body), NULL);
+	decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+	converter_stream = g_converter_input_stream_new (memory_stream, decompressor);
+	contents = g_byte_array_new ();
+
+	while ((length = g_input_stream_read (converter_stream, buffer, sizeof (buffer), NULL, &error)) > 0)
+		g_byte_array_append (contents, buffer, length);
+	g_assert_no_error (error);
+
+	g_byte_array_append (contents, (const guint8*) "", 1);
+
+	g_object_unref (converter_stream);
+	g_object_unref (decompressor);
+	g_object_unref (memory_stream);
+
+	return (gchar*) g_byte_array_free (contents, FALSE);
+}
+
+static void
+test_service_compress_requests_batch (void)
+{
+	GDataContactsService *service;
+	GDataBatchOperation *operation;
+	GDataContactsContact *contact;
+	GDataEntry *inserted_entry = NULL;
+	RequestLog *log;
+	gchar *request_body;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = gdata_contacts_service_new (NULL);
+	gdata_service_set_compress_requests (GDATA_SERVICE (service), TRUE);
+	log = request_log_start ();
+
+	gdata_test_mock_server_start_trace (mock_server, "compress-requests-batch");
+
+	contact = gdata_contacts_contact_new (NULL);
+	gdata_entry_set_title (GDATA_ENTRY (contact), "Fooish Bar");
+
+	operation = gdata_batchable_create_operation (GDATA_BATCHABLE (service), gdata_contacts_service_get_primary_authorization_domain (),
+	                                              "https://www.google.com/m8/feeds/contacts/default/full/batch");
+	gdata_test_batch_operation_insertion (operation, GDATA_ENTRY (contact), &inserted_entry, NULL);
+	g_assert (gdata_test_batch_operation_run (operation, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_assert (GDATA_IS_CONTACTS_CONTACT (inserted_entry));
+	g_assert_cmpstr (gdata_entry_get_id (inserted_entry), ==, "http://www.google.com/m8/feeds/contacts/default/base/1");
+
+	uhm_server_end_trace (mock_server);
+
+	/* The batch feed was sent gzipped, and decompresses to the whole feed */
+	g_assert_cmpuint (request_log_get_length (log), ==, 1);
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 0)->headers, "Content-Encoding"), ==, "gzip");
+
+	request_body = gunzip_request_body (request_log_get (log, 0)->body);
+	g_assert (g_str_has_prefix (request_body, "<?xml version='1.0' encoding='UTF-8'?><feed ") == TRUE);
+	g_assert (strstr (request_body, "<batch:operation type='insert'/>") != NULL);
+	g_assert (strstr (request_body, "Fooish Bar") != NULL);
+	g_assert (g_str_has_suffix (request_body, "</feed>") == TRUE);
+	g_free (request_body);
+
+	request_log_stop (log);
+	g_object_unref (inserted_entry);
+	g_object_unref (operation);
+	g_object_unref (contact);
+	g_object_unref (service);
+}
+
+static gboolean
+batch_split_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, gpointer user_data)
+{
+	SoupBuffer *buffer;
+	GString *response;
+	gchar *request_body;
+	const gchar *i;
+
+	buffer = soup_message_body_flatten (message->request_body);
+	request_body = g_strndup (buffer->data, buffer->length);
+	soup_buffer_free (buffer);
+
+	response = g_string_new ("<?xml version='1.0' encoding='UTF-8'?>"
+	                         "<feed xmlns='http://www.w3.org/2005/Atom' xmlns:batch='http://schemas.google.com/gdata/batch'>"
+	                         "<id>https://www.google.com/m8/feeds/contacts/default/full/batch/1</id>"
+	                         "<updated>2026-10-15T10:00:00.000Z</updated>"
+	                         "<title>Batch operation feed</title>");
+
+	/* Answer each of the request's queries successfully */
+	for (i = strstr (request_body, "<batch:id>"); i != NULL; i = strstr (i + 1, "<batch:id>")) {
+		guint id = g_ascii_strtoull (i + strlen ("<batch:id>"), NULL, 10);
+
+		g_string_append_printf (response,
+		                        "<entry>"
+		                        "<id>http://www.google.com/m8/feeds/contacts/default/base/%u</id>"
+		                        "<updated>2026-10-15T10:00:00.000Z</updated>"
+		                        "<category scheme='http://schemas.google.com/g/2005#kind' "
+		                                  "term='http://schemas.google.com/contact/2008#contact'/>"
+		                        "<title>Contact %u</title>"
+		                        "<batch:id>%u</batch:id>"
+		                        "<batch:status code='200' reason='Success'/>"
+		                        "<batch:operation type='query'/>"
+		                        "</entry>", id, id, id);
+	}
+
+	g_string_append (response, "</feed>");
+	g_free (request_body);
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_set_response (message, "application/atom+xml", SOUP_MEMORY_TAKE, response->str, response->len);
+	g_string_free (response, FALSE);
+
+	return TRUE;
+}
+
+typedef struct {
+	GThread *thread;
+	guint n_calls[8];
+} BatchSplitData;
+
+static void
+batch_split_query_cb (guint operation_id, GDataBatchOperationType operation_type, GDataEntry *entry, GError *error, BatchSplitData *data)
+{
+	gchar *id;
+
+	g_assert_no_error (error);
+	g_assert_cmpint (operation_type, ==, GDATA_BATCH_OPERATION_QUERY);
+	g_assert_cmpuint (operation_id, <, G_N_ELEMENTS (data->n_calls));
+
+	/* Callbacks are always called in the thread which ran the operation, even if its requests were sent from a thread pool */
+	g_assert (g_thread_self () == data->thread);
+
+	id = g_strdup_printf ("http://www.google.com/m8/feeds/contacts/default/base/%u", operation_id);
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, id);
+	g_free (id);
+
+	data->n_calls[operation_id]++;
+}
+
+/* Runs a batch operation of five queries split into requests of at most @max_operations_per_request, and returns the number of requests sent */
+static guint
+run_split_batch_operation (GDataContactsService *service, RequestLog *log, guint max_operations_per_request, guint max_concurrent_requests)
+{
+	GDataBatchOperation *operation;
+	BatchSplitData data;
+	guint i, id, n_requests_before;
+	GError *error = NULL;
+
+	memset (&data, 0, sizeof (data));
+	data.thread = g_thread_self ();
+
+	operation = gdata_batchable_create_operation (GDATA_BATCHABLE (service), gdata_contacts_service_get_primary_authorization_domain (),
+	                                              "https://www.google.com/m8/feeds/contacts/default/full/batch");
+	gdata_batch_operation_set_max_operations_per_request (operation, max_operations_per_request);
+	gdata_batch_operation_set_max_concurrent_requests (operation, max_concurrent_requests);
+
+	for (i = 1; i <= 5; i++) {
+		gchar *query_id = g_strdup_printf ("http://www.google.com/m8/feeds/contacts/default/base/%u", i);
+
+		id = gdata_batch_operation_add_query (operation, query_id, GDATA_TYPE_CONTACTS_CONTACT,
+		                                      (GDataBatchOperationCallback) batch_split_query_cb, &data);
+		g_assert_cmpuint (id, ==, i);
+
+		g_free (query_id);
+	}
+
+	n_requests_before = request_log_get_length (log);
+
+	g_assert (gdata_batch_operation_run (operation, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	/* Every operation's callback was called exactly once */
+	for (i = 1; i <= 5; i++)
+		g_assert_cmpuint (data.n_calls[i], ==, 1);
+
+	g_object_unref (operation);
+
+	return request_log_get_length (log) - n_requests_before;
+}
+
+static void
+test_batch_operation_split (void)
+{
+	GDataContactsService *service;
+	GDataBatchOperation *operation;
+	RequestLog *log;
+	gulong handler_id;
+	guint i, j, id;
+	gchar *body, *expected_id;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = gdata_contacts_service_new (NULL);
+
+	/* Batch operations created by applications aren't split by default, as before the property was added */
+	operation = gdata_batchable_create_operation (GDATA_BATCHABLE (service), gdata_contacts_service_get_primary_authorization_domain (),
+	                                              "https://www.google.com/m8/feeds/contacts/default/full/batch");
+	g_assert_cmpuint (gdata_batch_operation_get_max_operations_per_request (operation), ==, 0);
+	g_assert_cmpuint (gdata_batch_operation_get_max_concurrent_requests (operation), ==, 1);
+	g_object_unref (operation);
+
+	log = request_log_start ();
+	handler_id = g_signal_connect (mock_server, "handle-message", (GCallback) batch_split_handle_message_cb, NULL);
+	uhm_server_run (mock_server);
+	gdata_test_set_https_port (mock_server);
+
+	/* With no limit, all the operations go in one request */
+	g_assert_cmpuint (run_split_batch_operation (service, log, 0, 1), ==, 1);
+
+	/* With a limit, the requests are filled in the order the operations were added, and sent one after another */
+	g_assert_cmpuint (run_split_batch_operation (service, log, 2, 1), ==, 3);
+
+	for (i = 0, id = 1; i < 3; i++) {
+		const gchar *k;
+		guint n_ids = 0;
+
+		body = dup_logged_request_body (request_log_get (log, 1 + i));
+
+		for (k = strstr (body, "<batch:id>"); k != NULL; k = strstr (k + 1, "<batch:id>"))
+			n_ids++;
+		g_assert_cmpuint (n_ids, ==, (i < 2) ? 2 : 1);
+
+		for (j = 0; j < n_ids; j++, id++) {
+			expected_id = g_strdup_printf ("<batch:id>%u</batch:id>", id);
+			g_assert (strstr (body, expected_id) != NULL);
+			g_free (expected_id);
+		}
+
+		g_free (body);
+	}
+
+	/* With several requests allowed in flight at once, they're sent from a thread pool, but the callbacks are still called once each */
+	g_assert_cmpuint (run_split_batch_operation (service, log, 2, 3), ==, 3);
+
+	for (i = 4; i < 7; i++)
+		g_assert_cmpstr (request_log_get (log, i)->path_and_query, ==, "/m8/feeds/contacts/default/full/batch");
+
+	uhm_server_stop (mock_server);
+	g_signal_handler_disconnect (mock_server, handler_id);
+
+	request_log_stop (log);
+	g_object_unref (service);
+}
+
+static void
+test_service_shared_session (void)
+{
+	GDataService *service1, *service2, *service3;
+	SoupSession *session;
+
+	/* Each service has its own session by default */
+	service1 = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	service2 = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	g_assert (SOUP_IS_SESSION (gdata_service_get_session (service1)));
+	g_assert (gdata_service_get_session (service1) != gdata_service_get_session (service2));
+
+	/* A service can share another's session */
+	service3 = g_object_new (GDATA_TYPE_SERVICE, "session", gdata_service_get_session (service1), NULL);
+	g_assert (gdata_service_get_session (service3) == gdata_service_get_session (service1));
+
+	g_object_get (service3, "session", &session, NULL);
+	g_assert (session == gdata_service_get_session (service1));
+	g_object_unref (session);
+
+	/* Session-wide settings are shared */
+	gdata_service_set_timeout (service3, 30);
+	g_assert_cmpuint (gdata_service_get_timeout (service1), ==, 30);
+	g_assert_cmpuint (gdata_service_get_timeout (service2), ==, 0);
+
+	/* The session outlives the service it was created by */
+	session = g_object_ref (gdata_service_get_session (service1));
+	g_object_unref (service1);
+	g_assert (gdata_service_get_session (service3) == session);
+	g_assert_cmpuint (gdata_service_get_timeout (service3), ==, 30);
+	g_object_unref (session);
+
+	g_object_unref (service3);
+	g_object_unref (service2);
+}
+
+static void
+test_cancellable_deadline (void)
+{
+	GCancellable *cancellable;
+	gint64 deadline;
+
+	cancellable = g_cancellable_new ();
+
+	/* There's no deadline by default */
+	g_assert_cmpint (gdata_cancellable_get_deadline (NULL), ==, -1);
+	g_assert_cmpint (gdata_cancellable_get_deadline (cancellable), ==, -1);
+
+	/* A far-off deadline shouldn't cancel anything yet, and can be unset again */
+	deadline = g_get_monotonic_time () + 60 * G_USEC_PER_SEC;
+	gdata_cancellable_set_deadline (cancellable, deadline);
+	g_assert_cmpint (gdata_cancellable_get_deadline (cancellable), ==, deadline);
+	g_assert (g_cancellable_is_cancelled (cancellable) == FALSE);
+
+	gdata_cancellable_set_deadline (cancellable, -1);
+	g_assert_cmpint (gdata_cancellable_get_deadline (cancellable), ==, -1);
+
+	/* A deadline which has already passed should cancel the cancellable almost straight away, without the test iterating a main loop */
+	gdata_cancellable_set_deadline (cancellable, g_get_monotonic_time ());
+
+	deadline = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+	while (g_cancellable_is_cancelled (cancellable) == FALSE && g_get_monotonic_time () < deadline)
+		g_usleep (1000);
+
+	g_assert (g_cancellable_is_cancelled (cancellable) == TRUE);
+
+	g_object_unref (cancellable);
+}
+
+static void
+gauges_sampled_cb (GDataService *service, GDataServiceGauges *gauges, GDataServiceGauges **gauges_out)
+{
+	gdata_service_gauges_free (*gauges_out);
+	*gauges_out = gdata_service_gauges_copy (gauges);
+}
+
+static void
+test_service_gauges (void)
+{
+	GDataService *service;
+	GDataServiceGauges gauges, *sampled = NULL;
+	GOutputStream *upload_stream;
+	GInputStream *download_stream;
+	guint gauges_interval;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Nothing's happening yet */
+	gdata_service_get_gauges (service, &gauges);
+	g_assert_cmpuint (gauges.requests_in_flight, ==, 0);
+	g_assert_cmpuint (gauges.scheduler_queue_length, ==, 0);
+	g_assert_cmpuint (gauges.connection_queue_length, ==, 0);
+	g_assert_cmpuint (gauges.upload_streams, ==, 0);
+	g_assert_cmpuint (gauges.upload_buffered_bytes, ==, 0);
+	g_assert_cmpuint (gauges.download_streams, ==, 0);
+	g_assert_cmpuint (gauges.download_buffered_bytes, ==, 0);
+	g_assert_cmpuint (gauges.pending_progress_callbacks, ==, 0);
+	g_assert_cmpuint (gdata_service_get_requests_in_flight (service, NULL), ==, 0);
+
+	/* Streams are counted while they're open, even before they touch the network */
+	upload_stream = gdata_upload_stream_new (service, NULL, SOUP_METHOD_POST, "https://example.com/upload", NULL, "slug", "text/plain", NULL);
+	download_stream = gdata_download_stream_new (service, NULL, "https://example.com/download", NULL);
+
+	gdata_service_get_gauges (service, &gauges);
+	g_assert_cmpuint (gauges.upload_streams, ==, 1);
+	g_assert_cmpuint (gauges.download_streams, ==, 1);
+
+	g_object_unref (upload_stream);
+	g_object_unref (download_stream);
+
+	gdata_service_get_gauges (service, &gauges);
+	g_assert_cmpuint (gauges.upload_streams, ==, 0);
+	g_assert_cmpuint (gauges.download_streams, ==, 0);
+	g_assert_cmpuint (gauges.upload_buffered_bytes, ==, 0);
+
+	/* Snapshots are off by default */
+	g_assert_cmpuint (gdata_service_get_gauges_interval (service), ==, 0);
+
+	g_signal_connect (service, "gauges-sampled", (GCallback) gauges_sampled_cb, &sampled);
+	gdata_service_set_gauges_interval (service, 10);
+	g_object_get (service, "gauges-interval", &gauges_interval, NULL);
+	g_assert_cmpuint (gauges_interval, ==, 10);
+
+	while (sampled == NULL)
+		g_main_context_iteration (NULL, TRUE);
+
+	g_assert_cmpuint (sampled->requests_in_flight, ==, 0);
+	g_assert_cmpuint (sampled->upload_streams, ==, 0);
+
+	/* Turning them off again stops the signal */
+	g_object_set (service, "gauges-interval", 0, NULL);
+	gdata_service_gauges_free (sampled);
+	sampled = NULL;
+
+	while (g_main_context_iteration (NULL, FALSE) == TRUE);
+	g_assert (sampled == NULL);
+
+	g_object_unref (service);
+}
+
+static void
+test_service_reserved_connections (void)
+{
+	GDataService *service;
+	GDataQuery *query;
+	GDataRequestPriority priority;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* No connections are reserved by default */
+	g_assert_cmpuint (gdata_service_get_reserved_connections (service), ==, 0);
+
+	gdata_service_set_max_connections_per_host (service, 4);
+	gdata_service_set_reserved_connections (service, 1);
+	g_assert_cmpuint (gdata_service_get_reserved_connections (service), ==, 1);
+
+	/* Reserving every connection is allowed; non-interactive requests still get one */
+	g_object_set (service, "reserved-connections", 10, NULL);
+	g_assert_cmpuint (gdata_service_get_reserved_connections (service), ==, 10);
+
+	g_object_unref (service);
+
+	/* Queries are normal priority by default */
+	query = gdata_query_new (NULL);
+	g_assert_cmpint (gdata_query_get_priority (query), ==, GDATA_REQUEST_PRIORITY_NORMAL);
+
+	gdata_query_set_etag (query, "foobar");
+	gdata_query_set_priority (query, GDATA_REQUEST_PRIORITY_INTERACTIVE);
+	g_assert_cmpint (gdata_query_get_priority (query), ==, GDATA_REQUEST_PRIORITY_INTERACTIVE);
+
+	/* The priority doesn't affect the query URI, so the ETag should be kept */
+	g_assert_cmpstr (gdata_query_get_etag (query), ==, "foobar");
+
+	g_object_set (query, "priority", GDATA_REQUEST_PRIORITY_BACKGROUND, NULL);
+	g_object_get (query, "priority", &priority, NULL);
+	g_assert_cmpint (priority, ==, GDATA_REQUEST_PRIORITY_BACKGROUND);
+
+	g_object_unref (query);
+}
+
+#define CONCURRENCY_N_THREADS 16
+#define CONCURRENCY_N_ITERATIONS 500
+
+typedef struct {
+	GDataService *service;
+	GDataAuthorizer *authorizers[2];
+} ConcurrencyData;
+
+static gpointer
+concurrency_thread_cb (ConcurrencyData *data)
+{
+	static const gchar *locales[] = { "en_GB", "fr_FR", NULL };
+	guint i;
+
+	for (i = 0; i < CONCURRENCY_N_ITERATIONS; i++) {
+		GDataAuthorizer *authorizer;
+		const gchar *locale;
+		gchar *locale_copy;
+		guint timeout;
+
+		/* Change the configuration */
+		gdata_service_set_authorizer (data->service, data->authorizers[i % 2]);
+		gdata_service_set_locale (data->service, locales[i % G_N_ELEMENTS (locales)]);
+		gdata_service_set_timeout (data->service, i % 2);
+
+		/* Read it back while the other threads are changing it; whatever we get must be one of the values which were set */
+		authorizer = gdata_service_dup_authorizer (data->service);
+		g_assert (authorizer == data->authorizers[0] || authorizer == data->authorizers[1]);
+		g_object_unref (authorizer);
+
+		locale = gdata_service_get_locale (data->service);
+		g_assert (locale == NULL || strcmp (locale, "en_GB") == 0 || strcmp (locale, "fr_FR") == 0);
+
+		g_object_get (data->service, "locale", &locale_copy, "authorizer", &authorizer, "timeout", &timeout, NULL);
+		g_assert (authorizer == data->authorizers[0] || authorizer == data->authorizers[1]);
+		g_assert_cmpuint (timeout, <=, 1);
+		g_object_unref (authorizer);
+		g_free (locale_copy);
+
+		gdata_service_is_authorized (data->service);
+	}
+
+	return NULL;
+}
+
+static void
+test_service_concurrency (void)
+{
+	ConcurrencyData data;
+	GThread *threads[CONCURRENCY_N_THREADS];
+	guint i;
+
+	data.service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	data.authorizers[0] = GDATA_AUTHORIZER (gdata_client_login_authorizer_new ("testing", GDATA_TYPE_SERVICE));
+	data.authorizers[1] = GDATA_AUTHORIZER (gdata_client_login_authorizer_new ("testing", GDATA_TYPE_SERVICE));
+	gdata_service_set_authorizer (data.service, data.authorizers[0]);
+
+	/* Hammer a single service's configuration from lots of threads at once */
+	for (i = 0; i < G_N_ELEMENTS (threads); i++)
+		threads[i] = g_thread_new ("concurrency", (GThreadFunc) concurrency_thread_cb, &data);
+
+	for (i = 0; i < G_N_ELEMENTS (threads); i++)
+		g_thread_join (threads[i]);
+
+	/* The service should hold exactly one reference to whichever authorizer was set last */
+	gdata_service_set_authorizer (data.service, NULL);
+	g_assert (gdata_service_get_authorizer (data.service) == NULL);
+
+	g_assert_cmpuint (G_OBJECT (data.authorizers[0])->ref_count, ==, 1);
+	g_assert_cmpuint (G_OBJECT (data.authorizers[1])->ref_count, ==, 1);
+
+	g_object_unref (data.authorizers[1]);
+	g_object_unref (data.authorizers[0]);
+	g_object_unref (data.service);
+}
+
+typedef struct {
+	GMutex mutex;
+	GCond cond;
+	guint n_requests;
+	gboolean second_query_started;
+} ShareQueriesData;
+
+/* Counts the requests, and holds back the response to the first until the second query has been started, so that the two queries overlap. The
+ * responses themselves come from the trace. */
+static gboolean
+share_queries_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, ShareQueriesData *data)
+{
+	guint n_requests;
+
+	g_mutex_lock (&(data->mutex));
+
+	n_requests = ++data->n_requests;
+	g_cond_broadcast (&(data->cond));
+
+	while (n_requests == 1 && data->second_query_started == FALSE)
+		g_cond_wait (&(data->cond), &(data->mutex));
+
+	g_mutex_unlock (&(data->mutex));
+
+	/* Give the second query time to find the first one in progress */
+	if (n_requests == 1)
+		g_usleep (G_USEC_PER_SEC / 4);
+
+	return FALSE;
+}
+
+static gpointer
+share_queries_thread_cb (GDataService *service)
+{
+	GDataFeed *feed;
+	GError *error = NULL;
+
+	feed = gdata_service_query (service, NULL, "https://www.google.com/feeds/general/share-queries", NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL,
+	                            &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	return feed;
+}
+
+/* Runs two identical queries in separate threads, starting the second while the first is waiting for its response */
+static void
+run_shared_queries (GDataService *service, ShareQueriesData *data, GDataFeed **feed1, GDataFeed **feed2)
+{
+	GThread *thread1, *thread2;
+
+	data->n_requests = 0;
+	data->second_query_started = FALSE;
+
+	thread1 = g_thread_new ("share-queries-1", (GThreadFunc) share_queries_thread_cb, service);
+
+	g_mutex_lock (&(data->mutex));
+	while (data->n_requests == 0)
+		g_cond_wait (&(data->cond), &(data->mutex));
+	g_mutex_unlock (&(data->mutex));
+
+	thread2 = g_thread_new ("share-queries-2", (GThreadFunc) share_queries_thread_cb, service);
+
+	g_mutex_lock (&(data->mutex));
+	data->second_query_started = TRUE;
+	g_cond_broadcast (&(data->cond));
+	g_mutex_unlock (&(data->mutex));
+
+	*feed1 = g_thread_join (thread1);
+	*feed2 = g_thread_join (thread2);
+}
+
+static void
+test_service_share_queries (void)
+{
+	GDataService *service;
+	GDataFeed *feed1, *feed2;
+	ShareQueriesData data;
+	gboolean share_queries;
+	gulong handler_id;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+
+	/* Queries aren't shared by default */
+	g_assert (gdata_service_get_share_queries (service) == FALSE);
+
+	g_object_set (service, "share-queries", TRUE, NULL);
+	g_object_get (service, "share-queries", &share_queries, NULL);
+	g_assert (share_queries == TRUE);
+	gdata_service_set_share_queries (service, FALSE);
+
+	g_mutex_init (&(data.mutex));
+	g_cond_init (&(data.cond));
+	handler_id = g_signal_connect (mock_server, "handle-message", (GCallback) share_queries_handle_message_cb, &data);
+
+	/* Without sharing, each query makes its own request and gets its own feed */
+	gdata_test_mock_server_start_trace (mock_server, "share-queries-disabled");
+	run_shared_queries (service, &data, &feed1, &feed2);
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpuint (data.n_requests, ==, 2);
+	g_assert (feed1 != feed2);
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (feed1)), ==, 2);
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (feed2)), ==, 2);
+
+	g_object_unref (feed2);
+	g_object_unref (feed1);
+
+	/* With sharing, the second query waits for the first one's response rather than making a request of its own; the trace only has one
+	 * response, so a second request would fail */
+	gdata_service_set_share_queries (service, TRUE);
+
+	gdata_test_mock_server_start_trace (mock_server, "share-queries");
+	run_shared_queries (service, &data, &feed1, &feed2);
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpuint (data.n_requests, ==, 1);
+	g_assert (feed1 == feed2);
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (feed1)), ==, 2);
+
+	g_object_unref (feed2);
+	g_object_unref (feed1);
+
+	g_signal_handler_disconnect (mock_server, handler_id);
+	g_cond_clear (&(data.cond));
+	g_mutex_clear (&(data.mutex));
+
+	g_object_unref (service);
+}
+
+/* Inserts an entry asynchronously at @upload_uri, which the trace redirects or rejects before accepting */
+static void
+insert_entry_async_and_check (GDataService *service, const gchar *upload_uri)
+{
+	GDataEntry *entry, *inserted_entry;
+	GAsyncResult *async_result = NULL;
+	GError *error = NULL;
+
+	entry = gdata_entry_new (NULL);
+	gdata_entry_set_title (entry, "Inserted entry");
+
+	gdata_service_insert_entry_async (service, NULL, upload_uri, entry, NULL, (GAsyncReadyCallback) async_ready_cb, &async_result);
+	inserted_entry = gdata_service_insert_entry_finish (service, wait_for_async_result (&async_result), &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (inserted_entry));
+	g_assert_cmpstr (gdata_entry_get_id (inserted_entry), ==, "urn:entry:1");
+
+	g_object_unref (inserted_entry);
+	g_object_unref (async_result);
+	g_object_unref (entry);
+}
+
+static void
+test_service_send_async_redirect (void)
+{
+	GDataService *service;
+	RequestLog *log;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	log = request_log_start ();
+
+	/* The insertion is redirected, and the same message is sent again to the new URI once libsoup has finished with it */
+	gdata_test_mock_server_start_trace (mock_server, "send-async-redirect");
+	insert_entry_async_and_check (service, "https://www.google.com/feeds/general/redirect");
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 2);
+	g_assert_cmpstr (request_log_get (log, 0)->path_and_query, ==, "/feeds/general/redirect");
+	g_assert_cmpstr (request_log_get (log, 1)->method, ==, "POST");
+	g_assert_cmpstr (request_log_get (log, 1)->path_and_query, ==, "/feeds/general/redirected");
+
+	/* The redirected request still has its body and custom headers */
+	g_assert_cmpuint (g_bytes_get_size (request_log_get (log, 1)->body), ==, g_bytes_get_size (request_log_get (log, 0)->body));
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 1)->headers, "GData-Version"), ==,
+	                 soup_message_headers_get_one (request_log_get (log, 0)->headers, "GData-Version"));
+
+	request_log_stop (log);
+	g_object_unref (service);
+}
+
+static void
+query_redirected_entry (GDataService *service, const gchar *path)
+{
+	GDataEntry *entry;
+	gchar *uri;
+	GError *error = NULL;
+
+	uri = g_strconcat ("https://www.google.com/feeds/general/", path, NULL);
+	entry = gdata_service_query_single_entry (service, NULL, uri, NULL, GDATA_TYPE_ENTRY, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (entry));
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, "urn:entry:1");
+	g_object_unref (entry);
+	g_free (uri);
+}
+
+static void
+test_service_insert_entry_streamed_xml (void)
+{
+	GDataService *service;
+	GDataEntry *entry, *inserted_entry;
+	GString *content;
+	gchar *expected_xml;
+	const LoggedRequest *request;
+	RequestLog *log;
+	guint i;
+	GError *error = NULL;
 
-	_link = gdata_feed_look_up_link (feed, "http://schemas.google.com/g/2005#post");
-	g_assert (GDATA_IS_LINK (_link));
+	if (skip_if_not_offline () == TRUE)
+		return;
 
-	_link = gdata_feed_look_up_link (feed, GDATA_LINK_SELF);
-	g_assert (GDATA_IS_LINK (_link));
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	log = request_log_start ();
 
-	/* Check the authors */
-	list = gdata_feed_get_authors (feed);
-	g_assert (list != NULL);
-	g_assert_cmpint (g_list_length (list), ==, 1);
-	g_assert (GDATA_IS_AUTHOR (list->data));
+	/* Build an entry whose XML is several times the size of the chunks it's streamed into the request body in, with plenty of empty elements
+	 * (which are closed as "<.../>" once they're known to be empty) falling either side of the chunk boundaries */
+	entry = gdata_entry_new (NULL);
+	gdata_entry_set_title (entry, "Large entry");
+
+	content = g_string_new (NULL);
+	for (i = 0; i < 2000; i++)
+		g_string_append_printf (content, "Line %u of the content, with some <markup> & odd characters to escape.\n", i);
+	gdata_entry_set_content (entry, content->str);
+	g_string_free (content, TRUE);
+
+	for (i = 0; i < 2000; i++) {
+		GDataCategory *category;
+		gchar *term;
+
+		term = g_strdup_printf ("term-%u", i);
+		category = gdata_category_new (term, "http://example.com/scheme", (i % 2 == 0) ? NULL : "Label");
+		gdata_entry_add_category (entry, category);
+		g_object_unref (category);
+		g_free (term);
+	}
 
-	/* Check the other properties again, the more normal way this time */
-	g_assert_cmpstr (gdata_feed_get_title (feed), ==, "Test feed");
-	g_assert_cmpstr (gdata_feed_get_subtitle (feed), ==, "Test subtitle");
-	g_assert_cmpstr (gdata_feed_get_id (feed), ==, "http://example.com/id");
-	g_assert_cmpstr (gdata_feed_get_etag (feed), ==, "W/\"D08FQn8-eil7ImA9WxZbFEw.\"");
+	/* The request body should be exactly the XML which would have been built in one go */
+	expected_xml = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
+	g_assert_cmpuint (strlen (expected_xml), >, 3 * 64 * 1024);
 
-	updated2 = gdata_feed_get_updated (feed);
-	g_assert_cmpint (updated2, ==, 1235570857);
+	gdata_test_mock_server_start_trace (mock_server, "insert-entry-streamed-xml");
 
-	g_assert_cmpstr (gdata_feed_get_logo (feed), ==, "http://example.com/logo.png");
-	g_assert_cmpstr (gdata_feed_get_icon (feed), ==, "http://example.com/icon.png");
-	g_assert_cmpstr (gdata_feed_get_rights (feed), ==, "public");
+	inserted_entry = gdata_service_insert_entry (service, NULL, "https://www.google.com/feeds/general/streamed-xml", entry, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_ENTRY (inserted_entry));
 
-	generator = gdata_feed_get_generator (feed);
-	g_assert (GDATA_IS_GENERATOR (generator));
-	g_assert_cmpstr (gdata_generator_get_name (generator), ==, "Example Generator");
-	g_assert_cmpstr (gdata_generator_get_uri (generator), ==, "http://example.com/");
-	g_assert_cmpstr (gdata_generator_get_version (generator), ==, "0.6");
+	uhm_server_end_trace (mock_server);
 
-	g_assert_cmpuint (gdata_feed_get_items_per_page (feed), ==, 50);
-	g_assert_cmpuint (gdata_feed_get_start_index (feed), ==, 1);
-	g_assert_cmpuint (gdata_feed_get_total_results (feed), ==, 2);
+	g_assert_cmpuint (request_log_get_length (log), ==, 1);
+	request = request_log_get (log, 0);
 
-	g_object_unref (feed);
+	g_assert_cmpstr (soup_message_headers_get_one (request->headers, "Content-Type"), ==, "application/atom+xml");
+	g_assert_cmpuint (g_bytes_get_size (request->body), ==, strlen (expected_xml));
+	g_assert (memcmp (g_bytes_get_data (request->body, NULL), expected_xml, strlen (expected_xml)) == 0);
+
+	g_free (expected_xml);
+	g_object_unref (inserted_entry);
+	g_object_unref (entry);
+	request_log_stop (log);
+	g_object_unref (service);
 }
 
 static void
-test_feed_error_handling (void)
+test_service_redirect_cache (void)
 {
-	GDataFeed *feed;
-	GError *error = NULL;
-
-#define TEST_XML_ERROR_HANDLING(x) feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED, \
-		"<feed xmlns='http://www.w3.org/2005/Atom' xmlns:openSearch='http://a9.com/-/spec/opensearch/1.1/'>"\
-			x\
-		"</feed>", -1, &error));\
-	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);\
-	g_assert (feed == NULL);\
-	g_clear_error (&error)
+	GDataService *service;
+	RequestLog *log;
+	guint i;
 
-	/* entry */
-	TEST_XML_ERROR_HANDLING ("<entry><updated>this isn't a date</updated></entry>"); /* invalid entry */
+	if (skip_if_not_offline () == TRUE)
+		return;
 
-	/* title */
-	TEST_XML_ERROR_HANDLING ("<title>First title</title><title>Second title</title>"); /* duplicate title */
-#if 0
-	/* FIXME: Removed due to the YouTube comments feed not being a valid Atom feed.
-	 * See: https://code.google.com/p/gdata-issues/issues/detail?id=2908
-	 * and: https://bugzilla.gnome.org/show_bug.cgi?id=679072 */
-	TEST_XML_ERROR_HANDLING ("<id>ID</id><updated>2009-01-25T14:07:37.880860Z</updated>"); /* missing title */
-#endif
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	log = request_log_start ();
 
-	/* subtitle */
-	TEST_XML_ERROR_HANDLING ("<subtitle>First subtitle</subtitle><subtitle>Second subtitle</subtitle>"); /* duplicate subtitle */
+	gdata_test_mock_server_start_trace (mock_server, "redirect-cache");
 
-	/* id */
-	TEST_XML_ERROR_HANDLING ("<id>First ID</id><id>Second ID</id>"); /* duplicate ID */
-	TEST_XML_ERROR_HANDLING ("<title>Title</title><updated>2009-01-25T14:07:37.880860Z</updated>"); /* missing ID */
+	/* A permanent redirect is followed, and later requests for the same URI go straight to the new one */
+	query_redirected_entry (service, "moved");
+	query_redirected_entry (service, "moved");
 
-	/* updated */
-	TEST_XML_ERROR_HANDLING ("<updated>2009-01-25T14:07:37.880860Z</updated>"
-	                         "<updated>2009-01-25T14:07:37.880860Z</updated>"); /* duplicate updated */
-	TEST_XML_ERROR_HANDLING ("<updated>not a date</updated>"); /* invalid date */
-	TEST_XML_ERROR_HANDLING ("<title>Title</title><id>ID</id>"); /* missing updated */
+	g_assert_cmpuint (request_log_get_length (log), ==, 3);
+	g_assert_cmpstr (request_log_get (log, 0)->path_and_query, ==, "/feeds/general/moved");
+	g_assert_cmpstr (request_log_get (log, 1)->path_and_query, ==, "/feeds/general/entry");
+	g_assert_cmpstr (request_log_get (log, 2)->path_and_query, ==, "/feeds/general/entry");
 
-	/* category */
-	TEST_XML_ERROR_HANDLING ("<category/>"); /* invalid category */
+	/* A temporary redirect is followed every time */
+	query_redirected_entry (service, "found");
+	query_redirected_entry (service, "found");
 
-	/* logo */
-	TEST_XML_ERROR_HANDLING ("<logo>First logo</logo><logo>Second logo</logo>"); /* duplicate logo */
+	g_assert_cmpuint (request_log_get_length (log), ==, 7);
+	g_assert_cmpstr (request_log_get (log, 3)->path_and_query, ==, "/feeds/general/found");
+	g_assert_cmpstr (request_log_get (log, 5)->path_and_query, ==, "/feeds/general/found");
 
-	/* icon */
-	TEST_XML_ERROR_HANDLING ("<icon>First icon</icon><icon>Second icon</icon>"); /* duplicate icon */
+	/* Only the 128 most recent permanent redirects are remembered, so filling the cache with other redirects forgets the first one */
+	for (i = 1; i <= 128; i++) {
+		gchar *path = g_strdup_printf ("moved-%u", i);
+		query_redirected_entry (service, path);
+		g_free (path);
+	}
 
-	/* link */
-	TEST_XML_ERROR_HANDLING ("<link/>"); /* invalid link */
+	g_assert_cmpuint (request_log_get_length (log), ==, 7 + 128 * 2);
 
-	/* author */
-	TEST_XML_ERROR_HANDLING ("<author/>"); /* invalid author */
+	query_redirected_entry (service, "moved");
 
-	/* generator */
-	TEST_XML_ERROR_HANDLING ("<generator>First generator</generator><generator>Second generator</generator>"); /* duplicate generator */
-	TEST_XML_ERROR_HANDLING ("<generator uri=''/>"); /* invalid generator */
+	g_assert_cmpuint (request_log_get_length (log), ==, 7 + 128 * 2 + 2);
+	g_assert_cmpstr (request_log_get (log, 7 + 128 * 2)->path_and_query, ==, "/feeds/general/moved");
 
-	/* openSearch:totalResults */
-	TEST_XML_ERROR_HANDLING ("<openSearch:totalResults>5</openSearch:totalResults>"
-	                         "<openSearch:totalResults>3</openSearch:totalResults>"); /* duplicate totalResults */
-	TEST_XML_ERROR_HANDLING ("<openSearch:totalResults></openSearch:totalResults>"); /* missing content */
-	TEST_XML_ERROR_HANDLING ("<openSearch:totalResults>this isn't a number!</openSearch:totalResults>"); /* invalid number */
+	/* The most recent ones are still remembered */
+	query_redirected_entry (service, "moved-128");
 
-	/* openSearch:startIndex */
-	TEST_XML_ERROR_HANDLING ("<openSearch:startIndex>5</openSearch:startIndex>"
-	                         "<openSearch:startIndex>3</openSearch:startIndex>"); /* duplicate startIndex */
-	TEST_XML_ERROR_HANDLING ("<openSearch:startIndex></openSearch:startIndex>"); /* missing content */
-	TEST_XML_ERROR_HANDLING ("<openSearch:startIndex>this isn't a number!</openSearch:startIndex>"); /* invalid number */
+	g_assert_cmpuint (request_log_get_length (log), ==, 7 + 128 * 2 + 3);
+	g_assert_cmpstr (request_log_get (log, 7 + 128 * 2 + 2)->path_and_query, ==, "/feeds/general/entry");
 
-	/* openSearch:itemsPerPage */
-	TEST_XML_ERROR_HANDLING ("<openSearch:itemsPerPage>5</openSearch:itemsPerPage>"
-	                         "<openSearch:itemsPerPage>3</openSearch:itemsPerPage>"); /* duplicate itemsPerPage */
-	TEST_XML_ERROR_HANDLING ("<openSearch:itemsPerPage></openSearch:itemsPerPage>"); /* missing content */
-	TEST_XML_ERROR_HANDLING ("<openSearch:itemsPerPage>this isn't a number!</openSearch:itemsPerPage>"); /* invalid number */
+	uhm_server_end_trace (mock_server);
 
-#undef TEST_XML_ERROR_HANDLING
+	request_log_stop (log);
+	g_object_unref (service);
 }
 
 static void
-test_feed_escaping (void)
+test_service_send_async_unauthorized (void)
 {
-	GDataFeed *feed;
-	GError *error = NULL;
+	GDataService *service;
+	GDataAuthorizer *authorizer;
+	RequestLog *log;
 
-	/* Since we can't construct a GDataEntry directly, we need to parse it from XML */
-	feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED,
-		"<?xml version='1.0' encoding='UTF-8'?>"
-		"<feed xmlns='http://www.w3.org/2005/Atom'>"
-			"<id>http://foo.com?foo&amp;bar</id>"
-			"<updated>2010-12-10T17:49:15Z</updated>"
-			"<title type='text'>Test feed &amp; stuff.</title>"
-		"</feed>", -1, &error));
-	g_assert_no_error (error);
-	g_assert (GDATA_IS_FEED (feed));
+	if (skip_if_not_offline () == TRUE)
+		return;
 
-	/* Check the outputted XML is escaped properly */
-	gdata_test_assert_xml (feed,
-		"<?xml version='1.0' encoding='UTF-8'?>"
-		"<feed xmlns='http://www.w3.org/2005/Atom'>"
-			"<title type='text'>Test feed &amp; stuff.</title>"
-			"<id>http://foo.com?foo&amp;bar</id>"
-			"<updated>2010-12-10T17:49:15Z</updated>"
-		"</feed>");
-	g_object_unref (feed);
-}
+	authorizer = g_object_new (TYPE_TEST_AUTHORIZER, NULL);
+	service = g_object_new (GDATA_TYPE_SERVICE, "authorizer", authorizer, NULL);
+	log = request_log_start ();
 
-static void
-test_query_categories (void)
-{
-	GDataQuery *query;
-	gchar *query_uri;
+	/* The first attempt is rejected, so the authorization is refreshed and the message is sent again with the new token */
+	gdata_test_mock_server_start_trace (mock_server, "send-async-unauthorized");
+	insert_entry_async_and_check (service, "https://www.google.com/feeds/general/unauthorized");
+	uhm_server_end_trace (mock_server);
 
-	query = gdata_query_new ("foobar");
+	g_assert_cmpint (TEST_AUTHORIZER (authorizer)->n_refreshes, ==, 1);
+	g_assert_cmpuint (request_log_get_length (log), ==, 2);
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 0)->headers, "Authorization"), ==, "Bearer token-1");
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 1)->headers, "Authorization"), ==, "Bearer token-2");
 
-	/* AND */
-	gdata_query_set_categories (query, "Fritz/Laurie");
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/-/Fritz/Laurie?q=foobar");
-	g_free (query_uri);
+	request_log_stop (log);
+	g_object_unref (service);
+	g_object_unref (authorizer);
+}
 
-	/* OR */
-	gdata_query_set_categories (query, "Fritz|Laurie");
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/-/Fritz%7CLaurie?q=foobar");
-	g_free (query_uri);
+typedef struct {
+	guint n_entries;
+	guint n_start_index_notifications;
+	guint n_max_results_notifications;
+} QueryAllData;
 
-	/* Combination */
-	gdata_query_set_categories (query, "A|-{urn:google.com}B/-C");
-	query_uri = gdata_query_get_query_uri (query, "http://example.com/gdata_test");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/gdata_test/-/A%7C-%7Burn%3Agoogle.com%7DB/-C?q=foobar");
-	g_free (query_uri);
+static void
+query_all_progress_cb (GDataEntry *entry, guint entry_key, guint entry_count, QueryAllData *data)
+{
+	gchar *expected_id;
 
-	/* Same combination without q param */
-	gdata_query_set_q (query, NULL);
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/-/A%7C-%7Burn%3Agoogle.com%7DB/-C");
-	g_free (query_uri);
+	/* Entries are delivered in result order, with keys counting across all the pages */
+	g_assert_cmpuint (entry_key, ==, data->n_entries);
+	g_assert_cmpuint (entry_count, ==, 5);
 
-	g_object_unref (query);
+	expected_id = g_strdup_printf ("urn:entry:%u", entry_key + 1);
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, expected_id);
+	g_free (expected_id);
+
+	data->n_entries++;
 }
 
 static void
-test_query_dates (void)
+query_all_notify_cb (GDataQuery *query, GParamSpec *pspec, QueryAllData *data)
 {
-	GDataQuery *query;
-	gchar *query_uri;
+	if (strcmp (pspec->name, "start-index") == 0)
+		data->n_start_index_notifications++;
+	else if (strcmp (pspec->name, "max-results") == 0)
+		data->n_max_results_notifications++;
+}
 
-	query = gdata_query_new ("baz");
+/* Checks the feed of all the results of a query made by test_service_query_all() or its asynchronous version, and that the query wasn't changed
+ * while the pages' URIs were built */
+static void
+check_query_all_results (GDataFeed *feed, GDataQuery *query, QueryAllData *data)
+{
+	GList *entries, *i;
+	guint n;
 
-	/* updated-min */
-	gdata_query_set_updated_min (query, 1373280114); /* 2013-07-08T10:41:54Z */
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com?q=baz&updated-min=2013-07-08T10:41:54Z");
-	g_free (query_uri);
-	gdata_query_set_updated_min (query, -1);
+	g_assert (GDATA_IS_FEED (feed));
 
-	/* updated-max */
-	gdata_query_set_updated_max (query, 1373280114); /* 2013-07-08T10:41:54Z */
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com?q=baz&updated-max=2013-07-08T10:41:54Z");
-	g_free (query_uri);
-	gdata_query_set_updated_max (query, -1);
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, 5);
 
-	/* published-min */
-	gdata_query_set_published_min (query, 1373280114); /* 2013-07-08T10:41:54Z */
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com?q=baz&published-min=2013-07-08T10:41:54Z");
-	g_free (query_uri);
-	gdata_query_set_published_min (query, -1);
+	for (i = entries, n = 1; i != NULL; i = i->next, n++) {
+		gchar *expected_id = g_strdup_printf ("urn:entry:%u", n);
+		g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (i->data)), ==, expected_id);
+		g_free (expected_id);
+	}
 
-	/* published-max */
-	gdata_query_set_published_max (query, 1373280114); /* 2013-07-08T10:41:54Z */
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com?q=baz&published-max=2013-07-08T10:41:54Z");
-	g_free (query_uri);
-	gdata_query_set_published_max (query, -1);
+	g_assert_cmpuint (data->n_entries, ==, 5);
 
-	g_object_unref (query);
+	g_assert_cmpuint (gdata_query_get_start_index (query), ==, 0);
+	g_assert_cmpuint (gdata_query_get_max_results (query), ==, 2);
+	g_assert_cmpuint (data->n_start_index_notifications, ==, 0);
+	g_assert_cmpuint (data->n_max_results_notifications, ==, 0);
 }
 
 static void
-test_query_strict (void)
+test_service_query_all (void)
 {
+	GDataService *service;
 	GDataQuery *query;
-	gchar *query_uri;
+	GDataFeed *feed;
+	QueryAllData data = { 0, };
+	GError *error = NULL;
 
-	query = gdata_query_new ("bar");
+	if (skip_if_not_offline () == TRUE)
+		return;
 
-	gdata_query_set_is_strict (query, TRUE);
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com?q=bar&strict=true");
-	g_free (query_uri);
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	query = gdata_query_new_with_limits (NULL, 0, 2);
+	g_signal_connect (query, "notify", (GCallback) query_all_notify_cb, &data);
 
-	gdata_query_set_is_strict (query, FALSE);
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com?q=bar");
-	g_free (query_uri);
+	/* The first page says there are five results, so the other two pages are requested by start index, one at a time so that they're in the
+	 * order of the trace */
+	gdata_test_mock_server_start_trace (mock_server, "query-all");
 
+	feed = gdata_service_query_all (service, NULL, "https://www.google.com/feeds/general/query-all", query, GDATA_TYPE_ENTRY, 1, NULL,
+	                                (GDataQueryProgressCallback) query_all_progress_cb, &data, &error);
+	g_assert_no_error (error);
+	check_query_all_results (feed, query, &data);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (feed);
 	g_object_unref (query);
+	g_object_unref (service);
 }
 
 static void
-test_query_pagination (void)
+test_service_query_all_async (void)
 {
+	GDataService *service;
 	GDataQuery *query;
-	gchar *query_uri;
+	GDataFeed *feed;
+	GAsyncResult *async_result = NULL;
+	QueryAllData data = { 0, };
+	GError *error = NULL;
 
-	query = gdata_query_new ("test");
-	gdata_query_set_max_results (query, 15);
-	gdata_query_set_etag (query, "etag"); /* this should be cleared by pagination */
+	if (skip_if_not_offline () == TRUE)
+		return;
 
-	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&max-results=15");
-	g_free (query_uri);
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	query = gdata_query_new_with_limits (NULL, 0, 2);
+	g_signal_connect (query, "notify", (GCallback) query_all_notify_cb, &data);
 
-	/* Try the next and previous pages. */
-	gdata_query_next_page (query);
-	g_assert (gdata_query_get_etag (query) == NULL);
+	/* As above, but the page URIs are built in a worker thread, while the query is still owned by this one */
+	gdata_test_mock_server_start_trace (mock_server, "query-all-async");
 
-	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=16&max-results=15");
-	g_free (query_uri);
+	gdata_service_query_all_async (service, NULL, "https://www.google.com/feeds/general/query-all-async", query, GDATA_TYPE_ENTRY, 1, NULL,
+	                               (GDataQueryProgressCallback) query_all_progress_cb, &data, NULL, (GAsyncReadyCallback) async_ready_cb,
+	                               &async_result);
+	feed = gdata_service_query_finish (service, wait_for_async_result (&async_result), &error);
+	g_assert_no_error (error);
 
-	gdata_query_set_etag (query, "etag");
-	g_assert (gdata_query_previous_page (query) == TRUE);
-	g_assert (gdata_query_get_etag (query) == NULL);
+	/* Progress callbacks are dispatched in idles, so may still be pending */
+	while (data.n_entries < 5)
+		g_main_context_iteration (NULL, TRUE);
 
-	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&max-results=15");
-	g_free (query_uri);
+	check_query_all_results (feed, query, &data);
 
-	/* Try another previous page. This should fail, and the ETag should be untouched. */
-	gdata_query_set_etag (query, "etag");
-	g_assert (gdata_query_previous_page (query) == FALSE);
-	g_assert_cmpstr (gdata_query_get_etag (query), ==, "etag");
+	uhm_server_end_trace (mock_server);
 
+	g_object_unref (async_result);
+	g_object_unref (feed);
 	g_object_unref (query);
+	g_object_unref (service);
+}
 
-	/* Try the alternate constructor. */
-	query = gdata_query_new_with_limits ("test", 40, 10);
+static void
+test_service_query_all_short_page (void)
+{
+	GDataService *service;
+	GDataQuery *query;
+	GDataFeed *feed;
+	GList *entries, *i;
+	QueryAllData data = { 0, };
+	guint n;
+	GError *error = NULL;
 
-	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=40&max-results=10");
-	g_free (query_uri);
+	if (skip_if_not_offline () == TRUE)
+		return;
 
-	/* Try the next and previous pages again. */
-	gdata_query_next_page (query);
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	query = gdata_query_new_with_limits (NULL, 0, 2);
+
+	/* The second page only has one of its two entries, so the entry keys of the third page's entries follow on from the entries actually
+	 * delivered rather than from the page's start index */
+	gdata_test_mock_server_start_trace (mock_server, "query-all-short-page");
 
-	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=50&max-results=10");
-	g_free (query_uri);
+	feed = gdata_service_query_all (service, NULL, "https://www.google.com/feeds/general/query-all-short-page", query, GDATA_TYPE_ENTRY, 1,
+	                                NULL, (GDataQueryProgressCallback) query_all_progress_cb, &data, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
 
-	g_assert (gdata_query_previous_page (query) == TRUE);
+	uhm_server_end_trace (mock_server);
 
-	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=40&max-results=10");
-	g_free (query_uri);
+	g_assert_cmpuint (data.n_entries, ==, 4);
 
-	g_assert (gdata_query_previous_page (query) == TRUE);
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, 4);
 
-	query_uri = gdata_query_get_query_uri (query, "http://example.com/");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/?q=test&start-index=30&max-results=10");
-	g_free (query_uri);
+	for (i = entries, n = 1; i != NULL; i = i->next, n++) {
+		gchar *expected_id = g_strdup_printf ("urn:entry:%u", n);
+		g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (i->data)), ==, expected_id);
+		g_free (expected_id);
+	}
 
+	g_object_unref (feed);
 	g_object_unref (query);
+	g_object_unref (service);
 }
 
 static void
-notify_cb (GObject *obj, GParamSpec *pspec, gpointer user_data)
+query_all_next_links_progress_cb (GDataEntry *entry, guint entry_key, guint entry_count, QueryAllData *data)
 {
-	gboolean *notification_received = user_data;
-	g_assert (*notification_received == FALSE);
-	*notification_received = TRUE;
+	gchar *expected_id;
+
+	/* The feed doesn't report its size, so the entry count only covers the pages fetched so far */
+	g_assert_cmpuint (entry_key, ==, data->n_entries);
+	g_assert_cmpuint (entry_count, >, entry_key);
+
+	expected_id = g_strdup_printf ("urn:entry:%u", entry_key + 1);
+	g_assert_cmpstr (gdata_entry_get_id (entry), ==, expected_id);
+	g_free (expected_id);
+
+	data->n_entries++;
 }
 
 static void
-test_query_properties (void)
+test_service_query_all_next_links (gconstpointer max_concurrent_pages)
 {
+	GDataService *service;
 	GDataQuery *query;
-	gboolean notification_received = FALSE;
-	gulong handler_id;
+	GDataFeed *feed;
+	GList *entries, *i;
+	QueryAllData data = { 0, };
+	guint n;
+	GError *error = NULL;
 
-	query = gdata_query_new ("default");
+	if (skip_if_not_offline () == TRUE)
+		return;
 
-#define CHECK_PROPERTY(cmptype, name_hyphens, name_underscores, default_val, new_val, new_val2, val_type, free_val) \
-	{ \
-		val_type val; \
- \
-		handler_id = g_signal_connect (query, "notify::" name_hyphens, (GCallback) notify_cb, &notification_received); \
- \
-		g_assert_##cmptype (gdata_query_get_##name_underscores (query), ==, default_val); \
-		g_object_get (query, name_hyphens, &val, NULL); \
-		g_assert_##cmptype (val, ==, default_val); \
-		if (free_val == TRUE) { \
-			g_free ((gpointer) ((guintptr) val)); \
-		} \
- \
-		notification_received = FALSE; \
-		gdata_query_set_##name_underscores (query, new_val); \
-		g_assert (notification_received == TRUE); \
- \
-		g_assert_##cmptype (gdata_query_get_##name_underscores (query), ==, new_val); \
- \
-		notification_received = FALSE; \
-		g_object_set (query, name_hyphens, new_val2, NULL); \
-		g_assert (notification_received == TRUE); \
- \
-		g_assert_##cmptype (gdata_query_get_##name_underscores (query), ==, new_val2); \
- \
-		g_signal_handler_disconnect (query, handler_id); \
-	}
-#define CHECK_PROPERTY_STR(name_hyphens, name_underscores, default_val) \
-	CHECK_PROPERTY (cmpstr, name_hyphens, name_underscores, default_val, "new", "new2", gchar*, TRUE)
-#define CHECK_PROPERTY_INT64(name_hyphens, name_underscores, default_val) \
-	CHECK_PROPERTY (cmpint, name_hyphens, name_underscores, default_val, 123, 5134132, gint64, FALSE)
-#define CHECK_PROPERTY_UINT(name_hyphens, name_underscores, default_val) \
-	CHECK_PROPERTY (cmpuint, name_hyphens, name_underscores, default_val, 535, 123, guint, FALSE)
-#define CHECK_PROPERTY_BOOLEAN(name_hyphens, name_underscores, default_val) \
-	CHECK_PROPERTY (cmpuint, name_hyphens, name_underscores, default_val, TRUE, FALSE, gboolean, FALSE)
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	query = gdata_query_new_with_limits (NULL, 0, 2);
 
-	CHECK_PROPERTY_STR ("q", q, "default");
-	CHECK_PROPERTY_STR ("categories", categories, NULL);
-	CHECK_PROPERTY_STR ("author", author, NULL);
-	CHECK_PROPERTY_INT64 ("updated-min", updated_min, -1);
-	CHECK_PROPERTY_INT64 ("updated-max", updated_max, -1);
-	CHECK_PROPERTY_INT64 ("published-min", published_min, -1);
-	CHECK_PROPERTY_INT64 ("published-max", published_max, -1);
-	CHECK_PROPERTY_UINT ("start-index", start_index, 0);
-#define gdata_query_get_is_strict gdata_query_is_strict
-	CHECK_PROPERTY_BOOLEAN ("is-strict", is_strict, FALSE);
-#undef gdata_query_get_is_strict
-	CHECK_PROPERTY_UINT ("max-results", max_results, 0);
-	CHECK_PROPERTY_STR ("etag", etag, NULL);
+	/* None of the pages have a totalResults element, so the pages have to be found by following their next links. With more than one page
+	 * thread, each page is requested while the previous one is still being parsed, but since each request still depends on the previous page's
+	 * next link, they're made in the order of the trace. The fourth page is empty, which ends the results, even though it has a next link. */
+	gdata_test_mock_server_start_trace (mock_server, "query-all-next-links");
 
-#undef CHECK_PROPERTY_BOOLEAN
-#undef CHECK_PROPERTY_UINT
-#undef CHECK_PROPERTY_INT64
-#undef CHECK_PROPERTY_STR
-#undef CHECK_PROPERTY
+	feed = gdata_service_query_all (service, NULL, "https://www.google.com/feeds/general/query-all-next-links", query, GDATA_TYPE_ENTRY,
+	                                GPOINTER_TO_UINT (max_concurrent_pages), NULL,
+	                                (GDataQueryProgressCallback) query_all_next_links_progress_cb, &data, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpuint (data.n_entries, ==, 5);
 
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, 5);
+
+	for (i = entries, n = 1; i != NULL; i = i->next, n++) {
+		gchar *expected_id = g_strdup_printf ("urn:entry:%u", n);
+		g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (i->data)), ==, expected_id);
+		g_free (expected_id);
+	}
+
+	g_object_unref (feed);
 	g_object_unref (query);
+	g_object_unref (service);
 }
 
+typedef struct {
+	GMainContext *context;
+	guint n_batches;
+	guint n_entries;
+	gboolean destroyed;
+} QueryBatchedData;
+
 static void
-test_query_unicode (void)
+query_batched_progress_cb (GPtrArray *entries, guint first_entry_key, guint entry_count, QueryBatchedData *data)
 {
-	GDataQuery *query;
-	gchar *query_uri;
+	guint i;
+
+	/* Batches are delivered in the context which started the query, in order, and at most two entries at a time */
+	g_assert (g_main_context_get_thread_default () == data->context);
+	g_assert (data->destroyed == FALSE);
+	g_assert_cmpuint (first_entry_key, ==, data->n_entries);
+	g_assert_cmpuint (entries->len, ==, MIN (2, 5 - data->n_entries));
+	g_assert_cmpuint (entry_count, ==, 5);
+
+	for (i = 0; i < entries->len; i++) {
+		gchar *expected_id = g_strdup_printf ("urn:entry:%u", first_entry_key + i + 1);
+		g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (entries->pdata[i])), ==, expected_id);
+		g_free (expected_id);
+	}
 
-	g_test_bug ("602497");
+	data->n_batches++;
+	data->n_entries += entries->len;
+}
 
-	/* Simple query */
-	query = gdata_query_new ("fööbar‽");
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com?q=f%C3%B6%C3%B6bar%E2%80%BD");
-	g_free (query_uri);
+static void
+query_batched_destroy_cb (QueryBatchedData *data)
+{
+	g_assert (g_main_context_get_thread_default () == data->context);
+	data->destroyed = TRUE;
+}
 
-	/* Categories */
-	gdata_query_set_categories (query, "Ümlauts|¿Questions‽");
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/-/%C3%9Cmlauts%7C%C2%BFQuestions%E2%80%BD?q=f%C3%B6%C3%B6bar%E2%80%BD");
-	g_free (query_uri);
+static void
+query_batched_ready_cb (GObject *source_object, GAsyncResult *async_result, GAsyncResult **async_result_out)
+{
+	QueryBatchedData *data = g_object_get_data (source_object, "query-batched-data");
 
-	/* Author */
-	gdata_query_set_author (query, "Lørd Brïan Bleßêd");
-	query_uri = gdata_query_get_query_uri (query, "http://example.com");
-	g_assert_cmpstr (query_uri, ==, "http://example.com/-/%C3%9Cmlauts%7C%C2%BFQuestions%E2%80%BD?q=f%C3%B6%C3%B6bar%E2%80%BD&author=L%C3%B8rd%20Br%C3%AFan%20Ble%C3%9F%C3%AAd");
-	g_free (query_uri);
+	/* All the batches have been delivered by the time the query finishes */
+	g_assert (g_main_context_get_thread_default () == data->context);
+	g_assert_cmpuint (data->n_batches, ==, 3);
 
-	g_object_unref (query);
+	*async_result_out = g_object_ref (async_result);
 }
 
 static void
-test_query_etag (void)
+test_service_query_batched_async (void)
 {
-	GDataQuery *query = gdata_query_new (NULL);
+	GDataService *service;
+	GDataFeed *feed;
+	GAsyncResult *async_result = NULL;
+	QueryBatchedData data = { NULL, 0, 0, FALSE };
+	GError *error = NULL;
 
-	/* Test that setting any property will unset the ETag */
-	g_test_bug ("613529");
+	if (skip_if_not_offline () == TRUE)
+		return;
 
-	/* Also check that setting the ETag doesn't unset the ETag! */
-	gdata_query_set_etag (query, "foobar");
-	g_assert_cmpstr (gdata_query_get_etag (query), ==, "foobar");
+	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	g_object_set_data (G_OBJECT (service), "query-batched-data", &data);
 
-#define CHECK_ETAG(C) \
-	gdata_query_set_etag (query, "foobar");		\
-	(C);						\
-	g_assert (gdata_query_get_etag (query) == NULL);
+	/* Run the query from a context other than the global default one; nothing should be dispatched in the default context */
+	data.context = g_main_context_new ();
+	g_main_context_push_thread_default (data.context);
 
-	CHECK_ETAG (gdata_query_set_q (query, "q"))
-	CHECK_ETAG (gdata_query_set_categories (query, "shizzle,foobar"))
-	CHECK_ETAG (gdata_query_set_author (query, "John Smith"))
-	CHECK_ETAG (gdata_query_set_updated_min (query, -1))
-	CHECK_ETAG (gdata_query_set_updated_max (query, -1))
-	CHECK_ETAG (gdata_query_set_published_min (query, -1))
-	CHECK_ETAG (gdata_query_set_published_max (query, -1))
-	CHECK_ETAG (gdata_query_set_start_index (query, 5))
-	CHECK_ETAG (gdata_query_set_is_strict (query, TRUE))
-	CHECK_ETAG (gdata_query_set_max_results (query, 1000))
-	CHECK_ETAG (gdata_query_next_page (query))
-	CHECK_ETAG (gdata_query_previous_page (query))
+	gdata_test_mock_server_start_trace (mock_server, "query-batched-async");
 
-#undef CHECK_ETAG
+	gdata_service_query_batched_async (service, NULL, "https://www.google.com/feeds/general/query-batched-async", NULL, GDATA_TYPE_ENTRY, 2, 0,
+	                                   NULL, (GDataQueryBatchProgressCallback) query_batched_progress_cb, &data,
+	                                   (GDestroyNotify) query_batched_destroy_cb, (GAsyncReadyCallback) query_batched_ready_cb, &async_result);
 
-	g_object_unref (query);
+	while (async_result == NULL || data.destroyed == FALSE)
+		g_main_context_iteration (data.context, TRUE);
+
+	feed = gdata_service_query_finish (service, async_result, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (feed)), ==, 5);
+
+	g_assert_cmpuint (data.n_batches, ==, 3);
+	g_assert_cmpuint (data.n_entries, ==, 5);
+
+	uhm_server_end_trace (mock_server);
+
+	g_main_context_pop_thread_default (data.context);
+	g_main_context_unref (data.context);
+
+	g_object_unref (async_result);
+	g_object_unref (feed);
+	g_object_unref (service);
 }
 
 static void
-test_service_network_error (void)
+test_service_cache_directory (void)
 {
 	GDataService *service;
-#if 0
-	SoupURI *proxy_uri;
-#endif
-	GError *error = NULL;
+	gchar *cache_directory;
 
-	/* This is a little hacky, but it should work */
 	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
 
-	/* Try a query which should always fail due to errors resolving the hostname */
-	g_assert (gdata_service_query (service, NULL, "http://thisshouldnotexist.localhost", NULL, GDATA_TYPE_ENTRY,
-	                               NULL, NULL, NULL, &error) == NULL);
-	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NETWORK_ERROR);
-	g_clear_error (&error);
+	/* Responses aren't cached by default */
+	g_assert (gdata_service_get_cache_directory (service) == NULL);
 
-	/* TODO: We have to disable this test, as libsoup 2.30.2 < x <= 2.32.0 doesn't return SOUP_STATUS_CANT_RESOLVE_PROXY properly any more.
-	 * Filed as bgo#632354. */
-#if 0
-	/* Try one with a bad proxy set */
-	proxy_uri = soup_uri_new ("http://thisshouldalsonotexist.localhost/proxy");
-	gdata_service_set_proxy_uri (service, proxy_uri);
-	soup_uri_free (proxy_uri);
+	gdata_service_set_cache_directory (service, "/tmp/libgdata-cache");
+	g_assert_cmpstr (gdata_service_get_cache_directory (service), ==, "/tmp/libgdata-cache");
 
-	g_assert (gdata_service_query (service, "http://google.com", NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL, &error) == NULL);
-	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROXY_ERROR);
-	g_clear_error (&error);
-#endif
+	g_object_get (service, "cache-directory", &cache_directory, NULL);
+	g_assert_cmpstr (cache_directory, ==, "/tmp/libgdata-cache");
+	g_free (cache_directory);
+
+	g_object_set (service, "cache-directory", NULL, NULL);
+	g_assert (gdata_service_get_cache_directory (service) == NULL);
 
 	g_object_unref (service);
 }
 
+/* Queries the cache-directory trace's feed using a new service which caches responses in @cache_directory, and checks the feed's entries */
 static void
-test_service_locale (void)
+query_cached_feed_and_check (const gchar *cache_directory)
 {
 	GDataService *service;
-	gchar *locale;
+	GDataFeed *feed;
+	GList *entries;
+	GError *error = NULL;
 
-	/* This is a little hacky, but it should work */
-	service = g_object_new (GDATA_TYPE_SERVICE, NULL);
+	service = g_object_new (GDATA_TYPE_SERVICE, "cache-directory", cache_directory, NULL);
 
-	/* Just test setting and getting the locale */
-	g_assert (gdata_service_get_locale (service) == NULL);
-	gdata_service_set_locale (service, "en_GB");
-	g_assert_cmpstr (gdata_service_get_locale (service), ==, "en_GB");
+	feed = gdata_service_query (service, NULL, "https://www.google.com/feeds/general/cache-directory", NULL, GDATA_TYPE_ENTRY, NULL, NULL, NULL,
+	                            &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
 
-	g_object_get (service, "locale", &locale, NULL);
-	g_assert_cmpstr (locale, ==, "en_GB");
-	g_free (locale);
+	entries = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (entries), ==, 2);
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (entries->data)), ==, "urn:entry:1");
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (entries->next->data)), ==, "urn:entry:2");
 
+	g_object_unref (feed);
 	g_object_unref (service);
 }
 
+static void
+test_service_cache_directory_revalidation (void)
+{
+	gchar *cache_directory;
+	GDir *dir;
+	const gchar *name;
+	RequestLog *log;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	cache_directory = g_dir_make_tmp ("libgdata-cache-XXXXXX", &error);
+	g_assert_no_error (error);
+
+	log = request_log_start ();
+	gdata_test_mock_server_start_trace (mock_server, "cache-directory");
+
+	/* The first query is unconditional, and its response is stored along with its ETag. A separate service is used for each query, as if
+	 * they were made by separate processes sharing the cache. */
+	query_cached_feed_and_check (cache_directory);
+
+	/* The streamed response was written to a temporary file as it arrived, which has replaced the cache file, and isn't left behind */
+	dir = g_dir_open (cache_directory, 0, &error);
+	g_assert_no_error (error);
+	name = g_dir_read_name (dir);
+	g_assert (name != NULL);
+	g_assert (g_str_has_suffix (name, ".tmp") == FALSE);
+	g_assert (g_dir_read_name (dir) == NULL);
+	g_dir_close (dir);
+
+	/* The second query revalidates the stored response, and gets a 304 with no body, so the feed has to be built from the cache */
+	query_cached_feed_and_check (cache_directory);
+
+	uhm_server_end_trace (mock_server);
+
+	g_assert_cmpuint (request_log_get_length (log), ==, 2);
+	g_assert (soup_message_headers_get_one (request_log_get (log, 0)->headers, "If-None-Match") == NULL);
+	g_assert_cmpstr (soup_message_headers_get_one (request_log_get (log, 1)->headers, "If-None-Match"), ==, "W/\"cached-feed-1\"");
+
+	request_log_stop (log);
+
+	/* Clean up the cache */
+	dir = g_dir_open (cache_directory, 0, &error);
+	g_assert_no_error (error);
+
+	while ((name = g_dir_read_name (dir)) != NULL) {
+		gchar *path = g_build_filename (cache_directory, name, NULL);
+		g_unlink (path);
+		g_free (path);
+	}
+
+	g_dir_close (dir);
+	g_rmdir (cache_directory);
+	g_free (cache_directory);
+}
+
 static void
 test_access_rule_get_xml (void)
 {
@@ -1633,6 +7007,12 @@ test_color_parsing (void)
 
 	/* Wildly invalid */
 	g_assert (gdata_color_from_hexadecimal ("this is not a real colour!", &color) == FALSE);
+
+	/* Too short, too long and empty */
+	g_assert (gdata_color_from_hexadecimal ("#f99ff", &color) == FALSE);
+	g_assert (gdata_color_from_hexadecimal ("#f99ff00", &color) == FALSE);
+	g_assert (gdata_color_from_hexadecimal ("#", &color) == FALSE);
+	g_assert (gdata_color_from_hexadecimal ("", &color) == FALSE);
 }
 
 static void
@@ -1659,6 +7039,154 @@ test_color_output (void)
 	g_free (color_string);
 }
 
+static void
+test_parser_iso8601_parsing (void)
+{
+	guint i;
+	const gchar *times[] = {
+		/* The form Google sends, with each kind of time zone and fraction */
+		"2005-06-06T17:00:00Z",
+		"2005-06-06T17:00:00.000Z",
+		"2005-06-06T17:00:00.123456789Z",
+		"2005-06-06T17:00:00-08:00",
+		"2005-06-06T17:00:00+05:30",
+		"2005-06-06T17:00:00-0800",
+		"2005-06-06T17:00:00+0530",
+		"2005-06-06T17:00:00.5-00:00",
+		"2005-06-06T23:30:00-23:59",
+		/* Before the epoch */
+		"1969-12-31T23:59:59Z",
+		"1969-12-31T23:59:59.999Z",
+		"1970-01-01T00:00:00+01:00",
+		"1900-01-01T00:00:00Z",
+		"1601-01-01T12:34:56-0130",
+		/* Leap days, and days which don't exist */
+		"2000-02-29T12:00:00Z",
+		"2012-02-29T23:59:59+00:00",
+		"1904-02-29T00:00:00Z",
+		"2100-02-28T23:59:59Z",
+		"1900-02-29T00:00:00Z",
+		"2013-02-29T00:00:00Z",
+		"2013-04-31T00:00:00Z",
+		/* Years outside 1000–9999 */
+		"0999-12-31T23:59:59Z",
+		"0001-01-01T00:00:00Z",
+		"1000-01-01T00:00:00Z",
+		"9999-12-31T23:59:59Z",
+		"10000-01-01T00:00:00Z",
+		/* Other forms of ISO 8601, which are left to GLib */
+		"20050606T170000Z",
+		"2005-06-06T170000Z",
+		"2005-06-06T17:00:00,5Z",
+		"2005-06-06T17:00:00+05",
+		"2005-06-06T24:00:00Z",
+		"2005-06-06T23:59:60Z",
+		"2005-06-06T17:00:00",
+		" 2005-06-06T17:00:00Z",
+		"2005-06-06T17:00:00Z ",
+		/* Invalid */
+		"2005-06-06T17:00:00.Z",
+		"2005-06-06T17:00:00+",
+		"2005-06-06T17:00:00+05:3",
+		"2005-06-06T17:00:00+05:60",
+		"2005-13-01T00:00:00Z",
+		"2005-06-06 17:00:00Z",
+		"2005-06-06T17:00:00ZZ",
+		"not a date",
+		"",
+	};
+
+	/* Whichever way the time's parsed, the result must be the same as GLib's */
+	for (i = 0; i < G_N_ELEMENTS (times); i++) {
+		GDataGDWhen *when;
+		GTimeVal time_val;
+		gchar *xml;
+		GError *error = NULL;
+
+		g_test_message ("Parsing \"%s\"", times[i]);
+
+		xml = g_strdup_printf ("<gd:when xmlns:gd='http://schemas.google.com/g/2005' startTime='%s'/>", times[i]);
+		when = GDATA_GD_WHEN (gdata_parsable_new_from_xml (GDATA_TYPE_GD_WHEN, xml, -1, &error));
+		g_free (xml);
+
+		if (g_time_val_from_iso8601 (times[i], &time_val) == TRUE) {
+			g_assert_no_error (error);
+			g_assert (GDATA_IS_GD_WHEN (when));
+			g_assert_cmpint (gdata_gd_when_get_start_time (when), ==, time_val.tv_sec);
+			g_assert (gdata_gd_when_is_date (when) == FALSE);
+			g_object_unref (when);
+		} else {
+			g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+			g_assert (when == NULL);
+			g_clear_error (&error);
+		}
+	}
+}
+
+static void
+test_parser_iso8601_formatting (void)
+{
+	guint i;
+	const gint64 times[] = {
+		0,
+		1118106000, /* 2005-06-07T01:00:00Z */
+		G_GINT64_CONSTANT (4102444799), /* 2099-12-31T23:59:59Z, past 2038 */
+		/* Before the epoch, including either side of a day boundary */
+		-2,
+		-86400,
+		-86401,
+		G_GINT64_CONSTANT (-2208988800), /* 1900-01-01T00:00:00Z */
+		/* Leap days */
+		951825600, /* 2000-02-29T12:00:00Z */
+		1330559999, /* 2012-02-29T23:59:59Z */
+		G_GINT64_CONSTANT (-2203891200), /* 1900-03-01T00:00:00Z, the day after a non-leap 28 February */
+		/* Either side of the years formatted by GLib */
+		G_GINT64_CONSTANT (-30610224000), /* 1000-01-01T00:00:00Z */
+		G_GINT64_CONSTANT (-30610224001), /* 0999-12-31T23:59:59Z */
+		G_GINT64_CONSTANT (253402300799), /* 9999-12-31T23:59:59Z */
+		G_GINT64_CONSTANT (253402300800), /* 10000-01-01T00:00:00Z */
+	};
+
+	/* Times are formatted in the same way as GLib formats them, without a fraction since they're whole seconds. Entries are used, since their
+	 * times may be before the epoch. */
+	for (i = 0; i < G_N_ELEMENTS (times); i++) {
+		GDataEntry *entry;
+		GTimeVal time_val;
+		gchar *expected, *xml, *expected_element;
+		GError *error = NULL;
+
+		time_val.tv_sec = times[i];
+		time_val.tv_usec = 0;
+		expected = g_time_val_to_iso8601 (&time_val);
+
+		if (expected == NULL) {
+			/* Newer versions of GLib can't format years after 9999, so the time can't be given to the entry in the first place */
+			g_test_message ("Skipping %" G_GINT64_FORMAT ", which GLib can't format", times[i]);
+			continue;
+		}
+
+		g_test_message ("Formatting %" G_GINT64_FORMAT " (\"%s\")", times[i], expected);
+
+		xml = g_strdup_printf ("<entry xmlns='http://www.w3.org/2005/Atom'>"
+		                         "<id>urn:entry:1</id><title type='text'>Title</title><updated>%s</updated>"
+		                       "</entry>", expected);
+		entry = GDATA_ENTRY (gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY, xml, -1, &error));
+		g_assert_no_error (error);
+		g_assert (GDATA_IS_ENTRY (entry));
+		g_assert_cmpint (gdata_entry_get_updated (entry), ==, times[i]);
+		g_free (xml);
+
+		xml = gdata_parsable_get_xml (GDATA_PARSABLE (entry));
+		expected_element = g_strdup_printf ("<updated>%s</updated>", expected);
+		g_assert (strstr (xml, expected_element) != NULL);
+		g_free (expected_element);
+		g_free (xml);
+
+		g_object_unref (entry);
+		g_free (expected);
+	}
+}
+
 /*static void
 test_media_thumbnail_parse_time (const gchar *locale)
 {
@@ -2009,6 +7537,11 @@ test_atom_link (void)
 	link2 = gdata_link_new ("http://example.com/", "http://test.com#link-type");
 	g_assert_cmpint (gdata_comparable_compare (GDATA_COMPARABLE (link1), GDATA_COMPARABLE (link2)), ==, 0);
 	gdata_link_set_content_type (link2, "text/plain");
+
+	/* The relation and content types are interned, so should be identical */
+	g_assert (gdata_link_get_relation_type (link1) == gdata_link_get_relation_type (link2));
+	g_assert (gdata_link_get_content_type (link1) == gdata_link_get_content_type (link2));
+
 	gdata_link_set_language (link2, "de");
 	gdata_link_set_title (link2, "All About Angle Brackets: <, >");
 	gdata_link_set_length (link2, 2000);
@@ -3162,6 +8695,26 @@ test_gd_when (void)
 				"<foobar/>"
 			 "</gd:when>");
 	g_object_unref (when);
+
+	/* The end time must be of the same form as the start time */
+	when = GDATA_GD_WHEN (gdata_parsable_new_from_xml (GDATA_TYPE_GD_WHEN,
+		"<gd:when xmlns:gd='http://schemas.google.com/g/2005' startTime='2005-06-06' endTime='2005-06-08T18:00:00Z'/>", -1, &error));
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (when == NULL);
+	g_clear_error (&error);
+
+	when = GDATA_GD_WHEN (gdata_parsable_new_from_xml (GDATA_TYPE_GD_WHEN,
+		"<gd:when xmlns:gd='http://schemas.google.com/g/2005' startTime='2005-06-06T17:00:00Z' endTime='2005-06-08'/>", -1, &error));
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (when == NULL);
+	g_clear_error (&error);
+
+	/* The start time is required */
+	when = GDATA_GD_WHEN (gdata_parsable_new_from_xml (GDATA_TYPE_GD_WHEN,
+		"<gd:when xmlns:gd='http://schemas.google.com/g/2005' endTime='2005-06-08T18:00:00Z'/>", -1, &error));
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (when == NULL);
+	g_clear_error (&error);
 }
 
 static void
@@ -4450,36 +10003,144 @@ test_gcontact_website_escaping (void)
 	g_object_unref (website);
 }
 
+static void
+mock_server_notify_resolver_cb (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	UhmServer *server;
+	UhmResolver *resolver;
+
+	server = UHM_SERVER (object);
+
+	/* Set up the expected domain names here */
+	resolver = uhm_server_get_resolver (server);
+
+	if (resolver != NULL) {
+		const gchar *ip_address = uhm_server_get_address (server);
+
+		uhm_resolver_add_A (resolver, "www.google.com", ip_address);
+	}
+}
+
 int
 main (int argc, char *argv[])
 {
+	GFile *trace_directory;
+
 	gdata_test_init (argc, argv);
 
+	mock_server = gdata_test_get_mock_server ();
+	g_signal_connect (G_OBJECT (mock_server), "notify::resolver", (GCallback) mock_server_notify_resolver_cb, NULL);
+	trace_directory = g_file_new_for_path (TEST_FILE_DIR "traces/general");
+	uhm_server_set_trace_directory (mock_server, trace_directory);
+	g_object_unref (trace_directory);
+
 	g_test_add_func ("/tests/xml_comparison", test_xml_comparison);
 
 	g_test_add_func ("/service/network_error", test_service_network_error);
 	g_test_add_func ("/service/locale", test_service_locale);
+	g_test_add_func ("/service/connection-pool", test_service_connection_pool);
+	g_test_add_func ("/service/max-error-response-size", test_service_max_error_response_size);
+	g_test_add_func ("/service/prepare-connections", test_service_prepare_connections);
+	g_test_add_func ("/service/entry-cache", test_service_entry_cache);
+	g_test_add_func ("/service/acl-cache", test_service_acl_cache);
+	g_test_add_func ("/cache-manager", test_cache_manager);
+	g_test_add_func ("/blob-store", test_blob_store);
+	g_test_add_func ("/service/query-entries-by-id", test_service_query_entries_by_id);
+	g_test_add_func ("/service/query-entries-by-id/empty", test_service_query_entries_by_id_empty);
+	g_test_add_func ("/watch-channel", test_watch_channel);
+	g_test_add_func ("/watch-channel/inactive", test_watch_channel_inactive);
+	g_test_add_func ("/poll-scheduler", test_poll_scheduler);
+	g_test_add_func ("/write-queue/coalescing", test_write_queue_coalescing);
+	g_test_add_func ("/write-queue/flush", test_write_queue_flush);
+	g_test_add_func ("/write-queue/requeue", test_write_queue_requeue);
+	g_test_add_func ("/write-queue/conflict", test_write_queue_conflict);
+	g_test_add_func ("/service/cache-directory", test_service_cache_directory);
+	g_test_add_func ("/service/cache-directory/revalidation", test_service_cache_directory_revalidation);
+	g_test_add_func ("/service/rate-limit", test_service_rate_limit);
+	g_test_add_func ("/service/rate-limit/scheduling", test_service_rate_limit_scheduling);
+	g_test_add_func ("/service/retry-policy", test_service_retry_policy);
+	g_test_add_func ("/service/retry-policy/transient-failures", test_service_retry_transient_failures);
+	g_test_add_func ("/service/retry-policy/truncated-body", test_service_retry_truncated_body);
+	g_test_add_func ("/service/retry-policy/async-resend", test_service_retry_async_resend);
+	g_test_add_func ("/service/bandwidth-limits", test_service_bandwidth_limits);
+	g_test_add_func ("/service/minimal-responses", test_service_minimal_responses);
+	g_test_add_func ("/service/minimal-responses/upload", test_service_minimal_responses_upload);
+	g_test_add_func ("/service/update-entries-in-place", test_service_update_entries_in_place);
+	g_test_add_func ("/service/update-entries-in-place/upload", test_service_update_entries_in_place_upload);
+	g_test_add_func ("/service/patch-entry", test_service_patch_entry);
+	g_test_add_func ("/service/hedge-delay", test_service_hedge_delay);
+	g_test_add_func ("/service/hedge-delay/slow-request", test_service_hedge_slow_request);
+	g_test_add_func ("/service/compress-requests", test_service_compress_requests);
+	g_test_add_func ("/service/compress-requests/batch", test_service_compress_requests_batch);
+	g_test_add_func ("/batch-operation/split", test_batch_operation_split);
+	g_test_add_func ("/service/shared-session", test_service_shared_session);
+	g_test_add_func ("/cancellable/deadline", test_cancellable_deadline);
+	g_test_add_func ("/service/gauges", test_service_gauges);
+	g_test_add_func ("/service/reserved-connections", test_service_reserved_connections);
+	g_test_add_func ("/service/concurrency", test_service_concurrency);
+	g_test_add_func ("/service/share-queries", test_service_share_queries);
+	g_test_add_func ("/service/send-async/redirect", test_service_send_async_redirect);
+	g_test_add_func ("/service/send-async/unauthorized", test_service_send_async_unauthorized);
+	g_test_add_func ("/service/insert-entry/streamed-xml", test_service_insert_entry_streamed_xml);
+	g_test_add_func ("/service/redirect-cache", test_service_redirect_cache);
+	g_test_add_func ("/service/query-all", test_service_query_all);
+	g_test_add_func ("/service/query-all/async", test_service_query_all_async);
+	g_test_add_func ("/service/query-all/short-page", test_service_query_all_short_page);
+	g_test_add_data_func ("/service/query-all/next-links", GUINT_TO_POINTER (1), test_service_query_all_next_links);
+	g_test_add_data_func ("/service/query-all/next-links/pipelined", GUINT_TO_POINTER (3), test_service_query_all_next_links);
+	g_test_add_func ("/service/query-batched/async", test_service_query_batched_async);
 
 	g_test_add_func ("/entry/get_xml", test_entry_get_xml);
 	g_test_add_func ("/entry/get_json", test_entry_get_json);
+	g_test_add_func ("/entry/get_json/streamed", test_entry_get_json_streamed);
 	g_test_add_func ("/entry/parse_xml", test_entry_parse_xml);
 	g_test_add_func ("/entry/parse_json", test_entry_parse_json);
+	g_test_add_func ("/entry/variant", test_entry_variant);
+	g_test_add_func ("/entry/clone", test_entry_clone);
+	g_test_add_func ("/entry/dup-properties", test_entry_dup_properties);
+	g_test_add_func ("/parsable/accounting", test_parsable_accounting);
+	g_test_add_func ("/parsable/profiling", test_parsable_profiling);
+	g_test_add_func ("/parsable/incremental", test_parsable_incremental);
+	g_test_add_func ("/entry/diff", test_entry_diff);
+	g_test_add_func ("/entry/constructed-from-xml", test_entry_constructed_from_xml);
+	if (g_test_perf () == TRUE)
+		g_test_add_func ("/entry/constructed-from-xml/perf", test_entry_constructed_from_xml_perf);
 	g_test_add_func ("/entry/error_handling/xml", test_entry_error_handling_xml);
 	g_test_add_func ("/entry/error_handling/json", test_entry_error_handling_json);
 	g_test_add_func ("/entry/escaping", test_entry_escaping);
 	g_test_add_func ("/entry/links/remove", test_entry_links_remove);
+	g_test_add_func ("/entry/dirty", test_entry_dirty);
+	g_test_add_func ("/xml-scanner/in-place", test_xml_scanner_in_place);
+	g_test_add_func ("/xml-scanner/incremental", test_xml_scanner_incremental);
+	g_test_add_func ("/xml-scanner/unsupported", test_xml_scanner_unsupported);
+	g_test_add_func ("/parsable/original-xml/unmodified", test_parsable_original_xml_unmodified);
+	g_test_add_func ("/parsable/original-xml/category", test_parsable_original_xml_category);
+	g_test_add_func ("/parsable/original-xml/child", test_parsable_original_xml_child);
+	g_test_add_func ("/parsable/original-xml/group", test_parsable_original_xml_group);
 
 	g_test_add_func ("/feed/parse_xml", test_feed_parse_xml);
+	g_test_add_func ("/feed/shared_values", test_feed_shared_values);
+	g_test_add_func ("/feed/parse_json", test_feed_parse_json);
+	g_test_add_func ("/feed/lite", test_feed_lite);
+	g_test_add_func ("/feed/snapshot", test_feed_snapshot);
+	g_test_add_func ("/feed/iterator", test_feed_iterator);
+	g_test_add_func ("/feed/look-up", test_feed_look_up);
+	g_test_add_func ("/feed/look-up/id-changed", test_feed_look_up_id_changed);
+	g_test_add_func ("/entry-store", test_entry_store);
 	g_test_add_func ("/feed/error_handling", test_feed_error_handling);
 	g_test_add_func ("/feed/escaping", test_feed_escaping);
 
 	g_test_add_func ("/query/categories", test_query_categories);
+	g_test_add_func ("/query/uri-cache", test_query_uri_cache);
 	g_test_add_func ("/query/dates", test_query_dates);
 	g_test_add_func ("/query/strict", test_query_strict);
+	g_test_add_func ("/query/fields", test_query_fields);
 	g_test_add_func ("/query/pagination", test_query_pagination);
 	g_test_add_func ("/query/properties", test_query_properties);
 	g_test_add_func ("/query/unicode", test_query_unicode);
 	g_test_add_func ("/query/etag", test_query_etag);
+	g_test_add_func ("/query/page-etags", test_query_page_etags);
+	g_test_add_func ("/query/unhandled-xml-mode", test_query_unhandled_xml_mode);
 
 	g_test_add_func ("/access-rule/get_xml", test_access_rule_get_xml);
 	g_test_add_func ("/access-rule/error_handling", test_access_rule_error_handling);
@@ -4490,6 +10151,9 @@ main (int argc, char *argv[])
 	g_test_add_func ("/color/parsing", test_color_parsing);
 	g_test_add_func ("/color/output", test_color_output);
 
+	g_test_add_func ("/parser/iso8601/parsing", test_parser_iso8601_parsing);
+	g_test_add_func ("/parser/iso8601/formatting", test_parser_iso8601_formatting);
+
 	g_test_add_func ("/atom/author", test_atom_author);
 	g_test_add_func ("/atom/author/error_handling", test_atom_author_error_handling);
 	g_test_add_func ("/atom/author/escaping", test_atom_author_escaping);
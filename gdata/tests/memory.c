@@ -17,61 +17,586 @@
  * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/*
+ * Memory footprint regression tests.
+ *
+ * Each test replays a recorded query trace from traces/ against the mock server, and measures three things while the resulting feed is parsed:
+ *  - peak-heap: the highest number of live heap bytes above the level at the start of the query;
+ *  - retained-heap-per-entry: the heap still held by the returned feed once the query has finished, divided by its number of entries; and
+ *  - allocations: the number of allocations made during the query.
+ *
+ * Each query is run once to warm up type classes and other caches, then again to be measured. The mock server runs in-process, so its allocations
+ * are included in peak-heap and allocations; they're constant for a given trace, so this doesn't affect comparisons between revisions.
+ *
+ * The measurements are compared against the baselines in memory-baselines.ini, and a test fails if any of them exceeds its baseline by more than
+ * BASELINE_TOLERANCE. Measurements with no baseline are reported but not checked, so until baselines have been recorded for the platform the tests
+ * are run on, only the scaling checks below can fail. Running with --update-baselines rewrites the baselines file with the current measurements
+ * instead; this should be done (and the result committed) whenever a footprint change is intentional.
+ *
+ * The scale tests parse feeds from the synthetic feed generator at SCALE_SMALL_ENTRIES and SCALE_LARGE_ENTRIES entries, and check that the peak
+ * heap and retained heap per entry at the larger size don't exceed those at the smaller size by more than BASELINE_TOLERANCE: parsing should use
+ * memory linearly in the size of the feed. The per-entry measurements at the larger size are also checked against baselines.
+ *
+ * Heap usage can only be measured on glibc; elsewhere, the tests are skipped.
+ */
+
 #include <glib.h>
+#include <string.h>
 
 #include "gdata.h"
 #include "common.h"
+#include "feed-generator.h"
+
+#define BASELINES_FILE TEST_FILE_DIR "memory-baselines.ini"
+#define BASELINE_TOLERANCE 0.10 /* fraction of the baseline */
+#define SCALE_SMALL_ENTRIES 1000
+#define SCALE_LARGE_ENTRIES 10000
+#define SCALE_EXTENSION_ELEMENTS 4
+#define SCALE_UNKNOWN_ELEMENTS 4
+
+#define DEVELOPER_KEY "AI39si7Me3Q7zYs6hmkFvpRBD2nrkVjYYsUO5lh_3HdOkGRc9g6Z4nzxZatk_aAo2EsA21k7vrda0OO6oFg2rnhMedZXPyXoEw"
+#define PW_USERNAME "libgdata.picasaweb@gmail.com"
+
+static UhmServer *mock_server = NULL;
+static GKeyFile *baselines = NULL;
+static gboolean update_baselines = FALSE;
+static gboolean have_baselines = FALSE; /* whether the baselines file has any baselines in it at all */
+
+/*
+ * Heap accounting.
+ *
+ * As in perf.c, malloc() and friends are replaced on glibc so that every allocation made by the process (including those made by libxml and
+ * libsoup) is seen. malloc_usable_size() gives the size of each block as it's allocated and freed, so the number of live bytes can be tracked.
+ * G_SLICE=always-malloc is set in main() so that slice allocations are included.
+ *
+ * The aligned allocation functions have to be replaced too, even though they're rarely used: their blocks are released with free(), so any which
+ * weren't counted as they were allocated would make the number of live bytes drift downwards.
+ */
+#ifdef __GLIBC__
+#include <errno.h>
+#include <malloc.h>
+
+#define HAVE_HEAP_ACCOUNTING 1
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t n_members, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+extern void __libc_free (void *ptr);
+
+static volatile gsize n_allocations = 0;
+static volatile gssize live_bytes = 0;
+static volatile gssize peak_live_bytes = 0;
+
+static void
+account_allocation (void *ptr)
+{
+	gssize live, peak;
+
+	if (ptr == NULL)
+		return;
+
+	live = __sync_add_and_fetch (&live_bytes, (gssize) malloc_usable_size (ptr));
+
+	do {
+		peak = peak_live_bytes;
+	} while (live > peak && __sync_bool_compare_and_swap (&peak_live_bytes, peak, live) == FALSE);
+}
 
 static void
-test_query_events (void)
+account_free (void *ptr)
+{
+	if (ptr != NULL)
+		__sync_sub_and_fetch (&live_bytes, (gssize) malloc_usable_size (ptr));
+}
+
+void *
+malloc (size_t size)
+{
+	void *ptr;
+
+	__sync_fetch_and_add (&n_allocations, 1);
+	ptr = __libc_malloc (size);
+	account_allocation (ptr);
+
+	return ptr;
+}
+
+void *
+calloc (size_t n_members, size_t size)
+{
+	void *ptr;
+
+	__sync_fetch_and_add (&n_allocations, 1);
+	ptr = __libc_calloc (n_members, size);
+	account_allocation (ptr);
+
+	return ptr;
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+	void *new_ptr;
+	size_t old_size;
+
+	if (ptr == NULL)
+		__sync_fetch_and_add (&n_allocations, 1);
+
+	/* The old block has to be measured before it's potentially freed. If the reallocation fails, it's left untouched. */
+	old_size = (ptr != NULL) ? malloc_usable_size (ptr) : 0;
+	new_ptr = __libc_realloc (ptr, size);
+
+	if (new_ptr != NULL || size == 0) {
+		__sync_sub_and_fetch (&live_bytes, (gssize) old_size);
+		account_allocation (new_ptr);
+	}
+
+	return new_ptr;
+}
+
+void *
+memalign (size_t alignment, size_t size)
+{
+	void *ptr;
+
+	__sync_fetch_and_add (&n_allocations, 1);
+	ptr = __libc_memalign (alignment, size);
+	account_allocation (ptr);
+
+	return ptr;
+}
+
+void *
+aligned_alloc (size_t alignment, size_t size)
+{
+	/* glibc implements aligned_alloc() as memalign() */
+	return memalign (alignment, size);
+}
+
+int
+posix_memalign (void **memptr, size_t alignment, size_t size)
+{
+	void *ptr;
+
+	/* Unlike memalign(), posix_memalign() has to reject alignments which aren't a power-of-two multiple of sizeof (void*) */
+	if (alignment == 0 || alignment % sizeof (void*) != 0 || (alignment & (alignment - 1)) != 0)
+		return EINVAL;
+
+	ptr = memalign (alignment, size);
+	if (ptr == NULL)
+		return ENOMEM;
+
+	*memptr = ptr;
+
+	return 0;
+}
+
+void
+free (void *ptr)
+{
+	account_free (ptr);
+	__libc_free (ptr);
+}
+
+static gsize
+get_n_allocations (void)
+{
+	return __sync_fetch_and_add (&n_allocations, 0);
+}
+
+static gssize
+get_live_bytes (void)
+{
+	return __sync_fetch_and_add (&live_bytes, 0);
+}
+
+/* Resets the peak to the current number of live bytes, and returns it. */
+static gssize
+reset_peak_live_bytes (void)
+{
+	gssize live = get_live_bytes ();
+	__sync_lock_test_and_set (&peak_live_bytes, live);
+	return live;
+}
+
+static gssize
+get_peak_live_bytes (void)
+{
+	return __sync_fetch_and_add (&peak_live_bytes, 0);
+}
+#else /* !__GLIBC__ */
+#define HAVE_HEAP_ACCOUNTING 0
+
+static gsize
+get_n_allocations (void)
+{
+	return 0;
+}
+
+static gssize
+get_live_bytes (void)
+{
+	return 0;
+}
+
+static gssize
+reset_peak_live_bytes (void)
+{
+	return 0;
+}
+
+static gssize
+get_peak_live_bytes (void)
+{
+	return 0;
+}
+#endif /* !__GLIBC__ */
+
+typedef GDataFeed *(*QueryFunc) (GDataService *service, GError **error);
+
+typedef struct {
+	const gchar *name; /* also the name of the test and its group in the baselines file */
+	const gchar *trace_directory;
+	const gchar *trace_name;
+	const gchar *username;
+	QueryFunc query;
+} MemoryWorkload;
+
+static GDataFeed *
+query_contacts (GDataService *service, GError **error)
+{
+	return gdata_contacts_service_query_contacts (GDATA_CONTACTS_SERVICE (service), NULL, NULL, NULL, NULL, error);
+}
+
+static GDataFeed *
+query_own_calendars (GDataService *service, GError **error)
+{
+	return gdata_calendar_service_query_own_calendars (GDATA_CALENDAR_SERVICE (service), NULL, NULL, NULL, NULL, error);
+}
+
+static GDataFeed *
+query_standard_feed (GDataService *service, GError **error)
+{
+	return gdata_youtube_service_query_standard_feed (GDATA_YOUTUBE_SERVICE (service), GDATA_YOUTUBE_TOP_RATED_FEED, NULL, NULL, NULL, NULL,
+	                                                  error);
+}
+
+static GDataFeed *
+query_all_albums (GDataService *service, GError **error)
+{
+	return gdata_picasaweb_service_query_all_albums (GDATA_PICASAWEB_SERVICE (service), NULL, NULL, NULL, NULL, NULL, error);
+}
+
+static const MemoryWorkload workloads[] = {
+	{ "contacts/query-all-contacts", "contacts", "query-all-contacts", USERNAME, query_contacts },
+	{ "calendar/query-own-calendars", "calendar", "query-own-calendars", USERNAME, query_own_calendars },
+	{ "youtube/query-standard-feed", "youtube", "query-standard-feed", USERNAME, query_standard_feed },
+	{ "picasaweb/query-all-albums", "picasaweb", "query-all-albums", PW_USERNAME, query_all_albums },
+};
+
+static GType
+get_service_type (const MemoryWorkload *workload)
+{
+	/* The service types can't be used in the static initialiser above, since they're function calls. */
+	if (strcmp (workload->trace_directory, "contacts") == 0)
+		return GDATA_TYPE_CONTACTS_SERVICE;
+	else if (strcmp (workload->trace_directory, "calendar") == 0)
+		return GDATA_TYPE_CALENDAR_SERVICE;
+	else if (strcmp (workload->trace_directory, "youtube") == 0)
+		return GDATA_TYPE_YOUTUBE_SERVICE;
+	else if (strcmp (workload->trace_directory, "picasaweb") == 0)
+		return GDATA_TYPE_PICASAWEB_SERVICE;
+
+	g_assert_not_reached ();
+}
+
+static GDataService *
+create_service (const MemoryWorkload *workload)
 {
-	GDataFeed *feed, *calendar_feed;
 	GDataClientLoginAuthorizer *authorizer;
-	GDataCalendarCalendar *calendar;
-	GDataCalendarService *service;
-	GList *calendars;
-	GError *error = NULL;
+	GDataService *service;
+	GType service_type = get_service_type (workload);
 
-	authorizer = gdata_client_login_authorizer_new (CLIENT_ID, GDATA_TYPE_CALENDAR_SERVICE);
-	service = gdata_calendar_service_new (GDATA_AUTHORIZER (authorizer));
+	gdata_test_mock_server_start_trace (mock_server, "global-authentication");
+	authorizer = gdata_client_login_authorizer_new (CLIENT_ID, service_type);
+	gdata_client_login_authorizer_authenticate (authorizer, workload->username, PASSWORD, NULL, NULL);
+	uhm_server_end_trace (mock_server);
 
-	/* Log in */
-	gdata_client_login_authorizer_authenticate (authorizer, USERNAME, PASSWORD, NULL, &error);
-	g_assert_no_error (error);
+	if (service_type == GDATA_TYPE_YOUTUBE_SERVICE)
+		service = GDATA_SERVICE (gdata_youtube_service_new (DEVELOPER_KEY, GDATA_AUTHORIZER (authorizer)));
+	else
+		service = GDATA_SERVICE (g_object_new (service_type, "authorizer", authorizer, NULL));
 
-	/* Get a calendar */
-	calendar_feed = gdata_calendar_service_query_own_calendars (service, NULL, NULL, NULL, NULL, &error);
-	g_assert_no_error (error);
+	g_object_unref (authorizer);
 
-	calendars = gdata_feed_get_entries (calendar_feed);
-	calendar = calendars->data;
+	return service;
+}
 
-	g_object_ref (calendar);
-	g_object_unref (calendar_feed);
+/* Runs the workload's query once, returning the feed. The query must be sandwiched by the trace being started and ended. */
+static GDataFeed *
+run_query (GDataService *service, const MemoryWorkload *workload)
+{
+	GDataFeed *feed;
+	GError *error = NULL;
 
-	/* Get the entry feed */
-	feed = gdata_calendar_service_query_events (service, calendar, NULL, NULL, NULL, NULL, &error);
+	feed = workload->query (service, &error);
 	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	return feed;
+}
+
+static void
+check_against_baseline (const gchar *name, const gchar *key, gint64 measured)
+{
+	gint64 baseline;
+	GError *error = NULL;
+
+	if (update_baselines == TRUE) {
+		g_key_file_set_int64 (baselines, name, key, measured);
+		return;
+	}
+
+	/* Don't check anything until some baselines have been recorded */
+	if (have_baselines == FALSE) {
+		g_test_message ("%s: %s %" G_GINT64_FORMAT " (no baselines have been recorded; run with --update-baselines to record them)", name,
+		                key, measured);
+		return;
+	}
+
+	baseline = g_key_file_get_int64 (baselines, name, key, &error);
+
+	if (error != NULL) {
+		g_test_message ("%s: no %s baseline; measured %" G_GINT64_FORMAT, name, key, measured);
+		g_error_free (error);
+		return;
+	}
+
+	g_test_message ("%s: %s %" G_GINT64_FORMAT " (baseline %" G_GINT64_FORMAT ")", name, key, measured, baseline);
+
+	if (measured > baseline + (gint64) (baseline * BASELINE_TOLERANCE)) {
+		g_error ("%s: %s regressed from %" G_GINT64_FORMAT " to %" G_GINT64_FORMAT "; if this is intentional, re-run with "
+		         "--update-baselines", name, key, baseline, measured);
+	}
+}
+
+static void
+test_memory_footprint (gconstpointer user_data)
+{
+	const MemoryWorkload *workload = user_data;
+	GDataService *service;
+	GDataFeed *feed;
+	GFile *trace_directory;
+	gchar *path;
+	gssize start_bytes, peak_bytes, retained_bytes;
+	gsize start_allocations, allocations;
+	guint n_entries;
+
+	if (HAVE_HEAP_ACCOUNTING == 0) {
+		g_test_message ("Heap usage can't be measured on this platform; skipping.");
+		return;
+	}
+
+	path = g_build_filename (TEST_FILE_DIR, "traces", workload->trace_directory, NULL);
+	trace_directory = g_file_new_for_path (path);
+	uhm_server_set_trace_directory (mock_server, trace_directory);
+	g_object_unref (trace_directory);
+	g_free (path);
+
+	service = create_service (workload);
+
+	/* Warm up */
+	gdata_test_mock_server_start_trace (mock_server, workload->trace_name);
+	feed = run_query (service, workload);
+	uhm_server_end_trace (mock_server);
+	g_object_unref (feed);
+
+	/* Measure */
+	start_bytes = reset_peak_live_bytes ();
+	start_allocations = get_n_allocations ();
+
+	gdata_test_mock_server_start_trace (mock_server, workload->trace_name);
+	feed = run_query (service, workload);
+
+	allocations = get_n_allocations () - start_allocations;
+	peak_bytes = get_peak_live_bytes () - start_bytes;
+
+	uhm_server_end_trace (mock_server);
+
+	/* Everything else allocated by the query should have been freed by now, leaving just the feed */
+	retained_bytes = get_live_bytes () - start_bytes;
+	n_entries = g_list_length (gdata_feed_get_entries (feed));
+	g_assert_cmpuint (n_entries, >, 0);
 
 	g_object_unref (feed);
-	g_object_unref (calendar);
 	g_object_unref (service);
-	g_object_unref (authorizer);
+
+	g_test_maximized_result (peak_bytes, "Peak heap: %" G_GSSIZE_FORMAT " bytes", peak_bytes);
+	g_test_maximized_result (retained_bytes / n_entries, "Retained heap per entry: %" G_GSSIZE_FORMAT " bytes", retained_bytes / n_entries);
+	g_test_maximized_result (allocations, "Allocations: %" G_GSIZE_FORMAT, allocations);
+
+	check_against_baseline (workload->name, "peak-heap", peak_bytes);
+	check_against_baseline (workload->name, "retained-heap-per-entry", retained_bytes / n_entries);
+	check_against_baseline (workload->name, "allocations", allocations);
+}
+
+/* Parses a generated feed of the given size, returning the peak heap and retained heap per entry. The feed document itself is excluded. */
+static void
+measure_generated_feed (GDataTestFeedKind kind, guint n_entries, gssize *peak_bytes_per_entry, gssize *retained_bytes_per_entry)
+{
+	GDataParsable *feed;
+	gchar *document;
+	gsize length;
+	gssize start_bytes;
+	GError *error = NULL;
+
+	document = gdata_test_generate_feed (kind, n_entries, SCALE_EXTENSION_ELEMENTS, SCALE_UNKNOWN_ELEMENTS, &length);
+
+	start_bytes = reset_peak_live_bytes ();
+
+	if (gdata_test_feed_kind_is_json (kind) == TRUE)
+		feed = gdata_parsable_new_from_json (GDATA_TYPE_FEED, document, length, &error);
+	else
+		feed = gdata_parsable_new_from_xml (GDATA_TYPE_FEED, document, length, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	*peak_bytes_per_entry = (get_peak_live_bytes () - start_bytes) / n_entries;
+	*retained_bytes_per_entry = (get_live_bytes () - start_bytes) / n_entries;
+
+	g_assert_cmpuint (g_list_length (gdata_feed_get_entries (GDATA_FEED (feed))), ==, n_entries);
+
+	g_object_unref (feed);
+	g_free (document);
+}
+
+static void
+check_scaling (const gchar *name, const gchar *key, gssize small_measurement, gssize large_measurement)
+{
+	g_test_message ("%s: %s %" G_GSSIZE_FORMAT " at %u entries, %" G_GSSIZE_FORMAT " at %u entries", name, key,
+	                small_measurement, SCALE_SMALL_ENTRIES, large_measurement, SCALE_LARGE_ENTRIES);
+
+	if (large_measurement > small_measurement + (gssize) (small_measurement * BASELINE_TOLERANCE)) {
+		g_error ("%s: %s grows with the size of the feed: %" G_GSSIZE_FORMAT " at %u entries, but %" G_GSSIZE_FORMAT " at %u entries",
+		         name, key, small_measurement, SCALE_SMALL_ENTRIES, large_measurement, SCALE_LARGE_ENTRIES);
+	}
+}
+
+static void
+test_memory_scale (gconstpointer user_data)
+{
+	GDataTestFeedKind kind = GPOINTER_TO_UINT (user_data);
+	gssize small_peak, small_retained, large_peak, large_retained;
+	gchar *name;
+
+	if (HAVE_HEAP_ACCOUNTING == 0) {
+		g_test_message ("Heap usage can't be measured on this platform; skipping.");
+		return;
+	}
+
+	name = g_strdup_printf ("scale/%s", gdata_test_feed_kind_get_name (kind));
+
+	/* Warm up */
+	measure_generated_feed (kind, 1, &small_peak, &small_retained);
+
+	/* Measure */
+	measure_generated_feed (kind, SCALE_SMALL_ENTRIES, &small_peak, &small_retained);
+	measure_generated_feed (kind, SCALE_LARGE_ENTRIES, &large_peak, &large_retained);
+
+	g_test_maximized_result (large_peak, "Peak heap per entry: %" G_GSSIZE_FORMAT " bytes", large_peak);
+	g_test_maximized_result (large_retained, "Retained heap per entry: %" G_GSSIZE_FORMAT " bytes", large_retained);
+
+	if (update_baselines == FALSE) {
+		check_scaling (name, "peak-heap-per-entry", small_peak, large_peak);
+		check_scaling (name, "retained-heap-per-entry", small_retained, large_retained);
+	}
+
+	check_against_baseline (name, "peak-heap-per-entry", large_peak);
+	check_against_baseline (name, "retained-heap-per-entry", large_retained);
+
+	g_free (name);
+}
+
+static void
+mock_server_notify_resolver_cb (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	UhmServer *server;
+	UhmResolver *resolver;
+
+	server = UHM_SERVER (object);
+	resolver = uhm_server_get_resolver (server);
+
+	if (resolver != NULL) {
+		const gchar *ip_address = uhm_server_get_address (server);
+
+		uhm_resolver_add_A (resolver, "www.google.com", ip_address);
+		uhm_resolver_add_A (resolver, "gdata.youtube.com", ip_address);
+		uhm_resolver_add_A (resolver, "picasaweb.google.com", ip_address);
+	}
 }
 
 int
 main (int argc, char *argv[])
 {
-	g_mem_set_vtable (glib_mem_profiler_table);
+	GError *error = NULL;
+	gint i, retval;
 
-#if !GLIB_CHECK_VERSION (2, 35, 0)
-	g_type_init ();
-#endif
+	/* Make slice allocations go through malloc() so that they're measured. This must be done before GLib allocates anything. */
+	g_setenv ("G_SLICE", "always-malloc", TRUE);
 
-	test_query_events ();
+	/* Handle our own option before gdata_test_init() sees it */
+	for (i = 1; i < argc; i++) {
+		if (strcmp (argv[i], "--update-baselines") == 0) {
+			update_baselines = TRUE;
+			argv[i] = (char*) "";
+		}
+	}
 
-	/* Print memory usage data */
-	g_mem_profile ();
+	gdata_test_init (argc, argv);
 
-	return 0;
+	mock_server = gdata_test_get_mock_server ();
+	g_signal_connect (G_OBJECT (mock_server), "notify::resolver", (GCallback) mock_server_notify_resolver_cb, NULL);
+
+	baselines = g_key_file_new ();
+	if (g_key_file_load_from_file (baselines, BASELINES_FILE, G_KEY_FILE_KEEP_COMMENTS, &error) == FALSE) {
+		g_test_message ("Couldn't load baselines from ‘%s’: %s", BASELINES_FILE, error->message);
+		g_clear_error (&error);
+	} else {
+		gsize n_groups;
+		gchar **groups = g_key_file_get_groups (baselines, &n_groups);
+
+		have_baselines = (n_groups > 0) ? TRUE : FALSE;
+		g_strfreev (groups);
+	}
+
+	for (i = 0; i < (gint) G_N_ELEMENTS (workloads); i++) {
+		gchar *test_name = g_strdup_printf ("/memory/%s", workloads[i].name);
+		g_test_add_data_func (test_name, &workloads[i], test_memory_footprint);
+		g_free (test_name);
+	}
+
+	for (i = 0; i < GDATA_TEST_FEED_N_KINDS; i++) {
+		gchar *test_name = g_strdup_printf ("/memory/scale/%s", gdata_test_feed_kind_get_name (i));
+		g_test_add_data_func (test_name, GUINT_TO_POINTER (i), test_memory_scale);
+		g_free (test_name);
+	}
+
+	retval = g_test_run ();
+
+	if (update_baselines == TRUE) {
+		gchar *data = g_key_file_to_data (baselines, NULL, NULL);
+
+		if (g_file_set_contents (BASELINES_FILE, data, -1, &error) == FALSE) {
+			g_printerr ("Couldn't save baselines to ‘%s’: %s\n", BASELINES_FILE, error->message);
+			g_clear_error (&error);
+			retval = 1;
+		}
+
+		g_free (data);
+	}
+
+	g_key_file_free (baselines);
+
+	return retval;
 }
@@ -17,86 +17,1248 @@
  * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/*
+ * Benchmark suite for libgdata.
+ *
+ * Each benchmark runs a single operation repeatedly (for at least MIN_ITERATIONS iterations and --min-time seconds, or MAX_ITERATIONS iterations,
+ * whichever comes first), after one untimed warm-up run. Results are printed to stdout as one JSON object per line, so they can be collected and
+ * compared between releases:
+ *
+ *   {"benchmark": "parse-xml/feed/1000", "iterations": 52, "ops_per_second": 261.1, "p50_us": 3801, "p99_us": 4410, "allocations_per_op": 78044.0}
+ *
+ * allocations_per_op is null if allocations can't be counted on this platform. Buffer and stream benchmarks additionally report bytes_per_second, and
+ * cpu_seconds_per_gb: the CPU time (user and system, summed over all threads) used per GiB transferred.
+ *
+ * The libxml-options benchmarks parse documents with libxml directly, comparing a fresh parser context per parse (as xmlReadMemory() uses) with a
+ * reused one under each combination of parse options, so the options libgdata uses can be checked against the alternatives.
+ *
+ * The calendar benchmarks measure the date and time conversions done when expanding recurring events and building calendar queries; the
+ * parse-xml/calendar-event-recurring benchmark covers those done when parsing gd:when and gd:reminder elements.
+ *
+ * The startup/cold benchmark is only run once, since it measures the first use of the library in the process.
+ *
+ * The scale benchmarks parse feeds from the synthetic feed generator at 1000, 10 000, … entries, up to --scale-max entries, for each kind of entry
+ * the generator supports, both plain and with extension and unknown elements added to each entry. They report bytes_per_second for the feed
+ * document, so that a parser which scales worse than linearly shows up as a drop in throughput as the size increases. (The memory test program
+ * checks how the memory used scales.)
+ *
+ * The 100 000-entry workloads are only run if --full is passed, and --filter can be used to only run benchmarks whose names contain a given string.
+ */
+
 #include <glib.h>
+#include <libxml/parser.h>
+#include <locale.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <sys/types.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
 
 #include "gdata.h"
+#include "gdata-buffer.h"
 #include "common.h"
+#include "feed-generator.h"
+
+#define MIN_ITERATIONS 5
+#define MAX_ITERATIONS 10000
+#define STREAM_LENGTH (4 * 1024 * 1024)
+#define BUFFER_LENGTH (16 * 1024 * 1024)
+#define SCALE_EXTENSION_ELEMENTS 4
+#define SCALE_UNKNOWN_ELEMENTS 4
+
+static gboolean full = FALSE;
+static gchar *filter = NULL;
+static gdouble min_time = 0.2;
+static gint scale_max = 0;
+
+/*
+ * Allocation counting.
+ *
+ * On glibc, malloc() and friends can be replaced by the program, and the replacements will be used by every library it's linked against (including
+ * libxml, since libgdata sets its allocators to GLib's). G_SLICE=always-malloc is set in main() so that slice allocations are counted too.
+ */
+#ifdef __GLIBC__
+#define HAVE_ALLOCATION_COUNTING 1
+
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t n_members, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void __libc_free (void *ptr);
+
+static volatile gsize n_allocations = 0;
+
+void *
+malloc (size_t size)
+{
+	__sync_fetch_and_add (&n_allocations, 1);
+	return __libc_malloc (size);
+}
+
+void *
+calloc (size_t n_members, size_t size)
+{
+	__sync_fetch_and_add (&n_allocations, 1);
+	return __libc_calloc (n_members, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+	if (ptr == NULL)
+		__sync_fetch_and_add (&n_allocations, 1);
+	return __libc_realloc (ptr, size);
+}
+
+void
+free (void *ptr)
+{
+	__libc_free (ptr);
+}
+
+static gsize
+get_n_allocations (void)
+{
+	return __sync_fetch_and_add (&n_allocations, 0);
+}
+#else /* !__GLIBC__ */
+#define HAVE_ALLOCATION_COUNTING 0
+
+static gsize
+get_n_allocations (void)
+{
+	return 0;
+}
+#endif /* !__GLIBC__ */
+
+/*
+ * Benchmark harness.
+ */
+typedef void (*BenchmarkFunc) (gconstpointer user_data);
+
+/* Returns the CPU time used by the process so far, in microseconds */
+static gint64
+get_cpu_time (void)
+{
+	struct rusage usage;
+
+	getrusage (RUSAGE_SELF, &usage);
+
+	return ((gint64) usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * G_USEC_PER_SEC + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static gint
+compare_latencies (const gint64 *a, const gint64 *b)
+{
+	return (*a > *b) - (*a < *b);
+}
+
+static gboolean
+should_run (const gchar *name)
+{
+	return (filter == NULL || strstr (name, filter) != NULL);
+}
+
+static void
+run_benchmark (const gchar *name, BenchmarkFunc func, gconstpointer user_data, gsize bytes_per_op)
+{
+	GArray *latencies;
+	gint64 total_start, start, end, total_time, cpu_start, cpu_time;
+	gsize allocations_start, allocations_end;
+	gdouble ops_per_second;
+	gchar number_buffer[G_ASCII_DTOSTR_BUF_SIZE];
+	GString *result;
+
+	if (should_run (name) == FALSE)
+		return;
+
+	/* Preallocate the latency array so that it doesn't contribute to the allocation count */
+	latencies = g_array_sized_new (FALSE, FALSE, sizeof (gint64), MAX_ITERATIONS);
+
+	/* Warm up */
+	func (user_data);
+
+	allocations_start = get_n_allocations ();
+	cpu_start = get_cpu_time ();
+	total_start = g_get_monotonic_time ();
+
+	do {
+		gint64 latency;
+
+		start = g_get_monotonic_time ();
+		func (user_data);
+		end = g_get_monotonic_time ();
+
+		latency = end - start;
+		g_array_append_val (latencies, latency);
+	} while (latencies->len < MIN_ITERATIONS ||
+	         (latencies->len < MAX_ITERATIONS && (gdouble) (end - total_start) / (gdouble) G_USEC_PER_SEC < min_time));
+
+	allocations_end = get_n_allocations ();
+	cpu_time = get_cpu_time () - cpu_start;
+	total_time = MAX (end - total_start, 1);
+
+	g_array_sort (latencies, (GCompareFunc) compare_latencies);
+	ops_per_second = (gdouble) latencies->len * (gdouble) G_USEC_PER_SEC / (gdouble) total_time;
+
+	/* Numbers are formatted with g_ascii_dtostr() so that the output is independent of the locale */
+	result = g_string_new (NULL);
+	g_string_append_printf (result, "{\"benchmark\": \"%s\", \"iterations\": %u", name, latencies->len);
+	g_string_append_printf (result, ", \"ops_per_second\": %s", g_ascii_dtostr (number_buffer, sizeof (number_buffer), ops_per_second));
+	g_string_append_printf (result, ", \"p50_us\": %" G_GINT64_FORMAT, g_array_index (latencies, gint64, (latencies->len - 1) * 50 / 100));
+	g_string_append_printf (result, ", \"p99_us\": %" G_GINT64_FORMAT, g_array_index (latencies, gint64, (latencies->len - 1) * 99 / 100));
+
+	if (HAVE_ALLOCATION_COUNTING) {
+		gdouble allocations_per_op = (gdouble) (allocations_end - allocations_start) / (gdouble) latencies->len;
+		g_string_append_printf (result, ", \"allocations_per_op\": %s",
+		                        g_ascii_dtostr (number_buffer, sizeof (number_buffer), allocations_per_op));
+	} else {
+		g_string_append (result, ", \"allocations_per_op\": null");
+	}
+
+	if (bytes_per_op > 0) {
+		gdouble cpu_seconds_per_gb = (gdouble) cpu_time / (gdouble) G_USEC_PER_SEC /
+		                             ((gdouble) latencies->len * (gdouble) bytes_per_op / (1024.0 * 1024.0 * 1024.0));
+
+		g_string_append_printf (result, ", \"bytes_per_second\": %s",
+		                        g_ascii_dtostr (number_buffer, sizeof (number_buffer), ops_per_second * (gdouble) bytes_per_op));
+		g_string_append_printf (result, ", \"cpu_seconds_per_gb\": %s",
+		                        g_ascii_dtostr (number_buffer, sizeof (number_buffer), cpu_seconds_per_gb));
+	}
+
+	g_string_append_c (result, '}');
+	g_print ("%s\n", result->str);
+
+	g_string_free (result, TRUE);
+	g_array_free (latencies, TRUE);
+}
+
+/*
+ * Test data.
+ *
+ * Each template is a printf() format string taking a single unsigned integer, which is used to give each generated entry a unique ID.
+ */
+#define ATOM_NAMESPACES \
+	"xmlns='http://www.w3.org/2005/Atom' " \
+	"xmlns:gd='http://schemas.google.com/g/2005' " \
+	"xmlns:gCal='http://schemas.google.com/gCal/2005' " \
+	"xmlns:gContact='http://schemas.google.com/contact/2008' " \
+	"xmlns:app='http://www.w3.org/2007/app' "
+
+static const gchar *generic_entry_template =
+	"<entry>"
+		"<id>http://example.com/entries/%u</id>"
+		"<title type='text'>Testing unhandled XML</title>"
+		"<updated>2009-01-25T14:07:37.880860Z</updated>"
+		"<published>2009-01-23T14:06:37.880860Z</published>"
+		"<content type='text'>Here we test unhandled XML elements.</content>"
+		"<link rel='self' type='application/atom+xml' href='http://example.com/self'/>"
+		"<category scheme='http://example.com/categories' term='entry'/>"
+		"<author><name>Joe Smith</name><email>j.smith@example.com</email></author>"
+	"</entry>";
+
+/* Calendar events are parsed partly through their public setters, each of which notifies a property. */
+static const gchar *calendar_event_template =
+	"<entry " ATOM_NAMESPACES "gd:etag='W/\"DEQHQn84fCt7ImA9WxJTGUU.\"'>"
+		"<id>http://www.google.com/calendar/feeds/default/events/%u</id>"
+		"<published>2008-06-06T21:02:56.000Z</published>"
+		"<updated>2009-04-27T17:54:10.000Z</updated>"
+		"<app:edited>2009-04-27T17:54:10.000Z</app:edited>"
+		"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/g/2005#event'/>"
+		"<title>Tennis with Beth</title>"
+		"<content type='text'>Meet for a quick lesson.</content>"
+		"<gd:eventStatus value='http://schemas.google.com/g/2005#event.confirmed'/>"
+		"<gd:where valueString='Rolling Lawn Courts'/>"
+		"<gd:when startTime='2009-04-17T15:00:00.000Z' endTime='2009-04-17T17:00:00.000Z'/>"
+		"<gCal:anyoneCanAddSelf value='false'/>"
+		"<gCal:guestsCanInviteOthers value='false'/>"
+		"<gCal:guestsCanModify value='true'/>"
+		"<gCal:guestsCanSeeGuests value='true'/>"
+		"<gCal:sequence value='2'/>"
+		"<gCal:uid value='54dd4a2c-bee7-4c24-a0e2-a41a34c4d092@google.com'/>"
+	"</entry>";
+
+/* Recurring events list a gd:when for each instance in the requested range, each with its own reminders, so are dominated by date and time
+ * conversions. */
+static const gchar *calendar_recurring_event_template =
+	"<entry " ATOM_NAMESPACES ">"
+		"<id>http://www.google.com/calendar/feeds/default/events/recurring%u</id>"
+		"<updated>2009-04-27T17:54:10.000Z</updated>"
+		"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/g/2005#event'/>"
+		"<title>Stand-up</title>"
+		"<gd:when startTime='2009-04-13T09:00:00.000+01:00' endTime='2009-04-13T09:15:00.000+01:00'>"
+			"<gd:reminder minutes='10' method='alert'/><gd:reminder absoluteTime='2009-04-13T08:00:00.000Z' method='email'/>"
+		"</gd:when>"
+		"<gd:when startTime='2009-04-14T09:00:00.000+01:00' endTime='2009-04-14T09:15:00.000+01:00'>"
+			"<gd:reminder minutes='10' method='alert'/><gd:reminder absoluteTime='2009-04-14T08:00:00.000Z' method='email'/>"
+		"</gd:when>"
+		"<gd:when startTime='2009-04-15T09:00:00.000+01:00' endTime='2009-04-15T09:15:00.000+01:00'>"
+			"<gd:reminder minutes='10' method='alert'/><gd:reminder absoluteTime='2009-04-15T08:00:00.000Z' method='email'/>"
+		"</gd:when>"
+		"<gd:when startTime='2009-04-16T09:00:00.000+01:00' endTime='2009-04-16T09:15:00.000+01:00'>"
+			"<gd:reminder minutes='10' method='alert'/><gd:reminder absoluteTime='2009-04-16T08:00:00.000Z' method='email'/>"
+		"</gd:when>"
+		"<gd:when startTime='2009-04-17' endTime='2009-04-18'><gd:reminder days='1' method='alert'/></gd:when>"
+		"<gd:when startTime='2009-04-20' endTime='2009-04-21'><gd:reminder days='1' method='alert'/></gd:when>"
+	"</entry>";
+
+/* Contacts own many small gd:* and atom:* objects, so mostly measure the per-object overhead of parsing and freeing them. */
+static const gchar *contact_template =
+	"<entry " ATOM_NAMESPACES ">"
+		"<id>http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/base/%u</id>"
+		"<updated>2009-04-25T15:21:53.688Z</updated>"
+		"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>"
+		"<title>Fooish Bar</title>"
+		"<link rel='http://schemas.google.com/contacts/2008/rel#photo' type='image/*' "
+		      "href='http://www.google.com/m8/feeds/photos/media/libgdata.test@googlemail.com/1b46cdd20bfbee3b'/>"
+		"<link rel='self' type='application/atom+xml' "
+		      "href='http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/full/1b46cdd20bfbee3b'/>"
+		"<link rel='edit' type='application/atom+xml' "
+		      "href='http://www.google.com/m8/feeds/contacts/libgdata.test@googlemail.com/full/1b46cdd20bfbee3b/1240672913688000'/>"
+		"<gd:name><gd:fullName>Fooish Bar</gd:fullName></gd:name>"
+		"<gd:email rel='http://schemas.google.com/g/2005#work' address='fooish@example.com' primary='true'/>"
+		"<gd:email rel='http://schemas.google.com/g/2005#home' address='bar@example.com'/>"
+		"<gd:email rel='http://schemas.google.com/g/2005#other' address='fooish.bar@example.org'/>"
+		"<gd:im rel='http://schemas.google.com/g/2005#home' protocol='http://schemas.google.com/g/2005#GOOGLE_TALK' "
+		       "address='fooish@gmail.com'/>"
+		"<gd:phoneNumber rel='http://schemas.google.com/g/2005#work'>(206)555-1212</gd:phoneNumber>"
+		"<gd:phoneNumber rel='http://schemas.google.com/g/2005#mobile'>(206)555-1213</gd:phoneNumber>"
+		"<gd:phoneNumber rel='http://schemas.google.com/g/2005#home'>(206)555-1214</gd:phoneNumber>"
+		"<gd:structuredPostalAddress rel='http://schemas.google.com/g/2005#work'>"
+			"<gd:street>1600 Amphitheatre Parkway</gd:street><gd:city>Mountain View</gd:city><gd:postcode>94043</gd:postcode>"
+		"</gd:structuredPostalAddress>"
+		"<gd:organization rel='http://schemas.google.com/g/2005#work'><gd:orgName>Example Corp.</gd:orgName></gd:organization>"
+		"<gContact:website href='http://example.com/' rel='home-page'/>"
+		"<gContact:website href='http://blog.example.com/' rel='blog'/>"
+		"<gContact:groupMembershipInfo href='http://www.google.com/feeds/contacts/groups/jo%%40gmail.com/base/1234a' deleted='false'/>"
+	"</entry>";
+
+static const gchar *generic_json_entry_template =
+	"{"
+		"\"kind\": \"tasks#task\","
+		"\"id\": \"entry-%u\","
+		"\"etag\": \"\\\"etag\\\"\","
+		"\"title\": \"Testing unhandled JSON\","
+		"\"updated\": \"2014-08-30T19:04:34.000Z\","
+		"\"selfLink\": \"https://www.googleapis.com/tasks/v1/lists/list/tasks/task\""
+	"}";
+
+static const gchar *task_template =
+	"{"
+		"\"kind\": \"tasks#task\","
+		"\"id\": \"MTEzNTY3MTg4NTUzOTU4NDQ4MzI6MDo3ODQxMjA1NjQ-%u\","
+		"\"etag\": \"\\\"ydsIn5hgu1IBj0la4T4xznQOfJ0/LTIwNTg0MzMzNjE\\\"\","
+		"\"title\": \"Buy milk\","
+		"\"updated\": \"2014-08-30T19:04:34.000Z\","
+		"\"selfLink\": \"https://www.googleapis.com/tasks/v1/lists/list/tasks/task\","
+		"\"position\": \"00000000000000130998\","
+		"\"notes\": \"Semi-skimmed.\","
+		"\"status\": \"needsAction\","
+		"\"due\": \"2014-09-02T00:00:00.000Z\","
+		"\"deleted\": false,"
+		"\"hidden\": false"
+	"}";
+
+static GPtrArray *
+build_entries (const gchar *template, guint n_entries)
+{
+	GPtrArray *entries;
+	guint i;
+
+	entries = g_ptr_array_new_with_free_func (g_free);
+	for (i = 0; i < n_entries; i++)
+		g_ptr_array_add (entries, g_strdup_printf (template, i));
+
+	return entries;
+}
+
+static gchar *
+build_xml_feed (const gchar *template, guint n_entries)
+{
+	GString *xml;
+	guint i;
+
+	xml = g_string_new ("<feed " ATOM_NAMESPACES
+	                    "xmlns:openSearch='http://a9.com/-/spec/opensearch/1.1/' "
+	                    "gd:etag='W/\"D08FQn8-eil7ImA9WxZbFEw.\"'>"
+	                    "<id>http://example.com/id</id>"
+	                    "<updated>2009-02-25T14:07:37.880860Z</updated>"
+	                    "<title type='text'>Test feed</title>"
+	                    "<link rel='http://schemas.google.com/g/2005#feed' type='application/atom+xml' href='http://example.com/id'/>"
+	                    "<link rel='self' type='application/atom+xml' href='http://example.com/id'/>"
+	                    "<author><name>Joe Smith</name><email>j.smith@example.com</email></author>"
+	                    "<openSearch:totalResults>2</openSearch:totalResults>"
+	                    "<openSearch:startIndex>0</openSearch:startIndex>"
+	                    "<openSearch:itemsPerPage>50</openSearch:itemsPerPage>");
+
+	for (i = 0; i < n_entries; i++)
+		g_string_append_printf (xml, template, i);
+
+	g_string_append (xml, "</feed>");
+
+	return g_string_free (xml, FALSE);
+}
+
+static gchar *
+build_json_feed (const gchar *template, guint n_entries)
+{
+	GString *json;
+	guint i;
+
+	json = g_string_new ("{\"kind\": \"tasks#tasks\", \"etag\": \"\\\"feed-etag\\\"\", \"items\": [");
+
+	for (i = 0; i < n_entries; i++) {
+		if (i > 0)
+			g_string_append_c (json, ',');
+		g_string_append_printf (json, template, i);
+	}
+
+	g_string_append (json, "]}");
+
+	return g_string_free (json, FALSE);
+}
+
+/*
+ * Parsing benchmarks.
+ */
+typedef struct {
+	GType type;
+	GPtrArray *documents; /* for per-entry parsing */
+	gchar *document; /* for feed parsing */
+} ParseData;
 
 static void
-test_parse_feed (void)
+parse_xml_feed (gconstpointer user_data)
 {
-	GDataFeed *feed;
+	const ParseData *data = user_data;
+	GDataParsable *feed;
 	GError *error = NULL;
 
-	feed = GDATA_FEED (gdata_parsable_new_from_xml (GDATA_TYPE_FEED,
-		"<feed xmlns='http://www.w3.org/2005/Atom' "
-		      "xmlns:openSearch='http://a9.com/-/spec/opensearch/1.1/' "
-		      "xmlns:gd='http://schemas.google.com/g/2005' "
-		      "gd:etag='W/\"D08FQn8-eil7ImA9WxZbFEw.\"'>"
-			"<id>http://example.com/id</id>"
-			"<updated>2009-02-25T14:07:37.880860Z</updated>"
-			"<title type='text'>Test feed</title>"
-			"<subtitle type='text'>Test subtitle</subtitle>"
-			"<logo>http://example.com/logo.png</logo>"
-			"<icon>http://example.com/icon.png</icon>"
-			"<link rel='alternate' type='text/html' href='http://alternate.example.com/'/>"
-			"<link rel='http://schemas.google.com/g/2005#feed' type='application/atom+xml' href='http://example.com/id'/>"
-			"<link rel='http://schemas.google.com/g/2005#post' type='application/atom+xml' href='http://example.com/post'/>"
-			"<link rel='self' type='application/atom+xml' href='http://example.com/id'/>"
-			"<category scheme='http://example.com/categories' term='feed'/>"
-			"<author>"
-				"<name>Joe Smith</name>"
-				"<email>j.smith@example.com</email>"
-			"</author>"
-			"<generator version='0.6' uri='http://example.com/'>Example Generator</generator>"
-			"<openSearch:totalResults>2</openSearch:totalResults>"
-			"<openSearch:startIndex>0</openSearch:startIndex>"
-			"<openSearch:itemsPerPage>50</openSearch:itemsPerPage>"
-			"<entry>"
-				"<id>entry1</id>"
-				"<title type='text'>Testing unhandled XML</title>"
-				"<updated>2009-01-25T14:07:37.880860Z</updated>"
-				"<published>2009-01-23T14:06:37.880860Z</published>"
-				"<content type='text'>Here we test unhandled XML elements.</content>"
-			"</entry>"
-			"<entry>"
-				"<id>entry2</id>"
-				"<title type='text'>Testing unhandled XML 2</title>"
-				"<updated>2009-02-25T14:07:37.880860Z</updated>"
-				"<published>2009-02-23T14:06:37.880860Z</published>"
-				"<content type='text'>Here we test unhandled XML elements again.</content>"
-			"</entry>"
-		"</feed>", -1, &error));
+	feed = gdata_parsable_new_from_xml (data->type, data->document, -1, &error);
 	g_assert_no_error (error);
 	g_assert (GDATA_IS_FEED (feed));
-	g_clear_error (&error);
 
 	g_object_unref (feed);
 }
 
+static void
+parse_lite_feed (gconstpointer user_data)
+{
+	const ParseData *data = user_data;
+	GDataLiteFeed *feed;
+	GError *error = NULL;
+
+	feed = gdata_lite_feed_new_from_xml (data->document, -1, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_LITE_FEED (feed));
+
+	g_object_unref (feed);
+}
+
+static void
+parse_json_feed (gconstpointer user_data)
+{
+	const ParseData *data = user_data;
+	GDataParsable *feed;
+	GError *error = NULL;
+
+	feed = gdata_parsable_new_from_json (data->type, data->document, -1, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	g_object_unref (feed);
+}
+
+/* Only generic entries can be parsed as part of a feed through the public API, so service entry types are parsed one document at a time */
+static void
+parse_xml_entries (gconstpointer user_data)
+{
+	const ParseData *data = user_data;
+	guint i;
+
+	for (i = 0; i < data->documents->len; i++) {
+		GDataParsable *entry;
+		GError *error = NULL;
+
+		entry = gdata_parsable_new_from_xml (data->type, data->documents->pdata[i], -1, &error);
+		g_assert_no_error (error);
+		g_assert (G_TYPE_CHECK_INSTANCE_TYPE (entry, data->type));
+
+		g_object_unref (entry);
+	}
+}
+
+static void
+parse_json_entries (gconstpointer user_data)
+{
+	const ParseData *data = user_data;
+	guint i;
+
+	for (i = 0; i < data->documents->len; i++) {
+		GDataParsable *entry;
+		GError *error = NULL;
+
+		entry = gdata_parsable_new_from_json (data->type, data->documents->pdata[i], -1, &error);
+		g_assert_no_error (error);
+		g_assert (G_TYPE_CHECK_INSTANCE_TYPE (entry, data->type));
+
+		g_object_unref (entry);
+	}
+}
+
+static void
+run_parse_benchmarks (guint n_entries)
+{
+	ParseData data;
+	gchar *name;
+
+	#define RUN_FEED_BENCHMARK(Name, Func, Type, Document) \
+		name = g_strdup_printf (Name "/%u", n_entries); \
+		if (should_run (name) == TRUE) { \
+			data.type = Type; \
+			data.documents = NULL; \
+			data.document = Document; \
+			run_benchmark (name, Func, &data, 0); \
+			g_free (data.document); \
+		} \
+		g_free (name);
+
+	#define RUN_ENTRIES_BENCHMARK(Name, Func, Type, Template) \
+		name = g_strdup_printf (Name "/%u", n_entries); \
+		if (should_run (name) == TRUE) { \
+			data.type = Type; \
+			data.documents = build_entries (Template, n_entries); \
+			data.document = NULL; \
+			run_benchmark (name, Func, &data, 0); \
+			g_ptr_array_unref (data.documents); \
+		} \
+		g_free (name);
+
+	RUN_FEED_BENCHMARK ("parse-xml/feed", parse_xml_feed, GDATA_TYPE_FEED, build_xml_feed (generic_entry_template, n_entries))
+	RUN_FEED_BENCHMARK ("parse-xml/lite-feed", parse_lite_feed, GDATA_TYPE_FEED, build_xml_feed (generic_entry_template, n_entries))
+	RUN_FEED_BENCHMARK ("parse-json/feed", parse_json_feed, GDATA_TYPE_FEED, build_json_feed (generic_json_entry_template, n_entries))
+
+	RUN_ENTRIES_BENCHMARK ("parse-xml/calendar-event", parse_xml_entries, GDATA_TYPE_CALENDAR_EVENT, calendar_event_template)
+	RUN_ENTRIES_BENCHMARK ("parse-xml/calendar-event-recurring", parse_xml_entries, GDATA_TYPE_CALENDAR_EVENT, calendar_recurring_event_template)
+	RUN_ENTRIES_BENCHMARK ("parse-xml/contacts-contact", parse_xml_entries, GDATA_TYPE_CONTACTS_CONTACT, contact_template)
+	RUN_ENTRIES_BENCHMARK ("parse-json/tasks-task", parse_json_entries, GDATA_TYPE_TASKS_TASK, task_template)
+
+	#undef RUN_ENTRIES_BENCHMARK
+	#undef RUN_FEED_BENCHMARK
+}
+
+/*
+ * Calendar benchmarks.
+ *
+ * These measure the date and time conversions done outside parsing: expanding recurrences in a named time zone (whose instances each have to be
+ * converted from local time), and building query URIs containing times.
+ */
+static void
+expander_instance_cb (GDataCalendarEvent *event, gint64 start_time, gint64 end_time, gboolean is_date, gpointer user_data)
+{
+	(*((guint*) user_data))++;
+}
+
+static void
+expand_recurrence (gconstpointer user_data)
+{
+	GDataCalendarEventExpander *expander;
+	GDataCalendarEvent *event;
+	guint n_instances = 0;
+	GError *error = NULL;
+
+	expander = gdata_calendar_event_expander_new ();
+
+	event = gdata_calendar_event_new ("http://www.google.com/calendar/feeds/default/events/daily");
+	gdata_calendar_event_set_recurrence (event, user_data);
+	gdata_calendar_event_expander_add_event (expander, event, &error);
+	g_assert_no_error (error);
+	g_object_unref (event);
+
+	/* Expand 2009 */
+	gdata_calendar_event_expander_expand (expander, 1230768000, 1262304000, expander_instance_cb, &n_instances);
+	g_assert_cmpuint (n_instances, ==, 365);
+
+	g_object_unref (expander);
+}
+
+static void
+build_calendar_query_uri (gconstpointer user_data)
+{
+	GDataCalendarQuery *query;
+	gchar *uri;
+
+	query = gdata_calendar_query_new_with_limits (NULL, 1230768000, 1262304000);
+	gdata_calendar_query_set_recurrence_expansion_start (query, 1230768000);
+	gdata_calendar_query_set_recurrence_expansion_end (query, 1262304000);
+	gdata_calendar_query_set_timezone (query, "Europe/London");
+
+	uri = gdata_query_get_query_uri (GDATA_QUERY (query), "http://www.google.com/calendar/feeds/default/private/full");
+	g_free (uri);
+
+	g_object_unref (query);
+}
+
+static void
+run_calendar_benchmarks (void)
+{
+	run_benchmark ("calendar/expand-recurrence/utc", expand_recurrence,
+	               "DTSTART:20090101T090000Z\nDTEND:20090101T091500Z\nRRULE:FREQ=DAILY\n", 0);
+	run_benchmark ("calendar/expand-recurrence/time-zone", expand_recurrence,
+	               "DTSTART;TZID=Europe/London:20090101T090000\nDTEND;TZID=Europe/London:20090101T091500\nRRULE:FREQ=DAILY\n", 0);
+	run_benchmark ("calendar/query-uri", build_calendar_query_uri, NULL, 0);
+}
+
+/*
+ * Scale benchmarks.
+ *
+ * Only generic feeds can be parsed through the public API, so the feed benchmarks parse each kind's service-specific elements as unhandled XML; the
+ * entries benchmarks parse the same entries one document at a time as their proper types, to show the cost of the service-specific parsing.
+ */
+static void
+run_scale_benchmarks (guint n_entries)
+{
+	ParseData data;
+	GDataTestFeedKind kind;
+	guint i;
+	const struct {
+		const gchar *name;
+		guint n_extension_elements;
+		guint n_unknown_elements;
+	} variants[] = {
+		{ "plain", 0, 0 },
+		{ "extended", SCALE_EXTENSION_ELEMENTS, SCALE_UNKNOWN_ELEMENTS },
+	};
+
+	for (kind = 0; kind < GDATA_TEST_FEED_N_KINDS; kind++) {
+		for (i = 0; i < G_N_ELEMENTS (variants); i++) {
+			gboolean is_json = gdata_test_feed_kind_is_json (kind);
+			gchar *name;
+			gsize length;
+
+			name = g_strdup_printf ("scale/feed/%s/%s/%u", gdata_test_feed_kind_get_name (kind), variants[i].name, n_entries);
+
+			if (should_run (name) == TRUE) {
+				data.type = GDATA_TYPE_FEED;
+				data.documents = NULL;
+				data.document = gdata_test_generate_feed (kind, n_entries, variants[i].n_extension_elements,
+				                                          variants[i].n_unknown_elements, &length);
+
+				run_benchmark (name, (is_json == TRUE) ? parse_json_feed : parse_xml_feed, &data, length);
+
+				g_free (data.document);
+			}
+
+			g_free (name);
+
+			name = g_strdup_printf ("scale/entries/%s/%s/%u", gdata_test_feed_kind_get_name (kind), variants[i].name, n_entries);
+
+			if (should_run (name) == TRUE) {
+				guint j;
+
+				data.type = gdata_test_feed_kind_get_entry_type (kind);
+				data.documents = g_ptr_array_new_with_free_func (g_free);
+				data.document = NULL;
+				length = 0;
+
+				for (j = 0; j < n_entries; j++) {
+					gchar *entry = gdata_test_generate_entry (kind, j, variants[i].n_extension_elements,
+					                                          variants[i].n_unknown_elements);
+					length += strlen (entry);
+					g_ptr_array_add (data.documents, entry);
+				}
+
+				run_benchmark (name, (is_json == TRUE) ? parse_json_entries : parse_xml_entries, &data, length);
+
+				g_ptr_array_unref (data.documents);
+			}
+
+			g_free (name);
+		}
+	}
+}
+
+/*
+ * libxml parse option benchmarks.
+ */
+typedef struct {
+	const gchar *document;
+	gint options;
+	xmlParserCtxt *ctxt; /* NULL to use a fresh context for each parse */
+} LibxmlParseData;
+
+static void
+parse_with_libxml (gconstpointer user_data)
+{
+	const LibxmlParseData *data = user_data;
+	xmlDoc *doc;
+
+	if (data->ctxt == NULL)
+		doc = xmlReadMemory (data->document, strlen (data->document), "/dev/null", NULL, data->options);
+	else
+		doc = xmlCtxtReadMemory (data->ctxt, data->document, strlen (data->document), "/dev/null", NULL, data->options);
+
+	g_assert (doc != NULL);
+	xmlFreeDoc (doc);
+}
+
+static void
+run_libxml_benchmarks (void)
+{
+	const struct {
+		const gchar *name;
+		gint options;
+		gboolean reuse_context;
+	} variants[] = {
+		{ "fresh", 0, FALSE },
+		{ "reused", 0, TRUE },
+		{ "reused-nodict", XML_PARSE_NODICT, TRUE },
+		{ "reused-nonet", XML_PARSE_NONET, TRUE },
+		{ "reused-nonet-compact", XML_PARSE_NONET | XML_PARSE_COMPACT, TRUE }, /* what libgdata uses */
+		{ "reused-nonet-compact-huge", XML_PARSE_NONET | XML_PARSE_COMPACT | XML_PARSE_HUGE, TRUE },
+	};
+	struct {
+		const gchar *name;
+		gchar *document;
+	} documents[] = {
+		/* Single entries and small feeds are the cases dominated by setup cost */
+		{ "calendar-event", NULL },
+		{ "feed/10", NULL },
+		{ "feed/1000", NULL },
+	};
+	guint i, j;
+
+	documents[0].document = g_strdup_printf (calendar_event_template, 0);
+	documents[1].document = build_xml_feed (generic_entry_template, 10);
+	documents[2].document = build_xml_feed (generic_entry_template, 1000);
+
+	for (i = 0; i < G_N_ELEMENTS (documents); i++) {
+		for (j = 0; j < G_N_ELEMENTS (variants); j++) {
+			LibxmlParseData data;
+			gchar *name;
+
+			name = g_strdup_printf ("libxml-options/%s/%s", variants[j].name, documents[i].name);
+
+			data.document = documents[i].document;
+			data.options = variants[j].options;
+			data.ctxt = (variants[j].reuse_context == TRUE && should_run (name) == TRUE) ? xmlNewParserCtxt () : NULL;
+
+			run_benchmark (name, parse_with_libxml, &data, 0);
+
+			if (data.ctxt != NULL)
+				xmlFreeParserCtxt (data.ctxt);
+			g_free (name);
+		}
+
+		g_free (documents[i].document);
+	}
+}
+
+/*
+ * Serialisation benchmarks.
+ */
+static void
+serialise_xml (gconstpointer user_data)
+{
+	gchar *xml;
+
+	xml = gdata_parsable_get_xml (GDATA_PARSABLE (user_data));
+	g_assert (xml != NULL);
+	g_free (xml);
+}
+
+static void
+serialise_json (gconstpointer user_data)
+{
+	gchar *json;
+
+	json = gdata_parsable_get_json (GDATA_PARSABLE (user_data));
+	g_assert (json != NULL);
+	g_free (json);
+}
+
+/* A subclass of GDataTasksTask which overrides get_json without registering a JSON write function, so that gdata_parsable_get_json() falls back to
+ * building its JSON as a tree and then serialising it; the serialise-json-tree benchmark compares that to the direct writer */
+typedef GDataTasksTask TreeTask;
+typedef GDataTasksTaskClass TreeTaskClass;
+
+static GType tree_task_get_type (void) G_GNUC_CONST;
+G_DEFINE_TYPE (TreeTask, tree_task, GDATA_TYPE_TASKS_TASK)
+
+static void
+tree_task_get_json (GDataParsable *parsable, JsonBuilder *builder)
+{
+	GDATA_PARSABLE_CLASS (tree_task_parent_class)->get_json (parsable, builder);
+}
+
+static void
+tree_task_class_init (TreeTaskClass *klass)
+{
+	GDATA_PARSABLE_CLASS (klass)->get_json = tree_task_get_json;
+}
+
+static void
+tree_task_init (TreeTask *self)
+{
+	/* Nothing to see here */
+}
+
+static void
+run_serialisation_benchmark (const gchar *name, BenchmarkFunc func, GType type, const gchar *template, gboolean is_json)
+{
+	GDataParsable *parsable;
+	gchar *document;
+	GError *error = NULL;
+
+	if (should_run (name) == FALSE)
+		return;
+
+	document = g_strdup_printf (template, 0);
+	if (is_json == TRUE)
+		parsable = gdata_parsable_new_from_json (type, document, -1, &error);
+	else
+		parsable = gdata_parsable_new_from_xml (type, document, -1, &error);
+	g_assert_no_error (error);
+	g_free (document);
+
+	run_benchmark (name, func, parsable, 0);
+
+	g_object_unref (parsable);
+}
+
+/*
+ * Startup benchmarks. The first operation a process performs pays for registering and initialising the types it uses, setting up libxml and
+ * building the service's authorization domains, so it's measured once, cold, before any other benchmark runs; and then again, warm, as normal.
+ */
+static void
+start_up (gconstpointer user_data)
+{
+	GDataCalendarService *service;
+	GDataParsable *parsable;
+	GList *domains;
+	gchar *xml;
+	GError *error = NULL;
+
+	service = gdata_calendar_service_new (NULL);
+	domains = gdata_service_get_authorization_domains (G_OBJECT_TYPE (service));
+	g_assert (domains != NULL);
+	g_list_free (domains);
+
+	xml = g_strdup_printf (generic_entry_template, 0u);
+	parsable = gdata_parsable_new_from_xml (GDATA_TYPE_ENTRY, xml, -1, &error);
+	g_assert_no_error (error);
+	g_free (xml);
+
+	g_object_unref (parsable);
+	g_object_unref (service);
+}
+
+static void
+get_authorization_domains (gconstpointer user_data)
+{
+	g_list_free (gdata_service_get_authorization_domains (GDATA_TYPE_DOCUMENTS_SERVICE));
+}
+
+static void
+run_startup_benchmarks (void)
+{
+	if (should_run ("startup/cold") == TRUE) {
+		gint64 start, latency;
+		gsize allocations_start, allocations_end;
+		gchar number_buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+		/* This can only be done once per process, so it can't go through run_benchmark() */
+		allocations_start = get_n_allocations ();
+		start = g_get_monotonic_time ();
+		start_up (NULL);
+		latency = MAX (g_get_monotonic_time () - start, 1);
+		allocations_end = get_n_allocations ();
+
+		g_print ("{\"benchmark\": \"startup/cold\", \"iterations\": 1, \"ops_per_second\": %s, \"p50_us\": %" G_GINT64_FORMAT
+		         ", \"p99_us\": %" G_GINT64_FORMAT,
+		         g_ascii_dtostr (number_buffer, sizeof (number_buffer), (gdouble) G_USEC_PER_SEC / (gdouble) latency), latency, latency);
+
+		if (HAVE_ALLOCATION_COUNTING) {
+			g_print (", \"allocations_per_op\": %" G_GSIZE_FORMAT "}\n", allocations_end - allocations_start);
+		} else {
+			g_print (", \"allocations_per_op\": null}\n");
+		}
+	}
+
+	run_benchmark ("startup/warm", start_up, NULL, 0);
+	run_benchmark ("startup/authorization-domains", get_authorization_domains, NULL, 0);
+}
+
+/*
+ * Buffer benchmarks. Each operation transfers BUFFER_LENGTH bytes through a new GDataBuffer, pushed in chunks of a given size by one or more producer
+ * threads, and popped in chunks of the same size by the benchmark's thread.
+ */
+typedef enum {
+	BUFFER_LIST, /* chunk list, copying pushes, bounded as GDataDownloadStream bounds it */
+	BUFFER_LIST_ZERO_COPY, /* chunk list, pushes which don't copy */
+	BUFFER_RING, /* ring buffer; only supports a single producer */
+} BufferBackend;
+
+typedef struct {
+	BufferBackend backend;
+	gsize chunk_size;
+	guint n_producers;
+} BufferParams;
+
+typedef struct {
+	GDataBuffer *buffer;
+	const BufferParams *params;
+	const guint8 *data;
+	gsize length;
+} ProducerData;
+
+static guint8 *buffer_data = NULL;
+
+static void
+free_nothing (gpointer data)
+{
+	/* The pushed data is static */
+}
+
+static gpointer
+buffer_producer_thread (ProducerData *data)
+{
+	gsize offset;
+
+	for (offset = 0; offset < data->length; offset += data->params->chunk_size) {
+		gsize length = MIN (data->params->chunk_size, data->length - offset);
+
+		switch (data->params->backend) {
+			case BUFFER_LIST:
+				gdata_buffer_push_data_bounded (data->buffer, data->data + offset, length, NULL);
+				break;
+			case BUFFER_LIST_ZERO_COPY:
+				gdata_buffer_push_data_full (data->buffer, data->data + offset, length, free_nothing, NULL);
+				break;
+			case BUFFER_RING:
+				gdata_buffer_push_data (data->buffer, data->data + offset, length);
+				break;
+			default:
+				g_assert_not_reached ();
+		}
+	}
+
+	return NULL;
+}
+
+static void
+transfer_buffer (gconstpointer user_data)
+{
+	const BufferParams *params = user_data;
+	GDataBuffer *buffer;
+	ProducerData *producers;
+	GThread **threads;
+	guint8 *chunk;
+	gsize total_length = 0, share;
+	guint i;
+
+	if (params->backend == BUFFER_RING) {
+		buffer = gdata_buffer_new_ring (1024 * 1024);
+	} else {
+		buffer = gdata_buffer_new ();
+		gdata_buffer_set_limits (buffer, 1024 * 1024, 256 * 1024);
+	}
+
+	producers = g_new (ProducerData, params->n_producers);
+	threads = g_new (GThread*, params->n_producers);
+	share = BUFFER_LENGTH / params->n_producers;
+
+	for (i = 0; i < params->n_producers; i++) {
+		producers[i].buffer = buffer;
+		producers[i].params = params;
+		producers[i].data = buffer_data + i * share;
+		producers[i].length = (i == params->n_producers - 1) ? BUFFER_LENGTH - i * share : share;
+		threads[i] = g_thread_new ("producer", (GThreadFunc) buffer_producer_thread, &producers[i]);
+	}
+
+	chunk = g_malloc (params->chunk_size);
+
+	while (total_length < BUFFER_LENGTH)
+		total_length += gdata_buffer_pop_data (buffer, chunk, MIN (params->chunk_size, BUFFER_LENGTH - total_length), NULL, NULL);
+
+	g_assert_cmpuint (total_length, ==, BUFFER_LENGTH);
+
+	for (i = 0; i < params->n_producers; i++)
+		g_thread_join (threads[i]);
+
+	g_free (chunk);
+	g_free (threads);
+	g_free (producers);
+	gdata_buffer_free (buffer);
+}
+
+static void
+run_buffer_benchmarks (void)
+{
+	const gsize chunk_sizes[] = { 256, 4096, 65536 };
+	const guint producer_counts[] = { 1, 4 };
+	BufferParams params;
+	gchar *name;
+	guint i, j;
+
+	buffer_data = g_malloc (BUFFER_LENGTH);
+	for (i = 0; i < BUFFER_LENGTH; i++)
+		buffer_data[i] = i & 0xff;
+
+	for (i = 0; i < G_N_ELEMENTS (chunk_sizes); i++) {
+		params.chunk_size = chunk_sizes[i];
+
+		for (j = 0; j < G_N_ELEMENTS (producer_counts); j++) {
+			params.backend = BUFFER_LIST;
+			params.n_producers = producer_counts[j];
+			name = g_strdup_printf ("buffer/list/%" G_GSIZE_FORMAT "/%u", params.chunk_size, params.n_producers);
+			run_benchmark (name, transfer_buffer, &params, BUFFER_LENGTH);
+			g_free (name);
+
+			params.backend = BUFFER_LIST_ZERO_COPY;
+			name = g_strdup_printf ("buffer/list-zero-copy/%" G_GSIZE_FORMAT "/%u", params.chunk_size, params.n_producers);
+			run_benchmark (name, transfer_buffer, &params, BUFFER_LENGTH);
+			g_free (name);
+		}
+
+		/* The ring buffer only supports a single producer */
+		params.backend = BUFFER_RING;
+		params.n_producers = 1;
+		name = g_strdup_printf ("buffer/ring/%" G_GSIZE_FORMAT "/1", params.chunk_size);
+		run_benchmark (name, transfer_buffer, &params, BUFFER_LENGTH);
+		g_free (name);
+	}
+
+	g_free (buffer_data);
+	buffer_data = NULL;
+}
+
+/*
+ * Stream benchmarks, run against a local HTTP server.
+ */
+static guint8 *stream_data = NULL;
+
+static void
+server_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query, SoupClientContext *client, gpointer user_data)
+{
+	if (strcmp (path, "/download") == 0) {
+		soup_message_set_status (message, SOUP_STATUS_OK);
+		soup_message_headers_set_content_type (message->response_headers, "application/octet-stream", NULL);
+		soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, stream_data, STREAM_LENGTH);
+	} else {
+		/* Uploads */
+		g_assert_cmpint (message->request_body->length, ==, STREAM_LENGTH);
+
+		soup_message_set_status (message, SOUP_STATUS_OK);
+		soup_message_headers_set_content_type (message->response_headers, "text/plain", NULL);
+		soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, "OK", 2);
+	}
+}
+
+static gpointer
+run_server_thread (SoupServer *server)
+{
+	soup_server_run (server);
+
+	return NULL;
+}
+
+static gboolean
+quit_server_cb (SoupServer *server)
+{
+	soup_server_quit (server);
+
+	return FALSE;
+}
+
+typedef struct {
+	GDataService *service;
+	gchar *download_uri;
+	gchar *upload_uri;
+} StreamData;
+
+static void
+download_stream (gconstpointer user_data)
+{
+	const StreamData *data = user_data;
+	GInputStream *stream;
+	guint8 buffer[65536];
+	gssize length_read;
+	gsize total_length = 0;
+	GError *error = NULL;
+
+	stream = gdata_download_stream_new (data->service, NULL, data->download_uri, NULL);
+
+	while ((length_read = g_input_stream_read (stream, buffer, sizeof (buffer), NULL, &error)) > 0)
+		total_length += length_read;
+
+	g_assert_no_error (error);
+	g_assert_cmpuint (total_length, ==, STREAM_LENGTH);
+
+	g_input_stream_close (stream, NULL, &error);
+	g_assert_no_error (error);
+
+	g_object_unref (stream);
+}
+
+static void
+upload_stream (gconstpointer user_data)
+{
+	const StreamData *data = user_data;
+	GOutputStream *stream;
+	gssize length_written;
+	gsize total_length = 0;
+	GError *error = NULL;
+
+	stream = gdata_upload_stream_new (data->service, NULL, SOUP_METHOD_POST, data->upload_uri, NULL, "slug", "application/octet-stream", NULL);
+
+	while (total_length < STREAM_LENGTH &&
+	       (length_written = g_output_stream_write (stream, stream_data + total_length, STREAM_LENGTH - total_length, NULL, &error)) > 0)
+		total_length += length_written;
+
+	g_assert_no_error (error);
+	g_assert_cmpuint (total_length, ==, STREAM_LENGTH);
+
+	g_output_stream_close (stream, NULL, &error);
+	g_assert_no_error (error);
+
+	g_object_unref (stream);
+}
+
+static void
+run_stream_benchmarks (void)
+{
+	union {
+		struct sockaddr_in in;
+		struct sockaddr norm;
+	} sock;
+	SoupAddress *addr;
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	StreamData data;
+	gchar *base_uri, *port_string;
+	guint i;
+
+	if (should_run ("stream/download") == FALSE && should_run ("stream/upload") == FALSE)
+		return;
+
+	stream_data = g_malloc (STREAM_LENGTH);
+	for (i = 0; i < STREAM_LENGTH; i++)
+		stream_data[i] = i & 0xff;
+
+	/* Create and run the server on a random loopback port */
+	memset (&sock, 0, sizeof (sock));
+	sock.in.sin_family = AF_INET;
+	sock.in.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+	sock.in.sin_port = htons (0);
+
+	addr = soup_address_new_from_sockaddr (&sock.norm, sizeof (sock.norm));
+	async_context = g_main_context_new ();
+	server = soup_server_new (SOUP_SERVER_INTERFACE, addr, SOUP_SERVER_ASYNC_CONTEXT, async_context, NULL);
+	soup_server_add_handler (server, NULL, (SoupServerCallback) server_handler_cb, NULL, NULL);
+	g_object_unref (addr);
+
+	thread = g_thread_new ("server-thread", (GThreadFunc) run_server_thread, server);
+
+	/* Set the port so that libgdata doesn't override it */
+	port_string = g_strdup_printf ("%u", soup_server_get_port (server));
+	g_setenv ("LIBGDATA_HTTPS_PORT", port_string, TRUE);
+	g_free (port_string);
+
+	base_uri = g_strdup_printf ("http://%s:%u",
+	                            soup_address_get_physical (soup_socket_get_local_address (soup_server_get_listener (server))),
+	                            soup_server_get_port (server));
+
+	data.service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	data.download_uri = g_strconcat (base_uri, "/download", NULL);
+	data.upload_uri = g_strconcat (base_uri, "/upload", NULL);
+	g_free (base_uri);
+
+	run_benchmark ("stream/download", download_stream, &data, STREAM_LENGTH);
+	run_benchmark ("stream/upload", upload_stream, &data, STREAM_LENGTH);
+
+	g_free (data.upload_uri);
+	g_free (data.download_uri);
+	g_object_unref (data.service);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+
+	g_free (stream_data);
+	stream_data = NULL;
+}
+
 int
 main (int argc, char *argv[])
 {
-	GTimeVal start_time, end_time;
-	guint i;
-	gdouble total_time;
+	GOptionContext *context;
+	GError *error = NULL;
+	guint n_entries;
+	const GOptionEntry entries[] = {
+		{ "full", 0, 0, G_OPTION_ARG_NONE, &full, "Also run the 100 000-entry workloads", NULL },
+		{ "filter", 0, 0, G_OPTION_ARG_STRING, &filter, "Only run benchmarks whose names contain STRING", "STRING" },
+		{ "min-time", 0, 0, G_OPTION_ARG_DOUBLE, &min_time, "Minimum time to run each benchmark for, in seconds (default: 0.2)", "SECONDS" },
+		{ "scale-max", 0, 0, G_OPTION_ARG_INT, &scale_max,
+		  "Largest feed to run the scale benchmarks on, in entries, up to 1 000 000 (default: 10 000, or 100 000 with --full)", "ENTRIES" },
+		{ NULL }
+	};
 
-	#define ITERATIONS 10000
+	/* Make slice allocations go through malloc() so that they're counted. This must be done before GLib allocates anything. */
+	g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+	setlocale (LC_ALL, "");
 
 #if !GLIB_CHECK_VERSION (2, 35, 0)
 	g_type_init ();
 #endif
 
-	/* Test feed parsing time */
-	g_get_current_time (&start_time);
-	for (i = 0; i < ITERATIONS; i++)
-		test_parse_feed ();
-	g_get_current_time (&end_time);
+	context = g_option_context_new ("— run libgdata benchmarks");
+	g_option_context_add_main_entries (context, entries, NULL);
+
+	if (g_option_context_parse (context, &argc, &argv, &error) == FALSE) {
+		g_printerr ("%s\n", error->message);
+		g_error_free (error);
+		g_option_context_free (context);
+		return 1;
+	}
+
+	g_option_context_free (context);
+
+	/* Startup; this must come first, so that nothing else has initialised the library yet */
+	run_startup_benchmarks ();
+
+	/* Parsing */
+	run_parse_benchmarks (10);
+	run_parse_benchmarks (1000);
+	if (full == TRUE)
+		run_parse_benchmarks (100000);
+
+	if (scale_max <= 0)
+		scale_max = (full == TRUE) ? 100000 : 10000;
+	for (n_entries = 1000; n_entries <= (guint) scale_max && n_entries <= 1000000; n_entries *= 10)
+		run_scale_benchmarks (n_entries);
+
+	run_libxml_benchmarks ();
+
+	/* Calendar date and time conversions */
+	run_calendar_benchmarks ();
+
+	/* Serialisation */
+	run_serialisation_benchmark ("serialise-xml/calendar-event", serialise_xml, GDATA_TYPE_CALENDAR_EVENT, calendar_event_template, FALSE);
+	run_serialisation_benchmark ("serialise-xml/contacts-contact", serialise_xml, GDATA_TYPE_CONTACTS_CONTACT, contact_template, FALSE);
+	run_serialisation_benchmark ("serialise-json/tasks-task", serialise_json, GDATA_TYPE_TASKS_TASK, task_template, TRUE);
+	run_serialisation_benchmark ("serialise-json-tree/tasks-task", serialise_json, tree_task_get_type (), task_template, TRUE);
 
-	total_time = (gdouble) (end_time.tv_sec - start_time.tv_sec) + (gdouble) (end_time.tv_usec - start_time.tv_usec) / (gdouble) G_USEC_PER_SEC;
+	/* Buffers and streams */
+	run_buffer_benchmarks ();
+	run_stream_benchmarks ();
 
-	g_message ("Parsing a feed %u times took:\n * Total: %fs\n * Per iteration: %fs",
-	           ITERATIONS, total_time, total_time / (gdouble) ITERATIONS);
+	g_free (filter);
 
 	return 0;
 }
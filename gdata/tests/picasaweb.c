@@ -654,6 +654,131 @@ test_query_files_single (QueryFilesData *data, gconstpointer service)
 	uhm_server_end_trace (mock_server);
 }
 
+typedef struct {
+	GPtrArray *files; /* all the files delivered, in order */
+	guint n_batches;
+	GThread *thread; /* thread the batches are expected to be delivered in */
+	GMainLoop *main_loop; /* only used for the async test */
+	gboolean success;
+} QueryAllFilesData;
+
+static void
+query_all_files_cb (GDataPicasaWebAlbum *album, GPtrArray *files, QueryAllFilesData *data)
+{
+	guint i;
+
+	g_assert (GDATA_IS_PICASAWEB_ALBUM (album));
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (album)), ==, "Holiday");
+	g_assert (g_thread_self () == data->thread);
+
+	for (i = 0; i < files->len; i++) {
+		g_assert (GDATA_IS_PICASAWEB_FILE (files->pdata[i]));
+		g_ptr_array_add (data->files, g_object_ref (files->pdata[i]));
+	}
+
+	data->n_batches++;
+}
+
+/* Checks that all the pages of the album's files were delivered, in order */
+static void
+assert_all_files_queried (QueryAllFilesData *data)
+{
+	g_assert_cmpuint (data->n_batches, ==, 1);
+	g_assert_cmpuint (data->files->len, ==, 3);
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (data->files->pdata[0])), ==, "First.jpg");
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (data->files->pdata[1])), ==, "Second.jpg");
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (data->files->pdata[2])), ==, "Third.jpg");
+}
+
+static void
+test_query_all_files (gconstpointer service)
+{
+	QueryAllFilesData data = { NULL, };
+	gboolean success;
+	GError *error = NULL;
+
+	gdata_test_mock_server_start_trace (mock_server, "query-all-files");
+
+	data.files = g_ptr_array_new_with_free_func (g_object_unref);
+	data.thread = g_thread_self ();
+
+	success = gdata_picasaweb_service_query_all_files (GDATA_PICASAWEB_SERVICE (service), NULL, NULL, NULL,
+	                                                   (GDataPicasaWebFilesCallback) query_all_files_cb, &data, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	assert_all_files_queried (&data);
+
+	g_ptr_array_unref (data.files);
+
+	uhm_server_end_trace (mock_server);
+}
+
+static void
+test_query_all_files_error (gconstpointer service)
+{
+	QueryAllFilesData data = { NULL, };
+	gboolean success;
+	GError *error = NULL;
+
+	gdata_test_mock_server_start_trace (mock_server, "query-all-files-error");
+
+	data.files = g_ptr_array_new_with_free_func (g_object_unref);
+	data.thread = g_thread_self ();
+
+	/* The album's files can't be queried, so the error's returned and no files are delivered */
+	success = gdata_picasaweb_service_query_all_files (GDATA_PICASAWEB_SERVICE (service), NULL, NULL, NULL,
+	                                                   (GDataPicasaWebFilesCallback) query_all_files_cb, &data, &error);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+	g_assert (success == FALSE);
+	g_clear_error (&error);
+
+	g_assert_cmpuint (data.n_batches, ==, 0);
+
+	g_ptr_array_unref (data.files);
+
+	uhm_server_end_trace (mock_server);
+}
+
+static void
+query_all_files_async_cb (GDataPicasaWebService *service, GAsyncResult *async_result, QueryAllFilesData *data)
+{
+	GError *error = NULL;
+
+	data->success = gdata_picasaweb_service_query_all_files_finish (service, async_result, &error);
+	g_assert_no_error (error);
+
+	/* All the batches must have been delivered by now */
+	assert_all_files_queried (data);
+
+	g_main_loop_quit (data->main_loop);
+}
+
+static void
+test_query_all_files_async (gconstpointer service)
+{
+	QueryAllFilesData data = { NULL, };
+
+	gdata_test_mock_server_start_trace (mock_server, "query-all-files");
+
+	data.files = g_ptr_array_new_with_free_func (g_object_unref);
+	data.thread = g_thread_self ();
+	data.main_loop = g_main_loop_new (NULL, FALSE);
+
+	/* The batches are delivered in this thread's main context, rather than the thread doing the query */
+	gdata_picasaweb_service_query_all_files_async (GDATA_PICASAWEB_SERVICE (service), NULL, NULL, NULL,
+	                                               (GDataPicasaWebFilesCallback) query_all_files_cb, &data, NULL,
+	                                               (GAsyncReadyCallback) query_all_files_async_cb, &data);
+	g_main_loop_run (data.main_loop);
+
+	g_assert (data.success == TRUE);
+
+	g_main_loop_unref (data.main_loop);
+	g_ptr_array_unref (data.files);
+
+	uhm_server_end_trace (mock_server);
+}
+
 static void
 test_download_thumbnails (QueryFilesData *data, gconstpointer service)
 {
@@ -1516,6 +1641,403 @@ G_STMT_START {
 	}
 } G_STMT_END);
 
+/* Builds a list of files 2001, 2002 and 2003 in album 1001, for testing the functions which operate on the comments of multiple commentables.
+ * Free it with g_list_free_full (files, g_object_unref). */
+static GList *
+build_commentable_files (void)
+{
+	GList *files = NULL;
+	guint i;
+	const gchar *xml_format =
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gphoto='http://schemas.google.com/photos/2007'>"
+			"<id>https://picasaweb.google.com/data/entry/api/user/default/albumid/1001/photoid/%u</id>"
+			"<updated>2026-10-14T09:00:00.000Z</updated>"
+			"<title type='text'>Photo %u</title>"
+			"<category term='http://schemas.google.com/photos/2007#photo' scheme='http://schemas.google.com/g/2005#kind'/>"
+			"<link rel='http://schemas.google.com/g/2005#feed' type='application/atom+xml' "
+			      "href='https://picasaweb.google.com/data/feed/api/user/default/albumid/1001/photoid/%u'/>"
+			"<gphoto:id>%u</gphoto:id>"
+		"</entry>";
+
+	for (i = 2001; i <= 2003; i++) {
+		GDataPicasaWebFile *file;
+		gchar *xml;
+		GError *error = NULL;
+
+		xml = g_strdup_printf (xml_format, i, i, i, i);
+		file = GDATA_PICASAWEB_FILE (gdata_parsable_new_from_xml (GDATA_TYPE_PICASAWEB_FILE, xml, -1, &error));
+		g_assert_no_error (error);
+		g_free (xml);
+
+		files = g_list_append (files, file);
+	}
+
+	return files;
+}
+
+typedef struct {
+	GHashTable *results; /* GDataCommentable to its GDataFeed or GError */
+	GThread *thread; /* thread the callbacks are expected to be called in */
+	GMainLoop *main_loop; /* only used for the async test */
+	gboolean success;
+} QueryCommentsMultipleData;
+
+static void
+query_comments_multiple_cb (GDataCommentable *commentable, GDataFeed *comments, GError *error, QueryCommentsMultipleData *data)
+{
+	g_assert (GDATA_IS_PICASAWEB_FILE (commentable));
+	g_assert ((comments == NULL) != (error == NULL));
+	g_assert (g_thread_self () == data->thread);
+
+	/* Each commentable is reported exactly once */
+	g_assert (g_hash_table_lookup (data->results, commentable) == NULL);
+	g_hash_table_insert (data->results, commentable, (comments != NULL) ? (gpointer) g_object_ref (comments) : (gpointer) g_error_copy (error));
+}
+
+static void
+assert_comments_multiple_queried (QueryCommentsMultipleData *data, GList *files)
+{
+	GDataFeed *feed;
+	GError *error;
+	GList *comments;
+
+	g_assert_cmpuint (g_hash_table_size (data->results), ==, 3);
+
+	/* The first file has two comments */
+	feed = g_hash_table_lookup (data->results, files->data);
+	g_assert (GDATA_IS_FEED (feed));
+	comments = gdata_feed_get_entries (feed);
+	g_assert_cmpuint (g_list_length (comments), ==, 2);
+	g_assert (GDATA_IS_PICASAWEB_COMMENT (comments->data));
+	g_assert_cmpstr (gdata_entry_get_content (GDATA_ENTRY (comments->data)), ==, "Nice");
+	g_assert_cmpstr (gdata_entry_get_content (GDATA_ENTRY (comments->next->data)), ==, "Lovely");
+	g_object_unref (feed);
+
+	/* The second couldn't be queried, which didn't stop the third from being queried */
+	error = g_hash_table_lookup (data->results, files->next->data);
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+	g_error_free (error);
+
+	feed = g_hash_table_lookup (data->results, files->next->next->data);
+	g_assert (GDATA_IS_FEED (feed));
+	g_assert (gdata_feed_get_entries (feed) == NULL);
+	g_object_unref (feed);
+
+	g_hash_table_remove_all (data->results);
+}
+
+static void
+test_comment_query_multiple (gconstpointer service)
+{
+	QueryCommentsMultipleData data = { NULL, };
+	GList *files;
+	guint old_max_connections;
+	gboolean success;
+	GError *error = NULL;
+
+	gdata_test_mock_server_start_trace (mock_server, "comment-query-multiple");
+
+	/* Query the files one at a time so that the requests are made in the same order as in the trace */
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	files = build_commentable_files ();
+	data.results = g_hash_table_new (g_direct_hash, g_direct_equal);
+	data.thread = g_thread_self ();
+
+	success = gdata_commentable_query_comments_multiple (GDATA_SERVICE (service), files, NULL, NULL,
+	                                                     (GDataCommentableCommentsCallback) query_comments_multiple_cb, &data, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	assert_comments_multiple_queried (&data, files);
+
+	g_hash_table_unref (data.results);
+	g_list_free_full (files, g_object_unref);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+
+	uhm_server_end_trace (mock_server);
+}
+
+static void
+query_comments_multiple_async_cb (GDataService *service, GAsyncResult *async_result, QueryCommentsMultipleData *data)
+{
+	GError *error = NULL;
+
+	data->success = gdata_commentable_query_comments_multiple_finish (service, async_result, &error);
+	g_assert_no_error (error);
+
+	g_main_loop_quit (data->main_loop);
+}
+
+static void
+test_comment_query_multiple_async (gconstpointer service)
+{
+	QueryCommentsMultipleData data = { NULL, };
+	GList *files;
+	guint old_max_connections;
+
+	gdata_test_mock_server_start_trace (mock_server, "comment-query-multiple");
+
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	files = build_commentable_files ();
+	data.results = g_hash_table_new (g_direct_hash, g_direct_equal);
+	data.thread = g_thread_self ();
+	data.main_loop = g_main_loop_new (NULL, FALSE);
+
+	/* The callbacks are called in this thread's main context, and all of them before the operation finishes */
+	gdata_commentable_query_comments_multiple_async (GDATA_SERVICE (service), files, NULL, NULL,
+	                                                 (GDataCommentableCommentsCallback) query_comments_multiple_cb, &data, NULL,
+	                                                 (GAsyncReadyCallback) query_comments_multiple_async_cb, &data);
+	g_main_loop_run (data.main_loop);
+
+	g_assert (data.success == TRUE);
+	assert_comments_multiple_queried (&data, files);
+
+	g_main_loop_unref (data.main_loop);
+	g_hash_table_unref (data.results);
+	g_list_free_full (files, g_object_unref);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+
+	uhm_server_end_trace (mock_server);
+}
+
+typedef struct {
+	GPtrArray *results; /* GDataComment result or GError for each comment, by index */
+	guint n_callbacks;
+	GThread *thread;
+	GMainLoop *main_loop; /* only used for the async test */
+	gboolean success;
+} ModifyCommentsMultipleData;
+
+static void
+modify_comments_multiple_cb (guint index, GDataCommentable *commentable, GDataComment *comment_, GDataComment *result, GError *error,
+                             ModifyCommentsMultipleData *data)
+{
+	g_assert (GDATA_IS_PICASAWEB_FILE (commentable));
+	g_assert (GDATA_IS_PICASAWEB_COMMENT (comment_));
+	g_assert (result == NULL || error == NULL);
+	g_assert (g_thread_self () == data->thread);
+
+	g_assert_cmpuint (index, <, data->results->len);
+	g_assert (data->results->pdata[index] == NULL);
+
+	if (error != NULL)
+		data->results->pdata[index] = g_error_copy (error);
+	else if (result != NULL)
+		data->results->pdata[index] = g_object_ref (result);
+	else
+		data->results->pdata[index] = comment_; /* marker for a successful deletion */
+
+	data->n_callbacks++;
+}
+
+static GList *
+build_new_comments (void)
+{
+	GList *comments = NULL;
+	const gchar * const contents[] = { "First comment", "Second comment", "Third comment" };
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (contents); i++) {
+		GDataPicasaWebComment *comment_ = gdata_picasaweb_comment_new (NULL);
+		gdata_entry_set_content (GDATA_ENTRY (comment_), contents[i]);
+		comments = g_list_append (comments, comment_);
+	}
+
+	return comments;
+}
+
+static void
+assert_comments_multiple_inserted (ModifyCommentsMultipleData *data)
+{
+	GDataComment *comment_;
+	GError *error;
+
+	g_assert_cmpuint (data->n_callbacks, ==, 3);
+
+	/* The second comment couldn't be added, which didn't stop the third from being added */
+	comment_ = data->results->pdata[0];
+	g_assert (GDATA_IS_PICASAWEB_COMMENT (comment_));
+	g_assert_cmpstr (gdata_entry_get_content (GDATA_ENTRY (comment_)), ==, "First comment");
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (comment_)), ==,
+	                 "https://picasaweb.google.com/data/entry/api/user/default/albumid/1001/photoid/2001/commentid/3011");
+	g_object_unref (comment_);
+
+	error = data->results->pdata[1];
+	g_assert_error (error, GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+	g_error_free (error);
+
+	comment_ = data->results->pdata[2];
+	g_assert (GDATA_IS_PICASAWEB_COMMENT (comment_));
+	g_assert_cmpstr (gdata_entry_get_content (GDATA_ENTRY (comment_)), ==, "Third comment");
+	g_object_unref (comment_);
+}
+
+static void
+test_comment_insert_multiple (gconstpointer service)
+{
+	ModifyCommentsMultipleData data = { NULL, };
+	GList *files, *comments;
+	guint old_max_connections;
+	gboolean success;
+	GError *error = NULL;
+
+	gdata_test_mock_server_start_trace (mock_server, "comment-insert-multiple");
+
+	/* Add the comments one at a time so that the requests are made in the same order as in the trace */
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	files = build_commentable_files ();
+	comments = build_new_comments ();
+	data.results = g_ptr_array_new ();
+	g_ptr_array_set_size (data.results, 3);
+	data.thread = g_thread_self ();
+
+	success = gdata_commentable_insert_comments_multiple (GDATA_SERVICE (service), files, comments, NULL,
+	                                                      (GDataCommentableBatchCallback) modify_comments_multiple_cb, &data, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	assert_comments_multiple_inserted (&data);
+
+	g_ptr_array_unref (data.results);
+	g_list_free_full (comments, g_object_unref);
+	g_list_free_full (files, g_object_unref);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+
+	uhm_server_end_trace (mock_server);
+}
+
+static void
+insert_comments_multiple_async_cb (GDataService *service, GAsyncResult *async_result, ModifyCommentsMultipleData *data)
+{
+	GError *error = NULL;
+
+	data->success = gdata_commentable_insert_comments_multiple_finish (service, async_result, &error);
+	g_assert_no_error (error);
+
+	g_main_loop_quit (data->main_loop);
+}
+
+static void
+test_comment_insert_multiple_async (gconstpointer service)
+{
+	ModifyCommentsMultipleData data = { NULL, };
+	GList *files, *comments;
+	guint old_max_connections;
+
+	gdata_test_mock_server_start_trace (mock_server, "comment-insert-multiple");
+
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	files = build_commentable_files ();
+	comments = build_new_comments ();
+	data.results = g_ptr_array_new ();
+	g_ptr_array_set_size (data.results, 3);
+	data.thread = g_thread_self ();
+	data.main_loop = g_main_loop_new (NULL, FALSE);
+
+	/* The lists are copied, so can be freed straight away */
+	gdata_commentable_insert_comments_multiple_async (GDATA_SERVICE (service), files, comments, NULL,
+	                                                  (GDataCommentableBatchCallback) modify_comments_multiple_cb, &data, NULL,
+	                                                  (GAsyncReadyCallback) insert_comments_multiple_async_cb, &data);
+	g_list_free_full (comments, g_object_unref);
+	g_list_free_full (files, g_object_unref);
+
+	g_main_loop_run (data.main_loop);
+
+	g_assert (data.success == TRUE);
+	assert_comments_multiple_inserted (&data);
+
+	g_main_loop_unref (data.main_loop);
+	g_ptr_array_unref (data.results);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+
+	uhm_server_end_trace (mock_server);
+}
+
+static void
+test_comment_delete_multiple (gconstpointer service)
+{
+	ModifyCommentsMultipleData data = { NULL, };
+	GList *files, *comments = NULL;
+	guint old_max_connections, i;
+	gboolean success;
+	GError *error = NULL;
+	const gchar *xml_format =
+		"<entry xmlns='http://www.w3.org/2005/Atom' xmlns:gphoto='http://schemas.google.com/photos/2007'>"
+			"<id>https://picasaweb.google.com/data/entry/api/user/default/albumid/1001/photoid/%u/commentid/%u</id>"
+			"<updated>2026-10-14T09:00:00.000Z</updated>"
+			"<title type='text'>Alice</title>"
+			"<content type='text'>Comment</content>"
+			"<category term='http://schemas.google.com/photos/2007#comment' scheme='http://schemas.google.com/g/2005#kind'/>"
+			"%s"
+		"</entry>";
+
+	gdata_test_mock_server_start_trace (mock_server, "comment-delete-multiple");
+
+	/* Delete the comments one at a time so that the requests are made in the same order as in the trace */
+	old_max_connections = gdata_service_get_max_connections_per_host (GDATA_SERVICE (service));
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), 1);
+
+	/* The second comment has no edit link, so may not be deleted */
+	for (i = 1; i <= 3; i++) {
+		GDataPicasaWebComment *comment_;
+		gchar *edit_link = NULL, *xml;
+
+		if (i != 2) {
+			edit_link = g_strdup_printf ("<link rel='edit' type='application/atom+xml' "
+			                             "href='https://picasaweb.google.com/data/entry/api/user/default/albumid/1001/photoid/%u/"
+			                             "commentid/%u'/>", 2000 + i, 3000 + i);
+		}
+
+		xml = g_strdup_printf (xml_format, 2000 + i, 3000 + i, (edit_link != NULL) ? edit_link : "");
+		comment_ = GDATA_PICASAWEB_COMMENT (gdata_parsable_new_from_xml (GDATA_TYPE_PICASAWEB_COMMENT, xml, -1, &error));
+		g_assert_no_error (error);
+		comments = g_list_append (comments, comment_);
+
+		g_free (xml);
+		g_free (edit_link);
+	}
+
+	files = build_commentable_files ();
+	data.results = g_ptr_array_new ();
+	g_ptr_array_set_size (data.results, 3);
+	data.thread = g_thread_self ();
+
+	success = gdata_commentable_delete_comments_multiple (GDATA_SERVICE (service), files, comments, NULL,
+	                                                      (GDataCommentableBatchCallback) modify_comments_multiple_cb, &data, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	/* Each comment is reported individually, whether it was deleted, refused locally or failed on the server */
+	g_assert_cmpuint (data.n_callbacks, ==, 3);
+	g_assert (data.results->pdata[0] == comments->data);
+
+	g_assert_error ((GError*) data.results->pdata[1], GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_FORBIDDEN);
+	g_error_free (data.results->pdata[1]);
+
+	g_assert_error ((GError*) data.results->pdata[2], GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_NOT_FOUND);
+	g_error_free (data.results->pdata[2]);
+
+	g_ptr_array_unref (data.results);
+	g_list_free_full (comments, g_object_unref);
+	g_list_free_full (files, g_object_unref);
+
+	gdata_service_set_max_connections_per_host (GDATA_SERVICE (service), old_max_connections);
+
+	uhm_server_end_trace (mock_server);
+}
+
 static void
 test_query_user (gconstpointer service)
 {
@@ -1535,6 +2057,27 @@ test_query_user (gconstpointer service)
 	uhm_server_end_trace (mock_server);
 }
 
+/* Check that the user cache's TTL property defaults sensibly and can be changed. */
+static void
+test_service_properties_user_cache_ttl (void)
+{
+	GDataPicasaWebService *service;
+	guint ttl;
+
+	service = gdata_picasaweb_service_new (NULL);
+
+	g_assert_cmpuint (gdata_picasaweb_service_get_user_cache_ttl (service), ==, 60);
+
+	gdata_picasaweb_service_set_user_cache_ttl (service, 0);
+	g_assert_cmpuint (gdata_picasaweb_service_get_user_cache_ttl (service), ==, 0);
+
+	g_object_set (G_OBJECT (service), "user-cache-ttl", 3600, NULL);
+	g_object_get (G_OBJECT (service), "user-cache-ttl", &ttl, NULL);
+	g_assert_cmpuint (ttl, ==, 3600);
+
+	g_object_unref (service);
+}
+
 /* Check that asynchronously querying for the currently authenticated user's details works and returns the correct details. */
 GDATA_ASYNC_TEST_FUNCTIONS (query_user, void,
 G_STMT_START {
@@ -2013,6 +2556,62 @@ test_file_properties_coordinates (void)
 	g_object_unref (file);
 }
 
+static void
+test_file_exif (void)
+{
+	GDataPicasaWebFile *file;
+	gdouble latitude, longitude;
+
+	/* A JPEG file with no image data, but an APP1 segment containing an image description, a DateTimeOriginal of 2010:05:06 07:08:09
+	 * and GPS coordinates of 51° 30' 0" N, 0° 7' 30" W */
+	const guint8 jpeg[] = {
+		0xff, 0xd8, 0xff, 0xe1, 0x00, 0xce, 0x45, 0x78, 0x69, 0x66, 0x00, 0x00, 0x49, 0x49, 0x2a, 0x00, 0x08, 0x00, 0x00, 0x00,
+		0x03, 0x00, 0x0e, 0x01, 0x02, 0x00, 0x08, 0x00, 0x00, 0x00, 0x32, 0x00, 0x00, 0x00, 0x69, 0x87, 0x04, 0x00, 0x01, 0x00,
+		0x00, 0x00, 0x3a, 0x00, 0x00, 0x00, 0x25, 0x88, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x60, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x43, 0x61, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x00, 0x01, 0x00, 0x03, 0x90, 0x02, 0x00, 0x14, 0x00, 0x00, 0x00,
+		0x4c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x32, 0x30, 0x31, 0x30, 0x3a, 0x30, 0x35, 0x3a, 0x30, 0x36, 0x20, 0x30,
+		0x37, 0x3a, 0x30, 0x38, 0x3a, 0x30, 0x39, 0x00, 0x04, 0x00, 0x01, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x4e, 0x00,
+		0x00, 0x00, 0x02, 0x00, 0x05, 0x00, 0x03, 0x00, 0x00, 0x00, 0x96, 0x00, 0x00, 0x00, 0x03, 0x00, 0x02, 0x00, 0x02, 0x00,
+		0x00, 0x00, 0x57, 0x00, 0x00, 0x00, 0x04, 0x00, 0x05, 0x00, 0x03, 0x00, 0x00, 0x00, 0xae, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x33, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x01, 0x00,
+		0x00, 0x00, 0x1e, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0xff, 0xd9
+	};
+
+	file = gdata_picasaweb_file_new (NULL);
+
+	/* Truncated or invalid data should be ignored */
+	g_assert (gdata_picasaweb_file_update_from_exif (file, jpeg, 40) == FALSE);
+	g_assert (gdata_picasaweb_file_update_from_exif (file, jpeg + 2, sizeof (jpeg) - 2) == FALSE);
+	g_assert_cmpint (gdata_picasaweb_file_get_timestamp (file), ==, -1);
+	g_assert (gdata_picasaweb_file_get_caption (file) == NULL);
+
+	/* Parse the whole header */
+	g_assert (gdata_picasaweb_file_update_from_exif (file, jpeg, sizeof (jpeg)) == TRUE);
+
+	g_assert_cmpint (gdata_picasaweb_file_get_timestamp (file), ==, 1273129689000);
+	g_assert_cmpstr (gdata_picasaweb_file_get_caption (file), ==, "Caption");
+	gdata_picasaweb_file_get_coordinates (file, &latitude, &longitude);
+	g_assert_cmpfloat (latitude, ==, 51.5);
+	g_assert_cmpfloat (longitude, ==, -0.125);
+
+	g_object_unref (file);
+
+	/* Properties which have already been set shouldn't be overwritten */
+	file = gdata_picasaweb_file_new (NULL);
+	gdata_picasaweb_file_set_caption (file, "Existing caption");
+	gdata_picasaweb_file_set_timestamp (file, 1000);
+
+	g_assert (gdata_picasaweb_file_update_from_exif (file, jpeg, sizeof (jpeg)) == TRUE);
+
+	g_assert_cmpint (gdata_picasaweb_file_get_timestamp (file), ==, 1000);
+	g_assert_cmpstr (gdata_picasaweb_file_get_caption (file), ==, "Existing caption");
+	gdata_picasaweb_file_get_coordinates (file, &latitude, &longitude);
+	g_assert_cmpfloat (latitude, ==, 51.5);
+
+	g_object_unref (file);
+}
+
 static void
 test_comment_get_xml (void)
 {
@@ -2150,6 +2749,9 @@ main (int argc, char *argv[])
 	            test_query_files_async_cancellation, tear_down_query_files_async);
 	g_test_add ("/picasaweb/query/files/single", QueryFilesData, service, set_up_query_files, test_query_files_single,
 	            tear_down_query_files);
+	g_test_add_data_func ("/picasaweb/query/all_files", service, test_query_all_files);
+	g_test_add_data_func ("/picasaweb/query/all_files/error", service, test_query_all_files_error);
+	g_test_add_data_func ("/picasaweb/query/all_files/async", service, test_query_all_files_async);
 
 	g_test_add ("/picasaweb/comment/query", QueryCommentsData, service, set_up_query_comments, test_comment_query,
 	            tear_down_query_comments);
@@ -2173,6 +2775,11 @@ main (int argc, char *argv[])
 	            tear_down_query_comments_async);
 	g_test_add ("/picasaweb/comment/delete/async/cancellation", GDataAsyncTestData, service, set_up_query_comments_async,
 	            test_comment_delete_async_cancellation, tear_down_query_comments_async);
+	g_test_add_data_func ("/picasaweb/comment/query/multiple", service, test_comment_query_multiple);
+	g_test_add_data_func ("/picasaweb/comment/query/multiple/async", service, test_comment_query_multiple_async);
+	g_test_add_data_func ("/picasaweb/comment/insert/multiple", service, test_comment_insert_multiple);
+	g_test_add_data_func ("/picasaweb/comment/insert/multiple/async", service, test_comment_insert_multiple_async);
+	g_test_add_data_func ("/picasaweb/comment/delete/multiple", service, test_comment_delete_multiple);
 
 	g_test_add ("/picasaweb/upload/default_album", UploadData, service, set_up_upload, test_upload_default_album, tear_down_upload);
 	g_test_add ("/picasaweb/upload/default_album/async", GDataAsyncTestData, service, set_up_upload_async, test_upload_default_album_async,
@@ -2184,6 +2791,8 @@ main (int argc, char *argv[])
 	g_test_add ("/picasaweb/download/thumbnails", QueryFilesData, service, set_up_query_files, test_download_thumbnails,
 	            tear_down_query_files);
 
+	g_test_add_func ("/picasaweb/service/properties/user-cache-ttl", test_service_properties_user_cache_ttl);
+
 	g_test_add_func ("/picasaweb/album/new", test_album_new);
 	g_test_add_func ("/picasaweb/album/escaping", test_album_escaping);
 	g_test_add_func ("/picasaweb/album/properties/coordinates", test_album_properties_coordinates);
@@ -2191,6 +2800,7 @@ main (int argc, char *argv[])
 
 	g_test_add_func ("/picasaweb/file/escaping", test_file_escaping);
 	g_test_add_func ("/picasaweb/file/properties/coordinates", test_file_properties_coordinates);
+	g_test_add_func ("/picasaweb/file/exif", test_file_exif);
 
 	g_test_add_func ("/picasaweb/comment/get_xml", test_comment_get_xml);
 
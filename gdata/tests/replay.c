@@ -0,0 +1,907 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * End-to-end latency benchmarks, replaying recorded traces through the whole GDataService stack.
+ *
+ * Each benchmark takes one of the query traces from traces/ and runs its query --operations times in each of --concurrency worker threads, each with
+ * its own service (and hence its own connection). The mock server answers requests from a table built from the trace, rather than replaying it in
+ * order, so that concurrent workers don't interfere with each other.
+ *
+ * Traffic goes through a proxy between the client and the mock server, which can delay each chunk by --latency milliseconds in each direction, and
+ * limit each connection to --bandwidth KiB/s in each direction. This allows the effect of network conditions on features like asynchronous I/O,
+ * streaming parsing and compression to be measured without going online.
+ *
+ * Results are printed as one JSON object per line, in the same style as perf.c. As well as the overall latency of each query, its p50 is broken down
+ * into:
+ *  - request_us: from calling the query function to the mock server starting to handle the request (building the message, authorisation,
+ *    connecting and sending it);
+ *  - server_us: the time taken by the mock server to build the response;
+ *  - response_us: from the mock server finishing to the last byte of the response being passed to the client; and
+ *  - parse_us: from the last byte of the response being passed to the client to the query function returning (mostly parsing).
+ *
+ * Each query is tagged with a unique q parameter so that the mock server and proxy timings can be matched up with the query which caused them.
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <locale.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gdata.h"
+#include "common.h"
+
+#define DEVELOPER_KEY "AI39si7Me3Q7zYs6hmkFvpRBD2nrkVjYYsUO5lh_3HdOkGRc9g6Z4nzxZatk_aAo2EsA21k7vrda0OO6oFg2rnhMedZXPyXoEw"
+#define PW_USERNAME "libgdata.picasaweb@gmail.com"
+
+#define PROXY_CHUNK_SIZE 16384
+
+static gint concurrency = 1;
+static gint operations = 10;
+static gint latency_ms = 0;
+static gint bandwidth_kib = 0;
+static gchar *filter = NULL;
+
+static UhmServer *mock_server = NULL;
+
+/*
+ * Trace loading.
+ *
+ * Responses are keyed by the method and URI of the request which produced them (minus any q parameter), so that a request can be answered whatever
+ * order it arrives in.
+ */
+typedef struct {
+	guint status_code;
+	gchar *reason_phrase;
+	GPtrArray *headers; /* alternating names and values */
+	GString *body;
+} TraceResponse;
+
+static void
+trace_response_free (TraceResponse *response)
+{
+	g_free (response->reason_phrase);
+	g_ptr_array_unref (response->headers);
+	g_string_free (response->body, TRUE);
+	g_slice_free (TraceResponse, response);
+}
+
+static gboolean
+should_replay_header (const gchar *name)
+{
+	/* These are either recomputed by libsoup, or don't apply to the replayed body (which is stored decoded) */
+	return (g_ascii_strncasecmp (name, "Soup-Debug", strlen ("Soup-Debug")) != 0 &&
+	        g_ascii_strcasecmp (name, "Transfer-Encoding") != 0 &&
+	        g_ascii_strcasecmp (name, "Content-Length") != 0 &&
+	        g_ascii_strcasecmp (name, "Content-Encoding") != 0 &&
+	        g_ascii_strcasecmp (name, "Connection") != 0) ? TRUE : FALSE;
+}
+
+/* Strips the q parameter out of a URI query string. Returns NULL if nothing is left. */
+static gchar *
+strip_tag_parameter (const gchar *query)
+{
+	gchar **parameters;
+	GString *stripped;
+	guint i;
+
+	if (query == NULL || *query == '\0')
+		return NULL;
+
+	parameters = g_strsplit (query, "&", -1);
+	stripped = g_string_new (NULL);
+
+	for (i = 0; parameters[i] != NULL; i++) {
+		if (strncmp (parameters[i], "q=", 2) == 0)
+			continue;
+
+		if (stripped->len > 0)
+			g_string_append_c (stripped, '&');
+		g_string_append (stripped, parameters[i]);
+	}
+
+	g_strfreev (parameters);
+
+	return g_string_free (stripped, (stripped->len == 0) ? TRUE : FALSE);
+}
+
+static gchar *
+build_request_key (const gchar *method, const gchar *path, const gchar *query)
+{
+	gchar *stripped_query, *key;
+
+	stripped_query = strip_tag_parameter (query);
+	key = g_strdup_printf ("%s %s%s%s", method, path, (stripped_query != NULL) ? "?" : "", (stripped_query != NULL) ? stripped_query : "");
+	g_free (stripped_query);
+
+	return key;
+}
+
+/* Loads the responses from the given trace file into @responses, keyed by request. */
+static void
+load_trace (GHashTable *responses, const gchar *trace_directory, const gchar *trace_name)
+{
+	gchar *filename, *contents, **lines;
+	gchar *request_key = NULL;
+	TraceResponse *response = NULL;
+	gboolean in_body = FALSE;
+	GError *error = NULL;
+	guint i;
+
+	filename = g_build_filename (TEST_FILE_DIR, "traces", trace_directory, trace_name, NULL);
+	g_file_get_contents (filename, &contents, NULL, &error);
+	g_assert_no_error (error);
+	g_free (filename);
+
+	lines = g_strsplit (contents, "\n", -1);
+	g_free (contents);
+
+	for (i = 0; lines[i] != NULL; i++) {
+		const gchar *line = lines[i];
+
+		if (g_str_has_prefix (line, "> ") == TRUE) {
+			/* Request. Only the request line is needed. */
+			if (request_key == NULL) {
+				gchar **parts = g_strsplit (line + 2, " ", 3);
+				gchar *query;
+
+				g_assert (parts[0] != NULL && parts[1] != NULL);
+
+				query = strchr (parts[1], '?');
+				if (query != NULL)
+					*(query++) = '\0';
+
+				request_key = build_request_key (parts[0], parts[1], query);
+				g_strfreev (parts);
+			}
+		} else if (g_str_has_prefix (line, "< ") == TRUE && request_key != NULL) {
+			line += 2;
+
+			if (response == NULL) {
+				/* Status line, e.g. “HTTP/1.1 200 OK” */
+				gchar **parts = g_strsplit (line, " ", 3);
+
+				g_assert (parts[0] != NULL && parts[1] != NULL);
+
+				response = g_slice_new0 (TraceResponse);
+				response->status_code = strtoul (parts[1], NULL, 10);
+				response->reason_phrase = g_strdup ((parts[2] != NULL) ? parts[2] : "");
+				response->headers = g_ptr_array_new_with_free_func (g_free);
+				response->body = g_string_new (NULL);
+				in_body = FALSE;
+
+				g_strfreev (parts);
+			} else if (in_body == TRUE) {
+				if (response->body->len > 0)
+					g_string_append_c (response->body, '\n');
+				g_string_append (response->body, line);
+			} else if (*line == '\0') {
+				in_body = TRUE;
+			} else {
+				const gchar *colon = strchr (line, ':');
+
+				if (colon != NULL) {
+					gchar *name = g_strndup (line, colon - line);
+
+					if (should_replay_header (name) == TRUE) {
+						g_ptr_array_add (response->headers, name);
+						g_ptr_array_add (response->headers, g_strdup (g_strchug ((gchar*) colon + 1)));
+					} else {
+						g_free (name);
+					}
+				}
+			}
+		} else if (strcmp (line, "  ") == 0 && response != NULL) {
+			/* End of a response. The first recorded response for each request wins. */
+			if (g_hash_table_lookup (responses, request_key) == NULL) {
+				g_hash_table_insert (responses, request_key, response);
+			} else {
+				g_free (request_key);
+				trace_response_free (response);
+			}
+
+			request_key = NULL;
+			response = NULL;
+		}
+	}
+
+	/* Trailing response without a terminator */
+	if (response != NULL && g_hash_table_lookup (responses, request_key) == NULL) {
+		g_hash_table_insert (responses, request_key, response);
+	} else {
+		g_free (request_key);
+		if (response != NULL)
+			trace_response_free (response);
+	}
+
+	g_strfreev (lines);
+}
+
+/*
+ * Timing records, shared between the mock server, the proxy and the workers.
+ */
+typedef struct {
+	gint64 handle_start;
+	gint64 handle_end;
+	guint16 connection_port; /* port of the proxy's connection to the mock server which carried the request */
+} ServerTiming;
+
+typedef struct {
+	GSocket *from;
+	GSocket *to;
+	GAsyncQueue *queue; /* of Chunks */
+	volatile gint64 last_write; /* monotonic time of the last write to @to, or 0 */
+	GThread *reader;
+	GThread *writer;
+} ProxyPipe;
+
+typedef struct {
+	GSocket *client;
+	GSocketConnection *upstream;
+	ProxyPipe up;
+	ProxyPipe down;
+} ProxyConnection;
+
+typedef struct {
+	gint64 deliver_at;
+	gsize length; /* 0 for end of stream */
+	guint8 *data; /* stored after the Chunk itself */
+} Chunk;
+
+static void
+server_timing_free (ServerTiming *timing)
+{
+	g_slice_free (ServerTiming, timing);
+}
+
+G_LOCK_DEFINE_STATIC (timings);
+static GHashTable *server_timings = NULL; /* tag → ServerTiming */
+static GHashTable *proxy_connections = NULL; /* upstream local port → ProxyConnection */
+
+static guint16
+get_socket_port (GSocketAddress *address)
+{
+	guint16 port = 0;
+
+	if (G_IS_INET_SOCKET_ADDRESS (address))
+		port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (address));
+
+	g_clear_object (&address);
+
+	return port;
+}
+
+/*
+ * Mock server handler, answering requests from the loaded trace.
+ */
+static gboolean
+server_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, GHashTable *responses)
+{
+	SoupURI *uri;
+	TraceResponse *response;
+	GHashTable *parameters = NULL;
+	const gchar *tag = NULL;
+	gchar *key;
+	gint64 handle_start;
+	guint i;
+
+	handle_start = g_get_monotonic_time ();
+
+	uri = soup_message_get_uri (message);
+	key = build_request_key (message->method, soup_uri_get_path (uri), soup_uri_get_query (uri));
+	response = g_hash_table_lookup (responses, key);
+
+	if (response == NULL) {
+		g_printerr ("No recorded response for ‘%s’.\n", key);
+		g_free (key);
+
+		soup_message_set_status (message, SOUP_STATUS_NOT_FOUND);
+		return TRUE;
+	}
+
+	g_free (key);
+
+	soup_message_set_status_full (message, response->status_code, response->reason_phrase);
+
+	for (i = 0; i + 1 < response->headers->len; i += 2)
+		soup_message_headers_append (message->response_headers, response->headers->pdata[i], response->headers->pdata[i + 1]);
+
+	soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, response->body->str, response->body->len);
+
+	/* Record when this request was handled */
+	if (soup_uri_get_query (uri) != NULL) {
+		parameters = soup_form_decode (soup_uri_get_query (uri));
+		tag = g_hash_table_lookup (parameters, "q");
+	}
+
+	if (tag != NULL) {
+		ServerTiming *timing = g_slice_new (ServerTiming);
+
+		timing->handle_start = handle_start;
+		timing->handle_end = g_get_monotonic_time ();
+		timing->connection_port = soup_address_get_port (soup_client_context_get_address (client));
+
+		G_LOCK (timings);
+		g_hash_table_replace (server_timings, g_strdup (tag), timing);
+		G_UNLOCK (timings);
+	}
+
+	if (parameters != NULL)
+		g_hash_table_unref (parameters);
+
+	return TRUE;
+}
+
+/*
+ * Proxy, shaping traffic between the client and the mock server.
+ *
+ * Each direction of each connection has a reader thread, which timestamps chunks as they arrive and queues them, and a writer thread, which sends
+ * them on once their latency has elapsed, then sleeps for as long as they'd take to transmit at the configured bandwidth.
+ */
+static gpointer
+proxy_pipe_reader_thread (ProxyPipe *pipe)
+{
+	guint8 buffer[PROXY_CHUNK_SIZE];
+	gssize length;
+
+	do {
+		Chunk *chunk;
+
+		length = g_socket_receive (pipe->from, (gchar*) buffer, sizeof (buffer), NULL, NULL);
+		length = MAX (length, 0);
+
+		chunk = g_malloc (sizeof (Chunk) + length);
+		chunk->data = (guint8*) (chunk + 1);
+		chunk->deliver_at = g_get_monotonic_time () + latency_ms * 1000;
+		chunk->length = length;
+		memcpy (chunk->data, buffer, length);
+
+		g_async_queue_push (pipe->queue, chunk);
+	} while (length > 0);
+
+	return NULL;
+}
+
+static gpointer
+proxy_pipe_writer_thread (ProxyPipe *pipe)
+{
+	Chunk *chunk;
+
+	while ((chunk = g_async_queue_pop (pipe->queue))->length > 0) {
+		gint64 now = g_get_monotonic_time ();
+		gsize written = 0;
+
+		if (chunk->deliver_at > now)
+			g_usleep (chunk->deliver_at - now);
+
+		/* Recorded before sending, so that it's never later than the client receiving the data */
+		pipe->last_write = g_get_monotonic_time ();
+
+		while (written < chunk->length) {
+			gssize length = g_socket_send (pipe->to, (const gchar*) chunk->data + written, chunk->length - written, NULL, NULL);
+
+			if (length <= 0)
+				break;
+
+			written += length;
+		}
+
+		if (bandwidth_kib > 0)
+			g_usleep ((gulong) (chunk->length * G_USEC_PER_SEC / ((gsize) bandwidth_kib * 1024)));
+
+		g_free (chunk);
+	}
+
+	g_free (chunk);
+
+	/* Pass on the end of the stream */
+	g_socket_shutdown (pipe->to, FALSE, TRUE, NULL);
+
+	return NULL;
+}
+
+static void
+proxy_pipe_start (ProxyPipe *pipe, GSocket *from, GSocket *to)
+{
+	pipe->from = from;
+	pipe->to = to;
+	pipe->queue = g_async_queue_new ();
+	pipe->last_write = 0;
+	pipe->reader = g_thread_new ("proxy-reader", (GThreadFunc) proxy_pipe_reader_thread, pipe);
+	pipe->writer = g_thread_new ("proxy-writer", (GThreadFunc) proxy_pipe_writer_thread, pipe);
+}
+
+static void
+proxy_pipe_join (ProxyPipe *pipe)
+{
+	g_thread_join (pipe->reader);
+	g_thread_join (pipe->writer);
+	g_async_queue_unref (pipe->queue);
+}
+
+static void
+proxy_connection_free (ProxyConnection *connection)
+{
+	/* Make sure all the threads exit, even if the client is still holding its end open */
+	g_socket_shutdown (connection->client, TRUE, TRUE, NULL);
+	g_socket_shutdown (g_socket_connection_get_socket (connection->upstream), TRUE, TRUE, NULL);
+
+	proxy_pipe_join (&connection->up);
+	proxy_pipe_join (&connection->down);
+
+	g_object_unref (connection->upstream);
+	g_object_unref (connection->client);
+	g_slice_free (ProxyConnection, connection);
+}
+
+typedef struct {
+	GSocket *listener;
+	GCancellable *cancellable;
+	GSocketAddress *upstream_address;
+	GThread *thread;
+} Proxy;
+
+static gpointer
+proxy_accept_thread (Proxy *proxy)
+{
+	GSocketClient *socket_client;
+	GSocket *client_socket;
+
+	socket_client = g_socket_client_new ();
+
+	while ((client_socket = g_socket_accept (proxy->listener, proxy->cancellable, NULL)) != NULL) {
+		ProxyConnection *connection;
+		GSocket *upstream_socket;
+		GError *error = NULL;
+
+		connection = g_slice_new0 (ProxyConnection);
+		connection->client = client_socket;
+		connection->upstream = g_socket_client_connect (socket_client, G_SOCKET_CONNECTABLE (proxy->upstream_address), NULL, &error);
+		g_assert_no_error (error);
+
+		upstream_socket = g_socket_connection_get_socket (connection->upstream);
+
+		proxy_pipe_start (&connection->up, client_socket, upstream_socket);
+		proxy_pipe_start (&connection->down, upstream_socket, client_socket);
+
+		G_LOCK (timings);
+		g_hash_table_insert (proxy_connections, GUINT_TO_POINTER (get_socket_port (g_socket_get_local_address (upstream_socket, NULL))),
+		                     connection);
+		G_UNLOCK (timings);
+	}
+
+	g_object_unref (socket_client);
+
+	return NULL;
+}
+
+static void
+proxy_start (Proxy *proxy)
+{
+	GInetAddress *address;
+	GSocketAddress *listen_address;
+	GError *error = NULL;
+
+	address = g_inet_address_new_from_string (uhm_server_get_address (mock_server));
+	proxy->upstream_address = g_inet_socket_address_new (address, uhm_server_get_port (mock_server));
+
+	proxy->listener = g_socket_new (g_inet_address_get_family (address), G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_TCP, &error);
+	g_assert_no_error (error);
+
+	listen_address = g_inet_socket_address_new (address, 0);
+	g_socket_bind (proxy->listener, listen_address, TRUE, &error);
+	g_assert_no_error (error);
+	g_socket_listen (proxy->listener, &error);
+	g_assert_no_error (error);
+	g_object_unref (listen_address);
+	g_object_unref (address);
+
+	proxy->cancellable = g_cancellable_new ();
+	proxy->thread = g_thread_new ("proxy-accept", (GThreadFunc) proxy_accept_thread, proxy);
+}
+
+static guint16
+proxy_get_port (Proxy *proxy)
+{
+	return get_socket_port (g_socket_get_local_address (proxy->listener, NULL));
+}
+
+static void
+proxy_stop (Proxy *proxy)
+{
+	g_cancellable_cancel (proxy->cancellable);
+	g_thread_join (proxy->thread);
+
+	g_object_unref (proxy->cancellable);
+	g_object_unref (proxy->listener);
+	g_object_unref (proxy->upstream_address);
+}
+
+/*
+ * Workloads.
+ */
+typedef GDataFeed *(*QueryFunc) (GDataService *service, GDataQuery *query, GError **error);
+
+typedef struct {
+	const gchar *name;
+	const gchar *trace_directory;
+	const gchar *trace_name;
+	const gchar *username;
+	QueryFunc query;
+} ReplayWorkload;
+
+static GDataFeed *
+query_contacts (GDataService *service, GDataQuery *query, GError **error)
+{
+	return gdata_contacts_service_query_contacts (GDATA_CONTACTS_SERVICE (service), query, NULL, NULL, NULL, error);
+}
+
+static GDataFeed *
+query_own_calendars (GDataService *service, GDataQuery *query, GError **error)
+{
+	return gdata_calendar_service_query_own_calendars (GDATA_CALENDAR_SERVICE (service), query, NULL, NULL, NULL, error);
+}
+
+static GDataFeed *
+query_standard_feed (GDataService *service, GDataQuery *query, GError **error)
+{
+	return gdata_youtube_service_query_standard_feed (GDATA_YOUTUBE_SERVICE (service), GDATA_YOUTUBE_TOP_RATED_FEED, query, NULL, NULL, NULL,
+	                                                  error);
+}
+
+static GDataFeed *
+query_all_albums (GDataService *service, GDataQuery *query, GError **error)
+{
+	return gdata_picasaweb_service_query_all_albums (GDATA_PICASAWEB_SERVICE (service), query, NULL, NULL, NULL, NULL, error);
+}
+
+static const ReplayWorkload workloads[] = {
+	{ "replay/contacts/query-all-contacts", "contacts", "query-all-contacts", USERNAME, query_contacts },
+	{ "replay/calendar/query-own-calendars", "calendar", "query-own-calendars", USERNAME, query_own_calendars },
+	{ "replay/youtube/query-standard-feed", "youtube", "query-standard-feed", USERNAME, query_standard_feed },
+	{ "replay/picasaweb/query-all-albums", "picasaweb", "query-all-albums", PW_USERNAME, query_all_albums },
+};
+
+static GDataService *
+create_service (const ReplayWorkload *workload)
+{
+	GDataClientLoginAuthorizer *authorizer;
+	GDataService *service;
+	GType service_type;
+	GError *error = NULL;
+
+	if (strcmp (workload->trace_directory, "contacts") == 0)
+		service_type = GDATA_TYPE_CONTACTS_SERVICE;
+	else if (strcmp (workload->trace_directory, "calendar") == 0)
+		service_type = GDATA_TYPE_CALENDAR_SERVICE;
+	else if (strcmp (workload->trace_directory, "youtube") == 0)
+		service_type = GDATA_TYPE_YOUTUBE_SERVICE;
+	else if (strcmp (workload->trace_directory, "picasaweb") == 0)
+		service_type = GDATA_TYPE_PICASAWEB_SERVICE;
+	else
+		g_assert_not_reached ();
+
+	authorizer = gdata_client_login_authorizer_new (CLIENT_ID, service_type);
+	gdata_client_login_authorizer_authenticate (authorizer, workload->username, PASSWORD, NULL, &error);
+	g_assert_no_error (error);
+
+	if (service_type == GDATA_TYPE_YOUTUBE_SERVICE)
+		service = GDATA_SERVICE (gdata_youtube_service_new (DEVELOPER_KEY, GDATA_AUTHORIZER (authorizer)));
+	else
+		service = GDATA_SERVICE (g_object_new (service_type, "authorizer", authorizer, NULL));
+
+	g_object_unref (authorizer);
+
+	return service;
+}
+
+typedef struct {
+	gint64 total;
+	gint64 request;
+	gint64 server;
+	gint64 response;
+	gint64 parse;
+} OperationTiming;
+
+typedef struct {
+	guint id;
+	const ReplayWorkload *workload;
+	GArray *timings; /* of OperationTiming */
+} Worker;
+
+/* Barrier so that all workers start their measured operations together, once they've connected and authenticated */
+static GMutex start_mutex;
+static GCond start_cond;
+static guint n_workers_ready = 0;
+static gboolean workers_started = FALSE;
+
+static void
+run_operation (GDataService *service, Worker *worker, guint i, OperationTiming *timing)
+{
+	GDataQuery *query;
+	GDataFeed *feed;
+	ServerTiming *server_timing;
+	ProxyConnection *connection;
+	gchar *tag;
+	gint64 start, end, last_write = 0;
+	GError *error = NULL;
+
+	tag = g_strdup_printf ("replay-%u-%u", worker->id, i);
+	query = gdata_query_new (tag);
+
+	start = g_get_monotonic_time ();
+	feed = worker->workload->query (service, query, &error);
+	end = g_get_monotonic_time ();
+
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_FEED (feed));
+
+	g_object_unref (feed);
+	g_object_unref (query);
+
+	/* Match up the timings */
+	G_LOCK (timings);
+	server_timing = g_hash_table_lookup (server_timings, tag);
+	g_assert (server_timing != NULL);
+
+	if (timing != NULL) {
+		connection = g_hash_table_lookup (proxy_connections, GUINT_TO_POINTER (server_timing->connection_port));
+		if (connection != NULL)
+			last_write = connection->down.last_write;
+
+		timing->total = end - start;
+		timing->request = MAX (server_timing->handle_start - start, 0);
+		timing->server = server_timing->handle_end - server_timing->handle_start;
+		timing->response = (last_write > 0) ? MAX (last_write - server_timing->handle_end, 0) : 0;
+		timing->parse = (last_write > 0) ? MAX (end - last_write, 0) : 0;
+	}
+
+	g_hash_table_remove (server_timings, tag);
+	G_UNLOCK (timings);
+
+	g_free (tag);
+}
+
+static gpointer
+worker_thread (Worker *worker)
+{
+	GDataService *service;
+	guint i;
+
+	service = create_service (worker->workload);
+
+	/* Warm up, which also opens the connection */
+	run_operation (service, worker, 0, NULL);
+
+	g_mutex_lock (&start_mutex);
+	n_workers_ready++;
+	g_cond_broadcast (&start_cond);
+	while (workers_started == FALSE)
+		g_cond_wait (&start_cond, &start_mutex);
+	g_mutex_unlock (&start_mutex);
+
+	for (i = 1; i <= (guint) operations; i++) {
+		OperationTiming timing;
+
+		run_operation (service, worker, i, &timing);
+		g_array_append_val (worker->timings, timing);
+	}
+
+	g_object_unref (service);
+
+	return NULL;
+}
+
+static gint
+compare_int64s (const gint64 *a, const gint64 *b)
+{
+	return (*a > *b) - (*a < *b);
+}
+
+/* Returns the given percentile of the gint64 at @offset in each OperationTiming. Sorts @timings. */
+static gint64
+get_percentile (GArray *timings, gsize offset, guint percentile)
+{
+	GArray *values;
+	gint64 value;
+	guint i;
+
+	values = g_array_sized_new (FALSE, FALSE, sizeof (gint64), timings->len);
+	for (i = 0; i < timings->len; i++)
+		g_array_append_val (values, G_STRUCT_MEMBER (gint64, &g_array_index (timings, OperationTiming, i), offset));
+
+	g_array_sort (values, (GCompareFunc) compare_int64s);
+	value = g_array_index (values, gint64, (values->len - 1) * percentile / 100);
+	g_array_free (values, TRUE);
+
+	return value;
+}
+
+static void
+run_workload (const ReplayWorkload *workload)
+{
+	GHashTable *responses;
+	Proxy proxy;
+	Worker *workers;
+	GThread **threads;
+	GArray *timings;
+	gint64 start, end;
+	gchar *port_string;
+	gchar number_buffer[G_ASCII_DTOSTR_BUF_SIZE];
+	gulong handler_id;
+	GString *result;
+	guint i;
+
+	if (filter != NULL && strstr (workload->name, filter) == NULL)
+		return;
+
+	responses = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) trace_response_free);
+	load_trace (responses, workload->trace_directory, "global-authentication");
+	load_trace (responses, workload->trace_directory, workload->trace_name);
+
+	server_timings = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) server_timing_free);
+	proxy_connections = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) proxy_connection_free);
+
+	/* Answer everything from the trace, in any order */
+	handler_id = g_signal_connect (mock_server, "handle-message", (GCallback) server_handle_message_cb, responses);
+	uhm_server_run (mock_server);
+
+	proxy_start (&proxy);
+
+	/* Route all requests through the proxy */
+	port_string = g_strdup_printf ("%u", proxy_get_port (&proxy));
+	g_setenv ("LIBGDATA_HTTPS_PORT", port_string, TRUE);
+	g_free (port_string);
+
+	n_workers_ready = 0;
+	workers_started = FALSE;
+
+	workers = g_new0 (Worker, concurrency);
+	for (i = 0; i < (guint) concurrency; i++) {
+		workers[i].id = i;
+		workers[i].workload = workload;
+		workers[i].timings = g_array_sized_new (FALSE, FALSE, sizeof (OperationTiming), operations);
+	}
+
+	threads = g_new (GThread*, concurrency);
+	for (i = 0; i < (guint) concurrency; i++)
+		threads[i] = g_thread_new ("replay-worker", (GThreadFunc) worker_thread, &workers[i]);
+
+	/* Start the clock once every worker has warmed up */
+	g_mutex_lock (&start_mutex);
+	while (n_workers_ready < (guint) concurrency)
+		g_cond_wait (&start_cond, &start_mutex);
+	workers_started = TRUE;
+	start = g_get_monotonic_time ();
+	g_cond_broadcast (&start_cond);
+	g_mutex_unlock (&start_mutex);
+
+	for (i = 0; i < (guint) concurrency; i++)
+		g_thread_join (threads[i]);
+
+	end = g_get_monotonic_time ();
+	g_free (threads);
+
+	/* Collect the results */
+	timings = g_array_sized_new (FALSE, FALSE, sizeof (OperationTiming), concurrency * operations);
+	for (i = 0; i < (guint) concurrency; i++) {
+		g_array_append_vals (timings, workers[i].timings->data, workers[i].timings->len);
+		g_array_free (workers[i].timings, TRUE);
+	}
+	g_free (workers);
+
+	result = g_string_new (NULL);
+	g_string_append_printf (result, "{\"benchmark\": \"%s\", \"concurrency\": %d, \"latency_ms\": %d, \"bandwidth_kib_per_second\": %d",
+	                        workload->name, concurrency, latency_ms, bandwidth_kib);
+	g_string_append_printf (result, ", \"operations\": %u", timings->len);
+	g_string_append_printf (result, ", \"ops_per_second\": %s",
+	                        g_ascii_dtostr (number_buffer, sizeof (number_buffer),
+	                                        (gdouble) timings->len * (gdouble) G_USEC_PER_SEC / (gdouble) MAX (end - start, 1)));
+	g_string_append_printf (result, ", \"p50_us\": %" G_GINT64_FORMAT, get_percentile (timings, G_STRUCT_OFFSET (OperationTiming, total), 50));
+	g_string_append_printf (result, ", \"p99_us\": %" G_GINT64_FORMAT, get_percentile (timings, G_STRUCT_OFFSET (OperationTiming, total), 99));
+	g_string_append_printf (result, ", \"p50_breakdown\": {\"request_us\": %" G_GINT64_FORMAT ", \"server_us\": %" G_GINT64_FORMAT
+	                        ", \"response_us\": %" G_GINT64_FORMAT ", \"parse_us\": %" G_GINT64_FORMAT "}}",
+	                        get_percentile (timings, G_STRUCT_OFFSET (OperationTiming, request), 50),
+	                        get_percentile (timings, G_STRUCT_OFFSET (OperationTiming, server), 50),
+	                        get_percentile (timings, G_STRUCT_OFFSET (OperationTiming, response), 50),
+	                        get_percentile (timings, G_STRUCT_OFFSET (OperationTiming, parse), 50));
+	g_print ("%s\n", result->str);
+
+	g_string_free (result, TRUE);
+	g_array_free (timings, TRUE);
+
+	/* Tear down. The proxy connections are closed before the mock server is stopped, so that the server doesn't wait for their clients. */
+	proxy_stop (&proxy);
+	g_hash_table_destroy (proxy_connections);
+	proxy_connections = NULL;
+
+	uhm_server_stop (mock_server);
+	g_signal_handler_disconnect (mock_server, handler_id);
+
+	g_hash_table_destroy (server_timings);
+	server_timings = NULL;
+	g_hash_table_destroy (responses);
+}
+
+static void
+mock_server_notify_resolver_cb (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	UhmServer *server;
+	UhmResolver *resolver;
+
+	server = UHM_SERVER (object);
+	resolver = uhm_server_get_resolver (server);
+
+	if (resolver != NULL) {
+		const gchar *ip_address = uhm_server_get_address (server);
+
+		/* The proxy listens on the same address as the mock server */
+		uhm_resolver_add_A (resolver, "www.google.com", ip_address);
+		uhm_resolver_add_A (resolver, "gdata.youtube.com", ip_address);
+		uhm_resolver_add_A (resolver, "picasaweb.google.com", ip_address);
+	}
+}
+
+int
+main (int argc, char *argv[])
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	guint i;
+	const GOptionEntry entries[] = {
+		{ "concurrency", 0, 0, G_OPTION_ARG_INT, &concurrency, "Number of workers running queries at once (default: 1)", "N" },
+		{ "operations", 0, 0, G_OPTION_ARG_INT, &operations, "Number of measured queries per worker (default: 10)", "N" },
+		{ "latency", 0, 0, G_OPTION_ARG_INT, &latency_ms, "Latency to add in each direction, in milliseconds (default: 0)", "MS" },
+		{ "bandwidth", 0, 0, G_OPTION_ARG_INT, &bandwidth_kib, "Bandwidth limit per connection in each direction, in KiB/s (default: unlimited)",
+		  "KIB" },
+		{ "filter", 0, 0, G_OPTION_ARG_STRING, &filter, "Only run benchmarks whose names contain STRING", "STRING" },
+		{ NULL }
+	};
+
+	setlocale (LC_ALL, "");
+
+	/* Parse our options first, leaving the rest for gdata_test_init() */
+	context = g_option_context_new ("— replay recorded traces through libgdata");
+	g_option_context_add_main_entries (context, entries, NULL);
+	g_option_context_set_ignore_unknown_options (context, TRUE);
+	g_option_context_set_help_enabled (context, FALSE);
+
+	if (g_option_context_parse (context, &argc, &argv, &error) == FALSE || concurrency < 1 || operations < 1 || latency_ms < 0 ||
+	    bandwidth_kib < 0) {
+		g_printerr ("%s\n", (error != NULL) ? error->message : "Invalid option value.");
+		g_clear_error (&error);
+		g_option_context_free (context);
+		return 1;
+	}
+
+	g_option_context_free (context);
+
+	gdata_test_init (argc, argv);
+
+	mock_server = gdata_test_get_mock_server ();
+	g_signal_connect (G_OBJECT (mock_server), "notify::resolver", (GCallback) mock_server_notify_resolver_cb, NULL);
+
+	for (i = 0; i < G_N_ELEMENTS (workloads); i++)
+		run_workload (&workloads[i]);
+
+	g_free (filter);
+
+	return 0;
+}
@@ -18,14 +18,17 @@
  */
 
 #include <glib.h>
+#include <glib/gstdio.h>
 #include <locale.h>
 #include <string.h>
 #include <arpa/inet.h>
 #include <sys/types.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
 #include "gdata.h"
+#include "gdata-buffer.h"
 #include "common.h"
 
 static gpointer
@@ -201,6 +204,438 @@ test_download_stream_download_content_length (void)
 	g_main_context_unref (async_context);
 }
 
+/* Test downloading straight to a file */
+static void
+test_download_stream_download_to_file (void)
+{
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *download_uri, *test_string, *contents, *temp_path;
+	gsize length;
+	GFile *destination;
+	GDataService *service;
+	GInputStream *download_stream;
+	gboolean success;
+	gint fd;
+	GError *error = NULL;
+
+	/* Create and run the server */
+	server = create_server ((SoupServerCallback) test_download_stream_download_server_content_length_handler_cb, NULL, &async_context);
+	thread = run_server (server);
+
+	/* Create a new download stream connected to the server */
+	download_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	download_stream = gdata_download_stream_new (service, NULL, download_uri, NULL);
+	g_object_unref (service);
+	g_free (download_uri);
+
+	/* Download to a temporary file */
+	fd = g_file_open_tmp ("gdata-streams-test-XXXXXX", &temp_path, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (fd, >=, 0);
+	close (fd);
+
+	destination = g_file_new_for_path (temp_path);
+	success = gdata_download_stream_download_to_file (GDATA_DOWNLOAD_STREAM (download_stream), destination, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	/* Compare the downloaded file to the original */
+	test_string = get_test_string (1, 1000);
+
+	g_assert_cmpint (gdata_download_stream_get_content_length (GDATA_DOWNLOAD_STREAM (download_stream)), ==, strlen (test_string) + 1);
+	g_assert_cmpstr (gdata_download_stream_get_content_type (GDATA_DOWNLOAD_STREAM (download_stream)), ==, "text/plain");
+
+	success = g_file_get_contents (temp_path, &contents, &length, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+	g_assert_cmpuint (length, ==, strlen (test_string) + 1);
+	g_assert_cmpstr (contents, ==, test_string);
+
+	g_free (contents);
+	g_free (test_string);
+
+	g_file_delete (destination, NULL, NULL);
+	g_object_unref (destination);
+	g_free (temp_path);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_object_unref (download_stream);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+typedef struct {
+	guint8 *data;
+	goffset length;
+	gboolean support_ranges;
+	GArray *ranges; /* SoupRange for each request received */
+	GPtrArray *paused_messages;
+	guint n_segments; /* number of segment requests to hold back and then answer in reverse order */
+} DownloadSegmentsServerData;
+
+static void
+test_download_stream_download_segments_server_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query,
+                                                          SoupClientContext *client, DownloadSegmentsServerData *server_data)
+{
+	SoupRange *ranges, range;
+	int n_ranges;
+
+	soup_message_headers_set_content_type (message->response_headers, "text/plain", NULL);
+
+	if (server_data->support_ranges == FALSE ||
+	    soup_message_headers_get_ranges (message->request_headers, server_data->length, &ranges, &n_ranges) == FALSE) {
+		range.start = 0;
+		range.end = server_data->length - 1;
+		g_array_append_val (server_data->ranges, range);
+
+		soup_message_set_status (message, SOUP_STATUS_OK);
+		soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, server_data->data, server_data->length);
+		return;
+	}
+
+	g_assert_cmpint (n_ranges, ==, 1);
+	range = ranges[0];
+	soup_message_headers_free_ranges (message->request_headers, ranges);
+
+	g_array_append_val (server_data->ranges, range);
+
+	soup_message_set_status (message, SOUP_STATUS_PARTIAL_CONTENT);
+	soup_message_headers_set_content_range (message->response_headers, range.start, range.end, server_data->length);
+	soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, server_data->data + range.start, range.end - range.start + 1);
+
+	/* Hold back the segments until they've all been requested, then answer them last first so that they arrive out of order */
+	if (range.start > 0 && server_data->n_segments > 0) {
+		soup_server_pause_message (server, message);
+		g_ptr_array_add (server_data->paused_messages, message);
+
+		if (server_data->paused_messages->len == server_data->n_segments) {
+			guint i;
+
+			for (i = server_data->paused_messages->len; i > 0; i--)
+				soup_server_unpause_message (server, server_data->paused_messages->pdata[i - 1]);
+
+			g_ptr_array_set_size (server_data->paused_messages, 0);
+		}
+	}
+}
+
+static gint
+compare_ranges (const SoupRange *a, const SoupRange *b)
+{
+	return (a->start < b->start) ? -1 : (a->start > b->start) ? 1 : 0;
+}
+
+/* Test downloading a file in several segments over concurrent connections */
+static void
+test_download_stream_download_segments (void)
+{
+	DownloadSegmentsServerData server_data;
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *download_uri, *temp_path, *contents;
+	gsize length;
+	GFile *destination;
+	GDataService *service;
+	GInputStream *download_stream;
+	gboolean success;
+	goffset i;
+	gint fd;
+	GError *error = NULL;
+
+	/* Three segments of 1MiB each, plus the byte which is fetched first to find the length of the file. The data doesn't repeat with a period
+	 * which divides the segment length, so segments written at the wrong offset will be noticed. */
+	server_data.length = 3 * 1024 * 1024 + 1;
+	server_data.data = g_malloc (server_data.length);
+	for (i = 0; i < server_data.length; i++)
+		server_data.data[i] = i % 251;
+
+	server_data.support_ranges = TRUE;
+	server_data.ranges = g_array_new (FALSE, FALSE, sizeof (SoupRange));
+	server_data.paused_messages = g_ptr_array_new ();
+	server_data.n_segments = 3;
+
+	/* Create and run the server */
+	server = create_server ((SoupServerCallback) test_download_stream_download_segments_server_handler_cb, &server_data, &async_context);
+	thread = run_server (server);
+
+	download_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	gdata_service_set_max_connections_per_host (service, 3);
+
+	fd = g_file_open_tmp ("gdata-streams-test-XXXXXX", &temp_path, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (fd, >=, 0);
+	close (fd);
+
+	destination = g_file_new_for_path (temp_path);
+
+	/* Download the file in (up to) four segments; it's only long enough for three */
+	download_stream = gdata_download_stream_new (service, NULL, download_uri, NULL);
+	success = gdata_download_stream_download_segments (GDATA_DOWNLOAD_STREAM (download_stream), destination, 4, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	g_assert_cmpint (gdata_download_stream_get_content_length (GDATA_DOWNLOAD_STREAM (download_stream)), ==, server_data.length);
+	g_assert_cmpstr (gdata_download_stream_get_content_type (GDATA_DOWNLOAD_STREAM (download_stream)), ==, "text/plain");
+
+	g_object_unref (download_stream);
+
+	/* The first byte is requested on its own, then the rest of the file is split into contiguous ranges */
+	g_assert_cmpuint (server_data.ranges->len, ==, 4);
+	g_assert_cmpint (g_array_index (server_data.ranges, SoupRange, 0).start, ==, 0);
+	g_assert_cmpint (g_array_index (server_data.ranges, SoupRange, 0).end, ==, 0);
+
+	g_array_sort (server_data.ranges, (GCompareFunc) compare_ranges);
+
+	for (i = 1; i < server_data.ranges->len; i++) {
+		SoupRange *range = &g_array_index (server_data.ranges, SoupRange, i);
+
+		g_assert_cmpint (range->start, ==, g_array_index (server_data.ranges, SoupRange, i - 1).end + 1);
+		g_assert_cmpint (range->end - range->start + 1, >=, 1024 * 1024);
+	}
+
+	g_assert_cmpint (g_array_index (server_data.ranges, SoupRange, server_data.ranges->len - 1).end, ==, server_data.length - 1);
+
+	/* The segments were answered in reverse order, but must still have been written to the right places */
+	success = g_file_get_contents (temp_path, &contents, &length, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+	g_assert_cmpuint (length, ==, server_data.length);
+	g_assert (memcmp (contents, server_data.data, length) == 0);
+	g_free (contents);
+
+	/* If the server ignores the Range header, the whole file comes back in response to the first request */
+	server_data.support_ranges = FALSE;
+	server_data.n_segments = 0;
+	g_array_set_size (server_data.ranges, 0);
+
+	download_stream = gdata_download_stream_new (service, NULL, download_uri, NULL);
+	success = gdata_download_stream_download_segments (GDATA_DOWNLOAD_STREAM (download_stream), destination, 4, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	g_assert_cmpint (gdata_download_stream_get_content_length (GDATA_DOWNLOAD_STREAM (download_stream)), ==, server_data.length);
+	g_assert_cmpuint (server_data.ranges->len, ==, 1);
+
+	g_object_unref (download_stream);
+
+	success = g_file_get_contents (temp_path, &contents, &length, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+	g_assert_cmpuint (length, ==, server_data.length);
+	g_assert (memcmp (contents, server_data.data, length) == 0);
+	g_free (contents);
+
+	g_file_delete (destination, NULL, NULL);
+	g_object_unref (destination);
+	g_free (temp_path);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_ptr_array_unref (server_data.paused_messages);
+	g_array_free (server_data.ranges, TRUE);
+	g_free (server_data.data);
+	g_free (download_uri);
+	g_object_unref (service);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+typedef struct {
+	const gchar *test_string;
+	gsize test_string_length;
+	gboolean file_changed; /* whether to return a different version of the file when the download is resumed */
+	guint n_requests;
+	gchar *resume_range; /* Range header of the last resumed request */
+	gchar *resume_if_range; /* If-Range header of the last resumed request */
+} DownloadAutoResumeServerData;
+
+static gboolean
+test_download_stream_auto_resume_disconnect_cb (SoupSocket *socket)
+{
+	soup_socket_disconnect (socket);
+	return FALSE;
+}
+
+static void
+test_download_stream_auto_resume_server_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query,
+                                                    SoupClientContext *client, DownloadAutoResumeServerData *server_data)
+{
+	gsize half_length = server_data->test_string_length / 2;
+
+	soup_message_headers_set_content_type (message->response_headers, "text/plain", NULL);
+
+	if (server_data->n_requests++ == 0) {
+		GSource *source;
+
+		/* Send the headers and the first half of the file, then drop the connection while the message is paused waiting for the rest */
+		g_assert (soup_message_headers_get_one (message->request_headers, "Range") == NULL);
+
+		soup_message_set_status (message, SOUP_STATUS_OK);
+		soup_message_headers_replace (message->response_headers, "ETag", "\"v1\"");
+		soup_message_headers_set_encoding (message->response_headers, SOUP_ENCODING_CHUNKED);
+		soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, server_data->test_string, half_length);
+
+		source = g_timeout_source_new (100);
+		g_source_set_callback (source, (GSourceFunc) test_download_stream_auto_resume_disconnect_cb,
+		                       g_object_ref (soup_client_context_get_socket (client)), g_object_unref);
+		g_source_attach (source, soup_server_get_async_context (server));
+		g_source_unref (source);
+
+		return;
+	}
+
+	/* Resumed request */
+	g_free (server_data->resume_range);
+	server_data->resume_range = g_strdup (soup_message_headers_get_one (message->request_headers, "Range"));
+	g_free (server_data->resume_if_range);
+	server_data->resume_if_range = g_strdup (soup_message_headers_get_one (message->request_headers, "If-Range"));
+
+	if (server_data->file_changed == TRUE) {
+		/* The If-Range validator doesn't match any more, so the whole of the new version is returned */
+		soup_message_set_status (message, SOUP_STATUS_OK);
+		soup_message_headers_replace (message->response_headers, "ETag", "\"v2\"");
+		soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, server_data->test_string, server_data->test_string_length);
+	} else {
+		soup_message_set_status (message, SOUP_STATUS_PARTIAL_CONTENT);
+		soup_message_headers_replace (message->response_headers, "ETag", "\"v1\"");
+		soup_message_headers_set_content_range (message->response_headers, half_length, server_data->test_string_length - 1,
+		                                        server_data->test_string_length);
+		soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, server_data->test_string + half_length,
+		                          server_data->test_string_length - half_length);
+	}
+}
+
+/* Reads @download_stream to EOF or the first error, returning everything which was read */
+static GString *
+read_download_stream (GInputStream *download_stream, GError **error)
+{
+	GString *contents;
+	guint8 buffer[1024];
+	gssize length_read;
+
+	contents = g_string_new (NULL);
+
+	while ((length_read = g_input_stream_read (download_stream, buffer, sizeof (buffer), NULL, error)) > 0)
+		g_string_append_len (contents, (const gchar*) buffer, length_read);
+
+	return contents;
+}
+
+/* Test that a download which is interrupted by the connection dropping is resumed from where it left off, if auto-resume is enabled */
+static void
+test_download_stream_download_auto_resume (void)
+{
+	DownloadAutoResumeServerData server_data;
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *download_uri, *test_string, *expected_range;
+	GDataService *service;
+	GInputStream *download_stream;
+	GString *contents;
+	GError *error = NULL;
+
+	test_string = get_test_string (1, 5000);
+
+	server_data.test_string = test_string;
+	server_data.test_string_length = strlen (test_string) + 1;
+	server_data.file_changed = FALSE;
+	server_data.n_requests = 0;
+	server_data.resume_range = NULL;
+	server_data.resume_if_range = NULL;
+
+	expected_range = g_strdup_printf ("bytes=%" G_GSIZE_FORMAT "-", server_data.test_string_length / 2);
+
+	/* Create and run the server */
+	server = create_server ((SoupServerCallback) test_download_stream_auto_resume_server_handler_cb, &server_data, &async_context);
+	thread = run_server (server);
+
+	download_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+
+	/* Check the property */
+	download_stream = gdata_download_stream_new (service, NULL, download_uri, NULL);
+	g_assert (gdata_download_stream_get_auto_resume (GDATA_DOWNLOAD_STREAM (download_stream)) == FALSE);
+
+	gdata_download_stream_set_auto_resume (GDATA_DOWNLOAD_STREAM (download_stream), TRUE);
+	g_assert (gdata_download_stream_get_auto_resume (GDATA_DOWNLOAD_STREAM (download_stream)) == TRUE);
+
+	/* The download is resumed from the end of the first half, and only if the file hasn't changed */
+	contents = read_download_stream (download_stream, &error);
+	g_assert_no_error (error);
+	g_assert_cmpuint (contents->len, ==, server_data.test_string_length);
+	g_assert (memcmp (contents->str, test_string, contents->len) == 0);
+	g_string_free (contents, TRUE);
+
+	g_assert_cmpuint (server_data.n_requests, ==, 2);
+	g_assert_cmpstr (server_data.resume_range, ==, expected_range);
+	g_assert_cmpstr (server_data.resume_if_range, ==, "\"v1\"");
+
+	g_assert_cmpstr (gdata_download_stream_get_content_type (GDATA_DOWNLOAD_STREAM (download_stream)), ==, "text/plain");
+
+	g_input_stream_close (download_stream, NULL, NULL);
+	g_object_unref (download_stream);
+
+	/* If the file changes in the meantime, the new version mustn't be spliced onto the old one */
+	server_data.file_changed = TRUE;
+	server_data.n_requests = 0;
+
+	download_stream = gdata_download_stream_new (service, NULL, download_uri, NULL);
+	gdata_download_stream_set_auto_resume (GDATA_DOWNLOAD_STREAM (download_stream), TRUE);
+
+	contents = read_download_stream (download_stream, &error);
+	g_assert (error != NULL);
+	g_clear_error (&error);
+	g_assert_cmpuint (contents->len, ==, server_data.test_string_length / 2);
+	g_string_free (contents, TRUE);
+
+	g_assert_cmpuint (server_data.n_requests, ==, 2);
+	g_assert_cmpstr (server_data.resume_if_range, ==, "\"v1\"");
+
+	g_input_stream_close (download_stream, NULL, NULL);
+	g_object_unref (download_stream);
+
+	/* Without auto-resume, the download just fails */
+	server_data.file_changed = FALSE;
+	server_data.n_requests = 0;
+
+	download_stream = gdata_download_stream_new (service, NULL, download_uri, NULL);
+
+	contents = read_download_stream (download_stream, &error);
+	g_assert (error != NULL);
+	g_clear_error (&error);
+	g_assert_cmpuint (contents->len, ==, server_data.test_string_length / 2);
+	g_string_free (contents, TRUE);
+
+	g_assert_cmpuint (server_data.n_requests, ==, 1);
+
+	g_input_stream_close (download_stream, NULL, NULL);
+	g_object_unref (download_stream);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_free (server_data.resume_range);
+	g_free (server_data.resume_if_range);
+	g_free (expected_range);
+	g_free (download_uri);
+	g_free (test_string);
+	g_object_unref (service);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
 static void
 test_download_stream_download_server_seek_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query,
                                                       SoupClientContext *client, gpointer user_data)
@@ -479,62 +914,255 @@ test_download_stream_download_seek_after_start_backwards (void)
 }
 
 static void
-test_upload_stream_upload_no_entry_content_length_server_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query,
-                                                                     SoupClientContext *client, gpointer user_data)
+test_download_stream_download_server_counting_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query,
+                                                          SoupClientContext *client, volatile gint *request_count)
 {
-	gchar *test_string;
-	goffset test_string_length;
-
-	/* Check the Slug and Content-Type headers have been correctly set by the client */
-	g_assert_cmpstr (soup_message_headers_get_content_type (message->request_headers, NULL), ==, "text/plain");
-	g_assert_cmpstr (soup_message_headers_get_one (message->request_headers, "Slug"), ==, "slug");
-
-	/* Check the client sent the right data */
-	test_string = get_test_string (1, 1000);
-	test_string_length = strlen (test_string) + 1;
-
-	g_assert_cmpint (message->request_body->length, ==, test_string_length);
-	g_assert_cmpstr (message->request_body->data, ==, test_string);
-
-	g_free (test_string);
-
-	/* Add some response headers */
-	soup_message_set_status (message, SOUP_STATUS_OK);
-	soup_message_headers_set_content_type (message->response_headers, "text/plain", NULL);
-
-	/* Set the response body */
-	soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, "Test passed!", 13);
+	g_atomic_int_inc (request_count);
+	test_download_stream_download_server_seek_handler_cb (server, message, path, query, client, NULL);
 }
 
+/* Test that short backward seeks are served from the seek window without a new request, and longer ones aren't */
 static void
-test_upload_stream_upload_no_entry_content_length (void)
+test_download_stream_download_seek_window (void)
 {
 	SoupServer *server;
 	GMainContext *async_context;
 	GThread *thread;
-	gchar *upload_uri, *test_string;
+	gchar *download_uri, *test_string;
+	volatile gint request_count = 0;
 	GDataService *service;
-	GOutputStream *upload_stream;
-	gssize length_written;
-	gsize total_length_written = 0;
-	goffset test_string_length;
+	GInputStream *download_stream;
+	gssize length_read;
+	guint8 buffer[20];
+	guint i;
 	gboolean success;
 	GError *error = NULL;
 
 	/* Create and run the server */
-	server = create_server ((SoupServerCallback) test_upload_stream_upload_no_entry_content_length_server_handler_cb, NULL, &async_context);
+	server = create_server ((SoupServerCallback) test_download_stream_download_server_counting_handler_cb, (gpointer) &request_count,
+	                        &async_context);
 	thread = run_server (server);
 
-	/* Create a new upload stream uploading to the server */
-	upload_uri = build_server_uri (server);
+	/* Create a new download stream connected to the server, keeping the last 100 bytes read */
+	download_uri = build_server_uri (server);
 	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
-	upload_stream = gdata_upload_stream_new (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", NULL);
+	download_stream = gdata_download_stream_new (service, NULL, download_uri, NULL);
+	gdata_download_stream_set_seek_window_size (GDATA_DOWNLOAD_STREAM (download_stream), 100);
+	g_assert_cmpuint (gdata_download_stream_get_seek_window_size (GDATA_DOWNLOAD_STREAM (download_stream)), ==, 100);
+	g_object_unref (service);
+	g_free (download_uri);
+
+	test_string = get_test_string (1, 1000);
+
+	/* Read more than the seek window holds */
+	for (i = 0; i < 10; i++) {
+		length_read = g_input_stream_read (download_stream, buffer, sizeof (buffer), NULL, &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (length_read, ==, sizeof (buffer));
+	}
+
+	/* Seek back within the window, and check the data is replayed correctly, including reading across the front of the window */
+	success = g_seekable_seek (G_SEEKABLE (download_stream), 150, G_SEEK_SET, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+	g_assert_cmpint (g_seekable_tell (G_SEEKABLE (download_stream)), ==, 150);
+
+	for (i = 0; i < 4; i++) {
+		length_read = g_input_stream_read (download_stream, buffer, sizeof (buffer), NULL, &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (length_read, >, 0);
+		g_assert (memcmp (buffer, test_string + g_seekable_tell (G_SEEKABLE (download_stream)) - length_read, length_read) == 0);
+	}
+
+	g_assert_cmpint (g_atomic_int_get (&request_count), ==, 1);
+
+	/* Seek back beyond the window, which needs a new request */
+	success = g_seekable_seek (G_SEEKABLE (download_stream), 20, G_SEEK_SET, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	length_read = g_input_stream_read (download_stream, buffer, sizeof (buffer), NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (length_read, >, 0);
+	g_assert (memcmp (buffer, test_string + 20, length_read) == 0);
+
+	g_assert_cmpint (g_atomic_int_get (&request_count), ==, 2);
+
+	g_free (test_string);
+
+	/* Close the stream */
+	success = g_input_stream_close (download_stream, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_object_unref (download_stream);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+static void
+test_download_stream_download_server_large_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query,
+                                                       SoupClientContext *client, gpointer user_data)
+{
+	gchar *test_string;
+	goffset test_string_length;
+
+	/* Respond with much more data than the stream will buffer, all at once */
+	test_string = get_test_string (1, 50000);
+	test_string_length = strlen (test_string) + 1;
+
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_headers_set_content_type (message->response_headers, "text/plain", NULL);
+	soup_message_headers_set_content_length (message->response_headers, test_string_length);
+	soup_message_body_append (message->response_body, SOUP_MEMORY_TAKE, test_string, test_string_length);
+}
+
+/* Test that a download with a bounded buffer is paused by the service's I/O loop while the buffer is full, without any data being lost from the
+ * chunks which didn't fit into the buffer when they were received */
+static void
+test_download_stream_download_bounded_buffer (void)
+{
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *download_uri, *test_string;
+	GDataService *service;
+	GInputStream *download_stream;
+	GDataServiceGauges gauges;
+	gssize length_read;
+	GString *contents;
+	guint8 buffer[1000];
+	gboolean success;
+	GError *error = NULL;
+
+	/* Create and run the server */
+	server = create_server ((SoupServerCallback) test_download_stream_download_server_large_handler_cb, NULL, &async_context);
+	thread = run_server (server);
+
+	/* Create a new download stream connected to the server, with the smallest buffer possible */
+	download_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	download_stream = gdata_download_stream_new (service, NULL, download_uri, NULL);
+	gdata_download_stream_set_max_buffer_size (GDATA_DOWNLOAD_STREAM (download_stream), 4096);
+	g_assert_cmpuint (gdata_download_stream_get_max_buffer_size (GDATA_DOWNLOAD_STREAM (download_stream)), ==, 4096);
+	g_free (download_uri);
+
+	/* Start the download, then give the I/O loop time to fill the buffer */
+	length_read = g_input_stream_read (download_stream, buffer, 1, NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (length_read, ==, 1);
+
+	contents = g_string_new (NULL);
+	g_string_append_len (contents, (const gchar*) buffer, length_read);
+
+	g_usleep (G_USEC_PER_SEC / 5);
+
+	/* The buffer is a ring of exactly 4096 bytes, so that's all which can have been received but not read, however much the server sent */
+	gdata_service_get_gauges (service, &gauges);
+	g_assert_cmpuint (gauges.download_buffered_bytes, >, 0);
+	g_assert_cmpuint (gauges.download_buffered_bytes, <=, 4096);
+
+	/* Read the rest of the stream slowly, checking that the buffer stays bounded */
+	while ((length_read = g_input_stream_read (download_stream, buffer, sizeof (buffer), NULL, &error)) > 0) {
+		g_assert_cmpint (length_read, <=, sizeof (buffer));
+		g_string_append_len (contents, (const gchar*) buffer, length_read);
+
+		gdata_service_get_gauges (service, &gauges);
+		g_assert_cmpuint (gauges.download_buffered_bytes, <=, 4096);
+	}
+
+	/* Check we've reached EOF successfully */
+	g_assert_no_error (error);
+	g_assert_cmpint (length_read, ==, 0);
+
+	success = g_input_stream_close (download_stream, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	/* Compare the downloaded string to the original */
+	test_string = get_test_string (1, 50000);
+
+	g_assert_cmpint (contents->len, ==, strlen (test_string) + 1);
+	g_assert_cmpstr (contents->str, ==, test_string);
+
+	g_free (test_string);
+	g_string_free (contents, TRUE);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_object_unref (download_stream);
+	g_object_unref (service);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+static void
+test_upload_stream_upload_no_entry_content_length_server_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query,
+                                                                     SoupClientContext *client, gpointer user_data)
+{
+	gchar *test_string;
+	goffset test_string_length;
+
+	/* Check the Slug and Content-Type headers have been correctly set by the client */
+	g_assert_cmpstr (soup_message_headers_get_content_type (message->request_headers, NULL), ==, "text/plain");
+	g_assert_cmpstr (soup_message_headers_get_one (message->request_headers, "Slug"), ==, "slug");
+
+	/* Check the client sent the right data */
+	test_string = get_test_string (1, 1000);
+	test_string_length = strlen (test_string) + 1;
+
+	g_assert_cmpint (message->request_body->length, ==, test_string_length);
+	g_assert_cmpstr (message->request_body->data, ==, test_string);
+
+	g_free (test_string);
+
+	/* Add some response headers */
+	soup_message_set_status (message, SOUP_STATUS_OK);
+	soup_message_headers_set_content_type (message->response_headers, "text/plain", NULL);
+
+	/* Set the response body */
+	soup_message_body_append (message->response_body, SOUP_MEMORY_STATIC, "Test passed!", 13);
+}
+
+static void
+test_upload_stream_upload_no_entry_content_length (void)
+{
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *upload_uri, *test_string, *expected_checksum;
+	GDataService *service;
+	GOutputStream *upload_stream;
+	gssize length_written;
+	gsize total_length_written = 0;
+	goffset test_string_length;
+	gboolean success;
+	GError *error = NULL;
+
+	/* Create and run the server */
+	server = create_server ((SoupServerCallback) test_upload_stream_upload_no_entry_content_length_server_handler_cb, NULL, &async_context);
+	thread = run_server (server);
+
+	/* Create a new upload stream uploading to the server */
+	upload_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	upload_stream = gdata_upload_stream_new (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", NULL);
 	g_object_unref (service);
 	g_free (upload_uri);
 
+	/* Digest the data as it's written */
+	gdata_upload_stream_set_checksum_type (GDATA_UPLOAD_STREAM (upload_stream), G_CHECKSUM_SHA1);
+
 	/* Write the entire test string to the stream */
 	test_string = get_test_string (1, 1000);
 	test_string_length = strlen (test_string) + 1;
+	expected_checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA1, (const guchar*) test_string, test_string_length);
 
 	while ((length_written = g_output_stream_write (upload_stream, test_string + total_length_written,
 	                                                test_string_length - total_length_written, NULL, &error)) > 0) {
@@ -550,11 +1178,81 @@ test_upload_stream_upload_no_entry_content_length (void)
 	g_assert_cmpint (length_written, ==, 0);
 	g_assert_cmpint (total_length_written, ==, test_string_length);
 
+	/* The digest isn't available until the stream's closed */
+	g_assert (gdata_upload_stream_get_checksum (GDATA_UPLOAD_STREAM (upload_stream)) == NULL);
+
 	/* Close the stream */
 	success = g_output_stream_close (upload_stream, NULL, &error);
 	g_assert_no_error (error);
 	g_assert (success == TRUE);
 
+	g_assert_cmpstr (gdata_upload_stream_get_checksum (GDATA_UPLOAD_STREAM (upload_stream)), ==, expected_checksum);
+	g_free (expected_checksum);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_object_unref (upload_stream);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+static void
+test_upload_stream_upload_write_behind (void)
+{
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *upload_uri, *test_string;
+	GDataService *service;
+	GOutputStream *upload_stream;
+	gssize length_written;
+	gsize total_length_written = 0;
+	goffset test_string_length;
+	gboolean success;
+	GError *error = NULL;
+
+	/* Create and run the server; it checks the same data as for test_upload_stream_upload_no_entry_content_length() */
+	server = create_server ((SoupServerCallback) test_upload_stream_upload_no_entry_content_length_server_handler_cb, NULL, &async_context);
+	thread = run_server (server);
+
+	/* Create a new upload stream uploading to the server */
+	upload_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	upload_stream = gdata_upload_stream_new (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", NULL);
+	g_object_unref (service);
+	g_free (upload_uri);
+
+	/* Writes wait for their data to be sent by default */
+	g_assert_cmpuint (gdata_upload_stream_get_write_behind_size (GDATA_UPLOAD_STREAM (upload_stream)), ==, 0);
+	gdata_upload_stream_set_write_behind_size (GDATA_UPLOAD_STREAM (upload_stream), 4096);
+	g_assert_cmpuint (gdata_upload_stream_get_write_behind_size (GDATA_UPLOAD_STREAM (upload_stream)), ==, 4096);
+
+	/* Write the test string in small pieces, all of which should be accepted in full */
+	test_string = get_test_string (1, 1000);
+	test_string_length = strlen (test_string) + 1;
+
+	while (total_length_written < (gsize) test_string_length) {
+		length_written = g_output_stream_write (upload_stream, test_string + total_length_written,
+		                                        MIN (1000, test_string_length - total_length_written), NULL, &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (length_written, ==, MIN (1000, test_string_length - total_length_written));
+
+		total_length_written += length_written;
+	}
+
+	g_free (test_string);
+
+	/* Flushing waits for everything to be sent; then close the stream */
+	success = g_output_stream_flush (upload_stream, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	success = g_output_stream_close (upload_stream, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
 	/* Kill the server and wait for it to die */
 	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
 	g_thread_join (thread);
@@ -946,41 +1644,986 @@ test_upload_stream_resumable (gconstpointer user_data)
 	g_main_context_unref (async_context);
 }
 
-int
-main (int argc, char *argv[])
+typedef struct {
+	gsize file_size;
+	gsize next_range_start;
+	guint next_path_index;
+	const gchar *test_string;
+} UploadStreamResumableUnknownLengthServerData;
+
+static void
+test_upload_stream_resumable_unknown_length_server_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query,
+                                                               SoupClientContext *client, UploadStreamResumableUnknownLengthServerData *server_data)
 {
-	gdata_test_init (argc, argv);
+	gchar *upload_uri, *range;
+	gboolean is_final;
 
-	/* Only print out headers, since we're sending a lot of data. */
-	g_setenv ("LIBGDATA_DEBUG", "2" /* GDATA_LOG_HEADERS */, TRUE);
+	if (strcmp (path, "/") == 0) {
+		/* Initial request. The length of the file isn't known yet. */
+		g_assert_cmpuint (server_data->next_path_index, ==, 0);
+		g_assert_cmpstr (soup_message_headers_get_one (message->request_headers, "X-Upload-Content-Type"), ==, "text/plain");
+		g_assert_cmpstr (soup_message_headers_get_one (message->request_headers, "X-Upload-Content-Length"), ==, NULL);
+		g_assert_cmpint (message->request_body->length, ==, 0);
 
-	g_test_add_func ("/download-stream/download_content_length", test_download_stream_download_content_length);
-	g_test_add_func ("/download-stream/download_seek/before_start", test_download_stream_download_seek_before_start);
-	g_test_add_func ("/download-stream/download_seek/after_start_forwards", test_download_stream_download_seek_after_start_forwards);
-	g_test_add_func ("/download-stream/download_seek/after_start_backwards", test_download_stream_download_seek_after_start_backwards);
+		soup_message_set_status (message, SOUP_STATUS_OK);
+	} else if (*path == '/' && g_ascii_strtoull (path + 1, NULL, 10) == server_data->next_path_index) {
+		g_assert_cmpint (soup_message_headers_get_content_length (message->request_headers), ==, message->request_body->length);
 
-	g_test_add_func ("/upload-stream/upload_no_entry_content_length", test_upload_stream_upload_no_entry_content_length);
+		if (message->request_body->length > 0) {
+			goffset range_start, range_end, range_length;
 
-	/* Test all possible combinations of conditions for resumable uploads. */
-	{
-		guint i, j, k;
+			g_assert (soup_message_headers_get_content_range (message->request_headers, &range_start, &range_end, &range_length) == TRUE);
+			g_assert_cmpint (range_start, ==, server_data->next_range_start);
+			g_assert_cmpint (range_end, ==, range_start + message->request_body->length - 1);
+			g_assert (memcmp (server_data->test_string + range_start, message->request_body->data, message->request_body->length) == 0);
 
-		const gsize file_sizes[] = { /* all in bytes */
-			407 * 1024, /* < 512 KiB */
-			512 * 1024, /* 512 KiB */
-			666 * 1024, /* > 512 KiB, < 1024 KiB */
-			1024 * 1024, /* 1024 KiB */
-			1025 * 1024, /* > 1024 KiB */
-		};
+			/* All chunks but the last must be full-sized, and must not give the total length */
+			is_final = (range_length != -1);
+			g_assert (is_final == TRUE || message->request_body->length == 512 * 1024 /* 512 KiB */);
 
-		for (i = 0; i < UPLOAD_STREAM_RESUMABLE_MAX_CONTENT_TYPE + 1; i++) {
-			for (j = 0; j < G_N_ELEMENTS (file_sizes); j++) {
-				for (k = 0; k < UPLOAD_STREAM_RESUMABLE_MAX_ERROR_TYPE + 1; k++) {
-					UploadStreamResumableTestParams *test_params;
-					gchar *test_name;
-					gsize file_size;
+			server_data->next_range_start = range_end + 1;
+		} else {
+			gchar *expected_range;
 
-					/* Ignore combinations of METADATA_ONLY with file_sizes or non-initial errors. */
+			/* The previous chunk ended at EOF */
+			expected_range = g_strdup_printf ("bytes */%" G_GSIZE_FORMAT, server_data->next_range_start);
+			g_assert_cmpstr (soup_message_headers_get_one (message->request_headers, "Content-Range"), ==, expected_range);
+			g_free (expected_range);
+
+			is_final = TRUE;
+		}
+
+		if (is_final == TRUE) {
+			g_assert_cmpuint (server_data->next_range_start, ==, server_data->file_size);
+			soup_message_set_status (message, SOUP_STATUS_CREATED);
+			return;
+		}
+
+		soup_message_set_status (message, 308);
+
+		range = g_strdup_printf ("bytes=0-%" G_GSIZE_FORMAT, server_data->next_range_start - 1);
+		soup_message_headers_replace (message->response_headers, "Range", range);
+		g_free (range);
+	} else {
+		g_assert_not_reached ();
+	}
+
+	/* Continuation */
+	upload_uri = g_strdup_printf ("http://%s:%u/%u",
+	                              soup_address_get_physical (soup_socket_get_local_address (soup_server_get_listener (server))),
+	                              soup_server_get_port (server), ++server_data->next_path_index);
+	soup_message_headers_replace (message->response_headers, "Location", upload_uri);
+	g_free (upload_uri);
+}
+
+static void
+test_upload_stream_resumable_unknown_length (gconstpointer user_data)
+{
+	UploadStreamResumableUnknownLengthServerData server_data;
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *upload_uri, *test_string;
+	GDataService *service;
+	GOutputStream *upload_stream;
+	gsize file_size, total_length_written = 0;
+	gssize length_written;
+	gboolean success;
+	GError *error = NULL;
+
+	file_size = GPOINTER_TO_SIZE (user_data);
+
+	test_string = get_test_string (1, file_size / 4 /* arbitrary number which should generate enough data */);
+	g_assert (strlen (test_string) + 1 >= file_size);
+
+	/* Create and run the server */
+	server_data.file_size = file_size;
+	server_data.next_range_start = 0;
+	server_data.next_path_index = 0;
+	server_data.test_string = test_string;
+
+	server = create_server ((SoupServerCallback) test_upload_stream_resumable_unknown_length_server_handler_cb, &server_data, &async_context);
+	thread = run_server (server);
+
+	upload_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	upload_stream = gdata_upload_stream_new_resumable (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", -1, NULL);
+	g_object_unref (service);
+	g_free (upload_uri);
+
+	g_assert_cmpint (gdata_upload_stream_get_content_length (GDATA_UPLOAD_STREAM (upload_stream)), ==, -1);
+	g_assert (gdata_upload_stream_get_resumable (GDATA_UPLOAD_STREAM (upload_stream)) == TRUE);
+
+	/* Write in small pieces, as a live producer would. None of the writes should block waiting for the chunk they're part of to be sent. */
+	while (total_length_written < file_size) {
+		length_written = g_output_stream_write (upload_stream, test_string + total_length_written,
+		                                        MIN (4096, file_size - total_length_written), NULL, &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (length_written, >, 0);
+
+		total_length_written += length_written;
+	}
+
+	success = g_output_stream_close (upload_stream, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	g_assert_cmpuint (server_data.next_range_start, ==, file_size);
+	g_assert_cmpint (gdata_upload_stream_get_committed_length (GDATA_UPLOAD_STREAM (upload_stream)), ==, file_size);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_free (test_string);
+	g_object_unref (upload_stream);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+typedef struct {
+	const gchar *test_string;
+	gsize file_size;
+	gsize next_range_start;
+	guint next_path_index;
+	GArray *chunk_lengths; /* guint lengths of the chunks received */
+	guint fail_after_n_chunks; /* fail the chunk after this many have been received, or 0 to never fail */
+	guint n_requests;
+} UploadStreamChunksServerData;
+
+static void
+test_upload_stream_chunks_server_handler_cb (SoupServer *server, SoupMessage *message, const char *path, GHashTable *query,
+                                             SoupClientContext *client, UploadStreamChunksServerData *server_data)
+{
+	gchar *upload_uri, *range;
+
+	server_data->n_requests++;
+
+	if (strcmp (path, "/") == 0) {
+		/* Initial request */
+		g_assert_cmpuint (server_data->next_path_index, ==, 0);
+		g_assert_cmpint (message->request_body->length, ==, 0);
+
+		/* There's nothing more to send for an empty file */
+		if (server_data->file_size == 0) {
+			soup_message_set_status (message, SOUP_STATUS_CREATED);
+			soup_message_set_response (message, "text/plain", SOUP_MEMORY_STATIC, "Uploaded", strlen ("Uploaded"));
+			return;
+		}
+
+		soup_message_set_status (message, SOUP_STATUS_OK);
+		goto continuation;
+	}
+
+	g_assert_cmpuint (g_ascii_strtoull (path + 1, NULL, 10), ==, server_data->next_path_index);
+
+	if (message->request_body->length == 0) {
+		gchar *expected_range;
+
+		/* A resumed upload asking how much of the file has been received */
+		expected_range = g_strdup_printf ("bytes */%" G_GSIZE_FORMAT, server_data->file_size);
+		g_assert_cmpstr (soup_message_headers_get_one (message->request_headers, "Content-Range"), ==, expected_range);
+		g_free (expected_range);
+	} else {
+		goffset range_start, range_end, range_length;
+		guint length = message->request_body->length;
+
+		/* Check the chunk follows on from the previous one */
+		g_assert (soup_message_headers_get_content_range (message->request_headers, &range_start, &range_end, &range_length) == TRUE);
+		g_assert_cmpint (range_start, ==, server_data->next_range_start);
+		g_assert_cmpint (range_end, ==, range_start + length - 1);
+		g_assert_cmpint (range_length, ==, server_data->file_size);
+		g_assert (memcmp (server_data->test_string + range_start, message->request_body->data, length) == 0);
+
+		if (server_data->fail_after_n_chunks > 0 && server_data->chunk_lengths->len == server_data->fail_after_n_chunks) {
+			/* Interrupt the upload without committing the chunk */
+			soup_message_set_status (message, SOUP_STATUS_SERVICE_UNAVAILABLE);
+			return;
+		}
+
+		g_array_append_val (server_data->chunk_lengths, length);
+		server_data->next_range_start = range_end + 1;
+
+		if (server_data->next_range_start == server_data->file_size) {
+			/* Completion */
+			soup_message_set_status (message, SOUP_STATUS_CREATED);
+			soup_message_set_response (message, "text/plain", SOUP_MEMORY_STATIC, "Uploaded", strlen ("Uploaded"));
+			return;
+		}
+	}
+
+	soup_message_set_status (message, 308);
+
+	if (server_data->next_range_start > 0) {
+		range = g_strdup_printf ("bytes=0-%" G_GSIZE_FORMAT, server_data->next_range_start - 1);
+		soup_message_headers_replace (message->response_headers, "Range", range);
+		g_free (range);
+	}
+
+continuation:
+	upload_uri = g_strdup_printf ("http://%s:%u/%u",
+	                              soup_address_get_physical (soup_socket_get_local_address (soup_server_get_listener (server))),
+	                              soup_server_get_port (server), ++server_data->next_path_index);
+	soup_message_headers_replace (message->response_headers, "Location", upload_uri);
+	g_free (upload_uri);
+}
+
+/* Writes @length bytes of @data to @upload_stream and closes it, checking for errors */
+static void
+write_and_close_upload_stream (GOutputStream *upload_stream, const gchar *data, gsize length)
+{
+	gsize total_length_written = 0;
+	gssize length_written;
+	gboolean success;
+	GError *error = NULL;
+
+	while (total_length_written < length) {
+		length_written = g_output_stream_write (upload_stream, data + total_length_written, length - total_length_written, NULL, &error);
+		g_assert_no_error (error);
+		g_assert_cmpint (length_written, >, 0);
+
+		total_length_written += length_written;
+	}
+
+	success = g_output_stream_close (upload_stream, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+}
+
+static void
+test_upload_stream_resumable_chunk_size (void)
+{
+	UploadStreamChunksServerData server_data;
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *upload_uri, *test_string;
+	GDataService *service;
+	GOutputStream *upload_stream;
+	guint chunk_size;
+	gsize file_size = 1000 * 1024;
+
+	test_string = get_test_string (1, file_size / 4 /* arbitrary number which should generate enough data */);
+	g_assert (strlen (test_string) >= file_size);
+
+	/* Create and run the server */
+	server_data.test_string = test_string;
+	server_data.file_size = file_size;
+	server_data.next_range_start = 0;
+	server_data.next_path_index = 0;
+	server_data.chunk_lengths = g_array_new (FALSE, FALSE, sizeof (guint));
+	server_data.n_requests = 0;
+	server_data.fail_after_n_chunks = 0;
+
+	server = create_server ((SoupServerCallback) test_upload_stream_chunks_server_handler_cb, &server_data, &async_context);
+	thread = run_server (server);
+
+	upload_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	upload_stream = gdata_upload_stream_new_resumable (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", file_size, NULL);
+	g_object_unref (service);
+	g_free (upload_uri);
+
+	/* The default chunk size is 512 KiB; change it to 256 KiB before anything's been sent */
+	g_assert_cmpuint (gdata_upload_stream_get_chunk_size (GDATA_UPLOAD_STREAM (upload_stream)), ==, 512 * 1024);
+
+	gdata_upload_stream_set_chunk_size (GDATA_UPLOAD_STREAM (upload_stream), 256 * 1024);
+	g_assert_cmpuint (gdata_upload_stream_get_chunk_size (GDATA_UPLOAD_STREAM (upload_stream)), ==, 256 * 1024);
+
+	g_object_get (upload_stream, "chunk-size", &chunk_size, NULL);
+	g_assert_cmpuint (chunk_size, ==, 256 * 1024);
+
+	write_and_close_upload_stream (upload_stream, test_string, file_size);
+
+	/* Every chunk but the last is exactly the chunk size, and the last has the rest of the file */
+	g_assert_cmpuint (server_data.next_range_start, ==, file_size);
+	g_assert_cmpuint (server_data.chunk_lengths->len, ==, 4);
+	g_assert_cmpuint (g_array_index (server_data.chunk_lengths, guint, 0), ==, 256 * 1024);
+	g_assert_cmpuint (g_array_index (server_data.chunk_lengths, guint, 1), ==, 256 * 1024);
+	g_assert_cmpuint (g_array_index (server_data.chunk_lengths, guint, 2), ==, 256 * 1024);
+	g_assert_cmpuint (g_array_index (server_data.chunk_lengths, guint, 3), ==, file_size - 3 * 256 * 1024);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_array_free (server_data.chunk_lengths, TRUE);
+	g_free (test_string);
+	g_object_unref (upload_stream);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+typedef struct {
+	gint64 next_offset;
+	guint n_chunks;
+} UploadStreamChunkSentData;
+
+static void
+test_upload_stream_chunk_sent_cb (GDataUploadStream *upload_stream, gint64 offset, guint length, gint64 send_time, gint64 response_time,
+                                  UploadStreamChunkSentData *data)
+{
+	guint chunk_size;
+
+	/* Emitted once for each chunk, in order */
+	g_assert_cmpint (offset, ==, data->next_offset);
+	g_assert_cmpuint (length, >, 0);
+	g_assert_cmpint (send_time, >, 0);
+	g_assert_cmpint (response_time, >=, 0);
+
+	data->next_offset += length;
+	data->n_chunks++;
+
+	/* The chunk size is recalculated as each chunk is acknowledged, but never leaves its bounds */
+	chunk_size = gdata_upload_stream_get_chunk_size (upload_stream);
+	g_assert_cmpuint (chunk_size, >=, 256 * 1024);
+	g_assert_cmpuint (chunk_size, <=, 512 * 1024);
+	g_assert_cmpuint (chunk_size % (256 * 1024), ==, 0);
+}
+
+static void
+test_upload_stream_resumable_adaptive_chunk_size (void)
+{
+	UploadStreamChunksServerData server_data;
+	UploadStreamChunkSentData chunk_sent_data;
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *upload_uri, *test_string;
+	GDataService *service;
+	GOutputStream *upload_stream;
+	guint i;
+	gsize file_size = 3 * 1024 * 1024;
+
+	test_string = get_test_string (1, file_size / 4 /* arbitrary number which should generate enough data */);
+	g_assert (strlen (test_string) >= file_size);
+
+	/* Create and run the server */
+	server_data.test_string = test_string;
+	server_data.file_size = file_size;
+	server_data.next_range_start = 0;
+	server_data.next_path_index = 0;
+	server_data.chunk_lengths = g_array_new (FALSE, FALSE, sizeof (guint));
+	server_data.n_requests = 0;
+	server_data.fail_after_n_chunks = 0;
+
+	server = create_server ((SoupServerCallback) test_upload_stream_chunks_server_handler_cb, &server_data, &async_context);
+	thread = run_server (server);
+
+	upload_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	upload_stream = gdata_upload_stream_new_resumable (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", file_size, NULL);
+	g_object_unref (service);
+	g_free (upload_uri);
+
+	/* Check the defaults */
+	g_assert (gdata_upload_stream_get_adaptive_chunk_size (GDATA_UPLOAD_STREAM (upload_stream)) == FALSE);
+	g_assert_cmpuint (gdata_upload_stream_get_min_chunk_size (GDATA_UPLOAD_STREAM (upload_stream)), ==, 256 * 1024);
+	g_assert_cmpuint (gdata_upload_stream_get_max_chunk_size (GDATA_UPLOAD_STREAM (upload_stream)), ==, 64 * 1024 * 1024);
+
+	/* Start small and let the stream choose the size of later chunks, up to 512 KiB */
+	gdata_upload_stream_set_chunk_size (GDATA_UPLOAD_STREAM (upload_stream), 256 * 1024);
+	gdata_upload_stream_set_adaptive_chunk_size (GDATA_UPLOAD_STREAM (upload_stream), TRUE);
+	gdata_upload_stream_set_min_chunk_size (GDATA_UPLOAD_STREAM (upload_stream), 256 * 1024);
+	gdata_upload_stream_set_max_chunk_size (GDATA_UPLOAD_STREAM (upload_stream), 512 * 1024);
+	g_assert (gdata_upload_stream_get_adaptive_chunk_size (GDATA_UPLOAD_STREAM (upload_stream)) == TRUE);
+
+	chunk_sent_data.next_offset = 0;
+	chunk_sent_data.n_chunks = 0;
+	g_signal_connect (upload_stream, "chunk-sent", (GCallback) test_upload_stream_chunk_sent_cb, &chunk_sent_data);
+
+	write_and_close_upload_stream (upload_stream, test_string, file_size);
+
+	/* ::chunk-sent was emitted once for each chunk the server received */
+	g_assert_cmpuint (server_data.next_range_start, ==, file_size);
+	g_assert_cmpuint (chunk_sent_data.n_chunks, ==, server_data.chunk_lengths->len);
+	g_assert_cmpint (chunk_sent_data.next_offset, ==, file_size);
+
+	/* All the chunks but the last were within the bounds, and a multiple of 256 KiB */
+	g_assert_cmpuint (g_array_index (server_data.chunk_lengths, guint, 0), ==, 256 * 1024);
+
+	for (i = 0; i < server_data.chunk_lengths->len; i++) {
+		guint length = g_array_index (server_data.chunk_lengths, guint, i);
+
+		g_assert_cmpuint (length, <=, 512 * 1024);
+
+		if (i < server_data.chunk_lengths->len - 1) {
+			g_assert_cmpuint (length, >=, 256 * 1024);
+			g_assert_cmpuint (length % (256 * 1024), ==, 0);
+		}
+	}
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_array_free (server_data.chunk_lengths, TRUE);
+	g_free (test_string);
+	g_object_unref (upload_stream);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+static void
+test_upload_stream_save_session_cb (GDataUploadStream *upload_stream, gint64 offset, guint length, gint64 send_time, gint64 response_time,
+                                    gchar **session)
+{
+	/* Persist the session after each chunk, as an application would */
+	g_free (*session);
+	*session = gdata_upload_stream_save_session (upload_stream);
+}
+
+static void
+test_upload_stream_resumable_session (void)
+{
+	UploadStreamChunksServerData server_data;
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *upload_uri, *test_string, *session = NULL;
+	GDataService *service;
+	GOutputStream *upload_stream;
+	gsize total_length_written = 0;
+	gssize length_written;
+	goffset committed_length;
+	gboolean success;
+	GError *error = NULL;
+	gsize file_size = 1000 * 1024;
+
+	test_string = get_test_string (1, file_size / 4 /* arbitrary number which should generate enough data */);
+	g_assert (strlen (test_string) >= file_size);
+
+	/* Create and run the server, which fails the third chunk */
+	server_data.test_string = test_string;
+	server_data.file_size = file_size;
+	server_data.next_range_start = 0;
+	server_data.next_path_index = 0;
+	server_data.chunk_lengths = g_array_new (FALSE, FALSE, sizeof (guint));
+	server_data.n_requests = 0;
+	server_data.fail_after_n_chunks = 2;
+
+	server = create_server ((SoupServerCallback) test_upload_stream_chunks_server_handler_cb, &server_data, &async_context);
+	thread = run_server (server);
+
+	upload_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+	upload_stream = gdata_upload_stream_new_resumable (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", file_size, NULL);
+	g_free (upload_uri);
+
+	gdata_upload_stream_set_chunk_size (GDATA_UPLOAD_STREAM (upload_stream), 256 * 1024);
+	g_signal_connect (upload_stream, "chunk-sent", (GCallback) test_upload_stream_save_session_cb, &session);
+
+	/* There's no session until the server has responded to the initial request */
+	g_assert (gdata_upload_stream_save_session (GDATA_UPLOAD_STREAM (upload_stream)) == NULL);
+
+	while ((length_written = g_output_stream_write (upload_stream, test_string + total_length_written, file_size - total_length_written,
+	                                                NULL, &error)) > 0) {
+		total_length_written += length_written;
+	}
+
+	g_assert_cmpint (length_written, <=, 0);
+	g_clear_error (&error);
+
+	success = g_output_stream_close (upload_stream, NULL, &error);
+	g_assert (error != NULL);
+	g_assert (success == FALSE);
+	g_clear_error (&error);
+
+	/* The session was last saved once the second chunk had been acknowledged */
+	g_assert_cmpuint (server_data.chunk_lengths->len, ==, 2);
+	g_assert_cmpint (gdata_upload_stream_get_committed_length (GDATA_UPLOAD_STREAM (upload_stream)), ==, 2 * 256 * 1024);
+	g_assert (session != NULL);
+
+	g_object_unref (upload_stream);
+
+	/* Resume the upload from the session, as if in a new process. The server is asked how much it has received. */
+	server_data.fail_after_n_chunks = 0;
+
+	upload_stream = gdata_upload_stream_new_from_session (service, NULL, session, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_UPLOAD_STREAM (upload_stream));
+
+	g_assert (gdata_upload_stream_get_resumable (GDATA_UPLOAD_STREAM (upload_stream)) == TRUE);
+	g_assert_cmpint (gdata_upload_stream_get_content_length (GDATA_UPLOAD_STREAM (upload_stream)), ==, file_size);
+	g_assert_cmpstr (gdata_upload_stream_get_content_type (GDATA_UPLOAD_STREAM (upload_stream)), ==, "text/plain");
+	g_assert_cmpstr (gdata_upload_stream_get_slug (GDATA_UPLOAD_STREAM (upload_stream)), ==, "slug");
+
+	committed_length = gdata_upload_stream_get_committed_length (GDATA_UPLOAD_STREAM (upload_stream));
+	g_assert_cmpint (committed_length, ==, 2 * 256 * 1024);
+
+	/* Only the rest of the file is sent, which fits in a single chunk of the default size */
+	write_and_close_upload_stream (upload_stream, test_string + committed_length, file_size - committed_length);
+
+	g_assert_cmpuint (server_data.next_range_start, ==, file_size);
+	g_assert_cmpuint (server_data.chunk_lengths->len, ==, 3);
+	g_assert_cmpuint (g_array_index (server_data.chunk_lengths, guint, 2), ==, file_size - committed_length);
+	g_assert_cmpint (gdata_upload_stream_get_committed_length (GDATA_UPLOAD_STREAM (upload_stream)), ==, file_size);
+
+	g_object_unref (upload_stream);
+
+	/* Invalid sessions are rejected without touching the network */
+	upload_stream = gdata_upload_stream_new_from_session (service, NULL, "not a session", NULL, &error);
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_assert (upload_stream == NULL);
+	g_clear_error (&error);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_array_free (server_data.chunk_lengths, TRUE);
+	g_free (session);
+	g_free (test_string);
+	g_object_unref (service);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+/* Creates a temporary file containing the first @length bytes of @contents, returning it and its path */
+static GFile *
+create_upload_test_file (const gchar *contents, gsize length, gchar **path)
+{
+	GError *error = NULL;
+	gint fd;
+
+	fd = g_file_open_tmp ("libgdata-streams-test-XXXXXX", path, &error);
+	g_assert_no_error (error);
+	close (fd);
+
+	g_file_set_contents (*path, contents, length, &error);
+	g_assert_no_error (error);
+
+	return g_file_new_for_path (*path);
+}
+
+static void
+test_upload_stream_resumable_from_file (void)
+{
+	UploadStreamChunksServerData server_data;
+	SoupServer *server;
+	GMainContext *async_context;
+	GThread *thread;
+	gchar *upload_uri, *test_string, *path;
+	GDataService *service;
+	GOutputStream *upload_stream;
+	GFile *file;
+	const gchar *response;
+	gssize response_length;
+	gboolean success;
+	GError *error = NULL;
+	gsize file_size = 1000 * 1024;
+
+	test_string = get_test_string (1, file_size / 4 /* arbitrary number which should generate enough data */);
+	g_assert (strlen (test_string) >= file_size);
+
+	/* Create and run the server */
+	server_data.test_string = test_string;
+	server_data.file_size = file_size;
+	server_data.next_range_start = 0;
+	server_data.next_path_index = 0;
+	server_data.chunk_lengths = g_array_new (FALSE, FALSE, sizeof (guint));
+	server_data.n_requests = 0;
+	server_data.fail_after_n_chunks = 0;
+
+	server = create_server ((SoupServerCallback) test_upload_stream_chunks_server_handler_cb, &server_data, &async_context);
+	thread = run_server (server);
+
+	upload_uri = build_server_uri (server);
+	service = GDATA_SERVICE (gdata_youtube_service_new ("developer-key", NULL));
+
+	/* Only local files can be mapped */
+	file = g_file_new_for_uri ("http://example.com/file.txt");
+	upload_stream = gdata_upload_stream_new_resumable_from_file (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", file,
+	                                                             NULL, &error);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+	g_assert (upload_stream == NULL);
+	g_clear_error (&error);
+	g_object_unref (file);
+
+	file = create_upload_test_file (test_string, file_size, &path);
+	upload_stream = gdata_upload_stream_new_resumable_from_file (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", file,
+	                                                             NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_UPLOAD_STREAM (upload_stream));
+	g_assert_cmpint (gdata_upload_stream_get_content_length (GDATA_UPLOAD_STREAM (upload_stream)), ==, file_size);
+
+	/* The data comes from the file, so can't be written to the stream */
+	g_assert_cmpint (g_output_stream_write (upload_stream, "data", 4, NULL, &error), ==, -1);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+	g_clear_error (&error);
+
+	/* Nothing is sent until the stream is closed, which uploads the whole file */
+	g_assert_cmpuint (server_data.n_requests, ==, 0);
+
+	success = g_output_stream_close (upload_stream, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	g_assert_cmpuint (server_data.next_range_start, ==, file_size);
+	g_assert_cmpuint (server_data.chunk_lengths->len, ==, 2);
+	g_assert_cmpuint (g_array_index (server_data.chunk_lengths, guint, 0), ==, 512 * 1024);
+	g_assert_cmpuint (g_array_index (server_data.chunk_lengths, guint, 1), ==, file_size - 512 * 1024);
+
+	response = gdata_upload_stream_get_response (GDATA_UPLOAD_STREAM (upload_stream), &response_length);
+	g_assert_cmpint (response_length, ==, strlen ("Uploaded"));
+	g_assert (memcmp (response, "Uploaded", response_length) == 0);
+
+	g_object_unref (upload_stream);
+	g_object_unref (file);
+	g_unlink (path);
+	g_free (path);
+
+	/* An empty file is uploaded with just the initial request */
+	server_data.file_size = 0;
+	server_data.next_range_start = 0;
+	server_data.next_path_index = 0;
+	server_data.n_requests = 0;
+	g_array_set_size (server_data.chunk_lengths, 0);
+
+	file = create_upload_test_file ("", 0, &path);
+	upload_stream = gdata_upload_stream_new_resumable_from_file (service, NULL, SOUP_METHOD_POST, upload_uri, NULL, "slug", "text/plain", file,
+	                                                             NULL, &error);
+	g_assert_no_error (error);
+	g_assert_cmpint (gdata_upload_stream_get_content_length (GDATA_UPLOAD_STREAM (upload_stream)), ==, 0);
+
+	success = g_output_stream_close (upload_stream, NULL, &error);
+	g_assert_no_error (error);
+	g_assert (success == TRUE);
+
+	g_assert_cmpuint (server_data.n_requests, ==, 1);
+	g_assert_cmpuint (server_data.chunk_lengths->len, ==, 0);
+
+	response = gdata_upload_stream_get_response (GDATA_UPLOAD_STREAM (upload_stream), &response_length);
+	g_assert_cmpint (response_length, ==, strlen ("Uploaded"));
+	g_assert (memcmp (response, "Uploaded", response_length) == 0);
+
+	g_object_unref (upload_stream);
+	g_object_unref (file);
+	g_unlink (path);
+	g_free (path);
+
+	/* Kill the server and wait for it to die */
+	soup_add_completion (async_context, (GSourceFunc) quit_server_cb, server);
+	g_thread_join (thread);
+
+	g_array_free (server_data.chunk_lengths, TRUE);
+	g_free (upload_uri);
+	g_free (test_string);
+	g_object_unref (service);
+	g_object_unref (server);
+	g_main_context_unref (async_context);
+}
+
+/* Byte @i of the data pushed through the ring buffers in the tests below. 251 is prime, so the pattern never lines up with the ring's capacity. */
+static guint8
+get_ring_test_byte (gsize i)
+{
+	return (guint8) (i % 251);
+}
+
+static void
+fill_ring_test_data (guint8 *data, gsize offset, gsize length)
+{
+	gsize i;
+
+	for (i = 0; i < length; i++)
+		data[i] = get_ring_test_byte (offset + i);
+}
+
+static void
+check_ring_test_data (const guint8 *data, gsize offset, gsize length)
+{
+	gsize i;
+
+	for (i = 0; i < length; i++)
+		g_assert_cmpuint (data[i], ==, get_ring_test_byte (offset + i));
+}
+
+static void
+test_buffer_ring_wrap_around (void)
+{
+	GDataBuffer *buffer;
+	guint8 data[4096];
+	gsize offset, length;
+	gboolean reached_eof = TRUE;
+
+	/* The capacity is rounded up to a power of two, so this gives a ring of exactly 4096 bytes */
+	buffer = gdata_buffer_new_ring (4000);
+
+	/* Push and pop 3000 bytes at a time, so that every push after the first wraps around the end of the ring at a different offset */
+	for (offset = 0; offset < 20 * 3000; offset += 3000) {
+		fill_ring_test_data (data, offset, 3000);
+		g_assert (gdata_buffer_push_data (buffer, data, 3000) == TRUE);
+
+		memset (data, 0, sizeof (data));
+		length = gdata_buffer_pop_data (buffer, data, 3000, &reached_eof, NULL);
+		g_assert_cmpuint (length, ==, 3000);
+		g_assert (reached_eof == FALSE);
+		check_ring_test_data (data, offset, 3000);
+	}
+
+	/* Non-blocking pushes only push as much as fits, which is the whole ring once it's been emptied, wherever the ring's indices are */
+	fill_ring_test_data (data, offset, sizeof (data));
+	g_assert_cmpuint (gdata_buffer_push_data_nonblocking (buffer, data, 1000), ==, 1000);
+	g_assert_cmpuint (gdata_buffer_push_data_nonblocking (buffer, data + 1000, sizeof (data) - 1000), ==, sizeof (data) - 1000);
+	g_assert_cmpuint (gdata_buffer_push_data_nonblocking (buffer, data, 1), ==, 0);
+
+	/* Popping part of the ring makes space for exactly that much */
+	length = gdata_buffer_pop_data_limited (buffer, data, 1500, &reached_eof);
+	g_assert_cmpuint (length, ==, 1500);
+	g_assert (reached_eof == FALSE);
+	check_ring_test_data (data, offset, 1500);
+
+	fill_ring_test_data (data, offset + 4096, 2000);
+	g_assert_cmpuint (gdata_buffer_push_data_nonblocking (buffer, data, 2000), ==, 1500);
+
+	length = gdata_buffer_pop_data (buffer, data, sizeof (data), &reached_eof, NULL);
+	g_assert_cmpuint (length, ==, sizeof (data));
+	g_assert (reached_eof == FALSE);
+	check_ring_test_data (data, offset + 1500, sizeof (data));
+
+	gdata_buffer_free (buffer);
+}
+
+static void
+test_buffer_ring_eof (void)
+{
+	GDataBuffer *buffer;
+	guint8 data[4096];
+	gsize length;
+	gboolean reached_eof = FALSE;
+
+	buffer = gdata_buffer_new_ring (4096);
+
+	fill_ring_test_data (data, 0, 100);
+	g_assert (gdata_buffer_push_data (buffer, data, 100) == TRUE);
+
+	/* Mark EOF. Nothing can be pushed after it, by any means. */
+	gdata_buffer_push_data (buffer, NULL, 0);
+	g_assert (gdata_buffer_push_data (buffer, data, 100) == FALSE);
+	g_assert (gdata_buffer_push_data_bounded (buffer, data, 100, NULL) == FALSE);
+	g_assert_cmpuint (gdata_buffer_push_data_nonblocking (buffer, data, 100), ==, 0);
+
+	/* Popping more than there is doesn't block, and only reports EOF once everything has been popped */
+	memset (data, 0, sizeof (data));
+	length = gdata_buffer_pop_data (buffer, data, 50, &reached_eof, NULL);
+	g_assert_cmpuint (length, ==, 50);
+	g_assert (reached_eof == FALSE);
+	check_ring_test_data (data, 0, 50);
+
+	length = gdata_buffer_pop_data (buffer, data, sizeof (data), &reached_eof, NULL);
+	g_assert_cmpuint (length, ==, 50);
+	g_assert (reached_eof == TRUE);
+	check_ring_test_data (data, 50, 50);
+
+	/* Further pops return nothing immediately */
+	reached_eof = FALSE;
+	g_assert_cmpuint (gdata_buffer_pop_data (buffer, data, sizeof (data), &reached_eof, NULL), ==, 0);
+	g_assert (reached_eof == TRUE);
+
+	reached_eof = FALSE;
+	g_assert_cmpuint (gdata_buffer_pop_data_limited (buffer, data, sizeof (data), &reached_eof), ==, 0);
+	g_assert (reached_eof == TRUE);
+
+	gdata_buffer_free (buffer);
+}
+
+#define RING_STRESS_LENGTH (16 * 1024 * 1024) /* bytes */
+
+static gpointer
+ring_stress_push_thread_cb (GDataBuffer *buffer)
+{
+	guint8 data[7919];
+	gsize offset = 0, length;
+	guint i = 0;
+
+	/* Push pieces of varying sizes, some smaller than the ring and some larger, which block until the popping thread has made space */
+	while (offset < RING_STRESS_LENGTH) {
+		length = MIN (1 + (i++ * 1543) % sizeof (data), RING_STRESS_LENGTH - offset);
+
+		fill_ring_test_data (data, offset, length);
+
+		if (i % 2 == 0)
+			g_assert (gdata_buffer_push_data (buffer, data, length) == TRUE);
+		else
+			g_assert (gdata_buffer_push_data_bounded (buffer, data, length, NULL) == TRUE);
+
+		offset += length;
+	}
+
+	gdata_buffer_push_data (buffer, NULL, 0);
+
+	return NULL;
+}
+
+static void
+test_buffer_ring_stress (void)
+{
+	GDataBuffer *buffer;
+	GThread *thread;
+	guint8 data[6007];
+	gsize offset = 0, length;
+	gboolean reached_eof = FALSE;
+	volatile gsize length_counter = 0;
+	guint i = 0;
+
+	buffer = gdata_buffer_new_ring (4096);
+	gdata_buffer_set_length_counter (buffer, &length_counter);
+
+	thread = g_thread_new ("ring-stress-push", (GThreadFunc) ring_stress_push_thread_cb, buffer);
+
+	/* Pop pieces of varying sizes, alternating between waiting for the whole piece and taking whatever's available */
+	while (reached_eof == FALSE) {
+		length = 1 + (i++ * 2339) % sizeof (data);
+
+		if (i % 2 == 0)
+			length = gdata_buffer_pop_data (buffer, data, length, &reached_eof, NULL);
+		else
+			length = gdata_buffer_pop_data_limited (buffer, data, length, &reached_eof);
+
+		check_ring_test_data (data, offset, length);
+		offset += length;
+
+		g_assert_cmpuint (offset, <=, RING_STRESS_LENGTH);
+		g_assert_cmpuint (length_counter, <=, 4096);
+	}
+
+	g_thread_join (thread);
+
+	g_assert_cmpuint (offset, ==, RING_STRESS_LENGTH);
+	g_assert_cmpuint (length_counter, ==, 0);
+
+	gdata_buffer_free (buffer);
+}
+
+typedef struct {
+	GDataBuffer *buffer;
+	GCancellable *cancellable;
+	gsize result;
+	gboolean reached_eof;
+} RingCancellationData;
+
+static gpointer
+ring_cancellation_push_thread_cb (RingCancellationData *data)
+{
+	guint8 byte = 0;
+
+	data->result = gdata_buffer_push_data_bounded (data->buffer, &byte, 1, data->cancellable);
+
+	return NULL;
+}
+
+static gpointer
+ring_cancellation_pop_thread_cb (RingCancellationData *data)
+{
+	guint8 byte;
+
+	data->result = gdata_buffer_pop_data (data->buffer, &byte, 1, &(data->reached_eof), data->cancellable);
+
+	return NULL;
+}
+
+static void
+test_buffer_ring_cancellation (void)
+{
+	RingCancellationData data;
+	GThread *thread;
+	guint8 ring_data[4096];
+	gsize length;
+	gboolean reached_eof;
+
+	data.buffer = gdata_buffer_new_ring (4096);
+
+	/* Pop from the empty ring, which blocks until the pop is cancelled. The sleep is only to make it likely that the thread's blocked by the time
+	 * it's cancelled; the test passes either way. */
+	data.cancellable = g_cancellable_new ();
+	data.result = 1;
+	data.reached_eof = TRUE;
+
+	thread = g_thread_new ("ring-cancellation-pop", (GThreadFunc) ring_cancellation_pop_thread_cb, &data);
+	g_usleep (G_USEC_PER_SEC / 10);
+	g_cancellable_cancel (data.cancellable);
+	g_thread_join (thread);
+
+	g_assert_cmpuint (data.result, ==, 0);
+	g_assert (data.reached_eof == FALSE);
+	g_object_unref (data.cancellable);
+
+	/* Fill the ring, then push to it, which blocks until the push is cancelled */
+	fill_ring_test_data (ring_data, 0, sizeof (ring_data));
+	g_assert_cmpuint (gdata_buffer_push_data_nonblocking (data.buffer, ring_data, sizeof (ring_data)), ==, sizeof (ring_data));
+
+	data.cancellable = g_cancellable_new ();
+	data.result = TRUE;
+
+	thread = g_thread_new ("ring-cancellation-push", (GThreadFunc) ring_cancellation_push_thread_cb, &data);
+	g_usleep (G_USEC_PER_SEC / 10);
+	g_cancellable_cancel (data.cancellable);
+	g_thread_join (thread);
+
+	g_assert_cmpuint (data.result, ==, FALSE);
+	g_object_unref (data.cancellable);
+
+	/* The cancelled push mustn't have pushed anything, and the ring must still work afterwards */
+	memset (ring_data, 0, sizeof (ring_data));
+	length = gdata_buffer_pop_data_limited (data.buffer, ring_data, sizeof (ring_data) + 1, &reached_eof);
+	g_assert_cmpuint (length, ==, sizeof (ring_data));
+	g_assert (reached_eof == FALSE);
+	check_ring_test_data (ring_data, 0, sizeof (ring_data));
+
+	gdata_buffer_push_data (data.buffer, NULL, 0);
+	g_assert_cmpuint (gdata_buffer_pop_data (data.buffer, ring_data, 1, &reached_eof, NULL), ==, 0);
+	g_assert (reached_eof == TRUE);
+
+	gdata_buffer_free (data.buffer);
+}
+
+int
+main (int argc, char *argv[])
+{
+	gdata_test_init (argc, argv);
+
+	/* Only print out headers, since we're sending a lot of data. */
+	g_setenv ("LIBGDATA_DEBUG", "2" /* GDATA_LOG_HEADERS */, TRUE);
+
+	g_test_add_func ("/buffer/ring/wrap_around", test_buffer_ring_wrap_around);
+	g_test_add_func ("/buffer/ring/eof", test_buffer_ring_eof);
+	g_test_add_func ("/buffer/ring/stress", test_buffer_ring_stress);
+	g_test_add_func ("/buffer/ring/cancellation", test_buffer_ring_cancellation);
+
+	g_test_add_func ("/download-stream/download_content_length", test_download_stream_download_content_length);
+	g_test_add_func ("/download-stream/download_to_file", test_download_stream_download_to_file);
+	g_test_add_func ("/download-stream/download_segments", test_download_stream_download_segments);
+	g_test_add_func ("/download-stream/download_auto_resume", test_download_stream_download_auto_resume);
+	g_test_add_func ("/download-stream/download_seek/before_start", test_download_stream_download_seek_before_start);
+	g_test_add_func ("/download-stream/download_seek/after_start_forwards", test_download_stream_download_seek_after_start_forwards);
+	g_test_add_func ("/download-stream/download_seek/after_start_backwards", test_download_stream_download_seek_after_start_backwards);
+	g_test_add_func ("/download-stream/download_seek/window", test_download_stream_download_seek_window);
+	g_test_add_func ("/download-stream/download_bounded_buffer", test_download_stream_download_bounded_buffer);
+
+	g_test_add_func ("/upload-stream/upload_no_entry_content_length", test_upload_stream_upload_no_entry_content_length);
+	g_test_add_func ("/upload-stream/upload_write_behind", test_upload_stream_upload_write_behind);
+
+	/* Test all possible combinations of conditions for resumable uploads. */
+	{
+		guint i, j, k;
+
+		const gsize file_sizes[] = { /* all in bytes */
+			407 * 1024, /* < 512 KiB */
+			512 * 1024, /* 512 KiB */
+			666 * 1024, /* > 512 KiB, < 1024 KiB */
+			1024 * 1024, /* 1024 KiB */
+			1025 * 1024, /* > 1024 KiB */
+		};
+
+		for (i = 0; i < UPLOAD_STREAM_RESUMABLE_MAX_CONTENT_TYPE + 1; i++) {
+			for (j = 0; j < G_N_ELEMENTS (file_sizes); j++) {
+				for (k = 0; k < UPLOAD_STREAM_RESUMABLE_MAX_ERROR_TYPE + 1; k++) {
+					UploadStreamResumableTestParams *test_params;
+					gchar *test_name;
+					gsize file_size;
+
+					/* Ignore combinations of METADATA_ONLY with file_sizes or non-initial errors. */
 					if (i == METADATA_ONLY && (j != 0 || k != 0)) {
 						continue;
 					} else if (i == METADATA_ONLY) {
@@ -1008,5 +2651,14 @@ main (int argc, char *argv[])
 		}
 	}
 
+	g_test_add_data_func ("/upload-stream/resumable/unknown-length/407K", GSIZE_TO_POINTER (407 * 1024), test_upload_stream_resumable_unknown_length);
+	g_test_add_data_func ("/upload-stream/resumable/unknown-length/512K", GSIZE_TO_POINTER (512 * 1024), test_upload_stream_resumable_unknown_length);
+	g_test_add_data_func ("/upload-stream/resumable/unknown-length/1025K", GSIZE_TO_POINTER (1025 * 1024),
+	                      test_upload_stream_resumable_unknown_length);
+	g_test_add_func ("/upload-stream/resumable/chunk-size", test_upload_stream_resumable_chunk_size);
+	g_test_add_func ("/upload-stream/resumable/adaptive-chunk-size", test_upload_stream_resumable_adaptive_chunk_size);
+	g_test_add_func ("/upload-stream/resumable/session", test_upload_stream_resumable_session);
+	g_test_add_func ("/upload-stream/resumable/from-file", test_upload_stream_resumable_from_file);
+
 	return g_test_run ();
 }
@@ -0,0 +1,441 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "gdata.h"
+#include "common.h"
+
+static UhmServer *mock_server = NULL;
+
+/* The traces are hand-written, so there's nothing to check them against online */
+static gboolean
+skip_if_not_offline (void)
+{
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping test with a hand-written trace when online or logging.");
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* An authorizer which claims to be authorized for everything, since the Tasks API needs OAuth 2.0, which the tests can't authenticate against */
+#define TYPE_TEST_AUTHORIZER		(test_authorizer_get_type ())
+
+typedef struct {
+	GObject parent;
+} TestAuthorizer;
+
+typedef struct {
+	GObjectClass parent;
+} TestAuthorizerClass;
+
+static GType test_authorizer_get_type (void) G_GNUC_CONST;
+static void test_authorizer_authorizer_init (GDataAuthorizerInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestAuthorizer, test_authorizer, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_AUTHORIZER, test_authorizer_authorizer_init))
+
+static void
+test_authorizer_class_init (TestAuthorizerClass *klass)
+{
+	/* Nothing to see here */
+}
+
+static void
+test_authorizer_init (TestAuthorizer *self)
+{
+	/* Nothing to see here */
+}
+
+static void
+test_authorizer_process_request (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message)
+{
+	soup_message_headers_replace (message->request_headers, "Authorization", "Bearer token");
+}
+
+static gboolean
+test_authorizer_is_authorized_for_domain (GDataAuthorizer *self, GDataAuthorizationDomain *domain)
+{
+	return TRUE;
+}
+
+static void
+test_authorizer_authorizer_init (GDataAuthorizerInterface *iface)
+{
+	iface->process_request = test_authorizer_process_request;
+	iface->is_authorized_for_domain = test_authorizer_is_authorized_for_domain;
+}
+
+/* The results of a batch operation, as reported to its callback, indexed by the tasks' positions */
+typedef struct {
+	GDataTasksTask *results[3];
+	GError *errors[3];
+	guint n_callbacks;
+} BatchResults;
+
+static void
+batch_results_clear (BatchResults *results)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (results->results); i++) {
+		if (results->results[i] != NULL)
+			g_object_unref (results->results[i]);
+		g_clear_error (&(results->errors[i]));
+	}
+
+	memset (results, 0, sizeof (*results));
+}
+
+static void
+batch_cb (guint index, GDataTasksTask *task, GDataTasksTask *result, GError *error, BatchResults *results)
+{
+	g_assert (GDATA_IS_TASKS_TASK (task));
+	g_assert_cmpuint (index, <, G_N_ELEMENTS (results->results));
+	g_assert (results->results[index] == NULL && results->errors[index] == NULL);
+
+	results->results[index] = (result != NULL) ? g_object_ref (result) : NULL;
+	results->errors[index] = (error != NULL) ? g_error_copy (error) : NULL;
+	results->n_callbacks++;
+}
+
+static void
+test_batch (gconstpointer service)
+{
+	GDataTasksTasklist *tasklist;
+	GDataTasksTask *task1, *task2, *task3;
+	GList *tasks;
+	BatchResults results = { { NULL, }, };
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	tasklist = gdata_tasks_tasklist_new ("list-a");
+
+	gdata_test_mock_server_start_trace (mock_server, "batch");
+
+	/* Insert three tasks in one batch request. The server inserts the first, asks us to slow down for the second (which should then be retried
+	 * on its own) and rejects the third. */
+	task1 = gdata_tasks_task_new (NULL);
+	gdata_entry_set_title (GDATA_ENTRY (task1), "Buy milk");
+	task2 = gdata_tasks_task_new (NULL);
+	gdata_entry_set_title (GDATA_ENTRY (task2), "Post letter");
+	task3 = gdata_tasks_task_new (NULL);
+	gdata_entry_set_title (GDATA_ENTRY (task3), "");
+
+	tasks = g_list_prepend (NULL, task3);
+	tasks = g_list_prepend (tasks, task2);
+	tasks = g_list_prepend (tasks, task1);
+
+	g_assert (gdata_tasks_service_insert_tasks (GDATA_TASKS_SERVICE (service), tasks, tasklist, NULL, (GDataTasksServiceBatchCallback) batch_cb,
+	                                            &results, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_list_free_full (tasks, g_object_unref);
+
+	g_assert_cmpuint (results.n_callbacks, ==, 3);
+
+	g_assert_no_error (results.errors[0]);
+	g_assert (GDATA_IS_TASKS_TASK (results.results[0]));
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (results.results[0])), ==, "t1");
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (results.results[0])), ==, "Buy milk");
+
+	g_assert_no_error (results.errors[1]);
+	g_assert (GDATA_IS_TASKS_TASK (results.results[1]));
+	g_assert_cmpstr (gdata_entry_get_id (GDATA_ENTRY (results.results[1])), ==, "t2");
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (results.results[1])), ==, "Post letter");
+
+	g_assert_error (results.errors[2], GDATA_SERVICE_ERROR, GDATA_SERVICE_ERROR_PROTOCOL_ERROR);
+	g_assert (results.results[2] == NULL);
+
+	/* Delete the two inserted tasks. The batch endpoint isn't available this time, so they should each be deleted with their own request. */
+	tasks = g_list_prepend (NULL, g_object_ref (results.results[1]));
+	tasks = g_list_prepend (tasks, g_object_ref (results.results[0]));
+	batch_results_clear (&results);
+
+	g_assert (gdata_tasks_service_delete_tasks (GDATA_TASKS_SERVICE (service), tasks, NULL, (GDataTasksServiceBatchCallback) batch_cb,
+	                                            &results, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_list_free_full (tasks, g_object_unref);
+
+	/* Deletions have no results */
+	g_assert_cmpuint (results.n_callbacks, ==, 2);
+	g_assert_no_error (results.errors[0]);
+	g_assert (results.results[0] == NULL);
+	g_assert_no_error (results.errors[1]);
+	g_assert (results.results[1] == NULL);
+
+	batch_results_clear (&results);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (tasklist);
+}
+
+static void
+test_batch_empty (void)
+{
+	GDataTasksService *service;
+	GError *error = NULL;
+
+	/* Batching no tasks should succeed without making any requests */
+	service = gdata_tasks_service_new (NULL);
+
+	g_assert (gdata_tasks_service_update_tasks (service, NULL, NULL, NULL, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert (gdata_tasks_service_delete_tasks (service, NULL, NULL, NULL, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+
+	g_object_unref (service);
+}
+
+/* A synchronisation store which keeps the titles of each tasklist's tasks in a hash table */
+#define TYPE_TEST_TASKS_STORE		(test_tasks_store_get_type ())
+#define TEST_TASKS_STORE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), TYPE_TEST_TASKS_STORE, TestTasksStore))
+
+typedef struct {
+	GObject parent;
+	GHashTable *tasklists; /* tasklist ID → (task ID → title) */
+	guint n_resets;
+} TestTasksStore;
+
+typedef struct {
+	GObjectClass parent;
+} TestTasksStoreClass;
+
+static GType test_tasks_store_get_type (void) G_GNUC_CONST;
+static void test_tasks_store_sync_store_init (GDataTasksSyncStoreInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestTasksStore, test_tasks_store, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_TASKS_SYNC_STORE, test_tasks_store_sync_store_init))
+
+static void
+test_tasks_store_finalize (GObject *object)
+{
+	g_hash_table_unref (TEST_TASKS_STORE (object)->tasklists);
+
+	G_OBJECT_CLASS (test_tasks_store_parent_class)->finalize (object);
+}
+
+static void
+test_tasks_store_class_init (TestTasksStoreClass *klass)
+{
+	G_OBJECT_CLASS (klass)->finalize = test_tasks_store_finalize;
+}
+
+static void
+test_tasks_store_init (TestTasksStore *self)
+{
+	self->tasklists = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+}
+
+static gboolean
+test_tasks_store_reset_tasklist (GDataTasksSyncStore *self, GDataTasksTasklist *tasklist, GError **error)
+{
+	g_hash_table_replace (TEST_TASKS_STORE (self)->tasklists, g_strdup (gdata_entry_get_id (GDATA_ENTRY (tasklist))),
+	                      g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free));
+	TEST_TASKS_STORE (self)->n_resets++;
+
+	return TRUE;
+}
+
+static gboolean
+test_tasks_store_apply_task (GDataTasksSyncStore *self, GDataTasksTasklist *tasklist, GDataTasksTask *task, GError **error)
+{
+	GHashTable *tasks;
+
+	/* The tasklist must have been reset before it was first synchronised */
+	tasks = g_hash_table_lookup (TEST_TASKS_STORE (self)->tasklists, gdata_entry_get_id (GDATA_ENTRY (tasklist)));
+	g_assert (tasks != NULL);
+
+	g_hash_table_replace (tasks, g_strdup (gdata_entry_get_id (GDATA_ENTRY (task))), g_strdup (gdata_entry_get_title (GDATA_ENTRY (task))));
+
+	return TRUE;
+}
+
+static gboolean
+test_tasks_store_remove_task (GDataTasksSyncStore *self, GDataTasksTasklist *tasklist, const gchar *task_id, GError **error)
+{
+	GHashTable *tasks;
+
+	tasks = g_hash_table_lookup (TEST_TASKS_STORE (self)->tasklists, gdata_entry_get_id (GDATA_ENTRY (tasklist)));
+	g_assert (tasks != NULL);
+
+	g_hash_table_remove (tasks, task_id);
+
+	return TRUE;
+}
+
+static void
+test_tasks_store_sync_store_init (GDataTasksSyncStoreInterface *iface)
+{
+	iface->reset_tasklist = test_tasks_store_reset_tasklist;
+	iface->apply_task = test_tasks_store_apply_task;
+	iface->remove_task = test_tasks_store_remove_task;
+}
+
+static void
+async_ready_cb (GObject *source_object, GAsyncResult *async_result, GAsyncResult **async_result_out)
+{
+	*async_result_out = g_object_ref (async_result);
+}
+
+static void
+test_sync (gconstpointer service)
+{
+	TestTasksStore *store;
+	GDataTasksSync *sync;
+	GDataTasksTasklist *tasklist;
+	GAsyncResult *async_result = NULL;
+	GHashTable *tasks;
+	gchar *state;
+	guint n_changed, n_removed;
+	GError *error = NULL;
+
+	if (skip_if_not_offline () == TRUE)
+		return;
+
+	store = g_object_new (TYPE_TEST_TASKS_STORE, NULL);
+	tasklist = gdata_tasks_tasklist_new ("list-a");
+
+	sync = gdata_tasks_sync_new (GDATA_TASKS_SERVICE (service), GDATA_TASKS_SYNC_STORE (store));
+	gdata_tasks_sync_set_page_size (sync, 2);
+
+	gdata_test_mock_server_start_trace (mock_server, "sync");
+
+	/* The tasklist has never been synchronised, so it should be reset and fully downloaded, following the page token to the second page */
+	g_assert_cmpint (gdata_tasks_sync_get_watermark (sync, tasklist), ==, -1);
+
+	g_assert (gdata_tasks_sync_run (sync, tasklist, NULL, &n_changed, &n_removed, &error) == TRUE);
+	g_assert_no_error (error);
+	g_assert_cmpuint (n_changed, ==, 3);
+	g_assert_cmpuint (n_removed, ==, 0);
+	g_assert_cmpuint (store->n_resets, ==, 1);
+
+	tasks = g_hash_table_lookup (store->tasklists, "list-a");
+	g_assert_cmpuint (g_hash_table_size (tasks), ==, 3);
+	g_assert_cmpstr (g_hash_table_lookup (tasks, "t1"), ==, "Buy milk");
+	g_assert_cmpstr (g_hash_table_lookup (tasks, "t2"), ==, "Post letter");
+	g_assert_cmpstr (g_hash_table_lookup (tasks, "t3"), ==, "Water plants");
+
+	/* JSON feeds don't give the server's time, so the watermark is the latest update time of the tasks (2026-10-13T10:00:00Z) */
+	g_assert_cmpint (gdata_tasks_sync_get_watermark (sync, tasklist), ==, 1791885600);
+
+	/* Save the watermark and restore it into a new GDataTasksSync, as if resuming in a new process */
+	state = gdata_tasks_sync_save_state (sync);
+	g_object_unref (sync);
+
+	sync = gdata_tasks_sync_new (GDATA_TASKS_SERVICE (service), GDATA_TASKS_SYNC_STORE (store));
+	gdata_tasks_sync_set_page_size (sync, 2);
+
+	g_assert (gdata_tasks_sync_load_state (sync, "GDataTasksSync 1\nnot-a-number list-a\n", &error) == FALSE);
+	g_assert_error (error, GDATA_PARSER_ERROR, GDATA_PARSER_ERROR_PARSING_STRING);
+	g_clear_error (&error);
+	g_assert_cmpint (gdata_tasks_sync_get_watermark (sync, tasklist), ==, -1);
+
+	g_assert (gdata_tasks_sync_load_state (sync, state, &error) == TRUE);
+	g_assert_no_error (error);
+	g_free (state);
+
+	g_assert_cmpint (gdata_tasks_sync_get_watermark (sync, tasklist), ==, 1791885600);
+
+	/* Synchronising again (asynchronously) should only query for the changes since the watermark (less the clock skew margin), including the
+	 * deleted task, and shouldn't reset the tasklist */
+	gdata_tasks_sync_run_async (sync, tasklist, NULL, (GAsyncReadyCallback) async_ready_cb, &async_result);
+
+	while (async_result == NULL)
+		g_main_context_iteration (NULL, TRUE);
+
+	g_assert (gdata_tasks_sync_run_finish (sync, async_result, &n_changed, &n_removed, &error) == TRUE);
+	g_assert_no_error (error);
+	g_object_unref (async_result);
+
+	g_assert_cmpuint (n_changed, ==, 1);
+	g_assert_cmpuint (n_removed, ==, 1);
+	g_assert_cmpuint (store->n_resets, ==, 1);
+
+	tasks = g_hash_table_lookup (store->tasklists, "list-a");
+	g_assert_cmpuint (g_hash_table_size (tasks), ==, 2);
+	g_assert_cmpstr (g_hash_table_lookup (tasks, "t1"), ==, "Buy milk");
+	g_assert_cmpstr (g_hash_table_lookup (tasks, "t2"), ==, "Post letters");
+	g_assert (g_hash_table_lookup (tasks, "t3") == NULL);
+
+	g_assert_cmpint (gdata_tasks_sync_get_watermark (sync, tasklist), ==, 1791974400);
+
+	uhm_server_end_trace (mock_server);
+
+	g_object_unref (sync);
+	g_object_unref (tasklist);
+	g_object_unref (store);
+}
+
+static void
+mock_server_notify_resolver_cb (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	UhmServer *server;
+	UhmResolver *resolver;
+
+	server = UHM_SERVER (object);
+
+	/* Set up the expected domain names here. This should technically be split up between
+	 * the different unit test suites, but that's too much effort. */
+	resolver = uhm_server_get_resolver (server);
+
+	if (resolver != NULL) {
+		const gchar *ip_address = uhm_server_get_address (server);
+
+		uhm_resolver_add_A (resolver, "www.googleapis.com", ip_address);
+	}
+}
+
+int
+main (int argc, char *argv[])
+{
+	gint retval;
+	GDataAuthorizer *authorizer = NULL;
+	GDataService *service = NULL;
+	GFile *trace_directory;
+
+	gdata_test_init (argc, argv);
+
+	mock_server = gdata_test_get_mock_server ();
+	g_signal_connect (G_OBJECT (mock_server), "notify::resolver", (GCallback) mock_server_notify_resolver_cb, NULL);
+	trace_directory = g_file_new_for_path (TEST_FILE_DIR "traces/tasks");
+	uhm_server_set_trace_directory (mock_server, trace_directory);
+	g_object_unref (trace_directory);
+
+	authorizer = g_object_new (TYPE_TEST_AUTHORIZER, NULL);
+	service = GDATA_SERVICE (gdata_tasks_service_new (authorizer));
+
+	g_test_add_data_func ("/tasks/batch", service, test_batch);
+	g_test_add_func ("/tasks/batch/empty", test_batch_empty);
+	g_test_add_data_func ("/tasks/sync", service, test_sync);
+
+	retval = g_test_run ();
+
+	g_object_unref (service);
+	g_object_unref (authorizer);
+
+	return retval;
+}
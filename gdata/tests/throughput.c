@@ -0,0 +1,1420 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 8; tab-width: 8 -*- */
+/*
+ * GData Client
+ * Copyright (C) Philip Withnall 2014 <philip@tecnocode.co.uk>
+ *
+ * GData Client is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * GData Client is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GData Client.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * End-to-end synchronisation throughput benchmarks, driving GDataContactsSync, GDataCalendarSync and GDataDocumentsSync against a stateful mock of
+ * the Contacts, Calendar and Documents feeds.
+ *
+ * Unlike replay.c, the mock server doesn't answer from recorded traces: it holds an account of --entries contacts, events and documents, and builds
+ * each response from the account's current state. It implements the parts of the protocol which the synchronisation code relies on:
+ *  - start-index/max-results pagination with next links, and updated-min and showdeleted filtering;
+ *  - the Documents changes feed, with changestamps and removed entries;
+ *  - the Contacts batch endpoint, for updates, insertions, deletions and queries;
+ *  - an ETag for each page, answering If-None-Match with 304 Not Modified; and
+ *  - throttling, answering every --throttle-every'th GET with 503 Service Unavailable and a Retry-After header. Only GETs are throttled, as
+ *    libgdata never retries POSTs.
+ *
+ * Each workload runs --rounds measured rounds:
+ *  - full: a synchronisation of the whole account into an empty store;
+ *  - incremental: --changes server-side changes (roughly 80% updates, 10% insertions and 10% deletions), then a synchronisation of them into an
+ *    up-to-date store;
+ *  - batch-push: --changes contacts updated in a batch, then a synchronisation which pulls them back (both count towards the entries); and
+ *  - revalidate: a listing of every page of the account with #GDataQuery:page-cache-mode set to %GDATA_PAGE_CACHE_ETAGS, after an unmeasured
+ *    listing has remembered each page's ETag, so every page comes back as 304 Not Modified.
+ *
+ * Results are printed as one JSON object per line, in the same style as perf.c. entries_per_second is the number of entries synchronised (added,
+ * changed or removed in the store) per second of wall-clock time; requests_per_entry and bytes_per_entry (request and response bodies) come from the
+ * mock server. peak_rss_kib is the high-water mark of the process' resident set size during the measured rounds; it's reset before each workload
+ * where the kernel supports it, and it includes the mock server's copy of the account, which is in the same process.
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+#include <libxml/parser.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "gdata.h"
+#include "common.h"
+
+/* The account's clock starts at 2014-05-13T16:53:20Z, and is only moved on by changes to the account */
+#define MOCK_START_TIME 1400000000
+#define MOCK_ACCOUNT "libgdata.test@googlemail.com"
+
+#define CONTACTS_PATH "/m8/feeds/contacts/default/full"
+#define CONTACTS_BATCH_PATH "/m8/feeds/contacts/default/full/batch"
+#define CALENDARS_PATH "/calendar/feeds/default/owncalendars/full"
+#define EVENTS_PATH "/calendar/feeds/mock-calendar/private/full"
+#define DOCUMENTS_PATH "/feeds/default/private/full"
+#define CHANGES_PATH "/feeds/default/private/changes"
+
+#define ATOM_NAMESPACE "http://www.w3.org/2005/Atom"
+#define BATCH_NAMESPACE "http://schemas.google.com/gdata/batch"
+
+#define FEED_NAMESPACES \
+	"xmlns='" ATOM_NAMESPACE "' " \
+	"xmlns:app='http://www.w3.org/2007/app' " \
+	"xmlns:gd='http://schemas.google.com/g/2005' " \
+	"xmlns:gCal='http://schemas.google.com/gCal/2005' " \
+	"xmlns:gContact='http://schemas.google.com/contact/2008' " \
+	"xmlns:docs='http://schemas.google.com/docs/2007' " \
+	"xmlns:batch='" BATCH_NAMESPACE "' " \
+	"xmlns:openSearch='http://a9.com/-/spec/opensearch/1.1/'"
+
+/* Retries are immediate (the throttling responses say Retry-After: 0), so that the measurements are of libgdata rather than of waiting */
+#define MAX_RETRIES 3
+#define RETRY_DELAY_MS 1
+
+static gint n_account_entries = 10000;
+static gint n_changes = 100;
+static gint page_size = 250;
+static gint rounds = 3;
+static gint throttle_every = 50;
+static gchar *filter = NULL;
+
+static UhmServer *mock_server = NULL;
+
+/*
+ * Mock backend.
+ *
+ * The account holds an array of entries for each service, indexed by entry number, which is used in the entries' IDs. Deleted entries are kept as
+ * tombstones so that they can be reported to incremental synchronisations. Each change to an entry bumps its version (which is part of its ETag),
+ * stamps it with the account's clock, and gives it the next changestamp for its service; the changestamps index each service's change log, so the
+ * Documents changes feed can be served without sorting.
+ *
+ * The backend is accessed from the mock server's thread and (to make changes) from the main thread, so it's protected by a lock.
+ */
+typedef enum {
+	MOCK_CONTACTS = 0,
+	MOCK_CALENDAR,
+	MOCK_DOCUMENTS,
+	MOCK_N_SERVICES
+} MockService;
+
+typedef struct {
+	guint version;
+	gint64 updated;
+	gint64 changestamp;
+	gboolean deleted;
+} MockEntry;
+
+typedef struct {
+	guint n_requests;
+	guint n_not_modified;
+	guint n_throttled;
+	guint64 n_bytes; /* of request and response bodies */
+} MockStatistics;
+
+static struct {
+	GMutex mutex;
+	GArray *entries[MOCK_N_SERVICES]; /* of MockEntry */
+	GArray *changes[MOCK_N_SERVICES]; /* of guint entry numbers; the change with changestamp N is at N - 1 */
+	gint64 clock;
+	guint n_gets;
+	GRand *rand;
+	MockStatistics statistics;
+} backend;
+
+/* Records a change to entry @index of @service at the account's current time. Called with the backend lock held. */
+static void
+stamp_entry_unlocked (MockService service, guint index)
+{
+	MockEntry *entry = &g_array_index (backend.entries[service], MockEntry, index);
+
+	g_array_append_val (backend.changes[service], index);
+
+	entry->version++;
+	entry->updated = backend.clock;
+	entry->changestamp = backend.changes[service]->len;
+}
+
+/* Appends a new entry to @service, returning its index. Called with the backend lock held. */
+static guint
+insert_entry_unlocked (MockService service)
+{
+	MockEntry entry = { 0, };
+
+	g_array_append_val (backend.entries[service], entry);
+	stamp_entry_unlocked (service, backend.entries[service]->len - 1);
+
+	return backend.entries[service]->len - 1;
+}
+
+static void
+mock_backend_reset (guint n_entries)
+{
+	guint i, j;
+
+	g_mutex_lock (&backend.mutex);
+
+	if (backend.rand != NULL)
+		g_rand_free (backend.rand);
+	backend.rand = g_rand_new_with_seed (n_entries); /* so that runs with the same options make the same changes */
+
+	backend.clock = MOCK_START_TIME;
+	backend.n_gets = 0;
+	memset (&backend.statistics, 0, sizeof (backend.statistics));
+
+	for (i = 0; i < MOCK_N_SERVICES; i++) {
+		if (backend.entries[i] != NULL)
+			g_array_free (backend.entries[i], TRUE);
+		if (backend.changes[i] != NULL)
+			g_array_free (backend.changes[i], TRUE);
+
+		backend.entries[i] = g_array_sized_new (FALSE, FALSE, sizeof (MockEntry), n_entries);
+		backend.changes[i] = g_array_sized_new (FALSE, FALSE, sizeof (guint), n_entries);
+
+		for (j = 0; j < n_entries; j++)
+			insert_entry_unlocked (i);
+	}
+
+	/* Move the clock on, so that synchronisations watermarked from now on don't see the initial entries as changed */
+	backend.clock++;
+
+	g_mutex_unlock (&backend.mutex);
+}
+
+/* Makes @n changes to @service: roughly 80% updates, 10% insertions and 10% deletions of random entries. */
+static void
+mock_backend_make_changes (MockService service, guint n)
+{
+	GArray *entries = backend.entries[service];
+	guint i;
+
+	g_mutex_lock (&backend.mutex);
+
+	backend.clock++;
+
+	for (i = 0; i < n; i++) {
+		gint32 choice = g_rand_int_range (backend.rand, 0, 10);
+		MockEntry *entry = NULL;
+		guint index = 0, attempt;
+
+		if (choice == 0) {
+			insert_entry_unlocked (service);
+			continue;
+		}
+
+		/* Pick an entry which hasn't already been deleted */
+		for (attempt = 0; attempt < 16 && (entry == NULL || entry->deleted == TRUE); attempt++) {
+			index = g_rand_int_range (backend.rand, 0, entries->len);
+			entry = &g_array_index (entries, MockEntry, index);
+		}
+
+		if (entry->deleted == TRUE)
+			continue;
+
+		entry->deleted = (choice == 1) ? TRUE : FALSE;
+		stamp_entry_unlocked (service, index);
+	}
+
+	backend.clock++;
+
+	g_mutex_unlock (&backend.mutex);
+}
+
+static guint
+mock_backend_count_live_entries (MockService service)
+{
+	guint i, n_live = 0;
+
+	g_mutex_lock (&backend.mutex);
+
+	for (i = 0; i < backend.entries[service]->len; i++) {
+		if (g_array_index (backend.entries[service], MockEntry, i).deleted == FALSE)
+			n_live++;
+	}
+
+	g_mutex_unlock (&backend.mutex);
+
+	return n_live;
+}
+
+static void
+mock_backend_get_statistics (MockStatistics *statistics)
+{
+	g_mutex_lock (&backend.mutex);
+	*statistics = backend.statistics;
+	g_mutex_unlock (&backend.mutex);
+}
+
+static gchar *
+format_time (gint64 time)
+{
+	GDateTime *date_time;
+	gchar *formatted;
+
+	date_time = g_date_time_new_from_unix_utc (time);
+	formatted = g_date_time_format (date_time, "%Y-%m-%dT%H:%M:%S.000Z");
+	g_date_time_unref (date_time);
+
+	return formatted;
+}
+
+/* Appends entry @index of @service to @body. Changestamps are only included if @with_changestamp is set, as in the Documents changes feed. @extra
+ * is appended inside the entry, for batch responses. */
+static void
+append_entry (GString *body, MockService service, guint index, const MockEntry *entry, gboolean with_changestamp, const gchar *extra)
+{
+	gchar *updated;
+
+	updated = format_time (entry->updated);
+
+	g_string_append_printf (body, "<entry gd:etag='\"mock-%u-%u\"'>", index, entry->version);
+
+	switch (service) {
+		case MOCK_CONTACTS:
+			g_string_append_printf (body,
+				"<id>http://www.google.com/m8/feeds/contacts/" MOCK_ACCOUNT "/base/%u</id>"
+				"<updated>%s</updated>"
+				"<app:edited>%s</app:edited>"
+				"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/contact/2008#contact'/>",
+				index, updated, updated);
+
+			if (entry->deleted == TRUE) {
+				g_string_append (body, "<gd:deleted/>");
+				break;
+			}
+
+			g_string_append_printf (body,
+				"<title>Contact %u</title>"
+				"<content type='text'>Notes about contact %u.</content>"
+				"<link rel='self' type='application/atom+xml' href='https://www.google.com/m8/feeds/contacts/default/full/%u'/>"
+				"<link rel='edit' type='application/atom+xml' href='https://www.google.com/m8/feeds/contacts/default/full/%u/%u'/>"
+				"<gd:name><gd:givenName>Contact</gd:givenName><gd:familyName>%u</gd:familyName>"
+				"<gd:fullName>Contact %u</gd:fullName></gd:name>"
+				"<gd:email rel='http://schemas.google.com/g/2005#work' address='contact%u@example.com' primary='true'/>"
+				"<gd:phoneNumber rel='http://schemas.google.com/g/2005#work'>(206)555-%04u</gd:phoneNumber>"
+				"<gd:structuredPostalAddress rel='http://schemas.google.com/g/2005#work'>"
+					"<gd:street>1600 Amphitheatre Parkway</gd:street><gd:city>Mountain View</gd:city><gd:postcode>94043</gd:postcode>"
+				"</gd:structuredPostalAddress>"
+				"<gd:organization rel='http://schemas.google.com/g/2005#work'><gd:orgName>Example Corp.</gd:orgName></gd:organization>",
+				index, index, index, index, entry->version, index, index, index, index % 10000);
+			break;
+		case MOCK_CALENDAR:
+			g_string_append_printf (body,
+				"<id>http://www.google.com/calendar/feeds/mock-calendar/events/%u</id>"
+				"<published>2014-01-01T09:00:00.000Z</published>"
+				"<updated>%s</updated>"
+				"<app:edited>%s</app:edited>"
+				"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/g/2005#event'/>"
+				"<title>Event %u</title>"
+				"<content type='text'>Details of event %u.</content>"
+				"<link rel='self' type='application/atom+xml' href='https://www.google.com/calendar/feeds/mock-calendar/private/full/%u'/>"
+				"<link rel='edit' type='application/atom+xml' href='https://www.google.com/calendar/feeds/mock-calendar/private/full/%u/%u'/>"
+				"<gd:eventStatus value='http://schemas.google.com/g/2005#event.%s'/>"
+				"<gd:visibility value='http://schemas.google.com/g/2005#event.default'/>"
+				"<gd:transparency value='http://schemas.google.com/g/2005#event.opaque'/>"
+				"<gd:where valueString='Meeting room %u'/>"
+				"<gd:who email='" MOCK_ACCOUNT "' rel='http://schemas.google.com/g/2005#event.organizer' valueString='GData Test'/>"
+				"<gd:when startTime='2014-06-01T15:00:00.000Z' endTime='2014-06-01T16:00:00.000Z'/>"
+				"<gCal:sequence value='%u'/>"
+				"<gCal:uid value='mock-event-%u@google.com'/>",
+				index, updated, updated, index, index, index, index, entry->version, (entry->deleted == TRUE) ? "canceled" : "confirmed",
+				index % 100, entry->version, index);
+			break;
+		case MOCK_DOCUMENTS:
+			g_string_append_printf (body,
+				"<id>https://docs.google.com/feeds/id/document%%3A%u</id>"
+				"<updated>%s</updated>"
+				"<app:edited>%s</app:edited>"
+				"<gd:resourceId>document:%u</gd:resourceId>",
+				index, updated, updated, index);
+
+			if (with_changestamp == TRUE)
+				g_string_append_printf (body, "<docs:changestamp value='%" G_GINT64_FORMAT "'/>", entry->changestamp);
+
+			/* Removed entries carry nothing but their resource ID and changestamp */
+			if (entry->deleted == TRUE) {
+				g_string_append (body, "<docs:removed/>");
+				break;
+			}
+
+			g_string_append_printf (body,
+				"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/docs/2007#document' "
+				          "label='document'/>"
+				"<title>Document %u</title>"
+				"<content type='text/html' src='https://docs.google.com/feeds/download/documents/export/Export?id=%u'/>"
+				"<link rel='self' type='application/atom+xml' href='https://docs.google.com/feeds/default/private/full/document%%3A%u'/>"
+				"<link rel='edit' type='application/atom+xml' href='https://docs.google.com/feeds/default/private/full/document%%3A%u/%u'/>"
+				"<author><name>GData Test</name><email>" MOCK_ACCOUNT "</email></author>"
+				"<gd:lastModifiedBy><name>GData Test</name><email>" MOCK_ACCOUNT "</email></gd:lastModifiedBy>"
+				"<docs:writersCanInvite value='true'/>",
+				index, index, index, index, entry->version);
+			break;
+		case MOCK_N_SERVICES:
+		default:
+			g_assert_not_reached ();
+	}
+
+	if (extra != NULL)
+		g_string_append (body, extra);
+
+	g_string_append (body, "</entry>");
+
+	g_free (updated);
+}
+
+static void
+append_feed_header (GString *body, const gchar *feed_uri, const gchar *etag)
+{
+	gchar *updated;
+
+	updated = format_time (backend.clock);
+	g_string_append_printf (body,
+		"<?xml version='1.0' encoding='UTF-8'?>"
+		"<feed " FEED_NAMESPACES " gd:etag='%s'>"
+		"<id>%s</id>"
+		"<updated>%s</updated>"
+		"<title type='text'>Benchmark feed</title>"
+		"<link rel='self' type='application/atom+xml' href='%s'/>"
+		"<author><name>GData Test</name><email>" MOCK_ACCOUNT "</email></author>",
+		etag, feed_uri, updated, feed_uri);
+	g_free (updated);
+}
+
+static gint64
+get_integer_parameter (GHashTable *parameters, const gchar *name, gint64 default_value)
+{
+	const gchar *value = g_hash_table_lookup (parameters, name);
+	return (value != NULL) ? g_ascii_strtoll (value, NULL, 10) : default_value;
+}
+
+/* Builds the XML-escaped URI of @feed_uri with @parameters, but with start-index replaced by @start_index */
+static gchar *
+build_next_uri (const gchar *feed_uri, GHashTable *parameters, gint64 start_index)
+{
+	GHashTable *next_parameters;
+	GHashTableIter iter;
+	gpointer name, value;
+	gchar *start_index_string, *query, *uri, *escaped_uri;
+
+	next_parameters = g_hash_table_new (g_str_hash, g_str_equal);
+
+	g_hash_table_iter_init (&iter, parameters);
+	while (g_hash_table_iter_next (&iter, &name, &value) == TRUE)
+		g_hash_table_insert (next_parameters, name, value);
+
+	start_index_string = g_strdup_printf ("%" G_GINT64_FORMAT, start_index);
+	g_hash_table_insert (next_parameters, (gpointer) "start-index", start_index_string);
+
+	query = soup_form_encode_hash (next_parameters);
+	uri = g_strconcat (feed_uri, "?", query, NULL);
+	escaped_uri = g_markup_escape_text (uri, -1);
+
+	g_free (uri);
+	g_free (query);
+	g_free (start_index_string);
+	g_hash_table_destroy (next_parameters);
+
+	return escaped_uri;
+}
+
+/* Builds the page of @service's feed (or its changes feed, if @changes is set) which @parameters ask for. The page's ETag is returned in @etag; if
+ * it matches @if_none_match, %NULL is returned instead of the page. Called with the backend lock held. */
+static GString *
+build_feed_page_unlocked (MockService service, gboolean changes, const gchar *feed_uri, GHashTable *parameters, const gchar *if_none_match,
+                          gchar **etag)
+{
+	GArray *entries = backend.entries[service];
+	GArray *page;
+	GChecksum *checksum;
+	GString *body;
+	gint64 start_index, max_results, updated_min = -1, next_start_index = -1;
+	gboolean show_deleted;
+	const gchar *updated_min_string;
+	guint i;
+
+	start_index = MAX (get_integer_parameter (parameters, "start-index", 1), 1);
+	max_results = get_integer_parameter (parameters, "max-results", 25);
+	show_deleted = (g_strcmp0 (g_hash_table_lookup (parameters, "showdeleted"), "true") == 0 && service != MOCK_DOCUMENTS);
+
+	updated_min_string = g_hash_table_lookup (parameters, "updated-min");
+	if (updated_min_string != NULL) {
+		GTimeVal time_val;
+
+		if (g_time_val_from_iso8601 (updated_min_string, &time_val) == TRUE)
+			updated_min = time_val.tv_sec;
+	}
+
+	/* Pick out the entries on the page */
+	page = g_array_sized_new (FALSE, FALSE, sizeof (guint), MIN (max_results, (gint64) entries->len));
+
+	if (changes == TRUE) {
+		/* The changes feed's start-index is a changestamp; superseded changes are skipped */
+		GArray *log = backend.changes[service];
+
+		for (i = start_index - 1; i < log->len; i++) {
+			guint index = g_array_index (log, guint, i);
+
+			if (g_array_index (entries, MockEntry, index).changestamp != i + 1)
+				continue;
+
+			if ((gint64) page->len == max_results) {
+				next_start_index = i + 1;
+				break;
+			}
+
+			g_array_append_val (page, index);
+		}
+	} else {
+		gint64 n_matches = 0;
+
+		for (i = 0; i < entries->len; i++) {
+			const MockEntry *entry = &g_array_index (entries, MockEntry, i);
+
+			if ((entry->deleted == TRUE && show_deleted == FALSE) || entry->updated < updated_min)
+				continue;
+
+			n_matches++;
+			if (n_matches < start_index)
+				continue;
+
+			if ((gint64) page->len == max_results) {
+				next_start_index = start_index + max_results;
+				break;
+			}
+
+			g_array_append_val (page, i);
+		}
+	}
+
+	/* The page's ETag covers the versions of its entries, and whether there's a next page */
+	checksum = g_checksum_new (G_CHECKSUM_SHA1);
+	for (i = 0; i < page->len; i++) {
+		guint index = g_array_index (page, guint, i);
+		const MockEntry *entry = &g_array_index (entries, MockEntry, index);
+		guint data[3] = { index, entry->version, entry->deleted };
+
+		g_checksum_update (checksum, (const guchar*) data, sizeof (data));
+	}
+	g_checksum_update (checksum, (const guchar*) &next_start_index, sizeof (next_start_index));
+
+	*etag = g_strdup_printf ("\"%s\"", g_checksum_get_string (checksum));
+	g_checksum_free (checksum);
+
+	if (if_none_match != NULL && strcmp (if_none_match, *etag) == 0) {
+		g_array_free (page, TRUE);
+		return NULL;
+	}
+
+	/* Build the page */
+	body = g_string_sized_new (1024 + page->len * 2048);
+	append_feed_header (body, feed_uri, *etag);
+	g_string_append_printf (body,
+		"<openSearch:startIndex>%" G_GINT64_FORMAT "</openSearch:startIndex>"
+		"<openSearch:itemsPerPage>%" G_GINT64_FORMAT "</openSearch:itemsPerPage>",
+		start_index, max_results);
+
+	if (changes == TRUE)
+		g_string_append_printf (body, "<docs:largestChangestamp value='%u'/>", backend.changes[service]->len);
+
+	if (next_start_index != -1) {
+		gchar *next_uri = build_next_uri (feed_uri, parameters, next_start_index);
+		g_string_append_printf (body, "<link rel='next' type='application/atom+xml' href='%s'/>", next_uri);
+		g_free (next_uri);
+	}
+
+	for (i = 0; i < page->len; i++) {
+		guint index = g_array_index (page, guint, i);
+		append_entry (body, service, index, &g_array_index (entries, MockEntry, index), changes, NULL);
+	}
+
+	g_string_append (body, "</feed>");
+
+	g_array_free (page, TRUE);
+
+	return body;
+}
+
+/* The account has a single calendar, whose events are in the events feed */
+static GString *
+build_calendars_feed_unlocked (const gchar *feed_uri)
+{
+	GString *body;
+	gchar *updated;
+
+	updated = format_time (backend.clock);
+
+	body = g_string_new (NULL);
+	append_feed_header (body, feed_uri, "\"mock-calendars\"");
+	g_string_append_printf (body,
+		"<entry gd:etag='\"mock-calendar\"'>"
+			"<id>http://www.google.com/calendar/feeds/default/calendars/mock-calendar</id>"
+			"<updated>%s</updated>"
+			"<app:edited>%s</app:edited>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://schemas.google.com/gCal/2005#calendarmeta'/>"
+			"<title>Benchmark calendar</title>"
+			"<content type='application/atom+xml' src='https://www.google.com" EVENTS_PATH "'/>"
+			"<link rel='alternate' type='application/atom+xml' href='https://www.google.com" EVENTS_PATH "'/>"
+			"<link rel='self' type='application/atom+xml' "
+			      "href='https://www.google.com/calendar/feeds/default/owncalendars/full/mock-calendar'/>"
+			"<author><name>GData Test</name><email>" MOCK_ACCOUNT "</email></author>"
+			"<gCal:timezone value='UTC'/>"
+			"<gCal:timesCleaned value='0'/>"
+			"<gCal:hidden value='false'/>"
+			"<gCal:color value='#2952A3'/>"
+			"<gCal:selected value='true'/>"
+			"<gCal:accesslevel value='owner'/>"
+		"</entry>"
+		"</feed>",
+		updated, updated);
+
+	g_free (updated);
+
+	return body;
+}
+
+static xmlChar *
+get_child_content (xmlNode *node, const gchar *namespace, const gchar *name)
+{
+	xmlNode *child;
+
+	for (child = node->children; child != NULL; child = child->next) {
+		if (child->type == XML_ELEMENT_NODE && child->ns != NULL && xmlStrcmp (child->ns->href, (xmlChar*) namespace) == 0 &&
+		    xmlStrcmp (child->name, (xmlChar*) name) == 0) {
+			return xmlNodeGetContent (child);
+		}
+	}
+
+	return NULL;
+}
+
+static xmlChar *
+get_batch_operation_type (xmlNode *node)
+{
+	xmlNode *child;
+
+	for (child = node->children; child != NULL; child = child->next) {
+		if (child->type == XML_ELEMENT_NODE && child->ns != NULL && xmlStrcmp (child->ns->href, (xmlChar*) BATCH_NAMESPACE) == 0 &&
+		    xmlStrcmp (child->name, (xmlChar*) "operation") == 0) {
+			return xmlGetProp (child, (xmlChar*) "type");
+		}
+	}
+
+	return NULL;
+}
+
+/* Applies a Contacts batch request, returning the batch response, or %NULL if the request can't be parsed. Each contact is identified by the
+ * number at the end of its ID; the rest of the request entry is ignored. Called with the backend lock held. */
+static GString *
+handle_batch_unlocked (SoupMessage *message)
+{
+	GArray *entries = backend.entries[MOCK_CONTACTS];
+	xmlDoc *doc;
+	xmlNode *root, *node;
+	GString *body;
+
+	doc = xmlReadMemory (message->request_body->data, message->request_body->length, "batch.xml", NULL, XML_PARSE_NONET);
+	if (doc == NULL)
+		return NULL;
+
+	root = xmlDocGetRootElement (doc);
+	if (root == NULL) {
+		xmlFreeDoc (doc);
+		return NULL;
+	}
+
+	backend.clock++;
+
+	body = g_string_new (NULL);
+	append_feed_header (body, "https://www.google.com" CONTACTS_BATCH_PATH, "\"mock-batch\"");
+
+	for (node = root->children; node != NULL; node = node->next) {
+		xmlChar *id, *batch_id, *type;
+		const gchar *last_slash;
+		gchar *extra, *escaped_id;
+		guint index = G_MAXUINT;
+
+		if (node->type != XML_ELEMENT_NODE || xmlStrcmp (node->name, (xmlChar*) "entry") != 0)
+			continue;
+
+		id = get_child_content (node, ATOM_NAMESPACE, "id");
+		batch_id = get_child_content (node, BATCH_NAMESPACE, "id");
+		type = get_batch_operation_type (node);
+
+		if (id != NULL && (last_slash = strrchr ((const gchar*) id, '/')) != NULL)
+			index = strtoul (last_slash + 1, NULL, 10);
+
+		if (type != NULL && xmlStrcmp (type, (xmlChar*) "insert") == 0) {
+			index = insert_entry_unlocked (MOCK_CONTACTS);
+
+			extra = g_strdup_printf ("<batch:id>%s</batch:id><batch:operation type='insert'/><batch:status code='201' reason='Created'/>",
+			                         (batch_id != NULL) ? (const gchar*) batch_id : "0");
+			append_entry (body, MOCK_CONTACTS, index, &g_array_index (entries, MockEntry, index), FALSE, extra);
+		} else if (type == NULL || index >= entries->len || g_array_index (entries, MockEntry, index).deleted == TRUE) {
+			escaped_id = g_markup_escape_text ((id != NULL) ? (const gchar*) id : "", -1);
+			g_string_append_printf (body,
+				"<entry><id>%s</id><batch:id>%s</batch:id><batch:operation type='%s'/>"
+				"<batch:status code='404' reason='Not Found'/></entry>",
+				escaped_id, (batch_id != NULL) ? (const gchar*) batch_id : "0", (type != NULL) ? (const gchar*) type : "query");
+			g_free (escaped_id);
+			extra = NULL;
+		} else {
+			if (xmlStrcmp (type, (xmlChar*) "update") == 0) {
+				stamp_entry_unlocked (MOCK_CONTACTS, index);
+			} else if (xmlStrcmp (type, (xmlChar*) "delete") == 0) {
+				g_array_index (entries, MockEntry, index).deleted = TRUE;
+				stamp_entry_unlocked (MOCK_CONTACTS, index);
+			}
+
+			extra = g_strdup_printf ("<batch:id>%s</batch:id><batch:operation type='%s'/><batch:status code='200' reason='Success'/>",
+			                         (batch_id != NULL) ? (const gchar*) batch_id : "0", (const gchar*) type);
+			append_entry (body, MOCK_CONTACTS, index, &g_array_index (entries, MockEntry, index), FALSE, extra);
+		}
+
+		g_free (extra);
+		xmlFree (type);
+		xmlFree (batch_id);
+		xmlFree (id);
+	}
+
+	g_string_append (body, "</feed>");
+
+	backend.clock++;
+
+	xmlFreeDoc (doc);
+
+	return body;
+}
+
+static gboolean
+server_handle_message_cb (UhmServer *server, SoupMessage *message, SoupClientContext *client, gpointer user_data)
+{
+	SoupURI *uri;
+	const gchar *path, *if_none_match;
+	GHashTable *parameters;
+	GString *body = NULL;
+	gchar *feed_uri, *etag = NULL;
+	guint status_code = SOUP_STATUS_OK;
+
+	uri = soup_message_get_uri (message);
+	path = soup_uri_get_path (uri);
+	feed_uri = g_strdup_printf ("https://%s%s", soup_uri_get_host (uri), path);
+
+	if (soup_uri_get_query (uri) != NULL)
+		parameters = soup_form_decode (soup_uri_get_query (uri));
+	else
+		parameters = g_hash_table_new (g_str_hash, g_str_equal);
+
+	if_none_match = soup_message_headers_get_one (message->request_headers, "If-None-Match");
+
+	g_mutex_lock (&backend.mutex);
+
+	backend.statistics.n_requests++;
+	backend.statistics.n_bytes += message->request_body->length;
+
+	if (message->method == SOUP_METHOD_GET && throttle_every > 0 && ++backend.n_gets % throttle_every == 0) {
+		/* libgdata retries the request after the Retry-After delay */
+		backend.statistics.n_throttled++;
+		status_code = SOUP_STATUS_SERVICE_UNAVAILABLE;
+		soup_message_headers_replace (message->response_headers, "Retry-After", "0");
+	} else if (message->method == SOUP_METHOD_POST && strcmp (path, CONTACTS_BATCH_PATH) == 0) {
+		body = handle_batch_unlocked (message);
+		if (body == NULL)
+			status_code = SOUP_STATUS_BAD_REQUEST;
+	} else if (message->method == SOUP_METHOD_GET) {
+		if (strcmp (path, CONTACTS_PATH) == 0)
+			body = build_feed_page_unlocked (MOCK_CONTACTS, FALSE, feed_uri, parameters, if_none_match, &etag);
+		else if (strcmp (path, CALENDARS_PATH) == 0)
+			body = build_calendars_feed_unlocked (feed_uri);
+		else if (strcmp (path, EVENTS_PATH) == 0)
+			body = build_feed_page_unlocked (MOCK_CALENDAR, FALSE, feed_uri, parameters, if_none_match, &etag);
+		else if (strcmp (path, DOCUMENTS_PATH) == 0)
+			body = build_feed_page_unlocked (MOCK_DOCUMENTS, FALSE, feed_uri, parameters, if_none_match, &etag);
+		else if (strcmp (path, CHANGES_PATH) == 0)
+			body = build_feed_page_unlocked (MOCK_DOCUMENTS, TRUE, feed_uri, parameters, if_none_match, &etag);
+		else
+			status_code = SOUP_STATUS_NOT_FOUND;
+
+		if (status_code == SOUP_STATUS_OK && body == NULL) {
+			backend.statistics.n_not_modified++;
+			status_code = SOUP_STATUS_NOT_MODIFIED;
+		}
+	} else {
+		status_code = SOUP_STATUS_METHOD_NOT_ALLOWED;
+	}
+
+	if (body != NULL)
+		backend.statistics.n_bytes += body->len;
+
+	g_mutex_unlock (&backend.mutex);
+
+	soup_message_set_status (message, status_code);
+
+	if (etag != NULL)
+		soup_message_headers_replace (message->response_headers, "ETag", etag);
+
+	if (body != NULL) {
+		gsize length = body->len;
+		soup_message_set_response (message, "application/atom+xml; charset=UTF-8", SOUP_MEMORY_TAKE, g_string_free (body, FALSE), length);
+	}
+
+	g_free (etag);
+	g_hash_table_destroy (parameters);
+	g_free (feed_uri);
+
+	return TRUE;
+}
+
+/*
+ * Client side.
+ *
+ * Requests are authorised by a fake authorizer, and synchronised into a store which keeps every entry in memory, keyed by ID (or by resource ID for
+ * documents), as a real application's store would keep them in its database.
+ */
+#define TYPE_MOCK_AUTHORIZER		(mock_authorizer_get_type ())
+
+typedef struct {
+	GObject parent;
+} MockAuthorizer;
+
+typedef struct {
+	GObjectClass parent;
+} MockAuthorizerClass;
+
+static GType mock_authorizer_get_type (void) G_GNUC_CONST;
+static void mock_authorizer_authorizer_init (GDataAuthorizerInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (MockAuthorizer, mock_authorizer, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_AUTHORIZER, mock_authorizer_authorizer_init))
+
+static void
+mock_authorizer_class_init (MockAuthorizerClass *klass)
+{
+	/* Nothing to see here */
+}
+
+static void
+mock_authorizer_init (MockAuthorizer *self)
+{
+	/* Nothing to see here */
+}
+
+static void
+mock_authorizer_process_request (GDataAuthorizer *self, GDataAuthorizationDomain *domain, SoupMessage *message)
+{
+	soup_message_headers_replace (message->request_headers, "Authorization", "Bearer mock-token");
+}
+
+static gboolean
+mock_authorizer_is_authorized_for_domain (GDataAuthorizer *self, GDataAuthorizationDomain *domain)
+{
+	return TRUE;
+}
+
+static void
+mock_authorizer_authorizer_init (GDataAuthorizerInterface *iface)
+{
+	iface->process_request = mock_authorizer_process_request;
+	iface->is_authorized_for_domain = mock_authorizer_is_authorized_for_domain;
+}
+
+#define TYPE_BENCHMARK_STORE		(benchmark_store_get_type ())
+#define BENCHMARK_STORE(o)		(G_TYPE_CHECK_INSTANCE_CAST ((o), TYPE_BENCHMARK_STORE, BenchmarkStore))
+
+typedef struct {
+	GObject parent;
+	GHashTable *entries; /* entry ID or resource ID → owned GDataEntry */
+	gint64 watermark; /* or changestamp, for documents */
+} BenchmarkStore;
+
+typedef struct {
+	GObjectClass parent;
+} BenchmarkStoreClass;
+
+static GType benchmark_store_get_type (void) G_GNUC_CONST;
+static void benchmark_store_contacts_sync_store_init (GDataContactsSyncStoreInterface *iface);
+static void benchmark_store_calendar_sync_store_init (GDataCalendarSyncStoreInterface *iface);
+static void benchmark_store_documents_sync_store_init (GDataDocumentsSyncStoreInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (BenchmarkStore, benchmark_store, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_CONTACTS_SYNC_STORE, benchmark_store_contacts_sync_store_init)
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_CALENDAR_SYNC_STORE, benchmark_store_calendar_sync_store_init)
+                         G_IMPLEMENT_INTERFACE (GDATA_TYPE_DOCUMENTS_SYNC_STORE, benchmark_store_documents_sync_store_init))
+
+static void
+benchmark_store_finalize (GObject *object)
+{
+	g_hash_table_destroy (BENCHMARK_STORE (object)->entries);
+
+	/* Chain up to the parent class */
+	G_OBJECT_CLASS (benchmark_store_parent_class)->finalize (object);
+}
+
+static void
+benchmark_store_class_init (BenchmarkStoreClass *klass)
+{
+	GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+	gobject_class->finalize = benchmark_store_finalize;
+}
+
+static void
+benchmark_store_init (BenchmarkStore *self)
+{
+	self->entries = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+	self->watermark = -1;
+}
+
+static gint64
+benchmark_store_get_watermark (GDataContactsSyncStore *self)
+{
+	return BENCHMARK_STORE (self)->watermark;
+}
+
+static gboolean
+benchmark_store_set_watermark (GDataContactsSyncStore *self, gint64 watermark, GError **error)
+{
+	BENCHMARK_STORE (self)->watermark = watermark;
+	return TRUE;
+}
+
+static gboolean
+benchmark_store_apply_contact (GDataContactsSyncStore *self, GDataContactsContact *contact, GError **error)
+{
+	g_hash_table_replace (BENCHMARK_STORE (self)->entries, g_strdup (gdata_entry_get_id (GDATA_ENTRY (contact))), g_object_ref (contact));
+	return TRUE;
+}
+
+static gboolean
+benchmark_store_remove_contact (GDataContactsSyncStore *self, const gchar *contact_id, GError **error)
+{
+	g_hash_table_remove (BENCHMARK_STORE (self)->entries, contact_id);
+	return TRUE;
+}
+
+static void
+benchmark_store_contacts_sync_store_init (GDataContactsSyncStoreInterface *iface)
+{
+	iface->get_watermark = benchmark_store_get_watermark;
+	iface->set_watermark = benchmark_store_set_watermark;
+	iface->apply_contact = benchmark_store_apply_contact;
+	iface->remove_contact = benchmark_store_remove_contact;
+}
+
+static gboolean
+benchmark_store_reset_calendar (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GError **error)
+{
+	g_hash_table_remove_all (BENCHMARK_STORE (self)->entries);
+	return TRUE;
+}
+
+static gboolean
+benchmark_store_apply_event (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, GDataCalendarEvent *event, GError **error)
+{
+	g_hash_table_replace (BENCHMARK_STORE (self)->entries, g_strdup (gdata_entry_get_id (GDATA_ENTRY (event))), g_object_ref (event));
+	return TRUE;
+}
+
+static gboolean
+benchmark_store_remove_event (GDataCalendarSyncStore *self, GDataCalendarCalendar *calendar, const gchar *event_id, GError **error)
+{
+	g_hash_table_remove (BENCHMARK_STORE (self)->entries, event_id);
+	return TRUE;
+}
+
+static void
+benchmark_store_calendar_sync_store_init (GDataCalendarSyncStoreInterface *iface)
+{
+	iface->reset_calendar = benchmark_store_reset_calendar;
+	iface->apply_event = benchmark_store_apply_event;
+	iface->remove_event = benchmark_store_remove_event;
+}
+
+static gint64
+benchmark_store_get_changestamp (GDataDocumentsSyncStore *self)
+{
+	return BENCHMARK_STORE (self)->watermark;
+}
+
+static gboolean
+benchmark_store_set_changestamp (GDataDocumentsSyncStore *self, gint64 changestamp, GError **error)
+{
+	BENCHMARK_STORE (self)->watermark = changestamp;
+	return TRUE;
+}
+
+static gboolean
+benchmark_store_apply_entry (GDataDocumentsSyncStore *self, GDataDocumentsEntry *entry, GError **error)
+{
+	g_hash_table_replace (BENCHMARK_STORE (self)->entries, g_strdup (gdata_documents_entry_get_resource_id (entry)), g_object_ref (entry));
+	return TRUE;
+}
+
+static gboolean
+benchmark_store_remove_entry (GDataDocumentsSyncStore *self, const gchar *resource_id, GError **error)
+{
+	g_hash_table_remove (BENCHMARK_STORE (self)->entries, resource_id);
+	return TRUE;
+}
+
+static void
+benchmark_store_documents_sync_store_init (GDataDocumentsSyncStoreInterface *iface)
+{
+	iface->get_changestamp = benchmark_store_get_changestamp;
+	iface->set_changestamp = benchmark_store_set_changestamp;
+	iface->apply_entry = benchmark_store_apply_entry;
+	iface->remove_entry = benchmark_store_remove_entry;
+}
+
+typedef struct {
+	MockService service_type;
+	GDataService *service;
+	GDataCalendarCalendar *calendar; /* only for MOCK_CALENDAR */
+	BenchmarkStore *store;
+	GObject *sync;
+} SyncContext;
+
+/* Replaces the context's store and synchroniser with new ones, so that the next synchronisation is a full one */
+static void
+sync_context_reset (SyncContext *context)
+{
+	if (context->sync != NULL)
+		g_object_unref (context->sync);
+	if (context->store != NULL)
+		g_object_unref (context->store);
+
+	context->store = g_object_new (TYPE_BENCHMARK_STORE, NULL);
+
+	switch (context->service_type) {
+		case MOCK_CONTACTS: {
+			GDataContactsSync *sync;
+
+			sync = gdata_contacts_sync_new (GDATA_CONTACTS_SERVICE (context->service), GDATA_CONTACTS_SYNC_STORE (context->store));
+			gdata_contacts_sync_set_page_size (sync, page_size);
+			gdata_contacts_sync_set_clock_skew_margin (sync, 0);
+			context->sync = G_OBJECT (sync);
+			break;
+		}
+		case MOCK_CALENDAR: {
+			GDataCalendarSync *sync;
+
+			sync = gdata_calendar_sync_new (GDATA_CALENDAR_SERVICE (context->service), GDATA_CALENDAR_SYNC_STORE (context->store));
+			gdata_calendar_sync_set_page_size (sync, page_size);
+			gdata_calendar_sync_set_clock_skew_margin (sync, 0);
+			context->sync = G_OBJECT (sync);
+			break;
+		}
+		case MOCK_DOCUMENTS: {
+			GDataDocumentsSync *sync;
+
+			sync = gdata_documents_sync_new (GDATA_DOCUMENTS_SERVICE (context->service), GDATA_DOCUMENTS_SYNC_STORE (context->store));
+			gdata_documents_sync_set_page_size (sync, page_size);
+			context->sync = G_OBJECT (sync);
+			break;
+		}
+		case MOCK_N_SERVICES:
+		default:
+			g_assert_not_reached ();
+	}
+}
+
+static void
+sync_context_init (SyncContext *context, MockService service_type)
+{
+	GDataAuthorizer *authorizer;
+	GType gtype;
+
+	memset (context, 0, sizeof (*context));
+	context->service_type = service_type;
+
+	switch (service_type) {
+		case MOCK_CONTACTS:
+			gtype = GDATA_TYPE_CONTACTS_SERVICE;
+			break;
+		case MOCK_CALENDAR:
+			gtype = GDATA_TYPE_CALENDAR_SERVICE;
+			break;
+		case MOCK_DOCUMENTS:
+			gtype = GDATA_TYPE_DOCUMENTS_SERVICE;
+			break;
+		case MOCK_N_SERVICES:
+		default:
+			g_assert_not_reached ();
+	}
+
+	authorizer = GDATA_AUTHORIZER (g_object_new (TYPE_MOCK_AUTHORIZER, NULL));
+	context->service = GDATA_SERVICE (g_object_new (gtype, "authorizer", authorizer, "max-retries", MAX_RETRIES, "retry-delay", RETRY_DELAY_MS,
+	                                                NULL));
+	g_object_unref (authorizer);
+
+	if (service_type == MOCK_CALENDAR) {
+		GDataFeed *feed;
+		GError *error = NULL;
+
+		feed = gdata_calendar_service_query_own_calendars (GDATA_CALENDAR_SERVICE (context->service), NULL, NULL, NULL, NULL, &error);
+		g_assert_no_error (error);
+		g_assert (gdata_feed_get_entries (feed) != NULL);
+
+		context->calendar = g_object_ref (gdata_feed_get_entries (feed)->data);
+		g_object_unref (feed);
+	}
+
+	sync_context_reset (context);
+}
+
+static void
+sync_context_clear (SyncContext *context)
+{
+	g_object_unref (context->sync);
+	g_object_unref (context->store);
+	if (context->calendar != NULL)
+		g_object_unref (context->calendar);
+	g_object_unref (context->service);
+}
+
+/* Runs a synchronisation, returning the number of entries it added, changed or removed in the store */
+static guint
+run_sync (SyncContext *context)
+{
+	guint n_changed = 0, n_removed = 0;
+	GError *error = NULL;
+
+	switch (context->service_type) {
+		case MOCK_CONTACTS:
+			gdata_contacts_sync_run (GDATA_CONTACTS_SYNC (context->sync), NULL, &n_changed, &n_removed, &error);
+			break;
+		case MOCK_CALENDAR:
+			gdata_calendar_sync_run (GDATA_CALENDAR_SYNC (context->sync), context->calendar, NULL, &n_changed, &n_removed, &error);
+			break;
+		case MOCK_DOCUMENTS:
+			gdata_documents_sync_run (GDATA_DOCUMENTS_SYNC (context->sync), NULL, &n_changed, &n_removed, &error);
+			break;
+		case MOCK_N_SERVICES:
+		default:
+			g_assert_not_reached ();
+	}
+
+	g_assert_no_error (error);
+
+	return n_changed + n_removed;
+}
+
+static void
+batch_update_cb (guint index, GDataContactsContact *contact, GDataContactsContact *result, GError *error, gint *n_pushed)
+{
+	g_assert_no_error (error);
+	g_atomic_int_inc (n_pushed);
+}
+
+/* Updates --changes of the store's contacts in a batch, returning the number of contacts updated */
+static guint
+push_changes (SyncContext *context)
+{
+	GHashTableIter iter;
+	gpointer contact;
+	GList *contacts = NULL;
+	gint n_pushed = 0;
+	guint n = 0;
+	GError *error = NULL;
+
+	g_hash_table_iter_init (&iter, context->store->entries);
+	while (n < (guint) n_changes && g_hash_table_iter_next (&iter, NULL, &contact) == TRUE) {
+		gdata_entry_set_title (GDATA_ENTRY (contact), "Updated contact");
+		contacts = g_list_prepend (contacts, contact);
+		n++;
+	}
+
+	gdata_contacts_service_update_contacts (GDATA_CONTACTS_SERVICE (context->service), contacts, NULL,
+	                                        (GDataContactsServiceBatchCallback) batch_update_cb, &n_pushed, &error);
+	g_assert_no_error (error);
+
+	g_list_free (contacts);
+
+	return n_pushed;
+}
+
+/* Lists every page of the account through @query, returning the number of entries listed, whether or not their pages had changed */
+static guint
+list_pages (SyncContext *context, GDataQuery *query)
+{
+	guint n_live, i;
+
+	n_live = mock_backend_count_live_entries (context->service_type);
+
+	for (i = 0; i * (guint) page_size < n_live; i++) {
+		GDataFeed *feed = NULL;
+		GError *error = NULL;
+
+		gdata_query_set_start_index (query, 1 + i * page_size);
+
+		switch (context->service_type) {
+			case MOCK_CONTACTS:
+				feed = gdata_contacts_service_query_contacts (GDATA_CONTACTS_SERVICE (context->service), query, NULL, NULL, NULL, &error);
+				break;
+			case MOCK_CALENDAR:
+				feed = gdata_calendar_service_query_events (GDATA_CALENDAR_SERVICE (context->service), context->calendar, query, NULL, NULL,
+				                                            NULL, &error);
+				break;
+			case MOCK_DOCUMENTS:
+				feed = GDATA_FEED (gdata_documents_service_query_documents (GDATA_DOCUMENTS_SERVICE (context->service),
+				                                                            GDATA_DOCUMENTS_QUERY (query), NULL, NULL, NULL, &error));
+				break;
+			case MOCK_N_SERVICES:
+			default:
+				g_assert_not_reached ();
+		}
+
+		g_assert_no_error (error);
+
+		/* The feed is NULL if the page hasn't changed since it was last fetched */
+		if (feed != NULL)
+			g_object_unref (feed);
+	}
+
+	return n_live;
+}
+
+/*
+ * Peak RSS.
+ *
+ * On Linux 4.0 and later, writing 5 to /proc/self/clear_refs resets VmHWM (the peak resident set size) to the current RSS, so that each workload's
+ * peak can be measured separately. Elsewhere, the peak since the process started is reported.
+ */
+static void
+reset_peak_rss (void)
+{
+	FILE *file;
+
+	file = fopen ("/proc/self/clear_refs", "w");
+	if (file != NULL) {
+		fputs ("5", file);
+		fclose (file);
+	}
+}
+
+static glong
+get_peak_rss_kib (void)
+{
+	gchar *status = NULL;
+	const gchar *line;
+	struct rusage usage;
+	glong peak_rss = -1;
+
+	if (g_file_get_contents ("/proc/self/status", &status, NULL, NULL) == TRUE &&
+	    (line = strstr (status, "\nVmHWM:")) != NULL) {
+		peak_rss = strtol (line + strlen ("\nVmHWM:"), NULL, 10);
+	}
+
+	g_free (status);
+
+	if (peak_rss < 0 && getrusage (RUSAGE_SELF, &usage) == 0)
+		peak_rss = usage.ru_maxrss; /* in KiB on Linux */
+
+	return peak_rss;
+}
+
+typedef enum {
+	SYNC_FULL,
+	SYNC_INCREMENTAL,
+	SYNC_BATCH_PUSH,
+	SYNC_REVALIDATE,
+} SyncMode;
+
+typedef struct {
+	const gchar *name;
+	MockService service;
+	SyncMode mode;
+	GType (*get_query_type) (void); /* for SYNC_REVALIDATE */
+} ThroughputWorkload;
+
+static const ThroughputWorkload workloads[] = {
+	{ "sync/contacts/full", MOCK_CONTACTS, SYNC_FULL, NULL },
+	{ "sync/contacts/incremental", MOCK_CONTACTS, SYNC_INCREMENTAL, NULL },
+	{ "sync/contacts/batch-push", MOCK_CONTACTS, SYNC_BATCH_PUSH, NULL },
+	{ "sync/contacts/revalidate", MOCK_CONTACTS, SYNC_REVALIDATE, gdata_contacts_query_get_type },
+	{ "sync/calendar/full", MOCK_CALENDAR, SYNC_FULL, NULL },
+	{ "sync/calendar/incremental", MOCK_CALENDAR, SYNC_INCREMENTAL, NULL },
+	{ "sync/calendar/revalidate", MOCK_CALENDAR, SYNC_REVALIDATE, gdata_calendar_query_get_type },
+	{ "sync/documents/full", MOCK_DOCUMENTS, SYNC_FULL, NULL },
+	{ "sync/documents/incremental", MOCK_DOCUMENTS, SYNC_INCREMENTAL, NULL },
+	{ "sync/documents/revalidate", MOCK_DOCUMENTS, SYNC_REVALIDATE, gdata_documents_query_get_type },
+};
+
+static void
+run_workload (const ThroughputWorkload *workload)
+{
+	SyncContext context;
+	GDataQuery *query = NULL;
+	MockStatistics before, after;
+	gint64 start, elapsed = 0;
+	guint64 n_entries = 0;
+	guint64 n_requests, n_bytes;
+	gchar number_buffer[G_ASCII_DTOSTR_BUF_SIZE];
+	gulong handler_id;
+	GString *result;
+	gint i;
+
+	if (filter != NULL && strstr (workload->name, filter) == NULL)
+		return;
+
+	mock_backend_reset (n_account_entries);
+
+	handler_id = g_signal_connect (mock_server, "handle-message", (GCallback) server_handle_message_cb, NULL);
+	uhm_server_run (mock_server);
+	gdata_test_set_https_port (mock_server);
+
+	sync_context_init (&context, workload->service);
+
+	/* Everything apart from full synchronisation starts from an up-to-date store, or (for revalidation) from having seen every page */
+	if (workload->mode == SYNC_INCREMENTAL || workload->mode == SYNC_BATCH_PUSH) {
+		run_sync (&context);
+	} else if (workload->mode == SYNC_REVALIDATE) {
+		query = GDATA_QUERY (g_object_new (workload->get_query_type (), "max-results", page_size, "page-cache-mode", GDATA_PAGE_CACHE_ETAGS,
+		                                   NULL));
+		list_pages (&context, query);
+	}
+
+	reset_peak_rss ();
+	mock_backend_get_statistics (&before);
+
+	for (i = 0; i < rounds; i++) {
+		switch (workload->mode) {
+			case SYNC_FULL:
+				sync_context_reset (&context);
+
+				start = g_get_monotonic_time ();
+				n_entries += run_sync (&context);
+				elapsed += g_get_monotonic_time () - start;
+				break;
+			case SYNC_INCREMENTAL:
+				mock_backend_make_changes (workload->service, n_changes);
+
+				start = g_get_monotonic_time ();
+				n_entries += run_sync (&context);
+				elapsed += g_get_monotonic_time () - start;
+				break;
+			case SYNC_BATCH_PUSH:
+				start = g_get_monotonic_time ();
+				n_entries += push_changes (&context);
+				n_entries += run_sync (&context);
+				elapsed += g_get_monotonic_time () - start;
+				break;
+			case SYNC_REVALIDATE:
+				start = g_get_monotonic_time ();
+				n_entries += list_pages (&context, query);
+				elapsed += g_get_monotonic_time () - start;
+				break;
+			default:
+				g_assert_not_reached ();
+		}
+	}
+
+	mock_backend_get_statistics (&after);
+
+	n_requests = after.n_requests - before.n_requests;
+	n_bytes = after.n_bytes - before.n_bytes;
+
+	result = g_string_new (NULL);
+	g_string_append_printf (result, "{\"benchmark\": \"%s\", \"account_entries\": %d, \"changes\": %d, \"page_size\": %d, \"throttle_every\": %d",
+	                        workload->name, n_account_entries, n_changes, page_size, throttle_every);
+	g_string_append_printf (result, ", \"rounds\": %d, \"entries\": %" G_GUINT64_FORMAT, rounds, n_entries);
+	g_string_append_printf (result, ", \"seconds\": %s",
+	                        g_ascii_dtostr (number_buffer, sizeof (number_buffer), (gdouble) elapsed / (gdouble) G_USEC_PER_SEC));
+	g_string_append_printf (result, ", \"entries_per_second\": %s",
+	                        g_ascii_dtostr (number_buffer, sizeof (number_buffer),
+	                                        (gdouble) n_entries * (gdouble) G_USEC_PER_SEC / (gdouble) MAX (elapsed, 1)));
+	g_string_append_printf (result, ", \"requests_per_entry\": %s",
+	                        g_ascii_dtostr (number_buffer, sizeof (number_buffer), (gdouble) n_requests / (gdouble) MAX (n_entries, 1)));
+	g_string_append_printf (result, ", \"bytes_per_entry\": %s",
+	                        g_ascii_dtostr (number_buffer, sizeof (number_buffer), (gdouble) n_bytes / (gdouble) MAX (n_entries, 1)));
+	g_string_append_printf (result, ", \"requests\": %" G_GUINT64_FORMAT ", \"not_modified\": %u, \"throttled\": %u, \"peak_rss_kib\": %ld}",
+	                        n_requests, after.n_not_modified - before.n_not_modified, after.n_throttled - before.n_throttled,
+	                        get_peak_rss_kib ());
+	g_print ("%s\n", result->str);
+	g_string_free (result, TRUE);
+
+	if (query != NULL)
+		g_object_unref (query);
+	sync_context_clear (&context);
+
+	uhm_server_stop (mock_server);
+	g_signal_handler_disconnect (mock_server, handler_id);
+}
+
+static void
+mock_server_notify_resolver_cb (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	UhmServer *server;
+	UhmResolver *resolver;
+
+	server = UHM_SERVER (object);
+	resolver = uhm_server_get_resolver (server);
+
+	if (resolver != NULL) {
+		const gchar *ip_address = uhm_server_get_address (server);
+
+		uhm_resolver_add_A (resolver, "www.google.com", ip_address);
+		uhm_resolver_add_A (resolver, "docs.google.com", ip_address);
+	}
+}
+
+int
+main (int argc, char *argv[])
+{
+	GOptionContext *context;
+	GError *error = NULL;
+	guint i;
+	const GOptionEntry entries[] = {
+		{ "entries", 0, 0, G_OPTION_ARG_INT, &n_account_entries, "Number of entries in each service of the mock account (default: 10000)", "N" },
+		{ "changes", 0, 0, G_OPTION_ARG_INT, &n_changes, "Number of changes synchronised in each incremental round (default: 100)", "N" },
+		{ "page-size", 0, 0, G_OPTION_ARG_INT, &page_size, "Number of entries requested in each page of results (default: 250)", "N" },
+		{ "rounds", 0, 0, G_OPTION_ARG_INT, &rounds, "Number of measured rounds of each benchmark (default: 3)", "N" },
+		{ "throttle-every", 0, 0, G_OPTION_ARG_INT, &throttle_every, "Throttle every Nth GET request, or 0 to never throttle (default: 50)", "N" },
+		{ "filter", 0, 0, G_OPTION_ARG_STRING, &filter, "Only run benchmarks whose names contain STRING", "STRING" },
+		{ NULL }
+	};
+
+	setlocale (LC_ALL, "");
+
+	/* Parse our options first, leaving the rest for gdata_test_init() */
+	context = g_option_context_new ("— measure synchronisation throughput against a mock account");
+	g_option_context_add_main_entries (context, entries, NULL);
+	g_option_context_set_ignore_unknown_options (context, TRUE);
+	g_option_context_set_help_enabled (context, FALSE);
+
+	if (g_option_context_parse (context, &argc, &argv, &error) == FALSE || n_account_entries < 1 || n_changes < 0 || page_size < 1 ||
+	    rounds < 1 || throttle_every < 0) {
+		g_printerr ("%s\n", (error != NULL) ? error->message : "Invalid option value.");
+		g_clear_error (&error);
+		g_option_context_free (context);
+		return 1;
+	}
+
+	g_option_context_free (context);
+
+	/* Logging every message would dominate the measurements; it can still be turned on from the environment */
+	g_setenv ("LIBGDATA_DEBUG", "0" /* GDATA_LOG_NONE */, FALSE);
+
+	gdata_test_init (argc, argv);
+
+	mock_server = gdata_test_get_mock_server ();
+	g_signal_connect (G_OBJECT (mock_server), "notify::resolver", (GCallback) mock_server_notify_resolver_cb, NULL);
+
+	for (i = 0; i < G_N_ELEMENTS (workloads); i++)
+		run_workload (&workloads[i]);
+
+	g_free (filter);
+
+	return 0;
+}
@@ -1314,61 +1314,187 @@ test_parsing_georss_where (void)
 	g_object_unref (video);
 }
 
+static const gchar *media_group_video_xml =
+	"<entry xmlns='http://www.w3.org/2005/Atom' "
+	       "xmlns:media='http://search.yahoo.com/mrss/' "
+	       "xmlns:yt='http://gdata.youtube.com/schemas/2007' "
+	       "xmlns:gd='http://schemas.google.com/g/2005'>"
+		"<id>tag:youtube.com,2008:video:JAagedeKdcQ</id>"
+		"<published>2006-05-16T14:06:37.000Z</published>"
+		"<updated>2009-03-23T12:46:58.000Z</updated>"
+		"<category scheme='http://schemas.google.com/g/2005#kind' term='http://gdata.youtube.com/schemas/2007#video'/>"
+		"<title>Some video somewhere</title>"
+		"<link rel='http://www.iana.org/assignments/relation/alternate' type='text/html' href='http://www.youtube.com/watch?v=JAagedeKdcQ'/>"
+		"<link rel='http://www.iana.org/assignments/relation/self' type='application/atom+xml' href='http://gdata.youtube.com/feeds/api/videos/JAagedeKdcQ?client=ytapi-google-jsdemo'/>"
+		"<author>"
+			"<name>Foo</name>"
+			"<uri>http://gdata.youtube.com/feeds/api/users/Foo</uri>"
+		"</author>"
+		"<media:group>"
+			"<media:category label='Shows' scheme='http://gdata.youtube.com/schemas/2007/categories.cat'>Shows</media:category>"
+			"<media:category scheme='http://gdata.youtube.com/schemas/2007/releasemediums.cat'>6</media:category>"
+			"<media:category scheme='http://gdata.youtube.com/schemas/2007/mediatypes.cat'>3</media:category>"
+			"<media:content url='http://www.youtube.com/v/aklRlKH4R94?f=related&amp;d=ARK7_SyB_5iKQvGvwsk-0D4O88HsQjpE1a8d1GxQnGDm&amp;app=youtube_gdata' type='application/x-shockwave-flash' medium='video' isDefault='true' expression='full' duration='163' yt:format='5'/>"
+			"<media:content url='rtsp://v3.cache6.c.youtube.com/CkYLENy73wIaPQneR_ihlFFJahMYDSANFEgGUgdyZWxhdGVkciEBErv9LIH_mIpC8a_CyT7QPg7zwexCOkTVrx3UbFCcYOYM/0/0/0/video.3gp' type='video/3gpp' medium='video' expression='full' duration='163' yt:format='1'/>"
+			"<media:content url='rtsp://v3.cache3.c.youtube.com/CkYLENy73wIaPQneR_ihlFFJahMYESARFEgGUgdyZWxhdGVkciEBErv9LIH_mIpC8a_CyT7QPg7zwexCOkTVrx3UbFCcYOYM/0/0/0/video.3gp' type='video/3gpp' medium='video' expression='full' duration='163' yt:format='6'/>"
+			"<media:credit role='uploader' scheme='urn:youtube' yt:type='partner'>machinima</media:credit>"
+			"<media:credit role='Producer' scheme='urn:ebu'>Machinima</media:credit>"
+			"<media:credit role='info' scheme='urn:ebu'>season 1 episode 4 air date 08/22/10</media:credit>"
+			"<media:credit role='Producer' scheme='urn:ebu'>Machinima</media:credit>"
+			"<media:credit role='info' scheme='urn:ebu'>season 1 episode 4 air date 08/22/10</media:credit>"
+			"<media:description type='plain'>www.youtube.com Click here to watch If It Were Realistic: Melee If It Were Realistic: Gravity Gun (Half Life 2 Machinima) What if gravity guns were realistic? Created by Renaldoxx from Massive X Productions Directors Channel: www.youtube.com www.youtube.com - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - Follow Machinima on Twitter! Machinima twitter.com Inside Gaming twitter.com Machinima Respawn twitter.com Machinima Entertainment, Technology, Culture twitter.com FOR MORE MACHINIMA, GO TO: www.youtube.com FOR MORE GAMEPLAY, GO TO: www.youtube.com FOR MORE SPORTS GAMEPLAY, GO TO: www.youtube.com FOR MORE TRAILERS, GO TO: www.youtube.com</media:description>"
+			"<media:keywords>Half, Life, If, It, Were, Realistic, Gravity, Gun, Renaldoxx, Sniper, Game, Machinima, Action, Gordon, Freeman, drift0r, Euphorian, Films, Combine, Rebel, Dark, Citizen, Diary, massivex, Productions, Massive, yt:quality=high, Half-Life, [2], HL2, fortress, gmod, left dead, tf2</media:keywords>"
+			"<media:player url='http://www.youtube.com/watch?v=aklRlKH4R94&amp;feature=youtube_gdata_player'/>"
+			"<media:rating scheme='urn:mpaa'>pg</media:rating>"
+			"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/default.jpg' height='90' width='120' time='00:01:21.500' yt:name='default'/>"
+			"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/hqdefault.jpg' height='360' width='480' yt:name='hqdefault'/>"
+			"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/1.jpg' height='90' width='120' time='00:00:40.750' yt:name='start'/>"
+			"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/2.jpg' height='90' width='120' time='00:01:21.500' yt:name='middle'/>"
+			"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/3.jpg' height='90' width='120' time='00:02:02.250' yt:name='end'/>"
+			"<media:title type='plain'>If It Were Realistic - Gravity Gun (Half Life 2 Machinima)</media:title>"
+			"<yt:aspectRatio>widescreen</yt:aspectRatio>"
+			"<yt:duration seconds='163'/>"
+			"<yt:uploaded>2010-08-22T14:04:18.000Z</yt:uploaded>"
+			"<yt:videoid>aklRlKH4R94</yt:videoid>"
+		"</media:group>"
+	"</entry>";
+
+static void
+check_media_group_video (GDataYouTubeVideo *video)
+{
+	GList *thumbnails;
+
+	g_assert_cmpstr (gdata_entry_get_title (GDATA_ENTRY (video)), ==, "Some video somewhere");
+	g_assert_cmpstr (gdata_youtube_video_get_video_id (video), ==, "aklRlKH4R94");
+	g_assert_cmpuint (gdata_youtube_video_get_duration (video), ==, 163);
+
+	thumbnails = gdata_youtube_video_get_thumbnails (video);
+	g_assert_cmpuint (g_list_length (thumbnails), ==, 5);
+	g_assert_cmpstr (gdata_media_thumbnail_get_uri (GDATA_MEDIA_THUMBNAIL (thumbnails->data)), ==, "http://i.ytimg.com/vi/aklRlKH4R94/default.jpg");
+	g_assert_cmpuint (gdata_media_thumbnail_get_width (GDATA_MEDIA_THUMBNAIL (thumbnails->data)), ==, 120);
+	g_assert_cmpuint (gdata_media_thumbnail_get_height (GDATA_MEDIA_THUMBNAIL (thumbnails->data)), ==, 90);
+}
+
 static void
 test_parsing_media_group (void)
 {
 	GDataYouTubeVideo *video;
 	GError *error = NULL;
 
+	video = GDATA_YOUTUBE_VIDEO (gdata_parsable_new_from_xml (GDATA_TYPE_YOUTUBE_VIDEO, media_group_video_xml, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_YOUTUBE_VIDEO (video));
+	g_clear_error (&error);
+
+	check_media_group_video (video);
+
+	g_object_unref (video);
+}
+
+static void
+test_parsing_media_group_lazy (void)
+{
+	GDataYouTubeVideo *eager_video, *lazy_video;
+	gchar *eager_xml, *lazy_xml;
+	guint n_thumbnails;
+	GError *error = NULL;
+
+	/* The mock server is driven directly, so there's nothing to check against online */
+	if (uhm_server_get_enable_online (mock_server) == TRUE || uhm_server_get_enable_logging (mock_server) == TRUE) {
+		g_test_message ("Skipping lazy parsing test when online or logging.");
+		return;
+	}
+
+	gdata_parsable_set_accounting_enabled (TRUE);
+
+	eager_video = GDATA_YOUTUBE_VIDEO (gdata_parsable_new_from_xml (GDATA_TYPE_YOUTUBE_VIDEO, media_group_video_xml, -1, &error));
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_YOUTUBE_VIDEO (eager_video));
+
+	/* Parsing lazily shouldn't create any of the media:group's thumbnails… */
+	n_thumbnails = gdata_test_count_parsables (GDATA_TYPE_MEDIA_THUMBNAIL);
+	lazy_video = GDATA_YOUTUBE_VIDEO (gdata_test_parse_entry_lazily (mock_server, GDATA_TYPE_YOUTUBE_VIDEO, media_group_video_xml));
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_MEDIA_THUMBNAIL), ==, n_thumbnails);
+
+	/* …until something needs them. Serialising an untouched lazy video has to produce the same XML as an eager one; in particular, media:title
+	 * must keep its own value rather than being overwritten by atom:title. */
+	eager_xml = gdata_parsable_get_xml (GDATA_PARSABLE (eager_video));
+	lazy_xml = gdata_parsable_get_xml (GDATA_PARSABLE (lazy_video));
+	g_assert_cmpstr (lazy_xml, ==, eager_xml);
+	g_assert (strstr (lazy_xml, "If It Were Realistic - Gravity Gun (Half Life 2 Machinima)") != NULL);
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_MEDIA_THUMBNAIL), ==, n_thumbnails + 5);
+	g_free (lazy_xml);
+	g_free (eager_xml);
+
+	g_object_unref (lazy_video);
+
+	/* Getting the thumbnails parses the group, once */
+	lazy_video = GDATA_YOUTUBE_VIDEO (gdata_test_parse_entry_lazily (mock_server, GDATA_TYPE_YOUTUBE_VIDEO, media_group_video_xml));
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_MEDIA_THUMBNAIL), ==, n_thumbnails);
+
+	check_media_group_video (lazy_video);
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_MEDIA_THUMBNAIL), ==, n_thumbnails + 5);
+	check_media_group_video (lazy_video);
+	g_assert_cmpuint (gdata_test_count_parsables (GDATA_TYPE_MEDIA_THUMBNAIL), ==, n_thumbnails + 5);
+
+	/* Changing the title while the group is still deferred must still reach media:title */
+	g_object_unref (lazy_video);
+	lazy_video = GDATA_YOUTUBE_VIDEO (gdata_test_parse_entry_lazily (mock_server, GDATA_TYPE_YOUTUBE_VIDEO, media_group_video_xml));
+	gdata_entry_set_title (GDATA_ENTRY (lazy_video), "New title");
+
+	lazy_xml = gdata_parsable_get_xml (GDATA_PARSABLE (lazy_video));
+	g_assert (strstr (lazy_xml, "<media:title type='plain'>New title</media:title>") != NULL);
+	g_free (lazy_xml);
+
+	g_object_unref (lazy_video);
+	g_object_unref (eager_video);
+
+	gdata_parsable_set_accounting_enabled (FALSE);
+}
+
+static void
+test_thumbnail_prefetcher_choose_thumbnail (gconstpointer service)
+{
+	GDataYouTubeVideo *video;
+	GDataThumbnailPrefetcher *prefetcher;
+	GDataMediaThumbnail *thumbnail;
+	GError *error = NULL;
+
 	video = GDATA_YOUTUBE_VIDEO (gdata_parsable_new_from_xml (GDATA_TYPE_YOUTUBE_VIDEO,
 		"<entry xmlns='http://www.w3.org/2005/Atom' "
 		       "xmlns:media='http://search.yahoo.com/mrss/' "
-		       "xmlns:yt='http://gdata.youtube.com/schemas/2007' "
-		       "xmlns:gd='http://schemas.google.com/g/2005'>"
-			"<id>tag:youtube.com,2008:video:JAagedeKdcQ</id>"
-			"<published>2006-05-16T14:06:37.000Z</published>"
+		       "xmlns:yt='http://gdata.youtube.com/schemas/2007'>"
+			"<id>tag:youtube.com,2008:video:aklRlKH4R94</id>"
 			"<updated>2009-03-23T12:46:58.000Z</updated>"
-			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://gdata.youtube.com/schemas/2007#video'/>"
 			"<title>Some video somewhere</title>"
-			"<link rel='http://www.iana.org/assignments/relation/alternate' type='text/html' href='http://www.youtube.com/watch?v=JAagedeKdcQ'/>"
-			"<link rel='http://www.iana.org/assignments/relation/self' type='application/atom+xml' href='http://gdata.youtube.com/feeds/api/videos/JAagedeKdcQ?client=ytapi-google-jsdemo'/>"
-			"<author>"
-				"<name>Foo</name>"
-				"<uri>http://gdata.youtube.com/feeds/api/users/Foo</uri>"
-			"</author>"
 			"<media:group>"
-				"<media:category label='Shows' scheme='http://gdata.youtube.com/schemas/2007/categories.cat'>Shows</media:category>"
-				"<media:category scheme='http://gdata.youtube.com/schemas/2007/releasemediums.cat'>6</media:category>"
-				"<media:category scheme='http://gdata.youtube.com/schemas/2007/mediatypes.cat'>3</media:category>"
-				"<media:content url='http://www.youtube.com/v/aklRlKH4R94?f=related&amp;d=ARK7_SyB_5iKQvGvwsk-0D4O88HsQjpE1a8d1GxQnGDm&amp;app=youtube_gdata' type='application/x-shockwave-flash' medium='video' isDefault='true' expression='full' duration='163' yt:format='5'/>"
-				"<media:content url='rtsp://v3.cache6.c.youtube.com/CkYLENy73wIaPQneR_ihlFFJahMYDSANFEgGUgdyZWxhdGVkciEBErv9LIH_mIpC8a_CyT7QPg7zwexCOkTVrx3UbFCcYOYM/0/0/0/video.3gp' type='video/3gpp' medium='video' expression='full' duration='163' yt:format='1'/>"
-				"<media:content url='rtsp://v3.cache3.c.youtube.com/CkYLENy73wIaPQneR_ihlFFJahMYESARFEgGUgdyZWxhdGVkciEBErv9LIH_mIpC8a_CyT7QPg7zwexCOkTVrx3UbFCcYOYM/0/0/0/video.3gp' type='video/3gpp' medium='video' expression='full' duration='163' yt:format='6'/>"
-				"<media:credit role='uploader' scheme='urn:youtube' yt:type='partner'>machinima</media:credit>"
-				"<media:credit role='Producer' scheme='urn:ebu'>Machinima</media:credit>"
-				"<media:credit role='info' scheme='urn:ebu'>season 1 episode 4 air date 08/22/10</media:credit>"
-				"<media:credit role='Producer' scheme='urn:ebu'>Machinima</media:credit>"
-				"<media:credit role='info' scheme='urn:ebu'>season 1 episode 4 air date 08/22/10</media:credit>"
-				"<media:description type='plain'>www.youtube.com Click here to watch If It Were Realistic: Melee If It Were Realistic: Gravity Gun (Half Life 2 Machinima) What if gravity guns were realistic? Created by Renaldoxx from Massive X Productions Directors Channel: www.youtube.com www.youtube.com - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - Follow Machinima on Twitter! Machinima twitter.com Inside Gaming twitter.com Machinima Respawn twitter.com Machinima Entertainment, Technology, Culture twitter.com FOR MORE MACHINIMA, GO TO: www.youtube.com FOR MORE GAMEPLAY, GO TO: www.youtube.com FOR MORE SPORTS GAMEPLAY, GO TO: www.youtube.com FOR MORE TRAILERS, GO TO: www.youtube.com</media:description>"
-				"<media:keywords>Half, Life, If, It, Were, Realistic, Gravity, Gun, Renaldoxx, Sniper, Game, Machinima, Action, Gordon, Freeman, drift0r, Euphorian, Films, Combine, Rebel, Dark, Citizen, Diary, massivex, Productions, Massive, yt:quality=high, Half-Life, [2], HL2, fortress, gmod, left dead, tf2</media:keywords>"
-				"<media:player url='http://www.youtube.com/watch?v=aklRlKH4R94&amp;feature=youtube_gdata_player'/>"
-				"<media:rating scheme='urn:mpaa'>pg</media:rating>"
-				"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/default.jpg' height='90' width='120' time='00:01:21.500' yt:name='default'/>"
+				"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/default.jpg' height='90' width='120' yt:name='default'/>"
 				"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/hqdefault.jpg' height='360' width='480' yt:name='hqdefault'/>"
-				"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/1.jpg' height='90' width='120' time='00:00:40.750' yt:name='start'/>"
-				"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/2.jpg' height='90' width='120' time='00:01:21.500' yt:name='middle'/>"
-				"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/3.jpg' height='90' width='120' time='00:02:02.250' yt:name='end'/>"
-				"<media:title type='plain'>If It Were Realistic - Gravity Gun (Half Life 2 Machinima)</media:title>"
-				"<yt:aspectRatio>widescreen</yt:aspectRatio>"
-				"<yt:duration seconds='163'/>"
-				"<yt:uploaded>2010-08-22T14:04:18.000Z</yt:uploaded>"
-				"<yt:videoid>aklRlKH4R94</yt:videoid>"
+				"<media:thumbnail url='http://i.ytimg.com/vi/aklRlKH4R94/0.jpg' height='240' width='320'/>"
 			"</media:group>"
 		"</entry>", -1, &error));
 	g_assert_no_error (error);
 	g_assert (GDATA_IS_YOUTUBE_VIDEO (video));
-	g_clear_error (&error);
 
-	/* TODO: For the moment, we just check that parsing the XML didn't fail. Later, we might actually support outputting the XML again. */
+	/* Smallest thumbnail which is big enough */
+	prefetcher = gdata_thumbnail_prefetcher_new (GDATA_SERVICE (service), 200, 100);
+	g_assert_cmpuint (gdata_thumbnail_prefetcher_get_width (prefetcher), ==, 200);
+	g_assert_cmpuint (gdata_thumbnail_prefetcher_get_height (prefetcher), ==, 100);
+	thumbnail = gdata_thumbnail_prefetcher_choose_thumbnail (prefetcher, GDATA_ENTRY (video));
+	g_assert_cmpstr (gdata_media_thumbnail_get_uri (thumbnail), ==, "http://i.ytimg.com/vi/aklRlKH4R94/0.jpg");
+	g_object_unref (prefetcher);
+
+	/* Smallest thumbnail overall */
+	prefetcher = gdata_thumbnail_prefetcher_new (GDATA_SERVICE (service), 0, 0);
+	thumbnail = gdata_thumbnail_prefetcher_choose_thumbnail (prefetcher, GDATA_ENTRY (video));
+	g_assert_cmpstr (gdata_media_thumbnail_get_uri (thumbnail), ==, "http://i.ytimg.com/vi/aklRlKH4R94/default.jpg");
+	g_object_unref (prefetcher);
+
+	/* None are big enough, so the biggest should be chosen */
+	prefetcher = gdata_thumbnail_prefetcher_new (GDATA_SERVICE (service), 1024, 768);
+	thumbnail = gdata_thumbnail_prefetcher_choose_thumbnail (prefetcher, GDATA_ENTRY (video));
+	g_assert_cmpstr (gdata_media_thumbnail_get_uri (thumbnail), ==, "http://i.ytimg.com/vi/aklRlKH4R94/hqdefault.jpg");
+	g_object_unref (prefetcher);
 
 	g_object_unref (video);
 }
@@ -2096,6 +2222,88 @@ test_categories (gconstpointer service)
 	uhm_server_end_trace (mock_server);
 }
 
+static const gchar *
+get_first_category_label (GDataAPPCategories *app_categories)
+{
+	GList *categories;
+
+	categories = gdata_app_categories_get_categories (app_categories);
+	g_assert_cmpint (g_list_length (categories), ==, 1);
+	g_assert (GDATA_IS_YOUTUBE_CATEGORY (categories->data));
+
+	return gdata_category_get_label (GDATA_CATEGORY (categories->data));
+}
+
+static void
+test_categories_cache (gconstpointer service)
+{
+	GDataService *other_service;
+	GDataAPPCategories *app_categories, *fr_categories, *de_categories;
+	GError *error = NULL;
+	gchar *old_locale;
+
+	gdata_test_mock_server_start_trace (mock_server, "categories-cache");
+
+	/* Use locales which no other test uses, since the cache is shared between all services in the process */
+	old_locale = g_strdup (gdata_service_get_locale (GDATA_SERVICE (service)));
+	gdata_service_set_locale (GDATA_SERVICE (service), "fr");
+
+	fr_categories = gdata_youtube_service_get_categories (GDATA_YOUTUBE_SERVICE (service), NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_APP_CATEGORIES (fr_categories));
+	g_assert_cmpstr (get_first_category_label (fr_categories), ==, "Films et animation");
+
+	/* A different service with the same locale revalidates the cached categories, and gets the same object back when the server responds with
+	 * 304 Not Modified */
+	other_service = GDATA_SERVICE (gdata_youtube_service_new (DEVELOPER_KEY, NULL));
+	gdata_service_set_locale (other_service, "fr");
+
+	app_categories = gdata_youtube_service_get_categories (GDATA_YOUTUBE_SERVICE (other_service), NULL, &error);
+	g_assert_no_error (error);
+	g_assert (app_categories == fr_categories);
+	g_object_unref (app_categories);
+
+	/* Each locale is cached separately */
+	gdata_service_set_locale (other_service, "de");
+
+	de_categories = gdata_youtube_service_get_categories (GDATA_YOUTUBE_SERVICE (other_service), NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_APP_CATEGORIES (de_categories));
+	g_assert (de_categories != fr_categories);
+	g_assert_cmpstr (get_first_category_label (de_categories), ==, "Film und Animation");
+
+	/* The French categories are still cached, though */
+	app_categories = gdata_youtube_service_get_categories (GDATA_YOUTUBE_SERVICE (service), NULL, &error);
+	g_assert_no_error (error);
+	g_assert (app_categories == fr_categories);
+	g_object_unref (app_categories);
+
+	/* If the categories have changed on the server, the new ones replace the cached ones, and are revalidated from then on */
+	app_categories = gdata_youtube_service_get_categories (GDATA_YOUTUBE_SERVICE (service), NULL, &error);
+	g_assert_no_error (error);
+	g_assert (GDATA_IS_APP_CATEGORIES (app_categories));
+	g_assert (app_categories != fr_categories);
+	g_assert_cmpstr (get_first_category_label (app_categories), ==, "Cinema et animation");
+
+	g_object_unref (fr_categories);
+	fr_categories = app_categories;
+
+	app_categories = gdata_youtube_service_get_categories (GDATA_YOUTUBE_SERVICE (service), NULL, &error);
+	g_assert_no_error (error);
+	g_assert (app_categories == fr_categories);
+	g_object_unref (app_categories);
+
+	g_object_unref (fr_categories);
+	g_object_unref (de_categories);
+	g_object_unref (other_service);
+
+	/* Reset the locale */
+	gdata_service_set_locale (GDATA_SERVICE (service), old_locale);
+	g_free (old_locale);
+
+	uhm_server_end_trace (mock_server);
+}
+
 GDATA_ASYNC_TEST_FUNCTIONS (categories, void,
 G_STMT_START {
 	gdata_youtube_service_get_categories_async (GDATA_YOUTUBE_SERVICE (service), cancellable, async_ready_callback, async_data);
@@ -2291,6 +2499,150 @@ test_batch_async_cancellation (BatchData *data, gconstpointer service)
 	uhm_server_end_trace (mock_server);
 }
 
+static void
+test_multi_query_properties (gconstpointer service)
+{
+	GDataYouTubeMultiQuery *multi_query;
+	GDataYouTubeVideo *video;
+	GDataQuery *query;
+	GError *error = NULL;
+
+	multi_query = gdata_youtube_multi_query_new (GDATA_YOUTUBE_SERVICE (service));
+	g_assert (GDATA_IS_YOUTUBE_MULTI_QUERY (multi_query));
+	g_assert (gdata_youtube_multi_query_get_service (multi_query) == service);
+	g_assert_cmpuint (gdata_youtube_multi_query_get_max_concurrent_queries (multi_query), ==, 0);
+
+	gdata_youtube_multi_query_set_max_concurrent_queries (multi_query, 3);
+	g_assert_cmpuint (gdata_youtube_multi_query_get_max_concurrent_queries (multi_query), ==, 3);
+
+	/* Query IDs should be allocated sequentially, starting from 1 */
+	video = gdata_youtube_video_new (NULL);
+	query = GDATA_QUERY (gdata_youtube_query_new ("cats"));
+
+	g_assert_cmpuint (gdata_youtube_multi_query_add_standard_feed (multi_query, GDATA_YOUTUBE_TOP_RATED_FEED, NULL, NULL, NULL), ==, 1);
+	g_assert_cmpuint (gdata_youtube_multi_query_add_related (multi_query, video, NULL, NULL, NULL), ==, 2);
+	g_assert_cmpuint (gdata_youtube_multi_query_add_videos (multi_query, query, NULL, NULL), ==, 3);
+
+	g_object_unref (query);
+	g_object_unref (video);
+	g_object_unref (multi_query);
+
+	/* Running an empty multi-query should succeed without touching the network */
+	multi_query = gdata_youtube_multi_query_new (GDATA_YOUTUBE_SERVICE (service));
+	g_assert (gdata_youtube_multi_query_run (multi_query, NULL, &error) == TRUE);
+	g_assert_no_error (error);
+	g_object_unref (multi_query);
+}
+
+static void
+test_state_poller_properties (gconstpointer service)
+{
+	GDataYouTubeStatePoller *poller;
+	GDataYouTubeVideo *video;
+	GError *error = NULL;
+
+	poller = gdata_youtube_state_poller_new (GDATA_YOUTUBE_SERVICE (service));
+	g_assert (GDATA_IS_YOUTUBE_STATE_POLLER (poller));
+	g_assert (gdata_youtube_state_poller_get_service (poller) == service);
+	g_assert_cmpuint (gdata_youtube_state_poller_get_min_interval (poller), ==, 5);
+	g_assert_cmpuint (gdata_youtube_state_poller_get_max_interval (poller), ==, 300);
+	g_assert_cmpuint (gdata_youtube_state_poller_get_n_pending (poller), ==, 0);
+
+	gdata_youtube_state_poller_set_min_interval (poller, 10);
+	gdata_youtube_state_poller_set_max_interval (poller, 600);
+	g_assert_cmpuint (gdata_youtube_state_poller_get_min_interval (poller), ==, 10);
+	g_assert_cmpuint (gdata_youtube_state_poller_get_max_interval (poller), ==, 600);
+
+	video = GDATA_YOUTUBE_VIDEO (gdata_parsable_new_from_xml (GDATA_TYPE_YOUTUBE_VIDEO,
+		"<entry xmlns='http://www.w3.org/2005/Atom' "
+			"xmlns:media='http://search.yahoo.com/mrss/' "
+			"xmlns:yt='http://gdata.youtube.com/schemas/2007' "
+			"xmlns:app='http://www.w3.org/2007/app'>"
+			"<id>tag:youtube.com,2008:video:JAagedeKdcQ</id>"
+			"<app:control>"
+				"<yt:state name='processing'/>"
+			"</app:control>"
+			"<category scheme='http://schemas.google.com/g/2005#kind' term='http://gdata.youtube.com/schemas/2007#video'/>"
+			"<title>Processing</title>"
+			"<media:group>"
+				"<media:title type='plain'>Processing</media:title>"
+				"<yt:videoid>JAagedeKdcQ</yt:videoid>"
+			"</media:group>"
+		"</entry>", -1, &error));
+	g_assert_no_error (error);
+	g_assert_cmpstr (gdata_youtube_video_get_video_id (video), ==, "JAagedeKdcQ");
+
+	/* Adding the same video twice should replace it, rather than polling it twice. Nothing is polled until the main loop runs. */
+	gdata_youtube_state_poller_add_video (poller, video);
+	gdata_youtube_state_poller_add_video (poller, video);
+	g_assert_cmpuint (gdata_youtube_state_poller_get_n_pending (poller), ==, 1);
+
+	g_assert (gdata_youtube_state_poller_remove_video (poller, "JAagedeKdcQ") == TRUE);
+	g_assert (gdata_youtube_state_poller_remove_video (poller, "JAagedeKdcQ") == FALSE);
+	g_assert_cmpuint (gdata_youtube_state_poller_get_n_pending (poller), ==, 0);
+
+	g_object_unref (video);
+	g_object_unref (poller);
+}
+
+static void
+test_upload_queue_missing_file_cb (guint upload_id, GDataEntry *entry, GDataEntry *uploaded_entry, GError *error, guint *callback_count)
+{
+	g_assert_cmpuint (upload_id, !=, 0);
+	g_assert (GDATA_IS_YOUTUBE_VIDEO (entry));
+	g_assert (uploaded_entry == NULL);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+
+	(*callback_count)++;
+}
+
+static void
+test_upload_queue_missing_file (gconstpointer service)
+{
+	GDataUploadQueue *queue;
+	GDataYouTubeVideo *video;
+	GFile *file;
+	guint callback_count = 0, uploads_finished, uploads_total;
+	goffset bytes_uploaded, bytes_total;
+	GError *error = NULL;
+
+	queue = gdata_youtube_service_create_upload_queue (GDATA_YOUTUBE_SERVICE (service));
+	g_assert (GDATA_IS_UPLOAD_QUEUE (queue));
+	g_assert (gdata_upload_queue_get_service (queue) == service);
+	g_assert_cmpuint (gdata_upload_queue_get_max_concurrent_uploads (queue), ==, 4);
+	g_assert_cmpuint (gdata_upload_queue_get_max_retries (queue), ==, 3);
+
+	gdata_upload_queue_set_max_concurrent_uploads (queue, 2);
+	g_assert_cmpuint (gdata_upload_queue_get_max_concurrent_uploads (queue), ==, 2);
+
+	/* Neither upload should touch the network, since the files can't be found */
+	video = gdata_youtube_video_new (NULL);
+	file = g_file_new_for_path (TEST_FILE_DIR "this-file-does-not-exist.mp4");
+
+	g_assert_cmpuint (gdata_upload_queue_add_file (queue, GDATA_ENTRY (video), file,
+	                                               (GDataUploadQueueCallback) test_upload_queue_missing_file_cb, &callback_count), ==, 1);
+	g_assert_cmpuint (gdata_upload_queue_add_file (queue, GDATA_ENTRY (video), file,
+	                                               (GDataUploadQueueCallback) test_upload_queue_missing_file_cb, &callback_count), ==, 2);
+
+	g_object_unref (file);
+	g_object_unref (video);
+
+	g_assert (gdata_upload_queue_run (queue, NULL, &error) == FALSE);
+	g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+	g_clear_error (&error);
+
+	g_assert_cmpuint (callback_count, ==, 2);
+
+	gdata_upload_queue_get_progress (queue, &uploads_finished, &uploads_total, &bytes_uploaded, &bytes_total);
+	g_assert_cmpuint (uploads_finished, ==, 2);
+	g_assert_cmpuint (uploads_total, ==, 2);
+	g_assert_cmpint (bytes_uploaded, ==, 0);
+	g_assert_cmpint (bytes_total, ==, 0);
+	g_assert_cmpuint (gdata_upload_queue_get_throughput (queue), ==, 0);
+
+	g_object_unref (queue);
+}
+
 static void
 teardown_batch (BatchData *data, gconstpointer service)
 {
@@ -2374,6 +2726,10 @@ main (int argc, char *argv[])
 	g_test_add ("/youtube/upload/async", GDataAsyncTestData, service, set_up_upload_async, test_upload_async, tear_down_upload_async);
 	g_test_add ("/youtube/upload/async/cancellation", GDataAsyncTestData, service, set_up_upload_async, test_upload_async_cancellation,
 	            tear_down_upload_async);
+	g_test_add_data_func ("/youtube/upload/queue/missing-file", service, test_upload_queue_missing_file);
+	g_test_add_data_func ("/youtube/thumbnail-prefetcher/choose-thumbnail", service, test_thumbnail_prefetcher_choose_thumbnail);
+	g_test_add_data_func ("/youtube/multi-query/properties", service, test_multi_query_properties);
+	g_test_add_data_func ("/youtube/state-poller/properties", service, test_state_poller_properties);
 
 	g_test_add_data_func ("/youtube/query/single", service, test_query_single);
 	g_test_add ("/youtube/query/single/async", GDataAsyncTestData, service, gdata_set_up_async_test_data, test_query_single_async,
@@ -2404,6 +2760,7 @@ main (int argc, char *argv[])
 	            test_comment_delete_async_cancellation, tear_down_insert_comment_async);
 
 	g_test_add_data_func ("/youtube/categories", service, test_categories);
+	g_test_add_data_func ("/youtube/categories/cache", service, test_categories_cache);
 	g_test_add ("/youtube/categories/async", GDataAsyncTestData, service, gdata_set_up_async_test_data, test_categories_async,
 	            gdata_tear_down_async_test_data);
 	g_test_add ("/youtube/categories/async/cancellation", GDataAsyncTestData, service, gdata_set_up_async_test_data,
@@ -2423,6 +2780,7 @@ main (int argc, char *argv[])
 	g_test_add_func ("/youtube/parsing/video_id_from_uri", test_parsing_video_id_from_uri);
 	g_test_add_func ("/youtube/parsing/georss:where", test_parsing_georss_where);
 	g_test_add_func ("/youtube/parsing/media:group", test_parsing_media_group);
+	g_test_add_func ("/youtube/parsing/media:group/lazy", test_parsing_media_group_lazy);
 	g_test_add_func ("/youtube/parsing/media:group/ratings", test_parsing_media_group_ratings);
 	g_test_add_func ("/youtube/parsing/media:group/ratings/error_handling", test_parsing_media_group_ratings_error_handling);
 